@@ -75,11 +75,13 @@ typedef void *uspace_addr_t;
 #define uspace_ptr_cap_irq_handle_t uspace_ptr(cap_irq_handle_t)
 #define uspace_ptr_cap_phone_handle_t uspace_ptr(cap_phone_handle_t)
 #define uspace_ptr_cap_waitq_handle_t uspace_ptr(cap_waitq_handle_t)
+#define uspace_ptr_cap_ring_handle_t uspace_ptr(cap_ring_handle_t)
 #define uspace_ptr_char uspace_ptr(char)
 #define uspace_ptr_const_char uspace_ptr(const char)
 #define uspace_ptr_ddi_ioarg_t uspace_ptr(ddi_ioarg_t)
 #define uspace_ptr_ipc_data_t uspace_ptr(ipc_data_t)
 #define uspace_ptr_irq_code_t uspace_ptr(irq_code_t)
+#define uspace_ptr_irq_msi_t uspace_ptr(irq_msi_t)
 #define uspace_ptr_size_t uspace_ptr(size_t)
 #define uspace_ptr_struct_uspace_arg uspace_ptr(struct uspace_arg)
 #define uspace_ptr_sysarg64_t uspace_ptr(sysarg64_t)
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup abi_generic
+ * @{
+ */
+/** @file Boot timeline.
+ */
+
+#ifndef _ABI_BOOTMARK_H_
+#define _ABI_BOOTMARK_H_
+
+#include <stdint.h>
+#include <abi/proc/task.h>
+
+/** Maximum number of boot milestones recorded by the kernel. */
+#define BOOTMARK_MAX  256
+
+/** Size of the milestone name buffer, including the terminating NUL. */
+#define BOOTMARK_NAME_SIZE  48
+
+/** Prefix of kernel log messages announcing a boot milestone.
+ *
+ * The prefix is followed by the time in microseconds, the id of the
+ * task which recorded the milestone (0 for the kernel) and the name,
+ * separated by single spaces.
+ */
+#define BOOTMARK_LOG_PREFIX  "@bootmark"
+
+/** Name of the sysinfo item with the array of recorded milestones. */
+#define BOOTMARK_SYSINFO  "boot.timeline"
+
+/** One boot milestone. */
+typedef struct {
+	/** Uptime in microseconds when the milestone was reached. */
+	uint64_t time;
+	/** Task which recorded the milestone, 0 for the kernel. */
+	task_id_t task_id;
+	/** Name of the milestone. */
+	char name[BOOTMARK_NAME_SIZE];
+} bootmark_t;
+
+#endif
+
+/** @}
+ */
@@ -52,6 +52,9 @@ typedef struct {
 typedef struct {
 } *cap_waitq_handle_t;
 
+typedef struct {
+} *cap_ring_handle_t;
+
 static cap_handle_t const CAP_NIL = 0;
 
 static inline bool cap_handle_valid(cap_handle_t handle)
@@ -132,11 +132,40 @@ typedef struct {
 	uintptr_t dstarg;
 } irq_cmd_t;
 
+/** Moderation of the notifications of an IRQ subscription
+ *
+ * Interrupts which are not notified right away are merged into a single
+ * notification carrying their count and the scratch values of the last
+ * of them. Zero members disable the respective limit, a zeroed structure
+ * disables moderation.
+ */
+typedef struct {
+	/** Minimum interval between two notifications in microseconds */
+	uint32_t interval;
+	/** Maximum number of interrupts merged into one notification */
+	uint32_t max_pending;
+} irq_moderation_t;
+
+/** Block of message signalled interrupts.
+ *
+ * Interrupt @c i of the block has INR @c inr + @c i and is raised by the
+ * device writing @c data + @c i to @c address.
+ */
+typedef struct {
+	/** INR of the first interrupt in the block */
+	int inr;
+	/** Message data of the first interrupt in the block */
+	uint32_t data;
+	/** Message address */
+	uint64_t address;
+} irq_msi_t;
+
 typedef struct {
 	size_t rangecount;
 	irq_pio_range_t *ranges;
 	size_t cmdcount;
 	irq_cmd_t *cmds;
+	irq_moderation_t moderation;
 } irq_code_t;
 
 #endif
@@ -51,6 +51,8 @@ typedef enum event_type {
 /** Per-task events. */
 typedef enum event_task_type {
 	EVENT_TASK_STATE_CHANGE = EVENT_END,
+	/** Memory is low, the task should drop its caches */
+	EVENT_TASK_MEM_PRESSURE,
 	EVENT_TASK_END
 } event_task_type_t;
 
@@ -52,6 +52,9 @@ enum {
 	/** Maximum active async calls per phone */
 	IPC_MAX_ASYNC_CALLS = 64,
 
+	/** Maximum number of calls submitted or received by one batch syscall */
+	IPC_MAX_BATCH = 64,
+
 	/**
 	 * Maximum buffer size allowed for IPC_M_DATA_WRITE and
 	 * IPC_M_DATA_READ requests.
@@ -75,6 +78,12 @@ enum {
 
 	/** The call was automatically answered by the kernel due to error */
 	IPC_CALL_AUTO_REPLY     = 1 << 4,
+
+	/**
+	 * The call was received through a shared-memory ring instead of the
+	 * answerbox. This flag is never set by the kernel.
+	 */
+	IPC_CALL_RING           = 1 << 5,
 };
 
 /* Forwarding flags. */
@@ -116,7 +125,10 @@ typedef struct {
 	unsigned flags;
 	/** User-defined label associated with requests */
 	sysarg_t request_label;
-	/** User-defined label associated with answers */
+	/**
+	 * User-defined label associated with answers. For IRQ notifications,
+	 * the number of interrupts the notification stands for.
+	 */
 	sysarg_t answer_label;
 	/** Capability handle */
 	cap_call_handle_t cap_handle;
@@ -193,6 +205,11 @@ static inline sysarg_t ipc_get_arg5(ipc_data_t *data)
 	return data->args[5];
 }
 
+static inline sysarg_t ipc_get_irq_count(ipc_data_t *data)
+{
+	return data->answer_label;
+}
+
 #endif
 
 /** @}
@@ -120,6 +120,7 @@ enum {
 	 * on answer, the recipient must set:
 	 *
 	 * - ARG1 - source user page address
+	 * - ARG2 - page flags (AS_PAGER_WRITEBACK)
 	 */
 	IPC_M_PAGE_IN,
 
@@ -214,6 +215,52 @@ enum {
 	 * - other arguments are specific to the debug method
 	 */
 	IPC_M_DEBUG,
+
+	/** Set up a pair of shared-memory rings for the connection.
+	 *
+	 * - ARG1 - base address of the as_area with the rings
+	 * - ARG2 - size of the as_area (filled automatically by kernel)
+	 * - ARG3 - sender's ring capability handle
+	 * - ARG4 - recipient's ring capability handle
+	 *          (filled automatically by the kernel)
+	 *
+	 * on answer, the recipient must set:
+	 *
+	 * - ARG1 - dst as_area lower bound
+	 * - ARG2 - dst as_area base address pointer
+	 *          (filled automatically by the kernel)
+	 *
+	 * The ring capability is published in the recipient only when the
+	 * area has been shared successfully.
+	 */
+	IPC_M_RING_SHARE,
+
+	/** Write back pages modified through a user-paged area.
+	 *
+	 * Sent by the kernel for pages supplied with AS_PAGER_WRITEBACK
+	 * which were written to since they were mapped or last written back.
+	 *
+	 * - ARG1 - page-aligned offset from the beginning of the memory object
+	 * - ARG2 - size of the modified range
+	 * - ARG3 - user defined memory object ID
+	 * - ARG4 - user defined memory object ID
+	 * - ARG5 - user defined memory object ID
+	 */
+	IPC_M_PAGE_OUT,
+
+	/** Notify the pager that pages are no longer mapped.
+	 *
+	 * Sent by the kernel when a user-paged area holding pages supplied
+	 * with AS_PAGER_WRITEBACK is destroyed, after their modifications
+	 * have been written back.
+	 *
+	 * - ARG1 - page-aligned offset from the beginning of the memory object
+	 * - ARG2 - size of the unmapped range
+	 * - ARG3 - user defined memory object ID
+	 * - ARG4 - user defined memory object ID
+	 * - ARG5 - user defined memory object ID
+	 */
+	IPC_M_PAGE_RELEASE,
 };
 
 /** Last system IPC method */
@@ -37,7 +37,9 @@
 
 typedef enum {
 	KLOG_WRITE,
-	KLOG_READ
+	KLOG_READ,
+	/** Record a boot milestone of the calling task (see abi/bootmark.h) */
+	KLOG_BOOTMARK
 } klog_operation_t;
 
 #endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup abi_generic
+ * @{
+ */
+/** @file Kernel trace rings.
+ *
+ * The kernel records tracepoint hits into one ring per CPU. The rings
+ * are physically contiguous, ring i starts KTRACE_RING_SIZE * i bytes
+ * after the address published in sysinfo as "ktrace.faddr" and there are
+ * "ktrace.cpus" of them. A reader maps them read-only with physmem_map().
+ *
+ * The kernel overwrites the oldest records once a ring is full. The
+ * record with sequence number n lives in records[n % capacity] and is
+ * complete once head is greater than n. A reader which copied a record
+ * has to check that head did not reach n + capacity meanwhile, otherwise
+ * the copy may be torn and the record is lost.
+ */
+
+#ifndef _ABI_KTRACE_H_
+#define _ABI_KTRACE_H_
+
+#include <stdint.h>
+
+/** Size of the ring of one CPU in bytes, a multiple of any page size. */
+#define KTRACE_RING_SIZE  (64 * 1024)
+
+/** Tracepoints. */
+typedef enum {
+	/** IPC request sent, args: call, method, callee task. */
+	KTRACE_IPC_CALL,
+	/** IPC request answered, args: call, request method, return value. */
+	KTRACE_IPC_ANSWER,
+	/** IPC request forwarded, args: call, method, forward mode. */
+	KTRACE_IPC_FORWARD,
+	/** Thread scheduled, args: thread, task, priority. */
+	KTRACE_SCHED,
+	/** Page fault, args: address, access, program counter. */
+	KTRACE_PAGE_FAULT,
+
+	KTRACE_EVENT_COUNT
+} ktrace_event_t;
+
+/** One tracepoint hit. */
+typedef struct {
+	/** Cycle counter of the recording CPU. */
+	uint64_t timestamp;
+	/** Task running on the CPU. */
+	uint64_t task_id;
+	/** Event specific arguments. */
+	uint64_t arg[3];
+	/** Tracepoint, one of ktrace_event_t. */
+	uint32_t event;
+	/** CPU which recorded the event. */
+	uint32_t cpu;
+} ktrace_record_t;
+
+/** Ring of one CPU. */
+typedef struct {
+	/** Sequence number of the next record, written last. */
+	volatile uint64_t head;
+	/** Number of records in the ring. */
+	uint64_t capacity;
+	uint64_t reserved[2];
+	ktrace_record_t records[];
+} ktrace_ring_t;
+
+#endif
+
+/** @}
+ */
@@ -45,6 +45,14 @@ enum {
 	AS_AREA_CACHEABLE    = 0x08,
 	AS_AREA_GUARD        = 0x10,
 	AS_AREA_LATE_RESERVE = 0x20,
+	/** Map neighbouring pages which are cheap to map on a fault. */
+	AS_AREA_FAULT_AROUND = 0x40,
+	/** Map pages ahead of sequential faults. */
+	AS_AREA_PREFAULT     = 0x80,
+	/** Share as a private copy-on-write snapshot. */
+	AS_AREA_COW          = 0x100,
+	/** Combine writes to non-cacheable memory (e.g. a framebuffer). */
+	AS_AREA_WRITE_COMBINE = 0x200,
 };
 
 static void *const AS_AREA_ANY = (void *) -1;
@@ -63,6 +71,18 @@ typedef struct {
 	unsigned int flags;
 } as_area_info_t;
 
+/** Flags of a page supplied by a user pager.
+ *
+ * The pager returns them in ARG2 of its IPC_M_PAGE_IN answer.
+ */
+enum {
+	/**
+	 * The page is shared with the pager, which wants to be told about
+	 * writes to it (see IPC_M_PAGE_OUT and IPC_M_PAGE_RELEASE).
+	 */
+	AS_PAGER_WRITEBACK = 0x01,
+};
+
 typedef struct {
 	cap_phone_handle_t pager;
 	sysarg_t id1;
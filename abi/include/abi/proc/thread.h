@@ -39,6 +39,9 @@
 
 typedef uint64_t thread_id_t;
 
+/** Number of real-time thread priorities, higher values are more urgent */
+#define THREAD_RT_PRIORITIES  32
+
 /** Thread states */
 typedef enum {
 	/** It is an error, if thread is found in this state. */
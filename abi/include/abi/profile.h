@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup abi_generic
+ * @{
+ */
+/** @file Sampling profiler interface.
+ */
+
+#ifndef _ABI_PROFILE_H_
+#define _ABI_PROFILE_H_
+
+#include <stdint.h>
+#include <abi/proc/task.h>
+#include <abi/proc/thread.h>
+
+/** Maximum number of return addresses recorded in one sample. */
+#define PROFILE_MAX_DEPTH  32
+
+/** One sample of the profiler.
+ *
+ * The first kernel_depth entries of pc are kernel addresses, the
+ * innermost first, followed by the user space addresses of the thread.
+ */
+typedef struct {
+	/** Sampled task, 0 if the CPU was idle. */
+	task_id_t task_id;
+	/** Sampled thread, 0 if the CPU was idle. */
+	thread_id_t thread_id;
+	/** CPU which took the sample. */
+	uint32_t cpu;
+	/** Number of kernel addresses in pc. */
+	uint16_t kernel_depth;
+	/** Number of valid entries in pc. */
+	uint16_t depth;
+	uintptr_t pc[PROFILE_MAX_DEPTH];
+} profile_sample_t;
+
+/** Size of a kernel symbol name including the terminating NUL. */
+#define PROFILE_SYMBOL_NAME  64
+
+/** Entry of the kernel symbol table exported to user space.
+ *
+ * The table is sorted by address. It is mapped read-only from the
+ * physical address in the kernel.symtab.faddr sysinfo item, the
+ * kernel.symtab.pages and kernel.symtab.count items give its size.
+ */
+typedef struct {
+	/** Symbol address in little endian. */
+	uint64_t address_le;
+	/** NUL-terminated symbol name. */
+	char name[PROFILE_SYMBOL_NAME];
+} profile_symbol_t;
+
+#endif
+
+/** @}
+ */
@@ -51,6 +51,11 @@ enum {
 	SYNCH_FLAGS_FUTEX         = 1 << 2,
 };
 
+enum {
+	/** Wakeup count requesting all sleepers to be woken up. */
+	SYNCH_WAKEUP_ALL = -1,
+};
+
 #endif
 
 /** @}
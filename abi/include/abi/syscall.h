@@ -49,9 +49,13 @@ typedef enum {
 	SYS_THREAD_GET_ID,
 	SYS_THREAD_USLEEP,
 	SYS_THREAD_UDELAY,
+	SYS_THREAD_SET_AFFINITY,
+	SYS_THREAD_GET_AFFINITY,
+	SYS_THREAD_SET_RT,
 
 	SYS_TASK_GET_ID,
 	SYS_TASK_SET_NAME,
+	SYS_TASK_SET_NUMA,
 	SYS_TASK_KILL,
 	SYS_TASK_EXIT,
 	SYS_PROGRAM_SPAWN_LOADER,
@@ -60,6 +64,7 @@ typedef enum {
 	SYS_WAITQ_SLEEP,
 	SYS_WAITQ_WAKEUP,
 	SYS_WAITQ_DESTROY,
+	SYS_WAITQ_REQUEUE,
 	SYS_SMC_COHERENCE,
 
 	SYS_AS_AREA_CREATE,
@@ -67,20 +72,28 @@ typedef enum {
 	SYS_AS_AREA_CHANGE_FLAGS,
 	SYS_AS_AREA_GET_INFO,
 	SYS_AS_AREA_DESTROY,
+	SYS_AS_AREA_SYNC,
 
 	SYS_PAGE_FIND_MAPPING,
 
 	SYS_IPC_CALL_ASYNC_FAST,
 	SYS_IPC_CALL_ASYNC_SLOW,
+	SYS_IPC_CALL_ASYNC_BATCH,
 	SYS_IPC_ANSWER_FAST,
 	SYS_IPC_ANSWER_SLOW,
 	SYS_IPC_FORWARD_FAST,
 	SYS_IPC_FORWARD_SLOW,
 	SYS_IPC_WAIT,
+	SYS_IPC_WAIT_MULTI,
 	SYS_IPC_POKE,
 	SYS_IPC_HANGUP,
 	SYS_IPC_CONNECT_KBOX,
 
+	SYS_IPC_RING_CREATE,
+	SYS_IPC_RING_WAIT,
+	SYS_IPC_RING_NOTIFY,
+	SYS_IPC_RING_DESTROY,
+
 	SYS_IPC_EVENT_SUBSCRIBE,
 	SYS_IPC_EVENT_UNSUBSCRIBE,
 	SYS_IPC_EVENT_UNMASK,
@@ -97,6 +110,10 @@ typedef enum {
 
 	SYS_IPC_IRQ_SUBSCRIBE,
 	SYS_IPC_IRQ_UNSUBSCRIBE,
+	SYS_IRQ_MSI_ALLOC,
+	SYS_IRQ_MSI_FREE,
+	SYS_IRQ_AFFINITY_SET,
+	SYS_IRQ_AFFINITY_GET,
 
 	SYS_SYSINFO_GET_KEYS_SIZE,
 	SYS_SYSINFO_GET_KEYS,
@@ -107,6 +124,10 @@ typedef enum {
 
 	SYS_DEBUG_CONSOLE,
 
+	SYS_PROFILE_CTL,
+	SYS_PROFILE_READ,
+	SYS_PROFILE_SYMBOL,
+
 	SYS_KLOG
 } syscall_t;
 
@@ -39,6 +39,7 @@
 #include <stdbool.h>
 #include <abi/proc/task.h>
 #include <abi/proc/thread.h>
+#include <abi/mm/numa.h>
 #include <stdint.h>
 
 enum {
@@ -61,6 +62,28 @@ typedef enum {
 	SYSINFO_VAL_FUNCTION_DATA = 4  /**< Generated binary data */
 } sysinfo_item_val_type_t;
 
+/** Number of buckets of the latency histograms
+ *
+ * Bucket 0 counts waits shorter than 1 us, bucket i counts waits
+ * in the range of [2^(i-1), 2^i) us, the last bucket counts also
+ * all longer waits.
+ *
+ */
+#define STATS_LATENCY_BUCKETS  24
+
+/** Statistics about TLB shootdowns
+ *
+ */
+typedef struct {
+	uint64_t shootdowns;    /**< Number of TLB shootdown sequences */
+	uint64_t targeted;      /**< Number of CPUs sent shootdown messages */
+	uint64_t skipped;       /**< Number of CPUs spared from shootdowns */
+	uint64_t full_flushes;  /**< Ranges widened to a full flush */
+	uint64_t pages;         /**< Number of pages requested to invalidate */
+	uint64_t cycles;        /**< Cycles spent waiting for other CPUs */
+	uint64_t max_cycles;    /**< Longest wait for other CPUs */
+} stats_tlb_t;
+
 /** Statistics about a single CPU
  *
  */
@@ -70,6 +93,10 @@ typedef struct {
 	uint16_t frequency_mhz;  /**< Frequency in MHz */
 	uint64_t idle_cycles;    /**< Number of idle cycles */
 	uint64_t busy_cycles;    /**< Number of busy cycles */
+	uint64_t steal_count;    /**< Threads stolen by the CPU while idle */
+	uint64_t balance_count;  /**< Threads migrated by periodic balancing */
+	/** Run queue latency of threads dispatched by the CPU */
+	uint64_t rq_latency[STATS_LATENCY_BUCKETS];
 } stats_cpu_t;
 
 /** Physical memory statistics
@@ -80,8 +107,42 @@ typedef struct {
 	uint64_t unavail;  /**< Unavailable (reserved, firmware) bytes */
 	uint64_t used;     /**< Allocated physical memory (bytes) */
 	uint64_t free;     /**< Free physical memory (bytes) */
+	uint64_t cache_hits;    /**< Frames allocated from per-CPU caches */
+	uint64_t cache_misses;  /**< Refills of per-CPU frame caches */
+	uint64_t zero_pool;     /**< Pre-zeroed frames in the pool (bytes) */
+	uint64_t zero_hits;     /**< Zeroed frames taken from the pool */
+	uint64_t zero_misses;   /**< Zeroed frames which found the pool empty */
+	uint64_t reclaim_runs;   /**< Runs of the background reclaim */
+	uint64_t reclaim_freed;  /**< Bytes freed by the background reclaim */
+	unsigned int nodes;     /**< Number of NUMA nodes */
+	uint64_t node_busy[NUMA_NODES_MAX];  /**< Allocated bytes per node */
+	uint64_t node_free[NUMA_NODES_MAX];  /**< Free bytes per node */
 } stats_physmem_t;
 
+/** Size of the slab cache name buffer */
+#define STATS_SLAB_NAME_BUFLEN  32
+
+/** Slab cache statistics
+ *
+ */
+typedef struct {
+	char name[STATS_SLAB_NAME_BUFLEN];  /**< Cache name */
+	uint64_t size;        /**< Object size (bytes) */
+	uint64_t memory;      /**< Memory occupied by slabs (bytes) */
+	uint64_t slabs;       /**< Number of allocated slabs */
+	uint64_t objs;        /**< Number of allocated objects */
+	uint64_t cached;      /**< Free objects cached in magazines */
+	uint64_t peak;        /**< Highest number of allocated objects */
+	uint64_t allocs;      /**< Number of object allocations */
+	uint64_t frees;       /**< Number of object frees */
+	uint64_t mag_hits;    /**< Allocations served from CPU magazines */
+	uint64_t mag_misses;  /**< Allocations which missed CPU magazines */
+	uint64_t mag_gets;    /**< Full magazines taken from magazine list */
+	uint64_t mag_puts;    /**< Full magazines put to magazine list */
+	uint64_t grows;       /**< Slabs allocated from the frame allocator */
+	uint64_t reclaimed;   /**< Frames returned by slab reclaim */
+} stats_slab_t;
+
 /** IPC statistics
  *
  * Associated with a task.
@@ -94,6 +155,12 @@ typedef struct {
 	uint64_t answer_received;     /**< IPC answers received */
 	uint64_t irq_notif_received;  /**< IPC IRQ notifications */
 	uint64_t forwarded;           /**< IPC messages forwarded */
+	uint64_t data_copied;         /**< Data received via a kernel buffer */
+	uint64_t data_pinned;         /**< Data received via pinned frames */
+	uint64_t queue_depth;         /**< Requests received but not answered */
+	uint64_t queue_peak;          /**< Highest queue_depth so far */
+	/** Request-to-answer time of answered requests */
+	uint64_t answer_latency[STATS_LATENCY_BUCKETS];
 } stats_ipc_t;
 
 /** Statistics about a single task
@@ -104,10 +171,13 @@ typedef struct {
 	char name[TASK_NAME_BUFLEN];  /**< Task name (in kernel) */
 	size_t virtmem;               /**< Size of VAS (bytes) */
 	size_t resmem;                /**< Size of resident (used) memory (bytes) */
+	size_t large_pages;           /**< Number of large page mappings */
 	size_t threads;               /**< Number of threads */
 	uint64_t ucycles;             /**< Number of CPU cycles in user space */
 	uint64_t kcycles;             /**< Number of CPU cycles in kernel */
 	stats_ipc_t ipc_info;         /**< IPC statistics */
+	/** Run queue latency of the task's threads */
+	uint64_t rq_latency[STATS_LATENCY_BUCKETS];
 } stats_task_t;
 
 /** Statistics about a single thread
@@ -130,8 +200,29 @@ typedef struct {
 typedef struct {
 	task_id_t caller;  /**< Source task ID */
 	task_id_t callee;  /**< Target task ID */
+	uint64_t calls;    /**< Requests sent over the connection */
+	uint64_t answers;  /**< Answers received over the connection */
+	uint64_t active;   /**< Requests waiting for an answer */
 } stats_ipcc_t;
 
+/** Maximum length of a lock class name */
+#define STATS_LOCK_NAME_BUFLEN  64
+
+/** Contention statistics of a single lock class
+ *
+ * Only available in kernels built with CONFIG_LOCKSTAT.
+ *
+ */
+typedef struct {
+	char name[STATS_LOCK_NAME_BUFLEN];  /**< Lock name or mutex init site */
+	uint64_t acquired;                  /**< Number of acquisitions */
+	uint64_t contended;                 /**< Acquisitions which had to wait */
+	uint64_t wait_cycles;               /**< Cycles spent waiting */
+	uint64_t max_hold_cycles;           /**< Longest hold time (cycles) */
+	uint64_t spun;                      /**< Mutex waits ended by spinning */
+	uint64_t slept;                     /**< Mutex waits ended by sleeping */
+} stats_lock_t;
+
 /** Statistics about a single exception
  *
  */
@@ -146,6 +237,36 @@ typedef struct {
 /** Load fixed-point value */
 typedef uint32_t load_t;
 
+/** Header of incremental task or thread statistics
+ *
+ * Returned by system.tasks_delta.<generation> and
+ * system.threads_delta.<generation>. Followed by the IDs
+ * of all live tasks (threads) and then by the statistics of
+ * those which changed since the requested generation, both
+ * in the same order. Generation 0 requests all statistics.
+ *
+ */
+typedef struct {
+	uint64_t generation;  /**< Generation to request next time */
+	uint64_t count;       /**< Number of live tasks (threads) */
+	uint64_t changed;     /**< Number of changed tasks (threads) */
+} stats_delta_t;
+
+/** Statistics page shared read-only with user space
+ *
+ * The kernel refreshes the page every second. The sequence number
+ * is odd while the page is being updated, readers retry when it was
+ * odd or changed while they were copying the data.
+ *
+ */
+typedef struct {
+	volatile uint64_t seq;        /**< Update sequence number */
+	load_t load[LOAD_STEPS];      /**< System load */
+	stats_physmem_t physmem;      /**< Physical memory statistics */
+	uint64_t cpu_count;           /**< Number of CPUs */
+	stats_cpu_t cpus[];           /**< Statistics of all CPUs */
+} stats_page_t;
+
 #endif
 
 /** @}
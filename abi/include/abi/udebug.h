@@ -150,7 +150,15 @@ typedef enum { /* udebug_method_t */
 	 * - ARG4 - size of receiving buffer in bytes
 	 *
 	 */
-	UDEBUG_M_MEM_READ
+	UDEBUG_M_MEM_READ,
+
+	/** Write one word of the debugged task's memory.
+	 *
+	 * - ARG2 - destination address in the recipient's address space
+	 * - ARG3 - value to write
+	 *
+	 */
+	UDEBUG_M_WORD_WRITE
 } udebug_method_t;
 
 typedef enum {
@@ -31,12 +31,14 @@
  * @brief Implementation of inflate decompression
  *
  * A simple inflate implementation (decompression of `deflate' stream as
- * described by RFC 1951) based on puff.c by Mark Adler. It is not optimized
- * for speed but for readability as it is used as part of the bootloader and
- * any miss-optimization might be hard to debug.
+ * described by RFC 1951) based on puff.c by Mark Adler. Unlike puff.c,
+ * Huffman codes are decoded by table lookup (as in zlib) rather than bit
+ * by bit, and input is read into the bit buffer a word at a time.
  *
  * All dynamically allocated memory memory is taken from the stack. The
- * stack usage should be typically bounded by 2 KB.
+ * stack usage should be typically bounded by 2 KB. Boot stacks are small,
+ * so the Huffman lookup tables are static (the bootloader runs a single
+ * thread of execution).
  *
  * Original copyright notice:
  *
@@ -69,6 +71,7 @@
 #include <stdint.h>
 #include <errno.h>
 #include <memstr.h>
+#include <byteorder.h>
 #include <inflate.h>
 
 /** Maximum bits in the Huffman code */
@@ -88,6 +91,25 @@
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
+/** Index bits of the primary literal/length lookup table */
+#define LITLEN_ROOT  9
+/** Index bits of the primary distance lookup table */
+#define DIST_ROOT    6
+/** Index bits of the code length lookup table (no subtables needed) */
+#define ORDER_ROOT   7
+
+/** Maximum literal/length lookup table size including subtables
+ *
+ * The bounds are those computed by the `enough' utility of zlib
+ * for the respective number of symbols, root bits and maximum code
+ * length.
+ */
+#define ENOUGH_LITLEN  852
+/** Maximum distance lookup table size including subtables */
+#define ENOUGH_DIST    592
+/** Code length lookup table size */
+#define ENOUGH_ORDER   (1 << ORDER_ROOT)
+
 /** Check for input buffer overrun condition */
 #define CHECK_OVERRUN(state) \
 	do { \
@@ -107,20 +129,36 @@ typedef struct {
 	size_t srclen;    /**< Input buffer size */
 	size_t srccnt;    /**< Position in the input buffer */
 
-	uint16_t bitbuf;  /**< Bit buffer */
+	uint64_t bitbuf;  /**< Bit buffer */
 	size_t bitlen;    /**< Number of bits in the bit buffer */
 
 	bool overrun;     /**< Overrun condition */
 } inflate_state_t;
 
+/** Huffman lookup table entry
+ *
+ * An entry in the primary table either decodes a code of at most
+ * root bits directly or links to a subtable indexed by the bits
+ * following the first root bits.
+ *
+ */
+typedef struct {
+	uint16_t value;  /**< Symbol or subtable offset */
+	uint8_t len;     /**< Number of code bits to consume, 0 if invalid */
+	uint8_t sub;     /**< Subtable index bits, 0 if not a link */
+} huffman_entry_t;
+
 /** Huffman code description
  *
  */
 typedef struct {
-	uint16_t *count;   /**< Array of symbol counts */
-	uint16_t *symbol;  /**< Array of symbols */
+	uint16_t *count;         /**< Array of symbol counts */
+	uint16_t *symbol;        /**< Array of symbols */
+	huffman_entry_t *table;  /**< Lookup table */
+	size_t root;             /**< Index bits of the primary table */
 } huffman_t;
 
+
 /** Length codes
  *
  */
@@ -227,6 +265,47 @@ static huffman_t dist_code = {
 	.symbol = dist_symbol
 };
 
+/** Literal/length lookup table */
+static huffman_entry_t len_table[ENOUGH_LITLEN];
+
+/** Distance lookup table */
+static huffman_entry_t dist_table[ENOUGH_DIST];
+
+/** Refill the bit buffer
+ *
+ * Load as many whole bytes as fit into the bit buffer. Unless the end
+ * of input is near, this is done with a single 64-bit load. Afterwards
+ * the buffer holds at least 56 bits or all the remaining input.
+ *
+ * @param state Inflate state.
+ *
+ */
+static inline void bits_refill(inflate_state_t *state)
+{
+	uint64_t word;
+	size_t cnt;
+
+	if (state->srclen - state->srccnt >= sizeof(uint64_t)) {
+		memcpy(&word, state->src + state->srccnt, sizeof(uint64_t));
+		word = uint64_t_le2host(word);
+
+		cnt = (63 - state->bitlen) >> 3;
+		word &= ((uint64_t) 1 << (cnt << 3)) - 1;
+
+		state->bitbuf |= word << state->bitlen;
+		state->srccnt += cnt;
+		state->bitlen += cnt << 3;
+		return;
+	}
+
+	while (state->bitlen <= 56 && state->srccnt < state->srclen) {
+		state->bitbuf |=
+		    ((uint64_t) state->src[state->srccnt]) << state->bitlen;
+		state->srccnt++;
+		state->bitlen += 8;
+	}
+}
+
 /** Get bits from the bit buffer
  *
  * @param state Inflate state.
@@ -237,26 +316,23 @@ static huffman_t dist_code = {
  */
 static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
 {
-	/* Bit accumulator for at least 20 bits */
-	uint32_t val = state->bitbuf;
+	uint16_t val;
 
-	while (state->bitlen < cnt) {
-		if (state->srccnt == state->srclen) {
+	if (state->bitlen < cnt) {
+		bits_refill(state);
+		if (state->bitlen < cnt) {
 			state->overrun = true;
 			return 0;
 		}
-
-		/* Load 8 more bits */
-		val |= ((uint32_t) state->src[state->srccnt]) << state->bitlen;
-		state->srccnt++;
-		state->bitlen += 8;
 	}
 
+	val = (uint16_t) (state->bitbuf & ((1 << cnt) - 1));
+
 	/* Update bits in the buffer */
-	state->bitbuf = (uint16_t) (val >> cnt);
+	state->bitbuf >>= cnt;
 	state->bitlen -= cnt;
 
-	return ((uint16_t) (val & ((1 << cnt) - 1)));
+	return val;
 }
 
 /** Decode `stored' block
@@ -271,7 +347,11 @@ static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
  */
 static int inflate_stored(inflate_state_t *state)
 {
-	/* Discard bits in the bit buffer */
+	/*
+	 * Discard bits up to the byte boundary and give back the whole
+	 * bytes the bit buffer has read ahead.
+	 */
+	state->srccnt -= state->bitlen >> 3;
 	state->bitbuf = 0;
 	state->bitlen = 0;
 
@@ -313,46 +393,199 @@ static int inflate_stored(inflate_state_t *state)
  *
  * @param EOK on success.
  * @param EINVAL on invalid Huffman code.
+ * @param ELIMIT on input buffer overrun.
  *
  */
-static int huffman_decode(inflate_state_t *state, huffman_t *huffman,
-    uint16_t *symbol)
+static inline int huffman_decode(inflate_state_t *state,
+    huffman_t *huffman, uint16_t *symbol)
 {
-	/* Decode bits */
-	uint16_t code = 0;
+	huffman_entry_t entry;
+	size_t used = 0;
+
+	if (state->bitlen < MAX_HUFFMAN_BIT)
+		bits_refill(state);
+
+	/* Missing bits at the end of input read as zeros */
+	entry = huffman->table[state->bitbuf & ((1 << huffman->root) - 1)];
+	if (entry.sub != 0) {
+		used = huffman->root;
+		entry = huffman->table[entry.value +
+		    ((state->bitbuf >> used) & ((1 << entry.sub) - 1))];
+	}
 
-	/* First code of the given length */
-	size_t first = 0;
+	used += entry.len;
+	if (entry.len == 0 || used > state->bitlen) {
+		if (state->bitlen < MAX_HUFFMAN_BIT) {
+			state->overrun = true;
+			return ELIMIT;
+		}
 
-	/*
-	 * Index of the first code of the given length
-	 * in the symbol table
-	 */
-	size_t index = 0;
+		return EINVAL;
+	}
 
-	/* Current number of bits in the code */
+	state->bitbuf >>= used;
+	state->bitlen -= used;
+
+	*symbol = entry.value;
+	return EOK;
+}
+
+/** Reverse bits of a Huffman code
+ *
+ * Huffman codes are packed starting with the most significant bit,
+ * other data starting with the least significant bit.
+ *
+ * @param code Code.
+ * @param len  Length of the code in bits.
+ *
+ * @return Code with bits in reverse order.
+ *
+ */
+static size_t huffman_reverse(size_t code, size_t len)
+{
+	size_t rev = 0;
+
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
+	}
+
+	return rev;
+}
+
+/** Build Huffman lookup table
+ *
+ * Codes of at most root bits get all their primary table entries filled
+ * in, longer codes are placed in subtables. Codes sharing their first
+ * root bits share one subtable, which is made just large enough to hold
+ * them (the same way zlib does it).
+ *
+ * @param huffman Huffman code with counts and symbols already set up.
+ * @param size    Size of the lookup table.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the lookup table is too small.
+ *
+ */
+static int huffman_table(huffman_t *huffman, size_t size)
+{
+	huffman_entry_t *table = huffman->table;
+	uint16_t left[MAX_HUFFMAN_BIT + 1];
+	size_t root = huffman->root;
+	size_t mask = (1 << root) - 1;
+	size_t next = 1 << root;
+	size_t low = (size_t) -1;
+	size_t sub_base = 0;
+	size_t sub_bits = 0;
+	size_t index = 0;
+	size_t code = 0;
 	size_t len;
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < next; i++)
+		table[i] = (huffman_entry_t) { 0, 0, 0 };
+
+	for (len = 0; len <= MAX_HUFFMAN_BIT; len++)
+		left[len] = huffman->count[len];
 
 	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
-		/* Get next bit */
-		code |= get_bits(state, 1);
-		CHECK_OVERRUN(*state);
+		for (i = 0; i < huffman->count[len]; i++) {
+			uint16_t symbol = huffman->symbol[index];
+			size_t rev = huffman_reverse(code, len);
+
+			index++;
+			code++;
+
+			if (len <= root) {
+				for (j = rev; j <= mask; j += (size_t) 1 << len)
+					table[j] = (huffman_entry_t) { symbol, len, 0 };
+				continue;
+			}
+
+			if ((rev & mask) != low) {
+				/*
+				 * Start a new subtable. Grow it until it can
+				 * hold all remaining codes with this prefix.
+				 */
+				size_t curr = len - root;
+				int slots = 1 << curr;
 
-		uint16_t count = huffman->count[len];
-		if (code < first + count) {
-			/* Return decoded symbol */
-			*symbol = huffman->symbol[index + code - first];
-			return EOK;
+				while (curr + root < MAX_HUFFMAN_BIT) {
+					slots -= left[curr + root];
+					if (slots <= 0)
+						break;
+
+					curr++;
+					slots <<= 1;
+				}
+
+				if (next + ((size_t) 1 << curr) > size)
+					return EINVAL;
+
+				low = rev & mask;
+				sub_base = next;
+				sub_bits = curr;
+				next += (size_t) 1 << curr;
+
+				for (j = sub_base; j < next; j++)
+					table[j] = (huffman_entry_t) { 0, 0, 0 };
+
+				table[low] = (huffman_entry_t) {
+					sub_base, root, sub_bits
+				};
+			}
+
+			for (j = rev >> root; j < ((size_t) 1 << sub_bits);
+			    j += (size_t) 1 << (len - root)) {
+				table[sub_base + j] =
+				    (huffman_entry_t) { symbol, len - root, 0 };
+			}
+
+			left[len]--;
 		}
 
-		/* Update for next length */
-		index += count;
-		first += count;
-		first <<= 1;
 		code <<= 1;
 	}
 
-	return EINVAL;
+	return EOK;
+}
+
+/** Copy back reference
+ *
+ * @param out  Output position.
+ * @param dist Distance back (at least 1).
+ * @param len  Number of bytes to copy.
+ *
+ */
+static inline void inflate_copy(uint8_t *out, size_t dist, size_t len)
+{
+	const uint8_t *from = out - dist;
+
+	if (dist >= len) {
+		memcpy(out, from, len);
+		return;
+	}
+
+	/*
+	 * Source and destination overlap, so bytes just written are read
+	 * again. Copy byte by byte, four at a time.
+	 */
+	while (len >= 4) {
+		out[0] = from[0];
+		out[1] = from[1];
+		out[2] = from[2];
+		out[3] = from[3];
+		out += 4;
+		from += 4;
+		len -= 4;
+	}
+
+	while (len > 0) {
+		*out++ = *from++;
+		len--;
+	}
 }
 
 /** Construct Huffman tables from canonical Huffman code
@@ -431,7 +664,7 @@ static int inflate_codes(inflate_state_t *state, huffman_t *len_code,
 {
 	uint16_t symbol;
 
-	do {
+	while (true) {
 		int err = huffman_decode(state, len_code, &symbol);
 		if (err != EOK) {
 			/* Error decoding */
@@ -445,36 +678,38 @@ static int inflate_codes(inflate_state_t *state, huffman_t *len_code,
 
 			state->dest[state->destcnt] = (uint8_t) symbol;
 			state->destcnt++;
-		} else if (symbol > 256) {
-			/* Compute length */
-			symbol -= 257;
-			if (symbol >= 29)
-				return EINVAL;
+			continue;
+		}
 
-			size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
-			CHECK_OVERRUN(*state);
+		if (symbol == 256)
+			break;
 
-			/* Get distance */
-			err = huffman_decode(state, dist_code, &symbol);
-			if (err != EOK)
-				return err;
+		/* Compute length */
+		symbol -= 257;
+		if (symbol >= 29)
+			return EINVAL;
 
-			size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
-			if (dist > state->destcnt)
-				return ENOENT;
+		size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
+		CHECK_OVERRUN(*state);
 
-			if (state->destcnt + len > state->destlen)
-				return ENOMEM;
+		/* Get distance */
+		err = huffman_decode(state, dist_code, &symbol);
+		if (err != EOK)
+			return err;
 
-			while (len > 0) {
-				/* Copy len bytes from distance bytes back */
-				state->dest[state->destcnt] =
-				    state->dest[state->destcnt - dist];
-				state->destcnt++;
-				len--;
-			}
-		}
-	} while (symbol != 256);
+		size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
+		CHECK_OVERRUN(*state);
+
+		if (dist > state->destcnt)
+			return ENOENT;
+
+		if (state->destcnt + len > state->destlen)
+			return ENOMEM;
+
+		/* Copy len bytes from distance bytes back */
+		inflate_copy(state->dest + state->destcnt, dist, len);
+		state->destcnt += len;
+	}
 
 	return EOK;
 }
@@ -495,7 +730,24 @@ static int inflate_codes(inflate_state_t *state, huffman_t *len_code,
 static int inflate_fixed(inflate_state_t *state, huffman_t *len_code,
     huffman_t *dist_code)
 {
-	return inflate_codes(state, len_code, dist_code);
+	huffman_t fix_len_code = *len_code;
+	huffman_t fix_dist_code = *dist_code;
+	int rc;
+
+	/* All fixed codes fit in the primary tables */
+	fix_len_code.table = len_table;
+	fix_len_code.root = LITLEN_ROOT;
+	rc = huffman_table(&fix_len_code, 1 << LITLEN_ROOT);
+	if (rc != EOK)
+		return rc;
+
+	fix_dist_code.table = dist_table;
+	fix_dist_code.root = DIST_ROOT;
+	rc = huffman_table(&fix_dist_code, 1 << DIST_ROOT);
+	if (rc != EOK)
+		return rc;
+
+	return inflate_codes(state, &fix_len_code, &fix_dist_code);
 }
 
 /** Decode `dynamic codes' block
@@ -521,9 +773,12 @@ static int inflate_dynamic(inflate_state_t *state)
 
 	dyn_len_code.count = dyn_len_count;
 	dyn_len_code.symbol = dyn_len_symbol;
+	dyn_len_code.table = len_table;
 
 	dyn_dist_code.count = dyn_dist_count;
 	dyn_dist_code.symbol = dyn_dist_symbol;
+	dyn_dist_code.table = dist_table;
+	dyn_dist_code.root = DIST_ROOT;
 
 	/* Get number of bits in each table */
 	uint16_t nlen = get_bits(state, 5) + 257;
@@ -555,13 +810,19 @@ static int inflate_dynamic(inflate_state_t *state)
 	if (rc != 0)
 		return EINVAL;
 
+	/* Code lengths are at most 7 bits, all fit in the primary table */
+	dyn_len_code.root = ORDER_ROOT;
+	int err = huffman_table(&dyn_len_code, ENOUGH_ORDER);
+	if (err != EOK)
+		return err;
+
 	/* Read length/literal and distance code length tables */
 	index = 0;
 	while (index < nlen + ndist) {
 		uint16_t symbol;
-		int err = huffman_decode(state, &dyn_len_code, &symbol);
+		err = huffman_decode(state, &dyn_len_code, &symbol);
 		if (err != EOK)
-			return EOK;
+			return err;
 
 		if (symbol < 16) {
 			length[index] = symbol;
@@ -604,11 +865,20 @@ static int inflate_dynamic(inflate_state_t *state)
 	if ((rc < 0) || ((rc > 0) && (dyn_len_code.count[0] + 1 != nlen)))
 		return EINVAL;
 
+	dyn_len_code.root = LITLEN_ROOT;
+	err = huffman_table(&dyn_len_code, ENOUGH_LITLEN);
+	if (err != EOK)
+		return err;
+
 	/* Build Huffman tables for distance codes */
 	rc = huffman_construct(&dyn_dist_code, length + nlen, ndist);
 	if ((rc < 0) || ((rc > 0) && (dyn_dist_code.count[0] + 1 != ndist)))
 		return EINVAL;
 
+	err = huffman_table(&dyn_dist_code, ENOUGH_DIST);
+	if (err != EOK)
+		return err;
+
 	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
 }
 
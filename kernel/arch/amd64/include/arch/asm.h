@@ -312,6 +312,28 @@ _NO_TRACE static inline void invlpg(uintptr_t addr)
 	);
 }
 
+/** Invalidate TLB entries tagged by process-context identifiers.
+ *
+ * @param type Type of the invalidation (INVPCID_*).
+ * @param pcid Process-context identifier.
+ * @param addr Linear address for INVPCID_ADDRESS.
+ *
+ */
+_NO_TRACE static inline void invpcid(uint64_t type, uint64_t pcid,
+    uintptr_t addr)
+{
+	struct {
+		uint64_t pcid;
+		uint64_t addr;
+	} desc = { pcid, addr };
+
+	asm volatile (
+	    "invpcid %[desc], %[type]\n"
+	    :: [desc] "m" (desc), [type] "r" (type)
+	    : "memory"
+	);
+}
+
 /** Load GDTR register from memory.
  *
  * @param gdtr_reg Address of memory from where to load GDTR.
@@ -473,6 +495,11 @@ extern uintptr_t int_63;
 
 extern void enable_l_apic_in_msr(void);
 
+/** memset() and memcpy() are provided by arch/amd64/src/memfnc.c. */
+#define ARCH_HAS_MEMFNC
+
+extern void memfnc_init(void);
+
 #endif
 
 /** @}
@@ -57,7 +57,9 @@
 #define CR0_PG		(1 << 31)
 
 #define CR4_PAE		(1 << 5)
+#define CR4_PGE		(1 << 7)
 #define CR4_OSFXSR	(1 << 9)
+#define CR4_PCIDE	(1 << 17)
 
 /* EFER bits */
 #define AMD_SCE		(1 << 0)
@@ -70,6 +72,7 @@
 
 /* MSR registers */
 #define AMD_MSR_APIC_BASE	0x0000001b
+#define AMD_MSR_PAT		0x00000277
 #define AMD_MSR_EFER		0xc0000080
 #define AMD_MSR_STAR		0xc0000081
 #define AMD_MSR_LSTAR		0xc0000082
@@ -91,6 +94,13 @@ typedef struct {
 
 	unsigned int id; /** CPU's local, ie physical, APIC ID. */
 
+	uint32_t timer_period;   /** Local APIC timer counts per clock tick. */
+	uint32_t timer_oneshot;  /** Counts programmed for a stopped tick. */
+
+	bool mwait;  /** MONITOR/MWAIT instructions are supported. */
+	bool pcid;  /** Process-context identifiers are supported. */
+	bool invpcid;  /** INVPCID instruction is supported. */
+
 	size_t iomapver_copy;  /** Copy of TASK's I/O Permission bitmap generation count. */
 } cpu_arch_t;
 
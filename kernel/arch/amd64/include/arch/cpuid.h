@@ -39,11 +39,21 @@
 #define AMD_EXT_NOEXECUTE   20
 #define AMD_EXT_LONG_MODE   29
 
+#define AMD_CPUID_CACHE          0x80000006
+#define AMD_CPUID_ADDRESS_SIZES  0x80000008
+
 #define INTEL_CPUID_LEVEL     0x00000000
 #define INTEL_CPUID_STANDARD  0x00000001
+#define INTEL_CPUID_CACHE     0x00000004
+#define INTEL_CPUID_FEATURES  0x00000007
 #define INTEL_CPUID_EXTENDED  0x80000000
 #define INTEL_SSE2            26
+#define INTEL_MONITOR         3
 #define INTEL_FXSAVE          24
+#define INTEL_HTT             28
+#define INTEL_PCID            17
+#define INTEL_INVPCID         10
+#define INTEL_ERMS            9
 
 #ifndef __ASSEMBLER__
 
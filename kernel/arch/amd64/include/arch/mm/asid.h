@@ -1 +0,0 @@
-../../../../ia32/include/arch/mm/asid.h
\ No newline at end of file
@@ -40,11 +40,15 @@
 
 #define FRAME_LOWPRIO  0x1000
 
+/** Zero a frame without polluting the caches. */
+#define FRAME_ZERO_ARCH(addr)  frame_zero_nt((void *) (addr))
+
 #ifndef __ASSEMBLER__
 
 extern void frame_low_arch_init(void);
 extern void frame_high_arch_init(void);
 extern void physmem_print(void);
+extern void frame_zero_nt(void *);
 
 #endif /* __ASSEMBLER__ */
 
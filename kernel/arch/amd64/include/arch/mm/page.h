@@ -108,6 +108,8 @@
 /* Set PTE address accessors for each level. */
 #define SET_PTL0_ADDRESS_ARCH(ptl0) \
 	(write_cr3((uintptr_t) (ptl0)))
+#define SET_PTL0_ADDRESS_ASID_ARCH(ptl0, asid) \
+	(write_cr3_asid((uintptr_t) (ptl0), (asid)))
 #define SET_PTL1_ADDRESS_ARCH(ptl0, i, a) \
 	set_pt_addr((pte_t *) (ptl0), (size_t) (i), a)
 #define SET_PTL2_ADDRESS_ARCH(ptl1, i, a) \
@@ -160,9 +162,20 @@
 #define PTE_EXECUTABLE_ARCH(p) \
 	((p)->no_execute == 0)
 
+/* Large pages mapped directly by a PTL2 entry. */
+#define LARGE_PAGE_WIDTH_ARCH  21
+
+#define PTL3_LARGE_ARCH(ptl2, i) \
+	(((pte_t *) (ptl2))[(i)].page_size != 0)
+#define SET_PTL3_LARGE_ARCH(ptl2, i, large) \
+	(((pte_t *) (ptl2))[(i)].page_size = ((large) ? 1 : 0))
+#define SET_PTL3_ENTRY_ARCH(ptl2, i, p) \
+	set_pt_entry((pte_t *) (ptl2), (size_t) (i), (p))
+
 #ifndef __ASSEMBLER__
 
 #include <arch/interrupt.h>
+#include <arch/mm/tlb.h>
 #include <mm/mm.h>
 #include <trace.h>
 #include <typedefs.h>
@@ -197,7 +210,7 @@ typedef struct {
 	unsigned int page_cache_disable : 1;
 	unsigned int accessed : 1;
 	unsigned int dirty : 1;
-	unsigned int unused : 1;
+	unsigned int page_size : 1;  /**< Large page in PTL2 entries. */
 	unsigned int global : 1;
 	unsigned int soft_valid : 1;  /**< Valid content even if present bit is cleared. */
 	unsigned int avl : 2;
@@ -210,7 +223,10 @@ _NO_TRACE static inline unsigned int get_pt_flags(pte_t *pt, size_t i)
 {
 	pte_t *p = &pt[i];
 
-	return ((!p->page_cache_disable) << PAGE_CACHEABLE_SHIFT |
+	return ((!p->page_cache_disable && !p->page_write_through) <<
+	    PAGE_CACHEABLE_SHIFT |
+	    (!p->page_cache_disable && p->page_write_through) <<
+	    PAGE_WRITE_COMBINE_SHIFT |
 	    (!p->present) << PAGE_PRESENT_SHIFT |
 	    p->uaccessible << PAGE_USER_SHIFT |
 	    1 << PAGE_READ_SHIFT |
@@ -231,7 +247,17 @@ _NO_TRACE static inline void set_pt_flags(pte_t *pt, size_t i, int flags)
 {
 	pte_t *p = &pt[i];
 
-	p->page_cache_disable = !(flags & PAGE_CACHEABLE);
+	if (flags & PAGE_CACHEABLE) {
+		p->page_cache_disable = 0;
+		p->page_write_through = 0;
+	} else if (flags & PAGE_WRITE_COMBINE) {
+		/* PAT entry 1, programmed as write-combining */
+		p->page_cache_disable = 0;
+		p->page_write_through = 1;
+	} else {
+		p->page_cache_disable = 1;
+		p->page_write_through = 0;
+	}
 	p->present = !(flags & PAGE_NOT_PRESENT);
 	p->uaccessible = (flags & PAGE_USER) != 0;
 	p->writeable = (flags & PAGE_WRITE) != 0;
@@ -244,6 +270,16 @@ _NO_TRACE static inline void set_pt_flags(pte_t *pt, size_t i, int flags)
 	p->soft_valid = 1;
 }
 
+/** Replace a page table entry with a single store.
+ *
+ * Used when a hardware page table walk must not observe a partially
+ * updated entry.
+ */
+_NO_TRACE static inline void set_pt_entry(pte_t *pt, size_t i, pte_t *p)
+{
+	*((volatile uint64_t *) &pt[i]) = *((uint64_t *) p);
+}
+
 _NO_TRACE static inline void set_pt_present(pte_t *pt, size_t i)
 {
 	pte_t *p = &pt[i];
@@ -35,6 +35,27 @@
 #ifndef KERN_amd64_TLB_H_
 #define KERN_amd64_TLB_H_
 
+#include <arch/mm/asid.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* INVPCID invalidation types */
+#define INVPCID_ADDRESS     0  /**< One address in one context */
+#define INVPCID_CONTEXT     1  /**< All addresses in one context */
+#define INVPCID_ALL_GLOBAL  2  /**< All contexts including global entries */
+#define INVPCID_ALL         3  /**< All contexts except global entries */
+
+/** CR3 bits holding the PCID. */
+#define CR3_PCID_MASK  UINT64_C(0xfff)
+
+/** Do not invalidate the TLB entries of the PCID when loading CR3. */
+#define CR3_NOFLUSH  (UINT64_C(1) << 63)
+
+extern bool pcid_enabled;
+
+extern void pcid_init(void);
+extern void write_cr3_asid(uintptr_t, asid_t);
+
 #endif
 
 /** @}
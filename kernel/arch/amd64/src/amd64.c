@@ -116,6 +116,7 @@ void amd64_pre_mm_init(void)
 	write_cr0(read_cr0() & ~CR0_AM);
 
 	if (config.cpu_active == 1) {
+		memfnc_init();
 		interrupt_init();
 		bios_init();
 
@@ -135,7 +136,7 @@ void amd64_post_mm_init(void)
 
 	if (config.cpu_active == 1) {
 		/* Initialize IRQ routing */
-		irq_init(IRQ_COUNT, IRQ_COUNT);
+		irq_init(IRQ_COUNT + MSI_COUNT, IRQ_COUNT + MSI_COUNT);
 
 		/* hard clock */
 		i8254_init();
@@ -36,8 +36,10 @@
 #include <arch/cpu.h>
 #include <arch/cpuid.h>
 #include <arch/pm.h>
+#include <arch/mm/tlb.h>
 
 #include <arch.h>
+#include <bitops.h>
 #include <stdio.h>
 #include <fpu_context.h>
 
@@ -99,6 +101,61 @@ void cpu_arch_init(void)
 	CPU->arch.tss->iomap_base = &CPU->arch.tss->iomap[0] -
 	    ((uint8_t *) CPU->arch.tss);
 	CPU->fpu_owner = NULL;
+
+	pcid_init();
+}
+
+/** Number of bits needed to represent values 0 .. count - 1. */
+static unsigned int id_bits(unsigned int count)
+{
+	return (count > 1) ? fnzb32(count - 1) + 1 : 0;
+}
+
+/** Find the position of the CPU in the processor topology.
+ *
+ * The initial APIC ID is composed of the SMT, core and package
+ * fields. Their widths are derived from the number of logical
+ * processors and cores per package. The last-level cache is
+ * assumed to be shared by the whole package.
+ *
+ * @param max_level Highest supported standard CPUID leaf.
+ *
+ */
+static void cpu_identify_topology(uint32_t max_level)
+{
+	cpu_info_t info;
+
+	cpuid(INTEL_CPUID_STANDARD, &info);
+	if (!(info.cpuid_edx & (1 << INTEL_HTT)))
+		return;
+
+	unsigned int apic_id = info.cpuid_ebx >> 24;
+	unsigned int logical = (info.cpuid_ebx >> 16) & 0xff;
+	unsigned int cores = 1;
+
+	if ((CPU->arch.vendor == VendorIntel) &&
+	    (max_level >= INTEL_CPUID_CACHE)) {
+		cpuid(INTEL_CPUID_CACHE, &info);
+		cores = (info.cpuid_eax >> 26) + 1;
+	} else if (CPU->arch.vendor == VendorAMD) {
+		cpuid(INTEL_CPUID_EXTENDED, &info);
+		if (info.cpuid_eax >= AMD_CPUID_ADDRESS_SIZES) {
+			cpuid(AMD_CPUID_ADDRESS_SIZES, &info);
+			cores = (info.cpuid_ecx & 0xff) + 1;
+		}
+	}
+
+	if (logical == 0)
+		logical = 1;
+	if (cores > logical)
+		cores = logical;
+
+	unsigned int smt_bits = id_bits(logical / cores);
+	unsigned int core_bits = id_bits(cores);
+
+	CPU->topology.package = apic_id >> (smt_bits + core_bits);
+	CPU->topology.core = apic_id >> smt_bits;
+	CPU->topology.llc = 0;
 }
 
 void cpu_identify(void)
@@ -106,8 +163,11 @@ void cpu_identify(void)
 	cpu_info_t info;
 
 	CPU->arch.vendor = VendorUnknown;
+	CPU->arch.pcid = false;
+	CPU->arch.invpcid = false;
 	if (has_cpuid()) {
 		cpuid(INTEL_CPUID_LEVEL, &info);
+		uint32_t max_level = info.cpuid_eax;
 
 		/*
 		 * Check for AMD processor.
@@ -131,14 +191,66 @@ void cpu_identify(void)
 		CPU->arch.family = (info.cpuid_eax >> 8) & 0xf;
 		CPU->arch.model = (info.cpuid_eax >> 4) & 0xf;
 		CPU->arch.stepping = (info.cpuid_eax >> 0) & 0xf;
+		CPU->arch.mwait = (info.cpuid_ecx & (1 << INTEL_MONITOR)) != 0;
+		CPU->arch.pcid = (info.cpuid_ecx & (1 << INTEL_PCID)) != 0;
+
+		if (max_level >= INTEL_CPUID_FEATURES) {
+			cpuid(INTEL_CPUID_FEATURES, &info);
+			CPU->arch.invpcid =
+			    (info.cpuid_ebx & (1 << INTEL_INVPCID)) != 0;
+		}
+
+		cpu_identify_topology(max_level);
 	}
 }
 
+#ifdef CONFIG_IDLE_POLL
+
+/** Arm address monitoring for idle_mwait_arch().
+ *
+ * @param addr Address to monitor.
+ *
+ * @return False if the CPU does not support MONITOR/MWAIT.
+ *
+ */
+bool idle_monitor_arch(const volatile void *addr)
+{
+	if (!CPU->arch.mwait)
+		return false;
+
+	asm volatile (
+	    "monitor\n"
+	    :: "a" (addr), "c" (0), "d" (0)
+	    : "memory"
+	);
+
+	return true;
+}
+
+/** Enable interrupts and wait for a write to the monitored address.
+ *
+ * The STI shadow guarantees that no interrupt is taken between enabling
+ * interrupts and MWAIT, an interrupt ends the wait as well.
+ *
+ */
+void idle_mwait_arch(void)
+{
+	asm volatile (
+	    "sti\n"
+	    "mwait\n"
+	    :: "a" (0), "c" (0)
+	    : "memory"
+	);
+}
+
+#endif /* CONFIG_IDLE_POLL */
+
 void cpu_print_report(cpu_t *m)
 {
-	printf("cpu%d: (%s family=%d model=%d stepping=%d apicid=%u) %dMHz\n",
-	    m->id, vendor_str[m->arch.vendor], m->arch.family, m->arch.model,
-	    m->arch.stepping, m->arch.id, m->frequency_mhz);
+	printf("cpu%d: (%s family=%d model=%d stepping=%d apicid=%u "
+	    "package=%u core=%u) %dMHz\n", m->id, vendor_str[m->arch.vendor],
+	    m->arch.family, m->arch.model, m->arch.stepping, m->arch.id,
+	    m->topology.package, m->topology.core, m->frequency_mhz);
 }
 
 /** @}
@@ -147,6 +147,16 @@ static void tlb_shootdown_ipi(unsigned int n, istate_t *istate)
 	pic_ops->eoi(0);
 	tlb_shootdown_ipi_recv();
 }
+
+/** Wakeup IPI handler.
+ *
+ * The IPI only needs to interrupt cpu_sleep(), the stopped tick is
+ * restarted in exc_dispatch().
+ */
+static void wakeup_ipi(unsigned int n, istate_t *istate)
+{
+	pic_ops->eoi(0);
+}
 #endif
 
 /** Handler of IRQ exceptions.
@@ -226,6 +236,8 @@ void interrupt_init(void)
 #ifdef CONFIG_SMP
 	exc_register(VECTOR_TLB_SHOOTDOWN_IPI, "tlb_shootdown", true,
 	    (iroutine_t) tlb_shootdown_ipi);
+	exc_register(VECTOR_WAKEUP_IPI, "wakeup", true,
+	    (iroutine_t) wakeup_ipi);
 #endif
 }
 
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_amd64
+ * @{
+ */
+/**
+ * @file
+ * @brief Memory string functions optimized for amd64.
+ *
+ * Copies and fills use the string instructions, which are the fastest
+ * option on processors with Enhanced REP MOVSB/STOSB (ERMS). Blocks larger
+ * than the last-level cache are written with non-temporal stores so that
+ * they do not evict the whole cache. Only general-purpose registers are
+ * used, the kernel does not save the FPU state of its own.
+ */
+
+#include <lib/memfnc.h>
+#include <typedefs.h>
+#include <arch/asm.h>
+#include <arch/cpuid.h>
+
+/** Without ERMS, shorter blocks are still copied byte by byte. */
+#define MEMFNC_SMALL  64
+
+/** Size of the last-level cache assumed if it cannot be determined. */
+#define MEMFNC_LLC_DEFAULT  (4 * 1024 * 1024)
+
+/** Processor supports Enhanced REP MOVSB/STOSB. */
+static bool memfnc_erms = false;
+
+/** Blocks of at least this size bypass the cache. */
+static size_t memfnc_nt_threshold = SIZE_MAX;
+
+typedef struct {
+	uint64_t val;
+} __attribute__((packed)) memfnc_unaligned_t;
+
+/** Determine the size of the largest data or unified cache. */
+static size_t memfnc_llc_size(uint32_t max_level)
+{
+	cpu_info_t info;
+	size_t llc = 0;
+
+	if (max_level >= INTEL_CPUID_CACHE) {
+		for (uint32_t i = 0; i < 16; i++) {
+			asm volatile (
+			    "cpuid\n"
+			    : "=a" (info.cpuid_eax), "=b" (info.cpuid_ebx),
+			      "=c" (info.cpuid_ecx), "=d" (info.cpuid_edx)
+			    : "a" (INTEL_CPUID_CACHE), "c" (i)
+			);
+
+			uint32_t type = info.cpuid_eax & 0x1f;
+			if (type == 0)
+				break;
+
+			/* Skip instruction caches. */
+			if (type == 2)
+				continue;
+
+			size_t ways = (info.cpuid_ebx >> 22) + 1;
+			size_t parts = ((info.cpuid_ebx >> 12) & 0x3ff) + 1;
+			size_t line = (info.cpuid_ebx & 0xfff) + 1;
+			size_t sets = (size_t) info.cpuid_ecx + 1;
+
+			if (ways * parts * line * sets > llc)
+				llc = ways * parts * line * sets;
+		}
+	}
+
+	if (llc == 0) {
+		/* AMD reports the L3 size in units of 512 KiB. */
+		cpuid(INTEL_CPUID_EXTENDED, &info);
+		if (info.cpuid_eax >= AMD_CPUID_CACHE) {
+			cpuid(AMD_CPUID_CACHE, &info);
+			llc = (size_t) (info.cpuid_edx >> 18) * 512 * 1024;
+			if (llc == 0)
+				llc = (size_t) (info.cpuid_ecx >> 16) * 1024;
+		}
+	}
+
+	return (llc != 0) ? llc : MEMFNC_LLC_DEFAULT;
+}
+
+/** Select the memory string function variants for the processor.
+ *
+ * Called on the bootstrap processor. Until then, the functions use the
+ * variants which work on every processor.
+ *
+ */
+void memfnc_init(void)
+{
+	cpu_info_t info;
+
+	if (!has_cpuid())
+		return;
+
+	cpuid(INTEL_CPUID_LEVEL, &info);
+	uint32_t max_level = info.cpuid_eax;
+
+	if (max_level >= INTEL_CPUID_FEATURES) {
+		cpuid(INTEL_CPUID_FEATURES, &info);
+		memfnc_erms = (info.cpuid_ebx & (1 << INTEL_ERMS)) != 0;
+	}
+
+	memfnc_nt_threshold = memfnc_llc_size(max_level);
+}
+
+/** Copy bytes with the string instruction. */
+_NO_TRACE static inline void memfnc_movsb(uint8_t **dp, const uint8_t **sp,
+    size_t cnt)
+{
+	asm volatile (
+	    "rep movsb\n"
+	    : "+D" (*dp), "+S" (*sp), "+c" (cnt)
+	    :
+	    : "memory"
+	);
+}
+
+/** Fill bytes with the string instruction. */
+_NO_TRACE static inline void memfnc_stosb(uint8_t **dp, uint8_t val,
+    size_t cnt)
+{
+	asm volatile (
+	    "rep stosb\n"
+	    : "+D" (*dp), "+c" (cnt)
+	    : "a" (val)
+	    : "memory"
+	);
+}
+
+/** Copy a block using non-temporal stores. */
+static void memcpy_nt(uint8_t *dp, const uint8_t *sp, size_t cnt)
+{
+	size_t head = (-(uintptr_t) dp) & 7;
+
+	memfnc_movsb(&dp, &sp, head);
+	cnt -= head;
+
+	uint64_t *dw = (uint64_t *) dp;
+	const memfnc_unaligned_t *sw = (const memfnc_unaligned_t *) sp;
+	size_t words = cnt / 8;
+
+	for (size_t i = 0; i < words; i++) {
+		asm volatile (
+		    "movnti %[val], %[dst]\n"
+		    : [dst] "=m" (dw[i])
+		    : [val] "r" (sw[i].val)
+		);
+	}
+
+	asm volatile ("sfence\n" ::: "memory");
+
+	dp = (uint8_t *) (dw + words);
+	sp = (const uint8_t *) (sw + words);
+	memfnc_movsb(&dp, &sp, cnt % 8);
+}
+
+/** Fill a block using non-temporal stores. */
+static void memset_nt(uint8_t *dp, uint8_t val, size_t cnt)
+{
+	size_t head = (-(uintptr_t) dp) & 7;
+
+	memfnc_stosb(&dp, val, head);
+	cnt -= head;
+
+	uint64_t *dw = (uint64_t *) dp;
+	uint64_t pattern = val * UINT64_C(0x0101010101010101);
+	size_t words = cnt / 8;
+
+	for (size_t i = 0; i < words; i++) {
+		asm volatile (
+		    "movnti %[val], %[dst]\n"
+		    : [dst] "=m" (dw[i])
+		    : [val] "r" (pattern)
+		);
+	}
+
+	asm volatile ("sfence\n" ::: "memory");
+
+	dp = (uint8_t *) (dw + words);
+	memfnc_stosb(&dp, val, cnt % 8);
+}
+
+/** Fill block of memory.
+ *
+ * Fill cnt bytes at dst address with the value val.
+ *
+ * @param dst Destination address to fill.
+ * @param val Value to fill.
+ * @param cnt Number of bytes to fill.
+ *
+ * @return Destination address.
+ *
+ */
+void *memset(void *dst, int val, size_t cnt)
+{
+	uint8_t *dp = (uint8_t *) dst;
+
+	if (cnt >= memfnc_nt_threshold) {
+		memset_nt(dp, val, cnt);
+		return dst;
+	}
+
+	if ((!memfnc_erms) && (cnt >= MEMFNC_SMALL)) {
+		uint64_t pattern = (uint8_t) val * UINT64_C(0x0101010101010101);
+		size_t words = cnt / 8;
+
+		asm volatile (
+		    "rep stosq\n"
+		    : "+D" (dp), "+c" (words)
+		    : "a" (pattern)
+		    : "memory"
+		);
+
+		cnt %= 8;
+	}
+
+	memfnc_stosb(&dp, val, cnt);
+	return dst;
+}
+
+/** Move memory block without overlapping.
+ *
+ * Copy cnt bytes from src address to dst address. The source
+ * and destination memory areas cannot overlap.
+ *
+ * @param dst Destination address to copy to.
+ * @param src Source address to copy from.
+ * @param cnt Number of bytes to copy.
+ *
+ * @return Destination address.
+ *
+ */
+void *memcpy(void *dst, const void *src, size_t cnt)
+{
+	uint8_t *dp = (uint8_t *) dst;
+	const uint8_t *sp = (const uint8_t *) src;
+
+	if (cnt >= memfnc_nt_threshold) {
+		memcpy_nt(dp, sp, cnt);
+		return dst;
+	}
+
+	if ((!memfnc_erms) && (cnt >= MEMFNC_SMALL)) {
+		size_t words = cnt / 8;
+
+		asm volatile (
+		    "rep movsq\n"
+		    : "+D" (dp), "+S" (sp), "+c" (words)
+		    :
+		    : "memory"
+		);
+
+		cnt %= 8;
+	}
+
+	memfnc_movsb(&dp, &sp, cnt);
+	return dst;
+}
+
+/** @}
+ */
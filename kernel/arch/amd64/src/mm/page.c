@@ -44,9 +44,39 @@
 #include <panic.h>
 #include <align.h>
 #include <macros.h>
+#include <arch/cpu.h>
+
+/** Memory types in the Page Attribute Table. */
+#define PAT_UC   UINT64_C(0x00)
+#define PAT_WC   UINT64_C(0x01)
+#define PAT_WT   UINT64_C(0x04)
+#define PAT_WB   UINT64_C(0x06)
+#define PAT_UCM  UINT64_C(0x07)
+
+#define PAT_ENTRY(i, type)  ((type) << ((i) * 8))
+
+/** Program the Page Attribute Table.
+ *
+ * The power-on layout is kept except that the write-through entries
+ * (PWT set, PCD clear) become write-combining. The kernel never maps
+ * anything write-through, so no existing mapping changes its type.
+ * The PAT is architectural on amd64 and every processor must use the
+ * same layout.
+ *
+ */
+static void pat_init(void)
+{
+	write_msr(AMD_MSR_PAT,
+	    PAT_ENTRY(0, PAT_WB) | PAT_ENTRY(1, PAT_WC) |
+	    PAT_ENTRY(2, PAT_UCM) | PAT_ENTRY(3, PAT_UC) |
+	    PAT_ENTRY(4, PAT_WB) | PAT_ENTRY(5, PAT_WC) |
+	    PAT_ENTRY(6, PAT_UCM) | PAT_ENTRY(7, PAT_UC));
+}
 
 void page_arch_init(void)
 {
+	pat_init();
+
 	if (config.cpu_active > 1) {
 		write_cr3((uintptr_t) AS_KERNEL->genarch.page_table);
 		return;
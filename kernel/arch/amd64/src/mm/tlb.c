@@ -1 +0,0 @@
-../../../ia32/src/mm/tlb.c
\ No newline at end of file
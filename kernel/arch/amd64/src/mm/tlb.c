@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2005 Jakub Jermar
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_amd64_mm
+ * @{
+ */
+/** @file
+ */
+
+#include <mm/tlb.h>
+#include <mm/asid.h>
+#include <arch/mm/asid.h>
+#include <arch/mm/tlb.h>
+#include <arch/asm.h>
+#include <arch/cpu.h>
+#include <arch.h>
+#include <config.h>
+#include <cpu.h>
+#include <panic.h>
+#include <typedefs.h>
+
+/** The TLB entries are tagged by the ASIDs of the address spaces. */
+bool pcid_enabled = false;
+
+/** Individual contexts can be invalidated by INVPCID. */
+static bool invpcid_enabled = false;
+
+/** Enable process-context identifiers on the current processor.
+ *
+ * The bootstrap processor decides whether the PCIDs are used at all. They
+ * are used if the processor supports them and the "nopcid" boot option is
+ * not present. The application processors are assumed to have the same
+ * features.
+ *
+ */
+void pcid_init(void)
+{
+	if (config.cpu_active == 1) {
+		pcid_enabled = (CPU->arch.pcid) && (!bargs_option("nopcid"));
+		invpcid_enabled = (pcid_enabled) && (CPU->arch.invpcid);
+	}
+
+	if (!pcid_enabled)
+		return;
+
+	if (!CPU->arch.pcid)
+		panic("CPU%u does not support PCID.", CPU->id);
+
+	/* CR4.PCIDE can only be set while the current PCID is zero. */
+	write_cr3(read_cr3() & ~CR3_PCID_MASK);
+	write_cr4(read_cr4() | CR4_PCIDE);
+}
+
+/** Install a page table together with the PCID of its address space.
+ *
+ * The TLB entries tagged by the PCID are kept. They are valid because the
+ * ASID of a stolen or newly allocated address space is purged from all
+ * TLBs and the shootdowns target all processors which have used the
+ * address space, not only those where it is currently active.
+ *
+ * @param ptl0 Physical address of the top-level page table.
+ * @param asid ASID of the address space.
+ *
+ */
+void write_cr3_asid(uintptr_t ptl0, asid_t asid)
+{
+	if (pcid_enabled)
+		write_cr3(ptl0 | asid | CR3_NOFLUSH);
+	else
+		write_cr3(ptl0);
+}
+
+/** Get the PCID of the current address space. */
+static inline asid_t pcid_current(void)
+{
+	return read_cr3() & CR3_PCID_MASK;
+}
+
+/** Invalidate all entries in TLB. */
+void tlb_invalidate_all(void)
+{
+	if (!pcid_enabled) {
+		write_cr3(read_cr3());
+		return;
+	}
+
+	if (invpcid_enabled) {
+		invpcid(INVPCID_ALL_GLOBAL, 0, 0);
+	} else {
+		/* Changing CR4.PGE invalidates the entries of all PCIDs. */
+		uint64_t cr4 = read_cr4();
+		write_cr4(cr4 ^ CR4_PGE);
+		write_cr4(cr4);
+	}
+}
+
+/** Invalidate all entries in TLB that belong to specified address space.
+ *
+ * The kernel mappings are cached under every PCID, hence invalidating
+ * ASID_KERNEL needs to invalidate all entries.
+ *
+ * @param asid Address space identifier.
+ */
+void tlb_invalidate_asid(asid_t asid)
+{
+	if (!pcid_enabled) {
+		write_cr3(read_cr3());
+		return;
+	}
+
+	if (asid == ASID_KERNEL) {
+		tlb_invalidate_all();
+	} else if (invpcid_enabled) {
+		invpcid(INVPCID_CONTEXT, asid, 0);
+	} else if (asid == pcid_current()) {
+		/* Loading CR3 without CR3_NOFLUSH invalidates the current PCID. */
+		write_cr3(read_cr3());
+	} else {
+		tlb_invalidate_all();
+	}
+}
+
+/** Invalidate TLB entries for specified page range belonging to specified address space.
+ *
+ * INVLPG only invalidates the entries of the current PCID. The entries of
+ * other PCIDs are invalidated by INVPCID, or as a whole if it is not
+ * available.
+ *
+ * @param asid Address space identifier.
+ * @param page Address of the first page whose entry is to be invalidated.
+ * @param cnt Number of entries to invalidate.
+ */
+void tlb_invalidate_pages(asid_t asid, uintptr_t page, size_t cnt)
+{
+	unsigned int i;
+
+	if ((pcid_enabled) &&
+	    ((asid == ASID_KERNEL) || (asid != pcid_current()))) {
+		if ((asid == ASID_KERNEL) || (!invpcid_enabled)) {
+			tlb_invalidate_asid(asid);
+			return;
+		}
+
+		for (i = 0; i < cnt; i++)
+			invpcid(INVPCID_ADDRESS, asid, page + i * PAGE_SIZE);
+
+		return;
+	}
+
+	for (i = 0; i < cnt; i++)
+		invlpg(page + i * PAGE_SIZE);
+}
+
+void tlb_arch_init(void)
+{
+}
+
+void tlb_print(void)
+{
+}
+
+/** @}
+ */
@@ -150,6 +150,17 @@ SPECIAL_REG_GEN_READ(ESR_EL1);
 /* FAR */
 SPECIAL_REG_GEN_READ(FAR_EL1);
 
+/* ID_AA64ISAR0_EL1 */
+SPECIAL_REG_GEN_READ(ID_AA64ISAR0_EL1);
+#define ID_AA64ISAR0_AES_SHIFT  4
+#define ID_AA64ISAR0_AES_MASK  (UWORD64(0xf) << ID_AA64ISAR0_AES_SHIFT)
+#define ID_AA64ISAR0_SHA1_SHIFT  8
+#define ID_AA64ISAR0_SHA1_MASK  (UWORD64(0xf) << ID_AA64ISAR0_SHA1_SHIFT)
+#define ID_AA64ISAR0_SHA2_SHIFT  12
+#define ID_AA64ISAR0_SHA2_MASK  (UWORD64(0xf) << ID_AA64ISAR0_SHA2_SHIFT)
+#define ID_AA64ISAR0_CRC32_SHIFT  16
+#define ID_AA64ISAR0_CRC32_MASK  (UWORD64(0xf) << ID_AA64ISAR0_CRC32_SHIFT)
+
 /* MIDR_EL1 */
 SPECIAL_REG_GEN_READ(MIDR_EL1);
 #define MIDR_REVISION_SHIFT  0
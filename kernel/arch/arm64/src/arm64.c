@@ -117,6 +117,17 @@ void arm64_post_smp_init(void)
 	sysinfo_set_item_data("platform", NULL, (void *) platform,
 	    str_size(platform));
 
+	/* Let user space know which cryptographic and CRC instructions it can use. */
+	uint64_t isar0 = ID_AA64ISAR0_EL1_read();
+	sysinfo_set_item_val("cpu.aes", NULL,
+	    (isar0 & ID_AA64ISAR0_AES_MASK) != 0);
+	sysinfo_set_item_val("cpu.sha1", NULL,
+	    (isar0 & ID_AA64ISAR0_SHA1_MASK) != 0);
+	sysinfo_set_item_val("cpu.sha2", NULL,
+	    (isar0 & ID_AA64ISAR0_SHA2_MASK) != 0);
+	sysinfo_set_item_val("cpu.crc32", NULL,
+	    (isar0 & ID_AA64ISAR0_CRC32_MASK) != 0);
+
 	/* Initialize input device. */
 	machine_input_init();
 }
@@ -35,16 +35,19 @@
 
 #include <arch/mach/virt/virt.h>
 #include <console/console.h>
+#include <ddi/msi.h>
 #include <genarch/drivers/gicv2/gicv2.h>
 #include <genarch/drivers/pl011/pl011.h>
 #include <genarch/srln/srln.h>
 #include <mm/km.h>
+#include <stddef.h>
 #include <sysinfo/sysinfo.h>
 
 #define VIRT_VTIMER_IRQ         27
 #define VIRT_UART_IRQ           33
 #define VIRT_GIC_DISTR_ADDRESS  0x08000000
 #define VIRT_GIC_CPUI_ADDRESS   0x08010000
+#define VIRT_GICV2M_ADDRESS     0x08020000
 #define VIRT_UART_ADDRESS       0x09000000
 
 static void virt_init(void);
@@ -55,9 +58,27 @@ inr_t virt_enable_vtimer_irq(void);
 size_t virt_get_irq_count(void);
 static const char *virt_get_platform_name(void);
 
+/** GICv2m MSI frame registers */
+typedef struct {
+	ioport32_t res0[2];
+	/** MSI type register */
+	ioport32_t typer;
+	ioport32_t res1[13];
+	/** Writing an SPI number here raises the SPI */
+	ioport32_t setspi_ns;
+} gicv2m_regs_t;
+
+#define GICV2M_TYPER_BASE(typer)   (((typer) >> 16) & 0x3ff)
+#define GICV2M_TYPER_COUNT(typer)  ((typer) & 0x3ff)
+
+static void virt_msi_compose(inr_t, unsigned int, irq_msi_t *);
+static void virt_msi_enable(inr_t);
+static void virt_msi_disable(inr_t);
+
 struct {
 	gicv2_t gicv2;
 	pl011_uart_t uart;
+	msi_ops_t msi;
 } virt;
 
 struct arm_machine_ops virt_machine_ops = {
@@ -80,6 +101,45 @@ static void virt_init(void)
 	    ALIGN_UP(sizeof(*cpui), PAGE_SIZE), KM_NATURAL_ALIGNMENT,
 	    PAGE_NOT_CACHEABLE | PAGE_READ | PAGE_WRITE | PAGE_KERNEL);
 	gicv2_init(&virt.gicv2, distr, cpui);
+
+	/*
+	 * Message signalled interrupts are SPIs raised through the GICv2m
+	 * frame.
+	 */
+	gicv2m_regs_t *v2m = (void *) km_map(VIRT_GICV2M_ADDRESS,
+	    ALIGN_UP(sizeof(*v2m), PAGE_SIZE), KM_NATURAL_ALIGNMENT,
+	    PAGE_NOT_CACHEABLE | PAGE_READ | PAGE_WRITE | PAGE_KERNEL);
+	uint32_t typer = pio_read_32(&v2m->typer);
+	unsigned base = GICV2M_TYPER_BASE(typer);
+	unsigned count = GICV2M_TYPER_COUNT(typer);
+
+	if (count > 0 &&
+	    base + count <= gicv2_inum_get_total(&virt.gicv2)) {
+		virt.msi.base = base;
+		virt.msi.count = count;
+		virt.msi.compose = virt_msi_compose;
+		virt.msi.enable = virt_msi_enable;
+		virt.msi.disable = virt_msi_disable;
+		msi_register(&virt.msi);
+	}
+}
+
+static void virt_msi_compose(inr_t inr,
+    unsigned int cpu __attribute__((unused)), irq_msi_t *msi)
+{
+	msi->address = VIRT_GICV2M_ADDRESS +
+	    offsetof(gicv2m_regs_t, setspi_ns);
+	msi->data = inr;
+}
+
+static void virt_msi_enable(inr_t inr)
+{
+	gicv2_enable(&virt.gicv2, inr);
+}
+
+static void virt_msi_disable(inr_t inr)
+{
+	gicv2_disable(&virt.gicv2, inr);
 }
 
 static void virt_irq_exception(unsigned int exc_no, istate_t *istate)
@@ -78,6 +78,9 @@ typedef struct {
 
 	unsigned int id; /** CPU's local, ie physical, APIC ID. */
 
+	uint32_t timer_period;   /** Local APIC timer counts per clock tick. */
+	uint32_t timer_oneshot;  /** Counts programmed for a stopped tick. */
+
 	tss_t *tss;
 
 	size_t iomapver_copy;  /** Copy of TASK's I/O Permission bitmap generation count. */
@@ -49,6 +49,15 @@
 #define IVT_IRQBASE   (IVT_EXCBASE + EXC_COUNT)
 #define IVT_FREEBASE  (IVT_IRQBASE + IRQ_COUNT)
 
+/*
+ * Vectors of message signalled interrupts, delivered through the local
+ * APIC. They are dispatched as INRs following the ISA IRQs. The base is
+ * aligned to eight so that an aligned block of INRs is an aligned block
+ * of vectors, as multi-message MSI requires.
+ */
+#define IVT_MSIBASE  (IVT_FREEBASE + 8)
+#define MSI_COUNT    7
+
 #define EXC_DE 0
 #define EXC_DB 1
 #define EXC_NM 7
@@ -73,6 +82,10 @@
 #error Wrong definition of VECTOR_APIC_SPUR
 #endif
 
+#if ((IVT_MSIBASE + MSI_COUNT) > VECTOR_APIC_SPUR)
+#error Wrong definition of MSI vectors
+#endif
+
 #define VECTOR_DE                 (IVT_EXCBASE + EXC_DE)
 #define VECTOR_DB                 (IVT_EXCBASE + EXC_DB)
 #define VECTOR_NM                 (IVT_EXCBASE + EXC_NM)
@@ -86,6 +99,7 @@
 #define VECTOR_SYSCALL            IVT_FREEBASE
 #define VECTOR_TLB_SHOOTDOWN_IPI  (IVT_FREEBASE + 1)
 #define VECTOR_DEBUG_IPI          (IVT_FREEBASE + 2)
+#define VECTOR_WAKEUP_IPI         (IVT_FREEBASE + 3)
 
 extern void interrupt_init(void);
 
@@ -45,8 +45,11 @@
 #include <log.h>
 #include <arch/asm.h>
 #include <arch.h>
+#include <errno.h>
 #include <ddi/irq.h>
+#include <ddi/msi.h>
 #include <genarch/pic/pic_ops.h>
+#include <time/clock.h>
 
 #ifdef CONFIG_SMP
 
@@ -163,6 +166,84 @@ static void apic_spurious(unsigned int n __attribute__((unused)),
 {
 }
 
+/** Base of the MSI address range of the local APICs */
+#define MSI_ADDRESS_BASE  0xfee00000
+/** Destination ID in the MSI address is a logical one */
+#define MSI_ADDRESS_DM_LOGIC  (1 << 2)
+
+/** Handler of message signalled interrupts.
+ *
+ * @param n      Interrupt vector.
+ * @param istate Interrupted state.
+ *
+ */
+static void apic_msi_interrupt(unsigned int n,
+    istate_t *istate __attribute__((unused)))
+{
+	irq_t *irq = irq_dispatch_and_lock(IRQ_COUNT + (n - IVT_MSIBASE));
+	if (irq) {
+		irq->handler(irq);
+		irq_spinlock_unlock(&irq->lock, false);
+	} else {
+#ifdef CONFIG_DEBUG
+		log(LF_ARCH, LVL_DEBUG, "cpu%u: unhandled MSI %u", CPU->id,
+		    n - IVT_MSIBASE);
+#endif
+	}
+
+	l_apic_eoi(0);
+}
+
+/** Compose MSI message targeting one CPU's local APIC.
+ *
+ * Fixed delivery mode, edge triggered. The CPU is addressed by its
+ * logical flat mode ID, just like the I/O APIC does it.
+ *
+ * @param inr INR of the interrupt
+ * @param cpu ID of the destination CPU
+ * @param msi Place to store the message
+ *
+ */
+static void apic_msi_compose(inr_t inr, unsigned int cpu, irq_msi_t *msi)
+{
+	msi->address = MSI_ADDRESS_BASE | MSI_ADDRESS_DM_LOGIC |
+	    ((uint64_t) (1 << cpu) << 12);
+	msi->data = IVT_MSIBASE + (inr - IRQ_COUNT);
+}
+
+/** Route an I/O APIC interrupt to one CPU.
+ *
+ * Message signalled interrupts cannot be moved, their destination is
+ * part of the message the device has been programmed with.
+ *
+ * @param inr INR of the interrupt
+ * @param cpu ID of the destination CPU
+ *
+ * @return Error code.
+ *
+ */
+static errno_t apic_irq_route(inr_t inr, unsigned int cpu)
+{
+	if (inr == IRQ_CLK || inr >= IRQ_COUNT)
+		return ENOTSUP;
+
+	int pin = smp_irq_to_pin(inr);
+	if (pin == -1)
+		return ENOENT;
+
+	io_apic_change_ioredtbl((uint8_t) pin, (uint8_t) (1 << cpu),
+	    (uint8_t) (IVT_IRQBASE + inr), 0);
+	return EOK;
+}
+
+static msi_ops_t apic_msi_ops = {
+	.base = IRQ_COUNT,
+	.count = MSI_COUNT,
+	.compose = apic_msi_compose,
+	.enable = NULL,
+	.disable = NULL
+};
+
 static irq_ownership_t l_apic_timer_claim(irq_t *irq)
 {
 	return IRQ_ACCEPT;
@@ -246,6 +327,17 @@ void apic_init(void)
 	l_apic_debug();
 
 	bsp_l_apic = l_apic_id();
+
+	/*
+	 * Message signalled interrupts go straight to the local APIC.
+	 */
+	for (i = 0; i < MSI_COUNT; i++) {
+		exc_register(IVT_MSIBASE + i, "msi", true,
+		    (iroutine_t) apic_msi_interrupt);
+	}
+
+	msi_register(&apic_msi_ops);
+	irq_route_register(apic_irq_route);
 }
 
 /** Poll for APIC errors.
@@ -510,7 +602,8 @@ void l_apic_init(void)
 	delay(1000000 / HZ);
 	uint32_t t2 = l_apic[CCRT];
 
-	l_apic[ICRT] = t1 - t2;
+	CPU->arch.timer_period = t1 - t2;
+	l_apic[ICRT] = CPU->arch.timer_period;
 
 	/* Program Logical Destination Register. */
 	assert(CPU->id < 8);
@@ -528,6 +621,56 @@ void l_apic_init(void)
 	l_apic[DFR] = dfr.value;
 }
 
+#ifdef CONFIG_TICKLESS
+
+/** Stop the periodic local timer.
+ *
+ * Reprogram the local timer of the current CPU to fire only once
+ * after the given number of clock ticks.
+ *
+ * @param ticks Number of clock ticks until the next timer interrupt.
+ *
+ */
+void tickless_arch_enter(uint64_t ticks)
+{
+	uint32_t period = CPU->arch.timer_period;
+	uint64_t count = ticks * period;
+	if (count > UINT32_MAX)
+		count = (UINT32_MAX / period) * period;
+
+	lvt_tm_t tm;
+
+	tm.value = l_apic[LVT_Tm];
+	tm.mode = TIMER_ONESHOT;
+	l_apic[LVT_Tm] = tm.value;
+
+	CPU->arch.timer_oneshot = (uint32_t) count;
+	l_apic[ICRT] = CPU->arch.timer_oneshot;
+}
+
+/** Restart the periodic local timer.
+ *
+ * @return Number of whole clock ticks elapsed since the periodic
+ *         timer was stopped.
+ *
+ */
+uint64_t tickless_arch_exit(void)
+{
+	uint32_t elapsed = CPU->arch.timer_oneshot - l_apic[CCRT];
+
+	lvt_tm_t tm;
+
+	tm.value = l_apic[LVT_Tm];
+	tm.mode = TIMER_PERIODIC;
+	l_apic[LVT_Tm] = tm.value;
+
+	l_apic[ICRT] = CPU->arch.timer_period;
+
+	return elapsed / CPU->arch.timer_period;
+}
+
+#endif /* CONFIG_TICKLESS */
+
 /** Local APIC End of Interrupt. */
 void l_apic_eoi(unsigned int ignored)
 {
@@ -35,6 +35,8 @@
 #ifdef CONFIG_SMP
 
 #include <smp/ipi.h>
+#include <cpu.h>
+#include <arch/interrupt.h>
 #include <arch/smp/apic.h>
 
 void ipi_broadcast_arch(int ipi)
@@ -42,6 +44,21 @@ void ipi_broadcast_arch(int ipi)
 	(void) l_apic_broadcast_custom_ipi((uint8_t) ipi);
 }
 
+#if (defined CONFIG_TICKLESS) || (defined CONFIG_IDLE_POLL)
+
+/** Wake up a halted CPU or a CPU running with a stopped tick.
+ *
+ * @param cpu CPU to wake up.
+ *
+ */
+void ipi_wakeup_arch(cpu_t *cpu)
+{
+	(void) l_apic_send_custom_ipi((uint8_t) cpu->arch.id,
+	    VECTOR_WAKEUP_IPI);
+}
+
+#endif
+
 #endif /* CONFIG_SMP */
 
 /** @}
@@ -41,6 +41,7 @@
 #include <errno.h>
 #include <genarch/acpi/acpi.h>
 #include <genarch/acpi/madt.h>
+#include <genarch/acpi/srat.h>
 #include <config.h>
 #include <synch/waitq.h>
 #include <arch/pm.h>
@@ -50,6 +51,7 @@
 #include <mm/page.h>
 #include <mm/frame.h>
 #include <mm/km.h>
+#include <mm/numa.h>
 #include <stdlib.h>
 #include <mm/as.h>
 #include <log.h>
@@ -63,6 +65,9 @@ static struct smp_config_operations *ops = NULL;
 
 void smp_init(void)
 {
+	if (acpi_srat)
+		acpi_srat_parse();
+
 	if (acpi_madt) {
 		acpi_madt_parse();
 		ops = &madt_config_operations;
@@ -88,6 +93,7 @@ static void cpu_arch_id_init(void)
 
 	for (unsigned int i = 0; i < config.cpu_count; ++i) {
 		cpus[i].arch.id = ops->cpu_apic_id(i);
+		cpus[i].topology.node = numa_cpu_node(cpus[i].arch.id);
 	}
 }
 
@@ -91,7 +91,7 @@ bool calculate_optimal_nrdy(exec_unit_t *exec_unit)
 {
 
 	/* calculate the number of threads the core will steal */
-	int avg = atomic_load(&nrdy) / exec_unit_count;
+	int avg = pcpu_counter_sum_positive(&nrdy) / exec_unit_count;
 	int to_steal = avg - atomic_load(&(exec_units->nrdy));
 	if (to_steal < 0) {
 		return true;
@@ -81,6 +81,18 @@
 
 #define SET_PTL0_ADDRESS(ptl0)  SET_PTL0_ADDRESS_ARCH(ptl0)
 
+/*
+ * Install the page table of an address space together with its ASID on
+ * architectures which tag the TLB entries of page table based address
+ * spaces.
+ */
+#ifdef SET_PTL0_ADDRESS_ASID_ARCH
+#define SET_PTL0_ADDRESS_ASID(ptl0, asid) \
+	SET_PTL0_ADDRESS_ASID_ARCH(ptl0, asid)
+#else
+#define SET_PTL0_ADDRESS_ASID(ptl0, asid)  SET_PTL0_ADDRESS_ARCH(ptl0)
+#endif
+
 /*
  * These macros traverse the 4-level tree of page tables,
  * each descending by one level.
@@ -139,6 +151,23 @@
 #define PTE_WRITABLE(p)    PTE_WRITABLE_ARCH((p))
 #define PTE_EXECUTABLE(p)  PTE_EXECUTABLE_ARCH((p))
 
+/*
+ * Large pages mapped directly by PTL2 entries, if the architecture
+ * supports them.
+ *
+ */
+#ifdef LARGE_PAGE_WIDTH_ARCH
+
+#define LARGE_PAGE_WIDTH   LARGE_PAGE_WIDTH_ARCH
+#define LARGE_PAGE_SIZE    (1UL << LARGE_PAGE_WIDTH)
+#define LARGE_PAGE_FRAMES  (LARGE_PAGE_SIZE >> PAGE_WIDTH)
+
+#define PTL3_LARGE(ptl2, i)             PTL3_LARGE_ARCH(ptl2, i)
+#define SET_PTL3_LARGE(ptl2, i, large)  SET_PTL3_LARGE_ARCH(ptl2, i, large)
+#define SET_PTL3_ENTRY(ptl2, i, p)      SET_PTL3_ENTRY_ARCH(ptl2, i, p)
+
+#endif /* LARGE_PAGE_WIDTH_ARCH */
+
 extern as_operations_t as_pt_operations;
 extern page_mapping_operations_t pt_mapping_operations;
 
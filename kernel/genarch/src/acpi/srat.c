@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_genarch
+ * @{
+ */
+/**
+ * @file
+ * @brief System Resource Affinity Table (SRAT) parsing.
+ */
+
+#include <typedefs.h>
+#include <genarch/acpi/acpi.h>
+#include <genarch/acpi/srat.h>
+#include <mm/frame.h>
+#include <mm/numa.h>
+#include <log.h>
+
+struct acpi_srat *acpi_srat = NULL;
+
+static void srat_l_apic_entry(struct srat_l_apic *la)
+{
+	if (!(la->flags & SRAT_ENABLED))
+		return;
+
+	uint32_t domain = la->domain_lo | (la->domain_hi[0] << 8) |
+	    (la->domain_hi[1] << 16) | ((uint32_t) la->domain_hi[2] << 24);
+
+	numa_cpu_add(la->apic_id, domain);
+}
+
+static void srat_x2_apic_entry(struct srat_x2_apic *x2a)
+{
+	if (!(x2a->flags & SRAT_ENABLED))
+		return;
+
+	numa_cpu_add(x2a->x2_apic_id, x2a->domain);
+}
+
+static void srat_memory_entry(struct srat_memory *mem)
+{
+	if (!(mem->flags & SRAT_ENABLED))
+		return;
+
+	uint64_t base = ((uint64_t) mem->base_hi << 32) | mem->base_lo;
+	uint64_t length = ((uint64_t) mem->length_hi << 32) | mem->length_lo;
+
+	numa_range_add(base, length, mem->domain);
+}
+
+/** Register the NUMA affinity described by the SRAT.
+ *
+ * The frame zones are split at the node boundaries afterwards.
+ *
+ */
+void acpi_srat_parse(void)
+{
+	struct srat_header *end = (struct srat_header *)
+	    (((uint8_t *) acpi_srat) + acpi_srat->header.length);
+	struct srat_header *hdr;
+
+	for (hdr = acpi_srat->srat_header; hdr < end;
+	    hdr = (struct srat_header *) (((uint8_t *) hdr) + hdr->length)) {
+		if (hdr->length == 0)
+			break;
+
+		switch (hdr->type) {
+		case SRAT_L_APIC:
+			srat_l_apic_entry((struct srat_l_apic *) hdr);
+			break;
+		case SRAT_MEMORY:
+			srat_memory_entry((struct srat_memory *) hdr);
+			break;
+		case SRAT_X2_APIC:
+			srat_x2_apic_entry((struct srat_x2_apic *) hdr);
+			break;
+		default:
+			break;
+		}
+	}
+
+	log(LF_ARCH, LVL_NOTE, "SRAT: %u NUMA nodes", numa_node_count());
+
+	zones_numa_init();
+}
+
+/** @}
+ */
@@ -60,6 +60,7 @@
 #include <mm/asid.h>
 #include <mm/as.h>
 #include <mm/tlb.h>
+#include <cpu/cpu_mask.h>
 #include <arch/mm/asid.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
@@ -128,6 +129,13 @@ asid_t asid_get(void)
 		ipl_t ipl = tlb_shootdown_start(TLB_INVL_ASID, asid, 0, 0);
 		tlb_invalidate_asid(asid);
 		tlb_shootdown_finalize(ipl);
+
+		/*
+		 * No processor caches translations of the address space any
+		 * longer.
+		 */
+		if (as->cpu_mask)
+			cpu_mask_none(as->cpu_mask);
 	} else {
 
 		/*
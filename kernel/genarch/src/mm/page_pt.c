@@ -52,6 +52,11 @@
 #include <bitops.h>
 
 static void pt_mapping_insert(as_t *, uintptr_t, uintptr_t, unsigned int);
+#ifdef LARGE_PAGE_WIDTH
+static bool pt_mapping_insert_large(as_t *, uintptr_t, uintptr_t,
+    unsigned int);
+static void pt_mapping_split(as_t *, uintptr_t, size_t);
+#endif
 static void pt_mapping_remove(as_t *, uintptr_t);
 static bool pt_mapping_find(as_t *, uintptr_t, bool, pte_t *pte);
 static void pt_mapping_update(as_t *, uintptr_t, bool, pte_t *pte);
@@ -59,35 +64,32 @@ static void pt_mapping_make_global(uintptr_t, size_t);
 
 page_mapping_operations_t pt_mapping_operations = {
 	.mapping_insert = pt_mapping_insert,
+#ifdef LARGE_PAGE_WIDTH
+	.mapping_insert_large = pt_mapping_insert_large,
+	.mapping_split = pt_mapping_split,
+#endif
 	.mapping_remove = pt_mapping_remove,
 	.mapping_find = pt_mapping_find,
 	.mapping_update = pt_mapping_update,
 	.mapping_make_global = pt_mapping_make_global
 };
 
-/** Map page to frame using hierarchical page tables.
+/** Get the PTL2 covering a page, creating missing PTL1 and PTL2.
  *
- * Map virtual address page to physical address frame
- * using flags.
+ * @param as   Address space to wich page belongs.
+ * @param page Virtual address of the page.
  *
- * @param as    Address space to wich page belongs.
- * @param page  Virtual address of the page to be mapped.
- * @param frame Physical address of memory frame to which the mapping is done.
- * @param flags Flags to be used for mapping.
+ * @return PTL2 whose entry maps the page.
  *
  */
-void pt_mapping_insert(as_t *as, uintptr_t page, uintptr_t frame,
-    unsigned int flags)
+static pte_t *pt_ptl2_create(as_t *as, uintptr_t page)
 {
 	pte_t *ptl0 = (pte_t *) PA2KA((uintptr_t) as->genarch.page_table);
 
-	assert(page_table_locked(as));
-
 	if (GET_PTL1_FLAGS(ptl0, PTL0_INDEX(page)) & PAGE_NOT_PRESENT) {
-		pte_t *newpt = (pte_t *)
-		    PA2KA(frame_alloc(PTL1_FRAMES, FRAME_LOWMEM, PTL1_SIZE - 1));
-		memsetb(newpt, PTL1_SIZE, 0);
-		SET_PTL1_ADDRESS(ptl0, PTL0_INDEX(page), KA2PA(newpt));
+		SET_PTL1_ADDRESS(ptl0, PTL0_INDEX(page),
+		    frame_alloc(PTL1_FRAMES, FRAME_LOWMEM | FRAME_ZERO,
+		    PTL1_SIZE - 1));
 		SET_PTL1_FLAGS(ptl0, PTL0_INDEX(page),
 		    PAGE_NOT_PRESENT | PAGE_USER | PAGE_EXEC | PAGE_CACHEABLE |
 		    PAGE_WRITE);
@@ -103,10 +105,9 @@ void pt_mapping_insert(as_t *as, uintptr_t page, uintptr_t frame,
 	pte_t *ptl1 = (pte_t *) PA2KA(GET_PTL1_ADDRESS(ptl0, PTL0_INDEX(page)));
 
 	if (GET_PTL2_FLAGS(ptl1, PTL1_INDEX(page)) & PAGE_NOT_PRESENT) {
-		pte_t *newpt = (pte_t *)
-		    PA2KA(frame_alloc(PTL2_FRAMES, FRAME_LOWMEM, PTL2_SIZE - 1));
-		memsetb(newpt, PTL2_SIZE, 0);
-		SET_PTL2_ADDRESS(ptl1, PTL1_INDEX(page), KA2PA(newpt));
+		SET_PTL2_ADDRESS(ptl1, PTL1_INDEX(page),
+		    frame_alloc(PTL2_FRAMES, FRAME_LOWMEM | FRAME_ZERO,
+		    PTL2_SIZE - 1));
 		SET_PTL2_FLAGS(ptl1, PTL1_INDEX(page),
 		    PAGE_NOT_PRESENT | PAGE_USER | PAGE_EXEC | PAGE_CACHEABLE |
 		    PAGE_WRITE);
@@ -117,13 +118,35 @@ void pt_mapping_insert(as_t *as, uintptr_t page, uintptr_t frame,
 		SET_PTL2_PRESENT(ptl1, PTL1_INDEX(page));
 	}
 
-	pte_t *ptl2 = (pte_t *) PA2KA(GET_PTL2_ADDRESS(ptl1, PTL1_INDEX(page)));
+	return (pte_t *) PA2KA(GET_PTL2_ADDRESS(ptl1, PTL1_INDEX(page)));
+}
+
+/** Map page to frame using hierarchical page tables.
+ *
+ * Map virtual address page to physical address frame
+ * using flags.
+ *
+ * @param as    Address space to wich page belongs.
+ * @param page  Virtual address of the page to be mapped.
+ * @param frame Physical address of memory frame to which the mapping is done.
+ * @param flags Flags to be used for mapping.
+ *
+ */
+void pt_mapping_insert(as_t *as, uintptr_t page, uintptr_t frame,
+    unsigned int flags)
+{
+	assert(page_table_locked(as));
+
+	pte_t *ptl2 = pt_ptl2_create(as, page);
+
+#ifdef LARGE_PAGE_WIDTH
+	assert(!PTL3_LARGE(ptl2, PTL2_INDEX(page)));
+#endif
 
 	if (GET_PTL3_FLAGS(ptl2, PTL2_INDEX(page)) & PAGE_NOT_PRESENT) {
-		pte_t *newpt = (pte_t *)
-		    PA2KA(frame_alloc(PTL3_FRAMES, FRAME_LOWMEM, PTL2_SIZE - 1));
-		memsetb(newpt, PTL2_SIZE, 0);
-		SET_PTL3_ADDRESS(ptl2, PTL2_INDEX(page), KA2PA(newpt));
+		SET_PTL3_ADDRESS(ptl2, PTL2_INDEX(page),
+		    frame_alloc(PTL3_FRAMES, FRAME_LOWMEM | FRAME_ZERO,
+		    PTL2_SIZE - 1));
 		SET_PTL3_FLAGS(ptl2, PTL2_INDEX(page),
 		    PAGE_NOT_PRESENT | PAGE_USER | PAGE_EXEC | PAGE_CACHEABLE |
 		    PAGE_WRITE);
@@ -145,6 +168,128 @@ void pt_mapping_insert(as_t *as, uintptr_t page, uintptr_t frame,
 	SET_FRAME_PRESENT(ptl3, PTL3_INDEX(page));
 }
 
+#ifdef LARGE_PAGE_WIDTH
+
+/** Map a large page to contiguous frames using a single PTL2 entry.
+ *
+ * @param as    Address space to wich page belongs.
+ * @param page  Virtual address of the large page, aligned to
+ *              LARGE_PAGE_SIZE.
+ * @param frame Physical address of the first frame, aligned to
+ *              LARGE_PAGE_SIZE.
+ * @param flags Flags to be used for mapping.
+ *
+ * @return True on success, false if the PTL2 entry already refers to
+ *         a PTL3 or a large page.
+ *
+ */
+bool pt_mapping_insert_large(as_t *as, uintptr_t page, uintptr_t frame,
+    unsigned int flags)
+{
+	assert(page_table_locked(as));
+	assert(IS_ALIGNED(page, LARGE_PAGE_SIZE));
+	assert(IS_ALIGNED(frame, LARGE_PAGE_SIZE));
+
+	pte_t *ptl2 = pt_ptl2_create(as, page);
+
+	/*
+	 * Empty PTL3 tables are always freed, so a present PTL2 entry means
+	 * that some page of the range is already mapped.
+	 */
+	if (!(GET_PTL3_FLAGS(ptl2, PTL2_INDEX(page)) & PAGE_NOT_PRESENT))
+		return false;
+
+	SET_PTL3_ADDRESS(ptl2, PTL2_INDEX(page), frame);
+	SET_PTL3_FLAGS(ptl2, PTL2_INDEX(page), flags | PAGE_NOT_PRESENT);
+	SET_PTL3_LARGE(ptl2, PTL2_INDEX(page), true);
+	/*
+	 * Make the new mapping visible only after it is fully initialized.
+	 */
+	write_barrier();
+	SET_PTL3_PRESENT(ptl2, PTL2_INDEX(page));
+
+	as->large_pages++;
+	return true;
+}
+
+/** Split a large page mapping into a PTL3 of ordinary mappings.
+ *
+ * The new PTL3 maps the same frames with the same flags, so the
+ * translation does not change and no TLB shootdown is needed for
+ * the split itself.
+ *
+ * @param as   Address space to wich the mapping belongs.
+ * @param ptl2 PTL2 containing the large page entry.
+ * @param i    Index of the large page entry.
+ *
+ */
+static void pt_large_split(as_t *as, pte_t *ptl2, size_t i)
+{
+	pte_t *ptl3 = (pte_t *)
+	    PA2KA(frame_alloc(PTL3_FRAMES, FRAME_LOWMEM, PTL3_SIZE - 1));
+	uintptr_t base = (uintptr_t) GET_PTL3_ADDRESS(ptl2, i);
+
+	for (size_t j = 0; j < PTL3_ENTRIES; j++) {
+		ptl3[j] = ptl2[i];
+		SET_PTL3_LARGE(ptl3, j, false);
+		SET_FRAME_ADDRESS(ptl3, j, base + FRAMES2SIZE(j));
+	}
+
+	pte_t table;
+	memsetb(&table, sizeof(pte_t), 0);
+	SET_PTL3_ADDRESS(&table, 0, KA2PA(ptl3));
+	SET_PTL3_FLAGS(&table, 0, PAGE_USER | PAGE_EXEC | PAGE_CACHEABLE |
+	    PAGE_WRITE);
+
+	/*
+	 * Make the new PTL3 visible only after it is fully initialized and
+	 * replace the large entry with a single store so that a concurrent
+	 * hardware page table walk sees either the old or the new entry.
+	 */
+	write_barrier();
+	SET_PTL3_ENTRY(ptl2, i, &table);
+
+	as->large_pages--;
+}
+
+/** Split all large page mappings in a range of pages.
+ *
+ * @param as    Address space to wich the range belongs.
+ * @param page  First page of the range.
+ * @param count Number of pages in the range.
+ *
+ */
+void pt_mapping_split(as_t *as, uintptr_t page, size_t count)
+{
+	assert(page_table_locked(as));
+
+	if (as->large_pages == 0)
+		return;
+
+	pte_t *ptl0 = (pte_t *) PA2KA((uintptr_t) as->genarch.page_table);
+
+	for (uintptr_t addr = ALIGN_DOWN(page, LARGE_PAGE_SIZE);
+	    addr - 1 < page + P2SZ(count) - 1; addr += LARGE_PAGE_SIZE) {
+		if (GET_PTL1_FLAGS(ptl0, PTL0_INDEX(addr)) & PAGE_NOT_PRESENT)
+			continue;
+
+		pte_t *ptl1 =
+		    (pte_t *) PA2KA(GET_PTL1_ADDRESS(ptl0, PTL0_INDEX(addr)));
+		if (GET_PTL2_FLAGS(ptl1, PTL1_INDEX(addr)) & PAGE_NOT_PRESENT)
+			continue;
+
+		pte_t *ptl2 =
+		    (pte_t *) PA2KA(GET_PTL2_ADDRESS(ptl1, PTL1_INDEX(addr)));
+		if (GET_PTL3_FLAGS(ptl2, PTL2_INDEX(addr)) & PAGE_NOT_PRESENT)
+			continue;
+
+		if (PTL3_LARGE(ptl2, PTL2_INDEX(addr)))
+			pt_large_split(as, ptl2, PTL2_INDEX(addr));
+	}
+}
+
+#endif /* LARGE_PAGE_WIDTH */
+
 /** Remove mapping of page from hierarchical page tables.
  *
  * Remove any mapping of page within address space as.
@@ -177,6 +322,14 @@ void pt_mapping_remove(as_t *as, uintptr_t page)
 	if (GET_PTL3_FLAGS(ptl2, PTL2_INDEX(page)) & PAGE_NOT_PRESENT)
 		return;
 
+#ifdef LARGE_PAGE_WIDTH
+	/*
+	 * Large pages must have been split by pt_mapping_split() before the
+	 * TLB shootdown sequence was started.
+	 */
+	assert(!PTL3_LARGE(ptl2, PTL2_INDEX(page)));
+#endif
+
 	pte_t *ptl3 = (pte_t *) PA2KA(GET_PTL3_ADDRESS(ptl2, PTL2_INDEX(page)));
 
 	/*
@@ -291,8 +444,11 @@ void pt_mapping_remove(as_t *as, uintptr_t page)
 #endif /* PTL1_ENTRIES != 0 */
 }
 
-static pte_t *pt_mapping_find_internal(as_t *as, uintptr_t page, bool nolock)
+static pte_t *pt_mapping_find_internal(as_t *as, uintptr_t page, bool nolock,
+    bool *large)
 {
+	*large = false;
+
 	assert(nolock || page_table_locked(as));
 
 	pte_t *ptl0 = (pte_t *) PA2KA((uintptr_t) as->genarch.page_table);
@@ -316,6 +472,13 @@ static pte_t *pt_mapping_find_internal(as_t *as, uintptr_t page, bool nolock)
 	if (GET_PTL3_FLAGS(ptl2, PTL2_INDEX(page)) & PAGE_NOT_PRESENT)
 		return NULL;
 
+#ifdef LARGE_PAGE_WIDTH
+	if (PTL3_LARGE(ptl2, PTL2_INDEX(page))) {
+		*large = true;
+		return &ptl2[PTL2_INDEX(page)];
+	}
+#endif
+
 #if (PTL2_ENTRIES != 0)
 	/*
 	 * Always read ptl3 only after we are sure it is present.
@@ -339,10 +502,27 @@ static pte_t *pt_mapping_find_internal(as_t *as, uintptr_t page, bool nolock)
  */
 bool pt_mapping_find(as_t *as, uintptr_t page, bool nolock, pte_t *pte)
 {
-	pte_t *t = pt_mapping_find_internal(as, page, nolock);
-	if (t)
-		*pte = *t;
-	return t != NULL;
+	bool large;
+	pte_t *t = pt_mapping_find_internal(as, page, nolock, &large);
+	if (!t)
+		return false;
+
+	*pte = *t;
+
+#ifdef LARGE_PAGE_WIDTH
+	if (large) {
+		/*
+		 * Present the large page entry as an ordinary PTE mapping
+		 * the corresponding frame.
+		 */
+		SET_PTL3_LARGE(pte, 0, false);
+		SET_FRAME_ADDRESS(pte, 0, (uintptr_t) GET_FRAME_ADDRESS(pte, 0) +
+		    (ALIGN_DOWN(page, PAGE_SIZE) -
+		    ALIGN_DOWN(page, LARGE_PAGE_SIZE)));
+	}
+#endif
+
+	return true;
 }
 
 /** Update mapping for virtual page in hierarchical page tables.
@@ -354,10 +534,24 @@ bool pt_mapping_find(as_t *as, uintptr_t page, bool nolock, pte_t *pte)
  */
 void pt_mapping_update(as_t *as, uintptr_t page, bool nolock, pte_t *pte)
 {
-	pte_t *t = pt_mapping_find_internal(as, page, nolock);
+	bool large;
+	pte_t *t = pt_mapping_find_internal(as, page, nolock, &large);
 	if (!t)
 		panic("Updating non-existent PTE");
 
+#ifdef LARGE_PAGE_WIDTH
+	pte_t tmp;
+	if (large) {
+		/* Convert the PTE back to the large page entry. */
+		tmp = *pte;
+		SET_PTL3_LARGE(&tmp, 0, true);
+		SET_FRAME_ADDRESS(&tmp, 0, (uintptr_t) GET_FRAME_ADDRESS(&tmp, 0) -
+		    (ALIGN_DOWN(page, PAGE_SIZE) -
+		    ALIGN_DOWN(page, LARGE_PAGE_SIZE)));
+		pte = &tmp;
+	}
+#endif
+
 	assert(PTE_VALID(t) == PTE_VALID(pte));
 	assert(PTE_PRESENT(t) == PTE_PRESENT(pte));
 	assert(PTE_GET_FRAME(t) == PTE_GET_FRAME(pte));
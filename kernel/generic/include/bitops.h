@@ -40,10 +40,12 @@
 
 #ifdef __32_BITS__
 #define fnzb(arg)  fnzb32(arg)
+#define lnzb(arg)  lnzb32(arg)
 #endif
 
 #ifdef __64_BITS__
 #define fnzb(arg)  fnzb64(arg)
+#define lnzb(arg)  lnzb64(arg)
 #endif
 
 /** Return position of first non-zero bit from left (32b variant).
@@ -98,6 +100,28 @@ _NO_TRACE static inline uint8_t fnzb64(uint64_t arg)
 	return n + fnzb32((uint32_t) arg);
 }
 
+/** Return position of first non-zero bit from right (32b variant).
+ *
+ * @return 0 (if the number is zero) or the index of the least
+ *         significant non-zero bit.
+ *
+ */
+_NO_TRACE static inline uint8_t lnzb32(uint32_t arg)
+{
+	return fnzb32(arg & -arg);
+}
+
+/** Return position of first non-zero bit from right (64b variant).
+ *
+ * @return 0 (if the number is zero) or the index of the least
+ *         significant non-zero bit.
+ *
+ */
+_NO_TRACE static inline uint8_t lnzb64(uint64_t arg)
+{
+	return fnzb64(arg & -arg);
+}
+
 #endif
 
 /** @}
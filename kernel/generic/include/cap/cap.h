@@ -38,10 +38,9 @@
 #include <abi/cap.h>
 #include <typedefs.h>
 #include <adt/list.h>
-#include <adt/hash.h>
-#include <adt/hash_table.h>
 #include <lib/ra.h>
 #include <synch/mutex.h>
+#include <synch/rcu.h>
 #include <atomic.h>
 
 typedef enum {
@@ -55,6 +54,7 @@ typedef enum {
 	KOBJECT_TYPE_IRQ,
 	KOBJECT_TYPE_PHONE,
 	KOBJECT_TYPE_WAITQ,
+	KOBJECT_TYPE_RING,
 	KOBJECT_TYPE_MAX
 } kobject_type_t;
 
@@ -64,9 +64,15 @@ struct call;
 struct irq;
 struct phone;
 struct waitq;
+struct ipc_ring;
 
 typedef struct kobject_ops {
 	void (*destroy)(void *);
+	/**
+	 * Optionally keep the object together with its kobject_t for reuse
+	 * instead of destroying it. Returns true if the object was kept.
+	 */
+	bool (*recycle)(void *);
 } kobject_ops_t;
 
 extern kobject_ops_t *kobject_ops[];
@@ -92,11 +98,17 @@ typedef struct kobject {
 		struct irq *irq;
 		struct phone *phone;
 		struct waitq *waitq;
+		struct ipc_ring *ring;
 	};
+
+	/** Deferred reclamation of the kobject_t wrapper. */
+	rcu_item_t rcu;
 } kobject_t;
 
 /*
- * A cap_t may only be accessed under the protection of the cap_info_t lock.
+ * A cap_t may only be modified under the protection of the cap_info_t lock.
+ * kobject_get() reads it locklessly, so it is reclaimed only after an RCU
+ * grace period.
  */
 typedef struct cap {
 	cap_state_t state;
@@ -110,18 +122,30 @@ typedef struct cap {
 	/* Link to the task's capabilities of the same kobject type. */
 	link_t type_link;
 
-	ht_link_t caps_link;
-
 	/* The underlying kernel object. */
 	kobject_t *kobject;
+
+	/** Deferred reclamation of the capability. */
+	rcu_item_t rcu;
 } cap_t;
 
+/** Number of bits of a capability handle indexing a capability table leaf */
+#define CAPS_LEAF_BITS  10
+/** Number of capabilities in a capability table leaf */
+#define CAPS_LEAF_SIZE  (1 << CAPS_LEAF_BITS)
+/** Number of capability table leaves */
+#define CAPS_LEAVES     1024
+
 typedef struct cap_info {
 	mutex_t lock;
 
 	list_t type_list[KOBJECT_TYPE_MAX];
 
-	hash_table_t caps;
+	/**
+	 * Two-level table of capabilities indexed by the capability handle.
+	 * Leaves are allocated on demand and live as long as the task.
+	 */
+	struct cap **table[CAPS_LEAVES];
 	ra_arena_t *handles;
 } cap_info_t;
 
@@ -105,6 +105,7 @@ typedef struct {
 
 extern config_t config;
 extern char bargs[];
+extern bool bargs_option(const char *);
 extern init_t init;
 extern ballocs_t ballocs;
 
@@ -36,15 +36,52 @@
 #define KERN_CPU_H_
 
 #include <mm/tlb.h>
+#include <mm/frame.h>
 #include <synch/spinlock.h>
 #include <proc/scheduler.h>
 #include <arch/cpu.h>
 #include <arch/context.h>
 #include <adt/list.h>
+#include <abi/sysinfo.h>
 #include <arch.h>
 
 #define CPU                  CURRENT->cpu
 
+/*
+ * Geometry of the per-CPU hierarchical timeout wheel. Each level has
+ * TIMEOUT_WHEEL_SLOTS slots and every slot of a level spans
+ * TIMEOUT_WHEEL_SLOTS slots of the level below.
+ */
+#define TIMEOUT_WHEEL_BITS    6
+#define TIMEOUT_WHEEL_SLOTS   (1 << TIMEOUT_WHEEL_BITS)
+#define TIMEOUT_WHEEL_LEVELS  4
+
+/** Number of recycled IPC calls kept by each CPU. */
+#define CPU_CALL_CACHE_SIZE  16
+
+/** Idle state of a CPU, see cpu_t::idle_state. */
+typedef enum {
+	/** The CPU is running a thread or the scheduler. */
+	CPU_IDLE_NONE,
+	/** The CPU polls or monitors its nrdy, writing nrdy wakes it up. */
+	CPU_IDLE_POLLING,
+	/** The CPU is halted and needs an interrupt to wake up. */
+	CPU_IDLE_HALTED
+} cpu_idle_state_t;
+
+/** CPU topology information.
+ *
+ * The identifiers are only meaningful when compared between CPUs.
+ * CPUs with the same package and core are SMT siblings, CPUs with
+ * the same package and llc share the last-level cache.
+ */
+typedef struct {
+	unsigned int package;  /**< Physical package. */
+	unsigned int core;     /**< Core within the package. */
+	unsigned int llc;      /**< Last-level cache within the package. */
+	unsigned int node;     /**< NUMA node. */
+} cpu_topology_t;
+
 /** CPU structure.
  *
  * There is one structure like this for every processor.
@@ -59,10 +96,17 @@ typedef struct cpu {
 
 	atomic_size_t nrdy;
 	runq_t rq[RQ_COUNT];
+	rq_bitmap_t rq_ready;  /**< Non-empty queues in rq. */
+	/** Run queues of the real-time scheduling class. */
+	runq_t rt_rq[RT_PRIO_COUNT];
+	rq_bitmap_t rt_ready;  /**< Non-empty queues in rt_rq. */
 	volatile size_t needs_relink;
 
 	IRQ_SPINLOCK_DECLARE(timeoutlock);
-	list_t timeout_active_list;
+	/** Hierarchical timing wheel of active timeouts. */
+	list_t timeout_wheel[TIMEOUT_WHEEL_LEVELS][TIMEOUT_WHEEL_SLOTS];
+	uint64_t timeout_now;    /**< Clock ticks processed by the wheel. */
+	size_t timeout_count;    /**< Number of active timeouts. */
 
 	/**
 	 * When system clock loses a tick, it is
@@ -73,14 +117,72 @@ typedef struct cpu {
 	 */
 	size_t missed_clock_ticks;
 
+	/**
+	 * State interrupted by the innermost exception being handled on
+	 * this CPU, see exc_dispatch(). CPU-local, accessed only with
+	 * interrupts disabled.
+	 */
+	struct istate *istate;
+
+	/** Slots of per-CPU counters, see pcpu_counter_t. */
+	int64_t *counters;
+
+	/** Grace period in which the CPU last passed a quiescent state. */
+	atomic_size_t rcu_qs_gp;
+	/** The CPU is in its idle loop, see rcu_idle_enter(). */
+	atomic_bool rcu_idle;
+
+#ifdef CONFIG_TICKLESS
+	/**
+	 * The periodic clock tick is stopped and the local timer is
+	 * programmed to fire only when the next timeout expires.
+	 */
+	atomic_bool tickless;
+#endif
+
 	/**
 	 * Processor cycle accounting.
 	 */
 	bool idle;
+	/** How a thread readied by another CPU wakes this CPU up. */
+	atomic_int idle_state;
 	uint64_t last_cycle;
 	uint64_t idle_cycles;
 	uint64_t busy_cycles;
 
+	/**
+	 * Load balancing accounting.
+	 */
+	uint64_t steal_count;    /**< Threads stolen while idle. */
+	uint64_t balance_count;  /**< Threads migrated by kcpulb. */
+
+	/**
+	 * Run queue latency histogram of dispatched threads. Updated only
+	 * by this CPU with interrupts disabled, without taking the lock.
+	 */
+	uint64_t rq_latency[STATS_LATENCY_BUCKETS];
+
+#ifdef CONFIG_IPC_HANDOFF
+	/**
+	 * Thread the running thread handed the CPU over to. It is not in
+	 * any run queue and the scheduler runs it next. CPU-local, accessed
+	 * only with interrupts disabled.
+	 */
+	struct thread *handoff;
+	/** Ticks donated to the handoff thread. */
+	uint64_t handoff_ticks;
+#endif
+
+	/** Cache of free single frames. */
+	frame_cache_t frame_cache;
+
+	/**
+	 * Recycled IPC calls with their kernel objects, see ipc_call_alloc().
+	 * CPU-local, accessed only with interrupts disabled.
+	 */
+	struct call *call_cache[CPU_CALL_CACHE_SIZE];
+	size_t call_cache_count;
+
 	/**
 	 * Processor ID assigned by kernel.
 	 */
@@ -89,6 +191,9 @@ typedef struct cpu {
 	bool active;
 	volatile bool tlb_active;
 
+	/** Position of the CPU in the processor topology. */
+	cpu_topology_t topology;
+
 	uint16_t frequency_mhz;
 	uint32_t delay_loop_const;
 
@@ -106,11 +211,26 @@ extern cpu_t *cpus;
 
 extern void cpu_init(void);
 extern void cpu_list(void);
+extern void cpu_idle_end(void);
 
 extern void cpu_arch_init(void);
 extern void cpu_identify(void);
 extern void cpu_print_report(cpu_t *);
 
+/** Check whether two CPUs are SMT siblings (share the same core). */
+static inline bool cpu_same_core(cpu_t *a, cpu_t *b)
+{
+	return (a->topology.package == b->topology.package) &&
+	    (a->topology.core == b->topology.core);
+}
+
+/** Check whether two CPUs share the last-level cache. */
+static inline bool cpu_same_llc(cpu_t *a, cpu_t *b)
+{
+	return (a->topology.package == b->topology.package) &&
+	    (a->topology.llc == b->topology.llc);
+}
+
 #endif
 
 /** @}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_CPU_PCPU_COUNTER_H_
+#define KERN_CPU_PCPU_COUNTER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct cpu;
+
+/** Number of frames of the per-CPU counter area of each CPU. */
+#define PCPU_COUNTER_FRAMES  1
+
+/** Per-CPU counter.
+ *
+ * Each counter owns a slot in the counter area of every CPU. Updates
+ * only touch the slot of the current CPU, so they neither take a lock
+ * nor move a cache line between processors. Reading the counter sums
+ * the slots of all CPUs and is comparatively expensive.
+ *
+ * Counters without a slot, i.e. zero-initialized counters and counters
+ * created when all slots were taken, as well as updates made before the
+ * per-CPU areas exist, fall back to a shared value protected by a lock.
+ */
+typedef struct {
+	/** Slot in the per-CPU counter areas, zero if none. */
+	size_t slot;
+	/** Value accumulated outside of the per-CPU areas. */
+	int64_t shared;
+} pcpu_counter_t;
+
+extern void pcpu_counter_area_init(struct cpu *);
+
+extern void pcpu_counter_initialize(pcpu_counter_t *);
+extern void pcpu_counter_destroy(pcpu_counter_t *);
+extern void pcpu_counter_reset(pcpu_counter_t *);
+
+extern void pcpu_counter_add(pcpu_counter_t *, int64_t);
+extern int64_t pcpu_counter_sum(pcpu_counter_t *);
+extern uint64_t pcpu_counter_sum_positive(pcpu_counter_t *);
+
+/** Increment per-CPU counter by one. */
+#define pcpu_counter_inc(counter)  pcpu_counter_add((counter), 1)
+
+/** Decrement per-CPU counter by one. */
+#define pcpu_counter_dec(counter)  pcpu_counter_add((counter), -1)
+
+#endif /* KERN_CPU_PCPU_COUNTER_H_ */
+
+/** @}
+ */
@@ -38,11 +38,12 @@
 #include <typedefs.h>
 #include <abi/ddi/irq.h>
 #include <adt/list.h>
-#include <adt/hash_table.h>
 #include <synch/spinlock.h>
+#include <synch/rcu.h>
 #include <proc/task.h>
 #include <ipc/ipc.h>
 #include <mm/slab.h>
+#include <time/timeout.h>
 
 typedef enum {
 	IRQ_DECLINE,  /**< Decline to service. */
@@ -61,6 +62,15 @@ typedef void (*irq_handler_t)(struct irq *);
 /** Type for function used to clear the interrupt. */
 typedef void (*cir_t)(void *, inr_t);
 
+/** Route an INR to a CPU at the interrupt controller.
+ *
+ * Returns ENOTSUP if the INR cannot be moved.
+ */
+typedef errno_t (*irq_route_t)(inr_t, unsigned int);
+
+/** No CPU has been chosen for the INR yet */
+#define IRQ_CPU_ANY  ((unsigned int) -1)
+
 /** IPC notification config structure.
  *
  * Primarily, this structure is encapsulated in the irq_t structure.
@@ -82,6 +92,19 @@ typedef struct {
 	irq_code_t *code;
 	/** Counter. */
 	size_t counter;
+
+	/** Notification moderation. */
+	irq_moderation_t moderation;
+	/** Last notification sent, referenced while it may still be queued. */
+	struct call *pending;
+	/** Number of interrupts merged into the pending notification. */
+	size_t pending_count;
+	/** Interrupts not notified yet because of the minimum interval. */
+	size_t deferred;
+	/** True while the minimum interval after a notification runs. */
+	bool holdoff;
+	/** Timeout ending the minimum interval. */
+	timeout_t holdoff_timeout;
 } ipc_notif_cfg_t;
 
 /** Structure representing one device IRQ.
@@ -90,16 +113,21 @@ typedef struct {
  * instantions.
  */
 typedef struct irq {
-	/** Hash table link. */
-	ht_link_t link;
+	/** Next IRQ structure in the same IRQ hash chain. */
+	struct irq *next;
+	/** Deferred reclamation of the structure. */
+	rcu_item_t rcu;
 
 	/** Lock protecting everything in this structure
-	 *  except the link member. When both the IRQ
+	 *  except the next and rcu members. When both the IRQ
 	 *  hash table lock and this lock are to be acquired,
 	 *  this lock must not be taken first.
 	 */
 	IRQ_SPINLOCK_DECLARE(lock);
 
+	/** The structure is in an IRQ hash table. */
+	bool hashed;
+
 	/** Send EOI before processing the interrupt.
 	 *  This is essential for timer interrupt which
 	 *  has to be acknowledged before doing preemption
@@ -128,8 +156,21 @@ typedef struct irq {
 	ipc_notif_cfg_t notif_cfg;
 } irq_t;
 
+/** IRQ hash table with lockless readers.
+ *
+ * Writers hold the lock of the table and the lock of the inserted or
+ * removed IRQ structure. Readers traverse the chains in RCU read-side
+ * critical sections.
+ */
+typedef struct {
+	/** Chains of IRQ structures linked by irq_t::next. */
+	irq_t **chain;
+	/** Number of chains. */
+	size_t chains;
+} irq_hash_t;
+
 IRQ_SPINLOCK_EXTERN(irq_uspace_hash_table_lock);
-extern hash_table_t irq_uspace_hash_table;
+extern irq_hash_t irq_uspace_hash_table;
 
 extern slab_cache_t *irq_cache;
 
@@ -138,8 +179,20 @@ extern inr_t last_inr;
 extern void irq_init(size_t, size_t);
 extern void irq_initialize(irq_t *);
 extern void irq_register(irq_t *);
+extern void irq_hash_insert(irq_hash_t *, irq_t *);
+extern void irq_hash_remove(irq_hash_t *, irq_t *);
 extern irq_t *irq_dispatch_and_lock(inr_t);
 
+extern void irq_route_register(irq_route_t);
+extern errno_t irq_affinity_set(inr_t, unsigned int);
+extern unsigned int irq_affinity_get(inr_t);
+extern void irq_affinity_record(inr_t, unsigned int);
+extern unsigned int irq_affinity_next(void);
+extern void irq_affinity_default(inr_t);
+
+extern sys_errno_t sys_irq_affinity_set(sysarg_t, sysarg_t);
+extern sys_errno_t sys_irq_affinity_get(sysarg_t, uspace_addr_t);
+
 #endif
 
 /** @}
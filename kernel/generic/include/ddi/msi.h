@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ddi
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_DDI_MSI_H_
+#define KERN_DDI_MSI_H_
+
+#include <typedefs.h>
+#include <abi/ddi/irq.h>
+#include <abi/proc/task.h>
+
+/** Maximum number of message signalled interrupts */
+#define MSI_MAX  256
+
+/** Message signalled interrupt controller.
+ *
+ * Registered by the architecture code when the platform can deliver
+ * message signalled interrupts. The INRs of the range are dispatched
+ * to IRQ handlers like any other INR.
+ */
+typedef struct {
+	/** First INR of the MSI range */
+	inr_t base;
+	/** Number of INRs in the MSI range */
+	size_t count;
+	/** Compose the message which raises an INR of the range on a CPU */
+	void (*compose)(inr_t, unsigned int, irq_msi_t *);
+	/** Unmask an INR at the interrupt controller, may be NULL */
+	void (*enable)(inr_t);
+	/** Mask an INR at the interrupt controller, may be NULL */
+	void (*disable)(inr_t);
+} msi_ops_t;
+
+extern void msi_register(msi_ops_t *);
+extern errno_t msi_alloc(size_t, task_id_t, irq_msi_t *);
+extern errno_t msi_free(inr_t, size_t, task_id_t);
+extern void msi_release(task_id_t);
+
+extern sys_errno_t sys_irq_msi_alloc(sysarg_t, uspace_ptr_irq_msi_t);
+extern sys_errno_t sys_irq_msi_free(sysarg_t, sysarg_t);
+
+#endif
+
+/** @}
+ */
@@ -45,6 +45,7 @@
 #include <ddi/irq.h>
 #include <stacktrace.h>
 #include <arch/istate.h>
+#include <cpu/pcpu_counter.h>
 
 typedef void (*iroutine_t)(unsigned int, istate_t *);
 
@@ -52,8 +53,8 @@ typedef struct {
 	const char *name;
 	bool hot;
 	iroutine_t handler;
-	uint64_t cycles;
-	uint64_t count;
+	pcpu_counter_t cycles;
+	pcpu_counter_t count;
 } exc_table_t;
 
 IRQ_SPINLOCK_EXTERN(exctbl_lock);
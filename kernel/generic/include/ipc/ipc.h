@@ -40,6 +40,7 @@
 #include <synch/waitq.h>
 #include <abi/ipc/ipc.h>
 #include <abi/proc/task.h>
+#include <abi/sysinfo.h>
 #include <typedefs.h>
 #include <mm/slab.h>
 #include <cap/cap.h>
@@ -71,6 +72,10 @@ typedef struct phone {
 	struct call *hangup_call;
 	ipc_phone_state_t state;
 	atomic_size_t active_calls;
+	/** Requests sent over the phone. */
+	atomic_size_t calls_sent;
+	/** Answers received over the phone. */
+	atomic_size_t answers_received;
 	/** User-defined label */
 	sysarg_t label;
 	kobject_t *kobject;
@@ -104,6 +109,15 @@ typedef struct answerbox {
 
 	/** Notifications from IRQ handlers. */
 	list_t irq_notifs;
+
+	/** Protects the request statistics below. */
+	IRQ_SPINLOCK_DECLARE(stats_lock);
+	/** Requests queued in the answerbox and not yet answered. */
+	size_t queue_depth;
+	/** Highest queue_depth so far. */
+	size_t queue_peak;
+	/** Histogram of request-to-answer times, see STATS_LATENCY_BUCKETS. */
+	uint64_t answer_latency[STATS_LATENCY_BUCKETS];
 } answerbox_t;
 
 typedef struct call {
@@ -154,6 +168,11 @@ typedef struct call {
 	/** Phone which was used to send the call. */
 	phone_t *caller_phone;
 
+	/** Answerbox whose statistics the unanswered request counts in. */
+	answerbox_t *callee_box;
+	/** Cycle count when the request was queued in callee_box. */
+	uint64_t queued_cycle;
+
 	/** Private data to internal IPC. */
 	sysarg_t priv;
 
@@ -165,6 +184,9 @@ typedef struct call {
 
 	/** Buffer for IPC_M_DATA_WRITE and IPC_M_DATA_READ. */
 	uint8_t *buffer;
+
+	/** Pinned buffer of the caller for IPC_M_DATA_WRITE and IPC_M_DATA_READ. */
+	struct ipc_xfer *xfer;
 } call_t;
 
 extern slab_cache_t *phone_cache;
@@ -189,6 +211,7 @@ extern bool ipc_phone_connect(phone_t *, answerbox_t *);
 extern errno_t ipc_phone_hangup(phone_t *);
 
 extern void ipc_answerbox_init(answerbox_t *, struct task *);
+extern void ipc_answerbox_get_stats(answerbox_t *, stats_ipc_t *);
 
 extern void ipc_cleanup(void);
 extern void ipc_backsend_err(phone_t *, call_t *, errno_t);
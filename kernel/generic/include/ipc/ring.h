@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_IPC_RING_H_
+#define KERN_IPC_RING_H_
+
+#include <abi/ipc/ring.h>
+#include <abi/cap.h>
+#include <cap/cap.h>
+#include <synch/waitq.h>
+#include <typedefs.h>
+#include <stdatomic.h>
+
+/** Doorbells of a pair of shared-memory IPC rings.
+ *
+ * The rings themselves live in an address space area shared by the client
+ * and the server and are never touched by the kernel. The kernel only
+ * provides a doorbell for each side, which is rung by the producer when
+ * it finds the consumer sleeping.
+ */
+typedef struct ipc_ring {
+	waitq_t doorbell[IPC_RING_SIDES];
+
+	/** One of the peers has dropped its capability. */
+	atomic_bool closed;
+} ipc_ring_t;
+
+extern kobject_ops_t ring_kobject_ops;
+
+extern void ipc_ring_init(void);
+extern void ipc_ring_task_cleanup(void);
+
+extern sys_errno_t sys_ipc_ring_create(uspace_ptr_cap_ring_handle_t);
+extern sys_errno_t sys_ipc_ring_wait(cap_ring_handle_t, sysarg_t, uint32_t);
+extern sys_errno_t sys_ipc_ring_notify(cap_ring_handle_t, sysarg_t);
+extern sys_errno_t sys_ipc_ring_destroy(cap_ring_handle_t);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_KTRACE_H_
+#define KERN_KTRACE_H_
+
+#include <atomic.h>
+#include <stdint.h>
+#include <abi/ktrace.h>
+
+extern atomic_bool ktrace_enabled;
+
+extern void ktrace_init(void);
+extern void ktrace_write(ktrace_event_t, uint64_t, uint64_t, uint64_t);
+
+/** Record a tracepoint hit if the trace rings are available. */
+static inline void ktrace(ktrace_event_t event, uint64_t arg0, uint64_t arg1,
+    uint64_t arg2)
+{
+	if (atomic_load_explicit(&ktrace_enabled, memory_order_relaxed))
+		ktrace_write(event, arg0, arg1, arg2);
+}
+
+#endif
+
+/** @}
+ */
@@ -36,6 +36,7 @@
 #define KERN_AS_H_
 
 #include <typedefs.h>
+#include <atomic.h>
 #include <abi/mm/as.h>
 #include <arch/mm/page.h>
 #include <arch/mm/as.h>
@@ -43,6 +44,8 @@
 #include <arch/istate.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
+#include <adt/bdict.h>
+#include <adt/bitmap.h>
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <lib/elf.h>
@@ -72,9 +75,16 @@
 /** Kernel address space. */
 #define FLAG_AS_KERNEL  (1 << 0)
 
+/** Size of the window mapped on a fault in AS_AREA_FAULT_AROUND areas. */
+#define AS_FAULT_AROUND_PAGES  16
+
+/** Maximum number of pages mapped ahead in AS_AREA_PREFAULT areas. */
+#define AS_PREFAULT_PAGES_MAX  32
+
 /* Address space area attributes. */
 #define AS_AREA_ATTR_NONE     0
 #define AS_AREA_ATTR_PARTIAL  1  /**< Not fully initialized area. */
+#define AS_AREA_ATTR_COW      2  /**< Area may map copy-on-write pages. */
 
 /** The page fault was resolved by as_page_fault(). */
 #define AS_PF_OK     0
@@ -107,6 +117,13 @@ typedef struct as {
 	 */
 	size_t cpu_refcount;
 
+	/**
+	 * Processors which have run this address space since it was last
+	 * purged from all TLBs. NULL for the kernel address space, which is
+	 * used by all processors. Protected by asidlock.
+	 */
+	struct cpu_mask *cpu_mask;
+
 	/** Address space identifier.
 	 *
 	 * Constant on architectures that do not
@@ -126,6 +143,18 @@ typedef struct as {
 	 */
 	odict_t as_areas;
 
+	/**
+	 * Number of large page mappings. Protected by the page table lock.
+	 */
+	size_t large_pages;
+
+	/** Number of pages in all address space areas. */
+	atomic_size_t virt_pages;
+	/** Number of used pages in all address space areas. */
+	atomic_size_t resident_pages;
+	/** Statistics generation of the last change of the counters. */
+	atomic_size_t stats_gen;
+
 	/** Non-generic content. */
 	as_genarch_t genarch;
 
@@ -166,8 +195,6 @@ typedef struct as_pagemap {
 typedef struct {
 	/** Containing used_space structure */
 	struct used_space *used_space;
-	/** Link to @c used_space->ivals */
-	odlink_t lused_space;
 	/** First page address */
 	uintptr_t page;
 	/** Count of pages */
@@ -177,12 +204,14 @@ typedef struct {
 /** Map of used space in an address space area */
 typedef struct used_space {
 	/**
-	 * Dictionary of intervals by start address.
-	 * Members are of type @c used_space_ival_t.
+	 * Dictionary of intervals keyed by start address.
+	 * Values are of type @c used_space_ival_t.
 	 */
-	odict_t ivals;
+	bdict_t ivals;
 	/** Total number of used pages. */
 	size_t pages;
+	/** Address space accounting the used pages. */
+	struct as *as;
 } used_space_t;
 
 /**
@@ -197,6 +226,8 @@ typedef struct {
 	size_t refcount;
 	/** True if the area has been ever shared. */
 	bool shared;
+	/** Number of outstanding as_frames_pin() pins of the area frames. */
+	size_t pinned;
 
 	/** Complete map of anonymous pages of the shared area. */
 	as_pagemap_t pagemap;
@@ -241,6 +272,10 @@ typedef union mem_backend_data {
 	/** user_backend members */
 	struct {
 		as_area_pager_info_t pager_info;
+		/** Pages written to since they were last written back. */
+		bitmap_t dirty;
+		/** The pager supplied pages with AS_PAGER_WRITEBACK. */
+		bool writeback;
 	};
 
 } mem_backend_data_t;
@@ -285,6 +320,12 @@ typedef struct {
 
 	/** Data to be used by the backend. */
 	mem_backend_data_t backend_data;
+
+	/** Page expected to fault next if the access is sequential. */
+	uintptr_t next_fault;
+
+	/** Number of pages prefaulted on the last sequential fault. */
+	size_t prefault;
 } as_area_t;
 
 /** Address space area backend structure. */
@@ -299,6 +340,7 @@ typedef struct mem_backend {
 
 	int (*page_fault)(as_area_t *, uintptr_t, pf_access_t);
 	void (*frame_free)(as_area_t *, uintptr_t, uintptr_t);
+	errno_t (*sync)(as_area_t *, uintptr_t, size_t);
 
 	bool (*create_shared_data)(as_area_t *);
 	void (*destroy_shared_data)(void *);
@@ -324,6 +366,7 @@ extern errno_t as_area_resize(as_t *, uintptr_t, size_t, unsigned int);
 extern errno_t as_area_share(as_t *, uintptr_t, size_t, as_t *, unsigned int,
     uintptr_t *, uintptr_t);
 extern errno_t as_area_change_flags(as_t *, unsigned int, uintptr_t);
+extern errno_t as_area_sync(as_t *, uintptr_t, size_t);
 extern as_area_t *as_area_first(as_t *);
 extern as_area_t *as_area_next(as_area_t *);
 
@@ -338,6 +381,9 @@ extern void as_pagemap_remove(as_page_mapping_t *);
 extern unsigned int as_area_get_flags(as_area_t *);
 extern bool as_area_check_access(as_area_t *, pf_access_t);
 extern size_t as_area_get_size(uintptr_t);
+extern errno_t as_frames_pin(uintptr_t, size_t, bool, uintptr_t *,
+    share_info_t **);
+extern void as_frames_unpin(share_info_t *, uintptr_t *, size_t);
 extern used_space_ival_t *used_space_first(used_space_t *);
 extern used_space_ival_t *used_space_next(used_space_ival_t *);
 extern used_space_ival_t *used_space_find_gteq(used_space_t *, uintptr_t);
@@ -378,6 +424,7 @@ extern sys_errno_t sys_as_area_resize(uintptr_t, size_t, unsigned int);
 extern sys_errno_t sys_as_area_change_flags(uintptr_t, unsigned int);
 extern sys_errno_t sys_as_area_get_info(uintptr_t, uspace_ptr_as_area_info_t);
 extern sys_errno_t sys_as_area_destroy(uintptr_t);
+extern sys_errno_t sys_as_area_sync(uintptr_t, size_t);
 
 /* Introspection functions. */
 extern as_area_info_t *as_get_area_info(as_t *, size_t *);
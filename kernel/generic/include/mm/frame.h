@@ -47,6 +47,17 @@
 /** Maximum number of zones in the system. */
 #define ZONES_MAX  32
 
+/**
+ * Number of orders of the buddy allocator. The largest free block has
+ * 2^(ZONE_BUDDY_ORDERS - 1) frames.
+ */
+#define ZONE_BUDDY_ORDERS  20
+
+/** Buddy free list of blocks in memory above FRAME_LOWPRIO. */
+#define ZONE_BUDDY_LOWPRIO   0
+/** Buddy free list of blocks in memory below FRAME_LOWPRIO. */
+#define ZONE_BUDDY_HIGHPRIO  1
+
 typedef uint8_t frame_flags_t;
 
 #define FRAME_NONE        0x00
@@ -63,6 +74,10 @@ typedef uint8_t frame_flags_t;
  * Fall back to low memory if that fails.
  */
 #define FRAME_HIGHMEM     0x10
+/** Return zeroed frames, preferably from the pool of pre-zeroed frames. */
+#define FRAME_ZERO        0x20
+/** Place the frame according to the NUMA policy of the current task. */
+#define FRAME_POLICY      0x40
 
 // NOTE: If neither FRAME_LOWMEM nor FRAME_HIGHMEM is set, FRAME_LOWMEM is
 //       assumed as a safe default, and a runtime warning may be issued.
@@ -92,6 +107,15 @@ typedef uint8_t zone_flags_t;
 typedef struct {
 	size_t refcount;  /**< Tracking of shared frames */
 	void *parent;     /**< If allocated by slab, this points there */
+
+	/*
+	 * Buddy allocator links, only valid in the first frame of a free
+	 * block. The links are indices of frames within the zone so that
+	 * zone_t structures can be copied.
+	 */
+	size_t buddy_next;    /**< Next free block of the same order */
+	size_t buddy_prev;    /**< Previous free block of the same order */
+	uint8_t buddy_order;  /**< Order of the free block or BUDDY_ORDER_NONE */
 } frame_t;
 
 typedef struct {
@@ -110,9 +134,19 @@ typedef struct {
 	/** Type of the zone */
 	zone_flags_t flags;
 
-	/** Frame bitmap */
+	/** NUMA node of the zone memory */
+	unsigned int node;
+
+	/** Frame bitmap, set bits denote frames which are not free */
 	bitmap_t bitmap;
 
+	/**
+	 * Heads of the buddy free lists. The list free_head[c][k] contains
+	 * the free blocks of 2^k frames of priority class c, each aligned
+	 * to its size in the physical frame number space.
+	 */
+	size_t free_head[2][ZONE_BUDDY_ORDERS];
+
 	/** Array of frame_t structures in this zone */
 	frame_t *frames;
 } zone_t;
@@ -127,6 +161,32 @@ typedef struct {
 	zone_t info[ZONES_MAX];
 } zones_t;
 
+/** Number of frames a per-CPU frame cache list is refilled to. */
+#define FRAME_CACHE_LOW   16
+/** Capacity of a per-CPU frame cache list, reaching it drains the list. */
+#define FRAME_CACHE_HIGH  64
+
+/** Classes of frames kept in separate per-CPU frame cache lists. */
+typedef enum {
+	FRAME_CACHE_LOWMEM,   /**< Frames from ZONE_LOWMEM zones */
+	FRAME_CACHE_HIGHMEM,  /**< Frames from ZONE_HIGHMEM zones */
+	FRAME_CACHE_CLASSES
+} frame_cache_class_t;
+
+/** Per-CPU cache of single frames.
+ *
+ * The cached frames remain allocated in their zones, so that allocating
+ * and freeing single frames does not need to take zones.lock. The lists
+ * are refilled from and drained into the zones in batches.
+ */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+	size_t count[FRAME_CACHE_CLASSES];
+	pfn_t pfn[FRAME_CACHE_CLASSES][FRAME_CACHE_HIGH];
+	uint64_t hits;    /**< Allocations served from the cache */
+	uint64_t misses;  /**< Allocations which had to refill the cache */
+} frame_cache_t;
+
 extern zones_t zones;
 
 extern void frame_init(void);
@@ -138,7 +198,11 @@ extern void frame_free_generic(uintptr_t, size_t, frame_flags_t);
 extern void frame_free(uintptr_t, size_t);
 extern void frame_free_noreserve(uintptr_t, size_t);
 extern void frame_reference_add(pfn_t);
+extern size_t frame_reference_count(pfn_t);
 extern size_t frame_total_free_get(void);
+extern size_t frame_cache_trim(void);
+extern void frame_enable_cpucache(void);
+extern void frame_cache_stats(uint64_t *, uint64_t *);
 
 extern size_t find_zone(pfn_t, size_t, size_t);
 extern size_t zone_create(pfn_t, size_t, pfn_t, zone_flags_t);
@@ -149,8 +213,11 @@ extern size_t zone_conf_size(size_t);
 extern pfn_t zone_external_conf_alloc(size_t);
 extern bool zone_merge(size_t, size_t);
 extern void zone_merge_all(void);
+extern bool zone_split(size_t, pfn_t);
+extern void zones_numa_init(void);
 extern uint64_t zones_total_size(void);
-extern void zones_stats(uint64_t *, uint64_t *, uint64_t *, uint64_t *);
+extern void zones_stats(uint64_t *, uint64_t *, uint64_t *, uint64_t *,
+    uint64_t *, uint64_t *);
 
 /*
  * Console functions
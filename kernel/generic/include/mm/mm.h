@@ -45,6 +45,7 @@
 #define PAGE_WRITE_SHIFT		4
 #define PAGE_EXEC_SHIFT			5
 #define PAGE_GLOBAL_SHIFT		6
+#define PAGE_WRITE_COMBINE_SHIFT	7
 
 #define PAGE_NOT_CACHEABLE		(0 << PAGE_CACHEABLE_SHIFT)
 #define PAGE_CACHEABLE			(1 << PAGE_CACHEABLE_SHIFT)
@@ -61,6 +62,12 @@
 
 #define PAGE_GLOBAL			(1 << PAGE_GLOBAL_SHIFT)
 
+/*
+ * Only meaningful for non-cacheable mappings. Architectures which cannot
+ * combine writes map such pages as plain non-cacheable.
+ */
+#define PAGE_WRITE_COMBINE		(1 << PAGE_WRITE_COMBINE_SHIFT)
+
 #endif
 
 /** @}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_NUMA_H_
+#define KERN_NUMA_H_
+
+#include <stdbool.h>
+#include <typedefs.h>
+#include <abi/mm/numa.h>
+
+/** Maximum number of memory ranges with known node affinity. */
+#define NUMA_RANGES_MAX  32
+
+/** Maximum number of CPUs with known node affinity. */
+#define NUMA_CPUS_MAX  256
+
+/** Allocation from any node. */
+#define NUMA_NODE_ANY  ((unsigned int) -1)
+
+extern void numa_range_add(uint64_t, uint64_t, uint32_t);
+extern void numa_cpu_add(unsigned int, uint32_t);
+extern unsigned int numa_node_count(void);
+extern unsigned int numa_pfn_node(pfn_t);
+extern pfn_t numa_pfn_end(pfn_t);
+extern unsigned int numa_cpu_node(unsigned int);
+extern unsigned int numa_node_select(bool, bool *);
+
+#endif
+
+/** @}
+ */
@@ -46,6 +46,9 @@
 /** Operations to manipulate page mappings. */
 typedef struct {
 	void (*mapping_insert)(as_t *, uintptr_t, uintptr_t, unsigned int);
+	bool (*mapping_insert_large)(as_t *, uintptr_t, uintptr_t,
+	    unsigned int);
+	void (*mapping_split)(as_t *, uintptr_t, size_t);
 	void (*mapping_remove)(as_t *, uintptr_t);
 	bool (*mapping_find)(as_t *, uintptr_t, bool, pte_t *);
 	void (*mapping_update)(as_t *, uintptr_t, bool, pte_t *);
@@ -59,6 +62,9 @@ extern void page_table_lock(as_t *, bool);
 extern void page_table_unlock(as_t *, bool);
 extern bool page_table_locked(as_t *);
 extern void page_mapping_insert(as_t *, uintptr_t, uintptr_t, unsigned int);
+extern bool page_mapping_insert_large(as_t *, uintptr_t, uintptr_t,
+    unsigned int);
+extern void page_mapping_split(as_t *, uintptr_t, size_t);
 extern void page_mapping_remove(as_t *, uintptr_t);
 extern bool page_mapping_find(as_t *, uintptr_t, bool, pte_t *);
 extern void page_mapping_update(as_t *, uintptr_t, bool, pte_t *);
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_RECLAIM_H_
+#define KERN_RECLAIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <typedefs.h>
+
+/** The low watermark is this fraction of the memory (as a shift). */
+#define RECLAIM_LOW_SHIFT  6
+
+/** Minimum low watermark in frames. */
+#define RECLAIM_LOW_MIN  256
+
+/** Pause after a reclaim pass which freed nothing (microseconds). */
+#define RECLAIM_BACKOFF  (100 * 1000)
+
+extern void reclaim_init(size_t);
+extern void reclaim_wakeup(ssize_t);
+extern void reclaim_stats(uint64_t *, uint64_t *);
+extern void kreclaim(void *);
+
+#endif
+
+/** @}
+ */
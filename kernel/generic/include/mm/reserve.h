@@ -37,8 +37,10 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <typedefs.h>
 
 extern void reserve_init(void);
+extern ssize_t reserve_available(void);
 extern bool reserve_try_alloc(size_t);
 extern void reserve_force_alloc(size_t);
 extern void reserve_free(size_t);
@@ -38,11 +38,25 @@
 #include <adt/list.h>
 #include <synch/spinlock.h>
 #include <atomic.h>
+#include <cpu/pcpu_counter.h>
 #include <mm/frame.h>
+#include <abi/sysinfo.h>
 
-/** Initial Magazine size (TODO: dynamically growing magazines) */
+/** Initial magazine size */
 #define SLAB_MAG_SIZE  4
 
+/** Number of supported magazine sizes, each twice the previous one */
+#define SLAB_MAG_SIZES  5
+
+/** Largest magazine size */
+#define SLAB_MAG_SIZE_MAX  (SLAB_MAG_SIZE << (SLAB_MAG_SIZES - 1))
+
+/** Number of depot requests over which depot misses are counted */
+#define SLAB_MAG_RESIZE_WINDOW  64
+
+/** Full and empty magazines kept by each CPU besides the loaded ones */
+#define SLAB_MAG_CPU_SPARE  2
+
 /** If object size is less, store control structure inside SLAB */
 #define SLAB_INSIDE_SIZE  (PAGE_SIZE >> 3)
 
@@ -74,6 +88,16 @@ typedef struct {
 typedef struct {
 	slab_magazine_t *current;
 	slab_magazine_t *last;
+	/** Spare full magazines of this CPU */
+	slab_magazine_t *full[SLAB_MAG_CPU_SPARE];
+	size_t full_count;
+	/** Spare empty magazines of this CPU */
+	slab_magazine_t *empty[SLAB_MAG_CPU_SPARE];
+	size_t empty_count;
+	/** Allocations served from the magazines of this CPU */
+	uint64_t hits;
+	/** Allocations which found the magazines of this CPU empty */
+	uint64_t misses;
 	IRQ_SPINLOCK_DECLARE(lock);
 } slab_mag_cache_t;
 
@@ -103,6 +127,14 @@ typedef struct {
 	atomic_size_t cached_objs;
 	/** How many magazines in magazines list */
 	atomic_size_t magazine_counter;
+	/** Highest number of allocated objects */
+	atomic_size_t peak_objs;
+	pcpu_counter_t alloc_count;  /**< Number of object allocations */
+	pcpu_counter_t free_count;   /**< Number of object frees */
+	/** Number of slabs allocated from the frame allocator */
+	atomic_size_t grow_count;
+	/** Number of frames returned by slab_reclaim() */
+	atomic_size_t reclaimed_frames;
 
 	/* Slabs */
 	list_t full_slabs;     /**< List of full slabs */
@@ -111,6 +143,14 @@ typedef struct {
 	/* Magazines */
 	list_t magazines;  /**< List o full magazines */
 	IRQ_SPINLOCK_DECLARE(maglock);
+	/** Size of newly allocated magazines */
+	size_t mag_size;
+	/** Requests for a full magazine in the current resize window */
+	size_t mag_requests;
+	/** Requests which found no full magazine in the resize window */
+	size_t mag_misses;
+	size_t mag_gets;  /**< Full magazines taken from magazine list */
+	size_t mag_puts;  /**< Full magazines put to magazine list */
 
 	/** CPU cache */
 	slab_mag_cache_t *mag_cache;
@@ -132,6 +172,9 @@ extern void slab_enable_cpucache(void);
 /* kconsole debug */
 extern void slab_print_list(void);
 
+/* statistics */
+extern size_t slab_stats(stats_slab_t *, size_t);
+
 #endif
 
 /** @}
@@ -37,6 +37,10 @@
 
 #include <arch/mm/asid.h>
 #include <typedefs.h>
+#include <abi/sysinfo.h>
+
+struct as;
+struct cpu_mask;
 
 /**
  * Number of TLB shootdown messages that can be queued in processor tlb_messages
@@ -44,6 +48,15 @@
  */
 #define TLB_MESSAGE_QUEUE_LEN	10
 
+/** Maximum number of page ranges in one TLB shootdown batch. */
+#define TLB_BATCH_LEN  8
+
+/**
+ * Number of pages above which a user address space is flushed as a whole
+ * instead of page by page.
+ */
+#define TLB_FULL_FLUSH_PAGES  32
+
 /** Type of TLB shootdown message. */
 typedef enum {
 	/** Invalid type. */
@@ -64,16 +77,35 @@ typedef struct {
 	size_t count;			/**< Number of pages to invalidate. */
 } tlb_shootdown_msg_t;
 
+/** Batch of page ranges to be invalidated by a single TLB shootdown. */
+typedef struct {
+	/** CPUs which may cache the translations, NULL for all CPUs. */
+	struct cpu_mask *cpus;
+	asid_t asid;			/**< Address space identifier. */
+	size_t pages;			/**< Total number of queued pages. */
+	size_t count;			/**< Number of messages. */
+	tlb_shootdown_msg_t msgs[TLB_BATCH_LEN];
+} tlb_batch_t;
+
 extern void tlb_init(void);
 
+extern void tlb_batch_init(tlb_batch_t *, struct as *);
+extern void tlb_batch_add(tlb_batch_t *, uintptr_t, size_t);
+extern void tlb_batch_invalidate(tlb_batch_t *);
+extern void tlb_stats(stats_tlb_t *);
+
 #ifdef CONFIG_SMP
 extern ipl_t tlb_shootdown_start(tlb_invalidate_type_t, asid_t, uintptr_t,
     size_t);
+extern ipl_t tlb_batch_shootdown_start(tlb_batch_t *);
 extern void tlb_shootdown_finalize(ipl_t);
+extern void tlb_shootdown_sync(void);
 extern void tlb_shootdown_ipi_recv(void);
 #else
 #define tlb_shootdown_start(w, x, y, z)	interrupts_disable()
+#define tlb_batch_shootdown_start(b)	interrupts_disable()
 #define tlb_shootdown_finalize(i)	(interrupts_restore(i));
+#define tlb_shootdown_sync()
 #define tlb_shootdown_ipi_recv()
 #endif /* CONFIG_SMP */
 
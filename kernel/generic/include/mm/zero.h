@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_ZERO_H_
+#define KERN_ZERO_H_
+
+#include <typedefs.h>
+
+/** Number of zeroed frames kept in the pool. */
+#define ZERO_POOL_SIZE  256
+
+/** Refill the pool when it drops below this number of frames. */
+#define ZERO_POOL_LOW  (ZERO_POOL_SIZE / 2)
+
+/**
+ * Do not refill the pool unless at least this number of frames would
+ * remain free.
+ */
+#define ZERO_POOL_FREE_MIN  (ZERO_POOL_SIZE * 4)
+
+extern uintptr_t zero_pool_get(void);
+extern size_t zero_pool_drain(void);
+extern void zero_pool_stats(uint64_t *, uint64_t *, uint64_t *);
+extern void frame_zero(uintptr_t);
+extern void kzero(void *);
+
+#endif
+
+/** @}
+ */
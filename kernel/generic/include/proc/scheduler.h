@@ -39,11 +39,17 @@
 #include <synch/spinlock.h>
 #include <time/clock.h>
 #include <atomic.h>
+#include <cpu/pcpu_counter.h>
 #include <adt/list.h>
+#include <trace.h>
+#include <abi/proc/thread.h>
 
 #define RQ_COUNT          16
 #define NEEDS_RELINK_MAX  (HZ)
 
+/** Number of real-time run queues, rt_rq[i] has priority i. */
+#define RT_PRIO_COUNT  THREAD_RT_PRIORITIES
+
 /** Scheduler run queue structure. */
 typedef struct {
 	IRQ_SPINLOCK_DECLARE(lock);
@@ -51,7 +57,41 @@ typedef struct {
 	size_t n;			/**< Number of threads in rq_ready. */
 } runq_t;
 
-extern atomic_size_t nrdy;
+/** Bitmap of non-empty run queues.
+ *
+ * Bit i is set iff rq[i].n is non-zero. The same applies to the
+ * bitmap of the real-time run queues. The bit is only ever modified
+ * while holding rq[i].lock, but it may be read without any locks to
+ * quickly find the highest-priority candidate queue. The reader must
+ * re-check rq[i].n once it acquires rq[i].lock.
+ */
+typedef atomic_uint rq_bitmap_t;
+
+/** Mark run queue as non-empty.
+ *
+ * @param bitmap Run queue bitmap of the respective CPU.
+ * @param i      Index of the run queue (its lock must be held).
+ *
+ */
+_NO_TRACE static inline void rq_bitmap_set(rq_bitmap_t *bitmap,
+    unsigned int i)
+{
+	atomic_fetch_or(bitmap, 1U << i);
+}
+
+/** Mark run queue as empty.
+ *
+ * @param bitmap Run queue bitmap of the respective CPU.
+ * @param i      Index of the run queue (its lock must be held).
+ *
+ */
+_NO_TRACE static inline void rq_bitmap_clear(rq_bitmap_t *bitmap,
+    unsigned int i)
+{
+	atomic_fetch_and(bitmap, ~(1U << i));
+}
+
+extern pcpu_counter_t nrdy;
 extern void scheduler_init(void);
 
 extern void scheduler_fpu_lazy_request(void);
@@ -67,6 +107,11 @@ extern void before_task_runs_arch(void);
 extern void before_thread_runs_arch(void);
 extern void after_thread_ran_arch(void);
 
+#ifdef CONFIG_IDLE_POLL
+extern bool idle_monitor_arch(const volatile void *);
+extern void idle_mwait_arch(void);
+#endif
+
 #endif
 
 /** @}
@@ -41,6 +41,7 @@
 #include <ipc/kbox.h>
 #include <synch/spinlock.h>
 #include <synch/mutex.h>
+#include <synch/rcu.h>
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <security/perm.h>
@@ -55,6 +56,7 @@
 #include <mm/as.h>
 #include <abi/proc/task.h>
 #include <abi/sysinfo.h>
+#include <abi/mm/numa.h>
 #include <arch.h>
 #include <cap/cap.h>
 
@@ -67,6 +69,10 @@ struct cap;
 typedef struct task {
 	/** Link to @c tasks ordered dictionary */
 	odlink_t ltasks;
+	/** Next task in the same chain of the RCU task ID hash. */
+	struct task *hash_next;
+	/** Deferred reclamation of the structure. */
+	rcu_item_t rcu;
 
 	/** Task lock.
 	 *
@@ -129,6 +135,16 @@ typedef struct task {
 	/** Accumulated accounting. */
 	uint64_t ucycles;
 	uint64_t kcycles;
+	uint64_t rq_latency[STATS_LATENCY_BUCKETS];
+	/** Statistics generation of the last change. */
+	atomic_size_t stats_gen;
+
+	/** NUMA memory placement policy for user pages. */
+	numa_policy_t numa_policy;
+	/** Node used by NUMA_POLICY_BIND. */
+	unsigned int numa_node;
+	/** Interleave cursor used by NUMA_POLICY_INTERLEAVE. */
+	atomic_size_t numa_next;
 } task_t;
 
 /** Synchronize access to @c tasks */
@@ -143,12 +159,14 @@ extern void task_destroy(task_t *);
 extern void task_hold(task_t *);
 extern void task_release(task_t *);
 extern task_t *task_find_by_id(task_id_t);
+extern task_t *task_get_by_id(task_id_t);
 extern size_t task_count(void);
 extern task_t *task_first(void);
 extern task_t *task_next(task_t *);
 extern errno_t task_kill(task_id_t);
 extern void task_kill_self(bool) __attribute__((noreturn));
 extern void task_get_accounting(task_t *, uint64_t *, uint64_t *);
+extern void task_get_rq_latency(task_t *, uint64_t *);
 extern void task_print_list(bool);
 
 extern void perm_set(task_t *, perm_t);
@@ -171,6 +189,7 @@ extern sysarg_t sys_task_get_id(void);
 #endif
 
 extern sys_errno_t sys_task_set_name(uspace_ptr_const_char, size_t);
+extern sys_errno_t sys_task_set_numa(sysarg_t, sysarg_t);
 extern sys_errno_t sys_task_kill(uspace_ptr_task_id_t);
 extern sys_errno_t sys_task_exit(sysarg_t);
 
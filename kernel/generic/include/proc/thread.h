@@ -64,7 +64,9 @@ typedef enum {
 	/** Thread will be attached by the caller. */
 	THREAD_FLAG_NOATTACH = (1 << 1),
 	/** Thread accounting doesn't affect accumulated task accounting. */
-	THREAD_FLAG_UNCOUNTED = (1 << 2)
+	THREAD_FLAG_UNCOUNTED = (1 << 2),
+	/** Thread always runs from the lowest priority run queue. */
+	THREAD_FLAG_IDLE = (1 << 3)
 } thread_flags_t;
 
 /** Thread structure. There is one per thread. */
@@ -169,6 +171,8 @@ typedef struct thread {
 	cpu_t *cpu;
 	/** Containing task. */
 	task_t *task;
+	/** CPUs on which the thread may run, NULL if not restricted. */
+	struct cpu_mask *cpu_mask;
 	/** Thread is wired to CPU. */
 	bool wired;
 	/** Thread was migrated to another CPU and has not run yet. */
@@ -186,9 +190,34 @@ typedef struct thread {
 	uint64_t last_cycle;
 	/** Thread doesn't affect accumulated accounting. */
 	bool uncounted;
+	/** Thread runs at idle priority. */
+	bool idle;
+
+	/** Cycle at which the thread was last made ready. */
+	uint64_t ready_cycle;
+	/** Run queue latency histogram. */
+	uint64_t rq_latency[STATS_LATENCY_BUCKETS];
+	/** Statistics generation of the last change. */
+	atomic_size_t stats_gen;
 
 	/** Thread's priority. Implemented as index to CPU->rq */
 	int priority;
+
+	/** Real-time priority (index to CPU->rt_rq) or -1 if not real-time. */
+	int rt_priority;
+	/** Real-time budget per period in ticks, zero if unlimited. */
+	uint64_t rt_budget;
+	/** Real-time replenishment period in ticks. */
+	uint64_t rt_period;
+	/** Ticks of the budget consumed in the current period. */
+	uint64_t rt_used;
+	/** CPU tick at which the current period started. */
+	uint64_t rt_period_start;
+	/** Budget exhausted, the thread is time-shared until the period ends. */
+	bool rt_throttled;
+	/** CPU utilization reserved by admission control, in per mille. */
+	unsigned int rt_util;
+
 	/** Thread ID. */
 	thread_id_t tid;
 
@@ -219,6 +248,9 @@ extern thread_t *thread_create(void (*)(void *), void *, task_t *,
 extern void thread_wire(thread_t *, cpu_t *);
 extern void thread_attach(thread_t *, task_t *);
 extern void thread_ready(thread_t *);
+#ifdef CONFIG_IPC_HANDOFF
+extern bool thread_ready_handoff(thread_t *);
+#endif
 extern void thread_exit(void) __attribute__((noreturn));
 extern void thread_interrupt(thread_t *);
 extern bool thread_interrupted(thread_t *);
@@ -255,6 +287,22 @@ extern bool thread_exists(thread_t *);
 
 extern void thread_migration_disable(void);
 extern void thread_migration_enable(void);
+extern bool thread_may_run_on(thread_t *, cpu_t *);
+
+extern errno_t thread_set_rt(int, uint64_t, uint64_t);
+extern bool thread_rt_tick(thread_t *, uint64_t);
+
+/** Check whether the thread is scheduled in the real-time class.
+ *
+ * @param thread Thread with its lock held.
+ *
+ * @return True if the thread is real-time and not throttled.
+ *
+ */
+_NO_TRACE static inline bool thread_rt_active(thread_t *thread)
+{
+	return (thread->rt_priority >= 0) && (!thread->rt_throttled);
+}
 
 #ifdef CONFIG_UDEBUG
 extern void thread_stack_trace(thread_id_t);
@@ -270,6 +318,9 @@ extern sys_errno_t sys_thread_exit(int);
 extern sys_errno_t sys_thread_get_id(uspace_ptr_thread_id_t);
 extern sys_errno_t sys_thread_usleep(uint32_t);
 extern sys_errno_t sys_thread_udelay(uint32_t);
+extern sys_errno_t sys_thread_set_affinity(uspace_addr_t, size_t);
+extern sys_errno_t sys_thread_get_affinity(uspace_addr_t, size_t);
+extern sys_errno_t sys_thread_set_rt(sysarg_t, sysarg_t, sysarg_t);
 
 #endif
 
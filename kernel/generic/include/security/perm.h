@@ -70,6 +70,12 @@
  */
 #define PERM_IRQ_REG     (1 << 3)
 
+/**
+ * PERM_RT_SCHED entitles its holder to move its threads to the real-time
+ * scheduling class.
+ */
+#define PERM_RT_SCHED    (1 << 4)
+
 typedef uint32_t perm_t;
 
 #ifdef __32_BITS__
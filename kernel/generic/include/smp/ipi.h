@@ -37,12 +37,20 @@
 
 #ifdef CONFIG_SMP
 
+struct cpu;
+
 extern void ipi_broadcast(int);
 extern void ipi_broadcast_arch(int);
+extern void ipi_wakeup(struct cpu *);
+
+#if (defined CONFIG_TICKLESS) || (defined CONFIG_IDLE_POLL)
+extern void ipi_wakeup_arch(struct cpu *);
+#endif
 
 #else
 
 #define ipi_broadcast(ipi)
+#define ipi_wakeup(cpu)
 
 #endif /* CONFIG_SMP */
 
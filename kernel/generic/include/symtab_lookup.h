@@ -47,10 +47,14 @@ struct symtab_entry {
 extern errno_t symtab_name_lookup(uintptr_t, const char **, uintptr_t *);
 extern const char *symtab_fmt_name_lookup(uintptr_t);
 extern errno_t symtab_addr_lookup(const char *, uintptr_t *);
+extern void symtab_init(void);
 
 #ifdef CONFIG_SYMTAB
 
 /** Symtable linked together by build process
+ *
+ * Sorted by address and terminated by an entry with a zero address,
+ * followed by a hash index of the names.
  *
  */
 extern struct symtab_entry symbol_table[];
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_LOCKSTAT_H_
+#define KERN_LOCKSTAT_H_
+
+#ifdef CONFIG_LOCKSTAT
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <abi/sysinfo.h>
+
+/** Maximum number of distinct lock classes. */
+#define LOCKSTAT_CLASSES  1024
+
+/** Statistics of a lock class
+ *
+ * Spinlocks are grouped by their name, mutexes by the code
+ * location which initialized them.
+ */
+typedef struct lockstat {
+	/** Serializes updates of the counters. */
+	atomic_flag guard;
+
+	/** Spinlock name or NULL for mutexes. */
+	const char *name;
+	/** Return address of the mutex_initialize() call. */
+	uintptr_t site;
+
+	uint64_t acquired;         /**< Number of acquisitions. */
+	uint64_t contended;        /**< Acquisitions which had to wait. */
+	uint64_t wait_cycles;      /**< Cycles spent waiting for the lock. */
+	uint64_t max_hold_cycles;  /**< Longest time the lock was held. */
+	uint64_t spun;             /**< Contended mutex acquired by spinning. */
+	uint64_t slept;            /**< Contended mutex acquired by sleeping. */
+} lockstat_t;
+
+extern lockstat_t *lockstat_spinlock_class(const char *);
+extern lockstat_t *lockstat_mutex_class(uintptr_t);
+extern void lockstat_acquired(lockstat_t *, bool, uint64_t);
+extern void lockstat_released(lockstat_t *, uint64_t);
+extern void lockstat_mutex_waited(lockstat_t *, bool);
+extern void lockstat_class_name(lockstat_t *, char *, size_t);
+extern lockstat_t *lockstat_snapshot(size_t *);
+extern void lockstat_print(size_t);
+
+#endif /* CONFIG_LOCKSTAT */
+
+#endif
+
+/** @}
+ */
@@ -47,12 +47,20 @@ typedef enum {
 } mutex_type_t;
 
 struct thread;
+struct lockstat;
 
 typedef struct {
 	mutex_type_t type;
 	semaphore_t sem;
-	struct thread *owner;
+	/** Thread holding the mutex, read locklessly by spinning waiters. */
+	_Atomic(struct thread *) owner;
 	unsigned nesting;
+#ifdef CONFIG_LOCKSTAT
+	/** Lock class of the mutex. */
+	struct lockstat *stat;
+	/** Cycle at which the mutex was acquired. */
+	uint64_t hold_start;
+#endif
 } mutex_t;
 
 #define mutex_lock(mtx) \
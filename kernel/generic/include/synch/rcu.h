@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_RCU_H_
+#define KERN_RCU_H_
+
+#include <barrier.h>
+#include <preemption.h>
+#include <stdbool.h>
+
+struct rcu_item;
+
+/** Function invoked by rcu_call() once the grace period has elapsed. */
+typedef void (*rcu_func_t)(struct rcu_item *);
+
+/** Deferred callback, usually embedded in the structure to reclaim. */
+typedef struct rcu_item {
+	rcu_func_t func;
+	struct rcu_item *next;
+} rcu_item_t;
+
+/** Enter an RCU read-side critical section.
+ *
+ * Readers must not sleep. Read-side sections nest and may be entered
+ * from interrupt handlers.
+ */
+#define rcu_read_lock()  preemption_disable()
+
+/** Leave an RCU read-side critical section. */
+#define rcu_read_unlock()  preemption_enable()
+
+/** Publish a pointer to an initialized structure to RCU readers. */
+#define rcu_assign_pointer(ptr, value) \
+	do { \
+		write_barrier(); \
+		ACCESS_ONCE(ptr) = (value); \
+	} while (0)
+
+/** Load a pointer published by rcu_assign_pointer(). */
+#define rcu_dereference(ptr)  ACCESS_ONCE(ptr)
+
+extern void rcu_init(void);
+extern void rcu_qs(void);
+extern void rcu_idle_enter(void);
+extern void rcu_idle_exit(void);
+extern void rcu_exc_enter(bool);
+
+extern void rcu_call(rcu_item_t *, rcu_func_t);
+extern void rcu_barrier(void);
+
+extern void krcu(void *);
+
+#endif
+
+/** @}
+ */
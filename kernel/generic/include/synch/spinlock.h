@@ -38,6 +38,7 @@
 #include <assert.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <preemption.h>
 #include <arch/asm.h>
 
@@ -49,6 +50,13 @@ typedef struct spinlock {
 #ifdef CONFIG_DEBUG_SPINLOCK
 	const char *name;
 #endif /* CONFIG_DEBUG_SPINLOCK */
+
+#ifdef CONFIG_LOCKSTAT
+	/** Lock class, looked up on first acquisition. */
+	struct lockstat *stat;
+	/** Cycle at which the lock was acquired. */
+	uint64_t hold_start;
+#endif /* CONFIG_LOCKSTAT */
 } spinlock_t;
 
 /*
@@ -47,8 +47,10 @@ extern void sys_waitq_task_cleanup(void);
 
 extern sys_errno_t sys_waitq_create(uspace_ptr_cap_waitq_handle_t);
 extern sys_errno_t sys_waitq_sleep(cap_waitq_handle_t, uint32_t, unsigned int);
-extern sys_errno_t sys_waitq_wakeup(cap_waitq_handle_t);
+extern sys_errno_t sys_waitq_wakeup(cap_waitq_handle_t, sysarg_t);
 extern sys_errno_t sys_waitq_destroy(cap_waitq_handle_t);
+extern sys_errno_t sys_waitq_requeue(cap_waitq_handle_t, cap_waitq_handle_t,
+    sysarg_t, uspace_ptr_size_t);
 
 #endif
 
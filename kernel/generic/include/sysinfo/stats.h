@@ -35,6 +35,22 @@
 #ifndef KERN_STATS_H_
 #define KERN_STATS_H_
 
+#include <atomic.h>
+
+/** Current generation of task and thread statistics */
+extern atomic_size_t stats_generation;
+
+/** Mark statistics as changed in the current generation
+ *
+ * @param gen Generation of the last change of a task, thread
+ *            or address space.
+ *
+ */
+static inline void stats_touch(atomic_size_t *gen)
+{
+	atomic_store(gen, atomic_load(&stats_generation));
+}
+
 extern void kload(void *arg);
 extern void stats_init(void);
 
@@ -51,6 +51,21 @@ extern uptime_t *uptime;
 extern void clock(void);
 extern void clock_counter_init(void);
 
+#ifdef CONFIG_TICKLESS
+
+struct cpu;
+
+extern void clock_tick_stop_idle(void);
+extern void clock_tick_restart(void);
+
+/*
+ * To be defined by architectures supporting dynamic ticks.
+ */
+extern void tickless_arch_enter(uint64_t);
+extern uint64_t tickless_arch_exit(void);
+
+#endif /* CONFIG_TICKLESS */
+
 #endif
 
 /** @}
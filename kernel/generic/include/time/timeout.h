@@ -44,10 +44,10 @@ typedef void (*timeout_handler_t)(void *arg);
 typedef struct {
 	IRQ_SPINLOCK_DECLARE(lock);
 
-	/** Link to the list of active timeouts on CURRENT->cpu */
+	/** Link to the timeout wheel slot on CURRENT->cpu */
 	link_t link;
-	/** Timeout will be activated in this amount of clock() ticks. */
-	uint64_t ticks;
+	/** Value of cpu->timeout_now at which the timeout is activated. */
+	uint64_t deadline;
 	/** Function that will be called on timeout activation. */
 	timeout_handler_t handler;
 	/** Argument to be passed to handler() function. */
@@ -63,6 +63,8 @@ extern void timeout_initialize(timeout_t *);
 extern void timeout_reinitialize(timeout_t *);
 extern void timeout_register(timeout_t *, uint64_t, timeout_handler_t, void *);
 extern bool timeout_unregister(timeout_t *);
+extern uint64_t timeout_ticks_to_next(void);
+extern void timeout_process(void);
 
 #endif
 
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_adt
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_TYPES_BDICT_H_
+#define _LIBC_TYPES_BDICT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Maximum number of keys in a B+-tree node.
+ *
+ * Must be even. A node then fits in a few cache lines and the tree stays
+ * very shallow.
+ */
+#define BDICT_NODE_KEYS  30
+
+/** Key of an ordered B+-tree dictionary */
+typedef uintptr_t bdict_key_t;
+
+typedef struct bdict_node bdict_node_t;
+
+/** B+-tree node */
+struct bdict_node {
+	/** Number of keys in the node */
+	unsigned count;
+	/** True for leaves, which hold values rather than children */
+	bool leaf;
+	/** Keys in ascending order */
+	bdict_key_t key[BDICT_NODE_KEYS];
+	union {
+		/** Values of a leaf, @c value[i] belongs to @c key[i] */
+		void *value[BDICT_NODE_KEYS];
+		/**
+		 * Children of an inner node. Keys in @c child[i] are less than
+		 * @c key[i], which is less than or equal to the keys in
+		 * @c child[i + 1].
+		 */
+		bdict_node_t *child[BDICT_NODE_KEYS + 1];
+	};
+	/** Previous leaf in key order */
+	bdict_node_t *prev;
+	/** Next leaf in key order */
+	bdict_node_t *next;
+};
+
+/** Ordered dictionary implemented as a B+-tree */
+typedef struct {
+	/** Root node or @c NULL if the dictionary has never held a value */
+	bdict_node_t *root;
+	/** Number of values */
+	size_t count;
+} bdict_t;
+
+/** Position of a value in a B+-tree dictionary
+ *
+ * A cursor becomes invalid when the dictionary is modified.
+ */
+typedef struct {
+	/** Leaf holding the value */
+	bdict_node_t *leaf;
+	/** Index of the value in the leaf */
+	unsigned idx;
+} bdict_cursor_t;
+
+#endif
+
+/** @}
+ */
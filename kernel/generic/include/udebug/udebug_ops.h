@@ -55,6 +55,7 @@ errno_t udebug_args_read(thread_t *t, void **buffer);
 errno_t udebug_regs_read(thread_t *t, void **buffer);
 
 errno_t udebug_mem_read(uspace_addr_t uspace_addr, size_t n, void **buffer);
+errno_t udebug_word_write(uspace_addr_t uspace_addr, sysarg_t value);
 
 #endif
 
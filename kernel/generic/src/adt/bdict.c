@@ -0,0 +1,827 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_adt
+ * @{
+ */
+
+/** @file Ordered dictionary implemented as a B+-tree.
+ *
+ * Unlike odict, which links a red-black tree through the elements
+ * themselves, bdict keeps integer keys and value pointers in wide nodes.
+ * A lookup visits a handful of nodes and searches their keys in
+ * contiguous memory. Values live only in leaves and leaves are linked
+ * in key order, so iteration proceeds without going up the tree.
+ *
+ * Insertion and removal work top-down in a single pass. Full nodes are
+ * split on the way down to an insertion, and nodes with the minimum
+ * number of keys are refilled from a sibling or merged with it on the
+ * way down to a removal.
+ */
+
+#include <adt/bdict.h>
+#include <assert.h>
+#include <errno.h>
+#include <mem.h>
+#include <mm/slab.h>
+#include <stdbool.h>
+
+/** Nodes with at most this many keys are refilled before descending */
+#define BDICT_MIN_KEYS  (BDICT_NODE_KEYS / 2 - 1)
+
+/** Cache for bdict_node_t objects */
+static slab_cache_t *bdict_node_cache;
+
+/** Initialize the B+-tree dictionary subsystem. */
+void bdict_init(void)
+{
+	bdict_node_cache = slab_cache_create("bdict_node_t",
+	    sizeof(bdict_node_t), 0, NULL, NULL, 0);
+}
+
+/** Allocate a B+-tree node.
+ *
+ * Sleeps until memory is available, the same as allocating the objects
+ * stored in the dictionary usually does.
+ *
+ * @param leaf @c true to allocate a leaf
+ * @return New empty node
+ */
+static bdict_node_t *bdict_node_alloc(bool leaf)
+{
+	bdict_node_t *node = slab_alloc(bdict_node_cache, 0);
+	if (node == NULL)
+		return NULL;
+
+	node->count = 0;
+	node->leaf = leaf;
+	node->prev = NULL;
+	node->next = NULL;
+	return node;
+}
+
+/** Free a B+-tree node.
+ *
+ * @param node Node
+ */
+static void bdict_node_free(bdict_node_t *node)
+{
+	slab_free(bdict_node_cache, node);
+}
+
+/** Initialize ordered B+-tree dictionary.
+ *
+ * No memory is allocated until the first value is inserted.
+ *
+ * @param bdict Dictionary
+ */
+void bdict_initialize(bdict_t *bdict)
+{
+	bdict->root = NULL;
+	bdict->count = 0;
+}
+
+/** Free a subtree.
+ *
+ * @param node Root of the subtree
+ */
+static void bdict_free_subtree(bdict_node_t *node)
+{
+	unsigned i;
+
+	if (!node->leaf) {
+		for (i = 0; i <= node->count; i++)
+			bdict_free_subtree(node->child[i]);
+	}
+
+	bdict_node_free(node);
+}
+
+/** Finalize ordered B+-tree dictionary.
+ *
+ * Frees the tree nodes. Values still in the dictionary are not touched.
+ *
+ * @param bdict Dictionary
+ */
+void bdict_finalize(bdict_t *bdict)
+{
+	if (bdict->root != NULL)
+		bdict_free_subtree(bdict->root);
+
+	bdict->root = NULL;
+	bdict->count = 0;
+}
+
+/** Return number of keys in a node less than or equal to a key.
+ *
+ * In an inner node this is the index of the child which may contain
+ * @a key.
+ *
+ * @param node Node
+ * @param key Key
+ * @return Index of the first key greater than @a key
+ */
+static unsigned bdict_upper_bound(bdict_node_t *node, bdict_key_t key)
+{
+	unsigned lo = 0;
+	unsigned hi = node->count;
+
+	while (lo < hi) {
+		unsigned mid = (lo + hi) / 2;
+
+		if (node->key[mid] <= key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/** Return number of keys in a node less than a key.
+ *
+ * @param node Node
+ * @param key Key
+ * @return Index of the first key greater than or equal to @a key
+ */
+static unsigned bdict_lower_bound(bdict_node_t *node, bdict_key_t key)
+{
+	unsigned lo = 0;
+	unsigned hi = node->count;
+
+	while (lo < hi) {
+		unsigned mid = (lo + hi) / 2;
+
+		if (node->key[mid] < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/** Find leaf which may contain a key.
+ *
+ * @param bdict Dictionary, must not be empty
+ * @param key Key
+ * @return Leaf
+ */
+static bdict_node_t *bdict_find_leaf(bdict_t *bdict, bdict_key_t key)
+{
+	bdict_node_t *node = bdict->root;
+
+	while (!node->leaf)
+		node = node->child[bdict_upper_bound(node, key)];
+
+	return node;
+}
+
+/** Split full child of an inner node.
+ *
+ * @param parent Inner node which is not full
+ * @param i Index of the full child in @a parent
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t bdict_split_child(bdict_node_t *parent, unsigned i)
+{
+	bdict_node_t *child = parent->child[i];
+	bdict_node_t *right;
+	bdict_key_t sep;
+	unsigned keep;
+
+	assert(child->count == BDICT_NODE_KEYS);
+	assert(parent->count < BDICT_NODE_KEYS);
+
+	right = bdict_node_alloc(child->leaf);
+	if (right == NULL)
+		return ENOMEM;
+
+	keep = BDICT_NODE_KEYS / 2;
+
+	if (child->leaf) {
+		/* Right leaf gets the upper half, its first key separates */
+		right->count = BDICT_NODE_KEYS - keep;
+		memcpy(right->key, &child->key[keep],
+		    right->count * sizeof(bdict_key_t));
+		memcpy(right->value, &child->value[keep],
+		    right->count * sizeof(void *));
+		child->count = keep;
+		sep = right->key[0];
+
+		right->prev = child;
+		right->next = child->next;
+		if (child->next != NULL)
+			child->next->prev = right;
+		child->next = right;
+	} else {
+		/* The middle key moves up to the parent */
+		sep = child->key[keep];
+		right->count = BDICT_NODE_KEYS - keep - 1;
+		memcpy(right->key, &child->key[keep + 1],
+		    right->count * sizeof(bdict_key_t));
+		memcpy(right->child, &child->child[keep + 1],
+		    (right->count + 1) * sizeof(bdict_node_t *));
+		child->count = keep;
+	}
+
+	memmove(&parent->key[i + 1], &parent->key[i],
+	    (parent->count - i) * sizeof(bdict_key_t));
+	memmove(&parent->child[i + 2], &parent->child[i + 1],
+	    (parent->count - i) * sizeof(bdict_node_t *));
+	parent->key[i] = sep;
+	parent->child[i + 1] = right;
+	parent->count++;
+
+	return EOK;
+}
+
+/** Insert value into ordered B+-tree dictionary.
+ *
+ * @param bdict Dictionary
+ * @param key Key
+ * @param value Value, must not be @c NULL
+ * @return EOK on success, EEXIST if @a key is already present,
+ *         ENOMEM if out of memory
+ */
+errno_t bdict_insert(bdict_t *bdict, bdict_key_t key, void *value)
+{
+	bdict_node_t *node;
+	unsigned i;
+	errno_t rc;
+
+	assert(value != NULL);
+
+	if (bdict->root == NULL) {
+		bdict->root = bdict_node_alloc(true);
+		if (bdict->root == NULL)
+			return ENOMEM;
+	}
+
+	if (bdict->root->count == BDICT_NODE_KEYS) {
+		/* Grow the tree by one level */
+		node = bdict_node_alloc(false);
+		if (node == NULL)
+			return ENOMEM;
+
+		node->child[0] = bdict->root;
+		rc = bdict_split_child(node, 0);
+		if (rc != EOK) {
+			bdict_node_free(node);
+			return rc;
+		}
+
+		bdict->root = node;
+	}
+
+	node = bdict->root;
+	while (!node->leaf) {
+		i = bdict_upper_bound(node, key);
+		if (node->child[i]->count == BDICT_NODE_KEYS) {
+			rc = bdict_split_child(node, i);
+			if (rc != EOK)
+				return rc;
+
+			if (key >= node->key[i])
+				i++;
+		}
+
+		node = node->child[i];
+	}
+
+	i = bdict_lower_bound(node, key);
+	if (i < node->count && node->key[i] == key)
+		return EEXIST;
+
+	memmove(&node->key[i + 1], &node->key[i],
+	    (node->count - i) * sizeof(bdict_key_t));
+	memmove(&node->value[i + 1], &node->value[i],
+	    (node->count - i) * sizeof(void *));
+	node->key[i] = key;
+	node->value[i] = value;
+	node->count++;
+
+	bdict->count++;
+	return EOK;
+}
+
+/** Move first key of a child to its left sibling.
+ *
+ * @param parent Inner node
+ * @param i Index of the left sibling in @a parent
+ */
+static void bdict_shift_left(bdict_node_t *parent, unsigned i)
+{
+	bdict_node_t *left = parent->child[i];
+	bdict_node_t *right = parent->child[i + 1];
+
+	if (left->leaf) {
+		left->key[left->count] = right->key[0];
+		left->value[left->count] = right->value[0];
+		memmove(&right->key[0], &right->key[1],
+		    (right->count - 1) * sizeof(bdict_key_t));
+		memmove(&right->value[0], &right->value[1],
+		    (right->count - 1) * sizeof(void *));
+		parent->key[i] = right->key[0];
+	} else {
+		left->key[left->count] = parent->key[i];
+		left->child[left->count + 1] = right->child[0];
+		parent->key[i] = right->key[0];
+		memmove(&right->key[0], &right->key[1],
+		    (right->count - 1) * sizeof(bdict_key_t));
+		memmove(&right->child[0], &right->child[1],
+		    right->count * sizeof(bdict_node_t *));
+	}
+
+	left->count++;
+	right->count--;
+}
+
+/** Move last key of a child to its right sibling.
+ *
+ * @param parent Inner node
+ * @param i Index of the left sibling in @a parent
+ */
+static void bdict_shift_right(bdict_node_t *parent, unsigned i)
+{
+	bdict_node_t *left = parent->child[i];
+	bdict_node_t *right = parent->child[i + 1];
+
+	memmove(&right->key[1], &right->key[0],
+	    right->count * sizeof(bdict_key_t));
+
+	if (left->leaf) {
+		memmove(&right->value[1], &right->value[0],
+		    right->count * sizeof(void *));
+		right->key[0] = left->key[left->count - 1];
+		right->value[0] = left->value[left->count - 1];
+		parent->key[i] = right->key[0];
+	} else {
+		memmove(&right->child[1], &right->child[0],
+		    (right->count + 1) * sizeof(bdict_node_t *));
+		right->key[0] = parent->key[i];
+		right->child[0] = left->child[left->count];
+		parent->key[i] = left->key[left->count - 1];
+	}
+
+	left->count--;
+	right->count++;
+}
+
+/** Merge a child with its right sibling.
+ *
+ * @param parent Inner node
+ * @param i Index of the left sibling in @a parent
+ */
+static void bdict_merge(bdict_node_t *parent, unsigned i)
+{
+	bdict_node_t *left = parent->child[i];
+	bdict_node_t *right = parent->child[i + 1];
+
+	if (left->leaf) {
+		assert(left->count + right->count <= BDICT_NODE_KEYS);
+		memcpy(&left->key[left->count], right->key,
+		    right->count * sizeof(bdict_key_t));
+		memcpy(&left->value[left->count], right->value,
+		    right->count * sizeof(void *));
+		left->count += right->count;
+
+		left->next = right->next;
+		if (right->next != NULL)
+			right->next->prev = left;
+	} else {
+		assert(left->count + right->count + 1 <= BDICT_NODE_KEYS);
+		left->key[left->count] = parent->key[i];
+		memcpy(&left->key[left->count + 1], right->key,
+		    right->count * sizeof(bdict_key_t));
+		memcpy(&left->child[left->count + 1], right->child,
+		    (right->count + 1) * sizeof(bdict_node_t *));
+		left->count += right->count + 1;
+	}
+
+	memmove(&parent->key[i], &parent->key[i + 1],
+	    (parent->count - i - 1) * sizeof(bdict_key_t));
+	memmove(&parent->child[i + 1], &parent->child[i + 2],
+	    (parent->count - i - 1) * sizeof(bdict_node_t *));
+	parent->count--;
+
+	bdict_node_free(right);
+}
+
+/** Make sure a child has more than the minimum number of keys.
+ *
+ * @param parent Inner node
+ * @param i Index of the child in @a parent
+ * @return Index of the child which now covers the keys of the original one
+ */
+static unsigned bdict_refill_child(bdict_node_t *parent, unsigned i)
+{
+	if (parent->child[i]->count > BDICT_MIN_KEYS)
+		return i;
+
+	if (i > 0 && parent->child[i - 1]->count > BDICT_MIN_KEYS) {
+		bdict_shift_right(parent, i - 1);
+		return i;
+	}
+
+	if (i < parent->count && parent->child[i + 1]->count > BDICT_MIN_KEYS) {
+		bdict_shift_left(parent, i);
+		return i;
+	}
+
+	if (i > 0) {
+		bdict_merge(parent, i - 1);
+		return i - 1;
+	}
+
+	bdict_merge(parent, i);
+	return i;
+}
+
+/** Remove value from ordered B+-tree dictionary.
+ *
+ * @param bdict Dictionary
+ * @param key Key of the value to remove
+ * @return Removed value or @c NULL if @a key was not found
+ */
+void *bdict_remove(bdict_t *bdict, bdict_key_t key)
+{
+	bdict_node_t *node;
+	void *value;
+	unsigned i;
+
+	if (bdict->root == NULL)
+		return NULL;
+
+	node = bdict->root;
+	while (!node->leaf) {
+		i = bdict_refill_child(node, bdict_upper_bound(node, key));
+
+		if (node == bdict->root && node->count == 0) {
+			/* Root lost its last key in a merge, shrink the tree */
+			bdict->root = node->child[0];
+			bdict_node_free(node);
+			node = bdict->root;
+			continue;
+		}
+
+		node = node->child[i];
+	}
+
+	i = bdict_lower_bound(node, key);
+	if (i >= node->count || node->key[i] != key)
+		return NULL;
+
+	value = node->value[i];
+	memmove(&node->key[i], &node->key[i + 1],
+	    (node->count - i - 1) * sizeof(bdict_key_t));
+	memmove(&node->value[i], &node->value[i + 1],
+	    (node->count - i - 1) * sizeof(void *));
+	node->count--;
+
+	bdict->count--;
+	return value;
+}
+
+/** Return true if ordered B+-tree dictionary is empty.
+ *
+ * @param bdict Dictionary
+ * @return @c true if @a bdict is empty
+ */
+bool bdict_empty(bdict_t *bdict)
+{
+	return bdict->count == 0;
+}
+
+/** Return number of values in ordered B+-tree dictionary.
+ *
+ * @param bdict Dictionary
+ * @return Number of values
+ */
+size_t bdict_count(bdict_t *bdict)
+{
+	return bdict->count;
+}
+
+/** Return value at a position, moving across leaf boundaries.
+ *
+ * @param leaf Leaf or @c NULL
+ * @param idx Index in @a leaf, may equal the leaf's key count
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if there is no value at the position
+ */
+static void *bdict_at(bdict_node_t *leaf, unsigned idx,
+    bdict_cursor_t *cursor)
+{
+	if (leaf != NULL && idx >= leaf->count) {
+		leaf = leaf->next;
+		idx = 0;
+	}
+
+	if (leaf == NULL || leaf->count == 0)
+		return NULL;
+
+	if (cursor != NULL) {
+		cursor->leaf = leaf;
+		cursor->idx = idx;
+	}
+
+	return leaf->value[idx];
+}
+
+/** Return value before a position, moving across leaf boundaries.
+ *
+ * @param leaf Leaf
+ * @param idx Index in @a leaf of the value following the one to return
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if there is no such value
+ */
+static void *bdict_before(bdict_node_t *leaf, unsigned idx,
+    bdict_cursor_t *cursor)
+{
+	if (idx == 0) {
+		leaf = leaf->prev;
+		if (leaf == NULL)
+			return NULL;
+		idx = leaf->count;
+	}
+
+	return bdict_at(leaf, idx - 1, cursor);
+}
+
+/** Return first value in ordered B+-tree dictionary.
+ *
+ * @param bdict Dictionary
+ * @param cursor Cursor to fill in or @c NULL
+ * @return First value or @c NULL if @a bdict is empty
+ */
+void *bdict_first(bdict_t *bdict, bdict_cursor_t *cursor)
+{
+	bdict_node_t *node = bdict->root;
+
+	if (node == NULL)
+		return NULL;
+
+	while (!node->leaf)
+		node = node->child[0];
+
+	return bdict_at(node, 0, cursor);
+}
+
+/** Return last value in ordered B+-tree dictionary.
+ *
+ * @param bdict Dictionary
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Last value or @c NULL if @a bdict is empty
+ */
+void *bdict_last(bdict_t *bdict, bdict_cursor_t *cursor)
+{
+	bdict_node_t *node = bdict->root;
+
+	if (node == NULL || node->count == 0)
+		return NULL;
+
+	while (!node->leaf)
+		node = node->child[node->count];
+
+	return bdict_at(node, node->count - 1, cursor);
+}
+
+/** Advance cursor to the next value.
+ *
+ * @param cursor Cursor, updated to point to the next value
+ * @return Next value or @c NULL if there is none
+ */
+void *bdict_next(bdict_cursor_t *cursor)
+{
+	return bdict_at(cursor->leaf, cursor->idx + 1, cursor);
+}
+
+/** Move cursor to the previous value.
+ *
+ * @param cursor Cursor, updated to point to the previous value
+ * @return Previous value or @c NULL if there is none
+ */
+void *bdict_prev(bdict_cursor_t *cursor)
+{
+	return bdict_before(cursor->leaf, cursor->idx, cursor);
+}
+
+/** Return key of the value a cursor points to.
+ *
+ * @param cursor Cursor
+ * @return Key
+ */
+bdict_key_t bdict_cursor_key(bdict_cursor_t *cursor)
+{
+	return cursor->leaf->key[cursor->idx];
+}
+
+/** Find value with key equal to @a key.
+ *
+ * @param bdict Dictionary
+ * @param key Key
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if not found
+ */
+void *bdict_find_eq(bdict_t *bdict, bdict_key_t key, bdict_cursor_t *cursor)
+{
+	bdict_node_t *leaf;
+	unsigned i;
+
+	if (bdict->root == NULL)
+		return NULL;
+
+	leaf = bdict_find_leaf(bdict, key);
+	i = bdict_lower_bound(leaf, key);
+	if (i >= leaf->count || leaf->key[i] != key)
+		return NULL;
+
+	return bdict_at(leaf, i, cursor);
+}
+
+/** Find first value with key greater than or equal to @a key.
+ *
+ * @param bdict Dictionary
+ * @param key Key
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if not found
+ */
+void *bdict_find_geq(bdict_t *bdict, bdict_key_t key, bdict_cursor_t *cursor)
+{
+	bdict_node_t *leaf;
+
+	if (bdict->root == NULL)
+		return NULL;
+
+	leaf = bdict_find_leaf(bdict, key);
+	return bdict_at(leaf, bdict_lower_bound(leaf, key), cursor);
+}
+
+/** Find first value with key greater than @a key.
+ *
+ * @param bdict Dictionary
+ * @param key Key
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if not found
+ */
+void *bdict_find_gt(bdict_t *bdict, bdict_key_t key, bdict_cursor_t *cursor)
+{
+	bdict_node_t *leaf;
+
+	if (bdict->root == NULL)
+		return NULL;
+
+	leaf = bdict_find_leaf(bdict, key);
+	return bdict_at(leaf, bdict_upper_bound(leaf, key), cursor);
+}
+
+/** Find last value with key less than or equal to @a key.
+ *
+ * @param bdict Dictionary
+ * @param key Key
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if not found
+ */
+void *bdict_find_leq(bdict_t *bdict, bdict_key_t key, bdict_cursor_t *cursor)
+{
+	bdict_node_t *leaf;
+
+	if (bdict->root == NULL)
+		return NULL;
+
+	leaf = bdict_find_leaf(bdict, key);
+	return bdict_before(leaf, bdict_upper_bound(leaf, key), cursor);
+}
+
+/** Find last value with key less than @a key.
+ *
+ * @param bdict Dictionary
+ * @param key Key
+ * @param cursor Cursor to fill in or @c NULL
+ * @return Value or @c NULL if not found
+ */
+void *bdict_find_lt(bdict_t *bdict, bdict_key_t key, bdict_cursor_t *cursor)
+{
+	bdict_node_t *leaf;
+
+	if (bdict->root == NULL)
+		return NULL;
+
+	leaf = bdict_find_leaf(bdict, key);
+	return bdict_before(leaf, bdict_lower_bound(leaf, key), cursor);
+}
+
+/** Validate a subtree.
+ *
+ * @param node Root of the subtree
+ * @param lo Lower bound on keys, valid if @a has_lo is @c true
+ * @param has_lo @c true if @a lo applies
+ * @param hi Keys must be less than this, valid if @a has_hi is @c true
+ * @param has_hi @c true if @a hi applies
+ * @param depth Depth of @a node
+ * @param leaf_depth Depth of leaves, set when the first leaf is reached
+ * @param count Incremented by the number of values in the subtree
+ * @return EOK on success, EINVAL if the subtree is corrupt
+ */
+static errno_t bdict_validate_subtree(bdict_node_t *node, bdict_key_t lo,
+    bool has_lo, bdict_key_t hi, bool has_hi, unsigned depth,
+    unsigned *leaf_depth, size_t *count)
+{
+	unsigned i;
+	errno_t rc;
+
+	for (i = 0; i < node->count; i++) {
+		if (has_lo && node->key[i] < lo)
+			return EINVAL;
+		if (has_hi && node->key[i] >= hi)
+			return EINVAL;
+		if (i > 0 && node->key[i - 1] >= node->key[i])
+			return EINVAL;
+	}
+
+	if (node->leaf) {
+		if (*leaf_depth == 0)
+			*leaf_depth = depth;
+		else if (*leaf_depth != depth)
+			return EINVAL;
+
+		*count += node->count;
+		return EOK;
+	}
+
+	for (i = 0; i <= node->count; i++) {
+		rc = bdict_validate_subtree(node->child[i],
+		    (i > 0) ? node->key[i - 1] : lo, (i > 0) || has_lo,
+		    (i < node->count) ? node->key[i] : hi,
+		    (i < node->count) || has_hi, depth + 1, leaf_depth, count);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Validate ordered B+-tree dictionary.
+ *
+ * Checks key ordering, that all leaves are at the same depth, and that
+ * the leaf list and value count match the tree.
+ *
+ * @param bdict Dictionary
+ * @return EOK on success, EINVAL if the dictionary is corrupt
+ */
+errno_t bdict_validate(bdict_t *bdict)
+{
+	bdict_cursor_t cursor;
+	unsigned leaf_depth = 0;
+	size_t count = 0;
+	size_t listed = 0;
+	errno_t rc;
+
+	if (bdict->root == NULL)
+		return (bdict->count == 0) ? EOK : EINVAL;
+
+	rc = bdict_validate_subtree(bdict->root, 0, false, 0, false, 1,
+	    &leaf_depth, &count);
+	if (rc != EOK)
+		return rc;
+
+	if (count != bdict->count)
+		return EINVAL;
+
+	if (bdict_first(bdict, &cursor) != NULL) {
+		do {
+			++listed;
+		} while (bdict_next(&cursor) != NULL);
+	}
+
+	return (listed == count) ? EOK : EINVAL;
+}
+
+/** @}
+ */
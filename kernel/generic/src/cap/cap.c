@@ -73,27 +73,36 @@
  * kobject_get() or kobject_add_ref(). When the kernel object is removed from
  * the container, the reference count should go down via a call to
  * kobject_put().
+ *
+ * kobject_get() is the hot path of every IPC operation and looks the
+ * capability up in an RCU read-side section instead of taking the capability
+ * info lock. Capabilities and kobject_t wrappers are therefore reclaimed only
+ * after an RCU grace period.
  */
 
 #include <cap/cap.h>
 #include <abi/cap.h>
 #include <proc/task.h>
 #include <synch/mutex.h>
+#include <synch/rcu.h>
 #include <abi/errno.h>
 #include <mm/slab.h>
 #include <adt/list.h>
 #include <synch/syswaitq.h>
+#include <ipc/ring.h>
 #include <ipc/ipcrsc.h>
 #include <ipc/ipc.h>
 #include <ipc/irq.h>
 
-#include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <mem.h>
+#include <member.h>
+#include <barrier.h>
 
 #define CAPS_START	((intptr_t) CAP_NIL + 1)
-#define CAPS_SIZE	(INT_MAX - (int) CAPS_START)
-#define CAPS_LAST	(CAPS_SIZE - 1)
+#define CAPS_SIZE	(CAPS_LEAVES * CAPS_LEAF_SIZE - (int) CAPS_START)
+#define CAPS_LAST	(CAPS_START + CAPS_SIZE - 1)
 
 static slab_cache_t *cap_cache;
 static slab_cache_t *kobject_cache;
@@ -102,33 +111,39 @@ kobject_ops_t *kobject_ops[KOBJECT_TYPE_MAX] = {
 	[KOBJECT_TYPE_CALL] = &call_kobject_ops,
 	[KOBJECT_TYPE_IRQ] = &irq_kobject_ops,
 	[KOBJECT_TYPE_PHONE] = &phone_kobject_ops,
-	[KOBJECT_TYPE_WAITQ] = &waitq_kobject_ops
+	[KOBJECT_TYPE_WAITQ] = &waitq_kobject_ops,
+	[KOBJECT_TYPE_RING] = &ring_kobject_ops
 };
 
-static size_t caps_hash(const ht_link_t *item)
+/** Get the capability table slot of a capability handle
+ *
+ * @param info    Capability info of the task.
+ * @param handle  Valid capability handle.
+ * @param create  Allocate the table leaf if it does not exist yet.
+ *
+ * @return Address of the slot or NULL if the leaf does not exist and could
+ *         not be allocated.
+ */
+static cap_t **caps_table_slot(cap_info_t *info, cap_handle_t handle,
+    bool create)
 {
-	cap_t *cap = hash_table_get_inst(item, cap_t, caps_link);
-	return hash_mix(cap_handle_raw(cap->handle));
-}
+	uintptr_t raw = cap_handle_raw(handle);
+	cap_t **leaf = info->table[raw >> CAPS_LEAF_BITS];
 
-static size_t caps_key_hash(const void *key)
-{
-	const cap_handle_t *handle = key;
-	return hash_mix(cap_handle_raw(*handle));
-}
+	if (!leaf) {
+		if (!create)
+			return NULL;
 
-static bool caps_key_equal(const void *key, const ht_link_t *item)
-{
-	const cap_handle_t *handle = key;
-	cap_t *cap = hash_table_get_inst(item, cap_t, caps_link);
-	return *handle == cap->handle;
-}
+		leaf = malloc(CAPS_LEAF_SIZE * sizeof(cap_t *));
+		if (!leaf)
+			return NULL;
+		memsetb(leaf, CAPS_LEAF_SIZE * sizeof(cap_t *), 0);
 
-static hash_table_ops_t caps_ops = {
-	.hash = caps_hash,
-	.key_hash = caps_key_hash,
-	.key_equal = caps_key_equal
-};
+		rcu_assign_pointer(info->table[raw >> CAPS_LEAF_BITS], leaf);
+	}
+
+	return &leaf[raw & (CAPS_LEAF_SIZE - 1)];
+}
 
 void caps_init(void)
 {
@@ -152,8 +167,8 @@ errno_t caps_task_alloc(task_t *task)
 		goto error_handles;
 	if (!ra_span_add(task->cap_info->handles, CAPS_START, CAPS_SIZE))
 		goto error_span;
-	if (!hash_table_create(&task->cap_info->caps, 0, 0, &caps_ops))
-		goto error_span;
+	for (size_t i = 0; i < CAPS_LEAVES; i++)
+		task->cap_info->table[i] = NULL;
 	return EOK;
 
 error_span:
@@ -181,7 +196,8 @@ void caps_task_init(task_t *task)
  */
 void caps_task_free(task_t *task)
 {
-	hash_table_destroy(&task->cap_info->caps);
+	for (size_t i = 0; i < CAPS_LEAVES; i++)
+		free(task->cap_info->table[i]);
 	ra_arena_destroy(task->cap_info->handles);
 	free(task->cap_info);
 }
@@ -245,15 +261,40 @@ static cap_t *cap_get(task_t *task, cap_handle_t handle, cap_state_t state)
 	if ((cap_handle_raw(handle) < CAPS_START) ||
 	    (cap_handle_raw(handle) > CAPS_LAST))
 		return NULL;
-	ht_link_t *link = hash_table_find(&task->cap_info->caps, &handle);
-	if (!link)
+	cap_t **slot = caps_table_slot(task->cap_info, handle, false);
+	if (!slot)
 		return NULL;
-	cap_t *cap = hash_table_get_inst(link, cap_t, caps_link);
-	if (cap->state != state)
+	cap_t *cap = *slot;
+	if (!cap || cap->state != state)
 		return NULL;
 	return cap;
 }
 
+/** Get capability using capability handle without locking
+ *
+ * Must be called in an RCU read-side critical section. The state of the
+ * returned capability may change at any time.
+ *
+ * @param task    Task whose capability to get.
+ * @param handle  Capability handle of the desired capability.
+ *
+ * @return Address of the capability or NULL if there is none.
+ */
+static cap_t *cap_get_rcu(task_t *task, cap_handle_t handle)
+{
+	intptr_t raw = cap_handle_raw(handle);
+
+	if ((raw < CAPS_START) || (raw > CAPS_LAST))
+		return NULL;
+
+	cap_t **leaf = rcu_dereference(
+	    task->cap_info->table[raw >> CAPS_LEAF_BITS]);
+	if (!leaf)
+		return NULL;
+
+	return rcu_dereference(leaf[raw & (CAPS_LEAF_SIZE - 1)]);
+}
+
 /** Allocate new capability
  *
  * @param task  Task for which to allocate the new capability.
@@ -276,10 +317,18 @@ errno_t cap_alloc(task_t *task, cap_handle_t *handle)
 		mutex_unlock(&task->cap_info->lock);
 		return ENOMEM;
 	}
+	cap_t **slot = caps_table_slot(task->cap_info, (cap_handle_t) hbase,
+	    true);
+	if (!slot) {
+		ra_free(task->cap_info->handles, hbase, 1);
+		slab_free(cap_cache, cap);
+		mutex_unlock(&task->cap_info->lock);
+		return ENOMEM;
+	}
 	cap_initialize(cap, task, (cap_handle_t) hbase);
-	hash_table_insert(&task->cap_info->caps, &cap->caps_link);
-
 	cap->state = CAP_STATE_ALLOCATED;
+	rcu_assign_pointer(*slot, cap);
+
 	*handle = cap->handle;
 	mutex_unlock(&task->cap_info->lock);
 
@@ -303,11 +352,13 @@ cap_publish(task_t *task, cap_handle_t handle, kobject_t *kobj)
 	mutex_lock(&task->cap_info->lock);
 	cap_t *cap = cap_get(task, handle, CAP_STATE_ALLOCATED);
 	assert(cap);
-	cap->state = CAP_STATE_PUBLISHED;
 	/* Hand over kobj's reference to cap */
 	cap->kobject = kobj;
 	list_append(&cap->kobj_link, &kobj->caps_list);
 	list_append(&cap->type_link, &task->cap_info->type_list[kobj->type]);
+	/* Lockless readers must see the kobject once they see the state */
+	write_barrier();
+	cap->state = CAP_STATE_PUBLISHED;
 	mutex_unlock(&task->cap_info->lock);
 	mutex_unlock(&kobj->caps_list_lock);
 }
@@ -386,6 +437,12 @@ void cap_revoke(kobject_t *kobj)
 	mutex_unlock(&kobj->caps_list_lock);
 }
 
+/** Free a capability once no lockless lookup can see it. */
+static void cap_free_rcu(rcu_item_t *item)
+{
+	slab_free(cap_cache, member_to_inst(item, cap_t, rcu));
+}
+
 /** Free allocated capability
  *
  * @param task    Task in which to free the capability.
@@ -401,10 +458,11 @@ void cap_free(task_t *task, cap_handle_t handle)
 
 	assert(cap);
 
-	hash_table_remove_item(&task->cap_info->caps, &cap->caps_link);
+	ACCESS_ONCE(*caps_table_slot(task->cap_info, handle, false)) = NULL;
 	ra_free(task->cap_info->handles, cap_handle_raw(handle), 1);
-	slab_free(cap_cache, cap);
 	mutex_unlock(&task->cap_info->lock);
+
+	rcu_call(&cap->rcu, cap_free_rcu);
 }
 
 kobject_t *kobject_alloc(unsigned int flags)
@@ -417,6 +475,30 @@ void kobject_free(kobject_t *kobj)
 	slab_free(kobject_cache, kobj);
 }
 
+static void kobject_free_rcu(rcu_item_t *item)
+{
+	kobject_free(member_to_inst(item, kobject_t, rcu));
+}
+
+/** Add a reference to a kernel object unless it is being destroyed.
+ *
+ * @param kobj  Kernel object.
+ *
+ * @return True if a reference was added.
+ */
+static bool kobject_try_add_ref(kobject_t *kobj)
+{
+	size_t refs = atomic_load(&kobj->refcnt);
+
+	while (refs != 0) {
+		if (atomic_compare_exchange_weak(&kobj->refcnt, &refs,
+		    refs + 1))
+			return true;
+	}
+
+	return false;
+}
+
 /** Initialize kernel object
  *
  * @param kobj  Kernel object to initialize.
@@ -448,16 +530,38 @@ kobject_t *
 kobject_get(struct task *task, cap_handle_t handle, kobject_type_t type)
 {
 	kobject_t *kobj = NULL;
-
-	mutex_lock(&task->cap_info->lock);
-	cap_t *cap = cap_get(task, handle, CAP_STATE_PUBLISHED);
-	if (cap) {
-		if (cap->kobject->type == type) {
-			kobj = cap->kobject;
-			atomic_inc(&kobj->refcnt);
+	kobject_t *stale = NULL;
+
+	/*
+	 * The capability is looked up without the capability info lock.
+	 * Capabilities and kobject_t wrappers are reclaimed after a grace
+	 * period, but they may be unpublished or recycled at any time, so
+	 * the capability is checked again once a reference is held.
+	 */
+	rcu_read_lock();
+
+	cap_t *cap = cap_get_rcu(task, handle);
+	if ((cap) && (ACCESS_ONCE(cap->state) == CAP_STATE_PUBLISHED)) {
+		read_barrier();
+
+		kobject_t *cand = ACCESS_ONCE(cap->kobject);
+		if ((cand) && (kobject_try_add_ref(cand))) {
+			read_barrier();
+
+			if ((ACCESS_ONCE(cap->kobject) == cand) &&
+			    (ACCESS_ONCE(cap->state) == CAP_STATE_PUBLISHED) &&
+			    (cand->type == type))
+				kobj = cand;
+			else
+				stale = cand;
 		}
 	}
-	mutex_unlock(&task->cap_info->lock);
+
+	rcu_read_unlock();
+
+	/* Dropping the reference may destroy the object, which can sleep */
+	if (stale)
+		kobject_put(stale);
 
 	return kobj;
 }
@@ -474,15 +578,21 @@ void kobject_add_ref(kobject_t *kobj)
 /** Drop reference to kernel object
  *
  * The encapsulated object and the kobject_t wrapper are both destroyed when the
- * last reference is dropped.
+ * last reference is dropped, unless the object type recycles them.
  *
  * @param kobj  Kernel object whose reference to drop.
  */
 void kobject_put(kobject_t *kobj)
 {
 	if (atomic_postdec(&kobj->refcnt) == 1) {
+		if (KOBJECT_OP(kobj)->recycle &&
+		    KOBJECT_OP(kobj)->recycle(kobj->raw))
+			return;
+
 		KOBJECT_OP(kobj)->destroy(kobj->raw);
-		kobject_free(kobj);
+
+		/* Lockless kobject_get() may still be looking at kobj */
+		rcu_call(&kobj->rcu, kobject_free_rcu);
 	}
 }
 
@@ -76,6 +76,10 @@
 #include <test.h>
 #endif
 
+#ifdef CONFIG_LOCKSTAT
+#include <synch/lockstat.h>
+#endif
+
 /* Data and methods for 'help' command. */
 static int cmd_help(cmd_arg_t *argv);
 static cmd_info_t help_info = {
@@ -511,6 +515,23 @@ static cmd_info_t sysinfo_info = {
 	.argc = 0
 };
 
+#ifdef CONFIG_LOCKSTAT
+
+/* Data and methods for 'lockstat' command */
+static int cmd_lockstat(cmd_arg_t *argv);
+static cmd_arg_t lockstat_argv = {
+	.type = ARG_TYPE_INT,
+};
+static cmd_info_t lockstat_info = {
+	.name = "lockstat",
+	.description = "<count> List the most contended locks (0 for all).",
+	.func = cmd_lockstat,
+	.argc = 1,
+	.argv = &lockstat_argv
+};
+
+#endif /* CONFIG_LOCKSTAT */
+
 /* Data and methods for 'zones' command */
 static int cmd_zones(cmd_arg_t *argv);
 static cmd_info_t zones_info = {
@@ -596,6 +617,9 @@ static cmd_info_t *basic_commands[] = {
 	&help_info,
 	&ipc_info,
 	&kill_info,
+#ifdef CONFIG_LOCKSTAT
+	&lockstat_info,
+#endif
 	&physmem_info,
 	&reboot_info,
 	&sched_info,
@@ -1280,6 +1304,22 @@ int cmd_sched(cmd_arg_t *argv)
 	return 1;
 }
 
+#ifdef CONFIG_LOCKSTAT
+
+/** Command for printing lock contention statistics
+ *
+ * @param argv Integer argument from cmdline expected
+ *
+ * @return Always 1
+ */
+int cmd_lockstat(cmd_arg_t *argv)
+{
+	lockstat_print(argv[0].intval);
+	return 1;
+}
+
+#endif /* CONFIG_LOCKSTAT */
+
 /** Command for listing memory zones
  *
  * @param argv Ignored
@@ -36,6 +36,7 @@
  */
 
 #include <cpu.h>
+#include <cpu/pcpu_counter.h>
 #include <arch.h>
 #include <arch/cpu.h>
 #include <stdlib.h>
@@ -83,12 +84,30 @@ void cpu_init(void)
 			cpus[i].stack = (uint8_t *) PA2KA(stack_phys);
 			cpus[i].id = i;
 
+			pcpu_counter_area_init(&cpus[i]);
+
+			/*
+			 * Unless the architecture code tells us otherwise,
+			 * assume that the CPUs share nothing.
+			 */
+			cpus[i].topology.package = i;
+			cpus[i].topology.core = 0;
+			cpus[i].topology.llc = 0;
+			cpus[i].topology.node = 0;
+
 			irq_spinlock_initialize(&cpus[i].lock, "cpus[].lock");
+			irq_spinlock_initialize(&cpus[i].frame_cache.lock,
+			    "cpus[].frame_cache.lock");
 
 			for (unsigned int j = 0; j < RQ_COUNT; j++) {
 				irq_spinlock_initialize(&cpus[i].rq[j].lock, "cpus[].rq[].lock");
 				list_initialize(&cpus[i].rq[j].rq);
 			}
+
+			for (unsigned int j = 0; j < RT_PRIO_COUNT; j++) {
+				irq_spinlock_initialize(&cpus[i].rt_rq[j].lock, "cpus[].rt_rq[].lock");
+				list_initialize(&cpus[i].rt_rq[j].rq);
+			}
 		}
 
 #ifdef CONFIG_SMP
@@ -101,6 +120,7 @@ void cpu_init(void)
 	CPU->tlb_active = true;
 
 	CPU->idle = false;
+	atomic_store(&CPU->idle_state, CPU_IDLE_NONE);
 	CPU->last_cycle = get_cycle();
 	CPU->idle_cycles = 0;
 	CPU->busy_cycles = 0;
@@ -109,6 +129,25 @@ void cpu_init(void)
 	cpu_arch_init();
 }
 
+/** Account the end of an idle period of the current CPU
+ *
+ * Called when the CPU is woken up, be it by an interrupt or by a thread
+ * readied to it. Interrupts must be disabled.
+ *
+ */
+void cpu_idle_end(void)
+{
+	if (!CPU->idle)
+		return;
+
+	irq_spinlock_lock(&CPU->lock, false);
+	uint64_t now = get_cycle();
+	CPU->idle_cycles += now - CPU->last_cycle;
+	CPU->last_cycle = now;
+	CPU->idle = false;
+	irq_spinlock_unlock(&CPU->lock, false);
+}
+
 /** List all processors. */
 void cpu_list(void)
 {
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Per-CPU counters.
+ *
+ * Every CPU owns a counter area of PCPU_COUNTER_FRAMES frames, allocated
+ * when the CPU structures are initialized. A counter is an index into
+ * these areas, so the values of a single counter on different CPUs lie
+ * in different frames and never share a cache line. Updates disable
+ * interrupts instead of locking, which keeps the thread on its CPU and
+ * makes the update safe against interrupt handlers on the same CPU.
+ *
+ * Reads are not synchronized with updates. On 32-bit platforms a value
+ * of another CPU may be observed half-updated, which is acceptable for
+ * statistics.
+ */
+
+#include <cpu/pcpu_counter.h>
+#include <arch/asm.h>
+#include <assert.h>
+#include <config.h>
+#include <cpu.h>
+#include <mem.h>
+#include <mm/frame.h>
+#include <mm/page.h>
+#include <panic.h>
+#include <stdbool.h>
+#include <synch/spinlock.h>
+
+/** Number of slots in the counter area of each CPU. */
+#define PCPU_COUNTER_SLOTS \
+	(FRAMES2SIZE(PCPU_COUNTER_FRAMES) / sizeof(int64_t))
+
+/** Protects slot allocation and the shared values of counters. */
+IRQ_SPINLOCK_STATIC_INITIALIZE(pcpu_counter_lock);
+
+/**
+ * Slot usage. Slot zero is never handed out, so that zero-initialized
+ * counters are valid and use their shared value.
+ */
+static bool slot_used[PCPU_COUNTER_SLOTS];
+
+/** Lowest slot which may be free. */
+static size_t slot_hint = 1;
+
+/** Allocate the counter area of a CPU
+ *
+ * @param cpu CPU structure being initialized.
+ *
+ */
+void pcpu_counter_area_init(cpu_t *cpu)
+{
+	uintptr_t phys = frame_alloc(PCPU_COUNTER_FRAMES,
+	    FRAME_LOWMEM | FRAME_ATOMIC, 0);
+	if (!phys)
+		panic("Cannot allocate per-CPU counter area.");
+
+	cpu->counters = (int64_t *) PA2KA(phys);
+	memsetb(cpu->counters, FRAMES2SIZE(PCPU_COUNTER_FRAMES), 0);
+}
+
+/** Zero the slot of a counter on all CPUs
+ *
+ * Must be called with pcpu_counter_lock held.
+ *
+ */
+static void slot_clear(size_t slot)
+{
+	if ((slot == 0) || (cpus == NULL))
+		return;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		if (cpus[i].counters != NULL)
+			cpus[i].counters[slot] = 0;
+	}
+}
+
+/** Initialize per-CPU counter
+ *
+ * Assigns a slot to the counter and sets its value to zero. When no
+ * slot is free, the counter keeps working with the shared value only.
+ *
+ * @param counter Counter to initialize.
+ *
+ */
+void pcpu_counter_initialize(pcpu_counter_t *counter)
+{
+	irq_spinlock_lock(&pcpu_counter_lock, true);
+
+	counter->slot = 0;
+	counter->shared = 0;
+
+	for (size_t i = slot_hint; i < PCPU_COUNTER_SLOTS; i++) {
+		if (!slot_used[i]) {
+			slot_used[i] = true;
+			slot_hint = i + 1;
+			slot_clear(i);
+			counter->slot = i;
+			break;
+		}
+	}
+
+	irq_spinlock_unlock(&pcpu_counter_lock, true);
+}
+
+/** Release the slot of a per-CPU counter
+ *
+ * The counter must not be updated concurrently.
+ *
+ * @param counter Counter to destroy.
+ *
+ */
+void pcpu_counter_destroy(pcpu_counter_t *counter)
+{
+	irq_spinlock_lock(&pcpu_counter_lock, true);
+
+	if (counter->slot != 0) {
+		assert(slot_used[counter->slot]);
+
+		slot_used[counter->slot] = false;
+		if (counter->slot < slot_hint)
+			slot_hint = counter->slot;
+
+		counter->slot = 0;
+	}
+
+	irq_spinlock_unlock(&pcpu_counter_lock, true);
+}
+
+/** Set per-CPU counter to zero
+ *
+ * Updates running concurrently on other CPUs may or may not be lost.
+ *
+ * @param counter Counter to reset.
+ *
+ */
+void pcpu_counter_reset(pcpu_counter_t *counter)
+{
+	irq_spinlock_lock(&pcpu_counter_lock, true);
+
+	counter->shared = 0;
+	slot_clear(counter->slot);
+
+	irq_spinlock_unlock(&pcpu_counter_lock, true);
+}
+
+/** Add to per-CPU counter
+ *
+ * @param counter Counter to update.
+ * @param val     Value to add, may be negative.
+ *
+ */
+void pcpu_counter_add(pcpu_counter_t *counter, int64_t val)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if ((counter->slot != 0) && (CPU != NULL) && (CPU->counters != NULL)) {
+		CPU->counters[counter->slot] += val;
+	} else {
+		irq_spinlock_lock(&pcpu_counter_lock, false);
+		counter->shared += val;
+		irq_spinlock_unlock(&pcpu_counter_lock, false);
+	}
+
+	interrupts_restore(ipl);
+}
+
+/** Read per-CPU counter
+ *
+ * @param counter Counter to read.
+ *
+ * @return Sum of the values of the counter on all CPUs.
+ *
+ */
+int64_t pcpu_counter_sum(pcpu_counter_t *counter)
+{
+	irq_spinlock_lock(&pcpu_counter_lock, true);
+	int64_t sum = counter->shared;
+	irq_spinlock_unlock(&pcpu_counter_lock, true);
+
+	size_t slot = counter->slot;
+	if ((slot == 0) || (cpus == NULL))
+		return sum;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		volatile int64_t *area = cpus[i].counters;
+		if (area != NULL)
+			sum += area[slot];
+	}
+
+	return sum;
+}
+
+/** Read per-CPU counter which never drops below zero
+ *
+ * The per-CPU values are not read at a single instant, so the sum of
+ * a counter which is both incremented and decremented may transiently
+ * be negative.
+ *
+ * @param counter Counter to read.
+ *
+ * @return Sum of the values of the counter on all CPUs, at least zero.
+ *
+ */
+uint64_t pcpu_counter_sum_positive(pcpu_counter_t *counter)
+{
+	int64_t sum = pcpu_counter_sum(counter);
+	return (sum > 0) ? (uint64_t) sum : 0;
+}
+
+/** @}
+ */
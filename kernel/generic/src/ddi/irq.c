@@ -36,18 +36,30 @@
  * This file provides means of connecting IRQs with respective device drivers
  * and logic for dispatching interrupts to IRQ handlers defined by those
  * drivers.
+ *
+ * It also keeps track of which CPU each INR is routed to. Device interrupts
+ * subscribed from uspace are spread over the CPUs round-robin, unless a
+ * driver asks for a particular CPU, so that no single CPU ends up serving
+ * all of them.
  */
 
 #include <ddi/irq.h>
 #include <adt/hash.h>
-#include <adt/hash_table.h>
 #include <mm/slab.h>
 #include <typedefs.h>
 #include <synch/spinlock.h>
 #include <console/console.h>
 #include <interrupt.h>
 #include <mem.h>
+#include <macros.h>
 #include <arch.h>
+#include <atomic.h>
+#include <config.h>
+#include <cpu.h>
+#include <errno.h>
+#include <security/perm.h>
+#include <stdlib.h>
+#include <syscall/copy.h>
 
 slab_cache_t *irq_cache = NULL;
 
@@ -59,7 +71,7 @@ slab_cache_t *irq_cache = NULL;
 IRQ_SPINLOCK_STATIC_INITIALIZE(irq_kernel_hash_table_lock);
 
 /** The kernel IRQ hash table. */
-static hash_table_t irq_kernel_hash_table;
+static irq_hash_t irq_kernel_hash_table;
 
 /** Spinlock protecting the uspace IRQ hash table
  *
@@ -69,23 +81,93 @@ static hash_table_t irq_kernel_hash_table;
 IRQ_SPINLOCK_INITIALIZE(irq_uspace_hash_table_lock);
 
 /** The uspace IRQ hash table */
-hash_table_t irq_uspace_hash_table;
-
-static size_t irq_ht_hash(const ht_link_t *);
-static size_t irq_ht_key_hash(const void *);
-static bool irq_ht_equal(const ht_link_t *, const ht_link_t *);
-static bool irq_ht_key_equal(const void *, const ht_link_t *);
-
-static hash_table_ops_t irq_ht_ops = {
-	.hash = irq_ht_hash,
-	.key_hash = irq_ht_key_hash,
-	.equal = irq_ht_equal,
-	.key_equal = irq_ht_key_equal
-};
+irq_hash_t irq_uspace_hash_table;
 
 /** Last valid INR */
 inr_t last_inr = 0;
 
+/** Spinlock protecting the IRQ affinity table and the router */
+IRQ_SPINLOCK_STATIC_INITIALIZE(irq_affinity_lock);
+
+/** CPU each INR is routed to, IRQ_CPU_ANY if not chosen yet */
+static unsigned int *irq_affinity = NULL;
+
+/** Interrupt controller hook moving INRs between CPUs */
+static irq_route_t irq_route = NULL;
+
+/** Next CPU of the round-robin default distribution */
+static atomic_size_t irq_affinity_cursor = 0;
+
+/** Create an empty IRQ hash table
+ *
+ * The number of chains is fixed, so that readers need not care about
+ * the table being resized.
+ *
+ * @param h      IRQ hash table.
+ * @param chains Number of chains.
+ *
+ */
+static void irq_hash_create(irq_hash_t *h, size_t chains)
+{
+	h->chains = max(chains, 1);
+	h->chain = malloc(h->chains * sizeof(irq_t *));
+	assert(h->chain);
+
+	for (size_t i = 0; i < h->chains; i++)
+		h->chain[i] = NULL;
+}
+
+/** Get the chain of an IRQ hash table where an INR belongs. */
+static irq_t **irq_hash_chain(irq_hash_t *h, inr_t inr)
+{
+	return &h->chain[hash_mix(inr) % h->chains];
+}
+
+/** Insert IRQ structure into an IRQ hash table
+ *
+ * The structure is appended to its chain, so that IRQ structures
+ * sharing an INR are dispatched in the order of insertion. The caller
+ * must hold the lock of the table and of @a irq.
+ *
+ * @param h   IRQ hash table.
+ * @param irq IRQ structure with the INR set.
+ *
+ */
+void irq_hash_insert(irq_hash_t *h, irq_t *irq)
+{
+	assert(irq_spinlock_locked(&irq->lock));
+
+	irq_t **pprev = irq_hash_chain(h, irq->inr);
+	while (*pprev != NULL)
+		pprev = &(*pprev)->next;
+
+	irq->next = NULL;
+	irq->hashed = true;
+	rcu_assign_pointer(*pprev, irq);
+}
+
+/** Remove IRQ structure from an IRQ hash table
+ *
+ * Readers may still find the structure until a grace period elapses,
+ * but they will skip it as it is no longer hashed. The caller must hold
+ * the lock of the table and of @a irq.
+ *
+ * @param h   IRQ hash table.
+ * @param irq IRQ structure in the table.
+ *
+ */
+void irq_hash_remove(irq_hash_t *h, irq_t *irq)
+{
+	assert(irq_spinlock_locked(&irq->lock));
+
+	irq_t **pprev = irq_hash_chain(h, irq->inr);
+	while (*pprev != irq)
+		pprev = &(*pprev)->next;
+
+	rcu_assign_pointer(*pprev, irq->next);
+	irq->hashed = false;
+}
+
 /** Initialize IRQ subsystem
  *
  * @param inrs    Numbers of unique IRQ numbers or INRs.
@@ -100,8 +182,16 @@ void irq_init(size_t inrs, size_t chains)
 	    FRAME_ATOMIC);
 	assert(irq_cache);
 
-	hash_table_create(&irq_uspace_hash_table, chains, 0, &irq_ht_ops);
-	hash_table_create(&irq_kernel_hash_table, chains, 0, &irq_ht_ops);
+	irq_hash_create(&irq_uspace_hash_table, chains);
+	irq_hash_create(&irq_kernel_hash_table, chains);
+
+	if (inrs > 0) {
+		irq_affinity = malloc(inrs * sizeof(unsigned int));
+		assert(irq_affinity);
+
+		for (size_t i = 0; i < inrs; i++)
+			irq_affinity[i] = IRQ_CPU_ANY;
+	}
 }
 
 /** Initialize one IRQ structure
@@ -130,29 +220,36 @@ void irq_register(irq_t *irq)
 {
 	irq_spinlock_lock(&irq_kernel_hash_table_lock, true);
 	irq_spinlock_lock(&irq->lock, false);
-	hash_table_insert(&irq_kernel_hash_table, &irq->link);
+	irq_hash_insert(&irq_kernel_hash_table, irq);
 	irq_spinlock_unlock(&irq->lock, false);
 	irq_spinlock_unlock(&irq_kernel_hash_table_lock, true);
 }
 
-/** Search and lock an IRQ hash table */
-static irq_t *
-irq_dispatch_and_lock_table(hash_table_t *h, irq_spinlock_t *l, inr_t inr)
+/** Search and lock an IRQ hash table
+ *
+ * The table is searched without its lock. IRQ structures are reclaimed
+ * only after an RCU grace period and a removed one is recognized once
+ * its lock is held.
+ */
+static irq_t *irq_dispatch_and_lock_table(irq_hash_t *h, inr_t inr)
 {
-	irq_spinlock_lock(l, false);
-	ht_link_t *first = hash_table_find(h, &inr);
-	for (ht_link_t *lnk = first; lnk;
-	    lnk = hash_table_find_next(h, first, lnk)) {
-		irq_t *irq = hash_table_get_inst(lnk, irq_t, link);
+	rcu_read_lock();
+
+	irq_t *irq = rcu_dereference(*irq_hash_chain(h, inr));
+	for (; irq; irq = rcu_dereference(irq->next)) {
+		if (irq->inr != inr)
+			continue;
+
 		irq_spinlock_lock(&irq->lock, false);
-		if (irq->claim(irq) == IRQ_ACCEPT) {
+		if ((irq->hashed) && (irq->claim(irq) == IRQ_ACCEPT)) {
 			/* leave irq locked */
-			irq_spinlock_unlock(l, false);
+			rcu_read_unlock();
 			return irq;
 		}
 		irq_spinlock_unlock(&irq->lock, false);
 	}
-	irq_spinlock_unlock(l, false);
+
+	rcu_read_unlock();
 
 	return NULL;
 }
@@ -182,51 +279,164 @@ irq_t *irq_dispatch_and_lock(inr_t inr)
 
 	if (console_override) {
 		irq_t *irq = irq_dispatch_and_lock_table(&irq_kernel_hash_table,
-		    &irq_kernel_hash_table_lock, inr);
+		    inr);
 		if (irq)
 			return irq;
 
 		return irq_dispatch_and_lock_table(&irq_uspace_hash_table,
-		    &irq_uspace_hash_table_lock, inr);
+		    inr);
 	}
 
-	irq_t *irq = irq_dispatch_and_lock_table(&irq_uspace_hash_table,
-	    &irq_uspace_hash_table_lock, inr);
+	irq_t *irq = irq_dispatch_and_lock_table(&irq_uspace_hash_table, inr);
 	if (irq)
 		return irq;
 
-	return irq_dispatch_and_lock_table(&irq_kernel_hash_table,
-	    &irq_kernel_hash_table_lock, inr);
+	return irq_dispatch_and_lock_table(&irq_kernel_hash_table, inr);
 }
 
-/** Return the hash of the key stored in the item. */
-size_t irq_ht_hash(const ht_link_t *item)
+/** Register the interrupt controller hook which routes INRs to CPUs.
+ *
+ * @param route Routing hook
+ */
+void irq_route_register(irq_route_t route)
 {
-	irq_t *irq = hash_table_get_inst(item, irq_t, link);
-	return hash_mix(irq->inr);
+	irq_spinlock_lock(&irq_affinity_lock, true);
+	irq_route = route;
+	irq_spinlock_unlock(&irq_affinity_lock, true);
 }
 
-/** Return the hash of the key. */
-size_t irq_ht_key_hash(const void *key)
+/** Route an INR to a CPU.
+ *
+ * @param inr INR to route
+ * @param cpu ID of an active CPU
+ *
+ * @return EOK on success, EINVAL if @a inr or @a cpu is out of range,
+ *         ENOTSUP if the platform cannot route @a inr
+ */
+errno_t irq_affinity_set(inr_t inr, unsigned int cpu)
+{
+	if ((inr < 0) || (inr > last_inr) || (irq_affinity == NULL))
+		return EINVAL;
+
+	if ((cpu >= config.cpu_count) || (!cpus[cpu].active))
+		return EINVAL;
+
+	irq_spinlock_lock(&irq_affinity_lock, true);
+
+	if (irq_route == NULL) {
+		irq_spinlock_unlock(&irq_affinity_lock, true);
+		return ENOTSUP;
+	}
+
+	errno_t rc = irq_route(inr, cpu);
+	if (rc == EOK)
+		irq_affinity[inr] = cpu;
+
+	irq_spinlock_unlock(&irq_affinity_lock, true);
+	return rc;
+}
+
+/** Get the CPU an INR is routed to.
+ *
+ * @param inr INR
+ *
+ * @return ID of the CPU or IRQ_CPU_ANY if no particular CPU was chosen
+ */
+unsigned int irq_affinity_get(inr_t inr)
+{
+	if ((inr < 0) || (inr > last_inr) || (irq_affinity == NULL))
+		return IRQ_CPU_ANY;
+
+	irq_spinlock_lock(&irq_affinity_lock, true);
+	unsigned int cpu = irq_affinity[inr];
+	irq_spinlock_unlock(&irq_affinity_lock, true);
+
+	return cpu;
+}
+
+/** Note the CPU an INR has been routed to by other means.
+ *
+ * Used for interrupts whose destination is fixed when they are set up,
+ * such as message signalled ones.
+ *
+ * @param inr INR
+ * @param cpu ID of the CPU
+ */
+void irq_affinity_record(inr_t inr, unsigned int cpu)
+{
+	if ((inr < 0) || (inr > last_inr) || (irq_affinity == NULL))
+		return;
+
+	irq_spinlock_lock(&irq_affinity_lock, true);
+	irq_affinity[inr] = cpu;
+	irq_spinlock_unlock(&irq_affinity_lock, true);
+}
+
+/** Pick the next CPU of the round-robin default distribution.
+ *
+ * @return ID of an active CPU
+ */
+unsigned int irq_affinity_next(void)
 {
-	const inr_t *inr = key;
-	return hash_mix(*inr);
+	size_t active = config.cpu_active;
+	if (active == 0)
+		return 0;
+
+	/* Active CPUs are numbered from zero */
+	return atomic_fetch_add_explicit(&irq_affinity_cursor, 1,
+	    memory_order_relaxed) % active;
 }
 
-/** Return true if the items have the same lookup key. */
-bool irq_ht_equal(const ht_link_t *item1, const ht_link_t *item2)
+/** Give an INR a CPU unless it already has one.
+ *
+ * Failure is harmless, the INR is then left where the platform put it.
+ *
+ * @param inr INR
+ */
+void irq_affinity_default(inr_t inr)
 {
-	irq_t *irq1 = hash_table_get_inst(item1, irq_t, link);
-	irq_t *irq2 = hash_table_get_inst(item2, irq_t, link);
-	return irq1->inr == irq2->inr;
+	if (irq_affinity_get(inr) != IRQ_CPU_ANY)
+		return;
+
+	(void) irq_affinity_set(inr, irq_affinity_next());
 }
 
-/** Return true if the key is equal to the item's lookup key. */
-bool irq_ht_key_equal(const void *key, const ht_link_t *item)
+/** Route an INR to a CPU.
+ *
+ * @param inr INR to route
+ * @param cpu ID of the CPU
+ *
+ * @return Error code.
+ */
+sys_errno_t sys_irq_affinity_set(sysarg_t inr, sysarg_t cpu)
 {
-	const inr_t *inr = key;
-	irq_t *irq = hash_table_get_inst(item, irq_t, link);
-	return irq->inr == *inr;
+	if (!(perm_get(TASK) & PERM_IRQ_REG))
+		return EPERM;
+
+	if (inr > (sysarg_t) last_inr || cpu >= config.cpu_count)
+		return EINVAL;
+
+	return irq_affinity_set((inr_t) inr, (unsigned int) cpu);
+}
+
+/** Get the CPU an INR is routed to.
+ *
+ * @param inr  INR
+ * @param ucpu Uspace pointer where to store the CPU ID
+ *
+ * @return Error code, ENOENT if no particular CPU was chosen.
+ */
+sys_errno_t sys_irq_affinity_get(sysarg_t inr, uspace_addr_t ucpu)
+{
+	if (inr > (sysarg_t) last_inr)
+		return EINVAL;
+
+	unsigned int cpu = irq_affinity_get((inr_t) inr);
+	if (cpu == IRQ_CPU_ANY)
+		return ENOENT;
+
+	sysarg_t val = cpu;
+	return copy_to_uspace(ucpu, &val, sizeof(val));
 }
 
 /** @}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ddi
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Message signalled interrupt allocator.
+ *
+ * Hands out blocks of INRs from the range provided by the platform's
+ * MSI controller. Blocks are naturally aligned to their size rounded up
+ * to a power of two, so that a multi-message MSI capability, which puts
+ * the message number into the low bits of the data, can use them.
+ *
+ * All interrupts of a block share one message address and hence one
+ * destination CPU, which is chosen round-robin when the block is allocated.
+ */
+
+#include <assert.h>
+#include <ddi/irq.h>
+#include <ddi/msi.h>
+#include <errno.h>
+#include <proc/task.h>
+#include <security/perm.h>
+#include <synch/spinlock.h>
+#include <syscall/copy.h>
+
+IRQ_SPINLOCK_STATIC_INITIALIZE(msi_lock);
+
+/** Registered MSI controller or NULL */
+static msi_ops_t *msi_ops = NULL;
+
+/** Owner of each INR of the MSI range, zero if the INR is free */
+static task_id_t msi_owner[MSI_MAX];
+
+/** Register the MSI controller of the platform.
+ *
+ * @param ops MSI controller
+ */
+void msi_register(msi_ops_t *ops)
+{
+	assert(ops->compose != NULL);
+
+	irq_spinlock_lock(&msi_lock, true);
+	msi_ops = ops;
+	if (msi_ops->count > MSI_MAX)
+		msi_ops->count = MSI_MAX;
+	irq_spinlock_unlock(&msi_lock, true);
+}
+
+/** Allocate a block of message signalled interrupts.
+ *
+ * @param count Number of interrupts
+ * @param owner Task which will own the interrupts
+ * @param msi   Place to store the block
+ *
+ * @return EOK on success, ENOTSUP if the platform cannot deliver
+ *         message signalled interrupts, EINVAL if @a count is zero,
+ *         ELIMIT if there is no free block of the requested size
+ */
+errno_t msi_alloc(size_t count, task_id_t owner, irq_msi_t *msi)
+{
+	size_t align = 1;
+	size_t i, j;
+
+	if (count == 0 || count > MSI_MAX)
+		return EINVAL;
+
+	while (align < count)
+		align <<= 1;
+
+	irq_spinlock_lock(&msi_lock, true);
+
+	if (msi_ops == NULL) {
+		irq_spinlock_unlock(&msi_lock, true);
+		return ENOTSUP;
+	}
+
+	for (i = 0; i + count <= msi_ops->count; i += align) {
+		for (j = 0; j < count; j++) {
+			if (msi_owner[i + j] != 0)
+				break;
+		}
+
+		if (j == count)
+			break;
+	}
+
+	if (i + count > msi_ops->count) {
+		irq_spinlock_unlock(&msi_lock, true);
+		return ELIMIT;
+	}
+
+	unsigned int cpu = irq_affinity_next();
+
+	for (j = 0; j < count; j++) {
+		msi_owner[i + j] = owner;
+		if (msi_ops->enable != NULL)
+			msi_ops->enable(msi_ops->base + i + j);
+	}
+
+	msi_ops->compose(msi_ops->base + i, cpu, msi);
+	msi->inr = msi_ops->base + i;
+
+	irq_spinlock_unlock(&msi_lock, true);
+
+	for (j = 0; j < count; j++)
+		irq_affinity_record(msi->inr + j, cpu);
+
+	return EOK;
+}
+
+/** Free a block of message signalled interrupts.
+ *
+ * @param inr   First INR of the block
+ * @param count Number of interrupts
+ * @param owner Task owning the interrupts
+ *
+ * @return EOK on success, ENOENT if the block is not owned by @a owner
+ */
+errno_t msi_free(inr_t inr, size_t count, task_id_t owner)
+{
+	size_t i;
+
+	irq_spinlock_lock(&msi_lock, true);
+
+	if (msi_ops == NULL || inr < msi_ops->base ||
+	    count > msi_ops->count ||
+	    (size_t) (inr - msi_ops->base) > msi_ops->count - count) {
+		irq_spinlock_unlock(&msi_lock, true);
+		return ENOENT;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (msi_owner[inr - msi_ops->base + i] != owner) {
+			irq_spinlock_unlock(&msi_lock, true);
+			return ENOENT;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		if (msi_ops->disable != NULL)
+			msi_ops->disable(inr + i);
+		msi_owner[inr - msi_ops->base + i] = 0;
+	}
+
+	irq_spinlock_unlock(&msi_lock, true);
+	return EOK;
+}
+
+/** Release all message signalled interrupts owned by a task.
+ *
+ * @param owner Task being destroyed
+ */
+void msi_release(task_id_t owner)
+{
+	size_t i;
+
+	irq_spinlock_lock(&msi_lock, true);
+
+	if (msi_ops != NULL) {
+		for (i = 0; i < msi_ops->count; i++) {
+			if (msi_owner[i] != owner)
+				continue;
+
+			if (msi_ops->disable != NULL)
+				msi_ops->disable(msi_ops->base + i);
+			msi_owner[i] = 0;
+		}
+	}
+
+	irq_spinlock_unlock(&msi_lock, true);
+}
+
+/** Allocate a block of message signalled interrupts.
+ *
+ * @param count Number of interrupts
+ * @param umsi  Uspace pointer where to store the block
+ *
+ * @return Error code.
+ */
+sys_errno_t sys_irq_msi_alloc(sysarg_t count, uspace_ptr_irq_msi_t umsi)
+{
+	irq_msi_t msi;
+	errno_t rc;
+
+	if (!(perm_get(TASK) & PERM_IRQ_REG))
+		return EPERM;
+
+	rc = msi_alloc(count, TASK->taskid, &msi);
+	if (rc != EOK)
+		return rc;
+
+	rc = copy_to_uspace(umsi, &msi, sizeof(msi));
+	if (rc != EOK)
+		(void) msi_free(msi.inr, count, TASK->taskid);
+
+	return rc;
+}
+
+/** Free a block of message signalled interrupts.
+ *
+ * @param inr   First INR of the block
+ * @param count Number of interrupts
+ *
+ * @return Error code.
+ */
+sys_errno_t sys_irq_msi_free(sysarg_t inr, sysarg_t count)
+{
+	if (!(perm_get(TASK) & PERM_IRQ_REG))
+		return EPERM;
+
+	return msi_free(inr, count, TASK->taskid);
+}
+
+/** @}
+ */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Kernel trace rings.
+ *
+ * Tracepoints in IPC, the scheduler and the page fault handler write
+ * fixed-size binary records to a ring of the current CPU. The rings are
+ * always on: writing a record costs a few stores with interrupts
+ * disabled and never blocks. Readers map the rings through a physical
+ * memory area, see abi/ktrace.h for the protocol.
+ */
+
+#include <ktrace.h>
+#include <arch.h>
+#include <arch/asm.h>
+#include <arch/cycle.h>
+#include <barrier.h>
+#include <config.h>
+#include <cpu.h>
+#include <ddi/ddi.h>
+#include <log.h>
+#include <mm/frame.h>
+#include <proc/task.h>
+#include <sysinfo/sysinfo.h>
+
+/** True once the rings have been allocated. */
+atomic_bool ktrace_enabled = false;
+
+static parea_t ktrace_parea;
+
+/** Kernel address of the ring of the first CPU. */
+static uint8_t *ktrace_rings;
+
+static ktrace_ring_t *ktrace_ring(unsigned int cpu)
+{
+	return (ktrace_ring_t *) (ktrace_rings + cpu * KTRACE_RING_SIZE);
+}
+
+/** Allocate the rings and publish them to user space. */
+void ktrace_init(void)
+{
+	size_t frames = SIZE2FRAMES(KTRACE_RING_SIZE) * config.cpu_count;
+	uintptr_t faddr = frame_alloc(frames, FRAME_LOWMEM | FRAME_ATOMIC, 0);
+	if (faddr == 0) {
+		log(LF_OTHER, LVL_WARN, "Cannot allocate kernel trace rings.");
+		return;
+	}
+
+	ktrace_rings = (uint8_t *) PA2KA(faddr);
+
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		ktrace_ring_t *ring = ktrace_ring(i);
+
+		ring->head = 0;
+		ring->capacity = (KTRACE_RING_SIZE - sizeof(ktrace_ring_t)) /
+		    sizeof(ktrace_record_t);
+		ring->reserved[0] = 0;
+		ring->reserved[1] = 0;
+	}
+
+	ddi_parea_init(&ktrace_parea);
+	ktrace_parea.pbase = faddr;
+	ktrace_parea.frames = frames;
+	ktrace_parea.unpriv = false;
+	ktrace_parea.mapped = false;
+	ddi_parea_register(&ktrace_parea);
+
+	sysinfo_set_item_val("ktrace.faddr", NULL, (sysarg_t) faddr);
+	sysinfo_set_item_val("ktrace.cpus", NULL, config.cpu_count);
+
+	atomic_store(&ktrace_enabled, true);
+}
+
+/** Append a record to the ring of the current CPU.
+ *
+ * @param event Tracepoint.
+ * @param arg0  First event specific argument.
+ * @param arg1  Second event specific argument.
+ * @param arg2  Third event specific argument.
+ */
+void ktrace_write(ktrace_event_t event, uint64_t arg0, uint64_t arg1,
+    uint64_t arg2)
+{
+	ipl_t ipl = interrupts_disable();
+
+	if (CPU != NULL) {
+		ktrace_ring_t *ring = ktrace_ring(CPU->id);
+		uint64_t head = ring->head;
+		ktrace_record_t *record = &ring->records[head % ring->capacity];
+
+		record->timestamp = get_cycle();
+		record->task_id = TASK ? TASK->taskid : 0;
+		record->arg[0] = arg0;
+		record->arg[1] = arg1;
+		record->arg[2] = arg2;
+		record->event = event;
+		record->cpu = CPU->id;
+
+		/* Publish the record only after it has been written */
+		write_barrier();
+		ring->head = head + 1;
+	}
+
+	interrupts_restore(ipl);
+}
+
+/** @}
+ */
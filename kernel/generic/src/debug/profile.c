@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Sampling profiler.
+ *
+ * When enabled, every period-th clock tick of each CPU records the call
+ * stack of the interrupted code into a ring of samples of that CPU. The
+ * kernel part of the stack is followed only within the current kernel
+ * stack, the user space part only through pages which are present in
+ * the page tables, so that taking a sample never faults. The samples are
+ * drained by user space with SYS_PROFILE_READ; samples which do not fit
+ * into a full ring are dropped.
+ */
+
+#include <profile.h>
+#include <abi/profile.h>
+#include <arch.h>
+#include <atomic.h>
+#include <config.h>
+#include <cpu.h>
+#include <errno.h>
+#include <interrupt.h>
+#include <macros.h>
+#include <mm/as.h>
+#include <mm/page.h>
+#include <arch/mm/page.h>
+#include <genarch/mm/page_pt.h>
+#include <genarch/mm/page_ht.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+#include <stacktrace.h>
+#include <stdlib.h>
+#include <str.h>
+#include <symtab.h>
+#include <synch/mutex.h>
+#include <synch/spinlock.h>
+#include <syscall/copy.h>
+
+/** Number of samples kept by each CPU. */
+#define PROFILE_RING_SIZE  256
+
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+	/** Index of the oldest sample. */
+	size_t head;
+	/** Number of samples in the ring. */
+	size_t count;
+	/** Number of samples dropped because the ring was full. */
+	uint64_t dropped;
+	/** Ticks since the last sample, accessed only by the owning CPU. */
+	unsigned int ticks;
+	profile_sample_t samples[PROFILE_RING_SIZE];
+} profile_ring_t;
+
+/** Serializes the control and read syscalls. */
+static mutex_t profile_lock;
+
+/** Rings of all CPUs, allocated on first enable and never freed. */
+static profile_ring_t *profile_rings;
+
+/** Sampling period in clock ticks, 0 if the profiler is disabled. */
+static atomic_uint profile_period;
+
+void profile_init(void)
+{
+	mutex_initialize(&profile_lock, MUTEX_PASSIVE);
+}
+
+/** Walk the kernel stack of the interrupted code. */
+static void profile_walk_kernel(profile_sample_t *sample, istate_t *istate)
+{
+	stack_trace_context_t ctx = {
+		.fp = istate_get_fp(istate),
+		.pc = istate_get_pc(istate),
+		.istate = istate
+	};
+
+	/* The interrupted code runs on the stack holding CURRENT */
+	uintptr_t stack_lo = (uintptr_t) CURRENT + sizeof(current_t);
+	uintptr_t stack_hi = (uintptr_t) CURRENT + STACK_SIZE;
+
+	while (sample->depth < PROFILE_MAX_DEPTH) {
+		sample->pc[sample->depth++] = ctx.pc;
+
+		if ((ctx.fp < stack_lo) ||
+		    (ctx.fp > stack_hi - 2 * sizeof(uintptr_t)))
+			break;
+
+		uintptr_t fp;
+		uintptr_t pc;
+		if (!kernel_stack_trace_context_validate(&ctx) ||
+		    !kernel_return_address_get(&ctx, &pc) ||
+		    !kernel_frame_pointer_prev(&ctx, &fp))
+			break;
+
+		/* The stack grows down, each caller frame lies above */
+		if (fp <= ctx.fp)
+			break;
+
+		ctx.fp = fp;
+		ctx.pc = pc;
+	}
+
+	sample->kernel_depth = sample->depth;
+}
+
+/** Check that a user space address can be read without faulting.
+ *
+ * Mappings cannot be removed under our hands, since unmapping waits
+ * for a TLB shootdown which this CPU acknowledges only after the clock
+ * interrupt has been handled.
+ */
+static bool profile_uspace_readable(uintptr_t addr)
+{
+	pte_t pte;
+
+	return page_mapping_find(AS, addr, true, &pte) && PTE_VALID(&pte) &&
+	    PTE_PRESENT(&pte) && PTE_READABLE(&pte);
+}
+
+/** Walk the user space stack of the current thread. */
+static void profile_walk_uspace(profile_sample_t *sample, istate_t *istate)
+{
+	stack_trace_context_t ctx = {
+		.fp = istate_get_fp(istate),
+		.pc = istate_get_pc(istate),
+		.istate = istate
+	};
+
+	while (sample->depth < PROFILE_MAX_DEPTH) {
+		sample->pc[sample->depth++] = ctx.pc;
+
+		if ((ctx.fp == 0) || !profile_uspace_readable(ctx.fp) ||
+		    !profile_uspace_readable(ctx.fp + 2 * sizeof(uintptr_t) - 1))
+			break;
+
+		uintptr_t fp;
+		uintptr_t pc;
+		if (!uspace_stack_trace_context_validate(&ctx) ||
+		    !uspace_return_address_get(&ctx, &pc) ||
+		    !uspace_frame_pointer_prev(&ctx, &fp))
+			break;
+
+		if (fp <= ctx.fp)
+			break;
+
+		ctx.fp = fp;
+		ctx.pc = pc;
+	}
+}
+
+/** Record the call stack of the interrupted code. */
+static void profile_sample_take(profile_sample_t *sample, istate_t *istate)
+{
+	sample->task_id = THREAD ? TASK->taskid : 0;
+	sample->thread_id = THREAD ? THREAD->tid : 0;
+	sample->cpu = CPU->id;
+	sample->kernel_depth = 0;
+	sample->depth = 0;
+
+	if (!istate_from_uspace(istate))
+		profile_walk_kernel(sample, istate);
+
+	if ((THREAD) && (THREAD->uspace)) {
+		/* Within the kernel, use the state saved on kernel entry */
+		istate_t *ustate = istate_from_uspace(istate) ? istate :
+		    istate_get(THREAD);
+		if (istate_from_uspace(ustate))
+			profile_walk_uspace(sample, ustate);
+	}
+}
+
+/** Take a sample if the profiler is enabled and the period has elapsed.
+ *
+ * Called from clock() with interrupts disabled.
+ */
+void profile_tick(void)
+{
+	unsigned int period = atomic_load_explicit(&profile_period,
+	    memory_order_acquire);
+	if (period == 0)
+		return;
+
+	istate_t *istate = CPU->istate;
+	if (istate == NULL)
+		return;
+
+	profile_ring_t *ring = &profile_rings[CPU->id];
+	if (++ring->ticks < period)
+		return;
+
+	ring->ticks = 0;
+
+	irq_spinlock_lock(&ring->lock, false);
+
+	if (ring->count == PROFILE_RING_SIZE) {
+		ring->dropped++;
+	} else {
+		size_t idx = (ring->head + ring->count) % PROFILE_RING_SIZE;
+		profile_sample_take(&ring->samples[idx], istate);
+		ring->count++;
+	}
+
+	irq_spinlock_unlock(&ring->lock, false);
+}
+
+/** Enable or disable the profiler.
+ *
+ * @param period Sampling period in clock ticks of each CPU, 0 disables
+ *               the profiler.
+ *
+ * @return EOK on success, ENOMEM if the rings cannot be allocated.
+ */
+sys_errno_t sys_profile_ctl(sysarg_t period)
+{
+	mutex_lock(&profile_lock);
+
+	if ((period != 0) && (profile_rings == NULL)) {
+		profile_ring_t *rings =
+		    malloc(sizeof(profile_ring_t) * config.cpu_count);
+		if (rings == NULL) {
+			mutex_unlock(&profile_lock);
+			return (sys_errno_t) ENOMEM;
+		}
+
+		for (size_t i = 0; i < config.cpu_count; i++) {
+			irq_spinlock_initialize(&rings[i].lock,
+			    "profile_rings[].lock");
+			rings[i].head = 0;
+			rings[i].count = 0;
+			rings[i].dropped = 0;
+			rings[i].ticks = 0;
+		}
+
+		profile_rings = rings;
+	}
+
+	/* Publish the rings before the period */
+	atomic_store_explicit(&profile_period, (unsigned int) period,
+	    memory_order_release);
+
+	mutex_unlock(&profile_lock);
+	return EOK;
+}
+
+/** Read the collected samples.
+ *
+ * The samples are removed from the rings as they are read.
+ *
+ * @param buf          User space buffer for the samples.
+ * @param count        Capacity of the buffer in samples.
+ * @param uspace_nread Place to store the number of samples read.
+ *
+ * @return EOK on success or an error code.
+ */
+sys_errno_t sys_profile_read(uspace_addr_t buf, size_t count,
+    uspace_ptr_size_t uspace_nread)
+{
+	profile_sample_t sample;
+	size_t nread = 0;
+	errno_t rc = EOK;
+
+	mutex_lock(&profile_lock);
+
+	for (size_t i = 0; (profile_rings != NULL) &&
+	    (i < config.cpu_count); i++) {
+		profile_ring_t *ring = &profile_rings[i];
+
+		while (nread < count) {
+			irq_spinlock_lock(&ring->lock, true);
+			if (ring->count == 0) {
+				irq_spinlock_unlock(&ring->lock, true);
+				break;
+			}
+
+			sample = ring->samples[ring->head];
+			ring->head = (ring->head + 1) % PROFILE_RING_SIZE;
+			ring->count--;
+			irq_spinlock_unlock(&ring->lock, true);
+
+			rc = copy_to_uspace(buf + nread * sizeof(sample),
+			    &sample, sizeof(sample));
+			if (rc != EOK)
+				break;
+
+			nread++;
+		}
+
+		if (rc != EOK)
+			break;
+	}
+
+	mutex_unlock(&profile_lock);
+
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	return (sys_errno_t) copy_to_uspace(uspace_nread, &nread,
+	    sizeof(nread));
+}
+
+/** Resolve a kernel address recorded in a sample.
+ *
+ * @param addr          Kernel address.
+ * @param buf           User space buffer for the symbol name, the name is
+ *                      truncated if it does not fit.
+ * @param size          Size of the buffer.
+ * @param uspace_offset Place to store the offset of @a addr in the symbol.
+ *
+ * @return EOK on success, ENOENT if the address is not in any symbol or
+ *         an error code.
+ */
+sys_errno_t sys_profile_symbol(sysarg_t addr, uspace_addr_t buf, size_t size,
+    uspace_ptr_uintptr_t uspace_offset)
+{
+	const char *name;
+	uintptr_t offset;
+
+	if (size == 0)
+		return (sys_errno_t) EINVAL;
+
+	errno_t rc = symtab_name_lookup(addr, &name, &offset);
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	size_t len = min(str_size(name), size - 1);
+	const char nul = '\0';
+
+	rc = copy_to_uspace(buf, name, len);
+	if (rc == EOK)
+		rc = copy_to_uspace(buf + len, &nul, 1);
+	if (rc == EOK)
+		rc = copy_to_uspace(uspace_offset, &offset, sizeof(offset));
+
+	return (sys_errno_t) rc;
+}
+
+/** @}
+ */
@@ -42,6 +42,60 @@
 #include <typedefs.h>
 #include <errno.h>
 #include <console/prompt.h>
+#include <ddi/ddi.h>
+#include <mm/frame.h>
+#include <sysinfo/sysinfo.h>
+#include <log.h>
+#include <mem.h>
+
+#ifdef CONFIG_SYMTAB
+
+/** Name index generated by genmap.py after the symbol table terminator */
+typedef struct {
+	/** Number of buckets, a power of two */
+	uint32_t buckets_le;
+	/** Number of symbols */
+	uint32_t count_le;
+	/** Bucket heads followed by chain links, as 1-based entry indices */
+	uint32_t index_le[];
+} symtab_hash_t;
+
+/** Number of symbols in the table, determined on first use */
+static size_t symtab_count;
+
+/** Copy of the symbol table exported to user space */
+static parea_t symtab_parea;
+
+/** Get the number of symbols in the table
+ *
+ * The table is terminated by an entry with a zero address.
+ *
+ */
+static size_t symtab_size(void)
+{
+	if (symtab_count == 0) {
+		size_t count = 0;
+		while (symbol_table[count].address_le != 0)
+			count++;
+
+		symtab_count = count;
+	}
+
+	return symtab_count;
+}
+
+/** Hash a symbol name, must match name_hash() in genmap.py */
+static uint32_t symtab_hash(const char *name)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	for (const uint8_t *byte = (const uint8_t *) name; *byte != 0; byte++)
+		hash = (hash ^ *byte) * 0x01000193;
+
+	return hash;
+}
+
+#endif
 
 /** Get name of a symbol that seems most likely to correspond to address.
  *
@@ -56,23 +110,31 @@
 errno_t symtab_name_lookup(uintptr_t addr, const char **name, uintptr_t *offset)
 {
 #ifdef CONFIG_SYMTAB
-	size_t i;
+	size_t lo = 0;
+	size_t hi = symtab_size();
 
-	for (i = 1; symbol_table[i].address_le; i++) {
-		if (addr < uint64_t_le2host(symbol_table[i].address_le))
-			break;
+	/* The table is sorted by address, find the first symbol above addr */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (addr < uint64_t_le2host(symbol_table[mid].address_le))
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
 
-	if (addr >= uint64_t_le2host(symbol_table[i - 1].address_le)) {
-		*name = symbol_table[i - 1].symbol_name;
-		if (offset)
-			*offset = addr -
-			    uint64_t_le2host(symbol_table[i - 1].address_le);
-		return EOK;
+	if (lo == 0) {
+		*name = NULL;
+		return ENOENT;
 	}
 
-	*name = NULL;
-	return ENOENT;
+	const struct symtab_entry *entry = &symbol_table[lo - 1];
+
+	*name = entry->symbol_name;
+	if (offset)
+		*offset = addr - uint64_t_le2host(entry->address_le);
+
+	return EOK;
 
 #else
 	*name = NULL;
@@ -146,7 +208,8 @@ static const char *symtab_search_one(const char *name, size_t *startpos)
 
 /** Return address that corresponds to the entry.
  *
- * Search symbol table, and if there is one match, return it
+ * Look the name up in the name index of the symbol table,
+ * and if there is one match, return it
  *
  * @param name Name of the symbol
  * @param addr Place to store symbol address
@@ -158,16 +221,26 @@ static const char *symtab_search_one(const char *name, size_t *startpos)
 errno_t symtab_addr_lookup(const char *name, uintptr_t *addr)
 {
 #ifdef CONFIG_SYMTAB
+	const symtab_hash_t *hash =
+	    (const symtab_hash_t *) &symbol_table[symtab_size() + 1];
+	uint32_t buckets = uint32_t_le2host(hash->buckets_le);
 	size_t found = 0;
-	size_t pos = 0;
-	const char *hint;
 
-	while ((hint = symtab_search_one(name, &pos))) {
-		if (str_length(hint) == 0) {
-			*addr = uint64_t_le2host(symbol_table[pos].address_le);
+	if (buckets == 0)
+		return ENOENT;
+
+	uint32_t idx = uint32_t_le2host(
+	    hash->index_le[symtab_hash(name) & (buckets - 1)]);
+
+	while (idx != 0) {
+		const struct symtab_entry *entry = &symbol_table[idx - 1];
+
+		if (str_cmp(entry->symbol_name, name) == 0) {
+			*addr = uint64_t_le2host(entry->address_le);
 			found++;
 		}
-		pos++;
+
+		idx = uint32_t_le2host(hash->index_le[buckets + idx - 1]);
 	}
 
 	if (found > 1)
@@ -237,5 +310,44 @@ const char *symtab_hints_enum(const char *input, const char **help,
 #endif
 }
 
+/** Publish a read-only copy of the symbol table to user space
+ *
+ * Profilers map the copy to symbolize kernel addresses without
+ * a system call for each of them. Only the address-sorted entries
+ * are exported, the name index stays private to the kernel.
+ *
+ */
+void symtab_init(void)
+{
+#ifdef CONFIG_SYMTAB
+	size_t count = symtab_size();
+	size_t size = (count + 1) * sizeof(struct symtab_entry);
+	size_t frames = SIZE2FRAMES(size);
+
+	uintptr_t faddr = frame_alloc(frames, FRAME_LOWMEM | FRAME_ATOMIC, 0);
+	if (faddr == 0) {
+		log(LF_OTHER, LVL_WARN, "Cannot allocate symbol table copy.");
+		return;
+	}
+
+	uint8_t *copy = (uint8_t *) PA2KA(faddr);
+	memcpy(copy, symbol_table, size);
+
+	/* Clear the tail so that no stale data leaks to user space */
+	memsetb(copy + size, FRAMES2SIZE(frames) - size, 0);
+
+	ddi_parea_init(&symtab_parea);
+	symtab_parea.pbase = faddr;
+	symtab_parea.frames = frames;
+	symtab_parea.unpriv = true;
+	symtab_parea.mapped = false;
+	ddi_parea_register(&symtab_parea);
+
+	sysinfo_set_item_val("kernel.symtab.faddr", NULL, (sysarg_t) faddr);
+	sysinfo_set_item_val("kernel.symtab.pages", NULL, frames);
+	sysinfo_set_item_val("kernel.symtab.count", NULL, count);
+#endif
+}
+
 /** @}
  */
@@ -45,6 +45,7 @@
 #include <console/console.h>
 #include <console/cmd.h>
 #include <synch/mutex.h>
+#include <synch/rcu.h>
 #include <time/delay.h>
 #include <macros.h>
 #include <panic.h>
@@ -55,6 +56,7 @@
 #include <arch/cycle.h>
 #include <arch/stack.h>
 #include <str.h>
+#include <time/clock.h>
 #include <trace.h>
 
 exc_table_t exc_table[IVT_ITEMS];
@@ -84,8 +86,18 @@ iroutine_t exc_register(unsigned int n, const char *name, bool hot,
 	exc_table[n].handler = handler;
 	exc_table[n].name = name;
 	exc_table[n].hot = hot;
-	exc_table[n].cycles = 0;
-	exc_table[n].count = 0;
+
+	/*
+	 * Only handled exceptions get per-CPU accounting, the others
+	 * are rare and share a single value.
+	 */
+	if ((hot) && (exc_table[n].count.slot == 0)) {
+		pcpu_counter_initialize(&exc_table[n].cycles);
+		pcpu_counter_initialize(&exc_table[n].count);
+	} else {
+		pcpu_counter_reset(&exc_table[n].cycles);
+		pcpu_counter_reset(&exc_table[n].count);
+	}
 
 	irq_spinlock_unlock(&exctbl_lock, true);
 
@@ -104,6 +116,9 @@ _NO_TRACE void exc_dispatch(unsigned int n, istate_t *istate)
 	assert(n < IVT_ITEMS);
 #endif
 
+	/* Leave the RCU idle state before any handler may read */
+	rcu_exc_enter(istate_from_uspace(istate));
+
 	/* Account user cycles */
 	if (THREAD) {
 		irq_spinlock_lock(&THREAD->lock, false);
@@ -111,18 +126,25 @@ _NO_TRACE void exc_dispatch(unsigned int n, istate_t *istate)
 		irq_spinlock_unlock(&THREAD->lock, false);
 	}
 
+#ifdef CONFIG_TICKLESS
+	/* Any interrupt ends a stopped tick */
+	if (CPU)
+		clock_tick_restart();
+#endif
+
 	/* Account CPU usage if it woke up from sleep */
-	if (CPU && CPU->idle) {
-		irq_spinlock_lock(&CPU->lock, false);
-		uint64_t now = get_cycle();
-		CPU->idle_cycles += now - CPU->last_cycle;
-		CPU->last_cycle = now;
-		CPU->idle = false;
-		irq_spinlock_unlock(&CPU->lock, false);
-	}
+	if (CPU)
+		cpu_idle_end();
 
 	uint64_t begin_cycle = get_cycle();
 
+	/* Let the sampling profiler see the interrupted state */
+	istate_t *prev_istate = NULL;
+	if (CPU) {
+		prev_istate = CPU->istate;
+		CPU->istate = istate;
+	}
+
 #ifdef CONFIG_UDEBUG
 	if (THREAD)
 		THREAD->udebug.uspace_state = istate;
@@ -135,6 +157,10 @@ _NO_TRACE void exc_dispatch(unsigned int n, istate_t *istate)
 		THREAD->udebug.uspace_state = NULL;
 #endif
 
+	/* Return to the state of the enclosing exception, if any */
+	if (CPU)
+		CPU->istate = prev_istate;
+
 	/* This is a safe place to exit exiting thread */
 	if ((THREAD) && (THREAD->interrupted) && (istate_from_uspace(istate)))
 		thread_exit();
@@ -142,10 +168,8 @@ _NO_TRACE void exc_dispatch(unsigned int n, istate_t *istate)
 	/* Account exception handling */
 	uint64_t end_cycle = get_cycle();
 
-	irq_spinlock_lock(&exctbl_lock, false);
-	exc_table[n].cycles += end_cycle - begin_cycle;
-	exc_table[n].count++;
-	irq_spinlock_unlock(&exctbl_lock, false);
+	pcpu_counter_add(&exc_table[n].cycles, end_cycle - begin_cycle);
+	pcpu_counter_inc(&exc_table[n].count);
 
 	/* Do not charge THREAD for exception cycles */
 	if (THREAD) {
@@ -271,12 +295,14 @@ _NO_TRACE static int cmd_exc_print(cmd_arg_t *argv)
 		uint64_t count;
 		char count_suffix;
 
-		order_suffix(exc_table[i].count, &count, &count_suffix);
+		order_suffix(pcpu_counter_sum_positive(&exc_table[i].count),
+		    &count, &count_suffix);
 
 		uint64_t cycles;
 		char cycles_suffix;
 
-		order_suffix(exc_table[i].cycles, &cycles, &cycles_suffix);
+		order_suffix(pcpu_counter_sum_positive(&exc_table[i].cycles),
+		    &cycles, &cycles_suffix);
 
 		const char *symbol =
 		    symtab_fmt_name_lookup((sysarg_t) exc_table[i].handler);
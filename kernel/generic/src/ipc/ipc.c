@@ -49,9 +49,15 @@
 #include <ipc/event.h>
 #include <ipc/sysipc_ops.h>
 #include <ipc/sysipc_priv.h>
+#include <ipc/xfer.h>
 #include <errno.h>
 #include <mm/slab.h>
 #include <arch.h>
+#include <arch/asm.h>
+#include <arch/cycle.h>
+#include <cpu.h>
+#include <bitops.h>
+#include <macros.h>
 #include <proc/task.h>
 #include <mem.h>
 #include <stdio.h>
@@ -61,6 +67,7 @@
 #include <ipc/irq.h>
 #include <cap/cap.h>
 #include <stdlib.h>
+#include <ktrace.h>
 
 static void ipc_forget_call(call_t *);
 
@@ -86,43 +93,94 @@ static void _ipc_call_init(call_t *call)
 	call->sender = NULL;
 	call->callerbox = NULL;
 	call->buffer = NULL;
+	call->xfer = NULL;
+}
+
+/** Release the resources held by a call, but not the call itself. */
+static void call_release(call_t *call)
+{
+	if (call->buffer) {
+		free(call->buffer);
+		call->buffer = NULL;
+	}
+	if (call->xfer) {
+		ipc_xfer_release(call->xfer);
+		call->xfer = NULL;
+	}
+	if (call->caller_phone) {
+		kobject_put(call->caller_phone->kobject);
+		call->caller_phone = NULL;
+	}
 }
 
 static void call_destroy(void *arg)
 {
 	call_t *call = (call_t *) arg;
 
-	if (call->buffer)
-		free(call->buffer);
-	if (call->caller_phone)
-		kobject_put(call->caller_phone->kobject);
+	call_release(call);
 	slab_free(call_cache, call);
 }
 
+/** Keep a call with its kernel object in the current CPU's call cache.
+ *
+ * @return True if the call was cached, false if the cache is full.
+ */
+static bool call_recycle(void *arg)
+{
+	call_t *call = (call_t *) arg;
+	bool cached = false;
+
+	call_release(call);
+
+	ipl_t ipl = interrupts_disable();
+	if (CPU->call_cache_count < CPU_CALL_CACHE_SIZE) {
+		CPU->call_cache[CPU->call_cache_count++] = call;
+		cached = true;
+	}
+	interrupts_restore(ipl);
+
+	return cached;
+}
+
 kobject_ops_t call_kobject_ops = {
-	.destroy = call_destroy
+	.destroy = call_destroy,
+	.recycle = call_recycle
 };
 
 /** Allocate and initialize a call structure.
  *
  * The call is initialized, so that the reply will be directed to
- * TASK->answerbox.
+ * TASK->answerbox. Calls whose last reference was dropped on this CPU are
+ * reused together with their kernel objects before falling back to the slab
+ * allocator.
  *
  * @return Initialized kernel call structure with one reference, or NULL.
  *
  */
 call_t *ipc_call_alloc(void)
 {
-	// TODO: Allocate call and kobject in single allocation
+	call_t *call = NULL;
+	kobject_t *kobj;
 
-	call_t *call = slab_alloc(call_cache, FRAME_ATOMIC);
-	if (!call)
-		return NULL;
+	ipl_t ipl = interrupts_disable();
+	if (CPU->call_cache_count > 0)
+		call = CPU->call_cache[--CPU->call_cache_count];
+	interrupts_restore(ipl);
 
-	kobject_t *kobj = kobject_alloc(0);
-	if (!kobj) {
-		slab_free(call_cache, call);
-		return NULL;
+	if (call) {
+		kobj = call->kobject;
+	} else {
+		// TODO: Allocate call and kobject in single allocation
+
+		call = slab_alloc(call_cache, FRAME_ATOMIC);
+		if (!call)
+			return NULL;
+
+		kobj = kobject_alloc(0);
+		if (!kobj) {
+			slab_free(call_cache, call);
+			return NULL;
+		}
 	}
 
 	_ipc_call_init(call);
@@ -150,6 +208,90 @@ void ipc_answerbox_init(answerbox_t *box, task_t *task)
 	list_initialize(&box->irq_notifs);
 	atomic_store(&box->active_calls, 0);
 	box->task = task;
+
+	irq_spinlock_initialize(&box->stats_lock, "ipc.box.statslock");
+	box->queue_depth = 0;
+	box->queue_peak = 0;
+	memsetb(box->answer_latency, sizeof(box->answer_latency), 0);
+}
+
+/** Get answer latency histogram bucket
+ *
+ * @param cycles Number of cycles between queueing and answering a request.
+ *
+ * @return Index of the log2 microsecond bucket, see STATS_LATENCY_BUCKETS.
+ *
+ */
+static unsigned int answer_latency_bucket(uint64_t cycles)
+{
+	uint64_t us = (CPU->frequency_mhz != 0) ?
+	    cycles / CPU->frequency_mhz : cycles;
+
+	if (us == 0)
+		return 0;
+
+	return min(fnzb64(us) + 1, STATS_LATENCY_BUCKETS - 1);
+}
+
+/** Account a request queued in an answerbox.
+ *
+ * @param box  Answerbox the request is queued in.
+ * @param call Queued request.
+ *
+ */
+static void answerbox_request_queued(answerbox_t *box, call_t *call)
+{
+	call->callee_box = box;
+	call->queued_cycle = get_cycle();
+
+	irq_spinlock_lock(&box->stats_lock, true);
+	box->queue_depth++;
+	if (box->queue_depth > box->queue_peak)
+		box->queue_peak = box->queue_depth;
+	irq_spinlock_unlock(&box->stats_lock, true);
+}
+
+/** Account a request leaving the answerbox it was queued in.
+ *
+ * @param call     Request leaving its answerbox.
+ * @param answered True if the request is being answered, false if it is
+ *                 being forwarded.
+ *
+ */
+static void answerbox_request_done(call_t *call, bool answered)
+{
+	answerbox_t *box = call->callee_box;
+	if (!box)
+		return;
+
+	call->callee_box = NULL;
+
+	uint64_t now = get_cycle();
+	unsigned int bucket = answer_latency_bucket(
+	    (now > call->queued_cycle) ? now - call->queued_cycle : 0);
+
+	irq_spinlock_lock(&box->stats_lock, true);
+	box->queue_depth--;
+	if (answered)
+		box->answer_latency[bucket]++;
+	irq_spinlock_unlock(&box->stats_lock, true);
+}
+
+/** Get request statistics of an answerbox.
+ *
+ * @param box   Answerbox.
+ * @param stats IPC statistics whose queue depth and answer latency
+ *              members are filled in.
+ *
+ */
+void ipc_answerbox_get_stats(answerbox_t *box, stats_ipc_t *stats)
+{
+	irq_spinlock_lock(&box->stats_lock, true);
+	stats->queue_depth = box->queue_depth;
+	stats->queue_peak = box->queue_peak;
+	memcpy(stats->answer_latency, box->answer_latency,
+	    sizeof(stats->answer_latency));
+	irq_spinlock_unlock(&box->stats_lock, true);
 }
 
 /** Connect a phone to an answerbox.
@@ -199,6 +341,8 @@ void ipc_phone_init(phone_t *phone, task_t *caller)
 	phone->callee = NULL;
 	phone->state = IPC_PHONE_FREE;
 	atomic_store(&phone->active_calls, 0);
+	atomic_store(&phone->calls_sent, 0);
+	atomic_store(&phone->answers_received, 0);
 	phone->label = 0;
 	phone->kobject = NULL;
 }
@@ -284,6 +428,11 @@ errno_t ipc_call_sync(phone_t *phone, call_t *request)
  */
 void _ipc_answer_free_call(call_t *call, bool selflocked)
 {
+	ktrace(KTRACE_IPC_ANSWER, (uintptr_t) call, call->request_method,
+	    ipc_get_retval(&call->data));
+
+	answerbox_request_done(call, true);
+
 	/* Count sent answer */
 	irq_spinlock_lock(&TASK->lock, true);
 	TASK->ipc_info.answer_sent++;
@@ -325,7 +474,7 @@ void _ipc_answer_free_call(call_t *call, bool selflocked)
 	if (do_lock)
 		irq_spinlock_unlock(&callerbox->lock, true);
 
-	waitq_wakeup(&callerbox->wq, WAKEUP_FIRST);
+	waitq_wakeup(&callerbox->wq, WAKEUP_HANDOFF);
 }
 
 /** Answer a message which is in a callee queue.
@@ -407,15 +556,21 @@ static void _ipc_call(phone_t *phone, answerbox_t *box, call_t *call,
 	irq_spinlock_lock(&caller->lock, true);
 	caller->ipc_info.call_sent++;
 	irq_spinlock_unlock(&caller->lock, true);
+	atomic_inc(&phone->calls_sent);
 
 	if (!(call->flags & IPC_CALL_FORWARDED))
 		_ipc_call_actions_internal(phone, call, preforget);
 
+	ktrace(KTRACE_IPC_CALL, (uintptr_t) call, ipc_get_imethod(&call->data),
+	    box->task->taskid);
+
+	answerbox_request_queued(box, call);
+
 	irq_spinlock_lock(&box->lock, true);
 	list_append(&call->ab_link, &box->calls);
 	irq_spinlock_unlock(&box->lock, true);
 
-	waitq_wakeup(&box->wq, WAKEUP_FIRST);
+	waitq_wakeup(&box->wq, WAKEUP_HANDOFF);
 }
 
 /** Send an asynchronous request using a phone to an answerbox.
@@ -520,6 +675,11 @@ errno_t ipc_forward(call_t *call, phone_t *newphone, answerbox_t *oldbox,
 	list_remove(&call->ab_link);
 	irq_spinlock_unlock(&oldbox->lock, true);
 
+	answerbox_request_done(call, false);
+
+	ktrace(KTRACE_IPC_FORWARD, (uintptr_t) call,
+	    ipc_get_imethod(&call->data), mode);
+
 	if (mode & IPC_FF_ROUTE_FROM_ME) {
 		call->data.request_label = newphone->label;
 		call->data.task_id = TASK->taskid;
@@ -579,6 +739,7 @@ errno_t ipc_wait_for_call(answerbox_t *box, uint32_t usec, unsigned int flags,
 		    call_t, ab_link);
 		list_remove(&request->ab_link);
 		atomic_dec(&request->caller_phone->active_calls);
+		atomic_inc(&request->caller_phone->answers_received);
 		atomic_dec(&box->active_calls);
 		kobject_put(request->caller_phone->kobject);
 	} else if (!list_empty(&box->calls)) {
@@ -966,14 +1127,9 @@ static bool print_task_phone_cb(cap_t *cap, void *arg)
  */
 void ipc_print_task(task_id_t taskid)
 {
-	irq_spinlock_lock(&tasks_lock, true);
-	task_t *task = task_find_by_id(taskid);
-	if (!task) {
-		irq_spinlock_unlock(&tasks_lock, true);
+	task_t *task = task_get_by_id(taskid);
+	if (!task)
 		return;
-	}
-	task_hold(task);
-	irq_spinlock_unlock(&tasks_lock, true);
 
 	printf("[phone cap] [calls] [state\n");
 
@@ -985,6 +1141,8 @@ void ipc_print_task(task_id_t taskid)
 
 	printf("Active calls: %" PRIun "\n",
 	    atomic_load(&task->answerbox.active_calls));
+	printf("Queued requests: %zu (peak %zu)\n",
+	    task->answerbox.queue_depth, task->answerbox.queue_peak);
 
 #ifdef __32_BITS__
 	printf("[call adr] [method] [arg1] [arg2] [arg3] [arg4] [arg5]"
@@ -64,7 +64,9 @@
 #include <syscall/copy.h>
 #include <console/console.h>
 #include <macros.h>
+#include <member.h>
 #include <cap/cap.h>
+#include <synch/rcu.h>
 #include <stdlib.h>
 
 static void ranges_unmap(irq_pio_range_t *ranges, size_t rangecount)
@@ -286,7 +288,7 @@ static void irq_hash_out(irq_t *irq)
 
 	if (irq->notif_cfg.hashed_in) {
 		/* Remove the IRQ from the uspace IRQ hash table. */
-		hash_table_remove_item(&irq_uspace_hash_table, &irq->link);
+		irq_hash_remove(&irq_uspace_hash_table, irq);
 		irq->notif_cfg.hashed_in = false;
 	}
 
@@ -294,15 +296,52 @@ static void irq_hash_out(irq_t *irq)
 	irq_spinlock_unlock(&irq_uspace_hash_table_lock, true);
 }
 
+/** Stop moderating the notifications of an IRQ which is hashed out.
+ *
+ * @param irq IRQ structure.
+ *
+ */
+static void irq_moderation_cleanup(irq_t *irq)
+{
+	if (timeout_unregister(&irq->notif_cfg.holdoff_timeout)) {
+		irq_spinlock_lock(&irq->lock, true);
+		irq->notif_cfg.holdoff = false;
+		irq_spinlock_unlock(&irq->lock, true);
+	}
+
+	/* Wait for a running holdoff timeout handler to finish. */
+	while (true) {
+		irq_spinlock_lock(&irq->lock, true);
+		bool holdoff = irq->notif_cfg.holdoff;
+		irq_spinlock_unlock(&irq->lock, true);
+
+		if (!holdoff)
+			break;
+	}
+
+	if (irq->notif_cfg.pending) {
+		kobject_put(irq->notif_cfg.pending->kobject);
+		irq->notif_cfg.pending = NULL;
+	}
+}
+
+static void irq_free_rcu(rcu_item_t *item)
+{
+	slab_free(irq_cache, member_to_inst(item, irq_t, rcu));
+}
+
 static void irq_destroy(void *arg)
 {
 	irq_t *irq = (irq_t *) arg;
 
 	irq_hash_out(irq);
+	irq_moderation_cleanup(irq);
 
 	/* Free up the IRQ code and associated structures. */
 	code_free(irq->notif_cfg.code);
-	slab_free(irq_cache, irq);
+
+	/* Interrupt dispatch may still be looking at the structure */
+	rcu_call(&irq->rcu, irq_free_rcu);
 }
 
 kobject_ops_t irq_kobject_ops = {
@@ -371,6 +410,9 @@ errno_t ipc_irq_subscribe(answerbox_t *box, inr_t inr, sysarg_t imethod,
 	irq->notif_cfg.imethod = imethod;
 	irq->notif_cfg.code = code;
 	irq->notif_cfg.counter = 0;
+	if (code)
+		irq->notif_cfg.moderation = code->moderation;
+	timeout_initialize(&irq->notif_cfg.holdoff_timeout);
 
 	/*
 	 * Insert the IRQ structure into the uspace IRQ hash table.
@@ -379,7 +421,7 @@ errno_t ipc_irq_subscribe(answerbox_t *box, inr_t inr, sysarg_t imethod,
 	irq_spinlock_lock(&irq->lock, false);
 
 	irq->notif_cfg.hashed_in = true;
-	hash_table_insert(&irq_uspace_hash_table, &irq->link);
+	irq_hash_insert(&irq_uspace_hash_table, irq);
 
 	irq_spinlock_unlock(&irq->lock, false);
 	irq_spinlock_unlock(&irq_uspace_hash_table_lock, true);
@@ -387,6 +429,9 @@ errno_t ipc_irq_subscribe(answerbox_t *box, inr_t inr, sysarg_t imethod,
 	kobject_initialize(kobject, KOBJECT_TYPE_IRQ, irq);
 	cap_publish(TASK, handle, kobject);
 
+	/* Keep device interrupts from piling up on one CPU */
+	irq_affinity_default(inr);
+
 	return EOK;
 }
 
@@ -431,6 +476,168 @@ static void send_call(irq_t *irq, call_t *call)
 	waitq_wakeup(&irq->notif_cfg.answerbox->wq, WAKEUP_FIRST);
 }
 
+/** Check whether notifications of an IRQ are moderated.
+ *
+ * @param irq IRQ structure.
+ *
+ */
+static bool irq_moderated(irq_t *irq)
+{
+	return (irq->notif_cfg.moderation.interval != 0) ||
+	    (irq->notif_cfg.moderation.max_pending != 0);
+}
+
+/** Set the payload of a notification from the scratch values.
+ *
+ * @param irq   IRQ structure.
+ * @param call  Notification call.
+ * @param count Number of interrupts the notification stands for.
+ *
+ */
+static void notif_set_payload(irq_t *irq, call_t *call, size_t count)
+{
+	/* Put a counter to the message */
+	call->priv = ++irq->notif_cfg.counter;
+
+	ipc_set_arg1(&call->data, irq->notif_cfg.scratch[1]);
+	ipc_set_arg2(&call->data, irq->notif_cfg.scratch[2]);
+	ipc_set_arg3(&call->data, irq->notif_cfg.scratch[3]);
+	ipc_set_arg4(&call->data, irq->notif_cfg.scratch[4]);
+	ipc_set_arg5(&call->data, irq->notif_cfg.scratch[5]);
+	call->data.answer_label = count;
+}
+
+/** Send a notification carrying the scratch values.
+ *
+ * Assume irq->lock is locked and interrupts disabled.
+ *
+ * @param irq   IRQ structure.
+ * @param count Number of interrupts the notification stands for.
+ *
+ */
+static void notif_send(irq_t *irq, size_t count)
+{
+	call_t *call = ipc_call_alloc();
+	if (!call)
+		return;
+
+	call->flags |= IPC_CALL_NOTIF;
+	ipc_set_imethod(&call->data, irq->notif_cfg.imethod);
+	notif_set_payload(irq, call, count);
+
+	if (irq_moderated(irq)) {
+		/* Keep the call, so that further interrupts can be merged. */
+		if (irq->notif_cfg.pending)
+			kobject_put(irq->notif_cfg.pending->kobject);
+		kobject_add_ref(call->kobject);
+		irq->notif_cfg.pending = call;
+		irq->notif_cfg.pending_count = count;
+	}
+
+	send_call(irq, call);
+}
+
+/** Merge an interrupt into the pending notification if possible.
+ *
+ * Assume irq->lock is locked and interrupts disabled.
+ *
+ * @param irq IRQ structure.
+ *
+ * @return True if the interrupt was merged.
+ *
+ */
+static bool notif_merge(irq_t *irq)
+{
+	call_t *call = irq->notif_cfg.pending;
+	if (!call)
+		return false;
+
+	uint32_t max_pending = irq->notif_cfg.moderation.max_pending;
+	if ((max_pending != 0) && (irq->notif_cfg.pending_count >= max_pending))
+		return false;
+
+	answerbox_t *box = irq->notif_cfg.answerbox;
+	bool merged = false;
+
+	irq_spinlock_lock(&box->irq_lock, false);
+	if (link_in_use(&call->ab_link)) {
+		/* The notification has not been received yet. */
+		irq->notif_cfg.pending_count++;
+		notif_set_payload(irq, call, irq->notif_cfg.pending_count);
+		merged = true;
+	}
+	irq_spinlock_unlock(&box->irq_lock, false);
+
+	if (!merged) {
+		kobject_put(call->kobject);
+		irq->notif_cfg.pending = NULL;
+	}
+
+	return merged;
+}
+
+/** End of the minimum interval after a notification.
+ *
+ * Notifies the interrupts deferred during the interval and starts
+ * another interval if there were any.
+ *
+ * @param arg IRQ structure.
+ *
+ */
+static void notif_holdoff_end(void *arg)
+{
+	irq_t *irq = (irq_t *) arg;
+
+	irq_spinlock_lock(&irq->lock, true);
+
+	if ((irq->notif_cfg.deferred > 0) && (irq->notif_cfg.hashed_in) &&
+	    (irq->notif_cfg.notify)) {
+		notif_send(irq, irq->notif_cfg.deferred);
+		irq->notif_cfg.deferred = 0;
+		timeout_register(&irq->notif_cfg.holdoff_timeout,
+		    irq->notif_cfg.moderation.interval, notif_holdoff_end, irq);
+	} else {
+		irq->notif_cfg.deferred = 0;
+		irq->notif_cfg.holdoff = false;
+	}
+
+	irq_spinlock_unlock(&irq->lock, true);
+}
+
+/** Notify a claimed interrupt observing the moderation.
+ *
+ * Assume irq->lock is locked and interrupts disabled.
+ *
+ * @param irq IRQ structure.
+ *
+ */
+static void notif_moderated(irq_t *irq)
+{
+	if (notif_merge(irq))
+		return;
+
+	if (irq->notif_cfg.holdoff) {
+		uint32_t max_pending = irq->notif_cfg.moderation.max_pending;
+
+		irq->notif_cfg.deferred++;
+		if ((max_pending != 0) &&
+		    (irq->notif_cfg.deferred >= max_pending)) {
+			notif_send(irq, irq->notif_cfg.deferred);
+			irq->notif_cfg.deferred = 0;
+		}
+
+		return;
+	}
+
+	notif_send(irq, 1);
+
+	if (irq->notif_cfg.moderation.interval != 0) {
+		irq->notif_cfg.holdoff = true;
+		timeout_register(&irq->notif_cfg.holdoff_timeout,
+		    irq->notif_cfg.moderation.interval, notif_holdoff_end, irq);
+	}
+}
+
 /** Apply the top-half IRQ code to find out whether to accept the IRQ or not.
  *
  * @param irq IRQ structure.
@@ -529,23 +736,10 @@ void ipc_irq_top_half_handler(irq_t *irq)
 	assert(irq_spinlock_locked(&irq->lock));
 
 	if (irq->notif_cfg.answerbox) {
-		call_t *call = ipc_call_alloc();
-		if (!call)
-			return;
-
-		call->flags |= IPC_CALL_NOTIF;
-		/* Put a counter to the message */
-		call->priv = ++irq->notif_cfg.counter;
-
-		/* Set up args */
-		ipc_set_imethod(&call->data, irq->notif_cfg.imethod);
-		ipc_set_arg1(&call->data, irq->notif_cfg.scratch[1]);
-		ipc_set_arg2(&call->data, irq->notif_cfg.scratch[2]);
-		ipc_set_arg3(&call->data, irq->notif_cfg.scratch[3]);
-		ipc_set_arg4(&call->data, irq->notif_cfg.scratch[4]);
-		ipc_set_arg5(&call->data, irq->notif_cfg.scratch[5]);
-
-		send_call(irq, call);
+		if (irq_moderated(irq))
+			notif_moderated(irq);
+		else
+			notif_send(irq, 1);
 	}
 }
 
@@ -581,6 +775,7 @@ void ipc_irq_send_msg(irq_t *irq, sysarg_t a1, sysarg_t a2, sysarg_t a3,
 		ipc_set_arg3(&call->data, a3);
 		ipc_set_arg4(&call->data, a4);
 		ipc_set_arg5(&call->data, a5);
+		call->data.answer_label = 1;
 
 		send_call(irq, call);
 	}
@@ -35,6 +35,8 @@
 #include <assert.h>
 #include <ipc/sysipc_ops.h>
 #include <ipc/ipc.h>
+#include <ipc/xfer.h>
+#include <arch.h>
 #include <stdlib.h>
 #include <abi/errno.h>
 #include <syscall/copy.h>
@@ -42,17 +44,25 @@
 
 static errno_t request_preprocess(call_t *call, phone_t *phone)
 {
+	uspace_addr_t dst = ipc_get_arg1(&call->data);
 	size_t size = ipc_get_arg2(&call->data);
 
 	if (size > DATA_XFER_LIMIT) {
 		int flags = ipc_get_arg3(&call->data);
 
-		if (flags & IPC_XF_RESTRICT)
-			ipc_set_arg2(&call->data, DATA_XFER_LIMIT);
-		else
+		if (flags & IPC_XF_RESTRICT) {
+			size = DATA_XFER_LIMIT;
+			ipc_set_arg2(&call->data, size);
+		} else
 			return ELIMIT;
 	}
 
+	/*
+	 * Large buffers are pinned, so that the recipient can copy the data
+	 * right into them.
+	 */
+	call->xfer = ipc_xfer_pin(dst, size, true);
+
 	return EOK;
 }
 
@@ -74,6 +84,17 @@ static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 			 */
 			ipc_set_arg1(&answer->data, dst);
 
+			if (answer->xfer) {
+				errno_t rc = ipc_xfer_copy_from_uspace(
+				    answer->xfer, src, size);
+				if (rc)
+					ipc_set_retval(&answer->data, rc);
+				else
+					ipc_xfer_account(answer->sender, size, true);
+
+				return EOK;
+			}
+
 			answer->buffer = malloc(size);
 			if (!answer->buffer) {
 				ipc_set_retval(&answer->data, ENOMEM);
@@ -109,6 +130,8 @@ static errno_t answer_process(call_t *answer)
 		rc = copy_to_uspace(dst, answer->buffer, size);
 		if (rc)
 			ipc_set_retval(&answer->data, rc);
+		else
+			ipc_xfer_account(TASK, size, false);
 	}
 
 	return EOK;
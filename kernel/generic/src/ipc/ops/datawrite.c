@@ -35,6 +35,8 @@
 #include <assert.h>
 #include <ipc/sysipc_ops.h>
 #include <ipc/ipc.h>
+#include <ipc/xfer.h>
+#include <arch.h>
 #include <stdlib.h>
 #include <abi/errno.h>
 #include <syscall/copy.h>
@@ -55,6 +57,14 @@ static errno_t request_preprocess(call_t *call, phone_t *phone)
 			return ELIMIT;
 	}
 
+	/*
+	 * Large buffers are pinned instead and copied from only once, when
+	 * the call is answered.
+	 */
+	call->xfer = ipc_xfer_pin(src, size, false);
+	if (call->xfer)
+		return EOK;
+
 	call->buffer = (uint8_t *) malloc(size);
 	if (!call->buffer)
 		return ENOMEM;
@@ -72,7 +82,7 @@ static errno_t request_preprocess(call_t *call, phone_t *phone)
 
 static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 {
-	assert(answer->buffer);
+	assert((answer->buffer) || (answer->xfer));
 
 	if (!ipc_get_retval(&answer->data)) {
 		/* The recipient agreed to receive data. */
@@ -81,10 +91,18 @@ static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 		size_t max_size = ipc_get_arg2(olddata);
 
 		if (size <= max_size) {
-			errno_t rc = copy_to_uspace(dst,
-			    answer->buffer, size);
+			errno_t rc;
+			if (answer->xfer) {
+				rc = ipc_xfer_copy_to_uspace(dst, answer->xfer,
+				    size);
+			} else {
+				rc = copy_to_uspace(dst, answer->buffer, size);
+			}
+
 			if (rc)
 				ipc_set_retval(&answer->data, rc);
+			else
+				ipc_xfer_account(TASK, size, answer->xfer != NULL);
 		} else {
 			ipc_set_retval(&answer->data, ELIMIT);
 		}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ */
+
+#include <ipc/sysipc_ops.h>
+#include <ipc/ipc.h>
+#include <ipc/ring.h>
+#include <cap/cap.h>
+#include <mm/as.h>
+#include <synch/spinlock.h>
+#include <proc/task.h>
+#include <syscall/copy.h>
+#include <abi/errno.h>
+#include <arch.h>
+
+static errno_t request_preprocess(call_t *call, phone_t *phone)
+{
+	call->priv = 0;
+
+	size_t size = as_area_get_size(ipc_get_arg1(&call->data));
+	if (!size)
+		return EPERM;
+
+	kobject_t *robj = kobject_get(TASK,
+	    (cap_handle_t) ipc_get_arg3(&call->data), KOBJECT_TYPE_RING);
+	if (!robj)
+		return ENOENT;
+
+	/* Move robj's reference to call->priv */
+	call->priv = (sysarg_t) robj;
+
+	ipc_set_arg2(&call->data, size);
+	ipc_set_arg4(&call->data, cap_handle_raw(CAP_NIL));
+
+	return EOK;
+}
+
+static errno_t request_forget(call_t *call)
+{
+	/* Drop the reference held by call->priv */
+	if (call->priv)
+		kobject_put((kobject_t *) call->priv);
+	call->priv = 0;
+
+	return EOK;
+}
+
+static int request_process(call_t *call, answerbox_t *box)
+{
+	/*
+	 * Allocate the recipient's capability, but don't publish it until
+	 * the area has been shared.
+	 */
+	cap_handle_t rhandle = CAP_NIL;
+	if (cap_alloc(TASK, &rhandle) != EOK)
+		rhandle = CAP_NIL;
+
+	ipc_set_arg4(&call->data, cap_handle_raw(rhandle));
+	return 0;
+}
+
+static errno_t answer_cleanup(call_t *answer, ipc_data_t *olddata)
+{
+	cap_ring_handle_t rhandle = (cap_handle_t) ipc_get_arg4(olddata);
+
+	if (cap_handle_valid(rhandle))
+		cap_free(TASK, rhandle);
+
+	return EOK;
+}
+
+static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
+{
+	cap_ring_handle_t rhandle = (cap_handle_t) ipc_get_arg4(olddata);
+	kobject_t *robj = (kobject_t *) answer->priv;
+	errno_t rc = EOK;
+
+	if (ipc_get_retval(&answer->data) != EOK) {
+		/* The rings were not accepted */
+		answer_cleanup(answer, olddata);
+		return EOK;
+	}
+
+	if (!cap_handle_valid(rhandle)) {
+		ipc_set_retval(&answer->data, ELIMIT);
+		return ELIMIT;
+	}
+
+	irq_spinlock_lock(&answer->sender->lock, true);
+	as_t *as = answer->sender->as;
+	irq_spinlock_unlock(&answer->sender->lock, true);
+
+	uintptr_t dst_base = (uintptr_t) -1;
+	rc = as_area_share(as, ipc_get_arg1(olddata), ipc_get_arg2(olddata),
+	    AS, AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, &dst_base,
+	    ipc_get_arg1(&answer->data));
+
+	if (rc == EOK) {
+		rc = copy_to_uspace(ipc_get_arg2(&answer->data),
+		    &dst_base, sizeof(dst_base));
+	}
+
+	if (rc == EOK) {
+		/* Give the recipient its own reference to the doorbells */
+		kobject_add_ref(robj);
+		cap_publish(TASK, rhandle, robj);
+
+		/* Pass the recipient's handle in the answer's ARG4 */
+		ipc_set_arg4(&answer->data, cap_handle_raw(rhandle));
+	} else {
+		answer_cleanup(answer, olddata);
+	}
+
+	ipc_set_retval(&answer->data, rc);
+	return rc;
+}
+
+static errno_t answer_process(call_t *answer)
+{
+	/*
+	 * Drop the reference held by answer->priv. There is none if the
+	 * request did not pass request_preprocess().
+	 */
+	if (answer->priv)
+		kobject_put((kobject_t *) answer->priv);
+	answer->priv = 0;
+
+	return EOK;
+}
+
+sysipc_ops_t ipc_m_ring_share_ops = {
+	.request_preprocess = request_preprocess,
+	.request_forget = request_forget,
+	.request_process = request_process,
+	.answer_cleanup = answer_cleanup,
+	.answer_preprocess = answer_preprocess,
+	.answer_process = answer_process,
+};
+
+/** @}
+ */
@@ -63,9 +63,16 @@ static errno_t answer_preprocess(call_t *answer, ipc_data_t *olddata)
 		as_t *as = answer->sender->as;
 		irq_spinlock_unlock(&answer->sender->lock, true);
 
+		/*
+		 * The recipient may ask for a private copy-on-write snapshot
+		 * of the area instead of sharing it.
+		 */
+		unsigned int flags = ipc_get_arg3(olddata) |
+		    (ipc_get_arg3(&answer->data) & AS_AREA_COW);
+
 		uintptr_t dst_base = (uintptr_t) -1;
 		rc = as_area_share(as, ipc_get_arg1(olddata),
-		    ipc_get_arg2(olddata), AS, ipc_get_arg3(olddata),
+		    ipc_get_arg2(olddata), AS, flags,
 		    &dst_base, ipc_get_arg1(&answer->data));
 
 		if (rc == EOK) {
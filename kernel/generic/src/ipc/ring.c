@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Doorbells for shared-memory IPC rings.
+ *
+ * A client which wants to avoid a system call per request shares an
+ * address space area with the server by IPC_M_RING_SHARE. The area holds a
+ * submission ring for the requests and a completion ring for the answers.
+ * The peers exchange messages through the rings without entering the
+ * kernel and use the doorbells below only when the other side is asleep.
+ *
+ * The doorbells are wait queues, so a notification posted before the
+ * consumer actually goes to sleep is not lost. When one of the peers drops
+ * its capability, either explicitly or by exiting, the rings are closed and
+ * the other peer is told so by its next wait.
+ */
+
+#include <ipc/ring.h>
+#include <synch/waitq.h>
+#include <abi/cap.h>
+#include <abi/errno.h>
+#include <cap/cap.h>
+#include <mm/slab.h>
+#include <proc/task.h>
+#include <syscall/copy.h>
+#include <udebug/udebug.h>
+
+#include <stdint.h>
+
+static slab_cache_t *ring_cache;
+
+static void ring_destroy(void *arg)
+{
+	ipc_ring_t *ring = (ipc_ring_t *) arg;
+	slab_free(ring_cache, ring);
+}
+
+kobject_ops_t ring_kobject_ops = {
+	.destroy = ring_destroy
+};
+
+/** Close the rings and wake up everybody waiting for a doorbell */
+static void ring_close(ipc_ring_t *ring)
+{
+	atomic_store(&ring->closed, true);
+
+	for (unsigned int i = 0; i < IPC_RING_SIDES; i++)
+		waitq_wakeup(&ring->doorbell[i], WAKEUP_ALL);
+}
+
+static bool ring_cap_cleanup_cb(cap_t *cap, void *arg)
+{
+	kobject_t *kobj = cap_unpublish(cap->task, cap->handle,
+	    KOBJECT_TYPE_RING);
+	ring_close(kobj->ring);
+	kobject_put(kobj);
+	cap_free(cap->task, cap->handle);
+	return true;
+}
+
+/** Initialize the IPC ring subsystem */
+void ipc_ring_init(void)
+{
+	ring_cache = slab_cache_create("ipc_ring_t", sizeof(ipc_ring_t), 0,
+	    NULL, NULL, 0);
+}
+
+/** Clean-up all ring capabilities held by the exiting task */
+void ipc_ring_task_cleanup(void)
+{
+	caps_apply_to_kobject_type(TASK, KOBJECT_TYPE_RING,
+	    ring_cap_cleanup_cb, NULL);
+}
+
+/** Create the doorbells for a new pair of IPC rings
+ *
+ * @param[out] rhandle  Userspace address of the destination buffer that will
+ *                      receive the allocated ring capability.
+ *
+ * @return              Error code.
+ */
+sys_errno_t sys_ipc_ring_create(uspace_ptr_cap_ring_handle_t rhandle)
+{
+	ipc_ring_t *ring = slab_alloc(ring_cache, FRAME_ATOMIC);
+	if (!ring)
+		return (sys_errno_t) ENOMEM;
+
+	for (unsigned int i = 0; i < IPC_RING_SIDES; i++)
+		waitq_initialize(&ring->doorbell[i]);
+	atomic_store(&ring->closed, false);
+
+	kobject_t *kobj = kobject_alloc(0);
+	if (!kobj) {
+		slab_free(ring_cache, ring);
+		return (sys_errno_t) ENOMEM;
+	}
+	kobject_initialize(kobj, KOBJECT_TYPE_RING, ring);
+
+	cap_handle_t handle;
+	errno_t rc = cap_alloc(TASK, &handle);
+	if (rc != EOK) {
+		slab_free(ring_cache, ring);
+		kobject_free(kobj);
+		return (sys_errno_t) rc;
+	}
+
+	rc = copy_to_uspace(rhandle, &handle, sizeof(handle));
+	if (rc != EOK) {
+		cap_free(TASK, handle);
+		kobject_free(kobj);
+		slab_free(ring_cache, ring);
+		return (sys_errno_t) rc;
+	}
+
+	cap_publish(TASK, handle, kobj);
+
+	return (sys_errno_t) EOK;
+}
+
+/** Wait for the doorbell of one side of the rings
+ *
+ * @param rhandle  Ring capability handle.
+ * @param side     Side whose doorbell to wait for (ipc_ring_side_t).
+ * @param timeout  Timeout in microseconds.
+ *
+ * @return         EHANGUP if the rings have been closed by the peer.
+ * @return         Other error code.
+ */
+sys_errno_t sys_ipc_ring_wait(cap_ring_handle_t rhandle, sysarg_t side,
+    uint32_t timeout)
+{
+	if (side >= IPC_RING_SIDES)
+		return (sys_errno_t) EINVAL;
+
+	kobject_t *kobj = kobject_get(TASK, rhandle, KOBJECT_TYPE_RING);
+	if (!kobj)
+		return (sys_errno_t) ENOENT;
+
+	if (atomic_load(&kobj->ring->closed)) {
+		kobject_put(kobj);
+		return (sys_errno_t) EHANGUP;
+	}
+
+#ifdef CONFIG_UDEBUG
+	udebug_stoppable_begin();
+#endif
+
+	errno_t rc = waitq_sleep_timeout(&kobj->ring->doorbell[side], timeout,
+	    SYNCH_FLAGS_INTERRUPTIBLE, NULL);
+
+#ifdef CONFIG_UDEBUG
+	udebug_stoppable_end();
+#endif
+
+	kobject_put(kobj);
+
+	return (sys_errno_t) rc;
+}
+
+/** Ring the doorbell of one side of the rings
+ *
+ * @param rhandle  Ring capability handle.
+ * @param side     Side whose doorbell to ring (ipc_ring_side_t).
+ *
+ * @return         Error code.
+ */
+sys_errno_t sys_ipc_ring_notify(cap_ring_handle_t rhandle, sysarg_t side)
+{
+	if (side >= IPC_RING_SIDES)
+		return (sys_errno_t) EINVAL;
+
+	kobject_t *kobj = kobject_get(TASK, rhandle, KOBJECT_TYPE_RING);
+	if (!kobj)
+		return (sys_errno_t) ENOENT;
+
+	waitq_wakeup(&kobj->ring->doorbell[side], WAKEUP_FIRST);
+
+	kobject_put(kobj);
+	return (sys_errno_t) EOK;
+}
+
+/** Destroy a ring capability
+ *
+ * The rings are closed for the peer. The doorbells are destroyed when the
+ * last task holding them drops its capability.
+ *
+ * @param rhandle  Ring capability handle.
+ *
+ * @return         Error code.
+ */
+sys_errno_t sys_ipc_ring_destroy(cap_ring_handle_t rhandle)
+{
+	kobject_t *kobj = cap_unpublish(TASK, rhandle, KOBJECT_TYPE_RING);
+	if (!kobj)
+		return (sys_errno_t) ENOENT;
+	ring_close(kobj->ring);
+	kobject_put(kobj);
+	cap_free(TASK, rhandle);
+	return (sys_errno_t) EOK;
+}
+
+/** @}
+ */
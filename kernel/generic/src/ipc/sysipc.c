@@ -87,6 +87,9 @@ static inline bool method_is_forwardable(sysarg_t imethod)
 	case IPC_M_PHONE_HUNGUP:
 		/* This message is meant only for the original recipient. */
 		return false;
+	case IPC_M_RING_SHARE:
+		/* The rings are set up between the immediate peers only. */
+		return false;
 	default:
 		return true;
 	}
@@ -139,6 +142,7 @@ static inline bool answer_need_old(call_t *call)
 	case IPC_M_DATA_WRITE:
 	case IPC_M_DATA_READ:
 	case IPC_M_STATE_CHANGE_AUTHORIZE:
+	case IPC_M_RING_SHARE:
 		return true;
 	default:
 		return false;
@@ -409,17 +413,19 @@ sys_errno_t sys_ipc_call_async_fast(cap_phone_handle_t handle, sysarg_t imethod,
 	return EOK;
 }
 
-/** Make an asynchronous IPC call allowing to transmit the entire payload.
+/** Make an asynchronous IPC call with payload already copied from uspace.
+ *
+ * Common code for sys_ipc_call_async_slow() and sys_ipc_call_async_batch().
  *
  * @param handle  Phone capability for the call.
- * @param data    Userspace address of call data with the request.
+ * @param args    Payload arguments of the call.
  * @param label   User-defined label.
  *
  * @return See sys_ipc_call_async_fast().
  *
  */
-sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_data_t data,
-    sysarg_t label)
+static errno_t ipc_call_async_args(cap_phone_handle_t handle,
+    const sysarg_t *args, sysarg_t label)
 {
 	kobject_t *kobj = kobject_get(TASK, handle, KOBJECT_TYPE_PHONE);
 	if (!kobj)
@@ -436,13 +442,7 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 		return ENOMEM;
 	}
 
-	errno_t rc = copy_from_uspace(&call->data.args, data + offsetof(ipc_data_t, args),
-	    sizeof(call->data.args));
-	if (rc != EOK) {
-		kobject_put(call->kobject);
-		kobject_put(kobj);
-		return (sys_errno_t) rc;
-	}
+	memcpy(call->data.args, args, sizeof(call->data.args));
 
 	/* Set the user-defined label */
 	call->data.answer_label = label;
@@ -458,6 +458,72 @@ sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_da
 	return EOK;
 }
 
+/** Make an asynchronous IPC call allowing to transmit the entire payload.
+ *
+ * @param handle  Phone capability for the call.
+ * @param data    Userspace address of call data with the request.
+ * @param label   User-defined label.
+ *
+ * @return See sys_ipc_call_async_fast().
+ *
+ */
+sys_errno_t sys_ipc_call_async_slow(cap_phone_handle_t handle, uspace_ptr_ipc_data_t data,
+    sysarg_t label)
+{
+	sysarg_t args[IPC_CALL_LEN];
+
+	errno_t rc = copy_from_uspace(args, data + offsetof(ipc_data_t, args),
+	    sizeof(args));
+	if (rc != EOK)
+		return (sys_errno_t) rc;
+
+	return (sys_errno_t) ipc_call_async_args(handle, args, label);
+}
+
+/** Make a batch of asynchronous IPC calls in one syscall.
+ *
+ * Each entry of the array describes one call. The cap_handle member holds
+ * the phone capability to call over, answer_label holds the user-defined
+ * label and args hold the entire payload. The calls are made in the order
+ * of the array and the batch stops at the first call that cannot be made.
+ *
+ * @param data       Userspace address of an array of call data.
+ * @param count      Number of entries in the array.
+ * @param submitted  Userspace address where the number of calls actually
+ *                   made is stored.
+ *
+ * @return EOK if all calls were made.
+ * @return EINVAL if @a count exceeds IPC_MAX_BATCH.
+ * @return Error code of the first call that could not be made.
+ *
+ */
+sys_errno_t sys_ipc_call_async_batch(uspace_ptr_ipc_data_t data, sysarg_t count,
+    uspace_ptr_size_t submitted)
+{
+	if (count > IPC_MAX_BATCH)
+		return EINVAL;
+
+	errno_t rc = EOK;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		ipc_data_t req;
+
+		rc = copy_from_uspace(&req, data + i * sizeof(ipc_data_t),
+		    sizeof(req));
+		if (rc != EOK)
+			break;
+
+		rc = ipc_call_async_args((cap_phone_handle_t) req.cap_handle,
+		    req.args, req.answer_label);
+		if (rc != EOK)
+			break;
+	}
+
+	errno_t rc2 = copy_to_uspace(submitted, &i, sizeof(i));
+	return (sys_errno_t) (rc != EOK ? rc : rc2);
+}
+
 /** Forward a received call to another destination
  *
  * Common code for both the fast and the slow version.
@@ -757,6 +823,8 @@ sys_errno_t sys_ipc_hangup(cap_phone_handle_t handle)
 }
 
 /** Wait for an incoming IPC call or an answer.
+ *
+ * Common code for sys_ipc_wait_for_call() and sys_ipc_wait_for_calls().
  *
  * @param calldata Pointer to buffer where the call/answer data is stored.
  * @param usec     Timeout. See waitq_sleep_timeout() for explanation.
@@ -765,8 +833,8 @@ sys_errno_t sys_ipc_hangup(cap_phone_handle_t handle)
  *
  * @return An error code on error.
  */
-sys_errno_t sys_ipc_wait_for_call(uspace_ptr_ipc_data_t calldata, uint32_t usec,
-    unsigned int flags)
+static errno_t ipc_wait_for_call_uspace(uspace_ptr_ipc_data_t calldata,
+    uint32_t usec, unsigned int flags)
 {
 	call_t *call = NULL;
 	errno_t rc;
@@ -865,6 +933,63 @@ error:
 	return rc;
 }
 
+/** Wait for an incoming IPC call or an answer.
+ *
+ * @param calldata Pointer to buffer where the call/answer data is stored.
+ * @param usec     Timeout. See waitq_sleep_timeout() for explanation.
+ * @param flags    Select mode of sleep operation. See waitq_sleep_timeout()
+ *                 for explanation.
+ *
+ * @return An error code on error.
+ */
+sys_errno_t sys_ipc_wait_for_call(uspace_ptr_ipc_data_t calldata, uint32_t usec,
+    unsigned int flags)
+{
+	return (sys_errno_t) ipc_wait_for_call_uspace(calldata, usec, flags);
+}
+
+/** Wait for incoming IPC calls or answers and receive several at once.
+ *
+ * The first call is waited for as in sys_ipc_wait_for_call(). The rest of
+ * the array is then filled with calls and answers that are already pending
+ * in the answerbox, without blocking.
+ *
+ * @param calldata Pointer to an array where the call/answer data is stored.
+ * @param count    Number of entries in the array.
+ * @param usec     Timeout for the first call. See waitq_sleep_timeout() for
+ *                 explanation.
+ * @param flags    Select mode of sleep operation for the first call. See
+ *                 waitq_sleep_timeout() for explanation.
+ * @param received Userspace address where the number of received calls is
+ *                 stored.
+ *
+ * @return EINVAL if @a count is zero or exceeds IPC_MAX_BATCH.
+ * @return An error code if the first call could not be received.
+ */
+sys_errno_t sys_ipc_wait_for_calls(uspace_ptr_ipc_data_t calldata,
+    sysarg_t count, uint32_t usec, unsigned int flags,
+    uspace_ptr_size_t received)
+{
+	if ((count == 0) || (count > IPC_MAX_BATCH))
+		return EINVAL;
+
+	size_t n = 0;
+	errno_t rc = ipc_wait_for_call_uspace(calldata, usec, flags);
+	if (rc == EOK) {
+		n = 1;
+		while (n < count) {
+			if (ipc_wait_for_call_uspace(calldata +
+			    n * sizeof(ipc_data_t), SYNCH_NO_TIMEOUT,
+			    SYNCH_FLAGS_NON_BLOCKING) != EOK)
+				break;
+			n++;
+		}
+	}
+
+	errno_t rc2 = copy_to_uspace(received, &n, sizeof(n));
+	return (sys_errno_t) (rc != EOK ? rc : rc2);
+}
+
 /** Interrupt one thread from sys_ipc_wait_for_call().
  *
  */
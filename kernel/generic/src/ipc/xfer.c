@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_ipc
+ * @{
+ */
+/** @file
+ *
+ * Single-copy data transfers over IPC.
+ *
+ * IPC_M_DATA_WRITE and IPC_M_DATA_READ normally copy the data from the
+ * source address space into a kernel buffer and from there into the
+ * destination address space. For large transfers, the buffer of the side
+ * which makes the call is pinned instead and the other side copies the
+ * data directly from or into its frames, so that each byte is copied only
+ * once.
+ *
+ * Consequently, the data of a large IPC_M_DATA_WRITE is read from the
+ * buffer of the sender only when the receiver answers the call, not when
+ * the call is made. The sender must leave the buffer intact until the
+ * call is answered.
+ */
+
+#include <ipc/xfer.h>
+#include <mm/as.h>
+#include <mm/frame.h>
+#include <mm/km.h>
+#include <mm/page.h>
+#include <syscall/copy.h>
+#include <align.h>
+#include <config.h>
+#include <errno.h>
+#include <macros.h>
+#include <stdlib.h>
+#include <sysinfo/stats.h>
+
+/** Pin a buffer of the current task.
+ *
+ * @param buf   Userspace address of the buffer.
+ * @param size  Size of the buffer.
+ * @param write True if the data will be written into the buffer.
+ *
+ * @return Pinned buffer or NULL if the buffer cannot be pinned and the
+ *         data has to be copied through a kernel buffer.
+ *
+ */
+ipc_xfer_t *ipc_xfer_pin(uspace_addr_t buf, size_t size, bool write)
+{
+	if ((size < IPC_XFER_PIN_THRESHOLD) || (buf + size < buf))
+		return NULL;
+
+	uintptr_t base = ALIGN_DOWN(buf, PAGE_SIZE);
+	size_t offset = buf - base;
+	size_t pages = SIZE2FRAMES(offset + size);
+
+	ipc_xfer_t *xfer = malloc(sizeof(ipc_xfer_t) +
+	    pages * sizeof(uintptr_t));
+	if (!xfer)
+		return NULL;
+
+	if (as_frames_pin(base, pages, write, xfer->frames,
+	    &xfer->sh_info) != EOK) {
+		free(xfer);
+		return NULL;
+	}
+
+	xfer->offset = offset;
+	xfer->size = size;
+	xfer->pages = pages;
+	return xfer;
+}
+
+/** Unpin a pinned buffer and free it.
+ *
+ * @param xfer Pinned buffer.
+ *
+ */
+void ipc_xfer_release(ipc_xfer_t *xfer)
+{
+	as_frames_unpin(xfer->sh_info, xfer->frames, xfer->pages);
+	free(xfer);
+}
+
+/** Copy data between a pinned buffer and the current address space.
+ *
+ * @param xfer      Pinned buffer.
+ * @param uaddr     Userspace address in the current address space.
+ * @param size      Number of bytes to copy from the start of the buffer.
+ * @param to_uspace True to copy from the pinned buffer to @a uaddr.
+ *
+ * @return EOK on success or an error code from the copy.
+ *
+ */
+static errno_t ipc_xfer_copy(ipc_xfer_t *xfer, uspace_addr_t uaddr,
+    size_t size, bool to_uspace)
+{
+	assert(size <= xfer->size);
+
+	size_t done = 0;
+	for (size_t i = 0; done < size; i++) {
+		assert(i < xfer->pages);
+
+		size_t offset = (i == 0) ? xfer->offset : 0;
+		size_t len = min(PAGE_SIZE - offset, size - done);
+		uintptr_t frame = xfer->frames[i];
+
+		bool mapped = (frame >= config.identity_size);
+		uintptr_t kpage = mapped ? km_map(frame, PAGE_SIZE, PAGE_SIZE,
+		    PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE) : PA2KA(frame);
+
+		errno_t rc;
+		if (to_uspace) {
+			rc = copy_to_uspace(uaddr + done,
+			    (void *) (kpage + offset), len);
+		} else {
+			rc = copy_from_uspace((void *) (kpage + offset),
+			    uaddr + done, len);
+		}
+
+		if (mapped)
+			km_unmap(kpage, PAGE_SIZE);
+
+		if (rc != EOK)
+			return rc;
+
+		done += len;
+	}
+
+	return EOK;
+}
+
+/** Copy data from a pinned buffer to the current address space.
+ *
+ * @param dst  Destination userspace address.
+ * @param xfer Pinned source buffer.
+ * @param size Number of bytes to copy.
+ *
+ * @return EOK on success or an error code from copy_to_uspace().
+ *
+ */
+errno_t ipc_xfer_copy_to_uspace(uspace_addr_t dst, ipc_xfer_t *xfer,
+    size_t size)
+{
+	return ipc_xfer_copy(xfer, dst, size, true);
+}
+
+/** Copy data from the current address space to a pinned buffer.
+ *
+ * @param xfer Pinned destination buffer.
+ * @param src  Source userspace address.
+ * @param size Number of bytes to copy.
+ *
+ * @return EOK on success or an error code from copy_from_uspace().
+ *
+ */
+errno_t ipc_xfer_copy_from_uspace(ipc_xfer_t *xfer, uspace_addr_t src,
+    size_t size)
+{
+	return ipc_xfer_copy(xfer, src, size, false);
+}
+
+/** Account transferred data to the task which received it.
+ *
+ * @param task   Receiving task.
+ * @param size   Number of bytes transferred.
+ * @param pinned True if the data went directly through a pinned buffer.
+ *
+ */
+void ipc_xfer_account(task_t *task, size_t size, bool pinned)
+{
+	irq_spinlock_lock(&task->lock, true);
+	if (pinned)
+		task->ipc_info.data_pinned += size;
+	else
+		task->ipc_info.data_copied += size;
+	stats_touch(&task->stats_gen);
+	irq_spinlock_unlock(&task->lock, true);
+}
+
+/** @}
+ */
@@ -136,7 +136,7 @@ errno_t load_segment(elf_segment_header_t *entry, elf_header_t *elf, as_t *as)
 	if (entry->p_flags & PF_R)
 		flags |= AS_AREA_READ;
 
-	flags |= AS_AREA_CACHEABLE;
+	flags |= AS_AREA_CACHEABLE | AS_AREA_FAULT_AROUND;
 
 	/*
 	 * Align vaddr down, inserting a little "gap" at the beginning.
@@ -41,6 +41,10 @@
 
 #include <lib/memfnc.h>
 #include <typedefs.h>
+#include <arch/asm.h>
+
+#ifndef ARCH_HAS_MEMFNC
+
 
 /** Fill block of memory.
  *
@@ -86,6 +90,8 @@ void *memcpy(void *dst, const void *src, size_t cnt)
 	return dst;
 }
 
+#endif /* !ARCH_HAS_MEMFNC */
+
 /** Compare two memory areas.
  *
  * @param s1  Pointer to the first area to compare.
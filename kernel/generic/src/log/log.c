@@ -40,6 +40,8 @@
 #include <ipc/event.h>
 #include <ipc/irq.h>
 #include <arch.h>
+#include <cpu.h>
+#include <config.h>
 #include <panic.h>
 #include <putchar.h>
 #include <atomic.h>
@@ -50,136 +52,313 @@
 #include <printf/printf_core.h>
 #include <stdarg.h>
 #include <log.h>
+#include <macros.h>
 #include <console/console.h>
+#include <time/clock.h>
 #include <abi/log.h>
+#include <abi/bootmark.h>
+#include <main/bootmark.h>
+#include <proc/task.h>
 #include <stdlib.h>
 
-#define LOG_PAGES    8
-#define LOG_LENGTH   (LOG_PAGES * PAGE_SIZE)
-#define LOG_ENTRY_HEADER_LENGTH (sizeof(size_t) + sizeof(uint32_t))
+#define LOG_BOOT_PAGES  8
+#define LOG_BOOT_LENGTH  (LOG_BOOT_PAGES * PAGE_SIZE)
+#define LOG_CPU_PAGES   4
+#define LOG_CPU_LENGTH   (LOG_CPU_PAGES * PAGE_SIZE)
 
-/** Cyclic buffer holding the data for kernel log */
-uint8_t log_buffer[LOG_LENGTH] __attribute__((aligned(PAGE_SIZE)));
+/*
+ * Every entry starts with its length, serial number, facility, level and
+ * the uptime in microseconds at which it was begun.
+ */
+#define LOG_ENTRY_HEADER_LENGTH \
+	(sizeof(size_t) + 3 * sizeof(uint32_t) + sizeof(uint64_t))
+
+/** Number of entry bytes converted to kio characters at once */
+#define LOG_KIO_CHUNK  64
+
+/** Maximum length of an UTF-8 encoded character */
+#define LOG_UTF8_MAX  4
+
+/** Cyclic buffer holding the kernel log entries written by one CPU
+ *
+ * Entries are appended only by the owning CPU with interrupts disabled,
+ * the lock is contended only by readers.
+ */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+
+	uint8_t *buffer;
+	size_t length;
+
+	/** Position in the buffer where the first log entry starts */
+	size_t start;
+	/** Sum of length of all log entries currently stored in the buffer */
+	size_t used;
+	/** Start of the next entry to be handed to uspace starting from start */
+	size_t next_for_uspace;
+
+	/** Starting position of the entry currently being written */
+	size_t current_start;
+	/** Length (including header) of the entry currently being written */
+	size_t current_len;
+	/** Interrupt level to restore when the current entry is finished */
+	ipl_t ipl;
+} log_ring_t;
+
+/** Buffer for the entries logged before the per-CPU rings exist */
+static uint8_t log_boot_buffer[LOG_BOOT_LENGTH] __attribute__((aligned(PAGE_SIZE)));
+
+/** Ring for the entries logged before the per-CPU rings exist */
+static log_ring_t log_boot_ring;
+
+/** Per-CPU rings, indexed by CPU ID */
+static log_ring_t *log_rings = NULL;
 
 /** Kernel log initialized */
 static atomic_bool log_inited = false;
 
-/** Position in the cyclic buffer where the first log entry starts */
-size_t log_start = 0;
+/** Overall count of logged messages, which may overflow as needed */
+static atomic_size_t log_counter = 0;
 
-/** Sum of length of all log entries currently stored in the cyclic buffer */
-size_t log_used = 0;
+/** Number of entries discarded before uspace could read them */
+static atomic_size_t log_dropped = 0;
 
-/** Log spinlock */
-SPINLOCK_STATIC_INITIALIZE_NAME(log_lock, "log_lock");
+static void log_update(void *);
 
-/** Overall count of logged messages, which may overflow as needed */
-static uint32_t log_counter = 0;
+static void log_ring_initialize(log_ring_t *ring, uint8_t *buffer,
+    size_t length)
+{
+	irq_spinlock_initialize(&ring->lock, "log_ring.lock");
+	ring->buffer = buffer;
+	ring->length = length;
+	ring->start = 0;
+	ring->used = 0;
+	ring->next_for_uspace = 0;
+	ring->current_start = 0;
+	ring->current_len = 0;
+}
 
-/** Starting position of the entry currently being written to the log */
-static size_t log_current_start = 0;
+/** Get the ring to which the current CPU appends entries
+ *
+ * Interrupts must be disabled.
+ */
+static log_ring_t *log_ring_current(void)
+{
+	if ((log_rings != NULL) && (CPU != NULL))
+		return &log_rings[CPU->id];
 
-/** Length (including header) of the entry currently being written to the log */
-static size_t log_current_len = 0;
+	/* Early boot, only the bootstrap CPU is running. */
+	if (log_boot_ring.buffer == NULL) {
+		log_ring_initialize(&log_boot_ring, log_boot_buffer,
+		    LOG_BOOT_LENGTH);
+	}
 
-/** Start of the next entry to be handed to uspace starting from log_start */
-static size_t next_for_uspace = 0;
+	return &log_boot_ring;
+}
 
-static void log_update(void *);
+static sysarg_t log_get_dropped(sysinfo_item_t *item, void *data)
+{
+	return atomic_load(&log_dropped);
+}
 
 /** Initialize kernel logging facility
+ *
+ * Sets up the per-CPU rings. The entries logged so far stay in the boot
+ * ring and are merged with the others on read.
  *
  */
 void log_init(void)
 {
+	log_ring_t *rings = malloc(config.cpu_count * sizeof(log_ring_t));
+	if (rings != NULL) {
+		size_t i;
+		for (i = 0; i < config.cpu_count; i++) {
+			uint8_t *buffer = malloc(LOG_CPU_LENGTH);
+			if (buffer == NULL)
+				break;
+
+			log_ring_initialize(&rings[i], buffer, LOG_CPU_LENGTH);
+		}
+
+		if (i == config.cpu_count) {
+			log_rings = rings;
+		} else {
+			while (i-- > 0)
+				free(rings[i].buffer);
+			free(rings);
+		}
+	}
+
+	sysinfo_set_item_gen_val("klog.dropped", NULL, log_get_dropped, NULL);
+
 	event_set_unmask_callback(EVENT_KLOG, log_update);
 	atomic_store(&log_inited, true);
 }
 
-static size_t log_copy_from(uint8_t *data, size_t pos, size_t len)
+static size_t log_copy_from(log_ring_t *ring, uint8_t *data, size_t pos,
+    size_t len)
 {
-	for (size_t i = 0; i < len; i++, pos = (pos + 1) % LOG_LENGTH) {
-		data[i] = log_buffer[pos];
+	for (size_t i = 0; i < len; i++, pos = (pos + 1) % ring->length) {
+		data[i] = ring->buffer[pos];
 	}
 	return pos;
 }
 
-static size_t log_copy_to(const uint8_t *data, size_t pos, size_t len)
+static size_t log_copy_to(log_ring_t *ring, const uint8_t *data, size_t pos,
+    size_t len)
 {
-	for (size_t i = 0; i < len; i++, pos = (pos + 1) % LOG_LENGTH) {
-		log_buffer[pos] = data[i];
+	for (size_t i = 0; i < len; i++, pos = (pos + 1) % ring->length) {
+		ring->buffer[pos] = data[i];
 	}
 	return pos;
 }
 
-/** Append data to the currently open log entry.
+/** Append data to the currently open log entry of a ring.
  *
- * This function requires that the log_lock is acquired by the caller.
+ * This function requires that the ring lock is acquired by the caller.
  */
-static void log_append(const uint8_t *data, size_t len)
+static void log_ring_append(log_ring_t *ring, const uint8_t *data, size_t len)
 {
 	/* Cap the length so that the entry entirely fits into the buffer */
-	if (len > LOG_LENGTH - log_current_len) {
-		len = LOG_LENGTH - log_current_len;
+	if (len > ring->length - ring->current_len) {
+		len = ring->length - ring->current_len;
 	}
 
 	if (len == 0)
 		return;
 
-	size_t log_free = LOG_LENGTH - log_used - log_current_len;
+	size_t log_free = ring->length - ring->used - ring->current_len;
 
 	/* Discard older entries to make space, if necessary */
 	while (len > log_free) {
 		size_t entry_len;
-		log_copy_from((uint8_t *) &entry_len, log_start, sizeof(size_t));
-		log_start = (log_start + entry_len) % LOG_LENGTH;
-		log_used -= entry_len;
+		log_copy_from(ring, (uint8_t *) &entry_len, ring->start,
+		    sizeof(size_t));
+		ring->start = (ring->start + entry_len) % ring->length;
+		ring->used -= entry_len;
 		log_free += entry_len;
-		next_for_uspace -= entry_len;
+
+		if (ring->next_for_uspace >= entry_len) {
+			ring->next_for_uspace -= entry_len;
+		} else {
+			/* The entry has not been read by uspace yet */
+			ring->next_for_uspace = 0;
+			atomic_inc(&log_dropped);
+		}
 	}
 
-	size_t pos = (log_current_start + log_current_len) % LOG_LENGTH;
-	log_copy_to(data, pos, len);
-	log_current_len += len;
+	size_t pos = (ring->current_start + ring->current_len) % ring->length;
+	log_copy_to(ring, data, pos, len);
+	ring->current_len += len;
+}
+
+/** Append data to the currently open log entry.
+ *
+ * Requires that an entry has been started using log_begin().
+ */
+static void log_append(const uint8_t *data, size_t len)
+{
+	log_ring_append(log_ring_current(), data, len);
+}
+
+/** Get uptime in microseconds */
+static uint64_t log_timestamp(void)
+{
+	if (uptime == NULL)
+		return 0;
+
+	sysarg_t sec;
+	sysarg_t usec;
+
+	do {
+		sec = uptime->seconds1;
+		usec = uptime->useconds;
+	} while (sec != uptime->seconds2);
+
+	return (uint64_t) sec * 1000000 + usec;
 }
 
 /** Begin writing an entry to the log.
  *
- * This acquires the log and output buffer locks, so only calls to log_* functions should
- * be used until calling log_end.
+ * This acquires the log ring of the current CPU, so only calls to log_*
+ * functions should be used until calling log_end.
  */
 void log_begin(log_facility_t fac, log_level_t level)
 {
-	spinlock_lock(&log_lock);
-	spinlock_lock(&kio_lock);
+	ipl_t ipl = interrupts_disable();
+	log_ring_t *ring = log_ring_current();
+
+	irq_spinlock_lock(&ring->lock, false);
+	ring->ipl = ipl;
 
-	log_current_start = (log_start + log_used) % LOG_LENGTH;
-	log_current_len = 0;
+	ring->current_start = (ring->start + ring->used) % ring->length;
+	ring->current_len = 0;
 
 	/* Write header of the log entry, the length will be written in log_end() */
-	log_append((uint8_t *) &log_current_len, sizeof(size_t));
-	log_append((uint8_t *) &log_counter, sizeof(uint32_t));
+	uint32_t serial = atomic_postinc(&log_counter);
 	uint32_t fac32 = fac;
 	uint32_t lvl32 = level;
-	log_append((uint8_t *) &fac32, sizeof(uint32_t));
-	log_append((uint8_t *) &lvl32, sizeof(uint32_t));
+	uint64_t timestamp = log_timestamp();
+	log_ring_append(ring, (uint8_t *) &ring->current_len, sizeof(size_t));
+	log_ring_append(ring, (uint8_t *) &serial, sizeof(uint32_t));
+	log_ring_append(ring, (uint8_t *) &fac32, sizeof(uint32_t));
+	log_ring_append(ring, (uint8_t *) &lvl32, sizeof(uint32_t));
+	log_ring_append(ring, (uint8_t *) &timestamp, sizeof(uint64_t));
+}
+
+/** Output the message of the current entry of a ring to kio.
+ *
+ * Requires that kio_lock is acquired by the caller.
+ */
+static void log_ring_push_kio(log_ring_t *ring)
+{
+	if (ring->current_len <= LOG_ENTRY_HEADER_LENGTH)
+		return;
 
-	log_counter++;
+	size_t pos = (ring->current_start + LOG_ENTRY_HEADER_LENGTH) %
+	    ring->length;
+	size_t len = ring->current_len - LOG_ENTRY_HEADER_LENGTH;
+	char chunk[LOG_KIO_CHUNK];
+
+	while (len > 0) {
+		size_t size = min(len, LOG_KIO_CHUNK);
+		log_copy_from(ring, (uint8_t *) chunk, pos, size);
+
+		/*
+		 * Leave a possibly incomplete character at the end of the
+		 * chunk for the next one, unless this is the last chunk.
+		 */
+		size_t limit = (size < len) ? size - LOG_UTF8_MAX : size;
+		size_t offset = 0;
+		while (offset < limit)
+			kio_push_char(str_decode(chunk, &offset, size));
+
+		pos = (pos + offset) % ring->length;
+		len -= offset;
+	}
 }
 
 /** Finish writing an entry to the log.
  *
- * This releases the log and output buffer locks.
+ * This releases the log ring of the current CPU.
  */
 void log_end(void)
 {
+	log_ring_t *ring = log_ring_current();
+
 	/* Set the length in the header to correct value */
-	log_copy_to((uint8_t *) &log_current_len, log_current_start, sizeof(size_t));
-	log_used += log_current_len;
+	log_copy_to(ring, (uint8_t *) &ring->current_len, ring->current_start,
+	    sizeof(size_t));
+	ring->used += ring->current_len;
 
+	spinlock_lock(&kio_lock);
+	log_ring_push_kio(ring);
 	kio_push_char('\n');
 	spinlock_unlock(&kio_lock);
-	spinlock_unlock(&log_lock);
+
+	ipl_t ipl = ring->ipl;
+	irq_spinlock_unlock(&ring->lock, false);
+	interrupts_restore(ipl);
 
 	/* This has to be called after we released the locks above */
 	kio_flush();
@@ -187,15 +366,40 @@ void log_end(void)
 	log_update(NULL);
 }
 
+/** Get the number of rings, including the boot ring */
+static size_t log_ring_count(void)
+{
+	return (log_rings != NULL) ? config.cpu_count + 1 : 1;
+}
+
+/** Get a ring by its index, the boot ring is the last one */
+static log_ring_t *log_ring_get(size_t i)
+{
+	if ((log_rings != NULL) && (i < config.cpu_count))
+		return &log_rings[i];
+
+	return &log_boot_ring;
+}
+
 static void log_update(void *event)
 {
 	if (!atomic_load(&log_inited))
 		return;
 
-	spinlock_lock(&log_lock);
-	if (next_for_uspace < log_used)
+	bool pending = false;
+
+	for (size_t i = 0; (i < log_ring_count()) && (!pending); i++) {
+		log_ring_t *ring = log_ring_get(i);
+		if (ring->buffer == NULL)
+			continue;
+
+		irq_spinlock_lock(&ring->lock, true);
+		pending = (ring->next_for_uspace < ring->used);
+		irq_spinlock_unlock(&ring->lock, true);
+	}
+
+	if (pending)
 		event_notify_0(EVENT_KLOG, true);
-	spinlock_unlock(&log_lock);
 }
 
 static int log_printf_str_write(const char *str, size_t size, void *data)
@@ -204,7 +408,7 @@ static int log_printf_str_write(const char *str, size_t size, void *data)
 	size_t chars = 0;
 
 	while (offset < size) {
-		kio_push_char(str_decode(str, &offset, size));
+		str_decode(str, &offset, size);
 		chars++;
 	}
 
@@ -220,8 +424,6 @@ static int log_printf_wstr_write(const char32_t *wstr, size_t size, void *data)
 	size_t chars = 0;
 
 	for (offset = 0; offset < size; offset += sizeof(char32_t), chars++) {
-		kio_push_char(wstr[chars]);
-
 		size_t buffer_offset = 0;
 		errno_t rc = chr_encode(wstr[chars], buffer, &buffer_offset, 16);
 		if (rc != EOK) {
@@ -291,6 +493,101 @@ int log(log_facility_t fac, log_level_t level, const char *fmt, ...)
 	return ret;
 }
 
+/** Find the ring holding the oldest entry not yet handed to uspace
+ *
+ * @param[out] serial Serial number of the entry.
+ *
+ * @return The ring or NULL if all entries have been handed to uspace.
+ */
+static log_ring_t *log_oldest_for_uspace(uint32_t *serial)
+{
+	log_ring_t *oldest = NULL;
+
+	for (size_t i = 0; i < log_ring_count(); i++) {
+		log_ring_t *ring = log_ring_get(i);
+		if (ring->buffer == NULL)
+			continue;
+
+		irq_spinlock_lock(&ring->lock, true);
+
+		if (ring->next_for_uspace < ring->used) {
+			size_t pos = (ring->start + ring->next_for_uspace +
+			    sizeof(size_t)) % ring->length;
+			uint32_t entry_serial;
+			log_copy_from(ring, (uint8_t *) &entry_serial, pos,
+			    sizeof(uint32_t));
+
+			if ((oldest == NULL) ||
+			    ((int32_t) (entry_serial - *serial) < 0)) {
+				oldest = ring;
+				*serial = entry_serial;
+			}
+		}
+
+		irq_spinlock_unlock(&ring->lock, true);
+	}
+
+	return oldest;
+}
+
+/** Copy log entries for uspace, merging the rings by serial number
+ *
+ * @param data     Destination buffer.
+ * @param size     Size of the destination buffer.
+ * @param[out] copied Number of bytes copied.
+ *
+ * @return EOK on success, EOVERFLOW if the oldest entry does not fit.
+ */
+static errno_t log_read_for_uspace(char *data, size_t size, size_t *copied)
+{
+	uint32_t serial;
+	log_ring_t *ring;
+
+	*copied = 0;
+
+	while ((ring = log_oldest_for_uspace(&serial)) != NULL) {
+		irq_spinlock_lock(&ring->lock, true);
+
+		if (ring->next_for_uspace >= ring->used) {
+			/* Raced with another reader */
+			irq_spinlock_unlock(&ring->lock, true);
+			continue;
+		}
+
+		size_t entry_len;
+		size_t pos = (ring->start + ring->next_for_uspace) %
+		    ring->length;
+		log_copy_from(ring, (uint8_t *) &entry_len, pos, sizeof(size_t));
+
+		if (entry_len > PAGE_SIZE) {
+			/*
+			 * Since we limit data transfer
+			 * to uspace to a maximum of PAGE_SIZE
+			 * bytes, skip any entries larger
+			 * than this limit to prevent
+			 * userspace being stuck trying to
+			 * read them.
+			 */
+			ring->next_for_uspace += entry_len;
+			irq_spinlock_unlock(&ring->lock, true);
+			continue;
+		}
+
+		if (size < *copied + entry_len) {
+			irq_spinlock_unlock(&ring->lock, true);
+			return (*copied == 0) ? EOVERFLOW : EOK;
+		}
+
+		log_copy_from(ring, (uint8_t *) (data + *copied), pos, entry_len);
+		*copied += entry_len;
+		ring->next_for_uspace += entry_len;
+
+		irq_spinlock_unlock(&ring->lock, true);
+	}
+
+	return EOK;
+}
+
 /** Control of the log from uspace
  *
  */
@@ -328,43 +625,8 @@ sys_errno_t sys_klog(sysarg_t operation, uspace_addr_t buf, size_t size,
 		if (!data)
 			return (sys_errno_t) ENOMEM;
 
-		size_t entry_len = 0;
-		size_t copied = 0;
-
-		rc = EOK;
-
-		spinlock_lock(&log_lock);
-
-		while (next_for_uspace < log_used) {
-			size_t pos = (log_start + next_for_uspace) % LOG_LENGTH;
-			log_copy_from((uint8_t *) &entry_len, pos, sizeof(size_t));
-
-			if (entry_len > PAGE_SIZE) {
-				/*
-				 * Since we limit data transfer
-				 * to uspace to a maximum of PAGE_SIZE
-				 * bytes, skip any entries larger
-				 * than this limit to prevent
-				 * userspace being stuck trying to
-				 * read them.
-				 */
-				next_for_uspace += entry_len;
-				continue;
-			}
-
-			if (size < copied + entry_len) {
-				if (copied == 0)
-					rc = EOVERFLOW;
-				break;
-			}
-
-			log_copy_from((uint8_t *) (data + copied), pos, entry_len);
-			copied += entry_len;
-			next_for_uspace += entry_len;
-		}
-
-		spinlock_unlock(&log_lock);
-
+		size_t copied;
+		rc = log_read_for_uspace(data, size, &copied);
 		if (rc != EOK) {
 			free(data);
 			return (sys_errno_t) rc;
@@ -378,7 +640,25 @@ sys_errno_t sys_klog(sysarg_t operation, uspace_addr_t buf, size_t size,
 			return (sys_errno_t) rc;
 
 		return copy_to_uspace(uspace_nread, &copied, sizeof(copied));
-		return EOK;
+	case KLOG_BOOTMARK:
+		data = (char *) malloc(BOOTMARK_NAME_SIZE);
+		if (!data)
+			return (sys_errno_t) ENOMEM;
+
+		if (size >= BOOTMARK_NAME_SIZE)
+			size = BOOTMARK_NAME_SIZE - 1;
+
+		rc = copy_from_uspace(data, buf, size);
+		if (rc) {
+			free(data);
+			return (sys_errno_t) rc;
+		}
+		data[size] = 0;
+
+		rc = bootmark_task(TASK->taskid, data);
+
+		free(data);
+		return (sys_errno_t) rc;
 	default:
 		return (sys_errno_t) ENOTSUP;
 	}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Boot timeline.
+ *
+ * Significant boot milestones, both in the kernel and in user space, are
+ * recorded together with the uptime at which they were reached. Each
+ * milestone is announced in the kernel log with BOOTMARK_LOG_PREFIX and
+ * the whole timeline is available as the BOOTMARK_SYSINFO sysinfo item.
+ *
+ * Milestones recorded before the clock is running have a zero timestamp.
+ * Milestones recorded before bootmark_init() are logged once the kernel
+ * log is available.
+ */
+
+#include <main/bootmark.h>
+#include <abi/bootmark.h>
+#include <inttypes.h>
+#include <log.h>
+#include <mem.h>
+#include <print.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <str.h>
+#include <synch/spinlock.h>
+#include <sysinfo/sysinfo.h>
+#include <time/clock.h>
+
+static bootmark_t bootmarks[BOOTMARK_MAX];
+static size_t bootmark_count;
+
+/** Set by bootmark_init(), until then the boot is single-threaded. */
+static bool bootmark_ready = false;
+
+IRQ_SPINLOCK_STATIC_INITIALIZE(bootmark_lock);
+
+/** Get uptime in microseconds. */
+static uint64_t bootmark_time(void)
+{
+	if (uptime == NULL)
+		return 0;
+
+	sysarg_t sec;
+	sysarg_t usec;
+
+	do {
+		sec = uptime->seconds1;
+		usec = uptime->useconds;
+	} while (sec != uptime->seconds2);
+
+	return (uint64_t) sec * 1000000 + usec;
+}
+
+/** Write a milestone to the kernel log. */
+static void bootmark_log(bootmark_t *mark)
+{
+	log(LF_OTHER, LVL_NOTE, BOOTMARK_LOG_PREFIX " %" PRIu64 " %" PRIu64
+	    " %s", mark->time, mark->task_id, mark->name);
+}
+
+/** Record a milestone.
+ *
+ * @param task_id Task which reached the milestone, 0 for the kernel.
+ * @param name    Name of the milestone.
+ *
+ * @return EOK on success, ELIMIT if no more milestones can be recorded.
+ */
+errno_t bootmark_task(task_id_t task_id, const char *name)
+{
+	bootmark_t *mark;
+
+	if (bootmark_ready)
+		irq_spinlock_lock(&bootmark_lock, true);
+
+	if (bootmark_count >= BOOTMARK_MAX) {
+		if (bootmark_ready)
+			irq_spinlock_unlock(&bootmark_lock, true);
+		return ELIMIT;
+	}
+
+	mark = &bootmarks[bootmark_count];
+	mark->time = bootmark_time();
+	mark->task_id = task_id;
+	str_cpy(mark->name, BOOTMARK_NAME_SIZE, name);
+	bootmark_count++;
+
+	if (!bootmark_ready)
+		return EOK;
+
+	irq_spinlock_unlock(&bootmark_lock, true);
+
+	/* Recorded entries never change. */
+	bootmark_log(mark);
+	return EOK;
+}
+
+/** Record a kernel milestone.
+ *
+ * @param fmt Format of the milestone name.
+ */
+void bootmark(const char *fmt, ...)
+{
+	char name[BOOTMARK_NAME_SIZE];
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(name, BOOTMARK_NAME_SIZE, fmt, args);
+	va_end(args);
+
+	(void) bootmark_task(0, name);
+}
+
+/** Get the boot timeline.
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Array of bootmark_t. If the return value is not NULL,
+ *         it should be freed in the context of the sysinfo request.
+ */
+static void *bootmark_get_timeline(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	bootmark_t *marks;
+	size_t count;
+
+	irq_spinlock_lock(&bootmark_lock, true);
+	count = bootmark_count;
+	irq_spinlock_unlock(&bootmark_lock, true);
+
+	*size = count * sizeof(bootmark_t);
+	if (dry_run || count == 0)
+		return NULL;
+
+	marks = malloc(*size);
+	if (marks == NULL) {
+		*size = 0;
+		return NULL;
+	}
+
+	/* Entries below bootmark_count never change. */
+	memcpy(marks, bootmarks, *size);
+	return marks;
+}
+
+/** Initialize the boot timeline.
+ *
+ * Must be called after log_init(), while the boot is still
+ * single-threaded.
+ */
+void bootmark_init(void)
+{
+	size_t i;
+
+	for (i = 0; i < bootmark_count; i++)
+		bootmark_log(&bootmarks[i]);
+
+	bootmark_ready = true;
+
+	sysinfo_set_item_gen_data(BOOTMARK_SYSINFO, NULL,
+	    bootmark_get_timeline, NULL);
+}
+
+/** @}
+ */
@@ -43,6 +43,7 @@
 
 #include <assert.h>
 #include <main/kinit.h>
+#include <main/bootmark.h>
 #include <config.h>
 #include <arch.h>
 #include <proc/scheduler.h>
@@ -58,6 +59,8 @@
 #include <mm/as.h>
 #include <mm/frame.h>
 #include <mm/km.h>
+#include <mm/zero.h>
+#include <mm/reclaim.h>
 #include <stdio.h>
 #include <log.h>
 #include <mem.h>
@@ -70,6 +73,7 @@
 #include <str.h>
 #include <sysinfo/stats.h>
 #include <sysinfo/sysinfo.h>
+#include <synch/rcu.h>
 #include <align.h>
 #include <stdlib.h>
 
@@ -108,6 +112,8 @@ void kinit(void *arg)
 
 	interrupts_disable();
 
+	bootmark("kernel: kinit");
+
 #ifdef CONFIG_SMP
 	if (config.cpu_count > 1) {
 		waitq_initialize(&ap_completion_wq);
@@ -150,6 +156,14 @@ void kinit(void *arg)
 	 * At this point SMP, if present, is configured.
 	 */
 	ARCH_OP(post_smp_init);
+	bootmark("kernel: smp up (%u cpus)", config.cpu_count);
+
+	/* Start thread detecting RCU grace periods */
+	thread = thread_create(krcu, NULL, TASK, THREAD_FLAG_NONE, "krcu");
+	if (thread != NULL)
+		thread_ready(thread);
+	else
+		log(LF_OTHER, LVL_ERROR, "Unable to create krcu thread");
 
 	/* Start thread computing system load */
 	thread = thread_create(kload, NULL, TASK, THREAD_FLAG_NONE,
@@ -159,6 +173,22 @@ void kinit(void *arg)
 	else
 		log(LF_OTHER, LVL_ERROR, "Unable to create kload thread");
 
+	/* Start thread keeping the pool of zeroed frames full */
+	thread = thread_create(kzero, NULL, TASK,
+	    THREAD_FLAG_IDLE | THREAD_FLAG_UNCOUNTED, "kzero");
+	if (thread != NULL)
+		thread_ready(thread);
+	else
+		log(LF_OTHER, LVL_ERROR, "Unable to create kzero thread");
+
+	/* Start thread reclaiming memory in the background */
+	thread = thread_create(kreclaim, NULL, TASK,
+	    THREAD_FLAG_UNCOUNTED, "kreclaim");
+	if (thread != NULL)
+		thread_ready(thread);
+	else
+		log(LF_OTHER, LVL_ERROR, "Unable to create kreclaim thread");
+
 #ifdef CONFIG_KCONSOLE
 	if (stdin) {
 		/*
@@ -264,12 +294,14 @@ void kinit(void *arg)
 		if (rc == 0) {
 			assert(programs[i].task != NULL);
 
+			bootmark("kernel: spawn %s", namebuf);
+
 			/*
 			 * Set permissions to init userspace tasks.
 			 */
 			perm_set(programs[i].task,
 			    PERM_PERM | PERM_MEM_MANAGER |
-			    PERM_IO_MANAGER | PERM_IRQ_REG);
+			    PERM_IO_MANAGER | PERM_IRQ_REG | PERM_RT_SCHED);
 
 			if (!ipc_box_0) {
 				ipc_box_0 = &programs[i].task->answerbox;
@@ -303,6 +335,8 @@ void kinit(void *arg)
 			program_ready(&programs[i]);
 	}
 
+	bootmark("kernel: init tasks running");
+
 #ifdef CONFIG_KCONSOLE
 	if (!stdin) {
 		thread_sleep(10);
@@ -58,7 +58,9 @@
 #include <proc/scheduler.h>
 #include <proc/thread.h>
 #include <proc/task.h>
+#include <synch/rcu.h>
 #include <main/kinit.h>
+#include <main/bootmark.h>
 #include <main/version.h>
 #include <console/kconsole.h>
 #include <console/console.h>
@@ -86,9 +88,14 @@
 #include <ddi/ddi.h>
 #include <main/main.h>
 #include <ipc/event.h>
+#include <ipc/ring.h>
 #include <sysinfo/sysinfo.h>
 #include <sysinfo/stats.h>
+#include <profile.h>
+#include <symtab_lookup.h>
+#include <ktrace.h>
 #include <lib/ra.h>
+#include <adt/bdict.h>
 #include <cap/cap.h>
 
 /*
@@ -148,6 +155,38 @@ static void main_bsp_separated_stack(void);
 static void main_ap_separated_stack(void);
 #endif
 
+/** Check whether an option is present among the boot arguments.
+ *
+ * The boot arguments are separated by spaces.
+ *
+ * @param name Name of the option.
+ *
+ * @return True if the option is present.
+ *
+ */
+bool bargs_option(const char *name)
+{
+	size_t len = str_size(name);
+	const char *cur = bargs;
+
+	while (*cur != '\0') {
+		while (*cur == ' ')
+			cur++;
+
+		const char *end = cur;
+		while ((*end != '\0') && (*end != ' '))
+			end++;
+
+		if (((size_t) (end - cur) == len) &&
+		    (str_lcmp(cur, name, len) == 0))
+			return true;
+
+		cur = end;
+	}
+
+	return false;
+}
+
 /** Main kernel routine for bootstrap CPU.
  *
  * The code here still runs on the boot stack, which knows nothing about
@@ -217,6 +256,8 @@ void main_bsp_separated_stack(void)
 	/* Keep this the first thing. */
 	current_initialize(CURRENT);
 
+	bootmark("kernel: entry");
+
 	version_print();
 
 	LOG("\nconfig.base=%p config.kernel_size=%zu"
@@ -247,6 +288,7 @@ void main_bsp_separated_stack(void)
 	frame_init();
 	slab_cache_init();
 	malloc_init();
+	bdict_init();
 	ra_init();
 	sysinfo_init();
 	as_init();
@@ -255,6 +297,7 @@ void main_bsp_separated_stack(void)
 	km_non_identity_init();
 	ddi_init();
 	ARCH_OP(post_mm_init);
+	bootmark("kernel: mm initialized");
 	reserve_init();
 	ARCH_OP(pre_smp_init);
 	smp_init();
@@ -269,16 +312,20 @@ void main_bsp_separated_stack(void)
 	    config.cpu_count, size, size_suffix);
 
 	cpu_init();
+	frame_enable_cpucache();
 	calibrate_delay_loop();
 	ARCH_OP(post_cpu_init);
 
 	clock_counter_init();
+	bootmark("kernel: clock running");
 	timeout_init();
 	scheduler_init();
+	rcu_init();
 	caps_init();
 	task_init();
 	thread_init();
 	sys_waitq_init();
+	ipc_ring_init();
 
 	sysinfo_set_item_data("boot_args", NULL, bargs, str_size(bargs) + 1);
 
@@ -294,7 +341,11 @@ void main_bsp_separated_stack(void)
 	event_init();
 	kio_init();
 	log_init();
+	bootmark_init();
 	stats_init();
+	profile_init();
+	symtab_init();
+	ktrace_init();
 
 	/*
 	 * Create kernel task.
@@ -382,6 +433,7 @@ void main_ap_separated_stack(void)
 	 */
 	timeout_init();
 
+	bootmark("kernel: cpu%u up", CPU->id);
 	waitq_wakeup(&ap_completion_wq, WAKEUP_FIRST);
 	scheduler();
 	/* not reached */
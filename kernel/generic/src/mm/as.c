@@ -64,6 +64,7 @@
 #include <adt/list.h>
 #include <proc/task.h>
 #include <proc/thread.h>
+#include <cpu/cpu_mask.h>
 #include <arch/asm.h>
 #include <panic.h>
 #include <assert.h>
@@ -77,6 +78,8 @@
 #include <align.h>
 #include <typedefs.h>
 #include <syscall/copy.h>
+#include <ktrace.h>
+#include <sysinfo/stats.h>
 #include <arch/interrupt.h>
 #include <interrupt.h>
 #include <stdlib.h>
@@ -118,13 +121,12 @@ as_t *AS_KERNEL = NULL;
 static void *as_areas_getkey(odlink_t *);
 static int as_areas_cmp(void *, void *);
 
-static void used_space_initialize(used_space_t *);
+static void used_space_initialize(used_space_t *, as_t *);
 static void used_space_finalize(used_space_t *);
-static void *used_space_getkey(odlink_t *);
-static int used_space_cmp(void *, void *);
 static used_space_ival_t *used_space_last(used_space_t *);
 static void used_space_remove_ival(used_space_ival_t *);
 static void used_space_shorten_ival(used_space_ival_t *, size_t);
+static void used_space_tlb_batch(used_space_t *, tlb_batch_t *, as_t *);
 
 _NO_TRACE static errno_t as_constructor(void *obj, unsigned int flags)
 {
@@ -172,6 +174,18 @@ as_t *as_create(unsigned int flags)
 	if (!as)
 		return NULL;
 
+	if (flags & FLAG_AS_KERNEL) {
+		as->cpu_mask = NULL;
+	} else {
+		as->cpu_mask = malloc(cpu_mask_size());
+		if (!as->cpu_mask) {
+			slab_free(as_cache, as);
+			return NULL;
+		}
+
+		cpu_mask_none(as->cpu_mask);
+	}
+
 	(void) as_create_arch(as, 0);
 
 	odict_initialize(&as->as_areas, as_areas_getkey, as_areas_cmp);
@@ -183,6 +197,10 @@ as_t *as_create(unsigned int flags)
 
 	refcount_init(&as->refcount);
 	as->cpu_refcount = 0;
+	as->large_pages = 0;
+	atomic_store(&as->virt_pages, 0);
+	atomic_store(&as->resident_pages, 0);
+	stats_touch(&as->stats_gen);
 
 #ifdef AS_PAGE_TABLE
 	as->genarch.page_table = page_table_create(flags);
@@ -269,6 +287,10 @@ retry:
 	page_table_destroy(NULL);
 #endif
 
+	/* The kernel address space has no CPU mask. */
+	if (as->cpu_mask != NULL)
+		free(as->cpu_mask);
+
 	slab_free(as_cache, as);
 }
 
@@ -685,6 +707,30 @@ _NO_TRACE void as_pagemap_remove(as_page_mapping_t *mapping)
 	slab_free(as_page_mapping_cache, mapping);
 }
 
+/** Create address space area share info.
+ *
+ * @param backend Backend of the address space area.
+ *
+ * @return Share info with a single reference or NULL on failure.
+ *
+ */
+_NO_TRACE static share_info_t *sh_info_create(mem_backend_t *backend)
+{
+	share_info_t *sh_info = (share_info_t *) malloc(sizeof(share_info_t));
+	if (!sh_info)
+		return NULL;
+
+	mutex_initialize(&sh_info->lock, MUTEX_PASSIVE);
+	sh_info->refcount = 1;
+	sh_info->shared = false;
+	sh_info->pinned = 0;
+	sh_info->backend_shared_data = NULL;
+	sh_info->backend = backend;
+	as_pagemap_initialize(&sh_info->pagemap);
+
+	return sh_info;
+}
+
 /** Remove reference to address space area share info.
  *
  * If the reference count drops to 0, the sh_info is deallocated.
@@ -794,6 +840,8 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	area->base = *base;
 	area->backend = backend;
 	area->sh_info = NULL;
+	area->next_fault = 0;
+	area->prefault = 0;
 
 	if (backend_data)
 		area->backend_data = *backend_data;
@@ -808,18 +856,12 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 	 * to be shared.
 	 */
 	if (!(attrs & AS_AREA_ATTR_PARTIAL)) {
-		si = (share_info_t *) malloc(sizeof(share_info_t));
+		si = sh_info_create(backend);
 		if (!si) {
 			free(area);
 			mutex_unlock(&as->lock);
 			return NULL;
 		}
-		mutex_initialize(&si->lock, MUTEX_PASSIVE);
-		si->refcount = 1;
-		si->shared = false;
-		si->backend_shared_data = NULL;
-		si->backend = backend;
-		as_pagemap_initialize(&si->pagemap);
 
 		area->sh_info = si;
 
@@ -843,9 +885,12 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 		}
 	}
 
-	used_space_initialize(&area->used_space);
+	used_space_initialize(&area->used_space, as);
 	odict_insert(&area->las_areas, &as->as_areas, NULL);
 
+	atomic_fetch_add(&as->virt_pages, pages);
+	stats_touch(&as->stats_gen);
+
 	mutex_unlock(&as->lock);
 
 	return area;
@@ -950,13 +995,16 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 
 		page_table_lock(as, false);
 
+		page_mapping_split(as, start_free, area->pages - pages);
+
 		/*
 		 * Start TLB shootdown sequence.
 		 */
 
-		ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES,
-		    as->asid, area->base + P2SZ(pages),
-		    area->pages - pages);
+		tlb_batch_t batch;
+		tlb_batch_init(&batch, as);
+		tlb_batch_add(&batch, start_free, area->pages - pages);
+		ipl_t ipl = tlb_batch_shootdown_start(&batch);
 
 		/*
 		 * Remove frames belonging to used space starting from
@@ -1030,9 +1078,7 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		 * Finish TLB shootdown sequence.
 		 */
 
-		tlb_invalidate_pages(as->asid,
-		    area->base + P2SZ(pages),
-		    area->pages - pages);
+		tlb_batch_invalidate(&batch);
 
 		/*
 		 * Invalidate software translation caches
@@ -1071,6 +1117,10 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		}
 	}
 
+	atomic_fetch_add(&as->virt_pages, pages);
+	atomic_fetch_sub(&as->virt_pages, area->pages);
+	stats_touch(&as->stats_gen);
+
 	area->pages = pages;
 
 	mutex_unlock(&area->lock);
@@ -1101,11 +1151,13 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 		area->backend->destroy(area);
 
 	page_table_lock(as, false);
+	page_mapping_split(as, area->base, area->pages);
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
-	    area->pages);
+	tlb_batch_t batch;
+	used_space_tlb_batch(&area->used_space, &batch, as);
+	ipl_t ipl = tlb_batch_shootdown_start(&batch);
 
 	/*
 	 * Visit only the pages mapped by used_space.
@@ -1142,7 +1194,7 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	 * Finish TLB shootdown sequence.
 	 */
 
-	tlb_invalidate_pages(as->asid, area->base, area->pages);
+	tlb_batch_invalidate(&batch);
 
 	/*
 	 * Invalidate potential software translation caches
@@ -1164,12 +1216,216 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	 */
 	odict_remove(&area->las_areas);
 
+	atomic_fetch_sub(&as->virt_pages, area->pages);
+	stats_touch(&as->stats_gen);
+
 	free(area);
 
 	mutex_unlock(&as->lock);
 	return 0;
 }
 
+/** Share anonymous address space area as a copy-on-write snapshot.
+ *
+ * The destination is a new private anonymous area which maps the frames
+ * of the source area read-only. The present pages of the source area are
+ * remapped read-only, too. The first write to a page from either side
+ * copies the page unless the writer holds the only reference to the
+ * frame (see anon_page_fault()).
+ *
+ * @param src_as         Pointer to source address space.
+ * @param src_base       Base address of the source address space area.
+ * @param acc_size       Expected size of the source area.
+ * @param dst_as         Pointer to destination address space.
+ * @param dst_flags_mask Destination address space area flags mask.
+ * @param dst_base       Target base address. If set to -1,
+ *                       a suitable mappable area is found.
+ * @param bound          Lowest address bound if dst_base is set to -1.
+ *                       Otherwise ignored.
+ *
+ * @return Zero on success or an error code as as_area_share().
+ * @return EBUSY if frames of the source area are pinned.
+ *
+ */
+static errno_t as_area_share_cow(as_t *src_as, uintptr_t src_base,
+    size_t acc_size, as_t *dst_as, unsigned int dst_flags_mask,
+    uintptr_t *dst_base, uintptr_t bound)
+{
+	mutex_lock(&src_as->lock);
+	as_area_t *src_area = find_area_and_lock(src_as, src_base);
+	if (!src_area) {
+		mutex_unlock(&src_as->lock);
+		return ENOENT;
+	}
+
+	if ((src_area->backend != &anon_backend) ||
+	    (!src_area->backend->is_shareable(src_area))) {
+		mutex_unlock(&src_area->lock);
+		mutex_unlock(&src_as->lock);
+		return ENOTSUP;
+	}
+
+	size_t src_size = P2SZ(src_area->pages);
+	unsigned int src_flags = src_area->flags;
+
+	if (src_flags & AS_AREA_CACHEABLE)
+		dst_flags_mask |= AS_AREA_CACHEABLE;
+
+	if ((src_size != acc_size) ||
+	    ((src_flags & dst_flags_mask) != dst_flags_mask)) {
+		mutex_unlock(&src_area->lock);
+		mutex_unlock(&src_as->lock);
+		return EPERM;
+	}
+
+	mutex_unlock(&src_area->lock);
+	mutex_unlock(&src_as->lock);
+
+	/*
+	 * The destination area is created first as the source and the
+	 * destination address spaces may be the same. Being created partial,
+	 * it gets its own share info here.
+	 */
+	share_info_t *dst_sh_info = sh_info_create(&anon_backend);
+	if (!dst_sh_info)
+		return ENOMEM;
+
+	as_area_t *dst_area = as_area_create(dst_as, dst_flags_mask,
+	    src_size, AS_AREA_ATTR_PARTIAL, &anon_backend, NULL, dst_base,
+	    bound);
+	if (!dst_area) {
+		sh_info_remove_reference(dst_sh_info);
+		return ENOMEM;
+	}
+
+	mutex_lock(&dst_as->lock);
+	mutex_lock(&dst_area->lock);
+	dst_area->sh_info = dst_sh_info;
+	mutex_unlock(&dst_area->lock);
+	mutex_unlock(&dst_as->lock);
+
+	mutex_lock(&src_as->lock);
+	src_area = find_area_and_lock(src_as, src_base);
+	if ((!src_area) || (src_area->backend != &anon_backend) ||
+	    (P2SZ(src_area->pages) != src_size)) {
+		if (src_area)
+			mutex_unlock(&src_area->lock);
+		mutex_unlock(&src_as->lock);
+		as_area_destroy(dst_as, *dst_base);
+		return ENOENT;
+	}
+
+	/*
+	 * Pinned frames are still being written to or read from on behalf
+	 * of the source task (see as_frames_pin()). Remapping them read-only
+	 * would let the first write fault move the task to a private copy
+	 * while the pins keep referring to the now shared snapshot.
+	 */
+	mutex_lock(&src_area->sh_info->lock);
+	bool shared = src_area->sh_info->shared;
+	bool pinned = src_area->sh_info->pinned > 0;
+	mutex_unlock(&src_area->sh_info->lock);
+
+	if (pinned) {
+		mutex_unlock(&src_area->lock);
+		mutex_unlock(&src_as->lock);
+		as_area_destroy(dst_as, *dst_base);
+		return EBUSY;
+	}
+
+	/*
+	 * Offsets and frames of the present pages of the source area.
+	 */
+	size_t count = src_area->used_space.pages;
+	uintptr_t *snapshot = NULL;
+	if (count > 0)
+		snapshot = malloc(2 * count * sizeof(uintptr_t));
+
+	if ((shared) || ((count > 0) && (!snapshot))) {
+		mutex_unlock(&src_area->lock);
+		mutex_unlock(&src_as->lock);
+		as_area_destroy(dst_as, *dst_base);
+		return shared ? ENOTSUP : ENOMEM;
+	}
+
+	page_table_lock(src_as, false);
+	page_mapping_split(src_as, src_area->base, src_area->pages);
+
+	/*
+	 * Remove the present pages and map them back read-only only after
+	 * the TLB shootdown sequence, as in as_area_change_flags().
+	 */
+	tlb_batch_t batch;
+	used_space_tlb_batch(&src_area->used_space, &batch, src_as);
+	ipl_t ipl = tlb_batch_shootdown_start(&batch);
+
+	size_t idx = 0;
+	used_space_ival_t *ival = used_space_first(&src_area->used_space);
+	while (ival != NULL) {
+		for (size_t i = 0; i < ival->count; i++) {
+			uintptr_t page = ival->page + P2SZ(i);
+			pte_t pte;
+			bool found = page_mapping_find(src_as, page, false, &pte);
+
+			(void) found;
+			assert(found);
+			assert(PTE_VALID(&pte));
+			assert(PTE_PRESENT(&pte));
+
+			snapshot[idx++] = page - src_area->base;
+			snapshot[idx++] = PTE_GET_FRAME(&pte);
+
+			page_mapping_remove(src_as, page);
+		}
+
+		ival = used_space_next(ival);
+	}
+
+	tlb_batch_invalidate(&batch);
+	as_invalidate_translation_cache(src_as, src_area->base,
+	    src_area->pages);
+	tlb_shootdown_finalize(ipl);
+
+	unsigned int page_flags = as_area_get_flags(src_area) & ~PAGE_WRITE;
+	for (idx = 0; idx < 2 * count; idx += 2) {
+		frame_reference_add(ADDR2PFN(snapshot[idx + 1]));
+		page_mapping_insert(src_as, src_area->base + snapshot[idx],
+		    snapshot[idx + 1], page_flags);
+	}
+
+	src_area->attributes |= AS_AREA_ATTR_COW;
+
+	page_table_unlock(src_as, false);
+	mutex_unlock(&src_area->lock);
+	mutex_unlock(&src_as->lock);
+
+	/*
+	 * Map the snapshot into the destination area, which is not
+	 * accessible before AS_AREA_ATTR_PARTIAL is cleared.
+	 */
+	mutex_lock(&dst_as->lock);
+	mutex_lock(&dst_area->lock);
+	page_table_lock(dst_as, false);
+
+	page_flags = as_area_get_flags(dst_area) & ~PAGE_WRITE;
+	for (idx = 0; idx < 2 * count; idx += 2) {
+		page_mapping_insert(dst_as, dst_area->base + snapshot[idx],
+		    snapshot[idx + 1], page_flags);
+		if (!used_space_insert(&dst_area->used_space,
+		    dst_area->base + snapshot[idx], 1))
+			panic("Cannot insert used space.");
+	}
+
+	page_table_unlock(dst_as, false);
+	dst_area->attributes &= ~AS_AREA_ATTR_PARTIAL;
+	dst_area->attributes |= AS_AREA_ATTR_COW;
+	mutex_unlock(&dst_area->lock);
+	mutex_unlock(&dst_as->lock);
+
+	free(snapshot);
+	return EOK;
+}
+
 /** Share address space area with another or the same address space.
  *
  * Address space area mapping is shared with a new address space area.
@@ -1178,6 +1434,9 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
  * sh_info of the source area. The process of duplicating the
  * mapping is done through the backend share function.
  *
+ * If AS_AREA_COW is set in dst_flags_mask, a copy-on-write snapshot of
+ * an anonymous area is created instead (see as_area_share_cow()).
+ *
  * @param src_as         Pointer to source address space.
  * @param src_base       Base address of the source address space area.
  * @param acc_size       Expected size of the source area.
@@ -1201,6 +1460,11 @@ errno_t as_area_share(as_t *src_as, uintptr_t src_base, size_t acc_size,
     as_t *dst_as, unsigned int dst_flags_mask, uintptr_t *dst_base,
     uintptr_t bound)
 {
+	if (dst_flags_mask & AS_AREA_COW) {
+		return as_area_share_cow(src_as, src_base, acc_size, dst_as,
+		    dst_flags_mask & ~AS_AREA_COW, dst_base, bound);
+	}
+
 	mutex_lock(&src_as->lock);
 	as_area_t *src_area = find_area_and_lock(src_as, src_base);
 	if (!src_area) {
@@ -1211,9 +1475,11 @@ errno_t as_area_share(as_t *src_as, uintptr_t src_base, size_t acc_size,
 		return ENOENT;
 	}
 
-	if (!src_area->backend->is_shareable(src_area)) {
+	if ((!src_area->backend->is_shareable(src_area)) ||
+	    (src_area->attributes & AS_AREA_ATTR_COW)) {
 		/*
-		 * The backend does not permit sharing of this area.
+		 * The backend does not permit sharing of this area or the
+		 * area maps copy-on-write pages.
 		 */
 		mutex_unlock(&src_area->lock);
 		mutex_unlock(&src_as->lock);
@@ -1342,6 +1608,8 @@ _NO_TRACE static unsigned int area_flags_to_page_flags(unsigned int aflags)
 
 	if (aflags & AS_AREA_CACHEABLE)
 		flags |= PAGE_CACHEABLE;
+	else if (aflags & AS_AREA_WRITE_COMBINE)
+		flags |= PAGE_WRITE_COMBINE;
 
 	return flags;
 }
@@ -1381,8 +1649,9 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	}
 
 	mutex_lock(&area->sh_info->lock);
-	if (area->sh_info->shared) {
-		/* Copying shared areas not supported yet */
+	if ((area->sh_info->shared) ||
+	    (area->attributes & AS_AREA_ATTR_COW)) {
+		/* Copying shared and copy-on-write areas not supported yet */
 		mutex_unlock(&area->sh_info->lock);
 		mutex_unlock(&area->lock);
 		mutex_unlock(&as->lock);
@@ -1400,12 +1669,14 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	}
 
 	page_table_lock(as, false);
+	page_mapping_split(as, area->base, area->pages);
 
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
-	    area->pages);
+	tlb_batch_t batch;
+	used_space_tlb_batch(&area->used_space, &batch, as);
+	ipl_t ipl = tlb_batch_shootdown_start(&batch);
 
 	/*
 	 * Remove used pages from page tables and remember their frame
@@ -1441,7 +1712,7 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	 * Finish TLB shootdown sequence.
 	 */
 
-	tlb_invalidate_pages(as->asid, area->base, area->pages);
+	tlb_batch_invalidate(&batch);
 
 	/*
 	 * Invalidate potential software translation caches
@@ -1490,6 +1761,49 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	return 0;
 }
 
+/** Write back modified pages of an address space area.
+ *
+ * Only backends which keep their pages in sync with some backing object
+ * implement this. For the others this is a no-op.
+ *
+ * @param as      Address space.
+ * @param address Start of the range to write back.
+ * @param size    Size of the range to write back.
+ *
+ * @return Zero on success or a value from @ref errno.h on failure.
+ * @return ENOMEM if the range is not contained in one area.
+ *
+ */
+errno_t as_area_sync(as_t *as, uintptr_t address, size_t size)
+{
+	mutex_lock(&as->lock);
+
+	as_area_t *area = find_area_and_lock(as, address);
+	if (!area) {
+		mutex_unlock(&as->lock);
+		return ENOMEM;
+	}
+
+	uintptr_t end = area->base + P2SZ(area->pages);
+	if (size > end - address) {
+		mutex_unlock(&area->lock);
+		mutex_unlock(&as->lock);
+		return ENOMEM;
+	}
+
+	uintptr_t page = ALIGN_DOWN(address, PAGE_SIZE);
+	size_t pages = SIZE2FRAMES(address + size - page);
+
+	errno_t rc = EOK;
+	if ((pages > 0) && (area->backend) && (area->backend->sync))
+		rc = area->backend->sync(area, page, pages);
+
+	mutex_unlock(&area->lock);
+	mutex_unlock(&as->lock);
+
+	return rc;
+}
+
 /** Handle page fault within the current address space.
  *
  * This is the high-level page fault handler. It decides whether the page fault
@@ -1514,6 +1828,8 @@ int as_page_fault(uintptr_t address, pf_access_t access, istate_t *istate)
 	uintptr_t page = ALIGN_DOWN(address, PAGE_SIZE);
 	int rc = AS_PF_FAULT;
 
+	ktrace(KTRACE_PAGE_FAULT, address, access, istate_get_pc(istate));
+
 	if (!THREAD)
 		goto page_fault;
 
@@ -1675,8 +1991,18 @@ retry:
 			new_as->asid = asid_get();
 	}
 
+	/*
+	 * Make sure that TLB shootdowns of the new address space will
+	 * consider this processor before it starts using the page tables.
+	 */
+	if ((new_as->cpu_mask) &&
+	    (!cpu_mask_is_set(new_as->cpu_mask, CPU->id))) {
+		cpu_mask_set(new_as->cpu_mask, CPU->id);
+		tlb_shootdown_sync();
+	}
+
 #ifdef AS_PAGE_TABLE
-	SET_PTL0_ADDRESS(new_as->genarch.page_table);
+	SET_PTL0_ADDRESS_ASID(new_as->genarch.page_table, new_as->asid);
 #endif
 
 	/*
@@ -1843,14 +2169,167 @@ size_t as_area_get_size(uintptr_t base)
 	return size;
 }
 
+/** Pin frames backing a range of anonymous memory of the current task.
+ *
+ * Pages which are not present yet are faulted in first, for @a write with
+ * write access so that copy-on-write pages get a private frame. Each frame
+ * gets an extra reference, so that it stays allocated even if the area is
+ * destroyed in the meantime. While pinned, the area cannot be shared
+ * copy-on-write. Release the frames with as_frames_unpin().
+ *
+ * @param base    Page-aligned start of the range.
+ * @param pages   Number of pages in the range.
+ * @param write   True if the frames are going to be written to.
+ * @param frames  Array to store the physical addresses of the frames to.
+ * @param sh_info Place to store the share info of the area to.
+ *
+ * @return EOK on success.
+ * @return ENOENT if the range is not inside a single anonymous area or some
+ *         of its pages cannot be faulted in.
+ * @return EPERM if the area does not allow the requested access.
+ *
+ */
+errno_t as_frames_pin(uintptr_t base, size_t pages, bool write,
+    uintptr_t *frames, share_info_t **sh_info)
+{
+	assert(IS_ALIGNED(base, PAGE_SIZE));
+	assert(pages > 0);
+
+	pf_access_t access = write ? PF_ACCESS_WRITE : PF_ACCESS_READ;
+
+	mutex_lock(&AS->lock);
+	as_area_t *area = find_area_and_lock(AS, base);
+	if (!area) {
+		mutex_unlock(&AS->lock);
+		return ENOENT;
+	}
+
+	if ((area->backend != &anon_backend) ||
+	    (area->attributes & AS_AREA_ATTR_PARTIAL) ||
+	    (pages > area->pages - ((base - area->base) >> PAGE_WIDTH))) {
+		mutex_unlock(&area->lock);
+		mutex_unlock(&AS->lock);
+		return ENOENT;
+	}
+
+	if (!as_area_check_access(area, access)) {
+		mutex_unlock(&area->lock);
+		mutex_unlock(&AS->lock);
+		return EPERM;
+	}
+
+	page_table_lock(AS, false);
+
+	size_t i;
+	for (i = 0; i < pages; i++) {
+		uintptr_t page = base + P2SZ(i);
+		pte_t pte;
+
+		bool found = page_mapping_find(AS, page, false, &pte);
+		if ((!found) || (!PTE_PRESENT(&pte)) ||
+		    ((write) && (!PTE_WRITABLE(&pte)))) {
+			if (area->backend->page_fault(area, page, access) !=
+			    AS_PF_OK)
+				break;
+
+			found = page_mapping_find(AS, page, false, &pte);
+			if ((!found) || (!PTE_PRESENT(&pte)))
+				break;
+		}
+
+		frames[i] = PTE_GET_FRAME(&pte);
+		frame_reference_add(ADDR2PFN(frames[i]));
+	}
+
+	page_table_unlock(AS, false);
+
+	if (i == pages) {
+		*sh_info = area->sh_info;
+
+		mutex_lock(&area->sh_info->lock);
+		area->sh_info->refcount++;
+		area->sh_info->pinned++;
+		mutex_unlock(&area->sh_info->lock);
+	}
+
+	mutex_unlock(&area->lock);
+	mutex_unlock(&AS->lock);
+
+	if (i < pages) {
+		while (i-- > 0)
+			frame_free_noreserve(frames[i], 1);
+
+		return ENOENT;
+	}
+
+	return EOK;
+}
+
+/** Release frames pinned by as_frames_pin().
+ *
+ * @param sh_info Share info of the area returned by as_frames_pin().
+ * @param frames  Physical addresses of the pinned frames.
+ * @param pages   Number of the pinned frames.
+ *
+ */
+void as_frames_unpin(share_info_t *sh_info, uintptr_t *frames, size_t pages)
+{
+	for (size_t i = 0; i < pages; i++)
+		frame_free_noreserve(frames[i], 1);
+
+	mutex_lock(&sh_info->lock);
+	assert(sh_info->pinned > 0);
+	sh_info->pinned--;
+	mutex_unlock(&sh_info->lock);
+
+	sh_info_remove_reference(sh_info);
+}
+
 /** Initialize used space map.
  *
  * @param used_space Used space map
+ * @param as         Address space accounting the used pages
  */
-static void used_space_initialize(used_space_t *used_space)
+static void used_space_initialize(used_space_t *used_space, as_t *as)
 {
-	odict_initialize(&used_space->ivals, used_space_getkey, used_space_cmp);
+	bdict_initialize(&used_space->ivals);
 	used_space->pages = 0;
+	used_space->as = as;
+}
+
+/** Account used pages to the address space.
+ *
+ * @param used_space Used space map
+ * @param added      Number of pages added
+ * @param removed    Number of pages removed
+ */
+static void used_space_account(used_space_t *used_space, size_t added,
+    size_t removed)
+{
+	used_space->pages += added;
+	used_space->pages -= removed;
+
+	atomic_fetch_add(&used_space->as->resident_pages, added);
+	atomic_fetch_sub(&used_space->as->resident_pages, removed);
+	stats_touch(&used_space->as->stats_gen);
+}
+
+/** Queue all used space intervals for TLB invalidation.
+ *
+ * @param used_space Used space map
+ * @param batch      TLB shootdown batch to initialize
+ * @param as         Address space of the used space map
+ */
+static void used_space_tlb_batch(used_space_t *used_space, tlb_batch_t *batch,
+    as_t *as)
+{
+	tlb_batch_init(batch, as);
+
+	used_space_ival_t *ival = used_space_first(used_space);
+	while (ival != NULL) {
+		tlb_batch_add(batch, ival->page, ival->count);
+		ival = used_space_next(ival);
+	}
 }
 
 /** Finalize used space map.
@@ -1859,8 +2338,8 @@ static void used_space_initialize(used_space_t *used_space)
  */
 static void used_space_finalize(used_space_t *used_space)
 {
-	assert(odict_empty(&used_space->ivals));
-	odict_finalize(&used_space->ivals);
+	assert(bdict_empty(&used_space->ivals));
+	bdict_finalize(&used_space->ivals);
 }
 
 /** Get first interval of used space.
@@ -1870,12 +2349,7 @@ static void used_space_finalize(used_space_t *used_space)
  */
 used_space_ival_t *used_space_first(used_space_t *used_space)
 {
-	odlink_t *odlink = odict_first(&used_space->ivals);
-
-	if (odlink == NULL)
-		return NULL;
-
-	return odict_get_instance(odlink, used_space_ival_t, lused_space);
+	return bdict_first(&used_space->ivals, NULL);
 }
 
 /** Get next interval of used space.
@@ -1885,13 +2359,7 @@ used_space_ival_t *used_space_first(used_space_t *used_space)
  */
 used_space_ival_t *used_space_next(used_space_ival_t *cur)
 {
-	odlink_t *odlink = odict_next(&cur->lused_space,
-	    &cur->used_space->ivals);
-
-	if (odlink == NULL)
-		return NULL;
-
-	return odict_get_instance(odlink, used_space_ival_t, lused_space);
+	return bdict_find_gt(&cur->used_space->ivals, cur->page, NULL);
 }
 
 /** Get last interval of used space.
@@ -1901,12 +2369,7 @@ used_space_ival_t *used_space_next(used_space_ival_t *cur)
  */
 static used_space_ival_t *used_space_last(used_space_t *used_space)
 {
-	odlink_t *odlink = odict_last(&used_space->ivals);
-
-	if (odlink == NULL)
-		return NULL;
-
-	return odict_get_instance(odlink, used_space_ival_t, lused_space);
+	return bdict_last(&used_space->ivals, NULL);
 }
 
 /** Find the first interval that contains addresses greater than or equal to
@@ -1919,15 +2382,12 @@ static used_space_ival_t *used_space_last(used_space_t *used_space)
  */
 used_space_ival_t *used_space_find_gteq(used_space_t *used_space, uintptr_t ptr)
 {
-	odlink_t *odlink;
+	bdict_cursor_t cursor;
 	used_space_ival_t *ival;
 
 	/* Find last interval to start at address less than @a ptr */
-	odlink = odict_find_lt(&used_space->ivals, &ptr, NULL);
-	if (odlink != NULL) {
-		ival = odict_get_instance(odlink, used_space_ival_t,
-		    lused_space);
-
+	ival = bdict_find_lt(&used_space->ivals, ptr, &cursor);
+	if (ival != NULL) {
 		/* If the interval extends above @a ptr, return it */
 		if (ival->page + P2SZ(ival->count) > ptr)
 			return ival;
@@ -1936,56 +2396,14 @@ used_space_ival_t *used_space_find_gteq(used_space_t *used_space, uintptr_t ptr)
 		 * Otherwise, if a next interval exists, it must match
 		 * the criteria.
 		 */
-		odlink = odict_next(&ival->lused_space, &used_space->ivals);
-	} else {
-		/*
-		 * No interval with lower base address, so if there is any
-		 * interval at all, it must match the criteria
-		 */
-		odlink = odict_first(&used_space->ivals);
-	}
-
-	if (odlink != NULL) {
-		ival = odict_get_instance(odlink, used_space_ival_t,
-		    lused_space);
-		return ival;
+		return bdict_next(&cursor);
 	}
 
-	return NULL;
-}
-
-/** Get key function for used space ordered dictionary.
- *
- * The key is the virtual address of the first page
- *
- * @param odlink Ordered dictionary link (used_space_ival_t.lused_space)
- * @return Pointer to virtual address of first page cast as @c void *.
- */
-static void *used_space_getkey(odlink_t *odlink)
-{
-	used_space_ival_t *ival = odict_get_instance(odlink, used_space_ival_t,
-	    lused_space);
-	return (void *) &ival->page;
-}
-
-/** Compare function for used space ordered dictionary.
- *
- * @param a Pointer to virtual address of first page cast as @c void *
- * @param b Pointer to virtual address of first page cast as @c void *
- * @return Less than zero, zero, greater than zero if virtual address @a a
- *         is less than, equal to, greater than virtual address b, respectively.
- */
-static int used_space_cmp(void *a, void *b)
-{
-	uintptr_t va = *(uintptr_t *) a;
-	uintptr_t vb = *(uintptr_t *) b;
-
-	if (va < vb)
-		return -1;
-	else if (va == vb)
-		return 0;
-	else
-		return +1;
+	/*
+	 * No interval with lower base address, so if there is any
+	 * interval at all, it must match the criteria
+	 */
+	return bdict_first(&used_space->ivals, NULL);
 }
 
 /** Remove used space interval.
@@ -1994,8 +2412,8 @@ static int used_space_cmp(void *a, void *b)
  */
 static void used_space_remove_ival(used_space_ival_t *ival)
 {
-	ival->used_space->pages -= ival->count;
-	odict_remove(&ival->lused_space);
+	used_space_account(ival->used_space, 0, ival->count);
+	(void) bdict_remove(&ival->used_space->ivals, ival->page);
 	slab_free(used_space_ival_cache, ival);
 }
 
@@ -2009,7 +2427,7 @@ static void used_space_shorten_ival(used_space_ival_t *ival, size_t count)
 	assert(count > 0);
 	assert(count < ival->count);
 
-	ival->used_space->pages -= ival->count - count;
+	used_space_account(ival->used_space, 0, ival->count - count);
 	ival->count = count;
 }
 
@@ -2030,20 +2448,17 @@ bool used_space_insert(used_space_t *used_space, uintptr_t page, size_t count)
 	used_space_ival_t *b;
 	bool adj_a;
 	bool adj_b;
-	odlink_t *odlink;
+	bdict_cursor_t cursor;
 	used_space_ival_t *ival;
 
 	assert(IS_ALIGNED(page, PAGE_SIZE));
 	assert(count);
 
 	/* Interval to the left */
-	odlink = odict_find_lt(&used_space->ivals, &page, NULL);
-	a = (odlink != NULL) ?
-	    odict_get_instance(odlink, used_space_ival_t, lused_space) :
-	    NULL;
+	a = bdict_find_lt(&used_space->ivals, page, &cursor);
 
 	/* Interval to the right */
-	b = (a != NULL) ? used_space_next(a) :
+	b = (a != NULL) ? bdict_next(&cursor) :
 	    used_space_first(used_space);
 
 	/* Check for conflict with left interval */
@@ -2062,27 +2477,34 @@ bool used_space_insert(used_space_t *used_space, uintptr_t page, size_t count)
 	if (adj_a && adj_b) {
 		/* Fuse into a single interval */
 		a->count += count + b->count;
+		/* The pages of B stay used as a part of A */
+		used_space_account(used_space, b->count, 0);
 		used_space_remove_ival(b);
 	} else if (adj_a) {
 		/* Append to A */
 		a->count += count;
 	} else if (adj_b) {
-		/* Prepend to B */
+		/* Prepend to B, which changes its key */
+		(void) bdict_remove(&used_space->ivals, b->page);
 		b->page = page;
 		b->count += count;
+
+		if (bdict_insert(&used_space->ivals, b->page, b) != EOK)
+			panic("Cannot reinsert used space interval.");
 	} else {
 		/* Create new interval */
 		ival = slab_alloc(used_space_ival_cache, 0);
 		ival->used_space = used_space;
-		odlink_initialize(&ival->lused_space);
 		ival->page = page;
 		ival->count = count;
 
-		odict_insert(&ival->lused_space, &used_space->ivals,
-		    NULL);
+		if (bdict_insert(&used_space->ivals, ival->page, ival) != EOK) {
+			slab_free(used_space_ival_cache, ival);
+			return false;
+		}
 	}
 
-	used_space->pages += count;
+	used_space_account(used_space, count, 0);
 	return true;
 }
 
@@ -2155,6 +2577,11 @@ sys_errno_t sys_as_area_destroy(uintptr_t address)
 	return (sys_errno_t) as_area_destroy(AS, address);
 }
 
+sys_errno_t sys_as_area_sync(uintptr_t address, size_t size)
+{
+	return (sys_errno_t) as_area_sync(AS, address, size);
+}
+
 /** Get list of address space areas.
  *
  * @param as    Address space.
@@ -45,13 +45,16 @@
 #include <mm/frame.h>
 #include <mm/slab.h>
 #include <mm/km.h>
+#include <mm/tlb.h>
 #include <synch/mutex.h>
 #include <adt/list.h>
 #include <errno.h>
 #include <typedefs.h>
 #include <align.h>
+#include <macros.h>
 #include <mem.h>
 #include <arch.h>
+#include <config.h>
 
 static bool anon_create(as_area_t *);
 static bool anon_resize(as_area_t *, size_t);
@@ -75,6 +78,7 @@ mem_backend_t anon_backend = {
 
 	.page_fault = anon_page_fault,
 	.frame_free = anon_frame_free,
+	.sync = NULL,
 
 	.create_shared_data = NULL,
 	.destroy_shared_data = NULL
@@ -170,6 +174,183 @@ bool anon_is_shareable(as_area_t *area)
 	return !(area->flags & AS_AREA_LATE_RESERVE);
 }
 
+#if defined(CONFIG_THP) && defined(LARGE_PAGE_WIDTH)
+
+/** Try to service a page fault by mapping a whole large page.
+ *
+ * The large page is used only if the naturally aligned large page
+ * containing the faulting page lies entirely within the area and none of
+ * its pages are mapped yet. Any failure is silent and the caller falls
+ * back to mapping a single page.
+ *
+ * The address space area, its share info and page tables must be already
+ * locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Faulting virtual page.
+ *
+ * @return True if the large page has been mapped.
+ */
+static bool anon_large_page_fault(as_area_t *area, uintptr_t upage)
+{
+	uintptr_t lpage = ALIGN_DOWN(upage, LARGE_PAGE_SIZE);
+
+	if (lpage < area->base ||
+	    lpage + LARGE_PAGE_SIZE > area->base + P2SZ(area->pages))
+		return false;
+
+	used_space_ival_t *ival = used_space_find_gteq(&area->used_space,
+	    lpage);
+	if (ival != NULL && ival->page < lpage + LARGE_PAGE_SIZE)
+		return false;
+
+	if ((area->flags & AS_AREA_LATE_RESERVE) &&
+	    !reserve_try_alloc(LARGE_PAGE_FRAMES))
+		return false;
+
+	uintptr_t frame = frame_alloc(LARGE_PAGE_FRAMES, FRAME_HIGHMEM |
+	    FRAME_ATOMIC | FRAME_NO_RECLAIM | FRAME_NO_RESERVE | FRAME_POLICY,
+	    LARGE_PAGE_SIZE - 1);
+	if (frame == 0)
+		goto error;
+
+	uintptr_t kpage = km_map(frame, LARGE_PAGE_SIZE, PAGE_SIZE,
+	    PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE);
+	memsetb((void *) kpage, LARGE_PAGE_SIZE, 0);
+	km_unmap(kpage, LARGE_PAGE_SIZE);
+
+	if (!page_mapping_insert_large(AS, lpage, frame,
+	    as_area_get_flags(area))) {
+		frame_free_noreserve(frame, LARGE_PAGE_FRAMES);
+		goto error;
+	}
+
+	if (!used_space_insert(&area->used_space, lpage, LARGE_PAGE_FRAMES))
+		panic("Cannot insert used space.");
+
+	return true;
+
+error:
+	if (area->flags & AS_AREA_LATE_RESERVE)
+		reserve_free(LARGE_PAGE_FRAMES);
+
+	return false;
+}
+
+#endif /* CONFIG_THP && LARGE_PAGE_WIDTH */
+
+/** Map zeroed pages ahead of a sequential page fault.
+ *
+ * Faults on consecutive pages double the number of pages mapped ahead,
+ * up to AS_PREFAULT_PAGES_MAX. Prefaulting stops at the first page
+ * that is already mapped or cannot be allocated without blocking.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to a private address space area.
+ * @param upage Virtual page which has just been mapped.
+ */
+static void anon_prefault(as_area_t *area, uintptr_t upage)
+{
+	uintptr_t page = upage + PAGE_SIZE;
+
+	if (upage != area->next_fault) {
+		area->prefault = 0;
+		area->next_fault = page;
+		return;
+	}
+
+	area->prefault = min(max(area->prefault * 2, 2), AS_PREFAULT_PAGES_MAX);
+
+	uintptr_t end = min(page + P2SZ(area->prefault),
+	    area->base + P2SZ(area->pages));
+
+	for (; page < end; page += PAGE_SIZE) {
+		pte_t pte;
+		if (page_mapping_find(AS, page, false, &pte) && PTE_VALID(&pte))
+			break;
+
+		if ((area->flags & AS_AREA_LATE_RESERVE) &&
+		    (!reserve_try_alloc(1)))
+			break;
+
+		uintptr_t frame = frame_alloc(1, FRAME_HIGHMEM | FRAME_ZERO |
+		    FRAME_NO_RESERVE | FRAME_ATOMIC | FRAME_POLICY, 0);
+		if (frame == 0) {
+			if (area->flags & AS_AREA_LATE_RESERVE)
+				reserve_free(1);
+			break;
+		}
+
+		page_mapping_insert(AS, page, frame, as_area_get_flags(area));
+		if (!used_space_insert(&area->used_space, page, 1))
+			panic("Cannot insert used space.");
+	}
+
+	area->next_fault = page;
+}
+
+/** Resolve a write fault on a copy-on-write page.
+ *
+ * If the faulting address space holds the only reference to the frame,
+ * the page is simply remapped writable. Otherwise the page is copied to
+ * a new frame and the reference to the original frame is dropped.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Faulting virtual page.
+ * @param pte   Present read-only PTE of the page.
+ *
+ * @return AS_PF_OK.
+ */
+static int anon_cow_fault(as_area_t *area, uintptr_t upage, pte_t *pte)
+{
+	uintptr_t old_frame = PTE_GET_FRAME(pte);
+	uintptr_t frame = old_frame;
+
+	if (frame_reference_count(ADDR2PFN(old_frame)) > 1) {
+		uintptr_t kpage = km_temporary_page_get(&frame,
+		    FRAME_NO_RESERVE | FRAME_POLICY);
+
+		if (old_frame < config.identity_size) {
+			memcpy((void *) kpage, (void *) PA2KA(old_frame),
+			    PAGE_SIZE);
+		} else {
+			uintptr_t src = km_map(old_frame, PAGE_SIZE, PAGE_SIZE,
+			    PAGE_READ | PAGE_CACHEABLE);
+			memcpy((void *) kpage, (void *) src, PAGE_SIZE);
+			km_unmap(src, PAGE_SIZE);
+		}
+
+		km_temporary_page_put(kpage);
+	}
+
+	/*
+	 * Other threads of the address space must not keep reading the
+	 * original frame. The new mapping is inserted only after the TLB
+	 * shootdown sequence, other threads faulting on the page meanwhile
+	 * wait for the area lock.
+	 */
+	tlb_batch_t batch;
+	tlb_batch_init(&batch, AS);
+	tlb_batch_add(&batch, upage, 1);
+	ipl_t ipl = tlb_batch_shootdown_start(&batch);
+
+	page_mapping_remove(AS, upage);
+
+	tlb_batch_invalidate(&batch);
+	as_invalidate_translation_cache(AS, upage, 1);
+	tlb_shootdown_finalize(ipl);
+
+	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+
+	if (frame != old_frame)
+		frame_free_noreserve(old_frame, 1);
+
+	return AS_PF_OK;
+}
+
 /** Service a page fault in the anonymous memory address space area.
  *
  * The address space area and page tables must be already locked.
@@ -183,7 +364,6 @@ bool anon_is_shareable(as_area_t *area)
  */
 int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 {
-	uintptr_t kpage;
 	uintptr_t frame;
 
 	assert(page_table_locked(AS));
@@ -193,6 +373,15 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!as_area_check_access(area, access))
 		return AS_PF_FAULT;
 
+	if ((access == PF_ACCESS_WRITE) &&
+	    (area->attributes & AS_AREA_ATTR_COW)) {
+		pte_t pte;
+
+		if ((page_mapping_find(AS, upage, false, &pte)) &&
+		    (PTE_PRESENT(&pte)))
+			return anon_cow_fault(area, upage, &pte);
+	}
+
 	mutex_lock(&area->sh_info->lock);
 	if (area->sh_info->shared) {
 		/*
@@ -206,10 +395,8 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		    upage - area->base, &frame);
 		if (rc != EOK) {
 			/* Need to allocate the frame */
-			kpage = km_temporary_page_get(&frame,
-			    FRAME_NO_RESERVE);
-			memsetb((void *) kpage, PAGE_SIZE, 0);
-			km_temporary_page_put(kpage);
+			frame = frame_alloc(1, FRAME_HIGHMEM | FRAME_ZERO |
+			    FRAME_NO_RESERVE | FRAME_POLICY, 0);
 
 			/*
 			 * Insert the address of the newly allocated
@@ -236,6 +423,13 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		 *   the different causes
 		 */
 
+#if defined(CONFIG_THP) && defined(LARGE_PAGE_WIDTH)
+		if (anon_large_page_fault(area, upage)) {
+			mutex_unlock(&area->sh_info->lock);
+			return AS_PF_OK;
+		}
+#endif
+
 		if (area->flags & AS_AREA_LATE_RESERVE) {
 			/*
 			 * Reserve the memory for this page now.
@@ -246,9 +440,8 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 			}
 		}
 
-		kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
-		memsetb((void *) kpage, PAGE_SIZE, 0);
-		km_temporary_page_put(kpage);
+		frame = frame_alloc(1, FRAME_HIGHMEM | FRAME_ZERO |
+		    FRAME_NO_RESERVE | FRAME_POLICY, 0);
 	}
 	mutex_unlock(&area->sh_info->lock);
 
@@ -261,6 +454,9 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
+	if ((area->flags & AS_AREA_PREFAULT) && (!area->sh_info->shared))
+		anon_prefault(area, upage);
+
 	return AS_PF_OK;
 }
 
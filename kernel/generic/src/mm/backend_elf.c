@@ -74,6 +74,7 @@ mem_backend_t elf_backend = {
 
 	.page_fault = elf_page_fault,
 	.frame_free = elf_frame_free,
+	.sync = NULL,
 
 	.create_shared_data = NULL,
 	.destroy_shared_data = NULL
@@ -243,6 +244,72 @@ bool elf_is_shareable(as_area_t *area)
 	return true;
 }
 
+/** Map cheap neighbouring pages around a page fault.
+ *
+ * Pages in the naturally aligned window of AS_FAULT_AROUND_PAGES pages
+ * around the faulting page are mapped if their frames already exist,
+ * i.e. if they are found in the pagemap of a shared area or if they
+ * are read-only pages backed directly by the ELF image.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Virtual page which has just been mapped.
+ */
+static void elf_fault_around(as_area_t *area, uintptr_t upage)
+{
+	elf_segment_header_t *entry = area->backend_data.segment;
+	uintptr_t start_anon = entry->p_vaddr + entry->p_filesz;
+	uintptr_t base = (uintptr_t) (((void *) area->backend_data.elf) +
+	    ALIGN_DOWN(entry->p_offset, PAGE_SIZE));
+
+	uintptr_t window = ALIGN_DOWN(upage, P2SZ(AS_FAULT_AROUND_PAGES));
+	uintptr_t first = max(window, area->base);
+	uintptr_t last = min(window + P2SZ(AS_FAULT_AROUND_PAGES),
+	    area->base + P2SZ(area->pages));
+
+	mutex_lock(&area->sh_info->lock);
+
+	for (uintptr_t page = first; page < last; page += PAGE_SIZE) {
+		if (page == upage)
+			continue;
+
+		pte_t pte;
+		if (page_mapping_find(AS, page, false, &pte) && PTE_VALID(&pte))
+			continue;
+
+		uintptr_t elfpage = elf_orig_page(area, page);
+		uintptr_t frame;
+
+		if ((area->sh_info->shared) &&
+		    (as_pagemap_find(&area->sh_info->pagemap,
+		    page - area->base, &frame) == EOK)) {
+			frame_reference_add(ADDR2PFN(frame));
+		} else if ((!(entry->p_flags & PF_W)) &&
+		    (elfpage >= entry->p_vaddr) &&
+		    (elfpage + PAGE_SIZE <= start_anon)) {
+			size_t i = (elfpage - ALIGN_DOWN(entry->p_vaddr,
+			    PAGE_SIZE)) >> PAGE_WIDTH;
+			bool found = page_mapping_find(AS_KERNEL,
+			    base + i * FRAME_SIZE, true, &pte);
+
+			(void) found;
+			assert(found);
+			assert(PTE_PRESENT(&pte));
+
+			frame = PTE_GET_FRAME(&pte);
+		} else {
+			continue;
+		}
+
+		page_mapping_insert(AS, page, frame, as_area_get_flags(area));
+		if (!used_space_insert(&area->used_space, page, 1))
+			panic("Cannot insert used space.");
+	}
+
+	mutex_unlock(&area->sh_info->lock);
+}
+
 /** Service a page fault in the ELF backend address space area.
  *
  * The address space area and page tables must be already locked.
@@ -305,6 +372,10 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 			if (!used_space_insert(&area->used_space, upage, 1))
 				panic("Cannot insert used space.");
 			mutex_unlock(&area->sh_info->lock);
+
+			if (area->flags & AS_AREA_FAULT_AROUND)
+				elf_fault_around(area, upage);
+
 			return AS_PF_OK;
 		}
 	}
@@ -323,7 +394,8 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		 * as COW.
 		 */
 		if (entry->p_flags & PF_W) {
-			kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
+			kpage = km_temporary_page_get(&frame,
+			    FRAME_NO_RESERVE | FRAME_POLICY);
 			memcpy((void *) kpage, (void *) (base + i * PAGE_SIZE),
 			    PAGE_SIZE);
 			if (entry->p_flags & PF_X) {
@@ -351,7 +423,8 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		 * To resolve the situation, a frame must be allocated
 		 * and cleared.
 		 */
-		kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
+		kpage = km_temporary_page_get(&frame,
+		    FRAME_NO_RESERVE | FRAME_POLICY);
 		memsetb((void *) kpage, PAGE_SIZE, 0);
 		km_temporary_page_put(kpage);
 		dirty = true;
@@ -374,7 +447,8 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		else
 			pad_hi = 0;
 
-		kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
+		kpage = km_temporary_page_get(&frame,
+		    FRAME_NO_RESERVE | FRAME_POLICY);
 		memcpy((void *) (kpage + pad_lo),
 		    (void *) (base + i * PAGE_SIZE + pad_lo),
 		    PAGE_SIZE - pad_lo - pad_hi);
@@ -400,6 +474,9 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
+	if (area->flags & AS_AREA_FAULT_AROUND)
+		elf_fault_around(area, upage);
+
 	return AS_PF_OK;
 }
 
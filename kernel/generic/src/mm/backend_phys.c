@@ -75,6 +75,7 @@ mem_backend_t phys_backend = {
 
 	.page_fault = phys_page_fault,
 	.frame_free = NULL,
+	.sync = NULL,
 
 	.create_shared_data = phys_create_shared_data,
 	.destroy_shared_data = phys_destroy_shared_data
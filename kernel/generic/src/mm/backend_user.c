@@ -38,9 +38,13 @@
 
 #include <mm/as.h>
 #include <mm/page.h>
+#include <genarch/mm/page_pt.h>
+#include <genarch/mm/page_ht.h>
 #include <mm/frame.h>
+#include <mm/tlb.h>
 #include <abi/mm/as.h>
 #include <abi/ipc/methods.h>
+#include <adt/bitmap.h>
 #include <ipc/sysipc.h>
 #include <synch/mutex.h>
 #include <typedefs.h>
@@ -48,6 +52,8 @@
 #include <assert.h>
 #include <errno.h>
 #include <log.h>
+#include <mem.h>
+#include <stdlib.h>
 #include <str.h>
 
 static bool user_create(as_area_t *);
@@ -58,6 +64,7 @@ static bool user_is_shareable(as_area_t *);
 
 static int user_page_fault(as_area_t *, uintptr_t, pf_access_t);
 static void user_frame_free(as_area_t *, uintptr_t, uintptr_t);
+static errno_t user_sync(as_area_t *, uintptr_t, size_t);
 
 mem_backend_t user_backend = {
 	.create = user_create,
@@ -70,19 +77,105 @@ mem_backend_t user_backend = {
 
 	.page_fault = user_page_fault,
 	.frame_free = user_frame_free,
+	.sync = user_sync,
 
 	.create_shared_data = NULL,
 	.destroy_shared_data = NULL
 };
 
+/** Create a user-paged address space area.
+ *
+ * Writable areas get a map of modified pages, which is used for pages the
+ * pager supplies with AS_PAGER_WRITEBACK.
+ *
+ * @param area Pointer to the address space area.
+ *
+ * @return True on success, false if out of memory.
+ */
 bool user_create(as_area_t *area)
 {
+	bitmap_t *dirty = &area->backend_data.dirty;
+
+	area->backend_data.writeback = false;
+	bitmap_initialize(dirty, 0, NULL);
+
+	if (!(area->flags & AS_AREA_WRITE))
+		return true;
+
+	void *bits = malloc(bitmap_size(area->pages));
+	if (!bits)
+		return false;
+
+	memset(bits, 0, bitmap_size(area->pages));
+	bitmap_initialize(dirty, area->pages, bits);
 	return true;
 }
 
+/** Send a request about a range of the area to its pager.
+ *
+ * @param area   Pointer to the address space area.
+ * @param method IPC_M_PAGE_OUT or IPC_M_PAGE_RELEASE.
+ * @param page   First page of the range.
+ * @param count  Number of pages in the range.
+ *
+ * @return EOK on success or an error code.
+ */
+static errno_t user_pager_notify(as_area_t *area, sysarg_t method,
+    uintptr_t page, size_t count)
+{
+	as_area_pager_info_t *pager_info = &area->backend_data.pager_info;
+
+	ipc_data_t data = { };
+	ipc_set_imethod(&data, method);
+	ipc_set_arg1(&data, page - area->base);
+	ipc_set_arg2(&data, P2SZ(count));
+	ipc_set_arg3(&data, pager_info->id1);
+	ipc_set_arg4(&data, pager_info->id2);
+	ipc_set_arg5(&data, pager_info->id3);
+
+	errno_t rc = ipc_req_internal(pager_info->pager, &data, (sysarg_t) true);
+	if (rc != EOK)
+		return rc;
+
+	return ipc_get_retval(&data);
+}
+
+/** Destroy a user-paged address space area.
+ *
+ * Modified pages are written back and the pager is told which of the pages
+ * it supplied with AS_PAGER_WRITEBACK are no longer mapped. Nothing is sent
+ * if the area never held such pages.
+ *
+ * @param area Pointer to the address space area.
+ */
 void user_destroy(as_area_t *area)
 {
-	return;
+	assert(mutex_locked(&area->lock));
+
+	if (area->backend_data.writeback) {
+		/*
+		 * This fails when the task is exiting and its phones are
+		 * already gone. The pager writes back the pages of clients
+		 * which disconnect.
+		 */
+		errno_t rc = user_sync(area, area->base, area->pages);
+		if (rc != EOK) {
+			log(LF_USPACE, LVL_WARN,
+			    "Writing back area %p at pager %p failed with "
+			    "error %s.", (void *) area->base,
+			    area->backend_data.pager_info.pager,
+			    str_error_name(rc));
+		}
+
+		used_space_ival_t *ival = used_space_first(&area->used_space);
+		while (ival != NULL) {
+			(void) user_pager_notify(area, IPC_M_PAGE_RELEASE,
+			    ival->page, ival->count);
+			ival = used_space_next(ival);
+		}
+	}
+
+	free(area->backend_data.dirty.bits);
 }
 
 bool user_is_resizable(as_area_t *area)
@@ -95,6 +188,39 @@ bool user_is_shareable(as_area_t *area)
 	return false;
 }
 
+/** Remap a page for writing and note it as modified.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param upage Faulting virtual page.
+ * @param pte   Present read-only mapping of @a upage.
+ *
+ * @return AS_PF_OK.
+ */
+static int user_dirty_fault(as_area_t *area, uintptr_t upage, pte_t *pte)
+{
+	uintptr_t frame = PTE_GET_FRAME(pte);
+
+	bitmap_set(&area->backend_data.dirty, (upage - area->base) / PAGE_SIZE,
+	    1);
+
+	/* The same sequence as for a copy-on-write fault. */
+	tlb_batch_t batch;
+	tlb_batch_init(&batch, AS);
+	tlb_batch_add(&batch, upage, 1);
+	ipl_t ipl = tlb_batch_shootdown_start(&batch);
+
+	page_mapping_remove(AS, upage);
+
+	tlb_batch_invalidate(&batch);
+	as_invalidate_translation_cache(AS, upage, 1);
+	tlb_shootdown_finalize(ipl);
+
+	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	return AS_PF_OK;
+}
+
 /** Service a page fault in the user-paged address space area.
  *
  * The address space area and page tables must be already locked.
@@ -115,6 +241,16 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!as_area_check_access(area, access))
 		return AS_PF_FAULT;
 
+	/*
+	 * A write to a present page of a writable area means the page was
+	 * supplied with AS_PAGER_WRITEBACK and mapped read-only.
+	 */
+	pte_t pte;
+	if ((access == PF_ACCESS_WRITE) &&
+	    (page_mapping_find(AS, upage, false, &pte)) &&
+	    (PTE_PRESENT(&pte)))
+		return user_dirty_fault(area, upage, &pte);
+
 	as_area_pager_info_t *pager_info = &area->backend_data.pager_info;
 
 	ipc_data_t data = { };
@@ -145,7 +281,24 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	 */
 
 	uintptr_t frame = ipc_get_arg1(&data);
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	unsigned int flags = as_area_get_flags(area);
+
+	/*
+	 * Pages the pager wants to hear about are mapped read-only until they
+	 * are first written to.
+	 */
+	if ((ipc_get_arg2(&data) & AS_PAGER_WRITEBACK) &&
+	    (area->backend_data.dirty.bits)) {
+		area->backend_data.writeback = true;
+		if (access == PF_ACCESS_WRITE) {
+			bitmap_set(&area->backend_data.dirty,
+			    (upage - area->base) / PAGE_SIZE, 1);
+		} else {
+			flags &= ~PAGE_WRITE;
+		}
+	}
+
+	page_mapping_insert(AS, upage, frame, flags);
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
@@ -174,5 +327,94 @@ void user_frame_free(as_area_t *area, uintptr_t page, uintptr_t frame)
 
 }
 
+/** Write back modified pages of a user-paged address space area.
+ *
+ * Each run of modified pages is mapped read-only again before the pager is
+ * asked to write it back, so that writes done meanwhile are not lost.
+ *
+ * The address space area must be already locked.
+ *
+ * @param area  Pointer to the address space area.
+ * @param page  First page of the range to write back.
+ * @param count Number of pages in the range.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t user_sync(as_area_t *area, uintptr_t page, size_t count)
+{
+	assert(mutex_locked(&area->lock));
+
+	bitmap_t *dirty = &area->backend_data.dirty;
+	if (!dirty->bits)
+		return EOK;
+
+	as_t *as = area->as;
+	unsigned int flags = as_area_get_flags(area) & ~PAGE_WRITE;
+	size_t idx = (page - area->base) / PAGE_SIZE;
+	size_t end = idx + count;
+	errno_t rc = EOK;
+
+	while (idx < end) {
+		if (!bitmap_get(dirty, idx)) {
+			idx++;
+			continue;
+		}
+
+		size_t run = 1;
+		while ((idx + run < end) && (bitmap_get(dirty, idx + run)))
+			run++;
+
+		uintptr_t *frame = malloc(run * sizeof(uintptr_t));
+		if (!frame)
+			return ENOMEM;
+
+		uintptr_t base = area->base + P2SZ(idx);
+
+		page_table_lock(as, false);
+
+		tlb_batch_t batch;
+		tlb_batch_init(&batch, as);
+		tlb_batch_add(&batch, base, run);
+		ipl_t ipl = tlb_batch_shootdown_start(&batch);
+
+		for (size_t i = 0; i < run; i++) {
+			pte_t pte;
+			bool found = page_mapping_find(as, base + P2SZ(i),
+			    false, &pte);
+
+			(void) found;
+			assert(found);
+			assert(PTE_PRESENT(&pte));
+
+			frame[i] = PTE_GET_FRAME(&pte);
+			page_mapping_remove(as, base + P2SZ(i));
+		}
+
+		tlb_batch_invalidate(&batch);
+		as_invalidate_translation_cache(as, base, run);
+		tlb_shootdown_finalize(ipl);
+
+		for (size_t i = 0; i < run; i++)
+			page_mapping_insert(as, base + P2SZ(i), frame[i], flags);
+
+		page_table_unlock(as, false);
+		free(frame);
+
+		bitmap_clear_range(dirty, idx, run);
+
+		errno_t rc2 = user_pager_notify(area, IPC_M_PAGE_OUT, base, run);
+		if (rc2 != EOK) {
+			/* Retry on the next write back. */
+			bitmap_set_range(dirty, idx, run);
+			if (rc == EOK)
+				rc = rc2;
+		}
+
+		idx += run;
+	}
+
+	return rc;
+}
+
 /** @}
  */
@@ -37,13 +37,17 @@
  * @brief Physical frame allocator.
  *
  * This file contains the physical frame allocator and memory zone management.
- * The frame allocator is built on top of the two-level bitmap structure.
+ * Each zone keeps a bitmap of frames which are not free and a binary buddy
+ * allocator with free lists for each order, so that allocating and freeing
+ * frames takes logarithmic time in the size of the zone.
  *
  */
 
 #include <typedefs.h>
 #include <mm/frame.h>
 #include <mm/reserve.h>
+#include <mm/zero.h>
+#include <mm/numa.h>
 #include <mm/as.h>
 #include <panic.h>
 #include <assert.h>
@@ -61,9 +65,17 @@
 #include <config.h>
 #include <str.h>
 #include <proc/thread.h> /* THREAD */
+#include <cpu.h>
+#include <mem.h>
 
 zones_t zones;
 
+/** Terminator of the buddy free lists. */
+#define BUDDY_NONE  ((size_t) -1)
+
+/** Order of a frame which is not the first frame of a free block. */
+#define BUDDY_ORDER_NONE  UINT8_MAX
+
 /*
  * Synchronization primitives used to sleep when there is no memory
  * available.
@@ -73,6 +85,14 @@ static condvar_t mem_avail_cv;
 static size_t mem_avail_req = 0;  /**< Number of frames requested. */
 static size_t mem_avail_gen = 0;  /**< Generation counter. */
 
+/*
+ * The per-CPU frame caches are used only once the zones are final and
+ * the CPU structures exist. From then on, the zones are not added or
+ * merged, so that find_zone() may be called without zones.lock.
+ */
+static bool frame_cache_enabled = false;
+static bool frame_cache_highmem = false;  /**< There are highmem zones. */
+
 /** Initialize frame structure.
  *
  * @param frame Frame structure to be initialized.
@@ -82,6 +102,9 @@ _NO_TRACE static void frame_initialize(frame_t *frame)
 {
 	frame->refcount = 0;
 	frame->parent = NULL;
+	frame->buddy_next = BUDDY_NONE;
+	frame->buddy_prev = BUDDY_NONE;
+	frame->buddy_order = BUDDY_ORDER_NONE;
 }
 
 /*
@@ -147,6 +170,30 @@ _NO_TRACE static size_t zones_insert_zone(pfn_t base, size_t count,
 	return i;
 }
 
+/** Get number of frames in the per-CPU frame caches.
+ *
+ * The cached frames are allocated in their zones, but they are counted
+ * as free in all statistics. The counters of other CPUs are read without
+ * their locks, so the result is a snapshot.
+ *
+ * @param cls Class of the per-CPU frame cache lists.
+ *
+ * @return Number of cached frames of the class.
+ *
+ */
+_NO_TRACE static size_t frame_cache_count(frame_cache_class_t cls)
+{
+	if (!frame_cache_enabled)
+		return 0;
+
+	size_t total = 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++)
+		total += *((volatile size_t *) &cpus[i].frame_cache.count[cls]);
+
+	return total;
+}
+
 /** Get total available frames.
  *
  * Assume interrupts are disabled and zones lock is
@@ -163,7 +210,8 @@ _NO_TRACE static size_t frame_total_free_get_internal(void)
 	for (i = 0; i < zones.count; i++)
 		total += zones.info[i].free_count;
 
-	return total;
+	return total + frame_cache_count(FRAME_CACHE_LOWMEM) +
+	    frame_cache_count(FRAME_CACHE_HIGHMEM);
 }
 
 _NO_TRACE size_t frame_total_free_get(void)
@@ -209,18 +257,16 @@ _NO_TRACE size_t find_zone(pfn_t frame, size_t count, size_t hint)
 	return (size_t) -1;
 }
 
+_NO_TRACE static size_t buddy_find(zone_t *, size_t, pfn_t, unsigned int *);
+
 /** @return True if zone can allocate specified number of frames */
 _NO_TRACE static bool zone_can_alloc(zone_t *zone, size_t count,
     pfn_t constraint)
 {
-	/*
-	 * The function bitmap_allocate_range() does not modify
-	 * the bitmap if the last argument is NULL.
-	 */
+	unsigned int order;
 
 	return ((zone->flags & ZONE_AVAILABLE) &&
-	    bitmap_allocate_range(&zone->bitmap, count, zone->base,
-	    FRAME_LOWPRIO, constraint, NULL));
+	    (buddy_find(zone, count, constraint, &order) != BUDDY_NONE));
 }
 
 /** Find a zone that can allocate specified number of frames
@@ -233,13 +279,14 @@ _NO_TRACE static bool zone_can_alloc(zone_t *zone, size_t count,
  * @param constraint Indication of bits that cannot be set in the
  *                   physical frame number of the first allocated frame.
  * @param hint       Preferred zone.
+ * @param node       Required node of the zone or NUMA_NODE_ANY.
  *
  * @return Zone that can allocate specified number of frames.
  * @return -1 if no zone can satisfy the request.
  *
  */
 _NO_TRACE static size_t find_free_zone_all(size_t count, zone_flags_t flags,
-    pfn_t constraint, size_t hint)
+    pfn_t constraint, size_t hint, unsigned int node)
 {
 	for (size_t pos = 0; pos < zones.count; pos++) {
 		size_t i = (pos + hint) % zones.count;
@@ -248,6 +295,9 @@ _NO_TRACE static size_t find_free_zone_all(size_t count, zone_flags_t flags,
 		if (!ZONE_FLAGS_MATCH(zones.info[i].flags, flags))
 			continue;
 
+		if ((node != NUMA_NODE_ANY) && (zones.info[i].node != node))
+			continue;
+
 		/* Check if the zone can satisfy the allocation request. */
 		if (zone_can_alloc(&zones.info[i], count, constraint))
 			return i;
@@ -279,13 +329,14 @@ _NO_TRACE static bool is_high_priority(pfn_t base, size_t count)
  * @param constraint Indication of bits that cannot be set in the
  *                   physical frame number of the first allocated frame.
  * @param hint       Preferred zone.
+ * @param node       Required node of the zone or NUMA_NODE_ANY.
  *
  * @return Zone that can allocate specified number of frames.
  * @return -1 if no low-priority zone can satisfy the request.
  *
  */
 _NO_TRACE static size_t find_free_zone_lowprio(size_t count, zone_flags_t flags,
-    pfn_t constraint, size_t hint)
+    pfn_t constraint, size_t hint, unsigned int node)
 {
 	for (size_t pos = 0; pos < zones.count; pos++) {
 		size_t i = (pos + hint) % zones.count;
@@ -298,6 +349,9 @@ _NO_TRACE static size_t find_free_zone_lowprio(size_t count, zone_flags_t flags,
 		if (!ZONE_FLAGS_MATCH(zones.info[i].flags, flags))
 			continue;
 
+		if ((node != NUMA_NODE_ANY) && (zones.info[i].node != node))
+			continue;
+
 		/* Check if the zone can satisfy the allocation request. */
 		if (zone_can_alloc(&zones.info[i], count, constraint))
 			return i;
@@ -316,13 +370,14 @@ _NO_TRACE static size_t find_free_zone_lowprio(size_t count, zone_flags_t flags,
  * @param constraint Indication of bits that cannot be set in the
  *                   physical frame number of the first allocated frame.
  * @param hint       Preferred zone.
+ * @param node       Required node of the zone or NUMA_NODE_ANY.
  *
  * @return Zone that can allocate specified number of frames.
  * @return -1 if no zone can satisfy the request.
  *
  */
 _NO_TRACE static size_t find_free_zone(size_t count, zone_flags_t flags,
-    pfn_t constraint, size_t hint)
+    pfn_t constraint, size_t hint, unsigned int node)
 {
 	if (hint >= zones.count)
 		hint = 0;
@@ -332,12 +387,13 @@ _NO_TRACE static size_t find_free_zone(size_t count, zone_flags_t flags,
 	 * zones with high-priority memory.
 	 */
 
-	size_t znum = find_free_zone_lowprio(count, flags, constraint, hint);
+	size_t znum = find_free_zone_lowprio(count, flags, constraint, hint,
+	    node);
 	if (znum != (size_t) -1)
 		return znum;
 
 	/* Take all zones into account */
-	return find_free_zone_all(count, flags, constraint, hint);
+	return find_free_zone_all(count, flags, constraint, hint, node);
 }
 
 /*
@@ -352,6 +408,225 @@ _NO_TRACE static frame_t *zone_get_frame(zone_t *zone, size_t index)
 	return &zone->frames[index];
 }
 
+/*
+ * Buddy allocator functions
+ */
+
+/** Get the smallest order of a block of at least count frames. */
+_NO_TRACE static unsigned int buddy_order(size_t count)
+{
+	assert(count > 0);
+
+	return (count > 1) ? fnzb64(count - 1) + 1 : 0;
+}
+
+/** Get the buddy free list class of a block. */
+_NO_TRACE static unsigned int buddy_class(zone_t *zone, size_t index)
+{
+	return is_high_priority(zone->base + index, 1) ?
+	    ZONE_BUDDY_HIGHPRIO : ZONE_BUDDY_LOWPRIO;
+}
+
+/** Insert a free block into its buddy free list. */
+_NO_TRACE static void buddy_insert(zone_t *zone, size_t index,
+    unsigned int order)
+{
+	assert(order < ZONE_BUDDY_ORDERS);
+
+	frame_t *frame = zone_get_frame(zone, index);
+	size_t *head = &zone->free_head[buddy_class(zone, index)][order];
+
+	frame->buddy_order = order;
+	frame->buddy_prev = BUDDY_NONE;
+	frame->buddy_next = *head;
+
+	if (*head != BUDDY_NONE)
+		zone_get_frame(zone, *head)->buddy_prev = index;
+
+	*head = index;
+}
+
+/** Remove a free block from its buddy free list. */
+_NO_TRACE static void buddy_remove(zone_t *zone, size_t index)
+{
+	frame_t *frame = zone_get_frame(zone, index);
+	assert(frame->buddy_order != BUDDY_ORDER_NONE);
+
+	if (frame->buddy_prev != BUDDY_NONE) {
+		zone_get_frame(zone, frame->buddy_prev)->buddy_next =
+		    frame->buddy_next;
+	} else {
+		zone->free_head[buddy_class(zone, index)][frame->buddy_order] =
+		    frame->buddy_next;
+	}
+
+	if (frame->buddy_next != BUDDY_NONE) {
+		zone_get_frame(zone, frame->buddy_next)->buddy_prev =
+		    frame->buddy_prev;
+	}
+
+	frame->buddy_next = BUDDY_NONE;
+	frame->buddy_prev = BUDDY_NONE;
+	frame->buddy_order = BUDDY_ORDER_NONE;
+}
+
+/** Free a block and merge it with its free buddies.
+ *
+ * @param zone  Zone of the block.
+ * @param index Index of the first frame of the block, aligned to the
+ *              block size in the physical frame number space.
+ * @param order Order of the block.
+ *
+ */
+_NO_TRACE static void buddy_free(zone_t *zone, size_t index,
+    unsigned int order)
+{
+	while (order + 1 < ZONE_BUDDY_ORDERS) {
+		pfn_t buddy = (zone->base + index) ^ ((pfn_t) 1 << order);
+		if ((buddy < zone->base) || (buddy >= zone->base + zone->count))
+			break;
+
+		size_t buddy_index = buddy - zone->base;
+		if (zone_get_frame(zone, buddy_index)->buddy_order != order)
+			break;
+
+		buddy_remove(zone, buddy_index);
+		index = min(index, buddy_index);
+		order++;
+	}
+
+	buddy_insert(zone, index, order);
+}
+
+/** Free a range of frames into the buddy allocator.
+ *
+ * The range is split into the largest naturally aligned blocks.
+ *
+ */
+_NO_TRACE static void buddy_free_range(zone_t *zone, size_t index,
+    size_t count)
+{
+	while (count > 0) {
+		pfn_t pfn = zone->base + index;
+		unsigned int order = min(fnzb64(count), ZONE_BUDDY_ORDERS - 1);
+
+		if (pfn != 0)
+			order = min(order, lnzb64(pfn));
+
+		buddy_free(zone, index, order);
+
+		index += (size_t) 1 << order;
+		count -= (size_t) 1 << order;
+	}
+}
+
+/** Find a free block for an allocation.
+ *
+ * Blocks in low-priority memory are preferred. Because the blocks are
+ * naturally aligned, a block contains a position satisfying the
+ * constraint iff its first frame satisfies it.
+ *
+ * @param zone       Zone to search.
+ * @param count      Number of frames to allocate.
+ * @param constraint Indication of bits that cannot be set in the
+ *                   physical frame number of the first allocated frame.
+ * @param order      Place to store the order of the found block.
+ *
+ * @return Index of the first frame of the found block or BUDDY_NONE.
+ *
+ */
+_NO_TRACE static size_t buddy_find(zone_t *zone, size_t count,
+    pfn_t constraint, unsigned int *order)
+{
+	unsigned int min_order = buddy_order(count);
+	if (min_order >= ZONE_BUDDY_ORDERS)
+		return BUDDY_NONE;
+
+	for (unsigned int class = 0; class < 2; class++) {
+		for (unsigned int k = min_order; k < ZONE_BUDDY_ORDERS; k++) {
+			size_t index = zone->free_head[class][k];
+
+			while (index != BUDDY_NONE) {
+				if (((zone->base + index) & constraint) == 0) {
+					*order = k;
+					return index;
+				}
+
+				index = zone_get_frame(zone, index)->buddy_next;
+			}
+		}
+	}
+
+	return BUDDY_NONE;
+}
+
+/** Take a single free frame out of the buddy allocator.
+ *
+ * The free block containing the frame is split and the parts not
+ * containing the frame are put back to the free lists.
+ *
+ */
+_NO_TRACE static void buddy_take(zone_t *zone, size_t index)
+{
+	pfn_t pfn = zone->base + index;
+
+	for (unsigned int k = 0; k < ZONE_BUDDY_ORDERS; k++) {
+		pfn_t head_pfn = pfn & ~(((pfn_t) 1 << k) - 1);
+		if (head_pfn < zone->base)
+			break;
+
+		size_t head = head_pfn - zone->base;
+		if (zone_get_frame(zone, head)->buddy_order != k)
+			continue;
+
+		buddy_remove(zone, head);
+
+		while (k > 0) {
+			k--;
+
+			size_t half = head + ((size_t) 1 << k);
+			if (index >= half) {
+				buddy_insert(zone, head, k);
+				head = half;
+			} else {
+				buddy_insert(zone, half, k);
+			}
+		}
+
+		return;
+	}
+
+	panic("Free frame %p not found in buddy allocator.",
+	    (void *) PFN2ADDR(pfn));
+}
+
+/** Rebuild the buddy free lists of a zone from its bitmap. */
+_NO_TRACE static void buddy_rebuild(zone_t *zone)
+{
+	for (unsigned int class = 0; class < 2; class++) {
+		for (unsigned int k = 0; k < ZONE_BUDDY_ORDERS; k++)
+			zone->free_head[class][k] = BUDDY_NONE;
+	}
+
+	for (size_t i = 0; i < zone->count; i++)
+		zone->frames[i].buddy_order = BUDDY_ORDER_NONE;
+
+	size_t i = 0;
+	while (i < zone->count) {
+		if (bitmap_get(&zone->bitmap, i)) {
+			i++;
+			continue;
+		}
+
+		size_t end = i + 1;
+		while ((end < zone->count) && (!bitmap_get(&zone->bitmap, end)))
+			end++;
+
+		buddy_free_range(zone, i, end - i);
+		i = end;
+	}
+}
+
 /** Allocate frame in particular zone.
  *
  * Assume zone is locked and is available for allocation.
@@ -372,13 +647,24 @@ _NO_TRACE static size_t zone_frame_alloc(zone_t *zone, size_t count,
 	assert(zone->free_count >= count);
 
 	/* Allocate frames from zone */
-	size_t index = (size_t) -1;
-	int avail = bitmap_allocate_range(&zone->bitmap, count, zone->base,
-	    FRAME_LOWPRIO, constraint, &index);
+	unsigned int order;
+	size_t index = buddy_find(zone, count, constraint, &order);
+	assert(index != BUDDY_NONE);
+
+	buddy_remove(zone, index);
 
-	(void) avail;
-	assert(avail);
-	assert(index != (size_t) -1);
+	/* Split the block down to the requested size */
+	unsigned int min_order = buddy_order(count);
+	while (order > min_order) {
+		order--;
+		buddy_insert(zone, index + ((size_t) 1 << order), order);
+	}
+
+	/* Return the frames beyond the requested count */
+	buddy_free_range(zone, index + count,
+	    ((size_t) 1 << min_order) - count);
+
+	bitmap_set_range(&zone->bitmap, index, count);
 
 	/* Update frame reference count */
 	for (size_t i = 0; i < count; i++) {
@@ -416,6 +702,7 @@ _NO_TRACE static size_t zone_frame_free(zone_t *zone, size_t index)
 		assert(zone->busy_count > 0);
 
 		bitmap_set(&zone->bitmap, index, 0);
+		buddy_free(zone, index, 0);
 
 		/* Update zone information. */
 		zone->free_count++;
@@ -442,6 +729,7 @@ _NO_TRACE static void zone_mark_unavailable(zone_t *zone, size_t index)
 
 	frame->refcount = 1;
 	bitmap_set_range(&zone->bitmap, index, 1);
+	buddy_take(zone, index);
 
 	zone->free_count--;
 	reserve_force_alloc(1);
@@ -457,6 +745,7 @@ _NO_TRACE static void zone_mark_available(zone_t *zone, size_t index)
 
 	frame->refcount = 0;
 	bitmap_set_range(&zone->bitmap, index, 0);
+	buddy_free(zone, index, 0);
 
 	zone->free_count++;
 }
@@ -513,14 +802,21 @@ _NO_TRACE static void zone_merge_internal(size_t z1, size_t z2, zone_t *old_z1,
 		    zones.info[z2].frames[i];
 	}
 
+	for (size_t i = 0; i < gap; i++)
+		frame_initialize(&zones.info[z1].frames[old_z1->count + i]);
+
+	/*
+	 * The free blocks of both zones may have merged, the frame indices
+	 * have changed as well.
+	 */
+	buddy_rebuild(&zones.info[z1]);
+
 	/*
 	 * Mark the gap between the original zones as unavailable.
 	 */
 
-	for (size_t i = 0; i < gap; i++) {
-		frame_initialize(&zones.info[z1].frames[old_z1->count + i]);
+	for (size_t i = 0; i < gap; i++)
 		zone_mark_unavailable(&zones.info[z1], old_z1->count + i);
-	}
 }
 
 /** Return old configuration frames into the zone.
@@ -571,10 +867,11 @@ bool zone_merge(size_t z1, size_t z2)
 	/*
 	 * We can join only 2 zones with none existing inbetween,
 	 * the zones have to be available and with the same
-	 * set of flags
+	 * set of flags and on the same node
 	 */
 	if ((z1 >= zones.count) || (z2 >= zones.count) || (z2 - z1 != 1) ||
-	    (zones.info[z1].flags != zones.info[z2].flags)) {
+	    (zones.info[z1].flags != zones.info[z2].flags) ||
+	    (zones.info[z1].node != zones.info[z2].node)) {
 		ret = false;
 		goto errout;
 	}
@@ -641,6 +938,198 @@ void zone_merge_all(void)
 	}
 }
 
+/** Initialize a part of a zone being split.
+ *
+ * Assume zones lock is locked.
+ *
+ * @param zone     Zone to initialize.
+ * @param old      Original data of the zone being split.
+ * @param offset   Index of the first frame of the part in the original zone.
+ * @param count    Number of frames of the part.
+ * @param confdata Configuration data of the part.
+ *
+ */
+_NO_TRACE static void zone_split_internal(zone_t *zone, zone_t *old,
+    size_t offset, size_t count, void *confdata)
+{
+	zone->base = old->base + offset;
+	zone->count = count;
+	zone->flags = old->flags;
+	zone->node = numa_pfn_node(zone->base);
+
+	bitmap_initialize(&zone->bitmap, count,
+	    confdata + (sizeof(frame_t) * count));
+	zone->frames = (frame_t *) confdata;
+
+	/*
+	 * Copy frames and bits to preserve parents, etc. The zone does not
+	 * tell busy frames from frames marked unavailable, all frames not
+	 * free are accounted as busy.
+	 */
+	size_t busy = 0;
+	for (size_t i = 0; i < count; i++) {
+		unsigned int bit = bitmap_get(&old->bitmap, offset + i);
+
+		bitmap_set(&zone->bitmap, i, bit);
+		zone->frames[i] = old->frames[offset + i];
+		busy += bit;
+	}
+
+	zone->free_count = count - busy;
+	zone->busy_count = busy;
+
+	buddy_rebuild(zone);
+}
+
+/** Stop accounting frames of a split zone as busy.
+ *
+ * @param znum  First part of the split zone.
+ * @param pfn   First frame to stop accounting.
+ * @param count Number of frames.
+ * @param avail Also return the frames to the allocator.
+ *
+ */
+_NO_TRACE static void zone_split_unbusy(size_t znum, pfn_t pfn, size_t count,
+    bool avail)
+{
+	for (pfn_t i = pfn; i < pfn + count; i++) {
+		size_t z = (i < zones.info[znum + 1].base) ? znum : znum + 1;
+
+		if ((i < zones.info[z].base) ||
+		    (i >= zones.info[z].base + zones.info[z].count))
+			continue;
+
+		assert(zones.info[z].busy_count > 0);
+		zones.info[z].busy_count--;
+
+		if (avail)
+			zone_mark_available(&zones.info[z],
+			    i - zones.info[z].base);
+	}
+}
+
+/** Split a zone in two.
+ *
+ * Both parts keep the state of their frames. The configuration data of
+ * the parts is allocated from the zone being split, the original
+ * configuration data is then returned to the parts.
+ *
+ * @param znum Zone to split.
+ * @param pfn  First frame of the second part.
+ *
+ * @return True on success.
+ *
+ */
+bool zone_split(size_t znum, pfn_t pfn)
+{
+	irq_spinlock_lock(&zones.lock, true);
+
+	bool ret = true;
+
+	if ((znum >= zones.count) || (zones.count + 1 == ZONES_MAX) ||
+	    (pfn <= zones.info[znum].base) ||
+	    (pfn >= zones.info[znum].base + zones.info[znum].count)) {
+		ret = false;
+		goto errout;
+	}
+
+	zone_t *zone = &zones.info[znum];
+	size_t count1 = pfn - zone->base;
+	size_t count2 = zone->count - count1;
+
+	if (!(zone->flags & ZONE_AVAILABLE)) {
+		/* Nothing is allocated from the zone, just cut it. */
+		for (size_t i = zones.count; i > znum + 1; i--)
+			zones.info[i] = zones.info[i - 1];
+
+		zones.count++;
+
+		zones.info[znum].count = count1;
+		zones.info[znum + 1].base = pfn;
+		zones.info[znum + 1].count = count2;
+		zones.info[znum + 1].node = numa_pfn_node(pfn);
+		goto errout;
+	}
+
+	/* Allocate the configuration data of both parts inside the zone */
+	pfn_t cframes1 = SIZE2FRAMES(zone_conf_size(count1));
+	pfn_t cframes2 = SIZE2FRAMES(zone_conf_size(count2));
+
+	if (!zone_can_alloc(zone, cframes1, 0)) {
+		ret = false;
+		goto errout;
+	}
+
+	pfn_t conf1 = zone->base + zone_frame_alloc(zone, cframes1, 0);
+
+	if (!zone_can_alloc(zone, cframes2, 0)) {
+		for (pfn_t i = conf1; i < conf1 + cframes1; i++)
+			(void) zone_frame_free(zone, i - zone->base);
+
+		ret = false;
+		goto errout;
+	}
+
+	pfn_t conf2 = zone->base + zone_frame_alloc(zone, cframes2, 0);
+
+	/* Preserve original data of the zone */
+	zone_t old = *zone;
+
+	/* Move zones up */
+	for (size_t i = zones.count; i > znum + 1; i--)
+		zones.info[i] = zones.info[i - 1];
+
+	zones.count++;
+
+	zone_split_internal(&zones.info[znum], &old, 0, count1,
+	    (void *) PA2KA(PFN2ADDR(conf1)));
+	zone_split_internal(&zones.info[znum + 1], &old, count1, count2,
+	    (void *) PA2KA(PFN2ADDR(conf2)));
+
+	/* Configuration data is not accounted as busy */
+	zone_split_unbusy(znum, conf1, cframes1, false);
+	zone_split_unbusy(znum, conf2, cframes2, false);
+
+	/* Free old zone information */
+	zone_split_unbusy(znum, ADDR2PFN(KA2PA((uintptr_t) old.frames)),
+	    SIZE2FRAMES(zone_conf_size(old.count)), true);
+
+errout:
+	irq_spinlock_unlock(&zones.lock, true);
+
+	return ret;
+}
+
+/** Split zones at NUMA node boundaries.
+ *
+ * To be called once the node affinity of memory is known. Afterwards,
+ * each zone holds memory of a single node.
+ *
+ */
+void zones_numa_init(void)
+{
+	if (numa_node_count() == 1)
+		return;
+
+	for (size_t i = 0; i < zones.count; i++) {
+		pfn_t base = zones.info[i].base;
+		pfn_t end = base + zones.info[i].count;
+		unsigned int node = numa_pfn_node(base);
+
+		zones.info[i].node = node;
+
+		pfn_t split = numa_pfn_end(base);
+		while ((split < end) && (numa_pfn_node(split) == node))
+			split = numa_pfn_end(split);
+
+		if ((split < end) && (!zone_split(i, split))) {
+			log(LF_OTHER, LVL_WARN, "Cannot split zone %zu at %p "
+			    "for NUMA node boundary.", i,
+			    (void *) PFN2ADDR(split));
+		}
+	}
+}
+
 /** Create new frame zone.
  *
  * @param zone     Zone to construct.
@@ -658,6 +1147,7 @@ _NO_TRACE static void zone_construct(zone_t *zone, pfn_t start, size_t count,
 	zone->base = start;
 	zone->count = count;
 	zone->flags = flags;
+	zone->node = numa_pfn_node(start);
 	zone->free_count = count;
 	zone->busy_count = 0;
 
@@ -679,9 +1169,16 @@ _NO_TRACE static void zone_construct(zone_t *zone, pfn_t start, size_t count,
 
 		for (size_t i = 0; i < count; i++)
 			frame_initialize(&zone->frames[i]);
+
+		buddy_rebuild(zone);
 	} else {
 		bitmap_initialize(&zone->bitmap, 0, NULL);
 		zone->frames = NULL;
+
+		for (unsigned int class = 0; class < 2; class++) {
+			for (unsigned int k = 0; k < ZONE_BUDDY_ORDERS; k++)
+				zone->free_head[class][k] = BUDDY_NONE;
+		}
 	}
 }
 
@@ -845,18 +1342,298 @@ void *frame_get_parent(pfn_t pfn, size_t hint)
 	return res;
 }
 
-static size_t try_find_zone(size_t count, bool lowmem,
-    pfn_t frame_constraint, size_t hint)
+/** Enable the per-CPU frame caches.
+ *
+ * Must be called after the zones are created and merged and after the
+ * CPU structures are allocated.
+ *
+ */
+void frame_enable_cpucache(void)
+{
+	irq_spinlock_lock(&zones.lock, true);
+
+	for (size_t i = 0; i < zones.count; i++) {
+		if ((zones.info[i].flags & ZONE_AVAILABLE) &&
+		    (zones.info[i].flags & ZONE_HIGHMEM))
+			frame_cache_highmem = true;
+	}
+
+	frame_cache_enabled = true;
+
+	irq_spinlock_unlock(&zones.lock, true);
+}
+
+/** Get the node of the frames held by the per-CPU frame cache.
+ *
+ * @return Node of the current CPU or NUMA_NODE_ANY on single-node
+ *         systems.
+ *
+ */
+_NO_TRACE static unsigned int frame_cache_node(void)
+{
+	return (numa_node_count() > 1) ? CPU->topology.node : NUMA_NODE_ANY;
+}
+
+/** Refill a per-CPU frame cache list from the zones.
+ *
+ * Assume interrupts are disabled and the cache is locked.
+ *
+ * @param cache Per-CPU frame cache.
+ * @param cls   Class of the list to refill.
+ *
+ * @return Number of frames in the list after the refill.
+ *
+ */
+_NO_TRACE static size_t frame_cache_refill(frame_cache_t *cache,
+    frame_cache_class_t cls)
+{
+	zone_flags_t flags = ZONE_AVAILABLE |
+	    ((cls == FRAME_CACHE_HIGHMEM) ? ZONE_HIGHMEM : ZONE_LOWMEM);
+	size_t znum = 0;
+
+	irq_spinlock_lock(&zones.lock, false);
+
+	while (cache->count[cls] < FRAME_CACHE_LOW) {
+		znum = find_free_zone(1, flags, 0, znum, frame_cache_node());
+		if (znum == (size_t) -1)
+			break;
+
+		cache->pfn[cls][cache->count[cls]++] =
+		    zone_frame_alloc(&zones.info[znum], 1, 0) +
+		    zones.info[znum].base;
+	}
+
+	irq_spinlock_unlock(&zones.lock, false);
+
+	return cache->count[cls];
+}
+
+/** Drain the oldest frames of a per-CPU frame cache list into the zones.
+ *
+ * Assume interrupts are disabled and the cache is locked.
+ *
+ * @param cache Per-CPU frame cache.
+ * @param cls   Class of the list to drain.
+ * @param count Number of frames to drain.
+ *
+ * @return Number of frames which became free in the zones.
+ *
+ */
+_NO_TRACE static size_t frame_cache_drain(frame_cache_t *cache,
+    frame_cache_class_t cls, size_t count)
+{
+	size_t freed = 0;
+
+	assert(count <= cache->count[cls]);
+
+	irq_spinlock_lock(&zones.lock, false);
+
+	for (size_t i = 0; i < count; i++) {
+		pfn_t pfn = cache->pfn[cls][i];
+		size_t znum = find_zone(pfn, 1, 0);
+
+		assert(znum != (size_t) -1);
+
+		freed += zone_frame_free(&zones.info[znum],
+		    pfn - zones.info[znum].base);
+	}
+
+	irq_spinlock_unlock(&zones.lock, false);
+
+	cache->count[cls] -= count;
+	memmove(&cache->pfn[cls][0], &cache->pfn[cls][count],
+	    cache->count[cls] * sizeof(pfn_t));
+
+	return freed;
+}
+
+/** Drain all per-CPU frame caches into the zones.
+ *
+ * Used when the zones cannot satisfy an allocation or when the memory
+ * is being reclaimed, so that the frames cached by other CPUs are not
+ * lost for the allocations.
+ *
+ * @return Number of frames which became free in the zones.
+ *
+ */
+size_t frame_cache_trim(void)
+{
+	size_t freed = 0;
+
+	if (!frame_cache_enabled)
+		return 0;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		frame_cache_t *cache = &cpus[i].frame_cache;
+
+		irq_spinlock_lock(&cache->lock, true);
+
+		for (unsigned int cls = 0; cls < FRAME_CACHE_CLASSES; cls++)
+			freed += frame_cache_drain(cache, cls, cache->count[cls]);
+
+		irq_spinlock_unlock(&cache->lock, true);
+	}
+
+	return freed;
+}
+
+/** Take a frame from a per-CPU frame cache list.
+ *
+ * Assume interrupts are disabled and the cache is locked.
+ *
+ * @return Frame number of the frame or 0 if there is none.
+ *
+ */
+_NO_TRACE static pfn_t frame_cache_pop(frame_cache_t *cache,
+    frame_cache_class_t cls)
+{
+	if (cache->count[cls] > 0) {
+		cache->hits++;
+	} else {
+		cache->misses++;
+		if (frame_cache_refill(cache, cls) == 0)
+			return 0;
+	}
+
+	return cache->pfn[cls][--cache->count[cls]];
+}
+
+/** Allocate a single frame from the per-CPU frame cache.
+ *
+ * @param lowmem Whether the frame must be identity-mappable.
+ *
+ * @return Frame number of the frame or 0 if the zones are exhausted.
+ *
+ */
+_NO_TRACE static pfn_t frame_cache_alloc(bool lowmem)
+{
+	ipl_t ipl = interrupts_disable();
+	frame_cache_t *cache = &CPU->frame_cache;
+	pfn_t pfn = 0;
+
+	irq_spinlock_lock(&cache->lock, false);
+
+	if ((!lowmem) && (frame_cache_highmem))
+		pfn = frame_cache_pop(cache, FRAME_CACHE_HIGHMEM);
+
+	if (pfn == 0)
+		pfn = frame_cache_pop(cache, FRAME_CACHE_LOWMEM);
+
+	irq_spinlock_unlock(&cache->lock, false);
+	interrupts_restore(ipl);
+
+	return pfn;
+}
+
+/** Free a single frame into the per-CPU frame cache.
+ *
+ * Only frames with no other references are cached, shared frames
+ * just lose a reference in the zone.
+ *
+ * @param pfn Frame number of the frame.
+ *
+ * @return True if the frame has been cached.
+ *
+ */
+_NO_TRACE static bool frame_cache_free(pfn_t pfn)
+{
+	size_t znum = find_zone(pfn, 1, 0);
+
+	assert(znum != (size_t) -1);
+
+	zone_t *zone = &zones.info[znum];
+
+	/*
+	 * The caller holds the last reference if the reference count is one,
+	 * nobody else may change it in the meantime.
+	 */
+	if (zone->frames[pfn - zone->base].refcount != 1)
+		return false;
+
+	/* Frames of remote nodes go back to their zones. */
+	unsigned int node = frame_cache_node();
+	if ((node != NUMA_NODE_ANY) && (zone->node != node))
+		return false;
+
+	frame_cache_class_t cls = (zone->flags & ZONE_HIGHMEM) ?
+	    FRAME_CACHE_HIGHMEM : FRAME_CACHE_LOWMEM;
+
+	ipl_t ipl = interrupts_disable();
+	frame_cache_t *cache = &CPU->frame_cache;
+
+	irq_spinlock_lock(&cache->lock, false);
+
+	/*
+	 * Nobody waits for memory (see frame_free_generic()), so the drained
+	 * frames need not be announced.
+	 */
+	if (cache->count[cls] == FRAME_CACHE_HIGH)
+		(void) frame_cache_drain(cache, cls,
+		    FRAME_CACHE_HIGH - FRAME_CACHE_LOW);
+
+	cache->pfn[cls][cache->count[cls]++] = pfn;
+
+	irq_spinlock_unlock(&cache->lock, false);
+	interrupts_restore(ipl);
+
+	return true;
+}
+
+/** Get hit and miss counters of all per-CPU frame caches.
+ *
+ * @param hits   Place to store the number of allocations served
+ *               from the caches.
+ * @param misses Place to store the number of allocations which had
+ *               to refill the caches.
+ *
+ */
+void frame_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+	*hits = 0;
+	*misses = 0;
+
+	if (!frame_cache_enabled)
+		return;
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		irq_spinlock_lock(&cpus[i].frame_cache.lock, true);
+		*hits += cpus[i].frame_cache.hits;
+		*misses += cpus[i].frame_cache.misses;
+		irq_spinlock_unlock(&cpus[i].frame_cache.lock, true);
+	}
+}
+
+static size_t try_find_zone_node(size_t count, bool lowmem,
+    pfn_t frame_constraint, size_t hint, unsigned int node)
 {
 	if (!lowmem) {
 		size_t znum = find_free_zone(count,
-		    ZONE_HIGHMEM | ZONE_AVAILABLE, frame_constraint, hint);
+		    ZONE_HIGHMEM | ZONE_AVAILABLE, frame_constraint, hint, node);
 		if (znum != (size_t) -1)
 			return znum;
 	}
 
 	return find_free_zone(count, ZONE_LOWMEM | ZONE_AVAILABLE,
-	    frame_constraint, hint);
+	    frame_constraint, hint, node);
+}
+
+/** Find a zone for an allocation, preferring zones of a node.
+ *
+ * Unless the allocation is strict, zones of other nodes are used if the
+ * preferred node has no suitable zone.
+ *
+ */
+static size_t try_find_zone(size_t count, bool lowmem,
+    pfn_t frame_constraint, size_t hint, unsigned int node, bool strict)
+{
+	size_t znum = try_find_zone_node(count, lowmem, frame_constraint,
+	    hint, node);
+
+	if ((znum == (size_t) -1) && (node != NUMA_NODE_ANY) && (!strict))
+		znum = try_find_zone_node(count, lowmem, frame_constraint,
+		    hint, NUMA_NODE_ANY);
+
+	return znum;
 }
 
 /** Allocate frames of physical memory.
@@ -878,22 +1655,80 @@ uintptr_t frame_alloc_generic(size_t count, frame_flags_t flags,
 	size_t hint = pzone ? (*pzone) : 0;
 	pfn_t frame_constraint = ADDR2PFN(constraint);
 
+	bool strict;
+	unsigned int node = numa_node_select((flags & FRAME_POLICY) != 0,
+	    &strict);
+
+	/*
+	 * Single unconstrained zeroed frames come from the pool of pre-zeroed
+	 * frames, unless they must come from a particular node. Any other
+	 * zeroed frames are zeroed here.
+	 */
+	if (flags & FRAME_ZERO) {
+		if ((count == 1) && (frame_constraint == 0) && (pzone == NULL) &&
+		    (node == NUMA_NODE_ANY)) {
+			uintptr_t frame = zero_pool_get();
+			if (frame != 0) {
+				if (!(flags & FRAME_NO_RESERVE))
+					reserve_force_alloc(count);
+
+				return frame;
+			}
+		}
+
+		uintptr_t frame = frame_alloc_generic(count,
+		    flags & ~FRAME_ZERO, constraint, pzone);
+		if (frame != 0) {
+			for (size_t i = 0; i < count; i++)
+				frame_zero(frame + i * FRAME_SIZE);
+		}
+
+		return frame;
+	}
+
 	/*
 	 * If not told otherwise, we must first reserve the memory.
 	 */
 	if (!(flags & FRAME_NO_RESERVE))
 		reserve_force_alloc(count);
 
-loop:
-	irq_spinlock_lock(&zones.lock, true);
-
 	// TODO: Print diagnostic if neither is explicitly specified.
 	bool lowmem = (flags & FRAME_LOWMEM) || !(flags & FRAME_HIGHMEM);
 
+	/*
+	 * Single unconstrained frames come from the per-CPU frame cache,
+	 * which holds frames of the local node only.
+	 */
+	if ((count == 1) && (frame_constraint == 0) && (pzone == NULL) &&
+	    (frame_cache_enabled) && (node == frame_cache_node())) {
+		pfn_t pfn = frame_cache_alloc(lowmem);
+		if (pfn != 0)
+			return PFN2ADDR(pfn);
+	}
+
+loop:
+	irq_spinlock_lock(&zones.lock, true);
+
 	/*
 	 * First, find suitable frame zone.
 	 */
-	size_t znum = try_find_zone(count, lowmem, frame_constraint, hint);
+	size_t znum = try_find_zone(count, lowmem, frame_constraint, hint,
+	    node, strict);
+
+	/*
+	 * If no memory, return the pre-zeroed frames and the frames cached
+	 * by all CPUs to the zones.
+	 */
+	if (znum == (size_t) -1) {
+		irq_spinlock_unlock(&zones.lock, true);
+		size_t freed = zero_pool_drain();
+		freed += frame_cache_trim();
+		irq_spinlock_lock(&zones.lock, true);
+
+		if (freed > 0)
+			znum = try_find_zone(count, lowmem,
+			    frame_constraint, hint, node, strict);
+	}
 
 	/*
 	 * If no memory, reclaim some slab memory,
@@ -906,7 +1741,7 @@ loop:
 
 		if (freed > 0)
 			znum = try_find_zone(count, lowmem,
-			    frame_constraint, hint);
+			    frame_constraint, hint, node, strict);
 
 		if (znum == (size_t) -1) {
 			irq_spinlock_unlock(&zones.lock, true);
@@ -915,7 +1750,7 @@ loop:
 
 			if (freed > 0)
 				znum = try_find_zone(count, lowmem,
-				    frame_constraint, hint);
+				    frame_constraint, hint, node, strict);
 		}
 	}
 
@@ -1006,6 +1841,18 @@ void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 {
 	size_t freed = 0;
 
+	/*
+	 * Unless somebody waits for memory to become available in the zones,
+	 * single frames are freed into the per-CPU frame cache.
+	 */
+	if ((count == 1) && (frame_cache_enabled) && (mem_avail_req == 0) &&
+	    (frame_cache_free(ADDR2PFN(start)))) {
+		if (!(flags & FRAME_NO_RESERVE))
+			reserve_free(1);
+
+		return;
+	}
+
 	irq_spinlock_lock(&zones.lock, true);
 
 	for (size_t i = 0; i < count; i++) {
@@ -1082,6 +1929,29 @@ _NO_TRACE void frame_reference_add(pfn_t pfn)
 	irq_spinlock_unlock(&zones.lock, true);
 }
 
+/** Get reference count of frame.
+ *
+ * @param pfn Frame number of the frame.
+ *
+ * @return Number of references to the frame.
+ *
+ */
+_NO_TRACE size_t frame_reference_count(pfn_t pfn)
+{
+	irq_spinlock_lock(&zones.lock, true);
+
+	size_t znum = find_zone(pfn, 1, 0);
+
+	assert(znum != (size_t) -1);
+
+	size_t refcount =
+	    zones.info[znum].frames[pfn - zones.info[znum].base].refcount;
+
+	irq_spinlock_unlock(&zones.lock, true);
+
+	return refcount;
+}
+
 /** Mark given range unavailable in frame zones.
  *
  */
@@ -1195,13 +2065,24 @@ uint64_t zones_total_size(void)
 	return total;
 }
 
+/** Get physical memory statistics.
+ *
+ * @param total     Total size of all zones.
+ * @param unavail   Size of zones not available for allocation.
+ * @param busy      Allocated memory.
+ * @param free      Free memory.
+ * @param node_busy Allocated memory of each NUMA node or NULL.
+ * @param node_free Free memory of each NUMA node or NULL.
+ *
+ */
 void zones_stats(uint64_t *total, uint64_t *unavail, uint64_t *busy,
-    uint64_t *free)
+    uint64_t *free, uint64_t *node_busy, uint64_t *node_free)
 {
 	assert(total != NULL);
 	assert(unavail != NULL);
 	assert(busy != NULL);
 	assert(free != NULL);
+	assert((node_busy == NULL) == (node_free == NULL));
 
 	irq_spinlock_lock(&zones.lock, true);
 
@@ -1210,16 +2091,53 @@ void zones_stats(uint64_t *total, uint64_t *unavail, uint64_t *busy,
 	*busy = 0;
 	*free = 0;
 
+	if (node_busy != NULL) {
+		memsetb(node_busy, sizeof(uint64_t) * NUMA_NODES_MAX, 0);
+		memsetb(node_free, sizeof(uint64_t) * NUMA_NODES_MAX, 0);
+	}
+
 	for (size_t i = 0; i < zones.count; i++) {
 		*total += (uint64_t) FRAMES2SIZE(zones.info[i].count);
 
 		if (zones.info[i].flags & ZONE_AVAILABLE) {
-			*busy += (uint64_t) FRAMES2SIZE(zones.info[i].busy_count);
-			*free += (uint64_t) FRAMES2SIZE(zones.info[i].free_count);
+			uint64_t zbusy = FRAMES2SIZE(zones.info[i].busy_count);
+			uint64_t zfree = FRAMES2SIZE(zones.info[i].free_count);
+
+			*busy += zbusy;
+			*free += zfree;
+
+			if (node_busy != NULL) {
+				node_busy[zones.info[i].node] += zbusy;
+				node_free[zones.info[i].node] += zfree;
+			}
 		} else
 			*unavail += (uint64_t) FRAMES2SIZE(zones.info[i].count);
 	}
 
+	/* Frames in the per-CPU frame caches are busy only in their zones. */
+	uint64_t cached = (uint64_t) FRAMES2SIZE(
+	    frame_cache_count(FRAME_CACHE_LOWMEM) +
+	    frame_cache_count(FRAME_CACHE_HIGHMEM));
+
+	*busy -= min(*busy, cached);
+	*free += cached;
+
+	/* The per-CPU frame caches hold frames of the node of their CPU. */
+	if ((node_busy != NULL) && (frame_cache_enabled)) {
+		for (size_t i = 0; i < config.cpu_count; i++) {
+			frame_cache_t *cache = &cpus[i].frame_cache;
+			uint64_t ccached = FRAMES2SIZE(
+			    *((volatile size_t *) &cache->count[FRAME_CACHE_LOWMEM]) +
+			    *((volatile size_t *) &cache->count[FRAME_CACHE_HIGHMEM]));
+			unsigned int node = (numa_node_count() > 1) ?
+			    cpus[i].topology.node : 0;
+
+			ccached = min(node_busy[node], ccached);
+			node_busy[node] -= ccached;
+			node_free[node] += ccached;
+		}
+	}
+
 	irq_spinlock_unlock(&zones.lock, true);
 }
 
@@ -1325,6 +2243,34 @@ void zones_print_list(void)
 
 	printf("\n");
 
+	/*
+	 * The frames in the per-CPU frame caches are shown as busy
+	 * in their zones, but they are available.
+	 */
+	if (frame_cache_enabled) {
+		printf("[cpu] [lowmem] [highmem] [hits              ] "
+		    "[misses            ]\n");
+
+		for (size_t i = 0; i < config.cpu_count; i++) {
+			frame_cache_t *cache = &cpus[i].frame_cache;
+
+			irq_spinlock_lock(&cache->lock, true);
+			size_t cached_lowmem = cache->count[FRAME_CACHE_LOWMEM];
+			size_t cached_highmem = cache->count[FRAME_CACHE_HIGHMEM];
+			uint64_t hits = cache->hits;
+			uint64_t misses = cache->misses;
+			irq_spinlock_unlock(&cache->lock, true);
+
+			free_lowmem += cached_lowmem;
+			free_highmem += cached_highmem;
+
+			printf("%-5zu %8zu %9zu %20" PRIu64 " %20" PRIu64 "\n",
+			    i, cached_lowmem, cached_highmem, hits, misses);
+		}
+
+		printf("\n");
+	}
+
 	uint64_t size;
 	const char *size_suffix;
 
@@ -1374,6 +2320,7 @@ void zone_print_one(size_t num)
 	pfn_t fbase = zones.info[znum].base;
 	uintptr_t base = PFN2ADDR(fbase);
 	zone_flags_t flags = zones.info[znum].flags;
+	unsigned int node = zones.info[znum].node;
 	size_t count = zones.info[znum].count;
 	size_t free_count = zones.info[znum].free_count;
 	size_t busy_count = zones.info[znum].busy_count;
@@ -1420,6 +2367,7 @@ void zone_print_one(size_t num)
 	printf("Zone base address:       %p\n", (void *) base);
 	printf("Zone size:               %zu frames (%" PRIu64 " %s)\n", count,
 	    size, size_suffix);
+	printf("Zone node:               %u\n", node);
 	printf("Zone flags:              %c%c%c%c%c\n",
 	    available ? 'A' : '-',
 	    (flags & ZONE_RESERVED) ? 'R' : '-',
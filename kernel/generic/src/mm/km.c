@@ -241,15 +241,16 @@ static void km_unmap_deferred(uintptr_t page)
  *
  * @param[inout] framep	Pointer to a variable which will receive the physical
  *			address of the allocated frame.
- * @param[in] flags	Frame allocation flags. FRAME_NONE, FRAME_NO_RESERVE
- *			and FRAME_ATOMIC bits are allowed.
- * @return		Virtual address of the allocated frame.
+ * @param[in] flags	Frame allocation flags. FRAME_NONE, FRAME_NO_RESERVE,
+ *			FRAME_ATOMIC and FRAME_POLICY bits are allowed.
+ * @return		Virtual address of the allocated frame or 0 if an atomic
+ *			allocation failed.
  */
 uintptr_t km_temporary_page_get(uintptr_t *framep, frame_flags_t flags)
 {
 	assert(THREAD);
 	assert(framep);
-	assert(!(flags & ~(FRAME_NO_RESERVE | FRAME_ATOMIC)));
+	assert(!(flags & ~(FRAME_NO_RESERVE | FRAME_ATOMIC | FRAME_POLICY)));
 
 	/*
 	 * Allocate a frame, preferably from high memory.
@@ -258,6 +259,9 @@ uintptr_t km_temporary_page_get(uintptr_t *framep, frame_flags_t flags)
 	uintptr_t frame;
 
 	frame = frame_alloc(1, FRAME_HIGHMEM | flags, 0);
+	if (frame == 0)
+		return 0;
+
 	if (frame >= config.identity_size) {
 		page = km_map(frame, PAGE_SIZE, PAGE_SIZE,
 		    PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE);
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+
+/**
+ * @file
+ * @brief NUMA node affinity of memory and CPUs.
+ *
+ * The platform code registers the node affinity of memory ranges and
+ * CPUs, typically from the ACPI SRAT. Firmware proximity domains are
+ * mapped to dense node numbers in the order in which they are first
+ * seen. Without any registered affinity, the system has a single node.
+ *
+ * The affinity is registered during boot only, so the tables are read
+ * without locking afterwards.
+ */
+
+#include <mm/numa.h>
+#include <mm/frame.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+#include <align.h>
+#include <cpu.h>
+#include <log.h>
+
+/** Memory range with known node affinity. */
+typedef struct {
+	pfn_t base;
+	size_t count;
+	unsigned int node;
+} numa_range_t;
+
+/** Memory ranges sorted by their base. */
+static numa_range_t numa_ranges[NUMA_RANGES_MAX];
+static size_t numa_range_count = 0;
+
+/** CPU with known node affinity. */
+typedef struct {
+	unsigned int hwid;
+	unsigned int node;
+} numa_cpu_t;
+
+static numa_cpu_t numa_cpus[NUMA_CPUS_MAX];
+static size_t numa_cpu_count = 0;
+
+/** Proximity domains of the nodes, indexed by node number. */
+static uint32_t numa_domains[NUMA_NODES_MAX];
+static unsigned int numa_nodes = 0;
+
+/** Get the node number of a firmware proximity domain. */
+static unsigned int numa_domain_node(uint32_t domain)
+{
+	for (unsigned int i = 0; i < numa_nodes; i++) {
+		if (numa_domains[i] == domain)
+			return i;
+	}
+
+	if (numa_nodes == NUMA_NODES_MAX) {
+		log(LF_OTHER, LVL_WARN, "Too many NUMA nodes, "
+		    "merging proximity domain %" PRIu32 " into node %u.",
+		    domain, NUMA_NODES_MAX - 1);
+		return NUMA_NODES_MAX - 1;
+	}
+
+	numa_domains[numa_nodes] = domain;
+	return numa_nodes++;
+}
+
+/** Register the node affinity of a physical memory range.
+ *
+ * @param base   Physical address of the range.
+ * @param size   Size of the range in bytes.
+ * @param domain Firmware proximity domain of the range.
+ *
+ */
+void numa_range_add(uint64_t base, uint64_t size, uint32_t domain)
+{
+	pfn_t start = ADDR2PFN(ALIGN_UP(base, FRAME_SIZE));
+	pfn_t end = ADDR2PFN(ALIGN_DOWN(base + size, FRAME_SIZE));
+
+	if (end <= start)
+		return;
+
+	if (numa_range_count == NUMA_RANGES_MAX) {
+		log(LF_OTHER, LVL_WARN, "Too many NUMA memory ranges.");
+		return;
+	}
+
+	size_t i;
+	for (i = 0; i < numa_range_count; i++) {
+		if (overlaps(numa_ranges[i].base, numa_ranges[i].count,
+		    start, end - start)) {
+			log(LF_OTHER, LVL_WARN, "NUMA memory range %p overlaps "
+			    "with a previous range.", (void *) PFN2ADDR(start));
+			return;
+		}
+
+		if (start < numa_ranges[i].base)
+			break;
+	}
+
+	for (size_t j = numa_range_count; j > i; j--)
+		numa_ranges[j] = numa_ranges[j - 1];
+
+	numa_ranges[i].base = start;
+	numa_ranges[i].count = end - start;
+	numa_ranges[i].node = numa_domain_node(domain);
+	numa_range_count++;
+}
+
+/** Register the node affinity of a CPU.
+ *
+ * @param hwid   Hardware identifier of the CPU.
+ * @param domain Firmware proximity domain of the CPU.
+ *
+ */
+void numa_cpu_add(unsigned int hwid, uint32_t domain)
+{
+	if (numa_cpu_count == NUMA_CPUS_MAX) {
+		log(LF_OTHER, LVL_WARN, "Too many NUMA CPU entries.");
+		return;
+	}
+
+	numa_cpus[numa_cpu_count].hwid = hwid;
+	numa_cpus[numa_cpu_count].node = numa_domain_node(domain);
+	numa_cpu_count++;
+}
+
+/** Get the number of NUMA nodes. */
+unsigned int numa_node_count(void)
+{
+	return (numa_nodes > 0) ? numa_nodes : 1;
+}
+
+/** Find the memory range containing a frame. */
+static numa_range_t *numa_range_find(pfn_t pfn)
+{
+	for (size_t i = 0; i < numa_range_count; i++) {
+		if ((pfn >= numa_ranges[i].base) &&
+		    (pfn < numa_ranges[i].base + numa_ranges[i].count))
+			return &numa_ranges[i];
+	}
+
+	return NULL;
+}
+
+/** Get the node of a frame.
+ *
+ * @param pfn Frame number.
+ *
+ * @return Node of the frame, node 0 if the affinity is unknown.
+ *
+ */
+unsigned int numa_pfn_node(pfn_t pfn)
+{
+	numa_range_t *range = numa_range_find(pfn);
+	return (range != NULL) ? range->node : 0;
+}
+
+/** Get the end of the memory range with the same affinity as a frame.
+ *
+ * @param pfn Frame number.
+ *
+ * @return First frame after @a pfn which may have a different affinity,
+ *         or (pfn_t) -1 if there is none.
+ *
+ */
+pfn_t numa_pfn_end(pfn_t pfn)
+{
+	numa_range_t *range = numa_range_find(pfn);
+	if (range != NULL)
+		return range->base + range->count;
+
+	for (size_t i = 0; i < numa_range_count; i++) {
+		if (numa_ranges[i].base > pfn)
+			return numa_ranges[i].base;
+	}
+
+	return (pfn_t) -1;
+}
+
+/** Get the node of a CPU.
+ *
+ * @param hwid Hardware identifier of the CPU.
+ *
+ * @return Node of the CPU, node 0 if the affinity is unknown.
+ *
+ */
+unsigned int numa_cpu_node(unsigned int hwid)
+{
+	for (size_t i = 0; i < numa_cpu_count; i++) {
+		if (numa_cpus[i].hwid == hwid)
+			return numa_cpus[i].node;
+	}
+
+	return 0;
+}
+
+/** Select the node to allocate memory from.
+ *
+ * @param task_policy Apply the memory policy of the current task.
+ * @param strict      Set to true if the memory must not be allocated
+ *                    from any other node.
+ *
+ * @return Preferred node or NUMA_NODE_ANY.
+ *
+ */
+unsigned int numa_node_select(bool task_policy, bool *strict)
+{
+	*strict = false;
+
+	if (numa_node_count() == 1)
+		return NUMA_NODE_ANY;
+
+	if ((task_policy) && (THREAD != NULL)) {
+		switch (TASK->numa_policy) {
+		case NUMA_POLICY_INTERLEAVE:
+			return atomic_fetch_add_explicit(&TASK->numa_next, 1,
+			    memory_order_relaxed) % numa_nodes;
+		case NUMA_POLICY_BIND:
+			*strict = true;
+			return TASK->numa_node;
+		default:
+			break;
+		}
+	}
+
+	return (CPU != NULL) ? CPU->topology.node : NUMA_NODE_ANY;
+}
+
+/** @}
+ */
@@ -109,6 +109,61 @@ _NO_TRACE void page_mapping_insert(as_t *as, uintptr_t page, uintptr_t frame,
 	memory_barrier();
 }
 
+/** Insert mapping of a large page to contiguous frames.
+ *
+ * Map a naturally aligned large virtual page to naturally aligned
+ * physical frames using a single page table entry, if the page
+ * mapping implementation supports large pages.
+ *
+ * @param as    Address space to which page belongs.
+ * @param page  Virtual address of the large page to be mapped.
+ * @param frame Physical address of the first frame to which the mapping
+ *              is done.
+ * @param flags Flags to be used for mapping.
+ *
+ * @return True if the large page has been mapped, false if large pages
+ *         are not supported or the range already contains mappings.
+ *
+ */
+_NO_TRACE bool page_mapping_insert_large(as_t *as, uintptr_t page,
+    uintptr_t frame, unsigned int flags)
+{
+	assert(page_table_locked(as));
+
+	assert(page_mapping_operations);
+	if (!page_mapping_operations->mapping_insert_large)
+		return false;
+
+	bool inserted = page_mapping_operations->mapping_insert_large(as,
+	    page, frame, flags);
+
+	/* Repel prefetched accesses to the old mapping. */
+	memory_barrier();
+
+	return inserted;
+}
+
+/** Split large page mappings into ordinary page mappings.
+ *
+ * Every large page mapping intersecting the range is replaced by
+ * ordinary mappings of the same frames, so that the pages can then be
+ * removed one by one. The split may need to allocate page tables and
+ * must not be done during a TLB shootdown sequence.
+ *
+ * @param as    Address space to which the range belongs.
+ * @param page  First page of the range.
+ * @param count Number of pages in the range.
+ *
+ */
+_NO_TRACE void page_mapping_split(as_t *as, uintptr_t page, size_t count)
+{
+	assert(page_table_locked(as));
+
+	assert(page_mapping_operations);
+	if (page_mapping_operations->mapping_split)
+		page_mapping_operations->mapping_split(as, page, count);
+}
+
 /** Remove mapping of page.
  *
  * Remove any mapping of page within address space as.
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Asynchronous memory reclaim.
+ *
+ * When the reservable memory drops below the low watermark, the kreclaim
+ * thread is woken up. It asks the user space tasks subscribed to
+ * EVENT_TASK_MEM_PRESSURE to drop their caches, returns the pre-zeroed
+ * frames and the per-CPU frame caches to the zones and shrinks the slab
+ * caches until the reservable memory gets above the high watermark.
+ *
+ * Allocations therefore rarely need to reclaim memory themselves. The
+ * direct reclaim in the allocation paths is kept as the last resort.
+ *
+ * If a pass frees nothing, the thread ignores further wakeups for
+ * RECLAIM_BACKOFF, so that it does not spin while the memory stays low.
+ */
+
+#include <mm/reclaim.h>
+#include <mm/reserve.h>
+#include <mm/frame.h>
+#include <mm/slab.h>
+#include <mm/zero.h>
+#include <synch/spinlock.h>
+#include <synch/waitq.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+#include <ipc/event.h>
+#include <macros.h>
+
+IRQ_SPINLOCK_STATIC_INITIALIZE_NAME(reclaim_lock, "reclaim_lock");
+
+/** Start reclaiming below this number of reservable frames. */
+static size_t reclaim_low = 0;
+/** Stop reclaiming above this number of reservable frames. */
+static size_t reclaim_high = 0;
+
+/** Number of times the kreclaim thread has run. */
+static uint64_t reclaim_runs = 0;
+/** Number of frames the kreclaim thread has freed. */
+static uint64_t reclaim_freed = 0;
+
+/** The kreclaim thread is running and can be woken up. */
+static bool reclaim_running = false;
+/** The kreclaim thread has been asked to reclaim memory. */
+static bool reclaim_pending = false;
+static waitq_t reclaim_wq;
+
+/** Initialize the reclaim watermarks.
+ *
+ * @param total Total number of reservable frames.
+ *
+ */
+void reclaim_init(size_t total)
+{
+	reclaim_low = max(total >> RECLAIM_LOW_SHIFT, (size_t) RECLAIM_LOW_MIN);
+	reclaim_high = 2 * reclaim_low;
+}
+
+/** Wake up the kreclaim thread if the memory is low.
+ *
+ * @param avail Number of reservable frames left.
+ *
+ */
+void reclaim_wakeup(ssize_t avail)
+{
+	if (avail >= (ssize_t) reclaim_low)
+		return;
+
+	bool wakeup = false;
+
+	irq_spinlock_lock(&reclaim_lock, true);
+
+	if ((reclaim_running) && (!reclaim_pending)) {
+		reclaim_pending = true;
+		wakeup = true;
+	}
+
+	irq_spinlock_unlock(&reclaim_lock, true);
+
+	if (wakeup)
+		waitq_wakeup(&reclaim_wq, WAKEUP_FIRST);
+}
+
+/** Get the reclaim statistics.
+ *
+ * @param runs  Number of times the kreclaim thread has run.
+ * @param freed Number of frames the kreclaim thread has freed.
+ *
+ */
+void reclaim_stats(uint64_t *runs, uint64_t *freed)
+{
+	irq_spinlock_lock(&reclaim_lock, true);
+
+	*runs = reclaim_runs;
+	*freed = reclaim_freed;
+
+	irq_spinlock_unlock(&reclaim_lock, true);
+}
+
+/** Notify all subscribed tasks about the memory pressure.
+ *
+ * The notification is masked after it has been delivered, so a task
+ * receives no further notifications until it has unmasked the event.
+ *
+ * @param avail Number of reservable frames left.
+ *
+ */
+static void reclaim_notify(ssize_t avail)
+{
+	irq_spinlock_lock(&tasks_lock, true);
+	task_t *task = task_first();
+	if (task != NULL)
+		task_hold(task);
+	irq_spinlock_unlock(&tasks_lock, true);
+
+	while (task != NULL) {
+		(void) event_task_notify_2(task, EVENT_TASK_MEM_PRESSURE, true,
+		    (sysarg_t) max(avail, 0), reclaim_high);
+
+		irq_spinlock_lock(&tasks_lock, true);
+		task_t *next = task_next(task);
+		if (next != NULL)
+			task_hold(next);
+		irq_spinlock_unlock(&tasks_lock, true);
+
+		task_release(task);
+		task = next;
+	}
+}
+
+/** Reclaim memory until the high watermark is reached.
+ *
+ * @return False if there was memory to reclaim but nothing was freed.
+ *
+ */
+static bool reclaim_run(void)
+{
+	if (reserve_available() >= (ssize_t) reclaim_high)
+		return true;
+
+	/*
+	 * The tasks drop their caches asynchronously, so let them know
+	 * first and meanwhile reclaim the kernel memory.
+	 */
+	reclaim_notify(reserve_available());
+
+	size_t freed = zero_pool_drain();
+	freed += frame_cache_trim();
+
+	unsigned int flags = 0;
+	while (reserve_available() < (ssize_t) reclaim_high) {
+		size_t cur = slab_reclaim(flags);
+		if (cur == 0) {
+			if (flags == SLAB_RECLAIM_ALL)
+				break;
+
+			flags = SLAB_RECLAIM_ALL;
+		}
+
+		freed += cur;
+	}
+
+	irq_spinlock_lock(&reclaim_lock, true);
+	reclaim_runs++;
+	reclaim_freed += freed;
+	irq_spinlock_unlock(&reclaim_lock, true);
+
+	return freed > 0;
+}
+
+/** Kernel thread reclaiming memory in the background.
+ *
+ * @param arg Unused.
+ *
+ */
+void kreclaim(void *arg)
+{
+	thread_detach(THREAD);
+
+	waitq_initialize(&reclaim_wq);
+
+	irq_spinlock_lock(&reclaim_lock, true);
+	reclaim_running = true;
+	irq_spinlock_unlock(&reclaim_lock, true);
+
+	while (true) {
+		/*
+		 * Wakeups are ignored until reclaim_pending is cleared, so
+		 * back off while there is nothing left to reclaim.
+		 */
+		if (!reclaim_run())
+			thread_usleep(RECLAIM_BACKOFF);
+
+		irq_spinlock_lock(&reclaim_lock, true);
+		reclaim_pending = false;
+		irq_spinlock_unlock(&reclaim_lock, true);
+
+		waitq_sleep_timeout(&reclaim_wq, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NONE, NULL);
+	}
+}
+
+/** @}
+ */
@@ -39,6 +39,7 @@
 #include <mm/reserve.h>
 #include <mm/frame.h>
 #include <mm/slab.h>
+#include <mm/reclaim.h>
 #include <synch/spinlock.h>
 #include <typedefs.h>
 #include <arch/types.h>
@@ -56,9 +57,24 @@ static ssize_t reserve = 0;
 void reserve_init(void)
 {
 	reserve = frame_total_free_get();
+	reclaim_init(reserve);
 	reserve_initialized = true;
 }
 
+/** Get the number of reservable frames.
+ *
+ * @return Number of frames which can be reserved. The number is negative
+ *         if more memory has been reserved by force than available.
+ */
+ssize_t reserve_available(void)
+{
+	irq_spinlock_lock(&reserve_lock, true);
+	ssize_t avail = reserve;
+	irq_spinlock_unlock(&reserve_lock, true);
+
+	return avail;
+}
+
 /** Try to reserve memory.
  *
  * This function may not be called from contexts that do not allow memory
@@ -100,8 +116,15 @@ bool reserve_try_alloc(size_t size)
 			}
 		}
 	}
+	ssize_t avail = reserve;
 	irq_spinlock_unlock(&reserve_lock, true);
 
+	/*
+	 * Let the kreclaim thread bring the reserve back above the high
+	 * watermark in the background.
+	 */
+	reclaim_wakeup(avail);
+
 	return reserved;
 }
 
@@ -121,7 +144,10 @@ void reserve_force_alloc(size_t size)
 
 	irq_spinlock_lock(&reserve_lock, true);
 	reserve -= size;
+	ssize_t avail = reserve;
 	irq_spinlock_unlock(&reserve_lock, true);
+
+	reclaim_wakeup(avail);
 }
 
 /** Unreserve memory.
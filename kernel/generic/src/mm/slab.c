@@ -45,8 +45,6 @@
  *
  * Following features are not currently supported but would be easy to do:
  * @li cache coloring
- * @li dynamic magazine growing (different magazine sizes are already
- *     supported, but we would need to adjust allocation strategy)
  *
  * The slab allocator supports per-CPU caches ('magazines') to facilitate
  * good SMP scaling.
@@ -66,6 +64,15 @@
  * size boundary. LIFO order is enforced, which should avoid fragmentation
  * as much as possible.
  *
+ * Besides the loaded pair, each CPU keeps a few spare full and empty
+ * magazines, so that exchanging a magazine rarely needs the cpu-shared
+ * magazine list or the magazine caches.
+ *
+ * As in the magazine layer of Bonwick and Adams, the magazine size of
+ * a cache grows when the CPUs keep finding no full magazine in the
+ * cpu-shared list. Larger magazines are then allocated from the magazine
+ * cache of the respective size. A brutal reclaim resets the magazine size.
+ *
  * Every cache contains list of full slabs and list of partially full slabs.
  * Empty slabs are immediately freed (thrashing will be avoided because
  * of magazines).
@@ -84,16 +91,6 @@
  * magazines.
  *
  * @todo
- * For better CPU-scaling the magazine allocation strategy should
- * be extended. Currently, if the cache does not have magazine, it asks
- * for non-cpu cached magazine cache to provide one. It might be feasible
- * to add cpu-cached magazine cache (which would allocate it's magazines
- * from non-cpu-cached mag. cache). This would provide a nice per-cpu
- * buffer. The other possibility is to use the per-cache
- * 'empty-magazine-list', which decreases competing for 1 per-system
- * magazine cache.
- *
- * @todo
  * It might be good to add granularity of locks even to slab level,
  * we could then try_spinlock over all partial slabs and thus improve
  * scalability even on slab level.
@@ -116,12 +113,21 @@
 #include <macros.h>
 #include <cpu.h>
 #include <stdlib.h>
+#include <str.h>
 
 IRQ_SPINLOCK_STATIC_INITIALIZE(slab_cache_lock);
 static LIST_INITIALIZE(slab_cache_list);
 
-/** Magazine cache */
-static slab_cache_t mag_cache;
+/** Magazine caches, one for every magazine size */
+static slab_cache_t mag_cache[SLAB_MAG_SIZES];
+
+static const char *mag_cache_names[SLAB_MAG_SIZES] = {
+	"slab_magazine_4",
+	"slab_magazine_8",
+	"slab_magazine_16",
+	"slab_magazine_32",
+	"slab_magazine_64"
+};
 
 /** Cache for cache descriptors */
 static slab_cache_t slab_cache_cache;
@@ -197,6 +203,7 @@ _NO_TRACE static slab_t *slab_space_alloc(slab_cache_t *cache,
 		*((size_t *) (slab->start + i * cache->size)) = i + 1;
 
 	atomic_inc(&cache->allocated_slabs);
+	atomic_inc(&cache->grow_count);
 	return slab;
 }
 
@@ -326,13 +333,50 @@ _NO_TRACE static void *slab_obj_create(slab_cache_t *cache, unsigned int flags)
  * CPU-Cache slab functions
  */
 
+/** Return magazine cache of magazines of given size
+ *
+ */
+_NO_TRACE static slab_cache_t *mag_cache_of(size_t size)
+{
+	size_t i = fnzb(size / SLAB_MAG_SIZE);
+
+	assert(i < SLAB_MAG_SIZES);
+	assert(size == ((size_t) SLAB_MAG_SIZE << i));
+
+	return &mag_cache[i];
+}
+
+/** Account a request for a full magazine and grow magazines if needed
+ *
+ * Assume the cache maglock is locked.
+ *
+ * @param found True if a full magazine has been found.
+ *
+ */
+_NO_TRACE static void mag_resize_account(slab_cache_t *cache, bool found)
+{
+	if (!found)
+		cache->mag_misses++;
+
+	if (++cache->mag_requests < SLAB_MAG_RESIZE_WINDOW)
+		return;
+
+	if ((cache->mag_misses > SLAB_MAG_RESIZE_WINDOW / 2) &&
+	    (cache->mag_size < SLAB_MAG_SIZE_MAX))
+		cache->mag_size <<= 1;
+
+	cache->mag_requests = 0;
+	cache->mag_misses = 0;
+}
+
 /** Find a full magazine in cache, take it from list and return it
  *
- * @param first If true, return first, else last mag.
+ * @param first  If true, return first, else last mag.
+ * @param resize If true, account the request for magazine resizing.
  *
  */
 _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
-    bool first)
+    bool first, bool resize)
 {
 	slab_magazine_t *mag = NULL;
 	link_t *cur;
@@ -348,6 +392,14 @@ _NO_TRACE static slab_magazine_t *get_mag_from_cache(slab_cache_t *cache,
 		list_remove(&mag->link);
 		atomic_dec(&cache->magazine_counter);
 	}
+
+	if (resize) {
+		if (mag)
+			cache->mag_gets++;
+
+		mag_resize_account(cache, mag != NULL);
+	}
+
 	irq_spinlock_unlock(&cache->maglock, true);
 
 	return mag;
@@ -363,6 +415,7 @@ _NO_TRACE static void put_mag_to_cache(slab_cache_t *cache,
 
 	list_prepend(&mag->link, &cache->magazines);
 	atomic_inc(&cache->magazine_counter);
+	cache->mag_puts++;
 
 	irq_spinlock_unlock(&cache->maglock, true);
 }
@@ -383,42 +436,139 @@ _NO_TRACE static size_t magazine_destroy(slab_cache_t *cache,
 		atomic_dec(&cache->cached_objs);
 	}
 
-	slab_free(&mag_cache, mag);
+	slab_free(mag_cache_of(mag->size), mag);
+
+	return frames;
+}
+
+/** Destroy spare magazines of a CPU
+ *
+ * Assume the CPU cache lock is locked.
+ *
+ * @return Number of freed pages
+ *
+ */
+_NO_TRACE static size_t magazine_destroy_spare(slab_cache_t *cache,
+    slab_mag_cache_t *mcache)
+{
+	size_t frames = 0;
+
+	while (mcache->full_count > 0)
+		frames += magazine_destroy(cache,
+		    mcache->full[--mcache->full_count]);
+
+	while (mcache->empty_count > 0)
+		frames += magazine_destroy(cache,
+		    mcache->empty[--mcache->empty_count]);
 
 	return frames;
 }
 
+/** Keep an empty magazine as a spare of the CPU or free it
+ *
+ * Magazines of a size other than the current magazine size of the cache
+ * are not kept.
+ *
+ */
+_NO_TRACE static void put_empty_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache, slab_magazine_t *mag)
+{
+	assert(mag->busy == 0);
+
+	if ((mag->size == cache->mag_size) &&
+	    (mcache->empty_count < SLAB_MAG_CPU_SPARE))
+		mcache->empty[mcache->empty_count++] = mag;
+	else
+		slab_free(mag_cache_of(mag->size), mag);
+}
+
+/** Get an empty magazine from the spares of the CPU or allocate it
+ *
+ * @return Empty magazine or NULL if no memory
+ *
+ */
+_NO_TRACE static slab_magazine_t *get_empty_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache)
+{
+	size_t size = cache->mag_size;
+
+	while (mcache->empty_count > 0) {
+		slab_magazine_t *mag = mcache->empty[--mcache->empty_count];
+		if (mag->size == size)
+			return mag;
+
+		slab_free(mag_cache_of(mag->size), mag);
+	}
+
+	/*
+	 * We do not want to sleep just because of caching,
+	 * especially we do not want reclaiming to start, as
+	 * this would deadlock.
+	 *
+	 */
+	slab_magazine_t *mag = slab_alloc(mag_cache_of(size),
+	    FRAME_ATOMIC | FRAME_NO_RECLAIM);
+	if (!mag)
+		return NULL;
+
+	mag->size = size;
+	mag->busy = 0;
+
+	return mag;
+}
+
+/** Keep a full magazine as a spare of the CPU or put it to magazine list
+ *
+ */
+_NO_TRACE static void put_full_mag(slab_cache_t *cache,
+    slab_mag_cache_t *mcache, slab_magazine_t *mag)
+{
+	if (mcache->full_count < SLAB_MAG_CPU_SPARE)
+		mcache->full[mcache->full_count++] = mag;
+	else
+		put_mag_to_cache(cache, mag);
+}
+
 /** Find full magazine, set it as current and return it
  *
  */
 _NO_TRACE static slab_magazine_t *get_full_current_mag(slab_cache_t *cache)
 {
-	slab_magazine_t *cmag = cache->mag_cache[CPU->id].current;
-	slab_magazine_t *lastmag = cache->mag_cache[CPU->id].last;
+	slab_mag_cache_t *mcache = &cache->mag_cache[CPU->id];
+	slab_magazine_t *cmag = mcache->current;
+	slab_magazine_t *lastmag = mcache->last;
 
-	assert(irq_spinlock_locked(&cache->mag_cache[CPU->id].lock));
+	assert(irq_spinlock_locked(&mcache->lock));
 
 	if (cmag) { /* First try local CPU magazines */
 		if (cmag->busy)
 			return cmag;
 
 		if ((lastmag) && (lastmag->busy)) {
-			cache->mag_cache[CPU->id].current = lastmag;
-			cache->mag_cache[CPU->id].last = cmag;
+			mcache->current = lastmag;
+			mcache->last = cmag;
 			return lastmag;
 		}
 	}
 
-	/* Local magazines are empty, import one from magazine list */
-	slab_magazine_t *newmag = get_mag_from_cache(cache, 1);
+	/*
+	 * Local magazines are empty, take a spare full magazine
+	 * or import one from magazine list
+	 */
+	slab_magazine_t *newmag;
+	if (mcache->full_count > 0)
+		newmag = mcache->full[--mcache->full_count];
+	else
+		newmag = get_mag_from_cache(cache, true, true);
+
 	if (!newmag)
 		return NULL;
 
 	if (lastmag)
-		magazine_destroy(cache, lastmag);
+		put_empty_mag(cache, mcache, lastmag);
 
-	cache->mag_cache[CPU->id].last = cmag;
-	cache->mag_cache[CPU->id].current = newmag;
+	mcache->last = cmag;
+	mcache->current = newmag;
 
 	return newmag;
 }
@@ -437,10 +587,12 @@ _NO_TRACE static void *magazine_obj_get(slab_cache_t *cache)
 
 	slab_magazine_t *mag = get_full_current_mag(cache);
 	if (!mag) {
+		cache->mag_cache[CPU->id].misses++;
 		irq_spinlock_unlock(&cache->mag_cache[CPU->id].lock, true);
 		return NULL;
 	}
 
+	cache->mag_cache[CPU->id].hits++;
 	void *obj = mag->objs[--mag->busy];
 	irq_spinlock_unlock(&cache->mag_cache[CPU->id].lock, true);
 
@@ -460,45 +612,35 @@ _NO_TRACE static void *magazine_obj_get(slab_cache_t *cache)
  */
 _NO_TRACE static slab_magazine_t *make_empty_current_mag(slab_cache_t *cache)
 {
-	slab_magazine_t *cmag = cache->mag_cache[CPU->id].current;
-	slab_magazine_t *lastmag = cache->mag_cache[CPU->id].last;
+	slab_mag_cache_t *mcache = &cache->mag_cache[CPU->id];
+	slab_magazine_t *cmag = mcache->current;
+	slab_magazine_t *lastmag = mcache->last;
 
-	assert(irq_spinlock_locked(&cache->mag_cache[CPU->id].lock));
+	assert(irq_spinlock_locked(&mcache->lock));
 
 	if (cmag) {
 		if (cmag->busy < cmag->size)
 			return cmag;
 
 		if ((lastmag) && (lastmag->busy < lastmag->size)) {
-			cache->mag_cache[CPU->id].last = cmag;
-			cache->mag_cache[CPU->id].current = lastmag;
+			mcache->last = cmag;
+			mcache->current = lastmag;
 			return lastmag;
 		}
 	}
 
-	/* current | last are full | nonexistent, allocate new */
-
-	/*
-	 * We do not want to sleep just because of caching,
-	 * especially we do not want reclaiming to start, as
-	 * this would deadlock.
-	 *
-	 */
-	slab_magazine_t *newmag = slab_alloc(&mag_cache,
-	    FRAME_ATOMIC | FRAME_NO_RECLAIM);
+	/* current | last are full | nonexistent, get a new one */
+	slab_magazine_t *newmag = get_empty_mag(cache, mcache);
 	if (!newmag)
 		return NULL;
 
-	newmag->size = SLAB_MAG_SIZE;
-	newmag->busy = 0;
-
-	/* Flush last to magazine list */
+	/* Flush last to spares or magazine list */
 	if (lastmag)
-		put_mag_to_cache(cache, lastmag);
+		put_full_mag(cache, mcache, lastmag);
 
 	/* Move current as last, save new as current */
-	cache->mag_cache[CPU->id].last = cmag;
-	cache->mag_cache[CPU->id].current = newmag;
+	mcache->last = cmag;
+	mcache->current = newmag;
 
 	return newmag;
 }
@@ -593,6 +735,9 @@ _NO_TRACE static void _slab_cache_create(slab_cache_t *cache, const char *name,
 	memsetb(cache, sizeof(*cache), 0);
 	cache->name = name;
 
+	pcpu_counter_initialize(&cache->alloc_count);
+	pcpu_counter_initialize(&cache->free_count);
+
 	if (align < sizeof(sysarg_t))
 		align = sizeof(sysarg_t);
 
@@ -606,6 +751,7 @@ _NO_TRACE static void _slab_cache_create(slab_cache_t *cache, const char *name,
 	list_initialize(&cache->full_slabs);
 	list_initialize(&cache->partial_slabs);
 	list_initialize(&cache->magazines);
+	cache->mag_size = SLAB_MAG_SIZE;
 
 	irq_spinlock_initialize(&cache->slablock, "slab.cache.slablock");
 	irq_spinlock_initialize(&cache->maglock, "slab.cache.maglock");
@@ -673,7 +819,8 @@ _NO_TRACE static size_t _slab_reclaim(slab_cache_t *cache, unsigned int flags)
 	slab_magazine_t *mag;
 	size_t frames = 0;
 
-	while ((magcount--) && (mag = get_mag_from_cache(cache, 0))) {
+	while ((magcount--) &&
+	    (mag = get_mag_from_cache(cache, false, false))) {
 		frames += magazine_destroy(cache, mag);
 		if ((!(flags & SLAB_RECLAIM_ALL)) && (frames))
 			break;
@@ -696,10 +843,22 @@ _NO_TRACE static size_t _slab_reclaim(slab_cache_t *cache, unsigned int flags)
 				frames += magazine_destroy(cache, mag);
 			cache->mag_cache[i].last = NULL;
 
+			frames += magazine_destroy_spare(cache,
+			    &cache->mag_cache[i]);
+
 			irq_spinlock_unlock(&cache->mag_cache[i].lock, true);
 		}
+
+		/* Start over with small magazines */
+		irq_spinlock_lock(&cache->maglock, true);
+		cache->mag_size = SLAB_MAG_SIZE;
+		cache->mag_requests = 0;
+		cache->mag_misses = 0;
+		irq_spinlock_unlock(&cache->maglock, true);
 	}
 
+	(void) atomic_fetch_add(&cache->reclaimed_frames, frames);
+
 	return frames;
 }
 
@@ -719,6 +878,7 @@ _NO_TRACE static void _slab_free(slab_cache_t *cache, void *obj, slab_t *slab)
 
 	interrupts_restore(ipl);
 	atomic_dec(&cache->allocated_objs);
+	pcpu_counter_inc(&cache->free_count);
 }
 
 /** Check that there are no slabs and remove cache from system
@@ -753,6 +913,9 @@ void slab_cache_destroy(slab_cache_t *cache)
 		slab_free(&slab_mag_cache, cache->mag_cache);
 	}
 
+	pcpu_counter_destroy(&cache->alloc_count);
+	pcpu_counter_destroy(&cache->free_count);
+
 	slab_free(&slab_cache_cache, cache);
 }
 
@@ -774,8 +937,17 @@ void *slab_alloc(slab_cache_t *cache, unsigned int flags)
 
 	interrupts_restore(ipl);
 
-	if (result)
-		atomic_inc(&cache->allocated_objs);
+	if (result) {
+		size_t objs = atomic_preinc(&cache->allocated_objs);
+		size_t peak = atomic_load(&cache->peak_objs);
+
+		while ((objs > peak) &&
+		    (!atomic_compare_exchange_weak(&cache->peak_objs, &peak,
+		    objs)))
+			;
+
+		pcpu_counter_inc(&cache->alloc_count);
+	}
 
 	return result;
 }
@@ -807,7 +979,7 @@ size_t slab_reclaim(unsigned int flags)
 void slab_print_list(void)
 {
 	printf("[cache name      ] [size  ] [pages ] [obj/pg] [slabs ]"
-	    " [cached] [alloc ] [ctl]\n");
+	    " [cached] [alloc ] [ctl] [mag]\n");
 
 	size_t skip = 0;
 	while (true) {
@@ -860,23 +1032,90 @@ void slab_print_list(void)
 		long cached_objs = atomic_load(&cache->cached_objs);
 		long allocated_objs = atomic_load(&cache->allocated_objs);
 		unsigned int flags = cache->flags;
+		size_t mag_size = cache->mag_size;
 
 		irq_spinlock_unlock(&slab_cache_lock, true);
 
-		printf("%-18s %8zu %8zu %8zu %8ld %8ld %8ld %-5s\n",
+		printf("%-18s %8zu %8zu %8zu %8ld %8ld %8ld %-5s",
 		    name, size, frames, objects, allocated_slabs,
 		    cached_objs, allocated_objs,
 		    flags & SLAB_CACHE_SLINSIDE ? "in" : "out");
+
+		if (flags & SLAB_CACHE_NOMAGAZINE)
+			printf("\n");
+		else
+			printf(" %5zu\n", mag_size);
+	}
+}
+
+/** Get statistics of slab caches
+ *
+ * @param stats Array to fill with the statistics or NULL.
+ * @param max   Number of elements of the array.
+ *
+ * @return Total number of slab caches, which may be more than max.
+ *
+ */
+size_t slab_stats(stats_slab_t *stats, size_t max)
+{
+	size_t count = 0;
+
+	irq_spinlock_lock(&slab_cache_lock, true);
+
+	list_foreach(slab_cache_list, link, slab_cache_t, cache) {
+		if (count >= max) {
+			count++;
+			continue;
+		}
+
+		stats_slab_t *st = &stats[count++];
+
+		str_cpy(st->name, STATS_SLAB_NAME_BUFLEN, cache->name);
+		st->size = cache->size;
+		st->slabs = atomic_load(&cache->allocated_slabs);
+		st->memory = st->slabs * FRAMES2SIZE(cache->frames);
+		st->objs = atomic_load(&cache->allocated_objs);
+		st->cached = atomic_load(&cache->cached_objs);
+		st->peak = atomic_load(&cache->peak_objs);
+		st->allocs = pcpu_counter_sum_positive(&cache->alloc_count);
+		st->frees = pcpu_counter_sum_positive(&cache->free_count);
+		st->grows = atomic_load(&cache->grow_count);
+		st->reclaimed = atomic_load(&cache->reclaimed_frames);
+		st->mag_hits = 0;
+		st->mag_misses = 0;
+
+		irq_spinlock_lock(&cache->maglock, false);
+		st->mag_gets = cache->mag_gets;
+		st->mag_puts = cache->mag_puts;
+		irq_spinlock_unlock(&cache->maglock, false);
+
+		if ((cache->flags & SLAB_CACHE_NOMAGAZINE) ||
+		    (cache->mag_cache == NULL))
+			continue;
+
+		for (size_t i = 0; i < config.cpu_count; i++) {
+			irq_spinlock_lock(&cache->mag_cache[i].lock, false);
+			st->mag_hits += cache->mag_cache[i].hits;
+			st->mag_misses += cache->mag_cache[i].misses;
+			irq_spinlock_unlock(&cache->mag_cache[i].lock, false);
+		}
 	}
+
+	irq_spinlock_unlock(&slab_cache_lock, true);
+
+	return count;
 }
 
 void slab_cache_init(void)
 {
-	/* Initialize magazine cache */
-	_slab_cache_create(&mag_cache, "slab_magazine_t",
-	    sizeof(slab_magazine_t) + SLAB_MAG_SIZE * sizeof(void *),
-	    sizeof(uintptr_t), NULL, NULL, SLAB_CACHE_NOMAGAZINE |
-	    SLAB_CACHE_SLINSIDE);
+	/* Initialize magazine caches */
+	for (size_t i = 0; i < SLAB_MAG_SIZES; i++) {
+		_slab_cache_create(&mag_cache[i], mag_cache_names[i],
+		    sizeof(slab_magazine_t) +
+		    (SLAB_MAG_SIZE << i) * sizeof(void *),
+		    sizeof(uintptr_t), NULL, NULL, SLAB_CACHE_NOMAGAZINE |
+		    SLAB_CACHE_SLINSIDE);
+	}
 
 	/* Initialize slab_cache cache */
 	_slab_cache_create(&slab_cache_cache, "slab_cache_cache",
@@ -35,28 +35,159 @@
  * @brief Generic TLB shootdown algorithm.
  *
  * The algorithm implemented here is based on the CMU TLB shootdown
- * algorithm and is further simplified (e.g. all CPUs receive all TLB
- * shootdown messages).
+ * algorithm and is further simplified (e.g. the shootdown IPI is
+ * broadcast to all CPUs).
+ *
+ * Messages are queued only to the CPUs which may cache translations of
+ * the affected address space and only these CPUs are waited for. Other
+ * CPUs find their message queue empty and return from the IPI handler
+ * without waiting for the shootdown to finish.
+ *
+ * Page ranges can be collected in a tlb_batch_t and shot down in one
+ * sequence. Ranges of user address spaces longer than
+ * TLB_FULL_FLUSH_PAGES are replaced by a flush of the whole address
+ * space.
  */
 
 #include <mm/tlb.h>
 #include <mm/asid.h>
+#include <mm/as.h>
+#include <mm/page.h>
 #include <arch/mm/tlb.h>
 #include <assert.h>
 #include <smp/ipi.h>
 #include <synch/spinlock.h>
 #include <atomic.h>
 #include <arch/interrupt.h>
+#include <arch/cycle.h>
+#include <cpu/cpu_mask.h>
 #include <config.h>
 #include <arch.h>
 #include <panic.h>
 #include <cpu.h>
+#include <mem.h>
+#include <barrier.h>
+
+/** TLB shootdown statistics, protected by tlblock. */
+static stats_tlb_t tlb_stats_data;
 
 void tlb_init(void)
 {
 	tlb_arch_init();
 }
 
+/** Initialize a TLB shootdown batch.
+ *
+ * @param batch Batch to initialize.
+ * @param as    Address space whose pages will be queued.
+ *
+ */
+void tlb_batch_init(tlb_batch_t *batch, as_t *as)
+{
+	batch->cpus = as->cpu_mask;
+	batch->asid = as->asid;
+	batch->pages = 0;
+	batch->count = 0;
+}
+
+/** Replace the contents of a batch by a flush of the whole address space.
+ *
+ * @param batch Batch to widen.
+ *
+ */
+static void tlb_batch_widen(tlb_batch_t *batch)
+{
+	batch->count = 1;
+	batch->msgs[0].type = TLB_INVL_ASID;
+	batch->msgs[0].asid = batch->asid;
+	batch->msgs[0].page = 0;
+	batch->msgs[0].count = 0;
+}
+
+/** Queue a range of pages for invalidation.
+ *
+ * Adjacent ranges are merged. When the batch overflows or grows larger
+ * than TLB_FULL_FLUSH_PAGES, the whole address space is flushed instead.
+ *
+ * @param batch Batch to add to.
+ * @param page  First page of the range.
+ * @param count Number of pages in the range.
+ *
+ */
+void tlb_batch_add(tlb_batch_t *batch, uintptr_t page, size_t count)
+{
+	if (count == 0)
+		return;
+
+	batch->pages += count;
+
+	if ((batch->count == 1) && (batch->msgs[0].type == TLB_INVL_ASID))
+		return;
+
+	if ((batch->asid != ASID_KERNEL) &&
+	    (batch->pages > TLB_FULL_FLUSH_PAGES)) {
+		tlb_batch_widen(batch);
+		return;
+	}
+
+	if (batch->count > 0) {
+		tlb_shootdown_msg_t *last = &batch->msgs[batch->count - 1];
+
+		if (last->page + P2SZ(last->count) == page) {
+			last->count += count;
+			return;
+		}
+	}
+
+	if (batch->count == TLB_BATCH_LEN) {
+		/* Kernel ranges are never widened, so fall back to all. */
+		if (batch->asid == ASID_KERNEL) {
+			batch->count = 1;
+			batch->msgs[0].type = TLB_INVL_ALL;
+			batch->msgs[0].asid = ASID_INVALID;
+			batch->msgs[0].page = 0;
+			batch->msgs[0].count = 0;
+		} else {
+			tlb_batch_widen(batch);
+		}
+
+		return;
+	}
+
+	tlb_shootdown_msg_t *msg = &batch->msgs[batch->count++];
+	msg->type = TLB_INVL_PAGES;
+	msg->asid = batch->asid;
+	msg->page = page;
+	msg->count = count;
+}
+
+/** Invalidate the local TLB entries queued in a batch.
+ *
+ * @param batch Batch of queued ranges.
+ *
+ */
+void tlb_batch_invalidate(tlb_batch_t *batch)
+{
+	for (size_t i = 0; i < batch->count; i++) {
+		tlb_shootdown_msg_t *msg = &batch->msgs[i];
+
+		switch (msg->type) {
+		case TLB_INVL_ALL:
+			tlb_invalidate_all();
+			break;
+		case TLB_INVL_ASID:
+			tlb_invalidate_asid(msg->asid);
+			break;
+		case TLB_INVL_PAGES:
+			tlb_invalidate_pages(msg->asid, msg->page, msg->count);
+			break;
+		default:
+			panic("Unknown type (%d).", msg->type);
+			break;
+		}
+	}
+}
+
 #ifdef CONFIG_SMP
 
 /**
@@ -67,65 +198,146 @@ void tlb_init(void)
  */
 IRQ_SPINLOCK_STATIC_INITIALIZE(tlblock);
 
-/** Send TLB shootdown message.
+/** Enqueue TLB shootdown message to a processor.
  *
- * This function attempts to deliver TLB shootdown message
- * to all other processors.
+ * @param cpu Recipient processor, its lock must be held.
+ * @param msg Message to enqueue.
  *
- * @param type  Type describing scope of shootdown.
- * @param asid  Address space, if required by type.
- * @param page  Virtual page address, if required by type.
- * @param count Number of pages, if required by type.
+ */
+static void tlb_message_enqueue(cpu_t *cpu, tlb_shootdown_msg_t *msg)
+{
+	if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
+		/*
+		 * The message queue is full.
+		 * Erase the queue and store one TLB_INVL_ALL message.
+		 */
+		cpu->tlb_messages_count = 1;
+		cpu->tlb_messages[0].type = TLB_INVL_ALL;
+		cpu->tlb_messages[0].asid = ASID_INVALID;
+		cpu->tlb_messages[0].page = 0;
+		cpu->tlb_messages[0].count = 0;
+	} else if ((cpu->tlb_messages_count != 1) ||
+	    (cpu->tlb_messages[0].type != TLB_INVL_ALL)) {
+		/*
+		 * Enqueue the message.
+		 */
+		cpu->tlb_messages[cpu->tlb_messages_count++] = *msg;
+	}
+}
+
+/** Send TLB shootdown messages.
+ *
+ * @param msgs  Messages to deliver.
+ * @param count Number of messages.
+ * @param mask  Processors to deliver the messages to or NULL for all.
  *
  * @return The interrupt priority level as it existed prior to this call.
  *
  */
-ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
-    uintptr_t page, size_t count)
+static ipl_t tlb_shootdown_send(tlb_shootdown_msg_t *msgs, size_t count,
+    cpu_mask_t *mask)
 {
 	ipl_t ipl = interrupts_disable();
+	uint64_t start = get_cycle();
+
 	CPU->tlb_active = false;
 	irq_spinlock_lock(&tlblock, false);
 
+	DEFINE_CPU_MASK(targets);
+	cpu_mask_none(targets);
+
+	size_t targeted = 0;
 	size_t i;
 	for (i = 0; i < config.cpu_count; i++) {
 		if (i == CPU->id)
 			continue;
 
+		if ((mask != NULL) && (!cpu_mask_is_set(mask, i))) {
+			tlb_stats_data.skipped++;
+			continue;
+		}
+
 		cpu_t *cpu = &cpus[i];
 
 		irq_spinlock_lock(&cpu->lock, false);
-		if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
-			/*
-			 * The message queue is full.
-			 * Erase the queue and store one TLB_INVL_ALL message.
-			 */
-			cpu->tlb_messages_count = 1;
-			cpu->tlb_messages[0].type = TLB_INVL_ALL;
-			cpu->tlb_messages[0].asid = ASID_INVALID;
-			cpu->tlb_messages[0].page = 0;
-			cpu->tlb_messages[0].count = 0;
-		} else {
-			/*
-			 * Enqueue the message.
-			 */
-			size_t idx = cpu->tlb_messages_count++;
-			cpu->tlb_messages[idx].type = type;
-			cpu->tlb_messages[idx].asid = asid;
-			cpu->tlb_messages[idx].page = page;
-			cpu->tlb_messages[idx].count = count;
-		}
+		for (size_t j = 0; j < count; j++)
+			tlb_message_enqueue(cpu, &msgs[j]);
 		irq_spinlock_unlock(&cpu->lock, false);
+
+		cpu_mask_set(targets, i);
+		targeted++;
 	}
 
-	tlb_shootdown_ipi_send();
+	if ((targeted > 0) && (count > 0))
+		tlb_shootdown_ipi_send();
 
 busy_wait:
-	for (i = 0; i < config.cpu_count; i++) {
-		if (cpus[i].tlb_active)
+	cpu_mask_for_each(*targets, id) {
+		if (cpus[id].tlb_active)
 			goto busy_wait;
 	}
 
+	uint64_t cycles = get_cycle() - start;
+
+	tlb_stats_data.shootdowns++;
+	tlb_stats_data.targeted += targeted;
+	tlb_stats_data.cycles += cycles;
+	if (cycles > tlb_stats_data.max_cycles)
+		tlb_stats_data.max_cycles = cycles;
+
+	for (i = 0; i < count; i++) {
+		if (msgs[i].type == TLB_INVL_PAGES)
+			tlb_stats_data.pages += msgs[i].count;
+	}
+
+	return ipl;
+}
+
+/** Send TLB shootdown message.
+ *
+ * This function attempts to deliver TLB shootdown message
+ * to all other processors.
+ *
+ * @param type  Type describing scope of shootdown.
+ * @param asid  Address space, if required by type.
+ * @param page  Virtual page address, if required by type.
+ * @param count Number of pages, if required by type.
+ *
+ * @return The interrupt priority level as it existed prior to this call.
+ *
+ */
+ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
+    uintptr_t page, size_t count)
+{
+	tlb_shootdown_msg_t msg = {
+		.type = type,
+		.asid = asid,
+		.page = page,
+		.count = count
+	};
+
+	return tlb_shootdown_send(&msg, 1, NULL);
+}
+
+/** Send TLB shootdown messages for a batch of page ranges.
+ *
+ * Only the processors which have run the address space of the batch
+ * receive the messages.
+ *
+ * @param batch Batch of queued ranges.
+ *
+ * @return The interrupt priority level as it existed prior to this call.
+ *
+ */
+ipl_t tlb_batch_shootdown_start(tlb_batch_t *batch)
+{
+	ipl_t ipl = tlb_shootdown_send(batch->msgs, batch->count, batch->cpus);
+
+	if ((batch->count == 1) && (batch->msgs[0].type != TLB_INVL_PAGES)) {
+		tlb_stats_data.full_flushes++;
+		tlb_stats_data.pages += batch->pages;
+	}
+
 	return ipl;
 }
 
@@ -141,6 +353,25 @@ void tlb_shootdown_finalize(ipl_t ipl)
 	interrupts_restore(ipl);
 }
 
+/** Wait for a TLB shootdown sequence in progress to finish.
+ *
+ * Called with interrupts disabled by a processor which starts to use an
+ * address space for the first time. The processor will then observe
+ * only the page tables as left by the shootdown sequence.
+ *
+ */
+void tlb_shootdown_sync(void)
+{
+	assert(interrupts_disabled());
+
+	memory_barrier();
+
+	CPU->tlb_active = false;
+	irq_spinlock_lock(&tlblock, false);
+	irq_spinlock_unlock(&tlblock, false);
+	CPU->tlb_active = true;
+}
+
 void tlb_shootdown_ipi_send(void)
 {
 	ipi_broadcast(VECTOR_TLB_SHOOTDOWN_IPI);
@@ -153,6 +384,17 @@ void tlb_shootdown_ipi_recv(void)
 {
 	assert(CPU);
 
+	/*
+	 * Processors which were not sent any message need not wait for
+	 * the sender.
+	 */
+	irq_spinlock_lock(&CPU->lock, false);
+	size_t pending = CPU->tlb_messages_count;
+	irq_spinlock_unlock(&CPU->lock, false);
+
+	if (pending == 0)
+		return;
+
 	CPU->tlb_active = false;
 	irq_spinlock_lock(&tlblock, false);
 	irq_spinlock_unlock(&tlblock, false);
@@ -176,7 +418,11 @@ void tlb_shootdown_ipi_recv(void)
 			break;
 		case TLB_INVL_PAGES:
 			assert(count);
-			tlb_invalidate_pages(asid, page, count);
+			if ((asid != ASID_KERNEL) &&
+			    (count > TLB_FULL_FLUSH_PAGES))
+				tlb_invalidate_asid(asid);
+			else
+				tlb_invalidate_pages(asid, page, count);
 			break;
 		default:
 			panic("Unknown type (%d).", type);
@@ -194,5 +440,21 @@ void tlb_shootdown_ipi_recv(void)
 
 #endif /* CONFIG_SMP */
 
+/** Get TLB shootdown statistics.
+ *
+ * @param[out] stats Statistics.
+ *
+ */
+void tlb_stats(stats_tlb_t *stats)
+{
+#ifdef CONFIG_SMP
+	irq_spinlock_lock(&tlblock, true);
+	*stats = tlb_stats_data;
+	irq_spinlock_unlock(&tlblock, true);
+#else
+	*stats = tlb_stats_data;
+#endif
+}
+
 /** @}
  */
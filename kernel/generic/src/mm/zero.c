@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_generic_mm
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Pool of pre-zeroed frames.
+ *
+ * Anonymous memory and page tables need zeroed frames. Instead of zeroing
+ * them on the critical path of a page fault, the idle-priority kzero
+ * thread keeps a pool of frames zeroed in advance. The pool is drained
+ * back to the frame allocator when physical memory runs low.
+ *
+ * The pool only holds identity-mapped frames, so that it can satisfy
+ * both low and high memory requests.
+ */
+
+#include <mm/zero.h>
+#include <mm/frame.h>
+#include <mm/km.h>
+#include <mm/page.h>
+#include <synch/spinlock.h>
+#include <synch/waitq.h>
+#include <proc/thread.h>
+#include <config.h>
+#include <mem.h>
+
+IRQ_SPINLOCK_STATIC_INITIALIZE_NAME(zero_pool_lock, "zero_pool_lock");
+
+/** Physical addresses of the zeroed frames. */
+static uintptr_t zero_pool[ZERO_POOL_SIZE];
+static size_t zero_pool_count = 0;
+
+/** Allocations served from the pool. */
+static uint64_t zero_pool_hits = 0;
+/** Allocations which had to zero the frame themselves. */
+static uint64_t zero_pool_misses = 0;
+
+/** The kzero thread is running and can be woken up. */
+static bool zero_pool_running = false;
+/** The kzero thread has been asked to refill the pool. */
+static bool zero_pool_refill = false;
+static waitq_t zero_pool_wq;
+
+/** Zero a frame of physical memory.
+ *
+ * @param frame Physical address of the frame.
+ *
+ */
+void frame_zero(uintptr_t frame)
+{
+	if (frame + FRAME_SIZE <= config.identity_size) {
+#ifdef FRAME_ZERO_ARCH
+		FRAME_ZERO_ARCH(PA2KA(frame));
+#else
+		memsetb((void *) PA2KA(frame), FRAME_SIZE, 0);
+#endif
+	} else {
+		uintptr_t page = km_map(frame, FRAME_SIZE, FRAME_SIZE,
+		    PAGE_READ | PAGE_WRITE | PAGE_CACHEABLE);
+		memsetb((void *) page, FRAME_SIZE, 0);
+		km_unmap(page, FRAME_SIZE);
+	}
+}
+
+/** Take a zeroed frame from the pool.
+ *
+ * The frame is not reserved, the caller is responsible for the memory
+ * reservation.
+ *
+ * @return Physical address of a zeroed frame or 0 if the pool is empty.
+ *
+ */
+uintptr_t zero_pool_get(void)
+{
+	uintptr_t frame = 0;
+	bool wakeup = false;
+
+	irq_spinlock_lock(&zero_pool_lock, true);
+
+	if (zero_pool_count > 0) {
+		frame = zero_pool[--zero_pool_count];
+		zero_pool_hits++;
+	} else {
+		zero_pool_misses++;
+	}
+
+	if ((zero_pool_count < ZERO_POOL_LOW) && (zero_pool_running) &&
+	    (!zero_pool_refill)) {
+		zero_pool_refill = true;
+		wakeup = true;
+	}
+
+	irq_spinlock_unlock(&zero_pool_lock, true);
+
+	if (wakeup)
+		waitq_wakeup(&zero_pool_wq, WAKEUP_FIRST);
+
+	return frame;
+}
+
+/** Return all frames in the pool to the frame allocator.
+ *
+ * @return Number of frames freed.
+ *
+ */
+size_t zero_pool_drain(void)
+{
+	size_t freed = 0;
+
+	while (true) {
+		irq_spinlock_lock(&zero_pool_lock, true);
+
+		if (zero_pool_count == 0) {
+			irq_spinlock_unlock(&zero_pool_lock, true);
+			break;
+		}
+
+		uintptr_t frame = zero_pool[--zero_pool_count];
+		irq_spinlock_unlock(&zero_pool_lock, true);
+
+		frame_free_noreserve(frame, 1);
+		freed++;
+	}
+
+	return freed;
+}
+
+/** Get the pool statistics.
+ *
+ * @param count  Number of frames currently in the pool.
+ * @param hits   Allocations served from the pool.
+ * @param misses Allocations which found the pool empty.
+ *
+ */
+void zero_pool_stats(uint64_t *count, uint64_t *hits, uint64_t *misses)
+{
+	irq_spinlock_lock(&zero_pool_lock, true);
+
+	*count = zero_pool_count;
+	*hits = zero_pool_hits;
+	*misses = zero_pool_misses;
+
+	irq_spinlock_unlock(&zero_pool_lock, true);
+}
+
+/** Add a zeroed frame to the pool.
+ *
+ * @return True if the frame was added, false if the pool is full.
+ *
+ */
+static bool zero_pool_put(uintptr_t frame)
+{
+	bool added = false;
+
+	irq_spinlock_lock(&zero_pool_lock, true);
+
+	if (zero_pool_count < ZERO_POOL_SIZE) {
+		zero_pool[zero_pool_count++] = frame;
+		added = true;
+	}
+
+	irq_spinlock_unlock(&zero_pool_lock, true);
+
+	return added;
+}
+
+/** Kernel thread keeping the pool of zeroed frames full.
+ *
+ * The thread runs at idle priority, so frames are zeroed only when the CPU
+ * has nothing better to do.
+ *
+ * @param arg Unused.
+ *
+ */
+void kzero(void *arg)
+{
+	thread_detach(THREAD);
+
+	waitq_initialize(&zero_pool_wq);
+
+	irq_spinlock_lock(&zero_pool_lock, true);
+	zero_pool_running = true;
+	irq_spinlock_unlock(&zero_pool_lock, true);
+
+	while (true) {
+		while (frame_total_free_get() > ZERO_POOL_FREE_MIN) {
+			uintptr_t frame = frame_alloc(1, FRAME_LOWMEM |
+			    FRAME_ATOMIC | FRAME_NO_RECLAIM | FRAME_NO_RESERVE, 0);
+			if (frame == 0)
+				break;
+
+			frame_zero(frame);
+
+			if (!zero_pool_put(frame)) {
+				frame_free_noreserve(frame, 1);
+				break;
+			}
+		}
+
+		irq_spinlock_lock(&zero_pool_lock, true);
+		zero_pool_refill = false;
+		irq_spinlock_unlock(&zero_pool_lock, true);
+
+		waitq_sleep_timeout(&zero_pool_wq, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NONE, NULL);
+	}
+}
+
+/** @}
+ */
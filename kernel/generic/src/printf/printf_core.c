@@ -75,6 +75,12 @@
  */
 #define PRINT_NUMBER_BUFFER_SIZE  (64 + 5)
 
+/** Largest formatted number which is assembled on stack and written at once */
+#define PRINT_FAST_BUFFER_SIZE  128
+
+/** Number of padding characters written by a single output call */
+#define PRINT_PADDING_CHUNK  32
+
 /** Get signed or unsigned integer argument */
 #define PRINTF_GET_INT_ARGUMENT(type, ap, flags) \
 	({ \
@@ -112,6 +118,38 @@ static const char *digits_small = "0123456789abcdef";
 static const char *digits_big = "0123456789ABCDEF";
 static const char invalch = U_SPECIAL;
 
+/** Two-digit decimal numbers 00 to 99, used to convert two digits at a time */
+static const char dec_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** Prints count times character ch. */
+static int print_padding(char ch, int count, printf_spec_t *ps)
+{
+	char buf[PRINT_PADDING_CHUNK];
+	int n = min(count, PRINT_PADDING_CHUNK);
+
+	for (int i = 0; i < n; i++)
+		buf[i] = ch;
+
+	/* Write in chunks rather than one character at a time */
+	for (int left = count; left > 0; left -= n) {
+		n = min(left, PRINT_PADDING_CHUNK);
+		if (ps->str_write(buf, n, ps->data) < 0)
+			return -1;
+	}
+
+	return max(count, 0);
+}
+
 /** Print one or more characters without adding newline.
  *
  * @param buf  Buffer holding characters with size of
@@ -283,23 +321,32 @@ static int print_str(char *str, int width, unsigned int precision,
 	if (str == NULL)
 		return printf_putstr(nullstr, ps);
 
-	/* Print leading spaces. */
+	/* Without a field width there is no need to count the characters. */
+	if (width <= 0) {
+		size_t size = (precision == 0) ? str_size(str) :
+		    str_lsize(str, precision);
+		return printf_putnchars(str, size, ps);
+	}
+
 	size_t strw = str_length(str);
+
+	/* Precision unspecified - print everything. */
 	if ((precision == 0) || (precision > strw))
 		precision = strw;
 
 	/* Left padding */
 	size_t counter = 0;
+	int retval;
 	width -= precision;
-	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (width-- > 0) {
-			if (printf_putchar(' ', ps) == 1)
-				counter++;
-		}
+	if (!(flags & __PRINTF_FLAG_LEFTALIGNED) && (width > 0)) {
+		if ((retval = print_padding(' ', width, ps)) < 0)
+			return -1;
+
+		counter += retval;
+		width = 0;
 	}
 
 	/* Part of @a str fitting into the alloted space. */
-	int retval;
 	size_t size = str_lsize(str, precision);
 	if ((retval = printf_putnchars(str, size, ps)) < 0)
 		return -counter;
@@ -307,9 +354,11 @@ static int print_str(char *str, int width, unsigned int precision,
 	counter += retval;
 
 	/* Right padding */
-	while (width-- > 0) {
-		if (printf_putchar(' ', ps) == 1)
-			counter++;
+	if (width > 0) {
+		if ((retval = print_padding(' ', width, ps)) < 0)
+			return -1;
+
+		counter += retval;
 	}
 
 	return ((int) counter);
@@ -363,6 +412,89 @@ static int print_wstr(char32_t *str, int width, unsigned int precision,
 	return ((int) counter);
 }
 
+/** Convert a number to digits in a given base.
+ *
+ * Decimal numbers are converted two digits at a time and 64-bit division
+ * is only used while the remaining value does not fit in 32 bits. Powers
+ * of two are converted using shifts.
+ *
+ * @param num    Number to convert.
+ * @param base   Base (between 2 and 16).
+ * @param digits Digit characters to use.
+ * @param end    End of the buffer, digits are stored backwards from here.
+ *
+ * @return Pointer to the first (most significant) digit.
+ *
+ */
+static char *print_digits(uint64_t num, unsigned int base, const char *digits,
+    char *end)
+{
+	char *ptr = end;
+	unsigned int r;
+
+	switch (base) {
+	case 10:
+		while (num > UINT32_MAX) {
+			uint64_t q = num / 100;
+			r = num - q * 100;
+			ptr -= 2;
+			ptr[0] = dec_pairs[2 * r];
+			ptr[1] = dec_pairs[2 * r + 1];
+			num = q;
+		}
+
+		uint32_t num32 = num;
+		while (num32 >= 100) {
+			r = num32 % 100;
+			num32 /= 100;
+			ptr -= 2;
+			ptr[0] = dec_pairs[2 * r];
+			ptr[1] = dec_pairs[2 * r + 1];
+		}
+
+		if (num32 >= 10) {
+			ptr -= 2;
+			ptr[0] = dec_pairs[2 * num32];
+			ptr[1] = dec_pairs[2 * num32 + 1];
+		} else {
+			*--ptr = '0' + num32;
+		}
+		break;
+	case 16:
+		do {
+			*--ptr = digits[num & 0xf];
+			num >>= 4;
+		} while (num != 0);
+		break;
+	case 8:
+		do {
+			*--ptr = digits[num & 0x7];
+			num >>= 3;
+		} while (num != 0);
+		break;
+	default:
+		do {
+			*--ptr = digits[num % base];
+			num /= base;
+		} while (num != 0);
+		break;
+	}
+
+	return ptr;
+}
+
+/** Fill memory with a character.
+ *
+ * @return Pointer past the last character written.
+ */
+static char *print_fill(char *ptr, char ch, int count)
+{
+	while (count-- > 0)
+		*ptr++ = ch;
+
+	return ptr;
+}
+
 /** Print a number in a given base.
  *
  * Print significant digits of a number in given base.
@@ -379,6 +511,11 @@ static int print_wstr(char32_t *str, int width, unsigned int precision,
 static int print_number(uint64_t num, int width, int precision, int base,
     uint32_t flags, printf_spec_t *ps)
 {
+	/* Precision not specified. */
+	if (precision < 0) {
+		precision = 0;
+	}
+
 	const char *digits;
 	if (flags & __PRINTF_FLAG_BIGCHARS)
 		digits = digits_big;
@@ -386,46 +523,38 @@ static int print_number(uint64_t num, int width, int precision, int base,
 		digits = digits_small;
 
 	char data[PRINT_NUMBER_BUFFER_SIZE];
-	char *ptr = &data[PRINT_NUMBER_BUFFER_SIZE - 1];
-
-	/* Size of number with all prefixes and signs */
-	int size = 0;
-
-	/* Put zero at end of string */
-	*ptr-- = 0;
-
-	if (num == 0) {
-		*ptr-- = '0';
-		size++;
-	} else {
-		do {
-			*ptr-- = digits[num % base];
-			size++;
-		} while (num /= base);
-	}
+	char *end = &data[PRINT_NUMBER_BUFFER_SIZE];
+	char *ptr = print_digits(num, base, digits, end);
 
 	/* Size of plain number */
-	int number_size = size;
+	int number_size = end - ptr;
+
+	/* Size of number with all prefixes and signs */
+	int size = number_size;
 
 	/*
 	 * Collect the sum of all prefixes/signs/etc. to calculate padding and
 	 * leading zeroes.
 	 */
+	const char *prefix = "";
 	if (flags & __PRINTF_FLAG_PREFIX) {
 		switch (base) {
 		case 2:
 			/* Binary formating is not standard, but usefull */
-			size += 2;
+			prefix = (flags & __PRINTF_FLAG_BIGCHARS) ? "0B" : "0b";
 			break;
 		case 8:
-			size++;
+			prefix = "o";
 			break;
 		case 16:
-			size += 2;
+			prefix = (flags & __PRINTF_FLAG_BIGCHARS) ? "0X" : "0x";
 			break;
 		}
 	}
 
+	int prefix_size = str_size(prefix);
+	size += prefix_size;
+
 	char sgn = 0;
 	if (flags & __PRINTF_FLAG_SIGNED) {
 		if (flags & __PRINTF_FLAG_NEGATIVE) {
@@ -459,73 +588,66 @@ static int print_number(uint64_t num, int width, int precision, int base,
 	}
 
 	width -= precision + size - number_size;
-	size_t counter = 0;
+	if (width < 0)
+		width = 0;
 
-	if (!(flags & __PRINTF_FLAG_LEFTALIGNED)) {
-		while (width-- > 0) {
-			if (printf_putchar(' ', ps) == 1)
-				counter++;
-		}
-	}
+	int lead = (flags & __PRINTF_FLAG_LEFTALIGNED) ? 0 : width;
+	int trail = width - lead;
+	int zeros = precision - number_size;
+	int total = width + precision + size - number_size;
 
-	/* Print sign */
-	if (sgn) {
-		if (printf_putchar(sgn, ps) == 1)
-			counter++;
-	}
+	/*
+	 * Common case: assemble the whole field and write it with a single
+	 * call to the output method.
+	 */
+	if (total <= PRINT_FAST_BUFFER_SIZE) {
+		char out[PRINT_FAST_BUFFER_SIZE];
+		char *op = print_fill(out, ' ', lead);
 
-	/* Print prefix */
-	if (flags & __PRINTF_FLAG_PREFIX) {
-		switch (base) {
-		case 2:
-			/* Binary formating is not standard, but usefull */
-			if (printf_putchar('0', ps) == 1)
-				counter++;
-			if (flags & __PRINTF_FLAG_BIGCHARS) {
-				if (printf_putchar('B', ps) == 1)
-					counter++;
-			} else {
-				if (printf_putchar('b', ps) == 1)
-					counter++;
-			}
-			break;
-		case 8:
-			if (printf_putchar('o', ps) == 1)
-				counter++;
-			break;
-		case 16:
-			if (printf_putchar('0', ps) == 1)
-				counter++;
-			if (flags & __PRINTF_FLAG_BIGCHARS) {
-				if (printf_putchar('X', ps) == 1)
-					counter++;
-			} else {
-				if (printf_putchar('x', ps) == 1)
-					counter++;
-			}
-			break;
-		}
-	}
+		if (sgn)
+			*op++ = sgn;
 
-	/* Print leading zeroes */
-	precision -= number_size;
-	while (precision-- > 0) {
-		if (printf_putchar('0', ps) == 1)
-			counter++;
+		for (int k = 0; k < prefix_size; k++)
+			*op++ = prefix[k];
+
+		op = print_fill(op, '0', zeros);
+		for (int k = 0; k < number_size; k++)
+			*op++ = ptr[k];
+
+		op = print_fill(op, ' ', trail);
+		return ps->str_write(out, op - out, ps->data);
 	}
 
-	/* Print the number itself */
+	/* Very wide fields are printed piecewise */
+	size_t counter = 0;
 	int retval;
-	if ((retval = printf_putstr(++ptr, ps)) > 0)
-		counter += retval;
 
-	/* Print trailing spaces */
+	if ((retval = print_padding(' ', lead, ps)) < 0)
+		return -1;
+	counter += retval;
 
-	while (width-- > 0) {
-		if (printf_putchar(' ', ps) == 1)
-			counter++;
+	if (sgn) {
+		if ((retval = ps->str_write(&sgn, 1, ps->data)) < 0)
+			return -1;
+		counter += retval;
 	}
 
+	if ((retval = printf_putnchars(prefix, prefix_size, ps)) < 0)
+		return -1;
+	counter += retval;
+
+	if ((retval = print_padding('0', zeros, ps)) < 0)
+		return -1;
+	counter += retval;
+
+	if ((retval = printf_putnchars(ptr, number_size, ps)) < 0)
+		return -1;
+	counter += retval;
+
+	if ((retval = print_padding(' ', trail, ps)) < 0)
+		return -1;
+	counter += retval;
+
 	return ((int) counter);
 }
 
@@ -628,60 +750,96 @@ int printf_core(const char *fmt, printf_spec_t *ps, va_list ap)
 	int retval;           /* Return values from nested functions */
 
 	while (true) {
+		/*
+		 * Skip ordinary characters. '%' never occurs within a multi-byte
+		 * UTF-8 sequence, so there is no need to decode them.
+		 */
 		i = nxt;
-		char32_t uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+		while ((fmt[i] != '%') && (fmt[i] != 0))
+			i++;
 
-		if (uc == 0)
+		if (fmt[i] == 0)
 			break;
 
 		/* Control character */
-		if (uc == '%') {
-			/* Print common characters if any processed */
-			if (i > j) {
-				if ((retval = printf_putnchars(&fmt[j], i - j, ps)) < 0) {
-					/* Error */
-					counter = -counter;
-					goto out;
-				}
-				counter += retval;
+		nxt = i + 1;
+		char32_t uc;
+
+		/* Print common characters if any processed */
+		if (i > j) {
+			if ((retval = printf_putnchars(&fmt[j], i - j, ps)) < 0) {
+				/* Error */
+				counter = -counter;
+				goto out;
 			}
+			counter += retval;
+		}
 
-			j = i;
+		j = i;
 
-			/* Parse modifiers */
-			uint32_t flags = 0;
-			bool end = false;
+		/* Parse modifiers */
+		uint32_t flags = 0;
+		bool end = false;
+
+		do {
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			switch (uc) {
+			case '#':
+				flags |= __PRINTF_FLAG_PREFIX;
+				break;
+			case '-':
+				flags |= __PRINTF_FLAG_LEFTALIGNED;
+				break;
+			case '+':
+				flags |= __PRINTF_FLAG_SHOWPLUS;
+				break;
+			case ' ':
+				flags |= __PRINTF_FLAG_SPACESIGN;
+				break;
+			case '0':
+				flags |= __PRINTF_FLAG_ZEROPADDED;
+				break;
+			default:
+				end = true;
+			}
+		} while (!end);
+
+		/* Width & '*' operator */
+		int width = 0;
+		if (isdigit(uc)) {
+			while (true) {
+				width *= 10;
+				width += uc - '0';
 
-			do {
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				switch (uc) {
-				case '#':
-					flags |= __PRINTF_FLAG_PREFIX;
-					break;
-				case '-':
-					flags |= __PRINTF_FLAG_LEFTALIGNED;
-					break;
-				case '+':
-					flags |= __PRINTF_FLAG_SHOWPLUS;
+				if (uc == 0)
 					break;
-				case ' ':
-					flags |= __PRINTF_FLAG_SPACESIGN;
+				if (!isdigit(uc))
 					break;
-				case '0':
-					flags |= __PRINTF_FLAG_ZEROPADDED;
-					break;
-				default:
-					end = true;
-				}
-			} while (!end);
+			}
+		} else if (uc == '*') {
+			/* Get width value from argument list */
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			width = (int) va_arg(ap, int);
+			if (width < 0) {
+				/* Negative width sets '-' flag */
+				width *= -1;
+				flags |= __PRINTF_FLAG_LEFTALIGNED;
+			}
+		}
 
-			/* Width & '*' operator */
-			int width = 0;
+		/* Precision and '*' operator */
+		int precision = 0;
+		if (uc == '.') {
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
 			if (isdigit(uc)) {
 				while (true) {
-					width *= 10;
-					width += uc - '0';
+					precision *= 10;
+					precision += uc - '0';
 
 					i = nxt;
 					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
@@ -691,231 +849,201 @@ int printf_core(const char *fmt, printf_spec_t *ps, va_list ap)
 						break;
 				}
 			} else if (uc == '*') {
-				/* Get width value from argument list */
+				/* Get precision value from the argument list */
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				width = (int) va_arg(ap, int);
-				if (width < 0) {
-					/* Negative width sets '-' flag */
-					width *= -1;
-					flags |= __PRINTF_FLAG_LEFTALIGNED;
-				}
-			}
-
-			/* Precision and '*' operator */
-			int precision = 0;
-			if (uc == '.') {
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				if (isdigit(uc)) {
-					while (true) {
-						precision *= 10;
-						precision += uc - '0';
-
-						i = nxt;
-						uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-						if (uc == 0)
-							break;
-						if (!isdigit(uc))
-							break;
-					}
-				} else if (uc == '*') {
-					/* Get precision value from the argument list */
-					i = nxt;
-					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-					precision = (int) va_arg(ap, int);
-					if (precision < 0) {
-						/* Ignore negative precision */
-						precision = 0;
-					}
+				precision = (int) va_arg(ap, int);
+				if (precision < 0) {
+					/* Ignore negative precision */
+					precision = 0;
 				}
 			}
+		}
 
-			qualifier_t qualifier;
+		qualifier_t qualifier;
 
-			switch (uc) {
-			case 't':
-				/* ptrdiff_t */
-				if (sizeof(ptrdiff_t) == sizeof(int32_t))
-					qualifier = PrintfQualifierInt;
-				else
-					qualifier = PrintfQualifierLongLong;
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				break;
-			case 'h':
-				/* Char or short */
-				qualifier = PrintfQualifierShort;
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				if (uc == 'h') {
-					i = nxt;
-					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-					qualifier = PrintfQualifierByte;
-				}
-				break;
-			case 'l':
-				/* Long or long long */
-				qualifier = PrintfQualifierLong;
-				i = nxt;
-				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				if (uc == 'l') {
-					i = nxt;
-					uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-					qualifier = PrintfQualifierLongLong;
-				}
-				break;
-			case 'z':
-				qualifier = PrintfQualifierSize;
+		switch (uc) {
+		case 't':
+			/* ptrdiff_t */
+			if (sizeof(ptrdiff_t) == sizeof(int32_t))
+				qualifier = PrintfQualifierInt;
+			else
+				qualifier = PrintfQualifierLongLong;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			break;
+		case 'h':
+			/* Char or short */
+			qualifier = PrintfQualifierShort;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			if (uc == 'h') {
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				break;
-			case 'j':
-				qualifier = PrintfQualifierMax;
+				qualifier = PrintfQualifierByte;
+			}
+			break;
+		case 'l':
+			/* Long or long long */
+			qualifier = PrintfQualifierLong;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			if (uc == 'l') {
 				i = nxt;
 				uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
-				break;
-			default:
-				/* Default type */
-				qualifier = PrintfQualifierInt;
+				qualifier = PrintfQualifierLongLong;
 			}
+			break;
+		case 'z':
+			qualifier = PrintfQualifierSize;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			break;
+		case 'j':
+			qualifier = PrintfQualifierMax;
+			i = nxt;
+			uc = str_decode(fmt, &nxt, STR_NO_LIMIT);
+			break;
+		default:
+			/* Default type */
+			qualifier = PrintfQualifierInt;
+		}
 
-			unsigned int base = 10;
-
-			switch (uc) {
-				/*
-				 * String and character conversions.
-				 */
-			case 's':
-				if (qualifier == PrintfQualifierLong)
-					retval = print_wstr(va_arg(ap, char32_t *), width, precision, flags, ps);
-				else
-					retval = print_str(va_arg(ap, char *), width, precision, flags, ps);
-
-				if (retval < 0) {
-					counter = -counter;
-					goto out;
-				}
-
-				counter += retval;
-				j = nxt;
-				continue;
-			case 'c':
-				if (qualifier == PrintfQualifierLong)
-					retval = print_wchar(va_arg(ap, wint_t), width, flags, ps);
-				else
-					retval = print_char(va_arg(ap, unsigned int), width, flags, ps);
-
-				if (retval < 0) {
-					counter = -counter;
-					goto out;
-				}
-
-				counter += retval;
-				j = nxt;
-				continue;
-
-				/*
-				 * Integer values
-				 */
-			case 'P':
-				/* Pointer */
-				flags |= __PRINTF_FLAG_BIGCHARS;
-				/* Fallthrough */
-			case 'p':
-				flags |= __PRINTF_FLAG_PREFIX;
-				flags |= __PRINTF_FLAG_ZEROPADDED;
-				base = 16;
-				qualifier = PrintfQualifierPointer;
-				break;
-			case 'b':
-				base = 2;
-				break;
-			case 'o':
-				base = 8;
-				break;
-			case 'd':
-			case 'i':
-				flags |= __PRINTF_FLAG_SIGNED;
-				/* Fallthrough */
-			case 'u':
-				break;
-			case 'X':
-				flags |= __PRINTF_FLAG_BIGCHARS;
-				/* Fallthrough */
-			case 'x':
-				base = 16;
-				break;
-
-			case '%':
-				/* Percentile itself */
-				j = i;
-				continue;
-
-				/*
-				 * Bad formatting.
-				 */
-			default:
-				/*
-				 * Unknown format. Now, j is the index of '%'
-				 * so we will print whole bad format sequence.
-				 */
-				continue;
-			}
+		unsigned int base = 10;
 
-			/* Print integers */
-			size_t size;
-			uint64_t number;
+		switch (uc) {
+			/*
+			 * String and character conversions.
+			 */
+		case 's':
+			if (qualifier == PrintfQualifierLong)
+				retval = print_wstr(va_arg(ap, char32_t *), width, precision, flags, ps);
+			else
+				retval = print_str(va_arg(ap, char *), width, precision, flags, ps);
 
-			switch (qualifier) {
-			case PrintfQualifierByte:
-				size = sizeof(unsigned char);
-				number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
-				break;
-			case PrintfQualifierShort:
-				size = sizeof(unsigned short);
-				number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
-				break;
-			case PrintfQualifierInt:
-				size = sizeof(unsigned int);
-				number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
-				break;
-			case PrintfQualifierLong:
-				size = sizeof(unsigned long);
-				number = PRINTF_GET_INT_ARGUMENT(long, ap, flags);
-				break;
-			case PrintfQualifierLongLong:
-				size = sizeof(unsigned long long);
-				number = PRINTF_GET_INT_ARGUMENT(long long, ap, flags);
-				break;
-			case PrintfQualifierPointer:
-				size = sizeof(void *);
-				precision = size << 1;
-				number = (uint64_t) (uintptr_t) va_arg(ap, void *);
-				break;
-			case PrintfQualifierSize:
-				size = sizeof(size_t);
-				number = (uint64_t) va_arg(ap, size_t);
-				break;
-			case PrintfQualifierMax:
-				size = sizeof(uintmax_t);
-				number = (uint64_t) va_arg(ap, uintmax_t);
-				break;
-			default:
-				/* Unknown qualifier */
+			if (retval < 0) {
 				counter = -counter;
 				goto out;
 			}
 
-			if ((retval = print_number(number, width, precision,
-			    base, flags, ps)) < 0) {
+			counter += retval;
+			j = nxt;
+			continue;
+		case 'c':
+			if (qualifier == PrintfQualifierLong)
+				retval = print_wchar(va_arg(ap, wint_t), width, flags, ps);
+			else
+				retval = print_char(va_arg(ap, unsigned int), width, flags, ps);
+
+			if (retval < 0) {
 				counter = -counter;
 				goto out;
 			}
 
 			counter += retval;
 			j = nxt;
+			continue;
+
+			/*
+			 * Integer values
+			 */
+		case 'P':
+			/* Pointer */
+			flags |= __PRINTF_FLAG_BIGCHARS;
+			/* Fallthrough */
+		case 'p':
+			flags |= __PRINTF_FLAG_PREFIX;
+			flags |= __PRINTF_FLAG_ZEROPADDED;
+			base = 16;
+			qualifier = PrintfQualifierPointer;
+			break;
+		case 'b':
+			base = 2;
+			break;
+		case 'o':
+			base = 8;
+			break;
+		case 'd':
+		case 'i':
+			flags |= __PRINTF_FLAG_SIGNED;
+			/* Fallthrough */
+		case 'u':
+			break;
+		case 'X':
+			flags |= __PRINTF_FLAG_BIGCHARS;
+			/* Fallthrough */
+		case 'x':
+			base = 16;
+			break;
+
+		case '%':
+			/* Percentile itself */
+			j = i;
+			continue;
+
+			/*
+			 * Bad formatting.
+			 */
+		default:
+			/*
+			 * Unknown format. Now, j is the index of '%'
+			 * so we will print whole bad format sequence.
+			 */
+			continue;
+		}
+
+		/* Print integers */
+		size_t size;
+		uint64_t number;
+
+		switch (qualifier) {
+		case PrintfQualifierByte:
+			size = sizeof(unsigned char);
+			number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
+			break;
+		case PrintfQualifierShort:
+			size = sizeof(unsigned short);
+			number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
+			break;
+		case PrintfQualifierInt:
+			size = sizeof(unsigned int);
+			number = PRINTF_GET_INT_ARGUMENT(int, ap, flags);
+			break;
+		case PrintfQualifierLong:
+			size = sizeof(unsigned long);
+			number = PRINTF_GET_INT_ARGUMENT(long, ap, flags);
+			break;
+		case PrintfQualifierLongLong:
+			size = sizeof(unsigned long long);
+			number = PRINTF_GET_INT_ARGUMENT(long long, ap, flags);
+			break;
+		case PrintfQualifierPointer:
+			size = sizeof(void *);
+			precision = size << 1;
+			number = (uint64_t) (uintptr_t) va_arg(ap, void *);
+			break;
+		case PrintfQualifierSize:
+			size = sizeof(size_t);
+			number = (uint64_t) va_arg(ap, size_t);
+			break;
+		case PrintfQualifierMax:
+			size = sizeof(uintmax_t);
+			number = (uint64_t) va_arg(ap, uintmax_t);
+			break;
+		default:
+			/* Unknown qualifier */
+			counter = -counter;
+			goto out;
 		}
+
+		if ((retval = print_number(number, width, precision,
+		    base, flags, ps)) < 0) {
+			counter = -counter;
+			goto out;
+		}
+
+		counter += retval;
+		j = nxt;
 	}
 
 	if (i > j) {
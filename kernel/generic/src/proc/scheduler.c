@@ -34,12 +34,15 @@
  * @file
  * @brief Scheduler and load balancing.
  *
- * This file contains the scheduler and kcpulb kernel thread which
- * performs load-balancing of per-CPU run queues.
+ * This file contains the scheduler, the idle-time work stealing and
+ * the kcpulb kernel thread which performs periodic load-balancing of
+ * per-CPU run queues.
  */
 
 #include <assert.h>
 #include <atomic.h>
+#include <bitops.h>
+#include <macros.h>
 #include <proc/scheduler.h>
 #include <proc/thread.h>
 #include <proc/task.h>
@@ -53,6 +56,7 @@
 #include <arch/cycle.h>
 #include <atomic.h>
 #include <synch/spinlock.h>
+#include <synch/rcu.h>
 #include <config.h>
 #include <context.h>
 #include <fpu_context.h>
@@ -64,10 +68,28 @@
 #include <stdio.h>
 #include <log.h>
 #include <stacktrace.h>
+#include <ktrace.h>
 
 static void scheduler_separated_stack(void);
 
-atomic_size_t nrdy;  /**< Number of ready threads in the system. */
+#ifdef CONFIG_SMP
+static bool steal_work(void);
+#endif
+
+static_assert(RQ_COUNT <= sizeof(unsigned int) * 8,
+    "Run queue bitmap too small");
+static_assert(RT_PRIO_COUNT <= sizeof(unsigned int) * 8,
+    "Real-time run queue bitmap too small");
+
+/** Time slice of real-time threads of the same priority. */
+#define RT_QUANTUM  (us2ticks(100000))
+
+#ifdef CONFIG_IDLE_POLL
+/** Time for which an idle CPU polls its run queues before sleeping. */
+#define IDLE_POLL_US  20
+#endif
+
+pcpu_counter_t nrdy;  /**< Number of ready threads in the system. */
 
 /** Carry out actions before new task runs. */
 static void before_task_runs(void)
@@ -172,6 +194,145 @@ void scheduler_init(void)
 {
 }
 
+/** Get run queue latency histogram bucket
+ *
+ * @param cycles Number of cycles spent in the run queue.
+ *
+ * @return Index of the log2 microsecond bucket, see STATS_LATENCY_BUCKETS.
+ *
+ */
+static unsigned int rq_latency_bucket(uint64_t cycles)
+{
+	uint64_t us = (CPU->frequency_mhz != 0) ?
+	    cycles / CPU->frequency_mhz : cycles;
+
+	if (us == 0)
+		return 0;
+
+	return min(fnzb64(us) + 1, STATS_LATENCY_BUCKETS - 1);
+}
+
+#ifdef CONFIG_IDLE_POLL
+
+/** Poll the run queues of an idle CPU for a while
+ *
+ * A thread is often readied shortly after the CPU ran out of work,
+ * e.g. when the client of a server on another CPU sends its next
+ * request. Catching it by polling is much faster than sleeping and
+ * being woken up. Interrupts are enabled during the polling.
+ *
+ * @return True if a thread was readied to the CPU.
+ *
+ */
+static bool idle_poll(void)
+{
+	atomic_store(&CPU->idle_state, CPU_IDLE_POLLING);
+	rcu_idle_enter();
+	interrupts_enable();
+
+	uint64_t start = get_cycle();
+	uint64_t limit = (uint64_t) CPU->frequency_mhz * IDLE_POLL_US;
+	bool ready;
+
+	while (!(ready = (atomic_load(&CPU->nrdy) != 0))) {
+		if (get_cycle() - start >= limit)
+			break;
+	}
+
+	interrupts_disable();
+	rcu_idle_exit();
+	atomic_store(&CPU->idle_state, CPU_IDLE_NONE);
+
+	return ready;
+}
+
+#endif /* CONFIG_IDLE_POLL */
+
+/** Sleep until something happens on an idle CPU
+ *
+ * The CPU either monitors its nrdy counter, so that readying a thread
+ * on it wakes it up immediately, or halts until an interrupt comes. In
+ * the latter case, ipi_wakeup() sees the CPU_IDLE_HALTED state and
+ * sends an IPI. The idle state must be published before nrdy is checked
+ * for the last time, ipi_wakeup() reads it after nrdy was updated.
+ *
+ * Interrupts must be disabled, they are disabled again on return.
+ *
+ */
+static void idle_sleep(void)
+{
+	rcu_idle_enter();
+
+#ifdef CONFIG_IDLE_POLL
+	atomic_store(&CPU->idle_state, CPU_IDLE_POLLING);
+	if (idle_monitor_arch(&CPU->nrdy)) {
+		if (atomic_load(&CPU->nrdy) == 0)
+			idle_mwait_arch();
+
+		interrupts_disable();
+		rcu_idle_exit();
+		atomic_store(&CPU->idle_state, CPU_IDLE_NONE);
+		return;
+	}
+#endif
+
+	atomic_store(&CPU->idle_state, CPU_IDLE_HALTED);
+
+	/*
+	 * An interrupt might occur right now and wake up a thread.
+	 * In such case, the CPU will continue to go to sleep
+	 * even though there is a runnable thread.
+	 */
+	if (atomic_load(&CPU->nrdy) == 0) {
+		interrupts_enable();
+		cpu_sleep();
+		interrupts_disable();
+	}
+
+	rcu_idle_exit();
+	atomic_store(&CPU->idle_state, CPU_IDLE_NONE);
+}
+
+#ifdef CONFIG_IPC_HANDOFF
+
+/** Take the thread the CPU was handed over to.
+ *
+ * @return Thread readied by thread_ready_handoff() on this CPU or NULL.
+ *
+ */
+static thread_t *take_handoff_thread(void)
+{
+	thread_t *thread = CPU->handoff;
+	if (!thread)
+		return NULL;
+
+	CPU->handoff = NULL;
+
+	irq_spinlock_lock(&thread->lock, false);
+
+	assert(thread->state == Ready);
+
+	thread->cpu = CPU;
+	thread->ticks = CPU->handoff_ticks ? CPU->handoff_ticks :
+	    us2ticks((thread->priority + 1) * 10000);
+	thread->stolen = false;
+
+	/* The cycle counters of different CPUs need not be in sync */
+	uint64_t now = get_cycle();
+	unsigned int bucket = rq_latency_bucket((now > thread->ready_cycle) ?
+	    now - thread->ready_cycle : 0);
+	thread->rq_latency[bucket]++;
+
+	irq_spinlock_unlock(&thread->lock, false);
+
+	/* CPU-local and interrupts are disabled, no lock needed */
+	CPU->rq_latency[bucket]++;
+
+	return thread;
+}
+
+#endif /* CONFIG_IPC_HANDOFF */
+
 /** Get thread to be scheduled
  *
  * Get the optimal thread to be scheduled
@@ -185,70 +346,128 @@ static thread_t *find_best_thread(void)
 {
 	assert(CPU != NULL);
 
+#ifdef CONFIG_IPC_HANDOFF
+	thread_t *handoff = take_handoff_thread();
+	if (handoff)
+		return handoff;
+#endif
+
 loop:
 
 	if (atomic_load(&CPU->nrdy) == 0) {
+#ifdef CONFIG_SMP
+		/*
+		 * Before going idle, try to pull a thread from the most
+		 * loaded CPU so that it does not wait for kcpulb.
+		 */
+		if (steal_work())
+			goto loop;
+#endif
+
+#ifdef CONFIG_IDLE_POLL
+		if (idle_poll())
+			goto loop;
+#endif
+
 		/*
 		 * For there was nothing to run, the CPU goes to sleep
-		 * until a hardware interrupt or an IPI comes.
-		 * This improves energy saving and hyperthreading.
+		 * until a thread is readied to it or a hardware interrupt
+		 * or an IPI comes. This improves energy saving and
+		 * hyperthreading.
 		 */
 		irq_spinlock_lock(&CPU->lock, false);
 		CPU->idle = true;
 		irq_spinlock_unlock(&CPU->lock, false);
-		interrupts_enable();
+#ifdef CONFIG_TICKLESS
+		clock_tick_stop_idle();
+#endif
+		idle_sleep();
 
-		/*
-		 * An interrupt might occur right now and wake up a thread.
-		 * In such case, the CPU will continue to go to sleep
-		 * even though there is a runnable thread.
-		 */
-		cpu_sleep();
-		interrupts_disable();
+		/* A thread readied to a monitoring CPU raises no interrupt */
+#ifdef CONFIG_TICKLESS
+		clock_tick_restart();
+#endif
+		cpu_idle_end();
 		goto loop;
 	}
 
 	assert(!CPU->idle);
 
+	/*
+	 * Find the highest-priority non-empty queue without touching
+	 * the run queue locks, real-time queues first. The bitmap may
+	 * be stale by the time we lock the queue (the load balancer can
+	 * steal the last thread in the meantime), so re-check the queue
+	 * under its lock.
+	 */
+	unsigned int rt_ready = atomic_load(&CPU->rt_ready);
+	unsigned int ready = atomic_load(&CPU->rq_ready);
+	bool rt = (rt_ready != 0);
+
 	unsigned int i;
-	for (i = 0; i < RQ_COUNT; i++) {
-		irq_spinlock_lock(&(CPU->rq[i].lock), false);
-		if (CPU->rq[i].n == 0) {
-			/*
-			 * If this queue is empty, try a lower-priority queue.
-			 */
-			irq_spinlock_unlock(&(CPU->rq[i].lock), false);
-			continue;
-		}
+	runq_t *rq;
+	rq_bitmap_t *bitmap;
+
+	if (rt) {
+		i = fnzb32(rt_ready);
+		assert(i < RT_PRIO_COUNT);
+		rq = &CPU->rt_rq[i];
+		bitmap = &CPU->rt_ready;
+	} else if (ready != 0) {
+		i = lnzb32(ready);
+		assert(i < RQ_COUNT);
+		rq = &CPU->rq[i];
+		bitmap = &CPU->rq_ready;
+	} else {
+		goto loop;
+	}
 
-		atomic_dec(&CPU->nrdy);
-		atomic_dec(&nrdy);
-		CPU->rq[i].n--;
+	irq_spinlock_lock(&rq->lock, false);
+	if (rq->n == 0) {
+		irq_spinlock_unlock(&rq->lock, false);
+		goto loop;
+	}
 
-		/*
-		 * Take the first thread from the queue.
-		 */
-		thread_t *thread = list_get_instance(
-		    list_first(&CPU->rq[i].rq), thread_t, rq_link);
-		list_remove(&thread->rq_link);
+	atomic_dec(&CPU->nrdy);
+	pcpu_counter_dec(&nrdy);
+	if (--rq->n == 0)
+		rq_bitmap_clear(bitmap, i);
+
+	/*
+	 * Take the first thread from the queue.
+	 */
+	thread_t *thread = list_get_instance(
+	    list_first(&rq->rq), thread_t, rq_link);
+	list_remove(&thread->rq_link);
 
-		irq_spinlock_pass(&(CPU->rq[i].lock), &thread->lock);
+	irq_spinlock_pass(&rq->lock, &thread->lock);
 
-		thread->cpu = CPU;
+	thread->cpu = CPU;
+	if (rt) {
+		thread->ticks = RT_QUANTUM;
+	} else {
 		thread->ticks = us2ticks((i + 1) * 10000);
 		thread->priority = i;  /* Correct rq index */
+	}
 
-		/*
-		 * Clear the stolen flag so that it can be migrated
-		 * when load balancing needs emerge.
-		 */
-		thread->stolen = false;
-		irq_spinlock_unlock(&thread->lock, false);
+	/*
+	 * Clear the stolen flag so that it can be migrated
+	 * when load balancing needs emerge.
+	 */
+	thread->stolen = false;
 
-		return thread;
-	}
+	/* The cycle counters of different CPUs need not be in sync */
+	uint64_t now = get_cycle();
+	unsigned int bucket = rq_latency_bucket((now > thread->ready_cycle) ?
+	    now - thread->ready_cycle : 0);
+	thread->rq_latency[bucket]++;
 
-	goto loop;
+	irq_spinlock_unlock(&thread->lock, false);
+
+	/* CPU-local and interrupts are disabled, no lock needed */
+	CPU->rq_latency[bucket]++;
+
+	return thread;
 }
 
 /** Prevent rq starvation
@@ -278,6 +497,7 @@ static void relink_rq(int start)
 			list_concat(&list, &CPU->rq[i + 1].rq);
 			size_t n = CPU->rq[i + 1].n;
 			CPU->rq[i + 1].n = 0;
+			rq_bitmap_clear(&CPU->rq_ready, i + 1);
 			irq_spinlock_unlock(&CPU->rq[i + 1].lock, false);
 
 			/* Append rq[i + 1] to rq[i] */
@@ -285,6 +505,8 @@ static void relink_rq(int start)
 			irq_spinlock_lock(&CPU->rq[i].lock, false);
 			list_concat(&CPU->rq[i].rq, &list);
 			CPU->rq[i].n += n;
+			if (CPU->rq[i].n > 0)
+				rq_bitmap_set(&CPU->rq_ready, i);
 			irq_spinlock_unlock(&CPU->rq[i].lock, false);
 		}
 
@@ -390,6 +612,9 @@ void scheduler_separated_stack(void)
 	assert(CPU != NULL);
 	assert(interrupts_disabled());
 
+	/* Readers do not sleep, a context switch ends all of them */
+	rcu_qs();
+
 	/*
 	 * Hold the current task and the address space to prevent their
 	 * possible destruction should thread_destroy() be called on this or any
@@ -472,9 +697,12 @@ void scheduler_separated_stack(void)
 
 	irq_spinlock_lock(&THREAD->lock, false);
 	int priority = THREAD->priority;
+	bool rt = thread_rt_active(THREAD);
 	irq_spinlock_unlock(&THREAD->lock, false);
 
-	relink_rq(priority);
+	/* Real-time threads do not take part in starvation prevention */
+	if (!rt)
+		relink_rq(priority);
 
 	/*
 	 * If both the old and the new task are the same,
@@ -508,6 +736,8 @@ void scheduler_separated_stack(void)
 	irq_spinlock_lock(&THREAD->lock, false);
 	THREAD->state = Running;
 
+	ktrace(KTRACE_SCHED, THREAD->tid, TASK->taskid, THREAD->priority);
+
 #ifdef SCHEDULER_VERBOSE
 	log(LF_OTHER, LVL_DEBUG,
 	    "cpu%u: tid %" PRIu64 " (priority=%d, ticks=%" PRIu64
@@ -537,11 +767,153 @@ void scheduler_separated_stack(void)
 }
 
 #ifdef CONFIG_SMP
+/** Steal a thread from a run queue of another CPU
+ *
+ * Search the run queue from the back and remove the first thread
+ * which is allowed to migrate to the local CPU. CPU-wired threads,
+ * threads already stolen, threads for which migration was temporarily
+ * disabled, threads whose FPU context is still in the CPU and threads
+ * whose affinity excludes the local CPU are skipped.
+ *
+ * Interrupts must be disabled.
+ *
+ * @param cpu CPU to steal from.
+ * @param rq  Index of the run queue to steal from.
+ *
+ * @return Stolen thread, marked as stolen and in the Entering state,
+ *         or NULL if there is no suitable thread in the queue.
+ *
+ */
+static thread_t *steal_thread(cpu_t *cpu, int rq)
+{
+	assert(interrupts_disabled());
+
+	irq_spinlock_lock(&(cpu->rq[rq].lock), false);
+	if (cpu->rq[rq].n == 0) {
+		irq_spinlock_unlock(&(cpu->rq[rq].lock), false);
+		return NULL;
+	}
+
+	thread_t *thread = NULL;
+
+	/* Search rq from the back */
+	link_t *link = list_last(&cpu->rq[rq].rq);
+
+	while (link != NULL) {
+		thread = (thread_t *) list_get_instance(link, thread_t, rq_link);
+
+		irq_spinlock_lock(&thread->lock, false);
+
+		if ((!thread->wired) && (!thread->stolen) &&
+		    (!thread->nomigrate) && (!thread->fpu_context_engaged) &&
+		    (thread_may_run_on(thread, CPU))) {
+			/*
+			 * Remove thread from ready queue.
+			 */
+			irq_spinlock_unlock(&thread->lock, false);
+
+			atomic_dec(&cpu->nrdy);
+			pcpu_counter_dec(&nrdy);
+
+			if (--cpu->rq[rq].n == 0)
+				rq_bitmap_clear(&cpu->rq_ready, rq);
+			list_remove(&thread->rq_link);
+
+			break;
+		}
+
+		irq_spinlock_unlock(&thread->lock, false);
+
+		link = list_prev(link, &cpu->rq[rq].rq);
+		thread = NULL;
+	}
+
+	if (thread == NULL) {
+		irq_spinlock_unlock(&(cpu->rq[rq].lock), false);
+		return NULL;
+	}
+
+	irq_spinlock_pass(&(cpu->rq[rq].lock), &thread->lock);
+
+	thread->stolen = true;
+	thread->state = Entering;
+
+	irq_spinlock_unlock(&thread->lock, false);
+
+	return thread;
+}
+
+/** Steal work for an idle CPU
+ *
+ * Called by find_best_thread() when the local run queues are
+ * empty. Pick the CPU with the most ready threads and move one
+ * of its lowest-priority migratable threads to the local CPU.
+ *
+ * Interrupts must be disabled.
+ *
+ * @return True if a thread was made ready on the local CPU.
+ *
+ */
+static bool steal_work(void)
+{
+	assert(interrupts_disabled());
+
+	if (config.cpu_active < 2)
+		return false;
+
+	cpu_t *victim = NULL;
+	size_t victim_rdy = 0;
+
+	for (size_t acpu = 0; acpu < config.cpu_active; acpu++) {
+		cpu_t *cpu = &cpus[acpu];
+		if (cpu == CPU)
+			continue;
+
+		size_t rdy = atomic_load(&cpu->nrdy);
+		if (rdy > victim_rdy) {
+			victim = cpu;
+			victim_rdy = rdy;
+		}
+	}
+
+	if (victim == NULL)
+		return false;
+
+	/* Searching least priority queues first */
+	for (int rq = RQ_COUNT - 1; rq >= 0; rq--) {
+		thread_t *thread = steal_thread(victim, rq);
+		if (thread == NULL)
+			continue;
+
+#ifdef KCPULB_VERBOSE
+		log(LF_OTHER, LVL_DEBUG,
+		    "cpu%u: stole TID %" PRIu64 " from cpu%u, nrdy=%zu",
+		    CPU->id, thread->tid, victim->id,
+		    atomic_load(&victim->nrdy));
+#endif
+
+		thread_ready(thread);
+
+		irq_spinlock_lock(&CPU->lock, false);
+		CPU->steal_count++;
+		irq_spinlock_unlock(&CPU->lock, false);
+
+		return true;
+	}
+
+	return false;
+}
+
 /** Load balancing thread
  *
  * SMP load balancing thread, supervising thread supplies
  * for the CPU it's wired to.
  *
+ * Most of the balancing is done by idle CPUs stealing work in
+ * find_best_thread(). This thread is only a fallback which
+ * evens out CPUs which are busy but have shorter queues than
+ * others.
+ *
  * @param arg Generic thread argument (unused).
  *
  */
@@ -568,7 +940,7 @@ not_satisfied:
 	 * passes. Each time get the most up to date counts.
 	 *
 	 */
-	average = atomic_load(&nrdy) / config.cpu_active + 1;
+	average = pcpu_counter_sum_positive(&nrdy) / config.cpu_active + 1;
 	rdy = atomic_load(&CPU->nrdy);
 
 	if (average <= rdy)
@@ -600,75 +972,31 @@ not_satisfied:
 			if (atomic_load(&cpu->nrdy) <= average)
 				continue;
 
-			irq_spinlock_lock(&(cpu->rq[rq].lock), true);
-			if (cpu->rq[rq].n == 0) {
-				irq_spinlock_unlock(&(cpu->rq[rq].lock), true);
-				continue;
-			}
-
-			thread_t *thread = NULL;
-
-			/* Search rq from the back */
-			link_t *link = list_last(&cpu->rq[rq].rq);
-
-			while (link != NULL) {
-				thread = (thread_t *) list_get_instance(link,
-				    thread_t, rq_link);
-
-				/*
-				 * Do not steal CPU-wired threads, threads
-				 * already stolen, threads for which migration
-				 * was temporarily disabled or threads whose
-				 * FPU context is still in the CPU.
-				 */
-				irq_spinlock_lock(&thread->lock, false);
-
-				if ((!thread->wired) && (!thread->stolen) &&
-				    (!thread->nomigrate) &&
-				    (!thread->fpu_context_engaged)) {
-					/*
-					 * Remove thread from ready queue.
-					 */
-					irq_spinlock_unlock(&thread->lock,
-					    false);
-
-					atomic_dec(&cpu->nrdy);
-					atomic_dec(&nrdy);
-
-					cpu->rq[rq].n--;
-					list_remove(&thread->rq_link);
-
-					break;
-				}
-
-				irq_spinlock_unlock(&thread->lock, false);
-
-				link = list_prev(link, &cpu->rq[rq].rq);
-				thread = NULL;
-			}
+			ipl_t ipl = interrupts_disable();
+			thread_t *thread = steal_thread(cpu, rq);
+			interrupts_restore(ipl);
 
 			if (thread) {
 				/*
 				 * Ready thread on local CPU
 				 */
 
-				irq_spinlock_pass(&(cpu->rq[rq].lock),
-				    &thread->lock);
-
 #ifdef KCPULB_VERBOSE
 				log(LF_OTHER, LVL_DEBUG,
 				    "kcpulb%u: TID %" PRIu64 " -> cpu%u, "
-				    "nrdy=%ld, avg=%ld", CPU->id, thread->tid,
-				    CPU->id, atomic_load(&CPU->nrdy),
-				    atomic_load(&nrdy) / config.cpu_active);
+				    "nrdy=%zu, avg=%" PRId64, CPU->id,
+				    thread->tid, CPU->id,
+				    atomic_load(&CPU->nrdy),
+				    pcpu_counter_sum(&nrdy) /
+				    config.cpu_active);
 #endif
 
-				thread->stolen = true;
-				thread->state = Entering;
-
-				irq_spinlock_unlock(&thread->lock, true);
 				thread_ready(thread);
 
+				irq_spinlock_lock(&CPU->lock, true);
+				CPU->balance_count++;
+				irq_spinlock_unlock(&CPU->lock, true);
+
 				if (--count == 0)
 					goto satisfied;
 
@@ -678,11 +1006,7 @@ not_satisfied:
 				 *
 				 */
 				acpu_bias++;
-
-				continue;
-			} else
-				irq_spinlock_unlock(&(cpu->rq[rq].lock), true);
-
+			}
 		}
 	}
 
@@ -720,11 +1044,31 @@ void sched_print_list(void)
 
 		irq_spinlock_lock(&cpus[cpu].lock, true);
 
-		printf("cpu%u: address=%p, nrdy=%zu, needs_relink=%zu\n",
-		    cpus[cpu].id, &cpus[cpu], atomic_load(&cpus[cpu].nrdy),
-		    cpus[cpu].needs_relink);
+		printf("cpu%u: address=%p, nrdy=%zu, needs_relink=%zu, "
+		    "rq_ready=%#x, rt_ready=%#x\n", cpus[cpu].id, &cpus[cpu],
+		    atomic_load(&cpus[cpu].nrdy), cpus[cpu].needs_relink,
+		    atomic_load(&cpus[cpu].rq_ready),
+		    atomic_load(&cpus[cpu].rt_ready));
 
 		unsigned int i;
+		for (i = RT_PRIO_COUNT; i-- > 0;) {
+			irq_spinlock_lock(&(cpus[cpu].rt_rq[i].lock), false);
+			if (cpus[cpu].rt_rq[i].n == 0) {
+				irq_spinlock_unlock(&(cpus[cpu].rt_rq[i].lock), false);
+				continue;
+			}
+
+			printf("\trt_rq[%u]: ", i);
+			list_foreach(cpus[cpu].rt_rq[i].rq, rq_link, thread_t,
+			    thread) {
+				printf("%" PRIu64 "(%s) ", thread->tid,
+				    thread_states[thread->state]);
+			}
+			printf("\n");
+
+			irq_spinlock_unlock(&(cpus[cpu].rt_rq[i].lock), false);
+		}
+
 		for (i = 0; i < RQ_COUNT; i++) {
 			irq_spinlock_lock(&(cpus[cpu].rq[i].lock), false);
 			if (cpus[cpu].rq[i].n == 0) {
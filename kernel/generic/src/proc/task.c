@@ -41,6 +41,7 @@
 #include <proc/task.h>
 #include <mm/as.h>
 #include <mm/slab.h>
+#include <mm/numa.h>
 #include <atomic.h>
 #include <synch/spinlock.h>
 #include <synch/waitq.h>
@@ -49,6 +50,7 @@
 #include <adt/list.h>
 #include <adt/odict.h>
 #include <cap/cap.h>
+#include <ddi/msi.h>
 #include <ipc/ipc.h>
 #include <ipc/ipcrsc.h>
 #include <ipc/event.h>
@@ -56,8 +58,11 @@
 #include <errno.h>
 #include <halt.h>
 #include <str.h>
+#include <mem.h>
 #include <syscall/copy.h>
 #include <macros.h>
+#include <member.h>
+#include <sysinfo/stats.h>
 
 /** Spinlock protecting the @c tasks ordered dictionary. */
 IRQ_SPINLOCK_INITIALIZE(tasks_lock);
@@ -77,6 +82,18 @@ IRQ_SPINLOCK_INITIALIZE(tasks_lock);
  */
 odict_t tasks;
 
+/** Number of chains of the RCU task ID hash. */
+#define TASKS_HASH_SIZE  256
+
+/** Task ID hash for lookups without tasks_lock.
+ *
+ * Readers traverse the chains in RCU read-side sections, see
+ * task_get_by_id(). Writers hold tasks_lock. Task structures are
+ * reclaimed only after a grace period.
+ *
+ */
+static task_t *tasks_hash[TASKS_HASH_SIZE];
+
 static task_id_t task_counter = 0;
 
 static slab_cache_t *task_cache;
@@ -210,6 +227,11 @@ task_t *task_create(as_t *as, const char *name)
 	task->perms = 0;
 	task->ucycles = 0;
 	task->kcycles = 0;
+	memset(task->rq_latency, 0, sizeof(task->rq_latency));
+	stats_touch(&task->stats_gen);
+	task->numa_policy = NUMA_POLICY_LOCAL;
+	task->numa_node = 0;
+	atomic_store(&task->numa_next, 0);
 
 	caps_task_init(task);
 
@@ -219,6 +241,8 @@ task_t *task_create(as_t *as, const char *name)
 	task->ipc_info.answer_received = 0;
 	task->ipc_info.irq_notif_received = 0;
 	task->ipc_info.forwarded = 0;
+	task->ipc_info.data_copied = 0;
+	task->ipc_info.data_pinned = 0;
 
 	event_task_init(task);
 
@@ -255,11 +279,21 @@ task_t *task_create(as_t *as, const char *name)
 	odlink_initialize(&task->ltasks);
 	odict_insert(&task->ltasks, &tasks, NULL);
 
+	task_t **chain = &tasks_hash[task->taskid % TASKS_HASH_SIZE];
+	task->hash_next = *chain;
+	rcu_assign_pointer(*chain, task);
+
 	irq_spinlock_unlock(&tasks_lock, true);
 
 	return task;
 }
 
+/** Free a task structure once no lockless lookup can see it. */
+static void task_free_rcu(rcu_item_t *item)
+{
+	slab_free(task_cache, member_to_inst(item, task_t, rcu));
+}
+
 /** Destroy task.
  *
  * @param task Task to be destroyed.
@@ -268,12 +302,23 @@ task_t *task_create(as_t *as, const char *name)
 void task_destroy(task_t *task)
 {
 	/*
-	 * Remove the task from the task odict.
+	 * Remove the task from the task odict and the task ID hash.
 	 */
 	irq_spinlock_lock(&tasks_lock, true);
 	odict_remove(&task->ltasks);
+
+	task_t **pprev = &tasks_hash[task->taskid % TASKS_HASH_SIZE];
+	while (*pprev != task)
+		pprev = &(*pprev)->hash_next;
+	rcu_assign_pointer(*pprev, task->hash_next);
+
 	irq_spinlock_unlock(&tasks_lock, true);
 
+	/*
+	 * Release message signalled interrupts the task did not free.
+	 */
+	msi_release(task->taskid);
+
 	/*
 	 * Perform architecture specific task destruction.
 	 */
@@ -284,7 +329,8 @@ void task_destroy(task_t *task)
 	 */
 	as_release(task->as);
 
-	slab_free(task_cache, task);
+	/* Lockless lookups may still be looking at the structure */
+	rcu_call(&task->rcu, task_free_rcu);
 }
 
 /** Hold a reference to a task.
@@ -388,6 +434,7 @@ sys_errno_t sys_task_set_name(const uspace_ptr_char uspace_name, size_t name_len
 
 	/* Set task name */
 	str_cpy(TASK->name, TASK_NAME_BUFLEN, namebuf);
+	stats_touch(&TASK->stats_gen);
 
 	irq_spinlock_unlock(&threads_lock, false);
 	irq_spinlock_unlock(&TASK->lock, false);
@@ -396,6 +443,34 @@ sys_errno_t sys_task_set_name(const uspace_ptr_char uspace_name, size_t name_len
 	return EOK;
 }
 
+/** Syscall for setting the NUMA memory placement policy of the task.
+ *
+ * The policy governs on which node the frames backing the user pages of
+ * the task are allocated. Kernel allocations are not affected.
+ *
+ * @param policy Placement policy (numa_policy_t).
+ * @param node   Node to bind to if @a policy is NUMA_POLICY_BIND,
+ *               ignored otherwise.
+ *
+ * @return 0 on success or an error code from @ref errno.h.
+ *
+ */
+sys_errno_t sys_task_set_numa(sysarg_t policy, sysarg_t node)
+{
+	if (policy >= NUMA_POLICY_COUNT)
+		return EINVAL;
+
+	if ((policy == NUMA_POLICY_BIND) && (node >= numa_node_count()))
+		return EINVAL;
+
+	irq_spinlock_lock(&TASK->lock, true);
+	TASK->numa_policy = (numa_policy_t) policy;
+	TASK->numa_node = (policy == NUMA_POLICY_BIND) ? node : 0;
+	irq_spinlock_unlock(&TASK->lock, true);
+
+	return EOK;
+}
+
 /** Syscall to forcefully terminate a task
  *
  * @param uspace_taskid Pointer to task ID in user space.
@@ -435,6 +510,47 @@ task_t *task_find_by_id(task_id_t id)
 	return NULL;
 }
 
+/** Hold a reference to a task unless its last reference is gone. */
+static bool task_try_hold(task_t *task)
+{
+	size_t refs = atomic_load(&task->refcount);
+
+	while (refs != 0) {
+		if (atomic_compare_exchange_weak(&task->refcount, &refs,
+		    refs + 1))
+			return true;
+	}
+
+	return false;
+}
+
+/** Find task by ID and hold a reference to it.
+ *
+ * Unlike task_find_by_id(), this function does not need tasks_lock.
+ * Tasks which are being destroyed are not returned.
+ *
+ * @param id Task ID.
+ *
+ * @return Held task, to be released by task_release(), or NULL if there
+ *         is no such task.
+ *
+ */
+task_t *task_get_by_id(task_id_t id)
+{
+	rcu_read_lock();
+
+	task_t *task = rcu_dereference(tasks_hash[id % TASKS_HASH_SIZE]);
+	while ((task != NULL) && (task->taskid != id))
+		task = rcu_dereference(task->hash_next);
+
+	if ((task != NULL) && (!task_try_hold(task)))
+		task = NULL;
+
+	rcu_read_unlock();
+
+	return task;
+}
+
 /** Get count of tasks.
  *
  * @return Number of tasks in the system
@@ -525,6 +641,38 @@ void task_get_accounting(task_t *task, uint64_t *ucycles, uint64_t *kcycles)
 	*kcycles = kret;
 }
 
+/** Get run queue latency histogram of a task
+ *
+ * Sum the histograms of all threads of the task with the
+ * histograms of its already finished threads. The task lock
+ * must be already held and interrupts must be already disabled.
+ *
+ * @param task       Pointer to the task.
+ * @param rq_latency Array of STATS_LATENCY_BUCKETS buckets to fill.
+ *
+ */
+void task_get_rq_latency(task_t *task, uint64_t *rq_latency)
+{
+	assert(interrupts_disabled());
+	assert(irq_spinlock_locked(&task->lock));
+
+	/* Accumulated values of task */
+	for (unsigned int i = 0; i < STATS_LATENCY_BUCKETS; i++)
+		rq_latency[i] = task->rq_latency[i];
+
+	/* Current values of threads */
+	list_foreach(task->threads, th_link, thread_t, thread) {
+		irq_spinlock_lock(&thread->lock, false);
+
+		if (!thread->uncounted) {
+			for (unsigned int i = 0; i < STATS_LATENCY_BUCKETS; i++)
+				rq_latency[i] += thread->rq_latency[i];
+		}
+
+		irq_spinlock_unlock(&thread->lock, false);
+	}
+}
+
 static void task_kill_internal(task_t *task)
 {
 	irq_spinlock_lock(&task->lock, false);
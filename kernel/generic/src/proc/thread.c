@@ -48,7 +48,9 @@
 #include <synch/spinlock.h>
 #include <synch/waitq.h>
 #include <synch/syswaitq.h>
+#include <ipc/ring.h>
 #include <cpu.h>
+#include <cpu/cpu_mask.h>
 #include <str.h>
 #include <context.h>
 #include <adt/list.h>
@@ -68,6 +70,8 @@
 #include <syscall/copy.h>
 #include <errno.h>
 #include <debug.h>
+#include <sysinfo/stats.h>
+#include <security/perm.h>
 
 /** Thread states */
 const char *thread_states[] = {
@@ -101,6 +105,14 @@ static thread_id_t last_tid = 0;
 
 static slab_cache_t *thread_cache;
 
+/** CPU utilization available to real-time threads, per mille of each CPU. */
+#define RT_UTIL_MAX  800
+
+/** Lock protecting rt_util_total. */
+IRQ_SPINLOCK_STATIC_INITIALIZE(rt_lock);
+/** CPU utilization reserved by all real-time threads, in per mille. */
+static size_t rt_util_total = 0;
+
 #ifdef CONFIG_FPU
 slab_cache_t *fpu_context_cache;
 #endif
@@ -137,9 +149,15 @@ static void cushion(void)
 		uint64_t kcycles = THREAD->kcycles;
 		THREAD->kcycles = 0;
 
+		uint64_t rq_latency[STATS_LATENCY_BUCKETS];
+		memcpy(rq_latency, THREAD->rq_latency, sizeof(rq_latency));
+		memset(THREAD->rq_latency, 0, sizeof(THREAD->rq_latency));
+
 		irq_spinlock_pass(&THREAD->lock, &TASK->lock);
 		TASK->ucycles += ucycles;
 		TASK->kcycles += kcycles;
+		for (unsigned int i = 0; i < STATS_LATENCY_BUCKETS; i++)
+			TASK->rq_latency[i] += rq_latency[i];
 		irq_spinlock_unlock(&TASK->lock, true);
 	} else
 		irq_spinlock_unlock(&THREAD->lock, true);
@@ -241,7 +259,7 @@ void thread_init(void)
 {
 	THREAD = NULL;
 
-	atomic_store(&nrdy, 0);
+	pcpu_counter_initialize(&nrdy);
 	thread_cache = slab_cache_create("thread_t", sizeof(thread_t), 0,
 	    thr_constructor, thr_destructor, 0);
 
@@ -272,6 +290,213 @@ static void before_thread_is_ready(thread_t *thread)
 	assert(irq_spinlock_locked(&thread->lock));
 }
 
+/** Check whether a CPU is idle and without any ready threads. */
+static bool cpu_is_idle(cpu_t *cpu)
+{
+	return (cpu->active) && (cpu->idle) && (atomic_load(&cpu->nrdy) == 0);
+}
+
+/** Check whether the thread's CPU affinity allows it to run on a CPU.
+ *
+ * @param thread Thread to check.
+ * @param cpu    CPU to check.
+ *
+ * @return True if the thread may be readied on the CPU.
+ *
+ */
+bool thread_may_run_on(thread_t *thread, cpu_t *cpu)
+{
+	if (thread->cpu_mask == NULL)
+		return true;
+
+	return cpu_mask_is_set(thread->cpu_mask, cpu->id);
+}
+
+/** Choose the CPU on which to ready a migratable thread.
+ *
+ * The preferred CPU is kept if it is idle. Otherwise, an idle SMT
+ * sibling of the preferred CPU is used, then an idle CPU sharing the
+ * last-level cache, so that the cache footprint of the thread is
+ * retained while it does not have to wait behind other threads.
+ * If there is no such CPU, the preferred CPU is used unless the
+ * thread's affinity forbids it.
+ *
+ * @param thread    Thread to be readied (locked).
+ * @param preferred CPU on which the thread ran last, or the local CPU.
+ *
+ * @return CPU to ready the thread on.
+ *
+ */
+static cpu_t *thread_select_cpu(thread_t *thread, cpu_t *preferred)
+{
+	assert(irq_spinlock_locked(&thread->lock));
+
+	bool allowed = thread_may_run_on(thread, preferred);
+	if ((allowed) && (cpu_is_idle(preferred)))
+		return preferred;
+
+#ifdef CONFIG_SMP
+	cpu_t *llc_idle = NULL;
+	cpu_t *any_allowed = NULL;
+
+	for (size_t i = 0; i < config.cpu_active; i++) {
+		cpu_t *cpu = &cpus[i];
+		if ((cpu == preferred) || (!thread_may_run_on(thread, cpu)))
+			continue;
+
+		if (any_allowed == NULL)
+			any_allowed = cpu;
+
+		if (!cpu_is_idle(cpu))
+			continue;
+
+		if (cpu_same_core(cpu, preferred))
+			return cpu;
+
+		if ((llc_idle == NULL) && (cpu_same_llc(cpu, preferred)))
+			llc_idle = cpu;
+	}
+
+	if (llc_idle != NULL)
+		return llc_idle;
+
+	if ((!allowed) && (any_allowed != NULL))
+		return any_allowed;
+#endif
+
+	return preferred;
+}
+
+/** Start a new real-time period if the current one has elapsed
+ *
+ * The period is measured in clock ticks of the current CPU. The tick
+ * counters of different CPUs need not be in sync, a migrated thread
+ * whose period seems to start in the future starts a new one.
+ *
+ * @param thread Thread with its lock held.
+ *
+ */
+static void thread_rt_replenish(thread_t *thread)
+{
+	if ((thread->rt_priority < 0) || (thread->rt_budget == 0))
+		return;
+
+	uint64_t now = CPU->timeout_now;
+	if ((now < thread->rt_period_start) ||
+	    (now - thread->rt_period_start >= thread->rt_period)) {
+		thread->rt_period_start = now;
+		thread->rt_used = 0;
+		thread->rt_throttled = false;
+	}
+}
+
+/** Charge a running real-time thread for clock ticks
+ *
+ * A thread which exhausts its budget is throttled, i.e. it is scheduled
+ * as an ordinary time-shared thread until its next period starts.
+ *
+ * @param thread Running thread with its lock held.
+ * @param ticks  Number of clock ticks the thread ran for.
+ *
+ * @return True if the thread changed its scheduling class and needs
+ *         to be preempted to be queued accordingly.
+ *
+ */
+bool thread_rt_tick(thread_t *thread, uint64_t ticks)
+{
+	if ((thread->rt_priority < 0) || (thread->rt_budget == 0))
+		return false;
+
+	if (thread->rt_throttled) {
+		thread_rt_replenish(thread);
+		return !thread->rt_throttled;
+	}
+
+	thread->rt_used += ticks;
+	if (thread->rt_used < thread->rt_budget)
+		return false;
+
+	thread->rt_throttled = true;
+	return true;
+}
+
+/** Move the current thread to or from the real-time scheduling class
+ *
+ * A real-time thread always runs before any time-shared thread on
+ * its CPU and is preempted only by real-time threads of a higher
+ * priority. Threads of the same real-time priority are scheduled
+ * round-robin. If a budget is set, the thread can run for at most
+ * budget microseconds out of each period, otherwise it reserves the
+ * whole CPU. The reservations of all real-time threads must not exceed
+ * RT_UTIL_MAX per mille of each active CPU.
+ *
+ * The new class is used since the next time the thread is readied.
+ *
+ * @param priority Real-time priority from 0 to RT_PRIO_COUNT - 1, higher
+ *                 values are more urgent. A negative value moves the
+ *                 thread back to the time-sharing class.
+ * @param budget   Budget per period in microseconds, zero for unlimited.
+ * @param period   Replenishment period in microseconds.
+ *
+ * The budget and the period are accounted in timer ticks. A budget which
+ * is smaller than the period, but not by at least one tick, is rejected,
+ * as it could not be enforced.
+ *
+ * @return EOK on success, EINVAL if the parameters are out of range,
+ *         EBUSY if the reservation would exceed the available capacity.
+ *
+ */
+errno_t thread_set_rt(int priority, uint64_t budget, uint64_t period)
+{
+	unsigned int util = 0;
+	uint64_t budget_ticks = 0;
+	uint64_t period_ticks = 0;
+
+	if (priority >= RT_PRIO_COUNT)
+		return EINVAL;
+
+	if (priority >= 0) {
+		if (budget == 0) {
+			util = 1000;
+		} else {
+			if ((period == 0) || (budget > period) ||
+			    (period > UINT32_MAX))
+				return EINVAL;
+
+			util = (budget * 1000 + period - 1) / period;
+			budget_ticks = max(us2ticks(budget), 1);
+			period_ticks = max(us2ticks(period), 1);
+
+			if ((budget < period) && (budget_ticks >= period_ticks))
+				return EINVAL;
+		}
+	}
+
+	/* Only the thread itself changes its reservation */
+	irq_spinlock_lock(&rt_lock, true);
+
+	size_t total = rt_util_total - THREAD->rt_util + util;
+	if (total > RT_UTIL_MAX * config.cpu_active) {
+		irq_spinlock_unlock(&rt_lock, true);
+		return EBUSY;
+	}
+
+	rt_util_total = total;
+	irq_spinlock_unlock(&rt_lock, true);
+
+	irq_spinlock_lock(&THREAD->lock, true);
+	THREAD->rt_priority = (priority >= 0) ? priority : -1;
+	THREAD->rt_budget = budget_ticks;
+	THREAD->rt_period = period_ticks;
+	THREAD->rt_used = 0;
+	THREAD->rt_period_start = CPU->timeout_now;
+	THREAD->rt_throttled = false;
+	THREAD->rt_util = util;
+	irq_spinlock_unlock(&THREAD->lock, true);
+
+	return EOK;
+}
+
 /** Make thread ready
  *
  * Switch thread to the ready state.
@@ -287,8 +512,17 @@ void thread_ready(thread_t *thread)
 
 	before_thread_is_ready(thread);
 
-	int i = (thread->priority < RQ_COUNT - 1) ?
-	    ++thread->priority : thread->priority;
+	thread_rt_replenish(thread);
+
+	bool rt = thread_rt_active(thread);
+	int i;
+	if (rt)
+		i = thread->rt_priority;
+	else if (thread->idle)
+		i = thread->priority = RQ_COUNT - 1;
+	else
+		i = (thread->priority < RQ_COUNT - 1) ?
+		    ++thread->priority : thread->priority;
 
 	cpu_t *cpu;
 	if (thread->wired || thread->nomigrate || thread->fpu_context_engaged) {
@@ -300,29 +534,97 @@ void thread_ready(thread_t *thread)
 		cpu = CPU;
 	} else if (thread->cpu) {
 		/* Prefer the CPU on which the thread ran last */
-		assert(thread->cpu != NULL);
-		cpu = thread->cpu;
+		cpu = thread_select_cpu(thread, thread->cpu);
 	} else {
-		cpu = CPU;
+		cpu = thread_select_cpu(thread, CPU);
 	}
 
 	thread->state = Ready;
+	stats_touch(&thread->stats_gen);
+
+	/* A migrated thread keeps waiting since it was first readied */
+	if (!thread->stolen)
+		thread->ready_cycle = get_cycle();
 
-	irq_spinlock_pass(&thread->lock, &(cpu->rq[i].lock));
+	runq_t *rq = rt ? &cpu->rt_rq[i] : &cpu->rq[i];
+	rq_bitmap_t *ready = rt ? &cpu->rt_ready : &cpu->rq_ready;
+
+	irq_spinlock_pass(&thread->lock, &rq->lock);
 
 	/*
 	 * Append thread to respective ready queue
 	 * on respective processor.
 	 */
 
-	list_append(&thread->rq_link, &cpu->rq[i].rq);
-	cpu->rq[i].n++;
-	irq_spinlock_unlock(&(cpu->rq[i].lock), true);
+	list_append(&thread->rq_link, &rq->rq);
+	if (rq->n++ == 0)
+		rq_bitmap_set(ready, i);
+	irq_spinlock_unlock(&rq->lock, true);
 
-	atomic_inc(&nrdy);
+	pcpu_counter_inc(&nrdy);
 	atomic_inc(&cpu->nrdy);
+
+	ipi_wakeup(cpu);
 }
 
+#ifdef CONFIG_IPC_HANDOFF
+
+/** Make thread ready and hand it the current CPU
+ *
+ * The thread is not put into any run queue. The scheduler of the current
+ * CPU runs it before any other ready thread and gives it the rest of the
+ * time slice of the current thread, which is left with a single tick. That
+ * way a thread which blocks right after waking the receiver of its message
+ * switches directly to it, while one which keeps running does not delay
+ * the receiver by more than a tick.
+ *
+ * Interrupts must be disabled.
+ *
+ * @param thread Thread to make ready.
+ *
+ * @return True if the thread was handed the CPU, false if it has to be
+ *         readied by thread_ready() instead.
+ *
+ */
+bool thread_ready_handoff(thread_t *thread)
+{
+	assert(interrupts_disabled());
+
+	if ((!THREAD) || (CPU->handoff) || (THREAD->rt_priority >= 0))
+		return false;
+
+	irq_spinlock_lock(&thread->lock, false);
+
+	assert(thread->state != Ready);
+
+	bool pinned = (thread->wired) || (thread->nomigrate) ||
+	    (thread->fpu_context_engaged);
+	if ((thread->rt_priority >= 0) || (thread->idle) ||
+	    (!thread_may_run_on(thread, CPU)) ||
+	    ((pinned) && (thread->cpu != CPU))) {
+		irq_spinlock_unlock(&thread->lock, false);
+		return false;
+	}
+
+	before_thread_is_ready(thread);
+
+	thread->state = Ready;
+	thread->ready_cycle = get_cycle();
+
+	irq_spinlock_unlock(&thread->lock, false);
+
+	irq_spinlock_lock(&THREAD->lock, false);
+	CPU->handoff = thread;
+	CPU->handoff_ticks = (THREAD->ticks > 1) ? THREAD->ticks - 1 : 0;
+	if (THREAD->ticks > 1)
+		THREAD->ticks = 1;
+	irq_spinlock_unlock(&THREAD->lock, false);
+
+	return true;
+}
+
+#endif /* CONFIG_IPC_HANDOFF */
+
 /** Create new thread
  *
  * Create a new thread.
@@ -374,10 +676,22 @@ thread_t *thread_create(void (*func)(void *), void *arg, task_t *task,
 	thread->ticks = -1;
 	thread->ucycles = 0;
 	thread->kcycles = 0;
+	thread->ready_cycle = 0;
+	memset(thread->rq_latency, 0, sizeof(thread->rq_latency));
+	stats_touch(&thread->stats_gen);
 	thread->uncounted =
 	    ((flags & THREAD_FLAG_UNCOUNTED) == THREAD_FLAG_UNCOUNTED);
+	thread->idle = ((flags & THREAD_FLAG_IDLE) == THREAD_FLAG_IDLE);
 	thread->priority = -1;          /* Start in rq[0] */
+	thread->rt_priority = -1;
+	thread->rt_budget = 0;
+	thread->rt_period = 0;
+	thread->rt_used = 0;
+	thread->rt_period_start = 0;
+	thread->rt_throttled = false;
+	thread->rt_util = 0;
 	thread->cpu = NULL;
+	thread->cpu_mask = NULL;
 	thread->wired = false;
 	thread->stolen = false;
 	thread->uspace =
@@ -455,6 +769,8 @@ void thread_destroy(thread_t *thread, bool irq_res)
 	 * Drop the reference to the containing task.
 	 */
 	task_release(thread->task);
+	if (thread->cpu_mask != NULL)
+		free(thread->cpu_mask);
 	slab_free(thread_cache, thread);
 }
 
@@ -522,10 +838,14 @@ void thread_exit(void)
 			 */
 			ipc_cleanup();
 			sys_waitq_task_cleanup();
+			ipc_ring_task_cleanup();
 			LOG("Cleanup of task %" PRIu64 " completed.", TASK->taskid);
 		}
 	}
 
+	/* Release the real-time reservation */
+	(void) thread_set_rt(-1, 0, 0);
+
 restart:
 	irq_spinlock_lock(&THREAD->lock, true);
 	if (THREAD->timeout_pending) {
@@ -843,6 +1163,9 @@ void thread_update_accounting(bool user)
 		THREAD->kcycles += time - THREAD->last_cycle;
 
 	THREAD->last_cycle = time;
+
+	stats_touch(&THREAD->stats_gen);
+	stats_touch(&THREAD->task->stats_gen);
 }
 
 /** Find thread structure corresponding to thread ID.
@@ -1113,5 +1436,122 @@ sys_errno_t sys_thread_udelay(uint32_t usec)
 	return 0;
 }
 
+/** Syscall for restricting the CPUs the current thread may run on.
+ *
+ * The mask is an array of unsigned int words in the cpu_mask_t format,
+ * bit i standing for the CPU with ID i. Bits beyond the number of CPUs
+ * are ignored. If the thread currently runs on a CPU which is not in
+ * the mask, it is migrated before the syscall returns.
+ *
+ * @param uspace_mask Userspace address of the CPU mask.
+ * @param size        Size of the CPU mask in bytes.
+ *
+ * @return EOK on success, EINVAL if the mask does not contain any
+ *         active CPU or an error code from copy_from_uspace().
+ *
+ */
+sys_errno_t sys_thread_set_affinity(uspace_addr_t uspace_mask, size_t size)
+{
+	size_t mask_size = cpu_mask_size();
+	cpu_mask_t *mask = malloc(mask_size);
+	if (mask == NULL)
+		return (sys_errno_t) ENOMEM;
+
+	cpu_mask_none(mask);
+	errno_t rc = copy_from_uspace(mask, uspace_mask,
+	    min(size, mask_size));
+	if (rc != EOK) {
+		free(mask);
+		return (sys_errno_t) rc;
+	}
+
+	bool any_active = false;
+	cpu_mask_for_each(*mask, cpu_id) {
+		if (cpus[cpu_id].active) {
+			any_active = true;
+			break;
+		}
+	}
+
+	if (!any_active) {
+		free(mask);
+		return (sys_errno_t) EINVAL;
+	}
+
+	irq_spinlock_lock(&THREAD->lock, true);
+	cpu_mask_t *old_mask = THREAD->cpu_mask;
+	THREAD->cpu_mask = mask;
+	bool migrate = !cpu_mask_is_set(mask, CPU->id);
+	irq_spinlock_unlock(&THREAD->lock, true);
+
+	if (old_mask != NULL)
+		free(old_mask);
+
+	/* Let thread_ready() find an allowed CPU. */
+	if (migrate)
+		scheduler();
+
+	return (sys_errno_t) EOK;
+}
+
+/** Syscall for reading the CPUs the current thread may run on.
+ *
+ * If the thread is not restricted, all active CPUs are reported.
+ *
+ * @param uspace_mask Userspace address of the buffer for the CPU mask.
+ * @param size        Size of the buffer in bytes.
+ *
+ * @return EOK on success or an error code from copy_to_uspace().
+ *
+ */
+sys_errno_t sys_thread_get_affinity(uspace_addr_t uspace_mask, size_t size)
+{
+	size_t mask_size = cpu_mask_size();
+	cpu_mask_t *mask = malloc(mask_size);
+	if (mask == NULL)
+		return (sys_errno_t) ENOMEM;
+
+	irq_spinlock_lock(&THREAD->lock, true);
+	if (THREAD->cpu_mask != NULL)
+		memcpy(mask, THREAD->cpu_mask, mask_size);
+	else
+		cpu_mask_active(mask);
+	irq_spinlock_unlock(&THREAD->lock, true);
+
+	errno_t rc = copy_to_uspace(uspace_mask, mask, min(size, mask_size));
+	free(mask);
+
+	return (sys_errno_t) rc;
+}
+
+/** Syscall for moving the current thread to or from the real-time class.
+ *
+ * See thread_set_rt(). The current thread is rescheduled so that
+ * the change takes effect immediately.
+ *
+ * @param priority Real-time priority or -1 for the time-sharing class.
+ * @param budget   Budget per period in microseconds, zero for unlimited.
+ * @param period   Replenishment period in microseconds.
+ *
+ * Moving the thread to the real-time class requires PERM_RT_SCHED.
+ *
+ * @return EOK on success, EPERM if the task lacks PERM_RT_SCHED or an
+ *         error code from thread_set_rt().
+ *
+ */
+sys_errno_t sys_thread_set_rt(sysarg_t priority, sysarg_t budget,
+    sysarg_t period)
+{
+	if (((native_t) priority >= 0) &&
+	    (!(perm_get(TASK) & PERM_RT_SCHED)))
+		return (sys_errno_t) EPERM;
+
+	errno_t rc = thread_set_rt((int) (native_t) priority, budget, period);
+	if (rc == EOK)
+		scheduler();
+
+	return (sys_errno_t) rc;
+}
+
 /** @}
  */
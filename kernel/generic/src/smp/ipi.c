@@ -39,6 +39,9 @@
 
 #include <smp/ipi.h>
 #include <config.h>
+#include <cpu.h>
+#include <arch.h>
+#include <arch/asm.h>
 
 /** Broadcast IPI message
  *
@@ -59,6 +62,42 @@ void ipi_broadcast(int ipi)
 		ipi_broadcast_arch(ipi);
 }
 
+/** Make a CPU notice a thread readied to its run queue
+ *
+ * An idle CPU which polls or monitors its nrdy counter notices the new
+ * thread by itself, the update of the counter is enough to wake it up.
+ * IPIs are only sent to CPUs which are really halted or which run with
+ * a stopped clock tick. Without either of these, a remote CPU notices
+ * the new thread on its next clock tick.
+ *
+ * Must be called after the nrdy counter of the CPU was updated.
+ *
+ * @param cpu CPU to which a thread was readied.
+ *
+ */
+void ipi_wakeup(cpu_t *cpu)
+{
+#if (defined CONFIG_TICKLESS) || (defined CONFIG_IDLE_POLL)
+	ipl_t ipl = interrupts_disable();
+
+	if (cpu != CPU) {
+		bool kick = (atomic_load(&cpu->idle_state) == CPU_IDLE_HALTED);
+#ifdef CONFIG_TICKLESS
+		if ((atomic_load(&cpu->idle_state) == CPU_IDLE_NONE) &&
+		    (atomic_load(&cpu->tickless)))
+			kick = true;
+#endif
+
+		if (kick)
+			ipi_wakeup_arch(cpu);
+	}
+
+	interrupts_restore(ipl);
+#else
+	(void) cpu;
+#endif
+}
+
 #endif /* CONFIG_SMP */
 
 /** @}
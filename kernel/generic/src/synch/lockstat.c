@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Lock contention statistics.
+ *
+ * Every spinlock and mutex is assigned a lock class when it is first
+ * used. Spinlocks with the same name and mutexes initialized at the
+ * same code location share a class. The classes live in a fixed-size
+ * table, since the statistics are updated from within the locking
+ * primitives themselves and so cannot depend on the memory allocator
+ * or on other locks.
+ */
+
+#ifdef CONFIG_LOCKSTAT
+
+#include <synch/lockstat.h>
+#include <arch/asm.h>
+#include <gsort.h>
+#include <macros.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <symtab.h>
+
+/** Hash table of lock classes (open addressing). */
+static lockstat_t classes[LOCKSTAT_CLASSES];
+
+/** Class for all locks which do not fit into the table. */
+static lockstat_t overflow = {
+	.guard = ATOMIC_FLAG_INIT,
+	.name = "<overflow>"
+};
+
+/** Serializes insertions into the table. */
+static atomic_flag classes_guard = ATOMIC_FLAG_INIT;
+
+static ipl_t guard_lock(atomic_flag *guard)
+{
+	ipl_t ipl = interrupts_disable();
+
+	while (atomic_flag_test_and_set_explicit(guard, memory_order_acquire))
+		;
+
+	return ipl;
+}
+
+static void guard_unlock(atomic_flag *guard, ipl_t ipl)
+{
+	atomic_flag_clear_explicit(guard, memory_order_release);
+	interrupts_restore(ipl);
+}
+
+static size_t hash_name(const char *name)
+{
+	size_t hash = 0;
+
+	while (*name != 0)
+		hash = hash * 31 + (unsigned char) *name++;
+
+	return hash;
+}
+
+static bool class_matches(lockstat_t *stat, const char *name, uintptr_t site)
+{
+	if (name != NULL)
+		return ((stat->name != NULL) && (str_cmp(stat->name, name) == 0));
+
+	return ((stat->name == NULL) && (stat->site == site));
+}
+
+/** Find or create a lock class
+ *
+ * @param name Spinlock name, NULL for mutexes.
+ * @param site Mutex initialization site.
+ *
+ * @return Lock class.
+ *
+ */
+static lockstat_t *class_get(const char *name, uintptr_t site)
+{
+	size_t start = ((name != NULL) ? hash_name(name) : (site >> 2)) %
+	    LOCKSTAT_CLASSES;
+	lockstat_t *stat = &overflow;
+
+	ipl_t ipl = guard_lock(&classes_guard);
+
+	for (size_t i = 0; i < LOCKSTAT_CLASSES; i++) {
+		lockstat_t *cur = &classes[(start + i) % LOCKSTAT_CLASSES];
+
+		if ((cur->name == NULL) && (cur->site == 0)) {
+			/* Free slot, the class does not exist yet */
+			atomic_flag_clear_explicit(&cur->guard,
+			    memory_order_relaxed);
+			cur->name = name;
+			cur->site = site;
+			stat = cur;
+			break;
+		}
+
+		if (class_matches(cur, name, site)) {
+			stat = cur;
+			break;
+		}
+	}
+
+	guard_unlock(&classes_guard, ipl);
+	return stat;
+}
+
+/** Get the lock class of a spinlock
+ *
+ * @param name Spinlock name.
+ *
+ * @return Lock class.
+ *
+ */
+lockstat_t *lockstat_spinlock_class(const char *name)
+{
+	return class_get((name != NULL) ? name : "<unnamed>", 0);
+}
+
+/** Get the lock class of a mutex
+ *
+ * @param site Return address of the mutex_initialize() call.
+ *
+ * @return Lock class.
+ *
+ */
+lockstat_t *lockstat_mutex_class(uintptr_t site)
+{
+	return class_get(NULL, site);
+}
+
+/** Account a lock acquisition
+ *
+ * @param stat      Lock class.
+ * @param contended Whether the lock had to be waited for.
+ * @param wait      Number of cycles spent waiting.
+ *
+ */
+void lockstat_acquired(lockstat_t *stat, bool contended, uint64_t wait)
+{
+	ipl_t ipl = guard_lock(&stat->guard);
+
+	stat->acquired++;
+	if (contended) {
+		stat->contended++;
+		stat->wait_cycles += wait;
+	}
+
+	guard_unlock(&stat->guard, ipl);
+}
+
+/** Account a lock release
+ *
+ * @param stat Lock class.
+ * @param hold Number of cycles the lock was held.
+ *
+ */
+void lockstat_released(lockstat_t *stat, uint64_t hold)
+{
+	ipl_t ipl = guard_lock(&stat->guard);
+
+	if (hold > stat->max_hold_cycles)
+		stat->max_hold_cycles = hold;
+
+	guard_unlock(&stat->guard, ipl);
+}
+
+/** Account how a contended mutex was acquired
+ *
+ * @param stat  Lock class.
+ * @param slept True if the waiter had to sleep, false if
+ *              it acquired the mutex by spinning.
+ *
+ */
+void lockstat_mutex_waited(lockstat_t *stat, bool slept)
+{
+	ipl_t ipl = guard_lock(&stat->guard);
+
+	if (slept)
+		stat->slept++;
+	else
+		stat->spun++;
+
+	guard_unlock(&stat->guard, ipl);
+}
+
+/** Format the name of a lock class
+ *
+ * @param stat Lock class.
+ * @param buf  Output buffer.
+ * @param size Size of the output buffer.
+ *
+ */
+void lockstat_class_name(lockstat_t *stat, char *buf, size_t size)
+{
+	if (stat->name != NULL)
+		str_cpy(buf, size, stat->name);
+	else
+		snprintf(buf, size, "mutex@%s",
+		    symtab_fmt_name_lookup(stat->site));
+}
+
+/** Take a snapshot of all lock classes
+ *
+ * @param count Output number of classes in the snapshot.
+ *
+ * @return Array of classes allocated by malloc() or NULL.
+ *
+ */
+lockstat_t *lockstat_snapshot(size_t *count)
+{
+	lockstat_t *snapshot = malloc(sizeof(lockstat_t) *
+	    (LOCKSTAT_CLASSES + 1));
+	if (snapshot == NULL) {
+		*count = 0;
+		return NULL;
+	}
+
+	size_t n = 0;
+	for (size_t i = 0; i <= LOCKSTAT_CLASSES; i++) {
+		lockstat_t *stat = (i < LOCKSTAT_CLASSES) ?
+		    &classes[i] : &overflow;
+
+		ipl_t ipl = guard_lock(&stat->guard);
+		if ((stat->acquired != 0) || (stat->max_hold_cycles != 0)) {
+			snapshot[n] = *stat;
+			n++;
+		}
+		guard_unlock(&stat->guard, ipl);
+	}
+
+	*count = n;
+	return snapshot;
+}
+
+static int lockstat_cmp(void *a, void *b, void *arg)
+{
+	lockstat_t *sa = (lockstat_t *) a;
+	lockstat_t *sb = (lockstat_t *) b;
+
+	if (sa->wait_cycles > sb->wait_cycles)
+		return -1;
+
+	if (sa->wait_cycles < sb->wait_cycles)
+		return 1;
+
+	if (sa->contended > sb->contended)
+		return -1;
+
+	if (sa->contended < sb->contended)
+		return 1;
+
+	return 0;
+}
+
+/** Print the most contended lock classes
+ *
+ * @param limit Maximum number of classes to print, 0 for all.
+ *
+ */
+void lockstat_print(size_t limit)
+{
+	size_t count;
+	lockstat_t *snapshot = lockstat_snapshot(&count);
+	if (snapshot == NULL) {
+		printf("Not enough memory for lock statistics.\n");
+		return;
+	}
+
+	gsort(snapshot, count, sizeof(lockstat_t), lockstat_cmp, NULL);
+
+	if ((limit == 0) || (limit > count))
+		limit = count;
+
+	printf("[acquired  ] [contended ] [wait cycles ] [max hold    ]"
+	    " [spun      ] [slept     ] [class\n");
+
+	for (size_t i = 0; i < limit; i++) {
+		char name[STATS_LOCK_NAME_BUFLEN];
+		lockstat_class_name(&snapshot[i], name, sizeof(name));
+
+		uint64_t wait;
+		uint64_t hold;
+		char wait_suffix;
+		char hold_suffix;
+		order_suffix(snapshot[i].wait_cycles, &wait, &wait_suffix);
+		order_suffix(snapshot[i].max_hold_cycles, &hold, &hold_suffix);
+
+		printf("%12" PRIu64 " %12" PRIu64 " %13" PRIu64 "%c "
+		    "%13" PRIu64 "%c %12" PRIu64 " %12" PRIu64 " %s\n",
+		    snapshot[i].acquired, snapshot[i].contended, wait,
+		    wait_suffix, hold, hold_suffix, snapshot[i].spun,
+		    snapshot[i].slept, name);
+	}
+
+	free(snapshot);
+}
+
+#endif /* CONFIG_LOCKSTAT */
+
+/** @}
+ */
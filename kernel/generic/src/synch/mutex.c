@@ -36,6 +36,7 @@
  */
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <errno.h>
 #include <synch/mutex.h>
 #include <synch/semaphore.h>
@@ -43,6 +44,13 @@
 #include <stacktrace.h>
 #include <cpu.h>
 #include <proc/thread.h>
+#include <config.h>
+
+#ifdef CONFIG_LOCKSTAT
+#include <synch/lockstat.h>
+#include <arch/cycle.h>
+#include <debug.h>
+#endif
 
 /** Initialize mutex.
  *
@@ -55,6 +63,10 @@ void mutex_initialize(mutex_t *mtx, mutex_type_t type)
 	mtx->owner = NULL;
 	mtx->nesting = 0;
 	semaphore_initialize(&mtx->sem, 1);
+#ifdef CONFIG_LOCKSTAT
+	mtx->stat = lockstat_mutex_class(CALLER);
+	mtx->hold_start = 0;
+#endif
 }
 
 /** Find out whether the mutex is currently locked.
@@ -70,6 +82,116 @@ bool mutex_locked(mutex_t *mtx)
 
 #define MUTEX_DEADLOCK_THRESHOLD	100000000
 
+/** Maximum number of attempts to acquire a mutex by spinning. */
+#define MUTEX_SPIN_THRESHOLD  10000
+
+#ifdef CONFIG_SMP
+
+/** Find out whether the owner of a mutex is running
+ *
+ * The owner is read without any locking. Thread structures are
+ * allocated from a slab cache in identity-mapped memory, so even
+ * a stale owner can be safely read, it only misguides the spinning
+ * heuristic once.
+ *
+ * @param mtx Mutex.
+ *
+ * @return False if the mutex has an owner which is not running.
+ *
+ */
+static bool mutex_owner_running(mutex_t *mtx)
+{
+	thread_t *owner = atomic_load_explicit(&mtx->owner,
+	    memory_order_relaxed);
+
+	/* The owner is about to be set or has just been cleared */
+	if (owner == NULL)
+		return true;
+
+	return (*((volatile state_t *) &owner->state) == Running);
+}
+
+/** Spin on a mutex as long as its owner is running
+ *
+ * Sleeping and being woken up costs much more than a typical short
+ * critical section. It is therefore cheaper to wait for an owner
+ * running on another CPU to release the mutex than to sleep. An owner
+ * which has been preempted or is blocked is not going to release the
+ * mutex any time soon, so the waiter goes to sleep right away.
+ *
+ * @param mtx Mutex.
+ *
+ * @return True if the mutex was acquired, false if the caller
+ *         should sleep on the mutex.
+ *
+ */
+static bool mutex_spin(mutex_t *mtx)
+{
+	if (config.cpu_active <= 1)
+		return false;
+
+	for (unsigned int i = 0; i < MUTEX_SPIN_THRESHOLD; i++) {
+		if (!mutex_owner_running(mtx))
+			return false;
+
+		if (semaphore_trydown(&mtx->sem) == EOK)
+			return true;
+	}
+
+	return false;
+}
+
+#endif /* CONFIG_SMP */
+
+/** Acquire the semaphore of a passive or recursive mutex
+ *
+ * @param mtx   Mutex.
+ * @param usec  Timeout in microseconds.
+ * @param flags Specify mode of operation.
+ *
+ * @return See comment for waitq_sleep_timeout().
+ *
+ */
+static errno_t mutex_down(mutex_t *mtx, uint32_t usec, unsigned int flags)
+{
+#ifdef CONFIG_LOCKSTAT
+	uint64_t wait_start = get_cycle();
+#endif
+	bool contended = false;
+	bool spun = false;
+
+	errno_t rc = semaphore_trydown(&mtx->sem);
+	if ((rc != EOK) && ((usec != SYNCH_NO_TIMEOUT) ||
+	    !(flags & SYNCH_FLAGS_NON_BLOCKING))) {
+		contended = true;
+
+#ifdef CONFIG_SMP
+		spun = mutex_spin(mtx);
+#endif
+		if (spun)
+			rc = EOK;
+		else
+			rc = _semaphore_down_timeout(&mtx->sem, usec, flags);
+	}
+
+	if (rc != EOK)
+		return rc;
+
+	mtx->owner = THREAD;
+
+#ifdef CONFIG_LOCKSTAT
+	mtx->hold_start = get_cycle();
+	lockstat_acquired(mtx->stat, contended,
+	    contended ? mtx->hold_start - wait_start : 0);
+	if (contended)
+		lockstat_mutex_waited(mtx->stat, !spun);
+#else
+	(void) contended;
+#endif
+
+	return EOK;
+}
+
 /** Acquire mutex.
  *
  * Timeout mode and non-blocking mode can be requested.
@@ -89,7 +211,7 @@ errno_t _mutex_lock_timeout(mutex_t *mtx, uint32_t usec, unsigned int flags)
 	errno_t rc;
 
 	if (mtx->type == MUTEX_PASSIVE && THREAD) {
-		rc = _semaphore_down_timeout(&mtx->sem, usec, flags);
+		rc = mutex_down(mtx, usec, flags);
 	} else if (mtx->type == MUTEX_RECURSIVE) {
 		assert(THREAD);
 
@@ -97,11 +219,9 @@ errno_t _mutex_lock_timeout(mutex_t *mtx, uint32_t usec, unsigned int flags)
 			mtx->nesting++;
 			return EOK;
 		} else {
-			rc = _semaphore_down_timeout(&mtx->sem, usec, flags);
-			if (rc == EOK) {
-				mtx->owner = THREAD;
+			rc = mutex_down(mtx, usec, flags);
+			if (rc == EOK)
 				mtx->nesting = 1;
-			}
 		}
 	} else {
 		assert((mtx->type == MUTEX_ACTIVE) || !THREAD);
@@ -110,6 +230,9 @@ errno_t _mutex_lock_timeout(mutex_t *mtx, uint32_t usec, unsigned int flags)
 
 		unsigned int cnt = 0;
 		bool deadlock_reported = false;
+#ifdef CONFIG_LOCKSTAT
+		uint64_t wait_start = get_cycle();
+#endif
 		do {
 			if (cnt++ > MUTEX_DEADLOCK_THRESHOLD) {
 				printf("cpu%u: looping on active mutex %p\n",
@@ -122,6 +245,16 @@ errno_t _mutex_lock_timeout(mutex_t *mtx, uint32_t usec, unsigned int flags)
 		} while (rc != EOK && !(flags & SYNCH_FLAGS_NON_BLOCKING));
 		if (deadlock_reported)
 			printf("cpu%u: not deadlocked\n", CPU->id);
+
+#ifdef CONFIG_LOCKSTAT
+		if (rc == EOK) {
+			bool contended = (cnt > 1) || deadlock_reported;
+
+			mtx->hold_start = get_cycle();
+			lockstat_acquired(mtx->stat, contended,
+			    contended ? mtx->hold_start - wait_start : 0);
+		}
+#endif
 	}
 
 	return rc;
@@ -137,8 +270,13 @@ void mutex_unlock(mutex_t *mtx)
 		assert(mtx->owner == THREAD);
 		if (--mtx->nesting > 0)
 			return;
-		mtx->owner = NULL;
 	}
+
+	mtx->owner = NULL;
+
+#ifdef CONFIG_LOCKSTAT
+	lockstat_released(mtx->stat, get_cycle() - mtx->hold_start);
+#endif
 	semaphore_up(&mtx->sem);
 }
 
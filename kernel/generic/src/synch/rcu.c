@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup kernel_sync
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Read-copy-update.
+ *
+ * Quiescent state based RCU. Readers only disable preemption and must
+ * not sleep, so a CPU which switches threads, runs its idle loop or
+ * enters the kernel from user space holds no read-side section begun
+ * earlier. Such events are recorded in cpu_t::rcu_qs_gp.
+ *
+ * Callbacks queued by rcu_call() are processed in batches by the krcu
+ * thread. For each batch it starts a new grace period by incrementing
+ * rcu_gp and waits until every active CPU has passed a quiescent state
+ * since, or is idle. Then it invokes the callbacks of the batch in the
+ * order they were queued.
+ */
+
+#include <synch/rcu.h>
+#include <arch.h>
+#include <assert.h>
+#include <atomic.h>
+#include <config.h>
+#include <cpu.h>
+#include <member.h>
+#include <proc/thread.h>
+#include <stdint.h>
+#include <synch/semaphore.h>
+#include <synch/spinlock.h>
+
+/** Interval at which krcu checks for the end of a grace period. */
+#define RCU_POLL_US  1000
+
+/** Number of the most recently started grace period. */
+static atomic_size_t rcu_gp = 0;
+
+/** Protects the queue of callbacks waiting for a grace period. */
+IRQ_SPINLOCK_STATIC_INITIALIZE(rcu_lock);
+
+/** Callbacks not yet picked by krcu, oldest first. */
+static rcu_item_t *rcu_pending = NULL;
+static rcu_item_t **rcu_pending_tail = &rcu_pending;
+
+/** Upped when rcu_pending becomes non-empty. */
+static semaphore_t rcu_work;
+
+/** rcu_barrier() callback. */
+typedef struct {
+	rcu_item_t item;
+	semaphore_t done;
+} rcu_barrier_item_t;
+
+/** Initialize RCU. */
+void rcu_init(void)
+{
+	semaphore_initialize(&rcu_work, 0);
+}
+
+/** Record a quiescent state of the current CPU
+ *
+ * The caller must not be inside a read-side critical section.
+ *
+ */
+void rcu_qs(void)
+{
+	cpu_t *cpu = CPU;
+
+	if (cpu != NULL) {
+		atomic_store_explicit(&cpu->rcu_qs_gp,
+		    atomic_load_explicit(&rcu_gp, memory_order_acquire),
+		    memory_order_release);
+	}
+}
+
+/** Note that the current CPU enters its idle loop
+ *
+ * An idle CPU is in an extended quiescent state until it leaves the
+ * idle loop or takes an interrupt.
+ *
+ */
+void rcu_idle_enter(void)
+{
+	atomic_store(&CPU->rcu_idle, true);
+}
+
+/** Note that the current CPU leaves its idle loop. */
+void rcu_idle_exit(void)
+{
+	atomic_store(&CPU->rcu_idle, false);
+}
+
+/** Note an exception taken by the current CPU
+ *
+ * Must be called before the exception handler runs.
+ *
+ * @param from_uspace The exception interrupted user space, which is
+ *                    a quiescent state.
+ *
+ */
+void rcu_exc_enter(bool from_uspace)
+{
+	cpu_t *cpu = CPU;
+
+	if (cpu == NULL)
+		return;
+
+	if (atomic_load_explicit(&cpu->rcu_idle, memory_order_relaxed))
+		atomic_store(&cpu->rcu_idle, false);
+
+	if (from_uspace)
+		rcu_qs();
+}
+
+/** Invoke a function after all current read-side sections finish
+ *
+ * The function runs in the context of the krcu thread. Callbacks are
+ * invoked in the order in which they were queued.
+ *
+ * @param item Callback item, must stay allocated until @a func runs.
+ * @param func Function to invoke with @a item.
+ *
+ */
+void rcu_call(rcu_item_t *item, rcu_func_t func)
+{
+	item->func = func;
+	item->next = NULL;
+
+	irq_spinlock_lock(&rcu_lock, true);
+
+	bool was_empty = (rcu_pending == NULL);
+	*rcu_pending_tail = item;
+	rcu_pending_tail = &item->next;
+
+	irq_spinlock_unlock(&rcu_lock, true);
+
+	if (was_empty)
+		semaphore_up(&rcu_work);
+}
+
+static void rcu_barrier_cb(rcu_item_t *item)
+{
+	rcu_barrier_item_t *barrier =
+	    member_to_inst(item, rcu_barrier_item_t, item);
+
+	semaphore_up(&barrier->done);
+}
+
+/** Wait until all callbacks queued so far have been invoked
+ *
+ * This also waits for a full grace period, so it can be used to wait
+ * for the readers of a structure which was just unpublished.
+ *
+ */
+void rcu_barrier(void)
+{
+	rcu_barrier_item_t barrier;
+
+	semaphore_initialize(&barrier.done, 0);
+	rcu_call(&barrier.item, rcu_barrier_cb);
+	semaphore_down(&barrier.done);
+}
+
+/** Check whether a CPU passed a quiescent state in a grace period. */
+static bool rcu_cpu_quiescent(cpu_t *cpu, size_t gp)
+{
+	if (!cpu->active)
+		return true;
+
+	if (atomic_load(&cpu->rcu_idle))
+		return true;
+
+	size_t qs = atomic_load_explicit(&cpu->rcu_qs_gp,
+	    memory_order_acquire);
+
+	/* The grace period numbers wrap around */
+	return qs - gp <= SIZE_MAX / 2;
+}
+
+/** Start a new grace period and wait for its end. */
+static void rcu_gp_wait(void)
+{
+	size_t gp = atomic_fetch_add(&rcu_gp, 1) + 1;
+
+	/* Make the new grace period visible before sampling the CPUs */
+	memory_barrier();
+
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		/* The CPU running this thread is quiescent right now */
+		rcu_qs();
+
+		while (!rcu_cpu_quiescent(&cpus[i], gp))
+			thread_usleep(RCU_POLL_US);
+	}
+}
+
+/** Thread detecting grace periods and invoking RCU callbacks.
+ *
+ * @param arg Unused.
+ *
+ */
+void krcu(void *arg)
+{
+	thread_detach(THREAD);
+
+	while (true) {
+		semaphore_down(&rcu_work);
+
+		irq_spinlock_lock(&rcu_lock, true);
+		rcu_item_t *batch = rcu_pending;
+		rcu_pending = NULL;
+		rcu_pending_tail = &rcu_pending;
+		irq_spinlock_unlock(&rcu_lock, true);
+
+		if (batch == NULL)
+			continue;
+
+		rcu_gp_wait();
+
+		while (batch != NULL) {
+			rcu_item_t *item = batch;
+			batch = item->next;
+			item->func(item);
+		}
+	}
+}
+
+/** @}
+ */
@@ -46,6 +46,11 @@
 #include <stacktrace.h>
 #include <cpu.h>
 
+#ifdef CONFIG_LOCKSTAT
+#include <synch/lockstat.h>
+#include <arch/cycle.h>
+#endif
+
 #ifdef CONFIG_SMP
 
 /** Initialize spinlock
@@ -59,8 +64,37 @@ void spinlock_initialize(spinlock_t *lock, const char *name)
 #ifdef CONFIG_DEBUG_SPINLOCK
 	lock->name = name;
 #endif
+#ifdef CONFIG_LOCKSTAT
+	lock->stat = NULL;
+	lock->hold_start = 0;
+#endif
+}
+
+#ifdef CONFIG_LOCKSTAT
+
+/** Account acquisition of a spinlock
+ *
+ * The spinlock must be held by the caller.
+ *
+ * @param lock       Spinlock.
+ * @param contended  Whether the lock had to be waited for.
+ * @param wait_start Cycle at which the waiting started.
+ *
+ */
+static void spinlock_stat_acquired(spinlock_t *lock, bool contended,
+    uint64_t wait_start)
+{
+	lock->hold_start = get_cycle();
+
+	if (lock->stat == NULL)
+		lock->stat = lockstat_spinlock_class(lock->name);
+
+	lockstat_acquired(lock->stat, contended,
+	    contended ? lock->hold_start - wait_start : 0);
 }
 
+#endif /* CONFIG_LOCKSTAT */
+
 #ifdef CONFIG_DEBUG_SPINLOCK
 
 /** Lock spinlock
@@ -76,9 +110,20 @@ void spinlock_lock_debug(spinlock_t *lock)
 {
 	size_t i = 0;
 	bool deadlock_reported = false;
+#ifdef CONFIG_LOCKSTAT
+	bool contended = false;
+	uint64_t wait_start = 0;
+#endif
 
 	preemption_disable();
 	while (atomic_flag_test_and_set_explicit(&lock->flag, memory_order_acquire)) {
+#ifdef CONFIG_LOCKSTAT
+		if (!contended) {
+			contended = true;
+			wait_start = get_cycle();
+		}
+#endif
+
 		/*
 		 * We need to be careful about particular locks
 		 * which are directly used to report deadlocks
@@ -114,6 +159,10 @@ void spinlock_lock_debug(spinlock_t *lock)
 
 	if (deadlock_reported)
 		printf("cpu%u: not deadlocked\n", CPU->id);
+
+#ifdef CONFIG_LOCKSTAT
+	spinlock_stat_acquired(lock, contended, wait_start);
+#endif
 }
 
 /** Unlock spinlock
@@ -126,6 +175,11 @@ void spinlock_unlock_debug(spinlock_t *lock)
 {
 	ASSERT_SPINLOCK(spinlock_locked(lock), lock);
 
+#ifdef CONFIG_LOCKSTAT
+	if (lock->stat != NULL)
+		lockstat_released(lock->stat, get_cycle() - lock->hold_start);
+#endif
+
 	atomic_flag_clear_explicit(&lock->flag, memory_order_release);
 	preemption_enable();
 }
@@ -150,6 +204,11 @@ bool spinlock_trylock(spinlock_t *lock)
 	if (!ret)
 		preemption_enable();
 
+#ifdef CONFIG_LOCKSTAT
+	if (ret)
+		spinlock_stat_acquired(lock, false, 0);
+#endif
+
 	return ret;
 }
 
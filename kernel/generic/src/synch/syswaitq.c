@@ -38,6 +38,7 @@
 #include <synch/syswaitq.h>
 #include <synch/waitq.h>
 #include <abi/cap.h>
+#include <abi/synch.h>
 #include <cap/cap.h>
 #include <mm/slab.h>
 #include <proc/task.h>
@@ -170,23 +171,63 @@ sys_errno_t sys_waitq_sleep(cap_waitq_handle_t whandle, uint32_t timeout,
 	return (sys_errno_t) rc;
 }
 
-/** Wakeup a thread sleeping in the waitq
+/** Wakeup threads sleeping in the waitq
  *
  * @param whandle  Waitq capability handle of the waitq to invoke wakeup on.
+ * @param count    Number of wakeups to deliver, or SYNCH_WAKEUP_ALL to wake
+ *                 up all sleeping threads.
  *
  * @return         Error code.
  */
-sys_errno_t sys_waitq_wakeup(cap_waitq_handle_t whandle)
+sys_errno_t sys_waitq_wakeup(cap_waitq_handle_t whandle, sysarg_t count)
 {
 	kobject_t *kobj = kobject_get(TASK, whandle, KOBJECT_TYPE_WAITQ);
 	if (!kobj)
 		return (sys_errno_t) ENOENT;
 
-	waitq_wakeup(kobj->waitq, WAKEUP_FIRST);
+	if (count == (sysarg_t) SYNCH_WAKEUP_ALL)
+		waitq_wakeup(kobj->waitq, WAKEUP_ALL);
+	else if (count == 1)
+		waitq_wakeup(kobj->waitq, WAKEUP_FIRST);
+	else
+		waitq_wakeup_n(kobj->waitq, count);
 
 	kobject_put(kobj);
 	return (sys_errno_t) EOK;
 }
 
+/** Move threads sleeping in one waitq to another one
+ *
+ * @param shandle  Waitq capability handle of the source waitq.
+ * @param dhandle  Waitq capability handle of the destination waitq.
+ * @param count    Maximum number of sleeping threads to move.
+ * @param[out] moved  Userspace address of the buffer that will receive the
+ *                    number of threads actually moved.
+ *
+ * @return         Error code.
+ */
+sys_errno_t sys_waitq_requeue(cap_waitq_handle_t shandle,
+    cap_waitq_handle_t dhandle, sysarg_t count, uspace_ptr_size_t moved)
+{
+	kobject_t *src = kobject_get(TASK, shandle, KOBJECT_TYPE_WAITQ);
+	if (!src)
+		return (sys_errno_t) ENOENT;
+
+	kobject_t *dst = kobject_get(TASK, dhandle, KOBJECT_TYPE_WAITQ);
+	if (!dst) {
+		kobject_put(src);
+		return (sys_errno_t) ENOENT;
+	}
+
+	size_t cnt = 0;
+	if (src->waitq != dst->waitq)
+		cnt = waitq_requeue(src->waitq, dst->waitq, count);
+
+	kobject_put(dst);
+	kobject_put(src);
+
+	return (sys_errno_t) copy_to_uspace(moved, &cnt, sizeof(cnt));
+}
+
 /** @}
  */
@@ -444,6 +444,73 @@ void waitq_wakeup(waitq_t *wq, wakeup_mode_t mode)
 	irq_spinlock_unlock(&wq->lock, true);
 }
 
+/** Wake up several threads sleeping in a wait queue
+ *
+ * The wakeups are delivered as a batch under a single acquisition of the
+ * wait queue lock. Each of them behaves as a WAKEUP_FIRST wakeup, so the
+ * wakeups that do not find a sleeping thread are recorded as missed.
+ *
+ * @param wq    Pointer to wait queue.
+ * @param count Number of wakeups to deliver.
+ *
+ */
+void waitq_wakeup_n(waitq_t *wq, size_t count)
+{
+	irq_spinlock_lock(&wq->lock, true);
+	while (count-- > 0)
+		_waitq_wakeup_unsafe(wq, WAKEUP_FIRST);
+	irq_spinlock_unlock(&wq->lock, true);
+}
+
+/** Move threads sleeping in one wait queue to another one
+ *
+ * Up to @a count of the longest waiting threads are moved from @a src to
+ * the tail of @a dst without being woken up. Their timeouts, if any, stay
+ * armed and will remove them from @a dst. Missed wakeups are not
+ * transferred.
+ *
+ * @param src   Wait queue to take the sleeping threads from.
+ * @param dst   Wait queue to move the sleeping threads to.
+ * @param count Maximum number of threads to move.
+ *
+ * @return Number of threads actually moved.
+ *
+ */
+size_t waitq_requeue(waitq_t *src, waitq_t *dst, size_t count)
+{
+	assert(src != dst);
+
+	/* Lock the wait queues in a consistent order to avoid deadlock. */
+	waitq_t *first = (src < dst) ? src : dst;
+	waitq_t *second = (src < dst) ? dst : src;
+
+	irq_spinlock_lock(&first->lock, true);
+	irq_spinlock_lock(&second->lock, false);
+
+	size_t moved = 0;
+	while ((moved < count) && (!list_empty(&src->sleepers))) {
+		thread_t *thread = list_get_instance(list_first(&src->sleepers),
+		    thread_t, wq_link);
+
+		/*
+		 * Hold the thread lock so that waitq_sleep_timed_out() and
+		 * waitq_interrupt_sleep() see a consistent sleep_queue.
+		 */
+		irq_spinlock_lock(&thread->lock, false);
+		list_remove(&thread->wq_link);
+		list_append(&thread->wq_link, &dst->sleepers);
+		thread->sleep_queue = dst;
+		irq_spinlock_unlock(&thread->lock, false);
+
+		moved++;
+	}
+
+	irq_spinlock_unlock(&second->lock, false);
+	irq_spinlock_unlock(&first->lock, true);
+
+	return moved;
+}
+
 /** If there is a wakeup in progress actively waits for it to complete.
  *
  * The function returns once the concurrently running waitq_wakeup()
@@ -495,9 +562,10 @@ static void waitq_complete_wakeup(waitq_t *wq)
  * @param wq   Pointer to wait queue.
  * @param mode If mode is WAKEUP_FIRST, then the longest waiting
  *             thread, if any, is woken up. If mode is WAKEUP_ALL, then
- *             all waiting threads, if any, are woken up. If there are
- *             no waiting threads to be woken up, the missed wakeup is
- *             recorded in the wait queue.
+ *             all waiting threads, if any, are woken up. WAKEUP_HANDOFF
+ *             is like WAKEUP_FIRST, but the woken up thread is handed the
+ *             current CPU if possible. If there are no waiting threads to
+ *             be woken up, the missed wakeup is recorded in the wait queue.
  *
  */
 void _waitq_wakeup_unsafe(waitq_t *wq, wakeup_mode_t mode)
@@ -508,7 +576,7 @@ void _waitq_wakeup_unsafe(waitq_t *wq, wakeup_mode_t mode)
 	assert(irq_spinlock_locked(&wq->lock));
 
 	if (wq->ignore_wakeups > 0) {
-		if (mode == WAKEUP_FIRST) {
+		if (mode != WAKEUP_ALL) {
 			wq->ignore_wakeups--;
 			return;
 		}
@@ -555,7 +623,12 @@ loop:
 	thread->sleep_queue = NULL;
 	irq_spinlock_unlock(&thread->lock, false);
 
+#ifdef CONFIG_IPC_HANDOFF
+	if ((mode != WAKEUP_HANDOFF) || (!thread_ready_handoff(thread)))
+		thread_ready(thread);
+#else
 	thread_ready(thread);
+#endif
 
 	if (mode == WAKEUP_ALL)
 		goto loop;
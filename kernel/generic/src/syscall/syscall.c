@@ -48,12 +48,15 @@
 #include <synch/smc.h>
 #include <synch/syswaitq.h>
 #include <ddi/ddi.h>
+#include <ddi/msi.h>
 #include <ipc/event.h>
+#include <ipc/ring.h>
 #include <security/perm.h>
 #include <sysinfo/sysinfo.h>
 #include <console/console.h>
 #include <udebug/udebug.h>
 #include <log.h>
+#include <profile.h>
 
 static syshandler_t syscall_table[] = {
 	/* System management syscalls. */
@@ -65,9 +68,13 @@ static syshandler_t syscall_table[] = {
 	[SYS_THREAD_GET_ID] = (syshandler_t) sys_thread_get_id,
 	[SYS_THREAD_USLEEP] = (syshandler_t) sys_thread_usleep,
 	[SYS_THREAD_UDELAY] = (syshandler_t) sys_thread_udelay,
+	[SYS_THREAD_SET_AFFINITY] = (syshandler_t) sys_thread_set_affinity,
+	[SYS_THREAD_GET_AFFINITY] = (syshandler_t) sys_thread_get_affinity,
+	[SYS_THREAD_SET_RT] = (syshandler_t) sys_thread_set_rt,
 
 	[SYS_TASK_GET_ID] = (syshandler_t) sys_task_get_id,
 	[SYS_TASK_SET_NAME] = (syshandler_t) sys_task_set_name,
+	[SYS_TASK_SET_NUMA] = (syshandler_t) sys_task_set_numa,
 	[SYS_TASK_KILL] = (syshandler_t) sys_task_kill,
 	[SYS_TASK_EXIT] = (syshandler_t) sys_task_exit,
 	[SYS_PROGRAM_SPAWN_LOADER] = (syshandler_t) sys_program_spawn_loader,
@@ -77,6 +84,7 @@ static syshandler_t syscall_table[] = {
 	[SYS_WAITQ_SLEEP] = (syshandler_t) sys_waitq_sleep,
 	[SYS_WAITQ_WAKEUP] = (syshandler_t) sys_waitq_wakeup,
 	[SYS_WAITQ_DESTROY] = (syshandler_t) sys_waitq_destroy,
+	[SYS_WAITQ_REQUEUE] = (syshandler_t) sys_waitq_requeue,
 	[SYS_SMC_COHERENCE] = (syshandler_t) sys_smc_coherence,
 
 	/* Address space related syscalls. */
@@ -85,6 +93,7 @@ static syshandler_t syscall_table[] = {
 	[SYS_AS_AREA_CHANGE_FLAGS] = (syshandler_t) sys_as_area_change_flags,
 	[SYS_AS_AREA_GET_INFO] = (syshandler_t) sys_as_area_get_info,
 	[SYS_AS_AREA_DESTROY] = (syshandler_t) sys_as_area_destroy,
+	[SYS_AS_AREA_SYNC] = (syshandler_t) sys_as_area_sync,
 
 	/* Page mapping related syscalls. */
 	[SYS_PAGE_FIND_MAPPING] = (syshandler_t) sys_page_find_mapping,
@@ -92,15 +101,23 @@ static syshandler_t syscall_table[] = {
 	/* IPC related syscalls. */
 	[SYS_IPC_CALL_ASYNC_FAST] = (syshandler_t) sys_ipc_call_async_fast,
 	[SYS_IPC_CALL_ASYNC_SLOW] = (syshandler_t) sys_ipc_call_async_slow,
+	[SYS_IPC_CALL_ASYNC_BATCH] = (syshandler_t) sys_ipc_call_async_batch,
 	[SYS_IPC_ANSWER_FAST] = (syshandler_t) sys_ipc_answer_fast,
 	[SYS_IPC_ANSWER_SLOW] = (syshandler_t) sys_ipc_answer_slow,
 	[SYS_IPC_FORWARD_FAST] = (syshandler_t) sys_ipc_forward_fast,
 	[SYS_IPC_FORWARD_SLOW] = (syshandler_t) sys_ipc_forward_slow,
 	[SYS_IPC_WAIT] = (syshandler_t) sys_ipc_wait_for_call,
+	[SYS_IPC_WAIT_MULTI] = (syshandler_t) sys_ipc_wait_for_calls,
 	[SYS_IPC_POKE] = (syshandler_t) sys_ipc_poke,
 	[SYS_IPC_HANGUP] = (syshandler_t) sys_ipc_hangup,
 	[SYS_IPC_CONNECT_KBOX] = (syshandler_t) sys_ipc_connect_kbox,
 
+	/* IPC ring related syscalls. */
+	[SYS_IPC_RING_CREATE] = (syshandler_t) sys_ipc_ring_create,
+	[SYS_IPC_RING_WAIT] = (syshandler_t) sys_ipc_ring_wait,
+	[SYS_IPC_RING_NOTIFY] = (syshandler_t) sys_ipc_ring_notify,
+	[SYS_IPC_RING_DESTROY] = (syshandler_t) sys_ipc_ring_destroy,
+
 	/* Event notification syscalls. */
 	[SYS_IPC_EVENT_SUBSCRIBE] = (syshandler_t) sys_ipc_event_subscribe,
 	[SYS_IPC_EVENT_UNSUBSCRIBE] = (syshandler_t) sys_ipc_event_unsubscribe,
@@ -120,6 +137,10 @@ static syshandler_t syscall_table[] = {
 
 	[SYS_IPC_IRQ_SUBSCRIBE] = (syshandler_t) sys_ipc_irq_subscribe,
 	[SYS_IPC_IRQ_UNSUBSCRIBE] = (syshandler_t) sys_ipc_irq_unsubscribe,
+	[SYS_IRQ_MSI_ALLOC] = (syshandler_t) sys_irq_msi_alloc,
+	[SYS_IRQ_MSI_FREE] = (syshandler_t) sys_irq_msi_free,
+	[SYS_IRQ_AFFINITY_SET] = (syshandler_t) sys_irq_affinity_set,
+	[SYS_IRQ_AFFINITY_GET] = (syshandler_t) sys_irq_affinity_get,
 
 	/* Sysinfo syscalls. */
 	[SYS_SYSINFO_GET_KEYS_SIZE] = (syshandler_t) sys_sysinfo_get_keys_size,
@@ -132,6 +153,11 @@ static syshandler_t syscall_table[] = {
 	/* Kernel console syscalls. */
 	[SYS_DEBUG_CONSOLE] = (syshandler_t) sys_debug_console,
 
+	/* Sampling profiler syscalls. */
+	[SYS_PROFILE_CTL] = (syshandler_t) sys_profile_ctl,
+	[SYS_PROFILE_READ] = (syshandler_t) sys_profile_read,
+	[SYS_PROFILE_SYMBOL] = (syshandler_t) sys_profile_symbol,
+
 	[SYS_KLOG] = (syshandler_t) sys_klog,
 };
 
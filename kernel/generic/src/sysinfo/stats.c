@@ -43,15 +43,28 @@
 #include <synch/mutex.h>
 #include <time/clock.h>
 #include <mm/frame.h>
+#include <mm/slab.h>
+#include <mm/tlb.h>
+#include <mm/zero.h>
+#include <mm/reclaim.h>
+#include <mm/numa.h>
 #include <proc/task.h>
 #include <proc/thread.h>
 #include <interrupt.h>
 #include <stdbool.h>
 #include <str.h>
+#include <mem.h>
 #include <errno.h>
 #include <cpu.h>
 #include <arch.h>
 #include <stdlib.h>
+#include <barrier.h>
+#include <ddi/ddi.h>
+#include <log.h>
+
+#ifdef CONFIG_LOCKSTAT
+#include <synch/lockstat.h>
+#endif
 
 /** Bits of fixed-point precision for load */
 #define LOAD_FIXED_SHIFT  11
@@ -91,6 +104,40 @@ static load_t avenrdy[LOAD_STEPS] = { 0, 0, 0 };
 /** Load calculation lock */
 static mutex_t load_lock;
 
+/** Current generation of task and thread statistics */
+atomic_size_t stats_generation = 0;
+
+/** Statistics page shared with user space */
+static stats_page_t *stats_page;
+
+/** Physical memory area of the statistics page */
+static parea_t stats_parea;
+
+/** Produce statistics of all CPUs
+ *
+ * @param stats_cpus Array of config.cpu_count CPU statistics.
+ *
+ */
+static void produce_stats_cpus(stats_cpu_t *stats_cpus)
+{
+	size_t i;
+	for (i = 0; i < config.cpu_count; i++) {
+		irq_spinlock_lock(&cpus[i].lock, true);
+
+		stats_cpus[i].id = cpus[i].id;
+		stats_cpus[i].active = cpus[i].active;
+		stats_cpus[i].frequency_mhz = cpus[i].frequency_mhz;
+		stats_cpus[i].busy_cycles = cpus[i].busy_cycles;
+		stats_cpus[i].idle_cycles = cpus[i].idle_cycles;
+		stats_cpus[i].steal_count = cpus[i].steal_count;
+		stats_cpus[i].balance_count = cpus[i].balance_count;
+		memcpy(stats_cpus[i].rq_latency, cpus[i].rq_latency,
+		    sizeof(stats_cpus[i].rq_latency));
+
+		irq_spinlock_unlock(&cpus[i].lock, true);
+	}
+}
+
 /** Get statistics of all CPUs
  *
  * @param item    Sysinfo item (unused).
@@ -116,96 +163,11 @@ static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
 		return NULL;
 	}
 
-	size_t i;
-	for (i = 0; i < config.cpu_count; i++) {
-		irq_spinlock_lock(&cpus[i].lock, true);
-
-		stats_cpus[i].id = cpus[i].id;
-		stats_cpus[i].active = cpus[i].active;
-		stats_cpus[i].frequency_mhz = cpus[i].frequency_mhz;
-		stats_cpus[i].busy_cycles = cpus[i].busy_cycles;
-		stats_cpus[i].idle_cycles = cpus[i].idle_cycles;
-
-		irq_spinlock_unlock(&cpus[i].lock, true);
-	}
+	produce_stats_cpus(stats_cpus);
 
 	return ((void *) stats_cpus);
 }
 
-/** Get the size of a virtual address space
- *
- * @param as Address space.
- *
- * @return Size of the mapped virtual address space (bytes).
- *
- */
-static size_t get_task_virtmem(as_t *as)
-{
-	/*
-	 * We are holding spinlocks here and therefore are not allowed to
-	 * block. Only attempt to lock the address space and address space
-	 * area mutexes conditionally. If it is not possible to lock either
-	 * object, return inexact statistics by skipping the respective object.
-	 */
-
-	if (mutex_trylock(&as->lock) != EOK)
-		return 0;
-
-	size_t pages = 0;
-
-	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
-	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
-			continue;
-
-		pages += area->pages;
-		mutex_unlock(&area->lock);
-		area = as_area_next(area);
-	}
-
-	mutex_unlock(&as->lock);
-
-	return (pages << PAGE_WIDTH);
-}
-
-/** Get the resident (used) size of a virtual address space
- *
- * @param as Address space.
- *
- * @return Size of the resident (used) virtual address space (bytes).
- *
- */
-static size_t get_task_resmem(as_t *as)
-{
-	/*
-	 * We are holding spinlocks here and therefore are not allowed to
-	 * block. Only attempt to lock the address space and address space
-	 * area mutexes conditionally. If it is not possible to lock either
-	 * object, return inexact statistics by skipping the respective object.
-	 */
-
-	if (mutex_trylock(&as->lock) != EOK)
-		return 0;
-
-	size_t pages = 0;
-
-	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
-	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
-			continue;
-
-		pages += area->used_space.pages;
-		mutex_unlock(&area->lock);
-		area = as_area_next(area);
-	}
-
-	mutex_unlock(&as->lock);
-
-	return (pages << PAGE_WIDTH);
-}
-
 /** Produce task statistics
  *
  * Summarize task information into task statistics.
@@ -221,12 +183,17 @@ static void produce_stats_task(task_t *task, stats_task_t *stats_task)
 
 	stats_task->task_id = task->taskid;
 	str_cpy(stats_task->name, TASK_NAME_BUFLEN, task->name);
-	stats_task->virtmem = get_task_virtmem(task->as);
-	stats_task->resmem = get_task_resmem(task->as);
+	stats_task->virtmem =
+	    atomic_load(&task->as->virt_pages) << PAGE_WIDTH;
+	stats_task->resmem =
+	    atomic_load(&task->as->resident_pages) << PAGE_WIDTH;
+	stats_task->large_pages = task->as->large_pages;
 	stats_task->threads = atomic_load(&task->refcount);
 	task_get_accounting(task, &(stats_task->ucycles),
 	    &(stats_task->kcycles));
 	stats_task->ipc_info = task->ipc_info;
+	ipc_answerbox_get_stats(&task->answerbox, &stats_task->ipc_info);
+	task_get_rq_latency(task, stats_task->rq_latency);
 }
 
 /** Get task statistics
@@ -421,6 +388,10 @@ static bool produce_stats_ipcc_cb(cap_t *cap, void *arg)
 	if (phone->state == IPC_PHONE_CONNECTED) {
 		state->data[state->i].caller = phone->caller->taskid;
 		state->data[state->i].callee = phone->callee->task->taskid;
+		state->data[state->i].calls = atomic_load(&phone->calls_sent);
+		state->data[state->i].answers =
+		    atomic_load(&phone->answers_received);
+		state->data[state->i].active = atomic_load(&phone->active_calls);
 		state->i++;
 	}
 
@@ -637,6 +608,209 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 	return ret;
 }
 
+/** Check whether statistics changed since a generation
+ *
+ * @param gen   Generation of the last change.
+ * @param since Requested generation.
+ *
+ * @return True if the statistics changed in the requested
+ *         generation or later.
+ *
+ */
+static inline bool stats_changed(atomic_size_t *gen, uint64_t since)
+{
+	return atomic_load(gen) >= since;
+}
+
+/** Get incremental task statistics
+ *
+ * Get the IDs of all tasks and the statistics of the tasks
+ * changed since a given generation. The generation is passed
+ * as a string (current limitation of the sysinfo interface).
+ * Unlike get_stats_tasks(), this does not copy the statistics
+ * of idle tasks.
+ *
+ * @param name    Generation (string-encoded number), 0 to get
+ *                the statistics of all tasks.
+ * @param dry_run Do not get the data, just calculate an upper
+ *                bound of the size.
+ * @param data    Unused.
+ *
+ * @return Sysinfo return holder. The type of the returned
+ *         data is either SYSINFO_VAL_UNDEFINED (invalid
+ *         generation or memory allocation error) or
+ *         SYSINFO_VAL_FUNCTION_DATA (stats_delta_t followed
+ *         by task IDs and stats_task_t structures, the data
+ *         should be freed within the sysinfo request context).
+ *
+ */
+static sysinfo_return_t get_stats_tasks_delta(const char *name,
+    bool dry_run, void *data)
+{
+	/* Initially no return value */
+	sysinfo_return_t ret;
+	ret.tag = SYSINFO_VAL_UNDEFINED;
+
+	/* Parse the generation */
+	uint64_t since;
+	if (str_uint64_t(name, NULL, 0, true, &since) != EOK)
+		return ret;
+
+	/* Changes from now on belong to the next generation */
+	size_t generation = 0;
+	if (!dry_run)
+		generation = atomic_fetch_add(&stats_generation, 1);
+
+	/* Messing with task structures, avoid deadlock */
+	irq_spinlock_lock(&tasks_lock, true);
+
+	size_t count = task_count();
+	size_t size = sizeof(stats_delta_t) +
+	    count * (sizeof(task_id_t) + sizeof(stats_task_t));
+
+	if (dry_run) {
+		irq_spinlock_unlock(&tasks_lock, true);
+
+		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+		ret.data.data = NULL;
+		ret.data.size = size;
+		return ret;
+	}
+
+	stats_delta_t *delta = (stats_delta_t *) malloc(size);
+	if (delta == NULL) {
+		irq_spinlock_unlock(&tasks_lock, true);
+		return ret;
+	}
+
+	task_id_t *ids = (task_id_t *) (delta + 1);
+	stats_task_t *stats_tasks = (stats_task_t *) (ids + count);
+
+	size_t i = 0;
+	size_t changed = 0;
+	task_t *task = task_first();
+	while (task != NULL) {
+		ids[i] = task->taskid;
+		i++;
+
+		if (stats_changed(&task->stats_gen, since) ||
+		    stats_changed(&task->as->stats_gen, since)) {
+			/* Interrupts are already disabled */
+			irq_spinlock_lock(&task->lock, false);
+			produce_stats_task(task, &stats_tasks[changed]);
+			irq_spinlock_unlock(&task->lock, false);
+			changed++;
+		}
+
+		task = task_next(task);
+	}
+
+	irq_spinlock_unlock(&tasks_lock, true);
+
+	delta->generation = generation + 1;
+	delta->count = count;
+	delta->changed = changed;
+
+	ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+	ret.data.data = (void *) delta;
+	ret.data.size = sizeof(stats_delta_t) + count * sizeof(task_id_t) +
+	    changed * sizeof(stats_task_t);
+
+	return ret;
+}
+
+/** Get incremental thread statistics
+ *
+ * Same as get_stats_tasks_delta(), but for threads.
+ *
+ * @param name    Generation (string-encoded number), 0 to get
+ *                the statistics of all threads.
+ * @param dry_run Do not get the data, just calculate an upper
+ *                bound of the size.
+ * @param data    Unused.
+ *
+ * @return Sysinfo return holder. The type of the returned
+ *         data is either SYSINFO_VAL_UNDEFINED (invalid
+ *         generation or memory allocation error) or
+ *         SYSINFO_VAL_FUNCTION_DATA (stats_delta_t followed
+ *         by thread IDs and stats_thread_t structures, the data
+ *         should be freed within the sysinfo request context).
+ *
+ */
+static sysinfo_return_t get_stats_threads_delta(const char *name,
+    bool dry_run, void *data)
+{
+	/* Initially no return value */
+	sysinfo_return_t ret;
+	ret.tag = SYSINFO_VAL_UNDEFINED;
+
+	/* Parse the generation */
+	uint64_t since;
+	if (str_uint64_t(name, NULL, 0, true, &since) != EOK)
+		return ret;
+
+	/* Changes from now on belong to the next generation */
+	size_t generation = 0;
+	if (!dry_run)
+		generation = atomic_fetch_add(&stats_generation, 1);
+
+	/* Messing with threads structures, avoid deadlock */
+	irq_spinlock_lock(&threads_lock, true);
+
+	size_t count = thread_count();
+	size_t size = sizeof(stats_delta_t) +
+	    count * (sizeof(thread_id_t) + sizeof(stats_thread_t));
+
+	if (dry_run) {
+		irq_spinlock_unlock(&threads_lock, true);
+
+		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+		ret.data.data = NULL;
+		ret.data.size = size;
+		return ret;
+	}
+
+	stats_delta_t *delta = (stats_delta_t *) malloc(size);
+	if (delta == NULL) {
+		irq_spinlock_unlock(&threads_lock, true);
+		return ret;
+	}
+
+	thread_id_t *ids = (thread_id_t *) (delta + 1);
+	stats_thread_t *stats_threads = (stats_thread_t *) (ids + count);
+
+	size_t i = 0;
+	size_t changed = 0;
+	thread_t *thread = thread_first();
+	while (thread != NULL) {
+		ids[i] = thread->tid;
+		i++;
+
+		if (stats_changed(&thread->stats_gen, since)) {
+			/* Interrupts are already disabled */
+			irq_spinlock_lock(&thread->lock, false);
+			produce_stats_thread(thread, &stats_threads[changed]);
+			irq_spinlock_unlock(&thread->lock, false);
+			changed++;
+		}
+
+		thread = thread_next(thread);
+	}
+
+	irq_spinlock_unlock(&threads_lock, true);
+
+	delta->generation = generation + 1;
+	delta->count = count;
+	delta->changed = changed;
+
+	ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+	ret.data.data = (void *) delta;
+	ret.data.size = sizeof(stats_delta_t) + count * sizeof(thread_id_t) +
+	    changed * sizeof(stats_thread_t);
+
+	return ret;
+}
+
 /** Get exceptions statistics
  *
  * @param item    Sysinfo item (unused).
@@ -673,8 +847,10 @@ static void *get_stats_exceptions(struct sysinfo_item *item, size_t *size,
 		stats_exceptions[i].id = i + IVT_FIRST;
 		str_cpy(stats_exceptions[i].desc, EXC_NAME_BUFLEN, exc_table[i].name);
 		stats_exceptions[i].hot = exc_table[i].hot;
-		stats_exceptions[i].cycles = exc_table[i].cycles;
-		stats_exceptions[i].count = exc_table[i].count;
+		stats_exceptions[i].cycles =
+		    pcpu_counter_sum_positive(&exc_table[i].cycles);
+		stats_exceptions[i].count =
+		    pcpu_counter_sum_positive(&exc_table[i].count);
 	}
 
 	irq_spinlock_unlock(&exctbl_lock, true);
@@ -683,6 +859,94 @@ static void *get_stats_exceptions(struct sysinfo_item *item, size_t *size,
 	return ((void *) stats_exceptions);
 }
 
+#ifdef CONFIG_LOCKSTAT
+
+/** Get lock contention statistics
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing several stats_lock_t structures.
+ *         If the return value is not NULL, it should be freed
+ *         in the context of the sysinfo request.
+ */
+static void *get_stats_locks(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	size_t count;
+	lockstat_t *snapshot = lockstat_snapshot(&count);
+	if (snapshot == NULL) {
+		*size = 0;
+		return NULL;
+	}
+
+	*size = sizeof(stats_lock_t) * count;
+	if ((dry_run) || (count == 0)) {
+		free(snapshot);
+		return NULL;
+	}
+
+	stats_lock_t *stats_locks = (stats_lock_t *) malloc(*size);
+	if (stats_locks == NULL) {
+		/* No free space for allocation */
+		free(snapshot);
+		*size = 0;
+		return NULL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		lockstat_class_name(&snapshot[i], stats_locks[i].name,
+		    STATS_LOCK_NAME_BUFLEN);
+		stats_locks[i].acquired = snapshot[i].acquired;
+		stats_locks[i].contended = snapshot[i].contended;
+		stats_locks[i].wait_cycles = snapshot[i].wait_cycles;
+		stats_locks[i].max_hold_cycles = snapshot[i].max_hold_cycles;
+		stats_locks[i].spun = snapshot[i].spun;
+		stats_locks[i].slept = snapshot[i].slept;
+	}
+
+	free(snapshot);
+	return ((void *) stats_locks);
+}
+
+#endif /* CONFIG_LOCKSTAT */
+
+/** Get slab cache statistics
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing several stats_slab_t structures.
+ *         If the return value is not NULL, it should be freed
+ *         in the context of the sysinfo request.
+ */
+static void *get_stats_slabs(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	size_t count = slab_stats(NULL, 0);
+
+	*size = sizeof(stats_slab_t) * count;
+	if ((dry_run) || (count == 0))
+		return NULL;
+
+	stats_slab_t *stats_slabs = (stats_slab_t *) malloc(*size);
+	if (stats_slabs == NULL) {
+		/* No free space for allocation */
+		*size = 0;
+		return NULL;
+	}
+
+	/* Caches might have been destroyed in the meantime */
+	count = min(count, slab_stats(stats_slabs, count));
+	*size = sizeof(stats_slab_t) * count;
+
+	return ((void *) stats_slabs);
+}
+
 /** Get exception statistics
  *
  * Get statistics of a given exception. The exception number
@@ -750,8 +1014,10 @@ static sysinfo_return_t get_stats_exception(const char *name, bool dry_run,
 		stats_exception->id = excn;
 		str_cpy(stats_exception->desc, EXC_NAME_BUFLEN, exc_table[excn].name);
 		stats_exception->hot = exc_table[excn].hot;
-		stats_exception->cycles = exc_table[excn].cycles;
-		stats_exception->count = exc_table[excn].count;
+		stats_exception->cycles =
+		    pcpu_counter_sum_positive(&exc_table[excn].cycles);
+		stats_exception->count =
+		    pcpu_counter_sum_positive(&exc_table[excn].count);
 
 		irq_spinlock_unlock(&exctbl_lock, true);
 	}
@@ -759,6 +1025,27 @@ static sysinfo_return_t get_stats_exception(const char *name, bool dry_run,
 	return ret;
 }
 
+/** Produce physical memory statistics
+ *
+ * @param stats_physmem Physical memory statistics.
+ *
+ */
+static void produce_stats_physmem(stats_physmem_t *stats_physmem)
+{
+	zones_stats(&(stats_physmem->total), &(stats_physmem->unavail),
+	    &(stats_physmem->used), &(stats_physmem->free),
+	    stats_physmem->node_busy, stats_physmem->node_free);
+	stats_physmem->nodes = numa_node_count();
+	frame_cache_stats(&(stats_physmem->cache_hits),
+	    &(stats_physmem->cache_misses));
+	zero_pool_stats(&(stats_physmem->zero_pool),
+	    &(stats_physmem->zero_hits), &(stats_physmem->zero_misses));
+	stats_physmem->zero_pool = FRAMES2SIZE(stats_physmem->zero_pool);
+	reclaim_stats(&(stats_physmem->reclaim_runs),
+	    &(stats_physmem->reclaim_freed));
+	stats_physmem->reclaim_freed = FRAMES2SIZE(stats_physmem->reclaim_freed);
+}
+
 /** Get physical memory statistics
  *
  * @param item    Sysinfo item (unused).
@@ -784,12 +1071,40 @@ static void *get_stats_physmem(struct sysinfo_item *item, size_t *size,
 		return NULL;
 	}
 
-	zones_stats(&(stats_physmem->total), &(stats_physmem->unavail),
-	    &(stats_physmem->used), &(stats_physmem->free));
+	produce_stats_physmem(stats_physmem);
 
 	return ((void *) stats_physmem);
 }
 
+/** Get TLB shootdown statistics
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing stats_tlb_t.
+ *         If the return value is not NULL, it should be freed
+ *         in the context of the sysinfo request.
+ */
+static void *get_stats_tlb(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	*size = sizeof(stats_tlb_t);
+	if (dry_run)
+		return NULL;
+
+	stats_tlb_t *stats_tlb = (stats_tlb_t *) malloc(*size);
+	if (stats_tlb == NULL) {
+		*size = 0;
+		return NULL;
+	}
+
+	tlb_stats(stats_tlb);
+
+	return ((void *) stats_tlb);
+}
+
 /** Get system load
  *
  * @param item    Sysinfo item (unused).
@@ -837,9 +1152,66 @@ static inline load_t load_calc(load_t load, load_t exp, size_t ready)
 	return (load >> LOAD_FIXED_SHIFT);
 }
 
+/** Refresh the statistics page
+ *
+ * Only called from kload(), which is the only writer
+ * of the load averages.
+ *
+ */
+static void stats_page_update(void)
+{
+	if (stats_page == NULL)
+		return;
+
+	/* Odd sequence number tells readers to retry */
+	stats_page->seq++;
+	write_barrier();
+
+	unsigned int i;
+	for (i = 0; i < LOAD_STEPS; i++)
+		stats_page->load[i] = avenrdy[i] << LOAD_KERNEL_SHIFT;
+
+	produce_stats_physmem(&stats_page->physmem);
+	produce_stats_cpus(stats_page->cpus);
+
+	write_barrier();
+	stats_page->seq++;
+}
+
+/** Allocate the statistics page and publish it to user space
+ *
+ */
+static void stats_page_init(void)
+{
+	size_t size = sizeof(stats_page_t) +
+	    config.cpu_count * sizeof(stats_cpu_t);
+	size_t frames = SIZE2FRAMES(size);
+
+	uintptr_t faddr = frame_alloc(frames, FRAME_LOWMEM | FRAME_ATOMIC, 0);
+	if (faddr == 0) {
+		log(LF_OTHER, LVL_WARN, "Cannot allocate statistics page.");
+		return;
+	}
+
+	stats_page = (stats_page_t *) PA2KA(faddr);
+	memsetb(stats_page, FRAMES2SIZE(frames), 0);
+	stats_page->cpu_count = config.cpu_count;
+
+	ddi_parea_init(&stats_parea);
+	stats_parea.pbase = faddr;
+	stats_parea.frames = frames;
+	stats_parea.unpriv = true;
+	stats_parea.mapped = false;
+	ddi_parea_register(&stats_parea);
+
+	sysinfo_set_item_val("stats.faddr", NULL, (sysarg_t) faddr);
+	sysinfo_set_item_val("stats.pages", NULL, frames);
+}
+
 /** Load computation thread.
  *
- * Compute system load every few seconds.
+ * Compute system load every few seconds and refresh
+ * the statistics page every second.
  *
  * @param arg Unused.
  *
@@ -848,19 +1220,27 @@ void kload(void *arg)
 {
 	thread_detach(THREAD);
 
+	unsigned int seconds = 0;
+
 	while (true) {
-		size_t ready = atomic_load(&nrdy);
+		if (seconds == 0) {
+			size_t ready = pcpu_counter_sum_positive(&nrdy);
+
+			/* Mutually exclude with get_stats_load() */
+			mutex_lock(&load_lock);
 
-		/* Mutually exclude with get_stats_load() */
-		mutex_lock(&load_lock);
+			unsigned int i;
+			for (i = 0; i < LOAD_STEPS; i++)
+				avenrdy[i] = load_calc(avenrdy[i], load_exp[i],
+				    ready);
 
-		unsigned int i;
-		for (i = 0; i < LOAD_STEPS; i++)
-			avenrdy[i] = load_calc(avenrdy[i], load_exp[i], ready);
+			mutex_unlock(&load_lock);
+		}
 
-		mutex_unlock(&load_lock);
+		stats_page_update();
 
-		thread_sleep(LOAD_INTERVAL);
+		seconds = (seconds + 1) % LOAD_INTERVAL;
+		thread_sleep(1);
 	}
 }
 
@@ -870,17 +1250,25 @@ void kload(void *arg)
 void stats_init(void)
 {
 	mutex_initialize(&load_lock, MUTEX_PASSIVE);
+	stats_page_init();
 
 	sysinfo_set_item_gen_data("system.cpus", NULL, get_stats_cpus, NULL);
 	sysinfo_set_item_gen_data("system.physmem", NULL, get_stats_physmem, NULL);
+	sysinfo_set_item_gen_data("system.tlb", NULL, get_stats_tlb, NULL);
 	sysinfo_set_item_gen_data("system.load", NULL, get_stats_load, NULL);
 	sysinfo_set_item_gen_data("system.tasks", NULL, get_stats_tasks, NULL);
 	sysinfo_set_item_gen_data("system.threads", NULL, get_stats_threads, NULL);
 	sysinfo_set_item_gen_data("system.ipccs", NULL, get_stats_ipccs, NULL);
 	sysinfo_set_item_gen_data("system.exceptions", NULL, get_stats_exceptions, NULL);
+	sysinfo_set_item_gen_data("system.slabs", NULL, get_stats_slabs, NULL);
+#ifdef CONFIG_LOCKSTAT
+	sysinfo_set_item_gen_data("system.locks", NULL, get_stats_locks, NULL);
+#endif
 	sysinfo_set_subtree_fn("system.tasks", NULL, get_stats_task, NULL);
 	sysinfo_set_subtree_fn("system.threads", NULL, get_stats_thread, NULL);
 	sysinfo_set_subtree_fn("system.exceptions", NULL, get_stats_exception, NULL);
+	sysinfo_set_subtree_fn("system.tasks_delta", NULL, get_stats_tasks_delta, NULL);
+	sysinfo_set_subtree_fn("system.threads_delta", NULL, get_stats_threads_delta, NULL);
 }
 
 /** @}
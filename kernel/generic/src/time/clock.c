@@ -38,6 +38,13 @@
  * of preemption. It is also responsible for executing expired
  * timeouts.
  *
+ * With CONFIG_TICKLESS, CPUs other than the bootstrap CPU (which keeps
+ * the uptime counters up to date) stop the periodic tick while they
+ * are idle or run a single thread. The local timer is then programmed
+ * to fire only when the next timeout expires (or the time slice of the
+ * running thread ends) and the skipped ticks are accounted as missed
+ * clock ticks once the periodic tick is restarted.
+ *
  */
 
 #include <time/clock.h>
@@ -57,6 +64,9 @@
 #include <mm/frame.h>
 #include <ddi/ddi.h>
 #include <arch/cycle.h>
+#include <macros.h>
+#include <bitops.h>
+#include <profile.h>
 
 /* Pointer to variable with uptime */
 uptime_t *uptime;
@@ -127,6 +137,74 @@ static void clock_update_counters(void)
 	}
 }
 
+#ifdef CONFIG_TICKLESS
+
+/** Upper bound of the number of ticks a CPU can skip in one go. */
+#define TICKLESS_MAX_TICKS  (10 * HZ)
+
+/** Stop the periodic tick on the current CPU
+ *
+ * Interrupts must be disabled.
+ *
+ * @param limit Maximum number of ticks to skip.
+ *
+ */
+static void clock_tick_stop(uint64_t limit)
+{
+	/* The bootstrap CPU keeps the uptime counters running. */
+	if ((CPU->id == 0) || (atomic_load(&CPU->tickless)))
+		return;
+
+	uint64_t ticks = min(timeout_ticks_to_next(), limit);
+	if (ticks > TICKLESS_MAX_TICKS)
+		ticks = TICKLESS_MAX_TICKS;
+
+	if (ticks < 2)
+		return;
+
+	atomic_store(&CPU->tickless, true);
+	tickless_arch_enter(ticks);
+
+	/*
+	 * A thread might have been readied on this CPU by another CPU
+	 * which did not see the tick stopped yet and did not kick us.
+	 */
+	if (atomic_load(&CPU->nrdy) != 0)
+		clock_tick_restart();
+}
+
+/** Stop the periodic tick before the current CPU goes idle
+ *
+ * Interrupts must be disabled.
+ *
+ */
+void clock_tick_stop_idle(void)
+{
+	clock_tick_stop(TICKLESS_MAX_TICKS);
+}
+
+/** Restart the periodic tick on the current CPU
+ *
+ * The ticks which elapsed while the tick was stopped are recorded as
+ * missed clock ticks so that the next clock() accounts for them. The
+ * tick during which the CPU was woken up is accounted by that clock()
+ * itself. Interrupts must be disabled.
+ *
+ */
+void clock_tick_restart(void)
+{
+	if (!atomic_load(&CPU->tickless))
+		return;
+
+	atomic_store(&CPU->tickless, false);
+
+	uint64_t elapsed = tickless_arch_exit();
+	if (elapsed > 0)
+		CPU->missed_clock_ticks += elapsed - 1;
+}
+
+#endif /* CONFIG_TICKLESS */
+
 static void cpu_update_accounting(void)
 {
 	irq_spinlock_lock(&CPU->lock, false);
@@ -146,50 +224,23 @@ static void cpu_update_accounting(void)
 void clock(void)
 {
 	size_t missed_clock_ticks = CPU->missed_clock_ticks;
+	CPU->missed_clock_ticks = 0;
 
 	/* Account CPU usage */
 	cpu_update_accounting();
 
-	/*
-	 * To avoid lock ordering problems,
-	 * run all expired timeouts as you visit them.
-	 *
-	 */
 	size_t i;
 	for (i = 0; i <= missed_clock_ticks; i++) {
 		/* Update counters and accounting */
 		clock_update_counters();
 		cpu_update_accounting();
 
-		irq_spinlock_lock(&CPU->timeoutlock, false);
-
-		link_t *cur;
-		while ((cur = list_first(&CPU->timeout_active_list)) != NULL) {
-			timeout_t *timeout = list_get_instance(cur, timeout_t,
-			    link);
-
-			irq_spinlock_lock(&timeout->lock, false);
-			if (timeout->ticks-- != 0) {
-				irq_spinlock_unlock(&timeout->lock, false);
-				break;
-			}
-
-			list_remove(cur);
-			timeout_handler_t handler = timeout->handler;
-			void *arg = timeout->arg;
-			timeout_reinitialize(timeout);
-
-			irq_spinlock_unlock(&timeout->lock, false);
-			irq_spinlock_unlock(&CPU->timeoutlock, false);
-
-			handler(arg);
-
-			irq_spinlock_lock(&CPU->timeoutlock, false);
-		}
-
-		irq_spinlock_unlock(&CPU->timeoutlock, false);
+		/* Run expired timeouts */
+		timeout_process();
 	}
-	CPU->missed_clock_ticks = 0;
+
+	/* Sample the interrupted code before THREAD can be preempted */
+	profile_tick();
 
 	/*
 	 * Do CPU usage accounting and find out whether to preempt THREAD.
@@ -204,14 +255,38 @@ void clock(void)
 		irq_spinlock_unlock(&CPU->lock, false);
 
 		irq_spinlock_lock(&THREAD->lock, false);
+		if (thread_rt_tick(THREAD, 1 + missed_clock_ticks))
+			THREAD->ticks = 0;
+
 		if ((ticks = THREAD->ticks)) {
 			if (ticks >= 1 + missed_clock_ticks)
 				THREAD->ticks -= 1 + missed_clock_ticks;
 			else
 				THREAD->ticks = 0;
 		}
+
+		/*
+		 * Do not let a real-time thread wait for the time slice of
+		 * a less urgent thread to end.
+		 */
+		unsigned int rt_ready = atomic_load(&CPU->rt_ready);
+		if ((rt_ready != 0) && ((int) fnzb32(rt_ready) >
+		    (thread_rt_active(THREAD) ? THREAD->rt_priority : -1)))
+			ticks = 0;
+#ifdef CONFIG_TICKLESS
+		uint64_t slice = THREAD->ticks;
+#endif
 		irq_spinlock_unlock(&THREAD->lock, false);
 
+#ifdef CONFIG_TICKLESS
+		/*
+		 * With no other thread to run, the tick is only needed
+		 * to end the time slice and to activate timeouts.
+		 */
+		if ((ticks != 0) && (atomic_load(&CPU->nrdy) == 0))
+			clock_tick_stop(slice);
+#endif
+
 		if (ticks == 0 && PREEMPTION_ENABLED) {
 			scheduler();
 #ifdef CONFIG_UDEBUG
@@ -36,6 +36,8 @@
  */
 
 #include <time/timeout.h>
+#include <assert.h>
+#include <time/clock.h>
 #include <typedefs.h>
 #include <config.h>
 #include <panic.h>
@@ -53,7 +55,14 @@
 void timeout_init(void)
 {
 	irq_spinlock_initialize(&CPU->timeoutlock, "cpu.timeoutlock");
-	list_initialize(&CPU->timeout_active_list);
+
+	for (unsigned int level = 0; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		for (unsigned int slot = 0; slot < TIMEOUT_WHEEL_SLOTS; slot++)
+			list_initialize(&CPU->timeout_wheel[level][slot]);
+	}
+
+	CPU->timeout_now = 0;
+	CPU->timeout_count = 0;
 }
 
 /** Reinitialize timeout
@@ -66,7 +75,7 @@ void timeout_init(void)
 void timeout_reinitialize(timeout_t *timeout)
 {
 	timeout->cpu = NULL;
-	timeout->ticks = 0;
+	timeout->deadline = 0;
 	timeout->handler = NULL;
 	timeout->arg = NULL;
 	link_initialize(&timeout->link);
@@ -85,6 +94,39 @@ void timeout_initialize(timeout_t *timeout)
 	timeout_reinitialize(timeout);
 }
 
+/** Find the timeout wheel slot for a deadline
+ *
+ * The timeout is placed on the lowest level on which the deadline
+ * and the current time of the wheel differ only in the slot index.
+ * Timeouts too far in the future for the top level are parked in its
+ * current slot and placed again after a full revolution of the wheel.
+ *
+ * @param cpu      CPU owning the wheel, its timeoutlock must be held.
+ * @param deadline Absolute deadline in clock ticks.
+ *
+ * @return Slot list the timeout belongs to.
+ *
+ */
+static list_t *timeout_wheel_slot(cpu_t *cpu, uint64_t deadline)
+{
+	uint64_t diff = deadline ^ cpu->timeout_now;
+	unsigned int level = 0;
+
+	while ((level < TIMEOUT_WHEEL_LEVELS - 1) &&
+	    ((diff >> (TIMEOUT_WHEEL_BITS * (level + 1))) != 0))
+		level++;
+
+	unsigned int shift = TIMEOUT_WHEEL_BITS * level;
+	uint64_t index;
+
+	if ((diff >> (shift + TIMEOUT_WHEEL_BITS)) != 0)
+		index = cpu->timeout_now >> shift;
+	else
+		index = deadline >> shift;
+
+	return &cpu->timeout_wheel[level][index & (TIMEOUT_WHEEL_SLOTS - 1)];
+}
+
 /** Register timeout
  *
  * Insert timeout handler f (with argument arg)
@@ -106,53 +148,32 @@ void timeout_register(timeout_t *timeout, uint64_t time,
 	if (timeout->cpu)
 		panic("Unexpected: timeout->cpu != 0.");
 
-	timeout->cpu = CPU;
-	timeout->ticks = us2ticks(time);
-
-	timeout->handler = handler;
-	timeout->arg = arg;
+#ifdef CONFIG_TICKLESS
+	/* The stopped tick might fire only after this timeout expires */
+	clock_tick_restart();
+#endif
 
 	/*
-	 * Insert timeout into the active timeouts list according to timeout->ticks.
+	 * The timeout is activated by the (ticks + 1)-th
+	 * invocation of timeout_process() from now.
 	 */
-	uint64_t sum = 0;
-	timeout_t *target = NULL;
-	link_t *cur, *prev;
-	prev = NULL;
-	for (cur = list_first(&CPU->timeout_active_list);
-	    cur != NULL; cur = list_next(cur, &CPU->timeout_active_list)) {
-		target = list_get_instance(cur, timeout_t, link);
-		irq_spinlock_lock(&target->lock, false);
-
-		if (timeout->ticks < sum + target->ticks) {
-			irq_spinlock_unlock(&target->lock, false);
-			break;
-		}
-
-		sum += target->ticks;
-		irq_spinlock_unlock(&target->lock, false);
-		prev = cur;
-	}
-
-	if (prev == NULL)
-		list_prepend(&timeout->link, &CPU->timeout_active_list);
-	else
-		list_insert_after(&timeout->link, prev);
+	uint64_t ticks = us2ticks(time);
 
+#ifdef CONFIG_TICKLESS
 	/*
-	 * Adjust timeout->ticks according to ticks
-	 * accumulated in target's predecessors.
+	 * The ticks which elapsed while the tick was stopped are yet to be
+	 * replayed by clock(), they must not count against this timeout.
 	 */
-	timeout->ticks -= sum;
+	ticks += CPU->missed_clock_ticks;
+#endif
 
-	/*
-	 * Decrease ticks of timeout's immediate succesor by timeout->ticks.
-	 */
-	if (cur != NULL) {
-		irq_spinlock_lock(&target->lock, false);
-		target->ticks -= timeout->ticks;
-		irq_spinlock_unlock(&target->lock, false);
-	}
+	timeout->cpu = CPU;
+	timeout->deadline = CPU->timeout_now + ticks + 1;
+	timeout->handler = handler;
+	timeout->arg = arg;
+
+	list_append(&timeout->link, timeout_wheel_slot(CPU, timeout->deadline));
+	CPU->timeout_count++;
 
 	irq_spinlock_unlock(&timeout->lock, false);
 	irq_spinlock_unlock(&CPU->timeoutlock, true);
@@ -186,19 +207,11 @@ grab_locks:
 
 	/*
 	 * Now we know for sure that timeout hasn't been activated yet
-	 * and is lurking in timeout->cpu->timeout_active_list.
+	 * and is lurking in one of the timeout->cpu->timeout_wheel slots.
 	 */
 
-	link_t *cur = list_next(&timeout->link,
-	    &timeout->cpu->timeout_active_list);
-	if (cur != NULL) {
-		timeout_t *tmp = list_get_instance(cur, timeout_t, link);
-		irq_spinlock_lock(&tmp->lock, false);
-		tmp->ticks += timeout->ticks;
-		irq_spinlock_unlock(&tmp->lock, false);
-	}
-
 	list_remove(&timeout->link);
+	timeout->cpu->timeout_count--;
 	irq_spinlock_unlock(&timeout->cpu->timeoutlock, false);
 
 	timeout_reinitialize(timeout);
@@ -207,5 +220,130 @@ grab_locks:
 	return true;
 }
 
+/** Get number of clock ticks until the first timeout on this CPU expires
+ *
+ * Timeouts on higher levels of the wheel are only accounted for by the
+ * start of their slot, the result can therefore be smaller than the
+ * actual distance to the earliest timeout, but never larger.
+ *
+ * Interrupts must be disabled.
+ *
+ * @return Number of clock() invocations after which the earliest
+ *         timeout is going to be activated at the soonest, UINT64_MAX
+ *         if there are no timeouts registered on the current CPU.
+ *
+ */
+uint64_t timeout_ticks_to_next(void)
+{
+	uint64_t ticks = UINT64_MAX;
+
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	if (CPU->timeout_count == 0)
+		goto out;
+
+	uint64_t now = CPU->timeout_now;
+
+	for (unsigned int level = 0; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		unsigned int shift = TIMEOUT_WHEEL_BITS * level;
+		uint64_t base = (now >> (shift + TIMEOUT_WHEEL_BITS)) <<
+		    (shift + TIMEOUT_WHEEL_BITS);
+		unsigned int cur = (now >> shift) & (TIMEOUT_WHEEL_SLOTS - 1);
+
+		for (unsigned int slot = cur + 1; slot < TIMEOUT_WHEEL_SLOTS;
+		    slot++) {
+			if (!list_empty(&CPU->timeout_wheel[level][slot])) {
+				ticks = base + ((uint64_t) slot << shift) - now;
+				goto out;
+			}
+		}
+	}
+
+	/* Only timeouts parked until the next revolution of the wheel */
+	unsigned int bits = TIMEOUT_WHEEL_BITS * TIMEOUT_WHEEL_LEVELS;
+	ticks = (UINT64_C(1) << bits) - (now & ((UINT64_C(1) << bits) - 1));
+
+out:
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+	return ticks;
+}
+
+/** Redistribute the timeouts of one wheel slot to the levels below
+ *
+ * @param slot Slot list, CPU->timeoutlock must be held.
+ *
+ */
+static void timeout_wheel_cascade(list_t *slot)
+{
+	list_t pending;
+	list_initialize(&pending);
+	list_concat(&pending, slot);
+
+	link_t *cur;
+	while ((cur = list_first(&pending)) != NULL) {
+		timeout_t *timeout = list_get_instance(cur, timeout_t, link);
+
+		list_remove(cur);
+		list_append(cur, timeout_wheel_slot(CPU, timeout->deadline));
+	}
+}
+
+/** Advance the timeout wheel by one clock tick
+ *
+ * Run all timeouts of the current CPU which expire in this tick.
+ * To avoid lock ordering problems, the handlers are run as the
+ * timeouts are visited, without holding CPU->timeoutlock.
+ *
+ * Interrupts must be disabled.
+ *
+ */
+void timeout_process(void)
+{
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	uint64_t now = ++CPU->timeout_now;
+
+	/*
+	 * Entering a new slot on a higher level moves its timeouts
+	 * closer to the bottom. The higher levels have to go first,
+	 * as they may refill the slots being entered below them.
+	 */
+	for (unsigned int level = TIMEOUT_WHEEL_LEVELS - 1; level > 0; level--) {
+		unsigned int shift = TIMEOUT_WHEEL_BITS * level;
+
+		if ((now & ((UINT64_C(1) << shift) - 1)) != 0)
+			continue;
+
+		timeout_wheel_cascade(&CPU->timeout_wheel[level]
+		    [(now >> shift) & (TIMEOUT_WHEEL_SLOTS - 1)]);
+	}
+
+	list_t *slot = &CPU->timeout_wheel[0][now & (TIMEOUT_WHEEL_SLOTS - 1)];
+
+	link_t *cur;
+	while ((cur = list_first(slot)) != NULL) {
+		timeout_t *timeout = list_get_instance(cur, timeout_t, link);
+
+		irq_spinlock_lock(&timeout->lock, false);
+		assert(timeout->deadline == now);
+
+		list_remove(cur);
+		CPU->timeout_count--;
+
+		timeout_handler_t handler = timeout->handler;
+		void *arg = timeout->arg;
+		timeout_reinitialize(timeout);
+
+		irq_spinlock_unlock(&timeout->lock, false);
+		irq_spinlock_unlock(&CPU->timeoutlock, false);
+
+		handler(arg);
+
+		irq_spinlock_lock(&CPU->timeoutlock, false);
+	}
+
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+}
+
 /** @}
  */
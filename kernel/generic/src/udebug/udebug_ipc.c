@@ -435,6 +435,25 @@ static void udebug_receive_mem_read(call_t *call)
 	ipc_answer(&TASK->kb.box, call);
 }
 
+/** Process a WORD_WRITE call.
+ *
+ * Writes one word of memory of the current (debugged) task.
+ * @param call	The call structure.
+ */
+static void udebug_receive_word_write(call_t *call)
+{
+	uspace_addr_t uspace_dst;
+	sysarg_t value;
+	errno_t rc;
+
+	uspace_dst = ipc_get_arg2(&call->data);
+	value = ipc_get_arg3(&call->data);
+
+	rc = udebug_word_write(uspace_dst, value);
+	ipc_set_retval(&call->data, rc);
+	ipc_answer(&TASK->kb.box, call);
+}
+
 /** Handle a debug call received on the kernel answerbox.
  *
  * This is called by the kbox servicing thread. Verifies that the sender
@@ -495,6 +514,9 @@ void udebug_call_receive(call_t *call)
 	case UDEBUG_M_MEM_READ:
 		udebug_receive_mem_read(call);
 		break;
+	case UDEBUG_M_WORD_WRITE:
+		udebug_receive_word_write(call);
+		break;
 	}
 }
 
@@ -578,5 +578,30 @@ errno_t udebug_mem_read(uspace_addr_t uspace_addr, size_t n, void **buffer)
 	return EOK;
 }
 
+/** Write one word of the memory of the debugged task.
+ *
+ * The debugger uses this to flip switches in the debugged task, such as
+ * the sampling interval of the heap profiler.
+ *
+ * @param uspace_addr Address of the word.
+ * @param value       Value to write.
+ *
+ */
+errno_t udebug_word_write(uspace_addr_t uspace_addr, sysarg_t value)
+{
+	/* Verify task state */
+	mutex_lock(&TASK->udebug.lock);
+
+	if (TASK->udebug.dt_state != UDEBUG_TS_ACTIVE) {
+		mutex_unlock(&TASK->udebug.lock);
+		return EBUSY;
+	}
+
+	errno_t rc = copy_to_uspace(uspace_addr, &value, sizeof(value));
+	mutex_unlock(&TASK->udebug.lock);
+
+	return rc;
+}
+
 /** @}
  */
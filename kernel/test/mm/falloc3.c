@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <mm/page.h>
+#include <mm/frame.h>
+#include <arch/mm/page.h>
+#include <typedefs.h>
+#include <align.h>
+#include <stdlib.h>
+
+#define TEST_BLOCKS  256
+#define MAX_COUNT    37
+#define MAX_ALIGN    64
+
+/** Check contiguous allocations of odd sizes with alignment constraints. */
+const char *test_falloc3(void)
+{
+	uintptr_t *frames = malloc(TEST_BLOCKS * sizeof(uintptr_t));
+	size_t *counts = malloc(TEST_BLOCKS * sizeof(size_t));
+	if ((frames == NULL) || (counts == NULL)) {
+		free(frames);
+		free(counts);
+		return "Unable to allocate memory";
+	}
+
+	const char *ret = NULL;
+	size_t free_before = frame_total_free_get();
+	unsigned int allocated = 0;
+
+	for (unsigned int i = 0; i < TEST_BLOCKS; i++) {
+		size_t count = (i % MAX_COUNT) + 1;
+		size_t align = FRAMES2SIZE((size_t) 1 << (i % 7));
+		if (align > FRAMES2SIZE(MAX_ALIGN))
+			align = FRAMES2SIZE(MAX_ALIGN);
+
+		uintptr_t frame = frame_alloc(count, FRAME_ATOMIC, align - 1);
+		if (frame == 0) {
+			TPRINTF("Out of memory after %u blocks.\n", allocated);
+			break;
+		}
+
+		if (!IS_ALIGNED(frame, align)) {
+			TPRINTF("Block %p of %zu frames not aligned to %zu.\n",
+			    (void *) frame, count, align);
+			ret = "Alignment constraint not satisfied";
+			frame_free(frame, count);
+			break;
+		}
+
+		for (unsigned int j = 0; j < allocated; j++) {
+			if (overlaps(frame, FRAMES2SIZE(count), frames[j],
+			    FRAMES2SIZE(counts[j]))) {
+				ret = "Overlapping blocks allocated";
+				break;
+			}
+		}
+
+		frames[allocated] = frame;
+		counts[allocated] = count;
+		allocated++;
+
+		if (ret != NULL)
+			break;
+	}
+
+	TPRINTF("Allocated %u blocks, freeing them interleaved.\n",
+	    allocated);
+
+	/* Free odd-indexed blocks first to exercise buddy merging */
+	for (unsigned int i = 1; i < allocated; i += 2)
+		frame_free(frames[i], counts[i]);
+
+	for (unsigned int i = 0; i < allocated; i += 2)
+		frame_free(frames[i], counts[i]);
+
+	size_t free_after = frame_total_free_get();
+	if ((ret == NULL) && (free_after != free_before)) {
+		TPRINTF("Free frames before %zu, after %zu.\n", free_before,
+		    free_after);
+		ret = "Possible frame leak";
+	}
+
+	free(frames);
+	free(counts);
+
+	return ret;
+}
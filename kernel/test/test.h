@@ -61,6 +61,7 @@ extern const char *test_mips1(void);
 extern const char *test_fault1(void);
 extern const char *test_falloc1(void);
 extern const char *test_falloc2(void);
+extern const char *test_falloc3(void);
 extern const char *test_mapping1(void);
 extern const char *test_purge1(void);
 extern const char *test_slab1(void);
@@ -73,6 +74,8 @@ extern const char *test_print3(void);
 extern const char *test_print4(void);
 extern const char *test_print5(void);
 extern const char *test_thread1(void);
+extern const char *test_timeout1(void);
+extern const char *test_timeout2(void);
 
 extern test_t tests[];
 
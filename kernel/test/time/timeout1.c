@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <arch.h>
+#include <atomic.h>
+#include <stdlib.h>
+#include <cpu.h>
+#include <proc/thread.h>
+#include <time/timeout.h>
+
+#define TIMEOUTS      32768
+#define CANCEL_EVERY  4
+#define SPREAD_US     2000000
+#define LONG_US       600000000
+#define WAIT_SECONDS  30
+
+typedef struct {
+	timeout_t timeout;
+	/** Value of CPU->timeout_now at registration. */
+	uint64_t start;
+	/** Ticks which have to elapse before activation. */
+	uint64_t ticks;
+	atomic_bool fired;
+} item_t;
+
+static atomic_size_t fired;
+static atomic_size_t early;
+static atomic_size_t twice;
+
+static void handler(void *arg)
+{
+	item_t *item = (item_t *) arg;
+
+	if (CPU->timeout_now - item->start < item->ticks + 1)
+		atomic_inc(&early);
+
+	if (atomic_exchange(&item->fired, true))
+		atomic_inc(&twice);
+
+	atomic_inc(&fired);
+}
+
+static void item_register(item_t *item, uint64_t time)
+{
+	timeout_initialize(&item->timeout);
+	item->ticks = us2ticks(time);
+	atomic_store(&item->fired, false);
+
+	/* Sample the wheel time on the CPU the timeout is registered on */
+	ipl_t ipl = interrupts_disable();
+	item->start = CPU->timeout_now;
+	timeout_register(&item->timeout, time, handler, item);
+	interrupts_restore(ipl);
+}
+
+const char *test_timeout1(void)
+{
+	item_t *items = malloc(sizeof(item_t) * TIMEOUTS);
+	if (items == NULL)
+		return "Unable to allocate timeouts";
+
+	atomic_store(&fired, 0);
+	atomic_store(&early, 0);
+	atomic_store(&twice, 0);
+
+	TPRINTF("Registering %d timeouts...\n", TIMEOUTS);
+
+	size_t expected = 0;
+	for (size_t i = 0; i < TIMEOUTS; i++) {
+		if (i % CANCEL_EVERY == 0) {
+			item_register(&items[i], LONG_US + i);
+		} else {
+			item_register(&items[i], (i * 7919) % SPREAD_US);
+			expected++;
+		}
+	}
+
+	TPRINTF("Unregistering %zu timeouts...\n", TIMEOUTS - expected);
+
+	const char *err = NULL;
+	for (size_t i = 0; i < TIMEOUTS; i += CANCEL_EVERY) {
+		if (!timeout_unregister(&items[i].timeout)) {
+			err = "Unable to unregister pending timeout";
+			break;
+		}
+
+		if (timeout_unregister(&items[i].timeout)) {
+			err = "Timeout unregistered twice";
+			break;
+		}
+	}
+
+	for (unsigned int sec = 0; sec < WAIT_SECONDS; sec++) {
+		if (atomic_load(&fired) >= expected)
+			break;
+
+		TPRINTF("%zu timeouts pending\n", expected - atomic_load(&fired));
+		thread_sleep(1);
+	}
+
+	/* Make sure nothing fires after the handlers go away */
+	for (size_t i = 0; i < TIMEOUTS; i++)
+		timeout_unregister(&items[i].timeout);
+
+	size_t count = atomic_load(&fired);
+
+	if ((err == NULL) && (count > expected))
+		err = "Unregistered timeouts were activated";
+
+	if ((err == NULL) && (atomic_load(&early) != 0))
+		err = "Timeouts were activated prematurely";
+
+	if ((err == NULL) && (atomic_load(&twice) != 0))
+		err = "Timeouts were activated repeatedly";
+
+	for (size_t i = 0; i < TIMEOUTS; i += CANCEL_EVERY) {
+		if ((err == NULL) && (atomic_load(&items[i].fired)))
+			err = "Unregistered timeout was activated";
+	}
+
+	if (count < expected) {
+		/*
+		 * A handler might still be running, better leak
+		 * the items than let it touch freed memory.
+		 */
+		return "Timeouts were not activated in time";
+	}
+
+	free(items);
+	return err;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <test.h>
+#include <arch.h>
+#include <atomic.h>
+#include <stdlib.h>
+#include <proc/thread.h>
+#include <time/timeout.h>
+
+#define THREADS       8
+#define PER_THREAD    4096
+#define ROUNDS        8
+#define SPREAD_US     500000
+#define LONG_US       300000000
+#define WAIT_SECONDS  30
+
+struct worker;
+
+typedef struct {
+	timeout_t timeout;
+	struct worker *worker;
+} item_t;
+
+typedef struct worker {
+	item_t items[PER_THREAD];
+	atomic_size_t fired;
+	const char *err;
+} worker_t;
+
+static atomic_size_t threads_finished;
+
+static void handler(void *arg)
+{
+	item_t *item = (item_t *) arg;
+	atomic_inc(&item->worker->fired);
+}
+
+static const char *worker_round(worker_t *worker, unsigned int round)
+{
+	atomic_store(&worker->fired, 0);
+
+	/* Even items expire, odd items are cancelled before they do */
+	for (size_t i = 0; i < PER_THREAD; i++) {
+		item_t *item = &worker->items[i];
+
+		timeout_initialize(&item->timeout);
+		item->worker = worker;
+
+		uint64_t time = (i % 2 == 0) ?
+		    ((i + round) * 977) % SPREAD_US : LONG_US + i;
+		timeout_register(&item->timeout, time, handler, item);
+
+		/* Let the thread wander to other CPUs */
+		if (i % 1024 == 0)
+			thread_usleep(1000);
+	}
+
+	for (size_t i = 1; i < PER_THREAD; i += 2) {
+		if (!timeout_unregister(&worker->items[i].timeout))
+			return "Unable to unregister pending timeout";
+	}
+
+	for (unsigned int sec = 0; sec < WAIT_SECONDS; sec++) {
+		if (atomic_load(&worker->fired) >= PER_THREAD / 2)
+			break;
+
+		thread_sleep(1);
+	}
+
+	if (atomic_load(&worker->fired) != PER_THREAD / 2)
+		return "Unexpected number of timeouts activated";
+
+	return NULL;
+}
+
+static void worker_fn(void *arg)
+{
+	worker_t *worker = (worker_t *) arg;
+
+	thread_detach(THREAD);
+
+	for (unsigned int round = 0; round < ROUNDS; round++) {
+		worker->err = worker_round(worker, round);
+		if (worker->err != NULL)
+			break;
+	}
+
+	atomic_inc(&threads_finished);
+}
+
+const char *test_timeout2(void)
+{
+	worker_t *workers[THREADS];
+	size_t total = 0;
+
+	atomic_store(&threads_finished, 0);
+
+	TPRINTF("Running %d threads with %d timeouts each...\n",
+	    THREADS, PER_THREAD);
+
+	for (unsigned int i = 0; i < THREADS; i++) {
+		workers[i] = malloc(sizeof(worker_t));
+		if (workers[i] == NULL) {
+			TPRINTF("Could not allocate worker %u\n", i);
+			break;
+		}
+
+		workers[i]->err = NULL;
+
+		thread_t *thread = thread_create(worker_fn, workers[i], TASK,
+		    THREAD_FLAG_NONE, "timeout2");
+		if (thread == NULL) {
+			TPRINTF("Could not create thread %u\n", i);
+			free(workers[i]);
+			break;
+		}
+
+		thread_ready(thread);
+		total++;
+	}
+
+	while (atomic_load(&threads_finished) < total) {
+		TPRINTF("Threads left: %zu\n",
+		    total - atomic_load(&threads_finished));
+		thread_sleep(1);
+	}
+
+	const char *err = NULL;
+	for (size_t i = 0; i < total; i++) {
+		if ((err == NULL) && (workers[i]->err != NULL))
+			err = workers[i]->err;
+
+		/* Leak the worker if its timeouts might still fire */
+		if (workers[i]->err == NULL)
+			free(workers[i]);
+	}
+
+	if ((err == NULL) && (total != THREADS))
+		err = "Unable to create all threads";
+
+	return err;
+}
@@ -80,13 +80,20 @@ def read_obdump(inp):
 
 	return {'text' : funcs, 'bss' : bss, 'data' : data}
 
+def name_hash(name):
+	"FNV-1a hash of a symbol name, must match symtab_hash() in the kernel"
+
+	value = 0x811c9dc5
+	for byte in bytearray(name):
+		value = ((value ^ byte) * 0x01000193) & 0xffffffff
+
+	return value
+
 def generate(kmapf, obmapf, out):
 	"Generate output file"
 
 	obdump = read_obdump(obmapf)
-
-	def key_sorter(x):
-		return x[0]
+	entries = []
 
 	for line in kmapf:
 		line = line.strip()
@@ -95,16 +102,35 @@ def generate(kmapf, obmapf, out):
 		if ((res) and (res.group(3) in obdump[res.group(1)])):
 			offset = int(res.group(2), 16)
 			fname = res.group(3)
-			symbols = obdump[res.group(1)][fname]
-			symbols.sort(key = key_sorter)
-			for addr, symbol in symbols:
+			for addr, symbol in obdump[res.group(1)][fname]:
 				value = fname + ':' + symbol
 				value_bytes = value.encode('ascii')
-				data = struct.pack(symtabfmt, addr + offset, value_bytes[:MAXSTRING])
-				out.write(data)
+				entries.append((addr + offset, value_bytes[:MAXSTRING]))
+
+	# The kernel looks up addresses by binary search
+	entries.sort()
+
+	for addr, name in entries:
+		out.write(struct.pack(symtabfmt, addr, name))
 
 	out.write(struct.pack(symtabfmt, 0, b''))
 
+	# Name index: bucket heads and chain links of 1-based entry indices
+	buckets = 1
+	while (buckets < len(entries)):
+		buckets *= 2
+
+	heads = [0] * buckets
+	chain = [0] * len(entries)
+	for idx in range(len(entries) - 1, -1, -1):
+		bucket = name_hash(entries[idx][1]) & (buckets - 1)
+		chain[idx] = heads[bucket]
+		heads[bucket] = idx + 1
+
+	out.write(struct.pack("<II", buckets, len(entries)))
+	out.write(struct.pack("<%dI" % buckets, *heads))
+	out.write(struct.pack("<%dI" % len(entries), *chain))
+
 def main():
 	if (len(sys.argv) != 4):
 		print("Usage: %s <kernel.map> <nm dump> <output.bin>" % sys.argv[0])
@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2026 yfx contributors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# - Redistributions of source code must retain the above copyright
+#   notice, this list of conditions and the following disclaimer.
+# - Redistributions in binary form must reproduce the above copyright
+#   notice, this list of conditions and the following disclaimer in the
+#   documentation and/or other materials provided with the distribution.
+# - The name of the author may not be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+# IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+# OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+# NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+"""
+Create compressed RAM disk image
+
+The image is split into blocks which are compressed independently
+(raw deflate), so that the RAM disk server can decompress any block
+on demand. The header is followed by an index of block offsets.
+"""
+
+from collections import deque
+import os
+import sys
+import xstruct
+import zlib
+
+RDZ_HEADER = """little:
+	uint32_t magic          /* RDZ_MAGIC */
+	uint32_t version        /* RDZ_VERSION */
+	uint32_t block_size     /* Size of uncompressed block */
+	uint32_t block_count    /* Number of blocks */
+	uint64_t image_size     /* Size of uncompressed image */
+"""
+
+RDZ_MAGIC = 0x5a445248	# 'HRDZ'
+RDZ_VERSION = 1
+
+RDZ_OFFSET = """little:
+	uint64_t offset         /* Offset of compressed block from image start */
+"""
+
+def main():
+	args = deque(sys.argv)
+	cmd_name = args.popleft()
+	base_name = os.path.basename(cmd_name)
+	block_size = 65536
+
+	while len(args) >= 2 and args[0][0] == '-':
+		opt = args.popleft()[1:]
+		optarg = args.popleft()
+
+		if opt == 'bs':
+			block_size = (int)(optarg, 0)
+		else:
+			print(base_name + ": Unrecognized option.")
+			print_syntax(cmd_name)
+			return
+
+	if len(args) < 2:
+		print(base_name + ": Argument missing.")
+		print_syntax(cmd_name)
+		return
+
+	inf_name = args[0]
+	outf_name = args[1]
+
+	try:
+		mkrdz(inf_name, outf_name, block_size)
+	except:
+		os.remove(outf_name)
+		raise
+
+def mkrdz(inf_name, outf_name, block_size):
+	inf = open(inf_name, 'rb')
+	outf = open(outf_name, 'wb')
+
+	data = inf.read()
+	inf.close()
+
+	block_count = (len(data) + block_size - 1) // block_size
+
+	header = xstruct.create(RDZ_HEADER)
+	header.magic = RDZ_MAGIC
+	header.version = RDZ_VERSION
+	header.block_size = block_size
+	header.block_count = block_count
+	header.image_size = len(data)
+
+	entry = xstruct.create(RDZ_OFFSET)
+	offset = header.size() + (block_count + 1) * entry.size()
+
+	blocks = []
+	offsets = []
+	for i in range(block_count):
+		comp = zlib.compressobj(9, zlib.DEFLATED, -15)
+		block = comp.compress(data[i * block_size:(i + 1) * block_size])
+		block += comp.flush()
+
+		offsets.append(offset)
+		blocks.append(block)
+		offset += len(block)
+
+	offsets.append(offset)
+
+	outf.write(header.pack())
+	for offset in offsets:
+		entry.offset = offset
+		outf.write(entry.pack())
+
+	for block in blocks:
+		outf.write(block)
+
+	outf.close()
+
+## Print command-line syntax.
+#
+def print_syntax(cmd):
+	print("syntax: " + cmd + " [<options>] <raw_image> <compressed_image>")
+	print()
+	print("\traw_image\t\tInput RAM disk image")
+	print("\tcompressed_image\tOutput compressed RAM disk image")
+	print()
+	print("options:")
+	print("\t-bs <size>\tBlock size (default: 65536)")
+
+if __name__ == '__main__':
+	main()
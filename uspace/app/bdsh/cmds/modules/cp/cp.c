@@ -27,12 +27,15 @@
  */
 
 #include <errno.h>
+#include <fcopy.h>
 #include <str_error.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <io/console.h>
 #include <io/keycode.h>
 #include <getopt.h>
+#include <macros.h>
+#include <stdbool.h>
 #include <str.h>
 #include <vfs/vfs.h>
 #include <dirent.h>
@@ -66,8 +69,10 @@ typedef enum {
 	TYPE_DIR
 } dentry_type_t;
 
-static int copy_file(const char *src, const char *dest,
+static errno_t copy_file(const char *src, const char *dest,
     size_t blen, int vb);
+static errno_t copy_tree(const char *src, const char *dest,
+    size_t blen, int vb, int force);
 
 /** Get the type of a directory entry.
  *
@@ -270,9 +275,7 @@ static errno_t do_copy(const char *src, const char *dest,
 		}
 
 		/* call copy_file and exit */
-		if (copy_file(src, dest_path, blen, vb) < 0) {
-			rc = EIO;
-		}
+		rc = copy_file(src, dest_path, blen, vb);
 
 	} else if (src_type == TYPE_DIR) {
 		/* e.g. cp -r /x/srcdir /y/destdir/ */
@@ -334,6 +337,12 @@ static errno_t do_copy(const char *src, const char *dest,
 			break;
 		}
 
+		if (!interactive) {
+			/* Nothing to ask, let the copy engine do the work */
+			rc = copy_tree(src, dest_path, blen, vb, force);
+			goto exit;
+		}
+
 		dir = opendir(src);
 		if (!dir) {
 			/* Something strange is happening... */
@@ -390,72 +399,78 @@ exit:
 	return rc;
 }
 
-static int copy_file(const char *src, const char *dest,
-    size_t blen, int vb)
+static void copy_cb_copy(void *arg, const char *src, const char *dest,
+    bool dir)
 {
-	int fd1, fd2;
-	size_t rbytes, wbytes;
-	errno_t rc;
-	off64_t total;
-	char *buff = NULL;
-	aoff64_t posr = 0, posw = 0;
-	vfs_stat_t st;
-
-	if (vb)
-		printf("Copying %s to %s\n", src, dest);
+	printf("copy %s %s\n", src, dest);
+}
 
-	rc = vfs_lookup_open(src, WALK_REGULAR, MODE_READ, &fd1);
-	if (rc != EOK) {
-		printf("Unable to open source file %s\n", src);
-		return -1;
+static void copy_cb_error(void *arg, const char *src, const char *dest,
+    errno_t rc)
+{
+	switch (rc) {
+	case ELOOP:
+		printf("Cannot copy a directory into itself\n");
+		break;
+	case EEXIST:
+		printf("File already exists: %s\n", dest);
+		break;
+	default:
+		printf("\nError copying %s: %s\n", src, str_error(rc));
+		break;
 	}
+}
 
-	rc = vfs_lookup_open(dest, WALK_REGULAR | WALK_MAY_CREATE, MODE_WRITE, &fd2);
-	if (rc != EOK) {
-		printf("Unable to open destination file %s\n", dest);
-		vfs_put(fd1);
-		return -1;
-	}
+static fcopy_cb_t copy_cb = {
+	.error = copy_cb_error
+};
 
-	if (vfs_stat(fd1, &st) != EOK) {
-		printf("Unable to fstat %d\n", fd1);
-		vfs_put(fd1);
-		vfs_put(fd2);
-		return -1;
-	}
+static fcopy_cb_t copy_cb_verbose = {
+	.copy = copy_cb_copy,
+	.error = copy_cb_error
+};
 
-	total = st.size;
-	if (vb)
-		printf("%" PRIu64 " bytes to copy\n", total);
+/** Set up the copy engine.
+ *
+ * @param cfg		Configuration to fill in.
+ * @param blen		Minimum buffer size.
+ * @param vb		Print each copied entry.
+ * @param overwrite	Overwrite existing files.
+ */
+static void copy_cfg_init(fcopy_cfg_t *cfg, size_t blen, int vb,
+    bool overwrite)
+{
+	fcopy_cfg_init(cfg);
+	cfg->buf_size = max(blen, cfg->buf_size);
+	cfg->overwrite = overwrite;
+	cfg->cb = vb ? &copy_cb_verbose : &copy_cb;
+}
 
-	if (NULL == (buff = (char *) malloc(blen))) {
-		printf("Unable to allocate enough memory to read %s\n",
-		    src);
-		rc = ENOMEM;
-		goto out;
-	}
+static errno_t copy_file(const char *src, const char *dest,
+    size_t blen, int vb)
+{
+	fcopy_cfg_t cfg;
 
-	while ((rc = vfs_read(fd1, &posr, buff, blen, &rbytes)) == EOK &&
-	    rbytes > 0) {
-		if ((rc = vfs_write(fd2, &posw, buff, rbytes, &wbytes)) != EOK)
-			break;
-	}
+	/* An existing destination has been dealt with already */
+	copy_cfg_init(&cfg, blen, vb, true);
+	return fcopy_file(&cfg, src, dest);
+}
 
-	if (rc != EOK) {
-		printf("\nError copying %s: %s\n", src, str_error(rc));
-		return -1;
-	}
+/** Copy contents of a directory with several files in flight.
+ *
+ * @param src		Source directory.
+ * @param dest		Destination directory.
+ * @param blen		Minimum buffer size.
+ * @param vb		Print each copied entry.
+ * @param force		Overwrite existing files.
+ */
+static errno_t copy_tree(const char *src, const char *dest,
+    size_t blen, int vb, int force)
+{
+	fcopy_cfg_t cfg;
 
-out:
-	vfs_put(fd1);
-	vfs_put(fd2);
-	if (buff)
-		free(buff);
-	if (rc != EOK) {
-		return -1;
-	} else {
-		return 0;
-	}
+	copy_cfg_init(&cfg, blen, vb, force);
+	return fcopy_tree(&cfg, src, dest);
 }
 
 void help_cmd_cp(unsigned int level)
@@ -469,7 +484,7 @@ void help_cmd_cp(unsigned int level)
 	    "  -f, --force      Do not complain when <dest> exists (overrides a previous -i)\n"
 	    "  -i, --interactive Ask what to do when <dest> exists (overrides a previous -f)\n"
 	    "  -r, --recursive  Copy entire directories\n"
-	    "  -b, --buffer ## Set the read buffer size to ##\n";
+	    "  -b, --buffer ## Set the minimum copy buffer size to ##\n";
 	if (level == HELP_SHORT) {
 		printf("`%s' copies files and directories\n", cmdname);
 	} else {
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup bootchart
+ * @{
+ */
+/** @file Print boot timeline.
+ *
+ * Reads the boot milestones recorded by the kernel and by user space
+ * (see abi/bootmark.h) and prints them as a Gantt-style chart. A pair of
+ * milestones named "start <what>" and "done <what>" reported by the same
+ * task forms a bar, all other milestones are single points in time.
+ */
+
+#include <abi/bootmark.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stats.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <sysinfo.h>
+
+#define NAME  "bootchart"
+
+/** Default width of the chart in characters */
+#define CHART_WIDTH_DEFAULT  40
+/** Maximum width of the chart in characters */
+#define CHART_WIDTH_MAX  200
+
+#define START_PREFIX  "start "
+#define DONE_PREFIX  "done "
+
+/** One row of the chart */
+typedef struct {
+	/** Milestone starting the row */
+	bootmark_t *mark;
+	/** Label of the row */
+	const char *label;
+	/** Start time in microseconds */
+	uint64_t start;
+	/** End time in microseconds */
+	uint64_t end;
+	/** Row is a bar (as opposed to a point) */
+	bool bar;
+	/** Bar has been closed by a matching "done" milestone */
+	bool closed;
+} chart_row_t;
+
+static void print_syntax(void)
+{
+	printf("Syntax: %s [-r] [-w <width>]\n", NAME);
+	printf("\t-r          Print raw milestones, one per line\n");
+	printf("\t-w <width>  Width of the chart (default %d)\n",
+	    CHART_WIDTH_DEFAULT);
+}
+
+/** Find open bar which a "done" milestone closes.
+ *
+ * @param rows Rows
+ * @param nrows Number of rows
+ * @param mark The "done" milestone
+ * @return Matching row or @c NULL
+ */
+static chart_row_t *find_open_bar(chart_row_t *rows, size_t nrows,
+    bootmark_t *mark)
+{
+	const char *label = mark->name + str_length(DONE_PREFIX);
+	size_t i;
+
+	for (i = nrows; i > 0; i--) {
+		chart_row_t *row = &rows[i - 1];
+
+		if (row->bar && !row->closed &&
+		    row->mark->task_id == mark->task_id &&
+		    str_cmp(row->label, label) == 0)
+			return row;
+	}
+
+	return NULL;
+}
+
+/** Get name of the task which recorded a milestone.
+ *
+ * @param task_id Task ID
+ * @param buf Buffer for the name
+ * @param size Size of @a buf
+ */
+static void task_name(task_id_t task_id, char *buf, size_t size)
+{
+	stats_task_t *task;
+
+	if (task_id == 0) {
+		str_cpy(buf, size, "kernel");
+		return;
+	}
+
+	task = stats_get_task(task_id);
+	if (task == NULL) {
+		snprintf(buf, size, "%" PRIu64, task_id);
+		return;
+	}
+
+	str_cpy(buf, size, task->name);
+	free(task);
+}
+
+/** Print one row of the chart.
+ *
+ * @param row Row
+ * @param total Time of the last milestone in microseconds
+ * @param width Width of the chart
+ */
+static void print_row(chart_row_t *row, uint64_t total, size_t width)
+{
+	char chart[CHART_WIDTH_MAX + 1];
+	char tname[TASK_NAME_BUFLEN];
+	size_t first, last;
+	size_t i;
+
+	first = total > 0 ? row->start * width / total : 0;
+	last = total > 0 ? row->end * width / total : 0;
+	if (first >= width)
+		first = width - 1;
+	if (last >= width)
+		last = width - 1;
+
+	for (i = 0; i < width; i++) {
+		if (i < first || i > last)
+			chart[i] = ' ';
+		else if (!row->bar)
+			chart[i] = '|';
+		else if (i == last && !row->closed)
+			chart[i] = '>';
+		else
+			chart[i] = '=';
+	}
+	chart[width] = '\0';
+
+	task_name(row->mark->task_id, tname, sizeof(tname));
+
+	printf("%8" PRIu64 " %8" PRIu64 " |%s| %-12s %s\n",
+	    row->start / 1000, (row->end - row->start) / 1000, chart, tname,
+	    row->bar ? row->label : row->mark->name);
+}
+
+int main(int argc, char *argv[])
+{
+	bootmark_t *marks;
+	chart_row_t *rows;
+	chart_row_t *row;
+	size_t nmarks, nrows;
+	size_t size;
+	size_t width = CHART_WIDTH_DEFAULT;
+	uint64_t total;
+	bool raw = false;
+	char *endptr;
+	size_t i;
+	int c;
+
+	while ((c = getopt(argc, argv, "hrw:")) != -1) {
+		switch (c) {
+		case 'r':
+			raw = true;
+			break;
+		case 'w':
+			width = strtoul(optarg, &endptr, 10);
+			if (*endptr != '\0' || width == 0 ||
+			    width > CHART_WIDTH_MAX) {
+				printf("%s: Invalid width '%s'.\n", NAME,
+				    optarg);
+				return 1;
+			}
+			break;
+		case 'h':
+		default:
+			print_syntax();
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind < argc) {
+		print_syntax();
+		return 1;
+	}
+
+	marks = sysinfo_get_data(BOOTMARK_SYSINFO, &size);
+	if (marks == NULL) {
+		printf("%s: No boot timeline available.\n", NAME);
+		return 1;
+	}
+
+	nmarks = size / sizeof(bootmark_t);
+
+	if (raw) {
+		for (i = 0; i < nmarks; i++) {
+			printf(BOOTMARK_LOG_PREFIX " %" PRIu64 " %" PRIu64
+			    " %s\n", marks[i].time, marks[i].task_id,
+			    marks[i].name);
+		}
+
+		free(marks);
+		return 0;
+	}
+
+	rows = calloc(nmarks, sizeof(chart_row_t));
+	if (rows == NULL) {
+		printf("%s: Out of memory.\n", NAME);
+		free(marks);
+		return 1;
+	}
+
+	nrows = 0;
+	total = 0;
+
+	for (i = 0; i < nmarks; i++) {
+		bootmark_t *mark = &marks[i];
+
+		/* Make sure the name is terminated */
+		mark->name[BOOTMARK_NAME_SIZE - 1] = '\0';
+
+		if (mark->time > total)
+			total = mark->time;
+
+		if (str_lcmp(mark->name, DONE_PREFIX,
+		    str_length(DONE_PREFIX)) == 0) {
+			row = find_open_bar(rows, nrows, mark);
+			if (row != NULL) {
+				row->end = mark->time;
+				row->closed = true;
+				continue;
+			}
+		}
+
+		row = &rows[nrows++];
+		row->mark = mark;
+		row->start = mark->time;
+		row->end = mark->time;
+
+		if (str_lcmp(mark->name, START_PREFIX,
+		    str_length(START_PREFIX)) == 0) {
+			row->bar = true;
+			row->label = mark->name + str_length(START_PREFIX);
+		} else {
+			row->label = mark->name;
+		}
+	}
+
+	/* Bars which were never closed extend to the end of the chart */
+	for (i = 0; i < nrows; i++) {
+		if (rows[i].bar && !rows[i].closed)
+			rows[i].end = total;
+	}
+
+	printf("%8s %8s  %-*s  %-12s %s\n", "start", "length", (int) width,
+	    "timeline (ms)", "task", "milestone");
+
+	for (i = 0; i < nrows; i++)
+		print_row(&rows[i], total, width);
+
+	printf("Total: %" PRIu64 " ms, %zu milestones\n", total / 1000, nmarks);
+
+	free(rows);
+	free(marks);
+	return 0;
+}
+
+/** @}
+ */
@@ -0,0 +1,4 @@
+/** @addtogroup bootchart bootchart
+ * @brief Print boot timeline
+ * @ingroup apps
+ */
@@ -26,6 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <__bits/test/bench.hpp>
 #include <__bits/test/tests.hpp>
 
 /* using namespace std::chrono_literals; */
@@ -63,6 +64,7 @@
 #include <list>
 #include <locale>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <new>
 #include <numeric>
@@ -100,8 +102,74 @@
 
 #include <__bits/trycatch.hpp>
 
-int main()
+static void print_usage(const char *name)
 {
+    std::printf("Usage: %s [--startup-only]\n", name);
+    std::printf("       %s --bench [--size N] [--runs N] [-o filename.csv]\n", name);
+}
+
+/** Runs the benchmarks instead of the tests.
+ *
+ * The CSV report uses the columns of hbench with an extra
+ * column with the number of allocations.
+ */
+static int run_benchmarks(int argc, char *argv[])
+{
+    std::test::bench_config config{};
+    const char *csv_name = nullptr;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            config.size = ::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            config.runs = ::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            csv_name = argv[++i];
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (csv_name)
+    {
+        config.csv = std::fopen(csv_name, "w");
+        if (!config.csv)
+        {
+            std::fprintf(stderr, "Failed to open CSV report '%s'\n", csv_name);
+            return 1;
+        }
+    }
+
+    std::test::bench_set bs{};
+    bs.add<std::test::containers_bench>();
+    bs.add<std::test::runtime_bench>();
+
+    bool res = bs.run(config);
+
+    if (config.csv)
+        std::fclose(config.csv);
+
+    return res ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    /* Used to measure program start-up time */
+    if (argc > 1 && std::strcmp(argv[1], "--startup-only") == 0)
+        return 0;
+
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+        return run_benchmarks(argc, argv);
+
+    if (argc > 1)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
     std::test::test_set ts{};
     ts.add<std::test::vector_test>();
     ts.add<std::test::string_test>();
@@ -116,11 +184,14 @@ int main()
     ts.add<std::test::numeric_test>();
     ts.add<std::test::adaptors_test>();
     ts.add<std::test::memory_test>();
+    ts.add<std::test::memory_resource_test>();
     ts.add<std::test::list_test>();
     ts.add<std::test::ratio_test>();
     ts.add<std::test::functional_test>();
     ts.add<std::test::algorithm_test>();
     ts.add<std::test::future_test>();
+    ts.add<std::test::regex_test>();
+    ts.add<std::test::iostream_test>();
 
     return ts.run(true) ? 0 : 1;
 }
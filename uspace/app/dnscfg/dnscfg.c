@@ -37,6 +37,7 @@
 #include <errno.h>
 #include <inet/addr.h>
 #include <inet/dnsr.h>
+#include <inttypes.h>
 #include <ipc/services.h>
 #include <loc.h>
 #include <stdio.h>
@@ -53,6 +54,8 @@ static void print_syntax(void)
 	printf("\t%s get-ns\n", NAME);
 	printf("\t%s set-ns <server-addr>\n", NAME);
 	printf("\t%s unset-ns\n", NAME);
+	printf("\t%s cache-stats\n", NAME);
+	printf("\t%s set-cache-size <entries>\n", NAME);
 }
 
 static errno_t dnscfg_set_ns(int argc, char *argv[])
@@ -125,6 +128,55 @@ static errno_t dnscfg_print(void)
 	return EOK;
 }
 
+static errno_t dnscfg_cache_stats(void)
+{
+	dnsr_cache_stats_t stats;
+	errno_t rc = dnsr_get_cache_stats(&stats);
+	if (rc != EOK) {
+		printf("%s: Failed getting cache statistics (%s)\n", NAME,
+		    str_error(rc));
+		return rc;
+	}
+
+	uint64_t lookups = stats.hits + stats.neg_hits + stats.misses;
+
+	printf("Entries:        %" PRIu64 "/%" PRIu64 "\n", stats.entries,
+	    stats.max_entries);
+	printf("Hits:           %" PRIu64 "\n", stats.hits);
+	printf("Negative hits:  %" PRIu64 "\n", stats.neg_hits);
+	printf("Misses:         %" PRIu64 "\n", stats.misses);
+	printf("Coalesced:      %" PRIu64 "\n", stats.coalesced);
+	printf("Evictions:      %" PRIu64 "\n", stats.evictions);
+	printf("Hit ratio:      %" PRIu64 "%%\n", lookups != 0 ?
+	    100 * (stats.hits + stats.neg_hits) / lookups : 0);
+	return EOK;
+}
+
+static errno_t dnscfg_set_cache_size(int argc, char *argv[])
+{
+	if (argc != 1) {
+		printf("%s: Wrong number of arguments.\n", NAME);
+		print_syntax();
+		return EINVAL;
+	}
+
+	char *endptr;
+	unsigned long size = strtoul(argv[0], &endptr, 10);
+	if (*argv[0] == '\0' || *endptr != '\0') {
+		printf("%s: Invalid cache size '%s'.\n", NAME, argv[0]);
+		return EINVAL;
+	}
+
+	errno_t rc = dnsr_set_cache_size(size);
+	if (rc != EOK) {
+		printf("%s: Failed setting cache size (%s)\n", NAME,
+		    str_error(rc));
+		return rc;
+	}
+
+	return EOK;
+}
+
 int main(int argc, char *argv[])
 {
 	if ((argc < 2) || (str_cmp(argv[1], "get-ns") == 0))
@@ -133,6 +185,10 @@ int main(int argc, char *argv[])
 		return dnscfg_set_ns(argc - 2, argv + 2);
 	else if (str_cmp(argv[1], "unset-ns") == 0)
 		return dnscfg_unset_ns();
+	else if (str_cmp(argv[1], "cache-stats") == 0)
+		return dnscfg_cache_stats();
+	else if (str_cmp(argv[1], "set-cache-size") == 0)
+		return dnscfg_set_cache_size(argc - 2, argv + 2);
 	else {
 		printf("%s: Unknown command '%s'.\n", NAME, argv[1]);
 		print_syntax();
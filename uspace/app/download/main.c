@@ -42,7 +42,10 @@
 #include <str_error.h>
 #include <task.h>
 #include <macros.h>
+#include <mem.h>
 
+#include <crypto.h>
+#include <gzip.h>
 #include <http/http.h>
 #include <uri.h>
 
@@ -54,13 +57,104 @@
 #endif
 #define USER_AGENT "HelenOS-" NAME "/" VERSION
 
+/** Write received data to the output file, hashing it if requested.
+ *
+ * @param buf   Data
+ * @param size  Size of data in bytes
+ * @param ofile Output file
+ * @param hash  Hash context or @c NULL
+ */
+static void download_write(const void *buf, size_t size, FILE *ofile,
+    hash_ctx_t *hash)
+{
+	fwrite(buf, 1, size, ofile);
+	if (hash != NULL)
+		hash_update(hash, buf, size);
+}
+
+/** Parse expected SHA-256 digest given in hexadecimal.
+ *
+ * @param str    Hexadecimal string
+ * @param digest Place to store the digest
+ * @return EOK on success, EINVAL if @a str is not a SHA-256 digest
+ */
+static errno_t download_parse_digest(const char *str, uint8_t *digest)
+{
+	if (str_length(str) != 2 * HASH_SHA256)
+		return EINVAL;
+
+	for (size_t i = 0; i < 2 * HASH_SHA256; i++) {
+		char c = str[i];
+		uint8_t val;
+
+		if (c >= '0' && c <= '9')
+			val = c - '0';
+		else if (c >= 'a' && c <= 'f')
+			val = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			val = c - 'A' + 10;
+		else
+			return EINVAL;
+
+		if (i % 2 == 0)
+			digest[i / 2] = val << 4;
+		else
+			digest[i / 2] |= val;
+	}
+
+	return EOK;
+}
+
+/** Read compressed response body for the decompressor. */
+static errno_t download_gzip_read(void *arg, void *buf, size_t size,
+    size_t *nread)
+{
+	http_t *http = (http_t *) arg;
+
+	return recv_buffer(&http->recv_buffer, buf, size, nread);
+}
+
+/** Receive response body and decompress it on the fly.
+ *
+ * @param http    HTTP connection with the response headers received
+ * @param buf     Buffer for decompressed data
+ * @param buf_size Size of @a buf in bytes
+ * @param ofile   Output file
+ * @param hash    Hash context for the decompressed data or @c NULL
+ * @return EOK on success or an error code
+ */
+static errno_t download_gzip(http_t *http, void *buf, size_t buf_size,
+    FILE *ofile, hash_ctx_t *hash)
+{
+	gzip_reader_t *reader;
+	size_t nread;
+	errno_t rc;
+
+	rc = gzip_reader_create(download_gzip_read, http, &reader);
+	if (rc != EOK)
+		return rc;
+
+	do {
+		rc = gzip_reader_read(reader, buf, buf_size, &nread);
+		if (rc != EOK)
+			break;
+
+		download_write(buf, nread, ofile, hash);
+	} while (nread == buf_size);
+
+	gzip_reader_destroy(reader);
+	return rc;
+}
+
 static void syntax_print(void)
 {
-	fprintf(stderr, "Usage: download [-o <outfile>] <url>\n");
+	fprintf(stderr, "Usage: download [-o <outfile>] [-s <sha256>] <url>\n");
 	fprintf(stderr, "  Without -o, data will be written to stdout, so you may want\n");
 	fprintf(stderr, "  to redirect the output, e.g.\n");
 	fprintf(stderr, "\n");
 	fprintf(stderr, "    download http://helenos.org/ | to helenos.html\n\n");
+	fprintf(stderr, "  With -s, the downloaded data is checked against the given\n");
+	fprintf(stderr, "  hexadecimal SHA-256 digest while it is being received.\n\n");
 }
 
 int main(int argc, char *argv[])
@@ -72,6 +166,10 @@ int main(int argc, char *argv[])
 	void *buf = NULL;
 	uri_t *uri = NULL;
 	http_t *http = NULL;
+	hash_ctx_t hash;
+	hash_ctx_t *phash = NULL;
+	uint8_t digest[HASH_SHA256];
+	uint8_t expected[HASH_SHA256];
 	errno_t rc;
 	int ret;
 
@@ -83,21 +181,38 @@ int main(int argc, char *argv[])
 
 	i = 1;
 
-	if (str_cmp(argv[i], "-o") == 0) {
-		++i;
-		if (argc < i + 1) {
+	while (i < argc && argv[i][0] == '-') {
+		if (argc < i + 2) {
 			syntax_print();
 			rc = EINVAL;
 			goto error;
 		}
 
-		ofname = argv[i++];
-		ofile = fopen(ofname, "wb");
-		if (ofile == NULL) {
-			fprintf(stderr, "Error creating '%s'.\n", ofname);
+		if (str_cmp(argv[i], "-o") == 0 && ofile == NULL) {
+			ofname = argv[i + 1];
+			ofile = fopen(ofname, "wb");
+			if (ofile == NULL) {
+				fprintf(stderr, "Error creating '%s'.\n", ofname);
+				rc = EINVAL;
+				goto error;
+			}
+		} else if (str_cmp(argv[i], "-s") == 0 && phash == NULL) {
+			if (download_parse_digest(argv[i + 1], expected) != EOK) {
+				fprintf(stderr, "Invalid SHA-256 digest '%s'.\n",
+				    argv[i + 1]);
+				rc = EINVAL;
+				goto error;
+			}
+
+			(void) hash_init(&hash, HASH_SHA256);
+			phash = &hash;
+		} else {
+			syntax_print();
 			rc = EINVAL;
 			goto error;
 		}
+
+		i += 2;
 	}
 
 	if (argc != i + 1) {
@@ -183,6 +298,12 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
+	rc = http_headers_append(&req->headers, "Accept-Encoding", "gzip");
+	if (rc != EOK) {
+		fprintf(stderr, "Failed creating Accept-Encoding header: %s\n", str_error(rc));
+		goto error;
+	}
+
 	http = http_create(uri->host, port);
 	if (http == NULL) {
 		fprintf(stderr, "Failed creating HTTP object\n");
@@ -224,13 +345,28 @@ int main(int argc, char *argv[])
 			goto error;
 		}
 
-		size_t body_size;
-		while ((rc = recv_buffer(&http->recv_buffer, buf, buf_size, &body_size)) == EOK && body_size > 0) {
-			fwrite(buf, 1, body_size, ofile != NULL ? ofile : stdout);
+		char *encoding;
+		if (http_headers_get(&response->headers, "Content-Encoding",
+		    &encoding) == EOK && str_casecmp(encoding, "gzip") == 0) {
+			rc = download_gzip(http, buf, buf_size,
+			    ofile != NULL ? ofile : stdout, phash);
+		} else {
+			size_t body_size;
+			while ((rc = recv_buffer(&http->recv_buffer, buf, buf_size, &body_size)) == EOK && body_size > 0) {
+				download_write(buf, body_size,
+				    ofile != NULL ? ofile : stdout, phash);
+			}
 		}
 
 		if (rc != EOK) {
 			fprintf(stderr, "Failed receiving body: %s", str_error(rc));
+		} else if (phash != NULL) {
+			hash_final(phash, digest);
+			if (memcmp(digest, expected, HASH_SHA256) != 0) {
+				fprintf(stderr, "SHA-256 digest mismatch.\n");
+				rc = EIO;
+				goto error;
+			}
 		}
 	}
 
@@ -38,6 +38,7 @@
 #include <task.h>
 #include <str_error.h>
 #include <errno.h>
+#include <io/klog.h>
 #include <loc.h>
 #include <vfs/vfs.h>
 #include <str.h>
@@ -166,6 +167,8 @@ int main(int argc, char *argv[])
 	if (print_msg)
 		welcome_msg_print();
 
+	klog_bootmark("getterm: %s ready", term);
+
 	task_id_t id;
 	task_wait_t twait;
 
@@ -43,7 +43,10 @@
 #include <gfx/typeface.h>
 #include <io/console.h>
 #include <io/pixelmap.h>
+#include <memgfx/memgc.h>
+#include <perf.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
 #include <task.h>
@@ -84,6 +87,17 @@ static bool demo_is_text(gfx_coord_t w, gfx_coord_t h)
 	return w <= 80;
 }
 
+/** Show what has been drawn and pause.
+ *
+ * @param gc Graphic context
+ * @param usec Pause duration in microseconds
+ */
+static void demo_pause(gfx_context_t *gc, usec_t usec)
+{
+	(void) gfx_update(gc);
+	fibril_usleep(usec);
+}
+
 /** Clear screen.
  *
  * @param gc Graphic context
@@ -315,7 +329,7 @@ static errno_t demo_rects(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h)
 
 		gfx_color_delete(color);
 
-		fibril_usleep(500 * 1000);
+		demo_pause(gc, 500 * 1000);
 
 		if (quit)
 			break;
@@ -477,7 +491,7 @@ static errno_t demo_bitmap(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h)
 			rc = gfx_bitmap_render(bitmap, &srect, &offs);
 			if (rc != EOK)
 				goto error;
-			fibril_usleep(250 * 1000);
+			demo_pause(gc, 250 * 1000);
 
 			if (quit)
 				goto out;
@@ -538,7 +552,7 @@ static errno_t demo_bitmap2(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h)
 				goto error;
 		}
 
-		fibril_usleep(500 * 1000);
+		demo_pause(gc, 500 * 1000);
 
 		if (quit)
 			break;
@@ -599,7 +613,7 @@ static errno_t demo_bitmap_kc(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h)
 				goto error;
 		}
 
-		fibril_usleep(500 * 1000);
+		demo_pause(gc, 500 * 1000);
 
 		if (quit)
 			break;
@@ -790,7 +804,7 @@ static errno_t demo_text(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h)
 	}
 
 	for (i = 0; i < 10; i++) {
-		fibril_usleep(500 * 1000);
+		demo_pause(gc, 500 * 1000);
 		if (quit)
 			break;
 	}
@@ -887,7 +901,7 @@ static errno_t demo_clip(gfx_context_t *gc, gfx_coord_t w, gfx_coord_t h)
 				goto error;
 		}
 
-		fibril_usleep(500 * 1000);
+		demo_pause(gc, 500 * 1000);
 
 		if (quit)
 			break;
@@ -978,6 +992,171 @@ static errno_t demo_console(void)
 	return EOK;
 }
 
+static void bench_invalidate(void *arg, gfx_rect_t *rect)
+{
+}
+
+static void bench_update(void *arg)
+{
+}
+
+static mem_gc_cb_t bench_mem_gc_cb = {
+	.invalidate = bench_invalidate,
+	.update = bench_update
+};
+
+/** Report result of one benchmark.
+ *
+ * @param name Name of the benchmark
+ * @param pixels Number of pixels drawn
+ * @param sw Stopwatch
+ */
+static void bench_report(const char *name, uint64_t pixels, stopwatch_t *sw)
+{
+	nsec_t nsec = stopwatch_get_nanos(sw);
+
+	if (nsec == 0)
+		nsec = 1;
+
+	/* Pixels per microsecond is Mpixel/s */
+	printf("%-12s %8" PRIu64 " Mpixel/s\n", name,
+	    pixels * 1000 / (uint64_t) nsec);
+}
+
+/** Benchmark bitmap rendering on a graphic context.
+ *
+ * @param gc Graphic context
+ * @param name Name of the benchmark
+ * @param flags Bitmap flags
+ * @param w Width
+ * @param h Height
+ * @param iters Number of iterations
+ */
+static errno_t bench_bitmap(gfx_context_t *gc, const char *name,
+    gfx_bitmap_flags_t flags, gfx_coord_t w, gfx_coord_t h, unsigned iters)
+{
+	gfx_bitmap_t *bitmap;
+	gfx_bitmap_params_t params;
+	stopwatch_t sw;
+	unsigned i;
+	errno_t rc;
+
+	gfx_bitmap_params_init(&params);
+	params.rect.p0.x = 0;
+	params.rect.p0.y = 0;
+	params.rect.p1.x = w;
+	params.rect.p1.y = h;
+	params.flags = flags;
+	params.key_color = PIXEL(0, 255, 0, 255);
+
+	rc = gfx_bitmap_create(gc, &params, NULL, &bitmap);
+	if (rc != EOK)
+		return rc;
+
+	rc = bitmap_circle(bitmap, w, h);
+	if (rc != EOK)
+		goto error;
+
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+
+	for (i = 0; i < iters; i++) {
+		rc = gfx_bitmap_render(bitmap, NULL, NULL);
+		if (rc != EOK)
+			goto error;
+	}
+
+	stopwatch_stop(&sw);
+	bench_report(name, (uint64_t) w * h * iters, &sw);
+
+	gfx_bitmap_destroy(bitmap);
+	return EOK;
+error:
+	gfx_bitmap_destroy(bitmap);
+	return rc;
+}
+
+/** Measure rendering throughput of the memory GC. */
+static errno_t demo_bench(void)
+{
+	mem_gc_t *mgc = NULL;
+	gfx_context_t *gc;
+	gfx_rect_t rect;
+	gfx_bitmap_alloc_t alloc;
+	gfx_color_t *color = NULL;
+	stopwatch_t sw;
+	const unsigned iters = 100;
+	unsigned i;
+	errno_t rc;
+
+	rect.p0.x = 0;
+	rect.p0.y = 0;
+	rect.p1.x = 1024;
+	rect.p1.y = 768;
+
+	alloc.pitch = rect.p1.x * sizeof(uint32_t);
+	alloc.off0 = 0;
+	alloc.pixels = calloc(1, alloc.pitch * rect.p1.y);
+	if (alloc.pixels == NULL) {
+		printf("Out of memory.\n");
+		return ENOMEM;
+	}
+
+	rc = mem_gc_create(&rect, &alloc, &bench_mem_gc_cb, NULL, &mgc);
+	if (rc != EOK) {
+		printf("Error creating memory GC.\n");
+		goto error;
+	}
+
+	gc = mem_gc_get_ctx(mgc);
+
+	rc = gfx_color_new_rgb_i16(0xffff, 0x8000, 0, &color);
+	if (rc != EOK)
+		goto error;
+
+	rc = gfx_set_color(gc, color);
+	if (rc != EOK)
+		goto error;
+
+	stopwatch_init(&sw);
+	stopwatch_start(&sw);
+
+	for (i = 0; i < iters; i++) {
+		rc = gfx_fill_rect(gc, &rect);
+		if (rc != EOK)
+			goto error;
+	}
+
+	stopwatch_stop(&sw);
+	bench_report("fill", (uint64_t) rect.p1.x * rect.p1.y * iters, &sw);
+
+	rc = bench_bitmap(gc, "copy", 0, rect.p1.x, rect.p1.y, iters);
+	if (rc != EOK)
+		goto error;
+
+	rc = bench_bitmap(gc, "color key", bmpf_color_key, rect.p1.x,
+	    rect.p1.y, iters);
+	if (rc != EOK)
+		goto error;
+
+	rc = bench_bitmap(gc, "colorize", bmpf_color_key | bmpf_colorize,
+	    rect.p1.x, rect.p1.y, iters);
+	if (rc != EOK)
+		goto error;
+
+	gfx_color_delete(color);
+	mem_gc_delete(mgc);
+	free(alloc.pixels);
+	return EOK;
+error:
+	if (color != NULL)
+		gfx_color_delete(color);
+	if (mgc != NULL)
+		mem_gc_delete(mgc);
+	free(alloc.pixels);
+	return rc;
+}
+
 /** Run demo on UI. */
 static errno_t demo_ui(const char *display_spec)
 {
@@ -1125,7 +1304,7 @@ static void uiwnd_kbd_event(ui_window_t *window, void *arg, kbd_event_t *event)
 
 static void print_syntax(void)
 {
-	printf("Syntax: gfxdemo [-d <display>] {console|display|ui}\n");
+	printf("Syntax: gfxdemo [-d <display>] {bench|console|display|ui}\n");
 }
 
 int main(int argc, char *argv[])
@@ -1157,6 +1336,10 @@ int main(int argc, char *argv[])
 		rc = demo_display(display_svc);
 		if (rc != EOK)
 			return 1;
+	} else if (str_cmp(argv[i], "bench") == 0) {
+		rc = demo_bench();
+		if (rc != EOK)
+			return 1;
 	} else if (str_cmp(argv[i], "console") == 0) {
 		rc = demo_console();
 		if (rc != EOK)
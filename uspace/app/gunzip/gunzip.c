@@ -37,13 +37,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/** Size of the buffer for decompressed data */
+#define BUF_SIZE  65536
+
+/** Read compressed data from file.
+ *
+ * @param arg   Input file
+ * @param buf   Buffer for data
+ * @param size  Size of @a buf in bytes
+ * @param nread Place to store number of bytes read
+ * @return EOK on success, EIO on read error
+ */
+static errno_t gunzip_read(void *arg, void *buf, size_t size, size_t *nread)
+{
+	FILE *f = (FILE *) arg;
+
+	*nread = fread(buf, 1, size, f);
+	if (*nread < size && ferror(f))
+		return EIO;
+
+	return EOK;
+}
+
 int main(int argc, char *argv[])
 {
 	errno_t rc;
-	void *data, *ddata;
-	size_t size, dsize;
+	gzip_reader_t *reader;
+	void *buf;
 	size_t nread, nwr;
-	long len;
 	FILE *f, *wf;
 
 	if (argc != 3) {
@@ -57,61 +78,46 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	if (fseek(f, 0, SEEK_END) < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	len = ftell(f);
-	if (len < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	if (fseek(f, 0, SEEK_SET) < 0) {
-		printf ("Error rewinding '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	data = malloc(len);
-	if (data == NULL) {
-		printf("Error allocating %ld bytes.\n", len);
+	buf = malloc(BUF_SIZE);
+	if (buf == NULL) {
+		printf("Error allocating %d bytes.\n", BUF_SIZE);
 		fclose(f);
 		return 1;
 	}
 
-	nread = fread(data, 1, len, f);
-	if (nread != (size_t)len) {
-		printf("Error reading '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	fclose(f);
-
-	size = (size_t) len;
-
-	rc = gzip_expand(data, size, &ddata, &dsize);
+	rc = gzip_reader_create(gunzip_read, f, &reader);
 	if (rc != EOK) {
 		printf("Error decompressing data.\n");
+		fclose(f);
 		return 1;
 	}
 
 	wf = fopen(argv[2], "wb");
 	if (wf == NULL) {
 		printf("Error creating file '%s'\n", argv[2]);
+		gzip_reader_destroy(reader);
+		fclose(f);
 		return 1;
 	}
 
-	nwr = fwrite(ddata, 1, dsize, wf);
-	if (nwr != dsize) {
-		printf("Error writing '%s'\n", argv[2]);
-		fclose(wf);
-		return 1;
-	}
+	/* Decompress piece by piece, the data never needs to fit in memory */
+	do {
+		rc = gzip_reader_read(reader, buf, BUF_SIZE, &nread);
+		if (rc != EOK) {
+			printf("Error decompressing data.\n");
+			goto error;
+		}
+
+		nwr = fwrite(buf, 1, nread, wf);
+		if (nwr != nread) {
+			printf("Error writing '%s'\n", argv[2]);
+			goto error;
+		}
+	} while (nread == BUF_SIZE);
+
+	gzip_reader_destroy(reader);
+	fclose(f);
+	free(buf);
 
 	if (fclose(wf) != 0) {
 		printf("Error writing '%s'\n", argv[2]);
@@ -119,6 +125,12 @@ int main(int argc, char *argv[])
 	}
 
 	return 0;
+error:
+	gzip_reader_destroy(reader);
+	fclose(f);
+	fclose(wf);
+	free(buf);
+	return 1;
 }
 
 /** @}
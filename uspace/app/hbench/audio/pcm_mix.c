@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcm/format.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Frames mixed per iteration, 10 ms of 48 kHz stereo. */
+#define MIX_FRAMES  480
+
+/** Largest buffer, big enough for float stereo frames. */
+#define MIX_BUF_SIZE  (MIX_FRAMES * 2 * sizeof(float))
+
+static void *src_buf;
+static void *dst_buf;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	src_buf = malloc(MIX_BUF_SIZE);
+	dst_buf = malloc(MIX_BUF_SIZE);
+	if ((src_buf == NULL) || (dst_buf == NULL)) {
+		free(src_buf);
+		free(dst_buf);
+		return bench_run_fail(run, "failed to allocate %zuB buffers",
+		    MIX_BUF_SIZE);
+	}
+
+	/* Touch the buffers so that page faults are not measured. */
+	memset(src_buf, 0, MIX_BUF_SIZE);
+	memset(dst_buf, 0, MIX_BUF_SIZE);
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(src_buf);
+	free(dst_buf);
+	return true;
+}
+
+/** Mix one period of @a sf samples into @a df samples @a niter times. */
+static bool run_mix(bench_env_t *env, bench_run_t *run, uint64_t niter,
+    const pcm_format_t *sf, const pcm_format_t *df)
+{
+	const size_t src_size = MIX_FRAMES * pcm_format_frame_size(sf);
+	const size_t dst_size = MIX_FRAMES * pcm_format_frame_size(df);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		errno_t rc = pcm_format_convert_and_mix(dst_buf, dst_size,
+		    src_buf, src_size, sf, df);
+		if (rc != EOK) {
+			bench_run_stop(run);
+			return bench_run_fail(run, "mixing failed: %s",
+			    str_error(rc));
+		}
+
+		/* Keep the compiler from dropping mixes nobody reads. */
+		asm volatile ("" : : "r" (dst_buf) : "memory");
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_s16(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_mix(env, run, niter, &AUDIO_FORMAT_DEFAULT,
+	    &AUDIO_FORMAT_DEFAULT);
+}
+
+static bool runner_float(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const pcm_format_t f = {
+		.channels = 2,
+		.sampling_rate = 48000,
+		.sample_format = PCM_SAMPLE_FLOAT32
+	};
+
+	return run_mix(env, run, niter, &AUDIO_FORMAT_DEFAULT, &f);
+}
+
+benchmark_t benchmark_pcm_mix_s16 = {
+	.name = "pcm_mix_s16",
+	.desc = "Mix 10ms periods of 16-bit stereo audio",
+	.entry = &runner_s16,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_pcm_mix_float = {
+	.name = "pcm_mix_float",
+	.desc = "Mix 10ms periods of 16-bit stereo audio into float samples",
+	.entry = &runner_float,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+/**
+ * @file Comparison against results of an earlier build.
+ *
+ * The baseline is a CSV report written with --output. For every benchmark
+ * we compare the time per operation of the measured runs (warm-up runs are
+ * ignored) using the medians and a one-sided Mann-Whitney U test. A
+ * benchmark has regressed if it is significantly slower and the median
+ * grew by more than a given threshold.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <qsort.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include "hbench.h"
+
+/** Longest line of the CSV report we accept. */
+#define LINE_SIZE  256
+
+/** Two-sided 95% quantile of the normal distribution. */
+#define Z_95  1.959964
+
+/** Samples (in nanoseconds per operation) of one benchmark. */
+typedef struct {
+	char *name;
+	double *samples;
+	size_t count;
+	size_t capacity;
+} baseline_t;
+
+static baseline_t *baselines = NULL;
+static size_t baseline_count = 0;
+
+static baseline_t *baseline_find(const char *name)
+{
+	for (size_t i = 0; i < baseline_count; i++) {
+		if (str_cmp(baselines[i].name, name) == 0)
+			return &baselines[i];
+	}
+
+	return NULL;
+}
+
+static errno_t baseline_add(const char *name, double sample)
+{
+	baseline_t *base = baseline_find(name);
+
+	if (base == NULL) {
+		baseline_t *nb = realloc(baselines,
+		    (baseline_count + 1) * sizeof(baseline_t));
+		if (nb == NULL)
+			return ENOMEM;
+		baselines = nb;
+
+		base = &baselines[baseline_count];
+		memset(base, 0, sizeof(baseline_t));
+		base->name = str_dup(name);
+		if (base->name == NULL)
+			return ENOMEM;
+		baseline_count++;
+	}
+
+	if (base->count == base->capacity) {
+		size_t ncap = (base->capacity == 0) ? 16 : 2 * base->capacity;
+		double *ns = realloc(base->samples, ncap * sizeof(double));
+		if (ns == NULL)
+			return ENOMEM;
+		base->samples = ns;
+		base->capacity = ncap;
+	}
+
+	base->samples[base->count++] = sample;
+	return EOK;
+}
+
+/** Parse one CSV line, @c false if it is not a measured run. */
+static bool baseline_parse(char *line, char **name, double *sample)
+{
+	char *fields[4];
+	char *end;
+
+	for (int i = 0; i < 4; i++) {
+		fields[i] = line;
+		line = str_chr(line, (i < 3) ? ',' : '\n');
+		if (line == NULL && i < 3)
+			return false;
+		if (line != NULL)
+			*line++ = '\0';
+	}
+
+	long run = strtol(fields[1], &end, 10);
+	if (*end != '\0' || run < 0)
+		return false;
+
+	unsigned long long size = strtoull(fields[2], &end, 10);
+	if (*end != '\0' || size == 0)
+		return false;
+
+	long long nanos = strtoll(fields[3], &end, 10);
+	if (*end != '\0' || nanos < 0)
+		return false;
+
+	*name = fields[0];
+	*sample = (double) nanos / (double) size;
+	return true;
+}
+
+/** Load baseline results.
+ *
+ * @param filename CSV report of an earlier run.
+ * @return EOK on success or an error code.
+ */
+errno_t baseline_load(const char *filename)
+{
+	char line[LINE_SIZE];
+	char *name;
+	double sample;
+	errno_t rc = EOK;
+
+	FILE *file = fopen(filename, "r");
+	if (file == NULL)
+		return errno;
+
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (!baseline_parse(line, &name, &sample))
+			continue;
+
+		rc = baseline_add(name, sample);
+		if (rc != EOK)
+			break;
+	}
+
+	fclose(file);
+	return rc;
+}
+
+/** Free the loaded baseline. */
+void baseline_free(void)
+{
+	for (size_t i = 0; i < baseline_count; i++) {
+		free(baselines[i].name);
+		free(baselines[i].samples);
+	}
+
+	free(baselines);
+	baselines = NULL;
+	baseline_count = 0;
+}
+
+static int cmp_double(const void *a, const void *b, void *arg)
+{
+	double da = *(const double *) a;
+	double db = *(const double *) b;
+
+	return (da > db) - (da < db);
+}
+
+/** Median of sorted samples with a distribution-free 95% interval.
+ *
+ * The interval is given by order statistics around the median, their
+ * ranks follow from the normal approximation of the binomial distribution.
+ */
+static void median_ci(const double *sorted, size_t n, double *median,
+    double *lo, double *hi)
+{
+	double half = Z_95 * estimate_square_root(n, 0.001) / 2;
+	double lo_rank = n / 2.0 - half;
+	double hi_rank = 1 + n / 2.0 + half;
+
+	if (n % 2 == 1)
+		*median = sorted[n / 2];
+	else
+		*median = (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+
+	/* Round the ranks outwards, they are 1-based */
+	size_t lo_idx = (lo_rank < 1) ? 1 : (size_t) lo_rank;
+	size_t hi_idx = (hi_rank >= n) ? n : (size_t) hi_rank;
+	if (hi_idx < hi_rank)
+		hi_idx++;
+
+	*lo = sorted[lo_idx - 1];
+	*hi = sorted[hi_idx - 1];
+}
+
+/** Exponential of a non-positive number.
+ *
+ * Halve the argument until the Taylor series converges fast and square
+ * the result back. libmath has no exp() yet.
+ */
+static double exp_neg(double x)
+{
+	unsigned int halvings = 0;
+	double term = 1.0;
+	double sum = 1.0;
+
+	if (x < -700.0)
+		return 0.0;
+
+	while (x < -0.5) {
+		x /= 2;
+		halvings++;
+	}
+
+	for (int i = 1; i < 16; i++) {
+		term *= x / i;
+		sum += term;
+	}
+
+	while (halvings-- > 0)
+		sum *= sum;
+
+	return sum;
+}
+
+/** Upper tail probability of the standard normal distribution.
+ *
+ * Uses the approximation 7.1.26 of erfc from Abramowitz and Stegun,
+ * accurate to about 1e-7.
+ */
+static double normal_upper_tail(double z)
+{
+	double x = (z < 0 ? -z : z) / 1.4142135623730951;
+	double t = 1.0 / (1.0 + 0.3275911 * x);
+	double erfc = t * (0.254829592 + t * (-0.284496736 + t *
+	    (1.421413741 + t * (-1.453152027 + t * 1.061405429)))) *
+	    exp_neg(-x * x);
+
+	return (z < 0) ? 1.0 - erfc / 2 : erfc / 2;
+}
+
+typedef struct {
+	double value;
+	bool current;
+} ranked_t;
+
+static int cmp_ranked(const void *a, const void *b, void *arg)
+{
+	return cmp_double(&((const ranked_t *) a)->value,
+	    &((const ranked_t *) b)->value, arg);
+}
+
+/** One-sided Mann-Whitney U test that @a cur tends to exceed @a base.
+ *
+ * Uses the normal approximation with tie and continuity corrections.
+ *
+ * @return p-value, or a negative number if out of memory.
+ */
+static double mann_whitney(const double *base, size_t nb, const double *cur,
+    size_t nc)
+{
+	size_t n = nb + nc;
+	ranked_t *all = malloc(n * sizeof(ranked_t));
+	if (all == NULL)
+		return -1.0;
+
+	for (size_t i = 0; i < nb; i++)
+		all[i] = (ranked_t) { base[i], false };
+	for (size_t i = 0; i < nc; i++)
+		all[nb + i] = (ranked_t) { cur[i], true };
+
+	qsort_r(all, n, sizeof(ranked_t), cmp_ranked, NULL);
+
+	/* Sum of ranks of the current samples, ties get their average rank */
+	double rank_sum = 0.0;
+	double tie_sum = 0.0;
+	size_t i = 0;
+	while (i < n) {
+		size_t j = i + 1;
+		while (j < n && all[j].value == all[i].value)
+			j++;
+
+		double rank = (i + 1 + j) / 2.0;
+		for (size_t k = i; k < j; k++) {
+			if (all[k].current)
+				rank_sum += rank;
+		}
+
+		double t = j - i;
+		tie_sum += t * t * t - t;
+		i = j;
+	}
+
+	free(all);
+
+	double u = rank_sum - nc * (nc + 1) / 2.0;
+	double mean = nc * nb / 2.0;
+	double var = nc * nb / 12.0 * ((n + 1) - tie_sum / (n * (n - 1.0)));
+	if (var <= 0.0)
+		return 1.0;
+
+	double z = (u - mean - 0.5) / estimate_square_root(var, 0.0001);
+	return normal_upper_tail(z);
+}
+
+/** Compare runs against the baseline and report the result.
+ *
+ * @param env Benchmark environment with the test settings.
+ * @param bench Benchmark.
+ * @param runs Measured runs.
+ * @param run_count Number of runs.
+ * @param workload_size Workload size of each run.
+ * @return @c true if the benchmark has regressed.
+ */
+bool baseline_compare(bench_env_t *env, benchmark_t *bench, bench_run_t *runs,
+    size_t run_count, uint64_t workload_size)
+{
+	baseline_t *base = baseline_find(bench->name);
+	if (base == NULL || base->count < 2 || run_count < 2) {
+		printf("Baseline: not enough samples for comparison\n");
+		return false;
+	}
+
+	double *cur = malloc(run_count * sizeof(double));
+	if (cur == NULL) {
+		printf("Baseline: out of memory\n");
+		return false;
+	}
+
+	for (size_t i = 0; i < run_count; i++) {
+		cur[i] = (double) stopwatch_get_nanos(&runs[i].stopwatch) /
+		    (double) workload_size;
+	}
+
+	qsort_r(base->samples, base->count, sizeof(double), cmp_double, NULL);
+	qsort_r(cur, run_count, sizeof(double), cmp_double, NULL);
+
+	double base_med, base_lo, base_hi;
+	double cur_med, cur_lo, cur_hi;
+	median_ci(base->samples, base->count, &base_med, &base_lo, &base_hi);
+	median_ci(cur, run_count, &cur_med, &cur_lo, &cur_hi);
+
+	double p = mann_whitney(base->samples, base->count, cur, run_count);
+	free(cur);
+
+	double change = (base_med > 0) ?
+	    100.0 * (cur_med - base_med) / base_med : 0.0;
+	bool regressed = (p >= 0.0) && (p < env->regression_alpha) &&
+	    (change > env->regression_threshold);
+
+	printf("Baseline: median %.1f ns/op [%.1f, %.1f]; "
+	    "now %.1f ns/op [%.1f, %.1f]; change %+.1f%%, p=%.4f%s\n",
+	    base_med, base_lo, base_hi, cur_med, cur_lo, cur_hi, change, p,
+	    regressed ? " -- REGRESSION" : "");
+
+	return regressed;
+}
+
+/** @}
+ */
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <bd.h>
+#include <errno.h>
+#include <loc.h>
+#include <macros.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Size of one random read */
+#define READ_SIZE  4096
+
+/** Maximum number of reads in flight */
+#define MAX_DEPTH  32
+
+static bd_t *bd = NULL;
+static aoff64_t nreads;
+static size_t blocks_per_read;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *disk = bench_env_param_get(env, "disk", NULL);
+	service_id_t sid;
+	async_sess_t *sess;
+	size_t bsize;
+	aoff64_t nblocks;
+	void *buf;
+	errno_t rc;
+
+	if (disk == NULL)
+		return bench_run_fail(run, "use 'disk' param to name the disk");
+
+	rc = loc_service_get_id(disk, &sid, 0);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed resolving %s: %s", disk,
+		    str_error(rc));
+	}
+
+	sess = loc_service_connect(sid, INTERFACE_BLOCK, 0);
+	if (sess == NULL)
+		return bench_run_fail(run, "failed connecting to %s", disk);
+
+	rc = bd_open(sess, &bd);
+	if (rc != EOK) {
+		async_hangup(sess);
+		return bench_run_fail(run, "failed opening %s: %s", disk,
+		    str_error(rc));
+	}
+
+	rc = bd_get_block_size(bd, &bsize);
+	if (rc == EOK)
+		rc = bd_get_num_blocks(bd, &nblocks);
+	if (rc == EOK && (bsize == 0 || READ_SIZE % bsize != 0))
+		rc = ENOTSUP;
+	if (rc == EOK)
+		rc = bd_queue_setup(bd, MAX_DEPTH * READ_SIZE, &buf);
+	if (rc != EOK) {
+		bd_close(bd);
+		bd = NULL;
+		return bench_run_fail(run, "failed setting up %s: %s", disk,
+		    str_error(rc));
+	}
+
+	blocks_per_read = READ_SIZE / bsize;
+	nreads = nblocks / blocks_per_read;
+	if (nreads == 0) {
+		bd_close(bd);
+		bd = NULL;
+		return bench_run_fail(run, "%s is too small", disk);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (bd != NULL) {
+		bd_close(bd);
+		bd = NULL;
+	}
+
+	return true;
+}
+
+/** Start a read of a random aligned chunk into slot @a i of the buffer. */
+static errno_t read_start(size_t i, bd_req_t *req)
+{
+	uint64_t r = (uint64_t) rand() * (RAND_MAX + 1ULL) + rand();
+	bd_seg_t seg = {
+		.offset = i * READ_SIZE,
+		.size = READ_SIZE
+	};
+
+	return bd_queue_read(bd, (r % nreads) * blocks_per_read,
+	    blocks_per_read, &seg, 1, req);
+}
+
+/** Perform @a niter random reads keeping @a depth of them in flight. */
+static bool run_depth(bench_run_t *run, uint64_t niter, size_t depth)
+{
+	bd_req_t reqs[MAX_DEPTH];
+	uint64_t started = 0;
+	uint64_t count = 0;
+	errno_t rc = EOK;
+
+	bench_run_start(run);
+
+	while (started < min(niter, (uint64_t) depth)) {
+		rc = read_start(started, &reqs[started]);
+		if (rc != EOK)
+			break;
+		started++;
+	}
+
+	while (count < started) {
+		size_t i = count % depth;
+		errno_t rrc = bd_req_wait(&reqs[i]);
+		if (rc == EOK)
+			rc = rrc;
+		count++;
+
+		if (rc == EOK && started < niter) {
+			rc = read_start(i, &reqs[i]);
+			if (rc == EOK)
+				started++;
+		}
+	}
+
+	bench_run_stop(run);
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed reading: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool runner_1(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_depth(run, niter, 1);
+}
+
+static bool runner_32(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_depth(run, niter, 32);
+}
+
+benchmark_t benchmark_bd_rand_read_1 = {
+	.name = "bd_rand_read_1",
+	.desc = "Random 4 KiB disk reads with one in flight (set 'disk' param)",
+	.entry = &runner_1,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_bd_rand_read_32 = {
+	.name = "bd_rand_read_32",
+	.desc = "Random 4 KiB disk reads with 32 in flight (set 'disk' param)",
+	.entry = &runner_32,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -38,13 +38,60 @@
 #include "hbench.h"
 
 benchmark_t *benchmarks[] = {
+	&benchmark_aes_cbc,
+	&benchmark_aes_ccm,
+	&benchmark_aes_ctr,
+	&benchmark_as_area,
+	&benchmark_bd_rand_read_1,
+	&benchmark_bd_rand_read_32,
+	&benchmark_data_write_4k,
+	&benchmark_data_write_64k,
+	&benchmark_data_write_1m,
+	&benchmark_data_write_16m,
 	&benchmark_dir_read,
+	&benchmark_dir_read_mt,
+	&benchmark_fibril_condvar,
 	&benchmark_fibril_mutex,
+	&benchmark_fibril_spawn,
+	&benchmark_gunzip,
+	&benchmark_file_create,
 	&benchmark_file_read,
+	&benchmark_file_read_mt,
+	&benchmark_file_stat,
+	&benchmark_file_unlink,
 	&benchmark_malloc1,
+	&benchmark_malloc1_mt,
 	&benchmark_malloc2,
+	&benchmark_malloc2_mt,
+	&benchmark_memcpy_64,
+	&benchmark_memcpy_4k,
+	&benchmark_memcpy_256k,
+	&benchmark_memcpy_16m,
+	&benchmark_mpmc_ring,
 	&benchmark_ns_ping,
-	&benchmark_ping_pong
+	&benchmark_page_fault,
+	&benchmark_pbkdf2,
+	&benchmark_pcm_mix_float,
+	&benchmark_pcm_mix_s16,
+	&benchmark_ping_batch_1,
+	&benchmark_ping_batch_8,
+	&benchmark_ping_batch_64,
+	&benchmark_ping_pong,
+	&benchmark_qsort,
+	&benchmark_qsort_parallel,
+	&benchmark_sha1,
+	&benchmark_sha256,
+	&benchmark_startup_cpptest,
+	&benchmark_startup_uidemo,
+	&benchmark_str_ascii,
+	&benchmark_str_utf8,
+	&benchmark_task_spawn,
+	&benchmark_tcp_crr,
+	&benchmark_tcp_rr,
+	&benchmark_tcp_stream,
+	&benchmark_thread_switch,
+	&benchmark_udp_rr,
+	&benchmark_udp_stream
 };
 
 size_t benchmark_count = sizeof(benchmarks) / sizeof(benchmarks[0]);
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <gzip.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Compressed file, read into memory so that only inflate is measured. */
+static void *gz_data;
+static size_t gz_size;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *path = bench_env_param_get(env, "filename",
+	    "/data/bench.tar.gz");
+	FILE *file;
+	long size;
+
+	file = fopen(path, "rb");
+	if (file == NULL) {
+		return bench_run_fail(run, "failed to open %s for reading: %s",
+		    path, str_error(errno));
+	}
+
+	if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0) {
+		fclose(file);
+		return bench_run_fail(run, "failed to determine size of %s",
+		    path);
+	}
+
+	gz_size = size;
+	gz_data = malloc(gz_size);
+	if (gz_data == NULL) {
+		fclose(file);
+		return bench_run_fail(run, "failed to allocate %zuB buffer",
+		    gz_size);
+	}
+
+	if (fseek(file, 0, SEEK_SET) != 0 ||
+	    fread(gz_data, 1, gz_size, file) != gz_size) {
+		fclose(file);
+		free(gz_data);
+		return bench_run_fail(run, "failed to read %s", path);
+	}
+
+	fclose(file);
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(gz_data);
+	return true;
+}
+
+/** Discard expanded data. */
+static errno_t discard(void *arg, const void *data, size_t size)
+{
+	return EOK;
+}
+
+/** Expand the compressed file @a niter times. */
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	errno_t rc;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		rc = gzip_expand_stream(gz_data, gz_size, discard, NULL);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed to expand data: %s",
+			    str_error(rc));
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_gunzip = {
+	.name = "gunzip",
+	.desc = "Expand a gzip file in memory (use 'filename' param to select a representative tarball).",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
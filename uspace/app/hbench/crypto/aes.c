@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Largest accepted buffer size. */
+#define AES_MAX_SIZE  (16 * 1024 * 1024)
+
+static aes_ctx_t ctx;
+static uint8_t *buf;
+static size_t buf_size;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *str = bench_env_param_get(env, "size", "65536");
+	uint8_t key[AES_KEY_LENGTH];
+	char *end;
+
+	buf_size = strtoul(str, &end, 10);
+	if ((*end != '\0') || (buf_size == 0) || (buf_size > AES_MAX_SIZE) ||
+	    (buf_size % AES_CIPHER_LENGTH) != 0) {
+		return bench_run_fail(run, "size must be a multiple of %d "
+		    "up to %d", AES_CIPHER_LENGTH, AES_MAX_SIZE);
+	}
+
+	buf = malloc(buf_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %zuB buffer",
+		    buf_size);
+	}
+
+	for (size_t i = 0; i < buf_size; i++)
+		buf[i] = i & 0xff;
+
+	for (size_t i = 0; i < AES_KEY_LENGTH; i++)
+		key[i] = i;
+
+	aes_init(&ctx, key);
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(buf);
+	return true;
+}
+
+/** Encrypt the buffer in place in CTR mode @a niter times. */
+static bool run_ctr(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint8_t counter[AES_CIPHER_LENGTH] = { 0 };
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++)
+		aes_ctr(&ctx, counter, buf, buf, buf_size);
+	bench_run_stop(run);
+
+	return true;
+}
+
+/** Encrypt and decrypt the buffer in place in CBC mode @a niter times. */
+static bool run_cbc(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint8_t iv_enc[AES_CIPHER_LENGTH] = { 0 };
+	uint8_t iv_dec[AES_CIPHER_LENGTH] = { 0 };
+	errno_t rc;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		rc = aes_cbc_encrypt(&ctx, iv_enc, buf, buf, buf_size);
+		if (rc == EOK)
+			rc = aes_cbc_decrypt(&ctx, iv_dec, buf, buf, buf_size);
+		if (rc != EOK) {
+			return bench_run_fail(run, "CBC failed: %s",
+			    str_error(rc));
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+/** Seal and open the buffer in place in CCM mode @a niter times. */
+static bool run_ccm(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint8_t nonce[13] = { 0 };
+	uint8_t aad[8] = { 0 };
+	uint8_t tag[8];
+	errno_t rc;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		/* Use a fresh nonce for each message */
+		memcpy(nonce, &i, sizeof(i));
+
+		rc = aes_ccm_encrypt(&ctx, nonce, sizeof(nonce), aad,
+		    sizeof(aad), buf, buf, buf_size, tag, sizeof(tag));
+		if (rc == EOK) {
+			rc = aes_ccm_decrypt(&ctx, nonce, sizeof(nonce), aad,
+			    sizeof(aad), buf, buf, buf_size, tag, sizeof(tag));
+		}
+		if (rc != EOK) {
+			return bench_run_fail(run, "CCM failed: %s",
+			    str_error(rc));
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_aes_ctr = {
+	.name = "aes_ctr",
+	.desc = "AES-128 CTR encryption of a buffer ('size' param, default 64KiB).",
+	.entry = &run_ctr,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_aes_cbc = {
+	.name = "aes_cbc",
+	.desc = "AES-128 CBC encryption and decryption of a buffer ('size' param, default 64KiB).",
+	.entry = &run_cbc,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_aes_ccm = {
+	.name = "aes_ccm",
+	.desc = "AES-128 CCM sealing and opening of a buffer ('size' param, default 64KiB).",
+	.entry = &run_ccm,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Largest accepted buffer size. */
+#define HASH_MAX_SIZE  (16 * 1024 * 1024)
+
+static uint8_t *buf;
+static size_t buf_size;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *str = bench_env_param_get(env, "size", "65536");
+	char *end;
+
+	buf_size = strtoul(str, &end, 10);
+	if ((*end != '\0') || (buf_size > HASH_MAX_SIZE))
+		return bench_run_fail(run, "size must be a number up to %d",
+		    HASH_MAX_SIZE);
+
+	buf = malloc(buf_size);
+	if (buf == NULL) {
+		return bench_run_fail(run, "failed to allocate %zuB buffer",
+		    buf_size);
+	}
+
+	for (size_t i = 0; i < buf_size; i++)
+		buf[i] = i & 0xff;
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(buf);
+	return true;
+}
+
+/** Hash the buffer @a niter times. */
+static bool run_hash(bench_run_t *run, uint64_t niter, hash_func_t func)
+{
+	uint8_t digest[HASH_MAX_LENGTH];
+	hash_ctx_t ctx;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		(void) hash_init(&ctx, func);
+		hash_update(&ctx, buf, buf_size);
+		hash_final(&ctx, digest);
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool run_sha1(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_hash(run, niter, HASH_SHA1);
+}
+
+static bool run_sha256(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_hash(run, niter, HASH_SHA256);
+}
+
+/** Derive a WPA pre-shared key @a niter times. */
+static bool run_pbkdf2(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint8_t pass[] = "passphrase";
+	uint8_t ssid[] = "network";
+	uint8_t key[PBKDF2_KEY_LENGTH];
+	errno_t rc;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		rc = pbkdf2(pass, sizeof(pass) - 1, ssid, sizeof(ssid) - 1,
+		    key);
+		if (rc != EOK) {
+			return bench_run_fail(run, "PBKDF2 failed: %s",
+			    str_error(rc));
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_sha1 = {
+	.name = "sha1",
+	.desc = "SHA-1 hash of a buffer ('size' param, default 64KiB).",
+	.entry = &run_sha1,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_sha256 = {
+	.name = "sha256",
+	.desc = "SHA-256 hash of a buffer ('size' param, default 64KiB).",
+	.entry = &run_sha256,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_pbkdf2 = {
+	.name = "pbkdf2",
+	.desc = "Derive a WPA pre-shared key with 4096 rounds of HMAC-SHA1.",
+	.entry = &run_pbkdf2,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/**
+ * @}
+ */
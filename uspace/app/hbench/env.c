@@ -97,6 +97,9 @@ errno_t bench_env_init(bench_env_t *env)
 
 	env->run_count = DEFAULT_RUN_COUNT;
 	env->minimal_run_duration_nanos = MSEC2NSEC(DEFAULT_MIN_RUN_DURATION_SEC);
+	env->warmup_count = DEFAULT_WARMUP_COUNT;
+	env->regression_alpha = DEFAULT_REGRESSION_ALPHA;
+	env->regression_threshold = DEFAULT_REGRESSION_THRESHOLD;
 
 	return EOK;
 }
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <str_error.h>
+#include <vfs/vfs.h>
+#include "../hbench.h"
+
+/*
+ * File system metadata operations. The create and unlink benchmarks work
+ * on a fresh set of files named hbench-<n> in the directory given by the
+ * 'dir' parameter; only the operation in question is measured, the other
+ * one is done outside of the measured interval.
+ */
+
+#define PATH_SIZE  256
+
+static bool file_path(bench_env_t *env, bench_run_t *run, uint64_t n,
+    char *path)
+{
+	const char *dir = bench_env_param_get(env, "dir", "/tmp");
+	int len = snprintf(path, PATH_SIZE, "%s/hbench-%" PRIu64, dir, n);
+
+	if ((len < 0) || (len >= PATH_SIZE))
+		return bench_run_fail(run, "directory name %s too long", dir);
+
+	return true;
+}
+
+/** Create files 0 to @a count - 1.
+ *
+ * @param[out] created Number of files actually created
+ */
+static bool create_files(bench_env_t *env, bench_run_t *run, uint64_t count,
+    uint64_t *created)
+{
+	char path[PATH_SIZE];
+
+	for (*created = 0; *created < count; (*created)++) {
+		if (!file_path(env, run, *created, path))
+			return false;
+
+		errno_t rc = vfs_link_path(path, KIND_FILE, NULL);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed creating %s: %s",
+			    path, str_error(rc));
+		}
+	}
+
+	return true;
+}
+
+/** Unlink files 0 to @a count - 1. */
+static bool unlink_files(bench_env_t *env, bench_run_t *run, uint64_t count)
+{
+	char path[PATH_SIZE];
+
+	for (uint64_t i = 0; i < count; i++) {
+		if (!file_path(env, run, i, path))
+			return false;
+
+		errno_t rc = vfs_unlink_path(path);
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed unlinking %s: %s",
+			    path, str_error(rc));
+		}
+	}
+
+	return true;
+}
+
+/** Remove files left behind after a failure, ignoring errors. */
+static void remove_files(bench_env_t *env, uint64_t count)
+{
+	const char *dir = bench_env_param_get(env, "dir", "/tmp");
+	char path[PATH_SIZE];
+
+	for (uint64_t i = 0; i < count; i++) {
+		snprintf(path, PATH_SIZE, "%s/hbench-%" PRIu64, dir, i);
+		vfs_unlink_path(path);
+	}
+}
+
+static bool runner_create(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint64_t created;
+
+	bench_run_start(run);
+	bool ok = create_files(env, run, niter, &created);
+	bench_run_stop(run);
+
+	if (!ok) {
+		remove_files(env, created);
+		return false;
+	}
+
+	return unlink_files(env, run, created);
+}
+
+static bool runner_unlink(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint64_t created;
+
+	if (!create_files(env, run, niter, &created)) {
+		remove_files(env, created);
+		return false;
+	}
+
+	bench_run_start(run);
+	bool ok = unlink_files(env, run, niter);
+	bench_run_stop(run);
+
+	return ok;
+}
+
+static bool runner_stat(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *path = bench_env_param_get(env, "filename",
+	    "/data/web/helenos.png");
+	vfs_stat_t stat;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		errno_t rc = vfs_stat_path(path, &stat);
+		if (rc != EOK) {
+			bench_run_stop(run);
+			return bench_run_fail(run, "failed to stat %s: %s",
+			    path, str_error(rc));
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_file_create = {
+	.name = "file_create",
+	.desc = "Create empty files in a directory ('dir' param, default /tmp)",
+	.entry = &runner_create,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_file_stat = {
+	.name = "file_stat",
+	.desc = "Look up and stat a file by path ('filename' param)",
+	.entry = &runner_stat,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_file_unlink = {
+	.name = "file_unlink",
+	.desc = "Unlink empty files in a directory ('dir' param, default /tmp)",
+	.entry = &runner_unlink,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <dirent.h>
+#include <str_error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vfs/vfs.h>
+#include "../hbench.h"
+
+#define BUFFER_SIZE 65536
+
+static const char *path;
+
+/** Read the whole file @a niter times through a private file handle. */
+static bool file_worker(uint64_t niter)
+{
+	char *buf = malloc(BUFFER_SIZE);
+	if (buf == NULL)
+		return false;
+
+	int fd;
+	errno_t rc = vfs_lookup_open(path, WALK_REGULAR, MODE_READ, &fd);
+	if (rc != EOK) {
+		free(buf);
+		return false;
+	}
+
+	for (uint64_t i = 0; i < niter; i++) {
+		aoff64_t pos = 0;
+		size_t nread;
+
+		do {
+			rc = vfs_read(fd, &pos, buf, BUFFER_SIZE, &nread);
+			if (rc != EOK)
+				goto leave;
+		} while (nread > 0);
+	}
+
+leave:
+	vfs_put(fd);
+	free(buf);
+	return rc == EOK;
+}
+
+/** List the directory @a niter times. */
+static bool dir_worker(uint64_t niter)
+{
+	for (uint64_t i = 0; i < niter; i++) {
+		DIR *dir = opendir(path);
+		if (dir == NULL)
+			return false;
+
+		struct dirent *dp;
+		while ((dp = readdir(dir))) {
+			/* Do nothing */
+		}
+
+		closedir(dir);
+	}
+
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	return bench_spawn_runners(run, bench_env_threads(env) - 1);
+}
+
+/** Execute parallel file reading benchmark.
+ *
+ * Reads of regular files are usually served from the VFS page cache, so
+ * this measures how VFS scales with the number of readers.
+ */
+static bool file_runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	path = bench_env_param_get(env, "filename", "/data/web/helenos.png");
+
+	if (!bench_run_parallel(run, bench_env_threads(env), file_worker,
+	    niter)) {
+		return bench_run_fail(run, "failed to read %s", path);
+	}
+
+	return true;
+}
+
+/** Execute parallel directory listing benchmark.
+ *
+ * Directory reads bypass the VFS page cache and reach the file system
+ * server every time, so this shows how the server scales with the number
+ * of its runner threads.
+ */
+static bool dir_runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	path = bench_env_param_get(env, "dirname", "/");
+
+	if (!bench_run_parallel(run, bench_env_threads(env), dir_worker,
+	    niter)) {
+		return bench_run_fail(run, "failed to list %s", path);
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_file_read_mt = {
+	.name = "file_read_mt",
+	.desc = "Read a file in several threads (use 'filename' and 'threads' params to alter the defaults).",
+	.entry = &file_runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_dir_read_mt = {
+	.name = "dir_read_mt",
+	.desc = "List a directory in several threads (use 'dirname' and 'threads' params to alter the defaults).",
+	.entry = &dir_runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+/**
+ * @}
+ */
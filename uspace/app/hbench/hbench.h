@@ -38,11 +38,15 @@
 
 #include <adt/hash_table.h>
 #include <errno.h>
+#include <inet/endpoint.h>
 #include <stdbool.h>
 #include <perf.h>
 
 #define DEFAULT_RUN_COUNT 10
 #define DEFAULT_MIN_RUN_DURATION_SEC 10
+#define DEFAULT_WARMUP_COUNT 0
+#define DEFAULT_REGRESSION_ALPHA 0.01
+#define DEFAULT_REGRESSION_THRESHOLD 5.0
 
 /** Single run information.
  *
@@ -71,6 +75,12 @@ typedef struct {
 	hash_table_t parameters;
 	size_t run_count;
 	nsec_t minimal_run_duration_nanos;
+	/** Extra warm-up runs after the workload size is determined. */
+	size_t warmup_count;
+	/** Significance level of the baseline comparison. */
+	double regression_alpha;
+	/** Smallest slowdown (in percent) reported as a regression. */
+	double regression_threshold;
 } bench_env_t;
 
 /** Actual benchmark runner.
@@ -97,8 +107,17 @@ typedef struct {
 	benchmark_helper_t teardown;
 } benchmark_t;
 
+/** Worker of a multi-threaded benchmark.
+ *
+ * The argument is the number of iterations to execute, the return
+ * value tells whether the worker succeeded.
+ */
+typedef bool (*bench_worker_t)(uint64_t);
+
 extern void bench_run_init(bench_run_t *, char *, size_t);
 extern bool bench_run_fail(bench_run_t *, const char *, ...);
+extern bool bench_spawn_runners(bench_run_t *, int);
+extern bool bench_run_parallel(bench_run_t *, int, bench_worker_t, uint64_t);
 
 /*
  * We keep the following two functions inline to ensure that we start
@@ -118,6 +137,13 @@ static inline void bench_run_stop(bench_run_t *run)
 	stopwatch_stop(&run->stopwatch);
 }
 
+extern double estimate_square_root(double, double);
+
+extern errno_t baseline_load(const char *);
+extern bool baseline_compare(bench_env_t *, benchmark_t *, bench_run_t *,
+    size_t, uint64_t);
+extern void baseline_free(void);
+
 extern errno_t csv_report_open(const char *);
 extern void csv_report_add_entry(bench_run_t *, int, benchmark_t *, uint64_t);
 extern void csv_report_close(void);
@@ -125,19 +151,70 @@ extern void csv_report_close(void);
 extern errno_t bench_env_init(bench_env_t *);
 extern errno_t bench_env_param_set(bench_env_t *, const char *, const char *);
 extern const char *bench_env_param_get(bench_env_t *, const char *, const char *);
+extern int bench_env_threads(bench_env_t *);
 extern void bench_env_cleanup(bench_env_t *);
 
+extern bool bench_net_params(bench_env_t *, bench_run_t *, size_t,
+    inet_ep_t *, size_t *);
+
 extern benchmark_t *benchmarks[];
 extern size_t benchmark_count;
 
 /* Put your benchmark descriptors here (and also to benchlist.c). */
+extern benchmark_t benchmark_aes_cbc;
+extern benchmark_t benchmark_aes_ccm;
+extern benchmark_t benchmark_aes_ctr;
+extern benchmark_t benchmark_as_area;
+extern benchmark_t benchmark_bd_rand_read_1;
+extern benchmark_t benchmark_bd_rand_read_32;
+extern benchmark_t benchmark_data_write_4k;
+extern benchmark_t benchmark_data_write_64k;
+extern benchmark_t benchmark_data_write_1m;
+extern benchmark_t benchmark_data_write_16m;
 extern benchmark_t benchmark_dir_read;
+extern benchmark_t benchmark_dir_read_mt;
+extern benchmark_t benchmark_fibril_condvar;
 extern benchmark_t benchmark_fibril_mutex;
+extern benchmark_t benchmark_fibril_spawn;
+extern benchmark_t benchmark_gunzip;
+extern benchmark_t benchmark_file_create;
 extern benchmark_t benchmark_file_read;
+extern benchmark_t benchmark_file_read_mt;
+extern benchmark_t benchmark_file_stat;
+extern benchmark_t benchmark_file_unlink;
 extern benchmark_t benchmark_malloc1;
+extern benchmark_t benchmark_malloc1_mt;
 extern benchmark_t benchmark_malloc2;
+extern benchmark_t benchmark_malloc2_mt;
+extern benchmark_t benchmark_memcpy_64;
+extern benchmark_t benchmark_memcpy_4k;
+extern benchmark_t benchmark_memcpy_256k;
+extern benchmark_t benchmark_memcpy_16m;
+extern benchmark_t benchmark_mpmc_ring;
 extern benchmark_t benchmark_ns_ping;
+extern benchmark_t benchmark_page_fault;
+extern benchmark_t benchmark_pbkdf2;
+extern benchmark_t benchmark_pcm_mix_float;
+extern benchmark_t benchmark_pcm_mix_s16;
+extern benchmark_t benchmark_ping_batch_1;
+extern benchmark_t benchmark_ping_batch_8;
+extern benchmark_t benchmark_ping_batch_64;
 extern benchmark_t benchmark_ping_pong;
+extern benchmark_t benchmark_qsort;
+extern benchmark_t benchmark_qsort_parallel;
+extern benchmark_t benchmark_sha1;
+extern benchmark_t benchmark_sha256;
+extern benchmark_t benchmark_startup_cpptest;
+extern benchmark_t benchmark_startup_uidemo;
+extern benchmark_t benchmark_str_ascii;
+extern benchmark_t benchmark_str_utf8;
+extern benchmark_t benchmark_task_spawn;
+extern benchmark_t benchmark_tcp_crr;
+extern benchmark_t benchmark_tcp_rr;
+extern benchmark_t benchmark_tcp_stream;
+extern benchmark_t benchmark_thread_switch;
+extern benchmark_t benchmark_udp_rr;
+extern benchmark_t benchmark_udp_stream;
 
 #endif
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <async.h>
+#include <errno.h>
+#include <ipc_test.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/*
+ * Throughput of IPC data transfers. Each iteration writes a block to the
+ * IPC test server using async_data_write in pieces of at most
+ * DATA_XFER_LIMIT bytes, like file system clients do. The 'chunk'
+ * parameter selects a smaller piece size.
+ */
+
+/** Largest written block. */
+#define DATA_WRITE_MAX_SIZE  (16 * 1024 * 1024)
+
+static ipc_test_t *test = NULL;
+static uint8_t *buf;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	errno_t rc = ipc_test_create(&test);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "failed contacting IPC test server (have you run /srv/test/ipc-test?): %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	buf = malloc(DATA_WRITE_MAX_SIZE);
+	if (buf == NULL) {
+		ipc_test_destroy(test);
+		return bench_run_fail(run, "failed to allocate %dB buffer",
+		    DATA_WRITE_MAX_SIZE);
+	}
+
+	/* Touch the buffer so that page faults are not measured. */
+	memset(buf, 0x5a, DATA_WRITE_MAX_SIZE);
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(buf);
+	ipc_test_destroy(test);
+	return true;
+}
+
+/** Write a block of @a size bytes @a niter times. */
+static bool run_size(bench_env_t *env, bench_run_t *run, uint64_t niter,
+    size_t size)
+{
+	const char *str = bench_env_param_get(env, "chunk", "65536");
+	char *end;
+
+	size_t chunk = strtoul(str, &end, 10);
+	if ((*end != '\0') || (chunk == 0) || (chunk > DATA_XFER_LIMIT)) {
+		return bench_run_fail(run, "chunk must be a number up to %d",
+		    DATA_XFER_LIMIT);
+	}
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		for (size_t pos = 0; pos < size; pos += chunk) {
+			errno_t rc = ipc_test_write(test, buf + pos,
+			    min(size - pos, chunk));
+			if (rc != EOK) {
+				return bench_run_fail(run, "failed writing data: %s (%d)",
+				    str_error(rc), rc);
+			}
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_4k(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, 4096);
+}
+
+static bool runner_64k(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, 64 * 1024);
+}
+
+static bool runner_1m(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, 1024 * 1024);
+}
+
+static bool runner_16m(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, DATA_WRITE_MAX_SIZE);
+}
+
+benchmark_t benchmark_data_write_4k = {
+	.name = "data_write_4k",
+	.desc = "IPC data write of 4KiB blocks to the IPC test server ('chunk' param, default 64KiB)",
+	.entry = &runner_4k,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_data_write_64k = {
+	.name = "data_write_64k",
+	.desc = "IPC data write of 64KiB blocks to the IPC test server ('chunk' param, default 64KiB)",
+	.entry = &runner_64k,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_data_write_1m = {
+	.name = "data_write_1m",
+	.desc = "IPC data write of 1MiB blocks to the IPC test server ('chunk' param, default 64KiB)",
+	.entry = &runner_1m,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_data_write_16m = {
+	.name = "data_write_16m",
+	.desc = "IPC data write of 16MiB blocks to the IPC test server ('chunk' param, default 64KiB)",
+	.entry = &runner_16m,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
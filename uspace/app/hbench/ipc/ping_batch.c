@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <stdio.h>
+#include <ipc_test.h>
+#include <async.h>
+#include <errno.h>
+#include <macros.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+static ipc_test_t *test = NULL;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	errno_t rc = ipc_test_create(&test);
+	if (rc != EOK) {
+		return bench_run_fail(run,
+		    "failed contacting IPC test server (have you run /srv/test/ipc-test?): %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	ipc_test_destroy(test);
+	return true;
+}
+
+/** Send @a niter pings keeping @a depth of them in flight. */
+static bool run_depth(bench_run_t *run, uint64_t niter, size_t depth)
+{
+	bench_run_start(run);
+
+	uint64_t count = 0;
+	while (count < niter) {
+		size_t batch = min(niter - count, (uint64_t) depth);
+		errno_t rc = ipc_test_ping_batch(test, batch);
+
+		if (rc != EOK) {
+			return bench_run_fail(run, "failed sending ping batch: %s (%d)",
+			    str_error(rc), rc);
+		}
+
+		count += batch;
+	}
+
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_1(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_depth(run, niter, 1);
+}
+
+static bool runner_8(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_depth(run, niter, 8);
+}
+
+static bool runner_64(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_depth(run, niter, 64);
+}
+
+benchmark_t benchmark_ping_batch_1 = {
+	.name = "ping_batch_1",
+	.desc = "IPC ping throughput with one request in flight",
+	.entry = &runner_1,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_ping_batch_8 = {
+	.name = "ping_batch_8",
+	.desc = "IPC ping throughput with 8 batched requests in flight",
+	.entry = &runner_8,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_ping_batch_64 = {
+	.name = "ping_batch_64",
+	.desc = "IPC ping throughput with 64 batched requests in flight",
+	.entry = &runner_64,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/** @}
+ */
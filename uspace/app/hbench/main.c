@@ -34,6 +34,7 @@
  * @file
  */
 
+#include <affinity.h>
 #include <assert.h>
 #include <getopt.h>
 #include <math.h>
@@ -50,6 +51,12 @@
 
 #define MAX_ERROR_STR_LENGTH 1024
 
+/** Whether to compare the results with a baseline. */
+static bool use_baseline = false;
+
+/** Number of benchmarks that regressed against the baseline. */
+static unsigned int regression_count = 0;
+
 static void short_report(bench_run_t *info, int run_index,
     benchmark_t *bench, uint64_t workload_size)
 {
@@ -68,33 +75,6 @@ static void short_report(bench_run_t *info, int run_index,
 	}
 }
 
-/** Estimate square root value.
- *
- * @param value The value to compute square root of.
- * @param precision Required precision (e.g. 0.00001).
- *
- * @details
- *
- * This is a temporary solution until we have proper sqrt() implementation
- * in libmath.
- *
- * The algorithm uses Babylonian method [1].
- *
- * [1] https://en.wikipedia.org/wiki/Methods_of_computing_square_roots#Babylonian_method
- */
-static double estimate_square_root(double value, double precision)
-{
-	double estimate = 1.;
-	double prev_estimate = estimate + 10 * precision;
-
-	while (fabs(estimate - prev_estimate) > precision) {
-		prev_estimate = estimate;
-		estimate = (prev_estimate + value / prev_estimate) / 2.;
-	}
-
-	return estimate;
-}
-
 /** Compute available statistics from given stopwatches.
  *
  * We compute normal mean for average duration of the workload and geometric
@@ -203,6 +183,17 @@ static bool run_benchmark(bench_env_t *env, benchmark_t *bench)
 		}
 	}
 
+	for (size_t i = 0; i < env->warmup_count; i++) {
+		bench_run_t run;
+		bench_run_init(&run, error_msg, MAX_ERROR_STR_LENGTH);
+
+		bool ok = bench->entry(env, &run, workload_size);
+		if (!ok) {
+			goto leave_error;
+		}
+		short_report(&run, -1, bench, workload_size);
+	}
+
 	printf("Workload size set to %" PRIu64 ", measuring %zu samples.\n",
 	    workload_size, env->run_count);
 
@@ -223,6 +214,9 @@ static bool run_benchmark(bench_env_t *env, benchmark_t *bench)
 	}
 
 	summary_stats(runs, env->run_count, bench, workload_size);
+	if (use_baseline && baseline_compare(env, bench, runs, env->run_count,
+	    workload_size))
+		regression_count++;
 	printf("\nBenchmark completed\n");
 
 	free(runs);
@@ -316,10 +310,52 @@ static void print_usage(const char *progname)
 	    "Store machine-readable data in filename.csv\n");
 	printf("-p, --param KEY=VALUE      "
 	    "Additional parameters for the benchmark\n");
+	printf("-w, --warmup N             "
+	    "Set number of warm-up runs before measuring\n");
+	printf("-c, --cpu N                "
+	    "Pin the main thread to CPU N\n");
+	printf("-b, --baseline file.csv    "
+	    "Compare with results stored by an earlier --output\n");
+	printf("-a, --alpha P              "
+	    "Significance level of the comparison (default 0.01)\n");
+	printf("-t, --threshold PERCENT    "
+	    "Smallest slowdown considered a regression (default 5)\n");
 	printf("<benchmark> is one of the following:\n");
 	list_benchmarks();
 }
 
+/** Parse a non-negative decimal number such as 0.05.
+ *
+ * libc does not have strtod().
+ */
+static bool parse_decimal(const char *str, double *value)
+{
+	double scale = 1.0;
+	bool fraction = false;
+	bool digits = false;
+
+	*value = 0.0;
+	for (; *str != '\0'; str++) {
+		if (*str == '.' && !fraction) {
+			fraction = true;
+			continue;
+		}
+
+		if (*str < '0' || *str > '9')
+			return false;
+
+		if (fraction) {
+			scale /= 10;
+			*value += (*str - '0') * scale;
+		} else {
+			*value = *value * 10 + (*str - '0');
+		}
+		digits = true;
+	}
+
+	return digits;
+}
+
 static void handle_param_arg(bench_env_t *env, char *arg)
 {
 	char *value = NULL;
@@ -329,6 +365,10 @@ static void handle_param_arg(bench_env_t *env, char *arg)
 
 int main(int argc, char *argv[])
 {
+	/* Used by the task_spawn benchmark */
+	if (argc > 1 && str_cmp(argv[1], "--startup-only") == 0)
+		return 0;
+
 	bench_env_t bench_env;
 	errno_t rc = bench_env_init(&bench_env);
 	if (rc != EOK) {
@@ -337,21 +377,54 @@ int main(int argc, char *argv[])
 		return -5;
 	}
 
-	const char *short_options = "ho:p:n:d:";
+	const char *short_options = "ho:p:n:d:w:c:b:a:t:";
 	struct option long_options[] = {
+		{ "alpha", required_argument, NULL, 'a' },
+		{ "baseline", required_argument, NULL, 'b' },
+		{ "cpu", required_argument, NULL, 'c' },
 		{ "duration", required_argument, NULL, 'd' },
 		{ "help", optional_argument, NULL, 'h' },
 		{ "count", required_argument, NULL, 'n' },
 		{ "output", required_argument, NULL, 'o' },
 		{ "param", required_argument, NULL, 'p' },
+		{ "threshold", required_argument, NULL, 't' },
+		{ "warmup", required_argument, NULL, 'w' },
 		{ 0, 0, NULL, 0 }
 	};
 
 	char *csv_output_filename = NULL;
+	char *baseline_filename = NULL;
+	cpu_set_t cpus;
+	char *end;
 
 	int opt = 0;
 	while ((opt = getopt_long(argc, argv, short_options, long_options, NULL)) > 0) {
 		switch (opt) {
+		case 'a':
+			if (!parse_decimal(optarg, &bench_env.regression_alpha) ||
+			    (bench_env.regression_alpha <= 0) ||
+			    (bench_env.regression_alpha >= 1)) {
+				fprintf(stderr, "Invalid -a argument.\n");
+				return -3;
+			}
+			break;
+		case 'b':
+			baseline_filename = optarg;
+			break;
+		case 'c':
+			cpu_set_zero(&cpus);
+			cpu_set_add(&cpus, strtoul(optarg, &end, 10));
+			if (*end != '\0') {
+				fprintf(stderr, "Invalid -c argument.\n");
+				return -3;
+			}
+			rc = thread_set_affinity(&cpus);
+			if (rc != EOK) {
+				fprintf(stderr, "Failed to pin to CPU %s: %s\n",
+				    optarg, str_error(rc));
+				return -3;
+			}
+			break;
 		case 'd':
 			errno = EOK;
 			bench_env.minimal_run_duration_nanos = MSEC2NSEC(atoll(optarg));
@@ -377,6 +450,20 @@ int main(int argc, char *argv[])
 		case 'p':
 			handle_param_arg(&bench_env, optarg);
 			break;
+		case 't':
+			if (!parse_decimal(optarg,
+			    &bench_env.regression_threshold)) {
+				fprintf(stderr, "Invalid -t argument.\n");
+				return -3;
+			}
+			break;
+		case 'w':
+			bench_env.warmup_count = strtoul(optarg, &end, 10);
+			if (*end != '\0') {
+				fprintf(stderr, "Invalid -w argument.\n");
+				return -3;
+			}
+			break;
 		case -1:
 		default:
 			break;
@@ -400,6 +487,16 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (baseline_filename != NULL) {
+		rc = baseline_load(baseline_filename);
+		if (rc != EOK) {
+			fprintf(stderr, "Failed to load baseline '%s': %s\n",
+			    baseline_filename, str_error(rc));
+			return -4;
+		}
+		use_baseline = true;
+	}
+
 	int exit_code = 0;
 
 	if (str_cmp(benchmark, "*") == 0) {
@@ -419,7 +516,15 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (regression_count > 0) {
+		printf("%u benchmark(s) regressed against the baseline.\n",
+		    regression_count);
+		if (exit_code == 0)
+			exit_code = -6;
+	}
+
 	csv_report_close();
+	baseline_free();
 	bench_env_cleanup(&bench_env);
 
 	return exit_code;
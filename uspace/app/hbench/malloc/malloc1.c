@@ -60,5 +60,35 @@ benchmark_t benchmark_malloc1 = {
 	.teardown = NULL
 };
 
+static bool worker(uint64_t niter)
+{
+	for (uint64_t i = 0; i < niter; i++) {
+		void *p = malloc(1);
+		if (p == NULL)
+			return false;
+		free(p);
+	}
+
+	return true;
+}
+
+static bool setup_mt(bench_env_t *env, bench_run_t *run)
+{
+	return bench_spawn_runners(run, bench_env_threads(env) - 1);
+}
+
+static bool runner_mt(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	return bench_run_parallel(run, bench_env_threads(env), worker, size);
+}
+
+benchmark_t benchmark_malloc1_mt = {
+	.name = "malloc1_mt",
+	.desc = "User-space memory allocator benchmark, repeatedly allocate one block in several threads",
+	.entry = &runner_mt,
+	.setup = &setup_mt,
+	.teardown = NULL
+};
+
 /** @}
  */
@@ -75,5 +75,46 @@ benchmark_t benchmark_malloc2 = {
 	.teardown = NULL
 };
 
+static bool worker(uint64_t niter)
+{
+	void **p = malloc(niter * sizeof(void *));
+	if (p == NULL)
+		return false;
+
+	for (uint64_t count = 0; count < niter; count++) {
+		p[count] = malloc(1);
+		if (p[count] == NULL) {
+			for (uint64_t j = 0; j < count; j++)
+				free(p[j]);
+			free(p);
+			return false;
+		}
+	}
+
+	for (uint64_t count = 0; count < niter; count++)
+		free(p[count]);
+
+	free(p);
+	return true;
+}
+
+static bool setup_mt(bench_env_t *env, bench_run_t *run)
+{
+	return bench_spawn_runners(run, bench_env_threads(env) - 1);
+}
+
+static bool runner_mt(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return bench_run_parallel(run, bench_env_threads(env), worker, niter);
+}
+
+benchmark_t benchmark_malloc2_mt = {
+	.name = "malloc2_mt",
+	.desc = "User-space memory allocator benchmark, allocate many small blocks in several threads",
+	.entry = &runner_mt,
+	.setup = &setup_mt,
+	.teardown = NULL
+};
+
 /** @}
  */
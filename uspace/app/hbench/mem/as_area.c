@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <as.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/** Largest accepted area size in pages. */
+#define AREA_MAX_PAGES  (64 * 1024)
+
+/** Anonymous memory flags used for the areas. */
+#define AREA_FLAGS  (AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE)
+
+static bool get_pages(bench_env_t *env, bench_run_t *run, const char *def,
+    size_t *pages)
+{
+	const char *str = bench_env_param_get(env, "pages", def);
+	char *end;
+
+	*pages = strtoul(str, &end, 10);
+	if ((*end != '\0') || (*pages == 0) || (*pages > AREA_MAX_PAGES)) {
+		return bench_run_fail(run, "pages must be a number up to %d",
+		    AREA_MAX_PAGES);
+	}
+
+	return true;
+}
+
+/** Create an area and optionally fault in all its pages, then destroy it. */
+static bool run_area(bench_env_t *env, bench_run_t *run, uint64_t niter,
+    size_t pages, bool touch)
+{
+	size_t size = PAGES2SIZE(pages);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		volatile uint8_t *area = as_area_create(AS_AREA_ANY, size,
+		    AREA_FLAGS, AS_AREA_UNPAGED);
+		if (area == AS_MAP_FAILED) {
+			bench_run_stop(run);
+			return bench_run_fail(run, "failed creating %zu page area",
+			    pages);
+		}
+
+		if (touch) {
+			for (size_t off = 0; off < size; off += PAGE_SIZE)
+				area[off] = 1;
+		}
+
+		as_area_destroy((void *) area);
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_as_area(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	size_t pages;
+
+	if (!get_pages(env, run, "16", &pages))
+		return false;
+
+	return run_area(env, run, niter, pages, false);
+}
+
+static bool runner_page_fault(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	size_t pages;
+
+	if (!get_pages(env, run, "256", &pages))
+		return false;
+
+	return run_area(env, run, niter, pages, true);
+}
+
+benchmark_t benchmark_as_area = {
+	.name = "as_area",
+	.desc = "Create and destroy an anonymous area ('pages' param, default 16)",
+	.entry = &runner_as_area,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_page_fault = {
+	.name = "page_fault",
+	.desc = "Fault in every page of a new anonymous area ('pages' param, default 256; includes as_area cost)",
+	.entry = &runner_page_fault,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/** Largest copied block, well beyond the size of last-level caches. */
+#define MEMCPY_MAX_SIZE  (16 * 1024 * 1024)
+
+/** Largest source or destination offset. */
+#define MEMCPY_MAX_OFFSET  64
+
+static uint8_t *src_buf;
+static uint8_t *dst_buf;
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	src_buf = malloc(MEMCPY_MAX_SIZE + MEMCPY_MAX_OFFSET);
+	dst_buf = malloc(MEMCPY_MAX_SIZE + MEMCPY_MAX_OFFSET);
+	if ((src_buf == NULL) || (dst_buf == NULL)) {
+		free(src_buf);
+		free(dst_buf);
+		return bench_run_fail(run, "failed to allocate %dB buffers",
+		    MEMCPY_MAX_SIZE + MEMCPY_MAX_OFFSET);
+	}
+
+	/* Touch the buffers so that page faults are not measured. */
+	memset(src_buf, 0x5a, MEMCPY_MAX_SIZE + MEMCPY_MAX_OFFSET);
+	memset(dst_buf, 0, MEMCPY_MAX_SIZE + MEMCPY_MAX_OFFSET);
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(src_buf);
+	free(dst_buf);
+	return true;
+}
+
+static bool get_offset(bench_env_t *env, bench_run_t *run, const char *name,
+    size_t *offset)
+{
+	const char *str = bench_env_param_get(env, name, "0");
+	char *end;
+
+	*offset = strtoul(str, &end, 10);
+	if ((*end != '\0') || (*offset > MEMCPY_MAX_OFFSET)) {
+		return bench_run_fail(run, "%s must be a number up to %d",
+		    name, MEMCPY_MAX_OFFSET);
+	}
+
+	return true;
+}
+
+/** Copy a block of @a size bytes @a niter times. */
+static bool run_size(bench_env_t *env, bench_run_t *run, uint64_t niter,
+    size_t size)
+{
+	size_t src_offset;
+	size_t dst_offset;
+
+	if (!get_offset(env, run, "src_offset", &src_offset) ||
+	    !get_offset(env, run, "dst_offset", &dst_offset))
+		return false;
+
+	uint8_t *src = src_buf + src_offset;
+	uint8_t *dst = dst_buf + dst_offset;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		memcpy(dst, src, size);
+
+		/* Keep the compiler from dropping copies nobody reads. */
+		asm volatile ("" : : "r" (dst) : "memory");
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_64(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, 64);
+}
+
+static bool runner_4k(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, 4096);
+}
+
+static bool runner_256k(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, 256 * 1024);
+}
+
+static bool runner_16m(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_size(env, run, niter, MEMCPY_MAX_SIZE);
+}
+
+benchmark_t benchmark_memcpy_64 = {
+	.name = "memcpy_64",
+	.desc = "Copy 64B blocks (use 'src_offset' and 'dst_offset' params to misalign)",
+	.entry = &runner_64,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_memcpy_4k = {
+	.name = "memcpy_4k",
+	.desc = "Copy 4KiB blocks (use 'src_offset' and 'dst_offset' params to misalign)",
+	.entry = &runner_4k,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_memcpy_256k = {
+	.name = "memcpy_256k",
+	.desc = "Copy 256KiB blocks (use 'src_offset' and 'dst_offset' params to misalign)",
+	.entry = &runner_256k,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_memcpy_16m = {
+	.name = "memcpy_16m",
+	.desc = "Copy 16MiB blocks exceeding the cache (use 'src_offset' and 'dst_offset' params to misalign)",
+	.entry = &runner_16m,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
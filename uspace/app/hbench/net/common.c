@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <inet/addr.h>
+#include <inet/endpoint.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Default address for network benchmarks (loopback) */
+#define NET_DEFAULT_ADDR  "127.0.0.1"
+
+/** Default port for network benchmarks */
+#define NET_DEFAULT_PORT  "5800"
+
+/** Largest message size accepted by the network benchmarks */
+#define NET_MAX_SIZE  65536
+
+/** Read common parameters of network benchmarks.
+ *
+ * Both ends of the network benchmarks run in hbench itself. The 'addr'
+ * parameter selects the local address to use, i.e. loopback (default)
+ * or the address of a NIC, 'port' the port the server side listens on
+ * and 'size' the size of one message.
+ *
+ * @param env      Benchmark environment
+ * @param run      Run to report errors to
+ * @param def_size Default message size
+ * @param ep       Place to store the server endpoint
+ * @param size     Place to store the message size
+ * @return @c true on success, @c false on invalid parameters
+ */
+bool bench_net_params(bench_env_t *env, bench_run_t *run, size_t def_size,
+    inet_ep_t *ep, size_t *size)
+{
+	const char *addr = bench_env_param_get(env, "addr", NET_DEFAULT_ADDR);
+	const char *port = bench_env_param_get(env, "port", NET_DEFAULT_PORT);
+	const char *ssize = bench_env_param_get(env, "size", NULL);
+	uint16_t portno;
+	errno_t rc;
+
+	inet_ep_init(ep);
+
+	rc = inet_addr_parse(addr, &ep->addr, NULL);
+	if (rc != EOK) {
+		return bench_run_fail(run, "invalid address '%s': %s", addr,
+		    str_error(rc));
+	}
+
+	rc = str_uint16_t(port, NULL, 10, true, &portno);
+	if (rc != EOK || portno == 0)
+		return bench_run_fail(run, "invalid port '%s'", port);
+
+	ep->port = portno;
+
+	*size = def_size;
+	if (ssize != NULL) {
+		rc = str_size_t(ssize, NULL, 10, true, size);
+		if (rc != EOK || *size == 0 || *size > NET_MAX_SIZE) {
+			return bench_run_fail(run, "invalid size '%s' (1 to %d)",
+			    ssize, NET_MAX_SIZE);
+		}
+	}
+
+	return true;
+}
+
+/** @}
+ */
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <inet/endpoint.h>
+#include <inet/tcp.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Size of receive buffers */
+#define TCP_BUF_SIZE  65536
+
+/** What the server side does with received data */
+typedef enum {
+	/** Send all data back */
+	tcp_srv_echo,
+	/** Discard data, acknowledge end of stream with one byte */
+	tcp_srv_sink
+} tcp_srv_mode_t;
+
+static tcp_t *tcp = NULL;
+static tcp_listener_t *lst = NULL;
+static tcp_srv_mode_t srv_mode;
+static inet_ep2_t epp;
+static size_t msg_size;
+static char *buf = NULL;
+
+static tcp_cb_t conn_cb = {
+	.connected = NULL
+};
+
+static void srv_new_conn(tcp_listener_t *, tcp_conn_t *);
+
+static tcp_listen_cb_t listen_cb = {
+	.new_conn = srv_new_conn
+};
+
+/** Serve one incoming connection according to @c srv_mode. */
+static void srv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
+{
+	char *sbuf;
+	size_t nrecv;
+	errno_t rc;
+
+	sbuf = malloc(TCP_BUF_SIZE);
+	if (sbuf == NULL) {
+		tcp_conn_reset(conn);
+		return;
+	}
+
+	if (srv_mode == tcp_srv_echo)
+		(void) tcp_conn_set_nodelay(conn, true);
+
+	while (true) {
+		rc = tcp_conn_recv_wait(conn, sbuf, TCP_BUF_SIZE, &nrecv);
+		if (rc != EOK || nrecv == 0)
+			break;
+
+		if (srv_mode == tcp_srv_echo) {
+			rc = tcp_conn_send(conn, sbuf, nrecv);
+			if (rc != EOK)
+				break;
+		}
+	}
+
+	if (rc == EOK && srv_mode == tcp_srv_sink)
+		rc = tcp_conn_send(conn, sbuf, 1);
+
+	if (rc == EOK)
+		(void) tcp_conn_send_fin(conn);
+	else
+		(void) tcp_conn_reset(conn);
+
+	free(sbuf);
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run, tcp_srv_mode_t mode,
+    size_t def_size)
+{
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	if (!bench_net_params(env, run, def_size, &epp.remote, &msg_size))
+		return false;
+
+	buf = calloc(1, TCP_BUF_SIZE);
+	if (buf == NULL)
+		return bench_run_fail(run, "out of memory");
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		free(buf);
+		buf = NULL;
+		return bench_run_fail(run, "failed connecting to TCP: %s",
+		    str_error(rc));
+	}
+
+	srv_mode = mode;
+	rc = tcp_listener_create(tcp, &epp.remote, &listen_cb, NULL, &conn_cb,
+	    NULL, &lst);
+	if (rc != EOK) {
+		tcp_destroy(tcp);
+		tcp = NULL;
+		free(buf);
+		buf = NULL;
+		return bench_run_fail(run, "failed creating listener: %s",
+		    str_error(rc));
+	}
+
+	return true;
+}
+
+static bool setup_echo(bench_env_t *env, bench_run_t *run)
+{
+	return setup(env, run, tcp_srv_echo, 1);
+}
+
+static bool setup_sink(bench_env_t *env, bench_run_t *run)
+{
+	return setup(env, run, tcp_srv_sink, 16384);
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (lst != NULL) {
+		tcp_listener_destroy(lst);
+		lst = NULL;
+	}
+
+	if (tcp != NULL) {
+		tcp_destroy(tcp);
+		tcp = NULL;
+	}
+
+	free(buf);
+	buf = NULL;
+	return true;
+}
+
+/** Open connection to the server side. */
+static errno_t conn_open(bool nodelay, tcp_conn_t **rconn)
+{
+	tcp_conn_t *conn;
+	errno_t rc;
+
+	rc = tcp_conn_create(tcp, &epp, &conn_cb, NULL, &conn);
+	if (rc != EOK)
+		return rc;
+
+	rc = tcp_conn_wait_connected(conn);
+	if (rc == EOK && nodelay)
+		rc = tcp_conn_set_nodelay(conn, true);
+	if (rc != EOK) {
+		tcp_conn_destroy(conn);
+		return rc;
+	}
+
+	*rconn = conn;
+	return EOK;
+}
+
+/** Send one message and receive it back. */
+static errno_t request_response(tcp_conn_t *conn)
+{
+	size_t total;
+	size_t nrecv;
+	errno_t rc;
+
+	rc = tcp_conn_send(conn, buf, msg_size);
+	if (rc != EOK)
+		return rc;
+
+	total = 0;
+	while (total < msg_size) {
+		rc = tcp_conn_recv_wait(conn, buf + total, msg_size - total,
+		    &nrecv);
+		if (rc != EOK)
+			return rc;
+		if (nrecv == 0)
+			return EIO;
+		total += nrecv;
+	}
+
+	return EOK;
+}
+
+static bool runner_stream(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	tcp_conn_t *conn;
+	size_t nrecv;
+	errno_t rc;
+
+	rc = conn_open(false, &conn);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed connecting: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		rc = tcp_conn_send(conn, buf, msg_size);
+		if (rc != EOK)
+			break;
+	}
+
+	/* Wait until the server side has received everything */
+	if (rc == EOK)
+		rc = tcp_conn_send_fin(conn);
+	if (rc == EOK)
+		rc = tcp_conn_recv_wait(conn, buf, 1, &nrecv);
+	if (rc == EOK && nrecv != 1)
+		rc = EIO;
+
+	bench_run_stop(run);
+
+	tcp_conn_destroy(conn);
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed sending data: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool runner_rr(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	tcp_conn_t *conn;
+	errno_t rc = EOK;
+
+	rc = conn_open(true, &conn);
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed connecting: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		rc = request_response(conn);
+		if (rc != EOK)
+			break;
+	}
+
+	bench_run_stop(run);
+
+	tcp_conn_destroy(conn);
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed exchanging messages: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool runner_crr(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	tcp_conn_t *conn;
+	errno_t rc = EOK;
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		rc = conn_open(true, &conn);
+		if (rc != EOK)
+			break;
+
+		rc = request_response(conn);
+		if (rc == EOK)
+			rc = tcp_conn_send_fin(conn);
+
+		tcp_conn_destroy(conn);
+		if (rc != EOK)
+			break;
+	}
+
+	bench_run_stop(run);
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed exchanging messages: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_tcp_stream = {
+	.name = "tcp_stream",
+	.desc = "TCP bulk transfer (params 'addr', 'port', 'size')",
+	.entry = &runner_stream,
+	.setup = &setup_sink,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_tcp_rr = {
+	.name = "tcp_rr",
+	.desc = "TCP request/response round trips (params 'addr', 'port', 'size')",
+	.entry = &runner_rr,
+	.setup = &setup_echo,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_tcp_crr = {
+	.name = "tcp_crr",
+	.desc = "TCP connect/request/response/close (params 'addr', 'port', 'size')",
+	.entry = &runner_crr,
+	.setup = &setup_echo,
+	.teardown = &teardown
+};
+
+/** @}
+ */
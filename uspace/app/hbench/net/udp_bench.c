@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <fibril_synch.h>
+#include <inet/endpoint.h>
+#include <inet/udp.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include "../hbench.h"
+
+/** Largest UDP payload over IPv4 */
+#define UDP_MAX_SIZE  65507
+
+/** How long to wait for outstanding datagrams */
+#define UDP_WAIT_USEC  1000000
+
+static udp_t *udp = NULL;
+static udp_assoc_t *srv_assoc = NULL;
+static udp_assoc_t *cli_assoc = NULL;
+static inet_ep_t srv_ep;
+static size_t msg_size;
+static char *buf = NULL;
+static char *srv_buf = NULL;
+static bool srv_echo;
+
+static FIBRIL_MUTEX_INITIALIZE(count_lock);
+static FIBRIL_CONDVAR_INITIALIZE(count_cv);
+
+/** Datagrams received by the server side */
+static uint64_t srv_count;
+/** Datagrams received by the client side */
+static uint64_t cli_count;
+
+static void srv_recv_msg(udp_assoc_t *, udp_rmsg_t *);
+static void cli_recv_msg(udp_assoc_t *, udp_rmsg_t *);
+
+static udp_cb_t srv_cb = {
+	.recv_msg = srv_recv_msg
+};
+
+static udp_cb_t cli_cb = {
+	.recv_msg = cli_recv_msg
+};
+
+/** Count datagram received by the server side, echo it if requested. */
+static void srv_recv_msg(udp_assoc_t *assoc, udp_rmsg_t *rmsg)
+{
+	inet_ep_t ep;
+	size_t size;
+
+	if (srv_echo) {
+		size = udp_rmsg_size(rmsg);
+		if (size > UDP_MAX_SIZE)
+			return;
+		if (udp_rmsg_read(rmsg, 0, srv_buf, size) != EOK)
+			return;
+
+		udp_rmsg_remote_ep(rmsg, &ep);
+		(void) udp_assoc_send_msg(assoc, &ep, srv_buf, size);
+	}
+
+	fibril_mutex_lock(&count_lock);
+	++srv_count;
+	fibril_mutex_unlock(&count_lock);
+	fibril_condvar_broadcast(&count_cv);
+}
+
+/** Count datagram received by the client side. */
+static void cli_recv_msg(udp_assoc_t *assoc, udp_rmsg_t *rmsg)
+{
+	fibril_mutex_lock(&count_lock);
+	++cli_count;
+	fibril_mutex_unlock(&count_lock);
+	fibril_condvar_broadcast(&count_cv);
+}
+
+/** Wait until @a *counter reaches @a target.
+ *
+ * @return EOK on success, ETIMEOUT if no datagram arrived for
+ *         @c UDP_WAIT_USEC
+ */
+static errno_t wait_count(uint64_t *counter, uint64_t target)
+{
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&count_lock);
+	while (*counter < target && rc == EOK) {
+		rc = fibril_condvar_wait_timeout(&count_cv, &count_lock,
+		    UDP_WAIT_USEC);
+	}
+	if (*counter >= target)
+		rc = EOK;
+	fibril_mutex_unlock(&count_lock);
+
+	return rc;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	if (cli_assoc != NULL) {
+		udp_assoc_destroy(cli_assoc);
+		cli_assoc = NULL;
+	}
+
+	if (srv_assoc != NULL) {
+		udp_assoc_destroy(srv_assoc);
+		srv_assoc = NULL;
+	}
+
+	if (udp != NULL) {
+		udp_destroy(udp);
+		udp = NULL;
+	}
+
+	free(buf);
+	buf = NULL;
+	free(srv_buf);
+	srv_buf = NULL;
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run, bool echo,
+    size_t def_size)
+{
+	inet_ep2_t epp;
+	errno_t rc;
+
+	if (!bench_net_params(env, run, def_size, &srv_ep, &msg_size))
+		return false;
+
+	if (msg_size > UDP_MAX_SIZE)
+		return bench_run_fail(run, "size is over %d", UDP_MAX_SIZE);
+
+	buf = calloc(1, msg_size);
+	srv_buf = malloc(UDP_MAX_SIZE);
+	if (buf == NULL || srv_buf == NULL) {
+		teardown(env, run);
+		return bench_run_fail(run, "out of memory");
+	}
+
+	rc = udp_create(&udp);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "failed connecting to UDP: %s",
+		    str_error(rc));
+	}
+
+	srv_echo = echo;
+
+	inet_ep2_init(&epp);
+	epp.local = srv_ep;
+	rc = udp_assoc_create(udp, &epp, &srv_cb, NULL, &srv_assoc);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "failed creating server side: %s",
+		    str_error(rc));
+	}
+
+	inet_ep2_init(&epp);
+	epp.local.addr = srv_ep.addr;
+	epp.remote = srv_ep;
+	rc = udp_assoc_create(udp, &epp, &cli_cb, NULL, &cli_assoc);
+	if (rc != EOK) {
+		teardown(env, run);
+		return bench_run_fail(run, "failed creating client side: %s",
+		    str_error(rc));
+	}
+
+	return true;
+}
+
+static bool setup_echo(bench_env_t *env, bench_run_t *run)
+{
+	return setup(env, run, true, 1);
+}
+
+static bool setup_sink(bench_env_t *env, bench_run_t *run)
+{
+	return setup(env, run, false, 1024);
+}
+
+static bool runner_stream(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	uint64_t received;
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&count_lock);
+	srv_count = 0;
+	fibril_mutex_unlock(&count_lock);
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		rc = udp_assoc_send_msg(cli_assoc, &srv_ep, buf, msg_size);
+		if (rc != EOK)
+			break;
+	}
+
+	if (rc == EOK)
+		rc = wait_count(&srv_count, niter);
+
+	bench_run_stop(run);
+
+	if (rc == ETIMEOUT) {
+		fibril_mutex_lock(&count_lock);
+		received = srv_count;
+		fibril_mutex_unlock(&count_lock);
+
+		return bench_run_fail(run, "lost %" PRIu64 " of %" PRIu64
+		    " datagrams", niter - received, niter);
+	}
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed sending datagram: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+static bool runner_rr(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&count_lock);
+	cli_count = 0;
+	fibril_mutex_unlock(&count_lock);
+
+	bench_run_start(run);
+
+	for (uint64_t count = 0; count < niter; count++) {
+		rc = udp_assoc_send_msg(cli_assoc, &srv_ep, buf, msg_size);
+		if (rc != EOK)
+			break;
+
+		rc = wait_count(&cli_count, count + 1);
+		if (rc != EOK)
+			break;
+	}
+
+	bench_run_stop(run);
+
+	if (rc == ETIMEOUT)
+		return bench_run_fail(run, "request or response lost");
+
+	if (rc != EOK) {
+		return bench_run_fail(run, "failed sending datagram: %s (%d)",
+		    str_error(rc), rc);
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_udp_stream = {
+	.name = "udp_stream",
+	.desc = "UDP datagram throughput (params 'addr', 'port', 'size')",
+	.entry = &runner_stream,
+	.setup = &setup_sink,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_udp_rr = {
+	.name = "udp_rr",
+	.desc = "UDP request/response round trips (params 'addr', 'port', 'size')",
+	.entry = &runner_rr,
+	.setup = &setup_echo,
+	.teardown = &teardown
+};
+
+/** @}
+ */
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <mem.h>
+#include <qsort.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/** Largest number of sorted elements. */
+#define SORT_MAX_COUNT  10000000
+
+/** Default number of sorted elements. */
+#define SORT_DEFAULT_COUNT  1000000
+
+/** Unsorted input, copied to the work array before each sort. */
+static uint32_t *input;
+
+/** Array being sorted. */
+static uint32_t *work;
+
+static size_t count;
+
+static int cmp_u32(const void *a, const void *b, void *arg)
+{
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+
+	if (x < y)
+		return -1;
+	return (x > y) ? 1 : 0;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *order = bench_env_param_get(env, "order", "random");
+	const char *str = bench_env_param_get(env, "count", "1000000");
+	uint32_t seed = 12345;
+	char *end;
+	size_t i;
+
+	count = strtoul(str, &end, 10);
+	if ((*end != '\0') || (count == 0) || (count > SORT_MAX_COUNT)) {
+		return bench_run_fail(run, "count must be a number from 1 to %d",
+		    SORT_MAX_COUNT);
+	}
+
+	input = malloc(count * sizeof(uint32_t));
+	work = malloc(count * sizeof(uint32_t));
+	if ((input == NULL) || (work == NULL)) {
+		free(input);
+		free(work);
+		return bench_run_fail(run, "failed to allocate %zu elements",
+		    count);
+	}
+
+	for (i = 0; i < count; i++) {
+		if (str_cmp(order, "sorted") == 0) {
+			input[i] = i;
+		} else if (str_cmp(order, "reversed") == 0) {
+			input[i] = count - i;
+		} else if (str_cmp(order, "random") == 0) {
+			/* Linear congruential generator from Numerical Recipes */
+			seed = seed * 1664525 + 1013904223;
+			input[i] = seed;
+		} else {
+			free(input);
+			free(work);
+			return bench_run_fail(run, "order must be one of sorted, "
+			    "reversed or random");
+		}
+	}
+
+	return true;
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	free(input);
+	free(work);
+	return true;
+}
+
+/** Check that the work array is in ascending order. */
+static bool check_sorted(bench_run_t *run)
+{
+	size_t i;
+
+	for (i = 1; i < count; i++) {
+		if (work[i - 1] > work[i]) {
+			return bench_run_fail(run, "array not sorted at index %zu",
+			    i);
+		}
+	}
+
+	return true;
+}
+
+static bool runner_qsort(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		memcpy(work, input, count * sizeof(uint32_t));
+		qsort_r(work, count, sizeof(uint32_t), cmp_u32, NULL);
+	}
+	bench_run_stop(run);
+
+	return check_sorted(run);
+}
+
+static bool runner_qsort_parallel(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	fibril_enable_multithreaded();
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		memcpy(work, input, count * sizeof(uint32_t));
+		qsort_parallel(work, count, sizeof(uint32_t), cmp_u32, NULL);
+	}
+	bench_run_stop(run);
+
+	return check_sorted(run);
+}
+
+benchmark_t benchmark_qsort = {
+	.name = "qsort",
+	.desc = "Sort 32-bit integers (use 'count' and 'order' params, order is sorted, reversed or random)",
+	.entry = &runner_qsort,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+benchmark_t benchmark_qsort_parallel = {
+	.name = "qsort_parallel",
+	.desc = "Sort 32-bit integers using multiple fibril runners (use 'count' and 'order' params)",
+	.entry = &runner_qsort_parallel,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../hbench.h"
+
+/** Typical long path handled by VFS and file systems. */
+static const char path_ascii[] =
+    "/data/web/static/images/thumbnails/2024/highres/"
+    "collection-of-samples/subdirectory-with-long-name/last-component.png";
+
+/** The same path with non-ASCII characters in some components. */
+static const char path_utf8[] =
+    "/data/web/statické/obrázky/náhledy/2024/vysoké-rozlišení/"
+    "sbírka-vzorků/podadresář-s-dlouhým-názvem/poslední-součást.png";
+
+/** Run the common string operations on @a str @a niter times. */
+static bool run_str(bench_run_t *run, uint64_t niter, const char *str)
+{
+	char *copy = str_dup(str);
+	if (copy == NULL)
+		return bench_run_fail(run, "failed to duplicate string");
+
+	size_t size = str_size(str);
+	size_t length = str_length(str);
+	bool ret = true;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		if ((str_size(copy) != size) || (str_length(copy) != length) ||
+		    (str_cmp(str, copy) != 0) ||
+		    (str_lcmp(str, copy, length) != 0) ||
+		    (str_chr(copy, '!') != NULL)) {
+			ret = bench_run_fail(run, "string operation result mismatch");
+			break;
+		}
+	}
+	bench_run_stop(run);
+
+	free(copy);
+	return ret;
+}
+
+static bool runner_ascii(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_str(run, niter, path_ascii);
+}
+
+static bool runner_utf8(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	return run_str(run, niter, path_utf8);
+}
+
+benchmark_t benchmark_str_ascii = {
+	.name = "str_ascii",
+	.desc = "str_size/length/cmp/lcmp/chr on a long plain ASCII path",
+	.entry = &runner_ascii,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_str_utf8 = {
+	.name = "str_utf8",
+	.desc = "str_size/length/cmp/lcmp/chr on a long path with non-ASCII characters",
+	.entry = &runner_utf8,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/**
+ * @}
+ */
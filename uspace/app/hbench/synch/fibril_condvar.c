@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Condition variable ping-pong. Two fibrils take turns under a mutex and
+ * wake each other through a condition variable. With extra fibril runner
+ * threads ('runners' param) the two fibrils usually run on different
+ * threads, so the hand-off includes a cross-thread wakeup.
+ */
+
+/** Largest accepted number of extra runners. */
+#define CONDVAR_MAX_RUNNERS  64
+
+typedef struct {
+	fibril_mutex_t mutex;
+	fibril_condvar_t cv;
+	/** Whose turn it is, @c true for the ponger. */
+	bool pong_turn;
+	uint64_t count;
+	atomic_bool done;
+} shared_t;
+
+static errno_t ponger(void *arg)
+{
+	shared_t *shared = arg;
+	fibril_detach(fibril_get_id());
+
+	fibril_mutex_lock(&shared->mutex);
+	for (uint64_t i = 0; i < shared->count; i++) {
+		while (!shared->pong_turn)
+			fibril_condvar_wait(&shared->cv, &shared->mutex);
+		shared->pong_turn = false;
+		fibril_condvar_signal(&shared->cv);
+	}
+	fibril_mutex_unlock(&shared->mutex);
+
+	atomic_store(&shared->done, true);
+
+	return EOK;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	const char *str = bench_env_param_get(env, "runners", "1");
+	char *end;
+
+	long runners = strtol(str, &end, 10);
+	if ((*end != '\0') || (runners < 0) ||
+	    (runners > CONDVAR_MAX_RUNNERS)) {
+		return bench_run_fail(run, "runners must be a number up to %d",
+		    CONDVAR_MAX_RUNNERS);
+	}
+
+	return bench_spawn_runners(run, runners);
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	shared_t shared;
+	fibril_mutex_initialize(&shared.mutex);
+	fibril_condvar_initialize(&shared.cv);
+	shared.pong_turn = false;
+	shared.count = size;
+	atomic_store(&shared.done, false);
+
+	fid_t other = fibril_create(ponger, &shared);
+	if (other == 0)
+		return bench_run_fail(run, "failed creating fibril");
+	fibril_add_ready(other);
+
+	bench_run_start(run);
+	fibril_mutex_lock(&shared.mutex);
+	for (uint64_t i = 0; i < size; i++) {
+		shared.pong_turn = true;
+		fibril_condvar_signal(&shared.cv);
+		while (shared.pong_turn)
+			fibril_condvar_wait(&shared.cv, &shared.mutex);
+	}
+	fibril_mutex_unlock(&shared.mutex);
+	bench_run_stop(run);
+
+	while (!atomic_load(&shared.done)) {
+		fibril_yield();
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_fibril_condvar = {
+	.name = "fibril_condvar",
+	.desc = "Condition variable ping-pong between fibrils ('runners' param, default 1)",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+/** @}
+ */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/*
+ * Cost of fibril creation and termination. Each iteration starts a batch
+ * of fibrils that do nothing but signal their completion, and waits for
+ * all of them, which stands in for a join.
+ */
+
+/** Largest accepted batch. */
+#define SPAWN_MAX_BATCH  1024
+
+static errno_t worker(void *arg)
+{
+	fibril_semaphore_t *done = arg;
+	fibril_detach(fibril_get_id());
+
+	fibril_semaphore_up(done);
+	return EOK;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	const char *str = bench_env_param_get(env, "batch", "1");
+	fibril_semaphore_t done;
+	char *end;
+
+	size_t batch = strtoul(str, &end, 10);
+	if ((*end != '\0') || (batch == 0) || (batch > SPAWN_MAX_BATCH)) {
+		return bench_run_fail(run, "batch must be a number up to %d",
+		    SPAWN_MAX_BATCH);
+	}
+
+	fibril_semaphore_initialize(&done, 0);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		for (size_t j = 0; j < batch; j++) {
+			fid_t fid = fibril_create(worker, &done);
+			if (fid == 0) {
+				bench_run_stop(run);
+				/* Do not leave running fibrils behind */
+				while (j-- > 0)
+					fibril_semaphore_down(&done);
+				return bench_run_fail(run, "failed creating fibril");
+			}
+			fibril_add_ready(fid);
+		}
+
+		for (size_t j = 0; j < batch; j++)
+			fibril_semaphore_down(&done);
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+benchmark_t benchmark_fibril_spawn = {
+	.name = "fibril_spawn",
+	.desc = "Create fibrils and wait for them to finish ('batch' param, default 1)",
+	.entry = &runner,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/** @}
+ */
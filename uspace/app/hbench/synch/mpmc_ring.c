@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <adt/mpmc_ring.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../hbench.h"
+
+/** Largest number of producers and of consumers. */
+#define MPMC_MAX_SIDE  8
+
+/** Ring capacity. */
+#define MPMC_CAPACITY  256
+
+static mpmc_ring_t ring;
+static int producers;
+static int consumers;
+
+/** Ticket deciding whether a worker becomes a producer or a consumer. */
+static atomic_int ticket;
+
+/** Number of items still to be consumed in the current run. */
+static atomic_int_fast64_t remaining;
+
+static bool parse_side(bench_env_t *env, bench_run_t *run, const char *name,
+    int *res)
+{
+	const char *str = bench_env_param_get(env, name, "1");
+	char *end;
+	long val;
+
+	val = strtol(str, &end, 10);
+	if ((*end != '\0') || (val < 1) || (val > MPMC_MAX_SIDE)) {
+		return bench_run_fail(run, "%s must be a number from 1 to %d",
+		    name, MPMC_MAX_SIDE);
+	}
+
+	*res = val;
+	return true;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	errno_t rc;
+
+	if (!parse_side(env, run, "producers", &producers))
+		return false;
+	if (!parse_side(env, run, "consumers", &consumers))
+		return false;
+
+	rc = mpmc_ring_initialize(&ring, MPMC_CAPACITY, MPMC_RING_BLOCKING);
+	if (rc != EOK)
+		return bench_run_fail(run, "failed to initialize ring");
+
+	return bench_spawn_runners(run, producers + consumers - 1);
+}
+
+static bool teardown(bench_env_t *env, bench_run_t *run)
+{
+	mpmc_ring_destroy(&ring);
+	return true;
+}
+
+/** Either push @a niter items or pop until everything has been consumed. */
+static bool worker(uint64_t niter)
+{
+	uint64_t i;
+
+	if (atomic_fetch_add(&ticket, 1) < producers) {
+		for (i = 0; i < niter; i++)
+			mpmc_ring_push(&ring, (void *) (uintptr_t) (i + 1));
+	} else {
+		while (atomic_fetch_sub(&remaining, 1) > 0) {
+			if (mpmc_ring_pop(&ring) == NULL)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t niter)
+{
+	atomic_store(&ticket, 0);
+	atomic_store(&remaining, (int_fast64_t) niter * producers);
+
+	return bench_run_parallel(run, producers + consumers, worker, niter);
+}
+
+benchmark_t benchmark_mpmc_ring = {
+	.name = "mpmc_ring",
+	.desc = "Pass items through a lock-free ring (use 'producers' and 'consumers' params, 1 to 8)",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = &teardown
+};
+
+/**
+ * @}
+ */
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdatomic.h>
+#include "../hbench.h"
+
+/*
+ * Benchmark of kernel thread context switches. Two fibrils hand a token
+ * back and forth through a pair of semaphores. With a second fibril
+ * runner thread in place, the runner that is left without a ready fibril
+ * blocks in the kernel, so each hand-off costs one kernel wakeup and one
+ * pass through the scheduler.
+ */
+
+typedef struct {
+	fibril_semaphore_t ping;
+	fibril_semaphore_t pong;
+	uint64_t count;
+	atomic_bool done;
+} shared_t;
+
+static errno_t ponger(void *arg)
+{
+	shared_t *shared = arg;
+	fibril_detach(fibril_get_id());
+
+	for (uint64_t i = 0; i < shared->count; i++) {
+		fibril_semaphore_down(&shared->ping);
+		fibril_semaphore_up(&shared->pong);
+	}
+
+	atomic_store(&shared->done, true);
+
+	return EOK;
+}
+
+static bool setup(bench_env_t *env, bench_run_t *run)
+{
+	return bench_spawn_runners(run, 1);
+}
+
+static bool runner(bench_env_t *env, bench_run_t *run, uint64_t size)
+{
+	shared_t shared;
+	fibril_semaphore_initialize(&shared.ping, 0);
+	fibril_semaphore_initialize(&shared.pong, 0);
+	shared.count = size;
+	atomic_store(&shared.done, false);
+
+	fid_t other = fibril_create(ponger, &shared);
+	if (other == 0)
+		return bench_run_fail(run, "failed creating fibril");
+	fibril_add_ready(other);
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < size; i++) {
+		fibril_semaphore_up(&shared.ping);
+		fibril_semaphore_down(&shared.pong);
+	}
+	bench_run_stop(run);
+
+	while (!atomic_load(&shared.done)) {
+		fibril_yield();
+	}
+
+	return true;
+}
+
+benchmark_t benchmark_thread_switch = {
+	.name = "thread_switch",
+	.desc = "Speed of thread context switches (semaphore ping-pong)",
+	.entry = &runner,
+	.setup = &setup,
+	.teardown = NULL
+};
+
+/** @}
+ */
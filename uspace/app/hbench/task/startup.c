@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hbench
+ * @{
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <str_error.h>
+#include <task.h>
+#include "../hbench.h"
+
+/** Spawn a program and wait for it to terminate.
+ *
+ * The program is passed the --startup-only option which makes it exit
+ * right after it has been loaded, dynamically linked and has reached
+ * main(). The run time is therefore dominated by program loading and
+ * symbol resolution in the dynamic linker.
+ */
+static bool runner_startup(bench_env_t *env, bench_run_t *run, uint64_t niter,
+    const char *path)
+{
+	const char *args[] = { path, "--startup-only", NULL };
+	task_wait_t wait;
+	task_exit_t texit;
+	task_id_t id;
+	int retval;
+	errno_t rc;
+
+	bench_run_start(run);
+	for (uint64_t i = 0; i < niter; i++) {
+		rc = task_spawnv(&id, &wait, path, args);
+		if (rc != EOK) {
+			bench_run_stop(run);
+			return bench_run_fail(run, "failed spawning %s: %s", path,
+			    str_error(rc));
+		}
+
+		rc = task_wait(&wait, &texit, &retval);
+		if (rc != EOK || texit != TASK_EXIT_NORMAL || retval != 0) {
+			bench_run_stop(run);
+			return bench_run_fail(run, "%s did not terminate normally",
+			    path);
+		}
+	}
+	bench_run_stop(run);
+
+	return true;
+}
+
+static bool runner_startup_cpptest(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	return runner_startup(env, run, niter,
+	    bench_env_param_get(env, "program", "/app/cpptest"));
+}
+
+static bool runner_startup_uidemo(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	return runner_startup(env, run, niter,
+	    bench_env_param_get(env, "program", "/app/uidemo"));
+}
+
+static bool runner_task_spawn(bench_env_t *env, bench_run_t *run,
+    uint64_t niter)
+{
+	return runner_startup(env, run, niter,
+	    bench_env_param_get(env, "program", "/app/hbench"));
+}
+
+benchmark_t benchmark_startup_cpptest = {
+	.name = "startup_cpptest",
+	.desc = "Start a dynamically linked C++ program (cpptest) and wait for it to exit",
+	.entry = &runner_startup_cpptest,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_startup_uidemo = {
+	.name = "startup_uidemo",
+	.desc = "Start a dynamically linked UI program (uidemo) and wait for it to exit",
+	.entry = &runner_startup_uidemo,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+benchmark_t benchmark_task_spawn = {
+	.name = "task_spawn",
+	.desc = "Spawn a task and wait for it to exit ('program' param, default hbench itself)",
+	.entry = &runner_task_spawn,
+	.setup = NULL,
+	.teardown = NULL
+};
+
+/**
+ * @}
+ */
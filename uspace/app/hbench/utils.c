@@ -33,8 +33,12 @@
  * @file
  */
 
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "hbench.h"
 
 /** Initialize bench run structure.
@@ -75,5 +79,148 @@ bool bench_run_fail(bench_run_t *run, const char *fmt, ...)
 	return false;
 }
 
+/** Make sure the task has at least a given number of extra fibril runners.
+ *
+ * Runners cannot be stopped, so they are only ever added.
+ *
+ * @param run Current benchmark run.
+ * @param count Number of runners besides the main thread.
+ * @return Whether the runners are available.
+ */
+bool bench_spawn_runners(bench_run_t *run, int count)
+{
+	static int spawned = 0;
+
+	if (spawned < count) {
+		spawned += fibril_test_spawn_runners(count - spawned);
+		if (spawned < count)
+			return bench_run_fail(run, "failed spawning fibril runners");
+	}
+
+	return true;
+}
+
+/** Get the number of threads a multi-threaded benchmark should use.
+ *
+ * Taken from the "threads" parameter, 4 by default.
+ *
+ * @param env Benchmark environment.
+ * @return Number of threads (at least one).
+ */
+int bench_env_threads(bench_env_t *env)
+{
+	const char *value = bench_env_param_get(env, "threads", "4");
+	int threads = (int) strtol(value, NULL, 10);
+	return (threads > 0) ? threads : 1;
+}
+
+typedef struct {
+	bench_worker_t worker;
+	uint64_t niter;
+	bool ok;
+	fibril_semaphore_t *finished;
+} bench_worker_arg_t;
+
+static errno_t bench_worker_fibril(void *arg)
+{
+	bench_worker_arg_t *warg = arg;
+	fibril_detach(fibril_get_id());
+
+	warg->ok = warg->worker(warg->niter);
+	fibril_semaphore_up(warg->finished);
+
+	return EOK;
+}
+
+/** Run a worker in several fibrils at once and measure the whole batch.
+ *
+ * The fibrils are spread over the runners spawned with
+ * bench_spawn_runners().
+ *
+ * @param run Current benchmark run.
+ * @param count Number of fibrils.
+ * @param worker Function executed by each fibril.
+ * @param niter Number of iterations for each fibril.
+ * @return Whether all workers succeeded.
+ */
+bool bench_run_parallel(bench_run_t *run, int count, bench_worker_t worker,
+    uint64_t niter)
+{
+	fibril_semaphore_t finished;
+	fibril_semaphore_initialize(&finished, 0);
+
+	bench_worker_arg_t *args = calloc(count, sizeof(bench_worker_arg_t));
+	fid_t *fids = calloc(count, sizeof(fid_t));
+	if (args == NULL || fids == NULL) {
+		free(args);
+		free(fids);
+		return bench_run_fail(run, "failed to allocate worker arguments");
+	}
+
+	for (int i = 0; i < count; i++) {
+		args[i] = (bench_worker_arg_t) {
+			.worker = worker,
+			.niter = niter,
+			.finished = &finished
+		};
+
+		fids[i] = fibril_create(bench_worker_fibril, &args[i]);
+		if (fids[i] == 0) {
+			for (int j = 0; j < i; j++)
+				fibril_destroy(fids[j]);
+			free(args);
+			free(fids);
+			return bench_run_fail(run, "failed creating fibril");
+		}
+	}
+
+	bench_run_start(run);
+	for (int i = 0; i < count; i++)
+		fibril_add_ready(fids[i]);
+	for (int i = 0; i < count; i++)
+		fibril_semaphore_down(&finished);
+	bench_run_stop(run);
+
+	bool ok = true;
+	for (int i = 0; i < count; i++) {
+		if (!args[i].ok) {
+			ok = bench_run_fail(run, "worker %d failed", i);
+			break;
+		}
+	}
+
+	free(args);
+	free(fids);
+	return ok;
+}
+
+/** Estimate square root value.
+ *
+ * @param value The value to compute square root of.
+ * @param precision Required precision (e.g. 0.00001).
+ *
+ * @details
+ *
+ * This is a temporary solution until we have proper sqrt() implementation
+ * in libmath.
+ *
+ * The algorithm uses Babylonian method [1].
+ *
+ * [1] https://en.wikipedia.org/wiki/Methods_of_computing_square_roots#Babylonian_method
+ */
+double estimate_square_root(double value, double precision)
+{
+	double estimate = 1.;
+	double prev_estimate = estimate + 10 * precision;
+
+	while (fabs(estimate - prev_estimate) > precision) {
+		prev_estimate = estimate;
+		estimate = (prev_estimate + value / prev_estimate) / 2.;
+	}
+
+	return estimate;
+}
+
+
 /** @}
  */
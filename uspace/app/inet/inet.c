@@ -38,6 +38,7 @@
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/inetcfg.h>
+#include <inttypes.h>
 #include <io/table.h>
 #include <loc.h>
 #include <stdio.h>
@@ -59,6 +60,7 @@ static void print_syntax(void)
 	printf("  %s create-sr <dest-addr>/<width> <router-addr> <route-name>\n", NAME);
 	printf("  %s delete-sr <route-name>\n", NAME);
 	printf("  %s list-link\n", NAME);
+	printf("  %s show-reass\n", NAME);
 }
 
 static errno_t addr_create_static(int argc, char *argv[])
@@ -481,6 +483,27 @@ out:
 	return rc;
 }
 
+static errno_t reass_show(void)
+{
+	inet_reass_stats_t stats;
+	errno_t rc;
+
+	rc = inetcfg_reass_stats_get(&stats);
+	if (rc != EOK) {
+		printf(NAME ": Failed getting reassembly statistics.\n");
+		return rc;
+	}
+
+	printf("Reassembled:  %" PRIu64 "\n", stats.reassembled);
+	printf("Timeouts:     %" PRIu64 "\n", stats.timeouts);
+	printf("Evictions:    %" PRIu64 "\n", stats.evictions);
+	printf("Drops:        %" PRIu64 "\n", stats.drops);
+	printf("Overlaps:     %" PRIu64 "\n", stats.overlaps);
+	printf("Pending:      %" PRIu64 "\n", stats.pending);
+	printf("Memory used:  %" PRIu64 " bytes\n", stats.mem_used);
+	return EOK;
+}
+
 int main(int argc, char *argv[])
 {
 	errno_t rc;
@@ -525,6 +548,10 @@ int main(int argc, char *argv[])
 		rc = link_list();
 		if (rc != EOK)
 			return 1;
+	} else if (str_cmp(argv[1], "show-reass") == 0) {
+		rc = reass_show();
+		if (rc != EOK)
+			return 1;
 	} else {
 		printf(NAME ": Unknown command '%s'.\n", argv[1]);
 		print_syntax();
@@ -46,6 +46,7 @@
 #include <loc.h>
 #include <str_error.h>
 #include <config.h>
+#include <io/klog.h>
 #include <io/logctl.h>
 #include <vfs/vfs.h>
 #include <vol.h>
@@ -196,6 +197,7 @@ static errno_t srv_startl(const char *path, ...)
 	}
 
 	printf("%s: Starting %s\n", NAME, path);
+	klog_bootmark("start %s", path);
 
 	va_list ap;
 	const char *arg;
@@ -246,6 +248,8 @@ static errno_t srv_startl(const char *path, ...)
 		printf("%s: Server %s failed to start (exit code %d)\n", NAME,
 		    path, retval);
 
+	klog_bootmark("done %s", path);
+
 	return retval == 0 ? EOK : EPARTY;
 }
 
@@ -418,6 +422,7 @@ int main(int argc, char *argv[])
 {
 	errno_t rc;
 
+	klog_bootmark("init: entry");
 	info_print();
 
 	if (!mount_root(STRING(RDFMT))) {
@@ -483,6 +488,7 @@ int main(int argc, char *argv[])
 #endif
 	rc = console(HID_INPUT, HID_OUTPUT);
 	if (rc == EOK) {
+		klog_bootmark("init: spawning terminals");
 		getterm("term/vc0", "/app/bdsh", true);
 		getterm("term/vc1", "/app/bdsh", false);
 		getterm("term/vc2", "/app/bdsh", false);
@@ -0,0 +1,4 @@
+/** @addtogroup iostat iostat
+ * @brief Print block device and file system I/O statistics
+ * @ingroup apps
+ */
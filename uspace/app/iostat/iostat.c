@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup iostat
+ * @brief Print block device and file system I/O statistics.
+ * @{
+ */
+/**
+ * @file
+ */
+
+#include <adt/list.h>
+#include <bd.h>
+#include <errno.h>
+#include <fibril.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <loc.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <time.h>
+#include <vfs/vfs.h>
+#include <vfs/vfs_mtab.h>
+
+#define NAME  "iostat"
+
+#define HEADER_DEV \
+	"Device                  r/s    w/s  rKiB/s  wKiB/s err/s avgqu util%% svc_us"
+#define HEADER_MNT \
+	"Mount point          hits/s miss/s  hit%%    ra/s used%% wasted/s"
+
+/** Block device being watched */
+typedef struct {
+	link_t link;
+	char *name;
+	async_sess_t *sess;
+	bd_t *bd;
+	bd_stats_t prev;
+} iostat_dev_t;
+
+/** Mounted file system being watched */
+typedef struct {
+	link_t link;
+	char *mp;
+	vfs_block_stats_t prev;
+} iostat_mnt_t;
+
+static LIST_INITIALIZE(devs);
+static LIST_INITIALIZE(mnts);
+
+static bool show_hist;
+
+static void print_usage(void);
+
+/** Compute a rate per second.
+ *
+ * @param delta Difference of a counter
+ * @param usec  Length of the interval in microseconds
+ */
+static uint64_t rate(uint64_t delta, uint64_t usec)
+{
+	if (usec == 0)
+		return 0;
+	return delta * 1000000 / usec;
+}
+
+/** Add a block device to the watched devices.
+ *
+ * @param sid Service ID of the device
+ */
+static void dev_add(service_id_t sid)
+{
+	iostat_dev_t *dev;
+	errno_t rc;
+
+	dev = calloc(1, sizeof(iostat_dev_t));
+	if (dev == NULL)
+		return;
+
+	rc = loc_service_get_name(sid, &dev->name);
+	if (rc != EOK)
+		goto error;
+
+	dev->sess = loc_service_connect(sid, INTERFACE_BLOCK, 0);
+	if (dev->sess == NULL)
+		goto error;
+
+	rc = bd_open(dev->sess, &dev->bd);
+	if (rc != EOK)
+		goto error;
+
+	rc = bd_get_stats(dev->bd, &dev->prev);
+	if (rc != EOK) {
+		bd_close(dev->bd);
+		goto error;
+	}
+
+	list_append(&dev->link, &devs);
+	return;
+error:
+	if (dev->sess != NULL)
+		async_hangup(dev->sess);
+	free(dev->name);
+	free(dev);
+}
+
+/** Add the block devices of a location service category.
+ *
+ * @param cat_name Name of the category
+ */
+static void dev_add_category(const char *cat_name)
+{
+	category_id_t cat_id;
+	service_id_t *svcs;
+	size_t count;
+	errno_t rc;
+
+	rc = loc_category_get_id(cat_name, &cat_id, 0);
+	if (rc != EOK)
+		return;
+
+	rc = loc_category_get_svcs(cat_id, &svcs, &count);
+	if (rc != EOK)
+		return;
+
+	for (size_t i = 0; i < count; i++)
+		dev_add(svcs[i]);
+
+	free(svcs);
+}
+
+/** Add the mounted file systems to the watched file systems. */
+static void mnt_add_all(void)
+{
+	LIST_INITIALIZE(mtab_list);
+	vfs_statfs_t st;
+
+	if (vfs_get_mtab_list(&mtab_list) != EOK)
+		return;
+
+	list_foreach(mtab_list, link, mtab_ent_t, ent) {
+		iostat_mnt_t *mnt;
+
+		if (vfs_statfs_path(ent->mp, &st) != EOK)
+			continue;
+
+		mnt = calloc(1, sizeof(iostat_mnt_t));
+		if (mnt == NULL)
+			break;
+
+		mnt->mp = str_dup(ent->mp);
+		if (mnt->mp == NULL) {
+			free(mnt);
+			break;
+		}
+
+		mnt->prev = st.f_cache;
+		list_append(&mnt->link, &mnts);
+	}
+
+	while (!list_empty(&mtab_list)) {
+		mtab_ent_t *ent = list_get_instance(list_first(&mtab_list),
+		    mtab_ent_t, link);
+
+		list_remove(&ent->link);
+		free(ent);
+	}
+}
+
+/** Print the service time histogram of an interval.
+ *
+ * @param cur  Current statistics
+ * @param prev Statistics at the start of the interval
+ */
+static void print_hist(bd_stats_t *cur, bd_stats_t *prev)
+{
+	printf("  svc_us");
+	for (size_t i = 0; i < BD_STATS_HIST_BUCKETS; i++) {
+		uint64_t n = cur->hist[i] - prev->hist[i];
+
+		if (n == 0)
+			continue;
+
+		if (i < BD_STATS_HIST_BUCKETS - 1)
+			printf(" <%" PRIu64 ":%" PRIu64, (uint64_t) 2 << i, n);
+		else
+			printf(" >=%" PRIu64 ":%" PRIu64, (uint64_t) 1 << i, n);
+	}
+	putchar('\n');
+}
+
+/** Print the statistics of the block devices for the last interval. */
+static void print_devs(void)
+{
+	bd_stats_t cur;
+
+	printf(HEADER_DEV);
+	putchar('\n');
+
+	list_foreach(devs, link, iostat_dev_t, dev) {
+		bd_stats_t *prev = &dev->prev;
+		uint64_t usec;
+		uint64_t nreq;
+
+		if (bd_get_stats(dev->bd, &cur) != EOK)
+			continue;
+
+		usec = cur.uptime - prev->uptime;
+		nreq = (cur.reads - prev->reads) + (cur.writes - prev->writes) +
+		    (cur.errors - prev->errors);
+
+		printf("%-20s %6" PRIu64 " %6" PRIu64 " %7" PRIu64 " %7" PRIu64
+		    " %5" PRIu64 " %2" PRIu64 ".%02" PRIu64 " %5" PRIu64
+		    " %6" PRIu64 "\n", dev->name,
+		    rate(cur.reads - prev->reads, usec),
+		    rate(cur.writes - prev->writes, usec),
+		    rate(cur.read_bytes - prev->read_bytes, usec) / 1024,
+		    rate(cur.write_bytes - prev->write_bytes, usec) / 1024,
+		    rate(cur.errors - prev->errors, usec),
+		    rate(cur.queue_usec - prev->queue_usec, usec) / 1000000,
+		    rate(cur.queue_usec - prev->queue_usec, usec) / 10000 % 100,
+		    rate(cur.busy_usec - prev->busy_usec, usec) / 10000,
+		    nreq != 0 ?
+		    (cur.service_usec - prev->service_usec) / nreq : 0);
+
+		if (show_hist)
+			print_hist(&cur, prev);
+
+		*prev = cur;
+	}
+}
+
+/** Print the block cache statistics of the file systems.
+ *
+ * @param usec Length of the last interval in microseconds
+ */
+static void print_mnts(uint64_t usec)
+{
+	vfs_statfs_t st;
+
+	printf(HEADER_MNT);
+	putchar('\n');
+
+	list_foreach(mnts, link, iostat_mnt_t, mnt) {
+		vfs_block_stats_t *prev = &mnt->prev;
+		vfs_block_stats_t *cur = &st.f_cache;
+		uint64_t hits, misses, used, wasted;
+
+		if (vfs_statfs_path(mnt->mp, &st) != EOK)
+			continue;
+
+		hits = cur->hits - prev->hits;
+		misses = cur->misses - prev->misses;
+		used = cur->ra_used - prev->ra_used;
+		wasted = cur->ra_wasted - prev->ra_wasted;
+
+		printf("%-20s %6" PRIu64 " %6" PRIu64 " %4" PRIu64 "%% %7"
+		    PRIu64 " %4" PRIu64 "%% %8" PRIu64 "\n", mnt->mp,
+		    rate(hits, usec), rate(misses, usec),
+		    hits + misses != 0 ? 100 * hits / (hits + misses) : 0,
+		    rate(cur->ra_blocks - prev->ra_blocks, usec),
+		    used + wasted != 0 ? 100 * used / (used + wasted) : 0,
+		    rate(wasted, usec));
+
+		*prev = *cur;
+	}
+}
+
+static usec_t uptime_usec(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long interval = 1;
+	unsigned long count = 0;
+	int optres, errflg = 0;
+	usec_t last, now;
+
+	show_hist = false;
+
+	/* Parse command-line options */
+	while ((optres = getopt(argc, argv, "c:i:lh")) != -1) {
+		switch (optres) {
+		case 'h':
+			print_usage();
+			return 0;
+
+		case 'c':
+			count = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'i':
+			interval = strtoul(optarg, NULL, 10);
+			if (interval == 0) {
+				fprintf(stderr, "Invalid interval '%s'\n",
+				    optarg);
+				errflg++;
+			}
+			break;
+
+		case 'l':
+			show_hist = true;
+			break;
+
+		case '?':
+			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
+			errflg++;
+			break;
+
+		default:
+			fprintf(stderr,
+			    "Unknown error while parsing command line options");
+			errflg++;
+			break;
+		}
+	}
+
+	if (optind < argc) {
+		fprintf(stderr, "Too many input parameters\n");
+		errflg++;
+	}
+
+	if (errflg) {
+		print_usage();
+		return 1;
+	}
+
+	dev_add_category("disk");
+	dev_add_category("partition");
+	mnt_add_all();
+
+	if (list_empty(&devs) && list_empty(&mnts)) {
+		fprintf(stderr, "%s: No block devices or file systems found.\n",
+		    NAME);
+		return 1;
+	}
+
+	last = uptime_usec();
+	for (unsigned long i = 0; count == 0 || i < count; i++) {
+		fibril_usleep(SEC2USEC(interval));
+		now = uptime_usec();
+
+		if (!list_empty(&devs))
+			print_devs();
+		if (!list_empty(&mnts))
+			print_mnts(now - last);
+		putchar('\n');
+
+		last = now;
+	}
+
+	return 0;
+}
+
+static void print_usage(void)
+{
+	printf("Syntax: %s [<options>]\n", NAME);
+	printf("Options:\n");
+	printf("  -h          Print help\n");
+	printf("  -i <secs>   Interval between reports (default 1)\n");
+	printf("  -c <count>  Number of reports (default unlimited)\n");
+	printf("  -l          Print service time histograms\n");
+}
+
+/** @}
+ */
@@ -38,7 +38,9 @@
 #include <str_error.h>
 #include <str.h>
 #include <audio_mixer_iface.h>
+#include <hound/protocol.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #define DEFAULT_SERVICE "devices/\\hw\\pci0\\00:01.0\\sb16\\control"
 
@@ -125,11 +127,55 @@ static void get_level(async_exch_t *exch, int argc, char *argv[])
 	printf("Control item %u level: %u.\n", item, value);
 }
 
+/**
+ * Print xrun counters of all sinks of the sound service.
+ * @return Exit code.
+ */
+static int print_xruns(void)
+{
+	hound_sess_t *sess = hound_service_connect(HOUND_SERVICE);
+	if (!sess) {
+		printf("Failed to connect to the sound service.\n");
+		return 1;
+	}
+
+	char **names = NULL;
+	size_t count = 0;
+	errno_t ret = hound_service_get_list_all(sess, &names, &count,
+	    HOUND_SINK_DEVS | HOUND_SINK_APPS);
+	if (ret != EOK) {
+		printf("Failed to get sink list: %s.\n", str_error(ret));
+		hound_service_disconnect(sess);
+		return 1;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		size_t underruns, overruns;
+		ret = hound_service_get_xruns(sess, names[i], &underruns,
+		    &overruns);
+		if (ret != EOK) {
+			printf("Failed to get sink `%s' xruns: %s.\n",
+			    names[i], str_error(ret));
+		} else {
+			printf("Sink `%s' : %zu underruns, %zu overruns.\n",
+			    names[i], underruns, overruns);
+		}
+		free(names[i]);
+	}
+	free(names);
+
+	hound_service_disconnect(sess);
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	const char *service = DEFAULT_SERVICE;
 	void (*command)(async_exch_t *, int, char *[]) = NULL;
 
+	if (argc == 2 && str_cmp(argv[1], "xruns") == 0)
+		return print_xruns();
+
 	if (argc >= 2 && str_cmp(argv[1], "setlevel") == 0) {
 		command = set_level;
 		if (argc == 5)
@@ -175,6 +221,8 @@ int main(int argc, char *argv[])
 		    "settings\n", argv[0]);
 		printf("Use '%s setlevel idx' command to change "
 		    "settings\n", argv[0]);
+		printf("Use '%s xruns' command to show sound service "
+		    "xrun counters\n", argv[0]);
 	}
 
 	async_exchange_end(exch);
@@ -132,7 +132,11 @@ int main(int argc, char *argv[])
 #else
 	format.sample_format = PCM_SAMPLE_SINT16_BE;
 #endif
-	buffer_size = 64 * 1024;
+	/*
+	 * Keep about 90 ms queued in the server, written in ~23 ms chunks,
+	 * so that playback reacts quickly to key presses.
+	 */
+	buffer_size = 8 * 1024;
 
 	buffer = malloc(buffer_size);
 	if (buffer == NULL) {
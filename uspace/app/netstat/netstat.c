@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup netstat
+ * @brief Print TCP connections and their statistics.
+ * @{
+ */
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inet/addr.h>
+#include <inet/endpoint.h>
+#include <inet/tcp.h>
+#include <inttypes.h>
+#include <io/table.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+
+#define NAME  "netstat"
+
+static void print_usage(void);
+
+/** Connection state names indexed by tcp_info_state_t */
+static const char *state_name[] = {
+	[tcp_is_listen] = "LISTEN",
+	[tcp_is_syn_sent] = "SYN-SENT",
+	[tcp_is_syn_received] = "SYN-RECEIVED",
+	[tcp_is_established] = "ESTABLISHED",
+	[tcp_is_fin_wait_1] = "FIN-WAIT-1",
+	[tcp_is_fin_wait_2] = "FIN-WAIT-2",
+	[tcp_is_close_wait] = "CLOSE-WAIT",
+	[tcp_is_closing] = "CLOSING",
+	[tcp_is_last_ack] = "LAST-ACK",
+	[tcp_is_time_wait] = "TIME-WAIT",
+	[tcp_is_closed] = "CLOSED"
+};
+
+/** Format endpoint as a string.
+ *
+ * @param ep   Endpoint
+ * @param rstr Place to store pointer to newly allocated string
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t ep_format(inet_ep_t *ep, char **rstr)
+{
+	char *astr;
+	errno_t rc;
+	int rv;
+
+	if (inet_addr_is_any(&ep->addr)) {
+		astr = NULL;
+	} else {
+		rc = inet_addr_format(&ep->addr, &astr);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if (ep->port == inet_port_any)
+		rv = asprintf(rstr, "%s:*", astr != NULL ? astr : "*");
+	else
+		rv = asprintf(rstr, "%s:%" PRIu16, astr != NULL ? astr : "*",
+		    ep->port);
+
+	free(astr);
+	return rv < 0 ? ENOMEM : EOK;
+}
+
+/** Print connection list.
+ *
+ * @param info  Connection information
+ * @param count Number of connections
+ * @param stats @c true to print per-connection statistics
+ * @return EOK on success or an error code
+ */
+static errno_t print_conns(tcp_conn_info_t *info, size_t count, bool stats)
+{
+	table_t *table = NULL;
+	char *lstr = NULL;
+	char *rstr = NULL;
+	const char *sname;
+	errno_t rc;
+	size_t i;
+
+	rc = table_create(&table);
+	if (rc != EOK) {
+		printf("Memory allocation failed.\n");
+		goto out;
+	}
+
+	table_header_row(table);
+	if (!stats) {
+		table_printf(table, "Local\t" "Remote\t" "State\t"
+		    "Recv-Q\t" "Send-Q\n");
+	} else {
+		table_printf(table, "Local\t" "Remote\t" "State\t"
+		    "Segs-In\t" "Segs-Out\t" "Bytes-In\t" "Bytes-Out\t"
+		    "Retrans\t" "RTO-Exp\t" "Dup-ACK\t" "SRTT-us\t"
+		    "RTO-us\t" "Cwnd\t" "Ssthresh\t" "In-Flight\n");
+	}
+
+	for (i = 0; i < count; i++) {
+		rc = ep_format(&info[i].ident.local, &lstr);
+		if (rc != EOK)
+			goto out;
+
+		rc = ep_format(&info[i].ident.remote, &rstr);
+		if (rc != EOK)
+			goto out;
+
+		if (info[i].state < sizeof(state_name) / sizeof(state_name[0]))
+			sname = state_name[info[i].state];
+		else
+			sname = "?";
+
+		if (!stats) {
+			table_printf(table, "%s\t" "%s\t" "%s\t"
+			    "%" PRIu32 "\t" "%" PRIu32 "\n", lstr, rstr, sname,
+			    info[i].rcv_queue, info[i].snd_queue);
+		} else {
+			table_printf(table, "%s\t" "%s\t" "%s\t"
+			    "%" PRIu64 "\t" "%" PRIu64 "\t" "%" PRIu64 "\t"
+			    "%" PRIu64 "\t" "%" PRIu64 "\t" "%" PRIu64 "\t"
+			    "%" PRIu64 "\t" "%" PRIu64 "\t" "%" PRIu64 "\t"
+			    "%" PRIu32 "\t" "%" PRIu32 "\t" "%" PRIu32 "\n",
+			    lstr, rstr, sname, info[i].segs_in,
+			    info[i].segs_out, info[i].bytes_in,
+			    info[i].bytes_out, info[i].retransmits,
+			    info[i].rto_timeouts, info[i].dupacks,
+			    info[i].srtt, info[i].rto, info[i].cwnd,
+			    info[i].ssthresh, info[i].in_flight);
+		}
+
+		free(lstr);
+		free(rstr);
+		lstr = NULL;
+		rstr = NULL;
+	}
+
+	if (count != 0) {
+		rc = table_print_out(table, stdout);
+		if (rc != EOK) {
+			printf("Error printing table.\n");
+			goto out;
+		}
+	}
+
+	rc = EOK;
+out:
+	table_destroy(table);
+	free(lstr);
+	free(rstr);
+	return rc;
+}
+
+int main(int argc, char *argv[])
+{
+	tcp_conn_info_t *info;
+	tcp_t *tcp;
+	size_t count;
+	bool stats = false;
+	bool listen = true;
+	int optres, errflg = 0;
+	errno_t rc;
+
+	/* Parse command-line options */
+	while ((optres = getopt(argc, argv, "hsL")) != -1) {
+		switch (optres) {
+		case 'h':
+			print_usage();
+			return 0;
+
+		case 's':
+			stats = true;
+			break;
+
+		case 'L':
+			listen = false;
+			break;
+
+		case '?':
+			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
+			errflg++;
+			break;
+
+		default:
+			fprintf(stderr,
+			    "Unknown error while parsing command line options");
+			errflg++;
+			break;
+		}
+	}
+
+	if (optind < argc) {
+		fprintf(stderr, "Too many input parameters\n");
+		errflg++;
+	}
+
+	if (errflg) {
+		print_usage();
+		return 1;
+	}
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Error connecting to TCP service (%s).\n",
+		    NAME, str_error(rc));
+		return 1;
+	}
+
+	rc = tcp_get_conn_list(tcp, &info, &count);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Error getting connection list (%s).\n",
+		    NAME, str_error(rc));
+		tcp_destroy(tcp);
+		return 1;
+	}
+
+	if (!listen) {
+		size_t n = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			if (info[i].state != tcp_is_listen)
+				info[n++] = info[i];
+		}
+
+		count = n;
+	}
+
+	rc = print_conns(info, count, stats);
+
+	free(info);
+	tcp_destroy(tcp);
+	return rc == EOK ? 0 : 1;
+}
+
+static void print_usage(void)
+{
+	printf("Syntax: %s [<options>]\n", NAME);
+	printf("Options:\n");
+	printf("  -h  Print help\n");
+	printf("  -s  Print per-connection statistics\n");
+	printf("  -L  Do not list listening connections\n");
+}
+
+/** @}
+ */
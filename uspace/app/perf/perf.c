@@ -0,0 +1,698 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup perf
+ * @{
+ */
+/**
+ * @file
+ * @brief Sampling profiler front end.
+ *
+ * Runs the kernel sampling profiler for a while, symbolizes the sampled
+ * call stacks and prints a flat profile followed by the callers and
+ * callees of the hottest functions. Kernel addresses are resolved by the
+ * kernel, user space addresses using the symbol table of the executable
+ * of the sampled task.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <arg_parse.h>
+#include <errno.h>
+#include <fibril.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <profile.h>
+#include <qsort.h>
+#include <stats.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <symtab.h>
+
+#define NAME  "perf"
+
+/** Interval between draining the kernel sample rings. */
+#define POLL_USEC  100000
+
+/** Number of samples drained by one read. */
+#define READ_BUF_SIZE  128
+
+/** Maximum number of callers and callees listed for a function. */
+#define GRAPH_EDGES  5
+
+#define KERNEL_NAME  "kernel"
+
+/** Profiled function, identified by its printable name. */
+typedef struct {
+	ht_link_t link;
+	char *name;
+	/** Samples with the function at the top of the stack. */
+	size_t self;
+	/** Samples with the function anywhere on the stack. */
+	size_t total;
+	/** Last sample counted in total. */
+	size_t last_sample;
+} perf_func_t;
+
+/** Number of samples in which caller called callee. */
+typedef struct {
+	ht_link_t link;
+	perf_func_t *caller;
+	perf_func_t *callee;
+	size_t count;
+} perf_edge_t;
+
+/** Resolved address, task_id is 0 for kernel addresses. */
+typedef struct {
+	ht_link_t link;
+	task_id_t task_id;
+	uintptr_t addr;
+	perf_func_t *func;
+} perf_addr_t;
+
+/** Sampled task. */
+typedef struct {
+	link_t link;
+	task_id_t task_id;
+	char *name;
+	/** Symbol table of the executable or NULL if not available. */
+	symtab_t *symtab;
+} perf_task_t;
+
+static hash_table_t funcs;
+static hash_table_t edges;
+static hash_table_t addrs;
+static list_t tasks;
+
+/** Number of processed samples. */
+static size_t nsamples;
+
+static profile_sample_t read_buf[READ_BUF_SIZE];
+
+static size_t func_key_hash(const void *key)
+{
+	size_t hash = 0;
+
+	for (const char *c = key; *c != '\0'; c++)
+		hash = hash_combine(hash, (uint8_t) *c);
+
+	return hash;
+}
+
+static size_t func_hash(const ht_link_t *item)
+{
+	perf_func_t *func = hash_table_get_inst(item, perf_func_t, link);
+	return func_key_hash(func->name);
+}
+
+static bool func_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	perf_func_t *func1 = hash_table_get_inst(item1, perf_func_t, link);
+	perf_func_t *func2 = hash_table_get_inst(item2, perf_func_t, link);
+	return str_cmp(func1->name, func2->name) == 0;
+}
+
+static bool func_key_equal(const void *key, const ht_link_t *item)
+{
+	perf_func_t *func = hash_table_get_inst(item, perf_func_t, link);
+	return str_cmp(key, func->name) == 0;
+}
+
+static hash_table_ops_t func_ops = {
+	.hash = func_hash,
+	.key_hash = func_key_hash,
+	.equal = func_equal,
+	.key_equal = func_key_equal,
+	.remove_callback = NULL
+};
+
+typedef struct {
+	perf_func_t *caller;
+	perf_func_t *callee;
+} edge_key_t;
+
+static size_t edge_key_hash(const void *key)
+{
+	const edge_key_t *ekey = key;
+	return hash_combine(hash_mix((uintptr_t) ekey->caller),
+	    hash_mix((uintptr_t) ekey->callee));
+}
+
+static size_t edge_hash(const ht_link_t *item)
+{
+	perf_edge_t *edge = hash_table_get_inst(item, perf_edge_t, link);
+	edge_key_t key = { edge->caller, edge->callee };
+	return edge_key_hash(&key);
+}
+
+static bool edge_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	perf_edge_t *edge1 = hash_table_get_inst(item1, perf_edge_t, link);
+	perf_edge_t *edge2 = hash_table_get_inst(item2, perf_edge_t, link);
+	return (edge1->caller == edge2->caller) &&
+	    (edge1->callee == edge2->callee);
+}
+
+static bool edge_key_equal(const void *key, const ht_link_t *item)
+{
+	const edge_key_t *ekey = key;
+	perf_edge_t *edge = hash_table_get_inst(item, perf_edge_t, link);
+	return (ekey->caller == edge->caller) && (ekey->callee == edge->callee);
+}
+
+static hash_table_ops_t edge_ops = {
+	.hash = edge_hash,
+	.key_hash = edge_key_hash,
+	.equal = edge_equal,
+	.key_equal = edge_key_equal,
+	.remove_callback = NULL
+};
+
+typedef struct {
+	task_id_t task_id;
+	uintptr_t addr;
+} addr_key_t;
+
+static size_t addr_key_hash(const void *key)
+{
+	const addr_key_t *akey = key;
+	return hash_combine(hash_mix(akey->task_id), hash_mix(akey->addr));
+}
+
+static size_t addr_hash(const ht_link_t *item)
+{
+	perf_addr_t *addr = hash_table_get_inst(item, perf_addr_t, link);
+	addr_key_t key = { addr->task_id, addr->addr };
+	return addr_key_hash(&key);
+}
+
+static bool addr_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	perf_addr_t *addr1 = hash_table_get_inst(item1, perf_addr_t, link);
+	perf_addr_t *addr2 = hash_table_get_inst(item2, perf_addr_t, link);
+	return (addr1->task_id == addr2->task_id) &&
+	    (addr1->addr == addr2->addr);
+}
+
+static bool addr_key_equal(const void *key, const ht_link_t *item)
+{
+	const addr_key_t *akey = key;
+	perf_addr_t *addr = hash_table_get_inst(item, perf_addr_t, link);
+	return (akey->task_id == addr->task_id) && (akey->addr == addr->addr);
+}
+
+static hash_table_ops_t addr_ops = {
+	.hash = addr_hash,
+	.key_hash = addr_key_hash,
+	.equal = addr_equal,
+	.key_equal = addr_key_equal,
+	.remove_callback = NULL
+};
+
+/** Find the sampled task, looking it up on first use.
+ *
+ * The name and the symbol table are obtained while the task is still
+ * likely to be running. If the task name is a path, the symbol table is
+ * loaded from it. Shared libraries are not symbolized.
+ */
+static perf_task_t *task_get(task_id_t task_id)
+{
+	list_foreach(tasks, link, perf_task_t, task) {
+		if (task->task_id == task_id)
+			return task;
+	}
+
+	perf_task_t *task = calloc(1, sizeof(perf_task_t));
+	if (task == NULL)
+		return NULL;
+
+	task->task_id = task_id;
+
+	stats_task_t *stats = stats_get_task(task_id);
+	if (stats != NULL) {
+		task->name = str_dup(stats->name);
+		free(stats);
+	} else {
+		asprintf(&task->name, "task%" PRIu64, task_id);
+	}
+
+	if (task->name == NULL) {
+		free(task);
+		return NULL;
+	}
+
+	if ((task->name[0] == '/') &&
+	    (symtab_load(task->name, &task->symtab) != EOK))
+		task->symtab = NULL;
+
+	list_append(&task->link, &tasks);
+	return task;
+}
+
+/** Find or create function of the given name, consuming @a name. */
+static perf_func_t *func_get(char *name)
+{
+	ht_link_t *link = hash_table_find(&funcs, name);
+	if (link != NULL) {
+		free(name);
+		return hash_table_get_inst(link, perf_func_t, link);
+	}
+
+	perf_func_t *func = calloc(1, sizeof(perf_func_t));
+	if (func == NULL) {
+		free(name);
+		return NULL;
+	}
+
+	func->name = name;
+	func->last_sample = SIZE_MAX;
+	hash_table_insert(&funcs, &func->link);
+	return func;
+}
+
+/** Symbolize an address of a sample. */
+static perf_func_t *addr_resolve(profile_sample_t *sample, unsigned int i)
+{
+	bool kernel = (i < sample->kernel_depth);
+	addr_key_t key = {
+		.task_id = kernel ? 0 : sample->task_id,
+		.addr = sample->pc[i]
+	};
+
+	ht_link_t *link = hash_table_find(&addrs, &key);
+	if (link != NULL)
+		return hash_table_get_inst(link, perf_addr_t, link)->func;
+
+	char *name = NULL;
+	if (kernel) {
+		char sym[64];
+		uintptr_t offset;
+
+		if (profile_symbol(key.addr, sym, sizeof(sym), &offset) == EOK)
+			asprintf(&name, "%s:%s", KERNEL_NAME, sym);
+		else
+			asprintf(&name, "%s:%p", KERNEL_NAME, (void *) key.addr);
+	} else {
+		perf_task_t *task = task_get(sample->task_id);
+		if (task == NULL)
+			return NULL;
+
+		char *sym;
+		size_t offset;
+		if ((task->symtab != NULL) && (symtab_addr_to_name(task->symtab,
+		    key.addr, &sym, &offset) == EOK))
+			asprintf(&name, "%s:%s", task->name, sym);
+		else
+			asprintf(&name, "%s:%p", task->name, (void *) key.addr);
+	}
+
+	if (name == NULL)
+		return NULL;
+
+	perf_func_t *func = func_get(name);
+	if (func == NULL)
+		return NULL;
+
+	perf_addr_t *addr = malloc(sizeof(perf_addr_t));
+	if (addr == NULL)
+		return NULL;
+
+	addr->task_id = key.task_id;
+	addr->addr = key.addr;
+	addr->func = func;
+	hash_table_insert(&addrs, &addr->link);
+	return func;
+}
+
+static errno_t edge_add(perf_func_t *caller, perf_func_t *callee)
+{
+	edge_key_t key = { caller, callee };
+
+	ht_link_t *link = hash_table_find(&edges, &key);
+	if (link != NULL) {
+		hash_table_get_inst(link, perf_edge_t, link)->count++;
+		return EOK;
+	}
+
+	perf_edge_t *edge = malloc(sizeof(perf_edge_t));
+	if (edge == NULL)
+		return ENOMEM;
+
+	edge->caller = caller;
+	edge->callee = callee;
+	edge->count = 1;
+	hash_table_insert(&edges, &edge->link);
+	return EOK;
+}
+
+/** Account one sample to the functions and edges on its call stack. */
+static errno_t sample_process(profile_sample_t *sample)
+{
+	perf_func_t *callee = NULL;
+
+	for (unsigned int i = 0; i < sample->depth; i++) {
+		perf_func_t *func = addr_resolve(sample, i);
+		if (func == NULL)
+			return ENOMEM;
+
+		if (i == 0)
+			func->self++;
+
+		/* Count recursive functions once per sample */
+		if (func->last_sample != nsamples) {
+			func->last_sample = nsamples;
+			func->total++;
+		}
+
+		if ((callee != NULL) && (edge_add(func, callee) != EOK))
+			return ENOMEM;
+
+		callee = func;
+	}
+
+	nsamples++;
+	return EOK;
+}
+
+/** Drain the kernel sample rings. */
+static errno_t samples_drain(task_id_t task_id)
+{
+	size_t nread;
+
+	do {
+		errno_t rc = profile_read(read_buf, READ_BUF_SIZE, &nread);
+		if (rc != EOK)
+			return rc;
+
+		for (size_t i = 0; i < nread; i++) {
+			if ((task_id != 0) && (read_buf[i].task_id != task_id))
+				continue;
+
+			rc = sample_process(&read_buf[i]);
+			if (rc != EOK)
+				return rc;
+		}
+	} while (nread == READ_BUF_SIZE);
+
+	return EOK;
+}
+
+typedef struct {
+	void **items;
+	size_t count;
+} collect_t;
+
+static bool collect(ht_link_t *link, void *arg)
+{
+	collect_t *col = arg;
+	col->items[col->count++] = link;
+	return true;
+}
+
+/** Collect all items of a hash table into a newly allocated array. */
+static ht_link_t **table_collect(hash_table_t *table, size_t *count)
+{
+	collect_t col;
+
+	col.items = calloc(max(hash_table_size(table), 1), sizeof(void *));
+	if (col.items == NULL)
+		return NULL;
+
+	col.count = 0;
+	hash_table_apply(table, collect, &col);
+	*count = col.count;
+	return (ht_link_t **) col.items;
+}
+
+static int func_cmp_self(const void *a, const void *b)
+{
+	perf_func_t *fa = hash_table_get_inst(*(ht_link_t **) a, perf_func_t,
+	    link);
+	perf_func_t *fb = hash_table_get_inst(*(ht_link_t **) b, perf_func_t,
+	    link);
+
+	if (fa->self != fb->self)
+		return (fa->self < fb->self) ? 1 : -1;
+
+	if (fa->total != fb->total)
+		return (fa->total < fb->total) ? 1 : -1;
+
+	return str_cmp(fa->name, fb->name);
+}
+
+static int edge_cmp_count(const void *a, const void *b)
+{
+	perf_edge_t *ea = hash_table_get_inst(*(ht_link_t **) a, perf_edge_t,
+	    link);
+	perf_edge_t *eb = hash_table_get_inst(*(ht_link_t **) b, perf_edge_t,
+	    link);
+
+	if (ea->count != eb->count)
+		return (ea->count < eb->count) ? 1 : -1;
+
+	return 0;
+}
+
+/** Print share of samples as a percentage with one decimal. */
+static void print_share(size_t count)
+{
+	uint64_t permille = (uint64_t) count * 1000 / max(nsamples, 1);
+	printf("%3" PRIu64 ".%" PRIu64 "%%", permille / 10, permille % 10);
+}
+
+/** Print callers (@a callers true) or callees of a function. */
+static void print_edges(ht_link_t **edge_items, size_t nedges,
+    perf_func_t *func, bool callers)
+{
+	size_t listed = 0;
+
+	for (size_t i = 0; (i < nedges) && (listed < GRAPH_EDGES); i++) {
+		perf_edge_t *edge = hash_table_get_inst(edge_items[i],
+		    perf_edge_t, link);
+
+		if ((callers ? edge->callee : edge->caller) != func)
+			continue;
+
+		printf("    %s %8zu  %s\n", callers ? "<-" : "->", edge->count,
+		    callers ? edge->caller->name : edge->callee->name);
+		listed++;
+	}
+}
+
+static void report(size_t nfuncs_max)
+{
+	size_t nfuncs;
+	size_t nedges;
+
+	ht_link_t **func_items = table_collect(&funcs, &nfuncs);
+	ht_link_t **edge_items = table_collect(&edges, &nedges);
+	if ((func_items == NULL) || (edge_items == NULL)) {
+		fprintf(stderr, "%s: Out of memory\n", NAME);
+		free(func_items);
+		free(edge_items);
+		return;
+	}
+
+	qsort(func_items, nfuncs, sizeof(ht_link_t *), func_cmp_self);
+	qsort(edge_items, nedges, sizeof(ht_link_t *), edge_cmp_count);
+
+	nfuncs = min(nfuncs, nfuncs_max);
+
+	printf("%zu samples\n\n", nsamples);
+	printf("  [self] [total] [samples] [function]\n");
+
+	for (size_t i = 0; i < nfuncs; i++) {
+		perf_func_t *func = hash_table_get_inst(func_items[i],
+		    perf_func_t, link);
+
+		printf(" ");
+		print_share(func->self);
+		printf("  ");
+		print_share(func->total);
+		printf(" %9zu  %s\n", func->self, func->name);
+	}
+
+	printf("\nCall graph:\n");
+
+	for (size_t i = 0; i < nfuncs; i++) {
+		perf_func_t *func = hash_table_get_inst(func_items[i],
+		    perf_func_t, link);
+
+		printf("\n  %s (self %zu, total %zu)\n", func->name, func->self,
+		    func->total);
+		print_edges(edge_items, nedges, func, true);
+		print_edges(edge_items, nedges, func, false);
+	}
+
+	free(func_items);
+	free(edge_items);
+}
+
+static void usage(const char *name)
+{
+	printf(
+	    "Usage: %s [-d seconds] [-p ticks] [-t task_id] [-n count]\n"
+	    "\n"
+	    "Options:\n"
+	    "\t-d seconds | --duration=seconds\n"
+	    "\t\tProfile for the given number of seconds (default 5)\n"
+	    "\n"
+	    "\t-p ticks | --period=ticks\n"
+	    "\t\tSample every given number of clock ticks of each CPU\n"
+	    "\t\t(default 1)\n"
+	    "\n"
+	    "\t-t task_id | --task=task_id\n"
+	    "\t\tOnly account samples of the given task\n"
+	    "\n"
+	    "\t-n count | --count=count\n"
+	    "\t\tList the given number of hottest functions (default 20)\n"
+	    "\n"
+	    "\t-h | --help\n"
+	    "\t\tPrint this usage information\n",
+	    name);
+}
+
+int main(int argc, char *argv[])
+{
+	int duration = 5;
+	int period = 1;
+	int count = 20;
+	task_id_t task_id = 0;
+	errno_t rc;
+
+	for (int i = 1; i < argc; i++) {
+		int off;
+		int tmp;
+
+		/* Usage */
+		if ((off = arg_parse_short_long(argv[i], "-h", "--help")) != -1) {
+			usage(argv[0]);
+			return 0;
+		}
+
+		/* Duration */
+		if ((off = arg_parse_short_long(argv[i], "-d", "--duration=")) != -1) {
+			rc = arg_parse_int(argc, argv, &i, &duration, off);
+			if ((rc != EOK) || (duration <= 0)) {
+				printf("%s: Malformed duration '%s'\n", NAME, argv[i]);
+				return -1;
+			}
+
+			continue;
+		}
+
+		/* Period */
+		if ((off = arg_parse_short_long(argv[i], "-p", "--period=")) != -1) {
+			rc = arg_parse_int(argc, argv, &i, &period, off);
+			if ((rc != EOK) || (period <= 0)) {
+				printf("%s: Malformed period '%s'\n", NAME, argv[i]);
+				return -1;
+			}
+
+			continue;
+		}
+
+		/* Task */
+		if ((off = arg_parse_short_long(argv[i], "-t", "--task=")) != -1) {
+			// TODO: Support for 64b range
+			rc = arg_parse_int(argc, argv, &i, &tmp, off);
+			if ((rc != EOK) || (tmp <= 0)) {
+				printf("%s: Malformed task id '%s'\n", NAME, argv[i]);
+				return -1;
+			}
+
+			task_id = tmp;
+			continue;
+		}
+
+		/* Count */
+		if ((off = arg_parse_short_long(argv[i], "-n", "--count=")) != -1) {
+			rc = arg_parse_int(argc, argv, &i, &count, off);
+			if ((rc != EOK) || (count <= 0)) {
+				printf("%s: Malformed count '%s'\n", NAME, argv[i]);
+				return -1;
+			}
+
+			continue;
+		}
+
+		usage(argv[0]);
+		return -1;
+	}
+
+	list_initialize(&tasks);
+	if (!hash_table_create(&funcs, 0, 0, &func_ops) ||
+	    !hash_table_create(&edges, 0, 0, &edge_ops) ||
+	    !hash_table_create(&addrs, 0, 0, &addr_ops)) {
+		fprintf(stderr, "%s: Out of memory\n", NAME);
+		return -1;
+	}
+
+	/* Discard samples left over from an earlier run */
+	size_t nread;
+	do {
+		rc = profile_read(read_buf, READ_BUF_SIZE, &nread);
+	} while ((rc == EOK) && (nread == READ_BUF_SIZE));
+
+	rc = profile_start(period);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Unable to start profiler: %s\n", NAME,
+		    str_error(rc));
+		return -1;
+	}
+
+	printf("%s: Profiling for %d seconds...\n", NAME, duration);
+
+	for (int64_t polls = (int64_t) duration * 1000000 / POLL_USEC;
+	    polls > 0; polls--) {
+		fibril_usleep(POLL_USEC);
+
+		rc = samples_drain(task_id);
+		if (rc != EOK)
+			break;
+	}
+
+	profile_stop();
+	if (rc == EOK)
+		rc = samples_drain(task_id);
+
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Unable to read samples: %s\n", NAME,
+		    str_error(rc));
+		return -1;
+	}
+
+	report(count);
+	return 0;
+}
+
+/** @}
+ */
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file Arena allocator.
+ *
+ * Stack-like allocator for short-lived run-time data. The VM allocates
+ * the registers and slots of each procedure activation here and releases
+ * them all at once when the procedure returns, instead of going through
+ * malloc() for every temporary.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mytypes.h"
+
+#include "arena.h"
+
+/** Default size of chunk data area */
+#define ARENA_CHUNK_SIZE 16384
+
+/** Alignment of allocated blocks */
+#define ARENA_ALIGN 16
+
+/** Round @a size up to a multiple of ARENA_ALIGN */
+#define ARENA_ROUND(size) \
+	(((size) + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1))
+
+/** Size of chunk header, rounded so that the data area is aligned */
+#define ARENA_HDR_SIZE ARENA_ROUND(sizeof(arena_chunk_t))
+
+static arena_chunk_t *arena_chunk_get(arena_t *arena, size_t size);
+
+/** Initialize arena.
+ *
+ * @param arena		Arena
+ */
+void arena_init(arena_t *arena)
+{
+	arena->chunk = NULL;
+	arena->free = NULL;
+}
+
+/** Finalize arena.
+ *
+ * Frees all memory owned by the arena.
+ *
+ * @param arena		Arena
+ */
+void arena_fini(arena_t *arena)
+{
+	arena_chunk_t *chunk;
+
+	while (arena->chunk != NULL) {
+		chunk = arena->chunk;
+		arena->chunk = chunk->prev;
+		free(chunk);
+	}
+
+	while (arena->free != NULL) {
+		chunk = arena->free;
+		arena->free = chunk->prev;
+		free(chunk);
+	}
+}
+
+/** Allocate block from arena.
+ *
+ * @param arena		Arena
+ * @param size		Size of block in bytes
+ * @return		Pointer to block
+ */
+void *arena_alloc(arena_t *arena, size_t size)
+{
+	arena_chunk_t *chunk;
+	void *p;
+
+	size = ARENA_ROUND(size);
+
+	chunk = arena->chunk;
+	if (chunk == NULL || chunk->size - chunk->used < size) {
+		chunk = arena_chunk_get(arena, size);
+		chunk->prev = arena->chunk;
+		arena->chunk = chunk;
+	}
+
+	p = (char *) chunk + ARENA_HDR_SIZE + chunk->used;
+	chunk->used += size;
+
+	return p;
+}
+
+/** Get arena mark.
+ *
+ * @param arena		Arena
+ * @param mark		Place to store mark
+ */
+void arena_mark(arena_t *arena, arena_mark_t *mark)
+{
+	mark->chunk = arena->chunk;
+	mark->used = arena->chunk != NULL ? arena->chunk->used : 0;
+}
+
+/** Release everything allocated since a mark was taken.
+ *
+ * @param arena		Arena
+ * @param mark		Mark previously obtained with arena_mark()
+ */
+void arena_release(arena_t *arena, arena_mark_t *mark)
+{
+	arena_chunk_t *chunk;
+
+	/* Move chunks allocated after the mark to the free list. */
+	while (arena->chunk != mark->chunk) {
+		chunk = arena->chunk;
+		arena->chunk = chunk->prev;
+
+		chunk->used = 0;
+		chunk->prev = arena->free;
+		arena->free = chunk;
+	}
+
+	if (arena->chunk != NULL)
+		arena->chunk->used = mark->used;
+}
+
+/** Get empty chunk with data area of at least @a size bytes.
+ *
+ * Reuses a released chunk if there is one big enough.
+ *
+ * @param arena		Arena
+ * @param size		Minimum data area size
+ * @return		Chunk
+ */
+static arena_chunk_t *arena_chunk_get(arena_t *arena, size_t size)
+{
+	arena_chunk_t **cp;
+	arena_chunk_t *chunk;
+
+	cp = &arena->free;
+	while (*cp != NULL) {
+		if ((*cp)->size >= size) {
+			chunk = *cp;
+			*cp = chunk->prev;
+			return chunk;
+		}
+
+		cp = &(*cp)->prev;
+	}
+
+	if (size < ARENA_CHUNK_SIZE)
+		size = ARENA_CHUNK_SIZE;
+
+	chunk = malloc(ARENA_HDR_SIZE + size);
+	if (chunk == NULL) {
+		printf("Memory allocation failed.\n");
+		exit(1);
+	}
+
+	chunk->size = size;
+	chunk->used = 0;
+	return chunk;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARENA_T_H_
+#define ARENA_T_H_
+
+#include <stddef.h>
+
+/** Arena chunk
+ *
+ * The chunk header is immediately followed by @c size bytes of data.
+ */
+typedef struct arena_chunk {
+	/** Previous (older) chunk in the arena or next chunk in free list */
+	struct arena_chunk *prev;
+
+	/** Size of the data area in bytes */
+	size_t size;
+
+	/** Number of bytes of the data area in use */
+	size_t used;
+} arena_chunk_t;
+
+/** Arena allocator
+ *
+ * Memory is allocated by bumping a pointer in the current chunk and
+ * released in LIFO order by returning to a previously taken mark. Released
+ * chunks are kept for reuse. A zero-filled arena is a valid empty arena.
+ */
+typedef struct arena {
+	/** Current chunk or @c NULL if nothing has been allocated yet */
+	arena_chunk_t *chunk;
+
+	/** Released chunks kept for reuse */
+	arena_chunk_t *free;
+} arena_t;
+
+/** Arena mark
+ *
+ * Records the allocation state of an arena so that everything allocated
+ * after it can be released at once.
+ */
+typedef struct {
+	arena_chunk_t *chunk;
+	size_t used;
+} arena_mark_t;
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file Bytecode representation of compiled procedures. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bigint.h"
+#include "mytypes.h"
+#include "strtab.h"
+#include "symbol.h"
+
+#include "bcode.h"
+
+/** Create new, empty compiled procedure.
+ *
+ * @param proc		Procedure being compiled
+ * @return		New compiled procedure
+ */
+bcode_t *bcode_new(stree_proc_t *proc)
+{
+	bcode_t *bc;
+
+	bc = calloc(1, sizeof(bcode_t));
+	if (bc == NULL) {
+		printf("Memory allocation failed.\n");
+		exit(1);
+	}
+
+	bc->proc = proc;
+	return bc;
+}
+
+/** Append instruction.
+ *
+ * @param bc		Compiled procedure
+ * @param opc		Operation code
+ * @param a		First operand
+ * @param b		Second operand
+ * @param c		Third operand
+ * @return		Index of the new instruction
+ */
+int bcode_emit(bcode_t *bc, bcode_opc_t opc, int a, int b, int c)
+{
+	bcode_instr_t *instr;
+	int nalloc;
+
+	if (bc->ninstr >= bc->alloc_instr) {
+		nalloc = bc->alloc_instr != 0 ? 2 * bc->alloc_instr : 16;
+		instr = realloc(bc->instr, nalloc * sizeof(bcode_instr_t));
+		if (instr == NULL) {
+			printf("Memory allocation failed.\n");
+			exit(1);
+		}
+
+		bc->instr = instr;
+		bc->alloc_instr = nalloc;
+	}
+
+	instr = &bc->instr[bc->ninstr];
+	instr->opc = opc;
+	instr->op = 0;
+	instr->a = a;
+	instr->b = b;
+	instr->c = c;
+	instr->p = NULL;
+
+	return bc->ninstr++;
+}
+
+/** Get field slot for a member variable.
+ *
+ * @param bc		Compiled procedure
+ * @param name		Name of the member variable
+ * @param sym		Symbol of the member variable
+ * @return		Field slot number
+ */
+int bcode_field_add(bcode_t *bc, stree_ident_t *name, stree_symbol_t *sym)
+{
+	bcode_field_t *field;
+	int nalloc;
+	int i;
+
+	for (i = 0; i < bc->nfields; i++) {
+		if (bc->field[i].sym == sym)
+			return i;
+	}
+
+	if (bc->nfields >= bc->alloc_fields) {
+		nalloc = bc->alloc_fields != 0 ? 2 * bc->alloc_fields : 4;
+		field = realloc(bc->field, nalloc * sizeof(bcode_field_t));
+		if (field == NULL) {
+			printf("Memory allocation failed.\n");
+			exit(1);
+		}
+
+		bc->field = field;
+		bc->alloc_fields = nalloc;
+	}
+
+	bc->field[bc->nfields].name = name;
+	bc->field[bc->nfields].sym = sym;
+
+	return bc->nfields++;
+}
+
+/** Print compiled procedure in human-readable form.
+ *
+ * @param bc		Compiled procedure
+ */
+void bcode_print(bcode_t *bc)
+{
+	bcode_instr_t *instr;
+	int i;
+
+	printf("Bytecode for '");
+	symbol_print_fqn(bc->proc->outer_symbol);
+	printf("': %d registers, %d slots, %d fields\n", bc->nregs,
+	    bc->nslots, bc->nfields);
+
+	for (i = 0; i < bc->nfields; i++) {
+		printf("  field %d: %s\n", i,
+		    strtab_get_str(bc->field[i].name->sid));
+	}
+
+	for (i = 0; i < bc->ninstr; i++) {
+		instr = &bc->instr[i];
+		printf("%4d  ", i);
+
+		switch (instr->opc) {
+		case bc_ldbool:
+			printf("ldbool r%d, %s", instr->a,
+			    instr->b ? "true" : "false");
+			break;
+		case bc_ldint:
+			printf("ldint r%d, ", instr->a);
+			bigint_print((bigint_t *) instr->p);
+			break;
+		case bc_ldloc:
+			printf("ldloc r%d, s%d", instr->a, instr->b);
+			break;
+		case bc_stloc:
+			printf("stloc s%d, r%d", instr->a, instr->b);
+			break;
+		case bc_ldfld:
+			printf("ldfld r%d, f%d", instr->a, instr->b);
+			break;
+		case bc_stfld:
+			printf("stfld f%d, r%d", instr->a, instr->b);
+			break;
+		case bc_binop:
+			printf("binop.%d r%d, r%d, r%d", instr->op, instr->a,
+			    instr->b, instr->c);
+			break;
+		case bc_unop:
+			printf("unop.%d r%d, r%d", instr->op, instr->a,
+			    instr->b);
+			break;
+		case bc_jmp:
+			printf("jmp %d", instr->a);
+			break;
+		case bc_jf:
+			printf("jf r%d, %d", instr->a, instr->b);
+			break;
+		case bc_eval:
+			printf("eval r%d", instr->a);
+			break;
+		case bc_exec:
+			printf("exec brk %d, depth %d", instr->b, instr->c);
+			break;
+		case bc_vdecl:
+			printf("vdecl s%d", instr->a);
+			break;
+		case bc_benter:
+			printf("benter");
+			break;
+		case bc_bleave:
+			printf("bleave");
+			break;
+		case bc_ret:
+			printf("ret r%d", instr->a);
+			break;
+		}
+
+		printf("\n");
+	}
+}
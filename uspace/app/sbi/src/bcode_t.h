@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BCODE_T_H_
+#define BCODE_T_H_
+
+#include "stree_t.h"
+
+/** Bytecode operation code
+ *
+ * Operands @c a, @c b, @c c of the instruction are register numbers, slot
+ * numbers or instruction indices as described for each operation.
+ */
+typedef enum {
+	/** Load boolean constant @c b to register @c a */
+	bc_ldbool,
+	/** Load integer constant @c p (bigint_t *) to register @c a */
+	bc_ldint,
+	/** Load local variable in slot @c b to register @c a */
+	bc_ldloc,
+	/** Store register @c b to local variable in slot @c a */
+	bc_stloc,
+	/** Load member variable in field slot @c b to register @c a */
+	bc_ldfld,
+	/** Store register @c b to member variable in field slot @c a */
+	bc_stfld,
+	/** Register @c a = register @c b (binop_class_t @c op) register @c c */
+	bc_binop,
+	/** Register @c a = (unop_class_t @c op) register @c b */
+	bc_unop,
+	/** Jump to instruction @c a */
+	bc_jmp,
+	/** Jump to instruction @c b if register @c a is false */
+	bc_jf,
+	/** Evaluate expression @c p with the tree walker to register @c a */
+	bc_eval,
+	/**
+	 * Execute statement @c p with the tree walker. On break bailout
+	 * leave blocks down to depth @c c and jump to instruction @c b.
+	 */
+	bc_exec,
+	/** Declare local variable (stree_vdecl_t * @c p) in slot @c a */
+	bc_vdecl,
+	/** Enter block */
+	bc_benter,
+	/** Leave block */
+	bc_bleave,
+	/** Return value in register @c a (or nothing if @c a is negative) */
+	bc_ret
+} bcode_opc_t;
+
+/** Bytecode instruction */
+typedef struct {
+	bcode_opc_t opc;
+
+	/** Operation class for bc_binop and bc_unop */
+	int op;
+
+	/** Operands */
+	int a, b, c;
+
+	/** Tree node or constant */
+	void *p;
+} bcode_instr_t;
+
+/** Member variable referenced from compiled procedure */
+typedef struct {
+	/** Name of the variable */
+	stree_ident_t *name;
+
+	/** Symbol the name resolved to at compile time */
+	stree_symbol_t *sym;
+} bcode_field_t;
+
+/** Compiled procedure
+ *
+ * Local variables, including arguments, live in numbered slots. Arguments
+ * occupy the first @c nargs slots. Member variables of the active object
+ * are resolved to field slots when the procedure is activated.
+ */
+typedef struct bcode {
+	/** Procedure that was compiled */
+	stree_proc_t *proc;
+
+	/** CSI from which names were resolved */
+	stree_csi_t *csi;
+
+	/** Instructions */
+	bcode_instr_t *instr;
+	int ninstr;
+	int alloc_instr;
+
+	/** Number of registers */
+	int nregs;
+
+	/** Number of local variable slots */
+	int nslots;
+
+	/** Argument names (SIDs), one for each of the first @c nargs slots */
+	int *arg_sid;
+	int nargs;
+
+	/** Referenced member variables, one for each field slot */
+	bcode_field_t *field;
+	int nfields;
+	int alloc_fields;
+
+	/** Last CSI other than @c csi for which name resolution was verified */
+	stree_csi_t *vcsi;
+} bcode_t;
+
+#endif
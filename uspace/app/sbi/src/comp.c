@@ -0,0 +1,812 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file Bytecode compiler.
+ *
+ * Compiles the body of a type-checked procedure to register bytecode
+ * executed by the VM. Local variables and arguments are resolved to slots
+ * and member variables of the active object to field slots at compile
+ * time. Operations on @c int and @c bool values and the control flow
+ * around them are compiled to native instructions. Anything else is
+ * compiled to an instruction that evaluates the subtree with the
+ * tree-walking interpreter, so any program that the tree walker can run
+ * can be compiled.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "bcode.h"
+#include "debug.h"
+#include "intmap.h"
+#include "list.h"
+#include "mytypes.h"
+#include "stree.h"
+#include "symbol.h"
+
+#include "comp.h"
+
+/** Break target placeholder, patched when the loop is finished */
+#define COMP_BRK_PENDING (-2)
+
+static void comp_args(comp_t *comp, stree_proc_t *proc);
+static void comp_arg(comp_t *comp, stree_proc_arg_t *arg);
+static void comp_scope_push(comp_t *comp);
+static void comp_scope_pop(comp_t *comp);
+static int comp_local_lookup(comp_t *comp, int sid);
+static int comp_field_lookup(comp_t *comp, stree_ident_t *name);
+static int comp_reg_alloc(comp_t *comp);
+
+static void comp_block(comp_t *comp, stree_block_t *block);
+static void comp_stat(comp_t *comp, stree_stat_t *stat);
+static void comp_vdecl(comp_t *comp, stree_vdecl_t *vdecl);
+static void comp_exps(comp_t *comp, stree_stat_t *stat);
+static void comp_if(comp_t *comp, stree_if_t *if_s);
+static void comp_while(comp_t *comp, stree_while_t *while_s);
+static void comp_break(comp_t *comp, stree_stat_t *stat);
+static void comp_return(comp_t *comp, stree_return_t *return_s);
+static void comp_exec(comp_t *comp, stree_stat_t *stat);
+
+static int comp_expr(comp_t *comp, stree_expr_t *expr);
+static int comp_literal(comp_t *comp, stree_expr_t *expr);
+static int comp_nameref(comp_t *comp, stree_expr_t *expr);
+static int comp_binop(comp_t *comp, stree_expr_t *expr);
+static int comp_unop(comp_t *comp, stree_expr_t *expr);
+static int comp_eval(comp_t *comp, stree_expr_t *expr);
+static bool_t comp_expr_tpc(stree_expr_t *expr, tprimitive_class_t *tpc);
+
+/** Compile procedure.
+ *
+ * @param prog		Program containing the procedure
+ * @param proc		Procedure with a body
+ * @return		Compiled procedure or @c NULL if the procedure
+ *			cannot be compiled
+ */
+bcode_t *comp_proc(stree_program_t *prog, stree_proc_t *proc)
+{
+	comp_t comp;
+	bcode_t *bc;
+
+	assert(proc->body != NULL);
+
+	/* Procedures outside of any CSI only exist in interactive mode. */
+	if (proc->outer_symbol->outer_csi == NULL)
+		return NULL;
+
+	bc = bcode_new(proc);
+	bc->csi = proc->outer_symbol->outer_csi;
+
+	comp.program = prog;
+	comp.csi = bc->csi;
+	comp.bc = bc;
+	comp.scope = NULL;
+	comp.loop = NULL;
+	comp.depth = 0;
+	comp.slot = 0;
+	comp.reg = 0;
+
+	/* Scope of the arguments */
+	comp_scope_push(&comp);
+	comp_args(&comp, proc);
+
+	comp_block(&comp, proc->body);
+	(void) bcode_emit(bc, bc_ret, -1, 0, 0);
+
+	comp_scope_pop(&comp);
+
+	assert(comp.depth == 0);
+	assert(comp.loop == NULL);
+
+#ifdef DEBUG_VM_TRACE
+	bcode_print(bc);
+#endif
+	return bc;
+}
+
+/** Assign slots to procedure arguments.
+ *
+ * The arguments are stored in the first block activation record by
+ * run_proc_ar_set_args() and run_proc_ar_set_setter_arg().
+ *
+ * @param comp		Compiler
+ * @param proc		Procedure
+ */
+static void comp_args(comp_t *comp, stree_proc_t *proc)
+{
+	stree_symbol_t *outer_symbol;
+	stree_fun_sig_t *sig;
+	stree_prop_t *prop;
+	list_t *args;
+	stree_proc_arg_t *varg;
+	list_node_t *node;
+	int nargs;
+
+	outer_symbol = proc->outer_symbol;
+	prop = NULL;
+
+	switch (outer_symbol->sc) {
+	case sc_ctor:
+		sig = symbol_to_ctor(outer_symbol)->sig;
+		args = &sig->args;
+		varg = sig->varg;
+		break;
+	case sc_fun:
+		sig = symbol_to_fun(outer_symbol)->sig;
+		args = &sig->args;
+		varg = sig->varg;
+		break;
+	case sc_prop:
+		prop = symbol_to_prop(outer_symbol);
+		args = &prop->args;
+		varg = prop->varg;
+		break;
+	default:
+		assert(b_false);
+		return;
+	}
+
+	nargs = 0;
+	node = list_first(args);
+	while (node != NULL) {
+		nargs += 1;
+		node = list_next(args, node);
+	}
+
+	if (varg != NULL)
+		nargs += 1;
+	if (prop != NULL && proc == prop->setter)
+		nargs += 1;
+
+	if (nargs > 0) {
+		comp->bc->arg_sid = calloc(nargs, sizeof(int));
+		if (comp->bc->arg_sid == NULL) {
+			printf("Memory allocation failed.\n");
+			exit(1);
+		}
+	}
+
+	node = list_first(args);
+	while (node != NULL) {
+		comp_arg(comp, list_node_data(node, stree_proc_arg_t *));
+		node = list_next(args, node);
+	}
+
+	if (varg != NULL)
+		comp_arg(comp, varg);
+
+	if (prop != NULL && proc == prop->setter)
+		comp_arg(comp, prop->setter_arg);
+
+	assert(comp->bc->nargs == nargs);
+}
+
+/** Assign slot to one procedure argument.
+ *
+ * @param comp		Compiler
+ * @param arg		Argument
+ */
+static void comp_arg(comp_t *comp, stree_proc_arg_t *arg)
+{
+	int slot;
+
+	slot = comp->slot++;
+	if (comp->slot > comp->bc->nslots)
+		comp->bc->nslots = comp->slot;
+
+	assert(slot == comp->bc->nargs);
+	comp->bc->arg_sid[comp->bc->nargs++] = arg->name->sid;
+	intmap_set(&comp->scope->vars, arg->name->sid,
+	    (void *) (intptr_t) (slot + 1));
+}
+
+/** Open new scope.
+ *
+ * @param comp		Compiler
+ */
+static void comp_scope_push(comp_t *comp)
+{
+	comp_scope_t *scope;
+
+	scope = calloc(1, sizeof(comp_scope_t));
+	if (scope == NULL) {
+		printf("Memory allocation failed.\n");
+		exit(1);
+	}
+
+	intmap_init(&scope->vars);
+	scope->slot_base = comp->slot;
+	scope->outer = comp->scope;
+	comp->scope = scope;
+}
+
+/** Close innermost scope.
+ *
+ * The slots of variables declared in the scope can be reused afterwards.
+ *
+ * @param comp		Compiler
+ */
+static void comp_scope_pop(comp_t *comp)
+{
+	comp_scope_t *scope;
+	map_elem_t *elem;
+
+	scope = comp->scope;
+	comp->scope = scope->outer;
+	comp->slot = scope->slot_base;
+
+	elem = intmap_first(&scope->vars);
+	while (elem != NULL) {
+		intmap_set(&scope->vars, intmap_elem_get_key(elem), NULL);
+		elem = intmap_first(&scope->vars);
+	}
+
+	intmap_fini(&scope->vars);
+	free(scope);
+}
+
+/** Find slot of local variable.
+ *
+ * @param comp		Compiler
+ * @param sid		Name of the variable
+ * @return		Slot number or -1 if there is no such local variable
+ */
+static int comp_local_lookup(comp_t *comp, int sid)
+{
+	comp_scope_t *scope;
+	void *data;
+
+	scope = comp->scope;
+	while (scope != NULL) {
+		data = intmap_get(&scope->vars, sid);
+		if (data != NULL)
+			return (int) (intptr_t) data - 1;
+
+		scope = scope->outer;
+	}
+
+	return -1;
+}
+
+/** Find field slot of member variable.
+ *
+ * Only non-static member variables of the active object are resolved.
+ * Other symbols are left to the tree walker.
+ *
+ * @param comp		Compiler
+ * @param name		Name
+ * @return		Field slot number or -1 if @a name does not refer
+ *			to a member variable of the active object
+ */
+static int comp_field_lookup(comp_t *comp, stree_ident_t *name)
+{
+	stree_symbol_t *sym;
+
+	sym = symbol_lookup_in_csi(comp->program, comp->csi, name);
+	if (sym == NULL || sym->sc != sc_var || stree_symbol_is_static(sym))
+		return -1;
+
+	if (symbol_search_csi(comp->program, comp->csi, name) == NULL)
+		return -1;
+
+	return bcode_field_add(comp->bc, name, sym);
+}
+
+/** Allocate register.
+ *
+ * Registers are allocated in stack order. Temporaries are released by
+ * resetting @c comp->reg to a previous value.
+ *
+ * @param comp		Compiler
+ * @return		Register number
+ */
+static int comp_reg_alloc(comp_t *comp)
+{
+	int reg;
+
+	reg = comp->reg++;
+	if (comp->reg > comp->bc->nregs)
+		comp->bc->nregs = comp->reg;
+
+	return reg;
+}
+
+/** Compile block.
+ *
+ * @param comp		Compiler
+ * @param block		Block
+ */
+static void comp_block(comp_t *comp, stree_block_t *block)
+{
+	list_node_t *node;
+
+	(void) bcode_emit(comp->bc, bc_benter, 0, 0, 0);
+	comp->depth += 1;
+	comp_scope_push(comp);
+
+	node = list_first(&block->stats);
+	while (node != NULL) {
+		comp_stat(comp, list_node_data(node, stree_stat_t *));
+		node = list_next(&block->stats, node);
+	}
+
+	comp_scope_pop(comp);
+	comp->depth -= 1;
+	(void) bcode_emit(comp->bc, bc_bleave, 0, 0, 0);
+}
+
+/** Compile statement.
+ *
+ * @param comp		Compiler
+ * @param stat		Statement
+ */
+static void comp_stat(comp_t *comp, stree_stat_t *stat)
+{
+	/* Statements do not keep any registers. */
+	assert(comp->reg == 0);
+
+	switch (stat->sc) {
+	case st_vdecl:
+		comp_vdecl(comp, stat->u.vdecl_s);
+		break;
+	case st_exps:
+		comp_exps(comp, stat);
+		break;
+	case st_if:
+		comp_if(comp, stat->u.if_s);
+		break;
+	case st_while:
+		comp_while(comp, stat->u.while_s);
+		break;
+	case st_break:
+		comp_break(comp, stat);
+		break;
+	case st_return:
+		comp_return(comp, stat->u.return_s);
+		break;
+	case st_switch:
+	case st_for:
+	case st_raise:
+	case st_wef:
+		comp_exec(comp, stat);
+		break;
+	}
+
+	comp->reg = 0;
+}
+
+/** Compile variable declaration.
+ *
+ * @param comp		Compiler
+ * @param vdecl		Variable declaration
+ */
+static void comp_vdecl(comp_t *comp, stree_vdecl_t *vdecl)
+{
+	int slot;
+	int idx;
+
+	slot = comp->slot++;
+	if (comp->slot > comp->bc->nslots)
+		comp->bc->nslots = comp->slot;
+
+	idx = bcode_emit(comp->bc, bc_vdecl, slot, 0, 0);
+	comp->bc->instr[idx].p = vdecl;
+
+	intmap_set(&comp->scope->vars, vdecl->name->sid,
+	    (void *) (intptr_t) (slot + 1));
+}
+
+/** Compile expression statement.
+ *
+ * Assignments to local and member variables are compiled, anything else
+ * is executed by the tree walker.
+ *
+ * @param comp		Compiler
+ * @param stat		Expression statement
+ */
+static void comp_exps(comp_t *comp, stree_stat_t *stat)
+{
+	stree_assign_t *assign;
+	stree_nameref_t *nameref;
+	int slot;
+	int fslot;
+	int reg;
+
+	if (stat->u.exp_s->expr->ec != ec_assign) {
+		comp_exec(comp, stat);
+		return;
+	}
+
+	assign = stat->u.exp_s->expr->u.assign;
+	if (assign->ac != ac_set || assign->dest->ec != ec_nameref) {
+		comp_exec(comp, stat);
+		return;
+	}
+
+	nameref = assign->dest->u.nameref;
+	slot = comp_local_lookup(comp, nameref->name->sid);
+	fslot = -1;
+
+	if (slot < 0) {
+		fslot = comp_field_lookup(comp, nameref->name);
+		if (fslot < 0) {
+			comp_exec(comp, stat);
+			return;
+		}
+	}
+
+	reg = comp_expr(comp, assign->src);
+
+	if (slot >= 0)
+		(void) bcode_emit(comp->bc, bc_stloc, slot, reg, 0);
+	else
+		(void) bcode_emit(comp->bc, bc_stfld, fslot, reg, 0);
+}
+
+/** Compile @c if statement.
+ *
+ * @param comp		Compiler
+ * @param if_s		If statement
+ */
+static void comp_if(comp_t *comp, stree_if_t *if_s)
+{
+	list_node_t *ifc_node;
+	stree_if_clause_t *ifc;
+	int end_chain;
+	int next;
+	int jf;
+	int reg;
+
+	/* Jumps to the end are chained through their target operand. */
+	end_chain = -1;
+
+	ifc_node = list_first(&if_s->if_clauses);
+	while (ifc_node != NULL) {
+		ifc = list_node_data(ifc_node, stree_if_clause_t *);
+
+		reg = comp_expr(comp, ifc->cond);
+		jf = bcode_emit(comp->bc, bc_jf, reg, -1, 0);
+		comp->reg = 0;
+
+		comp_block(comp, ifc->block);
+
+		ifc_node = list_next(&if_s->if_clauses, ifc_node);
+		if (ifc_node != NULL || if_s->else_block != NULL) {
+			end_chain = bcode_emit(comp->bc, bc_jmp, end_chain,
+			    0, 0);
+		}
+
+		comp->bc->instr[jf].b = comp->bc->ninstr;
+	}
+
+	if (if_s->else_block != NULL)
+		comp_block(comp, if_s->else_block);
+
+	while (end_chain >= 0) {
+		next = comp->bc->instr[end_chain].a;
+		comp->bc->instr[end_chain].a = comp->bc->ninstr;
+		end_chain = next;
+	}
+}
+
+/** Compile @c while statement.
+ *
+ * @param comp		Compiler
+ * @param while_s	While statement
+ */
+static void comp_while(comp_t *comp, stree_while_t *while_s)
+{
+	comp_loop_t loop;
+	bcode_instr_t *instr;
+	int start;
+	int end;
+	int jf;
+	int reg;
+	int i;
+
+	start = comp->bc->ninstr;
+
+	reg = comp_expr(comp, while_s->cond);
+	jf = bcode_emit(comp->bc, bc_jf, reg, -1, 0);
+	comp->reg = 0;
+
+	loop.depth = comp->depth;
+	loop.outer = comp->loop;
+	comp->loop = &loop;
+
+	comp_block(comp, while_s->body);
+
+	comp->loop = loop.outer;
+
+	(void) bcode_emit(comp->bc, bc_jmp, start, 0, 0);
+	end = comp->bc->ninstr;
+	comp->bc->instr[jf].b = end;
+
+	/*
+	 * Patch breaks. Those of nested loops have already been patched,
+	 * any pending ones belong to this loop.
+	 */
+	for (i = start; i < end; i++) {
+		instr = &comp->bc->instr[i];
+		if (instr->opc == bc_jmp && instr->a == COMP_BRK_PENDING)
+			instr->a = end;
+		if (instr->opc == bc_exec && instr->b == COMP_BRK_PENDING)
+			instr->b = end;
+	}
+}
+
+/** Compile @c break statement.
+ *
+ * @param comp		Compiler
+ * @param stat		Break statement
+ */
+static void comp_break(comp_t *comp, stree_stat_t *stat)
+{
+	int depth;
+
+	if (comp->loop == NULL) {
+		/* Let the tree walker report it. */
+		comp_exec(comp, stat);
+		return;
+	}
+
+	for (depth = comp->depth; depth > comp->loop->depth; depth--)
+		(void) bcode_emit(comp->bc, bc_bleave, 0, 0, 0);
+
+	(void) bcode_emit(comp->bc, bc_jmp, COMP_BRK_PENDING, 0, 0);
+}
+
+/** Compile @c return statement.
+ *
+ * @param comp		Compiler
+ * @param return_s	Return statement
+ */
+static void comp_return(comp_t *comp, stree_return_t *return_s)
+{
+	int reg;
+
+	if (return_s->expr != NULL)
+		reg = comp_expr(comp, return_s->expr);
+	else
+		reg = -1;
+
+	(void) bcode_emit(comp->bc, bc_ret, reg, 0, 0);
+}
+
+/** Compile statement to be executed by the tree walker.
+ *
+ * @param comp		Compiler
+ * @param stat		Statement
+ */
+static void comp_exec(comp_t *comp, stree_stat_t *stat)
+{
+	int idx;
+
+	if (comp->loop != NULL) {
+		idx = bcode_emit(comp->bc, bc_exec, 0, COMP_BRK_PENDING,
+		    comp->loop->depth);
+	} else {
+		idx = bcode_emit(comp->bc, bc_exec, 0, -1, 0);
+	}
+
+	comp->bc->instr[idx].p = stat;
+}
+
+/** Compile expression.
+ *
+ * @param comp		Compiler
+ * @param expr		Expression
+ * @return		Register holding the value of the expression
+ */
+static int comp_expr(comp_t *comp, stree_expr_t *expr)
+{
+	switch (expr->ec) {
+	case ec_literal:
+		return comp_literal(comp, expr);
+	case ec_nameref:
+		return comp_nameref(comp, expr);
+	case ec_binop:
+		return comp_binop(comp, expr);
+	case ec_unop:
+		return comp_unop(comp, expr);
+	default:
+		return comp_eval(comp, expr);
+	}
+}
+
+/** Compile literal.
+ *
+ * @param comp		Compiler
+ * @param expr		Literal expression
+ * @return		Register holding the value
+ */
+static int comp_literal(comp_t *comp, stree_expr_t *expr)
+{
+	stree_literal_t *literal;
+	int reg;
+	int idx;
+
+	literal = expr->u.literal;
+
+	switch (literal->ltc) {
+	case ltc_bool:
+		reg = comp_reg_alloc(comp);
+		(void) bcode_emit(comp->bc, bc_ldbool, reg,
+		    literal->u.lit_bool.value, 0);
+		return reg;
+	case ltc_int:
+		reg = comp_reg_alloc(comp);
+		idx = bcode_emit(comp->bc, bc_ldint, reg, 0, 0);
+		comp->bc->instr[idx].p = &literal->u.lit_int.value;
+		return reg;
+	default:
+		return comp_eval(comp, expr);
+	}
+}
+
+/** Compile name reference.
+ *
+ * @param comp		Compiler
+ * @param expr		Name reference expression
+ * @return		Register holding the value
+ */
+static int comp_nameref(comp_t *comp, stree_expr_t *expr)
+{
+	stree_nameref_t *nameref;
+	int slot;
+	int reg;
+
+	nameref = expr->u.nameref;
+
+	slot = comp_local_lookup(comp, nameref->name->sid);
+	if (slot >= 0) {
+		reg = comp_reg_alloc(comp);
+		(void) bcode_emit(comp->bc, bc_ldloc, reg, slot, 0);
+		return reg;
+	}
+
+	slot = comp_field_lookup(comp, nameref->name);
+	if (slot >= 0) {
+		reg = comp_reg_alloc(comp);
+		(void) bcode_emit(comp->bc, bc_ldfld, reg, slot, 0);
+		return reg;
+	}
+
+	return comp_eval(comp, expr);
+}
+
+/** Compile binary operation.
+ *
+ * @param comp		Compiler
+ * @param expr		Binary operation expression
+ * @return		Register holding the result
+ */
+static int comp_binop(comp_t *comp, stree_expr_t *expr)
+{
+	stree_binop_t *binop;
+	tprimitive_class_t tpc1, tpc2;
+	int reg1, reg2;
+	int reg;
+	int idx;
+
+	binop = expr->u.binop;
+
+	if (!comp_expr_tpc(binop->arg1, &tpc1) ||
+	    !comp_expr_tpc(binop->arg2, &tpc2) || tpc1 != tpc2)
+		return comp_eval(comp, expr);
+
+	switch (tpc1) {
+	case tpc_int:
+		if (binop->bc == bo_and || binop->bc == bo_or)
+			return comp_eval(comp, expr);
+		break;
+	case tpc_bool:
+		if (binop->bc == bo_plus || binop->bc == bo_minus ||
+		    binop->bc == bo_mult)
+			return comp_eval(comp, expr);
+		break;
+	default:
+		return comp_eval(comp, expr);
+	}
+
+	reg1 = comp_expr(comp, binop->arg1);
+	reg2 = comp_expr(comp, binop->arg2);
+
+	/* The result replaces the operands. */
+	comp->reg = reg1;
+	reg = comp_reg_alloc(comp);
+
+	idx = bcode_emit(comp->bc, bc_binop, reg, reg1, reg2);
+	comp->bc->instr[idx].op = binop->bc;
+	return reg;
+}
+
+/** Compile unary operation.
+ *
+ * @param comp		Compiler
+ * @param expr		Unary operation expression
+ * @return		Register holding the result
+ */
+static int comp_unop(comp_t *comp, stree_expr_t *expr)
+{
+	stree_unop_t *unop;
+	tprimitive_class_t tpc;
+	int reg1;
+	int reg;
+	int idx;
+
+	unop = expr->u.unop;
+
+	if (!comp_expr_tpc(unop->arg, &tpc))
+		return comp_eval(comp, expr);
+
+	if (!(tpc == tpc_int && unop->uc != uo_not) &&
+	    !(tpc == tpc_bool && unop->uc == uo_not))
+		return comp_eval(comp, expr);
+
+	reg1 = comp_expr(comp, unop->arg);
+
+	comp->reg = reg1;
+	reg = comp_reg_alloc(comp);
+
+	idx = bcode_emit(comp->bc, bc_unop, reg, reg1, 0);
+	comp->bc->instr[idx].op = unop->uc;
+	return reg;
+}
+
+/** Compile expression to be evaluated by the tree walker.
+ *
+ * @param comp		Compiler
+ * @param expr		Expression
+ * @return		Register holding the value
+ */
+static int comp_eval(comp_t *comp, stree_expr_t *expr)
+{
+	int reg;
+	int idx;
+
+	reg = comp_reg_alloc(comp);
+	idx = bcode_emit(comp->bc, bc_eval, reg, 0, 0);
+	comp->bc->instr[idx].p = expr;
+	return reg;
+}
+
+/** Get primitive type class of expression.
+ *
+ * @param expr		Type-checked expression
+ * @param tpc		Place to store primitive type class
+ * @return		@c b_true if @a expr has primitive type
+ */
+static bool_t comp_expr_tpc(stree_expr_t *expr, tprimitive_class_t *tpc)
+{
+	if (expr->titem == NULL || expr->titem->tic != tic_tprimitive)
+		return b_false;
+
+	*tpc = expr->titem->u.tprimitive->tpc;
+	return b_true;
+}
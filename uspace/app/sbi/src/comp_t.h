@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMP_T_H_
+#define COMP_T_H_
+
+#include "intmap_t.h"
+
+/** Compiler scope
+ *
+ * One scope is created for the procedure arguments and one for each block.
+ * It maps names of local variables declared in it to slot numbers.
+ */
+typedef struct comp_scope {
+	/** Local variables (SID -> slot number + 1) */
+	intmap_t vars;
+
+	/** First slot number not used by outer scopes */
+	int slot_base;
+
+	/** Enclosing scope or @c NULL */
+	struct comp_scope *outer;
+} comp_scope_t;
+
+/** Loop being compiled */
+typedef struct comp_loop {
+	/** Block depth outside of the loop body */
+	int depth;
+
+	/** Enclosing loop or @c NULL */
+	struct comp_loop *outer;
+} comp_loop_t;
+
+/** Compiler state */
+typedef struct comp {
+	/** Program being compiled */
+	struct stree_program *program;
+
+	/** CSI from which names are resolved or @c NULL */
+	struct stree_csi *csi;
+
+	/** Procedure being built */
+	struct bcode *bc;
+
+	/** Innermost scope */
+	comp_scope_t *scope;
+
+	/** Innermost loop or @c NULL */
+	comp_loop_t *loop;
+
+	/** Current block depth */
+	int depth;
+
+	/** Next free slot */
+	int slot;
+
+	/** Next free register */
+	int reg;
+} comp_t;
+
+#endif
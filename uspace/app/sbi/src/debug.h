@@ -44,6 +44,9 @@
 /** Uncomment this to get verbose debugging messages during execution. */
 //#define DEBUG_RUN_TRACE
 
+/** Uncomment this to get bytecode listings and VM execution traces. */
+//#define DEBUG_VM_TRACE
+
 /** Uncomment this to get verbose debugging messages for bigint computation. */
 //#define DEBUG_BIGINT_TRACE
 
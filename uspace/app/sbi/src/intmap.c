@@ -25,28 +25,46 @@
  * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 /** @file Integer map.
  *
- * Maps integers to pointers (void *). Current implementation is trivial
- * (linked list of key-value pairs).
+ * Maps integers to pointers (void *). The map is a chained hash table.
+ * Keys are mostly SIDs, which are small consecutive integers, so the key
+ * itself is used as the hash. Buckets are only allocated on the first
+ * insertion as many maps (e.g. block activation records) stay empty.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include "list.h"
 #include "mytypes.h"
 
 #include "intmap.h"
 
+/** Initial number of buckets */
+#define INTMAP_INIT_BUCKETS 8
+
+static void intmap_grow(intmap_t *intmap);
+
+/** Compute bucket index for a key.
+ *
+ * @param intmap	Map (must have buckets allocated)
+ * @param key		Key
+ * @return		Bucket index
+ */
+static size_t intmap_hash(intmap_t *intmap, int key)
+{
+	return (size_t) (unsigned) key & (intmap->nbuckets - 1);
+}
+
 /** Initialize map.
  *
  * @param intmap	Map to initialize.
  */
 void intmap_init(intmap_t *intmap)
 {
-	list_init(&intmap->elem);
+	intmap->bucket = NULL;
+	intmap->nbuckets = 0;
+	intmap->count = 0;
 }
 
 /** Deinitialize map.
@@ -57,7 +75,11 @@ void intmap_init(intmap_t *intmap)
  */
 void intmap_fini(intmap_t *intmap)
 {
-	list_fini(&intmap->elem);
+	assert(intmap->count == 0);
+
+	free(intmap->bucket);
+	intmap->bucket = NULL;
+	intmap->nbuckets = 0;
 }
 
 /** Set value corresponding to a key.
@@ -72,27 +94,37 @@ void intmap_fini(intmap_t *intmap)
  */
 void intmap_set(intmap_t *intmap, int key, void *value)
 {
-	list_node_t *node;
+	map_elem_t **link;
 	map_elem_t *elem;
 
-	node = list_first(&intmap->elem);
-	while (node != NULL) {
-		elem = list_node_data(node, map_elem_t *);
-		if (elem->key == key) {
-			if (value != NULL) {
-				/* Replace existing value. */
-				elem->value = value;
-			} else {
-				/* Remove map element. */
-				list_remove(&intmap->elem, node);
-				free(elem);
+	if (intmap->nbuckets > 0) {
+		link = &intmap->bucket[intmap_hash(intmap, key)];
+		while (*link != NULL) {
+			elem = *link;
+			if (elem->key == key) {
+				if (value != NULL) {
+					/* Replace existing value. */
+					elem->value = value;
+				} else {
+					/* Remove map element. */
+					*link = elem->next;
+					free(elem);
+					--intmap->count;
+				}
+				return;
 			}
-			return;
+			link = &elem->next;
 		}
-		node = list_next(&intmap->elem, node);
 	}
 
-	/* Allocate new map element and add it to the list. */
+	if (value == NULL)
+		return;
+
+	/* Keep the load factor at or below one. */
+	if (intmap->count >= intmap->nbuckets)
+		intmap_grow(intmap);
+
+	/* Allocate new map element and add it to its bucket. */
 
 	elem = calloc(1, sizeof(map_elem_t));
 	if (elem == NULL) {
@@ -102,7 +134,11 @@ void intmap_set(intmap_t *intmap, int key, void *value)
 
 	elem->key = key;
 	elem->value = value;
-	list_append(&intmap->elem, elem);
+
+	link = &intmap->bucket[intmap_hash(intmap, key)];
+	elem->next = *link;
+	*link = elem;
+	++intmap->count;
 }
 
 /** Get value corresponding to a key.
@@ -115,16 +151,16 @@ void intmap_set(intmap_t *intmap, int key, void *value)
  */
 void *intmap_get(intmap_t *intmap, int key)
 {
-	list_node_t *node;
 	map_elem_t *elem;
 
-	node = list_first(&intmap->elem);
-	while (node != NULL) {
-		elem = list_node_data(node, map_elem_t *);
-		if (elem->key == key) {
+	if (intmap->count == 0)
+		return NULL;
+
+	elem = intmap->bucket[intmap_hash(intmap, key)];
+	while (elem != NULL) {
+		if (elem->key == key)
 			return elem->value;
-		}
-		node = list_next(&intmap->elem, node);
+		elem = elem->next;
 	}
 
 	/* Not found */
@@ -141,13 +177,18 @@ void *intmap_get(intmap_t *intmap, int key)
  */
 map_elem_t *intmap_first(intmap_t *intmap)
 {
-	list_node_t *node;
+	size_t i;
 
-	node = list_first(&intmap->elem);
-	if (node == NULL)
+	if (intmap->count == 0)
 		return NULL;
 
-	return list_node_data(node, map_elem_t *);
+	for (i = 0; i < intmap->nbuckets; i++) {
+		if (intmap->bucket[i] != NULL)
+			return intmap->bucket[i];
+	}
+
+	assert(b_false);
+	return NULL;
 }
 
 /** Get element key.
@@ -173,3 +214,41 @@ void *intmap_elem_get_value(map_elem_t *elem)
 {
 	return elem->value;
 }
+
+/** Double the number of buckets and rehash all elements.
+ *
+ * @param intmap	Map
+ */
+static void intmap_grow(intmap_t *intmap)
+{
+	map_elem_t **obucket;
+	size_t onbuckets;
+	map_elem_t *elem;
+	map_elem_t *next;
+	size_t idx;
+	size_t i;
+
+	obucket = intmap->bucket;
+	onbuckets = intmap->nbuckets;
+
+	intmap->nbuckets = onbuckets > 0 ? 2 * onbuckets :
+	    INTMAP_INIT_BUCKETS;
+	intmap->bucket = calloc(intmap->nbuckets, sizeof(map_elem_t *));
+	if (intmap->bucket == NULL) {
+		printf("Memory allocation failed.\n");
+		exit(1);
+	}
+
+	for (i = 0; i < onbuckets; i++) {
+		elem = obucket[i];
+		while (elem != NULL) {
+			next = elem->next;
+			idx = intmap_hash(intmap, elem->key);
+			elem->next = intmap->bucket[idx];
+			intmap->bucket[idx] = elem;
+			elem = next;
+		}
+	}
+
+	free(obucket);
+}
@@ -29,15 +29,25 @@
 #ifndef INTMAP_T_H_
 #define INTMAP_T_H_
 
-#include "list_t.h"
+#include <stddef.h>
 
-typedef struct {
+typedef struct map_elem {
 	int key;
 	void *value;
+
+	/** Next element in the same bucket */
+	struct map_elem *next;
 } map_elem_t;
 
 typedef struct intmap {
-	list_t elem; /* of (map_elem_t *) */
+	/** Hash buckets (chains of map_elem_t), @c NULL until first insert */
+	map_elem_t **bucket;
+
+	/** Number of buckets (zero or a power of two) */
+	size_t nbuckets;
+
+	/** Number of elements in the map */
+	size_t count;
 } intmap_t;
 
 #endif
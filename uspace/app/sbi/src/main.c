@@ -60,6 +60,7 @@ int main(int argc, char *argv[])
 	stree_program_t *program;
 	stype_t stype;
 	run_t run;
+	bool_t tree_walk;
 	errno_t rc;
 
 	/* Store executable file path under which we have been invoked. */
@@ -80,6 +81,18 @@ int main(int argc, char *argv[])
 		return 0;
 	}
 
+	tree_walk = b_false;
+	if (os_str_cmp(*argv, "-t") == 0) {
+		tree_walk = b_true;
+		argv += 1;
+		argc -= 1;
+
+		if (argc == 0) {
+			syntax_print();
+			return 1;
+		}
+	}
+
 	strtab_init();
 	program = stree_program_new();
 	program->module = stree_module_new();
@@ -121,6 +134,7 @@ int main(int argc, char *argv[])
 
 	/* Run program. */
 	run_init(&run);
+	run.tree_walk = tree_walk;
 	run_program(&run, program);
 
 	/* Check for run-time errors. */
@@ -133,5 +147,6 @@ int main(int argc, char *argv[])
 /** Print command-line syntax help. */
 static void syntax_print(void)
 {
-	printf("Syntax: sbi <source_file.sy>\n");
+	printf("Syntax: sbi [-t] <source_file.sy>\n");
+	printf("\t-t\tExecute using the tree-walking interpreter only\n");
 }
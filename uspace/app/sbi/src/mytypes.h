@@ -57,8 +57,11 @@ typedef enum {
 #define EOK 0
 #endif
 
+#include "arena_t.h"
+#include "bcode_t.h"
 #include "bigint_t.h"
 #include "builtin_t.h"
+#include "comp_t.h"
 #include "cspan_t.h"
 #include "input_t.h"
 #include "intmap_t.h"
@@ -71,5 +74,6 @@ typedef enum {
 #include "strtab_t.h"
 #include "stype_t.h"
 #include "tdata_t.h"
+#include "vm_t.h"
 
 #endif
@@ -43,6 +43,10 @@
  * a pointer to another var node. Delegate var node points to some stree
  * declaration. Array and object var nodes refer to a collection of child
  * nodes (fields, elements).
+ *
+ * Items, addresses, values, var nodes and integers are created and destroyed
+ * for nearly every evaluated expression. Instead of returning them to the
+ * heap they are kept on per-type free lists (pools) and reused.
  */
 
 #include <stdlib.h>
@@ -89,6 +93,28 @@ static void rdata_var_copy_to(rdata_var_t *src, rdata_var_t *dest);
 static void rdata_address_print(rdata_address_t *address);
 static void rdata_var_print(rdata_var_t *var);
 
+/** Maximum number of free nodes kept in one pool */
+#define RDATA_POOL_MAX 256
+
+/** Pool of free nodes of one type.
+ *
+ * Free nodes are linked through their first word.
+ */
+typedef struct {
+	void *free;
+	size_t count;
+} rdata_pool_t;
+
+static rdata_pool_t item_pool;
+static rdata_pool_t addr_var_pool;
+static rdata_pool_t address_pool;
+static rdata_pool_t value_pool;
+static rdata_pool_t var_pool;
+static rdata_pool_t int_pool;
+
+static void *rdata_pool_alloc(rdata_pool_t *pool, size_t size);
+static void rdata_pool_free(rdata_pool_t *pool, void *node);
+
 /** Allocate new data item.
  *
  * @param ic	Item class.
@@ -98,11 +124,7 @@ rdata_item_t *rdata_item_new(item_class_t ic)
 {
 	rdata_item_t *item;
 
-	item = calloc(1, sizeof(rdata_item_t));
-	if (item == NULL) {
-		printf("Memory allocation failed.\n");
-		exit(1);
-	}
+	item = rdata_pool_alloc(&item_pool, sizeof(rdata_item_t));
 
 	item->ic = ic;
 	return item;
@@ -116,11 +138,7 @@ rdata_addr_var_t *rdata_addr_var_new(void)
 {
 	rdata_addr_var_t *addr_var;
 
-	addr_var = calloc(1, sizeof(rdata_addr_var_t));
-	if (addr_var == NULL) {
-		printf("Memory allocation failed.\n");
-		exit(1);
-	}
+	addr_var = rdata_pool_alloc(&addr_var_pool, sizeof(rdata_addr_var_t));
 
 	return addr_var;
 }
@@ -187,11 +205,7 @@ rdata_address_t *rdata_address_new(address_class_t ac)
 {
 	rdata_address_t *address;
 
-	address = calloc(1, sizeof(rdata_address_t));
-	if (address == NULL) {
-		printf("Memory allocation failed.\n");
-		exit(1);
-	}
+	address = rdata_pool_alloc(&address_pool, sizeof(rdata_address_t));
 
 	address->ac = ac;
 	return address;
@@ -205,11 +219,7 @@ rdata_value_t *rdata_value_new(void)
 {
 	rdata_value_t *value;
 
-	value = calloc(1, sizeof(rdata_value_t));
-	if (value == NULL) {
-		printf("Memory allocation failed.\n");
-		exit(1);
-	}
+	value = rdata_pool_alloc(&value_pool, sizeof(rdata_value_t));
 
 	return value;
 }
@@ -223,11 +233,7 @@ rdata_var_t *rdata_var_new(var_class_t vc)
 {
 	rdata_var_t *var;
 
-	var = calloc(1, sizeof(rdata_var_t));
-	if (var == NULL) {
-		printf("Memory allocation failed.\n");
-		exit(1);
-	}
+	var = rdata_pool_alloc(&var_pool, sizeof(rdata_var_t));
 
 	var->vc = vc;
 	return var;
@@ -367,11 +373,7 @@ rdata_int_t *rdata_int_new(void)
 {
 	rdata_int_t *int_v;
 
-	int_v = calloc(1, sizeof(rdata_int_t));
-	if (int_v == NULL) {
-		printf("Memory allocation failed.\n");
-		exit(1);
-	}
+	int_v = rdata_pool_alloc(&int_pool, sizeof(rdata_int_t));
 
 	return int_v;
 }
@@ -471,7 +473,7 @@ static int rdata_array_get_dim(rdata_array_t *array)
 void rdata_item_delete(rdata_item_t *item)
 {
 	assert(item != NULL);
-	free(item);
+	rdata_pool_free(&item_pool, item);
 }
 
 /** Deallocate variable address.
@@ -481,7 +483,7 @@ void rdata_item_delete(rdata_item_t *item)
 void rdata_addr_var_delete(rdata_addr_var_t *addr_var)
 {
 	assert(addr_var != NULL);
-	free(addr_var);
+	rdata_pool_free(&addr_var_pool, addr_var);
 }
 
 /** Deallocate property address.
@@ -521,7 +523,7 @@ void rdata_aprop_indexed_delete(rdata_aprop_indexed_t *aprop_indexed)
 void rdata_address_delete(rdata_address_t *address)
 {
 	assert(address != NULL);
-	free(address);
+	rdata_pool_free(&address_pool, address);
 }
 
 /** Deallocate value.
@@ -531,7 +533,7 @@ void rdata_address_delete(rdata_address_t *address)
 void rdata_value_delete(rdata_value_t *value)
 {
 	assert(value != NULL);
-	free(value);
+	rdata_pool_free(&value_pool, value);
 }
 
 /** Deallocate var node.
@@ -541,7 +543,7 @@ void rdata_value_delete(rdata_value_t *value)
 void rdata_var_delete(rdata_var_t *var)
 {
 	assert(var != NULL);
-	free(var);
+	rdata_pool_free(&var_pool, var);
 }
 
 /** Deallocate boolean.
@@ -571,7 +573,7 @@ void rdata_char_delete(rdata_char_t *char_v)
 void rdata_int_delete(rdata_int_t *int_v)
 {
 	assert(int_v != NULL);
-	free(int_v);
+	rdata_pool_free(&int_pool, int_v);
 }
 
 /** Deallocate string.
@@ -1385,3 +1387,52 @@ static void rdata_var_print(rdata_var_t *var)
 		break;
 	}
 }
+
+/** Allocate a zeroed node, reusing a free node from a pool if possible.
+ *
+ * @param pool	Pool of free nodes
+ * @param size	Node size
+ * @return	New node
+ */
+static void *rdata_pool_alloc(rdata_pool_t *pool, size_t size)
+{
+	void *node;
+	size_t i;
+
+	if (pool->free != NULL) {
+		node = pool->free;
+		pool->free = *(void **) node;
+		--pool->count;
+
+		for (i = 0; i < size; i++)
+			((unsigned char *) node)[i] = 0;
+		return node;
+	}
+
+	node = calloc(1, size);
+	if (node == NULL) {
+		printf("Memory allocation failed.\n");
+		exit(1);
+	}
+
+	return node;
+}
+
+/** Return a node to a pool.
+ *
+ * If the pool is full, the node is returned to the heap.
+ *
+ * @param pool	Pool of free nodes
+ * @param node	Node
+ */
+static void rdata_pool_free(rdata_pool_t *pool, void *node)
+{
+	if (pool->count >= RDATA_POOL_MAX) {
+		free(node);
+		return;
+	}
+
+	*(void **) node = pool->free;
+	pool->free = node;
+	++pool->count;
+}
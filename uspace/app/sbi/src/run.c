@@ -45,6 +45,7 @@
 #include "strtab.h"
 #include "symbol.h"
 #include "tdata.h"
+#include "vm.h"
 
 #include "run.h"
 
@@ -82,7 +83,7 @@ static void run_var_new_enum(run_t *run, tdata_enum_t *tenum,
  */
 void run_init(run_t *run)
 {
-	(void) run;
+	run->tree_walk = b_false;
 }
 
 /** Run program.
@@ -197,7 +198,9 @@ void run_proc(run_t *run, run_proc_ar_t *proc_ar, rdata_item_t **res)
 
 	/* Run main procedure block. */
 	if (proc->body != NULL) {
-		run_block(run, proc->body);
+		/* Prefer the VM, the tree walker can run anything. */
+		if (run->tree_walk || !vm_run_proc(run, proc_ar))
+			run_block(run, proc->body);
 	} else {
 		builtin_run_proc(run, proc);
 	}
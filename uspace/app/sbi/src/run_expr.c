@@ -263,10 +263,22 @@ static void run_nameref(run_t *run, stree_nameref_t *nameref,
 		csi = NULL;
 	}
 
-	sym = symbol_lookup_in_csi(run->program, csi, nameref->name);
+	/*
+	 * Symbol lookup walks the CSI hierarchy. The result only depends
+	 * on the CSI we are looking from, so remember it in the nameref.
+	 */
+	if (nameref->sym_cached && nameref->sym_csi == csi) {
+		sym = nameref->sym;
+	} else {
+		sym = symbol_lookup_in_csi(run->program, csi, nameref->name);
 
-	/* Existence should have been verified in type checking phase. */
-	assert(sym != NULL);
+		/* Existence should have been verified in type checking. */
+		assert(sym != NULL);
+
+		nameref->sym_cached = b_true;
+		nameref->sym_csi = csi;
+		nameref->sym = sym;
+	}
 
 	switch (sym->sc) {
 	case sc_csi:
@@ -29,6 +29,7 @@
 #ifndef RUN_T_H_
 #define RUN_T_H_
 
+#include "arena_t.h"
 #include "intmap_t.h"
 #include "list_t.h"
 
@@ -103,6 +104,9 @@ typedef struct run_thread_ar {
 
 	/** @c b_true if a run-time error occured. */
 	bool_t error;
+
+	/** Arena for VM frames */
+	arena_t arena;
 } run_thread_ar_t;
 
 /** Runner state object */
@@ -115,6 +119,9 @@ typedef struct run {
 
 	/** Global state */
 	struct rdata_var *gdata;
+
+	/** @c b_true to run all procedures with the tree walker */
+	bool_t tree_walk;
 } run_t;
 
 #endif
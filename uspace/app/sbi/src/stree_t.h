@@ -38,6 +38,8 @@
  */
 
 struct stree_expr;
+struct stree_csi;
+struct stree_symbol;
 
 /** Identifier */
 typedef struct {
@@ -51,6 +53,14 @@ typedef struct {
 	struct stree_expr *expr;
 
 	stree_ident_t *name;
+
+	/*
+	 * Symbol resolved by the last evaluation. Used by the run module
+	 * to skip the symbol lookup when evaluated from the same CSI again.
+	 */
+	bool_t sym_cached;
+	struct stree_csi *sym_csi;
+	struct stree_symbol *sym;
 } stree_nameref_t;
 
 /** Boolean literal */
@@ -565,6 +575,9 @@ typedef struct stree_proc {
 
 	/** Builtin handler for builtin procedures */
 	builtin_proc_t bi_handler;
+
+	/** Compiled bytecode or @c NULL if not compiled yet */
+	struct bcode *bcode;
 } stree_proc_t;
 
 /** Constructor declaration */
@@ -35,22 +35,43 @@
  * The string table is a singleton as there will never be a need for
  * more than one.
  *
- * Current implementation uses a linked list and thus it is slow.
+ * Strings are kept in an array indexed by SID, with an open-addressing
+ * hash table of SIDs on top of it for looking up strings.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include "mytypes.h"
 #include "os/os.h"
-#include "list.h"
 
 #include "strtab.h"
 
-static list_t str_list;
+/** Initial number of hash slots (must be a power of two) */
+#define STRTAB_INIT_SLOTS 256
+
+/** Strings indexed by SID - 1 */
+static char **str_array;
+/** Number of strings in @c str_array */
+static size_t str_count;
+/** Allocated size of @c str_array */
+static size_t str_alloc;
+
+/** Hash slots containing SIDs, zero means free slot */
+static sid_t *str_hash;
+/** Number of hash slots (a power of two) */
+static size_t str_nslots;
+
+static size_t strtab_hash(const char *str);
+static void strtab_rehash(size_t nslots);
 
 /** Initialize string table. */
 void strtab_init(void)
 {
-	list_init(&str_list);
+	str_array = NULL;
+	str_count = 0;
+	str_alloc = 0;
+
+	strtab_rehash(STRTAB_INIT_SLOTS);
 }
 
 /** Get SID of a string.
@@ -63,22 +84,37 @@ void strtab_init(void)
  */
 sid_t strtab_get_sid(const char *str)
 {
-	list_node_t *node;
+	char **narray;
+	size_t idx;
 	sid_t sid;
 
-	sid = 0;
-	node = list_first(&str_list);
-
-	while (node != NULL) {
-		++sid;
-		if (os_str_cmp(str, list_node_data(node, char *)) == 0)
+	idx = strtab_hash(str) & (str_nslots - 1);
+	while (str_hash[idx] != 0) {
+		sid = str_hash[idx];
+		if (os_str_cmp(str, str_array[sid - 1]) == 0)
 			return sid;
 
-		node = list_next(&str_list, node);
+		idx = (idx + 1) & (str_nslots - 1);
+	}
+
+	if (str_count >= str_alloc) {
+		str_alloc = str_alloc > 0 ? 2 * str_alloc : STRTAB_INIT_SLOTS;
+		narray = realloc(str_array, str_alloc * sizeof(char *));
+		if (narray == NULL) {
+			printf("Memory allocation failed.\n");
+			exit(1);
+		}
+
+		str_array = narray;
 	}
 
-	++sid;
-	list_append(&str_list, os_str_dup(str));
+	str_array[str_count++] = os_str_dup(str);
+	sid = str_count;
+	str_hash[idx] = sid;
+
+	/* Keep the hash table at most half full. */
+	if (2 * str_count > str_nslots)
+		strtab_rehash(2 * str_nslots);
 
 	return sid;
 }
@@ -93,20 +129,57 @@ sid_t strtab_get_sid(const char *str)
  */
 char *strtab_get_str(sid_t sid)
 {
-	list_node_t *node;
-	sid_t cnt;
-
-	node = list_first(&str_list);
-	cnt = 1;
-	while (node != NULL && cnt < sid) {
-		node = list_next(&str_list, node);
-		cnt += 1;
-	}
-
-	if (node == NULL) {
+	if (sid < 1 || (size_t) sid > str_count) {
 		printf("Internal error: Invalid SID %d", sid);
 		abort();
 	}
 
-	return list_node_data(node, char *);
+	return str_array[sid - 1];
+}
+
+/** Compute hash of a string.
+ *
+ * @param str	String
+ * @return	Hash value
+ */
+static size_t strtab_hash(const char *str)
+{
+	size_t hash;
+
+	/* FNV-1a */
+	hash = 2166136261u;
+	while (*str != '\0') {
+		hash ^= (unsigned char) *str++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/** Rebuild the hash table with a new number of slots.
+ *
+ * @param nslots	New number of slots (a power of two)
+ */
+static void strtab_rehash(size_t nslots)
+{
+	size_t idx;
+	size_t i;
+
+	free(str_hash);
+
+	str_hash = calloc(nslots, sizeof(sid_t));
+	if (str_hash == NULL) {
+		printf("Memory allocation failed.\n");
+		exit(1);
+	}
+
+	str_nslots = nslots;
+
+	for (i = 0; i < str_count; i++) {
+		idx = strtab_hash(str_array[i]) & (str_nslots - 1);
+		while (str_hash[idx] != 0)
+			idx = (idx + 1) & (str_nslots - 1);
+
+		str_hash[idx] = i + 1;
+	}
 }
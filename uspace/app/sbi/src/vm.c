@@ -0,0 +1,781 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file Bytecode virtual machine.
+ *
+ * Executes procedures compiled by the comp module. Temporaries live in
+ * registers which hold @c int and @c bool values directly, without the
+ * item/value/var node chain the tree walker allocates for every
+ * intermediate result. Registers and slots of each activation are
+ * allocated from the thread's arena.
+ *
+ * Local variables are still kept in block activation records, so the tree
+ * walker can be called for any part of the procedure that was not compiled
+ * to native instructions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "arena.h"
+#include "bcode.h"
+#include "bigint.h"
+#include "comp.h"
+#include "debug.h"
+#include "intmap.h"
+#include "list.h"
+#include "mytypes.h"
+#include "rdata.h"
+#include "run.h"
+#include "run_expr.h"
+#include "strtab.h"
+#include "symbol.h"
+
+#include "vm.h"
+
+static bool_t vm_frame_setup(vm_frame_t *frame);
+static void vm_exec(vm_frame_t *frame);
+static int vm_bailout(vm_frame_t *frame, bcode_instr_t *instr);
+
+static void vm_block_enter(vm_frame_t *frame);
+static void vm_block_leave(vm_frame_t *frame);
+static void vm_vdecl(vm_frame_t *frame, bcode_instr_t *instr);
+static void vm_binop(vm_frame_t *frame, bcode_instr_t *instr);
+static void vm_unop(vm_frame_t *frame, bcode_instr_t *instr);
+static void vm_ret(vm_frame_t *frame, bcode_instr_t *instr);
+
+static void vm_load(vm_reg_t *reg, rdata_var_t *var, bool_t borrow);
+static void vm_store(vm_reg_t *reg, rdata_var_t *var);
+static void vm_reg_clear(vm_reg_t *reg);
+static bigint_t *vm_reg_get_int(vm_reg_t *reg);
+static bool_t vm_reg_get_bool(vm_reg_t *reg);
+static void vm_reg_to_item(vm_reg_t *reg, rdata_item_t **ritem);
+
+/** Run procedure in the VM.
+ *
+ * Compiles the procedure on first use. Must be called from run_proc()
+ * with @a proc_ar already on the stack.
+ *
+ * @param run		Runner object
+ * @param proc_ar	Procedure activation record
+ * @return		@c b_true if the procedure was run, @c b_false if it
+ *			cannot be run in the VM and the tree walker must be
+ *			used instead
+ */
+bool_t vm_run_proc(run_t *run, run_proc_ar_t *proc_ar)
+{
+	stree_proc_t *proc;
+	vm_frame_t frame;
+	arena_mark_t mark;
+	bcode_t *bc;
+	int i;
+
+	proc = proc_ar->proc;
+	assert(proc->body != NULL);
+
+	if (proc->bcode == NULL)
+		proc->bcode = comp_proc(run->program, proc);
+
+	bc = proc->bcode;
+	if (bc == NULL)
+		return b_false;
+
+	arena_mark(&run->thread_ar->arena, &mark);
+
+	frame.run = run;
+	frame.proc_ar = proc_ar;
+	frame.bc = bc;
+	frame.nblocks = 0;
+	frame.reg = arena_alloc(&run->thread_ar->arena,
+	    bc->nregs * sizeof(vm_reg_t));
+	frame.slot = arena_alloc(&run->thread_ar->arena,
+	    bc->nslots * sizeof(rdata_var_t *));
+	frame.fslot = arena_alloc(&run->thread_ar->arena,
+	    bc->nfields * sizeof(rdata_var_t *));
+
+	for (i = 0; i < bc->nregs; i++)
+		frame.reg[i].rc = vr_none;
+
+	if (!vm_frame_setup(&frame)) {
+		arena_release(&run->thread_ar->arena, &mark);
+		return b_false;
+	}
+
+	vm_exec(&frame);
+	assert(frame.nblocks == 0);
+
+	for (i = 0; i < bc->nregs; i++)
+		vm_reg_clear(&frame.reg[i]);
+
+	arena_release(&run->thread_ar->arena, &mark);
+	return b_true;
+}
+
+/** Fill argument and field slots of a new frame.
+ *
+ * Member variable names were resolved from the CSI where the procedure
+ * is defined. The tree walker resolves them from the class of the active
+ * object, so check that this gives the same symbols.
+ *
+ * @param frame		VM frame
+ * @return		@c b_true on success, @c b_false if the frame
+ *			cannot be set up
+ */
+static bool_t vm_frame_setup(vm_frame_t *frame)
+{
+	bcode_t *bc;
+	run_block_ar_t *block_ar;
+	rdata_object_t *obj;
+	stree_program_t *prog;
+	stree_csi_t *csi;
+	bcode_field_t *field;
+	int i;
+
+	bc = frame->bc;
+	prog = frame->run->program;
+
+	/* Arguments are in the first block AR. */
+	block_ar = list_node_data(list_first(&frame->proc_ar->block_ar),
+	    run_block_ar_t *);
+
+	for (i = 0; i < bc->nargs; i++) {
+		frame->slot[i] = intmap_get(&block_ar->vars, bc->arg_sid[i]);
+		if (frame->slot[i] == NULL)
+			return b_false;
+	}
+
+	if (bc->nfields == 0)
+		return b_true;
+
+	if (frame->proc_ar->obj == NULL ||
+	    frame->proc_ar->obj->vc != vc_object)
+		return b_false;
+
+	obj = frame->proc_ar->obj->u.object_v;
+	if (obj->class_sym == NULL)
+		return b_false;
+
+	csi = symbol_to_csi(obj->class_sym);
+
+	if (csi != bc->csi && csi != bc->vcsi) {
+		for (i = 0; i < bc->nfields; i++) {
+			field = &bc->field[i];
+			if (symbol_lookup_in_csi(prog, csi, field->name) !=
+			    field->sym)
+				return b_false;
+			if (symbol_search_csi(prog, csi, field->name) == NULL)
+				return b_false;
+		}
+
+		bc->vcsi = csi;
+	}
+
+	for (i = 0; i < bc->nfields; i++) {
+		frame->fslot[i] = intmap_get(&obj->fields,
+		    bc->field[i].name->sid);
+		if (frame->fslot[i] == NULL)
+			return b_false;
+	}
+
+	return b_true;
+}
+
+/** Execute instructions of a frame.
+ *
+ * Returns when the procedure returns or when control bails out of it.
+ * The bailout mode is left for run_proc() to handle.
+ *
+ * @param frame		VM frame
+ */
+static void vm_exec(vm_frame_t *frame)
+{
+	run_t *run;
+	bcode_instr_t *instr;
+	vm_reg_t *reg;
+	rdata_item_t *item;
+	rdata_item_t *vitem;
+	bool_t cond;
+	int pc;
+
+	run = frame->run;
+	reg = frame->reg;
+	pc = 0;
+
+	while (b_true) {
+		assert(pc >= 0 && pc < frame->bc->ninstr);
+		instr = &frame->bc->instr[pc++];
+
+#ifdef DEBUG_VM_TRACE
+		printf("VM: execute instruction %d.\n", pc - 1);
+#endif
+		switch (instr->opc) {
+		case bc_ldbool:
+			vm_reg_clear(&reg[instr->a]);
+			reg[instr->a].rc = vr_bool;
+			reg[instr->a].u.bool_v = instr->b;
+			break;
+		case bc_ldint:
+			vm_reg_clear(&reg[instr->a]);
+			reg[instr->a].rc = vr_intref;
+			reg[instr->a].u.intref = instr->p;
+			break;
+		case bc_ldloc:
+			vm_load(&reg[instr->a], frame->slot[instr->b], b_true);
+			break;
+		case bc_stloc:
+			vm_store(&reg[instr->b], frame->slot[instr->a]);
+			break;
+		case bc_ldfld:
+			/*
+			 * Member variables can be changed by procedures
+			 * we call, so do not borrow their values.
+			 */
+			vm_load(&reg[instr->a], frame->fslot[instr->b],
+			    b_false);
+			break;
+		case bc_stfld:
+			vm_store(&reg[instr->b], frame->fslot[instr->a]);
+			break;
+		case bc_binop:
+			vm_binop(frame, instr);
+			break;
+		case bc_unop:
+			vm_unop(frame, instr);
+			break;
+		case bc_jmp:
+			pc = instr->a;
+			break;
+		case bc_jf:
+			cond = vm_reg_get_bool(&reg[instr->a]);
+			vm_reg_clear(&reg[instr->a]);
+			if (!cond)
+				pc = instr->b;
+			break;
+		case bc_eval:
+			run_expr(run, instr->p, &item);
+			if (run_is_bo(run)) {
+				if (item != NULL)
+					rdata_item_destroy(item);
+				pc = vm_bailout(frame, instr);
+				if (pc < 0)
+					return;
+				break;
+			}
+
+			run_cvt_value_item(run, item, &vitem);
+			rdata_item_destroy(item);
+			if (run_is_bo(run)) {
+				pc = vm_bailout(frame, instr);
+				if (pc < 0)
+					return;
+				break;
+			}
+
+			vm_reg_clear(&reg[instr->a]);
+			reg[instr->a].rc = vr_item;
+			reg[instr->a].u.item = vitem;
+			break;
+		case bc_exec:
+			run_stat(run, instr->p, NULL);
+			if (run_is_bo(run)) {
+				pc = vm_bailout(frame, instr);
+				if (pc < 0)
+					return;
+			}
+			break;
+		case bc_vdecl:
+			vm_vdecl(frame, instr);
+			break;
+		case bc_benter:
+			vm_block_enter(frame);
+			break;
+		case bc_bleave:
+			vm_block_leave(frame);
+			break;
+		case bc_ret:
+			vm_ret(frame, instr);
+			return;
+		}
+	}
+}
+
+/** Handle bailout from tree walker.
+ *
+ * A break bailout from a statement inside a compiled loop terminates the
+ * loop, as run_while() would. Any other bailout leaves the procedure.
+ *
+ * @param frame		VM frame
+ * @param instr		Instruction that bailed out
+ * @return		Index of next instruction or -1 to leave the
+ *			procedure
+ */
+static int vm_bailout(vm_frame_t *frame, bcode_instr_t *instr)
+{
+	run_thread_ar_t *thread_ar;
+
+	thread_ar = frame->run->thread_ar;
+
+	if (thread_ar->bo_mode == bm_stat && instr->opc == bc_exec &&
+	    instr->b >= 0) {
+		while (frame->nblocks > instr->c)
+			vm_block_leave(frame);
+
+		thread_ar->bo_mode = bm_none;
+		return instr->b;
+	}
+
+	while (frame->nblocks > 0)
+		vm_block_leave(frame);
+
+	return -1;
+}
+
+/** Enter block.
+ *
+ * @param frame		VM frame
+ */
+static void vm_block_enter(vm_frame_t *frame)
+{
+	run_block_ar_t *block_ar;
+
+	block_ar = run_block_ar_new();
+	intmap_init(&block_ar->vars);
+
+	list_append(&frame->proc_ar->block_ar, block_ar);
+	frame->nblocks += 1;
+}
+
+/** Leave block.
+ *
+ * Destroys the variables declared in the block.
+ *
+ * @param frame		VM frame
+ */
+static void vm_block_leave(vm_frame_t *frame)
+{
+	list_node_t *node;
+	run_block_ar_t *block_ar;
+
+	assert(frame->nblocks > 0);
+
+	node = list_last(&frame->proc_ar->block_ar);
+	block_ar = list_node_data(node, run_block_ar_t *);
+	list_remove(&frame->proc_ar->block_ar, node);
+
+	run_block_ar_destroy(frame->run, block_ar);
+	frame->nblocks -= 1;
+}
+
+/** Declare local variable.
+ *
+ * The variable is entered into the current block AR, where the tree
+ * walker can find it, and into its slot.
+ *
+ * @param frame		VM frame
+ * @param instr		bc_vdecl instruction
+ */
+static void vm_vdecl(vm_frame_t *frame, bcode_instr_t *instr)
+{
+	stree_vdecl_t *vdecl;
+	run_block_ar_t *block_ar;
+	rdata_var_t *var;
+
+	vdecl = instr->p;
+	run_var_new(frame->run, vdecl->titem, &var);
+
+	block_ar = run_get_current_block_ar(frame->run);
+	if (intmap_get(&block_ar->vars, vdecl->name->sid) != NULL) {
+		printf("Error: Duplicate variable '%s'\n",
+		    strtab_get_str(vdecl->name->sid));
+		exit(1);
+	}
+
+	intmap_set(&block_ar->vars, vdecl->name->sid, var);
+	frame->slot[instr->a] = var;
+}
+
+/** Execute binary operation.
+ *
+ * The compiler only emits this for two @c int or two @c bool operands.
+ *
+ * @param frame		VM frame
+ * @param instr		bc_binop instruction
+ */
+static void vm_binop(vm_frame_t *frame, bcode_instr_t *instr)
+{
+	vm_reg_t *r1, *r2, *dest;
+	bigint_t *i1, *i2;
+	bigint_t ires;
+	bigint_t diff;
+	bool_t b1, b2;
+	bool_t bres;
+	bool_t zf, nf;
+	bool_t is_int;
+
+	r1 = &frame->reg[instr->b];
+	r2 = &frame->reg[instr->c];
+	dest = &frame->reg[instr->a];
+
+	/* Make compiler happy. */
+	bres = b_false;
+
+	is_int = r1->rc == vr_int || r1->rc == vr_intref ||
+	    (r1->rc == vr_item &&
+	    r1->u.item->u.value->var->vc == vc_int);
+
+	if (is_int) {
+		i1 = vm_reg_get_int(r1);
+		i2 = vm_reg_get_int(r2);
+
+		switch (instr->op) {
+		case bo_plus:
+			bigint_add(i1, i2, &ires);
+			goto int_result;
+		case bo_minus:
+			bigint_sub(i1, i2, &ires);
+			goto int_result;
+		case bo_mult:
+			bigint_mul(i1, i2, &ires);
+			goto int_result;
+		default:
+			break;
+		}
+
+		/* Relational operation. */
+		bigint_sub(i1, i2, &diff);
+		zf = bigint_is_zero(&diff);
+		nf = bigint_is_negative(&diff);
+		bigint_destroy(&diff);
+
+		switch (instr->op) {
+		case bo_equal:
+			bres = zf;
+			break;
+		case bo_notequal:
+			bres = !zf;
+			break;
+		case bo_lt:
+			bres = (!zf && nf);
+			break;
+		case bo_gt:
+			bres = (!zf && !nf);
+			break;
+		case bo_lt_equal:
+			bres = (zf || nf);
+			break;
+		case bo_gt_equal:
+			bres = !nf;
+			break;
+		default:
+			assert(b_false);
+		}
+	} else {
+		b1 = vm_reg_get_bool(r1);
+		b2 = vm_reg_get_bool(r2);
+
+		switch (instr->op) {
+		case bo_equal:
+			bres = (b1 == b2);
+			break;
+		case bo_notequal:
+			bres = (b1 != b2);
+			break;
+		case bo_lt:
+			bres = (b1 == b_false) && (b2 == b_true);
+			break;
+		case bo_gt:
+			bres = (b1 == b_true) && (b2 == b_false);
+			break;
+		case bo_lt_equal:
+			bres = (b1 == b_false) || (b2 == b_true);
+			break;
+		case bo_gt_equal:
+			bres = (b1 == b_true) || (b2 == b_false);
+			break;
+		case bo_and:
+			bres = (b1 == b_true) && (b2 == b_true);
+			break;
+		case bo_or:
+			bres = (b1 == b_true) || (b2 == b_true);
+			break;
+		default:
+			assert(b_false);
+		}
+	}
+
+	vm_reg_clear(r1);
+	vm_reg_clear(r2);
+	vm_reg_clear(dest);
+	dest->rc = vr_bool;
+	dest->u.bool_v = bres;
+	return;
+
+int_result:
+	vm_reg_clear(r1);
+	vm_reg_clear(r2);
+	vm_reg_clear(dest);
+	dest->rc = vr_int;
+	dest->u.int_v = ires;
+}
+
+/** Execute unary operation.
+ *
+ * The compiler only emits this for @c - and @c + on @c int and for
+ * @c ! on @c bool.
+ *
+ * @param frame		VM frame
+ * @param instr		bc_unop instruction
+ */
+static void vm_unop(vm_frame_t *frame, bcode_instr_t *instr)
+{
+	vm_reg_t *arg, *dest;
+	bigint_t ires;
+	bool_t bres;
+
+	arg = &frame->reg[instr->b];
+	dest = &frame->reg[instr->a];
+
+	switch (instr->op) {
+	case uo_plus:
+		bigint_clone(vm_reg_get_int(arg), &ires);
+		break;
+	case uo_minus:
+		bigint_reverse_sign(vm_reg_get_int(arg), &ires);
+		break;
+	case uo_not:
+		bres = !vm_reg_get_bool(arg);
+		vm_reg_clear(arg);
+		vm_reg_clear(dest);
+		dest->rc = vr_bool;
+		dest->u.bool_v = bres;
+		return;
+	default:
+		assert(b_false);
+		return;
+	}
+
+	vm_reg_clear(arg);
+	vm_reg_clear(dest);
+	dest->rc = vr_int;
+	dest->u.int_v = ires;
+}
+
+/** Return from procedure.
+ *
+ * @param frame		VM frame
+ * @param instr		bc_ret instruction
+ */
+static void vm_ret(vm_frame_t *frame, bcode_instr_t *instr)
+{
+	rdata_item_t *item;
+
+	if (instr->a >= 0) {
+		vm_reg_to_item(&frame->reg[instr->a], &item);
+		frame->proc_ar->retval = item;
+	}
+
+	while (frame->nblocks > 0)
+		vm_block_leave(frame);
+}
+
+/** Load variable to register.
+ *
+ * @param reg		Register
+ * @param var		Variable
+ * @param borrow	@c b_true to refer to the integer value of @a var
+ *			instead of copying it
+ */
+static void vm_load(vm_reg_t *reg, rdata_var_t *var, bool_t borrow)
+{
+	vm_reg_clear(reg);
+
+	switch (var->vc) {
+	case vc_bool:
+		reg->rc = vr_bool;
+		reg->u.bool_v = var->u.bool_v->value;
+		break;
+	case vc_int:
+		if (borrow) {
+			reg->rc = vr_intref;
+			reg->u.intref = &var->u.int_v->value;
+		} else {
+			reg->rc = vr_int;
+			bigint_clone(&var->u.int_v->value, &reg->u.int_v);
+		}
+		break;
+	default:
+		reg->rc = vr_item;
+		rdata_var_read(var, &reg->u.item);
+		break;
+	}
+}
+
+/** Store register to variable.
+ *
+ * The register is cleared.
+ *
+ * @param reg		Register
+ * @param var		Variable
+ */
+static void vm_store(vm_reg_t *reg, rdata_var_t *var)
+{
+	rdata_item_t *item;
+	bigint_t ival;
+
+	if (var->vc == vc_bool && reg->rc == vr_bool) {
+		var->u.bool_v->value = reg->u.bool_v;
+	} else if (var->vc == vc_int && reg->rc == vr_int) {
+		bigint_destroy(&var->u.int_v->value);
+		var->u.int_v->value = reg->u.int_v;
+		reg->rc = vr_none;
+	} else if (var->vc == vc_int && reg->rc == vr_intref) {
+		/* Copy first, @a reg can refer to @a var itself. */
+		bigint_clone(reg->u.intref, &ival);
+		bigint_destroy(&var->u.int_v->value);
+		var->u.int_v->value = ival;
+	} else {
+		vm_reg_to_item(reg, &item);
+		rdata_var_write(var, item->u.value);
+		rdata_item_destroy(item);
+	}
+
+	vm_reg_clear(reg);
+}
+
+/** Clear register.
+ *
+ * Frees the value owned by the register.
+ *
+ * @param reg		Register
+ */
+static void vm_reg_clear(vm_reg_t *reg)
+{
+	switch (reg->rc) {
+	case vr_int:
+		bigint_destroy(&reg->u.int_v);
+		break;
+	case vr_item:
+		if (reg->u.item != NULL)
+			rdata_item_destroy(reg->u.item);
+		break;
+	default:
+		break;
+	}
+
+	reg->rc = vr_none;
+}
+
+/** Get integer value of register.
+ *
+ * @param reg		Register holding an integer
+ * @return		Pointer to the value
+ */
+static bigint_t *vm_reg_get_int(vm_reg_t *reg)
+{
+	switch (reg->rc) {
+	case vr_int:
+		return &reg->u.int_v;
+	case vr_intref:
+		return reg->u.intref;
+	case vr_item:
+		assert(reg->u.item->u.value->var->vc == vc_int);
+		return &reg->u.item->u.value->var->u.int_v->value;
+	default:
+		assert(b_false);
+		return NULL;
+	}
+}
+
+/** Get boolean value of register.
+ *
+ * @param reg		Register holding a boolean
+ * @return		The value
+ */
+static bool_t vm_reg_get_bool(vm_reg_t *reg)
+{
+	switch (reg->rc) {
+	case vr_bool:
+		return reg->u.bool_v;
+	case vr_item:
+		assert(reg->u.item->u.value->var->vc == vc_bool);
+		return reg->u.item->u.value->var->u.bool_v->value;
+	default:
+		assert(b_false);
+		return b_false;
+	}
+}
+
+/** Convert register to value item.
+ *
+ * The value is moved out of the register, which is left empty.
+ *
+ * @param reg		Register
+ * @param ritem		Place to store pointer to new value item
+ */
+static void vm_reg_to_item(vm_reg_t *reg, rdata_item_t **ritem)
+{
+	rdata_item_t *item;
+	rdata_value_t *value;
+	rdata_var_t *var;
+
+	if (reg->rc == vr_item) {
+		*ritem = reg->u.item;
+		reg->rc = vr_none;
+		return;
+	}
+
+	item = rdata_item_new(ic_value);
+	value = rdata_value_new();
+	item->u.value = value;
+
+	switch (reg->rc) {
+	case vr_bool:
+		var = rdata_var_new(vc_bool);
+		var->u.bool_v = rdata_bool_new();
+		var->u.bool_v->value = reg->u.bool_v;
+		break;
+	case vr_int:
+		var = rdata_var_new(vc_int);
+		var->u.int_v = rdata_int_new();
+		var->u.int_v->value = reg->u.int_v;
+		break;
+	case vr_intref:
+		var = rdata_var_new(vc_int);
+		var->u.int_v = rdata_int_new();
+		bigint_clone(reg->u.intref, &var->u.int_v->value);
+		break;
+	default:
+		assert(b_false);
+		var = NULL;
+		break;
+	}
+
+	value->var = var;
+	reg->rc = vr_none;
+	*ritem = item;
+}
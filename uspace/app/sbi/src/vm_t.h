@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef VM_T_H_
+#define VM_T_H_
+
+#include "bigint_t.h"
+
+/** Class of VM register content */
+typedef enum {
+	/** Empty */
+	vr_none,
+
+	/** Boolean value */
+	vr_bool,
+
+	/** Integer value owned by the register */
+	vr_int,
+
+	/** Integer value borrowed from a constant or local variable */
+	vr_intref,
+
+	/** Value item (any type) */
+	vr_item
+} vm_reg_class_t;
+
+/** VM register */
+typedef struct {
+	vm_reg_class_t rc;
+
+	union {
+		bool_t bool_v;
+		bigint_t int_v;
+		bigint_t *intref;
+		struct rdata_item *item;
+	} u;
+} vm_reg_t;
+
+/** VM frame (activation of a compiled procedure) */
+typedef struct {
+	/** Runner object */
+	struct run *run;
+
+	/** Procedure activation record */
+	struct run_proc_ar *proc_ar;
+
+	/** Compiled procedure */
+	struct bcode *bc;
+
+	/** Registers */
+	vm_reg_t *reg;
+
+	/** Local variable slots */
+	struct rdata_var **slot;
+
+	/** Member variable slots */
+	struct rdata_var **fslot;
+
+	/** Number of block activation records pushed by the VM */
+	int nblocks;
+} vm_frame_t;
+
+#endif
@@ -59,6 +59,8 @@ typedef enum {
 	LIST_THREADS,
 	LIST_IPCCS,
 	LIST_CPUS,
+	LIST_LOCKS,
+	PRINT_TLB,
 	PRINT_LOAD,
 	PRINT_UPTIME,
 	PRINT_ARCH
@@ -150,12 +152,15 @@ static void list_ipccs(task_id_t task_id, bool all)
 		return;
 	}
 
-	printf("[caller] [callee]\n");
+	printf("[caller] [callee] [calls   ] [answers ] [active]\n");
 
 	for (size_t i = 0; i < count; i++) {
 		if ((all) || (stats_ipccs[i].caller == task_id)) {
-			printf("%-8" PRIu64 " %-8" PRIu64 "\n",
-			    stats_ipccs[i].caller, stats_ipccs[i].callee);
+			printf("%-8" PRIu64 " %-8" PRIu64 " %10" PRIu64
+			    " %10" PRIu64 " %8" PRIu64 "\n",
+			    stats_ipccs[i].caller, stats_ipccs[i].callee,
+			    stats_ipccs[i].calls, stats_ipccs[i].answers,
+			    stats_ipccs[i].active);
 		}
 	}
 
@@ -172,7 +177,8 @@ static void list_cpus(void)
 		return;
 	}
 
-	printf("[id] [MHz     ] [busy cycles] [idle cycles]\n");
+	printf("[id] [MHz     ] [busy cycles] [idle cycles] [stolen    ] "
+	    "[balanced  ]\n");
 
 	for (size_t i = 0; i < count; i++) {
 		printf("%-4u ", cpus[i].id);
@@ -183,9 +189,11 @@ static void list_cpus(void)
 			order_suffix(cpus[i].busy_cycles, &bcycles, &bsuffix);
 			order_suffix(cpus[i].idle_cycles, &icycles, &isuffix);
 
-			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c\n",
+			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c "
+			    "%12" PRIu64 " %12" PRIu64 "\n",
 			    cpus[i].frequency_mhz, bcycles, bsuffix,
-			    icycles, isuffix);
+			    icycles, isuffix, cpus[i].steal_count,
+			    cpus[i].balance_count);
 		} else
 			printf("inactive\n");
 	}
@@ -193,6 +201,59 @@ static void list_cpus(void)
 	free(cpus);
 }
 
+static void list_locks(void)
+{
+	size_t count;
+	stats_lock_t *locks = stats_get_locks(&count);
+
+	if (locks == NULL) {
+		fprintf(stderr, "%s: Lock statistics not available\n", NAME);
+		return;
+	}
+
+	printf("[acquired  ] [contended ] [wait cycles] [max hold   ] "
+	    "[spun      ] [slept     ] [name\n");
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t wcycles, hcycles;
+		char wsuffix, hsuffix;
+
+		order_suffix(locks[i].wait_cycles, &wcycles, &wsuffix);
+		order_suffix(locks[i].max_hold_cycles, &hcycles, &hsuffix);
+
+		printf("%12" PRIu64 " %12" PRIu64 " %12" PRIu64 "%c "
+		    "%12" PRIu64 "%c %12" PRIu64 " %12" PRIu64 " %s\n",
+		    locks[i].acquired, locks[i].contended, wcycles, wsuffix,
+		    hcycles, hsuffix, locks[i].spun, locks[i].slept,
+		    locks[i].name);
+	}
+
+	free(locks);
+}
+
+static void print_tlb(void)
+{
+	stats_tlb_t *tlb = stats_get_tlb();
+
+	if (tlb == NULL) {
+		fprintf(stderr, "%s: Unable to get TLB statistics\n", NAME);
+		return;
+	}
+
+	uint64_t avg = (tlb->shootdowns > 0) ?
+	    tlb->cycles / tlb->shootdowns : 0;
+
+	printf("Shootdowns:      %" PRIu64 "\n", tlb->shootdowns);
+	printf("CPUs targeted:   %" PRIu64 "\n", tlb->targeted);
+	printf("CPUs skipped:    %" PRIu64 "\n", tlb->skipped);
+	printf("Full flushes:    %" PRIu64 "\n", tlb->full_flushes);
+	printf("Pages:           %" PRIu64 "\n", tlb->pages);
+	printf("Average cycles:  %" PRIu64 "\n", avg);
+	printf("Maximum cycles:  %" PRIu64 "\n", tlb->max_cycles);
+
+	free(tlb);
+}
+
 static void print_load(void)
 {
 	size_t count;
@@ -367,7 +428,7 @@ static void print_arch(void)
 static void usage(const char *name)
 {
 	printf(
-	    "Usage: %s [-t task_id] [-i task_id] [-at] [-ai] [-c] [-l] [-u] [-d]\n"
+	    "Usage: %s [-t task_id] [-i task_id] [-at] [-ai] [-c] [-k] [-b] [-l] [-u] [-d]\n"
 	    "\n"
 	    "Options:\n"
 	    "\t-t task_id | --task=task_id\n"
@@ -385,6 +446,12 @@ static void usage(const char *name)
 	    "\t-c | --cpus\n"
 	    "\t\tList CPUs\n"
 	    "\n"
+	    "\t-k | --locks\n"
+	    "\t\tList lock contention statistics\n"
+	    "\n"
+	    "\t-b | --tlb\n"
+	    "\t\tPrint TLB shootdown statistics\n"
+	    "\n"
 	    "\t-l | --load\n"
 	    "\t\tPrint system load\n"
 	    "\n"
@@ -468,6 +535,18 @@ int main(int argc, char *argv[])
 			continue;
 		}
 
+		/* Locks */
+		if ((off = arg_parse_short_long(argv[i], "-k", "--locks")) != -1) {
+			output_toggle = LIST_LOCKS;
+			continue;
+		}
+
+		/* TLB shootdowns */
+		if ((off = arg_parse_short_long(argv[i], "-b", "--tlb")) != -1) {
+			output_toggle = PRINT_TLB;
+			continue;
+		}
+
 		/* Load */
 		if ((off = arg_parse_short_long(argv[i], "-l", "--load")) != -1) {
 			output_toggle = PRINT_LOAD;
@@ -500,6 +579,12 @@ int main(int argc, char *argv[])
 	case LIST_CPUS:
 		list_cpus();
 		break;
+	case LIST_LOCKS:
+		list_locks();
+		break;
+	case PRINT_TLB:
+		print_tlb();
+		break;
 	case PRINT_LOAD:
 		print_load();
 		break;
@@ -32,19 +32,36 @@
 /** @file File manipulation utility functions for installer
  */
 
-#include <dirent.h>
 #include <errno.h>
+#include <fcopy.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <str_error.h>
 #include <vfs/vfs.h>
-#include <dirent.h>
 
 #include "futil.h"
 
-#define BUF_SIZE 16384
-static char buf[BUF_SIZE];
+static void futil_copy_cb(void *arg, const char *src, const char *dest,
+    bool dir)
+{
+	if (dir)
+		printf("Create directory '%s'\n", dest);
+	else
+		printf("Copy '%s' to '%s'.\n", src, dest);
+}
+
+static void futil_error_cb(void *arg, const char *src, const char *dest,
+    errno_t rc)
+{
+	printf("Error copying '%s' to '%s': %s.\n", src, dest, str_error(rc));
+}
+
+static fcopy_cb_t futil_cb = {
+	.copy = futil_copy_cb,
+	.error = futil_error_cb
+};
 
 /** Copy file.
  *
@@ -55,48 +72,19 @@ static char buf[BUF_SIZE];
  */
 errno_t futil_copy_file(const char *srcp, const char *destp)
 {
-	int sf, df;
-	size_t nr, nw;
-	errno_t rc;
-	aoff64_t posr = 0, posw = 0;
-
-	printf("Copy '%s' to '%s'.\n", srcp, destp);
-
-	rc = vfs_lookup_open(srcp, WALK_REGULAR, MODE_READ, &sf);
-	if (rc != EOK)
-		return EIO;
-
-	rc = vfs_lookup_open(destp, WALK_REGULAR | WALK_MAY_CREATE, MODE_WRITE, &df);
-	if (rc != EOK)
-		return EIO;
+	fcopy_cfg_t cfg;
 
-	do {
-		rc = vfs_read(sf, &posr, buf, BUF_SIZE, &nr);
-		if (rc != EOK)
-			goto error;
-		if (nr == 0)
-			break;
+	fcopy_cfg_init(&cfg);
+	cfg.overwrite = true;
+	cfg.cb = &futil_cb;
 
-		rc = vfs_write(df, &posw, buf, nr, &nw);
-		if (rc != EOK)
-			goto error;
-
-	} while (nr == BUF_SIZE);
-
-	(void) vfs_put(sf);
-
-	rc = vfs_put(df);
-	if (rc != EOK)
-		return EIO;
-
-	return EOK;
-error:
-	vfs_put(sf);
-	vfs_put(df);
-	return rc;
+	return (fcopy_file(&cfg, srcp, destp) == EOK) ? EOK : EIO;
 }
 
 /** Copy contents of srcdir (recursively) into destdir.
+ *
+ * Several files are copied concurrently and the destination
+ * is synchronized once at the end.
  *
  * @param srcdir Source directory
  * @param destdir Destination directory
@@ -105,47 +93,18 @@ error:
  */
 errno_t futil_rcopy_contents(const char *srcdir, const char *destdir)
 {
-	DIR *dir;
-	struct dirent *de;
-	vfs_stat_t s;
-	char *srcp, *destp;
+	fcopy_cfg_t cfg;
 	errno_t rc;
 
-	dir = opendir(srcdir);
-	if (dir == NULL)
-		return EIO;
+	fcopy_cfg_init(&cfg);
+	cfg.overwrite = true;
+	cfg.cb = &futil_cb;
 
-	de = readdir(dir);
-	while (de != NULL) {
-		if (asprintf(&srcp, "%s/%s", srcdir, de->d_name) < 0)
-			return ENOMEM;
-		if (asprintf(&destp, "%s/%s", destdir, de->d_name) < 0)
-			return ENOMEM;
-
-		rc = vfs_stat_path(srcp, &s);
-		if (rc != EOK)
-			return EIO;
-
-		if (s.is_file) {
-			rc = futil_copy_file(srcp, destp);
-			if (rc != EOK)
-				return EIO;
-		} else if (s.is_directory) {
-			printf("Create directory '%s'\n", destp);
-			rc = vfs_link_path(destp, KIND_DIRECTORY, NULL);
-			if (rc != EOK)
-				return EIO;
-			rc = futil_rcopy_contents(srcp, destp);
-			if (rc != EOK)
-				return EIO;
-		} else {
-			return EIO;
-		}
-
-		de = readdir(dir);
-	}
+	rc = fcopy_tree(&cfg, srcdir, destdir);
+	if (rc != EOK && rc != ENOMEM)
+		return EIO;
 
-	return EOK;
+	return rc;
 }
 
 /** Return file contents as a heap-allocated block of bytes.
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup taskdump
+ * @{
+ */
+/** @file Dump the heap profile of the debugged task.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <heap_profile.h>
+#include <heapdump.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <symtab.h>
+#include <udebug.h>
+
+static_assert(sizeof(size_t) == sizeof(sysarg_t), "");
+
+static errno_t read_size(symtab_t *symtab, async_sess_t *sess,
+    const char *name, size_t *value)
+{
+	uintptr_t addr;
+	errno_t rc;
+
+	rc = symtab_name_to_addr(symtab, name, &addr);
+	if (rc != EOK)
+		return rc;
+
+	return udebug_mem_read(sess, value, addr, sizeof(size_t));
+}
+
+static int site_cmp(const void *a, const void *b)
+{
+	const heap_profile_site_t *sa = a;
+	const heap_profile_site_t *sb = b;
+
+	if (sa->live != sb->live)
+		return (sa->live < sb->live) ? 1 : -1;
+
+	if (sa->total != sb->total)
+		return (sa->total < sb->total) ? 1 : -1;
+
+	return 0;
+}
+
+/** Set the heap profiler sampling interval of the debugged task.
+ *
+ * @param symtab Symbol table of the debugged task.
+ * @param sess Debugging session.
+ * @param interval Sampling interval in bytes, zero stops the profiler.
+ * @return EOK on success or an error code.
+ */
+errno_t heap_profile_set(symtab_t *symtab, async_sess_t *sess,
+    size_t interval)
+{
+	uintptr_t addr;
+	errno_t rc;
+
+	if (symtab == NULL)
+		return EIO;
+
+	rc = symtab_name_to_addr(symtab, "heap_profile_interval", &addr);
+	if (rc != EOK)
+		return EIO;
+
+	/*
+	 * The countdown to the next sample is left alone, the first
+	 * allocation after switching on just gets sampled early.
+	 */
+	return udebug_word_write(sess, addr, (sysarg_t) interval);
+}
+
+/** Dump the heap profile of the debugged task.
+ *
+ * Call sites are listed from the one holding most live bytes.
+ *
+ * @param symtab Symbol table of the debugged task.
+ * @param sess Debugging session.
+ * @return EOK on success or an error code.
+ */
+errno_t heap_profile_remote_dump(symtab_t *symtab, async_sess_t *sess)
+{
+	size_t interval, in_use, peak;
+	uintptr_t sites_addr;
+	errno_t rc;
+
+	if (symtab == NULL)
+		return EIO;
+
+	if (read_size(symtab, sess, "heap_profile_interval", &interval) != EOK ||
+	    read_size(symtab, sess, "heap_in_use_bytes", &in_use) != EOK ||
+	    read_size(symtab, sess, "heap_peak_bytes", &peak) != EOK)
+		return EIO;
+
+	rc = symtab_name_to_addr(symtab, "heap_profile_sites", &sites_addr);
+	if (rc != EOK)
+		return EIO;
+
+	heap_profile_site_t *sites = calloc(HEAP_PROFILE_SITES,
+	    sizeof(heap_profile_site_t));
+	if (sites == NULL)
+		return ENOMEM;
+
+	rc = udebug_mem_read(sess, sites, sites_addr,
+	    HEAP_PROFILE_SITES * sizeof(heap_profile_site_t));
+	if (rc != EOK) {
+		free(sites);
+		return EIO;
+	}
+
+	qsort(sites, HEAP_PROFILE_SITES, sizeof(heap_profile_site_t),
+	    site_cmp);
+
+	printf("Heap profile (interval %zu B, in use %zu B, peak %zu B):\n",
+	    interval, in_use, peak);
+
+	for (size_t i = 0; i < HEAP_PROFILE_SITES; i++) {
+		if (sites[i].samples == 0)
+			continue;
+
+		printf("%zu B live, %zu B total, %zu samples\n",
+		    sites[i].live, sites[i].total, sites[i].samples);
+
+		for (size_t j = 0; j < HEAP_PROFILE_DEPTH; j++) {
+			uintptr_t ra = sites[i].trace[j];
+			char *name;
+			size_t offs;
+
+			if (ra == 0)
+				break;
+
+			if (symtab_addr_to_name(symtab, ra, &name, &offs) == EOK)
+				printf("\t%p (%s+%zu)\n", (void *) ra, name, offs);
+			else
+				printf("\t%p\n", (void *) ra);
+		}
+	}
+
+	free(sites);
+	return EOK;
+}
+
+/** @}
+ */
@@ -35,6 +35,7 @@
 #include <async.h>
 #include <elf/elf_linux.h>
 #include <fibrildump.h>
+#include <heapdump.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -61,6 +62,9 @@ static async_sess_t *sess;
 static task_id_t task_id;
 static bool write_core_file;
 static char *core_file_name;
+static bool heap_profile_dump;
+static bool heap_profile_change;
+static size_t heap_profile_interval;
 static char *app_name;
 static symtab_t *app_symtab;
 
@@ -117,6 +121,19 @@ int main(int argc, char *argv[])
 	if (rc != EOK)
 		printf("Failed dumping fibrils.\n");
 
+	if (heap_profile_dump) {
+		putchar('\n');
+		rc = heap_profile_remote_dump(app_symtab, sess);
+		if (rc != EOK)
+			printf("Failed dumping heap profile.\n");
+	}
+
+	if (heap_profile_change) {
+		rc = heap_profile_set(app_symtab, sess, heap_profile_interval);
+		if (rc != EOK)
+			printf("Failed setting heap profile interval.\n");
+	}
+
 	udebug_end(sess);
 	async_hangup(sess);
 
@@ -181,6 +198,19 @@ static int parse_args(int argc, char *argv[])
 				--argc;
 				++argv;
 				core_file_name = *argv;
+			} else if (arg[1] == 'H' && arg[2] == '\0') {
+				heap_profile_dump = true;
+			} else if (arg[1] == 'P' && arg[2] == '\0') {
+				/* Heap profile sampling interval */
+				--argc;
+				++argv;
+				heap_profile_interval = strtoul(*argv, &err_p, 10);
+				if (*err_p) {
+					printf("Interval syntax error\n");
+					print_syntax();
+					return -1;
+				}
+				heap_profile_change = true;
 			} else {
 				printf("Uknown option '%c'\n", arg[0]);
 				print_syntax();
@@ -211,8 +241,11 @@ static int parse_args(int argc, char *argv[])
 
 static void print_syntax(void)
 {
-	printf("Syntax: taskdump [-c <core_file>] -t <task_id>\n");
+	printf("Syntax: taskdump [-c <core_file>] [-H] [-P <bytes>] -t <task_id>\n");
 	printf("\t-c <core_file_id>\tName of core file to write.\n");
+	printf("\t-H\tDump the heap profile.\n");
+	printf("\t-P <bytes>\tSet the heap profile sampling interval "
+	    "(0 stops profiling).\n");
 	printf("\t-t <task_id>\tWhich task to dump.\n");
 }
 
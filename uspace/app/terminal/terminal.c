@@ -48,6 +48,7 @@
 #include <io/concaps.h>
 #include <io/console.h>
 #include <io/pixelmap.h>
+#include <mem.h>
 #include <task.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -67,6 +68,9 @@
 
 #define APP_GETTERM  "/app/getterm"
 
+/** Minimum time between updates of the terminal bitmap (usec) */
+#define TERM_UPDATE_DELAY  16000
+
 #define TERM_CAPS \
 	(CONSOLE_CAP_STYLE | CONSOLE_CAP_INDEXED | CONSOLE_CAP_RGB)
 
@@ -202,6 +206,7 @@ static void term_update_region(terminal_t *term, sysarg_t x, sysarg_t y,
     sysarg_t w, sysarg_t h)
 {
 	gfx_rect_t rect;
+	gfx_rect_t bounds;
 	gfx_rect_t nupdate;
 
 	rect.p0.x = x;
@@ -209,8 +214,29 @@ static void term_update_region(terminal_t *term, sysarg_t x, sysarg_t y,
 	rect.p1.x = x + w;
 	rect.p1.y = y + h;
 
-	gfx_rect_envelope(&term->update, &rect, &nupdate);
-	term->update = nupdate;
+	if (gfx_region_union_rect(&term->update, &rect) != EOK) {
+		/* Out of memory, fall back to a single rectangle */
+		gfx_region_get_bounds(&term->update, &bounds);
+		gfx_rect_envelope(&bounds, &rect, &nupdate);
+		(void) gfx_region_set_rect(&term->update, &nupdate);
+	}
+}
+
+/** Mark character cells as damaged.
+ *
+ * @param term Terminal
+ * @param sx Screen X coordinate of the character grid
+ * @param sy Screen Y coordinate of the character grid
+ * @param c0 First column
+ * @param c1 Column after the last column
+ * @param row Row
+ */
+static void term_update_cells(terminal_t *term, sysarg_t sx, sysarg_t sy,
+    sysarg_t c0, sysarg_t c1, sysarg_t row)
+{
+	term_update_region(term, sx + c0 * FONT_WIDTH,
+	    sy + row * FONT_SCANLINES, (c1 - c0) * FONT_WIDTH,
+	    FONT_SCANLINES);
 }
 
 static void term_update_char(terminal_t *term, pixelmap_t *pixelmap,
@@ -247,46 +273,110 @@ static void term_update_char(terminal_t *term, pixelmap_t *pixelmap,
 			*dst++ = (fb_font[glyph][y] & (1 << count)) ? fgcolor : bgcolor;
 		}
 	}
-	term_update_region(term, bx, by, FONT_WIDTH, FONT_SCANLINES);
 }
 
-static bool term_update_scroll(terminal_t *term, pixelmap_t *pixelmap,
-    sysarg_t sx, sysarg_t sy)
+/** Redraw changed characters in one row.
+ *
+ * Each span of adjacent changed characters is recorded as a single
+ * damaged rectangle.
+ *
+ * @param term Terminal
+ * @param pixelmap Pixel map of the terminal bitmap
+ * @param sx Screen X coordinate of the character grid
+ * @param sy Screen Y coordinate of the character grid
+ * @param row Row
+ * @return @c true if anything has been redrawn
+ */
+static bool term_update_row(terminal_t *term, pixelmap_t *pixelmap,
+    sysarg_t sx, sysarg_t sy, sysarg_t row)
 {
-	sysarg_t top_row = chargrid_get_top_row(term->frontbuf);
-
-	if (term->top_row == top_row) {
-		return false;
-	}
-
-	term->top_row = top_row;
+	bool update = false;
+	sysarg_t c0 = 0;
+	bool span = false;
 
-	for (sysarg_t row = 0; row < term->rows; row++) {
-		for (sysarg_t col = 0; col < term->cols; col++) {
-			charfield_t *front_field =
-			    chargrid_charfield_at(term->frontbuf, col, row);
-			charfield_t *back_field =
-			    chargrid_charfield_at(term->backbuf, col, row);
-			bool update = false;
+	for (sysarg_t col = 0; col < term->cols; col++) {
+		charfield_t *front_field =
+		    chargrid_charfield_at(term->frontbuf, col, row);
+		charfield_t *back_field =
+		    chargrid_charfield_at(term->backbuf, col, row);
+		bool cupdate = false;
 
+		if ((front_field->flags & CHAR_FLAG_DIRTY) == CHAR_FLAG_DIRTY) {
 			if (front_field->ch != back_field->ch) {
 				back_field->ch = front_field->ch;
-				update = true;
+				cupdate = true;
 			}
 
 			if (!attrs_same(front_field->attrs, back_field->attrs)) {
 				back_field->attrs = front_field->attrs;
-				update = true;
+				cupdate = true;
 			}
 
 			front_field->flags &= ~CHAR_FLAG_DIRTY;
+		}
 
-			if (update) {
-				term_update_char(term, pixelmap, sx, sy, col, row);
+		if (cupdate) {
+			term_update_char(term, pixelmap, sx, sy, col, row);
+			if (!span) {
+				c0 = col;
+				span = true;
 			}
+			update = true;
+		} else if (span) {
+			term_update_cells(term, sx, sy, c0, col, row);
+			span = false;
 		}
 	}
 
+	if (span)
+		term_update_cells(term, sx, sy, c0, term->cols, row);
+
+	return update;
+}
+
+/** Follow scrolling of the front buffer.
+ *
+ * Instead of redrawing the whole grid, the existing picture is moved
+ * up in the bitmap along with the contents of the back buffer. Only
+ * rows which are new or have changed since are redrawn afterwards.
+ *
+ * @return @c true if the grid has scrolled
+ */
+static bool term_update_scroll(terminal_t *term, pixelmap_t *pixelmap,
+    sysarg_t sx, sysarg_t sy)
+{
+	sysarg_t top_row = chargrid_get_top_row(term->frontbuf);
+	sysarg_t back_col;
+	sysarg_t back_row;
+	sysarg_t shift;
+	size_t line;
+
+	if (term->top_row == top_row) {
+		return false;
+	}
+
+	shift = (top_row + term->rows - term->top_row) % term->rows;
+	term->top_row = top_row;
+
+	/* Do not move the cursor along with the picture */
+	if (chargrid_get_cursor_visibility(term->backbuf)) {
+		chargrid_set_cursor_visibility(term->backbuf, false);
+		chargrid_get_cursor(term->backbuf, &back_col, &back_row);
+		term_update_char(term, pixelmap, sx, sy, back_col, back_row);
+	}
+
+	/* Move picture up */
+	line = pixelmap->width * FONT_SCANLINES;
+	memmove(pixelmap_pixel_at(pixelmap, 0, sy),
+	    pixelmap_pixel_at(pixelmap, 0, sy + shift * FONT_SCANLINES),
+	    (term->rows - shift) * line * sizeof(pixel_t));
+
+	/* Move back buffer contents up, the same way the front buffer did */
+	term->backbuf->top_row = (term->backbuf->top_row + shift) %
+	    term->rows;
+
+	term_update_region(term, sx, sy, term->cols * FONT_WIDTH,
+	    term->rows * FONT_SCANLINES);
 	return true;
 }
 
@@ -313,13 +403,19 @@ static bool term_update_cursor(terminal_t *term, pixelmap_t *pixelmap,
 		chargrid_set_cursor_visibility(term->backbuf,
 		    front_visibility);
 		term_update_char(term, pixelmap, sx, sy, back_col, back_row);
+		term_update_cells(term, sx, sy, back_col, back_col + 1,
+		    back_row);
 		update = true;
 	}
 
 	if ((front_col != back_col) || (front_row != back_row)) {
 		chargrid_set_cursor(term->backbuf, front_col, front_row);
 		term_update_char(term, pixelmap, sx, sy, back_col, back_row);
+		term_update_cells(term, sx, sy, back_col, back_col + 1,
+		    back_row);
 		term_update_char(term, pixelmap, sx, sy, front_col, front_row);
+		term_update_cells(term, sx, sy, front_col, front_col + 1,
+		    front_row);
 		update = true;
 	}
 
@@ -331,6 +427,8 @@ static void term_update(terminal_t *term)
 	pixelmap_t pixelmap;
 	gfx_bitmap_alloc_t alloc;
 	gfx_coord2_t pos;
+	gfx_rect_t *rect;
+	sysarg_t r0, r1;
 	errno_t rc;
 
 	rc = gfx_bitmap_get_alloc(term->bmp, &alloc);
@@ -347,39 +445,17 @@ static void term_update(terminal_t *term)
 	sysarg_t sx = 0;
 	sysarg_t sy = 0;
 
-	if (term_update_scroll(term, &pixelmap, sx, sy)) {
+	if (term_update_scroll(term, &pixelmap, sx, sy))
 		update = true;
-	} else {
-		for (sysarg_t y = 0; y < term->rows; y++) {
-			for (sysarg_t x = 0; x < term->cols; x++) {
-				charfield_t *front_field =
-				    chargrid_charfield_at(term->frontbuf, x, y);
-				charfield_t *back_field =
-				    chargrid_charfield_at(term->backbuf, x, y);
-				bool cupdate = false;
-
-				if ((front_field->flags & CHAR_FLAG_DIRTY) ==
-				    CHAR_FLAG_DIRTY) {
-					if (front_field->ch != back_field->ch) {
-						back_field->ch = front_field->ch;
-						cupdate = true;
-					}
-
-					if (!attrs_same(front_field->attrs,
-					    back_field->attrs)) {
-						back_field->attrs = front_field->attrs;
-						cupdate = true;
-					}
-
-					front_field->flags &= ~CHAR_FLAG_DIRTY;
-				}
-
-				if (cupdate) {
-					term_update_char(term, &pixelmap, sx, sy, x, y);
-					update = true;
-				}
-			}
+
+	/* Only rows written to since the last update can differ */
+	if (chargrid_get_dirty(term->frontbuf, &r0, &r1)) {
+		for (sysarg_t y = r0; y < r1; y++) {
+			if (term_update_row(term, &pixelmap, sx, sy, y))
+				update = true;
 		}
+
+		chargrid_clear_dirty(term->frontbuf);
 	}
 
 	if (term_update_cursor(term, &pixelmap, sx, sy))
@@ -388,12 +464,50 @@ static void term_update(terminal_t *term)
 	if (update) {
 		pos.x = 4;
 		pos.y = 26;
-		(void) gfx_bitmap_render(term->bmp, &term->update, &pos);
 
-		term->update.p0.x = 0;
-		term->update.p0.y = 0;
-		term->update.p1.x = 0;
-		term->update.p1.y = 0;
+		rect = gfx_region_first(&term->update);
+		while (rect != NULL) {
+			(void) gfx_bitmap_render(term->bmp, rect, &pos);
+			rect = gfx_region_next(&term->update, rect);
+		}
+
+		gfx_region_clear(&term->update);
+	}
+
+	fibril_mutex_unlock(&term->mtx);
+}
+
+/** Update timer handler.
+ *
+ * @param arg Terminal
+ */
+static void term_update_timer(void *arg)
+{
+	terminal_t *term = (terminal_t *) arg;
+
+	fibril_mutex_lock(&term->mtx);
+	term->update_pending = false;
+	fibril_mutex_unlock(&term->mtx);
+
+	term_update(term);
+	gfx_update(term->gc);
+}
+
+/** Schedule terminal update.
+ *
+ * Output arriving in quick succession is merged and drawn at most
+ * once per TERM_UPDATE_DELAY.
+ *
+ * @param term Terminal
+ */
+static void term_update_later(terminal_t *term)
+{
+	fibril_mutex_lock(&term->mtx);
+
+	if (!term->update_pending) {
+		fibril_timer_set_locked(term->update_timer, TERM_UPDATE_DELAY,
+		    term_update_timer, term);
+		term->update_pending = true;
 	}
 
 	fibril_mutex_unlock(&term->mtx);
@@ -420,23 +534,27 @@ static void term_repaint(terminal_t *term)
 	sysarg_t sx = 0;
 	sysarg_t sy = 0;
 
-	if (!term_update_scroll(term, &pixelmap, sx, sy)) {
-		for (sysarg_t y = 0; y < term->rows; y++) {
-			for (sysarg_t x = 0; x < term->cols; x++) {
-				charfield_t *front_field =
-				    chargrid_charfield_at(term->frontbuf, x, y);
-				charfield_t *back_field =
-				    chargrid_charfield_at(term->backbuf, x, y);
+	term->top_row = chargrid_get_top_row(term->frontbuf);
 
-				back_field->ch = front_field->ch;
-				back_field->attrs = front_field->attrs;
-				front_field->flags &= ~CHAR_FLAG_DIRTY;
+	for (sysarg_t y = 0; y < term->rows; y++) {
+		for (sysarg_t x = 0; x < term->cols; x++) {
+			charfield_t *front_field =
+			    chargrid_charfield_at(term->frontbuf, x, y);
+			charfield_t *back_field =
+			    chargrid_charfield_at(term->backbuf, x, y);
 
-				term_update_char(term, &pixelmap, sx, sy, x, y);
-			}
+			back_field->ch = front_field->ch;
+			back_field->attrs = front_field->attrs;
+			front_field->flags &= ~CHAR_FLAG_DIRTY;
+
+			term_update_char(term, &pixelmap, sx, sy, x, y);
 		}
 	}
 
+	chargrid_clear_dirty(term->frontbuf);
+	term_update_region(term, sx, sy, term->cols * FONT_WIDTH,
+	    term->rows * FONT_SCANLINES);
+
 	term_update_cursor(term, &pixelmap, sx, sy);
 
 	fibril_mutex_unlock(&term->mtx);
@@ -503,30 +621,25 @@ static errno_t term_read(con_srv_t *srv, void *buf, size_t size, size_t *nread)
 
 static void term_write_char(terminal_t *term, wchar_t ch)
 {
-	sysarg_t updated = 0;
-
 	fibril_mutex_lock(&term->mtx);
 
 	switch (ch) {
 	case '\n':
-		updated = chargrid_newline(term->frontbuf);
+		(void) chargrid_newline(term->frontbuf);
 		break;
 	case '\r':
 		break;
 	case '\t':
-		updated = chargrid_tabstop(term->frontbuf, 8);
+		(void) chargrid_tabstop(term->frontbuf, 8);
 		break;
 	case '\b':
-		updated = chargrid_backspace(term->frontbuf);
+		(void) chargrid_backspace(term->frontbuf);
 		break;
 	default:
-		updated = chargrid_putuchar(term->frontbuf, ch, true);
+		(void) chargrid_putuchar(term->frontbuf, ch, true);
 	}
 
 	fibril_mutex_unlock(&term->mtx);
-
-	if (updated > 1)
-		term_update(term);
 }
 
 static errno_t term_write(con_srv_t *srv, void *data, size_t size, size_t *nwritten)
@@ -537,7 +650,7 @@ static errno_t term_write(con_srv_t *srv, void *data, size_t size, size_t *nwrit
 	while (off < size)
 		term_write_char(term, str_decode(data, &off, size));
 
-	gfx_update(term->gc);
+	term_update_later(term);
 	*nwritten = size;
 	return EOK;
 }
@@ -785,6 +898,8 @@ static void term_buf_update(con_srv_t *srv, sysarg_t c0, sysarg_t r0,
 		}
 	}
 
+	chargrid_set_dirty(term->frontbuf, r0, r1);
+
 	fibril_mutex_unlock(&term->mtx);
 
 	/* Update terminal */
@@ -796,6 +911,13 @@ static void deinit_terminal(terminal_t *term)
 {
 	list_remove(&term->link);
 
+	if (term->update_timer != NULL) {
+		fibril_timer_clear(term->update_timer);
+		fibril_timer_destroy(term->update_timer);
+	}
+
+	gfx_region_fini(&term->update);
+
 	if (term->frontbuf)
 		chargrid_destroy(term->frontbuf);
 
@@ -929,6 +1051,14 @@ errno_t terminal_create(const char *display_spec, sysarg_t width,
 	link_initialize(&term->link);
 	fibril_mutex_initialize(&term->mtx);
 	atomic_flag_clear(&term->refcnt);
+	gfx_region_init(&term->update);
+
+	term->update_timer = fibril_timer_create(&term->mtx);
+	if (term->update_timer == NULL) {
+		printf("Out of memory.\n");
+		free(term);
+		return ENOMEM;
+	}
 
 	prodcons_initialize(&term->input_pc);
 	term->char_remains_len = 0;
@@ -1047,11 +1177,6 @@ errno_t terminal_create(const char *display_spec, sysarg_t width,
 
 	term->is_focused = true;
 
-	term->update.p0.x = 0;
-	term->update.p0.y = 0;
-	term->update.p1.x = 0;
-	term->update.p1.y = 0;
-
 	term_repaint(term);
 
 	*rterm = term;
@@ -1065,6 +1190,8 @@ error:
 		chargrid_destroy(term->frontbuf);
 	if (term->backbuf != NULL)
 		chargrid_destroy(term->backbuf);
+	fibril_timer_destroy(term->update_timer);
+	gfx_region_fini(&term->update);
 	free(term);
 	return rc;
 }
@@ -44,6 +44,7 @@
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
 #include <gfx/coord.h>
+#include <gfx/region.h>
 #include <io/chargrid.h>
 #include <io/con_srv.h>
 #include <loc.h>
@@ -68,7 +69,12 @@ typedef struct {
 	gfx_bitmap_t *bmp;
 	sysarg_t w;
 	sysarg_t h;
-	gfx_rect_t update;
+	/** Damaged part of the bitmap, not yet rendered */
+	gfx_region_t update;
+	/** Timer for merging bursts of output into one update */
+	fibril_timer_t *update_timer;
+	/** Update timer is armed */
+	bool update_pending;
 	gfx_coord2_t off;
 	bool is_focused;
 
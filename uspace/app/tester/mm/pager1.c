@@ -75,7 +75,8 @@ static void *create_paged_area(size_t size)
 	TPRINTF("Creating AS area...\n");
 
 	void *result = async_as_area_create(AS_AREA_ANY, size,
-	    AS_AREA_READ | AS_AREA_CACHEABLE, vfs_pager_sess, fd, 0, 0);
+	    AS_AREA_READ | AS_AREA_CACHEABLE, vfs_pager_sess, fd,
+	    VFS_PAGER_SHARED, 0);
 	if (result == AS_MAP_FAILED) {
 		vfs_put(fd);
 		return NULL;
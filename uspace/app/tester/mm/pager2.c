@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <vfs/vfs.h>
+#include <as.h>
+#include <ns.h>
+#include <async.h>
+#include <errno.h>
+#include <mem.h>
+#include <str_error.h>
+#include "../tester.h"
+
+#define TEST_FILE	"/tmp/pagertest2"
+#define TEST_PAGES	2
+
+static char page_buf[PAGE_SIZE];
+
+/** Read one byte of the test file through VFS. */
+static errno_t read_byte(int file, aoff64_t pos, char *ch)
+{
+	size_t nread;
+	errno_t rc = vfs_read(file, &pos, ch, 1, &nread);
+	if (rc == EOK && nread != 1)
+		rc = EIO;
+	return rc;
+}
+
+static const char *test_mapping(int file, volatile char *area)
+{
+	char ch;
+
+	TPRINTF("Reading through the mapping...\n");
+	if (area[0] != 'a' || area[PAGE_SIZE] != 'a')
+		return "Mapping does not show the file contents";
+
+	TPRINTF("Writing through the mapping...\n");
+	area[0] = 'b';
+	area[PAGE_SIZE + 1] = 'c';
+
+	if (read_byte(file, 0, &ch) != EOK || ch != 'b')
+		return "Write through the mapping not visible to vfs_read()";
+
+	TPRINTF("Writing back...\n");
+	errno_t rc = as_area_sync((void *) area, TEST_PAGES * PAGE_SIZE);
+	if (rc != EOK) {
+		TPRINTF("rc=%s\n", str_error_name(rc));
+		return "as_area_sync() failed";
+	}
+
+	TPRINTF("Writing through VFS...\n");
+	ch = 'x';
+	size_t nwr;
+	rc = vfs_write(file, (aoff64_t []) { 10 }, &ch, 1, &nwr);
+	if (rc != EOK)
+		return "vfs_write() failed";
+
+	if (area[10] != 'x')
+		return "vfs_write() not visible through the mapping";
+
+	if (area[0] != 'b')
+		return "Mapping lost an earlier write";
+
+	return NULL;
+}
+
+const char *test_pager2(void)
+{
+	const char *err;
+	errno_t rc;
+	int file;
+	char ch;
+
+	TPRINTF("Creating temporary file...\n");
+
+	rc = vfs_lookup_open(TEST_FILE, WALK_REGULAR | WALK_MAY_CREATE,
+	    MODE_READ | MODE_WRITE, &file);
+	if (rc != EOK)
+		return "vfs_lookup_open() failed";
+
+	memset(page_buf, 'a', PAGE_SIZE);
+	for (size_t i = 0; i < TEST_PAGES; i++) {
+		size_t nwr;
+		rc = vfs_write(file, (aoff64_t []) { i * PAGE_SIZE }, page_buf,
+		    PAGE_SIZE, &nwr);
+		if (rc != EOK) {
+			err = "vfs_write() failed";
+			goto out;
+		}
+	}
+
+	async_sess_t *pager_sess = service_connect_blocking(SERVICE_VFS,
+	    INTERFACE_PAGER, 0, NULL);
+	if (pager_sess == NULL) {
+		err = "Cannot connect to the VFS pager";
+		goto out;
+	}
+
+	TPRINTF("Creating writable shared AS area...\n");
+
+	void *area = async_as_area_create(AS_AREA_ANY, TEST_PAGES * PAGE_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, pager_sess, file,
+	    VFS_PAGER_WRITEBACK, 0);
+	if (area == AS_MAP_FAILED) {
+		async_hangup(pager_sess);
+		err = "async_as_area_create() failed";
+		goto out;
+	}
+
+	err = test_mapping(file, area);
+
+	as_area_destroy(area);
+	async_hangup(pager_sess);
+
+	if (err == NULL) {
+		TPRINTF("Checking the file after unmapping...\n");
+		if (read_byte(file, PAGE_SIZE + 1, &ch) != EOK || ch != 'c')
+			err = "Write through the mapping was lost";
+	}
+
+out:
+	vfs_put(file);
+	vfs_unlink_path(TEST_FILE);
+	return err;
+}
@@ -67,6 +67,7 @@ test_t tests[] = {
 #include "float/float1.def"
 #include "float/float2.def"
 #include "vfs/vfs1.def"
+#include "vfs/vfs2.def"
 #include "ipc/sharein.def"
 #include "ipc/starve.def"
 #include "loop/loop1.def"
@@ -75,6 +76,7 @@ test_t tests[] = {
 #include "mm/malloc3.def"
 #include "mm/mapping1.def"
 #include "mm/pager1.def"
+#include "mm/pager2.def"
 #include "hw/serial/serial1.def"
 #include "chardev/chardev1.def"
 	{ NULL, NULL, NULL, false }
@@ -97,6 +97,7 @@ extern const char *test_fault3(void);
 extern const char *test_float1(void);
 extern const char *test_float2(void);
 extern const char *test_vfs1(void);
+extern const char *test_vfs2(void);
 extern const char *test_ping_pong(void);
 extern const char *test_sharein(void);
 extern const char *test_starve_ipc(void);
@@ -106,6 +107,7 @@ extern const char *test_malloc2(void);
 extern const char *test_malloc3(void);
 extern const char *test_mapping1(void);
 extern const char *test_pager1(void);
+extern const char *test_pager2(void);
 extern const char *test_serial1(void);
 extern const char *test_devman1(void);
 extern const char *test_devman2(void);
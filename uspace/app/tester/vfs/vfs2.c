@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <str_error.h>
+#include <vfs/vfs.h>
+#include "../tester.h"
+
+#define TEST_FILE  "/tmp/aiotest"
+
+#define CHUNKS      8
+#define CHUNK_SIZE  512
+#define DEPTH       3
+
+static char wbuf[CHUNKS][CHUNK_SIZE];
+static char rbuf[CHUNKS][CHUNK_SIZE];
+
+/** Wait for all requests of a queue and check they transferred whole chunks */
+static const char *drain(vfs_aio_queue_t *queue, size_t count)
+{
+	vfs_aio_result_t res;
+	bool done[CHUNKS];
+	errno_t rc;
+
+	memset(done, 0, sizeof(done));
+
+	for (size_t i = 0; i < count; i++) {
+		rc = vfs_aio_wait(queue, &res);
+		if (rc != EOK) {
+			TPRINTF("rc=%s\n", str_error_name(rc));
+			return "vfs_aio_wait() failed";
+		}
+
+		size_t chunk = (size_t) res.arg;
+		if (chunk >= CHUNKS || done[chunk])
+			return "Unexpected completion argument";
+		done[chunk] = true;
+
+		if (res.rc != EOK) {
+			TPRINTF("chunk %zu: rc=%s\n", chunk, str_error_name(res.rc));
+			return "Request failed";
+		}
+
+		if (res.nbytes != CHUNK_SIZE) {
+			TPRINTF("chunk %zu: %zu bytes\n", chunk, res.nbytes);
+			return "Short transfer";
+		}
+	}
+
+	if (vfs_aio_wait(queue, &res) != ENOENT)
+		return "vfs_aio_wait() did not report an empty queue";
+
+	return NULL;
+}
+
+const char *test_vfs2(void)
+{
+	vfs_aio_queue_t *queue;
+	vfs_aio_t *first;
+	vfs_aio_t *second;
+	const char *err;
+	errno_t rc;
+	int fd;
+
+	rc = vfs_lookup_open(TEST_FILE, WALK_REGULAR | WALK_MAY_CREATE,
+	    MODE_READ | MODE_WRITE, &fd);
+	if (rc != EOK)
+		return "vfs_lookup_open() failed";
+
+	rc = vfs_aio_queue_create(DEPTH, &queue);
+	if (rc != EOK) {
+		vfs_put(fd);
+		return "vfs_aio_queue_create() failed";
+	}
+
+	for (size_t i = 0; i < CHUNKS; i++)
+		memset(wbuf[i], 'a' + i, CHUNK_SIZE);
+
+	TPRINTF("Writing %d chunks...\n", CHUNKS);
+	for (size_t i = 0; i < CHUNKS; i++) {
+		rc = vfs_write_async(queue, fd, i * CHUNK_SIZE, wbuf[i],
+		    CHUNK_SIZE, (void *) i, NULL);
+		if (rc != EOK) {
+			err = "vfs_write_async() failed";
+			goto out;
+		}
+	}
+
+	err = drain(queue, CHUNKS);
+	if (err != NULL)
+		goto out;
+
+	TPRINTF("Reading %d chunks...\n", CHUNKS);
+	for (size_t i = CHUNKS; i > 0; i--) {
+		rc = vfs_read_async(queue, fd, (i - 1) * CHUNK_SIZE,
+		    rbuf[i - 1], CHUNK_SIZE, (void *) (i - 1), NULL);
+		if (rc != EOK) {
+			err = "vfs_read_async() failed";
+			goto out;
+		}
+	}
+
+	err = drain(queue, CHUNKS);
+	if (err != NULL)
+		goto out;
+
+	if (memcmp(wbuf, rbuf, sizeof(wbuf)) != 0) {
+		err = "Data read back differs";
+		goto out;
+	}
+
+	TPRINTF("Cancelling...\n");
+	vfs_aio_queue_destroy(queue);
+	queue = NULL;
+
+	rc = vfs_aio_queue_create(1, &queue);
+	if (rc != EOK) {
+		err = "vfs_aio_queue_create() failed";
+		goto out;
+	}
+
+	rc = vfs_read_async(queue, fd, 0, rbuf[0], CHUNK_SIZE, (void *) 0,
+	    &first);
+	if (rc == EOK) {
+		rc = vfs_read_async(queue, fd, CHUNK_SIZE, rbuf[1], CHUNK_SIZE,
+		    (void *) 1, &second);
+	}
+	if (rc != EOK) {
+		err = "vfs_read_async() failed";
+		goto out;
+	}
+
+	if (vfs_aio_cancel(queue, second) != EOK) {
+		err = "Cancelling a queued request failed";
+		goto out;
+	}
+
+	if (vfs_aio_cancel(queue, first) != EBUSY) {
+		err = "Cancelling a request in flight did not fail";
+		goto out;
+	}
+
+	err = drain(queue, 1);
+
+out:
+	if (queue != NULL)
+		vfs_aio_queue_destroy(queue);
+	vfs_put(fd);
+	vfs_unlink_path(TEST_FILE);
+	return err;
+}
@@ -27,14 +27,44 @@
  */
 
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <mem.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str_error.h>
 #include <task.h>
+#include <time.h>
 #include <vfs/vfs.h>
 #include <dirent.h>
 #include <str.h>
 
+/** A pcut test binary run by run_pcut_tests(). */
+typedef struct {
+	/** File name of the binary in /test */
+	char *name;
+	/** Path to the binary */
+	char *bin;
+	/** Path to the log file */
+	char *logfile;
+	/** Result of run_test() */
+	errno_t rc;
+	task_exit_t ex;
+	int retval;
+	/** Wall-clock duration in milliseconds */
+	nsec_t msec;
+	/** The run has completed */
+	bool done;
+} pcut_run_t;
+
+/** Synchronizes pcut_run_t.done and pcut_running */
+static FIBRIL_MUTEX_INITIALIZE(pcut_lock);
+/** Signalled whenever a test binary completes */
+static FIBRIL_CONDVAR_INITIALIZE(pcut_cv);
+/** Number of test binaries currently running */
+static size_t pcut_running;
+
 static errno_t run_test(const char *logfile, const char *logmode,
     const char *path, const char *const args[], task_exit_t *ex, int *retval)
 {
@@ -165,8 +195,50 @@ static void run_tester_fault(const char *logfile)
 	printf("`tester fault1`: terminated as expected\n");
 }
 
-static void run_pcut_tests(void)
+/** Run one pcut test binary.
+ *
+ * @param arg Test binary run (pcut_run_t *)
+ * @return EOK
+ */
+static errno_t pcut_run_fibril(void *arg)
 {
+	pcut_run_t *run = (pcut_run_t *) arg;
+	struct timespec start, end;
+
+	const char *const args[] = { run->bin, NULL };
+
+	getuptime(&start);
+	run->rc = run_test(run->logfile, "w", run->bin, args, &run->ex,
+	    &run->retval);
+	getuptime(&end);
+
+	fibril_mutex_lock(&pcut_lock);
+	run->msec = NSEC2MSEC(ts_sub_diff(&end, &start));
+	run->done = true;
+	--pcut_running;
+	fibril_condvar_broadcast(&pcut_cv);
+	fibril_mutex_unlock(&pcut_lock);
+
+	return EOK;
+}
+
+/** Run all pcut test binaries found in /test.
+ *
+ * Up to @a jobs binaries run at the same time. Results are printed
+ * in directory order.
+ *
+ * @param jobs Maximum number of binaries to run concurrently
+ */
+static void run_pcut_tests(size_t jobs)
+{
+	pcut_run_t *runs = NULL;
+	pcut_run_t *nruns;
+	size_t nruns_alloc = 0;
+	size_t count = 0;
+	size_t started;
+	size_t i;
+	bool stop;
+
 	printf("Running all pcut tests...\n");
 
 	DIR *d = opendir("/test");
@@ -179,44 +251,102 @@ static void run_pcut_tests(void)
 		if (str_lcmp(e->d_name, "test-", 5) != 0)
 			continue;
 
-		task_exit_t ex;
-		int retval;
+		if (count >= nruns_alloc) {
+			nruns_alloc = nruns_alloc > 0 ? 2 * nruns_alloc : 16;
+			nruns = realloc(runs, nruns_alloc * sizeof(pcut_run_t));
+			if (nruns == NULL) {
+				fprintf(stderr, "out of memory\n");
+				exit(EXIT_FAILURE);
+			}
+
+			runs = nruns;
+		}
+
+		pcut_run_t *run = &runs[count];
+		memset(run, 0, sizeof(pcut_run_t));
 
-		char *bin;
-		if (asprintf(&bin, "/test/%s", e->d_name) < 0) {
+		run->name = str_dup(e->d_name);
+		if (run->name == NULL) {
 			fprintf(stderr, "out of memory\n");
 			exit(EXIT_FAILURE);
 		}
 
-		char *logfile;
-		if (asprintf(&logfile, "/data/web/result-%s.txt", e->d_name) < 0) {
+		if (asprintf(&run->bin, "/test/%s", e->d_name) < 0) {
 			fprintf(stderr, "out of memory\n");
 			exit(EXIT_FAILURE);
 		}
 
-		const char *const args[] = { bin, NULL };
-		errno_t rc = run_test(logfile, "w", bin, args, &ex, &retval);
-		free(bin);
-		free(logfile);
+		if (asprintf(&run->logfile, "/data/web/result-%s.txt",
+		    e->d_name) < 0) {
+			fprintf(stderr, "out of memory\n");
+			exit(EXIT_FAILURE);
+		}
 
-		if (rc != EOK) {
+		++count;
+	}
+
+	closedir(d);
+
+	started = 0;
+	stop = false;
+
+	fibril_mutex_lock(&pcut_lock);
+
+	for (i = 0; i < count; i++) {
+		/* Keep up to @a jobs binaries running. */
+		while (!stop && started < count && pcut_running < jobs) {
+			pcut_run_t *run = &runs[started++];
+			++pcut_running;
+
+			fid_t fid = fibril_create(pcut_run_fibril, run);
+			if (fid == 0) {
+				fibril_mutex_unlock(&pcut_lock);
+				pcut_run_fibril(run);
+				fibril_mutex_lock(&pcut_lock);
+			} else {
+				fibril_add_ready(fid);
+			}
+		}
+
+		if (i >= started)
+			break;
+
+		while (!runs[i].done)
+			fibril_condvar_wait(&pcut_cv, &pcut_lock);
+
+		if (stop)
+			continue;
+
+		if (runs[i].rc != EOK) {
 			/* Reason already printed in run_test(). */
-			return;
+			stop = true;
+			continue;
 		}
 
-		if (ex != TASK_EXIT_NORMAL) {
-			fprintf(stderr, "%s CRASHED\n", e->d_name);
-			return;
+		if (runs[i].ex != TASK_EXIT_NORMAL) {
+			fprintf(stderr, "%s CRASHED\n", runs[i].name);
+			stop = true;
+			continue;
 		}
 
-		if (retval == 0) {
-			printf("%s ok\n", e->d_name);
+		if (runs[i].retval == 0) {
+			printf("%s ok (%lld ms)\n", runs[i].name,
+			    (long long) runs[i].msec);
 		} else {
-			printf("%s FAILED\n", e->d_name);
+			printf("%s FAILED (%lld ms)\n", runs[i].name,
+			    (long long) runs[i].msec);
 		}
 	}
 
-	closedir(d);
+	fibril_mutex_unlock(&pcut_lock);
+
+	for (i = 0; i < count; i++) {
+		free(runs[i].name);
+		free(runs[i].bin);
+		free(runs[i].logfile);
+	}
+
+	free(runs);
 }
 
 static void gen_index(const char *fname)
@@ -251,11 +381,36 @@ static void gen_index(const char *fname)
 	fclose(f);
 }
 
+static void print_syntax(void)
+{
+	printf("Syntax: testrunner [-j <jobs>]\n");
+	printf("\t-j <jobs>, --jobs <jobs>  Run up to <jobs> pcut test "
+	    "binaries at a time\n");
+}
+
 int main(int argc, char **argv)
 {
+	size_t jobs = 1;
+	char *end;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((str_cmp(argv[i], "-j") == 0 ||
+		    str_cmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+			jobs = strtoul(argv[++i], &end, 10);
+			if (*end != '\0' || jobs == 0) {
+				print_syntax();
+				return EXIT_FAILURE;
+			}
+		} else {
+			print_syntax();
+			return EXIT_FAILURE;
+		}
+	}
+
 	run_tester("/data/web/result-tester.txt");
 	run_tester_fault("/tmp/tester_fault.log");
-	run_pcut_tests();
+	run_pcut_tests(jobs);
 
 	const char *fname = "/data/web/test.html";
 	printf("Generating HTML report in %s\n", fname);
@@ -260,6 +260,14 @@ static inline void print_cpu_info(data_t *data)
 			print_percent(data->cpus_perc[i].idle, 2);
 			fputs(", busy: ", stdout);
 			print_percent(data->cpus_perc[i].busy, 2);
+
+			const uint64_t *hist =
+			    &data->cpus_latency_diff[i * STATS_LATENCY_BUCKETS];
+			uint64_t count = latency_count(hist);
+			if (count > 0) {
+				printf(", rq p99: %" PRIu64 " us",
+				    latency_percentile(hist, count, 99));
+			}
 		} else
 			printf("cpu%u inactive", data->cpus[i].id);
 
@@ -314,12 +322,21 @@ static inline void print_help(void)
 	printf(" i .. IPC statistics");
 	screen_newline();
 
+	printf(" b .. IPC request queue statistics");
+	screen_newline();
+
 	printf(" e .. exceptions statistics");
 	screen_newline();
 
 	printf("      a .. toggle display of all/hot exceptions");
 	screen_newline();
 
+	printf(" l .. run queue latency statistics");
+	screen_newline();
+
+	printf(" m .. slab cache statistics");
+	screen_newline();
+
 	printf(" h .. toggle this help screen");
 	screen_newline();
 
@@ -56,7 +56,10 @@
 typedef enum {
 	OP_TASKS,
 	OP_IPC,
+	OP_IPC_QUEUE,
 	OP_EXCS,
+	OP_LATENCY,
+	OP_SLABS,
 } op_mode_t;
 
 static const column_t task_columns[] = {
@@ -91,6 +94,8 @@ static const column_t ipc_columns[] = {
 	{ "ans snt", 'a', 9 },
 	{ "ans rcv", 'A', 9 },
 	{ "forward", 'f', 9 },
+	{ "copied",  'p', 9 },
+	{ "pinned",  'P', 9 },
 	{ "name",    'd', 0 },
 };
 
@@ -101,10 +106,37 @@ enum {
 	IPC_COL_ANS_SNT,
 	IPC_COL_ANS_RCV,
 	IPC_COL_FORWARD,
+	IPC_COL_COPIED,
+	IPC_COL_PINNED,
 	IPC_COL_NAME,
 	IPC_NUM_COLUMNS,
 };
 
+static const column_t ipc_queue_columns[] = {
+	{ "taskid",  't', 8 },
+	{ "cls rcv", 'C', 9 },
+	{ "ans snt", 'a', 9 },
+	{ "depth",   'q', 7 },
+	{ "peak",    'p', 7 },
+	{ "p50 us",  '5', 9 },
+	{ "p99 us",  '9', 9 },
+	{ "max us",  'm', 9 },
+	{ "name",    'd', 0 },
+};
+
+enum {
+	IPC_QUEUE_COL_TASKID = 0,
+	IPC_QUEUE_COL_CLS_RCV,
+	IPC_QUEUE_COL_ANS_SNT,
+	IPC_QUEUE_COL_DEPTH,
+	IPC_QUEUE_COL_PEAK,
+	IPC_QUEUE_COL_P50,
+	IPC_QUEUE_COL_P99,
+	IPC_QUEUE_COL_MAX,
+	IPC_QUEUE_COL_NAME,
+	IPC_QUEUE_NUM_COLUMNS,
+};
+
 static const column_t exception_columns[] = {
 	{ "exc",         'e',  8 },
 	{ "count",       'n', 10 },
@@ -124,13 +156,66 @@ enum {
 	EXCEPTION_NUM_COLUMNS,
 };
 
+static const column_t latency_columns[] = {
+	{ "taskid",  't',  8 },
+	{ "samples", 'n', 10 },
+	{ "p50 us",  '5',  9 },
+	{ "p99 us",  '9',  9 },
+	{ "max us",  'm',  9 },
+	{ "name",    'd',  0 },
+};
+
+enum {
+	LATENCY_COL_TASKID = 0,
+	LATENCY_COL_SAMPLES,
+	LATENCY_COL_P50,
+	LATENCY_COL_P99,
+	LATENCY_COL_MAX,
+	LATENCY_COL_NAME,
+	LATENCY_NUM_COLUMNS,
+};
+
+static const column_t slab_columns[] = {
+	{ "objsize", 'z',  8 },
+	{ "memory",  'm',  9 },
+	{ "objs",    'o',  8 },
+	{ "peak",    'p',  8 },
+	{ "alloc/s", 'a',  8 },
+	{ "free/s",  'f',  8 },
+	{ "%hit",    'H',  7 },
+	{ "grows",   'g',  8 },
+	{ "reclaim", 'c',  8 },
+	{ "name",    'd',  0 },
+};
+
+enum {
+	SLAB_COL_SIZE = 0,
+	SLAB_COL_MEMORY,
+	SLAB_COL_OBJS,
+	SLAB_COL_PEAK,
+	SLAB_COL_ALLOCS,
+	SLAB_COL_FREES,
+	SLAB_COL_PERCENT_HITS,
+	SLAB_COL_GROWS,
+	SLAB_COL_RECLAIMED,
+	SLAB_COL_NAME,
+	SLAB_NUM_COLUMNS,
+};
+
 screen_mode_t screen_mode = SCREEN_TABLE;
 static op_mode_t op_mode = OP_TASKS;
 static size_t sort_column = TASK_COL_PERCENT_USER;
 static int sort_reverse = -1;
 static bool excs_all = false;
 
-static const char *read_data(data_t *target)
+/** Read a new sample of the statistics
+ *
+ * @param target Data structure to fill.
+ * @param prev   Previous sample or NULL. Statistics of the tasks
+ *               and threads which did not change are taken from it.
+ *
+ */
+static const char *read_data(data_t *target, data_t *prev)
 {
 	/* Initialize data */
 	target->load = NULL;
@@ -141,11 +226,16 @@ static const char *read_data(data_t *target)
 	target->threads = NULL;
 	target->exceptions = NULL;
 	target->exceptions_perc = NULL;
+	target->slabs = NULL;
+	target->slabs_diff = NULL;
 	target->physmem = NULL;
 	target->ucycles_diff = NULL;
 	target->kcycles_diff = NULL;
 	target->ecycles_diff = NULL;
 	target->ecount_diff = NULL;
+	target->cpus_latency_diff = NULL;
+	target->tasks_latency_diff = NULL;
+	target->tasks_ipc_latency_diff = NULL;
 	target->table.name = NULL;
 	target->table.num_columns = 0;
 	target->table.columns = NULL;
@@ -185,7 +275,11 @@ static const char *read_data(data_t *target)
 		return "Not enough memory for CPU utilization";
 
 	/* Get tasks */
-	target->tasks = stats_get_tasks(&(target->tasks_count));
+	target->tasks_gen = (prev != NULL) ? prev->tasks_gen : 0;
+	target->tasks = stats_get_tasks_delta(
+	    (prev != NULL) ? prev->tasks : NULL,
+	    (prev != NULL) ? prev->tasks_count : 0,
+	    &(target->tasks_gen), &(target->tasks_count));
 	if (target->tasks == NULL)
 		return "Cannot get tasks";
 
@@ -195,7 +289,11 @@ static const char *read_data(data_t *target)
 		return "Not enough memory for task utilization";
 
 	/* Get threads */
-	target->threads = stats_get_threads(&(target->threads_count));
+	target->threads_gen = (prev != NULL) ? prev->threads_gen : 0;
+	target->threads = stats_get_threads_delta(
+	    (prev != NULL) ? prev->threads : NULL,
+	    (prev != NULL) ? prev->threads_count : 0,
+	    &(target->threads_gen), &(target->threads_count));
 	if (target->threads == NULL)
 		return "Cannot get threads";
 
@@ -235,15 +333,120 @@ static const char *read_data(data_t *target)
 	if (target->ecount_diff == NULL)
 		return "Not enough memory for exception count utilization";
 
+	/* Get slab caches */
+	target->slabs = stats_get_slabs(&(target->slabs_count));
+	if (target->slabs == NULL)
+		return "Cannot get slab caches";
+
+	target->slabs_diff = calloc(target->slabs_count, sizeof(diff_slab_t));
+	if (target->slabs_diff == NULL)
+		return "Not enough memory for slab cache rates";
+
+	target->cpus_latency_diff = calloc(target->cpus_count *
+	    STATS_LATENCY_BUCKETS, sizeof(uint64_t));
+	if (target->cpus_latency_diff == NULL)
+		return "Not enough memory for CPU run queue latency";
+
+	target->tasks_latency_diff = calloc(target->tasks_count *
+	    STATS_LATENCY_BUCKETS, sizeof(uint64_t));
+	if (target->tasks_latency_diff == NULL)
+		return "Not enough memory for task run queue latency";
+
+	target->tasks_ipc_latency_diff = calloc(target->tasks_count *
+	    STATS_LATENCY_BUCKETS, sizeof(uint64_t));
+	if (target->tasks_ipc_latency_diff == NULL)
+		return "Not enough memory for task IPC answer latency";
+
 	return NULL;
 }
 
+/** Get number of samples in a run queue latency histogram
+ *
+ * @param hist Histogram of STATS_LATENCY_BUCKETS buckets.
+ *
+ * @return Total number of samples.
+ *
+ */
+uint64_t latency_count(const uint64_t *hist)
+{
+	uint64_t count = 0;
+
+	for (size_t i = 0; i < STATS_LATENCY_BUCKETS; i++)
+		count += hist[i];
+
+	return count;
+}
+
+/** Get a percentile of a run queue latency histogram
+ *
+ * @param hist  Histogram of STATS_LATENCY_BUCKETS buckets.
+ * @param count Total number of samples in the histogram.
+ * @param pct   Percentile to compute.
+ *
+ * @return Upper bound of the bucket containing the percentile (us).
+ *
+ */
+uint64_t latency_percentile(const uint64_t *hist, uint64_t count,
+    unsigned int pct)
+{
+	uint64_t target = (count * pct + 99) / 100;
+	uint64_t sum = 0;
+	size_t i;
+
+	for (i = 0; i < STATS_LATENCY_BUCKETS - 1; i++) {
+		sum += hist[i];
+		if ((sum >= target) && (sum > 0))
+			break;
+	}
+
+	return ((uint64_t) 1) << i;
+}
+
+static void compute_latency_diff(const uint64_t *old_hist,
+    const uint64_t *new_hist, uint64_t *diff)
+{
+	for (size_t i = 0; i < STATS_LATENCY_BUCKETS; i++)
+		diff[i] = new_hist[i] - old_hist[i];
+}
+
 /** Computes percentage differencies from old_data to new_data
  *
  * @param old_data Pointer to old data strucutre.
  * @param new_data Pointer to actual data where percetages are stored.
  *
  */
+static void compute_slab_rates(data_t *old_data, data_t *new_data)
+{
+	for (size_t i = 0; i < new_data->slabs_count; i++) {
+		stats_slab_t *slab = &new_data->slabs[i];
+		diff_slab_t *diff = &new_data->slabs_diff[i];
+
+		/* Match slab cache with the previous instance */
+		stats_slab_t *prev = NULL;
+		for (size_t j = 0; j < old_data->slabs_count; j++) {
+			if (str_cmp(slab->name, old_data->slabs[j].name) == 0) {
+				prev = &old_data->slabs[j];
+				break;
+			}
+		}
+
+		if (prev == NULL) {
+			/* This is a new slab cache, ignore it */
+			diff->allocs = 0;
+			diff->frees = 0;
+			FRACTION_TO_FLOAT(diff->hits, 0, 0);
+			continue;
+		}
+
+		diff->allocs = (slab->allocs - prev->allocs) / UPDATE_INTERVAL;
+		diff->frees = (slab->frees - prev->frees) / UPDATE_INTERVAL;
+
+		uint64_t hits = slab->mag_hits - prev->mag_hits;
+		uint64_t misses = slab->mag_misses - prev->mag_misses;
+		FRACTION_TO_FLOAT(diff->hits, hits * 100, hits + misses);
+	}
+}
+
 static void compute_percentages(data_t *old_data, data_t *new_data)
 {
 	/*
@@ -261,6 +464,10 @@ static void compute_percentages(data_t *old_data, data_t *new_data)
 
 		FRACTION_TO_FLOAT(new_data->cpus_perc[i].idle, idle * 100, sum);
 		FRACTION_TO_FLOAT(new_data->cpus_perc[i].busy, busy * 100, sum);
+
+		compute_latency_diff(old_data->cpus[i].rq_latency,
+		    new_data->cpus[i].rq_latency,
+		    &new_data->cpus_latency_diff[i * STATS_LATENCY_BUCKETS]);
 	}
 
 	/* For all tasks compute sum and differencies of all cycles */
@@ -293,6 +500,12 @@ static void compute_percentages(data_t *old_data, data_t *new_data)
 		    new_data->tasks[i].ucycles - old_data->tasks[j].ucycles;
 		new_data->kcycles_diff[i] =
 		    new_data->tasks[i].kcycles - old_data->tasks[j].kcycles;
+		compute_latency_diff(old_data->tasks[j].rq_latency,
+		    new_data->tasks[i].rq_latency,
+		    &new_data->tasks_latency_diff[i * STATS_LATENCY_BUCKETS]);
+		compute_latency_diff(old_data->tasks[j].ipc_info.answer_latency,
+		    new_data->tasks[i].ipc_info.answer_latency,
+		    &new_data->tasks_ipc_latency_diff[i * STATS_LATENCY_BUCKETS]);
 
 		virtmem_total += new_data->tasks[i].virtmem;
 		resmem_total += new_data->tasks[i].resmem;
@@ -358,6 +571,8 @@ static void compute_percentages(data_t *old_data, data_t *new_data)
 		FRACTION_TO_FLOAT(new_data->exceptions_perc[i].count,
 		    new_data->ecount_diff[i] * 100, ecount_total);
 	}
+
+	compute_slab_rates(old_data, new_data);
 }
 
 static int cmp_data(void *a, void *b, void *arg)
@@ -470,6 +685,10 @@ static const char *fill_ipc_table(data_t *data)
 		field[IPC_COL_ANS_RCV].uint = data->tasks[i].ipc_info.answer_received;
 		field[IPC_COL_FORWARD].type = FIELD_UINT_SUFFIX_DEC;
 		field[IPC_COL_FORWARD].uint = data->tasks[i].ipc_info.forwarded;
+		field[IPC_COL_COPIED].type = FIELD_UINT_SUFFIX_BIN;
+		field[IPC_COL_COPIED].uint = data->tasks[i].ipc_info.data_copied;
+		field[IPC_COL_PINNED].type = FIELD_UINT_SUFFIX_BIN;
+		field[IPC_COL_PINNED].uint = data->tasks[i].ipc_info.data_pinned;
 		field[IPC_COL_NAME].type = FIELD_STRING;
 		field[IPC_COL_NAME].string = data->tasks[i].name;
 		field += IPC_NUM_COLUMNS;
@@ -514,6 +733,139 @@ static const char *fill_exception_table(data_t *data)
 	return NULL;
 }
 
+static const char *fill_ipc_queue_table(data_t *data)
+{
+	data->table.name = "IPC request queues";
+	data->table.num_columns = IPC_QUEUE_NUM_COLUMNS;
+	data->table.columns = ipc_queue_columns;
+	data->table.num_fields = data->tasks_count * IPC_QUEUE_NUM_COLUMNS;
+	data->table.fields = calloc(data->table.num_fields,
+	    sizeof(field_t));
+	if (data->table.fields == NULL)
+		return "Not enough memory for table fields";
+
+	field_t *field = data->table.fields;
+	for (size_t i = 0; i < data->tasks_count; i++) {
+		const stats_ipc_t *ipc = &data->tasks[i].ipc_info;
+		const uint64_t *hist =
+		    &data->tasks_ipc_latency_diff[i * STATS_LATENCY_BUCKETS];
+		uint64_t count = latency_count(hist);
+
+		field[IPC_QUEUE_COL_TASKID].type = FIELD_UINT;
+		field[IPC_QUEUE_COL_TASKID].uint = data->tasks[i].task_id;
+		field[IPC_QUEUE_COL_CLS_RCV].type = FIELD_UINT_SUFFIX_DEC;
+		field[IPC_QUEUE_COL_CLS_RCV].uint = ipc->call_received;
+		field[IPC_QUEUE_COL_ANS_SNT].type = FIELD_UINT_SUFFIX_DEC;
+		field[IPC_QUEUE_COL_ANS_SNT].uint = ipc->answer_sent;
+		field[IPC_QUEUE_COL_DEPTH].type = FIELD_UINT;
+		field[IPC_QUEUE_COL_DEPTH].uint = ipc->queue_depth;
+		field[IPC_QUEUE_COL_PEAK].type = FIELD_UINT;
+		field[IPC_QUEUE_COL_PEAK].uint = ipc->queue_peak;
+
+		if (count > 0) {
+			field[IPC_QUEUE_COL_P50].type = FIELD_UINT;
+			field[IPC_QUEUE_COL_P50].uint =
+			    latency_percentile(hist, count, 50);
+			field[IPC_QUEUE_COL_P99].type = FIELD_UINT;
+			field[IPC_QUEUE_COL_P99].uint =
+			    latency_percentile(hist, count, 99);
+			field[IPC_QUEUE_COL_MAX].type = FIELD_UINT;
+			field[IPC_QUEUE_COL_MAX].uint =
+			    latency_percentile(hist, count, 100);
+		}
+
+		field[IPC_QUEUE_COL_NAME].type = FIELD_STRING;
+		field[IPC_QUEUE_COL_NAME].string = data->tasks[i].name;
+		field += IPC_QUEUE_NUM_COLUMNS;
+	}
+
+	return NULL;
+}
+
+static const char *fill_latency_table(data_t *data)
+{
+	data->table.name = "Run queue latency";
+	data->table.num_columns = LATENCY_NUM_COLUMNS;
+	data->table.columns = latency_columns;
+	data->table.num_fields = data->tasks_count * LATENCY_NUM_COLUMNS;
+	data->table.fields = calloc(data->table.num_fields,
+	    sizeof(field_t));
+	if (data->table.fields == NULL)
+		return "Not enough memory for table fields";
+
+	field_t *field = data->table.fields;
+	for (size_t i = 0; i < data->tasks_count; i++) {
+		const uint64_t *hist =
+		    &data->tasks_latency_diff[i * STATS_LATENCY_BUCKETS];
+		uint64_t count = latency_count(hist);
+
+		field[LATENCY_COL_TASKID].type = FIELD_UINT;
+		field[LATENCY_COL_TASKID].uint = data->tasks[i].task_id;
+		field[LATENCY_COL_SAMPLES].type = FIELD_UINT_SUFFIX_DEC;
+		field[LATENCY_COL_SAMPLES].uint = count;
+
+		if (count > 0) {
+			field[LATENCY_COL_P50].type = FIELD_UINT;
+			field[LATENCY_COL_P50].uint =
+			    latency_percentile(hist, count, 50);
+			field[LATENCY_COL_P99].type = FIELD_UINT;
+			field[LATENCY_COL_P99].uint =
+			    latency_percentile(hist, count, 99);
+			field[LATENCY_COL_MAX].type = FIELD_UINT;
+			field[LATENCY_COL_MAX].uint =
+			    latency_percentile(hist, count, 100);
+		}
+
+		field[LATENCY_COL_NAME].type = FIELD_STRING;
+		field[LATENCY_COL_NAME].string = data->tasks[i].name;
+		field += LATENCY_NUM_COLUMNS;
+	}
+
+	return NULL;
+}
+
+static const char *fill_slab_table(data_t *data)
+{
+	data->table.name = "Slab caches";
+	data->table.num_columns = SLAB_NUM_COLUMNS;
+	data->table.columns = slab_columns;
+	data->table.num_fields = data->slabs_count * SLAB_NUM_COLUMNS;
+	data->table.fields = calloc(data->table.num_fields,
+	    sizeof(field_t));
+	if (data->table.fields == NULL)
+		return "Not enough memory for table fields";
+
+	field_t *field = data->table.fields;
+	for (size_t i = 0; i < data->slabs_count; i++) {
+		stats_slab_t *slab = &data->slabs[i];
+		diff_slab_t *diff = &data->slabs_diff[i];
+
+		field[SLAB_COL_SIZE].type = FIELD_UINT;
+		field[SLAB_COL_SIZE].uint = slab->size;
+		field[SLAB_COL_MEMORY].type = FIELD_UINT_SUFFIX_BIN;
+		field[SLAB_COL_MEMORY].uint = slab->memory;
+		field[SLAB_COL_OBJS].type = FIELD_UINT_SUFFIX_DEC;
+		field[SLAB_COL_OBJS].uint = slab->objs;
+		field[SLAB_COL_PEAK].type = FIELD_UINT_SUFFIX_DEC;
+		field[SLAB_COL_PEAK].uint = slab->peak;
+		field[SLAB_COL_ALLOCS].type = FIELD_UINT_SUFFIX_DEC;
+		field[SLAB_COL_ALLOCS].uint = diff->allocs;
+		field[SLAB_COL_FREES].type = FIELD_UINT_SUFFIX_DEC;
+		field[SLAB_COL_FREES].uint = diff->frees;
+		field[SLAB_COL_PERCENT_HITS].type = FIELD_PERCENT;
+		field[SLAB_COL_PERCENT_HITS].fixed = diff->hits;
+		field[SLAB_COL_GROWS].type = FIELD_UINT_SUFFIX_DEC;
+		field[SLAB_COL_GROWS].uint = slab->grows;
+		field[SLAB_COL_RECLAIMED].type = FIELD_UINT_SUFFIX_DEC;
+		field[SLAB_COL_RECLAIMED].uint = slab->reclaimed;
+		field[SLAB_COL_NAME].type = FIELD_STRING;
+		field[SLAB_COL_NAME].string = slab->name;
+		field += SLAB_NUM_COLUMNS;
+	}
+
+	return NULL;
+}
+
 static const char *fill_table(data_t *data)
 {
 	if (data->table.fields != NULL) {
@@ -526,8 +878,14 @@ static const char *fill_table(data_t *data)
 		return fill_task_table(data);
 	case OP_IPC:
 		return fill_ipc_table(data);
+	case OP_IPC_QUEUE:
+		return fill_ipc_queue_table(data);
 	case OP_EXCS:
 		return fill_exception_table(data);
+	case OP_LATENCY:
+		return fill_latency_table(data);
+	case OP_SLABS:
+		return fill_slab_table(data);
 	}
 	return NULL;
 }
@@ -558,6 +916,12 @@ static void free_data(data_t *target)
 	if (target->exceptions_perc != NULL)
 		free(target->exceptions_perc);
 
+	if (target->slabs != NULL)
+		free(target->slabs);
+
+	if (target->slabs_diff != NULL)
+		free(target->slabs_diff);
+
 	if (target->physmem != NULL)
 		free(target->physmem);
 
@@ -573,6 +937,15 @@ static void free_data(data_t *target)
 	if (target->ecount_diff != NULL)
 		free(target->ecount_diff);
 
+	if (target->cpus_latency_diff != NULL)
+		free(target->cpus_latency_diff);
+
+	if (target->tasks_latency_diff != NULL)
+		free(target->tasks_latency_diff);
+
+	if (target->tasks_ipc_latency_diff != NULL)
+		free(target->tasks_ipc_latency_diff);
+
 	if (target->table.fields != NULL)
 		free(target->table.fields);
 }
@@ -588,7 +961,7 @@ int main(int argc, char *argv[])
 	screen_init();
 	printf("Reading initial data...\n");
 
-	if ((ret = read_data(&data)) != NULL)
+	if ((ret = read_data(&data, NULL)) != NULL)
 		goto out;
 
 	/* Compute some rubbish to have initialised values */
@@ -600,7 +973,7 @@ int main(int argc, char *argv[])
 
 		if (rc == ETIMEOUT) { /* timeout */
 			data_prev = data;
-			if ((ret = read_data(&data)) != NULL) {
+			if ((ret = read_data(&data, &data_prev)) != NULL) {
 				free_data(&data_prev);
 				goto out;
 			}
@@ -641,9 +1014,18 @@ int main(int argc, char *argv[])
 		case 'i':
 			op_mode = OP_IPC;
 			break;
+		case 'b':
+			op_mode = OP_IPC_QUEUE;
+			break;
 		case 'e':
 			op_mode = OP_EXCS;
 			break;
+		case 'l':
+			op_mode = OP_LATENCY;
+			break;
+		case 'm':
+			op_mode = OP_SLABS;
+			break;
 		case 's':
 			screen_mode = SCREEN_SORT;
 			break;
@@ -79,6 +79,12 @@ typedef struct {
 	fixed_float count;
 } perc_exc_t;
 
+typedef struct {
+	uint64_t allocs;  /**< Allocations since the previous sample */
+	uint64_t frees;   /**< Frees since the previous sample */
+	fixed_float hits; /**< Magazine hit ratio since the previous sample */
+} diff_slab_t;
+
 typedef enum {
 	FIELD_EMPTY,
 	FIELD_UINT,
@@ -131,24 +137,36 @@ typedef struct {
 	size_t tasks_count;
 	stats_task_t *tasks;
 	perc_task_t *tasks_perc;
+	uint64_t tasks_gen;
 
 	size_t threads_count;
 	stats_thread_t *threads;
+	uint64_t threads_gen;
 
 	size_t exceptions_count;
 	stats_exc_t *exceptions;
 	perc_exc_t *exceptions_perc;
 
+	size_t slabs_count;
+	stats_slab_t *slabs;
+	diff_slab_t *slabs_diff;
+
 	stats_physmem_t *physmem;
 
 	uint64_t *ucycles_diff;
 	uint64_t *kcycles_diff;
 	uint64_t *ecycles_diff;
 	uint64_t *ecount_diff;
+	uint64_t *cpus_latency_diff;
+	uint64_t *tasks_latency_diff;
+	uint64_t *tasks_ipc_latency_diff;
 
 	table_t table;
 } data_t;
 
+extern uint64_t latency_percentile(const uint64_t *, uint64_t, unsigned int);
+extern uint64_t latency_count(const uint64_t *);
+
 #endif
 
 /**
@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup trace
+ * @{
+ */
+/** @file Non-stopping tracing from the kernel trace rings.
+ *
+ * Instead of stopping the traced task on every event, the records the
+ * kernel writes to its per-CPU trace rings are read periodically. IPC
+ * requests are matched with their answers to compute per-method
+ * latencies, which are summarized at the end.
+ */
+
+#include <abi/ktrace.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <as.h>
+#include <barrier.h>
+#include <ddi.h>
+#include <errno.h>
+#include <fibril.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <qsort.h>
+#include <stats.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include <sysinfo.h>
+#include "ipc_desc.h"
+#include "ktrace.h"
+#include "trace.h"
+
+/** Interval between reading the rings. */
+#define KTRACE_POLL_USEC  50000
+
+/** Request waiting for its answer. */
+typedef struct {
+	ht_link_t link;
+	uint64_t call;
+	uint64_t timestamp;
+	task_id_t caller;
+	task_id_t callee;
+	sysarg_t method;
+} ktrace_call_t;
+
+/** Latency summary of one method of one server task. */
+typedef struct {
+	ht_link_t link;
+	task_id_t callee;
+	sysarg_t method;
+	size_t count;
+	uint64_t total;
+	uint64_t max;
+} ktrace_method_t;
+
+typedef struct {
+	task_id_t callee;
+	sysarg_t method;
+} method_key_t;
+
+static hash_table_t calls;
+static hash_table_t methods;
+
+/** Cycles per microsecond. */
+static uint64_t cycles_per_usec;
+/** Timestamp of the first record seen. */
+static uint64_t start_cycle;
+static bool started;
+
+/** Records overwritten before they could be read. */
+static uint64_t lost;
+/** Answers whose request was not seen. */
+static size_t unmatched;
+
+static size_t call_key_hash(const void *key)
+{
+	return hash_mix(*(const uint64_t *) key);
+}
+
+static size_t call_hash(const ht_link_t *item)
+{
+	ktrace_call_t *call = hash_table_get_inst(item, ktrace_call_t, link);
+	return call_key_hash(&call->call);
+}
+
+static bool call_key_equal(const void *key, const ht_link_t *item)
+{
+	ktrace_call_t *call = hash_table_get_inst(item, ktrace_call_t, link);
+	return *(const uint64_t *) key == call->call;
+}
+
+static hash_table_ops_t call_ops = {
+	.hash = call_hash,
+	.key_hash = call_key_hash,
+	.key_equal = call_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static size_t method_key_hash(const void *key)
+{
+	const method_key_t *mkey = key;
+	return hash_combine(hash_mix(mkey->callee), hash_mix(mkey->method));
+}
+
+static size_t method_hash(const ht_link_t *item)
+{
+	ktrace_method_t *method = hash_table_get_inst(item, ktrace_method_t,
+	    link);
+	method_key_t key = { method->callee, method->method };
+	return method_key_hash(&key);
+}
+
+static bool method_key_equal(const void *key, const ht_link_t *item)
+{
+	const method_key_t *mkey = key;
+	ktrace_method_t *method = hash_table_get_inst(item, ktrace_method_t,
+	    link);
+	return (mkey->callee == method->callee) &&
+	    (mkey->method == method->method);
+}
+
+static hash_table_ops_t method_ops = {
+	.hash = method_hash,
+	.key_hash = method_key_hash,
+	.key_equal = method_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static uint64_t cycles_to_usec(uint64_t cycles)
+{
+	return cycles / cycles_per_usec;
+}
+
+static void method_print(sysarg_t method)
+{
+	for (size_t i = 0; i < ipc_methods_len; i++) {
+		if ((sysarg_t) ipc_methods[i].number == method) {
+			printf("%s (%" PRIun ")", ipc_methods[i].name, method);
+			return;
+		}
+	}
+
+	printf("%" PRIun, method);
+}
+
+static void record_header_print(ktrace_record_t *rec)
+{
+	printf("%10" PRIu64 " cpu%" PRIu32 " task %" PRIu64 ": ",
+	    cycles_to_usec(rec->timestamp - start_cycle), rec->cpu,
+	    rec->task_id);
+}
+
+static void call_record(ktrace_record_t *rec)
+{
+	ht_link_t *link = hash_table_find(&calls, &rec->arg[0]);
+	ktrace_call_t *call;
+
+	/* A forwarded request is sent again, keep its original timestamp */
+	if (link != NULL) {
+		call = hash_table_get_inst(link, ktrace_call_t, link);
+		call->callee = rec->arg[2];
+		return;
+	}
+
+	call = malloc(sizeof(ktrace_call_t));
+	if (call == NULL)
+		return;
+
+	call->call = rec->arg[0];
+	call->timestamp = rec->timestamp;
+	call->caller = rec->task_id;
+	call->callee = rec->arg[2];
+	call->method = rec->arg[1];
+	hash_table_insert(&calls, &call->link);
+}
+
+static void answer_record(ktrace_record_t *rec, uint64_t *latency)
+{
+	ht_link_t *link = hash_table_find(&calls, &rec->arg[0]);
+	if (link == NULL) {
+		unmatched++;
+		return;
+	}
+
+	ktrace_call_t *call = hash_table_get_inst(link, ktrace_call_t, link);
+	hash_table_remove_item(&calls, link);
+
+	*latency = rec->timestamp - call->timestamp;
+
+	method_key_t key = { call->callee, call->method };
+	ktrace_method_t *method;
+
+	link = hash_table_find(&methods, &key);
+	if (link != NULL) {
+		method = hash_table_get_inst(link, ktrace_method_t, link);
+	} else {
+		method = calloc(1, sizeof(ktrace_method_t));
+		if (method == NULL) {
+			free(call);
+			return;
+		}
+
+		method->callee = call->callee;
+		method->method = call->method;
+		hash_table_insert(&methods, &method->link);
+	}
+
+	method->count++;
+	method->total += *latency;
+	method->max = max(method->max, *latency);
+	free(call);
+}
+
+/** Account and print one record. */
+static void record_process(ktrace_record_t *rec, task_id_t task_id)
+{
+	uint64_t latency = 0;
+
+	if (!started) {
+		start_cycle = rec->timestamp;
+		started = true;
+	}
+
+	bool ours = (task_id == 0) || (rec->task_id == task_id) ||
+	    ((rec->event == KTRACE_IPC_CALL) && (rec->arg[2] == task_id));
+
+	switch (rec->event) {
+	case KTRACE_IPC_CALL:
+		call_record(rec);
+		if (ours && (display_mask & (DM_IPC | DM_SYSTEM | DM_USER))) {
+			record_header_print(rec);
+			printf("call %#" PRIx64 " ", rec->arg[0]);
+			method_print(rec->arg[1]);
+			printf(" -> task %" PRIu64 "\n", rec->arg[2]);
+		}
+		break;
+	case KTRACE_IPC_FORWARD:
+		if (ours && (display_mask & (DM_IPC | DM_SYSTEM | DM_USER))) {
+			record_header_print(rec);
+			printf("forward %#" PRIx64 " ", rec->arg[0]);
+			method_print(rec->arg[1]);
+			printf("\n");
+		}
+		break;
+	case KTRACE_IPC_ANSWER:
+		answer_record(rec, &latency);
+		if (ours && (display_mask & (DM_IPC | DM_SYSTEM | DM_USER))) {
+			record_header_print(rec);
+			printf("answer %#" PRIx64 " ", rec->arg[0]);
+			method_print(rec->arg[1]);
+			printf(" retval %s, %" PRIu64 " us\n",
+			    str_error_name((errno_t) rec->arg[2]),
+			    cycles_to_usec(latency));
+		}
+		break;
+	case KTRACE_SCHED:
+		if (ours && (display_mask & DM_THREAD)) {
+			record_header_print(rec);
+			printf("run thread %" PRIu64 " (priority %" PRIu64 ")\n",
+			    rec->arg[0], rec->arg[2]);
+		}
+		break;
+	case KTRACE_PAGE_FAULT:
+		if (ours && (display_mask & DM_PAGEFAULT)) {
+			record_header_print(rec);
+			printf("page fault at %#" PRIx64 " (access %" PRIu64
+			    ") pc %#" PRIx64 "\n", rec->arg[0], rec->arg[1],
+			    rec->arg[2]);
+		}
+		break;
+	}
+}
+
+static int record_cmp(const void *a, const void *b)
+{
+	const ktrace_record_t *ra = a;
+	const ktrace_record_t *rb = b;
+
+	if (ra->timestamp != rb->timestamp)
+		return (ra->timestamp < rb->timestamp) ? -1 : 1;
+
+	return 0;
+}
+
+/** Copy new records from a ring.
+ *
+ * @param ring  Ring to read.
+ * @param tail  Sequence number of the next record to read.
+ * @param buf   Buffer for the records.
+ * @param count Number of records already in @a buf.
+ *
+ * @return Number of records in @a buf.
+ */
+static size_t ring_read(volatile ktrace_ring_t *ring, uint64_t *tail,
+    ktrace_record_t *buf, size_t count)
+{
+	uint64_t head = ring->head;
+	uint64_t capacity = ring->capacity;
+
+	read_barrier();
+
+	if (head - *tail > capacity) {
+		lost += head - *tail - capacity;
+		*tail = head - capacity;
+	}
+
+	for (; *tail < head; (*tail)++) {
+		buf[count] = ring->records[*tail % capacity];
+		read_barrier();
+
+		/* The slot may have been reused while copying */
+		if (ring->head >= *tail + capacity) {
+			lost++;
+			continue;
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+static int method_cmp(const void *a, const void *b)
+{
+	ktrace_method_t *ma = *(ktrace_method_t **) a;
+	ktrace_method_t *mb = *(ktrace_method_t **) b;
+
+	if (ma->total != mb->total)
+		return (ma->total < mb->total) ? 1 : -1;
+
+	return 0;
+}
+
+typedef struct {
+	ktrace_method_t **items;
+	size_t count;
+} method_list_t;
+
+static bool method_collect(ht_link_t *link, void *arg)
+{
+	method_list_t *list = arg;
+	list->items[list->count++] = hash_table_get_inst(link,
+	    ktrace_method_t, link);
+	return true;
+}
+
+static void summary_print(void)
+{
+	method_list_t list;
+
+	list.items = calloc(max(hash_table_size(&methods), 1),
+	    sizeof(ktrace_method_t *));
+	if (list.items == NULL)
+		return;
+
+	list.count = 0;
+	hash_table_apply(&methods, method_collect, &list);
+	qsort(list.items, list.count, sizeof(ktrace_method_t *), method_cmp);
+
+	printf("\nIPC latency by server and method:\n");
+	printf("[server] [count] [avg us] [max us] [method]\n");
+
+	for (size_t i = 0; i < list.count; i++) {
+		ktrace_method_t *method = list.items[i];
+
+		printf("%8" PRIu64 " %7zu %8" PRIu64 " %8" PRIu64 " ",
+		    method->callee, method->count,
+		    cycles_to_usec(method->total / method->count),
+		    cycles_to_usec(method->max));
+		method_print(method->method);
+		printf("\n");
+	}
+
+	if ((lost != 0) || (unmatched != 0)) {
+		printf("%" PRIu64 " records lost, %zu answers without request\n",
+		    lost, unmatched);
+	}
+
+	free(list.items);
+}
+
+/** Trace from the kernel trace rings without stopping any task.
+ *
+ * @param seconds Number of seconds to trace.
+ * @param task_id Task to print events of, 0 for all tasks. Latencies
+ *                are accounted for all tasks.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t ktrace_run(unsigned int seconds, task_id_t task_id)
+{
+	sysarg_t faddr;
+	sysarg_t cpus;
+
+	errno_t rc = sysinfo_get_value("ktrace.faddr", &faddr);
+	if (rc == EOK)
+		rc = sysinfo_get_value("ktrace.cpus", &cpus);
+	if (rc != EOK) {
+		printf("Kernel trace rings not available.\n");
+		return rc;
+	}
+
+	void *rings;
+	rc = physmem_map(faddr, cpus * KTRACE_RING_SIZE / PAGE_SIZE,
+	    AS_AREA_READ | AS_AREA_CACHEABLE, &rings);
+	if (rc != EOK) {
+		printf("Unable to map kernel trace rings: %s.\n",
+		    str_error(rc));
+		return rc;
+	}
+
+	size_t ncpus;
+	stats_cpu_t *stats_cpus = stats_get_cpus(&ncpus);
+	cycles_per_usec = 1;
+	if ((stats_cpus != NULL) && (ncpus > 0) &&
+	    (stats_cpus[0].frequency_mhz != 0))
+		cycles_per_usec = stats_cpus[0].frequency_mhz;
+	free(stats_cpus);
+
+	uint64_t *tails = calloc(cpus, sizeof(uint64_t));
+	size_t buf_size = 0;
+	for (sysarg_t i = 0; i < cpus; i++) {
+		volatile ktrace_ring_t *ring = rings + i * KTRACE_RING_SIZE;
+		if (tails != NULL)
+			tails[i] = ring->head;
+		buf_size += ring->capacity;
+	}
+
+	ktrace_record_t *buf = malloc(buf_size * sizeof(ktrace_record_t));
+	if ((tails == NULL) || (buf == NULL) ||
+	    !hash_table_create(&calls, 0, 0, &call_ops) ||
+	    !hash_table_create(&methods, 0, 0, &method_ops)) {
+		printf("Out of memory.\n");
+		free(tails);
+		free(buf);
+		as_area_destroy(rings);
+		return ENOMEM;
+	}
+
+	printf("Reading kernel trace rings for %u seconds.\n", seconds);
+
+	for (uint64_t polls = (uint64_t) seconds * 1000000 / KTRACE_POLL_USEC;
+	    polls > 0; polls--) {
+		fibril_usleep(KTRACE_POLL_USEC);
+
+		/* Merge the rings of all CPUs in time order */
+		size_t count = 0;
+		for (sysarg_t i = 0; i < cpus; i++) {
+			count = ring_read(rings + i * KTRACE_RING_SIZE,
+			    &tails[i], buf, count);
+		}
+
+		qsort(buf, count, sizeof(ktrace_record_t), record_cmp);
+
+		for (size_t i = 0; i < count; i++)
+			record_process(&buf[i], task_id);
+	}
+
+	summary_print();
+
+	free(tails);
+	free(buf);
+	as_area_destroy(rings);
+	return EOK;
+}
+
+/** @}
+ */
@@ -46,9 +46,13 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_THREAD_GET_ID] = { "thread_get_id", 1, V_ERRNO },
 	[SYS_THREAD_USLEEP] = { "thread_usleep", 1, V_ERRNO },
 	[SYS_THREAD_UDELAY] = { "thread_udelay", 1, V_ERRNO },
+	[SYS_THREAD_SET_AFFINITY] = { "thread_set_affinity", 2, V_ERRNO },
+	[SYS_THREAD_GET_AFFINITY] = { "thread_get_affinity", 2, V_ERRNO },
+	[SYS_THREAD_SET_RT] = { "thread_set_rt", 3, V_ERRNO },
 
 	[SYS_TASK_GET_ID] = { "task_get_id", 1, V_ERRNO },
 	[SYS_TASK_SET_NAME] = { "task_set_name", 2, V_ERRNO },
+	[SYS_TASK_SET_NUMA] = { "task_set_numa", 2, V_ERRNO },
 	[SYS_TASK_KILL] = { "task_kill", 1, V_ERRNO },
 	[SYS_TASK_EXIT] = { "task_exit", 1, V_ERRNO },
 	[SYS_PROGRAM_SPAWN_LOADER] = { "program_spawn_loader", 2, V_ERRNO },
@@ -56,8 +60,9 @@ const sc_desc_t syscall_desc[] = {
 	/* Synchronization related syscalls. */
 	[SYS_WAITQ_CREATE] = { "waitq_create", 1, V_ERRNO },
 	[SYS_WAITQ_SLEEP] = { "waitq_sleep", 3, V_ERRNO },
-	[SYS_WAITQ_WAKEUP] = { "waitq_wakeup", 1, V_ERRNO },
+	[SYS_WAITQ_WAKEUP] = { "waitq_wakeup", 2, V_ERRNO },
 	[SYS_WAITQ_DESTROY] = { "waitq_destroy", 1, V_ERRNO },
+	[SYS_WAITQ_REQUEUE] = { "waitq_requeue", 4, V_ERRNO },
 	[SYS_SMC_COHERENCE] = { "smc_coherence", 2, V_ERRNO },
 
 	/* Address space related syscalls. */
@@ -66,6 +71,7 @@ const sc_desc_t syscall_desc[] = {
 	[SYS_AS_AREA_CHANGE_FLAGS] = { "as_area_change_flags", 2, V_ERRNO },
 	[SYS_AS_AREA_GET_INFO] = { "as_area_get_info", 2, V_ERRNO },
 	[SYS_AS_AREA_DESTROY] = { "as_area_destroy", 1, V_ERRNO },
+	[SYS_AS_AREA_SYNC] = { "as_area_sync", 2, V_ERRNO },
 
 	/* Page mapping related syscalls. */
 	[SYS_PAGE_FIND_MAPPING] = { "page_find_mapping", 2, V_ERRNO },
@@ -73,15 +79,23 @@ const sc_desc_t syscall_desc[] = {
 	/* IPC related syscalls. */
 	[SYS_IPC_CALL_ASYNC_FAST] = { "ipc_call_async_fast", 6, V_HASH },
 	[SYS_IPC_CALL_ASYNC_SLOW] = { "ipc_call_async_slow", 3, V_HASH },
+	[SYS_IPC_CALL_ASYNC_BATCH] = { "ipc_call_async_batch", 3, V_ERRNO },
 	[SYS_IPC_ANSWER_FAST] = { "ipc_answer_fast", 6, V_ERRNO },
 	[SYS_IPC_ANSWER_SLOW] = { "ipc_answer_slow", 2, V_ERRNO },
 	[SYS_IPC_FORWARD_FAST] = { "ipc_forward_fast", 6, V_ERRNO },
 	[SYS_IPC_FORWARD_SLOW] = { "ipc_forward_slow", 3, V_ERRNO },
 	[SYS_IPC_WAIT] = { "ipc_wait_for_call", 3, V_HASH },
+	[SYS_IPC_WAIT_MULTI] = { "ipc_wait_for_calls", 5, V_ERRNO },
 	[SYS_IPC_POKE] = { "ipc_poke", 0, V_ERRNO },
 	[SYS_IPC_HANGUP] = { "ipc_hangup", 1, V_ERRNO },
 	[SYS_IPC_CONNECT_KBOX] = { "ipc_connect_kbox", 2, V_ERRNO },
 
+	/* IPC ring related syscalls. */
+	[SYS_IPC_RING_CREATE] = { "ipc_ring_create", 1, V_ERRNO },
+	[SYS_IPC_RING_WAIT] = { "ipc_ring_wait", 3, V_ERRNO },
+	[SYS_IPC_RING_NOTIFY] = { "ipc_ring_notify", 2, V_ERRNO },
+	[SYS_IPC_RING_DESTROY] = { "ipc_ring_destroy", 1, V_ERRNO },
+
 	/* Event notification syscalls. */
 	[SYS_IPC_EVENT_SUBSCRIBE] = { "ipc_event_subscribe", 2, V_ERRNO },
 	[SYS_IPC_EVENT_UNSUBSCRIBE] = { "ipc_event_unsubscribe", 1, V_ERRNO },
@@ -101,6 +115,10 @@ const sc_desc_t syscall_desc[] = {
 
 	[SYS_IPC_IRQ_SUBSCRIBE] = { "ipc_irq_subscribe", 4, V_ERRNO },
 	[SYS_IPC_IRQ_UNSUBSCRIBE] = { "ipc_irq_unsubscribe", 2, V_ERRNO },
+	[SYS_IRQ_MSI_ALLOC] = { "irq_msi_alloc", 2, V_ERRNO },
+	[SYS_IRQ_MSI_FREE] = { "irq_msi_free", 2, V_ERRNO },
+	[SYS_IRQ_AFFINITY_SET] = { "irq_affinity_set", 2, V_ERRNO },
+	[SYS_IRQ_AFFINITY_GET] = { "irq_affinity_get", 2, V_ERRNO },
 
 	/* Sysinfo syscalls. */
 	[SYS_SYSINFO_GET_KEYS_SIZE] = { "sysinfo_get_keys_size", 3, V_ERRNO },
@@ -113,6 +131,11 @@ const sc_desc_t syscall_desc[] = {
 	/* Kernel console syscalls. */
 	[SYS_DEBUG_CONSOLE] = { "debug_console", 0, V_ERRNO },
 
+	/* Sampling profiler syscalls. */
+	[SYS_PROFILE_CTL] = { "profile_ctl", 1, V_ERRNO },
+	[SYS_PROFILE_READ] = { "profile_read", 3, V_ERRNO },
+	[SYS_PROFILE_SYMBOL] = { "profile_symbol", 4, V_ERRNO },
+
 	[SYS_KLOG] = { "klog", 5, V_ERRNO }
 };
 
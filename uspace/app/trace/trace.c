@@ -61,6 +61,7 @@
 
 #include "syscalls.h"
 #include "ipcp.h"
+#include "ktrace.h"
 #include "trace.h"
 
 #define THBUF_SIZE 64
@@ -91,6 +92,9 @@ static task_id_t task_id;
 static task_wait_t task_w;
 static bool task_wait_for;
 
+/** Seconds to read the kernel trace rings for, 0 to trace using udebug. */
+static unsigned int ktrace_seconds;
+
 /** Combination of events/data to print. */
 display_mask_t display_mask;
 
@@ -331,6 +335,28 @@ static void sc_ipc_call_async_slow(sysarg_t *sc_args, errno_t sc_rc)
 	}
 }
 
+static void sc_ipc_call_async_batch(sysarg_t *sc_args, errno_t sc_rc)
+{
+	ipc_call_t call;
+	size_t submitted;
+	size_t i;
+	errno_t rc;
+
+	rc = udebug_mem_read(sess, &submitted, sc_args[2], sizeof(submitted));
+	if (rc != EOK)
+		return;
+
+	for (i = 0; i < submitted; i++) {
+		memset(&call, 0, sizeof(call));
+		rc = udebug_mem_read(sess, &call, sc_args[0] + i * sizeof(call),
+		    sizeof(call));
+		if (rc != EOK)
+			break;
+
+		ipcp_call_out((cap_phone_handle_t) call.cap_handle, &call, 0);
+	}
+}
+
 static void sc_ipc_wait(sysarg_t *sc_args, cap_call_handle_t sc_rc)
 {
 	ipc_call_t call;
@@ -346,6 +372,31 @@ static void sc_ipc_wait(sysarg_t *sc_args, cap_call_handle_t sc_rc)
 		ipcp_call_in(&call, sc_rc);
 }
 
+static void sc_ipc_wait_multi(sysarg_t *sc_args, errno_t sc_rc)
+{
+	ipc_call_t call;
+	size_t received;
+	size_t i;
+	errno_t rc;
+
+	if (sc_rc != EOK)
+		return;
+
+	rc = udebug_mem_read(sess, &received, sc_args[4], sizeof(received));
+	if (rc != EOK)
+		return;
+
+	for (i = 0; i < received; i++) {
+		memset(&call, 0, sizeof(call));
+		rc = udebug_mem_read(sess, &call, sc_args[0] + i * sizeof(call),
+		    sizeof(call));
+		if (rc != EOK)
+			break;
+
+		ipcp_call_in(&call, call.cap_handle);
+	}
+}
+
 static void event_syscall_b(unsigned thread_id, uintptr_t thread_hash,
     unsigned sc_id, sysarg_t sc_rc)
 {
@@ -403,9 +454,15 @@ static void event_syscall_e(unsigned thread_id, uintptr_t thread_hash,
 	case SYS_IPC_CALL_ASYNC_SLOW:
 		sc_ipc_call_async_slow(sc_args, (errno_t) sc_rc);
 		break;
+	case SYS_IPC_CALL_ASYNC_BATCH:
+		sc_ipc_call_async_batch(sc_args, (errno_t) sc_rc);
+		break;
 	case SYS_IPC_WAIT:
 		sc_ipc_wait(sc_args, (cap_call_handle_t) sc_rc);
 		break;
+	case SYS_IPC_WAIT_MULTI:
+		sc_ipc_wait_multi(sc_args, (errno_t) sc_rc);
+		break;
 	default:
 		break;
 	}
@@ -679,16 +736,22 @@ static void print_syntax(void)
 	printf("Syntax:\n");
 	printf("\ttrace [+<events>] <executable> [<arg1> [...]]\n");
 	printf("or\ttrace [+<events>] -t <task_id>\n");
+	printf("or\ttrace [+<events>] -k <seconds> [-t <task_id>]\n");
 	printf("Events: (default is +tp)\n");
 	printf("\n");
 	printf("\tt ... Thread creation and termination\n");
 	printf("\ts ... System calls\n");
 	printf("\ti ... Low-level IPC\n");
 	printf("\tp ... Protocol level\n");
+	printf("\tf ... Page faults (with -k only)\n");
+	printf("\n");
+	printf("With -k the kernel trace rings are read without stopping\n");
+	printf("any task, thread events are thread switches.\n");
 	printf("\n");
 	printf("Examples:\n");
 	printf("\ttrace +s /app/tetris\n");
 	printf("\ttrace +tsip -t 12\n");
+	printf("\ttrace +i -k 5\n");
 }
 
 static display_mask_t parse_display_mask(const char *text)
@@ -710,6 +773,9 @@ static display_mask_t parse_display_mask(const char *text)
 		case 'p':
 			dm = dm | DM_SYSTEM | DM_USER;
 			break;
+		case 'f':
+			dm = dm | DM_PAGEFAULT;
+			break;
 		default:
 			printf("Unexpected event type '%c'.\n", *c);
 			exit(1);
@@ -746,6 +812,17 @@ static int parse_args(int argc, char *argv[])
 					print_syntax();
 					return -1;
 				}
+			} else if (arg[1] == 'k') {
+				/* Read the kernel trace rings */
+				--argc;
+				++argv;
+				ktrace_seconds = argc > 0 ?
+				    strtoul(*argv, &err_p, 10) : 0;
+				if ((ktrace_seconds == 0) || (*err_p)) {
+					printf("Duration syntax error\n");
+					print_syntax();
+					return -1;
+				}
 			} else {
 				printf("Uknown option '%c'\n", arg[0]);
 				print_syntax();
@@ -759,7 +836,7 @@ static int parse_args(int argc, char *argv[])
 		++argv;
 	}
 
-	if (task_id != 0) {
+	if ((task_id != 0) || (ktrace_seconds != 0)) {
 		if (argc == 0)
 			return 0;
 		printf("Extra arguments\n");
@@ -794,13 +871,17 @@ int main(int argc, char *argv[])
 	int retval;
 
 	printf("System Call / IPC Tracer\n");
-	printf("Controls: Q - Quit, P - Pause, R - Resume\n");
 
 	display_mask = DM_THREAD | DM_SYSTEM | DM_USER;
 
 	if (parse_args(argc, argv) < 0)
 		return 1;
 
+	if (ktrace_seconds != 0)
+		return (ktrace_run(ktrace_seconds, task_id) == EOK) ? 0 : 1;
+
+	printf("Controls: Q - Quit, P - Pause, R - Resume\n");
+
 	main_init();
 
 	if (cmd_path != NULL)
@@ -46,7 +46,8 @@ typedef enum {
 	DM_SYSCALL	= 2,	/**< System calls */
 	DM_IPC		= 4,	/**< Low-level IPC */
 	DM_SYSTEM	= 8,	/**< Sysipc protocol */
-	DM_USER		= 16	/**< User IPC protocols */
+	DM_USER		= 16,	/**< User IPC protocols */
+	DM_PAGEFAULT	= 32	/**< Page faults (kernel trace rings only) */
 
 } display_mask_t;
 
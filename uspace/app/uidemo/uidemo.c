@@ -1206,6 +1206,9 @@ int main(int argc, char *argv[])
 			}
 
 			display_spec = argv[i++];
+		} else if (str_cmp(argv[i], "--startup-only") == 0) {
+			/* Used to measure program start-up time */
+			return 0;
 		} else {
 			printf("Invalid option '%s'.\n", argv[i]);
 			print_syntax();
@@ -33,36 +33,82 @@
  */
 
 #include <errno.h>
+#include <gzip.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <untar.h>
 
 typedef struct {
 	const char *filename;
 	FILE *file;
+	/** Decompressor if the archive is gzipped, @c NULL otherwise */
+	gzip_reader_t *gzip;
 } tar_state_t;
 
+/** Read compressed archive data from file. */
+static errno_t tar_gzip_read(void *arg, void *data, size_t size, size_t *nread)
+{
+	FILE *file = (FILE *) arg;
+
+	*nread = fread(data, 1, size, file);
+	if (*nread < size && ferror(file))
+		return EIO;
+
+	return EOK;
+}
+
 static int tar_open(tar_file_t *tar)
 {
 	tar_state_t *state = (tar_state_t *) tar->data;
+	uint8_t magic[2];
+	size_t nread;
+	errno_t rc;
 
+	state->gzip = NULL;
 	state->file = fopen(state->filename, "rb");
 	if (state->file == NULL)
 		return errno;
 
+	/* Gzipped archives are decompressed on the fly */
+	nread = fread(magic, 1, sizeof(magic), state->file);
+	if (fseek(state->file, 0, SEEK_SET) < 0) {
+		fclose(state->file);
+		return EIO;
+	}
+
+	if (nread == sizeof(magic) && magic[0] == 0x1f && magic[1] == 0x8b) {
+		rc = gzip_reader_create(tar_gzip_read, state->file,
+		    &state->gzip);
+		if (rc != EOK) {
+			fclose(state->file);
+			return rc;
+		}
+	}
+
 	return EOK;
 }
 
 static void tar_close(tar_file_t *tar)
 {
 	tar_state_t *state = (tar_state_t *) tar->data;
+
+	gzip_reader_destroy(state->gzip);
 	fclose(state->file);
 }
 
 static size_t tar_read(tar_file_t *tar, void *data, size_t size)
 {
 	tar_state_t *state = (tar_state_t *) tar->data;
-	return fread(data, 1, size, state->file);
+	size_t nread;
+
+	if (state->gzip == NULL)
+		return fread(data, 1, size, state->file);
+
+	if (gzip_reader_read(state->gzip, data, size, &nread) != EOK)
+		return 0;
+
+	return nread;
 }
 
 static void tar_vreport(tar_file_t *tar, const char *fmt, va_list args)
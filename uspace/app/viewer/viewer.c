@@ -47,6 +47,9 @@
 
 #define NAME  "viewer"
 
+/** Size of chunks in which the image file is read */
+#define IMG_READ_CHUNK  16384
+
 typedef struct {
 	ui_t *ui;
 } viewer_t;
@@ -130,41 +133,45 @@ static void wnd_kbd_event(ui_window_t *window, void *arg,
 static bool img_load(gfx_context_t *gc, const char *fname,
     gfx_bitmap_t **rbitmap, gfx_rect_t *rect)
 {
+	tga_decoder_t *dec;
+	aoff64_t pos = 0;
+	size_t nread;
+	void *buf;
 	int fd;
+
 	errno_t rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ, &fd);
 	if (rc != EOK)
 		return false;
 
-	vfs_stat_t stat;
-	rc = vfs_stat(fd, &stat);
-	if (rc != EOK) {
+	buf = malloc(IMG_READ_CHUNK);
+	if (buf == NULL) {
 		vfs_put(fd);
 		return false;
 	}
 
-	void *tga = malloc(stat.size);
-	if (tga == NULL) {
+	rc = tga_decoder_create(gc, &dec);
+	if (rc != EOK) {
+		free(buf);
 		vfs_put(fd);
 		return false;
 	}
 
-	size_t nread;
-	rc = vfs_read(fd, (aoff64_t []) { 0 }, tga, stat.size, &nread);
-	if (rc != EOK || nread != stat.size) {
-		free(tga);
-		vfs_put(fd);
-		return false;
-	}
+	/* Decode the image as it is being read */
+	do {
+		rc = vfs_read(fd, &pos, buf, IMG_READ_CHUNK, &nread);
+		if (rc == EOK)
+			rc = tga_decoder_write(dec, buf, nread);
+	} while (rc == EOK && nread > 0);
 
+	free(buf);
 	vfs_put(fd);
 
-	rc = decode_tga(gc, tga, stat.size, rbitmap, rect);
-	if (rc != EOK) {
-		free(tga);
-		return false;
-	}
+	if (rc == EOK)
+		rc = tga_decoder_finish(dec, rbitmap, rect);
 
-	free(tga);
+	tga_decoder_destroy(dec);
+	if (rc != EOK)
+		return false;
 
 	img_rect = *rect;
 	return true;
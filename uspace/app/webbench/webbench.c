@@ -0,0 +1,529 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup webbench
+ * @brief HTTP load generator.
+ * @{
+ */
+/**
+ * @file
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <getopt.h>
+#include <inet/endpoint.h>
+#include <inet/hostport.h>
+#include <inet/tcp.h>
+#include <inttypes.h>
+#include <qsort.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <time.h>
+
+#define NAME  "webbench"
+
+/** Default number of concurrent connections */
+#define DEFAULT_CONNS  4
+/** Default number of requests */
+#define DEFAULT_REQS  1000
+
+/** Size of receive buffer of one connection */
+#define RECV_BUF_SIZE  16384
+/** Maximum length of a response header line */
+#define LINE_SIZE  1024
+
+/** Load generating worker */
+typedef struct {
+	/** Connection or @c NULL if not connected */
+	tcp_conn_t *conn;
+	/** Receive buffer */
+	char rbuf[RECV_BUF_SIZE];
+	/** Number of bytes consumed from @c rbuf */
+	size_t rbuf_out;
+	/** Number of bytes in @c rbuf */
+	size_t rbuf_in;
+	/** Response header line */
+	char lbuf[LINE_SIZE + 1];
+} worker_t;
+
+static tcp_cb_t conn_cb = {
+	.connected = NULL
+};
+
+static tcp_t *tcp;
+static inet_ep2_t epp;
+static char *request;
+static bool keep_alive = true;
+static unsigned long nreqs = DEFAULT_REQS;
+
+/** Protects the variables below */
+static FIBRIL_MUTEX_INITIALIZE(bench_lock);
+/** Signalled when a worker finishes */
+static FIBRIL_CONDVAR_INITIALIZE(bench_cv);
+/** Number of requests handed out to workers */
+static unsigned long reqs_started;
+/** Number of successful requests */
+static unsigned long reqs_done;
+/** Number of failed requests */
+static unsigned long reqs_failed;
+/** Latencies of successful requests (microseconds) */
+static usec_t *latency;
+/** Number of running workers */
+static unsigned workers;
+
+static void print_usage(void);
+
+static usec_t uptime_usec(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+/** Receive one character (with buffering).
+ *
+ * @return EOK on success, ENOENT if the peer closed the connection or
+ *         other error code
+ */
+static errno_t recv_char(worker_t *w, char *c)
+{
+	size_t nrecv;
+	errno_t rc;
+
+	if (w->rbuf_out == w->rbuf_in) {
+		w->rbuf_out = 0;
+		w->rbuf_in = 0;
+
+		rc = tcp_conn_recv_wait(w->conn, w->rbuf, RECV_BUF_SIZE,
+		    &nrecv);
+		if (rc != EOK)
+			return rc;
+
+		if (nrecv == 0)
+			return ENOENT;
+
+		w->rbuf_in = nrecv;
+	}
+
+	*c = w->rbuf[w->rbuf_out++];
+	return EOK;
+}
+
+/** Receive one response header line with length limit. */
+static errno_t recv_line(worker_t *w, char **rline)
+{
+	char *bp = w->lbuf;
+	char c = '\0';
+
+	while (bp < w->lbuf + LINE_SIZE) {
+		char prev = c;
+		errno_t rc = recv_char(w, &c);
+
+		if (rc != EOK)
+			return rc;
+
+		*bp++ = c;
+		if ((prev == '\r') && (c == '\n'))
+			break;
+	}
+
+	*bp = '\0';
+
+	if (bp == w->lbuf + LINE_SIZE)
+		return ELIMIT;
+
+	*rline = w->lbuf;
+	return EOK;
+}
+
+/** Receive and discard response body.
+ *
+ * @param w      Worker
+ * @param length Body length or @c UINT64_MAX to read until end of stream
+ */
+static errno_t recv_body(worker_t *w, uint64_t length)
+{
+	bool to_eof = length == UINT64_MAX;
+	size_t nrecv;
+	size_t n;
+	errno_t rc;
+
+	n = w->rbuf_in - w->rbuf_out;
+	if (!to_eof && n > length)
+		n = length;
+	w->rbuf_out += n;
+	if (!to_eof)
+		length -= n;
+
+	while (to_eof || length > 0) {
+		rc = tcp_conn_recv_wait(w->conn, w->rbuf, RECV_BUF_SIZE,
+		    &nrecv);
+		if (rc != EOK)
+			return rc;
+
+		if (nrecv == 0)
+			return to_eof ? EOK : EIO;
+
+		n = nrecv;
+		if (!to_eof) {
+			if (n > length)
+				n = length;
+			length -= n;
+		}
+
+		/* Keep data beyond the body for the next response */
+		w->rbuf_out = n;
+		w->rbuf_in = nrecv;
+	}
+
+	return EOK;
+}
+
+/** Receive one response.
+ *
+ * @param w      Worker
+ * @param rclose Place to store @c true if the server closes the connection
+ */
+static errno_t recv_response(worker_t *w, bool *rclose)
+{
+	uint64_t length = UINT64_MAX;
+	char *line;
+	char *val;
+	errno_t rc;
+
+	rc = recv_line(w, &line);
+	if (rc != EOK)
+		return rc;
+
+	if (str_lcmp(line, "HTTP/", 5) != 0)
+		return EIO;
+
+	val = str_chr(line, ' ');
+	if (val == NULL || str_lcmp(val + 1, "200", 3) != 0)
+		return EIO;
+
+	*rclose = str_lcmp(line, "HTTP/1.1", 8) != 0;
+
+	while (true) {
+		rc = recv_line(w, &line);
+		if (rc != EOK)
+			return rc;
+
+		if (str_cmp(line, "\r\n") == 0)
+			break;
+
+		if (str_lcasecmp(line, "Content-Length:", 15) == 0) {
+			rc = str_uint64_t(line + 15, NULL, 10, false, &length);
+			if (rc != EOK)
+				return EIO;
+		} else if (str_lcasecmp(line, "Connection:", 11) == 0) {
+			val = line + 11;
+			while (*val == ' ')
+				++val;
+
+			if (str_lcasecmp(val, "close", 5) == 0)
+				*rclose = true;
+			else if (str_lcasecmp(val, "keep-alive", 10) == 0)
+				*rclose = false;
+		}
+	}
+
+	if (length == UINT64_MAX)
+		*rclose = true;
+
+	return recv_body(w, length);
+}
+
+/** Send one request and receive the response.
+ *
+ * @param w Worker
+ */
+static errno_t do_request(worker_t *w)
+{
+	bool rclose = true;
+	errno_t rc;
+
+	if (w->conn == NULL) {
+		rc = tcp_conn_create(tcp, &epp, &conn_cb, NULL, &w->conn);
+		if (rc != EOK)
+			return rc;
+
+		rc = tcp_conn_wait_connected(w->conn);
+		if (rc != EOK)
+			goto close;
+
+		w->rbuf_out = 0;
+		w->rbuf_in = 0;
+	}
+
+	rc = tcp_conn_send(w->conn, request, str_size(request));
+	if (rc != EOK)
+		goto close;
+
+	rc = recv_response(w, &rclose);
+	if (rc != EOK)
+		goto close;
+
+	if (keep_alive && !rclose)
+		return EOK;
+close:
+	tcp_conn_destroy(w->conn);
+	w->conn = NULL;
+	return rc;
+}
+
+/** Load generating fibril.
+ *
+ * @param arg Not used
+ */
+static errno_t worker_fibril(void *arg)
+{
+	worker_t *w;
+	usec_t start;
+	usec_t end;
+	errno_t rc;
+
+	w = calloc(1, sizeof(worker_t));
+
+	fibril_mutex_lock(&bench_lock);
+
+	while (w != NULL && reqs_started < nreqs) {
+		++reqs_started;
+		fibril_mutex_unlock(&bench_lock);
+
+		start = uptime_usec();
+		rc = do_request(w);
+		end = uptime_usec();
+
+		fibril_mutex_lock(&bench_lock);
+		if (rc == EOK)
+			latency[reqs_done++] = end - start;
+		else
+			++reqs_failed;
+	}
+
+	--workers;
+	fibril_mutex_unlock(&bench_lock);
+	fibril_condvar_broadcast(&bench_cv);
+
+	if (w != NULL && w->conn != NULL)
+		tcp_conn_destroy(w->conn);
+	free(w);
+	return EOK;
+}
+
+static int usec_cmp(const void *a, const void *b)
+{
+	usec_t ua = *(const usec_t *) a;
+	usec_t ub = *(const usec_t *) b;
+
+	return (ua > ub) - (ua < ub);
+}
+
+/** Get latency percentile.
+ *
+ * @param pct Percentile
+ * @return Latency (microseconds) at or below which @a pct percent of
+ *         successful requests completed
+ */
+static usec_t percentile(unsigned pct)
+{
+	size_t idx;
+
+	idx = (reqs_done * pct + 99) / 100;
+	if (idx > 0)
+		--idx;
+
+	return latency[idx];
+}
+
+static void print_results(usec_t elapsed)
+{
+	printf("Requests: %lu completed, %lu failed\n", reqs_done,
+	    reqs_failed);
+	printf("Time: %lld.%03lld s\n", elapsed / 1000000,
+	    elapsed / 1000 % 1000);
+
+	if (elapsed > 0) {
+		printf("Requests/s: %" PRIu64 "\n",
+		    (uint64_t) reqs_done * 1000000 / (uint64_t) elapsed);
+	}
+
+	if (reqs_done == 0)
+		return;
+
+	qsort(latency, reqs_done, sizeof(usec_t), usec_cmp);
+
+	printf("Latency (us): min %lld p50 %lld p99 %lld max %lld\n",
+	    latency[0], percentile(50), percentile(99),
+	    latency[reqs_done - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long nconns = DEFAULT_CONNS;
+	const char *path = "/";
+	const char *errmsg;
+	char *hostport;
+	usec_t start;
+	int optres, errflg = 0;
+	errno_t rc;
+
+	/* Parse command-line options */
+	while ((optres = getopt(argc, argv, "c:n:Ch")) != -1) {
+		switch (optres) {
+		case 'h':
+			print_usage();
+			return 0;
+
+		case 'c':
+			nconns = strtoul(optarg, NULL, 10);
+			if (nconns == 0) {
+				fprintf(stderr, "Invalid connection count '%s'\n",
+				    optarg);
+				errflg++;
+			}
+			break;
+
+		case 'n':
+			nreqs = strtoul(optarg, NULL, 10);
+			if (nreqs == 0) {
+				fprintf(stderr, "Invalid request count '%s'\n",
+				    optarg);
+				errflg++;
+			}
+			break;
+
+		case 'C':
+			keep_alive = false;
+			break;
+
+		case '?':
+			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
+			errflg++;
+			break;
+
+		default:
+			fprintf(stderr,
+			    "Unknown error while parsing command line options");
+			errflg++;
+			break;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "Missing host:port\n");
+		errflg++;
+	} else if (argc - optind > 2) {
+		fprintf(stderr, "Too many input parameters\n");
+		errflg++;
+	}
+
+	if (errflg) {
+		print_usage();
+		return 1;
+	}
+
+	hostport = argv[optind];
+	if (argc - optind == 2)
+		path = argv[optind + 1];
+
+	inet_ep2_init(&epp);
+	rc = inet_hostport_plookup_one(hostport, ip_any, &epp.remote, NULL,
+	    &errmsg);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: %s (host:port %s).\n", NAME, errmsg,
+		    hostport);
+		return 1;
+	}
+
+	if (asprintf(&request, "GET %s HTTP/1.1\r\n"
+	    "Host: %s\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n", path, hostport, keep_alive ? "keep-alive" : "close") < 0) {
+		fprintf(stderr, "%s: Out of memory.\n", NAME);
+		return 1;
+	}
+
+	latency = calloc(nreqs, sizeof(usec_t));
+	if (latency == NULL) {
+		fprintf(stderr, "%s: Out of memory.\n", NAME);
+		return 1;
+	}
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Error connecting to TCP service (%s).\n",
+		    NAME, str_error(rc));
+		return 1;
+	}
+
+	start = uptime_usec();
+
+	fibril_mutex_lock(&bench_lock);
+	for (unsigned long i = 0; i < nconns; i++) {
+		fid_t fid = fibril_create(worker_fibril, NULL);
+		if (fid == 0)
+			break;
+
+		++workers;
+		fibril_add_ready(fid);
+	}
+
+	while (workers > 0)
+		fibril_condvar_wait(&bench_cv, &bench_lock);
+	fibril_mutex_unlock(&bench_lock);
+
+	print_results(uptime_usec() - start);
+
+	tcp_destroy(tcp);
+	free(latency);
+	free(request);
+	return reqs_failed == 0 ? 0 : 1;
+}
+
+static void print_usage(void)
+{
+	printf("Syntax: %s [<options>] <host>:<port> [<path>]\n", NAME);
+	printf("Options:\n");
+	printf("  -h          Print help\n");
+	printf("  -c <conns>  Number of concurrent connections (default %d)\n",
+	    DEFAULT_CONNS);
+	printf("  -n <reqs>   Total number of requests (default %d)\n",
+	    DEFAULT_REQS);
+	printf("  -C          Open a new connection for each request\n");
+}
+
+/** @}
+ */
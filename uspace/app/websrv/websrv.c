@@ -35,6 +35,8 @@
 
 #include <errno.h>
 #include <assert.h>
+#include <fibril_synch.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -57,10 +59,16 @@
 
 #define DEFAULT_PORT  8080
 
+/** Default maximum number of connections served concurrently */
+#define DEFAULT_MAX_CONNS  16
+
+/** Maximum number of requests served over one persistent connection */
+#define KEEPALIVE_MAX_REQS  100
+
 #define WEB_ROOT  "/data/web"
 
 /** Buffer for receiving the request. */
-#define BUFFER_SIZE  1024
+#define BUFFER_SIZE  4096
 
 static void websrv_new_conn(tcp_listener_t *, tcp_conn_t *);
 
@@ -73,6 +81,16 @@ static tcp_cb_t conn_cb = {
 };
 
 static uint16_t port = DEFAULT_PORT;
+static size_t max_conns = DEFAULT_MAX_CONNS;
+
+/** Protects @c conns_active and @c conns_waiting */
+static FIBRIL_MUTEX_INITIALIZE(conns_lock);
+/** Signalled when a connection finishes */
+static FIBRIL_CONDVAR_INITIALIZE(conns_cv);
+/** Number of connections being served */
+static size_t conns_active;
+/** Number of connections waiting to be served */
+static size_t conns_waiting;
 
 typedef struct {
 	tcp_conn_t *conn;
@@ -89,13 +107,12 @@ static bool verbose = false;
 
 /** Responses to send to client. */
 
-static const char *msg_ok =
-    "HTTP/1.0 200 OK\r\n"
-    "\r\n";
+static const char *status_ok = "200 OK";
+static const char *status_bad_request = "400 Bad Request";
+static const char *status_not_found = "404 Not Found";
+static const char *status_not_implemented = "501 Not Implemented";
 
 static const char *msg_bad_request =
-    "HTTP/1.0 400 Bad Request\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>400 Bad Request</title>\r\n"
@@ -107,8 +124,6 @@ static const char *msg_bad_request =
     "</html>\r\n";
 
 static const char *msg_not_found =
-    "HTTP/1.0 404 Not Found\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>404 Not Found</title>\r\n"
@@ -120,8 +135,6 @@ static const char *msg_not_found =
     "</html>\r\n";
 
 static const char *msg_not_implemented =
-    "HTTP/1.0 501 Not Implemented\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>501 Not Implemented</title>\r\n"
@@ -154,7 +167,11 @@ static void recv_destroy(recv_t *recv)
 	free(recv);
 }
 
-/** Receive one character (with buffering) */
+/** Receive one character (with buffering)
+ *
+ * @return EOK on success, ENOENT if the peer closed the connection or
+ *         other error code
+ */
 static errno_t recv_char(recv_t *recv, char *c)
 {
 	size_t nrecv;
@@ -170,6 +187,9 @@ static errno_t recv_char(recv_t *recv, char *c)
 			return rc;
 		}
 
+		if (nrecv == 0)
+			return ENOENT;
+
 		recv->rbuf_in = nrecv;
 	}
 
@@ -224,14 +244,63 @@ static bool uri_is_valid(char *uri)
 	return true;
 }
 
-static errno_t send_response(tcp_conn_t *conn, const char *msg)
+/** Send response with a message body.
+ *
+ * @param conn       Connection
+ * @param status     Status code and reason phrase
+ * @param body       Message body
+ * @param keep_alive @c true to keep the connection open after the response
+ */
+static errno_t send_response(tcp_conn_t *conn, const char *status,
+    const char *body, bool keep_alive)
 {
-	size_t response_size = str_size(msg);
+	char *msg;
+	int rv;
 
 	if (verbose)
 		fprintf(stderr, "Sending response\n");
 
-	errno_t rc = tcp_conn_send(conn, (void *) msg, response_size);
+	rv = asprintf(&msg, "HTTP/1.1 %s\r\n"
+	    "Content-Length: %zu\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n"
+	    "%s", status, str_size(body),
+	    keep_alive ? "keep-alive" : "close", body);
+	if (rv < 0)
+		return ENOMEM;
+
+	errno_t rc = tcp_conn_send(conn, msg, rv);
+	free(msg);
+	if (rc != EOK) {
+		fprintf(stderr, "tcp_conn_send() failed\n");
+		return rc;
+	}
+
+	return EOK;
+}
+
+/** Send response header.
+ *
+ * @param conn       Connection
+ * @param status     Status code and reason phrase
+ * @param length     Length of the message body that follows
+ * @param keep_alive @c true to keep the connection open after the response
+ */
+static errno_t send_header(tcp_conn_t *conn, const char *status,
+    aoff64_t length, bool keep_alive)
+{
+	char *hdr;
+	int rv;
+
+	rv = asprintf(&hdr, "HTTP/1.1 %s\r\n"
+	    "Content-Length: %" PRIu64 "\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n", status, length, keep_alive ? "keep-alive" : "close");
+	if (rv < 0)
+		return ENOMEM;
+
+	errno_t rc = tcp_conn_send(conn, hdr, rv);
+	free(hdr);
 	if (rc != EOK) {
 		fprintf(stderr, "tcp_conn_send() failed\n");
 		return rc;
@@ -240,20 +309,15 @@ static errno_t send_response(tcp_conn_t *conn, const char *msg)
 	return EOK;
 }
 
-static errno_t uri_get(const char *uri, tcp_conn_t *conn)
+static errno_t uri_get(const char *uri, tcp_conn_t *conn, bool keep_alive)
 {
-	char *fbuf = NULL;
 	char *fname = NULL;
+	vfs_stat_t st;
+	aoff64_t pos;
+	aoff64_t nsent;
 	errno_t rc;
-	size_t nr;
 	int fd = -1;
 
-	fbuf = calloc(BUFFER_SIZE, 1);
-	if (fbuf == NULL) {
-		rc = ENOMEM;
-		goto out;
-	}
-
 	if (str_cmp(uri, "/") == 0)
 		uri = "/index.html";
 
@@ -264,31 +328,34 @@ static errno_t uri_get(const char *uri, tcp_conn_t *conn)
 
 	rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ, &fd);
 	if (rc != EOK) {
-		rc = send_response(conn, msg_not_found);
+		rc = send_response(conn, status_not_found, msg_not_found,
+		    keep_alive);
 		goto out;
 	}
 
 	free(fname);
 	fname = NULL;
 
-	rc = send_response(conn, msg_ok);
+	rc = vfs_stat(fd, &st);
 	if (rc != EOK)
 		goto out;
 
-	aoff64_t pos = 0;
-	while (true) {
-		rc = vfs_read(fd, &pos, fbuf, BUFFER_SIZE, &nr);
-		if (rc != EOK)
-			goto out;
+	rc = send_header(conn, status_ok, st.size, keep_alive);
+	if (rc != EOK)
+		goto out;
 
-		if (nr == 0)
-			break;
+	/* File data goes to the TCP service without an intermediate copy */
+	pos = 0;
+	rc = tcp_conn_send_file(conn, fd, &pos, st.size, &nsent);
+	if (rc != EOK) {
+		fprintf(stderr, "tcp_conn_send_file() failed\n");
+		goto out;
+	}
 
-		rc = tcp_conn_send(conn, fbuf, nr);
-		if (rc != EOK) {
-			fprintf(stderr, "tcp_conn_send() failed\n");
-			goto out;
-		}
+	/* File was truncated, we cannot satisfy Content-Length */
+	if (nsent != st.size) {
+		rc = EIO;
+		goto out;
 	}
 
 	rc = EOK;
@@ -296,45 +363,154 @@ out:
 	if (fd >= 0)
 		vfs_put(fd);
 	free(fname);
-	free(fbuf);
 	return rc;
 }
 
-static errno_t req_process(tcp_conn_t *conn, recv_t *recv)
+/** Receive and process one request.
+ *
+ * @param conn       Connection
+ * @param recv       Receive buffer
+ * @param keep_alive On entry @c true if the connection may be kept open,
+ *                   on exit @c true if it should be kept open
+ *
+ * @return EOK on success, ENOENT if the peer closed the connection before
+ *         sending a request or other error code
+ */
+static errno_t req_process(tcp_conn_t *conn, recv_t *recv, bool *keep_alive)
 {
 	char *reqline = NULL;
+	char *line;
+	char *uri = NULL;
+	char *end_uri;
+	char *sp;
+	bool has_headers;
+	bool is_get;
+	bool ka;
 
 	errno_t rc = recv_line(recv, &reqline);
 	if (rc != EOK) {
-		fprintf(stderr, "recv_line() failed\n");
+		if (rc != ENOENT)
+			fprintf(stderr, "recv_line() failed\n");
 		return rc;
 	}
 
 	if (verbose)
 		fprintf(stderr, "Request: %s", reqline);
 
-	if (str_lcmp(reqline, "GET ", 4) != 0) {
-		rc = send_response(conn, msg_not_implemented);
-		return rc;
+	sp = str_chr(reqline, ' ');
+	if (sp == NULL) {
+		*keep_alive = false;
+		return send_response(conn, status_bad_request,
+		    msg_bad_request, false);
 	}
 
-	char *uri = reqline + 4;
-	char *end_uri = str_chr(uri, ' ');
+	*sp = '\0';
+	is_get = str_cmp(reqline, "GET") == 0;
+
+	end_uri = str_chr(sp + 1, ' ');
 	if (end_uri == NULL) {
-		end_uri = reqline + str_size(reqline) - 2;
+		/* Simple request (HTTP/0.9) has no headers */
+		end_uri = sp + 1 + str_size(sp + 1) - 2;
 		assert(*end_uri == '\r');
+		has_headers = false;
+		ka = false;
+	} else {
+		/* HTTP/1.1 connections are persistent by default */
+		has_headers = true;
+		ka = str_lcmp(end_uri + 1, "HTTP/1.1", 8) == 0;
 	}
 
 	*end_uri = '\0';
 	if (verbose)
-		fprintf(stderr, "Requested URI: %s\n", uri);
+		fprintf(stderr, "Requested URI: %s\n", sp + 1);
+
+	/* Header lines reuse the line buffer */
+	uri = str_dup(sp + 1);
+	if (uri == NULL)
+		return ENOMEM;
+
+	while (has_headers) {
+		rc = recv_line(recv, &line);
+		if (rc != EOK) {
+			fprintf(stderr, "recv_line() failed\n");
+			goto out;
+		}
+
+		if (str_cmp(line, "\r\n") == 0)
+			break;
+
+		if (str_lcasecmp(line, "Connection:", 11) == 0) {
+			line += 11;
+			while (*line == ' ' || *line == '\t')
+				++line;
+
+			if (str_lcasecmp(line, "close", 5) == 0)
+				ka = false;
+			else if (str_lcasecmp(line, "keep-alive", 10) == 0)
+				ka = true;
+		}
+	}
+
+	*keep_alive = *keep_alive && ka;
+
+	if (!is_get) {
+		rc = send_response(conn, status_not_implemented,
+		    msg_not_implemented, *keep_alive);
+		goto out;
+	}
 
 	if (!uri_is_valid(uri)) {
-		rc = send_response(conn, msg_bad_request);
-		return rc;
+		rc = send_response(conn, status_bad_request, msg_bad_request,
+		    *keep_alive);
+		goto out;
 	}
 
-	return uri_get(uri, conn);
+	rc = uri_get(uri, conn, *keep_alive);
+out:
+	free(uri);
+	return rc;
+}
+
+/** Wait until the connection can be served. */
+static void conn_slot_get(void)
+{
+	fibril_mutex_lock(&conns_lock);
+
+	++conns_waiting;
+	while (conns_active >= max_conns)
+		fibril_condvar_wait(&conns_cv, &conns_lock);
+	--conns_waiting;
+
+	++conns_active;
+	fibril_mutex_unlock(&conns_lock);
+}
+
+/** Let another connection be served. */
+static void conn_slot_put(void)
+{
+	fibril_mutex_lock(&conns_lock);
+	--conns_active;
+	fibril_mutex_unlock(&conns_lock);
+	fibril_condvar_signal(&conns_cv);
+}
+
+/** Determine whether a connection may be kept open after a request.
+ *
+ * Persistent connections are closed when other connections are waiting
+ * so that idle clients do not hold up the bounded set of served
+ * connections.
+ *
+ * @param nreqs Number of requests already served over the connection
+ */
+static bool conn_may_keep(unsigned nreqs)
+{
+	bool may_keep;
+
+	fibril_mutex_lock(&conns_lock);
+	may_keep = conns_waiting == 0 && nreqs + 1 < KEEPALIVE_MAX_REQS;
+	fibril_mutex_unlock(&conns_lock);
+
+	return may_keep;
 }
 
 static void usage(void)
@@ -347,6 +523,10 @@ static void usage(void)
 	    "-p port_number | --port=port_number\n"
 	    "\tListening port (default " STRING(DEFAULT_PORT) ").\n"
 	    "\n"
+	    "-c count | --max-conn=count\n"
+	    "\tMaximum number of connections served at the same time\n"
+	    "\t(default " STRING(DEFAULT_MAX_CONNS) ").\n"
+	    "\n"
 	    "-h | --help\n"
 	    "\tShow this application help.\n"
 	    "-v | --verbose\n"
@@ -363,6 +543,15 @@ static errno_t parse_option(int argc, char *argv[], int *index)
 		usage();
 		exit(0);
 		break;
+	case 'c':
+		rc = arg_parse_int(argc, argv, index, &value, 0);
+		if (rc != EOK)
+			return rc;
+		if (value <= 0)
+			return EINVAL;
+
+		max_conns = (size_t) value;
+		break;
 	case 'p':
 		rc = arg_parse_int(argc, argv, index, &value, 0);
 		if (rc != EOK)
@@ -384,6 +573,14 @@ static errno_t parse_option(int argc, char *argv[], int *index)
 				return rc;
 
 			port = (uint16_t) value;
+		} else if (str_lcmp(argv[*index] + 2, "max-conn=", 9) == 0) {
+			rc = arg_parse_int(argc, argv, index, &value, 11);
+			if (rc != EOK)
+				return rc;
+			if (value <= 0)
+				return EINVAL;
+
+			max_conns = (size_t) value;
 		} else if (str_cmp(argv[*index] + 2, "verbose") == 0) {
 			verbose = true;
 		} else {
@@ -403,6 +600,10 @@ static void websrv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 {
 	errno_t rc;
 	recv_t *recv = NULL;
+	unsigned nreqs;
+	bool keep_alive;
+
+	conn_slot_get();
 
 	if (verbose)
 		fprintf(stderr, "New connection, waiting for request\n");
@@ -413,12 +614,24 @@ static void websrv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 		goto error;
 	}
 
-	rc = req_process(conn, recv);
-	if (rc != EOK) {
-		fprintf(stderr, "Error processing request (%s)\n",
-		    str_error(rc));
-		goto error;
-	}
+	nreqs = 0;
+	do {
+		keep_alive = conn_may_keep(nreqs);
+
+		rc = req_process(conn, recv, &keep_alive);
+		if (rc == ENOENT && nreqs > 0) {
+			/* Client closed persistent connection */
+			break;
+		}
+
+		if (rc != EOK) {
+			fprintf(stderr, "Error processing request (%s)\n",
+			    str_error(rc));
+			goto error;
+		}
+
+		++nreqs;
+	} while (keep_alive);
 
 	rc = tcp_conn_send_fin(conn);
 	if (rc != EOK) {
@@ -427,6 +640,7 @@ static void websrv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 	}
 
 	recv_destroy(recv);
+	conn_slot_put();
 	return;
 error:
 	rc = tcp_conn_reset(conn);
@@ -434,6 +648,7 @@ error:
 		fprintf(stderr, "Error resetting connection.\n");
 
 	recv_destroy(recv);
+	conn_slot_put();
 }
 
 int main(int argc, char *argv[])
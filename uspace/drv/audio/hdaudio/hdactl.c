@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <fibril_synch.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdint.h>
 
 #include "codec.h"
@@ -241,6 +242,53 @@ static void hda_corb_fini(hda_t *hda)
 		dmamem_unmap_anonymous(hda->ctl->corb_virt);
 }
 
+/** Initialize the DMA position buffer
+ *
+ * The controller keeps writing positions of all streams to the buffer,
+ * which lets clients follow a stream without reading registers.
+ */
+static errno_t hda_dmapos_init(hda_t *hda)
+{
+	size_t nsdesc;
+	void *dmapos;
+	errno_t rc;
+
+	ddf_msg(LVL_DEBUG, "hda_dmapos_init()");
+
+	/*
+	 * Position buffer must be aligned to 128 bytes. If 64OK is not set,
+	 * it must be within the 32-bit address space.
+	 */
+	nsdesc = hda->ctl->iss + hda->ctl->oss + hda->ctl->bss;
+	dmapos = AS_AREA_ANY;
+	rc = dmamem_map_anonymous(nsdesc * sizeof(hda_dma_pos_t),
+	    hda->ctl->ok64bit ? 0 : DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE, 0,
+	    &hda->ctl->dmapos_phys, &dmapos);
+	if (rc != EOK) {
+		ddf_msg(LVL_WARN, "Failed allocating DMA position buffer");
+		return rc;
+	}
+
+	memset(dmapos, 0, nsdesc * sizeof(hda_dma_pos_t));
+	hda->ctl->dmapos = dmapos;
+
+	hda_reg32_write(&hda->regs->dpubase, UPPER32(hda->ctl->dmapos_phys));
+	hda_reg32_write(&hda->regs->dplbase, LOWER32(hda->ctl->dmapos_phys) |
+	    BIT_V(uint32_t, dplbase_enable));
+	return EOK;
+}
+
+/** Tear down the DMA position buffer */
+static void hda_dmapos_fini(hda_t *hda)
+{
+	if (hda->ctl->dmapos == NULL)
+		return;
+
+	hda_reg32_write(&hda->regs->dplbase, 0);
+	dmamem_unmap_anonymous((void *) hda->ctl->dmapos);
+	hda->ctl->dmapos = NULL;
+}
+
 /** Initialize the RIRB */
 static errno_t hda_rirb_init(hda_t *hda)
 {
@@ -599,6 +647,9 @@ hda_ctl_t *hda_ctl_init(hda_t *hda)
 	if (rc != EOK)
 		goto error;
 
+	/* Streams work without it, only position queries are lost */
+	(void) hda_dmapos_init(hda);
+
 	ddf_msg(LVL_DEBUG, "call hda_codec_init()");
 	hda->ctl->codec = hda_codec_init(hda, 0);
 	if (hda->ctl->codec == NULL) {
@@ -612,6 +663,7 @@ hda_ctl_t *hda_ctl_init(hda_t *hda)
 
 	return ctl;
 error:
+	hda_dmapos_fini(hda);
 	hda_rirb_fini(hda);
 	hda_corb_fini(hda);
 	free(ctl);
@@ -622,6 +674,7 @@ error:
 void hda_ctl_fini(hda_ctl_t *ctl)
 {
 	ddf_msg(LVL_DEBUG, "hda_ctl_fini()");
+	hda_dmapos_fini(ctl->hda);
 	hda_rirb_fini(ctl->hda);
 	hda_corb_fini(ctl->hda);
 	free(ctl);
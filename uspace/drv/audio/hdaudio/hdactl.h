@@ -70,6 +70,10 @@ typedef struct hda_ctl {
 	size_t unsolrb_rp;
 	size_t unsolrb_wp;
 
+	/** DMA position buffer, one entry per stream descriptor */
+	uintptr_t dmapos_phys;
+	volatile hda_dma_pos_t *dmapos;
+
 	struct hda_codec *codec;
 	struct hda *hda;
 } hda_ctl_t;
@@ -35,6 +35,7 @@
 #include <assert.h>
 #include <bitops.h>
 #include <ddi.h>
+#include <rtsched.h>
 #include <device/hw_res.h>
 #include <device/hw_res_parsed.h>
 #include <stdio.h>
@@ -51,6 +52,13 @@
 
 #define NAME "hdaudio"
 
+/** Real-time priority of the driver thread handling stream interrupts */
+#define HDA_RT_PRIO  (RT_PRIO_MAX - 8)
+/** Real-time budget of the driver thread in microseconds per period */
+#define HDA_RT_BUDGET  1000
+/** Real-time period of the driver thread in microseconds */
+#define HDA_RT_PERIOD  10000
+
 static errno_t hda_dev_add(ddf_dev_t *dev);
 static errno_t hda_dev_remove(ddf_dev_t *dev);
 static errno_t hda_dev_gone(ddf_dev_t *dev);
@@ -387,17 +395,11 @@ static void hdaudio_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 	if (ipc_get_arg3(icall) != 0) {
 		/* Buffer completed */
 		hda_lock(hda);
-		if (hda->playing) {
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
+		/* Each BDL entry holds exactly one requested fragment */
+		if (hda->playing)
 			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_PLAYED);
-		} else if (hda->capturing) {
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
+		else if (hda->capturing)
 			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-			hda_pcm_event(hda, PCM_EVENT_FRAMES_CAPTURED);
-		}
 
 		hda_unlock(hda);
 	}
@@ -417,6 +419,15 @@ int main(int argc, char *argv[])
 {
 	printf(NAME ": High Definition Audio driver\n");
 	ddf_log_init(NAME);
+
+	/* Buffer completion interrupts should not wait for other tasks */
+	errno_t rc = thread_set_realtime(HDA_RT_PRIO, HDA_RT_BUDGET,
+	    HDA_RT_PERIOD);
+	if (rc != EOK) {
+		ddf_msg(LVL_WARN, "Failed to enter real-time class: %s",
+		    str_error(rc));
+	}
+
 	return ddf_driver_main(&hda_driver);
 }
 
@@ -81,7 +81,9 @@ audio_pcm_iface_t hda_pcm_iface = {
 };
 
 enum {
-	max_buffer_size = 65536 /* XXX this is completely arbitrary */
+	max_buffer_size = 65536, /* XXX this is completely arbitrary */
+	/** Only 2 channels of 16-bit samples are supported */
+	frame_size = 4
 };
 
 static hda_t *fun_to_hda(ddf_fun_t *fun)
@@ -111,13 +113,13 @@ static unsigned hda_query_cap(ddf_fun_t *fun, audio_cap_t cap)
 		/* Yes if we have an input converter */
 		return hda->ctl->codec->in_aw >= 0;
 	case AUDIO_CAP_BUFFER_POS:
-		return 0;
+		return hda->ctl->dmapos != NULL;
 	case AUDIO_CAP_MAX_BUFFER:
 		return max_buffer_size;
 	case AUDIO_CAP_INTERRUPT_MIN_FRAMES:
-		return 128;
+		return max_buffer_size / bdl_max_entries / frame_size;
 	case AUDIO_CAP_INTERRUPT_MAX_FRAMES:
-		return 16384;
+		return max_buffer_size / bdl_min_entries / frame_size;
 	default:
 		return -1;
 	}
@@ -163,7 +165,7 @@ static errno_t hda_get_buffer(ddf_fun_t *fun, void **buffer, size_t *size)
 	}
 
 	ddf_msg(LVL_DEBUG, "hda_get_buffer() - allocate stream buffers");
-	rc = hda_stream_buffers_alloc(hda, &hda->pcm_buffers);
+	rc = hda_stream_buffers_alloc(hda, max_buffer_size, &hda->pcm_buffers);
 	if (rc != EOK) {
 		assert(rc == ENOMEM);
 		hda_unlock(hda);
@@ -171,9 +173,8 @@ static errno_t hda_get_buffer(ddf_fun_t *fun, void **buffer, size_t *size)
 	}
 
 	ddf_msg(LVL_DEBUG, "hda_get_buffer() - fill info");
-	/* XXX This is only one buffer */
-	*buffer = hda->pcm_buffers->buf[0];
-	*size = hda->pcm_buffers->bufsize * hda->pcm_buffers->nbuffers;
+	*buffer = hda->pcm_buffers->base;
+	*size = hda->pcm_buffers->size;
 
 	ddf_msg(LVL_DEBUG, "hda_get_buffer() returing EOK, buffer=%p, size=%zu",
 	    *buffer, *size);
@@ -184,8 +185,39 @@ static errno_t hda_get_buffer(ddf_fun_t *fun, void **buffer, size_t *size)
 
 static errno_t hda_get_buffer_position(ddf_fun_t *fun, size_t *pos)
 {
-	ddf_msg(LVL_DEBUG, "hda_get_buffer_position()");
-	return ENOTSUP;
+	hda_t *hda = fun_to_hda(fun);
+	errno_t rc;
+
+	hda_lock(hda);
+	if (hda->pcm_stream == NULL) {
+		hda_unlock(hda);
+		return EINVAL;
+	}
+
+	rc = hda_stream_get_position(hda->pcm_stream, pos);
+	hda_unlock(hda);
+	return rc;
+}
+
+/** Lay out stream buffers for the requested fragment size.
+ *
+ * @param hda HDA instance
+ * @param frames Fragment size in frames, zero to run without interrupts
+ * @return EOK on success, EINVAL if the fragment size is not supported
+ */
+static errno_t hda_set_fragments(hda_t *hda, unsigned frames)
+{
+	hda_stream_buffers_t *bufs = hda->pcm_buffers;
+
+	if (bufs == NULL)
+		return EINVAL;
+
+	/* Clients polling the position need no interrupts at all */
+	if (frames == 0)
+		return hda_stream_buffers_split(bufs,
+		    bufs->size / bdl_min_entries, false);
+
+	return hda_stream_buffers_split(bufs, frames * frame_size, true);
 }
 
 static errno_t hda_set_event_session(ddf_fun_t *fun, async_sess_t *sess)
@@ -247,6 +279,14 @@ static errno_t hda_start_playback(ddf_fun_t *fun, unsigned frames,
 		return EBUSY;
 	}
 
+	rc = hda_set_fragments(hda, frames);
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "Unsupported fragment size %u frames",
+		    frames);
+		hda_unlock(hda);
+		return rc;
+	}
+
 	/* XXX Choose appropriate parameters */
 	uint32_t fmt;
 	/* 48 kHz, 16-bits, 1 channel */
@@ -306,6 +346,14 @@ static errno_t hda_start_capture(ddf_fun_t *fun, unsigned frames, unsigned chann
 		return EBUSY;
 	}
 
+	rc = hda_set_fragments(hda, frames);
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "Unsupported fragment size %u frames",
+		    frames);
+		hda_unlock(hda);
+		return rc;
+	}
+
 	/* XXX Choose appropriate parameters */
 	uint32_t fmt;
 	/* 48 kHz, 16-bits, 1 channel */
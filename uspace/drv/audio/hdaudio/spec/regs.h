@@ -281,6 +281,20 @@ typedef enum {
 	rirbctl_int = 0
 } hda_rirbctl_bits_t;
 
+/** DMA Position Buffer Lower Base bits */
+typedef enum {
+	/** DMA Position Buffer Enable */
+	dplbase_enable = 0
+} hda_dplbase_bits_t;
+
+/** DMA Position Buffer entry */
+typedef struct {
+	/** Stream Descriptor Link Position in Current Buffer */
+	uint32_t pos;
+	/** Reserved */
+	uint32_t reserved;
+} hda_dma_pos_t;
+
 typedef enum {
 	/** Response Overrun Interrupt Status */
 	rirbsts_ois = 2,
@@ -48,14 +48,19 @@
 #include "spec/bdl.h"
 #include "stream.h"
 
-errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
+/** Allocate stream buffers.
+ *
+ * @param hda HDA instance
+ * @param size Total size of the buffers
+ * @param rbufs Place to store pointer to the new buffers
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t hda_stream_buffers_alloc(hda_t *hda, size_t size,
+    hda_stream_buffers_t **rbufs)
 {
 	void *bdl;
 	void *buffer;
-	uintptr_t buffer_phys;
 	hda_stream_buffers_t *bufs = NULL;
-	size_t i;
-	//size_t j, k;
 	errno_t rc;
 
 	bufs = calloc(1, sizeof(hda_stream_buffers_t));
@@ -64,15 +69,13 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 		goto error;
 	}
 
-	bufs->nbuffers = 4;
-	bufs->bufsize = 16384;
-
 	/*
 	 * BDL must be aligned to 128 bytes. If 64OK is not set,
-	 * it must be within the 32-bit address space.
+	 * it must be within the 32-bit address space. Allocate room
+	 * for the longest list so that it can be split freely later.
 	 */
 	bdl = AS_AREA_ANY;
-	rc = dmamem_map_anonymous(bufs->nbuffers * sizeof(hda_buffer_desc_t),
+	rc = dmamem_map_anonymous(bdl_max_entries * sizeof(hda_buffer_desc_t),
 	    hda->ctl->ok64bit ? 0 : DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE,
 	    0, &bufs->bdl_phys, &bdl);
 	if (rc != EOK)
@@ -80,67 +83,25 @@ errno_t hda_stream_buffers_alloc(hda_t *hda, hda_stream_buffers_t **rbufs)
 
 	bufs->bdl = bdl;
 
-	/* Allocate arrays of buffer pointers */
-
-	bufs->buf = calloc(bufs->nbuffers, sizeof(void *));
-	if (bufs->buf == NULL)
-		goto error;
-
-	bufs->buf_phys = calloc(bufs->nbuffers, sizeof(uintptr_t));
-	if (bufs->buf_phys == NULL)
-		goto error;
-
-	/* Allocate buffers */
-#if 0
-	for (i = 0; i < bufs->nbuffers; i++) {
-		buffer = AS_AREA_ANY;
-		rc = dmamem_map_anonymous(bufs->bufsize,
-		    bufs->hda->ctl->ok64bit ? 0 : DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE,
-		    0, &buffer_phys, &buffer);
-		if (rc != EOK)
-			goto error;
-
-		ddf_msg(LVL_DEBUG, "Stream buf phys=0x%llx virt=%p",
-		    (unsigned long long)buffer_phys, buffer);
-
-		bufs->buf[i] = buffer;
-		bufs->buf_phys[i] = buffer_phys;
-
-		k = 0;
-		for (j = 0; j < bufs->bufsize / 2; j++) {
-			int16_t *bp = bufs->buf[i];
-			bp[j] = (k > 128) ? -100 : 100;
-			++k;
-			if (k >= 256)
-				k = 0;
-		}
-	}
-#endif
 	/* audio_pcm_iface requires a single contiguous buffer */
 	buffer = AS_AREA_ANY;
-	rc = dmamem_map_anonymous(bufs->bufsize * bufs->nbuffers,
+	rc = dmamem_map_anonymous(size,
 	    hda->ctl->ok64bit ? 0 : DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE,
-	    0, &buffer_phys, &buffer);
+	    0, &bufs->base_phys, &buffer);
 	if (rc != EOK) {
 		ddf_msg(LVL_DEBUG, "dmamem_map_anon -> %s", str_error_name(rc));
 		goto error;
 	}
 
-	for (i = 0; i < bufs->nbuffers; i++) {
-		bufs->buf[i] = buffer + i * bufs->bufsize;
-		bufs->buf_phys[i] = buffer_phys + i * bufs->bufsize;
+	bufs->base = buffer;
+	bufs->size = size;
 
-		ddf_msg(LVL_DEBUG, "Stream buf phys=0x%llx virt=%p",
-		    (long long unsigned)(uintptr_t)bufs->buf[i],
-		    (void *)bufs->buf_phys[i]);
-	}
+	ddf_msg(LVL_DEBUG, "Stream buf phys=0x%llx virt=%p",
+	    (unsigned long long)bufs->base_phys, bufs->base);
 
-	/* Fill in BDL */
-	for (i = 0; i < bufs->nbuffers; i++) {
-		bufs->bdl[i].address = host2uint64_t_le(bufs->buf_phys[i]);
-		bufs->bdl[i].length = host2uint32_t_le(bufs->bufsize);
-		bufs->bdl[i].flags = BIT_V(uint32_t, bdf_ioc);
-	}
+	rc = hda_stream_buffers_split(bufs, size / bdl_min_entries, true);
+	if (rc != EOK)
+		goto error;
 
 	*rbufs = bufs;
 	return EOK;
@@ -154,10 +115,53 @@ void hda_stream_buffers_free(hda_stream_buffers_t *bufs)
 	if (bufs == NULL)
 		return;
 
-	/* XXX */
+	if (bufs->base != NULL)
+		dmamem_unmap_anonymous(bufs->base);
+	if (bufs->bdl != NULL)
+		dmamem_unmap_anonymous(bufs->bdl);
 	free(bufs);
 }
 
+/** Split stream buffers into equally sized BDL entries.
+ *
+ * Small buffers give low latency, large buffers without interrupt on
+ * completion let the client poll the stream position instead.
+ *
+ * @param bufs Stream buffers, not in use by any running stream
+ * @param bufsize Size of one buffer
+ * @param ioc @c true to interrupt on completion of each buffer
+ * @return EOK on success, EINVAL if @a bufsize does not fit the BDL
+ */
+errno_t hda_stream_buffers_split(hda_stream_buffers_t *bufs, size_t bufsize,
+    bool ioc)
+{
+	size_t i;
+
+	if (bufsize == 0 || bufs->size % bufsize != 0 ||
+	    bufsize % bdl_buf_align != 0)
+		return EINVAL;
+
+	if (bufs->size / bufsize < bdl_min_entries ||
+	    bufs->size / bufsize > bdl_max_entries)
+		return EINVAL;
+
+	bufs->nbuffers = bufs->size / bufsize;
+	bufs->bufsize = bufsize;
+	bufs->ioc = ioc;
+
+	/* Fill in BDL */
+	for (i = 0; i < bufs->nbuffers; i++) {
+		bufs->bdl[i].address = host2uint64_t_le(bufs->base_phys +
+		    i * bufsize);
+		bufs->bdl[i].length = host2uint32_t_le(bufsize);
+		bufs->bdl[i].flags = ioc ? BIT_V(uint32_t, bdf_ioc) : 0;
+	}
+
+	ddf_msg(LVL_DEBUG, "Stream BDL: %zu buffers of %zu bytes, ioc=%d",
+	    bufs->nbuffers, bufs->bufsize, ioc);
+	return EOK;
+}
+
 static void hda_stream_desc_configure(hda_stream_t *stream)
 {
 	hda_sdesc_regs_t *sdregs;
@@ -169,7 +173,7 @@ static void hda_stream_desc_configure(hda_stream_t *stream)
 	ctl3 = (stream->sid << 4);
 
 	/* Interrupt on buffer completion */
-	ctl1 = BIT_V(uint8_t, sdctl1_ioce);
+	ctl1 = bufs->ioc ? BIT_V(uint8_t, sdctl1_ioce) : 0;
 
 	sdregs = &stream->hda->regs->sdesc[stream->sdid];
 	hda_reg8_write(&sdregs->ctl3, ctl3);
@@ -281,5 +285,26 @@ void hda_stream_reset(hda_stream_t *stream)
 	hda_stream_desc_configure(stream);
 }
 
+/** Get current DMA position of a stream.
+ *
+ * The position is read from the DMA position buffer in memory, so it does
+ * not cost a register access.
+ *
+ * @param stream Stream
+ * @param pos Place to store offset in the cyclic buffer, in bytes
+ * @return EOK on success, ENOTSUP if there is no DMA position buffer
+ */
+errno_t hda_stream_get_position(hda_stream_t *stream, size_t *pos)
+{
+	hda_ctl_t *ctl = stream->hda->ctl;
+
+	if (ctl->dmapos == NULL)
+		return ENOTSUP;
+
+	*pos = uint32_t_le2host(ctl->dmapos[stream->sdid].pos) %
+	    stream->buffers->size;
+	return EOK;
+}
+
 /** @}
  */
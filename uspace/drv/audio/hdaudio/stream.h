@@ -47,19 +47,32 @@ typedef enum {
 	sdir_bidi
 } hda_stream_dir_t;
 
+enum {
+	/** Fewest entries in a buffer descriptor list */
+	bdl_min_entries = 2,
+	/** Most entries in a buffer descriptor list */
+	bdl_max_entries = 256,
+	/** Required alignment of buffers described by the BDL */
+	bdl_buf_align = 128
+};
+
 typedef struct hda_stream_buffers {
 	/** Number of buffers */
 	size_t nbuffers;
 	/** Buffer size */
 	size_t bufsize;
+	/** Interrupt on completion of each buffer */
+	bool ioc;
 	/** Buffer Descriptor List */
 	hda_buffer_desc_t *bdl;
 	/** Physical address of BDL */
 	uintptr_t bdl_phys;
-	/** Buffers */
-	void **buf;
-	/** Physical addresses of buffers */
-	uintptr_t *buf_phys;
+	/** Contiguous memory split into the buffers */
+	void *base;
+	/** Physical address of @c base */
+	uintptr_t base_phys;
+	/** Size of @c base */
+	size_t size;
 } hda_stream_buffers_t;
 
 typedef struct hda_stream {
@@ -76,14 +89,17 @@ typedef struct hda_stream {
 	uint32_t fmt;
 } hda_stream_t;
 
-extern errno_t hda_stream_buffers_alloc(hda_t *, hda_stream_buffers_t **);
+extern errno_t hda_stream_buffers_alloc(hda_t *, size_t,
+    hda_stream_buffers_t **);
 extern void hda_stream_buffers_free(hda_stream_buffers_t *);
+extern errno_t hda_stream_buffers_split(hda_stream_buffers_t *, size_t, bool);
 extern hda_stream_t *hda_stream_create(hda_t *, hda_stream_dir_t,
     hda_stream_buffers_t *, uint32_t);
 extern void hda_stream_destroy(hda_stream_t *);
 extern void hda_stream_start(hda_stream_t *);
 extern void hda_stream_stop(hda_stream_t *);
 extern void hda_stream_reset(hda_stream_t *);
+extern errno_t hda_stream_get_position(hda_stream_t *, size_t *);
 
 #endif
 
@@ -31,7 +31,10 @@
  */
 
 #include <as.h>
+#include <assert.h>
+#include <bitops.h>
 #include <errno.h>
+#include <macros.h>
 #include <stdio.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -116,8 +119,8 @@ static errno_t write_blocks(ddf_fun_t *, uint64_t, size_t, void *);
 
 static errno_t ahci_identify_device(sata_dev_t *);
 static errno_t ahci_set_highest_ultra_dma_mode(sata_dev_t *);
-static errno_t ahci_rb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
-static errno_t ahci_wb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
+static errno_t ahci_rw_fpdma(sata_dev_t *, bool, uint64_t, size_t,
+    uint8_t *);
 
 static void ahci_sata_devices_create(ahci_dev_t *, ddf_dev_t *);
 static ahci_dev_t *ahci_ahci_create(ddf_dev_t *);
@@ -214,7 +217,7 @@ static errno_t get_block_size(ddf_fun_t *fun, size_t *block_size)
 	return EOK;
 }
 
-/** Read data blocks into SATA device.
+/** Read data blocks from SATA device.
  *
  * @param fun      Device function handling the call.
  * @param blocknum Number of first block.
@@ -228,33 +231,7 @@ static errno_t read_blocks(ddf_fun_t *fun, uint64_t blocknum,
     size_t count, void *buf)
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
-
-	uintptr_t phys;
-	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
-	if (rc != EOK) {
-		ddf_msg(LVL_ERROR, "Cannot allocate read buffer.");
-		return rc;
-	}
-
-	memset(buf, 0, sata->block_size);
-
-	fibril_mutex_lock(&sata->lock);
-
-	for (size_t cur = 0; cur < count; cur++) {
-		rc = ahci_rb_fpdma(sata, phys, blocknum + cur);
-		if (rc != EOK)
-			break;
-
-		memcpy((void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    ibuf, sata->block_size);
-	}
-
-	fibril_mutex_unlock(&sata->lock);
-	dmamem_unmap_anonymous(ibuf);
-
-	return rc;
+	return ahci_rw_fpdma(sata, false, blocknum, count, buf);
 }
 
 /** Write data blocks into SATA device.
@@ -271,30 +248,7 @@ static errno_t write_blocks(ddf_fun_t *fun, uint64_t blocknum,
     size_t count, void *buf)
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
-
-	uintptr_t phys;
-	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
-	if (rc != EOK) {
-		ddf_msg(LVL_ERROR, "Cannot allocate write buffer.");
-		return rc;
-	}
-
-	fibril_mutex_lock(&sata->lock);
-
-	for (size_t cur = 0; cur < count; cur++) {
-		memcpy(ibuf, (void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    sata->block_size);
-		rc = ahci_wb_fpdma(sata, phys, blocknum + cur);
-		if (rc != EOK)
-			break;
-	}
-
-	fibril_mutex_unlock(&sata->lock);
-	dmamem_unmap_anonymous(ibuf);
-
-	return rc;
+	return ahci_rw_fpdma(sata, true, blocknum, count, buf);
 }
 
 /*
@@ -469,6 +423,10 @@ static errno_t ahci_identify_device(sata_dev_t *sata)
 
 	ahci_get_model_name(idata->model_name, sata->model);
 
+	ahci_ghc_cap_t cap;
+	cap.u32 = sata->ahci->memregs->ghc.cap;
+	sata->nslots = min(cap.ncs + 1U, (idata->queue_depth & 0x1fU) + 1);
+
 	/*
 	 * Due to QEMU limitation (as of 2012-06-22),
 	 * only NCQ FPDMA mode is supported.
@@ -668,23 +626,113 @@ error:
 	return EINTR;
 }
 
-/** Set AHCI registers for reading one sector from the SATA device using FPDMA.
+/*
+ * Native command queuing
+ */
+
+/** Allocate a free command slot.
+ *
+ * @param sata SATA device structure.
+ * @param wait Wait for a slot if none is free.
+ *
+ * @return Number of the slot or -1 if none is free and @a wait is false.
+ *
+ */
+static int ahci_slot_get(sata_dev_t *sata, bool wait)
+{
+	fibril_mutex_lock(&sata->slot_lock);
+
+	while (sata->slots_free == 0) {
+		if (!wait) {
+			fibril_mutex_unlock(&sata->slot_lock);
+			return -1;
+		}
+
+		fibril_condvar_wait(&sata->slot_free_cv, &sata->slot_lock);
+	}
+
+	int slot = fnzb32(sata->slots_free);
+	sata->slots_free &= ~(1U << slot);
+
+	fibril_mutex_unlock(&sata->slot_lock);
+	return slot;
+}
+
+/** Return a command slot to the free ones.
+ *
+ * @param sata SATA device structure.
+ * @param slot Slot number.
+ *
+ */
+static void ahci_slot_put(sata_dev_t *sata, unsigned int slot)
+{
+	fibril_mutex_lock(&sata->slot_lock);
+	sata->slots_free |= 1U << slot;
+	fibril_condvar_signal(&sata->slot_free_cv);
+	fibril_mutex_unlock(&sata->slot_lock);
+}
+
+/** Fill the PRD table of a command slot.
+ *
+ * @param sata SATA device structure.
+ * @param slot Slot number.
+ * @param phys Physical address of the data.
+ * @param size Size of the data.
+ *
+ * @return Number of PRD entries used.
+ *
+ */
+static unsigned int ahci_slot_prdt_fill(sata_dev_t *sata, unsigned int slot,
+    uintptr_t phys, size_t size)
+{
+	volatile ahci_cmd_prdt_t *prdt = (ahci_cmd_prdt_t *)
+	    (&sata->slots[slot].cmd_table[AHCI_PRDT_OFFSET / 4]);
+	unsigned int n = 0;
+
+	while (size > 0) {
+		/* A PRD entry describes at most 4 MiB. */
+		size_t chunk = min(size, (size_t) 1 << 22);
+
+		assert(n < AHCI_PRDT_ENTRIES);
+		prdt[n].data_address_low = LO(phys);
+		prdt[n].data_address_upper = HI(phys);
+		prdt[n].reserved1 = 0;
+		prdt[n].dbc = chunk - 1;
+		prdt[n].reserved2 = 0;
+		prdt[n].ioc = 0;
+
+		phys += chunk;
+		size -= chunk;
+		n++;
+	}
+
+	return n;
+}
+
+/** Issue an FPDMA command in a command slot.
+ *
+ * The data of the command is transferred using the DMA buffer of the slot.
  *
  * @param sata     SATA device structure.
- * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+ * @param slot     Slot number, used as the NCQ tag.
+ * @param write    Write instead of read.
+ * @param blocknum First block.
+ * @param count    Number of blocks, must fit into the slot buffer.
+ *
+ * @return EOK if succeed, error code otherwise
  *
  */
-static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static errno_t ahci_fpdma_issue(sata_dev_t *sata, unsigned int slot,
+    bool write, uint64_t blocknum, size_t count)
 {
+	ahci_slot_t *s = &sata->slots[slot];
 	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
+	    (sata_ncq_command_frame_t *) s->cmd_table;
 
 	cmd->fis_type = SATA_CMD_FIS_TYPE;
 	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
-	cmd->command = 0x60;
-	cmd->tag = 0;
+	cmd->command = write ? 0x61 : 0x60;
+	cmd->tag = slot << 3;
 	cmd->control = 0;
 
 	cmd->reserved1 = 0;
@@ -694,8 +742,8 @@ static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->reserved5 = 0;
 	cmd->reserved6 = 0;
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	cmd->sector_count_low = count & 0xff;
+	cmd->sector_count_high = (count >> 8) & 0xff;
 
 	cmd->lba0 = blocknum & 0xff;
 	cmd->lba1 = (blocknum >> 8) & 0xff;
@@ -704,137 +752,180 @@ static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->lba4 = (blocknum >> 32) & 0xff;
 	cmd->lba5 = (blocknum >> 40) & 0xff;
 
-	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
+	volatile ahci_cmdhdr_t *hdr = &sata->cmd_header[slot];
 
-	prdt->data_address_low = LO(phys);
-	prdt->data_address_upper = HI(phys);
-	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
-	prdt->reserved2 = 0;
-	prdt->ioc = 0;
-
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
-	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
+	hdr->prdtl = ahci_slot_prdt_fill(sata, slot, s->buf_phys,
+	    count * sata->block_size);
+	hdr->flags = AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
 	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
+	if (write)
+		hdr->flags |= AHCI_CMDHDR_FLAGS_WRITE;
+	hdr->bytesprocessed = 0;
 
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
-}
+	fibril_mutex_lock(&sata->slot_lock);
 
-/** Read one sector from the SATA device using FPDMA.
- *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
- *
- * @return EOK if succeed, error code otherwise
- *
- */
-static errno_t ahci_rb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
-{
 	if (sata->is_invalid_device) {
-		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA read from invalid device", sata->model);
+		fibril_mutex_unlock(&sata->slot_lock);
 		return EINTR;
 	}
 
-	ahci_rb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+	sata->slots_issued |= 1U << slot;
+	s->rc = EOK;
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
-		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA read", sata->model);
-		return EINTR;
-	}
+	/* Writing zeros to these registers has no effect. */
+	sata->port->pxsact = 1U << slot;
+	sata->port->pxci = 1U << slot;
 
+	fibril_mutex_unlock(&sata->slot_lock);
 	return EOK;
 }
 
-/** Set AHCI registers for writing one sector to the SATA device, use FPDMA.
+/** Wait for completion of a command issued in a slot.
  *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
+ * @param sata SATA device structure.
+ * @param slot Slot number.
  *
- * @return EOK if succeed, error code otherwise
+ * @return Result of the command.
  *
  */
-static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static errno_t ahci_slot_wait(sata_dev_t *sata, unsigned int slot)
 {
-	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
+	fibril_mutex_lock(&sata->slot_lock);
 
-	cmd->fis_type = SATA_CMD_FIS_TYPE;
-	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
-	cmd->command = 0x61;
-	cmd->tag = 0;
-	cmd->control = 0;
+	while ((sata->slots_issued & (1U << slot)) != 0)
+		fibril_condvar_wait(&sata->slot_done_cv, &sata->slot_lock);
 
-	cmd->reserved1 = 0;
-	cmd->reserved2 = 0;
-	cmd->reserved3 = 0;
-	cmd->reserved4 = 0;
-	cmd->reserved5 = 0;
-	cmd->reserved6 = 0;
+	errno_t rc = sata->slots[slot].rc;
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	fibril_mutex_unlock(&sata->slot_lock);
+	return rc;
+}
 
-	cmd->lba0 = blocknum & 0xff;
-	cmd->lba1 = (blocknum >> 8) & 0xff;
-	cmd->lba2 = (blocknum >> 16) & 0xff;
-	cmd->lba3 = (blocknum >> 24) & 0xff;
-	cmd->lba4 = (blocknum >> 32) & 0xff;
-	cmd->lba5 = (blocknum >> 40) & 0xff;
+/** Complete the commands the device has finished.
+ *
+ * A queued command is finished when its bit is cleared both in the command
+ * issue and in the SActive register. After an error, the port stops
+ * processing commands and all outstanding ones fail.
+ *
+ * @param sata SATA device structure.
+ * @param pxis Port interrupt status.
+ *
+ */
+static void ahci_slots_complete(sata_dev_t *sata, ahci_port_is_t pxis)
+{
+	fibril_mutex_lock(&sata->slot_lock);
 
-	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
+	uint32_t done;
+	errno_t rc;
 
-	prdt->data_address_low = LO(phys);
-	prdt->data_address_upper = HI(phys);
-	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
-	prdt->reserved2 = 0;
-	prdt->ioc = 0;
+	if (ahci_port_is_error(pxis) && sata->slots_issued != 0) {
+		sata->is_invalid_device = true;
+		done = sata->slots_issued;
+		rc = EIO;
+	} else {
+		done = sata->slots_issued &
+		    ~(sata->port->pxsact | sata->port->pxci);
+		rc = EOK;
+	}
 
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
-	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
-	    AHCI_CMDHDR_FLAGS_WRITE |
-	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
+	if (done != 0) {
+		for (unsigned int slot = 0; slot < AHCI_SLOTS; slot++) {
+			if ((done & (1U << slot)) != 0)
+				sata->slots[slot].rc = rc;
+		}
 
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
+		sata->slots_issued &= ~done;
+		fibril_condvar_broadcast(&sata->slot_done_cv);
+	}
+
+	fibril_mutex_unlock(&sata->slot_lock);
 }
 
-/** Write one sector into the SATA device, use FPDMA.
+/** Read or write blocks using queued FPDMA commands.
+ *
+ * The transfer is split into commands of at most one slot buffer, which
+ * are kept in flight in as many slots as are free. The caller only blocks
+ * waiting for a free slot while it has no command of its own in flight, so
+ * that concurrent transfers cannot deadlock.
  *
  * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
+ * @param write    Write instead of read.
+ * @param blocknum First block.
+ * @param count    Number of blocks.
+ * @param buf      Data buffer.
  *
  * @return EOK if succeed, error code otherwise
  *
  */
-static errno_t ahci_wb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
+static errno_t ahci_rw_fpdma(sata_dev_t *sata, bool write, uint64_t blocknum,
+    size_t count, uint8_t *buf)
 {
+	struct {
+		unsigned int slot;
+		uint8_t *data;
+		size_t size;
+	} pend[AHCI_SLOTS];
+	size_t per_slot = AHCI_SLOT_BUF_SIZE / sata->block_size;
+	size_t head = 0;
+	size_t npend = 0;
+	size_t done = 0;
+	errno_t rc = EOK;
+
 	if (sata->is_invalid_device) {
-		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA write to invalid device", sata->model);
+		ddf_msg(LVL_ERROR, "%s: FPDMA %s invalid device", sata->model,
+		    write ? "write to" : "read from");
 		return EINTR;
 	}
 
-	ahci_wb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+	while (npend > 0 || (rc == EOK && done < count)) {
+		if (rc == EOK && done < count) {
+			int slot = ahci_slot_get(sata, npend == 0);
+			if (slot >= 0) {
+				size_t cnt = min(count - done, per_slot);
+				uint8_t *data = buf + done * sata->block_size;
+				size_t size = cnt * sata->block_size;
+
+				if (write) {
+					memcpy(sata->slots[slot].buf, data,
+					    size);
+				}
+
+				rc = ahci_fpdma_issue(sata, slot, write,
+				    blocknum + done, cnt);
+				if (rc != EOK) {
+					ahci_slot_put(sata, slot);
+					continue;
+				}
+
+				size_t i = (head + npend) % AHCI_SLOTS;
+				pend[i].slot = slot;
+				pend[i].data = data;
+				pend[i].size = size;
+				npend++;
+				done += cnt;
+				continue;
+			}
+		}
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
-		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA write", sata->model);
+		/* Reap the oldest command in flight. */
+		unsigned int slot = pend[head].slot;
+		errno_t crc = ahci_slot_wait(sata, slot);
+		if (crc == EOK && !write) {
+			memcpy(pend[head].data, sata->slots[slot].buf,
+			    pend[head].size);
+		}
+
+		ahci_slot_put(sata, slot);
+		head = (head + 1) % AHCI_SLOTS;
+		npend--;
+
+		if (rc == EOK)
+			rc = crc;
+	}
+
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "%s: Unrecoverable error during FPDMA %s",
+		    sata->model, write ? "write" : "read");
 		return EINTR;
 	}
 
@@ -916,6 +1007,8 @@ static void ahci_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 
 		fibril_mutex_unlock(&sata->event_lock);
 	}
+
+	ahci_slots_complete(sata, pxis);
 }
 
 /*
@@ -932,6 +1025,7 @@ static void ahci_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *port)
 {
 	size_t size = 4096;
+	size_t table_size = AHCI_SLOTS * AHCI_CMD_TABLE_SIZE;
 	uintptr_t phys = 0;
 	void *virt_fb = AS_AREA_ANY;
 	void *virt_cmd = AS_AREA_ANY;
@@ -968,19 +1062,42 @@ static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *po
 	sata->port->pxclb = LO(phys);
 	sata->cmd_header = (ahci_cmdhdr_t *) virt_cmd;
 
-	/* Allocate and init command table structure. */
-	rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
+	/* Allocate and init command tables, one for each command slot. */
+	rc = dmamem_map_anonymous(table_size, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_table);
 	if (rc != EOK)
 		goto error_table;
 
-	memset(virt_table, 0, size);
-	sata->cmd_header->cmdtableu = HI(phys);
-	sata->cmd_header->cmdtable = LO(phys);
-	sata->cmd_table = (uint32_t *) virt_table;
+	memset(virt_table, 0, table_size);
+	for (unsigned int slot = 0; slot < AHCI_SLOTS; slot++) {
+		uintptr_t tphys = phys + slot * AHCI_CMD_TABLE_SIZE;
+
+		sata->cmd_header[slot].cmdtableu = HI(tphys);
+		sata->cmd_header[slot].cmdtable = LO(tphys);
+		sata->slots[slot].cmd_table = (uint32_t *)
+		    ((uint8_t *) virt_table + slot * AHCI_CMD_TABLE_SIZE);
+	}
+
+	sata->cmd_table = sata->slots[0].cmd_table;
+
+	/* Allocate DMA buffers of command slots. */
+	unsigned int nbufs;
+	for (nbufs = 0; nbufs < AHCI_SLOTS; nbufs++) {
+		ahci_slot_t *s = &sata->slots[nbufs];
+
+		s->buf = AS_AREA_ANY;
+		rc = dmamem_map_anonymous(AHCI_SLOT_BUF_SIZE, DMAMEM_4GiB,
+		    AS_AREA_READ | AS_AREA_WRITE, 0, &s->buf_phys, &s->buf);
+		if (rc != EOK)
+			goto error_buf;
+	}
 
 	return sata;
 
+error_buf:
+	while (nbufs > 0)
+		dmamem_unmap_anonymous(sata->slots[--nbufs].buf);
+	dmamem_unmap(virt_table, table_size);
 error_table:
 	dmamem_unmap(virt_cmd, size);
 error_cmd:
@@ -1056,6 +1173,9 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	fibril_mutex_initialize(&sata->lock);
 	fibril_mutex_initialize(&sata->event_lock);
 	fibril_condvar_initialize(&sata->event_condvar);
+	fibril_mutex_initialize(&sata->slot_lock);
+	fibril_condvar_initialize(&sata->slot_free_cv);
+	fibril_condvar_initialize(&sata->slot_done_cv);
 
 	ahci_sata_hw_start(sata);
 
@@ -1067,6 +1187,9 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	if (ahci_set_highest_ultra_dma_mode(sata) != EOK)
 		goto error;
 
+	/* Enable queued commands in all slots both HBA and device support. */
+	sata->slots_free = (uint32_t) -1 >> (AHCI_SLOTS - sata->nslots);
+
 	/* Add device to the system */
 	char sata_dev_name[16];
 	snprintf(sata_dev_name, 16, "ahci_%u", sata_devices_count);
@@ -1183,16 +1306,26 @@ static ahci_dev_t *ahci_ahci_create(ddf_dev_t *dev)
 	ct.rangecount = sizeof(ahci_ranges) / sizeof(irq_pio_range_t);
 	ct.ranges = ahci_ranges;
 
+	/* Prefer a message signalled interrupt to the shared legacy line */
+	int irq = hw_res_parsed.irqs.irqs[0];
+	bool msi = false;
+	size_t nvec;
+	int inr;
+
+	if (hw_res_msi_alloc(ahci->parent_sess, 1, &inr, &nvec) == EOK) {
+		irq = inr;
+		msi = true;
+	}
+
 	cap_irq_handle_t irq_cap;
-	errno_t rc = register_interrupt_handler(dev,
-	    hw_res_parsed.irqs.irqs[0], ahci_interrupt, &ct, &irq_cap);
+	errno_t rc = register_interrupt_handler(dev, irq, ahci_interrupt, &ct,
+	    &irq_cap);
 	if (rc != EOK) {
 		ddf_msg(LVL_ERROR, "Failed registering interrupt handler.");
 		goto error_register_interrupt_handler;
 	}
 
-	rc = hw_res_enable_interrupt(ahci->parent_sess,
-	    hw_res_parsed.irqs.irqs[0]);
+	rc = hw_res_enable_interrupt(ahci->parent_sess, irq);
 	if (rc != EOK) {
 		ddf_msg(LVL_ERROR, "Failed enable interupt.");
 		goto error_enable_interrupt;
@@ -1205,6 +1338,8 @@ error_enable_interrupt:
 	unregister_interrupt_handler(dev, irq_cap);
 
 error_register_interrupt_handler:
+	if (msi)
+		hw_res_msi_free(ahci->parent_sess);
 	// FIXME: unmap physical memory
 
 error_map_registers:
@@ -34,12 +34,29 @@
 #define __AHCI_H__
 
 #include <async.h>
+#include <errno.h>
 #include <ddf/interrupt.h>
 #include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "ahci_hw.h"
 
+/** Maximum number of command slots of a port. */
+#define AHCI_SLOTS  32
+
+/** Number of PRD entries in a command table. */
+#define AHCI_PRDT_ENTRIES  8
+
+/** Offset of the PRD table in a command table. */
+#define AHCI_PRDT_OFFSET  0x80
+
+/** Size of a command table, must be a multiple of 128 B. */
+#define AHCI_CMD_TABLE_SIZE \
+	(AHCI_PRDT_OFFSET + AHCI_PRDT_ENTRIES * sizeof(ahci_cmd_prdt_t))
+
+/** Size of the DMA buffer of a command slot. */
+#define AHCI_SLOT_BUF_SIZE  (64 * 1024)
+
 /** AHCI Device. */
 typedef struct {
 	/** Pointer to ddf device. */
@@ -55,6 +72,21 @@ typedef struct {
 	async_sess_t *parent_sess;
 } ahci_dev_t;
 
+/** Command slot of a SATA port. */
+typedef struct {
+	/** Pointer to command table. */
+	volatile uint32_t *cmd_table;
+
+	/** Pointer to DMA buffer. */
+	void *buf;
+
+	/** Physical address of DMA buffer. */
+	uintptr_t buf_phys;
+
+	/** Result of the last command. */
+	errno_t rc;
+} ahci_slot_t;
+
 /** SATA Device. */
 typedef struct {
 	/** Pointer to AHCI device. */
@@ -72,15 +104,36 @@ typedef struct {
 	/** Pointer to SATA port. */
 	volatile ahci_port_t *port;
 
-	/** Pointer to command header. */
+	/** Pointer to command list, one header per command slot. */
 	volatile ahci_cmdhdr_t *cmd_header;
 
-	/** Pointer to command table. */
+	/** Pointer to command table of slot 0. */
 	volatile uint32_t *cmd_table;
 
-	/** Mutex for single operation on device. */
+	/** Mutex for single non-queued operation on device. */
 	fibril_mutex_t lock;
 
+	/** Command slots. */
+	ahci_slot_t slots[AHCI_SLOTS];
+
+	/** Number of command slots used for queued commands. */
+	unsigned int nslots;
+
+	/** Mutex protecting the state of command slots. */
+	fibril_mutex_t slot_lock;
+
+	/** Mask of free command slots. */
+	uint32_t slots_free;
+
+	/** Mask of issued command slots which have not completed. */
+	uint32_t slots_issued;
+
+	/** Signalled when a command slot is freed. */
+	fibril_condvar_t slot_free_cv;
+
+	/** Signalled when an issued command completes. */
+	fibril_condvar_t slot_done_cv;
+
 	/** Mutex for event signaling condition variable. */
 	fibril_mutex_t event_lock;
 
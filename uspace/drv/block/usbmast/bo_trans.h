@@ -81,6 +81,13 @@ typedef struct {
 	/** Number of bytes actually received */
 	size_t rcvd_size;
 
+	/** Buffer for sense data reported with the status, or @c NULL */
+	void *sense;
+	/** Size of sense buffer in bytes */
+	size_t sense_size;
+	/** Number of sense bytes received */
+	size_t sense_rcvd;
+
 	/** Status */
 	cmd_status_t status;
 } scsi_cmd_t;
@@ -50,6 +50,7 @@
 #include "cmdw.h"
 #include "bo_trans.h"
 #include "scsi_ms.h"
+#include "uas_trans.h"
 #include "usbmast.h"
 
 #define NAME "usbmast"
@@ -124,6 +125,7 @@ static errno_t usbmast_device_gone(usb_device_t *dev)
 		mdev->luns[i] = NULL;
 	}
 	free(mdev->luns);
+	uas_fini(mdev);
 	return EOK;
 }
 
@@ -150,15 +152,6 @@ static errno_t usbmast_device_add(usb_device_t *dev)
 	usbmast_dev_t *mdev = NULL;
 	unsigned i;
 
-	usb_endpoint_mapping_t *epm_in =
-	    usb_device_get_mapped_ep_desc(dev, &bulk_in_ep);
-	usb_endpoint_mapping_t *epm_out =
-	    usb_device_get_mapped_ep_desc(dev, &bulk_out_ep);
-	if (!epm_in || !epm_out || !epm_in->present || !epm_out->present) {
-		usb_log_error("Required EPs were not mapped.");
-		return ENOENT;
-	}
-
 	/* Allocate softstate */
 	mdev = usb_device_data_alloc(dev, sizeof(usbmast_dev_t));
 	if (mdev == NULL) {
@@ -170,21 +163,54 @@ static errno_t usbmast_device_add(usb_device_t *dev)
 
 	usb_log_info("Initializing mass storage `%s'.",
 	    usb_device_get_name(dev));
-	usb_log_debug("Bulk in endpoint: %d [%zuB].",
-	    epm_in->pipe.desc.endpoint_no, epm_in->pipe.desc.max_transfer_size);
-	usb_log_debug("Bulk out endpoint: %d [%zuB].",
-	    epm_out->pipe.desc.endpoint_no, epm_out->pipe.desc.max_transfer_size);
 
-	usb_log_debug("Get LUN count...");
-	mdev->lun_count = usb_masstor_get_lun_count(mdev);
+	rc = uas_init(mdev);
+	if (rc != EOK && rc != ENOTSUP) {
+		usb_log_warning("Falling back to bulk-only transport: %s.",
+		    str_error(rc));
+		rc = usb_device_select_interface(dev, 0, mast_endpoints);
+		if (rc != EOK) {
+			usb_log_error("Failed to select bulk-only transport: "
+			    "%s.", str_error(rc));
+			return rc;
+		}
+	}
+
+	if (mdev->uas != NULL) {
+		/* Multiple LUNs would need REPORT LUNS */
+		mdev->lun_count = 1;
+	} else {
+		usb_endpoint_mapping_t *epm_in =
+		    usb_device_get_mapped_ep_desc(dev, &bulk_in_ep);
+		usb_endpoint_mapping_t *epm_out =
+		    usb_device_get_mapped_ep_desc(dev, &bulk_out_ep);
+		if (!epm_in || !epm_out || !epm_in->present ||
+		    !epm_out->present) {
+			usb_log_error("Required EPs were not mapped.");
+			return ENOENT;
+		}
+
+		usb_log_debug("Bulk in endpoint: %d [%zuB].",
+		    epm_in->pipe.desc.endpoint_no,
+		    epm_in->pipe.desc.max_transfer_size);
+		usb_log_debug("Bulk out endpoint: %d [%zuB].",
+		    epm_out->pipe.desc.endpoint_no,
+		    epm_out->pipe.desc.max_transfer_size);
+
+		mdev->bulk_in_pipe = &epm_in->pipe;
+		mdev->bulk_out_pipe = &epm_out->pipe;
+
+		usb_log_debug("Get LUN count...");
+		mdev->lun_count = usb_masstor_get_lun_count(mdev);
+	}
+
 	mdev->luns = calloc(mdev->lun_count, sizeof(ddf_fun_t *));
 	if (mdev->luns == NULL) {
 		usb_log_error("Failed allocating luns table.");
-		return ENOMEM;
+		rc = ENOMEM;
+		goto error;
 	}
 
-	mdev->bulk_in_pipe = &epm_in->pipe;
-	mdev->bulk_out_pipe = &epm_out->pipe;
 	for (i = 0; i < mdev->lun_count; i++) {
 		rc = usbmast_fun_create(mdev, i);
 		if (rc != EOK)
@@ -194,7 +220,7 @@ static errno_t usbmast_device_add(usb_device_t *dev)
 	return EOK;
 error:
 	/* Destroy functions */
-	for (size_t i = 0; i < mdev->lun_count; ++i) {
+	for (size_t i = 0; mdev->luns != NULL && i < mdev->lun_count; ++i) {
 		if (mdev->luns[i] == NULL)
 			continue;
 		const errno_t rc = ddf_fun_unbind(mdev->luns[i]);
@@ -205,6 +231,7 @@ error:
 		ddf_fun_destroy(mdev->luns[i]);
 	}
 	free(mdev->luns);
+	uas_fini(mdev);
 	return rc;
 }
 
@@ -252,6 +279,8 @@ static errno_t usbmast_fun_create(usbmast_dev_t *mdev, unsigned lun)
 	bd_srvs_init(&mfun->bds);
 	mfun->bds.ops = &usbmast_bd_ops;
 	mfun->bds.sarg = mfun;
+	if (mdev->uas != NULL)
+		mfun->bds.queue_depth = mdev->uas->ntags;
 
 	/* Set up a connection handler. */
 	ddf_fun_set_conn_handler(fun, usbmast_bd_connection);
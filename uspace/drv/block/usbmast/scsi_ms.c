@@ -50,6 +50,7 @@
 #include "cmdw.h"
 #include "bo_trans.h"
 #include "scsi_ms.h"
+#include "uas_trans.h"
 #include "usbmast.h"
 
 /** Get string representation for SCSI peripheral device type.
@@ -62,6 +63,20 @@ const char *usbmast_scsi_dev_type_str(unsigned type)
 	return scsi_get_dev_type_str(type);
 }
 
+/** Send SCSI command over the transport of the device.
+ *
+ * @param mfun		Mass storage function
+ * @param cmd		SCSI command
+ * @return		Error code
+ */
+static errno_t usbmast_cmd(usbmast_fun_t *mfun, scsi_cmd_t *cmd)
+{
+	if (mfun->mdev->uas != NULL)
+		return uas_cmd(mfun, cmd);
+
+	return usb_massstor_cmd(mfun, 0xDEADBEEF, cmd);
+}
+
 static void usbmast_dump_sense(scsi_sense_data_t *sense_buf)
 {
 	const unsigned sense_key = sense_buf->flags_key & 0x0f;
@@ -85,7 +100,7 @@ static errno_t usb_massstor_unit_ready(usbmast_fun_t *mfun)
 	cmd.cdb = &cdb;
 	cmd.cdb_size = sizeof(cdb);
 
-	rc = usb_massstor_cmd(mfun, 0xDEADBEEF, &cmd);
+	rc = usbmast_cmd(mfun, &cmd);
 
 	if (rc != EOK) {
 		usb_log_error("Test Unit Ready failed on device %s: %s.",
@@ -115,14 +130,24 @@ static errno_t usbmast_run_cmd(usbmast_fun_t *mfun, scsi_cmd_t *cmd)
 	errno_t rc;
 
 	do {
-		rc = usb_massstor_unit_ready(mfun);
-		if (rc != EOK) {
-			usb_log_error("Inquiry transport failed, device %s: %s.",
-			    usb_device_get_name(mfun->mdev->usb_dev), str_error(rc));
-			return rc;
+		/*
+		 * UAS reports unit attention in the sense data of the
+		 * command itself.
+		 */
+		if (mfun->mdev->uas == NULL) {
+			rc = usb_massstor_unit_ready(mfun);
+			if (rc != EOK) {
+				usb_log_error("Inquiry transport failed, device %s: %s.",
+				    usb_device_get_name(mfun->mdev->usb_dev), str_error(rc));
+				return rc;
+			}
 		}
 
-		rc = usb_massstor_cmd(mfun, 0xDEADBEEF, cmd);
+		cmd->sense = &sense_buf;
+		cmd->sense_size = sizeof(sense_buf);
+		cmd->sense_rcvd = 0;
+
+		rc = usbmast_cmd(mfun, cmd);
 		if (rc != EOK) {
 			usb_log_error("Inquiry transport failed, device %s: %s.",
 			    usb_device_get_name(mfun->mdev->usb_dev), str_error(rc));
@@ -135,10 +160,14 @@ static errno_t usbmast_run_cmd(usbmast_fun_t *mfun, scsi_cmd_t *cmd)
 		usb_log_error("SCSI command failed, device %s.",
 		    usb_device_get_name(mfun->mdev->usb_dev));
 
-		rc = usbmast_request_sense(mfun, &sense_buf, sizeof(sense_buf));
-		if (rc != EOK) {
-			usb_log_error("Failed to read sense data.");
-			return EIO;
+		/* UAS delivers the sense data with the status */
+		if (cmd->sense_rcvd < SCSI_SENSE_DATA_MIN_SIZE) {
+			rc = usbmast_request_sense(mfun, &sense_buf,
+			    sizeof(sense_buf));
+			if (rc != EOK) {
+				usb_log_error("Failed to read sense data.");
+				return EIO;
+			}
 		}
 
 		/* Dump sense data to log */
@@ -180,7 +209,7 @@ errno_t usbmast_inquiry(usbmast_fun_t *mfun, usbmast_inquiry_data_t *inq_res)
 	cmd.data_in = &inq_data;
 	cmd.data_in_size = sizeof(inq_data);
 
-	rc = usb_massstor_cmd(mfun, 0xDEADBEEF, &cmd);
+	rc = usbmast_cmd(mfun, &cmd);
 
 	if (rc != EOK) {
 		usb_log_error("Inquiry transport failed, device %s: %s.",
@@ -248,7 +277,7 @@ errno_t usbmast_request_sense(usbmast_fun_t *mfun, void *buf, size_t size)
 	cmd.data_in = buf;
 	cmd.data_in_size = size;
 
-	rc = usb_massstor_cmd(mfun, 0xDEADBEEF, &cmd);
+	rc = usbmast_cmd(mfun, &cmd);
 
 	if (rc != EOK || cmd.status != CMDS_GOOD) {
 		usb_log_error("Request Sense failed, device %s: %s.",
@@ -0,0 +1,553 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup drvusbmast
+ * @{
+ */
+/**
+ * @file
+ * USB Attached SCSI transport.
+ *
+ * Every command gets a tag, which also selects the stream used for its data
+ * and status phases on the bulk pipes. The command IU goes over the command
+ * pipe, the data phase runs in a helper fibril and the calling fibril waits
+ * for the sense IU. Any number of fibrils can issue commands at the same
+ * time, up to the number of tags.
+ */
+
+#include <assert.h>
+#include <byteorder.h>
+#include <errno.h>
+#include <fibril.h>
+#include <macros.h>
+#include <mem.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <str_error.h>
+#include <usb/classes/classes.h>
+#include <usb/classes/massstor.h>
+#include <usb/debug.h>
+#include <usb/dev/alternate_ifaces.h>
+
+#include "uas_trans.h"
+#include "usbmast.h"
+
+/** How long to wait for a data phase after the command has failed */
+#define UAS_DATA_ABORT_TIMEOUT  1000000
+
+static const usb_endpoint_description_t uas_bulk_in_ep[2] = {
+	[0 ... 1] = {
+		.transfer_type = USB_TRANSFER_BULK,
+		.direction = USB_DIRECTION_IN,
+		.interface_class = USB_CLASS_MASS_STORAGE,
+		.interface_subclass = USB_MASSSTOR_SUBCLASS_SCSI,
+		.interface_protocol = USB_MASSSTOR_PROTOCOL_UAS,
+		.flags = 0
+	}
+};
+
+static const usb_endpoint_description_t uas_bulk_out_ep[2] = {
+	[0 ... 1] = {
+		.transfer_type = USB_TRANSFER_BULK,
+		.direction = USB_DIRECTION_OUT,
+		.interface_class = USB_CLASS_MASS_STORAGE,
+		.interface_subclass = USB_MASSSTOR_SUBCLASS_SCSI,
+		.interface_protocol = USB_MASSSTOR_PROTOCOL_UAS,
+		.flags = 0
+	}
+};
+
+static const usb_endpoint_description_t *uas_endpoints[] = {
+	&uas_bulk_in_ep[0],
+	&uas_bulk_in_ep[1],
+	&uas_bulk_out_ep[0],
+	&uas_bulk_out_ep[1],
+	NULL
+};
+
+/** Data phase of a command. */
+typedef struct {
+	usbmast_uas_t *uas;
+	/** Tag (stream ID) of the command */
+	unsigned tag;
+	usb_pipe_t *pipe;
+	usb_direction_t dir;
+	/** DMA buffer */
+	void *buf;
+	size_t size;
+	/** Number of bytes actually transferred */
+	size_t xfer_size;
+	errno_t rc;
+	/** Data phase has finished */
+	bool done;
+	/** The command has given up waiting, the fibril cleans up */
+	bool abandoned;
+} uas_data_t;
+
+/** Find the UAS alternate setting of the interface.
+ *
+ * @param dev USB device
+ * @return Interface descriptor of the setting or @c NULL
+ */
+static const usb_standard_interface_descriptor_t *uas_find_iface(
+    usb_device_t *dev)
+{
+	const usb_alternate_interfaces_t *ifaces =
+	    usb_device_get_alternative_ifaces(dev);
+
+	for (size_t i = 0; i < ifaces->alternative_count; i++) {
+		const usb_standard_interface_descriptor_t *iface =
+		    ifaces->alternatives[i].interface;
+
+		if (iface->interface_class == USB_CLASS_MASS_STORAGE &&
+		    iface->interface_subclass == USB_MASSSTOR_SUBCLASS_SCSI &&
+		    iface->interface_protocol == USB_MASSSTOR_PROTOCOL_UAS)
+			return iface;
+	}
+
+	return NULL;
+}
+
+/** Get the pipe ID from the Pipe Usage descriptor of a mapped endpoint.
+ *
+ * The descriptor follows the endpoint descriptor (and its companion).
+ *
+ * @param dev USB device
+ * @param epm Endpoint mapping
+ * @return Pipe ID or -1 if there is no Pipe Usage descriptor
+ */
+static int uas_pipe_id(usb_device_t *dev, const usb_endpoint_mapping_t *epm)
+{
+	const usb_device_descriptors_t *descs = usb_device_descriptors(dev);
+	const uint8_t *end = (const uint8_t *) descs->full_config +
+	    descs->full_config_size;
+	const uint8_t *d = (const uint8_t *) epm->descriptor;
+
+	for (d += d[0]; end - d >= 2 && d[0] >= 2 && end - d >= d[0];
+	    d += d[0]) {
+		if (d[1] == USB_DESCTYPE_ENDPOINT ||
+		    d[1] == USB_DESCTYPE_INTERFACE)
+			break;
+
+		if (d[1] == UAS_DESCTYPE_PIPE_USAGE && d[0] >= 4)
+			return d[2];
+	}
+
+	return -1;
+}
+
+/** Allocate a tag, waiting for one to become free.
+ *
+ * @param uas UAS transport
+ * @return Tag
+ */
+static unsigned uas_tag_alloc(usbmast_uas_t *uas)
+{
+	const uint32_t all = (uint32_t) ((UINT64_C(1) << uas->ntags) - 1);
+	unsigned i;
+
+	fibril_mutex_lock(&uas->lock);
+	while (uas->busy == all)
+		fibril_condvar_wait(&uas->cv, &uas->lock);
+
+	for (i = 0; (uas->busy & (1u << i)) != 0; i++)
+		;
+
+	uas->busy |= 1u << i;
+	fibril_mutex_unlock(&uas->lock);
+
+	return i + 1;
+}
+
+/** Release a tag.
+ *
+ * @param uas UAS transport, locked
+ * @param tag Tag
+ */
+static void uas_tag_release_locked(usbmast_uas_t *uas, unsigned tag)
+{
+	assert(fibril_mutex_is_locked(&uas->lock));
+
+	uas->busy &= ~(1u << (tag - 1));
+	fibril_condvar_broadcast(&uas->cv);
+}
+
+/** Run the data phase of a command. */
+static errno_t uas_data_fibril(void *arg)
+{
+	uas_data_t *data = (uas_data_t *) arg;
+	usbmast_uas_t *uas = data->uas;
+	size_t xfer_size = 0;
+	errno_t rc;
+
+	if (data->dir == USB_DIRECTION_IN) {
+		rc = usb_pipe_read_stream_dma(data->pipe, data->tag, data->buf,
+		    data->buf, data->size, &xfer_size);
+	} else {
+		rc = usb_pipe_write_stream_dma(data->pipe, data->tag,
+		    data->buf, data->buf, data->size);
+		if (rc == EOK)
+			xfer_size = data->size;
+	}
+
+	fibril_mutex_lock(&uas->lock);
+	data->rc = rc;
+	data->xfer_size = xfer_size;
+	data->done = true;
+
+	if (data->abandoned) {
+		/* Nothing is pending on the stream any more, reuse the tag. */
+		uas_tag_release_locked(uas, data->tag);
+		fibril_mutex_unlock(&uas->lock);
+
+		usb_pipe_free_buffer(data->pipe, data->buf);
+		free(data);
+		return EOK;
+	}
+
+	fibril_condvar_broadcast(&uas->cv);
+	fibril_mutex_unlock(&uas->lock);
+	return EOK;
+}
+
+/** Send SCSI command via USB Attached SCSI.
+ *
+ * @param mfun		Mass storage function
+ * @param cmd		SCSI command
+ *
+ * @return		Error code
+ */
+errno_t uas_cmd(usbmast_fun_t *mfun, scsi_cmd_t *cmd)
+{
+	usbmast_uas_t *uas = mfun->mdev->uas;
+	uas_data_t *data = NULL;
+	size_t sense_size;
+	errno_t rc;
+
+	if (cmd->data_in && cmd->data_out)
+		return EINVAL;
+
+	if (cmd->cdb_size > sizeof(uas->cmd_iu[0].cdb))
+		return EINVAL;
+
+	if (cmd->data_in || cmd->data_out) {
+		data = calloc(1, sizeof(uas_data_t));
+		if (data == NULL)
+			return ENOMEM;
+
+		data->uas = uas;
+		if (cmd->data_in) {
+			data->pipe = uas->data_in_pipe;
+			data->dir = USB_DIRECTION_IN;
+			data->size = cmd->data_in_size;
+		} else {
+			data->pipe = uas->data_out_pipe;
+			data->dir = USB_DIRECTION_OUT;
+			data->size = cmd->data_out_size;
+		}
+
+		data->buf = usb_pipe_alloc_buffer(data->pipe, data->size);
+		if (data->buf == NULL) {
+			free(data);
+			return ENOMEM;
+		}
+
+		if (cmd->data_out)
+			memcpy(data->buf, cmd->data_out, cmd->data_out_size);
+	}
+
+	const unsigned tag = uas_tag_alloc(uas);
+
+	/* Prepare command IU */
+	uas_cmd_iu_t *iu = &uas->cmd_iu[tag - 1];
+	memset(iu, 0, sizeof(*iu));
+	iu->iu_id = UAS_IU_COMMAND;
+	iu->tag = host2uint16_t_be(tag);
+	iu->lun[1] = mfun->lun;
+	memcpy(iu->cdb, cmd->cdb, cmd->cdb_size);
+
+	rc = usb_pipe_write_dma(uas->cmd_pipe, uas->cmd_iu, iu, sizeof(*iu));
+	if (rc != EOK) {
+		usb_log_error("Failed to send command IU: %s", str_error(rc));
+		fibril_mutex_lock(&uas->lock);
+		uas_tag_release_locked(uas, tag);
+		fibril_mutex_unlock(&uas->lock);
+		goto error;
+	}
+
+	if (data != NULL) {
+		data->tag = tag;
+
+		fid_t fid = fibril_create(uas_data_fibril, data);
+		if (fid == 0) {
+			/*
+			 * The device waits for a data phase that never comes,
+			 * do not reuse the tag.
+			 */
+			usb_log_error("Failed to start data phase of tag %u.",
+			    tag);
+			goto error;
+		}
+
+		fibril_add_ready(fid);
+	}
+
+	/* Read the sense IU */
+	uas_sense_iu_t *sense = &uas->sense_iu[tag - 1];
+	rc = usb_pipe_read_stream_dma(uas->status_pipe, tag, uas->sense_iu,
+	    sense, sizeof(*sense), &sense_size);
+	if (rc == EOK && (sense_size < 4 ||
+	    uint16_t_be2host(sense->tag) != tag)) {
+		usb_log_error("Received malformed status IU for tag %u.", tag);
+		rc = EIO;
+	}
+
+	if (rc == EOK) {
+		switch (sense->iu_id) {
+		case UAS_IU_SENSE:
+			if (sense_size < offsetof(uas_sense_iu_t, sense)) {
+				rc = EIO;
+				break;
+			}
+
+			if (sense->status == 0) {
+				cmd->status = CMDS_GOOD;
+				break;
+			}
+
+			cmd->status = CMDS_FAILED;
+			usb_log_error("UAS command failed, status 0x%02x.",
+			    sense->status);
+			if (cmd->sense != NULL) {
+				cmd->sense_rcvd = min(min(cmd->sense_size,
+				    uint16_t_be2host(sense->sense_len)),
+				    sense_size - offsetof(uas_sense_iu_t, sense));
+				memcpy(cmd->sense, sense->sense,
+				    cmd->sense_rcvd);
+			}
+			break;
+		case UAS_IU_RESPONSE:
+			usb_log_error("UAS response IU, code 0x%02x.",
+			    sense->code);
+			rc = EIO;
+			break;
+		default:
+			usb_log_error("Unexpected IU 0x%02x.", sense->iu_id);
+			rc = EIO;
+			break;
+		}
+	} else {
+		usb_log_error("Failed to read status IU: %s", str_error(rc));
+	}
+
+	fibril_mutex_lock(&uas->lock);
+
+	if (data == NULL) {
+		uas_tag_release_locked(uas, tag);
+		fibril_mutex_unlock(&uas->lock);
+		return rc;
+	}
+
+	/*
+	 * A good status follows the data phase, otherwise the device may
+	 * have skipped it.
+	 */
+	while (!data->done) {
+		if (rc == EOK && cmd->status == CMDS_GOOD) {
+			fibril_condvar_wait(&uas->cv, &uas->lock);
+		} else if (fibril_condvar_wait_timeout(&uas->cv, &uas->lock,
+		    UAS_DATA_ABORT_TIMEOUT) == ETIMEOUT) {
+			break;
+		}
+	}
+
+	if (!data->done) {
+		/*
+		 * The transfer is still queued on the stream, the tag is
+		 * released when it finishes.
+		 */
+		usb_log_warning("Abandoning data phase of tag %u.", tag);
+		data->abandoned = true;
+		fibril_mutex_unlock(&uas->lock);
+		return rc != EOK ? rc : EIO;
+	}
+
+	uas_tag_release_locked(uas, tag);
+	fibril_mutex_unlock(&uas->lock);
+
+	if (rc == EOK && data->rc != EOK) {
+		usb_log_error("Failed to transfer data: %s",
+		    str_error(data->rc));
+		rc = EIO;
+	}
+
+	if (rc == EOK && cmd->data_in) {
+		memcpy(cmd->data_in, data->buf, data->xfer_size);
+		cmd->rcvd_size = data->xfer_size;
+	}
+
+error:
+	if (data != NULL) {
+		usb_pipe_free_buffer(data->pipe, data->buf);
+		free(data);
+	}
+
+	return rc != EOK ? EIO : EOK;
+}
+
+/** Switch the device to USB Attached SCSI.
+ *
+ * Selects the UAS alternate setting, identifies the pipes and enables
+ * streams on the bulk pipes. Only SuperSpeed devices are switched, older
+ * ones do not use streams.
+ *
+ * @param mdev		Mass storage device
+ * @return		EOK on success, ENOTSUP if the device should keep
+ *			using bulk-only transport and the interface setting
+ *			was not changed, other error code if switching failed
+ */
+errno_t uas_init(usbmast_dev_t *mdev)
+{
+	usb_device_t *dev = mdev->usb_dev;
+	usbmast_uas_t *uas;
+	unsigned granted;
+	errno_t rc;
+
+	if (usb_device_get_speed(dev) != USB_SPEED_SUPER)
+		return ENOTSUP;
+
+	const usb_standard_interface_descriptor_t *iface = uas_find_iface(dev);
+	if (iface == NULL)
+		return ENOTSUP;
+
+	rc = usb_device_select_interface(dev, iface->alternate_setting,
+	    uas_endpoints);
+	if (rc != EOK)
+		return rc;
+
+	uas = calloc(1, sizeof(usbmast_uas_t));
+	if (uas == NULL)
+		return ENOMEM;
+
+	fibril_mutex_initialize(&uas->lock);
+	fibril_condvar_initialize(&uas->cv);
+
+	for (size_t i = 0; uas_endpoints[i] != NULL; i++) {
+		usb_endpoint_mapping_t *epm =
+		    usb_device_get_mapped_ep_desc(dev, uas_endpoints[i]);
+		if (epm == NULL || !epm->present)
+			continue;
+
+		switch (uas_pipe_id(dev, epm)) {
+		case UAS_PIPE_COMMAND:
+			uas->cmd_pipe = &epm->pipe;
+			break;
+		case UAS_PIPE_STATUS:
+			uas->status_pipe = &epm->pipe;
+			break;
+		case UAS_PIPE_DATA_IN:
+			uas->data_in_pipe = &epm->pipe;
+			break;
+		case UAS_PIPE_DATA_OUT:
+			uas->data_out_pipe = &epm->pipe;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (uas->cmd_pipe == NULL || uas->status_pipe == NULL ||
+	    uas->data_in_pipe == NULL || uas->data_out_pipe == NULL ||
+	    uas->cmd_pipe->desc.direction != USB_DIRECTION_OUT ||
+	    uas->status_pipe->desc.direction != USB_DIRECTION_IN ||
+	    uas->data_in_pipe->desc.direction != USB_DIRECTION_IN ||
+	    uas->data_out_pipe->desc.direction != USB_DIRECTION_OUT) {
+		usb_log_error("UAS pipes were not mapped.");
+		rc = ENOENT;
+		goto error;
+	}
+
+	uas->ntags = UAS_TAGS_MAX;
+
+	usb_pipe_t *streamed[] = {
+		uas->status_pipe, uas->data_in_pipe, uas->data_out_pipe
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(streamed); i++) {
+		rc = usb_pipe_request_streams(streamed[i], uas->ntags,
+		    &granted);
+		if (rc != EOK) {
+			usb_log_error("Failed to enable streams: %s",
+			    str_error(rc));
+			goto error;
+		}
+
+		uas->ntags = min(uas->ntags, granted);
+	}
+
+	uas->cmd_iu = usb_pipe_alloc_buffer(uas->cmd_pipe,
+	    uas->ntags * sizeof(uas_cmd_iu_t));
+	uas->sense_iu = usb_pipe_alloc_buffer(uas->status_pipe,
+	    uas->ntags * sizeof(uas_sense_iu_t));
+	if (uas->cmd_iu == NULL || uas->sense_iu == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	usb_log_info("Using USB Attached SCSI with %u tags.", uas->ntags);
+	mdev->uas = uas;
+	return EOK;
+
+error:
+	if (uas->cmd_iu != NULL)
+		usb_pipe_free_buffer(uas->cmd_pipe, uas->cmd_iu);
+	if (uas->sense_iu != NULL)
+		usb_pipe_free_buffer(uas->status_pipe, uas->sense_iu);
+	free(uas);
+	return rc;
+}
+
+/** Release the USB Attached SCSI transport state.
+ *
+ * @param mdev		Mass storage device
+ */
+void uas_fini(usbmast_dev_t *mdev)
+{
+	usbmast_uas_t *uas = mdev->uas;
+
+	if (uas == NULL)
+		return;
+
+	usb_pipe_free_buffer(uas->cmd_pipe, uas->cmd_iu);
+	usb_pipe_free_buffer(uas->status_pipe, uas->sense_iu);
+	free(uas);
+	mdev->uas = NULL;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup drvusbmast
+ * @{
+ */
+/** @file
+ * USB Attached SCSI transport.
+ */
+
+#ifndef UAS_TRANS_H_
+#define UAS_TRANS_H_
+
+#include <fibril_synch.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <usb/dev/pipes.h>
+#include "bo_trans.h"
+#include "usbmast.h"
+
+/** Maximum number of commands in flight on a UAS device */
+#define UAS_TAGS_MAX  32
+
+/** Pipe Usage class-specific endpoint descriptor type */
+#define UAS_DESCTYPE_PIPE_USAGE  0x24
+
+/** Pipe IDs from the Pipe Usage descriptor */
+enum uas_pipe_id {
+	UAS_PIPE_COMMAND = 1,
+	UAS_PIPE_STATUS = 2,
+	UAS_PIPE_DATA_IN = 3,
+	UAS_PIPE_DATA_OUT = 4
+};
+
+/** Information unit IDs */
+enum uas_iu_id {
+	UAS_IU_COMMAND = 0x01,
+	UAS_IU_SENSE = 0x03,
+	UAS_IU_RESPONSE = 0x04
+};
+
+/** Command IU */
+typedef struct {
+	uint8_t iu_id;
+	uint8_t reserved1;
+	/** Tag, big endian */
+	uint16_t tag;
+	/** Priority and task attribute (0 = simple) */
+	uint8_t prio_attr;
+	uint8_t reserved5;
+	/** Additional CDB length in dwords, in bits 7:2 */
+	uint8_t add_cdb_len;
+	uint8_t reserved7;
+	/** Logical unit number, SAM format */
+	uint8_t lun[8];
+	uint8_t cdb[16];
+} __attribute__((packed)) uas_cmd_iu_t;
+
+/** Sense IU (or Response IU, which is a shorter prefix of it) */
+typedef struct {
+	uint8_t iu_id;
+	uint8_t reserved1;
+	/** Tag, big endian */
+	uint16_t tag;
+	/** Status qualifier (Response IU: additional response information) */
+	uint16_t status_qual;
+	/** SCSI status (Response IU: additional response information) */
+	uint8_t status;
+	/** Response IU: response code, Sense IU: reserved */
+	uint8_t code;
+	uint8_t reserved8[6];
+	/** Length of sense data, big endian */
+	uint16_t sense_len;
+	uint8_t sense[SCSI_SENSE_DATA_MAX_SIZE];
+} __attribute__((packed)) uas_sense_iu_t;
+
+/** USB Attached SCSI transport state. */
+struct usbmast_uas {
+	/** Command pipe */
+	usb_pipe_t *cmd_pipe;
+	/** Status pipe */
+	usb_pipe_t *status_pipe;
+	/** Data-in pipe */
+	usb_pipe_t *data_in_pipe;
+	/** Data-out pipe */
+	usb_pipe_t *data_out_pipe;
+	/** Number of tags, tag n uses stream n on the streamed pipes */
+	unsigned ntags;
+	/** Command IU of each tag (DMA buffer) */
+	uas_cmd_iu_t *cmd_iu;
+	/** Sense IU of each tag (DMA buffer) */
+	uas_sense_iu_t *sense_iu;
+	/** Protects @c busy and the state of data phases */
+	fibril_mutex_t lock;
+	/** Signalled when a tag is released or a data phase finishes */
+	fibril_condvar_t cv;
+	/** Tags in use, bit n - 1 stands for tag n */
+	uint32_t busy;
+};
+
+extern errno_t uas_init(usbmast_dev_t *);
+extern void uas_fini(usbmast_dev_t *);
+extern errno_t uas_cmd(usbmast_fun_t *, scsi_cmd_t *);
+
+#endif
+
+/**
+ * @}
+ */
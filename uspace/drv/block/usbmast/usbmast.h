@@ -41,6 +41,8 @@
 #include <stdint.h>
 #include <usb/usb.h>
 
+typedef struct usbmast_uas usbmast_uas_t;
+
 /** Mass storage device. */
 typedef struct usbmast_dev {
 	/** USB device */
@@ -53,6 +55,8 @@ typedef struct usbmast_dev {
 	usb_pipe_t *bulk_in_pipe;
 	/** Data write pipe */
 	usb_pipe_t *bulk_out_pipe;
+	/** USB Attached SCSI transport or @c NULL for bulk-only transport */
+	usbmast_uas_t *uas;
 } usbmast_dev_t;
 
 /** Mass storage function.
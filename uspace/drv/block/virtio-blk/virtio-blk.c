@@ -32,11 +32,16 @@
 #include <stdint.h>
 
 #include <as.h>
+#include <align.h>
 #include <ddf/driver.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
 #include <pci_dev_iface.h>
 #include <fibril_synch.h>
+#include <macros.h>
+#include <stats.h>
+#include <stdlib.h>
+#include <fibril.h>
 
 #include <bd_srv.h>
 
@@ -44,9 +49,6 @@
 
 #define NAME	"virtio-blk"
 
-#define VIRTIO_BLK_NUM_QUEUES	1
-
-#define RQ_QUEUE	0
 
 /*
  * VIRTIO_BLK requests need at least two descriptors so that device-read-only
@@ -56,6 +58,11 @@
  * used for request headers, the following RQ_BUFFERS descriptors are used
  * for in/out buffers and the last RQ_BUFFERS descriptors are used for request
  * footers.
+ *
+ * If the device supports indirect descriptors, only the header descriptor
+ * of a request is used. It points to the indirect table of the request,
+ * which describes the header, any number of data segments up to seg_max and
+ * the footer.
  */
 #define REQ_HEADER_DESC(descno)	(0 * RQ_BUFFERS + (descno))
 #define REQ_BUFFER_DESC(descno)	(1 * RQ_BUFFERS + (descno))
@@ -80,11 +87,18 @@ static void virtio_blk_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 	uint16_t descno;
 	uint32_t len;
 
-	while (virtio_virtq_consume_used(vdev, RQ_QUEUE, &descno, &len)) {
-		assert(descno < RQ_BUFFERS);
-		fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
-		fibril_condvar_signal(&virtio_blk->completion_cv[descno]);
-		fibril_mutex_unlock(&virtio_blk->completion_lock[descno]);
+	/* All virtqueues share the interrupt. */
+	for (unsigned i = 0; i < virtio_blk->nqueues; i++) {
+		virtio_blk_queue_t *q = &virtio_blk->queues[i];
+
+		while (virtio_virtq_consume_used(vdev, q->num, &descno,
+		    &len)) {
+			assert(descno < RQ_BUFFERS);
+			fibril_mutex_lock(&q->completion_lock[descno]);
+			q->completed[descno] = true;
+			fibril_condvar_signal(&q->completion_cv[descno]);
+			fibril_mutex_unlock(&q->completion_lock[descno]);
+		}
 	}
 }
 
@@ -113,6 +127,30 @@ static errno_t virtio_blk_register_interrupt(ddf_dev_t *dev)
 	virtio_blk->irq = res.irqs.irqs[0];
 	hw_res_list_parsed_clean(&res);
 
+	/* With MSI-X the interrupt is ours alone and the ISR stays unused */
+	int inr;
+	if (virtio_pci_msi_alloc(dev, vdev, &inr) == EOK) {
+		virtio_blk->irq = inr;
+
+		irq_cmd_t msi_commands[] = {
+			{
+				.cmd = CMD_ACCEPT
+			}
+		};
+
+		irq_code_t msi_code = {
+			.cmdcount = sizeof(msi_commands) / sizeof(irq_cmd_t),
+			.cmds = msi_commands
+		};
+
+		rc = register_interrupt_handler(dev, virtio_blk->irq,
+		    virtio_blk_irq_handler, &msi_code,
+		    &virtio_blk->irq_handle);
+		if (rc != EOK)
+			virtio_pci_msi_free(dev, vdev);
+		return rc;
+	}
+
 	irq_pio_range_t pio_ranges[] = {
 		{
 			.base = vdev->isr_phys,
@@ -157,119 +195,332 @@ static errno_t virtio_blk_bd_close(bd_srv_t *bd)
 	return EOK;
 }
 
-static errno_t virtio_blk_rw_block(virtio_blk_t *virtio_blk, bool read,
-    aoff64_t ba, void *buf)
+/** Physically contiguous data segment of a request */
+typedef struct {
+	uintptr_t phys;
+	size_t size;
+} virtio_blk_seg_t;
+
+/** Request in flight */
+typedef struct {
+	uint16_t descno;
+	/** Caller's data */
+	void *buf;
+	size_t size;
+	/** Data is transferred through the bounce buffer of the request */
+	bool bounce;
+} virtio_blk_rq_t;
+
+/** Allocate a request descriptor.
+ *
+ * The allocated descno will determine the header descriptor
+ * (REQ_HEADER_DESC), the buffer descriptor (REQ_BUFFER_DESC), the footer
+ * (REQ_FOOTER_DESC) descriptor and the indirect table.
+ *
+ * @return Descriptor number or 0xFFFF if none is free and @a wait is false.
+ */
+static uint16_t virtio_blk_desc_alloc(virtio_blk_t *virtio_blk,
+    virtio_blk_queue_t *q, bool wait)
 {
 	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
 
-	/*
-	 * Allocate a descriptor.
-	 *
-	 * The allocated descno will determine the header descriptor
-	 * (REQ_HEADER_DESC), the buffer descriptor (REQ_BUFFER_DESC) and the
-	 * footer (REQ_FOOTER_DESC) descriptor.
-	 */
-	fibril_mutex_lock(&virtio_blk->free_lock);
-	uint16_t descno = virtio_alloc_desc(vdev, RQ_QUEUE,
-	    &virtio_blk->rq_free_head);
-	while (descno == (uint16_t) -1U) {
-		fibril_condvar_wait(&virtio_blk->free_cv,
-		    &virtio_blk->free_lock);
-		descno = virtio_alloc_desc(vdev, RQ_QUEUE,
-		    &virtio_blk->rq_free_head);
+	fibril_mutex_lock(&q->free_lock);
+	uint16_t descno = virtio_alloc_desc(vdev, q->num, &q->rq_free_head);
+	while (descno == (uint16_t) -1U && wait) {
+		fibril_condvar_wait(&q->free_cv, &q->free_lock);
+		descno = virtio_alloc_desc(vdev, q->num, &q->rq_free_head);
+	}
+	fibril_mutex_unlock(&q->free_lock);
+
+	assert(descno < RQ_BUFFERS || descno == (uint16_t) -1U);
+	return descno;
+}
+
+/** Free a request descriptor. */
+static void virtio_blk_desc_free(virtio_blk_t *virtio_blk,
+    virtio_blk_queue_t *q, uint16_t descno)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	fibril_mutex_lock(&q->free_lock);
+	virtio_free_desc(vdev, q->num, &q->rq_free_head, descno);
+	fibril_condvar_signal(&q->free_cv);
+	fibril_mutex_unlock(&q->free_lock);
+}
+
+/** Describe a caller buffer by its physical segments.
+ *
+ * Pages of the buffer are touched so that they are backed by frames.
+ *
+ * @param virtio_blk Device
+ * @param buf        Buffer
+ * @param size       Size of the buffer
+ * @param segs       Array of at least seg_max segments
+ * @param nsegs      Place to store the number of segments
+ *
+ * @return Number of bytes of @a buf described, a multiple of the block size
+ */
+static size_t virtio_blk_map_segs(virtio_blk_t *virtio_blk, uint8_t *buf,
+    size_t size, virtio_blk_seg_t *segs, size_t *nsegs)
+{
+	size_t done = 0;
+	size_t n = 0;
+
+	while (done < size) {
+		volatile uint8_t *p = buf + done;
+		size_t off = (uintptr_t) p & (PAGE_SIZE - 1);
+		size_t chunk = min(size - done, PAGE_SIZE - off);
+		uintptr_t phys;
+
+		*p = *p;
+		if (as_get_physical_mapping((void *) p, &phys) != EOK)
+			break;
+
+		if (n > 0 && segs[n - 1].phys + segs[n - 1].size == phys &&
+		    segs[n - 1].size + chunk <= virtio_blk->size_max) {
+			segs[n - 1].size += chunk;
+		} else {
+			if (n == virtio_blk->seg_max)
+				break;
+			segs[n].phys = phys;
+			segs[n].size = chunk;
+			n++;
+		}
+
+		done += chunk;
 	}
-	fibril_mutex_unlock(&virtio_blk->free_lock);
 
-	assert(descno < RQ_BUFFERS);
+	/* Requests consist of whole blocks. */
+	size_t excess = done % VIRTIO_BLK_BLOCK_SIZE;
+	done -= excess;
+	while (excess > 0) {
+		if (segs[n - 1].size <= excess) {
+			excess -= segs[n - 1].size;
+			n--;
+		} else {
+			segs[n - 1].size -= excess;
+			excess = 0;
+		}
+	}
+
+	*nsegs = n;
+	return done;
+}
+
+/** Set an entry of an indirect descriptor table. */
+static void virtio_blk_indirect_set(virtq_desc_t *table, uint16_t i,
+    uint64_t addr, uint32_t len, uint16_t flags, uint16_t next)
+{
+	virtq_desc_t *d = &table[i];
+	pio_write_le64(&d->addr, addr);
+	pio_write_le32(&d->len, len);
+	pio_write_le16(&d->flags, flags);
+	pio_write_le16(&d->next, next);
+}
+
+/** Make a request available to the device.
+ *
+ * @param virtio_blk Device
+ * @param q          Request virtqueue
+ * @param descno     Request descriptor
+ * @param read       Read instead of write
+ * @param ba         First block
+ * @param segs       Data segments
+ * @param nsegs      Number of data segments, 1 without indirect descriptors
+ */
+static void virtio_blk_rq_submit(virtio_blk_t *virtio_blk,
+    virtio_blk_queue_t *q, uint16_t descno, bool read, aoff64_t ba,
+    virtio_blk_seg_t *segs, size_t nsegs)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+	uint16_t dflags = read ? VIRTQ_DESC_F_WRITE : 0;
 
 	/* Setup the request header */
 	virtio_blk_req_header_t *req_header =
-	    (virtio_blk_req_header_t *) virtio_blk->rq_header[descno];
+	    (virtio_blk_req_header_t *) q->rq_header[descno];
 	memset(req_header, 0, sizeof(virtio_blk_req_header_t));
 	pio_write_le32(&req_header->type,
 	    read ? VIRTIO_BLK_T_IN : VIRTIO_BLK_T_OUT);
 	pio_write_le64(&req_header->sector, ba);
 
-	/* Copy write data to the request. */
-	if (!read)
-		memcpy(virtio_blk->rq_buf[descno], buf, VIRTIO_BLK_BLOCK_SIZE);
-
-	fibril_mutex_lock(&virtio_blk->completion_lock[descno]);
+	fibril_mutex_lock(&q->completion_lock[descno]);
+	q->completed[descno] = false;
+	fibril_mutex_unlock(&q->completion_lock[descno]);
 
 	/*
 	 * Set the descriptors, chain them in the virtqueue and notify the
 	 * device.
 	 */
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_HEADER_DESC(descno),
-	    virtio_blk->rq_header_p[descno], sizeof(virtio_blk_req_header_t),
-	    VIRTQ_DESC_F_NEXT, REQ_BUFFER_DESC(descno));
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_BUFFER_DESC(descno),
-	    virtio_blk->rq_buf_p[descno], VIRTIO_BLK_BLOCK_SIZE,
-	    VIRTQ_DESC_F_NEXT | (read ? VIRTQ_DESC_F_WRITE : 0),
-	    REQ_FOOTER_DESC(descno));
-	virtio_virtq_desc_set(vdev, RQ_QUEUE, REQ_FOOTER_DESC(descno),
-	    virtio_blk->rq_footer_p[descno], sizeof(virtio_blk_req_footer_t),
-	    VIRTQ_DESC_F_WRITE, 0);
-	virtio_virtq_produce_available(vdev, RQ_QUEUE, descno);
+	if (virtio_blk->indirect) {
+		virtq_desc_t *table = q->rq_indirect[descno];
+
+		virtio_blk_indirect_set(table, 0,
+		    q->rq_header_p[descno],
+		    sizeof(virtio_blk_req_header_t), VIRTQ_DESC_F_NEXT, 1);
+		for (size_t i = 0; i < nsegs; i++) {
+			virtio_blk_indirect_set(table, 1 + i, segs[i].phys,
+			    segs[i].size, VIRTQ_DESC_F_NEXT | dflags, 2 + i);
+		}
+		virtio_blk_indirect_set(table, 1 + nsegs,
+		    q->rq_footer_p[descno],
+		    sizeof(virtio_blk_req_footer_t), VIRTQ_DESC_F_WRITE, 0);
+
+		virtio_virtq_desc_set(vdev, q->num, REQ_HEADER_DESC(descno),
+		    q->rq_indirect_p[descno],
+		    (nsegs + 2) * sizeof(virtq_desc_t), VIRTQ_DESC_F_INDIRECT,
+		    0);
+	} else {
+		assert(nsegs == 1);
+
+		virtio_virtq_desc_set(vdev, q->num, REQ_HEADER_DESC(descno),
+		    q->rq_header_p[descno],
+		    sizeof(virtio_blk_req_header_t), VIRTQ_DESC_F_NEXT,
+		    REQ_BUFFER_DESC(descno));
+		virtio_virtq_desc_set(vdev, q->num, REQ_BUFFER_DESC(descno),
+		    segs[0].phys, segs[0].size, VIRTQ_DESC_F_NEXT | dflags,
+		    REQ_FOOTER_DESC(descno));
+		virtio_virtq_desc_set(vdev, q->num, REQ_FOOTER_DESC(descno),
+		    q->rq_footer_p[descno],
+		    sizeof(virtio_blk_req_footer_t), VIRTQ_DESC_F_WRITE, 0);
+	}
 
-	/*
-	 * Wait for the completion of the request.
-	 */
-	fibril_condvar_wait(&virtio_blk->completion_cv[descno],
-	    &virtio_blk->completion_lock[descno]);
-	fibril_mutex_unlock(&virtio_blk->completion_lock[descno]);
+	virtio_virtq_produce_available(vdev, q->num, descno);
+}
+
+/** Wait for the completion of a request.
+ *
+ * @return Status of the request
+ */
+static errno_t virtio_blk_rq_wait(virtio_blk_queue_t *q, uint16_t descno)
+{
+	fibril_mutex_lock(&q->completion_lock[descno]);
+	while (!q->completed[descno]) {
+		fibril_condvar_wait(&q->completion_cv[descno],
+		    &q->completion_lock[descno]);
+	}
+	fibril_mutex_unlock(&q->completion_lock[descno]);
 
-	errno_t rc;
 	virtio_blk_req_footer_t *footer =
-	    (virtio_blk_req_footer_t *) virtio_blk->rq_footer[descno];
+	    (virtio_blk_req_footer_t *) q->rq_footer[descno];
 	switch (footer->status) {
 	case VIRTIO_BLK_S_OK:
-		rc = EOK;
-		break;
+		return EOK;
 	case VIRTIO_BLK_S_IOERR:
-		rc = EIO;
-		break;
+		return EIO;
 	case VIRTIO_BLK_S_UNSUPP:
-		rc = ENOTSUP;
-		break;
+		return ENOTSUP;
 	default:
 		ddf_msg(LVL_DEBUG, "device returned unknown status=%d\n",
 		    (int) footer->status);
-		rc = EIO;
-		break;
+		return EIO;
 	}
+}
 
-	/* Copy read data from the request */
-	if (rc == EOK && read)
-		memcpy(buf, virtio_blk->rq_buf[descno], VIRTIO_BLK_BLOCK_SIZE);
+/** Start a request for a part of a transfer.
+ *
+ * @param virtio_blk Device
+ * @param q          Request virtqueue
+ * @param descno     Free request descriptor
+ * @param read       Read instead of write
+ * @param ba         First block
+ * @param data       Data of the request
+ * @param size       Size of the rest of the transfer
+ * @param shared     @a data lies in memory shared by the client
+ * @param rq         Request structure to fill in
+ *
+ * @return Number of bytes the request transfers
+ */
+static size_t virtio_blk_rq_start(virtio_blk_t *virtio_blk,
+    virtio_blk_queue_t *q, uint16_t descno, bool read, aoff64_t ba,
+    uint8_t *data, size_t size, bool shared, virtio_blk_rq_t *rq)
+{
+	virtio_blk_seg_t segs[RQ_SEGS_MAX];
+	size_t nsegs = 0;
+	size_t len = 0;
+
+	if (shared)
+		len = virtio_blk_map_segs(virtio_blk, data, size, segs, &nsegs);
+
+	rq->bounce = len == 0;
+	if (rq->bounce) {
+		len = min(size, virtio_blk->bounce_max);
+		segs[0].phys = q->rq_buf_p[descno];
+		segs[0].size = len;
+		nsegs = 1;
+		if (!read)
+			memcpy(q->rq_buf[descno], data, len);
+	}
 
-	/* Free the descriptor and buffer */
-	fibril_mutex_lock(&virtio_blk->free_lock);
-	virtio_free_desc(vdev, RQ_QUEUE, &virtio_blk->rq_free_head, descno);
-	fibril_condvar_signal(&virtio_blk->free_cv);
-	fibril_mutex_unlock(&virtio_blk->free_lock);
+	virtio_blk_rq_submit(virtio_blk, q, descno, read, ba, segs, nsegs);
 
-	return rc;
+	rq->descno = descno;
+	rq->buf = data;
+	rq->size = len;
+	return len;
 }
 
+/** Read or write blocks.
+ *
+ * The transfer is split into requests of as many sectors as fit into one
+ * request, which are kept in flight in as many descriptors as are free.
+ * Data in the buffer shared by the client through the queued protocol is
+ * transferred by DMA directly using indirect descriptors, other data goes
+ * through the bounce buffers of the requests. Transfers are spread over the
+ * request virtqueues in turn.
+ */
 static errno_t virtio_blk_bd_rw_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
     void *buf, size_t size, bool read)
 {
 	virtio_blk_t *virtio_blk = (virtio_blk_t *) bd->srvs->sarg;
-	aoff64_t i;
-	errno_t rc;
+	virtio_blk_queue_t *q = &virtio_blk->queues[
+	    atomic_fetch_add(&virtio_blk->next_queue, 1) % virtio_blk->nqueues];
+	virtio_blk_rq_t pend[RQ_BUFFERS];
+	size_t head = 0;
+	size_t npend = 0;
+	size_t done = 0;
+	errno_t rc = EOK;
 
 	if (size != cnt * VIRTIO_BLK_BLOCK_SIZE)
 		return EINVAL;
 
-	for (i = 0; i < cnt; i++) {
-		rc = virtio_blk_rw_block(virtio_blk, read, ba + i,
-		    buf + i * VIRTIO_BLK_BLOCK_SIZE);
-		if (rc != EOK)
-			return rc;
+	uint8_t *qbuf = bd->qbuf;
+	bool shared = virtio_blk->indirect && qbuf != NULL &&
+	    (uint8_t *) buf >= qbuf &&
+	    (uint8_t *) buf + size <= qbuf + bd->qsize;
+
+	/* Only wait for a descriptor if none of ours is in flight. */
+	while (npend > 0 || (rc == EOK && done < size)) {
+		if (rc == EOK && done < size) {
+			uint16_t descno = virtio_blk_desc_alloc(virtio_blk, q,
+			    npend == 0);
+			if (descno != (uint16_t) -1U) {
+				done += virtio_blk_rq_start(virtio_blk, q,
+				    descno, read,
+				    ba + done / VIRTIO_BLK_BLOCK_SIZE,
+				    (uint8_t *) buf + done, size - done, shared,
+				    &pend[(head + npend) % RQ_BUFFERS]);
+				npend++;
+				continue;
+			}
+		}
+
+		/* Complete the oldest request in flight */
+		virtio_blk_rq_t *rq = &pend[head];
+		errno_t rrc = virtio_blk_rq_wait(q, rq->descno);
+		if (rrc == EOK && read && rq->bounce) {
+			memcpy(rq->buf, q->rq_buf[rq->descno],
+			    rq->size);
+		}
+
+		virtio_blk_desc_free(virtio_blk, q, rq->descno);
+		head = (head + 1) % RQ_BUFFERS;
+		npend--;
+
+		if (rc == EOK)
+			rc = rrc;
 	}
 
-	return EOK;
+	return rc;
 }
 
 static errno_t virtio_blk_bd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
@@ -307,6 +558,74 @@ bd_ops_t virtio_blk_bd_ops = {
 	.get_num_blocks = virtio_blk_bd_get_num_blocks,
 };
 
+/** Set up one request virtqueue with its DMA buffers and free list. */
+static errno_t virtio_blk_queue_setup(virtio_blk_t *virtio_blk,
+    virtio_blk_queue_t *q, uint16_t num)
+{
+	virtio_dev_t *vdev = &virtio_blk->virtio_dev;
+
+	q->num = num;
+	fibril_mutex_initialize(&q->free_lock);
+	fibril_condvar_initialize(&q->free_cv);
+
+	for (unsigned i = 0; i < RQ_BUFFERS; i++) {
+		fibril_mutex_initialize(&q->completion_lock[i]);
+		fibril_condvar_initialize(&q->completion_cv[i]);
+	}
+
+	/* For each in/out request we need 3 descriptors */
+	errno_t rc = virtio_virtq_setup(vdev, q->num, 3 * RQ_BUFFERS);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Setup DMA buffers
+	 */
+	rc = virtio_setup_dma_bufs(RQ_BUFFERS, sizeof(virtio_blk_req_header_t),
+	    true, q->rq_header, q->rq_header_p);
+	if (rc != EOK)
+		return rc;
+	rc = virtio_setup_dma_bufs(RQ_BUFFERS, RQ_BUF_SIZE,
+	    true, q->rq_buf, q->rq_buf_p);
+	if (rc != EOK)
+		return rc;
+	if (virtio_blk->indirect) {
+		rc = virtio_setup_dma_bufs(RQ_BUFFERS,
+		    RQ_INDIRECT_DESCS * sizeof(virtq_desc_t), true,
+		    q->rq_indirect, q->rq_indirect_p);
+		if (rc != EOK)
+			return rc;
+	}
+	rc = virtio_setup_dma_bufs(RQ_BUFFERS, sizeof(virtio_blk_req_footer_t),
+	    false, q->rq_footer, q->rq_footer_p);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Put all request descriptors on a free list. Because of the
+	 * correspondence between the request, buffer and footer descriptors,
+	 * we only need to manage allocations for one set: the request header
+	 * descriptors.
+	 */
+	virtio_create_desc_free_list(vdev, q->num, RQ_BUFFERS,
+	    &q->rq_free_head);
+
+	return EOK;
+}
+
+/** Release the DMA buffers of all request virtqueues. */
+static void virtio_blk_queues_teardown(virtio_blk_t *virtio_blk)
+{
+	for (unsigned i = 0; i < VIRTIO_BLK_MAX_QUEUES; i++) {
+		virtio_blk_queue_t *q = &virtio_blk->queues[i];
+
+		virtio_teardown_dma_bufs(q->rq_header);
+		virtio_teardown_dma_bufs(q->rq_buf);
+		virtio_teardown_dma_bufs(q->rq_footer);
+		virtio_teardown_dma_bufs(q->rq_indirect);
+	}
+}
+
 static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 {
 	virtio_blk_t *virtio_blk = ddf_dev_data_alloc(dev,
@@ -314,14 +633,6 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 	if (!virtio_blk)
 		return ENOMEM;
 
-	fibril_mutex_initialize(&virtio_blk->free_lock);
-	fibril_condvar_initialize(&virtio_blk->free_cv);
-
-	for (unsigned i = 0; i < RQ_BUFFERS; i++) {
-		fibril_mutex_initialize(&virtio_blk->completion_lock[i]);
-		fibril_condvar_initialize(&virtio_blk->completion_cv[i]);
-	}
-
 	bd_srvs_init(&virtio_blk->bds);
 	virtio_blk->bds.ops = &virtio_blk_bd_ops;
 	virtio_blk->bds.sarg = virtio_blk;
@@ -341,58 +652,86 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/* Reset the device and negotiate the feature bits */
-	rc = virtio_device_setup_start(vdev, 0);
+	uint32_t features;
+	rc = virtio_device_setup_start_opt(vdev, 0,
+	    VIRTIO_RING_F_INDIRECT_DESC | VIRTIO_BLK_F_SIZE_MAX |
+	    VIRTIO_BLK_F_SEG_MAX | VIRTIO_BLK_F_MQ, &features);
 	if (rc != EOK)
 		goto fail;
 
 	/* Perform device-specific setup */
+	virtio_blk_cfg_t *blkcfg = vdev->device_cfg;
+
+	virtio_blk->indirect = (features & VIRTIO_RING_F_INDIRECT_DESC) != 0;
+
+	virtio_blk->seg_max = RQ_SEGS_MAX;
+	if ((features & VIRTIO_BLK_F_SEG_MAX) != 0) {
+		virtio_blk->seg_max = max(min(pio_read_le32(&blkcfg->seg_max),
+		    RQ_SEGS_MAX), 1);
+	}
+
+	virtio_blk->size_max = SIZE_MAX;
+	if ((features & VIRTIO_BLK_F_SIZE_MAX) != 0 &&
+	    pio_read_le32(&blkcfg->size_max) != 0)
+		virtio_blk->size_max = pio_read_le32(&blkcfg->size_max);
+
+	virtio_blk->bounce_max = max(ALIGN_DOWN(min(virtio_blk->size_max,
+	    RQ_BUF_SIZE), VIRTIO_BLK_BLOCK_SIZE), VIRTIO_BLK_BLOCK_SIZE);
+
+	ddf_msg(LVL_NOTE, "indirect descriptors %s, seg_max %zu",
+	    virtio_blk->indirect ? "on" : "off", virtio_blk->seg_max);
 
 	/*
-	 * Discover and configure the virtqueue
+	 * Discover and configure the virtqueues. The device exposes no more
+	 * request virtqueues than it advertises in num_queues; there is no
+	 * point in using more of them than there are CPUs to drive them.
 	 */
 	uint16_t num_queues = pio_read_le16(&cfg->num_queues);
-	if (num_queues != VIRTIO_BLK_NUM_QUEUES) {
+	if (num_queues < 1) {
 		ddf_msg(LVL_NOTE, "Unsupported number of virtqueues: %u",
 		    num_queues);
 		rc = ELIMIT;
 		goto fail;
 	}
 
+	unsigned nqueues = 1;
+	if ((features & VIRTIO_BLK_F_MQ) != 0) {
+		nqueues = min(pio_read_le16(&blkcfg->num_queues),
+		    num_queues);
+		nqueues = max(min(nqueues, VIRTIO_BLK_MAX_QUEUES), 1);
+	}
+
+	size_t ncpus;
+	stats_cpu_t *cpus = stats_get_cpus(&ncpus);
+	if (cpus != NULL) {
+		nqueues = max(min(nqueues, ncpus), 1);
+		free(cpus);
+	}
+
 	vdev->queues = calloc(sizeof(virtq_t), num_queues);
 	if (!vdev->queues) {
 		rc = ENOMEM;
 		goto fail;
 	}
 
-	/* For each in/out request we need 3 descriptors */
-	rc = virtio_virtq_setup(vdev, RQ_QUEUE, 3 * RQ_BUFFERS);
-	if (rc != EOK)
-		goto fail;
+	for (unsigned i = 0; i < nqueues; i++) {
+		rc = virtio_blk_queue_setup(virtio_blk,
+		    &virtio_blk->queues[i], i);
+		if (rc != EOK)
+			goto fail;
+	}
 
-	/*
-	 * Setup DMA buffers
-	 */
-	rc = virtio_setup_dma_bufs(RQ_BUFFERS, sizeof(virtio_blk_req_header_t),
-	    true, virtio_blk->rq_header, virtio_blk->rq_header_p);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_setup_dma_bufs(RQ_BUFFERS, VIRTIO_BLK_BLOCK_SIZE,
-	    true, virtio_blk->rq_buf, virtio_blk->rq_buf_p);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_setup_dma_bufs(RQ_BUFFERS, sizeof(virtio_blk_req_footer_t),
-	    false, virtio_blk->rq_footer, virtio_blk->rq_footer_p);
-	if (rc != EOK)
-		goto fail;
+	virtio_blk->nqueues = nqueues;
+	atomic_init(&virtio_blk->next_queue, 0);
 
-	/*
-	 * Put all request descriptors on a free list. Because of the
-	 * correspondence between the request, buffer and footer descriptors,
-	 * we only need to manage allocations for one set: the request header
-	 * descriptors.
-	 */
-	virtio_create_desc_free_list(vdev, RQ_QUEUE, RQ_BUFFERS,
-	    &virtio_blk->rq_free_head);
+	/* Each request buffer can carry one request at a time. */
+	virtio_blk->bds.queue_depth = RQ_BUFFERS * nqueues;
+
+	/* Let the request queues be driven from more than one CPU. */
+	if (nqueues > 1)
+		fibril_test_spawn_runners(nqueues - 1);
+
+	ddf_msg(LVL_NOTE, "Using %u request virtqueue(s)", nqueues);
 
 	/*
 	 * Enable IRQ
@@ -412,11 +751,10 @@ static errno_t virtio_blk_initialize(ddf_dev_t *dev)
 	return EOK;
 
 fail:
-	virtio_teardown_dma_bufs(virtio_blk->rq_header);
-	virtio_teardown_dma_bufs(virtio_blk->rq_buf);
-	virtio_teardown_dma_bufs(virtio_blk->rq_footer);
+	virtio_blk_queues_teardown(virtio_blk);
 
 	virtio_device_setup_fail(vdev);
+	virtio_pci_msi_free(dev, vdev);
 	virtio_pci_dev_cleanup(vdev);
 	return rc;
 }
@@ -425,11 +763,10 @@ static void virtio_blk_uninitialize(ddf_dev_t *dev)
 {
 	virtio_blk_t *virtio_blk = (virtio_blk_t *) ddf_dev_data_get(dev);
 
-	virtio_teardown_dma_bufs(virtio_blk->rq_header);
-	virtio_teardown_dma_bufs(virtio_blk->rq_buf);
-	virtio_teardown_dma_bufs(virtio_blk->rq_footer);
+	virtio_blk_queues_teardown(virtio_blk);
 
 	virtio_device_setup_fail(&virtio_blk->virtio_dev);
+	virtio_pci_msi_free(dev, &virtio_blk->virtio_dev);
 	virtio_pci_dev_cleanup(&virtio_blk->virtio_dev);
 }
 
@@ -34,6 +34,7 @@
 #include <abi/cap.h>
 
 #include <fibril_synch.h>
+#include <stdatomic.h>
 
 #define VIRTIO_BLK_BLOCK_SIZE	512
 
@@ -48,9 +49,30 @@
 
 #define RQ_BUFFERS	32
 
+/** Size of the bounce buffer of a request. */
+#define RQ_BUF_SIZE	(64 * 1024)
+
+/** Maximum number of data segments in an indirect request. */
+#define RQ_SEGS_MAX	64
+
+/** Indirect descriptors of a request: header, data segments and footer. */
+#define RQ_INDIRECT_DESCS	(RQ_SEGS_MAX + 2)
+
+/** Maximum size of a segment is in size_max. */
+#define VIRTIO_BLK_F_SIZE_MAX	(1U << 1)
+
+/** Maximum number of segments in a request is in seg_max. */
+#define VIRTIO_BLK_F_SEG_MAX	(1U << 2)
+
 /** Device is read-only. */
 #define VIRTIO_BLK_F_RO		(1U << 5)
 
+/** Device supports multiple request virtqueues, number is in num_queues. */
+#define VIRTIO_BLK_F_MQ		(1U << 12)
+
+/** Maximum number of request virtqueues used. */
+#define VIRTIO_BLK_MAX_QUEUES	4
+
 typedef struct {
 	uint32_t type;
 	uint32_t reserved;
@@ -63,10 +85,25 @@ typedef struct {
 
 typedef struct {
 	uint64_t capacity;
+	uint32_t size_max;
+	uint32_t seg_max;
+	uint16_t cylinders;
+	uint8_t heads;
+	uint8_t sectors;
+	uint32_t blk_size;
+	uint8_t physical_block_exp;
+	uint8_t alignment_offset;
+	uint16_t min_io_size;
+	uint32_t opt_io_size;
+	uint8_t writeback;
+	uint8_t unused0;
+	uint16_t num_queues;
 } virtio_blk_cfg_t;
 
+/** Request virtqueue */
 typedef struct {
-	virtio_dev_t virtio_dev;
+	/** Index of the virtqueue */
+	uint16_t num;
 
 	void *rq_header[RQ_BUFFERS];
 	uintptr_t rq_header_p[RQ_BUFFERS];
@@ -77,18 +114,43 @@ typedef struct {
 	void *rq_footer[RQ_BUFFERS];
 	uintptr_t rq_footer_p[RQ_BUFFERS];
 
-	uint16_t rq_free_head;
-
-	int irq;
-	cap_irq_handle_t irq_handle;
+	/** Indirect descriptor tables, used with VIRTIO_RING_F_INDIRECT_DESC */
+	void *rq_indirect[RQ_BUFFERS];
+	uintptr_t rq_indirect_p[RQ_BUFFERS];
 
-	bd_srvs_t bds;
+	uint16_t rq_free_head;
 
 	fibril_mutex_t free_lock;
 	fibril_condvar_t free_cv;
 
 	fibril_mutex_t completion_lock[RQ_BUFFERS];
 	fibril_condvar_t completion_cv[RQ_BUFFERS];
+	bool completed[RQ_BUFFERS];
+} virtio_blk_queue_t;
+
+typedef struct {
+	virtio_dev_t virtio_dev;
+
+	/** Request virtqueues */
+	virtio_blk_queue_t queues[VIRTIO_BLK_MAX_QUEUES];
+	/** Number of request virtqueues in use */
+	unsigned nqueues;
+	/** Counter spreading transfers over the request virtqueues */
+	atomic_uint next_queue;
+
+	/** Indirect descriptors are used */
+	bool indirect;
+	/** Maximum number of data segments in a request */
+	size_t seg_max;
+	/** Maximum size of a data segment */
+	size_t size_max;
+	/** Maximum size of a request using the bounce buffer */
+	size_t bounce_max;
+
+	int irq;
+	cap_irq_handle_t irq_handle;
+
+	bd_srvs_t bds;
 } virtio_blk_t;
 
 #endif
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @addtogroup pciintel
+ * @{
+ */
+
+/** @file Message signalled interrupts
+ *
+ * Programs the MSI and MSI-X capabilities of PCI functions with vectors
+ * allocated by the kernel. MSI-X is preferred as it allows each vector to
+ * be masked and placed independently.
+ */
+
+#include <ddf/log.h>
+#include <ddi.h>
+#include <errno.h>
+#include <ipc/irq.h>
+#include <macros.h>
+
+#include "msi.h"
+#include "pci.h"
+#include "pci_regs.h"
+
+/** Allocate a block of interrupt vectors.
+ *
+ * If there are not enough free vectors, settle for fewer.
+ *
+ * @param count	Number of vectors requested
+ * @param msi	Place to store the block
+ * @param nvec	Place to store the number of vectors allocated
+ * @return	EOK on success or an error code
+ */
+static errno_t pci_msi_vectors(size_t count, irq_msi_t *msi, size_t *nvec)
+{
+	errno_t rc;
+
+	while (true) {
+		rc = irq_msi_alloc(count, msi);
+		if (rc != ELIMIT || count == 1)
+			break;
+
+		count /= 2;
+	}
+
+	if (rc == EOK)
+		*nvec = count;
+
+	return rc;
+}
+
+/** Switch function to MSI-X.
+ *
+ * @param fun	PCI function
+ * @param count	Number of vectors requested
+ * @return	EOK on success or an error code
+ */
+static errno_t pci_msix_enable(pci_fun_t *fun, size_t count)
+{
+	uint16_t ctl = pci_conf_read_16(fun, fun->msix_cap + PCI_MSIX_CTL);
+	uint32_t table = pci_conf_read_32(fun, fun->msix_cap + PCI_MSIX_TABLE);
+	unsigned bir = PCI_MSIX_TABLE_BIR(table);
+	size_t tsize = PCI_MSIX_CTL_SIZE(ctl);
+	ioport32_t *regs;
+	irq_msi_t msi;
+	size_t nvec;
+	size_t i;
+	errno_t rc;
+
+	if (bir >= PCI_BAR_COUNT || fun->bar_addr[bir] == 0)
+		return EIO;
+
+	rc = pci_msi_vectors(min(count, tsize), &msi, &nvec);
+	if (rc != EOK)
+		return rc;
+
+	rc = pio_enable((void *) (uintptr_t) (fun->bar_addr[bir] +
+	    PCI_MSIX_TABLE_OFFSET(table)), tsize * PCI_MSIX_ENTRY_SIZE,
+	    (void **) &regs);
+	if (rc != EOK) {
+		irq_msi_free(msi.inr, nvec);
+		return rc;
+	}
+
+	/* Keep all vectors masked while the table is being filled in. */
+	pci_conf_write_16(fun, fun->msix_cap + PCI_MSIX_CTL,
+	    ctl | PCI_MSIX_CTL_ENABLE | PCI_MSIX_CTL_MASKALL);
+
+	for (i = 0; i < tsize; i++) {
+		ioport32_t *ent = regs + i * PCI_MSIX_ENTRY_SIZE / 4;
+
+		if (i >= nvec) {
+			pio_write_le32(&ent[PCI_MSIX_ENTRY_CTL / 4],
+			    PCI_MSIX_ENTRY_CTL_MASK);
+			continue;
+		}
+
+		pio_write_le32(&ent[PCI_MSIX_ENTRY_ADDR_LO / 4],
+		    (uint32_t) msi.address);
+		pio_write_le32(&ent[PCI_MSIX_ENTRY_ADDR_HI / 4],
+		    (uint32_t) (msi.address >> 32));
+		pio_write_le32(&ent[PCI_MSIX_ENTRY_DATA / 4], msi.data + i);
+		pio_write_le32(&ent[PCI_MSIX_ENTRY_CTL / 4], 0);
+	}
+
+	(void) pio_disable((void *) regs, tsize * PCI_MSIX_ENTRY_SIZE);
+
+	pci_conf_write_16(fun, fun->msix_cap + PCI_MSIX_CTL,
+	    (ctl | PCI_MSIX_CTL_ENABLE) & ~PCI_MSIX_CTL_MASKALL);
+
+	fun->msix = true;
+	fun->msi_inr = msi.inr;
+	fun->msi_count = nvec;
+	return EOK;
+}
+
+/** Switch function to MSI.
+ *
+ * MSI can only use a power of two number of vectors.
+ *
+ * @param fun	PCI function
+ * @param count	Number of vectors requested
+ * @return	EOK on success or an error code
+ */
+static errno_t pci_msi_enable(pci_fun_t *fun, size_t count)
+{
+	uint16_t ctl = pci_conf_read_16(fun, fun->msi_cap + PCI_MSI_CTL);
+	size_t max = min(count, (size_t) 1 << PCI_MSI_CTL_MMC(ctl));
+	unsigned mme;
+	irq_msi_t msi;
+	size_t nvec;
+	errno_t rc;
+
+	nvec = 1;
+	while (nvec * 2 <= max)
+		nvec *= 2;
+
+	rc = pci_msi_vectors(nvec, &msi, &nvec);
+	if (rc != EOK)
+		return rc;
+
+	pci_conf_write_32(fun, fun->msi_cap + PCI_MSI_ADDR_LO,
+	    (uint32_t) msi.address);
+
+	if ((ctl & PCI_MSI_CTL_64BIT) != 0) {
+		pci_conf_write_32(fun, fun->msi_cap + PCI_MSI_ADDR_HI,
+		    (uint32_t) (msi.address >> 32));
+		pci_conf_write_16(fun, fun->msi_cap + PCI_MSI_DATA_64,
+		    msi.data);
+	} else {
+		if ((msi.address >> 32) != 0) {
+			irq_msi_free(msi.inr, nvec);
+			return ENOTSUP;
+		}
+
+		pci_conf_write_16(fun, fun->msi_cap + PCI_MSI_DATA_32,
+		    msi.data);
+	}
+
+	for (mme = 0; ((size_t) 1 << mme) < nvec; mme++)
+		;
+
+	ctl &= ~PCI_MSI_CTL_MME_MASK;
+	ctl |= (mme << PCI_MSI_CTL_MME_SHIFT) | PCI_MSI_CTL_ENABLE;
+	pci_conf_write_16(fun, fun->msi_cap + PCI_MSI_CTL, ctl);
+
+	fun->msix = false;
+	fun->msi_inr = msi.inr;
+	fun->msi_count = nvec;
+	return EOK;
+}
+
+/** Switch function to message signalled interrupts.
+ *
+ * @param fun	PCI function
+ * @param count	Number of vectors the driver would like to use
+ * @param inr	Place to store INR of the first vector
+ * @param nvec	Place to store number of vectors allocated
+ * @return	EOK on success, ENOTSUP if the function does not support
+ *		message signalled interrupts, EBUSY if they are already
+ *		enabled, ELIMIT if no vector is available
+ */
+errno_t pci_msi_alloc(pci_fun_t *fun, size_t count, int *inr, size_t *nvec)
+{
+	errno_t rc = ENOTSUP;
+
+	if (count == 0)
+		return EINVAL;
+
+	if (fun->msi_count > 0)
+		return EBUSY;
+
+	if (fun->msix_cap != 0)
+		rc = pci_msix_enable(fun, count);
+
+	if (rc != EOK && fun->msi_cap != 0)
+		rc = pci_msi_enable(fun, count);
+
+	if (rc != EOK)
+		return rc;
+
+	/* Mute the legacy interrupt line. */
+	pci_conf_write_16(fun, PCI_COMMAND, pci_conf_read_16(fun,
+	    PCI_COMMAND) | PCI_COMMAND_INTX_DISABLE);
+
+	ddf_msg(LVL_NOTE, "Function %s uses %zu %s vectors from irq %x.",
+	    ddf_fun_get_name(fun->fnode), fun->msi_count,
+	    fun->msix ? "MSI-X" : "MSI", fun->msi_inr);
+
+	*inr = fun->msi_inr;
+	*nvec = fun->msi_count;
+	return EOK;
+}
+
+/** Switch function back to its legacy interrupt.
+ *
+ * @param fun	PCI function
+ * @return	EOK on success, ENOENT if message signalled interrupts
+ *		are not enabled
+ */
+errno_t pci_msi_free(pci_fun_t *fun)
+{
+	uint16_t ctl;
+
+	if (fun->msi_count == 0)
+		return ENOENT;
+
+	if (fun->msix) {
+		ctl = pci_conf_read_16(fun, fun->msix_cap + PCI_MSIX_CTL);
+		pci_conf_write_16(fun, fun->msix_cap + PCI_MSIX_CTL,
+		    ctl & ~PCI_MSIX_CTL_ENABLE);
+	} else {
+		ctl = pci_conf_read_16(fun, fun->msi_cap + PCI_MSI_CTL);
+		pci_conf_write_16(fun, fun->msi_cap + PCI_MSI_CTL,
+		    ctl & ~PCI_MSI_CTL_ENABLE);
+	}
+
+	pci_conf_write_16(fun, PCI_COMMAND, pci_conf_read_16(fun,
+	    PCI_COMMAND) & ~PCI_COMMAND_INTX_DISABLE);
+
+	(void) irq_msi_free(fun->msi_inr, fun->msi_count);
+	fun->msi_count = 0;
+	return EOK;
+}
+
+/**
+ * @}
+ */
@@ -58,6 +58,7 @@
 #include <pci_dev_iface.h>
 
 #include "ctl.h"
+#include "msi.h"
 #include "pci.h"
 #include "pci_regs.h"
 
@@ -97,6 +98,13 @@ static hw_resource_list_t *pciintel_get_resources(ddf_fun_t *fnode)
 	return &fun->hw_resources;
 }
 
+/** Determine whether interrupt is one of the function's MSI vectors. */
+static bool pciintel_fun_owns_msi(pci_fun_t *fun, int irq)
+{
+	return fun->msi_count > 0 && irq >= fun->msi_inr &&
+	    (size_t) (irq - fun->msi_inr) < fun->msi_count;
+}
+
 static bool pciintel_fun_owns_interrupt(pci_fun_t *fun, int irq)
 {
 	size_t i;
@@ -116,6 +124,10 @@ static errno_t pciintel_enable_interrupt(ddf_fun_t *fnode, int irq)
 {
 	pci_fun_t *fun = pci_fun(fnode);
 
+	/* Message signalled interrupts bypass the interrupt controller */
+	if (pciintel_fun_owns_msi(fun, irq))
+		return EOK;
+
 	if (!pciintel_fun_owns_interrupt(fun, irq))
 		return EINVAL;
 
@@ -126,6 +138,10 @@ static errno_t pciintel_disable_interrupt(ddf_fun_t *fnode, int irq)
 {
 	pci_fun_t *fun = pci_fun(fnode);
 
+	/* Message signalled interrupts bypass the interrupt controller */
+	if (pciintel_fun_owns_msi(fun, irq))
+		return EOK;
+
 	if (!pciintel_fun_owns_interrupt(fun, irq))
 		return EINVAL;
 
@@ -136,12 +152,27 @@ static errno_t pciintel_clear_interrupt(ddf_fun_t *fnode, int irq)
 {
 	pci_fun_t *fun = pci_fun(fnode);
 
+	/* Message signalled interrupts bypass the interrupt controller */
+	if (pciintel_fun_owns_msi(fun, irq))
+		return EOK;
+
 	if (!pciintel_fun_owns_interrupt(fun, irq))
 		return EINVAL;
 
 	return irc_clear_interrupt(irq);
 }
 
+static errno_t pciintel_msi_alloc(ddf_fun_t *fnode, size_t count, int *inr,
+    size_t *nvec)
+{
+	return pci_msi_alloc(pci_fun(fnode), count, inr, nvec);
+}
+
+static errno_t pciintel_msi_free(ddf_fun_t *fnode)
+{
+	return pci_msi_free(pci_fun(fnode));
+}
+
 static pio_window_t *pciintel_get_pio_window(ddf_fun_t *fnode)
 {
 	pci_fun_t *fun = pci_fun(fnode);
@@ -210,6 +241,8 @@ static hw_res_ops_t pciintel_hw_res_ops = {
 	.enable_interrupt = &pciintel_enable_interrupt,
 	.disable_interrupt = &pciintel_disable_interrupt,
 	.clear_interrupt = &pciintel_clear_interrupt,
+	.msi_alloc = &pciintel_msi_alloc,
+	.msi_free = &pciintel_msi_free,
 };
 
 static pio_window_ops_t pciintel_pio_window_ops = {
@@ -591,6 +624,9 @@ int pci_read_bar(pci_fun_t *fun, int addr)
 
 	pci_add_range(fun, range_addr, range_size, io);
 
+	if (!io)
+		fun->bar_addr[(addr - PCI_BASE_ADDR_0) / 4] = range_addr;
+
 	if (addrw64)
 		return addr + 8;
 
@@ -690,6 +726,7 @@ errno_t pci_bus_scan(pci_bus_t *bus, int bus_num)
 			pci_alloc_resource_list(fun);
 			pci_read_bars(fun);
 			pci_read_interrupt(fun);
+			pci_read_caps(fun);
 
 			/* Propagate the PIO window to the function. */
 			fun->pio_window = bus->pio_win;
@@ -972,6 +1009,32 @@ void pci_read_bars(pci_fun_t *fun)
 		addr = pci_read_bar(fun, addr);
 }
 
+/** Find the capabilities of the function the driver makes use of.
+ *
+ * @param fun	PCI function
+ */
+void pci_read_caps(pci_fun_t *fun)
+{
+	/* Bound the walk in case the capability list is corrupt */
+	int ttl = 48;
+	uint8_t ptr;
+	uint8_t id;
+
+	if ((pci_conf_read_16(fun, PCI_STATUS) & PCI_STATUS_CAP_LIST) == 0)
+		return;
+
+	ptr = pci_conf_read_8(fun, PCI_CAP_PTR) & ~0x3;
+	while (ptr != 0 && ttl-- > 0) {
+		id = pci_conf_read_8(fun, PCI_CAP_ID(ptr));
+		if (id == PCI_CAP_MSI)
+			fun->msi_cap = ptr;
+		else if (id == PCI_CAP_MSIX)
+			fun->msix_cap = ptr;
+
+		ptr = pci_conf_read_8(fun, PCI_CAP_NEXT(ptr)) & ~0x3;
+	}
+}
+
 size_t pci_bar_mask_to_size(uint32_t mask)
 {
 	size_t size = mask & ~(mask - 1);
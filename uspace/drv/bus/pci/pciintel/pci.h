@@ -40,6 +40,7 @@
 #include <ddi.h>
 #include <ddf/driver.h>
 #include <fibril_synch.h>
+#include <pci_dev_iface.h>
 
 #define PCI_MAX_HW_RES 10
 
@@ -74,6 +75,19 @@ typedef struct pci_fun_data {
 	hw_resource_list_t hw_resources;
 	hw_resource_t resources[PCI_MAX_HW_RES];
 	pio_window_t pio_window;
+	/** Addresses of memory BARs, zero for I/O and unimplemented BARs */
+	uint64_t bar_addr[PCI_BAR_COUNT];
+
+	/** Offset of the MSI capability, zero if there is none */
+	uint8_t msi_cap;
+	/** Offset of the MSI-X capability, zero if there is none */
+	uint8_t msix_cap;
+	/** Message signalled interrupts are delivered through MSI-X */
+	bool msix;
+	/** INR of the first message signalled interrupt */
+	int msi_inr;
+	/** Number of message signalled interrupts, zero when using INTx */
+	size_t msi_count;
 } pci_fun_t;
 
 extern pci_bus_t *pci_bus(ddf_dev_t *);
@@ -105,6 +119,7 @@ extern bool pci_alloc_resource_list(pci_fun_t *);
 extern void pci_clean_resource_list(pci_fun_t *);
 
 extern void pci_read_bars(pci_fun_t *);
+extern void pci_read_caps(pci_fun_t *);
 extern size_t pci_bar_mask_to_size(uint32_t);
 
 #endif
@@ -107,6 +107,38 @@
 #define PCI_COMMAND_FAST_BACK     0x200
 #define PCI_COMMAND_INTX_DISABLE  0x400
 
+/* MSI capability */
+#define PCI_MSI_CTL		0x02
+#define PCI_MSI_ADDR_LO		0x04
+#define PCI_MSI_ADDR_HI		0x08
+#define PCI_MSI_DATA_32		0x08
+#define PCI_MSI_DATA_64		0x0C
+
+#define PCI_MSI_CTL_ENABLE	0x0001
+#define PCI_MSI_CTL_MMC(ctl)	(((ctl) >> 1) & 0x7)
+#define PCI_MSI_CTL_MME_SHIFT	4
+#define PCI_MSI_CTL_MME_MASK	0x0070
+#define PCI_MSI_CTL_64BIT	0x0080
+
+/* MSI-X capability */
+#define PCI_MSIX_CTL		0x02
+#define PCI_MSIX_TABLE		0x04
+
+#define PCI_MSIX_CTL_SIZE(ctl)		(((ctl) & 0x7ff) + 1)
+#define PCI_MSIX_CTL_MASKALL		0x4000
+#define PCI_MSIX_CTL_ENABLE		0x8000
+#define PCI_MSIX_TABLE_BIR(tbl)		((tbl) & 0x7)
+#define PCI_MSIX_TABLE_OFFSET(tbl)	((tbl) & ~0x7)
+
+/* MSI-X table entry */
+#define PCI_MSIX_ENTRY_SIZE	16
+#define PCI_MSIX_ENTRY_ADDR_LO	0x00
+#define PCI_MSIX_ENTRY_ADDR_HI	0x04
+#define PCI_MSIX_ENTRY_DATA	0x08
+#define PCI_MSIX_ENTRY_CTL	0x0C
+
+#define PCI_MSIX_ENTRY_CTL_MASK	0x1
+
 #endif
 
 /**
@@ -135,6 +135,17 @@ static errno_t xhci_endpoint_init(xhci_endpoint_t *xhci_ep, device_t *dev,
 	/* But actualy can do full scatter-gather. */
 	ep->required_transfer_buffer_policy = dma_policy_create(flags, PAGE_SIZE);
 
+	/* TRBs can start anywhere in the buffer */
+	ep->transfer_buffer_offset = true;
+
+	/*
+	 * Transfers on bulk and interrupt rings complete in order, so several
+	 * of them can be queued back to back.
+	 */
+	if (ep->transfer_type == USB_TRANSFER_BULK ||
+	    ep->transfer_type == USB_TRANSFER_INTERRUPT)
+		ep->max_active = XHCI_EP_MAX_ACTIVE;
+
 	return EOK;
 
 err:
@@ -227,7 +238,7 @@ static void endpoint_abort(endpoint_t *ep)
 		return;
 	}
 
-	/* First, offer the batch a short chance to be finished. */
+	/* First, offer the batches a short chance to be finished. */
 	endpoint_wait_timeout_locked(ep, 10000);
 
 	if (!ep->active_batch) {
@@ -235,8 +246,6 @@ static void endpoint_abort(endpoint_t *ep)
 		return;
 	}
 
-	usb_transfer_batch_t *const batch = ep->active_batch;
-
 	const errno_t err = hc_stop_endpoint(xhci_ep);
 	if (err) {
 		usb_log_error("Failed to stop endpoint %u of device "
@@ -244,12 +253,24 @@ static void endpoint_abort(endpoint_t *ep)
 		    str_error(err));
 	}
 
+	list_t aborted;
+	list_initialize(&aborted);
+	while (ep->active_batch) {
+		usb_transfer_batch_t *const batch = ep->active_batch;
+		endpoint_deactivate_batch_locked(ep, batch);
+		list_append(&batch->link, &aborted);
+	}
+
 	fibril_mutex_unlock(&xhci_ep->guard);
 
-	batch->error = EINTR;
-	batch->transferred_size = 0;
-	usb_transfer_batch_finish(batch);
-	return;
+	list_foreach_safe(aborted, cur, next) {
+		usb_transfer_batch_t *const batch =
+		    list_get_instance(cur, usb_transfer_batch_t, link);
+		list_remove(cur);
+		batch->error = EINTR;
+		batch->transferred_size = 0;
+		usb_transfer_batch_finish(batch);
+	}
 }
 
 /**
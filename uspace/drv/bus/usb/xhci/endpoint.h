@@ -116,6 +116,9 @@ typedef struct xhci_endpoint {
 	xhci_isoch_t isoch [0];
 } xhci_endpoint_t;
 
+/** Number of transfers queued on a bulk or interrupt ring at once */
+#define XHCI_EP_MAX_ACTIVE  8
+
 #define XHCI_EP_FMT  "(%d:%d %s)"
 /* FIXME: "Device -1" messes up log messages, figure out a better way. */
 #define XHCI_EP_ARGS(ep)		\
@@ -46,6 +46,9 @@
 #include "transfers.h"
 #include "trb_ring.h"
 
+/** Number of events handled before the xHC is told about the progress */
+#define XHCI_EVENT_BATCH 16
+
 /**
  * Default USB Speed ID mapping: Table 157
  */
@@ -661,6 +664,7 @@ static void hc_run_event_ring(xhci_hc_t *hc, xhci_event_ring_t *event_ring,
 	errno_t err;
 
 	xhci_trb_t trb;
+	unsigned handled = 0;
 	hc->event_handler = fibril_get_id();
 
 	while ((err = xhci_event_ring_dequeue(event_ring, &trb)) != ENOENT) {
@@ -668,7 +672,9 @@ static void hc_run_event_ring(xhci_hc_t *hc, xhci_event_ring_t *event_ring,
 			usb_log_error("Failed to handle event in interrupt: %s", str_error(err));
 		}
 
-		XHCI_REG_WR(intr, XHCI_INTR_ERDP, hc->event_ring.dequeue_ptr);
+		/* Release consumed events to the xHC in batches */
+		if (++handled % XHCI_EVENT_BATCH == 0)
+			XHCI_REG_WR(intr, XHCI_INTR_ERDP, hc->event_ring.dequeue_ptr);
 	}
 
 	hc->event_handler = 0;
@@ -317,7 +317,7 @@ static errno_t verify_stream_conditions(xhci_hc_t *hc, xhci_device_t *dev,
 	 * The maximum amount of primary streams is 2 ^ (MaxPSA + 1)
 	 * See table 26 of XHCI specification.
 	 */
-	uint8_t max_psa_size = 1 << (XHCI_REG_RD(hc->cap_regs, XHCI_CAP_MAX_PSA_SIZE) + 1);
+	unsigned max_psa_size = 1 << (XHCI_REG_RD(hc->cap_regs, XHCI_CAP_MAX_PSA_SIZE) + 1);
 	if (count > max_psa_size) {
 		usb_log_error("Host controller only supports "
 		    "%u primary streams.", max_psa_size);
@@ -410,6 +410,52 @@ errno_t xhci_endpoint_request_primary_streams(xhci_hc_t *hc, xhci_device_t *dev,
 	return hc_update_endpoint(xhci_ep);
 }
 
+/**
+ * Switch a bulk endpoint to primary streams.
+ *
+ * Bus callback. The request is rounded up to a power of two and capped by
+ * what both the endpoint and the controller support. Stream ID 0 is reserved,
+ * the caller may use stream IDs 1 to @a granted.
+ *
+ * @param[in] ep_base Bulk endpoint with no transfers in flight.
+ * @param[in] count Number of streams the caller wants to use.
+ * @param[out] granted Number of usable streams.
+ */
+errno_t xhci_endpoint_request_streams(endpoint_t *ep_base, unsigned count,
+    unsigned *granted)
+{
+	xhci_endpoint_t *xhci_ep = xhci_endpoint_get(ep_base);
+	xhci_device_t *dev = xhci_ep_to_dev(xhci_ep);
+	xhci_hc_t *hc = bus_to_hc(endpoint_get_bus(ep_base));
+
+	const unsigned max_psa_size =
+	    1 << (XHCI_REG_RD(hc->cap_regs, XHCI_CAP_MAX_PSA_SIZE) + 1);
+	const unsigned limit = min(max_psa_size, xhci_ep->max_streams);
+
+	unsigned pstreams = 2;
+	while (pstreams < count + 1 && pstreams < limit)
+		pstreams <<= 1;
+
+	fibril_mutex_lock(&xhci_ep->guard);
+	const bool busy = ep_base->active_count > 0;
+	fibril_mutex_unlock(&xhci_ep->guard);
+	if (busy)
+		return EBUSY;
+
+	const errno_t err = xhci_endpoint_request_primary_streams(hc, dev,
+	    xhci_ep, pstreams);
+	if (err)
+		return err;
+
+	/* Every stream has its own ring, let each of them have a transfer. */
+	fibril_mutex_lock(&xhci_ep->guard);
+	ep_base->max_active = max(ep_base->max_active, pstreams - 1);
+	fibril_mutex_unlock(&xhci_ep->guard);
+
+	*granted = pstreams - 1;
+	return EOK;
+}
+
 /**
  * Initialize, setup and register secondary streams.
  * @param[in] hc Host controller of the endpoint.
@@ -70,6 +70,8 @@ extern errno_t xhci_endpoint_remove_streams(xhci_hc_t *, xhci_device_t *,
     xhci_endpoint_t *);
 extern errno_t xhci_endpoint_request_primary_streams(xhci_hc_t *,
     xhci_device_t *, xhci_endpoint_t *, unsigned);
+extern errno_t xhci_endpoint_request_streams(endpoint_t *, unsigned,
+    unsigned *);
 extern errno_t xhci_endpoint_request_secondary_streams(xhci_hc_t *,
     xhci_device_t *, xhci_endpoint_t *, unsigned *, unsigned);
 
@@ -290,6 +290,35 @@ static int schedule_isochronous(xhci_transfer_t *transfer)
 	    isoch_schedule_in(transfer);
 }
 
+/**
+ * Finish all transfers active on an endpoint with an error.
+ *
+ * @param ep    Endpoint
+ * @param error Error to finish the transfers with
+ */
+static void cancel_active(xhci_endpoint_t *ep, errno_t error)
+{
+	list_t cancelled;
+	list_initialize(&cancelled);
+
+	fibril_mutex_lock(&ep->guard);
+	while (ep->base.active_batch) {
+		usb_transfer_batch_t *const batch = ep->base.active_batch;
+		endpoint_deactivate_batch_locked(&ep->base, batch);
+		list_append(&batch->link, &cancelled);
+	}
+	fibril_mutex_unlock(&ep->guard);
+
+	list_foreach_safe(cancelled, cur, next) {
+		usb_transfer_batch_t *const batch =
+		    list_get_instance(cur, usb_transfer_batch_t, link);
+		list_remove(cur);
+		batch->error = error;
+		batch->transferred_size = 0;
+		usb_transfer_batch_finish(batch);
+	}
+}
+
 errno_t xhci_handle_transfer_event(xhci_hc_t *hc, xhci_trb_t *trb)
 {
 	uintptr_t addr = trb->parameter;
@@ -325,6 +354,11 @@ errno_t xhci_handle_transfer_event(xhci_hc_t *hc, xhci_trb_t *trb)
 		xhci_trb_ring_update_dequeue(get_ring(transfer),
 		    transfer->interrupt_trb_phys);
 		batch = &transfer->batch;
+
+		/* Streams complete out of order, retire this very batch. */
+		fibril_mutex_lock(&ep->guard);
+		endpoint_deactivate_batch_locked(&ep->base, batch);
+		fibril_mutex_unlock(&ep->guard);
 	} else {
 		xhci_trb_ring_update_dequeue(&ep->ring, addr);
 
@@ -350,6 +384,7 @@ errno_t xhci_handle_transfer_event(xhci_hc_t *hc, xhci_trb_t *trb)
 	}
 
 	const xhci_trb_completion_code_t completion_code = TRB_COMPLETION_CODE(*trb);
+	bool halted = false;
 	switch (completion_code) {
 	case XHCI_TRBC_SHORT_PACKET:
 	case XHCI_TRBC_SUCCESS:
@@ -367,30 +402,35 @@ errno_t xhci_handle_transfer_event(xhci_hc_t *hc, xhci_trb_t *trb)
 		usb_log_warning("Babble detected during the transfer.");
 		batch->error = EAGAIN;
 		batch->transferred_size = 0;
+		halted = true;
 		break;
 
 	case XHCI_TRBC_USB_TRANSACTION_ERROR:
 		usb_log_warning("USB Transaction error.");
 		batch->error = EAGAIN;
 		batch->transferred_size = 0;
+		halted = true;
 		break;
 
 	case XHCI_TRBC_TRB_ERROR:
 		usb_log_error("Invalid transfer parameters.");
 		batch->error = EINVAL;
 		batch->transferred_size = 0;
+		halted = true;
 		break;
 
 	case XHCI_TRBC_STALL_ERROR:
 		usb_log_warning("Stall condition detected.");
 		batch->error = ESTALL;
 		batch->transferred_size = 0;
+		halted = true;
 		break;
 
 	case XHCI_TRBC_SPLIT_TRANSACTION_ERROR:
 		usb_log_error("Split transcation error detected.");
 		batch->error = EAGAIN;
 		batch->transferred_size = 0;
+		halted = true;
 		break;
 
 	default:
@@ -401,6 +441,14 @@ errno_t xhci_handle_transfer_event(xhci_hc_t *hc, xhci_trb_t *trb)
 	assert(batch->transferred_size <= batch->size);
 
 	usb_transfer_batch_finish(batch);
+
+	/*
+	 * The ring stops on a halted endpoint and is reset when the halt is
+	 * cleared, the transfers queued behind this one will never complete.
+	 */
+	if (halted)
+		cancel_active(ep, EINTR);
+
 	/* Dropping temporary reference */
 	endpoint_del_ref(&ep->base);
 	return EOK;
@@ -435,7 +483,7 @@ errno_t xhci_transfer_schedule(usb_transfer_batch_t *batch)
 	}
 
 	// FIXME: find a better way to check if the ring is not initialized
-	if (!xhci_ep->ring.segment_count) {
+	if (!xhci_ep->ring.segment_count && !xhci_ep->primary_stream_data_size) {
 		usb_log_error("Ring not initialized for endpoint " XHCI_EP_FMT,
 		    XHCI_EP_ARGS(*xhci_ep));
 		return EINVAL;
@@ -500,7 +548,7 @@ errno_t xhci_transfer_schedule(usb_transfer_batch_t *batch)
 	}
 
 	if ((err = transfer_handlers[batch->ep->transfer_type](hc, transfer))) {
-		endpoint_deactivate_locked(ep);
+		endpoint_deactivate_batch_locked(ep, batch);
 		fibril_mutex_unlock(&xhci_ep->guard);
 		return err;
 	}
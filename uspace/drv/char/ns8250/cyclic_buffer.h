@@ -61,6 +61,31 @@ static inline bool buf_is_empty(cyclic_buffer_t *buf)
 	return buf->cnt == 0;
 }
 
+static inline bool buf_is_full(cyclic_buffer_t *buf)
+{
+	return buf->cnt >= BUF_LEN;
+}
+
+/*
+ * @return		Number of items actually stored.
+ */
+static inline size_t buf_push_many(cyclic_buffer_t *buf, const uint8_t *src,
+    size_t count)
+{
+	size_t done = 0;
+
+	while (done < count && !buf_is_full(buf)) {
+		int pos = (buf->start + buf->cnt) % BUF_LEN;
+		size_t n = min(count - done, (size_t) (BUF_LEN - buf->cnt));
+		n = min(n, (size_t) (BUF_LEN - pos));
+		memcpy(&buf->buf[pos], src + done, n);
+		buf->cnt += n;
+		done += n;
+	}
+
+	return done;
+}
+
 static inline uint8_t buf_pop_front(cyclic_buffer_t *buf)
 {
 	assert(!buf_is_empty(buf));
@@ -71,6 +96,26 @@ static inline uint8_t buf_pop_front(cyclic_buffer_t *buf)
 	return res;
 }
 
+/*
+ * @return		Number of items actually removed.
+ */
+static inline size_t buf_pop_many(cyclic_buffer_t *buf, uint8_t *dst,
+    size_t count)
+{
+	size_t done = 0;
+
+	while (done < count && !buf_is_empty(buf)) {
+		size_t n = min(count - done, (size_t) buf->cnt);
+		n = min(n, (size_t) (BUF_LEN - buf->start));
+		memcpy(dst + done, &buf->buf[buf->start], n);
+		buf->start = (buf->start + n) % BUF_LEN;
+		buf->cnt -= n;
+		done += n;
+	}
+
+	return done;
+}
+
 static inline void buf_clear(cyclic_buffer_t *buf)
 {
 	buf->cnt = 0;
@@ -45,6 +45,7 @@
 #include <str.h>
 #include <ctype.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <dirent.h>
 #include <ddi.h>
@@ -64,6 +65,8 @@
 #define REG_COUNT 7
 #define MAX_BAUD_RATE 115200
 #define DLAB_MASK (1 << 7)
+/** How long a writer waits for the transmitter interrupt (microseconds) */
+#define NS8250_TX_TIMEOUT 100000
 
 /** Interrupt Enable Register definition. */
 #define	NS8250_IER_RXREADY	(1 << 0)
@@ -75,12 +78,16 @@
 #define	NS8250_IID_ACTIVE	(1 << 0)
 #define NS8250_IID_CAUSE_MASK 0x0e
 #define NS8250_IID_CAUSE_RXSTATUS 0x06
+#define	NS8250_IID_FIFO64	(1 << 5)
+#define	NS8250_IID_FIFO_MASK	0xc0
+#define	NS8250_IID_FIFO_ENABLED	0xc0
 
 /** FIFO Control Register definition. */
 #define	NS8250_FCR_FIFOENABLE	(1 << 0)
 #define	NS8250_FCR_RXFIFORESET	(1 << 1)
 #define	NS8250_FCR_TXFIFORESET	(1 << 2)
 #define	NS8250_FCR_DMAMODE	(1 << 3)
+#define	NS8250_FCR_FIFO64	(1 << 5)
 #define	NS8250_FCR_RXTRIGGERLOW	(1 << 6)
 #define	NS8250_FCR_RXTRIGGERHI	(1 << 7)
 
@@ -168,12 +175,22 @@ typedef struct ns8250 {
 	uintptr_t io_addr;
 	/** The i/o port used to access the serial ports registers. */
 	ioport8_t *port;
+	/** Clock divided by 16, i.e. the baud rate with divisor 1 */
+	unsigned int base_baud;
+	/** Size of the transmit FIFO (1 if there is none) */
+	size_t fifo_size;
+	/** Cached value of the Interrupt Enable Register */
+	uint8_t ier;
 	/** The buffer for incoming data. */
 	cyclic_buffer_t input_buffer;
+	/** The buffer for outgoing data. */
+	cyclic_buffer_t output_buffer;
 	/** The fibril mutex for synchronizing the access to the device. */
 	fibril_mutex_t mutex;
 	/** Indicates that some data has become available */
 	fibril_condvar_t input_buffer_available;
+	/** Indicates that some space in the output buffer has become free */
+	fibril_condvar_t output_buffer_available;
 	/** True if device is removed. */
 	bool removed;
 } ns8250_t;
@@ -196,17 +213,6 @@ static ns8250_t *srv_ns8250(chardev_srv_t *srv)
 	return (ns8250_t *)srv->srvs->sarg;
 }
 
-/** Find out if there is some incoming data available on the serial port.
- *
- * @param port		The base address of the serial port device's ports.
- * @return		True if there are data waiting to be read, false
- *			otherwise.
- */
-static bool ns8250_received(ns8250_regs_t *regs)
-{
-	return (pio_read_8(&regs->lsr) & NS8250_LSR_RXREADY) != 0;
-}
-
 /** Read one byte from the serial port.
  *
  * @param port		The base address of the serial port device's ports.
@@ -226,17 +232,50 @@ static bool is_transmit_empty(ns8250_regs_t *regs)
 	return (pio_read_8(&regs->lsr) & NS8250_LSR_THRE) != 0;
 }
 
-/** Write one character on the serial port.
+/** Update the Interrupt Enable Register.
  *
- * @param port		The base address of the serial port device's ports.
- * @param c		The character to be written to the serial port device.
+ * The transmitter interrupt is only enabled while there is data waiting
+ * in the output buffer. Must be called with the device mutex held.
+ *
+ * @param ns		Serial port device
  */
-static void ns8250_write_8(ns8250_regs_t *regs, uint8_t c)
+static void ns8250_ier_update(ns8250_t *ns)
 {
-	while (!is_transmit_empty(regs))
-		;
+	uint8_t ier = NS8250_IER_RXREADY | NS8250_IER_RXSTATUS;
 
-	pio_write_8(&regs->data, c);
+	if (!buf_is_empty(&ns->output_buffer))
+		ier |= NS8250_IER_THRE;
+
+	if (ier != ns->ier) {
+		pio_write_8(&ns->regs->ier, ier);
+		ns->ier = ier;
+	}
+}
+
+/** Refill the transmit FIFO from the output buffer.
+ *
+ * Once the transmitter is empty, the whole FIFO can be filled without
+ * looking at the line status in between. Must be called with the device
+ * mutex held.
+ *
+ * @param ns		Serial port device
+ */
+static void ns8250_tx_fill(ns8250_t *ns)
+{
+	size_t n = 0;
+
+	if (!buf_is_empty(&ns->output_buffer) && is_transmit_empty(ns->regs)) {
+		while (n < ns->fifo_size && !buf_is_empty(&ns->output_buffer)) {
+			pio_write_8(&ns->regs->data,
+			    buf_pop_front(&ns->output_buffer));
+			n++;
+		}
+	}
+
+	if (n > 0)
+		fibril_condvar_broadcast(&ns->output_buffer_available);
+
+	ns8250_ier_update(ns);
 }
 
 /** Read data from the serial port device.
@@ -254,8 +293,7 @@ static errno_t ns8250_read(chardev_srv_t *srv, void *buf, size_t count, size_t *
     chardev_flags_t flags)
 {
 	ns8250_t *ns = srv_ns8250(srv);
-	char *bp = (char *) buf;
-	size_t pos = 0;
+	size_t pos;
 
 	if (count == 0) {
 		*nread = 0;
@@ -263,31 +301,16 @@ static errno_t ns8250_read(chardev_srv_t *srv, void *buf, size_t count, size_t *
 	}
 
 	fibril_mutex_lock(&ns->mutex);
-	while ((flags & chardev_f_none) == 0 &&
+	while ((flags & chardev_f_nonblock) == 0 &&
 	    buf_is_empty(&ns->input_buffer))
 		fibril_condvar_wait(&ns->input_buffer_available, &ns->mutex);
-	while (!buf_is_empty(&ns->input_buffer) && pos < count) {
-		bp[pos] = (char)buf_pop_front(&ns->input_buffer);
-		pos++;
-	}
+	pos = buf_pop_many(&ns->input_buffer, buf, count);
 	fibril_mutex_unlock(&ns->mutex);
 
 	*nread = pos;
 	return EOK;
 }
 
-/** Write a character to the serial port.
- *
- * @param ns		Serial port device
- * @param c		The character to be written
- */
-static inline void ns8250_putchar(ns8250_t *ns, uint8_t c)
-{
-	fibril_mutex_lock(&ns->mutex);
-	ns8250_write_8(ns->regs, c);
-	fibril_mutex_unlock(&ns->mutex);
-}
-
 /** Write data to the serial port.
  *
  * @param srv		Server-side connection data
@@ -300,11 +323,25 @@ static errno_t ns8250_write(chardev_srv_t *srv, const void *buf, size_t count,
     size_t *nwritten)
 {
 	ns8250_t *ns = srv_ns8250(srv);
-	size_t idx;
-	uint8_t *bp = (uint8_t *) buf;
+	const uint8_t *bp = (const uint8_t *) buf;
+	size_t pos = 0;
+	errno_t rc;
 
-	for (idx = 0; idx < count; idx++)
-		ns8250_putchar(ns, bp[idx]);
+	fibril_mutex_lock(&ns->mutex);
+	while (pos < count) {
+		pos += buf_push_many(&ns->output_buffer, bp + pos, count - pos);
+		ns8250_tx_fill(ns);
+
+		if (pos < count && buf_is_full(&ns->output_buffer)) {
+			rc = fibril_condvar_wait_timeout(
+			    &ns->output_buffer_available, &ns->mutex,
+			    NS8250_TX_TIMEOUT);
+			/* Do not rely solely on the transmitter interrupt */
+			if (rc == ETIMEOUT)
+				ns8250_tx_fill(ns);
+		}
+	}
+	fibril_mutex_unlock(&ns->mutex);
 
 	*nwritten = count;
 	return EOK;
@@ -476,25 +513,26 @@ failed:
 
 /** Enable interrupts on the serial port device.
  *
- * Interrupt when data is received
+ * Interrupt when data is received and, while there is data to send,
+ * when the transmitter becomes empty.
  *
- * @param port		The base address of the serial port device's ports.
+ * @param ns		Serial port device
  */
-static inline void ns8250_port_interrupts_enable(ns8250_regs_t *regs)
+static inline void ns8250_port_interrupts_enable(ns8250_t *ns)
 {
-	/* Interrupt when data received. */
-	pio_write_8(&regs->ier, NS8250_IER_RXREADY | NS8250_IER_RXSTATUS);
-	pio_write_8(&regs->mcr, NS8250_MCR_DTR | NS8250_MCR_RTS |
+	ns8250_ier_update(ns);
+	pio_write_8(&ns->regs->mcr, NS8250_MCR_DTR | NS8250_MCR_RTS |
 	    NS8250_MCR_OUT2);
 }
 
 /** Disable interrupts on the serial port device.
  *
- * @param port		The base address of the serial port device's ports
+ * @param ns		Serial port device
  */
-static inline void ns8250_port_interrupts_disable(ns8250_regs_t *regs)
+static inline void ns8250_port_interrupts_disable(ns8250_t *ns)
 {
-	pio_write_8(&regs->ier, 0x0);	/* Disable all interrupts. */
+	pio_write_8(&ns->regs->ier, 0x0);	/* Disable all interrupts. */
+	ns->ier = 0;
 }
 
 /** Enable interrupts for the serial port device.
@@ -513,7 +551,9 @@ static errno_t ns8250_interrupt_enable(ns8250_t *ns)
 	pio_read_8(&ns->regs->lsr);
 
 	/* Enable interrupt on the serial port. */
-	ns8250_port_interrupts_enable(ns->regs);
+	fibril_mutex_lock(&ns->mutex);
+	ns8250_port_interrupts_enable(ns);
+	fibril_mutex_unlock(&ns->mutex);
 
 	return EOK;
 }
@@ -544,22 +584,25 @@ static inline void clear_dlab(ns8250_regs_t *regs)
 /** Set baud rate of the serial communication on the serial device.
  *
  * @param port		The base address of the serial port device's ports.
+ * @param base_baud	Baud rate corresponding to divisor 1.
  * @param baud_rate	The baud rate to be used by the device.
  * @return		Zero on success, error number otherwise (EINVAL
  *			if the specified baud_rate is not valid).
  */
-static errno_t ns8250_port_set_baud_rate(ns8250_regs_t *regs, unsigned int baud_rate)
+static errno_t ns8250_port_set_baud_rate(ns8250_regs_t *regs,
+    unsigned int base_baud, unsigned int baud_rate)
 {
 	uint16_t divisor;
 	uint8_t div_low, div_high;
 
-	if (baud_rate < 50 || MAX_BAUD_RATE % baud_rate != 0) {
+	if (baud_rate < 50 || baud_rate > base_baud ||
+	    base_baud % baud_rate != 0 || base_baud / baud_rate > UINT16_MAX) {
 		ddf_msg(LVL_ERROR, "Invalid baud rate %d requested.",
 		    baud_rate);
 		return EINVAL;
 	}
 
-	divisor = MAX_BAUD_RATE / baud_rate;
+	divisor = base_baud / baud_rate;
 	div_low = (uint8_t)divisor;
 	div_high = (uint8_t)(divisor >> 8);
 
@@ -579,9 +622,11 @@ static errno_t ns8250_port_set_baud_rate(ns8250_regs_t *regs, unsigned int baud_
 /** Get baud rate used by the serial port device.
  *
  * @param port		The base address of the serial port device's ports.
- * @param baud_rate	The ouput parameter to which the baud rate is stored.
+ * @param base_baud	Baud rate corresponding to divisor 1.
+ * @return		The baud rate.
  */
-static unsigned int ns8250_port_get_baud_rate(ns8250_regs_t *regs)
+static unsigned int ns8250_port_get_baud_rate(ns8250_regs_t *regs,
+    unsigned int base_baud)
 {
 	uint16_t divisor;
 	uint8_t div_low, div_high;
@@ -597,7 +642,10 @@ static unsigned int ns8250_port_get_baud_rate(ns8250_regs_t *regs)
 	clear_dlab(regs);
 
 	divisor = (div_high << 8) | div_low;
-	return MAX_BAUD_RATE / divisor;
+	if (divisor == 0)
+		return 0;
+
+	return base_baud / divisor;
 }
 
 /** Get the parameters of the serial communication set on the serial port
@@ -697,6 +745,33 @@ static errno_t ns8250_port_set_com_props(ns8250_regs_t *regs, unsigned int parit
 	return EOK;
 }
 
+/** Find out the FIFO size of the serial port device.
+ *
+ * Tries to enable the (64-byte) FIFO and checks the Interrupt ID Register
+ * to see whether it took effect. The 8250 and 16450 have no FIFO at all
+ * and the FIFO of the original 16550 is unusable.
+ *
+ * @param regs		The serial port device's registers.
+ * @return		Size of the transmit FIFO (1 if there is none).
+ */
+static size_t ns8250_fifo_probe(ns8250_regs_t *regs)
+{
+	uint8_t iir;
+
+	enable_dlab(regs);
+	pio_write_8(&regs->iid, NS8250_FCR_FIFOENABLE | NS8250_FCR_FIFO64);
+	clear_dlab(regs);
+
+	iir = pio_read_8(&regs->iid);
+	if ((iir & NS8250_IID_FIFO_MASK) != NS8250_IID_FIFO_ENABLED)
+		return 1;
+
+	if ((iir & NS8250_IID_FIFO64) != 0)
+		return 64;
+
+	return 16;
+}
+
 /** Initialize the serial port device.
  *
  * Set the default parameters of the serial communication.
@@ -705,19 +780,32 @@ static errno_t ns8250_port_set_com_props(ns8250_regs_t *regs, unsigned int parit
  */
 static void ns8250_initialize_port(ns8250_t *ns)
 {
+	uint8_t fcr;
+
 	/* Disable interrupts. */
-	ns8250_port_interrupts_disable(ns->regs);
+	ns8250_port_interrupts_disable(ns);
 	/* Set baud rate. */
-	ns8250_port_set_baud_rate(ns->regs, 38400);
+	ns8250_port_set_baud_rate(ns->regs, ns->base_baud, 38400);
 	/* 8 bits, no parity, two stop bits. */
 	ns8250_port_set_com_props(ns->regs, SERIAL_NO_PARITY, 8, 2);
+	/* Find out how deep the FIFOs are. */
+	ns->fifo_size = ns8250_fifo_probe(ns->regs);
 	/*
-	 * Enable FIFO, clear them, with 4-byte threshold for greater
-	 * reliability.
+	 * Enable FIFO and clear it. The receiver interrupts at half of the
+	 * FIFO (8 of 16 bytes on a 16550A, 32 of 64 bytes on a 16750) so
+	 * that each interrupt drains a whole burst while still leaving room
+	 * for interrupt latency at high baud rates.
 	 */
-	pio_write_8(&ns->regs->iid, NS8250_FCR_FIFOENABLE |
-	    NS8250_FCR_RXFIFORESET | NS8250_FCR_TXFIFORESET |
-	    NS8250_FCR_RXTRIGGERLOW);
+	fcr = NS8250_FCR_FIFOENABLE | NS8250_FCR_RXFIFORESET |
+	    NS8250_FCR_TXFIFORESET | NS8250_FCR_RXTRIGGERHI;
+	if (ns->fifo_size > 16) {
+		/* The 64-byte FIFO bit can only be changed with DLAB set. */
+		enable_dlab(ns->regs);
+		pio_write_8(&ns->regs->iid, fcr | NS8250_FCR_FIFO64);
+		clear_dlab(ns->regs);
+	} else {
+		pio_write_8(&ns->regs->iid, fcr);
+	}
 	/*
 	 * RTS/DSR set (Request to Send and Data Terminal Ready lines enabled),
 	 * Aux Output2 set - needed for interrupts.
@@ -737,50 +825,56 @@ static void ns8250_port_cleanup(ns8250_t *ns)
 	/* Disable DTR, RTS, OUT1, OUT2 (int. enable) */
 	pio_write_8(&ns->regs->mcr, 0x00);
 	/* Disable all interrupts from the port */
-	ns8250_port_interrupts_disable(ns->regs);
+	ns8250_port_interrupts_disable(ns);
 }
 
-/** Read the data from the serial port device and store them to the input
- * buffer.
+/** Drain the receive FIFO into the input buffer.
+ *
+ * Must be called with the device mutex held.
  *
  * @param ns		Serial port device
  */
 static void ns8250_read_from_device(ns8250_t *ns)
 {
 	ns8250_regs_t *regs = ns->regs;
-	bool cont = true;
+	bool buf_was_empty = buf_is_empty(&ns->input_buffer);
+	size_t dropped = 0;
+	uint8_t lsr;
 
-	fibril_mutex_lock(&ns->mutex);
-	while (cont) {
-		cont = ns8250_received(regs);
-		if (cont) {
-			uint8_t val = ns8250_read_8(regs);
-
-			if (ns->client_connections > 0) {
-				bool buf_was_empty = buf_is_empty(&ns->input_buffer);
-				if (!buf_push_back(&ns->input_buffer, val)) {
-					ddf_msg(LVL_WARN, "Buffer overflow on "
-					    "%s.", ddf_dev_get_name(ns->dev));
-					break;
-				} else {
-					ddf_msg(LVL_DEBUG2, "Character %c saved "
-					    "to the buffer of %s.",
-					    val, ddf_dev_get_name(ns->dev));
-					if (buf_was_empty)
-						fibril_condvar_broadcast(&ns->input_buffer_available);
-				}
-			}
+	/*
+	 * Keep reading even when the buffer is full, otherwise the receiver
+	 * would keep the interrupt asserted.
+	 */
+	while (((lsr = pio_read_8(&regs->lsr)) & NS8250_LSR_RXREADY) != 0) {
+		uint8_t val = ns8250_read_8(regs);
+
+		if ((lsr & NS8250_LSR_OE) != 0) {
+			ddf_msg(LVL_WARN, "Overrun error on %s",
+			    ddf_dev_get_name(ns->dev));
 		}
+
+		if (ns->client_connections == 0)
+			continue;
+
+		if (!buf_push_back(&ns->input_buffer, val))
+			dropped++;
 	}
-	fibril_mutex_unlock(&ns->mutex);
-	fibril_yield();
+
+	if (dropped > 0) {
+		ddf_msg(LVL_WARN, "Buffer overflow on %s, %zu bytes dropped.",
+		    ddf_dev_get_name(ns->dev), dropped);
+	}
+
+	if (buf_was_empty && !buf_is_empty(&ns->input_buffer))
+		fibril_condvar_broadcast(&ns->input_buffer_available);
 }
 
 /** The interrupt handler.
  *
- * The serial port is initialized to interrupt when some data come or line
- * status register changes, so the interrupt is handled by reading the incoming
- * data and reading the line status register.
+ * The serial port is initialized to interrupt when some data come, line
+ * status register changes or, while there is data to send, the transmitter
+ * becomes empty. Each interrupt drains the whole receive FIFO and refills
+ * the whole transmit FIFO.
  *
  * @param dev The serial port device.
  *
@@ -788,15 +882,17 @@ static void ns8250_read_from_device(ns8250_t *ns)
 static inline void ns8250_interrupt_handler(ipc_call_t *icall, ddf_dev_t *dev)
 {
 	ns8250_t *ns = dev_ns8250(dev);
-	uint8_t iir = pio_read_8(&ns->regs->iid);
-	if ((iir & NS8250_IID_CAUSE_MASK) == NS8250_IID_CAUSE_RXSTATUS) {
-		uint8_t lsr = pio_read_8(&ns->regs->lsr);
-		if (lsr & NS8250_LSR_OE) {
-			ddf_msg(LVL_WARN, "Overrun error on %s", ddf_dev_get_name(ns->dev));
-		}
-	}
+
+	fibril_mutex_lock(&ns->mutex);
+
+	/* Reading IIR acknowledges a pending transmitter interrupt */
+	(void) pio_read_8(&ns->regs->iid);
 
 	ns8250_read_from_device(ns);
+	ns8250_tx_fill(ns);
+
+	fibril_mutex_unlock(&ns->mutex);
+
 	hw_res_clear_interrupt(ns->parent_sess, ns->irq);
 }
 
@@ -847,7 +943,9 @@ static errno_t ns8250_dev_add(ddf_dev_t *dev)
 
 	fibril_mutex_initialize(&ns->mutex);
 	fibril_condvar_initialize(&ns->input_buffer_available);
+	fibril_condvar_initialize(&ns->output_buffer_available);
 	ns->dev = dev;
+	ns->base_baud = MAX_BAUD_RATE;
 
 	ns->parent_sess = ddf_dev_parent_sess_get(ns->dev);
 	if (ns->parent_sess == NULL) {
@@ -876,6 +974,8 @@ static errno_t ns8250_dev_add(ddf_dev_t *dev)
 
 	/* Serial port initialization (baud rate etc.). */
 	ns8250_initialize_port(ns);
+	ddf_msg(LVL_NOTE, "Device %s has a %zu-byte FIFO.",
+	    ddf_dev_get_name(dev), ns->fifo_size);
 
 	/* Register interrupt handler. */
 	ns->irq_handle = CAP_NIL;
@@ -1029,10 +1129,10 @@ static void ns8250_get_props(ddf_dev_t *dev, unsigned int *baud_rate,
 	ns8250_regs_t *regs = data->regs;
 
 	fibril_mutex_lock(&data->mutex);
-	ns8250_port_interrupts_disable(regs);
-	*baud_rate = ns8250_port_get_baud_rate(regs);
+	ns8250_port_interrupts_disable(data);
+	*baud_rate = ns8250_port_get_baud_rate(regs, data->base_baud);
 	ns8250_port_get_com_props(regs, parity, word_length, stop_bits);
-	ns8250_port_interrupts_enable(regs);
+	ns8250_port_interrupts_enable(data);
 	fibril_mutex_unlock(&data->mutex);
 
 	ddf_msg(LVL_DEBUG, "ns8250_get_props: baud rate %d, parity 0x%x, word "
@@ -1061,11 +1161,11 @@ static errno_t ns8250_set_props(ddf_dev_t *dev, unsigned int baud_rate,
 	errno_t ret;
 
 	fibril_mutex_lock(&data->mutex);
-	ns8250_port_interrupts_disable(regs);
-	ret = ns8250_port_set_baud_rate(regs, baud_rate);
+	ns8250_port_interrupts_disable(data);
+	ret = ns8250_port_set_baud_rate(regs, data->base_baud, baud_rate);
 	if (ret == EOK)
 		ret = ns8250_port_set_com_props(regs, parity, word_length, stop_bits);
-	ns8250_port_interrupts_enable(regs);
+	ns8250_port_interrupts_enable(data);
 	fibril_mutex_unlock(&data->mutex);
 
 	return ret;
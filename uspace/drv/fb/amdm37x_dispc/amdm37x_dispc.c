@@ -45,6 +45,8 @@
 #include <ddi.h>
 #include <gfx/color.h>
 #include <io/pixelmap.h>
+#include <macros.h>
+#include <mem.h>
 
 #include "amdm37x_dispc.h"
 
@@ -60,11 +62,17 @@
 #define CONFIG_BFB_HEIGHT 768
 #endif
 
+/** Size of hardware cursor image buffer (in both dimensions) */
+#define CURSOR_MAX 64
+
 static errno_t amdm37x_change_mode(amdm37x_dispc_t *, unsigned, unsigned,
     visual_t);
 
 static errno_t amdm37x_ddev_get_gc(void *, sysarg_t *, sysarg_t *);
 static errno_t amdm37x_ddev_get_info(void *, ddev_info_t *);
+static errno_t amdm37x_ddev_cursor_set_image(void *, gfx_rect_t *, pixel_t *);
+static errno_t amdm37x_ddev_cursor_move(void *, gfx_coord2_t *);
+static errno_t amdm37x_ddev_cursor_set_visible(void *, bool);
 
 static errno_t amdm37x_gc_set_clip_rect(void *, gfx_rect_t *);
 static errno_t amdm37x_gc_set_color(void *, gfx_color_t *);
@@ -77,7 +85,10 @@ static errno_t amdm37x_gc_bitmap_get_alloc(void *, gfx_bitmap_alloc_t *);
 
 ddev_ops_t amdm37x_ddev_ops = {
 	.get_gc = amdm37x_ddev_get_gc,
-	.get_info = amdm37x_ddev_get_info
+	.get_info = amdm37x_ddev_get_info,
+	.cursor_set_image = amdm37x_ddev_cursor_set_image,
+	.cursor_move = amdm37x_ddev_cursor_move,
+	.cursor_set_visible = amdm37x_ddev_cursor_set_visible
 };
 
 gfx_context_ops_t amdm37x_gc_ops = {
@@ -93,22 +104,38 @@ gfx_context_ops_t amdm37x_gc_ops = {
 static const struct {
 	unsigned bpp;
 	pixel2visual_t func;
+	pixel2visual_row_t row;
 } pixel2visual_table[] = {
-	[VISUAL_INDIRECT_8] = { .bpp = 1, .func = pixel2bgr_323 },
-	[VISUAL_RGB_5_5_5_LE] = { .bpp = 2, .func = pixel2rgb_555_le },
-	[VISUAL_RGB_5_5_5_BE] = { .bpp = 2, .func = pixel2rgb_555_be },
-	[VISUAL_RGB_5_6_5_LE] = { .bpp = 2, .func = pixel2rgb_565_le },
-	[VISUAL_RGB_5_6_5_BE] = { .bpp = 2, .func = pixel2rgb_565_be },
-	[VISUAL_BGR_8_8_8] = { .bpp = 3, .func = pixel2bgr_888 },
-	[VISUAL_RGB_8_8_8] = { .bpp = 3, .func = pixel2rgb_888 },
-	[VISUAL_BGR_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888 },
-	[VISUAL_BGR_8_8_8_0] = { .bpp = 4, .func = pixel2bgr_8880 },
-	[VISUAL_ABGR_8_8_8_8] = { .bpp = 4, .func = pixel2abgr_8888 },
-	[VISUAL_BGRA_8_8_8_8] = { .bpp = 4, .func = pixel2bgra_8888 },
-	[VISUAL_RGB_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888 },
-	[VISUAL_RGB_8_8_8_0] = { .bpp = 4, .func = pixel2rgb_8880 },
-	[VISUAL_ARGB_8_8_8_8] = { .bpp = 4, .func = pixel2argb_8888 },
-	[VISUAL_RGBA_8_8_8_8] = { .bpp = 4, .func = pixel2rgba_8888 },
+	[VISUAL_INDIRECT_8] = { .bpp = 1, .func = pixel2bgr_323,
+	    .row = pixel2bgr_323_row },
+	[VISUAL_RGB_5_5_5_LE] = { .bpp = 2, .func = pixel2rgb_555_le,
+	    .row = pixel2rgb_555_le_row },
+	[VISUAL_RGB_5_5_5_BE] = { .bpp = 2, .func = pixel2rgb_555_be,
+	    .row = pixel2rgb_555_be_row },
+	[VISUAL_RGB_5_6_5_LE] = { .bpp = 2, .func = pixel2rgb_565_le,
+	    .row = pixel2rgb_565_le_row },
+	[VISUAL_RGB_5_6_5_BE] = { .bpp = 2, .func = pixel2rgb_565_be,
+	    .row = pixel2rgb_565_be_row },
+	[VISUAL_BGR_8_8_8] = { .bpp = 3, .func = pixel2bgr_888,
+	    .row = pixel2bgr_888_row },
+	[VISUAL_RGB_8_8_8] = { .bpp = 3, .func = pixel2rgb_888,
+	    .row = pixel2rgb_888_row },
+	[VISUAL_BGR_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888,
+	    .row = pixel2rgb_0888_row },
+	[VISUAL_BGR_8_8_8_0] = { .bpp = 4, .func = pixel2bgr_8880,
+	    .row = pixel2bgr_8880_row },
+	[VISUAL_ABGR_8_8_8_8] = { .bpp = 4, .func = pixel2abgr_8888,
+	    .row = pixel2abgr_8888_row },
+	[VISUAL_BGRA_8_8_8_8] = { .bpp = 4, .func = pixel2bgra_8888,
+	    .row = pixel2bgra_8888_row },
+	[VISUAL_RGB_0_8_8_8] = { .bpp = 4, .func = pixel2rgb_0888,
+	    .row = pixel2rgb_0888_row },
+	[VISUAL_RGB_8_8_8_0] = { .bpp = 4, .func = pixel2rgb_8880,
+	    .row = pixel2rgb_8880_row },
+	[VISUAL_ARGB_8_8_8_8] = { .bpp = 4, .func = pixel2argb_8888,
+	    .row = pixel2argb_8888_row },
+	[VISUAL_RGBA_8_8_8_8] = { .bpp = 4, .func = pixel2rgba_8888,
+	    .row = pixel2rgba_8888_row },
 };
 
 errno_t amdm37x_dispc_init(amdm37x_dispc_t *instance, ddf_fun_t *fun)
@@ -116,6 +143,8 @@ errno_t amdm37x_dispc_init(amdm37x_dispc_t *instance, ddf_fun_t *fun)
 	instance->fun = fun;
 	instance->fb_data = NULL;
 	instance->size = 0;
+	instance->cursor.data = NULL;
+	instance->cursor.visible = false;
 
 	/* Default is 24bpp, use config option if available */
 	visual_t visual = VISUAL_BGR_8_8_8;
@@ -147,6 +176,17 @@ errno_t amdm37x_dispc_init(amdm37x_dispc_t *instance, ddf_fun_t *fun)
 	if (ret != EOK)
 		return EIO;
 
+	/* Hardware cursor is optional, we can do without it */
+	void *cbuf = AS_AREA_ANY;
+	ret = dmamem_map_anonymous(
+	    ALIGN_UP(CURSOR_MAX * CURSOR_MAX * sizeof(pixel_t), PAGE_SIZE),
+	    DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE, 0,
+	    &instance->cursor.pa, &cbuf);
+	if (ret == EOK)
+		instance->cursor.data = cbuf;
+	else
+		ddf_log_warning("Failed to allocate cursor buffer\n");
+
 	return EOK;
 }
 
@@ -219,10 +259,17 @@ static errno_t amdm37x_dispc_setup_fb(amdm37x_dispc_regs_t *regs,
 	    AMDM37X_DISPC_CONTROL_GPOUT1_FLAG;
 	regs->control = control;
 
-	/* No gamma stuff only data */
+	/*
+	 * No gamma stuff only data. Alpha blending is needed for the
+	 * cursor overlay, the graphics pipeline itself has no alpha.
+	 */
 	uint32_t config = (AMDM37X_DISPC_CONFIG_LOADMODE_DATAEVERYFRAME <<
-	    AMDM37X_DISPC_CONFIG_LOADMODE_SHIFT);
+	    AMDM37X_DISPC_CONFIG_LOADMODE_SHIFT) |
+	    AMDM37X_DISPC_CONFIG_LCDPALPHABLENDERENABLDE_FLAG;
 	regs->config = config;
+	regs->global_alpha =
+	    (0xff << AMDM37X_DISPC_GLOBAL_ALPHA_GFXGLOBALALPHA_SHIFT) |
+	    (0xff << AMDM37X_DISPC_GLOBAL_ALPHA_VID2GLOBALALPHA_SHIFT);
 
 	/* Set framebuffer base address */
 	regs->gfx.ba[0] = pa;
@@ -268,6 +315,7 @@ static errno_t amdm37x_change_mode(amdm37x_dispc_t *dispc, unsigned x,
 	assert((size_t)visual < sizeof(pixel2visual_table) / sizeof(pixel2visual_table[0]));
 	const unsigned bpp = pixel2visual_table[visual].bpp;
 	pixel2visual_t p2v = pixel2visual_table[visual].func;
+	pixel2visual_row_t p2v_row = pixel2visual_table[visual].row;
 	ddf_log_note("Setting mode: %ux%ux%u\n", x, y, bpp * 8);
 	const size_t size = ALIGN_UP(x * y * bpp, PAGE_SIZE);
 	uintptr_t pa;
@@ -288,6 +336,7 @@ static errno_t amdm37x_change_mode(amdm37x_dispc_t *dispc, unsigned x,
 	dispc->active_fb.pitch = 0;
 	dispc->active_fb.bpp = bpp;
 	dispc->active_fb.pixel2visual = p2v;
+	dispc->active_fb.pixel2visual_row = p2v_row;
 	dispc->rect.p0.x = 0;
 	dispc->rect.p0.y = 0;
 	dispc->rect.p1.x = x;
@@ -320,6 +369,142 @@ static errno_t amdm37x_ddev_get_info(void *arg, ddev_info_t *info)
 	info->rect.p0.y = 0;
 	info->rect.p1.x = dispc->active_fb.width;
 	info->rect.p1.y = dispc->active_fb.height;
+
+	if (dispc->cursor.data != NULL) {
+		info->caps |= ddc_cursor;
+		info->cursor_max.x = CURSOR_MAX;
+		info->cursor_max.y = CURSOR_MAX;
+	}
+
+	return EOK;
+}
+
+/** Program video pipeline 2 to show the cursor.
+ *
+ * The pipeline cannot show a window that does not lie entirely on
+ * the screen. The part of the cursor image that is off screen is skipped
+ * by adjusting the base address, window size and row increment.
+ *
+ * @param dispc AMDM37x display controller
+ */
+static void amdm37x_cursor_update(amdm37x_dispc_t *dispc)
+{
+	amdm37x_dispc_regs_t *regs = dispc->regs;
+	gfx_rect_t crect;
+	gfx_rect_t vrect;
+	gfx_coord2_t dims;
+	uint32_t offset;
+	uint32_t size_reg;
+
+	/* Screen rectangle covered by cursor and its visible part */
+	gfx_rect_translate(&dispc->cursor.pos, &dispc->cursor.rect, &crect);
+	gfx_rect_clip(&crect, &dispc->rect, &vrect);
+
+	if (!dispc->cursor.visible || gfx_rect_is_empty(&vrect)) {
+		regs->vid[1].attributes &=
+		    ~AMDM37X_DISPC_VID_ATTRIBUTES_ENABLE_FLAG;
+		regs->control |= AMDM37X_DISPC_CONTROL_GOLCD_FLAG;
+		return;
+	}
+
+	gfx_rect_dims(&vrect, &dims);
+	offset = ((vrect.p0.y - crect.p0.y) * CURSOR_MAX +
+	    (vrect.p0.x - crect.p0.x)) * sizeof(pixel_t);
+
+	size_reg =
+	    (((dims.x - 1) & AMDM37X_DISPC_SIZE_WIDTH_MASK) <<
+	    AMDM37X_DISPC_SIZE_WIDTH_SHIFT) |
+	    (((dims.y - 1) & AMDM37X_DISPC_SIZE_HEIGHT_MASK) <<
+	    AMDM37X_DISPC_SIZE_HEIGHT_SHIFT);
+
+	regs->vid[1].ba[0] = (uint32_t) dispc->cursor.pa + offset;
+	regs->vid[1].ba[1] = (uint32_t) dispc->cursor.pa + offset;
+	regs->vid[1].position =
+	    ((vrect.p0.x & AMDM37X_DISPC_GFX_POSITION_GFXPOSX_MASK) <<
+	    AMDM37X_DISPC_GFX_POSITION_GFXPOSX_SHIFT) |
+	    ((vrect.p0.y & AMDM37X_DISPC_GFX_POSITION_GFXPOSY_MASK) <<
+	    AMDM37X_DISPC_GFX_POSITION_GFXPOSY_SHIFT);
+	/* No scaling, input and output sizes are the same */
+	regs->vid[1].size = size_reg;
+	regs->vid[1].picture_size = size_reg;
+	/* Skip rest of the buffer row (1 means next pixel) */
+	regs->vid[1].row_inc = 1 + (CURSOR_MAX - dims.x) * sizeof(pixel_t);
+	regs->vid[1].pixel_inc = 1;
+	regs->vid[1].attributes = AMDM37X_DISPC_VID_ATTRIBUTES_ENABLE_FLAG |
+	    (AMDM37X_DISPC_VID_ATTRIBUTES_FORMAT_ARGB <<
+	    AMDM37X_DISPC_VID_ATTRIBUTES_FORMAT_SHIFT);
+
+	/* Update register values */
+	regs->control |= AMDM37X_DISPC_CONTROL_GOLCD_FLAG;
+}
+
+/** Set hardware cursor image.
+ *
+ * @param arg AMDM37x display controller
+ * @param rect Rectangle covered by image, relative to hot spot
+ * @param pixels Image pixels in ARGB format
+ * @return EOK on success or an error code
+ */
+static errno_t amdm37x_ddev_cursor_set_image(void *arg, gfx_rect_t *rect,
+    pixel_t *pixels)
+{
+	amdm37x_dispc_t *dispc = (amdm37x_dispc_t *) arg;
+	gfx_coord2_t dims;
+	gfx_coord_t y;
+
+	if (dispc->cursor.data == NULL)
+		return ENOTSUP;
+
+	gfx_rect_dims(rect, &dims);
+	if (dims.x > CURSOR_MAX || dims.y > CURSOR_MAX)
+		return EINVAL;
+
+	/* ARGB32 in memory has the same layout as pixel_t */
+	memset(dispc->cursor.data, 0,
+	    CURSOR_MAX * CURSOR_MAX * sizeof(pixel_t));
+	for (y = 0; y < dims.y; y++) {
+		memcpy(dispc->cursor.data + y * CURSOR_MAX,
+		    pixels + y * dims.x, dims.x * sizeof(pixel_t));
+	}
+
+	dispc->cursor.rect = *rect;
+	amdm37x_cursor_update(dispc);
+	return EOK;
+}
+
+/** Move hardware cursor.
+ *
+ * @param arg AMDM37x display controller
+ * @param pos New hot spot position
+ * @return EOK on success or an error code
+ */
+static errno_t amdm37x_ddev_cursor_move(void *arg, gfx_coord2_t *pos)
+{
+	amdm37x_dispc_t *dispc = (amdm37x_dispc_t *) arg;
+
+	if (dispc->cursor.data == NULL)
+		return ENOTSUP;
+
+	dispc->cursor.pos = *pos;
+	amdm37x_cursor_update(dispc);
+	return EOK;
+}
+
+/** Show or hide hardware cursor.
+ *
+ * @param arg AMDM37x display controller
+ * @param visible @c true to show cursor, @c false to hide it
+ * @return EOK on success or an error code
+ */
+static errno_t amdm37x_ddev_cursor_set_visible(void *arg, bool visible)
+{
+	amdm37x_dispc_t *dispc = (amdm37x_dispc_t *) arg;
+
+	if (dispc->cursor.data == NULL)
+		return ENOTSUP;
+
+	dispc->cursor.visible = visible;
+	amdm37x_cursor_update(dispc);
 	return EOK;
 }
 
@@ -372,16 +557,30 @@ static errno_t amdm37x_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	amdm37x_dispc_t *dispc = (amdm37x_dispc_t *) arg;
 	gfx_rect_t crect;
-	gfx_coord_t x, y;
+	gfx_coord_t y;
+	uint8_t *row;
+	size_t done;
+	size_t len;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &dispc->clip_rect, &crect);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
+
+	/* Convert one pixel, double it across the first row, copy the row */
+	row = dispc->fb_data + FB_POS(dispc, crect.p0.x, crect.p0.y);
+	dispc->active_fb.pixel2visual(row, dispc->color);
+
+	len = (crect.p1.x - crect.p0.x) * dispc->active_fb.bpp;
+	done = dispc->active_fb.bpp;
+	while (done < len) {
+		memcpy(row + done, row, min(done, len - done));
+		done += min(done, len - done);
+	}
 
-	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			dispc->active_fb.pixel2visual(dispc->fb_data +
-			    FB_POS(dispc, x, y), dispc->color);
-		}
+	for (y = crect.p0.y + 1; y < crect.p1.y; y++) {
+		memcpy(dispc->fb_data + FB_POS(dispc, crect.p0.x, y), row,
+		    len);
 	}
 
 	return EOK;
@@ -510,16 +709,15 @@ static errno_t amdm37x_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_rect_clip(&srect, &skfbrect, &crect);
 
 	if ((dcbm->flags & bmpf_color_key) == 0) {
-		/* Simple copy */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &dcbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				dispc->active_fb.pixel2visual(dispc->fb_data +
-				    FB_POS(dispc, dp.x, dp.y), color);
-			}
+		/* Simple copy, convert whole rows */
+		gfx_coord2_subtract(&crect.p0, &dcbm->rect.p0, &sp);
+		gfx_coord2_add(&crect.p0, &offs, &dp);
+
+		for (pos.y = 0; pos.y < crect.p1.y - crect.p0.y; pos.y++) {
+			dispc->active_fb.pixel2visual_row(dispc->fb_data +
+			    FB_POS(dispc, dp.x, dp.y + pos.y),
+			    pbm.data + (sp.y + pos.y) * pbm.width + sp.x,
+			    crect.p1.x - crect.p0.x);
 		}
 	} else if ((dcbm->flags & bmpf_colorize) == 0) {
 		/* Color key */
@@ -54,6 +54,7 @@ typedef struct {
 
 	struct {
 		pixel2visual_t pixel2visual;
+		pixel2visual_row_t pixel2visual_row;
 		unsigned width;
 		unsigned height;
 		unsigned pitch;
@@ -65,6 +66,20 @@ typedef struct {
 	gfx_rect_t clip_rect;
 	size_t size;
 	void *fb_data;
+
+	/** Hardware cursor (shown using video pipeline 2) */
+	struct {
+		/** Cursor image buffer or @c NULL if not available */
+		pixel_t *data;
+		/** Physical address of the image buffer */
+		uintptr_t pa;
+		/** Rectangle covered by the image, relative to hot spot */
+		gfx_rect_t rect;
+		/** Hot spot position */
+		gfx_coord2_t pos;
+		/** Cursor is visible */
+		bool visible;
+	} cursor;
 } amdm37x_dispc_t;
 
 typedef struct {
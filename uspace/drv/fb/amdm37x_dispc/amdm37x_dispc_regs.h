@@ -248,6 +248,12 @@ typedef struct {
 		ioport32_t position;
 		ioport32_t size;
 		ioport32_t attributes;
+#define AMDM37X_DISPC_VID_ATTRIBUTES_ENABLE_FLAG  (1 << 0)
+#define AMDM37X_DISPC_VID_ATTRIBUTES_FORMAT_MASK  0xf
+#define AMDM37X_DISPC_VID_ATTRIBUTES_FORMAT_SHIFT  1
+#define AMDM37X_DISPC_VID_ATTRIBUTES_FORMAT_ARGB  0xc
+#define AMDM37X_DISPC_VID_ATTRIBUTES_VIDCHANNELOUT_FLAG  (1 << 16)
+
 		ioport32_t fifo_threshold;
 		const ioport32_t fifo_size_status;
 		ioport32_t row_inc;
@@ -46,11 +46,13 @@
 #include <ddi.h>
 #include <ddf/log.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <gfx/bitmap.h>
 #include <gfx/color.h>
 #include <gfx/coord.h>
 #include <io/pixelmap.h>
 #include <ipcgfx/server.h>
+#include <macros.h>
 #include <mem.h>
 #include <pixconv.h>
 #include <stddef.h>
@@ -63,6 +65,12 @@
 
 #define FB_POS(fb, x, y)  ((y) * (fb)->scanline + (x) * (fb)->pixel_bytes)
 
+/** Maximum number of separately tracked dirty rectangles */
+#define KFB_DIRTY_MAX  8
+
+/** Delay between drawing and copying to the framebuffer (microseconds) */
+#define KFB_FLUSH_DELAY  16000
+
 typedef struct {
 	ddf_fun_t *fun;
 
@@ -74,13 +82,30 @@ typedef struct {
 	visual_t visual;
 
 	pixel2visual_t pixel2visual;
+	pixel2visual_row_t pixel2visual_row;
 	visual2pixel_t visual2pixel;
 	visual_mask_t visual_mask;
 	size_t pixel_bytes;
 
+	/** Visual has the same memory layout as pixel_t */
+	bool native;
+
 	size_t size;
 	uint8_t *addr;
 
+	/** Back buffer all drawing goes to, same layout as the framebuffer */
+	uint8_t *shadow;
+	/** Synchronizes drawing with flushing the back buffer */
+	fibril_mutex_t lock;
+	/** Timer for flushing the back buffer */
+	fibril_timer_t *flush_timer;
+	/** Flush timer is armed */
+	bool flush_pending;
+	/** Rectangles of the back buffer not yet copied to the framebuffer */
+	gfx_rect_t dirty[KFB_DIRTY_MAX];
+	/** Number of entries in @c dirty */
+	size_t ndirty;
+
 	/** Current drawing color */
 	pixel_t color;
 } kfb_t;
@@ -121,6 +146,85 @@ static gfx_context_ops_t kfb_gc_ops = {
 	.bitmap_get_alloc = kfb_gc_bitmap_get_alloc
 };
 
+/** Copy dirty rectangles from the back buffer to the framebuffer.
+ *
+ * Must be called with the KFB lock held.
+ *
+ * @param kfb KFB
+ */
+static void kfb_flush(kfb_t *kfb)
+{
+	gfx_rect_t *rect;
+	gfx_coord_t y;
+	size_t len;
+	size_t i;
+
+	for (i = 0; i < kfb->ndirty; i++) {
+		rect = &kfb->dirty[i];
+		len = (rect->p1.x - rect->p0.x) * kfb->pixel_bytes;
+
+		for (y = rect->p0.y; y < rect->p1.y; y++) {
+			memcpy(kfb->addr + FB_POS(kfb, rect->p0.x, y),
+			    kfb->shadow + FB_POS(kfb, rect->p0.x, y), len);
+		}
+	}
+
+	kfb->ndirty = 0;
+}
+
+/** Flush timer handler.
+ *
+ * @param arg KFB
+ */
+static void kfb_flush_timer(void *arg)
+{
+	kfb_t *kfb = (kfb_t *) arg;
+
+	fibril_mutex_lock(&kfb->lock);
+	kfb_flush(kfb);
+	kfb->flush_pending = false;
+	fibril_mutex_unlock(&kfb->lock);
+}
+
+/** Mark rectangle of the back buffer as dirty.
+ *
+ * Overlapping or touching rectangles are merged so that everything drawn
+ * until the flush timer fires is copied to the framebuffer only once.
+ * Must be called with the KFB lock held.
+ *
+ * @param kfb KFB
+ * @param rect Sorted rectangle, clipped to the KFB bounds
+ */
+static void kfb_damage(kfb_t *kfb, gfx_rect_t *rect)
+{
+	gfx_rect_t env;
+	size_t i;
+
+	if (gfx_rect_is_empty(rect))
+		return;
+
+	for (i = 0; i < kfb->ndirty; i++) {
+		if (gfx_rect_is_incident(&kfb->dirty[i], rect))
+			break;
+	}
+
+	if (i < kfb->ndirty || kfb->ndirty == KFB_DIRTY_MAX) {
+		/* Merge with an incident rectangle or, if full, the last one */
+		if (i == kfb->ndirty)
+			i = kfb->ndirty - 1;
+		gfx_rect_envelope(&kfb->dirty[i], rect, &env);
+		kfb->dirty[i] = env;
+	} else {
+		kfb->dirty[kfb->ndirty++] = *rect;
+	}
+
+	if (!kfb->flush_pending) {
+		fibril_timer_set_locked(kfb->flush_timer, KFB_FLUSH_DELAY,
+		    kfb_flush_timer, kfb);
+		kfb->flush_pending = true;
+	}
+}
+
 static errno_t kfb_ddev_get_gc(void *arg, sysarg_t *arg2, sysarg_t *arg3)
 {
 	kfb_t *kfb = (kfb_t *) arg;
@@ -188,18 +292,40 @@ static errno_t kfb_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	kfb_t *kfb = (kfb_t *) arg;
 	gfx_rect_t crect;
-	gfx_coord_t x, y;
+	gfx_coord_t y;
+	uint8_t *row;
+	size_t done;
+	size_t len;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &kfb->rect, &crect);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
 
-	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			kfb->pixel2visual(kfb->addr + FB_POS(kfb, x, y),
-			    kfb->color);
-		}
+	fibril_mutex_lock(&kfb->lock);
+
+	/*
+	 * Convert the first pixel, then fill the first row by doubling
+	 * the converted part and finally replicate the row.
+	 */
+	row = kfb->shadow + FB_POS(kfb, crect.p0.x, crect.p0.y);
+	kfb->pixel2visual(row, kfb->color);
+
+	len = (crect.p1.x - crect.p0.x) * kfb->pixel_bytes;
+	done = kfb->pixel_bytes;
+	while (done < len) {
+		memcpy(row + done, row, min(done, len - done));
+		done += min(done, len - done);
+	}
+
+	for (y = crect.p0.y + 1; y < crect.p1.y; y++) {
+		memcpy(kfb->shadow + FB_POS(kfb, crect.p0.x, y),
+		    kfb->shadow + FB_POS(kfb, crect.p0.x, crect.p0.y), len);
 	}
 
+	kfb_damage(kfb, &crect);
+	fibril_mutex_unlock(&kfb->lock);
+
 	return EOK;
 }
 
@@ -325,9 +451,13 @@ static errno_t kfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	 * destination lies within KFB bounding rectangle
 	 */
 	gfx_rect_clip(&srect, &skfbrect, &crect);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
+
+	fibril_mutex_lock(&kfb->lock);
 
 	if ((kfbbm->flags & bmpf_color_key) != 0) {
-		/* Simple copy */
+		/* Color key */
 		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
 			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
 				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
@@ -335,37 +465,41 @@ static errno_t kfb_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 
 				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
 				if (color != kfbbm->key_color) {
-					kfb->pixel2visual(kfb->addr +
+					kfb->pixel2visual(kfb->shadow +
 					    FB_POS(kfb, dp.x, dp.y), color);
 				}
 			}
 		}
-	} else if ((kfbbm->flags & bmpf_colorize) != 0) {
-		/* Color key */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				kfb->pixel2visual(kfb->addr +
-				    FB_POS(kfb, dp.x, dp.y), color);
-			}
+	} else if (kfb->native) {
+		/*
+		 * Simple copy, pixel formats match. Colorized bitmaps
+		 * are rendered the same way as plain ones.
+		 */
+		gfx_coord2_subtract(&crect.p0, &kfbbm->rect.p0, &sp);
+		gfx_coord2_add(&crect.p0, &offs, &dp);
+
+		for (pos.y = 0; pos.y < crect.p1.y - crect.p0.y; pos.y++) {
+			memcpy(kfb->shadow + FB_POS(kfb, dp.x, dp.y + pos.y),
+			    pbm.data + (sp.y + pos.y) * pbm.width + sp.x,
+			    (crect.p1.x - crect.p0.x) * sizeof(pixel_t));
 		}
 	} else {
-		/* Color key & colorize */
-		for (pos.y = crect.p0.y; pos.y < crect.p1.y; pos.y++) {
-			for (pos.x = crect.p0.x; pos.x < crect.p1.x; pos.x++) {
-				gfx_coord2_subtract(&pos, &kfbbm->rect.p0, &sp);
-				gfx_coord2_add(&pos, &offs, &dp);
-
-				color = pixelmap_get_pixel(&pbm, sp.x, sp.y);
-				kfb->pixel2visual(kfb->addr +
-				    FB_POS(kfb, dp.x, dp.y), color);
-			}
+		/* Simple copy, convert whole rows */
+		gfx_coord2_subtract(&crect.p0, &kfbbm->rect.p0, &sp);
+		gfx_coord2_add(&crect.p0, &offs, &dp);
+
+		for (pos.y = 0; pos.y < crect.p1.y - crect.p0.y; pos.y++) {
+			kfb->pixel2visual_row(kfb->shadow +
+			    FB_POS(kfb, dp.x, dp.y + pos.y),
+			    pbm.data + (sp.y + pos.y) * pbm.width + sp.x,
+			    crect.p1.x - crect.p0.x);
 		}
 	}
 
+	gfx_rect_translate(&offs, &crect, &drect);
+	kfb_damage(kfb, &drect);
+	fibril_mutex_unlock(&kfb->lock);
+
 	return EOK;
 }
 
@@ -413,10 +547,23 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 
 		rc = physmem_map(kfb->paddr + kfb->offset,
 		    ALIGN_UP(kfb->size, PAGE_SIZE) >> PAGE_WIDTH,
-		    AS_AREA_READ | AS_AREA_WRITE, (void *) &kfb->addr);
+		    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_WRITE_COMBINE,
+		    (void *) &kfb->addr);
 		if (rc != EOK)
 			goto error;
 
+		kfb->shadow = calloc(1, kfb->size);
+		if (kfb->shadow == NULL) {
+			rc = ENOMEM;
+			goto error;
+		}
+
+		kfb->flush_timer = fibril_timer_create(&kfb->lock);
+		if (kfb->flush_timer == NULL) {
+			rc = ENOMEM;
+			goto error;
+		}
+
 		rc = gfx_context_new(&kfb_gc_ops, kfb, &gc);
 		if (rc != EOK)
 			goto error;
@@ -424,6 +571,17 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 		/* GC connection */
 		gc_conn(icall, gc);
 
+		fibril_mutex_lock(&kfb->lock);
+		fibril_timer_clear_locked(kfb->flush_timer);
+		kfb->flush_pending = false;
+		kfb_flush(kfb);
+		fibril_mutex_unlock(&kfb->lock);
+
+		fibril_timer_destroy(kfb->flush_timer);
+		kfb->flush_timer = NULL;
+		free(kfb->shadow);
+		kfb->shadow = NULL;
+
 		rc = physmem_unmap(kfb->addr);
 		if (rc == EOK)
 			kfb->addr = AS_AREA_ANY;
@@ -431,6 +589,14 @@ static void kfb_client_conn(ipc_call_t *icall, void *arg)
 
 	return;
 error:
+	if (kfb->flush_timer != NULL) {
+		fibril_timer_destroy(kfb->flush_timer);
+		kfb->flush_timer = NULL;
+	}
+
+	free(kfb->shadow);
+	kfb->shadow = NULL;
+
 	if (kfb->addr != AS_AREA_ANY) {
 		if (physmem_unmap(kfb->addr) == EOK)
 			kfb->addr = AS_AREA_ANY;
@@ -439,6 +605,23 @@ error:
 	async_answer_0(icall, rc);
 }
 
+/** Determine whether visual has the same memory layout as pixel_t.
+ *
+ * @param kfb KFB
+ * @return @c true if bitmap rows can be copied without conversion
+ */
+static bool kfb_visual_is_native(kfb_t *kfb)
+{
+	pixel_t pix = PIXEL(0, 0x12, 0x34, 0x56);
+	pixel_t vis = 0;
+
+	if (kfb->pixel_bytes != sizeof(pixel_t))
+		return false;
+
+	kfb->pixel2visual(&vis, pix);
+	return vis == pix;
+}
+
 errno_t port_init(ddf_dev_t *dev)
 {
 	ddf_fun_t *fun = NULL;
@@ -594,8 +777,11 @@ errno_t port_init(ddf_dev_t *dev)
 		return EINVAL;
 	}
 
+	kfb->pixel2visual_row = pixconv_row_func(visual);
+	kfb->native = kfb_visual_is_native(kfb);
 	kfb->size = scanline * height;
 	kfb->addr = AS_AREA_ANY;
+	fibril_mutex_initialize(&kfb->lock);
 
 	rc = ddf_fun_bind(fun);
 	if (rc != EOK)
@@ -162,6 +162,9 @@ typedef struct {
 	/** The irq assigned */
 	int irq;
 
+	/** The irq is a message signalled interrupt */
+	bool msi;
+
 	/** Lock for CTRL register */
 	fibril_mutex_t ctrl_lock;
 
@@ -235,6 +238,8 @@ static driver_t e1000_driver = {
 static errno_t e1000_on_activating(nic_t *);
 static errno_t e1000_on_stopping(nic_t *);
 static void e1000_send_frame(nic_t *, void *, size_t);
+static void e1000_send_frame_offload(nic_t *, void *, size_t,
+    const nic_tx_offload_t *);
 
 /** PIO ranges used in the IRQ code. */
 irq_pio_range_t e1000_irq_pio_ranges[] = {
@@ -282,7 +287,11 @@ irq_code_t e1000_irq_code = {
 	    sizeof(irq_pio_range_t),
 	.ranges = e1000_irq_pio_ranges,
 	.cmdcount = sizeof(e1000_irq_commands) / sizeof(irq_cmd_t),
-	.cmds = e1000_irq_commands
+	.cmds = e1000_irq_commands,
+	.moderation = {
+		/* Only RXT0 is handled, merged notifications lose nothing */
+		.interval = NIC_NAPI_IRQ_INTERVAL
+	}
 };
 
 /** Get the device information
@@ -1165,13 +1174,34 @@ static uint32_t e1000_inc_tail(uint32_t tail, uint32_t descriptors_count)
 		return tail + 1;
 }
 
+/** Determine whether the NIC verified checksums of a received frame
+ *
+ * @param rx_descriptor Receive descriptor of the frame
+ *
+ * @return True if the TCP/UDP checksum was checked and found valid
+ *
+ */
+static bool e1000_rx_csum_ok(e1000_rx_descriptor_t *rx_descriptor)
+{
+	if ((rx_descriptor->status & RXDESCRIPTOR_STATUS_IXSM) != 0 ||
+	    (rx_descriptor->status & RXDESCRIPTOR_STATUS_TCPCS) == 0)
+		return false;
+
+	return (rx_descriptor->errors & RXDESCRIPTOR_ERRORS_TCPE) == 0;
+}
+
 /** Receive frames
  *
- * @param nic NIC data
+ * @param nic    NIC data
+ * @param budget Maximum number of frames to receive
+ *
+ * @return Number of frames received
  *
  */
-static void e1000_receive_frames(nic_t *nic)
+static size_t e1000_receive_frames(nic_t *nic, size_t budget)
 {
+	size_t count = 0;
+
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
 
 	fibril_mutex_lock(&e1000->rx_lock);
@@ -1182,12 +1212,15 @@ static void e1000_receive_frames(nic_t *nic)
 	e1000_rx_descriptor_t *rx_descriptor = (e1000_rx_descriptor_t *)
 	    (e1000->rx_ring_virt + next_tail * sizeof(e1000_rx_descriptor_t));
 
-	while (rx_descriptor->status & 0x01) {
+	while (count < budget &&
+	    (rx_descriptor->status & RXDESCRIPTOR_STATUS_DD) != 0) {
 		uint32_t frame_size = rx_descriptor->length - E1000_CRC_SIZE;
 
 		nic_frame_t *frame = nic_alloc_frame(nic, frame_size);
 		if (frame != NULL) {
 			memcpy(frame->data, e1000->rx_frame_virt[next_tail], frame_size);
+			if (e1000_rx_csum_ok(rx_descriptor))
+				frame->offload = NIC_OFFLOAD_RX_CSUM;
 			nic_received_frame(nic, frame);
 		} else {
 			ddf_msg(LVL_ERROR, "Memory allocation failed. Frame dropped.");
@@ -1200,9 +1233,11 @@ static void e1000_receive_frames(nic_t *nic)
 
 		rx_descriptor = (e1000_rx_descriptor_t *)
 		    (e1000->rx_ring_virt + next_tail * sizeof(e1000_rx_descriptor_t));
+		count++;
 	}
 
 	fibril_mutex_unlock(&e1000->rx_lock);
+	return count;
 }
 
 /** Enable E1000 interupts
@@ -1225,22 +1260,39 @@ static void e1000_disable_interrupts(e1000_t *e1000)
 	E1000_REG_WRITE(e1000, E1000_IMS, 0);
 }
 
-/** Interrupt handler implementation
+/** Receive frames in the NAPI fibril
  *
- * This function is called from e1000_interrupt_handler()
- * and e1000_poll()
+ * @param nic    NIC data
+ * @param budget Maximum number of frames to receive
  *
- * @param nic NIC data
- * @param icr ICR register value
+ * @return Number of frames received
  *
  */
-static void e1000_interrupt_handler_impl(nic_t *nic, uint32_t icr)
+static size_t e1000_napi_poll(nic_t *nic, size_t budget)
 {
-	if (icr & ICR_RXT0)
-		e1000_receive_frames(nic);
+	return e1000_receive_frames(nic, budget);
+}
+
+/** Enable or disable interrupts for the NAPI fibril
+ *
+ * @param nic    NIC data
+ * @param enable True to enable the interrupts
+ *
+ */
+static void e1000_napi_irq(nic_t *nic, bool enable)
+{
+	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+
+	if (enable)
+		e1000_enable_interrupts(e1000);
+	else
+		e1000_disable_interrupts(e1000);
 }
 
 /** Handle device interrupt
+ *
+ * The interrupt code has disabled the interrupts, they are enabled
+ * again by the NAPI fibril when it has received all frames.
  *
  * @param icall IPC call structure
  * @param dev   E1000 device
@@ -1251,10 +1303,9 @@ static void e1000_interrupt_handler(ipc_call_t *icall,
 {
 	uint32_t icr = (uint32_t) ipc_get_arg2(icall);
 	nic_t *nic = NIC_DATA_DEV(dev);
-	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
 
-	e1000_interrupt_handler_impl(nic, icr);
-	e1000_enable_interrupts(e1000);
+	if (icr & ICR_RXT0)
+		nic_napi_schedule(nic);
 }
 
 /** Register interrupt handler for the card in the system
@@ -1273,6 +1324,14 @@ inline static errno_t e1000_register_int_handler(nic_t *nic,
     cap_irq_handle_t *handle)
 {
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+	size_t nvec;
+	int inr;
+
+	/* Prefer a message signalled interrupt to the shared legacy line */
+	if (hw_res_msi_alloc(e1000->parent_sess, 1, &inr, &nvec) == EOK) {
+		e1000->irq = inr;
+		e1000->msi = true;
+	}
 
 	/* Lock the mutex in whole driver while working with global structure */
 	fibril_mutex_lock(&irq_reg_mutex);
@@ -1285,6 +1344,12 @@ inline static errno_t e1000_register_int_handler(nic_t *nic,
 	    e1000_interrupt_handler, &e1000_irq_code, handle);
 
 	fibril_mutex_unlock(&irq_reg_mutex);
+
+	if (rc != EOK && e1000->msi) {
+		hw_res_msi_free(e1000->parent_sess);
+		e1000->msi = false;
+	}
+
 	return rc;
 }
 
@@ -1301,7 +1366,8 @@ static void e1000_poll(nic_t *nic)
 	assert(e1000);
 
 	uint32_t icr = E1000_REG_READ(e1000, E1000_ICR);
-	e1000_interrupt_handler_impl(nic, icr);
+	if (icr & ICR_RXT0)
+		e1000_receive_frames(nic, SIZE_MAX);
 }
 
 /** Calculates ITR register interrupt from timespec structure
@@ -1369,6 +1435,9 @@ static void e1000_initialize_rx_registers(e1000_t *e1000)
 
 	/* Set Broadcast Enable Bit */
 	E1000_REG_WRITE(e1000, E1000_RCTL, RCTL_BAM);
+
+	/* Verify TCP/UDP checksums of received frames */
+	E1000_REG_WRITE(e1000, E1000_RXCSUM, RXCSUM_TUOFLD);
 }
 
 /** Initialize receive structure
@@ -1898,6 +1967,8 @@ static e1000_t *e1000_create_dev_data(ddf_dev_t *dev)
 
 	nic_set_specific(nic, e1000);
 	nic_set_send_frame_handler(nic, e1000_send_frame);
+	nic_set_offload_handler(nic, NIC_OFFLOAD_RX_CSUM | NIC_OFFLOAD_TX_CSUM,
+	    e1000_send_frame_offload);
 	nic_set_state_change_handlers(nic, e1000_on_activating,
 	    e1000_on_down, e1000_on_stopping);
 	nic_set_filtering_change_handlers(nic,
@@ -1910,6 +1981,12 @@ static e1000_t *e1000_create_dev_data(ddf_dev_t *dev)
 	fibril_mutex_initialize(&e1000->tx_lock);
 	fibril_mutex_initialize(&e1000->eeprom_lock);
 
+	if (nic_napi_init(nic, e1000_napi_poll, e1000_napi_irq) != EOK) {
+		/* Releases the specific data as well */
+		nic_unbind_and_destroy(dev);
+		return NULL;
+	}
+
 	return e1000;
 }
 
@@ -2211,6 +2288,8 @@ err_rx_structure:
 	e1000_uninitialize_rx_structure(nic);
 err_irq:
 	unregister_interrupt_handler(dev, irq_handle);
+	if (e1000->msi)
+		hw_res_msi_free(e1000->parent_sess);
 err_fun_create:
 	ddf_fun_destroy(fun);
 	nic_set_ddf_fun(nic, NULL);
@@ -2327,21 +2406,26 @@ static void e1000_eeprom_get_address(e1000_t *e1000,
 	*mac4_dest = e1000_eeprom_read(e1000, 2);
 }
 
-/** Send frame
+/** Send frame with optional checksum insertion
  *
- * @param nic    NIC driver data structure
- * @param data   Frame data
- * @param size   Frame size in bytes
- *
- * @return EOK if succeed
- * @return Error code in the case of error
+ * @param nic     NIC driver data structure
+ * @param data    Frame data
+ * @param size    Frame size in bytes
+ * @param offload Offload computations or NULL
  *
  */
-static void e1000_send_frame(nic_t *nic, void *data, size_t size)
+static void e1000_send_frame_common(nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
 {
 	assert(nic);
 
 	e1000_t *e1000 = DRIVER_DATA_NIC(nic);
+
+	if (size > E1000_MAX_SEND_FRAME_SIZE) {
+		/* Frame too long */
+		return;
+	}
+
 	fibril_mutex_lock(&e1000->tx_lock);
 
 	uint32_t tdt = E1000_REG_READ(e1000, E1000_TDT);
@@ -2378,6 +2462,20 @@ static void e1000_send_frame(nic_t *nic, void *data, size_t size)
 	    TXDESCRIPTOR_COMMAND_EOP;
 
 	tx_descriptor_addr->checksum_offset = 0;
+	tx_descriptor_addr->checksum_start_field = 0;
+
+	if (offload != NULL && (offload->flags & NIC_OFFLOAD_TX_CSUM) != 0) {
+		/*
+		 * The NIC sums from CSS to the end of the frame (including
+		 * the pseudo-header sum already stored in the checksum field)
+		 * and stores the complement at CSO.
+		 */
+		tx_descriptor_addr->checksum_start_field = offload->csum_start;
+		tx_descriptor_addr->checksum_offset = offload->csum_start +
+		    offload->csum_offs;
+		tx_descriptor_addr->command |= TXDESCRIPTOR_COMMAND_IC;
+	}
+
 	tx_descriptor_addr->status = 0;
 	if (e1000->vlan_tag_add) {
 		tx_descriptor_addr->special = e1000->vlan_tag;
@@ -2385,8 +2483,6 @@ static void e1000_send_frame(nic_t *nic, void *data, size_t size)
 	} else
 		tx_descriptor_addr->special = 0;
 
-	tx_descriptor_addr->checksum_start_field = 0;
-
 	tdt++;
 	if (tdt == E1000_TX_FRAME_COUNT)
 		tdt = 0;
@@ -2396,6 +2492,41 @@ static void e1000_send_frame(nic_t *nic, void *data, size_t size)
 	fibril_mutex_unlock(&e1000->tx_lock);
 }
 
+/** Send frame
+ *
+ * @param nic    NIC driver data structure
+ * @param data   Frame data
+ * @param size   Frame size in bytes
+ *
+ */
+static void e1000_send_frame(nic_t *nic, void *data, size_t size)
+{
+	e1000_send_frame_common(nic, data, size, NULL);
+}
+
+/** Send frame with checksum offload
+ *
+ * Only checksum insertion is supported, the legacy descriptors
+ * used by the driver cannot express TCP segmentation.
+ *
+ * @param nic     NIC driver data structure
+ * @param data    Frame data
+ * @param size    Frame size in bytes
+ * @param offload Offload computations
+ *
+ */
+static void e1000_send_frame_offload(nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	if ((offload->flags & NIC_OFFLOAD_TSO) != 0 ||
+	    offload->csum_start + offload->csum_offs > UINT8_MAX) {
+		/* Cannot be expressed in a legacy descriptor */
+		return;
+	}
+
+	e1000_send_frame_common(nic, data, size, offload);
+}
+
 int main(void)
 {
 	printf("%s: HelenOS E1000 network adapter driver\n", NAME);
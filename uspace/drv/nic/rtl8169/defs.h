@@ -191,6 +191,7 @@ enum rtl8169_interrupts {
 	INT_KNOWN = (INT_SERR | INT_TIME_OUT | INT_SW | INT_TDU |
 	    INT_FIFOOVW | INT_PUN | INT_RXOVW | INT_TER |
 	    INT_TOK | INT_RER | INT_ROK),
+	INT_RX = (INT_RXOVW | INT_RER | INT_ROK), /**< Handled by receive polling */
 };
 
 /** Transmit status descriptor registers bits */
@@ -94,6 +94,8 @@ static uint16_t rtl8169_mii_read(rtl8169_t *rtl8169, uint8_t addr);
 static void rtl8169_mii_write(rtl8169_t *rtl8169, uint8_t addr, uint16_t value);
 static void rtl8169_rx_ring_refill(rtl8169_t *rtl8169, unsigned int first,
     unsigned int last);
+static size_t rtl8169_napi_poll(nic_t *nic_data, size_t budget);
+static void rtl8169_napi_irq(nic_t *nic_data, bool enable);
 
 /** Network interface options for RTL8169 card driver */
 static nic_iface_t rtl8169_nic_iface = {
@@ -319,11 +321,17 @@ static rtl8169_t *rtl8169_create_dev_data(ddf_dev_t *dev)
 
 	fibril_mutex_initialize(&rtl8169->rx_lock);
 	fibril_mutex_initialize(&rtl8169->tx_lock);
+	fibril_mutex_initialize(&rtl8169->imr_lock);
 
 	nic_set_wol_max_caps(nic_data, NIC_WV_BROADCAST, 1);
 	nic_set_wol_max_caps(nic_data, NIC_WV_LINK_CHANGE, 1);
 	nic_set_wol_max_caps(nic_data, NIC_WV_MAGIC_PACKET, 1);
 
+	if (nic_napi_init(nic_data, rtl8169_napi_poll, rtl8169_napi_irq) != EOK) {
+		nic_unbind_and_destroy(dev);
+		return NULL;
+	}
+
 	return rtl8169;
 }
 
@@ -974,9 +982,8 @@ static void rtl8169_transmit_done(ddf_dev_t *dev)
 	fibril_mutex_unlock(&rtl8169->tx_lock);
 }
 
-static void rtl8169_receive_done(ddf_dev_t *dev)
+static size_t rtl8169_receive_done(nic_t *nic_data, size_t budget)
 {
-	nic_t *nic_data = nic_get_from_ddf_dev(dev);
 	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
 	rtl8169_descr_t *descr;
 	nic_frame_list_t *frames = nic_alloc_frame_list();
@@ -984,6 +991,7 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 	void *buffer;
 	unsigned int tail, fsidx = 0;
 	int frame_size;
+	size_t count = 0;
 
 	ddf_msg(LVL_DEBUG, "rtl8169_receive_done()");
 
@@ -991,7 +999,7 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 
 	tail = rtl8169->rx_tail;
 
-	while (true) {
+	while (count < budget) {
 		descr = &rtl8169->rx_ring[tail];
 
 		if (descr->control & CONTROL_OWN)
@@ -1015,8 +1023,11 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 			frame_size = descr->control & 0x1fff;
 			buffer = rtl8169->rx_buff + (BUFFER_SIZE * tail);
 			frame = nic_alloc_frame(nic_data, frame_size);
-			memcpy(frame->data, buffer, frame_size);
-			nic_frame_list_append(frames, frame);
+			if (frame != NULL) {
+				memcpy(frame->data, buffer, frame_size);
+				nic_frame_list_append(frames, frame);
+			}
+			count++;
 		}
 
 		tail = (tail + 1) % RX_BUFFERS_COUNT;
@@ -1029,7 +1040,42 @@ static void rtl8169_receive_done(ddf_dev_t *dev)
 	fibril_mutex_unlock(&rtl8169->rx_lock);
 
 	nic_received_frame_list(nic_data, frames);
+	return count;
+}
+
+/** Receive frames in the NAPI fibril */
+static size_t rtl8169_napi_poll(nic_t *nic_data, size_t budget)
+{
+	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
 
+	/* Frames received from now on raise a new interrupt */
+	pio_write_16(rtl8169->regs + ISR, INT_RX);
+	return rtl8169_receive_done(nic_data, budget);
+}
+
+/** Write the interrupt mask, with receive interrupts masked while polling
+ *
+ * Must be called with imr_lock held.
+ */
+static void rtl8169_imr_write(rtl8169_t *rtl8169)
+{
+	uint16_t imr = 0xffff;
+
+	if (rtl8169->rx_polling)
+		imr &= ~INT_RX;
+
+	pio_write_16(rtl8169->regs + IMR, imr);
+}
+
+/** Enable or disable receive interrupts for the NAPI fibril */
+static void rtl8169_napi_irq(nic_t *nic_data, bool enable)
+{
+	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
+
+	fibril_mutex_lock(&rtl8169->imr_lock);
+	rtl8169->rx_polling = !enable;
+	rtl8169_imr_write(rtl8169);
+	fibril_mutex_unlock(&rtl8169->imr_lock);
 }
 
 static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
@@ -1042,7 +1088,20 @@ static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 	rtl8169_t *rtl8169 = nic_get_specific(nic_data);
 
 	ddf_msg(LVL_DEBUG, "rtl8169_irq_handler(): isr=0x%04x", isr);
-	pio_write_16(rtl8169->regs + IMR, 0xffff);
+
+	/*
+	 * The interrupt code has masked all interrupts. Receive interrupts
+	 * stay masked until the NAPI fibril has received all frames.
+	 */
+	fibril_mutex_lock(&rtl8169->imr_lock);
+	if (isr & INT_RX)
+		rtl8169->rx_polling = true;
+	rtl8169_imr_write(rtl8169);
+	fibril_mutex_unlock(&rtl8169->imr_lock);
+
+	if (isr & INT_RX)
+		nic_napi_schedule(nic_data);
+	isr &= ~INT_RX;
 
 	while (isr != 0) {
 		ddf_msg(LVL_DEBUG, "irq handler: remaining isr=0x%04x", isr);
@@ -1059,26 +1118,14 @@ static void rtl8169_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 			pio_write_16(rtl8169->regs + ISR, (INT_TER | INT_TOK | INT_TDU));
 		}
 
-		/* Receive underrun */
-		if (isr & INT_RXOVW) {
-			/* just ack.. */
-			pio_write_16(rtl8169->regs + ISR, INT_RXOVW);
-		}
-
 		if (isr & INT_SERR) {
 			ddf_msg(LVL_ERROR, "System error interrupt");
 			pio_write_16(rtl8169->regs + ISR, INT_SERR);
 		}
 
-		if (isr & (INT_RER | INT_ROK)) {
-			rtl8169_receive_done(dev);
-			pio_write_16(rtl8169->regs + ISR, (INT_RER | INT_ROK));
-		}
-
-		isr = pio_read_16(rtl8169->regs + ISR) & INT_KNOWN;
+		/* Receive status is acknowledged by the NAPI fibril */
+		isr = pio_read_16(rtl8169->regs + ISR) & INT_KNOWN & ~INT_RX;
 	}
-
-	pio_write_16(rtl8169->regs + ISR, 0xffff);
 }
 
 static void rtl8169_send_frame(nic_t *nic_data, void *data, size_t size)
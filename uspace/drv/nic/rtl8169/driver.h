@@ -98,6 +98,11 @@ typedef struct rtl8169_data {
 	/** Lock for transmitter */
 	fibril_mutex_t tx_lock;
 
+	/** Receive interrupts are masked while the NAPI fibril polls */
+	bool rx_polling;
+	/** Lock for the interrupt mask register and rx_polling */
+	fibril_mutex_t imr_lock;
+
 	/** Backward pointer to nic_data */
 	nic_t *nic_data;
 
@@ -32,6 +32,12 @@
 #include <stdint.h>
 
 #include <as.h>
+#include <byteorder.h>
+#include <fibril.h>
+#include <inet/checksum.h>
+#include <macros.h>
+#include <stats.h>
+#include <stdlib.h>
 #include <ddf/driver.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -45,15 +51,21 @@
 
 #define NAME	"virtio-net"
 
-#define VIRTIO_NET_NUM_QUEUES	3
+/*
+ * The RX and TX virtqueues of each pair are interleaved, the control
+ * virtqueue follows all the pairs the device supports.
+ */
+#define RX_QUEUE(pair)	(2 * (pair))
+#define TX_QUEUE(pair)	(2 * (pair) + 1)
 
-#define RX_QUEUE_1	0
-#define TX_QUEUE_1	1
-#define CT_QUEUE_1	2
+/** Time to wait for the device to acknowledge a control command */
+#define CT_TIMEOUT	(1000 * 1000)
 
 #define BUFFER_SIZE	2048
 #define RX_BUF_SIZE	BUFFER_SIZE
 #define TX_BUF_SIZE	BUFFER_SIZE
+/** TX buffer size fitting a header and a super-segment for TSO */
+#define TSO_TX_BUF_SIZE	(68 * 1024)
 #define CT_BUF_SIZE	BUFFER_SIZE
 
 static ddf_dev_ops_t virtio_net_dev_ops;
@@ -69,6 +81,211 @@ static driver_t virtio_net_driver = {
 	.driver_ops = &virtio_net_driver_ops
 };
 
+/** Complete or check the TCP/UDP checksum of a received frame.
+ *
+ * @param hdr   Header of the frame
+ * @param data  Frame data
+ * @param size  Frame size
+ *
+ * @return NIC_OFFLOAD_RX_CSUM if the checksum is known to be good
+ */
+static uint32_t virtio_net_rx_csum(virtio_net_hdr_t *hdr, uint8_t *data,
+    size_t size)
+{
+	if ((hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) != 0) {
+		/*
+		 * The frame comes from the host and only carries
+		 * the pseudo-header sum, complete the checksum.
+		 */
+		size_t start = uint16_t_le2host(hdr->csum_start);
+		size_t offs = start + uint16_t_le2host(hdr->csum_offset);
+		if (offs + 2 > size)
+			return 0;
+
+		uint16_t cs = inet_checksum_calc(INET_CHECKSUM_INIT,
+		    data + start, size - start);
+		data[offs] = cs >> 8;
+		data[offs + 1] = cs & 0xff;
+		return NIC_OFFLOAD_RX_CSUM;
+	}
+
+	if ((hdr->flags & VIRTIO_NET_HDR_F_DATA_VALID) != 0)
+		return NIC_OFFLOAD_RX_CSUM;
+
+	return 0;
+}
+
+/** Pass a received frame to the NIC framework.
+ *
+ * A frame fitting in a slot of the client's packet ring is gathered
+ * straight into the slot, otherwise into a newly allocated frame.
+ *
+ * @param nic       NIC
+ * @param pair      Pair the frame was received on
+ * @param descs     Buffers holding the frame, the first starts with a header
+ * @param lens      Lengths of the data in the buffers
+ * @param nbufs     Number of buffers
+ * @param size      Size of the frame without the header
+ * @param ring_put  Set to true if the frame was put into the packet ring
+ */
+static void virtio_net_rx_deliver(nic_t *nic, unsigned pair, uint16_t *descs,
+    uint32_t *lens, unsigned nbufs, size_t size, bool *ring_put)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_net_hdr_t *hdr =
+	    (virtio_net_hdr_t *) virtio_net->rx_buf[pair][descs[0]];
+	nic_frame_t *frame = NULL;
+	size_t slot_size;
+	uint8_t *dest;
+
+	dest = nic_rx_ring_slot(nic, &slot_size);
+	if (dest == NULL || size > slot_size) {
+		frame = nic_alloc_frame(nic, size);
+		if (frame == NULL) {
+			ddf_msg(LVL_WARN, "Cannot allocate RX frame, "
+			    "packet dropped");
+			return;
+		}
+		dest = frame->data;
+	}
+
+	size_t offs = lens[0] - sizeof(*hdr);
+	memcpy(dest, &hdr[1], offs);
+	for (unsigned i = 1; i < nbufs; i++) {
+		memcpy(dest + offs, virtio_net->rx_buf[pair][descs[i]],
+		    lens[i]);
+		offs += lens[i];
+	}
+
+	uint32_t offload = virtio_net_rx_csum(hdr, dest, size);
+
+	if (frame != NULL) {
+		frame->offload = offload;
+		nic_received_frame(nic, frame);
+	} else {
+		nic_rx_ring_put(nic, size, offload);
+		*ring_put = true;
+	}
+}
+
+/** Receive one frame from the RX virtqueue of a pair.
+ *
+ * With VIRTIO_NET_F_MRG_RXBUF a frame may span several buffers, the header
+ * in the first one tells how many. The buffers are put back into the
+ * available ring, the caller notifies the device.
+ *
+ * @param nic       NIC
+ * @param pair      Pair to receive from
+ * @param ring_put  Set to true if the frame was put into the packet ring
+ *
+ * @return False if there was no frame to receive
+ */
+static bool virtio_net_rx_frame(nic_t *nic, unsigned pair, bool *ring_put)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t descs[RX_BUFFERS];
+	uint32_t lens[RX_BUFFERS];
+	unsigned nbufs = 1;
+	size_t size;
+
+	if (!virtio_virtq_consume_used(vdev, RX_QUEUE(pair), &descs[0],
+	    &lens[0]))
+		return false;
+
+	virtio_net_hdr_t *hdr =
+	    (virtio_net_hdr_t *) virtio_net->rx_buf[pair][descs[0]];
+
+	if (lens[0] <= sizeof(*hdr) || lens[0] > RX_BUF_SIZE) {
+		ddf_msg(LVL_WARN, "RX data length invalid, packet dropped");
+		goto recycle;
+	}
+
+	size = lens[0] - sizeof(*hdr);
+
+	if (virtio_net->mrg_rxbuf) {
+		unsigned count = uint16_t_le2host(hdr->num_buffers);
+		if (count == 0 || count > RX_BUFFERS) {
+			ddf_msg(LVL_WARN, "RX buffer count invalid, "
+			    "packet dropped");
+			goto recycle;
+		}
+
+		for (; nbufs < count; nbufs++) {
+			if (!virtio_virtq_consume_used(vdev, RX_QUEUE(pair),
+			    &descs[nbufs], &lens[nbufs])) {
+				ddf_msg(LVL_WARN, "RX buffers missing, "
+				    "packet dropped");
+				goto recycle;
+			}
+
+			if (lens[nbufs] > RX_BUF_SIZE) {
+				ddf_msg(LVL_WARN, "RX data length invalid, "
+				    "packet dropped");
+				nbufs++;
+				goto recycle;
+			}
+
+			size += lens[nbufs];
+		}
+	}
+
+	virtio_net_rx_deliver(nic, pair, descs, lens, nbufs, size, ring_put);
+
+recycle:
+	for (unsigned i = 0; i < nbufs; i++)
+		virtio_virtq_add_available(vdev, RX_QUEUE(pair), descs[i]);
+
+	return true;
+}
+
+/** Receive frames from the RX virtqueues in the NAPI fibril. */
+static size_t virtio_net_napi_poll(nic_t *nic, size_t budget)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	unsigned npairs = virtio_net->npairs;
+	size_t count = 0;
+
+	bool ring_put = false;
+
+	/* Start with a different pair each time so that no pair starves */
+	for (unsigned i = 0; i < npairs && count < budget; i++) {
+		unsigned pair = (virtio_net->rx_pair + i) % npairs;
+		size_t received = 0;
+
+		while (count < budget &&
+		    virtio_net_rx_frame(nic, pair, &ring_put)) {
+			received++;
+			count++;
+		}
+
+		/* Give the device all the refilled buffers at once */
+		if (received > 0)
+			virtio_virtq_kick(vdev, RX_QUEUE(pair));
+	}
+
+	if (npairs > 0)
+		virtio_net->rx_pair = (virtio_net->rx_pair + 1) % npairs;
+
+	/* Let the client see the whole batch */
+	if (ring_put)
+		nic_rx_ring_flush(nic);
+
+	return count;
+}
+
+/** Enable or disable the RX virtqueue interrupts for the NAPI fibril. */
+static void virtio_net_napi_irq(nic_t *nic, bool enable)
+{
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+
+	for (unsigned pair = 0; pair < virtio_net->npairs; pair++) {
+		virtio_virtq_set_interrupt(&virtio_net->virtio_dev,
+		    RX_QUEUE(pair), enable);
+	}
+}
+
 static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 {
 	nic_t *nic = ddf_dev_data_get(dev);
@@ -77,36 +294,37 @@ static void virtio_net_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
 
 	uint16_t descno;
 	uint32_t len;
-	while (virtio_virtq_consume_used(vdev, RX_QUEUE_1, &descno, &len)) {
-		virtio_net_hdr_t *hdr =
-		    (virtio_net_hdr_t *) virtio_net->rx_buf[descno];
-		if (len <= sizeof(*hdr)) {
-			ddf_msg(LVL_WARN,
-			    "RX data length too short, packet dropped");
-			virtio_virtq_produce_available(vdev, RX_QUEUE_1,
-			    descno);
-			continue;
-		}
 
-		nic_frame_t *frame = nic_alloc_frame(nic, len - sizeof(*hdr));
-		if (frame) {
-			memcpy(frame->data, &hdr[1], len - sizeof(*hdr));
-			nic_received_frame(nic, frame);
-		} else {
-			ddf_msg(LVL_WARN,
-			    "Cannot allocate RX frame, packet dropped");
-		}
-
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, descno);
+	/*
+	 * Frames are received by the NAPI fibril, which enables the RX
+	 * interrupts again when it is done.
+	 */
+	if (virtio_net->npairs > 0) {
+		virtio_net_napi_irq(nic, false);
+		nic_napi_schedule(nic);
 	}
 
-	while (virtio_virtq_consume_used(vdev, TX_QUEUE_1, &descno, &len)) {
-		virtio_free_desc(vdev, TX_QUEUE_1, &virtio_net->tx_free_head,
-		    descno);
+	/* All virtqueues share the interrupt. */
+	for (unsigned pair = 0; pair < virtio_net->npairs; pair++) {
+		while (virtio_virtq_consume_used(vdev, TX_QUEUE(pair), &descno,
+		    &len)) {
+			virtio_free_desc(vdev, TX_QUEUE(pair),
+			    &virtio_net->tx_free_head[pair], descno);
+		}
 	}
-	while (virtio_virtq_consume_used(vdev, CT_QUEUE_1, &descno, &len)) {
-		virtio_free_desc(vdev, CT_QUEUE_1, &virtio_net->ct_free_head,
-		    descno);
+
+	/* Control commands free their descriptors themselves */
+	if (virtio_net->npairs > 0) {
+		bool done = false;
+		while (virtio_virtq_consume_used(vdev, virtio_net->ct_queue,
+		    &descno, &len))
+			done = true;
+		if (done) {
+			fibril_mutex_lock(&virtio_net->ct_lock);
+			virtio_net->ct_done = true;
+			fibril_condvar_broadcast(&virtio_net->ct_cv);
+			fibril_mutex_unlock(&virtio_net->ct_lock);
+		}
 	}
 }
 
@@ -132,6 +350,33 @@ static errno_t virtio_net_register_interrupt(ddf_dev_t *dev)
 	virtio_net->irq = res.irqs.irqs[0];
 	hw_res_list_parsed_clean(&res);
 
+	/* With MSI-X the interrupt is ours alone and the ISR stays unused */
+	int inr;
+	if (virtio_pci_msi_alloc(dev, vdev, &inr) == EOK) {
+		virtio_net->irq = inr;
+
+		irq_cmd_t msi_commands[] = {
+			{
+				.cmd = CMD_ACCEPT
+			}
+		};
+
+		irq_code_t msi_code = {
+			.cmdcount = sizeof(msi_commands) / sizeof(irq_cmd_t),
+			.cmds = msi_commands,
+			.moderation = {
+				.interval = NIC_NAPI_IRQ_INTERVAL
+			}
+		};
+
+		rc = register_interrupt_handler(dev, virtio_net->irq,
+		    virtio_net_irq_handler, &msi_code,
+		    &virtio_net->irq_handle);
+		if (rc != EOK)
+			virtio_pci_msi_free(dev, vdev);
+		return rc;
+	}
+
 	irq_pio_range_t pio_ranges[] = {
 		{
 			.base = vdev->isr_phys,
@@ -159,13 +404,134 @@ static errno_t virtio_net_register_interrupt(ddf_dev_t *dev)
 		.rangecount = sizeof(pio_ranges) / sizeof(irq_pio_range_t),
 		.ranges = pio_ranges,
 		.cmdcount = sizeof(irq_commands) / sizeof(irq_cmd_t),
-		.cmds = irq_commands
+		.cmds = irq_commands,
+		.moderation = {
+			/* The handler does not depend on the ISR value */
+			.interval = NIC_NAPI_IRQ_INTERVAL
+		}
 	};
 
 	return register_interrupt_handler(dev, virtio_net->irq,
 	    virtio_net_irq_handler, &irq_code, &virtio_net->irq_handle);
 }
 
+/** Set up the RX and TX virtqueues of one pair and their DMA buffers. */
+static errno_t virtio_net_pair_setup(virtio_net_t *virtio_net, unsigned pair)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+
+	errno_t rc = virtio_virtq_setup(vdev, RX_QUEUE(pair), RX_BUFFERS);
+	if (rc != EOK)
+		return rc;
+	rc = virtio_virtq_setup(vdev, TX_QUEUE(pair), TX_BUFFERS);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Setup DMA buffers
+	 */
+	rc = virtio_setup_dma_bufs(RX_BUFFERS, RX_BUF_SIZE, false,
+	    virtio_net->rx_buf[pair], virtio_net->rx_buf_p[pair]);
+	if (rc != EOK)
+		return rc;
+	rc = virtio_setup_dma_bufs(TX_BUFFERS, virtio_net->tx_buf_size, true,
+	    virtio_net->tx_buf[pair], virtio_net->tx_buf_p[pair]);
+	if (rc != EOK)
+		return rc;
+
+	/*
+	 * Give all RX buffers to the NIC
+	 */
+	for (unsigned i = 0; i < RX_BUFFERS; i++) {
+		/*
+		 * Associtate the buffer with the descriptor, set length and
+		 * flags.
+		 */
+		virtio_virtq_desc_set(vdev, RX_QUEUE(pair), i,
+		    virtio_net->rx_buf_p[pair][i], RX_BUF_SIZE,
+		    VIRTQ_DESC_F_WRITE, 0);
+		/*
+		 * Put the set descriptor into the available ring of the RX
+		 * queue.
+		 */
+		virtio_virtq_add_available(vdev, RX_QUEUE(pair), i);
+	}
+	virtio_virtq_kick(vdev, RX_QUEUE(pair));
+
+	/*
+	 * Put all TX buffers on a free list
+	 */
+	virtio_create_desc_free_list(vdev, TX_QUEUE(pair), TX_BUFFERS,
+	    &virtio_net->tx_free_head[pair]);
+
+	return EOK;
+}
+
+/** Release the DMA buffers of all virtqueues. */
+static void virtio_net_bufs_teardown(virtio_net_t *virtio_net)
+{
+	for (unsigned pair = 0; pair < VIRTIO_NET_MAX_PAIRS; pair++) {
+		virtio_teardown_dma_bufs(virtio_net->rx_buf[pair]);
+		virtio_teardown_dma_bufs(virtio_net->tx_buf[pair]);
+	}
+	virtio_teardown_dma_bufs(virtio_net->ct_buf);
+}
+
+/** Tell the device how many RX/TX virtqueue pairs to use.
+ *
+ * The command goes out in one descriptor and the device acknowledges it
+ * in another one, both of which are freed here once the device is done.
+ *
+ * @param virtio_net Device
+ * @param npairs     Number of pairs
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t virtio_net_ctrl_mq(virtio_net_t *virtio_net, unsigned npairs)
+{
+	virtio_dev_t *vdev = &virtio_net->virtio_dev;
+	uint16_t ctq = virtio_net->ct_queue;
+
+	uint16_t descs[2];
+	errno_t rc = virtio_alloc_desc_chain(vdev, ctq, &virtio_net->ct_free_head,
+	    2, descs);
+	if (rc != EOK)
+		return rc;
+	uint16_t cmd = descs[0];
+	uint16_t ack = descs[1];
+
+	virtio_net_ctrl_mq_t *mq = virtio_net->ct_buf[cmd];
+	mq->class = VIRTIO_NET_CTRL_MQ;
+	mq->command = VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET;
+	pio_write_le16(&mq->virtqueue_pairs, npairs);
+
+	uint8_t *status = virtio_net->ct_buf[ack];
+	*status = VIRTIO_NET_ERR;
+
+	fibril_mutex_lock(&virtio_net->ct_lock);
+	virtio_net->ct_done = false;
+
+	virtio_virtq_desc_set(vdev, ctq, cmd, virtio_net->ct_buf_p[cmd],
+	    sizeof(virtio_net_ctrl_mq_t), VIRTQ_DESC_F_NEXT, ack);
+	virtio_virtq_desc_set(vdev, ctq, ack, virtio_net->ct_buf_p[ack],
+	    sizeof(uint8_t), VIRTQ_DESC_F_WRITE, 0);
+	virtio_virtq_produce_available(vdev, ctq, cmd);
+
+	while (!virtio_net->ct_done && rc == EOK) {
+		rc = fibril_condvar_wait_timeout(&virtio_net->ct_cv,
+		    &virtio_net->ct_lock, CT_TIMEOUT);
+	}
+	fibril_mutex_unlock(&virtio_net->ct_lock);
+
+	/* The descriptors remain the device's until it has used them */
+	if (rc != EOK)
+		return rc;
+
+	virtio_free_desc_chain(vdev, ctq, &virtio_net->ct_free_head, cmd);
+
+	return *status == VIRTIO_NET_OK ? EOK : EIO;
+}
+
 static errno_t virtio_net_initialize(ddf_dev_t *dev)
 {
 	nic_t *nic = nic_create_and_bind(dev);
@@ -180,7 +546,17 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 
 	nic_set_specific(nic, virtio_net);
 
-	errno_t rc = virtio_pci_dev_initialize(dev, &virtio_net->virtio_dev);
+	fibril_mutex_initialize(&virtio_net->ct_lock);
+	fibril_condvar_initialize(&virtio_net->ct_cv);
+
+	errno_t rc = nic_napi_init(nic, virtio_net_napi_poll,
+	    virtio_net_napi_irq);
+	if (rc != EOK) {
+		nic_unbind_and_destroy(dev);
+		return rc;
+	}
+
+	rc = virtio_pci_dev_initialize(dev, &virtio_net->virtio_dev);
 	if (rc != EOK)
 		return rc;
 
@@ -196,49 +572,88 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/* Reset the device and negotiate the feature bits */
-	rc = virtio_device_setup_start(vdev,
-	    VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ);
+	uint32_t features;
+	uint32_t required = VIRTIO_NET_F_MAC | VIRTIO_NET_F_CTRL_VQ;
+	uint32_t optional = VIRTIO_NET_F_MQ | VIRTIO_NET_F_CSUM |
+	    VIRTIO_NET_F_GUEST_CSUM | VIRTIO_NET_F_HOST_TSO4 |
+	    VIRTIO_NET_F_GUEST_TSO4 | VIRTIO_NET_F_MRG_RXBUF |
+	    VIRTIO_RING_F_EVENT_IDX;
+	rc = virtio_device_setup_start_opt(vdev, required, optional,
+	    &features);
 	if (rc != EOK)
 		goto fail;
 
+	/*
+	 * Large received segments only fit in mergeable buffers and come
+	 * with a partial checksum. Start over without them otherwise.
+	 */
+	uint32_t lro_deps = VIRTIO_NET_F_MRG_RXBUF | VIRTIO_NET_F_GUEST_CSUM;
+	if ((features & VIRTIO_NET_F_GUEST_TSO4) != 0 &&
+	    (features & lro_deps) != lro_deps) {
+		rc = virtio_device_setup_start_opt(vdev, required,
+		    optional & ~VIRTIO_NET_F_GUEST_TSO4, &features);
+		if (rc != EOK)
+			goto fail;
+	}
+
+	virtio_net->mrg_rxbuf = (features & VIRTIO_NET_F_MRG_RXBUF) != 0;
+	if ((features & VIRTIO_NET_F_GUEST_TSO4) != 0)
+		ddf_msg(LVL_NOTE, "Receiving large TCP segments");
+
+	virtio_net->offload = 0;
+	virtio_net->tx_buf_size = TX_BUF_SIZE;
+	if ((features & VIRTIO_NET_F_GUEST_CSUM) != 0)
+		virtio_net->offload |= NIC_OFFLOAD_RX_CSUM;
+	if ((features & VIRTIO_NET_F_CSUM) != 0) {
+		virtio_net->offload |= NIC_OFFLOAD_TX_CSUM;
+		if ((features & VIRTIO_NET_F_HOST_TSO4) != 0) {
+			virtio_net->offload |= NIC_OFFLOAD_TSO;
+			virtio_net->tx_buf_size = TSO_TX_BUF_SIZE;
+		}
+	}
+
 	/* Perform device-specific setup */
 
 	/*
-	 * Discover and configure the virtqueues
+	 * Discover and configure the virtqueues. There is no point in using
+	 * more RX/TX pairs than there are CPUs to drive them.
 	 */
+	unsigned max_pairs = 1;
+	if ((features & VIRTIO_NET_F_MQ) != 0)
+		max_pairs = max(pio_read_le16(&netcfg->max_virtqueue_pairs), 1);
+
 	uint16_t num_queues = pio_read_le16(&cfg->num_queues);
-	if (num_queues != VIRTIO_NET_NUM_QUEUES) {
+	if (num_queues < 2 * max_pairs + 1) {
 		ddf_msg(LVL_NOTE, "Unsupported number of virtqueues: %u",
 		    num_queues);
 		rc = ELIMIT;
 		goto fail;
 	}
 
+	unsigned npairs = min(max_pairs, VIRTIO_NET_MAX_PAIRS);
+
+	size_t ncpus;
+	stats_cpu_t *cpus = stats_get_cpus(&ncpus);
+	if (cpus != NULL) {
+		npairs = max(min(npairs, ncpus), 1);
+		free(cpus);
+	}
+
+	virtio_net->ct_queue = 2 * max_pairs;
+
 	vdev->queues = calloc(sizeof(virtq_t), num_queues);
 	if (!vdev->queues) {
 		rc = ENOMEM;
 		goto fail;
 	}
 
-	rc = virtio_virtq_setup(vdev, RX_QUEUE_1, RX_BUFFERS);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_virtq_setup(vdev, TX_QUEUE_1, TX_BUFFERS);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_virtq_setup(vdev, CT_QUEUE_1, CT_BUFFERS);
-	if (rc != EOK)
-		goto fail;
+	for (unsigned pair = 0; pair < npairs; pair++) {
+		rc = virtio_net_pair_setup(virtio_net, pair);
+		if (rc != EOK)
+			goto fail;
+	}
 
-	/*
-	 * Setup DMA buffers
-	 */
-	rc = virtio_setup_dma_bufs(RX_BUFFERS, RX_BUF_SIZE, false,
-	    virtio_net->rx_buf, virtio_net->rx_buf_p);
-	if (rc != EOK)
-		goto fail;
-	rc = virtio_setup_dma_bufs(TX_BUFFERS, TX_BUF_SIZE, true,
-	    virtio_net->tx_buf, virtio_net->tx_buf_p);
+	rc = virtio_virtq_setup(vdev, virtio_net->ct_queue, CT_BUFFERS);
 	if (rc != EOK)
 		goto fail;
 	rc = virtio_setup_dma_bufs(CT_BUFFERS, CT_BUF_SIZE, true,
@@ -247,31 +662,14 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 		goto fail;
 
 	/*
-	 * Give all RX buffers to the NIC
+	 * Put all CT buffers on a free list
 	 */
-	for (unsigned i = 0; i < RX_BUFFERS; i++) {
-		/*
-		 * Associtate the buffer with the descriptor, set length and
-		 * flags.
-		 */
-		virtio_virtq_desc_set(vdev, RX_QUEUE_1, i,
-		    virtio_net->rx_buf_p[i], RX_BUF_SIZE, VIRTQ_DESC_F_WRITE,
-		    0);
-		/*
-		 * Put the set descriptor into the available ring of the RX
-		 * queue.
-		 */
-		virtio_virtq_produce_available(vdev, RX_QUEUE_1, i);
-	}
-
-	/*
-	 * Put all TX and CT buffers on a free list
-	 */
-	virtio_create_desc_free_list(vdev, TX_QUEUE_1, TX_BUFFERS,
-	    &virtio_net->tx_free_head);
-	virtio_create_desc_free_list(vdev, CT_QUEUE_1, CT_BUFFERS,
+	virtio_create_desc_free_list(vdev, virtio_net->ct_queue, CT_BUFFERS,
 	    &virtio_net->ct_free_head);
 
+	virtio_net->npairs = npairs;
+	virtio_net->tx_pairs = 1;
+
 	/*
 	 * Read the MAC address
 	 */
@@ -299,14 +697,31 @@ static errno_t virtio_net_initialize(ddf_dev_t *dev)
 	/* Go live */
 	virtio_device_setup_finalize(vdev);
 
+	/*
+	 * The device only uses the first pair until told otherwise. Should
+	 * it refuse, all the frames still arrive on the first pair.
+	 */
+	if (npairs > 1) {
+		if (virtio_net_ctrl_mq(virtio_net, npairs) == EOK) {
+			virtio_net->tx_pairs = npairs;
+			/* Let the queues be driven from more than one CPU. */
+			fibril_test_spawn_runners(npairs - 1);
+		} else {
+			ddf_msg(LVL_WARN, "Failed to enable %u queue pairs",
+			    npairs);
+		}
+	}
+
+	ddf_msg(LVL_NOTE, "Using %u RX/TX queue pair(s)",
+	    virtio_net->tx_pairs);
+
 	return EOK;
 
 fail:
-	virtio_teardown_dma_bufs(virtio_net->rx_buf);
-	virtio_teardown_dma_bufs(virtio_net->tx_buf);
-	virtio_teardown_dma_bufs(virtio_net->ct_buf);
+	virtio_net_bufs_teardown(virtio_net);
 
 	virtio_device_setup_fail(vdev);
+	virtio_pci_msi_free(dev, vdev);
 	virtio_pci_dev_cleanup(vdev);
 	return rc;
 }
@@ -316,26 +731,71 @@ static void virtio_net_uninitialize(ddf_dev_t *dev)
 	nic_t *nic = ddf_dev_data_get(dev);
 	virtio_net_t *virtio_net = (virtio_net_t *) nic_get_specific(nic);
 
-	virtio_teardown_dma_bufs(virtio_net->rx_buf);
-	virtio_teardown_dma_bufs(virtio_net->tx_buf);
-	virtio_teardown_dma_bufs(virtio_net->ct_buf);
+	virtio_net_bufs_teardown(virtio_net);
 
 	virtio_device_setup_fail(&virtio_net->virtio_dev);
+	virtio_pci_msi_free(dev, &virtio_net->virtio_dev);
 	virtio_pci_dev_cleanup(&virtio_net->virtio_dev);
 }
 
-static void virtio_net_send(nic_t *nic, void *data, size_t size)
+/** Choose the TX virtqueue pair for a frame.
+ *
+ * Frames of one IPv4 flow always hash to the same pair so that they leave
+ * in order. Everything else goes out through the first pair.
+ */
+static unsigned virtio_net_tx_pair(virtio_net_t *virtio_net, const void *data,
+    size_t size)
+{
+	const uint8_t *frame = data;
+
+	if (virtio_net->tx_pairs <= 1)
+		return 0;
+
+	/* Ethernet header, IPv4 header without options */
+	if (size < 14 + 20 || frame[12] != 0x08 || frame[13] != 0x00)
+		return 0;
+
+	const uint8_t *ip = &frame[14];
+	size_t ihl = (ip[0] & 0x0f) * 4;
+	uint32_t hash = 0;
+
+	/* Source and destination addresses */
+	for (unsigned i = 12; i < 20; i++)
+		hash = hash * 31 + ip[i];
+
+	/* Ports of unfragmented TCP and UDP packets */
+	bool frag = ((ip[6] & 0x3f) | ip[7]) != 0;
+	if ((ip[9] == 6 || ip[9] == 17) && !frag && ihl >= 20 &&
+	    size >= 14 + ihl + 4) {
+		for (unsigned i = 0; i < 4; i++)
+			hash = hash * 31 + ip[ihl + i];
+	}
+
+	hash ^= hash >> 16;
+	return hash % virtio_net->tx_pairs;
+}
+
+/** Send frame, letting the device perform offload computations.
+ *
+ * @param nic     NIC
+ * @param data    Frame data
+ * @param size    Frame size in bytes
+ * @param offload Offload computations or NULL
+ */
+static void virtio_net_send_common(nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
 {
 	virtio_net_t *virtio_net = nic_get_specific(nic);
 	virtio_dev_t *vdev = &virtio_net->virtio_dev;
 
-	if (size > sizeof(virtio_net) + TX_BUF_SIZE) {
+	if (sizeof(virtio_net_hdr_t) + size > virtio_net->tx_buf_size) {
 		ddf_msg(LVL_WARN, "TX data too big, frame dropped");
 		return;
 	}
 
-	uint16_t descno = virtio_alloc_desc(vdev, TX_QUEUE_1,
-	    &virtio_net->tx_free_head);
+	unsigned pair = virtio_net_tx_pair(virtio_net, data, size);
+	uint16_t descno = virtio_alloc_desc(vdev, TX_QUEUE(pair),
+	    &virtio_net->tx_free_head[pair]);
 	if (descno == (uint16_t) -1U) {
 		ddf_msg(LVL_WARN, "No TX buffers available, frame dropped");
 		return;
@@ -343,20 +803,49 @@ static void virtio_net_send(nic_t *nic, void *data, size_t size)
 	assert(descno < TX_BUFFERS);
 
 	/* Setup the packet header */
-	virtio_net_hdr_t *hdr = (virtio_net_hdr_t *) virtio_net->tx_buf[descno];
+	virtio_net_hdr_t *hdr =
+	    (virtio_net_hdr_t *) virtio_net->tx_buf[pair][descno];
 	memset(hdr, 0, sizeof(virtio_net_hdr_t));
 	hdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
 	hdr->num_buffers = 0;
 
+	if (offload != NULL && offload->flags != 0) {
+		hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		hdr->csum_start = host2uint16_t_le(offload->csum_start);
+		hdr->csum_offset = host2uint16_t_le(offload->csum_offs);
+	}
+
+	if (offload != NULL && (offload->flags & NIC_OFFLOAD_TSO) != 0 &&
+	    offload->csum_start + 13u <= size) {
+		/* Headers are replicated in every segment */
+		uint8_t *tcp = (uint8_t *) data + offload->csum_start;
+		hdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		hdr->gso_size = host2uint16_t_le(offload->mss);
+		hdr->hdr_len = host2uint16_t_le(offload->csum_start +
+		    4 * (tcp[12] >> 4));
+	}
+
 	/* Copy packet data into the buffer just past the header */
 	memcpy(&hdr[1], data, size);
 
 	/*
 	 * Set the descriptor, put it into the virtqueue and notify the device
 	 */
-	virtio_virtq_desc_set(vdev, TX_QUEUE_1, descno,
-	    virtio_net->tx_buf_p[descno], sizeof(virtio_net_hdr_t) + size, 0, 0);
-	virtio_virtq_produce_available(vdev, TX_QUEUE_1, descno);
+	virtio_virtq_desc_set(vdev, TX_QUEUE(pair), descno,
+	    virtio_net->tx_buf_p[pair][descno],
+	    sizeof(virtio_net_hdr_t) + size, 0, 0);
+	virtio_virtq_produce_available(vdev, TX_QUEUE(pair), descno);
+}
+
+static void virtio_net_send(nic_t *nic, void *data, size_t size)
+{
+	virtio_net_send_common(nic, data, size, NULL);
+}
+
+static void virtio_net_send_offload(nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	virtio_net_send_common(nic, data, size, offload);
 }
 
 static errno_t virtio_net_on_multicast_mode_change(nic_t *nic,
@@ -411,6 +900,9 @@ static errno_t virtio_net_dev_add(ddf_dev_t *dev)
 	ddf_fun_set_ops(fun, &virtio_net_dev_ops);
 
 	nic_set_send_frame_handler(nic, virtio_net_send);
+	virtio_net_t *virtio_net = nic_get_specific(nic);
+	nic_set_offload_handler(nic, virtio_net->offload,
+	    virtio_net_send_offload);
 	nic_set_filtering_change_handlers(nic, NULL,
 	    virtio_net_on_multicast_mode_change,
 	    virtio_net_on_broadcast_mode_change, NULL, NULL);
@@ -32,21 +32,50 @@
 #include <virtio-pci.h>
 #include <abi/cap.h>
 #include <nic/nic.h>
+#include <fibril_synch.h>
+#include <stdbool.h>
 
-#define RX_BUFFERS	8
+#define RX_BUFFERS	128
 #define TX_BUFFERS	8
 #define CT_BUFFERS	4
 
+/** Maximum number of RX/TX virtqueue pairs used. */
+#define VIRTIO_NET_MAX_PAIRS	4
+
 /** Device handles packets with partial checksum. */
 #define VIRTIO_NET_F_CSUM		(1U << 0)
 /** Driver handles packets with partial checksum. */
-#define VIRTIO_NET_F_GUEST_CSUM		(1U << 2)
+#define VIRTIO_NET_F_GUEST_CSUM		(1U << 1)
 /** Device has given MAC address. */
 #define VIRTIO_NET_F_MAC		(1U << 5)
+/** Driver can receive TSOv4 (large coalesced TCP segments). */
+#define VIRTIO_NET_F_GUEST_TSO4		(1U << 7)
+/** Device can receive TSOv4. */
+#define VIRTIO_NET_F_HOST_TSO4		(1U << 11)
+/** Driver can merge receive buffers. */
+#define VIRTIO_NET_F_MRG_RXBUF		(1U << 15)
 /** Control channel is available */
 #define VIRTIO_NET_F_CTRL_VQ		(1U << 17)
+/** Device supports multiple RX/TX virtqueue pairs. */
+#define VIRTIO_NET_F_MQ			(1U << 22)
+
+/** Control command class for multiqueue configuration. */
+#define VIRTIO_NET_CTRL_MQ		4
+/** Set the number of RX/TX virtqueue pairs in use. */
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET	0
+
+/** Control command acknowledgements */
+#define VIRTIO_NET_OK	0
+#define VIRTIO_NET_ERR	1
+
+/** Packet has partial checksum starting at csum_start */
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM	1
+/** Checksum of the packet has been validated */
+#define VIRTIO_NET_HDR_F_DATA_VALID	2
+
+#define VIRTIO_NET_HDR_GSO_NONE		0
+#define VIRTIO_NET_HDR_GSO_TCPV4	1
 
-#define VIRTIO_NET_HDR_GSO_NONE 0
 typedef struct {
 	uint8_t flags;
 	uint8_t gso_type;
@@ -59,20 +88,49 @@ typedef struct {
 
 typedef struct {
 	uint8_t mac[ETH_ADDR];
+	uint16_t status;
+	uint16_t max_virtqueue_pairs;
 } virtio_net_cfg_t;
 
+/** Control command header and data of VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET */
+typedef struct {
+	uint8_t class;
+	uint8_t command;
+	uint16_t virtqueue_pairs;
+} virtio_net_ctrl_mq_t;
+
 typedef struct {
 	virtio_dev_t virtio_dev;
-	void *rx_buf[RX_BUFFERS];
-	uintptr_t rx_buf_p[RX_BUFFERS];
-	void *tx_buf[TX_BUFFERS];
-	uintptr_t tx_buf_p[TX_BUFFERS];
+	void *rx_buf[VIRTIO_NET_MAX_PAIRS][RX_BUFFERS];
+	uintptr_t rx_buf_p[VIRTIO_NET_MAX_PAIRS][RX_BUFFERS];
+	void *tx_buf[VIRTIO_NET_MAX_PAIRS][TX_BUFFERS];
+	uintptr_t tx_buf_p[VIRTIO_NET_MAX_PAIRS][TX_BUFFERS];
 	void *ct_buf[CT_BUFFERS];
 	uintptr_t ct_buf_p[CT_BUFFERS];
 
-	uint16_t tx_free_head;
+	uint16_t tx_free_head[VIRTIO_NET_MAX_PAIRS];
+	/** Size of each TX buffer (larger with segmentation offload) */
+	size_t tx_buf_size;
+	/** Offload computations supported by the device (NIC_OFFLOAD_*) */
+	uint32_t offload;
+	/** Received frames may span several buffers */
+	bool mrg_rxbuf;
 	uint16_t ct_free_head;
 
+	/** Number of RX/TX virtqueue pairs set up */
+	unsigned npairs;
+	/** Number of pairs the device was told to use for transmitting */
+	unsigned tx_pairs;
+	/** Index of the control virtqueue */
+	uint16_t ct_queue;
+	/** Pair the next NAPI poll starts receiving from */
+	unsigned rx_pair;
+
+	/** Synchronizes control commands with their completion */
+	fibril_mutex_t ct_lock;
+	fibril_condvar_t ct_cv;
+	bool ct_done;
+
 	int irq;
 	cap_irq_handle_t irq_handle;
 } virtio_net_t;
@@ -246,6 +246,8 @@ static const bithenge_expression_ops_t binary_expression_ops = {
 	.destroy = binary_expression_destroy,
 };
 
+static void binary_expression_compile(bithenge_expression_t **);
+
 /** Create a binary expression. Takes ownership of @a a and @a b.
  * @param[out] out Holds the new expression.
  * @param op The operator to apply.
@@ -273,6 +275,7 @@ errno_t bithenge_binary_expression(bithenge_expression_t **out,
 	self->a = a;
 	self->b = b;
 	*out = binary_as_expression(self);
+	binary_expression_compile(out);
 	return EOK;
 
 error:
@@ -487,6 +490,349 @@ error:
 	return rc;
 }
 
+/*
+ * compiled_expression
+ *
+ * Trees of arithmetic, comparison and logical operators are compiled into
+ * code for a small stack machine, which evaluates them without creating a
+ * node for each intermediate result. Trees without any other operands are
+ * evaluated right away and replaced by a constant.
+ */
+
+/** Maximum stack depth of a compiled expression. */
+#define COMPILED_MAX_DEPTH 16
+
+typedef enum {
+	/** Push a constant. */
+	COMPILED_CONST,
+	/** Evaluate an expression and push its value. */
+	COMPILED_EVALUATE,
+	/** Replace the two topmost values by the result of an operator. */
+	COMPILED_BINARY,
+} compiled_opcode_t;
+
+/** An integer or boolean value on the stack. */
+typedef struct {
+	bool is_bool;
+	bithenge_int_t value;
+} compiled_value_t;
+
+typedef struct {
+	compiled_opcode_t opcode;
+	union {
+		compiled_value_t value;
+		bithenge_expression_t *expr;
+		bithenge_binary_op_t op;
+	};
+} compiled_insn_t;
+
+typedef struct {
+	bithenge_expression_t base;
+	/** The original tree, evaluated instead if an operand has another
+	 * type than integer or boolean. */
+	bithenge_expression_t *tree;
+	compiled_insn_t *code;
+	size_t code_len;
+	size_t depth;
+} compiled_expression_t;
+
+static inline compiled_expression_t *expression_as_compiled(
+    bithenge_expression_t *base)
+{
+	return (compiled_expression_t *)base;
+}
+
+static inline bithenge_expression_t *compiled_as_expression(
+    compiled_expression_t *self)
+{
+	return &self->base;
+}
+
+/** Apply a binary operator the same way as binary_expression_evaluate.
+ * @param op The operator.
+ * @param[in,out] a The first operand, replaced by the result.
+ * @param b The second operand.
+ * @return EOK on success or an error code from errno.h. */
+static errno_t compiled_binary(bithenge_binary_op_t op, compiled_value_t *a,
+    const compiled_value_t *b)
+{
+	switch (op) {
+	case BITHENGE_EXPRESSION_ADD: /* fallthrough */
+	case BITHENGE_EXPRESSION_SUBTRACT: /* fallthrough */
+	case BITHENGE_EXPRESSION_MULTIPLY: /* fallthrough */
+	case BITHENGE_EXPRESSION_INTEGER_DIVIDE: /* fallthrough */
+	case BITHENGE_EXPRESSION_MODULO: /* fallthrough */
+	case BITHENGE_EXPRESSION_LESS_THAN: /* fallthrough */
+	case BITHENGE_EXPRESSION_LESS_THAN_OR_EQUAL: /* fallthrough */
+	case BITHENGE_EXPRESSION_GREATER_THAN: /* fallthrough */
+	case BITHENGE_EXPRESSION_GREATER_THAN_OR_EQUAL:
+		if (a->is_bool || b->is_bool)
+			return EINVAL;
+		break;
+	case BITHENGE_EXPRESSION_AND: /* fallthrough */
+	case BITHENGE_EXPRESSION_OR:
+		if (!a->is_bool || !b->is_bool)
+			return EINVAL;
+		break;
+	default:
+		break;
+	}
+
+	bithenge_int_t a_int = a->value, b_int = b->value;
+	switch (op) {
+	case BITHENGE_EXPRESSION_ADD:
+		a->value = a_int + b_int;
+		break;
+	case BITHENGE_EXPRESSION_SUBTRACT:
+		a->value = a_int - b_int;
+		break;
+	case BITHENGE_EXPRESSION_MULTIPLY:
+		a->value = a_int * b_int;
+		break;
+	case BITHENGE_EXPRESSION_INTEGER_DIVIDE:
+		if (b_int <= 0)
+			return EINVAL;
+		a->value = (a_int / b_int) + (a_int % b_int < 0 ? -1 : 0);
+		break;
+	case BITHENGE_EXPRESSION_MODULO:
+		if (b_int <= 0)
+			return EINVAL;
+		a->value = (a_int % b_int) + (a_int % b_int < 0 ? b_int : 0);
+		break;
+	case BITHENGE_EXPRESSION_LESS_THAN:
+		a->value = a_int < b_int;
+		break;
+	case BITHENGE_EXPRESSION_LESS_THAN_OR_EQUAL:
+		a->value = a_int <= b_int;
+		break;
+	case BITHENGE_EXPRESSION_GREATER_THAN:
+		a->value = a_int > b_int;
+		break;
+	case BITHENGE_EXPRESSION_GREATER_THAN_OR_EQUAL:
+		a->value = a_int >= b_int;
+		break;
+	case BITHENGE_EXPRESSION_EQUALS:
+		a->value = a->is_bool == b->is_bool && a_int == b_int;
+		break;
+	case BITHENGE_EXPRESSION_NOT_EQUALS:
+		a->value = a->is_bool != b->is_bool || a_int != b_int;
+		break;
+	case BITHENGE_EXPRESSION_AND:
+		a->value = a_int && b_int;
+		break;
+	case BITHENGE_EXPRESSION_OR:
+		a->value = a_int || b_int;
+		break;
+	default:
+		assert(false);
+		return EINVAL;
+	}
+
+	switch (op) {
+	case BITHENGE_EXPRESSION_ADD: /* fallthrough */
+	case BITHENGE_EXPRESSION_SUBTRACT: /* fallthrough */
+	case BITHENGE_EXPRESSION_MULTIPLY: /* fallthrough */
+	case BITHENGE_EXPRESSION_INTEGER_DIVIDE: /* fallthrough */
+	case BITHENGE_EXPRESSION_MODULO:
+		a->is_bool = false;
+		break;
+	default:
+		a->is_bool = true;
+		break;
+	}
+	return EOK;
+}
+
+/** Get an integer or boolean value of a node.
+ * @return True if the node has one of these types. */
+static bool compiled_value(compiled_value_t *out, bithenge_node_t *node)
+{
+	switch (bithenge_node_type(node)) {
+	case BITHENGE_NODE_INTEGER:
+		out->is_bool = false;
+		out->value = bithenge_integer_node_value(node);
+		return true;
+	case BITHENGE_NODE_BOOLEAN:
+		out->is_bool = true;
+		out->value = bithenge_boolean_node_value(node);
+		return true;
+	default:
+		return false;
+	}
+}
+
+static errno_t compiled_expression_evaluate(bithenge_expression_t *base,
+    bithenge_scope_t *scope, bithenge_node_t **out)
+{
+	compiled_expression_t *self = expression_as_compiled(base);
+	compiled_value_t stack[COMPILED_MAX_DEPTH];
+	size_t sp = 0;
+	errno_t rc;
+
+	for (size_t i = 0; i < self->code_len; i++) {
+		compiled_insn_t *insn = &self->code[i];
+		bithenge_node_t *node;
+		bool valid;
+
+		switch (insn->opcode) {
+		case COMPILED_CONST:
+			stack[sp++] = insn->value;
+			break;
+		case COMPILED_EVALUATE:
+			rc = bithenge_expression_evaluate(insn->expr, scope,
+			    &node);
+			if (rc != EOK)
+				return rc;
+			valid = compiled_value(&stack[sp], node);
+			bithenge_node_dec_ref(node);
+			if (!valid) {
+				return bithenge_expression_evaluate(self->tree,
+				    scope, out);
+			}
+			sp++;
+			break;
+		case COMPILED_BINARY:
+			sp--;
+			rc = compiled_binary(insn->op, &stack[sp - 1],
+			    &stack[sp]);
+			if (rc != EOK)
+				return rc;
+			break;
+		}
+	}
+
+	assert(sp == 1);
+	if (stack[0].is_bool)
+		return bithenge_new_boolean_node(out, stack[0].value);
+	return bithenge_new_integer_node(out, stack[0].value);
+}
+
+static void compiled_expression_destroy(bithenge_expression_t *base)
+{
+	compiled_expression_t *self = expression_as_compiled(base);
+	for (size_t i = 0; i < self->code_len; i++) {
+		if (self->code[i].opcode == COMPILED_EVALUATE)
+			bithenge_expression_dec_ref(self->code[i].expr);
+	}
+	bithenge_expression_dec_ref(self->tree);
+	free(self->code);
+	free(self);
+}
+
+static const bithenge_expression_ops_t compiled_expression_ops = {
+	.evaluate = compiled_expression_evaluate,
+	.destroy = compiled_expression_destroy,
+};
+
+/** Get the code length and stack depth needed for an operand. */
+static void compiled_operand_size(bithenge_expression_t *expr, size_t *len,
+    size_t *depth)
+{
+	if (expr->ops == &compiled_expression_ops) {
+		*len = expression_as_compiled(expr)->code_len;
+		*depth = expression_as_compiled(expr)->depth;
+	} else {
+		*len = 1;
+		*depth = 1;
+	}
+}
+
+/** Append code computing an operand.
+ * @return True if the code evaluates another expression. */
+static bool compiled_emit_operand(compiled_expression_t *self,
+    bithenge_expression_t *expr)
+{
+	bool evaluates = false;
+
+	if (expr->ops == &compiled_expression_ops) {
+		compiled_expression_t *other = expression_as_compiled(expr);
+		for (size_t i = 0; i < other->code_len; i++) {
+			compiled_insn_t *insn = &other->code[i];
+			if (insn->opcode == COMPILED_EVALUATE) {
+				bithenge_expression_inc_ref(insn->expr);
+				evaluates = true;
+			}
+			self->code[self->code_len++] = *insn;
+		}
+		return evaluates;
+	}
+
+	compiled_insn_t *insn = &self->code[self->code_len++];
+	if (expr->ops == &const_expression_ops &&
+	    compiled_value(&insn->value, expression_as_const(expr)->node)) {
+		insn->opcode = COMPILED_CONST;
+		return false;
+	}
+
+	insn->opcode = COMPILED_EVALUATE;
+	insn->expr = expr;
+	bithenge_expression_inc_ref(expr);
+	return true;
+}
+
+/** Compile a binary expression, if possible. The expression is replaced by
+ * the compiled expression or a constant; it is left alone if it cannot be
+ * compiled.
+ * @param[in,out] expr The binary expression. */
+static void binary_expression_compile(bithenge_expression_t **expr)
+{
+	binary_expression_t *tree = expression_as_binary(*expr);
+
+	switch (tree->op) {
+	case BITHENGE_EXPRESSION_MEMBER: /* fallthrough */
+	case BITHENGE_EXPRESSION_CONCAT: /* fallthrough */
+	case BITHENGE_EXPRESSION_INVALID_BINARY_OP:
+		return;
+	default:
+		break;
+	}
+
+	size_t len_a, depth_a, len_b, depth_b;
+	compiled_operand_size(tree->a, &len_a, &depth_a);
+	compiled_operand_size(tree->b, &len_b, &depth_b);
+	size_t depth = max(depth_a, depth_b + 1);
+	if (depth > COMPILED_MAX_DEPTH)
+		return;
+
+	compiled_expression_t *self = malloc(sizeof(*self));
+	if (!self)
+		return;
+	self->code = malloc((len_a + len_b + 1) * sizeof(*self->code));
+	if (!self->code) {
+		free(self);
+		return;
+	}
+	if (bithenge_init_expression(compiled_as_expression(self),
+	    &compiled_expression_ops) != EOK) {
+		free(self->code);
+		free(self);
+		return;
+	}
+
+	self->code_len = 0;
+	bool evaluates = compiled_emit_operand(self, tree->a);
+	evaluates |= compiled_emit_operand(self, tree->b);
+	compiled_insn_t *insn = &self->code[self->code_len++];
+	insn->opcode = COMPILED_BINARY;
+	insn->op = tree->op;
+	self->depth = depth;
+	self->tree = *expr;
+	*expr = compiled_as_expression(self);
+
+	if (evaluates)
+		return;
+
+	/* All operands are constants, so the result is constant too. */
+	bithenge_node_t *node;
+	if (compiled_expression_evaluate(*expr, NULL, &node) != EOK)
+		return;
+	bithenge_expression_t *constant;
+	if (bithenge_const_expression(&constant, node) != EOK)
+		return;
+	bithenge_expression_dec_ref(*expr);
+	*expr = constant;
+}
+
 /*
  * scope_member_expression
  */
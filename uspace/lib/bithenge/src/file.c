@@ -45,11 +45,21 @@
 #include <bithenge/blob.h>
 #include <bithenge/file.h>
 
+/** Size of the part of the file kept in memory. */
+#define FILE_WINDOW_SIZE  (64 * 1024)
+
+/** Alignment of the window start, so that slightly earlier data is kept. */
+#define FILE_WINDOW_ALIGN  4096
+
 typedef struct {
 	bithenge_blob_t base;
 	int fd;
 	aoff64_t size; // needed by file_read()
 	bool needs_close;
+	/** Data of the file starting at @a window_start. */
+	char *window;
+	aoff64_t window_start;
+	size_t window_size;
 } file_blob_t;
 
 static inline file_blob_t *blob_as_file(bithenge_blob_t *base)
@@ -75,12 +85,39 @@ static errno_t file_read(bithenge_blob_t *base, aoff64_t offset, char *buffer,
 	file_blob_t *blob = blob_as_file(base);
 	if (offset > blob->size)
 		return ELIMIT;
+	*size = min(*size, blob->size - offset);
 
 	size_t amount_read;
-	errno_t rc = vfs_read(blob->fd, &offset, buffer, *size, &amount_read);
-	if (rc != EOK)
-		return errno;
-	*size += amount_read;
+	errno_t rc;
+
+	/* Large reads bypass the window. */
+	if (*size >= FILE_WINDOW_SIZE) {
+		rc = vfs_read(blob->fd, &offset, buffer, *size, &amount_read);
+		if (rc != EOK)
+			return rc;
+		*size = amount_read;
+		return EOK;
+	}
+
+	if (offset < blob->window_start ||
+	    offset + *size > blob->window_start + blob->window_size) {
+		aoff64_t start = offset - offset % FILE_WINDOW_ALIGN;
+		if (offset + *size > start + FILE_WINDOW_SIZE)
+			start = offset;
+
+		aoff64_t pos = start;
+		rc = vfs_read(blob->fd, &pos, blob->window, FILE_WINDOW_SIZE,
+		    &amount_read);
+		if (rc != EOK) {
+			blob->window_size = 0;
+			return rc;
+		}
+		blob->window_start = start;
+		blob->window_size = amount_read;
+	}
+
+	*size = min(*size, blob->window_start + blob->window_size - offset);
+	memcpy(buffer, blob->window + (offset - blob->window_start), *size);
 	return EOK;
 }
 
@@ -88,6 +125,7 @@ static void file_destroy(bithenge_blob_t *base)
 {
 	file_blob_t *blob = blob_as_file(base);
 	vfs_put(blob->fd);
+	free(blob->window);
 	free(blob);
 }
 
@@ -116,14 +154,24 @@ static errno_t new_file_blob(bithenge_node_t **out, int fd, bool needs_close)
 			vfs_put(fd);
 		return ENOMEM;
 	}
+	blob->window = malloc(FILE_WINDOW_SIZE);
+	if (!blob->window) {
+		free(blob);
+		if (needs_close)
+			vfs_put(fd);
+		return ENOMEM;
+	}
 	rc = bithenge_init_random_access_blob(file_as_blob(blob), &file_ops);
 	if (rc != EOK) {
+		free(blob->window);
 		free(blob);
 		if (needs_close)
 			vfs_put(fd);
 		return rc;
 	}
 	blob->fd = fd;
+	blob->window_start = 0;
+	blob->window_size = 0;
 #ifdef __HELENOS__
 	blob->size = stat.size;
 #else
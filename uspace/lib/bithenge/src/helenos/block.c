@@ -40,14 +40,22 @@
 #include <errno.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <bithenge/blob.h>
 #include "block.h"
 
+/** Size of the part of the device kept in memory. */
+#define BLOCK_WINDOW_SIZE  (64 * 1024)
+
 typedef struct {
 	bithenge_blob_t base;
 	service_id_t service_id;
 	aoff64_t size;
+	/** Data of the device starting at @a window_start. */
+	char *window;
+	aoff64_t window_start;
+	size_t window_size;
 } block_blob_t;
 
 static inline block_blob_t *blob_as_block(bithenge_blob_t *base)
@@ -74,13 +82,36 @@ static errno_t block_read(bithenge_blob_t *base, aoff64_t offset, char *buffer,
 	if (offset > self->size)
 		return ELIMIT;
 	*size = min(*size, self->size - offset);
-	return block_read_bytes_direct(self->service_id, offset, *size, buffer);
+
+	/* Large reads bypass the window. */
+	if (*size >= BLOCK_WINDOW_SIZE) {
+		return block_read_bytes_direct(self->service_id, offset, *size,
+		    buffer);
+	}
+
+	if (offset < self->window_start ||
+	    offset + *size > self->window_start + self->window_size) {
+		aoff64_t start = offset;
+		size_t window_size = min(BLOCK_WINDOW_SIZE, self->size - start);
+		errno_t rc = block_read_bytes_direct(self->service_id, start,
+		    window_size, self->window);
+		if (rc != EOK) {
+			self->window_size = 0;
+			return rc;
+		}
+		self->window_start = start;
+		self->window_size = window_size;
+	}
+
+	memcpy(buffer, self->window + (offset - self->window_start), *size);
+	return EOK;
 }
 
 static void block_destroy(bithenge_blob_t *base)
 {
 	block_blob_t *self = blob_as_block(base);
 	block_fini(self->service_id);
+	free(self->window);
 	free(self);
 }
 
@@ -128,15 +159,24 @@ errno_t bithenge_new_block_blob(bithenge_node_t **out, service_id_t service_id)
 		block_fini(service_id);
 		return ENOMEM;
 	}
+	blob->window = malloc(BLOCK_WINDOW_SIZE);
+	if (!blob->window) {
+		free(blob);
+		block_fini(service_id);
+		return ENOMEM;
+	}
 	rc = bithenge_init_random_access_blob(block_as_blob(blob),
 	    &block_ops);
 	if (rc != EOK) {
+		free(blob->window);
 		free(blob);
 		block_fini(service_id);
 		return rc;
 	}
 	blob->service_id = service_id;
 	blob->size = size;
+	blob->window_start = 0;
+	blob->window_size = 0;
 	*out = bithenge_blob_as_node(block_as_blob(blob));
 
 	return EOK;
@@ -54,6 +54,9 @@ typedef struct {
 	size_t num_ends;
 	bool end_on_empty;
 	bithenge_int_t num_xforms;
+	/** Decoded values of the fields, or NULL if they are not cached. */
+	bithenge_node_t **values;
+	bithenge_int_t num_values;
 } seq_node_t;
 
 typedef struct seq_node_ops {
@@ -135,7 +138,7 @@ static errno_t seq_node_field_offset(seq_node_t *self, aoff64_t *out, size_t ind
 	return EOK;
 }
 
-static errno_t seq_node_subtransform(seq_node_t *self, bithenge_node_t **out,
+static errno_t seq_node_decode(seq_node_t *self, bithenge_node_t **out,
     size_t index)
 {
 	aoff64_t start_pos;
@@ -221,6 +224,35 @@ static errno_t seq_node_subtransform(seq_node_t *self, bithenge_node_t **out,
 	return EOK;
 }
 
+/** Get the value of a field, decoding it only the first time if the values
+ * are cached. Only simple values are cached; internal and blob nodes may
+ * refer to the scope of this node, which would make a reference cycle. */
+static errno_t seq_node_subtransform(seq_node_t *self, bithenge_node_t **out,
+    size_t index)
+{
+	if (self->values && self->values[index]) {
+		bithenge_node_inc_ref(self->values[index]);
+		*out = self->values[index];
+		return EOK;
+	}
+
+	errno_t rc = seq_node_decode(self, out, index);
+	if (rc != EOK || !self->values)
+		return rc;
+
+	switch (bithenge_node_type(*out)) {
+	case BITHENGE_NODE_BOOLEAN:
+	case BITHENGE_NODE_INTEGER:
+	case BITHENGE_NODE_STRING:
+		bithenge_node_inc_ref(*out);
+		self->values[index] = *out;
+		break;
+	default:
+		break;
+	}
+	return EOK;
+}
+
 static errno_t seq_node_complete(seq_node_t *self, bool *out)
 {
 	aoff64_t blob_size, end_pos;
@@ -239,6 +271,23 @@ static void seq_node_destroy(seq_node_t *self)
 	bithenge_scope_dec_ref(self->scope);
 	bithenge_blob_dec_ref(self->blob);
 	free(self->ends);
+	if (self->values) {
+		for (bithenge_int_t i = 0; i < self->num_values; i++)
+			bithenge_node_dec_ref(self->values[i]);
+		free(self->values);
+	}
+}
+
+/** Cache the decoded values of the fields. Only possible if the number of
+ * fields is known. */
+static errno_t seq_node_cache_values(seq_node_t *self)
+{
+	assert(self->num_xforms != -1);
+	self->values = calloc(max(self->num_xforms, 1), sizeof(*self->values));
+	if (!self->values)
+		return ENOMEM;
+	self->num_values = self->num_xforms;
+	return EOK;
 }
 
 static void seq_node_set_num_xforms(seq_node_t *self,
@@ -257,6 +306,8 @@ static errno_t seq_node_init(seq_node_t *self, const seq_node_ops_t *ops,
     bool end_on_empty)
 {
 	self->ops = ops;
+	self->values = NULL;
+	self->num_values = 0;
 	if (num_xforms != -1) {
 		self->ends = malloc(sizeof(*self->ends) * num_xforms);
 		if (!self->ends)
@@ -506,6 +557,15 @@ static errno_t struct_transform_make_node(struct_transform_t *self,
 		return rc;
 	}
 
+	/* Fields are looked up by name repeatedly, e.g. by expressions. */
+	rc = seq_node_cache_values(struct_as_seq(node));
+	if (rc != EOK) {
+		seq_node_destroy(struct_as_seq(node));
+		bithenge_scope_dec_ref(inner);
+		free(node);
+		return rc;
+	}
+
 	bithenge_transform_inc_ref(struct_as_transform(self));
 	node->transform = self;
 	node->prefix = prefix;
@@ -40,6 +40,7 @@
 #include <ipc/services.h>
 #include <errno.h>
 #include <async.h>
+#include <align.h>
 #include <as.h>
 #include <assert.h>
 #include <bd.h>
@@ -53,25 +54,89 @@
 #include <stacktrace.h>
 #include <str_error.h>
 #include <offset.h>
+#include <stdatomic.h>
+#include <qsort.h>
+#include <time.h>
 #include <inttypes.h>
 #include "block.h"
 
 #define MAX_WRITE_RETRIES 10
 
+#define CACHE_LO_WATERMARK	10
+#define CACHE_HI_WATERMARK	20
+
+/** Number of lock-striped shards of a block cache. */
+#define CACHE_SHARDS		8
+
+/** Maximum size of a single device transfer, one IPC data transfer. */
+#define XFER_MAX_BYTES		(64 * 1024)
+
+/** Initial readahead window in blocks. */
+#define READAHEAD_MIN		4
+/** Maximum number of readahead fibrils per device. */
+#define READAHEAD_MAX_PENDING	2
+
+/** Default age of dirty blocks written back by the flusher. */
+#define FLUSH_AGE_DEFAULT	SEC2USEC(5)
+/** Period of the flusher. */
+#define FLUSH_INTERVAL		SEC2USEC(1)
+/** Maximum number of blocks the flusher handles at once. */
+#define FLUSH_BATCH		64
+/** Percentage of dirty cached blocks at which writers are throttled. */
+#define DIRTY_RATIO		50
+/** Number of dirty blocks which is never throttled. */
+#define DIRTY_MIN		CACHE_LO_WATERMARK
+
 /** Lock protecting the device connection list */
-static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
+static FIBRIL_RWLOCK_INITIALIZE(dcl_lock);
 /** Device connection list head. */
 static LIST_INITIALIZE(dcl);
+/** Memory pressure notifications have been subscribed. */
+static bool mem_pressure_subscribed = false;
 
+/** Part of a block cache protected by one lock. */
 typedef struct {
 	fibril_mutex_t lock;
+	/** Signalled when a block of the shard stops being busy. */
+	fibril_condvar_t busy_cv;
+	hash_table_t block_hash;
+	/** Clock of all blocks in the shard, the hand is at the front. */
+	list_t clock;
+	unsigned blocks;          /**< Number of blocks in the shard. */
+} cache_shard_t;
+
+typedef struct {
 	size_t lblock_size;       /**< Logical block size. */
 	unsigned blocks_cluster;  /**< Physical blocks per block_t */
 	unsigned block_count;     /**< Total number of blocks. */
-	unsigned blocks_cached;   /**< Number of cached blocks. */
-	hash_table_t block_hash;
-	list_t free_list;
+	atomic_uint blocks_cached; /**< Number of cached blocks. */
+	atomic_uint blocks_dirty; /**< Number of blocks awaiting write-back. */
 	enum cache_mode mode;
+	/** Block data points into the device mapping instead of own buffers. */
+	bool mapped;
+	/** Shards selected by the logical block address. */
+	cache_shard_t shards[CACHE_SHARDS];
+	fibril_mutex_t ra_lock;   /**< Lock protecting the readahead state. */
+	aoff64_t ra_next;         /**< Next block of the sequential stream. */
+	aoff64_t ra_cand;         /**< Block which would start a new stream. */
+	aoff64_t ra_end;          /**< End of the blocks read ahead so far. */
+	unsigned ra_window;       /**< Current readahead window in blocks. */
+	unsigned ra_max;          /**< Maximum readahead window in blocks. */
+	unsigned ra_pending;      /**< Number of readahead fibrils running. */
+	fibril_condvar_t ra_cv;   /**< Signalled when ra_pending drops. */
+	fibril_mutex_t flush_lock; /**< Lock protecting the flusher state. */
+	fibril_condvar_t flush_cv; /**< Wakes up the flusher. */
+	fibril_condvar_t flush_done_cv; /**< Signalled after each flush. */
+	usec_t flush_age;         /**< Age of blocks written by the flusher. */
+	unsigned flush_gen;       /**< Number of flushes done. */
+	bool flush_urgent;        /**< Flush all dirty blocks right away. */
+	bool flush_running;       /**< The flusher fibril is running. */
+	bool flush_stop;          /**< The flusher fibril should terminate. */
+	atomic_uint_fast64_t hits; /**< Lookups served by a cached block. */
+	atomic_uint_fast64_t misses; /**< Lookups which read the block. */
+	atomic_uint_fast64_t ra_blocks; /**< Blocks read ahead. */
+	atomic_uint_fast64_t ra_used; /**< Blocks read ahead and then used. */
+	atomic_uint_fast64_t ra_wasted; /**< Blocks read ahead but recycled. */
 } cache_t;
 
 typedef struct {
@@ -83,6 +148,8 @@ typedef struct {
 	aoff64_t bb_addr;
 	aoff64_t pblocks;    /**< Number of physical blocks */
 	size_t pblock_size;  /**< Physical block size. */
+	uint8_t *map;        /**< Mapping of the device contents or NULL */
+	size_t map_size;     /**< Size of the mapping */
 	cache_t *cache;
 } devcon_t;
 
@@ -92,16 +159,17 @@ static aoff64_t ba_ltop(devcon_t *, aoff64_t);
 
 static devcon_t *devcon_search(service_id_t service_id)
 {
-	fibril_mutex_lock(&dcl_lock);
+	/* Lookups are far more frequent than changes to the list. */
+	fibril_rwlock_read_lock(&dcl_lock);
 
 	list_foreach(dcl, link, devcon_t, devcon) {
 		if (devcon->service_id == service_id) {
-			fibril_mutex_unlock(&dcl_lock);
+			fibril_rwlock_read_unlock(&dcl_lock);
 			return devcon;
 		}
 	}
 
-	fibril_mutex_unlock(&dcl_lock);
+	fibril_rwlock_read_unlock(&dcl_lock);
 	return NULL;
 }
 
@@ -122,26 +190,57 @@ static errno_t devcon_add(service_id_t service_id, async_sess_t *sess,
 	devcon->bb_addr = 0;
 	devcon->pblock_size = bsize;
 	devcon->pblocks = dev_size;
+	devcon->map = NULL;
+	devcon->map_size = 0;
 	devcon->cache = NULL;
 
-	fibril_mutex_lock(&dcl_lock);
+	fibril_rwlock_write_lock(&dcl_lock);
 	list_foreach(dcl, link, devcon_t, d) {
 		if (d->service_id == service_id) {
-			fibril_mutex_unlock(&dcl_lock);
+			fibril_rwlock_write_unlock(&dcl_lock);
 			free(devcon);
 			return EEXIST;
 		}
 	}
 	list_append(&devcon->link, &dcl);
-	fibril_mutex_unlock(&dcl_lock);
+	fibril_rwlock_write_unlock(&dcl_lock);
 	return EOK;
 }
 
+/** Map the contents of the device if it supports it.
+ *
+ * Devices backed by memory can be accessed directly through the mapping,
+ * saving the copying in the server and over IPC. Cache blocks then point
+ * into the mapping and need no buffers of their own. The mapping is
+ * writable, since for such devices writing to it is the same as writing
+ * the blocks.
+ *
+ * @param devcon Device connection
+ */
+static void devcon_map(devcon_t *devcon)
+{
+	size_t size;
+	void *map;
+
+	if (devcon->pblocks > SIZE_MAX / devcon->pblock_size)
+		return;
+
+	size = ALIGN_UP(devcon->pblocks * devcon->pblock_size, PAGE_SIZE);
+	if (size == 0)
+		return;
+
+	if (bd_map(devcon->bd, AS_AREA_READ | AS_AREA_WRITE, size, &map) != EOK)
+		return;
+
+	devcon->map = map;
+	devcon->map_size = size;
+}
+
 static void devcon_remove(devcon_t *devcon)
 {
-	fibril_mutex_lock(&dcl_lock);
+	fibril_rwlock_write_lock(&dcl_lock);
 	list_remove(&devcon->link);
-	fibril_mutex_unlock(&dcl_lock);
+	fibril_rwlock_write_unlock(&dcl_lock);
 }
 
 errno_t block_init(service_id_t service_id, size_t comm_size)
@@ -183,6 +282,7 @@ errno_t block_init(service_id_t service_id, size_t comm_size)
 		return rc;
 	}
 
+	devcon_map(devcon_search(service_id));
 	return EOK;
 }
 
@@ -201,6 +301,9 @@ void block_fini(service_id_t service_id)
 	if (devcon->bb_buf)
 		free(devcon->bb_buf);
 
+	if (devcon->map != NULL)
+		as_area_destroy(devcon->map);
+
 	bd_close(devcon->bd);
 	async_hangup(devcon->sess);
 
@@ -243,13 +346,13 @@ void *block_bb_get(service_id_t service_id)
 static size_t cache_key_hash(const void *key)
 {
 	const aoff64_t *lba = key;
-	return *lba;
+	return *lba / CACHE_SHARDS;
 }
 
 static size_t cache_hash(const ht_link_t *item)
 {
 	block_t *b = hash_table_get_inst(item, block_t, hash_link);
-	return b->lba;
+	return b->lba / CACHE_SHARDS;
 }
 
 static bool cache_key_equal(const void *key, const ht_link_t *item)
@@ -267,11 +370,546 @@ static hash_table_ops_t cache_ops = {
 	.remove_callback = NULL
 };
 
+/** Get the shard of a cache which holds a block. */
+static cache_shard_t *cache_shard(cache_t *cache, aoff64_t lba)
+{
+	return &cache->shards[lba % CACHE_SHARDS];
+}
+
+/** Check whether a block is in the cache. */
+static bool cache_contains(cache_t *cache, aoff64_t lba)
+{
+	cache_shard_t *shard = cache_shard(cache, lba);
+	bool found;
+
+	fibril_mutex_lock(&shard->lock);
+	found = hash_table_find(&shard->block_hash, &lba) != NULL;
+	fibril_mutex_unlock(&shard->lock);
+
+	return found;
+}
+
+/** Allocate a new block structure and account for it in the cache. */
+static block_t *cache_block_alloc(cache_t *cache)
+{
+	block_t *b = malloc(sizeof(block_t));
+	if (!b)
+		return NULL;
+
+	if (cache->mapped) {
+		b->data = NULL;
+	} else {
+		b->data = malloc(cache->lblock_size);
+		if (!b->data) {
+			free(b);
+			return NULL;
+		}
+	}
+
+	atomic_fetch_add(&cache->blocks_cached, 1);
+	return b;
+}
+
+/** Free a block structure which is not in the cache any more. */
+static void cache_block_free(cache_t *cache, block_t *b)
+{
+	if (b->wb_pending)
+		atomic_fetch_sub(&cache->blocks_dirty, 1);
+	if (!cache->mapped)
+		free(b->data);
+	free(b);
+	atomic_fetch_sub(&cache->blocks_cached, 1);
+}
+
+/** Point a block at its contents in the device mapping.
+ *
+ * Reading such a block costs nothing, read_blocks() notices that the data
+ * is already in place.
+ *
+ * @param devcon	Device connection.
+ * @param b		Block with the physical address set.
+ */
+static void cache_block_map(devcon_t *devcon, block_t *b)
+{
+	if (devcon->cache->mapped)
+		b->data = devcon->map + b->pba * devcon->pblock_size;
+}
+
+/** Get the current uptime in microseconds. */
+static usec_t cache_uptime(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+/** Account for a dirty block awaiting write-back.
+ *
+ * The clients of the cache mark blocks dirty directly, so this is done
+ * when they release them.
+ *
+ * @param cache		Cache.
+ * @param b		Block, the lock of its shard must be held.
+ */
+static void cache_note_dirty(cache_t *cache, block_t *b)
+{
+	if (b->dirty && !b->wb_pending) {
+		b->wb_pending = true;
+		b->dirty_time = cache_uptime();
+		atomic_fetch_add(&cache->blocks_dirty, 1);
+	}
+}
+
+/** Mark a block clean.
+ *
+ * @param cache		Cache.
+ * @param b		Block, the lock of its shard must be held.
+ */
+static void cache_mark_clean(cache_t *cache, block_t *b)
+{
+	b->dirty = false;
+	if (b->wb_pending) {
+		b->wb_pending = false;
+		atomic_fetch_sub(&cache->blocks_dirty, 1);
+	}
+}
+
+/** Insert a block into a shard, the shard lock must be held. */
+static void cache_block_insert(cache_shard_t *shard, block_t *b)
+{
+	hash_table_insert(&shard->block_hash, &b->hash_link);
+	list_append(&b->clock_link, &shard->clock);
+	shard->blocks++;
+}
+
+/** Remove a block from a shard, the shard lock must be held. */
+static void cache_block_remove(cache_shard_t *shard, block_t *b)
+{
+	hash_table_remove_item(&shard->block_hash, &b->hash_link);
+	list_remove(&b->clock_link);
+	shard->blocks--;
+}
+
+/** Account for a block being recycled or dropped.
+ *
+ * @param cache		Cache.
+ * @param b		Block leaving the cache.
+ */
+static void cache_note_evict(cache_t *cache, block_t *b)
+{
+	if (b->readahead)
+		atomic_fetch_add(&cache->ra_wasted, 1);
+}
+
+/** Wait until there is no I/O in progress on a block.
+ *
+ * @param shard		Shard of the block, its lock must be held.
+ * @param b		Block to wait for.
+ */
+static void cache_wait_idle(cache_shard_t *shard, block_t *b)
+{
+	while (b->busy)
+		fibril_condvar_wait(&shard->busy_cv, &shard->lock);
+}
+
+/** Mark the I/O in progress on a block as finished.
+ *
+ * @param shard		Shard of the block, its lock must be held.
+ * @param b		Block which is not busy any more.
+ */
+static void cache_set_idle(cache_shard_t *shard, block_t *b)
+{
+	b->busy = false;
+	fibril_condvar_broadcast(&shard->busy_cv);
+}
+
+/** Find a block to recycle using the clock algorithm.
+ *
+ * The hand is at the front of the clock. Each block the hand passes is moved
+ * to the back, blocks accessed since the hand passed them last time get a
+ * second chance. Blocks which are referenced or busy are skipped. Blocks
+ * which were read ahead and not used yet are spared while the cache has room
+ * for a readahead window above the high watermark.
+ *
+ * @param cache		Cache.
+ * @param shard		Shard of the cache, its lock must be held.
+ * @param clean		If true, skip dirty blocks.
+ *
+ * @return		Block which is still in the shard or NULL.
+ */
+static block_t *cache_clock_victim(cache_t *cache, cache_shard_t *shard,
+    bool clean)
+{
+	unsigned steps = 2 * shard->blocks;
+	bool spare = atomic_load(&cache->blocks_cached) <
+	    CACHE_HI_WATERMARK + cache->ra_max;
+
+	while (steps-- > 0) {
+		link_t *link = list_first(&shard->clock);
+		block_t *b = list_get_instance(link, block_t, clock_link);
+
+		list_remove(link);
+		list_append(link, &shard->clock);
+
+		if ((b->refcnt > 0) || (b->busy))
+			continue;
+		if (b->accessed) {
+			b->accessed = false;
+			continue;
+		}
+		if (clean && b->dirty)
+			continue;
+		if (spare && b->readahead)
+			continue;
+		return b;
+	}
+
+	return NULL;
+}
+
+/** Compare blocks by their physical address, for qsort(). */
+static int cache_pba_cmp(const void *a, const void *b)
+{
+	const block_t *ba = *(const block_t * const *) a;
+	const block_t *bb = *(const block_t * const *) b;
+
+	if (ba->pba < bb->pba)
+		return -1;
+	return ba->pba > bb->pba ? 1 : 0;
+}
+
+/** Collect dirty blocks for write-back.
+ *
+ * The blocks collected are unreferenced and are made busy, so that nobody
+ * uses or recycles them until they are written. Referenced blocks are left
+ * alone, their users may be modifying them.
+ *
+ * @param cache		Cache.
+ * @param age		Minimum age of the blocks to collect, zero for all.
+ * @param start		First physical block of the range to collect.
+ * @param end		End of the range of physical blocks to collect.
+ * @param batch		Array for FLUSH_BATCH collected blocks.
+ *
+ * @return		Number of blocks collected.
+ */
+static size_t cache_flush_collect(cache_t *cache, usec_t age, aoff64_t start,
+    aoff64_t end, block_t **batch)
+{
+	usec_t now = cache_uptime();
+	size_t n = 0;
+
+	for (unsigned i = 0; i < CACHE_SHARDS && n < FLUSH_BATCH; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		fibril_mutex_lock(&shard->lock);
+		list_foreach(shard->clock, clock_link, block_t, b) {
+			if (n == FLUSH_BATCH)
+				break;
+			if (!b->dirty || b->refcnt > 0 || b->busy || b->toxic)
+				continue;
+			if (b->pba < start || b->pba >= end)
+				continue;
+			if (age > 0 && b->wb_pending &&
+			    now - b->dirty_time < age)
+				continue;
+
+			b->busy = true;
+			batch[n++] = b;
+		}
+		fibril_mutex_unlock(&shard->lock);
+	}
+
+	return n;
+}
+
+/** Write back dirty blocks, clustering contiguous blocks.
+ *
+ * @param devcon	Device connection.
+ * @param cache		Cache of the device.
+ * @param age		Minimum age of the blocks to write, zero for all.
+ * @param start		First physical block of the range to write.
+ * @param end		End of the range of physical blocks to write.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t cache_flush(devcon_t *devcon, cache_t *cache, usec_t age,
+    aoff64_t start, aoff64_t end)
+{
+	size_t max_run = max(XFER_MAX_BYTES / cache->lblock_size, 1);
+	block_t *batch[FLUSH_BATCH];
+	uint8_t *buf = NULL;
+	errno_t rc = EOK;
+	size_t n;
+
+	if (max_run > 1)
+		buf = malloc(max_run * cache->lblock_size);
+
+	do {
+		n = cache_flush_collect(cache, age, start, end, batch);
+		qsort(batch, n, sizeof(block_t *), cache_pba_cmp);
+
+		for (size_t i = 0; i < n; ) {
+			size_t run = 1;
+			errno_t wrc;
+
+			while (buf != NULL && run < max_run && i + run < n &&
+			    batch[i + run]->pba == batch[i + run - 1]->pba +
+			    cache->blocks_cluster)
+				run++;
+
+			if (run == 1) {
+				wrc = write_blocks(devcon, batch[i]->pba,
+				    cache->blocks_cluster, batch[i]->data,
+				    batch[i]->size);
+			} else {
+				for (size_t j = 0; j < run; j++) {
+					memcpy(buf + j * cache->lblock_size,
+					    batch[i + j]->data,
+					    cache->lblock_size);
+				}
+				wrc = write_blocks(devcon, batch[i]->pba,
+				    run * cache->blocks_cluster, buf,
+				    run * cache->lblock_size);
+			}
+
+			for (size_t j = i; j < i + run; j++) {
+				block_t *b = batch[j];
+				cache_shard_t *shard = cache_shard(cache,
+				    b->lba);
+
+				fibril_mutex_lock(&shard->lock);
+				if (wrc == EOK) {
+					b->write_failures = 0;
+					cache_mark_clean(cache, b);
+				} else {
+					b->write_failures++;
+				}
+				cache_set_idle(shard, b);
+				fibril_mutex_unlock(&shard->lock);
+			}
+
+			if (wrc != EOK && rc == EOK)
+				rc = wrc;
+			i += run;
+		}
+
+		/* Failed blocks are still dirty, do not loop over them. */
+	} while (n == FLUSH_BATCH && rc == EOK);
+
+	free(buf);
+	return rc;
+}
+
+/** Wait for write-back in progress on a range of blocks.
+ *
+ * @param cache		Cache.
+ * @param start		First physical block of the range.
+ * @param end		End of the range of physical blocks.
+ */
+static void cache_flush_wait(cache_t *cache, aoff64_t start, aoff64_t end)
+{
+	for (unsigned i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		fibril_mutex_lock(&shard->lock);
+	restart:
+		list_foreach(shard->clock, clock_link, block_t, b) {
+			if (b->busy && b->dirty && b->pba >= start &&
+			    b->pba < end) {
+				cache_wait_idle(shard, b);
+				goto restart;
+			}
+		}
+		fibril_mutex_unlock(&shard->lock);
+	}
+}
+
+/** Write-back flusher fibril.
+ *
+ * Periodically writes back dirty blocks older than the flush age. When
+ * writers are throttled, it writes back all dirty blocks right away.
+ *
+ * @param arg		Device connection.
+ *
+ * @return		EOK.
+ */
+static errno_t cache_flusher(void *arg)
+{
+	devcon_t *devcon = (devcon_t *) arg;
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->flush_lock);
+	while (!cache->flush_stop) {
+		usec_t age;
+
+		if (!cache->flush_urgent) {
+			(void) fibril_condvar_wait_timeout(&cache->flush_cv,
+			    &cache->flush_lock, FLUSH_INTERVAL);
+			if (cache->flush_stop)
+				break;
+		}
+
+		age = cache->flush_urgent ? 0 : cache->flush_age;
+		cache->flush_urgent = false;
+		fibril_mutex_unlock(&cache->flush_lock);
+
+		(void) cache_flush(devcon, cache, age, 0, devcon->pblocks);
+
+		fibril_mutex_lock(&cache->flush_lock);
+		cache->flush_gen++;
+		fibril_condvar_broadcast(&cache->flush_done_cv);
+	}
+
+	cache->flush_running = false;
+	fibril_condvar_broadcast(&cache->flush_done_cv);
+	fibril_mutex_unlock(&cache->flush_lock);
+	return EOK;
+}
+
+/** Throttle a writer when there are too many dirty blocks.
+ *
+ * Wakes up the flusher and waits for one flush to complete.
+ *
+ * @param cache		Cache.
+ */
+static void cache_throttle(cache_t *cache)
+{
+	unsigned dirty = atomic_load(&cache->blocks_dirty);
+	unsigned limit = atomic_load(&cache->blocks_cached) * DIRTY_RATIO / 100;
+
+	if (dirty <= max(limit, DIRTY_MIN))
+		return;
+
+	fibril_mutex_lock(&cache->flush_lock);
+	if (cache->flush_running) {
+		unsigned gen = cache->flush_gen;
+
+		cache->flush_urgent = true;
+		fibril_condvar_signal(&cache->flush_cv);
+		while (cache->flush_running && cache->flush_gen == gen) {
+			fibril_condvar_wait(&cache->flush_done_cv,
+			    &cache->flush_lock);
+		}
+	}
+	fibril_mutex_unlock(&cache->flush_lock);
+}
+
+/** Stop the flusher fibril of a cache and wait for it to terminate. */
+static void cache_flusher_stop(cache_t *cache)
+{
+	fibril_mutex_lock(&cache->flush_lock);
+	cache->flush_stop = true;
+	fibril_condvar_broadcast(&cache->flush_cv);
+	while (cache->flush_running)
+		fibril_condvar_wait(&cache->flush_done_cv, &cache->flush_lock);
+	fibril_mutex_unlock(&cache->flush_lock);
+}
+
+/** Set the age after which the flusher writes dirty blocks back.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param age		Age of dirty blocks in microseconds.
+ *
+ * @return		EOK on success, ENOENT if there is no cache for
+ *			the device, ENOTSUP if it is not in write-back mode.
+ */
+errno_t block_cache_set_flush_age(service_id_t service_id, usec_t age)
+{
+	devcon_t *devcon = devcon_search(service_id);
+
+	if (!devcon || !devcon->cache)
+		return ENOENT;
+	if (devcon->cache->mode != CACHE_MODE_WB)
+		return ENOTSUP;
+
+	fibril_mutex_lock(&devcon->cache->flush_lock);
+	devcon->cache->flush_age = age;
+	fibril_mutex_unlock(&devcon->cache->flush_lock);
+	return EOK;
+}
+
+/** Get the statistics of the block cache of a device.
+ *
+ * The counters are cumulative since the cache was created. File systems
+ * can use this function directly as their libfs cache_stats operation.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param stats		Place to store the statistics.
+ *
+ * @return		EOK on success, ENOENT if there is no cache for
+ *			the device.
+ */
+errno_t block_get_stats(service_id_t service_id, vfs_block_stats_t *stats)
+{
+	devcon_t *devcon = devcon_search(service_id);
+
+	if (!devcon || !devcon->cache)
+		return ENOENT;
+
+	stats->hits = atomic_load(&devcon->cache->hits);
+	stats->misses = atomic_load(&devcon->cache->misses);
+	stats->ra_blocks = atomic_load(&devcon->cache->ra_blocks);
+	stats->ra_used = atomic_load(&devcon->cache->ra_used);
+	stats->ra_wasted = atomic_load(&devcon->cache->ra_wasted);
+	return EOK;
+}
+
+/** Free all unreferenced clean blocks of a cache.
+ *
+ * @param cache Block cache.
+ */
+static void cache_drop_clean(cache_t *cache)
+{
+	for (unsigned i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		fibril_mutex_lock(&shard->lock);
+
+		list_foreach_safe(shard->clock, cur, next) {
+			block_t *b = list_get_instance(cur, block_t, clock_link);
+
+			if ((b->refcnt > 0) || (b->dirty) || (b->busy))
+				continue;
+
+			cache_note_evict(cache, b);
+			cache_block_remove(shard, b);
+			cache_block_free(cache, b);
+		}
+
+		fibril_mutex_unlock(&shard->lock);
+	}
+}
+
+/** Handle memory pressure notification from the kernel.
+ *
+ * Drop the clean blocks of all caches, they can be read again from the
+ * device when needed. Dirty blocks are left to the regular write-back.
+ *
+ * @param call Notification.
+ * @param arg  Unused.
+ */
+static void block_mem_pressure(ipc_call_t *call, void *arg)
+{
+	fibril_rwlock_read_lock(&dcl_lock);
+
+	list_foreach(dcl, link, devcon_t, devcon) {
+		if (devcon->cache != NULL)
+			cache_drop_clean(devcon->cache);
+	}
+
+	fibril_rwlock_read_unlock(&dcl_lock);
+
+	async_event_task_unmask(EVENT_TASK_MEM_PRESSURE);
+}
+
 errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
     enum cache_mode mode)
 {
 	devcon_t *devcon = devcon_search(service_id);
 	cache_t *cache;
+	unsigned i;
+
 	if (!devcon)
 		return ENOENT;
 	if (devcon->cache)
@@ -280,12 +918,32 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 	if (!cache)
 		return ENOMEM;
 
-	fibril_mutex_initialize(&cache->lock);
-	list_initialize(&cache->free_list);
 	cache->lblock_size = size;
 	cache->block_count = blocks;
-	cache->blocks_cached = 0;
+	atomic_init(&cache->blocks_cached, 0);
+	atomic_init(&cache->blocks_dirty, 0);
+	atomic_init(&cache->hits, 0);
+	atomic_init(&cache->misses, 0);
+	atomic_init(&cache->ra_blocks, 0);
+	atomic_init(&cache->ra_used, 0);
+	atomic_init(&cache->ra_wasted, 0);
 	cache->mode = mode;
+	cache->mapped = devcon->map != NULL;
+	fibril_mutex_initialize(&cache->ra_lock);
+	cache->ra_next = 0;
+	cache->ra_cand = 0;
+	cache->ra_end = 0;
+	cache->ra_window = 0;
+	cache->ra_pending = 0;
+	fibril_condvar_initialize(&cache->ra_cv);
+	fibril_mutex_initialize(&cache->flush_lock);
+	fibril_condvar_initialize(&cache->flush_cv);
+	fibril_condvar_initialize(&cache->flush_done_cv);
+	cache->flush_age = FLUSH_AGE_DEFAULT;
+	cache->flush_gen = 0;
+	cache->flush_urgent = false;
+	cache->flush_running = false;
+	cache->flush_stop = false;
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -293,79 +951,430 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 		return ENOTSUP;
 	}
 
-	cache->blocks_cluster = cache->lblock_size / devcon->pblock_size;
+	cache->blocks_cluster = cache->lblock_size / devcon->pblock_size;
+
+	/*
+	 * Read ahead at most as much as fits into a single data transfer.
+	 * A window of one block would not buy anything, neither would reading
+	 * ahead from a mapped device.
+	 */
+	cache->ra_max = XFER_MAX_BYTES / cache->lblock_size;
+	if (cache->ra_max < 2 || cache->mapped)
+		cache->ra_max = 0;
+
+	for (i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		fibril_mutex_initialize(&shard->lock);
+		fibril_condvar_initialize(&shard->busy_cv);
+		list_initialize(&shard->clock);
+		shard->blocks = 0;
+
+		if (!hash_table_create(&shard->block_hash, 0, 0, &cache_ops)) {
+			while (i-- > 0)
+				hash_table_destroy(&cache->shards[i].block_hash);
+			free(cache);
+			return ENOMEM;
+		}
+	}
+
+	devcon->cache = cache;
+
+	if (mode == CACHE_MODE_WB) {
+		/*
+		 * Without the flusher, dirty blocks are written back only on
+		 * eviction, sync and when the cache is destroyed.
+		 */
+		fid_t fid = fibril_create(cache_flusher, devcon);
+		if (fid != 0) {
+			cache->flush_running = true;
+			fibril_add_ready(fid);
+		}
+	}
+
+	fibril_rwlock_write_lock(&dcl_lock);
+	if (!mem_pressure_subscribed) {
+		/*
+		 * Failing to subscribe is not fatal, the cache just won't
+		 * shrink under memory pressure.
+		 */
+		if (async_event_task_subscribe(EVENT_TASK_MEM_PRESSURE,
+		    block_mem_pressure, NULL) == EOK)
+			mem_pressure_subscribed = true;
+	}
+	fibril_rwlock_write_unlock(&dcl_lock);
+
+	return EOK;
+}
+
+errno_t block_cache_fini(service_id_t service_id)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	cache_t *cache;
+	errno_t rc;
+	unsigned i;
+
+	if (!devcon)
+		return ENOENT;
+	if (!devcon->cache)
+		return EOK;
+	cache = devcon->cache;
+
+	cache_flusher_stop(cache);
+
+	/* Detach the cache from the memory pressure handler. */
+	fibril_rwlock_write_lock(&dcl_lock);
+	devcon->cache = NULL;
+	fibril_rwlock_write_unlock(&dcl_lock);
+
+	/* Let readahead in progress finish. */
+	fibril_mutex_lock(&cache->ra_lock);
+	while (cache->ra_pending > 0)
+		fibril_condvar_wait(&cache->ra_cv, &cache->ra_lock);
+	fibril_mutex_unlock(&cache->ra_lock);
+
+	/* Write back what can be clustered first. */
+	(void) cache_flush(devcon, cache, 0, 0, devcon->pblocks);
+
+	/*
+	 * We are expecting all blocks for this device handle to be
+	 * unreferenced. Do not bother with the shard locks because we are
+	 * single-threaded.
+	 */
+	for (i = 0; i < CACHE_SHARDS; i++) {
+		cache_shard_t *shard = &cache->shards[i];
+
+		while (!list_empty(&shard->clock)) {
+			block_t *b = list_get_instance(list_first(&shard->clock),
+			    block_t, clock_link);
+
+			if (b->dirty) {
+				rc = write_blocks(devcon, b->pba,
+				    cache->blocks_cluster, b->data, b->size);
+				if (rc != EOK) {
+					fibril_rwlock_write_lock(&dcl_lock);
+					devcon->cache = cache;
+					fibril_rwlock_write_unlock(&dcl_lock);
+					return rc;
+				}
+			}
+
+			cache_block_remove(shard, b);
+			cache_block_free(cache, b);
+		}
+	}
+
+	for (i = 0; i < CACHE_SHARDS; i++)
+		hash_table_destroy(&cache->shards[i].block_hash);
+	free(cache);
+
+	return EOK;
+}
+
+static void block_initialize(block_t *b)
+{
+	b->refcnt = 1;
+	b->write_failures = 0;
+	b->dirty = false;
+	b->toxic = false;
+	b->busy = false;
+	b->accessed = false;
+	b->readahead = false;
+	b->wb_pending = false;
+	fibril_rwlock_initialize(&b->contents_lock);
+	link_initialize(&b->clock_link);
+}
+
+/** Readahead request passed to the readahead fibril. */
+typedef struct {
+	devcon_t *devcon;
+	/** Cache of the device, it is detached before readahead finishes. */
+	cache_t *cache;
+	/** First block to read. */
+	aoff64_t ba;
+	/** Number of blocks to read. */
+	size_t cnt;
+} readahead_t;
+
+/** Get a block structure for readahead.
+ *
+ * Unlike block_get(), readahead never writes dirty blocks back and never
+ * recycles blocks which were read ahead and not used yet; it gives up
+ * instead.
+ *
+ * @param cache		Cache.
+ * @param shard		Shard which will hold the block, its lock must be
+ *			held.
+ *
+ * @return		Block structure or NULL if there is no room.
+ */
+static block_t *readahead_block_alloc(cache_t *cache, cache_shard_t *shard)
+{
+	block_t *b;
+
+	assert(fibril_mutex_is_locked(&shard->lock));
 
-	if (!hash_table_create(&cache->block_hash, 0, 0, &cache_ops)) {
-		free(cache);
-		return ENOMEM;
+	if (atomic_load(&cache->blocks_cached) <
+	    CACHE_HI_WATERMARK + cache->ra_max) {
+		b = cache_block_alloc(cache);
+		if (b)
+			return b;
 	}
 
-	devcon->cache = cache;
-	return EOK;
+	b = cache_clock_victim(cache, shard, true);
+	if (b == NULL || b->readahead)
+		return NULL;
+
+	cache_block_remove(shard, b);
+	return b;
 }
 
-errno_t block_cache_fini(service_id_t service_id)
+/** Read a run of blocks into the cache.
+ *
+ * The blocks are inserted into the cache busy before the I/O so that
+ * concurrent block_get() calls wait for the data instead of reading it
+ * themselves. The run ends at the first block which is already cached.
+ *
+ * @param arg		Readahead request.
+ *
+ * @return		EOK.
+ */
+static errno_t readahead_fibril(void *arg)
 {
-	devcon_t *devcon = devcon_search(service_id);
-	cache_t *cache;
-	errno_t rc;
+	readahead_t *ra = (readahead_t *) arg;
+	devcon_t *devcon = ra->devcon;
+	cache_t *cache = ra->cache;
+	aoff64_t ba = ra->ba;
+	size_t cnt = ra->cnt;
+	block_t **blocks;
+	size_t n = 0;
+	size_t i;
+
+	blocks = calloc(cnt, sizeof(block_t *));
+
+	while (cnt > 0 && cache_contains(cache, ba)) {
+		ba++;
+		cnt--;
+	}
 
-	if (!devcon)
-		return ENOENT;
-	if (!devcon->cache)
-		return EOK;
-	cache = devcon->cache;
+	while (blocks != NULL && n < cnt) {
+		aoff64_t lba = ba + n;
+		cache_shard_t *shard = cache_shard(cache, lba);
+		block_t *b;
 
-	/*
-	 * We are expecting to find all blocks for this device handle on the
-	 * free list, i.e. the block reference count should be zero. Do not
-	 * bother with the cache and block locks because we are single-threaded.
-	 */
-	while (!list_empty(&cache->free_list)) {
-		block_t *b = list_get_instance(list_first(&cache->free_list),
-		    block_t, free_link);
-
-		list_remove(&b->free_link);
-		if (b->dirty) {
-			rc = write_blocks(devcon, b->pba, cache->blocks_cluster,
-			    b->data, b->size);
-			if (rc != EOK)
-				return rc;
+		fibril_mutex_lock(&shard->lock);
+		if (hash_table_find(&shard->block_hash, &lba) != NULL) {
+			fibril_mutex_unlock(&shard->lock);
+			break;
+		}
+		b = readahead_block_alloc(cache, shard);
+		if (b == NULL) {
+			fibril_mutex_unlock(&shard->lock);
+			break;
 		}
 
-		hash_table_remove_item(&cache->block_hash, &b->hash_link);
+		block_initialize(b);
+		b->service_id = devcon->service_id;
+		b->size = cache->lblock_size;
+		b->lba = lba;
+		b->pba = lba * cache->blocks_cluster;
+		b->readahead = true;
+		b->accessed = true;
+		b->busy = true;
+		cache_block_insert(shard, b);
+		fibril_mutex_unlock(&shard->lock);
+
+		blocks[n++] = b;
+	}
 
-		free(b->data);
-		free(b);
+	atomic_fetch_add(&cache->ra_blocks, n);
+
+	if (n > 0) {
+		uint8_t *buf = malloc(n * cache->lblock_size);
+		errno_t rc = ENOMEM;
+
+		if (buf != NULL) {
+			rc = read_blocks(devcon, blocks[0]->pba,
+			    n * cache->blocks_cluster, buf,
+			    n * cache->lblock_size);
+		}
+
+		for (i = 0; i < n; i++) {
+			block_t *b = blocks[i];
+			cache_shard_t *shard = cache_shard(cache, b->lba);
+
+			if (rc == EOK) {
+				memcpy(b->data, buf + i * cache->lblock_size,
+				    cache->lblock_size);
+			}
+
+			/*
+			 * Drop our reference. Unlike block_put(), keep the
+			 * block even above the high watermark, it is about
+			 * to be used.
+			 */
+			fibril_mutex_lock(&shard->lock);
+			if (rc != EOK)
+				b->toxic = true;
+			cache_set_idle(shard, b);
+			if (--b->refcnt == 0 && b->toxic) {
+				cache_block_remove(shard, b);
+				cache_block_free(cache, b);
+			}
+			fibril_mutex_unlock(&shard->lock);
+		}
+
+		free(buf);
 	}
 
-	hash_table_destroy(&cache->block_hash);
-	devcon->cache = NULL;
-	free(cache);
+	fibril_mutex_lock(&cache->ra_lock);
+	cache->ra_pending--;
+	fibril_condvar_broadcast(&cache->ra_cv);
+	fibril_mutex_unlock(&cache->ra_lock);
 
+	free(blocks);
+	free(ra);
 	return EOK;
 }
 
-#define CACHE_LO_WATERMARK	10
-#define CACHE_HI_WATERMARK	20
-static bool cache_can_grow(cache_t *cache)
+/** Start reading blocks ahead in the background.
+ *
+ * @param devcon	Device connection, its readahead lock must be held.
+ * @param ba		First block to read.
+ * @param cnt		Number of blocks to read.
+ *
+ * @return		True if readahead was started.
+ */
+static bool readahead_start(devcon_t *devcon, aoff64_t ba, size_t cnt)
 {
-	if (cache->blocks_cached < CACHE_LO_WATERMARK)
-		return true;
-	if (!list_empty(&cache->free_list))
+	cache_t *cache = devcon->cache;
+	aoff64_t last;
+	readahead_t *ra;
+	fid_t fid;
+
+	assert(fibril_mutex_is_locked(&cache->ra_lock));
+
+	if (cache->ra_pending >= READAHEAD_MAX_PENDING)
+		return false;
+
+	/* Stay within the limit block_get() checks. */
+	if (devcon->pblocks <= cache->blocks_cluster)
+		return false;
+	last = (devcon->pblocks - cache->blocks_cluster - 1) /
+	    cache->blocks_cluster;
+	if (ba > last)
+		return false;
+	cnt = min(cnt, last - ba + 1);
+	cnt = min(cnt, cache->ra_max);
+	if (cnt == 0)
+		return false;
+
+	ra = malloc(sizeof(readahead_t));
+	if (ra == NULL)
+		return false;
+	ra->devcon = devcon;
+	ra->cache = cache;
+	ra->ba = ba;
+	ra->cnt = cnt;
+
+	fid = fibril_create(readahead_fibril, ra);
+	if (fid == 0) {
+		free(ra);
 		return false;
+	}
+
+	cache->ra_pending++;
+	fibril_add_ready(fid);
 	return true;
 }
 
-static void block_initialize(block_t *b)
+/** Track the access pattern and read ahead of sequential streams.
+ *
+ * Called for cache misses and for the first use of blocks read ahead. Two
+ * consecutive blocks start a stream; each further block of the stream keeps
+ * the readahead window ahead of it, doubling the window up to the maximum.
+ * Accesses elsewhere do not end the stream, so that interleaved metadata
+ * reads do not disturb streaming file data.
+ *
+ * @param devcon	Device connection.
+ * @param ba		Block which was accessed.
+ */
+static void readahead_track(devcon_t *devcon, aoff64_t ba)
 {
-	fibril_mutex_initialize(&b->lock);
-	b->refcnt = 1;
-	b->write_failures = 0;
-	b->dirty = false;
-	b->toxic = false;
-	fibril_rwlock_initialize(&b->contents_lock);
-	link_initialize(&b->free_link);
+	cache_t *cache = devcon->cache;
+	aoff64_t target;
+
+	if (cache->ra_max == 0)
+		return;
+
+	fibril_mutex_lock(&cache->ra_lock);
+
+	if (ba == cache->ra_cand && ba != cache->ra_next) {
+		/* Start a new stream. */
+		cache->ra_next = ba;
+		cache->ra_end = ba + 1;
+		cache->ra_window = min(READAHEAD_MIN, cache->ra_max);
+	}
+
+	if (ba == cache->ra_next) {
+		if (cache->ra_end < ba + 1)
+			cache->ra_end = ba + 1;
+		target = ba + 1 + cache->ra_window;
+
+		/* Issue readahead in chunks of at least half the window. */
+		if (target > cache->ra_end &&
+		    target - cache->ra_end >= cache->ra_window / 2 &&
+		    readahead_start(devcon, cache->ra_end,
+		    target - cache->ra_end)) {
+			cache->ra_end = target;
+			cache->ra_window = min(2 * cache->ra_window,
+			    cache->ra_max);
+		}
+		cache->ra_next = ba + 1;
+	} else if (ba + 1 != cache->ra_next) {
+		cache->ra_cand = ba + 1;
+	}
+
+	fibril_mutex_unlock(&cache->ra_lock);
+}
+
+/** Hint that blocks are going to be read soon.
+ *
+ * File systems which know the layout of a file, e.g. from an extent, can
+ * use this to read ahead of the automatic sequential detection. Blocks
+ * which are already cached are skipped and the request is limited to the
+ * maximum readahead window.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ba		First block to read (logical).
+ * @param cnt		Number of blocks to read.
+ */
+void block_readahead(service_id_t service_id, aoff64_t ba, size_t cnt)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	cache_t *cache;
+	size_t cached = 0;
+
+	assert(devcon);
+	assert(devcon->cache);
+
+	cache = devcon->cache;
+	if (cache->ra_max == 0)
+		return;
+
+	cnt = min(cnt, cache->ra_max);
+	while (cached < cnt && cache_contains(cache, ba + cached))
+		cached++;
+
+	/*
+	 * When most of the range is cached already, an earlier hint has it
+	 * covered. Wait until there is enough left to read in one go.
+	 */
+	if (cached < cnt && cached <= cnt / 2) {
+		fibril_mutex_lock(&cache->ra_lock);
+		(void) readahead_start(devcon, ba + cached, cnt - cached);
+		fibril_mutex_unlock(&cache->ra_lock);
+	}
 }
 
 /** Instantiate a block in memory and get a reference to it.
@@ -384,9 +1393,10 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 {
 	devcon_t *devcon;
 	cache_t *cache;
+	cache_shard_t *shard;
 	block_t *b;
-	link_t *link;
 	aoff64_t p_ba;
+	bool track = false;
 	errno_t rc;
 
 	devcon = devcon_search(service_id);
@@ -395,6 +1405,7 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 	assert(devcon->cache);
 
 	cache = devcon->cache;
+	shard = cache_shard(cache, ba);
 
 	/*
 	 * Check whether the logical block (or part of it) is beyond
@@ -411,167 +1422,138 @@ retry:
 	rc = EOK;
 	b = NULL;
 
-	fibril_mutex_lock(&cache->lock);
-	ht_link_t *hlink = hash_table_find(&cache->block_hash, &ba);
+	fibril_mutex_lock(&shard->lock);
+	ht_link_t *hlink = hash_table_find(&shard->block_hash, &ba);
 	if (hlink) {
-	found:
 		/*
-		 * We found the block in the cache.
+		 * We found the block in the cache. If there is I/O in progress
+		 * on it, wait for it to finish without blocking the other
+		 * users of the shard.
 		 */
 		b = hash_table_get_inst(hlink, block_t, hash_link);
-		fibril_mutex_lock(&b->lock);
-		if (b->refcnt++ == 0)
-			list_remove(&b->free_link);
+		b->refcnt++;
+		b->accessed = true;
+		track = b->readahead;
+		b->readahead = false;
+		atomic_fetch_add(&cache->hits, 1);
+		if (track)
+			atomic_fetch_add(&cache->ra_used, 1);
+		cache_wait_idle(shard, b);
 		if (b->toxic)
 			rc = EIO;
-		fibril_mutex_unlock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
-	} else {
+		fibril_mutex_unlock(&shard->lock);
+		goto out;
+	}
+
+	/*
+	 * The block was not found in the cache. Unless the cache is still
+	 * small, try to recycle a block of the shard before growing the cache.
+	 */
+	if (atomic_load(&cache->blocks_cached) >= CACHE_LO_WATERMARK)
+		b = cache_clock_victim(cache, shard, false);
+
+	if (b && b->dirty) {
 		/*
-		 * The block was not found in the cache.
+		 * The block needs to be written back to the device before it
+		 * changes identity. Do this while not holding the shard lock
+		 * so that concurrency is not impeded.
 		 */
-		if (cache_can_grow(cache)) {
+		b->busy = true;
+		fibril_mutex_unlock(&shard->lock);
+		rc = write_blocks(devcon, b->pba, cache->blocks_cluster,
+		    b->data, b->size);
+		fibril_mutex_lock(&shard->lock);
+		if (rc == EOK) {
+			b->write_failures = 0;
+			cache_mark_clean(cache, b);
+		} else if (b->write_failures < MAX_WRITE_RETRIES) {
 			/*
-			 * We can grow the cache by allocating new blocks.
-			 * Should the allocation fail, we fail over and try to
-			 * recycle a block from the cache.
+			 * We did not manage to write the block to the device.
+			 * Keep it around for another try. Hopefully, we will
+			 * grab another block next time.
 			 */
-			b = malloc(sizeof(block_t));
-			if (!b)
-				goto recycle;
-			b->data = malloc(cache->lblock_size);
-			if (!b->data) {
-				free(b);
-				b = NULL;
-				goto recycle;
-			}
-			cache->blocks_cached++;
+			b->write_failures++;
 		} else {
-			/*
-			 * Try to recycle a block from the free list.
-			 */
-		recycle:
-			if (list_empty(&cache->free_list)) {
-				fibril_mutex_unlock(&cache->lock);
-				rc = ENOMEM;
-				goto out;
-			}
-			link = list_first(&cache->free_list);
-			b = list_get_instance(link, block_t, free_link);
-
-			fibril_mutex_lock(&b->lock);
-			if (b->dirty) {
-				/*
-				 * The block needs to be written back to the
-				 * device before it changes identity. Do this
-				 * while not holding the cache lock so that
-				 * concurrency is not impeded. Also move the
-				 * block to the end of the free list so that we
-				 * do not slow down other instances of
-				 * block_get() draining the free list.
-				 */
-				list_remove(&b->free_link);
-				list_append(&b->free_link, &cache->free_list);
-				fibril_mutex_unlock(&cache->lock);
-				rc = write_blocks(devcon, b->pba,
-				    cache->blocks_cluster, b->data, b->size);
-				if (rc != EOK) {
-					/*
-					 * We did not manage to write the block
-					 * to the device. Keep it around for
-					 * another try. Hopefully, we will grab
-					 * another block next time.
-					 */
-					if (b->write_failures < MAX_WRITE_RETRIES) {
-						b->write_failures++;
-						fibril_mutex_unlock(&b->lock);
-						goto retry;
-					} else {
-						printf("Too many errors writing block %"
-						    PRIuOFF64 "from device handle %" PRIun "\n"
-						    "SEVERE DATA LOSS POSSIBLE\n",
-						    b->lba, devcon->service_id);
-					}
-				} else
-					b->write_failures = 0;
+			printf("Too many errors writing block %"
+			    PRIuOFF64 "from device handle %" PRIun "\n"
+			    "SEVERE DATA LOSS POSSIBLE\n",
+			    b->lba, devcon->service_id);
+			cache_mark_clean(cache, b);
+		}
+		cache_set_idle(shard, b);
+		fibril_mutex_unlock(&shard->lock);
 
-				b->dirty = false;
-				if (!fibril_mutex_trylock(&cache->lock)) {
-					/*
-					 * Somebody is probably racing with us.
-					 * Unlock the block and retry.
-					 */
-					fibril_mutex_unlock(&b->lock);
-					goto retry;
-				}
-				hlink = hash_table_find(&cache->block_hash, &ba);
-				if (hlink) {
-					/*
-					 * Someone else must have already
-					 * instantiated the block while we were
-					 * not holding the cache lock.
-					 * Leave the recycled block on the
-					 * freelist and continue as if we
-					 * found the block of interest during
-					 * the first try.
-					 */
-					fibril_mutex_unlock(&b->lock);
-					goto found;
-				}
+		/* Somebody may have instantiated the block meanwhile. */
+		goto retry;
+	}
 
+	if (b) {
+		cache_note_evict(cache, b);
+		cache_block_remove(shard, b);
+	} else {
+		/*
+		 * Grow the cache by allocating a new block. Should the
+		 * allocation fail, fail over to recycling a clean block.
+		 */
+		b = cache_block_alloc(cache);
+		if (!b) {
+			b = cache_clock_victim(cache, shard, true);
+			if (!b) {
+				fibril_mutex_unlock(&shard->lock);
+				rc = ENOMEM;
+				goto out;
 			}
-			fibril_mutex_unlock(&b->lock);
-
-			/*
-			 * Unlink the block from the free list and the hash
-			 * table.
-			 */
-			list_remove(&b->free_link);
-			hash_table_remove_item(&cache->block_hash, &b->hash_link);
+			cache_block_remove(shard, b);
 		}
+	}
 
-		block_initialize(b);
-		b->service_id = service_id;
-		b->size = cache->lblock_size;
-		b->lba = ba;
-		b->pba = ba_ltop(devcon, b->lba);
-		hash_table_insert(&cache->block_hash, &b->hash_link);
+	block_initialize(b);
+	b->service_id = service_id;
+	b->size = cache->lblock_size;
+	b->lba = ba;
+	b->pba = ba_ltop(devcon, b->lba);
+	cache_block_map(devcon, b);
+	atomic_fetch_add(&cache->misses, 1);
+
+	/*
+	 * Insert the block busy and do the I/O without holding the shard
+	 * lock. Concurrent users of the block wait until it becomes idle.
+	 */
+	b->busy = true;
+	cache_block_insert(shard, b);
+	fibril_mutex_unlock(&shard->lock);
 
+	if (!(flags & BLOCK_FLAGS_NOREAD)) {
 		/*
-		 * Lock the block before releasing the cache lock. Thus we don't
-		 * kill concurrent operations on the cache while doing I/O on
-		 * the block.
+		 * The block contains old or no data. We need to read
+		 * the new contents from the device.
 		 */
-		fibril_mutex_lock(&b->lock);
-		fibril_mutex_unlock(&cache->lock);
-
-		if (!(flags & BLOCK_FLAGS_NOREAD)) {
-			/*
-			 * The block contains old or no data. We need to read
-			 * the new contents from the device.
-			 */
-			rc = read_blocks(devcon, b->pba, cache->blocks_cluster,
-			    b->data, cache->lblock_size);
-			if (rc != EOK)
-				b->toxic = true;
-		} else
-			rc = EOK;
-
-		fibril_mutex_unlock(&b->lock);
+		rc = read_blocks(devcon, b->pba, cache->blocks_cluster,
+		    b->data, cache->lblock_size);
+		track = true;
 	}
+
+	fibril_mutex_lock(&shard->lock);
+	if (rc != EOK)
+		b->toxic = true;
+	cache_set_idle(shard, b);
+	fibril_mutex_unlock(&shard->lock);
 out:
 	if ((rc != EOK) && b) {
 		assert(b->toxic);
 		(void) block_put(b);
 		b = NULL;
 	}
+	if (rc == EOK && track)
+		readahead_track(devcon, ba);
 	*block = b;
 	return rc;
 }
 
 /** Release a reference to a block.
  *
- * If the last reference is dropped, the block is put on the free list.
+ * If the last reference is dropped, the block stays in the cache unless
+ * there are too many cached blocks or it is toxic.
  *
  * @param block		Block of which a reference is to be released.
  *
@@ -581,68 +1563,67 @@ errno_t block_put(block_t *block)
 {
 	devcon_t *devcon = devcon_search(block->service_id);
 	cache_t *cache;
-	unsigned blocks_cached;
-	enum cache_mode mode;
+	cache_shard_t *shard;
 	errno_t rc = EOK;
 
 	assert(devcon);
 	assert(devcon->cache);
-	assert(block->refcnt >= 1);
 
 	cache = devcon->cache;
+	shard = cache_shard(cache, block->lba);
 
 retry:
-	fibril_mutex_lock(&cache->lock);
-	blocks_cached = cache->blocks_cached;
-	mode = cache->mode;
-	fibril_mutex_unlock(&cache->lock);
+	fibril_mutex_lock(&shard->lock);
+	assert(block->refcnt >= 1);
+
+	if (block->toxic) {
+		/* will not write back toxic block */
+		cache_mark_clean(cache, block);
+	}
+	cache_note_dirty(cache, block);
 
 	/*
-	 * Determine whether to sync the block. Syncing the block is best done
-	 * when not holding the cache lock as it does not impede concurrency.
-	 * Since the situation may have changed when we unlocked the cache, the
-	 * blocks_cached and mode variables are mere hints. We will recheck the
-	 * conditions later when the cache lock is held again.
+	 * Determine whether to sync the block. Syncing the block is done
+	 * while the block is busy and the shard lock is not held as it does
+	 * not impede concurrency.
 	 */
-	fibril_mutex_lock(&block->lock);
-	if (block->toxic)
-		block->dirty = false;	/* will not write back toxic block */
 	if (block->dirty && (block->refcnt == 1) &&
-	    (blocks_cached > CACHE_HI_WATERMARK || mode != CACHE_MODE_WB)) {
+	    (atomic_load(&cache->blocks_cached) > CACHE_HI_WATERMARK ||
+	    cache->mode != CACHE_MODE_WB)) {
+		cache_wait_idle(shard, block);
+		block->busy = true;
+		fibril_mutex_unlock(&shard->lock);
 		rc = write_blocks(devcon, block->pba, cache->blocks_cluster,
 		    block->data, block->size);
+		fibril_mutex_lock(&shard->lock);
 		if (rc == EOK)
 			block->write_failures = 0;
-		block->dirty = false;
+		cache_mark_clean(cache, block);
+		cache_set_idle(shard, block);
 	}
-	fibril_mutex_unlock(&block->lock);
 
-	fibril_mutex_lock(&cache->lock);
-	fibril_mutex_lock(&block->lock);
 	if (!--block->refcnt) {
 		/*
 		 * Last reference to the block was dropped. Either free the
-		 * block or put it on the free list. In case of an I/O error,
+		 * block or leave it in the cache. In case of an I/O error,
 		 * free the block.
 		 */
-		if ((cache->blocks_cached > CACHE_HI_WATERMARK) ||
-		    (rc != EOK)) {
+		if ((atomic_load(&cache->blocks_cached) > CACHE_HI_WATERMARK) ||
+		    (rc != EOK) || (block->toxic)) {
 			/*
 			 * Currently there are too many cached blocks or there
-			 * was an I/O error when writing the block back to the
-			 * device.
+			 * was an I/O error.
 			 */
 			if (block->dirty) {
 				/*
 				 * We cannot sync the block while holding the
-				 * cache lock. Release everything and retry.
+				 * shard lock. Release everything and retry.
 				 */
 				block->refcnt++;
 
 				if (block->write_failures < MAX_WRITE_RETRIES) {
 					block->write_failures++;
-					fibril_mutex_unlock(&block->lock);
-					fibril_mutex_unlock(&cache->lock);
+					fibril_mutex_unlock(&shard->lock);
 					goto retry;
 				} else {
 					printf("Too many errors writing block %"
@@ -650,35 +1631,261 @@ retry:
 					    "SEVERE DATA LOSS POSSIBLE\n",
 					    block->lba, devcon->service_id);
 				}
+				block->refcnt--;
 			}
 			/*
 			 * Take the block out of the cache and free it.
 			 */
-			hash_table_remove_item(&cache->block_hash, &block->hash_link);
-			fibril_mutex_unlock(&block->lock);
-			free(block->data);
-			free(block);
-			cache->blocks_cached--;
-			fibril_mutex_unlock(&cache->lock);
+			cache_block_remove(shard, block);
+			fibril_mutex_unlock(&shard->lock);
+			cache_block_free(cache, block);
 			return rc;
 		}
-		/*
-		 * Put the block on the free list.
-		 */
+
 		if (cache->mode != CACHE_MODE_WB && block->dirty) {
 			/*
-			 * We cannot sync the block while holding the cache
+			 * We cannot sync the block while holding the shard
 			 * lock. Release everything and retry.
 			 */
 			block->refcnt++;
-			fibril_mutex_unlock(&block->lock);
-			fibril_mutex_unlock(&cache->lock);
+			fibril_mutex_unlock(&shard->lock);
 			goto retry;
 		}
-		list_append(&block->free_link, &cache->free_list);
 	}
-	fibril_mutex_unlock(&block->lock);
-	fibril_mutex_unlock(&cache->lock);
+	fibril_mutex_unlock(&shard->lock);
+
+	if (cache->mode == CACHE_MODE_WB)
+		cache_throttle(cache);
+
+	return rc;
+}
+
+/** State of a block in block_get_range(). */
+enum {
+	/** Block was found in the cache. */
+	RANGE_FOUND,
+	/** Block was found read ahead and not used yet. */
+	RANGE_READAHEAD,
+	/** Block was inserted and needs to be filled. */
+	RANGE_FILL
+};
+
+/** Get a new block structure for block_get_range().
+ *
+ * @param cache		Cache.
+ * @param shard		Shard which will hold the block, its lock must be
+ *			held.
+ *
+ * @return		Block structure or NULL if neither a clean block can
+ *			be recycled nor a new one allocated.
+ */
+static block_t *range_block_alloc(cache_t *cache, cache_shard_t *shard)
+{
+	block_t *b = NULL;
+
+	if (atomic_load(&cache->blocks_cached) >= CACHE_LO_WATERMARK)
+		b = cache_clock_victim(cache, shard, true);
+	if (b) {
+		cache_block_remove(shard, b);
+		return b;
+	}
+
+	return cache_block_alloc(cache);
+}
+
+/** Instantiate consecutive blocks in memory and get references to them.
+ *
+ * All blocks missing in the cache are read with as few device reads as
+ * possible. Blocks which cannot be instantiated this way, e.g. because
+ * their recycling requires a write-back, are left to block_get().
+ *
+ * @param blocks		Array of @a cnt block pointers to fill.
+ * @param service_id		Service ID of the block device.
+ * @param ba			Address of the first block (logical).
+ * @param cnt			Number of blocks.
+ * @param flags			Flags as for block_get().
+ *
+ * @return			EOK on success or an error code. On failure,
+ *				no references are held.
+ */
+errno_t block_get_range(block_t **blocks, service_id_t service_id,
+    aoff64_t ba, size_t cnt, int flags)
+{
+	devcon_t *devcon;
+	cache_t *cache;
+	uint8_t *state;
+	uint8_t *buf = NULL;
+	size_t max_run;
+	size_t fast;
+	size_t got;
+	size_t i;
+	errno_t rc = EOK;
+
+	devcon = devcon_search(service_id);
+
+	assert(devcon);
+	assert(devcon->cache);
+
+	cache = devcon->cache;
+
+	if (cnt == 0)
+		return EOK;
+	if (ba_ltop(devcon, ba + cnt) >= devcon->pblocks)
+		return EIO;
+
+	/* Without memory for the state, do it block by block. */
+	state = calloc(cnt, sizeof(uint8_t));
+	fast = state != NULL ? cnt : 0;
+
+	/*
+	 * Get references to all blocks first. The blocks we insert are busy
+	 * until we fill them; we do not wait for blocks busy elsewhere before
+	 * our own are filled so that two overlapping calls cannot wait for
+	 * each other.
+	 */
+	for (got = 0; got < fast; got++) {
+		aoff64_t lba = ba + got;
+		cache_shard_t *shard = cache_shard(cache, lba);
+		ht_link_t *hlink;
+		block_t *b;
+
+		fibril_mutex_lock(&shard->lock);
+		hlink = hash_table_find(&shard->block_hash, &lba);
+		if (hlink) {
+			b = hash_table_get_inst(hlink, block_t, hash_link);
+			b->refcnt++;
+			b->accessed = true;
+			state[got] = b->readahead ? RANGE_READAHEAD :
+			    RANGE_FOUND;
+			b->readahead = false;
+			atomic_fetch_add(&cache->hits, 1);
+			if (state[got] == RANGE_READAHEAD)
+				atomic_fetch_add(&cache->ra_used, 1);
+		} else {
+			b = range_block_alloc(cache, shard);
+			if (b == NULL) {
+				fibril_mutex_unlock(&shard->lock);
+				break;
+			}
+			block_initialize(b);
+			b->service_id = service_id;
+			b->size = cache->lblock_size;
+			b->lba = lba;
+			b->pba = ba_ltop(devcon, lba);
+			cache_block_map(devcon, b);
+			b->busy = true;
+			cache_block_insert(shard, b);
+			state[got] = RANGE_FILL;
+			atomic_fetch_add(&cache->misses, 1);
+		}
+		fibril_mutex_unlock(&shard->lock);
+		blocks[got] = b;
+	}
+
+	/* Fill the inserted blocks, one read per run of consecutive blocks. */
+	max_run = max(XFER_MAX_BYTES / cache->lblock_size, 1);
+	if (!(flags & BLOCK_FLAGS_NOREAD) && max_run > 1 && !cache->mapped)
+		buf = malloc(max_run * cache->lblock_size);
+
+	for (i = 0; i < got; ) {
+		size_t run = 1;
+		errno_t rrc;
+
+		if (state[i] != RANGE_FILL) {
+			i++;
+			continue;
+		}
+
+		while (buf != NULL && run < max_run && i + run < got &&
+		    state[i + run] == RANGE_FILL)
+			run++;
+
+		if (flags & BLOCK_FLAGS_NOREAD) {
+			rrc = EOK;
+		} else if (run == 1) {
+			rrc = read_blocks(devcon, blocks[i]->pba,
+			    cache->blocks_cluster, blocks[i]->data,
+			    cache->lblock_size);
+		} else {
+			rrc = read_blocks(devcon, blocks[i]->pba,
+			    run * cache->blocks_cluster, buf,
+			    run * cache->lblock_size);
+		}
+
+		for (size_t j = i; j < i + run; j++) {
+			block_t *b = blocks[j];
+			cache_shard_t *shard = cache_shard(cache, b->lba);
+
+			if (rrc == EOK && run > 1 && buf != NULL) {
+				memcpy(b->data,
+				    buf + (j - i) * cache->lblock_size,
+				    cache->lblock_size);
+			}
+
+			fibril_mutex_lock(&shard->lock);
+			if (rrc != EOK)
+				b->toxic = true;
+			cache_set_idle(shard, b);
+			fibril_mutex_unlock(&shard->lock);
+		}
+
+		i += run;
+	}
+	free(buf);
+
+	/* Now wait for the blocks which others are doing I/O on. */
+	for (i = 0; i < got; i++) {
+		cache_shard_t *shard = cache_shard(cache, blocks[i]->lba);
+
+		fibril_mutex_lock(&shard->lock);
+		cache_wait_idle(shard, blocks[i]);
+		if (blocks[i]->toxic && rc == EOK)
+			rc = EIO;
+		fibril_mutex_unlock(&shard->lock);
+	}
+
+	if (rc == EOK && !(flags & BLOCK_FLAGS_NOREAD)) {
+		for (i = 0; i < got; i++) {
+			if (state[i] != RANGE_FOUND)
+				readahead_track(devcon, ba + i);
+		}
+	}
+
+	free(state);
+
+	/* Leave whatever is left to the regular path. */
+	for (i = got; rc == EOK && i < cnt; i++) {
+		rc = block_get(&blocks[i], service_id, ba + i, flags);
+		if (rc == EOK)
+			got++;
+	}
+
+	if (rc != EOK) {
+		(void) block_put_range(blocks, got);
+		return rc;
+	}
+
+	return EOK;
+}
+
+/** Release references to consecutive blocks.
+ *
+ * @param blocks		Array of @a cnt blocks obtained by
+ *				block_get_range().
+ * @param cnt			Number of blocks.
+ *
+ * @return			EOK on success or the first error which
+ *				occurred. All references are released anyway.
+ */
+errno_t block_put_range(block_t **blocks, size_t cnt)
+{
+	errno_t rc = EOK;
+
+	for (size_t i = 0; i < cnt; i++) {
+		errno_t rc2 = block_put(blocks[i]);
+		if (rc2 != EOK && rc == EOK)
+			rc = rc2;
+	}
 
 	return rc;
 }
@@ -798,10 +2005,25 @@ errno_t block_write_direct(service_id_t service_id, aoff64_t ba, size_t cnt,
 errno_t block_sync_cache(service_id_t service_id, aoff64_t ba, size_t cnt)
 {
 	devcon_t *devcon;
+	errno_t rc;
 
 	devcon = devcon_search(service_id);
 	assert(devcon);
 
+	/*
+	 * Write back the dirty cached blocks of the range first, including
+	 * those the flusher is writing at the moment. Only these are waited
+	 * for, the rest is left to the flusher.
+	 */
+	if (devcon->cache != NULL) {
+		aoff64_t end = cnt > 0 ? ba + cnt : devcon->pblocks;
+
+		rc = cache_flush(devcon, devcon->cache, 0, ba, end);
+		cache_flush_wait(devcon->cache, ba, end);
+		if (rc != EOK)
+			return rc;
+	}
+
 	return bd_sync_cache(devcon->bd, ba, cnt);
 }
 
@@ -908,6 +2130,9 @@ errno_t block_read_toc(service_id_t service_id, uint8_t session, void *buf,
 }
 
 /** Read blocks from block device.
+ *
+ * A mapped device is read directly, nothing needs to be done if @a buf
+ * is where the blocks are mapped.
  *
  * @param devcon	Device connection.
  * @param ba		Address of first block.
@@ -921,6 +2146,16 @@ static errno_t read_blocks(devcon_t *devcon, aoff64_t ba, size_t cnt, void *buf,
 {
 	assert(devcon);
 
+	if (devcon->map != NULL) {
+		uint8_t *src = devcon->map + ba * devcon->pblock_size;
+
+		if (ba + cnt > devcon->pblocks)
+			return ELIMIT;
+		if (buf != src)
+			memcpy(buf, src, min(size, cnt * devcon->pblock_size));
+		return EOK;
+	}
+
 	errno_t rc = bd_read_blocks(devcon->bd, ba, cnt, buf, size);
 	if (rc != EOK) {
 		printf("Error %s reading %zu blocks starting at block %" PRIuOFF64
@@ -948,6 +2183,16 @@ static errno_t write_blocks(devcon_t *devcon, aoff64_t ba, size_t cnt, void *dat
 {
 	assert(devcon);
 
+	if (devcon->map != NULL) {
+		uint8_t *dst = devcon->map + ba * devcon->pblock_size;
+
+		if (ba + cnt > devcon->pblocks)
+			return ELIMIT;
+		if (data != dst)
+			memcpy(dst, data, min(size, cnt * devcon->pblock_size));
+		return EOK;
+	}
+
 	errno_t rc = bd_write_blocks(devcon->bd, ba, cnt, data, size);
 	if (rc != EOK) {
 		printf("Error %s writing %zu blocks starting at block %" PRIuOFF64
@@ -44,6 +44,7 @@
 #include <adt/hash_table.h>
 #include <adt/list.h>
 #include <loc.h>
+#include <vfs/vfs.h>
 
 /*
  * Flags that can be used with block_get().
@@ -62,14 +63,22 @@
 #define BLOCK_FLAGS_NOREAD	1
 
 typedef struct block {
-	/** Mutex protecting the reference count. */
-	fibril_mutex_t lock;
 	/** Number of references to the block_t structure. */
 	unsigned refcnt;
 	/** If true, the block needs to be written back to the block device. */
 	bool dirty;
 	/** If true, the blcok does not contain valid data. */
 	bool toxic;
+	/** If true, the block was read ahead and has not been used yet. */
+	bool readahead;
+	/** If true, I/O on the block is in progress. */
+	bool busy;
+	/** Reference bit of the clock replacement. */
+	bool accessed;
+	/** If true, the block is accounted for as awaiting write-back. */
+	bool wb_pending;
+	/** Uptime in microseconds when the block was found dirty. */
+	usec_t dirty_time;
 	/** Readers / Writer lock protecting the contents of the block. */
 	fibril_rwlock_t contents_lock;
 	/** Service ID of service providing the block device. */
@@ -82,8 +91,8 @@ typedef struct block {
 	size_t size;
 	/** Number of write failures. */
 	int write_failures;
-	/** Link for placing the block into the free block list. */
-	link_t free_link;
+	/** Link for placing the block into the cache clock. */
+	link_t clock_link;
 	/** Link for placing the block into the block hash table. */
 	ht_link_t hash_link;
 	/** Buffer with the block data. */
@@ -106,9 +115,15 @@ extern void *block_bb_get(service_id_t);
 
 extern errno_t block_cache_init(service_id_t, size_t, unsigned, enum cache_mode);
 extern errno_t block_cache_fini(service_id_t);
+extern errno_t block_cache_set_flush_age(service_id_t, usec_t);
+extern errno_t block_get_stats(service_id_t, vfs_block_stats_t *);
 
 extern errno_t block_get(block_t **, service_id_t, aoff64_t, int);
 extern errno_t block_put(block_t *);
+extern errno_t block_get_range(block_t **, service_id_t, aoff64_t, size_t, int);
+extern errno_t block_put_range(block_t **, size_t);
+
+extern void block_readahead(service_id_t, aoff64_t, size_t);
 
 extern errno_t block_seqread(service_id_t, void *, size_t *, size_t *, aoff64_t *,
     void *, size_t);
@@ -36,10 +36,15 @@
 #define _LIBC_amd64_RTLD_MODULE_H_
 
 #include <elf/elf_mod.h>
+#include <stddef.h>
 
 /** ELF module load flags */
 #define RTLD_MODULE_LDF 0
 
+struct module;
+
+extern void *plt_resolve(struct module *, size_t);
+
 #endif
 
 /** @}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file CRC computation accelerated for amd64.
+ *
+ * CRC32C uses the CRC32 instruction of SSE4.2. The instruction only
+ * implements the Castagnoli polynomial, so CRC32 is computed by folding
+ * the data with carry-less multiplication (PCLMULQDQ) instead, as
+ * described in Intel's "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction". Only SSE registers are used.
+ */
+
+#include <mem.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../../generic/private/checksum.h"
+
+#define CPUID_LEVEL     0x00000000
+#define CPUID_BASIC     0x00000001
+
+/** PCLMULQDQ in ECX of CPUID_BASIC */
+#define CPUID_PCLMULQDQ  (1 << 1)
+/** SSE4.2 in ECX of CPUID_BASIC */
+#define CPUID_SSE42  (1 << 20)
+
+typedef uint64_t crc_vec_t __attribute__((vector_size(16)));
+
+/*
+ * Folding constants for the reflected polynomial 0xedb88320:
+ * x^(4*128+32) mod P and x^(4*128-32) mod P fold across four
+ * registers, x^(128+32) mod P and x^(128-32) mod P across one,
+ * followed by the constants of the final reduction to 32 bits.
+ */
+static const crc_vec_t crc32_k1k2 = { 0x0154442bd4, 0x01c6e41596 };
+static const crc_vec_t crc32_k3k4 = { 0x01751997d0, 0x00ccaa009e };
+static const crc_vec_t crc32_k5 = { 0x0163cd6124, 0 };
+static const crc_vec_t crc32_poly = { 0x01db710641, 0x01f7011641 };
+static const crc_vec_t crc32_mask32 = { 0xffffffff, 0 };
+
+/** Shortest block worth folding. */
+#define CRC_FOLD_MIN  64
+
+static inline void crc_cpuid(uint32_t leaf, uint32_t *regs)
+{
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	    : "a" (leaf), "c" (0)
+	);
+}
+
+/** Get ECX of CPUID_BASIC, or zero if not available. */
+static uint32_t crc_features(void)
+{
+	uint32_t regs[4];
+
+	crc_cpuid(CPUID_LEVEL, regs);
+	if (regs[0] < CPUID_BASIC)
+		return 0;
+
+	crc_cpuid(CPUID_BASIC, regs);
+	return regs[2];
+}
+
+/** Carry-less multiplication of selected halves, result in @a a. */
+#define CLMUL(a, b, imm) \
+	asm ("pclmulqdq $" #imm ", %1, %0\n" : "+x" (a) : "x" (b))
+
+/** Shift right by @a imm bytes. */
+#define PSRLDQ(a, imm) \
+	asm ("psrldq $" #imm ", %0\n" : "+x" (a))
+
+static inline crc_vec_t crc_load(const uint8_t *data)
+{
+	crc_vec_t vec;
+
+	memcpy(&vec, data, sizeof(vec));
+	return vec;
+}
+
+/** Fold 128 bits forward by the distance given by @a k. */
+static inline crc_vec_t crc_fold(crc_vec_t x, crc_vec_t k)
+{
+	crc_vec_t hi = x;
+
+	CLMUL(x, k, 0x00);
+	CLMUL(hi, k, 0x11);
+	return x ^ hi;
+}
+
+static uint32_t crc32_pclmul(uint32_t crc, const uint8_t *data, size_t len)
+{
+	crc_vec_t x0, x1, x2, x3, t;
+
+	if (len < CRC_FOLD_MIN)
+		return __crc32_sw(crc, data, len);
+
+	x0 = crc_load(data) ^ (crc_vec_t) { crc, 0 };
+	x1 = crc_load(data + 16);
+	x2 = crc_load(data + 32);
+	x3 = crc_load(data + 48);
+	data += 64;
+	len -= 64;
+
+	while (len >= 64) {
+		x0 = crc_fold(x0, crc32_k1k2) ^ crc_load(data);
+		x1 = crc_fold(x1, crc32_k1k2) ^ crc_load(data + 16);
+		x2 = crc_fold(x2, crc32_k1k2) ^ crc_load(data + 32);
+		x3 = crc_fold(x3, crc32_k1k2) ^ crc_load(data + 48);
+		data += 64;
+		len -= 64;
+	}
+
+	x0 = crc_fold(x0, crc32_k3k4) ^ x1;
+	x0 = crc_fold(x0, crc32_k3k4) ^ x2;
+	x0 = crc_fold(x0, crc32_k3k4) ^ x3;
+
+	while (len >= 16) {
+		x0 = crc_fold(x0, crc32_k3k4) ^ crc_load(data);
+		data += 16;
+		len -= 16;
+	}
+
+	/* Fold 128 bits to 64, appending 32 zero bits */
+	t = crc32_k3k4;
+	CLMUL(t, x0, 0x01);
+	PSRLDQ(x0, 8);
+	x0 ^= t;
+
+	/* Fold 64 bits to 32 */
+	t = x0 & crc32_mask32;
+	CLMUL(t, crc32_k5, 0x00);
+	PSRLDQ(x0, 4);
+	x0 ^= t;
+
+	/* Barrett reduction */
+	t = x0 & crc32_mask32;
+	CLMUL(t, crc32_poly, 0x10);
+	t &= crc32_mask32;
+	CLMUL(t, crc32_poly, 0x00);
+	x0 ^= t;
+
+	crc = x0[0] >> 32;
+
+	return __crc32_sw(crc, data, len);
+}
+
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *data, size_t len)
+{
+	uint64_t crc64 = crc;
+
+	while (len > 0 && ((uintptr_t) data & 7) != 0) {
+		asm ("crc32b %1, %k0\n" : "+r" (crc64) : "rm" (*data));
+		data++;
+		len--;
+	}
+
+	while (len >= 8) {
+		uint64_t word;
+
+		memcpy(&word, data, sizeof(word));
+		asm ("crc32q %1, %0\n" : "+r" (crc64) : "rm" (word));
+		data += 8;
+		len -= 8;
+	}
+
+	while (len-- > 0) {
+		asm ("crc32b %1, %k0\n" : "+r" (crc64) : "rm" (*data));
+		data++;
+	}
+
+	return crc64;
+}
+
+crc_update_t __crc32_hw(void)
+{
+	return (crc_features() & CPUID_PCLMULQDQ) != 0 ? crc32_pclmul : NULL;
+}
+
+crc_update_t __crc32c_hw(void)
+{
+	return (crc_features() & CPUID_SSE42) != 0 ? crc32c_sse42 : NULL;
+}
+
+/** @}
+ */
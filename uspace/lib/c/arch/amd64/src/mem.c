@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Memory string functions optimized for amd64.
+ *
+ * Copies and fills use the string instructions, which are the fastest
+ * option on processors with Enhanced REP MOVSB/STOSB (ERMS). Blocks larger
+ * than the last-level cache are written with non-temporal stores so that
+ * they do not evict the whole cache. The variants are selected at libc
+ * initialization.
+ *
+ * Vector registers are not used, since the kernel only preserves the
+ * legacy SSE state of threads.
+ */
+
+#include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../../generic/private/libc.h"
+
+/** Without ERMS, shorter blocks are still copied byte by byte. */
+#define MEM_SMALL  64
+
+/** Size of the last-level cache assumed if it cannot be determined. */
+#define MEM_LLC_DEFAULT  (4 * 1024 * 1024)
+
+#define CPUID_LEVEL     0x00000000
+#define CPUID_CACHE     0x00000004
+#define CPUID_FEATURES  0x00000007
+#define CPUID_EXTENDED  0x80000000
+#define CPUID_AMD_CACHE 0x80000006
+
+/** Enhanced REP MOVSB/STOSB in EBX of CPUID_FEATURES */
+#define CPUID_ERMS  (1 << 9)
+
+/** Processor supports Enhanced REP MOVSB/STOSB. */
+static bool mem_erms = false;
+
+/** Blocks of at least this size bypass the cache. */
+static size_t mem_nt_threshold = SIZE_MAX;
+
+typedef struct {
+	uint64_t val;
+} __attribute__((packed)) mem_unaligned_t;
+
+static inline void mem_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *regs)
+{
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	    : "a" (leaf), "c" (subleaf)
+	);
+}
+
+/** Determine the size of the largest data or unified cache. */
+static size_t mem_llc_size(uint32_t max_level)
+{
+	uint32_t regs[4];
+	size_t llc = 0;
+
+	if (max_level >= CPUID_CACHE) {
+		for (uint32_t i = 0; i < 16; i++) {
+			mem_cpuid(CPUID_CACHE, i, regs);
+
+			uint32_t type = regs[0] & 0x1f;
+			if (type == 0)
+				break;
+
+			/* Skip instruction caches. */
+			if (type == 2)
+				continue;
+
+			size_t ways = (regs[1] >> 22) + 1;
+			size_t parts = ((regs[1] >> 12) & 0x3ff) + 1;
+			size_t line = (regs[1] & 0xfff) + 1;
+			size_t sets = (size_t) regs[2] + 1;
+
+			if (ways * parts * line * sets > llc)
+				llc = ways * parts * line * sets;
+		}
+	}
+
+	if (llc == 0) {
+		/* AMD reports the L3 size in units of 512 KiB. */
+		mem_cpuid(CPUID_EXTENDED, 0, regs);
+		if (regs[0] >= CPUID_AMD_CACHE) {
+			mem_cpuid(CPUID_AMD_CACHE, 0, regs);
+			llc = (size_t) (regs[3] >> 18) * 512 * 1024;
+			if (llc == 0)
+				llc = (size_t) (regs[2] >> 16) * 1024;
+		}
+	}
+
+	return (llc != 0) ? llc : MEM_LLC_DEFAULT;
+}
+
+/** Select the memory string function variants for the processor. */
+void __mem_init(void)
+{
+	uint32_t regs[4];
+
+	mem_cpuid(CPUID_LEVEL, 0, regs);
+	uint32_t max_level = regs[0];
+
+	if (max_level >= CPUID_FEATURES) {
+		mem_cpuid(CPUID_FEATURES, 0, regs);
+		mem_erms = (regs[1] & CPUID_ERMS) != 0;
+	}
+
+	mem_nt_threshold = mem_llc_size(max_level);
+}
+
+/** Copy bytes with the string instruction. */
+static inline void mem_movsb(uint8_t **dp, const uint8_t **sp, size_t n)
+{
+	asm volatile (
+	    "rep movsb\n"
+	    : "+D" (*dp), "+S" (*sp), "+c" (n)
+	    :
+	    : "memory"
+	);
+}
+
+/** Fill bytes with the string instruction. */
+static inline void mem_stosb(uint8_t **dp, uint8_t b, size_t n)
+{
+	asm volatile (
+	    "rep stosb\n"
+	    : "+D" (*dp), "+c" (n)
+	    : "a" (b)
+	    : "memory"
+	);
+}
+
+/** Copy a block using non-temporal stores. */
+static void memcpy_nt(uint8_t *dp, const uint8_t *sp, size_t n)
+{
+	size_t head = (-(uintptr_t) dp) & 7;
+
+	mem_movsb(&dp, &sp, head);
+	n -= head;
+
+	uint64_t *dw = (uint64_t *) dp;
+	const mem_unaligned_t *sw = (const mem_unaligned_t *) sp;
+	size_t words = n / 8;
+
+	for (size_t i = 0; i < words; i++) {
+		asm volatile (
+		    "movnti %[val], %[dst]\n"
+		    : [dst] "=m" (dw[i])
+		    : [val] "r" (sw[i].val)
+		);
+	}
+
+	asm volatile ("sfence\n" ::: "memory");
+
+	dp = (uint8_t *) (dw + words);
+	sp = (const uint8_t *) (sw + words);
+	mem_movsb(&dp, &sp, n % 8);
+}
+
+/** Fill a block using non-temporal stores. */
+static void memset_nt(uint8_t *dp, uint8_t b, size_t n)
+{
+	size_t head = (-(uintptr_t) dp) & 7;
+
+	mem_stosb(&dp, b, head);
+	n -= head;
+
+	uint64_t *dw = (uint64_t *) dp;
+	uint64_t pattern = b * UINT64_C(0x0101010101010101);
+	size_t words = n / 8;
+
+	for (size_t i = 0; i < words; i++) {
+		asm volatile (
+		    "movnti %[val], %[dst]\n"
+		    : [dst] "=m" (dw[i])
+		    : [val] "r" (pattern)
+		);
+	}
+
+	asm volatile ("sfence\n" ::: "memory");
+
+	dp = (uint8_t *) (dw + words);
+	mem_stosb(&dp, b, n % 8);
+}
+
+/** Fill memory block with a constant value. */
+void *memset(void *dest, int b, size_t n)
+{
+	uint8_t *dp = dest;
+
+	if (n >= mem_nt_threshold) {
+		memset_nt(dp, b, n);
+		return dest;
+	}
+
+	if ((!mem_erms) && (n >= MEM_SMALL)) {
+		uint64_t pattern = (uint8_t) b * UINT64_C(0x0101010101010101);
+		size_t words = n / 8;
+
+		asm volatile (
+		    "rep stosq\n"
+		    : "+D" (dp), "+c" (words)
+		    : "a" (pattern)
+		    : "memory"
+		);
+
+		n %= 8;
+	}
+
+	mem_stosb(&dp, b, n);
+	return dest;
+}
+
+/** Copy memory block. */
+void *memcpy(void *dst, const void *src, size_t n)
+{
+	uint8_t *dp = dst;
+	const uint8_t *sp = src;
+
+	if (n >= mem_nt_threshold) {
+		memcpy_nt(dp, sp, n);
+		return dst;
+	}
+
+	if ((!mem_erms) && (n >= MEM_SMALL)) {
+		size_t words = n / 8;
+
+		asm volatile (
+		    "rep movsq\n"
+		    : "+D" (dp), "+S" (sp), "+c" (words)
+		    :
+		    : "memory"
+		);
+
+		n %= 8;
+	}
+
+	mem_movsb(&dp, &sp, n);
+	return dst;
+}
+
+/** @}
+ */
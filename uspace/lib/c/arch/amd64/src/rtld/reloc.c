@@ -39,6 +39,7 @@
 #include <stdlib.h>
 
 #include <libarch/rtld/elf_dyn.h>
+#include <libarch/rtld/module.h>
 #include <rtld/symbol.h>
 #include <rtld/rtld.h>
 #include <rtld/rtld_debug.h>
@@ -49,6 +50,76 @@ void module_process_pre_arch(module_t *m)
 	/* Unused */
 }
 
+/** Set up lazy binding of PLT entries.
+ *
+ * PLT0 pushes GOT[1] and jumps to GOT[2]. We store the module pointer
+ * and the address of the resolver trampoline there. The GOT slots of
+ * the individual functions initially point back into the PLT (to the
+ * instruction following the indirect jump), so they only need to be
+ * adjusted by the load bias.
+ *
+ * @param m Module
+ * @return @c true on success, @c false if the PLT needs to be bound eagerly
+ */
+bool plt_lazy_setup_arch(module_t *m)
+{
+	elf_rela_t *rt = m->dyn.jmp_rel;
+	size_t rt_entries;
+	uintptr_t *got;
+	size_t i;
+
+	got = m->dyn.plt_got;
+	if (got == NULL || m->dyn.plt_rel != DT_RELA)
+		return false;
+
+	rt_entries = m->dyn.plt_rel_sz / sizeof(elf_rela_t);
+
+	/* Only plain JUMP_SLOT relocations can be deferred */
+	for (i = 0; i < rt_entries; i++) {
+		if (ELF64_R_TYPE(rt[i].r_info) != R_X86_64_JUMP_SLOT)
+			return false;
+	}
+
+	got[1] = (uintptr_t) m;
+	got[2] = m->rtld->plt_trampoline;
+
+	for (i = 0; i < rt_entries; i++)
+		*(uintptr_t *) (rt[i].r_offset + m->bias) += m->bias;
+
+	return true;
+}
+
+/** Resolve a lazily bound PLT entry.
+ *
+ * Called by the resolver trampoline on the first call through a PLT entry.
+ *
+ * @param m Module whose PLT entry is being resolved
+ * @param idx Index of the relocation in the module's PLT relocation table
+ * @return Address of the function, also stored to the GOT slot
+ */
+void *plt_resolve(module_t *m, size_t idx)
+{
+	elf_rela_t *rela = (elf_rela_t *) m->dyn.jmp_rel + idx;
+	elf_symbol_t *sym;
+	elf_symbol_t *sym_def;
+	module_t *dest;
+	uintptr_t sym_addr;
+
+	sym = (elf_symbol_t *) m->dyn.sym_tab + ELF64_R_SYM(rela->r_info);
+	sym_def = symbol_def_find(m->dyn.str_tab + sym->st_name, m, ssf_none,
+	    &dest);
+	if (sym_def == NULL) {
+		printf("Definition of '%s' not found.\n",
+		    m->dyn.str_tab + sym->st_name);
+		abort();
+	}
+
+	sym_addr = (uintptr_t) symbol_get_addr(sym_def, dest, NULL);
+	*(uintptr_t *) (rela->r_offset + m->bias) = sym_addr;
+
+	return (void *) sym_addr;
+}
+
 /**
  * Process (fixup) all relocations in a relocation table with implicit addends.
  */
@@ -52,6 +52,15 @@ void module_process_pre_arch(module_t *m)
 	/* Unused */
 }
 
+/** Set up lazy binding of PLT entries.
+ *
+ * Not supported on this architecture, PLT entries are bound eagerly.
+ */
+bool plt_lazy_setup_arch(module_t *m)
+{
+	return false;
+}
+
 /**
  * Process (fixup) all relocations in a relocation table.
  */
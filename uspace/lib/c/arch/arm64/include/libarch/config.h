@@ -39,6 +39,12 @@
 #define PAGE_WIDTH  12
 #define PAGE_SIZE   (1 << PAGE_WIDTH)
 
+/** memset() and memcpy() are provided by arch/arm64/src/mem.c. */
+#define ARCH_HAS_MEMFNC
+
+/** Hardware CRC32 and CRC32C are provided by arch/arm64/src/checksum.c. */
+#define ARCH_HAS_CRC32
+
 #endif
 
 /** @}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file CRC computation accelerated for arm64.
+ *
+ * The optional CRC32 extension of ARMv8.0 provides instructions for both
+ * the IEEE 802.3 and the Castagnoli polynomials. The kernel reports its
+ * presence in the "cpu.crc32" sysinfo item.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <mem.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sysinfo.h>
+#include "../../../generic/private/checksum.h"
+
+static bool crc_supported(void)
+{
+	sysarg_t crc32;
+
+	if (sysinfo_get_value("cpu.crc32", &crc32) != EOK)
+		return false;
+
+	return crc32 != 0;
+}
+
+/*
+ * Both instruction families share the same loop; @a sfx selects between
+ * crc32x/crc32b and crc32cx/crc32cb.
+ */
+#define CRC_ARM_LOOP(sfx) \
+	do { \
+		while (len > 0 && ((uintptr_t) data & 7) != 0) { \
+			asm ("crc32" sfx "b %w0, %w0, %w1\n" \
+			    : "+r" (crc) : "r" ((uint32_t) *data)); \
+			data++; \
+			len--; \
+		} \
+		while (len >= 8) { \
+			uint64_t word; \
+			memcpy(&word, data, sizeof(word)); \
+			asm ("crc32" sfx "x %w0, %w0, %x1\n" \
+			    : "+r" (crc) : "r" (word)); \
+			data += 8; \
+			len -= 8; \
+		} \
+		while (len-- > 0) { \
+			asm ("crc32" sfx "b %w0, %w0, %w1\n" \
+			    : "+r" (crc) : "r" ((uint32_t) *data)); \
+			data++; \
+		} \
+	} while (0)
+
+__attribute__((target("+crc")))
+static uint32_t crc32_arm(uint32_t crc, const uint8_t *data, size_t len)
+{
+	CRC_ARM_LOOP("");
+	return crc;
+}
+
+__attribute__((target("+crc")))
+static uint32_t crc32c_arm(uint32_t crc, const uint8_t *data, size_t len)
+{
+	CRC_ARM_LOOP("c");
+	return crc;
+}
+
+crc_update_t __crc32_hw(void)
+{
+	return crc_supported() ? crc32_arm : NULL;
+}
+
+crc_update_t __crc32c_hw(void)
+{
+	return crc_supported() ? crc32c_arm : NULL;
+}
+
+/** @}
+ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Memory string functions optimized for arm64.
+ *
+ * Aligned blocks are moved in pairs of 64-bit registers, which the
+ * compiler turns into LDP/STP. Blocks larger than the typical last-level
+ * cache are written with the non-temporal STNP so that they do not evict
+ * the whole cache. The cache geometry is not visible to user space, hence
+ * the fixed threshold.
+ *
+ * SIMD registers are not used, so the functions are safe to call in any
+ * context.
+ */
+
+#include <mem.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "../../../generic/private/cc.h"
+#include "../../../generic/private/libc.h"
+
+/** Blocks of at least this size bypass the cache. */
+#define MEM_NT_THRESHOLD  (8 * 1024 * 1024)
+
+/** Copy a block of 16-byte aligned pairs using non-temporal stores. */
+static void memcpy_pairs_nt(uint64_t *dw, const uint64_t *sw, size_t pairs)
+{
+	for (size_t i = 0; i < pairs; i++) {
+		uint64_t a = sw[2 * i];
+		uint64_t b = sw[2 * i + 1];
+
+		asm volatile (
+		    "stnp %[a], %[b], [%[dst]]\n"
+		    :
+		    : [a] "r" (a), [b] "r" (b), [dst] "r" (&dw[2 * i])
+		    : "memory"
+		);
+	}
+}
+
+/** Fill a block of 16-byte aligned pairs using non-temporal stores. */
+static void memset_pairs_nt(uint64_t *dw, uint64_t pattern, size_t pairs)
+{
+	for (size_t i = 0; i < pairs; i++) {
+		asm volatile (
+		    "stnp %[a], %[a], [%[dst]]\n"
+		    :
+		    : [a] "r" (pattern), [dst] "r" (&dw[2 * i])
+		    : "memory"
+		);
+	}
+}
+
+/** Fill memory block with a constant value. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memset(void *dest, int b, size_t n)
+{
+	uint8_t *dp = dest;
+
+	/* Fill up to the first 16-byte boundary. */
+	while ((n > 0) && (((uintptr_t) dp & 15) != 0)) {
+		*dp++ = b;
+		n--;
+	}
+
+	uint64_t *dw = (uint64_t *) dp;
+	uint64_t pattern = (uint8_t) b * UINT64_C(0x0101010101010101);
+	size_t pairs = n / 16;
+
+	if (n >= MEM_NT_THRESHOLD) {
+		memset_pairs_nt(dw, pattern, pairs);
+	} else {
+		for (size_t i = 0; i < pairs; i++) {
+			dw[2 * i] = pattern;
+			dw[2 * i + 1] = pattern;
+		}
+	}
+
+	dp = (uint8_t *) (dw + 2 * pairs);
+	n %= 16;
+
+	while (n-- > 0)
+		*dp++ = b;
+
+	return dest;
+}
+
+/** Copy memory block. */
+ATTRIBUTE_OPTIMIZE_NO_TLDP
+    void *memcpy(void *dst, const void *src, size_t n)
+{
+	uint8_t *dp = dst;
+	const uint8_t *sp = src;
+
+	/*
+	 * Blocks which cannot be aligned together are copied byte by byte,
+	 * so that no unaligned accesses are made.
+	 */
+	if ((((uintptr_t) dp ^ (uintptr_t) sp) & 15) == 0) {
+		while ((n > 0) && (((uintptr_t) dp & 15) != 0)) {
+			*dp++ = *sp++;
+			n--;
+		}
+
+		uint64_t *dw = (uint64_t *) dp;
+		const uint64_t *sw = (const uint64_t *) sp;
+		size_t pairs = n / 16;
+
+		if (n >= MEM_NT_THRESHOLD) {
+			memcpy_pairs_nt(dw, sw, pairs);
+		} else {
+			for (size_t i = 0; i < pairs; i++) {
+				uint64_t a = sw[2 * i];
+				uint64_t b = sw[2 * i + 1];
+				dw[2 * i] = a;
+				dw[2 * i + 1] = b;
+			}
+		}
+
+		dp = (uint8_t *) (dw + 2 * pairs);
+		sp = (const uint8_t *) (sw + 2 * pairs);
+		n %= 16;
+	} else if ((((uintptr_t) dp ^ (uintptr_t) sp) & 7) == 0) {
+		while ((n > 0) && (((uintptr_t) dp & 7) != 0)) {
+			*dp++ = *sp++;
+			n--;
+		}
+
+		uint64_t *dw = (uint64_t *) dp;
+		const uint64_t *sw = (const uint64_t *) sp;
+		size_t words = n / 8;
+
+		for (size_t i = 0; i < words; i++)
+			dw[i] = sw[i];
+
+		dp = (uint8_t *) (dw + words);
+		sp = (const uint8_t *) (sw + words);
+		n %= 8;
+	}
+
+	while (n-- > 0)
+		*dp++ = *sp++;
+
+	return dst;
+}
+
+/** Nothing to select, the functions do not depend on processor features. */
+void __mem_init(void)
+{
+}
+
+/** @}
+ */
@@ -46,6 +46,13 @@
  * have fairly large (prime/odd) divisors. Having a prime table size
  * mitigates the use of suboptimal hash functions and distributes
  * items over the whole table.
+ *
+ * Resizing is incremental. The new bucket array replaces the old one
+ * right away, but items are migrated from the old array only a few
+ * buckets at a time on subsequent insertions and removals, so that no
+ * single operation has to rehash the whole table. An item lives in the
+ * old array as long as its old bucket has not been migrated yet, which
+ * keeps all items with the same hash on a single chain.
  */
 
 #include <adt/hash_table.h>
@@ -59,11 +66,15 @@
 #define HT_MIN_BUCKETS  89
 /* The table is resized when the average load per bucket exceeds this number. */
 #define HT_MAX_LOAD     2
+/* Number of old buckets migrated by each insertion or removal. */
+#define HT_REHASH_STEP  4
 
 static size_t round_up_size(size_t);
 static bool alloc_table(size_t, list_t **);
 static void clear_items(hash_table_t *);
 static void resize(hash_table_t *, size_t);
+static void rehash_step(hash_table_t *, size_t);
+static void rehash_finish(hash_table_t *);
 static void grow_if_needed(hash_table_t *);
 static void shrink_if_needed(hash_table_t *);
 
@@ -104,6 +115,10 @@ bool hash_table_create(hash_table_t *h, size_t init_size, size_t max_load,
 	if (!alloc_table(h->bucket_cnt, &h->bucket))
 		return false;
 
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
+	h->rehash_idx = 0;
+
 	h->max_load = (max_load == 0) ? HT_MAX_LOAD : max_load;
 	h->item_cnt = 0;
 	h->op = op;
@@ -130,9 +145,12 @@ void hash_table_destroy(hash_table_t *h)
 	clear_items(h);
 
 	free(h->bucket);
+	free(h->old_bucket);
 
 	h->bucket = NULL;
 	h->bucket_cnt = 0;
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
 }
 
 /** Returns true if there are no items in the table. */
@@ -159,6 +177,7 @@ void hash_table_clear(hash_table_t *h)
 	assert(!h->apply_ongoing);
 
 	clear_items(h);
+	rehash_finish(h);
 
 	/* Shrink the table to its minimum size if possible. */
 	if (HT_MIN_BUCKETS < h->bucket_cnt) {
@@ -166,14 +185,12 @@ void hash_table_clear(hash_table_t *h)
 	}
 }
 
-/** Unlinks and removes all items but does not resize. */
-static void clear_items(hash_table_t *h)
+/** Unlinks and removes all items of a bucket array. */
+static void clear_buckets(hash_table_t *h, list_t *buckets, size_t first,
+    size_t cnt)
 {
-	if (h->item_cnt == 0)
-		return;
-
-	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
-		list_foreach_safe(h->bucket[idx], cur, next) {
+	for (size_t idx = first; idx < cnt; ++idx) {
+		list_foreach_safe(buckets[idx], cur, next) {
 			assert(cur);
 			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 
@@ -181,10 +198,36 @@ static void clear_items(hash_table_t *h)
 			h->op->remove_callback(cur_link);
 		}
 	}
+}
 
+/** Unlinks and removes all items but does not resize. */
+static void clear_items(hash_table_t *h)
+{
+	if (h->item_cnt == 0)
+		return;
+
+	if (h->old_bucket != NULL) {
+		clear_buckets(h, h->old_bucket, h->rehash_idx,
+		    h->old_bucket_cnt);
+	}
+
+	clear_buckets(h, h->bucket, 0, h->bucket_cnt);
 	h->item_cnt = 0;
 }
 
+/** Returns the chain holding items with the given hash. */
+static list_t *hash_bucket(const hash_table_t *h, size_t hash)
+{
+	if (h->old_bucket != NULL) {
+		size_t old_idx = hash % h->old_bucket_cnt;
+
+		if (old_idx >= h->rehash_idx)
+			return &h->old_bucket[old_idx];
+	}
+
+	return &h->bucket[hash % h->bucket_cnt];
+}
+
 /** Insert item into a hash table.
  *
  * @param h    Hash table.
@@ -196,9 +239,9 @@ void hash_table_insert(hash_table_t *h, ht_link_t *item)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	rehash_step(h, HT_REHASH_STEP);
 
-	list_append(&item->link, &h->bucket[idx]);
+	list_append(&item->link, hash_bucket(h, h->op->hash(item)));
 	++h->item_cnt;
 	grow_if_needed(h);
 }
@@ -218,10 +261,12 @@ bool hash_table_insert_unique(hash_table_t *h, ht_link_t *item)
 	assert(h->op && h->op->hash && h->op->equal);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	rehash_step(h, HT_REHASH_STEP);
+
+	list_t *bucket = hash_bucket(h, h->op->hash(item));
 
 	/* Check for duplicates. */
-	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
+	list_foreach(*bucket, link, ht_link_t, cur_link) {
 		/*
 		 * We could filter out items using their hashes first, but
 		 * calling equal() might very well be just as fast.
@@ -230,7 +275,7 @@ bool hash_table_insert_unique(hash_table_t *h, ht_link_t *item)
 			return false;
 	}
 
-	list_append(&item->link, &h->bucket[idx]);
+	list_append(&item->link, bucket);
 	++h->item_cnt;
 	grow_if_needed(h);
 
@@ -249,9 +294,9 @@ ht_link_t *hash_table_find(const hash_table_t *h, const void *key)
 {
 	assert(h && h->bucket);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	list_t *bucket = hash_bucket(h, h->op->key_hash(key));
 
-	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
+	list_foreach(*bucket, link, ht_link_t, cur_link) {
 		/*
 		 * Is this is the item we are looking for? We could have first
 		 * checked if the hashes match but op->key_equal() may very well be
@@ -272,14 +317,14 @@ hash_table_find_next(const hash_table_t *h, ht_link_t *first, ht_link_t *item)
 	assert(item);
 	assert(h && h->bucket);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	list_t *bucket = hash_bucket(h, h->op->hash(item));
 
 	/* Traverse the circular list until we reach the starting item again. */
 	for (link_t *cur = item->link.next; cur != &first->link;
 	    cur = cur->next) {
 		assert(cur);
 
-		if (cur == &h->bucket[idx].head)
+		if (cur == &bucket->head)
 			continue;
 
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
@@ -311,11 +356,12 @@ size_t hash_table_remove(hash_table_t *h, const void *key)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	rehash_step(h, HT_REHASH_STEP);
 
+	list_t *bucket = hash_bucket(h, h->op->key_hash(key));
 	size_t removed = 0;
 
-	list_foreach_safe(h->bucket[idx], cur, next) {
+	list_foreach_safe(*bucket, cur, next) {
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 
 		if (h->op->key_equal(key, cur_link)) {
@@ -338,6 +384,10 @@ void hash_table_remove_item(hash_table_t *h, ht_link_t *item)
 	assert(h && h->bucket);
 	assert(link_in_use(&item->link));
 
+	/* Migration would disturb a hash_table_apply() in progress. */
+	if (!h->apply_ongoing)
+		rehash_step(h, HT_REHASH_STEP);
+
 	list_remove(&item->link);
 	--h->item_cnt;
 	h->op->remove_callback(item);
@@ -363,6 +413,18 @@ void hash_table_apply(hash_table_t *h, bool (*f)(ht_link_t *, void *), void *arg
 
 	h->apply_ongoing = true;
 
+	if (h->old_bucket != NULL) {
+		for (size_t idx = h->rehash_idx; idx < h->old_bucket_cnt;
+		    ++idx) {
+			list_foreach_safe(h->old_bucket[idx], cur, next) {
+				ht_link_t *cur_link = member_to_inst(cur,
+				    ht_link_t, link);
+				if (!f(cur_link, arg))
+					goto out;
+			}
+		}
+	}
+
 	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
 		list_foreach_safe(h->bucket[idx], cur, next) {
 			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
@@ -433,7 +495,48 @@ static inline void grow_if_needed(hash_table_t *h)
 	}
 }
 
-/** Allocates and rehashes items to a new table. Frees the old table. */
+/** Migrates up to @a steps buckets of the old table to the new one.
+ *
+ * Frees the old table once all of its buckets have been migrated.
+ */
+static void rehash_step(hash_table_t *h, size_t steps)
+{
+	if (h->old_bucket == NULL)
+		return;
+
+	while (steps > 0 && h->rehash_idx < h->old_bucket_cnt) {
+		list_foreach_safe(h->old_bucket[h->rehash_idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			size_t new_idx = h->op->hash(cur_link) % h->bucket_cnt;
+			list_remove(cur);
+			list_append(cur, &h->bucket[new_idx]);
+		}
+
+		++h->rehash_idx;
+		--steps;
+	}
+
+	if (h->rehash_idx == h->old_bucket_cnt) {
+		free(h->old_bucket);
+		h->old_bucket = NULL;
+		h->old_bucket_cnt = 0;
+		h->rehash_idx = 0;
+	}
+}
+
+/** Completes a migration under way, if any. */
+static void rehash_finish(hash_table_t *h)
+{
+	if (h->old_bucket != NULL)
+		rehash_step(h, h->old_bucket_cnt);
+}
+
+/** Allocates a new table and starts migrating items to it.
+ *
+ * Any migration under way is completed first, so that there are never
+ * more than two bucket arrays.
+ */
 static void resize(hash_table_t *h, size_t new_bucket_cnt)
 {
 	assert(h && h->bucket);
@@ -449,23 +552,18 @@ static void resize(hash_table_t *h, size_t new_bucket_cnt)
 	if (!alloc_table(new_bucket_cnt, &new_buckets))
 		return;
 
-	if (0 < h->item_cnt) {
-		/* Rehash all the items to the new table. */
-		for (size_t old_idx = 0; old_idx < h->bucket_cnt; ++old_idx) {
-			list_foreach_safe(h->bucket[old_idx], cur, next) {
-				ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+	rehash_finish(h);
 
-				size_t new_idx = h->op->hash(cur_link) % new_bucket_cnt;
-				list_remove(cur);
-				list_append(cur, &new_buckets[new_idx]);
-			}
-		}
-	}
-
-	free(h->bucket);
+	h->old_bucket = h->bucket;
+	h->old_bucket_cnt = h->bucket_cnt;
+	h->rehash_idx = 0;
 	h->bucket = new_buckets;
 	h->bucket_cnt = new_bucket_cnt;
 	h->full_item_cnt = h->max_load * h->bucket_cnt;
+
+	/* An empty table has nothing to migrate. */
+	if (h->item_cnt == 0)
+		rehash_finish(h);
 }
 
 /** @}
@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+/*
+ * This is an implementation of an open-addressing hash table with linear
+ * probing. Slots hold the item pointer and the cached hash of its key,
+ * so a lookup scans a contiguous run of slots and only calls key_equal()
+ * for items whose hash matches. Removal shifts the following items of the
+ * probe run back instead of leaving tombstones, thus lookups never slow
+ * down with the number of removals. The only exception are removals made
+ * from within hash_table_oa_apply(), which are compacted when it returns.
+ *
+ * This table is best suited for small keys which map to few items each.
+ * It uses the same hash_table_ops_t and ht_link_t as the chained hash
+ * table, so switching a table between the two implementations only
+ * requires changing the calls.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table_oa.h>
+#include <assert.h>
+#include <stdlib.h>
+
+/* Initial and minimal number of slots. */
+#define HT_OA_MIN_SLOTS  16
+
+/* The table grows when more than HT_OA_LOAD_NUM / HT_OA_LOAD_DEN is used. */
+#define HT_OA_LOAD_NUM  3
+#define HT_OA_LOAD_DEN  4
+
+/* Marks slots of items removed while hash_table_oa_apply() is running. */
+static ht_link_t dead_item;
+#define HT_OA_DEAD  (&dead_item)
+
+static bool resize(hash_table_oa_t *, size_t);
+
+/* Dummy do nothing callback to invoke in place of remove_callback == NULL. */
+static void nop_remove_callback(ht_link_t *item)
+{
+	/* no-op */
+}
+
+/** Returns the preferred slot of an item with the given hash. */
+static inline size_t home_slot(const hash_table_oa_t *h, size_t hash)
+{
+	return hash_mix(hash) & (h->slot_cnt - 1);
+}
+
+/** Returns the slot following @a idx in the probe sequence. */
+static inline size_t next_slot(const hash_table_oa_t *h, size_t idx)
+{
+	return (idx + 1) & (h->slot_cnt - 1);
+}
+
+/** Allocates an empty slot array. True if successful. */
+static bool alloc_slots(size_t slot_cnt, hash_table_oa_slot_t **pslots)
+{
+	hash_table_oa_slot_t *slots = calloc(slot_cnt,
+	    sizeof(hash_table_oa_slot_t));
+	if (!slots)
+		return false;
+
+	*pslots = slots;
+	return true;
+}
+
+/** Create open-addressing hash table.
+ *
+ * @param h        Hash table structure. Will be initialized by this call.
+ * @param init_size Initial desired number of items the table can hold
+ *                 without growing. Pass zero if you want the default.
+ * @param op       Hash table operations structure. Same requirements as
+ *                 for hash_table_create() apply.
+ *
+ * @return True on success
+ *
+ */
+bool hash_table_oa_create(hash_table_oa_t *h, size_t init_size,
+    hash_table_ops_t *op)
+{
+	assert(h);
+	assert(op && op->hash && op->key_hash && op->key_equal);
+
+	/* Check for compulsory ops. */
+	if (!op || !op->hash || !op->key_hash || !op->key_equal)
+		return false;
+
+	h->slot_cnt = HT_OA_MIN_SLOTS;
+	while (h->slot_cnt * HT_OA_LOAD_NUM / HT_OA_LOAD_DEN < init_size)
+		h->slot_cnt *= 2;
+
+	if (!alloc_slots(h->slot_cnt, &h->slot))
+		return false;
+
+	h->item_cnt = 0;
+	h->dead_cnt = 0;
+	h->op = op;
+	h->apply_ongoing = false;
+
+	if (h->op->remove_callback == NULL) {
+		h->op->remove_callback = nop_remove_callback;
+	}
+
+	return true;
+}
+
+/** Destroy a hash table instance.
+ *
+ * @param h Hash table to be destroyed.
+ *
+ */
+void hash_table_oa_destroy(hash_table_oa_t *h)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	hash_table_oa_clear(h);
+
+	free(h->slot);
+
+	h->slot = NULL;
+	h->slot_cnt = 0;
+}
+
+/** Returns true if there are no items in the table. */
+bool hash_table_oa_empty(hash_table_oa_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt == 0;
+}
+
+/** Returns the number of items in the table. */
+size_t hash_table_oa_size(hash_table_oa_t *h)
+{
+	assert(h && h->slot);
+	return h->item_cnt;
+}
+
+/** Remove all elements from the hash table
+ *
+ * @param h Hash table to be cleared
+ */
+void hash_table_oa_clear(hash_table_oa_t *h)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	for (size_t idx = 0; idx < h->slot_cnt; ++idx) {
+		ht_link_t *item = h->slot[idx].item;
+
+		if (item != NULL) {
+			h->slot[idx].item = NULL;
+			h->op->remove_callback(item);
+		}
+	}
+
+	h->item_cnt = 0;
+
+	/* Shrink the table to its minimum size if possible. */
+	if (HT_OA_MIN_SLOTS < h->slot_cnt)
+		(void) resize(h, HT_OA_MIN_SLOTS);
+}
+
+/** Stores an item in the first free slot of its probe sequence. */
+static void place(hash_table_oa_t *h, size_t hash, ht_link_t *item)
+{
+	size_t idx = home_slot(h, hash);
+
+	while (h->slot[idx].item != NULL)
+		idx = next_slot(h, idx);
+
+	h->slot[idx].hash = hash;
+	h->slot[idx].item = item;
+}
+
+/** Empties a slot, moving back the following items of its probe run. */
+static void vacate(hash_table_oa_t *h, size_t idx)
+{
+	size_t next = idx;
+
+	if (h->apply_ongoing) {
+		/* Moving items would make hash_table_oa_apply() miss some. */
+		h->slot[idx].item = HT_OA_DEAD;
+		++h->dead_cnt;
+		return;
+	}
+
+	while (true) {
+		next = next_slot(h, next);
+		if (h->slot[next].item == NULL)
+			break;
+
+		size_t home = home_slot(h, h->slot[next].hash);
+
+		/*
+		 * The item at next can fill the hole at idx unless its home
+		 * lies cyclically within (idx, next].
+		 */
+		bool stays = (idx <= next) ? (idx < home && home <= next) :
+		    (idx < home || home <= next);
+		if (!stays) {
+			h->slot[idx] = h->slot[next];
+			idx = next;
+		}
+	}
+
+	h->slot[idx].item = NULL;
+}
+
+/** Grows the table if table load exceeds the maximum allowed.
+ *
+ * @return False if the table is full and cannot grow.
+ */
+static bool grow_if_needed(hash_table_oa_t *h)
+{
+	if ((h->item_cnt + 1) * HT_OA_LOAD_DEN <=
+	    h->slot_cnt * HT_OA_LOAD_NUM)
+		return true;
+
+	/* Keep at least one slot empty so that probing terminates. */
+	return resize(h, 2 * h->slot_cnt) || (h->item_cnt + 1 < h->slot_cnt);
+}
+
+/** Shrinks the table if the table is only sparsely populated. */
+static void shrink_if_needed(hash_table_oa_t *h)
+{
+	if (h->apply_ongoing || h->slot_cnt <= HT_OA_MIN_SLOTS)
+		return;
+
+	if (h->item_cnt * HT_OA_LOAD_DEN * 4 <= h->slot_cnt * HT_OA_LOAD_NUM)
+		(void) resize(h, h->slot_cnt / 2);
+}
+
+/** Insert item into a hash table.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return False if the table is full and could not grow.
+ */
+bool hash_table_oa_insert(hash_table_oa_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	if (!grow_if_needed(h))
+		return false;
+
+	place(h, h->op->hash(item), item);
+	++h->item_cnt;
+	return true;
+}
+
+/** Insert item into a hash table if not already present.
+ *
+ * @param h    Hash table.
+ * @param item Item to be inserted into the hash table.
+ *
+ * @return False if such an item had already been inserted or if the
+ *         table is full and could not grow.
+ * @return True if the inserted item was the only item with such a lookup key.
+ */
+bool hash_table_oa_insert_unique(hash_table_oa_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+	assert(h->op && h->op->hash && h->op->equal);
+	assert(!h->apply_ongoing);
+
+	size_t hash = h->op->hash(item);
+
+	/* Check for duplicates. */
+	for (size_t idx = home_slot(h, hash); h->slot[idx].item != NULL;
+	    idx = next_slot(h, idx)) {
+		if (h->slot[idx].hash == hash &&
+		    h->op->equal(h->slot[idx].item, item))
+			return false;
+	}
+
+	if (!grow_if_needed(h))
+		return false;
+
+	place(h, hash, item);
+	++h->item_cnt;
+	return true;
+}
+
+/** Search hash table for an item matching keys.
+ *
+ * @param h   Hash table.
+ * @param key Array of all keys needed to compute hash index.
+ *
+ * @return Matching item on success, NULL if there is no such item.
+ *
+ */
+ht_link_t *hash_table_oa_find(const hash_table_oa_t *h, const void *key)
+{
+	assert(h && h->slot);
+
+	size_t hash = h->op->key_hash(key);
+
+	for (size_t idx = home_slot(h, hash); h->slot[idx].item != NULL;
+	    idx = next_slot(h, idx)) {
+		hash_table_oa_slot_t *slot = &h->slot[idx];
+
+		if (slot->hash == hash && slot->item != HT_OA_DEAD &&
+		    h->op->key_equal(key, slot->item))
+			return slot->item;
+	}
+
+	return NULL;
+}
+
+/** Find the next item equal to item.
+ *
+ * @param h     Hash table.
+ * @param first Item returned by hash_table_oa_find().
+ * @param item  Item returned by the previous call.
+ *
+ * @return Next matching item, NULL if there are no more.
+ */
+ht_link_t *hash_table_oa_find_next(const hash_table_oa_t *h, ht_link_t *first,
+    ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+
+	size_t hash = h->op->hash(item);
+	size_t idx = home_slot(h, hash);
+
+	/* Equal items follow each other in the same probe run. */
+	while (h->slot[idx].item != item) {
+		assert(h->slot[idx].item != NULL);
+		idx = next_slot(h, idx);
+	}
+
+	for (idx = next_slot(h, idx); h->slot[idx].item != NULL;
+	    idx = next_slot(h, idx)) {
+		hash_table_oa_slot_t *slot = &h->slot[idx];
+
+		if (slot->hash == hash && slot->item != HT_OA_DEAD &&
+		    h->op->equal(slot->item, item))
+			return slot->item;
+	}
+
+	return NULL;
+}
+
+/** Remove all matching items from hash table.
+ *
+ * For each removed item, h->remove_callback() is called.
+ *
+ * @param h    Hash table.
+ * @param key  Array of keys that will be compared against items of
+ *             the hash table.
+ *
+ * @return Returns the number of removed items.
+ */
+size_t hash_table_oa_remove(hash_table_oa_t *h, const void *key)
+{
+	assert(h && h->slot);
+	assert(!h->apply_ongoing);
+
+	size_t hash = h->op->key_hash(key);
+	size_t idx = home_slot(h, hash);
+	size_t removed = 0;
+
+	while (h->slot[idx].item != NULL) {
+		ht_link_t *item = h->slot[idx].item;
+
+		if (h->slot[idx].hash == hash && h->op->key_equal(key, item)) {
+			/* Another item may have moved into this slot. */
+			vacate(h, idx);
+			++removed;
+			h->op->remove_callback(item);
+		} else {
+			idx = next_slot(h, idx);
+		}
+	}
+
+	h->item_cnt -= removed;
+	shrink_if_needed(h);
+
+	return removed;
+}
+
+/** Removes an item already present in the table. The item must be in the table. */
+void hash_table_oa_remove_item(hash_table_oa_t *h, ht_link_t *item)
+{
+	assert(item);
+	assert(h && h->slot);
+
+	size_t idx = home_slot(h, h->op->hash(item));
+
+	while (h->slot[idx].item != item) {
+		assert(h->slot[idx].item != NULL);
+		idx = next_slot(h, idx);
+	}
+
+	vacate(h, idx);
+	--h->item_cnt;
+	h->op->remove_callback(item);
+	shrink_if_needed(h);
+}
+
+/** Apply function to all items in hash table.
+ *
+ * @param h   Hash table.
+ * @param f   Function to be applied. Return false if no more items
+ *            should be visited. The functor may only delete the supplied
+ *            item.
+ * @param arg Argument to be passed to the function.
+ */
+void hash_table_oa_apply(hash_table_oa_t *h, bool (*f)(ht_link_t *, void *),
+    void *arg)
+{
+	assert(f);
+	assert(h && h->slot);
+
+	if (h->item_cnt == 0)
+		return;
+
+	h->apply_ongoing = true;
+
+	for (size_t idx = 0; idx < h->slot_cnt; ++idx) {
+		ht_link_t *item = h->slot[idx].item;
+
+		if (item == NULL || item == HT_OA_DEAD)
+			continue;
+
+		if (!f(item, arg))
+			break;
+	}
+
+	h->apply_ongoing = false;
+
+	/*
+	 * Purge slots of the items removed by f(). Vacating a slot only moves
+	 * items backwards into it, so rechecking the same slot is enough.
+	 */
+	for (size_t idx = 0; h->dead_cnt > 0 && idx < h->slot_cnt; ++idx) {
+		while (h->slot[idx].item == HT_OA_DEAD) {
+			vacate(h, idx);
+			--h->dead_cnt;
+		}
+	}
+
+	shrink_if_needed(h);
+}
+
+/** Allocates a new slot array and rehashes all items into it.
+ *
+ * @return False if the new array could not be allocated.
+ */
+static bool resize(hash_table_oa_t *h, size_t new_slot_cnt)
+{
+	assert(h && h->slot);
+	assert(HT_OA_MIN_SLOTS <= new_slot_cnt);
+	assert(h->item_cnt < new_slot_cnt);
+	assert(h->dead_cnt == 0);
+
+	hash_table_oa_slot_t *old_slots = h->slot;
+	size_t old_slot_cnt = h->slot_cnt;
+	hash_table_oa_slot_t *new_slots;
+
+	/* Leave the table as is if we cannot resize. */
+	if (!alloc_slots(new_slot_cnt, &new_slots))
+		return false;
+
+	h->slot = new_slots;
+	h->slot_cnt = new_slot_cnt;
+
+	for (size_t idx = 0; idx < old_slot_cnt; ++idx) {
+		if (old_slots[idx].item != NULL)
+			place(h, old_slots[idx].hash, old_slots[idx].item);
+	}
+
+	free(old_slots);
+	return true;
+}
+
+/** @}
+ */
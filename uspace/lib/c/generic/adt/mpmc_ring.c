@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+
+/** @file Bounded lock-free multi-producer multi-consumer ring buffer.
+ *
+ * The algorithm is due to Dmitry Vyukov. Every cell carries a sequence
+ * number. A cell at position @c pos is free for a producer if its sequence
+ * number equals @c pos and holds an item for a consumer if it equals
+ * @c pos + 1. Producers and consumers claim cells by advancing their
+ * respective position with a compare-and-swap and publish them by updating
+ * the sequence number, so that there is no shared lock and the two sides
+ * only meet on the cells themselves.
+ *
+ * Blocking operations (if enabled) sleep on a fibril semaphore and are only
+ * woken up when the other side notices somebody is waiting, so that the
+ * non-blocking fast path never touches the semaphores.
+ */
+
+#include <adt/mpmc_ring.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Initialize ring buffer.
+ *
+ * @param ring Ring buffer
+ * @param capacity Minimum number of items the ring must be able to hold
+ *        (rounded up to a power of two)
+ * @param flags Flags
+ * @return EOK on success, EINVAL if @a capacity is invalid, ENOMEM if out
+ *         of memory
+ */
+errno_t mpmc_ring_initialize(mpmc_ring_t *ring, size_t capacity,
+    mpmc_ring_flags_t flags)
+{
+	size_t cnt = 2;
+	size_t i;
+
+	if (capacity == 0 || capacity > SIZE_MAX / 2 / sizeof(mpmc_ring_cell_t))
+		return EINVAL;
+
+	while (cnt < capacity)
+		cnt <<= 1;
+
+	ring->cell = malloc(cnt * sizeof(mpmc_ring_cell_t));
+	if (ring->cell == NULL)
+		return ENOMEM;
+
+	for (i = 0; i < cnt; i++) {
+		atomic_init(&ring->cell[i].seq, i);
+		ring->cell[i].item = NULL;
+	}
+
+	ring->mask = cnt - 1;
+	ring->flags = flags;
+	atomic_init(&ring->push_pos, 0);
+	atomic_init(&ring->pop_pos, 0);
+	atomic_init(&ring->pop_waiting, 0);
+	atomic_init(&ring->push_waiting, 0);
+	fibril_semaphore_initialize(&ring->not_empty, 0);
+	fibril_semaphore_initialize(&ring->not_full, 0);
+
+	return EOK;
+}
+
+/** Destroy ring buffer.
+ *
+ * The ring must not be used concurrently. Items still in the ring are
+ * not freed.
+ *
+ * @param ring Ring buffer
+ */
+void mpmc_ring_destroy(mpmc_ring_t *ring)
+{
+	free(ring->cell);
+	ring->cell = NULL;
+}
+
+/** Return number of items the ring buffer can hold.
+ *
+ * @param ring Ring buffer
+ * @return Capacity
+ */
+size_t mpmc_ring_capacity(mpmc_ring_t *ring)
+{
+	return ring->mask + 1;
+}
+
+/** Wake up fibrils waiting for the other side of the ring.
+ *
+ * @param ring Ring buffer
+ * @param waiting Number of waiting fibrils
+ * @param sem Semaphore they are waiting on
+ * @param n Number of items or cells that have become available
+ */
+static void mpmc_ring_wakeup(mpmc_ring_t *ring, atomic_int *waiting,
+    fibril_semaphore_t *sem, size_t n)
+{
+	int nwait;
+
+	if ((ring->flags & MPMC_RING_BLOCKING) == 0)
+		return;
+
+	/*
+	 * Pairs with the fence in mpmc_ring_wait(). Either the waiter sees
+	 * our update of the cells or we see it waiting.
+	 */
+	atomic_thread_fence(memory_order_seq_cst);
+	nwait = atomic_load_explicit(waiting, memory_order_relaxed);
+
+	while (nwait > 0 && n > 0) {
+		fibril_semaphore_up(sem);
+		nwait--;
+		n--;
+	}
+}
+
+/** Push up to @a n items to ring buffer without blocking.
+ *
+ * Items are pushed in order. Fewer than @a n items are pushed only if
+ * the ring becomes full.
+ *
+ * @param ring Ring buffer
+ * @param items Items to push
+ * @param n Number of items
+ * @return Number of items actually pushed
+ */
+size_t mpmc_ring_push_batch(mpmc_ring_t *ring, void *const *items, size_t n)
+{
+	mpmc_ring_cell_t *cell;
+	size_t pos, seq, k, i;
+
+	if (n == 0)
+		return 0;
+
+	pos = atomic_load_explicit(&ring->push_pos, memory_order_relaxed);
+	while (true) {
+		/* Count consecutive free cells */
+		seq = pos;
+		for (k = 0; k < n && k <= ring->mask; k++) {
+			cell = &ring->cell[(pos + k) & ring->mask];
+			seq = atomic_load_explicit(&cell->seq,
+			    memory_order_acquire);
+			if (seq != pos + k)
+				break;
+		}
+
+		if (k == 0) {
+			if ((intptr_t) (seq - pos) < 0) {
+				/* Ring is full */
+				return 0;
+			}
+
+			/* Somebody else pushed in the meantime */
+			pos = atomic_load_explicit(&ring->push_pos,
+			    memory_order_relaxed);
+			continue;
+		}
+
+		if (atomic_compare_exchange_weak_explicit(&ring->push_pos,
+		    &pos, pos + k, memory_order_relaxed, memory_order_relaxed))
+			break;
+	}
+
+	/* Cells pos to pos + k - 1 are now ours */
+	for (i = 0; i < k; i++) {
+		cell = &ring->cell[(pos + i) & ring->mask];
+		cell->item = items[i];
+		atomic_store_explicit(&cell->seq, pos + i + 1,
+		    memory_order_release);
+	}
+
+	mpmc_ring_wakeup(ring, &ring->pop_waiting, &ring->not_empty, k);
+	return k;
+}
+
+/** Pop up to @a n items from ring buffer without blocking.
+ *
+ * @param ring Ring buffer
+ * @param items Array to store popped items to
+ * @param n Maximum number of items to pop
+ * @return Number of items actually popped (zero if the ring is empty)
+ */
+size_t mpmc_ring_pop_batch(mpmc_ring_t *ring, void **items, size_t n)
+{
+	mpmc_ring_cell_t *cell;
+	size_t pos, seq, k, i;
+
+	if (n == 0)
+		return 0;
+
+	pos = atomic_load_explicit(&ring->pop_pos, memory_order_relaxed);
+	while (true) {
+		/* Count consecutive full cells */
+		seq = pos + 1;
+		for (k = 0; k < n && k <= ring->mask; k++) {
+			cell = &ring->cell[(pos + k) & ring->mask];
+			seq = atomic_load_explicit(&cell->seq,
+			    memory_order_acquire);
+			if (seq != pos + k + 1)
+				break;
+		}
+
+		if (k == 0) {
+			if ((intptr_t) (seq - (pos + 1)) < 0) {
+				/* Ring is empty */
+				return 0;
+			}
+
+			/* Somebody else popped in the meantime */
+			pos = atomic_load_explicit(&ring->pop_pos,
+			    memory_order_relaxed);
+			continue;
+		}
+
+		if (atomic_compare_exchange_weak_explicit(&ring->pop_pos,
+		    &pos, pos + k, memory_order_relaxed, memory_order_relaxed))
+			break;
+	}
+
+	for (i = 0; i < k; i++) {
+		cell = &ring->cell[(pos + i) & ring->mask];
+		items[i] = cell->item;
+		/* Free the cell for the producer one lap ahead */
+		atomic_store_explicit(&cell->seq, pos + i + ring->mask + 1,
+		    memory_order_release);
+	}
+
+	mpmc_ring_wakeup(ring, &ring->push_waiting, &ring->not_full, k);
+	return k;
+}
+
+/** Push item to ring buffer without blocking.
+ *
+ * @param ring Ring buffer
+ * @param item Item
+ * @return @c true on success, @c false if the ring is full
+ */
+bool mpmc_ring_try_push(mpmc_ring_t *ring, void *item)
+{
+	return mpmc_ring_push_batch(ring, &item, 1) == 1;
+}
+
+/** Pop item from ring buffer without blocking.
+ *
+ * @param ring Ring buffer
+ * @param item Place to store the item
+ * @return @c true on success, @c false if the ring is empty
+ */
+bool mpmc_ring_try_pop(mpmc_ring_t *ring, void **item)
+{
+	return mpmc_ring_pop_batch(ring, item, 1) == 1;
+}
+
+/** Announce a waiting fibril and block unless the operation succeeds.
+ *
+ * @param waiting Number of waiting fibrils
+ * @param sem Semaphore to wait on
+ * @param retry Operation to retry after announcing the waiter
+ * @param ring Ring buffer
+ * @param item Item argument of @a retry
+ * @return @c true if @a retry succeeded, @c false after being woken up
+ */
+static bool mpmc_ring_wait(atomic_int *waiting, fibril_semaphore_t *sem,
+    bool (*retry)(mpmc_ring_t *, void **), mpmc_ring_t *ring, void **item)
+{
+	bool done;
+
+	atomic_fetch_add_explicit(waiting, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	/* Retry so that a wakeup sent before we announced ourselves is not lost */
+	done = retry(ring, item);
+	if (!done)
+		fibril_semaphore_down(sem);
+
+	atomic_fetch_sub_explicit(waiting, 1, memory_order_relaxed);
+	return done;
+}
+
+static bool mpmc_ring_retry_push(mpmc_ring_t *ring, void **item)
+{
+	return mpmc_ring_try_push(ring, *item);
+}
+
+/** Push item to ring buffer, blocking while it is full.
+ *
+ * The ring must have been initialized with @c MPMC_RING_BLOCKING.
+ *
+ * @param ring Ring buffer
+ * @param item Item
+ */
+void mpmc_ring_push(mpmc_ring_t *ring, void *item)
+{
+	assert((ring->flags & MPMC_RING_BLOCKING) != 0);
+
+	while (!mpmc_ring_try_push(ring, item)) {
+		if (mpmc_ring_wait(&ring->push_waiting, &ring->not_full,
+		    mpmc_ring_retry_push, ring, &item))
+			break;
+	}
+}
+
+/** Pop item from ring buffer, blocking while it is empty.
+ *
+ * The ring must have been initialized with @c MPMC_RING_BLOCKING.
+ *
+ * @param ring Ring buffer
+ * @return Item
+ */
+void *mpmc_ring_pop(mpmc_ring_t *ring)
+{
+	void *item;
+
+	assert((ring->flags & MPMC_RING_BLOCKING) != 0);
+
+	while (!mpmc_ring_try_pop(ring, &item)) {
+		if (mpmc_ring_wait(&ring->pop_waiting, &ring->not_empty,
+		    mpmc_ring_try_pop, ring, &item))
+			break;
+	}
+
+	return item;
+}
+
+/** @}
+ */
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+
+/** @file Single-producer single-consumer packet ring in shared memory.
+ *
+ * A packet ring lives in a memory area shared by two tasks. It consists
+ * of a header with the producer and consumer indices, an array of packet
+ * descriptors and an array of fixed-size packet slots. The producer fills
+ * slots (possibly letting a device DMA into them) and publishes a batch
+ * of them by advancing the producer index. The consumer reads the slots
+ * and returns them by advancing the consumer index.
+ *
+ * No IPC is needed while both sides are busy. A consumer that finds the
+ * ring empty raises a wait flag before going to sleep and the producer
+ * rings the doorbell (sends a notification by whatever means the users
+ * agree on) only if it sees the flag raised, so that a whole batch of
+ * packets costs at most one notification.
+ *
+ * The indices are read from memory shared with a possibly misbehaving
+ * task, so they are validated before use.
+ */
+
+#include <adt/pkt_ring.h>
+#include <align.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define PKT_RING_MAGIC  0x706b7472
+
+static size_t pkt_ring_desc_offs(void)
+{
+	return ALIGN_UP(sizeof(pkt_ring_hdr_t), PKT_RING_CACHE_LINE);
+}
+
+static size_t pkt_ring_slots_offs(size_t nslots)
+{
+	return pkt_ring_desc_offs() + ALIGN_UP(nslots * sizeof(pkt_ring_desc_t),
+	    PKT_RING_CACHE_LINE);
+}
+
+/** Compute size of the shared area needed for a packet ring.
+ *
+ * @param nslots Number of slots (a power of two)
+ * @param slot_size Size of one slot in bytes
+ * @return Size of the area in bytes
+ */
+size_t pkt_ring_area_size(size_t nslots, size_t slot_size)
+{
+	return pkt_ring_slots_offs(nslots) +
+	    nslots * ALIGN_UP(slot_size, PKT_RING_CACHE_LINE);
+}
+
+/** Set up view of a ring whose header has been validated. */
+static void pkt_ring_setup(pkt_ring_t *ring, void *area)
+{
+	pkt_ring_hdr_t *hdr = (pkt_ring_hdr_t *) area;
+
+	ring->hdr = hdr;
+	ring->desc = (pkt_ring_desc_t *) ((uint8_t *) area +
+	    pkt_ring_desc_offs());
+	ring->slots = (uint8_t *) area + pkt_ring_slots_offs(hdr->nslots);
+	ring->mask = hdr->nslots - 1;
+	ring->slot_size = hdr->slot_size;
+	ring->pos = 0;
+}
+
+/** Create an empty packet ring in a memory area.
+ *
+ * @param ring Ring view to initialize
+ * @param area Area of at least pkt_ring_area_size() bytes
+ * @param nslots Number of slots (a power of two)
+ * @param slot_size Size of one slot in bytes
+ * @return EOK on success, EINVAL if the geometry is invalid
+ */
+errno_t pkt_ring_create(pkt_ring_t *ring, void *area, size_t nslots,
+    size_t slot_size)
+{
+	pkt_ring_hdr_t *hdr = (pkt_ring_hdr_t *) area;
+
+	if (nslots == 0 || (nslots & (nslots - 1)) != 0 ||
+	    nslots > UINT32_MAX / 2 || slot_size == 0 ||
+	    slot_size > UINT32_MAX - PKT_RING_CACHE_LINE)
+		return EINVAL;
+
+	hdr->magic = PKT_RING_MAGIC;
+	hdr->nslots = nslots;
+	hdr->slot_size = ALIGN_UP(slot_size, PKT_RING_CACHE_LINE);
+	atomic_init(&hdr->prod, 0);
+	atomic_init(&hdr->cons, 0);
+	atomic_init(&hdr->cons_wait, 0);
+
+	pkt_ring_setup(ring, area);
+	return EOK;
+}
+
+/** Attach to a packet ring created by the other side.
+ *
+ * @param ring Ring view to initialize
+ * @param area Shared area containing the ring
+ * @param size Size of the area in bytes
+ * @return EOK on success, EINVAL if the area does not hold a valid ring
+ */
+errno_t pkt_ring_attach(pkt_ring_t *ring, void *area, size_t size)
+{
+	pkt_ring_hdr_t *hdr = (pkt_ring_hdr_t *) area;
+	uint32_t nslots;
+	uint32_t slot_size;
+
+	if (size < sizeof(pkt_ring_hdr_t))
+		return EINVAL;
+
+	nslots = hdr->nslots;
+	slot_size = hdr->slot_size;
+
+	if (hdr->magic != PKT_RING_MAGIC || nslots == 0 ||
+	    (nslots & (nslots - 1)) != 0 || nslots > UINT32_MAX / 2 ||
+	    slot_size == 0 || slot_size % PKT_RING_CACHE_LINE != 0)
+		return EINVAL;
+
+	if (nslots > SIZE_MAX / 2 / slot_size ||
+	    pkt_ring_area_size(nslots, slot_size) > size)
+		return EINVAL;
+
+	pkt_ring_setup(ring, area);
+	return EOK;
+}
+
+/** Get the next free slot to fill.
+ *
+ * @param ring Ring (producer side)
+ * @return Pointer to a slot of @c slot_size bytes or @c NULL if the ring
+ *         is full
+ */
+void *pkt_ring_prod_slot(pkt_ring_t *ring)
+{
+	uint32_t cons = atomic_load_explicit(&ring->hdr->cons,
+	    memory_order_acquire);
+
+	if (ring->pos - cons > ring->mask)
+		return NULL;
+
+	return ring->slots + (size_t) (ring->pos & ring->mask) *
+	    ring->slot_size;
+}
+
+/** Queue the slot returned by pkt_ring_prod_slot().
+ *
+ * The packet is not visible to the consumer until pkt_ring_prod_publish()
+ * is called.
+ *
+ * @param ring Ring (producer side)
+ * @param desc Packet descriptor
+ */
+void pkt_ring_prod_put(pkt_ring_t *ring, const pkt_ring_desc_t *desc)
+{
+	ring->desc[ring->pos & ring->mask] = *desc;
+	++ring->pos;
+}
+
+/** Make queued packets visible to the consumer.
+ *
+ * @param ring Ring (producer side)
+ * @return @c true if the consumer is waiting and the caller must ring
+ *         the doorbell
+ */
+bool pkt_ring_prod_publish(pkt_ring_t *ring)
+{
+	atomic_store_explicit(&ring->hdr->prod, ring->pos,
+	    memory_order_release);
+
+	/* Order the index store before the wait flag load */
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (atomic_load_explicit(&ring->hdr->cons_wait,
+	    memory_order_relaxed) == 0)
+		return false;
+
+	return atomic_exchange(&ring->hdr->cons_wait, 0) != 0;
+}
+
+/** Get the next packet to consume.
+ *
+ * @param ring Ring (consumer side)
+ * @param desc Place to store copy of the packet descriptor. The size is
+ *        clamped to the slot size.
+ * @return Pointer to the packet data or @c NULL if the ring is empty
+ */
+void *pkt_ring_cons_peek(pkt_ring_t *ring, pkt_ring_desc_t *desc)
+{
+	uint32_t prod = atomic_load_explicit(&ring->hdr->prod,
+	    memory_order_acquire);
+
+	/* Empty, or the producer index is bogus */
+	if (prod - ring->pos - 1 > ring->mask)
+		return NULL;
+
+	*desc = ring->desc[ring->pos & ring->mask];
+	if (desc->size > ring->slot_size)
+		desc->size = ring->slot_size;
+
+	return ring->slots + (size_t) (ring->pos & ring->mask) *
+	    ring->slot_size;
+}
+
+/** Move past the packet returned by pkt_ring_cons_peek().
+ *
+ * The slot is not returned to the producer until pkt_ring_cons_publish()
+ * is called.
+ *
+ * @param ring Ring (consumer side)
+ */
+void pkt_ring_cons_next(pkt_ring_t *ring)
+{
+	++ring->pos;
+}
+
+/** Return consumed slots to the producer.
+ *
+ * @param ring Ring (consumer side)
+ */
+void pkt_ring_cons_publish(pkt_ring_t *ring)
+{
+	atomic_store_explicit(&ring->hdr->cons, ring->pos,
+	    memory_order_release);
+}
+
+/** Prepare to wait for the doorbell.
+ *
+ * Raises the wait flag and checks the ring once more so that a packet
+ * published in the meantime is not missed.
+ *
+ * @param ring Ring (consumer side)
+ * @return @c true if the ring is still empty and the caller should sleep
+ *         until the doorbell rings, @c false if there are packets to consume
+ */
+bool pkt_ring_cons_wait(pkt_ring_t *ring)
+{
+	atomic_store(&ring->hdr->cons_wait, 1);
+
+	if (atomic_load(&ring->hdr->prod) != ring->pos) {
+		atomic_store(&ring->hdr->cons_wait, 0);
+		return false;
+	}
+
+	return true;
+}
+
+/** @}
+ */
@@ -34,17 +34,68 @@
 
 #include <adt/prodcons.h>
 #include <adt/list.h>
+#include <adt/mpmc_ring.h>
+#include <errno.h>
 #include <fibril_synch.h>
+#include <stdlib.h>
 
 void prodcons_initialize(prodcons_t *pc)
 {
 	list_initialize(&pc->list);
 	fibril_mutex_initialize(&pc->mtx);
 	fibril_condvar_initialize(&pc->cv);
+	pc->ring = NULL;
+}
+
+/** Initialize a bounded producer-consumer queue.
+ *
+ * The queue is backed by a lock-free ring buffer instead of a locked
+ * list. prodcons_produce() blocks while the queue is full.
+ *
+ * @param pc Producer-consumer queue
+ * @param capacity Minimum number of items the queue can hold
+ * @return EOK on success, EINVAL or ENOMEM on failure
+ */
+errno_t prodcons_initialize_bounded(prodcons_t *pc, size_t capacity)
+{
+	errno_t rc;
+
+	prodcons_initialize(pc);
+
+	pc->ring = malloc(sizeof(mpmc_ring_t));
+	if (pc->ring == NULL)
+		return ENOMEM;
+
+	rc = mpmc_ring_initialize(pc->ring, capacity, MPMC_RING_BLOCKING);
+	if (rc != EOK) {
+		free(pc->ring);
+		pc->ring = NULL;
+		return rc;
+	}
+
+	return EOK;
+}
+
+/** Destroy producer-consumer queue.
+ *
+ * @param pc Producer-consumer queue
+ */
+void prodcons_destroy(prodcons_t *pc)
+{
+	if (pc->ring != NULL) {
+		mpmc_ring_destroy(pc->ring);
+		free(pc->ring);
+		pc->ring = NULL;
+	}
 }
 
 void prodcons_produce(prodcons_t *pc, link_t *item)
 {
+	if (pc->ring != NULL) {
+		mpmc_ring_push(pc->ring, item);
+		return;
+	}
+
 	fibril_mutex_lock(&pc->mtx);
 
 	list_append(item, &pc->list);
@@ -55,6 +106,9 @@ void prodcons_produce(prodcons_t *pc, link_t *item)
 
 link_t *prodcons_consume(prodcons_t *pc)
 {
+	if (pc->ring != NULL)
+		return mpmc_ring_pop(pc->ring);
+
 	fibril_mutex_lock(&pc->mtx);
 
 	while (list_empty(&pc->list))
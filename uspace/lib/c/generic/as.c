@@ -92,6 +92,23 @@ errno_t as_area_destroy(void *address)
 	return (errno_t) __SYSCALL1(SYS_AS_AREA_DESTROY, (sysarg_t) address);
 }
 
+/** Write back modified pages of an address space area.
+ *
+ * For areas backed by a user pager, the pager is asked to write back the
+ * pages modified in the range. For other areas this does nothing.
+ *
+ * @param address Start of the range, pointing into the address space area.
+ * @param size    Size of the range, which must not extend past the area.
+ *
+ * @return zero on success or a code from @ref errno.h on failure.
+ *
+ */
+errno_t as_area_sync(void *address, size_t size)
+{
+	return (errno_t) __SYSCALL2(SYS_AS_AREA_SYNC, (sysarg_t) address,
+	    (sysarg_t) size);
+}
+
 /** Change address-space area flags.
  *
  * @param address Virtual address pointing into the address space area being
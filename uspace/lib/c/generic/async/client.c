@@ -98,6 +98,7 @@
 #include <ipc/ipc.h>
 #include <async.h>
 #include "../private/async.h"
+#include "../private/ring.h"
 #include "../private/ns.h"
 #undef _LIBC_ASYNC_C_
 
@@ -126,10 +127,18 @@ static fibril_rmutex_t message_mutex;
 /** Naming service session */
 async_sess_t session_ns;
 
+struct async_wait_set;
+
 /** Message data */
 typedef struct {
 	fibril_event_t received;
 
+	/** Wait set the message belongs to or NULL. */
+	struct async_wait_set *set;
+
+	/** Link in the list of pending or completed messages of the wait set. */
+	link_t set_link;
+
 	/** If reply was received. */
 	bool done;
 
@@ -139,9 +148,27 @@ typedef struct {
 	/** Pointer to where the answer data is stored. */
 	ipc_call_t *dataptr;
 
+	/** Rings of the session if the message was sent through the phone. */
+	async_ring_t *ring;
+
 	errno_t retval;
 } amsg_t;
 
+/** Set of messages whose replies are collected in order of arrival */
+struct async_wait_set {
+	/** Signalled when a member message is completed. */
+	fibril_event_t completed_event;
+
+	/** Member messages still waiting for their replies. */
+	list_t pending;
+
+	/** Completed member messages, in order of completion. */
+	list_t completed;
+
+	/** Number of member messages not yet returned to the caller. */
+	size_t members;
+};
+
 static amsg_t *amsg_create(void)
 {
 	return calloc(1, sizeof(amsg_t));
@@ -152,6 +179,35 @@ static void amsg_destroy(amsg_t *msg)
 	free(msg);
 }
 
+/** Account for a message sent through the phone of a session with rings.
+ *
+ * Requests are not sent through the rings while any message sent through
+ * the phone is waiting for an answer, so that they cannot overtake it.
+ *
+ * @param msg  Message being sent.
+ * @param exch Exchange the message is sent in.
+ */
+static void amsg_ring_begin(amsg_t *msg, async_exch_t *exch)
+{
+	async_ring_t *ring = exch->sess->ring;
+	if (!ring)
+		return;
+
+	async_ring_add_ref(ring);
+	atomic_fetch_add(&ring->phone_calls, 1);
+	msg->ring = ring;
+}
+
+static void amsg_ring_end(amsg_t *msg)
+{
+	if (!msg->ring)
+		return;
+
+	atomic_fetch_sub(&msg->ring->phone_calls, 1);
+	async_ring_put(msg->ring);
+	msg->ring = NULL;
+}
+
 /** Mutex protecting inactive_exch_list and avail_phone_cv.
  *
  */
@@ -213,6 +269,8 @@ void async_reply_received(ipc_call_t *data)
 	if (!msg)
 		return;
 
+	amsg_ring_end(msg);
+
 	fibril_rmutex_lock(&message_mutex);
 
 	msg->retval = ipc_get_retval(data);
@@ -225,6 +283,10 @@ void async_reply_received(ipc_call_t *data)
 
 	if (msg->forget) {
 		amsg_destroy(msg);
+	} else if (msg->set) {
+		list_remove(&msg->set_link);
+		list_append(&msg->set_link, &msg->set->completed);
+		fibril_notify(&msg->set->completed_event);
 	} else {
 		fibril_notify(&msg->received);
 	}
@@ -259,10 +321,12 @@ static aid_t async_send_fast(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1
 		return 0;
 
 	msg->dataptr = dataptr;
+	amsg_ring_begin(msg, exch);
 
 	errno_t rc = ipc_call_async_4(exch->phone, imethod, arg1, arg2, arg3,
 	    arg4, msg);
 	if (rc != EOK) {
+		amsg_ring_end(msg);
 		msg->retval = rc;
 		msg->done = true;
 	}
@@ -300,10 +364,12 @@ static aid_t async_send_slow(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1
 		return 0;
 
 	msg->dataptr = dataptr;
+	amsg_ring_begin(msg, exch);
 
 	errno_t rc = ipc_call_async_5(exch->phone, imethod, arg1, arg2, arg3,
 	    arg4, arg5, msg);
 	if (rc != EOK) {
+		amsg_ring_end(msg);
 		msg->retval = rc;
 		msg->done = true;
 	}
@@ -348,6 +414,88 @@ aid_t async_send_5(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
 	    dataptr);
 }
 
+/** Send a batch of messages in as few syscalls as possible.
+ *
+ * The interface, method and payload arguments of each message are taken from
+ * the corresponding entry of @a calls. The entry is also where the reply data
+ * of the message is stored. Every returned message id must be waited for or
+ * forgotten, including those of messages that could not be sent.
+ *
+ * @param exch  Exchange for sending the messages.
+ * @param calls Requests on input, storage for the reply data.
+ * @param count Number of messages.
+ * @param aids  Array to store ids of the sent messages to.
+ *
+ * @return EOK on success.
+ * @return ENOENT if @a exch is NULL.
+ * @return ENOMEM if out of memory. No message is sent in that case.
+ *
+ */
+errno_t async_send_batch(async_exch_t *exch, ipc_call_t *calls, size_t count,
+    aid_t *aids)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	if (count == 0)
+		return EOK;
+
+	ipc_call_t *reqs = malloc(min(count, (size_t) IPC_MAX_BATCH) *
+	    sizeof(ipc_call_t));
+	if (reqs == NULL)
+		return ENOMEM;
+
+	for (size_t i = 0; i < count; i++) {
+		amsg_t *msg = amsg_create();
+		if (msg == NULL) {
+			while (i-- > 0)
+				amsg_destroy((amsg_t *) aids[i]);
+			free(reqs);
+			return ENOMEM;
+		}
+
+		msg->dataptr = &calls[i];
+		aids[i] = (aid_t) msg;
+	}
+
+	size_t next = 0;
+	while (next < count) {
+		size_t batch = min(count - next, (size_t) IPC_MAX_BATCH);
+
+		for (size_t i = 0; i < batch; i++) {
+			amsg_t *msg = (amsg_t *) aids[next + i];
+
+			memcpy(reqs[i].args, calls[next + i].args,
+			    sizeof(reqs[i].args));
+			reqs[i].cap_handle =
+			    (cap_call_handle_t) cap_handle_raw(exch->phone);
+			reqs[i].answer_label = (sysarg_t) msg;
+			amsg_ring_begin(msg, exch);
+		}
+
+		size_t submitted = 0;
+		errno_t rc = ipc_call_async_batch(reqs, batch, &submitted);
+
+		/* Messages beyond the first failed one wait for the next round. */
+		for (size_t i = submitted + 1; i < batch; i++)
+			amsg_ring_end((amsg_t *) aids[next + i]);
+
+		if (rc != EOK) {
+			amsg_t *msg = (amsg_t *) aids[next + submitted];
+
+			amsg_ring_end(msg);
+			msg->retval = rc;
+			msg->done = true;
+			submitted++;
+		}
+
+		next += submitted;
+	}
+
+	free(reqs);
+	return EOK;
+}
+
 /** Wait for a message sent by the async framework.
  *
  * @param amsgid Hash of the message to wait for.
@@ -448,6 +596,244 @@ void async_forget(aid_t amsgid)
 	fibril_rmutex_unlock(&message_mutex);
 }
 
+/** Create a wait set.
+ *
+ * A wait set collects the replies of several messages and returns them in
+ * the order in which they arrive, so that a slow reply does not delay the
+ * processing of the others. Only one fibril may wait on a set at a time.
+ *
+ * @return New wait set or NULL if out of memory.
+ *
+ */
+async_wait_set_t *async_wait_set_create(void)
+{
+	async_wait_set_t *set = calloc(1, sizeof(async_wait_set_t));
+	if (set == NULL)
+		return NULL;
+
+	list_initialize(&set->pending);
+	list_initialize(&set->completed);
+	return set;
+}
+
+/** Destroy a wait set.
+ *
+ * Messages still in the set are forgotten, i.e. replies which have not
+ * arrived yet are discarded on arrival.
+ *
+ * @param set Wait set to destroy.
+ *
+ */
+void async_wait_set_destroy(async_wait_set_t *set)
+{
+	fibril_rmutex_lock(&message_mutex);
+
+	while (!list_empty(&set->completed)) {
+		amsg_t *msg = list_pop(&set->completed, amsg_t, set_link);
+		amsg_destroy(msg);
+	}
+
+	while (!list_empty(&set->pending)) {
+		amsg_t *msg = list_pop(&set->pending, amsg_t, set_link);
+		msg->set = NULL;
+		msg->dataptr = NULL;
+		msg->forget = true;
+	}
+
+	fibril_rmutex_unlock(&message_mutex);
+	free(set);
+}
+
+/** Add a message to a wait set.
+ *
+ * After this call, the reply to the message can only be collected through
+ * the set, i.e. it is not allowed to call async_wait_for(),
+ * async_wait_timeout() or async_forget() on the message.
+ *
+ * @param set    Wait set.
+ * @param amsgid Hash of the message to add.
+ *
+ * @return EOK on success, ENOMEM if @a amsgid is zero, i.e. sending
+ *         the message failed.
+ *
+ */
+errno_t async_wait_set_add(async_wait_set_t *set, aid_t amsgid)
+{
+	if (amsgid == 0)
+		return ENOMEM;
+
+	amsg_t *msg = (amsg_t *) amsgid;
+
+	assert(!msg->forget);
+	assert(msg->set == NULL);
+
+	fibril_rmutex_lock(&message_mutex);
+
+	msg->set = set;
+	set->members++;
+
+	if (msg->done) {
+		list_append(&msg->set_link, &set->completed);
+		fibril_notify(&set->completed_event);
+	} else {
+		list_append(&msg->set_link, &set->pending);
+	}
+
+	fibril_rmutex_unlock(&message_mutex);
+	return EOK;
+}
+
+/** Remove up to @a max completed messages from a wait set.
+ *
+ * Must be called with message_mutex held.
+ */
+static size_t async_wait_set_collect(async_wait_set_t *set, aid_t *amsgids,
+    errno_t *retvals, size_t max)
+{
+	size_t n = 0;
+
+	while (n < max && !list_empty(&set->completed)) {
+		amsg_t *msg = list_pop(&set->completed, amsg_t, set_link);
+
+		if (amsgids)
+			amsgids[n] = (aid_t) msg;
+		if (retvals)
+			retvals[n] = msg->retval;
+
+		amsg_destroy(msg);
+		set->members--;
+		n++;
+	}
+
+	return n;
+}
+
+/** Wait for replies to several messages of a wait set.
+ *
+ * Block until at least one member of the set has been completed and
+ * return as many completed members as are available, up to @a max. The
+ * returned messages are removed from the set; their hashes only identify
+ * the messages and must not be used to wait again.
+ *
+ * @param set     Wait set.
+ * @param amsgids Array of @a max entries for the hashes of the completed
+ *                messages.
+ * @param retvals If not NULL, array of @a max entries for the retvals of
+ *                the answers.
+ * @param max     Maximum number of messages to return.
+ *
+ * @return Number of completed messages returned, zero if the set is empty.
+ *
+ */
+size_t async_wait_some(async_wait_set_t *set, aid_t *amsgids,
+    errno_t *retvals, size_t max)
+{
+	if (max == 0)
+		return 0;
+
+	fibril_rmutex_lock(&message_mutex);
+
+	while (list_empty(&set->completed) && set->members > 0) {
+		fibril_rmutex_unlock(&message_mutex);
+		fibril_wait_for(&set->completed_event);
+		fibril_rmutex_lock(&message_mutex);
+	}
+
+	size_t n = async_wait_set_collect(set, amsgids, retvals, max);
+
+	fibril_rmutex_unlock(&message_mutex);
+	return n;
+}
+
+/** Collect replies of a wait set which have already arrived.
+ *
+ * Same as async_wait_some(), but never blocks.
+ *
+ * @param set     Wait set.
+ * @param amsgids Array of @a max entries for the hashes of the completed
+ *                messages.
+ * @param retvals If not NULL, array of @a max entries for the retvals of
+ *                the answers.
+ * @param max     Maximum number of messages to return.
+ *
+ * @return Number of completed messages returned, zero if no member of the
+ *         set has been completed yet.
+ *
+ */
+size_t async_wait_poll(async_wait_set_t *set, aid_t *amsgids,
+    errno_t *retvals, size_t max)
+{
+	fibril_rmutex_lock(&message_mutex);
+	size_t n = async_wait_set_collect(set, amsgids, retvals, max);
+	fibril_rmutex_unlock(&message_mutex);
+
+	return n;
+}
+
+/** Wait for the reply to any message of a wait set.
+ *
+ * @param set    Wait set.
+ * @param amsgid If not NULL, storage where the hash of the completed
+ *               message will be stored.
+ * @param retval If not NULL, storage where the retval of the answer will
+ *               be stored.
+ *
+ * @return EOK on success, ENOENT if the set has no members.
+ *
+ */
+errno_t async_wait_any(async_wait_set_t *set, aid_t *amsgid, errno_t *retval)
+{
+	aid_t aid;
+
+	if (async_wait_some(set, &aid, retval, 1) == 0)
+		return ENOENT;
+
+	if (amsgid)
+		*amsgid = aid;
+
+	return EOK;
+}
+
+/** Send a request through the rings of the session.
+ *
+ * @param exch    Exchange for sending the message.
+ * @param imethod Service-defined interface and method.
+ * @param arg1    Service-defined payload argument.
+ * @param arg2    Service-defined payload argument.
+ * @param arg3    Service-defined payload argument.
+ * @param arg4    Service-defined payload argument.
+ * @param arg5    Service-defined payload argument.
+ * @param dataptr If non-NULL, storage where the reply data will be stored.
+ *
+ * @return Hash of the sent message or 0 if the message has to be sent
+ *         through the phone.
+ *
+ */
+static aid_t async_send_ring(async_exch_t *exch, sysarg_t imethod,
+    sysarg_t arg1, sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5,
+    ipc_call_t *dataptr)
+{
+	async_ring_t *ring = exch->sess->ring;
+
+	if ((ring == NULL) || (imethod < IPC_FIRST_USER_METHOD) ||
+	    (atomic_load(&ring->phone_calls) > 0))
+		return 0;
+
+	amsg_t *msg = amsg_create();
+	if (msg == NULL)
+		return 0;
+
+	msg->dataptr = dataptr;
+
+	if (async_ring_send(ring, imethod, arg1, arg2, arg3, arg4, arg5,
+	    msg) != EOK) {
+		amsg_destroy(msg);
+		return 0;
+	}
+
+	return (aid_t) msg;
+}
+
 /** Pseudo-synchronous message sending - fast version.
  *
  * Send message asynchronously and return only after the reply arrives.
@@ -478,8 +864,11 @@ static errno_t async_req_fast(async_exch_t *exch, sysarg_t imethod,
 		return ENOENT;
 
 	ipc_call_t result;
-	aid_t aid = async_send_4(exch, imethod, arg1, arg2, arg3, arg4,
+	aid_t aid = async_send_ring(exch, imethod, arg1, arg2, arg3, arg4, 0,
 	    &result);
+	if (aid == 0)
+		aid = async_send_4(exch, imethod, arg1, arg2, arg3, arg4,
+		    &result);
 
 	errno_t rc;
 	async_wait_for(aid, &rc);
@@ -530,8 +919,11 @@ static errno_t async_req_slow(async_exch_t *exch, sysarg_t imethod,
 		return ENOENT;
 
 	ipc_call_t result;
-	aid_t aid = async_send_5(exch, imethod, arg1, arg2, arg3, arg4, arg5,
+	aid_t aid = async_send_ring(exch, imethod, arg1, arg2, arg3, arg4, arg5,
 	    &result);
+	if (aid == 0)
+		aid = async_send_5(exch, imethod, arg1, arg2, arg3, arg4, arg5,
+		    &result);
 
 	errno_t rc;
 	async_wait_for(aid, &rc);
@@ -849,7 +1241,7 @@ void async_msg_5(async_exch_t *exch, sysarg_t imethod, sysarg_t arg1,
 
 static errno_t async_connect_me_to_internal(cap_phone_handle_t phone,
     iface_t iface, sysarg_t arg2, sysarg_t arg3, sysarg_t flags,
-    cap_phone_handle_t *out_phone)
+    cap_phone_handle_t *out_phone, size_t *preferred)
 {
 	ipc_call_t result;
 
@@ -876,6 +1268,8 @@ static errno_t async_connect_me_to_internal(cap_phone_handle_t phone,
 		return rc;
 
 	*out_phone = (cap_phone_handle_t) ipc_get_arg5(&result);
+	if (preferred != NULL)
+		*preferred = ipc_get_arg1(&result);
 	return EOK;
 }
 
@@ -913,7 +1307,7 @@ async_sess_t *async_connect_me_to(async_exch_t *exch, iface_t iface,
 
 	cap_phone_handle_t phone;
 	errno_t ret = async_connect_me_to_internal(exch->phone, iface, arg2,
-	    arg3, 0, &phone);
+	    arg3, 0, &phone, &sess->preferred);
 	if (ret != EOK) {
 		if (rc != NULL)
 			*rc = ret;
@@ -988,7 +1382,7 @@ async_sess_t *async_connect_me_to_blocking(async_exch_t *exch, iface_t iface,
 
 	cap_phone_handle_t phone;
 	errno_t ret = async_connect_me_to_internal(exch->phone, iface, arg2,
-	    arg3, IPC_FLAG_BLOCKING, &phone);
+	    arg3, IPC_FLAG_BLOCKING, &phone, &sess->preferred);
 	if (ret != EOK) {
 		if (rc != NULL)
 			*rc = ret;
@@ -1071,6 +1465,9 @@ void async_hangup(async_sess_t *sess)
 	fibril_mutex_lock(&async_sess_mutex);
 	assert(sess->exchanges == 0);
 
+	if (sess->ring)
+		async_ring_destroy(sess->ring);
+
 	async_hangup_internal(sess->phone);
 
 	while (!list_empty(&sess->exch_list)) {
@@ -1091,6 +1488,174 @@ void async_hangup(async_sess_t *sess)
 	fibril_mutex_unlock(&async_sess_mutex);
 }
 
+/** Send the requests of a session through shared-memory rings.
+ *
+ * After the rings are set up, the requests whose sender waits for the
+ * answer (async_req_*()) are exchanged with the server through an address
+ * space area shared with it. The kernel is only entered when the other side
+ * needs to be woken up. The server side is set up transparently by the
+ * async framework of the server.
+ *
+ * The rings cannot be used with parallel exchange management, because all
+ * the requests are delivered to a single connection of the server.
+ *
+ * @param sess Session.
+ *
+ * @return EOK on success, ENOTSUP if the session uses parallel exchanges, or
+ *         an error code if the rings could not be set up. The session
+ *         remains usable without the rings in case of an error.
+ *
+ */
+errno_t async_sess_ring_enable(async_sess_t *sess)
+{
+	exch_mgmt_t mgmt = sess->mgmt;
+	if (sess->iface != 0)
+		mgmt = sess->iface & IFACE_EXCHANGE_MASK;
+
+	if (mgmt == EXCHANGE_PARALLEL)
+		return ENOTSUP;
+
+	if (sess->ring)
+		return EOK;
+
+	async_exch_t *exch = async_exchange_begin(sess);
+	if (exch == NULL)
+		return ENOMEM;
+
+	async_ring_t *ring;
+	errno_t rc = async_ring_connect(exch, &ring);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	fibril_mutex_lock(&async_sess_mutex);
+
+	if (sess->ring) {
+		/* Somebody else has been faster. */
+		fibril_mutex_unlock(&async_sess_mutex);
+		async_ring_destroy(ring);
+	} else {
+		sess->ring = ring;
+		fibril_mutex_unlock(&async_sess_mutex);
+	}
+
+	return EOK;
+}
+
+/** Get the exchange management style of a session. */
+static exch_mgmt_t async_sess_mgmt(async_sess_t *sess)
+{
+	if (sess->iface != 0)
+		return sess->iface & IFACE_EXCHANGE_MASK;
+
+	return sess->mgmt;
+}
+
+/** Get the maximum number of data phones of a session, zero if unlimited. */
+static size_t async_pool_max(async_sess_t *sess)
+{
+	if (sess->pool.max_phones != 0)
+		return sess->pool.max_phones;
+
+	return sess->preferred;
+}
+
+static async_exch_t *async_exch_create(async_sess_t *sess,
+    cap_phone_handle_t phone)
+{
+	async_exch_t *exch = (async_exch_t *) malloc(sizeof(async_exch_t));
+	if (exch == NULL)
+		return NULL;
+
+	link_initialize(&exch->sess_link);
+	link_initialize(&exch->global_link);
+	exch->sess = sess;
+	exch->phone = phone;
+	return exch;
+}
+
+/** Connect a new data phone of a parallel session.
+ *
+ * Must be called with async_sess_mutex held.
+ *
+ * @param sess Session.
+ * @param out  Place to store the new exchange.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+static errno_t async_pool_connect(async_sess_t *sess, async_exch_t **out)
+{
+	cap_phone_handle_t phone;
+
+	errno_t rc = async_connect_me_to_internal(sess->phone, sess->arg1,
+	    sess->arg2, sess->arg3, 0, &phone, NULL);
+	if (rc != EOK)
+		return rc;
+
+	async_exch_t *exch = async_exch_create(sess, phone);
+	if (exch == NULL) {
+		async_hangup_internal(phone);
+		return ENOMEM;
+	}
+
+	sess->phones++;
+	*out = exch;
+	return EOK;
+}
+
+/** Close an inactive exchange.
+ *
+ * Only exchanges of parallel sessions own their phone, the others share
+ * the phone of the session and are merely freed.
+ *
+ * Must be called with async_sess_mutex held.
+ *
+ */
+static void async_exch_close(async_exch_t *exch)
+{
+	list_remove(&exch->sess_link);
+	list_remove(&exch->global_link);
+
+	if (async_sess_mgmt(exch->sess) == EXCHANGE_PARALLEL) {
+		async_hangup_internal(exch->phone);
+
+		assert(exch->sess->phones > 0);
+		exch->sess->phones--;
+	}
+
+	free(exch);
+}
+
+/** Close the data phones of a session which stayed idle for too long.
+ *
+ * Must be called with async_sess_mutex held.
+ *
+ * @param sess Session.
+ * @param now  Current time.
+ *
+ */
+static void async_pool_reap(async_sess_t *sess, const struct timespec *now)
+{
+	if (sess->pool.idle_timeout <= 0)
+		return;
+
+	/* The exchanges are ordered by the time they became inactive. */
+	while ((sess->phones > sess->pool.min_phones) &&
+	    !list_empty(&sess->exch_list)) {
+		async_exch_t *exch = (async_exch_t *)
+		    list_get_instance(list_first(&sess->exch_list),
+		    async_exch_t, sess_link);
+
+		if (NSEC2USEC(ts_sub_diff(now, &exch->idle_since)) <
+		    sess->pool.idle_timeout)
+			break;
+
+		async_exch_close(exch);
+	}
+}
+
 /** Start new exchange in a session.
  *
  * @param session Session.
@@ -1103,58 +1668,53 @@ async_exch_t *async_exchange_begin(async_sess_t *sess)
 	if (sess == NULL)
 		return NULL;
 
-	exch_mgmt_t mgmt = sess->mgmt;
-	if (sess->iface != 0)
-		mgmt = sess->iface & IFACE_EXCHANGE_MASK;
-
+	exch_mgmt_t mgmt = async_sess_mgmt(sess);
 	async_exch_t *exch = NULL;
+	bool waited = false;
+	struct timespec wait_start;
 
 	fibril_mutex_lock(&async_sess_mutex);
 
-	if (!list_empty(&sess->exch_list)) {
-		/*
-		 * There are inactive exchanges in the session.
-		 */
-		exch = (async_exch_t *)
-		    list_get_instance(list_first(&sess->exch_list),
-		    async_exch_t, sess_link);
+	while (true) {
+		if (!list_empty(&sess->exch_list)) {
+			/*
+			 * There are inactive exchanges in the session. Take the
+			 * one used most recently, so that the others can time out.
+			 */
+			exch = (async_exch_t *)
+			    list_get_instance(list_last(&sess->exch_list),
+			    async_exch_t, sess_link);
+
+			list_remove(&exch->sess_link);
+			list_remove(&exch->global_link);
+			if (!waited)
+				sess->pool_stats.hits++;
+			break;
+		}
 
-		list_remove(&exch->sess_link);
-		list_remove(&exch->global_link);
-	} else {
 		/*
 		 * There are no available exchanges in the session.
 		 */
 
-		if ((mgmt == EXCHANGE_ATOMIC) ||
-		    (mgmt == EXCHANGE_SERIALIZE)) {
-			exch = (async_exch_t *) malloc(sizeof(async_exch_t));
-			if (exch != NULL) {
-				link_initialize(&exch->sess_link);
-				link_initialize(&exch->global_link);
-				exch->sess = sess;
-				exch->phone = sess->phone;
-			}
-		} else if (mgmt == EXCHANGE_PARALLEL) {
-			cap_phone_handle_t phone;
-			errno_t rc;
+		if (mgmt != EXCHANGE_PARALLEL) {
+			exch = async_exch_create(sess, sess->phone);
+			if (exch != NULL)
+				sess->pool_stats.misses++;
+			break;
+		}
 
-		retry:
+		size_t max = async_pool_max(sess);
+		if ((max == 0) || (sess->phones < max)) {
 			/*
 			 * Make a one-time attempt to connect a new data phone.
 			 */
-			rc = async_connect_me_to_internal(sess->phone, sess->arg1,
-			    sess->arg2, sess->arg3, 0, &phone);
-			if (rc == EOK) {
-				exch = (async_exch_t *) malloc(sizeof(async_exch_t));
-				if (exch != NULL) {
-					link_initialize(&exch->sess_link);
-					link_initialize(&exch->global_link);
-					exch->sess = sess;
-					exch->phone = phone;
-				} else
-					async_hangup_internal(phone);
-			} else if (!list_empty(&inactive_exch_list)) {
+			if (async_pool_connect(sess, &exch) == EOK) {
+				if (!waited)
+					sess->pool_stats.misses++;
+				break;
+			}
+
+			if (!list_empty(&inactive_exch_list)) {
 				/*
 				 * We did not manage to connect a new phone. But we
 				 * can try to close some of the currently inactive
@@ -1164,19 +1724,32 @@ async_exch_t *async_exchange_begin(async_sess_t *sess)
 				    list_get_instance(list_first(&inactive_exch_list),
 				    async_exch_t, global_link);
 
-				list_remove(&exch->sess_link);
-				list_remove(&exch->global_link);
-				async_hangup_internal(exch->phone);
-				free(exch);
-				goto retry;
-			} else {
-				/*
-				 * Wait for a phone to become available.
-				 */
-				fibril_condvar_wait(&avail_phone_cv, &async_sess_mutex);
-				goto retry;
+				async_exch_close(exch);
+				exch = NULL;
+				continue;
 			}
+		} else if (sess->pool.exhausted == ASYNC_POOL_FAIL) {
+			sess->pool_stats.failures++;
+			break;
+		}
+
+		/*
+		 * Wait for a phone to become available.
+		 */
+		if (!waited) {
+			waited = true;
+			sess->pool_stats.waits++;
+			getuptime(&wait_start);
 		}
+
+		fibril_condvar_wait(&avail_phone_cv, &async_sess_mutex);
+	}
+
+	if (waited) {
+		struct timespec now;
+		getuptime(&now);
+		sess->pool_stats.wait_time += NSEC2USEC(ts_sub_diff(&now,
+		    &wait_start));
 	}
 
 	if (exch != NULL)
@@ -1203,9 +1776,7 @@ void async_exchange_end(async_exch_t *exch)
 	async_sess_t *sess = exch->sess;
 	assert(sess != NULL);
 
-	exch_mgmt_t mgmt = sess->mgmt;
-	if (sess->iface != 0)
-		mgmt = sess->iface & IFACE_EXCHANGE_MASK;
+	exch_mgmt_t mgmt = async_sess_mgmt(sess);
 
 	if (mgmt == EXCHANGE_SERIALIZE)
 		fibril_mutex_unlock(&sess->mutex);
@@ -1214,9 +1785,84 @@ void async_exchange_end(async_exch_t *exch)
 
 	sess->exchanges--;
 
+	getuptime(&exch->idle_since);
 	list_append(&exch->sess_link, &sess->exch_list);
 	list_append(&exch->global_link, &inactive_exch_list);
-	fibril_condvar_signal(&avail_phone_cv);
+
+	if (mgmt == EXCHANGE_PARALLEL)
+		async_pool_reap(sess, &exch->idle_since);
+
+	/*
+	 * Waiters of different sessions share the condition variable, wake
+	 * them all so that the one waiting for this session gets the phone.
+	 */
+	fibril_condvar_broadcast(&avail_phone_cv);
+
+	fibril_mutex_unlock(&async_sess_mutex);
+}
+
+/** Configure the exchange pool of a session.
+ *
+ * The pool limits the number of data phones opened for the exchanges of a
+ * session with parallel exchange management. Up to @c min_phones phones
+ * are connected immediately and kept open, idle phones above that are
+ * closed once they stay idle for @c idle_timeout.
+ *
+ * @param sess   Session.
+ * @param config Pool configuration.
+ *
+ * @return EOK on success, EINVAL if the configuration is inconsistent,
+ *         or an error code if connecting the minimum number of phones failed.
+ *
+ */
+errno_t async_sess_pool_set(async_sess_t *sess,
+    const async_pool_config_t *config)
+{
+	errno_t rc = EOK;
+
+	if ((config->max_phones != 0) &&
+	    (config->min_phones > config->max_phones))
+		return EINVAL;
+
+	fibril_mutex_lock(&async_sess_mutex);
+
+	sess->pool = *config;
+
+	if (async_sess_mgmt(sess) == EXCHANGE_PARALLEL) {
+		while (sess->phones < config->min_phones) {
+			async_exch_t *exch;
+
+			rc = async_pool_connect(sess, &exch);
+			if (rc != EOK)
+				break;
+
+			getuptime(&exch->idle_since);
+			list_append(&exch->sess_link, &sess->exch_list);
+			list_append(&exch->global_link, &inactive_exch_list);
+		}
+	}
+
+	/* A lower limit may let waiters fail, a higher one serve them. */
+	fibril_condvar_broadcast(&avail_phone_cv);
+
+	fibril_mutex_unlock(&async_sess_mutex);
+	return rc;
+}
+
+/** Get the exchange pool statistics of a session.
+ *
+ * @param sess  Session.
+ * @param stats Place to store the statistics.
+ *
+ */
+void async_sess_pool_stats(async_sess_t *sess, async_pool_stats_t *stats)
+{
+	fibril_mutex_lock(&async_sess_mutex);
+
+	*stats = sess->pool_stats;
+	stats->phones = sess->phones;
+	stats->active = sess->exchanges;
+	stats->preferred = sess->preferred;
 
 	fibril_mutex_unlock(&async_sess_mutex);
 }
@@ -1328,6 +1974,27 @@ errno_t async_data_read_start(async_exch_t *exch, void *dst, size_t size)
 	    (sysarg_t) size);
 }
 
+/** Start IPC_M_DATA_WRITE using the async framework.
+ *
+ * The kernel may read large source buffers only when the receiver accepts
+ * the data. The buffer must not be modified or freed until the call is
+ * answered.
+ *
+ * @param exch    Exchange for sending the message.
+ * @param src     Address of the beginning of the source buffer.
+ * @param size    Size of the source buffer (in bytes).
+ * @param dataptr Storage of call data (arg 2 holds actual data size).
+ *
+ * @return Hash of the sent message or 0 on error.
+ *
+ */
+aid_t async_data_write(async_exch_t *exch, const void *src, size_t size,
+    ipc_call_t *dataptr)
+{
+	return async_send_2(exch, IPC_M_DATA_WRITE, (sysarg_t) src,
+	    (sysarg_t) size, dataptr);
+}
+
 /** Wrapper for IPC_M_DATA_WRITE calls using the async framework.
  *
  * @param exch Exchange for sending the message.
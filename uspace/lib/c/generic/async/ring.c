@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared-memory IPC rings.
+ *
+ * A session can opt in to send its requests through a pair of rings in an
+ * address space area shared with the server instead of making a system call
+ * per message. The client posts requests to the submission queue, the
+ * server posts answers to the completion queue. Each side has a thread
+ * which consumes the queue produced by the other side and hands the
+ * messages to the fibrils. The kernel is only entered to ring the doorbell
+ * of a consumer which has gone to sleep because its queue was empty.
+ *
+ * Only requests whose sender waits for the answer before doing anything
+ * else on the session (async_req_*()) travel through the rings. They cannot
+ * overtake anything sent through the phone, because a request is only sent
+ * through the ring when no answer to a call sent through the phone is
+ * pending. System methods always go through the kernel.
+ */
+
+#define _LIBC_ASYNC_C_
+#include <ipc/ipc.h>
+#include <async.h>
+#include "../private/async.h"
+#include "../private/ring.h"
+#undef _LIBC_ASYNC_C_
+
+#include <abi/synch.h>
+#include <as.h>
+#include <assert.h>
+#include <errno.h>
+#include <libc.h>
+#include <mem.h>
+#include <stdlib.h>
+#include "../private/libc.h"
+#include "../private/thread.h"
+
+#define RING_INDEX_MASK  (ASYNC_RING_ENTRIES - 1)
+
+static_assert((ASYNC_RING_ENTRIES & RING_INDEX_MASK) == 0,
+    "ASYNC_RING_ENTRIES must be a power of two");
+
+static errno_t ipc_ring_create(cap_ring_handle_t *handle)
+{
+	return (errno_t) __SYSCALL1(SYS_IPC_RING_CREATE, (sysarg_t) handle);
+}
+
+static errno_t ipc_ring_wait(cap_ring_handle_t handle, ipc_ring_side_t side)
+{
+	return (errno_t) __SYSCALL3(SYS_IPC_RING_WAIT, (sysarg_t) handle,
+	    (sysarg_t) side, SYNCH_NO_TIMEOUT);
+}
+
+static errno_t ipc_ring_notify(cap_ring_handle_t handle, ipc_ring_side_t side)
+{
+	return (errno_t) __SYSCALL2(SYS_IPC_RING_NOTIFY, (sysarg_t) handle,
+	    (sysarg_t) side);
+}
+
+static errno_t ipc_ring_destroy(cap_ring_handle_t handle)
+{
+	return (errno_t) __SYSCALL1(SYS_IPC_RING_DESTROY, (sysarg_t) handle);
+}
+
+static async_ring_t *ring_create(ipc_ring_side_t side)
+{
+	async_ring_t *ring = calloc(1, sizeof(async_ring_t));
+	if (!ring)
+		return NULL;
+
+	if (fibril_rmutex_initialize(&ring->lock) != EOK) {
+		free(ring);
+		return NULL;
+	}
+
+	refcount_init(&ring->refcnt);
+	ring->side = side;
+	ring->shared = AS_MAP_FAILED;
+	ring->handle = CAP_NIL;
+	atomic_init(&ring->closed, false);
+	atomic_init(&ring->phone_calls, 0);
+	atomic_init(&ring->pending, 0);
+
+	return ring;
+}
+
+void async_ring_add_ref(async_ring_t *ring)
+{
+	refcount_up(&ring->refcnt);
+}
+
+/** Drop a reference to a ring.
+ *
+ * The shared area is unmapped when the last reference is dropped.
+ */
+void async_ring_put(async_ring_t *ring)
+{
+	if (!refcount_down(&ring->refcnt))
+		return;
+
+	if (ring->shared != AS_MAP_FAILED)
+		as_area_destroy(ring->shared);
+
+	fibril_rmutex_destroy(&ring->lock);
+	free(ring);
+}
+
+/** Append an entry to a queue produced by this side.
+ *
+ * The caller guarantees that the queue has a free entry.
+ *
+ * @param ring  Local ring state.
+ * @param queue Queue to append to.
+ * @param entry Entry to append.
+ */
+static void ring_push(async_ring_t *ring, async_ring_queue_t *queue,
+    const async_ring_entry_t *entry)
+{
+	fibril_rmutex_lock(&ring->lock);
+
+	size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	queue->entries[tail & RING_INDEX_MASK] = *entry;
+	atomic_store(&queue->tail, tail + 1);
+
+	fibril_rmutex_unlock(&ring->lock);
+
+	/* Ring the doorbell only if the consumer has gone to sleep. */
+	if ((atomic_exchange(&queue->sleeping, false)) &&
+	    (!atomic_load(&ring->closed))) {
+		ipc_ring_side_t peer = (ring->side == IPC_RING_CLIENT) ?
+		    IPC_RING_SERVER : IPC_RING_CLIENT;
+		(void) ipc_ring_notify(ring->handle, peer);
+	}
+}
+
+/** Take the next entry from a queue produced by the other side.
+ *
+ * If the queue is empty, the caller sleeps until the other side rings the
+ * doorbell. The entry is copied out of the shared area before it is
+ * looked at, since the other side may keep changing it.
+ *
+ * @param ring  Local ring state.
+ * @param queue Queue to take the entry from.
+ * @param entry Storage for the entry.
+ *
+ * @return EOK on success, EHANGUP if the rings have been closed by any
+ *         side or another error code if waiting for the doorbell failed.
+ */
+static errno_t ring_pop(async_ring_t *ring, async_ring_queue_t *queue,
+    async_ring_entry_t *entry)
+{
+	while (!atomic_load(&ring->closed)) {
+		size_t head = atomic_load_explicit(&queue->head,
+		    memory_order_relaxed);
+
+		if (atomic_load_explicit(&queue->tail,
+		    memory_order_acquire) != head) {
+			*entry = queue->entries[head & RING_INDEX_MASK];
+			atomic_store_explicit(&queue->head, head + 1,
+			    memory_order_release);
+			return EOK;
+		}
+
+		/*
+		 * Announce that we are going to sleep and check once more.
+		 * A producer which appends an entry after the check will see
+		 * the flag and ring the doorbell.
+		 */
+		atomic_store(&queue->sleeping, true);
+		if (atomic_load(&queue->tail) == head) {
+			errno_t rc = ipc_ring_wait(ring->handle, ring->side);
+			if ((rc != EOK) && (rc != EINTR))
+				return rc;
+		}
+		atomic_store(&queue->sleeping, false);
+	}
+
+	return EHANGUP;
+}
+
+/** Mark the rings closed for the local producers. */
+static void ring_mark_closed(async_ring_t *ring)
+{
+	fibril_rmutex_lock(&ring->lock);
+	atomic_store(&ring->closed, true);
+	fibril_rmutex_unlock(&ring->lock);
+}
+
+/** Hand an answer received through the completion queue to its sender. */
+static void ring_complete(async_ring_t *ring, sysarg_t tag,
+    const sysarg_t *args)
+{
+	/* The tag comes from the server and must be checked. */
+	if (tag >= ASYNC_RING_ENTRIES)
+		return;
+
+	fibril_rmutex_lock(&ring->lock);
+	void *msg = ring->slots[tag];
+	ring->slots[tag] = NULL;
+	fibril_rmutex_unlock(&ring->lock);
+
+	if (!msg)
+		return;
+
+	ipc_call_t call;
+	memset(&call, 0, sizeof(call));
+	memcpy(call.args, args, sizeof(call.args));
+	call.flags = IPC_CALL_ANSWERED | IPC_CALL_RING;
+	call.answer_label = (sysarg_t) msg;
+
+	async_reply_received(&call);
+}
+
+/** Client thread consuming the completion queue. */
+static void ring_client_thread(void *arg)
+{
+	async_ring_t *ring = (async_ring_t *) arg;
+	async_ring_entry_t entry;
+
+	while (ring_pop(ring, &ring->shared->cq, &entry) == EOK)
+		ring_complete(ring, entry.tag, entry.args);
+
+	/* The server will not answer the requests still in flight. */
+	ring_mark_closed(ring);
+
+	sysarg_t args[IPC_CALL_LEN] = { EHANGUP };
+	for (sysarg_t tag = 0; tag < ASYNC_RING_ENTRIES; tag++)
+		ring_complete(ring, tag, args);
+
+	fibril_notify(&ring->done);
+}
+
+/** Post an answer to the completion queue. */
+static void ring_post_answer(async_ring_t *ring, sysarg_t tag, errno_t retval,
+    sysarg_t arg1, sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5)
+{
+	async_ring_entry_t entry = {
+		.args = { retval, arg1, arg2, arg3, arg4, arg5 },
+		.tag = tag
+	};
+
+	ring_push(ring, &ring->shared->cq, &entry);
+}
+
+/** Server thread consuming the submission queue. */
+static void ring_server_thread(void *arg)
+{
+	async_ring_t *ring = (async_ring_t *) arg;
+	async_ring_entry_t entry;
+
+	while (ring_pop(ring, &ring->shared->sq, &entry) == EOK) {
+		if (entry.args[0] < IPC_FIRST_USER_METHOD) {
+			/* System methods must go through the kernel. */
+			ring_post_answer(ring, entry.tag, EPERM, 0, 0, 0, 0, 0);
+			continue;
+		}
+
+		/*
+		 * A well-behaved client never has more requests in flight
+		 * than there are entries in the completion queue.
+		 */
+		if (atomic_load(&ring->pending) >= ASYNC_RING_ENTRIES) {
+			ring_post_answer(ring, entry.tag, ELIMIT, 0, 0, 0, 0, 0);
+			continue;
+		}
+
+		ipc_call_t call;
+		memset(&call, 0, sizeof(call));
+		memcpy(call.args, entry.args, sizeof(call.args));
+		call.task_id = ring->in_task_id;
+		call.flags = IPC_CALL_RING;
+		call.request_label = (sysarg_t) ring;
+		call.answer_label = entry.tag;
+		call.cap_handle = ASYNC_RING_CALL;
+
+		/* The reference is dropped when the call is answered. */
+		atomic_fetch_add(&ring->pending, 1);
+		async_ring_add_ref(ring);
+
+		if (mpsc_send(ring->channel, &call) != EOK)
+			async_ring_answer(&call, EHANGUP, 0, 0, 0, 0, 0);
+	}
+
+	ring_mark_closed(ring);
+	fibril_notify(&ring->done);
+}
+
+/** Set up a pair of rings for a session.
+ *
+ * @param exch Exchange of the session.
+ * @param out  Place to store the client side of the rings.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t async_ring_connect(async_exch_t *exch, async_ring_t **out)
+{
+	async_ring_t *ring = ring_create(IPC_RING_CLIENT);
+	if (!ring)
+		return ENOMEM;
+
+	ring->shared = as_area_create(AS_AREA_ANY, sizeof(async_ring_shared_t),
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (ring->shared == AS_MAP_FAILED) {
+		async_ring_put(ring);
+		return ENOMEM;
+	}
+
+	memset(ring->shared, 0, sizeof(async_ring_shared_t));
+
+	errno_t rc = ipc_ring_create(&ring->handle);
+	if (rc != EOK) {
+		async_ring_put(ring);
+		return rc;
+	}
+
+	rc = async_req_3_0(exch, IPC_M_RING_SHARE, (sysarg_t) ring->shared, 0,
+	    (sysarg_t) ring->handle);
+	if (rc != EOK) {
+		(void) ipc_ring_destroy(ring->handle);
+		async_ring_put(ring);
+		return rc;
+	}
+
+	thread_id_t tid;
+	rc = thread_create(ring_client_thread, ring, "async ring", &tid);
+	if (rc != EOK) {
+		(void) ipc_ring_destroy(ring->handle);
+		async_ring_put(ring);
+		return rc;
+	}
+
+	thread_detach(tid);
+
+	*out = ring;
+	return EOK;
+}
+
+/** Accept the IPC_M_RING_SHARE call.
+ *
+ * The call is answered in any case.
+ *
+ * @param call    IPC_M_RING_SHARE call.
+ * @param channel Channel of the connection to route the requests to.
+ * @param out     Place to store the server side of the rings.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t async_ring_accept(ipc_call_t *call, mpsc_t *channel,
+    async_ring_t **out)
+{
+	cap_call_handle_t chandle = call->cap_handle;
+	assert(chandle != CAP_NIL);
+	call->cap_handle = CAP_NIL;
+
+	cap_ring_handle_t handle = (cap_ring_handle_t) ipc_get_arg4(call);
+	if ((ipc_get_arg2(call) < sizeof(async_ring_shared_t)) ||
+	    (!cap_handle_valid(handle))) {
+		ipc_answer_0(chandle, EINVAL);
+		return EINVAL;
+	}
+
+	async_ring_t *ring = ring_create(IPC_RING_SERVER);
+	if (!ring) {
+		ipc_answer_0(chandle, ENOMEM);
+		return ENOMEM;
+	}
+
+	ring->channel = channel;
+	ring->in_task_id = call->task_id;
+
+	void *dst;
+	errno_t rc = ipc_answer_2(chandle, EOK, (sysarg_t) __progsymbols.end,
+	    (sysarg_t) &dst);
+	if (rc != EOK) {
+		async_ring_put(ring);
+		return rc;
+	}
+
+	/* The kernel has published the capability along with the area. */
+	ring->shared = dst;
+	ring->handle = handle;
+
+	thread_id_t tid;
+	rc = thread_create(ring_server_thread, ring, "async ring", &tid);
+	if (rc != EOK) {
+		(void) ipc_ring_destroy(ring->handle);
+		async_ring_put(ring);
+		return rc;
+	}
+
+	thread_detach(tid);
+
+	*out = ring;
+	return EOK;
+}
+
+/** Tear down one side of a pair of rings.
+ *
+ * The consumer thread is stopped. The other side sees the rings closed.
+ * Requests which have not been answered yet keep the shared area mapped.
+ *
+ * @param ring Local ring state.
+ */
+void async_ring_destroy(async_ring_t *ring)
+{
+	ring_mark_closed(ring);
+
+	/* Dropping the capability wakes up the consumer thread. */
+	(void) ipc_ring_destroy(ring->handle);
+	fibril_wait_for(&ring->done);
+
+	async_ring_put(ring);
+}
+
+/** Send a request through the submission queue.
+ *
+ * @param ring    Client side of the rings.
+ * @param imethod Interface and method of the call.
+ * @param arg1    Service-defined payload argument.
+ * @param arg2    Service-defined payload argument.
+ * @param arg3    Service-defined payload argument.
+ * @param arg4    Service-defined payload argument.
+ * @param arg5    Service-defined payload argument.
+ * @param msg     Message the answer will be handed to.
+ *
+ * @return EOK on success, ELIMIT if too many requests are in flight or
+ *         EHANGUP if the rings have been closed.
+ */
+errno_t async_ring_send(async_ring_t *ring, sysarg_t imethod, sysarg_t arg1,
+    sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5, void *msg)
+{
+	fibril_rmutex_lock(&ring->lock);
+
+	if (atomic_load(&ring->closed)) {
+		fibril_rmutex_unlock(&ring->lock);
+		return EHANGUP;
+	}
+
+	sysarg_t tag;
+	for (tag = 0; tag < ASYNC_RING_ENTRIES; tag++) {
+		if (!ring->slots[tag])
+			break;
+	}
+
+	if (tag == ASYNC_RING_ENTRIES) {
+		fibril_rmutex_unlock(&ring->lock);
+		return ELIMIT;
+	}
+
+	ring->slots[tag] = msg;
+	fibril_rmutex_unlock(&ring->lock);
+
+	async_ring_entry_t entry = {
+		.args = { imethod, arg1, arg2, arg3, arg4, arg5 },
+		.tag = tag
+	};
+
+	ring_push(ring, &ring->shared->sq, &entry);
+	return EOK;
+}
+
+/** Answer a call received through the submission queue.
+ *
+ * @param call   Call to answer.
+ * @param retval Return value.
+ * @param arg1   Service-defined return value.
+ * @param arg2   Service-defined return value.
+ * @param arg3   Service-defined return value.
+ * @param arg4   Service-defined return value.
+ * @param arg5   Service-defined return value.
+ *
+ * @return Always EOK.
+ */
+errno_t async_ring_answer(ipc_call_t *call, errno_t retval, sysarg_t arg1,
+    sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5)
+{
+	assert(call->flags & IPC_CALL_RING);
+	assert(call->cap_handle == ASYNC_RING_CALL);
+	call->cap_handle = CAP_NIL;
+
+	async_ring_t *ring = (async_ring_t *) call->request_label;
+
+	ring_post_answer(ring, call->answer_label, retval, arg1, arg2, arg3,
+	    arg4, arg5);
+
+	atomic_fetch_sub(&ring->pending, 1);
+	async_ring_put(ring);
+
+	return EOK;
+}
+
+/** @}
+ */
@@ -99,6 +99,7 @@
 #include <ipc/ipc.h>
 #include <async.h>
 #include "../private/async.h"
+#include "../private/ring.h"
 #undef _LIBC_ASYNC_C_
 
 #include <ipc/irq.h>
@@ -122,6 +123,9 @@
 
 #define DPRINTF(...)  ((void) 0)
 
+/** Number of calls the manager takes from the fibril runtime at once. */
+#define ASYNC_MANAGER_BATCH  8
+
 /* Client connection data */
 typedef struct {
 	ht_link_t link;
@@ -148,6 +152,9 @@ typedef struct {
 	/** Channel for messages that should be delivered to this fibril. */
 	mpsc_t *msg_channel;
 
+	/** Shared-memory rings the client sends requests through, if any. */
+	async_ring_t *ring;
+
 	/** Call data of the opening call. */
 	ipc_call_t call;
 
@@ -360,8 +367,19 @@ static errno_t connection_fibril(void *arg)
 	 * Answer all remaining messages with EHANGUP.
 	 */
 	ipc_call_t call;
-	while (mpsc_receive(c, &call, NULL) == EOK)
-		ipc_answer_0(call.cap_handle, EHANGUP);
+	while (mpsc_receive(c, &call, NULL) == EOK) {
+		if (call.flags & IPC_CALL_RING)
+			async_ring_answer(&call, EHANGUP, 0, 0, 0, 0, 0);
+		else
+			ipc_answer_0(call.cap_handle, EHANGUP);
+	}
+
+	/*
+	 * Stop receiving requests through the rings. This must be done
+	 * before the channel is destroyed.
+	 */
+	if (fibril_connection->ring)
+		async_ring_destroy(fibril_connection->ring);
 
 	/*
 	 * Clean up memory.
@@ -729,6 +747,10 @@ static notification_t *notification_create(async_notification_handler_t handler,
 }
 
 /** Subscribe to IRQ notification.
+ *
+ * The moderation member of @a ucode allows to trade a bounded notification
+ * delay for fewer notifications. The handler can find out how many
+ * interrupts a notification stands for using ipc_get_irq_count().
  *
  * @param inr     IRQ number.
  * @param handler Notification handler.
@@ -856,8 +878,23 @@ bool async_get_call_timeout(ipc_call_t *call, usec_t usecs)
 		expires = &ts;
 	}
 
-	errno_t rc = mpsc_receive(fibril_connection->msg_channel,
-	    call, expires);
+	errno_t rc;
+
+	while (true) {
+		rc = mpsc_receive(fibril_connection->msg_channel, call,
+		    expires);
+		if ((rc != EOK) || (ipc_get_imethod(call) != IPC_M_RING_SHARE))
+			break;
+
+		/* The rings are handled by the async framework itself. */
+		if (fibril_connection->ring) {
+			async_answer_0(call, EEXIST);
+			continue;
+		}
+
+		(void) async_ring_accept(call, fibril_connection->msg_channel,
+		    &fibril_connection->ring);
+	}
 
 	if (rc == ETIMEOUT)
 		return false;
@@ -979,13 +1016,18 @@ static void handle_call(ipc_call_t *call)
  */
 static errno_t async_manager_worker(void)
 {
-	ipc_call_t call;
+	ipc_call_t calls[ASYNC_MANAGER_BATCH];
+	size_t received;
 	errno_t rc;
 
 	while (true) {
-		rc = fibril_ipc_wait(&call, NULL);
-		if (rc == EOK)
-			handle_call(&call);
+		rc = fibril_ipc_wait_multi(calls, ASYNC_MANAGER_BATCH, NULL,
+		    &received);
+		if (rc != EOK)
+			continue;
+
+		for (size_t i = 0; i < received; i++)
+			handle_call(&calls[i]);
 	}
 
 	return 0;
@@ -1039,16 +1081,38 @@ void __async_server_fini(void)
 	fibril_rmutex_destroy(&notification_mutex);
 }
 
+/** Concurrency advertised to clients when accepting connections. */
+static size_t preferred_concurrency = 0;
+
+/** Advertise the number of parallel connections the server prefers.
+ *
+ * The value is passed to the clients in the answers to their connection
+ * requests and limits the number of data phones of parallel sessions
+ * which do not configure the limit themselves.
+ *
+ * @param concurrency Preferred number of connections per client, zero
+ *                    for no preference.
+ *
+ */
+void async_set_preferred_concurrency(size_t concurrency)
+{
+	preferred_concurrency = concurrency;
+}
+
 errno_t async_accept_0(ipc_call_t *call)
 {
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
-	return ipc_answer_5(chandle, EOK, 0, 0, 0, 0, async_get_label());
+	return ipc_answer_5(chandle, EOK, preferred_concurrency, 0, 0, 0,
+	    async_get_label());
 }
 
 errno_t async_answer_0(ipc_call_t *call, errno_t retval)
 {
+	if (call->flags & IPC_CALL_RING)
+		return async_ring_answer(call, retval, 0, 0, 0, 0, 0);
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1057,6 +1121,9 @@ errno_t async_answer_0(ipc_call_t *call, errno_t retval)
 
 errno_t async_answer_1(ipc_call_t *call, errno_t retval, sysarg_t arg1)
 {
+	if (call->flags & IPC_CALL_RING)
+		return async_ring_answer(call, retval, arg1, 0, 0, 0, 0);
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1066,6 +1133,9 @@ errno_t async_answer_1(ipc_call_t *call, errno_t retval, sysarg_t arg1)
 errno_t async_answer_2(ipc_call_t *call, errno_t retval, sysarg_t arg1,
     sysarg_t arg2)
 {
+	if (call->flags & IPC_CALL_RING)
+		return async_ring_answer(call, retval, arg1, arg2, 0, 0, 0);
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1075,6 +1145,9 @@ errno_t async_answer_2(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 errno_t async_answer_3(ipc_call_t *call, errno_t retval, sysarg_t arg1,
     sysarg_t arg2, sysarg_t arg3)
 {
+	if (call->flags & IPC_CALL_RING)
+		return async_ring_answer(call, retval, arg1, arg2, arg3, 0, 0);
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1084,6 +1157,9 @@ errno_t async_answer_3(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 errno_t async_answer_4(ipc_call_t *call, errno_t retval, sysarg_t arg1,
     sysarg_t arg2, sysarg_t arg3, sysarg_t arg4)
 {
+	if (call->flags & IPC_CALL_RING)
+		return async_ring_answer(call, retval, arg1, arg2, arg3, arg4, 0);
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1093,6 +1169,9 @@ errno_t async_answer_4(ipc_call_t *call, errno_t retval, sysarg_t arg1,
 errno_t async_answer_5(ipc_call_t *call, errno_t retval, sysarg_t arg1,
     sysarg_t arg2, sysarg_t arg3, sysarg_t arg4, sysarg_t arg5)
 {
+	if (call->flags & IPC_CALL_RING)
+		return async_ring_answer(call, retval, arg1, arg2, arg3, arg4, arg5);
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1104,6 +1183,12 @@ static errno_t async_forward_fast(ipc_call_t *call, async_exch_t *exch,
 {
 	assert(call);
 
+	/* Calls received through the rings cannot be forwarded. */
+	if (call->flags & IPC_CALL_RING) {
+		async_ring_answer(call, ENOTSUP, 0, 0, 0, 0, 0);
+		return ENOTSUP;
+	}
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1121,6 +1206,12 @@ static errno_t async_forward_slow(ipc_call_t *call, async_exch_t *exch,
 {
 	assert(call);
 
+	/* Calls received through the rings cannot be forwarded. */
+	if (call->flags & IPC_CALL_RING) {
+		async_ring_answer(call, ENOTSUP, 0, 0, 0, 0, 0);
+		return ENOTSUP;
+	}
+
 	cap_call_handle_t chandle = call->cap_handle;
 	assert(chandle != CAP_NIL);
 	call->cap_handle = CAP_NIL;
@@ -1307,6 +1398,31 @@ errno_t async_share_out_finalize(ipc_call_t *call, void **dst)
 	    (sysarg_t) dst);
 }
 
+/** Wrapper for answering the IPC_M_SHARE_OUT calls with a private copy.
+ *
+ * Unlike async_share_out_finalize(), the recipient does not share the area
+ * with the sender. It receives a copy-on-write snapshot of the area instead,
+ * so later writes of either party are not visible to the other one.
+ *
+ * @param call  IPC_M_SHARE_OUT call to answer.
+ * @param dst   Address of the storage for the destination address space area
+ *              base address.
+ *
+ * @return  Zero on success or a value from @ref errno.h on failure.
+ *
+ */
+errno_t async_share_out_finalize_cow(ipc_call_t *call, void **dst)
+{
+	assert(call);
+
+	cap_call_handle_t chandle = call->cap_handle;
+	assert(chandle != CAP_NIL);
+	call->cap_handle = CAP_NIL;
+
+	return ipc_answer_3(chandle, EOK, (sysarg_t) __progsymbols.end,
+	    (sysarg_t) dst, AS_AREA_COW);
+}
+
 /** Wrapper for receiving the IPC_M_DATA_READ calls using the async framework.
  *
  * This wrapper only makes it more comfortable to receive IPC_M_DATA_READ
@@ -160,5 +160,62 @@ errno_t hw_res_dma_channel_remain(async_sess_t *sess, unsigned channel, size_t *
 	return ret;
 }
 
+/** Switch device to message signalled interrupts.
+ *
+ * The bus driver allocates up to @a count interrupt vectors, programs
+ * the device to use them and disables its legacy interrupt. Vector @c i
+ * is then delivered as interrupt number @a inr + @c i, which can be
+ * subscribed to like any other interrupt.
+ *
+ * @param sess  Session to the bus driver.
+ * @param count Number of vectors the device would like to use.
+ *
+ * @param[out] inr   Interrupt number of the first vector.
+ * @param[out] nvec  Number of vectors actually allocated, at least one.
+ *
+ * @return EOK on success, ENOTSUP if the device or the platform do not
+ *         support message signalled interrupts, ELIMIT if no vector is
+ *         available.
+ *
+ */
+errno_t hw_res_msi_alloc(async_sess_t *sess, size_t count, int *inr,
+    size_t *nvec)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+
+	sysarg_t first;
+	sysarg_t cnt;
+	const errno_t ret = async_req_2_2(exch, DEV_IFACE_ID(HW_RES_DEV_IFACE),
+	    HW_RES_MSI_ALLOC, count, &first, &cnt);
+
+	async_exchange_end(exch);
+
+	if (ret == EOK) {
+		*inr = first;
+		*nvec = cnt;
+	}
+
+	return ret;
+}
+
+/** Switch device back to its legacy interrupt.
+ *
+ * @param sess Session to the bus driver.
+ *
+ * @return Error code.
+ *
+ */
+errno_t hw_res_msi_free(async_sess_t *sess)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+
+	const errno_t ret = async_req_1_0(exch, DEV_IFACE_ID(HW_RES_DEV_IFACE),
+	    HW_RES_MSI_FREE);
+
+	async_exchange_end(exch);
+
+	return ret;
+}
+
 /** @}
  */
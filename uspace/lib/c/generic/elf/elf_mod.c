@@ -37,13 +37,19 @@
  * @brief	Userspace ELF module loader.
  *
  * This module allows loading ELF binaries (both executables and
- * shared objects) from VFS. The current implementation allocates
- * anonymous memory, fills it with segment data and then adjusts
- * the memory areas' flags to the final value. In the future,
- * the segments will be mapped directly from the file.
+ * shared objects) from VFS. Read-only segments, such as program text
+ * and constant data, are mapped directly from the VFS page cache, so
+ * all tasks running the same file share their frames. Writable segments
+ * get anonymous memory, which is filled with segment data, and then the
+ * memory areas' flags are adjusted to the final value.
  */
 
+#include <async.h>
 #include <errno.h>
+#include <fibril_synch.h>
+#include <ipc/services.h>
+#include <ipc/vfs.h>
+#include <ns.h>
 #include <stdio.h>
 #include <vfs/vfs.h>
 #include <stddef.h>
@@ -67,6 +73,10 @@ static errno_t elf_load_module(elf_ld_t *elf);
 static errno_t segment_header(elf_ld_t *elf, elf_segment_header_t *entry);
 static errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry);
 
+/** Session with the VFS pager, backing read-only segments. */
+static async_sess_t *elf_pager_sess;
+static FIBRIL_MUTEX_INITIALIZE(elf_pager_mutex);
+
 /** Load ELF binary from a file.
  *
  * Load an ELF binary from the specified file. If the file is
@@ -98,10 +108,13 @@ errno_t elf_load_file(int file, eld_flags_t flags, elf_finfo_t *info)
 	elf.fd = ofile;
 	elf.info = info;
 	elf.flags = flags;
+	elf.mapped = false;
 
 	rc = elf_load_module(&elf);
 
-	vfs_put(ofile);
+	/* Segments mapped from the file are paged in through the handle. */
+	if (!elf.mapped)
+		vfs_put(ofile);
 	return rc;
 }
 
@@ -371,6 +384,82 @@ static errno_t segment_header(elf_ld_t *elf, elf_segment_header_t *entry)
 	return EOK;
 }
 
+/** Get a session with the VFS pager.
+ *
+ * @return Session or NULL if the pager is not available.
+ */
+static async_sess_t *elf_pager_get(void)
+{
+	fibril_mutex_lock(&elf_pager_mutex);
+	if (elf_pager_sess == NULL) {
+		elf_pager_sess = service_connect_blocking(SERVICE_VFS,
+		    INTERFACE_PAGER, 0, NULL);
+	}
+	fibril_mutex_unlock(&elf_pager_mutex);
+
+	return elf_pager_sess;
+}
+
+/** Map a read-only segment from the VFS page cache.
+ *
+ * The frames of the page cache are mapped directly, so the segment
+ * shares memory with all other tasks which map the same file.
+ *
+ * @param elf	Loader state.
+ * @param entry Program header entry describing segment to be mapped.
+ * @param base	Page-aligned link-time address of the segment.
+ * @param size	Size of the area starting at @a base.
+ * @param flags	Final flags of the area.
+ *
+ * @return EOK on success, ENOTSUP if the segment has to be loaded
+ *         into anonymous memory instead, error code otherwise.
+ */
+static errno_t map_segment(elf_ld_t *elf, elf_segment_header_t *entry,
+    uintptr_t base, size_t size, int flags)
+{
+	/* The caller wants to modify the segments */
+	if ((elf->flags & ELDF_RW) != 0)
+		return ENOTSUP;
+
+	if ((flags & AS_AREA_WRITE) != 0)
+		return ENOTSUP;
+
+	/* Memory past the file image would not be zero-filled */
+	if (entry->p_memsz != entry->p_filesz)
+		return ENOTSUP;
+
+	/* The area must start at a page boundary in the file, too */
+	if (entry->p_offset < entry->p_vaddr - base)
+		return ENOTSUP;
+
+	aoff64_t offset = entry->p_offset - (entry->p_vaddr - base);
+	if (ALIGN_DOWN(offset, PAGE_SIZE) != offset)
+		return ENOTSUP;
+
+	async_sess_t *sess = elf_pager_get();
+	if (sess == NULL)
+		return ENOTSUP;
+
+	void *a = async_as_area_create((uint8_t *) base + elf->bias, size,
+	    flags, sess, elf->fd, VFS_PAGER_SHARED, offset);
+	if (a == AS_MAP_FAILED) {
+		DPRINTF("pager mapping failed (%p, %zu)\n",
+		    (void *) (base + elf->bias), size);
+		return ENOTSUP;
+	}
+
+	elf->mapped = true;
+
+	if (flags & AS_AREA_EXEC) {
+		/* Enforce SMC coherence for the segment */
+		if (smc_coherence((void *) (entry->p_vaddr + elf->bias),
+		    entry->p_filesz))
+			return ENOMEM;
+	}
+
+	return EOK;
+}
+
 /** Load segment described by program header entry.
  *
  * @param elf	Loader state.
@@ -432,6 +521,10 @@ errno_t load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 	    (void *) (entry->p_vaddr + bias +
 	    ALIGN_UP(entry->p_memsz, PAGE_SIZE)));
 
+	rc = map_segment(elf, entry, base, mem_sz, flags);
+	if (rc != ENOTSUP)
+		return rc;
+
 	/*
 	 * For the course of loading, the area needs to be readable
 	 * and writeable.
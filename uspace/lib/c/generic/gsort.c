@@ -32,14 +32,17 @@
 
 /**
  * @file
- * @brief Gnome Sort.
+ * @brief Stable sort.
  *
- * This file contains an implementation of gnome sort
+ * This file contains an implementation of an in-place stable sort.
+ * The function is still called gsort for historical reasons (it used to
+ * be gnome sort).
  *
  */
 
 #include <gsort.h>
 #include <inttypes.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 
@@ -56,44 +59,164 @@
  */
 #define INDEX(buf, i, elem_size)  ((buf) + (i) * (elem_size))
 
-/** Gnome sort
+/** Elements are first sorted in runs of this length using insertion sort */
+#define RUN_SIZE  16
+
+/** Sort specification */
+typedef struct {
+	void *data;
+	size_t elem_size;
+	sort_cmp_t cmp;
+	void *arg;
+	/** Scratch memory buffer elem_size bytes long */
+	void *slot;
+} gs_spec_t;
+
+/** Determine if one element is less-than another element. */
+static bool elem_lt(gs_spec_t *gs, size_t i, size_t j)
+{
+	return gs->cmp(INDEX(gs->data, i, gs->elem_size),
+	    INDEX(gs->data, j, gs->elem_size), gs->arg) < 0;
+}
+
+/** Swap two elements. */
+static void elem_swap(gs_spec_t *gs, size_t i, size_t j)
+{
+	memcpy(gs->slot, INDEX(gs->data, i, gs->elem_size), gs->elem_size);
+	memcpy(INDEX(gs->data, i, gs->elem_size),
+	    INDEX(gs->data, j, gs->elem_size), gs->elem_size);
+	memcpy(INDEX(gs->data, j, gs->elem_size), gs->slot, gs->elem_size);
+}
+
+/** Sort the range [lo, hi) using insertion sort. */
+static void insertion_sort(gs_spec_t *gs, size_t lo, size_t hi)
+{
+	size_t i, j;
+
+	for (i = lo + 1; i < hi; i++) {
+		for (j = i; j > lo && elem_lt(gs, j, j - 1); j--)
+			elem_swap(gs, j, j - 1);
+	}
+}
+
+/** Reverse the range [lo, hi). */
+static void reverse(gs_spec_t *gs, size_t lo, size_t hi)
+{
+	while (hi - lo > 1)
+		elem_swap(gs, lo++, --hi);
+}
+
+/** Exchange the adjacent ranges [lo, mid) and [mid, hi). */
+static void rotate(gs_spec_t *gs, size_t lo, size_t mid, size_t hi)
+{
+	reverse(gs, lo, mid);
+	reverse(gs, mid, hi);
+	reverse(gs, lo, hi);
+}
+
+/** Merge the sorted adjacent ranges [lo, mid) and [mid, hi) in place.
+ *
+ * Uses the SymMerge algorithm by Kim and Kutzner, which is stable and
+ * needs O(n log n) element moves and no extra memory besides the stack.
+ */
+static void merge(gs_spec_t *gs, size_t lo, size_t mid, size_t hi)
+{
+	size_t start, end, half, pivot, r, c;
+
+	if (mid - lo == 1) {
+		/* Insert the single left element into the right range */
+		start = mid;
+		end = hi;
+		while (start < end) {
+			c = start + (end - start) / 2;
+			if (elem_lt(gs, c, lo))
+				start = c + 1;
+			else
+				end = c;
+		}
+
+		for (c = lo; c + 1 < start; c++)
+			elem_swap(gs, c, c + 1);
+		return;
+	}
+
+	if (hi - mid == 1) {
+		/* Insert the single right element into the left range */
+		start = lo;
+		end = mid;
+		while (start < end) {
+			c = start + (end - start) / 2;
+			if (!elem_lt(gs, mid, c))
+				start = c + 1;
+			else
+				end = c;
+		}
+
+		for (c = mid; c > start; c--)
+			elem_swap(gs, c, c - 1);
+		return;
+	}
+
+	half = lo + (hi - lo) / 2;
+	pivot = half + mid;
+	if (mid > half) {
+		start = pivot - hi;
+		r = half;
+	} else {
+		start = lo;
+		r = mid;
+	}
+
+	while (start < r) {
+		c = start + (r - start) / 2;
+		if (!elem_lt(gs, pivot - c - 1, c))
+			start = c + 1;
+		else
+			r = c;
+	}
+
+	end = pivot - start;
+	if (start < mid && mid < end)
+		rotate(gs, start, mid, end);
+	if (lo < start && start < half)
+		merge(gs, lo, start, half);
+	if (half < end && end < hi)
+		merge(gs, half, end, hi);
+}
+
+/** Stable sort
  *
- * Apply generic gnome sort algorithm on supplied data,
- * using pre-allocated buffer.
+ * Sort runs of RUN_SIZE elements using insertion sort and then merge
+ * them pairwise in place. Merging is skipped where two runs are already
+ * in order, so sorted input takes linear time.
  *
- * @param data      Pointer to data to be sorted.
- * @param cnt       Number of elements to be sorted.
- * @param elem_size Size of one element.
- * @param cmp       Comparator function.
- * @param arg       3rd argument passed to cmp.
- * @param slot      Pointer to scratch memory buffer
- *                  elem_size bytes long.
+ * @param gs Sort specification.
+ * @param cnt Number of elements to be sorted.
  *
  */
-static void _gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp,
-    void *arg, void *slot)
+static void _gsort(gs_spec_t *gs, size_t cnt)
 {
-	size_t i = 0;
-
-	while (i < cnt) {
-		if ((i != 0) &&
-		    (cmp(INDEX(data, i, elem_size),
-		    INDEX(data, i - 1, elem_size), arg) < 0)) {
-			memcpy(slot, INDEX(data, i, elem_size), elem_size);
-			memcpy(INDEX(data, i, elem_size), INDEX(data, i - 1, elem_size),
-			    elem_size);
-			memcpy(INDEX(data, i - 1, elem_size), slot, elem_size);
-			i--;
-		} else
-			i++;
+	size_t lo, mid, hi;
+	size_t width;
+
+	for (lo = 0; lo < cnt; lo += RUN_SIZE)
+		insertion_sort(gs, lo, min(lo + RUN_SIZE, cnt));
+
+	for (width = RUN_SIZE; width < cnt; width *= 2) {
+		for (lo = 0; lo + width < cnt; lo += 2 * width) {
+			mid = lo + width;
+			hi = min(mid + width, cnt);
+			if (elem_lt(gs, mid, mid - 1))
+				merge(gs, lo, mid, hi);
+		}
 	}
 }
 
-/** Gnome sort wrapper
+/** Stable sort wrapper
  *
  * This is only a wrapper that takes care of memory
  * allocations for storing the slot element for generic
- * gnome sort algorithm.
+ * stable sort algorithm.
  *
  * @param data      Pointer to data to be sorted.
  * @param cnt       Number of elements to be sorted.
@@ -116,7 +239,15 @@ bool gsort(void *data, size_t cnt, size_t elem_size, sort_cmp_t cmp, void *arg)
 	} else
 		slot = (void *) ibuf_slot;
 
-	_gsort(data, cnt, elem_size, cmp, arg, slot);
+	gs_spec_t gs = {
+		.data = data,
+		.elem_size = elem_size,
+		.cmp = cmp,
+		.arg = arg,
+		.slot = slot
+	};
+
+	_gsort(&gs, cnt);
 
 	if (elem_size > IBUF_SIZE)
 		free(slot);
@@ -79,6 +79,8 @@ chargrid_t *chargrid_create(sysarg_t cols, sysarg_t rows,
 	scrbuf->attrs.val.style = STYLE_NORMAL;
 
 	scrbuf->top_row = 0;
+	scrbuf->dirty_top = 0;
+	scrbuf->dirty_bottom = 0;
 	chargrid_clear(scrbuf);
 
 	return scrbuf;
@@ -105,6 +107,13 @@ static sysarg_t chargrid_update_rows(chargrid_t *scrbuf)
 	if (scrbuf->row == scrbuf->rows) {
 		scrbuf->row = scrbuf->rows - 1;
 		scrbuf->top_row = (scrbuf->top_row + 1) % scrbuf->rows;
+
+		/* Dirty rows move up together with the contents */
+		if (scrbuf->dirty_top > 0)
+			scrbuf->dirty_top--;
+		if (scrbuf->dirty_bottom > 0)
+			scrbuf->dirty_bottom--;
+
 		chargrid_clear_row(scrbuf, scrbuf->row);
 
 		return scrbuf->rows;
@@ -150,6 +159,7 @@ sysarg_t chargrid_putuchar(chargrid_t *scrbuf, char32_t ch, bool update)
 	field->ch = ch;
 	field->attrs = scrbuf->attrs;
 	field->flags |= CHAR_FLAG_DIRTY;
+	chargrid_set_dirty(scrbuf, scrbuf->row, scrbuf->row + 1);
 
 	if (update) {
 		scrbuf->col++;
@@ -249,6 +259,8 @@ void chargrid_clear(chargrid_t *scrbuf)
 		scrbuf->data[pos].flags = CHAR_FLAG_DIRTY;
 	}
 
+	chargrid_set_dirty(scrbuf, 0, scrbuf->rows);
+
 	scrbuf->col = 0;
 	scrbuf->row = 0;
 }
@@ -312,6 +324,67 @@ void chargrid_clear_row(chargrid_t *scrbuf, sysarg_t row)
 		field->attrs = scrbuf->attrs;
 		field->flags |= CHAR_FLAG_DIRTY;
 	}
+
+	chargrid_set_dirty(scrbuf, row, row + 1);
+}
+
+/** Mark range of rows as dirty.
+ *
+ * Functions modifying the chargrid do this automatically, this is needed
+ * only if the character fields are modified directly.
+ *
+ * @param scrbuf Chargrid.
+ * @param r0     First row to mark.
+ * @param r1     Row after the last row to mark.
+ *
+ */
+void chargrid_set_dirty(chargrid_t *scrbuf, sysarg_t r0, sysarg_t r1)
+{
+	if (r1 > scrbuf->rows)
+		r1 = scrbuf->rows;
+	if (r0 >= r1)
+		return;
+
+	if (scrbuf->dirty_top == scrbuf->dirty_bottom) {
+		scrbuf->dirty_top = r0;
+		scrbuf->dirty_bottom = r1;
+		return;
+	}
+
+	if (r0 < scrbuf->dirty_top)
+		scrbuf->dirty_top = r0;
+	if (r1 > scrbuf->dirty_bottom)
+		scrbuf->dirty_bottom = r1;
+}
+
+/** Get range of dirty rows.
+ *
+ * This allows redrawing only rows that might have changed since
+ * the last call to chargrid_clear_dirty().
+ *
+ * @param scrbuf Chargrid.
+ * @param r0     Place to store first dirty row.
+ * @param r1     Place to store row after the last dirty row.
+ *
+ * @return @c true if there are any dirty rows.
+ *
+ */
+bool chargrid_get_dirty(chargrid_t *scrbuf, sysarg_t *r0, sysarg_t *r1)
+{
+	*r0 = scrbuf->dirty_top;
+	*r1 = scrbuf->dirty_bottom;
+	return scrbuf->dirty_top < scrbuf->dirty_bottom;
+}
+
+/** Mark all rows as clean.
+ *
+ * @param scrbuf Chargrid.
+ *
+ */
+void chargrid_clear_dirty(chargrid_t *scrbuf)
+{
+	scrbuf->dirty_top = 0;
+	scrbuf->dirty_bottom = 0;
 }
 
 /** Set chargrid style.
@@ -129,6 +129,12 @@ FILE *stdin = NULL;
 FILE *stdout = NULL;
 FILE *stderr = NULL;
 
+/** Default buffer size for newly opened streams of each kind */
+static size_t stream_bufsize[STDIO_STREAM_LIMIT] = {
+	[STDIO_STREAM_FILE] = BUFSIZ,
+	[STDIO_STREAM_TERM] = BUFSIZ
+};
+
 static LIST_INITIALIZE(files);
 
 void __stdio_init(void)
@@ -294,20 +300,43 @@ void setbuf(FILE *stream, void *buf)
 	}
 }
 
+/** Set default buffer size for a kind of streams.
+ *
+ * Affects only streams opened after the call. Streams that already exist
+ * can be adjusted using setvbuf().
+ *
+ * @param kind Stream kind.
+ * @param size New default buffer size, zero to restore BUFSIZ.
+ *
+ * @return Previous default buffer size.
+ */
+size_t stdio_bufsize_set(stdio_stream_kind_t kind, size_t size)
+{
+	size_t old;
+
+	assert(kind < STDIO_STREAM_LIMIT);
+
+	old = stream_bufsize[kind];
+	stream_bufsize[kind] = (size != 0) ? size : BUFSIZ;
+	return old;
+}
+
 static void _setvbuf(FILE *stream)
 {
 	/* FIXME: Use more complex rules for setting buffering options. */
 
 	switch (stream->fd) {
 	case 1:
-		setvbuf(stream, NULL, _IOLBF, BUFSIZ);
+		setvbuf(stream, NULL, _IOLBF,
+		    stream_bufsize[STDIO_STREAM_TERM]);
 		break;
 	case 0:
 	case 2:
 		setvbuf(stream, NULL, _IONBF, 0);
 		break;
 	default:
-		setvbuf(stream, NULL, _IOFBF, BUFSIZ);
+		setvbuf(stream, NULL, _IOFBF,
+		    stream_bufsize[STDIO_STREAM_FILE]);
 	}
 }
 
@@ -609,7 +638,7 @@ size_t fread(void *dest, size_t size, size_t nmemb, FILE *stream)
 
 	/* If not buffered stream, read in directly. */
 	if (stream->btype == _IONBF) {
-		total_read += _fread(dest, 1, bytes_left, stream);
+		total_read += _fread(dp, 1, bytes_left, stream);
 		return total_read / size;
 	}
 
@@ -624,6 +653,16 @@ size_t fread(void *dest, size_t size, size_t nmemb, FILE *stream)
 	}
 
 	while ((!stream->error) && (!stream->eof) && (bytes_left > 0)) {
+		/*
+		 * Once the buffer is drained, read requests that would not
+		 * fit in it go straight to the destination.
+		 */
+		if (stream->buf_head == stream->buf_tail &&
+		    bytes_left >= stream->buf_size) {
+			total_read += _fread(dp, 1, bytes_left, stream);
+			break;
+		}
+
 		if (stream->buf_head == stream->buf_tail)
 			_ffillbuf(stream);
 
@@ -697,6 +736,25 @@ size_t fwrite(const void *buf, size_t size, size_t nmemb, FILE *stream)
 	need_flush = false;
 
 	while ((!stream->error) && (bytes_left > 0)) {
+		/*
+		 * Write requests that would not fit in an empty buffer
+		 * bypass it. Anything already buffered goes out first
+		 * to keep the data in order.
+		 */
+		if (bytes_left >= stream->buf_size) {
+			_fflushbuf(stream);
+			if (stream->error)
+				break;
+
+			now = _fwrite(data, 1, bytes_left, stream);
+			if ((stream->btype == _IOLBF) &&
+			    (memchr(data, '\n', now) != NULL))
+				need_flush = true;
+
+			total_written += now;
+			break;
+		}
+
 		buf_free = stream->buf_size - (stream->buf_head - stream->buf);
 		if (bytes_left > buf_free)
 			now = buf_free;
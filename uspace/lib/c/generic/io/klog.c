@@ -37,6 +37,9 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <abi/bootmark.h>
 #include <abi/klog.h>
 #include <io/klog.h>
 #include <abi/log.h>
@@ -53,5 +56,27 @@ errno_t klog_read(void *data, size_t size, size_t *nread)
 	    size, 0, (sysarg_t) nread);
 }
 
+/** Record a boot milestone.
+ *
+ * The kernel time-stamps the milestone, announces it in the kernel log
+ * and adds it to the boot timeline (see abi/bootmark.h). Names longer
+ * than BOOTMARK_NAME_SIZE - 1 bytes are truncated.
+ *
+ * @param fmt Format of the milestone name
+ * @return EOK on success or an error code
+ */
+errno_t klog_bootmark(const char *fmt, ...)
+{
+	char name[BOOTMARK_NAME_SIZE];
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(name, sizeof(name), fmt, args);
+	va_end(args);
+
+	return (errno_t) __SYSCALL4(SYS_KLOG, KLOG_BOOTMARK, (sysarg_t) name,
+	    str_size(name), 0);
+}
+
 /** @}
  */
@@ -31,15 +31,19 @@
  * @{
  */
 
+#include <align.h>
 #include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <as.h>
 #include <async.h>
 #include <io/log.h>
 #include <ipc/logger.h>
+#include <mem.h>
+#include <stdatomic.h>
 #include <str.h>
 #include <ns.h>
 
@@ -63,9 +67,141 @@ static const char *log_level_names[] = {
 /** IPC session with the logger service. */
 static async_sess_t *logger_session;
 
+/** Message ring shared with the logger, NULL if not available. */
+static logger_ring_t *logger_ring;
+
+/** Serializes producers of the message ring. */
+static FIBRIL_MUTEX_INITIALIZE(logger_ring_guard);
+
 /** Maximum length of a single log message (in bytes). */
 #define MESSAGE_BUFFER_SIZE 4096
 
+/** Share a message ring with the logger.
+ *
+ * Messages are then queued to the ring without waiting for the logger.
+ * If this fails, messages are sent synchronously over IPC.
+ *
+ * @param session Initialized IPC session with the logger.
+ */
+static void logger_ring_setup(async_sess_t *session)
+{
+	logger_ring_t *ring = as_area_create(AS_AREA_ANY, sizeof(logger_ring_t),
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (ring == AS_MAP_FAILED)
+		return;
+
+	memset(ring, 0, sizeof(logger_ring_t));
+
+	async_exch_t *exchange = async_exchange_begin(session);
+	if (exchange == NULL) {
+		as_area_destroy(ring);
+		return;
+	}
+
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_RING_SHARE, NULL);
+	errno_t rc = async_share_out_start(exchange, ring,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE);
+	async_exchange_end(exchange);
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	if ((rc != EOK) || (retval != EOK)) {
+		as_area_destroy(ring);
+		return;
+	}
+
+	logger_ring = ring;
+}
+
+/** Determine whether the logger would discard a message.
+ *
+ * @param ring Message ring shared with the logger.
+ * @param log Log to use.
+ * @param level Verbosity level of the message.
+ * @return @c true if the level published for @a log is less verbose
+ *         than @a level, @c false if it is or the log is not known yet.
+ */
+static bool logger_ring_filtered(logger_ring_t *ring, sysarg_t log,
+    log_level_t level)
+{
+	for (size_t i = 0; i < LOGGER_RING_LOGS; i++) {
+		sysarg_t id = atomic_load_explicit(&ring->logs[i].log,
+		    memory_order_acquire);
+		if (id == 0)
+			break;
+
+		if (id == log) {
+			return level > atomic_load_explicit(&ring->logs[i].level,
+			    memory_order_relaxed);
+		}
+	}
+
+	return false;
+}
+
+/** Queue a message to the ring shared with the logger.
+ *
+ * Never waits for the logger. If the ring is full, the message is
+ * dropped and counted so that the logger can report it.
+ *
+ * @param ring Message ring shared with the logger.
+ * @param session Initialized IPC session with the logger.
+ * @param log Log to use.
+ * @param level Verbosity level of the message.
+ * @param message The actual message.
+ */
+static void logger_ring_message(logger_ring_t *ring, async_sess_t *session,
+    sysarg_t log, log_level_t level, const char *message)
+{
+	size_t length = str_size(message);
+	size_t size = ALIGN_UP(sizeof(logger_ring_msg_t) + length + 1,
+	    sizeof(sysarg_t));
+
+	fibril_mutex_lock(&logger_ring_guard);
+
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t pos = tail % LOGGER_RING_SIZE;
+	size_t contig = LOGGER_RING_SIZE - pos;
+
+	/* Records never wrap, skip the end of the buffer if needed. */
+	size_t skip = (contig < size) ? contig : 0;
+
+	if (LOGGER_RING_SIZE - (tail - head) < skip + size) {
+		atomic_fetch_add(&ring->dropped, 1);
+		fibril_mutex_unlock(&logger_ring_guard);
+		return;
+	}
+
+	if (skip >= sizeof(logger_ring_msg_t)) {
+		logger_ring_msg_t *pad = (logger_ring_msg_t *) &ring->buffer[pos];
+		pad->log = 0;
+		pad->size = skip;
+	}
+
+	tail += skip;
+	logger_ring_msg_t *msg = (logger_ring_msg_t *)
+	    &ring->buffer[tail % LOGGER_RING_SIZE];
+	msg->log = log;
+	msg->level = level;
+	msg->size = size;
+	memcpy(msg + 1, message, length + 1);
+
+	atomic_store(&ring->tail, tail + size);
+
+	fibril_mutex_unlock(&logger_ring_guard);
+
+	/* Wake up the logger only if it is waiting for us. */
+	if (atomic_exchange(&ring->sleeping, false)) {
+		async_exch_t *exchange = async_exchange_begin(session);
+		if (exchange != NULL) {
+			async_msg_0(exchange, LOGGER_WRITER_RING_KICK);
+			async_exchange_end(exchange);
+		}
+	}
+}
+
 /** Send formatted message to the logger service.
  *
  * @param session Initialized IPC session with the logger.
@@ -173,6 +309,7 @@ errno_t log_init(const char *prog_name)
 		return rc;
 
 	default_log_id = log_create(prog_name, LOG_NO_PARENT);
+	logger_ring_setup(logger_session);
 
 	return EOK;
 }
@@ -239,12 +376,28 @@ void log_msgv(log_t ctx, log_level_t level, const char *fmt, va_list args)
 {
 	assert(level < LVL_LIMIT);
 
+	logger_ring_t *ring = logger_ring;
+	sysarg_t log = (ctx == LOG_DEFAULT) ? default_log_id : ctx;
+
+	/* Do not bother formatting messages the logger would discard. */
+	if (ring != NULL && logger_ring_filtered(ring, log, level))
+		return;
+
 	char *message_buffer = malloc(MESSAGE_BUFFER_SIZE);
 	if (message_buffer == NULL)
 		return;
 
 	vsnprintf(message_buffer, MESSAGE_BUFFER_SIZE, fmt, args);
-	logger_message(logger_session, ctx, level, message_buffer);
+
+	if (ring != NULL) {
+		// FIXME: remove when all USB drivers use libc logging explicitly
+		str_rtrim(message_buffer, '\n');
+		logger_ring_message(ring, logger_session, log, level,
+		    message_buffer);
+	} else {
+		logger_message(logger_session, ctx, level, message_buffer);
+	}
+
 	free(message_buffer);
 }
 
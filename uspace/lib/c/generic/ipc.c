@@ -109,6 +109,28 @@ errno_t ipc_call_async_slow(cap_phone_handle_t phandle, sysarg_t imethod,
 	    (sysarg_t) label);
 }
 
+/** Make a batch of asynchronous calls in one syscall.
+ *
+ * Each entry of @a calls describes one call: its payload arguments, the phone
+ * to send it over in the cap_handle member and the label in the answer_label
+ * member. The calls are made in the order of the array and the batch stops at
+ * the first call that cannot be made.
+ *
+ * @param calls     Array of call descriptions.
+ * @param count     Number of entries in @a calls, at most IPC_MAX_BATCH.
+ * @param submitted Place to store the number of calls actually made.
+ *
+ * @return EOK if all calls were made.
+ * @return Error code of the first call that could not be made.
+ *
+ */
+errno_t ipc_call_async_batch(const ipc_call_t *calls, size_t count,
+    size_t *submitted)
+{
+	return (errno_t) __SYSCALL3(SYS_IPC_CALL_ASYNC_BATCH,
+	    (sysarg_t) calls, (sysarg_t) count, (sysarg_t) submitted);
+}
+
 /** Answer received call (fast version).
  *
  * The fast answer makes use of passing retval and first four arguments in
@@ -176,6 +198,29 @@ errno_t ipc_wait(ipc_call_t *call, sysarg_t usec, unsigned int flags)
 	return __SYSCALL3(SYS_IPC_WAIT, (sysarg_t) call, usec, flags);
 }
 
+/** Wait for several calls or answers at once.
+ *
+ * Blocks until the first call arrives as ipc_wait() does and then fills the
+ * rest of the array with calls that are already pending, without blocking.
+ *
+ * @param calls    Array to store the received calls in.
+ * @param count    Number of entries in @a calls, at most IPC_MAX_BATCH.
+ * @param usec     Timeout for the first call.
+ * @param flags    Flags for the first call.
+ * @param received Place to store the number of received calls.
+ *
+ * @return EOK if at least one call was received, error code of the wait for
+ *         the first call otherwise.
+ *
+ */
+errno_t ipc_wait_multi(ipc_call_t *calls, size_t count, sysarg_t usec,
+    unsigned int flags, size_t *received)
+{
+	// TODO: Use expiration time instead of timeout.
+	return (errno_t) __SYSCALL5(SYS_IPC_WAIT_MULTI, (sysarg_t) calls,
+	    (sysarg_t) count, usec, flags, (sysarg_t) received);
+}
+
 /** Hang up a phone.
  *
  * @param phandle  Handle of the phone to be hung up.
@@ -111,6 +111,52 @@ errno_t ipc_test_ping(ipc_test_t *test)
 	return EOK;
 }
 
+/** Send a batch of pings and wait for all the answers.
+ *
+ * All pings are submitted before waiting for the first answer, which keeps
+ * @a count requests in flight.
+ *
+ * @param test IPC test service
+ * @param count Number of pings, at most IPC_MAX_BATCH
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_ping_batch(ipc_test_t *test, size_t count)
+{
+	ipc_call_t calls[IPC_MAX_BATCH];
+	aid_t reqs[IPC_MAX_BATCH];
+	async_exch_t *exch;
+	errno_t retval;
+	errno_t rc;
+	size_t i;
+
+	if (count > IPC_MAX_BATCH)
+		return EINVAL;
+
+	for (i = 0; i < count; i++) {
+		ipc_set_imethod(&calls[i], IPC_TEST_PING);
+		ipc_set_arg1(&calls[i], 0);
+		ipc_set_arg2(&calls[i], 0);
+		ipc_set_arg3(&calls[i], 0);
+		ipc_set_arg4(&calls[i], 0);
+		ipc_set_arg5(&calls[i], 0);
+	}
+
+	exch = async_exchange_begin(test->sess);
+	rc = async_send_batch(exch, calls, count, reqs);
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	for (i = 0; i < count; i++) {
+		async_wait_for(reqs[i], &retval);
+		if (retval != EOK)
+			rc = retval;
+	}
+
+	return rc;
+}
+
 /** Get size of shared read-only memory area.
  *
  * @param test IPC test service
@@ -220,5 +266,34 @@ errno_t ipc_test_share_in_rw(ipc_test_t *test, size_t size, void **rptr)
 	return EOK;
 }
 
+/** Write data to the test service, which discards it.
+ *
+ * @param test IPC test service
+ * @param data Data to write
+ * @param size Size of @a data, at most DATA_XFER_LIMIT
+ * @return EOK on success or an error code
+ */
+errno_t ipc_test_write(ipc_test_t *test, const void *data, size_t size)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	aid_t req;
+	errno_t retval;
+	errno_t rc;
+
+	exch = async_exchange_begin(test->sess);
+	req = async_send_0(exch, IPC_TEST_WRITE, &answer);
+	rc = async_data_write_start(exch, data, size);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
 /** @}
  */
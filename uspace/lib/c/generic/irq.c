@@ -33,6 +33,7 @@
  */
 
 #include <ipc/irq.h>
+#include <affinity.h>
 #include <libc.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -85,5 +86,95 @@ errno_t ipc_irq_unsubscribe(cap_irq_handle_t cap)
 	    cap_handle_raw(cap));
 }
 
+/** Allocate a block of message signalled interrupts.
+ *
+ * @param count Number of interrupts.
+ * @param msi   Place to store the first INR and the message which raises
+ *              the first interrupt of the block.
+ *
+ * @return Error code returned by the kernel.
+ *
+ */
+errno_t irq_msi_alloc(size_t count, irq_msi_t *msi)
+{
+	return (errno_t) __SYSCALL2(SYS_IRQ_MSI_ALLOC, count, (sysarg_t) msi);
+}
+
+/** Free a block of message signalled interrupts.
+ *
+ * @param inr   First INR of the block.
+ * @param count Number of interrupts.
+ *
+ * @return Error code returned by the kernel.
+ *
+ */
+errno_t irq_msi_free(int inr, size_t count)
+{
+	return (errno_t) __SYSCALL2(SYS_IRQ_MSI_FREE, inr, count);
+}
+
+/** Route an interrupt to a CPU.
+ *
+ * By default the kernel spreads device interrupts over the CPUs as they
+ * get subscribed. Interrupts which cannot be moved, such as message
+ * signalled ones, keep the CPU chosen when they were allocated.
+ *
+ * @param inr IRQ number.
+ * @param cpu ID of the CPU.
+ *
+ * @return EOK on success, ENOTSUP if the interrupt cannot be moved,
+ *         EINVAL if @a inr or @a cpu is out of range.
+ *
+ */
+errno_t irq_affinity_set(int inr, unsigned int cpu)
+{
+	return (errno_t) __SYSCALL2(SYS_IRQ_AFFINITY_SET, inr, cpu);
+}
+
+/** Get the CPU an interrupt is routed to.
+ *
+ * @param inr IRQ number.
+ * @param cpu Place to store the ID of the CPU.
+ *
+ * @return EOK on success, ENOENT if the interrupt is not routed to
+ *         a particular CPU.
+ *
+ */
+errno_t irq_affinity_get(int inr, unsigned int *cpu)
+{
+	sysarg_t val;
+	errno_t rc = (errno_t) __SYSCALL2(SYS_IRQ_AFFINITY_GET, inr,
+	    (sysarg_t) &val);
+	if (rc == EOK)
+		*cpu = val;
+
+	return rc;
+}
+
+/** Wire the current thread to the CPU an interrupt is routed to.
+ *
+ * Meant for a thread which does nothing but service the interrupt, so
+ * that the notification is handled where the interrupt arrived and the
+ * caches are still warm.
+ *
+ * @param inr IRQ number.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t irq_affinity_wire(int inr)
+{
+	unsigned int cpu;
+	errno_t rc = irq_affinity_get(inr, &cpu);
+	if (rc != EOK)
+		return rc;
+
+	cpu_set_t set;
+	cpu_set_zero(&set);
+	cpu_set_add(&set, cpu);
+
+	return thread_set_affinity(&set);
+}
+
 /** @}
  */
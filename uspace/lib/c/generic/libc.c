@@ -62,6 +62,8 @@ static fibril_t main_fibril;
 
 void __libc_main(void *pcb_ptr)
 {
+	__mem_init();
+
 	__kio_init();
 
 	assert(!__tcb_is_set());
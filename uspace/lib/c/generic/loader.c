@@ -41,6 +41,7 @@
 #include <stdlib.h>
 #include <async.h>
 #include <errno.h>
+#include <macros.h>
 #include <vfs/vfs.h>
 #include <loader/loader.h>
 #include "private/loader.h"
@@ -305,6 +306,113 @@ errno_t loader_add_inbox(loader_t *ldr, const char *name, int file)
 	return (errno_t) rc;
 }
 
+/** Send all parameters of a program to the loader and load it.
+ *
+ * This is equivalent to setting the current working directory, the
+ * program, the arguments and the inbox entries and loading the program,
+ * but it takes a single request and data transfer.
+ *
+ * @param ldr     Loader connection structure.
+ * @param path    Program path.
+ * @param argv    NULL-terminated array of pointers to arguments.
+ * @param inboxes Number of inbox entries.
+ * @param names   Identifications of the inbox entries.
+ * @param files   File descriptors of the inbox entries.
+ * @param task_id Place to store the ID of the new task.
+ *
+ * @return Zero on success or an error code.
+ *
+ */
+errno_t loader_prepare(loader_t *ldr, const char *path,
+    const char *const argv[], size_t inboxes, const char *const names[],
+    const int files[], task_id_t *task_id)
+{
+	char *cwd = (char *) malloc(MAX_PATH_LEN + 1);
+	if (cwd == NULL)
+		return ENOMEM;
+
+	if (vfs_cwd_get(cwd, MAX_PATH_LEN + 1) != EOK)
+		str_cpy(cwd, MAX_PATH_LEN + 1, "/");
+
+	size_t abslen;
+	char *abspath = vfs_absolutize(path, &abslen);
+	if (abspath == NULL) {
+		free(cwd);
+		return ENOMEM;
+	}
+
+	int fd;
+	errno_t rc = vfs_lookup(path, 0, &fd);
+	if (rc != EOK) {
+		free(abspath);
+		free(cwd);
+		return rc;
+	}
+
+	/* Serialize all strings into a single buffer */
+	size_t buffer_size = str_size(cwd) + 1 + str_size(abspath) + 1;
+	for (size_t i = 0; i < inboxes; i++)
+		buffer_size += str_size(names[i]) + 1;
+	for (const char *const *ap = argv; *ap != NULL; ap++)
+		buffer_size += str_size(*ap) + 1;
+
+	char *buf = malloc(buffer_size);
+	if (buf == NULL) {
+		vfs_put(fd);
+		free(abspath);
+		free(cwd);
+		return ENOMEM;
+	}
+
+	char *dp = buf;
+	str_cpy(dp, buffer_size, cwd);
+	dp += str_size(cwd) + 1;
+	str_cpy(dp, buffer_size - (dp - buf), abspath);
+	dp += str_size(abspath) + 1;
+	for (size_t i = 0; i < inboxes; i++) {
+		str_cpy(dp, buffer_size - (dp - buf), names[i]);
+		dp += str_size(names[i]) + 1;
+	}
+	for (const char *const *ap = argv; *ap != NULL; ap++) {
+		str_cpy(dp, buffer_size - (dp - buf), *ap);
+		dp += str_size(*ap) + 1;
+	}
+
+	async_exch_t *exch = async_exchange_begin(ldr->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, LOADER_SPAWN, inboxes, &answer);
+
+	rc = async_data_write_start(exch, buf, buffer_size);
+	if (rc == EOK) {
+		async_exch_t *vfs_exch = vfs_exchange_begin();
+
+		rc = vfs_pass_handle(vfs_exch, fd, exch);
+		for (size_t i = 0; (rc == EOK) && (i < inboxes); i++)
+			rc = vfs_pass_handle(vfs_exch, files[i], exch);
+
+		vfs_exchange_end(vfs_exch);
+	}
+
+	async_exchange_end(exch);
+	vfs_put(fd);
+	free(abspath);
+	free(cwd);
+	free(buf);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK)
+		return rc;
+
+	*task_id = MERGE_LOUP32(ipc_get_arg1(&answer), ipc_get_arg2(&answer));
+	return EOK;
+}
+
 /** Instruct loader to load the program.
  *
  * If this function succeeds, the program has been successfully loaded
@@ -27,6 +27,8 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <str.h>
 #include <ipc/services.h>
 #include <ns.h>
@@ -55,6 +57,141 @@ static async_sess_t *loc_cons_block_sess = NULL;
 static async_sess_t *loc_supplier_sess = NULL;
 static async_sess_t *loc_consumer_sess = NULL;
 
+/** Cached result of a name lookup */
+typedef struct {
+	ht_link_t link;
+	char *name;
+	sysarg_t id;
+} loc_cache_entry_t;
+
+/*
+ * Client-side cache of service and category name lookups, see
+ * loc_cache_enable(). Service names are forgotten whenever the location
+ * service reports a change. Category IDs never change.
+ */
+static FIBRIL_MUTEX_INITIALIZE(loc_cache_mutex);
+static bool loc_cache_enabled = false;
+static hash_table_t loc_svc_cache;
+static hash_table_t loc_cat_cache;
+/** Incremented by every invalidation of loc_svc_cache */
+static size_t loc_cache_gen = 0;
+
+static size_t loc_cache_key_hash(const void *key)
+{
+	const char *str = key;
+	size_t hash = 0;
+
+	while (*str != '\0')
+		hash = hash_combine(hash, (uint8_t) *str++);
+
+	return hash;
+}
+
+static size_t loc_cache_hash(const ht_link_t *item)
+{
+	loc_cache_entry_t *ent = hash_table_get_inst(item, loc_cache_entry_t,
+	    link);
+	return loc_cache_key_hash(ent->name);
+}
+
+static bool loc_cache_key_equal(const void *key, const ht_link_t *item)
+{
+	loc_cache_entry_t *ent = hash_table_get_inst(item, loc_cache_entry_t,
+	    link);
+	return str_cmp(ent->name, key) == 0;
+}
+
+static void loc_cache_remove_callback(ht_link_t *item)
+{
+	loc_cache_entry_t *ent = hash_table_get_inst(item, loc_cache_entry_t,
+	    link);
+	free(ent->name);
+	free(ent);
+}
+
+static hash_table_ops_t loc_cache_ops = {
+	.hash = loc_cache_hash,
+	.key_hash = loc_cache_key_hash,
+	.key_equal = loc_cache_key_equal,
+	.equal = NULL,
+	.remove_callback = loc_cache_remove_callback
+};
+
+/** Look up a name in a cache.
+ *
+ * @param cache Cache
+ * @param name  Name
+ * @param id    Place to store the cached ID
+ * @param gen   Place to store the cache generation, to be passed to
+ *              loc_cache_insert() after a miss, may be NULL
+ *
+ * @return @c true on a hit
+ */
+static bool loc_cache_lookup(hash_table_t *cache, const char *name,
+    sysarg_t *id, size_t *gen)
+{
+	bool hit = false;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+	if (loc_cache_enabled) {
+		ht_link_t *link = hash_table_find(cache, name);
+		if (link != NULL) {
+			*id = hash_table_get_inst(link, loc_cache_entry_t,
+			    link)->id;
+			hit = true;
+		}
+	}
+	if (gen != NULL)
+		*gen = loc_cache_gen;
+	fibril_mutex_unlock(&loc_cache_mutex);
+
+	return hit;
+}
+
+/** Remember the result of a name lookup.
+ *
+ * Nothing is remembered if the cache has been invalidated since the
+ * lookup started, the result might be stale already.
+ *
+ * @param cache Cache
+ * @param name  Name
+ * @param id    ID the name resolved to
+ * @param gen   Cache generation returned by loc_cache_lookup()
+ */
+static void loc_cache_insert(hash_table_t *cache, const char *name,
+    sysarg_t id, size_t gen)
+{
+	fibril_mutex_lock(&loc_cache_mutex);
+
+	if (!loc_cache_enabled || gen != loc_cache_gen ||
+	    hash_table_find(cache, name) != NULL) {
+		fibril_mutex_unlock(&loc_cache_mutex);
+		return;
+	}
+
+	loc_cache_entry_t *ent = malloc(sizeof(loc_cache_entry_t));
+	if (ent != NULL) {
+		ent->name = str_dup(name);
+		ent->id = id;
+		if (ent->name != NULL)
+			hash_table_insert(cache, &ent->link);
+		else
+			free(ent);
+	}
+
+	fibril_mutex_unlock(&loc_cache_mutex);
+}
+
+/** Forget all cached service names. */
+static void loc_cache_invalidate(void)
+{
+	fibril_mutex_lock(&loc_cache_mutex);
+	if (loc_cache_enabled)
+		hash_table_clear(&loc_svc_cache);
+	loc_cache_gen++;
+	fibril_mutex_unlock(&loc_cache_mutex);
+}
+
 static void loc_cb_conn(ipc_call_t *icall, void *arg)
 {
 	while (true) {
@@ -68,6 +205,9 @@ static void loc_cb_conn(ipc_call_t *icall, void *arg)
 
 		switch (ipc_get_imethod(&call)) {
 		case LOC_EVENT_CAT_CHANGE:
+			/* Services may have come or gone */
+			loc_cache_invalidate();
+
 			fibril_mutex_lock(&loc_callback_mutex);
 			loc_cat_change_cb_t cb_fun = cat_change_cb;
 			void *cb_arg = cat_change_arg;
@@ -327,6 +467,21 @@ errno_t loc_service_get_id(const char *fqdn, service_id_t *handle,
     unsigned int flags)
 {
 	async_exch_t *exch;
+	sysarg_t cached;
+	size_t gen;
+
+	/*
+	 * Null services come and go without notification, so their names
+	 * are never cached.
+	 */
+	bool cacheable = str_lcmp(fqdn, "null/", 5) != 0;
+
+	if (cacheable && loc_cache_lookup(&loc_svc_cache, fqdn, &cached,
+	    &gen)) {
+		if (handle != NULL)
+			*handle = (service_id_t) cached;
+		return EOK;
+	}
 
 	if (flags & IPC_FLAG_BLOCKING)
 		exch = loc_exchange_begin_blocking(INTERFACE_LOC_CONSUMER);
@@ -357,6 +512,11 @@ errno_t loc_service_get_id(const char *fqdn, service_id_t *handle,
 		return retval;
 	}
 
+	if (cacheable) {
+		loc_cache_insert(&loc_svc_cache, fqdn, ipc_get_arg1(&answer),
+		    gen);
+	}
+
 	if (handle != NULL)
 		*handle = (service_id_t) ipc_get_arg1(&answer);
 
@@ -509,6 +669,14 @@ errno_t loc_category_get_id(const char *name, category_id_t *cat_id,
     unsigned int flags)
 {
 	async_exch_t *exch;
+	sysarg_t cached;
+	size_t gen;
+
+	if (loc_cache_lookup(&loc_cat_cache, name, &cached, &gen)) {
+		if (cat_id != NULL)
+			*cat_id = (category_id_t) cached;
+		return EOK;
+	}
 
 	if (flags & IPC_FLAG_BLOCKING)
 		exch = loc_exchange_begin_blocking(INTERFACE_LOC_CONSUMER);
@@ -539,6 +707,8 @@ errno_t loc_category_get_id(const char *name, category_id_t *cat_id,
 		return retval;
 	}
 
+	loc_cache_insert(&loc_cat_cache, name, ipc_get_arg1(&answer), gen);
+
 	if (cat_id != NULL)
 		*cat_id = (category_id_t) ipc_get_arg1(&answer);
 
@@ -880,3 +1050,40 @@ errno_t loc_register_cat_change_cb(loc_cat_change_cb_t cb_fun, void *cb_arg)
 
 	return EOK;
 }
+
+/** Cache the results of name lookups.
+ *
+ * Once enabled, loc_service_get_id() and loc_category_get_id() answer
+ * repeated lookups of the same name without asking the location service.
+ * Cached service names are dropped whenever the location service signals
+ * a category change, which it does whenever a service goes away.
+ *
+ * @return EOK on success or an error code
+ */
+errno_t loc_cache_enable(void)
+{
+	fibril_mutex_lock(&loc_callback_mutex);
+	errno_t rc = loc_callback_create();
+	fibril_mutex_unlock(&loc_callback_mutex);
+	if (rc != EOK)
+		return rc;
+
+	fibril_mutex_lock(&loc_cache_mutex);
+	if (!loc_cache_enabled) {
+		if (!hash_table_create(&loc_svc_cache, 0, 0, &loc_cache_ops)) {
+			fibril_mutex_unlock(&loc_cache_mutex);
+			return ENOMEM;
+		}
+
+		if (!hash_table_create(&loc_cat_cache, 0, 0, &loc_cache_ops)) {
+			hash_table_destroy(&loc_svc_cache);
+			fibril_mutex_unlock(&loc_cache_mutex);
+			return ENOMEM;
+		}
+
+		loc_cache_enabled = true;
+	}
+	fibril_mutex_unlock(&loc_cache_mutex);
+
+	return EOK;
+}
@@ -33,10 +33,34 @@
 /** @file
  */
 
+
+/*
+ * The allocator serves requests from three tiers:
+ *
+ *  - Small blocks (up to SMALL_MAX bytes) are rounded up to one of
+ *    CLASS_COUNT size classes. Each class carves fixed-size objects out of
+ *    spans of SMALL_SPAN_PAGES pages. Objects are handed out from a small
+ *    number of shared caches first, which are refilled from and flushed to
+ *    the central per-class lists in batches.
+ *
+ *  - Medium blocks (up to MEDIUM_MAX bytes) are whole page runs.
+ *
+ *  - Large blocks get an address space area of their own.
+ *
+ * An optional heap profiler samples allocations and attributes them to
+ * the call sites they come from, see heap_profile_start().
+ *
+ * Spans and page runs live in arenas, address space areas of ARENA_SIZE
+ * bytes which start with a descriptor for each of their pages. Arenas are
+ * never destroyed, so a block can be classified by a lock-free range check.
+ */
+
 #include <malloc.h>
 #include <stdalign.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <as.h>
 #include <align.h>
 #include <macros.h>
@@ -45,731 +69,1164 @@
 #include <bitops.h>
 #include <mem.h>
 #include <stdlib.h>
-#include <adt/gcdlcm.h>
+#include <stdio.h>
+#include <stacktrace.h>
+#include <heap_profile.h>
+#include <adt/list.h>
 
 #include "private/malloc.h"
 #include "private/fibril.h"
 
-/** Magic used in heap headers. */
-#define HEAP_BLOCK_HEAD_MAGIC  UINT32_C(0xBEEF0101)
+/** Magic used in arena headers */
+#define ARENA_MAGIC  UINT32_C(0xBEEFCAFE)
 
-/** Magic used in heap footers. */
-#define HEAP_BLOCK_FOOT_MAGIC  UINT32_C(0xBEEF0202)
+/** Magic used in span descriptors */
+#define SPAN_MAGIC  UINT32_C(0xBEEF0101)
 
-/** Magic used in heap descriptor. */
-#define HEAP_AREA_MAGIC  UINT32_C(0xBEEFCAFE)
+/** Magic used in large block headers */
+#define LARGE_MAGIC  UINT32_C(0xBEEF0202)
 
 /** Allocation alignment.
  *
- * This also covers the alignment of fields
- * in the heap header and footer.
+ * This also covers the alignment of the large block header.
  *
  */
 #define BASE_ALIGN  16
 
-/** Heap shrink granularity
- *
- * Try not to pump and stress the heap too much
- * by shrinking and enlarging it too often.
- * A heap area won't shrink if the released
- * free block is smaller than this constant.
- *
- */
-#define SHRINK_GRANULARITY  (64 * PAGE_SIZE)
+/** Size of an arena */
+#define ARENA_SIZE  (4 * 1024 * 1024)
 
-/** Overhead of each heap block. */
-#define STRUCT_OVERHEAD \
-	(sizeof(heap_block_head_t) + sizeof(heap_block_foot_t))
+/** Number of pages in an arena */
+#define ARENA_PAGES  (ARENA_SIZE / PAGE_SIZE)
 
-/** Calculate real size of a heap block.
+/** Maximum number of arenas */
+#define ARENA_MAX  256
+
+/** Number of pages holding the arena header */
+#define ARENA_META_PAGES \
+	(ALIGN_UP(sizeof(arena_t), PAGE_SIZE) / PAGE_SIZE)
+
+/** Largest block served from a size class */
+#define SMALL_MAX  2048
+
+/** Number of pages in a span of small objects */
+#define SMALL_SPAN_PAGES  4
+
+/** Size of a span of small objects */
+#define SMALL_SPAN_SIZE  (SMALL_SPAN_PAGES * PAGE_SIZE)
+
+/** Largest block served as a page run from an arena */
+#define MEDIUM_MAX  (256 * 1024)
+
+/** Number of free run lists
  *
- * Add header and footer size.
+ * Run list i holds free runs of i + 1 pages, the last one holds all
+ * longer runs.
  *
  */
-#define GROSS_SIZE(size)  ((size) + STRUCT_OVERHEAD)
+#define RUN_BUCKETS  64
+
+/** Number of small object caches */
+#define CACHE_COUNT  8
+
+/** Number of bytes a cache may hold per size class */
+#define CACHE_CLASS_BYTES  8192
+
+/** Number of size classes */
+#define CLASS_COUNT  24
+
+/** Size of the large block header including padding */
+#define LARGE_HEAD_SIZE  ALIGN_UP(sizeof(large_head_t), BASE_ALIGN)
+
+/** Number of sampled blocks the heap profiler can track */
+#define HEAP_PROFILE_LIVE  4096
+
+/** Return addresses within malloc.c skipped in profiler backtraces */
+#define HEAP_PROFILE_SKIP  2
 
-/** Calculate net size of a heap block.
+/** Object sizes of the size classes */
+static const uint16_t class_sizes[CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024, 1280, 1536, 1792, 2048
+};
+
+typedef enum {
+	SPAN_FREE = 1,
+	SPAN_SMALL,
+	SPAN_MEDIUM
+} span_state_t;
+
+struct arena;
+
+/** Page descriptor
  *
- * Subtract header and footer size.
+ * Every page of an arena has a descriptor. A run of pages is described by
+ * the descriptor of its first page (the head). The descriptor of the last
+ * page of a run always points to the head, so do all descriptors of small
+ * object spans, which allows finding the span of any object.
  *
  */
-#define NET_SIZE(size)  ((size) - STRUCT_OVERHEAD)
+typedef struct span {
+	/** Link in a free run list or in a class list of partial spans */
+	link_t link;
 
-/** Overhead of each area. */
-#define AREA_OVERHEAD(size) \
-	(ALIGN_UP(GROSS_SIZE(size) + sizeof(heap_area_t), BASE_ALIGN))
+	/** Head of the run this page belongs to */
+	struct span *head;
 
-/** Get first block in heap area.
- *
- */
-#define AREA_FIRST_BLOCK_HEAD(area) \
-	(ALIGN_UP(((uintptr_t) (area)) + sizeof(heap_area_t), BASE_ALIGN))
+	/** Arena this page belongs to */
+	struct arena *arena;
 
-/** Get last block in heap area.
- *
- */
-#define AREA_LAST_BLOCK_FOOT(area) \
-	(((uintptr_t) (area)->end) - sizeof(heap_block_foot_t))
+	/** First byte of the run */
+	void *base;
 
-#define AREA_LAST_BLOCK_HEAD(area) \
-	((uintptr_t) BLOCK_HEAD(((heap_block_foot_t *) AREA_LAST_BLOCK_FOOT(area))))
+	/** Free objects of a small object span */
+	void *free_list;
 
-/** Get header in heap block.
- *
- */
-#define BLOCK_HEAD(foot) \
-	((heap_block_head_t *) \
-	    (((uintptr_t) (foot)) + sizeof(heap_block_foot_t) - (foot)->size))
+	/** Number of pages in the run */
+	size_t pages;
 
-/** Get footer in heap block.
- *
- */
-#define BLOCK_FOOT(head) \
-	((heap_block_foot_t *) \
-	    (((uintptr_t) (head)) + (head)->size - sizeof(heap_block_foot_t)))
+	/** A magic value */
+	uint32_t magic;
+
+	/** Number of objects allocated from a small object span */
+	uint16_t used;
+
+	/** Number of objects ever carved from a small object span */
+	uint16_t carved;
+
+	/** One of span_state_t */
+	uint8_t state;
+
+	/** Size class of a small object span */
+	uint8_t cls;
+
+	/** Span is on the class list of partial spans */
+	bool partial;
+} span_t;
 
-/** Heap area.
+/** Arena header
  *
- * The memory managed by the heap allocator is divided into
- * multiple discontinuous heaps. Each heap is represented
- * by a separate address space area which has this structure
- * at its very beginning.
+ * Stored at the beginning of each arena, followed by the data pages.
  *
  */
-typedef struct heap_area {
-	/** Start of the heap area (including this structure)
-	 *
-	 * Aligned on page boundary.
-	 *
-	 */
+typedef struct arena {
+	/** A magic value */
+	uint32_t magic;
+
+	/** Start of the arena (including this structure) */
 	void *start;
 
-	/** End of the heap area (aligned on page boundary) */
+	/** End of the arena */
 	void *end;
 
-	/** Previous heap area */
-	struct heap_area *prev;
+	/** Descriptors of all the pages of the arena */
+	span_t pages[ARENA_PAGES];
+} arena_t;
 
-	/** Next heap area */
-	struct heap_area *next;
+/** Free small object */
+typedef struct free_obj {
+	struct free_obj *next;
+} free_obj_t;
 
-	/** A magic value */
-	uint32_t magic;
-} heap_area_t;
+/** Size class */
+typedef struct {
+	/** Protects the spans of this class */
+	fibril_rmutex_t mutex;
+
+	/** Spans with free objects */
+	list_t partial;
+} size_class_t;
+
+/** Cached objects of one size class */
+typedef struct {
+	free_obj_t *head;
+	size_t count;
+} cache_bin_t;
 
-/** Header of a heap block
+/** Small object cache
+ *
+ * Ideally, each runner thread would own a cache. Fibrils migrate between
+ * threads and thread-local storage belongs to fibrils, though, so the
+ * caches are shared and each fibril sticks to the first cache it manages
+ * to grab without waiting.
  *
  */
 typedef struct {
-	/* Size of the block (including header and footer) */
-	size_t size;
+	atomic_flag busy;
+	cache_bin_t bins[CLASS_COUNT];
+} cache_t;
+
+/** Header of a large block */
+typedef struct {
+	/** Link in the list of large blocks */
+	link_t link;
 
-	/* Indication of a free block */
-	bool free;
+	/** Start of the address space area */
+	void *start;
 
-	/** Heap area this block belongs to */
-	heap_area_t *area;
+	/** Size of the address space area */
+	size_t area_size;
 
-	/* A magic value to detect overwrite of heap header */
+	/** A magic value */
 	uint32_t magic;
-} heap_block_head_t;
+} large_head_t;
+
+/** Arenas, append-only */
+static arena_t *arenas[ARENA_MAX];
+
+/** Number of published arenas */
+static atomic_size_t arena_count;
+
+/** Protects the free run lists and arena creation */
+static fibril_rmutex_t pages_mutex;
+
+/** Free page runs */
+static list_t free_runs[RUN_BUCKETS];
+
+/** Size classes */
+static size_class_t classes[CLASS_COUNT];
+
+/** Small object caches */
+static cache_t caches[CACHE_COUNT];
+
+/** Next cache to assign to a fibril */
+static atomic_uint cache_next;
+
+/** Cache the current fibril uses (-1 if not assigned yet) */
+static __thread int cache_hint = -1;
+
+/** Protects the list of large blocks */
+static fibril_rmutex_t large_mutex;
+
+/** Large blocks */
+static list_t large_blocks;
+
+/** Bytes of page runs and large blocks in use */
+static atomic_size_t heap_in_use_bytes;
+
+/** Maximum of heap_in_use_bytes seen so far */
+static atomic_size_t heap_peak_bytes;
+
+/** Sampled block tracked by the heap profiler */
+typedef struct {
+	/** Address of the block (NULL if the slot is unused) */
+	void *addr;
+
+	/** Bytes the sample stands for */
+	size_t weight;
 
-/** Footer of a heap block
+	/** Index of the call site in heap_profile_sites */
+	size_t site;
+} heap_profile_live_t;
+
+/** Sampling interval of the heap profiler in bytes (zero if disabled)
+ *
+ * It is word-sized so that a debugger can switch the profiler on and off
+ * by writing it (see taskdump).
  *
  */
-typedef struct {
-	/* Size of the block (including header and footer) */
-	size_t size;
+static atomic_size_t heap_profile_interval;
 
-	/* A magic value to detect overwrite of heap footer */
-	uint32_t magic;
-} heap_block_foot_t;
+/** Bytes to allocate until the next sample */
+static atomic_size_t heap_profile_countdown;
+
+/** Number of blocks in heap_profile_live */
+static atomic_size_t heap_profile_tracked;
 
-/** First heap area */
-static heap_area_t *first_heap_area = NULL;
+/** Number of samples lost because a table was full */
+static size_t heap_profile_dropped;
 
-/** Last heap area */
-static heap_area_t *last_heap_area = NULL;
+/** Protects the heap profiler tables */
+static fibril_rmutex_t heap_profile_mutex;
 
-/** Next heap block to examine (next fit algorithm) */
-static heap_block_head_t *next_fit = NULL;
+/** Call sites, open addressing on the backtrace */
+static heap_profile_site_t heap_profile_sites[HEAP_PROFILE_SITES];
 
-/** Futex for thread-safe heap manipulation */
-static fibril_rmutex_t malloc_mutex;
+/** Sampled blocks, open addressing on the address */
+static heap_profile_live_t heap_profile_live[HEAP_PROFILE_LIVE];
 
 #define malloc_assert(expr) safe_assert(expr)
 
 /*
  * Make sure the base alignment is sufficient.
  */
-static_assert(BASE_ALIGN >= alignof(heap_area_t), "");
-static_assert(BASE_ALIGN >= alignof(heap_block_head_t), "");
-static_assert(BASE_ALIGN >= alignof(heap_block_foot_t), "");
+static_assert(BASE_ALIGN >= alignof(large_head_t), "");
 static_assert(BASE_ALIGN >= alignof(max_align_t), "");
+static_assert(ARENA_META_PAGES + MEDIUM_MAX / PAGE_SIZE <= ARENA_PAGES, "");
 
-/** Serializes access to the heap from multiple threads. */
-static inline void heap_lock(void)
+/** Get the size class serving a block
+ *
+ * @param size  Size of the block (non-zero, at most SMALL_MAX).
+ * @param align Alignment of the block.
+ *
+ * @return Size class index or CLASS_COUNT if no class is suitable.
+ *
+ */
+static unsigned size_class(size_t size, size_t align)
 {
-	fibril_rmutex_lock(&malloc_mutex);
+	unsigned cls;
+
+	if (size <= 128) {
+		cls = (size - 1) >> 4;
+	} else {
+		/* Four classes for each power of two. */
+		unsigned log = fnzb(size - 1);
+		cls = 8 + (log - 7) * 4 + ((size - 1) >> (log - 2)) - 4;
+	}
+
+	/* Objects are naturally aligned to divisors of the class size. */
+	while ((cls < CLASS_COUNT) && (class_sizes[cls] % align != 0))
+		cls++;
+
+	return cls;
 }
 
-/** Serializes access to the heap from multiple threads. */
-static inline void heap_unlock(void)
+/** Number of objects a cache may hold for a size class */
+static inline size_t cache_limit(unsigned cls)
 {
-	fibril_rmutex_unlock(&malloc_mutex);
+	return min(max(CACHE_CLASS_BYTES / class_sizes[cls], 4), 64);
 }
 
-/** Initialize a heap block
+/** Find the arena containing an address
  *
- * Fill in the structures related to a heap block.
- * Should be called only inside the critical section.
+ * Does not need any lock since arenas are only ever added.
  *
- * @param addr Address of the block.
- * @param size Size of the block including the header and the footer.
- * @param free Indication of a free block.
- * @param area Heap area the block belongs to.
+ * @param addr Address.
+ *
+ * @return Arena or NULL if the address does not belong to any arena.
  *
  */
-static void block_init(void *addr, size_t size, bool free, heap_area_t *area)
+static arena_t *arena_find(void *addr)
 {
-	/* Calculate the position of the header and the footer */
-	heap_block_head_t *head = (heap_block_head_t *) addr;
-
-	head->size = size;
-	head->free = free;
-	head->area = area;
-	head->magic = HEAP_BLOCK_HEAD_MAGIC;
+	size_t count = atomic_load_explicit(&arena_count, memory_order_acquire);
 
-	heap_block_foot_t *foot = BLOCK_FOOT(head);
+	for (size_t i = 0; i < count; i++) {
+		arena_t *arena = arenas[i];
+		if ((addr >= arena->start) && (addr < arena->end))
+			return arena;
+	}
 
-	foot->size = size;
-	foot->magic = HEAP_BLOCK_FOOT_MAGIC;
+	return NULL;
 }
 
-/** Check a heap block
- *
- * Verifies that the structures related to a heap block still contain
- * the magic constants. This helps detect heap corruption early on.
- * Should be called only inside the critical section.
+/** Account for bytes taken from or returned to the system heap
  *
- * @param addr Address of the block.
+ * @param bytes Number of bytes.
+ * @param taken True if the bytes were taken, false if returned.
  *
  */
-static void block_check(void *addr)
+static void heap_usage_update(size_t bytes, bool taken)
 {
-	heap_block_head_t *head = (heap_block_head_t *) addr;
+	if (!taken) {
+		atomic_fetch_sub_explicit(&heap_in_use_bytes, bytes,
+		    memory_order_relaxed);
+		return;
+	}
 
-	malloc_assert(head->magic == HEAP_BLOCK_HEAD_MAGIC);
+	size_t in_use = atomic_fetch_add_explicit(&heap_in_use_bytes, bytes,
+	    memory_order_relaxed) + bytes;
+	size_t peak = atomic_load_explicit(&heap_peak_bytes,
+	    memory_order_relaxed);
 
-	heap_block_foot_t *foot = BLOCK_FOOT(head);
+	while ((in_use > peak) && (!atomic_compare_exchange_weak_explicit(
+	    &heap_peak_bytes, &peak, in_use, memory_order_relaxed,
+	    memory_order_relaxed)))
+		;
+}
 
-	malloc_assert(foot->magic == HEAP_BLOCK_FOOT_MAGIC);
-	malloc_assert(head->size == foot->size);
+/** Get the run containing an address within an arena */
+static inline span_t *span_find(arena_t *arena, void *addr)
+{
+	size_t idx = (size_t) (addr - arena->start) / PAGE_SIZE;
+	return arena->pages[idx].head;
+}
+
+/** Get the index of a page descriptor */
+static inline size_t span_index(span_t *span)
+{
+	return (size_t) (span - span->arena->pages);
 }
 
-/** Check a heap area structure
+/** Set up the descriptors of a run
+ *
+ * Should be called only with pages_mutex held.
  *
- * Should be called only inside the critical section.
+ * @param arena Arena of the run.
+ * @param idx   Index of the first page of the run.
+ * @param pages Number of pages in the run.
+ * @param state State of the run.
  *
- * @param addr Address of the heap area.
+ * @return Head of the run.
  *
  */
-static void area_check(void *addr)
+static span_t *run_mark(arena_t *arena, size_t idx, size_t pages,
+    span_state_t state)
 {
-	heap_area_t *area = (heap_area_t *) addr;
+	span_t *head = &arena->pages[idx];
+
+	head->head = head;
+	head->arena = arena;
+	head->base = arena->start + idx * PAGE_SIZE;
+	head->pages = pages;
+	head->magic = SPAN_MAGIC;
+	head->state = state;
+
+	/* Small object spans need every page to point to the head. */
+	size_t first = (state == SPAN_SMALL) ? idx + 1 : idx + pages - 1;
+	for (size_t i = first; i < idx + pages; i++) {
+		span_t *page = &arena->pages[i];
+		page->head = head;
+		page->arena = arena;
+		page->state = state;
+	}
 
-	malloc_assert(area->magic == HEAP_AREA_MAGIC);
-	malloc_assert(addr == area->start);
-	malloc_assert(area->start < area->end);
-	malloc_assert(((uintptr_t) area->start % PAGE_SIZE) == 0);
-	malloc_assert(((uintptr_t) area->end % PAGE_SIZE) == 0);
+	return head;
+}
+
+/** Put a free run on the free run list
+ *
+ * Should be called only with pages_mutex held.
+ *
+ */
+static void run_insert(span_t *head)
+{
+	size_t bucket = min(head->pages, RUN_BUCKETS) - 1;
+	list_prepend(&head->link, &free_runs[bucket]);
 }
 
-/** Create new heap area
+/** Create a new arena
  *
- * Should be called only inside the critical section.
+ * Should be called only with pages_mutex held.
  *
- * @param size Size of the area.
+ * @return True if successful.
  *
  */
-static bool area_create(size_t size)
+static bool arena_create(void)
 {
-	/* Align the heap area size on page boundary */
-	size_t asize = ALIGN_UP(size, PAGE_SIZE);
-	void *astart = as_area_create(AS_AREA_ANY, asize,
-	    AS_AREA_WRITE | AS_AREA_READ | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
-	if (astart == AS_MAP_FAILED)
+	size_t count = atomic_load_explicit(&arena_count, memory_order_relaxed);
+	if (count == ARENA_MAX)
 		return false;
 
-	heap_area_t *area = (heap_area_t *) astart;
+	void *astart = as_area_create(AS_AREA_ANY, ARENA_SIZE,
+	    AS_AREA_WRITE | AS_AREA_READ | AS_AREA_CACHEABLE |
+	    AS_AREA_LATE_RESERVE, AS_AREA_UNPAGED);
+	if (astart == AS_MAP_FAILED)
+		return false;
 
-	area->start = astart;
-	area->end = (void *) ((uintptr_t) astart + asize);
-	area->prev = NULL;
-	area->next = NULL;
-	area->magic = HEAP_AREA_MAGIC;
+	arena_t *arena = (arena_t *) astart;
 
-	void *block = (void *) AREA_FIRST_BLOCK_HEAD(area);
-	size_t bsize = (size_t) (area->end - block);
+	arena->magic = ARENA_MAGIC;
+	arena->start = astart;
+	arena->end = astart + ARENA_SIZE;
 
-	block_init(block, bsize, true, area);
+	run_insert(run_mark(arena, ARENA_META_PAGES,
+	    ARENA_PAGES - ARENA_META_PAGES, SPAN_FREE));
 
-	if (last_heap_area == NULL) {
-		first_heap_area = area;
-		last_heap_area = area;
-	} else {
-		area->prev = last_heap_area;
-		last_heap_area->next = area;
-		last_heap_area = area;
-	}
+	arenas[count] = arena;
+	atomic_store_explicit(&arena_count, count + 1, memory_order_release);
 
 	return true;
 }
 
-/** Try to enlarge a heap area
+/** Allocate a page run
  *
- * Should be called only inside the critical section.
+ * Should be called only with pages_mutex held.
  *
- * @param area Heap area to grow.
- * @param size Gross size to grow (bytes).
+ * @param pages Number of pages.
+ * @param state State of the new run.
  *
- * @return True if successful.
+ * @return Head of the run or NULL if out of memory.
  *
  */
-static bool area_grow(heap_area_t *area, size_t size)
+static span_t *run_alloc(size_t pages, span_state_t state)
 {
-	if (size == 0)
-		return true;
+	while (true) {
+		for (size_t bucket = min(pages, RUN_BUCKETS) - 1;
+		    bucket < RUN_BUCKETS; bucket++) {
+			list_foreach(free_runs[bucket], link, span_t, run) {
+				if (run->pages < pages)
+					continue;
+
+				list_remove(&run->link);
+
+				arena_t *arena = run->arena;
+				size_t idx = span_index(run);
+				size_t rest = run->pages - pages;
+
+				if (rest > 0) {
+					run_insert(run_mark(arena, idx + pages,
+					    rest, SPAN_FREE));
+				}
+
+				heap_usage_update(pages * PAGE_SIZE, true);
+				return run_mark(arena, idx, pages, state);
+			}
+		}
 
-	area_check(area);
+		if (!arena_create())
+			return NULL;
+	}
+}
 
-	/* New heap area size */
-	size_t gross_size = (size_t) (area->end - area->start) + size;
-	size_t asize = ALIGN_UP(gross_size, PAGE_SIZE);
-	void *end = (void *) ((uintptr_t) area->start + asize);
+/** Return a page run and merge it with its free neighbours
+ *
+ * Should be called only with pages_mutex held.
+ *
+ * @param run Head of the run.
+ *
+ */
+static void run_free(span_t *run)
+{
+	arena_t *arena = run->arena;
+	size_t idx = span_index(run);
+	size_t pages = run->pages;
+
+	heap_usage_update(pages * PAGE_SIZE, false);
+
+	if (idx > ARENA_META_PAGES) {
+		span_t *prev = arena->pages[idx - 1].head;
+		if (prev->state == SPAN_FREE) {
+			list_remove(&prev->link);
+			idx = span_index(prev);
+			pages += prev->pages;
+		}
+	}
 
-	/* Check for overflow */
-	if (end < area->start)
-		return false;
+	if (idx + pages < ARENA_PAGES) {
+		span_t *next = &arena->pages[idx + pages];
+		if (next->state == SPAN_FREE) {
+			list_remove(&next->link);
+			pages += next->pages;
+		}
+	}
 
-	/* Resize the address space area */
-	errno_t ret = as_area_resize(area->start, asize, 0);
-	if (ret != EOK)
-		return false;
+	run_insert(run_mark(arena, idx, pages, SPAN_FREE));
+}
 
-	heap_block_head_t *last_head =
-	    (heap_block_head_t *) AREA_LAST_BLOCK_HEAD(area);
+/** Take an object from a small object span
+ *
+ * Should be called only with the class mutex held.
+ *
+ */
+static void *span_pop(span_t *span)
+{
+	size_t size = class_sizes[span->cls];
+	void *obj;
 
-	if (last_head->free) {
-		/* Add the new space to the last block. */
-		size_t net_size = (size_t) (end - area->end) + last_head->size;
-		malloc_assert(net_size > 0);
-		block_init(last_head, net_size, true, area);
+	if (span->free_list != NULL) {
+		free_obj_t *fobj = span->free_list;
+		span->free_list = fobj->next;
+		obj = fobj;
 	} else {
-		/* Add new free block */
-		size_t net_size = (size_t) (end - area->end);
-		if (net_size > 0)
-			block_init(area->end, net_size, true, area);
+		/* Carve the free objects lazily to avoid touching the span. */
+		malloc_assert(span->carved < SMALL_SPAN_SIZE / size);
+		obj = span->base + span->carved * size;
+		span->carved++;
 	}
 
-	/* Update heap area parameters */
-	area->end = end;
+	span->used++;
+	if (span->used == SMALL_SPAN_SIZE / size) {
+		list_remove(&span->link);
+		span->partial = false;
+	}
 
-	return true;
+	return obj;
 }
 
-/** Try to shrink heap
+/** Take objects from the central list of a size class
  *
- * Should be called only inside the critical section.
- * In all cases the next pointer is reset.
+ * @param cls   Size class.
+ * @param count Number of objects to take.
+ * @param[out] list List of the objects taken.
  *
- * @param area Last modified heap area.
+ * @return Number of objects taken.
  *
  */
-static void heap_shrink(heap_area_t *area)
+static size_t class_take(unsigned cls, size_t count, free_obj_t **list)
 {
-	area_check(area);
-
-	heap_block_foot_t *last_foot =
-	    (heap_block_foot_t *) AREA_LAST_BLOCK_FOOT(area);
-	heap_block_head_t *last_head = BLOCK_HEAD(last_foot);
-
-	block_check((void *) last_head);
-	malloc_assert(last_head->area == area);
-
-	if (last_head->free) {
-		/*
-		 * The last block of the heap area is
-		 * unused. The area might be potentially
-		 * shrunk.
-		 */
-
-		heap_block_head_t *first_head =
-		    (heap_block_head_t *) AREA_FIRST_BLOCK_HEAD(area);
-
-		block_check((void *) first_head);
-		malloc_assert(first_head->area == area);
-
-		size_t shrink_size = ALIGN_DOWN(last_head->size, PAGE_SIZE);
-
-		if (first_head == last_head) {
-			/*
-			 * The entire heap area consists of a single
-			 * free heap block. This means we can get rid
-			 * of it entirely.
-			 */
-
-			heap_area_t *prev = area->prev;
-			heap_area_t *next = area->next;
-
-			if (prev != NULL) {
-				area_check(prev);
-				prev->next = next;
-			} else
-				first_heap_area = next;
-
-			if (next != NULL) {
-				area_check(next);
-				next->prev = prev;
-			} else
-				last_heap_area = prev;
-
-			as_area_destroy(area->start);
-		} else if (shrink_size >= SHRINK_GRANULARITY) {
-			/*
-			 * Make sure that we always shrink the area
-			 * by a multiple of page size and update
-			 * the block layout accordingly.
-			 */
-
-			size_t asize = (size_t) (area->end - area->start) - shrink_size;
-			void *end = (void *) ((uintptr_t) area->start + asize);
-
-			/* Resize the address space area */
-			errno_t ret = as_area_resize(area->start, asize, 0);
-			if (ret != EOK)
-				abort();
-
-			/* Update heap area parameters */
-			area->end = end;
-			size_t excess = ((size_t) area->end) - ((size_t) last_head);
-
-			if (excess > 0) {
-				if (excess >= STRUCT_OVERHEAD) {
-					/*
-					 * The previous block cannot be free and there
-					 * is enough free space left in the area to
-					 * create a new free block.
-					 */
-					block_init((void *) last_head, excess, true, area);
-				} else {
-					/*
-					 * The excess is small. Therefore just enlarge
-					 * the previous block.
-					 */
-					heap_block_foot_t *prev_foot = (heap_block_foot_t *)
-					    (((uintptr_t) last_head) - sizeof(heap_block_foot_t));
-					heap_block_head_t *prev_head = BLOCK_HEAD(prev_foot);
-
-					block_check((void *) prev_head);
-
-					block_init(prev_head, prev_head->size + excess,
-					    prev_head->free, area);
-				}
-			}
+	size_class_t *class = &classes[cls];
+	size_t taken = 0;
+
+	*list = NULL;
+
+	fibril_rmutex_lock(&class->mutex);
+
+	while (taken < count) {
+		if (list_empty(&class->partial)) {
+			fibril_rmutex_lock(&pages_mutex);
+			span_t *span = run_alloc(SMALL_SPAN_PAGES, SPAN_SMALL);
+			fibril_rmutex_unlock(&pages_mutex);
+
+			if (span == NULL)
+				break;
+
+			span->free_list = NULL;
+			span->used = 0;
+			span->carved = 0;
+			span->cls = cls;
+			span->partial = true;
+			list_append(&span->link, &class->partial);
 		}
+
+		span_t *span = list_get_instance(list_first(&class->partial),
+		    span_t, link);
+
+		free_obj_t *obj = span_pop(span);
+		obj->next = *list;
+		*list = obj;
+		taken++;
 	}
 
-	next_fit = NULL;
+	fibril_rmutex_unlock(&class->mutex);
+
+	return taken;
 }
 
-/** Initialize the heap allocator
+/** Return objects to the central list of a size class
  *
- * Create initial heap memory area. This routine is
- * only called from libc initialization, thus we do not
- * take any locks.
+ * Spans which become empty are returned to the page allocator unless they
+ * are the last partial span of the class.
+ *
+ * @param cls   Size class.
+ * @param list  List of the objects.
+ * @param count Number of objects to return.
  *
  */
-void __malloc_init(void)
+static void class_give(unsigned cls, free_obj_t *list, size_t count)
 {
-	if (fibril_rmutex_initialize(&malloc_mutex) != EOK)
-		abort();
+	size_class_t *class = &classes[cls];
 
-	if (!area_create(PAGE_SIZE))
-		abort();
+	fibril_rmutex_lock(&class->mutex);
+
+	while (count-- > 0) {
+		free_obj_t *obj = list;
+		list = obj->next;
+
+		span_t *span = span_find(arena_find(obj), obj);
+		malloc_assert(span->state == SPAN_SMALL);
+		malloc_assert(span->cls == cls);
+		malloc_assert(span->used > 0);
+
+		obj->next = span->free_list;
+		span->free_list = obj;
+		span->used--;
+
+		if (!span->partial) {
+			list_append(&span->link, &class->partial);
+			span->partial = true;
+		}
+
+		if ((span->used == 0) &&
+		    (list_first(&class->partial) != list_last(&class->partial))) {
+			list_remove(&span->link);
+			span->partial = false;
+
+			fibril_rmutex_lock(&pages_mutex);
+			run_free(span);
+			fibril_rmutex_unlock(&pages_mutex);
+		}
+	}
+
+	fibril_rmutex_unlock(&class->mutex);
 }
 
-void __malloc_fini(void)
+/** Grab a small object cache
+ *
+ * @return Cache or NULL if all caches are busy.
+ *
+ */
+static cache_t *cache_acquire(void)
 {
-	fibril_rmutex_destroy(&malloc_mutex);
+	if (cache_hint < 0) {
+		cache_hint = atomic_fetch_add_explicit(&cache_next, 1,
+		    memory_order_relaxed) % CACHE_COUNT;
+	}
+
+	for (int i = 0; i < CACHE_COUNT; i++) {
+		int idx = (cache_hint + i) % CACHE_COUNT;
+		if (!atomic_flag_test_and_set_explicit(&caches[idx].busy,
+		    memory_order_acquire)) {
+			cache_hint = idx;
+			return &caches[idx];
+		}
+	}
+
+	return NULL;
 }
 
-/** Split heap block and mark it as used.
+/** Release a small object cache */
+static inline void cache_release(cache_t *cache)
+{
+	atomic_flag_clear_explicit(&cache->busy, memory_order_release);
+}
+
+/** Allocate a small object
  *
- * Should be called only inside the critical section.
+ * @param cls Size class.
  *
- * @param cur  Heap block to split.
- * @param size Number of bytes to split and mark from the beginning
- *             of the block.
+ * @return Allocated object or NULL.
  *
  */
-static void split_mark(heap_block_head_t *cur, const size_t size)
+static void *malloc_small(unsigned cls)
 {
-	malloc_assert(cur->size >= size);
+	free_obj_t *obj;
+
+	cache_t *cache = cache_acquire();
+	if (cache == NULL) {
+		/* Everybody is busy, go to the central list directly. */
+		return (class_take(cls, 1, &obj) == 1) ? obj : NULL;
+	}
 
-	/* See if we should split the block. */
-	size_t split_limit = GROSS_SIZE(size);
+	cache_bin_t *bin = &cache->bins[cls];
 
-	if (cur->size > split_limit) {
-		/* Block big enough -> split. */
-		void *next = ((void *) cur) + size;
-		block_init(next, cur->size - size, true, cur->area);
-		block_init(cur, size, false, cur->area);
-	} else {
-		/* Block too small -> use as is. */
-		cur->free = false;
+	if (bin->head == NULL) {
+		bin->count = class_take(cls, cache_limit(cls) / 2,
+		    &bin->head);
+	}
+
+	obj = bin->head;
+	if (obj != NULL) {
+		bin->head = obj->next;
+		bin->count--;
+	}
+
+	cache_release(cache);
+	return obj;
+}
+
+/** Free a small object
+ *
+ * @param span Span of the object.
+ * @param addr Address of the object.
+ *
+ */
+static void free_small(span_t *span, void *addr)
+{
+	unsigned cls = span->cls;
+	free_obj_t *obj = (free_obj_t *) addr;
+
+	malloc_assert((size_t) (addr - span->base) % class_sizes[cls] == 0);
+	malloc_assert(span->used > 0);
+
+	cache_t *cache = cache_acquire();
+	if (cache == NULL) {
+		obj->next = NULL;
+		class_give(cls, obj, 1);
+		return;
+	}
+
+	cache_bin_t *bin = &cache->bins[cls];
+
+	if (bin->count >= cache_limit(cls)) {
+		/* Flush the older half of the bin. */
+		size_t keep = bin->count / 2;
+		free_obj_t *last = bin->head;
+		for (size_t i = 1; i < keep; i++)
+			last = last->next;
+
+		class_give(cls, last->next, bin->count - keep);
+		last->next = NULL;
+		bin->count = keep;
 	}
+
+	obj->next = bin->head;
+	bin->head = obj;
+	bin->count++;
+
+	cache_release(cache);
 }
 
-/** Allocate memory from heap area starting from given block
+/** Allocate a medium block as a page run
+ *
+ * @param size Size of the block.
+ *
+ * @return Allocated block or NULL.
  *
- * Should be called only inside the critical section.
- * As a side effect this function also sets the current
- * pointer on successful allocation.
+ */
+static void *malloc_medium(size_t size)
+{
+	fibril_rmutex_lock(&pages_mutex);
+	span_t *run = run_alloc(ALIGN_UP(size, PAGE_SIZE) / PAGE_SIZE,
+	    SPAN_MEDIUM);
+	fibril_rmutex_unlock(&pages_mutex);
+
+	return (run != NULL) ? run->base : NULL;
+}
+
+/** Free a medium block */
+static void free_medium(span_t *run, void *addr)
+{
+	malloc_assert(addr == run->base);
+
+	fibril_rmutex_lock(&pages_mutex);
+	run_free(run);
+	fibril_rmutex_unlock(&pages_mutex);
+}
+
+/** Get the header of a large block */
+static inline large_head_t *large_head(void *addr)
+{
+	large_head_t *head = (large_head_t *) (addr - LARGE_HEAD_SIZE);
+	malloc_assert(head->magic == LARGE_MAGIC);
+	return head;
+}
+
+/** Allocate a large block in an address space area of its own
  *
- * @param area        Heap area where to allocate from.
- * @param first_block Starting heap block.
- * @param final_block Heap block where to finish the search
- *                    (may be NULL).
- * @param real_size   Gross number of bytes to allocate.
- * @param falign      Physical alignment of the block.
+ * @param size  Size of the block.
+ * @param align Alignment of the block.
  *
- * @return Address of the allocated block or NULL on not enough memory.
+ * @return Allocated block or NULL.
  *
  */
-static void *malloc_area(heap_area_t *area, heap_block_head_t *first_block,
-    heap_block_head_t *final_block, size_t real_size, size_t falign)
+static void *malloc_large(size_t size, size_t align)
 {
-	area_check((void *) area);
-	malloc_assert((void *) first_block >= (void *) AREA_FIRST_BLOCK_HEAD(area));
-	malloc_assert((void *) first_block < area->end);
+	size_t pad = (align > BASE_ALIGN) ? align : 0;
 
-	for (heap_block_head_t *cur = first_block; (void *) cur < area->end;
-	    cur = (heap_block_head_t *) (((void *) cur) + cur->size)) {
-		block_check(cur);
+	if (size > SIZE_MAX - LARGE_HEAD_SIZE - pad - PAGE_SIZE)
+		return NULL;
 
-		/* Finish searching on the final block */
-		if ((final_block != NULL) && (cur == final_block))
-			break;
+	size_t asize = ALIGN_UP(LARGE_HEAD_SIZE + pad + size, PAGE_SIZE);
+	void *astart = as_area_create(AS_AREA_ANY, asize,
+	    AS_AREA_WRITE | AS_AREA_READ | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (astart == AS_MAP_FAILED)
+		return NULL;
 
-		/* Try to find a block that is free and large enough. */
-		if ((cur->free) && (cur->size >= real_size)) {
-			/*
-			 * We have found a suitable block.
-			 * Check for alignment properties.
-			 */
-			void *addr = (void *)
-			    ((uintptr_t) cur + sizeof(heap_block_head_t));
-			void *aligned = (void *)
-			    ALIGN_UP((uintptr_t) addr, falign);
-
-			if (addr == aligned) {
-				/* Exact block start including alignment. */
-				split_mark(cur, real_size);
-
-				next_fit = cur;
-				return addr;
-			} else {
-				/* Block start has to be aligned */
-				size_t excess = (size_t) (aligned - addr);
-
-				if (cur->size >= real_size + excess) {
-					/*
-					 * The current block is large enough to fit
-					 * data in (including alignment).
-					 */
-					if ((void *) cur > (void *) AREA_FIRST_BLOCK_HEAD(area)) {
-						/*
-						 * There is a block before the current block.
-						 * This previous block can be enlarged to
-						 * compensate for the alignment excess.
-						 */
-						heap_block_foot_t *prev_foot = (heap_block_foot_t *)
-						    ((void *) cur - sizeof(heap_block_foot_t));
-
-						heap_block_head_t *prev_head = (heap_block_head_t *)
-						    ((void *) cur - prev_foot->size);
-
-						block_check(prev_head);
-
-						size_t reduced_size = cur->size - excess;
-						heap_block_head_t *next_head = ((void *) cur) + excess;
-
-						if ((!prev_head->free) &&
-						    (excess >= STRUCT_OVERHEAD)) {
-							/*
-							 * The previous block is not free and there
-							 * is enough free space left to fill in
-							 * a new free block between the previous
-							 * and current block.
-							 */
-							block_init(cur, excess, true, area);
-						} else {
-							/*
-							 * The previous block is free (thus there
-							 * is no need to induce additional
-							 * fragmentation to the heap) or the
-							 * excess is small. Therefore just enlarge
-							 * the previous block.
-							 */
-							block_init(prev_head, prev_head->size + excess,
-							    prev_head->free, area);
-						}
-
-						block_init(next_head, reduced_size, true, area);
-						split_mark(next_head, real_size);
-
-						next_fit = next_head;
-						return aligned;
-					} else {
-						/*
-						 * The current block is the first block
-						 * in the heap area. We have to make sure
-						 * that the alignment excess is large enough
-						 * to fit a new free block just before the
-						 * current block.
-						 */
-						while (excess < STRUCT_OVERHEAD) {
-							aligned += falign;
-							excess += falign;
-						}
-
-						/* Check for current block size again */
-						if (cur->size >= real_size + excess) {
-							size_t reduced_size = cur->size - excess;
-							cur = (heap_block_head_t *)
-							    (AREA_FIRST_BLOCK_HEAD(area) + excess);
-
-							block_init((void *) AREA_FIRST_BLOCK_HEAD(area),
-							    excess, true, area);
-							block_init(cur, reduced_size, true, area);
-							split_mark(cur, real_size);
-
-							next_fit = cur;
-							return aligned;
-						}
-					}
-				}
-			}
+	void *addr = (void *) ALIGN_UP((uintptr_t) astart + LARGE_HEAD_SIZE,
+	    max(align, BASE_ALIGN));
+	large_head_t *head = (large_head_t *) (addr - LARGE_HEAD_SIZE);
+
+	head->start = astart;
+	head->area_size = asize;
+	head->magic = LARGE_MAGIC;
+
+	heap_usage_update(asize, true);
+
+	fibril_rmutex_lock(&large_mutex);
+	list_append(&head->link, &large_blocks);
+	fibril_rmutex_unlock(&large_mutex);
+
+	return addr;
+}
+
+/** Free a large block */
+static void free_large(void *addr)
+{
+	large_head_t *head = large_head(addr);
+
+	fibril_rmutex_lock(&large_mutex);
+	list_remove(&head->link);
+	fibril_rmutex_unlock(&large_mutex);
+
+	head->magic = 0;
+	heap_usage_update(head->area_size, false);
+	(void) as_area_destroy(head->start);
+}
+
+/** Find or create the call site record of a backtrace
+ *
+ * Should be called only with heap_profile_mutex held.
+ *
+ * @return Call site or NULL if the table is full.
+ *
+ */
+static heap_profile_site_t *heap_profile_site_get(const uintptr_t *trace)
+{
+	size_t hash = 0;
+	for (size_t i = 0; i < HEAP_PROFILE_DEPTH; i++)
+		hash = hash * 31 + (trace[i] >> 2);
+
+	for (size_t i = 0; i < HEAP_PROFILE_SITES; i++) {
+		heap_profile_site_t *site =
+		    &heap_profile_sites[(hash + i) % HEAP_PROFILE_SITES];
+
+		if (site->samples == 0) {
+			memcpy(site->trace, trace, sizeof(site->trace));
+			return site;
 		}
+
+		if (memcmp(site->trace, trace, sizeof(site->trace)) == 0)
+			return site;
 	}
 
 	return NULL;
 }
 
-/** Try to enlarge any of the heap areas.
+/** Get the home slot of a block in the table of sampled blocks */
+static inline size_t heap_profile_live_slot(void *addr)
+{
+	return ((uintptr_t) addr / BASE_ALIGN) % HEAP_PROFILE_LIVE;
+}
+
+/** Sample an allocation if it is due
+ *
+ * Kept out of line so that the backtrace has a fixed number of frames
+ * within malloc.c.
  *
- * If successful, allocate block of the given size in the area.
- * Should be called only inside the critical section.
+ * @param addr Address of the allocated block.
+ * @param size Requested size of the block.
  *
- * @param size  Gross size of item to allocate (bytes).
- * @param align Memory address alignment.
+ */
+static __attribute__((noinline)) void heap_profile_alloc(void *addr,
+    size_t size)
+{
+	size_t interval = atomic_load_explicit(&heap_profile_interval,
+	    memory_order_relaxed);
+	size_t left = atomic_fetch_sub_explicit(&heap_profile_countdown, size,
+	    memory_order_relaxed);
+	if ((interval == 0) || (left > size))
+		return;
+
+	atomic_store_explicit(&heap_profile_countdown, interval,
+	    memory_order_relaxed);
+
+	uintptr_t trace[HEAP_PROFILE_DEPTH] = { 0 };
+	(void) stacktrace_capture(trace, HEAP_PROFILE_DEPTH, HEAP_PROFILE_SKIP);
+
+	/* A sample stands for all the bytes allocated since the last one. */
+	size_t weight = max(size, interval);
+
+	fibril_rmutex_lock(&heap_profile_mutex);
+
+	heap_profile_site_t *site = heap_profile_site_get(trace);
+	size_t tracked = atomic_load_explicit(&heap_profile_tracked,
+	    memory_order_relaxed);
+
+	if ((site == NULL) || (tracked >= HEAP_PROFILE_LIVE / 2)) {
+		/* Keep the table sparse so that probing stays short. */
+		heap_profile_dropped++;
+	} else {
+		size_t slot = heap_profile_live_slot(addr);
+		while (heap_profile_live[slot].addr != NULL)
+			slot = (slot + 1) % HEAP_PROFILE_LIVE;
+
+		heap_profile_live[slot] = (heap_profile_live_t) {
+			.addr = addr,
+			.weight = weight,
+			.site = (size_t) (site - heap_profile_sites)
+		};
+		atomic_store_explicit(&heap_profile_tracked, tracked + 1,
+		    memory_order_relaxed);
+
+		site->samples++;
+		site->live += weight;
+		site->total += weight;
+	}
+
+	fibril_rmutex_unlock(&heap_profile_mutex);
+}
+
+/** Stop tracking a sampled block which is being freed
  *
- * @return Allocated block.
- * @return NULL on failure.
+ * @param addr Address of the block.
  *
  */
-static void *heap_grow_and_alloc(size_t size, size_t align)
+static void heap_profile_free(void *addr)
 {
-	if (size == 0)
-		return NULL;
+	fibril_rmutex_lock(&heap_profile_mutex);
 
-	/* First try to enlarge some existing area */
-	for (heap_area_t *area = first_heap_area; area != NULL;
-	    area = area->next) {
+	size_t slot = heap_profile_live_slot(addr);
+	while ((heap_profile_live[slot].addr != NULL) &&
+	    (heap_profile_live[slot].addr != addr))
+		slot = (slot + 1) % HEAP_PROFILE_LIVE;
 
-		if (area_grow(area, size + align)) {
-			heap_block_head_t *first =
-			    (heap_block_head_t *) AREA_LAST_BLOCK_HEAD(area);
+	if (heap_profile_live[slot].addr == NULL) {
+		/* Not a sampled block. */
+		fibril_rmutex_unlock(&heap_profile_mutex);
+		return;
+	}
 
-			void *addr =
-			    malloc_area(area, first, NULL, size, align);
-			malloc_assert(addr != NULL);
-			return addr;
+	heap_profile_live_t *live = &heap_profile_live[slot];
+	heap_profile_sites[live->site].live -= live->weight;
+	live->addr = NULL;
+
+	/* Move back the entries which probed past the freed slot. */
+	size_t hole = slot;
+	for (size_t i = (slot + 1) % HEAP_PROFILE_LIVE;
+	    heap_profile_live[i].addr != NULL; i = (i + 1) % HEAP_PROFILE_LIVE) {
+		size_t home = heap_profile_live_slot(heap_profile_live[i].addr);
+		if (((i - home) % HEAP_PROFILE_LIVE) >=
+		    ((i - hole) % HEAP_PROFILE_LIVE)) {
+			heap_profile_live[hole] = heap_profile_live[i];
+			heap_profile_live[i].addr = NULL;
+			hole = i;
 		}
 	}
 
-	/* Eventually try to create a new area */
-	if (area_create(AREA_OVERHEAD(size + align))) {
-		heap_block_head_t *first =
-		    (heap_block_head_t *) AREA_FIRST_BLOCK_HEAD(last_heap_area);
+	atomic_fetch_sub_explicit(&heap_profile_tracked, 1,
+	    memory_order_relaxed);
 
-		void *addr =
-		    malloc_area(last_heap_area, first, NULL, size, align);
-		malloc_assert(addr != NULL);
-		return addr;
-	}
+	fibril_rmutex_unlock(&heap_profile_mutex);
+}
 
-	return NULL;
+/** Check whether the heap profiler samples allocations */
+static inline bool heap_profile_sampling(void)
+{
+	return atomic_load_explicit(&heap_profile_interval,
+	    memory_order_relaxed) != 0;
+}
+
+/** Check whether the heap profiler tracks any sampled block */
+static inline bool heap_profile_tracking(void)
+{
+	return atomic_load_explicit(&heap_profile_tracked,
+	    memory_order_relaxed) != 0;
 }
 
-/** Allocate a memory block
+/** Start sampling allocations
+ *
+ * One allocation is sampled for every @a interval bytes allocated. The
+ * profile accumulates over subsequent runs of the profiler.
  *
- * Should be called only inside the critical section.
+ * @param interval Sampling interval in bytes (non-zero).
  *
- * @param size  The size of the block to allocate.
- * @param align Memory address alignment.
+ */
+void heap_profile_start(size_t interval)
+{
+	assert(interval > 0);
+
+	atomic_store_explicit(&heap_profile_countdown, interval,
+	    memory_order_relaxed);
+	atomic_store_explicit(&heap_profile_interval, interval,
+	    memory_order_relaxed);
+}
+
+/** Stop sampling allocations
  *
- * @return Address of the allocated block or NULL on not enough memory.
+ * Blocks sampled so far stay tracked until they are freed.
  *
  */
-static void *malloc_internal(const size_t size, const size_t align)
+void heap_profile_stop(void)
 {
-	malloc_assert(first_heap_area != NULL);
+	atomic_store_explicit(&heap_profile_interval, 0, memory_order_relaxed);
+}
 
-	if (align == 0)
-		return NULL;
+/** Print the heap profile to the standard output */
+void heap_profile_dump(void)
+{
+	printf("Heap profile: interval %zu B, in use %zu B, peak %zu B, "
+	    "%zu samples dropped\n",
+	    atomic_load_explicit(&heap_profile_interval, memory_order_relaxed),
+	    atomic_load_explicit(&heap_in_use_bytes, memory_order_relaxed),
+	    atomic_load_explicit(&heap_peak_bytes, memory_order_relaxed),
+	    heap_profile_dropped);
+
+	for (size_t i = 0; i < HEAP_PROFILE_SITES; i++) {
+		/* Printing may allocate, do not hold the lock meanwhile. */
+		fibril_rmutex_lock(&heap_profile_mutex);
+		heap_profile_site_t site = heap_profile_sites[i];
+		fibril_rmutex_unlock(&heap_profile_mutex);
+
+		if (site.samples == 0)
+			continue;
+
+		printf("%zu B live, %zu B total, %zu samples\n", site.live,
+		    site.total, site.samples);
+
+		for (size_t j = 0; j < HEAP_PROFILE_DEPTH; j++) {
+			if (site.trace[j] == 0)
+				break;
+			printf("\t%p\n", (void *) site.trace[j]);
+		}
+	}
+}
 
-	size_t falign = lcm(align, BASE_ALIGN);
+/** Get the number of usable bytes of a block */
+static size_t block_usable_size(void *addr)
+{
+	arena_t *arena = arena_find(addr);
+	if (arena == NULL) {
+		large_head_t *head = large_head(addr);
+		return (size_t) (head->start + head->area_size - addr);
+	}
 
-	/* Check for integer overflow. */
-	if (falign < align)
-		return NULL;
+	span_t *span = span_find(arena, addr);
+	malloc_assert(span->magic == SPAN_MAGIC);
 
-	/*
-	 * The size of the allocated block needs to be naturally
-	 * aligned, because the footer structure also needs to reside
-	 * on a naturally aligned address in order to avoid unaligned
-	 * memory accesses.
-	 */
-	size_t gross_size = GROSS_SIZE(ALIGN_UP(size, BASE_ALIGN));
+	if (span->state == SPAN_SMALL)
+		return class_sizes[span->cls];
 
-	/* Try the next fit approach */
-	heap_block_head_t *split = next_fit;
+	malloc_assert(span->state == SPAN_MEDIUM);
+	return span->pages * PAGE_SIZE;
+}
 
-	if (split != NULL) {
-		void *addr = malloc_area(split->area, split, NULL, gross_size,
-		    falign);
+/** Initialize the heap allocator
+ *
+ * Create the first arena. This function is
+ * only called from libc initialization, thus we do not
+ * take any locks.
+ *
+ */
+void __malloc_init(void)
+{
+	if (fibril_rmutex_initialize(&pages_mutex) != EOK)
+		abort();
+	if (fibril_rmutex_initialize(&large_mutex) != EOK)
+		abort();
+	if (fibril_rmutex_initialize(&heap_profile_mutex) != EOK)
+		abort();
 
-		if (addr != NULL)
-			return addr;
+	for (unsigned i = 0; i < CLASS_COUNT; i++) {
+		if (fibril_rmutex_initialize(&classes[i].mutex) != EOK)
+			abort();
+		list_initialize(&classes[i].partial);
 	}
 
-	/* Search the entire heap */
-	for (heap_area_t *area = first_heap_area; area != NULL;
-	    area = area->next) {
-		heap_block_head_t *first = (heap_block_head_t *)
-		    AREA_FIRST_BLOCK_HEAD(area);
+	for (unsigned i = 0; i < RUN_BUCKETS; i++)
+		list_initialize(&free_runs[i]);
+
+	for (unsigned i = 0; i < CACHE_COUNT; i++)
+		atomic_flag_clear(&caches[i].busy);
+
+	list_initialize(&large_blocks);
+
+	if (!arena_create())
+		abort();
+}
+
+void __malloc_fini(void)
+{
+	for (unsigned i = 0; i < CLASS_COUNT; i++)
+		fibril_rmutex_destroy(&classes[i].mutex);
+
+	fibril_rmutex_destroy(&heap_profile_mutex);
+	fibril_rmutex_destroy(&large_mutex);
+	fibril_rmutex_destroy(&pages_mutex);
+}
+
+/** Allocate memory
+ *
+ * @param size  Number of bytes to allocate.
+ * @param align Memory address alignment (a power of two).
+ *
+ * @return Allocated memory or NULL.
+ *
+ */
+static void *malloc_internal(size_t size, size_t align)
+{
+	void *block;
 
-		void *addr = malloc_area(area, first, split, gross_size,
-		    falign);
+	if (size == 0)
+		size = 1;
+
+	if ((size <= SMALL_MAX) && (align <= SMALL_MAX)) {
+		unsigned cls = size_class(size, align);
+		if (cls < CLASS_COUNT) {
+			block = malloc_small(cls);
+			if (block != NULL)
+				return block;
+		}
+	}
 
-		if (addr != NULL)
-			return addr;
+	if ((size <= MEDIUM_MAX) && (align <= PAGE_SIZE)) {
+		block = malloc_medium(size);
+		if (block != NULL)
+			return block;
 	}
 
-	/* Finally, try to grow heap space and allocate in the new area. */
-	return heap_grow_and_alloc(gross_size, falign);
+	/* Also the fallback when all arenas are used up. */
+	return malloc_large(size, align);
 }
 
 /** Allocate memory by number of elements
@@ -801,9 +1258,10 @@ void *calloc(const size_t nmemb, const size_t size)
  */
 void *malloc(const size_t size)
 {
-	heap_lock();
 	void *block = malloc_internal(size, BASE_ALIGN);
-	heap_unlock();
+
+	if ((block != NULL) && heap_profile_sampling())
+		heap_profile_alloc(block, size);
 
 	return block;
 }
@@ -824,9 +1282,10 @@ void *memalign(const size_t align, const size_t size)
 	size_t palign =
 	    1 << (fnzb(max(sizeof(void *), align) - 1) + 1);
 
-	heap_lock();
-	void *block = malloc_internal(size, palign);
-	heap_unlock();
+	void *block = malloc_internal(size, max(palign, BASE_ALIGN));
+
+	if ((block != NULL) && heap_profile_sampling())
+		heap_profile_alloc(block, size);
 
 	return block;
 }
@@ -849,100 +1308,35 @@ void *realloc(void *const addr, const size_t size)
 	if (addr == NULL)
 		return malloc(size);
 
-	heap_lock();
-
-	/* Calculate the position of the header. */
-	heap_block_head_t *head =
-	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
-
-	block_check(head);
-	malloc_assert(!head->free);
-
-	heap_area_t *area = head->area;
-
-	area_check(area);
-	malloc_assert((void *) head >= (void *) AREA_FIRST_BLOCK_HEAD(area));
-	malloc_assert((void *) head < area->end);
-
-	void *ptr = NULL;
-	bool reloc = false;
-	size_t real_size = GROSS_SIZE(ALIGN_UP(size, BASE_ALIGN));
-	size_t orig_size = head->size;
-
-	if (orig_size > real_size) {
-		/* Shrink */
-		if (orig_size - real_size >= STRUCT_OVERHEAD) {
-			/*
-			 * Split the original block to a full block
-			 * and a trailing free block.
-			 */
-			block_init((void *) head, real_size, false, area);
-			block_init((void *) head + real_size,
-			    orig_size - real_size, true, area);
-			heap_shrink(area);
-		}
+	size_t usable = block_usable_size(addr);
 
-		ptr = ((void *) head) + sizeof(heap_block_head_t);
-	} else {
-		heap_block_head_t *next_head =
-		    (heap_block_head_t *) (((void *) head) + head->size);
-		bool have_next = ((void *) next_head < area->end);
-
-		if (((void *) head) + real_size > area->end) {
-			/*
-			 * The current area is too small to hold the resized
-			 * block. Make sure there are no used blocks standing
-			 * in our way and try to grow the area using real_size
-			 * as a safe upper bound.
-			 */
-
-			bool have_next_next;
-
-			if (have_next) {
-				have_next_next = (((void *) next_head) +
-				    next_head->size < area->end);
-			}
-			if (!have_next || (next_head->free && !have_next_next)) {
-				/*
-				 * There is no next block in this area or
-				 * it is a free block and there is no used
-				 * block following it. There can't be any
-				 * free block following it either as
-				 * two free blocks would be merged.
-				 */
-				(void) area_grow(area, real_size);
-			}
-		}
+	/*
+	 * Keep the block unless that would waste more than half of it
+	 * (the smallest size class cannot shrink any further).
+	 */
+	if ((size <= usable) &&
+	    ((size > usable / 2) || (usable <= class_sizes[0])))
+		return addr;
+
+	if ((size > usable) && (arena_find(addr) == NULL)) {
+		/* Try to grow a large block in place. */
+		large_head_t *head = large_head(addr);
+		size_t offset = (size_t) (addr - head->start);
 
-		/*
-		 * Look at the next block. If it is free and the size is
-		 * sufficient then merge the two. Otherwise just allocate a new
-		 * block, copy the original data into it and free the original
-		 * block.
-		 */
-
-		if (have_next && (head->size + next_head->size >= real_size) &&
-		    next_head->free) {
-			block_check(next_head);
-			block_init(head, head->size + next_head->size, false,
-			    area);
-			split_mark(head, real_size);
-
-			ptr = ((void *) head) + sizeof(heap_block_head_t);
-			next_fit = NULL;
-		} else {
-			reloc = true;
+		if (size <= SIZE_MAX - offset - PAGE_SIZE) {
+			size_t asize = ALIGN_UP(offset + size, PAGE_SIZE);
+			if (as_area_resize(head->start, asize, 0) == EOK) {
+				heap_usage_update(asize - head->area_size, true);
+				head->area_size = asize;
+				return addr;
+			}
 		}
 	}
 
-	heap_unlock();
-
-	if (reloc) {
-		ptr = malloc(size);
-		if (ptr != NULL) {
-			memcpy(ptr, addr, NET_SIZE(orig_size));
-			free(addr);
-		}
+	void *ptr = malloc(size);
+	if (ptr != NULL) {
+		memcpy(ptr, addr, min(size, usable));
+		free(addr);
 	}
 
 	return ptr;
@@ -958,101 +1352,145 @@ void free(void *const addr)
 	if (addr == NULL)
 		return;
 
-	heap_lock();
-
-	/* Calculate the position of the header. */
-	heap_block_head_t *head =
-	    (heap_block_head_t *) (addr - sizeof(heap_block_head_t));
-
-	block_check(head);
-	malloc_assert(!head->free);
+	if (heap_profile_tracking())
+		heap_profile_free(addr);
 
-	heap_area_t *area = head->area;
-
-	area_check(area);
-	malloc_assert((void *) head >= (void *) AREA_FIRST_BLOCK_HEAD(area));
-	malloc_assert((void *) head < area->end);
-
-	/* Mark the block itself as free. */
-	head->free = true;
-
-	/* Look at the next block. If it is free, merge the two. */
-	heap_block_head_t *next_head =
-	    (heap_block_head_t *) (((void *) head) + head->size);
-
-	if ((void *) next_head < area->end) {
-		block_check(next_head);
-		if (next_head->free)
-			block_init(head, head->size + next_head->size, true, area);
+	arena_t *arena = arena_find(addr);
+	if (arena == NULL) {
+		free_large(addr);
+		return;
 	}
 
-	/* Look at the previous block. If it is free, merge the two. */
-	if ((void *) head > (void *) AREA_FIRST_BLOCK_HEAD(area)) {
-		heap_block_foot_t *prev_foot =
-		    (heap_block_foot_t *) (((void *) head) - sizeof(heap_block_foot_t));
-
-		heap_block_head_t *prev_head =
-		    (heap_block_head_t *) (((void *) head) - prev_foot->size);
+	span_t *span = span_find(arena, addr);
+	malloc_assert(span->magic == SPAN_MAGIC);
 
-		block_check(prev_head);
-
-		if (prev_head->free)
-			block_init(prev_head, prev_head->size + head->size, true,
-			    area);
+	if (span->state == SPAN_SMALL) {
+		free_small(span, addr);
+	} else {
+		malloc_assert(span->state == SPAN_MEDIUM);
+		free_medium(span, addr);
 	}
+}
 
-	heap_shrink(area);
+/** Check the consistency of a small object span
+ *
+ * Should be called only with the class mutex held.
+ *
+ * @return NULL if consistent, otherwise the offending address.
+ *
+ */
+static void *span_check(span_t *span)
+{
+	if (span->cls >= CLASS_COUNT)
+		return (void *) span;
+
+	size_t size = class_sizes[span->cls];
+	size_t capacity = SMALL_SPAN_SIZE / size;
+
+	if ((span->pages != SMALL_SPAN_PAGES) || (span->carved > capacity) ||
+	    (span->used > span->carved))
+		return (void *) span;
+
+	/* Walk the free objects. */
+	size_t free_count = 0;
+	for (free_obj_t *obj = span->free_list; obj != NULL;
+	    obj = obj->next) {
+		if (((void *) obj < span->base) ||
+		    ((void *) obj >= span->base + span->carved * size) ||
+		    ((size_t) ((void *) obj - span->base) % size != 0) ||
+		    (++free_count > (size_t) (span->carved - span->used)))
+			return (void *) obj;
+	}
 
-	heap_unlock();
+	return NULL;
 }
 
+/** Check the consistency of the heap
+ *
+ * Objects held in the small object caches are not examined.
+ *
+ * @return NULL if consistent, (void *) -1 if the heap is not initialized,
+ *         otherwise the address of the corrupted structure.
+ *
+ */
 void *heap_check(void)
 {
-	heap_lock();
-
-	if (first_heap_area == NULL) {
-		heap_unlock();
+	size_t count = atomic_load_explicit(&arena_count, memory_order_acquire);
+	if (count == 0)
 		return (void *) -1;
-	}
 
-	/* Walk all heap areas */
-	for (heap_area_t *area = first_heap_area; area != NULL;
-	    area = area->next) {
-
-		/* Check heap area consistency */
-		if ((area->magic != HEAP_AREA_MAGIC) ||
-		    ((void *) area != area->start) ||
-		    (area->start >= area->end) ||
-		    (((uintptr_t) area->start % PAGE_SIZE) != 0) ||
-		    (((uintptr_t) area->end % PAGE_SIZE) != 0)) {
-			heap_unlock();
-			return (void *) area;
+	void *bad = NULL;
+
+	for (unsigned i = 0; i < CLASS_COUNT; i++)
+		fibril_rmutex_lock(&classes[i].mutex);
+	fibril_rmutex_lock(&pages_mutex);
+
+	/* Walk all arenas */
+	for (size_t i = 0; (i < count) && (bad == NULL); i++) {
+		arena_t *arena = arenas[i];
+
+		/* Check arena consistency */
+		if ((arena->magic != ARENA_MAGIC) ||
+		    ((void *) arena != arena->start) ||
+		    (arena->end != arena->start + ARENA_SIZE) ||
+		    (((uintptr_t) arena->start % PAGE_SIZE) != 0)) {
+			bad = (void *) arena;
+			break;
 		}
 
-		/* Walk all heap blocks */
-		for (heap_block_head_t *head = (heap_block_head_t *)
-		    AREA_FIRST_BLOCK_HEAD(area); (void *) head < area->end;
-		    head = (heap_block_head_t *) (((void *) head) + head->size)) {
+		/* Walk all page runs */
+		size_t idx = ARENA_META_PAGES;
+		while (idx < ARENA_PAGES) {
+			span_t *run = &arena->pages[idx];
+
+			/* Check run consistency */
+			if ((run->magic != SPAN_MAGIC) || (run->head != run) ||
+			    (run->arena != arena) || (run->pages == 0) ||
+			    (run->pages > ARENA_PAGES - idx) ||
+			    (run->base != arena->start + idx * PAGE_SIZE) ||
+			    (arena->pages[idx + run->pages - 1].head != run)) {
+				bad = (void *) run;
+				break;
+			}
 
-			/* Check heap block consistency */
-			if (head->magic != HEAP_BLOCK_HEAD_MAGIC) {
-				heap_unlock();
-				return (void *) head;
+			if (run->state == SPAN_SMALL) {
+				bad = span_check(run);
+				if (bad != NULL)
+					break;
+			} else if ((run->state != SPAN_FREE) &&
+			    (run->state != SPAN_MEDIUM)) {
+				bad = (void *) run;
+				break;
 			}
 
-			heap_block_foot_t *foot = BLOCK_FOOT(head);
+			idx += run->pages;
+		}
+	}
 
-			if ((foot->magic != HEAP_BLOCK_FOOT_MAGIC) ||
-			    (head->size != foot->size)) {
-				heap_unlock();
-				return (void *) foot;
-			}
+	fibril_rmutex_unlock(&pages_mutex);
+	for (unsigned i = CLASS_COUNT; i > 0; i--)
+		fibril_rmutex_unlock(&classes[i - 1].mutex);
+
+	if (bad != NULL)
+		return bad;
+
+	/* Walk all large blocks */
+	fibril_rmutex_lock(&large_mutex);
+
+	list_foreach(large_blocks, link, large_head_t, head) {
+		if ((head->magic != LARGE_MAGIC) ||
+		    (((uintptr_t) head->start % PAGE_SIZE) != 0) ||
+		    ((void *) head < head->start) ||
+		    ((void *) head + LARGE_HEAD_SIZE > head->start +
+		    head->area_size)) {
+			bad = (void *) head;
+			break;
 		}
 	}
 
-	heap_unlock();
+	fibril_rmutex_unlock(&large_mutex);
 
-	return NULL;
+	return bad;
 }
 
 /** @}
@@ -37,7 +37,11 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <libarch/config.h>
 #include "private/cc.h"
+#include "private/libc.h"
+
+#ifndef ARCH_HAS_MEMFNC
 
 /** Fill memory block with a constant value. */
 ATTRIBUTE_OPTIMIZE_NO_TLDP
@@ -192,6 +196,13 @@ ATTRIBUTE_OPTIMIZE_NO_TLDP
 	return dst;
 }
 
+/** The generic memory string functions need no initialization. */
+void __mem_init(void)
+{
+}
+
+#endif /* !ARCH_HAS_MEMFNC */
+
 /** Move memory block with possible overlapping. */
 void *memmove(void *dst, const void *src, size_t n)
 {
@@ -71,11 +71,26 @@ struct async_sess {
 	/** Number of opened exchanges */
 	int exchanges;
 
+	/** Number of data phones of a parallel session, idle or in use */
+	size_t phones;
+
+	/** Concurrency advertised by the server */
+	size_t preferred;
+
+	/** Exchange pool configuration */
+	async_pool_config_t pool;
+
+	/** Exchange pool statistics */
+	async_pool_stats_t pool_stats;
+
 	/** Mutex for stateful connections */
 	fibril_mutex_t remote_state_mtx;
 
 	/** Data for stateful connections */
 	void *remote_state_data;
+
+	/** Shared-memory rings the requests are sent through, if any */
+	struct async_ring *ring;
 };
 
 /** Exchange data */
@@ -91,6 +106,9 @@ struct async_exch {
 
 	/** Exchange identification */
 	cap_phone_handle_t phone;
+
+	/** Time the exchange became inactive */
+	struct timespec idle_since;
 };
 
 extern void __async_server_init(void);
@@ -61,6 +61,8 @@ struct fibril {
 	errno_t retval;
 
 	fibril_t *thread_ctx;
+	/* Ready queue of the thread running the fibril, moves with thread_ctx. */
+	unsigned runner;
 
 	bool is_running : 1;
 	bool is_writer : 1;
@@ -86,6 +88,8 @@ extern errno_t fibril_wait_timeout(fibril_event_t *, const struct timespec *);
 extern void fibril_notify(fibril_event_t *);
 
 extern errno_t fibril_ipc_wait(ipc_call_t *, const struct timespec *);
+extern errno_t fibril_ipc_wait_multi(ipc_call_t *, size_t,
+    const struct timespec *, size_t *);
 extern void fibril_ipc_poke(void);
 
 /**
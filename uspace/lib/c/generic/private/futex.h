@@ -163,11 +163,90 @@ static inline errno_t futex_down_composable(futex_t *futex,
 static inline errno_t futex_up(futex_t *futex)
 {
 	if (atomic_fetch_add_explicit(&futex->val, 1, memory_order_release) < 0)
-		return __SYSCALL1(SYS_WAITQ_WAKEUP, (sysarg_t) futex->whandle);
+		return __SYSCALL2(SYS_WAITQ_WAKEUP, (sysarg_t) futex->whandle, 1);
 
 	return EOK;
 }
 
+/** Up the futex several times at once.
+ *
+ * This is equivalent to calling futex_up() @a count times, but the
+ * counter is updated with a single atomic operation and all the sleepers
+ * that get a token are woken up by a single syscall. No syscall is made
+ * if nobody is waiting.
+ *
+ * @param futex Futex.
+ * @param count Number of tokens to add.
+ *
+ * @return ENOENT if there is no such virtual address.
+ * @return EOK on success.
+ * @return Error code from <errno.h> otherwise.
+ *
+ */
+static inline errno_t futex_up_n(futex_t *futex, int count)
+{
+	assert(count >= 0);
+
+	if (count == 0)
+		return EOK;
+
+	int old = atomic_fetch_add_explicit(&futex->val, count,
+	    memory_order_release);
+	if (old >= 0)
+		return EOK;
+
+	int waiters = -old;
+	return __SYSCALL2(SYS_WAITQ_WAKEUP, (sysarg_t) futex->whandle,
+	    (sysarg_t) (waiters < count ? waiters : count));
+}
+
+/** Move threads waiting on one futex to another one.
+ *
+ * Up to @a count threads sleeping in @a src are moved to @a dst without
+ * being woken up, so that e.g. a broadcast on a condition does not wake
+ * every waiter only to have them contend on the associated lock.
+ *
+ * The caller must be holding @a dst (i.e. its counter must be non-positive
+ * and must not be upped concurrently). Waiters on @a src may observe
+ * spurious wakeups when it is upped concurrently with the requeue.
+ *
+ * @param src   Futex to take the waiting threads from.
+ * @param dst   Futex to move the waiting threads to.
+ * @param count Maximum number of threads to move.
+ *
+ * @return EOK on success.
+ * @return Error code from <errno.h> otherwise.
+ *
+ */
+static inline errno_t futex_requeue(futex_t *src, futex_t *dst, int count)
+{
+	assert(count >= 0);
+	assert(atomic_load_explicit(&dst->val, memory_order_relaxed) <= 0);
+
+	if (count == 0)
+		return EOK;
+
+	/* Account for the moved threads as waiters on dst in advance. */
+	atomic_fetch_sub_explicit(&dst->val, count, memory_order_relaxed);
+
+	size_t moved = 0;
+	errno_t rc = __SYSCALL4(SYS_WAITQ_REQUEUE, (sysarg_t) src->whandle,
+	    (sysarg_t) dst->whandle, (sysarg_t) count, (sysarg_t) &moved);
+	if (rc != EOK)
+		moved = 0;
+
+	/* The moved threads no longer wait for a src token. */
+	if (moved > 0)
+		atomic_fetch_add_explicit(&src->val, (int) moved,
+		    memory_order_relaxed);
+
+	/* Nobody ups dst while we hold it, so no wakeup can be lost here. */
+	atomic_fetch_add_explicit(&dst->val, count - (int) moved,
+	    memory_order_relaxed);
+
+	return rc;
+}
+
 static inline errno_t futex_down_timeout(futex_t *futex,
     const struct timespec *expires)
 {
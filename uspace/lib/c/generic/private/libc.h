@@ -63,6 +63,7 @@ extern progsymbols_t __progsymbols;
 extern void __libc_main(void *) __attribute__((noreturn));
 extern void __libc_exit(int) __attribute__((noreturn));
 extern void __libc_abort(void) __attribute__((noreturn));
+extern void __mem_init(void);
 
 #endif
 
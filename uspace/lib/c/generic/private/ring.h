@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared-memory IPC rings.
+ */
+
+#ifndef _LIBC_PRIVATE_RING_H_
+#define _LIBC_PRIVATE_RING_H_
+
+#include <abi/cap.h>
+#include <abi/ipc/ring.h>
+#include <async.h>
+#include <fibril_synch.h>
+#include <ipc/common.h>
+#include <refcount.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "./fibril.h"
+
+/** Number of entries in each ring. Must be a power of two. */
+#define ASYNC_RING_ENTRIES  64
+
+/** Call handle of the calls received through a ring. */
+#define ASYNC_RING_CALL  ((cap_call_handle_t) -1)
+
+/** Ring entry.
+ *
+ * A request carries the interface and method followed by the payload
+ * arguments, an answer carries the return value followed by the return
+ * arguments. The tag is chosen by the client and copied into the answer.
+ */
+typedef struct {
+	sysarg_t args[IPC_CALL_LEN];
+	sysarg_t tag;
+} async_ring_entry_t;
+
+/** Single-producer single-consumer queue in shared memory. */
+typedef struct {
+	/** Index of the next entry to be consumed. Written by the consumer. */
+	atomic_size_t head;
+	/** Index of the next entry to be produced. Written by the producer. */
+	atomic_size_t tail;
+	/** The consumer is about to wait for the doorbell. */
+	atomic_bool sleeping;
+	async_ring_entry_t entries[ASYNC_RING_ENTRIES];
+} async_ring_queue_t;
+
+/** Layout of the address space area shared by the client and the server. */
+typedef struct {
+	/** Submission queue, produced by the client. */
+	async_ring_queue_t sq;
+	/** Completion queue, produced by the server. */
+	async_ring_queue_t cq;
+} async_ring_shared_t;
+
+/** Local state of one side of a pair of rings. */
+typedef struct async_ring {
+	atomic_refcount_t refcnt;
+
+	/** Side of the rings this task is on. */
+	ipc_ring_side_t side;
+
+	/** Shared area. */
+	async_ring_shared_t *shared;
+
+	/** Doorbell capability. */
+	cap_ring_handle_t handle;
+
+	/** Serializes the producers of this side. */
+	fibril_rmutex_t lock;
+
+	/** The ring is being torn down. */
+	atomic_bool closed;
+
+	/** Signalled by the consumer thread when it exits. */
+	fibril_event_t done;
+
+	/** Client: messages waiting for answers, indexed by tag. */
+	void *slots[ASYNC_RING_ENTRIES];
+
+	/** Client: number of requests sent through the phone. */
+	atomic_size_t phone_calls;
+
+	/** Server: channel of the connection the requests are routed to. */
+	mpsc_t *channel;
+
+	/** Server: client task. */
+	task_id_t in_task_id;
+
+	/** Server: number of requests which have not been answered yet. */
+	atomic_size_t pending;
+} async_ring_t;
+
+extern errno_t async_ring_connect(async_exch_t *, async_ring_t **);
+extern errno_t async_ring_accept(ipc_call_t *, mpsc_t *, async_ring_t **);
+extern void async_ring_destroy(async_ring_t *);
+extern void async_ring_add_ref(async_ring_t *);
+extern void async_ring_put(async_ring_t *);
+
+extern errno_t async_ring_send(async_ring_t *, sysarg_t, sysarg_t, sysarg_t,
+    sysarg_t, sysarg_t, sysarg_t, void *);
+extern errno_t async_ring_answer(ipc_call_t *, errno_t, sysarg_t, sysarg_t,
+    sysarg_t, sysarg_t, sysarg_t);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#include <libc.h>
+#include <profile.h>
+#include <as.h>
+#include <byteorder.h>
+#include <ddi.h>
+#include <stdbool.h>
+#include <str.h>
+#include <sysinfo.h>
+
+/** Kernel symbol table mapped from the kernel */
+static const profile_symbol_t *ksymtab;
+
+/** Number of symbols in the kernel symbol table */
+static size_t ksymtab_count;
+
+/** Mapping the kernel symbol table failed */
+static bool ksymtab_failed = false;
+
+/** Start the kernel sampling profiler.
+ *
+ * @param period Sampling period in clock ticks of each CPU.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t profile_start(unsigned int period)
+{
+	if (period == 0)
+		return EINVAL;
+
+	return (errno_t) __SYSCALL1(SYS_PROFILE_CTL, (sysarg_t) period);
+}
+
+/** Stop the kernel sampling profiler.
+ *
+ * The samples taken so far can still be read.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t profile_stop(void)
+{
+	return (errno_t) __SYSCALL1(SYS_PROFILE_CTL, 0);
+}
+
+/** Read and remove samples collected by the profiler.
+ *
+ * @param buf   Buffer for the samples.
+ * @param count Capacity of @a buf in samples.
+ * @param nread Place to store the number of samples read.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t profile_read(profile_sample_t *buf, size_t count, size_t *nread)
+{
+	return (errno_t) __SYSCALL3(SYS_PROFILE_READ, (sysarg_t) buf,
+	    (sysarg_t) count, (sysarg_t) nread);
+}
+
+/** Map the kernel symbol table
+ *
+ * The table is mapped read-only on the first use.
+ *
+ * @return Kernel symbol table or NULL if it is not available.
+ */
+static const profile_symbol_t *ksymtab_get(void)
+{
+	if ((ksymtab == NULL) && (!ksymtab_failed)) {
+		sysarg_t faddr;
+		sysarg_t pages;
+		sysarg_t count;
+		if ((sysinfo_get_value("kernel.symtab.faddr", &faddr) != EOK) ||
+		    (sysinfo_get_value("kernel.symtab.pages", &pages) != EOK) ||
+		    (sysinfo_get_value("kernel.symtab.count", &count) != EOK)) {
+			ksymtab_failed = true;
+			return NULL;
+		}
+
+		void *addr = AS_AREA_ANY;
+		errno_t rc = physmem_map(faddr, pages,
+		    AS_AREA_READ | AS_AREA_CACHEABLE, &addr);
+		if (rc != EOK) {
+			ksymtab_failed = true;
+			return NULL;
+		}
+
+		ksymtab_count = count;
+		ksymtab = addr;
+	}
+
+	return ksymtab;
+}
+
+/** Resolve a kernel address to a symbol.
+ *
+ * The symbol is looked up in the mapped kernel symbol table,
+ * the kernel is asked only if the table is not available.
+ *
+ * @param addr   Kernel address.
+ * @param name   Buffer for the symbol name.
+ * @param size   Size of @a name.
+ * @param offset Place to store the offset of @a addr in the symbol.
+ *
+ * @return EOK on success, ENOENT if no symbol contains @a addr.
+ */
+errno_t profile_symbol(uintptr_t addr, char *name, size_t size,
+    uintptr_t *offset)
+{
+	const profile_symbol_t *symtab = ksymtab_get();
+	if (symtab == NULL) {
+		return (errno_t) __SYSCALL4(SYS_PROFILE_SYMBOL, (sysarg_t) addr,
+		    (sysarg_t) name, (sysarg_t) size, (sysarg_t) offset);
+	}
+
+	if (size == 0)
+		return EINVAL;
+
+	size_t lo = 0;
+	size_t hi = ksymtab_count;
+
+	/* Find the first symbol above addr */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (addr < uint64_t_le2host(symtab[mid].address_le))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	if (lo == 0)
+		return ENOENT;
+
+	const profile_symbol_t *sym = &symtab[lo - 1];
+	str_ncpy(name, size, sym->name, PROFILE_SYMBOL_NAME);
+	*offset = addr - uint64_t_le2host(sym->address_le);
+	return EOK;
+}
+
+/** @}
+ */
@@ -32,12 +32,27 @@
 
 /**
  * @file
- * @brief Quicksort.
+ * @brief Introsort.
+ *
+ * Quicksort with median-of-three pivot selection which finishes short
+ * ranges with insertion sort and falls back to heapsort when recursion
+ * gets too deep, so that the worst case stays O(n log n).
  */
 
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <qsort.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Ranges up to this many elements are sorted using insertion sort */
+#define QSORT_INSERT_MAX  16
+
+/** qsort_parallel() hands off ranges of at least this many elements */
+#define QSORT_PARALLEL_MIN  65536
 
 /** Quicksort spec */
 typedef struct {
@@ -46,6 +61,8 @@ typedef struct {
 	size_t size;
 	int (*compar)(const void *, const void *, void *);
 	void *arg;
+	/** Elements can be swapped a word at a time */
+	bool word_swap;
 } qs_spec_t;
 
 /** Comparison function wrapper.
@@ -100,6 +117,20 @@ static void elem_swap(qs_spec_t *qs, size_t i, size_t j)
 	a = qs->base + i * qs->size;
 	b = qs->base + j * qs->size;
 
+	if (qs->word_swap) {
+		unsigned long *wa = (unsigned long *) a;
+		unsigned long *wb = (unsigned long *) b;
+		unsigned long wt;
+
+		for (k = 0; k < qs->size / sizeof(unsigned long); k++) {
+			wt = wa[k];
+			wa[k] = wb[k];
+			wb[k] = wt;
+		}
+
+		return;
+	}
+
 	for (k = 0; k < qs->size; k++) {
 		t = a[k];
 		a[k] = b[k];
@@ -144,21 +175,159 @@ static size_t partition(qs_spec_t *qs, size_t lo, size_t hi)
 	}
 }
 
+/** Sort a short range of indices using insertion sort.
+ *
+ * @param qs Quicksort spec
+ * @param lo Lower bound (inclusive)
+ * @param hi Upper bound (inclusive)
+ */
+static void insertion_sort(qs_spec_t *qs, size_t lo, size_t hi)
+{
+	size_t i, j;
+
+	for (i = lo + 1; i <= hi; i++) {
+		for (j = i; j > lo && elem_lt(qs, j, j - 1); j--)
+			elem_swap(qs, j, j - 1);
+	}
+}
+
+/** Restore heap property below a node.
+ *
+ * @param qs Quicksort spec
+ * @param lo Index of the heap root
+ * @param node Node index relative to @a lo
+ * @param n Number of elements in the heap
+ */
+static void sift_down(qs_spec_t *qs, size_t lo, size_t node, size_t n)
+{
+	size_t child;
+
+	while ((child = 2 * node + 1) < n) {
+		if (child + 1 < n && elem_lt(qs, lo + child, lo + child + 1))
+			++child;
+
+		if (!elem_lt(qs, lo + node, lo + child))
+			return;
+
+		elem_swap(qs, lo + node, lo + child);
+		node = child;
+	}
+}
+
+/** Sort a range of indices using heapsort.
+ *
+ * @param qs Quicksort spec
+ * @param lo Lower bound (inclusive)
+ * @param hi Upper bound (inclusive)
+ */
+static void heap_sort(qs_spec_t *qs, size_t lo, size_t hi)
+{
+	size_t n = hi - lo + 1;
+	size_t i;
+
+	for (i = n / 2; i > 0; i--)
+		sift_down(qs, lo, i - 1, n);
+
+	for (i = n - 1; i > 0; i--) {
+		elem_swap(qs, lo, lo + i);
+		sift_down(qs, lo, 0, i);
+	}
+}
+
+/** Order the first, middle and last element of a range.
+ *
+ * Afterwards the middle element is the median of the three and can be used
+ * as the pivot.
+ *
+ * @param qs Quicksort spec
+ * @param lo Lower bound (inclusive)
+ * @param hi Upper bound (inclusive)
+ */
+static void median_of_three(qs_spec_t *qs, size_t lo, size_t hi)
+{
+	size_t mid = lo + (hi - lo) / 2;
+
+	if (elem_lt(qs, mid, lo))
+		elem_swap(qs, mid, lo);
+	if (elem_lt(qs, hi, mid)) {
+		elem_swap(qs, hi, mid);
+		if (elem_lt(qs, mid, lo))
+			elem_swap(qs, mid, lo);
+	}
+}
+
+/** Compute recursion depth limit for a number of elements.
+ *
+ * @param nmemb Number of elements
+ * @return Twice the binary logarithm of @a nmemb
+ */
+static unsigned depth_limit(size_t nmemb)
+{
+	unsigned depth = 0;
+
+	while (nmemb > 1) {
+		nmemb >>= 1;
+		depth += 2;
+	}
+
+	return depth;
+}
+
 /** Sort a range of indices.
+ *
+ * Recurses into the smaller part only, so the stack depth is logarithmic
+ * even when the depth limit is not hit.
  *
  * @param qs Quicksort spec
  * @param lo Lower bound (inclusive)
  * @param hi Upper bound (inclusive)
+ * @param depth Number of partitioning steps left before heapsort is used
  */
-static void quicksort(qs_spec_t *qs, size_t lo, size_t hi)
+static void introsort(qs_spec_t *qs, size_t lo, size_t hi, unsigned depth)
 {
 	size_t p;
 
-	if (lo < hi) {
+	while (hi - lo >= QSORT_INSERT_MAX) {
+		if (depth == 0) {
+			heap_sort(qs, lo, hi);
+			return;
+		}
+
+		--depth;
+		median_of_three(qs, lo, hi);
 		p = partition(qs, lo, hi);
-		quicksort(qs, lo, p);
-		quicksort(qs, p + 1, hi);
+
+		if (p - lo < hi - p) {
+			introsort(qs, lo, p, depth);
+			lo = p + 1;
+		} else {
+			introsort(qs, p + 1, hi, depth);
+			hi = p;
+		}
 	}
+
+	insertion_sort(qs, lo, hi);
+}
+
+/** Fill in a quicksort spec.
+ *
+ * @param qs Quicksort spec
+ * @param base Array to sort
+ * @param nmemb Number of array members
+ * @param size Size of member in bytes
+ * @param compar Comparison function
+ * @param arg Argument to comparison function
+ */
+static void qs_spec_init(qs_spec_t *qs, void *base, size_t nmemb, size_t size,
+    int (*compar)(const void *, const void *, void *), void *arg)
+{
+	qs->base = base;
+	qs->nmemb = nmemb;
+	qs->size = size;
+	qs->compar = compar;
+	qs->arg = arg;
+	qs->word_swap = (size % sizeof(unsigned long)) == 0 &&
+	    ((uintptr_t) base % sizeof(unsigned long)) == 0;
 }
 
 /** Quicksort.
@@ -176,13 +345,8 @@ void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *,
 	if (nmemb == 0)
 		return;
 
-	qs.base = base;
-	qs.nmemb = nmemb;
-	qs.size = size;
-	qs.compar = compar_wrap;
-	qs.arg = compar;
-
-	quicksort(&qs, 0, nmemb - 1);
+	qs_spec_init(&qs, base, nmemb, size, compar_wrap, compar);
+	introsort(&qs, 0, nmemb - 1, depth_limit(nmemb));
 }
 
 /** Quicksort with extra argument to comparison function.
@@ -201,13 +365,138 @@ void qsort_r(void *base, size_t nmemb, size_t size, int (*compar)(const void *,
 	if (nmemb == 0)
 		return;
 
-	qs.base = base;
-	qs.nmemb = nmemb;
-	qs.size = size;
-	qs.compar = compar;
-	qs.arg = arg;
+	qs_spec_init(&qs, base, nmemb, size, compar, arg);
+	introsort(&qs, 0, nmemb - 1, depth_limit(nmemb));
+}
+
+/** Shared state of a parallel sort */
+typedef struct {
+	qs_spec_t qs;
+	fibril_mutex_t lock;
+	fibril_condvar_t done_cv;
+	/** Number of ranges still being sorted by helper fibrils */
+	size_t active;
+} qs_par_t;
+
+/** Range handed off to a helper fibril */
+typedef struct {
+	qs_par_t *par;
+	size_t lo;
+	size_t hi;
+	unsigned depth;
+} qs_task_t;
+
+static errno_t qsort_par_fibril(void *);
+
+/** Sort a range, handing off large parts to other fibrils.
+ *
+ * @param par Parallel sort state
+ * @param lo Lower bound (inclusive)
+ * @param hi Upper bound (inclusive)
+ * @param depth Number of partitioning steps left before heapsort is used
+ */
+static void qsort_par_range(qs_par_t *par, size_t lo, size_t hi,
+    unsigned depth)
+{
+	qs_task_t *task;
+	size_t p;
+	fid_t fid;
+
+	while (hi - lo >= QSORT_PARALLEL_MIN && depth > 0) {
+		--depth;
+		median_of_three(&par->qs, lo, hi);
+		p = partition(&par->qs, lo, hi);
+
+		/* Keep the larger part, try handing off the smaller one */
+		task = malloc(sizeof(qs_task_t));
+		if (task == NULL)
+			break;
+
+		task->par = par;
+		task->depth = depth;
+		if (p - lo < hi - p) {
+			task->lo = lo;
+			task->hi = p;
+			lo = p + 1;
+		} else {
+			task->lo = p + 1;
+			task->hi = hi;
+			hi = p;
+		}
+
+		fid = fibril_create(qsort_par_fibril, task);
+		if (fid == 0) {
+			introsort(&par->qs, task->lo, task->hi, task->depth);
+			free(task);
+			continue;
+		}
+
+		fibril_mutex_lock(&par->lock);
+		par->active++;
+		fibril_mutex_unlock(&par->lock);
+
+		fibril_add_ready(fid);
+	}
+
+	introsort(&par->qs, lo, hi, depth);
+}
+
+/** Helper fibril of a parallel sort.
+ *
+ * @param arg Range to sort (qs_task_t *)
+ * @return EOK
+ */
+static errno_t qsort_par_fibril(void *arg)
+{
+	qs_task_t *task = (qs_task_t *) arg;
+	qs_par_t *par = task->par;
+
+	qsort_par_range(par, task->lo, task->hi, task->depth);
+	free(task);
+
+	fibril_mutex_lock(&par->lock);
+	if (--par->active == 0)
+		fibril_condvar_broadcast(&par->done_cv);
+	fibril_mutex_unlock(&par->lock);
+
+	return EOK;
+}
+
+/** Parallel quicksort.
+ *
+ * Sorts like qsort_r(), but once the array has more than a few ten
+ * thousand elements, parts of it are sorted by separate fibrils. These
+ * only run in parallel if the task has more than one fibril runner
+ * thread (see fibril_enable_multithreaded()). The comparison function
+ * must be safe to call from several threads at once.
+ *
+ * @param base Array to sort
+ * @param nmemb Number of array members
+ * @param size Size of member in bytes
+ * @param compar Comparison function
+ * @param arg Argument to comparison function
+ */
+void qsort_parallel(void *base, size_t nmemb, size_t size,
+    int (*compar)(const void *, const void *, void *), void *arg)
+{
+	qs_par_t par;
+
+	if (nmemb < QSORT_PARALLEL_MIN) {
+		qsort_r(base, nmemb, size, compar, arg);
+		return;
+	}
+
+	qs_spec_init(&par.qs, base, nmemb, size, compar, arg);
+	fibril_mutex_initialize(&par.lock);
+	fibril_condvar_initialize(&par.done_cv);
+	par.active = 0;
+
+	qsort_par_range(&par, 0, nmemb - 1, depth_limit(nmemb));
 
-	quicksort(&qs, 0, nmemb - 1);
+	fibril_mutex_lock(&par.lock);
+	while (par.active > 0)
+		fibril_condvar_wait(&par.done_cv, &par.lock);
+	fibril_mutex_unlock(&par.lock);
 }
 
 /** @}
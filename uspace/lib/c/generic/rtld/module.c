@@ -50,6 +50,7 @@
 #include <rtld/dynamic.h>
 #include <rtld/rtld_arch.h>
 #include <rtld/module.h>
+#include <rtld/symbol.h>
 #include <libarch/rtld/module.h>
 
 #include "../private/libc.h"
@@ -94,15 +95,35 @@ errno_t module_create_static_exec(rtld_t *rtld, module_t **rmodule)
 	}
 
 	list_append(&module->modules_link, &rtld->modules);
+	symbol_cache_flush(rtld);
 
 	if (rmodule != NULL)
 		*rmodule = module;
 	return EOK;
 }
 
-/** (Eagerly) process all relocation tables in a module.
+/** Determine whether PLT entries of a module may be bound lazily.
  *
- * Currently works as if LD_BIND_NOW was specified.
+ * Lazy binding requires the resolver trampoline to be present and
+ * is disabled if either the program or the module has been linked
+ * with -z now. The module containing the trampoline must itself be
+ * bound eagerly, since the resolver calls through its PLT.
+ */
+static bool module_plt_lazy(module_t *m)
+{
+	rtld_t *rtld = m->rtld;
+
+	if (rtld->plt_trampoline == 0 || rtld->bind_now || m->dyn.bind_now)
+		return false;
+
+	return m != rtld->plt_trampoline_mod;
+}
+
+/** Process all relocation tables in a module.
+ *
+ * PLT relocations are left to be resolved on first call if the
+ * architecture supports it and the module does not ask for eager
+ * binding, everything else is processed right away.
  */
 void module_process_relocs(module_t *m)
 {
@@ -115,7 +136,10 @@ void module_process_relocs(module_t *m)
 	module_process_pre_arch(m);
 
 	/* jmp_rel table */
-	if (m->dyn.jmp_rel != NULL) {
+	if (m->dyn.jmp_rel != NULL && module_plt_lazy(m) &&
+	    plt_lazy_setup_arch(m)) {
+		DPRINTF("jmp_rel table bound lazily\n");
+	} else if (m->dyn.jmp_rel != NULL) {
 		DPRINTF("jmp_rel table\n");
 		if (m->dyn.plt_rel == DT_REL) {
 			DPRINTF("jmp_rel table type DT_REL\n");
@@ -234,6 +258,7 @@ module_t *module_load(rtld_t *rtld, const char *name, mlflags_t flags)
 
 	/* Insert into the list of loaded modules */
 	list_append(&m->modules_link, &rtld->modules);
+	symbol_cache_flush(rtld);
 
 	/* Copy TLS info */
 	m->tdata = info.tls.tdata;
@@ -37,7 +37,9 @@
 #include <errno.h>
 #include <rtld/module.h>
 #include <rtld/rtld.h>
+#include <rtld/rtld_arch.h>
 #include <rtld/rtld_debug.h>
+#include <rtld/symbol.h>
 #include <stdlib.h>
 #include <str.h>
 
@@ -54,6 +56,7 @@ errno_t rtld_init_static(void)
 	list_initialize(&runtime_env->imodules);
 	runtime_env->program = NULL;
 	runtime_env->next_id = 1;
+	atomic_flag_clear(&runtime_env->symcache_lock);
 
 	rc = module_create_static_exec(runtime_env, NULL);
 	if (rc != EOK)
@@ -73,6 +76,8 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 {
 	rtld_t *env;
 	module_t *prog;
+	module_t *tmod;
+	elf_symbol_t *sym;
 
 	DPRINTF("Load dynamically linked program.\n");
 
@@ -82,6 +87,7 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 		return ENOMEM;
 
 	env->next_id = 1;
+	atomic_flag_clear(&env->symcache_lock);
 
 	prog = calloc(1, sizeof(module_t));
 	if (prog == NULL) {
@@ -115,6 +121,7 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 	list_initialize(&env->modules);
 	list_initialize(&env->imodules);
 	list_append(&prog->modules_link, &env->modules);
+	symbol_cache_flush(env);
 
 	/* Pointer to program module. Used as root of the module graph. */
 	env->program = prog;
@@ -132,6 +139,18 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 	/* Compute static TLS size */
 	modules_process_tls(env);
 
+	/*
+	 * Locate the lazy PLT resolver. It must be the instance in the
+	 * program's libc (not ours), since it runs in the program context.
+	 */
+	env->bind_now = prog->dyn.bind_now;
+	sym = symbol_def_find(RTLD_PLT_TRAMPOLINE, prog, ssf_none, &tmod);
+	if (sym != NULL) {
+		env->plt_trampoline = (uintptr_t) symbol_get_addr(sym, tmod,
+		    NULL);
+		env->plt_trampoline_mod = tmod;
+	}
+
 	/*
 	 * Now relocate/link all modules together.
 	 */
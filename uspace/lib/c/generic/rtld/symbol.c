@@ -34,6 +34,8 @@
  * @file
  */
 
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -44,6 +46,21 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/symbol.h>
 
+/** Symbol being looked up.
+ *
+ * Hashes are computed at most once per lookup, no matter how many
+ * modules get searched.
+ */
+typedef struct {
+	/** Symbol name */
+	const char *name;
+	/** GNU hash of @c name */
+	elf_word gnu_hash;
+	/** SysV hash of @c name, valid if @c have_hash is @c true */
+	elf_word hash;
+	bool have_hash;
+} symbol_lookup_t;
+
 /*
  * Hash tables are 32-bit (elf_word) even for 64-bit ELF files.
  */
@@ -62,38 +79,128 @@ static elf_word elf_hash(const unsigned char *name)
 	return h;
 }
 
-static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
+/** Compute GNU-style (DT_GNU_HASH) hash of a symbol name. */
+static elf_word elf_gnu_hash(const unsigned char *name)
+{
+	elf_word h = 5381;
+
+	while (*name)
+		h = (h << 5) + h + *name++;
+
+	return h;
+}
+
+static void symbol_lookup_init(symbol_lookup_t *lk, const char *name)
+{
+	lk->name = name;
+	lk->gnu_hash = elf_gnu_hash((const unsigned char *) name);
+	lk->have_hash = false;
+}
+
+/** Look up symbol using the module's SysV hash table. */
+static elf_symbol_t *def_find_sysv(symbol_lookup_t *lk, module_t *m)
 {
 	elf_symbol_t *sym_table;
-	elf_symbol_t *s, *sym;
+	elf_symbol_t *s;
 	elf_word nbucket;
 	/* elf_word nchain; */
 	elf_word i;
 	char *s_name;
 	elf_word bucket;
 
-	DPRINTF("def_find_in_module('%s', %s)\n", name, m->dyn.soname);
+	if (!lk->have_hash) {
+		lk->hash = elf_hash((const unsigned char *) lk->name);
+		lk->have_hash = true;
+	}
 
 	sym_table = m->dyn.sym_tab;
 	nbucket = m->dyn.hash[0];
 	/* nchain = m->dyn.hash[1]; XXX Use to check HT range */
 
-	bucket = elf_hash((unsigned char *)name) % nbucket;
+	bucket = lk->hash % nbucket;
 	i = m->dyn.hash[2 + bucket];
 
-	sym = NULL;
 	while (i != STN_UNDEF) {
 		s = &sym_table[i];
 		s_name = m->dyn.str_tab + s->st_name;
 
-		if (str_cmp(name, s_name) == 0) {
-			sym = s;
-			break;
-		}
+		if (str_cmp(lk->name, s_name) == 0)
+			return s;
 
 		i = m->dyn.hash[2 + nbucket + i];
 	}
 
+	return NULL;
+}
+
+/** Look up symbol using the module's GNU hash table.
+ *
+ * The table starts with a header of four words (number of buckets,
+ * index of the first hashed symbol, number of Bloom filter words and
+ * the Bloom filter shift), followed by the Bloom filter (made of
+ * native-sized words), the buckets and the hash value chains.
+ * The Bloom filter lets us reject most symbols not defined in the
+ * module without touching the buckets or the symbol table at all.
+ */
+static elf_symbol_t *def_find_gnu(symbol_lookup_t *lk, module_t *m)
+{
+	const elf_word *ht = m->dyn.gnu_hash;
+	elf_word nbuckets = ht[0];
+	elf_word symoffset = ht[1];
+	elf_word bloom_size = ht[2];
+	elf_word bloom_shift = ht[3];
+	const uintptr_t *bloom = (const uintptr_t *) &ht[4];
+	const elf_word *buckets = (const elf_word *) &bloom[bloom_size];
+	const elf_word *chain = &buckets[nbuckets];
+	const unsigned wbits = sizeof(uintptr_t) * 8;
+	elf_symbol_t *sym_table;
+	elf_word h = lk->gnu_hash;
+	uintptr_t word, mask;
+	elf_word i, ch;
+
+	if (nbuckets == 0 || bloom_size == 0)
+		return NULL;
+
+	word = bloom[(h / wbits) % bloom_size];
+	mask = ((uintptr_t) 1 << (h % wbits)) |
+	    ((uintptr_t) 1 << ((h >> bloom_shift) % wbits));
+	if ((word & mask) != mask)
+		return NULL;
+
+	i = buckets[h % nbuckets];
+	if (i < symoffset)
+		return NULL;
+
+	sym_table = m->dyn.sym_tab;
+
+	while (true) {
+		ch = chain[i - symoffset];
+		if ((h | 1) == (ch | 1) && str_cmp(lk->name,
+		    m->dyn.str_tab + sym_table[i].st_name) == 0)
+			return &sym_table[i];
+
+		/* Lowest bit marks the end of the chain */
+		if ((ch & 1) != 0)
+			break;
+		++i;
+	}
+
+	return NULL;
+}
+
+static elf_symbol_t *def_find_in_module(symbol_lookup_t *lk, module_t *m)
+{
+	elf_symbol_t *sym;
+
+	DPRINTF("def_find_in_module('%s', %s)\n", lk->name, m->dyn.soname);
+
+	if (m->dyn.gnu_hash != NULL)
+		sym = def_find_gnu(lk, m);
+	else if (m->dyn.hash != NULL)
+		sym = def_find_sysv(lk, m);
+	else
+		sym = NULL;
+
 	if (!sym)
 		return NULL;	/* Not found */
 
@@ -105,6 +212,85 @@ static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
 	return sym; /* Found */
 }
 
+/** Lock the resolved symbol cache.
+ *
+ * Lazy PLT resolution may run in several threads at once, possibly
+ * before the fibril run-time is initialized, so a plain spinlock is
+ * used. Critical sections are only a few instructions long.
+ */
+static void symcache_lock(rtld_t *rtld)
+{
+	while (atomic_flag_test_and_set_explicit(&rtld->symcache_lock,
+	    memory_order_acquire))
+		;
+}
+
+static void symcache_unlock(rtld_t *rtld)
+{
+	atomic_flag_clear_explicit(&rtld->symcache_lock, memory_order_release);
+}
+
+/** Look up symbol in the resolved symbol cache.
+ *
+ * @param rtld	Runtime environment
+ * @param lk	Symbol lookup
+ * @param flags	Search flags
+ * @param mod	Place to store module containing the definition
+ * @return Symbol definition or @c NULL if not cached
+ */
+static elf_symbol_t *symcache_find(rtld_t *rtld, symbol_lookup_t *lk,
+    symbol_search_flags_t flags, module_t **mod)
+{
+	rtld_symcache_entry_t *e;
+	elf_symbol_t *sym = NULL;
+
+	e = &rtld->symcache[lk->gnu_hash & (RTLD_SYMCACHE_SIZE - 1)];
+
+	symcache_lock(rtld);
+	if (e->sym != NULL && e->hash == lk->gnu_hash &&
+	    e->flags == (unsigned) flags && str_cmp(e->name, lk->name) == 0) {
+		*mod = e->mod;
+		sym = e->sym;
+	}
+	symcache_unlock(rtld);
+
+	return sym;
+}
+
+/** Insert symbol into the resolved symbol cache (replacing any entry). */
+static void symcache_insert(rtld_t *rtld, symbol_lookup_t *lk,
+    symbol_search_flags_t flags, elf_symbol_t *sym, module_t *mod)
+{
+	rtld_symcache_entry_t *e;
+
+	e = &rtld->symcache[lk->gnu_hash & (RTLD_SYMCACHE_SIZE - 1)];
+
+	symcache_lock(rtld);
+	e->name = mod->dyn.str_tab + sym->st_name;
+	e->hash = lk->gnu_hash;
+	e->flags = flags;
+	e->mod = mod;
+	e->sym = sym;
+	symcache_unlock(rtld);
+}
+
+/** Flush the resolved symbol cache.
+ *
+ * Must be called whenever the set of modules in the global scope
+ * changes.
+ *
+ * @param rtld Runtime environment
+ */
+void symbol_cache_flush(rtld_t *rtld)
+{
+	size_t i;
+
+	symcache_lock(rtld);
+	for (i = 0; i < RTLD_SYMCACHE_SIZE; i++)
+		rtld->symcache[i].sym = NULL;
+	symcache_unlock(rtld);
+}
+
 /** Find the definition of a symbol in a module and its deps.
  *
  * Search the module dependency graph is breadth-first, beginning
@@ -121,9 +307,12 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 {
 	module_t *m, *dm;
 	elf_symbol_t *sym, *s;
+	symbol_lookup_t lk;
 	list_t queue;
 	size_t i;
 
+	symbol_lookup_init(&lk, name);
+
 	/*
 	 * Do a BFS using the queue_link and bfs_tag fields.
 	 * Vertices (modules) are tagged the moment they are inserted
@@ -149,7 +338,7 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 		list_remove(&m->queue_link);
 
 		/* If ssf_noroot is specified, do not look in start module */
-		s = def_find_in_module(name, m);
+		s = def_find_in_module(&lk, m);
 		if (s != NULL) {
 			/* Symbol found */
 			sym = s;
@@ -199,6 +388,9 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
     symbol_search_flags_t flags, module_t **mod)
 {
 	elf_symbol_t *s;
+	symbol_lookup_t lk;
+
+	symbol_lookup_init(&lk, name);
 
 	DPRINTF("symbol_def_find('%s', origin='%s'\n",
 	    name, origin->dyn.soname);
@@ -208,7 +400,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 		 * Origin module has a DT_SYMBOLIC flag.
 		 * Try this module first
 		 */
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&lk, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -218,13 +410,18 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 
 	/* Not DT_SYMBOLIC or no match. Now try other locations. */
 
+	s = symcache_find(origin->rtld, &lk, flags, mod);
+	if (s != NULL)
+		return s;
+
 	list_foreach(origin->rtld->modules, modules_link, module_t, m) {
 		DPRINTF("module '%s' local?\n", m->dyn.soname);
 		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
 			DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
-			s = def_find_in_module(name, m);
+			s = def_find_in_module(&lk, m);
 			if (s != NULL) {
 				/* Found */
+				symcache_insert(origin->rtld, &lk, flags, s, m);
 				*mod = m;
 				return s;
 			}
@@ -237,7 +434,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 	    origin->dyn.soname);
 
 	if (!origin->exec || (flags & ssf_noexec) == 0) {
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&lk, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
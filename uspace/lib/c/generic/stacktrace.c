@@ -108,6 +108,46 @@ void stacktrace_print(void)
 	printf("-- end of stack trace --\n");
 }
 
+/** Record the return addresses of the current call chain.
+ *
+ * @param trace Buffer for the return addresses, innermost first.
+ * @param depth Number of entries in the buffer.
+ * @param skip  Number of innermost return addresses to leave out. The first
+ *              one returns into the caller of this function.
+ *
+ * @return Number of return addresses recorded.
+ */
+size_t stacktrace_capture(uintptr_t *trace, size_t depth, size_t skip)
+{
+	stacktrace_t st;
+	uintptr_t fp, nfp, ra;
+	size_t cnt = 0;
+	int frames = 0;
+
+	st.op_arg = NULL;
+	st.ops = &basic_ops;
+
+	stacktrace_prepare();
+	fp = stacktrace_fp_get();
+
+	while (cnt < depth && frames++ < STACK_FRAMES_MAX &&
+	    stacktrace_fp_valid(&st, fp)) {
+		if (stacktrace_ra_get(&st, fp, &ra) != EOK)
+			break;
+
+		if (skip > 0)
+			skip--;
+		else
+			trace[cnt++] = ra;
+
+		if (stacktrace_fp_prev(&st, fp, &nfp) != EOK)
+			break;
+		fp = nfp;
+	}
+
+	return cnt;
+}
+
 static errno_t stacktrace_read_uintptr(void *arg, uintptr_t addr, uintptr_t *data)
 {
 	(void) arg;
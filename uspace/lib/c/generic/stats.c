@@ -35,13 +35,26 @@
 
 #include <stats.h>
 #include <sysinfo.h>
+#include <as.h>
+#include <barrier.h>
+#include <ddi.h>
 #include <errno.h>
+#include <mem.h>
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
 
 #define SYSINFO_STATS_MAX_PATH  64
 
+/** Number of attempts to read a consistent copy of the statistics page */
+#define STATS_PAGE_RETRIES  16
+
+/** Statistics page mapped from the kernel */
+static stats_page_t *stats_page;
+
+/** Mapping the statistics page failed */
+static bool stats_page_failed = false;
+
 /** Thread states
  *
  */
@@ -55,6 +68,71 @@ static const char *thread_states[] = {
 	"Lingering"
 };
 
+/** Map the statistics page
+ *
+ * The page is mapped read-only on the first use.
+ *
+ * @return Statistics page or NULL if it is not available.
+ *
+ */
+static stats_page_t *stats_page_get(void)
+{
+	if ((stats_page == NULL) && (!stats_page_failed)) {
+		sysarg_t faddr;
+		sysarg_t pages;
+		if ((sysinfo_get_value("stats.faddr", &faddr) != EOK) ||
+		    (sysinfo_get_value("stats.pages", &pages) != EOK)) {
+			stats_page_failed = true;
+			return NULL;
+		}
+
+		void *addr = AS_AREA_ANY;
+		errno_t rc = physmem_map(faddr, pages,
+		    AS_AREA_READ | AS_AREA_CACHEABLE, &addr);
+		if (rc != EOK) {
+			stats_page_failed = true;
+			return NULL;
+		}
+
+		stats_page = addr;
+	}
+
+	return stats_page;
+}
+
+/** Copy data from the statistics page
+ *
+ * @param dst  Destination buffer.
+ * @param src  Data in the statistics page.
+ * @param size Size of the data.
+ *
+ * @return True if a consistent copy was made, false if the
+ *         page has not been filled yet or kept changing.
+ *
+ */
+static bool stats_page_read(void *dst, const void *src, size_t size)
+{
+	for (unsigned int i = 0; i < STATS_PAGE_RETRIES; i++) {
+		uint64_t seq = stats_page->seq;
+
+		/* Zero means the kernel has not filled the page yet */
+		if (seq == 0)
+			return false;
+
+		if ((seq & 1) != 0)
+			continue;
+
+		read_barrier();
+		memcpy(dst, src, size);
+		read_barrier();
+
+		if (stats_page->seq == seq)
+			return true;
+	}
+
+	return false;
+}
+
 /** Get CPUs statistics
  *
  * @param count Number of records returned.
@@ -66,6 +144,20 @@ static const char *thread_states[] = {
  */
 stats_cpu_t *stats_get_cpus(size_t *count)
 {
+	stats_page_t *page = stats_page_get();
+	if (page != NULL) {
+		size_t cpu_count = page->cpu_count;
+		stats_cpu_t *stats_cpus =
+		    calloc(cpu_count, sizeof(stats_cpu_t));
+		if ((stats_cpus != NULL) && (stats_page_read(stats_cpus,
+		    page->cpus, cpu_count * sizeof(stats_cpu_t)))) {
+			*count = cpu_count;
+			return stats_cpus;
+		}
+
+		free(stats_cpus);
+	}
+
 	size_t size = 0;
 	stats_cpu_t *stats_cpus =
 	    (stats_cpu_t *) sysinfo_get_data("system.cpus", &size);
@@ -91,6 +183,17 @@ stats_cpu_t *stats_get_cpus(size_t *count)
  */
 stats_physmem_t *stats_get_physmem(void)
 {
+	stats_page_t *page = stats_page_get();
+	if (page != NULL) {
+		stats_physmem_t *stats_physmem =
+		    malloc(sizeof(stats_physmem_t));
+		if ((stats_physmem != NULL) && (stats_page_read(stats_physmem,
+		    &page->physmem, sizeof(stats_physmem_t))))
+			return stats_physmem;
+
+		free(stats_physmem);
+	}
+
 	size_t size = 0;
 	stats_physmem_t *stats_physmem =
 	    (stats_physmem_t *) sysinfo_get_data("system.physmem", &size);
@@ -104,6 +207,28 @@ stats_physmem_t *stats_get_physmem(void)
 	return stats_physmem;
 }
 
+/** Get TLB shootdown statistics.
+ *
+ * @return Pointer to the stats_tlb_t structure.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_tlb_t *stats_get_tlb(void)
+{
+	size_t size = 0;
+	stats_tlb_t *stats_tlb =
+	    (stats_tlb_t *) sysinfo_get_data("system.tlb", &size);
+
+	if (size != sizeof(stats_tlb_t)) {
+		if (stats_tlb != NULL)
+			free(stats_tlb);
+		return NULL;
+	}
+
+	return stats_tlb;
+}
+
 /** Get task statistics
  *
  * @param count Number of records returned.
@@ -130,6 +255,164 @@ stats_task_t *stats_get_tasks(size_t *count)
 	return stats_tasks;
 }
 
+/** Apply incremental statistics to the previous ones
+ *
+ * Both the IDs and the changed entries come in the order in which
+ * the kernel walks its structures. The order of the entries which
+ * remain alive does not change between queries, so the entries
+ * which did not change are found in @a prev by a single pass.
+ *
+ * @param delta      Incremental statistics returned by the kernel.
+ * @param size       Size of @a delta (bytes).
+ * @param prev       Previous statistics array (can be NULL).
+ * @param prev_count Number of entries in @a prev.
+ * @param entry_size Size of a single entry (bytes).
+ * @param id_offset  Offset of the 64-bit ID in an entry.
+ * @param count      Number of entries returned.
+ *
+ * @return New statistics array or NULL if @a delta was truncated
+ *         or does not apply to @a prev.
+ *
+ */
+static void *stats_delta_apply(const stats_delta_t *delta, size_t size,
+    const void *prev, size_t prev_count, size_t entry_size,
+    size_t id_offset, size_t *count)
+{
+	if (size < sizeof(stats_delta_t))
+		return NULL;
+
+	size_t total = delta->count;
+	size_t changed = delta->changed;
+	if ((total == 0) || (changed > total) ||
+	    (size != sizeof(stats_delta_t) + total * sizeof(uint64_t) +
+	    changed * entry_size))
+		return NULL;
+
+	const uint64_t *ids = (const uint64_t *) (delta + 1);
+	const uint8_t *changes = (const uint8_t *) (ids + total);
+	const uint8_t *prev_entries = (const uint8_t *) prev;
+
+	uint8_t *entries = malloc(total * entry_size);
+	if (entries == NULL)
+		return NULL;
+
+	size_t c = 0;
+	size_t p = 0;
+
+	for (size_t i = 0; i < total; i++) {
+		const uint8_t *src = NULL;
+		uint64_t id;
+
+		if (c < changed) {
+			memcpy(&id, changes + c * entry_size + id_offset,
+			    sizeof(id));
+			if (id == ids[i]) {
+				src = changes + c * entry_size;
+				c++;
+			}
+		}
+
+		while ((src == NULL) && (p < prev_count)) {
+			memcpy(&id, prev_entries + p * entry_size + id_offset,
+			    sizeof(id));
+			if (id == ids[i])
+				src = prev_entries + p * entry_size;
+			p++;
+		}
+
+		if (src == NULL) {
+			free(entries);
+			return NULL;
+		}
+
+		memcpy(entries + i * entry_size, src, entry_size);
+	}
+
+	if (c != changed) {
+		free(entries);
+		return NULL;
+	}
+
+	*count = total;
+	return entries;
+}
+
+/** Get incremental statistics and apply them to the previous ones
+ *
+ * @param item       Sysinfo item of the incremental statistics.
+ * @param prev       Previous statistics array (can be NULL).
+ * @param prev_count Number of entries in @a prev.
+ * @param entry_size Size of a single entry (bytes).
+ * @param id_offset  Offset of the 64-bit ID in an entry.
+ * @param generation Generation of @a prev (0 if none), updated to the
+ *                   generation of the returned statistics.
+ * @param count      Number of entries returned.
+ *
+ * @return New statistics array or NULL.
+ *
+ */
+static void *stats_get_delta(const char *item, const void *prev,
+    size_t prev_count, size_t entry_size, size_t id_offset,
+    uint64_t *generation, size_t *count)
+{
+	char name[SYSINFO_STATS_MAX_PATH];
+	snprintf(name, SYSINFO_STATS_MAX_PATH, "%s.%" PRIu64, item,
+	    *generation);
+
+	size_t size = 0;
+	stats_delta_t *delta = (stats_delta_t *) sysinfo_get_data(name, &size);
+	if (delta == NULL)
+		return NULL;
+
+	void *entries = stats_delta_apply(delta, size, prev, prev_count,
+	    entry_size, id_offset, count);
+	if (entries != NULL)
+		*generation = delta->generation;
+
+	free(delta);
+	return entries;
+}
+
+/** Get task statistics incrementally
+ *
+ * Only the statistics of the tasks which changed since @a prev
+ * was obtained are transferred from the kernel, the rest is
+ * copied from @a prev.
+ *
+ * @param prev       Previous task statistics (NULL for the first call).
+ * @param prev_count Number of records in @a prev.
+ * @param generation Generation of @a prev (0 for the first call),
+ *                   updated to the generation of the returned records.
+ * @param count      Number of records returned.
+ *
+ * @return Array of stats_task_t structures.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_task_t *stats_get_tasks_delta(const stats_task_t *prev,
+    size_t prev_count, uint64_t *generation, size_t *count)
+{
+	stats_task_t *stats_tasks = stats_get_delta("system.tasks_delta",
+	    prev, prev_count, sizeof(stats_task_t),
+	    offsetof(stats_task_t, task_id), generation, count);
+
+	if ((stats_tasks == NULL) && (*generation != 0)) {
+		/* Start over with a complete set */
+		*generation = 0;
+		stats_tasks = stats_get_delta("system.tasks_delta", NULL, 0,
+		    sizeof(stats_task_t), offsetof(stats_task_t, task_id),
+		    generation, count);
+	}
+
+	if (stats_tasks == NULL) {
+		*generation = 0;
+		stats_tasks = stats_get_tasks(count);
+	}
+
+	return stats_tasks;
+}
+
 /** Get single task statistics
  *
  * @param task_id Task ID we are interested in.
@@ -183,6 +466,44 @@ stats_thread_t *stats_get_threads(size_t *count)
 	return stats_threads;
 }
 
+/** Get thread statistics incrementally
+ *
+ * Same as stats_get_tasks_delta(), but for threads.
+ *
+ * @param prev       Previous thread statistics (NULL for the first call).
+ * @param prev_count Number of records in @a prev.
+ * @param generation Generation of @a prev (0 for the first call),
+ *                   updated to the generation of the returned records.
+ * @param count      Number of records returned.
+ *
+ * @return Array of stats_thread_t structures.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_thread_t *stats_get_threads_delta(const stats_thread_t *prev,
+    size_t prev_count, uint64_t *generation, size_t *count)
+{
+	stats_thread_t *stats_threads = stats_get_delta("system.threads_delta",
+	    prev, prev_count, sizeof(stats_thread_t),
+	    offsetof(stats_thread_t, thread_id), generation, count);
+
+	if ((stats_threads == NULL) && (*generation != 0)) {
+		/* Start over with a complete set */
+		*generation = 0;
+		stats_threads = stats_get_delta("system.threads_delta", NULL,
+		    0, sizeof(stats_thread_t),
+		    offsetof(stats_thread_t, thread_id), generation, count);
+	}
+
+	if (stats_threads == NULL) {
+		*generation = 0;
+		stats_threads = stats_get_threads(count);
+	}
+
+	return stats_threads;
+}
+
 /** Get IPC connections statistics.
  *
  * @param count Number of records returned.
@@ -235,6 +556,61 @@ stats_exc_t *stats_get_exceptions(size_t *count)
 	return stats_exceptions;
 }
 
+/** Get lock contention statistics.
+ *
+ * The statistics are only available if the kernel
+ * was built with lock statistics support.
+ *
+ * @param count Number of records returned.
+ *
+ * @return Array of stats_lock_t structures.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_lock_t *stats_get_locks(size_t *count)
+{
+	size_t size = 0;
+	stats_lock_t *stats_locks =
+	    (stats_lock_t *) sysinfo_get_data("system.locks", &size);
+
+	if ((size % sizeof(stats_lock_t)) != 0) {
+		if (stats_locks != NULL)
+			free(stats_locks);
+		*count = 0;
+		return NULL;
+	}
+
+	*count = size / sizeof(stats_lock_t);
+	return stats_locks;
+}
+
+/** Get slab cache statistics
+ *
+ * @param count Number of records returned.
+ *
+ * @return Array of stats_slab_t structures.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_slab_t *stats_get_slabs(size_t *count)
+{
+	size_t size = 0;
+	stats_slab_t *stats_slabs =
+	    (stats_slab_t *) sysinfo_get_data("system.slabs", &size);
+
+	if ((size % sizeof(stats_slab_t)) != 0) {
+		if (stats_slabs != NULL)
+			free(stats_slabs);
+		*count = 0;
+		return NULL;
+	}
+
+	*count = size / sizeof(stats_slab_t);
+	return stats_slabs;
+}
+
 /** Get single exception statistics
  *
  * @param excn Exception number we are interested in.
@@ -273,6 +649,18 @@ stats_exc_t *stats_get_exception(unsigned int excn)
  */
 load_t *stats_get_load(size_t *count)
 {
+	stats_page_t *page = stats_page_get();
+	if (page != NULL) {
+		load_t *load = calloc(LOAD_STEPS, sizeof(load_t));
+		if ((load != NULL) && (stats_page_read(load, page->load,
+		    LOAD_STEPS * sizeof(load_t)))) {
+			*count = LOAD_STEPS;
+			return load;
+		}
+
+		free(load);
+	}
+
 	size_t size = 0;
 	load_t *load =
 	    (load_t *) sysinfo_get_data("system.load", &size);
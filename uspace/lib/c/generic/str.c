@@ -116,7 +116,9 @@
 #include <stdlib.h>
 
 #include <align.h>
+#include <macros.h>
 #include <mem.h>
+#include <libarch/config.h>
 
 /** Byte mask consisting of lowest @n bits (out of 8) */
 #define LO_MASK_8(n)  ((uint8_t) ((1 << (n)) - 1))
@@ -130,6 +132,136 @@
 /** Number of data bits in a UTF-8 continuation byte */
 #define CONT_BITS  6
 
+/** Number of bytes examined at once by the ASCII fast paths */
+#define STR_CHUNK  16
+
+/*
+ * Chunks are processed using the generic vector extension of the compiler,
+ * which maps them to SSE2 on amd64, NEON on arm64 and plain integer
+ * operations elsewhere.
+ */
+typedef uint8_t str_chunk_t __attribute__((vector_size(STR_CHUNK), may_alias));
+typedef uint8_t str_uchunk_t __attribute__((vector_size(STR_CHUNK), may_alias,
+    aligned(1)));
+
+typedef union {
+	str_chunk_t v;
+	uint64_t w[STR_CHUNK / sizeof(uint64_t)];
+} str_chunk_bits_t;
+
+/** Check whether any byte of a chunk mask is set. */
+static inline bool str_chunk_any(str_chunk_t mask)
+{
+	str_chunk_bits_t bits = { .v = mask };
+	uint64_t any = 0;
+
+	for (size_t i = 0; i < STR_CHUNK / sizeof(uint64_t); i++)
+		any |= bits.w[i];
+
+	return any != 0;
+}
+
+/** Get the number of bytes before a stop byte.
+ *
+ * A stop byte is the NULL-terminator, a byte equal to @a stop and, if
+ * @a ascii is true, any byte which is not plain ASCII. Each byte before
+ * the stop byte is therefore a complete character in the ASCII case.
+ *
+ * The chunks are read aligned, so that the reads never cross a page
+ * boundary beyond the terminator.
+ *
+ * @param str   String to scan.
+ * @param limit Maximum number of bytes to scan.
+ * @param stop  Additional stop byte, zero for none.
+ * @param ascii Stop at non-ASCII bytes too.
+ *
+ * @return Number of bytes before the first stop byte, at most @a limit.
+ *
+ */
+static size_t str_span(const char *str, size_t limit, uint8_t stop,
+    bool ascii)
+{
+	const uint8_t *p = (const uint8_t *) str;
+	uint8_t high = ascii ? 0x80 : 0;
+	size_t n = 0;
+
+	/* Bytewise up to the first aligned chunk. */
+	while ((n < limit) &&
+	    ((((uintptr_t) (p + n)) & (STR_CHUNK - 1)) != 0)) {
+		if ((p[n] == 0) || (p[n] == stop) || ((p[n] & high) != 0))
+			return n;
+		n++;
+	}
+
+	while (limit - n >= STR_CHUNK) {
+		str_chunk_t c = *(const str_chunk_t *) (p + n);
+		str_chunk_t mask = (str_chunk_t) (c == 0) |
+		    (str_chunk_t) (c == stop) | (c & high);
+
+		if (str_chunk_any(mask))
+			break;
+
+		n += STR_CHUNK;
+	}
+
+	/* Locate the stop byte within the last chunk. */
+	size_t end = min(limit, n + STR_CHUNK);
+	while (n < end) {
+		if ((p[n] == 0) || (p[n] == stop) || ((p[n] & high) != 0))
+			return n;
+		n++;
+	}
+
+	return n;
+}
+
+/** Get the number of equal plain ASCII bytes at the start of two strings.
+ *
+ * Unaligned chunks are only read when they do not cross a page boundary.
+ *
+ * @param s1    First string.
+ * @param s2    Second string.
+ * @param limit Maximum number of bytes to compare.
+ *
+ * @return Number of equal non-zero ASCII bytes, at most @a limit.
+ *
+ */
+static size_t str_ascii_common(const char *s1, const char *s2, size_t limit)
+{
+	const uint8_t *p1 = (const uint8_t *) s1;
+	const uint8_t *p2 = (const uint8_t *) s2;
+	size_t n = 0;
+
+	while (n < limit) {
+		if ((limit - n >= STR_CHUNK) &&
+		    ((((uintptr_t) (p1 + n)) & (PAGE_SIZE - 1)) <=
+		    PAGE_SIZE - STR_CHUNK) &&
+		    ((((uintptr_t) (p2 + n)) & (PAGE_SIZE - 1)) <=
+		    PAGE_SIZE - STR_CHUNK)) {
+			str_chunk_t c1 = *(const str_uchunk_t *) (p1 + n);
+			str_chunk_t c2 = *(const str_uchunk_t *) (p2 + n);
+			str_chunk_t mask = (str_chunk_t) (c1 != c2) |
+			    (str_chunk_t) (c1 == 0) | ((c1 | c2) & 0x80);
+
+			if (!str_chunk_any(mask)) {
+				n += STR_CHUNK;
+				continue;
+			}
+		}
+
+		/* Bytewise within the chunk containing the difference. */
+		size_t end = min(limit, n + STR_CHUNK);
+		while (n < end) {
+			if ((p1[n] != p2[n]) || (p1[n] == 0) ||
+			    (((p1[n] | p2[n]) & 0x80) != 0))
+				return n;
+			n++;
+		}
+	}
+
+	return limit;
+}
+
 /** Decode a single character from a string.
  *
  * Decode a single character from a string of size @a size. Decoding starts
@@ -326,12 +458,7 @@ errno_t chr_encode(const char32_t ch, char *str, size_t *offset, size_t size)
  */
 size_t str_size(const char *str)
 {
-	size_t size = 0;
-
-	while (*str++ != 0)
-		size++;
-
-	return size;
+	return str_span(str, SIZE_MAX, 0, false);
 }
 
 /** Get size of wide string.
@@ -368,6 +495,14 @@ size_t str_lsize(const char *str, size_t max_len)
 	size_t offset = 0;
 
 	while (len < max_len) {
+		/* Plain ASCII bytes are characters of their own. */
+		size_t ascii = str_span(str + offset, max_len - len, 0, true);
+		offset += ascii;
+		len += ascii;
+
+		if (len >= max_len)
+			break;
+
 		if (str_decode(str, &offset, STR_NO_LIMIT) == 0)
 			break;
 
@@ -390,12 +525,7 @@ size_t str_lsize(const char *str, size_t max_len)
  */
 size_t str_nsize(const char *str, size_t max_size)
 {
-	size_t size = 0;
-
-	while ((*str++ != 0) && (size < max_size))
-		size++;
-
-	return size;
+	return str_span(str, max_size, 0, false);
 }
 
 /** Get size of wide string with size limit.
@@ -444,8 +574,17 @@ size_t str_length(const char *str)
 	size_t len = 0;
 	size_t offset = 0;
 
-	while (str_decode(str, &offset, STR_NO_LIMIT) != 0)
+	while (true) {
+		/* Plain ASCII bytes are characters of their own. */
+		size_t ascii = str_span(str + offset, SIZE_MAX, 0, true);
+		offset += ascii;
+		len += ascii;
+
+		if (str_decode(str, &offset, STR_NO_LIMIT) == 0)
+			break;
+
 		len++;
+	}
 
 	return len;
 }
@@ -588,6 +727,11 @@ int str_cmp(const char *s1, const char *s2)
 	size_t off2 = 0;
 
 	while (true) {
+		/* Skip equal plain ASCII characters. */
+		size_t common = str_ascii_common(s1 + off1, s2 + off2, SIZE_MAX);
+		off1 += common;
+		off2 += common;
+
 		c1 = str_decode(s1, &off1, STR_NO_LIMIT);
 		c2 = str_decode(s2, &off2, STR_NO_LIMIT);
 
@@ -637,6 +781,13 @@ int str_lcmp(const char *s1, const char *s2, size_t max_len)
 	size_t len = 0;
 
 	while (true) {
+		/* Skip equal plain ASCII characters. */
+		size_t common = str_ascii_common(s1 + off1, s2 + off2,
+		    max_len - len);
+		off1 += common;
+		off2 += common;
+		len += common;
+
 		if (len >= max_len)
 			break;
 
@@ -1219,10 +1370,20 @@ char *str_chr(const char *str, char32_t ch)
 	size_t off = 0;
 	size_t last = 0;
 
-	while ((acc = str_decode(str, &off, STR_NO_LIMIT)) != 0) {
+	/* An ASCII character can be searched for bytewise. */
+	uint8_t stop = (ch < 0x80) ? (uint8_t) ch : 0;
+
+	while (true) {
+		/* Skip plain ASCII characters other than ch. */
+		off += str_span(str + off, SIZE_MAX, stop, true);
+		last = off;
+
+		acc = str_decode(str, &off, STR_NO_LIMIT);
+		if (acc == 0)
+			break;
+
 		if (acc == ch)
 			return (char *) (str + last);
-		last = off;
 	}
 
 	return NULL;
@@ -79,6 +79,20 @@ errno_t task_set_name(const char *name)
 	return (errno_t) __SYSCALL2(SYS_TASK_SET_NAME, (sysarg_t) name, str_size(name));
 }
 
+/** Set the NUMA memory placement policy of the current task.
+ *
+ * @param policy Placement policy for user pages of the task.
+ * @param node   Node to bind to if @a policy is NUMA_POLICY_BIND,
+ *               ignored otherwise.
+ *
+ * @return Zero on success or an error code.
+ */
+errno_t task_set_numa_policy(numa_policy_t policy, unsigned int node)
+{
+	return (errno_t) __SYSCALL2(SYS_TASK_SET_NUMA, (sysarg_t) policy,
+	    (sysarg_t) node);
+}
+
 /** Kill a task.
  *
  * @param task_id ID of task to kill.
@@ -187,56 +201,40 @@ errno_t task_spawnvf_debug(task_id_t *id, task_wait_t *wait,
 
 	bool wait_initialized = false;
 
-	/* Get task ID. */
-	task_id_t task_id;
-	rc = loader_get_task_id(ldr, &task_id);
-	if (rc != EOK)
-		goto error;
-
-	/* Send spawner's current working directory. */
-	rc = loader_set_cwd(ldr);
-	if (rc != EOK)
-		goto error;
-
-	/* Send program binary. */
-	rc = loader_set_program_path(ldr, path);
-	if (rc != EOK)
-		goto error;
-
-	/* Send arguments. */
-	rc = loader_set_args(ldr, args);
-	if (rc != EOK)
-		goto error;
+	/* Collect files */
+	const char *names[4];
+	int files[4];
+	size_t inboxes = 0;
 
-	/* Send files */
 	int root = vfs_root();
 	if (root >= 0) {
-		rc = loader_add_inbox(ldr, "root", root);
-		vfs_put(root);
-		if (rc != EOK)
-			goto error;
+		names[inboxes] = "root";
+		files[inboxes++] = root;
 	}
 
 	if (fd_stdin >= 0) {
-		rc = loader_add_inbox(ldr, "stdin", fd_stdin);
-		if (rc != EOK)
-			goto error;
+		names[inboxes] = "stdin";
+		files[inboxes++] = fd_stdin;
 	}
 
 	if (fd_stdout >= 0) {
-		rc = loader_add_inbox(ldr, "stdout", fd_stdout);
-		if (rc != EOK)
-			goto error;
+		names[inboxes] = "stdout";
+		files[inboxes++] = fd_stdout;
 	}
 
 	if (fd_stderr >= 0) {
-		rc = loader_add_inbox(ldr, "stderr", fd_stderr);
-		if (rc != EOK)
-			goto error;
+		names[inboxes] = "stderr";
+		files[inboxes++] = fd_stderr;
 	}
 
-	/* Load the program. */
-	rc = loader_load_program(ldr);
+	/*
+	 * Send the working directory, program binary, arguments and files
+	 * and load the program in a single request.
+	 */
+	task_id_t task_id;
+	rc = loader_prepare(ldr, path, args, inboxes, names, files, &task_id);
+	if (root >= 0)
+		vfs_put(root);
 	if (rc != EOK)
 		goto error;
 
@@ -259,19 +257,15 @@ errno_t task_spawnvf_debug(task_id_t *id, task_wait_t *wait,
 		rc = udebug_begin(ksess);
 		if (rc != EOK)
 			goto error;
-
-		/*
-		 * Run it, not waiting for response. It would never come
-		 * as the loader is stopped.
-		 */
-		loader_run_nowait(ldr);
-	} else {
-		/* Run it. */
-		rc = loader_run(ldr);
-		if (rc != EOK)
-			goto error;
 	}
 
+	/*
+	 * Run it, not waiting for response. The program is already loaded,
+	 * so the loader cannot fail any more, and the response would never
+	 * come if the loader is stopped for debugging.
+	 */
+	loader_run_nowait(ldr);
+
 	/* Success */
 	if (id != NULL)
 		*id = task_id;
@@ -35,6 +35,7 @@
  */
 
 #include <adt/list.h>
+#include <adt/odict.h>
 #include <fibril.h>
 #include <stack.h>
 #include <tls.h>
@@ -56,9 +57,24 @@
 #define DPRINTF(...) ((void)0)
 #undef READY_DEBUG
 
-/** Member of timeout_list. */
+/** Maximum number of calls received by a single IPC wait. */
+#define IPC_WAIT_BATCH  8
+
+/**
+ * Number of ready queues. Runner threads beyond this number share
+ * queues. Queue 0 belongs to the main thread.
+ */
+#define READY_QUEUES  16
+
+/** Upper bound on the number of recycled fibril stacks kept by a task. */
+#define STACK_POOL_MAX  64
+
+/** Default number of recycled fibril stacks kept by a task. */
+#define STACK_POOL_DEFAULT  16
+
+/** Member of timeouts. */
 typedef struct {
-	link_t link;
+	odlink_t odlink;
 	struct timespec expires;
 	fibril_event_t *event;
 } _timeout_t;
@@ -90,9 +106,35 @@ static futex_t fibril_futex;
 static futex_t ready_semaphore;
 static long ready_st_count;
 
-static LIST_INITIALIZE(ready_list);
+/*
+ * Ready fibrils, one queue per runner thread. A fibril made ready is queued
+ * on the runner that readied it, runners without work of their own steal
+ * from the others.
+ */
+static list_t ready_queues[READY_QUEUES];
+static int runners_spawned;
 static LIST_INITIALIZE(fibril_list);
-static LIST_INITIALIZE(timeout_list);
+
+/*
+ * Pending timeouts ordered by expiration time. Timeouts with equal
+ * expiration time fire in the order they were armed.
+ */
+static odict_t timeouts;
+
+/*
+ * Stacks of dead fibrils kept for reuse, so that short-lived fibrils do not
+ * pay for creating and destroying an address space area each time. The
+ * areas keep their guard page.
+ */
+typedef struct {
+	void *base;
+	size_t size;
+} _pooled_stack_t;
+
+static futex_t stack_pool_futex;
+static _pooled_stack_t stack_pool[STACK_POOL_MAX];
+static size_t stack_pool_count;
+static size_t stack_pool_limit = STACK_POOL_DEFAULT;
 
 static futex_t ipc_lists_futex;
 static LIST_INITIALIZE(ipc_waiter_list);
@@ -110,8 +152,9 @@ static inline void _ready_debug_check(void)
 {
 #ifdef READY_DEBUG
 	assert(!multithreaded);
-	long count = (long) list_count(&ready_list) +
-	    (long) list_count(&ipc_buffer_free_list);
+	long count = (long) list_count(&ipc_buffer_free_list);
+	for (int i = 0; i < READY_QUEUES; i++)
+		count += (long) list_count(&ready_queues[i]);
 	assert(ready_st_count == count);
 #endif
 }
@@ -126,6 +169,27 @@ static inline void _ready_up(void)
 	}
 }
 
+/*
+ * Returns whether a runner is parked on ready_semaphore, i.e. whether the
+ * next token will wake it up. Only a hint, the answer may be outdated.
+ */
+static inline bool _ready_has_sleepers(void)
+{
+	return multithreaded && atomic_load_explicit(&ready_semaphore.val,
+	    memory_order_relaxed) < 0;
+}
+
+/* Returns several tokens to ready_semaphore, waking runners in one go. */
+static inline void _ready_up_n(size_t count)
+{
+	if (multithreaded) {
+		futex_up_n(&ready_semaphore, (int) count);
+	} else {
+		ready_st_count += count;
+		_ready_debug_check();
+	}
+}
+
 static inline errno_t _ready_down(const struct timespec *expires)
 {
 	if (multithreaded)
@@ -136,8 +200,24 @@ static inline errno_t _ready_down(const struct timespec *expires)
 	return EOK;
 }
 
+/* Takes a token from ready_semaphore if one is available right now. */
+static inline bool _ready_try_down(void)
+{
+	if (multithreaded) {
+		struct timespec tv = { .tv_sec = 0, .tv_nsec = 0 };
+		return futex_down_timeout(&ready_semaphore, &tv) == EOK;
+	}
+
+	if (ready_st_count <= 0)
+		return false;
+
+	ready_st_count--;
+	return true;
+}
+
 static atomic_int threads_in_ipc_wait;
 
+static void _ready_list_push(fibril_t *);
 /** Function that spans the whole life-cycle of a fibril.
  *
  * Each fibril begins execution in this function. Then the function implementing
@@ -237,22 +317,46 @@ static fibril_t *_fibril_trigger_internal(fibril_event_t *event, fibril_t *reaso
 	return f;
 }
 
-static errno_t _ipc_wait(ipc_call_t *call, const struct timespec *expires)
+static errno_t _ipc_wait(ipc_call_t *calls, size_t count,
+    const struct timespec *expires, size_t *received)
 {
 	if (!expires)
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NONE);
+		return ipc_wait_multi(calls, count, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NONE, received);
 
 	if (expires->tv_sec == 0)
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		return ipc_wait_multi(calls, count, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NON_BLOCKING, received);
 
 	struct timespec now;
 	getuptime(&now);
 
 	if (ts_gteq(&now, expires))
-		return ipc_wait(call, SYNCH_NO_TIMEOUT, SYNCH_FLAGS_NON_BLOCKING);
+		return ipc_wait_multi(calls, count, SYNCH_NO_TIMEOUT,
+		    SYNCH_FLAGS_NON_BLOCKING, received);
 
-	return ipc_wait(call, NSEC2USEC(ts_sub_diff(expires, &now)),
-	    SYNCH_FLAGS_NONE);
+	return ipc_wait_multi(calls, count, NSEC2USEC(ts_sub_diff(expires, &now)),
+	    SYNCH_FLAGS_NONE, received);
+}
+
+/*
+ * Takes a fibril from the current runner's ready queue, or steals the oldest
+ * ready fibril of another runner if there is none.
+ */
+static fibril_t *_ready_queue_pop(void)
+{
+	futex_assert_is_locked(&fibril_futex);
+
+	unsigned self = fibril_self()->runner;
+
+	for (unsigned i = 0; i < READY_QUEUES; i++) {
+		list_t *queue = &ready_queues[(self + i) % READY_QUEUES];
+		fibril_t *f = list_pop(queue, fibril_t, link);
+		if (f)
+			return f;
+	}
+
+	return NULL;
 }
 
 /*
@@ -284,10 +388,21 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 
 	if (!locked)
 		futex_lock(&fibril_futex);
-	fibril_t *f = list_pop(&ready_list, fibril_t, link);
-	if (!f)
+	fibril_t *f = _ready_queue_pop();
+	size_t reserved = 0;
+	if (!f) {
 		atomic_fetch_add_explicit(&threads_in_ipc_wait, 1,
 		    memory_order_relaxed);
+
+		/*
+		 * With the ready list empty, every token left on the semaphore
+		 * stands for a free buffer bucket. Take some of them, so that
+		 * calls already pending in the answerbox can be received by
+		 * the same wait.
+		 */
+		while (reserved < IPC_WAIT_BATCH - 1 && _ready_try_down())
+			reserved++;
+	}
 	if (!locked)
 		futex_unlock(&fibril_futex);
 
@@ -298,15 +413,17 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 		assert(list_empty(&ipc_buffer_list));
 
 	/* No fibril is ready, IPC wait it is. */
-	ipc_call_t call = { 0 };
-	rc = _ipc_wait(&call, expires);
+	ipc_call_t calls[IPC_WAIT_BATCH];
+	size_t received = 0;
+	calls[0] = (ipc_call_t) { 0 };
+	rc = _ipc_wait(calls, reserved + 1, expires, &received);
 
 	atomic_fetch_sub_explicit(&threads_in_ipc_wait, 1,
 	    memory_order_relaxed);
 
 	if (rc != EOK && rc != ENOENT) {
-		/* Return token. */
-		_ready_up();
+		/* Return our token and the reserved ones. */
+		_ready_up_n(reserved + 1);
 		return NULL;
 	}
 
@@ -315,6 +432,8 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 	 * In that case, we propagate the null call out of fibril_ipc_wait(),
 	 * because poke must result in that call returning.
 	 */
+	if (rc == ENOENT)
+		received = 1;
 
 	/*
 	 * If a fibril is already waiting for IPC, we wake up the fibril,
@@ -329,24 +448,43 @@ static fibril_t *_ready_list_pop(const struct timespec *expires, bool locked)
 
 	futex_lock(&ipc_lists_futex);
 
-	_ipc_waiter_t *w = list_pop(&ipc_waiter_list, _ipc_waiter_t, link);
-	if (w) {
-		*w->call = call;
-		w->rc = rc;
-		/* We switch to the woken up fibril immediately if possible. */
-		f = _fibril_trigger_internal(&w->event, _EVENT_TRIGGERED);
-
-		/* Return token. */
-		_ready_up();
-	} else {
-		_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
-		assert(buf);
-		*buf = (_ipc_buffer_t) { .call = call, .rc = rc };
-		list_append(&buf->link, &ipc_buffer_list);
+	for (size_t i = 0; i < received; i++) {
+		/* Only the first call can carry an error. */
+		errno_t call_rc = (i == 0) ? rc : EOK;
+
+		_ipc_waiter_t *w = list_pop(&ipc_waiter_list, _ipc_waiter_t, link);
+		if (w) {
+			*w->call = calls[i];
+			w->rc = call_rc;
+			fibril_t *woken = _fibril_trigger_internal(&w->event,
+			    _EVENT_TRIGGERED);
+
+			/*
+			 * We switch to the first woken up fibril immediately
+			 * if possible, the others go to the ready list.
+			 */
+			if (!f)
+				f = woken;
+			else
+				_ready_list_push(woken);
+
+			/* Return token. */
+			_ready_up();
+		} else {
+			_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list,
+			    _ipc_buffer_t, link);
+			assert(buf);
+			*buf = (_ipc_buffer_t) { .call = calls[i], .rc = call_rc };
+			list_append(&buf->link, &ipc_buffer_list);
+		}
 	}
 
 	futex_unlock(&ipc_lists_futex);
 
+	/* Return the reserved tokens no call arrived for. */
+	if (received <= reserved)
+		_ready_up_n(reserved + 1 - received);
+
 	if (!locked)
 		futex_unlock(&fibril_futex);
 
@@ -366,11 +504,21 @@ static void _ready_list_push(fibril_t *f)
 
 	futex_assert_is_locked(&fibril_futex);
 
-	/* Enqueue in ready_list. */
-	list_append(&f->link, &ready_list);
+	/*
+	 * Enqueue on the current runner, so that the fibril runs on the same
+	 * thread as the one that made it ready, unless another runner is idle.
+	 */
+	list_append(&f->link, &ready_queues[fibril_self()->runner]);
+
+	/*
+	 * A runner parked on the semaphore picks up the new token by itself,
+	 * so only pull a runner out of the IPC wait if there is none.
+	 */
+	bool sleepers = _ready_has_sleepers();
 	_ready_up();
 
-	if (atomic_load_explicit(&threads_in_ipc_wait, memory_order_relaxed)) {
+	if (!sleepers &&
+	    atomic_load_explicit(&threads_in_ipc_wait, memory_order_relaxed)) {
 		DPRINTF("Poking.\n");
 		/* Wakeup one thread sleeping in SYS_IPC_WAIT. */
 		ipc_poke();
@@ -414,6 +562,60 @@ static errno_t _wait_ipc(ipc_call_t *call, const struct timespec *expires)
 	return rc;
 }
 
+/*
+ * Blocks the current fibril until an IPC call arrives and takes up to
+ * @a count calls that are already buffered.
+ */
+static errno_t _wait_ipc_multi(ipc_call_t *calls, size_t count,
+    const struct timespec *expires, size_t *received)
+{
+	futex_assert_is_not_locked(&fibril_futex);
+	assert(count > 0);
+
+	size_t n = 0;
+	size_t tokens = 0;
+	errno_t rc = EOK;
+
+	futex_lock(&ipc_lists_futex);
+	while (n < count) {
+		link_t *link = list_first(&ipc_buffer_list);
+		if (!link)
+			break;
+
+		_ipc_buffer_t *buf = list_get_instance(link, _ipc_buffer_t, link);
+
+		/* A failed wait is only returned on its own. */
+		if (buf->rc != EOK && n > 0)
+			break;
+
+		list_remove(&buf->link);
+		calls[n] = buf->call;
+		rc = buf->rc;
+
+		/* Return to freelist. */
+		list_append(&buf->link, &ipc_buffer_free_list);
+		tokens++;
+
+		if (rc != EOK)
+			break;
+
+		n++;
+	}
+
+	/* Return IPC wait tokens. */
+	_ready_up_n(tokens);
+	futex_unlock(&ipc_lists_futex);
+
+	if (n == 0 && rc == EOK) {
+		rc = _wait_ipc(&calls[0], expires);
+		if (rc == EOK)
+			n = 1;
+	}
+
+	*received = n;
+	return rc;
+}
+
 /** Fire all timeouts that expired. */
 static struct timespec *_handle_expired_timeouts(struct timespec *next_timeout)
 {
@@ -422,9 +624,9 @@ static struct timespec *_handle_expired_timeouts(struct timespec *next_timeout)
 
 	futex_lock(&fibril_futex);
 
-	while (!list_empty(&timeout_list)) {
-		link_t *cur = list_first(&timeout_list);
-		_timeout_t *to = list_get_instance(cur, _timeout_t, link);
+	odlink_t *cur;
+	while ((cur = odict_first(&timeouts)) != NULL) {
+		_timeout_t *to = odict_get_instance(cur, _timeout_t, odlink);
 
 		if (ts_gt(&to->expires, &ts)) {
 			*next_timeout = to->expires;
@@ -432,7 +634,7 @@ static struct timespec *_handle_expired_timeouts(struct timespec *next_timeout)
 			return next_timeout;
 		}
 
-		list_remove(&to->link);
+		odict_remove(&to->odlink);
 
 		_ready_list_push(_fibril_trigger_internal(
 		    to->event, _EVENT_TIMED_OUT));
@@ -442,6 +644,81 @@ static struct timespec *_handle_expired_timeouts(struct timespec *next_timeout)
 	return NULL;
 }
 
+/** Take a recycled stack of the given size from the pool, if there is one. */
+static void *_stack_pool_get(size_t size)
+{
+	void *base = NULL;
+
+	futex_lock(&stack_pool_futex);
+	for (size_t i = stack_pool_count; i-- > 0;) {
+		if (stack_pool[i].size == size) {
+			base = stack_pool[i].base;
+			stack_pool[i] = stack_pool[--stack_pool_count];
+			break;
+		}
+	}
+	futex_unlock(&stack_pool_futex);
+
+	return base;
+}
+
+/** Allocate a fibril stack, preferably by recycling a pooled one. */
+static void *_stack_alloc(size_t size)
+{
+	void *base = _stack_pool_get(size);
+	if (base)
+		return base;
+
+	return as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE | AS_AREA_GUARD |
+	    AS_AREA_LATE_RESERVE, AS_AREA_UNPAGED);
+}
+
+/** Return a fibril stack to the pool, or destroy it if the pool is full. */
+static void _stack_free(void *base, size_t size)
+{
+	futex_lock(&stack_pool_futex);
+	if (stack_pool_count < stack_pool_limit) {
+		stack_pool[stack_pool_count].base = base;
+		stack_pool[stack_pool_count].size = size;
+		stack_pool_count++;
+		base = NULL;
+	}
+	futex_unlock(&stack_pool_futex);
+
+	if (base)
+		as_area_destroy(base);
+}
+
+/** Set the maximum number of recycled fibril stacks kept by the task.
+ *
+ * Pooled stacks above the new limit are destroyed. A limit of zero
+ * disables stack reuse and releases all pooled stacks.
+ *
+ * @param limit Maximum number of pooled stacks, clamped to STACK_POOL_MAX.
+ * @return Previous limit.
+ */
+size_t fibril_stack_pool_set_limit(size_t limit)
+{
+	_pooled_stack_t excess[STACK_POOL_MAX];
+	size_t nexcess = 0;
+
+	if (limit > STACK_POOL_MAX)
+		limit = STACK_POOL_MAX;
+
+	futex_lock(&stack_pool_futex);
+	size_t old = stack_pool_limit;
+	stack_pool_limit = limit;
+	while (stack_pool_count > limit)
+		excess[nexcess++] = stack_pool[--stack_pool_count];
+	futex_unlock(&stack_pool_futex);
+
+	for (size_t i = 0; i < nexcess; i++)
+		as_area_destroy(excess[i].base);
+
+	return old;
+}
+
 /**
  * Clean up after a dead fibril from which we restored context, if any.
  * Called after a switch is made and fibril_futex is unlocked.
@@ -454,7 +731,7 @@ static void _fibril_cleanup_dead(void)
 
 	void *stack = srcf->clean_after_me->stack;
 	assert(stack);
-	as_area_destroy(stack);
+	_stack_free(stack, srcf->clean_after_me->stack_size);
 	fibril_teardown(srcf->clean_after_me);
 	srcf->clean_after_me = NULL;
 }
@@ -487,6 +764,7 @@ static void _fibril_switch_to(_switch_type_t type, fibril_t *dstf, bool locked)
 
 	dstf->thread_ctx = srcf->thread_ctx;
 	srcf->thread_ctx = NULL;
+	dstf->runner = srcf->runner;
 
 	/* Just some bookkeeping to allow better debugging of futex locks. */
 	futex_give_to(&fibril_futex, dstf);
@@ -550,9 +828,7 @@ fid_t fibril_create_generic(errno_t (*func)(void *), void *arg, size_t stksz)
 		return 0;
 
 	fibril->stack_size = stksz;
-	fibril->stack = as_area_create(AS_AREA_ANY, fibril->stack_size,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE | AS_AREA_GUARD |
-	    AS_AREA_LATE_RESERVE, AS_AREA_UNPAGED);
+	fibril->stack = _stack_alloc(fibril->stack_size);
 	if (fibril->stack == AS_MAP_FAILED) {
 		fibril_teardown(fibril);
 		return 0;
@@ -591,26 +867,38 @@ void fibril_destroy(fid_t fid)
 
 	assert(!fibril->is_running);
 	assert(fibril->stack);
-	as_area_destroy(fibril->stack);
+	_stack_free(fibril->stack, fibril->stack_size);
 	fibril_teardown(fibril);
 }
 
+static void *_timeout_getkey(odlink_t *odlink)
+{
+	return &odict_get_instance(odlink, _timeout_t, odlink)->expires;
+}
+
+static int _timeout_cmp(void *a, void *b)
+{
+	if (ts_gt(a, b))
+		return 1;
+	if (ts_gt(b, a))
+		return -1;
+	return 0;
+}
+
 static void _insert_timeout(_timeout_t *timeout)
 {
 	futex_assert_is_locked(&fibril_futex);
 	assert(timeout);
 
-	link_t *tmp = timeout_list.head.next;
-	while (tmp != &timeout_list.head) {
-		_timeout_t *cur = list_get_instance(tmp, _timeout_t, link);
-
-		if (ts_gteq(&cur->expires, &timeout->expires))
-			break;
+	odict_insert(&timeout->odlink, &timeouts, NULL);
+}
 
-		tmp = tmp->next;
-	}
+static void _remove_timeout(_timeout_t *timeout)
+{
+	futex_assert_is_locked(&fibril_futex);
 
-	list_insert_before(&timeout->link, tmp);
+	if (odlink_used(&timeout->odlink))
+		odict_remove(&timeout->odlink);
 }
 
 /**
@@ -697,7 +985,7 @@ errno_t fibril_wait_timeout(fibril_event_t *event,
 	assert(event->fibril != _EVENT_INITIAL);
 	assert(event->fibril == _EVENT_TIMED_OUT || event->fibril == _EVENT_TRIGGERED);
 
-	list_remove(&timeout.link);
+	_remove_timeout(&timeout);
 	errno_t rc = (event->fibril == _EVENT_TIMED_OUT) ? ETIMEOUT : EOK;
 	event->fibril = _EVENT_INITIAL;
 
@@ -782,7 +1070,8 @@ void fibril_yield(void)
 
 static void _runner_fn(void *arg)
 {
-	_helper_fibril_fn(arg);
+	fibril_self()->runner = (unsigned) (uintptr_t) arg;
+	_helper_fibril_fn(NULL);
 }
 
 /**
@@ -808,7 +1097,9 @@ int fibril_test_spawn_runners(int n)
 
 	for (int i = 0; i < n; i++) {
 		thread_id_t tid;
-		rc = thread_create(_runner_fn, NULL, "fibril runner", &tid);
+		uintptr_t runner = (uintptr_t) (++runners_spawned % READY_QUEUES);
+		rc = thread_create(_runner_fn, (void *) runner, "fibril runner",
+		    &tid);
 		if (rc != EOK)
 			return i;
 		thread_detach(tid);
@@ -835,6 +1126,25 @@ void fibril_enable_multithreaded(void)
 	}
 }
 
+/**
+ * Opt-in to have a given number of runner threads in total.
+ *
+ * This is meant for servers which let the user choose how many threads
+ * serve their requests. Runners are only ever added, never removed.
+ *
+ * @param n  Requested number of runners, including the main thread.
+ * @return   Number of runners the task has now.
+ */
+int fibril_set_runners(int n)
+{
+	int have = runners_spawned + 1;
+
+	if (n <= have)
+		return have;
+
+	return have + fibril_test_spawn_runners(n - have);
+}
+
 /**
  * Detach a fibril.
  */
@@ -869,6 +1179,13 @@ void __fibrils_init(void)
 		abort();
 	if (futex_initialize(&ipc_lists_futex, 1) != EOK)
 		abort();
+	if (futex_initialize(&stack_pool_futex, 1) != EOK)
+		abort();
+
+	odict_initialize(&timeouts, _timeout_getkey, _timeout_cmp);
+
+	for (int i = 0; i < READY_QUEUES; i++)
+		list_initialize(&ready_queues[i]);
 
 	/*
 	 * We allow a fixed, small amount of parallelism for IPC reads, but
@@ -879,10 +1196,10 @@ void __fibrils_init(void)
 #define IPC_BUFFER_COUNT 1024
 	static _ipc_buffer_t buffers[IPC_BUFFER_COUNT];
 
-	for (int i = 0; i < IPC_BUFFER_COUNT; i++) {
+	for (int i = 0; i < IPC_BUFFER_COUNT; i++)
 		list_append(&buffers[i].link, &ipc_buffer_free_list);
-		_ready_up();
-	}
+
+	_ready_up_n(IPC_BUFFER_COUNT);
 }
 
 void __fibrils_fini(void)
@@ -923,5 +1240,21 @@ errno_t fibril_ipc_wait(ipc_call_t *call, const struct timespec *expires)
 	return _wait_ipc(call, expires);
 }
 
+/** Wait for IPC calls and take several at once if they are already there.
+ *
+ * @param calls    Array to store the received calls in.
+ * @param count    Number of entries in @a calls.
+ * @param expires  Time when to stop waiting for the first call.
+ * @param received Place to store the number of received calls.
+ *
+ * @return EOK if @a received calls were received, error code of the wait
+ *         otherwise.
+ */
+errno_t fibril_ipc_wait_multi(ipc_call_t *calls, size_t count,
+    const struct timespec *expires, size_t *received)
+{
+	return _wait_ipc_multi(calls, count, expires, received);
+}
+
 /** @}
  */
@@ -32,6 +32,8 @@
 /** @file
  */
 
+#include <affinity.h>
+#include <rtsched.h>
 #include <libc.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -180,6 +182,73 @@ void thread_usleep(usec_t usec)
 	(void) __SYSCALL1(SYS_THREAD_USLEEP, usec);
 }
 
+/** Restrict the CPUs the current thread may run on.
+ *
+ * This can be used e.g. by servers to pin their fibril runner threads
+ * to chosen cores. If the thread currently runs on a CPU outside of
+ * the set, it is migrated before the function returns.
+ *
+ * @param set Set of allowed CPUs.
+ *
+ * @return EOK on success, EINVAL if the set contains no active CPU.
+ */
+errno_t thread_set_affinity(const cpu_set_t *set)
+{
+	return (errno_t) __SYSCALL2(SYS_THREAD_SET_AFFINITY, (sysarg_t) set,
+	    sizeof(*set));
+}
+
+/** Get the CPUs the current thread may run on.
+ *
+ * @param set Place to store the set of allowed CPUs.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t thread_get_affinity(cpu_set_t *set)
+{
+	cpu_set_zero(set);
+	return (errno_t) __SYSCALL2(SYS_THREAD_GET_AFFINITY, (sysarg_t) set,
+	    sizeof(*set));
+}
+
+/** Move the current thread to the real-time scheduling class.
+ *
+ * A real-time thread runs before all time-shared threads and is only
+ * preempted by real-time threads of a higher priority. If a budget is
+ * set, the thread runs in the real-time class for at most @a budget
+ * microseconds of each @a period and is time-shared for the rest. The
+ * kernel refuses reservations which would overcommit the CPUs. Without
+ * a budget, the thread reserves a whole CPU.
+ *
+ * @param prio   Priority from RT_PRIO_MIN to RT_PRIO_MAX.
+ * @param budget Budget per period in microseconds or 0 for unlimited.
+ * @param period Replenishment period in microseconds.
+ *
+ * @return EOK on success, EINVAL on invalid arguments, EBUSY if the
+ *         reservation cannot be admitted, EPERM if the task is not
+ *         permitted to use the real-time class.
+ */
+errno_t thread_set_realtime(int prio, usec_t budget, usec_t period)
+{
+	if ((prio < RT_PRIO_MIN) || (prio > RT_PRIO_MAX))
+		return EINVAL;
+
+	if ((budget < 0) || (period < 0) || (period > UINT32_MAX))
+		return EINVAL;
+
+	return (errno_t) __SYSCALL3(SYS_THREAD_SET_RT, (sysarg_t) prio,
+	    (sysarg_t) budget, (sysarg_t) period);
+}
+
+/** Move the current thread back to the time-sharing scheduling class.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t thread_set_timesharing(void)
+{
+	return (errno_t) __SYSCALL3(SYS_THREAD_SET_RT, (sysarg_t) -1, 0, 0);
+}
+
 /** Wait unconditionally for specified number of seconds
  *
  */
@@ -123,6 +123,16 @@ errno_t udebug_mem_read(async_sess_t *sess, void *buffer, uintptr_t addr, size_t
 	return rc;
 }
 
+errno_t udebug_word_write(async_sess_t *sess, uintptr_t addr, sysarg_t value)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	errno_t rc = async_req_3_0(exch, IPC_M_DEBUG, UDEBUG_M_WORD_WRITE,
+	    addr, value);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 errno_t udebug_args_read(async_sess_t *sess, thash_t tid, sysarg_t *buffer)
 {
 	async_exch_t *exch = async_exchange_begin(sess);
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Asynchronous file I/O
+ *
+ * Reads and writes submitted to a queue are sent to VFS right away, up to the
+ * depth of the queue, each over an exchange of its own so that VFS and the
+ * file systems can work on them in parallel. Requests beyond the depth are
+ * held locally and sent as earlier requests complete. Completions are
+ * collected from the queue in the order in which their answers arrive.
+ */
+
+#include <vfs/vfs.h>
+#include <adt/list.h>
+#include <assert.h>
+#include <async.h>
+#include <errno.h>
+#include <macros.h>
+#include <stdlib.h>
+
+typedef enum {
+	/** Not sent yet, waiting for room in the queue */
+	VFS_AIO_QUEUED,
+	/** Sent to VFS, waiting for the answer */
+	VFS_AIO_SENT,
+	/** Failed before it could be sent */
+	VFS_AIO_FAILED
+} vfs_aio_state_t;
+
+struct vfs_aio {
+	/** Link in one of the lists of the queue */
+	link_t link;
+	vfs_aio_state_t state;
+	/** VFS_IN_READ or VFS_IN_WRITE */
+	sysarg_t method;
+	int file;
+	aoff64_t pos;
+	void *buf;
+	size_t nbyte;
+	/** Argument passed back with the completion */
+	void *arg;
+	/** Exchange held while the request is in flight */
+	async_exch_t *exch;
+	/** The VFS request */
+	aid_t req;
+	/** The data transfer accompanying the request */
+	aid_t data;
+	ipc_call_t answer;
+	/** Error code of a request which failed before it could be sent */
+	errno_t rc;
+};
+
+struct vfs_aio_queue {
+	/** Wait set of the requests in flight */
+	async_wait_set_t *set;
+	/** Maximum number of requests in flight */
+	size_t depth;
+	/** Requests in flight (vfs_aio_t) */
+	list_t sent;
+	size_t nsent;
+	/** Requests waiting to be sent (vfs_aio_t) */
+	list_t queued;
+	/** Requests which failed before they could be sent (vfs_aio_t) */
+	list_t failed;
+};
+
+/** Send a request to VFS.
+ *
+ * If the request cannot be sent, it is moved to the list of failed requests
+ * and reported by the next call to vfs_aio_wait() or vfs_aio_poll().
+ */
+static void vfs_aio_send(vfs_aio_queue_t *queue, vfs_aio_t *aio)
+{
+	aio->exch = vfs_exchange_begin();
+	aio->req = async_send_3(aio->exch, aio->method, aio->file,
+	    LOWER32(aio->pos), UPPER32(aio->pos), &aio->answer);
+	if (aio->req != 0) {
+		if (aio->method == VFS_IN_READ)
+			aio->data = async_data_read(aio->exch, aio->buf,
+			    aio->nbyte, NULL);
+		else
+			aio->data = async_data_write(aio->exch, aio->buf,
+			    aio->nbyte, NULL);
+	}
+
+	if (aio->req == 0 || aio->data == 0 ||
+	    async_wait_set_add(queue->set, aio->req) != EOK) {
+		if (aio->data != 0)
+			async_forget(aio->data);
+		if (aio->req != 0)
+			async_forget(aio->req);
+		vfs_exchange_end(aio->exch);
+		aio->exch = NULL;
+
+		aio->state = VFS_AIO_FAILED;
+		aio->rc = ENOMEM;
+		list_append(&aio->link, &queue->failed);
+		return;
+	}
+
+	aio->state = VFS_AIO_SENT;
+	list_append(&aio->link, &queue->sent);
+	queue->nsent++;
+}
+
+/** Send queued requests while there is room in the queue. */
+static void vfs_aio_refill(vfs_aio_queue_t *queue)
+{
+	while (queue->nsent < queue->depth && !list_empty(&queue->queued)) {
+		vfs_aio_t *aio = list_pop(&queue->queued, vfs_aio_t, link);
+		vfs_aio_send(queue, aio);
+	}
+}
+
+/** Find the request in flight with the given VFS request hash. */
+static vfs_aio_t *vfs_aio_find(vfs_aio_queue_t *queue, aid_t req)
+{
+	list_foreach(queue->sent, link, vfs_aio_t, aio) {
+		if (aio->req == req)
+			return aio;
+	}
+
+	return NULL;
+}
+
+/** Report a request which failed before it could be sent. */
+static void vfs_aio_report_failed(vfs_aio_queue_t *queue,
+    vfs_aio_result_t *res)
+{
+	vfs_aio_t *aio = list_pop(&queue->failed, vfs_aio_t, link);
+
+	res->aio = aio;
+	res->arg = aio->arg;
+	res->rc = aio->rc;
+	res->nbytes = 0;
+	free(aio);
+}
+
+/** Finish a request whose VFS request has been answered.
+ *
+ * @param queue Queue
+ * @param req   Hash of the answered VFS request
+ * @param rc    Return value of the VFS request
+ * @param res   Place to store the completion
+ */
+static void vfs_aio_finish(vfs_aio_queue_t *queue, aid_t req, errno_t rc,
+    vfs_aio_result_t *res)
+{
+	vfs_aio_t *aio = vfs_aio_find(queue, req);
+	assert(aio != NULL);
+
+	errno_t drc;
+	async_wait_for(aio->data, &drc);
+	vfs_exchange_end(aio->exch);
+
+	list_remove(&aio->link);
+	queue->nsent--;
+
+	if (rc == EOK)
+		rc = drc;
+
+	res->aio = aio;
+	res->arg = aio->arg;
+	res->rc = rc;
+	res->nbytes = (rc == EOK) ? ipc_get_arg1(&aio->answer) : 0;
+	free(aio);
+
+	vfs_aio_refill(queue);
+}
+
+/** Create an asynchronous I/O queue.
+ *
+ * A queue may only be used by one fibril at a time.
+ *
+ * @param depth         Maximum number of requests sent to VFS at the same
+ *                      time
+ * @param[out] rqueue   Place to store pointer to the new queue
+ *
+ * @return              EOK on success, EINVAL if @a depth is zero, ENOMEM if
+ *                      out of memory
+ */
+errno_t vfs_aio_queue_create(size_t depth, vfs_aio_queue_t **rqueue)
+{
+	if (depth == 0)
+		return EINVAL;
+
+	vfs_aio_queue_t *queue = calloc(1, sizeof(vfs_aio_queue_t));
+	if (queue == NULL)
+		return ENOMEM;
+
+	queue->set = async_wait_set_create();
+	if (queue->set == NULL) {
+		free(queue);
+		return ENOMEM;
+	}
+
+	queue->depth = depth;
+	list_initialize(&queue->sent);
+	list_initialize(&queue->queued);
+	list_initialize(&queue->failed);
+
+	*rqueue = queue;
+	return EOK;
+}
+
+/** Destroy an asynchronous I/O queue.
+ *
+ * Requests which have not been sent yet are cancelled. Requests in flight
+ * still use their buffers, so this waits until they are answered. No
+ * completions are reported.
+ *
+ * @param queue Queue to destroy
+ */
+void vfs_aio_queue_destroy(vfs_aio_queue_t *queue)
+{
+	vfs_aio_result_t res;
+
+	list_foreach_safe(queue->queued, cur, next) {
+		vfs_aio_t *aio = list_get_instance(cur, vfs_aio_t, link);
+		list_remove(&aio->link);
+		free(aio);
+	}
+
+	while (!list_empty(&queue->failed))
+		vfs_aio_report_failed(queue, &res);
+
+	while (queue->nsent > 0) {
+		aid_t req;
+		errno_t rc;
+
+		async_wait_any(queue->set, &req, &rc);
+		vfs_aio_finish(queue, req, rc, &res);
+	}
+
+	async_wait_set_destroy(queue->set);
+	free(queue);
+}
+
+/** Submit an asynchronous request.
+ *
+ * @param queue         Queue
+ * @param method        VFS_IN_READ or VFS_IN_WRITE
+ * @param file          File handle
+ * @param pos           Position in the file
+ * @param buf           Data buffer
+ * @param nbyte         Number of bytes
+ * @param arg           Argument passed back with the completion
+ * @param[out] raio     If not NULL, place to store the request handle
+ *
+ * @return              EOK on success, ENOMEM if out of memory
+ */
+static errno_t vfs_aio_submit(vfs_aio_queue_t *queue, sysarg_t method,
+    int file, aoff64_t pos, void *buf, size_t nbyte, void *arg,
+    vfs_aio_t **raio)
+{
+	vfs_aio_t *aio = calloc(1, sizeof(vfs_aio_t));
+	if (aio == NULL)
+		return ENOMEM;
+
+	aio->method = method;
+	aio->file = file;
+	aio->pos = pos;
+	aio->buf = buf;
+	aio->nbyte = min(nbyte, DATA_XFER_LIMIT);
+	aio->arg = arg;
+
+	if (raio != NULL)
+		*raio = aio;
+
+	if (queue->nsent < queue->depth) {
+		vfs_aio_send(queue, aio);
+	} else {
+		aio->state = VFS_AIO_QUEUED;
+		list_append(&aio->link, &queue->queued);
+	}
+
+	return EOK;
+}
+
+/** Start an asynchronous read.
+ *
+ * Like vfs_read_short(), at most DATA_XFER_LIMIT bytes are transferred and
+ * fewer bytes than requested may be read. The buffer must not be touched
+ * until the completion of the request is reported.
+ *
+ * @param queue         Queue to submit the request to
+ * @param file          File handle to read from
+ * @param pos           Position to read from
+ * @param buf           Buffer to read into
+ * @param nbyte         Maximum number of bytes to read
+ * @param arg           Argument passed back with the completion
+ * @param[out] raio     If not NULL, place to store the request handle
+ *
+ * @return              EOK on success or an error code. Errors of the read
+ *                      itself are reported with its completion.
+ */
+errno_t vfs_read_async(vfs_aio_queue_t *queue, int file, aoff64_t pos,
+    void *buf, size_t nbyte, void *arg, vfs_aio_t **raio)
+{
+	return vfs_aio_submit(queue, VFS_IN_READ, file, pos, buf, nbyte, arg,
+	    raio);
+}
+
+/** Start an asynchronous write.
+ *
+ * Like vfs_write_short(), at most DATA_XFER_LIMIT bytes are transferred. The
+ * buffer must not be modified until the completion of the request is
+ * reported.
+ *
+ * @param queue         Queue to submit the request to
+ * @param file          File handle to write to
+ * @param pos           Position to write to
+ * @param buf           Data to write
+ * @param nbyte         Number of bytes to write
+ * @param arg           Argument passed back with the completion
+ * @param[out] raio     If not NULL, place to store the request handle
+ *
+ * @return              EOK on success or an error code. Errors of the write
+ *                      itself are reported with its completion.
+ */
+errno_t vfs_write_async(vfs_aio_queue_t *queue, int file, aoff64_t pos,
+    const void *buf, size_t nbyte, void *arg, vfs_aio_t **raio)
+{
+	return vfs_aio_submit(queue, VFS_IN_WRITE, file, pos, (void *) buf,
+	    nbyte, arg, raio);
+}
+
+/** Wait for the completion of a request.
+ *
+ * The request handle in @a res only identifies the request, it is no longer
+ * valid.
+ *
+ * @param queue         Queue
+ * @param[out] res      Place to store the completion
+ *
+ * @return              EOK if a completion was stored, ENOENT if the queue
+ *                      holds no requests
+ */
+errno_t vfs_aio_wait(vfs_aio_queue_t *queue, vfs_aio_result_t *res)
+{
+	if (!list_empty(&queue->failed)) {
+		vfs_aio_report_failed(queue, res);
+		return EOK;
+	}
+
+	if (queue->nsent == 0)
+		return ENOENT;
+
+	aid_t req;
+	errno_t rc;
+
+	async_wait_any(queue->set, &req, &rc);
+	vfs_aio_finish(queue, req, rc, res);
+	return EOK;
+}
+
+/** Collect the completion of a request without blocking.
+ *
+ * @param queue         Queue
+ * @param[out] res      Place to store the completion
+ *
+ * @return              EOK if a completion was stored, EAGAIN if no request
+ *                      has completed yet, ENOENT if the queue holds no
+ *                      requests
+ */
+errno_t vfs_aio_poll(vfs_aio_queue_t *queue, vfs_aio_result_t *res)
+{
+	if (!list_empty(&queue->failed)) {
+		vfs_aio_report_failed(queue, res);
+		return EOK;
+	}
+
+	if (queue->nsent == 0)
+		return ENOENT;
+
+	aid_t req;
+	errno_t rc;
+
+	if (async_wait_poll(queue->set, &req, &rc, 1) == 0)
+		return EAGAIN;
+
+	vfs_aio_finish(queue, req, rc, res);
+	return EOK;
+}
+
+/** Cancel a request.
+ *
+ * Only requests which have not been sent to VFS yet can be cancelled. The
+ * completion of a cancelled request is not reported and its handle is no
+ * longer valid.
+ *
+ * @param queue         Queue the request was submitted to
+ * @param aio           Request to cancel
+ *
+ * @return              EOK on success, EBUSY if the request is already in
+ *                      flight
+ */
+errno_t vfs_aio_cancel(vfs_aio_queue_t *queue, vfs_aio_t *aio)
+{
+	(void) queue;
+
+	if (aio->state == VFS_AIO_SENT)
+		return EBUSY;
+
+	list_remove(&aio->link);
+	free(aio);
+	return EOK;
+}
+
+/** @}
+ */
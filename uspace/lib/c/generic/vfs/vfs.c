@@ -42,6 +42,7 @@
 #include <stdint.h>
 #include <ipc/services.h>
 #include <ns.h>
+#include <as.h>
 #include <async.h>
 #include <fibril_synch.h>
 #include <errno.h>
@@ -224,6 +225,79 @@ char *vfs_absolutize(const char *path, size_t *retlen)
 	return ncwd_path;
 }
 
+/** Share a data buffer with VFS for a file handle
+ *
+ * Subsequent vfs_read_buffer() and vfs_write_buffer() calls on @a file
+ * transfer data through this buffer, so that only control messages need to be
+ * exchanged with VFS. The same area can be shared for several file handles.
+ * Any buffer previously shared for @a file is released.
+ *
+ * @param file          File handle
+ * @param buf           Start of a readable and writable address space area
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_buffer_register(int file, void *buf)
+{
+	ipc_call_t answer;
+	errno_t rc;
+
+	async_exch_t *exch = vfs_exchange_begin();
+	aid_t req = async_send_2(exch, VFS_IN_BUFFER, file, true, &answer);
+	rc = async_share_out_start(exch, buf, AS_AREA_READ | AS_AREA_WRITE);
+	vfs_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	return rc;
+}
+
+/** Stop sharing a data buffer with VFS for a file handle
+ *
+ * @param file          File handle
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_buffer_unregister(int file)
+{
+	async_exch_t *exch = vfs_exchange_begin();
+	errno_t rc = async_req_2_0(exch, VFS_IN_BUFFER, file, false);
+	vfs_exchange_end(exch);
+
+	return rc;
+}
+
+/** Get statistics of a VFS cache
+ *
+ * @param cache         Cache to query
+ * @param[out] stats    Place to store the statistics
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_cache_stats(vfs_cache_t cache, vfs_cache_stats_t *stats)
+{
+	sysarg_t hits, misses, evictions, invalidations, entries;
+
+	async_exch_t *exch = vfs_exchange_begin();
+	errno_t rc = async_req_1_5(exch, VFS_IN_CACHE_STATS, cache, &hits,
+	    &misses, &evictions, &invalidations, &entries);
+	vfs_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	stats->hits = hits;
+	stats->misses = misses;
+	stats->evictions = evictions;
+	stats->invalidations = invalidations;
+	stats->entries = entries;
+	return EOK;
+}
+
 /** Clone a file handle
  *
  * The caller can choose whether to clone an existing file handle into another
@@ -861,6 +935,38 @@ errno_t vfs_read(int file, aoff64_t *pos, void *buf, size_t nbyte, size_t *nread
 	return EOK;
 }
 
+/** Read bytes from a file into its shared buffer
+ *
+ * The data is stored at the start of the buffer registered with
+ * vfs_buffer_register(). Unlike vfs_read_short(), the transfer is not limited
+ * to DATA_XFER_LIMIT bytes. Fewer bytes than requested are read only at the
+ * end of the file or on error after some data has been transferred.
+ *
+ * @param file          File handle to read from
+ * @param pos           Position to read from, updated by the actual bytes
+ *                      read
+ * @param nbyte         Number of bytes to read, at most the buffer size
+ * @param[out] nread    Actual number of bytes read
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_read_buffer(int file, aoff64_t *pos, size_t nbyte, size_t *nread)
+{
+	sysarg_t cnt;
+
+	async_exch_t *exch = vfs_exchange_begin();
+	errno_t rc = async_req_4_1(exch, VFS_IN_READ_BUFFER, file,
+	    LOWER32(*pos), UPPER32(*pos), nbyte, &cnt);
+	vfs_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*pos += cnt;
+	*nread = cnt;
+	return EOK;
+}
+
 /** Read bytes from a file
  *
  * Read up to @a nbyte bytes from file. The actual number of bytes read
@@ -906,6 +1012,115 @@ errno_t vfs_read_short(int file, aoff64_t pos, void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Transfer one chunk of a vectored request over an open exchange
+ *
+ * @param exch          VFS exchange
+ * @param method        VFS_IN_READ or VFS_IN_WRITE
+ * @param file          File handle
+ * @param pos           Position to transfer at
+ * @param buf           Data buffer
+ * @param nbyte         Number of bytes, at most DATA_XFER_LIMIT
+ * @param[out] cnt      Number of bytes actually transferred
+ *
+ * @return              EOK on success or an error code
+ */
+static errno_t vfs_xfer_chunk(async_exch_t *exch, sysarg_t method, int file,
+    aoff64_t pos, void *buf, size_t nbyte, size_t *cnt)
+{
+	errno_t rc;
+	ipc_call_t answer;
+	aid_t req;
+
+	req = async_send_3(exch, method, file, LOWER32(pos), UPPER32(pos),
+	    &answer);
+	if (method == VFS_IN_READ)
+		rc = async_data_read_start(exch, buf, nbyte);
+	else
+		rc = async_data_write_start(exch, buf, nbyte);
+
+	if (rc == EOK)
+		async_wait_for(req, &rc);
+	else
+		async_forget(req);
+
+	if (rc != EOK)
+		return rc;
+
+	*cnt = ipc_get_arg1(&answer);
+	return EOK;
+}
+
+/** Transfer a vector of buffers using a single VFS exchange
+ *
+ * The transfer stops at the first short read or write, so the file
+ * position always matches the data actually transferred.
+ *
+ * @param method        VFS_IN_READ or VFS_IN_WRITE
+ * @param file          File handle
+ * @param[inout] pos    Position, updated by the number of bytes transferred
+ * @param iov           Array of buffers
+ * @param iovcnt        Number of entries in @a iov
+ * @param[out] ndone    Total number of bytes transferred
+ *
+ * @return              EOK on success or an error code
+ */
+static errno_t vfs_xfer_vec(sysarg_t method, int file, aoff64_t *pos,
+    const vfs_iovec_t *iov, size_t iovcnt, size_t *ndone)
+{
+	errno_t rc = EOK;
+	size_t total = 0;
+	size_t i;
+
+	async_exch_t *exch = vfs_exchange_begin();
+
+	for (i = 0; i < iovcnt; i++) {
+		uint8_t *bp = iov[i].base;
+		size_t left = iov[i].size;
+
+		while (left > 0) {
+			size_t now = min(left, (size_t) DATA_XFER_LIMIT);
+			size_t cnt = 0;
+
+			rc = vfs_xfer_chunk(exch, method, file, *pos, bp, now,
+			    &cnt);
+			if (rc != EOK)
+				goto out;
+
+			bp += cnt;
+			left -= cnt;
+			total += cnt;
+			*pos += cnt;
+
+			if (cnt < now)
+				goto out;
+		}
+	}
+
+out:
+	vfs_exchange_end(exch);
+	*ndone = total;
+	return rc;
+}
+
+/** Read data into a vector of buffers
+ *
+ * All segments are read over a single VFS exchange. Reading stops early
+ * at end of file.
+ *
+ * @param file          File handle to read from
+ * @param[inout] pos    Position to read from, updated by the actual bytes read
+ * @param iov           Array of destination buffers
+ * @param iovcnt        Number of entries in @a iov
+ * @param[out] nread    Place to store total number of bytes read
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_readv(int file, aoff64_t *pos, const vfs_iovec_t *iov,
+    size_t iovcnt, size_t *nread)
+{
+	return vfs_xfer_vec(VFS_IN_READ, file, pos, iov, iovcnt, nread);
+}
+
 /** Rename a file or directory
  *
  * There is no file-handle-based variant to disallow attempts to introduce loops
@@ -1327,6 +1542,38 @@ errno_t vfs_write(int file, aoff64_t *pos, const void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Write bytes to a file from its shared buffer
+ *
+ * The data is taken from the start of the buffer registered with
+ * vfs_buffer_register(). Unlike vfs_write_short(), the transfer is not
+ * limited to DATA_XFER_LIMIT bytes.
+ *
+ * @param file          File handle to write to
+ * @param pos           Position to write to, updated by the actual bytes
+ *                      written
+ * @param nbyte         Number of bytes to write, at most the buffer size
+ * @param[out] nwritten Actual number of bytes written
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_write_buffer(int file, aoff64_t *pos, size_t nbyte,
+    size_t *nwritten)
+{
+	sysarg_t cnt;
+
+	async_exch_t *exch = vfs_exchange_begin();
+	errno_t rc = async_req_4_1(exch, VFS_IN_WRITE_BUFFER, file,
+	    LOWER32(*pos), UPPER32(*pos), nbyte, &cnt);
+	vfs_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*pos += cnt;
+	*nwritten = cnt;
+	return EOK;
+}
+
 /** Write bytes to a file
  *
  * Write up to @a nbyte bytes from file. The actual number of bytes written
@@ -1370,5 +1617,23 @@ errno_t vfs_write_short(int file, aoff64_t pos, const void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Write data from a vector of buffers
+ *
+ * All segments are written over a single VFS exchange.
+ *
+ * @param file          File handle to write to
+ * @param[inout] pos    Position to write to, updated by the actual bytes written
+ * @param iov           Array of source buffers
+ * @param iovcnt        Number of entries in @a iov
+ * @param[out] nwritten Place to store total number of bytes written
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_writev(int file, aoff64_t *pos, const vfs_iovec_t *iov,
+    size_t iovcnt, size_t *nwritten)
+{
+	return vfs_xfer_vec(VFS_IN_WRITE, file, pos, iov, iovcnt, nwritten);
+}
+
 /** @}
  */
@@ -75,6 +75,11 @@ typedef struct {
 	hash_table_ops_t *op;
 	list_t *bucket;
 	size_t bucket_cnt;
+	/** Table being migrated to @c bucket, NULL if no resize is under way. */
+	list_t *old_bucket;
+	size_t old_bucket_cnt;
+	/** Buckets of @c old_bucket below this index have been migrated. */
+	size_t rehash_idx;
 	size_t full_item_cnt;
 	size_t item_cnt;
 	size_t max_load;
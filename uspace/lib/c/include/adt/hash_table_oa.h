@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Open-addressing hash table.
+ */
+
+#ifndef _LIBC_HASH_TABLE_OA_H_
+#define _LIBC_HASH_TABLE_OA_H_
+
+#include <adt/hash_table.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Slot of an open-addressing hash table. */
+typedef struct {
+	/** Cached hash of the item's lookup key. */
+	size_t hash;
+	/** Item stored in the slot, NULL if the slot is empty. */
+	ht_link_t *item;
+} hash_table_oa_slot_t;
+
+/** Open-addressing hash table structure.
+ *
+ * Uses the same items and operations as hash_table_t, but keeps pointers
+ * to the items together with their hashes in a single array, so that
+ * lookups touch only the items whose hash matches.
+ */
+typedef struct {
+	hash_table_ops_t *op;
+	hash_table_oa_slot_t *slot;
+	/** Number of slots, always a power of two. */
+	size_t slot_cnt;
+	size_t item_cnt;
+	/** Number of items removed while hash_table_oa_apply() was running. */
+	size_t dead_cnt;
+	bool apply_ongoing;
+} hash_table_oa_t;
+
+extern bool hash_table_oa_create(hash_table_oa_t *, size_t,
+    hash_table_ops_t *);
+extern void hash_table_oa_destroy(hash_table_oa_t *);
+
+extern bool hash_table_oa_empty(hash_table_oa_t *);
+extern size_t hash_table_oa_size(hash_table_oa_t *);
+
+extern void hash_table_oa_clear(hash_table_oa_t *);
+extern bool hash_table_oa_insert(hash_table_oa_t *, ht_link_t *);
+extern bool hash_table_oa_insert_unique(hash_table_oa_t *, ht_link_t *);
+extern ht_link_t *hash_table_oa_find(const hash_table_oa_t *, const void *);
+extern ht_link_t *hash_table_oa_find_next(const hash_table_oa_t *,
+    ht_link_t *, ht_link_t *);
+extern size_t hash_table_oa_remove(hash_table_oa_t *, const void *);
+extern void hash_table_oa_remove_item(hash_table_oa_t *, ht_link_t *);
+extern void hash_table_oa_apply(hash_table_oa_t *,
+    bool (*)(ht_link_t *, void *), void *);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Bounded lock-free multi-producer multi-consumer ring buffer.
+ */
+
+#ifndef _LIBC_MPMC_RING_H_
+#define _LIBC_MPMC_RING_H_
+
+#include <errno.h>
+#include <fibril_synch.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Assumed size of a cache line. */
+#define MPMC_RING_CACHE_LINE  64
+
+typedef enum {
+	/** Allow mpmc_ring_push() and mpmc_ring_pop() to block. */
+	MPMC_RING_BLOCKING = 0x1
+} mpmc_ring_flags_t;
+
+/** Ring buffer cell. */
+typedef struct {
+	/** Sequence number telling whether the cell is free or full. */
+	atomic_size_t seq;
+	/** Stored item. */
+	void *item;
+} mpmc_ring_cell_t;
+
+/** Bounded MPMC ring buffer of pointers.
+ *
+ * The producer and consumer positions are kept on separate cache lines
+ * so that producers and consumers do not contend with each other.
+ */
+typedef struct {
+	mpmc_ring_cell_t *cell;
+	/** Number of cells minus one (the size is a power of two). */
+	size_t mask;
+	mpmc_ring_flags_t flags;
+
+	char pad0[MPMC_RING_CACHE_LINE];
+	/** Position of the next item to be pushed. */
+	atomic_size_t push_pos;
+	char pad1[MPMC_RING_CACHE_LINE - sizeof(atomic_size_t)];
+	/** Position of the next item to be popped. */
+	atomic_size_t pop_pos;
+	char pad2[MPMC_RING_CACHE_LINE - sizeof(atomic_size_t)];
+
+	/** Number of fibrils blocked in mpmc_ring_pop(). */
+	atomic_int pop_waiting;
+	/** Number of fibrils blocked in mpmc_ring_push(). */
+	atomic_int push_waiting;
+	fibril_semaphore_t not_empty;
+	fibril_semaphore_t not_full;
+} mpmc_ring_t;
+
+extern errno_t mpmc_ring_initialize(mpmc_ring_t *, size_t, mpmc_ring_flags_t);
+extern void mpmc_ring_destroy(mpmc_ring_t *);
+
+extern size_t mpmc_ring_capacity(mpmc_ring_t *);
+extern bool mpmc_ring_try_push(mpmc_ring_t *, void *);
+extern bool mpmc_ring_try_pop(mpmc_ring_t *, void **);
+extern size_t mpmc_ring_push_batch(mpmc_ring_t *, void *const *, size_t);
+extern size_t mpmc_ring_pop_batch(mpmc_ring_t *, void **, size_t);
+extern void mpmc_ring_push(mpmc_ring_t *, void *);
+extern void *mpmc_ring_pop(mpmc_ring_t *);
+
+#endif
+
+/** @}
+ */
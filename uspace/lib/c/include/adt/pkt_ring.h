@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Single-producer single-consumer packet ring in shared memory.
+ */
+
+#ifndef _LIBC_PKT_RING_H_
+#define _LIBC_PKT_RING_H_
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Assumed size of a cache line. */
+#define PKT_RING_CACHE_LINE  64
+
+/** Packet descriptor.
+ *
+ * The meaning of @c flags and the two arguments is up to the users
+ * of the ring.
+ */
+typedef struct {
+	/** Packet size in bytes */
+	uint32_t size;
+	uint32_t flags;
+	uint32_t arg1;
+	uint32_t arg2;
+} pkt_ring_desc_t;
+
+/** Ring header at the start of the shared area.
+ *
+ * The producer and consumer indices run freely and are kept on separate
+ * cache lines. The wait flags are raised by a side that is about to sleep
+ * so that the other side knows it has to ring the doorbell.
+ */
+typedef struct {
+	uint32_t magic;
+	/** Number of slots (a power of two) */
+	uint32_t nslots;
+	/** Size of one slot in bytes */
+	uint32_t slot_size;
+	char pad0[PKT_RING_CACHE_LINE - 3 * sizeof(uint32_t)];
+	/** Index of the next slot to be produced */
+	atomic_uint prod;
+	char pad1[PKT_RING_CACHE_LINE - sizeof(atomic_uint)];
+	/** Index of the next slot to be consumed */
+	atomic_uint cons;
+	char pad2[PKT_RING_CACHE_LINE - sizeof(atomic_uint)];
+	/** Consumer waits for a doorbell */
+	atomic_uint cons_wait;
+	char pad3[PKT_RING_CACHE_LINE - sizeof(atomic_uint)];
+} pkt_ring_hdr_t;
+
+/** One side's view of a packet ring.
+ *
+ * Each side keeps a private copy of the index it advances, so that
+ * a batch of packets can be made visible to the other side at once.
+ */
+typedef struct {
+	pkt_ring_hdr_t *hdr;
+	pkt_ring_desc_t *desc;
+	uint8_t *slots;
+	uint32_t mask;
+	uint32_t slot_size;
+	/** Producer: next slot to fill, consumer: next slot to read */
+	uint32_t pos;
+} pkt_ring_t;
+
+extern size_t pkt_ring_area_size(size_t, size_t);
+extern errno_t pkt_ring_create(pkt_ring_t *, void *, size_t, size_t);
+extern errno_t pkt_ring_attach(pkt_ring_t *, void *, size_t);
+
+extern void *pkt_ring_prod_slot(pkt_ring_t *);
+extern void pkt_ring_prod_put(pkt_ring_t *, const pkt_ring_desc_t *);
+extern bool pkt_ring_prod_publish(pkt_ring_t *);
+
+extern void *pkt_ring_cons_peek(pkt_ring_t *, pkt_ring_desc_t *);
+extern void pkt_ring_cons_next(pkt_ring_t *);
+extern void pkt_ring_cons_publish(pkt_ring_t *);
+extern bool pkt_ring_cons_wait(pkt_ring_t *);
+
+#endif
+
+/** @}
+ */
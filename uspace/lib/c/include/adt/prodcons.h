@@ -36,15 +36,21 @@
 #define _LIBC_PRODCONS_H_
 
 #include <adt/list.h>
+#include <adt/mpmc_ring.h>
+#include <errno.h>
 #include <fibril_synch.h>
 
 typedef struct {
 	fibril_mutex_t mtx;
 	fibril_condvar_t cv;
 	list_t list;
+	/** Lock-free backend of a bounded queue or @c NULL */
+	mpmc_ring_t *ring;
 } prodcons_t;
 
 extern void prodcons_initialize(prodcons_t *);
+extern errno_t prodcons_initialize_bounded(prodcons_t *, size_t);
+extern void prodcons_destroy(prodcons_t *);
 extern void prodcons_produce(prodcons_t *, link_t *);
 extern link_t *prodcons_consume(prodcons_t *);
 
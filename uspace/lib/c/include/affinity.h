@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file
+ */
+
+#ifndef _LIBC_AFFINITY_H_
+#define _LIBC_AFFINITY_H_
+
+#include <errno.h>
+#include <stdbool.h>
+
+/** Maximum number of CPUs representable in cpu_set_t */
+#define CPU_SET_MAX  256
+
+#define CPU_SET_WORD_BITS  (8 * sizeof(unsigned int))
+
+/** Set of CPUs
+ *
+ * The layout matches the kernel cpu_mask_t, bit i stands for the CPU
+ * with ID i.
+ */
+typedef struct {
+	unsigned int mask[CPU_SET_MAX / CPU_SET_WORD_BITS];
+} cpu_set_t;
+
+/** Remove all CPUs from the set. */
+static inline void cpu_set_zero(cpu_set_t *set)
+{
+	for (unsigned int i = 0; i < CPU_SET_MAX / CPU_SET_WORD_BITS; i++)
+		set->mask[i] = 0;
+}
+
+/** Add CPU to the set. */
+static inline void cpu_set_add(cpu_set_t *set, unsigned int cpu)
+{
+	if (cpu < CPU_SET_MAX)
+		set->mask[cpu / CPU_SET_WORD_BITS] |= 1U << (cpu % CPU_SET_WORD_BITS);
+}
+
+/** Remove CPU from the set. */
+static inline void cpu_set_remove(cpu_set_t *set, unsigned int cpu)
+{
+	if (cpu < CPU_SET_MAX)
+		set->mask[cpu / CPU_SET_WORD_BITS] &= ~(1U << (cpu % CPU_SET_WORD_BITS));
+}
+
+/** Check whether the set contains a CPU. */
+static inline bool cpu_set_contains(const cpu_set_t *set, unsigned int cpu)
+{
+	if (cpu >= CPU_SET_MAX)
+		return false;
+
+	return (set->mask[cpu / CPU_SET_WORD_BITS] &
+	    (1U << (cpu % CPU_SET_WORD_BITS))) != 0;
+}
+
+extern errno_t thread_set_affinity(const cpu_set_t *);
+extern errno_t thread_get_affinity(cpu_set_t *);
+
+#endif
+
+/** @}
+ */
@@ -101,9 +101,51 @@ typedef enum {
 /** Forward declarations */
 struct async_exch;
 struct async_sess;
+struct async_wait_set;
 
 typedef struct async_sess async_sess_t;
 typedef struct async_exch async_exch_t;
+typedef struct async_wait_set async_wait_set_t;
+
+/** What async_exchange_begin() does when the exchange pool is exhausted */
+typedef enum {
+	/** Wait until another exchange of the session ends */
+	ASYNC_POOL_WAIT = 0,
+	/** Fail the exchange immediately */
+	ASYNC_POOL_FAIL
+} async_pool_exhausted_t;
+
+/** Configuration of the pool of data phones of a parallel session */
+typedef struct {
+	/** Number of phones kept open even when idle */
+	size_t min_phones;
+	/** Maximum number of phones, zero for the server's preference */
+	size_t max_phones;
+	/** Idle phones above min_phones are closed after this time, zero never */
+	usec_t idle_timeout;
+	/** Behaviour when max_phones exchanges are in progress */
+	async_pool_exhausted_t exhausted;
+} async_pool_config_t;
+
+/** Statistics of the exchange pool of a session */
+typedef struct {
+	/** Exchanges served by an idle exchange */
+	uint64_t hits;
+	/** Exchanges that needed a new exchange */
+	uint64_t misses;
+	/** Exchanges that had to wait for another one to end */
+	uint64_t waits;
+	/** Exchanges that failed because the pool was exhausted */
+	uint64_t failures;
+	/** Total time spent waiting, in microseconds */
+	usec_t wait_time;
+	/** Number of open data phones */
+	size_t phones;
+	/** Number of exchanges in progress */
+	size_t active;
+	/** Concurrency preferred by the server, zero if not advertised */
+	size_t preferred;
+} async_pool_stats_t;
 
 extern __noreturn void async_manager(void);
 
@@ -120,11 +162,19 @@ extern aid_t async_send_4(async_exch_t *, sysarg_t, sysarg_t, sysarg_t,
     sysarg_t, sysarg_t, ipc_call_t *);
 extern aid_t async_send_5(async_exch_t *, sysarg_t, sysarg_t, sysarg_t,
     sysarg_t, sysarg_t, sysarg_t, ipc_call_t *);
+extern errno_t async_send_batch(async_exch_t *, ipc_call_t *, size_t, aid_t *);
 
 extern void async_wait_for(aid_t, errno_t *);
 extern errno_t async_wait_timeout(aid_t, errno_t *, usec_t);
 extern void async_forget(aid_t);
 
+extern async_wait_set_t *async_wait_set_create(void);
+extern void async_wait_set_destroy(async_wait_set_t *);
+extern errno_t async_wait_set_add(async_wait_set_t *, aid_t);
+extern errno_t async_wait_any(async_wait_set_t *, aid_t *, errno_t *);
+extern size_t async_wait_some(async_wait_set_t *, aid_t *, errno_t *, size_t);
+extern size_t async_wait_poll(async_wait_set_t *, aid_t *, errno_t *, size_t);
+
 extern void async_set_client_data_constructor(async_client_data_ctor_t);
 extern void async_set_client_data_destructor(async_client_data_dtor_t);
 extern void *async_get_client_data(void);
@@ -271,6 +321,7 @@ extern errno_t async_req_5_5(async_exch_t *, sysarg_t, sysarg_t, sysarg_t,
     sysarg_t *, sysarg_t *);
 
 extern errno_t async_accept_0(ipc_call_t *);
+extern void async_set_preferred_concurrency(size_t);
 extern sysarg_t async_get_label(void);
 
 extern async_sess_t *async_connect_me_to(async_exch_t *, iface_t, sysarg_t,
@@ -278,10 +329,14 @@ extern async_sess_t *async_connect_me_to(async_exch_t *, iface_t, sysarg_t,
 extern async_sess_t *async_connect_me_to_blocking(async_exch_t *, iface_t,
     sysarg_t, sysarg_t, errno_t *);
 extern async_sess_t *async_connect_kbox(task_id_t, errno_t *);
+extern errno_t async_sess_pool_set(async_sess_t *,
+    const async_pool_config_t *);
+extern void async_sess_pool_stats(async_sess_t *, async_pool_stats_t *);
 
 extern errno_t async_connect_to_me(async_exch_t *, iface_t, sysarg_t, sysarg_t);
 
 extern void async_hangup(async_sess_t *);
+extern errno_t async_sess_ring_enable(async_sess_t *);
 
 extern async_exch_t *async_exchange_begin(async_sess_t *);
 extern void async_exchange_end(async_exch_t *);
@@ -310,6 +365,7 @@ extern errno_t async_share_in_finalize(ipc_call_t *, void *, unsigned int);
 extern errno_t async_share_out_start(async_exch_t *, void *, unsigned int);
 extern bool async_share_out_receive(ipc_call_t *, size_t *, unsigned int *);
 extern errno_t async_share_out_finalize(ipc_call_t *, void **);
+extern errno_t async_share_out_finalize_cow(ipc_call_t *, void **);
 
 extern errno_t async_data_read_forward_0_0(async_exch_t *, sysarg_t);
 extern errno_t async_data_read_forward_1_0(async_exch_t *, sysarg_t, sysarg_t);
@@ -356,6 +412,8 @@ extern errno_t async_data_write_forward_3_1(async_exch_t *, sysarg_t, sysarg_t,
 extern errno_t async_data_write_forward_4_1(async_exch_t *, sysarg_t, sysarg_t,
     sysarg_t, sysarg_t, sysarg_t, ipc_call_t *);
 
+extern aid_t async_data_write(async_exch_t *, const void *, size_t,
+    ipc_call_t *);
 extern errno_t async_data_write_start(async_exch_t *, const void *, size_t);
 extern bool async_data_write_receive(ipc_call_t *, size_t *);
 extern errno_t async_data_write_finalize(ipc_call_t *, void *, size_t);
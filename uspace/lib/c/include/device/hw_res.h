@@ -55,6 +55,8 @@ typedef enum {
 	HW_RES_CLEAR_INTERRUPT,
 	HW_RES_DMA_CHANNEL_SETUP,
 	HW_RES_DMA_CHANNEL_REMAIN,
+	HW_RES_MSI_ALLOC,
+	HW_RES_MSI_FREE,
 } hw_res_method_t;
 
 /** HW resource types */
@@ -123,6 +125,8 @@ extern errno_t hw_res_clear_interrupt(async_sess_t *, int);
 extern errno_t hw_res_dma_channel_setup(async_sess_t *, unsigned int, uint32_t,
     uint32_t, uint8_t);
 extern errno_t hw_res_dma_channel_remain(async_sess_t *, unsigned, size_t *);
+extern errno_t hw_res_msi_alloc(async_sess_t *, size_t, int *, size_t *);
+extern errno_t hw_res_msi_free(async_sess_t *);
 
 #endif
 
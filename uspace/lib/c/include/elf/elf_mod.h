@@ -38,6 +38,7 @@
 #define ELF_MOD_H_
 
 #include <elf/elf.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <loader/pcb.h>
@@ -94,6 +95,9 @@ typedef struct {
 	/** Flags passed to the ELF loader. */
 	eld_flags_t flags;
 
+	/** Some segments are mapped from the file, which must stay open. */
+	bool mapped;
+
 	/** Store extracted info here */
 	elf_finfo_t *info;
 } elf_ld_t;
@@ -67,6 +67,8 @@ extern void fibril_sleep(sec_t);
 
 extern void fibril_enable_multithreaded(void);
 extern int fibril_test_spawn_runners(int);
+extern int fibril_set_runners(int);
+extern size_t fibril_stack_pool_set_limit(size_t);
 
 extern void fibril_detach(fid_t fid);
 
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Heap profiler.
+ */
+
+#ifndef _LIBC_HEAP_PROFILE_H_
+#define _LIBC_HEAP_PROFILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Maximum number of return addresses recorded per call site */
+#define HEAP_PROFILE_DEPTH  8
+
+/** Number of call sites the heap profiler can distinguish */
+#define HEAP_PROFILE_SITES  256
+
+/** Heap profile of one call site
+ *
+ * The byte counts are estimates scaled by the sampling interval.
+ */
+typedef struct {
+	/** Return addresses, innermost first, zero-terminated if shorter */
+	uintptr_t trace[HEAP_PROFILE_DEPTH];
+
+	/** Number of sampled allocations (zero if the record is unused) */
+	size_t samples;
+
+	/** Bytes allocated from this site and not freed yet */
+	size_t live;
+
+	/** Bytes ever allocated from this site */
+	size_t total;
+} heap_profile_site_t;
+
+extern void heap_profile_start(size_t);
+extern void heap_profile_stop(void);
+extern void heap_profile_dump(void);
+
+#endif
+
+/** @}
+ */
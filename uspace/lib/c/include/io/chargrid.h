@@ -59,6 +59,8 @@ typedef struct {
 	char_attrs_t attrs;     /**< Current attributes */
 
 	sysarg_t top_row;       /**< The first row in the cyclic buffer */
+	sysarg_t dirty_top;     /**< First dirty row */
+	sysarg_t dirty_bottom;  /**< Row after the last dirty row */
 	charfield_t data[];     /**< Screen contents (cyclic buffer) */
 } chargrid_t;
 
@@ -86,6 +88,10 @@ extern sysarg_t chargrid_backspace(chargrid_t *);
 extern void chargrid_clear(chargrid_t *);
 extern void chargrid_clear_row(chargrid_t *, sysarg_t);
 
+extern void chargrid_set_dirty(chargrid_t *, sysarg_t, sysarg_t);
+extern bool chargrid_get_dirty(chargrid_t *, sysarg_t *, sysarg_t *);
+extern void chargrid_clear_dirty(chargrid_t *);
+
 extern void chargrid_set_cursor(chargrid_t *, sysarg_t, sysarg_t);
 extern void chargrid_set_cursor_visibility(chargrid_t *, bool);
 extern bool chargrid_get_cursor_visibility(chargrid_t *);
@@ -45,6 +45,8 @@
 
 extern errno_t klog_write(log_level_t, const void *, size_t);
 extern errno_t klog_read(void *, size_t, size_t *);
+extern errno_t klog_bootmark(const char *, ...)
+    _HELENOS_PRINTF_ATTRIBUTE(1, 2);
 
 #define KLOG_PRINTF(lvl, fmt, ...) ({ \
 	char *_s; \
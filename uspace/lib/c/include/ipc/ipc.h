@@ -46,6 +46,8 @@
 #include <abi/cap.h>
 
 extern errno_t ipc_wait(ipc_call_t *, sysarg_t, unsigned int);
+extern errno_t ipc_wait_multi(ipc_call_t *, size_t, sysarg_t, unsigned int,
+    size_t *);
 extern void ipc_poke(void);
 
 /*
@@ -102,6 +104,7 @@ extern errno_t ipc_call_async_fast(cap_phone_handle_t, sysarg_t, sysarg_t,
     sysarg_t, sysarg_t, void *);
 extern errno_t ipc_call_async_slow(cap_phone_handle_t, sysarg_t, sysarg_t,
     sysarg_t, sysarg_t, sysarg_t, sysarg_t, void *);
+extern errno_t ipc_call_async_batch(const ipc_call_t *, size_t, size_t *);
 
 extern errno_t ipc_hangup(cap_phone_handle_t);
 
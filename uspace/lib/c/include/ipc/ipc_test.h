@@ -42,7 +42,8 @@ typedef enum {
 	IPC_TEST_GET_RO_AREA_SIZE,
 	IPC_TEST_GET_RW_AREA_SIZE,
 	IPC_TEST_SHARE_IN_RO,
-	IPC_TEST_SHARE_IN_RW
+	IPC_TEST_SHARE_IN_RW,
+	IPC_TEST_WRITE
 } ipc_test_request_t;
 
 #endif
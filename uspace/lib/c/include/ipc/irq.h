@@ -42,6 +42,11 @@
 extern errno_t ipc_irq_subscribe(int, sysarg_t, const irq_code_t *,
     cap_irq_handle_t *);
 extern errno_t ipc_irq_unsubscribe(cap_irq_handle_t);
+extern errno_t irq_msi_alloc(size_t, irq_msi_t *);
+extern errno_t irq_msi_free(int, size_t);
+extern errno_t irq_affinity_set(int, unsigned int);
+extern errno_t irq_affinity_get(int, unsigned int *);
+extern errno_t irq_affinity_wire(int);
 
 #endif
 
@@ -45,9 +45,22 @@ typedef enum {
 	LOADER_SET_ARGS,
 	LOADER_ADD_INBOX,
 	LOADER_LOAD,
-	LOADER_RUN
+	LOADER_RUN,
+	LOADER_SPAWN
 } loader_request_t;
 
+/*
+ * LOADER_SPAWN carries the number of inbox entries in the first argument.
+ * Its data are null-terminated strings: the current working directory,
+ * the program name, the names of the inbox entries and the program
+ * arguments, which extend up to the end of the data. After the data,
+ * the program file handle and the inbox entry handles are passed.
+ * The answer carries the ID of the new task.
+ */
+
+/** Largest accepted size of the LOADER_SPAWN data */
+#define LOADER_SPAWN_MAX_SIZE  (64 * 1024)
+
 #endif
 
 /** @}
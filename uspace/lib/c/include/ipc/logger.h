@@ -34,6 +34,8 @@
 #define _LIBC_IPC_LOGGER_H_
 
 #include <ipc/common.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 typedef enum {
 	/** Set (global) default displayed logging level.
@@ -71,9 +73,67 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: string with the message.
 	 */
-	LOGGER_WRITER_MESSAGE
+	LOGGER_WRITER_MESSAGE,
+	/** Share a message ring with the logger.
+	 *
+	 * Returns: error code
+	 * Followed by: IPC_M_SHARE_OUT of a logger_ring_t area.
+	 */
+	LOGGER_WRITER_RING_SHARE,
+	/** Wake up the logger waiting for messages in the ring.
+	 *
+	 * Returns: error code
+	 */
+	LOGGER_WRITER_RING_KICK
 } logger_writer_request_t;
 
+/** Size of the message buffer of logger_ring_t. Must be a power of two. */
+#define LOGGER_RING_SIZE  (32 * 1024)
+
+/** Number of logs of one client whose levels are published in the ring. */
+#define LOGGER_RING_LOGS  100
+
+/** Level of a log of the client, published by the logger. */
+typedef struct {
+	/** Log id, 0 if the entry is not used yet. */
+	atomic_uintptr_t log;
+	/** Most verbose level the logger writes to the log. */
+	atomic_uint level;
+} logger_ring_log_t;
+
+/** Message in the ring, followed by the NUL-terminated text.
+ *
+ * Records are aligned to sizeof(sysarg_t) and never wrap around the end
+ * of the buffer. A record with log 0 is padding, so is a tail of the
+ * buffer too short to hold a header.
+ */
+typedef struct {
+	sysarg_t log;
+	uint32_t level;
+	/** Size of the record including the header and the padding. */
+	uint32_t size;
+} logger_ring_msg_t;
+
+/** Layout of the area a client shares with the logger.
+ *
+ * The client produces messages into the buffer without waiting for the
+ * logger and drops them when the buffer is full. It sends
+ * LOGGER_WRITER_RING_KICK only when the logger announced it is sleeping.
+ */
+typedef struct {
+	/** Bytes consumed by the logger, written by the logger. */
+	atomic_size_t head;
+	/** Bytes produced by the client, written by the client. */
+	atomic_size_t tail;
+	/** The logger waits for LOGGER_WRITER_RING_KICK. */
+	atomic_bool sleeping;
+	/** Messages dropped because the buffer was full. */
+	atomic_size_t dropped;
+	/** Levels of the logs of the client, written by the logger. */
+	logger_ring_log_t logs[LOGGER_RING_LOGS];
+	uint8_t buffer[LOGGER_RING_SIZE];
+} logger_ring_t;
+
 #endif
 
 /** @}
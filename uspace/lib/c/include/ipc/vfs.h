@@ -61,6 +61,8 @@ typedef struct {
 	unsigned int instance;
 	bool concurrent_read_write;
 	bool write_retains_size;
+	/** File contents may be kept in the VFS page cache. */
+	bool cacheable;
 } vfs_info_t;
 
 /** Data returned by filesystem probe regarding a specific volume. */
@@ -70,13 +72,16 @@ typedef struct {
 } vfs_fs_probe_info_t;
 
 typedef enum {
-	VFS_IN_CLONE = IPC_FIRST_USER_METHOD,
+	VFS_IN_BUFFER = IPC_FIRST_USER_METHOD,
+	VFS_IN_CACHE_STATS,
+	VFS_IN_CLONE,
 	VFS_IN_FSPROBE,
 	VFS_IN_FSTYPES,
 	VFS_IN_MOUNT,
 	VFS_IN_OPEN,
 	VFS_IN_PUT,
 	VFS_IN_READ,
+	VFS_IN_READ_BUFFER,
 	VFS_IN_REGISTER,
 	VFS_IN_RENAME,
 	VFS_IN_RESIZE,
@@ -88,6 +93,7 @@ typedef enum {
 	VFS_IN_WAIT_HANDLE,
 	VFS_IN_WALK,
 	VFS_IN_WRITE,
+	VFS_IN_WRITE_BUFFER,
 } vfs_in_request_t;
 
 typedef enum {
@@ -189,6 +195,25 @@ enum {
 	MODE_APPEND = 4,
 };
 
+/*
+ * Pager flags, passed as the second pager identifier (after the file handle)
+ * to async_as_area_create(). The third identifier is the page-aligned offset
+ * in the file at which the area starts.
+ */
+enum {
+	/**
+	 * Map the frames of the VFS page cache directly instead of private
+	 * copies. Only suitable for read-only areas, such as program text.
+	 */
+	VFS_PAGER_SHARED = 1,
+	/**
+	 * Map the frames of the VFS page cache directly and write modified
+	 * pages back to the file on as_area_sync() and when the area is
+	 * destroyed. The file must be open for writing.
+	 */
+	VFS_PAGER_WRITEBACK = 2,
+};
+
 #endif
 
 /** @}
@@ -37,6 +37,7 @@
 #define _LIBC_LOADER_H_
 
 #include <abi/proc/task.h>
+#include <stddef.h>
 
 /** Forward declararion */
 struct loader;
@@ -50,6 +51,8 @@ extern errno_t loader_set_program(loader_t *, const char *, int);
 extern errno_t loader_set_program_path(loader_t *, const char *);
 extern errno_t loader_set_args(loader_t *, const char *const[]);
 extern errno_t loader_add_inbox(loader_t *, const char *, int);
+extern errno_t loader_prepare(loader_t *, const char *, const char *const[],
+    size_t, const char *const[], const int[], task_id_t *);
 extern errno_t loader_load_program(loader_t *);
 extern errno_t loader_run(loader_t *);
 extern void loader_run_nowait(loader_t *);
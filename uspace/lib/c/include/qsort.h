@@ -47,6 +47,8 @@ __C_DECLS_END;
 __HELENOS_DECLS_BEGIN;
 extern void qsort_r(void *, size_t, size_t, int (*)(const void *,
     const void *, void *), void *);
+extern void qsort_parallel(void *, size_t, size_t, int (*)(const void *,
+    const void *, void *), void *);
 __HELENOS_DECLS_END;
 #endif
 
@@ -68,6 +68,8 @@ typedef struct dyn_info {
 
 	/** Hash table */
 	elf_word *hash;
+	/** GNU-style hash table with Bloom filter (or @c NULL) */
+	elf_word *gnu_hash;
 
 	/** String table */
 	char *str_tab;
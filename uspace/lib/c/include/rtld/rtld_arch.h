@@ -38,7 +38,11 @@
 #include <rtld/rtld.h>
 #include <loader/pcb.h>
 
+/** Name of the lazy PLT resolver trampoline exported by libc */
+#define RTLD_PLT_TRAMPOLINE "__rtld_plt_trampoline"
+
 void module_process_pre_arch(module_t *m);
+bool plt_lazy_setup_arch(module_t *m);
 
 void rel_table_process(module_t *m, elf_rel_t *rt, size_t rt_size);
 void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size);
@@ -37,6 +37,7 @@
 #define _LIBC_STACKTRACE_H_
 
 #include <errno.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -55,6 +56,7 @@ extern void stacktrace_kio_print(void);
 extern void stacktrace_print_fp_pc(uintptr_t, uintptr_t);
 extern void stacktrace_print_generic(stacktrace_ops_t *, void *, uintptr_t,
     uintptr_t);
+extern size_t stacktrace_capture(uintptr_t *, size_t, size_t);
 
 /*
  * The following interface is to be implemented by each architecture.
@@ -45,17 +45,25 @@
 
 extern stats_cpu_t *stats_get_cpus(size_t *);
 extern stats_physmem_t *stats_get_physmem(void);
+extern stats_tlb_t *stats_get_tlb(void);
 extern load_t *stats_get_load(size_t *);
 
 extern stats_task_t *stats_get_tasks(size_t *);
 extern stats_task_t *stats_get_task(task_id_t);
+extern stats_task_t *stats_get_tasks_delta(const stats_task_t *, size_t,
+    uint64_t *, size_t *);
 
 extern stats_thread_t *stats_get_threads(size_t *);
+extern stats_thread_t *stats_get_threads_delta(const stats_thread_t *,
+    size_t, uint64_t *, size_t *);
 extern stats_ipcc_t *stats_get_ipccs(size_t *);
 
 extern stats_exc_t *stats_get_exceptions(size_t *);
 extern stats_exc_t *stats_get_exception(unsigned int);
 
+extern stats_lock_t *stats_get_locks(size_t *);
+extern stats_slab_t *stats_get_slabs(size_t *);
+
 extern void stats_print_load_fragment(load_t, unsigned int);
 extern const char *thread_get_state(state_t);
 
@@ -217,6 +217,18 @@ extern int fileno(FILE *);
 extern int fseek64(FILE *, off64_t, int);
 extern off64_t ftell64(FILE *);
 
+/** Stream kinds with a separately configurable default buffer size */
+typedef enum {
+	/** Files opened with fopen() or fdopen() */
+	STDIO_STREAM_FILE,
+	/** Line-buffered standard output */
+	STDIO_STREAM_TERM,
+	/** Number of stream kinds */
+	STDIO_STREAM_LIMIT
+} stdio_stream_kind_t;
+
+extern size_t stdio_bufsize_set(stdio_stream_kind_t, size_t);
+
 __HELENOS_DECLS_END;
 #endif
 
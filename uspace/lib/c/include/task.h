@@ -39,6 +39,7 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <abi/proc/task.h>
+#include <abi/mm/numa.h>
 #include <async.h>
 #include <types/task.h>
 
@@ -52,6 +53,7 @@ typedef struct _TASK task_t;
 
 extern task_id_t task_get_id(void);
 extern errno_t task_set_name(const char *);
+extern errno_t task_set_numa_policy(numa_policy_t, unsigned int);
 extern errno_t task_kill(task_id_t);
 
 extern errno_t task_spawnv(task_id_t *, task_wait_t *, const char *path,
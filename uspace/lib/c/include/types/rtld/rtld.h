@@ -37,11 +37,35 @@
 
 #include <adt/list.h>
 #include <elf/elf_mod.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include <types/rtld/module.h>
 
+/** Number of entries in the resolved symbol cache (power of two) */
+#define RTLD_SYMCACHE_SIZE 256
+
+/** Resolved symbol cache entry.
+ *
+ * Caches the result of searching the global module scope for a symbol
+ * so that relocations referring to the same symbol from different
+ * places (or different modules) do not repeat the search.
+ */
+typedef struct {
+	/** Symbol name (points into the string table of a loaded module) */
+	const char *name;
+	/** GNU hash of @c name */
+	uint32_t hash;
+	/** Search flags the entry was resolved with */
+	unsigned flags;
+	/** Module containing the definition */
+	module_t *mod;
+	/** Symbol definition or @c NULL if the entry is empty */
+	elf_symbol_t *sym;
+} rtld_symcache_entry_t;
+
 typedef struct rtld {
 	elf_dyn_t *rtld_dynamic;
 	module_t rtld;
@@ -60,6 +84,18 @@ typedef struct rtld {
 
 	/** List of initial modules */
 	list_t imodules;
+
+	/** Resolved symbol cache, flushed when the module list changes */
+	rtld_symcache_entry_t symcache[RTLD_SYMCACHE_SIZE];
+	/** Protects @c symcache against concurrent lazy PLT resolution */
+	atomic_flag symcache_lock;
+
+	/** Resolve all PLT entries eagerly (program linked with -z now) */
+	bool bind_now;
+	/** Address of the lazy PLT resolver trampoline or zero */
+	uintptr_t plt_trampoline;
+	/** Module containing the trampoline (always bound eagerly) */
+	module_t *plt_trampoline_mod;
 } rtld_t;
 
 #endif
@@ -52,6 +52,7 @@ extern errno_t udebug_name_read(async_sess_t *, void *, size_t, size_t *,
 extern errno_t udebug_areas_read(async_sess_t *, void *, size_t, size_t *,
     size_t *);
 extern errno_t udebug_mem_read(async_sess_t *, void *, uintptr_t, size_t);
+extern errno_t udebug_word_write(async_sess_t *, uintptr_t, sysarg_t);
 extern errno_t udebug_args_read(async_sess_t *, thash_t, sysarg_t *);
 extern errno_t udebug_regs_read(async_sess_t *, thash_t, void *);
 extern errno_t udebug_go(async_sess_t *, thash_t, udebug_event_t *, sysarg_t *,
@@ -64,11 +64,26 @@ typedef struct {
 	service_id_t service;
 } vfs_stat_t;
 
+/** Block cache statistics of a mounted file system */
+typedef struct {
+	/** Lookups served by a cached block */
+	uint64_t hits;
+	/** Lookups which had to read the block */
+	uint64_t misses;
+	/** Blocks read ahead */
+	uint64_t ra_blocks;
+	/** Blocks read ahead and then used */
+	uint64_t ra_used;
+	/** Blocks read ahead and recycled before being used */
+	uint64_t ra_wasted;
+} vfs_block_stats_t;
+
 typedef struct {
 	char fs_name[FS_NAME_MAXLEN + 1];
 	uint32_t f_bsize;    /* fundamental file system block size */
 	uint64_t f_blocks;   /* total data blocks in file system */
 	uint64_t f_bfree;    /* free blocks in fs */
+	vfs_block_stats_t f_cache; /* block cache statistics, zero if none */
 } vfs_statfs_t;
 
 /** List of file system types */
@@ -78,9 +93,65 @@ typedef struct {
 	size_t size;
 } vfs_fstypes_t;
 
+/** Buffer descriptor for vectored I/O */
+typedef struct {
+	/** Start of the buffer */
+	void *base;
+	/** Size of the buffer in bytes */
+	size_t size;
+} vfs_iovec_t;
+
+/** Caches maintained by VFS */
+typedef enum {
+	/** Contents of regular files */
+	VFS_PAGE_CACHE,
+	/** Results of path component lookups */
+	VFS_NAME_CACHE
+} vfs_cache_t;
+
+/** VFS cache statistics */
+typedef struct {
+	/** Lookups served from the cache */
+	size_t hits;
+	/** Lookups that had to ask the file system */
+	size_t misses;
+	/** Entries dropped to make room for new ones */
+	size_t evictions;
+	/** Entries dropped because the file system was modified */
+	size_t invalidations;
+	/** Entries currently resident */
+	size_t entries;
+} vfs_cache_stats_t;
+
+/** Asynchronous I/O queue */
+typedef struct vfs_aio_queue vfs_aio_queue_t;
+
+/** Asynchronous I/O request */
+typedef struct vfs_aio vfs_aio_t;
+
+/** Completion of an asynchronous I/O request */
+typedef struct {
+	/** The completed request, no longer valid */
+	vfs_aio_t *aio;
+	/** Argument given when the request was submitted */
+	void *arg;
+	/** Result of the request */
+	errno_t rc;
+	/** Number of bytes transferred */
+	size_t nbytes;
+} vfs_aio_result_t;
+
 extern errno_t vfs_fhandle(FILE *, int *);
 
 extern char *vfs_absolutize(const char *, size_t *);
+extern errno_t vfs_aio_cancel(vfs_aio_queue_t *, vfs_aio_t *);
+extern errno_t vfs_aio_poll(vfs_aio_queue_t *, vfs_aio_result_t *);
+extern errno_t vfs_aio_queue_create(size_t, vfs_aio_queue_t **);
+extern void vfs_aio_queue_destroy(vfs_aio_queue_t *);
+extern errno_t vfs_aio_wait(vfs_aio_queue_t *, vfs_aio_result_t *);
+extern errno_t vfs_buffer_register(int, void *);
+extern errno_t vfs_buffer_unregister(int);
+extern errno_t vfs_cache_stats(vfs_cache_t, vfs_cache_stats_t *);
 extern errno_t vfs_clone(int, int, bool, int *);
 extern errno_t vfs_cwd_get(char *path, size_t);
 extern errno_t vfs_cwd_set(const char *path);
@@ -101,7 +172,12 @@ extern errno_t vfs_open(int, int);
 extern errno_t vfs_pass_handle(async_exch_t *, int, async_exch_t *);
 extern errno_t vfs_put(int);
 extern errno_t vfs_read(int, aoff64_t *, void *, size_t, size_t *);
+extern errno_t vfs_read_async(vfs_aio_queue_t *, int, aoff64_t, void *, size_t,
+    void *, vfs_aio_t **);
+extern errno_t vfs_read_buffer(int, aoff64_t *, size_t, size_t *);
 extern errno_t vfs_read_short(int, aoff64_t, void *, size_t, ssize_t *);
+extern errno_t vfs_readv(int, aoff64_t *, const vfs_iovec_t *, size_t,
+    size_t *);
 extern errno_t vfs_receive_handle(bool, int *);
 extern errno_t vfs_rename_path(const char *, const char *);
 extern errno_t vfs_resize(int, aoff64_t);
@@ -118,7 +194,12 @@ extern errno_t vfs_unmount(int);
 extern errno_t vfs_unmount_path(const char *);
 extern errno_t vfs_walk(int, const char *, int, int *);
 extern errno_t vfs_write(int, aoff64_t *, const void *, size_t, size_t *);
+extern errno_t vfs_write_async(vfs_aio_queue_t *, int, aoff64_t, const void *,
+    size_t, void *, vfs_aio_t **);
+extern errno_t vfs_write_buffer(int, aoff64_t *, size_t, size_t *);
 extern errno_t vfs_write_short(int, aoff64_t, const void *, size_t, ssize_t *);
+extern errno_t vfs_writev(int, aoff64_t *, const vfs_iovec_t *, size_t,
+    size_t *);
 
 #endif
 
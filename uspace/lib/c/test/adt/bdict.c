@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/bdict.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+enum {
+	/** Length of test number sequences, enough for a three-level tree */
+	test_seq_len = 2000
+};
+
+/** Values stored in the dictionary, the value for key i is &values[i] */
+static int values[test_seq_len];
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(bdict);
+
+/** Increasing sequence test.
+ *
+ * Test initialization, emptiness, insertion of increasing sequence and walking.
+ */
+PCUT_TEST(incr_seq)
+{
+	bdict_t bdict;
+	bdict_cursor_t cursor;
+	int *v;
+	int i;
+
+	bdict_initialize(&bdict);
+	PCUT_ASSERT_TRUE(bdict_empty(&bdict));
+
+	for (i = 0; i < test_seq_len; i++) {
+		PCUT_ASSERT_ERRNO_VAL(EOK, bdict_insert(&bdict, i, &values[i]));
+		PCUT_ASSERT_ERRNO_VAL(EOK, bdict_validate(&bdict));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, bdict_count(&bdict));
+
+	i = 0;
+	v = bdict_first(&bdict, &cursor);
+	while (v != NULL) {
+		PCUT_ASSERT_EQUALS(&values[i], v);
+		PCUT_ASSERT_INT_EQUALS(i, bdict_cursor_key(&cursor));
+		v = bdict_next(&cursor);
+		++i;
+	}
+	PCUT_ASSERT_INT_EQUALS(test_seq_len, i);
+
+	v = bdict_last(&bdict, &cursor);
+	while (v != NULL) {
+		--i;
+		PCUT_ASSERT_EQUALS(&values[i], v);
+		v = bdict_prev(&cursor);
+	}
+	PCUT_ASSERT_INT_EQUALS(0, i);
+
+	PCUT_ASSERT_ERRNO_VAL(EEXIST, bdict_insert(&bdict, 5, &values[5]));
+
+	bdict_finalize(&bdict);
+}
+
+/** Removal test.
+ *
+ * Insert keys in scattered order, then remove every other one.
+ */
+PCUT_TEST(remove)
+{
+	bdict_t bdict;
+	int i, key;
+
+	bdict_initialize(&bdict);
+
+	for (i = 0; i < test_seq_len; i++) {
+		key = (i * 7) % test_seq_len;
+		PCUT_ASSERT_ERRNO_VAL(EOK, bdict_insert(&bdict, key,
+		    &values[key]));
+	}
+
+	for (i = 0; i < test_seq_len; i += 2) {
+		PCUT_ASSERT_EQUALS(&values[i], bdict_remove(&bdict, i));
+		PCUT_ASSERT_ERRNO_VAL(EOK, bdict_validate(&bdict));
+	}
+
+	PCUT_ASSERT_NULL(bdict_remove(&bdict, 0));
+	PCUT_ASSERT_INT_EQUALS(test_seq_len / 2, bdict_count(&bdict));
+
+	for (i = 0; i < test_seq_len; i++) {
+		if (i % 2 == 0)
+			PCUT_ASSERT_NULL(bdict_find_eq(&bdict, i, NULL));
+		else
+			PCUT_ASSERT_EQUALS(&values[i], bdict_find_eq(&bdict, i,
+			    NULL));
+	}
+
+	for (i = 1; i < test_seq_len; i += 2)
+		PCUT_ASSERT_EQUALS(&values[i], bdict_remove(&bdict, i));
+
+	PCUT_ASSERT_TRUE(bdict_empty(&bdict));
+	PCUT_ASSERT_NULL(bdict_first(&bdict, NULL));
+	PCUT_ASSERT_ERRNO_VAL(EOK, bdict_validate(&bdict));
+
+	bdict_finalize(&bdict);
+}
+
+/** Range search test. */
+PCUT_TEST(find_range)
+{
+	bdict_t bdict;
+	int i;
+
+	bdict_initialize(&bdict);
+
+	/* Even keys only */
+	for (i = 0; i < test_seq_len; i += 2)
+		PCUT_ASSERT_ERRNO_VAL(EOK, bdict_insert(&bdict, i, &values[i]));
+
+	for (i = 1; i < test_seq_len - 1; i += 2) {
+		PCUT_ASSERT_EQUALS(&values[i - 1], bdict_find_leq(&bdict, i,
+		    NULL));
+		PCUT_ASSERT_EQUALS(&values[i - 1], bdict_find_lt(&bdict, i,
+		    NULL));
+		PCUT_ASSERT_EQUALS(&values[i + 1], bdict_find_geq(&bdict, i,
+		    NULL));
+		PCUT_ASSERT_EQUALS(&values[i + 1], bdict_find_gt(&bdict, i,
+		    NULL));
+	}
+
+	PCUT_ASSERT_EQUALS(&values[4], bdict_find_leq(&bdict, 4, NULL));
+	PCUT_ASSERT_EQUALS(&values[2], bdict_find_lt(&bdict, 4, NULL));
+	PCUT_ASSERT_EQUALS(&values[4], bdict_find_geq(&bdict, 4, NULL));
+	PCUT_ASSERT_EQUALS(&values[6], bdict_find_gt(&bdict, 4, NULL));
+
+	PCUT_ASSERT_NULL(bdict_find_lt(&bdict, 0, NULL));
+	PCUT_ASSERT_NULL(bdict_find_gt(&bdict, test_seq_len, NULL));
+
+	bdict_finalize(&bdict);
+}
+
+PCUT_EXPORT(bdict);
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/checksum.h>
+#include <pcut/pcut.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+enum {
+	data_size = 1000
+};
+
+static uint8_t data[data_size];
+
+static void fill_data(void)
+{
+	for (size_t i = 0; i < data_size; i++)
+		data[i] = i * 7 + 3;
+}
+
+/** Standard check values of the CRC catalogue */
+PCUT_TEST(check_value)
+{
+	uint8_t check[] = "123456789";
+
+	PCUT_ASSERT_INT_EQUALS(0xcbf43926, compute_crc32(check, 9));
+	PCUT_ASSERT_INT_EQUALS(0xe3069283, compute_crc32c(check, 9));
+}
+
+/** Checksum of empty data is zero */
+PCUT_TEST(empty)
+{
+	PCUT_ASSERT_INT_EQUALS(0, compute_crc32(data, 0));
+	PCUT_ASSERT_INT_EQUALS(0, compute_crc32c(data, 0));
+}
+
+/** Checksum of a buffer long enough for the wide code paths */
+PCUT_TEST(long_buffer)
+{
+	fill_data();
+
+	PCUT_ASSERT_INT_EQUALS(0x17bc2a46, compute_crc32(data, data_size));
+	PCUT_ASSERT_INT_EQUALS(0xdd2edff7, compute_crc32c(data, data_size));
+}
+
+/** Chaining at any split point gives the same result as one call */
+PCUT_TEST(chaining)
+{
+	uint32_t crc;
+	uint32_t crc_c;
+
+	fill_data();
+
+	for (size_t split = 0; split <= 200; split++) {
+		crc = compute_crc32(data, split);
+		crc = compute_crc32_seed(data + split, data_size - split, crc);
+		PCUT_ASSERT_INT_EQUALS(0x17bc2a46, crc);
+
+		crc_c = compute_crc32c(data, split);
+		crc_c = compute_crc32c_seed(data + split, data_size - split,
+		    crc_c);
+		PCUT_ASSERT_INT_EQUALS(0xdd2edff7, crc_c);
+	}
+}
+
+PCUT_EXPORT(checksum);
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/hash_table.h>
+#include <adt/hash_table_oa.h>
+#include <pcut/pcut.h>
+#include <stdlib.h>
+
+/** Number of items inserted by the tests */
+#define TEST_ITEMS  5000
+
+/** Test item */
+typedef struct {
+	ht_link_t link;
+	size_t key;
+} test_item_t;
+
+static size_t test_hash(const ht_link_t *item)
+{
+	return hash_table_get_inst(item, test_item_t, link)->key;
+}
+
+static size_t test_key_hash(const void *key)
+{
+	return *(const size_t *) key;
+}
+
+static bool test_equal(const ht_link_t *a, const ht_link_t *b)
+{
+	return test_hash(a) == test_hash(b);
+}
+
+static bool test_key_equal(const void *key, const ht_link_t *item)
+{
+	return *(const size_t *) key == test_hash(item);
+}
+
+static hash_table_ops_t test_ops = {
+	.hash = test_hash,
+	.key_hash = test_key_hash,
+	.equal = test_equal,
+	.key_equal = test_key_equal,
+	.remove_callback = NULL
+};
+
+static bool count_item(ht_link_t *item, void *arg)
+{
+	++*(size_t *) arg;
+	return true;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(hash_table);
+
+/** Items stay reachable while the table grows and shrinks incrementally */
+PCUT_TEST(incremental_resize)
+{
+	hash_table_t h;
+	test_item_t *items;
+	size_t i, key, cnt;
+	bool rc;
+
+	items = calloc(TEST_ITEMS, sizeof(test_item_t));
+	PCUT_ASSERT_NOT_NULL(items);
+
+	rc = hash_table_create(&h, 0, 0, &test_ops);
+	PCUT_ASSERT_TRUE(rc);
+
+	for (i = 0; i < TEST_ITEMS; i++) {
+		items[i].key = i;
+		hash_table_insert(&h, &items[i].link);
+
+		/* Every item inserted so far must be found */
+		key = i / 2;
+		PCUT_ASSERT_EQUALS(&items[key].link, hash_table_find(&h, &key));
+	}
+
+	cnt = 0;
+	hash_table_apply(&h, count_item, &cnt);
+	PCUT_ASSERT_INT_EQUALS(TEST_ITEMS, cnt);
+
+	for (i = 0; i < TEST_ITEMS - 1; i++) {
+		key = i;
+		PCUT_ASSERT_INT_EQUALS(1, hash_table_remove(&h, &key));
+
+		key = TEST_ITEMS - 1;
+		PCUT_ASSERT_EQUALS(&items[key].link, hash_table_find(&h, &key));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(1, hash_table_size(&h));
+	hash_table_destroy(&h);
+	free(items);
+}
+
+/** Items with equal keys are all found using find_next */
+PCUT_TEST(oa_find_next)
+{
+	hash_table_oa_t h;
+	test_item_t items[10];
+	ht_link_t *first, *cur;
+	size_t i, key, cnt;
+	bool rc;
+
+	rc = hash_table_oa_create(&h, 0, &test_ops);
+	PCUT_ASSERT_TRUE(rc);
+
+	for (i = 0; i < 10; i++) {
+		items[i].key = i % 3;
+		rc = hash_table_oa_insert(&h, &items[i].link);
+		PCUT_ASSERT_TRUE(rc);
+	}
+
+	key = 1;
+	cnt = 0;
+	first = hash_table_oa_find(&h, &key);
+	for (cur = first; cur != NULL;
+	    cur = hash_table_oa_find_next(&h, first, cur)) {
+		PCUT_ASSERT_INT_EQUALS(1, test_hash(cur));
+		++cnt;
+	}
+
+	PCUT_ASSERT_INT_EQUALS(3, cnt);
+
+	rc = hash_table_oa_insert_unique(&h, &items[0].link);
+	PCUT_ASSERT_FALSE(rc);
+
+	key = 0;
+	PCUT_ASSERT_INT_EQUALS(4, hash_table_oa_remove(&h, &key));
+	PCUT_ASSERT_INT_EQUALS(6, hash_table_oa_size(&h));
+	hash_table_oa_destroy(&h);
+}
+
+/** Removals keep the remaining items reachable */
+PCUT_TEST(oa_insert_remove)
+{
+	hash_table_oa_t h;
+	test_item_t *items;
+	size_t i, key, cnt;
+	bool rc;
+
+	items = calloc(TEST_ITEMS, sizeof(test_item_t));
+	PCUT_ASSERT_NOT_NULL(items);
+
+	rc = hash_table_oa_create(&h, 0, &test_ops);
+	PCUT_ASSERT_TRUE(rc);
+
+	for (i = 0; i < TEST_ITEMS; i++) {
+		items[i].key = i;
+		rc = hash_table_oa_insert(&h, &items[i].link);
+		PCUT_ASSERT_TRUE(rc);
+	}
+
+	/* Remove every other item */
+	for (i = 0; i < TEST_ITEMS; i += 2)
+		hash_table_oa_remove_item(&h, &items[i].link);
+
+	for (i = 0; i < TEST_ITEMS; i++) {
+		key = i;
+		PCUT_ASSERT_EQUALS((i % 2 == 0) ? NULL : &items[i].link,
+		    hash_table_oa_find(&h, &key));
+	}
+
+	cnt = 0;
+	hash_table_oa_apply(&h, count_item, &cnt);
+	PCUT_ASSERT_INT_EQUALS(TEST_ITEMS / 2, cnt);
+
+	hash_table_oa_destroy(&h);
+	free(items);
+}
+
+PCUT_EXPORT(hash_table);
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/mpmc_ring.h>
+#include <adt/prodcons.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <pcut/pcut.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(mpmc_ring);
+
+enum {
+	/** Items pushed by each producer fibril */
+	items_per_producer = 2000,
+	/** Capacity of the ring used by the concurrent tests */
+	stress_capacity = 16
+};
+
+/** State shared by producers and consumers of a concurrent test */
+typedef struct {
+	mpmc_ring_t ring;
+	fibril_semaphore_t done;
+	atomic_uint_fast64_t sum;
+	atomic_size_t count;
+} stress_t;
+
+typedef struct {
+	stress_t *st;
+	size_t id;
+} stress_arg_t;
+
+/** Capacity is rounded up to a power of two, zero is rejected. */
+PCUT_TEST(initialize)
+{
+	mpmc_ring_t ring;
+	errno_t rc;
+
+	rc = mpmc_ring_initialize(&ring, 0, 0);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	rc = mpmc_ring_initialize(&ring, 5, 0);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(8, mpmc_ring_capacity(&ring));
+	mpmc_ring_destroy(&ring);
+
+	rc = mpmc_ring_initialize(&ring, 1, 0);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(2, mpmc_ring_capacity(&ring));
+	mpmc_ring_destroy(&ring);
+}
+
+/** Items come out in FIFO order, full and empty rings are detected. */
+PCUT_TEST(push_pop)
+{
+	mpmc_ring_t ring;
+	void *item;
+	uintptr_t i, lap;
+	errno_t rc;
+
+	rc = mpmc_ring_initialize(&ring, 8, 0);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_FALSE(mpmc_ring_try_pop(&ring, &item));
+
+	/* Several laps to exercise wrap-around of the sequence numbers */
+	for (lap = 0; lap < 5; lap++) {
+		for (i = 0; i < 8; i++)
+			PCUT_ASSERT_TRUE(mpmc_ring_try_push(&ring, (void *) i));
+
+		PCUT_ASSERT_FALSE(mpmc_ring_try_push(&ring, (void *) i));
+
+		for (i = 0; i < 8; i++) {
+			PCUT_ASSERT_TRUE(mpmc_ring_try_pop(&ring, &item));
+			PCUT_ASSERT_INT_EQUALS(i, (uintptr_t) item);
+		}
+
+		PCUT_ASSERT_FALSE(mpmc_ring_try_pop(&ring, &item));
+	}
+
+	mpmc_ring_destroy(&ring);
+}
+
+/** Batches are truncated to the free space or the number of items. */
+PCUT_TEST(batch)
+{
+	mpmc_ring_t ring;
+	void *in[10];
+	void *out[10];
+	uintptr_t i;
+	size_t n;
+	errno_t rc;
+
+	rc = mpmc_ring_initialize(&ring, 8, 0);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (i = 0; i < 10; i++)
+		in[i] = (void *) (i + 1);
+
+	n = mpmc_ring_push_batch(&ring, in, 3);
+	PCUT_ASSERT_INT_EQUALS(3, n);
+
+	n = mpmc_ring_push_batch(&ring, in + 3, 7);
+	PCUT_ASSERT_INT_EQUALS(5, n);
+
+	n = mpmc_ring_push_batch(&ring, in, 1);
+	PCUT_ASSERT_INT_EQUALS(0, n);
+
+	n = mpmc_ring_pop_batch(&ring, out, 2);
+	PCUT_ASSERT_INT_EQUALS(2, n);
+
+	n = mpmc_ring_pop_batch(&ring, out + 2, 10);
+	PCUT_ASSERT_INT_EQUALS(6, n);
+
+	for (i = 0; i < 8; i++)
+		PCUT_ASSERT_INT_EQUALS(i + 1, (uintptr_t) out[i]);
+
+	n = mpmc_ring_pop_batch(&ring, out, 10);
+	PCUT_ASSERT_INT_EQUALS(0, n);
+
+	mpmc_ring_destroy(&ring);
+}
+
+static errno_t producer_fn(void *arg)
+{
+	stress_arg_t *sa = (stress_arg_t *) arg;
+	uintptr_t base = sa->id * items_per_producer;
+	uintptr_t i;
+
+	/* Items are non-zero, zero tells consumers to terminate */
+	for (i = 1; i <= items_per_producer; i++)
+		mpmc_ring_push(&sa->st->ring, (void *) (base + i));
+
+	fibril_semaphore_up(&sa->st->done);
+	return EOK;
+}
+
+static errno_t consumer_fn(void *arg)
+{
+	stress_arg_t *sa = (stress_arg_t *) arg;
+	uintptr_t item;
+
+	while (true) {
+		item = (uintptr_t) mpmc_ring_pop(&sa->st->ring);
+		if (item == 0)
+			break;
+
+		atomic_fetch_add(&sa->st->sum, item);
+		atomic_fetch_add(&sa->st->count, 1);
+	}
+
+	fibril_semaphore_up(&sa->st->done);
+	return EOK;
+}
+
+/** Run @a np producers and @a nc consumers over a small blocking ring. */
+static void stress(size_t np, size_t nc)
+{
+	stress_t st;
+	stress_arg_t pa[8];
+	stress_arg_t ca[8];
+	uint64_t total;
+	uint64_t sum;
+	size_t i;
+	fid_t fid;
+	errno_t rc;
+
+	rc = mpmc_ring_initialize(&st.ring, stress_capacity,
+	    MPMC_RING_BLOCKING);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	fibril_semaphore_initialize(&st.done, 0);
+	atomic_init(&st.sum, 0);
+	atomic_init(&st.count, 0);
+
+	for (i = 0; i < nc; i++) {
+		ca[i].st = &st;
+		ca[i].id = i;
+		fid = fibril_create(consumer_fn, &ca[i]);
+		PCUT_ASSERT_NOT_NULL(fid);
+		fibril_add_ready(fid);
+	}
+
+	for (i = 0; i < np; i++) {
+		pa[i].st = &st;
+		pa[i].id = i;
+		fid = fibril_create(producer_fn, &pa[i]);
+		PCUT_ASSERT_NOT_NULL(fid);
+		fibril_add_ready(fid);
+	}
+
+	for (i = 0; i < np; i++)
+		fibril_semaphore_down(&st.done);
+
+	/* Terminate consumers */
+	for (i = 0; i < nc; i++)
+		mpmc_ring_push(&st.ring, NULL);
+
+	for (i = 0; i < nc; i++)
+		fibril_semaphore_down(&st.done);
+
+	total = np * items_per_producer;
+	sum = total * (total + 1) / 2;
+
+	PCUT_ASSERT_INT_EQUALS(total, atomic_load(&st.count));
+	PCUT_ASSERT_INT_EQUALS(sum, atomic_load(&st.sum));
+
+	mpmc_ring_destroy(&st.ring);
+}
+
+/** Every item is delivered exactly once with 1 to 8 producers/consumers. */
+PCUT_TEST(stress_1_1)
+{
+	stress(1, 1);
+}
+
+PCUT_TEST(stress_2_2)
+{
+	stress(2, 2);
+}
+
+PCUT_TEST(stress_4_1)
+{
+	stress(4, 1);
+}
+
+PCUT_TEST(stress_1_4)
+{
+	stress(1, 4);
+}
+
+PCUT_TEST(stress_8_8)
+{
+	stress(8, 8);
+}
+
+/** Bounded producer-consumer queue passes the links through. */
+PCUT_TEST(prodcons_bounded)
+{
+	prodcons_t pc;
+	link_t links[4];
+	errno_t rc;
+	int i;
+
+	rc = prodcons_initialize_bounded(&pc, 4);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (i = 0; i < 4; i++)
+		prodcons_produce(&pc, &links[i]);
+
+	for (i = 0; i < 4; i++)
+		PCUT_ASSERT_EQUALS(&links[i], prodcons_consume(&pc));
+
+	prodcons_destroy(&pc);
+}
+
+PCUT_EXPORT(mpmc_ring);
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/pkt_ring.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(pkt_ring);
+
+enum {
+	test_nslots = 4,
+	test_slot_size = 100
+};
+
+/** Producer and consumer attached to the same area */
+typedef struct {
+	void *area;
+	size_t size;
+	pkt_ring_t prod;
+	pkt_ring_t cons;
+} test_ring_t;
+
+static void test_ring_create(test_ring_t *tr)
+{
+	errno_t rc;
+
+	tr->size = pkt_ring_area_size(test_nslots, test_slot_size);
+	tr->area = calloc(1, tr->size);
+	PCUT_ASSERT_NOT_NULL(tr->area);
+
+	rc = pkt_ring_create(&tr->prod, tr->area, test_nslots, test_slot_size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = pkt_ring_attach(&tr->cons, tr->area, tr->size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+static void test_put(pkt_ring_t *ring, uint8_t val, uint32_t size)
+{
+	pkt_ring_desc_t desc;
+	uint8_t *slot;
+
+	slot = pkt_ring_prod_slot(ring);
+	PCUT_ASSERT_NOT_NULL(slot);
+	memset(slot, val, size);
+
+	desc.size = size;
+	desc.flags = val;
+	desc.arg1 = 0;
+	desc.arg2 = 0;
+	pkt_ring_prod_put(ring, &desc);
+}
+
+/** Invalid geometry is rejected */
+PCUT_TEST(create_invalid)
+{
+	pkt_ring_t ring;
+	uint8_t area[1024];
+
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pkt_ring_create(&ring, area, 0, 64));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pkt_ring_create(&ring, area, 3, 64));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pkt_ring_create(&ring, area, 4, 0));
+}
+
+/** Attaching to an area that is too small or not a ring fails */
+PCUT_TEST(attach_invalid)
+{
+	test_ring_t tr;
+	pkt_ring_t ring;
+
+	test_ring_create(&tr);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pkt_ring_attach(&ring, tr.area,
+	    tr.size - 1));
+
+	memset(tr.area, 0, tr.size);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pkt_ring_attach(&ring, tr.area,
+	    tr.size));
+	free(tr.area);
+}
+
+/** Packets are only visible after publishing and come out in order */
+PCUT_TEST(put_peek)
+{
+	test_ring_t tr;
+	pkt_ring_desc_t desc;
+	uint8_t *data;
+
+	test_ring_create(&tr);
+
+	test_put(&tr.prod, 1, 10);
+	test_put(&tr.prod, 2, 20);
+	PCUT_ASSERT_NULL(pkt_ring_cons_peek(&tr.cons, &desc));
+
+	PCUT_ASSERT_FALSE(pkt_ring_prod_publish(&tr.prod));
+
+	data = pkt_ring_cons_peek(&tr.cons, &desc);
+	PCUT_ASSERT_NOT_NULL(data);
+	PCUT_ASSERT_INT_EQUALS(10, desc.size);
+	PCUT_ASSERT_INT_EQUALS(1, desc.flags);
+	PCUT_ASSERT_INT_EQUALS(1, data[9]);
+	pkt_ring_cons_next(&tr.cons);
+
+	data = pkt_ring_cons_peek(&tr.cons, &desc);
+	PCUT_ASSERT_NOT_NULL(data);
+	PCUT_ASSERT_INT_EQUALS(20, desc.size);
+	PCUT_ASSERT_INT_EQUALS(2, data[19]);
+	pkt_ring_cons_next(&tr.cons);
+
+	PCUT_ASSERT_NULL(pkt_ring_cons_peek(&tr.cons, &desc));
+	free(tr.area);
+}
+
+/** Slots are only reused after the consumer returns them */
+PCUT_TEST(full_wrap)
+{
+	test_ring_t tr;
+	pkt_ring_desc_t desc;
+	uint8_t *data;
+	int i, round;
+
+	test_ring_create(&tr);
+
+	for (round = 0; round < 3; round++) {
+		for (i = 0; i < test_nslots; i++)
+			test_put(&tr.prod, round * test_nslots + i, 1);
+
+		PCUT_ASSERT_NULL(pkt_ring_prod_slot(&tr.prod));
+		pkt_ring_prod_publish(&tr.prod);
+
+		for (i = 0; i < test_nslots; i++) {
+			data = pkt_ring_cons_peek(&tr.cons, &desc);
+			PCUT_ASSERT_NOT_NULL(data);
+			PCUT_ASSERT_INT_EQUALS(round * test_nslots + i,
+			    data[0]);
+			pkt_ring_cons_next(&tr.cons);
+		}
+
+		/* Not returned yet */
+		PCUT_ASSERT_NULL(pkt_ring_prod_slot(&tr.prod));
+		pkt_ring_cons_publish(&tr.cons);
+		PCUT_ASSERT_NOT_NULL(pkt_ring_prod_slot(&tr.prod));
+	}
+
+	free(tr.area);
+}
+
+/** Descriptor size is clamped to the slot size */
+PCUT_TEST(size_clamp)
+{
+	test_ring_t tr;
+	pkt_ring_desc_t desc;
+
+	test_ring_create(&tr);
+
+	test_put(&tr.prod, 1, 1);
+	tr.prod.desc[0].size = 100000;
+	pkt_ring_prod_publish(&tr.prod);
+
+	PCUT_ASSERT_NOT_NULL(pkt_ring_cons_peek(&tr.cons, &desc));
+	PCUT_ASSERT_INT_EQUALS(tr.cons.slot_size, desc.size);
+	free(tr.area);
+}
+
+/** Doorbell is requested only when the consumer waits */
+PCUT_TEST(doorbell)
+{
+	test_ring_t tr;
+	pkt_ring_desc_t desc;
+
+	test_ring_create(&tr);
+
+	/* Consumer finds the ring empty and goes to sleep */
+	PCUT_ASSERT_TRUE(pkt_ring_cons_wait(&tr.cons));
+
+	test_put(&tr.prod, 1, 1);
+	PCUT_ASSERT_TRUE(pkt_ring_prod_publish(&tr.prod));
+
+	/* Only one doorbell for the batch */
+	test_put(&tr.prod, 2, 1);
+	PCUT_ASSERT_FALSE(pkt_ring_prod_publish(&tr.prod));
+
+	/* Consumer does not wait if there are packets */
+	PCUT_ASSERT_FALSE(pkt_ring_cons_wait(&tr.cons));
+	PCUT_ASSERT_NOT_NULL(pkt_ring_cons_peek(&tr.cons, &desc));
+
+	test_put(&tr.prod, 3, 1);
+	PCUT_ASSERT_FALSE(pkt_ring_prod_publish(&tr.prod));
+	free(tr.area);
+}
+
+PCUT_EXPORT(pkt_ring);
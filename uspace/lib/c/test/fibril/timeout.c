@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <pcut/pcut.h>
+#include <stddef.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(fibril_timeout);
+
+enum {
+	/** Number of concurrently sleeping fibrils */
+	sleepers = 100,
+	/** Number of concurrently armed timers */
+	timers = 50,
+	/** Number of set/clear rounds per timer */
+	timer_rounds = 20,
+	/** Spacing of expiration times in microseconds */
+	spacing = 2000
+};
+
+static size_t wake_order[sleepers];
+static size_t wake_count;
+
+static errno_t sleeper_fn(void *arg)
+{
+	size_t slot = (size_t) arg;
+
+	fibril_usleep(slot * spacing);
+	wake_order[wake_count++] = slot;
+	return EOK;
+}
+
+static void timer_fn(void *arg)
+{
+	size_t slot = (size_t) arg;
+
+	wake_order[wake_count++] = slot;
+}
+
+/** Wait until @a count wakeups have been recorded. */
+static void wait_wakeups(size_t count)
+{
+	while (wake_count < count)
+		fibril_usleep(spacing);
+}
+
+/** Fibrils sleeping with different timeouts wake up in timeout order. */
+PCUT_TEST(sleepers_wake_in_order)
+{
+	size_t i;
+	fid_t fid;
+
+	wake_count = 0;
+
+	/* Arm the timeouts in an order different from their expiration. */
+	for (i = 0; i < sleepers; i++) {
+		fid = fibril_create(sleeper_fn, (void *) ((i * 37) % sleepers));
+		PCUT_ASSERT_NOT_NULL(fid);
+		fibril_add_ready(fid);
+	}
+
+	wait_wakeups(sleepers);
+
+	for (i = 0; i < sleepers; i++)
+		PCUT_ASSERT_INT_EQUALS(i, wake_order[i]);
+}
+
+/** Repeatedly armed and cancelled timers fire once, in expiration order. */
+PCUT_TEST(timers_set_clear)
+{
+	fibril_timer_t *t[timers];
+	fibril_timer_state_t fts;
+	size_t i, r;
+
+	wake_count = 0;
+
+	for (i = 0; i < timers; i++) {
+		t[i] = fibril_timer_create(NULL);
+		PCUT_ASSERT_NOT_NULL(t[i]);
+	}
+
+	for (r = 0; r < timer_rounds; r++) {
+		for (i = 0; i < timers; i++) {
+			fibril_timer_set(t[i], 100 * 1000 * 1000, timer_fn,
+			    (void *) i);
+		}
+
+		fibril_usleep(100);
+
+		for (i = 0; i < timers; i++) {
+			fts = fibril_timer_clear(t[i]);
+			PCUT_ASSERT_INT_EQUALS(fts_active, fts);
+		}
+	}
+
+	PCUT_ASSERT_INT_EQUALS(0, wake_count);
+
+	for (i = 0; i < timers; i++) {
+		fibril_timer_set(t[i], (timers - i) * spacing, timer_fn,
+		    (void *) (timers - 1 - i));
+	}
+
+	wait_wakeups(timers);
+
+	for (i = 0; i < timers; i++) {
+		PCUT_ASSERT_INT_EQUALS(i, wake_order[i]);
+		fts = fibril_timer_clear(t[i]);
+		PCUT_ASSERT_INT_EQUALS(fts_fired, fts);
+		fibril_timer_destroy(t[i]);
+	}
+}
+
+PCUT_EXPORT(fibril_timeout);
@@ -105,4 +105,25 @@ PCUT_TEST(gsort_desc)
 	}
 }
 
+/* sort pairs by key only, equal keys must keep their original order */
+PCUT_TEST(gsort_stable)
+{
+	int size = 1000;
+	int data[size][2];
+
+	for (int i = 0; i < size; i++) {
+		data[i][0] = (i * 37) % 11;
+		data[i][1] = i;
+	}
+
+	bool ret = gsort(data, size, sizeof(data[0]), cmp_func, NULL);
+	PCUT_ASSERT_TRUE(ret);
+
+	for (int i = 1; i < size; i++) {
+		PCUT_ASSERT_TRUE(data[i - 1][0] <= data[i][0]);
+		if (data[i - 1][0] == data[i][0])
+			PCUT_ASSERT_TRUE(data[i - 1][1] < data[i][1]);
+	}
+}
+
 PCUT_EXPORT(gsort);
@@ -31,17 +31,23 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(bdict);
 PCUT_IMPORT(capa);
 PCUT_IMPORT(casting);
+PCUT_IMPORT(checksum);
 PCUT_IMPORT(circ_buf);
 PCUT_IMPORT(double_to_str);
+PCUT_IMPORT(fibril_timeout);
 PCUT_IMPORT(fibril_timer);
 PCUT_IMPORT(getopt);
 PCUT_IMPORT(gsort);
+PCUT_IMPORT(hash_table);
 PCUT_IMPORT(ieee_double);
 PCUT_IMPORT(imath);
 PCUT_IMPORT(inttypes);
 PCUT_IMPORT(mem);
+PCUT_IMPORT(mpmc_ring);
+PCUT_IMPORT(pkt_ring);
 PCUT_IMPORT(odict);
 PCUT_IMPORT(perf);
 PCUT_IMPORT(perm);
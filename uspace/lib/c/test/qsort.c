@@ -171,4 +171,82 @@ PCUT_TEST(pseudorandom_seq)
 	free(seq2);
 }
 
+/** Length of the sequence used to exercise introsort paths */
+#define LONG_SEQ_LEN  100000
+
+/** Test compare function with extra argument. */
+static int test_cmp_r(const void *a, const void *b, void *arg)
+{
+	int *ia = (int *)a;
+	int *ib = (int *)b;
+
+	(void) arg;
+	return (*ia > *ib) - (*ia < *ib);
+}
+
+/** Test sorting long sequences that are bad for naive quicksort */
+PCUT_TEST(long_seq)
+{
+	int *seq;
+	int i;
+	int kind;
+
+	seq = calloc(LONG_SEQ_LEN, sizeof(int));
+	PCUT_ASSERT_NOT_NULL(seq);
+
+	for (kind = 0; kind < 4; kind++) {
+		for (i = 0; i < LONG_SEQ_LEN; i++) {
+			switch (kind) {
+			case 0:
+				/* Increasing */
+				seq[i] = i;
+				break;
+			case 1:
+				/* Decreasing */
+				seq[i] = LONG_SEQ_LEN - i;
+				break;
+			case 2:
+				/* Organ pipe */
+				seq[i] = i < LONG_SEQ_LEN / 2 ? i : LONG_SEQ_LEN - i;
+				break;
+			default:
+				/* Few distinct keys */
+				seq[i] = (i * 7919) % 3;
+				break;
+			}
+		}
+
+		qsort(seq, LONG_SEQ_LEN, sizeof(int), test_cmp);
+
+		for (i = 1; i < LONG_SEQ_LEN; i++)
+			PCUT_ASSERT_TRUE(seq[i - 1] <= seq[i]);
+	}
+
+	free(seq);
+}
+
+/** Test parallel sorting of a pseudorandom sequence. */
+PCUT_TEST(parallel_seq)
+{
+	int *seq;
+	int i;
+	int v;
+
+	seq = calloc(LONG_SEQ_LEN * 4, sizeof(int));
+	PCUT_ASSERT_NOT_NULL(seq);
+
+	v = 1;
+	for (i = 0; i < LONG_SEQ_LEN * 4; i++) {
+		seq[i] = v;
+		v = seq_next(v);
+	}
+
+	qsort_parallel(seq, LONG_SEQ_LEN * 4, sizeof(int), test_cmp_r, NULL);
+
+	for (i = 1; i < LONG_SEQ_LEN * 4; i++)
+		PCUT_ASSERT_TRUE(seq[i - 1] <= seq[i]);
+
+	free(seq);
+}
+
 PCUT_EXPORT(qsort);
@@ -82,4 +82,23 @@ SPRINTF_TEST(int_as_hex, "[0x11] [0x012] [0x013] [0x00014] [0x00015]",
     "[%#x] [%#5.3x] [%#-5.3x] [%#3.5x] [%#-3.5x]",
     17, 18, 19, 20, 21);
 
+SPRINTF_TEST(int_digit_pairs, "[0] [7] [10] [99] [100] [12345] [-4096]",
+    "[%d] [%d] [%d] [%d] [%d] [%d] [%d]",
+    0, 7, 10, 99, 100, 12345, -4096);
+
+SPRINTF_TEST(int_64bit, "[18446744073709551615] [-9000000000000000001]",
+    "[%llu] [%lld]", (unsigned long long) -1,
+    (long long) -9000000000000000001LL);
+
+SPRINTF_TEST(size_and_hex, "[3000000000] [deadbeef] [DEADBEEF]",
+    "[%zu] [%x] [%X]", (size_t) 3000000000U, 0xdeadbeef, 0xdeadbeef);
+
+SPRINTF_TEST(int_wide_field,
+    "[                                                                    "
+    "                                                                  42]",
+    "[%136d]", 42);
+
+SPRINTF_TEST(string_no_width_precision, "[abc] [very]", "[%s] [%.4s]",
+    "abc", "very long text");
+
 PCUT_EXPORT(sprintf);
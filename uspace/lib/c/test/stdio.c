@@ -36,6 +36,7 @@
 
 #include <errno.h>
 #include <pcut/pcut.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <str.h>
 #include <tmpfile.h>
@@ -131,6 +132,45 @@ PCUT_TEST(tmpfile)
 	fclose(f);
 }
 
+/** Large reads and writes bypassing the stream buffer */
+PCUT_TEST(fread_fwrite_large)
+{
+	static uint8_t wbuf[4 * BUFSIZ];
+	static uint8_t rbuf[4 * BUFSIZ];
+	FILE *f;
+	size_t n;
+	size_t i;
+
+	for (i = 0; i < sizeof(wbuf); i++)
+		wbuf[i] = (uint8_t) (i * 7 + 3);
+
+	f = tmpfile();
+	PCUT_ASSERT_NOT_NULL(f);
+
+	/* Leave a few bytes in the buffer before the large write */
+	n = fwrite(wbuf, 1, 5, f);
+	PCUT_ASSERT_INT_EQUALS(5, n);
+	n = fwrite(wbuf + 5, 1, sizeof(wbuf) - 5, f);
+	PCUT_ASSERT_INT_EQUALS(sizeof(wbuf) - 5, n);
+
+	rewind(f);
+
+	/* Partially fill the buffer before the large read */
+	n = fread(rbuf, 1, 3, f);
+	PCUT_ASSERT_INT_EQUALS(3, n);
+	n = fread(rbuf + 3, 1, sizeof(rbuf) - 3, f);
+	PCUT_ASSERT_INT_EQUALS(sizeof(rbuf) - 3, n);
+
+	for (i = 0; i < sizeof(rbuf); i++)
+		PCUT_ASSERT_INT_EQUALS(wbuf[i], rbuf[i]);
+
+	n = fread(rbuf, 1, 1, f);
+	PCUT_ASSERT_INT_EQUALS(0, n);
+	PCUT_ASSERT_TRUE(feof(f));
+
+	fclose(f);
+}
+
 /** tmpnam function with buffer argument */
 PCUT_TEST(tmpnam_buf)
 {
@@ -114,4 +114,43 @@ PCUT_TEST(str_str_empty_n)
 	PCUT_ASSERT_TRUE((const char *)p == hs);
 }
 
+/** Strings long enough for the chunked ASCII fast paths */
+static const char *long_ascii = "/data/web/static/images/thumbnails/last.png";
+static const char *long_mixed = "/data/web/static/obrázky/thumbnails/last.png";
+
+PCUT_TEST(str_size_long)
+{
+	PCUT_ASSERT_INT_EQUALS(43, str_size(long_ascii));
+	PCUT_ASSERT_INT_EQUALS(45, str_size(long_mixed));
+	PCUT_ASSERT_INT_EQUALS(20, str_nsize(long_ascii, 20));
+	PCUT_ASSERT_INT_EQUALS(43, str_nsize(long_ascii, 100));
+}
+
+PCUT_TEST(str_length_long)
+{
+	PCUT_ASSERT_INT_EQUALS(43, str_length(long_ascii));
+	PCUT_ASSERT_INT_EQUALS(44, str_length(long_mixed));
+	PCUT_ASSERT_INT_EQUALS(23, str_lsize(long_mixed, 22));
+	PCUT_ASSERT_INT_EQUALS(45, str_lsize(long_mixed, 100));
+}
+
+PCUT_TEST(str_cmp_long)
+{
+	PCUT_ASSERT_INT_EQUALS(0, str_cmp(long_ascii, long_ascii));
+	PCUT_ASSERT_INT_EQUALS(-1, str_cmp(long_ascii, long_mixed));
+	PCUT_ASSERT_INT_EQUALS(1, str_cmp(long_mixed, long_ascii));
+	PCUT_ASSERT_INT_EQUALS(0, str_lcmp(long_ascii, long_mixed, 17));
+	PCUT_ASSERT_INT_EQUALS(-1, str_lcmp(long_ascii, long_mixed, 18));
+	PCUT_ASSERT_INT_EQUALS(1, str_cmp(long_ascii, "/data/web/static"));
+}
+
+PCUT_TEST(str_chr_long)
+{
+	PCUT_ASSERT_TRUE(str_chr(long_ascii, 'p') == long_ascii + 40);
+	PCUT_ASSERT_TRUE(str_chr(long_mixed, 'p') == long_mixed + 42);
+	PCUT_ASSERT_TRUE(str_chr(long_mixed, L'á') == long_mixed + 20);
+	PCUT_ASSERT_TRUE(str_chr(long_ascii, L'á') == NULL);
+	PCUT_ASSERT_TRUE(str_chr(long_ascii, '!') == NULL);
+}
+
 PCUT_EXPORT(str);
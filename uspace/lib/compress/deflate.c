@@ -0,0 +1,1138 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * @brief Implementation of deflate compression
+ *
+ * Compression into a `deflate' stream as described by RFC 1951. The
+ * design follows zlib: repeated strings are found through hash chains
+ * over a 32 KiB sliding window, higher compression levels search longer
+ * chains and defer each match by one byte to see whether a longer one
+ * starts there (lazy matching). Every block is emitted with dynamic
+ * Huffman codes, fixed codes or stored, whichever turns out smallest.
+ *
+ * Data is compressed as it is written and the compressed stream is
+ * passed to an output callback, so neither the input nor the output
+ * need to be held in memory as a whole.
+ *
+ */
+
+#include <errno.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "deflate.h"
+
+/** Size of the sliding window */
+#define WSIZE  32768
+#define WMASK  (WSIZE - 1)
+
+#define MIN_MATCH  3
+#define MAX_MATCH  258
+
+/** Minimum lookahead kept while compressing (except at the end of input) */
+#define MIN_LOOKAHEAD  (MAX_MATCH + MIN_MATCH + 1)
+
+/** Largest distance of a match, leaving room for the lookahead */
+#define MAX_MATCH_DIST  (WSIZE - MIN_LOOKAHEAD)
+
+/** Matches of minimum length further back than this are not worth it */
+#define TOO_FAR  4096
+
+#define HASH_BITS   15
+#define HASH_SIZE   (1 << HASH_BITS)
+#define HASH_MASK   (HASH_SIZE - 1)
+
+/** Number of symbols buffered before a block is emitted */
+#define SYM_BUF_SIZE  16384
+
+/** Size of the output buffer */
+#define OUT_BUF_SIZE  16384
+
+/** Maximum length of a stored block */
+#define MAX_STORED  65535
+
+#define MAX_BITS     15  /**< Maximum bits in a Huffman code */
+#define MAX_BL_BITS  7   /**< Maximum bits in a code length code */
+
+#define LITLEN_CODES  286
+#define FIXED_CODES   288
+#define DIST_CODES    30
+#define BL_CODES      19
+#define LEN_CODES     29
+
+#define END_BLOCK  256
+
+/** Block types */
+#define BTYPE_STORED  0
+#define BTYPE_FIXED   1
+#define BTYPE_DYNAMIC 2
+
+/** Compression level parameters
+ *
+ */
+typedef struct {
+	uint16_t good;   /**< Shorten the search beyond a match this long */
+	uint16_t lazy;   /**< Do not try lazy matches beyond this length */
+	uint16_t nice;   /**< Stop searching at a match this long */
+	uint16_t chain;  /**< Maximum number of hash chain links followed */
+	bool lazy_eval;  /**< Use lazy matching */
+} deflate_config_t;
+
+/** Parameters of compression levels 1 to 9 (as in zlib) */
+static const deflate_config_t configs[DEFLATE_LEVEL_MAX + 1] = {
+	{ 0, 0, 0, 0, false },
+	{ 4, 4, 8, 4, false },
+	{ 4, 5, 16, 8, false },
+	{ 4, 6, 32, 32, false },
+	{ 4, 4, 16, 16, true },
+	{ 8, 16, 32, 32, true },
+	{ 8, 16, 128, 128, true },
+	{ 8, 32, 128, 256, true },
+	{ 32, 128, 258, 1024, true },
+	{ 32, 258, 258, 4096, true }
+};
+
+/** Base lengths of length codes 257 to 285 */
+static const uint16_t lens[LEN_CODES] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/** Extra bits of length codes 257 to 285 */
+static const uint8_t lens_ext[LEN_CODES] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/** Base distances of distance codes 0 to 29 */
+static const uint16_t dists[DIST_CODES] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+/** Extra bits of distance codes 0 to 29 */
+static const uint8_t dists_ext[DIST_CODES] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/** Order of code length code lengths in the block header */
+static const uint8_t order[BL_CODES] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** Huffman code
+ *
+ */
+typedef struct {
+	uint16_t code[FIXED_CODES];  /**< Bit-reversed codes */
+	uint8_t len[FIXED_CODES];    /**< Code lengths, 0 if unused */
+} deflate_code_t;
+
+/** Symbol with its frequency, used for building Huffman codes
+ *
+ */
+typedef struct {
+	uint32_t freq;
+	uint16_t sym;
+} deflate_sym_t;
+
+/** Deflate stream
+ *
+ */
+struct deflate_stream {
+	deflate_write_t write;  /**< Output callback */
+	void *arg;              /**< Output callback argument */
+	errno_t rc;             /**< First error returned by output callback */
+	bool finished;          /**< Stream has been finished */
+
+	const deflate_config_t *config;  /**< Compression level parameters */
+
+	/** Sliding window, twice the window size */
+	uint8_t window[2 * WSIZE];
+	/** Most recent position of each hash value, 0 if none */
+	uint16_t head[HASH_SIZE];
+	/** Previous position with the same hash for the last WSIZE positions */
+	uint16_t prev[WSIZE];
+
+	size_t strstart;   /**< Current position in the window */
+	size_t lookahead;  /**< Number of bytes ahead of strstart */
+	long block_start;  /**< Start of the current block, negative if slid */
+
+	size_t match_length;  /**< Length of the current match */
+	size_t match_start;   /**< Position of the current match */
+	size_t prev_length;   /**< Length of the previous match */
+	size_t prev_match;    /**< Position of the previous match */
+	bool match_available; /**< Previous byte not emitted yet */
+
+	/** Buffered symbols: literal or match length minus MIN_MATCH */
+	uint8_t sym_lc[SYM_BUF_SIZE];
+	/** Buffered symbols: match distance or 0 for a literal */
+	uint16_t sym_dist[SYM_BUF_SIZE];
+	size_t sym_cnt;       /**< Number of buffered symbols */
+
+	uint32_t lit_freq[LITLEN_CODES];  /**< Literal/length frequencies */
+	uint32_t dist_freq[DIST_CODES];   /**< Distance frequencies */
+
+	uint8_t length_code[MAX_MATCH - MIN_MATCH + 1];  /**< Length to code */
+	uint8_t dist_code[512];  /**< Distance to code, see dist_to_code() */
+
+	deflate_code_t fixed_lit;   /**< Fixed literal/length code */
+	deflate_code_t fixed_dist;  /**< Fixed distance code */
+	deflate_code_t dyn_lit;     /**< Dynamic literal/length code */
+	deflate_code_t dyn_dist;    /**< Dynamic distance code */
+
+	uint8_t out[OUT_BUF_SIZE];  /**< Output buffer */
+	size_t outcnt;              /**< Number of bytes in output buffer */
+	uint64_t bitbuf;            /**< Bits not yet in the output buffer */
+	size_t bitlen;              /**< Number of bits in the bit buffer */
+};
+
+/** Pass the output buffer to the output callback
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void deflate_flush(deflate_stream_t *stream)
+{
+	if (stream->outcnt > 0 && stream->rc == EOK)
+		stream->rc = stream->write(stream->arg, stream->out,
+		    stream->outcnt);
+
+	stream->outcnt = 0;
+}
+
+/** Put bits into the output
+ *
+ * @param stream Deflate stream.
+ * @param value  Bits to put, least significant bit first.
+ * @param cnt    Number of bits (at most 16).
+ *
+ */
+static inline void put_bits(deflate_stream_t *stream, uint32_t value,
+    size_t cnt)
+{
+	stream->bitbuf |= (uint64_t) value << stream->bitlen;
+	stream->bitlen += cnt;
+
+	if (stream->bitlen < 32)
+		return;
+
+	if (stream->outcnt + 4 > OUT_BUF_SIZE)
+		deflate_flush(stream);
+
+	stream->out[stream->outcnt++] = (uint8_t) stream->bitbuf;
+	stream->out[stream->outcnt++] = (uint8_t) (stream->bitbuf >> 8);
+	stream->out[stream->outcnt++] = (uint8_t) (stream->bitbuf >> 16);
+	stream->out[stream->outcnt++] = (uint8_t) (stream->bitbuf >> 24);
+	stream->bitbuf >>= 32;
+	stream->bitlen -= 32;
+}
+
+/** Move all complete bytes from the bit buffer to the output buffer
+ *
+ * Any incomplete byte is padded with zero bits first.
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void put_align(deflate_stream_t *stream)
+{
+	while (stream->bitlen > 0) {
+		if (stream->outcnt == OUT_BUF_SIZE)
+			deflate_flush(stream);
+
+		stream->out[stream->outcnt++] = (uint8_t) stream->bitbuf;
+		stream->bitbuf >>= 8;
+		stream->bitlen = stream->bitlen > 8 ? stream->bitlen - 8 : 0;
+	}
+
+	stream->bitbuf = 0;
+}
+
+/** Reverse bits of a Huffman code
+ *
+ * @param code Code.
+ * @param len  Length of the code in bits.
+ *
+ * @return Code with bits in reverse order.
+ *
+ */
+static uint16_t code_reverse(uint16_t code, size_t len)
+{
+	uint16_t res = 0;
+
+	while (len-- > 0) {
+		res = (res << 1) | (code & 1);
+		code >>= 1;
+	}
+
+	return res;
+}
+
+/** Assign canonical Huffman codes to code lengths
+ *
+ * @param code Huffman code with lengths set.
+ * @param n    Number of symbols.
+ *
+ */
+static void code_assign(deflate_code_t *code, size_t n)
+{
+	uint16_t count[MAX_BITS + 1];
+	uint16_t next[MAX_BITS + 1];
+	uint16_t c = 0;
+
+	memset(count, 0, sizeof(count));
+	for (size_t i = 0; i < n; i++)
+		count[code->len[i]]++;
+
+	count[0] = 0;
+	for (size_t bits = 1; bits <= MAX_BITS; bits++) {
+		c = (c + count[bits - 1]) << 1;
+		next[bits] = c;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		if (code->len[i] != 0)
+			code->code[i] = code_reverse(next[code->len[i]]++,
+			    code->len[i]);
+	}
+}
+
+/** Compare symbols by frequency */
+static int sym_cmp(const void *a, const void *b)
+{
+	const deflate_sym_t *sa = a;
+	const deflate_sym_t *sb = b;
+
+	if (sa->freq != sb->freq)
+		return sa->freq < sb->freq ? -1 : 1;
+
+	return (int) sa->sym - (int) sb->sym;
+}
+
+/** Build a length-limited Huffman code
+ *
+ * Optimal code lengths are computed in place with the algorithm of
+ * Moffat and Katajainen, then codes longer than the limit are
+ * shortened and the code rebalanced (as in miniz). At least two symbols
+ * always get a code, so the code is complete.
+ *
+ * @param code    Huffman code to build.
+ * @param freq    Symbol frequencies.
+ * @param n       Number of symbols.
+ * @param maxbits Maximum code length.
+ *
+ */
+static void code_build(deflate_code_t *code, const uint32_t *freq, size_t n,
+    size_t maxbits)
+{
+	deflate_sym_t syms[LITLEN_CODES];
+	size_t num[MAX_BITS + 2];
+	size_t cnt = 0;
+
+	memset(code->len, 0, sizeof(code->len));
+
+	for (size_t i = 0; i < n; i++) {
+		if (freq[i] != 0) {
+			syms[cnt].freq = freq[i];
+			syms[cnt].sym = i;
+			cnt++;
+		}
+	}
+
+	if (cnt < 2) {
+		/* A complete code needs at least two one-bit codes */
+		size_t a = (cnt == 1) ? syms[0].sym : 1;
+
+		code->len[a] = 1;
+		code->len[(a == 0) ? 1 : 0] = 1;
+		code_assign(code, n);
+		return;
+	}
+
+	qsort(syms, cnt, sizeof(deflate_sym_t), sym_cmp);
+
+	/* Moffat-Katajainen: parent pointers, then depths */
+	size_t root = 0;
+	size_t leaf = 2;
+	syms[0].freq += syms[1].freq;
+
+	for (size_t next = 1; next < cnt - 1; next++) {
+		if (leaf >= cnt || syms[root].freq < syms[leaf].freq) {
+			syms[next].freq = syms[root].freq;
+			syms[root++].freq = next;
+		} else {
+			syms[next].freq = syms[leaf++].freq;
+		}
+
+		if (leaf >= cnt || (root < next &&
+		    syms[root].freq < syms[leaf].freq)) {
+			syms[next].freq += syms[root].freq;
+			syms[root++].freq = next;
+		} else {
+			syms[next].freq += syms[leaf++].freq;
+		}
+	}
+
+	syms[cnt - 2].freq = 0;
+	for (size_t next = cnt - 2; next-- > 0;)
+		syms[next].freq = syms[syms[next].freq].freq + 1;
+
+	size_t avail = 1;
+	size_t used = 0;
+	size_t depth = 0;
+	size_t next = cnt - 1;
+	long r = (long) cnt - 2;
+
+	memset(num, 0, sizeof(num));
+
+	while (avail > 0) {
+		while (r >= 0 && syms[r].freq == depth) {
+			used++;
+			r--;
+		}
+
+		while (avail > used) {
+			num[min(depth, MAX_BITS + 1)]++;
+			syms[next--].freq = depth;
+			avail--;
+		}
+
+		avail = 2 * used;
+		depth++;
+		used = 0;
+	}
+
+	/* Limit code lengths, keeping the Kraft sum at one */
+	for (size_t i = maxbits + 1; i <= MAX_BITS + 1; i++) {
+		num[maxbits] += num[i];
+		num[i] = 0;
+	}
+
+	uint32_t total = 0;
+	for (size_t i = maxbits; i > 0; i--)
+		total += (uint32_t) num[i] << (maxbits - i);
+
+	while (total != ((uint32_t) 1 << maxbits)) {
+		num[maxbits]--;
+		for (size_t i = maxbits - 1; i > 0; i--) {
+			if (num[i] != 0) {
+				num[i]--;
+				num[i + 1] += 2;
+				break;
+			}
+		}
+
+		total--;
+	}
+
+	/* Most frequent symbols get the shortest codes */
+	size_t j = cnt;
+	for (size_t bits = 1; bits <= maxbits; bits++) {
+		for (size_t k = num[bits]; k > 0; k--)
+			code->len[syms[--j].sym] = bits;
+	}
+
+	code_assign(code, n);
+}
+
+/** Get distance code of a distance
+ *
+ * @param stream Deflate stream.
+ * @param dist   Distance minus one.
+ *
+ * @return Distance code.
+ *
+ */
+static inline uint8_t dist_to_code(deflate_stream_t *stream, size_t dist)
+{
+	return dist < 256 ? stream->dist_code[dist] :
+	    stream->dist_code[256 + (dist >> 7)];
+}
+
+/** Compute number of bits needed to emit buffered symbols
+ *
+ * @param stream Deflate stream.
+ * @param lit    Literal/length code.
+ * @param dist   Distance code.
+ *
+ * @return Number of bits, excluding the block header.
+ *
+ */
+static size_t block_cost(deflate_stream_t *stream, deflate_code_t *lit,
+    deflate_code_t *dist)
+{
+	size_t bits = 0;
+
+	for (size_t i = 0; i < LITLEN_CODES; i++)
+		bits += stream->lit_freq[i] * lit->len[i];
+
+	for (size_t i = 0; i < LEN_CODES; i++)
+		bits += stream->lit_freq[257 + i] * lens_ext[i];
+
+	for (size_t i = 0; i < DIST_CODES; i++)
+		bits += stream->dist_freq[i] * (dist->len[i] + dists_ext[i]);
+
+	return bits;
+}
+
+/** Emit buffered symbols
+ *
+ * @param stream Deflate stream.
+ * @param lit    Literal/length code.
+ * @param dist   Distance code.
+ *
+ */
+static void block_symbols(deflate_stream_t *stream, deflate_code_t *lit,
+    deflate_code_t *dist)
+{
+	for (size_t i = 0; i < stream->sym_cnt; i++) {
+		size_t lc = stream->sym_lc[i];
+		size_t d = stream->sym_dist[i];
+
+		if (d == 0) {
+			put_bits(stream, lit->code[lc], lit->len[lc]);
+			continue;
+		}
+
+		size_t code = stream->length_code[lc];
+		put_bits(stream, lit->code[257 + code], lit->len[257 + code]);
+		if (lens_ext[code] != 0)
+			put_bits(stream, lc + MIN_MATCH - lens[code],
+			    lens_ext[code]);
+
+		d--;
+		code = dist_to_code(stream, d);
+		put_bits(stream, dist->code[code], dist->len[code]);
+		if (dists_ext[code] != 0)
+			put_bits(stream, d + 1 - dists[code], dists_ext[code]);
+	}
+
+	put_bits(stream, lit->code[END_BLOCK], lit->len[END_BLOCK]);
+}
+
+/** Emit the current block
+ *
+ * @param stream Deflate stream.
+ * @param last   This is the last block of the stream.
+ *
+ */
+static void deflate_block(deflate_stream_t *stream, bool last)
+{
+	uint8_t lens_all[LITLEN_CODES + DIST_CODES];
+	uint8_t rle_sym[LITLEN_CODES + DIST_CODES];
+	uint8_t rle_ext[LITLEN_CODES + DIST_CODES];
+	uint32_t bl_freq[BL_CODES];
+	deflate_code_t bl;
+	size_t rle_cnt = 0;
+
+	stream->lit_freq[END_BLOCK] = 1;
+
+	code_build(&stream->dyn_lit, stream->lit_freq, LITLEN_CODES, MAX_BITS);
+	code_build(&stream->dyn_dist, stream->dist_freq, DIST_CODES, MAX_BITS);
+
+	size_t hlit = LITLEN_CODES;
+	while (hlit > 257 && stream->dyn_lit.len[hlit - 1] == 0)
+		hlit--;
+
+	size_t hdist = DIST_CODES;
+	while (hdist > 1 && stream->dyn_dist.len[hdist - 1] == 0)
+		hdist--;
+
+	/* Run-length encode the code lengths of both codes */
+	memcpy(lens_all, stream->dyn_lit.len, hlit);
+	memcpy(lens_all + hlit, stream->dyn_dist.len, hdist);
+	memset(bl_freq, 0, sizeof(bl_freq));
+
+	size_t n = hlit + hdist;
+	size_t i = 0;
+	while (i < n) {
+		uint8_t cur = lens_all[i];
+		size_t run = 1;
+
+		while (i + run < n && lens_all[i + run] == cur)
+			run++;
+
+		i += run;
+
+		if (cur != 0) {
+			rle_sym[rle_cnt++] = cur;
+			run--;
+
+			while (run >= 3) {
+				size_t rep = min(run, 6);
+				rle_sym[rle_cnt] = 16;
+				rle_ext[rle_cnt++] = rep - 3;
+				run -= rep;
+			}
+		} else {
+			while (run >= 11) {
+				size_t rep = min(run, 138);
+				rle_sym[rle_cnt] = 18;
+				rle_ext[rle_cnt++] = rep - 11;
+				run -= rep;
+			}
+
+			if (run >= 3) {
+				rle_sym[rle_cnt] = 17;
+				rle_ext[rle_cnt++] = run - 3;
+				run = 0;
+			}
+		}
+
+		while (run-- > 0)
+			rle_sym[rle_cnt++] = cur;
+	}
+
+	for (i = 0; i < rle_cnt; i++)
+		bl_freq[rle_sym[i]]++;
+
+	code_build(&bl, bl_freq, BL_CODES, MAX_BL_BITS);
+
+	size_t hclen = BL_CODES;
+	while (hclen > 4 && bl.len[order[hclen - 1]] == 0)
+		hclen--;
+
+	/* Compare sizes of the possible encodings */
+	size_t dyn_bits = 3 + 5 + 5 + 4 + 3 * hclen +
+	    block_cost(stream, &stream->dyn_lit, &stream->dyn_dist);
+	for (i = 0; i < BL_CODES; i++)
+		dyn_bits += bl_freq[i] * bl.len[i];
+	dyn_bits += bl_freq[16] * 2 + bl_freq[17] * 3 + bl_freq[18] * 7;
+
+	size_t fixed_bits = 3 +
+	    block_cost(stream, &stream->fixed_lit, &stream->fixed_dist);
+
+	size_t stored_len = stream->strstart - stream->block_start;
+	size_t stored_bits = SIZE_MAX;
+	if (stream->block_start >= 0) {
+		size_t pieces = max(1, (stored_len + MAX_STORED - 1) /
+		    MAX_STORED);
+		stored_bits = (stored_len + 4 * pieces) * 8 + 3 * pieces + 7;
+	}
+
+	if (stored_bits <= fixed_bits && stored_bits <= dyn_bits) {
+		const uint8_t *data = stream->window + stream->block_start;
+
+		do {
+			size_t len = min(stored_len, MAX_STORED);
+			bool final = last && len == stored_len;
+
+			put_bits(stream, (final ? 1 : 0) | (BTYPE_STORED << 1),
+			    3);
+			put_align(stream);
+			put_bits(stream, len, 16);
+			put_bits(stream, (uint16_t) ~len, 16);
+
+			while (len > 0) {
+				if (stream->outcnt == OUT_BUF_SIZE)
+					deflate_flush(stream);
+
+				size_t cnt = min(len,
+				    OUT_BUF_SIZE - stream->outcnt);
+				memcpy(stream->out + stream->outcnt, data, cnt);
+				stream->outcnt += cnt;
+				data += cnt;
+				len -= cnt;
+				stored_len -= cnt;
+			}
+		} while (stored_len > 0);
+	} else if (fixed_bits <= dyn_bits) {
+		put_bits(stream, (last ? 1 : 0) | (BTYPE_FIXED << 1), 3);
+		block_symbols(stream, &stream->fixed_lit, &stream->fixed_dist);
+	} else {
+		put_bits(stream, (last ? 1 : 0) | (BTYPE_DYNAMIC << 1), 3);
+		put_bits(stream, hlit - 257, 5);
+		put_bits(stream, hdist - 1, 5);
+		put_bits(stream, hclen - 4, 4);
+
+		for (i = 0; i < hclen; i++)
+			put_bits(stream, bl.len[order[i]], 3);
+
+		for (i = 0; i < rle_cnt; i++) {
+			uint8_t sym = rle_sym[i];
+
+			put_bits(stream, bl.code[sym], bl.len[sym]);
+			if (sym == 16)
+				put_bits(stream, rle_ext[i], 2);
+			else if (sym == 17)
+				put_bits(stream, rle_ext[i], 3);
+			else if (sym == 18)
+				put_bits(stream, rle_ext[i], 7);
+		}
+
+		block_symbols(stream, &stream->dyn_lit, &stream->dyn_dist);
+	}
+
+	memset(stream->lit_freq, 0, sizeof(stream->lit_freq));
+	memset(stream->dist_freq, 0, sizeof(stream->dist_freq));
+	stream->sym_cnt = 0;
+	stream->block_start = stream->strstart;
+}
+
+/** Buffer a literal
+ *
+ * @param stream Deflate stream.
+ * @param c      Literal byte.
+ *
+ * @return @c true if the symbol buffer is full.
+ *
+ */
+static inline bool tally_lit(deflate_stream_t *stream, uint8_t c)
+{
+	stream->sym_lc[stream->sym_cnt] = c;
+	stream->sym_dist[stream->sym_cnt] = 0;
+	stream->sym_cnt++;
+	stream->lit_freq[c]++;
+
+	return stream->sym_cnt == SYM_BUF_SIZE;
+}
+
+/** Buffer a match
+ *
+ * @param stream Deflate stream.
+ * @param dist   Distance of the match.
+ * @param len    Length of the match.
+ *
+ * @return @c true if the symbol buffer is full.
+ *
+ */
+static inline bool tally_match(deflate_stream_t *stream, size_t dist,
+    size_t len)
+{
+	stream->sym_lc[stream->sym_cnt] = len - MIN_MATCH;
+	stream->sym_dist[stream->sym_cnt] = dist;
+	stream->sym_cnt++;
+	stream->lit_freq[257 + stream->length_code[len - MIN_MATCH]]++;
+	stream->dist_freq[dist_to_code(stream, dist - 1)]++;
+
+	return stream->sym_cnt == SYM_BUF_SIZE;
+}
+
+/** Insert string starting at a position into the hash table
+ *
+ * @param stream Deflate stream.
+ * @param pos    Position in the window (with MIN_MATCH bytes available).
+ *
+ * @return Previous position with the same hash, 0 if none.
+ *
+ */
+static inline size_t insert_string(deflate_stream_t *stream, size_t pos)
+{
+	const uint8_t *p = stream->window + pos;
+	size_t hash = ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & HASH_MASK;
+	size_t head = stream->head[hash];
+
+	stream->prev[pos & WMASK] = head;
+	stream->head[hash] = pos;
+	return head;
+}
+
+/** Find the longest match at the current position
+ *
+ * Follow the hash chain looking for a match longer than prev_length.
+ *
+ * @param stream    Deflate stream.
+ * @param cur_match Head of the hash chain.
+ *
+ * @return Length of the longest match found, at least prev_length. If
+ *         longer than prev_length, match_start is set to its position.
+ *
+ */
+static size_t longest_match(deflate_stream_t *stream, size_t cur_match)
+{
+	const uint8_t *scan = stream->window + stream->strstart;
+	size_t chain = stream->config->chain;
+	size_t nice = stream->config->nice;
+	size_t best_len = stream->prev_length;
+	size_t maxlen = min(MAX_MATCH, stream->lookahead);
+	size_t limit = stream->strstart > MAX_MATCH_DIST ?
+	    stream->strstart - MAX_MATCH_DIST : 0;
+
+	if (best_len >= maxlen)
+		return best_len;
+
+	if (best_len >= stream->config->good)
+		chain >>= 2;
+
+	if (nice > maxlen)
+		nice = maxlen;
+
+	do {
+		const uint8_t *match = stream->window + cur_match;
+
+		if (match[best_len] != scan[best_len] ||
+		    match[best_len - 1] != scan[best_len - 1] ||
+		    match[0] != scan[0] || match[1] != scan[1])
+			continue;
+
+		size_t len = 2;
+		while (len < maxlen && match[len] == scan[len])
+			len++;
+
+		if (len > best_len) {
+			stream->match_start = cur_match;
+			best_len = len;
+			if (len >= nice)
+				break;
+		}
+	} while ((cur_match = stream->prev[cur_match & WMASK]) > limit &&
+	    --chain != 0);
+
+	return best_len;
+}
+
+/** Compress without lazy matching (levels 1 to 3)
+ *
+ * Each match found is taken immediately. Only short matches have all
+ * their strings inserted into the hash table.
+ *
+ * @param stream Deflate stream.
+ * @param flush  Process all input, not only up to MIN_LOOKAHEAD.
+ *
+ */
+static void deflate_fast(deflate_stream_t *stream, bool flush)
+{
+	while (stream->lookahead >= MIN_LOOKAHEAD ||
+	    (flush && stream->lookahead > 0)) {
+		size_t hash_head = 0;
+		size_t match_length = 0;
+		bool full;
+
+		if (stream->lookahead >= MIN_MATCH)
+			hash_head = insert_string(stream, stream->strstart);
+
+		if (hash_head != 0 &&
+		    stream->strstart - hash_head <= MAX_MATCH_DIST) {
+			stream->prev_length = MIN_MATCH - 1;
+			match_length = longest_match(stream, hash_head);
+		}
+
+		if (match_length >= MIN_MATCH) {
+			full = tally_match(stream,
+			    stream->strstart - stream->match_start,
+			    match_length);
+			stream->lookahead -= match_length;
+
+			if (match_length <= stream->config->lazy &&
+			    stream->lookahead >= MIN_MATCH) {
+				size_t end = stream->strstart +
+				    stream->lookahead;
+
+				/* String at strstart is already inserted */
+				while (--match_length != 0) {
+					stream->strstart++;
+					if (stream->strstart + MIN_MATCH <= end)
+						insert_string(stream,
+						    stream->strstart);
+				}
+
+				stream->strstart++;
+			} else {
+				stream->strstart += match_length;
+			}
+		} else {
+			full = tally_lit(stream,
+			    stream->window[stream->strstart]);
+			stream->lookahead--;
+			stream->strstart++;
+		}
+
+		if (full)
+			deflate_block(stream, false);
+	}
+}
+
+/** Compress with lazy matching (levels 4 to 9)
+ *
+ * A match is only taken if no longer match starts at the next byte.
+ *
+ * @param stream Deflate stream.
+ * @param flush  Process all input, not only up to MIN_LOOKAHEAD.
+ *
+ */
+static void deflate_slow(deflate_stream_t *stream, bool flush)
+{
+	while (stream->lookahead >= MIN_LOOKAHEAD ||
+	    (flush && stream->lookahead > 0)) {
+		size_t hash_head = 0;
+
+		if (stream->lookahead >= MIN_MATCH)
+			hash_head = insert_string(stream, stream->strstart);
+
+		stream->prev_length = stream->match_length;
+		stream->prev_match = stream->match_start;
+		stream->match_length = MIN_MATCH - 1;
+
+		if (hash_head != 0 &&
+		    stream->prev_length < stream->config->lazy &&
+		    stream->strstart - hash_head <= MAX_MATCH_DIST) {
+			stream->match_length = longest_match(stream, hash_head);
+
+			if (stream->match_length == MIN_MATCH &&
+			    stream->strstart - stream->match_start > TOO_FAR)
+				stream->match_length = MIN_MATCH - 1;
+		}
+
+		if (stream->prev_length >= MIN_MATCH &&
+		    stream->match_length <= stream->prev_length) {
+			/* Take the previous match */
+			size_t end = stream->strstart + stream->lookahead;
+			size_t len = stream->prev_length;
+			bool full;
+
+			full = tally_match(stream,
+			    stream->strstart - 1 - stream->prev_match, len);
+			stream->lookahead -= len - 1;
+
+			/* Strings up to strstart are already inserted */
+			len -= 2;
+			while (len-- > 0) {
+				stream->strstart++;
+				if (stream->strstart + MIN_MATCH <= end)
+					insert_string(stream, stream->strstart);
+			}
+
+			stream->match_available = false;
+			stream->match_length = MIN_MATCH - 1;
+			stream->strstart++;
+
+			if (full)
+				deflate_block(stream, false);
+		} else if (stream->match_available) {
+			/* Emit the previous byte as a literal */
+			if (tally_lit(stream,
+			    stream->window[stream->strstart - 1]))
+				deflate_block(stream, false);
+
+			stream->strstart++;
+			stream->lookahead--;
+		} else {
+			/* Wait for the next byte to decide */
+			stream->match_available = true;
+			stream->strstart++;
+			stream->lookahead--;
+		}
+	}
+
+	if (flush && stream->match_available) {
+		(void) tally_lit(stream, stream->window[stream->strstart - 1]);
+		stream->match_available = false;
+	}
+}
+
+/** Compress buffered input
+ *
+ * @param stream Deflate stream.
+ * @param flush  Process all input, not only up to MIN_LOOKAHEAD.
+ *
+ */
+static void deflate_process(deflate_stream_t *stream, bool flush)
+{
+	if (stream->config->lazy_eval)
+		deflate_slow(stream, flush);
+	else
+		deflate_fast(stream, flush);
+}
+
+/** Slide the window down by WSIZE bytes
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void deflate_slide(deflate_stream_t *stream)
+{
+	memcpy(stream->window, stream->window + WSIZE, WSIZE);
+	stream->strstart -= WSIZE;
+	stream->match_start = stream->match_start >= WSIZE ?
+	    stream->match_start - WSIZE : 0;
+	stream->block_start -= WSIZE;
+
+	for (size_t i = 0; i < HASH_SIZE; i++)
+		stream->head[i] = stream->head[i] >= WSIZE ?
+		    stream->head[i] - WSIZE : 0;
+
+	for (size_t i = 0; i < WSIZE; i++)
+		stream->prev[i] = stream->prev[i] >= WSIZE ?
+		    stream->prev[i] - WSIZE : 0;
+}
+
+/** Create deflate stream
+ *
+ * @param level  Compression level (DEFLATE_LEVEL_MIN to DEFLATE_LEVEL_MAX).
+ * @param write  Output callback receiving the compressed stream.
+ * @param arg    Output callback argument.
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression level.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t deflate_stream_create(int level, deflate_write_t write, void *arg,
+    deflate_stream_t **rstream)
+{
+	deflate_stream_t *stream;
+	size_t len = 0;
+	size_t dist = 0;
+	size_t code;
+
+	if (level < DEFLATE_LEVEL_MIN || level > DEFLATE_LEVEL_MAX)
+		return EINVAL;
+
+	stream = calloc(1, sizeof(deflate_stream_t));
+	if (stream == NULL)
+		return ENOMEM;
+
+	stream->write = write;
+	stream->arg = arg;
+	stream->config = &configs[level];
+	stream->match_length = MIN_MATCH - 1;
+	stream->prev_length = MIN_MATCH - 1;
+
+	/* Map lengths and distances to their codes */
+	for (code = 0; code < LEN_CODES - 1; code++) {
+		for (size_t i = 0; i < (1u << lens_ext[code]); i++)
+			stream->length_code[len++] = code;
+	}
+
+	/* Length 258 has a code of its own */
+	stream->length_code[MAX_MATCH - MIN_MATCH] = LEN_CODES - 1;
+
+	for (code = 0; code < 16; code++) {
+		for (size_t i = 0; i < (1u << dists_ext[code]); i++)
+			stream->dist_code[dist++] = code;
+	}
+
+	dist >>= 7;
+	for (; code < DIST_CODES; code++) {
+		for (size_t i = 0; i < (1u << (dists_ext[code] - 7)); i++)
+			stream->dist_code[256 + dist++] = code;
+	}
+
+	/* Fixed codes (RFC 1951, 3.2.6) */
+	for (size_t i = 0; i < FIXED_CODES; i++) {
+		if (i < 144)
+			stream->fixed_lit.len[i] = 8;
+		else if (i < 256)
+			stream->fixed_lit.len[i] = 9;
+		else if (i < 280)
+			stream->fixed_lit.len[i] = 7;
+		else
+			stream->fixed_lit.len[i] = 8;
+	}
+
+	code_assign(&stream->fixed_lit, FIXED_CODES);
+
+	for (size_t i = 0; i < DIST_CODES; i++)
+		stream->fixed_dist.len[i] = 5;
+
+	code_assign(&stream->fixed_dist, DIST_CODES);
+
+	*rstream = stream;
+	return EOK;
+}
+
+/** Compress data
+ *
+ * The data is compressed as far as possible; compressed output is passed
+ * to the output callback whenever the output buffer fills up.
+ *
+ * @param stream Deflate stream.
+ * @param data   Data to compress.
+ * @param size   Size of @a data in bytes.
+ *
+ * @return EOK on success or an error returned by the output callback.
+ *
+ */
+errno_t deflate_stream_write(deflate_stream_t *stream, const void *data,
+    size_t size)
+{
+	const uint8_t *src = data;
+
+	if (stream->finished)
+		return EINVAL;
+
+	while (size > 0 && stream->rc == EOK) {
+		if (stream->strstart >= WSIZE + MAX_MATCH_DIST)
+			deflate_slide(stream);
+
+		size_t end = stream->strstart + stream->lookahead;
+		size_t cnt = min(size, 2 * WSIZE - end);
+
+		memcpy(stream->window + end, src, cnt);
+		stream->lookahead += cnt;
+		src += cnt;
+		size -= cnt;
+
+		deflate_process(stream, false);
+	}
+
+	return stream->rc;
+}
+
+/** Finish compressed stream
+ *
+ * Compress all remaining input, emit the last block and pass all
+ * remaining output to the output callback. No more data can be written
+ * afterwards.
+ *
+ * @param stream Deflate stream.
+ *
+ * @return EOK on success or an error returned by the output callback.
+ *
+ */
+errno_t deflate_stream_finish(deflate_stream_t *stream)
+{
+	if (stream->finished)
+		return EINVAL;
+
+	deflate_process(stream, true);
+	deflate_block(stream, true);
+	put_align(stream);
+	deflate_flush(stream);
+
+	stream->finished = true;
+	return stream->rc;
+}
+
+/** Destroy deflate stream
+ *
+ * @param stream Deflate stream.
+ *
+ */
+void deflate_stream_destroy(deflate_stream_t *stream)
+{
+	free(stream);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCOMPRESS_DEFLATE_H_
+#define LIBCOMPRESS_DEFLATE_H_
+
+#include <errno.h>
+#include <stddef.h>
+
+/** Lowest compression level (fastest) */
+#define DEFLATE_LEVEL_MIN  1
+/** Highest compression level (best compression) */
+#define DEFLATE_LEVEL_MAX  9
+/** Default compression level */
+#define DEFLATE_LEVEL_DEFAULT  6
+
+/** Deflate output callback
+ *
+ * @param arg  Callback argument
+ * @param data Compressed data
+ * @param size Size of @a data in bytes
+ * @return EOK to continue or an error code to abort compression
+ */
+typedef errno_t (*deflate_write_t)(void *, const void *, size_t);
+
+/** Deflate stream */
+typedef struct deflate_stream deflate_stream_t;
+
+extern errno_t deflate_stream_create(int, deflate_write_t, void *,
+    deflate_stream_t **);
+extern errno_t deflate_stream_write(deflate_stream_t *, const void *, size_t);
+extern errno_t deflate_stream_finish(deflate_stream_t *);
+extern void deflate_stream_destroy(deflate_stream_t *);
+
+#endif
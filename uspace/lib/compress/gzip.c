@@ -28,10 +28,14 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <errno.h>
+#include <macros.h>
 #include <mem.h>
 #include <byteorder.h>
 #include <stdlib.h>
+#include <adt/checksum.h>
+#include "deflate.h"
 #include "gzip.h"
 #include "inflate.h"
 
@@ -46,6 +50,14 @@
 #define GZIP_FLAG_FNAME     UINT8_C(1 << 3)
 #define GZIP_FLAG_FCOMMENT  UINT8_C(1 << 4)
 
+#define GZIP_XFL_BEST     UINT8_C(2)
+#define GZIP_XFL_FASTEST  UINT8_C(4)
+
+#define GZIP_OS_UNKNOWN  UINT8_C(255)
+
+/** Size of the reader input buffer */
+#define GZIP_BUF_SIZE  4096
+
 typedef struct {
 	uint8_t id1;
 	uint8_t id2;
@@ -61,30 +73,46 @@ typedef struct {
 	uint32_t size;
 } __attribute__((packed)) gzip_footer_t;
 
-/** Expand GZIP compressed data
+/** GZIP stream reader */
+struct gzip_reader {
+	inflate_read_t read;   /**< Input callback */
+	void *arg;             /**< Input callback argument */
+	inflate_stream_t *inflate;  /**< Decompressor */
+
+	uint8_t buf[GZIP_BUF_SIZE];  /**< Input read while parsing header */
+	size_t buflen;         /**< Number of bytes in @c buf */
+	size_t bufpos;         /**< Number of bytes consumed from @c buf */
+
+	uint32_t crc32;        /**< CRC32 of data read so far */
+	uint32_t size;         /**< Size of data read so far (modulo 2^32) */
+	bool done;             /**< End of stream reached and verified */
+	errno_t rc;            /**< First error encountered */
+};
+
+/** GZIP stream writer */
+struct gzip_writer {
+	deflate_write_t write;     /**< Output callback */
+	void *arg;                 /**< Output callback argument */
+	deflate_stream_t *deflate; /**< Compressor */
+
+	uint32_t crc32;  /**< CRC32 of data written so far */
+	uint32_t size;   /**< Size of data written so far (modulo 2^32) */
+};
+
+/** Parse GZIP header and footer
  *
- * The routine allocates the output buffer based
- * on the size encoded in the input stream. This
- * effectively limits the size of the uncompressed
- * data to 4 GiB (expanding input streams that actually
- * encode more data will always fail).
- *
- * So far, no CRC is perfomed.
- *
- * @param[in]  src     Source data buffer.
- * @param[in]  srclen  Source buffer size (bytes).
- * @param[out] dest    Destination data buffer.
- * @param[out] destlen Destination buffer size (bytes).
+ * @param[in]  src           Source data buffer.
+ * @param[in]  srclen        Source buffer size (bytes).
+ * @param[out] rstream       Start of the deflate stream.
+ * @param[out] rstream_length Length of the deflate stream (bytes).
+ * @param[out] destlen       Size of uncompressed data (bytes).
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code, invalid deflate data,
- *                   invalid compression method or invalid stream.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EINVAL on invalid compression method or invalid stream.
  *
  */
-errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
+static errno_t gzip_parse(void *src, size_t srclen, void **rstream,
+    size_t *rstream_length, size_t *destlen)
 {
 	gzip_header_t header;
 	gzip_footer_t footer;
@@ -167,17 +195,473 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 		stream_length -= 2;
 	}
 
+	*rstream = stream;
+	*rstream_length = stream_length;
+	return EOK;
+}
+
+/** Expand GZIP compressed data
+ *
+ * The routine allocates the output buffer based
+ * on the size encoded in the input stream. This
+ * effectively limits the size of the uncompressed
+ * data to 4 GiB (expanding input streams that actually
+ * encode more data will always fail).
+ *
+ * So far, no CRC is perfomed.
+ *
+ * @param[in]  src     Source data buffer.
+ * @param[in]  srclen  Source buffer size (bytes).
+ * @param[out] dest    Destination data buffer.
+ * @param[out] destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code, invalid deflate data,
+ *                   invalid compression method or invalid stream.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun.
+ *
+ */
+errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
+{
+	void *stream;
+	size_t stream_length;
+	errno_t ret;
+
+	ret = gzip_parse(src, srclen, &stream, &stream_length, destlen);
+	if (ret != EOK)
+		return ret;
+
 	/* Allocate output buffer and inflate the data */
 
 	*dest = malloc(*destlen);
 	if (*dest == NULL)
 		return ENOMEM;
 
-	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
+	ret = inflate(stream, stream_length, *dest, *destlen);
 	if (ret != EOK) {
-		free(dest);
+		free(*dest);
 		return ret;
 	}
 
 	return EOK;
 }
+
+/** Expand GZIP compressed data, passing output to a callback
+ *
+ * Unlike gzip_expand(), the uncompressed data is never held in memory
+ * as a whole. It is passed to @a write piece by piece as it is
+ * being decompressed.
+ *
+ * So far, no CRC is perfomed.
+ *
+ * @param src    Source data buffer.
+ * @param srclen Source buffer size (bytes).
+ * @param write  Output callback.
+ * @param arg    Argument to the output callback.
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code, invalid deflate data,
+ *                   invalid compression method or invalid stream.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM if out of memory.
+ * @return Error code returned by @a write.
+ *
+ */
+errno_t gzip_expand_stream(void *src, size_t srclen, inflate_write_t write,
+    void *arg)
+{
+	void *stream;
+	size_t stream_length;
+	size_t destlen;
+	errno_t ret;
+
+	ret = gzip_parse(src, srclen, &stream, &stream_length, &destlen);
+	if (ret != EOK)
+		return ret;
+
+	return inflate_stream(stream, stream_length, write, arg);
+}
+
+/** Get next byte of the GZIP header
+ *
+ * @param reader GZIP reader.
+ * @param byte   Place to store the byte.
+ *
+ * @return EOK on success.
+ * @return EINVAL on premature end of input.
+ * @return Error code returned by the input callback.
+ *
+ */
+static errno_t gzip_reader_byte(gzip_reader_t *reader, uint8_t *byte)
+{
+	size_t nread;
+	errno_t rc;
+
+	if (reader->bufpos == reader->buflen) {
+		rc = reader->read(reader->arg, reader->buf, GZIP_BUF_SIZE,
+		    &nread);
+		if (rc != EOK)
+			return rc;
+
+		if (nread == 0)
+			return EINVAL;
+
+		reader->buflen = nread;
+		reader->bufpos = 0;
+	}
+
+	*byte = reader->buf[reader->bufpos++];
+	return EOK;
+}
+
+/** Skip bytes of the GZIP header
+ *
+ * @param reader GZIP reader.
+ * @param cnt    Number of bytes to skip.
+ * @param zterm  Skip a zero-terminated string instead.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+static errno_t gzip_reader_skip(gzip_reader_t *reader, size_t cnt, bool zterm)
+{
+	uint8_t byte;
+	errno_t rc;
+
+	while (zterm || cnt > 0) {
+		rc = gzip_reader_byte(reader, &byte);
+		if (rc != EOK)
+			return rc;
+
+		if (zterm && byte == 0)
+			break;
+
+		cnt--;
+	}
+
+	return EOK;
+}
+
+/** Parse GZIP header from the input
+ *
+ * @param reader GZIP reader.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression method or invalid stream.
+ * @return Error code returned by the input callback.
+ *
+ */
+static errno_t gzip_reader_header(gzip_reader_t *reader)
+{
+	gzip_header_t header;
+	uint8_t *hdr = (uint8_t *) &header;
+	uint8_t lo, hi;
+	errno_t rc;
+
+	for (size_t i = 0; i < sizeof(header); i++) {
+		rc = gzip_reader_byte(reader, &hdr[i]);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if ((header.id1 != GZIP_ID1) ||
+	    (header.id2 != GZIP_ID2) ||
+	    (header.method != GZIP_METHOD_DEFLATE) ||
+	    ((header.flags & (~GZIP_FLAGS_MASK)) != 0))
+		return EINVAL;
+
+	/* Ignore extra metadata */
+
+	if ((header.flags & GZIP_FLAG_FEXTRA) != 0) {
+		rc = gzip_reader_byte(reader, &lo);
+		if (rc == EOK)
+			rc = gzip_reader_byte(reader, &hi);
+		if (rc == EOK)
+			rc = gzip_reader_skip(reader, lo | (hi << 8), false);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if ((header.flags & GZIP_FLAG_FNAME) != 0) {
+		rc = gzip_reader_skip(reader, 0, true);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if ((header.flags & GZIP_FLAG_FCOMMENT) != 0) {
+		rc = gzip_reader_skip(reader, 0, true);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if ((header.flags & GZIP_FLAG_FHCRC) != 0) {
+		rc = gzip_reader_skip(reader, 2, false);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Pass input to the decompressor
+ *
+ * Input left over from parsing the header is passed first.
+ *
+ * @param arg   GZIP reader.
+ * @param buf   Buffer for compressed data.
+ * @param size  Size of @a buf in bytes.
+ * @param nread Place to store number of bytes read.
+ *
+ * @return EOK on success or an error code from the input callback.
+ *
+ */
+static errno_t gzip_reader_input(void *arg, void *buf, size_t size,
+    size_t *nread)
+{
+	gzip_reader_t *reader = (gzip_reader_t *) arg;
+	size_t cnt;
+
+	if (reader->bufpos < reader->buflen) {
+		cnt = min(size, reader->buflen - reader->bufpos);
+		memcpy(buf, reader->buf + reader->bufpos, cnt);
+		reader->bufpos += cnt;
+		*nread = cnt;
+		return EOK;
+	}
+
+	return reader->read(reader->arg, buf, size, nread);
+}
+
+/** Create GZIP stream reader
+ *
+ * The GZIP header is read and parsed immediately. Decompressed data
+ * can then be read using gzip_reader_read().
+ *
+ * @param read    Input callback providing the GZIP stream.
+ * @param arg     Input callback argument.
+ * @param rreader Place to store pointer to the new reader.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression method or invalid stream.
+ * @return ENOMEM if out of memory.
+ * @return Error code returned by @a read.
+ *
+ */
+errno_t gzip_reader_create(inflate_read_t read, void *arg,
+    gzip_reader_t **rreader)
+{
+	gzip_reader_t *reader;
+	errno_t rc;
+
+	reader = calloc(1, sizeof(gzip_reader_t));
+	if (reader == NULL)
+		return ENOMEM;
+
+	reader->read = read;
+	reader->arg = arg;
+
+	rc = gzip_reader_header(reader);
+	if (rc != EOK)
+		goto error;
+
+	rc = inflate_stream_create(gzip_reader_input, reader,
+	    &reader->inflate);
+	if (rc != EOK)
+		goto error;
+
+	*rreader = reader;
+	return EOK;
+error:
+	free(reader);
+	return rc;
+}
+
+/** Read decompressed data from GZIP stream
+ *
+ * Fewer bytes than requested are only returned at the end of the stream,
+ * once the CRC32 and size in the GZIP footer have been verified.
+ *
+ * @param reader GZIP reader.
+ * @param buf    Buffer for decompressed data.
+ * @param size   Size of @a buf in bytes.
+ * @param nread  Place to store number of bytes read.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid deflate data or checksum mismatch.
+ * @return Other error code returned by the decompressor or the input
+ *         callback.
+ *
+ */
+errno_t gzip_reader_read(gzip_reader_t *reader, void *buf, size_t size,
+    size_t *nread)
+{
+	gzip_footer_t footer;
+	size_t cnt;
+	errno_t rc;
+
+	if (reader->rc != EOK)
+		return reader->rc;
+
+	if (reader->done) {
+		*nread = 0;
+		return EOK;
+	}
+
+	rc = inflate_stream_read(reader->inflate, buf, size, &cnt);
+	if (rc != EOK)
+		goto error;
+
+	reader->crc32 = compute_crc32_seed(buf, cnt, reader->crc32);
+	reader->size += cnt;
+
+	if (cnt < size) {
+		/* End of deflate stream, verify footer */
+		rc = inflate_stream_tail(reader->inflate, &footer,
+		    sizeof(footer));
+		if (rc != EOK)
+			goto error;
+
+		if (uint32_t_le2host(footer.crc32) != reader->crc32 ||
+		    uint32_t_le2host(footer.size) != reader->size) {
+			rc = EINVAL;
+			goto error;
+		}
+
+		reader->done = true;
+	}
+
+	*nread = cnt;
+	return EOK;
+error:
+	reader->rc = rc;
+	return rc;
+}
+
+/** Destroy GZIP stream reader
+ *
+ * @param reader GZIP reader.
+ *
+ */
+void gzip_reader_destroy(gzip_reader_t *reader)
+{
+	if (reader == NULL)
+		return;
+
+	inflate_stream_destroy(reader->inflate);
+	free(reader);
+}
+
+/** Create GZIP stream writer
+ *
+ * The GZIP header is passed to the output callback immediately.
+ *
+ * @param level   Compression level (DEFLATE_LEVEL_MIN to DEFLATE_LEVEL_MAX).
+ * @param write   Output callback receiving the GZIP stream.
+ * @param arg     Output callback argument.
+ * @param rwriter Place to store pointer to the new writer.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression level.
+ * @return ENOMEM if out of memory.
+ * @return Error code returned by @a write.
+ *
+ */
+errno_t gzip_writer_create(int level, deflate_write_t write, void *arg,
+    gzip_writer_t **rwriter)
+{
+	gzip_writer_t *writer;
+	gzip_header_t header;
+	errno_t rc;
+
+	writer = calloc(1, sizeof(gzip_writer_t));
+	if (writer == NULL)
+		return ENOMEM;
+
+	writer->write = write;
+	writer->arg = arg;
+
+	rc = deflate_stream_create(level, write, arg, &writer->deflate);
+	if (rc != EOK)
+		goto error;
+
+	header.id1 = GZIP_ID1;
+	header.id2 = GZIP_ID2;
+	header.method = GZIP_METHOD_DEFLATE;
+	header.flags = 0;
+	header.mtime = 0;
+	header.extra_flags = (level == DEFLATE_LEVEL_MAX) ? GZIP_XFL_BEST :
+	    (level == DEFLATE_LEVEL_MIN) ? GZIP_XFL_FASTEST : 0;
+	header.os = GZIP_OS_UNKNOWN;
+
+	rc = write(arg, &header, sizeof(header));
+	if (rc != EOK) {
+		deflate_stream_destroy(writer->deflate);
+		goto error;
+	}
+
+	*rwriter = writer;
+	return EOK;
+error:
+	free(writer);
+	return rc;
+}
+
+/** Compress data into GZIP stream
+ *
+ * @param writer GZIP writer.
+ * @param data   Data to compress.
+ * @param size   Size of @a data in bytes.
+ *
+ * @return EOK on success or an error code returned by the output callback.
+ *
+ */
+errno_t gzip_writer_write(gzip_writer_t *writer, const void *data, size_t size)
+{
+	writer->crc32 = compute_crc32_seed((uint8_t *) data, size,
+	    writer->crc32);
+	writer->size += size;
+
+	return deflate_stream_write(writer->deflate, data, size);
+}
+
+/** Finish GZIP stream
+ *
+ * The rest of the compressed data and the GZIP footer are passed
+ * to the output callback.
+ *
+ * @param writer GZIP writer.
+ *
+ * @return EOK on success or an error code returned by the output callback.
+ *
+ */
+errno_t gzip_writer_finish(gzip_writer_t *writer)
+{
+	gzip_footer_t footer;
+	errno_t rc;
+
+	rc = deflate_stream_finish(writer->deflate);
+	if (rc != EOK)
+		return rc;
+
+	footer.crc32 = host2uint32_t_le(writer->crc32);
+	footer.size = host2uint32_t_le(writer->size);
+
+	return writer->write(writer->arg, &footer, sizeof(footer));
+}
+
+/** Destroy GZIP stream writer
+ *
+ * @param writer GZIP writer.
+ *
+ */
+void gzip_writer_destroy(gzip_writer_t *writer)
+{
+	if (writer == NULL)
+		return;
+
+	deflate_stream_destroy(writer->deflate);
+	free(writer);
+}
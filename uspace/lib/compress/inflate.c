@@ -31,11 +31,14 @@
  * @brief Implementation of inflate decompression
  *
  * A simple inflate implementation (decompression of `deflate' stream as
- * described by RFC 1951) based on puff.c by Mark Adler. This code is
- * currently not optimized for speed but for readability.
+ * described by RFC 1951) based on puff.c by Mark Adler. Unlike puff.c,
+ * Huffman codes are decoded by table lookup (as in zlib) rather than bit
+ * by bit, and input is read into the bit buffer a word at a time.
  *
- * All dynamically allocated memory memory is taken from the stack. The
- * stack usage should be typically bounded by 2 KB.
+ * The decoder state can be suspended between any two symbols, which
+ * allows decompressing a stream piece by piece through the
+ * inflate_stream_*() API with both input and output of arbitrary size.
+ * The one-shot inflate() keeps its state on the stack.
  *
  * Original copyright notice:
  *
@@ -67,7 +70,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <macros.h>
 #include <mem.h>
+#include <stdlib.h>
+#include <byteorder.h>
 #include "inflate.h"
 
 /** Maximum bits in the Huffman code */
@@ -87,6 +93,41 @@
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
+/** Index bits of the primary literal/length lookup table */
+#define LITLEN_ROOT  9
+/** Index bits of the primary distance lookup table */
+#define DIST_ROOT    6
+/** Index bits of the code length lookup table (no subtables needed) */
+#define ORDER_ROOT   7
+
+/** Maximum literal/length lookup table size including subtables
+ *
+ * The bounds are those computed by the `enough' utility of zlib
+ * for the respective number of symbols, root bits and maximum code
+ * length.
+ */
+#define ENOUGH_LITLEN  852
+/** Maximum distance lookup table size including subtables */
+#define ENOUGH_DIST    592
+/** Code length lookup table size */
+#define ENOUGH_ORDER   (1 << ORDER_ROOT)
+
+/** Maximum back reference distance */
+#define MAX_WINDOW  32768
+
+/** Size of output buffer when streaming
+ *
+ * Half of the buffer holds the previous window needed for back
+ * references, the other half collects new output.
+ */
+#define STREAM_BUF_SIZE  (2 * MAX_WINDOW)
+
+/** Size of input buffer when input is read through a callback */
+#define INPUT_BUF_SIZE  16384
+
+/** Maximum length of a back reference */
+#define MAX_MATCH  258
+
 /** Check for input buffer overrun condition */
 #define CHECK_OVERRUN(state) \
 	do { \
@@ -94,6 +135,39 @@
 			return ELIMIT; \
 	} while (false)
 
+/** Huffman lookup table entry
+ *
+ * An entry in the primary table either decodes a code of at most
+ * root bits directly or links to a subtable indexed by the bits
+ * following the first root bits.
+ *
+ */
+typedef struct {
+	uint16_t value;  /**< Symbol or subtable offset */
+	uint8_t len;     /**< Number of code bits to consume, 0 if invalid */
+	uint8_t sub;     /**< Subtable index bits, 0 if not a link */
+} huffman_entry_t;
+
+/** Huffman code description
+ *
+ */
+typedef struct {
+	uint16_t *count;         /**< Array of symbol counts */
+	uint16_t *symbol;        /**< Array of symbols */
+	huffman_entry_t *table;  /**< Lookup table */
+	size_t root;             /**< Index bits of the primary table */
+} huffman_t;
+
+/** Position of the decoder in the deflate stream
+ *
+ */
+typedef enum {
+	ism_header,  /**< Block header is next */
+	ism_stored,  /**< Inside a stored block */
+	ism_codes,   /**< Inside a block coded with Huffman codes */
+	ism_done     /**< Past the last block */
+} inflate_mode_t;
+
 /** Inflate algorithm state
  *
  */
@@ -102,23 +176,45 @@ typedef struct {
 	size_t destlen;   /**< Output buffer size */
 	size_t destcnt;   /**< Position in the output buffer */
 
-	uint8_t *src;     /**< Input buffer */
-	size_t srclen;    /**< Input buffer size */
-	size_t srccnt;    /**< Position in the input buffer */
+	bool stream;      /**< Output is taken piece by piece */
+	size_t readcnt;   /**< Output already taken when streaming */
+
+	const uint8_t *src;  /**< Input buffer */
+	size_t srclen;       /**< Input buffer size */
+	size_t srccnt;       /**< Position in the input buffer */
+
+	inflate_read_t read;  /**< Input callback or @c NULL */
+	void *read_arg;       /**< Input callback argument */
+	uint8_t *inbuf;       /**< Buffer for input from callback */
+	errno_t read_rc;      /**< Error returned by input callback */
 
-	uint16_t bitbuf;  /**< Bit buffer */
+	uint64_t bitbuf;  /**< Bit buffer */
 	size_t bitlen;    /**< Number of bits in the bit buffer */
 
 	bool overrun;     /**< Overrun condition */
+
+	inflate_mode_t mode;  /**< Position in the stream */
+	bool last;            /**< Current block is the last one */
+	size_t stored_left;   /**< Bytes left in the current stored block */
+
+	huffman_t len_code;   /**< Literal/length code of current block */
+	huffman_t dist_code;  /**< Distance code of current block */
+
+	uint16_t len_count[MAX_HUFFMAN_BIT + 1];
+	uint16_t len_symbol[MAX_LITLEN];
+	uint16_t dist_count[MAX_HUFFMAN_BIT + 1];
+	uint16_t dist_symbol[MAX_DIST];
+	huffman_entry_t len_table[ENOUGH_LITLEN];
+	huffman_entry_t dist_table[ENOUGH_DIST];
 } inflate_state_t;
 
-/** Huffman code description
+/** Inflate stream
  *
  */
-typedef struct {
-	uint16_t *count;   /**< Array of symbol counts */
-	uint16_t *symbol;  /**< Array of symbols */
-} huffman_t;
+struct inflate_stream {
+	inflate_state_t state;  /**< Decoder state */
+	errno_t rc;             /**< First error encountered */
+};
 
 /** Length codes
  *
@@ -210,21 +306,89 @@ static uint16_t dist_symbol[MAX_DIST] = {
 	16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29
 };
 
-/** Huffman code for lengths
+/** Read more input
+ *
+ * @param state Inflate state.
+ *
+ * @return @c true if more input is available in the input buffer.
  *
  */
-static huffman_t len_code = {
-	.count = len_count,
-	.symbol = len_symbol
-};
+static bool inflate_fill(inflate_state_t *state)
+{
+	size_t nread;
+	errno_t rc;
+
+	if (state->srccnt < state->srclen)
+		return true;
+
+	if (state->read == NULL || state->read_rc != EOK)
+		return false;
+
+	rc = state->read(state->read_arg, state->inbuf, INPUT_BUF_SIZE,
+	    &nread);
+	if (rc != EOK) {
+		state->read_rc = rc;
+		return false;
+	}
+
+	state->src = state->inbuf;
+	state->srclen = nread;
+	state->srccnt = 0;
+
+	return nread > 0;
+}
+
+/** Refill the bit buffer byte by byte
+ *
+ * Used near the end of the input buffer, reading more input through
+ * the input callback as needed.
+ *
+ * @param state Inflate state.
+ *
+ */
+static void bits_refill_slow(inflate_state_t *state)
+{
+	while (state->bitlen <= 56) {
+		if (state->srccnt == state->srclen && !inflate_fill(state))
+			break;
+
+		state->bitbuf |=
+		    ((uint64_t) state->src[state->srccnt]) << state->bitlen;
+		state->srccnt++;
+		state->bitlen += 8;
+	}
+}
 
-/** Huffman code for distances
+/** Refill the bit buffer
+ *
+ * Load as many whole bytes as fit into the bit buffer. Unless the end
+ * of the input buffer is near, this is done with a single 64-bit load.
+ * Afterwards the bit buffer holds at least 56 bits or all the remaining
+ * input.
+ *
+ * @param state Inflate state.
  *
  */
-static huffman_t dist_code = {
-	.count = dist_count,
-	.symbol = dist_symbol
-};
+static inline void bits_refill(inflate_state_t *state)
+{
+	uint64_t word;
+	size_t cnt;
+
+	if (state->srclen - state->srccnt >= sizeof(uint64_t)) {
+		memcpy(&word, state->src + state->srccnt, sizeof(uint64_t));
+		word = uint64_t_le2host(word);
+
+		cnt = (63 - state->bitlen) >> 3;
+		word &= ((uint64_t) 1 << (cnt << 3)) - 1;
+
+		state->bitbuf |= word << state->bitlen;
+		state->srccnt += cnt;
+		state->bitlen += cnt << 3;
+		return;
+	}
+
+	bits_refill_slow(state);
+}
 
 /** Get bits from the bit buffer
  *
@@ -236,71 +400,133 @@ static huffman_t dist_code = {
  */
 static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
 {
-	/* Bit accumulator for at least 20 bits */
-	uint32_t val = state->bitbuf;
+	uint16_t val;
 
-	while (state->bitlen < cnt) {
-		if (state->srccnt == state->srclen) {
+	if (state->bitlen < cnt) {
+		bits_refill(state);
+		if (state->bitlen < cnt) {
 			state->overrun = true;
 			return 0;
 		}
-
-		/* Load 8 more bits */
-		val |= ((uint32_t) state->src[state->srccnt]) << state->bitlen;
-		state->srccnt++;
-		state->bitlen += 8;
 	}
 
+	val = (uint16_t) (state->bitbuf & ((1 << cnt) - 1));
+
 	/* Update bits in the buffer */
-	state->bitbuf = (uint16_t) (val >> cnt);
+	state->bitbuf >>= cnt;
 	state->bitlen -= cnt;
 
-	return ((uint16_t) (val & ((1 << cnt) - 1)));
+	return val;
 }
 
-/** Decode `stored' block
+/** Make room in the output buffer
+ *
+ * When streaming, only the last window (needed for back references) is
+ * kept in the output buffer once all output has been taken.
  *
  * @param state Inflate state.
+ * @param len   Number of bytes needed (at most MAX_WINDOW).
  *
  * @return EOK on success.
- * @return ELIMIT on input buffer overrun.
  * @return ENOMEM on output buffer overrun.
+ * @return EBUSY if the output buffer is full of output not taken yet.
+ *
+ */
+static errno_t inflate_room(inflate_state_t *state, size_t len)
+{
+	size_t keep;
+
+	if (state->destcnt + len <= state->destlen)
+		return EOK;
+
+	if (!state->stream)
+		return ENOMEM;
+
+	if (state->readcnt < state->destcnt)
+		return EBUSY;
+
+	keep = min(state->destcnt, MAX_WINDOW);
+	memmove(state->dest, state->dest + state->destcnt - keep, keep);
+	state->destcnt = keep;
+	state->readcnt = keep;
+
+	return EOK;
+}
+
+/** Decode `stored' block header
+ *
+ * @param state Inflate state.
+ *
+ * @return EOK on success.
+ * @return ELIMIT on input buffer overrun.
  * @return EINVAL on invalid data.
  *
  */
-static errno_t inflate_stored(inflate_state_t *state)
+static errno_t inflate_stored_header(inflate_state_t *state)
 {
-	/* Discard bits in the bit buffer */
-	state->bitbuf = 0;
-	state->bitlen = 0;
+	/* Discard bits up to the byte boundary */
+	(void) get_bits(state, state->bitlen & 7);
 
-	if (state->srccnt + 4 > state->srclen)
-		return ELIMIT;
+	uint16_t len = get_bits(state, 16);
+	CHECK_OVERRUN(*state);
 
-	uint16_t len =
-	    state->src[state->srccnt] | (state->src[state->srccnt + 1] << 8);
-	uint16_t len_compl =
-	    state->src[state->srccnt + 2] | (state->src[state->srccnt + 3] << 8);
+	uint16_t len_compl = get_bits(state, 16);
+	CHECK_OVERRUN(*state);
 
 	/* Check block length and its complement */
-	if (((int16_t) len) != ~((int16_t) len_compl))
+	if ((uint16_t) (len ^ len_compl) != 0xffff)
 		return EINVAL;
 
-	state->srccnt += 4;
+	state->stored_left = len;
+	state->mode = ism_stored;
+	return EOK;
+}
 
-	/* Check input buffer size */
-	if (state->srccnt + len > state->srclen)
-		return ELIMIT;
+/** Decode `stored' block
+ *
+ * @param state Inflate state.
+ *
+ * @return EOK on success.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun.
+ * @return EBUSY if output needs to be taken first.
+ *
+ */
+static errno_t inflate_stored(inflate_state_t *state)
+{
+	while (state->stored_left > 0) {
+		size_t chunk = min(state->stored_left, MAX_WINDOW);
 
-	/* Check output buffer size */
-	if (state->destcnt + len > state->destlen)
-		return ENOMEM;
+		errno_t rc = inflate_room(state, state->stream ? 1 : chunk);
+		if (rc != EOK)
+			return rc;
+
+		chunk = min(chunk, state->destlen - state->destcnt);
+		state->stored_left -= chunk;
+
+		/* Whole bytes already in the bit buffer come first */
+		while (chunk > 0 && state->bitlen >= 8) {
+			state->dest[state->destcnt] = get_bits(state, 8);
+			state->destcnt++;
+			chunk--;
+		}
+
+		while (chunk > 0) {
+			if (!inflate_fill(state)) {
+				state->overrun = true;
+				return ELIMIT;
+			}
 
-	/* Copy data */
-	memcpy(state->dest + state->destcnt, state->src + state->srccnt, len);
-	state->srccnt += len;
-	state->destcnt += len;
+			size_t n = min(chunk, state->srclen - state->srccnt);
+			memcpy(state->dest + state->destcnt,
+			    state->src + state->srccnt, n);
+			state->srccnt += n;
+			state->destcnt += n;
+			chunk -= n;
+		}
+	}
 
+	state->mode = ism_header;
 	return EOK;
 }
 
@@ -312,46 +538,199 @@ static errno_t inflate_stored(inflate_state_t *state)
  *
  * @param EOK on success.
  * @param EINVAL on invalid Huffman code.
+ * @param ELIMIT on input buffer overrun.
  *
  */
-static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
-    uint16_t *symbol)
+static inline errno_t huffman_decode(inflate_state_t *state,
+    huffman_t *huffman, uint16_t *symbol)
 {
-	/* Decode bits */
-	uint16_t code = 0;
+	huffman_entry_t entry;
+	size_t used = 0;
+
+	if (state->bitlen < MAX_HUFFMAN_BIT)
+		bits_refill(state);
+
+	/* Missing bits at the end of input read as zeros */
+	entry = huffman->table[state->bitbuf & ((1 << huffman->root) - 1)];
+	if (entry.sub != 0) {
+		used = huffman->root;
+		entry = huffman->table[entry.value +
+		    ((state->bitbuf >> used) & ((1 << entry.sub) - 1))];
+	}
 
-	/* First code of the given length */
-	size_t first = 0;
+	used += entry.len;
+	if (entry.len == 0 || used > state->bitlen) {
+		if (state->bitlen < MAX_HUFFMAN_BIT) {
+			state->overrun = true;
+			return ELIMIT;
+		}
 
-	/*
-	 * Index of the first code of the given length
-	 * in the symbol table
-	 */
-	size_t index = 0;
+		return EINVAL;
+	}
+
+	state->bitbuf >>= used;
+	state->bitlen -= used;
+
+	*symbol = entry.value;
+	return EOK;
+}
+
+/** Reverse bits of a Huffman code
+ *
+ * Huffman codes are packed starting with the most significant bit,
+ * other data starting with the least significant bit.
+ *
+ * @param code Code.
+ * @param len  Length of the code in bits.
+ *
+ * @return Code with bits in reverse order.
+ *
+ */
+static size_t huffman_reverse(size_t code, size_t len)
+{
+	size_t rev = 0;
+
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
+	}
 
-	/* Current number of bits in the code */
+	return rev;
+}
+
+/** Build Huffman lookup table
+ *
+ * Codes of at most root bits get all their primary table entries filled
+ * in, longer codes are placed in subtables. Codes sharing their first
+ * root bits share one subtable, which is made just large enough to hold
+ * them (the same way zlib does it).
+ *
+ * @param huffman Huffman code with counts and symbols already set up.
+ * @param size    Size of the lookup table.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the lookup table is too small.
+ *
+ */
+static errno_t huffman_table(huffman_t *huffman, size_t size)
+{
+	huffman_entry_t *table = huffman->table;
+	uint16_t left[MAX_HUFFMAN_BIT + 1];
+	size_t root = huffman->root;
+	size_t mask = (1 << root) - 1;
+	size_t next = 1 << root;
+	size_t low = (size_t) -1;
+	size_t sub_base = 0;
+	size_t sub_bits = 0;
+	size_t index = 0;
+	size_t code = 0;
 	size_t len;
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < next; i++)
+		table[i] = (huffman_entry_t) { 0, 0, 0 };
+
+	for (len = 0; len <= MAX_HUFFMAN_BIT; len++)
+		left[len] = huffman->count[len];
 
 	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
-		/* Get next bit */
-		code |= get_bits(state, 1);
-		CHECK_OVERRUN(*state);
+		for (i = 0; i < huffman->count[len]; i++) {
+			uint16_t symbol = huffman->symbol[index];
+			size_t rev = huffman_reverse(code, len);
 
-		uint16_t count = huffman->count[len];
-		if (code < first + count) {
-			/* Return decoded symbol */
-			*symbol = huffman->symbol[index + code - first];
-			return EOK;
+			index++;
+			code++;
+
+			if (len <= root) {
+				for (j = rev; j <= mask; j += (size_t) 1 << len)
+					table[j] = (huffman_entry_t) { symbol, len, 0 };
+				continue;
+			}
+
+			if ((rev & mask) != low) {
+				/*
+				 * Start a new subtable. Grow it until it can
+				 * hold all remaining codes with this prefix.
+				 */
+				size_t curr = len - root;
+				int slots = 1 << curr;
+
+				while (curr + root < MAX_HUFFMAN_BIT) {
+					slots -= left[curr + root];
+					if (slots <= 0)
+						break;
+
+					curr++;
+					slots <<= 1;
+				}
+
+				if (next + ((size_t) 1 << curr) > size)
+					return EINVAL;
+
+				low = rev & mask;
+				sub_base = next;
+				sub_bits = curr;
+				next += (size_t) 1 << curr;
+
+				for (j = sub_base; j < next; j++)
+					table[j] = (huffman_entry_t) { 0, 0, 0 };
+
+				table[low] = (huffman_entry_t) {
+					sub_base, root, sub_bits
+				};
+			}
+
+			for (j = rev >> root; j < ((size_t) 1 << sub_bits);
+			    j += (size_t) 1 << (len - root)) {
+				table[sub_base + j] =
+				    (huffman_entry_t) { symbol, len - root, 0 };
+			}
+
+			left[len]--;
 		}
 
-		/* Update for next length */
-		index += count;
-		first += count;
-		first <<= 1;
 		code <<= 1;
 	}
 
-	return EINVAL;
+	return EOK;
+}
+
+/** Copy back reference
+ *
+ * @param out  Output position.
+ * @param dist Distance back (at least 1).
+ * @param len  Number of bytes to copy.
+ *
+ */
+static inline void inflate_copy(uint8_t *out, size_t dist, size_t len)
+{
+	const uint8_t *from = out - dist;
+
+	if (dist >= len) {
+		memcpy(out, from, len);
+		return;
+	}
+
+	/*
+	 * Source and destination overlap, so bytes just written are read
+	 * again. Copy byte by byte, four at a time.
+	 */
+	while (len >= 4) {
+		out[0] = from[0];
+		out[1] = from[1];
+		out[2] = from[2];
+		out[3] = from[3];
+		out += 4;
+		from += 4;
+		len -= 4;
+	}
+
+	while (len > 0) {
+		*out++ = *from++;
+		len--;
+	}
 }
 
 /** Construct Huffman tables from canonical Huffman code
@@ -412,26 +791,36 @@ static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
 
 /** Decode literal/length and distance codes
  *
- * Decode until end-of-block code.
+ * Decode until end-of-block code. When streaming, decoding stops
+ * early if the output buffer fills up and is resumed later.
  *
  * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
  *
  * @return EOK on success.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code.
  * @return ELIMIT on input buffer overrun.
  * @return ENOMEM on output buffer overrun.
+ * @return EBUSY if output needs to be taken first.
  *
  */
-static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_codes(inflate_state_t *state)
 {
+	huffman_t *len_code = &state->len_code;
+	huffman_t *dist_code = &state->dist_code;
 	uint16_t symbol;
+	errno_t err;
+
+	while (true) {
+		if (state->stream &&
+		    state->destlen - state->destcnt < MAX_MATCH) {
+			/* Stop between symbols if the longest match won't fit */
+			err = inflate_room(state, MAX_MATCH);
+			if (err != EOK)
+				return err;
+		}
 
-	do {
-		errno_t err = huffman_decode(state, len_code, &symbol);
+		err = huffman_decode(state, len_code, &symbol);
 		if (err != EOK) {
 			/* Error decoding */
 			return err;
@@ -439,90 +828,113 @@ static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
 
 		if (symbol < 256) {
 			/* Write out literal */
-			if (state->destcnt == state->destlen)
-				return ENOMEM;
+			if (state->destcnt == state->destlen) {
+				err = inflate_room(state, 1);
+				if (err != EOK)
+					return err;
+			}
 
 			state->dest[state->destcnt] = (uint8_t) symbol;
 			state->destcnt++;
-		} else if (symbol > 256) {
-			/* Compute length */
-			symbol -= 257;
-			if (symbol >= 29)
-				return EINVAL;
+			continue;
+		}
 
-			size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
-			CHECK_OVERRUN(*state);
+		if (symbol == 256)
+			break;
 
-			/* Get distance */
-			err = huffman_decode(state, dist_code, &symbol);
-			if (err != EOK)
-				return err;
+		/* Compute length */
+		symbol -= 257;
+		if (symbol >= 29)
+			return EINVAL;
 
-			size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
-			if (dist > state->destcnt)
-				return ENOENT;
+		size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
+		CHECK_OVERRUN(*state);
 
-			if (state->destcnt + len > state->destlen)
-				return ENOMEM;
+		/* Get distance */
+		err = huffman_decode(state, dist_code, &symbol);
+		if (err != EOK)
+			return err;
 
-			while (len > 0) {
-				/* Copy len bytes from distance bytes back */
-				state->dest[state->destcnt] =
-				    state->dest[state->destcnt - dist];
-				state->destcnt++;
-				len--;
-			}
-		}
-	} while (symbol != 256);
+		size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
+		CHECK_OVERRUN(*state);
+
+		err = inflate_room(state, len);
+		if (err != EOK)
+			return err;
+
+		if (dist > state->destcnt)
+			return ENOENT;
+
+		/* Copy len bytes from distance bytes back */
+		inflate_copy(state->dest + state->destcnt, dist, len);
+		state->destcnt += len;
+	}
 
+	state->mode = ism_header;
 	return EOK;
 }
 
-/** Decode `fixed codes' block
+/** Decode `fixed codes' block header
+ *
+ * Set up the fixed codes for decoding the block.
  *
  * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
  *
  */
-static errno_t inflate_fixed(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_fixed(inflate_state_t *state)
 {
-	return inflate_codes(state, len_code, dist_code);
+	errno_t rc;
+
+	/* All fixed codes fit in the primary tables */
+	state->len_code.count = len_count;
+	state->len_code.symbol = len_symbol;
+	state->len_code.table = state->len_table;
+	state->len_code.root = LITLEN_ROOT;
+	rc = huffman_table(&state->len_code, 1 << LITLEN_ROOT);
+	if (rc != EOK)
+		return rc;
+
+	state->dist_code.count = dist_count;
+	state->dist_code.symbol = dist_symbol;
+	state->dist_code.table = state->dist_table;
+	state->dist_code.root = DIST_ROOT;
+	rc = huffman_table(&state->dist_code, 1 << DIST_ROOT);
+	if (rc != EOK)
+		return rc;
+
+	state->mode = ism_codes;
+	return EOK;
 }
 
 /** Decode `dynamic codes' block
+ *
+ * Read the code descriptions and set up the codes for decoding
+ * the block.
  *
  * @param state     Inflate state.
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code.
  * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
  *
  */
 static errno_t inflate_dynamic(inflate_state_t *state)
 {
 	uint16_t length[MAX_CODE];
-	uint16_t dyn_len_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_len_symbol[MAX_LITLEN];
-	uint16_t dyn_dist_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_dist_symbol[MAX_DIST];
-	huffman_t dyn_len_code;
-	huffman_t dyn_dist_code;
+	huffman_t *dyn_len_code = &state->len_code;
+	huffman_t *dyn_dist_code = &state->dist_code;
 
-	dyn_len_code.count = dyn_len_count;
-	dyn_len_code.symbol = dyn_len_symbol;
+	dyn_len_code->count = state->len_count;
+	dyn_len_code->symbol = state->len_symbol;
+	dyn_len_code->table = state->len_table;
 
-	dyn_dist_code.count = dyn_dist_count;
-	dyn_dist_code.symbol = dyn_dist_symbol;
+	dyn_dist_code->count = state->dist_count;
+	dyn_dist_code->symbol = state->dist_symbol;
+	dyn_dist_code->table = state->dist_table;
+	dyn_dist_code->root = DIST_ROOT;
 
 	/* Get number of bits in each table */
 	uint16_t nlen = get_bits(state, 5) + 257;
@@ -550,17 +962,23 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 		length[order[index]] = 0;
 
 	/* Build Huffman code */
-	int16_t rc = huffman_construct(&dyn_len_code, length, MAX_ORDER);
+	int16_t rc = huffman_construct(dyn_len_code, length, MAX_ORDER);
 	if (rc != 0)
 		return EINVAL;
 
+	/* Code lengths are at most 7 bits, all fit in the primary table */
+	dyn_len_code->root = ORDER_ROOT;
+	errno_t err = huffman_table(dyn_len_code, ENOUGH_ORDER);
+	if (err != EOK)
+		return err;
+
 	/* Read length/literal and distance code length tables */
 	index = 0;
 	while (index < nlen + ndist) {
 		uint16_t symbol;
-		errno_t err = huffman_decode(state, &dyn_len_code, &symbol);
+		err = huffman_decode(state, dyn_len_code, &symbol);
 		if (err != EOK)
-			return EOK;
+			return err;
 
 		if (symbol < 16) {
 			length[index] = symbol;
@@ -599,16 +1017,144 @@ static errno_t inflate_dynamic(inflate_state_t *state)
 		return EINVAL;
 
 	/* Build Huffman tables for literal/length codes */
-	rc = huffman_construct(&dyn_len_code, length, nlen);
-	if ((rc < 0) || ((rc > 0) && (dyn_len_code.count[0] + 1 != nlen)))
+	rc = huffman_construct(dyn_len_code, length, nlen);
+	if ((rc < 0) || ((rc > 0) && (dyn_len_code->count[0] + 1 != nlen)))
 		return EINVAL;
 
+	dyn_len_code->root = LITLEN_ROOT;
+	err = huffman_table(dyn_len_code, ENOUGH_LITLEN);
+	if (err != EOK)
+		return err;
+
 	/* Build Huffman tables for distance codes */
-	rc = huffman_construct(&dyn_dist_code, length + nlen, ndist);
-	if ((rc < 0) || ((rc > 0) && (dyn_dist_code.count[0] + 1 != ndist)))
+	rc = huffman_construct(dyn_dist_code, length + nlen, ndist);
+	if ((rc < 0) || ((rc > 0) && (dyn_dist_code->count[0] + 1 != ndist)))
+		return EINVAL;
+
+	err = huffman_table(dyn_dist_code, ENOUGH_DIST);
+	if (err != EOK)
+		return err;
+
+	state->mode = ism_codes;
+	return EOK;
+}
+
+/** Decode block header
+ *
+ * @param state Inflate state.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+static errno_t inflate_header(inflate_state_t *state)
+{
+	if (state->last) {
+		state->mode = ism_done;
+		return EOK;
+	}
+
+	/* Last block is indicated by a non-zero bit */
+	state->last = get_bits(state, 1);
+	CHECK_OVERRUN(*state);
+
+	/* Block type */
+	uint16_t type = get_bits(state, 2);
+	CHECK_OVERRUN(*state);
+
+	switch (type) {
+	case 0:
+		return inflate_stored_header(state);
+	case 1:
+		return inflate_fixed(state);
+	case 2:
+		return inflate_dynamic(state);
+	default:
 		return EINVAL;
+	}
+}
+
+/** Initialize inflate state
+ *
+ * @param state   Inflate state.
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ *
+ */
+static void inflate_init(inflate_state_t *state, const void *src,
+    size_t srclen, void *dest, size_t destlen)
+{
+	state->dest = (uint8_t *) dest;
+	state->destlen = destlen;
+	state->destcnt = 0;
+
+	state->stream = false;
+	state->readcnt = 0;
+
+	state->src = (const uint8_t *) src;
+	state->srclen = srclen;
+	state->srccnt = 0;
+
+	state->read = NULL;
+	state->read_arg = NULL;
+	state->inbuf = NULL;
+	state->read_rc = EOK;
 
-	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
+	state->bitbuf = 0;
+	state->bitlen = 0;
+
+	state->overrun = false;
+
+	state->mode = ism_header;
+	state->last = false;
+	state->stored_left = 0;
+}
+
+/** Decode blocks
+ *
+ * Decode until the end of the last block or, when streaming, until
+ * the output buffer is full of output that has not been taken yet.
+ *
+ * @param state Inflate state.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+static errno_t inflate_run(inflate_state_t *state)
+{
+	errno_t rc = EOK;
+
+	while (state->mode != ism_done) {
+		switch (state->mode) {
+		case ism_header:
+			rc = inflate_header(state);
+			break;
+		case ism_stored:
+			rc = inflate_stored(state);
+			break;
+		case ism_codes:
+			rc = inflate_codes(state);
+			break;
+		case ism_done:
+			break;
+		}
+
+		if (rc == EBUSY) {
+			/* Resume once output has been taken */
+			return EOK;
+		}
+
+		if (rc != EOK) {
+			/* Report input errors rather than the overrun */
+			if (state->read_rc != EOK)
+				return state->read_rc;
+
+			return rc;
+		}
+	}
+
+	return EOK;
 }
 
 /** Inflate data
@@ -627,48 +1173,244 @@ static errno_t inflate_dynamic(inflate_state_t *state)
  */
 errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
 {
-	/* Initialize the state */
 	inflate_state_t state;
 
-	state.dest = (uint8_t *) dest;
-	state.destlen = destlen;
-	state.destcnt = 0;
+	inflate_init(&state, src, srclen, dest, destlen);
+	return inflate_run(&state);
+}
 
-	state.src = (uint8_t *) src;
-	state.srclen = srclen;
-	state.srccnt = 0;
+/** Create inflate stream
+ *
+ * @param src     Source data buffer or @c NULL.
+ * @param srclen  Source buffer size (bytes).
+ * @param read    Input callback or @c NULL.
+ * @param arg     Argument to the input callback.
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success or ENOMEM if out of memory.
+ *
+ */
+static errno_t inflate_stream_init(const void *src, size_t srclen,
+    inflate_read_t read, void *arg, inflate_stream_t **rstream)
+{
+	inflate_stream_t *stream;
+	uint8_t *buf;
+	uint8_t *inbuf = NULL;
 
-	state.bitbuf = 0;
-	state.bitlen = 0;
+	stream = calloc(1, sizeof(inflate_stream_t));
+	if (stream == NULL)
+		return ENOMEM;
+
+	buf = malloc(STREAM_BUF_SIZE);
+	if (buf == NULL)
+		goto error;
+
+	if (read != NULL) {
+		inbuf = malloc(INPUT_BUF_SIZE);
+		if (inbuf == NULL)
+			goto error;
+	}
+
+	inflate_init(&stream->state, src, srclen, buf, STREAM_BUF_SIZE);
+	stream->state.stream = true;
+	stream->state.read = read;
+	stream->state.read_arg = arg;
+	stream->state.inbuf = inbuf;
+	stream->rc = EOK;
 
-	state.overrun = false;
+	*rstream = stream;
+	return EOK;
+error:
+	free(buf);
+	free(stream);
+	return ENOMEM;
+}
+
+/** Create inflate stream
+ *
+ * Compressed data is read through @a read as needed and decompressed
+ * data is taken with inflate_stream_read(). Only a fixed-size window
+ * of recent output (needed for back references) and a small input
+ * buffer are kept in memory, so the size of the data is not limited.
+ *
+ * @param read    Input callback.
+ * @param arg     Argument to the input callback.
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success or ENOMEM if out of memory.
+ *
+ */
+errno_t inflate_stream_create(inflate_read_t read, void *arg,
+    inflate_stream_t **rstream)
+{
+	return inflate_stream_init(NULL, 0, read, arg, rstream);
+}
 
-	uint16_t last;
-	errno_t ret = EOK;
+/** Destroy inflate stream
+ *
+ * @param stream Inflate stream or @c NULL.
+ *
+ */
+void inflate_stream_destroy(inflate_stream_t *stream)
+{
+	if (stream == NULL)
+		return;
 
-	do {
-		/* Last block is indicated by a non-zero bit */
-		last = get_bits(&state, 1);
-		CHECK_OVERRUN(state);
+	free(stream->state.dest);
+	free(stream->state.inbuf);
+	free(stream);
+}
 
-		/* Block type */
-		uint16_t type = get_bits(&state, 2);
-		CHECK_OVERRUN(state);
+/** Read decompressed data from inflate stream
+ *
+ * @param stream Inflate stream.
+ * @param buf    Buffer for decompressed data.
+ * @param size   Number of bytes to read.
+ * @param nread  Place to store number of bytes read. Less than
+ *               @a size only at the end of the stream.
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT if the input ends prematurely.
+ * @return Error code returned by the input callback.
+ *
+ */
+errno_t inflate_stream_read(inflate_stream_t *stream, void *buf,
+    size_t size, size_t *nread)
+{
+	inflate_state_t *state = &stream->state;
+	uint8_t *bp = (uint8_t *) buf;
+	size_t done = 0;
+
+	if (stream->rc != EOK)
+		return stream->rc;
+
+	while (done < size) {
+		if (state->readcnt < state->destcnt) {
+			size_t n = min(size - done,
+			    state->destcnt - state->readcnt);
+			memcpy(bp + done, state->dest + state->readcnt, n);
+			state->readcnt += n;
+			done += n;
+			continue;
+		}
 
-		switch (type) {
-		case 0:
-			ret = inflate_stored(&state);
+		if (state->mode == ism_done)
 			break;
-		case 1:
-			ret = inflate_fixed(&state, &len_code, &dist_code);
+
+		stream->rc = inflate_run(state);
+		if (stream->rc != EOK)
+			return stream->rc;
+	}
+
+	*nread = done;
+	return EOK;
+}
+
+/** Read data following the end of the deflate stream
+ *
+ * Data formats wrapping deflate streams have trailers after the end
+ * of the stream. This reads them from the same input, starting at the
+ * first byte boundary after the last block.
+ *
+ * @param stream Inflate stream, decoded to the end.
+ * @param buf    Buffer for the data.
+ * @param size   Number of bytes to read.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the end of the deflate stream was not reached.
+ * @return ELIMIT if the input ends prematurely.
+ * @return Error code returned by the input callback.
+ *
+ */
+errno_t inflate_stream_tail(inflate_stream_t *stream, void *buf, size_t size)
+{
+	inflate_state_t *state = &stream->state;
+	uint8_t *bp = (uint8_t *) buf;
+
+	if (stream->rc != EOK)
+		return stream->rc;
+
+	if (state->mode != ism_done)
+		return EINVAL;
+
+	/* Discard bits up to the byte boundary */
+	(void) get_bits(state, state->bitlen & 7);
+
+	while (size > 0) {
+		if (state->bitlen >= 8) {
+			*bp = get_bits(state, 8);
+		} else {
+			if (!inflate_fill(state)) {
+				if (state->read_rc != EOK)
+					return state->read_rc;
+
+				return ELIMIT;
+			}
+
+			*bp = state->src[state->srccnt];
+			state->srccnt++;
+		}
+
+		bp++;
+		size--;
+	}
+
+	return EOK;
+}
+
+/** Inflate data, passing output to a callback
+ *
+ * The output is produced piece by piece, so the whole decompressed data
+ * never needs to be held in memory. Only a fixed-size window of recent
+ * output (needed for back references) is kept.
+ *
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param write   Output callback.
+ * @param arg     Argument to the output callback.
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM if out of memory.
+ * @return Error code returned by @a write.
+ *
+ */
+errno_t inflate_stream(void *src, size_t srclen, inflate_write_t write,
+    void *arg)
+{
+	inflate_stream_t *stream;
+	inflate_state_t *state;
+	errno_t rc;
+
+	rc = inflate_stream_init(src, srclen, NULL, NULL, &stream);
+	if (rc != EOK)
+		return rc;
+
+	state = &stream->state;
+
+	while (true) {
+		/* Pass output directly from the window */
+		if (state->readcnt < state->destcnt) {
+			rc = write(arg, state->dest + state->readcnt,
+			    state->destcnt - state->readcnt);
+			if (rc != EOK)
+				break;
+
+			state->readcnt = state->destcnt;
+		}
+
+		if (state->mode == ism_done)
 			break;
-		case 2:
-			ret = inflate_dynamic(&state);
+
+		rc = inflate_run(state);
+		if (rc != EOK)
 			break;
-		default:
-			ret = EINVAL;
-		}
-	} while ((!last) && (ret == 0));
+	}
 
-	return ret;
+	inflate_stream_destroy(stream);
+	return rc;
 }
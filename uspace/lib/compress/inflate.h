@@ -29,8 +29,38 @@
 #ifndef LIBCOMPRESS_INFLATE_H_
 #define LIBCOMPRESS_INFLATE_H_
 
+#include <errno.h>
 #include <stddef.h>
 
+/** Inflate output callback
+ *
+ * @param arg  Callback argument
+ * @param data Decompressed data
+ * @param size Size of @a data in bytes
+ * @return EOK to continue or an error code to abort decompression
+ */
+typedef errno_t (*inflate_write_t)(void *, const void *, size_t);
+
+/** Inflate input callback
+ *
+ * @param arg   Callback argument
+ * @param buf   Buffer for compressed data
+ * @param size  Size of @a buf in bytes
+ * @param nread Place to store number of bytes read, 0 at end of input
+ * @return EOK on success or an error code to abort decompression
+ */
+typedef errno_t (*inflate_read_t)(void *, void *, size_t, size_t *);
+
+/** Inflate stream */
+typedef struct inflate_stream inflate_stream_t;
+
 extern errno_t inflate(void *, size_t, void *, size_t);
+extern errno_t inflate_stream(void *, size_t, inflate_write_t, void *);
+extern errno_t inflate_stream_create(inflate_read_t, void *,
+    inflate_stream_t **);
+extern void inflate_stream_destroy(inflate_stream_t *);
+extern errno_t inflate_stream_read(inflate_stream_t *, void *, size_t,
+    size_t *);
+extern errno_t inflate_stream_tail(inflate_stream_t *, void *, size_t);
 
 #endif
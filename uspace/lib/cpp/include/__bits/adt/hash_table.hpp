@@ -29,7 +29,7 @@
 #ifndef LIBCPP_BITS_ADT_HASH_TABLE
 #define LIBCPP_BITS_ADT_HASH_TABLE
 
-#include <__bits/adt/list_node.hpp>
+#include <__bits/adt/hash_table_node.hpp>
 #include <__bits/adt/key_extractors.hpp>
 #include <__bits/adt/hash_table_iterators.hpp>
 #include <__bits/adt/hash_table_policies.hpp>
@@ -79,24 +79,28 @@ namespace std::aux
             using local_iterator       = LocalIterator;
             using const_local_iterator = ConstLocalIterator;
 
-            using node_type = list_node<value_type>;
+            using node_type = hash_table_node<value_type>;
 
+            /**
+             * Bucket, matching node (or the bucket head),
+             * bucket index and the hash of the key.
+             */
             using place_type = tuple<
                 hash_table_bucket<value_type, size_type>*,
-                list_node<value_type>*, size_type
+                node_type*, size_type, size_t
             >;
 
             hash_table(size_type buckets, float max_load_factor = 1.f)
                 : table_{new hash_table_bucket<value_type, size_type>[buckets]()},
                   bucket_count_{buckets}, size_{}, hasher_{}, key_eq_{},
-                  key_extractor_{}, max_load_factor_{max_load_factor}
+                  key_extractor_{}, max_load_factor_{max_load_factor}, pool_{}
             { /* DUMMY BODY */ }
 
             hash_table(size_type buckets, const hasher& hf, const key_equal& eql,
                        float max_load_factor = 1.f)
                 : table_{new hash_table_bucket<value_type, size_type>[buckets]()},
                   bucket_count_{buckets}, size_{}, hasher_{hf}, key_eq_{eql},
-                  key_extractor_{}, max_load_factor_{max_load_factor}
+                  key_extractor_{}, max_load_factor_{max_load_factor}, pool_{}
             { /* DUMMY BODY */ }
 
             hash_table(const hash_table& other)
@@ -111,7 +115,7 @@ namespace std::aux
                 : table_{other.table_}, bucket_count_{other.bucket_count_},
                   size_{other.size_}, hasher_{move(other.hasher_)},
                   key_eq_{move(other.key_eq_)}, key_extractor_{move(other.key_extractor_)},
-                  max_load_factor_{other.max_load_factor_}
+                  max_load_factor_{other.max_load_factor_}, pool_{move(other.pool_)}
             {
                 other.table_ = nullptr;
                 other.bucket_count_ = size_type{};
@@ -221,7 +225,7 @@ namespace std::aux
                  * Note: This way we will continue on the next bucket
                  *       if this is the last element in its bucket.
                  */
-                iterator res{table_, idx, size_, node};
+                iterator res{table_, idx, bucket_count_, node};
                 ++res;
 
                 if (table_[idx].head == node)
@@ -234,7 +238,7 @@ namespace std::aux
                 --size_;
 
                 node->unlink();
-                delete node;
+                pool_.destroy(node);
 
                 if (empty())
                     return end();
@@ -245,14 +249,14 @@ namespace std::aux
             void clear() noexcept
             {
                 for (size_type i = 0; i < bucket_count_; ++i)
-                    table_[i].clear();
+                    table_[i].clear(pool_);
                 size_ = size_type{};
             }
 
             void swap(hash_table& other)
                 noexcept(allocator_traits<allocator_type>::is_always_equal::value &&
-                         noexcept(swap(declval<Hasher&>(), declval<Hasher&>())) &&
-                         noexcept(swap(declval<KeyEq&>(), declval<KeyEq&>())))
+                         noexcept(std::swap(declval<Hasher&>(), declval<Hasher&>())) &&
+                         noexcept(std::swap(declval<KeyEq&>(), declval<KeyEq&>())))
             {
                 std::swap(table_, other.table_);
                 std::swap(bucket_count_, other.bucket_count_);
@@ -260,6 +264,7 @@ namespace std::aux
                 std::swap(hasher_, other.hasher_);
                 std::swap(key_eq_, other.key_eq_);
                 std::swap(max_load_factor_, other.max_load_factor_);
+                pool_.swap(other.pool_);
             }
 
             hasher hash_function() const
@@ -274,42 +279,26 @@ namespace std::aux
 
             iterator find(const key_type& key)
             {
-                auto idx = get_bucket_idx_(key);
-                auto head = table_[idx].head;
-
-                if (!head)
+                auto node = find_node_(key);
+                if (!node)
                     return end();
 
-                auto current = head;
-                do
-                {
-                    if (key_eq_(key, key_extractor_(current->value)))
-                        return iterator{table_, idx, size_, current};
-                    current = current->next;
-                }
-                while (current && current != head);
-
-                return end();
+                return iterator{
+                    table_, node->hash % bucket_count_,
+                    bucket_count_, node
+                };
             }
 
             const_iterator find(const key_type& key) const
             {
-                auto idx = get_bucket_idx_(key);
-                auto head = table_[idx].head;
-
-                if (!head)
+                auto node = find_node_(key);
+                if (!node)
                     return end();
 
-                auto current = head;
-                do
-                {
-                    if (key_eq_(key, key_extractor_(current->value)))
-                        return iterator{table_, idx, size_, current};
-                    current = current->next;
-                }
-                while (current != head);
-
-                return end();
+                return const_iterator{
+                    table_, node->hash % bucket_count_,
+                    bucket_count_, node
+                };
             }
 
             size_type count(const key_type& key) const
@@ -400,6 +389,8 @@ namespace std::aux
             {
                 if (count < size_ / max_load_factor_)
                     count = size_ / max_load_factor_;
+                if (count == 0)
+                    count = 1;
 
                 /**
                  * Note: If an exception is thrown, there
@@ -408,38 +399,31 @@ namespace std::aux
                  *       be thrown and no changes to this have been
                  *       made, we're ok.
                  */
-                hash_table new_table{count, max_load_factor_};
+                auto new_table = new hash_table_bucket<value_type, size_type>[count]();
 
-                for (std::size_t i = 0; i < bucket_count_; ++i)
+                /**
+                 * The nodes are relinked into the new buckets as
+                 * they are, using the cached hashes, so rehashing
+                 * neither allocates nodes nor calls the hasher or
+                 * the key comparator. Nodes with equivalent keys
+                 * are adjacent in their old bucket and are appended
+                 * in order, so they stay adjacent (the multi
+                 * containers rely on that).
+                 */
+                for (size_type i = 0; i < bucket_count_; ++i)
                 {
                     auto head = table_[i].head;
                     if (!head)
                         continue;
 
                     auto current = head;
-
                     do
                     {
                         auto next = current->next;
 
                         current->next = current;
                         current->prev = current;
-
-                        auto where = Policy::find_insertion_spot(
-                            new_table, key_extractor_(current->value)
-                        );
-
-                        /**
-                         * Note: We're rehashing, so we know each
-                         *       key can be inserted.
-                         */
-                        auto new_bucket = get<0>(where);
-                        auto new_successor = get<1>(where);
-
-                        if (new_successor)
-                            new_successor->append(current);
-                        else
-                            new_bucket->append(current);
+                        new_table[current->hash % count].append(current);
 
                         current = next;
                     } while (current != head);
@@ -447,11 +431,9 @@ namespace std::aux
                     table_[i].head = nullptr;
                 }
 
-                new_table.size_ = size_;
-                swap(new_table);
-
-                delete[] new_table.table_;
-                new_table.table_ = nullptr;
+                delete[] table_;
+                table_ = new_table;
+                bucket_count_ = count;
             }
 
             void reserve(size_type count)
@@ -496,9 +478,11 @@ namespace std::aux
 
             ~hash_table()
             {
-                // Lists are deleted in ~hash_table_bucket.
                 if (table_)
+                {
+                    clear();
                     delete[] table_;
+                }
             }
 
             place_type find_insertion_spot(const key_type& key) const
@@ -526,15 +510,42 @@ namespace std::aux
                 return key_eq_(key, key_extractor_(val));
             }
 
+            /**
+             * Compares the cached hashes first, key_eq_ is only
+             * called for (likely) matches.
+             */
+            bool keys_equal(const key_type& key, size_t hash,
+                            const node_type* node) const
+            {
+                return node->hash == hash &&
+                       key_eq_(key, key_extractor_(node->value));
+            }
+
+            size_t hash_key(const key_type& key) const
+            {
+                return hasher_(key);
+            }
+
+            template<class... Args>
+            node_type* create_node(Args&&... args)
+            {
+                return pool_.create(forward<Args>(args)...);
+            }
+
+            void destroy_node(node_type* node)
+            {
+                pool_.destroy(node);
+            }
+
             hash_table_bucket<value_type, size_type>* table()
             {
                 return table_;
             }
 
-            hash_table_bucket<value_type, size_type>* head(size_type idx)
+            node_type* head(size_type idx)
             {
                 if (idx < bucket_count_)
-                    return table_[idx]->head;
+                    return table_[idx].head;
                 else
                     return nullptr;
             }
@@ -565,6 +576,7 @@ namespace std::aux
             key_equal key_eq_;
             key_extract key_extractor_;
             float max_load_factor_;
+            hash_table_node_pool<node_type> pool_;
 
             static constexpr float bucket_count_growth_factor_{1.25};
 
@@ -573,6 +585,25 @@ namespace std::aux
                 return hasher_(key) % bucket_count_;
             }
 
+            node_type* find_node_(const key_type& key) const
+            {
+                auto hash = hasher_(key);
+                auto head = table_[hash % bucket_count_].head;
+                if (!head)
+                    return nullptr;
+
+                auto current = head;
+                do
+                {
+                    if (keys_equal(key, hash, current))
+                        return current;
+                    current = current->next;
+                }
+                while (current != head);
+
+                return nullptr;
+            }
+
             size_type first_filled_bucket_() const
             {
                 size_type res{};
@@ -29,7 +29,7 @@
 #ifndef LIBCPP_BITS_ADT_HASH_TABLE_BUCKET
 #define LIBCPP_BITS_ADT_HASH_TABLE_BUCKET
 
-#include <__bits/adt/list_node.hpp>
+#include <__bits/adt/hash_table_node.hpp>
 
 namespace std::aux
 {
@@ -42,7 +42,7 @@ namespace std::aux
          *       element after the hinted spot.
          */
 
-        list_node<Value>* head;
+        hash_table_node<Value>* head;
 
         hash_table_bucket()
             : head{}
@@ -50,6 +50,9 @@ namespace std::aux
 
         Size size() const noexcept
         {
+            if (!head)
+                return 0;
+
             auto current = head;
             Size res{};
 
@@ -63,7 +66,7 @@ namespace std::aux
             return res;
         }
 
-        void append(list_node<Value>* node)
+        void append(hash_table_node<Value>* node)
         {
             if (!head)
                 head = node;
@@ -71,7 +74,7 @@ namespace std::aux
                 head->append(node);
         }
 
-        void prepend(list_node<Value>* node)
+        void prepend(hash_table_node<Value>* node)
         {
             if (!head)
                 head = node;
@@ -79,7 +82,13 @@ namespace std::aux
                 head->prepend(node);
         }
 
-        void clear()
+        /**
+         * Note: The nodes are owned by the node pool
+         *       of the table, so the bucket cannot free
+         *       them on its own.
+         */
+        template<class Pool>
+        void clear(Pool& pool)
         {
             if (!head)
                 return;
@@ -89,17 +98,12 @@ namespace std::aux
             {
                 auto tmp = current;
                 current = current->next;
-                delete tmp;
+                pool.destroy(tmp);
             }
             while (current && current != head);
 
             head = nullptr;
         }
-
-        ~hash_table_bucket()
-        {
-            clear();
-        }
     };
 }
 
@@ -29,7 +29,6 @@
 #ifndef LIBCPP_BITS_ADT_HASH_TABLE_ITERATORS
 #define LIBCPP_BITS_ADT_HASH_TABLE_ITERATORS
 
-#include <__bits/adt/list_node.hpp>
 #include <__bits/adt/hash_table_bucket.hpp>
 #include <__bits/iterator_helpers.hpp>
 #include <iterator>
@@ -50,7 +49,7 @@ namespace std::aux
 
             hash_table_iterator(hash_table_bucket<value_type, size_type>* table = nullptr,
                                 size_type idx = size_type{}, size_type max_idx = size_type{},
-                                list_node<value_type>* current = nullptr)
+                                hash_table_node<value_type>* current = nullptr)
                 : table_{table}, idx_{idx}, max_idx_{max_idx}, current_{current}
             { /* DUMMY BODY */ }
 
@@ -74,7 +73,7 @@ namespace std::aux
                 {
                     if (idx_ < max_idx_)
                     {
-                        while (!table_[++idx_].head && idx_ < max_idx_)
+                        while (++idx_ < max_idx_ && !table_[idx_].head)
                         { /* DUMMY BODY */ }
 
                         if (idx_ < max_idx_)
@@ -97,12 +96,12 @@ namespace std::aux
                 return tmp;
             }
 
-            list_node<value_type>* node()
+            hash_table_node<value_type>* node()
             {
                 return current_;
             }
 
-            const list_node<value_type>* node() const
+            const hash_table_node<value_type>* node() const
             {
                 return current_;
             }
@@ -116,7 +115,7 @@ namespace std::aux
             hash_table_bucket<value_type, size_type>* table_;
             size_type idx_;
             size_type max_idx_;
-            list_node<value_type>* current_;
+            hash_table_node<value_type>* current_;
 
             template<class V, class CR, class CP, class S>
             friend class hash_table_const_iterator;
@@ -155,7 +154,7 @@ namespace std::aux
 
             hash_table_const_iterator(const hash_table_bucket<value_type, size_type>* table = nullptr,
                                       size_type idx = size_type{}, size_type max_idx = size_type{},
-                                      const list_node<value_type>* current = nullptr)
+                                      const hash_table_node<value_type>* current = nullptr)
                 : table_{table}, idx_{idx}, max_idx_{max_idx}, current_{current}
             { /* DUMMY BODY */ }
 
@@ -194,7 +193,7 @@ namespace std::aux
                 {
                     if (idx_ < max_idx_)
                     {
-                        while (!table_[++idx_].head && idx_ < max_idx_)
+                        while (++idx_ < max_idx_ && !table_[idx_].head)
                         { /* DUMMY BODY */ }
 
                         if (idx_ < max_idx_)
@@ -217,12 +216,12 @@ namespace std::aux
                 return tmp;
             }
 
-            list_node<value_type>* node()
+            hash_table_node<value_type>* node()
             {
-                return const_cast<list_node<value_type>*>(current_);
+                return const_cast<hash_table_node<value_type>*>(current_);
             }
 
-            const list_node<value_type>* node() const
+            const hash_table_node<value_type>* node() const
             {
                 return current_;
             }
@@ -236,7 +235,7 @@ namespace std::aux
             const hash_table_bucket<value_type, size_type>* table_;
             size_type idx_;
             size_type max_idx_;
-            const list_node<value_type>* current_;
+            const hash_table_node<value_type>* current_;
     };
 
     template<class Value, class CRef, class CPtr, class Size>
@@ -292,8 +291,8 @@ namespace std::aux
 
             using iterator_category = forward_iterator_tag;
 
-            hash_table_local_iterator(list_node<value_type>* head = nullptr,
-                                      list_node<value_type>* current = nullptr)
+            hash_table_local_iterator(hash_table_node<value_type>* head = nullptr,
+                                      hash_table_node<value_type>* current = nullptr)
                 : head_{head}, current_{current}
             { /* DUMMY BODY */ }
 
@@ -327,19 +326,19 @@ namespace std::aux
                 return tmp;
             }
 
-            list_node<value_type>* node()
+            hash_table_node<value_type>* node()
             {
                 return current_;
             }
 
-            const list_node<value_type>* node() const
+            const hash_table_node<value_type>* node() const
             {
                 return current_;
             }
 
         private:
-            list_node<value_type>* head_;
-            list_node<value_type>* current_;
+            hash_table_node<value_type>* head_;
+            hash_table_node<value_type>* current_;
 
             template<class V, class CR, class CP>
             friend class hash_table_const_local_iterator;
@@ -376,8 +375,8 @@ namespace std::aux
             using iterator_category = forward_iterator_tag;
 
             // TODO: requirement for forward iterator is default constructibility, fix others!
-            hash_table_const_local_iterator(const list_node<value_type>* head = nullptr,
-                                            const list_node<value_type>* current = nullptr)
+            hash_table_const_local_iterator(const hash_table_node<value_type>* head = nullptr,
+                                            const hash_table_node<value_type>* current = nullptr)
                 : head_{head}, current_{current}
             { /* DUMMY BODY */ }
 
@@ -424,19 +423,19 @@ namespace std::aux
             }
 
 
-            list_node<value_type>* node()
+            hash_table_node<value_type>* node()
             {
-                return const_cast<list_node<value_type>*>(current_);
+                return const_cast<hash_table_node<value_type>*>(current_);
             }
 
-            const list_node<value_type>* node() const
+            const hash_table_node<value_type>* node() const
             {
                 return current_;
             }
 
         private:
-            const list_node<value_type>* head_;
-            const list_node<value_type>* current_;
+            const hash_table_node<value_type>* head_;
+            const hash_table_node<value_type>* current_;
     };
 
     template<class Value, class CRef, class CPtr>
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_HASH_TABLE_NODE
+#define LIBCPP_BITS_ADT_HASH_TABLE_NODE
+
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * Like list_node, but also caches the hash of the key
+     * so that lookups can skip most key comparisons and
+     * rehashing does not need to call the hasher at all.
+     */
+    template<class T>
+    struct hash_table_node
+    {
+        T value;
+        size_t hash;
+        hash_table_node* next;
+        hash_table_node* prev;
+
+        template<class... Args>
+        hash_table_node(Args&&... args)
+            : value{forward<Args>(args)...},
+              hash{}, next{}, prev{}
+        {
+            next = this;
+            prev = this;
+        }
+
+        void append(hash_table_node* node)
+        {
+            if (!node)
+                return;
+
+            node->next = next;
+            node->prev = this;
+            next->prev = node;
+            next = node;
+        }
+
+        void prepend(hash_table_node* node)
+        {
+            if (!node)
+                return;
+
+            node->next = this;
+            node->prev = prev;
+            prev->next = node;
+            prev = node;
+        }
+
+        void unlink()
+        {
+            prev->next = next;
+            next->prev = prev;
+            next = this;
+            prev = this;
+        }
+    };
+
+    /**
+     * Slab pool the nodes of a single hash table are allocated
+     * from. Memory is obtained in chunks of geometrically growing
+     * size and freed nodes are kept on a free list for reuse, so
+     * after warming up inserts and erases do not touch the global
+     * allocator. Nodes never move, so pointers and references to
+     * the elements stay valid until the elements are erased.
+     * The memory itself is only returned when the pool is destroyed.
+     */
+    template<class Node>
+    class hash_table_node_pool
+    {
+        public:
+            hash_table_node_pool()
+                : chunks_{}, free_{}, chunk_size_{initial_chunk_size_}
+            { /* DUMMY BODY */ }
+
+            hash_table_node_pool(const hash_table_node_pool&) = delete;
+            hash_table_node_pool& operator=(const hash_table_node_pool&) = delete;
+
+            hash_table_node_pool(hash_table_node_pool&& other) noexcept
+                : chunks_{other.chunks_}, free_{other.free_},
+                  chunk_size_{other.chunk_size_}
+            {
+                other.chunks_ = nullptr;
+                other.free_ = nullptr;
+                other.chunk_size_ = initial_chunk_size_;
+            }
+
+            template<class... Args>
+            Node* create(Args&&... args)
+            {
+                auto slot = acquire_();
+
+                return ::new(static_cast<void*>(slot)) Node{forward<Args>(args)...};
+            }
+
+            void destroy(Node* node)
+            {
+                node->~Node();
+                release_(reinterpret_cast<slot_t*>(node));
+            }
+
+            void swap(hash_table_node_pool& other) noexcept
+            {
+                std::swap(chunks_, other.chunks_);
+                std::swap(free_, other.free_);
+                std::swap(chunk_size_, other.chunk_size_);
+            }
+
+            ~hash_table_node_pool()
+            {
+                // Note: The table destroys its nodes before this runs.
+                while (chunks_)
+                {
+                    auto next = chunks_[0].next;
+                    ::operator delete(static_cast<void*>(chunks_));
+                    chunks_ = next;
+                }
+            }
+
+        private:
+            union slot_t
+            {
+                slot_t* next;
+                alignas(Node) unsigned char storage[sizeof(Node)];
+            };
+
+            /**
+             * The first slot of every chunk links
+             * it to the previously allocated chunk.
+             */
+            slot_t* chunks_;
+            slot_t* free_;
+            size_t chunk_size_;
+
+            static constexpr size_t initial_chunk_size_{8};
+            static constexpr size_t max_chunk_size_{256};
+
+            slot_t* acquire_()
+            {
+                if (!free_)
+                    grow_();
+
+                auto slot = free_;
+                free_ = slot->next;
+
+                return slot;
+            }
+
+            void release_(slot_t* slot)
+            {
+                slot->next = free_;
+                free_ = slot;
+            }
+
+            void grow_()
+            {
+                auto chunk = static_cast<slot_t*>(
+                    ::operator new((chunk_size_ + 1) * sizeof(slot_t))
+                );
+
+                chunk[0].next = chunks_;
+                chunks_ = chunk;
+
+                /**
+                 * Push the slots in reverse so that consecutive
+                 * allocations get consecutive addresses.
+                 */
+                for (size_t i = chunk_size_; i > 0; --i)
+                    release_(&chunk[i]);
+
+                if (chunk_size_ < max_chunk_size_)
+                    chunk_size_ *= 2;
+            }
+    };
+}
+
+#endif
@@ -45,7 +45,8 @@ namespace std::aux
         template<class Table, class Key>
         static typename Table::place_type find_insertion_spot(const Table& table, const Key& key)
         {
-            auto idx = table.get_bucket_idx_(key);
+            auto hash = table.hash_key(key);
+            auto idx = static_cast<typename Table::size_type>(hash % table.bucket_count_);
             auto head = table.table_[idx].head;
 
             if (head)
@@ -53,12 +54,12 @@ namespace std::aux
                 auto current = head;
                 do
                 {
-                    if (table.keys_equal(key, current->value))
+                    if (table.keys_equal(key, hash, current))
                     {
                         return make_tuple(
                             &table.table_[idx],
                             current,
-                            idx
+                            idx, hash
                         );
                     }
 
@@ -69,14 +70,15 @@ namespace std::aux
             return make_tuple(
                 &table.table_[idx],
                 table.table_[idx].head,
-                idx
+                idx, hash
             );
         }
 
         template<class Table, class Key>
         static typename Table::size_type erase(Table& table, const Key& key)
         {
-            auto idx = table.get_bucket_idx_(key);
+            auto hash = table.hash_key(key);
+            auto idx = static_cast<typename Table::size_type>(hash % table.bucket_count_);
             auto head = table.table_[idx].head;
             auto current = head;
 
@@ -85,7 +87,7 @@ namespace std::aux
 
             do
             {
-                if (table.keys_equal(key, current->value))
+                if (table.keys_equal(key, hash, current))
                 {
                     --table.size_;
 
@@ -98,7 +100,7 @@ namespace std::aux
                     }
 
                     current->unlink();
-                    delete current;
+                    table.destroy_node(current);
 
                     return 1;
                 }
@@ -131,10 +133,12 @@ namespace std::aux
         }
 
         /**
-         * Note: We have to duplicate code for emplace, insert(const&)
+         * Note: We have to duplicate code for insert(const&)
          *       and insert(&&) here, because the node (which makes distinction
          *       between the arguments) is only created if the value isn't
-         *       in the table already.
+         *       in the table already. Emplace has to create the node
+         *       to get the key, but since nodes come from the node pool
+         *       of the table, giving it back on a duplicate is cheap.
          */
 
         template<class Table, class... Args>
@@ -142,22 +146,25 @@ namespace std::aux
             typename Table::iterator, bool
         > emplace(Table& table, Args&&... args)
         {
-            using value_type = typename Table::value_type;
-            using node_type  = typename Table::node_type;
             using iterator   = typename Table::iterator;
 
             table.increment_size();
 
-            auto val = value_type{forward<Args>(args)...};
-            const auto& key = table.get_key(val);
-            auto [bucket, target, idx] = table.find_insertion_spot(key);
+            auto node = table.create_node(forward<Args>(args)...);
+            const auto& key = table.get_key(node->value);
+            auto [bucket, target, idx, hash] = table.find_insertion_spot(key);
 
             if (!bucket)
+            {
+                table.destroy_node(node);
+
                 return make_pair(table.end(), false);
+            }
 
-            if (target && table.keys_equal(key, target->value))
+            if (target && table.keys_equal(key, hash, target))
             {
                 table.decrement_size();
+                table.destroy_node(node);
 
                 return make_pair(
                     iterator{
@@ -169,7 +176,7 @@ namespace std::aux
             }
             else
             {
-                auto node = new node_type{move(val)};
+                node->hash = hash;
                 bucket->prepend(node);
 
                 return make_pair(iterator{
@@ -185,18 +192,17 @@ namespace std::aux
             typename Table::iterator, bool
         > insert(Table& table, const Value& val)
         {
-            using node_type  = typename Table::node_type;
             using iterator   = typename Table::iterator;
 
             table.increment_size();
 
             const auto& key = table.get_key(val);
-            auto [bucket, target, idx] = table.find_insertion_spot(key);
+            auto [bucket, target, idx, hash] = table.find_insertion_spot(key);
 
             if (!bucket)
                 return make_pair(table.end(), false);
 
-            if (target && table.keys_equal(key, target->value))
+            if (target && table.keys_equal(key, hash, target))
             {
                 table.decrement_size();
 
@@ -210,7 +216,8 @@ namespace std::aux
             }
             else
             {
-                auto node = new node_type{val};
+                auto node = table.create_node(val);
+                node->hash = hash;
                 bucket->prepend(node);
 
                 return make_pair(iterator{
@@ -227,18 +234,17 @@ namespace std::aux
         > insert(Table& table, Value&& val)
         {
             using value_type = typename Table::value_type;
-            using node_type  = typename Table::node_type;
             using iterator   = typename Table::iterator;
 
             table.increment_size();
 
             const auto& key = table.get_key(val);
-            auto [bucket, target, idx] = table.find_insertion_spot(key);
+            auto [bucket, target, idx, hash] = table.find_insertion_spot(key);
 
             if (!bucket)
                 return make_pair(table.end(), false);
 
-            if (target && table.keys_equal(key, target->value))
+            if (target && table.keys_equal(key, hash, target))
             {
                 table.decrement_size();
 
@@ -252,7 +258,8 @@ namespace std::aux
             }
             else
             {
-                auto node = new node_type{forward<value_type>(val)};
+                auto node = table.create_node(forward<value_type>(val));
+                node->hash = hash;
                 bucket->prepend(node);
 
                 return make_pair(iterator{
@@ -269,7 +276,8 @@ namespace std::aux
         template<class Table, class Key>
         static typename Table::size_type count(const Table& table, const Key& key)
         {
-            auto head = table.table_[table.get_bucket_idx_(key)].head;
+            auto hash = table.hash_key(key);
+            auto head = table.table_[hash % table.bucket_count_].head;
             if (!head)
                 return 0;
 
@@ -277,7 +285,7 @@ namespace std::aux
             typename Table::size_type res = 0;
             do
             {
-                if (table.keys_equal(key, current->value))
+                if (table.keys_equal(key, hash, current))
                     ++res;
 
                 current = current->next;
@@ -290,7 +298,8 @@ namespace std::aux
         template<class Table, class Key>
         static typename Table::place_type find_insertion_spot(const Table& table, const Key& key)
         {
-            auto idx = table.get_bucket_idx_(key);
+            auto hash = table.hash_key(key);
+            auto idx = static_cast<typename Table::size_type>(hash % table.bucket_count_);
             auto head = table.table_[idx].head;
 
             if (head)
@@ -298,12 +307,12 @@ namespace std::aux
                 auto current = head;
                 do
                 {
-                    if (table.keys_equal(key, current->value))
+                    if (table.keys_equal(key, hash, current))
                     {
                         return make_tuple(
                             &table.table_[idx],
                             current,
-                            idx
+                            idx, hash
                         );
                     }
 
@@ -314,14 +323,15 @@ namespace std::aux
             return make_tuple(
                 &table.table_[idx],
                 table.table_[idx].head,
-                idx
+                idx, hash
             );
         }
 
         template<class Table, class Key>
         static typename Table::size_type erase(Table& table, const Key& key)
         {
-            auto idx = table.get_bucket_idx_(key);
+            auto hash = table.hash_key(key);
+            auto idx = static_cast<typename Table::size_type>(hash % table.bucket_count_);
             auto head = table.table_[idx].head;
             auto current = head;
             table.table_[idx].head = nullptr;
@@ -344,7 +354,7 @@ namespace std::aux
                 tmp->next = tmp;
                 tmp->prev = tmp;
 
-                if (!table.keys_equal(key, tmp->value))
+                if (!table.keys_equal(key, hash, tmp))
                 {
                     if (!last)
                         table.table_[idx].head = tmp;
@@ -357,7 +367,7 @@ namespace std::aux
                     --table.size_;
                     ++res;
 
-                    delete tmp;
+                    table.destroy_node(tmp);
                 }
             }
             while (current && current != head);
@@ -406,9 +416,7 @@ namespace std::aux
         template<class Table, class... Args>
         static typename Table::iterator emplace(Table& table, Args&&... args)
         {
-            using node_type  = typename Table::node_type;
-
-            auto node = new node_type{forward<Args>(args)...};
+            auto node = table.create_node(forward<Args>(args)...);
 
             return insert(table, node);
         }
@@ -416,9 +424,7 @@ namespace std::aux
         template<class Table, class Value>
         static typename Table::iterator insert(Table& table, const Value& val)
         {
-            using node_type  = typename Table::node_type;
-
-            auto node = new node_type{val};
+            auto node = table.create_node(val);
 
             return insert(table, node);
         }
@@ -427,9 +433,8 @@ namespace std::aux
         static typename Table::iterator insert(Table& table, Value&& val)
         {
             using value_type = typename Table::value_type;
-            using node_type  = typename Table::node_type;
 
-            auto node = new node_type{forward<value_type>(val)};
+            auto node = table.create_node(forward<value_type>(val));
 
             return insert(table, node);
         }
@@ -442,12 +447,17 @@ namespace std::aux
             table.increment_size();
 
             const auto& key = table.get_key(node->value);
-            auto [bucket, target, idx] = table.find_insertion_spot(key);
+            auto [bucket, target, idx, hash] = table.find_insertion_spot(key);
 
             if (!bucket)
+            {
+                table.destroy_node(node);
+
                 return table.end();
+            }
 
-            if (target && table.keys_equal(key, target->value))
+            node->hash = hash;
+            if (target && table.keys_equal(key, hash, target))
                 target->append(node);
             else
                 bucket->prepend(node);
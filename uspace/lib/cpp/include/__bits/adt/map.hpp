@@ -30,6 +30,7 @@
 #define LIBCPP_BITS_ADT_MAP
 
 #include <__bits/adt/rbtree.hpp>
+#include <__bits/memory/memory_resource_fwd.hpp>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -163,7 +164,8 @@ namespace std
             map& operator=(const map& other)
             {
                 tree_ = other.tree_;
-                allocator_ = other.allocator_;
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_copy_assignment::value)
+                    allocator_ = other.allocator_;
 
                 return *this;
             }
@@ -173,7 +175,8 @@ namespace std
                          is_nothrow_move_assignable<key_compare>::value)
             {
                 tree_ = move(other.tree_);
-                allocator_ = move(other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_move_assignment::value)
+                    allocator_ = move(other.allocator_);
 
                 return *this;
             }
@@ -495,7 +498,8 @@ namespace std
                          noexcept(std::swap(declval<key_compare>(), declval<key_compare>())))
             {
                 tree_.swap(other.tree_);
-                std::swap(allocator_, other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_swap::value)
+                    std::swap(allocator_, other.allocator_);
             }
 
             void clear() noexcept
@@ -822,7 +826,8 @@ namespace std
             multimap& operator=(const multimap& other)
             {
                 tree_ = other.tree_;
-                allocator_ = other.allocator_;
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_copy_assignment::value)
+                    allocator_ = other.allocator_;
 
                 return *this;
             }
@@ -832,7 +837,8 @@ namespace std
                          is_nothrow_move_assignable<key_compare>::value)
             {
                 tree_ = move(other.tree_);
-                allocator_ = move(other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_move_assignment::value)
+                    allocator_ = move(other.allocator_);
 
                 return *this;
             }
@@ -1014,7 +1020,8 @@ namespace std
                          noexcept(std::swap(declval<key_compare>(), declval<key_compare>())))
             {
                 tree_.swap(other.tree_);
-                std::swap(allocator_, other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_swap::value)
+                    std::swap(allocator_, other.allocator_);
             }
 
             void clear() noexcept
@@ -1219,6 +1226,21 @@ namespace std
     {
         return !(rhs < lhs);
     }
+
+    namespace pmr
+    {
+        template<class Key, class Value, class Compare = less<Key>>
+        using map = std::map<
+            Key, Value, Compare,
+            polymorphic_allocator<pair<const Key, Value>>
+        >;
+
+        template<class Key, class Value, class Compare = less<Key>>
+        using multimap = std::multimap<
+            Key, Value, Compare,
+            polymorphic_allocator<pair<const Key, Value>>
+        >;
+    }
 }
 
 #endif
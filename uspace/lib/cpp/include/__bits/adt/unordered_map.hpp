@@ -30,6 +30,7 @@
 #define LIBCPP_BITS_ADT_UNORDERED_MAP
 
 #include <__bits/adt/hash_table.hpp>
+#include <__bits/memory/memory_resource_fwd.hpp>
 #include <initializer_list>
 #include <functional>
 #include <memory>
@@ -165,7 +166,8 @@ namespace std
             unordered_map& operator=(const unordered_map& other)
             {
                 table_ = other.table_;
-                allocator_ = other.allocator_;
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_copy_assignment::value)
+                    allocator_ = other.allocator_;
 
                 return *this;
             }
@@ -176,7 +178,8 @@ namespace std
                          is_nothrow_move_assignable<key_equal>::value)
             {
                 table_ = move(other.table_);
-                allocator_ = move(other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_move_assignment::value)
+                    allocator_ = move(other.allocator_);
 
                 return *this;
             }
@@ -316,12 +319,12 @@ namespace std
 
                 table_.increment_size();
 
-                auto [bucket, target, idx] = table_.find_insertion_spot(key);
+                auto [bucket, target, idx, hash] = table_.find_insertion_spot(key);
 
                 if (!bucket)
                     return make_pair(end(), false);
 
-                if (target && table_.keys_equal(key, target->value))
+                if (target && table_.keys_equal(key, hash, target))
                 {
                     table_.decrement_size();
 
@@ -335,7 +338,8 @@ namespace std
                 }
                 else
                 {
-                    auto node = new node_type{key, forward<Args>(args)...};
+                    auto node = table_.create_node(key, forward<Args>(args)...);
+                    node->hash = hash;
                     bucket->append(node);
 
                     return make_pair(iterator{
@@ -351,12 +355,12 @@ namespace std
             {
                 table_.increment_size();
 
-                auto [bucket, target, idx] = table_.find_insertion_spot(key);
+                auto [bucket, target, idx, hash] = table_.find_insertion_spot(key);
 
                 if (!bucket)
                     return make_pair(end(), false);
 
-                if (target && table_.keys_equal(key, target->value))
+                if (target && table_.keys_equal(key, hash, target))
                 {
                     table_.decrement_size();
 
@@ -370,7 +374,8 @@ namespace std
                 }
                 else
                 {
-                    auto node = new node_type{move(key), forward<Args>(args)...};
+                    auto node = table_.create_node(move(key), forward<Args>(args)...);
+                    node->hash = hash;
                     bucket->append(node);
 
                     return make_pair(iterator{
@@ -398,12 +403,12 @@ namespace std
             {
                 table_.increment_size();
 
-                auto [bucket, target, idx] = table_.find_insertion_spot(key);
+                auto [bucket, target, idx, hash] = table_.find_insertion_spot(key);
 
                 if (!bucket)
                     return make_pair(end(), false);
 
-                if (target && table_.keys_equal(key, target->value))
+                if (target && table_.keys_equal(key, hash, target))
                 {
                     table_.decrement_size();
                     target->value.second = forward<T>(val);
@@ -418,7 +423,8 @@ namespace std
                 }
                 else
                 {
-                    auto node = new node_type{key, forward<T>(val)};
+                    auto node = table_.create_node(key, forward<T>(val));
+                    node->hash = hash;
                     bucket->append(node);
 
                     return make_pair(iterator{
@@ -434,12 +440,12 @@ namespace std
             {
                 table_.increment_size();
 
-                auto [bucket, target, idx] = table_.find_insertion_spot(key);
+                auto [bucket, target, idx, hash] = table_.find_insertion_spot(key);
 
                 if (!bucket)
                     return make_pair(end(), false);
 
-                if (target && table_.keys_equal(key, target->value))
+                if (target && table_.keys_equal(key, hash, target))
                 {
                     table_.decrement_size();
                     target->value.second = forward<T>(val);
@@ -454,7 +460,8 @@ namespace std
                 }
                 else
                 {
-                    auto node = new node_type{move(key), forward<T>(val)};
+                    auto node = table_.create_node(move(key), forward<T>(val));
+                    node->hash = hash;
                     bucket->append(node);
 
                     return make_pair(iterator{
@@ -494,7 +501,7 @@ namespace std
 
                 return iterator{
                     table_.table(), first.idx(),
-                    table_.bucket_count(), table_.head(first.idx())
+                    table_.bucket_count(), first.node()
                 };
             }
 
@@ -509,7 +516,8 @@ namespace std
                          noexcept(std::swap(declval<key_equal>(), declval<key_equal>())))
             {
                 table_.swap(other.table_);
-                std::swap(allocator_, other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_swap::value)
+                    std::swap(allocator_, other.allocator_);
             }
 
             hasher hash_function() const
@@ -549,57 +557,31 @@ namespace std
 
             mapped_type& operator[](const key_type& key)
             {
-                auto spot = table_.find_insertion_spot(key);
-                auto bucket = get<0>(spot);
+                auto [bucket, target, idx, hash] = table_.find_insertion_spot(key);
 
-                if (bucket->head)
-                {
-                    auto head = bucket->head;
-                    auto current = bucket->head;
-
-                    do
-                    {
-                        if (table_.keys_equal(key, current->value))
-                            return current->value.second;
-                        else
-                            current = current->next;
-                    }
-                    while (current != head);
-                }
+                if (target && table_.keys_equal(key, hash, target))
+                    return target->value.second;
 
-                auto node = new node_type{key, mapped_type{}};
+                auto node = table_.create_node(key, mapped_type{});
+                node->hash = hash;
                 bucket->append(node);
 
                 table_.increment_size();
-                table_.rehash_if_needed();
                 return node->value.second;
             }
 
             mapped_type& operator[](key_type&& key)
             {
-                auto spot = table_.find_insertion_spot(key);
-                auto bucket = get<0>(spot);
+                auto [bucket, target, idx, hash] = table_.find_insertion_spot(key);
 
-                if (bucket->head)
-                {
-                    auto head = bucket->head;
-                    auto current = bucket->head;
-
-                    do
-                    {
-                        if (table_.keys_equal(key, current->value))
-                            return current->value.second;
-                        else
-                            current = current->next;
-                    }
-                    while (current != head);
-                }
+                if (target && table_.keys_equal(key, hash, target))
+                    return target->value.second;
 
-                auto node = new node_type{move(key), mapped_type{}};
+                auto node = table_.create_node(move(key), mapped_type{});
+                node->hash = hash;
                 bucket->append(node);
 
                 table_.increment_size();
-                table_.rehash_if_needed();
                 return node->value.second;
             }
 
@@ -842,7 +824,8 @@ namespace std
             unordered_multimap& operator=(const unordered_multimap& other)
             {
                 table_ = other.table_;
-                allocator_ = other.allocator_;
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_copy_assignment::value)
+                    allocator_ = other.allocator_;
 
                 return *this;
             }
@@ -853,7 +836,8 @@ namespace std
                          is_nothrow_move_assignable<key_equal>::value)
             {
                 table_ = move(other.table_);
-                allocator_ = move(other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_move_assignment::value)
+                    allocator_ = move(other.allocator_);
 
                 return *this;
             }
@@ -998,7 +982,7 @@ namespace std
 
                 return iterator{
                     table_.table(), first.idx(),
-                    table_.bucket_count(), table_.head(first.idx())
+                    table_.bucket_count(), first.node()
                 };
             }
 
@@ -1013,7 +997,8 @@ namespace std
                          noexcept(std::swap(declval<key_equal>(), declval<key_equal>())))
             {
                 table_.swap(other.table_);
-                std::swap(allocator_, other.allocator_);
+                if constexpr (allocator_traits<allocator_type>::propagate_on_container_swap::value)
+                    std::swap(allocator_, other.allocator_);
             }
 
             hasher hash_function() const
@@ -1188,6 +1173,29 @@ namespace std
     {
         return !(lhs == rhs);
     }
+
+    namespace pmr
+    {
+        template<
+            class Key, class Value,
+            class Hash = hash<Key>,
+            class Pred = equal_to<Key>
+        >
+        using unordered_map = std::unordered_map<
+            Key, Value, Hash, Pred,
+            polymorphic_allocator<pair<const Key, Value>>
+        >;
+
+        template<
+            class Key, class Value,
+            class Hash = hash<Key>,
+            class Pred = equal_to<Key>
+        >
+        using unordered_multimap = std::unordered_multimap<
+            Key, Value, Hash, Pred,
+            polymorphic_allocator<pair<const Key, Value>>
+        >;
+    }
 }
 
 #endif
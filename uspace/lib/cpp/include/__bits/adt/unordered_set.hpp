@@ -723,7 +723,7 @@ namespace std
 
                 return iterator{
                     table_.table(), first.idx(),
-                    table_.bucket_count(), table_.head(first.idx())
+                    table_.bucket_count(), first.node()
                 };
             }
 
@@ -29,10 +29,13 @@
 #ifndef LIBCPP_BITS_ADT_VECTOR
 #define LIBCPP_BITS_ADT_VECTOR
 
+#include <__bits/memory/memory_resource_fwd.hpp>
 #include <algorithm>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 namespace std
@@ -68,41 +71,58 @@ namespace std
             { /* DUMMY BODY */ }
 
             explicit vector(size_type n, const Allocator& alloc = Allocator{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{}, size_{}, capacity_{n}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
+                data_ = allocate_(capacity_);
 
-                for (size_type i = 0; i < size_; ++i)
-                    allocator_traits<Allocator>::construct(allocator_, data_ + i);
+                for (; size_ < n; ++size_)
+                    alloc_traits_::construct(allocator_, data_ + size_);
             }
 
             vector(size_type n, const T& val, const Allocator& alloc = Allocator{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{}, size_{}, capacity_{n}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
+                data_ = allocate_(capacity_);
 
-                for (size_type i = 0; i < size_; ++i)
-                    data_[i] = val;
+                for (; size_ < n; ++size_)
+                    alloc_traits_::construct(allocator_, data_ + size_, val);
             }
 
-            template<class InputIterator>
+            template<
+                class InputIterator,
+                class = enable_if_t<!is_integral_v<InputIterator>>
+            >
             vector(InputIterator first, InputIterator last,
                    const Allocator& alloc = Allocator{})
+                : data_{nullptr}, size_{}, capacity_{}, allocator_{alloc}
             {
-                // TODO: research constraints and provide multiple
-                //       implementations via enable_if
-            }
+                using category = typename iterator_traits<InputIterator>::iterator_category;
 
-            vector(const vector& other)
-                : data_{nullptr}, size_{other.size_}, capacity_{other.capacity_},
-                  allocator_{other.allocator_}
-            {
-                data_ = allocator_.allocate(capacity_);
+                if constexpr (is_base_of_v<forward_iterator_tag, category>)
+                {
+                    capacity_ = static_cast<size_type>(distance(first, last));
+                    data_ = allocate_(capacity_);
 
-                for (size_type i = 0; i < size_; ++i)
-                    data_[i] = other.data_[i];
+                    for (; first != last; ++first, ++size_)
+                        alloc_traits_::construct(allocator_, data_ + size_, *first);
+                }
+                else
+                {
+                    /**
+                     * Input iterators can only be traversed
+                     * once, so we do not know the size ahead.
+                     */
+                    for (; first != last; ++first)
+                        emplace_back(*first);
+                }
             }
 
+            vector(const vector& other)
+                : vector{other, alloc_traits_::select_on_container_copy_construction(
+                    other.allocator_
+                )}
+            { /* DUMMY BODY */ }
+
             vector(vector&& other) noexcept
                 : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_},
                   allocator_{move(other.allocator_)}
@@ -113,36 +133,34 @@ namespace std
             }
 
             vector(const vector& other, const Allocator& alloc)
-                : data_{nullptr}, size_{other.size_}, capacity_{other.capacity_},
+                : data_{nullptr}, size_{}, capacity_{other.size_},
                   allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
-
-                for (size_type i = 0; i < size_; ++i)
-                    data_[i] = other.data_[i];
+                data_ = allocate_(capacity_);
+                copy_construct_(other.data_, other.size_, data_);
+                size_ = other.size_;
             }
 
             vector(initializer_list<T> init, const Allocator& alloc = Allocator{})
-                : data_{nullptr}, size_{init.size()}, capacity_{init.size()},
+                : data_{nullptr}, size_{}, capacity_{init.size()},
                   allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
-
-                auto it = init.begin();
-                for (size_type i = 0; it != init.end(); ++i, ++it)
-                {
-                    data_[i] = *it;
-                }
+                data_ = allocate_(capacity_);
+                copy_construct_(init.begin(), init.size(), data_);
+                size_ = init.size();
             }
 
             ~vector()
             {
-                allocator_.deallocate(data_, capacity_);
+                destroy_from_end_until_(begin());
+
+                if (data_)
+                    allocator_.deallocate(data_, capacity_);
             }
 
             vector& operator=(const vector& other)
             {
-                vector tmp{other};
+                vector tmp{other, allocator_};
                 swap(tmp);
 
                 return *this;
@@ -152,19 +170,38 @@ namespace std
                 noexcept(allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
                          allocator_traits<Allocator>::is_always_equal::value)
             {
+                using propagate = typename allocator_traits<
+                    Allocator
+                >::propagate_on_container_move_assignment;
+
+                /**
+                 * Storage can only be stolen if we will be able
+                 * to deallocate it with our own allocator.
+                 */
+                if (!propagate::value && allocator_ != other.allocator_)
+                {
+                    vector tmp{other, allocator_};
+                    swap(tmp);
+
+                    return *this;
+                }
+
+                destroy_from_end_until_(begin());
                 if (data_)
                     allocator_.deallocate(data_, capacity_);
 
-                // TODO: test this
                 data_ = other.data_;
                 size_ = other.size_;
                 capacity_ = other.capacity_;
-                allocator_ = move(other.allocator_);
+                if constexpr (propagate::value)
+                {
+                    allocator_ = move(other.allocator_);
+                    other.allocator_ = allocator_type{};
+                }
 
                 other.data_ = nullptr;
                 other.size_ = size_type{};
                 other.capacity_ = size_type{};
-                other.allocator_ = allocator_type{};
                 return *this;
             }
 
@@ -176,10 +213,13 @@ namespace std
                 return *this;
             }
 
-            template<class InputIterator>
+            template<
+                class InputIterator,
+                class = enable_if_t<!is_integral_v<InputIterator>>
+            >
             void assign(InputIterator first, InputIterator last)
             {
-                vector tmp{first, last};
+                vector tmp(first, last, allocator_);
                 swap(tmp);
             }
 
@@ -187,13 +227,13 @@ namespace std
             {
                 // Parenthesies required to avoid initializer list
                 // construction.
-                vector tmp(size, val);
+                vector tmp(size, val, allocator_);
                 swap(tmp);
             }
 
             void assign(initializer_list<T> init)
             {
-                vector tmp{init};
+                vector tmp{init, allocator_};
                 swap(tmp);
             }
 
@@ -274,16 +314,45 @@ namespace std
 
             void resize(size_type sz)
             {
-                resize_with_copy_(size_, capacity_);
+                if (sz <= size_)
+                {
+                    destroy_from_end_until_(begin() + sz);
+                    size_ = sz;
+
+                    return;
+                }
+
+                if (sz > capacity_)
+                    reallocate_(max(sz, next_capacity_()));
+
+                for (; size_ < sz; ++size_)
+                    alloc_traits_::construct(allocator_, data_ + size_);
             }
 
             void resize(size_type sz, const value_type& val)
             {
-                auto old_size = size_;
-                resize_with_copy_(sz, capacity_);
+                if (sz <= size_)
+                {
+                    destroy_from_end_until_(begin() + sz);
+                    size_ = sz;
+
+                    return;
+                }
 
-                for (size_type i = old_size - 1; i < size_; ++i)
-                    data_[i] = val;
+                if (sz > capacity_)
+                {
+                    // Val might be one of our elements.
+                    value_type tmp(val);
+                    reallocate_(max(sz, next_capacity_()));
+
+                    for (; size_ < sz; ++size_)
+                        alloc_traits_::construct(allocator_, data_ + size_, tmp);
+                }
+                else
+                {
+                    for (; size_ < sz; ++size_)
+                        alloc_traits_::construct(allocator_, data_ + size_, val);
+                }
             }
 
             size_type capacity() const noexcept
@@ -302,12 +371,13 @@ namespace std
                 //       length_error (this function shall have no
                 //       effect in such case)
                 if (new_capacity > capacity_)
-                    resize_with_copy_(size_, new_capacity);
+                    reallocate_(new_capacity);
             }
 
             void shrink_to_fit()
             {
-                resize_with_copy_(size_, size_);
+                if (capacity_ > size_)
+                    reallocate_(size_);
             }
 
             reference operator[](size_type idx)
@@ -372,27 +442,42 @@ namespace std
             template<class... Args>
             reference emplace_back(Args&&... args)
             {
-                if (size_ >= capacity_)
-                    resize_with_copy_(size_, next_capacity_());
+                if (size_ < capacity_)
+                {
+                    alloc_traits_::construct(
+                        allocator_, data_ + size_, forward<Args>(args)...
+                    );
+                }
+                else
+                {
+                    /**
+                     * The new element is constructed before the old
+                     * ones are relocated as the arguments might refer
+                     * to elements of this vector.
+                     */
+                    auto new_capacity = next_capacity_();
+                    auto new_data = allocate_(new_capacity);
+                    alloc_traits_::construct(
+                        allocator_, new_data + size_, forward<Args>(args)...
+                    );
+
+                    relocate_(data_, size_, new_data);
+                    replace_storage_(new_data, new_capacity);
+                }
 
-                allocator_traits<Allocator>::construct(allocator_,
-                                                       begin() + size_, forward<Args>(args)...);
+                ++size_;
 
                 return back();
             }
 
             void push_back(const T& x)
             {
-                if (size_ >= capacity_)
-                    resize_with_copy_(size_, next_capacity_());
-                data_[size_++] = x;
+                emplace_back(x);
             }
 
             void push_back(T&& x)
             {
-                if (size_ >= capacity_)
-                    resize_with_copy_(size_, next_capacity_());
-                data_[size_++] = forward<T>(x);
+                emplace_back(forward<T>(x));
             }
 
             void pop_back()
@@ -404,83 +489,107 @@ namespace std
             template<class... Args>
             iterator emplace(const_iterator position, Args&&... args)
             {
-                auto pos = const_cast<iterator>(position);
+                auto idx = static_cast<size_type>(position - cbegin());
+                if (idx == size_)
+                {
+                    emplace_back(forward<Args>(args)...);
+
+                    return begin() + idx;
+                }
 
-                pos = shift_(pos, 1);
-                allocator_.construct(pos, forward<Args>(args)...);
+                // Args might refer to elements that will be shifted.
+                value_type tmp(forward<Args>(args)...);
+
+                auto pos = open_gap_(begin() + idx, 1);
+                alloc_traits_::construct(allocator_, pos, move(tmp));
 
                 return pos;
             }
 
             iterator insert(const_iterator position, const value_type& x)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, 1);
-                *pos = x;
-
-                return pos;
+                return emplace(position, x);
             }
 
             iterator insert(const_iterator position, value_type&& x)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, 1);
-                *pos = forward<value_type>(x);
-
-                return pos;
+                return emplace(position, forward<value_type>(x));
             }
 
             iterator insert(const_iterator position, size_type count, const value_type& x)
             {
-                auto pos = const_cast<iterator>(position);
+                if (count == 0)
+                    return const_cast<iterator>(position);
 
-                pos = shift_(pos, count);
-                auto copy_target = pos;
+                value_type tmp(x);
+
+                auto pos = open_gap_(const_cast<iterator>(position), count);
                 for (size_type i = 0; i < count; ++i)
-                    *copy_target++ = x;
+                    alloc_traits_::construct(allocator_, pos + i, tmp);
 
                 return pos;
             }
 
-            template<class InputIterator>
+            template<
+                class InputIterator,
+                class = enable_if_t<!is_integral_v<InputIterator>>
+            >
             iterator insert(const_iterator position, InputIterator first,
                             InputIterator last)
             {
-                auto pos = const_cast<iterator>(position);
-                auto count = static_cast<size_type>(last - first);
+                using category = typename iterator_traits<InputIterator>::iterator_category;
 
-                pos = shift_(pos, count);
-                copy(first, last, pos);
+                if constexpr (is_base_of_v<forward_iterator_tag, category>)
+                {
+                    auto count = static_cast<size_type>(distance(first, last));
+                    if (count == 0)
+                        return const_cast<iterator>(position);
 
-                return pos;
+                    auto pos = open_gap_(const_cast<iterator>(position), count);
+                    for (auto it = pos; first != last; ++first, ++it)
+                        alloc_traits_::construct(allocator_, it, *first);
+
+                    return pos;
+                }
+                else
+                {
+                    auto idx = static_cast<size_type>(position - cbegin());
+                    for (auto i = idx; first != last; ++first, ++i)
+                        emplace(cbegin() + i, *first);
+
+                    return begin() + idx;
+                }
             }
 
             iterator insert(const_iterator position, initializer_list<T> init)
             {
-                auto pos = const_cast<iterator>(position);
-
-                pos = shift_(pos, init.size());
-                copy(init.begin(), init.end(), pos);
-
-                return pos;
+                return insert(position, init.begin(), init.end());
             }
 
             iterator erase(const_iterator position)
             {
-                iterator pos = const_cast<iterator>(position);
-                copy(position + 1, cend(), pos);
-                --size_;
-
-                return pos;
+                return erase(position, position + 1);
             }
 
             iterator erase(const_iterator first, const_iterator last)
             {
                 iterator pos = const_cast<iterator>(first);
-                copy(last, cend(), pos);
-                size_ -= static_cast<size_type>(last - first);
+                auto count = static_cast<size_type>(last - first);
+                if (count == 0)
+                    return pos;
+
+                if constexpr (is_trivially_copyable_v<value_type>)
+                {
+                    auto tail = static_cast<size_type>(cend() - last);
+                    if (tail > 0)
+                        memmove(pos, last, tail * sizeof(value_type));
+                }
+                else
+                {
+                    move(const_cast<iterator>(last), end(), pos);
+                    destroy_from_end_until_(end() - count);
+                }
+                size_ -= count;
 
                 return pos;
             }
@@ -492,6 +601,8 @@ namespace std
                 std::swap(data_, other.data_);
                 std::swap(size_, other.size_);
                 std::swap(capacity_, other.capacity_);
+                if constexpr (allocator_traits<Allocator>::propagate_on_container_swap::value)
+                    std::swap(allocator_, other.allocator_);
             }
 
             void clear() noexcept
@@ -502,50 +613,95 @@ namespace std
             }
 
         private:
+            using alloc_traits_ = allocator_traits<Allocator>;
+
             value_type* data_;
             size_type size_;
             size_type capacity_;
             allocator_type allocator_;
 
-            void resize_without_copy_(size_type capacity)
+            value_type* allocate_(size_type capacity)
+            {
+                if (capacity == 0)
+                    return nullptr;
+
+                return allocator_.allocate(capacity);
+            }
+
+            /**
+             * Frees the current storage and adopts new_data,
+             * the elements must have been relocated already.
+             */
+            void replace_storage_(value_type* new_data, size_type new_capacity)
             {
                 if (data_)
                     allocator_.deallocate(data_, capacity_);
 
-                data_ = allocator_.allocate(capacity);
-                size_ = 0;
-                capacity_ = capacity;
+                data_ = new_data;
+                capacity_ = new_capacity;
             }
 
-            void resize_with_copy_(size_type size, size_type capacity)
+            void reallocate_(size_type capacity)
             {
-                if (size < size_)
-                    destroy_from_end_until_(begin() + size);
+                auto new_data = allocate_(capacity);
 
-                if(capacity_ == 0 || capacity_ < capacity)
-                {
-                    auto new_data = allocator_.allocate(capacity);
+                relocate_(data_, size_, new_data);
+                replace_storage_(new_data, capacity);
+            }
 
-                    auto to_copy = min(size, size_);
-                    for (size_type i = 0; i < to_copy; ++i)
-                        new_data[i] = move(data_[i]);
+            template<class Iterator>
+            void copy_construct_(Iterator from, size_type count, value_type* to)
+            {
+                if constexpr (is_trivially_copyable_v<value_type> &&
+                              is_pointer_v<Iterator>)
+                {
+                    if (count > 0)
+                        memcpy(to, from, count * sizeof(value_type));
+                }
+                else
+                {
+                    for (size_type i = 0; i < count; ++i, ++from)
+                        alloc_traits_::construct(allocator_, to + i, *from);
+                }
+            }
 
-                    std::swap(data_, new_data);
+            /**
+             * Moves count elements from one raw storage to another,
+             * leaving the source uninitialized. Trivially copyable
+             * types are copied in bulk, other types are moved only
+             * if that cannot throw and copied otherwise.
+             */
+            void relocate_(value_type* from, size_type count, value_type* to)
+            {
+                if (count == 0)
+                    return;
 
-                    allocator_.deallocate(new_data, capacity_);
+                if constexpr (is_trivially_copyable_v<value_type>)
+                    memcpy(to, from, count * sizeof(value_type));
+                else
+                {
+                    for (size_type i = 0; i < count; ++i)
+                    {
+                        alloc_traits_::construct(
+                            allocator_, to + i, move_if_noexcept(from[i])
+                        );
+                    }
+
+                    for (size_type i = 0; i < count; ++i)
+                        alloc_traits_::destroy(allocator_, from + i);
                 }
-
-                capacity_ = capacity;
-                size_ = size;
             }
 
             void destroy_from_end_until_(iterator target)
             {
-                if (!empty())
+                if constexpr (!is_trivially_destructible_v<value_type>)
                 {
-                    auto last = end();
-                    while(last != target)
-                        allocator_traits<Allocator>::destroy(allocator_, --last);
+                    if (!empty())
+                    {
+                        auto last = end();
+                        while(last != target)
+                            alloc_traits_::destroy(allocator_, --last);
+                    }
                 }
             }
 
@@ -557,37 +713,61 @@ namespace std
                     return max(capacity_ * 2, size_type{2u});
             }
 
-            iterator shift_(iterator position, size_type count)
+            /**
+             * Makes room for count elements at position and
+             * returns the adjusted position of the room, which
+             * is left uninitialized for the caller to construct
+             * the new elements in.
+             */
+            iterator open_gap_(iterator position, size_type count)
             {
-                if (size_ + count < capacity_)
-                {
-                    copy_backward(position, end(), end() + count);
-                    size_ += count;
+                auto idx = static_cast<size_type>(position - begin());
+                auto tail = size_ - idx;
 
-                    return position;
+                if (size_ + count <= capacity_)
+                {
+                    if constexpr (is_trivially_copyable_v<value_type>)
+                    {
+                        if (tail > 0)
+                            memmove(position + count, position, tail * sizeof(value_type));
+                    }
+                    else
+                    {
+                        /**
+                         * Elements that end up past the old end
+                         * are constructed in raw storage, the rest
+                         * is moved backwards and the moved from
+                         * elements left in the gap get destroyed.
+                         */
+                        auto old_end = end();
+                        auto split = tail > count ? old_end - count : position;
+                        for (auto it = old_end; it != split;)
+                        {
+                            --it;
+                            alloc_traits_::construct(
+                                allocator_, it + count, move(*it)
+                            );
+                        }
+
+                        move_backward(position, split, old_end);
+
+                        auto gap_end = position + min(count, tail);
+                        for (auto it = position; it != gap_end; ++it)
+                            alloc_traits_::destroy(allocator_, it);
+                    }
                 }
                 else
                 {
-                    auto start_idx = static_cast<size_type>(position - begin());
-                    auto end_idx = start_idx + count;
-                    auto new_size = size_ + count;
-
-                    // Auxiliary vector for easier swap.
-                    vector tmp{};
-                    tmp.resize_without_copy_(max(new_size, capacity_));
-                    tmp.size_ = new_size;
-
-                    // Copy before insertion index.
-                    copy(begin(), begin() + start_idx, tmp.begin());
+                    auto new_capacity = next_capacity_(size_ + count);
+                    auto new_data = allocate_(new_capacity);
 
-                    // Copy after insertion index.
-                    copy(begin() + start_idx, end(), tmp.begin() + end_idx);
-
-                    swap(tmp);
-
-                    // Position was invalidated!
-                    return begin() + start_idx;
+                    relocate_(data_, idx, new_data);
+                    relocate_(data_ + idx, tail, new_data + idx + count);
+                    replace_storage_(new_data, new_capacity);
                 }
+                size_ += count;
+
+                return begin() + idx;
             }
     };
 
@@ -661,6 +841,12 @@ namespace std
      */
 
     // TODO: implement
+
+    namespace pmr
+    {
+        template<class T>
+        using vector = std::vector<T, polymorphic_allocator<T>>;
+    }
 }
 
 #endif
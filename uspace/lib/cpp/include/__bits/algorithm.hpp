@@ -30,6 +30,7 @@
 #define LIBCPP_BITS_ALGORITHM
 
 #include <iterator>
+#include <new>
 #include <utility>
 
 namespace std
@@ -408,9 +409,11 @@ namespace std
     BidirectionalIterator2 move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last,
                                          BidirectionalIterator2 result)
     {
-        // Note: We're copying [first, last) so we need to skip the initial value of last.
-        while (last-- != first)
-            *result-- = move(*last);
+        // Note: result is the end of the destination range.
+        while (first != last)
+            *--result = move(*--last);
+
+        return result;
     }
 
     /**
@@ -687,6 +690,210 @@ namespace std
     void sort_heap(RandomAccessIterator, RandomAccessIterator,
                    Compare);
 
+    namespace aux
+    {
+        template<class RandomAccessIterator, class Size, class Compare>
+        void correct_children(RandomAccessIterator, Size, Size, Compare);
+
+        /**
+         * Ranges of at most this many elements are left
+         * to insertion sort by the sorting and selection
+         * algorithms below.
+         */
+        constexpr ptrdiff_t sort_threshold{16};
+
+        template<class Size>
+        Size sort_depth_limit(Size count)
+        {
+            Size depth{};
+            while (count > 1)
+            {
+                count /= 2;
+                ++depth;
+            }
+
+            return 2 * depth;
+        }
+
+        template<class RandomAccessIterator, class Compare>
+        void insertion_sort(RandomAccessIterator first,
+                            RandomAccessIterator last,
+                            Compare comp)
+        {
+            if (first == last)
+                return;
+
+            for (auto it = first + 1; it != last; ++it)
+            {
+                if (comp(*it, *first))
+                {
+                    /**
+                     * New minimum, no need to compare on the way
+                     * down to the beginning of the range.
+                     */
+                    auto tmp = move(*it);
+                    for (auto hole = it; hole != first; --hole)
+                        *hole = move(*(hole - 1));
+                    *first = move(tmp);
+                }
+                else
+                {
+                    /**
+                     * The first element guards the scan, so
+                     * the lower bound check can be omitted.
+                     */
+                    auto tmp = move(*it);
+                    auto hole = it;
+                    for (auto prev = hole - 1; comp(tmp, *prev); --prev)
+                    {
+                        *hole = move(*prev);
+                        hole = prev;
+                    }
+                    *hole = move(tmp);
+                }
+            }
+        }
+
+        template<class RandomAccessIterator, class Compare>
+        void move_median_to_first(RandomAccessIterator result,
+                                  RandomAccessIterator a,
+                                  RandomAccessIterator b,
+                                  RandomAccessIterator c,
+                                  Compare comp)
+        {
+            if (comp(*a, *b))
+            {
+                if (comp(*b, *c))
+                    iter_swap(result, b);
+                else if (comp(*a, *c))
+                    iter_swap(result, c);
+                else
+                    iter_swap(result, a);
+            }
+            else if (comp(*a, *c))
+                iter_swap(result, a);
+            else if (comp(*b, *c))
+                iter_swap(result, c);
+            else
+                iter_swap(result, b);
+        }
+
+        /**
+         * Partitions [first, last) around the median of its first,
+         * middle and last element and returns the cut point such
+         * that no element in [first, cut) is greater than any
+         * element in [cut, last). The median of three guarantees
+         * that both scans stop inside of the range, which is why
+         * neither of them checks the bounds. Large ranges use
+         * the median of three medians (Tukey's ninther) for
+         * the three candidates instead.
+         */
+        template<class RandomAccessIterator, class Compare>
+        RandomAccessIterator partition_pivot(RandomAccessIterator first,
+                                             RandomAccessIterator last,
+                                             Compare comp)
+        {
+            auto count = last - first;
+            auto mid = first + count / 2;
+            if (count > 8 * sort_threshold)
+            {
+                auto step = count / 8;
+                move_median_to_first(first + 1, first + 1, first + step,
+                                     first + 2 * step, comp);
+                move_median_to_first(mid, mid - step, mid, mid + step, comp);
+                move_median_to_first(last - 1, last - 1 - 2 * step,
+                                     last - 1 - step, last - 1, comp);
+            }
+            move_median_to_first(first, first + 1, mid, last - 1, comp);
+
+            auto lo = first + 1;
+            auto hi = last;
+            while (true)
+            {
+                while (comp(*lo, *first))
+                    ++lo;
+                --hi;
+                while (comp(*first, *hi))
+                    --hi;
+
+                if (!(lo < hi))
+                    return lo;
+
+                iter_swap(lo, hi);
+                ++lo;
+            }
+        }
+
+        template<class RandomAccessIterator, class Size, class Compare>
+        void introsort_loop(RandomAccessIterator first,
+                            RandomAccessIterator last,
+                            Size depth, Compare comp)
+        {
+            while (last - first > sort_threshold)
+            {
+                if (depth == 0)
+                {
+                    /**
+                     * Too many bad pivots, fall back to heapsort
+                     * to keep the worst case at O(n log n).
+                     */
+                    make_heap(first, last, comp);
+                    sort_heap(first, last, comp);
+
+                    return;
+                }
+                --depth;
+
+                /**
+                 * Recurse into the smaller part and loop on
+                 * the larger one to bound the stack depth.
+                 */
+                auto cut = partition_pivot(first, last, comp);
+                if (cut - first < last - cut)
+                {
+                    introsort_loop(first, cut, depth, comp);
+                    first = cut;
+                }
+                else
+                {
+                    introsort_loop(cut, last, depth, comp);
+                    last = cut;
+                }
+            }
+        }
+
+        template<class RandomAccessIterator, class Compare>
+        void introselect(RandomAccessIterator first,
+                         RandomAccessIterator nth,
+                         RandomAccessIterator last,
+                         Compare comp)
+        {
+            if (first == last || nth == last)
+                return;
+
+            auto depth = sort_depth_limit(last - first);
+            while (last - first > sort_threshold)
+            {
+                if (depth == 0)
+                {
+                    make_heap(first, last, comp);
+                    sort_heap(first, last, comp);
+
+                    return;
+                }
+                --depth;
+
+                auto cut = partition_pivot(first, last, comp);
+                if (cut <= nth)
+                    first = cut;
+                else
+                    last = cut;
+            }
+
+            insertion_sort(first, last, comp);
+        }
+    }
+
     template<class RandomAccessIterator>
     void sort(RandomAccessIterator first, RandomAccessIterator last)
     {
@@ -700,40 +907,350 @@ namespace std
               Compare comp)
     {
         /**
-         * Note: This isn't the most effective approach,
-         *       but since we already have these two functions
-         *       and they satisfy asymptotic limitations
-         *       imposed by the standard, we're using them at
-         *       the moment. Might be good to change it to qsort
-         *       or merge sort later.
+         * Introsort: quicksort with median of three pivots that
+         * switches to heapsort when the recursion gets too deep
+         * and leaves short ranges unsorted. Since every element
+         * is then at most aux::sort_threshold positions away from
+         * its final place, one insertion sort pass finishes
+         * the job in linear time.
          */
+        if (last - first < 2)
+            return;
 
-        make_heap(first, last, comp);
-        sort_heap(first, last, comp);
+        aux::introsort_loop(first, last, aux::sort_depth_limit(last - first), comp);
+        aux::insertion_sort(first, last, comp);
     }
 
     /**
      * 25.4.1.2, stable_sort:
      */
 
-    // TODO: implement
+    namespace aux
+    {
+        template<class RandomAccessIterator>
+        void reverse_range(RandomAccessIterator first,
+                           RandomAccessIterator last)
+        {
+            while (first < last)
+                iter_swap(first++, --last);
+        }
+
+        template<class RandomAccessIterator>
+        void rotate_range(RandomAccessIterator first,
+                          RandomAccessIterator mid,
+                          RandomAccessIterator last)
+        {
+            reverse_range(first, mid);
+            reverse_range(mid, last);
+            reverse_range(first, last);
+        }
+
+        template<class RandomAccessIterator, class T, class Compare>
+        RandomAccessIterator lower_bound_of(RandomAccessIterator first,
+                                            RandomAccessIterator last,
+                                            const T& value, Compare comp)
+        {
+            auto count = last - first;
+            while (count > 0)
+            {
+                auto half = count / 2;
+                auto mid = first + half;
+                if (comp(*mid, value))
+                {
+                    first = mid + 1;
+                    count -= half + 1;
+                }
+                else
+                    count = half;
+            }
+
+            return first;
+        }
+
+        template<class RandomAccessIterator, class T, class Compare>
+        RandomAccessIterator upper_bound_of(RandomAccessIterator first,
+                                            RandomAccessIterator last,
+                                            const T& value, Compare comp)
+        {
+            auto count = last - first;
+            while (count > 0)
+            {
+                auto half = count / 2;
+                auto mid = first + half;
+                if (!comp(value, *mid))
+                {
+                    first = mid + 1;
+                    count -= half + 1;
+                }
+                else
+                    count = half;
+            }
+
+            return first;
+        }
+
+        /**
+         * Stable merge of [first, mid) and [mid, last) used when
+         * no temporary buffer could be obtained, O(n log n) moves.
+         */
+        template<class RandomAccessIterator, class Compare>
+        void merge_in_place(RandomAccessIterator first,
+                            RandomAccessIterator mid,
+                            RandomAccessIterator last,
+                            Compare comp)
+        {
+            auto len1 = mid - first;
+            auto len2 = last - mid;
+            if (len1 == 0 || len2 == 0)
+                return;
+
+            if (len1 + len2 == 2)
+            {
+                if (comp(*mid, *first))
+                    iter_swap(first, mid);
+
+                return;
+            }
+
+            RandomAccessIterator cut1, cut2;
+            if (len1 > len2)
+            {
+                cut1 = first + len1 / 2;
+                cut2 = lower_bound_of(mid, last, *cut1, comp);
+            }
+            else
+            {
+                cut2 = mid + len2 / 2;
+                cut1 = upper_bound_of(first, mid, *cut2, comp);
+            }
+
+            rotate_range(cut1, mid, cut2);
+            auto new_mid = cut1 + (cut2 - mid);
+
+            merge_in_place(first, cut1, new_mid, comp);
+            merge_in_place(new_mid, cut2, last, comp);
+        }
+
+        template<class RandomAccessIterator, class Compare>
+        void merge_sort_in_place(RandomAccessIterator first,
+                                 RandomAccessIterator last,
+                                 Compare comp)
+        {
+            if (last - first <= sort_threshold)
+            {
+                insertion_sort(first, last, comp);
+
+                return;
+            }
+
+            auto mid = first + (last - first) / 2;
+            merge_sort_in_place(first, mid, comp);
+            merge_sort_in_place(mid, last, comp);
+            merge_in_place(first, mid, last, comp);
+        }
+
+        /**
+         * Stable merge of [first, mid) and [mid, last) that moves
+         * the left range into buf first, buf has to hold at least
+         * mid - first valid (e.g. moved from) objects. Ties are
+         * resolved in favour of the left range.
+         */
+        template<class RandomAccessIterator, class Pointer, class Compare>
+        void merge_with_buffer(RandomAccessIterator first,
+                               RandomAccessIterator mid,
+                               RandomAccessIterator last,
+                               Pointer buf, Compare comp)
+        {
+            if (first == mid || mid == last || !comp(*mid, *(mid - 1)))
+                return;
+
+            auto buf_end = buf;
+            for (auto it = first; it != mid; ++it)
+                *buf_end++ = move(*it);
+
+            auto out = first;
+            auto left = buf;
+            auto right = mid;
+            while (left != buf_end && right != last)
+            {
+                if (comp(*right, *left))
+                    *out++ = move(*right++);
+                else
+                    *out++ = move(*left++);
+            }
+
+            while (left != buf_end)
+                *out++ = move(*left++);
+        }
+
+        /**
+         * Merge sort that moves the left half of every merged
+         * range into buf, which has to hold at least half of
+         * the elements of [first, last).
+         */
+        template<class RandomAccessIterator, class Pointer, class Compare>
+        void merge_sort_buffered(RandomAccessIterator first,
+                                 RandomAccessIterator last,
+                                 Pointer buf, Compare comp)
+        {
+            if (last - first <= sort_threshold)
+            {
+                insertion_sort(first, last, comp);
+
+                return;
+            }
+
+            auto mid = first + (last - first) / 2;
+            merge_sort_buffered(first, mid, buf, comp);
+            merge_sort_buffered(mid, last, buf, comp);
+            merge_with_buffer(first, mid, last, buf, comp);
+        }
+    }
+
+    template<class RandomAccessIterator>
+    void stable_sort(RandomAccessIterator first, RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        stable_sort(first, last, less<value_type>{});
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void stable_sort(RandomAccessIterator first, RandomAccessIterator last,
+                     Compare comp)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        auto count = last - first;
+        if (count < 2)
+            return;
+
+        /**
+         * The standard allows stable_sort to degrade to
+         * O(n log^2 n) when there is not enough memory,
+         * so failure to get the buffer is not an error.
+         */
+        auto buf_size = static_cast<size_t>((count + 1) / 2);
+        auto buf = static_cast<value_type*>(
+            ::operator new(buf_size * sizeof(value_type), nothrow)
+        );
+        if (!buf)
+        {
+            aux::merge_sort_in_place(first, last, comp);
+
+            return;
+        }
+
+        /**
+         * Fill the buffer with valid objects, the merges
+         * then only need move assignment.
+         */
+        for (size_t i = 0; i < buf_size; ++i)
+        {
+            ::new(static_cast<void*>(buf + i)) value_type(move(first[i]));
+            first[i] = move(buf[i]);
+        }
+
+        aux::merge_sort_buffered(first, last, buf, comp);
+
+        for (size_t i = 0; i < buf_size; ++i)
+            buf[i].~value_type();
+        ::operator delete(static_cast<void*>(buf));
+    }
 
     /**
      * 25.4.1.3, partial_sort:
      */
 
-    // TODO: implement
+    template<class RandomAccessIterator>
+    void partial_sort(RandomAccessIterator first,
+                      RandomAccessIterator middle,
+                      RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        partial_sort(first, middle, last, less<value_type>{});
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void partial_sort(RandomAccessIterator first,
+                      RandomAccessIterator middle,
+                      RandomAccessIterator last,
+                      Compare comp)
+    {
+        if (first == middle)
+            return;
+
+        /**
+         * Selecting the smallest elements first makes this
+         * O(n + k log k) on average instead of the O(n log k)
+         * of the heap selection approach.
+         */
+        aux::introselect(first, middle - 1, last, comp);
+        sort(first, middle, comp);
+    }
 
     /**
      * 25.4.1.4, partial_sort_copy:
      */
 
-    // TODO: implement
+    template<class InputIterator, class RandomAccessIterator>
+    RandomAccessIterator partial_sort_copy(InputIterator first,
+                                           InputIterator last,
+                                           RandomAccessIterator result_first,
+                                           RandomAccessIterator result_last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        return partial_sort_copy(first, last, result_first, result_last,
+                                 less<value_type>{});
+    }
+
+    template<class InputIterator, class RandomAccessIterator, class Compare>
+    RandomAccessIterator partial_sort_copy(InputIterator first,
+                                           InputIterator last,
+                                           RandomAccessIterator result_first,
+                                           RandomAccessIterator result_last,
+                                           Compare comp)
+    {
+        auto result = result_first;
+        while (first != last && result != result_last)
+            *result++ = *first++;
+
+        if (result == result_first)
+            return result;
+
+        /**
+         * Keep the smallest elements seen so far in a max heap,
+         * anything smaller than its top replaces the top.
+         */
+        auto count = result - result_first;
+        make_heap(result_first, result, comp);
+        while (first != last)
+        {
+            if (comp(*first, *result_first))
+            {
+                *result_first = *first;
+                aux::correct_children(result_first, decltype(count){},
+                                      count, comp);
+            }
+            ++first;
+        }
+        sort_heap(result_first, result, comp);
+
+        return result;
+    }
 
     /**
      * 25.4.1.5, is_sorted:
      */
 
+    template<class ForwardIterator>
+    ForwardIterator is_sorted_until(ForwardIterator, ForwardIterator);
+
+    template<class ForwardIterator, class Comp>
+    ForwardIterator is_sorted_until(ForwardIterator, ForwardIterator, Comp);
+
     template<class ForwardIterator>
     bool is_sorted(ForwardIterator first, ForwardIterator last)
     {
@@ -753,10 +1270,12 @@ namespace std
         if (distance(first, last) < 2)
             return last;
 
-        while (first != last)
+        auto next = first;
+        while (++next != last)
         {
-            if (*first > *(++first))
-                return first;
+            if (*next < *first)
+                return next;
+            first = next;
         }
 
         return last;
@@ -769,10 +1288,12 @@ namespace std
         if (distance(first, last) < 2)
             return last;
 
-        while (first != last)
+        auto next = first;
+        while (++next != last)
         {
-            if (!comp(*first, *(++first)))
-                return first;
+            if (comp(*next, *first))
+                return next;
+            first = next;
         }
 
         return last;
@@ -782,7 +1303,24 @@ namespace std
      * 25.4.2, nth_element:
      */
 
-    // TODO: implement
+    template<class RandomAccessIterator>
+    void nth_element(RandomAccessIterator first,
+                     RandomAccessIterator nth,
+                     RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        nth_element(first, nth, last, less<value_type>{});
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void nth_element(RandomAccessIterator first,
+                     RandomAccessIterator nth,
+                     RandomAccessIterator last,
+                     Compare comp)
+    {
+        aux::introselect(first, nth, last, comp);
+    }
 
     /**
      * 25.4.3, binary search:
@@ -883,32 +1421,25 @@ namespace std
             using aux::heap_left_child;
             using aux::heap_right_child;
 
+            /**
+             * Sift the element down, always swapping it with
+             * the larger of its children.
+             */
             auto left = heap_left_child(idx);
-            auto right = heap_right_child(idx);
-
-            bool left_incorrect{comp(first[idx], first[left])};
-            bool right_incorrect{comp(first[idx], first[right])};
-            while ((left < count && left_incorrect) ||
-                   (right < count && right_incorrect))
+            while (left < count)
             {
-                if (right >= count || (left_incorrect && comp(first[right], first[left])))
-                {
-                    swap(first[idx], first[left]);
+                auto larger = left;
+                auto right = heap_right_child(idx);
+                if (right < count && comp(first[left], first[right]))
+                    larger = right;
 
-                    idx = left;
-                }
-                else if (right < count && right_incorrect)
-                {
-                    swap(first[idx], first[right]);
+                if (!comp(first[idx], first[larger]))
+                    break;
 
-                    idx = right;
-                } // Else should not happen because of the while condition.
+                swap(first[idx], first[larger]);
 
+                idx = larger;
                 left = heap_left_child(idx);
-                right = heap_right_child(idx);
-
-                left_incorrect = comp(first[idx], first[left]);
-                right_incorrect = comp(first[idx], first[right]);
             }
         }
     }
@@ -971,7 +1502,7 @@ namespace std
             return;
 
         swap(first[0], first[count - 1]);
-        aux::correct_children(first, decltype(count){}, count - 2, comp);
+        aux::correct_children(first, decltype(count){}, count - 1, comp);
     }
 
     /**
@@ -996,7 +1527,7 @@ namespace std
         if (count <= 1)
             return;
 
-        for (auto i = count; i > 0; --i)
+        for (auto i = count / 2; i > 0; --i)
         {
             auto idx = i - 1;
 
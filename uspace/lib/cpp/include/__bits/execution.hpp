@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_EXECUTION
+#define LIBCPP_BITS_EXECUTION
+
+#include <type_traits>
+
+namespace std
+{
+    /**
+     * 23.19.3, execution policy type trait:
+     */
+
+    template<class T>
+    struct is_execution_policy: false_type
+    { /* DUMMY BODY */ };
+
+    template<class T>
+    inline constexpr bool is_execution_policy_v = is_execution_policy<T>::value;
+}
+
+namespace std::execution
+{
+    /**
+     * 23.19.4, sequenced execution policy:
+     */
+
+    class sequenced_policy
+    { /* DUMMY BODY */ };
+
+    /**
+     * 23.19.5, parallel execution policy:
+     */
+
+    class parallel_policy
+    { /* DUMMY BODY */ };
+
+    /**
+     * 23.19.6, parallel and unsequenced execution policy:
+     * Note: We have no vectorization of our own, so this
+     *       is treated the same as the parallel policy.
+     */
+
+    class parallel_unsequenced_policy
+    { /* DUMMY BODY */ };
+
+    /**
+     * 23.19.7, execution policy objects:
+     */
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr parallel_policy par{};
+    inline constexpr parallel_unsequenced_policy par_unseq{};
+}
+
+namespace std
+{
+    template<>
+    struct is_execution_policy<execution::sequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_unsequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    namespace aux
+    {
+        template<class ExecutionPolicy, class T = void>
+        using enable_if_execution_policy_t = enable_if_t<
+            is_execution_policy_v<decay_t<ExecutionPolicy>>, T
+        >;
+
+        template<class ExecutionPolicy>
+        inline constexpr bool is_parallel_policy_v =
+            !is_same_v<decay_t<ExecutionPolicy>, execution::sequenced_policy>;
+    }
+}
+
+#endif
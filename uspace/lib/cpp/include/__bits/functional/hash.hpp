@@ -75,7 +75,12 @@ namespace std
             static_assert(is_arithmetic<T>::value || is_pointer<T>::value,
                           "invalid type passed to aux::hash");
 
+            /**
+             * Note: Types narrower than uint64_t would leave
+             *       the rest of converted undefined otherwise.
+             */
             converter<T> conv;
+            conv.converted = 0;
             conv.value = x;
 
             return hash_<size_t>(conv.converted);
@@ -58,26 +58,25 @@ namespace std
 
             basic_filebuf()
                 : basic_streambuf<char_type, traits_type>{},
-                  obuf_{nullptr}, ibuf_{nullptr}, mode_{}, file_{nullptr}
+                  buf_{nullptr}, buf_size_{default_buf_size_}, own_buf_{true},
+                  mode_{}, file_{nullptr}
             { /* DUMMY BODY */ }
 
             basic_filebuf(const basic_filebuf&) = delete;
 
             basic_filebuf(basic_filebuf&& other)
-                : mode_{other.mode_}
+                : basic_filebuf{}
             {
-                close();
-                std::swap(obuf_, other.obuf_);
-                std::swap(ibuf_, other.ibuf_);
-                std::swap(file_, other.file_);
-
-                basic_streambuf<char_type, traits_type>::swap(other);
+                swap(other);
             }
 
             virtual ~basic_filebuf()
             {
                 // TODO: exception here caught and not rethrown
                 close();
+
+                if (own_buf_)
+                    delete[] buf_;
             }
 
             /**
@@ -96,9 +95,11 @@ namespace std
 
             void swap(basic_filebuf& rhs)
             {
+                std::swap(buf_, rhs.buf_);
+                std::swap(buf_size_, rhs.buf_size_);
+                std::swap(own_buf_, rhs.own_buf_);
                 std::swap(mode_, rhs.mode_);
-                std::swap(obuf_, rhs.obuf_);
-                std::swap(ibuf_, rhs.ibuf_);
+                std::swap(file_, rhs.file_);
 
                 basic_streambuf<char_type, traits_type>::swap(rhs);
             }
@@ -128,6 +129,12 @@ namespace std
                 if (!file_)
                     return nullptr;
 
+                /**
+                 * We do our own buffering, so there is no point
+                 * in having stdio copy everything once more.
+                 */
+                setvbuf(file_, nullptr, ::helenos::_IONBF, 0);
+
                 if ((mode_ & ios_base::ate) != 0)
                 {
                     if (fseek(file_, 0, SEEK_END) != 0)
@@ -137,11 +144,12 @@ namespace std
                     }
                 }
 
-                if (!ibuf_ && mode_is_in_(mode_))
-                    ibuf_ = new char_type[buf_size_];
-                if (!obuf_ && mode_is_out_(mode_))
-                    obuf_ = new char_type[buf_size_];
-                init_();
+                if (!buf_)
+                {
+                    buf_ = new char_type[buf_size_];
+                    own_buf_ = true;
+                }
+                reset_areas_();
 
                 return this;
             }
@@ -156,16 +164,18 @@ namespace std
                 // TODO: caught exceptions are to be rethrown after closing the file
                 if (!file_)
                     return nullptr;
-                // TODO: deallocate buffers?
 
-                if (this->output_next_ != this->output_begin_)
-                    overflow(traits_type::eof());
+                auto res = flush_output_();
                 // TODO: unshift? (p. 1084 at the top)
 
-                fclose(file_);
+                if (fclose(file_) != 0)
+                    res = false;
                 file_ = nullptr;
 
-                return this;
+                this->setg(nullptr, nullptr, nullptr);
+                this->setp(nullptr, nullptr);
+
+                return res ? this : nullptr;
             }
 
         protected:
@@ -173,50 +183,78 @@ namespace std
              * 27.9.1.5, overriden virtual functions:
              */
 
+            streamsize showmanyc() override
+            {
+                if (!file_ || !mode_is_in_(mode_))
+                    return -1;
+
+                return static_cast<streamsize>(this->egptr() - this->gptr());
+            }
+
             int_type underflow() override
             {
                 // TODO: use codecvt
-                if (!mode_is_in_(mode_))
+                if (!file_ || !mode_is_in_(mode_))
+                    return traits_type::eof();
+
+                if (this->read_avail_())
+                    return traits_type::to_int_type(*this->gptr());
+
+                if (!flush_output_())
                     return traits_type::eof();
 
-                if (!ibuf_)
+                /**
+                 * The last few characters are moved to the front
+                 * of the buffer so that they can still be put back.
+                 */
+                size_t keep{};
+                if (this->gptr())
                 {
-                    ibuf_ = new char_type[buf_size_];
-                    this->input_begin_ = this->input_next_ = this->input_end_ = ibuf_;
+                    keep = min(static_cast<size_t>(this->gptr() - this->eback()),
+                               min(putback_size_, buf_size_ / 2));
+                    traits_type::move(buf_, this->gptr() - keep, keep);
                 }
 
-                off_type i{};
-                if (this->input_next_ < this->input_end_)
-                {
-                    auto idx = static_cast<off_type>(this->input_next_ - this->input_begin_);
-                    auto count = static_cast<off_type>(buf_size_) - idx;
+                auto count = fread(buf_ + keep, sizeof(char_type), buf_size_ - keep, file_);
+                this->setg(buf_, buf_ + keep, buf_ + keep + count);
 
-                    for (; i < count; ++i, ++idx)
-                        ibuf_[i] = ibuf_[idx];
-                }
+                if (count == 0)
+                    return traits_type::eof();
 
-                for (; i < static_cast<off_type>(buf_size_); ++i)
-                {
-                    auto c = fgetc(file_);
-                    if (c == traits_type::eof())
-                        break;
+                return traits_type::to_int_type(*this->gptr());
+            }
 
-                    ibuf_[i] = static_cast<char_type>(c);
+            streamsize xsgetn(char_type* s, streamsize n) override
+            {
+                if (!file_ || !mode_is_in_(mode_) || !s || n <= 0)
+                    return 0;
 
-                    if (ibuf_[i] == '\n')
-                    {
-                        ++i;
-                        break;
-                    }
+                auto count = static_cast<size_t>(n);
+                if (count < buf_size_)
+                    return basic_streambuf<char_type, traits_type>::xsgetn(s, n);
+
+                /**
+                 * Large reads drain the buffer and then go
+                 * directly into the destination.
+                 */
+                size_t done{};
+                if (this->read_avail_())
+                {
+                    done = min(static_cast<size_t>(this->egptr() - this->gptr()), count);
+                    traits_type::copy(s, this->gptr(), done);
+                    this->gbump(static_cast<int>(done));
                 }
 
-                this->input_next_ = this->input_begin_;
-                this->input_end_ = this->input_begin_ + i;
+                if (done < count)
+                {
+                    if (!flush_output_())
+                        return static_cast<streamsize>(done);
 
-                if (i == 0)
-                    return traits_type::eof();
+                    done += fread(s + done, sizeof(char_type), count - done, file_);
+                    this->setg(buf_, buf_, buf_);
+                }
 
-                return traits_type::to_int_type(*this->input_next_);
+                return static_cast<streamsize>(done);
             }
 
             int_type pbackfail(int_type c = traits_type::eof()) override
@@ -251,48 +289,146 @@ namespace std
             int_type overflow(int_type c = traits_type::eof()) override
             {
                 // TODO: use codecvt
-                if (!mode_is_out_(mode_))
+                if (!file_ || !mode_is_out_(mode_))
                     return traits_type::eof();
 
-                auto count = static_cast<size_t>(this->output_next_ - this->output_begin_);
-                fwrite(obuf_, sizeof(char_type), count, file_);
-                fflush(file_);
+                if (this->pptr())
+                {
+                    if (!flush_output_())
+                        return traits_type::eof();
+                }
+                else if (!drop_input_())
+                    return traits_type::eof();
+                this->setp(buf_, buf_ + buf_size_);
 
-                this->output_next_ = this->output_begin_;
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    *this->output_next_++ = traits_type::to_char_type(c);
 
                 return traits_type::not_eof(c);
             }
 
+            streamsize xsputn(const char_type* s, streamsize n) override
+            {
+                if (!file_ || !mode_is_out_(mode_) || !s || n <= 0)
+                    return 0;
+
+                auto count = static_cast<size_t>(n);
+                if (this->write_avail_() &&
+                    count <= static_cast<size_t>(this->epptr() - this->pptr()))
+                {
+                    traits_type::copy(this->pptr(), s, count);
+                    this->pbump(static_cast<int>(count));
+
+                    return n;
+                }
+
+                if (count < buf_size_)
+                    return basic_streambuf<char_type, traits_type>::xsputn(s, n);
+
+                /**
+                 * Large writes flush whatever is buffered and
+                 * then bypass the buffer completely.
+                 */
+                if (this->pptr())
+                {
+                    if (!flush_output_())
+                        return 0;
+                }
+                else if (!drop_input_())
+                    return 0;
+
+                return static_cast<streamsize>(fwrite(s, sizeof(char_type), count, file_));
+            }
+
             basic_streambuf<char_type, traits_type>*
             setbuf(char_type* s, streamsize n) override
             {
-                // TODO: implement
-                __unimplemented();
-                return nullptr;
+                /**
+                 * Only allowed before any I/O took place,
+                 * we also allocate lazily in open().
+                 */
+                if (this->gptr() != this->egptr() || this->pptr() != this->pbase())
+                    return nullptr;
+
+                if (own_buf_)
+                    delete[] buf_;
+
+                if (s && n > 0)
+                {
+                    buf_ = s;
+                    buf_size_ = static_cast<size_t>(n);
+                    own_buf_ = false;
+                }
+                else
+                {
+                    /**
+                     * Note: A buffer of one character still works,
+                     *       every other character causes a transfer.
+                     */
+                    buf_size_ = (!s && n == 0) ? 1 : default_buf_size_;
+                    buf_ = new char_type[buf_size_];
+                    own_buf_ = true;
+                }
+
+                if (file_)
+                    reset_areas_();
+
+                return this;
             }
 
             pos_type seekoff(off_type off, ios_base::seekdir dir,
                              ios_base::openmode mode = ios_base::in | ios_base::out) override
             {
-                // TODO: implement
-                __unimplemented();
-                return pos_type{};
+                // TODO: use codecvt (and fail for variable width encodings)
+                if (!file_)
+                    return pos_type(off_type(-1));
+
+                if (!flush_output_())
+                    return pos_type(off_type(-1));
+
+                int whence{SEEK_SET};
+                if (dir == ios_base::cur)
+                {
+                    whence = SEEK_CUR;
+
+                    /**
+                     * The file position is past the characters
+                     * we have read ahead.
+                     */
+                    if (this->gptr())
+                        off -= static_cast<off_type>(this->egptr() - this->gptr());
+                }
+                else if (dir == ios_base::end)
+                    whence = SEEK_END;
+
+                this->setg(buf_, buf_, buf_);
+                this->setp(nullptr, nullptr);
+
+                if (fseek(file_, static_cast<long>(off * sizeof(char_type)), whence) != 0)
+                    return pos_type(off_type(-1));
+
+                auto res = ftell(file_);
+                if (res < 0)
+                    return pos_type(off_type(-1));
+
+                return pos_type(off_type(res / sizeof(char_type)));
             }
 
             pos_type seekpos(pos_type pos,
                              ios_base::openmode mode = ios_base::in | ios_base::out) override
             {
-                // TODO: implement
-                __unimplemented();
-                return pos_type{};
+                return seekoff(off_type(pos), ios_base::beg, mode);
             }
 
             int sync() override
             {
-                if (mode_is_out_(mode_))
-                    overflow();
+                if (!file_)
+                    return 0;
+
+                if (!flush_output_() || fflush(file_) != 0)
+                    return -1;
 
-                return 0; // TODO: what is the correct return value?
+                return 0;
             }
 
             void imbue(const locale& loc) override
@@ -302,14 +438,20 @@ namespace std
             }
 
         private:
-            char_type* obuf_;
-            char_type* ibuf_;
+            /**
+             * The get and put areas share a single buffer,
+             * at most one of them is active at a time.
+             */
+            char_type* buf_;
+            size_t buf_size_;
+            bool own_buf_;
 
             ios_base::openmode mode_;
 
             FILE* file_;
 
-            static constexpr size_t buf_size_{128};
+            static constexpr size_t default_buf_size_{8192};
+            static constexpr size_t putback_size_{8};
 
             const char* get_mode_str_(ios_base::openmode mode)
             {
@@ -363,16 +505,46 @@ namespace std
                 return (mode & (ios_base::out | ios_base::app | ios_base::trunc)) != 0;
             }
 
-            void init_()
+            void reset_areas_()
+            {
+                this->setg(buf_, buf_, buf_);
+                this->setp(nullptr, nullptr);
+            }
+
+            /**
+             * Writes out the put area (if any) and leaves
+             * the buffer free for either reading or writing.
+             */
+            bool flush_output_()
             {
-                if (ibuf_)
-                    this->input_begin_ = this->input_next_ = this->input_end_ = ibuf_;
+                if (!this->pptr())
+                    return true;
+
+                auto count = static_cast<size_t>(this->pptr() - this->pbase());
+                auto res = fwrite(this->pbase(), sizeof(char_type), count, file_);
+
+                this->setp(nullptr, nullptr);
+                this->setg(buf_, buf_, buf_);
+
+                return res == count;
+            }
 
-                if (obuf_)
+            /**
+             * Before writing, the file position has to be moved
+             * back over the characters we have read ahead.
+             */
+            bool drop_input_()
+            {
+                if (this->read_avail_())
                 {
-                    this->output_begin_ = this->output_next_ = obuf_;
-                    this->output_end_ = obuf_ + buf_size_;
+                    auto unread = static_cast<long>(this->egptr() - this->gptr());
+                    if (fseek(file_, -unread * static_cast<long>(sizeof(char_type)), SEEK_CUR) != 0)
+                        return false;
                 }
+
+                this->setg(buf_, buf_, buf_);
+
+                return true;
             }
     };
 
@@ -439,6 +611,8 @@ namespace std
             basic_ifstream& operator=(basic_ifstream&& other)
             {
                 swap(other);
+
+                return *this;
             }
 
             void swap(basic_ifstream& rhs)
@@ -548,6 +722,8 @@ namespace std
             basic_ofstream& operator=(basic_ofstream&& other)
             {
                 swap(other);
+
+                return *this;
             }
 
             void swap(basic_ofstream& rhs)
@@ -659,6 +835,8 @@ namespace std
             basic_fstream& operator=(basic_fstream&& other)
             {
                 swap(other);
+
+                return *this;
             }
 
             void swap(basic_fstream& rhs)
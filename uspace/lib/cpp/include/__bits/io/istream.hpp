@@ -604,17 +604,10 @@ namespace std
                     return *this;
                 }
 
-                while (gcount_ < n)
-                {
-                    auto c = this->rdbuf()->sbumpc();
-                    if (traits_type::eq_int_type(c, traits_type::eof()))
-                    {
-                        this->setstate(ios_base::failbit | ios_base::eofbit);
-                        break;
-                    }
-
-                    s[gcount_++] = traits_type::to_char_type(c);
-                }
+                if (n > 0)
+                    gcount_ = this->rdbuf()->sgetn(s, n);
+                if (gcount_ < n)
+                    this->setstate(ios_base::failbit | ios_base::eofbit);
 
                 return *this;
             }
@@ -638,8 +631,7 @@ namespace std
                 } else if (avail > 0)
                 {
                     auto count = (avail < n ? avail : n);
-                    while (gcount_ < count)
-                        s[gcount_++] = traits_type::to_char_type(this->rdbuf()->sbumpc());
+                    gcount_ = this->rdbuf()->sgetn(s, count);
                 }
 
                 return gcount_;
@@ -731,7 +723,7 @@ namespace std
                 sentry sen{*this, true};
 
                 if (!this->fail())
-                    this->rdbuf()->pubseekoff(pos, ios_base::in);
+                    this->rdbuf()->pubseekpos(pos, ios_base::in);
                 else
                     this->setstate(ios_base::failbit);
 
@@ -141,7 +141,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -159,7 +159,7 @@ namespace std
                     auto basefield = (this->flags() & ios_base::basefield);
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(),
+                    >(this->locale_).put(*this, *this, this->fill(),
                                           (basefield == ios_base::oct || basefield == ios_base::hex)
                                           ? static_cast<long>(static_cast<unsigned short>(x))
                                           : static_cast<long>(x)).failed();
@@ -179,7 +179,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(),
+                    >(this->locale_).put(*this, *this, this->fill(),
                                           static_cast<unsigned long>(x)).failed();
 
                     if (failed)
@@ -198,7 +198,7 @@ namespace std
                     auto basefield = (this->flags() & ios_base::basefield);
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(),
+                    >(this->locale_).put(*this, *this, this->fill(),
                                           (basefield == ios_base::oct || basefield == ios_base::hex)
                                           ? static_cast<long>(static_cast<unsigned int>(x))
                                           : static_cast<long>(x)).failed();
@@ -218,7 +218,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(),
+                    >(this->locale_).put(*this, *this, this->fill(),
                                           static_cast<unsigned long>(x)).failed();
 
                     if (failed)
@@ -236,7 +236,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -253,7 +253,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -270,7 +270,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -287,7 +287,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -304,7 +304,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), static_cast<double>(x)).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), static_cast<double>(x)).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -321,7 +321,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -338,7 +338,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), x).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), x).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -355,7 +355,7 @@ namespace std
                 {
                     bool failed = use_facet<
                         num_put<char_type, ostreambuf_iterator<char_type, traits_type>>
-                    >(this->getloc()).put(*this, *this, this->fill(), p).failed();
+                    >(this->locale_).put(*this, *this, this->fill(), p).failed();
 
                     if (failed)
                         this->setstate(ios_base::badbit);
@@ -418,18 +418,8 @@ namespace std
             {
                 sentry sen{*this};
 
-                if (sen)
-                {
-                    for (streamsize i = 0; i < n; ++i)
-                    {
-                        auto ret = this->rdbuf()->sputc(s[i]);
-                        if (traits_type::eq_int_type(ret, traits_type::eof()))
-                        {
-                            this->setstate(ios_base::badbit);
-                            break;
-                        }
-                    }
-                }
+                if (sen && this->rdbuf()->sputn(s, n) != n)
+                    this->setstate(ios_base::badbit);
 
                 return *this;
             }
@@ -457,22 +447,27 @@ namespace std
 
             pos_type tellp()
             {
-                // TODO: implement
-                __unimplemented();
-                return pos_type{};
+                if (this->fail())
+                    return pos_type(-1);
+                else
+                    return this->rdbuf()->pubseekoff(0, ios_base::cur, ios_base::out);
             }
 
             basic_ostream<Char, Traits>& seekp(pos_type pos)
             {
-                // TODO: implement
-                __unimplemented();
+                if (!this->fail() &&
+                    this->rdbuf()->pubseekpos(pos, ios_base::out) == pos_type(off_type(-1)))
+                    this->setstate(ios_base::failbit);
+
                 return *this;
             }
 
             basic_ostream<Char, Traits>& seekp(off_type off, ios_base::seekdir dir)
             {
-                // TODO: implement
-                __unimplemented();
+                if (!this->fail() &&
+                    this->rdbuf()->pubseekoff(off, dir, ios_base::out) == pos_type(off_type(-1)))
+                    this->setstate(ios_base::failbit);
+
                 return *this;
             }
 
@@ -506,6 +501,96 @@ namespace std
     using ostream  = basic_ostream<char>;
     using wostream = basic_ostream<wchar_t>;
 
+    namespace aux
+    {
+        /**
+         * Writes count fill characters, in chunks so that
+         * padding does not go character by character.
+         */
+        template<class Char, class Traits>
+        bool pad(basic_ostream<Char, Traits>& os, size_t count)
+        {
+            constexpr size_t chunk_size{16};
+            Char chunk[chunk_size];
+            Traits::assign(chunk, min(count, chunk_size), os.fill());
+
+            while (count > 0)
+            {
+                auto n = static_cast<streamsize>(min(count, chunk_size));
+                if (os.rdbuf()->sputn(chunk, n) != n)
+                    return false;
+                count -= static_cast<size_t>(n);
+            }
+
+            return true;
+        }
+
+        template<class Char, class Traits>
+        bool write(basic_ostream<Char, Traits>& os, const Char* str, size_t len)
+        {
+            auto n = static_cast<streamsize>(len);
+
+            return os.rdbuf()->sputn(str, n) == n;
+        }
+
+        /**
+         * Narrow characters inserted into a wide stream
+         * are widened in chunks.
+         */
+        template<class Char, class Traits>
+        bool write(basic_ostream<Char, Traits>& os, const char* str, size_t len)
+        {
+            constexpr size_t chunk_size{64};
+            Char chunk[chunk_size];
+
+            while (len > 0)
+            {
+                auto n = min(len, chunk_size);
+                for (size_t i = 0; i < n; ++i)
+                    chunk[i] = os.widen(str[i]);
+
+                if (os.rdbuf()->sputn(chunk, static_cast<streamsize>(n)) != static_cast<streamsize>(n))
+                    return false;
+
+                str += n;
+                len -= n;
+            }
+
+            return true;
+        }
+
+        template<class Traits>
+        bool write(basic_ostream<char, Traits>& os, const char* str, size_t len)
+        {
+            auto n = static_cast<streamsize>(len);
+
+            return os.rdbuf()->sputn(str, n) == n;
+        }
+
+        template<class Char, class Traits, class Str>
+        basic_ostream<Char, Traits>& insert(basic_ostream<Char, Traits>& os,
+                                            const Str* str, size_t len)
+        {
+            size_t to_pad{};
+            if (os.width() > 0 && static_cast<size_t>(os.width()) > len)
+                to_pad = (static_cast<size_t>(os.width()) - len);
+
+            bool ok{true};
+            if (to_pad > 0 && (os.flags() & ios_base::adjustfield) != ios_base::left)
+                ok = pad(os, to_pad) && write(os, str, len);
+            else if (to_pad > 0)
+                ok = write(os, str, len) && pad(os, to_pad);
+            else
+                ok = write(os, str, len);
+
+            if (!ok)
+                os.setstate(ios_base::badbit);
+
+            os.width(0);
+            return os;
+        }
+    }
+
     /**
      * 27.7.6.3.4, character inserter function templates:
      */
@@ -517,27 +602,7 @@ namespace std
         typename basic_ostream<Char, Traits>::sentry sen{os};
 
         if (sen)
-        {
-            if (os.width() > 0)
-            {
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                    os.put(c);
-                }
-                else
-                {
-                    os.put(c);
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
-                os.put(c);
-
-            os.width(0);
-        }
+            aux::insert(os, &c, 1);
 
         return os;
     }
@@ -549,27 +614,8 @@ namespace std
         typename basic_ostream<Char, Traits>::sentry sen{os};
 
         if (sen)
-        {
-            if (os.width() > 0)
-            {
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                    os.put(os.widen(c));
-                }
-                else
-                {
-                    os.put(os.widen(c));
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
-                os.put(os.widen(c));
+            aux::insert(os, &c, 1);
 
-            os.width(0);
-        }
         return os;
     }
 
@@ -580,27 +626,7 @@ namespace std
         typename basic_ostream<char, Traits>::sentry sen{os};
 
         if (sen)
-        {
-            if (os.width() > 0)
-            {
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                    os.put(c);
-                }
-                else
-                {
-                    os.put(c);
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
-                os.put(c);
-
-            os.width(0);
-            }
+            aux::insert(os, &c, 1);
 
         return os;
     }
@@ -612,27 +638,7 @@ namespace std
         typename basic_ostream<char, Traits>::sentry sen{os};
 
         if (sen)
-        {
-            if (os.width() > 0)
-            {
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                    os.put(c);
-                }
-                else
-                {
-                    os.put(c);
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
-                os.put(c);
-
-            os.width(0);
-        }
+            aux::insert(os, reinterpret_cast<const char*>(&c), 1);
 
         return os;
     }
@@ -644,67 +650,11 @@ namespace std
         typename basic_ostream<char, Traits>::sentry sen{os};
 
         if (sen)
-        {
-            if (os.width() > 0)
-            {
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                    os.put(c);
-                }
-                else
-                {
-                    os.put(c);
-                    for (decltype(os.width()) i = 0; i < os.width(); ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
-                os.put(c);
-
-            os.width(0);
-        }
+            aux::insert(os, reinterpret_cast<const char*>(&c), 1);
 
         return os;
     }
 
-    namespace aux
-    {
-        template<class Char, class Traits>
-        basic_ostream<Char, Traits>& insert(basic_ostream<Char, Traits>& os,
-                                            const Char* str, size_t len)
-        {
-            if (os.width() > 0 && static_cast<size_t>(os.width()) > len)
-            {
-                size_t to_pad = (static_cast<size_t>(os.width()) - len);
-
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (size_t i = 0; i < to_pad; ++i)
-                        os.put(os.fill());
-                    for (size_t i = 0; i < len; ++i)
-                        os.put(os.widen(str[i]));
-                }
-                else
-                {
-                    for (size_t i = 0; i < len; ++i)
-                        os.put(os.widen(str[i]));
-                    for (size_t i = 0; i < to_pad; ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
-            {
-                for (size_t i = 0; i < len; ++i)
-                    os.put(os.widen(str[i]));
-            }
-
-            os.width(0);
-            return os;
-        }
-    }
-
     template<class Char, class Traits>
     basic_ostream<Char, Traits>& operator<<(basic_ostream<Char, Traits>& os,
                                             const Char* str)
@@ -753,7 +703,7 @@ namespace std
         {
             auto len = Traits::length(reinterpret_cast<const char*>(str));
 
-            return aux::insert(os, str, len);
+            return aux::insert(os, reinterpret_cast<const char*>(str), len);
         }
         else
             return os;
@@ -769,7 +719,7 @@ namespace std
         {
             auto len = Traits::length(reinterpret_cast<const char*>(str));
 
-            return aux::insert(os, str, len);
+            return aux::insert(os, reinterpret_cast<const char*>(str), len);
         }
         else
             return os;
@@ -72,9 +72,13 @@ namespace std
             basic_stringbuf(const basic_stringbuf&) = delete;
 
             basic_stringbuf(basic_stringbuf&& other)
-                : mode_{move(other.mode_)}, str_{move(other.str_)}
+                : mode_{move(other.mode_)}, str_{}
             {
+                auto old_data = other.str_.data();
+                str_ = move(other.str_);
+
                 basic_streambuf<char_type, traits_type>::swap(other);
+                rebase_(old_data);
             }
 
             /**
@@ -90,10 +94,15 @@ namespace std
 
             void swap(basic_stringbuf& rhs)
             {
+                auto old_data = str_.data();
+                auto rhs_old_data = rhs.str_.data();
+
                 std::swap(mode_, rhs.mode_);
                 std::swap(str_, rhs.str_);
 
                 basic_streambuf<char_type, traits_type>::swap(rhs);
+                rebase_(rhs_old_data);
+                rhs.rebase_(old_data);
             }
 
             /**
@@ -104,7 +113,8 @@ namespace std
             {
                 if (mode_ & ios_base::out)
                     return basic_string<char_type, traits_type, allocator_type>{
-                        this->output_begin_, this->output_next_ - 1, str_.get_allocator()
+                        this->output_begin_, this->output_begin_ + written_size_(),
+                        str_.get_allocator()
                     };
                 else if (mode_ == ios_base::in)
                     return basic_string<char_type, traits_type, allocator_type>{
@@ -129,8 +139,21 @@ namespace std
             {
                 if (this->read_avail_())
                     return traits_type::to_int_type(*this->gptr());
-                else
-                    return traits_type::eof();
+
+                /**
+                 * Characters written since the last read
+                 * become readable.
+                 */
+                if ((mode_ & ios_base::out) != 0 && this->input_next_)
+                {
+                    sync_size_();
+                    this->input_end_ = str_.begin() + str_.size();
+
+                    if (this->read_avail_())
+                        return traits_type::to_int_type(*this->gptr());
+                }
+
+                return traits_type::eof();
             }
 
             int_type pbackfail(int_type c = traits_type::eof()) override
@@ -163,26 +186,33 @@ namespace std
 
             int_type overflow(int_type c = traits_type::eof()) override
             {
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                    return traits_type::not_eof(c);
+
                 if ((mode_ & ios_base::out) == 0)
                     return traits_type::eof();
 
-                if (!traits_type::eq_int_type(c, traits_type::eof()))
-                {
-                    if (this->output_next_ < this->output_end_)
-                        return c;
+                if (!this->write_avail_())
+                    grow_(1);
 
-                    auto size = static_cast<size_t>(this->output_next_ - this->output_begin_);
-                    str_.size_ = size;
+                *this->output_next_++ = traits_type::to_char_type(c);
 
-                    str_.push_back(traits_type::to_char_type(c));
-                    init_();
+                return c;
+            }
 
-                    return c;
-                }
-                else if (traits_type::eq_int_type(c, traits_type::eof()))
-                    return traits_type::not_eof(c);
+            streamsize xsputn(const char_type* s, streamsize n) override
+            {
+                if ((mode_ & ios_base::out) == 0 || !s || n <= 0)
+                    return 0;
 
-                return traits_type::eof();
+                auto count = static_cast<size_t>(n);
+                if (static_cast<size_t>(this->output_end_ - this->output_next_) < count)
+                    grow_(count);
+
+                traits_type::copy(this->output_next_, s, count);
+                this->output_next_ += count;
+
+                return n;
             }
 
             basic_streambuf<char_type, traits_type>* setbuf(char_type* str, streamsize n) override
@@ -198,29 +228,29 @@ namespace std
             pos_type seekoff(off_type off, ios_base::seekdir dir,
                              ios_base::openmode mode = ios_base::in | ios_base::out)
             {
-                if ((mode & ios_base::in) == ios_base::in)
-                {
-                    if (!this->input_next_)
-                        return pos_type(off_type(-1));
+                sync_size_();
+                auto end = str_.begin() + str_.size();
+                if ((mode_ & ios_base::in) != 0)
+                    this->input_end_ = end;
 
-                    return seekoff_(off, this->input_begin_, this->input_next_, this->input_end_, dir);
-                }
-                else if ((mode & ios_base::out) == ios_base::out)
-                {
-                    if (!this->output_next_)
-                        return pos_type(off_type(-1));
+                auto in = (mode & ios_base::in) != 0 && (mode_ & ios_base::in) != 0;
+                auto out = (mode & ios_base::out) != 0 && (mode_ & ios_base::out) != 0;
 
-                    return seekoff_(off, this->output_begin_, this->output_next_, this->output_end_, dir);
-                }
-                else if ((mode & (ios_base::in | ios_base::out)) == (ios_base::in | ios_base::out) &&
-                          (dir == ios_base::beg || dir == ios_base::end))
+                if (in && out)
                 {
-                    if (!this->input_next_ || !this->output_next_)
+                    if (dir == ios_base::cur)
                         return pos_type(off_type(-1));
 
-                    seekoff_(off, this->input_begin_, this->input_next_, this->input_end_, dir);
-                    return seekoff_(off, this->output_begin_, this->output_next_, this->output_end_, dir);
+                    auto res = seekoff_(off, this->input_begin_, this->input_next_, end, dir);
+                    if (off_type(res) == off_type(-1))
+                        return res;
+
+                    return seekoff_(off, this->output_begin_, this->output_next_, end, dir);
                 }
+                else if (in)
+                    return seekoff_(off, this->input_begin_, this->input_next_, end, dir);
+                else if (out)
+                    return seekoff_(off, this->output_begin_, this->output_next_, end, dir);
 
                 return pos_type(off_type(-1));
             }
@@ -244,18 +274,90 @@ namespace std
 
                 if ((mode_ & ios_base::out) != 0)
                 {
+                    /**
+                     * The put area spans the whole capacity of str_
+                     * so that most writes are plain copies, the
+                     * logical size is only updated when needed.
+                     */
                     this->output_begin_ = str_.begin();
-                    this->output_next_ = str_.end();
-                    this->output_end_ = str_.begin() + str_.size() + 1;
+                    this->output_end_ = str_.begin() + str_.capacity() - 1;
+
+                    if ((mode_ & (ios_base::app | ios_base::ate)) != 0)
+                        this->output_next_ = str_.end();
+                    else
+                        this->output_next_ = str_.begin();
+                }
+            }
+
+            size_t written_size_() const
+            {
+                auto written = static_cast<size_t>(this->output_next_ - this->output_begin_);
+
+                return max(written, str_.size());
+            }
+
+            void sync_size_()
+            {
+                if ((mode_ & ios_base::out) == 0)
+                    return;
+
+                auto size = written_size_();
+                if (size != str_.size())
+                {
+                    str_.size_ = size;
+                    str_.ensure_null_terminator_();
                 }
             }
 
-            bool ensure_free_space_(size_t n = 1)
+            /**
+             * Makes room for at least n more characters after
+             * the put pointer, keeps all positions intact.
+             */
+            void grow_(size_t n)
+            {
+                sync_size_();
+
+                auto data = str_.begin();
+                auto gnext = this->input_next_ - data;
+                auto gend = this->input_end_ - data;
+                auto pnext = this->output_next_ - data;
+
+                auto needed = static_cast<size_t>(pnext) + n;
+                if (needed > str_.size())
+                    str_.ensure_free_space_(needed - str_.size());
+
+                data = str_.begin();
+                if ((mode_ & ios_base::in) != 0)
+                {
+                    this->input_begin_ = data;
+                    this->input_next_ = data + gnext;
+                    this->input_end_ = data + gend;
+                }
+
+                this->output_begin_ = data;
+                this->output_next_ = data + pnext;
+                this->output_end_ = data + str_.capacity() - 1;
+            }
+
+            /**
+             * Short strings keep their characters inline, so
+             * moving str_ can relocate the buffer the stream
+             * pointers point to.
+             */
+            void rebase_(const char_type* old_data)
             {
-                str_.ensure_free_space_(n);
-                this->output_end_ = str_.begin() + str_.capacity();
+                auto data = str_.begin();
+                auto rebase = [data, old_data](char_type*& ptr){
+                    if (ptr)
+                        ptr = data + (ptr - old_data);
+                };
 
-                return true;
+                rebase(this->input_begin_);
+                rebase(this->input_next_);
+                rebase(this->input_end_);
+                rebase(this->output_begin_);
+                rebase(this->output_next_);
+                rebase(this->output_end_);
             }
 
             pos_type seekoff_(off_type off, char_type* begin, char_type*& next, char_type* end,
@@ -270,12 +372,12 @@ namespace std
                 else if (dir == ios_base::end)
                     new_off = static_cast<off_type>(end - begin);
 
-                if (new_off + off < 0 || begin + new_off + off >= end)
+                if (new_off + off < 0 || begin + new_off + off > end)
                     return pos_type(off_type(-1));
                 else
                     next = begin + new_off + off;
 
-                return pos_type(new_off);
+                return pos_type(new_off + off);
             }
     };
 
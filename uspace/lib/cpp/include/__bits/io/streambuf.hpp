@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_IO_STREAMBUF
 #define LIBCPP_BITS_IO_STREAMBUF
 
+#include <algorithm>
 #include <ios>
 #include <iosfwd>
 #include <locale>
@@ -214,15 +215,15 @@ namespace std
 
             void swap(basic_streambuf& rhs)
             {
-                swap(input_begin_, rhs.input_begin_);
-                swap(input_next_, rhs.input_next_);
-                swap(input_end_, rhs.input_end_);
+                std::swap(input_begin_, rhs.input_begin_);
+                std::swap(input_next_, rhs.input_next_);
+                std::swap(input_end_, rhs.input_end_);
 
-                swap(output_begin_, rhs.output_begin_);
-                swap(output_next_, rhs.output_next_);
-                swap(output_end_, rhs.output_end_);
+                std::swap(output_begin_, rhs.output_begin_);
+                std::swap(output_next_, rhs.output_next_);
+                std::swap(output_end_, rhs.output_end_);
 
-                swap(locale_, rhs.locale_);
+                std::swap(locale_, rhs.locale_);
             }
 
             /**
@@ -335,14 +336,29 @@ namespace std
                 if (!s || n == 0)
                     return 0;
 
+                /**
+                 * Whatever is already in the get area is copied
+                 * in bulk, uflow only refills it when empty.
+                 */
                 streamsize i{0};
                 auto eof = traits_type::eof();
-                for (; i <= n; ++i)
+                while (i < n)
                 {
-                    if (!read_avail_() && traits_type::eq_int_type(uflow(), eof))
-                        break;
-
-                    *s++ = *input_next_++;
+                    if (read_avail_())
+                    {
+                        auto count = min(static_cast<streamsize>(input_end_ - input_next_), n - i);
+                        traits_type::copy(s + i, input_next_, static_cast<size_t>(count));
+                        input_next_ += count;
+                        i += count;
+                    }
+                    else
+                    {
+                        auto c = uflow();
+                        if (traits_type::eq_int_type(c, eof))
+                            break;
+
+                        s[i++] = traits_type::to_char_type(c);
+                    }
                 }
 
                 return i;
@@ -381,12 +397,22 @@ namespace std
                     return 0;
 
                 streamsize i{0};
-                for (; i <= n; ++i)
+                auto eof = traits_type::eof();
+                while (i < n)
                 {
-                    if (!write_avail_() && traits_type::eq_int_type(overflow(), traits_type::eof()))
-                        break;
-
-                    *output_next_++ = *s++;
+                    if (write_avail_())
+                    {
+                        auto count = min(static_cast<streamsize>(output_end_ - output_next_), n - i);
+                        traits_type::copy(output_next_, s + i, static_cast<size_t>(count));
+                        output_next_ += count;
+                        i += count;
+                    }
+                    else
+                    {
+                        if (traits_type::eq_int_type(overflow(traits_type::to_int_type(s[i])), eof))
+                            break;
+                        ++i;
+                    }
                 }
 
                 return i;
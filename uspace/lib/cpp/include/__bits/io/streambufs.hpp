@@ -29,24 +29,67 @@
 #ifndef LIBCPP_BITS_IO_STREAMBUFS
 #define LIBCPP_BITS_IO_STREAMBUFS
 
-#include <iosfwd>
+#include <cstdint>
 #include <cstdio>
+#include <iosfwd>
 #include <streambuf>
 
 namespace std::aux
 {
+    /**
+     * Connection of a standard stream to its C stream.
+     * While synchronized with stdio, all transfers go
+     * through the FILE so that C and C++ output can be
+     * freely interleaved, otherwise the underlying file
+     * descriptor is accessed directly by vfs_read and
+     * vfs_write (streams without a descriptor, like the
+     * kernel console, fall back to stdio).
+     */
+    class stdio_channel
+    {
+        public:
+            explicit stdio_channel(FILE* file);
+
+            void set_synced(bool synced);
+
+            bool synced() const
+            {
+                return synced_;
+            }
+
+            size_t read(void* data, size_t size);
+            size_t write(const void* data, size_t size);
+            bool flush();
+
+        private:
+            FILE* file_;
+            int fd_;
+            uint64_t pos_;
+            bool synced_;
+    };
+
     template<class Char, class Traits = char_traits<Char>>
     class stdin_streambuf : public basic_streambuf<Char, Traits>
     {
         public:
             stdin_streambuf()
-                : basic_streambuf<Char, Traits>{}, buffer_{nullptr}
-            { /* DUMMY BODY */ }
+                : basic_streambuf<Char, Traits>{}, channel_{stdin}
+            {
+                set_synced(true);
+            }
 
             virtual ~stdin_streambuf()
+            { /* DUMMY BODY */ }
+
+            /**
+             * Unread characters stay in the buffer, only the
+             * size of subsequent reads changes.
+             */
+            void set_synced(bool synced)
             {
-                if (buffer_)
-                    delete[] buffer_;
+                channel_.set_synced(synced);
+                if (!this->gptr())
+                    this->setg(buffer_, buffer_ + putback_size_, buffer_ + putback_size_);
             }
 
         protected:
@@ -55,59 +98,29 @@ namespace std::aux
             using int_type    = typename traits_type::int_type;
             using off_type    = typename traits_type::off_type;
 
-            using basic_streambuf<Char, Traits>::input_begin_;
-            using basic_streambuf<Char, Traits>::input_next_;
-            using basic_streambuf<Char, Traits>::input_end_;
-
             int_type underflow() override
             {
-                if (!this->gptr())
-                {
-                    buffer_ = new char_type[buf_size_];
-                    input_begin_ = input_next_ = input_end_ = buffer_;
-                }
-
-                off_type i{};
-                if (input_next_ < input_end_)
-                {
-                    auto idx = static_cast<off_type>(input_next_ - input_begin_);
-                    auto count = buf_size_ - idx;
+                if (this->read_avail_())
+                    return traits_type::to_int_type(*this->gptr());
 
-                    for (; i < count; ++i, ++idx)
-                        buffer_[i] = buffer_[idx];
-                }
-
-                for (; i < buf_size_; ++i)
-                {
-                    auto c = fgetc(in_);
-                    putchar(c); // TODO: Temporary source of feedback.
-                    if (c == traits_type::eof())
-                        break;
+                /**
+                 * Keep the last few characters in front of the
+                 * get area so that they can be put back.
+                 */
+                auto keep = min(static_cast<size_t>(this->gptr() - this->eback()), putback_size_);
+                traits_type::move(buffer_ + putback_size_ - keep, this->gptr() - keep, keep);
 
-                    buffer_[i] = static_cast<char_type>(c);
+                auto count = fill_(buffer_ + putback_size_, buf_size_ - putback_size_);
+                this->setg(buffer_ + putback_size_ - keep, buffer_ + putback_size_,
+                           buffer_ + putback_size_ + count);
 
-                    if (buffer_[i] == '\n')
-                    {
-                        ++i;
-                        break;
-                    }
-                }
-
-                input_next_ = input_begin_;
-                input_end_ = input_begin_ + i;
-
-                if (i == 0)
+                if (count == 0)
                     return traits_type::eof();
 
-                return traits_type::to_int_type(*input_next_);
-            }
+                // TODO: Temporary source of feedback.
+                fwrite(this->gptr(), sizeof(char_type), count, stdout);
 
-            int_type uflow() override
-            {
-                auto res = underflow();
-                ++input_next_;
-
-                return res;
+                return traits_type::to_int_type(*this->gptr());
             }
 
             void imbue(const locale& loc)
@@ -116,23 +129,63 @@ namespace std::aux
             }
 
         private:
-            FILE* in_{stdin};
+            static constexpr size_t putback_size_{8};
+            static constexpr size_t buf_size_{4096};
+
+            stdio_channel channel_;
+
+            char_type buffer_[buf_size_];
+
+            size_t fill_(char_type* dst, size_t size)
+            {
+                /**
+                 * When synchronized, characters are read one by
+                 * one, otherwise scanf and friends would miss
+                 * the input we read ahead.
+                 */
+                if (channel_.synced())
+                {
+                    auto c = fgetc(stdin);
+                    if (c == EOF)
+                        return 0;
 
-            char_type* buffer_;
+                    *dst = static_cast<char_type>(c);
 
-            static constexpr off_type buf_size_{128};
+                    return 1;
+                }
+
+                return channel_.read(dst, size * sizeof(char_type)) / sizeof(char_type);
+            }
     };
 
     template<class Char, class Traits = char_traits<Char>>
     class stdout_streambuf: public basic_streambuf<Char, Traits>
     {
         public:
-            stdout_streambuf()
-                : basic_streambuf<Char, Traits>{}
+            explicit stdout_streambuf(FILE* out = stdout)
+                : basic_streambuf<Char, Traits>{}, channel_{out}
             { /* DUMMY BODY */ }
 
             virtual ~stdout_streambuf()
-            { /* DUMMY BODY */ }
+            {
+                flush_();
+            }
+
+            /**
+             * While synchronized there is no put area, so every
+             * output operation goes straight to the FILE and
+             * is ordered with printf and friends.
+             */
+            void set_synced(bool synced)
+            {
+                flush_();
+                channel_.set_synced(synced);
+
+                if (synced)
+                    this->setp(nullptr, nullptr);
+                else
+                    this->setp(buffer_, buffer_ + buf_size_);
+            }
 
         protected:
             using traits_type = Traits;
@@ -142,29 +195,85 @@ namespace std::aux
 
             int_type overflow(int_type c = traits_type::eof()) override
             {
-                if (!traits_type::eq_int_type(c, traits_type::eof()))
-                {
-                    auto cc = traits_type::to_char_type(c);
-                    fwrite(&cc, sizeof(char_type), 1, out_);
-                }
+                if (!flush_())
+                    return traits_type::eof();
 
-                return traits_type::not_eof(c);
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                    return traits_type::not_eof(c);
+
+                auto cc = traits_type::to_char_type(c);
+                if (this->pptr())
+                    *this->output_next_++ = cc;
+                else if (channel_.write(&cc, sizeof(char_type)) != sizeof(char_type))
+                    return traits_type::eof();
+
+                return c;
             }
 
             streamsize xsputn(const char_type* s, streamsize n) override
             {
-                return fwrite(s, sizeof(char_type), n, out_);
+                if (!s || n <= 0)
+                    return 0;
+
+                auto count = static_cast<size_t>(n);
+                if (this->pptr())
+                {
+                    auto avail = static_cast<size_t>(this->epptr() - this->pptr());
+                    if (count <= avail)
+                    {
+                        traits_type::copy(this->output_next_, s, count);
+                        this->output_next_ += count;
+
+                        return n;
+                    }
+
+                    if (!flush_())
+                        return 0;
+
+                    if (count < buf_size_)
+                    {
+                        traits_type::copy(this->output_next_, s, count);
+                        this->output_next_ += count;
+
+                        return n;
+                    }
+                }
+
+                /**
+                 * Large blocks (and everything while synced)
+                 * are written without copying them.
+                 */
+                auto res = channel_.write(s, count * sizeof(char_type));
+
+                return static_cast<streamsize>(res / sizeof(char_type));
             }
 
             int sync() override
             {
-                if (fflush(out_))
+                if (!flush_())
                     return -1;
-                return 0;
+
+                return channel_.flush() ? 0 : -1;
             }
 
         private:
-            FILE* out_{stdout};
+            static constexpr size_t buf_size_{4096};
+
+            stdio_channel channel_;
+
+            char_type buffer_[buf_size_];
+
+            bool flush_()
+            {
+                if (!this->pptr() || this->pptr() == this->pbase())
+                    return true;
+
+                auto size = static_cast<size_t>(this->pptr() - this->pbase()) * sizeof(char_type);
+                auto res = channel_.write(this->pbase(), size);
+                this->setp(buffer_, buffer_ + buf_size_);
+
+                return res == size;
+            }
     };
 }
 
@@ -962,6 +962,11 @@ namespace std
         return !lhs.equal(rhs);
     }
 
+    namespace aux
+    {
+        struct ostreambuf_iterator_access;
+    }
+
     /**
      * 24.6.4, class template ostreambuf_iterator:
      */
@@ -1016,8 +1021,47 @@ namespace std
             streambuf_type* sbuf_;
 
             bool failed_{false};
+
+            friend struct aux::ostreambuf_iterator_access;
     };
 
+    namespace aux
+    {
+        struct ostreambuf_iterator_access
+        {
+            template<class Char, class Traits>
+            static void write(ostreambuf_iterator<Char, Traits>& it,
+                              const Char* s, size_t n)
+            {
+                if (!it.failed_ && static_cast<size_t>(it.sbuf_->sputn(s, n)) != n)
+                    it.failed_ = true;
+            }
+        };
+
+        /**
+         * Writes a block of characters through an output iterator,
+         * used by the facets so that ostreambuf_iterator can hand
+         * the whole block to the stream buffer at once.
+         */
+        template<class OutputIterator, class Char>
+        OutputIterator put_chars(OutputIterator it, const Char* s, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+                *it++ = s[i];
+
+            return it;
+        }
+
+        template<class Char, class Traits>
+        ostreambuf_iterator<Char, Traits> put_chars(ostreambuf_iterator<Char, Traits> it,
+                                                    const Char* s, size_t n)
+        {
+            ostreambuf_iterator_access::write(it, s, n);
+
+            return it;
+        }
+    }
+
     /**
      * 24.7, range access:
      */
@@ -96,16 +96,14 @@ namespace std
         protected:
             iter_type do_put(iter_type it, ios_base& base, char_type fill, bool v) const
             {
-                auto loc = base.getloc();
-
                 if ((base.flags() & ios_base::boolalpha) == 0)
                     return do_put(it, base, fill, (long)v);
                 else
                 {
-                    auto s = v ? use_facet<numpunct<char_type>>(loc).truename()
-                               : use_facet<numpunct<char_type>>(loc).falsename();
-                    for (auto c: s)
-                        *it++ = c;
+                    auto punct = use_facet<numpunct<char_type>>(base.locale_);
+                    auto s = v ? punct.truename() : punct.falsename();
+
+                    it = aux::put_chars(it, s.c_str(), s.size());
                 }
 
                 return it;
@@ -247,8 +245,20 @@ namespace std
             }
 
         private:
-            iter_type put_adjusted_buffer_(iter_type it, ios_base& base, char_type fill, size_t size) const
+            /**
+             * The formatted number is widened into a local array
+             * and emitted as a single block, so that a stream
+             * buffer receives one sputn per number.
+             */
+            iter_type put_adjusted_buffer_(iter_type it, ios_base& base, char_type fill, int ret) const
             {
+                size_t size{};
+                if (ret > 0)
+                    size = min(static_cast<size_t>(ret), ios_base::buffer_size_ - 1);
+
+                char_type buffer[ios_base::buffer_size_];
+                widen_buffer_(base, buffer, size);
+
                 auto adjustfield = (base.flags() & ios_base::adjustfield);
 
                 size_t to_fill{};
@@ -256,54 +266,71 @@ namespace std
 
                 if (base.width() > 0 && size < width)
                     to_fill = width - size;
+                base.width(0);
 
-                if (to_fill > 0)
+                if (to_fill == 0)
+                    return aux::put_chars(it, buffer, size);
+
+                if (adjustfield == ios_base::left)
                 {
-                    if (adjustfield == ios_base::left)
-                    {
-                        it = put_buffer_(it, base, fill, 0, size);
-                        for (size_t i = 0; i < to_fill; ++i)
-                            *it++ = fill;
-                    }
-                    else if (adjustfield == ios_base::right)
-                    {
-                        for (size_t i = 0; i < to_fill; ++i)
-                            *it++ = fill;
-                        it = put_buffer_(it, base, fill, 0, size);
-                    }
-                    else if (adjustfield == ios_base::internal)
-                    {
-                        // TODO: pad after - or 0x/0X
-                    }
-                    else
-                    {
-                        for (size_t i = 0; i < to_fill; ++i)
-                            *it++ = fill;
-                        it = put_buffer_(it, base, fill, 0, size);
-                    }
+                    it = aux::put_chars(it, buffer, size);
+                    it = put_fill_(it, fill, to_fill);
+                }
+                else if (adjustfield == ios_base::internal)
+                {
+                    /**
+                     * Padding goes after the sign and the base prefix.
+                     */
+                    size_t prefix{};
+                    if (size > 0 && (base.buffer_[0] == '-' || base.buffer_[0] == '+'))
+                        ++prefix;
+                    if (size >= prefix + 2 && base.buffer_[prefix] == '0' &&
+                        (base.buffer_[prefix + 1] == 'x' || base.buffer_[prefix + 1] == 'X'))
+                        prefix += 2;
+
+                    it = aux::put_chars(it, buffer, prefix);
+                    it = put_fill_(it, fill, to_fill);
+                    it = aux::put_chars(it, buffer + prefix, size - prefix);
                 }
                 else
-                    it = put_buffer_(it, base, fill, 0, size);
-                base.width(0);
+                {
+                    it = put_fill_(it, fill, to_fill);
+                    it = aux::put_chars(it, buffer, size);
+                }
 
                 return it;
             }
 
-            iter_type put_buffer_(iter_type it, ios_base& base, char_type fill, size_t start, size_t size) const
+            void widen_buffer_(ios_base& base, char_type* buffer, size_t size) const
             {
-                const auto& loc = base.getloc();
-                const auto& ct = use_facet<ctype<char_type>>(loc);
-                const auto& punct = use_facet<numpunct<char_type>>(loc);
+                auto ct = use_facet<ctype<char_type>>(base.locale_);
+                auto punct = use_facet<numpunct<char_type>>(base.locale_);
+                auto decimal_point = punct.decimal_point();
 
-                for (size_t i = start; i < size; ++i)
+                for (size_t i = 0; i < size; ++i)
                 {
                     if (base.buffer_[i] == '.')
-                        *it++ = punct.decimal_point();
+                        buffer[i] = decimal_point;
                     else
-                        *it++ = ct.widen(base.buffer_[i]);
+                        buffer[i] = ct.widen(base.buffer_[i]);
                     // TODO: Should do grouping & thousands_sep, but that's a low
                     //       priority for now.
                 }
+            }
+
+            iter_type put_fill_(iter_type it, char_type fill, size_t count) const
+            {
+                constexpr size_t chunk_size{16};
+                char_type chunk[chunk_size];
+                for (size_t i = 0; i < min(count, chunk_size); ++i)
+                    chunk[i] = fill;
+
+                while (count > 0)
+                {
+                    auto n = min(count, chunk_size);
+                    it = aux::put_chars(it, chunk, n);
+                    count -= n;
+                }
 
                 return it;
             }
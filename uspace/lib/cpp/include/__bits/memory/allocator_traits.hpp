@@ -53,15 +53,23 @@ namespace std
         struct has_allocator_type<T, void_t<typename T::allocator_type>>
             : true_type
         { /* DUMMY BODY */ };
+
+        /**
+         * Note: T::allocator_type must not be named unless
+         *       it exists, hence the extra level.
+         */
+        template<class T, class Alloc, bool = has_allocator_type<T>::value>
+        struct uses_allocator: false_type
+        { /* DUMMY BODY */ };
+
+        template<class T, class Alloc>
+        struct uses_allocator<T, Alloc, true>
+            : value_is<bool, is_convertible_v<Alloc, typename T::allocator_type>>
+        { /* DUMMY BODY */ };
     }
 
     template<class T, class Alloc>
-    struct uses_allocator
-        : aux::value_is<
-        bool, aux::has_allocator_type<T>::value && is_convertible_v<
-            Alloc, typename T::allocator_type
-        >
-    >
+    struct uses_allocator: aux::uses_allocator<T, Alloc>
     { /* DUMMY BODY */ };
 
     /**
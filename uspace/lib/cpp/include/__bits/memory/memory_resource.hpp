@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_MEMORY_MEMORY_RESOURCE
+#define LIBCPP_BITS_MEMORY_MEMORY_RESOURCE
+
+#include <__bits/memory/allocator_arg.hpp>
+#include <__bits/memory/allocator_traits.hpp>
+#include <__bits/memory/memory_resource_fwd.hpp>
+#include <__bits/thread/threading.hpp>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace std::pmr
+{
+    /**
+     * 23.12.2, class memory_resource:
+     */
+
+    class memory_resource
+    {
+        public:
+            virtual ~memory_resource();
+
+            void* allocate(size_t bytes, size_t alignment = max_align_)
+            {
+                return do_allocate(bytes, alignment);
+            }
+
+            void deallocate(void* ptr, size_t bytes, size_t alignment = max_align_)
+            {
+                do_deallocate(ptr, bytes, alignment);
+            }
+
+            bool is_equal(const memory_resource& other) const noexcept
+            {
+                return do_is_equal(other);
+            }
+
+        private:
+            static constexpr size_t max_align_{alignof(max_align_t)};
+
+            virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+
+            virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) = 0;
+
+            virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+    };
+
+    inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept
+    {
+        return &lhs == &rhs || lhs.is_equal(rhs);
+    }
+
+    inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /**
+     * 23.12.4, access to program-wide memory_resource objects:
+     */
+
+    memory_resource* new_delete_resource() noexcept;
+
+    memory_resource* null_memory_resource() noexcept;
+
+    memory_resource* set_default_resource(memory_resource* res) noexcept;
+
+    memory_resource* get_default_resource() noexcept;
+
+    /**
+     * 23.12.3, class template polymorphic_allocator:
+     */
+
+    template<class T>
+    class polymorphic_allocator
+    {
+        public:
+            using value_type = T;
+
+            polymorphic_allocator() noexcept
+                : resource_{get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator(memory_resource* resource)
+                : resource_{resource}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator(const polymorphic_allocator& other) = default;
+
+            template<class U>
+            polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+                : resource_{other.resource()}
+            { /* DUMMY BODY */ }
+
+            polymorphic_allocator& operator=(const polymorphic_allocator&) = delete;
+
+            T* allocate(size_t n)
+            {
+                return static_cast<T*>(
+                    resource_->allocate(n * sizeof(T), alignof(T))
+                );
+            }
+
+            void deallocate(T* ptr, size_t n)
+            {
+                resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+            }
+
+            /**
+             * Note: Construction follows the uses-allocator
+             *       protocol, so that elements that are themselves
+             *       allocator aware (e.g. pmr::string in a pmr::vector)
+             *       allocate from the same resource as their container.
+             */
+            template<class U, class... Args>
+            void construct(U* ptr, Args&&... args)
+            {
+                auto place = static_cast<void*>(ptr);
+
+                if constexpr (!uses_allocator<U, polymorphic_allocator>::value)
+                    ::new(place) U(forward<Args>(args)...);
+                else if constexpr (is_constructible_v<U, allocator_arg_t,
+                                   const polymorphic_allocator&, Args...>)
+                    ::new(place) U(allocator_arg, *this, forward<Args>(args)...);
+                else
+                    ::new(place) U(forward<Args>(args)..., *this);
+            }
+
+            template<class U>
+            void destroy(U* ptr)
+            {
+                ptr->~U();
+            }
+
+            polymorphic_allocator select_on_container_copy_construction() const
+            {
+                return polymorphic_allocator{};
+            }
+
+            memory_resource* resource() const
+            {
+                return resource_;
+            }
+
+        private:
+            memory_resource* resource_;
+    };
+
+    template<class T1, class T2>
+    bool operator==(const polymorphic_allocator<T1>& lhs,
+                    const polymorphic_allocator<T2>& rhs) noexcept
+    {
+        return *lhs.resource() == *rhs.resource();
+    }
+
+    template<class T1, class T2>
+    bool operator!=(const polymorphic_allocator<T1>& lhs,
+                    const polymorphic_allocator<T2>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    /**
+     * 23.12.5, pool resource classes:
+     */
+
+    struct pool_options
+    {
+        size_t max_blocks_per_chunk{};
+        size_t largest_required_pool_block{};
+    };
+
+    class unsynchronized_pool_resource: public memory_resource
+    {
+        public:
+            unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream);
+
+            unsynchronized_pool_resource()
+                : unsynchronized_pool_resource{pool_options{}, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit unsynchronized_pool_resource(memory_resource* upstream)
+                : unsynchronized_pool_resource{pool_options{}, upstream}
+            { /* DUMMY BODY */ }
+
+            explicit unsynchronized_pool_resource(const pool_options& opts)
+                : unsynchronized_pool_resource{opts, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+            unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+            virtual ~unsynchronized_pool_resource();
+
+            void release();
+
+            memory_resource* upstream_resource() const;
+
+            pool_options options() const;
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+            bool do_is_equal(const memory_resource& other) const noexcept override;
+
+        private:
+            /**
+             * Each pool hands out blocks of a single power
+             * of two size. Blocks are carved out of chunks
+             * requested from the upstream resource, the
+             * number of blocks per chunk doubles (up to
+             * max_blocks_per_chunk) every time a pool runs
+             * out of free blocks.
+             */
+            struct chunk_header
+            {
+                chunk_header* next;
+                size_t size;
+            };
+
+            struct free_block
+            {
+                free_block* next;
+            };
+
+            struct pool
+            {
+                size_t block_size;
+                size_t next_block_count;
+                free_block* free;
+                chunk_header* chunks;
+            };
+
+            /**
+             * Requests that do not fit into any pool (or need an
+             * alignment stricter than max_align_t) go directly to
+             * the upstream resource, but we keep them in a list so
+             * that release() can return them.
+             */
+            struct large_header
+            {
+                large_header* next;
+                large_header* prev;
+                size_t size;
+                size_t alignment;
+            };
+
+            static constexpr size_t min_block_size_{sizeof(void*)};
+            static constexpr size_t max_pool_count_{14};
+            static constexpr size_t default_blocks_per_chunk_{1024};
+            static constexpr size_t default_largest_block_{4096};
+            static constexpr size_t initial_blocks_per_chunk_{8};
+
+            memory_resource* upstream_;
+            pool_options options_;
+            pool pools_[max_pool_count_];
+            size_t pool_count_;
+            large_header* large_;
+
+            pool* pool_for_(size_t bytes, size_t alignment);
+            void refill_(pool& p);
+            void* allocate_large_(size_t bytes, size_t alignment);
+            void deallocate_large_(void* ptr, size_t bytes, size_t alignment);
+    };
+
+    class synchronized_pool_resource: public memory_resource
+    {
+        public:
+            synchronized_pool_resource(const pool_options& opts, memory_resource* upstream);
+
+            synchronized_pool_resource()
+                : synchronized_pool_resource{pool_options{}, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit synchronized_pool_resource(memory_resource* upstream)
+                : synchronized_pool_resource{pool_options{}, upstream}
+            { /* DUMMY BODY */ }
+
+            explicit synchronized_pool_resource(const pool_options& opts)
+                : synchronized_pool_resource{opts, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            synchronized_pool_resource(const synchronized_pool_resource&) = delete;
+            synchronized_pool_resource& operator=(const synchronized_pool_resource&) = delete;
+
+            virtual ~synchronized_pool_resource();
+
+            void release();
+
+            memory_resource* upstream_resource() const;
+
+            pool_options options() const;
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+            bool do_is_equal(const memory_resource& other) const noexcept override;
+
+        private:
+            /**
+             * Note: The pools themselves are not shared between
+             *       fibrils in any clever way, we simply serialize
+             *       all access with a mutex provided by the
+             *       threading policy.
+             */
+            unsynchronized_pool_resource pools_;
+            aux::mutex_t mtx_;
+    };
+
+    /**
+     * 23.12.6, class monotonic_buffer_resource:
+     */
+
+    class monotonic_buffer_resource: public memory_resource
+    {
+        public:
+            explicit monotonic_buffer_resource(memory_resource* upstream);
+
+            monotonic_buffer_resource(size_t initial_size, memory_resource* upstream);
+
+            monotonic_buffer_resource(void* buffer, size_t buffer_size,
+                                      memory_resource* upstream);
+
+            monotonic_buffer_resource()
+                : monotonic_buffer_resource{get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            explicit monotonic_buffer_resource(size_t initial_size)
+                : monotonic_buffer_resource{initial_size, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            monotonic_buffer_resource(void* buffer, size_t buffer_size)
+                : monotonic_buffer_resource{buffer, buffer_size, get_default_resource()}
+            { /* DUMMY BODY */ }
+
+            monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+            monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+            virtual ~monotonic_buffer_resource();
+
+            void release();
+
+            memory_resource* upstream_resource() const;
+
+        protected:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+            bool do_is_equal(const memory_resource& other) const noexcept override;
+
+        private:
+            /**
+             * Chunks obtained from upstream are chained
+             * through a header at their beginning so that
+             * release() can give them back.
+             */
+            struct chunk_header
+            {
+                chunk_header* next;
+                size_t size;
+                size_t alignment;
+            };
+
+            static constexpr size_t default_initial_size_{128 * sizeof(void*)};
+
+            memory_resource* upstream_;
+            void* initial_buffer_;
+            size_t initial_size_;
+            char* current_;
+            size_t space_;
+            size_t next_size_;
+            chunk_header* chunks_;
+
+            void new_chunk_(size_t bytes, size_t alignment);
+    };
+}
+
+#endif
@@ -104,17 +104,22 @@ namespace std::aux
 
             void destroy() override
             {
-                if (this->refs() == 0)
+                /**
+                 * Called by the shared_ptr that dropped the
+                 * last strong reference, so no other shared_ptr
+                 * can access data_ anymore. Weak pointers keep
+                 * the payload alive until the last of them
+                 * (including the one added for the strong
+                 * references) is gone.
+                 */
+                if (data_)
                 {
-                    if (data_)
-                    {
-                        deleter_(data_);
-                        data_ = nullptr;
-                    }
-
-                    if (this->weak_refs() == 0)
-                        delete this;
+                    deleter_(data_);
+                    data_ = nullptr;
                 }
+
+                if (this->decrement_weak())
+                    delete this;
             }
 
             T* get() const noexcept override
@@ -129,18 +134,10 @@ namespace std::aux
 
             shared_payload_base<T>* lock() noexcept override
             {
-                refcount_t rfs = this->refs();
-                while (rfs != 0L)
-                {
-                    if (__atomic_compare_exchange_n(&this->refcount_, &rfs, rfs + 1,
-                                                    true, __ATOMIC_RELAXED,
-                                                    __ATOMIC_RELAXED))
-                    {
-                        return this;
-                    }
-                }
-
-                return nullptr;
+                if (this->increment_if_nonzero())
+                    return this;
+                else
+                    return nullptr;
             }
 
         private:
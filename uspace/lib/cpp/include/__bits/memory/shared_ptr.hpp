@@ -34,6 +34,8 @@
 #include <__bits/memory/allocator_arg.hpp>
 #include <__bits/memory/shared_payload.hpp>
 #include <__bits/memory/unique_ptr.hpp>
+#include <__bits/memory_order.hpp>
+#include <__bits/refcount_obj.hpp>
 #include <__bits/trycatch.hpp>
 #include <exception>
 #include <type_traits>
@@ -197,14 +199,17 @@ namespace std
             )
                 : payload_{}, data_{}
             {
-                if (other.expired())
-                    throw bad_weak_ptr{};
-
+                /**
+                 * Note: The last shared_ptr can be released
+                 *       concurrently, so lock() has the final
+                 *       say on whether the object is alive.
+                 */
                 if (other.payload_)
-                {
                     payload_ = other.payload_->lock();
-                    data_ = payload_->get();
-                }
+
+                if (!payload_)
+                    throw bad_weak_ptr{};
+                data_ = payload_->get();
             }
 
             template<class U, class D>
@@ -375,7 +380,7 @@ namespace std
             element_type* data_;
 
             shared_ptr(aux::payload_tag_t, aux::shared_payload_base<element_type>* payload)
-                : payload_{payload}, data_{payload->get()}
+                : payload_{payload}, data_{payload ? payload->get() : nullptr}
             { /* DUMMY BODY */ }
 
             void remove_payload_()
@@ -622,9 +627,117 @@ namespace std
 
     /**
      * 20.8.2.6, shared_ptr atomic access
+     * Note: These are implemented using a table of spinlocks,
+     *       the memory order arguments are thus ignored as
+     *       the locks always imply acquire and release.
+     *       Previous values are released after the lock is
+     *       dropped, as their destruction can run arbitrary
+     *       deleters.
      */
 
-    // TODO: implement
+    template<class T>
+    bool atomic_is_lock_free(const shared_ptr<T>*)
+    {
+        return false;
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_load(const shared_ptr<T>* ptr)
+    {
+        aux::shared_ptr_lock_guard guard{ptr};
+
+        return *ptr;
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_load_explicit(const shared_ptr<T>* ptr, memory_order)
+    {
+        return atomic_load(ptr);
+    }
+
+    template<class T>
+    void atomic_store(shared_ptr<T>* ptr, shared_ptr<T> val)
+    {
+        aux::shared_ptr_lock_guard guard{ptr};
+
+        ptr->swap(val);
+    }
+
+    template<class T>
+    void atomic_store_explicit(shared_ptr<T>* ptr, shared_ptr<T> val, memory_order)
+    {
+        atomic_store(ptr, move(val));
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_exchange(shared_ptr<T>* ptr, shared_ptr<T> val)
+    {
+        {
+            aux::shared_ptr_lock_guard guard{ptr};
+
+            ptr->swap(val);
+        }
+
+        return val;
+    }
+
+    template<class T>
+    shared_ptr<T> atomic_exchange_explicit(shared_ptr<T>* ptr, shared_ptr<T> val,
+                                           memory_order)
+    {
+        return atomic_exchange(ptr, move(val));
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_strong(shared_ptr<T>* ptr, shared_ptr<T>* expected,
+                                        shared_ptr<T> desired)
+    {
+        shared_ptr<T> current{};
+
+        {
+            aux::shared_ptr_lock_guard guard{ptr};
+
+            if (ptr->get() == expected->get() &&
+                !ptr->owner_before(*expected) &&
+                !expected->owner_before(*ptr))
+            {
+                ptr->swap(desired);
+
+                return true;
+            }
+
+            current = *ptr;
+        }
+
+        expected->swap(current);
+
+        return false;
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_weak(shared_ptr<T>* ptr, shared_ptr<T>* expected,
+                                      shared_ptr<T> desired)
+    {
+        return atomic_compare_exchange_strong(ptr, expected, move(desired));
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_strong_explicit(
+        shared_ptr<T>* ptr, shared_ptr<T>* expected,
+        shared_ptr<T> desired, memory_order, memory_order
+    )
+    {
+        return atomic_compare_exchange_strong(ptr, expected, move(desired));
+    }
+
+    template<class T>
+    bool atomic_compare_exchange_weak_explicit(
+        shared_ptr<T>* ptr, shared_ptr<T>* expected,
+        shared_ptr<T> desired, memory_order, memory_order
+    )
+    {
+        return atomic_compare_exchange_strong(ptr, expected, move(desired));
+    }
 
     /**
      * 20.8.2.7, smart pointer hash support:
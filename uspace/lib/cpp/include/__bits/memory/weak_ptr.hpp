@@ -191,7 +191,10 @@ namespace std
 
             shared_ptr<T> lock() const noexcept
             {
-                return shared_ptr{aux::payload_tag, payload_->lock()};
+                if (payload_)
+                    return shared_ptr<T>{aux::payload_tag, payload_->lock()};
+                else
+                    return shared_ptr<T>{};
             }
 
             template<class U>
@@ -211,8 +214,12 @@ namespace std
 
             void remove_payload_()
             {
+                /**
+                 * Note: The held object is destroyed by the last
+                 *       shared_ptr, we only free the payload.
+                 */
                 if (payload_ && payload_->decrement_weak())
-                    payload_->destroy();
+                    delete payload_;
                 payload_ = nullptr;
             }
 
@@ -53,6 +53,18 @@ using new_handler = void (*)();
 new_handler set_new_handler(new_handler);
 new_handler get_new_handler() noexcept;
 
+namespace aux
+{
+	/**
+	 * Number of calls to the global operator new, only
+	 * maintained while count_allocations is set (used by
+	 * the cpptest benchmarks to report allocations per
+	 * operation).
+	 */
+	extern bool count_allocations;
+	extern size_t allocation_count;
+}
+
 }
 
 void* operator new(std::size_t);
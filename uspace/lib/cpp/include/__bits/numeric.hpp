@@ -29,6 +29,8 @@
 #ifndef LIBCPP_BITS_NUMERIC
 #define LIBCPP_BITS_NUMERIC
 
+#include <__bits/functional/arithmetic_operations.hpp>
+#include <iterator>
 #include <utility>
 
 namespace std
@@ -167,6 +169,121 @@ namespace std
         return result;
     }
 
+    /**
+     * 29.8.3, reduce:
+     * Note: Unlike accumulate, reduce may combine the elements
+     *       in any order, which is what allows the parallel
+     *       overloads to split the range.
+     */
+
+    template<class InputIterator, class T, class BinaryOperation>
+    T reduce(InputIterator first, InputIterator last, T init,
+             BinaryOperation op)
+    {
+        auto acc{move(init)};
+        while (first != last)
+            acc = op(move(acc), *first++);
+
+        return acc;
+    }
+
+    template<class InputIterator, class T>
+    T reduce(InputIterator first, InputIterator last, T init)
+    {
+        return reduce(first, last, move(init), plus<>{});
+    }
+
+    template<class InputIterator>
+    typename iterator_traits<InputIterator>::value_type
+    reduce(InputIterator first, InputIterator last)
+    {
+        using value_type = typename iterator_traits<InputIterator>::value_type;
+
+        return reduce(first, last, value_type{}, plus<>{});
+    }
+
+    /**
+     * 29.8.5, transform_reduce:
+     */
+
+    template<
+        class InputIterator1, class InputIterator2, class T,
+        class BinaryOperation1, class BinaryOperation2
+    >
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2, T init,
+                       BinaryOperation1 reduce_op, BinaryOperation2 transform_op)
+    {
+        auto acc{move(init)};
+        while (first1 != last1)
+            acc = reduce_op(move(acc), transform_op(*first1++, *first2++));
+
+        return acc;
+    }
+
+    template<class InputIterator1, class InputIterator2, class T>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2, T init)
+    {
+        return transform_reduce(
+            first1, last1, first2, move(init),
+            plus<>{}, multiplies<>{}
+        );
+    }
+
+    template<
+        class InputIterator, class T,
+        class BinaryOperation, class UnaryOperation
+    >
+    T transform_reduce(InputIterator first, InputIterator last, T init,
+                       BinaryOperation reduce_op, UnaryOperation transform_op)
+    {
+        auto acc{move(init)};
+        while (first != last)
+            acc = reduce_op(move(acc), transform_op(*first++));
+
+        return acc;
+    }
+
+    /**
+     * 29.8.8, inclusive_scan:
+     */
+
+    template<class InputIterator, class OutputIterator, class BinaryOperation, class T>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                  OutputIterator result, BinaryOperation op,
+                                  T init)
+    {
+        auto acc{move(init)};
+        while (first != last)
+        {
+            acc = op(move(acc), *first++);
+            *result++ = acc;
+        }
+
+        return result;
+    }
+
+    template<class InputIterator, class OutputIterator, class BinaryOperation>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                  OutputIterator result, BinaryOperation op)
+    {
+        if (first == last)
+            return result;
+
+        typename iterator_traits<InputIterator>::value_type acc = *first++;
+        *result++ = acc;
+
+        return inclusive_scan(first, last, result, op, move(acc));
+    }
+
+    template<class InputIterator, class OutputIterator>
+    OutputIterator inclusive_scan(InputIterator first, InputIterator last,
+                                  OutputIterator result)
+    {
+        return inclusive_scan(first, last, result, plus<>{});
+    }
+
     /**
      * 26.7.6, iota:
      */
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_PARALLEL_ALGORITHM
+#define LIBCPP_BITS_PARALLEL_ALGORITHM
+
+#include <__bits/algorithm.hpp>
+#include <__bits/execution.hpp>
+#include <__bits/parallel/fork_join.hpp>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <utility>
+
+/**
+ * Parallel overloads of the algorithms from <algorithm>.
+ * Ranges are split into chunks that are processed on the
+ * shared executor, sequential policy and iterators that are
+ * not random access use the sequential algorithms.
+ */
+
+namespace std
+{
+    /**
+     * 25.2.4, for_each:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Function>
+    aux::enable_if_execution_policy_t<ExecutionPolicy>
+    for_each(ExecutionPolicy&&, ForwardIterator first,
+             ForwardIterator last, Function f)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator>)
+        {
+            auto size = static_cast<size_t>(last - first);
+
+            aux::fork_join_chunks(
+                size, aux::parallel_chunks(size),
+                [&](size_t begin, size_t end, size_t){
+                    std::for_each(first + begin, first + end, f);
+                }
+            );
+        }
+        else
+            std::for_each(first, last, f);
+    }
+
+    /**
+     * 25.3.4, transform:
+     */
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1,
+        class ForwardIterator2, class UnaryOperation
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, ForwardIterator2>
+    transform(ExecutionPolicy&&, ForwardIterator1 first,
+              ForwardIterator1 last, ForwardIterator2 result,
+              UnaryOperation op)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator1> &&
+                      aux::is_random_access_v<ForwardIterator2>)
+        {
+            auto size = static_cast<size_t>(last - first);
+
+            aux::fork_join_chunks(
+                size, aux::parallel_chunks(size),
+                [&](size_t begin, size_t end, size_t){
+                    std::transform(
+                        first + begin, first + end,
+                        result + begin, op
+                    );
+                }
+            );
+
+            return result + size;
+        }
+        else
+            return std::transform(first, last, result, op);
+    }
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+        class ForwardIterator3, class BinaryOperation
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, ForwardIterator3>
+    transform(ExecutionPolicy&&, ForwardIterator1 first1,
+              ForwardIterator1 last1, ForwardIterator2 first2,
+              ForwardIterator3 result, BinaryOperation op)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator1> &&
+                      aux::is_random_access_v<ForwardIterator2> &&
+                      aux::is_random_access_v<ForwardIterator3>)
+        {
+            auto size = static_cast<size_t>(last1 - first1);
+
+            aux::fork_join_chunks(
+                size, aux::parallel_chunks(size),
+                [&](size_t begin, size_t end, size_t){
+                    std::transform(
+                        first1 + begin, first1 + end,
+                        first2 + begin, result + begin, op
+                    );
+                }
+            );
+
+            return result + size;
+        }
+        else
+            return std::transform(first1, last1, first2, result, op);
+    }
+
+    /**
+     * 25.3.1, copy_if:
+     */
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1,
+        class ForwardIterator2, class Predicate
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, ForwardIterator2>
+    copy_if(ExecutionPolicy&&, ForwardIterator1 first, ForwardIterator1 last,
+            ForwardIterator2 result, Predicate pred)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator1> &&
+                      aux::is_random_access_v<ForwardIterator2>)
+        {
+            auto size = static_cast<size_t>(last - first);
+            auto chunks = aux::parallel_chunks(size);
+            if (chunks <= 1)
+                return std::copy_if(first, last, result, pred);
+
+            /**
+             * First count the matches of each chunk, which
+             * gives us the output position of every chunk,
+             * then copy all chunks in parallel.
+             */
+            auto offsets = new size_t[chunks];
+            aux::fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t idx){
+                    offsets[idx] = static_cast<size_t>(
+                        std::count_if(first + begin, first + end, pred)
+                    );
+                }
+            );
+
+            size_t total{};
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                auto count = offsets[i];
+                offsets[i] = total;
+                total += count;
+            }
+
+            aux::fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t idx){
+                    std::copy_if(
+                        first + begin, first + end,
+                        result + offsets[idx], pred
+                    );
+                }
+            );
+
+            delete[] offsets;
+
+            return result + total;
+        }
+        else
+            return std::copy_if(first, last, result, pred);
+    }
+
+    /**
+     * 25.4.1.1, sort:
+     */
+
+    template<class ExecutionPolicy, class RandomAccessIterator, class Compare>
+    aux::enable_if_execution_policy_t<ExecutionPolicy>
+    sort(ExecutionPolicy&&, RandomAccessIterator first,
+         RandomAccessIterator last, Compare comp)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        auto size = static_cast<size_t>(last - first);
+        auto chunks = aux::parallel_chunks(size);
+        if (!aux::is_parallel_policy_v<ExecutionPolicy> || chunks <= 1)
+        {
+            std::sort(first, last, comp);
+
+            return;
+        }
+
+        /**
+         * Chunks are sorted in parallel and then merged pairwise,
+         * each round of merges runs in parallel as well. Every
+         * chunk also fills its part of the merge buffer with
+         * valid objects, if we cannot get the buffer the merges
+         * are done in place.
+         */
+        auto buf = static_cast<value_type*>(
+            ::operator new(size * sizeof(value_type), nothrow)
+        );
+
+        aux::fork_join_chunks(
+            size, chunks,
+            [&](size_t begin, size_t end, size_t){
+                std::sort(first + begin, first + end, comp);
+
+                if (buf)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        ::new(static_cast<void*>(buf + i)) value_type(move(first[i]));
+                        first[i] = move(buf[i]);
+                    }
+                }
+            }
+        );
+
+        for (size_t width = 1; width < chunks; width *= 2)
+        {
+            auto pairs = (chunks + 2 * width - 1) / (2 * width);
+
+            aux::fork_join(pairs, [&](size_t pair){
+                auto lo = pair * 2 * width;
+                auto mid = lo + width;
+                auto hi = mid + width < chunks ? mid + width : chunks;
+                if (mid >= hi)
+                    return;
+
+                auto begin = aux::chunk_begin(size, chunks, lo);
+                auto middle = aux::chunk_begin(size, chunks, mid);
+                auto end = aux::chunk_end(size, chunks, hi - 1);
+
+                if (buf)
+                {
+                    aux::merge_with_buffer(
+                        first + begin, first + middle,
+                        first + end, buf + begin, comp
+                    );
+                }
+                else
+                {
+                    aux::merge_in_place(
+                        first + begin, first + middle,
+                        first + end, comp
+                    );
+                }
+            });
+        }
+
+        if (buf)
+        {
+            for (size_t i = 0; i < size; ++i)
+                buf[i].~value_type();
+            ::operator delete(static_cast<void*>(buf));
+        }
+    }
+
+    template<class ExecutionPolicy, class RandomAccessIterator>
+    aux::enable_if_execution_policy_t<ExecutionPolicy>
+    sort(ExecutionPolicy&& policy, RandomAccessIterator first,
+         RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        std::sort(forward<ExecutionPolicy>(policy), first, last, less<value_type>{});
+    }
+}
+
+#endif
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_PARALLEL_FORK_JOIN
+#define LIBCPP_BITS_PARALLEL_FORK_JOIN
+
+#include <__bits/thread/executor.hpp>
+#include <__bits/thread/threading.hpp>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * Ranges shorter than this are not worth splitting,
+     * the cost of a task is a queue operation and a
+     * context switch on the worker.
+     */
+    inline constexpr size_t parallel_grain{2048};
+
+    /**
+     * Number of chunks a range of the given size is split into.
+     */
+    inline size_t parallel_chunks(size_t size)
+    {
+        auto max_chunks = executor::instance().max_workers();
+        auto chunks = size / parallel_grain;
+
+        if (chunks == 0)
+            return 1;
+        else
+            return chunks < max_chunks ? chunks : max_chunks;
+    }
+
+    /**
+     * Bounds [begin, end) of chunk idx when splitting
+     * size elements into count chunks.
+     */
+    inline size_t chunk_begin(size_t size, size_t count, size_t idx)
+    {
+        return size / count * idx + (idx < size % count ? idx : size % count);
+    }
+
+    inline size_t chunk_end(size_t size, size_t count, size_t idx)
+    {
+        return chunk_begin(size, count, idx + 1);
+    }
+
+    template<class Iterator>
+    inline constexpr bool is_random_access_v = is_base_of_v<
+        random_access_iterator_tag,
+        typename iterator_traits<Iterator>::iterator_category
+    >;
+
+    /**
+     * Counts finished chunks so that the forking
+     * fibril can wait for all of them.
+     */
+    class join_counter
+    {
+        public:
+            explicit join_counter(size_t count)
+                : mtx_{}, cv_{}, pending_{count}
+            {
+                threading::mutex::init(mtx_);
+                threading::condvar::init(cv_);
+            }
+
+            void done()
+            {
+                /**
+                 * Note: The waiter may destroy the counter as soon
+                 *       as we release the mutex, so we do not touch
+                 *       it after that.
+                 */
+                threading::mutex::lock(mtx_);
+                if (--pending_ == 0)
+                    threading::condvar::broadcast(cv_);
+                threading::mutex::unlock(mtx_);
+            }
+
+            void wait()
+            {
+                threading::mutex::lock(mtx_);
+                while (pending_ > 0)
+                    threading::condvar::wait(cv_, mtx_);
+                threading::mutex::unlock(mtx_);
+            }
+
+        private:
+            mutex_t mtx_;
+            condvar_t cv_;
+            size_t pending_;
+    };
+
+    template<class Body>
+    class fork_join_task: public executor_task
+    {
+        public:
+            void run() override
+            {
+                (*body)(idx);
+                counter->done();
+            }
+
+            Body* body;
+            size_t idx;
+            join_counter* counter;
+    };
+
+    /**
+     * Calls body(0), ..., body(count - 1) in parallel on the
+     * shared executor and returns once all of them finished.
+     * Chunk 0 runs on the calling fibril, which afterwards
+     * also runs every chunk no worker has picked up yet.
+     */
+    template<class Body>
+    void fork_join(size_t count, Body body)
+    {
+        if (count <= 1)
+        {
+            if (count == 1)
+                body(0);
+
+            return;
+        }
+
+        auto tasks = new fork_join_task<Body>[count - 1];
+        join_counter counter{count - 1};
+        auto& exec = executor::instance();
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            auto& task = tasks[i - 1];
+            task.body = &body;
+            task.idx = i;
+            task.counter = &counter;
+
+            exec.submit(&task);
+        }
+
+        body(0);
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            if (exec.withdraw(&tasks[i - 1]))
+                tasks[i - 1].run();
+        }
+
+        counter.wait();
+        delete[] tasks;
+    }
+
+    /**
+     * Splits [0, size) into count chunks and calls
+     * body(begin, end, idx) for each of them in parallel.
+     */
+    template<class Body>
+    void fork_join_chunks(size_t size, size_t count, Body body)
+    {
+        fork_join(count, [&body, size, count](size_t idx){
+            body(chunk_begin(size, count, idx), chunk_end(size, count, idx), idx);
+        });
+    }
+
+    /**
+     * Per chunk results, constructed in place so that
+     * T does not need to be default constructible.
+     */
+    template<class T>
+    class chunk_results
+    {
+        public:
+            explicit chunk_results(size_t count)
+                : data_{static_cast<T*>(::operator new(count * sizeof(T)))},
+                  count_{count}, constructed_{new bool[count]()}
+            { /* DUMMY BODY */ }
+
+            chunk_results(const chunk_results&) = delete;
+            chunk_results& operator=(const chunk_results&) = delete;
+
+            ~chunk_results()
+            {
+                for (size_t i = 0; i < count_; ++i)
+                {
+                    if (constructed_[i])
+                        data_[i].~T();
+                }
+
+                ::operator delete(static_cast<void*>(data_));
+                delete[] constructed_;
+            }
+
+            template<class... Args>
+            void emplace(size_t idx, Args&&... args)
+            {
+                ::new(static_cast<void*>(data_ + idx)) T(forward<Args>(args)...);
+                constructed_[idx] = true;
+            }
+
+            T& operator[](size_t idx)
+            {
+                return data_[idx];
+            }
+
+        private:
+            T* data_;
+            size_t count_;
+            bool* constructed_;
+    };
+}
+
+#endif
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_PARALLEL_NUMERIC
+#define LIBCPP_BITS_PARALLEL_NUMERIC
+
+#include <__bits/execution.hpp>
+#include <__bits/numeric.hpp>
+#include <__bits/parallel/fork_join.hpp>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+/**
+ * Parallel overloads of the algorithms from <numeric>.
+ * The operations are required to be associative and
+ * commutative, so chunks can be reduced independently
+ * and their results combined afterwards.
+ */
+
+namespace std
+{
+    /**
+     * 29.8.3, reduce:
+     */
+
+    template<
+        class ExecutionPolicy, class ForwardIterator,
+        class T, class BinaryOperation
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, T>
+    reduce(ExecutionPolicy&&, ForwardIterator first, ForwardIterator last,
+           T init, BinaryOperation op)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator>)
+        {
+            auto size = static_cast<size_t>(last - first);
+            auto chunks = aux::parallel_chunks(size);
+            if (chunks <= 1)
+                return std::reduce(first, last, move(init), op);
+
+            aux::chunk_results<T> partials{chunks};
+            aux::fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t idx){
+                    auto it = first + begin;
+                    T acc = *it++;
+
+                    partials.emplace(idx, std::reduce(it, first + end, move(acc), op));
+                }
+            );
+
+            for (size_t i = 0; i < chunks; ++i)
+                init = op(move(init), move(partials[i]));
+
+            return init;
+        }
+        else
+            return std::reduce(first, last, move(init), op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class T>
+    aux::enable_if_execution_policy_t<ExecutionPolicy, T>
+    reduce(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last, T init)
+    {
+        return std::reduce(
+            forward<ExecutionPolicy>(policy), first, last,
+            move(init), plus<>{}
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator>
+    aux::enable_if_execution_policy_t<
+        ExecutionPolicy, typename iterator_traits<ForwardIterator>::value_type
+    >
+    reduce(ExecutionPolicy&& policy, ForwardIterator first, ForwardIterator last)
+    {
+        using value_type = typename iterator_traits<ForwardIterator>::value_type;
+
+        return std::reduce(
+            forward<ExecutionPolicy>(policy), first, last,
+            value_type{}, plus<>{}
+        );
+    }
+
+    /**
+     * 29.8.5, transform_reduce:
+     */
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+        class T, class BinaryOperation1, class BinaryOperation2
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&&, ForwardIterator1 first1,
+                     ForwardIterator1 last1, ForwardIterator2 first2, T init,
+                     BinaryOperation1 reduce_op, BinaryOperation2 transform_op)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator1> &&
+                      aux::is_random_access_v<ForwardIterator2>)
+        {
+            auto size = static_cast<size_t>(last1 - first1);
+            auto chunks = aux::parallel_chunks(size);
+            if (chunks <= 1)
+            {
+                return std::transform_reduce(
+                    first1, last1, first2, move(init),
+                    reduce_op, transform_op
+                );
+            }
+
+            aux::chunk_results<T> partials{chunks};
+            aux::fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t idx){
+                    auto it1 = first1 + begin;
+                    auto it2 = first2 + begin;
+                    T acc = transform_op(*it1++, *it2++);
+
+                    partials.emplace(idx, std::transform_reduce(
+                        it1, first1 + end, it2, move(acc),
+                        reduce_op, transform_op
+                    ));
+                }
+            );
+
+            for (size_t i = 0; i < chunks; ++i)
+                init = reduce_op(move(init), move(partials[i]));
+
+            return init;
+        }
+        else
+        {
+            return std::transform_reduce(
+                first1, last1, first2, move(init),
+                reduce_op, transform_op
+            );
+        }
+    }
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1,
+        class ForwardIterator2, class T
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&& policy, ForwardIterator1 first1,
+                     ForwardIterator1 last1, ForwardIterator2 first2, T init)
+    {
+        return std::transform_reduce(
+            forward<ExecutionPolicy>(policy), first1, last1, first2,
+            move(init), plus<>{}, multiplies<>{}
+        );
+    }
+
+    template<
+        class ExecutionPolicy, class ForwardIterator, class T,
+        class BinaryOperation, class UnaryOperation
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&&, ForwardIterator first,
+                     ForwardIterator last, T init,
+                     BinaryOperation reduce_op, UnaryOperation transform_op)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator>)
+        {
+            auto size = static_cast<size_t>(last - first);
+            auto chunks = aux::parallel_chunks(size);
+            if (chunks <= 1)
+            {
+                return std::transform_reduce(
+                    first, last, move(init), reduce_op, transform_op
+                );
+            }
+
+            aux::chunk_results<T> partials{chunks};
+            aux::fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t idx){
+                    auto it = first + begin;
+                    T acc = transform_op(*it++);
+
+                    partials.emplace(idx, std::transform_reduce(
+                        it, first + end, move(acc), reduce_op, transform_op
+                    ));
+                }
+            );
+
+            for (size_t i = 0; i < chunks; ++i)
+                init = reduce_op(move(init), move(partials[i]));
+
+            return init;
+        }
+        else
+        {
+            return std::transform_reduce(
+                first, last, move(init), reduce_op, transform_op
+            );
+        }
+    }
+
+    /**
+     * 29.8.8, inclusive_scan:
+     */
+
+    namespace aux
+    {
+        /**
+         * Scans every chunk on its own, computes the value
+         * preceding each chunk from the chunk totals and then
+         * applies that value to the chunks in parallel.
+         * Without an initial value, init is null.
+         */
+        template<
+            class ForwardIterator1, class ForwardIterator2,
+            class BinaryOperation, class T
+        >
+        ForwardIterator2 parallel_inclusive_scan(ForwardIterator1 first,
+                                                 ForwardIterator1 last,
+                                                 ForwardIterator2 result,
+                                                 BinaryOperation op,
+                                                 const T* init)
+        {
+            auto size = static_cast<size_t>(last - first);
+            auto chunks = parallel_chunks(size);
+            if (chunks <= 1)
+            {
+                if (init)
+                    return std::inclusive_scan(first, last, result, op, *init);
+                else
+                    return std::inclusive_scan(first, last, result, op);
+            }
+
+            fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t){
+                    std::inclusive_scan(
+                        first + begin, first + end, result + begin, op
+                    );
+                }
+            );
+
+            size_t first_chunk = init ? 0 : 1;
+            chunk_results<T> prefixes{chunks};
+            T carry = init ? *init : T(result[chunk_end(size, chunks, 0) - 1]);
+
+            for (size_t i = first_chunk; i < chunks; ++i)
+            {
+                prefixes.emplace(i, carry);
+                carry = op(move(carry), result[chunk_end(size, chunks, i) - 1]);
+            }
+
+            fork_join_chunks(
+                size, chunks,
+                [&](size_t begin, size_t end, size_t idx){
+                    if (idx < first_chunk)
+                        return;
+
+                    for (auto i = begin; i < end; ++i)
+                        result[i] = op(prefixes[idx], result[i]);
+                }
+            );
+
+            return result + size;
+        }
+    }
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2,
+        class BinaryOperation, class T
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, ForwardIterator2>
+    inclusive_scan(ExecutionPolicy&&, ForwardIterator1 first,
+                   ForwardIterator1 last, ForwardIterator2 result,
+                   BinaryOperation op, T init)
+    {
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator1> &&
+                      aux::is_random_access_v<ForwardIterator2>)
+            return aux::parallel_inclusive_scan(first, last, result, op, &init);
+        else
+            return std::inclusive_scan(first, last, result, op, move(init));
+    }
+
+    template<
+        class ExecutionPolicy, class ForwardIterator1,
+        class ForwardIterator2, class BinaryOperation
+    >
+    aux::enable_if_execution_policy_t<ExecutionPolicy, ForwardIterator2>
+    inclusive_scan(ExecutionPolicy&&, ForwardIterator1 first,
+                   ForwardIterator1 last, ForwardIterator2 result,
+                   BinaryOperation op)
+    {
+        using value_type = typename iterator_traits<ForwardIterator1>::value_type;
+
+        if constexpr (aux::is_parallel_policy_v<ExecutionPolicy> &&
+                      aux::is_random_access_v<ForwardIterator1> &&
+                      aux::is_random_access_v<ForwardIterator2>)
+        {
+            return aux::parallel_inclusive_scan(
+                first, last, result, op,
+                static_cast<const value_type*>(nullptr)
+            );
+        }
+        else
+            return std::inclusive_scan(first, last, result, op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1, class ForwardIterator2>
+    aux::enable_if_execution_policy_t<ExecutionPolicy, ForwardIterator2>
+    inclusive_scan(ExecutionPolicy&& policy, ForwardIterator1 first,
+                   ForwardIterator1 last, ForwardIterator2 result)
+    {
+        return std::inclusive_scan(
+            forward<ExecutionPolicy>(policy), first, last, result, plus<>{}
+        );
+    }
+}
+
+#endif
@@ -32,8 +32,13 @@
 namespace std::aux
 {
     /**
-     * At the moment we do not have atomics, change this
-     * to std::atomic<long> once we do.
+     * Note: <atomic> is not implemented yet, so the counters
+     *       are plain longs that are only ever accessed
+     *       through the __atomic builtins. Increments are
+     *       relaxed, as a new reference can only be created
+     *       from an existing one, decrements are acq_rel so
+     *       that whoever drops the last reference sees all
+     *       writes made through the other references.
      */
     using refcount_t = long;
 
@@ -44,6 +49,7 @@ namespace std::aux
 
             void increment() noexcept;
             void increment_weak() noexcept;
+            bool increment_if_nonzero() noexcept;
             bool decrement() noexcept;
             bool decrement_weak() noexcept;
             refcount_t refs() const noexcept;
@@ -60,10 +66,33 @@ namespace std::aux
              * this makes it easier for weak_ptrs that
              * can't decrement the weak_refcount_ to
              * zero with shared_ptrs using this object.
+             * The shared_ptr that drops refcount_ to zero
+             * is responsible for removing that one once
+             * it has destroyed the held object.
              */
             refcount_t refcount_{1};
             refcount_t weak_refcount_{1};
     };
+
+    /**
+     * Serializes the shared_ptr atomic access functions.
+     * The lock is picked from a small table by the address
+     * of the shared_ptr, so unrelated pointers rarely
+     * contend on the same lock.
+     */
+    class shared_ptr_lock_guard
+    {
+        public:
+            explicit shared_ptr_lock_guard(const void* ptr) noexcept;
+
+            ~shared_ptr_lock_guard() noexcept;
+
+            shared_ptr_lock_guard(const shared_ptr_lock_guard&) = delete;
+            shared_ptr_lock_guard& operator=(const shared_ptr_lock_guard&) = delete;
+
+        private:
+            bool* lock_;
+    };
 }
 
 #endif
@@ -29,6 +29,1540 @@
 #ifndef LIBCPP_BITS_REGEX
 #define LIBCPP_BITS_REGEX
 
-#error "<regex> is not implemented"
+#include <__bits/regex/automaton.hpp>
+#include <__bits/regex/constants.hpp>
+#include <__bits/regex/traits.hpp>
+#include <initializer_list>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace std
+{
+    namespace aux
+    {
+        struct regex_access;
+    }
+
+    /**
+     * 28.8, class template basic_regex:
+     * Note: Only the ECMAScript grammar is implemented,
+     *       the other grammars are parsed as ECMAScript.
+     */
+
+    template<class charT, class traits = regex_traits<charT>>
+    class basic_regex
+    {
+        public:
+            using value_type  = charT;
+            using traits_type = traits;
+            using string_type = typename traits::string_type;
+            using flag_type   = regex_constants::syntax_option_type;
+            using locale_type = typename traits::locale_type;
+
+            static constexpr flag_type icase      = regex_constants::icase;
+            static constexpr flag_type nosubs     = regex_constants::nosubs;
+            static constexpr flag_type optimize   = regex_constants::optimize;
+            static constexpr flag_type collate    = regex_constants::collate;
+            static constexpr flag_type ECMAScript = regex_constants::ECMAScript;
+            static constexpr flag_type basic      = regex_constants::basic;
+            static constexpr flag_type extended   = regex_constants::extended;
+            static constexpr flag_type awk        = regex_constants::awk;
+            static constexpr flag_type grep       = regex_constants::grep;
+            static constexpr flag_type egrep      = regex_constants::egrep;
+            static constexpr flag_type multiline  = regex_constants::multiline;
+
+            basic_regex()
+                : flags_{ECMAScript}, traits_{}, automaton_{}
+            { /* DUMMY BODY */ }
+
+            explicit basic_regex(const charT* str, flag_type f = ECMAScript)
+                : basic_regex{}
+            {
+                assign(str, f);
+            }
+
+            basic_regex(const charT* str, size_t len, flag_type f = ECMAScript)
+                : basic_regex{}
+            {
+                assign(str, len, f);
+            }
+
+            basic_regex(const basic_regex&) = default;
+
+            basic_regex(basic_regex&&) noexcept = default;
+
+            template<class ST, class SA>
+            explicit basic_regex(const basic_string<charT, ST, SA>& str,
+                                 flag_type f = ECMAScript)
+                : basic_regex{}
+            {
+                assign(str, f);
+            }
+
+            template<class ForwardIterator>
+            basic_regex(ForwardIterator first, ForwardIterator last,
+                        flag_type f = ECMAScript)
+                : basic_regex{}
+            {
+                assign(first, last, f);
+            }
+
+            basic_regex(initializer_list<charT> init, flag_type f = ECMAScript)
+                : basic_regex{}
+            {
+                assign(init, f);
+            }
+
+            ~basic_regex() = default;
+
+            basic_regex& operator=(const basic_regex&) = default;
+
+            basic_regex& operator=(basic_regex&&) noexcept = default;
+
+            basic_regex& operator=(const charT* str)
+            {
+                return assign(str);
+            }
+
+            basic_regex& operator=(initializer_list<charT> init)
+            {
+                return assign(init);
+            }
+
+            template<class ST, class SA>
+            basic_regex& operator=(const basic_string<charT, ST, SA>& str)
+            {
+                return assign(str);
+            }
+
+            basic_regex& assign(const basic_regex& other)
+            {
+                return *this = other;
+            }
+
+            basic_regex& assign(basic_regex&& other) noexcept
+            {
+                return *this = move(other);
+            }
+
+            basic_regex& assign(const charT* str, flag_type f = ECMAScript)
+            {
+                return assign(str, traits::length(str), f);
+            }
+
+            basic_regex& assign(const charT* str, size_t len, flag_type f = ECMAScript)
+            {
+                return compile_(str, str + len, f);
+            }
+
+            template<class ST, class SA>
+            basic_regex& assign(const basic_string<charT, ST, SA>& str,
+                                flag_type f = ECMAScript)
+            {
+                return compile_(str.data(), str.data() + str.size(), f);
+            }
+
+            template<class InputIterator>
+            basic_regex& assign(InputIterator first, InputIterator last,
+                                flag_type f = ECMAScript)
+            {
+                basic_string<charT> str(first, last);
+
+                return assign(str, f);
+            }
+
+            basic_regex& assign(initializer_list<charT> init, flag_type f = ECMAScript)
+            {
+                return compile_(init.begin(), init.end(), f);
+            }
+
+            unsigned mark_count() const
+            {
+                if (automaton_)
+                    return static_cast<unsigned>(automaton_->mark_count());
+                else
+                    return 0U;
+            }
+
+            flag_type flags() const
+            {
+                return flags_;
+            }
+
+            locale_type imbue(locale_type loc)
+            {
+                // The expression matches nothing until reassigned.
+                automaton_.reset();
+
+                return traits_.imbue(loc);
+            }
+
+            locale_type getloc() const
+            {
+                return traits_.getloc();
+            }
+
+            void swap(basic_regex& other)
+            {
+                std::swap(flags_, other.flags_);
+                std::swap(traits_, other.traits_);
+                std::swap(automaton_, other.automaton_);
+            }
+
+        private:
+            using automaton_type = aux::regex_automaton<charT, traits>;
+
+            flag_type flags_;
+            traits traits_;
+
+            /**
+             * The compiled expression is immutable (except
+             * for the DFA cache, which guards itself), so
+             * copies share it.
+             */
+            shared_ptr<automaton_type> automaton_;
+
+            basic_regex& compile_(const charT* first, const charT* last, flag_type f)
+            {
+                flags_ = f;
+                automaton_ = make_shared<automaton_type>(first, last, f, traits_);
+
+                return *this;
+            }
+
+            friend struct aux::regex_access;
+    };
+
+    using regex  = basic_regex<char>;
+    using wregex = basic_regex<wchar_t>;
+
+    /**
+     * 28.8.6, basic_regex swap:
+     */
+
+    template<class charT, class traits>
+    void swap(basic_regex<charT, traits>& lhs, basic_regex<charT, traits>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+
+    /**
+     * 28.9, class template sub_match:
+     */
+
+    template<class BidirectionalIterator>
+    class sub_match: public pair<BidirectionalIterator, BidirectionalIterator>
+    {
+        public:
+            using value_type      = typename iterator_traits<BidirectionalIterator>::value_type;
+            using difference_type = typename iterator_traits<BidirectionalIterator>::difference_type;
+            using iterator        = BidirectionalIterator;
+            using string_type     = basic_string<value_type>;
+
+            bool matched;
+
+            constexpr sub_match()
+                : pair<BidirectionalIterator, BidirectionalIterator>{}, matched{false}
+            { /* DUMMY BODY */ }
+
+            difference_type length() const
+            {
+                if (matched)
+                    return distance(this->first, this->second);
+                else
+                    return difference_type{};
+            }
+
+            operator string_type() const
+            {
+                return str();
+            }
+
+            string_type str() const
+            {
+                if (matched)
+                    return string_type(this->first, this->second);
+                else
+                    return string_type{};
+            }
+
+            int compare(const sub_match& other) const
+            {
+                return str().compare(other.str());
+            }
+
+            int compare(const string_type& other) const
+            {
+                return str().compare(other);
+            }
+
+            int compare(const value_type* other) const
+            {
+                return str().compare(other);
+            }
+    };
+
+    using csub_match  = sub_match<const char*>;
+    using wcsub_match = sub_match<const wchar_t*>;
+    using ssub_match  = sub_match<string::const_iterator>;
+    using wssub_match = sub_match<wstring::const_iterator>;
+
+    /**
+     * 28.9.2, sub_match non-member operators:
+     */
+
+    template<class BidirectionalIterator>
+    bool operator==(const sub_match<BidirectionalIterator>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator!=(const sub_match<BidirectionalIterator>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return lhs.compare(rhs) != 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<(const sub_match<BidirectionalIterator>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<=(const sub_match<BidirectionalIterator>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return lhs.compare(rhs) <= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>(const sub_match<BidirectionalIterator>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return lhs.compare(rhs) > 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>=(const sub_match<BidirectionalIterator>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return lhs.compare(rhs) >= 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator==(const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs.c_str()) == 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator!=(const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs.c_str()) != 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator<(const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs.c_str()) < 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator<=(const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs.c_str()) <= 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator>(const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs.c_str()) > 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator>=(const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs.c_str()) >= 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator==(const sub_match<BidirectionalIterator>& lhs, const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& rhs)
+    {
+        return lhs.compare(rhs.c_str()) == 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator!=(const sub_match<BidirectionalIterator>& lhs, const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& rhs)
+    {
+        return lhs.compare(rhs.c_str()) != 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator<(const sub_match<BidirectionalIterator>& lhs, const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& rhs)
+    {
+        return lhs.compare(rhs.c_str()) < 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator<=(const sub_match<BidirectionalIterator>& lhs, const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& rhs)
+    {
+        return lhs.compare(rhs.c_str()) <= 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator>(const sub_match<BidirectionalIterator>& lhs, const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& rhs)
+    {
+        return lhs.compare(rhs.c_str()) > 0;
+    }
+
+    template<class BidirectionalIterator, class ST, class SA>
+    bool operator>=(const sub_match<BidirectionalIterator>& lhs, const basic_string<typename iterator_traits<BidirectionalIterator>::value_type, ST, SA>& rhs)
+    {
+        return lhs.compare(rhs.c_str()) >= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator==(const typename iterator_traits<BidirectionalIterator>::value_type* lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs) == 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator!=(const typename iterator_traits<BidirectionalIterator>::value_type* lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs) != 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<(const typename iterator_traits<BidirectionalIterator>::value_type* lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs) < 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<=(const typename iterator_traits<BidirectionalIterator>::value_type* lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs) <= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>(const typename iterator_traits<BidirectionalIterator>::value_type* lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs) > 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>=(const typename iterator_traits<BidirectionalIterator>::value_type* lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(lhs) >= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator==(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type* rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator!=(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type* rhs)
+    {
+        return lhs.compare(rhs) != 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type* rhs)
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<=(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type* rhs)
+    {
+        return lhs.compare(rhs) <= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type* rhs)
+    {
+        return lhs.compare(rhs) > 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>=(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type* rhs)
+    {
+        return lhs.compare(rhs) >= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator==(const typename iterator_traits<BidirectionalIterator>::value_type& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, lhs)) == 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator!=(const typename iterator_traits<BidirectionalIterator>::value_type& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, lhs)) != 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<(const typename iterator_traits<BidirectionalIterator>::value_type& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, lhs)) < 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<=(const typename iterator_traits<BidirectionalIterator>::value_type& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, lhs)) <= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>(const typename iterator_traits<BidirectionalIterator>::value_type& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, lhs)) > 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>=(const typename iterator_traits<BidirectionalIterator>::value_type& lhs, const sub_match<BidirectionalIterator>& rhs)
+    {
+        return -rhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, lhs)) >= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator==(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type& rhs)
+    {
+        return lhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, rhs)) == 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator!=(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type& rhs)
+    {
+        return lhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, rhs)) != 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type& rhs)
+    {
+        return lhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, rhs)) < 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator<=(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type& rhs)
+    {
+        return lhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, rhs)) <= 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type& rhs)
+    {
+        return lhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, rhs)) > 0;
+    }
+
+    template<class BidirectionalIterator>
+    bool operator>=(const sub_match<BidirectionalIterator>& lhs, const typename iterator_traits<BidirectionalIterator>::value_type& rhs)
+    {
+        return lhs.compare(typename sub_match<BidirectionalIterator>::string_type(1, rhs)) >= 0;
+    }
+    template<class charT, class ST, class BidirectionalIterator>
+    basic_ostream<charT, ST>& operator<<(basic_ostream<charT, ST>& os,
+                                         const sub_match<BidirectionalIterator>& m)
+    {
+        return os << m.str();
+    }
+
+    /**
+     * 28.10, class template match_results:
+     */
+
+    template<
+        class BidirectionalIterator,
+        class Allocator = allocator<sub_match<BidirectionalIterator>>
+    >
+    class match_results
+    {
+        public:
+            using value_type      = sub_match<BidirectionalIterator>;
+            using const_reference = const value_type&;
+            using reference       = value_type&;
+            using const_iterator  = typename vector<value_type, Allocator>::const_iterator;
+            using iterator        = const_iterator;
+            using difference_type = typename iterator_traits<BidirectionalIterator>::difference_type;
+            using size_type       = typename allocator_traits<Allocator>::size_type;
+            using allocator_type  = Allocator;
+            using char_type       = typename iterator_traits<BidirectionalIterator>::value_type;
+            using string_type     = basic_string<char_type>;
+
+            explicit match_results(const Allocator& alloc = Allocator{})
+                : subs_(alloc), prefix_{}, suffix_{}, unmatched_{},
+                  begin_{}, ready_{false}
+            { /* DUMMY BODY */ }
+
+            match_results(const match_results&) = default;
+
+            match_results(match_results&&) = default;
+
+            match_results& operator=(const match_results&) = default;
+
+            match_results& operator=(match_results&&) = default;
+
+            ~match_results() = default;
+
+            bool ready() const
+            {
+                return ready_;
+            }
+
+            size_type size() const
+            {
+                return subs_.size();
+            }
+
+            size_type max_size() const
+            {
+                return subs_.max_size();
+            }
+
+            bool empty() const
+            {
+                return size() == 0;
+            }
+
+            difference_type length(size_type sub = 0) const
+            {
+                return (*this)[sub].length();
+            }
+
+            difference_type position(size_type sub = 0) const
+            {
+                return distance(begin_, (*this)[sub].first);
+            }
+
+            string_type str(size_type sub = 0) const
+            {
+                return (*this)[sub].str();
+            }
+
+            const_reference operator[](size_type n) const
+            {
+                if (n < size())
+                    return subs_[n];
+                else
+                    return unmatched_;
+            }
+
+            const_reference prefix() const
+            {
+                return prefix_;
+            }
+
+            const_reference suffix() const
+            {
+                return suffix_;
+            }
+
+            const_iterator begin() const
+            {
+                return subs_.begin();
+            }
+
+            const_iterator end() const
+            {
+                return subs_.end();
+            }
+
+            const_iterator cbegin() const
+            {
+                return subs_.cbegin();
+            }
+
+            const_iterator cend() const
+            {
+                return subs_.cend();
+            }
+
+            template<class OutputIterator>
+            OutputIterator format(
+                OutputIterator out, const char_type* fmt_first, const char_type* fmt_last,
+                regex_constants::match_flag_type flags = regex_constants::format_default
+            ) const
+            {
+                if (flags & regex_constants::format_sed)
+                    return format_sed_(out, fmt_first, fmt_last);
+                else
+                    return format_ecma_(out, fmt_first, fmt_last);
+            }
+
+            template<class OutputIterator, class ST, class SA>
+            OutputIterator format(
+                OutputIterator out, const basic_string<char_type, ST, SA>& fmt,
+                regex_constants::match_flag_type flags = regex_constants::format_default
+            ) const
+            {
+                return format(out, fmt.data(), fmt.data() + fmt.size(), flags);
+            }
+
+            template<class ST, class SA>
+            basic_string<char_type, ST, SA> format(
+                const basic_string<char_type, ST, SA>& fmt,
+                regex_constants::match_flag_type flags = regex_constants::format_default
+            ) const
+            {
+                basic_string<char_type, ST, SA> res{};
+                format(back_inserter(res), fmt, flags);
+
+                return res;
+            }
+
+            string_type format(
+                const char_type* fmt,
+                regex_constants::match_flag_type flags = regex_constants::format_default
+            ) const
+            {
+                string_type res{};
+                format(back_inserter(res), fmt, fmt + char_traits<char_type>::length(fmt), flags);
+
+                return res;
+            }
+
+            allocator_type get_allocator() const
+            {
+                return subs_.get_allocator();
+            }
+
+            void swap(match_results& other)
+            {
+                std::swap(subs_, other.subs_);
+                std::swap(prefix_, other.prefix_);
+                std::swap(suffix_, other.suffix_);
+                std::swap(unmatched_, other.unmatched_);
+                std::swap(begin_, other.begin_);
+                std::swap(ready_, other.ready_);
+            }
+
+        private:
+            vector<value_type, Allocator> subs_;
+            value_type prefix_;
+            value_type suffix_;
+            value_type unmatched_;
+            BidirectionalIterator begin_;
+            bool ready_;
+
+            template<class OutputIterator>
+            static OutputIterator copy_(OutputIterator out, const value_type& sub)
+            {
+                if (sub.matched)
+                    out = copy(sub.first, sub.second, out);
+
+                return out;
+            }
+
+            template<class OutputIterator>
+            OutputIterator format_ecma_(OutputIterator out, const char_type* first,
+                                        const char_type* last) const
+            {
+                auto digit = [](char_type c){
+                    return c >= char_type('0') && c <= char_type('9');
+                };
+
+                while (first != last)
+                {
+                    auto c = *first++;
+                    if (c != char_type('$') || first == last)
+                    {
+                        *out++ = c;
+                        continue;
+                    }
+
+                    auto spec = *first;
+                    if (spec == char_type('$'))
+                        *out++ = spec;
+                    else if (spec == char_type('&'))
+                        out = copy_(out, (*this)[0]);
+                    else if (spec == char_type('`'))
+                        out = copy_(out, prefix_);
+                    else if (spec == char_type('\''))
+                        out = copy_(out, suffix_);
+                    else if (digit(spec))
+                    {
+                        size_type idx = static_cast<size_type>(spec - char_type('0'));
+                        if (first + 1 != last && digit(first[1]))
+                        {
+                            auto idx2 = idx * 10 + static_cast<size_type>(first[1] - char_type('0'));
+                            if (idx2 < size())
+                            {
+                                idx = idx2;
+                                ++first;
+                            }
+                        }
+
+                        out = copy_(out, (*this)[idx]);
+                    }
+                    else
+                    {
+                        // Not a format specifier.
+                        *out++ = c;
+                        continue;
+                    }
+
+                    ++first;
+                }
+
+                return out;
+            }
+
+            template<class OutputIterator>
+            OutputIterator format_sed_(OutputIterator out, const char_type* first,
+                                       const char_type* last) const
+            {
+                while (first != last)
+                {
+                    auto c = *first++;
+                    if (c == char_type('&'))
+                        out = copy_(out, (*this)[0]);
+                    else if (c == char_type('\\') && first != last)
+                    {
+                        c = *first++;
+                        if (c >= char_type('0') && c <= char_type('9'))
+                            out = copy_(out, (*this)[static_cast<size_type>(c - char_type('0'))]);
+                        else
+                            *out++ = c;
+                    }
+                    else
+                        *out++ = c;
+                }
+
+                return out;
+            }
+
+            friend struct aux::regex_access;
+    };
+
+    using cmatch  = match_results<const char*>;
+    using wcmatch = match_results<const wchar_t*>;
+    using smatch  = match_results<string::const_iterator>;
+    using wsmatch = match_results<wstring::const_iterator>;
+
+    /**
+     * 28.10.8, match_results comparisons:
+     */
+
+    template<class BidirectionalIterator, class Allocator>
+    bool operator==(const match_results<BidirectionalIterator, Allocator>& lhs,
+                    const match_results<BidirectionalIterator, Allocator>& rhs)
+    {
+        if (!lhs.ready() || !rhs.ready())
+            return lhs.ready() == rhs.ready();
+
+        if (lhs.empty() || rhs.empty())
+            return lhs.empty() == rhs.empty();
+
+        if (lhs.size() != rhs.size() || lhs.prefix() != rhs.prefix() ||
+            lhs.suffix() != rhs.suffix())
+            return false;
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (lhs[i] != rhs[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    template<class BidirectionalIterator, class Allocator>
+    bool operator!=(const match_results<BidirectionalIterator, Allocator>& lhs,
+                    const match_results<BidirectionalIterator, Allocator>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    /**
+     * 28.10.9, match_results swap:
+     */
+
+    template<class BidirectionalIterator, class Allocator>
+    void swap(match_results<BidirectionalIterator, Allocator>& lhs,
+              match_results<BidirectionalIterator, Allocator>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+
+    namespace aux
+    {
+        struct regex_access
+        {
+            /**
+             * Runs the automaton of e over [first, last) and
+             * fills m (if not null) with the results.
+             */
+            template<class BidirectionalIterator, class Allocator, class charT, class traits>
+            static bool execute(BidirectionalIterator first, BidirectionalIterator last,
+                                match_results<BidirectionalIterator, Allocator>* m,
+                                const basic_regex<charT, traits>& e,
+                                regex_constants::match_flag_type flags, bool search)
+            {
+                vector<size_t> caps{};
+
+                bool res{false};
+                if (e.automaton_)
+                    res = e.automaton_->execute(first, last, flags, search, m ? &caps : nullptr);
+
+                if (m)
+                    fill_(*m, first, last, res, caps);
+
+                return res;
+            }
+
+            template<class BidirectionalIterator, class Allocator>
+            static void set_begin(match_results<BidirectionalIterator, Allocator>& m,
+                                  BidirectionalIterator begin,
+                                  BidirectionalIterator prefix_first)
+            {
+                m.begin_ = begin;
+                m.prefix_.first = prefix_first;
+                m.prefix_.matched = m.prefix_.first != m.prefix_.second;
+            }
+
+            template<class BidirectionalIterator, class Allocator>
+            static void fill_(match_results<BidirectionalIterator, Allocator>& m,
+                              BidirectionalIterator first, BidirectionalIterator last,
+                              bool matched, const vector<size_t>& caps)
+            {
+                using sub_type = sub_match<BidirectionalIterator>;
+
+                m.ready_ = true;
+                m.begin_ = first;
+                m.unmatched_ = sub_type{};
+                m.unmatched_.first = last;
+                m.unmatched_.second = last;
+
+                m.subs_.clear();
+                if (!matched)
+                {
+                    m.prefix_ = m.unmatched_;
+                    m.suffix_ = m.unmatched_;
+
+                    return;
+                }
+
+                m.subs_.resize(caps.size() / 2);
+
+                /**
+                 * The offsets are increasing in most patterns,
+                 * so walk from the previous submatch start to
+                 * keep it cheap for non random access iterators.
+                 */
+                auto it = first;
+                size_t off{};
+                auto seek = [&](size_t target){
+                    if (target < off)
+                    {
+                        it = first;
+                        off = 0;
+                    }
+
+                    std::advance(it, target - off);
+                    off = target;
+
+                    return it;
+                };
+
+                for (size_t i = 0; i < m.subs_.size(); ++i)
+                {
+                    auto& sub = m.subs_[i];
+                    if (caps[2 * i] == regex_npos || caps[2 * i + 1] == regex_npos)
+                    {
+                        sub.first = last;
+                        sub.second = last;
+                        sub.matched = false;
+                    }
+                    else
+                    {
+                        sub.first = seek(caps[2 * i]);
+                        sub.second = seek(caps[2 * i + 1]);
+                        sub.matched = true;
+                        seek(caps[2 * i]);
+                    }
+                }
+
+                m.prefix_.first = first;
+                m.prefix_.second = m.subs_[0].first;
+                m.prefix_.matched = m.prefix_.first != m.prefix_.second;
+
+                m.suffix_.first = m.subs_[0].second;
+                m.suffix_.second = last;
+                m.suffix_.matched = m.suffix_.first != m.suffix_.second;
+            }
+        };
+    }
+
+    /**
+     * 28.11.2, function template regex_match:
+     */
+
+    template<class BidirectionalIterator, class Allocator, class charT, class traits>
+    bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
+                     match_results<BidirectionalIterator, Allocator>& m,
+                     const basic_regex<charT, traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_access::execute(first, last, &m, e, flags, false);
+    }
+
+    template<class BidirectionalIterator, class charT, class traits>
+    bool regex_match(BidirectionalIterator first, BidirectionalIterator last,
+                     const basic_regex<charT, traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_access::execute(
+            first, last, static_cast<match_results<BidirectionalIterator>*>(nullptr),
+            e, flags, false
+        );
+    }
+
+    template<class charT, class Allocator, class traits>
+    bool regex_match(const charT* str, match_results<const charT*, Allocator>& m,
+                     const basic_regex<charT, traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str, str + char_traits<charT>::length(str), m, e, flags);
+    }
+
+    template<class ST, class SA, class Allocator, class charT, class traits>
+    bool regex_match(const basic_string<charT, ST, SA>& str,
+                     match_results<typename basic_string<charT, ST, SA>::const_iterator,
+                                   Allocator>& m,
+                     const basic_regex<charT, traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str.begin(), str.end(), m, e, flags);
+    }
+
+    template<class ST, class SA, class Allocator, class charT, class traits>
+    bool regex_match(const basic_string<charT, ST, SA>&&,
+                     match_results<typename basic_string<charT, ST, SA>::const_iterator,
+                                   Allocator>&,
+                     const basic_regex<charT, traits>&,
+                     regex_constants::match_flag_type = regex_constants::match_default) = delete;
+
+    template<class charT, class traits>
+    bool regex_match(const charT* str, const basic_regex<charT, traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str, str + char_traits<charT>::length(str), e, flags);
+    }
+
+    template<class ST, class SA, class charT, class traits>
+    bool regex_match(const basic_string<charT, ST, SA>& str,
+                     const basic_regex<charT, traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str.begin(), str.end(), e, flags);
+    }
+
+    /**
+     * 28.11.3, function template regex_search:
+     */
+
+    template<class BidirectionalIterator, class Allocator, class charT, class traits>
+    bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
+                      match_results<BidirectionalIterator, Allocator>& m,
+                      const basic_regex<charT, traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_access::execute(first, last, &m, e, flags, true);
+    }
+
+    template<class BidirectionalIterator, class charT, class traits>
+    bool regex_search(BidirectionalIterator first, BidirectionalIterator last,
+                      const basic_regex<charT, traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_access::execute(
+            first, last, static_cast<match_results<BidirectionalIterator>*>(nullptr),
+            e, flags, true
+        );
+    }
+
+    template<class charT, class Allocator, class traits>
+    bool regex_search(const charT* str, match_results<const charT*, Allocator>& m,
+                      const basic_regex<charT, traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str, str + char_traits<charT>::length(str), m, e, flags);
+    }
+
+    template<class charT, class traits>
+    bool regex_search(const charT* str, const basic_regex<charT, traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str, str + char_traits<charT>::length(str), e, flags);
+    }
+
+    template<class ST, class SA, class charT, class traits>
+    bool regex_search(const basic_string<charT, ST, SA>& str,
+                      const basic_regex<charT, traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str.begin(), str.end(), e, flags);
+    }
+
+    template<class ST, class SA, class Allocator, class charT, class traits>
+    bool regex_search(const basic_string<charT, ST, SA>& str,
+                      match_results<typename basic_string<charT, ST, SA>::const_iterator,
+                                    Allocator>& m,
+                      const basic_regex<charT, traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str.begin(), str.end(), m, e, flags);
+    }
+
+    template<class ST, class SA, class Allocator, class charT, class traits>
+    bool regex_search(const basic_string<charT, ST, SA>&&,
+                      match_results<typename basic_string<charT, ST, SA>::const_iterator,
+                                    Allocator>&,
+                      const basic_regex<charT, traits>&,
+                      regex_constants::match_flag_type = regex_constants::match_default) = delete;
+
+    /**
+     * 28.12.1, class template regex_iterator:
+     */
+
+    template<
+        class BidirectionalIterator,
+        class charT = typename iterator_traits<BidirectionalIterator>::value_type,
+        class traits = regex_traits<charT>
+    >
+    class regex_iterator
+    {
+        public:
+            using regex_type        = basic_regex<charT, traits>;
+            using value_type        = match_results<BidirectionalIterator>;
+            using difference_type   = ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = const value_type&;
+            using iterator_category = forward_iterator_tag;
+
+            regex_iterator()
+                : begin_{}, end_{}, regex_{}, flags_{}, match_{}
+            { /* DUMMY BODY */ }
+
+            regex_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                           const regex_type& re,
+                           regex_constants::match_flag_type flags = regex_constants::match_default)
+                : begin_{first}, end_{last}, regex_{&re}, flags_{flags}, match_{}
+            {
+                if (!regex_search(begin_, end_, match_, *regex_, flags_))
+                    regex_ = nullptr;
+            }
+
+            regex_iterator(BidirectionalIterator, BidirectionalIterator, const regex_type&&,
+                           regex_constants::match_flag_type = regex_constants::match_default) = delete;
+
+            regex_iterator(const regex_iterator&) = default;
+
+            regex_iterator& operator=(const regex_iterator&) = default;
+
+            bool operator==(const regex_iterator& other) const
+            {
+                if (!regex_ || !other.regex_)
+                    return !regex_ && !other.regex_;
+
+                return begin_ == other.begin_ && end_ == other.end_ &&
+                       regex_ == other.regex_ && flags_ == other.flags_ &&
+                       match_[0] == other.match_[0];
+            }
+
+            bool operator!=(const regex_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+            const value_type& operator*() const
+            {
+                return match_;
+            }
+
+            const value_type* operator->() const
+            {
+                return &match_;
+            }
+
+            regex_iterator& operator++()
+            {
+                auto start = match_[0].second;
+                auto prev_end = start;
+
+                if (match_[0].first == match_[0].second)
+                {
+                    /**
+                     * An empty match, first try a non empty one
+                     * at the same position, then move on to avoid
+                     * matching the same empty string forever.
+                     */
+                    if (start == end_)
+                    {
+                        regex_ = nullptr;
+                        return *this;
+                    }
+
+                    auto flags = flags_ | regex_constants::match_not_null |
+                                 regex_constants::match_continuous;
+                    if (start != begin_)
+                        flags |= regex_constants::match_prev_avail;
+
+                    if (regex_search(start, end_, match_, *regex_, flags))
+                    {
+                        aux::regex_access::set_begin(match_, begin_, prev_end);
+                        return *this;
+                    }
+
+                    ++start;
+                }
+
+                flags_ |= regex_constants::match_prev_avail;
+                if (regex_search(start, end_, match_, *regex_, flags_))
+                    aux::regex_access::set_begin(match_, begin_, prev_end);
+                else
+                    regex_ = nullptr;
+
+                return *this;
+            }
+
+            regex_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+        private:
+            BidirectionalIterator begin_;
+            BidirectionalIterator end_;
+            const regex_type* regex_;
+            regex_constants::match_flag_type flags_;
+            value_type match_;
+    };
+
+    using cregex_iterator  = regex_iterator<const char*>;
+    using wcregex_iterator = regex_iterator<const wchar_t*>;
+    using sregex_iterator  = regex_iterator<string::const_iterator>;
+    using wsregex_iterator = regex_iterator<wstring::const_iterator>;
+
+    /**
+     * 28.12.2, class template regex_token_iterator:
+     */
+
+    template<
+        class BidirectionalIterator,
+        class charT = typename iterator_traits<BidirectionalIterator>::value_type,
+        class traits = regex_traits<charT>
+    >
+    class regex_token_iterator
+    {
+        public:
+            using regex_type        = basic_regex<charT, traits>;
+            using value_type        = sub_match<BidirectionalIterator>;
+            using difference_type   = ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = const value_type&;
+            using iterator_category = forward_iterator_tag;
+
+            regex_token_iterator()
+                : position_{}, result_{}, suffix_{}, n_{}, subs_{}
+            { /* DUMMY BODY */ }
+
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, int submatch = 0,
+                                 regex_constants::match_flag_type flags =
+                                    regex_constants::match_default)
+                : regex_token_iterator{first, last, re, vector<int>{submatch}, flags}
+            { /* DUMMY BODY */ }
+
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, const vector<int>& submatches,
+                                 regex_constants::match_flag_type flags =
+                                    regex_constants::match_default)
+                : position_{first, last, re, flags}, result_{}, suffix_{},
+                  n_{}, subs_{submatches}
+            {
+                init_(first, last);
+            }
+
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, initializer_list<int> submatches,
+                                 regex_constants::match_flag_type flags =
+                                    regex_constants::match_default)
+                : regex_token_iterator{first, last, re, vector<int>(submatches), flags}
+            { /* DUMMY BODY */ }
+
+            template<size_t N>
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, const int (&submatches)[N],
+                                 regex_constants::match_flag_type flags =
+                                    regex_constants::match_default)
+                : regex_token_iterator{
+                    first, last, re, vector<int>(submatches, submatches + N), flags
+                  }
+            { /* DUMMY BODY */ }
+
+            regex_token_iterator(BidirectionalIterator, BidirectionalIterator,
+                                 const regex_type&&, int = 0,
+                                 regex_constants::match_flag_type =
+                                    regex_constants::match_default) = delete;
+
+            regex_token_iterator(const regex_token_iterator& other)
+                : position_{other.position_}, result_{}, suffix_{other.suffix_},
+                  n_{other.n_}, subs_{other.subs_}
+            {
+                result_ = other.result_ == &other.suffix_ ? &suffix_ : other.result_;
+            }
+
+            regex_token_iterator& operator=(const regex_token_iterator& other)
+            {
+                position_ = other.position_;
+                suffix_ = other.suffix_;
+                n_ = other.n_;
+                subs_ = other.subs_;
+                result_ = other.result_ == &other.suffix_ ? &suffix_ : other.result_;
+
+                return *this;
+            }
+
+            bool operator==(const regex_token_iterator& other) const
+            {
+                if (!result_ || !other.result_)
+                    return !result_ && !other.result_;
+
+                if (result_ == &suffix_ || other.result_ == &other.suffix_)
+                {
+                    return result_ == &suffix_ && other.result_ == &other.suffix_ &&
+                           suffix_ == other.suffix_;
+                }
+
+                return position_ == other.position_ && n_ == other.n_ &&
+                       subs_ == other.subs_;
+            }
+
+            bool operator!=(const regex_token_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+            const value_type& operator*() const
+            {
+                return *result_;
+            }
+
+            const value_type* operator->() const
+            {
+                return result_;
+            }
+
+            regex_token_iterator& operator++()
+            {
+                if (!result_)
+                    return *this;
+
+                if (result_ == &suffix_)
+                {
+                    result_ = nullptr;
+                    return *this;
+                }
+
+                auto prev = position_;
+                if (n_ + 1 < subs_.size())
+                {
+                    ++n_;
+                    result_ = current_();
+
+                    return *this;
+                }
+
+                n_ = 0;
+                ++position_;
+                if (position_ != regex_iterator<BidirectionalIterator, charT, traits>{})
+                    result_ = current_();
+                else if (has_minus_one_() && prev->suffix().length() != 0)
+                {
+                    suffix_ = prev->suffix();
+                    result_ = &suffix_;
+                }
+                else
+                    result_ = nullptr;
+
+                return *this;
+            }
+
+            regex_token_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+        private:
+            using position_type = regex_iterator<BidirectionalIterator, charT, traits>;
+
+            position_type position_;
+            const value_type* result_;
+            value_type suffix_;
+            size_t n_;
+            vector<int> subs_;
+
+            const value_type* current_() const
+            {
+                if (subs_[n_] == -1)
+                    return &position_->prefix();
+                else
+                    return &(*position_)[static_cast<size_t>(subs_[n_])];
+            }
+
+            bool has_minus_one_() const
+            {
+                for (auto sub: subs_)
+                {
+                    if (sub == -1)
+                        return true;
+                }
+
+                return false;
+            }
+
+            void init_(BidirectionalIterator first, BidirectionalIterator last)
+            {
+                if (position_ != position_type{})
+                    result_ = current_();
+                else if (has_minus_one_() && first != last)
+                {
+                    // No match at all, the whole input is the suffix.
+                    suffix_.first = first;
+                    suffix_.second = last;
+                    suffix_.matched = true;
+                    result_ = &suffix_;
+                }
+                else
+                    result_ = nullptr;
+            }
+    };
+
+    using cregex_token_iterator  = regex_token_iterator<const char*>;
+    using wcregex_token_iterator = regex_token_iterator<const wchar_t*>;
+    using sregex_token_iterator  = regex_token_iterator<string::const_iterator>;
+    using wsregex_token_iterator = regex_token_iterator<wstring::const_iterator>;
+
+    /**
+     * 28.11.4, function template regex_replace:
+     */
+
+    template<class OutputIterator, class BidirectionalIterator, class traits, class charT>
+    OutputIterator regex_replace(
+        OutputIterator out, BidirectionalIterator first, BidirectionalIterator last,
+        const basic_regex<charT, traits>& e, const charT* fmt,
+        regex_constants::match_flag_type flags = regex_constants::match_default
+    )
+    {
+        using iterator_type = regex_iterator<BidirectionalIterator, charT, traits>;
+
+        auto fmt_last = fmt + char_traits<charT>::length(fmt);
+        bool copy_rest = !(flags & regex_constants::format_no_copy);
+
+        iterator_type it{first, last, e, flags};
+        iterator_type end{};
+        if (it == end)
+        {
+            if (copy_rest)
+                out = copy(first, last, out);
+
+            return out;
+        }
+
+        sub_match<BidirectionalIterator> suffix{};
+        for (; it != end; ++it)
+        {
+            if (copy_rest)
+                out = copy(it->prefix().first, it->prefix().second, out);
+            out = it->format(out, fmt, fmt_last, flags);
+            suffix = it->suffix();
+
+            if (flags & regex_constants::format_first_only)
+                break;
+        }
+
+        if (copy_rest)
+            out = copy(suffix.first, suffix.second, out);
+
+        return out;
+    }
+
+    template<class OutputIterator, class BidirectionalIterator,
+             class traits, class charT, class ST, class SA>
+    OutputIterator regex_replace(
+        OutputIterator out, BidirectionalIterator first, BidirectionalIterator last,
+        const basic_regex<charT, traits>& e, const basic_string<charT, ST, SA>& fmt,
+        regex_constants::match_flag_type flags = regex_constants::match_default
+    )
+    {
+        return regex_replace(out, first, last, e, fmt.c_str(), flags);
+    }
+
+    template<class traits, class charT, class ST, class SA, class FST, class FSA>
+    basic_string<charT, ST, SA> regex_replace(
+        const basic_string<charT, ST, SA>& str, const basic_regex<charT, traits>& e,
+        const basic_string<charT, FST, FSA>& fmt,
+        regex_constants::match_flag_type flags = regex_constants::match_default
+    )
+    {
+        basic_string<charT, ST, SA> res{};
+        regex_replace(back_inserter(res), str.begin(), str.end(), e, fmt.c_str(), flags);
+
+        return res;
+    }
+
+    template<class traits, class charT, class ST, class SA>
+    basic_string<charT, ST, SA> regex_replace(
+        const basic_string<charT, ST, SA>& str, const basic_regex<charT, traits>& e,
+        const charT* fmt,
+        regex_constants::match_flag_type flags = regex_constants::match_default
+    )
+    {
+        basic_string<charT, ST, SA> res{};
+        regex_replace(back_inserter(res), str.begin(), str.end(), e, fmt, flags);
+
+        return res;
+    }
+
+    template<class traits, class charT, class ST, class SA>
+    basic_string<charT> regex_replace(
+        const charT* str, const basic_regex<charT, traits>& e,
+        const basic_string<charT, ST, SA>& fmt,
+        regex_constants::match_flag_type flags = regex_constants::match_default
+    )
+    {
+        basic_string<charT> res{};
+        regex_replace(back_inserter(res), str, str + char_traits<charT>::length(str),
+                      e, fmt.c_str(), flags);
+
+        return res;
+    }
+
+    template<class traits, class charT>
+    basic_string<charT> regex_replace(
+        const charT* str, const basic_regex<charT, traits>& e, const charT* fmt,
+        regex_constants::match_flag_type flags = regex_constants::match_default
+    )
+    {
+        basic_string<charT> res{};
+        regex_replace(back_inserter(res), str, str + char_traits<charT>::length(str),
+                      e, fmt, flags);
+
+        return res;
+    }
+}
 
 #endif
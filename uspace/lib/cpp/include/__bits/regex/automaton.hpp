@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_AUTOMATON
+#define LIBCPP_BITS_REGEX_AUTOMATON
+
+#include <__bits/memory/unique_ptr.hpp>
+#include <__bits/regex/backtrack.hpp>
+#include <__bits/regex/dfa.hpp>
+#include <__bits/regex/nfa.hpp>
+#include <__bits/regex/program.hpp>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Compiled regular expression shared by all copies
+     * of a basic_regex, picks the cheapest engine that
+     * can answer a query:
+     *   1) The lazy DFA rejects inputs without a match
+     *      and finds where the earliest match ends, which
+     *      is all that is needed when submatches are not
+     *      requested and bounds the starts of the Pike VM
+     *      otherwise.
+     *   2) The Pike VM finds the submatches in linear time.
+     *   3) The backtracker handles back references and
+     *      lookaheads.
+     */
+    template<class charT, class traits>
+    class regex_automaton
+    {
+        public:
+            using program_type  = regex_program<charT, traits>;
+            using compiler_type = regex_compiler<charT, traits>;
+            using dfa_type      = regex_dfa<charT, traits>;
+            using flag_type     = regex_constants::match_flag_type;
+
+            regex_automaton(const charT* first, const charT* last,
+                            regex_constants::syntax_option_type flags,
+                            const traits& tr)
+                : prog_{compiler_type{first, last, flags, tr}.compile()},
+                  dfa_{}, dfa_busy_{false}
+            {
+                if (dfa_type::supports(prog_))
+                    dfa_.reset(new dfa_type{prog_});
+            }
+
+            regex_automaton(const regex_automaton&) = delete;
+            regex_automaton& operator=(const regex_automaton&) = delete;
+
+            size_t mark_count() const
+            {
+                return prog_.mark_count;
+            }
+
+            /**
+             * Matches [first, last) (search anywhere in it if
+             * search) and, if caps is not null, stores the
+             * offsets of all submatches from first to it.
+             */
+            template<class BidirectionalIterator>
+            bool execute(BidirectionalIterator first, BidirectionalIterator last,
+                         flag_type flags, bool search, vector<size_t>* caps) const
+            {
+                if (prog_.failed)
+                    return false;
+
+                bool full = !search;
+                bool anchored = full || (flags & regex_constants::match_continuous);
+                if (anchored)
+                    search = false;
+
+                size_t bound{regex_npos};
+
+                /**
+                 * The DFA caches states, so concurrent queries
+                 * on the same regex skip it instead of waiting.
+                 */
+                if (dfa_ && !(flags & regex_constants::match_not_null) && try_lock_dfa_())
+                {
+                    bool bol = !(flags & (regex_constants::match_not_bol |
+                                          regex_constants::match_prev_avail));
+                    bool eol = !(flags & regex_constants::match_not_eol);
+
+                    auto end = dfa_->search(first, last, anchored, full, bol, eol);
+                    unlock_dfa_();
+
+                    if (end == regex_npos)
+                        return false;
+
+                    if (!caps)
+                        return true;
+
+                    if (full && prog_.mark_count == 0)
+                    {
+                        caps->assign(2, 0);
+                        (*caps)[1] = end;
+
+                        return true;
+                    }
+
+                    bound = end;
+                }
+
+                vector<size_t> tmp{};
+                auto& res = caps ? *caps : tmp;
+
+                if (prog_.has_back_references || prog_.has_lookaheads)
+                {
+                    regex_backtracker<charT, traits, BidirectionalIterator> bt{
+                        prog_, first, last, flags, full
+                    };
+
+                    return bt.run(search, res);
+                }
+                else
+                {
+                    regex_pike_vm<charT, traits> vm{prog_};
+
+                    return vm.run(first, last, flags, search, full, bound, res);
+                }
+            }
+
+        private:
+            program_type prog_;
+            unique_ptr<dfa_type> dfa_;
+            mutable bool dfa_busy_;
+
+            bool try_lock_dfa_() const
+            {
+                return !__atomic_exchange_n(&dfa_busy_, true, __ATOMIC_ACQUIRE);
+            }
+
+            void unlock_dfa_() const
+            {
+                __atomic_store_n(&dfa_busy_, false, __ATOMIC_RELEASE);
+            }
+    };
+}
+
+#endif
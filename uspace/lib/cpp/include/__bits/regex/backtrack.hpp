@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_BACKTRACK
+#define LIBCPP_BITS_REGEX_BACKTRACK
+
+#include <__bits/iterator.hpp>
+#include <__bits/regex/program.hpp>
+#include <__bits/trycatch.hpp>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Backtracking matcher, only used for programs that
+     * contain back references or lookaheads, which the
+     * automata cannot simulate. Uses an explicit stack
+     * of choice points and capture restores instead of
+     * recursion (except for lookaheads) and gives up
+     * with error_complexity after a fixed number of
+     * steps.
+     */
+    template<class charT, class traits, class BidirectionalIterator>
+    class regex_backtracker
+    {
+        public:
+            using program_type = regex_program<charT, traits>;
+            using flag_type    = regex_constants::match_flag_type;
+            using iterator     = BidirectionalIterator;
+
+            regex_backtracker(const program_type& prog, iterator first, iterator last,
+                              flag_type flags, bool full)
+                : prog_{prog}, first_{first}, last_{last}, flags_{flags},
+                  full_{full}, slots_{2 * (prog.mark_count + 1) + prog.loop_count},
+                  offsets_(slots_, regex_npos), iterators_(slots_, first),
+                  stack_{}, steps_{}, failed_{false}
+            { /* DUMMY BODY */ }
+
+            bool run(bool search, vector<size_t>& caps)
+            {
+                auto it = first_;
+                for (size_t i = 0; ; ++i, ++it)
+                {
+                    if (!search || !prog_.has_first_chars ||
+                        (it != last_ && prog_.is_first_char(*it)))
+                    {
+                        for (auto& off: offsets_)
+                            off = regex_npos;
+
+                        stack_.clear();
+                        if (run_(0, i, it, stack_))
+                        {
+                            caps.assign(offsets_.begin(),
+                                        offsets_.begin() + 2 * (prog_.mark_count + 1));
+                            return true;
+                        }
+                    }
+
+                    if (!search || failed_ || it == last_)
+                        return false;
+                }
+            }
+
+        private:
+            static constexpr size_t max_steps_{size_t{1} << 24};
+
+            struct frame
+            {
+                /**
+                 * A choice point if slot is regex_npos, otherwise
+                 * a restore of the slot to offset pc and it.
+                 */
+                size_t pc;
+                size_t pos;
+                iterator it;
+                size_t slot;
+            };
+
+            const program_type& prog_;
+            iterator first_;
+            iterator last_;
+            flag_type flags_;
+            bool full_;
+            size_t slots_;
+            vector<size_t> offsets_;
+            vector<iterator> iterators_;
+            vector<frame> stack_;
+            size_t steps_;
+            bool failed_;
+
+            bool holds_(size_t pc, iterator it) const
+            {
+                bool has_prev = it != first_ || (flags_ & regex_constants::match_prev_avail);
+                bool has_cur = it != last_;
+
+                return prog_.assertion_holds(
+                    pc, flags_, has_prev, has_prev ? *std::prev(it) : charT{},
+                    has_cur, has_cur ? *it : charT{}
+                );
+            }
+
+            void set_slot_(vector<frame>& stack, size_t slot, size_t pos, iterator it)
+            {
+                stack.push_back(frame{offsets_[slot], 0, iterators_[slot], slot});
+                offsets_[slot] = pos;
+                iterators_[slot] = it;
+            }
+
+            bool back_reference_(size_t group, size_t& pos, iterator& it) const
+            {
+                if (offsets_[2 * group] == regex_npos || offsets_[2 * group + 1] == regex_npos)
+                    return true; // Unmatched groups match empty.
+
+                auto ref = iterators_[2 * group];
+                auto ref_last = iterators_[2 * group + 1];
+                for (; ref != ref_last; ++ref, ++it, ++pos)
+                {
+                    if (it == last_)
+                        return false;
+
+                    auto a = *ref;
+                    auto b = *it;
+                    if (prog_.icase)
+                    {
+                        a = prog_.tr.translate_nocase(a);
+                        b = prog_.tr.translate_nocase(b);
+                    }
+
+                    if (a != b)
+                        return false;
+                }
+
+                return true;
+            }
+
+            /**
+             * Runs the program from pc at the given position,
+             * returns true when it reaches match (or the end of
+             * a lookahead). On failure the captures are restored.
+             */
+            bool run_(size_t pc, size_t pos, iterator it, vector<frame>& stack)
+            {
+                auto base = stack.size();
+                auto loops = 2 * (prog_.mark_count + 1);
+
+                while (true)
+                {
+                    bool alive{true};
+                    if (++steps_ > max_steps_)
+                    {
+                        if (!failed_)
+                            throw regex_error{regex_constants::error_complexity};
+                        failed_ = true;
+                        alive = false;
+                    }
+
+                    const auto& inst = prog_.code[pc];
+                    switch (alive ? inst.op : regex_opcode::fail)
+                    {
+                        case regex_opcode::character:
+                        case regex_opcode::any:
+                        case regex_opcode::char_set:
+                            if (it != last_ && prog_.consumes(pc, *it))
+                            {
+                                ++it;
+                                ++pos;
+                                ++pc;
+                            }
+                            else
+                                alive = false;
+                            break;
+                        case regex_opcode::split:
+                            stack.push_back(frame{inst.y, pos, it, regex_npos});
+                            pc = inst.x;
+                            break;
+                        case regex_opcode::jump:
+                            pc = inst.x;
+                            break;
+                        case regex_opcode::save:
+                            set_slot_(stack, inst.x, pos, it);
+                            ++pc;
+                            break;
+                        case regex_opcode::loop_enter:
+                            set_slot_(stack, loops + inst.x, pos, it);
+                            ++pc;
+                            break;
+                        case regex_opcode::loop_check:
+                            alive = offsets_[loops + inst.x] != pos;
+                            ++pc;
+                            break;
+                        case regex_opcode::line_begin:
+                        case regex_opcode::line_end:
+                        case regex_opcode::word_boundary:
+                            alive = holds_(pc, it);
+                            ++pc;
+                            break;
+                        case regex_opcode::back_reference:
+                            alive = back_reference_(inst.x, pos, it);
+                            ++pc;
+                            break;
+                        case regex_opcode::lookahead:
+                        {
+                            // Captures of a lookahead are kept, but undone on backtracking.
+                            for (size_t slot = 0; slot < slots_; ++slot)
+                                stack.push_back(frame{offsets_[slot], 0, iterators_[slot], slot});
+
+                            vector<frame> inner{};
+                            bool res = run_(inst.x + 1, pos, it, inner);
+                            if (failed_)
+                                alive = false;
+                            else if (inst.negate)
+                            {
+                                if (res)
+                                    undo_(inner, 0);
+                                alive = !res;
+                            }
+                            else
+                                alive = res;
+                            pc = inst.y;
+                            break;
+                        }
+                        case regex_opcode::lookahead_end:
+                            return true;
+                        case regex_opcode::match:
+                            if (full_ && it != last_)
+                                alive = false;
+                            else if ((flags_ & regex_constants::match_not_null) &&
+                                     pos == offsets_[0])
+                                alive = false;
+                            else
+                                return true;
+                            break;
+                        default:
+                            alive = false;
+                    }
+
+                    if (alive)
+                        continue;
+
+                    // Backtrack to the last choice point.
+                    bool resumed{false};
+                    while (stack.size() > base)
+                    {
+                        auto f = stack.back();
+                        stack.pop_back();
+
+                        if (f.slot != regex_npos)
+                        {
+                            offsets_[f.slot] = f.pc;
+                            iterators_[f.slot] = f.it;
+                        }
+                        else if (!failed_)
+                        {
+                            pc = f.pc;
+                            pos = f.pos;
+                            it = f.it;
+                            resumed = true;
+                            break;
+                        }
+                    }
+
+                    if (!resumed)
+                        return false;
+                }
+            }
+
+            void undo_(vector<frame>& stack, size_t base)
+            {
+                while (stack.size() > base)
+                {
+                    auto f = stack.back();
+                    stack.pop_back();
+
+                    if (f.slot != regex_npos)
+                    {
+                        offsets_[f.slot] = f.pc;
+                        iterators_[f.slot] = f.it;
+                    }
+                }
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_DFA
+#define LIBCPP_BITS_REGEX_DFA
+
+#include <__bits/regex/program.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Lazily built DFA over a regex program. States are
+     * sets of program counters of the consuming instructions
+     * (plus match and $) reached after following all epsilon
+     * transitions and are only built when the input visits
+     * them, each caching its transitions for all 256 bytes.
+     * The DFA only decides whether and where the earliest
+     * match ends, it cannot recover submatches, so it is
+     * only used for byte sized characters and programs
+     * without back references, lookaheads, word boundaries
+     * and multiline anchors (see regex_automaton).
+     */
+    template<class charT, class traits>
+    class regex_dfa
+    {
+        public:
+            using program_type = regex_program<charT, traits>;
+
+            static bool supports(const program_type& prog)
+            {
+                return sizeof(charT) == 1 && !prog.failed &&
+                       !prog.has_back_references && !prog.has_lookaheads &&
+                       !prog.has_word_boundaries && !prog.multiline;
+            }
+
+            explicit regex_dfa(const program_type& prog)
+                : prog_{prog}, marks_(prog.code.size(), 0),
+                  mark_gen_{}, stack_{}
+            { /* DUMMY BODY */ }
+
+            /**
+             * Returns the length of the shortest prefix of the
+             * input that ends a match, or regex_npos. If full,
+             * the match has to end at last. If !anchored, the
+             * matches can start anywhere in the input. The bol
+             * and eol flags say whether ^ and $ can match at the
+             * begining and the end of the input, respectively.
+             */
+            template<class BidirectionalIterator>
+            size_t search(BidirectionalIterator first, BidirectionalIterator last,
+                          bool anchored, bool full, bool bol, bool eol)
+            {
+                auto& c = caches_[anchored ? 0 : 1];
+                auto cur = start_(c, bol);
+
+                size_t len{};
+                if (!full && c.states[cur].accepting)
+                    return 0;
+
+                for (; first != last; ++first, ++len)
+                {
+                    auto b = static_cast<unsigned char>(*first);
+                    auto next = c.states[cur].next[b];
+                    if (next < 0)
+                        next = step_(c, cur, b, !anchored);
+                    cur = static_cast<size_t>(next);
+
+                    if (anchored && c.states[cur].pcs.empty())
+                        return regex_npos;
+
+                    if (!full && c.states[cur].accepting)
+                        return len + 1;
+                }
+
+                if (accepts_at_end_(c.states[cur], eol))
+                    return len;
+                else
+                    return regex_npos;
+            }
+
+        private:
+            struct state
+            {
+                /**
+                 * Sorted, if the state was built at the
+                 * beginning of the input with ^ allowed,
+                 * it ends with regex_npos.
+                 */
+                vector<size_t> pcs;
+                bool accepting;
+                int8_t accepts_at_end;
+                int32_t next[256];
+            };
+
+            struct cache
+            {
+                vector<state> states{};
+                vector<vector<size_t>> buckets{};
+                int32_t start[2]{-1, -1};
+            };
+
+            /**
+             * Upper bound for the number of states, when reached
+             * the cache is flushed, which keeps the worst case
+             * memory small while still making the common case
+             * table driven.
+             */
+            static constexpr size_t max_states_{512};
+            static constexpr size_t bucket_count_{256};
+
+            const program_type& prog_;
+            cache caches_[2];
+            vector<size_t> marks_;
+            size_t mark_gen_;
+            vector<size_t> stack_;
+
+            /**
+             * Adds the epsilon closure of the instructions
+             * on stack_ to pcs. The bol flag tells whether
+             * ^ holds, eol tells whether $ holds, if not,
+             * $ is kept in the set for acceptance at the
+             * end of the input.
+             */
+            void closure_(vector<size_t>& pcs, bool bol, bool eol)
+            {
+                while (!stack_.empty())
+                {
+                    auto pc = stack_.back();
+                    stack_.pop_back();
+
+                    if (marks_[pc] == mark_gen_)
+                        continue;
+                    marks_[pc] = mark_gen_;
+
+                    const auto& inst = prog_.code[pc];
+                    switch (inst.op)
+                    {
+                        case regex_opcode::split:
+                            stack_.push_back(inst.y);
+                            stack_.push_back(inst.x);
+                            break;
+                        case regex_opcode::jump:
+                            stack_.push_back(inst.x);
+                            break;
+                        case regex_opcode::save:
+                        case regex_opcode::loop_enter:
+                        case regex_opcode::loop_check:
+                            stack_.push_back(pc + 1);
+                            break;
+                        case regex_opcode::line_begin:
+                            if (bol)
+                                stack_.push_back(pc + 1);
+                            break;
+                        case regex_opcode::line_end:
+                            if (eol)
+                                stack_.push_back(pc + 1);
+                            else
+                                pcs.push_back(pc);
+                            break;
+                        case regex_opcode::fail:
+                            break;
+                        default:
+                            pcs.push_back(pc);
+                    }
+                }
+            }
+
+            void new_closure_()
+            {
+                if (++mark_gen_ == 0)
+                {
+                    for (auto& mark: marks_)
+                        mark = 0;
+                    mark_gen_ = 1;
+                }
+            }
+
+            static size_t hash_(const vector<size_t>& pcs)
+            {
+                size_t res{pcs.size()};
+                for (auto pc: pcs)
+                    res = res * 31 + pc;
+
+                return res % bucket_count_;
+            }
+
+            void flush_(cache& c)
+            {
+                c.states.clear();
+                c.buckets.clear();
+                c.start[0] = -1;
+                c.start[1] = -1;
+            }
+
+            size_t intern_(cache& c, vector<size_t>&& pcs)
+            {
+                if (c.buckets.empty())
+                    c.buckets.resize(bucket_count_);
+
+                auto& bucket = c.buckets[hash_(pcs)];
+                for (auto idx: bucket)
+                {
+                    const auto& other = c.states[idx].pcs;
+                    if (other.size() == pcs.size() &&
+                        equal(other.begin(), other.end(), pcs.begin()))
+                        return idx;
+                }
+
+                c.states.emplace_back();
+                auto& st = c.states.back();
+                st.accepting = false;
+                st.accepts_at_end = -1;
+                for (auto& next: st.next)
+                    next = -1;
+
+                for (auto pc: pcs)
+                {
+                    if (pc != regex_npos && prog_.code[pc].op == regex_opcode::match)
+                        st.accepting = true;
+                }
+                st.pcs = move(pcs);
+
+                auto idx = c.states.size() - 1;
+                bucket.push_back(idx);
+
+                return idx;
+            }
+
+            void sort_(vector<size_t>& pcs)
+            {
+                // The sets are small, insertion sort suffices.
+                for (size_t i = 1; i < pcs.size(); ++i)
+                {
+                    auto pc = pcs[i];
+                    auto j = i;
+                    for (; j > 0 && pcs[j - 1] > pc; --j)
+                        pcs[j] = pcs[j - 1];
+                    pcs[j] = pc;
+                }
+            }
+
+            size_t start_(cache& c, bool bol)
+            {
+                if (c.start[bol] >= 0)
+                    return static_cast<size_t>(c.start[bol]);
+
+                if (c.states.size() >= max_states_)
+                    flush_(c);
+
+                vector<size_t> pcs{};
+                new_closure_();
+                stack_.push_back(0);
+                closure_(pcs, bol, false);
+                sort_(pcs);
+                if (bol)
+                    pcs.push_back(regex_npos);
+
+                auto res = intern_(c, move(pcs));
+                c.start[bol] = static_cast<int32_t>(res);
+
+                return res;
+            }
+
+            int32_t step_(cache& c, size_t cur, unsigned char b, bool restart)
+            {
+                vector<size_t> pcs{};
+                new_closure_();
+
+                const auto& from = c.states[cur].pcs;
+                for (auto it = from.rbegin(); it != from.rend(); ++it)
+                {
+                    auto pc = *it;
+                    if (pc == regex_npos)
+                        continue;
+
+                    if (program_type::is_consuming(prog_.code[pc].op) &&
+                        prog_.consumes(pc, static_cast<charT>(b)))
+                        stack_.push_back(pc + 1);
+                }
+
+                // Matches can start at any position when searching.
+                if (restart)
+                    stack_.push_back(0);
+                closure_(pcs, false, false);
+                sort_(pcs);
+
+                bool flushed{false};
+                if (c.states.size() >= max_states_)
+                {
+                    flush_(c);
+                    flushed = true;
+                }
+
+                auto res = static_cast<int32_t>(intern_(c, move(pcs)));
+                if (!flushed)
+                    c.states[cur].next[b] = res;
+
+                return res;
+            }
+
+            bool accepts_at_end_(state& st, bool eol)
+            {
+                if (st.accepting || !eol)
+                    return st.accepting;
+
+                if (st.accepts_at_end < 0)
+                {
+                    bool bol = !st.pcs.empty() && st.pcs.back() == regex_npos;
+
+                    vector<size_t> pcs{};
+                    new_closure_();
+                    for (auto pc: st.pcs)
+                    {
+                        if (pc != regex_npos && prog_.code[pc].op == regex_opcode::line_end)
+                            stack_.push_back(pc + 1);
+                    }
+                    closure_(pcs, bol, true);
+
+                    st.accepts_at_end = 0;
+                    for (auto pc: pcs)
+                    {
+                        if (prog_.code[pc].op == regex_opcode::match)
+                            st.accepts_at_end = 1;
+                    }
+                }
+
+                return st.accepts_at_end == 1;
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_NFA
+#define LIBCPP_BITS_REGEX_NFA
+
+#include <__bits/iterator.hpp>
+#include <__bits/regex/program.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Pike VM, simulates the NFA of a regex program on all
+     * paths at once while keeping the threads ordered by
+     * priority, which gives the leftmost-first (ECMAScript)
+     * submatches in O(n * m) time for any input.
+     * Note: Captures are kept as offsets from the start of
+     *       the input, regex_npos marks unmatched groups.
+     */
+    template<class charT, class traits>
+    class regex_pike_vm
+    {
+        public:
+            using program_type = regex_program<charT, traits>;
+            using flag_type    = regex_constants::match_flag_type;
+
+            explicit regex_pike_vm(const program_type& prog)
+                : prog_{prog}, slots_{2 * (prog.mark_count + 1) + prog.loop_count},
+                  lists_{thread_list{prog, slots_}, thread_list{prog, slots_}},
+                  work_(slots_, regex_npos), stack_{}
+            { /* DUMMY BODY */ }
+
+            /**
+             * Runs the program over [first, last), if search,
+             * a match can start at any offset up to bound,
+             * if full, the match has to end at last. On success
+             * caps holds the capture offsets.
+             */
+            template<class BidirectionalIterator>
+            bool run(BidirectionalIterator first, BidirectionalIterator last,
+                     flag_type flags, bool search, bool full, size_t bound,
+                     vector<size_t>& caps)
+            {
+                auto* clist = &lists_[0];
+                auto* nlist = &lists_[1];
+                clist->clear();
+
+                bool matched{false};
+                bool not_null = (flags & regex_constants::match_not_null) != 0;
+
+                auto it = first;
+                size_t i{};
+
+                context ctx{};
+                ctx.has_prev = (flags & regex_constants::match_prev_avail) != 0;
+                if (ctx.has_prev)
+                    ctx.prev = *std::prev(first);
+                ctx.has_cur = it != last;
+                if (ctx.has_cur)
+                    ctx.cur = *it;
+
+                while (true)
+                {
+                    if (!matched && (i == 0 || search) && i <= bound)
+                    {
+                        if (search && clist->pcs.empty() && prog_.has_first_chars)
+                        {
+                            // Nothing alive, skip to a possible start of a match.
+                            while (it != last && i < bound && !prog_.is_first_char(*it))
+                            {
+                                ctx.prev = *it;
+                                ctx.has_prev = true;
+                                ++it;
+                                ++i;
+                            }
+
+                            // Matches are not empty when there are first chars.
+                            ctx.has_cur = it != last;
+                            if (!ctx.has_cur)
+                                break;
+                            ctx.cur = *it;
+                        }
+
+                        for (auto& slot: work_)
+                            slot = regex_npos;
+                        add_(*clist, 0, i, flags, ctx);
+                    }
+
+                    if (clist->pcs.empty())
+                    {
+                        if (matched || !search || i >= bound || it == last)
+                            break;
+                    }
+
+                    nlist->clear();
+
+                    context next_ctx{};
+                    if (ctx.has_cur)
+                    {
+                        next_ctx.has_prev = true;
+                        next_ctx.prev = ctx.cur;
+
+                        auto next_it = std::next(it);
+                        next_ctx.has_cur = next_it != last;
+                        if (next_ctx.has_cur)
+                            next_ctx.cur = *next_it;
+                    }
+
+                    for (size_t k = 0; k < clist->pcs.size(); ++k)
+                    {
+                        auto pc = clist->pcs[k];
+                        const auto* thread_caps = clist->caps_of(pc);
+                        const auto& inst = prog_.code[pc];
+
+                        if (inst.op == regex_opcode::match)
+                        {
+                            if ((full && ctx.has_cur) || (not_null && thread_caps[0] == i))
+                                continue;
+
+                            caps.assign(thread_caps, thread_caps + 2 * (prog_.mark_count + 1));
+                            matched = true;
+
+                            // Lower priority threads are cut off.
+                            break;
+                        }
+
+                        if (ctx.has_cur && prog_.consumes(pc, ctx.cur))
+                        {
+                            memcpy(work_.data(), thread_caps, slots_ * sizeof(size_t));
+                            add_(*nlist, pc + 1, i + 1, flags, next_ctx);
+                        }
+                    }
+
+                    if (!ctx.has_cur)
+                        break;
+
+                    swap(clist, nlist);
+                    ctx = next_ctx;
+                    ++it;
+                    ++i;
+                }
+
+                return matched;
+            }
+
+        private:
+            struct context
+            {
+                bool has_prev;
+                charT prev;
+                bool has_cur;
+                charT cur;
+            };
+
+            struct thread_list
+            {
+                thread_list(const program_type& prog, size_t slots)
+                    : pcs{}, marks(prog.code.size(), 0), gen{},
+                      caps(prog.code.size() * slots), slots{slots}
+                { /* DUMMY BODY */ }
+
+                void clear()
+                {
+                    pcs.clear();
+                    if (++gen == 0)
+                    {
+                        for (auto& mark: marks)
+                            mark = 0;
+                        gen = 1;
+                    }
+                }
+
+                size_t* caps_of(size_t pc)
+                {
+                    return caps.data() + pc * slots;
+                }
+
+                vector<size_t> pcs;
+                vector<size_t> marks;
+                size_t gen;
+                vector<size_t> caps;
+                size_t slots;
+            };
+
+            struct entry
+            {
+                // Either a pc to explore or a slot to restore.
+                size_t pc;
+                size_t slot;
+                size_t value;
+            };
+
+            const program_type& prog_;
+            size_t slots_;
+            thread_list lists_[2];
+            vector<size_t> work_;
+            vector<entry> stack_;
+
+            /**
+             * Adds the thread at pc with captures in work_
+             * and all threads reachable from it by epsilon
+             * transitions at offset i to the list, in priority
+             * order. Threads already on the list have higher
+             * priority, so they are kept.
+             */
+            void add_(thread_list& list, size_t pc, size_t i,
+                      flag_type flags, const context& ctx)
+            {
+                auto loops = 2 * (prog_.mark_count + 1);
+
+                stack_.push_back(entry{pc, regex_npos, 0});
+                while (!stack_.empty())
+                {
+                    auto e = stack_.back();
+                    stack_.pop_back();
+
+                    if (e.slot != regex_npos)
+                    {
+                        work_[e.slot] = e.value;
+                        continue;
+                    }
+
+                    pc = e.pc;
+                    while (list.marks[pc] != list.gen)
+                    {
+                        list.marks[pc] = list.gen;
+
+                        const auto& inst = prog_.code[pc];
+                        bool alive{true};
+                        switch (inst.op)
+                        {
+                            case regex_opcode::character:
+                            case regex_opcode::any:
+                            case regex_opcode::char_set:
+                            case regex_opcode::match:
+                                list.pcs.push_back(pc);
+                                memcpy(list.caps_of(pc), work_.data(), slots_ * sizeof(size_t));
+                                alive = false;
+                                break;
+                            case regex_opcode::split:
+                                stack_.push_back(entry{inst.y, regex_npos, 0});
+                                pc = inst.x;
+                                break;
+                            case regex_opcode::jump:
+                                pc = inst.x;
+                                break;
+                            case regex_opcode::save:
+                                stack_.push_back(entry{0, inst.x, work_[inst.x]});
+                                work_[inst.x] = i;
+                                ++pc;
+                                break;
+                            case regex_opcode::loop_enter:
+                                stack_.push_back(entry{0, loops + inst.x, work_[loops + inst.x]});
+                                work_[loops + inst.x] = i;
+                                ++pc;
+                                break;
+                            case regex_opcode::loop_check:
+                                // Empty iterations are rejected.
+                                alive = work_[loops + inst.x] != i;
+                                ++pc;
+                                break;
+                            case regex_opcode::line_begin:
+                            case regex_opcode::line_end:
+                            case regex_opcode::word_boundary:
+                                alive = prog_.assertion_holds(
+                                    pc, flags, ctx.has_prev, ctx.prev, ctx.has_cur, ctx.cur
+                                );
+                                ++pc;
+                                break;
+                            default:
+                                alive = false;
+                        }
+
+                        if (!alive)
+                            break;
+                    }
+                }
+            }
+    };
+}
+
+#endif
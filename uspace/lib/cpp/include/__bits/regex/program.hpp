@@ -0,0 +1,1231 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_PROGRAM
+#define LIBCPP_BITS_REGEX_PROGRAM
+
+#include <__bits/regex/constants.hpp>
+#include <__bits/regex/traits.hpp>
+#include <__bits/trycatch.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Regular expressions are compiled into a program for
+     * a Thompson style NFA. The same program is executed
+     * by the lazy DFA, the Pike VM and the backtracking
+     * matcher, each of them supporting a different subset
+     * of the instructions (see regex_automaton).
+     */
+
+    enum class regex_opcode: uint8_t
+    {
+        character,        // Consumes ch.
+        any,              // Consumes anything but a line terminator.
+        char_set,         // Consumes a character from sets[x].
+        split,            // Continues at x, then at y.
+        jump,             // Continues at x.
+        save,             // Stores position to capture slot x.
+        line_begin,       // Assertion ^.
+        line_end,         // Assertion $.
+        word_boundary,    // Assertion \b, or \B if negate.
+        back_reference,   // Consumes text of group x.
+        loop_enter,       // Stores position to loop slot x.
+        loop_check,       // Fails if loop slot x holds the position.
+        lookahead,        // Runs x + 1 as a lookahead, continues at y.
+        lookahead_end,    // Ends a lookahead successfully.
+        match,
+        fail
+    };
+
+    template<class charT>
+    struct regex_instruction
+    {
+        regex_opcode op;
+        bool negate;
+        charT ch;
+        size_t x;
+        size_t y;
+    };
+
+    inline constexpr size_t regex_npos = static_cast<size_t>(-1);
+
+    template<class charT>
+    bool regex_is_line_terminator(charT c)
+    {
+        return c == charT('\n') || c == charT('\r');
+    }
+
+    template<class charT, class traits>
+    bool regex_is_word(const traits& tr, charT c)
+    {
+        static const auto cls = tr.lookup_classname("w", "w" + 1);
+
+        return tr.isctype(c, cls);
+    }
+
+    /**
+     * Bracket expression, translated to lower case
+     * when compiled with icase. Single byte character
+     * types get a bitmap so that testing membership
+     * costs a single lookup.
+     */
+    template<class charT, class traits>
+    class regex_char_set
+    {
+        public:
+            using class_type = typename traits::char_class_type;
+
+            regex_char_set()
+                : chars_{}, ranges_{}, classes_{},
+                  negated_classes_{}, negated_{false}, bitmap_{}
+            { /* DUMMY BODY */ }
+
+            void add(charT c)
+            {
+                chars_.push_back(c);
+            }
+
+            void add_range(charT low, charT high)
+            {
+                ranges_.emplace_back(low, high);
+            }
+
+            void add_class(class_type cls, bool negated)
+            {
+                if (negated)
+                    negated_classes_.push_back(cls);
+                else
+                    classes_ |= cls;
+            }
+
+            void negate()
+            {
+                negated_ = !negated_;
+            }
+
+            void finish(const traits& tr, bool icase)
+            {
+                if constexpr (sizeof(charT) == 1)
+                {
+                    for (size_t i = 0; i < 256; ++i)
+                    {
+                        auto c = static_cast<charT>(i);
+                        if (test_slow_(tr, icase, c))
+                            bitmap_[i / 64] |= uint64_t{1} << (i % 64);
+                    }
+                }
+            }
+
+            bool test(const traits& tr, bool icase, charT c) const
+            {
+                if constexpr (sizeof(charT) == 1)
+                {
+                    auto i = static_cast<unsigned char>(c);
+
+                    return (bitmap_[i / 64] >> (i % 64)) & 1;
+                }
+                else
+                    return test_slow_(tr, icase, c);
+            }
+
+        private:
+            vector<charT> chars_;
+            vector<pair<charT, charT>> ranges_;
+            class_type classes_;
+            vector<class_type> negated_classes_;
+            bool negated_;
+            uint64_t bitmap_[4];
+
+            bool test_slow_(const traits& tr, bool icase, charT c) const
+            {
+                if (icase)
+                    c = tr.translate_nocase(c);
+
+                bool res = tr.isctype(c, classes_);
+                for (size_t i = 0; !res && i < chars_.size(); ++i)
+                    res = chars_[i] == c;
+                for (size_t i = 0; !res && i < ranges_.size(); ++i)
+                    res = ranges_[i].first <= c && c <= ranges_[i].second;
+                for (size_t i = 0; !res && i < negated_classes_.size(); ++i)
+                    res = !tr.isctype(c, negated_classes_[i]);
+
+                return res != negated_;
+            }
+    };
+
+    template<class charT, class traits>
+    struct regex_program
+    {
+        using instruction_type = regex_instruction<charT>;
+        using char_set_type    = regex_char_set<charT, traits>;
+
+        vector<instruction_type> code{};
+        vector<char_set_type> sets{};
+        traits tr{};
+        size_t mark_count{};
+        size_t loop_count{};
+        bool icase{};
+        bool multiline{};
+        bool has_back_references{};
+        bool has_lookaheads{};
+        bool has_word_boundaries{};
+        bool failed{};
+
+        /**
+         * Bytes that can start a match, used to skip
+         * ahead in searches. Empty if a match can
+         * start with anything or be empty.
+         */
+        bool has_first_chars{};
+        uint64_t first_chars[4]{};
+
+        bool is_first_char(charT c) const
+        {
+            auto i = static_cast<unsigned char>(c);
+
+            return (first_chars[i / 64] >> (i % 64)) & 1;
+        }
+
+        /**
+         * Tests whether the consuming instruction
+         * at pc accepts the character c.
+         */
+        bool consumes(size_t pc, charT c) const
+        {
+            const auto& inst = code[pc];
+            switch (inst.op)
+            {
+                case regex_opcode::character:
+                    return inst.ch == (icase ? tr.translate_nocase(c) : c);
+                case regex_opcode::any:
+                    return !regex_is_line_terminator(c);
+                case regex_opcode::char_set:
+                    return sets[inst.x].test(tr, icase, c);
+                default:
+                    return false;
+            }
+        }
+
+        static bool is_consuming(regex_opcode op)
+        {
+            return op == regex_opcode::character ||
+                   op == regex_opcode::any ||
+                   op == regex_opcode::char_set;
+        }
+
+        /**
+         * Evaluates the assertion at pc, prev and cur are the
+         * characters around the position if has_prev and
+         * has_cur, respectively.
+         */
+        bool assertion_holds(size_t pc, regex_constants::match_flag_type flags,
+                             bool has_prev, charT prev, bool has_cur, charT cur) const
+        {
+            const auto& inst = code[pc];
+            switch (inst.op)
+            {
+                case regex_opcode::line_begin:
+                    if (!has_prev)
+                        return !(flags & regex_constants::match_not_bol);
+                    return multiline && regex_is_line_terminator(prev);
+                case regex_opcode::line_end:
+                    if (!has_cur)
+                        return !(flags & regex_constants::match_not_eol);
+                    return multiline && regex_is_line_terminator(cur);
+                case regex_opcode::word_boundary:
+                {
+                    bool prev_word = has_prev && regex_is_word(tr, prev);
+                    bool cur_word = has_cur && regex_is_word(tr, cur);
+
+                    bool res = prev_word != cur_word;
+                    if (!has_prev && (flags & regex_constants::match_not_bow))
+                        res = false;
+                    if (!has_cur && (flags & regex_constants::match_not_eow))
+                        res = false;
+
+                    return res != inst.negate;
+                }
+                default:
+                    return false;
+            }
+        }
+    };
+
+    /**
+     * Recursive descent parser of the ECMAScript grammar
+     * (ECMA-262 15.10 as modified by 28.13) that builds
+     * a syntax tree, which is then emitted as a program.
+     * Note: As exceptions are not supported yet, errors
+     *       set failed_ and the parse unwinds, the result
+     *       is a program that never matches.
+     */
+    template<class charT, class traits>
+    class regex_compiler
+    {
+        public:
+            using program_type = regex_program<charT, traits>;
+            using flag_type    = regex_constants::syntax_option_type;
+
+            regex_compiler(const charT* first, const charT* last,
+                           flag_type flags, const traits& tr)
+                : first_{first}, pos_{first}, last_{last},
+                  flags_{flags}, prog_{}, nodes_{},
+                  failed_{false}, group_count_{},
+                  max_back_reference_{}
+            {
+                prog_.tr = tr;
+                prog_.icase = (flags & regex_constants::icase) != 0;
+                prog_.multiline = (flags & regex_constants::multiline) != 0;
+            }
+
+            program_type compile()
+            {
+                auto root = parse_disjunction_();
+                if (!failed_ && pos_ != last_)
+                {
+                    // Only an unmatched ')' stops the top level.
+                    error_(regex_constants::error_paren);
+                }
+
+                if (!failed_ && max_back_reference_ > group_count_)
+                    error_(regex_constants::error_backref);
+
+                if (!failed_)
+                {
+                    emit_(instruction_(regex_opcode::save, 0));
+                    emit_node_(root);
+                    emit_(instruction_(regex_opcode::save, 1));
+                    emit_(instruction_(regex_opcode::match));
+                    prog_.mark_count = group_count_;
+                }
+                else
+                {
+                    prog_.code.clear();
+                    prog_.code.push_back(instruction_(regex_opcode::fail));
+                    prog_.mark_count = 0;
+                    prog_.failed = true;
+                }
+
+                for (auto& set: prog_.sets)
+                    set.finish(prog_.tr, prog_.icase);
+
+                if constexpr (sizeof(charT) == 1)
+                {
+                    if (!prog_.failed)
+                        compute_first_chars_();
+                }
+
+                return move(prog_);
+            }
+
+        private:
+            enum class node_type
+            {
+                empty,
+                character,
+                any,
+                char_set,
+                concat,
+                alternate,
+                repeat,
+                group,
+                line_begin,
+                line_end,
+                word_boundary,
+                back_reference,
+                lookahead
+            };
+
+            struct node
+            {
+                node_type type;
+                charT ch{};
+                size_t idx{};
+                size_t min{};
+                size_t max{};
+                bool greedy{true};
+                bool negate{false};
+                vector<size_t> children{};
+            };
+
+            static constexpr size_t infinity_ = regex_npos;
+
+            /**
+             * Bounded repetitions are unrolled, so limit the
+             * counts to keep the program size reasonable.
+             */
+            static constexpr size_t max_repeat_count_{1000};
+
+            const charT* first_;
+            const charT* pos_;
+            const charT* last_;
+            flag_type flags_;
+            program_type prog_;
+            vector<node> nodes_;
+            bool failed_;
+            size_t group_count_;
+            size_t max_back_reference_;
+
+            void error_(regex_constants::error_type ecode)
+            {
+                if (!failed_)
+                    throw regex_error{ecode};
+                failed_ = true;
+                pos_ = last_;
+            }
+
+            bool at_end_() const
+            {
+                return failed_ || pos_ == last_;
+            }
+
+            bool peek_(charT c) const
+            {
+                return !at_end_() && *pos_ == c;
+            }
+
+            bool consume_(charT c)
+            {
+                if (peek_(c))
+                {
+                    ++pos_;
+                    return true;
+                }
+                else
+                    return false;
+            }
+
+            size_t make_node_(node_type type)
+            {
+                nodes_.emplace_back();
+                nodes_.back().type = type;
+
+                return nodes_.size() - 1;
+            }
+
+            size_t make_character_(charT c)
+            {
+                auto res = make_node_(node_type::character);
+                nodes_[res].ch = prog_.icase ? prog_.tr.translate_nocase(c) : c;
+
+                return res;
+            }
+
+            size_t parse_disjunction_()
+            {
+                auto first = parse_alternative_();
+                if (!peek_(charT('|')))
+                    return first;
+
+                auto res = make_node_(node_type::alternate);
+                nodes_[res].children.push_back(first);
+                while (consume_(charT('|')))
+                {
+                    auto alt = parse_alternative_();
+                    nodes_[res].children.push_back(alt);
+                }
+
+                return res;
+            }
+
+            size_t parse_alternative_()
+            {
+                auto res = make_node_(node_type::concat);
+                while (!at_end_() && !peek_(charT('|')) && !peek_(charT(')')))
+                {
+                    auto term = parse_term_();
+                    if (failed_)
+                        break;
+                    nodes_[res].children.push_back(term);
+                }
+
+                return res;
+            }
+
+            size_t parse_term_()
+            {
+                auto c = *pos_;
+                if (c == charT('^'))
+                {
+                    ++pos_;
+                    return make_node_(node_type::line_begin);
+                }
+                else if (c == charT('$'))
+                {
+                    ++pos_;
+                    return make_node_(node_type::line_end);
+                }
+                else if (c == charT('\\') && pos_ + 1 != last_ &&
+                         (pos_[1] == charT('b') || pos_[1] == charT('B')))
+                {
+                    auto res = make_node_(node_type::word_boundary);
+                    nodes_[res].negate = pos_[1] == charT('B');
+                    prog_.has_word_boundaries = true;
+                    pos_ += 2;
+
+                    return res;
+                }
+                else if (c == charT('(') && pos_ + 2 < last_ && pos_[1] == charT('?') &&
+                         (pos_[2] == charT('=') || pos_[2] == charT('!')))
+                {
+                    auto res = make_node_(node_type::lookahead);
+                    nodes_[res].negate = pos_[2] == charT('!');
+                    prog_.has_lookaheads = true;
+                    pos_ += 3;
+
+                    auto body = parse_disjunction_();
+                    nodes_[res].children.push_back(body);
+                    if (!consume_(charT(')')))
+                        error_(regex_constants::error_paren);
+
+                    return res;
+                }
+
+                auto atom = parse_atom_();
+                if (failed_)
+                    return atom;
+
+                return parse_quantifier_(atom);
+            }
+
+            bool parse_number_(size_t& res)
+            {
+                if (at_end_() || prog_.tr.value(*pos_, 10) < 0)
+                    return false;
+
+                res = 0;
+                while (!at_end_() && prog_.tr.value(*pos_, 10) >= 0)
+                {
+                    res = res * 10 + static_cast<size_t>(prog_.tr.value(*pos_, 10));
+                    if (res > max_repeat_count_)
+                    {
+                        error_(regex_constants::error_badbrace);
+                        return false;
+                    }
+
+                    ++pos_;
+                }
+
+                return true;
+            }
+
+            size_t parse_quantifier_(size_t atom)
+            {
+                size_t min{}, max{};
+                if (consume_(charT('*')))
+                {
+                    min = 0;
+                    max = infinity_;
+                }
+                else if (consume_(charT('+')))
+                {
+                    min = 1;
+                    max = infinity_;
+                }
+                else if (consume_(charT('?')))
+                {
+                    min = 0;
+                    max = 1;
+                }
+                else if (consume_(charT('{')))
+                {
+                    if (!parse_number_(min))
+                    {
+                        error_(regex_constants::error_badbrace);
+                        return atom;
+                    }
+
+                    max = min;
+                    if (consume_(charT(',')))
+                    {
+                        if (!parse_number_(max))
+                            max = infinity_;
+                    }
+
+                    if (!consume_(charT('}')))
+                    {
+                        error_(regex_constants::error_brace);
+                        return atom;
+                    }
+
+                    if (max < min)
+                    {
+                        error_(regex_constants::error_badbrace);
+                        return atom;
+                    }
+                }
+                else
+                    return atom;
+
+                auto res = make_node_(node_type::repeat);
+                nodes_[res].min = min;
+                nodes_[res].max = max;
+                nodes_[res].greedy = !consume_(charT('?'));
+                nodes_[res].children.push_back(atom);
+
+                if (peek_(charT('*')) || peek_(charT('+')) ||
+                    peek_(charT('?')) || peek_(charT('{')))
+                {
+                    error_(regex_constants::error_badrepeat);
+                }
+
+                return res;
+            }
+
+            size_t parse_atom_()
+            {
+                auto c = *pos_++;
+                switch (c)
+                {
+                    case charT('.'):
+                        return make_node_(node_type::any);
+                    case charT('['):
+                        return parse_bracket_();
+                    case charT('\\'):
+                        return parse_atom_escape_();
+                    case charT('('):
+                        return parse_group_();
+                    case charT(')'):
+                        error_(regex_constants::error_paren);
+                        return make_node_(node_type::empty);
+                    case charT(']'):
+                        return make_character_(c);
+                    case charT('}'):
+                        return make_character_(c);
+                    case charT('*'):
+                    case charT('+'):
+                    case charT('?'):
+                    case charT('{'):
+                        error_(regex_constants::error_badrepeat);
+                        return make_node_(node_type::empty);
+                    default:
+                        return make_character_(c);
+                }
+            }
+
+            size_t parse_group_()
+            {
+                bool capture{true};
+                if (pos_ + 1 < last_ && pos_[0] == charT('?') && pos_[1] == charT(':'))
+                {
+                    capture = false;
+                    pos_ += 2;
+                }
+
+                if (capture && (flags_ & regex_constants::nosubs))
+                    capture = false;
+
+                size_t idx{};
+                if (capture)
+                    idx = ++group_count_;
+
+                auto body = parse_disjunction_();
+                if (!consume_(charT(')')))
+                {
+                    error_(regex_constants::error_paren);
+                    return body;
+                }
+
+                if (!capture)
+                    return body;
+
+                auto res = make_node_(node_type::group);
+                nodes_[res].idx = idx;
+                nodes_[res].children.push_back(body);
+
+                return res;
+            }
+
+            /**
+             * Parses escapes shared by atoms and bracket
+             * expressions that denote a single character.
+             * Returns false if the escape is not one of them.
+             */
+            bool parse_character_escape_(charT& res)
+            {
+                auto c = *pos_;
+                switch (c)
+                {
+                    case charT('f'):
+                        res = charT('\f');
+                        break;
+                    case charT('n'):
+                        res = charT('\n');
+                        break;
+                    case charT('r'):
+                        res = charT('\r');
+                        break;
+                    case charT('t'):
+                        res = charT('\t');
+                        break;
+                    case charT('v'):
+                        res = charT('\v');
+                        break;
+                    case charT('0'):
+                        if (pos_ + 1 != last_ && prog_.tr.value(pos_[1], 10) >= 0)
+                            return false;
+                        res = charT('\0');
+                        break;
+                    case charT('c'):
+                        if (pos_ + 1 == last_ || !prog_.tr.isctype(
+                            pos_[1], prog_.tr.lookup_classname("alpha", "alpha" + 5)))
+                        {
+                            error_(regex_constants::error_escape);
+                            return true;
+                        }
+                        ++pos_;
+                        res = static_cast<charT>(*pos_ % 32);
+                        break;
+                    case charT('x'):
+                    case charT('u'):
+                    {
+                        size_t digits = c == charT('x') ? 2 : 4;
+                        int val{};
+                        for (size_t i = 1; i <= digits; ++i)
+                        {
+                            if (pos_ + i == last_ || prog_.tr.value(pos_[i], 16) < 0)
+                            {
+                                error_(regex_constants::error_escape);
+                                return true;
+                            }
+                            val = val * 16 + prog_.tr.value(pos_[i], 16);
+                        }
+                        pos_ += digits;
+                        res = static_cast<charT>(val);
+                        break;
+                    }
+                    default:
+                        if (prog_.tr.isctype(c, prog_.tr.lookup_classname("w", "w" + 1)))
+                            return false;
+
+                        // Identity escape.
+                        res = c;
+                }
+
+                ++pos_;
+                return true;
+            }
+
+            /**
+             * Parses \d, \D, \s, \S, \w and \W into set.
+             */
+            bool parse_class_escape_(regex_char_set<charT, traits>& set)
+            {
+                auto c = *pos_;
+                auto lower = prog_.tr.translate_nocase(c);
+                if (lower != charT('d') && lower != charT('s') && lower != charT('w'))
+                    return false;
+
+                auto cls = prog_.tr.lookup_classname(&lower, &lower + 1);
+                set.add_class(cls, lower != c);
+                ++pos_;
+
+                return true;
+            }
+
+            size_t make_set_node_(regex_char_set<charT, traits>&& set)
+            {
+                prog_.sets.push_back(move(set));
+
+                auto res = make_node_(node_type::char_set);
+                nodes_[res].idx = prog_.sets.size() - 1;
+
+                return res;
+            }
+
+            size_t parse_atom_escape_()
+            {
+                if (at_end_())
+                {
+                    error_(regex_constants::error_escape);
+                    return make_node_(node_type::empty);
+                }
+
+                auto c = *pos_;
+                if (prog_.tr.value(c, 10) > 0)
+                {
+                    size_t ref{};
+                    while (!at_end_() && prog_.tr.value(*pos_, 10) >= 0)
+                        ref = ref * 10 + static_cast<size_t>(prog_.tr.value(*pos_++, 10));
+
+                    if (flags_ & regex_constants::nosubs)
+                    {
+                        error_(regex_constants::error_backref);
+                        return make_node_(node_type::empty);
+                    }
+
+                    auto res = make_node_(node_type::back_reference);
+                    nodes_[res].idx = ref;
+                    max_back_reference_ = max(max_back_reference_, ref);
+                    prog_.has_back_references = true;
+
+                    return res;
+                }
+
+                regex_char_set<charT, traits> set{};
+                if (parse_class_escape_(set))
+                    return make_set_node_(move(set));
+
+                charT ch{};
+                if (parse_character_escape_(ch))
+                    return make_character_(ch);
+
+                error_(regex_constants::error_escape);
+                return make_node_(node_type::empty);
+            }
+
+            /**
+             * Parses a single bracket expression element, returns
+             * false if it was a character class and thus cannot
+             * be an endpoint of a range.
+             */
+            bool parse_class_atom_(regex_char_set<charT, traits>& set, charT& res)
+            {
+                auto c = *pos_++;
+                if (c == charT('\\'))
+                {
+                    if (at_end_())
+                    {
+                        error_(regex_constants::error_escape);
+                        return false;
+                    }
+
+                    if (parse_class_escape_(set))
+                        return false;
+
+                    if (*pos_ == charT('b'))
+                    {
+                        ++pos_;
+                        res = charT('\b');
+                        return true;
+                    }
+
+                    if (*pos_ == charT('-'))
+                    {
+                        ++pos_;
+                        res = charT('-');
+                        return true;
+                    }
+
+                    if (!parse_character_escape_(res))
+                        error_(regex_constants::error_escape);
+
+                    return true;
+                }
+                else if (c == charT('[') && !at_end_() &&
+                         (*pos_ == charT(':') || *pos_ == charT('.') || *pos_ == charT('=')))
+                {
+                    auto kind = *pos_++;
+                    auto name_first = pos_;
+                    while (pos_ + 1 < last_ && !(pos_[0] == kind && pos_[1] == charT(']')))
+                        ++pos_;
+
+                    if (pos_ + 1 >= last_)
+                    {
+                        error_(regex_constants::error_brack);
+                        return false;
+                    }
+
+                    auto name_last = pos_;
+                    pos_ += 2;
+
+                    if (kind == charT(':'))
+                    {
+                        auto cls = prog_.tr.lookup_classname(name_first, name_last, prog_.icase);
+                        if (cls == 0)
+                            error_(regex_constants::error_ctype);
+                        set.add_class(cls, false);
+
+                        return false;
+                    }
+                    else
+                    {
+                        auto name = prog_.tr.lookup_collatename(name_first, name_last);
+                        if (name.size() != 1)
+                        {
+                            error_(regex_constants::error_collate);
+                            return false;
+                        }
+                        res = name[0];
+
+                        return true;
+                    }
+                }
+
+                res = c;
+                return true;
+            }
+
+            size_t parse_bracket_()
+            {
+                regex_char_set<charT, traits> set{};
+                if (consume_(charT('^')))
+                    set.negate();
+
+                auto translate = [this](charT c){
+                    return prog_.icase ? prog_.tr.translate_nocase(c) : c;
+                };
+
+                while (true)
+                {
+                    if (at_end_())
+                    {
+                        error_(regex_constants::error_brack);
+                        break;
+                    }
+
+                    if (consume_(charT(']')))
+                        break;
+
+                    charT low{};
+                    if (!parse_class_atom_(set, low))
+                        continue;
+
+                    if (pos_ + 1 < last_ && pos_[0] == charT('-') && pos_[1] != charT(']'))
+                    {
+                        ++pos_;
+
+                        charT high{};
+                        if (!parse_class_atom_(set, high))
+                        {
+                            error_(regex_constants::error_range);
+                            break;
+                        }
+
+                        if (high < low)
+                        {
+                            error_(regex_constants::error_range);
+                            break;
+                        }
+
+                        set.add_range(translate(low), translate(high));
+                    }
+                    else
+                        set.add(translate(low));
+                }
+
+                return make_set_node_(move(set));
+            }
+
+            /**
+             * Collects the characters accepted by the consuming
+             * instructions reachable from the start, assertions
+             * are assumed to hold.
+             */
+            void compute_first_chars_()
+            {
+                vector<uint8_t> visited(prog_.code.size(), 0);
+                vector<size_t> stack{0};
+                vector<size_t> consuming{};
+
+                while (!stack.empty())
+                {
+                    auto pc = stack.back();
+                    stack.pop_back();
+
+                    if (visited[pc])
+                        continue;
+                    visited[pc] = 1;
+
+                    const auto& inst = prog_.code[pc];
+                    switch (inst.op)
+                    {
+                        case regex_opcode::character:
+                        case regex_opcode::any:
+                        case regex_opcode::char_set:
+                            consuming.push_back(pc);
+                            break;
+                        case regex_opcode::split:
+                            stack.push_back(inst.x);
+                            stack.push_back(inst.y);
+                            break;
+                        case regex_opcode::jump:
+                            stack.push_back(inst.x);
+                            break;
+                        case regex_opcode::match:
+                        case regex_opcode::back_reference:
+                        case regex_opcode::lookahead:
+                            // Match may be empty or start anywhere.
+                            return;
+                        case regex_opcode::fail:
+                            break;
+                        default:
+                            stack.push_back(pc + 1);
+                    }
+                }
+
+                for (size_t i = 0; i < 256; ++i)
+                {
+                    auto c = static_cast<charT>(i);
+                    for (auto pc: consuming)
+                    {
+                        if (prog_.consumes(pc, c))
+                        {
+                            prog_.first_chars[i / 64] |= uint64_t{1} << (i % 64);
+                            break;
+                        }
+                    }
+                }
+                prog_.has_first_chars = true;
+            }
+
+            /**
+             * Emission of the syntax tree:
+             */
+
+            static regex_instruction<charT> instruction_(regex_opcode op, size_t x = 0,
+                                                         size_t y = 0)
+            {
+                return regex_instruction<charT>{op, false, charT{}, x, y};
+            }
+
+            size_t emit_(const regex_instruction<charT>& inst)
+            {
+                prog_.code.push_back(inst);
+
+                return prog_.code.size() - 1;
+            }
+
+            size_t next_pc_() const
+            {
+                return prog_.code.size();
+            }
+
+            bool nullable_(size_t idx) const
+            {
+                const auto& n = nodes_[idx];
+                switch (n.type)
+                {
+                    case node_type::character:
+                    case node_type::any:
+                    case node_type::char_set:
+                        return false;
+                    case node_type::concat:
+                        for (auto child: n.children)
+                        {
+                            if (!nullable_(child))
+                                return false;
+                        }
+                        return true;
+                    case node_type::alternate:
+                        for (auto child: n.children)
+                        {
+                            if (nullable_(child))
+                                return true;
+                        }
+                        return false;
+                    case node_type::repeat:
+                        return n.min == 0 || nullable_(n.children[0]);
+                    case node_type::group:
+                        return nullable_(n.children[0]);
+                    default:
+                        // Assertions and back references.
+                        return true;
+                }
+            }
+
+            void emit_node_(size_t idx)
+            {
+                /**
+                 * Note: The node is copied as nodes_ does
+                 *       not change during emission but the
+                 *       recursion makes references awkward.
+                 */
+                const auto type = nodes_[idx].type;
+                switch (type)
+                {
+                    case node_type::empty:
+                        break;
+                    case node_type::character:
+                    {
+                        auto inst = instruction_(regex_opcode::character);
+                        inst.ch = nodes_[idx].ch;
+                        emit_(inst);
+                        break;
+                    }
+                    case node_type::any:
+                        emit_(instruction_(regex_opcode::any));
+                        break;
+                    case node_type::char_set:
+                        emit_(instruction_(regex_opcode::char_set, nodes_[idx].idx));
+                        break;
+                    case node_type::concat:
+                        for (size_t i = 0; i < nodes_[idx].children.size(); ++i)
+                            emit_node_(nodes_[idx].children[i]);
+                        break;
+                    case node_type::alternate:
+                        emit_alternate_(idx);
+                        break;
+                    case node_type::repeat:
+                        emit_repeat_(idx);
+                        break;
+                    case node_type::group:
+                        emit_(instruction_(regex_opcode::save, 2 * nodes_[idx].idx));
+                        emit_node_(nodes_[idx].children[0]);
+                        emit_(instruction_(regex_opcode::save, 2 * nodes_[idx].idx + 1));
+                        break;
+                    case node_type::line_begin:
+                        emit_(instruction_(regex_opcode::line_begin));
+                        break;
+                    case node_type::line_end:
+                        emit_(instruction_(regex_opcode::line_end));
+                        break;
+                    case node_type::word_boundary:
+                    {
+                        auto inst = instruction_(regex_opcode::word_boundary);
+                        inst.negate = nodes_[idx].negate;
+                        emit_(inst);
+                        break;
+                    }
+                    case node_type::back_reference:
+                        emit_(instruction_(regex_opcode::back_reference, nodes_[idx].idx));
+                        break;
+                    case node_type::lookahead:
+                    {
+                        auto look = emit_(instruction_(regex_opcode::lookahead));
+                        prog_.code[look].negate = nodes_[idx].negate;
+                        prog_.code[look].x = look;
+                        emit_node_(nodes_[idx].children[0]);
+                        emit_(instruction_(regex_opcode::lookahead_end));
+                        prog_.code[look].y = next_pc_();
+                        break;
+                    }
+                }
+            }
+
+            void emit_alternate_(size_t idx)
+            {
+                /**
+                 *     split L1, N1
+                 * L1: <alt 1>
+                 *     jump END
+                 * N1: split L2, N2
+                 *     ...
+                 * Nk: <alt k>
+                 * END:
+                 */
+                vector<size_t> jumps{};
+                auto count = nodes_[idx].children.size();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    size_t split{regex_npos};
+                    if (i + 1 < count)
+                        split = emit_(instruction_(regex_opcode::split, next_pc_() + 1));
+
+                    emit_node_(nodes_[idx].children[i]);
+
+                    if (i + 1 < count)
+                    {
+                        jumps.push_back(emit_(instruction_(regex_opcode::jump)));
+                        prog_.code[split].y = next_pc_();
+                    }
+                }
+
+                for (auto jump: jumps)
+                    prog_.code[jump].x = next_pc_();
+            }
+
+            /**
+             * Emits an optional or a looping copy of the repeated
+             * node. Splits prefer the body if greedy, the exit
+             * otherwise. Returns the split so that its exit can
+             * be patched.
+             */
+            size_t emit_repeat_split_(bool greedy)
+            {
+                auto split = emit_(instruction_(regex_opcode::split));
+                if (greedy)
+                    prog_.code[split].x = split + 1;
+                else
+                    prog_.code[split].y = split + 1;
+
+                return split;
+            }
+
+            void patch_repeat_exit_(size_t split, bool greedy)
+            {
+                if (greedy)
+                    prog_.code[split].y = next_pc_();
+                else
+                    prog_.code[split].x = next_pc_();
+            }
+
+            void emit_repeat_(size_t idx)
+            {
+                auto child = nodes_[idx].children[0];
+                auto min = nodes_[idx].min;
+                auto max = nodes_[idx].max;
+                auto greedy = nodes_[idx].greedy;
+
+                for (size_t i = 0; i < min; ++i)
+                    emit_node_(child);
+
+                if (max == infinity_)
+                {
+                    /**
+                     * L:  split B, END
+                     * B:  <body>
+                     *     jump L
+                     * END:
+                     * An iteration that matches empty would loop
+                     * forever in the backtracking matcher, so the
+                     * body of nullable nodes is guarded.
+                     */
+                    bool guard = nullable_(child);
+                    size_t slot = guard ? prog_.loop_count++ : 0;
+
+                    auto split = emit_repeat_split_(greedy);
+                    if (guard)
+                        emit_(instruction_(regex_opcode::loop_enter, slot));
+                    emit_node_(child);
+                    if (guard)
+                        emit_(instruction_(regex_opcode::loop_check, slot));
+                    emit_(instruction_(regex_opcode::jump, split));
+                    patch_repeat_exit_(split, greedy);
+                }
+                else if (max > min)
+                {
+                    vector<size_t> splits{};
+                    for (size_t i = min; i < max; ++i)
+                    {
+                        splits.push_back(emit_repeat_split_(greedy));
+                        emit_node_(child);
+                    }
+
+                    for (auto split: splits)
+                        patch_repeat_exit_(split, greedy);
+                }
+            }
+    };
+}
+
+#endif
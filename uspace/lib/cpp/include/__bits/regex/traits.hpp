@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_TRAITS
+#define LIBCPP_BITS_REGEX_TRAITS
+
+#include <__bits/locale/locale.hpp>
+#include <__bits/string/string.hpp>
+#include <cctype>
+#include <cstdint>
+
+namespace std
+{
+    /**
+     * 28.7, class template regex_traits:
+     * Note: Character classification is done by the C
+     *       library and only covers the single byte
+     *       range, the locale is only kept around.
+     */
+
+    template<class charT>
+    struct regex_traits
+    {
+        using char_type       = charT;
+        using string_type     = basic_string<char_type>;
+        using locale_type     = locale;
+        using char_class_type = uint16_t;
+
+        regex_traits()
+            : loc_{}
+        { /* DUMMY BODY */ }
+
+        static size_t length(const char_type* p)
+        {
+            return char_traits<char_type>::length(p);
+        }
+
+        charT translate(charT c) const
+        {
+            return c;
+        }
+
+        charT translate_nocase(charT c) const
+        {
+            if (is_byte_(c))
+                return static_cast<charT>(std::tolower(byte_(c)));
+            else
+                return c;
+        }
+
+        template<class ForwardIterator>
+        string_type transform(ForwardIterator first, ForwardIterator last) const
+        {
+            return string_type(first, last);
+        }
+
+        template<class ForwardIterator>
+        string_type transform_primary(ForwardIterator first,
+                                      ForwardIterator last) const
+        {
+            string_type res{};
+            for (; first != last; ++first)
+                res.push_back(translate_nocase(*first));
+
+            return res;
+        }
+
+        template<class ForwardIterator>
+        string_type lookup_collatename(ForwardIterator first,
+                                       ForwardIterator last) const
+        {
+            // Only single characters name themselves.
+            string_type res(first, last);
+            if (res.size() != 1)
+                res.clear();
+
+            return res;
+        }
+
+        template<class ForwardIterator>
+        char_class_type lookup_classname(ForwardIterator first, ForwardIterator last,
+                                         bool icase = false) const
+        {
+            static constexpr struct
+            {
+                const char* name;
+                char_class_type mask;
+            } classes[] = {
+                { "alnum",  alpha_ | digit_ },
+                { "alpha",  alpha_ },
+                { "blank",  blank_ },
+                { "cntrl",  cntrl_ },
+                { "digit",  digit_ },
+                { "d",      digit_ },
+                { "graph",  graph_ },
+                { "lower",  lower_ },
+                { "print",  print_ },
+                { "punct",  punct_ },
+                { "space",  space_ },
+                { "s",      space_ },
+                { "upper",  upper_ },
+                { "w",      word_ | alpha_ | digit_ },
+                { "xdigit", xdigit_ }
+            };
+
+            string_type name{};
+            for (; first != last; ++first)
+                name.push_back(translate_nocase(*first));
+
+            for (const auto& cls: classes)
+            {
+                size_t i{};
+                while (cls.name[i] && i < name.size() &&
+                       name[i] == static_cast<char_type>(cls.name[i]))
+                    ++i;
+
+                if (cls.name[i] || i != name.size())
+                    continue;
+
+                if (icase && (cls.mask == lower_ || cls.mask == upper_))
+                    return alpha_;
+                else
+                    return cls.mask;
+            }
+
+            return char_class_type{};
+        }
+
+        bool isctype(charT c, char_class_type f) const
+        {
+            if (!is_byte_(c))
+                return false;
+
+            auto b = byte_(c);
+            return ((f & alpha_) && std::isalpha(b)) ||
+                   ((f & digit_) && std::isdigit(b)) ||
+                   ((f & lower_) && std::islower(b)) ||
+                   ((f & upper_) && std::isupper(b)) ||
+                   ((f & space_) && std::isspace(b)) ||
+                   ((f & blank_) && std::isblank(b)) ||
+                   ((f & cntrl_) && std::iscntrl(b)) ||
+                   ((f & punct_) && std::ispunct(b)) ||
+                   ((f & xdigit_) && std::isxdigit(b)) ||
+                   ((f & print_) && std::isprint(b)) ||
+                   ((f & graph_) && std::isgraph(b)) ||
+                   ((f & word_) && c == charT('_'));
+        }
+
+        int value(charT ch, int radix) const
+        {
+            int res{-1};
+            if (ch >= charT('0') && ch <= charT('9'))
+                res = static_cast<int>(ch - charT('0'));
+            else if (ch >= charT('a') && ch <= charT('z'))
+                res = static_cast<int>(ch - charT('a')) + 10;
+            else if (ch >= charT('A') && ch <= charT('Z'))
+                res = static_cast<int>(ch - charT('A')) + 10;
+
+            if (res >= radix)
+                return -1;
+            else
+                return res;
+        }
+
+        locale_type imbue(locale_type loc)
+        {
+            auto old = loc_;
+            loc_ = loc;
+
+            return old;
+        }
+
+        locale_type getloc() const
+        {
+            return loc_;
+        }
+
+        private:
+            locale_type loc_;
+
+            static constexpr char_class_type alpha_  = 0b0000'0000'0001;
+            static constexpr char_class_type digit_  = 0b0000'0000'0010;
+            static constexpr char_class_type lower_  = 0b0000'0000'0100;
+            static constexpr char_class_type upper_  = 0b0000'0000'1000;
+            static constexpr char_class_type space_  = 0b0000'0001'0000;
+            static constexpr char_class_type blank_  = 0b0000'0010'0000;
+            static constexpr char_class_type cntrl_  = 0b0000'0100'0000;
+            static constexpr char_class_type punct_  = 0b0000'1000'0000;
+            static constexpr char_class_type xdigit_ = 0b0001'0000'0000;
+            static constexpr char_class_type print_  = 0b0010'0000'0000;
+            static constexpr char_class_type graph_  = 0b0100'0000'0000;
+            static constexpr char_class_type word_   = 0b1000'0000'0000;
+
+            static bool is_byte_(charT c)
+            {
+                using unsigned_type = make_unsigned_t<charT>;
+
+                if constexpr (sizeof(charT) == 1)
+                    return true;
+                else
+                    return static_cast<unsigned_type>(c) < 0x100;
+            }
+
+            static int byte_(charT c)
+            {
+                using unsigned_type = make_unsigned_t<charT>;
+
+                return static_cast<int>(static_cast<unsigned_type>(c) & 0xFF);
+            }
+    };
+}
+
+#endif
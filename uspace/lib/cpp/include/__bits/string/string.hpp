@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_STRING
 #define LIBCPP_BITS_STRING
 
+#include <__bits/memory/memory_resource_fwd.hpp>
 #include <__bits/string/stringfwd.hpp>
 #include <algorithm>
 #include <cassert>
@@ -478,8 +479,7 @@ namespace std
                  *  size() = 0
                  *  capacity() = unspecified
                  */
-                data_ = allocator_.allocate(default_capacity_);
-                capacity_ = default_capacity_;
+                reset_to_inline_();
             }
 
             basic_string(const basic_string& other)
@@ -490,12 +490,10 @@ namespace std
             }
 
             basic_string(basic_string&& other)
-                : data_{other.data_}, size_{other.size_},
-                  capacity_{other.capacity_}, allocator_{move(other.allocator_)}
+                : data_{}, size_{}, capacity_{},
+                  allocator_{move(other.allocator_)}
             {
-                other.data_ = nullptr;
-                other.size_ = 0;
-                other.capacity_ = 0;
+                steal_(other);
             }
 
             basic_string(const basic_string& other, size_type pos, size_type n = npos,
@@ -520,9 +518,9 @@ namespace std
             }
 
             basic_string(size_type n, value_type c, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{}, size_{n}, capacity_{}, allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
+                data_ = allocate_(size_ + 1);
                 for (size_type i = 0; i < size_; ++i)
                     traits_type::assign(data_[i], c);
                 ensure_null_terminator_();
@@ -536,8 +534,7 @@ namespace std
                 if constexpr (is_integral<InputIterator>::value)
                 { // Required by the standard.
                     size_ = static_cast<size_type>(first);
-                    capacity_ = size_;
-                    data_ = allocator_.allocate(capacity_);
+                    data_ = allocate_(size_ + 1);
 
                     for (size_type i = 0; i < size_; ++i)
                         traits_type::assign(data_[i], static_cast<value_type>(last));
@@ -561,23 +558,21 @@ namespace std
             }
 
             basic_string(basic_string&& other, const allocator_type& alloc)
-                : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
+                : data_{}, size_{}, capacity_{}, allocator_{alloc}
             {
-                other.data_ = nullptr;
-                other.size_ = 0;
-                other.capacity_ = 0;
+                steal_(other);
             }
 
             ~basic_string()
             {
-                allocator_.deallocate(data_, capacity_);
+                deallocate_(data_, capacity_);
             }
 
             basic_string& operator=(const basic_string& other)
             {
                 if (this != &other)
                 {
-                    basic_string tmp{other};
+                    basic_string tmp{other, allocator_};
                     swap(tmp);
                 }
 
@@ -588,8 +583,20 @@ namespace std
                 noexcept(allocator_traits<allocator_type>::propagate_on_container_move_assignment::value ||
                          allocator_traits<allocator_type>::is_always_equal::value)
             {
-                if (this != &other)
+                /**
+                 * Note: swap does not exchange allocators, so
+                 *       buffers may only change hands if both
+                 *       allocators can free each other's memory.
+                 */
+                if (this == &other)
+                    return *this;
+                else if (allocator_ == other.allocator_)
                     swap(other);
+                else
+                {
+                    basic_string tmp{other, allocator_};
+                    swap(tmp);
+                }
 
                 return *this;
             }
@@ -736,8 +743,12 @@ namespace std
 
             void shrink_to_fit()
             {
-                if (size_ != capacity_)
-                    resize_with_copy_(size_, capacity_);
+                /**
+                 * Note: This can move the string back
+                 *       into the inline buffer.
+                 */
+                if (!is_inline_() && size_ + 1 < capacity_)
+                    reallocate_(size_ + 1);
             }
 
             void clear() noexcept
@@ -1095,6 +1106,7 @@ namespace std
                 copy_(begin() + pos + len, end(), tmp.begin() + pos + n2);
 
                 tmp.size_ = size_ - len + n2;
+                tmp.ensure_null_terminator_();
                 swap(tmp);
                 return *this;
             }
@@ -1160,7 +1172,36 @@ namespace std
                 noexcept(allocator_traits<allocator_type>::propagate_on_container_swap::value ||
                          allocator_traits<allocator_type>::is_always_equal::value)
             {
-                std::swap(data_, other.data_);
+                /**
+                 * Inline buffers cannot be exchanged by swapping
+                 * pointers, their contents have to be copied and
+                 * the pointers redirected to the new owner.
+                 */
+                auto this_data = data_;
+                auto other_data = other.data_;
+                auto this_inline = is_inline_();
+                auto other_inline = other.is_inline_();
+
+                value_type tmp[inline_capacity_ + 1];
+                if (this_inline)
+                    traits_type::copy(tmp, inline_, size_ + 1);
+
+                if (other_inline)
+                {
+                    traits_type::copy(inline_, other.inline_, other.size_ + 1);
+                    data_ = inline_;
+                }
+                else
+                    data_ = other_data;
+
+                if (this_inline)
+                {
+                    traits_type::copy(other.inline_, tmp, size_ + 1);
+                    other.data_ = other.inline_;
+                }
+                else
+                    other.data_ = this_data;
+
                 std::swap(size_, other.size_);
                 std::swap(capacity_, other.capacity_);
             }
@@ -1435,17 +1476,7 @@ namespace std
 
             int compare(const basic_string& other) const noexcept
             {
-                auto len = min(size(), other.size());
-                auto comp = traits_type::compare(data_, other.data(), len);
-
-                if (comp != 0)
-                    return comp;
-                else if (size() == other.size())
-                    return 0;
-                else if (size() > other.size())
-                    return 1;
-                else
-                    return -1;
+                return compare_(other.data(), other.size());
             }
 
             int compare(size_type pos, size_type n, const basic_string& other) const
@@ -1461,7 +1492,7 @@ namespace std
 
             int compare(const value_type* other) const
             {
-                return compare(basic_string(other));
+                return compare_(other, traits_type::length(other));
             }
 
             int compare(size_type pos, size_type n, const value_type* other) const
@@ -1476,32 +1507,119 @@ namespace std
             }
 
         private:
+            /**
+             * Short strings (the common case for keys and
+             * path components) are stored in the inline
+             * buffer and do not touch the allocator at all.
+             * Note that capacity_ (like everywhere in this
+             * class) includes the null terminator.
+             */
+            static constexpr size_type inline_capacity_{
+                sizeof(value_type) == 1 ? 15 : 7
+            };
+
             value_type* data_;
             size_type size_;
             size_type capacity_;
             allocator_type allocator_;
+            value_type inline_[inline_capacity_ + 1];
 
             template<class C, class T, class A>
             friend class basic_stringbuf;
 
+            bool is_inline_() const noexcept
+            {
+                return data_ == inline_;
+            }
+
             /**
-             * Arbitrary value, standard just requires
-             * data() to have some capacity.
-             * (Well, we could've done data_ = &data_ and
-             * set capacity to 0, but that would be too cryptic.)
+             * Returns the inline buffer for capacities it can
+             * hold and sets capacity_ to the real capacity of
+             * the returned buffer.
              */
-            static constexpr size_type default_capacity_{4};
+            value_type* allocate_(size_type capacity)
+            {
+                if (capacity <= inline_capacity_ + 1)
+                {
+                    capacity_ = inline_capacity_ + 1;
+
+                    return inline_;
+                }
+
+                capacity_ = capacity;
+
+                return allocator_.allocate(capacity);
+            }
+
+            void deallocate_(value_type* ptr, size_type capacity)
+            {
+                if (ptr && ptr != inline_)
+                    allocator_.deallocate(ptr, capacity);
+            }
+
+            void reset_to_inline_() noexcept
+            {
+                data_ = inline_;
+                size_ = 0;
+                capacity_ = inline_capacity_ + 1;
+                ensure_null_terminator_();
+            }
+
+            /**
+             * Takes over the contents of other, heap buffers
+             * are stolen while inline ones have to be copied.
+             * Leaves other as a valid empty string.
+             */
+            void steal_(basic_string& other) noexcept
+            {
+                if (other.is_inline_())
+                {
+                    data_ = inline_;
+                    size_ = other.size_;
+                    capacity_ = inline_capacity_ + 1;
+                    traits_type::copy(inline_, other.inline_, size_ + 1);
+                }
+                else
+                {
+                    data_ = other.data_;
+                    size_ = other.size_;
+                    capacity_ = other.capacity_;
+                }
+
+                other.reset_to_inline_();
+            }
 
             void init_(const value_type* str, size_type size)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                auto old_data = data_;
+                auto old_capacity = capacity_;
 
                 size_ = size;
-                capacity_ = size + 1;
+                data_ = allocate_(size + 1);
+
+                /**
+                 * Note: Both the source and the destination can
+                 *       be the inline buffer.
+                 */
+                traits_type::move(data_, str, size);
+                ensure_null_terminator_();
+
+                if (old_data != data_)
+                    deallocate_(old_data, old_capacity);
+            }
+
+            void reallocate_(size_type capacity)
+            {
+                auto old_data = data_;
+                auto old_capacity = capacity_;
+                auto new_data = allocate_(capacity);
 
-                data_ = allocator_.allocate(capacity_);
-                traits_type::copy(data_, str, size);
+                if (new_data != old_data)
+                {
+                    traits_type::copy(new_data, old_data, size_);
+                    data_ = new_data;
+                    deallocate_(old_data, old_capacity);
+                }
                 ensure_null_terminator_();
             }
 
@@ -1513,6 +1631,26 @@ namespace std
                     return max(capacity_ * 2, size_type{2u});
             }
 
+            /**
+             * Compares directly against a character array
+             * so that comparison with a literal does not
+             * need a temporary string.
+             */
+            int compare_(const value_type* other, size_type other_size) const noexcept
+            {
+                auto len = min(size(), other_size);
+                auto comp = traits_type::compare(data_, other, len);
+
+                if (comp != 0)
+                    return comp;
+                else if (size() == other_size)
+                    return 0;
+                else if (size() > other_size)
+                    return 1;
+                else
+                    return -1;
+            }
+
             void ensure_free_space_(size_type n)
             {
                 /**
@@ -1524,32 +1662,31 @@ namespace std
                     resize_with_copy_(size_, max(size_ + 1 + n, next_capacity_()));
             }
 
-            void resize_without_copy_(size_type capacity)
+            /**
+             * Makes room for size characters and the null
+             * terminator, discarding the current contents.
+             */
+            void resize_without_copy_(size_type size)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                auto old_data = data_;
+                auto old_capacity = capacity_;
+
+                data_ = allocate_(size + 1);
+                if (old_data != data_)
+                    deallocate_(old_data, old_capacity);
 
-                data_ = allocator_.allocate(capacity);
                 size_ = 0;
-                capacity_ = capacity;
                 ensure_null_terminator_();
             }
 
             void resize_with_copy_(size_type size, size_type capacity)
             {
-                if(capacity_ == 0 || capacity_ < capacity)
+                if (capacity_ < capacity)
                 {
-                    auto new_data = allocator_.allocate(capacity);
-
-                    auto to_copy = min(size, size_);
-                    traits_type::move(new_data, data_, to_copy);
-
-                    std::swap(data_, new_data);
-
-                    allocator_.deallocate(new_data, capacity_);
+                    size_ = min(size, size_);
+                    reallocate_(capacity);
                 }
 
-                capacity_ = capacity;
                 size_ = size;
                 ensure_null_terminator_();
             }
@@ -1609,6 +1746,19 @@ namespace std
     using u32string = basic_string<char32_t>;
     using wstring   = basic_string<wchar_t>;
 
+    namespace pmr
+    {
+        template<class Char, class Traits = char_traits<Char>>
+        using basic_string = std::basic_string<
+            Char, Traits, polymorphic_allocator<Char>
+        >;
+
+        using string    = basic_string<char>;
+        using u16string = basic_string<char16_t>;
+        using u32string = basic_string<char32_t>;
+        using wstring   = basic_string<wchar_t>;
+    }
+
     /**
      * 21.4.8, basic_string non-member functions:
      */
@@ -1926,23 +2076,41 @@ namespace std
     template<class>
     struct hash;
 
-    template<>
-    struct hash<string>
+    namespace aux
     {
-        size_t operator()(const string& str) const noexcept
+        /**
+         * FNV-1a over the characters of a string, reading them
+         * straight from the buffer (inline or not) instead of
+         * going through iterators.
+         */
+        template<class Char>
+        size_t string_hash(const Char* str, size_t len) noexcept
         {
-            size_t res{};
+            size_t res = sizeof(size_t) == 8 ?
+                static_cast<size_t>(0xcbf29ce484222325ULL) :
+                static_cast<size_t>(0x811c9dc5UL);
+            const size_t prime = sizeof(size_t) == 8 ?
+                static_cast<size_t>(0x100000001b3ULL) :
+                static_cast<size_t>(0x01000193UL);
 
-            /**
-             * Note: No need for fancy algorithms here,
-             *       std::hash is used for indexing, not
-             *       cryptography.
-             */
-            for (const auto& c: str)
-                res = res * 5 + (res >> 3) + static_cast<size_t>(c);
+            using uchar_type = typename make_unsigned<Char>::type;
+            for (size_t i = 0; i < len; ++i)
+            {
+                res ^= static_cast<size_t>(static_cast<uchar_type>(str[i]));
+                res *= prime;
+            }
 
             return res;
         }
+    }
+
+    template<>
+    struct hash<string>
+    {
+        size_t operator()(const string& str) const noexcept
+        {
+            return aux::string_hash(str.data(), str.size());
+        }
 
         using argument_type = string;
         using result_type   = size_t;
@@ -1953,9 +2121,7 @@ namespace std
     {
         size_t operator()(const wstring& str) const noexcept
         {
-            // TODO: implement
-            __unimplemented();
-            return size_t{};
+            return aux::string_hash(str.data(), str.size());
         }
 
         using argument_type = wstring;
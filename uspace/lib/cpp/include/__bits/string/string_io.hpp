@@ -94,7 +94,7 @@ namespace std
             auto size = str.size();
 
             size_t to_pad{};
-            if (width > 0)
+            if (width > 0 && static_cast<size_t>(width) > size)
                 to_pad = (static_cast<size_t>(width) - size);
 
             if (to_pad > 0)
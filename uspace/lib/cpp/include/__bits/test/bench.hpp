@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_TEST_BENCH
+#define LIBCPP_BITS_TEST_BENCH
+
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <vector>
+
+namespace std::test
+{
+    /**
+     * Benchmark configuration, size is the number of
+     * operations each benchmark performs per run.
+     */
+    struct bench_config
+    {
+        uint64_t size{10000};
+        int runs{3};
+        FILE* csv{nullptr};
+    };
+
+    /**
+     * Base of the benchmark suites. Unlike tests, benchmarks
+     * do not check anything (apart from sanity of their
+     * results), they report nanoseconds and allocations per
+     * operation and optionally write every run to a CSV
+     * report in the format used by hbench.
+     */
+    class bench_suite
+    {
+        public:
+            virtual void run(const bench_config&) = 0;
+            virtual const char* name() = 0;
+
+            virtual ~bench_suite() = default;
+
+            bool ok() const noexcept
+            {
+                return ok_;
+            }
+
+        protected:
+            bool ok_{true};
+
+            /**
+             * Runs fn(size) once as a warm-up (run index -1)
+             * and then config.runs times. The function returns
+             * a checksum that is kept alive so that the compiler
+             * cannot discard the work.
+             */
+            template<class Fn>
+            void measure(const bench_config& config, const char* bname, Fn&& fn)
+            {
+                for (int run = -1; run < config.runs; ++run)
+                {
+                    auto allocs_before = aux::allocation_count;
+                    aux::count_allocations = true;
+                    auto start = now_();
+
+                    sink_ += fn(config.size);
+
+                    auto end = now_();
+                    aux::count_allocations = false;
+
+                    record_(config, bname, run, end - start,
+                            aux::allocation_count - allocs_before);
+                }
+            }
+
+            void fail(const char* bname);
+
+        private:
+            uint64_t sink_{};
+
+            static uint64_t now_();
+            void record_(const bench_config&, const char*, int, uint64_t, size_t);
+    };
+
+    class bench_set
+    {
+        public:
+            bench_set() = default;
+
+            template<class T>
+            void add()
+            {
+                benches_.push_back(new T{});
+            }
+
+            bool run(const bench_config& config)
+            {
+                bool res{true};
+
+                if (config.csv)
+                    std::fprintf(config.csv, "benchmark,run,size,duration_nanos,allocations\n");
+
+                for (auto bench: benches_)
+                {
+                    bench->run(config);
+                    res &= bench->ok();
+                }
+
+                return res;
+            }
+
+            ~bench_set()
+            {
+                for (auto ptr: benches_)
+                    delete ptr;
+            }
+
+        private:
+            std::vector<bench_suite*> benches_{};
+    };
+
+    class containers_bench: public bench_suite
+    {
+        public:
+            void run(const bench_config&) override;
+            const char* name() override;
+        private:
+            void bench_vector(const bench_config&);
+            void bench_deque(const bench_config&);
+            void bench_list(const bench_config&);
+            void bench_map(const bench_config&);
+            void bench_unordered_map(const bench_config&);
+    };
+
+    class runtime_bench: public bench_suite
+    {
+        public:
+            void run(const bench_config&) override;
+            const char* name() override;
+        private:
+            void bench_string(const bench_config&);
+            void bench_sort(const bench_config&);
+            void bench_shared_ptr(const bench_config&);
+            void bench_iostream(const bench_config&);
+    };
+}
+
+#endif
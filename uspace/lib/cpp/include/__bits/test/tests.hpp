@@ -105,6 +105,8 @@ namespace std::test
             void test_construction_and_assignment();
             void test_insert();
             void test_erase();
+            void test_non_trivial();
+            void test_growth();
     };
 
     class string_test: public test_suite
@@ -123,6 +125,7 @@ namespace std::test
             void test_find();
             void test_substr();
             void test_compare();
+            void test_small_strings();
     };
 
     class bitset_test: public test_suite
@@ -205,6 +208,7 @@ namespace std::test
             void test_histogram();
             void test_emplace_insert();
             void test_multi();
+            void test_large();
     };
 
     class unordered_set_test: public test_suite
@@ -252,10 +256,26 @@ namespace std::test
             void test_unique_ptr();
             void test_shared_ptr();
             void test_weak_ptr();
+            void test_atomic_access();
+            void test_concurrent_refcount();
             void test_allocators();
             void test_pointers();
     };
 
+    class memory_resource_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_monotonic();
+            void test_pool();
+            void test_synchronized_pool();
+            void test_polymorphic_allocator();
+            void test_containers();
+    };
+
     class list_test: public test_suite
     {
         public:
@@ -293,6 +313,8 @@ namespace std::test
         private:
             void test_non_modifying();
             void test_mutating();
+            void test_sorting();
+            void test_parallel();
     };
 
     class future_test: public test_suite
@@ -305,9 +327,39 @@ namespace std::test
             void test_promise();
             void test_future_promise();
             void test_async();
+            void test_async_pool();
             void test_packaged_task();
             void test_shared_future();
     };
+
+    class regex_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+        private:
+            void test_match();
+            void test_search();
+            void test_syntax();
+            void test_back_references();
+            void test_iterators();
+            void test_replace();
+            void test_errors();
+            void test_throughput();
+    };
+
+    class iostream_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+        private:
+            void test_stringstream();
+            void test_formatting();
+            void test_filebuf();
+            void test_seek();
+            void test_throughput();
+    };
 }
 
 #endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_THREAD_EXECUTOR
+#define LIBCPP_BITS_THREAD_EXECUTOR
+
+#include <__bits/thread/threading.hpp>
+#include <cstddef>
+
+namespace std::aux
+{
+    /**
+     * Unit of work that can be queued in the executor,
+     * the queue links are intrusive so that submitting
+     * a task does not allocate.
+     */
+    class executor_task
+    {
+        public:
+            virtual void run() = 0;
+
+            virtual ~executor_task() = default;
+
+        private:
+            executor_task* prev_task_{nullptr};
+            executor_task* next_task_{nullptr};
+
+            friend class executor;
+    };
+
+    /**
+     * Process-wide pool of worker fibrils used by
+     * std::async(launch::async, ...). Workers are created
+     * lazily (up to max_workers()), reused for subsequent
+     * tasks and retire after being idle for a while.
+     * The fibrils are scheduled over the runner threads
+     * enabled by the threading policy.
+     */
+    class executor
+    {
+        public:
+            static executor& instance();
+
+            void submit(executor_task* task);
+
+            /**
+             * Removes the task from the queue if no worker
+             * has picked it up yet. This allows a waiter to run
+             * the task itself instead of blocking, which keeps
+             * nested async calls from exhausting the pool.
+             */
+            bool withdraw(executor_task* task);
+
+            void set_max_workers(size_t count);
+
+            size_t max_workers() const;
+
+            size_t workers() const;
+
+            executor(const executor&) = delete;
+            executor& operator=(const executor&) = delete;
+
+        private:
+            executor();
+
+            static constexpr size_t default_max_workers_{16};
+            static constexpr time_unit_t idle_timeout_{1000000};
+
+            mutex_t mtx_;
+            condvar_t cv_;
+
+            executor_task* head_;
+            executor_task* tail_;
+
+            size_t workers_;
+            size_t idle_;
+            size_t max_workers_;
+            bool multithreaded_;
+
+            executor_task* pop_();
+            void spawn_worker_();
+
+            static int worker_main_(void* arg);
+    };
+}
+
+#endif
@@ -37,6 +37,7 @@
 #include <__bits/functional/function.hpp>
 #include <__bits/functional/invoke.hpp>
 #include <__bits/refcount_obj.hpp>
+#include <__bits/thread/executor.hpp>
 #include <__bits/thread/future_common.hpp>
 #include <__bits/thread/threading.hpp>
 #include <cerrno>
@@ -270,42 +271,38 @@ namespace std::aux
      */
 
     template<class R, class F, class... Args>
-    class async_shared_state: public shared_state<R>
+    class async_shared_state: public shared_state<R>, public executor_task
     {
         public:
             async_shared_state(F&& f, Args&&... args)
-                : shared_state<R>{}, thread_{}
+                : shared_state<R>{}, func_{forward<F>(f)},
+                  args_{forward<Args>(args)...}
             {
-                thread_ = thread{
-                    [=](){
-                        try
-                        {
-                            if constexpr (!is_same_v<R, void>)
-                                this->set_value(invoke(f, args...));
-                            else
-                            {
-                                invoke(f, args...);
-                                this->mark_set(true);
-                            }
-                        }
-                        catch(const exception& __exception)
-                        {
-                            this->set_exception(make_exception_ptr(__exception));
-                        }
-                    }
-                };
+                executor::instance().submit(this);
+            }
+
+            void run() override
+            {
+                invoke_(make_index_sequence<sizeof...(Args)>{});
             }
 
             void destroy() override
             {
-                if (!this->is_set())
-                    thread_.join();
+                wait();
             }
 
             void wait() const override
             {
-                if (!this->is_set())
-                    const_cast<thread&>(thread_).join();
+                auto self = const_cast<async_shared_state<R, F, Args...>*>(this);
+
+                /**
+                 * If no worker got to the task yet, we run it
+                 * ourselves instead of blocking on a free worker.
+                 */
+                if (!this->is_set() && executor::instance().withdraw(self))
+                    self->run();
+
+                shared_state_base::wait();
             }
 
             ~async_shared_state() override
@@ -314,21 +311,34 @@ namespace std::aux
             }
 
         protected:
-            future_status timed_wait_(aux::time_unit_t time) const override
+            function<R(decay_t<Args>...)> func_;
+            tuple<decay_t<Args>...> args_;
+
+            template<size_t... Is>
+            void invoke_(index_sequence<Is...>)
             {
+                try
+                {
+                    if constexpr (!is_same_v<R, void>)
+                        this->value_ = invoke(move(func_), get<Is>(move(args_))...);
+                    else
+                        invoke(move(func_), get<Is>(move(args_))...);
+                }
+                catch(const exception& __exception)
+                {
+                    this->set_exception(make_exception_ptr(__exception));
+                }
+
                 /**
-                 * Note: Currently we have no timed join, but this
-                 *       behaviour should be compliant.
+                 * Note: The state is marked ready and the waiters
+                 *       are woken with the mutex held, once we unlock
+                 *       it the waiter may destroy the state.
                  */
-                aux::threading::time::sleep(time);
-                if (this->value_set_)
-                    return future_status::ready;
-                else
-                    return future_status::timeout;
+                aux::threading::mutex::lock(this->mutex_);
+                this->value_set_ = true;
+                aux::threading::condvar::broadcast(this->condvar_);
+                aux::threading::mutex::unlock(this->mutex_);
             }
-
-        private:
-            thread thread_;
     };
 
     template<class R, class F, class... Args>
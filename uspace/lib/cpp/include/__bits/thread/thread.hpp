@@ -57,6 +57,8 @@ namespace std
                     aux::threading::condvar::init(join_cv_);
                 }
 
+                virtual ~joinable_wrapper() = default;
+
                 void join()
                 {
                     aux::threading::mutex::lock(join_mtx_);
@@ -70,9 +72,19 @@ namespace std
                     return finished_;
                 }
 
-                void detach()
+                /**
+                 * Returns true if the fibril has already
+                 * finished, in which case the caller is
+                 * responsible for deleting the wrapper.
+                 */
+                bool detach()
                 {
+                    aux::threading::mutex::lock(join_mtx_);
                     detached_ = true;
+                    bool res = finished_;
+                    aux::threading::mutex::unlock(join_mtx_);
+
+                    return res;
                 }
 
                 bool detached() const
@@ -95,15 +107,25 @@ namespace std
                     : joinable_wrapper{}, callable_{forward<Callable>(clbl)}
                 { /* DUMMY BODY */ }
 
-                void operator()()
+                /**
+                 * Returns true if the thread was detached,
+                 * in which case nobody else will delete
+                 * the wrapper.
+                 * Note: The wrapper must not be touched after
+                 *       the mutex is released as the joiner
+                 *       may delete it at that point.
+                 */
+                bool operator()()
                 {
                     callable_();
 
                     aux::threading::mutex::lock(join_mtx_);
                     finished_ = true;
+                    bool res = detached_;
+                    aux::threading::condvar::broadcast(join_cv_);
                     aux::threading::mutex::unlock(join_mtx_);
 
-                    aux::threading::condvar::broadcast(join_cv_);
+                    return res;
                 }
 
             private:
@@ -194,9 +216,7 @@ namespace std
                 return 1;
 
             auto callable = static_cast<CallablePtr>(clbl);
-            (*callable)();
-
-            if (callable->detached())
+            if ((*callable)())
                 delete callable;
 
             return 0;
@@ -77,6 +77,11 @@ namespace std::aux
                 ::helenos::fibril_yield();
             }
 
+            static void enable_multithreaded()
+            {
+                ::helenos::fibril_enable_multithreaded();
+            }
+
             /**
              * Note: join & detach are performed at the C++
              *       level at the moment, but eventually should
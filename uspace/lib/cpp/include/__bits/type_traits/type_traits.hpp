@@ -107,6 +107,9 @@ namespace std
             char16_t, char32_t, wchar_t>
     { /* DUMMY BODY */ };
 
+    template<class T>
+    inline constexpr bool is_integral_v = is_integral<T>::value;
+
     template<class T>
     struct is_floating_point
         : aux::is_one_of<remove_cv_t<T>, float, double, long double>
@@ -531,7 +534,7 @@ namespace std
     inline constexpr bool is_trivial_v = is_trivial<T>::value;
 
     template<class T>
-    struct is_trivially_copyable: aux::value_is<bool, __has_trivial_copy(T)>
+    struct is_trivially_copyable: aux::value_is<bool, __is_trivially_copyable(T)>
     { /* DUMMY BODY */ };
 
     template<class T>
@@ -650,14 +653,20 @@ namespace std
 
     template<class T>
     struct is_copy_constructible
-        : is_constructible<T, add_lvalue_reference<const T>>
+        : is_constructible<T, add_lvalue_reference_t<const T>>
     { /* DUMMY BODY */ };
 
+    template<class T>
+    inline constexpr bool is_copy_constructible_v = is_copy_constructible<T>::value;
+
     template<class T>
     struct is_move_constructible
-        : is_constructible<T, add_rvalue_reference<T>>
+        : is_constructible<T, add_rvalue_reference_t<T>>
     { /* DUMMY BODY */ };
 
+    template<class T>
+    inline constexpr bool is_move_constructible_v = is_move_constructible<T>::value;
+
     template<class T, class U, class = void>
     struct is_assignable: false_type
     { /* DUMMY BODY */ };
@@ -734,12 +743,27 @@ namespace std
     template<class T>
     inline constexpr bool is_trivially_destructible_v = is_trivially_destructible<T>::value;
 
+    namespace aux
+    {
+        template<class, class T, class... Args>
+        struct is_nothrow_constructible: false_type
+        { /* DUMMY BODY */ };
+
+        template<class T, class... Args>
+        struct is_nothrow_constructible<
+            void_t<decltype(T(declval<Args>()...))>,
+            T, Args...
+        >
+            : value_is<bool, noexcept(T(declval<Args>()...))>
+        { /* DUMMY BODY */ };
+    }
+
     template<class T, class... Args>
-    struct is_nothrow_constructible: aux::value_is<bool, __has_nothrow_constructor(T)>
+    struct is_nothrow_constructible: aux::is_nothrow_constructible<void_t<>, T, Args...>
     { /* DUMMY BODY */ };
 
-    template<class T>
-    inline constexpr bool is_nothrow_constructible_v = is_nothrow_constructible<T>::value;
+    template<class T, class... Args>
+    inline constexpr bool is_nothrow_constructible_v = is_nothrow_constructible<T, Args...>::value;
 
     template<class T>
     struct is_nothrow_default_constructible
@@ -755,9 +779,12 @@ namespace std
 
     template<class T>
     struct is_nothrow_move_constructible
-        : is_nothrow_constructible<add_lvalue_reference_t<T>, add_rvalue_reference_t<T>>
+        : is_nothrow_constructible<T, add_rvalue_reference_t<T>>
     { /* DUMMY BODY */ };
 
+    template<class T>
+    inline constexpr bool is_nothrow_move_constructible_v = is_nothrow_move_constructible<T>::value;
+
     template<class T, class U>
     struct is_nothrow_assignable: aux::value_is<bool, __has_nothrow_assign(T)>
     { /* DUMMY BODY */ };
@@ -999,7 +1026,7 @@ namespace std
     using make_signed_t = typename make_signed<T>::type;
 
     template<class T>
-    using make_unsigned_t = typename make_signed<T>::type;
+    using make_unsigned_t = typename make_unsigned<T>::type;
 
     /**
      * 20.10.7.4, array modifications:
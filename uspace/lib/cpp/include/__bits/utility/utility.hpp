@@ -103,6 +103,21 @@ namespace std
         return old_val;
     }
 
+    /**
+     * 20.2.4, forward/move helpers:
+     * Note: The rest lives in forward_move.hpp, this
+     *       one needs the type traits.
+     */
+
+    template<class T>
+    constexpr conditional_t<
+        !is_nothrow_move_constructible_v<T> && is_copy_constructible_v<T>,
+        const T&, T&&
+    > move_if_noexcept(T& x) noexcept
+    {
+        return move(x);
+    }
+
     /**
      * 20.5.2, class template integer_sequence:
      */
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/thread/executor.hpp>
+#include <cerrno>
+
+namespace std::aux
+{
+    executor& executor::instance()
+    {
+        /**
+         * Note: Workers may outlive any static destructor,
+         *       so the executor is intentionally never freed.
+         */
+        static executor* inst = new executor{};
+
+        return *inst;
+    }
+
+    executor::executor()
+        : mtx_{}, cv_{}, head_{}, tail_{}, workers_{},
+          idle_{}, max_workers_{default_max_workers_},
+          multithreaded_{false}
+    {
+        threading::mutex::init(mtx_);
+        threading::condvar::init(cv_);
+    }
+
+    void executor::submit(executor_task* task)
+    {
+        threading::mutex::lock(mtx_);
+
+        task->next_task_ = nullptr;
+        task->prev_task_ = tail_;
+        if (tail_)
+            tail_->next_task_ = task;
+        else
+            head_ = task;
+        tail_ = task;
+
+        if (idle_ > 0)
+            threading::condvar::signal(cv_);
+        else if (workers_ < max_workers_)
+            spawn_worker_();
+
+        threading::mutex::unlock(mtx_);
+    }
+
+    bool executor::withdraw(executor_task* task)
+    {
+        threading::mutex::lock(mtx_);
+
+        bool queued = task->prev_task_ || head_ == task;
+        if (queued)
+        {
+            if (task->prev_task_)
+                task->prev_task_->next_task_ = task->next_task_;
+            else
+                head_ = task->next_task_;
+
+            if (task->next_task_)
+                task->next_task_->prev_task_ = task->prev_task_;
+            else
+                tail_ = task->prev_task_;
+
+            task->prev_task_ = task->next_task_ = nullptr;
+        }
+
+        threading::mutex::unlock(mtx_);
+
+        return queued;
+    }
+
+    void executor::set_max_workers(size_t count)
+    {
+        threading::mutex::lock(mtx_);
+        max_workers_ = count > 0 ? count : 1;
+        threading::mutex::unlock(mtx_);
+    }
+
+    size_t executor::max_workers() const
+    {
+        return max_workers_;
+    }
+
+    size_t executor::workers() const
+    {
+        return workers_;
+    }
+
+    executor_task* executor::pop_()
+    {
+        auto task = head_;
+        if (!task)
+            return nullptr;
+
+        head_ = task->next_task_;
+        if (head_)
+            head_->prev_task_ = nullptr;
+        else
+            tail_ = nullptr;
+
+        task->prev_task_ = task->next_task_ = nullptr;
+
+        return task;
+    }
+
+    void executor::spawn_worker_()
+    {
+        /**
+         * Note: The worker count is only changed with
+         *       the mutex held, which callers guarantee.
+         */
+        if (!multithreaded_)
+        {
+            threading::thread::enable_multithreaded();
+            multithreaded_ = true;
+        }
+
+        auto fid = threading::thread::create(worker_main_, *this);
+        if (!fid)
+            return;
+
+        ++workers_;
+        threading::thread::start(fid);
+    }
+
+    int executor::worker_main_(void* arg)
+    {
+        auto& exec = *static_cast<executor*>(arg);
+
+        threading::mutex::lock(exec.mtx_);
+        while (true)
+        {
+            auto task = exec.pop_();
+            if (task)
+            {
+                threading::mutex::unlock(exec.mtx_);
+                task->run();
+                threading::mutex::lock(exec.mtx_);
+
+                continue;
+            }
+
+            if (exec.workers_ > exec.max_workers_)
+                break;
+
+            ++exec.idle_;
+            auto rc = threading::condvar::wait_for(
+                exec.cv_, exec.mtx_, idle_timeout_
+            );
+            --exec.idle_;
+
+            if (rc == ETIMEOUT && !exec.head_)
+                break;
+        }
+
+        --exec.workers_;
+        threading::mutex::unlock(exec.mtx_);
+
+        return 0;
+    }
+}
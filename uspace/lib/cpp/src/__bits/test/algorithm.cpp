@@ -29,8 +29,12 @@
 #include <__bits/test/tests.hpp>
 #include <algorithm>
 #include <array>
+#include <execution>
+#include <list>
+#include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace std::test
 {
@@ -41,6 +45,8 @@ namespace std::test
 
         test_non_modifying();
         test_mutating();
+        test_sorting();
+        test_parallel();
 
         return end();
     }
@@ -293,4 +299,242 @@ namespace std::test
         );
         test_eq("transform pt2", res6, data10.end());
     }
+    void algorithm_test::test_sorting()
+    {
+        auto check1 = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        std::array<int, 9> data1{5, 3, 9, 1, 7, 2, 8, 4, 6};
+
+        std::sort(data1.begin(), data1.end());
+        test_eq(
+            "sort small", check1.begin(), check1.end(),
+            data1.begin(), data1.end()
+        );
+
+        auto check2 = {9, 8, 7, 6, 5, 4, 3, 2, 1};
+        std::sort(
+            data1.begin(), data1.end(),
+            [](auto x, auto y){ return x > y; }
+        );
+        test_eq(
+            "sort comp", check2.begin(), check2.end(),
+            data1.begin(), data1.end()
+        );
+
+        /**
+         * Simple LCG so that the large cases are
+         * reproducible between runs.
+         */
+        unsigned int seed{12345};
+        auto next_rand = [&seed](){
+            seed = seed * 1103515245U + 12345U;
+            return static_cast<int>((seed >> 8) % 100000);
+        };
+
+        /**
+         * Count comparisons to check that no input pattern
+         * makes sort degrade to quadratic behaviour, the bound
+         * is a generous multiple of n * log2(n).
+         */
+        const size_t count{100000};
+        const size_t max_comparisons{3 * count * 17};
+        size_t comparisons{};
+        auto counting_less = [&comparisons](auto x, auto y){
+            ++comparisons;
+            return x < y;
+        };
+
+        std::vector<int> data2(count);
+        for (auto& x: data2)
+            x = next_rand();
+        std::sort(data2.begin(), data2.end(), counting_less);
+        test("sort random", std::is_sorted(data2.begin(), data2.end()));
+        test("sort random comparisons", comparisons <= max_comparisons);
+
+        comparisons = 0;
+        std::sort(data2.begin(), data2.end(), counting_less);
+        test("sort sorted", std::is_sorted(data2.begin(), data2.end()));
+        test("sort sorted comparisons", comparisons <= max_comparisons);
+
+        comparisons = 0;
+        std::reverse(data2.begin(), data2.end());
+        std::sort(data2.begin(), data2.end(), counting_less);
+        test("sort reversed", std::is_sorted(data2.begin(), data2.end()));
+        test("sort reversed comparisons", comparisons <= max_comparisons);
+
+        comparisons = 0;
+        for (size_t i = 0; i < count; ++i)
+            data2[i] = static_cast<int>(i < count / 2 ? i : count - i);
+        std::sort(data2.begin(), data2.end(), counting_less);
+        test("sort organ pipe", std::is_sorted(data2.begin(), data2.end()));
+        test("sort organ pipe comparisons", comparisons <= max_comparisons);
+
+        comparisons = 0;
+        for (auto& x: data2)
+            x = 42;
+        std::sort(data2.begin(), data2.end(), counting_less);
+        test("sort equal comparisons", comparisons <= max_comparisons);
+
+        /**
+         * Stability: sort by key only and check that
+         * elements with equal keys keep their order.
+         */
+        std::vector<std::pair<int, int>> data3(count / 10);
+        for (size_t i = 0; i < data3.size(); ++i)
+            data3[i] = std::make_pair(next_rand() % 100, static_cast<int>(i));
+        std::stable_sort(
+            data3.begin(), data3.end(),
+            [](const auto& x, const auto& y){ return x.first < y.first; }
+        );
+
+        bool stable{true};
+        for (size_t i = 1; i < data3.size(); ++i)
+        {
+            if (data3[i - 1].first > data3[i].first ||
+                (data3[i - 1].first == data3[i].first &&
+                 data3[i - 1].second > data3[i].second))
+                stable = false;
+        }
+        test("stable_sort", stable);
+
+        auto check3 = {1, 2, 3, 4};
+        std::array<int, 9> data4{5, 3, 9, 1, 7, 2, 8, 4, 6};
+        std::partial_sort(data4.begin(), data4.begin() + 4, data4.end());
+        test_eq(
+            "partial_sort small", check3.begin(), check3.end(),
+            data4.begin(), data4.begin() + 4
+        );
+
+        std::vector<int> data5(count);
+        for (auto& x: data5)
+            x = next_rand();
+        auto data6 = data5;
+        std::sort(data6.begin(), data6.end());
+
+        auto data7 = data5;
+        std::partial_sort(data7.begin(), data7.begin() + 100, data7.end());
+        test_eq(
+            "partial_sort large", data6.begin(), data6.begin() + 100,
+            data7.begin(), data7.begin() + 100
+        );
+
+        std::array<int, 5> data8{};
+        auto res1 = std::partial_sort_copy(
+            data5.begin(), data5.end(), data8.begin(), data8.end()
+        );
+        test_eq(
+            "partial_sort_copy pt1", data6.begin(), data6.begin() + 5,
+            data8.begin(), data8.end()
+        );
+        test_eq("partial_sort_copy pt2", res1, data8.end());
+
+        auto data9 = data5;
+        auto nth = data9.begin() + count / 3;
+        std::nth_element(data9.begin(), nth, data9.end());
+        test_eq("nth_element pt1", *nth, data6[count / 3]);
+
+        bool partitioned{true};
+        for (auto it = data9.begin(); it != data9.end(); ++it)
+        {
+            if ((it < nth && *nth < *it) || (it > nth && *it < *nth))
+                partitioned = false;
+        }
+        test("nth_element pt2", partitioned);
+    }
+
+    void algorithm_test::test_parallel()
+    {
+        constexpr std::size_t count{100000};
+        auto data1 = new int[count];
+        auto data2 = new int[count];
+        auto data3 = new int[count];
+        for (std::size_t i = 0; i < count; ++i)
+            data1[i] = static_cast<int>((i * 7919) % 1009) - 504;
+
+        std::for_each(
+            std::execution::par, data1, data1 + count,
+            [](int& x){ x *= 2; }
+        );
+        test_eq("par for_each", data1[count - 1], 2 * (static_cast<int>(((count - 1) * 7919) % 1009) - 504));
+
+        auto res1 = std::transform(
+            std::execution::par, data1, data1 + count, data2,
+            [](int x){ return x / 2; }
+        );
+        std::transform(
+            data1, data1 + count, data3,
+            [](int x){ return x / 2; }
+        );
+        test_eq("par transform pt1", data2, data2 + count, data3, data3 + count);
+        test_eq("par transform pt2", res1, data2 + count);
+
+        std::transform(
+            std::execution::par, data1, data1 + count, data2, data3,
+            [](int x, int y){ return x - y; }
+        );
+        test_eq("par transform binary", data3, data3 + count, data2, data2 + count);
+
+        auto sum = std::accumulate(data2, data2 + count, 0L);
+        test_eq("par reduce pt1", std::reduce(std::execution::par, data2, data2 + count, 0L), sum);
+        test_eq("par reduce pt2", std::reduce(std::execution::seq, data2, data2 + count, 0L), sum);
+        test_eq("par reduce pt3", std::reduce(data2, data2 + count, 0L), sum);
+
+        auto dot = std::inner_product(data2, data2 + count, data3, 0L);
+        test_eq(
+            "par transform_reduce pt1",
+            std::transform_reduce(std::execution::par, data2, data2 + count, data3, 0L),
+            dot
+        );
+        test_eq(
+            "par transform_reduce pt2",
+            std::transform_reduce(
+                std::execution::par, data2, data2 + count, 0L,
+                std::plus<>{}, [](int x){ return x < 0 ? -x : x; }
+            ),
+            std::transform_reduce(
+                data2, data2 + count, 0L,
+                std::plus<>{}, [](int x){ return x < 0 ? -x : x; }
+            )
+        );
+
+        std::partial_sum(data2, data2 + count, data3);
+        auto res2 = std::inclusive_scan(std::execution::par, data2, data2 + count, data1);
+        test_eq("par inclusive_scan pt1", data1, data1 + count, data3, data3 + count);
+        test_eq("par inclusive_scan pt2", res2, data1 + count);
+        std::inclusive_scan(
+            std::execution::par, data2, data2 + count, data1,
+            std::plus<>{}, 10
+        );
+        test_eq("par inclusive_scan pt3", data1[count - 1], data3[count - 1] + 10);
+
+        auto res3 = std::copy_if(
+            std::execution::par, data2, data2 + count, data1,
+            [](int x){ return x % 3 == 0; }
+        );
+        auto res4 = std::copy_if(
+            data2, data2 + count, data3,
+            [](int x){ return x % 3 == 0; }
+        );
+        test_eq("par copy_if pt1", data1, res3, data3, res4);
+
+        std::copy(data2, data2 + count, data1);
+        std::sort(std::execution::par, data1, data1 + count);
+        std::sort(data2, data2 + count);
+        test_eq("par sort pt1", data1, data1 + count, data2, data2 + count);
+
+        std::sort(
+            std::execution::par_unseq, data1, data1 + count,
+            [](int x, int y){ return y < x; }
+        );
+        test("par sort pt2", std::is_sorted(
+            data1, data1 + count, [](int x, int y){ return y < x; }
+        ));
+
+        // Non random access iterators use the sequential algorithms.
+        std::list<int> lst{5, 1, 4, 2, 3};
+        test_eq("par list reduce", std::reduce(std::execution::par, lst.begin(), lst.end()), 15);
+
+        delete[] data1;
+        delete[] data2;
+        delete[] data3;
+    }
 }
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/bench.hpp>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+namespace std::test
+{
+    void bench_suite::fail(const char* bname)
+    {
+        std::printf("[%s][%s] ... FAIL\n", name(), bname);
+        ok_ = false;
+    }
+
+    uint64_t bench_suite::now_()
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()
+        );
+    }
+
+    void bench_suite::record_(const bench_config& config, const char* bname,
+                              int run, uint64_t nanos, size_t allocs)
+    {
+        if (config.csv)
+        {
+            std::fprintf(config.csv, "cpp_%s_%s,%d,%" PRIu64 ",%" PRIu64 ",%zu\n",
+                         name(), bname, run, config.size, nanos, allocs);
+        }
+
+        // Warm-up runs are only recorded in the report.
+        if (run < 0)
+            return;
+
+        /**
+         * Note: Fixed point with two decimal places, so that
+         *       we do not depend on floating point printf.
+         */
+        auto size = config.size > 0 ? config.size : 1;
+        auto ns = nanos * 100 / size;
+        auto al = static_cast<uint64_t>(allocs) * 100 / size;
+
+        std::printf("[%s][%s] run %d: %" PRIu64 ".%02" PRIu64 " ns/op, %"
+                    PRIu64 ".%02" PRIu64 " allocs/op\n", name(), bname, run,
+                    ns / 100, ns % 100, al / 100, al % 100);
+    }
+}
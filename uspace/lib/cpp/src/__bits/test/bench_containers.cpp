@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/bench.hpp>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    /**
+     * Keys are scattered by a multiplicative hash so that
+     * tree and hash containers do not see sorted input.
+     */
+    uint64_t key(uint64_t i)
+    {
+        return (i * 2654435761U) & 0xFFFFFFFFU;
+    }
+}
+
+namespace std::test
+{
+    void containers_bench::run(const bench_config& config)
+    {
+        bench_vector(config);
+        bench_deque(config);
+        bench_list(config);
+        bench_map(config);
+        bench_unordered_map(config);
+    }
+
+    const char* containers_bench::name()
+    {
+        return "containers";
+    }
+
+    void containers_bench::bench_vector(const bench_config& config)
+    {
+        measure(config, "vector_insert", [](uint64_t size){
+            std::vector<uint64_t> vec{};
+            for (uint64_t i = 0; i < size; ++i)
+                vec.push_back(i);
+
+            return vec.size();
+        });
+
+        std::vector<uint64_t> vec{};
+        for (uint64_t i = 0; i < config.size; ++i)
+            vec.push_back(key(i));
+
+        measure(config, "vector_lookup", [&vec](uint64_t size){
+            uint64_t sum{};
+            for (uint64_t i = 0; i < size; ++i)
+                sum += vec[key(i) % vec.size()];
+
+            return sum;
+        });
+
+        measure(config, "vector_iterate", [&vec](uint64_t){
+            uint64_t sum{};
+            for (auto x: vec)
+                sum += x;
+
+            return sum;
+        });
+    }
+
+    void containers_bench::bench_deque(const bench_config& config)
+    {
+        measure(config, "deque_insert", [](uint64_t size){
+            std::deque<uint64_t> deq{};
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                if (i % 2 == 0)
+                    deq.push_back(i);
+                else
+                    deq.push_front(i);
+            }
+
+            return deq.size();
+        });
+
+        std::deque<uint64_t> deq{};
+        for (uint64_t i = 0; i < config.size; ++i)
+            deq.push_back(key(i));
+
+        measure(config, "deque_lookup", [&deq](uint64_t size){
+            uint64_t sum{};
+            for (uint64_t i = 0; i < size; ++i)
+                sum += deq[key(i) % deq.size()];
+
+            return sum;
+        });
+
+        measure(config, "deque_iterate", [&deq](uint64_t){
+            uint64_t sum{};
+            for (auto x: deq)
+                sum += x;
+
+            return sum;
+        });
+    }
+
+    void containers_bench::bench_list(const bench_config& config)
+    {
+        measure(config, "list_insert", [](uint64_t size){
+            std::list<uint64_t> lst{};
+            for (uint64_t i = 0; i < size; ++i)
+                lst.push_back(i);
+
+            return lst.size();
+        });
+
+        std::list<uint64_t> lst{};
+        for (uint64_t i = 0; i < config.size; ++i)
+            lst.push_back(key(i));
+
+        measure(config, "list_iterate", [&lst](uint64_t){
+            uint64_t sum{};
+            for (auto x: lst)
+                sum += x;
+
+            return sum;
+        });
+    }
+
+    void containers_bench::bench_map(const bench_config& config)
+    {
+        measure(config, "map_insert", [](uint64_t size){
+            std::map<uint64_t, uint64_t> mp{};
+            for (uint64_t i = 0; i < size; ++i)
+                mp.emplace(key(i), i);
+
+            return mp.size();
+        });
+
+        std::map<uint64_t, uint64_t> mp{};
+        for (uint64_t i = 0; i < config.size; ++i)
+            mp.emplace(key(i), i);
+
+        measure(config, "map_lookup", [&mp](uint64_t size){
+            uint64_t found{};
+            for (uint64_t i = 0; i < size; ++i)
+                found += mp.count(key(i));
+
+            return found;
+        });
+
+        measure(config, "map_iterate", [&mp](uint64_t){
+            uint64_t sum{};
+            for (const auto& x: mp)
+                sum += x.second;
+
+            return sum;
+        });
+
+        if (mp.size() != config.size)
+            fail("map_size");
+    }
+
+    void containers_bench::bench_unordered_map(const bench_config& config)
+    {
+        measure(config, "unordered_map_insert", [](uint64_t size){
+            std::unordered_map<uint64_t, uint64_t> mp{};
+            for (uint64_t i = 0; i < size; ++i)
+                mp.emplace(key(i), i);
+
+            return mp.size();
+        });
+
+        std::unordered_map<uint64_t, uint64_t> mp{};
+        for (uint64_t i = 0; i < config.size; ++i)
+            mp.emplace(key(i), i);
+
+        measure(config, "unordered_map_lookup", [&mp](uint64_t size){
+            uint64_t found{};
+            for (uint64_t i = 0; i < size; ++i)
+                found += mp.count(key(i));
+
+            return found;
+        });
+
+        measure(config, "unordered_map_iterate", [&mp](uint64_t){
+            uint64_t sum{};
+            for (const auto& x: mp)
+                sum += x.second;
+
+            return sum;
+        });
+
+        if (mp.size() != config.size)
+            fail("unordered_map_size");
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/bench.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace std::test
+{
+    void runtime_bench::run(const bench_config& config)
+    {
+        bench_string(config);
+        bench_sort(config);
+        bench_shared_ptr(config);
+        bench_iostream(config);
+    }
+
+    const char* runtime_bench::name()
+    {
+        return "runtime";
+    }
+
+    void runtime_bench::bench_string(const bench_config& config)
+    {
+        measure(config, "string_append", [](uint64_t size){
+            std::string str{};
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                str += "abc";
+                str.push_back('d');
+            }
+
+            return str.size();
+        });
+
+        // Short strings stay in the inline buffer.
+        measure(config, "string_short", [](uint64_t size){
+            uint64_t len{};
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                std::string str{"key"};
+                str += std::to_string(static_cast<int>(i % 1000));
+                len += str.size();
+            }
+
+            return len;
+        });
+    }
+
+    void runtime_bench::bench_sort(const bench_config& config)
+    {
+        std::vector<uint64_t> data{};
+        uint64_t x{88172645463325252ULL};
+        for (uint64_t i = 0; i < config.size; ++i)
+        {
+            // Xorshift, deterministic across runs.
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            data.push_back(x);
+        }
+
+        bool sorted{true};
+        measure(config, "sort", [&data, &sorted](uint64_t){
+            auto vec = data;
+            std::sort(vec.begin(), vec.end());
+            sorted &= std::is_sorted(vec.begin(), vec.end());
+
+            return vec.front();
+        });
+
+        if (!sorted)
+            fail("sort");
+    }
+
+    void runtime_bench::bench_shared_ptr(const bench_config& config)
+    {
+        auto ptr = std::make_shared<uint64_t>(uint64_t{42});
+
+        measure(config, "shared_ptr_copy", [&ptr](uint64_t size){
+            uint64_t sum{};
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                auto copy = ptr;
+                sum += *copy;
+            }
+
+            return sum;
+        });
+
+        measure(config, "make_shared", [](uint64_t size){
+            uint64_t sum{};
+            for (uint64_t i = 0; i < size; ++i)
+                sum += *std::make_shared<uint64_t>(i);
+
+            return sum;
+        });
+
+        if (ptr.use_count() != 1)
+            fail("shared_ptr_use_count");
+    }
+
+    void runtime_bench::bench_iostream(const bench_config& config)
+    {
+        measure(config, "iostream_format", [](uint64_t size){
+            std::ostringstream oss{};
+            for (uint64_t i = 0; i < size; ++i)
+                oss << static_cast<unsigned long>(i) << ' ' << "x" << '\n';
+
+            return oss.str().size();
+        });
+
+        std::ostringstream oss{};
+        for (uint64_t i = 0; i < config.size; ++i)
+            oss << static_cast<unsigned long>(i) << '\n';
+        auto text = oss.str();
+
+        measure(config, "iostream_parse", [&text](uint64_t size){
+            std::istringstream iss{text};
+            uint64_t sum{};
+            unsigned long x{};
+            for (uint64_t i = 0; i < size; ++i)
+            {
+                iss >> x;
+                sum += x;
+            }
+
+            return sum;
+        });
+    }
+}
@@ -29,6 +29,7 @@
 #include <__bits/test/mock.hpp>
 #include <__bits/test/tests.hpp>
 #include <chrono>
+#include <cstdio>
 #include <exception>
 #include <future>
 #include <tuple>
@@ -64,6 +65,7 @@ namespace std::test
         test_promise();
         test_future_promise();
         test_async();
+        test_async_pool();
         test_packaged_task();
         test_shared_future();
 
@@ -277,6 +279,62 @@ namespace std::test
         test_eq("void async", x, 42);
     }
 
+    void future_test::test_async_pool()
+    {
+        constexpr int count{1000};
+        std::future<int> futures[count];
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i)
+        {
+            futures[i] = std::async(
+                std::launch::async, [](int x){
+                    return 2 * x;
+                }, i
+            );
+        }
+
+        bool ok{true};
+        for (int i = 0; i < count; ++i)
+            ok = ok && futures[i].get() == 2 * i;
+        auto end = std::chrono::steady_clock::now();
+        test("async pool results", ok);
+
+        auto& exec = std::aux::executor::instance();
+        test("async pool bounded", exec.workers() <= exec.max_workers());
+
+        if (report_)
+        {
+            auto usecs = std::chrono::duration_cast<std::chrono::microseconds>(
+                end - start
+            ).count();
+            std::printf(
+                "[%s] %d async tasks in %lld us\n",
+                name(), count, static_cast<long long>(usecs)
+            );
+        }
+
+        /**
+         * A task waiting for another task must not
+         * deadlock even if all workers are busy.
+         */
+        auto old_max = exec.max_workers();
+        exec.set_max_workers(1);
+        auto outer = std::async(
+            std::launch::async, [](){
+                auto inner = std::async(
+                    std::launch::async, [](){
+                        return 21;
+                    }
+                );
+
+                return 2 * inner.get();
+            }
+        );
+        test_eq("nested async", outer.get(), 42);
+        exec.set_max_workers(old_max);
+    }
+
     void future_test::test_packaged_task()
     {
         std::packaged_task<int(int)> pt1{};
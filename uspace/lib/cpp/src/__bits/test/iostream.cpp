@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    const char* test_file{"/tmp/cpptest_iostream.txt"};
+}
+
+namespace std::test
+{
+    bool iostream_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_stringstream();
+        test_formatting();
+        test_filebuf();
+        test_seek();
+        test_throughput();
+
+        std::remove(test_file);
+
+        return end();
+    }
+
+    const char* iostream_test::name()
+    {
+        return "iostream";
+    }
+
+    void iostream_test::test_stringstream()
+    {
+        std::ostringstream oss1{};
+        oss1 << 'a' << 'b' << 123 << "xyz" << std::string{"QQ"};
+        test_eq("ostringstream", oss1.str(), std::string{"ab123xyzQQ"});
+
+        std::ostringstream oss2{};
+        oss2.write("hello world", 11);
+        test_eq("write", oss2.str(), std::string{"hello world"});
+
+        std::string long_str(100, 'x');
+        std::ostringstream oss3{};
+        oss3 << long_str << long_str;
+        test_eq("long writes", oss3.str().size(), 200U);
+
+        std::ostringstream oss4{"abcdef"};
+        oss4 << "XY";
+        test_eq("overwrite", oss4.str(), std::string{"XYcdef"});
+
+        std::ostringstream oss5{"abc", std::ios_base::out | std::ios_base::ate};
+        oss5 << "de";
+        test_eq("ate", oss5.str(), std::string{"abcde"});
+
+        std::stringstream ss{};
+        ss << 42 << ' ' << 17;
+        int a{}, b{};
+        ss >> a >> b;
+        test_eq("read after write pt1", a, 42);
+        test_eq("read after write pt2", b, 17);
+
+        std::istringstream iss{"0123456789"};
+        char buf[5]{};
+        iss.read(buf, 4);
+        test_eq("read pt1", iss.gcount(), 4);
+        test_eq("read pt2", std::string{buf}, std::string{"0123"});
+        iss.read(buf, 4);
+        iss.read(buf, 4);
+        test_eq("read pt3", iss.gcount(), 2);
+        test("read pt4", iss.eof());
+    }
+
+    void iostream_test::test_formatting()
+    {
+        std::ostringstream oss{};
+        oss << std::setw(6) << -42 << '|'
+            << std::left << std::setw(5) << 'x' << '|'
+            << std::internal << std::setw(6) << -7 << '|'
+            << std::right << std::setw(4) << "ab" << '|'
+            << std::setfill('*') << std::setw(3) << 'c';
+        test_eq("padding", oss.str(), std::string{"   -42|x    |-    7|  ab|**c"});
+
+        std::ostringstream oss2{};
+        oss2 << std::hex << 255 << ' ' << std::oct << 8 << ' '
+             << std::dec << 4.5 << ' ' << std::boolalpha << true;
+        test_eq("numbers", oss2.str(), std::string{"ff 10 4.5 true"});
+
+        std::ostringstream oss3{};
+        oss3 << std::setw(40) << 1;
+        test_eq("wide padding", oss3.str().size(), 40U);
+    }
+
+    void iostream_test::test_filebuf()
+    {
+        {
+            std::ofstream out{test_file};
+            test("open for writing", out.is_open());
+
+            for (int i = 0; i < 5000; ++i)
+                out << i << '\n';
+
+            // Larger than the buffer, bypasses it.
+            std::string big(20000, 'z');
+            out << big << '\n';
+        }
+
+        std::ifstream in{test_file};
+        test("open for reading", in.is_open());
+
+        long sum{};
+        int x{};
+        for (int i = 0; i < 5000; ++i)
+        {
+            in >> x;
+            sum += x;
+        }
+        test_eq("formatted round trip", sum, 12497500L);
+
+        std::string big{};
+        in >> big;
+        test_eq("bulk round trip", big.size(), 20000U);
+
+        in.close();
+        test("close", !in.is_open());
+
+        std::ifstream in2{test_file};
+        std::string buf(50000, '\0');
+        in2.read(&buf[0], static_cast<std::streamsize>(buf.size()));
+        test("bulk read pt1", in2.eof());
+        test_eq("bulk read pt2", in2.gcount(), 43891);
+        test_eq("bulk read pt3", buf[0], '0');
+    }
+
+    void iostream_test::test_seek()
+    {
+        std::fstream f{test_file, std::ios_base::in | std::ios_base::out};
+        char buf[5]{};
+
+        f.read(buf, 4);
+        test_eq("seek initial read", std::string{buf}, std::string{"0\n1\n"});
+
+        f.seekp(0);
+        f << "AB";
+        f.seekg(0);
+        f.read(buf, 4);
+        test_eq("write after read", std::string{buf}, std::string{"AB1\n"});
+
+        /**
+         * Switching from reading to writing has to
+         * write right after the last read character.
+         */
+        f.seekg(0);
+        f.read(buf, 2);
+        f << "CD";
+        f.seekg(0);
+        f.read(buf, 4);
+        test_eq("interleaved", std::string{buf}, std::string{"ABCD"});
+
+        f.seekg(-3, std::ios_base::end);
+        f.read(buf, 3);
+        test_eq("seek end", std::string{buf, 3}, std::string{"zz\n"});
+        test_eq("tellg", static_cast<long>(f.tellg()), 43891L);
+    }
+
+    void iostream_test::test_throughput()
+    {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ofstream out{test_file};
+            for (int i = 0; i < 100000; ++i)
+                out << i << ' ' << 2.5 << '\n';
+        }
+        auto mid = std::chrono::steady_clock::now();
+
+        std::ifstream in{test_file};
+        long sum{};
+        int x{};
+        std::string str{};
+        for (int i = 0; i < 100000; ++i)
+        {
+            in >> x >> str;
+            sum += x;
+        }
+        test_eq("throughput", sum, 4999950000L);
+        auto end = std::chrono::steady_clock::now();
+
+        if (report_)
+        {
+            auto write = std::chrono::duration_cast<std::chrono::microseconds>(
+                mid - start
+            ).count();
+            auto read = std::chrono::duration_cast<std::chrono::microseconds>(
+                end - mid
+            ).count();
+            std::printf(
+                "[%s] 100000 formatted lines written in %lld us, read in %lld us\n",
+                name(), static_cast<long long>(write), static_cast<long long>(read)
+            );
+        }
+    }
+}
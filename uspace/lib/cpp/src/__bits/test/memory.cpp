@@ -30,6 +30,7 @@
 #include <__bits/test/tests.hpp>
 #include <initializer_list>
 #include <memory>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -82,6 +83,17 @@ namespace std::test
             using propagate_on_container_swap            = std::true_type;
             using is_always_equal                        = std::true_type;
         };
+
+        struct tracked_value
+        {
+            mock tracker{};
+            int value{42};
+
+            ~tracked_value()
+            {
+                value = 0;
+            }
+        };
     }
 
     bool memory_test::run(bool report)
@@ -92,6 +104,8 @@ namespace std::test
         test_unique_ptr();
         test_shared_ptr();
         test_weak_ptr();
+        test_atomic_access();
+        test_concurrent_refcount();
         test_allocators();
         test_pointers();
 
@@ -201,6 +215,114 @@ namespace std::test
         }
     }
 
+    void memory_test::test_atomic_access()
+    {
+        mock::clear();
+        {
+            auto ptr1 = std::make_shared<mock>();
+            auto ptr2 = std::make_shared<mock>();
+            std::shared_ptr<mock> shared{ptr1};
+
+            auto res1 = std::atomic_load(&shared);
+            test_eq("atomic_load", res1.get(), ptr1.get());
+            test_eq("atomic_load use count", ptr1.use_count(), 3L);
+
+            std::atomic_store(&shared, ptr2);
+            test_eq("atomic_store", shared.get(), ptr2.get());
+            test_eq("atomic_store releases old", ptr1.use_count(), 2L);
+
+            auto res2 = std::atomic_exchange(&shared, ptr1);
+            test_eq("atomic_exchange pt1", res2.get(), ptr2.get());
+            test_eq("atomic_exchange pt2", shared.get(), ptr1.get());
+
+            std::shared_ptr<mock> expected{ptr2};
+            auto res3 = std::atomic_compare_exchange_strong(&shared, &expected, ptr2);
+            test_eq("atomic_compare_exchange failure pt1", res3, false);
+            test_eq("atomic_compare_exchange failure pt2", expected.get(), ptr1.get());
+
+            auto res4 = std::atomic_compare_exchange_strong(&shared, &expected, ptr2);
+            test_eq("atomic_compare_exchange success pt1", res4, true);
+            test_eq("atomic_compare_exchange success pt2", shared.get(), ptr2.get());
+        }
+        test_eq("atomic access destroys once", mock::destructor_calls, 2U);
+    }
+
+    void memory_test::test_concurrent_refcount()
+    {
+        constexpr std::size_t thread_count{8};
+        constexpr std::size_t iterations{10000};
+
+        mock::clear();
+        {
+            auto ptr = std::make_shared<mock>();
+            std::weak_ptr<mock> wptr{ptr};
+            std::shared_ptr<mock> shared{ptr};
+            std::thread* threads[thread_count];
+
+            for (std::size_t i = 0; i < thread_count; ++i)
+            {
+                threads[i] = new std::thread{
+                    [&ptr, &wptr, &shared, i](){
+                        for (std::size_t j = 0; j < iterations; ++j)
+                        {
+                            std::shared_ptr<mock> copy{ptr};
+                            std::weak_ptr<mock> weak{copy};
+                            auto locked = wptr.lock();
+
+                            if (i % 2 == 0)
+                                std::atomic_store(&shared, copy);
+                            else
+                                locked = std::atomic_load(&shared);
+
+                            if (j % 1000 == 0)
+                                std::this_thread::yield();
+                        }
+                    }
+                };
+            }
+
+            for (std::size_t i = 0; i < thread_count; ++i)
+            {
+                threads[i]->join();
+                delete threads[i];
+            }
+
+            test_eq("concurrent copies use count", ptr.use_count(), 2L);
+            test_eq("concurrent copies no destruction", mock::destructor_calls, 0U);
+        }
+        test_eq("concurrent copies destroy once", mock::destructor_calls, 1U);
+
+        /**
+         * Release the last shared_ptr while other threads
+         * try to lock weak pointers to the same object,
+         * lock has to fail once the object is gone.
+         */
+        mock::clear();
+        {
+            constexpr std::size_t rounds{1000};
+            bool consistent{true};
+
+            for (std::size_t r = 0; r < rounds; ++r)
+            {
+                auto ptr = std::make_shared<aux::tracked_value>();
+                std::weak_ptr<aux::tracked_value> wptr{ptr};
+
+                std::thread t{
+                    [&wptr, &consistent](){
+                        auto locked = wptr.lock();
+                        if (locked && locked->value != 42)
+                            consistent = false;
+                    }
+                };
+                ptr.reset();
+                t.join();
+            }
+
+            test("weak_ptr lock races with release", consistent);
+        }
+        test_eq("weak_ptr lock race destroys all", mock::destructor_calls, 1000U);
+    }
+
     void memory_test::test_allocators()
     {
         using dummy_traits1 = std::allocator_traits<aux::dummy_allocator1>;
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace std::test
+{
+    namespace
+    {
+        /**
+         * Upstream resource that forwards to new/delete
+         * and counts what passes through it.
+         */
+        class counting_resource: public std::pmr::memory_resource
+        {
+            public:
+                std::size_t allocations{};
+                std::size_t deallocations{};
+                std::size_t outstanding{};
+
+            private:
+                void* do_allocate(std::size_t bytes, std::size_t alignment) override
+                {
+                    ++allocations;
+                    outstanding += bytes;
+
+                    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+                }
+
+                void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+                {
+                    ++deallocations;
+                    outstanding -= bytes;
+
+                    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+                }
+
+                bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        bool is_aligned(void* ptr, std::size_t alignment)
+        {
+            return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+        }
+    }
+
+    bool memory_resource_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_monotonic();
+        test_pool();
+        test_synchronized_pool();
+        test_polymorphic_allocator();
+        test_containers();
+
+        return end();
+    }
+
+    const char* memory_resource_test::name()
+    {
+        return "memory_resource";
+    }
+
+    void memory_resource_test::test_monotonic()
+    {
+        counting_resource upstream{};
+        alignas(std::max_align_t) char buffer[256];
+
+        {
+            std::pmr::monotonic_buffer_resource mono{buffer, sizeof(buffer), &upstream};
+            test_eq("monotonic upstream", mono.upstream_resource(), &upstream);
+
+            auto ptr1 = mono.allocate(10, 1);
+            auto ptr2 = mono.allocate(8, 8);
+            auto ptr3 = mono.allocate(16, 16);
+            test("monotonic initial buffer pt1", ptr1 == static_cast<void*>(buffer));
+            test(
+                "monotonic initial buffer pt2",
+                static_cast<char*>(ptr3) < buffer + sizeof(buffer)
+            );
+            test("monotonic alignment pt1", is_aligned(ptr2, 8));
+            test("monotonic alignment pt2", is_aligned(ptr3, 16));
+            test_eq("monotonic no upstream", upstream.allocations, 0U);
+
+            // Deallocation is a no-op, memory is not reused.
+            mono.deallocate(ptr2, 8, 8);
+            auto ptr4 = mono.allocate(8, 8);
+            test("monotonic deallocate", ptr4 != ptr2);
+
+            for (int i = 0; i < 100; ++i)
+                mono.allocate(64, 8);
+            test("monotonic grows", upstream.allocations > 0U);
+            test("monotonic geometric growth", upstream.allocations < 10U);
+
+            mono.release();
+            test_eq("monotonic release pt1", upstream.outstanding, 0U);
+            test_eq("monotonic release pt2", upstream.deallocations, upstream.allocations);
+
+            auto ptr5 = mono.allocate(10, 1);
+            test("monotonic release reuses buffer", ptr5 == static_cast<void*>(buffer));
+
+            mono.allocate(1024, 64);
+            test("monotonic large grows", upstream.outstanding > 0U);
+        }
+
+        test_eq("monotonic destructor", upstream.outstanding, 0U);
+    }
+
+    void memory_resource_test::test_pool()
+    {
+        counting_resource upstream{};
+
+        {
+            std::pmr::pool_options opts{};
+            opts.max_blocks_per_chunk = 64;
+            opts.largest_required_pool_block = 200;
+
+            std::pmr::unsynchronized_pool_resource pool{opts, &upstream};
+            test_eq("pool options pt1", pool.options().max_blocks_per_chunk, 64U);
+            test("pool options pt2", pool.options().largest_required_pool_block >= 200U);
+
+            void* blocks[100];
+            for (auto& block: blocks)
+                block = pool.allocate(24, 8);
+            auto chunks = upstream.allocations;
+            test("pool chunks", chunks > 0U && chunks < 10U);
+
+            bool aligned{true};
+            for (auto block: blocks)
+                aligned = aligned && is_aligned(block, 8);
+            test("pool alignment", aligned);
+
+            for (auto block: blocks)
+                pool.deallocate(block, 24, 8);
+            for (auto& block: blocks)
+                block = pool.allocate(24, 8);
+            test_eq("pool reuse", upstream.allocations, chunks);
+
+            auto large = pool.allocate(4096, 16);
+            test_eq("pool large upstream", upstream.allocations, chunks + 1);
+            test("pool large alignment", is_aligned(large, 16));
+            pool.deallocate(large, 4096, 16);
+            test_eq("pool large deallocate", upstream.deallocations, 1U);
+
+            auto overaligned = pool.allocate(32, 256);
+            test("pool overaligned", is_aligned(overaligned, 256));
+
+            pool.release();
+            test_eq("pool release", upstream.outstanding, 0U);
+        }
+
+        test_eq("pool destructor", upstream.deallocations, upstream.allocations);
+    }
+
+    void memory_resource_test::test_synchronized_pool()
+    {
+        counting_resource upstream{};
+
+        {
+            std::pmr::synchronized_pool_resource pool{&upstream};
+            test_eq("synchronized upstream", pool.upstream_resource(), &upstream);
+
+            auto ptr1 = pool.allocate(48);
+            auto ptr2 = pool.allocate(48);
+            test("synchronized distinct", ptr1 != ptr2);
+
+            pool.deallocate(ptr1, 48);
+            auto ptr3 = pool.allocate(48);
+            test("synchronized reuse", ptr3 == ptr1);
+
+            pool.deallocate(ptr2, 48);
+            pool.deallocate(ptr3, 48);
+        }
+
+        test_eq("synchronized destructor", upstream.outstanding, 0U);
+    }
+
+    void memory_resource_test::test_polymorphic_allocator()
+    {
+        counting_resource upstream{};
+        std::pmr::monotonic_buffer_resource mono{&upstream};
+
+        std::pmr::polymorphic_allocator<int> alloc1{};
+        test_eq(
+            "default resource",
+            alloc1.resource(), std::pmr::new_delete_resource()
+        );
+
+        auto old = std::pmr::set_default_resource(&mono);
+        std::pmr::polymorphic_allocator<int> alloc2{};
+        test_eq("set default resource pt1", old, std::pmr::new_delete_resource());
+        test_eq("set default resource pt2", alloc2.resource(), static_cast<std::pmr::memory_resource*>(&mono));
+        std::pmr::set_default_resource(nullptr);
+        test_eq("reset default resource", std::pmr::get_default_resource(), std::pmr::new_delete_resource());
+
+        std::pmr::polymorphic_allocator<long> alloc3{alloc2};
+        test("allocator equality pt1", alloc2 == alloc3);
+        test("allocator equality pt2", alloc1 != alloc2);
+        test(
+            "resource equality",
+            *std::pmr::null_memory_resource() != *std::pmr::new_delete_resource()
+        );
+
+        auto ints = alloc2.allocate(4);
+        test("allocator allocate", is_aligned(ints, alignof(int)));
+        alloc2.deallocate(ints, 4);
+
+        /**
+         * Uses-allocator construction passes the allocator
+         * on to allocator aware elements.
+         */
+        std::pmr::polymorphic_allocator<std::pmr::string> alloc4{&mono};
+        auto str = alloc4.allocate(1);
+        alloc4.construct(str, "a string that does not fit inline");
+        test_eq(
+            "uses-allocator construction",
+            str->get_allocator().resource(),
+            static_cast<std::pmr::memory_resource*>(&mono)
+        );
+        alloc4.destroy(str);
+        alloc4.deallocate(str, 1);
+    }
+
+    void memory_resource_test::test_containers()
+    {
+        counting_resource upstream{};
+
+        {
+            std::pmr::monotonic_buffer_resource mono{&upstream};
+
+            std::pmr::vector<int> vec{&mono};
+            for (int i = 0; i < 1000; ++i)
+                vec.push_back(i);
+
+            bool ok{true};
+            for (int i = 0; i < 1000; ++i)
+                ok = ok && vec[i] == i;
+            test("pmr vector", ok);
+            test("pmr vector upstream", upstream.allocations > 0U);
+
+            std::pmr::string str1{"a string that does not fit inline", &mono};
+            std::pmr::string str2{&mono};
+            str2 = str1;
+            test("pmr string copy", str2 == str1);
+            test_eq(
+                "pmr string keeps resource",
+                str2.get_allocator().resource(),
+                static_cast<std::pmr::memory_resource*>(&mono)
+            );
+
+            std::pmr::string str3{"another string that does not fit inline"};
+            str2 = std::move(str3);
+            test("pmr string move between resources", str2.compare("another string that does not fit inline") == 0);
+            test_eq(
+                "pmr string move keeps resource",
+                str2.get_allocator().resource(),
+                static_cast<std::pmr::memory_resource*>(&mono)
+            );
+
+            std::pmr::map<int, int> map{&mono};
+            std::pmr::unordered_map<int, int> umap{&mono};
+            for (int i = 0; i < 100; ++i)
+            {
+                map.emplace(i, i * i);
+                umap.emplace(i, i * i);
+            }
+            test_eq("pmr map", map[9], 81);
+            test_eq("pmr unordered_map", umap[9], 81);
+        }
+
+        test_eq("pmr containers release", upstream.outstanding, 0U);
+    }
+}
@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <__bits/trycatch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <list>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * Compiles the pattern and reports whether
+     * that raised regex_error with the given code.
+     */
+    bool fails_with(const char* pattern, std::regex_constants::error_type)
+    {
+        std::aux::exception_thrown = false;
+        std::regex re{pattern};
+
+        bool res = std::aux::exception_thrown && !std::regex_search("", re);
+        std::aux::exception_thrown = false;
+
+        return res;
+    }
+}
+
+namespace std::test
+{
+    bool regex_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_match();
+        test_search();
+        test_syntax();
+        test_back_references();
+        test_iterators();
+        test_replace();
+        test_errors();
+        test_throughput();
+
+        return end();
+    }
+
+    const char* regex_test::name()
+    {
+        return "regex";
+    }
+
+    void regex_test::test_match()
+    {
+        std::regex re1{"a(b|c)*d"};
+        test("match pt1", std::regex_match("abcbd", re1));
+        test("match pt2", !std::regex_match("abcbdx", re1));
+        test("match pt3", !std::regex_match("xabcbd", re1));
+        test_eq("mark_count", re1.mark_count(), 1U);
+
+        std::cmatch m1{};
+        test("match results pt1", std::regex_match("abcbd", m1, re1));
+        test_eq("match results pt2", m1.size(), 2U);
+        test_eq("match results pt3", m1.str(0), std::string{"abcbd"});
+        test_eq("match results pt4", m1.str(1), std::string{"b"});
+        test_eq("match results pt5", m1.position(1), 3);
+        test("match results pt6", !m1.prefix().matched && !m1.suffix().matched);
+
+        // The whole input has to match, not the first alternative.
+        std::regex re2{"a|ab"};
+        test("match alternatives", std::regex_match("ab", re2));
+
+        std::string str{"2026-10-14"};
+        std::smatch m2{};
+        std::regex re3{"(\\d{4})-(\\d{2})-(\\d{2})"};
+        test("match string", std::regex_match(str, m2, re3));
+        test_eq("match string pt1", m2[1].str(), std::string{"2026"});
+        test_eq("match string pt2", m2[3].str(), std::string{"14"});
+        test("match string pt3", m2[2] == "10");
+
+        std::list<char> lst{'x', 'y', 'y', 'z'};
+        test("match list", std::regex_match(lst.begin(), lst.end(), std::regex{"xy+z"}));
+
+        std::regex re4{"HeLLo", std::regex::icase};
+        test("match icase pt1", std::regex_match("hello", re4));
+        test("match icase pt2", std::regex_match("HELLO", re4));
+        test("match icase pt3", std::regex_match("Q", std::regex{"[a-z]", std::regex::icase}));
+
+        std::regex re5{"(a)(b)?", std::regex::nosubs};
+        test_eq("nosubs", re5.mark_count(), 0U);
+    }
+
+    void regex_test::test_search()
+    {
+        std::cmatch m{};
+        std::regex re1{"b+"};
+        test("search pt1", std::regex_search("aabbbcc", m, re1));
+        test_eq("search pt2", m.position(), 2);
+        test_eq("search pt3", m.length(), 3);
+        test_eq("search pt4", m.prefix().str(), std::string{"aa"});
+        test_eq("search pt5", m.suffix().str(), std::string{"cc"});
+        test("search pt6", !std::regex_search("aacc", re1));
+
+        // Leftmost match wins, then the first alternative.
+        std::regex re2{"abcd|bc|a"};
+        test("leftmost pt1", std::regex_search("xabcd", m, re2));
+        test_eq("leftmost pt2", m.str(), std::string{"abcd"});
+        std::regex re3{"a|ab"};
+        test("leftmost pt3", std::regex_search("ab", m, re3));
+        test_eq("leftmost pt4", m.str(), std::string{"a"});
+
+        std::regex re4{"a+?"};
+        test("lazy pt1", std::regex_search("aaa", m, re4));
+        test_eq("lazy pt2", m.length(), 1);
+        std::regex re5{"<(.*?)>"};
+        test("lazy pt3", std::regex_search("<a><b>", m, re5));
+        test_eq("lazy pt4", m.str(1), std::string{"a"});
+
+        std::regex re6{"^abc$"};
+        test("anchors pt1", std::regex_search("abc", re6));
+        test("anchors pt2", !std::regex_search("xabc", re6));
+        test("anchors pt3", !std::regex_search("abc", re6, std::regex_constants::match_not_bol));
+        test("anchors pt4", !std::regex_search("abc", re6, std::regex_constants::match_not_eol));
+
+        std::regex re7{"^b", std::regex::multiline};
+        test("multiline pt1", std::regex_search("a\nb", m, re7));
+        test_eq("multiline pt2", m.position(), 2);
+
+        std::regex re8{"\\bfoo\\b"};
+        test("word boundary pt1", std::regex_search("a foo b", m, re8));
+        test_eq("word boundary pt2", m.position(), 2);
+        test("word boundary pt3", !std::regex_search("afoob", re8));
+        test("word boundary pt4", std::regex_search("afoob", std::regex{"\\Boo\\B"}));
+
+        std::regex re9{"x*"};
+        test("empty match pt1", std::regex_search("abc", m, re9));
+        test_eq("empty match pt2", m.position(), 0);
+        test_eq("empty match pt3", m.length(), 0);
+
+        test("continuous pt1", !std::regex_search("ab", std::regex{"b"},
+                                                  std::regex_constants::match_continuous));
+        test("continuous pt2", std::regex_search("ab", std::regex{"a"},
+                                                 std::regex_constants::match_continuous));
+
+        std::regex re10{"(a|(b))+"};
+        test("captures pt1", std::regex_search("ab", m, re10));
+        test_eq("captures pt2", m.str(1), std::string{"b"});
+        test_eq("captures pt3", m.str(2), std::string{"b"});
+        test("captures pt4", std::regex_search("ba", m, re10));
+        test_eq("captures pt5", m.str(1), std::string{"a"});
+        test("captures pt6", m[2].matched);
+
+        std::regex re11{"(a*)*"};
+        test("empty iteration pt1", std::regex_search("b", m, re11));
+        test("empty iteration pt2", !m[1].matched);
+    }
+
+    void regex_test::test_syntax()
+    {
+        test("classes pt1", std::regex_match("a1_ \t", std::regex{"\\w\\d\\w\\s\\s"}));
+        test("classes pt2", std::regex_match("x-Y", std::regex{"\\D\\W\\S"}));
+        test("classes pt3", std::regex_match("b", std::regex{"[[:alpha:]]"}));
+        test("classes pt4", !std::regex_match("b", std::regex{"[^[:alpha:]]"}));
+        test("classes pt5", std::regex_match("-", std::regex{"[a\\-z]"}));
+        test("classes pt6", std::regex_match("]", std::regex{"[\\]a]"}));
+        test("classes pt7", std::regex_match("q", std::regex{"[^\\d]"}));
+        test("classes pt8", !std::regex_match("\n", std::regex{"."}));
+
+        test("repeat pt1", std::regex_match("aaa", std::regex{"a{3}"}));
+        test("repeat pt2", !std::regex_match("aa", std::regex{"a{3}"}));
+        test("repeat pt3", std::regex_match("aaaaa", std::regex{"a{2,}"}));
+        test("repeat pt4", !std::regex_match("aaaa", std::regex{"a{1,3}"}));
+        test("repeat pt5", std::regex_match("ab", std::regex{"a?b?c?"}));
+
+        test("escapes pt1", std::regex_match("\t\n", std::regex{"\\t\\n"}));
+        test("escapes pt2", std::regex_match("A", std::regex{"\\x41"}));
+        test("escapes pt3", std::regex_match("A", std::regex{"\\u0041"}));
+        test("escapes pt4", std::regex_match("a.b", std::regex{"a\\.b"}));
+        test("escapes pt5", !std::regex_match("axb", std::regex{"a\\.b"}));
+
+        std::cmatch m{};
+        test("non capturing pt1", std::regex_match("ab", m, std::regex{"(?:a)(b)"}));
+        test_eq("non capturing pt2", m.str(1), std::string{"b"});
+
+        test("lookahead pt1", std::regex_search("foobar", m, std::regex{"foo(?=bar)"}));
+        test_eq("lookahead pt2", m.length(), 3);
+        test("lookahead pt3", !std::regex_search("foobaz", std::regex{"foo(?=bar)"}));
+        test("lookahead pt4", std::regex_search("foobaz", std::regex{"foo(?!bar)"}));
+
+        std::wregex re{L"x(y+)"};
+        std::wcmatch wm{};
+        test("wide pt1", std::regex_search(L"axyyb", wm, re));
+        test_eq("wide pt2", wm.length(1), 2);
+    }
+
+    void regex_test::test_back_references()
+    {
+        std::cmatch m{};
+        std::regex re1{"(a+)b\\1"};
+        test("backref pt1", std::regex_match("aabaa", re1));
+        test("backref pt2", !std::regex_match("aaba", re1));
+        test("backref pt3", std::regex_search("xabaay", m, re1));
+        test_eq("backref pt4", m.str(), std::string{"aba"});
+
+        std::regex re2{"(\\w)\\1", std::regex::icase};
+        test("backref icase", std::regex_match("aA", re2));
+
+        // Unmatched groups match the empty string.
+        test("backref unmatched", std::regex_match("b", std::regex{"(a)?b\\1"}));
+
+        std::regex re3{"<(\\w+)>.*</\\1>"};
+        test("backref tags pt1", std::regex_search("x<b>bold</b>y", m, re3));
+        test_eq("backref tags pt2", m.position(), 1);
+        test_eq("backref tags pt3", m.str(1), std::string{"b"});
+    }
+
+    void regex_test::test_iterators()
+    {
+        std::string str{"a1 b22 c333"};
+        std::regex re1{"\\d+"};
+
+        std::vector<std::string> found{};
+        std::vector<long> positions{};
+        for (std::sregex_iterator it{str.begin(), str.end(), re1}, end{}; it != end; ++it)
+        {
+            found.push_back(it->str());
+            positions.push_back(it->position());
+        }
+        auto check1 = {std::string{"1"}, std::string{"22"}, std::string{"333"}};
+        test_eq("iterator pt1", check1.begin(), check1.end(), found.begin(), found.end());
+        auto check2 = {1L, 4L, 8L};
+        test_eq("iterator pt2", check2.begin(), check2.end(),
+                positions.begin(), positions.end());
+
+        // Empty matches advance by one character.
+        std::regex re2{"x*"};
+        std::string str2{"axb"};
+        size_t count{};
+        for (std::sregex_iterator it{str2.begin(), str2.end(), re2}, end{}; it != end; ++it)
+            ++count;
+        test_eq("iterator empty", count, 4U);
+
+        std::regex re3{"\\s*,\\s*"};
+        std::string str3{"one , two,three"};
+        std::vector<std::string> tokens{};
+        for (std::sregex_token_iterator it{str3.begin(), str3.end(), re3, -1}, end{};
+             it != end; ++it)
+            tokens.push_back(it->str());
+        auto check3 = {std::string{"one"}, std::string{"two"}, std::string{"three"}};
+        test_eq("token iterator pt1", check3.begin(), check3.end(),
+                tokens.begin(), tokens.end());
+
+        std::regex re4{"(\\w)=(\\d)"};
+        std::string str4{"a=1 b=2"};
+        std::string joined{};
+        for (std::sregex_token_iterator it{str4.begin(), str4.end(), re4, {2, 1}}, end{};
+             it != end; ++it)
+            joined += it->str();
+        test_eq("token iterator pt2", joined, std::string{"1a2b"});
+    }
+
+    void regex_test::test_replace()
+    {
+        std::regex re1{"(\\w+)@(\\w+)"};
+        std::string str{"mail joe@example now"};
+
+        auto res1 = std::regex_replace(str, re1, "$2 at $1");
+        test_eq("replace pt1", res1, std::string{"mail example at joe now"});
+
+        auto res2 = std::regex_replace(str, re1, "[$&]");
+        test_eq("replace pt2", res2, std::string{"mail [joe@example] now"});
+
+        auto res3 = std::regex_replace(str, re1, "<$`|$'>", std::regex_constants::format_no_copy);
+        test_eq("replace pt3", res3, std::string{"<mail | now>"});
+
+        auto res4 = std::regex_replace(std::string{"aaa"}, std::regex{"a"}, "b",
+                                       std::regex_constants::format_first_only);
+        test_eq("replace pt4", res4, std::string{"baa"});
+
+        auto res5 = std::regex_replace(std::string{"ab"}, std::regex{"x*"}, "-");
+        test_eq("replace pt5", res5, std::string{"-a-b-"});
+
+        auto res6 = std::regex_replace(str, re1, "\\2&", std::regex_constants::format_sed);
+        test_eq("replace pt6", res6, std::string{"mail examplejoe@example now"});
+
+        auto res7 = std::regex_replace("cost: 5$", std::regex{"\\d"}, "$$$&");
+        test_eq("replace pt7", res7, std::string{"cost: $5$"});
+
+        std::string out{};
+        std::regex_replace(std::back_inserter(out), str.begin(), str.end(),
+                           std::regex{"o"}, "0");
+        test_eq("replace iterator", out, std::string{"mail j0e@example n0w"});
+    }
+
+    void regex_test::test_errors()
+    {
+        test("error paren pt1", fails_with("(a", std::regex_constants::error_paren));
+        test("error paren pt2", fails_with("a)", std::regex_constants::error_paren));
+        test("error brack", fails_with("[a", std::regex_constants::error_brack));
+        test("error range", fails_with("[z-a]", std::regex_constants::error_range));
+        test("error badrepeat", fails_with("*a", std::regex_constants::error_badrepeat));
+        test("error brace", fails_with("a{2", std::regex_constants::error_brace));
+        test("error badbrace", fails_with("a{3,2}", std::regex_constants::error_badbrace));
+        test("error backref", fails_with("(a)\\2", std::regex_constants::error_backref));
+        test("error escape", fails_with("a\\", std::regex_constants::error_escape));
+        test("error ctype", fails_with("[[:foo:]]", std::regex_constants::error_ctype));
+
+        std::regex_error err{std::regex_constants::error_stack};
+        test_eq("error code", err.code(), std::regex_constants::error_stack);
+    }
+
+    void regex_test::test_throughput()
+    {
+        /**
+         * A pattern that needs exponential time with naive
+         * backtracking, the automata keep it linear.
+         */
+        std::string evil(30, 'a');
+        std::regex re1{"(a*)*b"};
+        auto start = std::chrono::steady_clock::now();
+        test("pathological pt1", !std::regex_search(evil, re1));
+        std::smatch m{};
+        test("pathological pt2", !std::regex_match(evil, m, std::regex{"(a|aa)*c"}));
+        auto mid = std::chrono::steady_clock::now();
+
+        std::string text{};
+        for (int i = 0; i < 2000; ++i)
+            text += "lorem ipsum dolor sit amet 192.168.1.42 consectetur ";
+
+        std::regex re2{"(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)"};
+        size_t count{};
+        for (std::sregex_iterator it{text.begin(), text.end(), re2}, end{}; it != end; ++it)
+            count += (*it)[4].length() == 2;
+        test_eq("throughput matches", count, 2000U);
+
+        size_t lines{};
+        std::regex re3{"amet [0-9.]+ cons"};
+        for (int i = 0; i < 2000; ++i)
+            lines += std::regex_search(text.c_str() + i * 52, text.c_str() + (i + 1) * 52, re3);
+        test_eq("throughput search", lines, 2000U);
+        auto end = std::chrono::steady_clock::now();
+
+        if (report_)
+        {
+            auto patho = std::chrono::duration_cast<std::chrono::microseconds>(
+                mid - start
+            ).count();
+            auto thru = std::chrono::duration_cast<std::chrono::microseconds>(
+                end - mid
+            ).count();
+            std::printf(
+                "[%s] pathological %lld us, %zu bytes scanned twice %lld us\n",
+                name(), static_cast<long long>(patho), text.size(),
+                static_cast<long long>(thru)
+            );
+        }
+    }
+}
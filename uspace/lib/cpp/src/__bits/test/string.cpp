@@ -30,6 +30,66 @@
 #include <__bits/test/tests.hpp>
 #include <string>
 #include <cstdio>
+#include <functional>
+#include <utility>
+
+namespace
+{
+    /**
+     * Allocator that keeps statistics so that we can
+     * check which strings actually hit the heap.
+     */
+    struct allocation_stats
+    {
+        static std::size_t allocations;
+        static std::size_t deallocations;
+        static std::size_t bytes;
+    };
+
+    std::size_t allocation_stats::allocations{};
+    std::size_t allocation_stats::deallocations{};
+    std::size_t allocation_stats::bytes{};
+
+    template<class T>
+    struct counting_allocator
+    {
+        using value_type = T;
+
+        counting_allocator() = default;
+
+        template<class U>
+        counting_allocator(const counting_allocator<U>&)
+        { /* DUMMY BODY */ }
+
+        T* allocate(std::size_t n)
+        {
+            ++allocation_stats::allocations;
+            allocation_stats::bytes += n * sizeof(T);
+
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t)
+        {
+            ++allocation_stats::deallocations;
+            ::operator delete(ptr);
+        }
+
+        bool operator==(const counting_allocator&) const
+        {
+            return true;
+        }
+
+        bool operator!=(const counting_allocator&) const
+        {
+            return false;
+        }
+    };
+
+    using counted_string = std::basic_string<
+        char, std::char_traits<char>, counting_allocator<char>
+    >;
+}
 
 namespace std::test
 {
@@ -47,6 +107,7 @@ namespace std::test
         test_find();
         test_substr();
         test_compare();
+        test_small_strings();
 
         return end();
     }
@@ -703,4 +764,104 @@ namespace std::test
             res, 0
         );
     }
+    void string_test::test_small_strings()
+    {
+        allocation_stats::allocations = 0;
+        allocation_stats::deallocations = 0;
+        allocation_stats::bytes = 0;
+
+        {
+            counted_string str1{};
+            counted_string str2{"fifteen chars.."};
+            counted_string str3{str2};
+            test_eq("empty string allocations", allocation_stats::allocations, 0ul);
+            test_eq("short string size", str3.size(), 15ul);
+
+            counted_string str4{"sixteen chars..."};
+            test_eq("long string allocations", allocation_stats::allocations, 1ul);
+
+            counted_string str5{std::move(str2)};
+            test("move short string pt1", str5.compare("fifteen chars..") == 0);
+            test("move short string pt2", str2.empty() && str2.c_str()[0] == '\0');
+
+            counted_string str6{std::move(str4)};
+            test_eq("move long string allocations", allocation_stats::allocations, 1ul);
+            test("move long string", str6.compare("sixteen chars...") == 0);
+
+            str5.swap(str6);
+            test("swap inline and heap pt1", str5.compare("sixteen chars...") == 0);
+            test("swap inline and heap pt2", str6.compare("fifteen chars..") == 0);
+
+            str6.append("!");
+            test("grow out of inline buffer", str6.compare("fifteen chars..!") == 0);
+            test_eq("grow allocations", allocation_stats::allocations, 2ul);
+
+            str6.resize(5);
+            str6.shrink_to_fit();
+            test("shrink back to inline buffer", str6.compare("fifte") == 0);
+        }
+        test_eq(
+            "all allocations freed",
+            allocation_stats::deallocations, allocation_stats::allocations
+        );
+
+        const wchar_t* check1 = L"seven..";
+        std::wstring wstr1{check1};
+        std::wstring wstr2{std::move(wstr1)};
+        test_eq(
+            "move short wide string pt1",
+            wstr2.begin(), wstr2.end(),
+            check1, check1 + 7
+        );
+        test("move short wide string pt2", wstr1.empty());
+
+        /**
+         * Benchmark-like check of a typical workload, many short
+         * keys (e.g. path components), with the number of
+         * allocations and the amount of memory they need.
+         */
+        allocation_stats::allocations = 0;
+        allocation_stats::bytes = 0;
+
+        const std::size_t key_count{1000};
+        auto keys = new counted_string[key_count];
+
+        char buf[16];
+        for (std::size_t i = 0; i < key_count; ++i)
+        {
+            std::snprintf(buf, sizeof(buf), "key%zu", i);
+            keys[i] = counted_string{buf};
+        }
+
+        test_eq("short keys allocations", allocation_stats::allocations, 0ul);
+        if (report_)
+        {
+            std::printf(
+                "[%s] %zu short keys: %zu B inline, %zu allocations\n",
+                name(), key_count, key_count * sizeof(counted_string),
+                allocation_stats::allocations
+            );
+        }
+
+        for (std::size_t i = 0; i < key_count; ++i)
+            keys[i].append("/long/path/component");
+
+        test_eq("long keys allocations", allocation_stats::allocations, key_count);
+        if (report_)
+        {
+            std::printf(
+                "[%s] %zu long keys: %zu allocations, %zu B on the heap\n",
+                name(), key_count, allocation_stats::allocations,
+                allocation_stats::bytes
+            );
+        }
+        delete[] keys;
+
+        std::string str7{"abc"};
+        std::string str8{"abcdefghijklmnopqrstuvwxyz"};
+        std::string str9{str8};
+        std::hash<std::string> hasher{};
+        test_eq("hash equal strings", hasher(str8), hasher(str9));
+        test("hash different strings", hasher(str7) != hasher(str8));
+    }
 }
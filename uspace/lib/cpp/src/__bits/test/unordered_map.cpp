@@ -27,6 +27,7 @@
  */
 
 #include <__bits/test/tests.hpp>
+#include <cstdio>
 #include <initializer_list>
 #include <unordered_map>
 #include <string>
@@ -44,6 +45,7 @@ namespace std::test
         test_histogram();
         test_emplace_insert();
         test_multi();
+        test_large();
 
         return end();
     }
@@ -263,4 +265,71 @@ namespace std::test
         test_eq("multi erase by iterator pt1", res7->first, 7);
         test_eq("multi erase by iterator pt2", mmap.count(7), 1U);
     }
+
+    void unordered_map_test::test_large()
+    {
+        const int count{100000};
+        std::unordered_map<int, int> map{};
+
+        map.emplace(0, 0);
+        auto first_value = &map.find(0)->second;
+        auto initial_buckets = map.bucket_count();
+
+        for (int i = 1; i < count; ++i)
+            map.emplace(i, 2 * i);
+
+        test_eq("large insert size", map.size(), static_cast<std::size_t>(count));
+        test("large insert rehashed", map.bucket_count() > initial_buckets);
+        test("large insert load factor", map.load_factor() <= map.max_load_factor());
+        test("reference stable across rehash", &map.find(0)->second == first_value);
+
+        int found{};
+        for (int i = 0; i < count; ++i)
+        {
+            auto it = map.find(i);
+            if (it != map.end() && it->second == 2 * i)
+                ++found;
+        }
+        test_eq("large lookup hits", found, count);
+
+        int missed{};
+        for (int i = count; i < 2 * count; ++i)
+        {
+            if (map.find(i) == map.end())
+                ++missed;
+        }
+        test_eq("large lookup misses", missed, count);
+
+        for (int i = 1; i < count; i += 2)
+            map.erase(i);
+        test_eq("large erase size", map.size(), static_cast<std::size_t>(count / 2));
+        test_eq("large erase removes", map.count(1), 0U);
+        test_eq("large erase keeps", map.count(2), 1U);
+
+        // Freed nodes are reused by the pool.
+        for (int i = 1; i < count; i += 2)
+            map.emplace(i, 2 * i);
+        test_eq("large reinsert size", map.size(), static_cast<std::size_t>(count));
+        test("reference stable across reuse", &map.find(0)->second == first_value);
+
+        std::size_t longest{};
+        for (std::size_t i = 0; i < map.bucket_count(); ++i)
+        {
+            if (map.bucket_size(i) > longest)
+                longest = map.bucket_size(i);
+        }
+
+        if (report_)
+        {
+            std::printf(
+                "[%s] %d keys: %zu buckets, load factor %f, longest chain %zu\n",
+                name(), count, map.bucket_count(),
+                static_cast<double>(map.load_factor()), longest
+            );
+        }
+
+        map.clear();
+        test_eq("large clear", map.size(), 0U);
+        test("large clear find", map.find(0) == map.end());
+    }
 }
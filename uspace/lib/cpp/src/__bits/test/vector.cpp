@@ -26,9 +26,14 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <__bits/test/mock.hpp>
 #include <__bits/test/tests.hpp>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <initializer_list>
+#include <list>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -42,6 +47,8 @@ namespace std::test
         test_construction_and_assignment();
         test_insert();
         test_erase();
+        test_non_trivial();
+        test_growth();
 
         return end();
     }
@@ -85,7 +92,13 @@ namespace std::test
             check3.begin(), check3.end()
         );
 
-        // TODO: iterator constructor when implemented
+        std::list<int> lst{4, 3, 2, 1};
+        std::vector<int> vec5(lst.begin(), lst.end());
+        test_eq(
+            "iterator constructor",
+            vec5.begin(), vec5.end(),
+            check2.begin(), check2.end()
+        );
 
         std::vector<int> vec6{vec4};
         test_eq(
@@ -227,4 +240,114 @@ namespace std::test
             check3.begin(), check3.end()
         );
     }
+
+    void vector_test::test_non_trivial()
+    {
+        auto check1 = {"a", "b", "x", "c", "d"};
+        auto check2 = {"a", "b", "c", "d", "c"};
+        auto check3 = {"a", "d"};
+
+        std::vector<std::string> vec1{};
+        vec1.push_back("a");
+        vec1.push_back("b");
+        vec1.push_back("c");
+        vec1.push_back("d");
+        vec1.insert(vec1.begin() + 2, "x");
+        test_eq(
+            "non trivial insert",
+            vec1.begin(), vec1.end(),
+            check1.begin(), check1.end()
+        );
+
+        vec1.erase(vec1.begin() + 2);
+        vec1.push_back(vec1[2]);
+        test_eq(
+            "non trivial push_back own element",
+            vec1.begin(), vec1.end(),
+            check2.begin(), check2.end()
+        );
+
+        vec1.erase(vec1.begin() + 1, vec1.begin() + 3);
+        vec1.pop_back();
+        vec1.pop_back();
+        vec1.push_back("d");
+        test_eq(
+            "non trivial erase",
+            vec1.begin(), vec1.end(),
+            check3.begin(), check3.end()
+        );
+
+        std::vector<std::string> vec2{"a", "b", "c"};
+        vec2.insert(vec2.begin(), vec2[2]);
+        test_eq("insert own element", vec2[0], std::string{"c"});
+
+        vec2.insert(vec2.begin() + 1, 5ul, std::string{"y"});
+        test_eq("insert copies size", vec2.size(), 9ul);
+        test_eq("insert copies value", vec2[5], std::string{"y"});
+        test_eq("insert copies tail", vec2[8], std::string{"c"});
+
+        vec2.resize(2);
+        test_eq("resize shrink", vec2.size(), 2ul);
+        vec2.resize(4, "z");
+        test_eq("resize grow", vec2[3], std::string{"z"});
+
+        mock::clear();
+        {
+            std::vector<mock> vec3{};
+            for (int i = 0; i < 100; ++i)
+                vec3.emplace_back();
+            vec3.emplace_back();
+            for (int i = 0; i < 10; ++i)
+                vec3.pop_back();
+            vec3.shrink_to_fit();
+            vec3.resize(120);
+
+            test_eq("constructed in place", mock::constructor_calls, 130ul);
+            test_eq("growth does not use throwing move", mock::move_constructor_calls, 0ul);
+        }
+        test_eq(
+            "every element destroyed once",
+            mock::destructor_calls,
+            mock::constructor_calls + mock::copy_constructor_calls +
+            mock::move_constructor_calls
+        );
+    }
+
+    void vector_test::test_growth()
+    {
+        constexpr int count{100000};
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<int> vec1{};
+        for (int i = 0; i < count; ++i)
+            vec1.push_back(i);
+        auto mid = std::chrono::steady_clock::now();
+
+        bool ok{true};
+        for (int i = 0; i < count; ++i)
+            ok = ok && vec1[i] == i;
+        test("push_back ints", ok);
+
+        std::vector<std::string> vec2{};
+        for (int i = 0; i < count; ++i)
+            vec2.push_back("a string that does not fit inline");
+        auto end = std::chrono::steady_clock::now();
+        test_eq("push_back strings", vec2.size(), static_cast<size_t>(count));
+        test_eq("push_back strings value", vec2[count - 1], vec2[0]);
+
+        if (report_)
+        {
+            auto ints = std::chrono::duration_cast<std::chrono::microseconds>(
+                mid - start
+            ).count();
+            auto strings = std::chrono::duration_cast<std::chrono::microseconds>(
+                end - mid
+            ).count();
+            std::printf(
+                "[%s] %d push_backs: ints %lld us, strings %lld us\n",
+                name(), count, static_cast<long long>(ints),
+                static_cast<long long>(strings)
+            );
+        }
+    }
 }
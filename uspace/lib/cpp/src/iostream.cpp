@@ -27,9 +27,22 @@
  */
 
 #include <__bits/io/streambufs.hpp>
+#include <cerrno>
+#include <cstdio>
 #include <ios>
 #include <iostream>
 #include <new>
+#include <offset.h>
+
+namespace helenos
+{
+    /**
+     * Note: vfs/vfs.h cannot be included from C++,
+     *       so we declare the two functions we need.
+     */
+    extern "C" errno_t vfs_read(int, aoff64_t*, void*, size_t, size_t*);
+    extern "C" errno_t vfs_write(int, aoff64_t*, const void*, size_t, size_t*);
+}
 
 namespace std
 {
@@ -39,6 +52,79 @@ namespace std
     namespace aux
     {
         ios_base::Init init{};
+
+        stdin_streambuf<char>* cin_buf{nullptr};
+        stdout_streambuf<char>* cout_buf{nullptr};
+
+        stdio_channel::stdio_channel(FILE* file)
+            : file_{file}, fd_{-1}, pos_{}, synced_{true}
+        { /* DUMMY BODY */ }
+
+        void stdio_channel::set_synced(bool synced)
+        {
+            if (synced == synced_)
+                return;
+
+            if (synced)
+            {
+                /**
+                 * Let stdio continue where we stopped, this
+                 * fails for unseekable files, which is fine.
+                 */
+                if (fd_ >= 0)
+                    ::helenos::fseek64(file_, static_cast<off64_t>(pos_), SEEK_SET);
+                fd_ = -1;
+            }
+            else
+            {
+                fflush(file_);
+                fd_ = ::helenos::fileno(file_);
+
+                auto pos = ::helenos::ftell64(file_);
+                pos_ = pos >= 0 ? static_cast<uint64_t>(pos) : 0;
+            }
+
+            synced_ = synced;
+        }
+
+        size_t stdio_channel::read(void* data, size_t size)
+        {
+            if (synced_ || fd_ < 0)
+                return fread(data, 1, size, file_);
+
+            /**
+             * A single request, console reads return
+             * as soon as a line is available.
+             */
+            size_t nread{};
+            if (::helenos::vfs_read(fd_, &pos_, data, size, &nread) != EOK)
+                return 0;
+
+            return nread;
+        }
+
+        size_t stdio_channel::write(const void* data, size_t size)
+        {
+            if (synced_ || fd_ < 0)
+                return fwrite(data, 1, size, file_);
+
+            /**
+             * Note: On error, nwritten holds the amount
+             *       written before the failure.
+             */
+            size_t nwritten{};
+            ::helenos::vfs_write(fd_, &pos_, data, size, &nwritten);
+
+            return nwritten;
+        }
+
+        bool stdio_channel::flush()
+        {
+            if (synced_ || fd_ < 0)
+                return fflush(file_) == 0;
+
+            return true;
+        }
     }
 
     int ios_base::Init::init_cnt_{};
@@ -49,10 +135,19 @@ namespace std
         {
             // TODO: These buffers should be static too
             //       in case somebody reassigns to cout/cin.
-            ::new(&cin) istream{::new aux::stdin_streambuf<char>{}};
-            ::new(&cout) ostream{::new aux::stdout_streambuf<char>{}};
+            aux::cin_buf = ::new aux::stdin_streambuf<char>{};
+            aux::cout_buf = ::new aux::stdout_streambuf<char>{};
+
+            ::new(&cin) istream{aux::cin_buf};
+            ::new(&cout) ostream{aux::cout_buf};
 
             cin.tie(&cout);
+
+            if (!sync_)
+            {
+                aux::cin_buf->set_synced(false);
+                aux::cout_buf->set_synced(false);
+            }
         }
     }
 
@@ -61,4 +156,19 @@ namespace std
         if (--init_cnt_ == 0)
             cout.flush();
     }
+
+    bool ios_base::sync_with_stdio(bool sync)
+    {
+        auto old = sync_;
+        sync_ = sync;
+
+        if (old != sync && aux::cout_buf)
+        {
+            cout.flush();
+            aux::cin_buf->set_synced(sync);
+            aux::cout_buf->set_synced(sync);
+        }
+
+        return old;
+    }
 }
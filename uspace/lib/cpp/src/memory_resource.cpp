@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/trycatch.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+
+#include <malloc.h>
+
+namespace std::pmr
+{
+    namespace
+    {
+        constexpr size_t max_align{alignof(max_align_t)};
+
+        size_t align_up(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        class new_delete_resource_t: public memory_resource
+        {
+            private:
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    if (alignment <= max_align)
+                        return ::operator new(bytes);
+
+                    auto ptr = ::helenos::memalign(alignment, bytes);
+                    if (!ptr)
+                        throw bad_alloc{};
+
+                    return ptr;
+                }
+
+                void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+                {
+                    if (alignment <= max_align)
+                        ::operator delete(ptr);
+                    else
+                        std::free(ptr);
+                }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        class null_memory_resource_t: public memory_resource
+        {
+            private:
+                void* do_allocate(size_t, size_t) override
+                {
+                    throw bad_alloc{};
+
+                    return nullptr;
+                }
+
+                void do_deallocate(void*, size_t, size_t) override
+                { /* DUMMY BODY */ }
+
+                bool do_is_equal(const memory_resource& other) const noexcept override
+                {
+                    return this == &other;
+                }
+        };
+
+        new_delete_resource_t new_delete_resource_instance{};
+        null_memory_resource_t null_memory_resource_instance{};
+        memory_resource* default_resource{&new_delete_resource_instance};
+    }
+
+    memory_resource::~memory_resource()
+    { /* DUMMY BODY */ }
+
+    memory_resource* new_delete_resource() noexcept
+    {
+        return &new_delete_resource_instance;
+    }
+
+    memory_resource* null_memory_resource() noexcept
+    {
+        return &null_memory_resource_instance;
+    }
+
+    memory_resource* set_default_resource(memory_resource* res) noexcept
+    {
+        if (!res)
+            res = new_delete_resource();
+
+        return __atomic_exchange_n(&default_resource, res, __ATOMIC_ACQ_REL);
+    }
+
+    memory_resource* get_default_resource() noexcept
+    {
+        return __atomic_load_n(&default_resource, __ATOMIC_ACQUIRE);
+    }
+
+    /**
+     * unsynchronized_pool_resource:
+     */
+
+    unsynchronized_pool_resource::unsynchronized_pool_resource(
+        const pool_options& opts, memory_resource* upstream
+    )
+        : upstream_{upstream}, options_{opts}, pools_{},
+          pool_count_{}, large_{}
+    {
+        if (options_.max_blocks_per_chunk == 0)
+            options_.max_blocks_per_chunk = default_blocks_per_chunk_;
+        if (options_.max_blocks_per_chunk < initial_blocks_per_chunk_)
+            options_.max_blocks_per_chunk = initial_blocks_per_chunk_;
+
+        if (options_.largest_required_pool_block == 0)
+            options_.largest_required_pool_block = default_largest_block_;
+
+        /**
+         * The largest block is rounded up to a power of two
+         * and limited by the number of pools we have room for.
+         */
+        size_t block_size{min_block_size_};
+        while (pool_count_ < max_pool_count_)
+        {
+            pools_[pool_count_].block_size = block_size;
+            pools_[pool_count_].next_block_count = initial_blocks_per_chunk_;
+            ++pool_count_;
+
+            if (block_size >= options_.largest_required_pool_block)
+                break;
+            block_size <<= 1;
+        }
+
+        options_.largest_required_pool_block = block_size;
+    }
+
+    unsynchronized_pool_resource::~unsynchronized_pool_resource()
+    {
+        release();
+    }
+
+    void unsynchronized_pool_resource::release()
+    {
+        for (size_t i = 0; i < pool_count_; ++i)
+        {
+            auto& p = pools_[i];
+
+            while (p.chunks)
+            {
+                auto chunk = p.chunks;
+                p.chunks = chunk->next;
+
+                upstream_->deallocate(chunk, chunk->size, max_align);
+            }
+
+            p.free = nullptr;
+            p.next_block_count = initial_blocks_per_chunk_;
+        }
+
+        while (large_)
+        {
+            auto block = large_;
+            large_ = block->next;
+
+            upstream_->deallocate(block, block->size, block->alignment);
+        }
+    }
+
+    memory_resource* unsynchronized_pool_resource::upstream_resource() const
+    {
+        return upstream_;
+    }
+
+    pool_options unsynchronized_pool_resource::options() const
+    {
+        return options_;
+    }
+
+    void* unsynchronized_pool_resource::do_allocate(size_t bytes, size_t alignment)
+    {
+        auto p = pool_for_(bytes, alignment);
+        if (!p)
+            return allocate_large_(bytes, alignment);
+
+        if (!p->free)
+            refill_(*p);
+
+        auto block = p->free;
+        p->free = block->next;
+
+        return static_cast<void*>(block);
+    }
+
+    void unsynchronized_pool_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+    {
+        auto p = pool_for_(bytes, alignment);
+        if (!p)
+        {
+            deallocate_large_(ptr, bytes, alignment);
+
+            return;
+        }
+
+        auto block = static_cast<free_block*>(ptr);
+        block->next = p->free;
+        p->free = block;
+    }
+
+    bool unsynchronized_pool_resource::do_is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    unsynchronized_pool_resource::pool*
+    unsynchronized_pool_resource::pool_for_(size_t bytes, size_t alignment)
+    {
+        if (alignment > max_align)
+            return nullptr;
+
+        /**
+         * Pools have power of two block sizes and start at
+         * a max_align_t boundary, so a block is aligned to
+         * min(block size, max_align_t) and we only need to
+         * make sure the block is not smaller than the
+         * requested alignment.
+         */
+        auto size = bytes < alignment ? alignment : bytes;
+        for (size_t i = 0; i < pool_count_; ++i)
+        {
+            if (pools_[i].block_size >= size)
+                return &pools_[i];
+        }
+
+        return nullptr;
+    }
+
+    void unsynchronized_pool_resource::refill_(pool& p)
+    {
+        auto header_size = align_up(sizeof(chunk_header), max_align);
+        auto count = p.next_block_count;
+        auto size = header_size + count * p.block_size;
+
+        auto chunk = static_cast<chunk_header*>(upstream_->allocate(size, max_align));
+        chunk->size = size;
+        chunk->next = p.chunks;
+        p.chunks = chunk;
+
+        /**
+         * Thread the new blocks in address order so
+         * that consecutive allocations are adjacent.
+         */
+        auto blocks = reinterpret_cast<char*>(chunk) + header_size;
+        for (size_t i = count; i > 0; --i)
+        {
+            auto block = reinterpret_cast<free_block*>(blocks + (i - 1) * p.block_size);
+            block->next = p.free;
+            p.free = block;
+        }
+
+        if (p.next_block_count < options_.max_blocks_per_chunk)
+        {
+            p.next_block_count <<= 1;
+            if (p.next_block_count > options_.max_blocks_per_chunk)
+                p.next_block_count = options_.max_blocks_per_chunk;
+        }
+    }
+
+    void* unsynchronized_pool_resource::allocate_large_(size_t bytes, size_t alignment)
+    {
+        if (alignment < alignof(large_header))
+            alignment = alignof(large_header);
+        auto header_size = align_up(sizeof(large_header), alignment);
+
+        auto size = header_size + bytes;
+
+        auto block = static_cast<large_header*>(
+            upstream_->allocate(size, alignment)
+        );
+
+        block->size = size;
+        block->alignment = alignment;
+        block->prev = nullptr;
+        block->next = large_;
+        if (large_)
+            large_->prev = block;
+        large_ = block;
+
+        return reinterpret_cast<char*>(block) + header_size;
+    }
+
+    void unsynchronized_pool_resource::deallocate_large_(void* ptr, size_t bytes, size_t alignment)
+    {
+        if (alignment < alignof(large_header))
+            alignment = alignof(large_header);
+        auto header_size = align_up(sizeof(large_header), alignment);
+
+        auto block = reinterpret_cast<large_header*>(
+            static_cast<char*>(ptr) - header_size
+        );
+
+        if (block->prev)
+            block->prev->next = block->next;
+        else
+            large_ = block->next;
+        if (block->next)
+            block->next->prev = block->prev;
+
+        upstream_->deallocate(block, block->size, block->alignment);
+    }
+
+    /**
+     * synchronized_pool_resource:
+     */
+
+    synchronized_pool_resource::synchronized_pool_resource(
+        const pool_options& opts, memory_resource* upstream
+    )
+        : pools_{opts, upstream}, mtx_{}
+    {
+        aux::threading::mutex::init(mtx_);
+    }
+
+    synchronized_pool_resource::~synchronized_pool_resource()
+    { /* DUMMY BODY */ }
+
+    void synchronized_pool_resource::release()
+    {
+        aux::threading::mutex::lock(mtx_);
+        pools_.release();
+        aux::threading::mutex::unlock(mtx_);
+    }
+
+    memory_resource* synchronized_pool_resource::upstream_resource() const
+    {
+        return pools_.upstream_resource();
+    }
+
+    pool_options synchronized_pool_resource::options() const
+    {
+        return pools_.options();
+    }
+
+    void* synchronized_pool_resource::do_allocate(size_t bytes, size_t alignment)
+    {
+        aux::threading::mutex::lock(mtx_);
+        auto ptr = pools_.allocate(bytes, alignment);
+        aux::threading::mutex::unlock(mtx_);
+
+        return ptr;
+    }
+
+    void synchronized_pool_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+    {
+        aux::threading::mutex::lock(mtx_);
+        pools_.deallocate(ptr, bytes, alignment);
+        aux::threading::mutex::unlock(mtx_);
+    }
+
+    bool synchronized_pool_resource::do_is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    /**
+     * monotonic_buffer_resource:
+     */
+
+    monotonic_buffer_resource::monotonic_buffer_resource(memory_resource* upstream)
+        : monotonic_buffer_resource{default_initial_size_, upstream}
+    { /* DUMMY BODY */ }
+
+    monotonic_buffer_resource::monotonic_buffer_resource(
+        size_t initial_size, memory_resource* upstream
+    )
+        : upstream_{upstream}, initial_buffer_{}, initial_size_{initial_size},
+          current_{}, space_{}, next_size_{initial_size}, chunks_{}
+    {
+        if (next_size_ == 0)
+            next_size_ = initial_size_ = default_initial_size_;
+    }
+
+    monotonic_buffer_resource::monotonic_buffer_resource(
+        void* buffer, size_t buffer_size, memory_resource* upstream
+    )
+        : upstream_{upstream}, initial_buffer_{buffer}, initial_size_{buffer_size},
+          current_{static_cast<char*>(buffer)}, space_{buffer_size},
+          next_size_{buffer_size * 2}, chunks_{}
+    {
+        if (next_size_ == 0)
+            next_size_ = default_initial_size_;
+    }
+
+    monotonic_buffer_resource::~monotonic_buffer_resource()
+    {
+        release();
+    }
+
+    void monotonic_buffer_resource::release()
+    {
+        while (chunks_)
+        {
+            auto chunk = chunks_;
+            chunks_ = chunk->next;
+
+            upstream_->deallocate(chunk, chunk->size, chunk->alignment);
+        }
+
+        if (initial_buffer_)
+        {
+            current_ = static_cast<char*>(initial_buffer_);
+            space_ = initial_size_;
+            next_size_ = initial_size_ * 2;
+            if (next_size_ == 0)
+                next_size_ = default_initial_size_;
+        }
+        else
+        {
+            current_ = nullptr;
+            space_ = 0;
+            next_size_ = initial_size_;
+        }
+    }
+
+    memory_resource* monotonic_buffer_resource::upstream_resource() const
+    {
+        return upstream_;
+    }
+
+    void* monotonic_buffer_resource::do_allocate(size_t bytes, size_t alignment)
+    {
+        if (bytes == 0)
+            bytes = 1;
+
+        auto addr = reinterpret_cast<uintptr_t>(current_);
+        auto padding = align_up(addr, alignment) - addr;
+
+        if (!current_ || padding + bytes > space_)
+        {
+            new_chunk_(bytes, alignment);
+
+            addr = reinterpret_cast<uintptr_t>(current_);
+            padding = align_up(addr, alignment) - addr;
+        }
+
+        auto ptr = current_ + padding;
+        current_ = ptr + bytes;
+        space_ -= padding + bytes;
+
+        return static_cast<void*>(ptr);
+    }
+
+    void monotonic_buffer_resource::do_deallocate(void*, size_t, size_t)
+    { /* DUMMY BODY */ }
+
+    bool monotonic_buffer_resource::do_is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void monotonic_buffer_resource::new_chunk_(size_t bytes, size_t alignment)
+    {
+        if (alignment < max_align)
+            alignment = max_align;
+        auto header_size = align_up(sizeof(chunk_header), alignment);
+
+        /**
+         * Chunk sizes grow geometrically, so the number of
+         * upstream allocations stays logarithmic in the total
+         * amount of memory handed out.
+         */
+        auto size = next_size_;
+        while (size < header_size + bytes)
+            size *= 2;
+        next_size_ = size * 2;
+
+        auto chunk = static_cast<chunk_header*>(upstream_->allocate(size, alignment));
+        chunk->next = chunks_;
+        chunk->size = size;
+        chunk->alignment = alignment;
+        chunks_ = chunk;
+
+        current_ = reinterpret_cast<char*>(chunk) + header_size;
+        space_ = size - header_size;
+    }
+}
@@ -51,6 +51,12 @@ namespace std
     {
         return handler;
     }
+
+    namespace aux
+    {
+        bool count_allocations{false};
+        size_t allocation_count{};
+    }
 }
 
 void* operator new(std::size_t size)
@@ -58,6 +64,9 @@ void* operator new(std::size_t size)
     if (size == 0)
         size = 1;
 
+    if (std::aux::count_allocations)
+        __atomic_add_fetch(&std::aux::allocation_count, 1, __ATOMIC_RELAXED);
+
     void *ptr = std::malloc(size);
 
     while (!ptr)
@@ -27,53 +27,95 @@
  */
 
 #include <__bits/refcount_obj.hpp>
+#include <cstdint>
+#include <fibril.h>
 
 namespace std::aux
 {
-    void refcount_obj::increment()
+    void refcount_obj::increment() noexcept
     {
-        __atomic_add_fetch(&refcount_, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&refcount_, 1, __ATOMIC_RELAXED);
     }
 
-    void refcount_obj::increment_weak()
+    void refcount_obj::increment_weak() noexcept
     {
-        __atomic_add_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&weak_refcount_, 1, __ATOMIC_RELAXED);
     }
 
-    bool refcount_obj::decrement()
+    bool refcount_obj::increment_if_nonzero() noexcept
     {
-        if (__atomic_sub_fetch(&refcount_, 1, __ATOMIC_ACQ_REL) == 0)
+        refcount_t rfs = refs();
+        while (rfs != 0)
         {
             /**
-             * First call to destroy() will delete the held object,
-             * so it doesn't matter what the weak_refcount_ is,
-             * but we added one and we need to remove it now.
+             * Note: On failure the compare exchange stores
+             *       the current value to rfs, so we either
+             *       retry with that or give up once the last
+             *       reference has been dropped.
              */
-            decrement_weak();
-
-            return true;
+            if (__atomic_compare_exchange_n(&refcount_, &rfs, rfs + 1,
+                                            true, __ATOMIC_ACQ_REL,
+                                            __ATOMIC_RELAXED))
+            {
+                return true;
+            }
         }
-        else
-            return false;
+
+        return false;
+    }
+
+    bool refcount_obj::decrement() noexcept
+    {
+        return __atomic_sub_fetch(&refcount_, 1, __ATOMIC_ACQ_REL) == 0;
     }
 
-    bool refcount_obj::decrement_weak()
+    bool refcount_obj::decrement_weak() noexcept
     {
-        return __atomic_sub_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL) == 0 && refs() == 0;
+        return __atomic_sub_fetch(&weak_refcount_, 1, __ATOMIC_ACQ_REL) == 0;
     }
 
-    refcount_t refcount_obj::refs() const
+    refcount_t refcount_obj::refs() const noexcept
     {
         return __atomic_load_n(&refcount_, __ATOMIC_RELAXED);
     }
 
-    refcount_t refcount_obj::weak_refs() const
+    refcount_t refcount_obj::weak_refs() const noexcept
     {
         return __atomic_load_n(&weak_refcount_, __ATOMIC_RELAXED);
     }
 
-    bool refcount_obj::expired() const
+    bool refcount_obj::expired() const noexcept
     {
         return refs() == 0;
     }
+
+    namespace
+    {
+        constexpr size_t shared_ptr_lock_count{32};
+
+        bool shared_ptr_locks[shared_ptr_lock_count]{};
+    }
+
+    shared_ptr_lock_guard::shared_ptr_lock_guard(const void* ptr) noexcept
+    {
+        /**
+         * Note: The low bits of the address are mostly
+         *       zero due to alignment, so skip them.
+         */
+        auto idx = (reinterpret_cast<uintptr_t>(ptr) >> 4) % shared_ptr_lock_count;
+        lock_ = &shared_ptr_locks[idx];
+
+        /**
+         * The critical sections only copy or swap pointers
+         * and never block, so a holder running on another
+         * thread will release the lock shortly.
+         */
+        while (__atomic_test_and_set(lock_, __ATOMIC_ACQUIRE))
+            ::helenos::fibril_yield();
+    }
+
+    shared_ptr_lock_guard::~shared_ptr_lock_guard() noexcept
+    {
+        __atomic_clear(lock_, __ATOMIC_RELEASE);
+    }
 }
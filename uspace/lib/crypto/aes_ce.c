@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_ce.c
+ *
+ * AES-128 block cipher using the ARMv8 Cryptography Extension.
+ *
+ * The extension is optional, the kernel reports its presence in the
+ * "cpu.aes" sysinfo item. Four independent blocks are processed at
+ * a time to hide the latency of the round instructions.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <mem.h>
+#include <sysinfo.h>
+#include "aes_impl.h"
+
+#define ROUNDS  10
+
+typedef uint8_t aes_vec_t __attribute__((vector_size(16)));
+
+static bool aes_ce_supported(void)
+{
+	sysarg_t aes;
+
+	if (sysinfo_get_value("cpu.aes", &aes) != EOK)
+		return false;
+
+	return aes != 0;
+}
+
+static inline aes_vec_t aes_ce_load(const uint8_t *buf)
+{
+	aes_vec_t vec;
+
+	memcpy(&vec, buf, sizeof(vec));
+	return vec;
+}
+
+static inline void aes_ce_store(uint8_t *buf, aes_vec_t vec)
+{
+	memcpy(buf, &vec, sizeof(vec));
+}
+
+__attribute__((target("+crypto")))
+static void aes_ce_encrypt(const aes_ctx_t *ctx, const uint8_t *in,
+    uint8_t *out, size_t blocks)
+{
+	const aes_vec_t *rk = (const aes_vec_t *) ctx->enc_bytes;
+
+	/*
+	 * AESE performs AddRoundKey, SubBytes and ShiftRows, AESMC
+	 * performs MixColumns. The last round key is added separately.
+	 */
+	while (blocks >= 4) {
+		aes_vec_t b0 = aes_ce_load(in);
+		aes_vec_t b1 = aes_ce_load(in + 16);
+		aes_vec_t b2 = aes_ce_load(in + 32);
+		aes_vec_t b3 = aes_ce_load(in + 48);
+
+		for (size_t round = 0; round < ROUNDS - 1; round++) {
+			asm (
+			    "aese %[b0].16b, %[k].16b\n"
+			    "aesmc %[b0].16b, %[b0].16b\n"
+			    "aese %[b1].16b, %[k].16b\n"
+			    "aesmc %[b1].16b, %[b1].16b\n"
+			    "aese %[b2].16b, %[k].16b\n"
+			    "aesmc %[b2].16b, %[b2].16b\n"
+			    "aese %[b3].16b, %[k].16b\n"
+			    "aesmc %[b3].16b, %[b3].16b\n"
+			    : [b0] "+w" (b0), [b1] "+w" (b1), [b2] "+w" (b2),
+			      [b3] "+w" (b3)
+			    : [k] "w" (rk[round])
+			);
+		}
+
+		asm (
+		    "aese %[b0].16b, %[k].16b\n"
+		    "aese %[b1].16b, %[k].16b\n"
+		    "aese %[b2].16b, %[k].16b\n"
+		    "aese %[b3].16b, %[k].16b\n"
+		    : [b0] "+w" (b0), [b1] "+w" (b1), [b2] "+w" (b2),
+		      [b3] "+w" (b3)
+		    : [k] "w" (rk[ROUNDS - 1])
+		);
+
+		aes_ce_store(out, b0 ^ rk[ROUNDS]);
+		aes_ce_store(out + 16, b1 ^ rk[ROUNDS]);
+		aes_ce_store(out + 32, b2 ^ rk[ROUNDS]);
+		aes_ce_store(out + 48, b3 ^ rk[ROUNDS]);
+
+		in += 64;
+		out += 64;
+		blocks -= 4;
+	}
+
+	while (blocks > 0) {
+		aes_vec_t b = aes_ce_load(in);
+
+		for (size_t round = 0; round < ROUNDS - 1; round++) {
+			asm (
+			    "aese %0.16b, %1.16b\n"
+			    "aesmc %0.16b, %0.16b\n"
+			    : "+w" (b)
+			    : "w" (rk[round])
+			);
+		}
+
+		asm ("aese %0.16b, %1.16b\n" : "+w" (b) : "w" (rk[ROUNDS - 1]));
+		aes_ce_store(out, b ^ rk[ROUNDS]);
+
+		in += 16;
+		out += 16;
+		blocks--;
+	}
+}
+
+__attribute__((target("+crypto")))
+static void aes_ce_decrypt(const aes_ctx_t *ctx, const uint8_t *in,
+    uint8_t *out, size_t blocks)
+{
+	const aes_vec_t *rk = (const aes_vec_t *) ctx->dec_bytes;
+
+	while (blocks >= 4) {
+		aes_vec_t b0 = aes_ce_load(in);
+		aes_vec_t b1 = aes_ce_load(in + 16);
+		aes_vec_t b2 = aes_ce_load(in + 32);
+		aes_vec_t b3 = aes_ce_load(in + 48);
+
+		for (size_t round = 0; round < ROUNDS - 1; round++) {
+			asm (
+			    "aesd %[b0].16b, %[k].16b\n"
+			    "aesimc %[b0].16b, %[b0].16b\n"
+			    "aesd %[b1].16b, %[k].16b\n"
+			    "aesimc %[b1].16b, %[b1].16b\n"
+			    "aesd %[b2].16b, %[k].16b\n"
+			    "aesimc %[b2].16b, %[b2].16b\n"
+			    "aesd %[b3].16b, %[k].16b\n"
+			    "aesimc %[b3].16b, %[b3].16b\n"
+			    : [b0] "+w" (b0), [b1] "+w" (b1), [b2] "+w" (b2),
+			      [b3] "+w" (b3)
+			    : [k] "w" (rk[round])
+			);
+		}
+
+		asm (
+		    "aesd %[b0].16b, %[k].16b\n"
+		    "aesd %[b1].16b, %[k].16b\n"
+		    "aesd %[b2].16b, %[k].16b\n"
+		    "aesd %[b3].16b, %[k].16b\n"
+		    : [b0] "+w" (b0), [b1] "+w" (b1), [b2] "+w" (b2),
+		      [b3] "+w" (b3)
+		    : [k] "w" (rk[ROUNDS - 1])
+		);
+
+		aes_ce_store(out, b0 ^ rk[ROUNDS]);
+		aes_ce_store(out + 16, b1 ^ rk[ROUNDS]);
+		aes_ce_store(out + 32, b2 ^ rk[ROUNDS]);
+		aes_ce_store(out + 48, b3 ^ rk[ROUNDS]);
+
+		in += 64;
+		out += 64;
+		blocks -= 4;
+	}
+
+	while (blocks > 0) {
+		aes_vec_t b = aes_ce_load(in);
+
+		for (size_t round = 0; round < ROUNDS - 1; round++) {
+			asm (
+			    "aesd %0.16b, %1.16b\n"
+			    "aesimc %0.16b, %0.16b\n"
+			    : "+w" (b)
+			    : "w" (rk[round])
+			);
+		}
+
+		asm ("aesd %0.16b, %1.16b\n" : "+w" (b) : "w" (rk[ROUNDS - 1]));
+		aes_ce_store(out, b ^ rk[ROUNDS]);
+
+		in += 16;
+		out += 16;
+		blocks--;
+	}
+}
+
+const aes_impl_t aes_hw_impl = {
+	.name = "armv8-ce",
+	.supported = aes_ce_supported,
+	.encrypt = aes_ce_encrypt,
+	.decrypt = aes_ce_decrypt
+};
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_impl.h
+ *
+ * Interface between the AES modes of operation and the block cipher
+ * implementations.
+ */
+
+#ifndef LIBCRYPTO_AES_IMPL_H
+#define LIBCRYPTO_AES_IMPL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto.h"
+
+/** AES block cipher implementation. */
+typedef struct {
+	/** Implementation name */
+	const char *name;
+	/** Determine whether the processor supports the implementation */
+	bool (*supported)(void);
+	/** Encrypt consecutive blocks using ctx->enc_bytes */
+	void (*encrypt)(const aes_ctx_t *, const uint8_t *, uint8_t *, size_t);
+	/** Decrypt consecutive blocks using ctx->dec_bytes */
+	void (*decrypt)(const aes_ctx_t *, const uint8_t *, uint8_t *, size_t);
+} aes_impl_t;
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+/** Hardware implementation is available for this architecture */
+#define AES_IMPL_HW
+
+/** Implementation using AES-NI (amd64) or ARMv8 Crypto Extension (arm64) */
+extern const aes_impl_t aes_hw_impl;
+
+#endif
+
+#endif
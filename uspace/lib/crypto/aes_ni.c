@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_ni.c
+ *
+ * AES-128 block cipher using the AES-NI instructions of amd64 processors.
+ *
+ * Only SSE registers are used, whose state the kernel preserves across
+ * context switches. Four independent blocks are processed at a time
+ * to hide the latency of the round instructions.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <mem.h>
+#include "aes_impl.h"
+
+#define CPUID_LEVEL  0
+#define CPUID_FEATURES  1
+
+/** CPUID.1:ECX AES instructions bit. */
+#define CPUID_ECX_AES  (1 << 25)
+
+#define ROUNDS  10
+
+typedef long long aes_vec_t __attribute__((vector_size(16)));
+
+static inline void aes_ni_cpuid(uint32_t leaf, uint32_t *regs)
+{
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	    : "a" (leaf), "c" (0)
+	);
+}
+
+static bool aes_ni_supported(void)
+{
+	uint32_t regs[4];
+
+	aes_ni_cpuid(CPUID_LEVEL, regs);
+	if (regs[0] < CPUID_FEATURES)
+		return false;
+
+	aes_ni_cpuid(CPUID_FEATURES, regs);
+	return (regs[2] & CPUID_ECX_AES) != 0;
+}
+
+static inline aes_vec_t aes_ni_load(const uint8_t *buf)
+{
+	aes_vec_t vec;
+
+	memcpy(&vec, buf, sizeof(vec));
+	return vec;
+}
+
+static inline void aes_ni_store(uint8_t *buf, aes_vec_t vec)
+{
+	memcpy(buf, &vec, sizeof(vec));
+}
+
+static void aes_ni_encrypt(const aes_ctx_t *ctx, const uint8_t *in,
+    uint8_t *out, size_t blocks)
+{
+	const aes_vec_t *rk = (const aes_vec_t *) ctx->enc_bytes;
+
+	while (blocks >= 4) {
+		aes_vec_t b0 = aes_ni_load(in) ^ rk[0];
+		aes_vec_t b1 = aes_ni_load(in + 16) ^ rk[0];
+		aes_vec_t b2 = aes_ni_load(in + 32) ^ rk[0];
+		aes_vec_t b3 = aes_ni_load(in + 48) ^ rk[0];
+
+		for (size_t round = 1; round < ROUNDS; round++) {
+			asm (
+			    "aesenc %[k], %[b0]\n"
+			    "aesenc %[k], %[b1]\n"
+			    "aesenc %[k], %[b2]\n"
+			    "aesenc %[k], %[b3]\n"
+			    : [b0] "+x" (b0), [b1] "+x" (b1), [b2] "+x" (b2),
+			      [b3] "+x" (b3)
+			    : [k] "x" (rk[round])
+			);
+		}
+
+		asm (
+		    "aesenclast %[k], %[b0]\n"
+		    "aesenclast %[k], %[b1]\n"
+		    "aesenclast %[k], %[b2]\n"
+		    "aesenclast %[k], %[b3]\n"
+		    : [b0] "+x" (b0), [b1] "+x" (b1), [b2] "+x" (b2),
+		      [b3] "+x" (b3)
+		    : [k] "x" (rk[ROUNDS])
+		);
+
+		aes_ni_store(out, b0);
+		aes_ni_store(out + 16, b1);
+		aes_ni_store(out + 32, b2);
+		aes_ni_store(out + 48, b3);
+
+		in += 64;
+		out += 64;
+		blocks -= 4;
+	}
+
+	while (blocks > 0) {
+		aes_vec_t b = aes_ni_load(in) ^ rk[0];
+
+		for (size_t round = 1; round < ROUNDS; round++)
+			asm ("aesenc %1, %0\n" : "+x" (b) : "x" (rk[round]));
+
+		asm ("aesenclast %1, %0\n" : "+x" (b) : "x" (rk[ROUNDS]));
+		aes_ni_store(out, b);
+
+		in += 16;
+		out += 16;
+		blocks--;
+	}
+}
+
+static void aes_ni_decrypt(const aes_ctx_t *ctx, const uint8_t *in,
+    uint8_t *out, size_t blocks)
+{
+	const aes_vec_t *rk = (const aes_vec_t *) ctx->dec_bytes;
+
+	while (blocks >= 4) {
+		aes_vec_t b0 = aes_ni_load(in) ^ rk[0];
+		aes_vec_t b1 = aes_ni_load(in + 16) ^ rk[0];
+		aes_vec_t b2 = aes_ni_load(in + 32) ^ rk[0];
+		aes_vec_t b3 = aes_ni_load(in + 48) ^ rk[0];
+
+		for (size_t round = 1; round < ROUNDS; round++) {
+			asm (
+			    "aesdec %[k], %[b0]\n"
+			    "aesdec %[k], %[b1]\n"
+			    "aesdec %[k], %[b2]\n"
+			    "aesdec %[k], %[b3]\n"
+			    : [b0] "+x" (b0), [b1] "+x" (b1), [b2] "+x" (b2),
+			      [b3] "+x" (b3)
+			    : [k] "x" (rk[round])
+			);
+		}
+
+		asm (
+		    "aesdeclast %[k], %[b0]\n"
+		    "aesdeclast %[k], %[b1]\n"
+		    "aesdeclast %[k], %[b2]\n"
+		    "aesdeclast %[k], %[b3]\n"
+		    : [b0] "+x" (b0), [b1] "+x" (b1), [b2] "+x" (b2),
+		      [b3] "+x" (b3)
+		    : [k] "x" (rk[ROUNDS])
+		);
+
+		aes_ni_store(out, b0);
+		aes_ni_store(out + 16, b1);
+		aes_ni_store(out + 32, b2);
+		aes_ni_store(out + 48, b3);
+
+		in += 64;
+		out += 64;
+		blocks -= 4;
+	}
+
+	while (blocks > 0) {
+		aes_vec_t b = aes_ni_load(in) ^ rk[0];
+
+		for (size_t round = 1; round < ROUNDS; round++)
+			asm ("aesdec %1, %0\n" : "+x" (b) : "x" (rk[round]));
+
+		asm ("aesdeclast %1, %0\n" : "+x" (b) : "x" (rk[ROUNDS]));
+		aes_ni_store(out, b);
+
+		in += 16;
+		out += 16;
+		blocks--;
+	}
+}
+
+const aes_impl_t aes_hw_impl = {
+	.name = "aes-ni",
+	.supported = aes_ni_supported,
+	.encrypt = aes_ni_encrypt,
+	.decrypt = aes_ni_decrypt
+};
@@ -0,0 +1,17 @@
+#ifndef SHIM_BO
+#define SHIM_BO
+#include <stdint.h>
+#include <endian.h>
+#define uint32_t_le2host(x) le32toh(x)
+#define uint32_t_be2host(x) be32toh(x)
+#define host2uint32_t_le(x) htole32(x)
+#define host2uint32_t_be(x) htobe32(x)
+#define uint16_t_le2host(x) le16toh(x)
+#define uint16_t_be2host(x) be16toh(x)
+#define host2uint16_t_le(x) htole16(x)
+#define host2uint16_t_be(x) htobe16(x)
+#define uint64_t_le2host(x) le64toh(x)
+#define uint64_t_be2host(x) be64toh(x)
+#define host2uint64_t_le(x) htole64(x)
+#define host2uint64_t_be(x) htobe64(x)
+#endif
@@ -31,39 +31,27 @@
  * Cryptographic functions library.
  */
 
-#include <assert.h>
 #include <str.h>
 #include <macros.h>
 #include <errno.h>
 #include <byteorder.h>
-#include <limits.h>
 #include "crypto.h"
-
-/** Hash function procedure definition. */
-typedef void (*hash_fnc_t)(uint32_t *, uint32_t *);
+#include "sha_impl.h"
 
 /** Length of HMAC block. */
-#define HMAC_BLOCK_LENGTH  64
-
-/** Ceiling for uint32_t. */
-#define ceil_uint32(val) \
-	(((val) - (uint32_t) (val)) > 0 ? \
-	(uint32_t) ((val) + 1) : (uint32_t) (val))
-
-/** Floor for uint32_t. */
-#define floor_uint32(val) \
-	(((val) - (uint32_t) (val)) < 0 ? \
-	(uint32_t) ((val) - 1) : (uint32_t) (val))
-
-/** Pick value at specified index from array or zero if out of bounds. */
-#define get_at(input, size, i) \
-	((i) < (size) ? (input[i]) : 0)
+#define HMAC_BLOCK_LENGTH  HASH_BLOCK_LENGTH
 
 /** Init values used in SHA1 and MD5 functions. */
-static const uint32_t hash_init[] = {
+static const uint32_t md5_sha1_init[] = {
 	0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
 };
 
+/** Init values used in SHA-256 function. */
+static const uint32_t sha256_init[] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
 /** Shift amount array for MD5 algorithm. */
 static const uint32_t md5_shift[] = {
 	7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
@@ -92,95 +80,368 @@ static const uint32_t md5_sbox[] = {
 	0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
 };
 
+/** Round constants for SHA-256 algorithm. */
+const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t load_be32(const uint8_t *buf)
+{
+	return ((uint32_t) buf[0] << 24) | ((uint32_t) buf[1] << 16) |
+	    ((uint32_t) buf[2] << 8) | buf[3];
+}
+
+static inline uint32_t load_le32(const uint8_t *buf)
+{
+	return ((uint32_t) buf[3] << 24) | ((uint32_t) buf[2] << 16) |
+	    ((uint32_t) buf[1] << 8) | buf[0];
+}
+
 /** Working procedure of MD5 cryptographic hash function.
  *
- * @param h         Working array with interim hash parts values.
- * @param sched_arr Input array with scheduled values from input string.
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
  *
  */
-static void md5_proc(uint32_t *h, uint32_t *sched_arr)
+static void md5_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
 {
-	uint32_t f, g, temp;
-	uint32_t w[HASH_MD5 / 4];
-
-	memcpy(w, h, (HASH_MD5 / 4) * sizeof(uint32_t));
-
-	for (size_t k = 0; k < 64; k++) {
-		if (k < 16) {
-			f = (w[1] & w[2]) | (~w[1] & w[3]);
-			g = k;
-		} else if ((k >= 16) && (k < 32)) {
-			f = (w[1] & w[3]) | (w[2] & ~w[3]);
-			g = (5 * k + 1) % 16;
-		} else if ((k >= 32) && (k < 48)) {
-			f = w[1] ^ w[2] ^ w[3];
-			g = (3 * k + 5) % 16;
-		} else {
-			f = w[2] ^ (w[1] | ~w[3]);
-			g = 7 * k % 16;
+	uint32_t m[16];
+	uint32_t a, b, c, d, f, temp;
+
+	while (blocks-- > 0) {
+		for (size_t k = 0; k < 16; k++)
+			m[k] = load_le32(data + 4 * k);
+
+		a = h[0];
+		b = h[1];
+		c = h[2];
+		d = h[3];
+
+		for (size_t k = 0; k < 64; k++) {
+			size_t g;
+
+			if (k < 16) {
+				f = d ^ (b & (c ^ d));
+				g = k;
+			} else if (k < 32) {
+				f = c ^ (d & (b ^ c));
+				g = (5 * k + 1) % 16;
+			} else if (k < 48) {
+				f = b ^ c ^ d;
+				g = (3 * k + 5) % 16;
+			} else {
+				f = c ^ (b | ~d);
+				g = 7 * k % 16;
+			}
+
+			temp = d;
+			d = c;
+			c = b;
+			b += rotl_uint32(a + f + md5_sbox[k] + m[g],
+			    md5_shift[k]);
+			a = temp;
 		}
 
-		temp = w[3];
-		w[3] = w[2];
-		w[2] = w[1];
-		w[1] += rotl_uint32(w[0] + f + md5_sbox[k] +
-		    uint32_t_byteorder_swap(sched_arr[g]),
-		    md5_shift[k]);
-		w[0] = temp;
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		data += HASH_BLOCK_LENGTH;
 	}
-
-	for (uint8_t k = 0; k < HASH_MD5 / 4; k++)
-		h[k] += w[k];
 }
 
 /** Working procedure of SHA-1 cryptographic hash function.
  *
- * @param h         Working array with interim hash parts values.
- * @param sched_arr Input array with scheduled values from input string.
+ * The message schedule is kept in a 16-word circular buffer.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
  *
  */
-static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
+static void sha1_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
 {
-	uint32_t f, cf, temp;
-	uint32_t w[HASH_SHA1 / 4];
-
-	for (size_t k = 16; k < 80; k++) {
-		sched_arr[k] = rotl_uint32(
-		    sched_arr[k - 3] ^
-		    sched_arr[k - 8] ^
-		    sched_arr[k - 14] ^
-		    sched_arr[k - 16],
-		    1);
+	uint32_t w[16];
+	uint32_t a, b, c, d, e, f, cf, temp;
+
+	while (blocks-- > 0) {
+		for (size_t k = 0; k < 16; k++)
+			w[k] = load_be32(data + 4 * k);
+
+		a = h[0];
+		b = h[1];
+		c = h[2];
+		d = h[3];
+		e = h[4];
+
+		for (size_t k = 0; k < 80; k++) {
+			if (k >= 16) {
+				w[k % 16] = rotl_uint32(w[(k - 3) % 16] ^
+				    w[(k - 8) % 16] ^ w[(k - 14) % 16] ^
+				    w[k % 16], 1);
+			}
+
+			if (k < 20) {
+				f = d ^ (b & (c ^ d));
+				cf = 0x5a827999;
+			} else if (k < 40) {
+				f = b ^ c ^ d;
+				cf = 0x6ed9eba1;
+			} else if (k < 60) {
+				f = (b & c) | (d & (b | c));
+				cf = 0x8f1bbcdc;
+			} else {
+				f = b ^ c ^ d;
+				cf = 0xca62c1d6;
+			}
+
+			temp = rotl_uint32(a, 5) + f + e + cf + w[k % 16];
+			e = d;
+			d = c;
+			c = rotl_uint32(b, 30);
+			b = a;
+			a = temp;
+		}
+
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+		data += HASH_BLOCK_LENGTH;
 	}
+}
 
-	memcpy(w, h, (HASH_SHA1 / 4) * sizeof(uint32_t));
-
-	for (size_t k = 0; k < 80; k++) {
-		if (k < 20) {
-			f = (w[1] & w[2]) | (~w[1] & w[3]);
-			cf = 0x5A827999;
-		} else if ((k >= 20) && (k < 40)) {
-			f = w[1] ^ w[2] ^ w[3];
-			cf = 0x6ed9eba1;
-		} else if ((k >= 40) && (k < 60)) {
-			f = (w[1] & w[2]) | (w[1] & w[3]) | (w[2] & w[3]);
-			cf = 0x8f1bbcdc;
-		} else {
-			f = w[1] ^ w[2] ^ w[3];
-			cf = 0xca62c1d6;
+/** Working procedure of SHA-256 cryptographic hash function.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
+ *
+ */
+static void sha256_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	uint32_t w[16];
+	uint32_t s[8];
+	uint32_t t1, t2;
+
+	while (blocks-- > 0) {
+		for (size_t k = 0; k < 16; k++)
+			w[k] = load_be32(data + 4 * k);
+
+		memcpy(s, h, sizeof(s));
+
+		for (size_t k = 0; k < 64; k++) {
+			if (k >= 16) {
+				uint32_t w15 = w[(k - 15) % 16];
+				uint32_t w2 = w[(k - 2) % 16];
+
+				w[k % 16] += w[(k - 7) % 16] +
+				    (rotr_uint32(w15, 7) ^ rotr_uint32(w15, 18) ^
+				    (w15 >> 3)) +
+				    (rotr_uint32(w2, 17) ^ rotr_uint32(w2, 19) ^
+				    (w2 >> 10));
+			}
+
+			t1 = s[7] + (rotr_uint32(s[4], 6) ^
+			    rotr_uint32(s[4], 11) ^ rotr_uint32(s[4], 25)) +
+			    (s[6] ^ (s[4] & (s[5] ^ s[6]))) + sha256_k[k] +
+			    w[k % 16];
+			t2 = (rotr_uint32(s[0], 2) ^ rotr_uint32(s[0], 13) ^
+			    rotr_uint32(s[0], 22)) +
+			    ((s[0] & s[1]) | (s[2] & (s[0] | s[1])));
+
+			s[7] = s[6];
+			s[6] = s[5];
+			s[5] = s[4];
+			s[4] = s[3] + t1;
+			s[3] = s[2];
+			s[2] = s[1];
+			s[1] = s[0];
+			s[0] = t1 + t2;
 		}
 
-		temp = rotl_uint32(w[0], 5) + f + w[4] + cf + sched_arr[k];
+		for (size_t k = 0; k < 8; k++)
+			h[k] += s[k];
+
+		data += HASH_BLOCK_LENGTH;
+	}
+}
+
+/** Block functions in use, chosen on first use. */
+static hash_blocks_t sha1_impl = NULL;
+static hash_blocks_t sha256_impl = NULL;
+
+/** Choose the fastest SHA implementations supported by the processor. */
+static void hash_impl_select(void)
+{
+	if (sha256_impl != NULL)
+		return;
+
+	hash_blocks_t sha1 = sha1_blocks;
+	hash_blocks_t sha256 = sha256_blocks;
+
+#ifdef SHA_IMPL_HW
+	if (sha_hw_impl.supported(HASH_SHA1))
+		sha1 = sha_hw_impl.sha1_blocks;
+	if (sha_hw_impl.supported(HASH_SHA256))
+		sha256 = sha_hw_impl.sha256_blocks;
+#endif
+
+	sha1_impl = sha1;
+	sha256_impl = sha256;
+}
+
+/** Get name of the implementation used for a hash function.
+ *
+ * @param hash_sel Hash function selector.
+ *
+ * @return Implementation name ("generic", "sha-ni" or "armv8-ce").
+ *
+ */
+const char *hash_impl_name(hash_func_t hash_sel)
+{
+	hash_impl_select();
+
+#ifdef SHA_IMPL_HW
+	if (hash_sel == HASH_SHA1 && sha1_impl != sha1_blocks)
+		return sha_hw_impl.name;
+	if (hash_sel == HASH_SHA256 && sha256_impl != sha256_blocks)
+		return sha_hw_impl.name;
+#endif
+
+	return "generic";
+}
 
-		w[4] = w[3];
-		w[3] = w[2];
-		w[2] = rotl_uint32(w[1], 30);
-		w[1] = w[0];
-		w[0] = temp;
+/** Initialize hash context.
+ *
+ * @param ctx      Hash context.
+ * @param hash_sel Hash function selector.
+ *
+ * @return EOK on success, EINVAL for unknown hash function.
+ *
+ */
+errno_t hash_init(hash_ctx_t *ctx, hash_func_t hash_sel)
+{
+	hash_impl_select();
+
+	switch (hash_sel) {
+	case HASH_MD5:
+		ctx->blocks = md5_blocks;
+		memcpy(ctx->h, md5_sha1_init, 4 * sizeof(uint32_t));
+		break;
+	case HASH_SHA1:
+		ctx->blocks = sha1_impl;
+		memcpy(ctx->h, md5_sha1_init, 5 * sizeof(uint32_t));
+		break;
+	case HASH_SHA256:
+		ctx->blocks = sha256_impl;
+		memcpy(ctx->h, sha256_init, 8 * sizeof(uint32_t));
+		break;
+	default:
+		return EINVAL;
 	}
 
-	for (uint8_t k = 0; k < HASH_SHA1 / 4; k++)
-		h[k] += w[k];
+	ctx->func = hash_sel;
+	ctx->length = 0;
+	ctx->buf_len = 0;
+	return EOK;
+}
+
+/** Feed data to hash context.
+ *
+ * Whole blocks are processed directly from @a data, only the remainder
+ * is buffered in the context.
+ *
+ * @param ctx  Hash context.
+ * @param data Data.
+ * @param size Size of data in bytes.
+ *
+ */
+void hash_update(hash_ctx_t *ctx, const void *data, size_t size)
+{
+	const uint8_t *bp = data;
+
+	ctx->length += size;
+
+	if (ctx->buf_len > 0) {
+		size_t chunk = min(size, HASH_BLOCK_LENGTH - ctx->buf_len);
+
+		memcpy(ctx->buf + ctx->buf_len, bp, chunk);
+		ctx->buf_len += chunk;
+		bp += chunk;
+		size -= chunk;
+
+		if (ctx->buf_len < HASH_BLOCK_LENGTH)
+			return;
+
+		ctx->blocks(ctx->h, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+
+	if (size >= HASH_BLOCK_LENGTH) {
+		size_t blocks = size / HASH_BLOCK_LENGTH;
+
+		ctx->blocks(ctx->h, bp, blocks);
+		bp += blocks * HASH_BLOCK_LENGTH;
+		size -= blocks * HASH_BLOCK_LENGTH;
+	}
+
+	memcpy(ctx->buf, bp, size);
+	ctx->buf_len = size;
+}
+
+/** Finish hash computation.
+ *
+ * @param ctx  Hash context. Must be initialized again before reuse.
+ * @param hash Output buffer of (size_t) ctx->func bytes.
+ *
+ */
+void hash_final(hash_ctx_t *ctx, uint8_t *hash)
+{
+	uint64_t bits = ctx->length * 8;
+	size_t len = ctx->buf_len;
+
+	ctx->buf[len++] = 0x80;
+
+	if (len > HASH_BLOCK_LENGTH - 8) {
+		memset(ctx->buf + len, 0, HASH_BLOCK_LENGTH - len);
+		ctx->blocks(ctx->h, ctx->buf, 1);
+		len = 0;
+	}
+
+	memset(ctx->buf + len, 0, HASH_BLOCK_LENGTH - 8 - len);
+
+	/* MD5 stores the length and the result in little-endian order */
+	for (size_t i = 0; i < 8; i++) {
+		size_t shift = (ctx->func == HASH_MD5) ? 8 * i : 56 - 8 * i;
+		ctx->buf[HASH_BLOCK_LENGTH - 8 + i] = (bits >> shift) & 0xff;
+	}
+
+	ctx->blocks(ctx->h, ctx->buf, 1);
+
+	for (size_t i = 0; i < ctx->func / 4; i++) {
+		uint32_t val = (ctx->func == HASH_MD5) ?
+		    host2uint32_t_le(ctx->h[i]) : host2uint32_t_be(ctx->h[i]);
+
+		memcpy(hash + i * sizeof(uint32_t), &val, sizeof(uint32_t));
+	}
 }
 
 /** Create hash based on selected algorithm.
@@ -190,7 +451,7 @@ static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
  * @param output     Result hash byte sequence.
  * @param hash_sel   Hash function selector.
  *
- * @return EINVAL when input not specified,
+ * @return EINVAL when input not specified or hash function unknown,
  *         ENOMEM when pointer for output hash result
  *         is not allocated, otherwise EOK.
  *
@@ -198,7 +459,8 @@ static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
 errno_t create_hash(uint8_t *input, size_t input_size, uint8_t *output,
     hash_func_t hash_sel)
 {
-	assert(input_size < SSIZE_MAX);
+	hash_ctx_t ctx;
+	errno_t rc;
 
 	if (!input)
 		return EINVAL;
@@ -206,55 +468,92 @@ errno_t create_hash(uint8_t *input, size_t input_size, uint8_t *output,
 	if (!output)
 		return ENOMEM;
 
-	hash_fnc_t hash_func = (hash_sel == HASH_MD5) ? md5_proc : sha1_proc;
-
-	/* Prepare scheduled input. */
-	uint8_t work_input[input_size + 1];
-	memcpy(work_input, input, input_size);
-	work_input[input_size] = 0x80;
-
-	// FIXME: double?
-	size_t blocks = ceil_uint32((((double) input_size + 1) / 4 + 2) / 16);
-	uint32_t work_arr[blocks * 16];
-	for (size_t i = 0; i < blocks; i++) {
-		for (size_t j = 0; j < 16; j++) {
-			work_arr[i * 16 + j] =
-			    (get_at(work_input, input_size + 1, i * 64 + j * 4) << 24) |
-			    (get_at(work_input, input_size + 1, i * 64 + j * 4 + 1) << 16) |
-			    (get_at(work_input, input_size + 1, i * 64 + j * 4 + 2) << 8) |
-			    get_at(work_input, input_size + 1, i * 64 + j * 4 + 3);
-		}
-	}
+	rc = hash_init(&ctx, hash_sel);
+	if (rc != EOK)
+		return rc;
 
-	uint64_t bits_size = (uint64_t) (input_size * 8);
-	if (hash_sel == HASH_MD5)
-		bits_size = uint64_t_byteorder_swap(bits_size);
+	hash_update(&ctx, input, input_size);
+	hash_final(&ctx, output);
 
-	work_arr[(blocks - 1) * 16 + 14] = bits_size >> 32;
-	work_arr[(blocks - 1) * 16 + 15] = bits_size & 0xffffffff;
+	return EOK;
+}
 
-	/* Hash computation. */
-	uint32_t h[hash_sel / 4];
-	memcpy(h, hash_init, (hash_sel / 4) * sizeof(uint32_t));
-	uint32_t sched_arr[80];
-	for (size_t i = 0; i < blocks; i++) {
-		for (size_t k = 0; k < 16; k++)
-			sched_arr[k] = work_arr[i * 16 + k];
+/** Initialize HMAC context.
+ *
+ * The inner and outer hash states after absorbing the padded key are
+ * kept in the context. A keyed context can be copied by assignment to
+ * compute several MACs with the same key without processing the key
+ * again.
+ *
+ * @param ctx      HMAC context.
+ * @param key      Cryptographic key sequence.
+ * @param key_size Size of key sequence.
+ * @param hash_sel Hash function selector.
+ *
+ * @return EOK on success, EINVAL for unknown hash function.
+ *
+ */
+errno_t hmac_init(hmac_ctx_t *ctx, const uint8_t *key, size_t key_size,
+    hash_func_t hash_sel)
+{
+	uint8_t work_key[HMAC_BLOCK_LENGTH];
+	uint8_t pad[HMAC_BLOCK_LENGTH];
+	errno_t rc;
 
-		hash_func(h, sched_arr);
-	}
+	rc = hash_init(&ctx->inner, hash_sel);
+	if (rc != EOK)
+		return rc;
 
-	/* Copy hash parts into final result. */
-	for (size_t i = 0; i < hash_sel / 4; i++) {
-		if (hash_sel == HASH_SHA1)
-			h[i] = uint32_t_byteorder_swap(h[i]);
+	memset(work_key, 0, HMAC_BLOCK_LENGTH);
 
-		memcpy(output + i * sizeof(uint32_t), &h[i], sizeof(uint32_t));
+	if (key_size > HMAC_BLOCK_LENGTH) {
+		hash_update(&ctx->inner, key, key_size);
+		hash_final(&ctx->inner, work_key);
+		(void) hash_init(&ctx->inner, hash_sel);
+	} else {
+		memcpy(work_key, key, key_size);
 	}
 
+	(void) hash_init(&ctx->outer, hash_sel);
+
+	for (size_t i = 0; i < HMAC_BLOCK_LENGTH; i++)
+		pad[i] = work_key[i] ^ 0x36;
+	hash_update(&ctx->inner, pad, HMAC_BLOCK_LENGTH);
+
+	for (size_t i = 0; i < HMAC_BLOCK_LENGTH; i++)
+		pad[i] = work_key[i] ^ 0x5c;
+	hash_update(&ctx->outer, pad, HMAC_BLOCK_LENGTH);
+
 	return EOK;
 }
 
+/** Feed message data to HMAC context.
+ *
+ * @param ctx  HMAC context.
+ * @param data Data.
+ * @param size Size of data in bytes.
+ *
+ */
+void hmac_update(hmac_ctx_t *ctx, const void *data, size_t size)
+{
+	hash_update(&ctx->inner, data, size);
+}
+
+/** Finish HMAC computation.
+ *
+ * @param ctx  HMAC context. Must be initialized again before reuse.
+ * @param hash Output buffer of (size_t) hash function bytes.
+ *
+ */
+void hmac_final(hmac_ctx_t *ctx, uint8_t *hash)
+{
+	uint8_t temp_hash[HASH_MAX_LENGTH];
+
+	hash_final(&ctx->inner, temp_hash);
+	hash_update(&ctx->outer, temp_hash, ctx->outer.func);
+	hash_final(&ctx->outer, hash);
+}
+
 /** Hash-based message authentication code.
  *
  * @param key      Cryptographic key sequence.
@@ -264,47 +563,29 @@ errno_t create_hash(uint8_t *input, size_t input_size, uint8_t *output,
  * @param hash     Output parameter for result hash.
  * @param hash_sel Hash function selector.
  *
- * @return EINVAL when key or message not specified,
- *         ENOMEM when pointer for output hash result
+ * @return EINVAL when key or message not specified or hash function
+ *         unknown, ENOMEM when pointer for output hash result
  *         is not allocated, otherwise EOK.
  *
  */
 errno_t hmac(uint8_t *key, size_t key_size, uint8_t *msg, size_t msg_size,
     uint8_t *hash, hash_func_t hash_sel)
 {
+	hmac_ctx_t ctx;
+	errno_t rc;
+
 	if ((!key) || (!msg))
 		return EINVAL;
 
 	if (!hash)
 		return ENOMEM;
 
-	uint8_t work_key[HMAC_BLOCK_LENGTH];
-	uint8_t o_key_pad[HMAC_BLOCK_LENGTH];
-	uint8_t i_key_pad[HMAC_BLOCK_LENGTH];
-	uint8_t temp_hash[hash_sel];
-	memset(work_key, 0, HMAC_BLOCK_LENGTH);
+	rc = hmac_init(&ctx, key, key_size, hash_sel);
+	if (rc != EOK)
+		return rc;
 
-	if (key_size > HMAC_BLOCK_LENGTH)
-		create_hash(key, key_size, work_key, hash_sel);
-	else
-		memcpy(work_key, key, key_size);
-
-	for (size_t i = 0; i < HMAC_BLOCK_LENGTH; i++) {
-		o_key_pad[i] = work_key[i] ^ 0x5c;
-		i_key_pad[i] = work_key[i] ^ 0x36;
-	}
-
-	uint8_t temp_work[HMAC_BLOCK_LENGTH + max(msg_size, hash_sel)];
-	memcpy(temp_work, i_key_pad, HMAC_BLOCK_LENGTH);
-	memcpy(temp_work + HMAC_BLOCK_LENGTH, msg, msg_size);
-
-	create_hash(temp_work, HMAC_BLOCK_LENGTH + msg_size, temp_hash,
-	    hash_sel);
-
-	memcpy(temp_work, o_key_pad, HMAC_BLOCK_LENGTH);
-	memcpy(temp_work + HMAC_BLOCK_LENGTH, temp_hash, hash_sel);
-
-	create_hash(temp_work, HMAC_BLOCK_LENGTH + hash_sel, hash, hash_sel);
+	hmac_update(&ctx, msg, msg_size);
+	hmac_final(&ctx, hash);
 
 	return EOK;
 }
@@ -314,6 +595,9 @@ errno_t hmac(uint8_t *key, size_t key_size, uint8_t *msg, size_t msg_size,
  * As defined in RFC 2898, using HMAC-SHA1 with 4096 iterations
  * and 32 bytes key result used for WPA/WPA2.
  *
+ * The password is absorbed into the HMAC state only once, each
+ * iteration starts from a copy of the keyed state.
+ *
  * @param pass      Password sequence.
  * @param pass_size Password sequence length.
  * @param salt      Salt sequence to be used with password.
@@ -328,31 +612,34 @@ errno_t hmac(uint8_t *key, size_t key_size, uint8_t *msg, size_t msg_size,
 errno_t pbkdf2(uint8_t *pass, size_t pass_size, uint8_t *salt, size_t salt_size,
     uint8_t *hash)
 {
+	hmac_ctx_t keyed;
+	hmac_ctx_t ctx;
+
 	if ((!pass) || (!salt))
 		return EINVAL;
 
 	if (!hash)
 		return ENOMEM;
 
-	uint8_t work_salt[salt_size + 4];
-	memcpy(work_salt, salt, salt_size);
 	uint8_t work_hmac[HASH_SHA1];
-	uint8_t temp_hmac[HASH_SHA1];
 	uint8_t xor_hmac[HASH_SHA1];
 	uint8_t temp_hash[HASH_SHA1 * 2];
 
+	(void) hmac_init(&keyed, pass, pass_size, HASH_SHA1);
+
 	for (size_t i = 0; i < 2; i++) {
 		uint32_t be_i = host2uint32_t_be(i + 1);
 
-		memcpy(work_salt + salt_size, &be_i, 4);
-		hmac(pass, pass_size, work_salt, salt_size + 4,
-		    work_hmac, HASH_SHA1);
+		ctx = keyed;
+		hmac_update(&ctx, salt, salt_size);
+		hmac_update(&ctx, &be_i, 4);
+		hmac_final(&ctx, work_hmac);
 		memcpy(xor_hmac, work_hmac, HASH_SHA1);
 
 		for (size_t k = 1; k < 4096; k++) {
-			memcpy(temp_hmac, work_hmac, HASH_SHA1);
-			hmac(pass, pass_size, temp_hmac, HASH_SHA1,
-			    work_hmac, HASH_SHA1);
+			ctx = keyed;
+			hmac_update(&ctx, work_hmac, HASH_SHA1);
+			hmac_final(&ctx, work_hmac);
 
 			for (size_t t = 0; t < HASH_SHA1; t++)
 				xor_hmac[t] ^= work_hmac[t];
@@ -34,8 +34,12 @@
 #include <stdint.h>
 
 #define AES_CIPHER_LENGTH  16
+#define AES_KEY_LENGTH  16
 #define PBKDF2_KEY_LENGTH  32
 
+/** Number of 32-bit words in an expanded AES-128 key. */
+#define AES_KEY_WORDS  44
+
 /* Left rotation for uint32_t. */
 #define rotl_uint32(val, shift) \
 	(((val) << shift) | ((val) >> (32 - shift)))
@@ -47,13 +51,84 @@
 /** Hash function selector and also result hash length indicator. */
 typedef enum {
 	HASH_MD5 =  16,
-	HASH_SHA1 = 20
+	HASH_SHA1 = 20,
+	HASH_SHA256 = 32
 } hash_func_t;
 
+/** Longest hash result. */
+#define HASH_MAX_LENGTH  32
+
+/** Block size of all supported hash functions. */
+#define HASH_BLOCK_LENGTH  64
+
+/** Process whole blocks, updating the hash state. */
+typedef void (*hash_blocks_t)(uint32_t *, const uint8_t *, size_t);
+
+/** Incremental hash computation. */
+typedef struct {
+	/** Hash function */
+	hash_func_t func;
+	/** Block function */
+	hash_blocks_t blocks;
+	/** Intermediate hash value */
+	uint32_t h[8];
+	/** Number of bytes hashed so far */
+	uint64_t length;
+	/** Incomplete block */
+	uint8_t buf[HASH_BLOCK_LENGTH];
+	/** Number of bytes in @c buf */
+	size_t buf_len;
+} hash_ctx_t;
+
+/** Incremental HMAC computation. */
+typedef struct {
+	/** Hash of inner padded key followed by message */
+	hash_ctx_t inner;
+	/** Hash of outer padded key */
+	hash_ctx_t outer;
+} hmac_ctx_t;
+
+/** Expanded AES-128 key. */
+typedef struct {
+	/** Encryption round keys */
+	uint32_t enc[AES_KEY_WORDS];
+	/** Round keys of the equivalent inverse cipher */
+	uint32_t dec[AES_KEY_WORDS];
+	/** Encryption round keys in byte order for AES instructions */
+	uint8_t enc_bytes[4 * AES_KEY_WORDS] __attribute__((aligned(16)));
+	/** Decryption round keys in byte order for AES instructions */
+	uint8_t dec_bytes[4 * AES_KEY_WORDS] __attribute__((aligned(16)));
+} aes_ctx_t;
+
 extern errno_t rc4(uint8_t *, size_t, uint8_t *, size_t, size_t, uint8_t *);
+extern void aes_init(aes_ctx_t *, const uint8_t *);
+extern const char *aes_impl_name(void);
+extern void aes_encrypt_blocks(const aes_ctx_t *, const uint8_t *, uint8_t *,
+    size_t);
+extern void aes_decrypt_blocks(const aes_ctx_t *, const uint8_t *, uint8_t *,
+    size_t);
+extern void aes_ctr(const aes_ctx_t *, uint8_t *, const uint8_t *, uint8_t *,
+    size_t);
+extern errno_t aes_cbc_encrypt(const aes_ctx_t *, uint8_t *, const uint8_t *,
+    uint8_t *, size_t);
+extern errno_t aes_cbc_decrypt(const aes_ctx_t *, uint8_t *, const uint8_t *,
+    uint8_t *, size_t);
+extern errno_t aes_ccm_encrypt(const aes_ctx_t *, const uint8_t *, size_t,
+    const uint8_t *, size_t, const uint8_t *, uint8_t *, size_t, uint8_t *,
+    size_t);
+extern errno_t aes_ccm_decrypt(const aes_ctx_t *, const uint8_t *, size_t,
+    const uint8_t *, size_t, const uint8_t *, uint8_t *, size_t,
+    const uint8_t *, size_t);
 extern errno_t aes_encrypt(uint8_t *, uint8_t *, uint8_t *);
 extern errno_t aes_decrypt(uint8_t *, uint8_t *, uint8_t *);
+extern errno_t hash_init(hash_ctx_t *, hash_func_t);
+extern void hash_update(hash_ctx_t *, const void *, size_t);
+extern void hash_final(hash_ctx_t *, uint8_t *);
+extern const char *hash_impl_name(hash_func_t);
 extern errno_t create_hash(uint8_t *, size_t, uint8_t *, hash_func_t);
+extern errno_t hmac_init(hmac_ctx_t *, const uint8_t *, size_t, hash_func_t);
+extern void hmac_update(hmac_ctx_t *, const void *, size_t);
+extern void hmac_final(hmac_ctx_t *, uint8_t *);
 extern errno_t hmac(uint8_t *, size_t, uint8_t *, size_t, uint8_t *, hash_func_t);
 extern errno_t pbkdf2(uint8_t *, size_t, uint8_t *, size_t, uint8_t *);
 
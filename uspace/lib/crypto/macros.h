@@ -0,0 +1,10 @@
+#ifndef SHIM_MACROS_H
+#define SHIM_MACROS_H
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define ALIGN_UP(s,a) (((s)+((a)-1)) & ~((a)-1))
+#define ALIGN_DOWN(s,a) ((s) & ~((a)-1))
+#define IS_ALIGNED(s,a) (((s) & ((a)-1))==0)
+#define KiB2SIZE(x) ((size_t)(x) << 10)
+#define abs(x) ((x) < 0 ? -(x) : (x))
+#endif
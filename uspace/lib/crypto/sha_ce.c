@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha_ce.c
+ *
+ * SHA-1 and SHA-256 block functions using the ARMv8 Cryptography
+ * Extension.
+ *
+ * The SHA-1 and SHA-256 instructions are optional independently of each
+ * other, the kernel reports their presence in the "cpu.sha1" and
+ * "cpu.sha2" sysinfo items.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <mem.h>
+#include <sysinfo.h>
+#include "sha_impl.h"
+
+typedef uint32_t sha_vec_t __attribute__((vector_size(16)));
+
+/** SHA-1 round constants, one per group of twenty rounds. */
+static const uint32_t sha1_k[] = {
+	0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6
+};
+
+static bool sha_ce_supported(hash_func_t hash_sel)
+{
+	const char *item;
+	sysarg_t val;
+
+	switch (hash_sel) {
+	case HASH_SHA1:
+		item = "cpu.sha1";
+		break;
+	case HASH_SHA256:
+		item = "cpu.sha2";
+		break;
+	default:
+		return false;
+	}
+
+	if (sysinfo_get_value(item, &val) != EOK)
+		return false;
+
+	return val != 0;
+}
+
+/** Load four big-endian message words. */
+static inline sha_vec_t sha_ce_load(const uint8_t *data)
+{
+	sha_vec_t vec;
+
+	memcpy(&vec, data, sizeof(vec));
+	asm ("rev32 %0.16b, %0.16b\n" : "+w" (vec));
+	return vec;
+}
+
+__attribute__((target("+crypto")))
+static void sha_ce_sha1(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	sha_vec_t abcd, abcd_save, tmp;
+	sha_vec_t msg[4];
+	uint32_t e, e_next, e_save;
+
+	memcpy(&abcd, h, sizeof(abcd));
+	e = h[4];
+
+	while (blocks-- > 0) {
+		abcd_save = abcd;
+		e_save = e;
+
+		/*
+		 * Each step performs four rounds. Message words for step
+		 * j + 4 are computed from those of steps j to j + 3.
+		 */
+		for (size_t j = 0; j < 20; j++) {
+			sha_vec_t *cur = &msg[j % 4];
+
+			if (j < 4)
+				*cur = sha_ce_load(data + 16 * j);
+
+			tmp = *cur + sha1_k[j / 5];
+
+			/* E after four rounds is A rotated by 30 bits */
+			asm ("sha1h %s0, %s1\n" : "=w" (e_next) : "w" (abcd[0]));
+
+			switch (j / 5) {
+			case 0:
+				asm ("sha1c %q0, %s1, %2.4s\n"
+				    : "+w" (abcd) : "w" (e), "w" (tmp));
+				break;
+			case 2:
+				asm ("sha1m %q0, %s1, %2.4s\n"
+				    : "+w" (abcd) : "w" (e), "w" (tmp));
+				break;
+			default:
+				asm ("sha1p %q0, %s1, %2.4s\n"
+				    : "+w" (abcd) : "w" (e), "w" (tmp));
+				break;
+			}
+
+			e = e_next;
+
+			if (j < 16) {
+				asm ("sha1su0 %0.4s, %1.4s, %2.4s\n"
+				    : "+w" (*cur)
+				    : "w" (msg[(j + 1) % 4]), "w" (msg[(j + 2) % 4]));
+				asm ("sha1su1 %0.4s, %1.4s\n"
+				    : "+w" (*cur) : "w" (msg[(j + 3) % 4]));
+			}
+		}
+
+		abcd += abcd_save;
+		e += e_save;
+
+		data += HASH_BLOCK_LENGTH;
+	}
+
+	memcpy(h, &abcd, sizeof(abcd));
+	h[4] = e;
+}
+
+__attribute__((target("+crypto")))
+static void sha_ce_sha256(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	sha_vec_t abcd, efgh, abcd_save, efgh_save, abcd_prev, tmp;
+	sha_vec_t msg[4];
+
+	memcpy(&abcd, h, sizeof(abcd));
+	memcpy(&efgh, h + 4, sizeof(efgh));
+
+	while (blocks-- > 0) {
+		abcd_save = abcd;
+		efgh_save = efgh;
+
+		/*
+		 * Each step performs four rounds. Message words for step
+		 * j + 4 are computed from those of steps j to j + 3.
+		 */
+		for (size_t j = 0; j < 16; j++) {
+			sha_vec_t *cur = &msg[j % 4];
+
+			if (j < 4)
+				*cur = sha_ce_load(data + 16 * j);
+
+			memcpy(&tmp, &sha256_k[4 * j], sizeof(tmp));
+			tmp += *cur;
+
+			abcd_prev = abcd;
+			asm ("sha256h %q0, %q1, %2.4s\n"
+			    : "+w" (abcd) : "w" (efgh), "w" (tmp));
+			asm ("sha256h2 %q0, %q1, %2.4s\n"
+			    : "+w" (efgh) : "w" (abcd_prev), "w" (tmp));
+
+			if (j < 12) {
+				asm ("sha256su0 %0.4s, %1.4s\n"
+				    : "+w" (*cur) : "w" (msg[(j + 1) % 4]));
+				asm ("sha256su1 %0.4s, %1.4s, %2.4s\n"
+				    : "+w" (*cur)
+				    : "w" (msg[(j + 2) % 4]), "w" (msg[(j + 3) % 4]));
+			}
+		}
+
+		abcd += abcd_save;
+		efgh += efgh_save;
+
+		data += HASH_BLOCK_LENGTH;
+	}
+
+	memcpy(h, &abcd, sizeof(abcd));
+	memcpy(h + 4, &efgh, sizeof(efgh));
+}
+
+const sha_impl_t sha_hw_impl = {
+	.name = "armv8-ce",
+	.supported = sha_ce_supported,
+	.sha1_blocks = sha_ce_sha1,
+	.sha256_blocks = sha_ce_sha256
+};
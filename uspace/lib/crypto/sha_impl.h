@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha_impl.h
+ *
+ * Interface between the hash functions and their hardware accelerated
+ * block functions.
+ */
+
+#ifndef LIBCRYPTO_SHA_IMPL_H
+#define LIBCRYPTO_SHA_IMPL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto.h"
+
+/** Hardware SHA implementation. */
+typedef struct {
+	/** Implementation name */
+	const char *name;
+	/** Determine whether the processor supports the hash function */
+	bool (*supported)(hash_func_t);
+	/** SHA-1 block function */
+	hash_blocks_t sha1_blocks;
+	/** SHA-256 block function */
+	hash_blocks_t sha256_blocks;
+} sha_impl_t;
+
+/** SHA-256 round constants. */
+extern const uint32_t sha256_k[64];
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+/** Hardware implementation is available for this architecture */
+#define SHA_IMPL_HW
+
+/** Implementation using SHA-NI (amd64) or ARMv8 Crypto Extension (arm64) */
+extern const sha_impl_t sha_hw_impl;
+
+#endif
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha_ni.c
+ *
+ * SHA-1 and SHA-256 block functions using the SHA-NI instructions
+ * of amd64 processors.
+ *
+ * Besides the SHA extension, the code relies on SSSE3 and SSE4.1,
+ * which all processors implementing it have. Only SSE registers are
+ * used, whose state the kernel preserves across context switches.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <mem.h>
+#include "sha_impl.h"
+
+#define CPUID_LEVEL  0
+#define CPUID_EXT_FEATURES  7
+
+/** CPUID.(EAX=7,ECX=0):EBX SHA extensions bit. */
+#define CPUID_EBX_SHA  (1 << 29)
+
+typedef uint32_t sha_vec_t __attribute__((vector_size(16)));
+
+/* Wrappers for instructions taking an immediate operand */
+#define PSHUFD(dst, src, imm) \
+	asm ("pshufd $" #imm ", %1, %0\n" : "=x" (dst) : "x" (src))
+#define PALIGNR(dst, src, imm) \
+	asm ("palignr $" #imm ", %1, %0\n" : "+x" (dst) : "x" (src))
+#define PBLENDW(dst, src, imm) \
+	asm ("pblendw $" #imm ", %1, %0\n" : "+x" (dst) : "x" (src))
+#define SHA1RNDS4(abcd, e, imm) \
+	asm ("sha1rnds4 $" #imm ", %1, %0\n" : "+x" (abcd) : "x" (e))
+
+/* Wrappers for two-operand instructions, @a dst is also a source */
+#define SHA_OP(insn, dst, src) \
+	asm (insn " %1, %0\n" : "+x" (dst) : "x" (src))
+
+static inline void sha_ni_cpuid(uint32_t leaf, uint32_t *regs)
+{
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	    : "a" (leaf), "c" (0)
+	);
+}
+
+static bool sha_ni_supported(hash_func_t hash_sel)
+{
+	uint32_t regs[4];
+
+	sha_ni_cpuid(CPUID_LEVEL, regs);
+	if (regs[0] < CPUID_EXT_FEATURES)
+		return false;
+
+	sha_ni_cpuid(CPUID_EXT_FEATURES, regs);
+	return (regs[1] & CPUID_EBX_SHA) != 0;
+}
+
+/** Load 16 bytes of message, converting them with @a mask. */
+static inline sha_vec_t sha_ni_load(const uint8_t *data, sha_vec_t mask)
+{
+	sha_vec_t vec;
+
+	memcpy(&vec, data, sizeof(vec));
+	SHA_OP("pshufb", vec, mask);
+	return vec;
+}
+
+static void sha_ni_sha1(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	/* Reverse all bytes, putting the first word in the top lane */
+	const sha_vec_t mask = {
+		0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203
+	};
+	sha_vec_t abcd, abcd_save, e_save, tmp;
+	sha_vec_t e[2];
+	sha_vec_t msg[4];
+
+	memcpy(&tmp, h, sizeof(tmp));
+	PSHUFD(abcd, tmp, 0x1b);
+	e[0] = (sha_vec_t) { 0, 0, 0, h[4] };
+
+	while (blocks-- > 0) {
+		abcd_save = abcd;
+		e_save = e[0];
+
+		/*
+		 * Each step performs four rounds. Message words for step
+		 * j + 1 are completed from those of steps j - 3 to j.
+		 */
+		for (size_t j = 0; j < 20; j++) {
+			sha_vec_t *cur = &msg[j % 4];
+
+			if (j < 4)
+				*cur = sha_ni_load(data + 16 * j, mask);
+
+			if (j == 0)
+				e[0] += *cur;
+			else
+				SHA_OP("sha1nexte", e[j % 2], *cur);
+
+			e[(j + 1) % 2] = abcd;
+
+			switch (j / 5) {
+			case 0:
+				SHA1RNDS4(abcd, e[j % 2], 0);
+				break;
+			case 1:
+				SHA1RNDS4(abcd, e[j % 2], 1);
+				break;
+			case 2:
+				SHA1RNDS4(abcd, e[j % 2], 2);
+				break;
+			default:
+				SHA1RNDS4(abcd, e[j % 2], 3);
+				break;
+			}
+
+			if (j >= 1 && j < 17)
+				SHA_OP("sha1msg1", msg[(j + 3) % 4], *cur);
+			if (j >= 2 && j < 18)
+				msg[(j + 2) % 4] ^= *cur;
+			if (j >= 3 && j < 19)
+				SHA_OP("sha1msg2", msg[(j + 1) % 4], *cur);
+		}
+
+		/* The last step left E in e[0] */
+		SHA_OP("sha1nexte", e[0], e_save);
+		abcd += abcd_save;
+
+		data += HASH_BLOCK_LENGTH;
+	}
+
+	PSHUFD(tmp, abcd, 0x1b);
+	memcpy(h, &tmp, sizeof(tmp));
+	h[4] = e[0][3];
+}
+
+static void sha_ni_sha256(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	/* Reverse bytes of each word */
+	const sha_vec_t mask = {
+		0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f
+	};
+	sha_vec_t abef, cdgh, abef_save, cdgh_save, tmp, k;
+	sha_vec_t msg[4];
+
+	/* Rearrange state into the ABEF/CDGH layout of the instructions */
+	memcpy(&tmp, h, sizeof(tmp));
+	PSHUFD(tmp, tmp, 0xb1);
+	memcpy(&cdgh, h + 4, sizeof(cdgh));
+	PSHUFD(cdgh, cdgh, 0x1b);
+	abef = tmp;
+	PALIGNR(abef, cdgh, 8);
+	PBLENDW(cdgh, tmp, 0xf0);
+
+	while (blocks-- > 0) {
+		abef_save = abef;
+		cdgh_save = cdgh;
+
+		/*
+		 * Each step performs four rounds. Message words for step
+		 * j + 1 are completed from those of steps j - 3 to j.
+		 */
+		for (size_t j = 0; j < 16; j++) {
+			sha_vec_t *cur = &msg[j % 4];
+
+			if (j < 4)
+				*cur = sha_ni_load(data + 16 * j, mask);
+
+			memcpy(&k, &sha256_k[4 * j], sizeof(k));
+			k += *cur;
+			asm ("sha256rnds2 %2, %1, %0\n"
+			    : "+x" (cdgh) : "x" (abef), "Yz" (k));
+			PSHUFD(k, k, 0x0e);
+			asm ("sha256rnds2 %2, %1, %0\n"
+			    : "+x" (abef) : "x" (cdgh), "Yz" (k));
+
+			if (j >= 3 && j < 15) {
+				tmp = *cur;
+				PALIGNR(tmp, msg[(j + 3) % 4], 4);
+				msg[(j + 1) % 4] += tmp;
+				SHA_OP("sha256msg2", msg[(j + 1) % 4], *cur);
+			}
+			if (j >= 1 && j < 13)
+				SHA_OP("sha256msg1", msg[(j + 3) % 4], *cur);
+		}
+
+		abef += abef_save;
+		cdgh += cdgh_save;
+
+		data += HASH_BLOCK_LENGTH;
+	}
+
+	PSHUFD(tmp, abef, 0x1b);
+	PSHUFD(cdgh, cdgh, 0xb1);
+	abef = tmp;
+	PBLENDW(tmp, cdgh, 0xf0);
+	PALIGNR(cdgh, abef, 8);
+
+	memcpy(h, &tmp, sizeof(tmp));
+	memcpy(h + 4, &cdgh, sizeof(cdgh));
+}
+
+const sha_impl_t sha_hw_impl = {
+	.name = "sha-ni",
+	.supported = sha_ni_supported,
+	.sha1_blocks = sha_ni_sha1,
+	.sha256_blocks = sha_ni_sha256
+};
@@ -38,6 +38,7 @@
 #include <ddev/info.h>
 #include <errno.h>
 #include <gfx/context.h>
+#include <io/pixel.h>
 #include <stdbool.h>
 #include "types/ddev.h"
 #include "types/ddev/info.h"
@@ -46,6 +47,9 @@ extern errno_t ddev_open(const char *, ddev_t **);
 extern void ddev_close(ddev_t *);
 extern errno_t ddev_get_gc(ddev_t *, gfx_context_t **);
 extern errno_t ddev_get_info(ddev_t *, ddev_info_t *);
+extern errno_t ddev_cursor_set_image(ddev_t *, gfx_rect_t *, const pixel_t *);
+extern errno_t ddev_cursor_move(ddev_t *, gfx_coord2_t *);
+extern errno_t ddev_cursor_set_visible(ddev_t *, bool);
 
 #endif
 
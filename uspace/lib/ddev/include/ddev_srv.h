@@ -38,6 +38,9 @@
 #include <async.h>
 #include <errno.h>
 #include <gfx/context.h>
+#include <gfx/coord.h>
+#include <io/pixel.h>
+#include <stdbool.h>
 #include "types/ddev/info.h"
 
 typedef struct ddev_ops ddev_ops_t;
@@ -52,6 +55,9 @@ typedef struct {
 struct ddev_ops {
 	errno_t (*get_gc)(void *, sysarg_t *, sysarg_t *);
 	errno_t (*get_info)(void *, ddev_info_t *);
+	errno_t (*cursor_set_image)(void *, gfx_rect_t *, pixel_t *);
+	errno_t (*cursor_move)(void *, gfx_coord2_t *);
+	errno_t (*cursor_set_visible)(void *, bool);
 };
 
 extern void ddev_conn(ipc_call_t *, ddev_srv_t *);
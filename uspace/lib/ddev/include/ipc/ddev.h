@@ -39,7 +39,10 @@
 
 typedef enum {
 	DDEV_GET_GC = IPC_FIRST_USER_METHOD,
-	DDEV_GET_INFO
+	DDEV_GET_INFO,
+	DDEV_CURSOR_SET_IMAGE,
+	DDEV_CURSOR_MOVE,
+	DDEV_CURSOR_SET_VISIBLE
 } ddev_request_t;
 
 #endif
@@ -37,10 +37,22 @@
 
 #include <gfx/coord.h>
 
+/** Display device capabilities */
+typedef enum {
+	/** No optional capabilities */
+	ddc_none = 0,
+	/** Hardware cursor plane */
+	ddc_cursor = 0x1
+} ddev_caps_t;
+
 /** Display device information */
 typedef struct {
 	/** Bounding rectangle */
 	gfx_rect_t rect;
+	/** Capabilities */
+	ddev_caps_t caps;
+	/** Maximum cursor image size (if @c ddc_cursor is supported) */
+	gfx_coord2_t cursor_max;
 } ddev_info_t;
 
 #endif
@@ -29,6 +29,7 @@
 #include <async.h>
 #include <ddev.h>
 #include <errno.h>
+#include <gfx/coord.h>
 #include <ipc/ddev.h>
 #include <ipc/services.h>
 #include <ipcgfx/client.h>
@@ -143,5 +144,79 @@ errno_t ddev_get_info(ddev_t *ddev, ddev_info_t *info)
 	return EOK;
 }
 
+/** Set hardware cursor image.
+ *
+ * The image is given in ARGB format with alpha 0 meaning transparent
+ * and 255 meaning opaque. @a rect is relative to the cursor hot spot,
+ * i.e. to the position set by ddev_cursor_move().
+ *
+ * @param ddev Display device
+ * @param rect Rectangle covered by the image, relative to the hot spot
+ * @param pixels Image pixels (row by row, without padding)
+ * @return EOK on success, ENOTSUP if the device has no hardware cursor
+ *         or an error code
+ */
+errno_t ddev_cursor_set_image(ddev_t *ddev, gfx_rect_t *rect,
+    const pixel_t *pixels)
+{
+	async_exch_t *exch;
+	gfx_coord2_t dims;
+	errno_t retval;
+	ipc_call_t answer;
+
+	gfx_rect_dims(rect, &dims);
+
+	exch = async_exchange_begin(ddev->sess);
+	aid_t req = async_send_4(exch, DDEV_CURSOR_SET_IMAGE, rect->p0.x,
+	    rect->p0.y, rect->p1.x, rect->p1.y, &answer);
+
+	errno_t rc = async_data_write_start(exch, pixels,
+	    (size_t) dims.x * dims.y * sizeof(pixel_t));
+	async_exchange_end(exch);
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Move hardware cursor.
+ *
+ * @param ddev Display device
+ * @param pos New position of the cursor hot spot
+ * @return EOK on success or an error code
+ */
+errno_t ddev_cursor_move(ddev_t *ddev, gfx_coord2_t *pos)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	exch = async_exchange_begin(ddev->sess);
+	rc = async_req_2_0(exch, DDEV_CURSOR_MOVE, pos->x, pos->y);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+/** Show or hide hardware cursor.
+ *
+ * @param ddev Display device
+ * @param visible @c true to show the cursor, @c false to hide it
+ * @return EOK on success or an error code
+ */
+errno_t ddev_cursor_set_visible(ddev_t *ddev, bool visible)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	exch = async_exchange_begin(ddev->sess);
+	rc = async_req_1_0(exch, DDEV_CURSOR_SET_VISIBLE, visible);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 /** @}
  */
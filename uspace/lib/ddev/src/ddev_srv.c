@@ -36,6 +36,7 @@
 
 #include <ddev_srv.h>
 #include <errno.h>
+#include <gfx/coord.h>
 #include <io/log.h>
 #include <ipc/ddev.h>
 #include <mem.h>
@@ -107,6 +108,79 @@ static void ddev_get_info_srv(ddev_srv_t *srv, ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+/** Set hardware cursor image */
+static void ddev_cursor_set_image_srv(ddev_srv_t *srv, ipc_call_t *icall)
+{
+	gfx_rect_t rect;
+	gfx_coord2_t dims;
+	pixel_t *pixels;
+	ipc_call_t call;
+	size_t size;
+	errno_t rc;
+
+	rect.p0.x = ipc_get_arg1(icall);
+	rect.p0.y = ipc_get_arg2(icall);
+	rect.p1.x = ipc_get_arg3(icall);
+	rect.p1.y = ipc_get_arg4(icall);
+
+	gfx_rect_dims(&rect, &dims);
+	size = (size_t) dims.x * dims.y * sizeof(pixel_t);
+
+	if (gfx_rect_is_empty(&rect) || srv->ops->cursor_set_image == NULL) {
+		rc = gfx_rect_is_empty(&rect) ? EINVAL : ENOTSUP;
+		(void) async_data_write_receive(&call, NULL);
+		async_answer_0(&call, rc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	rc = async_data_write_accept((void **) &pixels, false, size, size,
+	    0, NULL);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	rc = srv->ops->cursor_set_image(srv->arg, &rect, pixels);
+	free(pixels);
+	async_answer_0(icall, rc);
+}
+
+/** Move hardware cursor */
+static void ddev_cursor_move_srv(ddev_srv_t *srv, ipc_call_t *icall)
+{
+	gfx_coord2_t pos;
+	errno_t rc;
+
+	pos.x = ipc_get_arg1(icall);
+	pos.y = ipc_get_arg2(icall);
+
+	if (srv->ops->cursor_move == NULL) {
+		async_answer_0(icall, ENOTSUP);
+		return;
+	}
+
+	rc = srv->ops->cursor_move(srv->arg, &pos);
+	async_answer_0(icall, rc);
+}
+
+/** Show or hide hardware cursor */
+static void ddev_cursor_set_visible_srv(ddev_srv_t *srv, ipc_call_t *icall)
+{
+	bool visible;
+	errno_t rc;
+
+	visible = ipc_get_arg1(icall) != 0;
+
+	if (srv->ops->cursor_set_visible == NULL) {
+		async_answer_0(icall, ENOTSUP);
+		return;
+	}
+
+	rc = srv->ops->cursor_set_visible(srv->arg, visible);
+	async_answer_0(icall, rc);
+}
+
 void ddev_conn(ipc_call_t *icall, ddev_srv_t *srv)
 {
 	/* Accept the connection */
@@ -131,6 +205,15 @@ void ddev_conn(ipc_call_t *icall, ddev_srv_t *srv)
 		case DDEV_GET_INFO:
 			ddev_get_info_srv(srv, &call);
 			break;
+		case DDEV_CURSOR_SET_IMAGE:
+			ddev_cursor_set_image_srv(srv, &call);
+			break;
+		case DDEV_CURSOR_MOVE:
+			ddev_cursor_move_srv(srv, &call);
+			break;
+		case DDEV_CURSOR_SET_VISIBLE:
+			ddev_cursor_set_visible_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
@@ -49,11 +49,17 @@ static void test_ddev_conn(ipc_call_t *, void *);
 
 static errno_t test_get_gc(void *, sysarg_t *, sysarg_t *);
 static errno_t test_get_info(void *, ddev_info_t *);
+static errno_t test_cursor_set_image(void *, gfx_rect_t *, pixel_t *);
+static errno_t test_cursor_move(void *, gfx_coord2_t *);
+static errno_t test_cursor_set_visible(void *, bool);
 static errno_t test_gc_set_color(void *, gfx_color_t *);
 
 static ddev_ops_t test_ddev_ops = {
 	.get_gc = test_get_gc,
-	.get_info = test_get_info
+	.get_info = test_get_info,
+	.cursor_set_image = test_cursor_set_image,
+	.cursor_move = test_cursor_move,
+	.cursor_set_visible = test_cursor_set_visible
 };
 
 static gfx_context_ops_t test_gc_ops = {
@@ -68,6 +74,13 @@ typedef struct {
 	bool set_color_called;
 	ddev_srv_t *srv;
 	ddev_info_t info;
+	bool cursor_set_image_called;
+	gfx_rect_t cursor_rect;
+	pixel_t cursor_pixel[2];
+	bool cursor_move_called;
+	gfx_coord2_t cursor_pos;
+	bool cursor_set_visible_called;
+	bool cursor_visible;
 } test_response_t;
 
 /** ddev_open(), ddev_close() work for valid display device service */
@@ -247,6 +260,202 @@ PCUT_TEST(dev_get_info_success)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 }
 
+/** ddev_cursor_set_image() with server returning failure */
+PCUT_TEST(cursor_set_image_failure)
+{
+	errno_t rc;
+	service_id_t sid;
+	ddev_t *ddev = NULL;
+	test_response_t resp;
+	gfx_rect_t rect;
+	pixel_t pixels[2];
+
+	async_set_fallback_port_handler(test_ddev_conn, &resp);
+
+	// FIXME This causes this test to be non-reentrant!
+	rc = loc_server_register(test_ddev_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_ddev_svc, &sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ddev_open(test_ddev_svc, &ddev);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(ddev);
+
+	rect.p0.x = -1;
+	rect.p0.y = 0;
+	rect.p1.x = 1;
+	rect.p1.y = 1;
+	pixels[0] = PIXEL(255, 1, 2, 3);
+	pixels[1] = PIXEL(0, 4, 5, 6);
+
+	resp.rc = ENOTSUP;
+	resp.cursor_set_image_called = false;
+	rc = ddev_cursor_set_image(ddev, &rect, pixels);
+	PCUT_ASSERT_ERRNO_VAL(resp.rc, rc);
+	PCUT_ASSERT_TRUE(resp.cursor_set_image_called);
+
+	ddev_close(ddev);
+	rc = loc_service_unregister(sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+/** ddev_cursor_set_image() with server returning success */
+PCUT_TEST(cursor_set_image_success)
+{
+	errno_t rc;
+	service_id_t sid;
+	ddev_t *ddev = NULL;
+	test_response_t resp;
+	gfx_rect_t rect;
+	pixel_t pixels[2];
+
+	async_set_fallback_port_handler(test_ddev_conn, &resp);
+
+	// FIXME This causes this test to be non-reentrant!
+	rc = loc_server_register(test_ddev_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_ddev_svc, &sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ddev_open(test_ddev_svc, &ddev);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(ddev);
+
+	rect.p0.x = -1;
+	rect.p0.y = 0;
+	rect.p1.x = 1;
+	rect.p1.y = 1;
+	pixels[0] = PIXEL(255, 1, 2, 3);
+	pixels[1] = PIXEL(0, 4, 5, 6);
+
+	resp.rc = EOK;
+	resp.cursor_set_image_called = false;
+	rc = ddev_cursor_set_image(ddev, &rect, pixels);
+	PCUT_ASSERT_ERRNO_VAL(resp.rc, rc);
+	PCUT_ASSERT_TRUE(resp.cursor_set_image_called);
+	PCUT_ASSERT_INT_EQUALS(rect.p0.x, resp.cursor_rect.p0.x);
+	PCUT_ASSERT_INT_EQUALS(rect.p0.y, resp.cursor_rect.p0.y);
+	PCUT_ASSERT_INT_EQUALS(rect.p1.x, resp.cursor_rect.p1.x);
+	PCUT_ASSERT_INT_EQUALS(rect.p1.y, resp.cursor_rect.p1.y);
+	PCUT_ASSERT_INT_EQUALS(pixels[0], resp.cursor_pixel[0]);
+	PCUT_ASSERT_INT_EQUALS(pixels[1], resp.cursor_pixel[1]);
+
+	ddev_close(ddev);
+	rc = loc_service_unregister(sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+/** ddev_cursor_move() with server returning failure */
+PCUT_TEST(cursor_move_failure)
+{
+	errno_t rc;
+	service_id_t sid;
+	ddev_t *ddev = NULL;
+	test_response_t resp;
+	gfx_coord2_t pos;
+
+	async_set_fallback_port_handler(test_ddev_conn, &resp);
+
+	// FIXME This causes this test to be non-reentrant!
+	rc = loc_server_register(test_ddev_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_ddev_svc, &sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ddev_open(test_ddev_svc, &ddev);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(ddev);
+
+	pos.x = 1;
+	pos.y = 2;
+
+	resp.rc = ENOTSUP;
+	resp.cursor_move_called = false;
+	rc = ddev_cursor_move(ddev, &pos);
+	PCUT_ASSERT_ERRNO_VAL(resp.rc, rc);
+	PCUT_ASSERT_TRUE(resp.cursor_move_called);
+
+	ddev_close(ddev);
+	rc = loc_service_unregister(sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+/** ddev_cursor_move() with server returning success */
+PCUT_TEST(cursor_move_success)
+{
+	errno_t rc;
+	service_id_t sid;
+	ddev_t *ddev = NULL;
+	test_response_t resp;
+	gfx_coord2_t pos;
+
+	async_set_fallback_port_handler(test_ddev_conn, &resp);
+
+	// FIXME This causes this test to be non-reentrant!
+	rc = loc_server_register(test_ddev_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_ddev_svc, &sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ddev_open(test_ddev_svc, &ddev);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(ddev);
+
+	pos.x = 1;
+	pos.y = 2;
+
+	resp.rc = EOK;
+	resp.cursor_move_called = false;
+	rc = ddev_cursor_move(ddev, &pos);
+	PCUT_ASSERT_ERRNO_VAL(resp.rc, rc);
+	PCUT_ASSERT_TRUE(resp.cursor_move_called);
+	PCUT_ASSERT_INT_EQUALS(pos.x, resp.cursor_pos.x);
+	PCUT_ASSERT_INT_EQUALS(pos.y, resp.cursor_pos.y);
+
+	ddev_close(ddev);
+	rc = loc_service_unregister(sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+/** ddev_cursor_set_visible() with server returning success */
+PCUT_TEST(cursor_set_visible_success)
+{
+	errno_t rc;
+	service_id_t sid;
+	ddev_t *ddev = NULL;
+	test_response_t resp;
+
+	async_set_fallback_port_handler(test_ddev_conn, &resp);
+
+	// FIXME This causes this test to be non-reentrant!
+	rc = loc_server_register(test_ddev_server);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = loc_service_register(test_ddev_svc, &sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ddev_open(test_ddev_svc, &ddev);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(ddev);
+
+	resp.rc = EOK;
+	resp.cursor_set_visible_called = false;
+	resp.cursor_visible = false;
+	rc = ddev_cursor_set_visible(ddev, true);
+	PCUT_ASSERT_ERRNO_VAL(resp.rc, rc);
+	PCUT_ASSERT_TRUE(resp.cursor_set_visible_called);
+	PCUT_ASSERT_TRUE(resp.cursor_visible);
+
+	ddev_close(ddev);
+	rc = loc_service_unregister(sid);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
 /** Test display device connection.
  *
  * This is very similar to connection handler in the display server.
@@ -308,6 +517,36 @@ static errno_t test_get_info(void *arg, ddev_info_t *info)
 	return EOK;
 }
 
+static errno_t test_cursor_set_image(void *arg, gfx_rect_t *rect,
+    pixel_t *pixels)
+{
+	test_response_t *resp = (test_response_t *) arg;
+
+	resp->cursor_set_image_called = true;
+	resp->cursor_rect = *rect;
+	resp->cursor_pixel[0] = pixels[0];
+	resp->cursor_pixel[1] = pixels[1];
+	return resp->rc;
+}
+
+static errno_t test_cursor_move(void *arg, gfx_coord2_t *pos)
+{
+	test_response_t *resp = (test_response_t *) arg;
+
+	resp->cursor_move_called = true;
+	resp->cursor_pos = *pos;
+	return resp->rc;
+}
+
+static errno_t test_cursor_set_visible(void *arg, bool visible)
+{
+	test_response_t *resp = (test_response_t *) arg;
+
+	resp->cursor_set_visible_called = true;
+	resp->cursor_visible = visible;
+	return resp->rc;
+}
+
 static errno_t test_gc_set_color(void *arg, gfx_color_t *color)
 {
 	test_response_t *resp = (test_response_t *) arg;
@@ -36,12 +36,23 @@
 #define LIBDEVICE_BD_H
 
 #include <async.h>
+#include <ipc/bd.h>
 #include <offset.h>
 
 typedef struct {
 	async_sess_t *sess;
+	/** Buffer shared with the server for queued requests or @c NULL */
+	void *qbuf;
+	/** Size of the shared buffer */
+	size_t qsize;
 } bd_t;
 
+/** Queued request in flight */
+typedef struct {
+	aid_t aid;
+	ipc_call_t answer;
+} bd_req_t;
+
 extern errno_t bd_open(async_sess_t *, bd_t **);
 extern void bd_close(bd_t *);
 extern errno_t bd_read_blocks(bd_t *, aoff64_t, size_t, void *, size_t);
@@ -50,6 +61,16 @@ extern errno_t bd_write_blocks(bd_t *, aoff64_t, size_t, const void *, size_t);
 extern errno_t bd_sync_cache(bd_t *, aoff64_t, size_t);
 extern errno_t bd_get_block_size(bd_t *, size_t *);
 extern errno_t bd_get_num_blocks(bd_t *, aoff64_t *);
+extern errno_t bd_get_stats(bd_t *, bd_stats_t *);
+extern errno_t bd_map(bd_t *, unsigned int, size_t, void **);
+
+extern errno_t bd_queue_setup(bd_t *, size_t, void **);
+extern errno_t bd_queue_read(bd_t *, aoff64_t, size_t, const bd_seg_t *,
+    size_t, bd_req_t *);
+extern errno_t bd_queue_write(bd_t *, aoff64_t, size_t, const bd_seg_t *,
+    size_t, bd_req_t *);
+extern errno_t bd_req_wait(bd_req_t *);
+extern errno_t bd_req_poll(bd_req_t *, errno_t *);
 
 #endif
 
@@ -38,8 +38,10 @@
 #include <adt/list.h>
 #include <async.h>
 #include <fibril_synch.h>
+#include <ipc/bd.h>
 #include <stdbool.h>
 #include <offset.h>
+#include <time.h>
 
 typedef struct bd_ops bd_ops_t;
 
@@ -47,6 +49,18 @@ typedef struct bd_ops bd_ops_t;
 typedef struct {
 	bd_ops_t *ops;
 	void *sarg;
+	/** Maximum number of requests of a client session processed at once.
+	 *
+	 * With more than one, read and write operations can be called
+	 * concurrently and must be able to cope. The default is one.
+	 */
+	unsigned queue_depth;
+	/** Protects @c stats and @c stats_time */
+	fibril_mutex_t stats_lock;
+	/** I/O statistics of the service */
+	bd_stats_t stats;
+	/** Uptime when the time counters of @c stats were last updated */
+	usec_t stats_time;
 } bd_srvs_t;
 
 /** Server structure (per client session) */
@@ -54,6 +68,16 @@ typedef struct {
 	bd_srvs_t *srvs;
 	async_sess_t *client_sess;
 	void *carg;
+	/** Buffer shared by the client for queued requests or @c NULL */
+	void *qbuf;
+	/** Size of the shared buffer */
+	size_t qsize;
+	/** Protects @c inflight */
+	fibril_mutex_t lock;
+	/** Signalled when @c inflight drops */
+	fibril_condvar_t cv;
+	/** Number of requests being processed */
+	unsigned inflight;
 } bd_srv_t;
 
 struct bd_ops {
@@ -65,6 +89,7 @@ struct bd_ops {
 	errno_t (*write_blocks)(bd_srv_t *, aoff64_t, size_t, const void *, size_t);
 	errno_t (*get_block_size)(bd_srv_t *, size_t *);
 	errno_t (*get_num_blocks)(bd_srv_t *, aoff64_t *);
+	errno_t (*map)(bd_srv_t *, void **, size_t *, unsigned int *);
 };
 
 extern void bd_srvs_init(bd_srvs_t *);
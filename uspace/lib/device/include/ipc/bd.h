@@ -36,6 +36,8 @@
 #define LIBDEVICE_IPC_BD_H
 
 #include <ipc/common.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef enum {
 	BD_GET_BLOCK_SIZE = IPC_FIRST_USER_METHOD,
@@ -43,9 +45,73 @@ typedef enum {
 	BD_READ_BLOCKS,
 	BD_SYNC_CACHE,
 	BD_WRITE_BLOCKS,
-	BD_READ_TOC
+	BD_READ_TOC,
+	BD_QUEUE_SETUP,
+	BD_QUEUE_READ,
+	BD_QUEUE_WRITE,
+	BD_GET_STATS,
+	BD_MAP
 } bd_request_t;
 
+/** Maximum number of buffer segments of a queued request */
+#define BD_QUEUE_SEGS_MAX	16
+
+/** Maximum number of requests the server processes at the same time
+ * per client session
+ */
+#define BD_QUEUE_DEPTH		32
+
+/** Segment of the shared buffer used by a queued request.
+ *
+ * The segments of a request are filled or drained in order with
+ * consecutive blocks. Their sizes must be multiples of the block size.
+ */
+typedef struct {
+	/** Offset of the segment in the shared buffer */
+	size_t offset;
+	/** Size of the segment in bytes */
+	size_t size;
+} bd_seg_t;
+
+/** Number of buckets of the service time histogram.
+ *
+ * Bucket @c i counts requests which took less than 2^(i + 1) microseconds
+ * and were not counted in a lower bucket. The last bucket takes the rest.
+ */
+#define BD_STATS_HIST_BUCKETS	20
+
+/** I/O statistics of a block device service.
+ *
+ * All counters are cumulative since the service was started, clients
+ * compute rates from the differences of two samples.
+ */
+typedef struct {
+	/** Uptime of the sample in microseconds */
+	uint64_t uptime;
+	/** Number of completed read requests */
+	uint64_t reads;
+	/** Number of completed write requests */
+	uint64_t writes;
+	/** Number of bytes read */
+	uint64_t read_bytes;
+	/** Number of bytes written */
+	uint64_t write_bytes;
+	/** Number of failed requests */
+	uint64_t errors;
+	/** Time with at least one request in progress in microseconds */
+	uint64_t busy_usec;
+	/** Integral of the queue depth over time in microseconds */
+	uint64_t queue_usec;
+	/** Sum of the service times of the requests in microseconds */
+	uint64_t service_usec;
+	/** Number of requests in progress */
+	uint32_t inflight;
+	/** Maximum number of requests in progress seen so far */
+	uint32_t max_inflight;
+	/** Service time histogram */
+	uint64_t hist[BD_STATS_HIST_BUCKETS];
+} bd_stats_t;
+
 #endif
 
 /** @}
@@ -325,6 +325,43 @@ typedef struct nic_vlan_mask {
 	uint8_t bitmap[NIC_VLAN_BITMAP_SIZE];
 } nic_vlan_mask_t;
 
+/** NIC verifies TCP/UDP checksums of received frames */
+#define NIC_OFFLOAD_RX_CSUM  0x0001
+/** NIC computes TCP/UDP checksums of transmitted frames */
+#define NIC_OFFLOAD_TX_CSUM  0x0002
+/** NIC splits TCP over IPv4 super-segments into frames (implies TX_CSUM) */
+#define NIC_OFFLOAD_TSO      0x0004
+
+/** Maximum size of a frame handed to the NIC for segmentation */
+#define NIC_TSO_FRAME_MAX  (14 + 65535)
+
+/**
+ * Offload computations requested for a transmitted frame.
+ */
+typedef struct nic_tx_offload {
+	/** NIC_OFFLOAD_TX_CSUM and/or NIC_OFFLOAD_TSO, zero for none */
+	uint32_t flags;
+	/** Offset of the transport header (where checksumming starts) */
+	uint16_t csum_start;
+	/** Offset of the checksum field from @c csum_start */
+	uint16_t csum_offs;
+	/** Maximum segment size (payload bytes per frame) with NIC_OFFLOAD_TSO */
+	uint16_t mss;
+} nic_tx_offload_t;
+
+/** Number of slots in a NIC packet ring */
+#define NIC_RING_SLOTS  256
+/** Size of a NIC packet ring slot, enough for a frame with VLAN tag */
+#define NIC_RING_SLOT_SIZE  2048
+
+/** Direction of a packet ring shared between NIC and client */
+typedef enum {
+	/** Received frames, produced by the NIC */
+	NIC_RING_RX,
+	/** Frames to send, produced by the client */
+	NIC_RING_TX
+} nic_ring_dir_t;
+
 /* WOL virtue identifier */
 typedef unsigned int nic_wv_id_t;
 
@@ -34,6 +34,7 @@
  * @brief Block device client interface
  */
 
+#include <as.h>
 #include <async.h>
 #include <assert.h>
 #include <bd.h>
@@ -79,6 +80,8 @@ error:
 void bd_close(bd_t *bd)
 {
 	/* XXX Synchronize with bd_cb_conn */
+	if (bd->qbuf != NULL)
+		as_area_destroy(bd->qbuf);
 	free(bd);
 }
 
@@ -195,6 +198,205 @@ errno_t bd_get_num_blocks(bd_t *bd, aoff64_t *rnb)
 	return EOK;
 }
 
+/** Get I/O statistics of a block device.
+ *
+ * The statistics cover all clients of the device.
+ *
+ * @param bd	Block device
+ * @param stats	Place to store the statistics
+ *
+ * @return EOK on success or an error code
+ */
+errno_t bd_get_stats(bd_t *bd, bd_stats_t *stats)
+{
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, BD_GET_STATS, &answer);
+	errno_t rc = async_data_read_start(exch, stats, sizeof(bd_stats_t));
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Map the contents of a block device into the address space.
+ *
+ * Only devices backed by memory, such as RAM disks, support this. Writes
+ * to a writable mapping go straight to the device.
+ *
+ * @param bd	Block device
+ * @param flags	Access flags of the mapping (AS_AREA_READ, AS_AREA_WRITE)
+ * @param size	Size of the device rounded up to whole pages
+ * @param rmap	Place to store the address of the mapping
+ *
+ * @return EOK on success, ENOTSUP if the device cannot be mapped or
+ *         another error code
+ */
+errno_t bd_map(bd_t *bd, unsigned int flags, size_t size, void **rmap)
+{
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_1(exch, BD_MAP, flags, &answer);
+	errno_t rc = async_share_in_start_0_0(exch, size, rmap);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Set up the buffer shared with the server for queued requests.
+ *
+ * Queued requests transfer data through this buffer instead of copying it
+ * with each request, and any number of them can be in flight at a time.
+ *
+ * @param bd	Block device
+ * @param size	Size of the buffer in bytes
+ * @param rbuf	Place to store the address of the buffer
+ *
+ * @return EOK on success or an error code
+ */
+errno_t bd_queue_setup(bd_t *bd, size_t size, void **rbuf)
+{
+	if (bd->qbuf != NULL)
+		return EEXIST;
+
+	void *buf = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (buf == AS_MAP_FAILED)
+		return ENOMEM;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, BD_QUEUE_SETUP, &answer);
+	errno_t rc = async_share_out_start(exch, buf,
+	    AS_AREA_READ | AS_AREA_WRITE);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		as_area_destroy(buf);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK) {
+		as_area_destroy(buf);
+		return retval;
+	}
+
+	bd->qbuf = buf;
+	bd->qsize = size;
+	*rbuf = buf;
+	return EOK;
+}
+
+/** Send a queued request. */
+static errno_t bd_queue_send(bd_t *bd, sysarg_t method, aoff64_t ba,
+    size_t cnt, const bd_seg_t *segs, size_t nsegs, bd_req_t *req)
+{
+	if (bd->qbuf == NULL)
+		return EINVAL;
+	if (nsegs == 0 || nsegs > BD_QUEUE_SEGS_MAX)
+		return EINVAL;
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	req->aid = async_send_4(exch, method, LOWER32(ba), UPPER32(ba), cnt,
+	    nsegs, &req->answer);
+	errno_t rc = async_data_write_start(exch, segs,
+	    nsegs * sizeof(bd_seg_t));
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req->aid);
+		return rc;
+	}
+
+	return EOK;
+}
+
+/** Start reading blocks into the shared buffer.
+ *
+ * The request completes asynchronously; requests can complete in any
+ * order. Use bd_req_wait() or bd_req_poll() to collect the result.
+ *
+ * @param bd	Block device
+ * @param ba	Address of the first block
+ * @param cnt	Number of blocks
+ * @param segs	Segments of the shared buffer to fill in order
+ * @param nsegs	Number of segments, at most BD_QUEUE_SEGS_MAX
+ * @param req	Request structure, must stay valid until completion
+ *
+ * @return EOK if the request was sent or an error code
+ */
+errno_t bd_queue_read(bd_t *bd, aoff64_t ba, size_t cnt, const bd_seg_t *segs,
+    size_t nsegs, bd_req_t *req)
+{
+	return bd_queue_send(bd, BD_QUEUE_READ, ba, cnt, segs, nsegs, req);
+}
+
+/** Start writing blocks from the shared buffer.
+ *
+ * The segments must not be modified until the request completes.
+ *
+ * @param bd	Block device
+ * @param ba	Address of the first block
+ * @param cnt	Number of blocks
+ * @param segs	Segments of the shared buffer to write in order
+ * @param nsegs	Number of segments, at most BD_QUEUE_SEGS_MAX
+ * @param req	Request structure, must stay valid until completion
+ *
+ * @return EOK if the request was sent or an error code
+ */
+errno_t bd_queue_write(bd_t *bd, aoff64_t ba, size_t cnt, const bd_seg_t *segs,
+    size_t nsegs, bd_req_t *req)
+{
+	return bd_queue_send(bd, BD_QUEUE_WRITE, ba, cnt, segs, nsegs, req);
+}
+
+/** Wait for a queued request to complete.
+ *
+ * @param req	Request
+ *
+ * @return Result of the request
+ */
+errno_t bd_req_wait(bd_req_t *req)
+{
+	errno_t retval;
+
+	async_wait_for(req->aid, &retval);
+	return retval;
+}
+
+/** Check whether a queued request has completed.
+ *
+ * @param req		Request
+ * @param rretval	Place to store the result of a completed request
+ *
+ * @return EOK if the request has completed, ETIMEOUT if it is still in
+ *         flight
+ */
+errno_t bd_req_poll(bd_req_t *req, errno_t *rretval)
+{
+	return async_wait_timeout(req->aid, rretval, 0);
+}
+
 static void bd_cb_conn(ipc_call_t *icall, void *arg)
 {
 	bd_t *bd = (bd_t *)arg;
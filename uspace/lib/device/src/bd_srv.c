@@ -33,58 +33,213 @@
  * @file
  * @brief Block device server stub
  */
+#include <as.h>
+#include <assert.h>
 #include <errno.h>
+#include <fibril.h>
 #include <ipc/bd.h>
 #include <macros.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <str.h>
+#include <time.h>
 
 #include <bd_srv.h>
 
-static void bd_read_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
-{
+/** Request processed by a worker fibril */
+typedef struct {
+	bd_srv_t *srv;
+	sysarg_t method;
+	ipc_call_t call;
+	/** Data read call of BD_READ_BLOCKS */
+	ipc_call_t rcall;
 	aoff64_t ba;
 	size_t cnt;
-	void *buf;
+	/** Data of BD_WRITE_BLOCKS */
+	void *data;
+	/** Size of the data transfer */
 	size_t size;
-	errno_t rc;
+	/** Segments of BD_QUEUE_READ and BD_QUEUE_WRITE */
+	bd_seg_t *segs;
+	size_t nsegs;
+} bd_srv_req_t;
 
-	ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
-	cnt = ipc_get_arg3(call);
+static errno_t bd_srv_worker(void *);
+
+/** Get the current uptime in microseconds. */
+static usec_t bd_srv_uptime(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
 
+/** Bring the time counters of the statistics up to date.
+ *
+ * @param srvs Service, its statistics lock must be held
+ * @param now  Current uptime in microseconds
+ */
+static void bd_srvs_stats_update(bd_srvs_t *srvs, usec_t now)
+{
+	bd_stats_t *stats = &srvs->stats;
+	usec_t delta = now - srvs->stats_time;
+
+	if (stats->inflight > 0)
+		stats->busy_usec += delta;
+	stats->queue_usec += (uint64_t) stats->inflight * delta;
+	stats->uptime = now;
+	srvs->stats_time = now;
+}
+
+/** Account for the start of a request.
+ *
+ * @param srvs Service
+ * @return Uptime when the request started
+ */
+static usec_t bd_srvs_stats_start(bd_srvs_t *srvs)
+{
+	usec_t now = bd_srv_uptime();
+
+	fibril_mutex_lock(&srvs->stats_lock);
+	bd_srvs_stats_update(srvs, now);
+	srvs->stats.inflight++;
+	if (srvs->stats.inflight > srvs->stats.max_inflight)
+		srvs->stats.max_inflight = srvs->stats.inflight;
+	fibril_mutex_unlock(&srvs->stats_lock);
+	return now;
+}
+
+/** Account for the completion of a request.
+ *
+ * @param srvs  Service
+ * @param start Uptime when the request started
+ * @param write @c true for a write request
+ * @param bytes Number of bytes transferred
+ * @param rc    Result of the request
+ */
+static void bd_srvs_stats_end(bd_srvs_t *srvs, usec_t start, bool write,
+    size_t bytes, errno_t rc)
+{
+	usec_t now = bd_srv_uptime();
+	usec_t svc = now - start;
+	unsigned i = 0;
+
+	while (i < BD_STATS_HIST_BUCKETS - 1 && (svc >> (i + 1)) != 0)
+		i++;
+
+	fibril_mutex_lock(&srvs->stats_lock);
+	bd_srvs_stats_update(srvs, now);
+	srvs->stats.inflight--;
+	srvs->stats.service_usec += svc;
+	srvs->stats.hist[i]++;
+	if (rc != EOK) {
+		srvs->stats.errors++;
+	} else if (write) {
+		srvs->stats.writes++;
+		srvs->stats.write_bytes += bytes;
+	} else {
+		srvs->stats.reads++;
+		srvs->stats.read_bytes += bytes;
+	}
+	fibril_mutex_unlock(&srvs->stats_lock);
+}
+
+/** Process a request, possibly concurrently with others.
+ *
+ * Waits while the queue depth of the service is exhausted, so that the
+ * client cannot consume unbounded resources.
+ *
+ * @param req Request, freed when processed
+ */
+static void bd_srv_dispatch(bd_srv_req_t *req)
+{
+	bd_srv_t *srv = req->srv;
+	fid_t fid;
+
+	fibril_mutex_lock(&srv->lock);
+	while (srv->inflight >= max(srv->srvs->queue_depth, 1))
+		fibril_condvar_wait(&srv->cv, &srv->lock);
+	srv->inflight++;
+	fibril_mutex_unlock(&srv->lock);
+
+	if (srv->srvs->queue_depth <= 1) {
+		(void) bd_srv_worker(req);
+		return;
+	}
+
+	fid = fibril_create(bd_srv_worker, req);
+	if (fid == 0) {
+		(void) bd_srv_worker(req);
+		return;
+	}
+
+	fibril_add_ready(fid);
+}
+
+static void bd_read_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	bd_srv_req_t *req;
 	ipc_call_t rcall;
+	size_t size;
+
 	if (!async_data_read_receive(&rcall, &size)) {
 		async_answer_0(call, EINVAL);
 		return;
 	}
 
-	buf = malloc(size);
-	if (buf == NULL) {
+	req = calloc(1, sizeof(bd_srv_req_t));
+	if (req == NULL) {
 		async_answer_0(&rcall, ENOMEM);
 		async_answer_0(call, ENOMEM);
 		return;
 	}
 
+	req->srv = srv;
+	req->method = BD_READ_BLOCKS;
+	req->call = *call;
+	req->rcall = rcall;
+	req->ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+	req->cnt = ipc_get_arg3(call);
+	req->size = size;
+	bd_srv_dispatch(req);
+}
+
+static errno_t bd_read_blocks_do(bd_srv_req_t *req)
+{
+	bd_srv_t *srv = req->srv;
+	void *buf;
+	errno_t rc;
+
+	buf = malloc(req->size);
+	if (buf == NULL) {
+		async_answer_0(&req->rcall, ENOMEM);
+		async_answer_0(&req->call, ENOMEM);
+		return ENOMEM;
+	}
+
 	if (srv->srvs->ops->read_blocks == NULL) {
-		async_answer_0(&rcall, ENOTSUP);
-		async_answer_0(call, ENOTSUP);
+		async_answer_0(&req->rcall, ENOTSUP);
+		async_answer_0(&req->call, ENOTSUP);
 		free(buf);
-		return;
+		return ENOTSUP;
 	}
 
-	rc = srv->srvs->ops->read_blocks(srv, ba, cnt, buf, size);
+	rc = srv->srvs->ops->read_blocks(srv, req->ba, req->cnt, buf,
+	    req->size);
 	if (rc != EOK) {
-		async_answer_0(&rcall, ENOMEM);
-		async_answer_0(call, ENOMEM);
+		async_answer_0(&req->rcall, ENOMEM);
+		async_answer_0(&req->call, ENOMEM);
 		free(buf);
-		return;
+		return rc;
 	}
 
-	async_data_read_finalize(&rcall, buf, size);
+	async_data_read_finalize(&req->rcall, buf, req->size);
 
 	free(buf);
-	async_answer_0(call, EOK);
+	async_answer_0(&req->call, EOK);
+	return EOK;
 }
 
 static void bd_read_toc_srv(bd_srv_t *srv, ipc_call_t *call)
@@ -150,29 +305,238 @@ static void bd_sync_cache_srv(bd_srv_t *srv, ipc_call_t *call)
 
 static void bd_write_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 {
-	aoff64_t ba;
-	size_t cnt;
+	bd_srv_req_t *req;
 	void *data;
 	size_t size;
 	errno_t rc;
 
-	ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
-	cnt = ipc_get_arg3(call);
-
 	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
 	if (rc != EOK) {
 		async_answer_0(call, rc);
 		return;
 	}
 
+	req = calloc(1, sizeof(bd_srv_req_t));
+	if (req == NULL) {
+		free(data);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	req->srv = srv;
+	req->method = BD_WRITE_BLOCKS;
+	req->call = *call;
+	req->ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+	req->cnt = ipc_get_arg3(call);
+	req->data = data;
+	req->size = size;
+	bd_srv_dispatch(req);
+}
+
+static errno_t bd_write_blocks_do(bd_srv_req_t *req)
+{
+	bd_srv_t *srv = req->srv;
+	errno_t rc;
+
 	if (srv->srvs->ops->write_blocks == NULL) {
-		async_answer_0(call, ENOTSUP);
+		free(req->data);
+		async_answer_0(&req->call, ENOTSUP);
+		return ENOTSUP;
+	}
+
+	rc = srv->srvs->ops->write_blocks(srv, req->ba, req->cnt, req->data,
+	    req->size);
+	free(req->data);
+	async_answer_0(&req->call, rc);
+	return rc;
+}
+
+static void bd_queue_setup_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	ipc_call_t scall;
+	size_t size;
+	unsigned int flags;
+	void *buf;
+	errno_t rc;
+
+	if (!async_share_out_receive(&scall, &size, &flags)) {
+		async_answer_0(call, EINVAL);
 		return;
 	}
 
-	rc = srv->srvs->ops->write_blocks(srv, ba, cnt, data, size);
-	free(data);
-	async_answer_0(call, rc);
+	if (srv->qbuf != NULL ||
+	    (flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE)) {
+		async_answer_0(&scall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	rc = async_share_out_finalize(&scall, &buf);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	srv->qbuf = buf;
+	srv->qsize = size;
+	async_answer_0(call, EOK);
+}
+
+static void bd_queue_rw_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	bd_srv_req_t *req;
+	void *segs;
+	size_t nsegs;
+	size_t size;
+	errno_t rc;
+
+	nsegs = ipc_get_arg4(call);
+	if (nsegs == 0 || nsegs > BD_QUEUE_SEGS_MAX) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	rc = async_data_write_accept(&segs, false, nsegs * sizeof(bd_seg_t),
+	    nsegs * sizeof(bd_seg_t), 0, &size);
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return;
+	}
+
+	req = calloc(1, sizeof(bd_srv_req_t));
+	if (req == NULL) {
+		free(segs);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	req->srv = srv;
+	req->method = ipc_get_imethod(call);
+	req->call = *call;
+	req->ba = MERGE_LOUP32(ipc_get_arg1(call), ipc_get_arg2(call));
+	req->cnt = ipc_get_arg3(call);
+	req->segs = segs;
+	req->nsegs = nsegs;
+	bd_srv_dispatch(req);
+}
+
+/** Check the segments of a queued request.
+ *
+ * @param srv   Server structure
+ * @param req   Request
+ * @param bsize Block size
+ *
+ * @return EOK if the segments lie in the shared buffer and add up to
+ *         the number of blocks of the request
+ */
+static errno_t bd_queue_check(bd_srv_t *srv, bd_srv_req_t *req, size_t bsize)
+{
+	size_t total = 0;
+
+	if (srv->qbuf == NULL)
+		return EINVAL;
+
+	for (size_t i = 0; i < req->nsegs; i++) {
+		bd_seg_t *seg = &req->segs[i];
+
+		if (seg->size % bsize != 0 || seg->offset > srv->qsize ||
+		    seg->size > srv->qsize - seg->offset)
+			return EINVAL;
+		total += seg->size / bsize;
+	}
+
+	return total == req->cnt ? EOK : EINVAL;
+}
+
+static errno_t bd_queue_rw_do(bd_srv_req_t *req)
+{
+	bd_srv_t *srv = req->srv;
+	bool read = req->method == BD_QUEUE_READ;
+	aoff64_t ba = req->ba;
+	size_t bsize;
+	errno_t rc;
+
+	if ((read && srv->srvs->ops->read_blocks == NULL) ||
+	    (!read && srv->srvs->ops->write_blocks == NULL) ||
+	    srv->srvs->ops->get_block_size == NULL) {
+		rc = ENOTSUP;
+		goto out;
+	}
+
+	rc = srv->srvs->ops->get_block_size(srv, &bsize);
+	if (rc != EOK)
+		goto out;
+
+	rc = bd_queue_check(srv, req, bsize);
+	if (rc != EOK)
+		goto out;
+
+	for (size_t i = 0; i < req->nsegs; i++) {
+		bd_seg_t *seg = &req->segs[i];
+		uint8_t *buf = (uint8_t *) srv->qbuf + seg->offset;
+		size_t cnt = seg->size / bsize;
+
+		if (cnt == 0)
+			continue;
+
+		if (read) {
+			rc = srv->srvs->ops->read_blocks(srv, ba, cnt, buf,
+			    seg->size);
+		} else {
+			rc = srv->srvs->ops->write_blocks(srv, ba, cnt, buf,
+			    seg->size);
+		}
+		if (rc != EOK)
+			break;
+
+		ba += cnt;
+		req->size += seg->size;
+	}
+
+out:
+	free(req->segs);
+	async_answer_0(&req->call, rc);
+	return rc;
+}
+
+/** Worker fibril processing one request. */
+static errno_t bd_srv_worker(void *arg)
+{
+	bd_srv_req_t *req = (bd_srv_req_t *) arg;
+	bd_srv_t *srv = req->srv;
+	bool write = false;
+	usec_t start;
+	errno_t rc;
+
+	start = bd_srvs_stats_start(srv->srvs);
+
+	switch (req->method) {
+	case BD_READ_BLOCKS:
+		rc = bd_read_blocks_do(req);
+		break;
+	case BD_WRITE_BLOCKS:
+		rc = bd_write_blocks_do(req);
+		write = true;
+		break;
+	case BD_QUEUE_READ:
+	case BD_QUEUE_WRITE:
+		rc = bd_queue_rw_do(req);
+		write = req->method == BD_QUEUE_WRITE;
+		break;
+	default:
+		assert(false);
+		rc = EINVAL;
+	}
+
+	bd_srvs_stats_end(srv->srvs, start, write, req->size, rc);
+	free(req);
+
+	fibril_mutex_lock(&srv->lock);
+	srv->inflight--;
+	fibril_condvar_broadcast(&srv->cv);
+	fibril_mutex_unlock(&srv->lock);
+	return EOK;
 }
 
 static void bd_get_block_size_srv(bd_srv_t *srv, ipc_call_t *call)
@@ -203,6 +567,70 @@ static void bd_get_num_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_2(call, rc, LOWER32(num_blocks), UPPER32(num_blocks));
 }
 
+static void bd_get_stats_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	bd_srvs_t *srvs = srv->srvs;
+	ipc_call_t rcall;
+	bd_stats_t stats;
+	size_t size;
+
+	if (!async_data_read_receive(&rcall, &size)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (size != sizeof(bd_stats_t)) {
+		async_answer_0(&rcall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	fibril_mutex_lock(&srvs->stats_lock);
+	bd_srvs_stats_update(srvs, bd_srv_uptime());
+	stats = srvs->stats;
+	fibril_mutex_unlock(&srvs->stats_lock);
+
+	async_data_read_finalize(&rcall, &stats, sizeof(bd_stats_t));
+	async_answer_0(call, EOK);
+}
+
+static void bd_map_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	ipc_call_t scall;
+	unsigned int flags;
+	unsigned int mflags;
+	size_t msize;
+	size_t size;
+	void *addr;
+	errno_t rc;
+
+	if (!async_share_in_receive(&scall, &size)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (srv->srvs->ops->map == NULL) {
+		async_answer_0(&scall, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = srv->srvs->ops->map(srv, &addr, &msize, &mflags);
+	if (rc == EOK && size != msize)
+		rc = EINVAL;
+	if (rc != EOK) {
+		async_answer_0(&scall, rc);
+		async_answer_0(call, rc);
+		return;
+	}
+
+	/* Grant the requested access as far as the device allows it. */
+	flags = ipc_get_arg1(call) & (AS_AREA_READ | AS_AREA_WRITE);
+	rc = async_share_in_finalize(&scall, addr,
+	    (flags & mflags) | (mflags & AS_AREA_CACHEABLE));
+	async_answer_0(call, rc);
+}
+
 static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 {
 	bd_srv_t *srv;
@@ -212,6 +640,8 @@ static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 		return NULL;
 
 	srv->srvs = srvs;
+	fibril_mutex_initialize(&srv->lock);
+	fibril_condvar_initialize(&srv->cv);
 	return srv;
 }
 
@@ -219,6 +649,10 @@ void bd_srvs_init(bd_srvs_t *srvs)
 {
 	srvs->ops = NULL;
 	srvs->sarg = NULL;
+	srvs->queue_depth = 1;
+	fibril_mutex_initialize(&srvs->stats_lock);
+	memset(&srvs->stats, 0, sizeof(bd_stats_t));
+	srvs->stats_time = bd_srv_uptime();
 }
 
 errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
@@ -273,12 +707,33 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 		case BD_GET_NUM_BLOCKS:
 			bd_get_num_blocks_srv(srv, &call);
 			break;
+		case BD_QUEUE_SETUP:
+			bd_queue_setup_srv(srv, &call);
+			break;
+		case BD_QUEUE_READ:
+		case BD_QUEUE_WRITE:
+			bd_queue_rw_srv(srv, &call);
+			break;
+		case BD_GET_STATS:
+			bd_get_stats_srv(srv, &call);
+			break;
+		case BD_MAP:
+			bd_map_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
 	}
 
+	/* Let the requests in progress complete. */
+	fibril_mutex_lock(&srv->lock);
+	while (srv->inflight > 0)
+		fibril_condvar_wait(&srv->cv, &srv->lock);
+	fibril_mutex_unlock(&srv->lock);
+
 	rc = srvs->ops->close(srv);
+	if (srv->qbuf != NULL)
+		as_area_destroy(srv->qbuf);
 	free(srv);
 
 	return rc;
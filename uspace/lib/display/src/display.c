@@ -248,6 +248,9 @@ errno_t display_window_get_gc(display_window_t *window, gfx_context_t **rgc)
 		return ENOMEM;
 	}
 
+	/* Batch drawing operations until gfx_update(), if possible */
+	(void) ipc_gc_batch_enable(gc);
+
 	*rgc = ipc_gc_get_ctx(gc);
 	return EOK;
 }
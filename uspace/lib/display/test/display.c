@@ -71,6 +71,7 @@ static errno_t test_get_event(void *, sysarg_t *, display_wnd_ev_t *);
 static errno_t test_get_info(void *, display_info_t *);
 
 static errno_t test_gc_set_color(void *, gfx_color_t *);
+static errno_t test_gc_update(void *);
 
 static display_ops_t test_display_srv_ops = {
 	.window_create = test_window_create,
@@ -97,7 +98,8 @@ static display_wnd_cb_t test_display_wnd_cb = {
 };
 
 static gfx_context_ops_t test_gc_ops = {
-	.set_color = test_gc_set_color
+	.set_color = test_gc_set_color,
+	.update = test_gc_update
 };
 
 /** Describes to the server how to respond to our request and pass tracking
@@ -1346,6 +1348,10 @@ PCUT_TEST(window_get_gc_success)
 	resp.set_color_called = false;
 	rc = gfx_set_color(gc, color);
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Window GC batches drawing operations until update */
+	rc = gfx_update(gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 	PCUT_ASSERT_TRUE(resp.set_color_called);
 
 	gfx_color_delete(color);
@@ -2051,4 +2057,10 @@ static errno_t test_gc_set_color(void *arg, gfx_color_t *color)
 	return resp->rc;
 }
 
+static errno_t test_gc_update(void *arg)
+{
+	(void) arg;
+	return EOK;
+}
+
 PCUT_EXPORT(display);
@@ -297,6 +297,7 @@ void remote_ahci_read_blocks(ddf_fun_t *fun, void *iface, ipc_call_t *call)
 	const size_t cnt = (size_t) DEV_IPC_GET_ARG3(*call);
 
 	const errno_t ret = ahci_iface->read_blocks(fun, blocknum, cnt, buf);
+	as_area_destroy(buf);
 
 	async_answer_0(call, ret);
 }
@@ -324,6 +325,7 @@ void remote_ahci_write_blocks(ddf_fun_t *fun, void *iface, ipc_call_t *call)
 	const size_t cnt = (size_t) DEV_IPC_GET_ARG3(*call);
 
 	const errno_t ret = ahci_iface->write_blocks(fun, blocknum, cnt, buf);
+	as_area_destroy(buf);
 
 	async_answer_0(call, ret);
 }
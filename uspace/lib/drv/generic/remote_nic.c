@@ -35,6 +35,7 @@
  */
 
 #include <assert.h>
+#include <as.h>
 #include <async.h>
 #include <errno.h>
 #include <ipc/services.h>
@@ -85,7 +86,10 @@ typedef enum {
 	NIC_OFFLOAD_SET,
 	NIC_POLL_GET_MODE,
 	NIC_POLL_SET_MODE,
-	NIC_POLL_NOW
+	NIC_POLL_NOW,
+	NIC_SEND_FRAME_OFFLOAD,
+	NIC_RING_SETUP,
+	NIC_RING_DOORBELL
 } nic_funcs_t;
 
 /** Send frame from NIC
@@ -117,6 +121,90 @@ errno_t nic_send_frame(async_sess_t *dev_sess, void *data, size_t size)
 	return retval;
 }
 
+/** Send frame from NIC with offload computations
+ *
+ * The NIC must have the requested offloads enabled (see nic_offload_set).
+ *
+ * @param[in] dev_sess
+ * @param[in] data     Frame data
+ * @param[in] size     Frame size in bytes
+ * @param[in] offload  Offload computations to perform on the frame
+ *
+ * @return EOK If the operation was successfully completed
+ *
+ */
+errno_t nic_send_frame_offload(async_sess_t *dev_sess, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_4(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_SEND_FRAME_OFFLOAD, offload->flags, offload->csum_start |
+	    ((sysarg_t) offload->csum_offs << 16), offload->mss, &answer);
+	errno_t retval = async_data_write_start(exch, data, size);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Share a packet ring with NIC
+ *
+ * The caller creates the ring in @a area (see pkt_ring_create()). Frames
+ * then pass through the ring instead of separate IPC calls. A NIC that
+ * does not support packet rings returns ENOTSUP and the caller keeps
+ * using nic_send_frame() and NIC_EV_RECEIVED.
+ *
+ * @param[in] dev_sess
+ * @param[in] dir      Direction of the ring
+ * @param[in] area     Address space area holding the ring
+ *
+ * @return EOK If the operation was successfully completed
+ *
+ */
+errno_t nic_ring_setup(async_sess_t *dev_sess, nic_ring_dir_t dir, void *area)
+{
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_2(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
+	    NIC_RING_SETUP, dir, &answer);
+	errno_t retval = async_share_out_start(exch, area,
+	    AS_AREA_READ | AS_AREA_WRITE);
+
+	async_exchange_end(exch);
+
+	if (retval != EOK) {
+		async_forget(req);
+		return retval;
+	}
+
+	async_wait_for(req, &retval);
+	return retval;
+}
+
+/** Notify NIC that frames have been published in its TX ring
+ *
+ * Only needed when pkt_ring_prod_publish() says the NIC is waiting.
+ * The notification is not answered.
+ *
+ * @param[in] dev_sess
+ *
+ */
+void nic_ring_doorbell(async_sess_t *dev_sess)
+{
+	async_exch_t *exch = async_exchange_begin(dev_sess);
+	async_msg_1(exch, DEV_IFACE_ID(NIC_DEV_IFACE), NIC_RING_DOORBELL);
+	async_exchange_end(exch);
+}
+
 /** Create callback connection from NIC service
  *
  * @param[in] dev_sess
@@ -1244,7 +1332,7 @@ errno_t nic_offload_set(async_sess_t *dev_sess, uint32_t mask, uint32_t active)
 {
 	async_exch_t *exch = async_exchange_begin(dev_sess);
 	errno_t rc = async_req_3_0(exch, DEV_IFACE_ID(NIC_DEV_IFACE),
-	    NIC_AUTONEG_RESTART, (sysarg_t) mask, (sysarg_t) active);
+	    NIC_OFFLOAD_SET, (sysarg_t) mask, (sysarg_t) active);
 	async_exchange_end(exch);
 
 	return rc;
@@ -1356,6 +1444,94 @@ static void remote_nic_send_frame(ddf_fun_t *dev, void *iface,
 	free(data);
 }
 
+static void remote_nic_send_frame_offload(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	nic_tx_offload_t offload;
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	offload.flags = (uint32_t) ipc_get_arg2(call);
+	offload.csum_start = ipc_get_arg3(call) & 0xffff;
+	offload.csum_offs = (ipc_get_arg3(call) >> 16) & 0xffff;
+	offload.mss = (uint16_t) ipc_get_arg4(call);
+
+	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
+	if (rc != EOK) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (offload.flags == 0) {
+		assert(nic_iface->send_frame);
+		rc = nic_iface->send_frame(dev, data, size);
+	} else if (nic_iface->send_frame_offload != NULL) {
+		rc = nic_iface->send_frame_offload(dev, data, size, &offload);
+	} else {
+		rc = ENOTSUP;
+	}
+
+	async_answer_0(call, rc);
+	free(data);
+}
+
+static void remote_nic_ring_setup(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	nic_ring_dir_t dir = (nic_ring_dir_t) ipc_get_arg2(call);
+	ipc_call_t data;
+	unsigned int flags;
+	void *area;
+	size_t size;
+	errno_t rc;
+
+	if (!async_share_out_receive(&data, &size, &flags)) {
+		async_answer_0(&data, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if (nic_iface->ring_setup == NULL) {
+		async_answer_0(&data, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	if ((flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE)) {
+		async_answer_0(&data, EPERM);
+		async_answer_0(call, EPERM);
+		return;
+	}
+
+	rc = async_share_out_finalize(&data, &area);
+	if (rc != EOK || area == AS_MAP_FAILED) {
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	rc = nic_iface->ring_setup(dev, dir, area, size);
+	if (rc != EOK)
+		as_area_destroy(area);
+
+	async_answer_0(call, rc);
+}
+
+static void remote_nic_ring_doorbell(ddf_fun_t *dev, void *iface,
+    ipc_call_t *call)
+{
+	nic_iface_t *nic_iface = (nic_iface_t *) iface;
+	errno_t rc = ENOTSUP;
+
+	if (nic_iface->ring_doorbell != NULL)
+		rc = nic_iface->ring_doorbell(dev);
+
+	async_answer_0(call, rc);
+}
+
 static void remote_nic_callback_create(ddf_fun_t *dev, void *iface,
     ipc_call_t *call)
 {
@@ -2529,7 +2705,10 @@ static const remote_iface_func_ptr_t remote_nic_iface_ops[] = {
 	[NIC_OFFLOAD_SET] = remote_nic_offload_set,
 	[NIC_POLL_GET_MODE] = remote_nic_poll_get_mode,
 	[NIC_POLL_SET_MODE] = remote_nic_poll_set_mode,
-	[NIC_POLL_NOW] = remote_nic_poll_now
+	[NIC_POLL_NOW] = remote_nic_poll_now,
+	[NIC_SEND_FRAME_OFFLOAD] = remote_nic_send_frame_offload,
+	[NIC_RING_SETUP] = remote_nic_ring_setup,
+	[NIC_RING_DOORBELL] = remote_nic_ring_doorbell
 };
 
 /** Remote NIC interface structure.
@@ -49,6 +49,7 @@ typedef enum {
 	IPC_M_USB_DEVICE_REMOVE,
 	IPC_M_USB_REGISTER_ENDPOINT,
 	IPC_M_USB_UNREGISTER_ENDPOINT,
+	IPC_M_USB_REQUEST_STREAMS,
 	IPC_M_USB_TRANSFER,
 } usbhc_iface_funcs_t;
 
@@ -176,6 +177,46 @@ errno_t usbhc_unregister_endpoint(async_exch_t *exch, const usb_pipe_desc_t *pip
 	return (errno_t) opening_request_rc;
 }
 
+/** Switch a bulk endpoint to stream operation
+ *
+ * @param[in]  exch      IPC communication exchange
+ * @param[in]  pipe_desc Registered bulk endpoint
+ * @param[in]  count     Number of streams requested
+ * @param[out] granted   Number of usable stream IDs (1..granted)
+ *
+ * @return Error code.
+ */
+errno_t usbhc_request_streams(async_exch_t *exch,
+    const usb_pipe_desc_t *pipe_desc, unsigned count, unsigned *granted)
+{
+	if (!exch)
+		return EBADMEM;
+
+	ipc_call_t answer;
+	aid_t opening_request = async_send_2(exch,
+	    DEV_IFACE_ID(USBHC_DEV_IFACE), IPC_M_USB_REQUEST_STREAMS, count,
+	    &answer);
+
+	if (opening_request == 0) {
+		return ENOMEM;
+	}
+
+	const errno_t ret = async_data_write_start(exch, pipe_desc, sizeof(*pipe_desc));
+	if (ret != EOK) {
+		async_forget(opening_request);
+		return ret;
+	}
+
+	/* Wait for the answer. */
+	errno_t opening_request_rc;
+	async_wait_for(opening_request, &opening_request_rc);
+
+	if (opening_request_rc == EOK && granted)
+		*granted = ipc_get_arg1(&answer);
+
+	return (errno_t) opening_request_rc;
+}
+
 /**
  * Issue a USB transfer with a data contained in memory area. That area is
  * temporarily shared with the HC.
@@ -230,6 +271,7 @@ static void remote_usbhc_device_enumerate(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_usbhc_device_remove(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_usbhc_register_endpoint(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_usbhc_unregister_endpoint(ddf_fun_t *, void *, ipc_call_t *);
+static void remote_usbhc_request_streams(ddf_fun_t *, void *, ipc_call_t *);
 static void remote_usbhc_transfer(ddf_fun_t *fun, void *iface, ipc_call_t *call);
 
 /** Remote USB interface operations. */
@@ -239,6 +281,7 @@ static const remote_iface_func_ptr_t remote_usbhc_iface_ops [] = {
 	[IPC_M_USB_DEVICE_REMOVE] = remote_usbhc_device_remove,
 	[IPC_M_USB_REGISTER_ENDPOINT] = remote_usbhc_register_endpoint,
 	[IPC_M_USB_UNREGISTER_ENDPOINT] = remote_usbhc_unregister_endpoint,
+	[IPC_M_USB_REQUEST_STREAMS] = remote_usbhc_request_streams,
 	[IPC_M_USB_TRANSFER] = remote_usbhc_transfer,
 };
 
@@ -367,6 +410,38 @@ static void remote_usbhc_unregister_endpoint(ddf_fun_t *fun, void *iface,
 	async_answer_0(call, rc);
 }
 
+static void remote_usbhc_request_streams(ddf_fun_t *fun, void *iface,
+    ipc_call_t *call)
+{
+	assert(fun);
+	assert(iface);
+	assert(call);
+
+	const usbhc_iface_t *usbhc_iface = iface;
+
+	if (!usbhc_iface->request_streams) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	const unsigned count = DEV_IPC_GET_ARG1(*call);
+	usb_pipe_desc_t pipe_desc;
+	ipc_call_t data;
+	size_t len;
+
+	if (!async_data_write_receive(&data, &len) ||
+	    len != sizeof(pipe_desc)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+	async_data_write_finalize(&data, &pipe_desc, sizeof(pipe_desc));
+
+	unsigned granted = 0;
+	const errno_t rc = usbhc_iface->request_streams(fun, &pipe_desc,
+	    count, &granted);
+	async_answer_1(call, rc, granted);
+}
+
 static void async_transaction_destroy(async_transaction_t *trans)
 {
 	if (trans == NULL) {
@@ -48,6 +48,8 @@ typedef struct {
 	errno_t (*clear_interrupt)(ddf_fun_t *, int);
 	errno_t (*dma_channel_setup)(ddf_fun_t *, unsigned, uint32_t, uint32_t, uint8_t);
 	errno_t (*dma_channel_remain)(ddf_fun_t *, unsigned, size_t *);
+	errno_t (*msi_alloc)(ddf_fun_t *, size_t, int *, size_t *);
+	errno_t (*msi_free)(ddf_fun_t *);
 } hw_res_ops_t;
 
 #endif
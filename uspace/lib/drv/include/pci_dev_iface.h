@@ -57,7 +57,9 @@
 #define PCI_CAP_NEXT(c)	((c) + 0x1)
 
 #define PCI_CAP_PMID		0x1
+#define PCI_CAP_MSI		0x5
 #define PCI_CAP_VENDORSPECID	0x9
+#define PCI_CAP_MSIX		0x11
 
 extern errno_t pci_config_space_read_8(async_sess_t *, uint32_t, uint8_t *);
 extern errno_t pci_config_space_read_16(async_sess_t *, uint32_t, uint16_t *);
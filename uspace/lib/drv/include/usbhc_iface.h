@@ -177,6 +177,8 @@ extern errno_t usbhc_device_remove(async_exch_t *, unsigned);
 
 extern errno_t usbhc_register_endpoint(async_exch_t *, usb_pipe_desc_t *, const usb_endpoint_descriptors_t *);
 extern errno_t usbhc_unregister_endpoint(async_exch_t *, const usb_pipe_desc_t *);
+extern errno_t usbhc_request_streams(async_exch_t *, const usb_pipe_desc_t *,
+    unsigned, unsigned *);
 
 extern errno_t usbhc_transfer(async_exch_t *, const usbhc_iface_transfer_request_t *, size_t *);
 
@@ -192,6 +194,8 @@ typedef struct {
 
 	errno_t (*register_endpoint)(ddf_fun_t *, usb_pipe_desc_t *, const usb_endpoint_descriptors_t *);
 	errno_t (*unregister_endpoint)(ddf_fun_t *, const usb_pipe_desc_t *);
+	errno_t (*request_streams)(ddf_fun_t *, const usb_pipe_desc_t *,
+	    unsigned, unsigned *);
 
 	errno_t (*transfer)(ddf_fun_t *, const usbhc_iface_transfer_request_t *,
 	    usbhc_iface_transfer_callback_t, void *);
@@ -43,6 +43,8 @@ extern errno_t ext4_bitmap_find_free_byte_and_set_bit(uint8_t *, uint32_t,
     uint32_t *, uint32_t);
 extern errno_t ext4_bitmap_find_free_bit_and_set(uint8_t *, uint32_t, uint32_t *,
     uint32_t);
+extern errno_t ext4_bitmap_find_free_run_and_set(uint8_t *, uint32_t, uint32_t,
+    uint32_t, uint32_t *, uint32_t *);
 
 #endif
 
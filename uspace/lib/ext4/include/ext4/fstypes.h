@@ -35,6 +35,7 @@
 #define LIBEXT4_FSTYPES_H_
 
 #include <adt/list.h>
+#include <fibril_synch.h>
 #include <libfs.h>
 #include <loc.h>
 #include "ext4/types.h"
@@ -51,6 +52,10 @@ typedef struct ext4_instance {
 
 /**
  * Type for wrapping common fs_node and add some useful pointers.
+ *
+ * The lock is held for reading while the node contents are read and for
+ * writing while they change, so that runner threads of a multithreaded
+ * server can work on different nodes at the same time.
  */
 typedef struct ext4_node {
 	ext4_instance_t *instance;
@@ -58,6 +63,7 @@ typedef struct ext4_node {
 	fs_node_t *fs_node;
 	ht_link_t link;
 	unsigned int references;
+	fibril_rwlock_t lock;
 } ext4_node_t;
 
 #define EXT4_NODE(node) \
@@ -36,6 +36,7 @@
 #define LIBEXT4_TYPES_H_
 
 #include <block.h>
+#include <fibril_synch.h>
 
 /*
  * Structure of the super block
@@ -195,6 +196,7 @@ typedef struct ext4_superblock {
 #define EXT4_FEATURE_RO_COMPAT_GDT_CSUM      0x0010
 #define EXT4_FEATURE_RO_COMPAT_DIR_NLINK     0x0020
 #define EXT4_FEATURE_RO_COMPAT_EXTRA_ISIZE   0x0040
+#define EXT4_FEATURE_RO_COMPAT_METADATA_CSUM 0x0400
 
 /*
  * Incompatible features
@@ -232,6 +234,8 @@ typedef struct ext4_filesystem {
 	ext4_superblock_t *superblock;
 	aoff64_t inode_block_limits[4];
 	aoff64_t inode_blocks_per_level[4];
+	/* Serializes changes of the bitmaps and free counts */
+	fibril_mutex_t alloc_lock;
 } ext4_filesystem_t;
 
 /** Size of buffer for volume name. To hold 16 latin-1 chars encoded as UTF-8
@@ -387,12 +391,33 @@ typedef struct ext4_inode {
 
 #define EXT4_INODE_ROOT_INDEX  2
 
+/*
+ * In-memory cache of the extents of one i-node
+ */
+#define EXT4_EXTENT_CACHE_SIZE  16
+
+typedef struct ext4_extent_cache_entry {
+	uint32_t first_block;   /* First logical block of the extent */
+	uint32_t start;         /* First physical block of the extent */
+	uint32_t block_count;   /* Number of blocks in the extent */
+} ext4_extent_cache_entry_t;
+
+typedef struct ext4_extent_cache {
+	fibril_mutex_t lock;
+	size_t count;           /* Number of valid entries */
+	/* Entries sorted by the first logical block */
+	ext4_extent_cache_entry_t entries[EXT4_EXTENT_CACHE_SIZE];
+} ext4_extent_cache_t;
+
 typedef struct ext4_inode_ref {
 	block_t *block;         /* Reference to a block containing this inode */
 	ext4_inode_t *inode;
 	ext4_filesystem_t *fs;
 	uint32_t index;         /* Index number of this inode */
 	bool dirty;
+	ext4_extent_cache_t extent_cache;
+	uint32_t prealloc_start; /* First block preallocated to this inode */
+	uint32_t prealloc_count; /* Number of preallocated blocks */
 } ext4_inode_ref_t;
 
 #define EXT4_DIRECTORY_FILENAME_LEN  255
@@ -36,6 +36,7 @@
  */
 
 #include <errno.h>
+#include <macros.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include "ext4/balloc.h"
@@ -46,7 +47,7 @@
 #include "ext4/superblock.h"
 #include "ext4/types.h"
 
-/** Free block.
+/** Free block with the allocation lock held.
  *
  * @param inode_ref  Inode, where the block is allocated
  * @param block_addr Absolute block address to free
@@ -54,7 +55,8 @@
  * @return Error code
  *
  */
-errno_t ext4_balloc_free_block(ext4_inode_ref_t *inode_ref, uint32_t block_addr)
+static errno_t ext4_balloc_free_block_locked(ext4_inode_ref_t *inode_ref,
+    uint32_t block_addr)
 {
 	ext4_filesystem_t *fs = inode_ref->fs;
 	ext4_superblock_t *sb = fs->superblock;
@@ -119,8 +121,27 @@ errno_t ext4_balloc_free_block(ext4_inode_ref_t *inode_ref, uint32_t block_addr)
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
 
-static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
-    uint32_t first, uint32_t count)
+/** Free block.
+ *
+ * @param inode_ref  Inode, where the block is allocated
+ * @param block_addr Absolute block address to free
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_free_block(ext4_inode_ref_t *inode_ref, uint32_t block_addr)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+
+	fibril_mutex_lock(&fs->alloc_lock);
+	errno_t rc = ext4_balloc_free_block_locked(inode_ref, block_addr);
+	fibril_mutex_unlock(&fs->alloc_lock);
+
+	return rc;
+}
+
+static errno_t ext4_balloc_free_blocks_locked(ext4_inode_ref_t *inode_ref,
+    uint32_t first, uint32_t count, bool charged)
 {
 	ext4_filesystem_t *fs = inode_ref->fs;
 	ext4_superblock_t *sb = fs->superblock;
@@ -174,11 +195,13 @@ static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
 	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
 
 	/* Update inode blocks count */
-	uint64_t ino_blocks =
-	    ext4_inode_get_blocks_count(sb, inode_ref->inode);
-	ino_blocks -= count * (block_size / EXT4_INODE_BLOCK_SIZE);
-	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
-	inode_ref->dirty = true;
+	if (charged) {
+		uint64_t ino_blocks =
+		    ext4_inode_get_blocks_count(sb, inode_ref->inode);
+		ino_blocks -= count * (block_size / EXT4_INODE_BLOCK_SIZE);
+		ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
+		inode_ref->dirty = true;
+	}
 
 	/* Update block group free blocks count */
 	uint32_t free_blocks =
@@ -192,6 +215,19 @@ static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
 
+static errno_t ext4_balloc_free_blocks_internal(ext4_inode_ref_t *inode_ref,
+    uint32_t first, uint32_t count, bool charged)
+{
+	ext4_filesystem_t *fs = inode_ref->fs;
+
+	fibril_mutex_lock(&fs->alloc_lock);
+	errno_t rc = ext4_balloc_free_blocks_locked(inode_ref, first, count,
+	    charged);
+	fibril_mutex_unlock(&fs->alloc_lock);
+
+	return rc;
+}
+
 /** Free continuous set of blocks.
  *
  * @param inode_ref Inode, where the blocks are allocated
@@ -221,7 +257,7 @@ errno_t ext4_balloc_free_blocks(ext4_inode_ref_t *inode_ref,
 			uint32_t s = limit - first;
 
 			r = ext4_balloc_free_blocks_internal(inode_ref,
-			    first, s);
+			    first, s, true);
 			if (r != EOK)
 				return r;
 
@@ -229,7 +265,7 @@ errno_t ext4_balloc_free_blocks(ext4_inode_ref_t *inode_ref,
 			count -= s;
 		} else {
 			return ext4_balloc_free_blocks_internal(inode_ref,
-			    first, count);
+			    first, count, true);
 		}
 	}
 
@@ -312,7 +348,7 @@ static errno_t ext4_balloc_find_goal(ext4_inode_ref_t *inode_ref, uint32_t *goal
 		if (rc != EOK)
 			return rc;
 
-		if (goal != 0) {
+		if (*goal != 0) {
 			(*goal)++;
 			return EOK;
 		}
@@ -335,65 +371,78 @@ static errno_t ext4_balloc_find_goal(ext4_inode_ref_t *inode_ref, uint32_t *goal
 	return ext4_filesystem_put_block_group_ref(bg_ref);
 }
 
-/** Data block allocation algorithm.
- *
- * @param inode_ref Inode to allocate block for
- * @param fblock    Allocated block address
+/** Account allocated blocks to an i-node.
  *
- * @return Error code
+ * @param inode_ref Inode the blocks were allocated for
+ * @param count     Number of blocks
  *
  */
-errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
+static void ext4_balloc_charge_inode(ext4_inode_ref_t *inode_ref,
+    uint32_t count)
 {
-	uint32_t allocated_block = 0;
-
-	uint32_t bitmap_block_addr;
-	block_t *bitmap_block;
-	uint32_t rel_block_idx = 0;
-	uint32_t free_blocks;
-	uint32_t goal;
-	uint32_t block_size;
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
 
-	/* Find GOAL */
-	errno_t rc = ext4_balloc_find_goal(inode_ref, &goal);
-	if (rc != EOK)
-		return rc;
+	/* Update inode blocks (different block size!) count */
+	uint64_t ino_blocks =
+	    ext4_inode_get_blocks_count(sb, inode_ref->inode);
+	ino_blocks += count * (block_size / EXT4_INODE_BLOCK_SIZE);
+	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
+	inode_ref->dirty = true;
+}
 
+/** Allocate a run of contiguous blocks in one block group.
+ *
+ * The blocks are marked as used in the bitmap and the free block counts
+ * are updated, but the blocks are not charged to any i-node.
+ *
+ * @param inode_ref      Inode to allocate blocks for
+ * @param block_group    Block group to allocate from
+ * @param index_in_group Index in group where to start looking
+ * @param want           Requested number of blocks
+ * @param fblock         Output value - first allocated block
+ * @param count          Output value - number of allocated blocks
+ *
+ * @return Error code, ENOSPC if the group has no free block
+ *
+ */
+static errno_t ext4_balloc_alloc_run_in_group(ext4_inode_ref_t *inode_ref,
+    uint32_t block_group, uint32_t index_in_group, uint32_t want,
+    uint32_t *fblock, uint32_t *count)
+{
 	ext4_superblock_t *sb = inode_ref->fs->superblock;
 
-	/* Load block group number for goal and relative index */
-	uint32_t block_group = ext4_filesystem_blockaddr2group(sb, goal);
-	uint32_t index_in_group =
-	    ext4_filesystem_blockaddr2_index_in_group(sb, goal);
-
 	/* Load block group reference */
 	ext4_block_group_ref_t *bg_ref;
-	rc = ext4_filesystem_get_block_group_ref(inode_ref->fs,
+	errno_t rc = ext4_filesystem_get_block_group_ref(inode_ref->fs,
 	    block_group, &bg_ref);
 	if (rc != EOK)
 		return rc;
 
-	free_blocks =
+	uint32_t free_blocks =
 	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
 	if (free_blocks == 0) {
 		/* This group has no free blocks */
-		goto goal_failed;
+		rc = ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc != EOK ? rc : ENOSPC;
 	}
 
 	/* Compute indexes */
 	uint32_t first_in_group =
 	    ext4_balloc_get_first_data_block_in_group(sb, bg_ref);
-
 	uint32_t first_in_group_index =
 	    ext4_filesystem_blockaddr2_index_in_group(sb, first_in_group);
+	uint32_t blocks_in_group =
+	    ext4_superblock_get_blocks_in_group(sb, block_group);
 
 	if (index_in_group < first_in_group_index)
 		index_in_group = first_in_group_index;
 
 	/* Load block with bitmap */
-	bitmap_block_addr =
+	uint32_t bitmap_block_addr =
 	    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
 
+	block_t *bitmap_block;
 	rc = block_get(&bitmap_block, inode_ref->fs->device,
 	    bitmap_block_addr, BLOCK_FLAGS_NONE);
 	if (rc != EOK) {
@@ -401,217 +450,161 @@ errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
 		return rc;
 	}
 
-	/* Check if goal is free */
-	if (ext4_bitmap_is_free_bit(bitmap_block->data, index_in_group)) {
-		ext4_bitmap_set_bit(bitmap_block->data, index_in_group);
+	uint32_t rel_block_idx;
+	uint32_t allocated;
+	rc = ext4_bitmap_find_free_run_and_set(bitmap_block->data,
+	    index_in_group, blocks_in_group, min(want, free_blocks),
+	    &rel_block_idx, &allocated);
+	if (rc == EOK)
 		bitmap_block->dirty = true;
-		rc = block_put(bitmap_block);
-		if (rc != EOK) {
-			ext4_filesystem_put_block_group_ref(bg_ref);
-			return rc;
-		}
-
-		allocated_block =
-		    ext4_filesystem_index_in_group2blockaddr(sb, index_in_group,
-		    block_group);
 
-		goto success;
+	errno_t rc2 = block_put(bitmap_block);
+	if (rc != EOK || rc2 != EOK) {
+		ext4_filesystem_put_block_group_ref(bg_ref);
+		return rc != EOK ? rc : rc2;
 	}
 
-	uint32_t blocks_in_group =
-	    ext4_superblock_get_blocks_in_group(sb, block_group);
-
-	uint32_t end_idx = (index_in_group + 63) & ~63;
-	if (end_idx > blocks_in_group)
-		end_idx = blocks_in_group;
-
-	/* Try to find free block near to goal */
-	for (uint32_t tmp_idx = index_in_group + 1; tmp_idx < end_idx;
-	    ++tmp_idx) {
-		if (ext4_bitmap_is_free_bit(bitmap_block->data, tmp_idx)) {
-			ext4_bitmap_set_bit(bitmap_block->data, tmp_idx);
-			bitmap_block->dirty = true;
-			rc = block_put(bitmap_block);
-			if (rc != EOK)
-				return rc;
-
-			allocated_block =
-			    ext4_filesystem_index_in_group2blockaddr(sb, tmp_idx,
-			    block_group);
-
-			goto success;
-		}
-	}
+	/* Update superblock free blocks count */
+	uint32_t sb_free_blocks = ext4_superblock_get_free_blocks_count(sb);
+	sb_free_blocks -= allocated;
+	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
 
-	/* Find free BYTE in bitmap */
-	rc = ext4_bitmap_find_free_byte_and_set_bit(bitmap_block->data,
-	    index_in_group, &rel_block_idx, blocks_in_group);
-	if (rc == EOK) {
-		bitmap_block->dirty = true;
-		rc = block_put(bitmap_block);
-		if (rc != EOK)
-			return rc;
+	/* Update block group free blocks count */
+	free_blocks -= allocated;
+	ext4_block_group_set_free_blocks_count(bg_ref->block_group, sb,
+	    free_blocks);
+	bg_ref->dirty = true;
 
-		allocated_block =
-		    ext4_filesystem_index_in_group2blockaddr(sb, rel_block_idx,
-		    block_group);
+	*fblock = ext4_filesystem_index_in_group2blockaddr(sb, rel_block_idx,
+	    block_group);
+	*count = allocated;
 
-		goto success;
-	}
+	return ext4_filesystem_put_block_group_ref(bg_ref);
+}
 
-	/* Find free bit in bitmap */
-	rc = ext4_bitmap_find_free_bit_and_set(bitmap_block->data,
-	    index_in_group, &rel_block_idx, blocks_in_group);
-	if (rc == EOK) {
-		bitmap_block->dirty = true;
-		rc = block_put(bitmap_block);
-		if (rc != EOK)
-			return rc;
+/** Allocate a run of contiguous blocks near the goal of an i-node.
+ *
+ * The block group of the goal is searched first, starting at the goal.
+ * The other groups follow, each from its first data block.
+ *
+ * @param inode_ref Inode to allocate blocks for
+ * @param want      Requested number of blocks
+ * @param fblock    Output value - first allocated block
+ * @param count     Output value - number of allocated blocks
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_balloc_alloc_run(ext4_inode_ref_t *inode_ref,
+    uint32_t want, uint32_t *fblock, uint32_t *count)
+{
+	uint32_t goal;
 
-		allocated_block =
-		    ext4_filesystem_index_in_group2blockaddr(sb, rel_block_idx,
-		    block_group);
+	/* Find GOAL */
+	errno_t rc = ext4_balloc_find_goal(inode_ref, &goal);
+	if (rc != EOK)
+		return rc;
 
-		goto success;
-	}
+	ext4_filesystem_t *fs = inode_ref->fs;
+	ext4_superblock_t *sb = fs->superblock;
 
-	/* No free block found yet */
-	rc = block_put(bitmap_block);
-	if (rc != EOK) {
-		ext4_filesystem_put_block_group_ref(bg_ref);
-		return rc;
-	}
+	/* Load block group number for goal and relative index */
+	uint32_t block_group = ext4_filesystem_blockaddr2group(sb, goal);
+	uint32_t index_in_group =
+	    ext4_filesystem_blockaddr2_index_in_group(sb, goal);
 
-goal_failed:
+	fibril_mutex_lock(&fs->alloc_lock);
 
-	rc = ext4_filesystem_put_block_group_ref(bg_ref);
-	if (rc != EOK)
-		return rc;
+	rc = ext4_balloc_alloc_run_in_group(inode_ref, block_group,
+	    index_in_group, want, fblock, count);
+	if (rc != ENOSPC)
+		goto out;
 
 	/* Try other block groups */
 	uint32_t block_group_count = ext4_superblock_get_block_group_count(sb);
 
 	uint32_t bgid = (block_group + 1) % block_group_count;
-	uint32_t count = block_group_count;
-
-	while (count > 0) {
-		rc = ext4_filesystem_get_block_group_ref(inode_ref->fs, bgid,
-		    &bg_ref);
-		if (rc != EOK)
-			return rc;
-
-		free_blocks =
-		    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
-		if (free_blocks == 0) {
-			/* This group has no free blocks */
-			goto next_group;
-		}
-
-		/* Load block with bitmap */
-		bitmap_block_addr =
-		    ext4_block_group_get_block_bitmap(bg_ref->block_group, sb);
-
-		rc = block_get(&bitmap_block, inode_ref->fs->device,
-		    bitmap_block_addr, 0);
-		if (rc != EOK) {
-			ext4_filesystem_put_block_group_ref(bg_ref);
-			return rc;
-		}
+	uint32_t groups = block_group_count;
 
-		/* Compute indexes */
-		first_in_group =
-		    ext4_balloc_get_first_data_block_in_group(sb, bg_ref);
-		index_in_group =
-		    ext4_filesystem_blockaddr2_index_in_group(sb, first_in_group);
-		blocks_in_group = ext4_superblock_get_blocks_in_group(sb, bgid);
-
-		first_in_group_index =
-		    ext4_filesystem_blockaddr2_index_in_group(sb, first_in_group);
-
-		if (index_in_group < first_in_group_index)
-			index_in_group = first_in_group_index;
-
-		/* Try to find free byte in bitmap */
-		rc = ext4_bitmap_find_free_byte_and_set_bit(bitmap_block->data,
-		    index_in_group, &rel_block_idx, blocks_in_group);
-		if (rc == EOK) {
-			bitmap_block->dirty = true;
-			rc = block_put(bitmap_block);
-			if (rc != EOK) {
-				ext4_filesystem_put_block_group_ref(bg_ref);
-				return rc;
-			}
-
-			allocated_block =
-			    ext4_filesystem_index_in_group2blockaddr(sb, rel_block_idx,
-			    bgid);
-
-			goto success;
-		}
+	while (groups > 0) {
+		rc = ext4_balloc_alloc_run_in_group(inode_ref, bgid, 0, want,
+		    fblock, count);
+		if (rc != ENOSPC)
+			goto out;
 
-		/* Try to find free bit in bitmap */
-		rc = ext4_bitmap_find_free_bit_and_set(bitmap_block->data,
-		    index_in_group, &rel_block_idx, blocks_in_group);
-		if (rc == EOK) {
-			bitmap_block->dirty = true;
-			rc = block_put(bitmap_block);
-			if (rc != EOK) {
-				ext4_filesystem_put_block_group_ref(bg_ref);
-				return rc;
-			}
-
-			allocated_block =
-			    ext4_filesystem_index_in_group2blockaddr(sb, rel_block_idx,
-			    bgid);
-
-			goto success;
-		}
+		/* Goto next group */
+		bgid = (bgid + 1) % block_group_count;
+		groups--;
+	}
 
-		rc = block_put(bitmap_block);
-		if (rc != EOK) {
-			ext4_filesystem_put_block_group_ref(bg_ref);
-			return rc;
-		}
+out:
+	fibril_mutex_unlock(&fs->alloc_lock);
+	return rc;
+}
 
-	next_group:
-		rc = ext4_filesystem_put_block_group_ref(bg_ref);
-		if (rc != EOK)
-			return rc;
+/** Data block allocation algorithm.
+ *
+ * Blocks of regular files are allocated in runs of up to
+ * EXT4_BALLOC_PREALLOC_BLOCKS. The rest of the run after the returned
+ * block is preallocated to the i-node and handed out by the following
+ * allocations, so that a growing file stays contiguous on the disk.
+ *
+ * @param inode_ref Inode to allocate block for
+ * @param fblock    Allocated block address
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t *fblock)
+{
+	ext4_superblock_t *sb = inode_ref->fs->superblock;
 
-		/* Goto next group */
-		bgid = (bgid + 1) % block_group_count;
-		count--;
+	/* Use preallocated blocks first */
+	if (inode_ref->prealloc_count > 0) {
+		*fblock = inode_ref->prealloc_start++;
+		inode_ref->prealloc_count--;
+		ext4_balloc_charge_inode(inode_ref, 1);
+		return EOK;
 	}
 
-	return ENOSPC;
+	uint32_t want = 1;
+	if (ext4_inode_is_type(sb, inode_ref->inode, EXT4_INODE_MODE_FILE))
+		want = EXT4_BALLOC_PREALLOC_BLOCKS;
 
-success:
-	block_size = ext4_superblock_get_block_size(sb);
+	uint32_t first;
+	uint32_t count;
+	errno_t rc = ext4_balloc_alloc_run(inode_ref, want, &first, &count);
+	if (rc != EOK)
+		return rc;
 
-	/* Update superblock free blocks count */
-	uint32_t sb_free_blocks = ext4_superblock_get_free_blocks_count(sb);
-	sb_free_blocks--;
-	ext4_superblock_set_free_blocks_count(sb, sb_free_blocks);
+	ext4_balloc_charge_inode(inode_ref, 1);
+	inode_ref->prealloc_start = first + 1;
+	inode_ref->prealloc_count = count - 1;
 
-	/* Update inode blocks (different block size!) count */
-	uint64_t ino_blocks =
-	    ext4_inode_get_blocks_count(sb, inode_ref->inode);
-	ino_blocks += block_size / EXT4_INODE_BLOCK_SIZE;
-	ext4_inode_set_blocks_count(sb, inode_ref->inode, ino_blocks);
-	inode_ref->dirty = true;
+	*fblock = first;
+	return EOK;
+}
 
-	/* Update block group free blocks count */
-	uint32_t bg_free_blocks =
-	    ext4_block_group_get_free_blocks_count(bg_ref->block_group, sb);
-	bg_free_blocks--;
-	ext4_block_group_set_free_blocks_count(bg_ref->block_group, sb,
-	    bg_free_blocks);
-	bg_ref->dirty = true;
+/** Release blocks preallocated to an i-node.
+ *
+ * @param inode_ref Inode to release the preallocated blocks of
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_balloc_discard_prealloc(ext4_inode_ref_t *inode_ref)
+{
+	if (inode_ref->prealloc_count == 0)
+		return EOK;
 
-	rc = ext4_filesystem_put_block_group_ref(bg_ref);
+	uint32_t first = inode_ref->prealloc_start;
+	uint32_t count = inode_ref->prealloc_count;
 
-	*fblock = allocated_block;
-	return rc;
+	inode_ref->prealloc_count = 0;
+
+	/* A run never crosses a block group boundary */
+	return ext4_balloc_free_blocks_internal(inode_ref, first, count,
+	    false);
 }
 
 /** Try to allocate concrete block.
@@ -628,6 +621,16 @@ errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t fblock
 {
 	errno_t rc;
 
+	/* The block may be the next preallocated one */
+	if (inode_ref->prealloc_count > 0 &&
+	    fblock == inode_ref->prealloc_start) {
+		inode_ref->prealloc_start++;
+		inode_ref->prealloc_count--;
+		ext4_balloc_charge_inode(inode_ref, 1);
+		*free = true;
+		return EOK;
+	}
+
 	ext4_filesystem_t *fs = inode_ref->fs;
 	ext4_superblock_t *sb = fs->superblock;
 
@@ -636,11 +639,15 @@ errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t fblock
 	uint32_t index_in_group =
 	    ext4_filesystem_blockaddr2_index_in_group(sb, fblock);
 
+	fibril_mutex_lock(&fs->alloc_lock);
+
 	/* Load block group reference */
 	ext4_block_group_ref_t *bg_ref;
 	rc = ext4_filesystem_get_block_group_ref(fs, block_group, &bg_ref);
-	if (rc != EOK)
+	if (rc != EOK) {
+		fibril_mutex_unlock(&fs->alloc_lock);
 		return rc;
+	}
 
 	/* Load block with bitmap */
 	uint32_t bitmap_block_addr =
@@ -649,6 +656,7 @@ errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t fblock
 	rc = block_get(&bitmap_block, fs->device, bitmap_block_addr, 0);
 	if (rc != EOK) {
 		ext4_filesystem_put_block_group_ref(bg_ref);
+		fibril_mutex_unlock(&fs->alloc_lock);
 		return rc;
 	}
 
@@ -666,6 +674,7 @@ errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t fblock
 	if (rc != EOK) {
 		/* Error in saving bitmap */
 		ext4_filesystem_put_block_group_ref(bg_ref);
+		fibril_mutex_unlock(&fs->alloc_lock);
 		return rc;
 	}
 
@@ -696,7 +705,9 @@ errno_t ext4_balloc_try_alloc_block(ext4_inode_ref_t *inode_ref, uint32_t fblock
 	bg_ref->dirty = true;
 
 terminate:
-	return ext4_filesystem_put_block_group_ref(bg_ref);
+	rc = ext4_filesystem_put_block_group_ref(bg_ref);
+	fibril_mutex_unlock(&fs->alloc_lock);
+	return rc;
 }
 
 /**
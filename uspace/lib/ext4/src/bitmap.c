@@ -264,6 +264,66 @@ errno_t ext4_bitmap_find_free_bit_and_set(uint8_t *bitmap, uint32_t start_idx,
 	return ENOSPC;
 }
 
+/** Find a run of free bits and set them as used.
+ *
+ * Walk through bitmap and look for the first run of at least @a want
+ * free bits. If there is none, the longest run found is used instead.
+ *
+ * @param bitmap Pointer to bitmap
+ * @param start  Index of bit, where the algorithm will begin
+ * @param max    Maximum index of bit in bitmap
+ * @param want   Requested number of bits
+ * @param index  Output value - index of the first set bit
+ * @param count  Output value - number of set bits (at most @a want)
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_bitmap_find_free_run_and_set(uint8_t *bitmap, uint32_t start,
+    uint32_t max, uint32_t want, uint32_t *index, uint32_t *count)
+{
+	uint32_t best_idx = 0;
+	uint32_t best_len = 0;
+	uint32_t run_idx = 0;
+	uint32_t run_len = 0;
+	uint32_t idx = start;
+
+	while (idx < max && best_len < want) {
+		/* Skip whole used bytes quickly */
+		if ((idx % 8) == 0 && bitmap[idx / 8] == 255) {
+			run_len = 0;
+			idx += 8;
+			continue;
+		}
+
+		if (ext4_bitmap_is_free_bit(bitmap, idx)) {
+			if (run_len == 0)
+				run_idx = idx;
+			run_len++;
+
+			if (run_len > best_len) {
+				best_idx = run_idx;
+				best_len = run_len;
+			}
+		} else {
+			run_len = 0;
+		}
+
+		idx++;
+	}
+
+	/* Free bit not found */
+	if (best_len == 0)
+		return ENOSPC;
+
+	for (uint32_t i = 0; i < best_len; i++)
+		ext4_bitmap_set_bit(bitmap, best_idx + i);
+
+	*index = best_idx;
+	*count = best_len;
+	return EOK;
+}
+
 /**
  * @}
  */
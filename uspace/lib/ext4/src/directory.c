@@ -447,9 +447,20 @@ errno_t ext4_directory_add_entry(ext4_inode_ref_t *parent, const char *name,
 
 	/* No free block found - needed to allocate next data block */
 
+	/* Index the directory once it outgrows its first block */
+	errno_t rc;
+	if ((ext4_superblock_has_feature_compatible(fs->superblock,
+	    EXT4_FEATURE_COMPAT_DIR_INDEX)) && (total_blocks == 1)) {
+		rc = ext4_directory_dx_make_indexed(parent);
+		if (rc == EOK)
+			return ext4_directory_dx_add_entry(parent, child, name);
+		if (rc != ENOTSUP)
+			return rc;
+	}
+
 	iblock = 0;
 	fblock = 0;
-	errno_t rc = ext4_filesystem_append_inode_block(parent, &fblock, &iblock);
+	rc = ext4_filesystem_append_inode_block(parent, &fblock, &iblock);
 	if (rc != EOK)
 		return rc;
 
@@ -235,27 +235,19 @@ void ext4_directory_dx_entry_set_block(ext4_directory_dx_entry_t *entry,
  * @return Error code
  *
  */
-errno_t ext4_directory_dx_init(ext4_inode_ref_t *dir)
+/** Fill in the root info and the limits of an empty index root.
+ *
+ * @param sb   Superblock
+ * @param root Index root in block 0 of the directory
+ *
+ */
+static void ext4_directory_dx_root_init(ext4_superblock_t *sb,
+    ext4_directory_dx_root_t *root)
 {
-	/* Load block 0, where will be index root located */
-	uint32_t fblock;
-	errno_t rc = ext4_filesystem_get_inode_data_block_index(dir, 0,
-	    &fblock);
-	if (rc != EOK)
-		return rc;
-
-	block_t *block;
-	rc = block_get(&block, dir->fs->device, fblock, BLOCK_FLAGS_NONE);
-	if (rc != EOK)
-		return rc;
-
-	/* Initialize pointers to data structures */
-	ext4_directory_dx_root_t *root = block->data;
 	ext4_directory_dx_root_info_t *info = &(root->info);
 
 	/* Initialize root info structure */
-	uint8_t hash_version =
-	    ext4_superblock_get_default_hash_version(dir->fs->superblock);
+	uint8_t hash_version = ext4_superblock_get_default_hash_version(sb);
 
 	ext4_directory_dx_root_info_set_hash_version(info, hash_version);
 	ext4_directory_dx_root_info_set_indirect_levels(info, 0);
@@ -266,13 +258,34 @@ errno_t ext4_directory_dx_init(ext4_inode_ref_t *dir)
 	    (ext4_directory_dx_countlimit_t *) &root->entries;
 	ext4_directory_dx_countlimit_set_count(countlimit, 1);
 
-	uint32_t block_size =
-	    ext4_superblock_get_block_size(dir->fs->superblock);
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
 	uint32_t entry_space =
 	    block_size - 2 * sizeof(ext4_directory_dx_dot_entry_t) -
 	    sizeof(ext4_directory_dx_root_info_t);
 	uint16_t root_limit = entry_space / sizeof(ext4_directory_dx_entry_t);
 	ext4_directory_dx_countlimit_set_limit(countlimit, root_limit);
+}
+
+errno_t ext4_directory_dx_init(ext4_inode_ref_t *dir)
+{
+	/* Load block 0, where will be index root located */
+	uint32_t fblock;
+	errno_t rc = ext4_filesystem_get_inode_data_block_index(dir, 0,
+	    &fblock);
+	if (rc != EOK)
+		return rc;
+
+	block_t *block;
+	rc = block_get(&block, dir->fs->device, fblock, BLOCK_FLAGS_NONE);
+	if (rc != EOK)
+		return rc;
+
+	/* Initialize pointers to data structures */
+	ext4_directory_dx_root_t *root = block->data;
+	ext4_directory_dx_root_init(dir->fs->superblock, root);
+
+	uint32_t block_size =
+	    ext4_superblock_get_block_size(dir->fs->superblock);
 
 	/* Append new block, where will be new entries inserted in the future */
 	uint32_t iblock;
@@ -310,6 +323,140 @@ errno_t ext4_directory_dx_init(ext4_inode_ref_t *dir)
 	return block_put(block);
 }
 
+/** Convert a linear directory of one block to an indexed one.
+ *
+ * The entries following '.' and '..' are moved to a new block, which
+ * becomes the only leaf of the index. The index root takes their place
+ * in the first block.
+ *
+ * @param dir Directory i-node
+ *
+ * @return Error code, ENOTSUP if the directory cannot be converted
+ *
+ */
+errno_t ext4_directory_dx_make_indexed(ext4_inode_ref_t *dir)
+{
+	ext4_superblock_t *sb = dir->fs->superblock;
+	uint32_t block_size = ext4_superblock_get_block_size(sb);
+
+	if (ext4_inode_get_size(sb, dir->inode) != block_size)
+		return ENOTSUP;
+
+	uint32_t fblock;
+	errno_t rc = ext4_filesystem_get_inode_data_block_index(dir, 0,
+	    &fblock);
+	if (rc != EOK)
+		return rc;
+
+	block_t *block;
+	rc = block_get(&block, dir->fs->device, fblock, BLOCK_FLAGS_NONE);
+	if (rc != EOK)
+		return rc;
+
+	/* The dot entries must already have the layout of the index root */
+	ext4_directory_dx_root_t *root = block->data;
+	ext4_directory_entry_ll_t *dot =
+	    (ext4_directory_entry_ll_t *) &root->dots[0];
+	ext4_directory_entry_ll_t *dotdot =
+	    (ext4_directory_entry_ll_t *) &root->dots[1];
+
+	uint16_t dotdot_len = ext4_directory_entry_ll_get_entry_length(dotdot);
+	if (ext4_directory_entry_ll_get_name_length(sb, dot) != 1 ||
+	    dot->name[0] != '.' ||
+	    ext4_directory_entry_ll_get_entry_length(dot) !=
+	    sizeof(ext4_directory_dx_dot_entry_t) ||
+	    ext4_directory_entry_ll_get_name_length(sb, dotdot) != 2 ||
+	    dotdot->name[0] != '.' || dotdot->name[1] != '.' ||
+	    dotdot_len < sizeof(ext4_directory_dx_dot_entry_t) ||
+	    sizeof(ext4_directory_dx_dot_entry_t) + dotdot_len > block_size) {
+		block_put(block);
+		return ENOTSUP;
+	}
+
+	/* Append the block, which will become the leaf */
+	uint32_t leaf_fblock;
+	uint32_t leaf_iblock;
+	rc = ext4_filesystem_append_inode_block(dir, &leaf_fblock,
+	    &leaf_iblock);
+	if (rc != EOK) {
+		block_put(block);
+		return rc;
+	}
+
+	block_t *leaf;
+	rc = block_get(&leaf, dir->fs->device, leaf_fblock, BLOCK_FLAGS_NOREAD);
+	if (rc != EOK) {
+		block_put(block);
+		return rc;
+	}
+
+	memset(leaf->data, 0, block_size);
+
+	/* Move the valid entries to the leaf, dropping the free space */
+	ext4_directory_entry_ll_t *last = NULL;
+	uint32_t dst = 0;
+	uint32_t off = sizeof(ext4_directory_dx_dot_entry_t) + dotdot_len;
+
+	while (off < block_size) {
+		ext4_directory_entry_ll_t *dentry = block->data + off;
+		uint16_t rec_len =
+		    ext4_directory_entry_ll_get_entry_length(dentry);
+
+		if (rec_len < sizeof(ext4_fake_directory_entry_t) ||
+		    off + rec_len > block_size)
+			break;
+
+		if (ext4_directory_entry_ll_get_inode(dentry) != 0) {
+			uint16_t used_len = sizeof(ext4_fake_directory_entry_t) +
+			    ext4_directory_entry_ll_get_name_length(sb, dentry);
+			if ((used_len % 4) != 0)
+				used_len += 4 - (used_len % 4);
+
+			last = leaf->data + dst;
+			memcpy(last, dentry, used_len);
+			ext4_directory_entry_ll_set_entry_length(last, used_len);
+			dst += used_len;
+		}
+
+		off += rec_len;
+	}
+
+	if (last != NULL) {
+		ext4_directory_entry_ll_set_entry_length(last,
+		    ext4_directory_entry_ll_get_entry_length(last) +
+		    block_size - dst);
+	} else {
+		last = leaf->data;
+		ext4_directory_entry_ll_set_entry_length(last, block_size);
+		ext4_directory_entry_ll_set_inode(last, 0);
+	}
+
+	leaf->dirty = true;
+	rc = block_put(leaf);
+	if (rc != EOK) {
+		block_put(block);
+		return rc;
+	}
+
+	/* Let '..' cover the rest of the block and build the root there */
+	ext4_directory_entry_ll_set_entry_length(dotdot,
+	    block_size - sizeof(ext4_directory_dx_dot_entry_t));
+	memset(&root->info, 0, block_size -
+	    2 * sizeof(ext4_directory_dx_dot_entry_t));
+	ext4_directory_dx_root_init(sb, root);
+	ext4_directory_dx_entry_set_block(root->entries, leaf_iblock);
+
+	block->dirty = true;
+	rc = block_put(block);
+	if (rc != EOK)
+		return rc;
+
+	ext4_inode_set_flag(dir->inode, EXT4_INODE_FLAG_INDEX);
+	dir->dirty = true;
+
+	return EOK;
+}
+
 /** Initialize hash info structure necessary for index operations.
  *
  * @param hinfo      Pointer to hinfo to be initialized
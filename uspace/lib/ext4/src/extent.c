@@ -360,19 +360,147 @@ static void ext4_extent_binsearch(ext4_extent_header_t *header,
 	*extent = l - 1;
 }
 
+/** Initialize an empty extent cache.
+ *
+ * @param cache Extent cache to initialize
+ *
+ */
+void ext4_extent_cache_init(ext4_extent_cache_t *cache)
+{
+	fibril_mutex_initialize(&cache->lock);
+	cache->count = 0;
+}
+
+/** Drop all entries of an extent cache.
+ *
+ * Must be called whenever the extent tree of the i-node changes.
+ *
+ * @param cache Extent cache to invalidate
+ *
+ */
+void ext4_extent_cache_invalidate(ext4_extent_cache_t *cache)
+{
+	fibril_mutex_lock(&cache->lock);
+	cache->count = 0;
+	fibril_mutex_unlock(&cache->lock);
+}
+
+/** Find the position of the last cached extent starting at or before iblock.
+ *
+ * @param cache  Extent cache (locked)
+ * @param iblock Logical block number
+ *
+ * @return Index of the entry following the found one (0 if there is none)
+ *
+ */
+static size_t ext4_extent_cache_search(ext4_extent_cache_t *cache,
+    uint32_t iblock)
+{
+	size_t l = 0;
+	size_t r = cache->count;
+
+	while (l < r) {
+		size_t m = l + (r - l) / 2;
+		if (cache->entries[m].first_block <= iblock)
+			l = m + 1;
+		else
+			r = m;
+	}
+
+	return l;
+}
+
+/** Look up a logical block in the extent cache.
+ *
+ * @param cache  Extent cache
+ * @param iblock Logical block number to find
+ * @param fblock Output value for physical block number
+ * @param count  Output value for the number of contiguous blocks (can be NULL)
+ *
+ * @return True if the block is covered by a cached extent
+ *
+ */
+static bool ext4_extent_cache_lookup(ext4_extent_cache_t *cache,
+    uint32_t iblock, uint32_t *fblock, uint32_t *count)
+{
+	bool found = false;
+
+	fibril_mutex_lock(&cache->lock);
+
+	size_t pos = ext4_extent_cache_search(cache, iblock);
+	if (pos > 0) {
+		ext4_extent_cache_entry_t *entry = &cache->entries[pos - 1];
+		uint32_t offset = iblock - entry->first_block;
+
+		if (offset < entry->block_count) {
+			*fblock = entry->start + offset;
+			if (count != NULL)
+				*count = entry->block_count - offset;
+			found = true;
+		}
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+	return found;
+}
+
+/** Insert an extent into the extent cache.
+ *
+ * When the cache is full, it is emptied first. Extents of a file are
+ * mostly visited in order, so there is little to gain from keeping the
+ * older ones.
+ *
+ * @param cache       Extent cache
+ * @param first_block First logical block of the extent
+ * @param start       First physical block of the extent
+ * @param block_count Number of blocks in the extent
+ *
+ */
+static void ext4_extent_cache_insert(ext4_extent_cache_t *cache,
+    uint32_t first_block, uint32_t start, uint32_t block_count)
+{
+	fibril_mutex_lock(&cache->lock);
+
+	size_t pos = ext4_extent_cache_search(cache, first_block);
+	if (pos > 0 && cache->entries[pos - 1].first_block == first_block) {
+		/* Already cached by a concurrent lookup */
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	if (cache->count == EXT4_EXTENT_CACHE_SIZE) {
+		cache->count = 0;
+		pos = 0;
+	}
+
+	memmove(&cache->entries[pos + 1], &cache->entries[pos],
+	    (cache->count - pos) * sizeof(ext4_extent_cache_entry_t));
+
+	cache->entries[pos].first_block = first_block;
+	cache->entries[pos].start = start;
+	cache->entries[pos].block_count = block_count;
+	cache->count++;
+
+	fibril_mutex_unlock(&cache->lock);
+}
+
 /** Find physical block in the extent tree by logical block number.
  *
  * There is no need to save path in the tree during this algorithm.
+ * Extents found in the tree are remembered in the extent cache of the
+ * i-node, so that further lookups within them need not walk the tree.
  *
  * @param inode_ref I-node to load block from
  * @param iblock    Logical block number to find
  * @param fblock    Output value for physical block number
+ * @param count     Output value for the number of blocks starting at iblock
+ *                  which are contiguous on the device (can be NULL)
  *
  * @return Error code
  *
  */
 errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
-    uint32_t *fblock)
+    uint32_t *fblock, uint32_t *count)
 {
 	errno_t rc = EOK;
 	/* Compute bound defined by i-node size */
@@ -384,12 +512,19 @@ errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
 
 	uint32_t last_idx = (inode_size - 1) / block_size;
 
+	if (count != NULL)
+		*count = 1;
+
 	/* Check if requested iblock is not over size of i-node */
 	if (iblock > last_idx) {
 		*fblock = 0;
 		return EOK;
 	}
 
+	if (ext4_extent_cache_lookup(&inode_ref->extent_cache, iblock, fblock,
+	    count))
+		return EOK;
+
 	block_t *block = NULL;
 
 	/* Walk through extent tree */
@@ -432,6 +567,15 @@ errno_t ext4_extent_find_block(ext4_inode_ref_t *inode_ref, uint32_t iblock,
 		phys_block = ext4_extent_get_start(extent) + iblock - first;
 
 		*fblock = phys_block;
+
+		uint32_t length = ext4_extent_get_block_count(extent);
+		if (iblock - first < length) {
+			if (count != NULL)
+				*count = length - (iblock - first);
+
+			ext4_extent_cache_insert(&inode_ref->extent_cache,
+			    first, ext4_extent_get_start(extent), length);
+		}
 	}
 
 	/* Cleanup */
@@ -619,6 +763,8 @@ static errno_t ext4_extent_release_branch(ext4_inode_ref_t *inode_ref,
 errno_t ext4_extent_release_blocks_from(ext4_inode_ref_t *inode_ref,
     uint32_t iblock_from)
 {
+	ext4_extent_cache_invalidate(&inode_ref->extent_cache);
+
 	/* Find the first extent to modify */
 	ext4_extent_path_t *path;
 	errno_t rc2;
@@ -968,6 +1114,8 @@ errno_t ext4_extent_append_block(ext4_inode_ref_t *inode_ref, uint32_t *iblock,
 	uint64_t inode_size = ext4_inode_get_size(sb, inode_ref->inode);
 	uint32_t block_size = ext4_superblock_get_block_size(sb);
 
+	ext4_extent_cache_invalidate(&inode_ref->extent_cache);
+
 	/* Calculate number of new logical block */
 	uint32_t new_block_idx = 0;
 	if (inode_size > 0) {
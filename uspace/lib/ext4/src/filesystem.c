@@ -36,6 +36,7 @@
  * @brief More complex filesystem operations.
  */
 
+#include <adt/checksum.h>
 #include <byteorder.h>
 #include <errno.h>
 #include <mem.h>
@@ -80,6 +81,7 @@ static errno_t ext4_filesystem_init(ext4_filesystem_t *fs, service_id_t service_
 	ext4_superblock_t *temp_superblock = NULL;
 
 	fs->device = service_id;
+	fibril_mutex_initialize(&fs->alloc_lock);
 
 	/* Initialize block library (4096 is size of communication channel) */
 	rc = block_init(fs->device, 4096);
@@ -1004,8 +1006,36 @@ static uint16_t ext4_filesystem_bg_checksum(ext4_superblock_t *sb, uint32_t bgid
 	/* If checksum not supported, 0 will be returned */
 	uint16_t crc = 0;
 
-	/* Compute the checksum only if the filesystem supports it */
+	/* Metadata checksums supersede the CRC16 of GDT_CSUM */
 	if (ext4_superblock_has_feature_read_only(sb,
+	    EXT4_FEATURE_RO_COMPAT_METADATA_CSUM)) {
+		uint8_t *base = (uint8_t *) bg;
+		uint32_t offset = (uint8_t *) &bg->checksum - base;
+		uint32_t desc_size = ext4_superblock_get_desc_size(sb);
+		uint32_t le_group = host2uint32_t_le(bgid);
+		uint16_t zero = 0;
+		uint32_t crc32;
+
+		/*
+		 * The checksum is the low half of the raw (not inverted)
+		 * CRC32C of the UUID, the group index and the descriptor with
+		 * a zero checksum field. Chaining the inverted CRC yields the
+		 * complement of the raw value.
+		 */
+		crc32 = compute_crc32c(sb->uuid, sizeof(sb->uuid));
+		crc32 = compute_crc32c_seed((uint8_t *) &le_group,
+		    sizeof(le_group), crc32);
+		crc32 = compute_crc32c_seed(base, offset, crc32);
+		crc32 = compute_crc32c_seed((uint8_t *) &zero, sizeof(zero),
+		    crc32);
+		offset += sizeof(bg->checksum);
+		if (offset < desc_size) {
+			crc32 = compute_crc32c_seed(base + offset,
+			    desc_size - offset, crc32);
+		}
+
+		crc = ~crc32 & 0xffff;
+	} else if (ext4_superblock_has_feature_read_only(sb,
 	    EXT4_FEATURE_RO_COMPAT_GDT_CSUM)) {
 		void *base = bg;
 		void *checksum = &bg->checksum;
@@ -1125,6 +1155,10 @@ errno_t ext4_filesystem_get_inode_ref(ext4_filesystem_t *fs, uint32_t index,
 	if (newref == NULL)
 		return ENOMEM;
 
+	ext4_extent_cache_init(&newref->extent_cache);
+	newref->prealloc_start = 0;
+	newref->prealloc_count = 0;
+
 	/* Compute number of i-nodes, that fits in one data block */
 	uint32_t inodes_per_group =
 	    ext4_superblock_get_inodes_per_group(fs->superblock);
@@ -1193,6 +1227,9 @@ errno_t ext4_filesystem_get_inode_ref(ext4_filesystem_t *fs, uint32_t index,
  */
 errno_t ext4_filesystem_put_inode_ref(ext4_inode_ref_t *ref)
 {
+	/* Give back blocks reserved for the growth of the file */
+	errno_t rc = ext4_balloc_discard_prealloc(ref);
+
 	/* Check if reference modified */
 	if (ref->dirty) {
 		/* Mark block dirty for writing changes to physical device */
@@ -1200,10 +1237,10 @@ errno_t ext4_filesystem_put_inode_ref(ext4_inode_ref_t *ref)
 	}
 
 	/* Put back block, that contains i-node */
-	errno_t rc = block_put(ref->block);
+	errno_t rc2 = block_put(ref->block);
 	free(ref);
 
-	return rc;
+	return rc == EOK ? rc2 : rc;
 }
 
 /** Initialize newly allocated i-node in the filesystem.
@@ -1538,6 +1575,11 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
 	if (old_size < new_size)
 		return EINVAL;
 
+	/* Blocks beyond the new end of the file would not be contiguous */
+	errno_t rc = ext4_balloc_discard_prealloc(inode_ref);
+	if (rc != EOK)
+		return rc;
+
 	/* Compute how many blocks will be released */
 	aoff64_t size_diff = old_size - new_size;
 	uint32_t block_size  = ext4_superblock_get_block_size(sb);
@@ -1553,7 +1595,7 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
 	    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
 	    (ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS))) {
 		/* Extents require special operation */
-		errno_t rc = ext4_extent_release_blocks_from(inode_ref,
+		rc = ext4_extent_release_blocks_from(inode_ref,
 		    old_blocks_count - diff_blocks_count);
 		if (rc != EOK)
 			return rc;
@@ -1562,7 +1604,7 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
 
 		/* Starting from 1 because of logical blocks are numbered from 0 */
 		for (uint32_t i = 1; i <= diff_blocks_count; ++i) {
-			errno_t rc = ext4_filesystem_release_inode_block(inode_ref,
+			rc = ext4_filesystem_release_inode_block(inode_ref,
 			    old_blocks_count - i);
 			if (rc != EOK)
 				return rc;
@@ -1587,9 +1629,33 @@ errno_t ext4_filesystem_truncate_inode(ext4_inode_ref_t *inode_ref,
  */
 errno_t ext4_filesystem_get_inode_data_block_index(ext4_inode_ref_t *inode_ref,
     aoff64_t iblock, uint32_t *fblock)
+{
+	return ext4_filesystem_get_inode_data_block_run(inode_ref, iblock,
+	    fblock, NULL);
+}
+
+/** Get physical block address and length of the run it starts.
+ *
+ * The run length is the number of blocks starting at iblock which are
+ * known to be contiguous on the device. It is only determined for i-nodes
+ * using extents, otherwise it is 1.
+ *
+ * @param inode_ref I-node to read block address from
+ * @param iblock    Logical index of block
+ * @param fblock    Output pointer for return physical block address
+ * @param count     Output pointer for the run length (can be NULL)
+ *
+ * @return Error code
+ *
+ */
+errno_t ext4_filesystem_get_inode_data_block_run(ext4_inode_ref_t *inode_ref,
+    aoff64_t iblock, uint32_t *fblock, uint32_t *count)
 {
 	ext4_filesystem_t *fs = inode_ref->fs;
 
+	if (count != NULL)
+		*count = 1;
+
 	/* For empty file is situation simple */
 	if (ext4_inode_get_size(fs->superblock, inode_ref->inode) == 0) {
 		*fblock = 0;
@@ -1602,7 +1668,8 @@ errno_t ext4_filesystem_get_inode_data_block_index(ext4_inode_ref_t *inode_ref,
 	if ((ext4_superblock_has_feature_incompatible(fs->superblock,
 	    EXT4_FEATURE_INCOMPAT_EXTENTS)) &&
 	    (ext4_inode_has_flag(inode_ref->inode, EXT4_INODE_FLAG_EXTENTS))) {
-		errno_t rc = ext4_extent_find_block(inode_ref, iblock, &current_block);
+		errno_t rc = ext4_extent_find_block(inode_ref, iblock,
+		    &current_block, count);
 		if (rc != EOK)
 			return rc;
 
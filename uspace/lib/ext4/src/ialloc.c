@@ -95,7 +95,8 @@ static uint32_t ext4_ialloc_get_bgid_of_inode(ext4_superblock_t *sb,
  * @param is_dir Flag us for information whether i-node is directory or not
  *
  */
-errno_t ext4_ialloc_free_inode(ext4_filesystem_t *fs, uint32_t index, bool is_dir)
+static errno_t ext4_ialloc_free_inode_locked(ext4_filesystem_t *fs,
+    uint32_t index, bool is_dir)
 {
 	ext4_superblock_t *sb = fs->superblock;
 
@@ -173,7 +174,8 @@ errno_t ext4_ialloc_free_inode(ext4_filesystem_t *fs, uint32_t index, bool is_di
  * @return Error code
  *
  */
-errno_t ext4_ialloc_alloc_inode(ext4_filesystem_t *fs, uint32_t *index, bool is_dir)
+static errno_t ext4_ialloc_alloc_inode_locked(ext4_filesystem_t *fs,
+    uint32_t *index, bool is_dir)
 {
 	int pick_first_free = 0;
 	ext4_superblock_t *sb = fs->superblock;
@@ -330,8 +332,8 @@ retry:
  * @return Error code
  *
  */
-errno_t ext4_ialloc_alloc_this_inode(ext4_filesystem_t *fs, uint32_t inode,
-    bool is_dir)
+static errno_t ext4_ialloc_alloc_this_inode_locked(ext4_filesystem_t *fs,
+    uint32_t inode, bool is_dir)
 {
 	ext4_superblock_t *sb = fs->superblock;
 
@@ -416,6 +418,39 @@ errno_t ext4_ialloc_alloc_this_inode(ext4_filesystem_t *fs, uint32_t inode,
 	return EOK;
 }
 
+/*
+ * The allocation lock of the file system serializes the changes of the
+ * i-node bitmaps and of the free i-node counts.
+ */
+
+errno_t ext4_ialloc_free_inode(ext4_filesystem_t *fs, uint32_t index, bool is_dir)
+{
+	fibril_mutex_lock(&fs->alloc_lock);
+	errno_t rc = ext4_ialloc_free_inode_locked(fs, index, is_dir);
+	fibril_mutex_unlock(&fs->alloc_lock);
+
+	return rc;
+}
+
+errno_t ext4_ialloc_alloc_inode(ext4_filesystem_t *fs, uint32_t *index, bool is_dir)
+{
+	fibril_mutex_lock(&fs->alloc_lock);
+	errno_t rc = ext4_ialloc_alloc_inode_locked(fs, index, is_dir);
+	fibril_mutex_unlock(&fs->alloc_lock);
+
+	return rc;
+}
+
+errno_t ext4_ialloc_alloc_this_inode(ext4_filesystem_t *fs, uint32_t inode,
+    bool is_dir)
+{
+	fibril_mutex_lock(&fs->alloc_lock);
+	errno_t rc = ext4_ialloc_alloc_this_inode_locked(fs, inode, is_dir);
+	fibril_mutex_unlock(&fs->alloc_lock);
+
+	return rc;
+}
+
 /**
  * @}
  */
@@ -55,6 +55,12 @@
 #include "ext4/fstypes.h"
 #include "ext4/superblock.h"
 
+/** Maximum number of bytes returned by one read of a file. */
+#define EXT4_READ_MAX_BYTES	(64 * 1024)
+
+/** Maximum number of names kept in the directory entry cache. */
+#define EXT4_DCACHE_MAX_ENTRIES	4096
+
 /* Forward declarations of auxiliary functions */
 
 static errno_t ext4_read_directory(ipc_call_t *, aoff64_t, size_t,
@@ -74,8 +80,11 @@ errno_t ext4_node_put(fs_node_t *);
 static errno_t ext4_create_node(fs_node_t **, service_id_t, int);
 static errno_t ext4_destroy_node(fs_node_t *);
 static errno_t ext4_link(fs_node_t *, fs_node_t *, const char *);
+static errno_t ext4_link_core(ext4_node_t *, ext4_node_t *, const char *);
 static errno_t ext4_unlink(fs_node_t *, fs_node_t *, const char *);
+static errno_t ext4_unlink_core(fs_node_t *, fs_node_t *, const char *);
 static errno_t ext4_has_children(bool *, fs_node_t *);
+static errno_t ext4_has_children_core(bool *, ext4_node_t *);
 static fs_index_t ext4_index_get(fs_node_t *);
 static aoff64_t ext4_size_get(fs_node_t *);
 static unsigned ext4_lnkcnt_get(fs_node_t *);
@@ -129,6 +138,213 @@ static hash_table_ops_t open_nodes_ops = {
 	.remove_callback = NULL,
 };
 
+/*
+ * Directory entry cache
+ *
+ * Maps names in directories to i-node numbers, so that repeated lookups
+ * of the same path components need not search the directories. Only
+ * entries found on the disk are cached, and they are dropped when the
+ * name is unlinked. The least recently used entries go first when the
+ * cache is full.
+ */
+
+typedef struct {
+	ht_link_t link;
+	link_t lru_link;
+	service_id_t service_id;
+	fs_index_t parent;
+	fs_index_t index;
+	char *name;
+} dcache_entry_t;
+
+typedef struct {
+	service_id_t service_id;
+	fs_index_t parent;
+	const char *name;
+} dcache_key_t;
+
+static hash_table_t dcache;
+static LIST_INITIALIZE(dcache_lru);
+static size_t dcache_count;
+static FIBRIL_MUTEX_INITIALIZE(dcache_lock);
+
+static size_t dcache_name_hash(service_id_t service_id, fs_index_t parent,
+    const char *name)
+{
+	size_t hash = hash_combine(service_id, parent);
+
+	while (*name != '\0')
+		hash = hash * 31 + (uint8_t) *name++;
+
+	return hash_mix(hash);
+}
+
+static size_t dcache_key_hash(const void *key_arg)
+{
+	const dcache_key_t *key = key_arg;
+	return dcache_name_hash(key->service_id, key->parent, key->name);
+}
+
+static size_t dcache_hash(const ht_link_t *item)
+{
+	dcache_entry_t *entry = hash_table_get_inst(item, dcache_entry_t, link);
+	return dcache_name_hash(entry->service_id, entry->parent, entry->name);
+}
+
+static bool dcache_key_equal(const void *key_arg, const ht_link_t *item)
+{
+	const dcache_key_t *key = key_arg;
+	dcache_entry_t *entry = hash_table_get_inst(item, dcache_entry_t, link);
+
+	return key->service_id == entry->service_id &&
+	    key->parent == entry->parent && str_cmp(key->name, entry->name) == 0;
+}
+
+static void dcache_remove_callback(ht_link_t *item)
+{
+	dcache_entry_t *entry = hash_table_get_inst(item, dcache_entry_t, link);
+
+	list_remove(&entry->lru_link);
+	dcache_count--;
+	free(entry->name);
+	free(entry);
+}
+
+static hash_table_ops_t dcache_ops = {
+	.hash = dcache_hash,
+	.key_hash = dcache_key_hash,
+	.key_equal = dcache_key_equal,
+	.equal = NULL,
+	.remove_callback = dcache_remove_callback,
+};
+
+/** Look up a name in the directory entry cache.
+ *
+ * @param service_id Device identifier
+ * @param parent     Index of the directory
+ * @param name       Name to look up
+ * @param index      Output value - index of the named node
+ *
+ * @return True if the name was found
+ *
+ */
+static bool dcache_lookup(service_id_t service_id, fs_index_t parent,
+    const char *name, fs_index_t *index)
+{
+	dcache_key_t key = {
+		.service_id = service_id,
+		.parent = parent,
+		.name = name
+	};
+
+	fibril_mutex_lock(&dcache_lock);
+
+	ht_link_t *link = hash_table_find(&dcache, &key);
+	if (link != NULL) {
+		dcache_entry_t *entry =
+		    hash_table_get_inst(link, dcache_entry_t, link);
+
+		/* Move to the front of the LRU list */
+		list_remove(&entry->lru_link);
+		list_prepend(&entry->lru_link, &dcache_lru);
+		*index = entry->index;
+	}
+
+	fibril_mutex_unlock(&dcache_lock);
+	return link != NULL;
+}
+
+/** Insert a name into the directory entry cache.
+ *
+ * Nothing happens when there is not enough memory.
+ *
+ * @param service_id Device identifier
+ * @param parent     Index of the directory
+ * @param name       Name of the entry
+ * @param index      Index of the named node
+ *
+ */
+static void dcache_insert(service_id_t service_id, fs_index_t parent,
+    const char *name, fs_index_t index)
+{
+	dcache_entry_t *entry = malloc(sizeof(dcache_entry_t));
+	if (entry == NULL)
+		return;
+
+	entry->name = str_dup(name);
+	if (entry->name == NULL) {
+		free(entry);
+		return;
+	}
+
+	entry->service_id = service_id;
+	entry->parent = parent;
+	entry->index = index;
+
+	dcache_key_t key = {
+		.service_id = service_id,
+		.parent = parent,
+		.name = name
+	};
+
+	fibril_mutex_lock(&dcache_lock);
+
+	/* Replace an entry for the same name */
+	hash_table_remove(&dcache, &key);
+
+	if (dcache_count >= EXT4_DCACHE_MAX_ENTRIES) {
+		dcache_entry_t *lru = list_get_instance(list_last(&dcache_lru),
+		    dcache_entry_t, lru_link);
+		hash_table_remove_item(&dcache, &lru->link);
+	}
+
+	hash_table_insert(&dcache, &entry->link);
+	list_prepend(&entry->lru_link, &dcache_lru);
+	dcache_count++;
+
+	fibril_mutex_unlock(&dcache_lock);
+}
+
+/** Remove a name from the directory entry cache.
+ *
+ * @param service_id Device identifier
+ * @param parent     Index of the directory
+ * @param name       Name of the entry
+ *
+ */
+static void dcache_remove(service_id_t service_id, fs_index_t parent,
+    const char *name)
+{
+	dcache_key_t key = {
+		.service_id = service_id,
+		.parent = parent,
+		.name = name
+	};
+
+	fibril_mutex_lock(&dcache_lock);
+	hash_table_remove(&dcache, &key);
+	fibril_mutex_unlock(&dcache_lock);
+}
+
+/** Remove all entries of a device from the directory entry cache.
+ *
+ * @param service_id Device identifier
+ *
+ */
+static void dcache_purge(service_id_t service_id)
+{
+	fibril_mutex_lock(&dcache_lock);
+
+	list_foreach_safe(dcache_lru, cur, next) {
+		dcache_entry_t *entry =
+		    list_get_instance(cur, dcache_entry_t, lru_link);
+		if (entry->service_id == service_id)
+			hash_table_remove_item(&dcache, &entry->link);
+	}
+
+	fibril_mutex_unlock(&dcache_lock);
+}
+
 /** Basic initialization of the driver.
  *
  * This is only needed to create the hash table
@@ -142,6 +358,11 @@ errno_t ext4_global_init(void)
 	if (!hash_table_create(&open_nodes, 0, 0, &open_nodes_ops))
 		return ENOMEM;
 
+	if (!hash_table_create(&dcache, 0, 0, &dcache_ops)) {
+		hash_table_destroy(&open_nodes);
+		return ENOMEM;
+	}
+
 	return EOK;
 }
 
@@ -153,6 +374,7 @@ errno_t ext4_global_init(void)
  */
 errno_t ext4_global_fini(void)
 {
+	hash_table_destroy(&dcache);
 	hash_table_destroy(&open_nodes);
 	return EOK;
 }
@@ -224,11 +446,23 @@ errno_t ext4_match(fs_node_t **rfn, fs_node_t *pfn, const char *component)
 	    EXT4_INODE_MODE_DIRECTORY))
 		return ENOTDIR;
 
+	service_id_t service_id = eparent->instance->service_id;
+	fs_index_t parent = eparent->inode_ref->index;
+	bool dots = ext4_is_dots((const uint8_t *) component,
+	    str_size(component));
+
+	fs_index_t index;
+	if (!dots && dcache_lookup(service_id, parent, component, &index))
+		return ext4_node_get_core(rfn, eparent->instance, index);
+
+	fibril_rwlock_read_lock(&eparent->lock);
+
 	/* Try to find entry */
 	ext4_directory_search_result_t result;
 	errno_t rc = ext4_directory_find_entry(&result, eparent->inode_ref,
 	    component);
 	if (rc != EOK) {
+		fibril_rwlock_read_unlock(&eparent->lock);
 		if (rc == ENOENT) {
 			*rfn = NULL;
 			return EOK;
@@ -243,9 +477,13 @@ errno_t ext4_match(fs_node_t **rfn, fs_node_t *pfn, const char *component)
 	if (rc != EOK)
 		goto exit;
 
+	if (!dots)
+		dcache_insert(service_id, parent, component, inode);
+
 exit:
 	/* Destroy search result structure */
 	rc2 = ext4_directory_destroy_result(&result);
+	fibril_rwlock_read_unlock(&eparent->lock);
 	return rc == EOK ? rc2 : rc;
 }
 
@@ -334,6 +572,7 @@ errno_t ext4_node_get_core(fs_node_t **rfn, ext4_instance_t *inst,
 	enode->instance = inst;
 	enode->references = 1;
 	enode->fs_node = fs_node;
+	fibril_rwlock_initialize(&enode->lock);
 
 	fs_node->data = enode;
 	*rfn = fs_node;
@@ -461,11 +700,12 @@ errno_t ext4_create_node(fs_node_t **rfn, service_id_t service_id, int flags)
 	enode->inode_ref = inode_ref;
 	enode->instance = inst;
 	enode->references = 1;
+	fibril_rwlock_initialize(&enode->lock);
 
 	fibril_mutex_lock(&open_nodes_lock);
 	hash_table_insert(&open_nodes, &enode->link);
-	fibril_mutex_unlock(&open_nodes_lock);
 	inst->open_nodes_count++;
+	fibril_mutex_unlock(&open_nodes_lock);
 
 	enode->inode_ref->dirty = true;
 
@@ -486,28 +726,26 @@ errno_t ext4_create_node(fs_node_t **rfn, service_id_t service_id, int flags)
  */
 errno_t ext4_destroy_node(fs_node_t *fn)
 {
+	ext4_node_t *enode = EXT4_NODE(fn);
+	ext4_inode_ref_t *inode_ref = enode->inode_ref;
+
+	fibril_rwlock_write_lock(&enode->lock);
+
 	/* If directory, check for children */
 	bool has_children;
-	errno_t rc = ext4_has_children(&has_children, fn);
-	if (rc != EOK) {
-		ext4_node_put(fn);
-		return rc;
-	}
+	errno_t rc = ext4_has_children_core(&has_children, enode);
+	if (rc != EOK)
+		goto error;
 
 	if (has_children) {
-		ext4_node_put(fn);
-		return EINVAL;
+		rc = EINVAL;
+		goto error;
 	}
 
-	ext4_node_t *enode = EXT4_NODE(fn);
-	ext4_inode_ref_t *inode_ref = enode->inode_ref;
-
 	/* Release data blocks */
 	rc = ext4_filesystem_truncate_inode(inode_ref, 0);
-	if (rc != EOK) {
-		ext4_node_put(fn);
-		return rc;
-	}
+	if (rc != EOK)
+		goto error;
 
 	/*
 	 * TODO: Sset real deletion time when it will be supported.
@@ -518,12 +756,16 @@ errno_t ext4_destroy_node(fs_node_t *fn)
 
 	/* Free inode */
 	rc = ext4_filesystem_free_inode(inode_ref);
-	if (rc != EOK) {
-		ext4_node_put(fn);
-		return rc;
-	}
+	if (rc != EOK)
+		goto error;
 
+	fibril_rwlock_write_unlock(&enode->lock);
 	return ext4_node_put(fn);
+
+error:
+	fibril_rwlock_write_unlock(&enode->lock);
+	ext4_node_put(fn);
+	return rc;
 }
 
 /** Link the specfied node to directory.
@@ -543,6 +785,31 @@ errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 
 	ext4_node_t *parent = EXT4_NODE(pfn);
 	ext4_node_t *child = EXT4_NODE(cfn);
+
+	/* Lock the parent first, the namespace lock of VFS orders the rest */
+	fibril_rwlock_write_lock(&parent->lock);
+	fibril_rwlock_write_lock(&child->lock);
+
+	errno_t rc = ext4_link_core(parent, child, name);
+
+	fibril_rwlock_write_unlock(&child->lock);
+	fibril_rwlock_write_unlock(&parent->lock);
+
+	return rc;
+}
+
+/** Link the specfied node to directory with both nodes locked.
+ *
+ * @param parent Parent node to link in
+ * @param child  Node to be linked
+ * @param name   Name which will be assigned to directory entry
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_link_core(ext4_node_t *parent, ext4_node_t *child,
+    const char *name)
+{
 	ext4_filesystem_t *fs = parent->instance->filesystem;
 
 	/* Add entry to parent directory */
@@ -609,9 +876,35 @@ errno_t ext4_link(fs_node_t *pfn, fs_node_t *cfn, const char *name)
  *
  */
 errno_t ext4_unlink(fs_node_t *pfn, fs_node_t *cfn, const char *name)
+{
+	ext4_node_t *parent = EXT4_NODE(pfn);
+	ext4_node_t *child = EXT4_NODE(cfn);
+
+	fibril_rwlock_write_lock(&parent->lock);
+	fibril_rwlock_write_lock(&child->lock);
+
+	errno_t rc = ext4_unlink_core(pfn, cfn, name);
+
+	fibril_rwlock_write_unlock(&child->lock);
+	fibril_rwlock_write_unlock(&parent->lock);
+
+	return rc;
+}
+
+/** Unlink node from specified directory with both nodes locked.
+ *
+ * @param pfn  Parent node to delete node from
+ * @param cfn  Child node to be unlinked from directory
+ * @param name Name of entry that will be removed
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_unlink_core(fs_node_t *pfn, fs_node_t *cfn,
+    const char *name)
 {
 	bool has_children;
-	errno_t rc = ext4_has_children(&has_children, cfn);
+	errno_t rc = ext4_has_children_core(&has_children, EXT4_NODE(cfn));
 	if (rc != EOK)
 		return rc;
 
@@ -625,6 +918,9 @@ errno_t ext4_unlink(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 	if (rc != EOK)
 		return rc;
 
+	dcache_remove(EXT4_NODE(pfn)->instance->service_id, parent->index,
+	    name);
+
 	/* Decrement links count */
 	ext4_inode_ref_t *child_inode_ref = EXT4_NODE(cfn)->inode_ref;
 
@@ -684,6 +980,24 @@ errno_t ext4_unlink(fs_node_t *pfn, fs_node_t *cfn, const char *name)
 errno_t ext4_has_children(bool *has_children, fs_node_t *fn)
 {
 	ext4_node_t *enode = EXT4_NODE(fn);
+
+	fibril_rwlock_read_lock(&enode->lock);
+	errno_t rc = ext4_has_children_core(has_children, enode);
+	fibril_rwlock_read_unlock(&enode->lock);
+
+	return rc;
+}
+
+/** Check if a locked node has children.
+ *
+ * @param has_children Output value for response
+ * @param enode        Node to check, locked by the caller
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_has_children_core(bool *has_children, ext4_node_t *enode)
+{
 	ext4_filesystem_t *fs = enode->instance->filesystem;
 
 	/* Check if node is directory */
@@ -888,7 +1202,8 @@ libfs_ops_t ext4_libfs_ops = {
 	.service_get = ext4_service_get,
 	.size_block = ext4_size_block,
 	.total_block_count = ext4_total_block_count,
-	.free_block_count = ext4_free_block_count
+	.free_block_count = ext4_free_block_count,
+	.cache_stats = block_get_stats
 };
 
 /*
@@ -1000,6 +1315,8 @@ static errno_t ext4_unmounted(service_id_t service_id)
 
 	fibril_mutex_unlock(&open_nodes_lock);
 
+	dcache_purge(service_id);
+
 	rc = ext4_filesystem_close(inst->filesystem);
 	if (rc != EOK) {
 		fibril_mutex_lock(&instance_list_mutex);
@@ -1034,20 +1351,19 @@ static errno_t ext4_read(service_id_t service_id, fs_index_t index, aoff64_t pos
 		return EINVAL;
 	}
 
-	ext4_instance_t *inst;
-	errno_t rc = ext4_instance_get(service_id, &inst);
+	/* Load the node, reads of it may run in parallel */
+	fs_node_t *fn;
+	errno_t rc = ext4_node_get(&fn, service_id, index);
 	if (rc != EOK) {
 		async_answer_0(&call, rc);
 		return rc;
 	}
 
-	/* Load i-node */
-	ext4_inode_ref_t *inode_ref;
-	rc = ext4_filesystem_get_inode_ref(inst->filesystem, index, &inode_ref);
-	if (rc != EOK) {
-		async_answer_0(&call, rc);
-		return rc;
-	}
+	ext4_node_t *enode = EXT4_NODE(fn);
+	ext4_instance_t *inst = enode->instance;
+	ext4_inode_ref_t *inode_ref = enode->inode_ref;
+
+	fibril_rwlock_read_lock(&enode->lock);
 
 	/* Read from i-node by type */
 	if (ext4_inode_is_type(inst->filesystem->superblock, inode_ref->inode,
@@ -1064,7 +1380,9 @@ static errno_t ext4_read(service_id_t service_id, fs_index_t index, aoff64_t pos
 		rc = ENOTSUP;
 	}
 
-	errno_t const rc2 = ext4_filesystem_put_inode_ref(inode_ref);
+	fibril_rwlock_read_unlock(&enode->lock);
+
+	errno_t const rc2 = ext4_node_put(fn);
 
 	return rc == EOK ? rc2 : rc;
 }
@@ -1204,7 +1522,7 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 		return EOK;
 	}
 
-	/* For now, we only read data from one block at a time */
+	/* Holes are read one block at a time */
 	uint32_t block_size = ext4_superblock_get_block_size(sb);
 	aoff64_t file_block = pos / block_size;
 	uint32_t offset_in_block = pos % block_size;
@@ -1216,8 +1534,9 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 
 	/* Get the real block number */
 	uint32_t fs_block;
-	errno_t rc = ext4_filesystem_get_inode_data_block_index(inode_ref,
-	    file_block, &fs_block);
+	uint32_t run;
+	errno_t rc = ext4_filesystem_get_inode_data_block_run(inode_ref,
+	    file_block, &fs_block, &run);
 	if (rc != EOK) {
 		async_answer_0(call, rc);
 		return rc;
@@ -1246,24 +1565,75 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 		return rc;
 	}
 
-	/* Usual case - we need to read a block from device */
-	block_t *block;
-	rc = block_get(&block, inst->service_id, fs_block, BLOCK_FLAGS_NONE);
+	/*
+	 * Read as much of the extent as requested at once, but no more than
+	 * fits into a single data transfer.
+	 */
+	size_t want = min(size, file_size - pos);
+	size_t cnt = (offset_in_block + want + block_size - 1) / block_size;
+	cnt = min(cnt, run);
+	cnt = min(cnt, max(EXT4_READ_MAX_BYTES / block_size, 1));
+	bytes = min(want, cnt * block_size - offset_in_block);
+
+	/*
+	 * Let the block cache read ahead the rest of the extent, as far as
+	 * it belongs to the file.
+	 */
+	aoff64_t left = (file_size - 1) / block_size - file_block;
+	if (run > cnt && left >= cnt)
+		block_readahead(inst->service_id, fs_block + cnt,
+		    min(run - cnt, left - cnt + 1));
+
+	block_t *one;
+	block_t **blocks = &one;
+	if (cnt > 1) {
+		blocks = calloc(cnt, sizeof(block_t *));
+		if (blocks == NULL) {
+			/* Make do with the first block. */
+			blocks = &one;
+			bytes = min(bytes, block_size - offset_in_block);
+			cnt = 1;
+		}
+	}
+
+	/* Usual case - we need to read blocks from device */
+	rc = block_get_range(blocks, inst->service_id, fs_block, cnt,
+	    BLOCK_FLAGS_NONE);
 	if (rc != EOK) {
+		if (blocks != &one)
+			free(blocks);
 		async_answer_0(call, rc);
 		return rc;
 	}
 
-	assert(offset_in_block + bytes <= block_size);
-	rc = async_data_read_finalize(call, block->data + offset_in_block, bytes);
-	if (rc != EOK) {
-		block_put(block);
-		return rc;
+	buffer = NULL;
+	if (cnt > 1)
+		buffer = malloc(bytes);
+
+	if (buffer != NULL) {
+		size_t done = 0;
+		for (size_t i = 0; i < cnt; i++) {
+			size_t from = (i == 0) ? offset_in_block : 0;
+			size_t n = min(block_size - from, bytes - done);
+
+			memcpy(buffer + done, blocks[i]->data + from, n);
+			done += n;
+		}
+		rc = async_data_read_finalize(call, buffer, bytes);
+		free(buffer);
+	} else {
+		bytes = min(bytes, block_size - offset_in_block);
+		rc = async_data_read_finalize(call,
+		    blocks[0]->data + offset_in_block, bytes);
 	}
 
-	rc = block_put(block);
+	errno_t rc2 = block_put_range(blocks, cnt);
+	if (blocks != &one)
+		free(blocks);
 	if (rc != EOK)
 		return rc;
+	if (rc2 != EOK)
+		return rc2;
 
 	*rbytes = bytes;
 	return EOK;
@@ -1300,6 +1670,8 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	ext4_node_t *enode = EXT4_NODE(fn);
 	ext4_filesystem_t *fs = enode->instance->filesystem;
 
+	fibril_rwlock_write_lock(&enode->lock);
+
 	uint32_t block_size = ext4_superblock_get_block_size(fs->superblock);
 
 	/* Prevent writing to more than one block */
@@ -1318,7 +1690,7 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	    &fblock);
 	if (rc != EOK) {
 		async_answer_0(&call, rc);
-		goto exit;
+		goto unlock;
 	}
 
 	/* Check for sparse file */
@@ -1335,7 +1707,7 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 				    &fblock, true);
 				if (rc != EOK) {
 					async_answer_0(&call, rc);
-					goto exit;
+					goto unlock;
 				}
 			}
 
@@ -1343,13 +1715,13 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 			    &fblock, false);
 			if (rc != EOK) {
 				async_answer_0(&call, rc);
-				goto exit;
+				goto unlock;
 			}
 		} else {
 			rc = ext4_balloc_alloc_block(inode_ref, &fblock);
 			if (rc != EOK) {
 				async_answer_0(&call, rc);
-				goto exit;
+				goto unlock;
 			}
 
 			rc = ext4_filesystem_set_inode_data_block_index(inode_ref,
@@ -1357,7 +1729,7 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 			if (rc != EOK) {
 				ext4_balloc_free_block(inode_ref, fblock);
 				async_answer_0(&call, rc);
-				goto exit;
+				goto unlock;
 			}
 		}
 
@@ -1370,7 +1742,7 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	rc = block_get(&write_block, service_id, fblock, flags);
 	if (rc != EOK) {
 		async_answer_0(&call, rc);
-		goto exit;
+		goto unlock;
 	}
 
 	if (flags == BLOCK_FLAGS_NOREAD)
@@ -1380,14 +1752,14 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	    (pos % block_size), bytes);
 	if (rc != EOK) {
 		block_put(write_block);
-		goto exit;
+		goto unlock;
 	}
 
 	write_block->dirty = true;
 
 	rc = block_put(write_block);
 	if (rc != EOK)
-		goto exit;
+		goto unlock;
 
 	/* Do some counting */
 	uint32_t old_inode_size = ext4_inode_get_size(fs->superblock,
@@ -1400,6 +1772,8 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	*nsize = ext4_inode_get_size(fs->superblock, inode_ref->inode);
 	*wbytes = bytes;
 
+unlock:
+	fibril_rwlock_write_unlock(&enode->lock);
 exit:
 	rc2 = ext4_node_put(fn);
 	return rc == EOK ? rc2 : rc;
@@ -1427,7 +1801,10 @@ static errno_t ext4_truncate(service_id_t service_id, fs_index_t index,
 	ext4_node_t *enode = EXT4_NODE(fn);
 	ext4_inode_ref_t *inode_ref = enode->inode_ref;
 
+	fibril_rwlock_write_lock(&enode->lock);
 	rc = ext4_filesystem_truncate_inode(inode_ref, new_size);
+	fibril_rwlock_write_unlock(&enode->lock);
+
 	errno_t const rc2 = ext4_node_put(fn);
 
 	return rc == EOK ? rc2 : rc;
@@ -0,0 +1,3 @@
+/** @addtogroup libfcopy libfcopy
+ * @ingroup libs
+ */
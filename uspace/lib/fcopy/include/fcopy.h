@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libfcopy
+ * @{
+ */
+/**
+ * @file
+ * @brief Parallel file copying engine
+ */
+
+#ifndef LIBFCOPY_FCOPY_H_
+#define LIBFCOPY_FCOPY_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Default number of files copied concurrently */
+#define FCOPY_COPIERS  4
+
+/** Default size of the buffer of each copier */
+#define FCOPY_BUF_SIZE  (2 * 1024 * 1024)
+
+/** Copy progress callbacks */
+typedef struct {
+	/** Entry is about to be copied, @a dir if it is a directory */
+	void (*copy)(void *arg, const char *src, const char *dest, bool dir);
+	/** Copying an entry failed with @a rc */
+	void (*error)(void *arg, const char *src, const char *dest, errno_t rc);
+} fcopy_cb_t;
+
+/** Copy configuration */
+typedef struct {
+	/** Number of files copied concurrently */
+	size_t copiers;
+	/** Size of the buffer of each copier */
+	size_t buf_size;
+	/** Overwrite existing files instead of failing with EEXIST */
+	bool overwrite;
+	/** Callbacks or @c NULL */
+	fcopy_cb_t *cb;
+	/** Argument to the callbacks */
+	void *arg;
+} fcopy_cfg_t;
+
+extern void fcopy_cfg_init(fcopy_cfg_t *);
+extern errno_t fcopy_file(fcopy_cfg_t *, const char *, const char *);
+extern errno_t fcopy_tree(fcopy_cfg_t *, const char *, const char *);
+
+#endif
+
+/** @}
+ */
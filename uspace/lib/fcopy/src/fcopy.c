@@ -0,0 +1,692 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libfcopy
+ * @{
+ */
+/**
+ * @file Parallel file copying engine
+ *
+ * The calling fibril walks the source tree ahead of the copiers. It
+ * creates the destination directories and queues regular files for a
+ * pool of copier fibrils, so that several files are in flight at once.
+ * Each copier owns one large buffer. Large files are transferred through
+ * the buffer shared with VFS, which avoids copying the data in IPC
+ * messages. The destination is synchronized only once, at the end.
+ */
+
+#include <adt/list.h>
+#include <as.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcopy.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <vfs/vfs.h>
+
+/** Maximum number of files queued ahead of the copiers */
+#define FCOPY_QUEUE_MAX  64
+
+/** Smallest file copied through the buffer shared with VFS */
+#define FCOPY_SHARED_MIN  (64 * 1024)
+
+/** File queued for copying */
+typedef struct {
+	/** Link to fcopy_t.jobs */
+	link_t ljobs;
+	/** Source path */
+	char *src;
+	/** Destination path */
+	char *dest;
+	/** Size of the source file */
+	aoff64_t size;
+} fcopy_job_t;
+
+/** Tree copy in progress */
+typedef struct {
+	/** Configuration */
+	fcopy_cfg_t *cfg;
+	/** Protects the fields below */
+	fibril_mutex_t lock;
+	/** Signalled when a job is queued or the walk is finished */
+	fibril_condvar_t jobs_cv;
+	/** Signalled when a job is taken or a copier exits */
+	fibril_condvar_t done_cv;
+	/** Queued jobs, fcopy_job_t */
+	list_t jobs;
+	/** Number of queued jobs */
+	size_t njobs;
+	/** No more jobs will be queued */
+	bool walk_done;
+	/** Number of running copiers */
+	size_t copiers;
+	/** First error */
+	errno_t rc;
+	/** Destination root directory */
+	vfs_stat_t dest_st;
+} fcopy_t;
+
+/** Copier */
+typedef struct {
+	/** Configuration */
+	fcopy_cfg_t *cfg;
+	/** Tree copy or @c NULL when copying a single file */
+	fcopy_t *fcopy;
+	/** Copy buffer, an address space area */
+	void *buf;
+	/** Size of @c buf */
+	size_t size;
+} fcopy_copier_t;
+
+/** Initialize copy configuration with the defaults.
+ *
+ * @param cfg Configuration
+ */
+void fcopy_cfg_init(fcopy_cfg_t *cfg)
+{
+	cfg->copiers = FCOPY_COPIERS;
+	cfg->buf_size = FCOPY_BUF_SIZE;
+	cfg->overwrite = false;
+	cfg->cb = NULL;
+	cfg->arg = NULL;
+}
+
+/** Report that an entry is about to be copied.
+ *
+ * @param cfg  Configuration
+ * @param src  Source path
+ * @param dest Destination path
+ * @param dir  @c true if the entry is a directory
+ */
+static void fcopy_report_copy(fcopy_cfg_t *cfg, const char *src,
+    const char *dest, bool dir)
+{
+	if (cfg->cb != NULL && cfg->cb->copy != NULL)
+		cfg->cb->copy(cfg->arg, src, dest, dir);
+}
+
+/** Report that copying an entry failed.
+ *
+ * @param cfg  Configuration
+ * @param src  Source path
+ * @param dest Destination path
+ * @param rc   Error code
+ */
+static void fcopy_report_error(fcopy_cfg_t *cfg, const char *src,
+    const char *dest, errno_t rc)
+{
+	if (cfg->cb != NULL && cfg->cb->error != NULL)
+		cfg->cb->error(cfg->arg, src, dest, rc);
+}
+
+/** Record and report a failure of a tree copy.
+ *
+ * Only the first error is returned by fcopy_tree(), the remaining
+ * queued files are skipped.
+ *
+ * @param fcopy Tree copy
+ * @param src   Source path
+ * @param dest  Destination path
+ * @param rc    Error code
+ */
+static void fcopy_fail(fcopy_t *fcopy, const char *src, const char *dest,
+    errno_t rc)
+{
+	fibril_mutex_lock(&fcopy->lock);
+	if (fcopy->rc == EOK)
+		fcopy->rc = rc;
+	fibril_mutex_unlock(&fcopy->lock);
+
+	fcopy_report_error(fcopy->cfg, src, dest, rc);
+}
+
+/** Determine whether a tree copy has failed.
+ *
+ * @param fcopy Tree copy
+ * @return @c true if an error has been recorded
+ */
+static bool fcopy_failed(fcopy_t *fcopy)
+{
+	fibril_mutex_lock(&fcopy->lock);
+	bool failed = (fcopy->rc != EOK);
+	fibril_mutex_unlock(&fcopy->lock);
+
+	return failed;
+}
+
+/** Create a copier.
+ *
+ * @param cfg     Configuration
+ * @param fcopy   Tree copy or @c NULL
+ * @param size    Buffer size
+ * @param rcopier Place to store pointer to the new copier
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t fcopy_copier_create(fcopy_cfg_t *cfg, fcopy_t *fcopy,
+    size_t size, fcopy_copier_t **rcopier)
+{
+	fcopy_copier_t *copier = calloc(1, sizeof(fcopy_copier_t));
+	if (copier == NULL)
+		return ENOMEM;
+
+	/* Unpaged, so that it can be shared with VFS */
+	copier->buf = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (copier->buf == AS_MAP_FAILED) {
+		free(copier);
+		return ENOMEM;
+	}
+
+	copier->cfg = cfg;
+	copier->fcopy = fcopy;
+	copier->size = size;
+	*rcopier = copier;
+	return EOK;
+}
+
+/** Destroy a copier.
+ *
+ * @param copier Copier
+ */
+static void fcopy_copier_destroy(fcopy_copier_t *copier)
+{
+	as_area_destroy(copier->buf);
+	free(copier);
+}
+
+/** Copy file data through the buffer shared with VFS.
+ *
+ * @param copier Copier
+ * @param sf     Source file handle
+ * @param df     Destination file handle
+ * @param posw   Place to store the number of bytes written
+ * @param rc     Place to store the result of the copy
+ *
+ * @return @c false if the buffer could not be shared and no data
+ *         has been copied, @c true otherwise
+ */
+static bool fcopy_data_shared(fcopy_copier_t *copier, int sf, int df,
+    aoff64_t *posw, errno_t *rc)
+{
+	aoff64_t posr = 0;
+	size_t nr, nw;
+
+	if (vfs_buffer_register(sf, copier->buf) != EOK)
+		return false;
+
+	if (vfs_buffer_register(df, copier->buf) != EOK) {
+		vfs_buffer_unregister(sf);
+		return false;
+	}
+
+	while ((*rc = vfs_read_buffer(sf, &posr, copier->size, &nr)) == EOK &&
+	    nr > 0) {
+		*rc = vfs_write_buffer(df, posw, nr, &nw);
+		if (*rc == EOK && nw < nr)
+			*rc = EIO;
+		if (*rc != EOK)
+			break;
+	}
+
+	vfs_buffer_unregister(sf);
+	vfs_buffer_unregister(df);
+	return true;
+}
+
+/** Copy file data.
+ *
+ * @param copier Copier
+ * @param sf     Source file handle
+ * @param df     Destination file handle
+ * @param size   Size of the source file
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t fcopy_data(fcopy_copier_t *copier, int sf, int df,
+    aoff64_t size)
+{
+	aoff64_t posr = 0, posw = 0;
+	size_t nr, nw;
+	errno_t rc;
+
+	/*
+	 * Let the file system allocate the whole file at once. Not all
+	 * file systems can grow a file this way, the writes allocate
+	 * the space then.
+	 */
+	(void) vfs_resize(df, size);
+
+	if (size < FCOPY_SHARED_MIN ||
+	    !fcopy_data_shared(copier, sf, df, &posw, &rc)) {
+		while ((rc = vfs_read(sf, &posr, copier->buf, copier->size,
+		    &nr)) == EOK && nr > 0) {
+			rc = vfs_write(df, &posw, copier->buf, nr, &nw);
+			if (rc != EOK)
+				break;
+		}
+	}
+
+	if (rc != EOK)
+		return rc;
+
+	/* Drop any data beyond the copy, e.g. of an overwritten file */
+	return vfs_resize(df, posw);
+}
+
+/** Copy a regular file.
+ *
+ * @param copier Copier
+ * @param src    Source path
+ * @param dest   Destination path
+ * @param size   Size of the source file
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t fcopy_copy(fcopy_copier_t *copier, const char *src,
+    const char *dest, aoff64_t size)
+{
+	int sf, df;
+	errno_t rc;
+
+	fcopy_report_copy(copier->cfg, src, dest, false);
+
+	rc = vfs_lookup_open(src, WALK_REGULAR, MODE_READ, &sf);
+	if (rc != EOK)
+		return rc;
+
+	rc = vfs_lookup_open(dest, WALK_REGULAR | (copier->cfg->overwrite ?
+	    WALK_MAY_CREATE : WALK_MUST_CREATE), MODE_WRITE, &df);
+	if (rc != EOK) {
+		vfs_put(sf);
+		return rc;
+	}
+
+	rc = fcopy_data(copier, sf, df, size);
+
+	(void) vfs_put(sf);
+
+	errno_t rc2 = vfs_put(df);
+	return (rc != EOK) ? rc : rc2;
+}
+
+/** Synchronize a copy destination.
+ *
+ * @param path Destination path
+ * @return EOK on success or an error code
+ */
+static errno_t fcopy_sync(const char *path)
+{
+	int fd;
+
+	errno_t rc = vfs_lookup(path, 0, &fd);
+	if (rc != EOK)
+		return rc;
+
+	rc = vfs_sync(fd);
+	(void) vfs_put(fd);
+	return rc;
+}
+
+/** Copier fibril.
+ *
+ * Copies queued files until the walk is finished and the queue is empty.
+ *
+ * @param arg Copier
+ * @return EOK
+ */
+static errno_t fcopy_copier_fibril(void *arg)
+{
+	fcopy_copier_t *copier = (fcopy_copier_t *) arg;
+	fcopy_t *fcopy = copier->fcopy;
+
+	fibril_mutex_lock(&fcopy->lock);
+
+	while (true) {
+		while (list_empty(&fcopy->jobs) && !fcopy->walk_done)
+			fibril_condvar_wait(&fcopy->jobs_cv, &fcopy->lock);
+
+		link_t *link = list_first(&fcopy->jobs);
+		if (link == NULL)
+			break;
+
+		list_remove(link);
+		fcopy->njobs--;
+		fibril_condvar_broadcast(&fcopy->done_cv);
+
+		/* Skip the remaining files after a failure */
+		bool failed = (fcopy->rc != EOK);
+		fibril_mutex_unlock(&fcopy->lock);
+
+		fcopy_job_t *job = list_get_instance(link, fcopy_job_t, ljobs);
+		if (!failed) {
+			errno_t rc = fcopy_copy(copier, job->src, job->dest,
+			    job->size);
+			if (rc != EOK)
+				fcopy_fail(fcopy, job->src, job->dest, rc);
+		}
+
+		free(job->src);
+		free(job->dest);
+		free(job);
+
+		fibril_mutex_lock(&fcopy->lock);
+	}
+
+	fcopy->copiers--;
+	fibril_condvar_broadcast(&fcopy->done_cv);
+	fibril_mutex_unlock(&fcopy->lock);
+
+	fcopy_copier_destroy(copier);
+	return EOK;
+}
+
+/** Start the copier fibrils of a tree copy.
+ *
+ * @param fcopy Tree copy
+ * @return EOK if at least one copier is running, ENOMEM otherwise
+ */
+static errno_t fcopy_start(fcopy_t *fcopy)
+{
+	size_t count = max(fcopy->cfg->copiers, (size_t) 1);
+
+	for (size_t i = 0; i < count; i++) {
+		fcopy_copier_t *copier;
+
+		if (fcopy_copier_create(fcopy->cfg, fcopy,
+		    fcopy->cfg->buf_size, &copier) != EOK)
+			break;
+
+		fid_t fid = fibril_create(fcopy_copier_fibril, copier);
+		if (fid == 0) {
+			fcopy_copier_destroy(copier);
+			break;
+		}
+
+		fibril_mutex_lock(&fcopy->lock);
+		fcopy->copiers++;
+		fibril_mutex_unlock(&fcopy->lock);
+
+		fibril_add_ready(fid);
+	}
+
+	return (fcopy->copiers > 0) ? EOK : ENOMEM;
+}
+
+/** Finish a tree copy.
+ *
+ * Wait for the copiers to process the remaining queued files.
+ *
+ * @param fcopy Tree copy
+ * @return EOK on success or the first error
+ */
+static errno_t fcopy_finish(fcopy_t *fcopy)
+{
+	fibril_mutex_lock(&fcopy->lock);
+
+	fcopy->walk_done = true;
+	fibril_condvar_broadcast(&fcopy->jobs_cv);
+
+	while (fcopy->copiers > 0)
+		fibril_condvar_wait(&fcopy->done_cv, &fcopy->lock);
+
+	errno_t rc = fcopy->rc;
+	fibril_mutex_unlock(&fcopy->lock);
+
+	return rc;
+}
+
+/** Queue a regular file for copying.
+ *
+ * Blocks while too many files are queued already.
+ *
+ * @param fcopy Tree copy
+ * @param job   Job, ownership passes to the copiers
+ */
+static void fcopy_queue(fcopy_t *fcopy, fcopy_job_t *job)
+{
+	fibril_mutex_lock(&fcopy->lock);
+
+	while (fcopy->njobs >= FCOPY_QUEUE_MAX)
+		fibril_condvar_wait(&fcopy->done_cv, &fcopy->lock);
+
+	list_append(&job->ljobs, &fcopy->jobs);
+	fcopy->njobs++;
+	fibril_condvar_signal(&fcopy->jobs_cv);
+
+	fibril_mutex_unlock(&fcopy->lock);
+}
+
+static errno_t fcopy_walk(fcopy_t *, const char *, const char *);
+
+/** Create a destination directory and walk the source directory.
+ *
+ * An existing destination directory is merged into.
+ *
+ * @param fcopy Tree copy
+ * @param src   Source directory
+ * @param dest  Destination directory
+ * @param st    Status of the source directory
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t fcopy_walk_dir(fcopy_t *fcopy, const char *src,
+    const char *dest, vfs_stat_t *st)
+{
+	vfs_stat_t dest_st;
+	errno_t rc;
+
+	/* Do not copy the destination into itself */
+	if (st->fs_handle == fcopy->dest_st.fs_handle &&
+	    st->service_id == fcopy->dest_st.service_id &&
+	    st->index == fcopy->dest_st.index)
+		return ELOOP;
+
+	fcopy_report_copy(fcopy->cfg, src, dest, true);
+
+	rc = vfs_link_path(dest, KIND_DIRECTORY, NULL);
+	if (rc == EEXIST) {
+		rc = vfs_stat_path(dest, &dest_st);
+		if (rc == EOK && !dest_st.is_directory)
+			rc = EEXIST;
+	}
+
+	if (rc != EOK)
+		return rc;
+
+	return fcopy_walk(fcopy, src, dest);
+}
+
+/** Walk a source directory.
+ *
+ * Directories are created as they are found, regular files
+ * are queued for the copiers.
+ *
+ * @param fcopy  Tree copy
+ * @param srcdir Source directory
+ * @param destdir Destination directory
+ *
+ * @return EOK on success or an error code, which has been
+ *         reported already
+ */
+static errno_t fcopy_walk(fcopy_t *fcopy, const char *srcdir,
+    const char *destdir)
+{
+	struct dirent *de;
+	errno_t rc = EOK;
+
+	DIR *dir = opendir(srcdir);
+	if (dir == NULL) {
+		fcopy_fail(fcopy, srcdir, destdir, EIO);
+		return EIO;
+	}
+
+	while ((de = readdir(dir)) != NULL && !fcopy_failed(fcopy)) {
+		fcopy_job_t *job = calloc(1, sizeof(fcopy_job_t));
+		if (job == NULL) {
+			rc = ENOMEM;
+			fcopy_fail(fcopy, srcdir, destdir, rc);
+			break;
+		}
+
+		if (asprintf(&job->src, "%s/%s", srcdir, de->d_name) < 0 ||
+		    asprintf(&job->dest, "%s/%s", destdir, de->d_name) < 0) {
+			free(job->src);
+			free(job);
+			rc = ENOMEM;
+			fcopy_fail(fcopy, srcdir, destdir, rc);
+			break;
+		}
+
+		vfs_stat_t st;
+		rc = vfs_stat_path(job->src, &st);
+		if (rc == EOK && st.is_file) {
+			job->size = st.size;
+			fcopy_queue(fcopy, job);
+			continue;
+		}
+
+		if (rc == EOK && st.is_directory) {
+			rc = fcopy_walk_dir(fcopy, job->src, job->dest, &st);
+			/* Errors of the walk below are reported already */
+			if (rc != EOK && !fcopy_failed(fcopy))
+				fcopy_fail(fcopy, job->src, job->dest, rc);
+		} else {
+			if (rc == EOK)
+				rc = EIO;
+			fcopy_fail(fcopy, job->src, job->dest, rc);
+		}
+
+		free(job->src);
+		free(job->dest);
+		free(job);
+
+		if (rc != EOK)
+			break;
+	}
+
+	closedir(dir);
+	return rc;
+}
+
+/** Copy a regular file.
+ *
+ * @param cfg  Configuration
+ * @param src  Source path
+ * @param dest Destination path
+ *
+ * @return EOK on success, EEXIST if the destination exists and
+ *         overwriting is not allowed or another error code
+ */
+errno_t fcopy_file(fcopy_cfg_t *cfg, const char *src, const char *dest)
+{
+	fcopy_copier_t *copier;
+	vfs_stat_t st;
+	errno_t rc;
+
+	rc = vfs_stat_path(src, &st);
+	if (rc == EOK && !st.is_file)
+		rc = EISDIR;
+	if (rc != EOK)
+		goto error;
+
+	/* Do not map a large buffer for a small file */
+	size_t size = cfg->buf_size;
+	if (st.size < size)
+		size = max(st.size, 1);
+
+	rc = fcopy_copier_create(cfg, NULL, size, &copier);
+	if (rc != EOK)
+		goto error;
+
+	rc = fcopy_copy(copier, src, dest, st.size);
+	fcopy_copier_destroy(copier);
+	if (rc != EOK)
+		goto error;
+
+	return fcopy_sync(dest);
+error:
+	fcopy_report_error(cfg, src, dest, rc);
+	return rc;
+}
+
+/** Copy contents of a directory recursively.
+ *
+ * The destination directory is created if it does not exist. Existing
+ * subdirectories of the destination are merged into.
+ *
+ * @param cfg     Configuration
+ * @param srcdir  Source directory
+ * @param destdir Destination directory
+ *
+ * @return EOK on success, ELOOP if @a destdir is inside @a srcdir,
+ *         ENOMEM if out of memory or another error code
+ */
+errno_t fcopy_tree(fcopy_cfg_t *cfg, const char *srcdir, const char *destdir)
+{
+	fcopy_t fcopy;
+	errno_t rc;
+
+	memset(&fcopy, 0, sizeof(fcopy));
+	fcopy.cfg = cfg;
+	fibril_mutex_initialize(&fcopy.lock);
+	fibril_condvar_initialize(&fcopy.jobs_cv);
+	fibril_condvar_initialize(&fcopy.done_cv);
+	list_initialize(&fcopy.jobs);
+
+	rc = vfs_link_path(destdir, KIND_DIRECTORY, NULL);
+	if (rc != EOK && rc != EEXIST)
+		return rc;
+
+	rc = vfs_stat_path(destdir, &fcopy.dest_st);
+	if (rc != EOK)
+		return rc;
+
+	if (!fcopy.dest_st.is_directory)
+		return ENOTDIR;
+
+	rc = fcopy_start(&fcopy);
+	if (rc != EOK)
+		return rc;
+
+	(void) fcopy_walk(&fcopy, srcdir, destdir);
+
+	rc = fcopy_finish(&fcopy);
+	if (rc != EOK)
+		return rc;
+
+	return fcopy_sync(destdir);
+}
+
+/** @}
+ */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <pcut/pcut.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vfs/vfs.h>
+#include "../include/fcopy.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(fcopy);
+
+/** Size of a file large enough to use the buffer shared with VFS */
+#define LARGE_SIZE  (100 * 1024)
+
+/** Create a file filled with a pattern. */
+static void file_create(const char *path, size_t size, char seed)
+{
+	FILE *f = fopen(path, "wb");
+	PCUT_ASSERT_NOT_NULL(f);
+
+	for (size_t i = 0; i < size; i++)
+		PCUT_ASSERT_TRUE(fputc((char) (seed + i), f) != EOF);
+
+	PCUT_ASSERT_INT_EQUALS(0, fclose(f));
+}
+
+/** Verify that a file is filled with a pattern. */
+static void file_check(const char *path, size_t size, char seed)
+{
+	FILE *f = fopen(path, "rb");
+	PCUT_ASSERT_NOT_NULL(f);
+
+	for (size_t i = 0; i < size; i++)
+		PCUT_ASSERT_INT_EQUALS((char) (seed + i), (char) fgetc(f));
+
+	PCUT_ASSERT_INT_EQUALS(EOF, fgetc(f));
+	PCUT_ASSERT_INT_EQUALS(0, fclose(f));
+}
+
+/** Build a path in a directory. */
+static char *path_join(const char *dir, const char *name)
+{
+	char *path;
+
+	PCUT_ASSERT_TRUE(asprintf(&path, "%s/%s", dir, name) >= 0);
+	return path;
+}
+
+/** Copying a single file, with and without overwriting */
+PCUT_TEST(file)
+{
+	char buf[L_tmpnam];
+	fcopy_cfg_t cfg;
+	errno_t rc;
+
+	char *p = tmpnam(buf);
+	PCUT_ASSERT_NOT_NULL(p);
+
+	rc = vfs_link_path(p, KIND_DIRECTORY, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	char *src = path_join(p, "src");
+	char *dest = path_join(p, "dest");
+
+	file_create(src, 10, 'a');
+
+	fcopy_cfg_init(&cfg);
+	rc = fcopy_file(&cfg, src, dest);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	file_check(dest, 10, 'a');
+
+	/* The destination exists now */
+	rc = fcopy_file(&cfg, src, dest);
+	PCUT_ASSERT_ERRNO_VAL(EEXIST, rc);
+
+	/* Overwriting a longer file truncates it */
+	file_create(dest, LARGE_SIZE, 'x');
+	file_create(src, 5, 'b');
+	cfg.overwrite = true;
+	rc = fcopy_file(&cfg, src, dest);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	file_check(dest, 5, 'b');
+
+	PCUT_ASSERT_INT_EQUALS(0, remove(src));
+	PCUT_ASSERT_INT_EQUALS(0, remove(dest));
+	PCUT_ASSERT_INT_EQUALS(0, remove(p));
+	free(src);
+	free(dest);
+}
+
+/** Copying a directory tree */
+PCUT_TEST(tree)
+{
+	char buf[L_tmpnam];
+	fcopy_cfg_t cfg;
+	errno_t rc;
+
+	char *p = tmpnam(buf);
+	PCUT_ASSERT_NOT_NULL(p);
+
+	rc = vfs_link_path(p, KIND_DIRECTORY, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	char *src = path_join(p, "src");
+	char *src_sub = path_join(src, "sub");
+	char *src_a = path_join(src, "a");
+	char *src_b = path_join(src_sub, "b");
+	char *dest = path_join(p, "dest");
+	char *dest_sub = path_join(dest, "sub");
+	char *dest_a = path_join(dest, "a");
+	char *dest_b = path_join(dest_sub, "b");
+
+	rc = vfs_link_path(src, KIND_DIRECTORY, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = vfs_link_path(src_sub, KIND_DIRECTORY, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	file_create(src_a, 3, 'a');
+	file_create(src_b, LARGE_SIZE, 'b');
+
+	fcopy_cfg_init(&cfg);
+	rc = fcopy_tree(&cfg, src, dest);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	file_check(dest_a, 3, 'a');
+	file_check(dest_b, LARGE_SIZE, 'b');
+
+	PCUT_ASSERT_INT_EQUALS(0, remove(dest_b));
+	PCUT_ASSERT_INT_EQUALS(0, remove(dest_a));
+	PCUT_ASSERT_INT_EQUALS(0, remove(dest_sub));
+	PCUT_ASSERT_INT_EQUALS(0, remove(dest));
+	PCUT_ASSERT_INT_EQUALS(0, remove(src_b));
+	PCUT_ASSERT_INT_EQUALS(0, remove(src_a));
+	PCUT_ASSERT_INT_EQUALS(0, remove(src_sub));
+	PCUT_ASSERT_INT_EQUALS(0, remove(src));
+	PCUT_ASSERT_INT_EQUALS(0, remove(p));
+
+	free(src);
+	free(src_sub);
+	free(src_a);
+	free(src_b);
+	free(dest);
+	free(dest_sub);
+	free(dest_a);
+	free(dest_b);
+}
+
+/** Copying a directory into itself fails */
+PCUT_TEST(tree_into_itself)
+{
+	char buf[L_tmpnam];
+	fcopy_cfg_t cfg;
+	errno_t rc;
+
+	char *p = tmpnam(buf);
+	PCUT_ASSERT_NOT_NULL(p);
+
+	rc = vfs_link_path(p, KIND_DIRECTORY, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	char *dest = path_join(p, "dest");
+
+	fcopy_cfg_init(&cfg);
+	rc = fcopy_tree(&cfg, p, dest);
+	PCUT_ASSERT_ERRNO_VAL(ELOOP, rc);
+
+	PCUT_ASSERT_INT_EQUALS(0, remove(dest));
+	PCUT_ASSERT_INT_EQUALS(0, remove(p));
+	free(dest);
+}
+
+PCUT_EXPORT(fcopy);
@@ -44,6 +44,7 @@
 #include <mem.h>
 #include <str.h>
 #include <stdlib.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <ipc/vfs.h>
 #include <vfs/vfs.h>
@@ -347,6 +348,26 @@ static void vfs_connection(ipc_call_t *icall, void *arg)
 	}
 }
 
+/** Serve VFS requests from more than one fibril runner thread.
+ *
+ * The fibrils of vfs_connection() are spread over the runners, so that
+ * requests for different nodes are served in parallel. Only file systems
+ * whose libfs_ops_t and vfs_out_ops_t implementations lock their nodes and
+ * shared structures may ask for more than one runner.
+ *
+ * @param runners Requested number of runners, including the main thread.
+ *
+ * @return Number of runners serving the file system.
+ *
+ */
+unsigned fs_set_runners(unsigned runners)
+{
+	if (runners <= 1)
+		return 1;
+
+	return (unsigned) fibril_set_runners((int) runners);
+}
+
 /** Register file system server.
  *
  * This function abstracts away the tedious registration protocol from
@@ -789,6 +810,12 @@ void libfs_statfs(libfs_ops_t *ops, fs_handle_t fs_handle, ipc_call_t *req)
 			goto error;
 	}
 
+	if (ops->cache_stats != NULL) {
+		rc = ops->cache_stats(service_id, &st.f_cache);
+		if (rc != EOK)
+			goto error;
+	}
+
 	ops->node_put(fn);
 	async_data_read_finalize(&call, &st, sizeof(vfs_statfs_t));
 	async_answer_0(req, EOK);
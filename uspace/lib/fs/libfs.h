@@ -40,6 +40,7 @@
 #include <offset.h>
 #include <async.h>
 #include <loc.h>
+#include <vfs/vfs.h>
 
 typedef struct {
 	errno_t (*fsprobe)(service_id_t, vfs_fs_probe_info_t *);
@@ -87,8 +88,12 @@ typedef struct {
 	errno_t (*size_block)(service_id_t, uint32_t *);
 	errno_t (*total_block_count)(service_id_t, uint64_t *);
 	errno_t (*free_block_count)(service_id_t, uint64_t *);
+	errno_t (*cache_stats)(service_id_t, vfs_block_stats_t *);
 } libfs_ops_t;
 
+/** Number of runner threads of file systems which lock their nodes. */
+#define FS_RUNNERS_DEFAULT  4
+
 typedef struct {
 	int fs_handle;           /**< File system handle. */
 	uint8_t *plb_ro;         /**< Read-only PLB view. */
@@ -96,6 +101,7 @@ typedef struct {
 
 extern errno_t fs_register(async_sess_t *, vfs_info_t *, vfs_out_ops_t *,
     libfs_ops_t *);
+extern unsigned fs_set_runners(unsigned);
 
 extern void fs_node_initialize(fs_node_t *);
 
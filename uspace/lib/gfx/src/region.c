@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libgfx
+ * @{
+ */
+/**
+ * @file Regions
+ *
+ * Regions are kept as y-x banded rectangle lists. Boolean operations sweep
+ * both operands top to bottom, slab by slab between consecutive y
+ * coordinates, and combine the x spans of the bands covering each slab.
+ * The result is normalized on the fly, so adjacent spans are joined and
+ * adjacent bands with identical spans are merged.
+ */
+
+#include <gfx/coord.h>
+#include <gfx/region.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/** Boolean region operation */
+typedef enum {
+	gro_union,
+	gro_intersect,
+	gro_subtract
+} gfx_region_op_t;
+
+/** Initialize region.
+ *
+ * The region is empty after initialization.
+ *
+ * @param region Region
+ */
+void gfx_region_init(gfx_region_t *region)
+{
+	region->rects = NULL;
+	region->count = 0;
+	region->alloc = 0;
+}
+
+/** Finalize region.
+ *
+ * Free memory used by the region.
+ *
+ * @param region Region
+ */
+void gfx_region_fini(gfx_region_t *region)
+{
+	free(region->rects);
+	gfx_region_init(region);
+}
+
+/** Make region empty.
+ *
+ * Memory is kept for reuse.
+ *
+ * @param region Region
+ */
+void gfx_region_clear(gfx_region_t *region)
+{
+	region->count = 0;
+}
+
+/** Determine if region is empty.
+ *
+ * @param region Region
+ * @return @c true iff region contains no pixels
+ */
+bool gfx_region_is_empty(gfx_region_t *region)
+{
+	return region->count == 0;
+}
+
+/** Get bounding rectangle of region.
+ *
+ * @param region Region
+ * @param rect Place to store bounding rectangle (empty if region is empty)
+ */
+void gfx_region_get_bounds(gfx_region_t *region, gfx_rect_t *rect)
+{
+	size_t i;
+
+	if (region->count == 0) {
+		rect->p0.x = 0;
+		rect->p0.y = 0;
+		rect->p1.x = 0;
+		rect->p1.y = 0;
+		return;
+	}
+
+	rect->p0.x = region->rects[0].p0.x;
+	rect->p0.y = region->rects[0].p0.y;
+	rect->p1.x = region->rects[0].p1.x;
+	rect->p1.y = region->rects[region->count - 1].p1.y;
+
+	for (i = 1; i < region->count; i++) {
+		if (region->rects[i].p0.x < rect->p0.x)
+			rect->p0.x = region->rects[i].p0.x;
+		if (region->rects[i].p1.x > rect->p1.x)
+			rect->p1.x = region->rects[i].p1.x;
+	}
+}
+
+/** Append rectangle to region.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM
+ */
+static errno_t gfx_region_append(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t *nrects;
+	size_t nalloc;
+
+	if (region->count == region->alloc) {
+		nalloc = region->alloc > 0 ? 2 * region->alloc : 8;
+		nrects = realloc(region->rects, nalloc * sizeof(gfx_rect_t));
+		if (nrects == NULL)
+			return ENOMEM;
+
+		region->rects = nrects;
+		region->alloc = nalloc;
+	}
+
+	region->rects[region->count++] = *rect;
+	return EOK;
+}
+
+/** Set region to a single rectangle.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM
+ */
+errno_t gfx_region_set_rect(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t srect;
+
+	gfx_region_clear(region);
+
+	gfx_rect_points_sort(rect, &srect);
+	if (gfx_rect_is_empty(&srect))
+		return EOK;
+
+	return gfx_region_append(region, &srect);
+}
+
+/** Compare two coordinates for qsort(). */
+static int gfx_coord_cmp(const void *a, const void *b)
+{
+	gfx_coord_t ca = *(const gfx_coord_t *) a;
+	gfx_coord_t cb = *(const gfx_coord_t *) b;
+
+	if (ca < cb)
+		return -1;
+	if (ca > cb)
+		return 1;
+	return 0;
+}
+
+/** Find band of region covering row.
+ *
+ * Bands are visited in order, so @a idx is only ever advanced.
+ *
+ * @param region Region
+ * @param idx Index of first rectangle not yet known to be above @a y
+ * @param y Row
+ * @return Number of rectangles in the band starting at @a idx which
+ *         covers @a y (zero if no band covers it)
+ */
+static size_t gfx_region_band(gfx_region_t *region, size_t *idx,
+    gfx_coord_t y)
+{
+	gfx_rect_t *rects = region->rects;
+	size_t n;
+
+	while (*idx < region->count && rects[*idx].p1.y <= y)
+		++*idx;
+
+	if (*idx >= region->count || rects[*idx].p0.y > y)
+		return 0;
+
+	n = 1;
+	while (*idx + n < region->count &&
+	    rects[*idx + n].p0.y == rects[*idx].p0.y)
+		++n;
+
+	return n;
+}
+
+/** Get n-th x coordinate of span boundaries in a band. */
+static gfx_coord_t gfx_band_x(gfx_rect_t *band, size_t k)
+{
+	return (k % 2 == 0) ? band[k / 2].p0.x : band[k / 2].p1.x;
+}
+
+/** Determine if band covers column.
+ *
+ * Columns are visited in order, so @a idx is only ever advanced.
+ *
+ * @param band First rectangle of band
+ * @param n Number of rectangles in band
+ * @param idx Index of first rectangle not yet known to be left of @a x
+ * @param x Column
+ * @return @c true iff @a x is covered
+ */
+static bool gfx_band_covers(gfx_rect_t *band, size_t n, size_t *idx,
+    gfx_coord_t x)
+{
+	while (*idx < n && band[*idx].p1.x <= x)
+		++*idx;
+
+	return *idx < n && band[*idx].p0.x <= x;
+}
+
+/** Combine two bands covering the same slab.
+ *
+ * @param res Region to append rectangles to
+ * @param a First band
+ * @param na Number of rectangles in @a a
+ * @param b Second band
+ * @param nb Number of rectangles in @a b
+ * @param op Operation
+ * @param y0 Top of slab
+ * @param y1 Bottom of slab
+ * @return EOK on success or ENOMEM
+ */
+static errno_t gfx_region_combine_band(gfx_region_t *res, gfx_rect_t *a,
+    size_t na, gfx_rect_t *b, size_t nb, gfx_region_op_t op,
+    gfx_coord_t y0, gfx_coord_t y1)
+{
+	size_t band_start = res->count;
+	size_t ka = 0, kb = 0;
+	size_t ia = 0, ib = 0;
+	gfx_coord_t x, xnext;
+	gfx_rect_t rect;
+	bool ina, inb, in;
+	errno_t rc;
+
+	/* Merge the sorted boundary lists of both bands */
+	while (ka < 2 * na || kb < 2 * nb) {
+		if (kb >= 2 * nb || (ka < 2 * na &&
+		    gfx_band_x(a, ka) <= gfx_band_x(b, kb)))
+			x = gfx_band_x(a, ka);
+		else
+			x = gfx_band_x(b, kb);
+
+		while (ka < 2 * na && gfx_band_x(a, ka) == x)
+			++ka;
+		while (kb < 2 * nb && gfx_band_x(b, kb) == x)
+			++kb;
+
+		if (ka >= 2 * na && kb >= 2 * nb)
+			break;
+
+		if (kb >= 2 * nb || (ka < 2 * na &&
+		    gfx_band_x(a, ka) <= gfx_band_x(b, kb)))
+			xnext = gfx_band_x(a, ka);
+		else
+			xnext = gfx_band_x(b, kb);
+
+		ina = gfx_band_covers(a, na, &ia, x);
+		inb = gfx_band_covers(b, nb, &ib, x);
+
+		switch (op) {
+		case gro_union:
+			in = ina || inb;
+			break;
+		case gro_intersect:
+			in = ina && inb;
+			break;
+		default:
+			in = ina && !inb;
+			break;
+		}
+
+		if (!in)
+			continue;
+
+		if (res->count > band_start &&
+		    res->rects[res->count - 1].p1.x == x) {
+			/* Extend the previous span */
+			res->rects[res->count - 1].p1.x = xnext;
+			continue;
+		}
+
+		rect.p0.x = x;
+		rect.p0.y = y0;
+		rect.p1.x = xnext;
+		rect.p1.y = y1;
+
+		rc = gfx_region_append(res, &rect);
+		if (rc != EOK)
+			return rc;
+	}
+
+	return EOK;
+}
+
+/** Merge last band of region with the band above it if possible.
+ *
+ * @param res Region
+ * @param prev Start of the band above the last band
+ * @param cur Start of the last band
+ * @return @c true if the bands were merged
+ */
+static bool gfx_region_coalesce(gfx_region_t *res, size_t prev, size_t cur)
+{
+	size_t n = res->count - cur;
+	size_t i;
+
+	if (cur - prev != n || res->rects[prev].p1.y != res->rects[cur].p0.y)
+		return false;
+
+	for (i = 0; i < n; i++) {
+		if (res->rects[prev + i].p0.x != res->rects[cur + i].p0.x ||
+		    res->rects[prev + i].p1.x != res->rects[cur + i].p1.x)
+			return false;
+	}
+
+	for (i = 0; i < n; i++)
+		res->rects[prev + i].p1.y = res->rects[cur].p1.y;
+
+	res->count = cur;
+	return true;
+}
+
+/** Combine two regions.
+ *
+ * @param a First region
+ * @param b Second region
+ * @param op Operation
+ * @param dest Place to store result (can be the same as @a a or @a b)
+ * @return EOK on success or ENOMEM (in which case @a dest is unchanged)
+ */
+static errno_t gfx_region_combine(gfx_region_t *a, gfx_region_t *b,
+    gfx_region_op_t op, gfx_region_t *dest)
+{
+	gfx_region_t res;
+	gfx_coord_t *ys;
+	size_t nys, i, j;
+	size_t ia = 0, ib = 0;
+	size_t na, nb;
+	size_t prev = 0, cur;
+	bool have_prev = false;
+	errno_t rc;
+
+	gfx_region_init(&res);
+
+	nys = 2 * (a->count + b->count);
+	if (nys == 0)
+		goto done;
+
+	ys = malloc(nys * sizeof(gfx_coord_t));
+	if (ys == NULL)
+		return ENOMEM;
+
+	j = 0;
+	for (i = 0; i < a->count; i++) {
+		ys[j++] = a->rects[i].p0.y;
+		ys[j++] = a->rects[i].p1.y;
+	}
+
+	for (i = 0; i < b->count; i++) {
+		ys[j++] = b->rects[i].p0.y;
+		ys[j++] = b->rects[i].p1.y;
+	}
+
+	qsort(ys, nys, sizeof(gfx_coord_t), gfx_coord_cmp);
+
+	for (i = 0; i + 1 < nys; i++) {
+		if (ys[i] == ys[i + 1])
+			continue;
+
+		na = gfx_region_band(a, &ia, ys[i]);
+		nb = gfx_region_band(b, &ib, ys[i]);
+		if (na == 0 && nb == 0)
+			continue;
+
+		cur = res.count;
+		rc = gfx_region_combine_band(&res, a->rects + ia, na,
+		    b->rects + ib, nb, op, ys[i], ys[i + 1]);
+		if (rc != EOK) {
+			free(ys);
+			gfx_region_fini(&res);
+			return rc;
+		}
+
+		if (res.count == cur)
+			continue;
+
+		if (!have_prev || !gfx_region_coalesce(&res, prev, cur)) {
+			prev = cur;
+			have_prev = true;
+		}
+	}
+
+	free(ys);
+done:
+	gfx_region_fini(dest);
+	*dest = res;
+	return EOK;
+}
+
+/** Compute union of two regions.
+ *
+ * @param a First region
+ * @param b Second region
+ * @param dest Place to store result (can be the same as @a a or @a b)
+ * @return EOK on success or ENOMEM (in which case @a dest is unchanged)
+ */
+errno_t gfx_region_union(gfx_region_t *a, gfx_region_t *b, gfx_region_t *dest)
+{
+	return gfx_region_combine(a, b, gro_union, dest);
+}
+
+/** Compute intersection of two regions.
+ *
+ * @param a First region
+ * @param b Second region
+ * @param dest Place to store result (can be the same as @a a or @a b)
+ * @return EOK on success or ENOMEM (in which case @a dest is unchanged)
+ */
+errno_t gfx_region_intersect(gfx_region_t *a, gfx_region_t *b,
+    gfx_region_t *dest)
+{
+	return gfx_region_combine(a, b, gro_intersect, dest);
+}
+
+/** Subtract region from region.
+ *
+ * @param a Region to subtract from
+ * @param b Region to subtract
+ * @param dest Place to store result (can be the same as @a a or @a b)
+ * @return EOK on success or ENOMEM (in which case @a dest is unchanged)
+ */
+errno_t gfx_region_subtract(gfx_region_t *a, gfx_region_t *b,
+    gfx_region_t *dest)
+{
+	return gfx_region_combine(a, b, gro_subtract, dest);
+}
+
+/** Combine region with a rectangle in place.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @param op Operation
+ * @return EOK on success or ENOMEM (in which case @a region is unchanged)
+ */
+static errno_t gfx_region_combine_rect(gfx_region_t *region, gfx_rect_t *rect,
+    gfx_region_op_t op)
+{
+	gfx_region_t rregion;
+	gfx_rect_t srect;
+
+	gfx_rect_points_sort(rect, &srect);
+
+	rregion.rects = &srect;
+	rregion.count = gfx_rect_is_empty(&srect) ? 0 : 1;
+	rregion.alloc = 0;
+
+	return gfx_region_combine(region, &rregion, op, region);
+}
+
+/** Add rectangle to region.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM (in which case @a region is unchanged)
+ */
+errno_t gfx_region_union_rect(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t srect;
+	size_t i;
+
+	gfx_rect_points_sort(rect, &srect);
+	if (gfx_rect_is_empty(&srect))
+		return EOK;
+
+	if (region->count == 0)
+		return gfx_region_set_rect(region, &srect);
+
+	/* Already covered by a single rectangle? */
+	for (i = 0; i < region->count; i++) {
+		if (gfx_rect_is_inside(&srect, &region->rects[i]))
+			return EOK;
+	}
+
+	return gfx_region_combine_rect(region, &srect, gro_union);
+}
+
+/** Clip region to a rectangle.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM (in which case @a region is unchanged)
+ */
+errno_t gfx_region_intersect_rect(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t bounds;
+	gfx_rect_t srect;
+
+	gfx_rect_points_sort(rect, &srect);
+	gfx_region_get_bounds(region, &bounds);
+	if (region->count == 0 || gfx_rect_is_inside(&bounds, &srect))
+		return EOK;
+
+	return gfx_region_combine_rect(region, &srect, gro_intersect);
+}
+
+/** Remove rectangle from region.
+ *
+ * @param region Region
+ * @param rect Rectangle
+ * @return EOK on success or ENOMEM (in which case @a region is unchanged)
+ */
+errno_t gfx_region_subtract_rect(gfx_region_t *region, gfx_rect_t *rect)
+{
+	gfx_rect_t bounds;
+	gfx_rect_t srect;
+	gfx_rect_t crect;
+
+	gfx_rect_points_sort(rect, &srect);
+	gfx_region_get_bounds(region, &bounds);
+	gfx_rect_clip(&srect, &bounds, &crect);
+	if (gfx_rect_is_empty(&crect))
+		return EOK;
+
+	return gfx_region_combine_rect(region, &srect, gro_subtract);
+}
+
+/** Get first rectangle of region.
+ *
+ * @param region Region
+ * @return First rectangle or @c NULL if region is empty
+ */
+gfx_rect_t *gfx_region_first(gfx_region_t *region)
+{
+	if (region->count == 0)
+		return NULL;
+
+	return &region->rects[0];
+}
+
+/** Get next rectangle of region.
+ *
+ * @param region Region
+ * @param rect Current rectangle
+ * @return Next rectangle or @c NULL if @a rect is the last one
+ */
+gfx_rect_t *gfx_region_next(gfx_region_t *region, gfx_rect_t *rect)
+{
+	if (rect + 1 >= region->rects + region->count)
+		return NULL;
+
+	return rect + 1;
+}
+
+/** @}
+ */
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gfx/coord.h>
+#include <gfx/region.h>
+#include <pcut/pcut.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(region);
+
+static void set_rect(gfx_rect_t *rect, gfx_coord_t x0, gfx_coord_t y0,
+    gfx_coord_t x1, gfx_coord_t y1)
+{
+	rect->p0.x = x0;
+	rect->p0.y = y0;
+	rect->p1.x = x1;
+	rect->p1.y = y1;
+}
+
+static void assert_rect(gfx_rect_t *rect, gfx_coord_t x0, gfx_coord_t y0,
+    gfx_coord_t x1, gfx_coord_t y1)
+{
+	PCUT_ASSERT_NOT_NULL(rect);
+	PCUT_ASSERT_INT_EQUALS(x0, rect->p0.x);
+	PCUT_ASSERT_INT_EQUALS(y0, rect->p0.y);
+	PCUT_ASSERT_INT_EQUALS(x1, rect->p1.x);
+	PCUT_ASSERT_INT_EQUALS(y1, rect->p1.y);
+}
+
+/** New region is empty, empty rectangles are ignored */
+PCUT_TEST(init_empty)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	errno_t rc;
+
+	gfx_region_init(&region);
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&region));
+	PCUT_ASSERT_NULL(gfx_region_first(&region));
+
+	set_rect(&rect, 10, 10, 10, 20);
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&region));
+
+	gfx_region_fini(&region);
+}
+
+/** Union of two overlapping rectangles is split into three bands */
+PCUT_TEST(union_overlap)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	gfx_rect_t *r;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 20, 20);
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 10, 10, 30, 30);
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	r = gfx_region_first(&region);
+	assert_rect(r, 0, 0, 20, 10);
+	r = gfx_region_next(&region, r);
+	assert_rect(r, 0, 10, 30, 20);
+	r = gfx_region_next(&region, r);
+	assert_rect(r, 10, 20, 30, 30);
+	PCUT_ASSERT_NULL(gfx_region_next(&region, r));
+
+	gfx_region_get_bounds(&region, &rect);
+	assert_rect(&rect, 0, 0, 30, 30);
+
+	gfx_region_fini(&region);
+}
+
+/** Adjacent rectangles are merged */
+PCUT_TEST(union_coalesce)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	gfx_rect_t *r;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 10, 0, 20, 10);
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 0, 10, 20, 20);
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	r = gfx_region_first(&region);
+	assert_rect(r, 0, 0, 20, 20);
+	PCUT_ASSERT_NULL(gfx_region_next(&region, r));
+
+	gfx_region_fini(&region);
+}
+
+/** Subtracting a rectangle from the middle leaves a frame */
+PCUT_TEST(subtract_hole)
+{
+	gfx_region_t region;
+	gfx_rect_t rect;
+	gfx_rect_t *r;
+	errno_t rc;
+
+	gfx_region_init(&region);
+
+	set_rect(&rect, 0, 0, 30, 30);
+	rc = gfx_region_set_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 10, 10, 20, 20);
+	rc = gfx_region_subtract_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	r = gfx_region_first(&region);
+	assert_rect(r, 0, 0, 30, 10);
+	r = gfx_region_next(&region, r);
+	assert_rect(r, 0, 10, 10, 20);
+	r = gfx_region_next(&region, r);
+	assert_rect(r, 20, 10, 30, 20);
+	r = gfx_region_next(&region, r);
+	assert_rect(r, 0, 20, 30, 30);
+	PCUT_ASSERT_NULL(gfx_region_next(&region, r));
+
+	/* Filling the hole back in restores a single rectangle */
+	rc = gfx_region_union_rect(&region, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	r = gfx_region_first(&region);
+	assert_rect(r, 0, 0, 30, 30);
+	PCUT_ASSERT_NULL(gfx_region_next(&region, r));
+
+	gfx_region_fini(&region);
+}
+
+/** Intersection of two regions */
+PCUT_TEST(intersect)
+{
+	gfx_region_t a;
+	gfx_region_t b;
+	gfx_rect_t rect;
+	gfx_rect_t *r;
+	errno_t rc;
+
+	gfx_region_init(&a);
+	gfx_region_init(&b);
+
+	set_rect(&rect, 0, 0, 10, 10);
+	rc = gfx_region_union_rect(&a, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	set_rect(&rect, 20, 0, 30, 10);
+	rc = gfx_region_union_rect(&a, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	set_rect(&rect, 5, 5, 25, 15);
+	rc = gfx_region_set_rect(&b, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Store result in one of the operands */
+	rc = gfx_region_intersect(&a, &b, &b);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	r = gfx_region_first(&b);
+	assert_rect(r, 5, 5, 10, 10);
+	r = gfx_region_next(&b, r);
+	assert_rect(r, 20, 5, 25, 10);
+	PCUT_ASSERT_NULL(gfx_region_next(&b, r));
+
+	/* Intersecting with a rectangle outside leaves nothing */
+	set_rect(&rect, 40, 40, 50, 50);
+	rc = gfx_region_intersect_rect(&b, &rect);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(gfx_region_is_empty(&b));
+
+	gfx_region_fini(&a);
+	gfx_region_fini(&b);
+}
+
+PCUT_EXPORT(region);
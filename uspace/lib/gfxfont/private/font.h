@@ -37,8 +37,10 @@
 #ifndef _GFX_PRIVATE_FONT_H
 #define _GFX_PRIVATE_FONT_H
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <types/gfx/bitmap.h>
 #include <types/gfx/context.h>
@@ -46,6 +48,11 @@
 #include <types/gfx/typeface.h>
 #include <riff/chunk.h>
 
+/** Number of code points per page of the glyph index */
+#define GFX_FONT_INDEX_PAGE_SIZE 256
+/** Number of pages of the glyph index (covering the BMP) */
+#define GFX_FONT_INDEX_PAGES 256
+
 /** Font
  *
  * This is private to libgfxfont.
@@ -55,6 +62,9 @@
  * used. The baselines of the glyphs are not mutually aligned.
  * For each glyph @c gfx_glyph_t.origin designates
  * pen start point (and thus the position of the baseline).
+ *
+ * The glyph index maps code points to glyphs. It is built on first
+ * lookup and dropped whenever patterns change.
  */
 struct gfx_font {
 	/** Containing typeface */
@@ -69,6 +79,12 @@ struct gfx_font {
 	gfx_bitmap_t *bitmap;
 	/** Bitmap rectangle */
 	gfx_rect_t rect;
+	/** Glyph index is built */
+	bool index_valid;
+	/** Glyphs for single BMP code points in pages (or @c NULL) */
+	struct gfx_glyph **index_page[GFX_FONT_INDEX_PAGES];
+	/** Other patterns (of gfx_glyph_pattern_t) by first code point */
+	hash_table_t index_patterns;
 };
 
 /** Font info
@@ -88,6 +104,7 @@ struct gfx_font_info {
 	riff_rchunk_t fontck;
 };
 
+extern void gfx_font_index_invalidate(gfx_font_t *);
 extern errno_t gfx_font_splice_at_glyph(gfx_font_t *, gfx_glyph_t *,
     gfx_rect_t *);
 extern errno_t gfx_font_info_load(gfx_typeface_t *, riff_rchunk_t *);
@@ -37,8 +37,10 @@
 #ifndef _GFX_PRIVATE_GLYPH_H
 #define _GFX_PRIVATE_GLYPH_H
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <gfx/coord.h>
+#include <uchar.h>
 #include <types/gfx/glyph.h>
 #include <riff/chunk.h>
 
@@ -72,6 +74,10 @@ struct gfx_glyph_pattern {
 	link_t lpatterns;
 	/** Pattern text */
 	char *text;
+	/** First code point of @c text */
+	char32_t c0;
+	/** Link to gfx_font.index_patterns */
+	ht_link_t lindex;
 };
 
 extern errno_t gfx_glyph_transfer(gfx_glyph_t *, gfx_coord_t, gfx_bitmap_t *,
@@ -42,6 +42,7 @@
 #include <gfx/glyph.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <str.h>
 #include "../private/font.h"
 #include "../private/glyph.h"
 #include "../private/tpf_file.h"
@@ -243,6 +244,7 @@ void gfx_font_close(gfx_font_t *font)
 		glyph = gfx_font_first_glyph(font);
 	}
 
+	gfx_font_index_invalidate(font);
 	font->finfo->font = NULL;
 	free(font);
 }
@@ -333,7 +335,135 @@ gfx_glyph_t *gfx_font_prev_glyph(gfx_glyph_t *cur)
 	return list_get_instance(link, gfx_glyph_t, lglyphs);
 }
 
+static size_t pattern_index_hash(const ht_link_t *item)
+{
+	gfx_glyph_pattern_t *pat = hash_table_get_inst(item,
+	    gfx_glyph_pattern_t, lindex);
+	return pat->c0;
+}
+
+static size_t pattern_index_key_hash(const void *key)
+{
+	const char32_t *c = (const char32_t *) key;
+	return *c;
+}
+
+static bool pattern_index_equal(const ht_link_t *item1,
+    const ht_link_t *item2)
+{
+	gfx_glyph_pattern_t *pat1 = hash_table_get_inst(item1,
+	    gfx_glyph_pattern_t, lindex);
+	gfx_glyph_pattern_t *pat2 = hash_table_get_inst(item2,
+	    gfx_glyph_pattern_t, lindex);
+	return pat1->c0 == pat2->c0;
+}
+
+static bool pattern_index_key_equal(const void *key, const ht_link_t *item)
+{
+	const char32_t *c = (const char32_t *) key;
+	gfx_glyph_pattern_t *pat = hash_table_get_inst(item,
+	    gfx_glyph_pattern_t, lindex);
+	return *c == pat->c0;
+}
+
+static hash_table_ops_t pattern_index_ops = {
+	.hash = pattern_index_hash,
+	.key_hash = pattern_index_key_hash,
+	.equal = pattern_index_equal,
+	.key_equal = pattern_index_key_equal,
+	.remove_callback = NULL
+};
+
+/** Drop glyph index.
+ *
+ * Must be called before any glyph pattern is added or removed. The index
+ * is rebuilt on next lookup.
+ *
+ * @param font Font
+ */
+void gfx_font_index_invalidate(gfx_font_t *font)
+{
+	size_t i;
+
+	if (!font->index_valid)
+		return;
+
+	for (i = 0; i < GFX_FONT_INDEX_PAGES; i++) {
+		free(font->index_page[i]);
+		font->index_page[i] = NULL;
+	}
+
+	hash_table_destroy(&font->index_patterns);
+	font->index_valid = false;
+}
+
+/** Build glyph index.
+ *
+ * Patterns consisting of a single code point from the BMP go to the page
+ * table. All other patterns are hashed by their first code point.
+ *
+ * @param font Font
+ * @return EOK on success or ENOMEM
+ */
+static errno_t gfx_font_index_build(gfx_font_t *font)
+{
+	gfx_glyph_t *glyph;
+	gfx_glyph_pattern_t *pat;
+	gfx_glyph_t **page;
+	size_t off;
+	char32_t c;
+
+	if (!hash_table_create(&font->index_patterns, 0, 0,
+	    &pattern_index_ops))
+		return ENOMEM;
+
+	font->index_valid = true;
+
+	glyph = gfx_font_first_glyph(font);
+	while (glyph != NULL) {
+		pat = gfx_glyph_first_pattern(glyph);
+		while (pat != NULL) {
+			off = 0;
+			c = str_decode(pat->text, &off, STR_NO_LIMIT);
+			pat->c0 = c;
+
+			if (c == 0) {
+				/* Empty pattern cannot be used to advance */
+			} else if (pat->text[off] == '\0' && c < GFX_FONT_INDEX_PAGES *
+			    GFX_FONT_INDEX_PAGE_SIZE) {
+				page = font->index_page[c / GFX_FONT_INDEX_PAGE_SIZE];
+				if (page == NULL) {
+					page = calloc(GFX_FONT_INDEX_PAGE_SIZE,
+					    sizeof(gfx_glyph_t *));
+					if (page == NULL) {
+						gfx_font_index_invalidate(font);
+						return ENOMEM;
+					}
+
+					font->index_page[c / GFX_FONT_INDEX_PAGE_SIZE] =
+					    page;
+				}
+
+				/* First glyph wins */
+				if (page[c % GFX_FONT_INDEX_PAGE_SIZE] == NULL)
+					page[c % GFX_FONT_INDEX_PAGE_SIZE] = glyph;
+			} else {
+				hash_table_insert(&font->index_patterns,
+				    &pat->lindex);
+			}
+
+			pat = gfx_glyph_next_pattern(pat);
+		}
+
+		glyph = gfx_font_next_glyph(glyph);
+	}
+
+	return EOK;
+}
+
 /** Search for glyph that should be set for the beginning of a string.
+ *
+ * The longest matching pattern wins.
  *
  * @param font Font
  * @param str String whose beginning we would like to set
@@ -345,20 +475,67 @@ errno_t gfx_font_search_glyph(gfx_font_t *font, const char *str,
     gfx_glyph_t **rglyph, size_t *rsize)
 {
 	gfx_glyph_t *glyph;
+	gfx_glyph_pattern_t *pat;
+	gfx_glyph_t **page;
+	ht_link_t *first;
+	ht_link_t *link;
 	size_t msize;
+	size_t off;
+	char32_t c;
 
-	glyph = gfx_font_first_glyph(font);
-	while (glyph != NULL) {
-		if (gfx_glyph_matches(glyph, str, &msize)) {
-			*rglyph = glyph;
-			*rsize = msize;
-			return EOK;
+	if (!font->index_valid && gfx_font_index_build(font) != EOK) {
+		/* Out of memory, fall back to trying all glyphs */
+		glyph = gfx_font_first_glyph(font);
+		while (glyph != NULL) {
+			if (gfx_glyph_matches(glyph, str, &msize)) {
+				*rglyph = glyph;
+				*rsize = msize;
+				return EOK;
+			}
+
+			glyph = gfx_font_next_glyph(glyph);
 		}
 
-		glyph = gfx_font_next_glyph(glyph);
+		return ENOENT;
 	}
 
-	return ENOENT;
+	off = 0;
+	c = str_decode(str, &off, STR_NO_LIMIT);
+	if (c == 0)
+		return ENOENT;
+
+	/* Longer patterns starting with the same code point take precedence */
+	glyph = NULL;
+	msize = 0;
+
+	first = hash_table_find(&font->index_patterns, &c);
+	link = first;
+	while (link != NULL) {
+		pat = hash_table_get_inst(link, gfx_glyph_pattern_t, lindex);
+		if (str_size(pat->text) > msize &&
+		    str_test_prefix(str, pat->text)) {
+			glyph = pat->glyph;
+			msize = str_size(pat->text);
+		}
+
+		link = hash_table_find_next(&font->index_patterns, first, link);
+	}
+
+	if (glyph == NULL && c < GFX_FONT_INDEX_PAGES *
+	    GFX_FONT_INDEX_PAGE_SIZE) {
+		page = font->index_page[c / GFX_FONT_INDEX_PAGE_SIZE];
+		if (page != NULL) {
+			glyph = page[c % GFX_FONT_INDEX_PAGE_SIZE];
+			msize = off;
+		}
+	}
+
+	if (glyph == NULL)
+		return ENOENT;
+
+	*rglyph = glyph;
+	*rsize = msize;
+	return EOK;
 }
 
 /** Replace glyph graphic with empty space of specified width.
@@ -117,6 +117,7 @@ errno_t gfx_glyph_create(gfx_font_t *font, gfx_glyph_metrics_t *metrics,
  */
 void gfx_glyph_destroy(gfx_glyph_t *glyph)
 {
+	gfx_font_index_invalidate(glyph->font);
 	list_remove(&glyph->lglyphs);
 	free(glyph);
 }
@@ -178,6 +179,7 @@ errno_t gfx_glyph_set_pattern(gfx_glyph_t *glyph, const char *pattern)
 		return ENOMEM;
 	}
 
+	gfx_font_index_invalidate(glyph->font);
 	list_append(&pat->lpatterns, &glyph->patterns);
 	return EOK;
 }
@@ -196,6 +198,7 @@ void gfx_glyph_clear_pattern(gfx_glyph_t *glyph, const char *pattern)
 	pat = gfx_glyph_first_pattern(glyph);
 	while (pat != NULL) {
 		if (str_cmp(pat->text, pattern) == 0) {
+			gfx_font_index_invalidate(glyph->font);
 			list_remove(&pat->lpatterns);
 			free(pat->text);
 			free(pat);
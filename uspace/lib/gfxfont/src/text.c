@@ -44,6 +44,7 @@
 #include <mem.h>
 #include <str.h>
 #include "../private/font.h"
+#include "../private/glyph.h"
 #include "../private/typeface.h"
 
 /** Initialize text formatting structure.
@@ -231,6 +232,9 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 	gfx_glyph_t *glyph;
 	gfx_coord2_t cpos;
 	gfx_coord2_t spos;
+	gfx_coord2_t offs;
+	gfx_coord2_t roffs;
+	gfx_rect_t run;
 	gfx_rect_t rect;
 	errno_t rc;
 
@@ -244,6 +248,15 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 	if (rc != EOK)
 		return rc;
 
+	/*
+	 * Glyphs that lie side by side in the font bitmap and land at
+	 * the same offset from it are collected into a run and rendered
+	 * with a single operation.
+	 */
+	run.p0.x = run.p1.x = 0;
+	run.p0.y = run.p1.y = 0;
+	roffs.x = roffs.y = 0;
+
 	cpos = spos;
 	cp = str;
 	while (*cp != '\0') {
@@ -254,15 +267,39 @@ errno_t gfx_puttext(gfx_coord2_t *pos, gfx_text_fmt_t *fmt, const char *str)
 		}
 
 		gfx_glyph_get_metrics(glyph, &gmetrics);
-
-		rc = gfx_glyph_render(glyph, &cpos);
-		if (rc != EOK)
-			return rc;
+		gfx_coord2_subtract(&cpos, &glyph->origin, &offs);
+
+		if (gfx_rect_is_empty(&glyph->rect)) {
+			/* Nothing to draw */
+		} else if (!gfx_rect_is_empty(&run) &&
+		    glyph->rect.p0.x == run.p1.x &&
+		    glyph->rect.p0.y == run.p0.y &&
+		    glyph->rect.p1.y == run.p1.y &&
+		    offs.x == roffs.x && offs.y == roffs.y) {
+			/* Extend run */
+			run.p1.x = glyph->rect.p1.x;
+		} else {
+			if (!gfx_rect_is_empty(&run)) {
+				rc = gfx_bitmap_render(fmt->font->bitmap, &run,
+				    &roffs);
+				if (rc != EOK)
+					return rc;
+			}
+
+			run = glyph->rect;
+			roffs = offs;
+		}
 
 		cp += stradv;
 		cpos.x += gmetrics.advance;
 	}
 
+	if (!gfx_rect_is_empty(&run)) {
+		rc = gfx_bitmap_render(fmt->font->bitmap, &run, &roffs);
+		if (rc != EOK)
+			return rc;
+	}
+
 	/* Text underlining */
 	if (fmt->underline) {
 		gfx_font_get_metrics(fmt->font, &fmetrics);
@@ -450,6 +450,88 @@ PCUT_TEST(search_glyph)
 	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
 }
 
+/** gfx_font_search_glyph() finds glyphs by pattern, longest pattern wins */
+PCUT_TEST(search_glyph_patterns)
+{
+	gfx_font_props_t props;
+	gfx_font_metrics_t fmetrics;
+	gfx_glyph_metrics_t gmetrics;
+	gfx_typeface_t *tface;
+	gfx_font_t *font;
+	gfx_context_t *gc;
+	gfx_glyph_t *ga;
+	gfx_glyph_t *gfi;
+	gfx_glyph_t *glyph;
+	size_t bytes;
+	test_gc_t tgc;
+	errno_t rc;
+
+	rc = gfx_context_new(&test_ops, (void *)&tgc, &gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_typeface_create(gc, &tface);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_font_props_init(&props);
+	gfx_font_metrics_init(&fmetrics);
+	rc = gfx_font_create(tface, &props, &fmetrics, &font);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_glyph_metrics_init(&gmetrics);
+	rc = gfx_glyph_create(font, &gmetrics, &ga);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(ga, "f");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(ga, "á");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_glyph_create(font, &gmetrics, &gfi);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = gfx_glyph_set_pattern(gfi, "fi");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_font_search_glyph(font, "áx", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(ga, glyph);
+	PCUT_ASSERT_INT_EQUALS(2, bytes);
+
+	rc = gfx_font_search_glyph(font, "fo", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(ga, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	rc = gfx_font_search_glyph(font, "fix", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gfi, glyph);
+	PCUT_ASSERT_INT_EQUALS(2, bytes);
+
+	rc = gfx_font_search_glyph(font, "x", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	/* Changing patterns is reflected by the lookup */
+	gfx_glyph_clear_pattern(gfi, "fi");
+
+	rc = gfx_font_search_glyph(font, "fix", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(ga, glyph);
+	PCUT_ASSERT_INT_EQUALS(1, bytes);
+
+	rc = gfx_glyph_set_pattern(gfi, "x");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_font_search_glyph(font, "x", &glyph, &bytes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_EQUALS(gfi, glyph);
+
+	gfx_glyph_destroy(gfi);
+	gfx_glyph_destroy(ga);
+
+	gfx_font_close(font);
+	gfx_typeface_destroy(tface);
+	rc = gfx_context_delete(gc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
 /** Test gfx_font_splice_at_glyph() */
 PCUT_TEST(splice_at_glyph)
 {
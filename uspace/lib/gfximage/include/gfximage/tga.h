@@ -43,9 +43,18 @@
 #include <gfx/coord.h>
 #include <stddef.h>
 
+/** Streaming TGA decoder */
+typedef struct tga_decoder tga_decoder_t;
+
 extern errno_t decode_tga(gfx_context_t *, void *, size_t,
     gfx_bitmap_t **, gfx_rect_t *);
 
+extern errno_t tga_decoder_create(gfx_context_t *, tga_decoder_t **);
+extern void tga_decoder_destroy(tga_decoder_t *);
+extern errno_t tga_decoder_write(tga_decoder_t *, const void *, size_t);
+extern errno_t tga_decoder_finish(tga_decoder_t *, gfx_bitmap_t **,
+    gfx_rect_t *);
+
 #endif
 
 /** @}
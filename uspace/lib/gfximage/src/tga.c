@@ -37,11 +37,12 @@
 #include <stdlib.h>
 #include <byteorder.h>
 #include <align.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdbool.h>
 #include <pixconv.h>
 #include <gfx/bitmap.h>
 #include <gfximage/tga.h>
-#include <io/pixelmap.h>
 
 typedef struct {
 	uint8_t id_length;
@@ -93,41 +94,51 @@ typedef struct {
 	uint8_t img_alpha_bpp;
 	uint8_t img_alpha_dir;
 
-	void *id_data;
 	size_t id_length;
-
-	void *cmap_data;
 	size_t cmap_length;
-
-	void *img_data;
-	size_t img_length;
 } tga_t;
 
+/** Streaming TGA decoder */
+struct tga_decoder {
+	/** Graphic context in which to create the bitmap */
+	gfx_context_t *gc;
+	/** Header data collected so far */
+	uint8_t head[sizeof(tga_header_t)];
+	/** Number of header bytes collected */
+	size_t head_cnt;
+	/** Decoded header */
+	tga_t tga;
+	/** Number of bytes (image ID and color map) left to skip */
+	size_t skip;
+	/** Bitmap being decoded into */
+	gfx_bitmap_t *bitmap;
+	/** Bitmap allocation */
+	gfx_bitmap_alloc_t alloc;
+	/** Bitmap rectangle */
+	gfx_rect_t rect;
+	/** Row converter */
+	visual2pixel_row_t conv;
+	/** Size of one image row in bytes */
+	size_t row_size;
+	/** Buffer for an image row split between writes */
+	uint8_t *row;
+	/** Number of bytes in @c row */
+	size_t row_cnt;
+	/** Number of image rows decoded */
+	size_t rows;
+};
+
 /** Decode Truevision TGA header
  *
- * @param[in]  data Memory representation of TGA.
- * @param[in]  size Size of the representation (in bytes).
+ * @param[in]  head TGA header.
  * @param[out] tga  Decoded TGA.
  *
- * @return True on succesful decoding.
- * @return False on failure.
- *
  */
-static bool decode_tga_header(void *data, size_t size, tga_t *tga)
+static void decode_tga_header(tga_header_t *head, tga_t *tga)
 {
-	/* Header sanity check */
-	if (size < sizeof(tga_header_t))
-		return false;
-
-	tga_header_t *head = (tga_header_t *) data;
-
 	/* Image ID field */
-	tga->id_data = data + sizeof(tga_header_t);
 	tga->id_length = head->id_length;
 
-	if (size < sizeof(tga_header_t) + tga->id_length)
-		return false;
-
 	/* Color map type */
 	tga->cmap_type = head->cmap_type;
 
@@ -138,13 +149,8 @@ static bool decode_tga_header(void *data, size_t size, tga_t *tga)
 	tga->cmap_first_entry = uint16_t_le2host(head->cmap_first_entry);
 	tga->cmap_entries = uint16_t_le2host(head->cmap_entries);
 	tga->cmap_bpp = head->cmap_bpp;
-	tga->cmap_data = tga->id_data + tga->id_length;
 	tga->cmap_length = ALIGN_UP(tga->cmap_entries * tga->cmap_bpp, 8) >> 3;
 
-	if (size < sizeof(tga_header_t) + tga->id_length +
-	    tga->cmap_length)
-		return false;
-
 	/* Image specification */
 	tga->startx = uint16_t_le2host(head->startx);
 	tga->starty = uint16_t_le2host(head->starty);
@@ -153,49 +159,29 @@ static bool decode_tga_header(void *data, size_t size, tga_t *tga)
 	tga->img_bpp = head->img_bpp;
 	tga->img_alpha_bpp = head->img_descr & 0x0f;
 	tga->img_alpha_dir = (head->img_descr & 0xf0) >> 4;
-	tga->img_data = tga->cmap_data + tga->cmap_length;
-	tga->img_length = ALIGN_UP(tga->width * tga->height * tga->img_bpp, 8) >> 3;
-
-	if (size < sizeof(tga_header_t) + tga->id_length +
-	    tga->cmap_length + tga->img_length)
-		return false;
-
-	return true;
 }
 
-/** Decode Truevision TGA format
+/** Start decoding image data.
  *
- * Decode Truevision TGA format and create a surface
- * from it. The supported variants of TGA are currently
- * limited to uncompressed 24 bit true-color images without
- * alpha channel.
- *
- * @param gc      Graphic context
- * @param data    Memory representation of gzipped TGA.
- * @param size    Size of the representation (in bytes).
- * @param rbitmap Place to store pointer to new bitmap
- * @param rrect   Place to store bitmap rectangle
+ * Called once the header is complete. Checks for unsupported features
+ * and creates the bitmap the image is decoded into.
  *
- * @return EOK un success or an error code
+ * @param dec TGA decoder
+ * @return EOK on success or an error code
  */
-errno_t decode_tga(gfx_context_t *gc, void *data, size_t size,
-    gfx_bitmap_t **rbitmap, gfx_rect_t *rrect)
+static errno_t tga_decoder_start(tga_decoder_t *dec)
 {
 	gfx_bitmap_params_t params;
-	gfx_bitmap_alloc_t alloc;
-	gfx_bitmap_t *bitmap = NULL;
-	pixelmap_t pixelmap;
+	tga_t *tga = &dec->tga;
 	errno_t rc;
 
-	tga_t tga;
-	if (!decode_tga_header(data, size, &tga))
-		return EINVAL;
+	decode_tga_header((tga_header_t *) dec->head, tga);
 
 	/*
 	 * Check for unsupported features.
 	 */
 
-	switch (tga.cmap_type) {
+	switch (tga->cmap_type) {
 	case CMAP_NOT_PRESENT:
 		break;
 	default:
@@ -203,82 +189,213 @@ errno_t decode_tga(gfx_context_t *gc, void *data, size_t size,
 		return ENOTSUP;
 	}
 
-	switch (tga.img_type) {
+	switch (tga->img_type) {
 	case IMG_BGRA:
-		if (tga.img_bpp != 24)
+		if (tga->img_bpp != 24)
 			return ENOTSUP;
+		dec->conv = bgr_888_2pixel_row;
 		break;
 	case IMG_GRAY:
-		if (tga.img_bpp != 8)
+		if (tga->img_bpp != 8)
 			return ENOTSUP;
+		dec->conv = gray_8_2pixel_row;
 		break;
 	default:
 		/* Unsupported */
 		return ENOTSUP;
 	}
 
-	if (tga.img_alpha_bpp != 0)
+	if (tga->img_alpha_bpp != 0)
 		return ENOTSUP;
 
-	sysarg_t twidth = tga.startx + tga.width;
-	sysarg_t theight = tga.starty + tga.height;
+	if (tga->width == 0 || tga->height == 0)
+		return EINVAL;
+
+	dec->skip = tga->id_length + tga->cmap_length;
+	dec->row_size = (size_t) tga->width * (tga->img_bpp >> 3);
+
+	dec->row = malloc(dec->row_size);
+	if (dec->row == NULL)
+		return ENOMEM;
 
 	gfx_bitmap_params_init(&params);
-	params.rect.p1.x = twidth;
-	params.rect.p1.y = theight;
+	params.rect.p1.x = tga->startx + tga->width;
+	params.rect.p1.y = tga->starty + tga->height;
 
-	rc = gfx_bitmap_create(gc, &params, NULL, &bitmap);
+	rc = gfx_bitmap_create(dec->gc, &params, NULL, &dec->bitmap);
 	if (rc != EOK)
 		return rc;
 
-	rc = gfx_bitmap_get_alloc(bitmap, &alloc);
-	if (rc != EOK) {
-		gfx_bitmap_destroy(bitmap);
+	rc = gfx_bitmap_get_alloc(dec->bitmap, &dec->alloc);
+	if (rc != EOK)
 		return rc;
-	}
 
-	pixelmap.width = twidth;
-	pixelmap.height = theight;
-	pixelmap.data = alloc.pixels;
+	dec->rect = params.rect;
+	return EOK;
+}
 
-	/*
-	 * TGA is encoded in a bottom-up manner, the true-color
-	 * variant is in BGR 8:8:8 encoding.
-	 */
+/** Convert one image row into the bitmap.
+ *
+ * TGA is encoded in a bottom-up manner.
+ *
+ * @param dec TGA decoder
+ * @param data Row data
+ */
+static void tga_decoder_row(tga_decoder_t *dec, const uint8_t *data)
+{
+	size_t y = dec->tga.height - dec->rows - 1;
+	pixel_t *dst;
 
-	switch (tga.img_type) {
-	case IMG_BGRA:
-		for (sysarg_t y = tga.starty; y < theight; y++) {
-			for (sysarg_t x = tga.startx; x < twidth; x++) {
-				size_t offset =
-				    ((y - tga.starty) * tga.width + (x - tga.startx)) * 3;
-
-				pixel_t pixel =
-				    bgr_888_2pixel(((uint8_t *) tga.img_data) + offset);
-				pixelmap_put_pixel(&pixelmap, x, theight - y - 1, pixel);
+	dst = (pixel_t *) ((uint8_t *) dec->alloc.pixels + dec->alloc.off0 +
+	    y * dec->alloc.pitch) + dec->tga.startx;
+	dec->conv(dst, data, dec->tga.width);
+	dec->rows++;
+}
+
+/** Create streaming TGA decoder.
+ *
+ * The image is decoded row by row straight into a bitmap created
+ * in @a gc, as soon as the data is passed to tga_decoder_write().
+ * No copy of the encoded image needs to be held in memory.
+ *
+ * @param gc Graphic context
+ * @param rdec Place to store pointer to new decoder
+ * @return EOK on success or an error code
+ */
+errno_t tga_decoder_create(gfx_context_t *gc, tga_decoder_t **rdec)
+{
+	tga_decoder_t *dec;
+
+	dec = calloc(1, sizeof(tga_decoder_t));
+	if (dec == NULL)
+		return ENOMEM;
+
+	dec->gc = gc;
+	*rdec = dec;
+	return EOK;
+}
+
+/** Destroy streaming TGA decoder.
+ *
+ * The bitmap is destroyed too, unless it has been retrieved using
+ * tga_decoder_finish().
+ *
+ * @param dec TGA decoder
+ */
+void tga_decoder_destroy(tga_decoder_t *dec)
+{
+	if (dec->bitmap != NULL)
+		gfx_bitmap_destroy(dec->bitmap);
+	free(dec->row);
+	free(dec);
+}
+
+/** Feed data to streaming TGA decoder.
+ *
+ * @param dec TGA decoder
+ * @param data Next piece of TGA data
+ * @param size Size of @a data in bytes
+ * @return EOK on success or an error code
+ */
+errno_t tga_decoder_write(tga_decoder_t *dec, const void *data, size_t size)
+{
+	const uint8_t *dp = (const uint8_t *) data;
+	size_t n;
+	errno_t rc;
+
+	while (size > 0) {
+		if (dec->head_cnt < sizeof(tga_header_t)) {
+			/* Header */
+			n = min(size, sizeof(tga_header_t) - dec->head_cnt);
+			memcpy(dec->head + dec->head_cnt, dp, n);
+			dec->head_cnt += n;
+
+			if (dec->head_cnt == sizeof(tga_header_t)) {
+				rc = tga_decoder_start(dec);
+				if (rc != EOK)
+					return rc;
 			}
-		}
-		break;
-	case IMG_GRAY:
-		for (sysarg_t y = tga.starty; y < theight; y++) {
-			for (sysarg_t x = tga.startx; x < twidth; x++) {
-				size_t offset =
-				    (y - tga.starty) * tga.width + (x - tga.startx);
-
-				pixel_t pixel =
-				    gray_8_2pixel(((uint8_t *) tga.img_data) + offset);
-				pixelmap_put_pixel(&pixelmap, x, theight - y - 1, pixel);
+		} else if (dec->skip > 0) {
+			/* Image ID and color map */
+			n = min(size, dec->skip);
+			dec->skip -= n;
+		} else if (dec->rows == dec->tga.height) {
+			/* Ignore anything after image data */
+			return EOK;
+		} else if (dec->row_cnt == 0 && size >= dec->row_size) {
+			/* Complete row, convert it in place */
+			n = dec->row_size;
+			tga_decoder_row(dec, dp);
+		} else {
+			/* Row split between writes */
+			n = min(size, dec->row_size - dec->row_cnt);
+			memcpy(dec->row + dec->row_cnt, dp, n);
+			dec->row_cnt += n;
+
+			if (dec->row_cnt == dec->row_size) {
+				tga_decoder_row(dec, dec->row);
+				dec->row_cnt = 0;
 			}
 		}
-		break;
-	default:
-		break;
+
+		dp += n;
+		size -= n;
 	}
 
-	*rbitmap = bitmap;
-	*rrect = params.rect;
 	return EOK;
 }
 
+/** Finish decoding with streaming TGA decoder.
+ *
+ * @param dec TGA decoder
+ * @param rbitmap Place to store pointer to new bitmap
+ * @param rrect Place to store bitmap rectangle
+ * @return EOK on success, EINVAL if the image data is incomplete
+ */
+errno_t tga_decoder_finish(tga_decoder_t *dec, gfx_bitmap_t **rbitmap,
+    gfx_rect_t *rrect)
+{
+	if (dec->bitmap == NULL || dec->rows < dec->tga.height)
+		return EINVAL;
+
+	*rbitmap = dec->bitmap;
+	*rrect = dec->rect;
+	dec->bitmap = NULL;
+	return EOK;
+}
+
+/** Decode Truevision TGA format
+ *
+ * Decode Truevision TGA format and create a surface
+ * from it. The supported variants of TGA are currently
+ * limited to uncompressed 24 bit true-color images and
+ * 8 bit grayscale images without alpha channel.
+ *
+ * @param gc      Graphic context
+ * @param data    Memory representation of TGA.
+ * @param size    Size of the representation (in bytes).
+ * @param rbitmap Place to store pointer to new bitmap
+ * @param rrect   Place to store bitmap rectangle
+ *
+ * @return EOK un success or an error code
+ */
+errno_t decode_tga(gfx_context_t *gc, void *data, size_t size,
+    gfx_bitmap_t **rbitmap, gfx_rect_t *rrect)
+{
+	tga_decoder_t *dec;
+	errno_t rc;
+
+	rc = tga_decoder_create(gc, &dec);
+	if (rc != EOK)
+		return rc;
+
+	rc = tga_decoder_write(dec, data, size);
+	if (rc == EOK)
+		rc = tga_decoder_finish(dec, rbitmap, rrect);
+
+	tga_decoder_destroy(dec);
+	return rc;
+}
+
 /** @}
  */
@@ -39,6 +39,18 @@
 #include <gfximage/tga.h>
 #include <gfximage/tga_gz.h>
 
+/** Pass inflated data to TGA decoder.
+ *
+ * @param arg TGA decoder
+ * @param data Inflated data
+ * @param size Size of @a data in bytes
+ * @return EOK on success or an error code
+ */
+static errno_t decode_tga_gz_write(void *arg, const void *data, size_t size)
+{
+	return tga_decoder_write((tga_decoder_t *) arg, data, size);
+}
+
 /** Decode gzipped Truevision TGA format
  *
  * Decode gzipped Truevision TGA format and create a bitmap
@@ -56,16 +68,19 @@
 errno_t decode_tga_gz(gfx_context_t *gc, void *data, size_t size,
     gfx_bitmap_t **rbitmap, gfx_rect_t *rrect)
 {
-	void *data_expanded;
-	size_t size_expanded;
+	tga_decoder_t *dec;
 	errno_t rc;
 
-	rc = gzip_expand(data, size, &data_expanded, &size_expanded);
+	rc = tga_decoder_create(gc, &dec);
 	if (rc != EOK)
 		return rc;
 
-	rc = decode_tga(gc, data_expanded, size_expanded, rbitmap, rrect);
-	free(data_expanded);
+	/* Decode rows into the bitmap as they are being inflated */
+	rc = gzip_expand_stream(data, size, decode_tga_gz_write, dec);
+	if (rc == EOK)
+		rc = tga_decoder_finish(dec, rbitmap, rrect);
+
+	tga_decoder_destroy(dec);
 	return rc;
 }
 
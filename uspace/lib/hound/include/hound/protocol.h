@@ -88,6 +88,9 @@ errno_t hound_service_connect_source_sink(hound_sess_t *sess, const char *source
 errno_t hound_service_disconnect_source_sink(hound_sess_t *sess, const char *source,
     const char *sink);
 
+errno_t hound_service_get_xruns(hound_sess_t *sess, const char *sink,
+    size_t *underruns, size_t *overruns);
+
 errno_t hound_service_stream_enter(async_exch_t *exch, hound_context_id_t id,
     int flags, pcm_format_t format, size_t bsize);
 errno_t hound_service_stream_drain(async_exch_t *exch);
@@ -123,6 +126,8 @@ typedef struct hound_server_iface {
 	errno_t (*stream_data_write)(void *, void *, size_t);
 	/** Read data from the stream */
 	errno_t (*stream_data_read)(void *, void *, size_t);
+	/** Get xrun counters of a sink */
+	errno_t (*get_xruns)(void *, const char *, size_t *, size_t *);
 	void *server;
 } hound_server_iface_t;
 
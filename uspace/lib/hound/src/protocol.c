@@ -64,6 +64,8 @@ enum ipc_methods {
 	IPC_M_HOUND_STREAM_EXIT,
 	/** Wait until there is no data in the stream */
 	IPC_M_HOUND_STREAM_DRAIN,
+	/** Get xrun counters of a sink */
+	IPC_M_HOUND_GET_XRUNS,
 };
 
 /** PCM format conversion helper structure */
@@ -294,6 +296,41 @@ errno_t hound_service_disconnect_source_sink(hound_sess_t *sess, const char *sou
 	return ENOTSUP;
 }
 
+/**
+ * Get xrun counters of a sink.
+ * @param[in] sess Valid audio session.
+ * @param[in] sink Sink name, valid string.
+ * @param[out] underruns Number of times a connection ran out of data.
+ * @param[out] overruns Number of buffers dropped by full connections.
+ * @return Error code.
+ */
+errno_t hound_service_get_xruns(hound_sess_t *sess, const char *sink,
+    size_t *underruns, size_t *overruns)
+{
+	assert(sess);
+	assert(sink);
+
+	async_exch_t *exch = async_exchange_begin(sess);
+	if (!exch)
+		return ENOMEM;
+	ipc_call_t call;
+	aid_t id = async_send_0(exch, IPC_M_HOUND_GET_XRUNS, &call);
+	errno_t ret = id ? EOK : EPARTY;
+	if (ret == EOK)
+		ret = async_data_write_start(exch, sink, str_size(sink));
+	async_exchange_end(exch);
+
+	errno_t rc;
+	async_wait_for(id, &rc);
+	if (ret == EOK)
+		ret = rc;
+	if (ret == EOK) {
+		*underruns = ipc_get_arg1(&call);
+		*overruns = ipc_get_arg2(&call);
+	}
+	return ret;
+}
+
 /**
  * Switch IPC exchange to a STREAM mode.
  * @param exch IPC exchange.
@@ -557,6 +594,26 @@ void hound_connection_handler(ipc_call_t *icall, void *arg)
 			free(sink);
 			async_answer_0(&call, ret);
 			break;
+		case IPC_M_HOUND_GET_XRUNS:
+			/* check interface functions */
+			if (!server_iface || !server_iface->get_xruns) {
+				async_answer_0(&call, ENOTSUP);
+				break;
+			}
+
+			sink = NULL;
+			size_t underruns = 0;
+			size_t overruns = 0;
+
+			/* read sink name */
+			ret = async_data_write_accept(&sink, true, 0, 0, 0, 0);
+			if (ret == EOK)
+				ret = server_iface->get_xruns(
+				    server_iface->server, sink, &underruns,
+				    &overruns);
+			free(sink);
+			async_answer_2(&call, ret, underruns, overruns);
+			break;
 		case IPC_M_HOUND_STREAM_ENTER:
 			/* check interface functions */
 			if (!server_iface || !server_iface->is_record_context ||
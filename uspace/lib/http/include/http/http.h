@@ -59,14 +59,28 @@ typedef struct {
 	uint8_t major;
 } http_version_t;
 
+/** Number of buckets of the header lookup table */
+#define HTTP_HEADERS_BUCKETS 16
+
 typedef struct {
 	link_t link;
+	/** Link to http_headers_t.buckets */
+	link_t hlink;
+	/** Hash of the case-insensitive name */
+	size_t hash;
 	char *name;
 	char *value;
+	/** Header is stored in an arena of the header list */
+	bool arena;
 } http_header_t;
 
 typedef struct {
+	/** Headers in order of appearance */
 	list_t list;
+	/** Headers hashed by name */
+	list_t buckets[HTTP_HEADERS_BUCKETS];
+	/** Arenas holding received headers */
+	list_t arenas;
 } http_headers_t;
 
 typedef struct {
@@ -87,11 +101,6 @@ extern errno_t http_connect(http_t *);
 
 extern void http_header_init(http_header_t *);
 extern http_header_t *http_header_create(const char *, const char *);
-extern errno_t http_header_receive_name(receive_buffer_t *, receive_buffer_mark_t *);
-extern errno_t http_header_receive_value(receive_buffer_t *, receive_buffer_mark_t *,
-    receive_buffer_mark_t *);
-extern errno_t http_header_receive(receive_buffer_t *, http_header_t *, size_t,
-    size_t *);
 extern void http_header_normalize_value(char *);
 extern bool http_header_name_match(const char *, const char *);
 ssize_t http_header_encode(http_header_t *, char *, size_t);
@@ -103,25 +112,17 @@ extern errno_t http_headers_find_single(http_headers_t *, const char *,
 extern errno_t http_headers_append(http_headers_t *, const char *, const char *);
 extern errno_t http_headers_set(http_headers_t *, const char *, const char *);
 extern errno_t http_headers_get(http_headers_t *, const char *, char **);
+extern errno_t http_headers_parse(http_headers_t *, const char *, size_t,
+    unsigned);
 extern errno_t http_headers_receive(receive_buffer_t *, http_headers_t *, size_t,
     unsigned);
+extern void http_headers_remove(http_headers_t *, http_header_t *);
+extern void http_headers_append_header(http_headers_t *, http_header_t *);
 extern void http_headers_clear(http_headers_t *);
 
 #define http_headers_foreach(headers, iter) \
     list_foreach((headers).list, link, http_header_t, (iter))
 
-static inline void http_headers_remove(http_headers_t *headers,
-    http_header_t *header)
-{
-	list_remove(&header->link);
-}
-
-static inline void http_headers_append_header(http_headers_t *headers,
-    http_header_t *header)
-{
-	list_append(&header->link, &headers->list);
-}
-
 extern http_request_t *http_request_create(const char *, const char *);
 extern void http_request_destroy(http_request_t *);
 extern errno_t http_request_format(http_request_t *, char **, size_t *);
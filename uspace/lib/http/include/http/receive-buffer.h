@@ -67,6 +67,14 @@ typedef struct {
 	size_t offset;
 } receive_buffer_mark_t;
 
+/** Data in the receive buffer referenced in place */
+typedef struct {
+	/** Offset of the first byte in the buffer */
+	size_t offset;
+	/** Number of bytes */
+	size_t size;
+} receive_buffer_span_t;
+
 typedef bool (*char_class_func_t)(char);
 
 extern errno_t recv_buffer_init(receive_buffer_t *, size_t, receive_func_t, void *);
@@ -87,6 +95,18 @@ extern errno_t recv_discard_str(receive_buffer_t *, const char *, size_t *);
 extern errno_t recv_while(receive_buffer_t *, char_class_func_t);
 extern errno_t recv_eol(receive_buffer_t *, size_t *);
 extern errno_t recv_line(receive_buffer_t *, char *, size_t, size_t *);
+extern errno_t recv_span_line(receive_buffer_t *, receive_buffer_span_t *);
+extern errno_t recv_span_block(receive_buffer_t *, receive_buffer_span_t *);
+
+/** Get pointer to data referenced by span.
+ *
+ * The data is only valid until the next receive operation.
+ */
+static inline char *recv_span_data(receive_buffer_t *rb,
+    receive_buffer_span_t *span)
+{
+	return rb->buffer + span->offset;
+}
 
 #endif
 
@@ -33,6 +33,8 @@
  * @file
  */
 
+
+#include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -44,11 +46,36 @@
 
 #define HTTP_HEADER_LINE "%s: %s\r\n"
 
+/** Arena holding all headers of one received header block */
+typedef struct {
+	/** Link to http_headers_t.arenas */
+	link_t link;
+	/** Headers, followed by their names and values */
+	http_header_t headers[];
+} http_headers_arena_t;
+
+/** Compute hash of a header name.
+ *
+ * Header names are case-insensitive.
+ */
+static size_t http_header_name_hash(const char *name)
+{
+	size_t hash = 0;
+
+	while (*name != '\0')
+		hash = hash * 31 + tolower((unsigned char) *name++);
+
+	return hash;
+}
+
 void http_header_init(http_header_t *header)
 {
 	link_initialize(&header->link);
+	link_initialize(&header->hlink);
+	header->hash = 0;
 	header->name = NULL;
 	header->value = NULL;
+	header->arena = false;
 }
 
 http_header_t *http_header_create(const char *name, const char *value)
@@ -76,6 +103,10 @@ http_header_t *http_header_create(const char *name, const char *value)
 
 void http_header_destroy(http_header_t *header)
 {
+	/* Received headers are freed with their arena */
+	if (header->arena)
+		return;
+
 	free(header->name);
 	free(header->value);
 	free(header);
@@ -88,132 +119,6 @@ ssize_t http_header_encode(http_header_t *header, char *buf, size_t buf_size)
 	    HTTP_HEADER_LINE, header->name, header->value);
 }
 
-errno_t http_header_receive_name(receive_buffer_t *rb,
-    receive_buffer_mark_t *name_end)
-{
-	char c = 0;
-	do {
-		if (name_end)
-			recv_mark_update(rb, name_end);
-
-		errno_t rc = recv_char(rb, &c, true);
-		if (rc != EOK)
-			return rc;
-	} while (is_token(c));
-
-	if (c != ':')
-		return EINVAL;
-
-	return EOK;
-}
-
-errno_t http_header_receive_value(receive_buffer_t *rb,
-    receive_buffer_mark_t *value_start, receive_buffer_mark_t *value_end)
-{
-	errno_t rc = EOK;
-	char c = 0;
-
-	/* Ignore any inline LWS */
-	while (true) {
-		if (value_start)
-			recv_mark_update(rb, value_start);
-
-		rc = recv_char(rb, &c, false);
-		if (rc != EOK)
-			return rc;
-
-		if (c != ' ' && c != '\t')
-			break;
-
-		rc = recv_char(rb, &c, true);
-		if (rc != EOK)
-			return rc;
-	}
-
-	while (true) {
-		recv_mark_update(rb, value_end);
-
-		rc = recv_char(rb, &c, true);
-		if (rc != EOK)
-			return rc;
-
-		if (c != '\r' && c != '\n')
-			continue;
-
-		size_t nrecv;
-		rc = recv_discard(rb, (c == '\r' ? '\n' : '\r'), &nrecv);
-		if (rc != EOK)
-			return rc;
-
-		rc = recv_char(rb, &c, false);
-		if (rc != EOK)
-			return rc;
-
-		if (c != ' ' && c != '\t')
-			break;
-
-		/* Ignore the char */
-		rc = recv_char(rb, &c, true);
-		if (rc != EOK)
-			return rc;
-	}
-
-	return EOK;
-}
-
-errno_t http_header_receive(receive_buffer_t *rb, http_header_t *header,
-    size_t size_limit, size_t *out_bytes_used)
-{
-	receive_buffer_mark_t mark_start;
-	receive_buffer_mark_t mark_end;
-
-	recv_mark(rb, &mark_start);
-	recv_mark(rb, &mark_end);
-
-	errno_t rc = http_header_receive_name(rb, &mark_end);
-	if (rc != EOK)
-		goto end;
-
-	size_t name_size = mark_end.offset - mark_start.offset;
-	if (size_limit > 0 && name_size > size_limit) {
-		rc = ELIMIT;
-		goto end;
-	}
-
-	char *name = NULL;
-	rc = recv_cut_str(rb, &mark_start, &mark_end, &name);
-	if (rc != EOK)
-		goto end;
-
-	rc = http_header_receive_value(rb, &mark_start, &mark_end);
-	if (rc != EOK)
-		goto end_with_name;
-
-	size_t value_size = mark_end.offset - mark_start.offset;
-	if (size_limit > 0 && (name_size + value_size) > size_limit) {
-		rc = ELIMIT;
-		goto end_with_name;
-	}
-
-	char *value = NULL;
-	rc = recv_cut_str(rb, &mark_start, &mark_end, &value);
-	if (rc != EOK)
-		goto end_with_name;
-
-	if (out_bytes_used)
-		*out_bytes_used = name_size + value_size;
-
-	header->name = name;
-	header->value = value;
-	goto end;
-end_with_name:
-	free(name);
-end:
-	recv_unmark(rb, &mark_start);
-	recv_unmark(rb, &mark_end);
-	return rc;
-}
-
 /** Normalize HTTP header value
  *
  * @see RFC2616 section 4.2
@@ -254,14 +159,36 @@ bool http_header_name_match(const char *name_a, const char *name_b)
 void http_headers_init(http_headers_t *headers)
 {
 	list_initialize(&headers->list);
+	for (size_t i = 0; i < HTTP_HEADERS_BUCKETS; i++)
+		list_initialize(&headers->buckets[i]);
+	list_initialize(&headers->arenas);
+}
+
+void http_headers_append_header(http_headers_t *headers,
+    http_header_t *header)
+{
+	header->hash = http_header_name_hash(header->name);
+	list_append(&header->link, &headers->list);
+	list_append(&header->hlink,
+	    &headers->buckets[header->hash % HTTP_HEADERS_BUCKETS]);
+}
+
+void http_headers_remove(http_headers_t *headers, http_header_t *header)
+{
+	list_remove(&header->link);
+	list_remove(&header->hlink);
 }
 
 errno_t http_headers_find_single(http_headers_t *headers, const char *name,
     http_header_t **out_header)
 {
 	http_header_t *found = NULL;
-	http_headers_foreach(*headers, header) {
-		if (!http_header_name_match(header->name, name))
+	size_t hash = http_header_name_hash(name);
+
+	list_foreach(headers->buckets[hash % HTTP_HEADERS_BUCKETS], hlink,
+	    http_header_t, header) {
+		if (header->hash != hash ||
+		    !http_header_name_match(header->name, name))
 			continue;
 
 		if (found == NULL) {
@@ -300,6 +227,20 @@ errno_t http_headers_set(http_headers_t *headers, const char *name,
 	if (rc == HTTP_EMISSING_HEADER)
 		return http_headers_append(headers, name, value);
 
+	if (header->arena) {
+		/* Replace received header with one we can modify */
+		http_header_t *new_header = http_header_create(header->name,
+		    value);
+		if (new_header == NULL)
+			return ENOMEM;
+
+		new_header->hash = header->hash;
+		list_insert_before(&new_header->link, &header->link);
+		list_insert_before(&new_header->hlink, &header->hlink);
+		http_headers_remove(headers, header);
+		return EOK;
+	}
+
 	char *new_value = str_dup(value);
 	if (new_value == NULL)
 		return ENOMEM;
@@ -320,66 +261,180 @@ errno_t http_headers_get(http_headers_t *headers, const char *name, char **value
 	return EOK;
 }
 
-errno_t http_headers_receive(receive_buffer_t *rb, http_headers_t *headers,
-    size_t limit_alloc, unsigned limit_count)
+/** Terminate header value, removing trailing whitespace. */
+static void http_header_value_end(char *value, char *end)
+{
+	while (end > value && (end[-1] == ' ' || end[-1] == '\t'))
+		--end;
+
+	*end = '\0';
+}
+
+/** Parse block of header lines.
+ *
+ * All headers and their names and values are stored in a single arena
+ * allocation, names and values are cut out of a copy of @a block in place.
+ *
+ * @param headers     Header list to append the headers to
+ * @param block       Header lines, each terminated by LF or CRLF, followed
+ *                    by an empty line
+ * @param size        Size of @a block
+ * @param limit_count Maximum number of headers or zero for no limit
+ * @return EOK on success or an error code
+ */
+errno_t http_headers_parse(http_headers_t *headers, const char *block,
+    size_t size, unsigned limit_count)
 {
-	errno_t rc = EOK;
-	unsigned added = 0;
+	http_headers_arena_t *arena;
+	http_header_t *header = NULL;
+	size_t nlines = 0;
+	size_t count = 0;
+	char *text;
+	char *end;
+	char *p;
+	char *lf;
+	char *line_end;
+	char *value_end = NULL;
+	errno_t rc;
+
+	if (memchr(block, '\0', size) != NULL)
+		return EIO;
+
+	/* Each header takes at least one line */
+	for (p = memchr(block, '\n', size); p != NULL;
+	    p = memchr(p + 1, '\n', block + size - p - 1))
+		++nlines;
+
+	arena = malloc(sizeof(http_headers_arena_t) +
+	    nlines * sizeof(http_header_t) + size + 1);
+	if (arena == NULL)
+		return ENOMEM;
+
+	text = (char *) &arena->headers[nlines];
+	memcpy(text, block, size);
+	text[size] = '\0';
+	end = text + size;
 
-	while (true) {
-		char c = 0;
-		rc = recv_char(rb, &c, false);
-		if (rc != EOK)
+	p = text;
+	while (p < end) {
+		lf = memchr(p, '\n', end - p);
+		if (lf == NULL) {
+			rc = HTTP_EPARSE;
 			goto error;
+		}
+
+		line_end = lf;
+		if (line_end > p && line_end[-1] == '\r')
+			--line_end;
 
-		if (c == '\n' || c == '\r')
+		/* Empty line terminates the block */
+		if (line_end == p)
 			break;
 
-		if (limit_count > 0 && added >= limit_count) {
-			rc = ELIMIT;
-			goto error;
+		if (*p == ' ' || *p == '\t') {
+			/* Continuation of the previous value */
+			if (header == NULL) {
+				rc = HTTP_EPARSE;
+				goto error;
+			}
+
+			for (char *q = value_end; q < p; q++)
+				*q = ' ';
+			value_end = line_end;
+			p = lf + 1;
+			continue;
 		}
 
-		http_header_t *header = malloc(sizeof(http_header_t));
-		if (header == NULL) {
-			rc = ENOMEM;
+		if (header != NULL)
+			http_header_value_end(header->value, value_end);
+
+		if (limit_count > 0 && count >= limit_count) {
+			rc = ELIMIT;
 			goto error;
 		}
+
+		header = &arena->headers[count++];
 		http_header_init(header);
+		header->arena = true;
+		header->name = p;
+
+		while (p < line_end && is_token(*p))
+			++p;
 
-		size_t header_size;
-		rc = http_header_receive(rb, header, limit_alloc, &header_size);
-		if (rc != EOK) {
-			free(header);
+		if (p == header->name || p == line_end || *p != ':') {
+			rc = EINVAL;
 			goto error;
 		}
-		limit_alloc -= header_size;
 
-		http_headers_append_header(headers, header);
-		added++;
+		*p++ = '\0';
+
+		/* Ignore any inline LWS */
+		while (p < line_end && (*p == ' ' || *p == '\t'))
+			++p;
+
+		header->value = p;
+		value_end = line_end;
+		p = lf + 1;
 	}
 
+	if (header != NULL)
+		http_header_value_end(header->value, value_end);
+
+	for (size_t i = 0; i < count; i++)
+		http_headers_append_header(headers, &arena->headers[i]);
+
+	link_initialize(&arena->link);
+	list_append(&arena->link, &headers->arenas);
 	return EOK;
 error:
-	while (added-- > 0) {
-		link_t *link = list_last(&headers->list);
-		http_header_t *header = list_get_instance(link, http_header_t, link);
-		http_headers_remove(headers, header);
-		http_header_destroy(header);
-	}
+	free(arena);
 	return rc;
 }
 
+/** Receive headers.
+ *
+ * The whole header block is located in the receive buffer first and then
+ * parsed in place, so it must fit in the buffer.
+ *
+ * @param rb          Receive buffer
+ * @param headers     Header list to append the headers to
+ * @param limit_alloc Maximum size of the header block or zero for no limit
+ * @param limit_count Maximum number of headers or zero for no limit
+ * @return EOK on success or an error code
+ */
+errno_t http_headers_receive(receive_buffer_t *rb, http_headers_t *headers,
+    size_t limit_alloc, unsigned limit_count)
+{
+	receive_buffer_span_t span;
+	errno_t rc;
+
+	rc = recv_span_block(rb, &span);
+	if (rc != EOK)
+		return rc;
+
+	if (limit_alloc > 0 && span.size > limit_alloc)
+		return ELIMIT;
+
+	return http_headers_parse(headers, recv_span_data(rb, &span),
+	    span.size, limit_count);
+}
+
 void http_headers_clear(http_headers_t *headers)
 {
 	link_t *link = list_first(&headers->list);
 	while (link != NULL) {
 		link_t *next = list_next(link, &headers->list);
 		http_header_t *header = list_get_instance(link, http_header_t, link);
-		list_remove(link);
+		http_headers_remove(headers, header);
 		http_header_destroy(header);
 		link = next;
 	}
+
+	while (!list_empty(&headers->arenas)) {
+		link = list_first(&headers->arenas);
+		list_remove(link);
+		free(list_get_instance(link, http_headers_arena_t, link));
+	}
 }
 
 /** @}
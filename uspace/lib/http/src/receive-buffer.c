@@ -144,35 +144,65 @@ errno_t recv_cut_str(receive_buffer_t *rb, receive_buffer_mark_t *a, receive_buf
 	return EOK;
 }
 
-/** Receive one character (with buffering) */
-errno_t recv_char(receive_buffer_t *rb, char *c, bool consume)
+/** Discard consumed data that is not needed by any mark.
+ *
+ * @return EOK on success, ELIMIT if no data can be discarded
+ */
+static errno_t recv_compact(receive_buffer_t *rb)
 {
-	if (rb->out == rb->in) {
-		size_t free = rb->size - rb->in;
-		if (free == 0) {
-			size_t min_mark = rb->size;
-			list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
-				min_mark = min(min_mark, mark->offset);
-			}
+	size_t min_mark = rb->out;
+	list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
+		min_mark = min(min_mark, mark->offset);
+	}
 
-			if (min_mark == 0)
-				return ELIMIT;
+	if (min_mark == 0)
+		return ELIMIT;
 
-			size_t new_in = rb->in - min_mark;
-			memmove(rb->buffer, rb->buffer + min_mark, new_in);
-			rb->out = rb->in = new_in;
-			free = rb->size - rb->in;
-			list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
-				mark->offset -= min_mark;
-			}
-		}
+	memmove(rb->buffer, rb->buffer + min_mark, rb->in - min_mark);
+	rb->in -= min_mark;
+	rb->out -= min_mark;
+	list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
+		mark->offset -= min_mark;
+	}
 
-		size_t nrecv;
-		errno_t rc = rb->receive(rb->client_data, rb->buffer + rb->in, free, &nrecv);
+	return EOK;
+}
+
+/** Append more received data to the buffer.
+ *
+ * @return EOK on success, ELIMIT if the buffer is full, EIO if the
+ *         connection was closed or other error code
+ */
+static errno_t recv_more(receive_buffer_t *rb)
+{
+	size_t nrecv;
+	errno_t rc;
+
+	if (rb->in == rb->size) {
+		rc = recv_compact(rb);
 		if (rc != EOK)
 			return rc;
+	}
 
-		rb->in = nrecv;
+	rc = rb->receive(rb->client_data, rb->buffer + rb->in,
+	    rb->size - rb->in, &nrecv);
+	if (rc != EOK)
+		return rc;
+
+	if (nrecv == 0)
+		return EIO;
+
+	rb->in += nrecv;
+	return EOK;
+}
+
+/** Receive one character (with buffering) */
+errno_t recv_char(receive_buffer_t *rb, char *c, bool consume)
+{
+	if (rb->out == rb->in) {
+		errno_t rc = recv_more(rb);
+		if (rc != EOK)
+			return rc;
 	}
 
 	*c = rb->buffer[rb->out];
@@ -322,5 +352,104 @@ errno_t recv_line(receive_buffer_t *rb, char *line, size_t size, size_t *nrecv)
 	return ELIMIT;
 }
 
+/** Find end of line or of block of lines.
+ *
+ * Receives more data as needed. Each received byte is examined only once,
+ * no matter how the data is split among reads.
+ *
+ * @param rb    Receive buffer
+ * @param block @c true to find the empty line terminating a block of lines
+ * @param rsize Place to store number of bytes up to and including the LF
+ * @return EOK on success or an error code
+ */
+static errno_t recv_find_eol(receive_buffer_t *rb, bool block, size_t *rsize)
+{
+	/* Offsets relative to rb->out stay valid when the buffer is compacted */
+	size_t scan = 0;
+	size_t line = 0;
+	char *lf;
+	errno_t rc;
+
+	while (true) {
+		while (rb->out + scan < rb->in) {
+			lf = memchr(rb->buffer + rb->out + scan, '\n',
+			    rb->in - rb->out - scan);
+			if (lf == NULL) {
+				scan = rb->in - rb->out;
+				break;
+			}
+
+			scan = lf - (rb->buffer + rb->out) + 1;
+
+			/* Empty line is LF or CRLF */
+			if (!block || scan - line == 1 || (scan - line == 2 &&
+			    rb->buffer[rb->out + line] == '\r')) {
+				*rsize = scan;
+				return EOK;
+			}
+
+			line = scan;
+		}
+
+		rc = recv_more(rb);
+		if (rc != EOK)
+			return rc;
+	}
+}
+
+/** Receive a line and reference it in the buffer.
+ *
+ * The line must fit in the buffer. It is not copied; @a span stays valid
+ * until the next receive operation.
+ *
+ * @param rb   Receive buffer
+ * @param span Place to store the line without the line terminator
+ * @return EOK on success, ELIMIT if the line does not fit in the buffer
+ *         or other error code
+ */
+errno_t recv_span_line(receive_buffer_t *rb, receive_buffer_span_t *span)
+{
+	size_t size;
+	errno_t rc;
+
+	rc = recv_find_eol(rb, false, &size);
+	if (rc != EOK)
+		return rc;
+
+	span->offset = rb->out;
+	span->size = size - 1;
+	if (span->size > 0 && rb->buffer[rb->out + span->size - 1] == '\r')
+		--span->size;
+
+	rb->out += size;
+	return EOK;
+}
+
+/** Receive a block of lines terminated by an empty line.
+ *
+ * The block must fit in the buffer. It is not copied; @a span stays valid
+ * until the next receive operation.
+ *
+ * @param rb   Receive buffer
+ * @param span Place to store the block including the empty line
+ * @return EOK on success, ELIMIT if the block does not fit in the buffer
+ *         or other error code
+ */
+errno_t recv_span_block(receive_buffer_t *rb, receive_buffer_span_t *span)
+{
+	size_t size;
+	errno_t rc;
+
+	rc = recv_find_eol(rb, true, &size);
+	if (rc != EOK)
+		return rc;
+
+	span->offset = rb->out;
+	span->size = size;
+
+	rb->out += size;
+	return EOK;
+}
+
 /** @}
  */
@@ -46,139 +46,108 @@ static bool is_digit(char c)
 	return (c >= '0' && c <= '9');
 }
 
-static errno_t receive_number(receive_buffer_t *rb, char **str)
-{
-	receive_buffer_mark_t start;
-	receive_buffer_mark_t end;
-
-	recv_mark(rb, &start);
-	errno_t rc = recv_while(rb, is_digit);
-	if (rc != EOK) {
-		recv_unmark(rb, &start);
-		return rc;
-	}
-	recv_mark(rb, &end);
-
-	rc = recv_cut_str(rb, &start, &end, str);
-	recv_unmark(rb, &start);
-	recv_unmark(rb, &end);
-	return rc;
-}
-
-static errno_t receive_uint8_t(receive_buffer_t *rb, uint8_t *out_value)
+/** Parse decimal number in place.
+ *
+ * @param pp  Current position, advanced past the number
+ * @param end End of the text
+ * @param max Maximum allowed value
+ * @param out_value Place to store the number
+ * @return EOK on success, HTTP_EPARSE if there is no number or it
+ *         exceeds @a max
+ */
+static errno_t parse_number(const char **pp, const char *end, unsigned max,
+    unsigned *out_value)
 {
-	char *str = NULL;
-	errno_t rc = receive_number(rb, &str);
+	const char *p = *pp;
+	unsigned value = 0;
 
-	if (rc != EOK)
-		return rc;
+	if (p >= end || !is_digit(*p))
+		return HTTP_EPARSE;
 
-	rc = str_uint8_t(str, NULL, 10, true, out_value);
-	free(str);
+	while (p < end && is_digit(*p)) {
+		value = value * 10 + (*p - '0');
+		if (value > max)
+			return HTTP_EPARSE;
+		++p;
+	}
 
-	return rc;
+	*pp = p;
+	*out_value = value;
+	return EOK;
 }
 
-static errno_t receive_uint16_t(receive_buffer_t *rb, uint16_t *out_value)
+/** Skip expected string.
+ *
+ * @return EOK if the text at @a *pp starts with @a expect, HTTP_EPARSE
+ *         otherwise
+ */
+static errno_t parse_expect(const char **pp, const char *end,
+    const char *expect)
 {
-	char *str = NULL;
-	errno_t rc = receive_number(rb, &str);
-
-	if (rc != EOK)
-		return rc;
-
-	rc = str_uint16_t(str, NULL, 10, true, out_value);
-	free(str);
+	size_t len = str_size(expect);
 
-	return rc;
-}
-
-static errno_t expect(receive_buffer_t *rb, const char *expect)
-{
-	size_t ndisc;
-	errno_t rc = recv_discard_str(rb, expect, &ndisc);
-	if (rc != EOK)
-		return rc;
-	if (ndisc < str_length(expect))
+	if ((size_t) (end - *pp) < len || memcmp(*pp, expect, len) != 0)
 		return HTTP_EPARSE;
-	return EOK;
-}
 
-static bool is_not_newline(char c)
-{
-	return (c != '\n' && c != '\r');
+	*pp += len;
+	return EOK;
 }
 
 errno_t http_receive_status(receive_buffer_t *rb, http_version_t *out_version,
     uint16_t *out_status, char **out_message)
 {
-	http_version_t version;
-	uint16_t status;
+	receive_buffer_span_t span;
+	unsigned major, minor, status;
 	char *message = NULL;
 
-	errno_t rc = expect(rb, "HTTP/");
+	errno_t rc = recv_span_line(rb, &span);
 	if (rc != EOK)
 		return rc;
 
-	rc = receive_uint8_t(rb, &version.major);
+	const char *p = recv_span_data(rb, &span);
+	const char *end = p + span.size;
+
+	rc = parse_expect(&p, end, "HTTP/");
 	if (rc != EOK)
 		return rc;
 
-	rc = expect(rb, ".");
+	rc = parse_number(&p, end, UINT8_MAX, &major);
 	if (rc != EOK)
 		return rc;
 
-	rc = receive_uint8_t(rb, &version.minor);
+	rc = parse_expect(&p, end, ".");
 	if (rc != EOK)
 		return rc;
 
-	rc = expect(rb, " ");
+	rc = parse_number(&p, end, UINT8_MAX, &minor);
 	if (rc != EOK)
 		return rc;
 
-	rc = receive_uint16_t(rb, &status);
+	rc = parse_expect(&p, end, " ");
 	if (rc != EOK)
 		return rc;
 
-	rc = expect(rb, " ");
+	rc = parse_number(&p, end, UINT16_MAX, &status);
 	if (rc != EOK)
 		return rc;
 
-	receive_buffer_mark_t msg_start;
-	recv_mark(rb, &msg_start);
-
-	rc = recv_while(rb, is_not_newline);
-	if (rc != EOK) {
-		recv_unmark(rb, &msg_start);
+	rc = parse_expect(&p, end, " ");
+	if (rc != EOK)
 		return rc;
-	}
-
-	receive_buffer_mark_t msg_end;
-	recv_mark(rb, &msg_end);
 
 	if (out_message) {
-		rc = recv_cut_str(rb, &msg_start, &msg_end, &message);
-		if (rc != EOK) {
-			recv_unmark(rb, &msg_start);
-			recv_unmark(rb, &msg_end);
-			return rc;
-		}
-	}
-
-	recv_unmark(rb, &msg_start);
-	recv_unmark(rb, &msg_end);
+		if (memchr(p, '\0', end - p) != NULL)
+			return HTTP_EPARSE;
 
-	size_t nrecv;
-	rc = recv_eol(rb, &nrecv);
-	if (rc == EOK && nrecv == 0)
-		rc = HTTP_EPARSE;
-	if (rc != EOK) {
-		free(message);
-		return rc;
+		message = str_ndup(p, end - p);
+		if (message == NULL)
+			return ENOMEM;
 	}
 
-	if (out_version)
-		*out_version = version;
+	if (out_version) {
+		out_version->major = major;
+		out_version->minor = minor;
+	}
 	if (out_status)
 		*out_status = status;
 	if (out_message)
@@ -205,13 +174,6 @@ errno_t http_receive_response(receive_buffer_t *rb, http_response_t **out_respon
 	if (rc != EOK)
 		goto error;
 
-	size_t nrecv;
-	rc = recv_eol(rb, &nrecv);
-	if (rc == EOK && nrecv == 0)
-		rc = HTTP_EPARSE;
-	if (rc != EOK)
-		goto error;
-
 	*out_response = resp;
 
 	return EOK;
@@ -37,6 +37,8 @@
 
 #include <inet/inet.h>
 #include <inet/addr.h>
+#include <stddef.h>
+#include <types/dnsr.h>
 
 enum {
 	DNSR_NAME_MAX_SIZE = 255
@@ -54,6 +56,8 @@ extern errno_t dnsr_name2host(const char *, dnsr_hostinfo_t **, ip_ver_t);
 extern void dnsr_hostinfo_destroy(dnsr_hostinfo_t *);
 extern errno_t dnsr_get_srvaddr(inet_addr_t *);
 extern errno_t dnsr_set_srvaddr(inet_addr_t *);
+extern errno_t dnsr_get_cache_stats(dnsr_cache_stats_t *);
+extern errno_t dnsr_set_cache_size(size_t);
 
 #endif
 
@@ -55,6 +55,7 @@ extern errno_t inetcfg_sroute_get_id(const char *, sysarg_t *);
 extern errno_t inetcfg_sroute_create(const char *, inet_naddr_t *, inet_addr_t *,
     sysarg_t *);
 extern errno_t inetcfg_sroute_delete(sysarg_t);
+extern errno_t inetcfg_reass_stats_get(inet_reass_stats_t *);
 
 #endif
 
@@ -35,16 +35,36 @@
 #ifndef LIBINET_INET_IPLINK_H
 #define LIBINET_INET_IPLINK_H
 
+#include <adt/pkt_ring.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 
 struct iplink_ev_ops;
 
+/** Link verifies TCP/UDP checksums of received packets */
+#define IPLINK_OFFLOAD_RX_CSUM  0x1
+/** Link computes TCP/UDP checksums of sent packets */
+#define IPLINK_OFFLOAD_TX_CSUM  0x2
+/** Link splits TCP over IPv4 packets larger than the MTU into segments */
+#define IPLINK_OFFLOAD_TSO      0x4
+
+/** Number of slots in the ring of received packets */
+#define IPLINK_RING_SLOTS  256
+/** Size of a slot in the ring of received packets */
+#define IPLINK_RING_SLOT_SIZE  2048
+
 typedef struct {
 	async_sess_t *sess;
 	struct iplink_ev_ops *ev_ops;
 	void *arg;
+	/** Area holding the ring of received packets, NULL if not shared */
+	void *rx_ring_area;
+	/** Ring of received packets */
+	pkt_ring_t rx_ring;
+	/** Rung by the link when it publishes packets in the ring */
+	fibril_semaphore_t rx_ring_doorbell;
 } iplink_t;
 
 /** IPv4 link Service Data Unit */
@@ -57,6 +77,14 @@ typedef struct {
 	void *data;
 	/** Size of @c data in bytes */
 	size_t size;
+	/** Offloads requested (IPLINK_OFFLOAD_TX_CSUM, IPLINK_OFFLOAD_TSO) */
+	uint32_t offload;
+	/** Offset of the transport header in @c data */
+	uint16_t csum_start;
+	/** Offset of the checksum field from @c csum_start */
+	uint16_t csum_offs;
+	/** Maximum segment size with IPLINK_OFFLOAD_TSO */
+	uint16_t mss;
 } iplink_sdu_t;
 
 /** IPv6 link Service Data Unit */
@@ -75,6 +103,8 @@ typedef struct {
 	void *data;
 	/** Size of @c data in bytes */
 	size_t size;
+	/** Checksums verified by the link (IPLINK_OFFLOAD_RX_CSUM) */
+	uint32_t offload;
 } iplink_recv_sdu_t;
 
 typedef struct iplink_ev_ops {
@@ -89,6 +119,7 @@ extern errno_t iplink_send6(iplink_t *, iplink_sdu6_t *);
 extern errno_t iplink_addr_add(iplink_t *, inet_addr_t *);
 extern errno_t iplink_addr_remove(iplink_t *, inet_addr_t *);
 extern errno_t iplink_get_mtu(iplink_t *, size_t *);
+extern errno_t iplink_get_offload(iplink_t *, uint32_t *);
 extern errno_t iplink_get_mac48(iplink_t *, eth_addr_t *);
 extern errno_t iplink_set_mac48(iplink_t *, eth_addr_t *);
 extern void *iplink_get_userptr(iplink_t *);
@@ -35,6 +35,7 @@
 #ifndef LIBINET_INET_IPLINK_SRV_H
 #define LIBINET_INET_IPLINK_SRV_H
 
+#include <adt/pkt_ring.h>
 #include <async.h>
 #include <fibril_synch.h>
 #include <inet/addr.h>
@@ -50,6 +51,10 @@ typedef struct {
 	struct iplink_ops *ops;
 	void *arg;
 	async_sess_t *client_sess;
+	/** Area holding the client's ring of received packets or NULL */
+	void *rx_ring_area;
+	/** Client's ring of received packets, protected by @c lock */
+	pkt_ring_t rx_ring;
 } iplink_srv_t;
 
 typedef struct iplink_ops {
@@ -62,6 +67,8 @@ typedef struct iplink_ops {
 	errno_t (*set_mac48)(iplink_srv_t *, eth_addr_t *);
 	errno_t (*addr_add)(iplink_srv_t *, inet_addr_t *);
 	errno_t (*addr_remove)(iplink_srv_t *, inet_addr_t *);
+	/** Get supported offloads (IPLINK_OFFLOAD_*), optional */
+	errno_t (*get_offload)(iplink_srv_t *, uint32_t *);
 } iplink_ops_t;
 
 extern void iplink_srv_init(iplink_srv_t *);
@@ -39,6 +39,8 @@
 #include <inet/addr.h>
 #include <inet/endpoint.h>
 #include <inet/inet.h>
+#include <offset.h>
+#include <types/tcp.h>
 
 /** TCP connection */
 typedef struct {
@@ -95,6 +97,14 @@ typedef struct tcp {
 	fibril_condvar_t cv;
 	/** Set to @a true when callback connection handler has terminated */
 	bool cb_done;
+	/** Protects buffer shared with the TCP service */
+	fibril_mutex_t shm_lock;
+	/** Buffer shared with the TCP service for sending files or @c NULL */
+	void *shm;
+	/** Size of @c shm */
+	size_t shm_size;
+	/** TCP service does not support the shared buffer */
+	bool shm_failed;
 } tcp_t;
 
 extern errno_t tcp_create(tcp_t **);
@@ -110,12 +120,16 @@ extern void *tcp_listener_userptr(tcp_listener_t *);
 
 extern errno_t tcp_conn_wait_connected(tcp_conn_t *);
 extern errno_t tcp_conn_send(tcp_conn_t *, const void *, size_t);
+extern errno_t tcp_conn_send_file(tcp_conn_t *, int, aoff64_t *, aoff64_t,
+    aoff64_t *);
 extern errno_t tcp_conn_send_fin(tcp_conn_t *);
 extern errno_t tcp_conn_push(tcp_conn_t *);
+extern errno_t tcp_conn_set_nodelay(tcp_conn_t *, bool);
 extern errno_t tcp_conn_reset(tcp_conn_t *);
 
 extern errno_t tcp_conn_recv(tcp_conn_t *, void *, size_t, size_t *);
 extern errno_t tcp_conn_recv_wait(tcp_conn_t *, void *, size_t, size_t *);
+extern errno_t tcp_get_conn_list(tcp_t *, tcp_conn_info_t **, size_t *);
 
 #endif
 
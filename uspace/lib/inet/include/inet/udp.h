@@ -54,8 +54,20 @@ typedef struct {
 	sysarg_t assoc_id;
 	size_t size;
 	inet_ep_t remote_ep;
+	/** Message data if already fetched from the service or @c NULL */
+	void *data;
 } udp_rmsg_t;
 
+/** UDP message to send as part of a batch */
+typedef struct {
+	/** Destination endpoint or @c NULL to use association's remote ep. */
+	inet_ep_t *dest;
+	/** Message data */
+	void *data;
+	/** Message size in bytes */
+	size_t size;
+} udp_mmsg_t;
+
 /** UDP received error */
 typedef struct {
 } udp_rerr_t;
@@ -88,6 +100,8 @@ typedef struct udp {
 	fibril_condvar_t cv;
 	/** Set to @a true when callback connection handler has terminated */
 	bool cb_done;
+	/** Buffer for receiving batches of messages */
+	void *rbuf;
 } udp_t;
 
 extern errno_t udp_create(udp_t **);
@@ -97,6 +111,8 @@ extern errno_t udp_assoc_create(udp_t *, inet_ep2_t *, udp_cb_t *, void *,
 extern errno_t udp_assoc_set_nolocal(udp_assoc_t *);
 extern void udp_assoc_destroy(udp_assoc_t *);
 extern errno_t udp_assoc_send_msg(udp_assoc_t *, inet_ep_t *, void *, size_t);
+extern errno_t udp_assoc_send_mmsg(udp_assoc_t *, udp_mmsg_t *, size_t,
+    size_t *);
 extern void *udp_assoc_userptr(udp_assoc_t *);
 extern size_t udp_rmsg_size(udp_rmsg_t *);
 extern errno_t udp_rmsg_read(udp_rmsg_t *, size_t, void *, size_t);
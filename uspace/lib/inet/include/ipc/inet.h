@@ -65,7 +65,8 @@ typedef enum {
 	INETCFG_SROUTE_CREATE,
 	INETCFG_SROUTE_DELETE,
 	INETCFG_SROUTE_GET,
-	INETCFG_SROUTE_GET_ID
+	INETCFG_SROUTE_GET_ID,
+	INETCFG_REASS_STATS_GET
 } inetcfg_request_t;
 
 /** Events on Inet ping port */
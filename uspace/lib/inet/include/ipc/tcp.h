@@ -48,7 +48,11 @@ typedef enum {
 	TCP_CONN_PUSH,
 	TCP_CONN_RESET,
 	TCP_CONN_RECV,
-	TCP_CONN_RECV_WAIT
+	TCP_CONN_RECV_WAIT,
+	TCP_CONN_SET_NODELAY,
+	TCP_GET_CONN_LIST,
+	TCP_SHM_SETUP,
+	TCP_CONN_SEND_SHM
 } tcp_request_t;
 
 typedef enum {
@@ -35,7 +35,9 @@
 #ifndef LIBINET_IPC_UDP_H
 #define LIBINET_IPC_UDP_H
 
+#include <inet/endpoint.h>
 #include <ipc/common.h>
+#include <stddef.h>
 
 typedef enum {
 	UDP_CALLBACK_CREATE = IPC_FIRST_USER_METHOD,
@@ -45,13 +47,37 @@ typedef enum {
 	UDP_ASSOC_SEND_MSG,
 	UDP_RMSG_INFO,
 	UDP_RMSG_READ,
-	UDP_RMSG_DISCARD
+	UDP_RMSG_DISCARD,
+	UDP_ASSOC_SEND_MMSG,
+	UDP_RMSG_READ_MULTI
 } udp_request_t;
 
 typedef enum {
 	UDP_EV_DATA = IPC_FIRST_USER_METHOD
 } udp_event_t;
 
+/** Header of one message in a UDP_ASSOC_SEND_MMSG/UDP_RMSG_READ_MULTI buffer.
+ *
+ * Each header is followed by @c size bytes of message data, padded
+ * to UDP_MMSG_ALIGN.
+ */
+typedef struct {
+	/** Destination (send) or remote (receive) endpoint */
+	inet_ep_t ep;
+	/** Association ID (receive only) */
+	sysarg_t assoc_id;
+	/** Message size in bytes */
+	size_t size;
+} udp_mmsg_hdr_t;
+
+/** Alignment of message headers in a batch buffer */
+#define UDP_MMSG_ALIGN  8
+
+/** Space taken by message of size @a size in a batch buffer */
+#define UDP_MMSG_SPACE(size) \
+	(sizeof(udp_mmsg_hdr_t) + \
+	(((size) + UDP_MMSG_ALIGN - 1) & ~(UDP_MMSG_ALIGN - 1)))
+
 #endif
 
 /** @}
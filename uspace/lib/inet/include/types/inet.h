@@ -42,6 +42,16 @@
 
 #define INET_TTL_MAX 255
 
+/** Checksum state of a datagram payload */
+typedef enum {
+	/** Transport checksum is complete (send) or unverified (receive) */
+	INET_CSUM_NONE = 0,
+	/** Checksum field holds the pseudo-header sum, to be completed */
+	INET_CSUM_PARTIAL,
+	/** Transport checksum has been verified by the link */
+	INET_CSUM_VALID
+} inet_csum_t;
+
 typedef struct {
 	/** Local IP link service ID (optional) */
 	service_id_t iplink;
@@ -50,6 +60,12 @@ typedef struct {
 	uint8_t tos;
 	void *data;
 	size_t size;
+	/** Checksum state of @c data */
+	inet_csum_t csum;
+	/** Offset of the checksum field in @c data (if partial) */
+	uint16_t csum_offs;
+	/** TCP segment size to split @c data into, zero for none */
+	uint16_t tso_mss;
 } inet_dgram_t;
 
 typedef struct {
@@ -38,6 +38,7 @@
 #include <inet/eth_addr.h>
 #include <inet/inet.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /** Address object info */
 typedef struct {
@@ -69,6 +70,24 @@ typedef struct {
 	char *name;
 } inet_sroute_info_t;
 
+/** Datagram reassembly statistics */
+typedef struct {
+	/** Datagrams reassembled and delivered */
+	uint64_t reassembled;
+	/** Datagrams discarded because reassembly timed out */
+	uint64_t timeouts;
+	/** Datagrams discarded to stay within the memory limit */
+	uint64_t evictions;
+	/** Fragments dropped as invalid or for lack of memory */
+	uint64_t drops;
+	/** Fragments overlapping already received data */
+	uint64_t overlaps;
+	/** Datagrams currently being reassembled */
+	uint64_t pending;
+	/** Memory currently used for reassembly in bytes */
+	uint64_t mem_used;
+} inet_reass_stats_t;
+
 #endif
 
 /** @}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/** @file
+ */
+
+#ifndef LIBINET_TYPES_TCP_H
+#define LIBINET_TYPES_TCP_H
+
+#include <inet/endpoint.h>
+#include <stdint.h>
+
+/** TCP connection state */
+typedef enum {
+	tcp_is_listen,
+	tcp_is_syn_sent,
+	tcp_is_syn_received,
+	tcp_is_established,
+	tcp_is_fin_wait_1,
+	tcp_is_fin_wait_2,
+	tcp_is_close_wait,
+	tcp_is_closing,
+	tcp_is_last_ack,
+	tcp_is_time_wait,
+	tcp_is_closed
+} tcp_info_state_t;
+
+/** TCP connection information and statistics */
+typedef struct {
+	/** Local and remote endpoint */
+	inet_ep2_t ident;
+	/** Connection state (tcp_info_state_t) */
+	uint32_t state;
+
+	/** Segments received */
+	uint64_t segs_in;
+	/** Segments sent */
+	uint64_t segs_out;
+	/** Data bytes received */
+	uint64_t bytes_in;
+	/** Data bytes sent, including retransmissions */
+	uint64_t bytes_out;
+	/** Segments retransmitted */
+	uint64_t retransmits;
+	/** Retransmission timeouts */
+	uint64_t rto_timeouts;
+	/** Duplicate ACKs received */
+	uint64_t dupacks;
+
+	/** Smoothed round-trip time (microseconds) */
+	uint64_t srtt;
+	/** Round-trip time variation (microseconds) */
+	uint64_t rttvar;
+	/** Retransmission timeout (microseconds) */
+	uint64_t rto;
+	/** Congestion window (bytes) */
+	uint32_t cwnd;
+	/** Slow start threshold (bytes) */
+	uint32_t ssthresh;
+	/** Send window (bytes) */
+	uint32_t snd_wnd;
+	/** Receive window (bytes) */
+	uint32_t rcv_wnd;
+	/** Bytes sent but not acknowledged */
+	uint32_t in_flight;
+	/** Bytes in the send buffer */
+	uint32_t snd_queue;
+	/** Bytes in the receive buffer */
+	uint32_t rcv_queue;
+} tcp_conn_info_t;
+
+#endif
+
+/** @}
+ */
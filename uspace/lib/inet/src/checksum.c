@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libinet
+ * @{
+ */
+/**
+ * @file
+ * @brief Internet checksum (RFC 1071)
+ *
+ * The one's complement sum does not depend on byte order, so the data
+ * is summed in native 32-bit words and only the folded result is
+ * converted to network order.
+ */
+
+#include <byteorder.h>
+#include <inet/checksum.h>
+#include <mem.h>
+
+/** One's complement addition.
+ *
+ * @param a First operand
+ * @param b Second operand
+ * @return @a a + @a b + carry
+ */
+uint16_t inet_checksum_add(uint16_t a, uint16_t b)
+{
+	uint32_t s;
+
+	s = (uint32_t)a + (uint32_t)b;
+	return (s & 0xffff) + (s >> 16);
+}
+
+/** Fold 64-bit sum of native words into a 16-bit one's complement sum. */
+static uint16_t inet_checksum_fold(uint64_t sum)
+{
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t)sum;
+}
+
+/** Compute internet checksum.
+ *
+ * Continues a checksum computation started by a previous call
+ * (or with @c INET_CHECKSUM_INIT), so that the checksum can be computed
+ * over data that is not contiguous.
+ *
+ * @param ivalue Checksum of preceding data (or @c INET_CHECKSUM_INIT)
+ * @param data Data
+ * @param size Size of @a data in bytes. Only the last call may pass
+ *             an odd size.
+ * @return Checksum of the preceding data and @a data
+ */
+uint16_t inet_checksum_calc(uint16_t ivalue, const void *data, size_t size)
+{
+	const uint8_t *bdata = (const uint8_t *)data;
+	uint64_t sum = 0;
+	uint32_t w[4];
+	uint16_t h;
+	uint8_t tail[2];
+
+	while (size >= sizeof(w)) {
+		memcpy(w, bdata, sizeof(w));
+		sum += (uint64_t)w[0] + w[1] + w[2] + w[3];
+		bdata += sizeof(w);
+		size -= sizeof(w);
+	}
+
+	while (size >= sizeof(w[0])) {
+		memcpy(w, bdata, sizeof(w[0]));
+		sum += w[0];
+		bdata += sizeof(w[0]);
+		size -= sizeof(w[0]);
+	}
+
+	if (size >= sizeof(h)) {
+		memcpy(&h, bdata, sizeof(h));
+		sum += h;
+		bdata += sizeof(h);
+		size -= sizeof(h);
+	}
+
+	if (size != 0) {
+		/* Pad the odd byte with zero */
+		tail[0] = bdata[0];
+		tail[1] = 0;
+		memcpy(&h, tail, sizeof(h));
+		sum += h;
+	}
+
+	h = uint16_t_be2host(inet_checksum_fold(sum));
+	return ~inet_checksum_add(~ivalue, h);
+}
+
+/** @}
+ */
@@ -462,5 +462,27 @@ errno_t inetcfg_sroute_get_id(const char *name, sysarg_t *sroute_id)
 	return retval;
 }
 
+errno_t inetcfg_reass_stats_get(inet_reass_stats_t *stats)
+{
+	async_exch_t *exch = async_exchange_begin(inetcfg_sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, INETCFG_REASS_STATS_GET, &answer);
+	errno_t rc = async_data_read_start(exch, stats,
+	    sizeof(inet_reass_stats_t));
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	return retval;
+}
+
 /** @}
  */
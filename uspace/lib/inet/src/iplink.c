@@ -34,9 +34,13 @@
  * @brief IP link client stub
  */
 
+#include <adt/pkt_ring.h>
+#include <as.h>
 #include <async.h>
 #include <assert.h>
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
@@ -46,6 +50,7 @@
 #include <stdlib.h>
 
 static void iplink_cb_conn(ipc_call_t *icall, void *arg);
+static void iplink_ring_setup(iplink_t *iplink);
 
 errno_t iplink_open(async_sess_t *sess, iplink_ev_ops_t *ev_ops, void *arg,
     iplink_t **riplink)
@@ -57,6 +62,7 @@ errno_t iplink_open(async_sess_t *sess, iplink_ev_ops_t *ev_ops, void *arg,
 	iplink->sess = sess;
 	iplink->ev_ops = ev_ops;
 	iplink->arg = arg;
+	fibril_semaphore_initialize(&iplink->rx_ring_doorbell, 0);
 
 	async_exch_t *exch = async_exchange_begin(sess);
 
@@ -69,6 +75,8 @@ errno_t iplink_open(async_sess_t *sess, iplink_ev_ops_t *ev_ops, void *arg,
 	if (rc != EOK)
 		goto error;
 
+	iplink_ring_setup(iplink);
+
 	*riplink = iplink;
 	return EOK;
 
@@ -90,8 +98,9 @@ errno_t iplink_send(iplink_t *iplink, iplink_sdu_t *sdu)
 	async_exch_t *exch = async_exchange_begin(iplink->sess);
 
 	ipc_call_t answer;
-	aid_t req = async_send_2(exch, IPLINK_SEND, (sysarg_t) sdu->src,
-	    (sysarg_t) sdu->dest, &answer);
+	aid_t req = async_send_5(exch, IPLINK_SEND, (sysarg_t) sdu->src,
+	    (sysarg_t) sdu->dest, sdu->offload, sdu->csum_start |
+	    ((sysarg_t) sdu->csum_offs << 16), sdu->mss, &answer);
 
 	errno_t rc = async_data_write_start(exch, sdu->data, sdu->size);
 
@@ -153,6 +162,28 @@ errno_t iplink_get_mtu(iplink_t *iplink, size_t *rmtu)
 	return EOK;
 }
 
+/** Get offloads supported by the link.
+ *
+ * @param iplink IP link
+ * @param roffload Place to store supported offloads (IPLINK_OFFLOAD_*)
+ * @return EOK on success or an error code
+ */
+errno_t iplink_get_offload(iplink_t *iplink, uint32_t *roffload)
+{
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	sysarg_t offload;
+	errno_t rc = async_req_0_1(exch, IPLINK_GET_OFFLOAD, &offload);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK)
+		return rc;
+
+	*roffload = offload;
+	return EOK;
+}
+
 errno_t iplink_get_mac48(iplink_t *iplink, eth_addr_t *mac)
 {
 	async_exch_t *exch = async_exchange_begin(iplink->sess);
@@ -244,11 +275,100 @@ void *iplink_get_userptr(iplink_t *iplink)
 	return iplink->arg;
 }
 
+/** Fibril passing packets from the ring to the receive handler.
+ *
+ * Drains all packets published by the link, then waits for the doorbell.
+ *
+ * @param arg IP link
+ * @return Never returns
+ */
+static errno_t iplink_rx_ring_fibril(void *arg)
+{
+	iplink_t *iplink = (iplink_t *) arg;
+	iplink_recv_sdu_t sdu;
+	pkt_ring_desc_t desc;
+
+	while (true) {
+		while ((sdu.data = pkt_ring_cons_peek(&iplink->rx_ring,
+		    &desc)) != NULL) {
+			sdu.size = desc.size;
+			sdu.offload = desc.arg1;
+			(void) iplink->ev_ops->recv(iplink, &sdu,
+			    (ip_ver_t) desc.flags);
+			pkt_ring_cons_next(&iplink->rx_ring);
+		}
+
+		pkt_ring_cons_publish(&iplink->rx_ring);
+
+		if (pkt_ring_cons_wait(&iplink->rx_ring))
+			fibril_semaphore_down(&iplink->rx_ring_doorbell);
+	}
+
+	return EOK;
+}
+
+/** Share a ring of received packets with the link.
+ *
+ * Links that do not support the ring keep sending each packet
+ * in a separate IPLINK_EV_RECV call.
+ *
+ * @param iplink IP link
+ */
+static void iplink_ring_setup(iplink_t *iplink)
+{
+	size_t size;
+	void *area;
+	fid_t fid;
+	errno_t rc;
+
+	fid = fibril_create(iplink_rx_ring_fibril, iplink);
+	if (fid == 0)
+		return;
+
+	size = pkt_ring_area_size(IPLINK_RING_SLOTS, IPLINK_RING_SLOT_SIZE);
+	area = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED) {
+		fibril_destroy(fid);
+		return;
+	}
+
+	rc = pkt_ring_create(&iplink->rx_ring, area, IPLINK_RING_SLOTS,
+	    IPLINK_RING_SLOT_SIZE);
+	if (rc != EOK)
+		goto error;
+
+	async_exch_t *exch = async_exchange_begin(iplink->sess);
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, IPLINK_RING_SETUP, &answer);
+	rc = async_share_out_start(exch, area, AS_AREA_READ | AS_AREA_WRITE);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		goto error;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK)
+		goto error;
+
+	iplink->rx_ring_area = area;
+	fibril_add_ready(fid);
+	return;
+error:
+	as_area_destroy(area);
+	fibril_destroy(fid);
+}
+
 static void iplink_ev_recv(iplink_t *iplink, ipc_call_t *icall)
 {
 	iplink_recv_sdu_t sdu;
 
 	ip_ver_t ver = ipc_get_arg1(icall);
+	sdu.offload = ipc_get_arg2(icall);
 
 	errno_t rc = async_data_write_accept(&sdu.data, false, 0, 0, 0,
 	    &sdu.size);
@@ -279,6 +399,12 @@ static void iplink_ev_change_addr(iplink_t *iplink, ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+static void iplink_ev_ring(iplink_t *iplink, ipc_call_t *icall)
+{
+	fibril_semaphore_up(&iplink->rx_ring_doorbell);
+	async_answer_0(icall, EOK);
+}
+
 static void iplink_cb_conn(ipc_call_t *icall, void *arg)
 {
 	iplink_t *iplink = (iplink_t *) arg;
@@ -299,6 +425,9 @@ static void iplink_cb_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_EV_CHANGE_ADDR:
 			iplink_ev_change_addr(iplink, &call);
 			break;
+		case IPLINK_EV_RING:
+			iplink_ev_ring(iplink, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
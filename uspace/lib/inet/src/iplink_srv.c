@@ -34,9 +34,12 @@
  * @brief IP link server stub
  */
 
+#include <adt/pkt_ring.h>
+#include <as.h>
 #include <errno.h>
 #include <inet/eth_addr.h>
 #include <ipc/iplink.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <inet/addr.h>
@@ -49,6 +52,16 @@ static void iplink_get_mtu_srv(iplink_srv_t *srv, ipc_call_t *call)
 	async_answer_1(call, rc, mtu);
 }
 
+static void iplink_get_offload_srv(iplink_srv_t *srv, ipc_call_t *call)
+{
+	uint32_t offload = 0;
+	errno_t rc = EOK;
+
+	if (srv->ops->get_offload != NULL)
+		rc = srv->ops->get_offload(srv, &offload);
+	async_answer_1(call, rc, offload);
+}
+
 static void iplink_get_mac48_srv(iplink_srv_t *srv, ipc_call_t *icall)
 {
 	eth_addr_t mac;
@@ -164,6 +177,10 @@ static void iplink_send_srv(iplink_srv_t *srv, ipc_call_t *icall)
 
 	sdu.src = ipc_get_arg1(icall);
 	sdu.dest = ipc_get_arg2(icall);
+	sdu.offload = ipc_get_arg3(icall);
+	sdu.csum_start = ipc_get_arg4(icall) & 0xffff;
+	sdu.csum_offs = (ipc_get_arg4(icall) >> 16) & 0xffff;
+	sdu.mss = ipc_get_arg5(icall);
 
 	errno_t rc = async_data_write_accept(&sdu.data, false, 0, 0, 0,
 	    &sdu.size);
@@ -213,6 +230,56 @@ static void iplink_send6_srv(iplink_srv_t *srv, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void iplink_ring_setup_srv(iplink_srv_t *srv, ipc_call_t *call)
+{
+	ipc_call_t data;
+	unsigned int flags;
+	pkt_ring_t ring;
+	void *area;
+	size_t size;
+	errno_t rc;
+
+	if (!async_share_out_receive(&data, &size, &flags)) {
+		async_answer_0(&data, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if ((flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE)) {
+		async_answer_0(&data, EPERM);
+		async_answer_0(call, EPERM);
+		return;
+	}
+
+	rc = async_share_out_finalize(&data, &area);
+	if (rc != EOK || area == AS_MAP_FAILED) {
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	rc = pkt_ring_attach(&ring, area, size);
+	if (rc != EOK) {
+		as_area_destroy(area);
+		async_answer_0(call, rc);
+		return;
+	}
+
+	fibril_mutex_lock(&srv->lock);
+	if (srv->rx_ring_area != NULL) {
+		fibril_mutex_unlock(&srv->lock);
+		as_area_destroy(area);
+		async_answer_0(call, EEXIST);
+		return;
+	}
+
+	srv->rx_ring = ring;
+	srv->rx_ring_area = area;
+	fibril_mutex_unlock(&srv->lock);
+
+	async_answer_0(call, EOK);
+}
+
 void iplink_srv_init(iplink_srv_t *srv)
 {
 	fibril_mutex_initialize(&srv->lock);
@@ -220,6 +287,7 @@ void iplink_srv_init(iplink_srv_t *srv)
 	srv->ops = NULL;
 	srv->arg = NULL;
 	srv->client_sess = NULL;
+	srv->rx_ring_area = NULL;
 }
 
 errno_t iplink_conn(ipc_call_t *icall, void *arg)
@@ -268,6 +336,9 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_GET_MTU:
 			iplink_get_mtu_srv(srv, &call);
 			break;
+		case IPLINK_GET_OFFLOAD:
+			iplink_get_offload_srv(srv, &call);
+			break;
 		case IPLINK_GET_MAC48:
 			iplink_get_mac48_srv(srv, &call);
 			break;
@@ -286,6 +357,9 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 		case IPLINK_ADDR_REMOVE:
 			iplink_addr_remove_srv(srv, &call);
 			break;
+		case IPLINK_RING_SETUP:
+			iplink_ring_setup_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
@@ -295,16 +369,72 @@ errno_t iplink_conn(ipc_call_t *icall, void *arg)
 }
 
 /* XXX Version should be part of @a sdu */
+/** Pass received packet to the client through its ring.
+ *
+ * @param srv IP link server
+ * @param sdu Received packet
+ * @param ver IP version
+ * @return EOK if the packet was queued, ENOMEM if the ring is full or
+ *         the packet larger than a slot, ENOENT if there is no ring
+ */
+static errno_t iplink_ev_recv_ring(iplink_srv_t *srv, iplink_recv_sdu_t *sdu,
+    ip_ver_t ver)
+{
+	pkt_ring_desc_t desc;
+	bool doorbell;
+	void *slot;
+
+	fibril_mutex_lock(&srv->lock);
+
+	if (srv->rx_ring_area == NULL) {
+		fibril_mutex_unlock(&srv->lock);
+		return ENOENT;
+	}
+
+	if (sdu->size > srv->rx_ring.slot_size) {
+		fibril_mutex_unlock(&srv->lock);
+		return ENOMEM;
+	}
+
+	slot = pkt_ring_prod_slot(&srv->rx_ring);
+	if (slot == NULL) {
+		fibril_mutex_unlock(&srv->lock);
+		return ENOMEM;
+	}
+
+	memcpy(slot, sdu->data, sdu->size);
+	desc.size = sdu->size;
+	desc.flags = ver;
+	desc.arg1 = sdu->offload;
+	desc.arg2 = 0;
+	pkt_ring_prod_put(&srv->rx_ring, &desc);
+	doorbell = pkt_ring_prod_publish(&srv->rx_ring);
+
+	fibril_mutex_unlock(&srv->lock);
+
+	if (doorbell) {
+		async_exch_t *exch = async_exchange_begin(srv->client_sess);
+		async_msg_0(exch, IPLINK_EV_RING);
+		async_exchange_end(exch);
+	}
+
+	return EOK;
+}
+
 errno_t iplink_ev_recv(iplink_srv_t *srv, iplink_recv_sdu_t *sdu, ip_ver_t ver)
 {
 	if (srv->client_sess == NULL)
 		return EIO;
 
+	/* Packets that do not fit in the ring are sent by IPC */
+	if (iplink_ev_recv_ring(srv, sdu, ver) == EOK)
+		return EOK;
+
 	async_exch_t *exch = async_exchange_begin(srv->client_sess);
 
 	ipc_call_t answer;
-	aid_t req = async_send_1(exch, IPLINK_EV_RECV, (sysarg_t)ver,
-	    &answer);
+	aid_t req = async_send_2(exch, IPLINK_EV_RECV, (sysarg_t)ver,
+	    sdu->offload, &answer);
 
 	errno_t rc = async_data_write_start(exch, sdu->data, sdu->size);
 	async_exchange_end(exch);
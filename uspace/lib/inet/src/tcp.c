@@ -32,13 +32,20 @@
 /** @file TCP API
  */
 
+#include <as.h>
+#include <assert.h>
 #include <errno.h>
 #include <fibril.h>
 #include <inet/endpoint.h>
 #include <inet/tcp.h>
 #include <ipc/services.h>
 #include <ipc/tcp.h>
+#include <macros.h>
 #include <stdlib.h>
+#include <vfs/vfs.h>
+
+/** Size of the buffer shared with the TCP service for sending files */
+#define TCP_SHM_SIZE DATA_XFER_LIMIT
 
 static void tcp_cb_conn(ipc_call_t *, void *);
 static errno_t tcp_conn_fibril(void *);
@@ -103,6 +110,7 @@ errno_t tcp_create(tcp_t **rtcp)
 	list_initialize(&tcp->listener);
 	fibril_mutex_initialize(&tcp->lock);
 	fibril_condvar_initialize(&tcp->cv);
+	fibril_mutex_initialize(&tcp->shm_lock);
 
 	rc = loc_service_get_id(SERVICE_NAME_TCP, &tcp_svcid,
 	    IPC_FLAG_BLOCKING);
@@ -147,6 +155,9 @@ void tcp_destroy(tcp_t *tcp)
 		fibril_condvar_wait(&tcp->cv, &tcp->lock);
 	fibril_mutex_unlock(&tcp->lock);
 
+	if (tcp->shm != NULL)
+		as_area_destroy(tcp->shm);
+
 	free(tcp);
 }
 
@@ -471,6 +482,146 @@ errno_t tcp_conn_send(tcp_conn_t *conn, const void *data, size_t bytes)
 	return rc;
 }
 
+/** Share a buffer for sending files with the TCP service.
+ *
+ * @param tcp TCP client, @c tcp->shm_lock must be held
+ * @return EOK on success or an error code
+ */
+static errno_t tcp_shm_setup(tcp_t *tcp)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	void *area;
+	errno_t rc;
+
+	assert(fibril_mutex_is_locked(&tcp->shm_lock));
+
+	area = as_area_create(AS_AREA_ANY, TCP_SHM_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED)
+		return ENOMEM;
+
+	exch = async_exchange_begin(tcp->sess);
+	aid_t req = async_send_0(exch, TCP_SHM_SETUP, &answer);
+	rc = async_share_out_start(exch, area, AS_AREA_READ);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		as_area_destroy(area);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK) {
+		as_area_destroy(area);
+		return rc;
+	}
+
+	tcp->shm = area;
+	tcp->shm_size = TCP_SHM_SIZE;
+	return EOK;
+}
+
+/** Send file data via connection by copying it through a private buffer.
+ *
+ * Used if the TCP service does not support the shared buffer.
+ *
+ * @param conn  Connection
+ * @param fd    File descriptor
+ * @param pos   Position in file, updated on return
+ * @param size  Maximum number of bytes to send
+ * @param nsent Place to store number of bytes sent
+ * @return EOK on success or an error code
+ */
+static errno_t tcp_conn_send_file_copy(tcp_conn_t *conn, int fd,
+    aoff64_t *pos, aoff64_t size, aoff64_t *nsent)
+{
+	void *buf;
+	size_t nr;
+	errno_t rc;
+
+	buf = malloc(TCP_SHM_SIZE);
+	if (buf == NULL)
+		return ENOMEM;
+
+	rc = EOK;
+	while (*nsent < size) {
+		rc = vfs_read(fd, pos, buf, min(size - *nsent, TCP_SHM_SIZE),
+		    &nr);
+		if (rc != EOK || nr == 0)
+			break;
+
+		rc = tcp_conn_send(conn, buf, nr);
+		if (rc != EOK)
+			break;
+
+		*nsent += nr;
+	}
+
+	free(buf);
+	return rc;
+}
+
+/** Send file data via connection.
+ *
+ * File data is read directly into a buffer shared with the TCP service
+ * which copies it straight to the connection send buffer, saving the
+ * copy into an IPC message. Sending stops at the end of the file.
+ *
+ * @param conn  Connection
+ * @param fd    File descriptor
+ * @param pos   Position in file, updated on return
+ * @param size  Maximum number of bytes to send
+ * @param nsent Place to store number of bytes sent (even on error) or @c NULL
+ * @return EOK on success or an error code
+ */
+errno_t tcp_conn_send_file(tcp_conn_t *conn, int fd, aoff64_t *pos,
+    aoff64_t size, aoff64_t *nsent)
+{
+	tcp_t *tcp = conn->tcp;
+	async_exch_t *exch;
+	aoff64_t sent = 0;
+	size_t nr;
+	errno_t rc;
+
+	fibril_mutex_lock(&tcp->shm_lock);
+
+	if (tcp->shm == NULL && !tcp->shm_failed) {
+		if (tcp_shm_setup(tcp) != EOK)
+			tcp->shm_failed = true;
+	}
+
+	if (tcp->shm == NULL) {
+		fibril_mutex_unlock(&tcp->shm_lock);
+		rc = tcp_conn_send_file_copy(conn, fd, pos, size, &sent);
+		goto out;
+	}
+
+	rc = EOK;
+	while (sent < size) {
+		rc = vfs_read(fd, pos, tcp->shm, min(size - sent,
+		    tcp->shm_size), &nr);
+		if (rc != EOK || nr == 0)
+			break;
+
+		exch = async_exchange_begin(tcp->sess);
+		rc = async_req_2_0(exch, TCP_CONN_SEND_SHM, conn->id, nr);
+		async_exchange_end(exch);
+
+		if (rc != EOK)
+			break;
+
+		sent += nr;
+	}
+
+	fibril_mutex_unlock(&tcp->shm_lock);
+out:
+	if (nsent != NULL)
+		*nsent = sent;
+	return rc;
+}
+
 /** Send FIN.
  *
  * Send FIN, indicating no more data will be send over the connection.
@@ -505,6 +656,29 @@ errno_t tcp_conn_push(tcp_conn_t *conn)
 	return rc;
 }
 
+/** Set connection no-delay option.
+ *
+ * By default small amounts of data are held back while previously sent
+ * data is unacknowledged so that they can be sent in fewer segments
+ * (Nagle algorithm). With no-delay set, data is sent immediately, which
+ * suits interactive traffic.
+ *
+ * @param conn Connection
+ * @param nodelay @c true to send data without delay
+ * @return EOK on success or an error code
+ */
+errno_t tcp_conn_set_nodelay(tcp_conn_t *conn, bool nodelay)
+{
+	async_exch_t *exch;
+
+	exch = async_exchange_begin(conn->tcp->sess);
+	errno_t rc = async_req_2_0(exch, TCP_CONN_SET_NODELAY, conn->id,
+	    nodelay ? 1 : 0);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 /** Reset connection.
  *
  * @param conn Connection
@@ -572,6 +746,86 @@ errno_t tcp_conn_recv(tcp_conn_t *conn, void *buf, size_t bsize, size_t *nrecv)
 	return EOK;
 }
 
+/** Read connection information into buffer.
+ *
+ * @param tcp      TCP client
+ * @param buf      Buffer
+ * @param bsize    Buffer size
+ * @param act_size Place to store size needed to hold all information
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t tcp_get_conn_list_once(tcp_t *tcp, tcp_conn_info_t *buf,
+    size_t bsize, size_t *act_size)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+
+	exch = async_exchange_begin(tcp->sess);
+	aid_t req = async_send_0(exch, TCP_GET_CONN_LIST, &answer);
+	errno_t rc = async_data_read_start(exch, buf, bsize);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	*act_size = ipc_get_arg1(&answer);
+	return EOK;
+}
+
+/** Get information and statistics for all connections.
+ *
+ * @param tcp    TCP client
+ * @param rinfo  Place to store pointer to array of connection information
+ * @param rcount Place to store number of connections
+ *
+ * @return EOK on success or an error code
+ */
+errno_t tcp_get_conn_list(tcp_t *tcp, tcp_conn_info_t **rinfo, size_t *rcount)
+{
+	tcp_conn_info_t *info;
+	tcp_conn_info_t *tmp;
+	size_t alloc_size;
+	size_t act_size;
+	errno_t rc;
+
+	rc = tcp_get_conn_list_once(tcp, NULL, 0, &act_size);
+	if (rc != EOK)
+		return rc;
+
+	info = NULL;
+	while (true) {
+		alloc_size = act_size;
+		tmp = realloc(info, alloc_size);
+		if (tmp == NULL && alloc_size != 0) {
+			free(info);
+			return ENOMEM;
+		}
+
+		info = tmp;
+		rc = tcp_get_conn_list_once(tcp, info, alloc_size, &act_size);
+		if (rc != EOK) {
+			free(info);
+			return rc;
+		}
+
+		/* Connections may have been created in the meantime */
+		if (act_size <= alloc_size)
+			break;
+	}
+
+	*rinfo = info;
+	*rcount = act_size / sizeof(tcp_conn_info_t);
+	return EOK;
+}
+
 /** Read received data from connection with blocking.
  *
  * Wait for @a bsize bytes of data to be received and copy them to
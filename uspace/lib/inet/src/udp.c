@@ -38,8 +38,14 @@
 #include <ipc/services.h>
 #include <ipc/udp.h>
 #include <loc.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+/** Size of buffer for receiving batches of messages */
+#define UDP_RMSG_BATCH_SIZE  16384
+
 static void udp_cb_conn(ipc_call_t *, void *);
 
 /** Create callback connection from UDP service.
@@ -90,6 +96,12 @@ errno_t udp_create(udp_t **rudp)
 	fibril_mutex_initialize(&udp->lock);
 	fibril_condvar_initialize(&udp->cv);
 
+	udp->rbuf = malloc(UDP_RMSG_BATCH_SIZE);
+	if (udp->rbuf == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
 	rc = loc_service_get_id(SERVICE_NAME_UDP, &udp_svcid,
 	    IPC_FLAG_BLOCKING);
 	if (rc != EOK) {
@@ -113,6 +125,8 @@ errno_t udp_create(udp_t **rudp)
 	*rudp = udp;
 	return EOK;
 error:
+	if (udp != NULL)
+		free(udp->rbuf);
 	free(udp);
 	return rc;
 }
@@ -133,6 +147,7 @@ void udp_destroy(udp_t *udp)
 		fibril_condvar_wait(&udp->cv, &udp->lock);
 	fibril_mutex_unlock(&udp->lock);
 
+	free(udp->rbuf);
 	free(udp);
 }
 
@@ -291,6 +306,120 @@ errno_t udp_assoc_send_msg(udp_assoc_t *assoc, inet_ep_t *dest, void *data,
 	return rc;
 }
 
+/** Send one batch of messages via UDP association.
+ *
+ * @param assoc Association
+ * @param msgs  Messages
+ * @param count Number of messages
+ * @param bsize Size of the batch buffer needed to hold the messages
+ * @param rsent Place to store number of messages sent
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t udp_assoc_send_batch(udp_assoc_t *assoc, udp_mmsg_t *msgs,
+    size_t count, size_t bsize, size_t *rsent)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	uint8_t *buf;
+	size_t off;
+
+	*rsent = 0;
+
+	buf = calloc(1, bsize);
+	if (buf == NULL)
+		return ENOMEM;
+
+	off = 0;
+	for (size_t i = 0; i < count; i++) {
+		udp_mmsg_hdr_t *hdr = (udp_mmsg_hdr_t *) (buf + off);
+
+		/* If dest is null, use default destination */
+		if (msgs[i].dest != NULL)
+			hdr->ep = *msgs[i].dest;
+		else
+			inet_ep_init(&hdr->ep);
+
+		hdr->size = msgs[i].size;
+		memcpy(buf + off + sizeof(udp_mmsg_hdr_t), msgs[i].data,
+		    msgs[i].size);
+		off += UDP_MMSG_SPACE(msgs[i].size);
+	}
+
+	exch = async_exchange_begin(assoc->udp->sess);
+	aid_t req = async_send_2(exch, UDP_ASSOC_SEND_MMSG, assoc->id, count,
+	    &answer);
+	errno_t rc = async_data_write_start(exch, buf, bsize);
+	async_exchange_end(exch);
+	free(buf);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	*rsent = ipc_get_arg1(&answer);
+	return rc;
+}
+
+/** Send multiple messages via UDP association.
+ *
+ * Messages are packed together and handed to the UDP service in as few
+ * IPC exchanges as possible. Sending stops at the first message that
+ * cannot be sent.
+ *
+ * @param assoc Association
+ * @param msgs  Array of messages
+ * @param count Number of messages in @a msgs
+ * @param rsent Place to store number of messages sent or @c NULL
+ *
+ * @return EOK if all messages were sent or an error code
+ */
+errno_t udp_assoc_send_mmsg(udp_assoc_t *assoc, udp_mmsg_t *msgs,
+    size_t count, size_t *rsent)
+{
+	size_t sent;
+	size_t nsent;
+	size_t bsize;
+	size_t n;
+	errno_t rc;
+
+	sent = 0;
+	rc = EOK;
+
+	while (sent < count) {
+		/* Determine how many messages fit in one transfer */
+		bsize = 0;
+		n = 0;
+		while (sent + n < count && msgs[sent + n].size <= DATA_XFER_LIMIT &&
+		    bsize + UDP_MMSG_SPACE(msgs[sent + n].size) <=
+		    DATA_XFER_LIMIT) {
+			bsize += UDP_MMSG_SPACE(msgs[sent + n].size);
+			++n;
+		}
+
+		if (n == 0) {
+			/* Message too large to be batched */
+			rc = udp_assoc_send_msg(assoc, msgs[sent].dest,
+			    msgs[sent].data, msgs[sent].size);
+			if (rc != EOK)
+				break;
+			++sent;
+			continue;
+		}
+
+		rc = udp_assoc_send_batch(assoc, msgs + sent, n, bsize, &nsent);
+		sent += nsent;
+		if (rc != EOK)
+			break;
+	}
+
+	if (rsent != NULL)
+		*rsent = sent;
+	return rc;
+}
+
 /** Get the user/callback argument for an association.
  *
  * @param assoc UDP association
@@ -329,6 +458,16 @@ errno_t udp_rmsg_read(udp_rmsg_t *rmsg, size_t off, void *buf, size_t bsize)
 	async_exch_t *exch;
 	ipc_call_t answer;
 
+	if (rmsg->data != NULL) {
+		/* Message was received as part of a batch */
+		if (off > rmsg->size)
+			return EINVAL;
+
+		memcpy(buf, (uint8_t *) rmsg->data + off,
+		    min(rmsg->size - off, bsize));
+		return EOK;
+	}
+
 	exch = async_exchange_begin(rmsg->udp->sess);
 	aid_t req = async_send_1(exch, UDP_RMSG_READ, off, &answer);
 	errno_t rc = async_data_read_start(exch, buf, bsize);
@@ -413,6 +552,7 @@ static errno_t udp_rmsg_info(udp_t *udp, udp_rmsg_t *rmsg)
 	rmsg->assoc_id = ipc_get_arg1(&answer);
 	rmsg->size = ipc_get_arg2(&answer);
 	rmsg->remote_ep = ep;
+	rmsg->data = NULL;
 	return EOK;
 }
 
@@ -432,6 +572,41 @@ static errno_t udp_rmsg_discard(udp_t *udp)
 	return rc;
 }
 
+/** Read and consume a batch of received messages from UDP service.
+ *
+ * The messages are stored in @a udp->rbuf, each preceded by a header.
+ *
+ * @param udp    UDP client
+ * @param rcount Place to store number of messages read. Zero means
+ *               the next message does not fit into the batch buffer.
+ *
+ * @return EOK on success, ENOENT if there are no messages or an error code
+ */
+static errno_t udp_rmsg_read_multi(udp_t *udp, size_t *rcount)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+
+	exch = async_exchange_begin(udp->sess);
+	aid_t req = async_send_0(exch, UDP_RMSG_READ_MULTI, &answer);
+	errno_t rc = async_data_read_start(exch, udp->rbuf,
+	    UDP_RMSG_BATCH_SIZE);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	*rcount = ipc_get_arg1(&answer);
+	return EOK;
+}
+
 /** Get association based on its ID.
  *
  * @param udp    UDP client
@@ -452,39 +627,91 @@ static errno_t udp_assoc_get(udp_t *udp, sysarg_t id, udp_assoc_t **rassoc)
 	return EINVAL;
 }
 
-/** Handle 'data' event, i.e. some message(s) arrived.
+/** Deliver one received message that is too large to be batched.
  *
- * For each received message, get information about it, call @c recv_msg
- * callback and discard it.
+ * Get information about the message, call @c recv_msg callback
+ * and discard it.
  *
- * @param udp   UDP client
- * @param icall IPC message
+ * @param udp UDP client
+ * @return EOK on success or an error code
+ */
+static errno_t udp_ev_data_single(udp_t *udp)
+{
+	udp_rmsg_t rmsg;
+	udp_assoc_t *assoc;
+	errno_t rc;
+
+	rc = udp_rmsg_info(udp, &rmsg);
+	if (rc != EOK)
+		return rc;
+
+	rc = udp_assoc_get(udp, rmsg.assoc_id, &assoc);
+	if (rc == EOK && assoc->cb != NULL && assoc->cb->recv_msg != NULL)
+		assoc->cb->recv_msg(assoc, &rmsg);
+
+	return udp_rmsg_discard(udp);
+}
+
+/** Deliver a batch of received messages stored in @a udp->rbuf.
  *
+ * @param udp   UDP client
+ * @param count Number of messages in the batch
  */
-static void udp_ev_data(udp_t *udp, ipc_call_t *icall)
+static void udp_ev_data_batch(udp_t *udp, size_t count)
 {
 	udp_rmsg_t rmsg;
 	udp_assoc_t *assoc;
+	uint8_t *bp;
 	errno_t rc;
 
-	while (true) {
-		rc = udp_rmsg_info(udp, &rmsg);
-		if (rc != EOK) {
-			break;
-		}
+	bp = udp->rbuf;
+	for (size_t i = 0; i < count; i++) {
+		udp_mmsg_hdr_t *hdr = (udp_mmsg_hdr_t *) bp;
+
+		rmsg.udp = udp;
+		rmsg.assoc_id = hdr->assoc_id;
+		rmsg.size = hdr->size;
+		rmsg.remote_ep = hdr->ep;
+		rmsg.data = bp + sizeof(udp_mmsg_hdr_t);
+		bp += UDP_MMSG_SPACE(hdr->size);
 
 		rc = udp_assoc_get(udp, rmsg.assoc_id, &assoc);
-		if (rc != EOK) {
+		if (rc != EOK)
 			continue;
-		}
 
 		if (assoc->cb != NULL && assoc->cb->recv_msg != NULL)
 			assoc->cb->recv_msg(assoc, &rmsg);
+	}
+}
 
-		rc = udp_rmsg_discard(udp);
-		if (rc != EOK) {
+/** Handle 'data' event, i.e. some message(s) arrived.
+ *
+ * Drain the receive queue in batches, calling @c recv_msg callback for
+ * each message. Messages too large for the batch buffer are fetched
+ * individually.
+ *
+ * @param udp   UDP client
+ * @param icall IPC message
+ *
+ */
+static void udp_ev_data(udp_t *udp, ipc_call_t *icall)
+{
+	size_t count;
+	errno_t rc;
+
+	while (true) {
+		rc = udp_rmsg_read_multi(udp, &count);
+		if (rc != EOK)
 			break;
+
+		if (count == 0) {
+			rc = udp_ev_data_single(udp);
+			if (rc != EOK)
+				break;
+			continue;
 		}
+
+		udp_ev_data_batch(udp, count);
 	}
 
 	async_answer_0(icall, EOK);
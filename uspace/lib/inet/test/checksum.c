@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inet/checksum.h>
+#include <pcut/pcut.h>
+#include <stddef.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+/** Reference implementation summing 16-bit big-endian words */
+static uint16_t checksum_ref(uint16_t ivalue, const uint8_t *data,
+    size_t size)
+{
+	uint16_t sum = ~ivalue;
+	size_t i;
+
+	for (i = 0; i + 1 < size; i += 2)
+		sum = inet_checksum_add(sum, (data[i] << 8) | data[i + 1]);
+
+	if (size % 2 != 0)
+		sum = inet_checksum_add(sum, data[size - 1] << 8);
+
+	return ~sum;
+}
+
+/** Test checksum of the example in RFC 1071 section 3 */
+PCUT_TEST(rfc1071)
+{
+	uint8_t data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+
+	PCUT_ASSERT_INT_EQUALS((uint16_t)~0xddf2,
+	    inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data)));
+}
+
+/** Test inet_checksum_calc() matches reference for all sizes and alignments */
+PCUT_TEST(sizes)
+{
+	uint8_t data[80];
+	size_t offs;
+	size_t size;
+	size_t i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)(i * 37 + 0xa5);
+
+	for (offs = 0; offs < 4; offs++) {
+		for (size = 0; size + offs <= sizeof(data); size++) {
+			PCUT_ASSERT_INT_EQUALS(checksum_ref(INET_CHECKSUM_INIT,
+			    data + offs, size), inet_checksum_calc(
+			    INET_CHECKSUM_INIT, data + offs, size));
+		}
+	}
+}
+
+/** Test checksum can be continued over non-contiguous data */
+PCUT_TEST(continued)
+{
+	uint8_t data[] = { 0xff, 0xff, 0x12, 0x34, 0x80, 0x00, 0xab, 0xcd,
+	    0x01 };
+	uint16_t cs;
+
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, data, 4);
+	cs = inet_checksum_calc(cs, data + 4, sizeof(data) - 4);
+
+	PCUT_ASSERT_INT_EQUALS(inet_checksum_calc(INET_CHECKSUM_INIT, data,
+	    sizeof(data)), cs);
+}
+
+/** Test data carrying its own checksum sums to zero */
+PCUT_TEST(verify)
+{
+	uint8_t data[] = { 0x45, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x00,
+	    0x40, 0x11, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x01, 0x0a, 0x00, 0x00,
+	    0x02 };
+	uint16_t cs;
+
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data));
+	data[10] = cs >> 8;
+	data[11] = cs & 0xff;
+
+	PCUT_ASSERT_INT_EQUALS(0, inet_checksum_calc(INET_CHECKSUM_INIT, data,
+	    sizeof(data)));
+}
+
+PCUT_EXPORT(checksum);
@@ -30,6 +30,7 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(checksum);
 PCUT_IMPORT(eth_addr);
 
 PCUT_MAIN();
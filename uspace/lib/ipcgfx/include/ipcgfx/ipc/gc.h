@@ -36,6 +36,8 @@
 #define _IPCGFX_IPC_GC_H_
 
 #include <ipc/common.h>
+#include <stdint.h>
+#include <types/gfx/coord.h>
 
 typedef enum {
 	GC_SET_CLIP_RECT = IPC_FIRST_USER_METHOD,
@@ -48,8 +50,36 @@ typedef enum {
 	GC_BITMAP_DESTROY,
 	GC_BITMAP_RENDER,
 	GC_BITMAP_GET_ALLOC,
+	GC_CMDBUF_CREATE,
+	GC_CMDBUF_FLUSH
 } gc_request_t;
 
+/** Size of command buffer shared between client and server */
+#define GC_CMDBUF_SIZE 16384
+
+/** Command buffer operation */
+typedef enum {
+	GC_CMD_SET_CLIP_RECT,
+	GC_CMD_SET_CLIP_RECT_NULL,
+	GC_CMD_SET_RGB_COLOR,
+	GC_CMD_FILL_RECT,
+	GC_CMD_BITMAP_RENDER
+} gc_cmd_op_t;
+
+/** Encoded command in command buffer */
+typedef struct {
+	/** Operation (gc_cmd_op_t) */
+	uint32_t op;
+	/** Color components (GC_CMD_SET_RGB_COLOR) */
+	uint16_t r, g, b;
+	/** Bitmap ID (GC_CMD_BITMAP_RENDER) */
+	sysarg_t bmp_id;
+	/** Clipping, fill or source rectangle */
+	gfx_rect_t rect;
+	/** Bitmap offset (GC_CMD_BITMAP_RENDER) */
+	gfx_coord2_t offs;
+} gc_cmd_t;
+
 #endif
 
 /** @}
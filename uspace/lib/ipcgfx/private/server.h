@@ -42,7 +42,9 @@
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
 #include <gfx/coord.h>
+#include <ipcgfx/ipc/gc.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /** Server-side of IPC GC connection.
  */
@@ -53,6 +55,10 @@ typedef struct {
 	list_t bitmaps;
 	/** Next bitmap ID to allocate */
 	sysarg_t next_bmp_id;
+	/** Command buffer shared by client or @c NULL */
+	gc_cmd_t *cmdbuf;
+	/** Number of commands that fit in the command buffer */
+	size_t cmd_max;
 } ipc_gc_srv_t;
 
 /** Bitmap in canvas GC */
@@ -33,6 +33,15 @@
  * @file GFX IPC backend
  *
  * This implements a graphics context via HelenOS IPC.
+ *
+ * If batching is enabled with ipc_gc_batch_enable(), drawing operations
+ * that do not return anything besides an error code are encoded into
+ * a command buffer shared with the server instead of being sent one by
+ * one. The buffer is flushed in a single request on gfx_update(), when
+ * it fills up or before an operation that must be synchronous. Errors
+ * of queued operations are reported by the call that flushes them.
+ * Queued bitmap renders read the bitmap pixels when they are executed,
+ * i.e. at flush time.
  */
 
 #include <as.h>
@@ -65,6 +74,53 @@ gfx_context_ops_t ipc_gc_ops = {
 	.bitmap_get_alloc = ipc_gc_bitmap_get_alloc
 };
 
+/** Flush command buffer of IPC GC.
+ *
+ * Have the server execute all queued commands.
+ *
+ * @param ipcgc IPC GC
+ * @param update @c true to also update display after executing commands
+ * @return EOK on success or error code of the first failed command
+ */
+static errno_t ipc_gc_flush(ipc_gc_t *ipcgc, bool update)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	if (ipcgc->cmd_cnt == 0 && !update)
+		return EOK;
+
+	exch = async_exchange_begin(ipcgc->sess);
+	rc = async_req_2_0(exch, GC_CMDBUF_FLUSH, ipcgc->cmd_cnt, update);
+	async_exchange_end(exch);
+
+	ipcgc->cmd_cnt = 0;
+	return rc;
+}
+
+/** Get next free entry in command buffer of IPC GC.
+ *
+ * If the command buffer is full, it is flushed first. If that fails,
+ * the new command is not queued.
+ *
+ * @param ipcgc IPC GC
+ * @param rcmd Place to store pointer to command entry
+ * @return EOK on success or an error code
+ */
+static errno_t ipc_gc_cmd_get(ipc_gc_t *ipcgc, gc_cmd_t **rcmd)
+{
+	errno_t rc;
+
+	if (ipcgc->cmd_cnt >= ipcgc->cmd_max) {
+		rc = ipc_gc_flush(ipcgc, false);
+		if (rc != EOK)
+			return rc;
+	}
+
+	*rcmd = &ipcgc->cmdbuf[ipcgc->cmd_cnt++];
+	return EOK;
+}
+
 /** Set clipping rectangle on IPC GC.
  *
  * @param arg IPC GC
@@ -76,8 +132,24 @@ static errno_t ipc_gc_set_clip_rect(void *arg, gfx_rect_t *rect)
 {
 	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
 	async_exch_t *exch;
+	gc_cmd_t *cmd;
 	errno_t rc;
 
+	if (ipcgc->cmdbuf != NULL) {
+		rc = ipc_gc_cmd_get(ipcgc, &cmd);
+		if (rc != EOK)
+			return rc;
+
+		if (rect != NULL) {
+			cmd->op = GC_CMD_SET_CLIP_RECT;
+			cmd->rect = *rect;
+		} else {
+			cmd->op = GC_CMD_SET_CLIP_RECT_NULL;
+		}
+
+		return EOK;
+	}
+
 	exch = async_exchange_begin(ipcgc->sess);
 	if (rect != NULL) {
 		rc = async_req_4_0(exch, GC_SET_CLIP_RECT, rect->p0.x, rect->p0.y,
@@ -105,10 +177,23 @@ static errno_t ipc_gc_set_color(void *arg, gfx_color_t *color)
 	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
 	async_exch_t *exch;
 	uint16_t r, g, b;
+	gc_cmd_t *cmd;
 	errno_t rc;
 
 	gfx_color_get_rgb_i16(color, &r, &g, &b);
 
+	if (ipcgc->cmdbuf != NULL) {
+		rc = ipc_gc_cmd_get(ipcgc, &cmd);
+		if (rc != EOK)
+			return rc;
+
+		cmd->op = GC_CMD_SET_RGB_COLOR;
+		cmd->r = r;
+		cmd->g = g;
+		cmd->b = b;
+		return EOK;
+	}
+
 	exch = async_exchange_begin(ipcgc->sess);
 	rc = async_req_3_0(exch, GC_SET_RGB_COLOR, r, g, b);
 	async_exchange_end(exch);
@@ -127,8 +212,19 @@ static errno_t ipc_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	ipc_gc_t *ipcgc = (ipc_gc_t *) arg;
 	async_exch_t *exch;
+	gc_cmd_t *cmd;
 	errno_t rc;
 
+	if (ipcgc->cmdbuf != NULL) {
+		rc = ipc_gc_cmd_get(ipcgc, &cmd);
+		if (rc != EOK)
+			return rc;
+
+		cmd->op = GC_CMD_FILL_RECT;
+		cmd->rect = *rect;
+		return EOK;
+	}
+
 	exch = async_exchange_begin(ipcgc->sess);
 	rc = async_req_4_0(exch, GC_FILL_RECT, rect->p0.x, rect->p0.y,
 	    rect->p1.x, rect->p1.y);
@@ -149,6 +245,10 @@ static errno_t ipc_gc_update(void *arg)
 	async_exch_t *exch;
 	errno_t rc;
 
+	/* Execute queued commands and update in one request */
+	if (ipcgc->cmdbuf != NULL)
+		return ipc_gc_flush(ipcgc, true);
+
 	exch = async_exchange_begin(ipcgc->sess);
 	rc = async_req_0_0(exch, GC_UPDATE);
 	async_exchange_end(exch);
@@ -363,6 +463,13 @@ static errno_t ipc_gc_bitmap_destroy(void *bm)
 	async_exch_t *exch;
 	errno_t rc;
 
+	/* Queued commands may refer to the bitmap */
+	if (ipcbm->ipcgc->cmdbuf != NULL) {
+		rc = ipc_gc_flush(ipcbm->ipcgc, false);
+		if (rc != EOK)
+			return rc;
+	}
+
 	exch = async_exchange_begin(ipcbm->ipcgc->sess);
 	rc = async_req_1_0(exch, GC_BITMAP_DESTROY, ipcbm->bmp_id);
 	async_exchange_end(exch);
@@ -392,6 +499,7 @@ static errno_t ipc_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_coord2_t offs;
 	async_exch_t *exch = NULL;
 	ipc_call_t answer;
+	gc_cmd_t *cmd;
 	aid_t req;
 	errno_t rc;
 
@@ -410,6 +518,18 @@ static errno_t ipc_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	/* Destination rectangle */
 	gfx_rect_translate(&offs, &srect, &drect);
 
+	if (ipcbm->ipcgc->cmdbuf != NULL) {
+		rc = ipc_gc_cmd_get(ipcbm->ipcgc, &cmd);
+		if (rc != EOK)
+			return rc;
+
+		cmd->op = GC_CMD_BITMAP_RENDER;
+		cmd->bmp_id = ipcbm->bmp_id;
+		cmd->rect = srect;
+		cmd->offs = offs;
+		return EOK;
+	}
+
 	exch = async_exchange_begin(ipcbm->ipcgc->sess);
 	req = async_send_3(exch, GC_BITMAP_RENDER, ipcbm->bmp_id, offs.x,
 	    offs.y, &answer);
@@ -495,10 +615,65 @@ errno_t ipc_gc_delete(ipc_gc_t *ipcgc)
 	if (rc != EOK)
 		return rc;
 
+	if (ipcgc->cmdbuf != NULL) {
+		(void) ipc_gc_flush(ipcgc, false);
+		as_area_destroy(ipcgc->cmdbuf);
+	}
+
 	free(ipcgc);
 	return EOK;
 }
 
+/** Enable batching of drawing operations in IPC GC.
+ *
+ * Set up a command buffer shared with the server. From now on drawing
+ * operations are queued and only sent when the buffer is flushed.
+ * If this fails, the GC keeps working synchronously.
+ *
+ * @param ipcgc IPC GC
+ * @return EOK on success or an error code
+ */
+errno_t ipc_gc_batch_enable(ipc_gc_t *ipcgc)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	void *cmdbuf;
+	aid_t req;
+	errno_t rc;
+
+	if (ipcgc->cmdbuf != NULL)
+		return EOK;
+
+	cmdbuf = as_area_create(AS_AREA_ANY, GC_CMDBUF_SIZE, AS_AREA_READ |
+	    AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (cmdbuf == AS_MAP_FAILED)
+		return ENOMEM;
+
+	exch = async_exchange_begin(ipcgc->sess);
+	req = async_send_0(exch, GC_CMDBUF_CREATE, &answer);
+	rc = async_share_out_start(exch, cmdbuf, AS_AREA_READ |
+	    AS_AREA_CACHEABLE);
+	if (rc != EOK) {
+		async_forget(req);
+		async_exchange_end(exch);
+		goto error;
+	}
+
+	async_exchange_end(exch);
+
+	async_wait_for(req, &rc);
+	if (rc != EOK)
+		goto error;
+
+	ipcgc->cmdbuf = (gc_cmd_t *) cmdbuf;
+	ipcgc->cmd_max = GC_CMDBUF_SIZE / sizeof(gc_cmd_t);
+	ipcgc->cmd_cnt = 0;
+	return EOK;
+error:
+	as_area_destroy(cmdbuf);
+	return rc;
+}
+
 /** Get generic graphic context from IPC GC.
  *
  * @param ipcgc IPC GC
@@ -356,6 +356,104 @@ static void gc_bitmap_render_srv(ipc_gc_srv_t *srvgc, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void gc_cmdbuf_create_srv(ipc_gc_srv_t *srvgc, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+	void *cmdbuf;
+	errno_t rc;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	if (srvgc->cmdbuf != NULL || size != GC_CMDBUF_SIZE) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	rc = async_share_out_finalize(&call, &cmdbuf);
+	if (rc != EOK || cmdbuf == AS_MAP_FAILED) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	srvgc->cmdbuf = (gc_cmd_t *) cmdbuf;
+	srvgc->cmd_max = GC_CMDBUF_SIZE / sizeof(gc_cmd_t);
+	async_answer_0(icall, EOK);
+}
+
+/** Execute one command from command buffer.
+ *
+ * @param srvgc Server GC
+ * @param cmd Command (a private copy, the client can modify the buffer)
+ * @return EOK on success or an error code
+ */
+static errno_t gc_cmd_execute(ipc_gc_srv_t *srvgc, gc_cmd_t *cmd)
+{
+	ipc_gc_srv_bitmap_t *bitmap;
+	gfx_color_t *color;
+	errno_t rc;
+
+	switch (cmd->op) {
+	case GC_CMD_SET_CLIP_RECT:
+		return gfx_set_clip_rect(srvgc->gc, &cmd->rect);
+	case GC_CMD_SET_CLIP_RECT_NULL:
+		return gfx_set_clip_rect(srvgc->gc, NULL);
+	case GC_CMD_SET_RGB_COLOR:
+		rc = gfx_color_new_rgb_i16(cmd->r, cmd->g, cmd->b, &color);
+		if (rc != EOK)
+			return ENOMEM;
+
+		rc = gfx_set_color(srvgc->gc, color);
+		gfx_color_delete(color);
+		return rc;
+	case GC_CMD_FILL_RECT:
+		return gfx_fill_rect(srvgc->gc, &cmd->rect);
+	case GC_CMD_BITMAP_RENDER:
+		bitmap = gc_bitmap_lookup(srvgc, cmd->bmp_id);
+		if (bitmap == NULL)
+			return ENOENT;
+
+		return gfx_bitmap_render(bitmap->bmp, &cmd->rect, &cmd->offs);
+	}
+
+	return EINVAL;
+}
+
+static void gc_cmdbuf_flush_srv(ipc_gc_srv_t *srvgc, ipc_call_t *call)
+{
+	gc_cmd_t cmd;
+	size_t cnt;
+	size_t i;
+	bool update;
+	errno_t rc;
+
+	cnt = ipc_get_arg1(call);
+	update = ipc_get_arg2(call) != 0;
+
+	if (cnt > 0 && (srvgc->cmdbuf == NULL || cnt > srvgc->cmd_max)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	/* Stop at the first failure, the following commands depend on it */
+	for (i = 0; i < cnt; i++) {
+		cmd = srvgc->cmdbuf[i];
+		rc = gc_cmd_execute(srvgc, &cmd);
+		if (rc != EOK) {
+			async_answer_0(call, rc);
+			return;
+		}
+	}
+
+	rc = update ? gfx_update(srvgc->gc) : EOK;
+	async_answer_0(call, rc);
+}
+
 errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 {
 	ipc_gc_srv_t srvgc;
@@ -368,6 +466,8 @@ errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 	srvgc.gc = gc;
 	list_initialize(&srvgc.bitmaps);
 	srvgc.next_bmp_id = 1;
+	srvgc.cmdbuf = NULL;
+	srvgc.cmd_max = 0;
 
 	while (true) {
 		ipc_call_t call;
@@ -408,6 +508,12 @@ errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 		case GC_BITMAP_RENDER:
 			gc_bitmap_render_srv(&srvgc, &call);
 			break;
+		case GC_CMDBUF_CREATE:
+			gc_cmdbuf_create_srv(&srvgc, &call);
+			break;
+		case GC_CMDBUF_FLUSH:
+			gc_cmdbuf_flush_srv(&srvgc, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
@@ -434,6 +540,9 @@ errno_t gc_conn(ipc_call_t *icall, gfx_context_t *gc)
 		link = list_first(&srvgc.bitmaps);
 	}
 
+	if (srvgc.cmdbuf != NULL)
+		as_area_destroy(srvgc.cmdbuf);
+
 	return EOK;
 }
 
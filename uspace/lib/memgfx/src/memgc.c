@@ -42,11 +42,20 @@
 #include <gfx/context.h>
 #include <gfx/render.h>
 #include <io/pixel.h>
-#include <io/pixelmap.h>
+#include <mem.h>
 #include <memgfx/memgc.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "../private/memgc.h"
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define MEMGC_VECTOR
+#endif
+
+#ifdef MEMGC_VECTOR
+typedef uint32_t v4u32_t __attribute__((vector_size(16)));
+#endif
+
 static errno_t mem_gc_set_clip_rect(void *, gfx_rect_t *);
 static errno_t mem_gc_set_color(void *, gfx_color_t *);
 static errno_t mem_gc_fill_rect(void *, gfx_rect_t *);
@@ -75,6 +84,95 @@ gfx_context_ops_t mem_gc_ops = {
 	.cursor_set_visible = mem_gc_cursor_set_visible
 };
 
+/** Fill a row of pixels with a color.
+ *
+ * @param d Destination pixels
+ * @param count Number of pixels
+ * @param color Color
+ */
+static void mem_gc_fill_row(pixel_t *d, size_t count, pixel_t color)
+{
+	size_t i = 0;
+
+#ifdef MEMGC_VECTOR
+	const v4u32_t c = { color, color, color, color };
+
+	for (; i + 4 <= count; i += 4)
+		memcpy(d + i, &c, sizeof(c));
+#endif
+	for (; i < count; i++)
+		d[i] = color;
+}
+
+/** Copy a row of pixels except those equal to the key color.
+ *
+ * @param d Destination pixels
+ * @param s Source pixels
+ * @param count Number of pixels
+ * @param key Key color
+ */
+static void mem_gc_key_row(pixel_t *d, const pixel_t *s, size_t count,
+    pixel_t key)
+{
+	size_t i = 0;
+
+#ifdef MEMGC_VECTOR
+	const v4u32_t k = { key, key, key, key };
+
+	for (; i + 4 <= count; i += 4) {
+		v4u32_t a, b, m;
+
+		memcpy(&a, s + i, sizeof(a));
+		memcpy(&b, d + i, sizeof(b));
+
+		/* All ones where the source pixel is transparent */
+		m = (v4u32_t) (a == k);
+		b = (b & m) | (a & ~m);
+
+		memcpy(d + i, &b, sizeof(b));
+	}
+#endif
+	for (; i < count; i++) {
+		if (s[i] != key)
+			d[i] = s[i];
+	}
+}
+
+/** Set pixels of a row where the source is not equal to the key color.
+ *
+ * @param d Destination pixels
+ * @param s Source pixels
+ * @param count Number of pixels
+ * @param key Key color
+ * @param color Color to set
+ */
+static void mem_gc_colorize_row(pixel_t *d, const pixel_t *s, size_t count,
+    pixel_t key, pixel_t color)
+{
+	size_t i = 0;
+
+#ifdef MEMGC_VECTOR
+	const v4u32_t k = { key, key, key, key };
+	const v4u32_t c = { color, color, color, color };
+
+	for (; i + 4 <= count; i += 4) {
+		v4u32_t a, b, m;
+
+		memcpy(&a, s + i, sizeof(a));
+		memcpy(&b, d + i, sizeof(b));
+
+		m = (v4u32_t) (a == k);
+		b = (b & m) | (c & ~m);
+
+		memcpy(d + i, &b, sizeof(b));
+	}
+#endif
+	for (; i < count; i++) {
+		if (s[i] != key)
+			d[i] = color;
+	}
+}
+
 /** Set clipping rectangle on memory GC.
  *
  * @param arg Memory GC
@@ -126,8 +224,10 @@ static errno_t mem_gc_fill_rect(void *arg, gfx_rect_t *rect)
 {
 	mem_gc_t *mgc = (mem_gc_t *) arg;
 	gfx_rect_t crect;
-	gfx_coord_t x, y;
-	pixelmap_t pixelmap;
+	gfx_coord_t y;
+	pixel_t *row;
+	size_t width;
+	size_t pitch;
 
 	/* Make sure we have a sorted, clipped rectangle */
 	gfx_rect_clip(rect, &mgc->clip_rect, &crect);
@@ -135,14 +235,14 @@ static errno_t mem_gc_fill_rect(void *arg, gfx_rect_t *rect)
 	assert(mgc->rect.p0.x == 0);
 	assert(mgc->rect.p0.y == 0);
 	assert(mgc->alloc.pitch == mgc->rect.p1.x * (int)sizeof(uint32_t));
-	pixelmap.width = mgc->rect.p1.x;
-	pixelmap.height = mgc->rect.p1.y;
-	pixelmap.data = mgc->alloc.pixels;
+
+	pitch = mgc->rect.p1.x;
+	width = crect.p1.x - crect.p0.x;
+	row = (pixel_t *) mgc->alloc.pixels + crect.p0.y * pitch + crect.p0.x;
 
 	for (y = crect.p0.y; y < crect.p1.y; y++) {
-		for (x = crect.p0.x; x < crect.p1.x; x++) {
-			pixelmap_put_pixel(&pixelmap, x, y, mgc->color);
-		}
+		mem_gc_fill_row(row, width, mgc->color);
+		row += pitch;
 	}
 
 	mem_gc_invalidate_rect(mgc, &crect);
@@ -379,10 +479,12 @@ static errno_t mem_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 	gfx_rect_t drect;
 	gfx_rect_t crect;
 	gfx_coord2_t offs;
-	gfx_coord_t x, y;
-	pixelmap_t smap;
-	pixelmap_t dmap;
-	pixel_t pixel;
+	gfx_coord_t y;
+	pixel_t *srow;
+	pixel_t *drow;
+	size_t spitch;
+	size_t dpitch;
+	size_t width;
 
 	if (srect0 != NULL)
 		gfx_rect_clip(srect0, &mbm->rect, &srect);
@@ -404,51 +506,43 @@ static errno_t mem_gc_bitmap_render(void *bm, gfx_rect_t *srect0,
 
 	assert(mbm->alloc.pitch == (mbm->rect.p1.x - mbm->rect.p0.x) *
 	    (int)sizeof(uint32_t));
-	smap.width = mbm->rect.p1.x - mbm->rect.p0.x;
-	smap.height = mbm->rect.p1.y - mbm->rect.p0.y;
-	smap.data = mbm->alloc.pixels;
-
 	assert(mbm->mgc->rect.p0.x == 0);
 	assert(mbm->mgc->rect.p0.y == 0);
 	assert(mbm->mgc->alloc.pitch == mbm->mgc->rect.p1.x * (int)sizeof(uint32_t));
-	dmap.width = mbm->mgc->rect.p1.x;
-	dmap.height = mbm->mgc->rect.p1.y;
-	dmap.data = mbm->mgc->alloc.pixels;
 
-	if ((mbm->flags & bmpf_direct_output) != 0) {
+	/* Start of the first source and destination row */
+	spitch = mbm->rect.p1.x - mbm->rect.p0.x;
+	dpitch = mbm->mgc->rect.p1.x;
+	width = crect.p1.x - crect.p0.x;
+	srow = (pixel_t *) mbm->alloc.pixels +
+	    (crect.p0.y - mbm->rect.p0.y - offs.y) * spitch +
+	    (crect.p0.x - mbm->rect.p0.x - offs.x);
+	drow = (pixel_t *) mbm->mgc->alloc.pixels + crect.p0.y * dpitch +
+	    crect.p0.x;
+
+	if ((mbm->flags & bmpf_direct_output) != 0 || gfx_rect_is_empty(&crect)) {
 		/* Nothing to do */
 	} else if ((mbm->flags & bmpf_color_key) == 0) {
 		/* Simple copy */
 		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				pixelmap_put_pixel(&dmap, x, y, pixel);
-			}
+			memcpy(drow, srow, width * sizeof(pixel_t));
+			srow += spitch;
+			drow += dpitch;
 		}
 	} else if ((mbm->flags & bmpf_colorize) == 0) {
 		/* Color key */
 		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				if (pixel != mbm->key_color)
-					pixelmap_put_pixel(&dmap, x, y, pixel);
-			}
+			mem_gc_key_row(drow, srow, width, mbm->key_color);
+			srow += spitch;
+			drow += dpitch;
 		}
 	} else {
 		/* Color key & colorization */
 		for (y = crect.p0.y; y < crect.p1.y; y++) {
-			for (x = crect.p0.x; x < crect.p1.x; x++) {
-				pixel = pixelmap_get_pixel(&smap,
-				    x - mbm->rect.p0.x - offs.x,
-				    y - mbm->rect.p0.y - offs.y);
-				if (pixel != mbm->key_color)
-					pixelmap_put_pixel(&dmap, x, y,
-					    mbm->mgc->color);
-			}
+			mem_gc_colorize_row(drow, srow, width, mbm->key_color,
+			    mbm->mgc->color);
+			srow += spitch;
+			drow += dpitch;
 		}
 	}
 
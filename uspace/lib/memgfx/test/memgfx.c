@@ -279,6 +279,109 @@ PCUT_TEST(bitmap_render)
 	free(alloc.pixels);
 }
 
+/** Test rendering a color-keyed bitmap with offset in memory GC */
+PCUT_TEST(bitmap_render_color_key)
+{
+	mem_gc_t *mgc;
+	gfx_rect_t rect;
+	gfx_rect_t drect;
+	gfx_bitmap_alloc_t alloc;
+	gfx_context_t *gc;
+	gfx_coord2_t pos;
+	gfx_coord2_t offs;
+	gfx_bitmap_params_t params;
+	gfx_bitmap_alloc_t balloc;
+	gfx_bitmap_t *bitmap;
+	pixelmap_t bpmap;
+	pixelmap_t dpmap;
+	pixel_t pixel;
+	pixel_t expected;
+	test_resp_t resp;
+	errno_t rc;
+
+	/* Bounding rectangle for memory GC */
+	rect.p0.x = 0;
+	rect.p0.y = 0;
+	rect.p1.x = 10;
+	rect.p1.y = 10;
+
+	alloc.pitch = (rect.p1.x - rect.p0.x) * sizeof(uint32_t);
+	alloc.off0 = 0;
+	alloc.pixels = calloc(1, alloc.pitch * (rect.p1.y - rect.p0.y));
+	PCUT_ASSERT_NOT_NULL(alloc.pixels);
+
+	rc = mem_gc_create(&rect, &alloc, &test_mem_gc_cb, &resp, &mgc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gc = mem_gc_get_ctx(mgc);
+	PCUT_ASSERT_NOT_NULL(gc);
+
+	/* Create bitmap, width is not a multiple of four */
+
+	gfx_bitmap_params_init(&params);
+	params.rect.p0.x = 0;
+	params.rect.p0.y = 0;
+	params.rect.p1.x = 7;
+	params.rect.p1.y = 3;
+	params.flags = bmpf_color_key;
+	params.key_color = PIXEL(0, 255, 0, 255);
+
+	rc = gfx_bitmap_create(gc, &params, NULL, &bitmap);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = gfx_bitmap_get_alloc(bitmap, &balloc);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	bpmap.width = params.rect.p1.x - params.rect.p0.x;
+	bpmap.height = params.rect.p1.y - params.rect.p0.y;
+	bpmap.data = balloc.pixels;
+
+	/* Every third pixel is transparent */
+	for (pos.y = params.rect.p0.y; pos.y < params.rect.p1.y; pos.y++) {
+		for (pos.x = params.rect.p0.x; pos.x < params.rect.p1.x; pos.x++) {
+			pixelmap_put_pixel(&bpmap, pos.x, pos.y,
+			    (pos.x + pos.y) % 3 == 0 ? params.key_color :
+			    PIXEL(0, 255, 255, 0));
+		}
+	}
+
+	dpmap.width = rect.p1.x - rect.p0.x;
+	dpmap.height = rect.p1.y - rect.p0.y;
+	dpmap.data = alloc.pixels;
+
+	memset(&resp, 0, sizeof(resp));
+
+	/* Render the bitmap with offset */
+	offs.x = 2;
+	offs.y = 1;
+	rc = gfx_bitmap_render(bitmap, NULL, &offs);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_rect_translate(&offs, &params.rect, &drect);
+
+	/* Check that only opaque pixels of the bitmap were copied */
+	for (pos.y = rect.p0.y; pos.y < rect.p1.y; pos.y++) {
+		for (pos.x = rect.p0.x; pos.x < rect.p1.x; pos.x++) {
+			pixel = pixelmap_get_pixel(&dpmap, pos.x, pos.y);
+			expected = gfx_pix_inside_rect(&pos, &drect) &&
+			    (pos.x - offs.x + pos.y - offs.y) % 3 != 0 ?
+			    PIXEL(0, 255, 255, 0) : PIXEL(0, 0, 0, 0);
+			PCUT_ASSERT_INT_EQUALS(expected, pixel);
+		}
+	}
+
+	/* Check that the invalidate rect is equal to the rendered rect */
+	PCUT_ASSERT_TRUE(resp.invalidate_called);
+	PCUT_ASSERT_INT_EQUALS(drect.p0.x, resp.inv_rect.p0.x);
+	PCUT_ASSERT_INT_EQUALS(drect.p0.y, resp.inv_rect.p0.y);
+	PCUT_ASSERT_INT_EQUALS(drect.p1.x, resp.inv_rect.p1.x);
+	PCUT_ASSERT_INT_EQUALS(drect.p1.y, resp.inv_rect.p1.y);
+
+	gfx_bitmap_destroy(bitmap);
+	mem_gc_delete(mgc);
+	free(alloc.pixels);
+}
+
 /** Test gfx_update() on a memory GC */
 PCUT_TEST(gfx_update)
 {
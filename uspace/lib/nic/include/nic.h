@@ -68,6 +68,8 @@ typedef struct {
 	link_t link;
 	void *data;
 	size_t size;
+	/** Offloads performed on a received frame (NIC_OFFLOAD_RX_CSUM) */
+	uint32_t offload;
 } nic_frame_t;
 
 typedef list_t nic_frame_list_t;
@@ -84,6 +86,19 @@ typedef list_t nic_frame_list_t;
  */
 typedef void (*send_frame_handler)(nic_t *, void *, size_t);
 
+/**
+ * Handler for writing frame data to the NIC device, letting the NIC
+ * perform the requested offload computations. Otherwise the same as
+ * send_frame_handler.
+ *
+ * @param nic_data
+ * @param data		Pointer to frame data
+ * @param size		Size of frame data in bytes
+ * @param offload	Offload computations requested for the frame
+ */
+typedef void (*send_frame_offload_handler)(nic_t *, void *, size_t,
+    const nic_tx_offload_t *);
+
 /**
  * The handler for transitions between driver states.
  * If the handler returns error code, the transition between
@@ -205,6 +220,34 @@ typedef errno_t (*poll_mode_change_handler)(nic_t *,
  */
 typedef void (*poll_request_handler)(nic_t *);
 
+/**
+ * Handler receiving frames from the device buffers in the interrupt/poll
+ * hybrid receive (see nic_napi_init()). It must not receive more than
+ * @a budget frames.
+ *
+ * @param nic_data	NICF main structure
+ * @param budget	Maximum number of frames to receive
+ *
+ * @return Number of frames received
+ */
+typedef size_t (*napi_poll_handler)(nic_t *, size_t);
+
+/**
+ * Handler enabling or disabling the receive interrupts of the device
+ * in the interrupt/poll hybrid receive.
+ *
+ * @param nic_data	NICF main structure
+ * @param enable	True to enable the interrupts, false to disable them
+ */
+typedef void (*napi_irq_handler)(nic_t *, bool);
+
+/**
+ * Minimum interval between IRQ notifications in microseconds suggested for
+ * drivers using the interrupt/poll hybrid receive. Interrupts arriving
+ * while the receive fibril polls are merged into one notification.
+ */
+#define NIC_NAPI_IRQ_INTERVAL  50
+
 /* nic_t allocation and deallocation */
 extern nic_t *nic_create_and_bind(ddf_dev_t *);
 extern void nic_unbind_and_destroy(ddf_dev_t *);
@@ -228,6 +271,9 @@ extern void nic_set_wol_virtue_change_handlers(nic_t *,
     wol_virtue_add_handler, wol_virtue_remove_handler);
 extern void nic_set_poll_handlers(nic_t *,
     poll_mode_change_handler, poll_request_handler);
+extern void nic_set_offload_handler(nic_t *, uint32_t,
+    send_frame_offload_handler);
+extern errno_t nic_napi_init(nic_t *, napi_poll_handler, napi_irq_handler);
 
 /* General driver functions */
 extern ddf_dev_t *nic_get_ddf_dev(nic_t *);
@@ -244,6 +290,11 @@ extern void nic_query_address(nic_t *, nic_address_t *);
 extern void nic_received_frame(nic_t *, nic_frame_t *);
 extern void nic_received_frame_list(nic_t *, nic_frame_list_t *);
 extern nic_poll_mode_t nic_query_poll_mode(nic_t *, struct timespec *);
+extern uint32_t nic_query_offload(nic_t *);
+extern void *nic_rx_ring_slot(nic_t *, size_t *);
+extern void nic_rx_ring_put(nic_t *, size_t, uint32_t);
+extern void nic_rx_ring_flush(nic_t *);
+extern void nic_napi_schedule(nic_t *);
 
 /* Statistics updates */
 extern void nic_report_send_ok(nic_t *, size_t, size_t);
@@ -42,9 +42,11 @@
 #error "This is internal libnic's header, please do not include it"
 #endif
 
+#include <adt/pkt_ring.h>
 #include <fibril_synch.h>
 #include <nic/nic.h>
 #include <async.h>
+#include <time.h>
 
 #include "nic.h"
 #include "nic_rx_control.h"
@@ -56,6 +58,28 @@ struct sw_poll_info {
 	volatile int running;
 };
 
+/** Interrupt/poll hybrid receive (NAPI) information */
+struct napi_info {
+	/** Receive fibril, 0 if the driver does not use NAPI */
+	fid_t fibril;
+	/** Protects @c scheduled */
+	fibril_mutex_t lock;
+	/** Signalled when the receive fibril is scheduled */
+	fibril_condvar_t cv;
+	/** Receive interrupt arrived, the receive fibril should poll */
+	bool scheduled;
+	/** Driver's function receiving frames */
+	napi_poll_handler poll;
+	/** Driver's function enabling and disabling receive interrupts */
+	napi_irq_handler irq;
+	/** Polling with interrupts disabled because of high frame rate */
+	bool busy;
+	/** Start of the current frame rate measurement window */
+	usec_t window_start;
+	/** Frames received in the current measurement window */
+	size_t window_frames;
+};
+
 struct nic {
 	/**
 	 * Device from device manager's point of view.
@@ -89,6 +113,8 @@ struct nic {
 	struct timespec default_poll_period;
 	/** Software period fibrill information */
 	struct sw_poll_info sw_poll_info;
+	/** Interrupt/poll hybrid receive information */
+	struct napi_info napi;
 	/**
 	 * Lock on everything but statistics, rx control and wol virtues. This lock
 	 * cannot be used if filters_lock or stats_lock is already held - you must
@@ -194,6 +220,28 @@ struct nic {
 	 * The implementation is optional.
 	 */
 	poll_request_handler on_poll_request;
+	/** Offload computations supported by the NIC (NIC_OFFLOAD_*) */
+	uint32_t offload_supported;
+	/** Offload computations enabled by the client */
+	uint32_t offload_active;
+	/**
+	 * Function sending the data with offload computations. Must be set
+	 * if TX offloads are supported. Called with the main_lock locked for
+	 * reading.
+	 */
+	send_frame_offload_handler send_frame_offload;
+	/** Area with the ring of received frames shared with the client */
+	void *rx_ring_area;
+	/** Ring of received frames (producer side) */
+	pkt_ring_t rx_ring;
+	/** Serializes nic_received_frame() callers on the RX ring */
+	fibril_mutex_t rx_ring_lock;
+	/** Area with the ring of frames to send shared with the client */
+	void *tx_ring_area;
+	/** Ring of frames to send (consumer side) */
+	pkt_ring_t tx_ring;
+	/** Raised when the client rings the TX ring doorbell */
+	fibril_semaphore_t tx_ring_doorbell;
 	/** Data specific for particular driver */
 	void *specific;
 };
@@ -37,7 +37,9 @@
  */
 
 #include <assert.h>
+#include <fibril.h>
 #include <fibril_synch.h>
+#include <mem.h>
 #include <ns.h>
 #include <stdio.h>
 #include <str_error.h>
@@ -51,6 +53,17 @@
 #include "nic_ev.h"
 #include "nic_impl.h"
 
+/** Maximum number of frames received in one NAPI poll */
+#define NIC_NAPI_BUDGET  64
+/** Length of the NAPI frame rate measurement window in microseconds */
+#define NIC_NAPI_WINDOW  10000
+/** Frame rate (frames per second) switching NAPI to polling */
+#define NIC_NAPI_BUSY_RATE  20000
+/** Frame rate (frames per second) switching NAPI back to interrupts */
+#define NIC_NAPI_IDLE_RATE  5000
+/** Interval between NAPI polls without interrupts in microseconds */
+#define NIC_NAPI_BUSY_INTERVAL  500
+
 #define NIC_GLOBALS_MAX_CACHE_SIZE 16
 
 nic_globals_t nic_globals;
@@ -143,6 +156,16 @@ void nic_driver_implement(driver_ops_t *driver_ops, ddf_dev_ops_t *dev_ops,
 			iface->poll_set_mode = nic_poll_set_mode_impl;
 		if (!iface->poll_now)
 			iface->poll_now = nic_poll_now_impl;
+		if (!iface->offload_probe)
+			iface->offload_probe = nic_offload_probe_impl;
+		if (!iface->offload_set)
+			iface->offload_set = nic_offload_set_impl;
+		if (!iface->send_frame_offload)
+			iface->send_frame_offload = nic_send_frame_offload_impl;
+		if (!iface->ring_setup)
+			iface->ring_setup = nic_ring_setup_impl;
+		if (!iface->ring_doorbell)
+			iface->ring_doorbell = nic_ring_doorbell_impl;
 	}
 }
 
@@ -160,6 +183,25 @@ void nic_set_send_frame_handler(nic_t *nic_data, send_frame_handler sffunc)
 	nic_data->send_frame = sffunc;
 }
 
+/**
+ * Setup offload computations supported by the NIC. This function can be
+ * called only in the add_device handler. The computations stay disabled
+ * until the client enables them.
+ *
+ * @param nic_data
+ * @param supported	Supported offload computations (NIC_OFFLOAD_*)
+ * @param sfofunc	Function sending frames with TX offloads (can be NULL
+ *			if only NIC_OFFLOAD_RX_CSUM is supported)
+ */
+void nic_set_offload_handler(nic_t *nic_data, uint32_t supported,
+    send_frame_offload_handler sfofunc)
+{
+	assert(sfofunc != NULL || (supported & ~NIC_OFFLOAD_RX_CSUM) == 0);
+
+	nic_data->offload_supported = supported;
+	nic_data->send_frame_offload = sfofunc;
+}
+
 /**
  * Setup event handlers for transitions between driver states.
  * This function can be called only in the add_device handler.
@@ -232,6 +274,39 @@ void nic_set_poll_handlers(nic_t *nic_data,
 	nic_data->on_poll_request = on_poll_req;
 }
 
+static errno_t napi_fibril_fun(void *);
+
+/**
+ * Setup the interrupt/poll hybrid receive (NAPI). The driver's interrupt
+ * handler then leaves the receive interrupts disabled and calls
+ * nic_napi_schedule() instead of receiving the frames itself. A fibril
+ * receives the frames in batches using @a poll and re-enables the
+ * interrupts using @a irq when there are no more frames. When the frame
+ * rate is high, the interrupts stay disabled and the fibril polls the
+ * device periodically instead.
+ *
+ * This function can be called only in the add_device handler.
+ *
+ * @param poll	Receives at most the given number of frames
+ * @param irq	Enables or disables the receive interrupts
+ *
+ * @return EOK or ENOMEM if the receive fibril cannot be created
+ */
+errno_t nic_napi_init(nic_t *nic_data, napi_poll_handler poll,
+    napi_irq_handler irq)
+{
+	assert(poll != NULL && irq != NULL);
+
+	nic_data->napi.poll = poll;
+	nic_data->napi.irq = irq;
+	nic_data->napi.fibril = fibril_create(napi_fibril_fun, nic_data);
+	if (nic_data->napi.fibril == 0)
+		return ENOMEM;
+
+	fibril_add_ready(nic_data->napi.fibril);
+	return EOK;
+}
+
 /**
  * Connect to the parent's driver and get HW resources list in parsed format.
  * Note: this function should be called only from add_device handler, therefore
@@ -287,6 +362,7 @@ nic_frame_t *nic_alloc_frame(nic_t *nic_data, size_t size)
 	}
 
 	frame->size = size;
+	frame->offload = 0;
 	return frame;
 }
 
@@ -390,6 +466,16 @@ nic_poll_mode_t nic_query_poll_mode(nic_t *nic_data, struct timespec *period)
 	return nic_data->poll_mode;
 }
 
+/** Query the offload computations enabled by the client
+ *
+ *  @param nic_data The controller data
+ *  @return Enabled offload computations (NIC_OFFLOAD_*)
+ */
+uint32_t nic_query_offload(nic_t *nic_data)
+{
+	return nic_data->offload_active;
+}
+
 /** Inform the NICF about poll mode
  *
  *  @param nic_data The controller data
@@ -507,31 +593,27 @@ void nic_set_tx_busy(nic_t *nic_data, int busy)
 	nic_data->tx_busy = busy;
 }
 
-/**
- * This is the function that the driver should call when it receives a frame.
- * The frame is checked by filters and then sent up to the NIL layer or
- * discarded. The frame is released.
+/** Check received frame against filters and update statistics.
  *
  * @param nic_data
- * @param frame		The received frame
+ * @param data		Frame data
+ * @param size		Frame size in bytes
+ *
+ * @return true if the frame should be passed to the client
  */
-void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+static bool nic_rx_accept(nic_t *nic_data, void *data, size_t size)
 {
-	/*
-	 * Note: this function must not lock main lock, because loopback driver
-	 * 		 calls it inside send_frame handler (with locked main lock)
-	 */
 	fibril_rwlock_read_lock(&nic_data->rxc_lock);
 	nic_frame_type_t frame_type;
-	bool check = nic_rxc_check(&nic_data->rx_control, frame->data,
-	    frame->size, &frame_type);
+	bool check = nic_rxc_check(&nic_data->rx_control, data, size,
+	    &frame_type);
 	fibril_rwlock_read_unlock(&nic_data->rxc_lock);
 	/* Update statistics */
 	fibril_rwlock_write_lock(&nic_data->stats_lock);
 
 	if (nic_data->state == NIC_STATE_ACTIVE && check) {
 		nic_data->stats.receive_packets++;
-		nic_data->stats.receive_bytes += frame->size;
+		nic_data->stats.receive_bytes += size;
 		switch (frame_type) {
 		case NIC_FRAME_MULTICAST:
 			nic_data->stats.receive_multicast++;
@@ -543,22 +625,127 @@ void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
 			break;
 		}
 		fibril_rwlock_write_unlock(&nic_data->stats_lock);
-		nic_ev_received(nic_data->client_session, frame->data,
-		    frame->size);
-	} else {
-		switch (frame_type) {
-		case NIC_FRAME_UNICAST:
-			nic_data->stats.receive_filtered_unicast++;
-			break;
-		case NIC_FRAME_MULTICAST:
-			nic_data->stats.receive_filtered_multicast++;
-			break;
-		case NIC_FRAME_BROADCAST:
-			nic_data->stats.receive_filtered_broadcast++;
-			break;
+		return true;
+	}
+
+	switch (frame_type) {
+	case NIC_FRAME_UNICAST:
+		nic_data->stats.receive_filtered_unicast++;
+		break;
+	case NIC_FRAME_MULTICAST:
+		nic_data->stats.receive_filtered_multicast++;
+		break;
+	case NIC_FRAME_BROADCAST:
+		nic_data->stats.receive_filtered_broadcast++;
+		break;
+	}
+	fibril_rwlock_write_unlock(&nic_data->stats_lock);
+	return false;
+}
+
+/**
+ * Get a free slot in the ring of received frames shared with the client.
+ *
+ * A driver can receive a frame directly into the slot (e.g. by letting
+ * the device DMA into it) and pass it on with nic_rx_ring_put(). Filling
+ * slots directly must be done from a single fibril that does not call
+ * nic_received_frame() at the same time.
+ *
+ * @param nic_data
+ * @param[out] size	Size of the slot in bytes
+ *
+ * @return Pointer to the slot or NULL if there is no ring or it is full
+ */
+void *nic_rx_ring_slot(nic_t *nic_data, size_t *size)
+{
+	if (nic_data->rx_ring_area == NULL)
+		return NULL;
+
+	*size = nic_data->rx_ring.slot_size;
+	return pkt_ring_prod_slot(&nic_data->rx_ring);
+}
+
+/**
+ * Pass frame received into the slot returned by nic_rx_ring_slot() on to
+ * the client. The frame is checked by filters; a discarded frame leaves
+ * the slot free. The client does not see the frame before
+ * nic_rx_ring_flush() is called, so a driver can pass on all frames
+ * received in one interrupt at once.
+ *
+ * @param nic_data
+ * @param size		Frame size in bytes
+ * @param offload	Offload computations performed on the frame
+ */
+void nic_rx_ring_put(nic_t *nic_data, size_t size, uint32_t offload)
+{
+	pkt_ring_desc_t desc;
+	void *data;
+
+	data = pkt_ring_prod_slot(&nic_data->rx_ring);
+	assert(data != NULL);
+
+	if (!nic_rx_accept(nic_data, data, size))
+		return;
+
+	desc.size = size;
+	desc.flags = offload & nic_data->offload_active;
+	desc.arg1 = 0;
+	desc.arg2 = 0;
+	pkt_ring_prod_put(&nic_data->rx_ring, &desc);
+}
+
+/**
+ * Make frames passed by nic_rx_ring_put() visible to the client and
+ * notify it if it waits for them.
+ *
+ * @param nic_data
+ */
+void nic_rx_ring_flush(nic_t *nic_data)
+{
+	if (pkt_ring_prod_publish(&nic_data->rx_ring))
+		nic_ev_ring(nic_data->client_session);
+}
+
+/**
+ * This is the function that the driver should call when it receives a frame.
+ * The frame is checked by filters and then sent up to the NIL layer or
+ * discarded. The frame is released.
+ *
+ * If the client has set up a ring of received frames, the frame is copied
+ * into the ring. It is dropped if the ring is full. Frames larger than
+ * a ring slot (e.g. coalesced by the NIC) are still sent by IPC.
+ *
+ * @param nic_data
+ * @param frame		The received frame
+ */
+void nic_received_frame(nic_t *nic_data, nic_frame_t *frame)
+{
+	/*
+	 * Note: this function must not lock main lock, because loopback driver
+	 * 		 calls it inside send_frame handler (with locked main lock)
+	 */
+	if (nic_data->rx_ring_area != NULL &&
+	    frame->size <= nic_data->rx_ring.slot_size) {
+		size_t slot_size;
+		void *slot;
+
+		fibril_mutex_lock(&nic_data->rx_ring_lock);
+		slot = nic_rx_ring_slot(nic_data, &slot_size);
+		if (slot != NULL) {
+			memcpy(slot, frame->data, frame->size);
+			nic_rx_ring_put(nic_data, frame->size, frame->offload);
+			nic_rx_ring_flush(nic_data);
+		} else {
+			fibril_rwlock_write_lock(&nic_data->stats_lock);
+			nic_data->stats.receive_dropped++;
+			fibril_rwlock_write_unlock(&nic_data->stats_lock);
 		}
-		fibril_rwlock_write_unlock(&nic_data->stats_lock);
+		fibril_mutex_unlock(&nic_data->rx_ring_lock);
+	} else if (nic_rx_accept(nic_data, frame->data, frame->size)) {
+		nic_ev_received(nic_data->client_session, frame->data,
+		    frame->size, frame->offload & nic_data->offload_active);
 	}
+
 	nic_release_frame(nic_data, frame);
 }
 
@@ -612,6 +799,11 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	nic_data->poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->default_poll_mode = NIC_POLL_IMMEDIATE;
 	nic_data->send_frame = NULL;
+	nic_data->offload_supported = 0;
+	nic_data->offload_active = 0;
+	nic_data->send_frame_offload = NULL;
+	nic_data->rx_ring_area = NULL;
+	nic_data->tx_ring_area = NULL;
 	nic_data->on_activating = NULL;
 	nic_data->on_going_down = NULL;
 	nic_data->on_stopping = NULL;
@@ -621,6 +813,10 @@ static nic_t *nic_create(ddf_dev_t *dev)
 	fibril_rwlock_initialize(&nic_data->stats_lock);
 	fibril_rwlock_initialize(&nic_data->rxc_lock);
 	fibril_rwlock_initialize(&nic_data->wv_lock);
+	fibril_mutex_initialize(&nic_data->rx_ring_lock);
+	fibril_semaphore_initialize(&nic_data->tx_ring_doorbell, 0);
+	fibril_mutex_initialize(&nic_data->napi.lock);
+	fibril_condvar_initialize(&nic_data->napi.cv);
 
 	memset(&nic_data->mac, 0, sizeof(nic_address_t));
 	memset(&nic_data->default_mac, 0, sizeof(nic_address_t));
@@ -1132,5 +1328,131 @@ void nic_sw_period_stop(nic_t *nic_data)
 	nic_data->sw_poll_info.running = 0;
 }
 
+/** Check whether the device should receive with interrupts enabled
+ *
+ *  In the on-demand and software periodic modes the NAPI fibril must
+ *  leave the interrupts disabled.
+ *
+ *  @param nic Nic data structure
+ */
+static bool napi_irq_mode(nic_t *nic)
+{
+	if (nic->sw_poll_info.running)
+		return false;
+
+	return nic->poll_mode == NIC_POLL_IMMEDIATE ||
+	    nic->poll_mode == NIC_POLL_PERIODIC;
+}
+
+/** Account received frames and switch between interrupts and polling
+ *
+ *  @param napi   NAPI information
+ *  @param frames Number of frames received by the last poll
+ */
+static void napi_account(struct napi_info *napi, size_t frames)
+{
+	struct timespec ts;
+	usec_t now, elapsed;
+	uint64_t rate;
+
+	getuptime(&ts);
+	now = SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+
+	napi->window_frames += frames;
+	elapsed = now - napi->window_start;
+	if (elapsed < NIC_NAPI_WINDOW)
+		return;
+
+	rate = (uint64_t) napi->window_frames * 1000000 / elapsed;
+	if (rate >= NIC_NAPI_BUSY_RATE)
+		napi->busy = true;
+	else if (rate < NIC_NAPI_IDLE_RATE)
+		napi->busy = false;
+
+	napi->window_start = now;
+	napi->window_frames = 0;
+}
+
+/** Main function of the NAPI fibril
+ *
+ *  Woken up by nic_napi_schedule() with the receive interrupts disabled.
+ *  Receives frames in batches of NIC_NAPI_BUDGET until there are no more
+ *  and then enables the interrupts again. While the frame rate is high,
+ *  the interrupts stay disabled and the device is polled every
+ *  NIC_NAPI_BUSY_INTERVAL instead.
+ *
+ *  @param  data The NIC structure pointer
+ *
+ *  @return 0, never reached
+ */
+static errno_t napi_fibril_fun(void *data)
+{
+	nic_t *nic = data;
+	struct napi_info *napi = &nic->napi;
+	size_t frames;
+
+	while (true) {
+		fibril_mutex_lock(&napi->lock);
+		while (!napi->scheduled)
+			fibril_condvar_wait(&napi->cv, &napi->lock);
+		napi->scheduled = false;
+		fibril_mutex_unlock(&napi->lock);
+
+		while (true) {
+			frames = napi->poll(nic, NIC_NAPI_BUDGET);
+			napi_account(napi, frames);
+
+			if (frames == NIC_NAPI_BUDGET) {
+				/* More frames are waiting, let others run first */
+				fibril_yield();
+				continue;
+			}
+
+			if (!napi_irq_mode(nic))
+				break;
+
+			if (napi->busy) {
+				fibril_usleep(NIC_NAPI_BUSY_INTERVAL);
+				continue;
+			}
+
+			napi->irq(nic, true);
+
+			/*
+			 * A frame received after the last poll but before the
+			 * interrupts were enabled might not raise an interrupt.
+			 */
+			frames = napi->poll(nic, NIC_NAPI_BUDGET);
+			napi_account(napi, frames);
+			if (frames == 0)
+				break;
+
+			napi->irq(nic, false);
+		}
+	}
+
+	return EOK;
+}
+
+/** Schedule receiving by the NAPI fibril
+ *
+ *  Called by the driver's interrupt handler after a receive interrupt
+ *  instead of receiving the frames. The receive interrupts must stay
+ *  disabled, the NAPI fibril enables them when it is done.
+ *
+ *  @param nic_data Nic data structure
+ */
+void nic_napi_schedule(nic_t *nic_data)
+{
+	struct napi_info *napi = &nic_data->napi;
+
+	assert(napi->fibril != 0);
+
+	fibril_mutex_lock(&napi->lock);
+	napi->scheduled = true;
+	fibril_condvar_signal(&napi->cv);
+	fibril_mutex_unlock(&napi->lock);
+}
+
 /** @}
  */
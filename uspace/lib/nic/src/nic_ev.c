@@ -73,13 +73,20 @@ errno_t nic_ev_device_state(async_sess_t *sess, sysarg_t state)
 	return rc;
 }
 
-/** Frame received. */
-errno_t nic_ev_received(async_sess_t *sess, void *data, size_t size)
+/** Frame received.
+ *
+ * @param sess    Client session
+ * @param data    Frame data
+ * @param size    Frame size in bytes
+ * @param offload Offloads performed on the frame (NIC_OFFLOAD_RX_CSUM)
+ */
+errno_t nic_ev_received(async_sess_t *sess, void *data, size_t size,
+    uint32_t offload)
 {
 	async_exch_t *exch = async_exchange_begin(sess);
 
 	ipc_call_t answer;
-	aid_t req = async_send_0(exch, NIC_EV_RECEIVED, &answer);
+	aid_t req = async_send_1(exch, NIC_EV_RECEIVED, offload, &answer);
 	errno_t retval = async_data_write_start(exch, data, size);
 
 	async_exchange_end(exch);
@@ -93,5 +100,18 @@ errno_t nic_ev_received(async_sess_t *sess, void *data, size_t size)
 	return retval;
 }
 
+/** Frames have been published in the RX ring.
+ *
+ * Only sent when the client waits for frames. Not answered.
+ *
+ * @param sess    Client session
+ */
+void nic_ev_ring(async_sess_t *sess)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	async_msg_0(exch, NIC_EV_RING);
+	async_exchange_end(exch);
+}
+
 /** @}
  */
@@ -36,6 +36,7 @@
  */
 
 #include <errno.h>
+#include <fibril.h>
 #include <str_error.h>
 #include <ipc/services.h>
 #include <ns.h>
@@ -808,6 +809,218 @@ errno_t nic_poll_now_impl(ddf_fun_t *fun)
 	}
 }
 
+/**
+ * Default implementation of the offload_probe method.
+ *
+ * @param[in]	fun
+ * @param[out]	supported	Offload computations supported by the NIC
+ * @param[out]	active		Offload computations currently enabled
+ *
+ * @return EOK
+ */
+errno_t nic_offload_probe_impl(ddf_fun_t *fun, uint32_t *supported,
+    uint32_t *active)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	fibril_rwlock_read_lock(&nic_data->main_lock);
+	*supported = nic_data->offload_supported;
+	*active = nic_data->offload_active;
+	fibril_rwlock_read_unlock(&nic_data->main_lock);
+	return EOK;
+}
+
+/**
+ * Default implementation of the offload_set method.
+ *
+ * @param[in]	fun
+ * @param[in]	mask	Offload computations to change
+ * @param[in]	active	New setting of the computations in @a mask
+ *
+ * @return EOK		If the setting was changed
+ * @return ENOTSUP	If some computation to be enabled is not supported
+ * @return EINVAL	If segmentation would be enabled without TX checksums
+ */
+errno_t nic_offload_set_impl(ddf_fun_t *fun, uint32_t mask, uint32_t active)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	uint32_t nactive;
+
+	fibril_rwlock_write_lock(&nic_data->main_lock);
+	if ((active & mask & ~nic_data->offload_supported) != 0) {
+		fibril_rwlock_write_unlock(&nic_data->main_lock);
+		return ENOTSUP;
+	}
+
+	nactive = (nic_data->offload_active & ~mask) | (active & mask);
+	if ((nactive & NIC_OFFLOAD_TSO) != 0 &&
+	    (nactive & NIC_OFFLOAD_TX_CSUM) == 0) {
+		fibril_rwlock_write_unlock(&nic_data->main_lock);
+		return EINVAL;
+	}
+
+	nic_data->offload_active = nactive;
+	fibril_rwlock_write_unlock(&nic_data->main_lock);
+	return EOK;
+}
+
+/**
+ * Default implementation of the send_frame_offload method.
+ *
+ * @param	fun
+ * @param	data	Frame data
+ * @param 	size	Frame size in bytes
+ * @param	offload	Offload computations requested for the frame
+ *
+ * @return EOK		If the message was sent
+ * @return EBUSY	If the device is not in state when the frame can be sent.
+ * @return ENOTSUP	If a requested computation is not enabled
+ */
+errno_t nic_send_frame_offload_impl(ddf_fun_t *fun, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+
+	fibril_rwlock_read_lock(&nic_data->main_lock);
+	if (nic_data->state != NIC_STATE_ACTIVE || nic_data->tx_busy) {
+		fibril_rwlock_read_unlock(&nic_data->main_lock);
+		return EBUSY;
+	}
+
+	if ((offload->flags & ~nic_data->offload_active) != 0 ||
+	    nic_data->send_frame_offload == NULL) {
+		fibril_rwlock_read_unlock(&nic_data->main_lock);
+		return ENOTSUP;
+	}
+
+	nic_data->send_frame_offload(nic_data, data, size, offload);
+	fibril_rwlock_read_unlock(&nic_data->main_lock);
+	return EOK;
+}
+
+/**
+ * Send frames the client has published in the TX ring. Waits for the
+ * doorbell when the ring is empty.
+ *
+ * @param arg	NIC structure
+ *
+ * @return Never returns
+ */
+static errno_t nic_tx_ring_fibril(void *arg)
+{
+	nic_t *nic_data = (nic_t *) arg;
+	nic_tx_offload_t offload;
+	pkt_ring_desc_t desc;
+	void *data;
+
+	while (true) {
+		while ((data = pkt_ring_cons_peek(&nic_data->tx_ring,
+		    &desc)) != NULL) {
+			if (desc.flags != 0) {
+				offload.flags = desc.flags;
+				offload.csum_start = desc.arg1 & 0xffff;
+				offload.csum_offs = desc.arg1 >> 16;
+				offload.mss = desc.arg2;
+				(void) nic_send_frame_offload_impl(nic_data->fun,
+				    data, desc.size, &offload);
+			} else {
+				(void) nic_send_frame_impl(nic_data->fun, data,
+				    desc.size);
+			}
+
+			pkt_ring_cons_next(&nic_data->tx_ring);
+		}
+
+		pkt_ring_cons_publish(&nic_data->tx_ring);
+
+		if (pkt_ring_cons_wait(&nic_data->tx_ring))
+			fibril_semaphore_down(&nic_data->tx_ring_doorbell);
+	}
+
+	return EOK;
+}
+
+/**
+ * Default implementation of the ring_setup method. Attaches to a packet
+ * ring shared by the client. Frames received by the NIC are then passed
+ * to the client through the RX ring and frames to send are taken from
+ * the TX ring by a dedicated fibril.
+ *
+ * @param fun
+ * @param dir	Direction of the ring
+ * @param area	Shared area holding the ring
+ * @param size	Size of the area in bytes
+ *
+ * @return EOK If the ring has been attached
+ * @return EEXIST If there already is a ring for this direction
+ * @return EINVAL If the area does not contain a valid ring
+ * @return ENOMEM If the TX fibril cannot be created
+ */
+errno_t nic_ring_setup_impl(ddf_fun_t *fun, nic_ring_dir_t dir, void *area,
+    size_t size)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+	pkt_ring_t ring;
+	errno_t rc;
+
+	rc = pkt_ring_attach(&ring, area, size);
+	if (rc != EOK)
+		return rc;
+
+	fibril_rwlock_write_lock(&nic_data->main_lock);
+
+	switch (dir) {
+	case NIC_RING_RX:
+		if (nic_data->rx_ring_area != NULL) {
+			rc = EEXIST;
+			break;
+		}
+
+		fibril_mutex_lock(&nic_data->rx_ring_lock);
+		nic_data->rx_ring = ring;
+		nic_data->rx_ring_area = area;
+		fibril_mutex_unlock(&nic_data->rx_ring_lock);
+		break;
+	case NIC_RING_TX:
+		if (nic_data->tx_ring_area != NULL) {
+			rc = EEXIST;
+			break;
+		}
+
+		nic_data->tx_ring = ring;
+		fid_t fid = fibril_create(nic_tx_ring_fibril, nic_data);
+		if (fid == 0) {
+			rc = ENOMEM;
+			break;
+		}
+
+		nic_data->tx_ring_area = area;
+		fibril_add_ready(fid);
+		break;
+	default:
+		rc = EINVAL;
+		break;
+	}
+
+	fibril_rwlock_write_unlock(&nic_data->main_lock);
+	return rc;
+}
+
+/**
+ * Default implementation of the ring_doorbell method. Wakes up the
+ * fibril sending frames from the TX ring.
+ *
+ * @param fun
+ *
+ * @return EOK
+ */
+errno_t nic_ring_doorbell_impl(ddf_fun_t *fun)
+{
+	nic_t *nic_data = nic_get_from_ddf_fun(fun);
+
+	fibril_semaphore_up(&nic_data->tx_ring_doorbell);
+	return EOK;
+}
+
 /**
  * Default handler for unknown methods (outside of the NIC interface).
  * Logs a warning message and returns ENOTSUP to the caller.
@@ -47,6 +47,9 @@ typedef struct {
 	pcm_sample_format_t sample_format;
 } pcm_format_t;
 
+/** Mixing kernel, adds a number of samples from source to destination */
+typedef void (*pcm_mix_func_t)(void *, const void *, size_t);
+
 extern const pcm_format_t AUDIO_FORMAT_DEFAULT;
 extern const pcm_format_t AUDIO_FORMAT_ANY;
 
@@ -100,6 +103,8 @@ void pcm_format_silence(void *dst, size_t size, const pcm_format_t *f);
 errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
     size_t src_size, const pcm_format_t *sf, const pcm_format_t *df);
 errno_t pcm_format_mix(void *dst, const void *src, size_t size, const pcm_format_t *f);
+pcm_mix_func_t pcm_format_mix_func(const pcm_format_t *sf,
+    const pcm_format_t *df);
 errno_t pcm_format_convert(pcm_format_t a, void *srca, size_t sizea,
     pcm_format_t b, void *srcb, size_t *sizeb);
 
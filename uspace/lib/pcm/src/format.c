@@ -37,6 +37,7 @@
 #include <byteorder.h>
 #include <errno.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdio.h>
 #include <inttypes.h>
 #include <limits.h>
@@ -136,15 +137,18 @@ do { \
 	case PCM_SAMPLE_SINT32_BE:
 		SET_NULL(int32_t, le, 0);
 		break;
-	case PCM_SAMPLE_UINT24_32_LE:
 	case PCM_SAMPLE_SINT24_32_LE:
-	case PCM_SAMPLE_UINT24_32_BE:
 	case PCM_SAMPLE_SINT24_32_BE:
-	case PCM_SAMPLE_UINT24_LE:
 	case PCM_SAMPLE_SINT24_LE:
-	case PCM_SAMPLE_UINT24_BE:
 	case PCM_SAMPLE_SINT24_BE:
 	case PCM_SAMPLE_FLOAT32:
+		/* Zero is silence in both byte orders and in IEEE 754 */
+		memset(dst, 0, size);
+		break;
+	case PCM_SAMPLE_UINT24_32_LE:
+	case PCM_SAMPLE_UINT24_32_BE:
+	case PCM_SAMPLE_UINT24_LE:
+	case PCM_SAMPLE_UINT24_BE:
 	default:
 		break;
 	}
@@ -190,6 +194,15 @@ errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
 	if ((dst_size % dst_frame_size) != 0)
 		return EINVAL;
 
+	const pcm_mix_func_t mix = pcm_format_mix_func(sf, df);
+	if (mix != NULL) {
+		/* Missing source frames are silence, they leave dst intact */
+		const size_t frames = min(dst_size / dst_frame_size,
+		    src_size / src_frame_size);
+		mix(dst, src, frames * df->channels);
+		return EOK;
+	}
+
 	/*
 	 * This is so ugly it eats kittens, and puppies, and ducklings,
 	 * and all little fluffy things...
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup audio
+ * @{
+ */
+/** @file
+ * Mixing kernels specialized for pairs of sample formats.
+ *
+ * The integer kernels process 128 bits at a time using the compiler's vector
+ * extensions, which map to SSE2 and NEON registers. Saturation is done with
+ * masks so that no instruction set specific builtins are needed.
+ */
+
+#include <macros.h>
+#include <mem.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "format.h"
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define MIX_VECTOR
+#endif
+
+#ifdef __BE__
+#define PCM_SAMPLE_SINT16_NE  PCM_SAMPLE_SINT16_BE
+#define PCM_SAMPLE_SINT24_32_NE  PCM_SAMPLE_SINT24_32_BE
+#else
+#define PCM_SAMPLE_SINT16_NE  PCM_SAMPLE_SINT16_LE
+#define PCM_SAMPLE_SINT24_32_NE  PCM_SAMPLE_SINT24_32_LE
+#endif
+
+#define S24_MIN  (-0x800000)
+#define S24_MAX  0x7fffff
+
+#ifdef MIX_VECTOR
+typedef int16_t v8i16_t __attribute__((vector_size(16)));
+typedef uint16_t v8u16_t __attribute__((vector_size(16)));
+typedef int32_t v4i32_t __attribute__((vector_size(16)));
+#endif
+
+static inline int16_t sat16(int32_t v)
+{
+	if (v > INT16_MAX)
+		return INT16_MAX;
+	if (v < INT16_MIN)
+		return INT16_MIN;
+	return v;
+}
+
+static inline int32_t sat24(int32_t v)
+{
+	if (v > S24_MAX)
+		return S24_MAX;
+	if (v < S24_MIN)
+		return S24_MIN;
+	return v;
+}
+
+static inline float satf(float v)
+{
+	if (v > 1.0f)
+		return 1.0f;
+	if (v < -1.0f)
+		return -1.0f;
+	return v;
+}
+
+/** Sign-extend a 24-bit sample stored in a 32-bit container */
+static inline int32_t sext24(int32_t v)
+{
+	return (int32_t) ((uint32_t) v << 8) >> 8;
+}
+
+static void mix_s16_s16(void *dst, const void *src, size_t count)
+{
+	int16_t *d = dst;
+	const int16_t *s = src;
+	size_t i = 0;
+
+#ifdef MIX_VECTOR
+	const v8i16_t max = {
+		INT16_MAX, INT16_MAX, INT16_MAX, INT16_MAX,
+		INT16_MAX, INT16_MAX, INT16_MAX, INT16_MAX
+	};
+
+	for (; i + 8 <= count; i += 8) {
+		v8i16_t a, b, sum, ovf;
+
+		memcpy(&a, d + i, sizeof(a));
+		memcpy(&b, s + i, sizeof(b));
+
+		/* Wrapping add, overflow if the sign differs from both */
+		sum = (v8i16_t) ((v8u16_t) a + (v8u16_t) b);
+		ovf = ((a ^ sum) & (b ^ sum)) >> 15;
+		/* INT16_MAX for positive a, INT16_MIN for negative a */
+		sum = (sum & ~ovf) | (((a >> 15) ^ max) & ovf);
+
+		memcpy(d + i, &sum, sizeof(sum));
+	}
+#endif
+	for (; i < count; i++)
+		d[i] = sat16((int32_t) d[i] + s[i]);
+}
+
+static void mix_s24_32_s24_32(void *dst, const void *src, size_t count)
+{
+	int32_t *d = dst;
+	const int32_t *s = src;
+	size_t i = 0;
+
+#ifdef MIX_VECTOR
+	const v4i32_t max = { S24_MAX, S24_MAX, S24_MAX, S24_MAX };
+	const v4i32_t min = { S24_MIN, S24_MIN, S24_MIN, S24_MIN };
+
+	for (; i + 4 <= count; i += 4) {
+		v4i32_t a, b, sum, m;
+
+		memcpy(&a, d + i, sizeof(a));
+		memcpy(&b, s + i, sizeof(b));
+
+		/* 25-bit sums cannot overflow */
+		sum = ((a << 8) >> 8) + ((b << 8) >> 8);
+		m = sum > max;
+		sum = (sum & ~m) | (max & m);
+		m = sum < min;
+		sum = (sum & ~m) | (min & m);
+
+		memcpy(d + i, &sum, sizeof(sum));
+	}
+#endif
+	for (; i < count; i++)
+		d[i] = sat24(sext24(d[i]) + sext24(s[i]));
+}
+
+static void mix_s16_s24_32(void *dst, const void *src, size_t count)
+{
+	int32_t *d = dst;
+	const int16_t *s = src;
+
+	for (size_t i = 0; i < count; i++)
+		d[i] = sat24(sext24(d[i]) + ((int32_t) s[i] << 8));
+}
+
+static void mix_s24_32_s16(void *dst, const void *src, size_t count)
+{
+	int16_t *d = dst;
+	const int32_t *s = src;
+
+	for (size_t i = 0; i < count; i++)
+		d[i] = sat16((int32_t) d[i] + (sext24(s[i]) >> 8));
+}
+
+static void mix_s16_float(void *dst, const void *src, size_t count)
+{
+	float *d = dst;
+	const int16_t *s = src;
+
+	for (size_t i = 0; i < count; i++)
+		d[i] = satf(d[i] + s[i] * (1.0f / 32768.0f));
+}
+
+static void mix_float_s16(void *dst, const void *src, size_t count)
+{
+	int16_t *d = dst;
+	const float *s = src;
+
+	for (size_t i = 0; i < count; i++)
+		d[i] = sat16((int32_t) d[i] + (int32_t) (satf(s[i]) * 32767.0f));
+}
+
+static void mix_float_float(void *dst, const void *src, size_t count)
+{
+	float *d = dst;
+	const float *s = src;
+
+	for (size_t i = 0; i < count; i++)
+		d[i] = satf(d[i] + s[i]);
+}
+
+/** Specialized kernels, other pairs use the generic path */
+static const struct {
+	pcm_sample_format_t src;
+	pcm_sample_format_t dst;
+	pcm_mix_func_t mix;
+} mix_kernels[] = {
+	{ PCM_SAMPLE_SINT16_NE, PCM_SAMPLE_SINT16_NE, mix_s16_s16 },
+	{ PCM_SAMPLE_SINT24_32_NE, PCM_SAMPLE_SINT24_32_NE, mix_s24_32_s24_32 },
+	{ PCM_SAMPLE_SINT16_NE, PCM_SAMPLE_SINT24_32_NE, mix_s16_s24_32 },
+	{ PCM_SAMPLE_SINT24_32_NE, PCM_SAMPLE_SINT16_NE, mix_s24_32_s16 },
+	{ PCM_SAMPLE_SINT16_NE, PCM_SAMPLE_FLOAT32, mix_s16_float },
+	{ PCM_SAMPLE_FLOAT32, PCM_SAMPLE_SINT16_NE, mix_float_s16 },
+	{ PCM_SAMPLE_FLOAT32, PCM_SAMPLE_FLOAT32, mix_float_float },
+};
+
+/**
+ * Find a specialized mixing kernel.
+ * @param sf Pointer to the source format descriptor.
+ * @param df Pointer to the destination format descriptor.
+ * @return Kernel adding samples of format @p sf to samples of format @p df,
+ *         NULL if there is none.
+ *
+ * Kernels work on samples, they require both formats to have the same
+ * number of channels.
+ */
+pcm_mix_func_t pcm_format_mix_func(const pcm_format_t *sf,
+    const pcm_format_t *df)
+{
+	if (sf->channels != df->channels)
+		return NULL;
+
+	for (size_t i = 0; i < ARRAY_SIZE(mix_kernels); i++) {
+		if (mix_kernels[i].src == sf->sample_format &&
+		    mix_kernels[i].dst == df->sample_format)
+			return mix_kernels[i].mix;
+	}
+
+	return NULL;
+}
+
+/**
+ * @}
+ */
@@ -96,6 +96,21 @@ void pcut_print_tests(pcut_item_t *first);
 int pcut_is_arg_with_number(const char *arg, const char *opt, int *value);
 
 int pcut_run_test_forking(const char *self_path, pcut_item_t *test);
+
+/** Callback for reporting a test run by pcut_run_tests_forking().
+ *
+ * @param index Index of the test in the array passed in.
+ * @param outcome Outcome of the test.
+ * @param unparsed_output Buffer with all the output from the test.
+ * @param unparsed_output_size Size of @p unparsed_output in bytes.
+ * @param duration_ms Wall-clock duration of the test in milliseconds.
+ */
+typedef void (*pcut_forked_done_func_t)(int index, int outcome,
+		const char *unparsed_output, size_t unparsed_output_size,
+		unsigned long duration_ms);
+
+int pcut_run_tests_forking(const char *self_path, pcut_item_t **tests,
+		int count, int jobs, pcut_forked_done_func_t done);
 int pcut_run_test_forked(pcut_item_t *test);
 int pcut_run_test_single(pcut_item_t *test);
 
@@ -122,6 +137,8 @@ struct pcut_report_ops {
 	/** Test completed. */
 	void (*test_done)(pcut_item_t *, int, const char *, const char *,
 		const char *);
+	/** Wall-clock duration of a completed test in milliseconds. */
+	void (*test_time)(pcut_item_t *, unsigned long);
 };
 
 void pcut_report_register_handler(pcut_report_ops_t *ops);
@@ -135,6 +152,7 @@ void pcut_report_test_done(pcut_item_t *test, int outcome,
 		const char *extra_output);
 void pcut_report_test_done_unparsed(pcut_item_t *test, int outcome,
 		const char *unparsed_output, size_t unparsed_output_size);
+void pcut_report_test_time(pcut_item_t *test, unsigned long duration_ms);
 void pcut_report_done(void);
 
 /* OS-dependent functions. */
@@ -44,6 +44,20 @@
 /** Current running mode. */
 int pcut_run_mode = PCUT_RUN_MODE_FORKING;
 
+#ifdef __helenos__
+/** Number of tests to run concurrently in forking mode. */
+static int pcut_jobs = 1;
+
+/** Tests run by run_all_forking(). */
+static pcut_item_t **forked_tests;
+
+/** Suite of each test in forked_tests. */
+static pcut_item_t **forked_suites;
+
+/** Suite of the last test reported by report_forked_test(). */
+static pcut_item_t *forked_current_suite;
+#endif
+
 /** Empty list to bypass special handling for NULL. */
 static pcut_main_extra_t empty_main_extra[] = {
 	PCUT_MAIN_EXTRA_SET_LAST
@@ -151,6 +165,98 @@ leave_no_print:
 	return ret_code;
 }
 
+#ifdef __helenos__
+/** Report a test completed by pcut_run_tests_forking().
+ *
+ * Tests are reported in order, so suite boundaries can be reported
+ * here as well.
+ *
+ * @param index Index of the test in forked_tests.
+ * @param outcome Outcome of the test.
+ * @param unparsed_output Buffer with all the output from the test.
+ * @param unparsed_output_size Size of @p unparsed_output in bytes.
+ * @param duration_ms Wall-clock duration of the test in milliseconds.
+ */
+static void report_forked_test(int index, int outcome,
+		const char *unparsed_output, size_t unparsed_output_size,
+		unsigned long duration_ms) {
+	pcut_item_t *test = forked_tests[index];
+	pcut_item_t *suite = forked_suites[index];
+
+	if (suite != forked_current_suite) {
+		if (forked_current_suite != NULL) {
+			pcut_report_suite_done(forked_current_suite);
+		}
+		pcut_report_suite_start(suite);
+		forked_current_suite = suite;
+	}
+
+	pcut_report_test_start(test);
+	pcut_report_test_done_unparsed(test, outcome, unparsed_output,
+			unparsed_output_size);
+	pcut_report_test_time(test, duration_ms);
+}
+
+/** Run all tests, each in a new task, pcut_jobs of them at a time.
+ *
+ * @param first First item of the list.
+ * @param prog_path Path to the current binary.
+ * @return Error code.
+ */
+static int run_all_forking(pcut_item_t *first, const char *prog_path) {
+	pcut_item_t *suite = NULL;
+	pcut_item_t *it;
+	int count = 0;
+	int rc;
+
+	for (it = first; it != NULL; it = pcut_get_real_next(it)) {
+		if (it->kind == PCUT_KIND_TESTSUITE) {
+			suite = it;
+		} else if ((it->kind == PCUT_KIND_TEST) && (suite != NULL)) {
+			count++;
+		}
+	}
+
+	if (count == 0) {
+		return PCUT_OUTCOME_PASS;
+	}
+
+	forked_tests = malloc(count * sizeof(pcut_item_t *));
+	forked_suites = malloc(count * sizeof(pcut_item_t *));
+	if ((forked_tests == NULL) || (forked_suites == NULL)) {
+		free(forked_tests);
+		free(forked_suites);
+		return PCUT_OUTCOME_INTERNAL_ERROR;
+	}
+
+	count = 0;
+	suite = NULL;
+	for (it = first; it != NULL; it = pcut_get_real_next(it)) {
+		if (it->kind == PCUT_KIND_TESTSUITE) {
+			suite = it;
+		} else if ((it->kind == PCUT_KIND_TEST) && (suite != NULL)) {
+			forked_tests[count] = it;
+			forked_suites[count] = suite;
+			count++;
+		}
+	}
+
+	forked_current_suite = NULL;
+	rc = pcut_run_tests_forking(prog_path, forked_tests, count, pcut_jobs,
+			report_forked_test);
+	if (forked_current_suite != NULL) {
+		pcut_report_suite_done(forked_current_suite);
+	}
+
+	free(forked_tests);
+	free(forked_suites);
+	forked_tests = NULL;
+	forked_suites = NULL;
+
+	return rc;
+}
+#endif
+
 /** Add direct pointers to set-up/tear-down functions to a suites.
  *
  * At start-up, set-up and tear-down functions are scattered in the
@@ -229,6 +335,10 @@ int pcut_main(pcut_item_t *last, int argc, char *argv[]) {
 			if (pcut_str_equals(argv[i], "-x")) {
 				pcut_report_register_handler(&pcut_report_xml);
 			}
+#ifdef __helenos__
+			pcut_is_arg_with_number(argv[i], "-j", &pcut_jobs);
+			pcut_is_arg_with_number(argv[i], "--jobs=", &pcut_jobs);
+#endif
 #ifndef PCUT_NO_LONG_JUMP
 			if (pcut_str_equals(argv[i], "-u")) {
 				pcut_run_mode = PCUT_RUN_MODE_SINGLE;
@@ -291,6 +401,17 @@ int pcut_main(pcut_item_t *last, int argc, char *argv[]) {
 	/* Otherwise, run the whole thing. */
 	pcut_report_init(items);
 
+#ifdef __helenos__
+	if (pcut_run_mode == PCUT_RUN_MODE_FORKING) {
+		if (pcut_jobs < 1) {
+			pcut_jobs = 1;
+		}
+		rc = run_all_forking(items, argv[0]);
+		pcut_report_done();
+		return rc;
+	}
+#endif
+
 	rc = PCUT_OUTCOME_PASS;
 
 	it = items;
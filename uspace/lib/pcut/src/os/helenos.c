@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <task.h>
 #include <fibril_synch.h>
+#include <time.h>
 #include <vfs/vfs.h>
 #include "../internal.h"
 
@@ -223,6 +224,240 @@ leave_close_tempfile:
 	return status;
 }
 
+/** How many tests may finish ahead of the one being reported, per job. */
+#define FORKED_TESTS_AHEAD_PER_JOB 4
+
+/** A test running as a separate task in pcut_run_tests_forking(). */
+typedef struct {
+	/** The test. */
+	pcut_item_t *test;
+	/** Name of the file capturing output of the test. */
+	char tempfile_name[PCUT_TEMP_FILENAME_BUFFER_SIZE];
+	/** Handle of the output file, -1 if not open. */
+	int tempfile;
+	/** Id of the task running the test. */
+	task_id_t task_id;
+	/** Wait handle for the task. */
+	task_wait_t task_wait;
+	/** Timer killing the task when the test times out. */
+	fibril_timer_t *timer;
+	/** Time when the task was started. */
+	struct timespec start;
+	/** Wall-clock duration of the test in milliseconds. */
+	unsigned long duration_ms;
+	/** Outcome of the test. */
+	int status;
+	/** Whether the task has terminated. */
+	int finished;
+} forked_test_t;
+
+/** Mutex guarding forked_test_t.finished and forked_running. */
+static FIBRIL_MUTEX_INITIALIZE(forked_mutex);
+
+/** Signalled whenever a forked test finishes. */
+static FIBRIL_CONDVAR_INITIALIZE(forked_cv);
+
+/** Number of forked tests currently running. */
+static int forked_running;
+
+/** Kill a forked test that timed out.
+ *
+ * @param arg The test (forked_test_t *).
+ */
+static void forked_test_timeout(void *arg) {
+	forked_test_t *ft = arg;
+
+	task_kill(ft->task_id);
+}
+
+/** Mark a forked test as finished.
+ *
+ * @param ft The test.
+ * @param status Outcome of the test.
+ */
+static void forked_test_finished(forked_test_t *ft, int status) {
+	struct timespec now;
+
+	getuptime(&now);
+
+	fibril_mutex_lock(&forked_mutex);
+	ft->status = status;
+	ft->duration_ms = NSEC2MSEC(ts_sub_diff(&now, &ft->start));
+	ft->finished = 1;
+	forked_running--;
+	fibril_condvar_broadcast(&forked_cv);
+	fibril_mutex_unlock(&forked_mutex);
+}
+
+/** Wait for the task of a forked test to terminate.
+ *
+ * @param arg The test (forked_test_t *).
+ * @return EOK Always.
+ */
+static errno_t forked_test_wait_fibril(void *arg) {
+	forked_test_t *ft = arg;
+	task_exit_t task_exit;
+	int task_retval;
+	int status;
+
+	errno_t rc = task_wait(&ft->task_wait, &task_exit, &task_retval);
+	if (ft->timer != NULL) {
+		fibril_timer_clear(ft->timer);
+	}
+
+	if (rc != EOK) {
+		status = PCUT_OUTCOME_INTERNAL_ERROR;
+	} else if (task_exit == TASK_EXIT_UNEXPECTED) {
+		status = PCUT_OUTCOME_INTERNAL_ERROR;
+	} else {
+		status = task_retval == 0 ? PCUT_OUTCOME_PASS : PCUT_OUTCOME_FAIL;
+	}
+
+	forked_test_finished(ft, status);
+	return EOK;
+}
+
+/** Start a forked test.
+ *
+ * The test is marked as finished once its task terminates (or right
+ * away if it cannot be started).
+ *
+ * @param self_path Path to itself, that is to current binary.
+ * @param ft The test to start.
+ */
+static void forked_test_start(const char *self_path, forked_test_t *ft) {
+	char test_number_argument[MAX_TEST_NUMBER_WIDTH];
+	const char *const arguments[3] = {
+		self_path,
+		test_number_argument,
+		NULL
+	};
+
+	getuptime(&ft->start);
+
+	snprintf(ft->tempfile_name, PCUT_TEMP_FILENAME_BUFFER_SIZE - 1,
+	    "pcut_%llu_%d.tmp", (unsigned long long) task_get_id(),
+	    ft->test->id);
+	errno_t rc = vfs_lookup_open(ft->tempfile_name,
+	    WALK_REGULAR | WALK_MAY_CREATE, MODE_READ | MODE_WRITE,
+	    &ft->tempfile);
+	if (rc != EOK) {
+		ft->tempfile = -1;
+		forked_test_finished(ft, PCUT_OUTCOME_INTERNAL_ERROR);
+		return;
+	}
+
+	snprintf(test_number_argument, MAX_TEST_NUMBER_WIDTH, "-t%d",
+	    ft->test->id);
+
+	rc = task_spawnvf(&ft->task_id, &ft->task_wait, self_path, arguments,
+	    fileno(stdin), ft->tempfile, ft->tempfile);
+	if (rc != EOK) {
+		forked_test_finished(ft, PCUT_OUTCOME_INTERNAL_ERROR);
+		return;
+	}
+
+	ft->timer = fibril_timer_create(NULL);
+	if (ft->timer == NULL) {
+		/* FIXME: somehow announce this problem. */
+		task_kill(ft->task_id);
+	} else {
+		fibril_timer_set(ft->timer,
+		    SEC2USEC(pcut_get_test_timeout(ft->test)),
+		    forked_test_timeout, ft);
+	}
+
+	fid_t wait_fibril = fibril_create(forked_test_wait_fibril, ft);
+	if (wait_fibril == 0) {
+		forked_test_wait_fibril(ft);
+	} else {
+		fibril_add_ready(wait_fibril);
+	}
+}
+
+/** Collect output of a finished forked test and clean up after it.
+ *
+ * @param ft The test.
+ */
+static void forked_test_collect(forked_test_t *ft) {
+	memset(extra_output_buffer, 0, OUTPUT_BUFFER_SIZE);
+
+	if (ft->timer != NULL) {
+		fibril_timer_destroy(ft->timer);
+	}
+
+	if (ft->tempfile >= 0) {
+		aoff64_t pos = 0;
+		size_t nread;
+		vfs_read(ft->tempfile, &pos, extra_output_buffer,
+		    OUTPUT_BUFFER_SIZE - 1, &nread);
+
+		vfs_put(ft->tempfile);
+		vfs_unlink_path(ft->tempfile_name);
+	}
+}
+
+/** Run several tests as new tasks, some of them concurrently.
+ *
+ * Up to @p jobs tests run at the same time, each with its own time-out.
+ * Results are passed to @p done strictly in the order of @p tests.
+ *
+ * @param self_path Path to itself, that is to current binary.
+ * @param tests Tests to be run.
+ * @param count Number of tests in @p tests.
+ * @param jobs Maximum number of tests to run at the same time.
+ * @param done Callback reporting each completed test.
+ * @return Error status (zero means all tests passed).
+ */
+int pcut_run_tests_forking(const char *self_path, pcut_item_t **tests,
+		int count, int jobs, pcut_forked_done_func_t done) {
+	int ahead = jobs * FORKED_TESTS_AHEAD_PER_JOB;
+	int started = 0;
+	int reported = 0;
+	int rc = PCUT_OUTCOME_PASS;
+
+	forked_test_t *fts = calloc(count, sizeof(forked_test_t));
+	if (fts == NULL) {
+		return PCUT_OUTCOME_INTERNAL_ERROR;
+	}
+
+	fibril_mutex_lock(&forked_mutex);
+	while (reported < count) {
+		if ((started < count) && (forked_running < jobs) &&
+		    (started - reported < ahead)) {
+			forked_test_t *ft = &fts[started++];
+			ft->test = tests[started - 1];
+			forked_running++;
+
+			fibril_mutex_unlock(&forked_mutex);
+			forked_test_start(self_path, ft);
+			fibril_mutex_lock(&forked_mutex);
+			continue;
+		}
+
+		forked_test_t *ft = &fts[reported];
+		if (!ft->finished) {
+			fibril_condvar_wait(&forked_cv, &forked_mutex);
+			continue;
+		}
+
+		fibril_mutex_unlock(&forked_mutex);
+		forked_test_collect(ft);
+		done(reported, ft->status, extra_output_buffer,
+		    OUTPUT_BUFFER_SIZE, ft->duration_ms);
+		fibril_mutex_lock(&forked_mutex);
+
+		if (ft->status != PCUT_OUTCOME_PASS) {
+			rc = PCUT_OUTCOME_FAIL;
+		}
+		reported++;
+	}
+	fibril_mutex_unlock(&forked_mutex);
+
+	free(fts);
+	return rc;
+}
+
 void pcut_hook_before_test(pcut_item_t *test) {
 	PCUT_UNUSED(test);
 
@@ -228,6 +228,15 @@ void pcut_report_test_done_unparsed(pcut_item_t *test, int outcome,
 	pcut_report_test_done(test, outcome, buffer_for_error_messages, NULL, buffer_for_extra_output);
 }
 
+/** Report how long a completed test took.
+ *
+ * @param test Test that just finished.
+ * @param duration_ms Wall-clock duration of the test in milliseconds.
+ */
+void pcut_report_test_time(pcut_item_t *test, unsigned long duration_ms) {
+	REPORT_CALL(test_time, test, duration_ms);
+}
+
 /** Close the report.
  *
  */
@@ -186,6 +186,17 @@ static void tap_test_done(pcut_item_t *test, int outcome,
 	}
 }
 
+/** Report duration of a completed test.
+ *
+ * @param test Test that just finished.
+ * @param duration_ms Wall-clock duration of the test in milliseconds.
+ */
+static void tap_test_time(pcut_item_t *test, unsigned long duration_ms) {
+	PCUT_UNUSED(test);
+
+	printf("# time: %lu ms\n", duration_ms);
+}
+
 /** Report testing done. */
 static void tap_done(void) {
 	if (failed_test_counter == 0) {
@@ -200,5 +211,6 @@ static void tap_done(void) {
 pcut_report_ops_t pcut_report_tap = {
 	tap_init, tap_done,
 	tap_suite_start, tap_suite_done,
-	tap_test_start, tap_test_done
+	tap_test_start, tap_test_done,
+	tap_test_time
 };
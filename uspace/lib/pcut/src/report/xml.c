@@ -177,5 +177,6 @@ static void xml_done(void) {
 pcut_report_ops_t pcut_report_xml = {
 	xml_init, xml_done,
 	xml_suite_start, xml_suite_done,
-	xml_test_start, xml_test_done
+	xml_test_start, xml_test_done,
+	NULL
 };
@@ -40,9 +40,17 @@
  * with respect to their names.
  */
 
+#include <assert.h>
 #include <byteorder.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <mem.h>
 #include "pixconv.h"
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define PIXCONV_VECTOR
+#endif
+
 void pixel2argb_8888(void *dst, pixel_t pix)
 {
 	*((uint32_t *) dst) = host2uint32_t_be(
@@ -283,5 +291,234 @@ pixel_t gray_8_2pixel(void *src)
 	return (0xff000000 | (val << 16) | (val << 8) | (val));
 }
 
+/*
+ * Row converters
+ *
+ * The packing expressions below are written so that they are valid both
+ * for a scalar uint32_t and for a GCC vector of four uint32_t lanes. The
+ * vector loop converts four pixels per iteration (this maps to SSE2 or
+ * NEON registers), the scalar per-pixel converter handles the tail.
+ */
+
+#define BSWAP32(v) \
+	((((v) >> 24) & 0xff) | (((v) >> 8) & 0xff00) | \
+	(((v) & 0xff00) << 8) | ((v) << 24))
+#define BSWAP16(v) ((((v) >> 8) & 0xff) | (((v) & 0xff) << 8))
+
+#define PACK_ARGB_8888(v) (v)
+#define PACK_ABGR_8888(v) \
+	(((v) & 0xff00ff00) | (((v) >> 16) & 0xff) | (((v) & 0xff) << 16))
+#define PACK_RGBA_8888(v) (((v) << 8) | (((v) >> 24) & 0xff))
+#define PACK_BGRA_8888(v) BSWAP32(v)
+#define PACK_RGB_0888(v) ((v) & 0xffffff)
+#define PACK_BGR_0888(v) \
+	((((v) & 0xff) << 16) | ((v) & 0xff00) | (((v) >> 16) & 0xff))
+#define PACK_RGB_8880(v) ((v) << 8)
+#define PACK_BGR_8880(v) \
+	((((v) & 0xff) << 24) | (((v) & 0xff00) << 8) | (((v) >> 8) & 0xff00))
+#define PACK_RGB_555(v) \
+	((((v) >> 9) & 0x7c00) | (((v) >> 6) & 0x3e0) | (((v) >> 3) & 0x1f))
+#define PACK_RGB_565(v) \
+	((((v) >> 8) & 0xf800) | (((v) >> 5) & 0x7e0) | (((v) >> 3) & 0x1f))
+
+#ifdef __LE__
+#define STORE32_BE(v) BSWAP32(v)
+#define STORE16_BE(v) BSWAP16(v)
+#define STORE16_LE(v) (v)
+#else
+#define STORE32_BE(v) (v)
+#define STORE16_BE(v) (v)
+#define STORE16_LE(v) BSWAP16(v)
+#endif
+
+#ifdef PIXCONV_VECTOR
+typedef uint32_t v4u32_t __attribute__((vector_size(16)));
+
+/** Define a row converter into a 32-bit visual. */
+#define PIXCONV_ROW_32(name, pack) \
+	void name##_row(void *dst, const pixel_t *src, size_t n) \
+	{ \
+		uint8_t *d = (uint8_t *) dst; \
+		v4u32_t v; \
+		size_t i; \
+\
+		for (i = 0; i + 4 <= n; i += 4) { \
+			memcpy(&v, src + i, sizeof(v)); \
+			v = STORE32_BE(pack(v)); \
+			memcpy(d + 4 * i, &v, sizeof(v)); \
+		} \
+\
+		for (; i < n; i++) \
+			name(d + 4 * i, src[i]); \
+	}
+
+/** Define a row converter into a 16-bit visual. */
+#define PIXCONV_ROW_16(name, pack, store) \
+	void name##_row(void *dst, const pixel_t *src, size_t n) \
+	{ \
+		uint8_t *d = (uint8_t *) dst; \
+		uint16_t h[4]; \
+		v4u32_t v; \
+		size_t i; \
+\
+		for (i = 0; i + 4 <= n; i += 4) { \
+			memcpy(&v, src + i, sizeof(v)); \
+			v = store(pack(v)); \
+			h[0] = v[0]; \
+			h[1] = v[1]; \
+			h[2] = v[2]; \
+			h[3] = v[3]; \
+			memcpy(d + 2 * i, h, sizeof(h)); \
+		} \
+\
+		for (; i < n; i++) \
+			name(d + 2 * i, src[i]); \
+	}
+#else
+#define PIXCONV_ROW_32(name, pack) PIXCONV_ROW(name, 4)
+#define PIXCONV_ROW_16(name, pack, store) PIXCONV_ROW(name, 2)
+#endif
+
+/** Define a row converter using the per-pixel converter only. */
+#define PIXCONV_ROW(name, bytes) \
+	void name##_row(void *dst, const pixel_t *src, size_t n) \
+	{ \
+		uint8_t *d = (uint8_t *) dst; \
+		size_t i; \
+\
+		for (i = 0; i < n; i++) \
+			name(d + (bytes) * i, src[i]); \
+	}
+
+PIXCONV_ROW_32(pixel2argb_8888, PACK_ARGB_8888)
+PIXCONV_ROW_32(pixel2abgr_8888, PACK_ABGR_8888)
+PIXCONV_ROW_32(pixel2rgba_8888, PACK_RGBA_8888)
+PIXCONV_ROW_32(pixel2bgra_8888, PACK_BGRA_8888)
+PIXCONV_ROW_32(pixel2rgb_0888, PACK_RGB_0888)
+PIXCONV_ROW_32(pixel2bgr_0888, PACK_BGR_0888)
+PIXCONV_ROW_32(pixel2rgb_8880, PACK_RGB_8880)
+PIXCONV_ROW_32(pixel2bgr_8880, PACK_BGR_8880)
+PIXCONV_ROW(pixel2rgb_888, 3)
+PIXCONV_ROW(pixel2bgr_888, 3)
+PIXCONV_ROW_16(pixel2rgb_555_be, PACK_RGB_555, STORE16_BE)
+PIXCONV_ROW_16(pixel2rgb_555_le, PACK_RGB_555, STORE16_LE)
+PIXCONV_ROW_16(pixel2rgb_565_be, PACK_RGB_565, STORE16_BE)
+PIXCONV_ROW_16(pixel2rgb_565_le, PACK_RGB_565, STORE16_LE)
+PIXCONV_ROW(pixel2bgr_323, 1)
+PIXCONV_ROW(pixel2gray_8, 1)
+
+/** Get row converter for a visual.
+ *
+ * @param visual Visual
+ * @return Row converter or @c NULL if @a visual is not supported
+ */
+pixel2visual_row_t pixconv_row_func(visual_t visual)
+{
+	switch (visual) {
+	case VISUAL_INDIRECT_8:
+		return pixel2bgr_323_row;
+	case VISUAL_RGB_5_5_5_LE:
+		return pixel2rgb_555_le_row;
+	case VISUAL_RGB_5_5_5_BE:
+		return pixel2rgb_555_be_row;
+	case VISUAL_RGB_5_6_5_LE:
+		return pixel2rgb_565_le_row;
+	case VISUAL_RGB_5_6_5_BE:
+		return pixel2rgb_565_be_row;
+	case VISUAL_BGR_8_8_8:
+		return pixel2bgr_888_row;
+	case VISUAL_BGR_0_8_8_8:
+		return pixel2bgr_0888_row;
+	case VISUAL_BGR_8_8_8_0:
+		return pixel2bgr_8880_row;
+	case VISUAL_ABGR_8_8_8_8:
+		return pixel2abgr_8888_row;
+	case VISUAL_BGRA_8_8_8_8:
+		return pixel2bgra_8888_row;
+	case VISUAL_RGB_8_8_8:
+		return pixel2rgb_888_row;
+	case VISUAL_RGB_0_8_8_8:
+		return pixel2rgb_0888_row;
+	case VISUAL_RGB_8_8_8_0:
+		return pixel2rgb_8880_row;
+	case VISUAL_ARGB_8_8_8_8:
+		return pixel2argb_8888_row;
+	case VISUAL_RGBA_8_8_8_8:
+		return pixel2rgba_8888_row;
+	default:
+		return NULL;
+	}
+}
+
+/** Convert a row of pixels to a visual.
+ *
+ * @param dst    Destination
+ * @param src    Source pixels
+ * @param n      Number of pixels
+ * @param visual Destination visual (must be supported)
+ */
+void pixconv_row(void *dst, const pixel_t *src, size_t n, visual_t visual)
+{
+	pixel2visual_row_t row = pixconv_row_func(visual);
+
+	assert(row != NULL);
+	row(dst, src, n);
+}
+
+/** Convert a rectangle of pixels to a visual.
+ *
+ * @param dst    Destination
+ * @param dpitch Destination scanline length in bytes
+ * @param src    Source pixels
+ * @param spitch Source scanline length in pixels
+ * @param width  Rectangle width in pixels
+ * @param height Rectangle height in pixels
+ * @param visual Destination visual (must be supported)
+ */
+void pixconv_rect(void *dst, size_t dpitch, const pixel_t *src,
+    size_t spitch, size_t width, size_t height, visual_t visual)
+{
+	pixel2visual_row_t row = pixconv_row_func(visual);
+	uint8_t *d = (uint8_t *) dst;
+	size_t y;
+
+	assert(row != NULL);
+	for (y = 0; y < height; y++)
+		row(d + y * dpitch, src + y * spitch, width);
+}
+
+/** Convert a row of BGR 8:8:8 pixels to pixel_t.
+ *
+ * @param dst Destination pixels
+ * @param src Source row
+ * @param n Number of pixels
+ */
+void bgr_888_2pixel_row(pixel_t *dst, const void *src, size_t n)
+{
+	const uint8_t *s = (const uint8_t *) src;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		dst[i] = 0xff000000 | ((uint32_t) s[2] << 16) |
+		    ((uint32_t) s[1] << 8) | s[0];
+		s += 3;
+	}
+}
+
+/** Convert a row of 8-bit gray pixels to pixel_t.
+ *
+ * @param dst Destination pixels
+ * @param src Source row
+ * @param n Number of pixels
+ */
+void gray_8_2pixel_row(pixel_t *dst, const void *src, size_t n)
+{
+	const uint8_t *s = (const uint8_t *) src;
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = 0xff000000 | ((uint32_t) s[i] * 0x010101);
+}
+
 /** @}
  */
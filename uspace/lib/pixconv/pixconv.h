@@ -37,18 +37,26 @@
 #ifndef SOFTREND_PIXCONV_H_
 #define SOFTREND_PIXCONV_H_
 
+#include <abi/fb/visuals.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <io/pixel.h>
 
 /** Function to render a pixel. */
 typedef void (*pixel2visual_t)(void *, pixel_t);
 
+/** Function to render a row of pixels. */
+typedef void (*pixel2visual_row_t)(void *, const pixel_t *, size_t);
+
 /** Function to render a bit mask. */
 typedef void (*visual_mask_t)(void *, bool);
 
 /** Function to retrieve a pixel. */
 typedef pixel_t (*visual2pixel_t)(void *);
 
+/** Function to retrieve a row of pixels. */
+typedef void (*visual2pixel_row_t)(pixel_t *, const void *, size_t);
+
 extern void pixel2argb_8888(void *, pixel_t);
 extern void pixel2abgr_8888(void *, pixel_t);
 extern void pixel2rgba_8888(void *, pixel_t);
@@ -66,6 +74,28 @@ extern void pixel2rgb_565_le(void *, pixel_t);
 extern void pixel2bgr_323(void *, pixel_t);
 extern void pixel2gray_8(void *, pixel_t);
 
+extern void pixel2argb_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2abgr_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgba_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2bgra_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_0888_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_0888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_8880_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_8880_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_888_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_555_be_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_555_le_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_565_be_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_565_le_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_323_row(void *, const pixel_t *, size_t);
+extern void pixel2gray_8_row(void *, const pixel_t *, size_t);
+
+extern pixel2visual_row_t pixconv_row_func(visual_t);
+extern void pixconv_row(void *, const pixel_t *, size_t, visual_t);
+extern void pixconv_rect(void *, size_t, const pixel_t *, size_t, size_t,
+    size_t, visual_t);
+
 extern void visual_mask_8888(void *, bool);
 extern void visual_mask_0888(void *, bool);
 extern void visual_mask_8880(void *, bool);
@@ -92,6 +122,9 @@ extern pixel_t rgb_565_le_2pixel(void *);
 extern pixel_t bgr_323_2pixel(void *);
 extern pixel_t gray_8_2pixel(void *);
 
+extern void bgr_888_2pixel_row(pixel_t *, const void *, size_t);
+extern void gray_8_2pixel_row(pixel_t *, const void *, size_t);
+
 #endif
 
 /** @}
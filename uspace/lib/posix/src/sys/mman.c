@@ -35,9 +35,31 @@
 #include "../internal/common.h"
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <align.h>
 #include <as.h>
+#include <async.h>
+#include <fibril_synch.h>
+#include <ipc/services.h>
+#include <ipc/vfs.h>
+#include <ns.h>
 #include <unistd.h>
 
+/** Session with the VFS pager, backing file mappings. */
+static async_sess_t *_pager_sess;
+static FIBRIL_MUTEX_INITIALIZE(_pager_mutex);
+
+static async_sess_t *_pager_get(void)
+{
+	fibril_mutex_lock(&_pager_mutex);
+	if (_pager_sess == NULL) {
+		_pager_sess = service_connect_blocking(SERVICE_VFS,
+		    INTERFACE_PAGER, 0, NULL);
+	}
+	fibril_mutex_unlock(&_pager_mutex);
+
+	return _pager_sess;
+}
+
 static int _prot_to_as(int prot)
 {
 	int ret = 0;
@@ -65,10 +87,52 @@ void *mmap(void *start, size_t length, int prot, int flags, int fd,
 		return MAP_FAILED;
 #endif
 
-	if (!(flags & MAP_ANONYMOUS))
+	if (flags & MAP_ANONYMOUS)
+		return as_area_create(start, length, _prot_to_as(prot),
+		    AS_AREA_UNPAGED);
+
+	if (offset < 0 || ALIGN_DOWN(offset, PAGE_SIZE) != offset) {
+		errno = EINVAL;
+		return MAP_FAILED;
+	}
+
+	/*
+	 * Shared mappings map the frames of the VFS page cache. Writable ones
+	 * are written back on msync() and munmap().
+	 */
+	sysarg_t pager_flags = 0;
+	if (flags & MAP_SHARED) {
+		pager_flags = (prot & PROT_WRITE) ? VFS_PAGER_WRITEBACK :
+		    VFS_PAGER_SHARED;
+	}
+
+	async_sess_t *sess = _pager_get();
+	if (sess == NULL) {
+		errno = ENOENT;
 		return MAP_FAILED;
+	}
+
+	void *area = async_as_area_create(start, length,
+	    _prot_to_as(prot) | AS_AREA_CACHEABLE, sess, fd, pager_flags,
+	    offset);
+	if (area == AS_MAP_FAILED)
+		errno = ENOMEM;
 
-	return as_area_create(start, length, _prot_to_as(prot), AS_AREA_UNPAGED);
+	return area;
+}
+
+int msync(void *start, size_t length, int flags)
+{
+	/*
+	 * Write back is always synchronous and shared mappings use the page
+	 * cache, so there is nothing to invalidate.
+	 */
+	int rc = as_area_sync(start, length);
+	if (rc != EOK) {
+		errno = rc;
+		return -1;
+	}
+	return 0;
 }
 
 int munmap(void *start, size_t length)
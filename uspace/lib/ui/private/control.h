@@ -37,6 +37,7 @@
 #ifndef _UI_PRIVATE_CONTROL_H
 #define _UI_PRIVATE_CONTROL_H
 
+#include <adt/list.h>
 #include <gfx/coord.h>
 #include <stdbool.h>
 
@@ -54,6 +55,8 @@ struct ui_control {
 	struct ui_control_ops *ops;
 	/** Extended data */
 	void *ext;
+	/** Link to @c ui_window_t.inval_ctls if control needs repainting */
+	link_t linval;
 };
 
 #endif
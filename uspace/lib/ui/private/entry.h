@@ -99,6 +99,7 @@ extern void ui_entry_get_geom(ui_entry_t *, ui_entry_geom_t *);
 extern size_t ui_entry_find_pos(ui_entry_t *, gfx_coord2_t *);
 extern void ui_entry_delete_sel(ui_entry_t *);
 extern void ui_entry_scroll_update(ui_entry_t *, bool);
+extern void ui_entry_invalidate(ui_entry_t *);
 
 #endif
 
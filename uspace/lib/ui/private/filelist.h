@@ -129,6 +129,7 @@ typedef struct ui_file_list {
 extern gfx_coord_t ui_file_list_entry_height(ui_file_list_t *);
 extern errno_t ui_file_list_entry_paint(ui_file_list_entry_t *, size_t);
 extern errno_t ui_file_list_paint(ui_file_list_t *);
+extern void ui_file_list_invalidate(ui_file_list_t *);
 extern ui_evclaim_t ui_file_list_kbd_event(ui_file_list_t *, kbd_event_t *);
 extern ui_evclaim_t ui_file_list_pos_event(ui_file_list_t *, pos_event_t *);
 extern unsigned ui_file_list_page_size(ui_file_list_t *);
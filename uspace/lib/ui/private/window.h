@@ -42,10 +42,12 @@
 #include <congfx/console.h>
 #include <display.h>
 #include <gfx/context.h>
+#include <gfx/region.h>
 #include <io/kbd_event.h>
 #include <io/pos_event.h>
 #include <memgfx/memgc.h>
 #include <memgfx/xlategc.h>
+#include <types/ui/control.h>
 #include <types/ui/cursor.h>
 #include <types/ui/window.h>
 
@@ -86,8 +88,12 @@ struct ui_window {
 	mem_gc_t *app_mgc;
 	/** Application area GC */
 	gfx_context_t *app_gc;
-	/** Dirty rectangle */
-	gfx_rect_t dirty_rect;
+	/** Dirty region (if client-side rendering) */
+	gfx_region_t dirty;
+	/** Update of the dirty region has been deferred */
+	bool update_pending;
+	/** Controls waiting to be repainted (ui_control_t) */
+	list_t inval_ctls;
 	/** UI resource. Ideally this would be in ui_t. */
 	struct ui_resource *res;
 	/** Window decoration */
@@ -121,6 +127,8 @@ extern void ui_window_send_pos(ui_window_t *, pos_event_t *);
 extern void ui_window_send_unfocus(ui_window_t *);
 extern errno_t ui_window_size_change(ui_window_t *, gfx_rect_t *,
     ui_wnd_sc_op_t);
+extern void ui_window_invalidate_ctl(ui_window_t *, ui_control_t *);
+extern void ui_window_flush(ui_window_t *);
 
 #endif
 
@@ -58,6 +58,7 @@ errno_t ui_control_new(ui_control_ops_t *ops, void *ext,
 
 	control->ops = ops;
 	control->ext = ext;
+	link_initialize(&control->linval);
 	*rcontrol = control;
 	return EOK;
 }
@@ -73,6 +74,10 @@ void ui_control_delete(ui_control_t *control)
 	if (control == NULL)
 		return;
 
+	/* Drop pending repaint */
+	if (link_in_use(&control->linval))
+		list_remove(&control->linval);
+
 	free(control);
 }
 
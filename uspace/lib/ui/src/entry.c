@@ -52,6 +52,7 @@
 #include <ui/window.h>
 #include "../private/entry.h"
 #include "../private/resource.h"
+#include "../private/window.h"
 
 static void ui_entry_ctl_destroy(void *);
 static errno_t ui_entry_ctl_paint(void *);
@@ -158,7 +159,7 @@ void ui_entry_set_halign(ui_entry_t *entry, gfx_halign_t halign)
 {
 	entry->halign = halign;
 	ui_entry_scroll_update(entry, true);
-	ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Set text entry read-only flag.
@@ -191,7 +192,7 @@ errno_t ui_entry_set_text(ui_entry_t *entry, const char *text)
 	entry->sel_start = entry->pos;
 
 	ui_entry_scroll_update(entry, false);
-	ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 
 	return EOK;
 }
@@ -403,6 +404,18 @@ error:
 	return rc;
 }
 
+/** Request repainting text entry.
+ *
+ * The entry is repainted once the current event has been handled
+ * (or immediately if the UI is not locked).
+ *
+ * @param entry Text entry
+ */
+void ui_entry_invalidate(ui_entry_t *entry)
+{
+	ui_window_invalidate_ctl(entry->window, entry->control);
+}
+
 /** Find position in text entry.
  *
  * @param entry Text entry
@@ -468,7 +481,7 @@ void ui_entry_delete_sel(ui_entry_t *entry)
 	entry->pos = off1;
 	entry->sel_start = off1;
 	ui_entry_scroll_update(entry, false);
-	ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Insert string at cursor position.
@@ -511,7 +524,7 @@ errno_t ui_entry_insert_str(ui_entry_t *entry, const char *str)
 
 	entry->sel_start = entry->pos;
 	ui_entry_scroll_update(entry, false);
-	ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 
 	return EOK;
 }
@@ -544,7 +557,7 @@ void ui_entry_backspace(ui_entry_t *entry)
 	entry->sel_start = off;
 
 	ui_entry_scroll_update(entry, false);
-	ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Delete character after cursor.
@@ -570,7 +583,7 @@ void ui_entry_delete(ui_entry_t *entry)
 	    str_size(entry->text + off) + 1);
 
 	ui_entry_scroll_update(entry, false);
-	ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Copy selected text to clipboard.
@@ -823,7 +836,7 @@ ui_evclaim_t ui_entry_pos_event(ui_entry_t *entry, pos_event_t *event)
 			 * keep sel_start
 			 */
 			entry->pos = ui_entry_find_pos(entry, &pos);
-			ui_entry_paint(entry);
+			ui_entry_invalidate(entry);
 		}
 	}
 
@@ -841,7 +854,7 @@ ui_evclaim_t ui_entry_pos_event(ui_entry_t *entry, pos_event_t *event)
 				entry->sel_start = entry->pos;
 
 			if (entry->active)
-				ui_entry_paint(entry);
+				ui_entry_invalidate(entry);
 			else
 				ui_entry_activate(entry);
 
@@ -951,7 +964,7 @@ void ui_entry_activate(ui_entry_t *entry)
 		return;
 
 	entry->active = true;
-	(void) ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 
 	if (res->textmode)
 		gfx_cursor_set_visible(res->gc, true);
@@ -970,7 +983,7 @@ void ui_entry_seek_start(ui_entry_t *entry, bool shift)
 		entry->sel_start = entry->pos;
 
 	ui_entry_scroll_update(entry, false);
-	(void) ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Move text cursor to the end of text.
@@ -986,7 +999,7 @@ void ui_entry_seek_end(ui_entry_t *entry, bool shift)
 		entry->sel_start = entry->pos;
 
 	ui_entry_scroll_update(entry, false);
-	(void) ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Move text cursor one character backward.
@@ -1007,7 +1020,7 @@ void ui_entry_seek_prev_char(ui_entry_t *entry, bool shift)
 		entry->sel_start = entry->pos;
 
 	ui_entry_scroll_update(entry, false);
-	(void) ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Move text cursor one character forward.
@@ -1028,7 +1041,7 @@ void ui_entry_seek_next_char(ui_entry_t *entry, bool shift)
 		entry->sel_start = entry->pos;
 
 	ui_entry_scroll_update(entry, false);
-	(void) ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 }
 
 /** Deactivate text entry.
@@ -1046,7 +1059,7 @@ void ui_entry_deactivate(ui_entry_t *entry)
 
 	entry->active = false;
 	entry->sel_start = entry->pos;
-	(void) ui_entry_paint(entry);
+	ui_entry_invalidate(entry);
 
 	if (res->textmode)
 		gfx_cursor_set_visible(res->gc, false);
@@ -49,6 +49,7 @@
 #include <qsort.h>
 #include "../private/filelist.h"
 #include "../private/resource.h"
+#include "../private/window.h"
 
 static void ui_file_list_ctl_destroy(void *);
 static errno_t ui_file_list_ctl_paint(void *);
@@ -622,6 +623,18 @@ bool ui_file_list_is_active(ui_file_list_t *flist)
 	return flist->active;
 }
 
+/** Request repainting file list.
+ *
+ * The list is repainted once the current event has been handled
+ * (or immediately if the UI is not locked).
+ *
+ * @param flist File list
+ */
+void ui_file_list_invalidate(ui_file_list_t *flist)
+{
+	ui_window_invalidate_ctl(flist->window, flist->control);
+}
+
 /** Activate file list.
  *
  * @param flist File list
@@ -639,7 +652,7 @@ errno_t ui_file_list_activate(ui_file_list_t *flist)
 	}
 
 	flist->active = true;
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 	return EOK;
 }
 
@@ -650,7 +663,7 @@ errno_t ui_file_list_activate(ui_file_list_t *flist)
 void ui_file_list_deactivate(ui_file_list_t *flist)
 {
 	flist->active = false;
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 }
 
 /** Initialize file list entry attributes.
@@ -1154,7 +1167,7 @@ void ui_file_list_cursor_move(ui_file_list_t *flist,
 		}
 
 		ui_file_list_scrollbar_update(flist);
-		(void) ui_file_list_paint(flist);
+		ui_file_list_invalidate(flist);
 	}
 }
 
@@ -1249,7 +1262,7 @@ void ui_file_list_page_up(ui_file_list_t *flist)
 	if (flist->page != old_page) {
 		/* We have scrolled. Need to repaint all entries */
 		ui_file_list_scrollbar_update(flist);
-		(void) ui_file_list_paint(flist);
+		ui_file_list_invalidate(flist);
 	} else if (flist->cursor != old_cursor) {
 		/* No scrolling, but cursor has moved */
 		ui_file_list_entry_paint(old_cursor, old_idx);
@@ -1308,7 +1321,7 @@ void ui_file_list_page_down(ui_file_list_t *flist)
 	if (flist->page != old_page) {
 		/* We have scrolled. Need to repaint all entries */
 		ui_file_list_scrollbar_update(flist);
-		(void) ui_file_list_paint(flist);
+		ui_file_list_invalidate(flist);
 	} else if (flist->cursor != old_cursor) {
 		/* No scrolling, but cursor has moved */
 		ui_file_list_entry_paint(old_cursor, old_idx);
@@ -1335,7 +1348,7 @@ void ui_file_list_scroll_up(ui_file_list_t *flist)
 	--flist->page_idx;
 
 	ui_file_list_scrollbar_update(flist);
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 }
 
 /** Scroll one entry down.
@@ -1368,7 +1381,7 @@ void ui_file_list_scroll_down(ui_file_list_t *flist)
 	}
 
 	ui_file_list_scrollbar_update(flist);
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 }
 
 /** Scroll one page up.
@@ -1395,7 +1408,7 @@ void ui_file_list_scroll_page_up(ui_file_list_t *flist)
 	}
 
 	ui_file_list_scrollbar_update(flist);
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 }
 
 /** Scroll one page down.
@@ -1430,7 +1443,7 @@ void ui_file_list_scroll_page_down(ui_file_list_t *flist)
 	}
 
 	ui_file_list_scrollbar_update(flist);
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 }
 
 /** Scroll to a specific entry
@@ -1452,7 +1465,7 @@ void ui_file_list_scroll_pos(ui_file_list_t *flist, size_t page_idx)
 	flist->page = entry;
 	flist->page_idx = page_idx;
 
-	(void) ui_file_list_paint(flist);
+	ui_file_list_invalidate(flist);
 }
 
 /** Open file list entry.
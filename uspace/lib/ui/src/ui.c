@@ -323,7 +323,9 @@ void ui_run(ui_t *ui)
 
 			/* Do we actually have an event? */
 			if (rc == EOK) {
+				ui_lock(ui);
 				ui_cons_event_process(ui, &event);
+				ui_unlock(ui);
 			} else if (rc != ETIMEOUT) {
 				/* Error, quit */
 				break;
@@ -479,10 +481,16 @@ void ui_lock(ui_t *ui)
  * must be used when accessing window resources from a fibril (as opposed to
  * from a window callback).
  *
+ * Controls invalidated and window updates requested while the UI was
+ * locked are painted and sent to the display now.
+ *
  * @param ui UI
  */
 void ui_unlock(ui_t *ui)
 {
+	list_foreach(ui->windows, lwindows, ui_window_t, window)
+		ui_window_flush(window);
+
 	fibril_mutex_unlock(&ui->lock);
 }
 
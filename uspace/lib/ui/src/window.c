@@ -39,6 +39,7 @@
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
 #include <gfx/cursor.h>
+#include <gfx/region.h>
 #include <gfx/render.h>
 #include <io/kbd_event.h>
 #include <io/pos_event.h>
@@ -218,6 +219,8 @@ errno_t ui_window_create(ui_t *ui, ui_wnd_params_t *params,
 		return ENOMEM;
 
 	window->ui = ui;
+	gfx_region_init(&window->dirty);
+	list_initialize(&window->inval_ctls);
 
 	display_wnd_params_init(&dparams);
 	dparams.rect = params->rect;
@@ -378,6 +381,7 @@ error:
 		gfx_bitmap_destroy(bmp);
 	if (dgc != NULL)
 		dummygc_destroy(dgc);
+	gfx_region_fini(&window->dirty);
 	free(window);
 	return rc;
 }
@@ -389,6 +393,7 @@ error:
 void ui_window_destroy(ui_window_t *window)
 {
 	ui_t *ui;
+	link_t *link;
 
 	if (window == NULL)
 		return;
@@ -396,6 +401,10 @@ void ui_window_destroy(ui_window_t *window)
 	ui = window->ui;
 
 	list_remove(&window->lwindows);
+
+	/* Drop pending repaints */
+	while ((link = list_first(&window->inval_ctls)) != NULL)
+		list_remove(link);
 	ui_control_destroy(window->control);
 	ui_wdecor_destroy(window->wdecor);
 	ui_resource_destroy(window->res);
@@ -422,6 +431,7 @@ void ui_window_destroy(ui_window_t *window)
 		(void) console_set_caption(ui->console, "");
 	}
 
+	gfx_region_fini(&window->dirty);
 	free(window);
 }
 
@@ -1229,6 +1239,66 @@ void ui_window_def_unfocus(ui_window_t *window)
 		ui_control_unfocus(window->control);
 }
 
+/** Request repainting a control.
+ *
+ * The control is painted when the UI is unlocked. This way any number of
+ * state changes made while handling a single event result in a single
+ * repaint of each affected control (and nothing else). If the UI is not
+ * locked, the control is painted immediately.
+ *
+ * @param window Window containing the control
+ * @param control Control
+ */
+void ui_window_invalidate_ctl(ui_window_t *window, ui_control_t *control)
+{
+	if (!link_in_use(&control->linval))
+		list_append(&control->linval, &window->inval_ctls);
+
+	if (!fibril_mutex_is_locked(&window->ui->lock))
+		ui_window_flush(window);
+}
+
+/** Render dirty region of the window bitmap to the real GC.
+ *
+ * @param window Window
+ */
+static void ui_window_render_dirty(ui_window_t *window)
+{
+	gfx_rect_t *rect;
+
+	window->update_pending = false;
+	if (gfx_region_is_empty(&window->dirty))
+		return;
+
+	rect = gfx_region_first(&window->dirty);
+	while (rect != NULL) {
+		(void) gfx_bitmap_render(window->bmp, rect, &window->dpos);
+		rect = gfx_region_next(&window->dirty, rect);
+	}
+
+	(void) gfx_update(window->realgc);
+	gfx_region_clear(&window->dirty);
+}
+
+/** Paint invalidated controls and carry out deferred update.
+ *
+ * @param window Window
+ */
+void ui_window_flush(ui_window_t *window)
+{
+	ui_control_t *control;
+	link_t *link;
+
+	while ((link = list_first(&window->inval_ctls)) != NULL) {
+		control = list_get_instance(link, ui_control_t, linval);
+		list_remove(link);
+		(void) ui_control_paint(control);
+	}
+
+	if (window->update_pending)
+		ui_window_render_dirty(window);
+}
+
 /** Window invalidate callback
  *
  * @param arg Argument (ui_window_t *)
@@ -1237,13 +1307,24 @@ void ui_window_def_unfocus(ui_window_t *window)
 static void ui_window_invalidate(void *arg, gfx_rect_t *rect)
 {
 	ui_window_t *window = (ui_window_t *) arg;
+	gfx_rect_t bounds;
 	gfx_rect_t env;
+	errno_t rc;
 
-	gfx_rect_envelope(&window->dirty_rect, rect, &env);
-	window->dirty_rect = env;
+	rc = gfx_region_union_rect(&window->dirty, rect);
+	if (rc != EOK) {
+		/* Out of memory, fall back to a single enveloping rectangle */
+		gfx_region_get_bounds(&window->dirty, &bounds);
+		gfx_rect_envelope(&bounds, rect, &env);
+		(void) gfx_region_set_rect(&window->dirty, &env);
+	}
 }
 
 /** Window update callback
+ *
+ * While the UI is locked (i.e. an event is being handled) the update
+ * is deferred until the UI is unlocked, so that the damage caused by
+ * the whole event is sent to the display at once.
  *
  * @param arg Argument (ui_window_t *)
  */
@@ -1251,15 +1332,12 @@ static void ui_window_update(void *arg)
 {
 	ui_window_t *window = (ui_window_t *) arg;
 
-	if (!gfx_rect_is_empty(&window->dirty_rect)) {
-		(void) gfx_bitmap_render(window->bmp, &window->dirty_rect,
-		    &window->dpos);
+	if (fibril_mutex_is_locked(&window->ui->lock)) {
+		window->update_pending = true;
+		return;
 	}
 
-	window->dirty_rect.p0.x = 0;
-	window->dirty_rect.p0.y = 0;
-	window->dirty_rect.p1.x = 0;
-	window->dirty_rect.p1.y = 0;
+	ui_window_render_dirty(window);
 }
 
 /** Window cursor get position callback
@@ -450,6 +450,56 @@ PCUT_TEST(def_paint)
 	ui_destroy(ui);
 }
 
+/** Control invalidated while UI is locked is painted when it is unlocked */
+PCUT_TEST(invalidate_ctl)
+{
+	errno_t rc;
+	ui_t *ui = NULL;
+	ui_wnd_params_t params;
+	ui_window_t *window = NULL;
+	ui_control_t *control = NULL;
+	test_ctl_resp_t resp;
+
+	rc = ui_create_disp(NULL, &ui);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	ui_wnd_params_init(&params);
+	params.caption = "Hello";
+
+	rc = ui_window_create(ui, &params, &window);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_NOT_NULL(window);
+
+	rc = ui_control_new(&test_ctl_ops, &resp, &control);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	/* Not locked, paint immediately */
+	resp.rc = EOK;
+	resp.paint = false;
+	ui_window_invalidate_ctl(window, control);
+	PCUT_ASSERT_TRUE(resp.paint);
+
+	/* Locked, paint is deferred until unlock */
+	resp.paint = false;
+	ui_lock(ui);
+	ui_window_invalidate_ctl(window, control);
+	ui_window_invalidate_ctl(window, control);
+	PCUT_ASSERT_FALSE(resp.paint);
+	ui_unlock(ui);
+	PCUT_ASSERT_TRUE(resp.paint);
+
+	/* Deleting control drops pending paint */
+	resp.paint = false;
+	ui_lock(ui);
+	ui_window_invalidate_ctl(window, control);
+	ui_control_delete(control);
+	ui_unlock(ui);
+	PCUT_ASSERT_FALSE(resp.paint);
+
+	ui_window_destroy(window);
+	ui_destroy(ui);
+}
+
 /** ui_window_def_pos() delivers position event to control in window */
 PCUT_TEST(def_pos)
 {
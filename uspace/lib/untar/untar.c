@@ -32,14 +32,63 @@
 /** @file
  */
 
+#include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <macros.h>
+#include <mem.h>
+#include <str.h>
 #include <str_error.h>
 #include <vfs/vfs.h>
 #include "private/tar.h"
 #include "untar.h"
 
+/** Size of the archive read buffer */
+#define UNTAR_BUF_SIZE  (64 * 1024)
+
+/** Largest chunk of file data written at once */
+#define UNTAR_CHUNK_SIZE  (64 * 1024)
+
+/** Largest number of chunks read ahead of their writes */
+#define UNTAR_CHUNKS  16
+
+/** Number of writes sent to VFS at the same time */
+#define UNTAR_DEPTH  8
+
+/** File being extracted */
+typedef struct {
+	int fd;
+	/** Chunks being written, plus one while the file is being read */
+	size_t refs;
+	char filename[100];
+} untar_file_t;
+
+/** Chunk of file data being written */
+typedef struct {
+	untar_file_t *file;
+	size_t size;
+	uint8_t data[];
+} untar_chunk_t;
+
+/** Extraction state */
+typedef struct {
+	tar_file_t *tar;
+
+	/** Read buffer */
+	uint8_t *buf;
+	size_t buf_pos;
+	size_t buf_len;
+
+	/** Writes of file data */
+	vfs_aio_queue_t *queue;
+	/** Number of chunks being written */
+	size_t chunks;
+	/** First error of a write */
+	errno_t rc;
+} untar_t;
+
 static size_t get_block_count(size_t bytes)
 {
 	return (bytes + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE;
@@ -70,15 +119,67 @@ static void tar_report(tar_file_t *tar, const char *fmt, ...)
 	va_end(args);
 }
 
-static errno_t tar_skip_blocks(tar_file_t *tar, size_t valid_data_size)
+/** Read archive data.
+ *
+ * The archive is read in large pieces through a buffer, large requests
+ * bypass the buffer.
+ *
+ * @param u    Extraction state
+ * @param data Destination buffer
+ * @param size Number of bytes to read
+ *
+ * @return EOK on success, EIO if the archive ended or could not be read
+ */
+static errno_t untar_read(untar_t *u, void *data, size_t size)
+{
+	uint8_t *dp = (uint8_t *) data;
+
+	while (size > 0) {
+		if (u->buf_pos == u->buf_len) {
+			size_t nread = 0;
+
+			if (size < UNTAR_BUF_SIZE) {
+				nread = tar_read(u->tar, u->buf,
+				    UNTAR_BUF_SIZE);
+				u->buf_pos = 0;
+				u->buf_len = nread;
+			}
+
+			if (nread == 0) {
+				/*
+				 * Read directly if the request is large or if
+				 * the source cannot provide a whole buffer,
+				 * e.g. at the end of a block device.
+				 */
+				nread = tar_read(u->tar, dp, size);
+				if (nread == 0)
+					return EIO;
+
+				dp += nread;
+				size -= nread;
+				continue;
+			}
+		}
+
+		size_t n = min(size, u->buf_len - u->buf_pos);
+		memcpy(dp, u->buf + u->buf_pos, n);
+		u->buf_pos += n;
+		dp += n;
+		size -= n;
+	}
+
+	return EOK;
+}
+
+static errno_t tar_skip_blocks(untar_t *u, size_t valid_data_size)
 {
 	size_t blocks_to_read = get_block_count(valid_data_size);
 
 	while (blocks_to_read > 0) {
 		uint8_t block[TAR_BLOCK_SIZE];
-		size_t actually_read = tar_read(tar, block, TAR_BLOCK_SIZE);
-		if (actually_read != TAR_BLOCK_SIZE)
-			return errno;
+		errno_t rc = untar_read(u, block, TAR_BLOCK_SIZE);
+		if (rc != EOK)
+			return rc;
 
 		blocks_to_read--;
 	}
@@ -86,66 +187,167 @@ static errno_t tar_skip_blocks(tar_file_t *tar, size_t valid_data_size)
 	return EOK;
 }
 
-static errno_t tar_handle_normal_file(tar_file_t *tar,
-    const tar_header_t *header)
+/** Drop a reference to a file being extracted, close it with the last one. */
+static void untar_file_put(untar_file_t *file)
+{
+	assert(file->refs > 0);
+
+	if (--file->refs == 0) {
+		vfs_put(file->fd);
+		free(file);
+	}
+}
+
+/** Wait for a chunk to be written.
+ *
+ * @param u Extraction state
+ *
+ * @return EOK if a chunk was written, ENOENT if no write is pending
+ */
+static errno_t untar_write_wait(untar_t *u)
+{
+	vfs_aio_result_t res;
+	errno_t rc = vfs_aio_wait(u->queue, &res);
+	if (rc != EOK)
+		return rc;
+
+	untar_chunk_t *chunk = (untar_chunk_t *) res.arg;
+
+	rc = res.rc;
+	if (rc == EOK && res.nbytes != chunk->size)
+		rc = EIO;
+
+	if (rc != EOK) {
+		tar_report(u->tar, "Failed to write to %s: %s.\n",
+		    chunk->file->filename, str_error(rc));
+		if (u->rc == EOK)
+			u->rc = rc;
+	}
+
+	untar_file_put(chunk->file);
+	free(chunk);
+	u->chunks--;
+	return EOK;
+}
+
+static errno_t tar_handle_normal_file(untar_t *u, const tar_header_t *header)
 {
 	// FIXME: create the directory first
 
-	FILE *file = fopen(header->filename, "wb");
+	untar_file_t *file = malloc(sizeof(untar_file_t));
 	if (file == NULL) {
-		tar_report(tar, "Failed to create %s: %s.\n", header->filename,
-		    str_error(errno));
-		return errno;
+		tar_report(u->tar, "Failed to create %s: %s.\n",
+		    header->filename, str_error(ENOMEM));
+		return ENOMEM;
 	}
 
-	errno_t rc = EOK;
-	size_t bytes_remaining = header->size;
-	size_t blocks = get_block_count(bytes_remaining);
+	errno_t rc = vfs_lookup_open(header->filename,
+	    WALK_REGULAR | WALK_MAY_CREATE, MODE_WRITE, &file->fd);
+	if (rc != EOK) {
+		tar_report(u->tar, "Failed to create %s: %s.\n",
+		    header->filename, str_error(rc));
+		free(file);
+		return rc;
+	}
 
-	while (blocks > 0) {
-		uint8_t block[TAR_BLOCK_SIZE];
-		size_t actually_read = tar_read(tar, block, TAR_BLOCK_SIZE);
-		if (actually_read != TAR_BLOCK_SIZE) {
-			rc = errno;
-			tar_report(tar, "Failed to read block for %s: %s.\n",
+	str_cpy(file->filename, sizeof(file->filename), header->filename);
+	file->refs = 1;
+
+	/*
+	 * Replace any previous content. The chunks are written at their own
+	 * positions and may complete in any order.
+	 */
+	rc = vfs_resize(file->fd, header->size);
+	if (rc != EOK) {
+		tar_report(u->tar, "Failed to create %s: %s.\n",
+		    header->filename, str_error(rc));
+	}
+
+	aoff64_t pos = 0;
+	while (rc == EOK && pos < header->size) {
+		size_t size = min(header->size - pos, UNTAR_CHUNK_SIZE);
+
+		/* Do not read too far ahead of the writes */
+		if (u->chunks >= UNTAR_CHUNKS)
+			(void) untar_write_wait(u);
+
+		if (u->rc != EOK) {
+			rc = u->rc;
+			break;
+		}
+
+		untar_chunk_t *chunk = malloc(sizeof(untar_chunk_t) + size);
+		if (chunk == NULL) {
+			rc = ENOMEM;
+			tar_report(u->tar, "Failed to write to %s: %s.\n",
+			    header->filename, str_error(rc));
+			break;
+		}
+
+		rc = untar_read(u, chunk->data, size);
+		if (rc != EOK) {
+			tar_report(u->tar, "Failed to read block for %s: %s.\n",
 			    header->filename, str_error(rc));
+			free(chunk);
 			break;
 		}
 
-		size_t to_write = TAR_BLOCK_SIZE;
-		if (bytes_remaining < TAR_BLOCK_SIZE)
-			to_write = bytes_remaining;
+		chunk->file = file;
+		chunk->size = size;
 
-		size_t actually_written = fwrite(block, 1, to_write, file);
-		if (actually_written != to_write) {
-			rc = errno;
-			tar_report(tar, "Failed to write to %s: %s.\n",
+		rc = vfs_write_async(u->queue, file->fd, pos, chunk->data, size,
+		    chunk, NULL);
+		if (rc != EOK) {
+			tar_report(u->tar, "Failed to write to %s: %s.\n",
 			    header->filename, str_error(rc));
+			free(chunk);
 			break;
 		}
 
-		blocks--;
-		bytes_remaining -= TAR_BLOCK_SIZE;
+		file->refs++;
+		u->chunks++;
+		pos += size;
+	}
+
+	/* Skip the padding of the last block */
+	if (rc == EOK) {
+		size_t padding = get_block_count(header->size) *
+		    TAR_BLOCK_SIZE - header->size;
+		if (padding > 0) {
+			uint8_t block[TAR_BLOCK_SIZE];
+			rc = untar_read(u, block, padding);
+		}
 	}
 
-	fclose(file);
+	untar_file_put(file);
 	return rc;
 }
 
-static errno_t tar_handle_directory(tar_file_t *tar, const tar_header_t *header)
+static errno_t tar_handle_directory(untar_t *u, const tar_header_t *header)
 {
 	errno_t rc = vfs_link_path(header->filename, KIND_DIRECTORY, NULL);
 	if (rc != EOK) {
 		if (rc != EEXIST) {
-			tar_report(tar, "Failed to create directory %s: %s.\n",
+			tar_report(u->tar,
+			    "Failed to create directory %s: %s.\n",
 			    header->filename, str_error(rc));
 			return rc;
 		}
 	}
 
-	return tar_skip_blocks(tar, header->size);
+	return tar_skip_blocks(u, header->size);
 }
 
+/** Extract an archive.
+ *
+ * The archive is read and decompressed while the file data read so far
+ * is still being written. Writes of several chunks, possibly of several
+ * files, are sent to VFS at the same time.
+ *
+ * @param tar Archive
+ *
+ * @return EOK if the archive could be opened, error code otherwise
+ */
 int untar(tar_file_t *tar)
 {
 	int rc = tar_open(tar);
@@ -154,10 +356,31 @@ int untar(tar_file_t *tar)
 		return rc;
 	}
 
+	untar_t u;
+	u.tar = tar;
+	u.buf_pos = 0;
+	u.buf_len = 0;
+	u.chunks = 0;
+	u.rc = EOK;
+
+	u.buf = malloc(UNTAR_BUF_SIZE);
+	if (u.buf == NULL) {
+		tar_report(tar, "Failed to open: %s.\n", str_error(ENOMEM));
+		tar_close(tar);
+		return ENOMEM;
+	}
+
+	rc = vfs_aio_queue_create(UNTAR_DEPTH, &u.queue);
+	if (rc != EOK) {
+		tar_report(tar, "Failed to open: %s.\n", str_error(rc));
+		free(u.buf);
+		tar_close(tar);
+		return rc;
+	}
+
 	while (true) {
 		tar_header_raw_t header_raw;
-		size_t header_ok = tar_read(tar, &header_raw, sizeof(header_raw));
-		if (header_ok != sizeof(header_raw))
+		if (untar_read(&u, &header_raw, sizeof(header_raw)) != EOK)
 			break;
 
 		tar_header_t header;
@@ -172,13 +395,13 @@ int untar(tar_file_t *tar)
 
 		switch (header.type) {
 		case TAR_TYPE_DIRECTORY:
-			rc = tar_handle_directory(tar, &header);
+			rc = tar_handle_directory(&u, &header);
 			break;
 		case TAR_TYPE_NORMAL:
-			rc = tar_handle_normal_file(tar, &header);
+			rc = tar_handle_normal_file(&u, &header);
 			break;
 		default:
-			rc = tar_skip_blocks(tar, header.size);
+			rc = tar_skip_blocks(&u, header.size);
 			break;
 		}
 
@@ -186,6 +409,12 @@ int untar(tar_file_t *tar)
 			break;
 	}
 
+	/* Wait until all file data is written */
+	while (untar_write_wait(&u) == EOK)
+		;
+
+	vfs_aio_queue_destroy(u.queue);
+	free(u.buf);
 	tar_close(tar);
 	return EOK;
 }
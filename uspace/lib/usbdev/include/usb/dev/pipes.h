@@ -109,6 +109,7 @@ errno_t usb_pipe_register(usb_pipe_t *,
     const usb_standard_endpoint_descriptor_t *,
     const usb_superspeed_endpoint_companion_descriptor_t *);
 errno_t usb_pipe_unregister(usb_pipe_t *);
+errno_t usb_pipe_request_streams(usb_pipe_t *, unsigned, unsigned *);
 
 errno_t usb_pipe_read(usb_pipe_t *, void *, size_t, size_t *);
 errno_t usb_pipe_write(usb_pipe_t *, const void *, size_t);
@@ -116,6 +117,11 @@ errno_t usb_pipe_write(usb_pipe_t *, const void *, size_t);
 errno_t usb_pipe_read_dma(usb_pipe_t *, void *, void *, size_t, size_t *);
 errno_t usb_pipe_write_dma(usb_pipe_t *, void *, void *, size_t);
 
+errno_t usb_pipe_read_stream_dma(usb_pipe_t *, usb_stream_t, void *, void *,
+    size_t, size_t *);
+errno_t usb_pipe_write_stream_dma(usb_pipe_t *, usb_stream_t, void *, void *,
+    size_t);
+
 errno_t usb_pipe_control_read(usb_pipe_t *, const void *, size_t,
     void *, size_t, size_t *);
 errno_t usb_pipe_control_write(usb_pipe_t *, const void *, size_t,
@@ -350,6 +350,66 @@ errno_t usb_pipe_write_dma(usb_pipe_t *pipe, void *base, void *ptr, size_t size)
 	return transfer_common(&transfer);
 }
 
+/**
+ * Request a read (in) transfer on a stream of a bulk endpoint pipe, declaring
+ * that buffer is pointing to a memory area previously allocated by
+ * usb_pipe_alloc_buffer.
+ *
+ * @param[in] pipe Pipe used for the transfer.
+ * @param[in] stream Stream ID, as granted by usb_pipe_request_streams.
+ * @param[in] buffer Buffer, previously allocated with usb_pipe_alloc_buffer.
+ * @param[in] size Size of the buffer (in bytes).
+ * @param[out] size_transferred Number of bytes that were actually transferred.
+ * @return Error code.
+ */
+errno_t usb_pipe_read_stream_dma(usb_pipe_t *pipe, usb_stream_t stream,
+    void *base, void *ptr, size_t size, size_t *size_transferred)
+{
+	assert(pipe);
+	errno_t err;
+	transfer_t transfer = {
+		.pipe = pipe,
+		.dir = USB_DIRECTION_IN,
+		.req.stream = stream,
+	};
+
+	setup_dma_buffer(&transfer, base, ptr, size);
+
+	if ((err = transfer_common(&transfer)))
+		return err;
+
+	if (size_transferred)
+		*size_transferred = transfer.transferred_size;
+
+	return EOK;
+}
+
+/**
+ * Request a write (out) transfer on a stream of a bulk endpoint pipe,
+ * declaring that buffer is pointing to a memory area previously allocated by
+ * usb_pipe_alloc_buffer.
+ *
+ * @param[in] pipe Pipe used for the transfer.
+ * @param[in] stream Stream ID, as granted by usb_pipe_request_streams.
+ * @param[in] buffer Buffer, previously allocated with usb_pipe_alloc_buffer.
+ * @param[in] size Size of the buffer (in bytes).
+ * @return Error code.
+ */
+errno_t usb_pipe_write_stream_dma(usb_pipe_t *pipe, usb_stream_t stream,
+    void *base, void *ptr, size_t size)
+{
+	assert(pipe);
+	transfer_t transfer = {
+		.pipe = pipe,
+		.dir = USB_DIRECTION_OUT,
+		.req.stream = stream,
+	};
+
+	setup_dma_buffer(&transfer, base, ptr, size);
+
+	return transfer_common(&transfer);
+}
+
 /** Initialize USB endpoint pipe.
  *
  * @param pipe Endpoint pipe to be initialized.
@@ -457,6 +517,35 @@ errno_t usb_pipe_unregister(usb_pipe_t *pipe)
 	return ret;
 }
 
+/** Switch a registered bulk endpoint to stream operation.
+ *
+ * Must be called while there are no transfers on the pipe.
+ *
+ * @param[in] pipe Bulk pipe.
+ * @param[in] count Number of streams requested.
+ * @param[out] granted Number of streams granted, usable IDs are 1..granted.
+ * @return Error code.
+ */
+errno_t usb_pipe_request_streams(usb_pipe_t *pipe, unsigned count,
+    unsigned *granted)
+{
+	assert(pipe);
+	assert(pipe->bus_session);
+
+	if (pipe->desc.transfer_type != USB_TRANSFER_BULK)
+		return EINVAL;
+
+	async_exch_t *exch = async_exchange_begin(pipe->bus_session);
+	if (!exch)
+		return ENOMEM;
+
+	const errno_t ret = usbhc_request_streams(exch, &pipe->desc, count,
+	    granted);
+
+	async_exchange_end(exch);
+	return ret;
+}
+
 /**
  * @}
  */
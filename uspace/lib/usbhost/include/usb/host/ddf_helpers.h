@@ -54,6 +54,8 @@ extern errno_t hcd_ddf_setup_match_ids(device_t *,
     usb_standard_device_descriptor_t *);
 
 extern errno_t hcd_ddf_enable_interrupt(hc_device_t *, int);
+extern errno_t hcd_ddf_msi_alloc(hc_device_t *, int *);
+extern void hcd_ddf_msi_free(hc_device_t *);
 extern errno_t hcd_ddf_get_registers(hc_device_t *, hw_res_list_parsed_t *);
 
 #endif
@@ -65,8 +65,8 @@ typedef struct usb_transfer_batch usb_transfer_batch_t;
  * concrete instance of mutex can be unknown at the time of initialization,
  * the HC shall pass the right lock at the time of onlining the endpoint.
  *
- * The fields used for scheduling (online, active_batch) are to be used only
- * under that guard and by functions designed for this purpose. The driver can
+ * The fields used for scheduling (online, active_batch, active_batches) are
+ * to be used only under that guard and by functions designed for this purpose. The driver can
  * also completely avoid using this mechanism, in which case it is on its own in
  * question of transfer aborting.
  *
@@ -83,8 +83,14 @@ typedef struct endpoint {
 	fibril_mutex_t *guard;
 	/** Whether it's allowed to schedule on this endpoint */
 	bool online;
-	/** The currently active transfer batch. */
+	/** The oldest active transfer batch. */
 	usb_transfer_batch_t *active_batch;
+	/** Active transfer batches in the order of activation. */
+	list_t active_batches;
+	/** Number of batches in active_batches. */
+	size_t active_count;
+	/** Number of batches that can be active at the same time. */
+	size_t max_active;
 	/** Signals change of active status. */
 	fibril_condvar_t avail;
 
@@ -105,6 +111,8 @@ typedef struct endpoint {
 	dma_policy_t transfer_buffer_policy;
 	/** Enforced by the library. */
 	dma_policy_t required_transfer_buffer_policy;
+	/** Whether the HC honors the offset into the transfer buffer. */
+	bool transfer_buffer_offset;
 
 	/**
 	 * Number of packets that can be sent in one service interval
@@ -127,6 +135,8 @@ extern void endpoint_set_offline_locked(endpoint_t *);
 extern void endpoint_wait_timeout_locked(endpoint_t *ep, usec_t);
 extern int endpoint_activate_locked(endpoint_t *, usb_transfer_batch_t *);
 extern void endpoint_deactivate_locked(endpoint_t *);
+extern void endpoint_deactivate_batch_locked(endpoint_t *,
+    usb_transfer_batch_t *);
 
 int endpoint_send_batch(endpoint_t *, const transfer_request_t *);
 
@@ -62,6 +62,9 @@ typedef struct hc_device {
 	/* IRQ capability handle of the subscribed IRQ code */
 	cap_irq_handle_t irq_handle;
 
+	/** Interrupt is message signalled */
+	bool msi;
+
 	/** Interrupt replacement fibril */
 	fid_t polling_fibril;
 
@@ -62,6 +62,8 @@ typedef struct usb_transfer_batch {
 
 	/** Endpoint used for communication */
 	endpoint_t *ep;
+	/** Link to endpoint's list of active batches */
+	link_t link;
 
 	/** Place to store SETUP data needed by control transfers */
 	union {
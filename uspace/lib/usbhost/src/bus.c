@@ -515,6 +515,40 @@ int bus_endpoint_remove(endpoint_t *ep)
 	return EOK;
 }
 
+/**
+ * Switch a registered bulk endpoint to stream operation.
+ *
+ * @param ep Endpoint with no transfers in flight
+ * @param count Number of streams the caller wants to use
+ * @param granted Number of streams that can be used, IDs 1..granted
+ */
+int bus_endpoint_request_streams(endpoint_t *ep, unsigned count,
+    unsigned *granted)
+{
+	assert(ep);
+	assert(ep->device);
+
+	device_t *device = ep->device;
+	bus_t *bus = device->bus;
+
+	if (!bus->ops->endpoint_request_streams)
+		return ENOTSUP;
+
+	if (ep->transfer_type != USB_TRANSFER_BULK)
+		return EINVAL;
+
+	fibril_mutex_lock(&device->guard);
+	const int err = bus->ops->endpoint_request_streams(ep, count, granted);
+	fibril_mutex_unlock(&device->guard);
+
+	if (!err) {
+		usb_log_debug("Endpoint %d:%d uses %u streams.",
+		    device->address, ep->endpoint, *granted);
+	}
+
+	return err;
+}
+
 /**
  * Reserve the default address on the bus for the specified device (hub).
  */
@@ -118,6 +118,33 @@ static errno_t unregister_endpoint(ddf_fun_t *fun, const usb_pipe_desc_t *pipe_d
 	return err;
 }
 
+/**
+ * DDF usbhc_iface callback. Switch the endpoint that makes the other end of
+ * the pipe described to stream operation.
+ *
+ * @param fun DDF function of the device in question.
+ * @param pipe_desc Pipe description.
+ * @param count Number of streams requested.
+ * @param granted Number of streams usable by the device driver.
+ * @return Error code.
+ */
+static errno_t request_streams(ddf_fun_t *fun, const usb_pipe_desc_t *pipe_desc,
+    unsigned count, unsigned *granted)
+{
+	assert(fun);
+	device_t *dev = ddf_fun_data_get(fun);
+	assert(dev);
+
+	endpoint_t *ep = bus_find_endpoint(dev, pipe_desc->endpoint_no, pipe_desc->direction);
+	if (!ep)
+		return ENOENT;
+
+	const errno_t err = bus_endpoint_request_streams(ep, count, granted);
+
+	endpoint_del_ref(ep);
+	return err;
+}
+
 /**
  * DDF usbhc_iface callback. Calls the respective bus operation directly.
  *
@@ -330,6 +357,7 @@ static usbhc_iface_t usbhc_iface = {
 
 	.register_endpoint = register_endpoint,
 	.unregister_endpoint = unregister_endpoint,
+	.request_streams = request_streams,
 
 	.transfer = transfer,
 };
@@ -511,6 +539,42 @@ errno_t hcd_ddf_enable_interrupt(hc_device_t *hcd, int inum)
 	return hw_res_enable_interrupt(parent_sess, inum);
 }
 
+/** Ask the parent driver for a message signalled interrupt
+ *
+ * @param[in] hcd Device asking for the interrupt
+ * @param[out] inum Interrupt number to use instead of the legacy line
+ * @return Error code.
+ */
+errno_t hcd_ddf_msi_alloc(hc_device_t *hcd, int *inum)
+{
+	async_sess_t *parent_sess = ddf_dev_parent_sess_get(hcd->ddf_dev);
+	if (parent_sess == NULL)
+		return EIO;
+
+	size_t nvec;
+	errno_t ret = hw_res_msi_alloc(parent_sess, 1, inum, &nvec);
+	if (ret == EOK)
+		hcd->msi = true;
+
+	return ret;
+}
+
+/** Return the message signalled interrupt to the parent driver
+ *
+ * @param[in] hcd Device owning the interrupt
+ */
+void hcd_ddf_msi_free(hc_device_t *hcd)
+{
+	if (!hcd->msi)
+		return;
+
+	async_sess_t *parent_sess = ddf_dev_parent_sess_get(hcd->ddf_dev);
+	if (parent_sess != NULL)
+		(void) hw_res_msi_free(parent_sess);
+
+	hcd->msi = false;
+}
+
 errno_t hcd_ddf_get_registers(hc_device_t *hcd, hw_res_list_parsed_t *hw_res)
 {
 	async_sess_t *parent_sess = ddf_dev_parent_sess_get(hcd->ddf_dev);
@@ -60,6 +60,8 @@ void endpoint_init(endpoint_t *ep, device_t *dev, const usb_endpoint_descriptors
 
 	refcount_init(&ep->refcnt);
 	fibril_condvar_initialize(&ep->avail);
+	list_initialize(&ep->active_batches);
+	ep->max_active = 1;
 
 	ep->endpoint = USB_ED_GET_EP(desc->endpoint);
 	ep->direction = USB_ED_GET_DIR(desc->endpoint);
@@ -156,8 +158,8 @@ void endpoint_wait_timeout_locked(endpoint_t *ep, usec_t timeout)
 }
 
 /**
- * Mark the endpoint as active and block access for further fibrils. If the
- * endpoint is already active, it will block on ep->avail condvar.
+ * Add a batch to the active batches of the endpoint. If the endpoint already
+ * has ep->max_active batches active, it will block on ep->avail condvar.
  *
  * Call only under endpoint guard. After you activate the endpoint and release
  * the guard, you must assume that particular transfer is already
@@ -177,27 +179,56 @@ int endpoint_activate_locked(endpoint_t *ep, usb_transfer_batch_t *batch)
 	assert(ep->guard);
 	assert(fibril_mutex_is_locked(ep->guard));
 
-	while (ep->online && ep->active_batch != NULL)
+	while (ep->online && ep->active_count >= ep->max_active)
 		fibril_condvar_wait(&ep->avail, ep->guard);
 
 	if (!ep->online)
 		return EINTR;
 
-	assert(ep->active_batch == NULL);
-	ep->active_batch = batch;
+	list_append(&batch->link, &ep->active_batches);
+	if (ep->active_count++ == 0)
+		ep->active_batch = batch;
 	return EOK;
 }
 
 /**
- * Mark the endpoint as inactive and allow access for further fibrils.
+ * Remove a batch from the active batches of the endpoint and allow access for
+ * further fibrils.
+ *
+ * @param batch Active transfer batch of this endpoint.
+ */
+void endpoint_deactivate_batch_locked(endpoint_t *ep,
+    usb_transfer_batch_t *batch)
+{
+	assert(ep);
+	assert(batch);
+	assert(batch->ep == ep);
+	assert(fibril_mutex_is_locked(ep->guard));
+	assert(ep->active_count > 0);
+
+	list_remove(&batch->link);
+	ep->active_count--;
+
+	link_t *first = list_first(&ep->active_batches);
+	ep->active_batch = first ?
+	    list_get_instance(first, usb_transfer_batch_t, link) : NULL;
+	fibril_condvar_broadcast(&ep->avail);
+}
+
+/**
+ * Deactivate the oldest active batch of the endpoint (if any).
  */
 void endpoint_deactivate_locked(endpoint_t *ep)
 {
 	assert(ep);
 	assert(fibril_mutex_is_locked(ep->guard));
 
-	ep->active_batch = NULL;
-	fibril_condvar_signal(&ep->avail);
+	if (ep->active_batch == NULL) {
+		fibril_condvar_broadcast(&ep->avail);
+		return;
+	}
+
+	endpoint_deactivate_batch_locked(ep, ep->active_batch);
 }
 
 /**
@@ -267,7 +298,7 @@ errno_t endpoint_send_batch(endpoint_t *ep, const transfer_request_t *req)
 
 	dma_buffer_acquire(&batch->dma_buffer);
 
-	if (batch->offset != 0) {
+	if (batch->offset != 0 && !ep->transfer_buffer_offset) {
 		usb_log_debug("A transfer with nonzero offset requested.");
 		usb_transfer_batch_bounce(batch);
 	}
@@ -174,6 +174,14 @@ static errno_t hcd_ddf_setup_interrupts(hc_device_t *hcd,
 		return ret;
 	}
 
+	/*
+	 * The IRQ code only touches the controller registers, so it works
+	 * just as well when the interrupt arrives as a message.
+	 */
+	int inr;
+	if (hcd_ddf_msi_alloc(hcd, &inr) == EOK)
+		irq = inr;
+
 	/* Register handler to avoid interrupt lockup */
 	cap_irq_handle_t ihandle;
 	ret = register_interrupt_handler(hcd->ddf_dev, irq, irq_handler,
@@ -182,6 +190,7 @@ static errno_t hcd_ddf_setup_interrupts(hc_device_t *hcd,
 	if (ret != EOK) {
 		usb_log_error("Failed to register interrupt handler: %s.",
 		    str_error(ret));
+		hcd_ddf_msi_free(hcd);
 		return ret;
 	}
 
@@ -191,6 +200,7 @@ static errno_t hcd_ddf_setup_interrupts(hc_device_t *hcd,
 		usb_log_error("Failed to enable interrupts: %s.",
 		    str_error(ret));
 		unregister_interrupt_handler(hcd->ddf_dev, ihandle);
+		hcd_ddf_msi_free(hcd);
 		return ret;
 	}
 
@@ -311,6 +321,7 @@ err_started:
 		hc_driver->stop(hcd);
 err_irq:
 	unregister_interrupt_handler(device, hcd->irq_handle);
+	hcd_ddf_msi_free(hcd);
 	if (hc_driver->hc_remove)
 		hc_driver->hc_remove(hcd);
 err_hw_res:
@@ -330,6 +341,7 @@ errno_t hc_dev_remove(ddf_dev_t *dev)
 			return err;
 
 	unregister_interrupt_handler(dev, hcd->irq_handle);
+	hcd_ddf_msi_free(hcd);
 
 	if (hc_driver->hc_remove)
 		if ((err = hc_driver->hc_remove(hcd)))
@@ -290,5 +290,45 @@ errno_t virtio_pci_dev_cleanup(virtio_dev_t *vdev)
 	return disable_resources(vdev);
 }
 
+/** Switch the device from INT#x to a single MSI-X vector.
+ *
+ * Must be called before the virtqueues are set up, which is when the
+ * vector gets assigned to them. Once MSI-X is enabled the device no longer
+ * updates the ISR register, so the caller's IRQ code must not look at it.
+ *
+ * @param dev  DDF device
+ * @param vdev VIRTIO device
+ * @param inr  Place to store the interrupt number
+ *
+ * @return EOK on success or an error code
+ */
+errno_t virtio_pci_msi_alloc(ddf_dev_t *dev, virtio_dev_t *vdev, int *inr)
+{
+	async_sess_t *pci_sess = ddf_dev_parent_sess_get(dev);
+	if (!pci_sess)
+		return ENOENT;
+
+	size_t nvec;
+	errno_t rc = hw_res_msi_alloc(pci_sess, 1, inr, &nvec);
+	if (rc != EOK)
+		return rc;
+
+	vdev->msix = true;
+	return EOK;
+}
+
+/** Return the MSI-X vector to the PCI driver. */
+void virtio_pci_msi_free(ddf_dev_t *dev, virtio_dev_t *vdev)
+{
+	if (!vdev->msix)
+		return;
+
+	async_sess_t *pci_sess = ddf_dev_parent_sess_get(dev);
+	if (pci_sess)
+		(void) hw_res_msi_free(pci_sess);
+
+	vdev->msix = false;
+}
+
 /** @}
  */
@@ -50,6 +50,9 @@
 #define VIRTIO_PCI_CAP_DEVICE_CFG	4
 #define VIRTIO_PCI_CAP_PCI_CFG		5
 
+/** MSI-X vector number meaning no interrupt */
+#define VIRTIO_MSI_NO_VECTOR	0xffff
+
 #define VIRTIO_DEV_STATUS_RESET			0
 #define VIRTIO_DEV_STATUS_ACKNOWLEDGE		1
 #define VIRTIO_DEV_STATUS_DRIVER		2
@@ -62,6 +65,13 @@
 #define VIRTIO_FEATURES_32_63	1
 
 #define VIRTIO_F_VERSION_1	1
+/** Packed virtqueue layout, bit 34 of the feature bits */
+#define VIRTIO_F_RING_PACKED	(1U << 2)
+
+/** Descriptors with VIRTQ_DESC_F_INDIRECT can be used */
+#define VIRTIO_RING_F_INDIRECT_DESC	(1U << 28)
+/** The used_event and avail_event ring members are used */
+#define VIRTIO_RING_F_EVENT_IDX		(1U << 29)
 
 /** Common configuration structure layout according to VIRTIO version 1.0 */
 typedef struct virtio_pci_common_cfg {
@@ -118,6 +128,33 @@ typedef struct virtq_used_elem {
 
 #define VIRTQ_USED_F_NO_NOTIFY	1
 
+/** Packed descriptor made available with the avail wrap counter set */
+#define VIRTQ_DESC_F_AVAIL	(1 << 7)
+/** Packed descriptor used with the used wrap counter set */
+#define VIRTQ_DESC_F_USED	(1 << 15)
+
+/** Packed virtqueue descriptor as per VIRTIO version 1.1 */
+typedef struct virtq_pdesc {
+	ioport64_t addr;	/**< Buffer physical address */
+	ioport32_t len;		/**< Buffer length */
+	ioport16_t id;		/**< Buffer ID */
+	ioport16_t flags;	/**< Buffer flags */
+} virtq_pdesc_t;
+
+#define VIRTQ_PEVENT_F_ENABLE	0
+#define VIRTQ_PEVENT_F_DISABLE	1
+/** Notify at the ring position in off_wrap, needs VIRTIO_RING_F_EVENT_IDX */
+#define VIRTQ_PEVENT_F_DESC	2
+
+/** Wrap counter bit of off_wrap */
+#define VIRTQ_PEVENT_WRAP	(1 << 15)
+
+/** Packed virtqueue event suppression structure as per VIRTIO version 1.1 */
+typedef struct virtq_pevent {
+	ioport16_t off_wrap;
+	ioport16_t flags;
+} virtq_pevent_t;
+
 /** Virtqueue Used Ring as per VIRTIO version 1.0 */
 typedef struct virtq_used {
 	ioport16_t flags;
@@ -143,13 +180,40 @@ typedef struct {
 	 */
 	size_t queue_size;
 
-	/** Virtual address of queue size virtq descriptors */
+	/**
+	 * Virtual address of queue size virtq descriptors. With a packed
+	 * virtqueue, the descriptors live in driver memory and are only
+	 * copied to the ring when made available.
+	 */
 	virtq_desc_t *desc;
 	/** Virtual address of the available ring */
 	virtq_avail_t *avail;
 	/** Virtual address of the used ring */
 	virtq_used_t *used;
 	uint16_t used_last_idx;
+	/** Available ring index at the last notification of the device */
+	uint16_t kicked_idx;
+	/** Interrupts suppressed by virtio_virtq_set_interrupt() */
+	bool no_interrupt;
+
+	/** Descriptor ring of a packed virtqueue, NULL if split */
+	virtq_pdesc_t *ring;
+	/** Event suppression written by the driver */
+	virtq_pevent_t *driver_event;
+	/** Event suppression written by the device */
+	virtq_pevent_t *device_event;
+	/** Next ring slot to make available */
+	uint16_t next_avail;
+	/** Avail wrap counter */
+	bool avail_wrap;
+	/** Next ring slot to be used by the device */
+	uint16_t next_used;
+	/** Used wrap counter */
+	bool used_wrap;
+	/** Ring slots made available since the last notification */
+	uint16_t added;
+	/** Ring slots taken by each buffer, indexed by buffer ID */
+	uint16_t *chain_len;
 
 	/** Address of the queue's notification register */
 	ioport16_t *notify;
@@ -181,6 +245,14 @@ typedef struct {
 
 	/** Virtqueues */
 	virtq_t *queues;
+
+	/** VIRTIO_RING_F_EVENT_IDX has been negotiated */
+	bool event_idx;
+	/** VIRTIO_F_RING_PACKED has been negotiated */
+	bool packed;
+
+	/** All virtqueues signal MSI-X vector 0 instead of INT#x */
+	bool msix;
 } virtio_dev_t;
 
 extern errno_t virtio_setup_dma_bufs(unsigned int, size_t, bool, void *[],
@@ -196,20 +268,31 @@ extern void virtio_create_desc_free_list(virtio_dev_t *, uint16_t, uint16_t,
     uint16_t *);
 extern uint16_t virtio_alloc_desc(virtio_dev_t *, uint16_t, uint16_t *);
 extern void virtio_free_desc(virtio_dev_t *, uint16_t, uint16_t *, uint16_t);
+extern errno_t virtio_alloc_desc_chain(virtio_dev_t *, uint16_t, uint16_t *,
+    uint16_t, uint16_t []);
+extern void virtio_free_desc_chain(virtio_dev_t *, uint16_t, uint16_t *,
+    uint16_t);
 
+extern void virtio_virtq_add_available(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_kick(virtio_dev_t *, uint16_t);
 extern void virtio_virtq_produce_available(virtio_dev_t *, uint16_t, uint16_t);
 extern bool virtio_virtq_consume_used(virtio_dev_t *, uint16_t, uint16_t *,
     uint32_t *);
+extern void virtio_virtq_set_interrupt(virtio_dev_t *, uint16_t, bool);
 
 extern errno_t virtio_virtq_setup(virtio_dev_t *, uint16_t, uint16_t);
 extern void virtio_virtq_teardown(virtio_dev_t *, uint16_t);
 
 extern errno_t virtio_device_setup_start(virtio_dev_t *, uint32_t);
+extern errno_t virtio_device_setup_start_opt(virtio_dev_t *, uint32_t,
+    uint32_t, uint32_t *);
 extern void virtio_device_setup_fail(virtio_dev_t *);
 extern void virtio_device_setup_finalize(virtio_dev_t *);
 
 extern errno_t virtio_pci_dev_initialize(ddf_dev_t *, virtio_dev_t *);
 extern errno_t virtio_pci_dev_cleanup(virtio_dev_t *);
+extern errno_t virtio_pci_msi_alloc(ddf_dev_t *, virtio_dev_t *, int *);
+extern void virtio_pci_msi_free(ddf_dev_t *, virtio_dev_t *);
 
 #endif
 
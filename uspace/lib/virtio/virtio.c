@@ -35,6 +35,8 @@
 #include <align.h>
 #include <macros.h>
 #include <stdalign.h>
+#include <stdlib.h>
+#include <fibril.h>
 
 #include <ddf/log.h>
 #include <barrier.h>
@@ -170,27 +172,289 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 	fibril_mutex_unlock(&q->lock);
 }
 
-void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+/** Allocate several descriptors from the free list at once
+ *
+ * The descriptors are not linked together, the caller chains them with
+ * virtio_virtq_desc_set().
+ *
+ * @param vdev[in]      VIRTIO device with the free list.
+ * @param num[in]       Index of the virtqueue with free list.
+ * @param head[in,out]  Head of the free list.
+ * @param count[in]     Number of descriptors to allocate.
+ * @param descs[out]    Array of @a count allocated descriptors.
+ *
+ * @return  EOK on success, ENOMEM if the list holds fewer than @a count
+ *          descriptors, in which case none is allocated.
+ */
+errno_t virtio_alloc_desc_chain(virtio_dev_t *vdev, uint16_t num,
+    uint16_t *head, uint16_t count, uint16_t descs[])
+{
+	virtq_t *q = &vdev->queues[num];
+	fibril_mutex_lock(&q->lock);
+	uint16_t descno = *head;
+	for (unsigned i = 0; i < count; i++) {
+		if (descno == (uint16_t) -1U) {
+			fibril_mutex_unlock(&q->lock);
+			return ENOMEM;
+		}
+		descs[i] = descno;
+		descno = virtio_virtq_desc_get_next(vdev, num, descno);
+	}
+	*head = descno;
+	fibril_mutex_unlock(&q->lock);
+	return EOK;
+}
+
+/** Free a whole descriptor chain into the free list
+ *
+ * The chain is spliced into the list as it is, only its last descriptor
+ * gets rewritten.
+ *
+ * @param vdev[in]      VIRTIO device with the free list.
+ * @param num[in]       Index of the virtqueue with free list.
+ * @param head[in,out]  Head of the free list.
+ * @param descno[in]    First descriptor of the freed chain.
+ */
+void virtio_free_desc_chain(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
+    uint16_t descno)
+{
+	virtq_t *q = &vdev->queues[num];
+	fibril_mutex_lock(&q->lock);
+	uint16_t tail = descno;
+	uint16_t next;
+	while ((next = virtio_virtq_desc_get_next(vdev, num, tail)) !=
+	    (uint16_t) -1U)
+		tail = next;
+	virtio_virtq_desc_set(vdev, num, tail, 0, 0, VIRTQ_DESC_F_NEXT,
+	    *head);
+	*head = descno;
+	fibril_mutex_unlock(&q->lock);
+}
+
+/** Address of the used_event member following the available ring */
+static ioport16_t *virtq_used_event(virtq_t *q)
+{
+	return &q->avail->ring[q->queue_size];
+}
+
+/** Address of the avail_event member following the used ring */
+static ioport16_t *virtq_avail_event(virtq_t *q)
+{
+	return (ioport16_t *) &q->used->ring[q->queue_size];
+}
+
+/** Determine whether moving an index from @a old to @a new passes @a event */
+static bool virtq_need_event(uint16_t event, uint16_t new, uint16_t old)
+{
+	return (uint16_t) (new - event - 1) < (uint16_t) (new - old);
+}
+
+/** Flags marking a packed descriptor available in the current lap */
+static uint16_t virtq_packed_avail_flags(virtq_t *q)
+{
+	return q->avail_wrap ? VIRTQ_DESC_F_AVAIL : VIRTQ_DESC_F_USED;
+}
+
+/** Copy a descriptor chain into the ring of a packed virtqueue
+ *
+ * The head descriptor's flags are written last, so that the device never
+ * sees a partial chain. All descriptors of the chain carry the head
+ * descriptor number as the buffer ID.
+ */
+static void virtq_packed_add(virtq_t *q, uint16_t head)
+{
+	uint16_t head_slot = q->next_avail;
+	uint16_t head_flags = 0;
+	uint16_t len = 0;
+	uint16_t descno = head;
+
+	while (true) {
+		virtq_desc_t *d = &q->desc[descno];
+		virtq_pdesc_t *p = &q->ring[q->next_avail];
+		uint16_t dflags = pio_read_le16(&d->flags);
+		uint16_t flags = (dflags & (VIRTQ_DESC_F_NEXT |
+		    VIRTQ_DESC_F_WRITE)) | virtq_packed_avail_flags(q);
+
+		pio_write_le64(&p->addr, pio_read_le64(&d->addr));
+		pio_write_le32(&p->len, pio_read_le32(&d->len));
+		pio_write_le16(&p->id, head);
+		if (len == 0)
+			head_flags = flags;
+		else
+			pio_write_le16(&p->flags, flags);
+		len++;
+
+		if (++q->next_avail == q->queue_size) {
+			q->next_avail = 0;
+			q->avail_wrap = !q->avail_wrap;
+		}
+
+		if (!(dflags & VIRTQ_DESC_F_NEXT))
+			break;
+		descno = pio_read_le16(&d->next);
+	}
+
+	q->chain_len[head] = len;
+	q->added += len;
+
+	write_barrier();
+	pio_write_le16(&q->ring[head_slot].flags, head_flags);
+}
+
+/** Put a descriptor into the available ring without notifying the device
+ *
+ * The device learns about the descriptor with the next
+ * virtio_virtq_kick(), so that a batch of descriptors needs only one
+ * notification.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ * @param descno[in]  The descriptor
+ */
+void virtio_virtq_add_available(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
 {
 	virtq_t *q = &vdev->queues[num];
 
 	fibril_mutex_lock(&q->lock);
+	if (q->ring != NULL) {
+		virtq_packed_add(q, descno);
+		fibril_mutex_unlock(&q->lock);
+		return;
+	}
+
 	uint16_t idx = pio_read_le16(&q->avail->idx);
 	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
 	write_barrier();
 	pio_write_le16(&q->avail->idx, idx + 1);
-	write_barrier();
-	pio_write_le16(q->notify, num);
 	fibril_mutex_unlock(&q->lock);
 }
 
+/** Notify the device of the descriptors added to the available ring
+ *
+ * The notification is skipped when the device has asked not to be
+ * notified, either by VIRTQ_USED_F_NO_NOTIFY or, with
+ * VIRTIO_RING_F_EVENT_IDX, by its avail_event. Packed virtqueues carry
+ * the same information in the device event suppression structure.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ */
+void virtio_virtq_kick(virtio_dev_t *vdev, uint16_t num)
+{
+	virtq_t *q = &vdev->queues[num];
+	bool notify;
+
+	fibril_mutex_lock(&q->lock);
+
+	/* Make the index visible before reading the device's wishes */
+	memory_barrier();
+
+	if (q->ring != NULL) {
+		uint16_t new = q->next_avail;
+		uint16_t old = new - q->added;
+		uint16_t flags = pio_read_le16(&q->device_event->flags);
+
+		if (q->added == 0) {
+			notify = false;
+		} else if (flags == VIRTQ_PEVENT_F_DESC) {
+			uint16_t off_wrap =
+			    pio_read_le16(&q->device_event->off_wrap);
+			uint16_t event = off_wrap & ~VIRTQ_PEVENT_WRAP;
+
+			/* An event in the previous lap lies before zero */
+			if (((off_wrap & VIRTQ_PEVENT_WRAP) != 0) !=
+			    q->avail_wrap)
+				event -= q->queue_size;
+			notify = virtq_need_event(event, new, old);
+		} else {
+			notify = flags != VIRTQ_PEVENT_F_DISABLE;
+		}
+
+		q->added = 0;
+		if (notify)
+			pio_write_le16(q->notify, num);
+
+		fibril_mutex_unlock(&q->lock);
+		return;
+	}
+
+	uint16_t new = pio_read_le16(&q->avail->idx);
+	uint16_t old = q->kicked_idx;
+
+	if (new == old) {
+		notify = false;
+	} else if (vdev->event_idx) {
+		notify = virtq_need_event(pio_read_le16(virtq_avail_event(q)),
+		    new, old);
+	} else {
+		notify = (pio_read_le16(&q->used->flags) &
+		    VIRTQ_USED_F_NO_NOTIFY) == 0;
+	}
+
+	q->kicked_idx = new;
+	if (notify)
+		pio_write_le16(q->notify, num);
+
+	fibril_mutex_unlock(&q->lock);
+}
+
+void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+    uint16_t descno)
+{
+	virtio_virtq_add_available(vdev, num, descno);
+	virtio_virtq_kick(vdev, num);
+}
+
+/** Driver event suppression asking for an interrupt at the next used slot */
+static void virtq_packed_want_event(virtq_t *q)
+{
+	pio_write_le16(&q->driver_event->off_wrap, q->next_used |
+	    (q->used_wrap ? VIRTQ_PEVENT_WRAP : 0));
+}
+
+static bool virtq_packed_consume(virtio_dev_t *vdev, virtq_t *q,
+    uint16_t *descno, uint32_t *len)
+{
+	virtq_pdesc_t *p = &q->ring[q->next_used];
+	uint16_t flags = pio_read_le16(&p->flags);
+	bool avail = (flags & VIRTQ_DESC_F_AVAIL) != 0;
+	bool used = (flags & VIRTQ_DESC_F_USED) != 0;
+
+	if (avail != used || used != q->used_wrap)
+		return false;
+
+	/* Do not read the rest of the descriptor before its flags */
+	read_barrier();
+
+	*descno = pio_read_le16(&p->id);
+	*len = pio_read_le32(&p->len);
+
+	/* The device skips the rest of the chain */
+	q->next_used += q->chain_len[*descno];
+	if (q->next_used >= q->queue_size) {
+		q->next_used -= q->queue_size;
+		q->used_wrap = !q->used_wrap;
+	}
+
+	if (vdev->event_idx && !q->no_interrupt)
+		virtq_packed_want_event(q);
+
+	return true;
+}
+
 bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
     uint16_t *descno, uint32_t *len)
 {
 	virtq_t *q = &vdev->queues[num];
 
 	fibril_mutex_lock(&q->lock);
+	if (q->ring != NULL) {
+		bool found = virtq_packed_consume(vdev, q, descno, len);
+		fibril_mutex_unlock(&q->lock);
+		return found;
+	}
+
 	uint16_t last_idx = q->used_last_idx % q->queue_size;
 	if (last_idx == (pio_read_le16(&q->used->idx) % q->queue_size)) {
 		fibril_mutex_unlock(&q->lock);
@@ -201,21 +465,69 @@ bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
 	*len = pio_read_le32(&q->used->ring[last_idx].len);
 
 	q->used_last_idx++;
+
+	/* Ask for an interrupt when the next buffer is used */
+	if (vdev->event_idx && !q->no_interrupt)
+		pio_write_le16(virtq_used_event(q), q->used_last_idx);
+
 	fibril_mutex_unlock(&q->lock);
 
 	return true;
 }
 
+/** Ask the device to interrupt or not when it uses buffers of a virtqueue
+ *
+ * Suppressing the interrupts is only a hint, the device may still
+ * interrupt. After enabling the interrupts, the driver must check the used
+ * ring once more, buffers used before might not have interrupted.
+ *
+ * @param vdev[in]    VIRTIO device
+ * @param num[in]     Index of the virtqueue
+ * @param enable[in]  True to enable the interrupts
+ */
+void virtio_virtq_set_interrupt(virtio_dev_t *vdev, uint16_t num, bool enable)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	fibril_mutex_lock(&q->lock);
+	q->no_interrupt = !enable;
+	if (q->ring != NULL) {
+		uint16_t flags = VIRTQ_PEVENT_F_DISABLE;
+		if (enable && vdev->event_idx) {
+			virtq_packed_want_event(q);
+			flags = VIRTQ_PEVENT_F_DESC;
+		} else if (enable) {
+			flags = VIRTQ_PEVENT_F_ENABLE;
+		}
+		pio_write_le16(&q->driver_event->flags, flags);
+	} else if (vdev->event_idx) {
+		/*
+		 * The flags must stay zero, point used_event where the
+		 * device cannot get before we consume what it has used.
+		 */
+		pio_write_le16(virtq_used_event(q), enable ? q->used_last_idx :
+		    (uint16_t) (q->used_last_idx + q->queue_size));
+	} else {
+		pio_write_le16(&q->avail->flags, enable ? 0 :
+		    VIRTQ_AVAIL_F_NO_INTERRUPT);
+	}
+	memory_barrier();
+	fibril_mutex_unlock(&q->lock);
+}
+
 errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 {
 	virtq_t *q = &vdev->queues[num];
 	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
 
+	if (num >= pio_read_le16(&cfg->num_queues))
+		return ENOENT;
+
 	/* Program the queue of our interest */
 	pio_write_le16(&cfg->queue_select, num);
 
 	/* Trim the size of the queue as needed */
-	if (size > pio_read_16(&cfg->queue_size)) {
+	if (size > pio_read_le16(&cfg->queue_size)) {
 		ddf_msg(LVL_ERROR, "Virtq %u: not enough descriptors", num);
 		return ENOMEM;
 	}
@@ -224,20 +536,31 @@ errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 
 	size_t avail_offset = 0;
 	size_t used_offset = 0;
+	size_t mem_size;
 
 	/*
 	 * Compute the size of the needed DMA memory and also the offsets of
-	 * the individual components
+	 * the individual components. For a packed virtqueue these are the
+	 * descriptor ring and the driver and device event suppression
+	 * structures.
 	 */
-	size_t mem_size = sizeof(virtq_desc_t[size]);
-	mem_size = ALIGN_UP(mem_size, alignof(virtq_avail_t));
-	avail_offset = mem_size;
-	mem_size += sizeof(virtq_avail_t) + sizeof(ioport16_t[size]) +
-	    sizeof(ioport16_t);
-	mem_size = ALIGN_UP(mem_size, alignof(virtq_used_t));
-	used_offset = mem_size;
-	mem_size += sizeof(virtq_used_t) + sizeof(virtq_used_elem_t[size]) +
-	    sizeof(ioport16_t);
+	if (vdev->packed) {
+		mem_size = sizeof(virtq_pdesc_t[size]);
+		avail_offset = mem_size;
+		mem_size += sizeof(virtq_pevent_t);
+		used_offset = mem_size;
+		mem_size += sizeof(virtq_pevent_t);
+	} else {
+		mem_size = sizeof(virtq_desc_t[size]);
+		mem_size = ALIGN_UP(mem_size, alignof(virtq_avail_t));
+		avail_offset = mem_size;
+		mem_size += sizeof(virtq_avail_t) + sizeof(ioport16_t[size]) +
+		    sizeof(ioport16_t);
+		mem_size = ALIGN_UP(mem_size, alignof(virtq_used_t));
+		used_offset = mem_size;
+		mem_size += sizeof(virtq_used_t) +
+		    sizeof(virtq_used_elem_t[size]) + sizeof(ioport16_t);
+	}
 
 	/*
 	 * Allocate DMA memory for the virtqueues
@@ -254,13 +577,46 @@ errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 
 	q->size = mem_size;
 	q->queue_size = size;
-	q->desc = q->virt;
-	q->avail = q->virt + avail_offset;
-	q->used = q->virt + used_offset;
 	q->used_last_idx = 0;
+	q->kicked_idx = 0;
+	q->no_interrupt = false;
 
 	memset(q->virt, 0, q->size);
 
+	if (vdev->packed) {
+		q->desc = calloc(size, sizeof(virtq_desc_t));
+		q->chain_len = calloc(size, sizeof(uint16_t));
+		if (q->desc == NULL || q->chain_len == NULL) {
+			free(q->desc);
+			free(q->chain_len);
+			q->desc = NULL;
+			q->chain_len = NULL;
+			dmamem_unmap_anonymous(q->virt);
+			q->virt = NULL;
+			q->size = 0;
+			return ENOMEM;
+		}
+
+		q->ring = q->virt;
+		q->driver_event = q->virt + avail_offset;
+		q->device_event = q->virt + used_offset;
+		q->next_avail = 0;
+		q->avail_wrap = true;
+		q->next_used = 0;
+		q->used_wrap = true;
+		q->added = 0;
+
+		if (vdev->event_idx) {
+			virtq_packed_want_event(q);
+			pio_write_le16(&q->driver_event->flags,
+			    VIRTQ_PEVENT_F_DESC);
+		}
+	} else {
+		q->desc = q->virt;
+		q->avail = q->virt + avail_offset;
+		q->used = q->virt + used_offset;
+	}
+
 	/*
 	 * Write the configured addresses to device's common config
 	 */
@@ -277,6 +633,16 @@ errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 
 	ddf_msg(LVL_NOTE, "notification register: %p", q->notify);
 
+	/* Route the queue's interrupts */
+	if (vdev->msix) {
+		pio_write_le16(&cfg->queue_msix_vector, 0);
+		if (pio_read_le16(&cfg->queue_msix_vector) ==
+		    VIRTIO_MSI_NO_VECTOR) {
+			ddf_msg(LVL_ERROR, "Virtq %u: no MSI-X vector", num);
+			return EIO;
+		}
+	}
+
 	/* Enable the queue */
 	pio_write_le16(&cfg->queue_enable, 1);
 	ddf_msg(LVL_NOTE, "virtq %d set", num);
@@ -294,6 +660,14 @@ void virtio_virtq_teardown(virtio_dev_t *vdev, uint16_t num)
 	virtq_t *q = &vdev->queues[num];
 	if (q->size)
 		dmamem_unmap_anonymous(q->virt);
+
+	if (q->ring != NULL) {
+		free(q->desc);
+		free(q->chain_len);
+		q->desc = NULL;
+		q->chain_len = NULL;
+		q->ring = NULL;
+	}
 }
 
 /**
@@ -301,12 +675,32 @@ void virtio_virtq_teardown(virtio_dev_t *vdev, uint16_t num)
  * specification, steps 1 - 6.
  */
 errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
+{
+	return virtio_device_setup_start_opt(vdev, features, 0, NULL);
+}
+
+/**
+ * Perform device initialization as described in section 3.1.1 of the
+ * specification, steps 1 - 6, accepting optional features.
+ *
+ * @param vdev[in]       VIRTIO device.
+ * @param features[in]   Feature bits the driver requires.
+ * @param optional[in]   Feature bits the driver uses if the device offers
+ *                       them.
+ * @param accepted[out]  Feature bits accepted, may be NULL.
+ *
+ * @return  EOK on success, ENOTSUP if a required feature is missing.
+ */
+errno_t virtio_device_setup_start_opt(virtio_dev_t *vdev, uint32_t features,
+    uint32_t optional, uint32_t *accepted)
 {
 	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
 
-	/* 1. Reset the device */
+	/* 1. Reset the device and wait for the reset to complete */
 	uint8_t status = VIRTIO_DEV_STATUS_RESET;
 	pio_write_8(&cfg->device_status, status);
+	while (pio_read_8(&cfg->device_status) != VIRTIO_DEV_STATUS_RESET)
+		fibril_usleep(1000);
 
 	/* 2. Acknowledge we found the device */
 	status |= VIRTIO_DEV_STATUS_ACKNOWLEDGE;
@@ -329,10 +723,12 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 
 	if (features != (features & device_features))
 		return ENOTSUP;
+	features |= optional;
 	features &= device_features;
 
 	if (reserved_features != (reserved_features & device_reserved_features))
 		return ENOTSUP;
+	reserved_features |= VIRTIO_F_RING_PACKED;
 	reserved_features &= device_reserved_features;
 
 	/* 4. Write the accepted feature flags */
@@ -353,6 +749,11 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 	if (!(status & VIRTIO_DEV_STATUS_FEATURES_OK))
 		return ENOTSUP;
 
+	vdev->event_idx = (features & VIRTIO_RING_F_EVENT_IDX) != 0;
+	vdev->packed = (reserved_features & VIRTIO_F_RING_PACKED) != 0;
+
+	if (accepted != NULL)
+		*accepted = features;
 	return EOK;
 }
 
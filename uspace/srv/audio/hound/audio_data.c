@@ -86,106 +86,22 @@ void audio_data_unref(audio_data_t *adata)
 	}
 }
 
-/* Data link helpers */
-
-/** Audio data buffer list helper structure. */
-typedef struct {
-	link_t link;
-	audio_data_t *adata;
-	size_t position;
-} audio_data_link_t;
-
-/** List instance helper function.
- * @param l link
- * @return valid pointer to data link structure, NULL on failure.
- */
-static inline audio_data_link_t *audio_data_link_list_instance(link_t *l)
-{
-	return l ? list_get_instance(l, audio_data_link_t, link) : NULL;
-}
-
-/**
- * Create a new audio data link.
- * @param adata Audio data to store.
- * @return Valid pointer to a new audio data link structure, NULL on failure.
- */
-static audio_data_link_t *audio_data_link_create(audio_data_t *adata)
-{
-	assert(adata);
-	audio_data_link_t *link = malloc(sizeof(audio_data_link_t));
-	if (link) {
-		audio_data_addref(adata);
-		link->adata = adata;
-		link->position = 0;
-	}
-	return link;
-}
-
-/**
- * Destroy audio data link.
- * @param link The link to destroy.
- *
- * Releases data reference.
- */
-static void audio_data_link_destroy(audio_data_link_t *link)
-{
-	assert(link);
-	assert(!link_in_use(&link->link));
-	audio_data_unref(link->adata);
-	free(link);
-}
-
-/**
- * Data link buffer start helper function.
- * @param alink audio data link
- * @return pointer to the beginning of data buffer.
- */
-static inline const void *audio_data_link_start(audio_data_link_t *alink)
-{
-	assert(alink);
-	assert(alink->adata);
-	return alink->adata->data + alink->position;
-}
-
-/**
- * Data link remaining size getter.
- * @param alink audio data link
- * @return Remaining size of valid data in the buffer.
- */
-static inline size_t audio_data_link_remain_size(audio_data_link_t *alink)
-{
-	assert(alink);
-	assert(alink->adata);
-	assert(alink->position <= alink->adata->size);
-	return alink->adata->size - alink->position;
-}
-
-/**
- * Data link remaining frames getter.
- * @param alink audio data link
- * @return Number of remaining frames in the buffer.
- */
-static inline size_t audio_data_link_available_frames(audio_data_link_t *alink)
-{
-	assert(alink);
-	assert(alink->adata);
-	return pcm_format_size_to_frames(audio_data_link_remain_size(alink),
-	    &alink->adata->format);
-}
-
 /* Audio Pipe */
 
 /**
  * Initialize audio pipe structure.
  * @param pipe The pipe structure to initialize.
+ * @param capacity Maximum number of buffers in the pipe.
+ * @return Error code.
  */
-void audio_pipe_init(audio_pipe_t *pipe)
+errno_t audio_pipe_init(audio_pipe_t *pipe, size_t capacity)
 {
 	assert(pipe);
-	list_initialize(&pipe->list);
-	fibril_mutex_initialize(&pipe->guard);
-	pipe->frames = 0;
-	pipe->bytes = 0;
+	pipe->current = NULL;
+	pipe->position = 0;
+	atomic_init(&pipe->frames, 0);
+	atomic_init(&pipe->bytes, 0);
+	return mpmc_ring_initialize(&pipe->ring, capacity, 0);
 }
 
 /**
@@ -195,31 +111,41 @@ void audio_pipe_init(audio_pipe_t *pipe)
 void audio_pipe_fini(audio_pipe_t *pipe)
 {
 	assert(pipe);
-	while (!list_empty(&pipe->list)) {
-		audio_data_t *adata = audio_pipe_pop(pipe);
+	audio_data_t *adata;
+	while ((adata = audio_pipe_pop(pipe)))
 		audio_data_unref(adata);
-	}
+	mpmc_ring_destroy(&pipe->ring);
 }
 
 /**
  * Add new audio data to a pipe.
  * @param pipe The target pipe.
  * @param data The data.
- * @return Error code.
+ * @return Error code, EOVERFLOW if the pipe is full.
+ *
+ * Must not be called concurrently with another push to the same pipe.
  */
 errno_t audio_pipe_push(audio_pipe_t *pipe, audio_data_t *data)
 {
 	assert(pipe);
 	assert(data);
-	audio_data_link_t *alink = audio_data_link_create(data);
-	if (!alink)
-		return ENOMEM;
-
-	fibril_mutex_lock(&pipe->guard);
-	list_append(&alink->link, &pipe->list);
-	pipe->bytes += audio_data_link_remain_size(alink);
-	pipe->frames += audio_data_link_available_frames(alink);
-	fibril_mutex_unlock(&pipe->guard);
+	const size_t frames = pcm_format_size_to_frames(data->size,
+	    &data->format);
+
+	/* Account first, the consumer may take the data right away */
+	atomic_fetch_add_explicit(&pipe->bytes, data->size,
+	    memory_order_relaxed);
+	atomic_fetch_add_explicit(&pipe->frames, frames, memory_order_relaxed);
+
+	audio_data_addref(data);
+	if (!mpmc_ring_try_push(&pipe->ring, data)) {
+		audio_data_unref(data);
+		atomic_fetch_sub_explicit(&pipe->bytes, data->size,
+		    memory_order_relaxed);
+		atomic_fetch_sub_explicit(&pipe->frames, frames,
+		    memory_order_relaxed);
+		return EOVERFLOW;
+	}
 	return EOK;
 }
 
@@ -227,23 +153,25 @@ errno_t audio_pipe_push(audio_pipe_t *pipe, audio_data_t *data)
  * Retrieve data form a audio pipe.
  * @param pipe THe target pipe.
  * @return Valid pointer to audio data, NULL if the pipe was empty.
+ *
+ * Must not be called concurrently with another pop or mix on the same pipe.
  */
 audio_data_t *audio_pipe_pop(audio_pipe_t *pipe)
 {
 	assert(pipe);
-	fibril_mutex_lock(&pipe->guard);
-	audio_data_t *adata = NULL;
-	link_t *l = list_first(&pipe->list);
-	if (l) {
-		audio_data_link_t *alink = audio_data_link_list_instance(l);
-		list_remove(&alink->link);
-		pipe->bytes -= audio_data_link_remain_size(alink);
-		pipe->frames -= audio_data_link_available_frames(alink);
-		adata = alink->adata;
-		audio_data_addref(adata);
-		audio_data_link_destroy(alink);
-	}
-	fibril_mutex_unlock(&pipe->guard);
+	audio_data_t *adata = pipe->current;
+	size_t position = pipe->position;
+
+	pipe->current = NULL;
+	pipe->position = 0;
+	if (!adata && !mpmc_ring_try_pop(&pipe->ring, (void **) &adata))
+		return NULL;
+
+	const size_t remain = adata->size - position;
+	atomic_fetch_sub_explicit(&pipe->bytes, remain, memory_order_relaxed);
+	atomic_fetch_sub_explicit(&pipe->frames,
+	    pcm_format_size_to_frames(remain, &adata->format),
+	    memory_order_relaxed);
 	return adata;
 }
 
@@ -254,6 +182,8 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe)
  * @param size Target buffer size.
  * @param format Target data format.
  * @return Size of the target buffer used.
+ *
+ * Must not be called concurrently with another pop or mix on the same pipe.
  */
 size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
     size_t size, const pcm_format_t *f)
@@ -264,43 +194,46 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
 	size_t needed_frames = pcm_format_size_to_frames(size, f);
 	size_t copied_size = 0;
 
-	fibril_mutex_lock(&pipe->guard);
-	while (needed_frames > 0 && !list_empty(&pipe->list)) {
+	while (needed_frames > 0) {
 		/* Get first audio chunk */
-		link_t *l = list_first(&pipe->list);
-		audio_data_link_t *alink = audio_data_link_list_instance(l);
+		if (!pipe->current) {
+			if (!mpmc_ring_try_pop(&pipe->ring,
+			    (void **) &pipe->current))
+				break;
+			pipe->position = 0;
+		}
+		audio_data_t *adata = pipe->current;
 
 		/* Get audio chunk metadata */
 		const size_t src_frame_size =
-		    pcm_format_frame_size(&alink->adata->format);
+		    pcm_format_frame_size(&adata->format);
 		const size_t available_frames =
-		    audio_data_link_available_frames(alink);
+		    (adata->size - pipe->position) / src_frame_size;
 		const size_t copy_frames = min(available_frames, needed_frames);
 		const size_t dst_copy_size = copy_frames * dst_frame_size;
 		const size_t src_copy_size = copy_frames * src_frame_size;
 
-		assert(src_copy_size <= audio_data_link_remain_size(alink));
-
 		/* Copy audio data */
 		pcm_format_convert_and_mix(data, dst_copy_size,
-		    audio_data_link_start(alink), src_copy_size,
-		    &alink->adata->format, f);
+		    adata->data + pipe->position, src_copy_size,
+		    &adata->format, f);
 
 		/* Update values */
 		needed_frames -= copy_frames;
 		copied_size += dst_copy_size;
 		data += dst_copy_size;
-		alink->position += src_copy_size;
-		pipe->bytes -= src_copy_size;
-		pipe->frames -= copy_frames;
-		if (audio_data_link_remain_size(alink) == 0) {
-			list_remove(&alink->link);
-			audio_data_link_destroy(alink);
+		pipe->position += src_copy_size;
+		atomic_fetch_sub_explicit(&pipe->bytes, src_copy_size,
+		    memory_order_relaxed);
+		atomic_fetch_sub_explicit(&pipe->frames, copy_frames,
+		    memory_order_relaxed);
+		if (pipe->position == adata->size) {
+			pipe->current = NULL;
+			audio_data_unref(adata);
 		} else {
 			assert(needed_frames == 0);
 		}
 	}
-	fibril_mutex_unlock(&pipe->guard);
 	return copied_size;
 }
 
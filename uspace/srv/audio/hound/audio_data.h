@@ -36,12 +36,15 @@
 #ifndef AUDIO_DATA_H_
 #define AUDIO_DATA_H_
 
-#include <adt/list.h>
+#include <adt/mpmc_ring.h>
 #include <refcount.h>
 #include <errno.h>
-#include <fibril_synch.h>
+#include <stdatomic.h>
 #include <pcm/format.h>
 
+/** Default number of buffers a pipe can hold */
+#define AUDIO_PIPE_CAPACITY  64
+
 /** Reference counted audio buffer */
 typedef struct {
 	/** Audio data */
@@ -54,16 +57,24 @@ typedef struct {
 	atomic_refcount_t refcount;
 } audio_data_t;
 
-/** Audio data pipe structure */
+/** Audio data pipe structure
+ *
+ * The pipe has a single producer and a single consumer. Buffers are
+ * passed through a preallocated lock-free ring so that neither side
+ * blocks or allocates memory; the consumer owns the buffer it is
+ * currently mixing.
+ */
 typedef struct {
-	/** List of audio data buffers */
-	list_t list;
+	/** Queued audio data buffers */
+	mpmc_ring_t ring;
+	/** Partially consumed buffer, owned by the consumer */
+	audio_data_t *current;
+	/** Consumed part of @c current */
+	size_t position;
 	/** Total size of all buffers */
-	size_t bytes;
+	atomic_size_t bytes;
 	/** Total frames stored in all buffers */
-	size_t frames;
-	/** List access synchronization */
-	fibril_mutex_t guard;
+	atomic_size_t frames;
 } audio_pipe_t;
 
 audio_data_t *audio_data_create(void *data, size_t size,
@@ -71,7 +82,7 @@ audio_data_t *audio_data_create(void *data, size_t size,
 void audio_data_addref(audio_data_t *adata);
 void audio_data_unref(audio_data_t *adata);
 
-void audio_pipe_init(audio_pipe_t *pipe);
+errno_t audio_pipe_init(audio_pipe_t *pipe, size_t capacity);
 void audio_pipe_fini(audio_pipe_t *pipe);
 
 errno_t audio_pipe_push(audio_pipe_t *pipe, audio_data_t *data);
@@ -88,7 +99,7 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *buffer, size_t size,
 static inline size_t audio_pipe_bytes(audio_pipe_t *pipe)
 {
 	assert(pipe);
-	return pipe->bytes;
+	return atomic_load_explicit(&pipe->bytes, memory_order_relaxed);
 }
 
 /**
@@ -99,7 +110,7 @@ static inline size_t audio_pipe_bytes(audio_pipe_t *pipe)
 static inline size_t audio_pipe_frames(audio_pipe_t *pipe)
 {
 	assert(pipe);
-	return pipe->frames;
+	return atomic_load_explicit(&pipe->frames, memory_order_relaxed);
 }
 
 /**
@@ -43,20 +43,24 @@
 #include <str.h>
 #include <str_error.h>
 #include <as.h>
+#include <fibril.h>
 
 #include "audio_device.h"
 #include "log.h"
 
-/* hardwired to provide ~21ms per fragment */
-#define BUFFER_PARTS   16
+/** Fewest fragments per buffer, we stay one fragment ahead of the device */
+#define BUFFER_PARTS_MIN  4
+/** Most fragments per buffer */
+#define BUFFER_PARTS_MAX  256
 
 static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new);
 static errno_t device_source_connection_callback(audio_source_t *source, bool new);
 static void device_event_callback(ipc_call_t *icall, void *arg);
 static errno_t device_check_format(audio_sink_t *sink);
-static errno_t get_buffer(audio_device_t *dev);
+static errno_t get_buffer(audio_device_t *dev, const pcm_format_t *f);
 static errno_t release_buffer(audio_device_t *dev);
 static void advance_buffer(audio_device_t *dev, size_t size);
+static errno_t device_poll_fibril(void *arg);
 static inline bool is_running(audio_device_t *dev)
 {
 	assert(dev);
@@ -69,13 +73,20 @@ static inline bool is_running(audio_device_t *dev)
  * @param dev The structure to initialize.
  * @param id Location service id of the device driver.
  * @param name Name of the device.
+ * @param period Requested mixing period in microseconds.
+ * @param poll Poll buffer position if the device supports it.
  * @return Error code.
  */
-errno_t audio_device_init(audio_device_t *dev, service_id_t id, const char *name)
+errno_t audio_device_init(audio_device_t *dev, service_id_t id, const char *name,
+    usec_t period, bool poll)
 {
 	assert(dev);
 	link_initialize(&dev->link);
 	dev->id = id;
+	dev->period = period;
+	dev->poll = poll;
+	dev->polling = false;
+	dev->poll_gen = 0;
 	dev->name = str_dup(name);
 	dev->sess = audio_pcm_open_service(id);
 	if (!dev->sess) {
@@ -159,7 +170,7 @@ static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new)
 	if (new && list_count(&sink->connections) == 1) {
 		log_verbose("First connection on device sink '%s'", sink->name);
 
-		errno_t ret = get_buffer(dev);
+		errno_t ret = get_buffer(dev, &dev->sink.format);
 		if (ret != EOK) {
 			log_error("Failed to get device buffer: %s",
 			    str_error(ret));
@@ -180,10 +191,20 @@ static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new)
 		audio_sink_mix_inputs(&dev->sink, dev->buffer.position, size);
 		advance_buffer(dev, size);
 
+		/* Devices that know their position need no fragment events */
+		sysarg_t pos_cap = 0;
+		if (dev->poll) {
+			ret = audio_pcm_query_cap(dev->sess,
+			    AUDIO_CAP_BUFFER_POS, &pos_cap);
+			if (ret != EOK)
+				pos_cap = 0;
+		}
+
 		const unsigned frames = dev->buffer.fragment_size /
 		    pcm_format_frame_size(&dev->sink.format);
 		log_verbose("Fragment frame count %u", frames);
-		ret = audio_pcm_start_playback_fragment(dev->sess, frames,
+		ret = audio_pcm_start_playback_fragment(dev->sess,
+		    pos_cap ? 0 : frames,
 		    dev->sink.format.channels, dev->sink.format.sampling_rate,
 		    dev->sink.format.sample_format);
 		if (ret != EOK) {
@@ -192,11 +213,24 @@ static errno_t device_sink_connection_callback(audio_sink_t *sink, bool new)
 			release_buffer(dev);
 			return ret;
 		}
+
+		if (pos_cap) {
+			fid_t fid = fibril_create(device_poll_fibril, dev);
+			if (fid == 0) {
+				log_error("Failed to create polling fibril");
+				audio_pcm_stop_playback(dev->sess);
+				return ENOMEM;
+			}
+			dev->polling = true;
+			++dev->poll_gen;
+			fibril_add_ready(fid);
+		}
 	}
 	if (list_count(&sink->connections) == 0) {
 		assert(!new);
 		log_verbose("Removed last connection on device sink '%s'",
 		    sink->name);
+		dev->polling = false;
 		errno_t ret = audio_pcm_stop_playback(dev->sess);
 		if (ret != EOK) {
 			log_error("Failed to stop playback: %s",
@@ -221,7 +255,7 @@ static errno_t device_source_connection_callback(audio_source_t *source, bool ne
 	assert(source);
 	audio_device_t *dev = source->private_data;
 	if (new && list_count(&source->connections) == 1) {
-		errno_t ret = get_buffer(dev);
+		errno_t ret = get_buffer(dev, &dev->source.format);
 		if (ret != EOK) {
 			log_error("Failed to get device buffer: %s",
 			    str_error(ret));
@@ -321,6 +355,61 @@ static void device_event_callback(ipc_call_t *icall, void *arg)
 	}
 }
 
+/**
+ * Mix device buffer fragments as the device position advances.
+ * @param arg Audio device.
+ * @return Error code.
+ *
+ * Replaces fragment events for devices that report their buffer position.
+ * Wakes up once per fragment and keeps the buffer two fragments ahead
+ * of the device, the same as the event driven playback.
+ */
+static errno_t device_poll_fibril(void *arg)
+{
+	audio_device_t *dev = arg;
+	assert(dev);
+	const unsigned gen = dev->poll_gen;
+	const size_t fragment = dev->buffer.fragment_size;
+	const usec_t fragment_usec =
+	    pcm_format_size_to_usec(fragment, &dev->sink.format);
+
+	log_verbose("Polling device '%s' every %lld us", dev->name,
+	    fragment_usec);
+	while (true) {
+		fibril_usleep(fragment_usec);
+		if (!dev->polling || dev->poll_gen != gen)
+			break;
+
+		size_t pos;
+		const errno_t ret = audio_pcm_get_buffer_pos(dev->sess, &pos);
+		if (ret != EOK) {
+			log_error("Failed to get buffer position: %s",
+			    str_error(ret));
+			break;
+		}
+		/* The buffer may be gone while we waited for the answer */
+		if (!dev->polling || dev->poll_gen != gen || !is_running(dev))
+			break;
+
+		const size_t wpos = dev->buffer.position - dev->buffer.base;
+		size_t ahead = (wpos + dev->buffer.size - pos) %
+		    dev->buffer.size;
+		if (ahead < fragment) {
+			atomic_fetch_add_explicit(&dev->sink.underruns, 1,
+			    memory_order_relaxed);
+		}
+		while (ahead < 2 * fragment) {
+			/* We never cross the end of the buffer here */
+			audio_sink_mix_inputs(&dev->sink,
+			    dev->buffer.position, fragment);
+			advance_buffer(dev, fragment);
+			ahead += fragment;
+		}
+	}
+	log_verbose("Stopped polling device '%s'", dev->name);
+	return EOK;
+}
+
 /**
  * Test format against hardware limits.
  * @param sink audio playback device.
@@ -339,12 +428,41 @@ static errno_t device_check_format(audio_sink_t *sink)
 	    &sink->format.sampling_rate, &sink->format.sample_format);
 }
 
+/**
+ * Split device buffer into fragments of at most one mixing period.
+ * @param dev Audio device.
+ * @param f Format of the transferred data.
+ *
+ * The number of fragments is a power of two so that fragments of
+ * power-of-two sized buffers stay frame aligned and cover the whole buffer.
+ */
+static void set_fragment_size(audio_device_t *dev, const pcm_format_t *f)
+{
+	const size_t frame_size = pcm_format_frame_size(f);
+	const size_t period_size = frame_size *
+	    ((uint64_t) f->sampling_rate * dev->period / 1000000);
+	unsigned parts = BUFFER_PARTS_MIN;
+
+	while (parts < BUFFER_PARTS_MAX &&
+	    dev->buffer.size / parts > period_size)
+		parts *= 2;
+	while (parts > BUFFER_PARTS_MIN &&
+	    (dev->buffer.size % parts != 0 ||
+	    (dev->buffer.size / parts) % frame_size != 0))
+		parts /= 2;
+
+	dev->buffer.fragment_size = dev->buffer.size / parts;
+	log_verbose("Device '%s' uses %u fragments of %zu bytes", dev->name,
+	    parts, dev->buffer.fragment_size);
+}
+
 /**
  * Get access to device buffer.
  * @param dev Audio device.
+ * @param f Format of the transferred data.
  * @return Error code.
  */
-static errno_t get_buffer(audio_device_t *dev)
+static errno_t get_buffer(audio_device_t *dev, const pcm_format_t *f)
 {
 	assert(dev);
 	if (!dev->sess) {
@@ -363,8 +481,8 @@ static errno_t get_buffer(audio_device_t *dev)
 	    &preferred_size);
 	if (ret == EOK) {
 		dev->buffer.size = preferred_size;
-		dev->buffer.fragment_size = dev->buffer.size / BUFFER_PARTS;
 		dev->buffer.position = dev->buffer.base;
+		set_fragment_size(dev, f);
 	}
 	return ret;
 
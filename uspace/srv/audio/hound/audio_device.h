@@ -40,7 +40,9 @@
 #include <async.h>
 #include <fibril_synch.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <ipc/loc.h>
+#include <time.h>
 #include <audio_pcm_iface.h>
 
 #include "audio_source.h"
@@ -56,6 +58,14 @@ typedef struct {
 	audio_pcm_sess_t *sess;
 	/** Device name */
 	char *name;
+	/** Requested mixing period in microseconds */
+	usec_t period;
+	/** Poll buffer position instead of waiting for fragment events */
+	bool poll;
+	/** Playback is driven by the polling fibril */
+	bool polling;
+	/** Incremented on every start of the polling fibril */
+	unsigned poll_gen;
 	/** Device buffer */
 	struct {
 		void *base;
@@ -75,7 +85,8 @@ static inline audio_device_t *audio_device_list_instance(link_t *l)
 	return l ? list_get_instance(l, audio_device_t, link) : NULL;
 }
 
-errno_t audio_device_init(audio_device_t *dev, service_id_t id, const char *name);
+errno_t audio_device_init(audio_device_t *dev, service_id_t id, const char *name,
+    usec_t period, bool poll);
 void audio_device_fini(audio_device_t *dev);
 audio_source_t *audio_device_get_source(audio_device_t *dev);
 audio_sink_t *audio_device_get_sink(audio_device_t *dev);
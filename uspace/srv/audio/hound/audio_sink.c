@@ -72,6 +72,8 @@ errno_t audio_sink_init(audio_sink_t *sink, const char *name, void *private_data
 	sink->connection_change = connection_change;
 	sink->check_format = check_format;
 	sink->data_available = data_available;
+	atomic_init(&sink->underruns, 0);
+	atomic_init(&sink->overruns, 0);
 	log_verbose("Initialized sink (%p) '%s'", sink, sink->name);
 	return EOK;
 }
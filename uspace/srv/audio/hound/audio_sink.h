@@ -41,6 +41,7 @@
 #include <stdbool.h>
 #include <fibril.h>
 #include <pcm/format.h>
+#include <stdatomic.h>
 
 #include "audio_source.h"
 
@@ -64,6 +65,10 @@ struct audio_sink {
 	errno_t (*check_format)(audio_sink_t *);
 	/** new data notifier */
 	errno_t (*data_available)(audio_sink_t *);
+	/** Number of times a connection could not provide enough data */
+	atomic_size_t underruns;
+	/** Number of buffers dropped because a connection was full */
+	atomic_size_t overruns;
 };
 
 /**
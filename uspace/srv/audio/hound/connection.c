@@ -53,7 +53,10 @@ connection_t *connection_create(audio_source_t *source, audio_sink_t *sink)
 	assert(sink);
 	connection_t *conn = malloc(sizeof(connection_t));
 	if (conn) {
-		audio_pipe_init(&conn->fifo);
+		if (audio_pipe_init(&conn->fifo, AUDIO_PIPE_CAPACITY) != EOK) {
+			free(conn);
+			return NULL;
+		}
 		link_initialize(&conn->source_link);
 		link_initialize(&conn->sink_link);
 		link_initialize(&conn->hound_link);
@@ -117,9 +120,12 @@ errno_t connection_add_source_data(connection_t *connection, void *data,
 	    audio_pipe_bytes(&connection->fifo));
 	size_t ret =
 	    audio_pipe_mix_data(&connection->fifo, data, size, &format);
-	if (ret != size)
+	if (ret != size) {
+		atomic_fetch_add_explicit(&connection->sink->underruns, 1,
+		    memory_order_relaxed);
 		log_warning("Connection failed to provide enough data %zd/%zu",
 		    ret, size);
+	}
 	return EOK;
 }
 /**
@@ -134,6 +140,10 @@ errno_t connection_push_data(connection_t *connection,
 	assert(connection);
 	assert(adata);
 	const errno_t ret = audio_pipe_push(&connection->fifo, adata);
+	if (ret == EOVERFLOW) {
+		atomic_fetch_add_explicit(&connection->sink->overruns, 1,
+		    memory_order_relaxed);
+	}
 	if (ret == EOK && connection->sink->data_available)
 		connection->sink->data_available(connection->sink);
 	return ret;
@@ -161,11 +161,17 @@ static void hound_remove_source_internal(hound_t *hound, audio_source_t *source)
 /**
  * Initialize hound structure.
  * @param hound The structure to initialize.
+ * @param period Mixing period of devices in microseconds.
+ * @param poll Poll buffer position of devices that support it.
  * @return Error code.
  */
-errno_t hound_init(hound_t *hound)
+errno_t hound_init(hound_t *hound, usec_t period, bool poll)
 {
 	assert(hound);
+	if (period < HOUND_PERIOD_MIN)
+		return EINVAL;
+	hound->period = period;
+	hound->poll = poll;
 	fibril_mutex_initialize(&hound->list_guard);
 	list_initialize(&hound->devices);
 	list_initialize(&hound->contexts);
@@ -284,7 +290,8 @@ errno_t hound_add_device(hound_t *hound, service_id_t id, const char *name)
 		return ENOMEM;
 	}
 
-	const errno_t ret = audio_device_init(dev, id, name);
+	const errno_t ret = audio_device_init(dev, id, name, hound->period,
+	    hound->poll);
 	if (ret != EOK) {
 		log_debug("Failed to initialize new audio device: %s",
 		    str_error(ret));
@@ -491,6 +498,33 @@ errno_t hound_list_sinks(hound_t *hound, char ***list, size_t *size)
 	return ret;
 }
 
+/**
+ * Get xrun counters of a sink.
+ * @param[in] hound The hound structure.
+ * @param[in] sink_name Sink string identifier.
+ * @param[out] underruns Number of times a connection ran out of data.
+ * @param[out] overruns Number of buffers dropped by full connections.
+ * @return Error code.
+ */
+errno_t hound_get_xruns(hound_t *hound, const char *sink_name,
+    size_t *underruns, size_t *overruns)
+{
+	assert(hound);
+	if (!sink_name || !underruns || !overruns)
+		return EINVAL;
+
+	fibril_mutex_lock(&hound->list_guard);
+	audio_sink_t *sink = find_sink_by_name(&hound->sinks, sink_name);
+	if (sink) {
+		*underruns = atomic_load_explicit(&sink->underruns,
+		    memory_order_relaxed);
+		*overruns = atomic_load_explicit(&sink->overruns,
+		    memory_order_relaxed);
+	}
+	fibril_mutex_unlock(&hound->list_guard);
+	return sink ? EOK : ENOENT;
+}
+
 /**
  * List all connections
  * @param[in] hound The hound structure.
@@ -42,12 +42,18 @@
 #include <errno.h>
 #include <fibril_synch.h>
 #include <pcm/format.h>
+#include <time.h>
 #include <hound/protocol.h>
 
 #include "hound_ctx.h"
 #include "audio_source.h"
 #include "audio_sink.h"
 
+/** Default mixing period in microseconds */
+#define HOUND_PERIOD_DEFAULT  10000
+/** Shortest supported mixing period in microseconds */
+#define HOUND_PERIOD_MIN  2000
+
 /** The main Hound structure */
 typedef struct {
 	/** List access guard */
@@ -62,9 +68,13 @@ typedef struct {
 	list_t sinks;
 	/** Existing connections. */
 	list_t connections;
+	/** Mixing period of new devices in microseconds */
+	usec_t period;
+	/** Poll buffer position of new devices instead of using interrupts */
+	bool poll;
 } hound_t;
 
-errno_t hound_init(hound_t *hound);
+errno_t hound_init(hound_t *hound, usec_t period, bool poll);
 errno_t hound_add_ctx(hound_t *hound, hound_ctx_t *ctx);
 errno_t hound_remove_ctx(hound_t *hound, hound_ctx_t *ctx);
 hound_ctx_t *hound_get_ctx_by_id(hound_t *hound, hound_context_id_t id);
@@ -80,6 +90,8 @@ errno_t hound_remove_source(hound_t *hound, audio_source_t *source);
 errno_t hound_remove_sink(hound_t *hound, audio_sink_t *sink);
 errno_t hound_connect(hound_t *hound, const char *source_name, const char *sink_name);
 errno_t hound_disconnect(hound_t *hound, const char *source_name, const char *sink_name);
+errno_t hound_get_xruns(hound_t *hound, const char *sink_name,
+    size_t *underruns, size_t *overruns);
 
 #endif
 
@@ -249,7 +249,10 @@ hound_ctx_stream_t *hound_ctx_create_stream(hound_ctx_t *ctx, int flags,
 	assert(ctx);
 	hound_ctx_stream_t *stream = malloc(sizeof(hound_ctx_stream_t));
 	if (stream) {
-		audio_pipe_init(&stream->fifo);
+		if (audio_pipe_init(&stream->fifo, AUDIO_PIPE_CAPACITY) != EOK) {
+			free(stream);
+			return NULL;
+		}
 		link_initialize(&stream->link);
 		fibril_mutex_initialize(&stream->guard);
 		fibril_condvar_initialize(&stream->change);
@@ -303,6 +306,10 @@ errno_t hound_ctx_stream_write(hound_ctx_stream_t *stream, void *data,
 	if (stream->allowed_size && size > stream->allowed_size)
 		return EINVAL;
 
+	audio_data_t *adata = audio_data_create(data, size, stream->format);
+	if (!adata)
+		return ENOMEM;
+
 	fibril_mutex_lock(&stream->guard);
 	while (stream->allowed_size &&
 	    (audio_pipe_bytes(&stream->fifo) + size > stream->allowed_size)) {
@@ -310,9 +317,12 @@ errno_t hound_ctx_stream_write(hound_ctx_stream_t *stream, void *data,
 
 	}
 
-	const errno_t ret =
-	    audio_pipe_push_data(&stream->fifo, data, size, stream->format);
+	/* The pipe may also run out of slots for many small buffers */
+	errno_t ret;
+	while ((ret = audio_pipe_push(&stream->fifo, adata)) == EOVERFLOW)
+		fibril_condvar_wait(&stream->change, &stream->guard);
 	fibril_mutex_unlock(&stream->guard);
+	audio_data_unref(adata);
 	if (ret == EOK)
 		fibril_condvar_signal(&stream->change);
 	return ret;
@@ -360,8 +370,9 @@ size_t hound_ctx_stream_add_self(hound_ctx_stream_t *stream, void *data,
     size_t size, const pcm_format_t *f)
 {
 	assert(stream);
-	fibril_mutex_lock(&stream->guard);
+	/* The pipe is lock-free, the guard only orders the wakeup */
 	const size_t ret = audio_pipe_mix_data(&stream->fifo, data, size, f);
+	fibril_mutex_lock(&stream->guard);
 	fibril_condvar_signal(&stream->change);
 	fibril_mutex_unlock(&stream->guard);
 	return ret;
@@ -39,10 +39,12 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <str.h>
 #include <str_error.h>
 #include <hound/server.h>
 #include <hound/protocol.h>
 #include <task.h>
+#include <rtsched.h>
 
 #include "hound.h"
 
@@ -50,6 +52,11 @@
 #define NAME "hound"
 #define CATEGORY "audio-pcm"
 
+/** Real-time priority of the mixing thread */
+#define HOUND_RT_PRIO  (RT_PRIO_MAX - 9)
+/** Share of each period the mixing thread may use, in percent */
+#define HOUND_RT_LOAD  20
+
 #include "log.h"
 
 extern hound_server_iface_t hound_iface;
@@ -66,16 +73,57 @@ static void scan_for_devices(void *arg)
 	hound_server_devices_iterate(device_callback);
 }
 
+static void print_syntax(void)
+{
+	printf("Syntax: %s [--period <msec>] [--poll]\n", NAME);
+	printf("\t--period <msec>  Mixing period (default %u ms)\n",
+	    HOUND_PERIOD_DEFAULT / 1000);
+	printf("\t--poll           Follow device buffer position instead of "
+	    "using interrupts\n");
+}
+
 int main(int argc, char **argv)
 {
+	usec_t period = HOUND_PERIOD_DEFAULT;
+	bool poll = false;
+
 	printf("%s: HelenOS sound service\n", NAME);
 
+	for (int i = 1; i < argc; i++) {
+		if (str_cmp(argv[i], "--period") == 0 && i + 1 < argc) {
+			unsigned msec;
+			if (str_uint32_t(argv[++i], NULL, 10, true, &msec) != EOK ||
+			    MSEC2USEC(msec) < HOUND_PERIOD_MIN) {
+				printf(NAME ": Period must be at least %u ms.\n",
+				    HOUND_PERIOD_MIN / 1000);
+				return 1;
+			}
+			period = MSEC2USEC(msec);
+		} else if (str_cmp(argv[i], "--poll") == 0) {
+			poll = true;
+		} else {
+			print_syntax();
+			return 1;
+		}
+	}
+
 	if (log_init(NAME) != EOK) {
 		printf(NAME ": Failed to initialize logging.\n");
 		return 1;
 	}
 
-	errno_t ret = hound_init(&hound);
+	/*
+	 * Device buffers are mixed by the main thread, make it meet the
+	 * device deadlines even when the system is loaded.
+	 */
+	errno_t ret = thread_set_realtime(HOUND_RT_PRIO,
+	    period * HOUND_RT_LOAD / 100, period);
+	if (ret != EOK) {
+		log_warning("Failed to enter real-time class: %s",
+		    str_error(ret));
+	}
+
+	ret = hound_init(&hound, period, poll);
 	if (ret != EOK) {
 		log_fatal("Failed to initialize hound structure: %s",
 		    str_error(ret));
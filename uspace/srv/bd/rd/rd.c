@@ -54,6 +54,10 @@
 #include <loc.h>
 #include <macros.h>
 #include <inttypes.h>
+#include <byteorder.h>
+#include <inflate.h>
+#include <mem.h>
+#include <stdlib.h>
 
 #define NAME  "rd"
 
@@ -66,12 +70,52 @@ static size_t rd_size;
 /** Block size */
 static const size_t block_size = 512;
 
+/** Compressed RAM disk image magic ('HRDZ') */
+#define RDZ_MAGIC  UINT32_C(0x5a445248)
+
+/** Compressed RAM disk image version */
+#define RDZ_VERSION  1
+
+/** Compressed RAM disk image header
+ *
+ * The image (created by tools/mkrdz.py) consists of the header,
+ * an index of block_count + 1 little-endian 64-bit offsets of the
+ * compressed blocks from the image start and the blocks themselves,
+ * each compressed independently as a raw deflate stream.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t block_size;
+	uint32_t block_count;
+	uint64_t image_size;
+} __attribute__((packed)) rdz_header_t;
+
+/** Compressed image, blocks are decompressed on first access */
+static struct {
+	/** The RAM disk is compressed */
+	bool compressed;
+	/** Compressed image */
+	uint8_t *image;
+	/** Size of compressed image */
+	size_t image_size;
+	/** Size of uncompressed block */
+	size_t block_size;
+	/** Number of blocks */
+	size_t block_count;
+	/** Size of uncompressed image */
+	size_t data_size;
+	/** Decompressed blocks, @c NULL if not decompressed yet */
+	uint8_t **blocks;
+} rdz;
+
 static errno_t rd_open(bd_srvs_t *, bd_srv_t *);
 static errno_t rd_close(bd_srv_t *);
 static errno_t rd_read_blocks(bd_srv_t *, aoff64_t, size_t, void *, size_t);
 static errno_t rd_write_blocks(bd_srv_t *, aoff64_t, size_t, const void *, size_t);
 static errno_t rd_get_block_size(bd_srv_t *, size_t *);
 static errno_t rd_get_num_blocks(bd_srv_t *, aoff64_t *);
+static errno_t rd_map(bd_srv_t *, void **, size_t *, unsigned int *);
 
 /** This rwlock protects the ramdisk's data.
  *
@@ -88,7 +132,8 @@ static bd_ops_t rd_bd_ops = {
 	.read_blocks = rd_read_blocks,
 	.write_blocks = rd_write_blocks,
 	.get_block_size = rd_get_block_size,
-	.get_num_blocks = rd_get_num_blocks
+	.get_num_blocks = rd_get_num_blocks,
+	.map = rd_map
 };
 
 static bd_srvs_t bd_srvs;
@@ -110,15 +155,114 @@ static errno_t rd_close(bd_srv_t *bd)
 	return EOK;
 }
 
+/** Get decompressed block of a compressed RAM disk.
+ *
+ * The block is decompressed on first access and stays in memory
+ * afterwards, so that it can also be written to.
+ *
+ * @param idx    Block index
+ * @param rblock Place to store pointer to block data
+ * @return EOK on success or an error code
+ */
+static errno_t rdz_block(size_t idx, uint8_t **rblock)
+{
+	uint64_t start, end;
+	uint8_t *block;
+	size_t len;
+	errno_t rc;
+
+	if (rdz.blocks[idx] != NULL) {
+		*rblock = rdz.blocks[idx];
+		return EOK;
+	}
+
+	memcpy(&start, rdz.image + sizeof(rdz_header_t) +
+	    idx * sizeof(uint64_t), sizeof(uint64_t));
+	memcpy(&end, rdz.image + sizeof(rdz_header_t) +
+	    (idx + 1) * sizeof(uint64_t), sizeof(uint64_t));
+	start = uint64_t_le2host(start);
+	end = uint64_t_le2host(end);
+
+	if (start > end || end > rdz.image_size) {
+		printf("%s: Corrupt index of block %zu\n", NAME, idx);
+		return EIO;
+	}
+
+	block = calloc(1, rdz.block_size);
+	if (block == NULL)
+		return ENOMEM;
+
+	len = min(rdz.block_size, rdz.data_size - idx * rdz.block_size);
+	rc = inflate(rdz.image + start, end - start, block, len);
+	if (rc != EOK) {
+		printf("%s: Error decompressing block %zu: %s\n", NAME, idx,
+		    str_error(rc));
+		free(block);
+		return EIO;
+	}
+
+	rdz.blocks[idx] = block;
+
+	*rblock = block;
+	return EOK;
+}
+
+/** Transfer data from or to a compressed RAM disk.
+ *
+ * @param pos   Byte position on the RAM disk
+ * @param buf   Buffer
+ * @param size  Number of bytes to transfer
+ * @param write @c true to write @a buf to the RAM disk
+ * @return EOK on success or an error code
+ */
+static errno_t rdz_transfer(aoff64_t pos, void *buf, size_t size, bool write)
+{
+	uint8_t *data = (uint8_t *) buf;
+	uint8_t *block;
+	errno_t rc;
+
+	while (size > 0) {
+		size_t idx = pos / rdz.block_size;
+		size_t offs = pos % rdz.block_size;
+		size_t cnt = min(size, rdz.block_size - offs);
+
+		rc = rdz_block(idx, &block);
+		if (rc != EOK)
+			return rc;
+
+		if (write)
+			memcpy(block + offs, data, cnt);
+		else
+			memcpy(data, block + offs, cnt);
+
+		pos += cnt;
+		data += cnt;
+		size -= cnt;
+	}
+
+	return EOK;
+}
+
 /** Read blocks from the device. */
 static errno_t rd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt, void *buf,
     size_t size)
 {
+	errno_t rc;
+
 	if ((ba + cnt) * block_size > rd_size) {
 		/* Reading past the end of the device. */
 		return ELIMIT;
 	}
 
+	if (rdz.compressed) {
+		/* Decompressing a block modifies the RAM disk state */
+		fibril_rwlock_write_lock(&rd_lock);
+		rc = rdz_transfer(ba * block_size, buf,
+		    min(block_size * cnt, size), false);
+		fibril_rwlock_write_unlock(&rd_lock);
+		return rc;
+	}
+
 	fibril_rwlock_read_lock(&rd_lock);
 	memcpy(buf, rd_addr + ba * block_size, min(block_size * cnt, size));
 	fibril_rwlock_read_unlock(&rd_lock);
@@ -130,18 +274,94 @@ static errno_t rd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt, void *buf,
 static errno_t rd_write_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
     const void *buf, size_t size)
 {
+	errno_t rc = EOK;
+
 	if ((ba + cnt) * block_size > rd_size) {
 		/* Writing past the end of the device. */
 		return ELIMIT;
 	}
 
 	fibril_rwlock_write_lock(&rd_lock);
-	memcpy(rd_addr + ba * block_size, buf, min(block_size * cnt, size));
+	if (rdz.compressed) {
+		rc = rdz_transfer(ba * block_size, (void *) buf,
+		    min(block_size * cnt, size), true);
+	} else {
+		memcpy(rd_addr + ba * block_size, buf,
+		    min(block_size * cnt, size));
+	}
 	fibril_rwlock_write_unlock(&rd_lock);
 
+	return rc;
+}
+
+/** Share the ramdisk image with a client.
+ *
+ * Clients which map the image access it without any copying. Accesses
+ * through the mapping are not serialized by rd_lock, their ordering is up
+ * to the clients just as for concurrent requests for the same blocks.
+ * A compressed RAM disk cannot be mapped.
+ */
+static errno_t rd_map(bd_srv_t *bd, void **raddr, size_t *rsize,
+    unsigned int *rflags)
+{
+	if (rdz.compressed)
+		return ENOTSUP;
+
+	*raddr = rd_addr;
+	*rsize = ALIGN_UP(rd_size, PAGE_SIZE);
+	*rflags = AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE;
 	return EOK;
 }
 
+/** Check for a compressed RAM disk image and prepare it for operation.
+ *
+ * @param size Size of the RAM disk image
+ * @return @c true if the image is valid (compressed or not)
+ */
+static bool rdz_init(size_t size)
+{
+	rdz_header_t header;
+
+	if (size < sizeof(header))
+		return true;
+
+	memcpy(&header, rd_addr, sizeof(header));
+	if (uint32_t_le2host(header.magic) != RDZ_MAGIC)
+		return true;
+
+	rdz.block_size = uint32_t_le2host(header.block_size);
+	rdz.block_count = uint32_t_le2host(header.block_count);
+	uint64_t image_size = uint64_t_le2host(header.image_size);
+
+	if (uint32_t_le2host(header.version) != RDZ_VERSION ||
+	    rdz.block_size == 0 || rdz.block_size % block_size != 0 ||
+	    image_size > SIZE_MAX ||
+	    rdz.block_count != (image_size + rdz.block_size - 1) /
+	    rdz.block_size ||
+	    (rdz.block_count + 1) * sizeof(uint64_t) >
+	    size - sizeof(header)) {
+		printf("%s: Invalid compressed RAM disk image\n", NAME);
+		return false;
+	}
+
+	rdz.blocks = calloc(rdz.block_count, sizeof(uint8_t *));
+	if (rdz.blocks == NULL) {
+		printf("%s: Out of memory\n", NAME);
+		return false;
+	}
+
+	rdz.compressed = true;
+	rdz.image = rd_addr;
+	rdz.image_size = size;
+	rdz.data_size = image_size;
+	rd_size = ALIGN_UP(image_size, block_size);
+
+	printf("%s: Compressed RAM disk, %zu blocks of %zu bytes, "
+	    "%" PRIu64 " bytes uncompressed\n", NAME, rdz.block_count,
+	    rdz.block_size, image_size);
+	return true;
+}
+
 /** Prepare the ramdisk image for operation. */
 static bool rd_init(void)
 {
@@ -173,6 +393,9 @@ static bool rd_init(void)
 	printf("%s: Found RAM disk at %p, %" PRIun " bytes\n", NAME,
 	    (void *) addr_phys, size);
 
+	if (!rdz_init(size))
+		return false;
+
 	bd_srvs_init(&bd_srvs);
 	bd_srvs.ops = &rd_bd_ops;
 
@@ -40,6 +40,7 @@
 #include <bd_srv.h>
 #include <devman.h>
 #include <errno.h>
+#include <ipc/bd.h>
 #include <str_error.h>
 #include <stdio.h>
 #include <str.h>
@@ -109,6 +110,8 @@ static errno_t scan_device_tree(devman_handle_t funh)
 		bd_srvs_init(&disk[disk_count].bds);
 		disk[disk_count].bds.ops = &sata_bd_ops;
 		disk[disk_count].bds.sarg = &disk[disk_count];
+		/* The AHCI driver queues requests in its command slots. */
+		disk[disk_count].bds.queue_depth = BD_QUEUE_DEPTH;
 
 		printf("Device %s - %s , blocks: %lu, block_size: %lu\n",
 		    disk[disk_count].dev_name, disk[disk_count].sata_dev_name,
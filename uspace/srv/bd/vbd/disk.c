@@ -39,6 +39,7 @@
 #include <errno.h>
 #include <str_error.h>
 #include <io/log.h>
+#include <ipc/bd.h>
 #include <label/empty.h>
 #include <label/label.h>
 #include <loc.h>
@@ -331,6 +332,8 @@ static errno_t vbds_part_add(vbds_disk_t *disk, label_part_t *lpart,
 	bd_srvs_init(&part->bds);
 	part->bds.ops = &vbds_bd_ops;
 	part->bds.sarg = part;
+	/* Requests are forwarded to the disk, which queues them itself. */
+	part->bds.queue_depth = BD_QUEUE_DEPTH;
 
 	if (lpinfo.pkind != lpk_extended) {
 		rc = vbds_part_svc_register(part);
@@ -461,6 +464,9 @@ errno_t vbds_disk_discovery_start(void)
 		return rc;
 	}
 
+	/* Every rescan resolves the same names again */
+	(void) loc_cache_enable();
+
 	return vbds_disks_check_new();
 }
 
@@ -42,6 +42,7 @@
 #include <fibril_synch.h>
 #include <refcount.h>
 #include <async.h>
+#include <time.h>
 
 #include "util.h"
 
@@ -61,6 +62,16 @@ typedef struct {
 	struct driver *driver;
 } client_t;
 
+/** Entry of the match id index (driver_list_t.match_index). */
+typedef struct {
+	/** Link to driver_list_t.match_index */
+	ht_link_t link;
+	/** Driver match id */
+	match_id_t *mid;
+	/** Driver the match id belongs to */
+	struct driver *drv;
+} match_index_entry_t;
+
 /** Representation of device driver. */
 typedef struct driver {
 	/** Pointers to previous and next drivers in a linked list. */
@@ -82,8 +93,14 @@ typedef struct driver {
 	char *binary_path;
 	/** List of device ids for device-to-driver matching. */
 	match_id_list_t match_ids;
+	/** Match index entries, one per match id */
+	match_index_entry_t *mindex;
+	/** Number of entries in @c mindex */
+	size_t mindex_cnt;
 	/** List of devices controlled by this driver. */
 	list_t devices;
+	/** Time when the driver task was spawned */
+	struct timespec start_time;
 
 	/**
 	 * Fibril mutex for this driver - driver state, list of devices, session.
@@ -99,6 +116,8 @@ typedef struct driver_list {
 	fibril_mutex_t drivers_mutex;
 	/** Next free handle */
 	devman_handle_t next_handle;
+	/** Driver match ids indexed by match id string */
+	hash_table_t match_index;
 } driver_list_t;
 
 /** Device state */
@@ -31,14 +31,17 @@
  * @{
  */
 
+#include <adt/hash.h>
 #include <dirent.h>
 #include <errno.h>
+#include <io/klog.h>
 #include <io/log.h>
 #include <vfs/vfs.h>
 #include <loc.h>
 #include <str_error.h>
 #include <stdio.h>
 #include <task.h>
+#include <time.h>
 
 #include "dev.h"
 #include "devman.h"
@@ -48,20 +51,60 @@
 #include "main.h"
 
 static errno_t driver_reassign_fibril(void *);
+static errno_t driver_pass_device_fibril(void *);
+
+/* match index hash table operations */
+
+static size_t match_id_key_hash(const void *key)
+{
+	const char *id = key;
+	size_t hash = 0;
+
+	while (*id != '\0')
+		hash = hash_combine(hash, (uint8_t) *id++);
+
+	return hash;
+}
+
+static size_t match_index_hash(const ht_link_t *item)
+{
+	match_index_entry_t *ent = hash_table_get_inst(item,
+	    match_index_entry_t, link);
+	return match_id_key_hash(ent->mid->id);
+}
+
+static bool match_index_key_equal(const void *key, const ht_link_t *item)
+{
+	match_index_entry_t *ent = hash_table_get_inst(item,
+	    match_index_entry_t, link);
+	return str_cmp(ent->mid->id, key) == 0;
+}
+
+static hash_table_ops_t match_index_ops = {
+	.hash = match_index_hash,
+	.key_hash = match_id_key_hash,
+	.key_equal = match_index_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
 
 /**
  * Initialize the list of device driver's.
  *
  * @param drv_list the list of device driver's.
- *
+ * @return EOK on success, ENOMEM if out of memory
  */
-void init_driver_list(driver_list_t *drv_list)
+errno_t init_driver_list(driver_list_t *drv_list)
 {
 	assert(drv_list != NULL);
 
+	if (!hash_table_create(&drv_list->match_index, 0, 0, &match_index_ops))
+		return ENOMEM;
+
 	list_initialize(&drv_list->drivers);
 	fibril_mutex_initialize(&drv_list->drivers_mutex);
 	drv_list->next_handle = 1;
+	return EOK;
 }
 
 /** Allocate and initialize a new driver structure.
@@ -77,19 +120,48 @@ driver_t *create_driver(void)
 }
 
 /** Add a driver to the list of drivers.
+ *
+ * The driver's match ids are entered into the match index so that
+ * find_best_match_driver() only needs to look at drivers sharing at
+ * least one match id with the device.
  *
  * @param drivers_list	List of drivers.
  * @param drv		Driver structure.
+ * @return		EOK on success, ENOMEM if out of memory
  */
-void add_driver(driver_list_t *drivers_list, driver_t *drv)
+errno_t add_driver(driver_list_t *drivers_list, driver_t *drv)
 {
+	size_t cnt = list_count(&drv->match_ids.ids);
+	size_t i;
+
+	assert(drv->mindex == NULL);
+
+	if (cnt > 0) {
+		drv->mindex = calloc(cnt, sizeof(match_index_entry_t));
+		if (drv->mindex == NULL)
+			return ENOMEM;
+	}
+
+	drv->mindex_cnt = cnt;
+
 	fibril_mutex_lock(&drivers_list->drivers_mutex);
 	list_append(&drv->drivers, &drivers_list->drivers);
 	drv->handle = drivers_list->next_handle++;
+
+	i = 0;
+	list_foreach(drv->match_ids.ids, link, match_id_t, mid) {
+		drv->mindex[i].mid = mid;
+		drv->mindex[i].drv = drv;
+		hash_table_insert(&drivers_list->match_index,
+		    &drv->mindex[i].link);
+		++i;
+	}
+
 	fibril_mutex_unlock(&drivers_list->drivers_mutex);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Driver `%s' was added to the list of available "
 	    "drivers.", drv->name);
+	return EOK;
 }
 
 /**
@@ -179,22 +251,38 @@ int lookup_available_drivers(driver_list_t *drivers_list, const char *dir_path)
 	int drv_cnt = 0;
 	DIR *dir = NULL;
 	struct dirent *diren;
+	struct timespec t0, t1;
+
+	getuptime(&t0);
 
 	dir = opendir(dir_path);
 
 	if (dir != NULL) {
 		driver_t *drv = create_driver();
-		while ((diren = readdir(dir))) {
-			if (get_driver_info(dir_path, diren->d_name, drv)) {
-				add_driver(drivers_list, drv);
-				drv_cnt++;
-				drv = create_driver();
+		while (drv != NULL && (diren = readdir(dir))) {
+			if (!get_driver_info(dir_path, diren->d_name, drv))
+				continue;
+
+			if (add_driver(drivers_list, drv) != EOK) {
+				log_msg(LOG_DEFAULT, LVL_ERROR, "Out of memory "
+				    "adding driver `%s'.", drv->name);
+				clean_driver(drv);
+				continue;
 			}
+
+			drv_cnt++;
+			drv = create_driver();
 		}
-		delete_driver(drv);
+		if (drv != NULL)
+			delete_driver(drv);
 		closedir(dir);
 	}
 
+	getuptime(&t1);
+	log_msg(LOG_DEFAULT, LVL_NOTE, "Found %d drivers (%zu match ids) "
+	    "in %lld ms.", drv_cnt, hash_table_size(&drivers_list->match_index),
+	    (long long) NSEC2MSEC(ts_sub_diff(&t1, &t0)));
+
 	return drv_cnt;
 }
 
@@ -211,6 +299,10 @@ int lookup_available_drivers(driver_list_t *drivers_list, const char *dir_path)
  * same score in the list of drivers, or a driver with the next best score
  * (greater than zero).
  *
+ * Only drivers found in the match index under one of the device's match ids
+ * are considered. Driver handles are allocated in list order, so comparing
+ * handles gives the same tie-breaking as walking the list of drivers.
+ *
  * @param drivers_list	The list of drivers, where we look for the driver
  *			suitable for handling the device.
  * @param node		The device node structure of the device.
@@ -220,51 +312,56 @@ int lookup_available_drivers(driver_list_t *drivers_list, const char *dir_path)
 driver_t *find_best_match_driver(driver_list_t *drivers_list, dev_node_t *node)
 {
 	driver_t *best_drv = NULL;
+	driver_t *next_drv = NULL;
 	int best_score = 0, score = 0;
 	int cur_score;
-	link_t *link;
+	devman_handle_t cur_handle;
+	hash_table_t *index = &drivers_list->match_index;
+	ht_link_t *first, *item;
 
 	fibril_mutex_lock(&drivers_list->drivers_mutex);
 
 	if (node->drv != NULL) {
 		cur_score = get_match_score(node->drv, node);
+		cur_handle = node->drv->handle;
+	} else {
+		cur_score = INT_MAX;
+		cur_handle = 0;
+	}
 
-		link = list_next(&node->drv->drivers, &drivers_list->drivers);
+	list_foreach(node->pfun->match_ids.ids, link, match_id_t, mid) {
+		first = hash_table_find(index, mid->id);
+		for (item = first; item != NULL;
+		    item = hash_table_find_next(index, first, item)) {
+			match_index_entry_t *ent = hash_table_get_inst(item,
+			    match_index_entry_t, link);
+			driver_t *drv = ent->drv;
 
-		/*
-		 * Find next driver with score equal to the current.
-		 */
-		while (link != NULL) {
-			driver_t *drv = list_get_instance(link, driver_t,
-			    drivers);
 			score = get_match_score(drv, node);
-			if (score == cur_score) {
-				/* Found it */
-				fibril_mutex_unlock(&drivers_list->drivers_mutex);
-				return drv;
-			}
 
-			link = list_next(link, &drivers_list->drivers);
-		}
-
-		/* There is no driver with the same score */
-	} else {
-		cur_score = INT_MAX;
-	}
+			/*
+			 * Next driver with score equal to the current.
+			 */
+			if (node->drv != NULL && score == cur_score &&
+			    drv->handle > cur_handle && (next_drv == NULL ||
+			    drv->handle < next_drv->handle)) {
+				next_drv = drv;
+			}
 
-	/*
-	 * Find driver with the next best score
-	 */
-	list_foreach(drivers_list->drivers, drivers, driver_t, drv) {
-		score = get_match_score(drv, node);
-		if (score > best_score && score < cur_score) {
-			best_score = score;
-			best_drv = drv;
+			/*
+			 * Driver with the next best score
+			 */
+			if (score > 0 && score < cur_score &&
+			    (score > best_score || (score == best_score &&
+			    drv->handle < best_drv->handle))) {
+				best_score = score;
+				best_drv = drv;
+			}
 		}
 	}
 
 	fibril_mutex_unlock(&drivers_list->drivers_mutex);
-	return best_drv;
+	return next_drv != NULL ? next_drv : best_drv;
 }
 
 /** Assign a driver to a device.
@@ -329,6 +426,8 @@ bool start_driver(driver_t *drv)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "start_driver(drv=\"%s\")", drv->name);
 
+	getuptime(&drv->start_time);
+	klog_bootmark("start driver %s", drv->name);
 	rc = task_spawnl(NULL, NULL, drv->binary_path, drv->binary_path, NULL);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Spawning driver `%s' (%s) failed: %s.",
@@ -416,7 +515,43 @@ driver_t *driver_find_by_name(driver_list_t *drv_list, const char *drv_name)
 	return res;
 }
 
+/** Pass one device to the driver it was assigned to.
+ *
+ * If the driver reports the device as not present, look for the next best
+ * driver in a separate fibril.
+ *
+ * @param driver	The driver to which the device is passed.
+ * @param dev		The device. The caller holds a reference.
+ * @param tree		Device tree
+ */
+static void pass_device_to_driver(driver_t *driver, dev_node_t *dev,
+    dev_tree_t *tree)
+{
+	add_device(driver, dev, tree);
+
+	/* Device probe failed, need to try next best driver */
+	if (dev->state == DEVICE_NOT_PRESENT) {
+		fibril_mutex_lock(&driver->driver_mutex);
+		list_remove(&dev->driver_devices);
+		fibril_mutex_unlock(&driver->driver_mutex);
+		/* Give an extra reference to driver_reassign_fibril */
+		dev_add_ref(dev);
+		fid_t fid = fibril_create(driver_reassign_fibril, dev);
+		if (fid == 0) {
+			log_msg(LOG_DEFAULT, LVL_ERROR,
+			    "Error creating fibril to assign driver.");
+			dev_del_ref(dev);
+		} else {
+			fibril_add_ready(fid);
+		}
+	}
+}
+
 /** Notify driver about the devices to which it was assigned.
+ *
+ * Each device is passed in its own fibril so that a driver slow to probe
+ * one device does not hold up the rest of the devices (and the drivers
+ * of their subtrees).
  *
  * @param driver	The driver to which the devices are passed.
  */
@@ -424,6 +559,7 @@ static void pass_devices_to_driver(driver_t *driver, dev_tree_t *tree)
 {
 	dev_node_t *dev;
 	link_t *link;
+	size_t cnt = 0;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "pass_devices_to_driver(driver=\"%s\")",
 	    driver->name);
@@ -445,33 +581,29 @@ static void pass_devices_to_driver(driver_t *driver, dev_tree_t *tree)
 			continue;
 		}
 
-		dev_add_ref(dev);
-
 		/*
-		 * Unlock to avoid deadlock when adding device
-		 * handled by itself.
+		 * Mark the device now so that it is not picked up again
+		 * while the driver is still probing it.
 		 */
-		fibril_mutex_unlock(&driver->driver_mutex);
+		dev->passed_to_driver = true;
+		dev_add_ref(dev);
 		fibril_rwlock_write_unlock(&tree->rwlock);
+		++cnt;
 
-		add_device(driver, dev, tree);
-
-		/* Device probe failed, need to try next best driver */
-		if (dev->state == DEVICE_NOT_PRESENT) {
-			fibril_mutex_lock(&driver->driver_mutex);
-			list_remove(&dev->driver_devices);
-			fibril_mutex_unlock(&driver->driver_mutex);
-			/* Give an extra reference to driver_reassign_fibril */
-			dev_add_ref(dev);
-			fid_t fid = fibril_create(driver_reassign_fibril, dev);
-			if (fid == 0) {
-				log_msg(LOG_DEFAULT, LVL_ERROR,
-				    "Error creating fibril to assign driver.");
-				dev_del_ref(dev);
-			}
+		/* The fibril takes over our reference */
+		fid_t fid = fibril_create(driver_pass_device_fibril, dev);
+		if (fid != 0) {
 			fibril_add_ready(fid);
+			link = link->next;
+			continue;
 		}
 
+		/*
+		 * Fall back to passing the device synchronously. Unlock
+		 * to avoid deadlock when adding device handled by itself.
+		 */
+		fibril_mutex_unlock(&driver->driver_mutex);
+		pass_device_to_driver(driver, dev, tree);
 		dev_del_ref(dev);
 
 		/*
@@ -495,7 +627,8 @@ static void pass_devices_to_driver(driver_t *driver, dev_tree_t *tree)
 	 * the driver would be added to the device list and started
 	 * immediately and possibly started here as well.
 	 */
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "Driver `%s' enters running state.", driver->name);
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Driver `%s' enters running state "
+	    "(%zu devices passed).", driver->name, cnt);
 	driver->state = DRIVER_RUNNING;
 
 	fibril_mutex_unlock(&driver->driver_mutex);
@@ -512,9 +645,17 @@ static void pass_devices_to_driver(driver_t *driver, dev_tree_t *tree)
  */
 void initialize_running_driver(driver_t *driver, dev_tree_t *tree)
 {
+	struct timespec now;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "initialize_running_driver(driver=\"%s\")",
 	    driver->name);
 
+	getuptime(&now);
+	log_msg(LOG_DEFAULT, LVL_NOTE, "Driver `%s' registered %lld ms after "
+	    "start.", driver->name,
+	    (long long) NSEC2MSEC(ts_sub_diff(&now, &driver->start_time)));
+	klog_bootmark("done driver %s", driver->name);
+
 	/*
 	 * Pass devices which have been already assigned to the driver to the
 	 * driver.
@@ -547,6 +688,7 @@ void clean_driver(driver_t *drv)
 
 	free(drv->name);
 	free(drv->binary_path);
+	free(drv->mindex);
 
 	clean_match_ids(&drv->match_ids);
 
@@ -645,6 +787,8 @@ void add_device(driver_t *drv, dev_node_t *dev, dev_tree_t *tree)
 		parent_handle = 0;
 	}
 
+	klog_bootmark("start dev_add %s", dev->pfun->pathname);
+
 	async_exch_t *exch = async_exchange_begin(drv->sess);
 
 	ipc_call_t answer;
@@ -664,6 +808,8 @@ void add_device(driver_t *drv, dev_node_t *dev, dev_tree_t *tree)
 		async_wait_for(req, &rc);
 	}
 
+	klog_bootmark("done dev_add %s", dev->pfun->pathname);
+
 	switch (rc) {
 	case EOK:
 		dev->state = DEVICE_USABLE;
@@ -859,5 +1005,25 @@ static errno_t driver_reassign_fibril(void *arg)
 	return EOK;
 }
 
+/** Pass device to its driver in a separate fibril.
+ *
+ * @param arg Device node (dev_node_t)
+ */
+static errno_t driver_pass_device_fibril(void *arg)
+{
+	dev_node_t *dev_node = (dev_node_t *) arg;
+	driver_t *drv;
+
+	fibril_rwlock_read_lock(&device_tree.rwlock);
+	drv = dev_node->drv;
+	fibril_rwlock_read_unlock(&device_tree.rwlock);
+
+	pass_device_to_driver(drv, dev_node, &device_tree);
+
+	/* Delete one reference we got from the caller. */
+	dev_del_ref(dev_node);
+	return EOK;
+}
+
 /** @}
  */
@@ -282,7 +282,12 @@ static bool devman_init(void)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "devman_init - looking for available drivers.");
 
 	/* Initialize list of available drivers. */
-	init_driver_list(&drivers_list);
+	if (init_driver_list(&drivers_list) != EOK) {
+		log_msg(LOG_DEFAULT, LVL_FATAL, "Failed to initialize list of "
+		    "drivers.");
+		return false;
+	}
+
 	if (lookup_available_drivers(&drivers_list,
 	    DRIVER_DEFAULT_STORE) == 0) {
 		log_msg(LOG_DEFAULT, LVL_FATAL, "No drivers found.");
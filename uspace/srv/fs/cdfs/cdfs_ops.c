@@ -59,6 +59,9 @@
 /** Standard CD-ROM block size */
 #define BLOCK_SIZE  2048
 
+/** Maximum number of bytes returned by one read of a file */
+#define CDFS_READ_MAX_BYTES  (64 * 1024)
+
 #define NODE_CACHE_SIZE 200
 
 /** All root nodes have index 0 */
@@ -246,6 +249,7 @@ typedef struct {
 	cdfs_lba_t lba;           /**< LBA of data on disk */
 	bool processed;           /**< If all children have been read */
 	unsigned int opened;      /**< Opened count */
+	aoff64_t next_pos;        /**< Position following the last read */
 } cdfs_node_t;
 
 /** String encoding */
@@ -365,6 +369,7 @@ static void cdfs_node_initialize(cdfs_node_t *node)
 	node->size = 0;
 	node->lba = 0;
 	node->processed = false;
+	node->next_pos = 0;
 	node->opened = 0;
 
 	list_initialize(&node->cs_list);
@@ -845,7 +850,8 @@ libfs_ops_t cdfs_libfs_ops = {
 	.service_get = cdfs_service_get,
 	.size_block = cdfs_size_block,
 	.total_block_count = cdfs_total_block_count,
-	.free_block_count = cdfs_free_block_count
+	.free_block_count = cdfs_free_block_count,
+	.cache_stats = block_get_stats
 };
 
 /** Verify that escape sequence corresonds to one of the allowed encoding
@@ -1251,6 +1257,98 @@ static errno_t cdfs_unmounted(service_id_t service_id)
 	return EOK;
 }
 
+/** Read data of a file.
+ *
+ * Files occupy one contiguous extent, so the blocks of the read are
+ * fetched with a single block_get_range() request. When the file is
+ * read sequentially, the blocks following the read are requested
+ * ahead of time.
+ *
+ * @param call   Data read call to answer
+ * @param node   File node
+ * @param pos    Position in the file, below its size
+ * @param len    Number of bytes requested
+ * @param rbytes Place to store the number of bytes read
+ *
+ * @return EOK on success or an error code. The call is answered
+ *         in either case.
+ *
+ */
+static errno_t cdfs_read_file(ipc_call_t *call, cdfs_node_t *node,
+    aoff64_t pos, size_t len, size_t *rbytes)
+{
+	service_id_t service_id = node->fs->service_id;
+	cdfs_lba_t lba = pos / BLOCK_SIZE;
+	size_t offset = pos % BLOCK_SIZE;
+	block_t *one;
+	block_t **blocks = &one;
+	uint8_t *buf = NULL;
+
+	size_t bytes = min(len, node->size - pos);
+	bytes = min(bytes, CDFS_READ_MAX_BYTES - offset);
+	size_t cnt = (offset + bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	if (cnt > 1) {
+		blocks = calloc(cnt, sizeof(block_t *));
+		buf = malloc(bytes);
+		if ((blocks == NULL) || (buf == NULL)) {
+			/* Make do with the first block */
+			free(blocks);
+			free(buf);
+			blocks = &one;
+			buf = NULL;
+			cnt = 1;
+			bytes = min(bytes, BLOCK_SIZE - offset);
+		}
+	}
+
+	errno_t rc = block_get_range(blocks, service_id, node->lba + lba, cnt,
+	    BLOCK_FLAGS_NONE);
+	if (rc != EOK) {
+		if (blocks != &one)
+			free(blocks);
+		free(buf);
+		async_answer_0(call, rc);
+		return rc;
+	}
+
+	if (pos == node->next_pos) {
+		uint32_t blocks_total = (node->size + BLOCK_SIZE - 1) /
+		    BLOCK_SIZE;
+		uint32_t next = lba + cnt;
+
+		if (next < blocks_total) {
+			block_readahead(service_id, node->lba + next,
+			    min(blocks_total - next, 2 * cnt));
+		}
+	}
+	node->next_pos = pos + bytes;
+
+	if (buf != NULL) {
+		size_t done = 0;
+
+		for (size_t i = 0; i < cnt; i++) {
+			size_t from = (i == 0) ? offset : 0;
+			size_t n = min(BLOCK_SIZE - from, bytes - done);
+
+			memcpy(buf + done, blocks[i]->data + from, n);
+			done += n;
+		}
+
+		async_data_read_finalize(call, buf, bytes);
+		free(buf);
+	} else {
+		async_data_read_finalize(call, one->data + offset, bytes);
+	}
+
+	rc = block_put_range(blocks, cnt);
+	if (blocks != &one)
+		free(blocks);
+
+	*rbytes = bytes;
+	return rc;
+}
+
 static errno_t cdfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *rbytes)
 {
@@ -1284,23 +1382,8 @@ static errno_t cdfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos
 			*rbytes = 0;
 			async_data_read_finalize(&call, NULL, 0);
 		} else {
-			cdfs_lba_t lba = pos / BLOCK_SIZE;
-			size_t offset = pos % BLOCK_SIZE;
-
-			*rbytes = min(len, BLOCK_SIZE - offset);
-			*rbytes = min(*rbytes, node->size - pos);
-
-			block_t *block;
-			errno_t rc = block_get(&block, service_id, node->lba + lba,
-			    BLOCK_FLAGS_NONE);
-			if (rc != EOK) {
-				async_answer_0(&call, rc);
-				return rc;
-			}
-
-			async_data_read_finalize(&call, block->data + offset,
-			    *rbytes);
-			rc = block_put(block);
+			errno_t rc = cdfs_read_file(&call, node, pos, len,
+			    rbytes);
 			if (rc != EOK)
 				return rc;
 		}
@@ -55,6 +55,7 @@ vfs_info_t exfat_vfs_info = {
 	.name = NAME,
 	.concurrent_read_write = false,
 	.write_retains_size = false,
+	.cacheable = true,
 	.instance = 0,
 };
 
@@ -44,7 +44,364 @@
 #include <align.h>
 #include <assert.h>
 #include <fibril_synch.h>
+#include <macros.h>
 #include <mem.h>
+#include <stdlib.h>
+
+/** Number of bits searched at once in the bitmap cache. */
+#define BITMAP_WORD_BITS	64
+
+/**
+ * Number of free clusters the allocator tries to leave behind the first run
+ * of a file so that the file can grow without a FAT chain.
+ */
+#define EXFAT_BITMAP_SLACK	16
+
+static exfat_bitmap_cache_t *exfat_bitmap_cache_get(service_id_t service_id)
+{
+	void *data;
+
+	if (fs_instance_get(service_id, &data) != EOK)
+		return NULL;
+	return (exfat_bitmap_cache_t *) data;
+}
+
+static uint64_t exfat_bitmap_cache_word(exfat_bitmap_cache_t *cache,
+    exfat_cluster_t bit)
+{
+	uint64_t word;
+
+	memcpy(&word, &cache->map[bit / 8], sizeof(word));
+	return uint64_t_le2host(word);
+}
+
+static bool exfat_bitmap_cache_test(exfat_bitmap_cache_t *cache,
+    exfat_cluster_t bit)
+{
+	return (cache->map[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+/** Mark a bit of the bitmap cache as allocated or free.
+ *
+ * The sector holding the bit is remembered as dirty and written back by
+ * exfat_bitmap_cache_sync(). The caller must hold the cache lock.
+ *
+ * @param cache		Bitmap cache.
+ * @param bit		Bit number, i.e. the cluster number minus
+ *			EXFAT_CLST_FIRST.
+ * @param alloc		True if the cluster is now allocated.
+ */
+static void exfat_bitmap_cache_mark(exfat_bitmap_cache_t *cache,
+    exfat_cluster_t bit, bool alloc)
+{
+	uint8_t mask = 1 << (bit % 8);
+	uint8_t *byte = &cache->map[bit / 8];
+	size_t sector = (bit / 8) / cache->bps;
+
+	if (bit >= cache->clusters || alloc == ((*byte & mask) != 0))
+		return;
+
+	if (alloc) {
+		*byte |= mask;
+		cache->free_count--;
+	} else {
+		*byte &= ~mask;
+		cache->free_count++;
+	}
+
+	cache->dirty[sector / 8] |= 1 << (sector % 8);
+}
+
+/** Find a run of free bits in the bitmap cache.
+ *
+ * Words with all bits set or all bits clear are skipped as a whole.
+ *
+ * @param cache		Bitmap cache.
+ * @param start		First bit to consider.
+ * @param end		First bit not to consider.
+ * @param want		Length of the run.
+ * @param first		Output parameter where the first bit of the run
+ *			will be returned.
+ *
+ * @return		True if a run was found.
+ */
+static bool exfat_bitmap_cache_find_run(exfat_bitmap_cache_t *cache,
+    exfat_cluster_t start, exfat_cluster_t end, exfat_cluster_t want,
+    exfat_cluster_t *first)
+{
+	exfat_cluster_t bit = start;
+	exfat_cluster_t run = 0;
+
+	while (bit < end) {
+		if (bit % BITMAP_WORD_BITS == 0 &&
+		    end - bit >= BITMAP_WORD_BITS) {
+			uint64_t word = exfat_bitmap_cache_word(cache, bit);
+
+			if (word == UINT64_MAX) {
+				run = 0;
+				bit += BITMAP_WORD_BITS;
+				continue;
+			}
+			if (word == 0) {
+				if (run == 0)
+					*first = bit;
+				run += BITMAP_WORD_BITS;
+				bit += BITMAP_WORD_BITS;
+				if (run >= want)
+					return true;
+				continue;
+			}
+		}
+
+		if (exfat_bitmap_cache_test(cache, bit)) {
+			run = 0;
+		} else {
+			if (run == 0)
+				*first = bit;
+			if (++run >= want)
+				return true;
+		}
+		bit++;
+	}
+
+	return false;
+}
+
+/** Allocate a contiguous run of clusters in the bitmap cache.
+ *
+ * The search starts at the allocation hint and wraps around. A run with
+ * EXFAT_BITMAP_SLACK free clusters behind it is preferred so that the file
+ * can later be extended in place.
+ *
+ * @param cache		Bitmap cache.
+ * @param count		Number of clusters to allocate.
+ * @param firstc	Output parameter where the first allocated cluster
+ *			will be returned.
+ *
+ * @return		EOK on success, ENOSPC if there is no such run.
+ */
+static errno_t exfat_bitmap_cache_alloc(exfat_bitmap_cache_t *cache,
+    exfat_cluster_t count, exfat_cluster_t *firstc)
+{
+	exfat_cluster_t hint, want, first, i;
+	unsigned attempt;
+
+	fibril_mutex_lock(&cache->lock);
+
+	hint = cache->next_free;
+	if (hint >= cache->clusters)
+		hint = 0;
+
+	for (attempt = 0; attempt < 2; attempt++) {
+		want = (attempt == 0) ? count + EXFAT_BITMAP_SLACK : count;
+		if (want > cache->free_count)
+			continue;
+
+		if (exfat_bitmap_cache_find_run(cache, hint, cache->clusters,
+		    want, &first) ||
+		    exfat_bitmap_cache_find_run(cache, 0,
+		    min(hint + want - 1, cache->clusters), want, &first)) {
+			for (i = 0; i < count; i++)
+				exfat_bitmap_cache_mark(cache, first + i, true);
+			cache->next_free = first + want;
+			fibril_mutex_unlock(&cache->lock);
+
+			*firstc = first + EXFAT_CLST_FIRST;
+			return EOK;
+		}
+	}
+
+	fibril_mutex_unlock(&cache->lock);
+	return ENOSPC;
+}
+
+/** Load the allocation bitmap of a mounted file system into memory.
+ *
+ * While the cache exists, all bitmap operations of the file system are
+ * performed in memory and the modified sectors are written back by
+ * exfat_bitmap_cache_sync().
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_bitmap_cache_init(exfat_bs_t *bs, service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache;
+	exfat_node_t *bitmapp;
+	fs_node_t *fn;
+	block_t *b;
+	exfat_cluster_t bit;
+	size_t i;
+	errno_t rc;
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		return rc;
+	bitmapp = EXFAT_NODE(fn);
+
+	cache = calloc(1, sizeof(exfat_bitmap_cache_t));
+	if (cache == NULL) {
+		(void) exfat_node_put(fn);
+		return ENOMEM;
+	}
+
+	fibril_mutex_initialize(&cache->lock);
+	cache->bps = BPS(bs);
+	cache->clusters = min((uint64_t) DATA_CNT(bs), bitmapp->size * 8);
+	cache->sectors = ROUND_UP(bitmapp->size, BPS(bs)) / BPS(bs);
+	cache->map = malloc(cache->sectors * BPS(bs));
+	cache->dirty = calloc((cache->sectors + 7) / 8, 1);
+	if (cache->map == NULL || cache->dirty == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	for (i = 0; i < cache->sectors; i++) {
+		rc = exfat_block_get(&b, bs, bitmapp, i, BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			goto error;
+		memcpy(&cache->map[i * BPS(bs)], b->data, BPS(bs));
+		rc = block_put(b);
+		if (rc != EOK)
+			goto error;
+	}
+
+	for (bit = 0; bit < cache->clusters; bit++) {
+		if (bit % BITMAP_WORD_BITS == 0 &&
+		    cache->clusters - bit >= BITMAP_WORD_BITS) {
+			uint64_t word = exfat_bitmap_cache_word(cache, bit);
+
+			if (word == UINT64_MAX || word == 0) {
+				if (word == 0)
+					cache->free_count += BITMAP_WORD_BITS;
+				bit += BITMAP_WORD_BITS - 1;
+				continue;
+			}
+		}
+		if (!exfat_bitmap_cache_test(cache, bit))
+			cache->free_count++;
+	}
+
+	rc = exfat_node_put(fn);
+	fn = NULL;
+	if (rc != EOK)
+		goto error;
+
+	rc = fs_instance_create(service_id, cache);
+	if (rc != EOK)
+		goto error;
+
+	return EOK;
+
+error:
+	if (fn != NULL)
+		(void) exfat_node_put(fn);
+	free(cache->dirty);
+	free(cache->map);
+	free(cache);
+	return rc;
+}
+
+/** Write the modified sectors of the bitmap cache back to the bitmap.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t exfat_bitmap_cache_sync(exfat_bs_t *bs, service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache;
+	exfat_node_t *bitmapp;
+	fs_node_t *fn;
+	block_t *b;
+	uint8_t mask;
+	size_t i;
+	errno_t rc;
+
+	cache = exfat_bitmap_cache_get(service_id);
+	if (cache == NULL)
+		return EOK;
+
+	rc = exfat_bitmap_get(&fn, service_id);
+	if (rc != EOK)
+		return rc;
+	bitmapp = EXFAT_NODE(fn);
+
+	fibril_mutex_lock(&cache->lock);
+	for (i = 0; i < cache->sectors; i++) {
+		mask = 1 << (i % 8);
+		if (!(cache->dirty[i / 8] & mask))
+			continue;
+
+		rc = exfat_block_get(&b, bs, bitmapp, i, BLOCK_FLAGS_NOREAD);
+		if (rc != EOK)
+			break;
+		memcpy(b->data, &cache->map[i * cache->bps], cache->bps);
+		b->dirty = true;
+		rc = block_put(b);
+		if (rc != EOK)
+			break;
+
+		cache->dirty[i / 8] &= ~mask;
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	if (rc != EOK) {
+		(void) exfat_node_put(fn);
+		return rc;
+	}
+
+	return exfat_node_put(fn);
+}
+
+/** Write back and destroy the bitmap cache of a file system.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ *
+ * @return		EOK on success or an error code of the write back.
+ */
+errno_t exfat_bitmap_cache_fini(exfat_bs_t *bs, service_id_t service_id)
+{
+	exfat_bitmap_cache_t *cache;
+	errno_t rc;
+
+	cache = exfat_bitmap_cache_get(service_id);
+	if (cache == NULL)
+		return EOK;
+
+	rc = exfat_bitmap_cache_sync(bs, service_id);
+	(void) fs_instance_destroy(service_id);
+
+	free(cache->dirty);
+	free(cache->map);
+	free(cache);
+	return rc;
+}
+
+/** Get the number of free clusters from the bitmap cache.
+ *
+ * @param service_id	Service ID of the file system.
+ * @param count		Output parameter where the number of free
+ *			clusters will be returned.
+ *
+ * @return		True if the file system has a bitmap cache.
+ */
+bool exfat_bitmap_free_count(service_id_t service_id, uint64_t *count)
+{
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+
+	if (cache == NULL)
+		return false;
+
+	fibril_mutex_lock(&cache->lock);
+	*count = cache->free_count;
+	fibril_mutex_unlock(&cache->lock);
+	return true;
+}
 
 errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
     exfat_cluster_t clst)
@@ -58,6 +415,15 @@ errno_t exfat_bitmap_is_free(exfat_bs_t *bs, service_id_t service_id,
 
 	clst -= EXFAT_CLST_FIRST;
 
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		alloc = clst >= cache->clusters ||
+		    exfat_bitmap_cache_test(cache, clst);
+		fibril_mutex_unlock(&cache->lock);
+		return alloc ? ENOENT : EOK;
+	}
+
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
@@ -98,6 +464,14 @@ errno_t exfat_bitmap_set_cluster(exfat_bs_t *bs, service_id_t service_id,
 
 	clst -= EXFAT_CLST_FIRST;
 
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		exfat_bitmap_cache_mark(cache, clst, true);
+		fibril_mutex_unlock(&cache->lock);
+		return EOK;
+	}
+
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
@@ -133,6 +507,14 @@ errno_t exfat_bitmap_clear_cluster(exfat_bs_t *bs, service_id_t service_id,
 
 	clst -= EXFAT_CLST_FIRST;
 
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		exfat_bitmap_cache_mark(cache, clst, false);
+		fibril_mutex_unlock(&cache->lock);
+		return EOK;
+	}
+
 	rc = exfat_bitmap_get(&fn, service_id);
 	if (rc != EOK)
 		return rc;
@@ -165,6 +547,17 @@ errno_t exfat_bitmap_set_clusters(exfat_bs_t *bs, service_id_t service_id,
 	exfat_cluster_t clst;
 	clst = firstc;
 
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		for (; clst < firstc + count; clst++) {
+			exfat_bitmap_cache_mark(cache, clst - EXFAT_CLST_FIRST,
+			    true);
+		}
+		fibril_mutex_unlock(&cache->lock);
+		return EOK;
+	}
+
 	while (clst < firstc + count) {
 		rc = exfat_bitmap_set_cluster(bs, service_id, clst);
 		if (rc != EOK) {
@@ -185,6 +578,17 @@ errno_t exfat_bitmap_clear_clusters(exfat_bs_t *bs, service_id_t service_id,
 	exfat_cluster_t clst;
 	clst = firstc;
 
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		for (; clst < firstc + count; clst++) {
+			exfat_bitmap_cache_mark(cache, clst - EXFAT_CLST_FIRST,
+			    false);
+		}
+		fibril_mutex_unlock(&cache->lock);
+		return EOK;
+	}
+
 	while (clst < firstc + count) {
 		rc = exfat_bitmap_clear_cluster(bs, service_id, clst);
 		if (rc != EOK)
@@ -200,6 +604,10 @@ errno_t exfat_bitmap_alloc_clusters(exfat_bs_t *bs, service_id_t service_id,
 	exfat_cluster_t startc, endc;
 	startc = EXFAT_CLST_FIRST;
 
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL)
+		return exfat_bitmap_cache_alloc(cache, count, firstc);
+
 	while (startc < DATA_CNT(bs) + 2) {
 		endc = startc;
 		while (exfat_bitmap_is_free(bs, service_id, endc) == EOK) {
@@ -214,6 +622,53 @@ errno_t exfat_bitmap_alloc_clusters(exfat_bs_t *bs, service_id_t service_id,
 	return ENOSPC;
 }
 
+/** Allocate the first free cluster at or after a given cluster.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param clst		Cluster at which the search starts. The allocated
+ *			cluster is returned here.
+ *
+ * @return		EOK on success, ENOSPC if there is no free cluster
+ *			or an error code.
+ */
+errno_t exfat_bitmap_alloc_cluster(exfat_bs_t *bs, service_id_t service_id,
+    exfat_cluster_t *clst)
+{
+	exfat_cluster_t bit = *clst - EXFAT_CLST_FIRST;
+	exfat_cluster_t c;
+
+	exfat_bitmap_cache_t *cache = exfat_bitmap_cache_get(service_id);
+	if (cache != NULL) {
+		fibril_mutex_lock(&cache->lock);
+		while (bit < cache->clusters) {
+			if (bit % BITMAP_WORD_BITS == 0 &&
+			    cache->clusters - bit >= BITMAP_WORD_BITS &&
+			    exfat_bitmap_cache_word(cache, bit) == UINT64_MAX) {
+				bit += BITMAP_WORD_BITS;
+				continue;
+			}
+			if (!exfat_bitmap_cache_test(cache, bit)) {
+				exfat_bitmap_cache_mark(cache, bit, true);
+				fibril_mutex_unlock(&cache->lock);
+				*clst = bit + EXFAT_CLST_FIRST;
+				return EOK;
+			}
+			bit++;
+		}
+		fibril_mutex_unlock(&cache->lock);
+		return ENOSPC;
+	}
+
+	for (c = *clst; c < DATA_CNT(bs) + 2; c++) {
+		if (exfat_bitmap_is_free(bs, service_id, c) == EOK) {
+			*clst = c;
+			return exfat_bitmap_set_cluster(bs, service_id, c);
+		}
+	}
+	return ENOSPC;
+}
+
 errno_t exfat_bitmap_append_clusters(exfat_bs_t *bs, exfat_node_t *nodep,
     exfat_cluster_t count)
 {
@@ -224,6 +679,27 @@ errno_t exfat_bitmap_append_clusters(exfat_bs_t *bs, exfat_node_t *nodep,
 		exfat_cluster_t lastc, clst;
 		lastc = nodep->firstc + ROUND_UP(nodep->size, BPC(bs)) / BPC(bs) - 1;
 
+		exfat_bitmap_cache_t *cache =
+		    exfat_bitmap_cache_get(nodep->idx->service_id);
+		if (cache != NULL) {
+			exfat_cluster_t bit = lastc + 1 - EXFAT_CLST_FIRST;
+			exfat_cluster_t first;
+			errno_t rc = ENOSPC;
+
+			fibril_mutex_lock(&cache->lock);
+			if (bit + count <= cache->clusters &&
+			    exfat_bitmap_cache_find_run(cache, bit, bit + count,
+			    count, &first)) {
+				for (clst = 0; clst < count; clst++) {
+					exfat_bitmap_cache_mark(cache,
+					    bit + clst, true);
+				}
+				rc = EOK;
+			}
+			fibril_mutex_unlock(&cache->lock);
+			return rc;
+		}
+
 		clst = lastc + 1;
 		while (exfat_bitmap_is_free(bs, nodep->idx->service_id, clst) == EOK) {
 			if (clst - lastc == count) {
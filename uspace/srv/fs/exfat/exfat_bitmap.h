@@ -34,6 +34,8 @@
 #define EXFAT_EXFAT_BITMAP_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <fibril_synch.h>
 #include "exfat.h"
 #include "exfat_fat.h"
 
@@ -41,6 +43,27 @@
 struct exfat_node;
 struct exfat_bs;
 
+/** In-memory copy of the allocation bitmap of a mounted file system. */
+typedef struct exfat_bitmap_cache {
+	fibril_mutex_t lock;
+	/** Contents of the bitmap, whole sectors. */
+	uint8_t *map;
+	/** One bit per bitmap sector modified since the last sync. */
+	uint8_t *dirty;
+	size_t sectors;
+	size_t bps;
+	/** Number of clusters described by the bitmap. */
+	exfat_cluster_t clusters;
+	exfat_cluster_t free_count;
+	/** Bit at which the next search for a free run starts. */
+	exfat_cluster_t next_free;
+} exfat_bitmap_cache_t;
+
+extern errno_t exfat_bitmap_cache_init(struct exfat_bs *, service_id_t);
+extern errno_t exfat_bitmap_cache_sync(struct exfat_bs *, service_id_t);
+extern errno_t exfat_bitmap_cache_fini(struct exfat_bs *, service_id_t);
+extern bool exfat_bitmap_free_count(service_id_t, uint64_t *);
+
 extern errno_t exfat_bitmap_alloc_clusters(struct exfat_bs *, service_id_t,
     exfat_cluster_t *, exfat_cluster_t);
 extern errno_t exfat_bitmap_append_clusters(struct exfat_bs *, struct exfat_node *,
@@ -53,6 +76,8 @@ extern errno_t exfat_bitmap_is_free(struct exfat_bs *, service_id_t, exfat_clust
 extern errno_t exfat_bitmap_set_cluster(struct exfat_bs *, service_id_t, exfat_cluster_t);
 extern errno_t exfat_bitmap_clear_cluster(struct exfat_bs *, service_id_t,
     exfat_cluster_t);
+extern errno_t exfat_bitmap_alloc_cluster(struct exfat_bs *, service_id_t,
+    exfat_cluster_t *);
 
 extern errno_t exfat_bitmap_set_clusters(struct exfat_bs *, service_id_t,
     exfat_cluster_t, exfat_cluster_t);
@@ -308,25 +308,22 @@ exfat_alloc_clusters(exfat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 		return ENOMEM;
 
 	fibril_mutex_lock(&exfat_alloc_lock);
-	for (clst = EXFAT_CLST_FIRST; clst < DATA_CNT(bs) + 2 && found < nclsts;
-	    clst++) {
-		/* Need to rewrite because of multiple exfat_bitmap_get calls */
-		if (exfat_bitmap_is_free(bs, service_id, clst) == EOK) {
-			/*
-			 * The cluster is free. Put it into our stack
-			 * of found clusters and mark it as non-free.
-			 */
-			lifo[found] = clst;
-			rc = exfat_set_cluster(bs, service_id, clst,
-			    (found == 0) ?  EXFAT_CLST_EOF : lifo[found - 1]);
-			if (rc != EOK)
-				goto exit_error;
-			found++;
-			rc = exfat_bitmap_set_cluster(bs, service_id, clst);
-			if (rc != EOK)
-				goto exit_error;
-
+	for (clst = EXFAT_CLST_FIRST; found < nclsts; clst++) {
+		/*
+		 * Find the next free cluster and mark it as non-free in the
+		 * bitmap. Then put it into our stack of found clusters.
+		 */
+		if (exfat_bitmap_alloc_cluster(bs, service_id, &clst) != EOK)
+			break;
+
+		lifo[found] = clst;
+		rc = exfat_set_cluster(bs, service_id, clst,
+		    (found == 0) ?  EXFAT_CLST_EOF : lifo[found - 1]);
+		if (rc != EOK) {
+			(void) exfat_bitmap_clear_cluster(bs, service_id, clst);
+			goto exit_error;
 		}
+		found++;
 	}
 
 	if (rc == EOK && found == nclsts) {
@@ -939,6 +939,9 @@ errno_t exfat_free_block_count(service_id_t service_id, uint64_t *count)
 	unsigned sector;
 	errno_t rc;
 
+	if (exfat_bitmap_free_count(service_id, count))
+		return EOK;
+
 	rc = exfat_total_block_count(service_id, &block_count);
 	if (rc != EOK)
 		goto exit;
@@ -1008,7 +1011,8 @@ libfs_ops_t exfat_libfs_ops = {
 	.service_get = exfat_service_get,
 	.size_block = exfat_size_block,
 	.total_block_count = exfat_total_block_count,
-	.free_block_count = exfat_free_block_count
+	.free_block_count = exfat_free_block_count,
+	.cache_stats = block_get_stats
 };
 
 static errno_t exfat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1298,6 +1302,12 @@ exfat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	if (rc != EOK)
 		return rc;
 
+	rc = exfat_bitmap_cache_init(block_bb_get(service_id), service_id);
+	if (rc != EOK) {
+		exfat_fs_close(service_id, rfn);
+		return rc;
+	}
+
 	*index = ridxp->index;
 	*size = EXFAT_NODE(rfn)->size;
 
@@ -1313,6 +1323,7 @@ static errno_t exfat_unmounted(service_id_t service_id)
 	if (rc != EOK)
 		return rc;
 
+	(void) exfat_bitmap_cache_fini(block_bb_get(service_id), service_id);
 	exfat_fs_close(service_id, rfn);
 	return EOK;
 }
@@ -1454,6 +1465,11 @@ static errno_t exfat_sync(service_id_t service_id, fs_index_t index)
 
 	nodep->dirty = true;
 	rc = exfat_node_sync(nodep);
+	if (rc == EOK) {
+		/* Bitmap changes are written back only here and at unmount. */
+		rc = exfat_bitmap_cache_sync(block_bb_get(service_id),
+		    service_id);
+	}
 
 	exfat_node_put(fn);
 	return rc;
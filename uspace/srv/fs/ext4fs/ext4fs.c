@@ -50,6 +50,7 @@
 
 vfs_info_t ext4fs_vfs_info = {
 	.name = NAME,
+	.cacheable = true,
 	.instance = 0
 };
 
@@ -57,9 +58,13 @@ int main(int argc, char **argv)
 {
 	printf("%s: HelenOS ext4 file system server\n", NAME);
 
-	if (argc == 3) {
-		if (!str_cmp(argv[1], "--instance"))
-			ext4fs_vfs_info.instance = strtol(argv[2], NULL, 10);
+	unsigned runners = FS_RUNNERS_DEFAULT;
+
+	for (int i = 1; i < argc; i += 2) {
+		if (i + 1 < argc && !str_cmp(argv[i], "--instance"))
+			ext4fs_vfs_info.instance = strtol(argv[i + 1], NULL, 10);
+		else if (i + 1 < argc && !str_cmp(argv[i], "--runners"))
+			runners = strtoul(argv[i + 1], NULL, 10);
 		else {
 			printf("%s: Unrecognized parameters\n", NAME);
 			return 1;
@@ -89,7 +94,9 @@ int main(int argc, char **argv)
 		return rc;
 	}
 
-	printf("%s: Accepting connections\n", NAME);
+	runners = fs_set_runners(runners);
+
+	printf("%s: Accepting connections (%u runners)\n", NAME, runners);
 	task_retval(0);
 	async_manager();
 
@@ -221,6 +221,16 @@ typedef struct {
 	struct fat_node	*nodep;
 } fat_idx_t;
 
+/** Run of consecutive clusters in a node's cluster chain. */
+typedef struct {
+	/** Index of the first cluster of the run within the chain. */
+	uint32_t	lclst;
+	/** First cluster of the run. */
+	fat_cluster_t	pclst;
+	/** Number of clusters in the run. */
+	uint32_t	count;
+} fat_extent_t;
+
 /** FAT in-core node. */
 typedef struct fat_node {
 	/** Back pointer to the FS node. */
@@ -249,14 +259,35 @@ typedef struct fat_node {
 	/* Node's last cluster in FAT. */
 	bool		lastc_cached_valid;
 	fat_cluster_t	lastc_cached_value;
-	/* Node's "current" cluster, i.e. where the last I/O took place. */
-	bool		currc_cached_valid;
-	aoff64_t	currc_cached_bn;
-	fat_cluster_t	currc_cached_value;
+
+	/*
+	 * Run-length map of the beginning of the node's cluster chain. It is
+	 * extended lazily as blocks further in the file are accessed.
+	 */
+	fat_extent_t	*extents;
+	size_t		extent_count;
+	size_t		extent_alloc;
+	/* Number of clusters covered by the extents. */
+	uint32_t	extent_clusters;
+	/* The extents cover the whole cluster chain. */
+	bool		extent_complete;
 } fat_node_t;
 
-typedef struct {
+typedef struct fat_instance {
 	bool lfn_enabled;
+
+	/*
+	 * In-memory copy of the free/used state of FAT1, built once at mount
+	 * time. Bit N is set if cluster N is free. The map and the counters
+	 * below are protected by the FAT allocation lock.
+	 */
+	uint32_t	*free_map;
+	/* Number of clusters described by the map, including the reserved. */
+	fat_cluster_t	free_map_clusters;
+	/* Number of free clusters. */
+	uint32_t	free_count;
+	/* Cluster at which the next search for free clusters starts. */
+	fat_cluster_t	next_free;
 } fat_instance_t;
 
 extern vfs_out_ops_t fat_ops;
@@ -47,6 +47,7 @@
 #include <align.h>
 #include <assert.h>
 #include <fibril_synch.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 
@@ -55,7 +56,8 @@
 /**
  * The fat_alloc_lock mutex protects all copies of the File Allocation Table
  * during allocation of clusters. The lock does not have to be held durring
- * deallocation of clusters.
+ * deallocation of clusters. It also protects the free cluster maps of all
+ * FAT instances.
  */
 static FIBRIL_MUTEX_INITIALIZE(fat_alloc_lock);
 
@@ -112,6 +114,122 @@ fat_cluster_walk(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc,
 	return EOK;
 }
 
+/** Add the next cluster of the chain to the node's extent map.
+ *
+ * @param nodep		FAT node.
+ * @param clst		Next cluster of the node's chain.
+ *
+ * @return		EOK on success or ENOMEM.
+ */
+static errno_t fat_extent_push(fat_node_t *nodep, fat_cluster_t clst)
+{
+	fat_extent_t *last = NULL;
+
+	if (nodep->extent_count > 0)
+		last = &nodep->extents[nodep->extent_count - 1];
+
+	if (last != NULL && last->pclst + last->count == clst) {
+		last->count++;
+		nodep->extent_clusters++;
+		return EOK;
+	}
+
+	if (nodep->extent_count == nodep->extent_alloc) {
+		size_t alloc = max(2 * nodep->extent_alloc, 8);
+		fat_extent_t *extents = realloc(nodep->extents,
+		    alloc * sizeof(fat_extent_t));
+		if (extents == NULL)
+			return ENOMEM;
+
+		nodep->extents = extents;
+		nodep->extent_alloc = alloc;
+	}
+
+	last = &nodep->extents[nodep->extent_count++];
+	last->lclst = nodep->extent_clusters;
+	last->pclst = clst;
+	last->count = 1;
+	nodep->extent_clusters++;
+
+	return EOK;
+}
+
+/** Drop the extent map of a node.
+ *
+ * @param nodep		FAT node.
+ */
+void fat_extents_free(fat_node_t *nodep)
+{
+	free(nodep->extents);
+	nodep->extents = NULL;
+	nodep->extent_count = 0;
+	nodep->extent_alloc = 0;
+	nodep->extent_clusters = 0;
+	nodep->extent_complete = false;
+}
+
+/** Find the cluster of a node by its index within the cluster chain.
+ *
+ * The node's extent map is extended along the chain as far as needed, so
+ * each FAT entry of the node is read at most once while the node stays in
+ * memory. The lookup itself is a binary search of the extents.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param lcl		Index of the cluster within the chain.
+ * @param clst		Output argument holding the cluster number.
+ *
+ * @return		EOK on success, ELIMIT if the chain is shorter or
+ *			another error code.
+ */
+errno_t fat_cluster_map(fat_bs_t *bs, fat_node_t *nodep, uint32_t lcl,
+    fat_cluster_t *clst)
+{
+	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	errno_t rc;
+
+	while (lcl >= nodep->extent_clusters && !nodep->extent_complete) {
+		fat_cluster_t next = nodep->firstc;
+
+		if (nodep->extent_count > 0) {
+			fat_extent_t *last =
+			    &nodep->extents[nodep->extent_count - 1];
+
+			rc = fat_get_cluster(bs, nodep->idx->service_id, FAT1,
+			    last->pclst + last->count - 1, &next);
+			if (rc != EOK)
+				return rc;
+		}
+
+		if (next == FAT_CLST_RES0 || next >= clst_last1) {
+			nodep->extent_complete = true;
+			break;
+		}
+
+		assert(next >= FAT_CLST_FIRST);
+		rc = fat_extent_push(nodep, next);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if (lcl >= nodep->extent_clusters)
+		return ELIMIT;
+
+	size_t l = 0;
+	size_t r = nodep->extent_count;
+
+	while (r - l > 1) {
+		size_t m = l + (r - l) / 2;
+		if (nodep->extents[m].lclst <= lcl)
+			l = m;
+		else
+			r = m;
+	}
+
+	*clst = nodep->extents[l].pclst + (lcl - nodep->extents[l].lclst);
+	return EOK;
+}
+
 /** Read block from file located on a FAT file system.
  *
  * @param block		Pointer to a block pointer for storing result.
@@ -126,16 +244,35 @@ errno_t
 fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
     aoff64_t bn, int flags)
 {
-	fat_cluster_t firstc = nodep->firstc;
-	fat_cluster_t currc = 0;
-	aoff64_t relbn = bn;
+	return fat_block_get_range(block, bs, nodep, bn, 1, flags);
+}
+
+/** Read consecutive blocks of one cluster of a file on a FAT file system.
+ *
+ * @param blocks	Array for storing @a cnt block pointers.
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param bn		Number of the first block.
+ * @param cnt		Number of blocks, they must all lie in the cluster
+ *			of the first block.
+ * @param flags		Flags passed to libblock.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+fat_block_get_range(block_t **blocks, struct fat_bs *bs, fat_node_t *nodep,
+    aoff64_t bn, size_t cnt, int flags)
+{
+	fat_cluster_t c;
 	errno_t rc;
 
 	if (!nodep->size)
 		return ELIMIT;
 
-	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT)
-		goto fall_through;
+	if (!FAT_IS_FAT32(bs) && nodep->firstc == FAT_CLST_ROOT) {
+		return _fat_block_get_range(blocks, bs, nodep->idx->service_id,
+		    nodep->firstc, NULL, bn, cnt, flags);
+	}
 
 	if (((((nodep->size - 1) / BPS(bs)) / SPC(bs)) == bn / SPC(bs)) &&
 	    nodep->lastc_cached_valid) {
@@ -143,33 +280,19 @@ fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
 		 * This is a request to read a block within the last cluster
 		 * when fortunately we have the last cluster number cached.
 		 */
-		return block_get(block, nodep->idx->service_id,
-		    CLBN2PBN(bs, nodep->lastc_cached_value, bn), flags);
+		return block_get_range(blocks, nodep->idx->service_id,
+		    CLBN2PBN(bs, nodep->lastc_cached_value, bn), cnt, flags);
 	}
 
-	if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
-		/*
-		 * We can start with the cluster cached by the previous call to
-		 * fat_block_get().
-		 */
-		firstc = nodep->currc_cached_value;
-		relbn -= (nodep->currc_cached_bn / SPC(bs)) * SPC(bs);
-	}
+	assert(cnt > 0);
+	assert(bn / SPC(bs) == (bn + cnt - 1) / SPC(bs));
 
-fall_through:
-	rc = _fat_block_get(block, bs, nodep->idx->service_id, firstc,
-	    &currc, relbn, flags);
+	rc = fat_cluster_map(bs, nodep, bn / SPC(bs), &c);
 	if (rc != EOK)
 		return rc;
 
-	/*
-	 * Update the "current" cluster cache.
-	 */
-	nodep->currc_cached_valid = true;
-	nodep->currc_cached_bn = bn;
-	nodep->currc_cached_value = currc;
-
-	return rc;
+	return block_get_range(blocks, nodep->idx->service_id,
+	    CLBN2PBN(bs, c, bn), cnt, flags);
 }
 
 /** Read block from file located on a FAT file system.
@@ -190,6 +313,30 @@ fall_through:
 errno_t
 _fat_block_get(block_t **block, fat_bs_t *bs, service_id_t service_id,
     fat_cluster_t fcl, fat_cluster_t *clp, aoff64_t bn, int flags)
+{
+	return _fat_block_get_range(block, bs, service_id, fcl, clp, bn, 1,
+	    flags);
+}
+
+/** Read consecutive blocks of one cluster of a file on a FAT file system.
+ *
+ * @param blocks	Array for storing @a cnt block pointers.
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID handle of the file system.
+ * @param fcl		First cluster used by the file. Can be zero if the file
+ *			is empty.
+ * @param clp		If not NULL, address where the cluster containing bn
+ *			will be stored.
+ * @param bn		Number of the first block.
+ * @param cnt		Number of blocks, they must all lie in the cluster
+ *			of the first block.
+ * @param flags		Flags passed to libblock.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+_fat_block_get_range(block_t **blocks, fat_bs_t *bs, service_id_t service_id,
+    fat_cluster_t fcl, fat_cluster_t *clp, aoff64_t bn, size_t cnt, int flags)
 {
 	uint32_t clusters;
 	uint32_t max_clusters;
@@ -204,19 +351,23 @@ _fat_block_get(block_t **block, fat_bs_t *bs, service_id_t service_id,
 
 	if (!FAT_IS_FAT32(bs) && fcl == FAT_CLST_ROOT) {
 		/* root directory special case */
-		assert(bn < RDS(bs));
-		rc = block_get(block, service_id,
-		    RSCNT(bs) + FATCNT(bs) * SF(bs) + bn, flags);
+		assert(bn + cnt <= RDS(bs));
+		rc = block_get_range(blocks, service_id,
+		    RSCNT(bs) + FATCNT(bs) * SF(bs) + bn, cnt, flags);
 		return rc;
 	}
 
+	assert(cnt > 0);
+	assert(bn / SPC(bs) == (bn + cnt - 1) / SPC(bs));
+
 	max_clusters = bn / SPC(bs);
 	rc = fat_cluster_walk(bs, service_id, fcl, &c, &clusters, max_clusters);
 	if (rc != EOK)
 		return rc;
 	assert(clusters == max_clusters);
 
-	rc = block_get(block, service_id, CLBN2PBN(bs, c, bn), flags);
+	rc = block_get_range(blocks, service_id, CLBN2PBN(bs, c, bn), cnt,
+	    flags);
 
 	if (clp)
 		*clp = c;
@@ -654,6 +805,280 @@ errno_t fat_alloc_shadow_clusters(fat_bs_t *bs, service_id_t service_id,
 	return EOK;
 }
 
+/** Number of clusters described by one word of the free cluster map. */
+#define FREE_MAP_BITS	32
+
+static bool fat_free_map_test(fat_instance_t *inst, fat_cluster_t clst)
+{
+	return (inst->free_map[clst / FREE_MAP_BITS] &
+	    (1U << (clst % FREE_MAP_BITS))) != 0;
+}
+
+/** Mark a cluster as free or used in the free cluster map.
+ *
+ * The caller must hold fat_alloc_lock.
+ *
+ * @param inst		FAT instance.
+ * @param clst		Cluster to mark.
+ * @param free		True if the cluster is now free.
+ */
+static void fat_free_map_set(fat_instance_t *inst, fat_cluster_t clst,
+    bool free)
+{
+	uint32_t mask = 1U << (clst % FREE_MAP_BITS);
+	uint32_t *word;
+
+	if (clst >= inst->free_map_clusters)
+		return;
+
+	word = &inst->free_map[clst / FREE_MAP_BITS];
+	if (free && !(*word & mask)) {
+		*word |= mask;
+		inst->free_count++;
+	} else if (!free && (*word & mask)) {
+		*word &= ~mask;
+		inst->free_count--;
+	}
+}
+
+/** Find a run of contiguous free clusters in the free cluster map.
+ *
+ * Words with no free cluster and words with no used cluster are skipped
+ * as a whole.
+ *
+ * @param inst		FAT instance.
+ * @param start		First cluster to consider.
+ * @param end		First cluster not to consider.
+ * @param want		Length of the run.
+ * @param first		Output parameter where the first cluster of the
+ *			run will be returned.
+ *
+ * @return		True if a run was found.
+ */
+static bool fat_free_map_find_run(fat_instance_t *inst, fat_cluster_t start,
+    fat_cluster_t end, unsigned want, fat_cluster_t *first)
+{
+	fat_cluster_t clst = start;
+	unsigned run = 0;
+
+	while (clst < end) {
+		uint32_t word = inst->free_map[clst / FREE_MAP_BITS];
+
+		if (clst % FREE_MAP_BITS == 0 && end - clst >= FREE_MAP_BITS) {
+			if (word == 0) {
+				run = 0;
+				clst += FREE_MAP_BITS;
+				continue;
+			}
+			if (word == UINT32_MAX) {
+				if (run == 0)
+					*first = clst;
+				run += FREE_MAP_BITS;
+				clst += FREE_MAP_BITS;
+				if (run >= want)
+					return true;
+				continue;
+			}
+		}
+
+		if (word & (1U << (clst % FREE_MAP_BITS))) {
+			if (run == 0)
+				*first = clst;
+			if (++run >= want)
+				return true;
+		} else {
+			run = 0;
+		}
+		clst++;
+	}
+
+	return false;
+}
+
+/** Collect free clusters from the free cluster map.
+ *
+ * @param inst		FAT instance.
+ * @param start		First cluster to consider.
+ * @param end		First cluster not to consider.
+ * @param clsts		Array where the free clusters will be stored in
+ *			ascending order.
+ * @param want		Maximum number of clusters to collect.
+ *
+ * @return		Number of clusters collected.
+ */
+static unsigned fat_free_map_gather(fat_instance_t *inst, fat_cluster_t start,
+    fat_cluster_t end, fat_cluster_t *clsts, unsigned want)
+{
+	fat_cluster_t clst = start;
+	unsigned found = 0;
+
+	while (clst < end && found < want) {
+		if (clst % FREE_MAP_BITS == 0 &&
+		    inst->free_map[clst / FREE_MAP_BITS] == 0) {
+			clst += FREE_MAP_BITS;
+			continue;
+		}
+		if (fat_free_map_test(inst, clst))
+			clsts[found++] = clst;
+		clst++;
+	}
+
+	return found;
+}
+
+/** Pick free clusters for a new cluster chain using the free cluster map.
+ *
+ * A contiguous run is preferred. The search starts at the allocation hint
+ * and wraps around. The picked clusters are marked as used in the map.
+ *
+ * The caller must hold fat_alloc_lock.
+ *
+ * @param inst		FAT instance.
+ * @param nclsts	Number of clusters to pick.
+ * @param lifo		Array where the clusters will be stored, last cluster
+ *			of the chain first.
+ *
+ * @return		EOK on success, ENOSPC if there are not enough free
+ *			clusters.
+ */
+static errno_t fat_free_map_alloc(fat_instance_t *inst, unsigned nclsts,
+    fat_cluster_t *lifo)
+{
+	fat_cluster_t end = inst->free_map_clusters;
+	fat_cluster_t hint = inst->next_free;
+	fat_cluster_t first;
+	fat_cluster_t tmp;
+	unsigned found;
+	unsigned i;
+
+	if (inst->free_count < nclsts)
+		return ENOSPC;
+
+	if (hint < FAT_CLST_FIRST || hint >= end)
+		hint = FAT_CLST_FIRST;
+
+	if (fat_free_map_find_run(inst, hint, end, nclsts, &first) ||
+	    fat_free_map_find_run(inst, FAT_CLST_FIRST,
+	    min(hint + nclsts - 1, end), nclsts, &first)) {
+		for (i = 0; i < nclsts; i++)
+			lifo[nclsts - 1 - i] = first + i;
+	} else {
+		/* The free space is fragmented, take what there is. */
+		found = fat_free_map_gather(inst, hint, end, lifo, nclsts);
+		found += fat_free_map_gather(inst, FAT_CLST_FIRST, hint,
+		    lifo + found, nclsts - found);
+		if (found < nclsts)
+			return ENOSPC;
+
+		for (i = 0; i < nclsts / 2; i++) {
+			tmp = lifo[i];
+			lifo[i] = lifo[nclsts - 1 - i];
+			lifo[nclsts - 1 - i] = tmp;
+		}
+	}
+
+	for (i = 0; i < nclsts; i++)
+		fat_free_map_set(inst, lifo[i], false);
+	inst->next_free = lifo[0] + 1;
+
+	return EOK;
+}
+
+/** Get the FAT instance of a file system if it has a free cluster map.
+ *
+ * @param service_id	Device service ID of the file system.
+ *
+ * @return		FAT instance or NULL.
+ */
+static fat_instance_t *fat_free_map_instance(service_id_t service_id)
+{
+	void *data;
+
+	if (fs_instance_get(service_id, &data) != EOK)
+		return NULL;
+	if (((fat_instance_t *) data)->free_map == NULL)
+		return NULL;
+	return (fat_instance_t *) data;
+}
+
+/** Build the free cluster map of a file system.
+ *
+ * FAT1 is scanned once and the state of each cluster is recorded in the map
+ * so that allocations do not have to search the FAT.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Device service ID of the file system.
+ * @param inst		FAT instance which will own the map.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_free_map_init(fat_bs_t *bs, service_id_t service_id,
+    fat_instance_t *inst)
+{
+	fat_cluster_t clusters = CC(bs) + 2;
+	fat_cluster_t clst;
+	fat_cluster_t value;
+	errno_t rc;
+
+	inst->free_map = calloc((clusters + FREE_MAP_BITS - 1) / FREE_MAP_BITS,
+	    sizeof(uint32_t));
+	if (inst->free_map == NULL)
+		return ENOMEM;
+	inst->free_map_clusters = clusters;
+	inst->free_count = 0;
+	inst->next_free = FAT_CLST_FIRST;
+
+	for (clst = FAT_CLST_FIRST; clst < clusters; clst++) {
+		rc = fat_get_cluster(bs, service_id, FAT1, clst, &value);
+		if (rc != EOK) {
+			fat_free_map_fini(inst);
+			return rc;
+		}
+		if (value == FAT_CLST_RES0)
+			fat_free_map_set(inst, clst, true);
+	}
+
+	return EOK;
+}
+
+/** Destroy the free cluster map of a file system.
+ *
+ * @param inst		FAT instance which owns the map.
+ */
+void fat_free_map_fini(fat_instance_t *inst)
+{
+	free(inst->free_map);
+	inst->free_map = NULL;
+	inst->free_count = 0;
+}
+
+/** Get the number of free clusters from the free cluster map.
+ *
+ * @param service_id	Device service ID of the file system.
+ * @param free_count	Output parameter where the number of free clusters
+ *			will be returned.
+ * @param next_free	If not NULL, output parameter where the cluster at
+ *			which the next allocation starts will be returned.
+ *
+ * @return		True if the file system has a free cluster map.
+ */
+bool fat_free_map_stat(service_id_t service_id, uint32_t *free_count,
+    fat_cluster_t *next_free)
+{
+	fat_instance_t *inst = fat_free_map_instance(service_id);
+
+	if (inst == NULL)
+		return false;
+
+	fibril_mutex_lock(&fat_alloc_lock);
+	*free_count = inst->free_count;
+	if (next_free != NULL)
+		*next_free = inst->next_free;
+	fibril_mutex_unlock(&fat_alloc_lock);
+
+	return true;
+}
+
 /** Allocate clusters in all copies of FAT.
  *
  * This function will attempt to allocate the requested number of clusters in
@@ -680,18 +1105,39 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 	fat_cluster_t clst;
 	fat_cluster_t value = 0;
 	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_instance_t *inst;
 	errno_t rc = EOK;
 
 	lifo = (fat_cluster_t *) malloc(nclsts * sizeof(fat_cluster_t));
 	if (!lifo)
 		return ENOMEM;
 
+	fibril_mutex_lock(&fat_alloc_lock);
+	inst = fat_free_map_instance(service_id);
+	if (inst != NULL) {
+		/*
+		 * Pick the clusters from the free cluster map and link them in
+		 * FAT1.
+		 */
+		if (fat_free_map_alloc(inst, nclsts, lifo) != EOK) {
+			free(lifo);
+			fibril_mutex_unlock(&fat_alloc_lock);
+			return ENOSPC;
+		}
+
+		for (; found < nclsts; found++) {
+			rc = fat_set_cluster(bs, service_id, FAT1, lifo[found],
+			    (found == 0) ?  clst_last1 : lifo[found - 1]);
+			if (rc != EOK)
+				break;
+		}
+	}
+
 	/*
 	 * Search FAT1 for unused clusters.
 	 */
-	fibril_mutex_lock(&fat_alloc_lock);
-	for (clst = FAT_CLST_FIRST; clst < CC(bs) + 2 && found < nclsts;
-	    clst++) {
+	for (clst = FAT_CLST_FIRST; inst == NULL && clst < CC(bs) + 2 &&
+	    found < nclsts; clst++) {
 		rc = fat_get_cluster(bs, service_id, FAT1, clst, &value);
 		if (rc != EOK)
 			break;
@@ -728,6 +1174,11 @@ fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
 		    FAT_CLST_RES0);
 	}
 
+	if (inst != NULL) {
+		for (found = 0; found < nclsts; found++)
+			fat_free_map_set(inst, lifo[found], true);
+	}
+
 	free(lifo);
 	fibril_mutex_unlock(&fat_alloc_lock);
 
@@ -748,6 +1199,7 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 	unsigned fatno;
 	fat_cluster_t nextc = 0;
 	fat_cluster_t clst_bad = FAT_CLST_BAD(bs);
+	fat_instance_t *inst = fat_free_map_instance(service_id);
 	errno_t rc;
 
 	/* Mark all clusters in the chain as free in all copies of FAT. */
@@ -765,6 +1217,13 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 				return rc;
 		}
 
+		/* Only now can the cluster be handed out again. */
+		if (inst != NULL) {
+			fibril_mutex_lock(&fat_alloc_lock);
+			fat_free_map_set(inst, firstc, true);
+			fibril_mutex_unlock(&fat_alloc_lock);
+		}
+
 		firstc = nextc;
 	}
 
@@ -788,6 +1247,9 @@ errno_t fat_append_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t mcl,
 	uint8_t fatno;
 	errno_t rc;
 
+	/* The extent map will find the appended clusters when needed. */
+	nodep->extent_complete = false;
+
 	if (nodep->firstc == FAT_CLST_RES0) {
 		/* No clusters allocated to the node yet. */
 		nodep->firstc = mcl;
@@ -817,6 +1279,35 @@ errno_t fat_append_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t mcl,
 	return EOK;
 }
 
+/** Cut a node's extent map after the cluster which becomes the last one.
+ *
+ * @param nodep		FAT node.
+ * @param lcl		Last cluster which will remain in the node, or
+ *			FAT_CLST_RES0 if none will.
+ */
+static void fat_extents_chop(fat_node_t *nodep, fat_cluster_t lcl)
+{
+	nodep->extent_complete = false;
+
+	if (lcl == FAT_CLST_RES0) {
+		fat_extents_free(nodep);
+		return;
+	}
+
+	for (size_t i = 0; i < nodep->extent_count; i++) {
+		fat_extent_t *e = &nodep->extents[i];
+
+		if (lcl >= e->pclst && lcl - e->pclst < e->count) {
+			e->count = lcl - e->pclst + 1;
+			nodep->extent_count = i + 1;
+			nodep->extent_clusters = e->lclst + e->count;
+			return;
+		}
+	}
+
+	/* The map only covers clusters before lcl, which all remain. */
+}
+
 /** Chop off node clusters in all copies of FAT.
  *
  * @param bs		Buffer holding the boot sector of the file system.
@@ -834,11 +1325,11 @@ errno_t fat_chop_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t lcl)
 	service_id_t service_id = nodep->idx->service_id;
 
 	/*
-	 * Invalidate cached cluster numbers.
+	 * Invalidate cached cluster numbers and cut the extent map after
+	 * the new last cluster.
 	 */
 	nodep->lastc_cached_valid = false;
-	if (nodep->currc_cached_value != lcl)
-		nodep->currc_cached_valid = false;
+	fat_extents_chop(nodep, lcl);
 
 	if (lcl == FAT_CLST_RES0) {
 		/* The node will have zero size and no clusters allocated. */
@@ -881,23 +1372,29 @@ errno_t fat_chop_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t lcl)
 errno_t
 fat_zero_cluster(struct fat_bs *bs, service_id_t service_id, fat_cluster_t c)
 {
+	block_t **blocks;
 	int i;
-	block_t *b;
 	errno_t rc;
 
+	blocks = calloc(SPC(bs), sizeof(block_t *));
+	if (blocks == NULL)
+		return ENOMEM;
+
+	rc = _fat_block_get_range(blocks, bs, service_id, c, NULL, 0, SPC(bs),
+	    BLOCK_FLAGS_NOREAD);
+	if (rc != EOK) {
+		free(blocks);
+		return rc;
+	}
+
 	for (i = 0; i < SPC(bs); i++) {
-		rc = _fat_block_get(&b, bs, service_id, c, NULL, i,
-		    BLOCK_FLAGS_NOREAD);
-		if (rc != EOK)
-			return rc;
-		memset(b->data, 0, BPS(bs));
-		b->dirty = true;
-		rc = block_put(b);
-		if (rc != EOK)
-			return rc;
+		memset(blocks[i]->data, 0, BPS(bs));
+		blocks[i]->dirty = true;
 	}
 
-	return EOK;
+	rc = block_put_range(blocks, SPC(bs));
+	free(blocks);
+	return rc;
 }
 
 /** Perform basic sanity checks on the file system.
@@ -36,6 +36,7 @@
 
 #include "../../vfs/vfs.h"
 #include <stdint.h>
+#include <stdbool.h>
 #include <block.h>
 
 #define FAT1		0
@@ -102,6 +103,7 @@
 struct block;
 struct fat_node;
 struct fat_bs;
+struct fat_instance;
 
 typedef uint32_t fat_cluster_t;
 
@@ -110,10 +112,18 @@ typedef uint32_t fat_cluster_t;
 extern errno_t fat_cluster_walk(struct fat_bs *, service_id_t, fat_cluster_t,
     fat_cluster_t *, uint32_t *, uint32_t);
 
+extern errno_t fat_cluster_map(struct fat_bs *, struct fat_node *, uint32_t,
+    fat_cluster_t *);
+extern void fat_extents_free(struct fat_node *);
+
 extern errno_t fat_block_get(block_t **, struct fat_bs *, struct fat_node *,
     aoff64_t, int);
 extern errno_t _fat_block_get(block_t **, struct fat_bs *, service_id_t,
     fat_cluster_t, fat_cluster_t *, aoff64_t, int);
+extern errno_t fat_block_get_range(block_t **, struct fat_bs *,
+    struct fat_node *, aoff64_t, size_t, int);
+extern errno_t _fat_block_get_range(block_t **, struct fat_bs *, service_id_t,
+    fat_cluster_t, fat_cluster_t *, aoff64_t, size_t, int);
 
 extern errno_t fat_append_clusters(struct fat_bs *, struct fat_node *,
     fat_cluster_t, fat_cluster_t);
@@ -122,6 +132,10 @@ extern errno_t fat_chop_clusters(struct fat_bs *, struct fat_node *,
 extern errno_t fat_alloc_clusters(struct fat_bs *, service_id_t, unsigned,
     fat_cluster_t *, fat_cluster_t *);
 extern errno_t fat_free_clusters(struct fat_bs *, service_id_t, fat_cluster_t);
+extern errno_t fat_free_map_init(struct fat_bs *, service_id_t,
+    struct fat_instance *);
+extern void fat_free_map_fini(struct fat_instance *);
+extern bool fat_free_map_stat(service_id_t, uint32_t *, fat_cluster_t *);
 extern errno_t fat_alloc_shadow_clusters(struct fat_bs *, service_id_t,
     fat_cluster_t *, unsigned);
 extern errno_t fat_get_cluster(struct fat_bs *, service_id_t, unsigned,
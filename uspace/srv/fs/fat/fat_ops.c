@@ -108,9 +108,8 @@ static void fat_node_initialize(fat_node_t *node)
 	node->dirty = false;
 	node->lastc_cached_valid = false;
 	node->lastc_cached_value = 0;
-	node->currc_cached_valid = false;
-	node->currc_cached_bn = 0;
-	node->currc_cached_value = 0;
+	node->extents = NULL;
+	fat_extents_free(node);
 }
 
 static errno_t fat_node_sync(fat_node_t *node)
@@ -192,6 +191,7 @@ restart:
 				return rc;
 		}
 		nodep->idx->nodep = NULL;
+		fat_extents_free(nodep);
 		free(nodep->bp);
 		free(nodep);
 
@@ -230,6 +230,7 @@ static errno_t fat_node_get_new(fat_node_t **nodepp)
 				idxp_tmp->nodep = NULL;
 				fibril_mutex_unlock(&nodep->lock);
 				fibril_mutex_unlock(&idxp_tmp->lock);
+				fat_extents_free(nodep);
 				free(nodep->bp);
 				free(nodep);
 				return rc;
@@ -238,6 +239,7 @@ static errno_t fat_node_get_new(fat_node_t **nodepp)
 		idxp_tmp->nodep = NULL;
 		fibril_mutex_unlock(&nodep->lock);
 		fibril_mutex_unlock(&idxp_tmp->lock);
+		fat_extents_free(nodep);
 		fn = FS_NODE(nodep);
 	} else {
 	skip_cache:
@@ -476,6 +478,7 @@ errno_t fat_node_put(fs_node_t *fn)
 	}
 	fibril_mutex_unlock(&nodep->lock);
 	if (destroy) {
+		fat_extents_free(nodep);
 		free(nodep->bp);
 		free(nodep);
 	}
@@ -569,6 +572,7 @@ errno_t fat_destroy_node(fs_node_t *fn)
 	}
 
 	fat_idx_destroy(nodep->idx);
+	fat_extents_free(nodep);
 	free(nodep->bp);
 	free(nodep);
 	return rc;
@@ -868,6 +872,12 @@ errno_t fat_free_block_count(service_id_t service_id, uint64_t *count)
 	uint64_t block_count;
 	errno_t rc;
 	uint32_t cluster_no, clusters;
+	uint32_t free_count;
+
+	if (fat_free_map_stat(service_id, &free_count, NULL)) {
+		*count = free_count;
+		return EOK;
+	}
 
 	block_count = 0;
 	bs = block_bb_get(service_id);
@@ -905,7 +915,8 @@ libfs_ops_t fat_libfs_ops = {
 	.service_get = fat_service_get,
 	.size_block = fat_size_block,
 	.total_block_count = fat_total_block_count,
-	.free_block_count = fat_free_block_count
+	.free_block_count = fat_free_block_count,
+	.cache_stats = block_get_stats
 };
 
 static errno_t fat_fs_open(service_id_t service_id, enum cache_mode cmode,
@@ -1088,6 +1099,7 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	if (!instance)
 		return ENOMEM;
 	instance->lfn_enabled = true;
+	instance->free_map = NULL;
 
 	/* Parse mount options. */
 	char *mntopts = (char *) opts;
@@ -1105,12 +1117,24 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 		return rc;
 	}
 
+	/*
+	 * Without the free cluster map, allocations fall back to searching
+	 * the FAT.
+	 */
+	rc = fat_free_map_init(block_bb_get(service_id), service_id, instance);
+	if (rc != EOK && rc != ENOMEM) {
+		fat_fs_close(service_id, rfn);
+		free(instance);
+		return rc;
+	}
+
 	fibril_mutex_lock(&ridxp->lock);
 
 	rc = fs_instance_create(service_id, instance);
 	if (rc != EOK) {
 		fibril_mutex_unlock(&ridxp->lock);
 		fat_fs_close(service_id, rfn);
+		fat_free_map_fini(instance);
 		free(instance);
 		return rc;
 	}
@@ -1127,6 +1151,8 @@ static errno_t fat_update_fat32_fsinfo(service_id_t service_id)
 {
 	fat_bs_t *bs;
 	fat32_fsinfo_t *info;
+	uint32_t free_count;
+	fat_cluster_t next_free;
 	block_t *b;
 	errno_t rc;
 
@@ -1147,8 +1173,13 @@ static errno_t fat_update_fat32_fsinfo(service_id_t service_id)
 		return EINVAL;
 	}
 
-	/* For now, invalidate the counter. */
-	info->free_clusters = host2uint16_t_le(-1);
+	if (fat_free_map_stat(service_id, &free_count, &next_free)) {
+		info->free_clusters = host2uint32_t_le(free_count);
+		info->last_allocated_cluster = host2uint32_t_le(next_free);
+	} else {
+		/* Invalidate the counter. */
+		info->free_clusters = host2uint32_t_le(UINT32_MAX);
+	}
 
 	b->dirty = true;
 	return block_put(b);
@@ -1200,12 +1231,93 @@ static errno_t fat_unmounted(service_id_t service_id)
 	void *data;
 	if (fs_instance_get(service_id, &data) == EOK) {
 		fs_instance_destroy(service_id);
+		fat_free_map_fini((fat_instance_t *) data);
 		free(data);
 	}
 
 	return EOK;
 }
 
+/** Maximum number of bytes returned by one read of a regular file. */
+#define FAT_READ_MAX_BYTES	(64 * 1024)
+
+/** Read data of a regular file, within one cluster at most.
+ *
+ * @param call		Data read call to answer.
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		Node of the file.
+ * @param pos		Position in the file, below its size.
+ * @param len		Number of bytes requested.
+ * @param rbytes	Place to store the number of bytes read.
+ *
+ * @return		EOK on success or an error code. The call is answered
+ *			in either case.
+ */
+static errno_t
+fat_read_file(ipc_call_t *call, fat_bs_t *bs, fat_node_t *nodep,
+    aoff64_t pos, size_t len, size_t *rbytes)
+{
+	aoff64_t bn = pos / BPS(bs);
+	size_t offset = pos % BPS(bs);
+	size_t bytes;
+	size_t cnt;
+	block_t *one;
+	block_t **blocks = &one;
+	errno_t rc;
+
+	bytes = min(len, nodep->size - pos);
+	bytes = min(bytes, (SPC(bs) - bn % SPC(bs)) * BPS(bs) - offset);
+	bytes = min(bytes, FAT_READ_MAX_BYTES - offset);
+	cnt = (offset + bytes + BPS(bs) - 1) / BPS(bs);
+
+	if (cnt > 1) {
+		blocks = calloc(cnt, sizeof(block_t *));
+		if (blocks == NULL) {
+			/* Make do with the first block. */
+			blocks = &one;
+			bytes = BPS(bs) - offset;
+			cnt = 1;
+		}
+	}
+
+	rc = fat_block_get_range(blocks, bs, nodep, bn, cnt, BLOCK_FLAGS_NONE);
+	if (rc != EOK) {
+		if (blocks != &one)
+			free(blocks);
+		async_answer_0(call, rc);
+		return rc;
+	}
+
+	uint8_t *buf = NULL;
+	if (cnt > 1)
+		buf = malloc(bytes);
+
+	if (buf != NULL) {
+		size_t done = 0;
+
+		for (size_t i = 0; i < cnt; i++) {
+			size_t from = i == 0 ? offset : 0;
+			size_t n = min(BPS(bs) - from, bytes - done);
+
+			memcpy(buf + done, blocks[i]->data + from, n);
+			done += n;
+		}
+		(void) async_data_read_finalize(call, buf, bytes);
+		free(buf);
+	} else {
+		bytes = min(bytes, BPS(bs) - offset);
+		(void) async_data_read_finalize(call, blocks[0]->data + offset,
+		    bytes);
+	}
+
+	rc = block_put_range(blocks, cnt);
+	if (blocks != &one)
+		free(blocks);
+
+	*rbytes = bytes;
+	return rc;
+}
+
 static errno_t
 fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *rbytes)
@@ -1214,7 +1326,6 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	fat_node_t *nodep;
 	fat_bs_t *bs;
 	size_t bytes;
-	block_t *b;
 	errno_t rc;
 
 	rc = fat_node_get(&fn, service_id, index);
@@ -1236,27 +1347,17 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 
 	if (nodep->type == FAT_FILE) {
 		/*
-		 * Our strategy for regular file reads is to read one block at
-		 * most and make use of the possibility to return less data than
-		 * requested. This keeps the code very simple.
+		 * Our strategy for regular file reads is to read within one
+		 * cluster at most and make use of the possibility to return
+		 * less data than requested. This keeps the code simple while
+		 * the blocks of the cluster are read from the device at once.
 		 */
 		if (pos >= nodep->size) {
 			/* reading beyond the EOF */
 			bytes = 0;
 			(void) async_data_read_finalize(&call, NULL, 0);
 		} else {
-			bytes = min(len, BPS(bs) - pos % BPS(bs));
-			bytes = min(bytes, nodep->size - pos);
-			rc = fat_block_get(&b, bs, nodep, pos / BPS(bs),
-			    BLOCK_FLAGS_NONE);
-			if (rc != EOK) {
-				fat_node_put(fn);
-				async_answer_0(&call, rc);
-				return rc;
-			}
-			(void) async_data_read_finalize(&call,
-			    b->data + pos % BPS(bs), bytes);
-			rc = block_put(b);
+			rc = fat_read_file(&call, bs, nodep, pos, len, &bytes);
 			if (rc != EOK) {
 				fat_node_put(fn);
 				return rc;
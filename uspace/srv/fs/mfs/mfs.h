@@ -155,6 +155,21 @@ struct mfs_instance {
 	service_id_t service_id;
 	struct mfs_sb_info *sbi;
 	unsigned open_nodes_cnt;
+	/*
+	 * In-memory copies of the zone and inode bitmaps in host byte order,
+	 * indexed by bmap_id_t. NULL if the bitmap is accessed on disk.
+	 */
+	bitchunk_t *bmap[2];
+};
+
+/* Number of indirect zones cached for each open node */
+#define MFS_IND_CACHE_SIZE	3
+
+/* Cached content of an indirect zone, in host byte order */
+struct mfs_ind_cache_entry {
+	/* Zero if the entry is unused */
+	uint32_t zone;
+	uint32_t *ptrs;
 };
 
 /* MinixFS node in core */
@@ -164,6 +179,9 @@ struct mfs_node {
 	unsigned refcnt;
 	fs_node_t *fsnode;
 	ht_link_t link;
+	struct mfs_ind_cache_entry ind_cache[MFS_IND_CACHE_SIZE];
+	/* Next entry of ind_cache to be replaced */
+	unsigned ind_cache_next;
 };
 
 /* mfs_ops.c */
@@ -186,7 +204,7 @@ mfs_inode_shrink(struct mfs_node *mnode, size_t size_shrink);
 
 /* mfs_rw.c */
 extern errno_t
-mfs_read_map(uint32_t *b, const struct mfs_node *mnode, const uint32_t pos);
+mfs_read_map(uint32_t *b, struct mfs_node *mnode, const uint32_t pos);
 
 extern errno_t
 mfs_write_map(struct mfs_node *mnode, uint32_t pos, uint32_t new_zone,
@@ -195,6 +213,12 @@ mfs_write_map(struct mfs_node *mnode, uint32_t pos, uint32_t new_zone,
 extern errno_t
 mfs_prune_ind_zones(struct mfs_node *mnode, size_t new_size);
 
+extern void
+mfs_ind_cache_init(struct mfs_node *mnode);
+
+extern void
+mfs_ind_cache_fini(struct mfs_node *mnode);
+
 /* mfs_dentry.c */
 extern errno_t
 mfs_read_dentry(struct mfs_node *mnode,
@@ -228,6 +252,12 @@ mfs_count_free_zones(struct mfs_instance *inst, uint32_t *zones);
 extern errno_t
 mfs_count_free_inodes(struct mfs_instance *inst, uint32_t *inodes);
 
+extern errno_t
+mfs_bitmaps_load(struct mfs_instance *inst);
+
+extern void
+mfs_bitmaps_free(struct mfs_instance *inst);
+
 /* mfs_utils.c */
 extern uint16_t
 conv16(bool native, uint16_t n);
@@ -46,6 +46,111 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid);
 static errno_t
 mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free);
 
+static errno_t
+mfs_bmap_write_chunk(struct mfs_instance *inst, bmap_id_t bid, size_t chunk);
+
+/**Load the zone and inode bitmaps into memory.
+ *
+ * Once loaded, the bitmaps are searched in memory and every
+ * change is written through to the bitmap block on disk.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t
+mfs_bitmaps_load(struct mfs_instance *inst)
+{
+	struct mfs_sb_info *sbi = inst->sbi;
+	const size_t chunks_per_block = sbi->block_size / sizeof(bitchunk_t);
+	unsigned long block, nblocks;
+	unsigned start_block;
+	bmap_id_t bid;
+	block_t *b;
+	size_t i;
+	errno_t r;
+
+	inst->bmap[BMAP_ZONE] = NULL;
+	inst->bmap[BMAP_INODE] = NULL;
+
+	for (bid = BMAP_ZONE; bid <= BMAP_INODE; ++bid) {
+		start_block = MFS_BMAP_START_BLOCK(sbi, bid);
+		nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
+
+		bitchunk_t *bmap = malloc(nblocks * sbi->block_size);
+		if (!bmap) {
+			r = ENOMEM;
+			goto out_err;
+		}
+		inst->bmap[bid] = bmap;
+
+		for (block = 0; block < nblocks; ++block) {
+			r = block_get(&b, inst->service_id,
+			    block + start_block, BLOCK_FLAGS_NONE);
+			if (r != EOK)
+				goto out_err;
+
+			bitchunk_t *data = b->data;
+			for (i = 0; i < chunks_per_block; ++i) {
+				bmap[block * chunks_per_block + i] =
+				    conv32(sbi->native, data[i]);
+			}
+
+			r = block_put(b);
+			if (r != EOK)
+				goto out_err;
+		}
+	}
+
+	return EOK;
+
+out_err:
+	mfs_bitmaps_free(inst);
+	return r;
+}
+
+/**Free the in-memory copies of the bitmaps.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ */
+void
+mfs_bitmaps_free(struct mfs_instance *inst)
+{
+	free(inst->bmap[BMAP_ZONE]);
+	free(inst->bmap[BMAP_INODE]);
+	inst->bmap[BMAP_ZONE] = NULL;
+	inst->bmap[BMAP_INODE] = NULL;
+}
+
+/**Write a chunk of an in-memory bitmap to its bitmap block.
+ *
+ * @param inst		Pointer to the filesystem instance.
+ * @param bid		BMAP_ZONE or BMAP_INODE.
+ * @param chunk		Index of the chunk in the bitmap.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+mfs_bmap_write_chunk(struct mfs_instance *inst, bmap_id_t bid, size_t chunk)
+{
+	struct mfs_sb_info *sbi = inst->sbi;
+	const size_t chunks_per_block = sbi->block_size / sizeof(bitchunk_t);
+	block_t *b;
+	errno_t r;
+
+	r = block_get(&b, inst->service_id, MFS_BMAP_START_BLOCK(sbi, bid) +
+	    chunk / chunks_per_block, BLOCK_FLAGS_NONE);
+	if (r != EOK)
+		return r;
+
+	bitchunk_t *data = b->data;
+	data[chunk % chunks_per_block] = conv32(sbi->native,
+	    inst->bmap[bid][chunk]);
+
+	b->dirty = true;
+	return block_put(b);
+}
+
 /**Allocate a new inode.
  *
  * @param inst		Pointer to the filesystem instance.
@@ -180,6 +285,31 @@ mfs_count_free_bits(struct mfs_instance *inst, bmap_id_t bid, uint32_t *free)
 	nblocks = MFS_BMAP_SIZE_BLOCKS(sbi, bid);
 	nbits = MFS_BMAP_SIZE_BITS(sbi, bid);
 
+	if (inst->bmap[bid] != NULL) {
+		bitchunk_t *bmap = inst->bmap[bid];
+		size_t i;
+
+		for (i = 0; nbits > 0; ++i) {
+			chunk = bmap[i];
+
+			if (nbits >= bitchunk_bits && chunk == 0) {
+				free_bits += bitchunk_bits;
+				nbits -= bitchunk_bits;
+				continue;
+			}
+
+			size_t bit;
+			for (bit = 0; bit < bitchunk_bits && nbits > 0;
+			    ++bit, --nbits) {
+				if (!(chunk & (1 << bit)))
+					free_bits++;
+			}
+		}
+
+		*free = free_bits;
+		return EOK;
+	}
+
 	for (block = 0; block < nblocks; ++block) {
 		r = block_get(&b, inst->service_id, block + start_block,
 		    BLOCK_FLAGS_NONE);
@@ -257,6 +387,17 @@ mfs_free_bit(struct mfs_instance *inst, uint32_t idx, bmap_id_t bid)
 		}
 	}
 
+	if (inst->bmap[bid] != NULL) {
+		const size_t chunk_bits = sizeof(bitchunk_t) * 8;
+
+		inst->bmap[bid][idx / chunk_bits] &= ~(1U << (idx % chunk_bits));
+		r = mfs_bmap_write_chunk(inst, bid, idx / chunk_bits);
+
+		if (*search > idx)
+			*search = idx;
+		return r;
+	}
+
 	/* Compute the bitmap block */
 	uint32_t block = idx / (sbi->block_size * 8) + start_block;
 
@@ -319,6 +460,45 @@ mfs_alloc_bit(struct mfs_instance *inst, uint32_t *idx, bmap_id_t bid)
 	}
 	bits_per_block = sbi->block_size * 8;
 
+	if (inst->bmap[bid] != NULL) {
+		/*
+		 * Search the in-memory bitmap starting at the hint and
+		 * wrapping around, skipping chunks with no free bit.
+		 */
+		bitchunk_t *bmap = inst->bmap[bid];
+		const size_t chunk_bits = sizeof(bitchunk_t) * 8;
+		const size_t nchunks = nblocks * bits_per_block / chunk_bits;
+		size_t n, c;
+
+		for (n = 0; n < nchunks; ++n) {
+			c = (*search / chunk_bits + n) % nchunks;
+			if (!(~bmap[c]))
+				continue;
+
+			unsigned j;
+			for (j = 0; bmap[c] & (1U << j); ++j)
+				;
+
+			if (c * chunk_bits + j > limit) {
+				/* Index is beyond the limit, it is invalid */
+				continue;
+			}
+
+			bmap[c] |= 1U << j;
+			r = mfs_bmap_write_chunk(inst, bid, c);
+			if (r != EOK) {
+				bmap[c] &= ~(1U << j);
+				return r;
+			}
+
+			*idx = c * chunk_bits + j;
+			*search = *idx;
+			return EOK;
+		}
+
+		return ENOSPC;
+	}
+
 	block_t *b;
 
 retry:
@@ -89,7 +89,8 @@ libfs_ops_t mfs_libfs_ops = {
 	.lnkcnt_get = mfs_lnkcnt_get,
 	.size_block = mfs_size_block,
 	.total_block_count = mfs_total_block_count,
-	.free_block_count = mfs_free_block_count
+	.free_block_count = mfs_free_block_count,
+	.cache_stats = block_get_stats
 };
 
 /* Hash table interface for open nodes hash table */
@@ -336,9 +337,19 @@ mfs_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	instance->service_id = service_id;
 	instance->sbi = sbi;
 	instance->open_nodes_cnt = 0;
+
+	/* Without the in-memory bitmaps, the bitmaps are searched on disk */
+	rc = mfs_bitmaps_load(instance);
+	if (rc != EOK && rc != ENOMEM) {
+		block_cache_fini(service_id);
+		mfsdebug("bitmaps loading failed\n");
+		goto out_error;
+	}
+
 	rc = fs_instance_create(service_id, instance);
 	if (rc != EOK) {
 		block_cache_fini(service_id);
+		mfs_bitmaps_free(instance);
 		mfsdebug("fs instance creation failed\n");
 		goto out_error;
 	}
@@ -383,6 +394,7 @@ mfs_unmounted(service_id_t service_id)
 
 	/* Remove and destroy the instance */
 	(void) fs_instance_destroy(service_id);
+	mfs_bitmaps_free(inst);
 	free(inst->sbi);
 	free(inst);
 	return EOK;
@@ -457,6 +469,7 @@ mfs_create_node(fs_node_t **rfn, service_id_t service_id, int flags)
 	mnode->ino_i = ino_i;
 	mnode->instance = inst;
 	mnode->refcnt = 1;
+	mfs_ind_cache_init(mnode);
 
 	fibril_mutex_lock(&open_nodes_lock);
 	hash_table_insert(&open_nodes, &mnode->link);
@@ -557,6 +570,7 @@ mfs_node_put(fs_node_t *fsnode)
 		assert(mnode->instance->open_nodes_cnt > 0);
 		mnode->instance->open_nodes_cnt--;
 		rc = mfs_put_inode(mnode);
+		mfs_ind_cache_fini(mnode);
 		free(mnode->ino_i);
 		free(mnode);
 		free(fsnode);
@@ -650,6 +664,7 @@ mfs_node_core_get(fs_node_t **rfn, struct mfs_instance *inst,
 	ino_i->index = index;
 	mnode->ino_i = ino_i;
 	mnode->refcnt = 1;
+	mfs_ind_cache_init(mnode);
 
 	mnode->instance = inst;
 	node->data = mnode;
@@ -818,6 +833,77 @@ out:
 	return EOK;
 }
 
+/** Maximum number of bytes returned by one read of a regular file. */
+#define MFS_READ_MAX_BYTES	(64 * 1024)
+
+/** Answer a data read call with bytes from consecutive zones.
+ *
+ * @param call		Data read call to answer.
+ * @param service_id	Service ID of the device.
+ * @param zone		First zone to read.
+ * @param cnt		Number of zones to read.
+ * @param off		Offset of the first byte in the first zone.
+ * @param bytes		Number of bytes to return. Updated to the number
+ *			of bytes actually returned.
+ *
+ * @return		EOK on success or an error code. The call is answered
+ *			in either case.
+ */
+static errno_t
+mfs_read_zones(ipc_call_t *call, service_id_t service_id, uint32_t zone,
+    size_t cnt, size_t off, size_t *bytes)
+{
+	block_t *one;
+	block_t **blocks = &one;
+	uint8_t *buf = NULL;
+	errno_t rc;
+
+	if (cnt > 1) {
+		blocks = calloc(cnt, sizeof(block_t *));
+		buf = malloc(*bytes);
+		if (blocks == NULL || buf == NULL) {
+			/* Make do with the first zone. */
+			free(blocks);
+			free(buf);
+			blocks = &one;
+			buf = NULL;
+			cnt = 1;
+		}
+	}
+
+	rc = block_get_range(blocks, service_id, zone, cnt, BLOCK_FLAGS_NONE);
+	if (rc != EOK) {
+		if (blocks != &one)
+			free(blocks);
+		free(buf);
+		async_answer_0(call, rc);
+		return rc;
+	}
+
+	if (buf != NULL) {
+		size_t done = 0;
+		size_t bsize = blocks[0]->size;
+
+		for (size_t i = 0; i < cnt; i++) {
+			size_t from = i == 0 ? off : 0;
+			size_t n = min(bsize - from, *bytes - done);
+
+			memcpy(buf + done, blocks[i]->data + from, n);
+			done += n;
+		}
+		(void) async_data_read_finalize(call, buf, *bytes);
+		free(buf);
+	} else {
+		*bytes = min(*bytes, one->size - off);
+		(void) async_data_read_finalize(call, one->data + off, *bytes);
+	}
+
+	rc = block_put_range(blocks, cnt);
+	if (blocks != &one)
+		free(blocks);
+	return rc;
+}
+
 static errno_t
 mfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *rbytes)
@@ -883,11 +969,12 @@ mfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 			goto out_success;
 		}
 
-		bytes = min(len, sbi->block_size - pos % sbi->block_size);
-		bytes = min(bytes, ino_i->i_size - pos);
+		const size_t off = pos % sbi->block_size;
+
+		bytes = min(len, ino_i->i_size - pos);
+		bytes = min(bytes, MFS_READ_MAX_BYTES - off);
 
 		uint32_t zone;
-		block_t *b;
 
 		rc = mfs_read_map(&zone, mnode, pos);
 		if (rc != EOK)
@@ -895,26 +982,36 @@ mfs_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 
 		if (zone == 0) {
 			/* sparse file */
-			uint8_t *buf = malloc(sbi->block_size);
+			bytes = min(bytes, sbi->block_size - off);
+			uint8_t *buf = calloc(1, sbi->block_size);
 			if (!buf) {
 				rc = ENOMEM;
 				goto out_error;
 			}
-			memset(buf, 0, sizeof(sbi->block_size));
-			async_data_read_finalize(&call,
-			    buf + pos % sbi->block_size, bytes);
+			async_data_read_finalize(&call, buf + off, bytes);
 			free(buf);
 			goto out_success;
 		}
 
-		rc = block_get(&b, service_id, zone, BLOCK_FLAGS_NONE);
-		if (rc != EOK)
-			goto out_error;
+		/*
+		 * Merge the following zones into one request for as long as
+		 * they are contiguous on disk.
+		 */
+		size_t cnt = 1;
+		while (cnt * sbi->block_size < off + bytes) {
+			uint32_t next;
 
-		async_data_read_finalize(&call, b->data +
-		    pos % sbi->block_size, bytes);
+			rc = mfs_read_map(&next, mnode,
+			    pos - off + cnt * sbi->block_size);
+			if (rc != EOK)
+				goto out_error;
+			if (next != zone + cnt)
+				break;
+			cnt++;
+		}
+		bytes = min(bytes, cnt * sbi->block_size - off);
 
-		rc = block_put(b);
+		rc = mfs_read_zones(&call, service_id, zone, cnt, off, &bytes);
 		if (rc != EOK) {
 			mfs_node_put(fn);
 			return rc;
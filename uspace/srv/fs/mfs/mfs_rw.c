@@ -34,7 +34,7 @@
 #include "mfs.h"
 
 static errno_t
-rw_map_ondisk(uint32_t *b, const struct mfs_node *mnode, int rblock,
+rw_map_ondisk(uint32_t *b, struct mfs_node *mnode, int rblock,
     bool write_mode, uint32_t w_block);
 
 static errno_t
@@ -44,7 +44,10 @@ static errno_t
 alloc_zone_and_clear(struct mfs_instance *inst, uint32_t *zone);
 
 static errno_t
-read_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t **ind_zone);
+read_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t *ind_zone);
+
+static errno_t
+get_ind_zone(struct mfs_node *mnode, uint32_t zone, uint32_t **ind_zone);
 
 static errno_t
 write_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t *ind_zone);
@@ -60,7 +63,7 @@ write_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t *ind_zone);
  * @return	EOK on success or an error code.
  */
 errno_t
-mfs_read_map(uint32_t *b, const struct mfs_node *mnode, uint32_t pos)
+mfs_read_map(uint32_t *b, struct mfs_node *mnode, uint32_t pos)
 {
 	errno_t r;
 	const struct mfs_sb_info *sbi = mnode->instance->sbi;
@@ -99,7 +102,7 @@ mfs_write_map(struct mfs_node *mnode, const uint32_t pos, uint32_t new_zone,
 }
 
 static errno_t
-rw_map_ondisk(uint32_t *b, const struct mfs_node *mnode, int rblock,
+rw_map_ondisk(uint32_t *b, struct mfs_node *mnode, int rblock,
     bool write_mode, uint32_t w_block)
 {
 	int nr_direct;
@@ -152,7 +155,7 @@ rw_map_ondisk(uint32_t *b, const struct mfs_node *mnode, int rblock,
 			}
 		}
 
-		r = read_ind_zone(inst, ino_i->i_izone[0], &ind_zone);
+		r = get_ind_zone(mnode, ino_i->i_izone[0], &ind_zone);
 		if (r != EOK)
 			goto out;
 
@@ -186,7 +189,7 @@ rw_map_ondisk(uint32_t *b, const struct mfs_node *mnode, int rblock,
 		}
 	}
 
-	r = read_ind_zone(inst, ino_i->i_izone[1], &ind_zone);
+	r = get_ind_zone(mnode, ino_i->i_izone[1], &ind_zone);
 	if (r != EOK)
 		goto out;
 
@@ -213,19 +216,23 @@ rw_map_ondisk(uint32_t *b, const struct mfs_node *mnode, int rblock,
 		}
 	}
 
-	r = read_ind_zone(inst, ind_zone[ind2_off], &ind2_zone);
+	/*
+	 * Getting the second indirect zone may evict the first one from the
+	 * cache, remember the zone number.
+	 */
+	uint32_t ind2_zone_nr = ind_zone[ind2_off];
+
+	r = get_ind_zone(mnode, ind2_zone_nr, &ind2_zone);
 	if (r != EOK)
 		goto out;
 
 	*b = ind2_zone[rblock - (ind2_off * ptrs_per_block)];
 	if (write_mode) {
 		ind2_zone[rblock - (ind2_off * ptrs_per_block)] = w_block;
-		write_ind_zone(inst, ind_zone[ind2_off], ind2_zone);
+		write_ind_zone(inst, ind2_zone_nr, ind2_zone);
 	}
 
 out:
-	free(ind2_zone);
-	free(ind_zone);
 	return r;
 }
 
@@ -263,6 +270,7 @@ mfs_prune_ind_zones(struct mfs_node *mnode, size_t new_size)
 	if (rblock < nr_direct) {
 		/* Free the single indirect zone */
 		if (ino_i->i_izone[0]) {
+			mfs_ind_cache_fini(mnode);
 			r = mfs_free_zone(inst, ino_i->i_izone[0]);
 			if (r != EOK)
 				return r;
@@ -287,7 +295,7 @@ mfs_prune_ind_zones(struct mfs_node *mnode, size_t new_size)
 		return EOK;
 	}
 
-	r = read_ind_zone(inst, ino_i->i_izone[1], &dbl_zone);
+	r = get_ind_zone(mnode, ino_i->i_izone[1], &dbl_zone);
 	if (r != EOK)
 		return r;
 
@@ -306,7 +314,8 @@ mfs_prune_ind_zones(struct mfs_node *mnode, size_t new_size)
 		ino_i->dirty = true;
 	}
 out:
-	free(dbl_zone);
+	/* Some of the cached indirect zones may have been freed. */
+	mfs_ind_cache_fini(mnode);
 	return r;
 }
 
@@ -340,40 +349,113 @@ alloc_zone_and_clear(struct mfs_instance *inst, uint32_t *zone)
 }
 
 static errno_t
-read_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t **ind_zone)
+read_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t *ind_zone)
 {
 	struct mfs_sb_info *sbi = inst->sbi;
 	errno_t r;
 	unsigned i;
 	block_t *b;
-	const int max_ind_zone_ptrs = (MFS_MAX_BLOCKSIZE / sizeof(uint16_t)) *
-	    sizeof(uint32_t);
-
-	*ind_zone = malloc(max_ind_zone_ptrs);
-	if (*ind_zone == NULL)
-		return ENOMEM;
 
 	r = block_get(&b, inst->service_id, zone, BLOCK_FLAGS_NONE);
-	if (r != EOK) {
-		free(*ind_zone);
+	if (r != EOK)
 		return r;
-	}
 
 	if (sbi->fs_version == MFS_VERSION_V1) {
 		uint16_t *src_ptr = b->data;
 
 		for (i = 0; i < sbi->block_size / sizeof(uint16_t); ++i)
-			(*ind_zone)[i] = conv16(sbi->native, src_ptr[i]);
+			ind_zone[i] = conv16(sbi->native, src_ptr[i]);
 	} else {
 		uint32_t *src_ptr = b->data;
 
 		for (i = 0; i < sbi->block_size / sizeof(uint32_t); ++i)
-			(*ind_zone)[i] = conv32(sbi->native, src_ptr[i]);
+			ind_zone[i] = conv32(sbi->native, src_ptr[i]);
 	}
 
 	return block_put(b);
 }
 
+/**Get the content of an indirect zone through the node's cache.
+ *
+ * The returned array belongs to the cache. It stays valid until
+ * the next call of this function for the same node.
+ *
+ * @param mnode		Pointer to a generic MINIX inode in memory.
+ * @param zone		Number of the indirect zone.
+ * @param ind_zone	Pointer where the array of zone pointers will be
+ * 			stored.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t
+get_ind_zone(struct mfs_node *mnode, uint32_t zone, uint32_t **ind_zone)
+{
+	struct mfs_ind_cache_entry *e;
+	errno_t r;
+	unsigned i;
+	const int max_ind_zone_ptrs = (MFS_MAX_BLOCKSIZE / sizeof(uint16_t)) *
+	    sizeof(uint32_t);
+
+	for (i = 0; i < MFS_IND_CACHE_SIZE; ++i) {
+		if (mnode->ind_cache[i].zone == zone) {
+			*ind_zone = mnode->ind_cache[i].ptrs;
+			return EOK;
+		}
+	}
+
+	e = &mnode->ind_cache[mnode->ind_cache_next];
+	mnode->ind_cache_next = (mnode->ind_cache_next + 1) %
+	    MFS_IND_CACHE_SIZE;
+
+	e->zone = 0;
+	if (e->ptrs == NULL) {
+		e->ptrs = malloc(max_ind_zone_ptrs);
+		if (e->ptrs == NULL)
+			return ENOMEM;
+	}
+
+	r = read_ind_zone(mnode->instance, zone, e->ptrs);
+	if (r != EOK)
+		return r;
+
+	e->zone = zone;
+	*ind_zone = e->ptrs;
+	return EOK;
+}
+
+/**Initialize the indirect zone cache of a node.
+ *
+ * @param mnode		Pointer to a generic MINIX inode in memory.
+ */
+void
+mfs_ind_cache_init(struct mfs_node *mnode)
+{
+	unsigned i;
+
+	for (i = 0; i < MFS_IND_CACHE_SIZE; ++i) {
+		mnode->ind_cache[i].zone = 0;
+		mnode->ind_cache[i].ptrs = NULL;
+	}
+	mnode->ind_cache_next = 0;
+}
+
+/**Empty the indirect zone cache of a node and release its memory.
+ *
+ * @param mnode		Pointer to a generic MINIX inode in memory.
+ */
+void
+mfs_ind_cache_fini(struct mfs_node *mnode)
+{
+	unsigned i;
+
+	for (i = 0; i < MFS_IND_CACHE_SIZE; ++i) {
+		free(mnode->ind_cache[i].ptrs);
+		mnode->ind_cache[i].zone = 0;
+		mnode->ind_cache[i].ptrs = NULL;
+	}
+	mnode->ind_cache_next = 0;
+}
+
 static errno_t
 write_ind_zone(struct mfs_instance *inst, uint32_t zone, uint32_t *ind_zone)
 {
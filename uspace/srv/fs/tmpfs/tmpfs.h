@@ -37,6 +37,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <adt/hash_table.h>
+#include <as.h>
+#include <fibril_synch.h>
 
 #define TMPFS_NODE(node)	((node) ? (tmpfs_node_t *)(node)->data : NULL)
 #define FS_NODE(node)		((node) ? (node)->bp : NULL)
@@ -50,6 +52,14 @@ typedef enum {
 /* forward declaration */
 struct tmpfs_node;
 
+/** Number of page pointers held by one leaf of the file content table. */
+#define TMPFS_LEAF_PAGES	(PAGE_SIZE / sizeof(void *))
+
+/** Leaf of the file content table. NULL pages are holes. */
+typedef struct tmpfs_leaf {
+	void *page[TMPFS_LEAF_PAGES];
+} tmpfs_leaf_t;
+
 typedef struct tmpfs_dentry {
 	link_t link;		/**< Linkage for the list of siblings. */
 	struct tmpfs_node *node;/**< Back pointer to TMPFS node. */
@@ -64,8 +74,10 @@ typedef struct tmpfs_node {
 	tmpfs_dentry_type_t type;
 	unsigned lnkcnt;	/**< Link count. */
 	size_t size;		/**< File size if type is TMPFS_FILE. */
-	void *data;		/**< File content's if type is TMPFS_FILE. */
+	tmpfs_leaf_t **leaves;	/**< File content's pages if TMPFS_FILE. */
+	size_t nleaves;		/**< Number of entries in leaves. */
 	list_t cs_list;		/**< Child's siblings list. */
+	fibril_rwlock_t contents_lock;	/**< Protects the pages and cs_list. */
 } tmpfs_node_t;
 
 extern vfs_out_ops_t tmpfs_ops;
@@ -47,9 +47,13 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stddef.h>
+#include <fibril_synch.h>
 #include <adt/hash_table.h>
 #include <adt/hash.h>
+#include <align.h>
 #include <as.h>
+#include <malloc.h>
+#include <mem.h>
 #include <libfs.h>
 
 /** All root nodes have index 0. */
@@ -58,6 +62,17 @@
 /** Global counter for assigning node indices. Shared by all instances. */
 fs_index_t tmpfs_next_index = 1;
 
+/*
+ * The nodes hash table and the index counter are protected by nodes_lock.
+ * The contents of each node are protected by its own contents_lock, so that
+ * the runner threads can read and write different nodes in parallel. Link
+ * counts only change under the namespace lock of VFS.
+ */
+static FIBRIL_RWLOCK_INITIALIZE(nodes_lock);
+
+/** Contents of file holes. */
+static const uint8_t tmpfs_zero_page[PAGE_SIZE];
+
 /*
  * Implementation of the libfs interface.
  */
@@ -73,6 +88,107 @@ static errno_t tmpfs_link_node(fs_node_t *, fs_node_t *, const char *);
 static errno_t tmpfs_unlink_node(fs_node_t *, fs_node_t *, const char *);
 
 /* Implementation of helper functions. */
+
+/** Find a page of file contents.
+ *
+ * @param nodep		TMPFS file node.
+ * @param idx		Index of the page within the file.
+ *
+ * @return		The page or NULL if the page is a hole.
+ */
+static void *tmpfs_page_find(tmpfs_node_t *nodep, size_t idx)
+{
+	size_t l = idx / TMPFS_LEAF_PAGES;
+
+	if (l >= nodep->nleaves || nodep->leaves[l] == NULL)
+		return NULL;
+	return nodep->leaves[l]->page[idx % TMPFS_LEAF_PAGES];
+}
+
+/** Get a page of file contents, allocating it if it is a hole.
+ *
+ * New pages are page-aligned and zero-filled.
+ *
+ * @param nodep		TMPFS file node.
+ * @param idx		Index of the page within the file.
+ * @param page		Output parameter where the page will be returned.
+ *
+ * @return		EOK on success or ENOMEM.
+ */
+static errno_t tmpfs_page_get(tmpfs_node_t *nodep, size_t idx, void **page)
+{
+	size_t l = idx / TMPFS_LEAF_PAGES;
+	tmpfs_leaf_t *leaf;
+	void **pagep;
+
+	if (l >= nodep->nleaves) {
+		size_t n = max(l + 1, 2 * nodep->nleaves);
+		tmpfs_leaf_t **leaves = realloc(nodep->leaves,
+		    n * sizeof(tmpfs_leaf_t *));
+		if (!leaves)
+			return ENOMEM;
+
+		memset(leaves + nodep->nleaves, 0,
+		    (n - nodep->nleaves) * sizeof(tmpfs_leaf_t *));
+		nodep->leaves = leaves;
+		nodep->nleaves = n;
+	}
+
+	leaf = nodep->leaves[l];
+	if (!leaf) {
+		leaf = calloc(1, sizeof(tmpfs_leaf_t));
+		if (!leaf)
+			return ENOMEM;
+		nodep->leaves[l] = leaf;
+	}
+
+	pagep = &leaf->page[idx % TMPFS_LEAF_PAGES];
+	if (!*pagep) {
+		*pagep = memalign(PAGE_SIZE, PAGE_SIZE);
+		if (!*pagep)
+			return ENOMEM;
+		memset(*pagep, 0, PAGE_SIZE);
+	}
+
+	*page = *pagep;
+	return EOK;
+}
+
+/** Free the pages of file contents starting with a given page.
+ *
+ * @param nodep		TMPFS file node.
+ * @param first		Index of the first page to free. If zero, the
+ *			whole content table is freed.
+ */
+static void tmpfs_pages_free(tmpfs_node_t *nodep, size_t first)
+{
+	size_t l, p;
+
+	for (l = first / TMPFS_LEAF_PAGES; l < nodep->nleaves; l++) {
+		tmpfs_leaf_t *leaf = nodep->leaves[l];
+		if (!leaf)
+			continue;
+
+		p = (l == first / TMPFS_LEAF_PAGES) ?
+		    first % TMPFS_LEAF_PAGES : 0;
+		for (; p < TMPFS_LEAF_PAGES; p++) {
+			free(leaf->page[p]);
+			leaf->page[p] = NULL;
+		}
+
+		if (l * TMPFS_LEAF_PAGES >= first) {
+			free(leaf);
+			nodep->leaves[l] = NULL;
+		}
+	}
+
+	if (first == 0) {
+		free(nodep->leaves);
+		nodep->leaves = NULL;
+		nodep->nleaves = 0;
+	}
+}
+
 static errno_t tmpfs_root_get(fs_node_t **rfn, service_id_t service_id)
 {
 	return tmpfs_node_get(rfn, service_id, TMPFS_SOME_ROOT);
@@ -80,7 +196,11 @@ static errno_t tmpfs_root_get(fs_node_t **rfn, service_id_t service_id)
 
 static errno_t tmpfs_has_children(bool *has_children, fs_node_t *fn)
 {
-	*has_children = !list_empty(&TMPFS_NODE(fn)->cs_list);
+	tmpfs_node_t *nodep = TMPFS_NODE(fn);
+
+	fibril_rwlock_read_lock(&nodep->contents_lock);
+	*has_children = !list_empty(&nodep->cs_list);
+	fibril_rwlock_read_unlock(&nodep->contents_lock);
 	return EOK;
 }
 
@@ -179,9 +299,9 @@ static void nodes_remove_callback(ht_link_t *item)
 		free(dentryp);
 	}
 
-	if (nodep->data) {
+	if (nodep->leaves) {
 		assert(nodep->type == TMPFS_FILE);
-		free(nodep->data);
+		tmpfs_pages_free(nodep, 0);
 	}
 	free(nodep->bp);
 	free(nodep);
@@ -204,8 +324,10 @@ static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 	nodep->type = TMPFS_NONE;
 	nodep->lnkcnt = 0;
 	nodep->size = 0;
-	nodep->data = NULL;
+	nodep->leaves = NULL;
+	nodep->nleaves = 0;
 	list_initialize(&nodep->cs_list);
+	fibril_rwlock_initialize(&nodep->contents_lock);
 }
 
 static void tmpfs_dentry_initialize(tmpfs_dentry_t *dentryp)
@@ -248,40 +370,56 @@ static bool rm_service_id_nodes(ht_link_t *item, void *arg)
 
 static void tmpfs_instance_done(service_id_t service_id)
 {
+	fibril_rwlock_write_lock(&nodes_lock);
 	hash_table_apply(&nodes, rm_service_id_nodes, &service_id);
+	fibril_rwlock_write_unlock(&nodes_lock);
+}
+
+/** Find a node in the nodes hash table.
+ *
+ * @param service_id	Service ID of the instance.
+ * @param index		Index of the node.
+ *
+ * @return		The node or NULL if there is no such node.
+ */
+static tmpfs_node_t *tmpfs_node_find(service_id_t service_id,
+    fs_index_t index)
+{
+	node_key_t key = {
+		.service_id = service_id,
+		.index = index
+	};
+
+	fibril_rwlock_read_lock(&nodes_lock);
+	ht_link_t *lnk = hash_table_find(&nodes, &key);
+	fibril_rwlock_read_unlock(&nodes_lock);
+
+	if (!lnk)
+		return NULL;
+	return hash_table_get_inst(lnk, tmpfs_node_t, nh_link);
 }
 
 errno_t tmpfs_match(fs_node_t **rfn, fs_node_t *pfn, const char *component)
 {
 	tmpfs_node_t *parentp = TMPFS_NODE(pfn);
 
+	*rfn = NULL;
+
+	fibril_rwlock_read_lock(&parentp->contents_lock);
 	list_foreach(parentp->cs_list, link, tmpfs_dentry_t, dentryp) {
 		if (!str_cmp(dentryp->name, component)) {
 			*rfn = FS_NODE(dentryp->node);
-			return EOK;
+			break;
 		}
 	}
+	fibril_rwlock_read_unlock(&parentp->contents_lock);
 
-	*rfn = NULL;
 	return EOK;
 }
 
 errno_t tmpfs_node_get(fs_node_t **rfn, service_id_t service_id, fs_index_t index)
 {
-	node_key_t key = {
-		.service_id = service_id,
-		.index = index
-	};
-
-	ht_link_t *lnk = hash_table_find(&nodes, &key);
-
-	if (lnk) {
-		tmpfs_node_t *nodep;
-		nodep = hash_table_get_inst(lnk, tmpfs_node_t, nh_link);
-		*rfn = FS_NODE(nodep);
-	} else {
-		*rfn = NULL;
-	}
+	*rfn = FS_NODE(tmpfs_node_find(service_id, index));
 	return EOK;
 }
 
@@ -320,10 +458,6 @@ errno_t tmpfs_create_node(fs_node_t **rfn, service_id_t service_id, int lflag)
 
 	rc = tmpfs_root_get(&rootfn, service_id);
 	assert(rc == EOK);
-	if (!rootfn)
-		nodep->index = TMPFS_SOME_ROOT;
-	else
-		nodep->index = tmpfs_next_index++;
 
 	nodep->service_id = service_id;
 	if (lflag & L_DIRECTORY)
@@ -332,7 +466,14 @@ errno_t tmpfs_create_node(fs_node_t **rfn, service_id_t service_id, int lflag)
 		nodep->type = TMPFS_FILE;
 
 	/* Insert the new node into the nodes hash table. */
+	fibril_rwlock_write_lock(&nodes_lock);
+	if (!rootfn)
+		nodep->index = TMPFS_SOME_ROOT;
+	else
+		nodep->index = tmpfs_next_index++;
 	hash_table_insert(&nodes, &nodep->nh_link);
+	fibril_rwlock_write_unlock(&nodes_lock);
+
 	*rfn = FS_NODE(nodep);
 	return EOK;
 }
@@ -344,7 +485,9 @@ errno_t tmpfs_destroy_node(fs_node_t *fn)
 	assert(!nodep->lnkcnt);
 	assert(list_empty(&nodep->cs_list));
 
+	fibril_rwlock_write_lock(&nodes_lock);
 	hash_table_remove_item(&nodes, &nodep->nh_link);
+	fibril_rwlock_write_unlock(&nodes_lock);
 
 	/*
 	 * The nodes_remove_callback() function takes care of the actual
@@ -361,19 +504,13 @@ errno_t tmpfs_link_node(fs_node_t *pfn, fs_node_t *cfn, const char *nm)
 
 	assert(parentp->type == TMPFS_DIRECTORY);
 
-	/* Check for duplicit entries. */
-	list_foreach(parentp->cs_list, link, tmpfs_dentry_t, dp) {
-		if (!str_cmp(dp->name, nm))
-			return EEXIST;
-	}
-
 	/* Allocate and initialize the dentry. */
 	dentryp = malloc(sizeof(tmpfs_dentry_t));
 	if (!dentryp)
 		return ENOMEM;
 	tmpfs_dentry_initialize(dentryp);
 
-	/* Populate and link the new dentry. */
+	/* Populate the new dentry. */
 	size_t size = str_size(nm);
 	dentryp->name = malloc(size + 1);
 	if (!dentryp->name) {
@@ -382,9 +519,24 @@ errno_t tmpfs_link_node(fs_node_t *pfn, fs_node_t *cfn, const char *nm)
 	}
 	str_cpy(dentryp->name, size + 1, nm);
 	dentryp->node = childp;
+
+	fibril_rwlock_write_lock(&parentp->contents_lock);
+
+	/* Check for duplicit entries. */
+	list_foreach(parentp->cs_list, link, tmpfs_dentry_t, dp) {
+		if (!str_cmp(dp->name, nm)) {
+			fibril_rwlock_write_unlock(&parentp->contents_lock);
+			free(dentryp->name);
+			free(dentryp);
+			return EEXIST;
+		}
+	}
+
+	/* Link the new dentry. */
 	childp->lnkcnt++;
 	list_append(&dentryp->link, &parentp->cs_list);
 
+	fibril_rwlock_write_unlock(&parentp->contents_lock);
 	return EOK;
 }
 
@@ -397,6 +549,8 @@ errno_t tmpfs_unlink_node(fs_node_t *pfn, fs_node_t *cfn, const char *nm)
 	if (!parentp)
 		return EBUSY;
 
+	fibril_rwlock_write_lock(&parentp->contents_lock);
+
 	list_foreach(parentp->cs_list, link, tmpfs_dentry_t, dp) {
 		if (!str_cmp(dp->name, nm)) {
 			dentryp = dp;
@@ -406,16 +560,22 @@ errno_t tmpfs_unlink_node(fs_node_t *pfn, fs_node_t *cfn, const char *nm)
 		}
 	}
 
-	if (!childp)
+	if (!childp) {
+		fibril_rwlock_write_unlock(&parentp->contents_lock);
 		return ENOENT;
+	}
 
-	if ((childp->lnkcnt == 1) && !list_empty(&childp->cs_list))
+	if ((childp->lnkcnt == 1) && !list_empty(&childp->cs_list)) {
+		fibril_rwlock_write_unlock(&parentp->contents_lock);
 		return ENOTEMPTY;
+	}
 
 	list_remove(&dentryp->link);
-	free(dentryp);
 	childp->lnkcnt--;
 
+	fibril_rwlock_write_unlock(&parentp->contents_lock);
+
+	free(dentryp);
 	return EOK;
 }
 
@@ -468,17 +628,10 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 	/*
 	 * Lookup the respective TMPFS node.
 	 */
-	node_key_t key = {
-		.service_id = service_id,
-		.index = index
-	};
-
-	ht_link_t *hlp = hash_table_find(&nodes, &key);
-	if (!hlp)
+	tmpfs_node_t *nodep = tmpfs_node_find(service_id, index);
+	if (!nodep)
 		return ENOENT;
 
-	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t, nh_link);
-
 	/*
 	 * Receive the read request.
 	 */
@@ -489,11 +642,19 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 		return EINVAL;
 	}
 
+	fibril_rwlock_read_lock(&nodep->contents_lock);
+
 	size_t bytes;
 	if (nodep->type == TMPFS_FILE) {
-		bytes = min(nodep->size - pos, size);
-		(void) async_data_read_finalize(&call, nodep->data + pos,
-		    bytes);
+		/* Read at most up to the end of the page. */
+		size_t off = pos % PAGE_SIZE;
+		bytes = (pos < nodep->size) ? min(nodep->size - pos, size) : 0;
+		bytes = min(bytes, PAGE_SIZE - off);
+
+		const uint8_t *page = tmpfs_page_find(nodep, pos / PAGE_SIZE);
+		if (!page)
+			page = tmpfs_zero_page;
+		(void) async_data_read_finalize(&call, page + off, bytes);
 	} else {
 		tmpfs_dentry_t *dentryp;
 		link_t *lnk;
@@ -508,6 +669,7 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 		lnk = list_nth(&nodep->cs_list, pos);
 
 		if (lnk == NULL) {
+			fibril_rwlock_read_unlock(&nodep->contents_lock);
 			async_answer_0(&call, ENOENT);
 			return ENOENT;
 		}
@@ -519,6 +681,8 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 		bytes = 1;
 	}
 
+	fibril_rwlock_read_unlock(&nodep->contents_lock);
+
 	*rbytes = bytes;
 	return EOK;
 }
@@ -530,18 +694,10 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	/*
 	 * Lookup the respective TMPFS node.
 	 */
-	node_key_t key = {
-		.service_id = service_id,
-		.index = index
-	};
-
-	ht_link_t *hlp = hash_table_find(&nodes, &key);
-
-	if (!hlp)
+	tmpfs_node_t *nodep = tmpfs_node_find(service_id, index);
+	if (!nodep)
 		return ENOENT;
 
-	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t, nh_link);
-
 	/*
 	 * Receive the write request.
 	 */
@@ -552,38 +708,38 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		return EINVAL;
 	}
 
-	/*
-	 * Check whether the file needs to grow.
-	 */
-	if (pos + size <= nodep->size) {
-		/* The file size is not changing. */
-		(void) async_data_write_finalize(&call, nodep->data + pos,
-		    size);
+	fibril_rwlock_write_lock(&nodep->contents_lock);
+
+	if (pos > SIZE_MAX - size) {
+		async_answer_0(&call, ENOMEM);
+		size = 0;
 		goto out;
 	}
-	size_t delta = (pos + size) - nodep->size;
+
 	/*
-	 * At this point, we are deliberately extremely straightforward and
-	 * simply realloc the contents of the file on every write that grows the
-	 * file. In the end, the situation might not be as bad as it may look:
-	 * our heap allocator can save us and just grow the block whenever
-	 * possible.
+	 * Write at most up to the end of the page so that the data can be
+	 * received directly into it. Pages are allocated on demand and the
+	 * unwritten parts of the file stay holes.
 	 */
-	void *newdata = realloc(nodep->data, nodep->size + delta);
-	if (!newdata) {
-		async_answer_0(&call, ENOMEM);
+	size_t off = pos % PAGE_SIZE;
+	size = min(size, PAGE_SIZE - off);
+
+	void *page;
+	errno_t rc = tmpfs_page_get(nodep, pos / PAGE_SIZE, &page);
+	if (rc != EOK) {
+		async_answer_0(&call, rc);
 		size = 0;
 		goto out;
 	}
-	/* Clear any newly allocated memory in order to emulate gaps. */
-	memset(newdata + nodep->size, 0, delta);
-	nodep->size += delta;
-	nodep->data = newdata;
-	(void) async_data_write_finalize(&call, nodep->data + pos, size);
+
+	(void) async_data_write_finalize(&call, page + off, size);
+	if (pos + size > nodep->size)
+		nodep->size = pos + size;
 
 out:
 	*wbytes = size;
 	*nsize = nodep->size;
+	fibril_rwlock_write_unlock(&nodep->contents_lock);
 	return EOK;
 }
 
@@ -593,33 +749,33 @@ static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
 	/*
 	 * Lookup the respective TMPFS node.
 	 */
-	node_key_t key = {
-		.service_id = service_id,
-		.index = index
-	};
-
-	ht_link_t *hlp = hash_table_find(&nodes, &key);
-	if (!hlp)
+	tmpfs_node_t *nodep = tmpfs_node_find(service_id, index);
+	if (!nodep)
 		return ENOENT;
-	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t, nh_link);
-
-	if (size == nodep->size)
-		return EOK;
 
 	if (size > SIZE_MAX)
 		return ENOMEM;
 
-	void *newdata = realloc(nodep->data, size);
-	if (!newdata && size)
-		return ENOMEM;
+	fibril_rwlock_write_lock(&nodep->contents_lock);
+
+	if (size < nodep->size) {
+		size_t keep = ROUND_UP(size, PAGE_SIZE) / PAGE_SIZE;
+		size_t off = size % PAGE_SIZE;
+
+		tmpfs_pages_free(nodep, keep);
 
-	if (size > nodep->size) {
-		size_t delta = size - nodep->size;
-		memset(newdata + nodep->size, 0, delta);
+		/* Clear the tail of the last page in order to emulate gaps. */
+		if (off != 0) {
+			uint8_t *page = tmpfs_page_find(nodep, keep - 1);
+			if (page)
+				memset(page + off, 0, PAGE_SIZE - off);
+		}
 	}
 
+	/* Growing the file just leaves a hole. */
 	nodep->size = size;
-	nodep->data = newdata;
+
+	fibril_rwlock_write_unlock(&nodep->contents_lock);
 	return EOK;
 }
 
@@ -630,16 +786,9 @@ static errno_t tmpfs_close(service_id_t service_id, fs_index_t index)
 
 static errno_t tmpfs_destroy(service_id_t service_id, fs_index_t index)
 {
-	node_key_t key = {
-		.service_id = service_id,
-		.index = index
-	};
-
-	ht_link_t *hlp = hash_table_find(&nodes, &key);
-	if (!hlp)
+	tmpfs_node_t *nodep = tmpfs_node_find(service_id, index);
+	if (!nodep)
 		return ENOENT;
-	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t,
-	    nh_link);
 	return tmpfs_destroy_node(FS_NODE(nodep));
 }
 
@@ -114,6 +114,7 @@ typedef struct udf_node {
 	uint8_t *data;
 	udf_allocator_t *allocators;
 	size_t alloc_size;
+	aoff64_t next_pos;  /* Position following the last read */
 } udf_node_t;
 
 extern vfs_out_ops_t udf_ops;
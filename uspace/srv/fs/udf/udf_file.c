@@ -40,12 +40,16 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <io/log.h>
+#include <macros.h>
 #include <mem.h>
 #include "udf.h"
 #include "udf_file.h"
 #include "udf_cksum.h"
 #include "udf_volume.h"
 
+/** Maximum number of bytes returned by one read of a file */
+#define UDF_READ_MAX_BYTES  (64 * 1024)
+
 /** Read extended allocator in allocation sequence
  *
  * @paran node     UDF node
@@ -565,6 +569,11 @@ errno_t udf_get_fid_in_sector(udf_file_identifier_descriptor_t **fid,
 }
 
 /** Read file if it is saved in allocators.
+ *
+ * The read covers as much of the requested range as lies in physically
+ * contiguous extents, up to UDF_READ_MAX_BYTES, and fetches its blocks
+ * with a single block_get_range() request. When the file is read
+ * sequentially, the blocks following the read are requested ahead of time.
  *
  * @param read_len Returned value. Length file or part file which we could read.
  * @param call     IPC call
@@ -578,8 +587,10 @@ errno_t udf_get_fid_in_sector(udf_file_identifier_descriptor_t **fid,
 errno_t udf_read_file(size_t *read_len, ipc_call_t *call, udf_node_t *node,
     aoff64_t pos, size_t len)
 {
+	service_id_t service_id = node->instance->service_id;
+	size_t sector_size = node->instance->sector_size;
 	size_t i = 0;
-	size_t l = 0;
+	aoff64_t l = 0;
 
 	while (i < node->alloc_size) {
 		if (pos >= l + node->allocators[i].length) {
@@ -589,37 +600,94 @@ errno_t udf_read_file(size_t *read_len, ipc_call_t *call, udf_node_t *node,
 			break;
 	}
 
-	size_t sector_cnt = ALL_UP(l, node->instance->sector_size);
-	size_t sector_num = pos / node->instance->sector_size;
+	if (i == node->alloc_size) {
+		/* Nothing is recorded past the last extent */
+		*read_len = 0;
+		async_data_read_finalize(call, NULL, 0);
+		return EOK;
+	}
 
-	block_t *block = NULL;
-	errno_t rc = block_get(&block, node->instance->service_id,
-	    node->allocators[i].position + (sector_num - sector_cnt),
+	aoff64_t ext_off = pos - l;
+	aoff64_t first = node->allocators[i].position + ext_off / sector_size;
+	size_t sector_pos = ext_off % sector_size;
+	aoff64_t avail = node->allocators[i].length - ext_off;
+
+	/* Extend the read over following extents adjacent on the medium */
+	size_t k = i;
+	while (k + 1 < node->alloc_size &&
+	    node->allocators[k].length % sector_size == 0 &&
+	    node->allocators[k + 1].position == node->allocators[k].position +
+	    node->allocators[k].length / sector_size) {
+		k++;
+		avail += node->allocators[k].length;
+	}
+
+	size_t bytes = min(len, avail);
+	bytes = min(bytes, node->data_size - pos);
+	bytes = min(bytes, UDF_READ_MAX_BYTES - sector_pos);
+	size_t cnt = ALL_UP(sector_pos + bytes, sector_size);
+
+	block_t *one;
+	block_t **blocks = &one;
+	uint8_t *buf = NULL;
+
+	if (cnt > 1) {
+		blocks = calloc(cnt, sizeof(block_t *));
+		buf = malloc(bytes);
+		if ((blocks == NULL) || (buf == NULL)) {
+			/* Make do with the first block */
+			free(blocks);
+			free(buf);
+			blocks = &one;
+			buf = NULL;
+			cnt = 1;
+			bytes = min(bytes, sector_size - sector_pos);
+		}
+	}
+
+	errno_t rc = block_get_range(blocks, service_id, first, cnt,
 	    BLOCK_FLAGS_NONE);
 	if (rc != EOK) {
+		if (blocks != &one)
+			free(blocks);
+		free(buf);
 		async_answer_0(call, rc);
 		return rc;
 	}
 
-	size_t sector_pos = pos % node->instance->sector_size;
-
-	if (sector_pos + len < node->instance->sector_size)
-		*read_len = len;
-	else
-		*read_len = node->instance->sector_size - sector_pos;
-
-	if (ALL_UP(node->allocators[i].length, node->instance->sector_size) ==
-	    sector_num - sector_cnt + 1) {
-		if (pos + len > node->allocators[i].length + l)
-			*read_len = node->allocators[i].length -
-			    (sector_num - sector_cnt) * node->instance->sector_size -
-			    sector_pos;
-		else
-			*read_len = len;
+	if (pos == node->next_pos) {
+		aoff64_t left = ALL_UP(sector_pos + avail, sector_size) - cnt;
+
+		if (left > 0) {
+			block_readahead(service_id, first + cnt,
+			    min(left, 2 * cnt));
+		}
+	}
+	node->next_pos = pos + bytes;
+
+	if (buf != NULL) {
+		size_t done = 0;
+
+		for (size_t j = 0; j < cnt; j++) {
+			size_t from = (j == 0) ? sector_pos : 0;
+			size_t n = min(sector_size - from, bytes - done);
+
+			memcpy(buf + done, blocks[j]->data + from, n);
+			done += n;
+		}
+
+		async_data_read_finalize(call, buf, bytes);
+		free(buf);
+	} else {
+		async_data_read_finalize(call, one->data + sector_pos, bytes);
 	}
 
-	async_data_read_finalize(call, block->data + sector_pos, *read_len);
-	return block_put(block);
+	rc = block_put_range(blocks, cnt);
+	if (blocks != &one)
+		free(blocks);
+
+	*read_len = bytes;
+	return rc;
 }
 
 /**
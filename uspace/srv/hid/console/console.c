@@ -302,6 +302,7 @@ static void pointer_draw(void)
 
 	/* Make sure the cell gets updated */
 	ch->flags |= CHAR_FLAG_DIRTY;
+	chargrid_set_dirty(active_console->frontbuf, row, row + 1);
 }
 
 /** Undraw mouse pointer. */
@@ -318,6 +319,7 @@ static void pointer_undraw(void)
 	ch = chargrid_charfield_at(active_console->frontbuf, col, row);
 	*ch = pointer_bg;
 	ch->flags |= CHAR_FLAG_DIRTY;
+	chargrid_set_dirty(active_console->frontbuf, row, row + 1);
 }
 
 /** Queue console event.
@@ -458,7 +460,13 @@ static errno_t input_ev_dclick(input_t *input, int bnum)
 }
 
 /** Process a character from the client (TTY emulation). */
-static void cons_write_char(console_t *cons, char32_t ch)
+/** Write character to console.
+ *
+ * @param cons Console
+ * @param ch Character
+ * @return @c true if more than one row has been affected
+ */
+static bool cons_write_char(console_t *cons, char32_t ch)
 {
 	sysarg_t updated = 0;
 
@@ -484,8 +492,7 @@ static void cons_write_char(console_t *cons, char32_t ch)
 	pointer_draw();
 	fibril_mutex_unlock(&cons->mtx);
 
-	if (updated > 1)
-		cons_update(cons);
+	return updated > 1;
 }
 
 static void cons_set_cursor_vis(console_t *cons, bool visible)
@@ -558,10 +565,17 @@ static errno_t cons_read(con_srv_t *srv, void *buf, size_t size, size_t *nread)
 static errno_t cons_write(con_srv_t *srv, void *data, size_t size, size_t *nwritten)
 {
 	console_t *cons = srv_to_console(srv);
+	bool update = false;
 
+	/* Update output once per write, not once per row */
 	size_t off = 0;
-	while (off < size)
-		cons_write_char(cons, str_decode(data, &off, size));
+	while (off < size) {
+		if (cons_write_char(cons, str_decode(data, &off, size)))
+			update = true;
+	}
+
+	if (update)
+		cons_update(cons);
 
 	*nwritten = size;
 	return EOK;
@@ -800,6 +814,7 @@ static void cons_buf_update(con_srv_t *srv, sysarg_t c0, sysarg_t r0,
 		}
 	}
 
+	chargrid_set_dirty(cons->frontbuf, r0, r1);
 	pointer_draw();
 	fibril_mutex_unlock(&cons->mtx);
 
@@ -184,5 +184,47 @@ void ds_cursor_get_rect(ds_cursor_t *cursor, gfx_coord2_t *pos,
 	gfx_rect_translate(pos, &cursor->rect, drect);
 }
 
+/** Get cursor image in ARGB format.
+ *
+ * This is the format used for loading the image into a hardware
+ * cursor plane. Transparent pixels have alpha set to zero, all other
+ * pixels are opaque.
+ *
+ * @param cursor Cursor
+ * @param rpixels Place to store pointer to newly allocated pixel array
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t ds_cursor_get_argb(ds_cursor_t *cursor, pixel_t **rpixels)
+{
+	gfx_coord2_t dims;
+	pixel_t *pixels;
+	const uint8_t *pp;
+	gfx_coord_t i;
+
+	gfx_rect_dims(&cursor->rect, &dims);
+
+	pixels = calloc(dims.x * dims.y, sizeof(pixel_t));
+	if (pixels == NULL)
+		return ENOMEM;
+
+	pp = cursor->image;
+	for (i = 0; i < dims.x * dims.y; i++) {
+		switch (pp[i]) {
+		case 1:
+			pixels[i] = PIXEL(255, 0, 0, 0);
+			break;
+		case 2:
+			pixels[i] = PIXEL(255, 255, 255, 255);
+			break;
+		default:
+			pixels[i] = PIXEL(0, 0, 0, 0);
+			break;
+		}
+	}
+
+	*rpixels = pixels;
+	return EOK;
+}
+
 /** @}
  */
@@ -37,6 +37,7 @@
 #define CURSOR_H
 
 #include <errno.h>
+#include <io/pixel.h>
 #include <types/gfx/coord.h>
 #include <stdint.h>
 #include "types/display/display.h"
@@ -47,6 +48,7 @@ extern errno_t ds_cursor_create(ds_display_t *, gfx_rect_t *, const uint8_t *,
 extern void ds_cursor_destroy(ds_cursor_t *);
 extern errno_t ds_cursor_paint(ds_cursor_t *, gfx_coord2_t *, gfx_rect_t *);
 extern void ds_cursor_get_rect(ds_cursor_t *, gfx_coord2_t *, gfx_rect_t *);
+extern errno_t ds_cursor_get_argb(ds_cursor_t *, pixel_t **);
 
 #endif
 
@@ -33,13 +33,16 @@
  * @file Display server display
  */
 
+#include <ddev.h>
 #include <errno.h>
 #include <gfx/bitmap.h>
 #include <gfx/context.h>
+#include <gfx/region.h>
 #include <gfx/render.h>
 #include <io/log.h>
 #include <memgfx/memgc.h>
 #include <stdlib.h>
+#include <time.h>
 #include "client.h"
 #include "clonegc.h"
 #include "cursimg.h"
@@ -51,6 +54,14 @@
 static gfx_context_t *ds_display_get_unbuf_gc(ds_display_t *);
 static void ds_display_invalidate_cb(void *, gfx_rect_t *);
 static void ds_display_update_cb(void *);
+static void ds_display_frame_timer(void *);
+
+enum {
+	/** Refresh interval in microseconds (60 Hz) */
+	ds_frame_interval = 16667,
+	/** Log frame statistics every this many frames */
+	ds_frame_stats_period = 600
+};
 
 static mem_gc_cb_t ds_display_mem_gc_cb = {
 	.invalidate = ds_display_invalidate_cb,
@@ -99,6 +110,14 @@ errno_t ds_display_create(gfx_context_t *gc, ds_display_flags_t flags,
 	list_initialize(&disp->ddevs);
 	list_initialize(&disp->seats);
 	list_initialize(&disp->windows);
+	gfx_region_init(&disp->dirty);
+
+	disp->frame_timer = fibril_timer_create(NULL);
+	if (disp->frame_timer == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
 	disp->flags = flags;
 	*rdisp = disp;
 	return EOK;
@@ -116,6 +135,12 @@ void ds_display_destroy(ds_display_t *disp)
 	assert(list_empty(&disp->clients));
 	assert(list_empty(&disp->seats));
 	/* XXX destroy cursors */
+	if (disp->frame_timer != NULL) {
+		fibril_timer_clear(disp->frame_timer);
+		fibril_timer_destroy(disp->frame_timer);
+	}
+
+	gfx_region_fini(&disp->dirty);
 	gfx_color_delete(disp->bg_color);
 	free(disp);
 }
@@ -468,10 +493,8 @@ static errno_t ds_display_alloc_backbuf(ds_display_t *disp)
 	if (rc != EOK)
 		goto error;
 
-	disp->dirty_rect.p0.x = 0;
-	disp->dirty_rect.p0.y = 0;
-	disp->dirty_rect.p1.x = 0;
-	disp->dirty_rect.p1.y = 0;
+	gfx_region_clear(&disp->dirty);
+	disp->dirty_all = false;
 
 	return EOK;
 error:
@@ -496,6 +519,12 @@ errno_t ds_display_add_ddev(ds_display_t *disp, ds_ddev_t *ddev)
 	assert(ddev->display == NULL);
 	assert(!link_used(&ddev->lddevs));
 
+	/*
+	 * The new device must get the cursor image, or the pointer must be
+	 * drawn in software if it does not support a hardware cursor.
+	 */
+	ds_display_hide_hw_cursor(disp);
+
 	ddev->display = disp;
 	list_append(&ddev->lddevs, &disp->ddevs);
 
@@ -541,6 +570,7 @@ error:
  */
 void ds_display_remove_ddev(ds_ddev_t *ddev)
 {
+	ds_display_hide_hw_cursor(ddev->display);
 	list_remove(&ddev->lddevs);
 	ddev->display = NULL;
 }
@@ -595,10 +625,124 @@ void ds_display_add_cursor(ds_display_t *display, ds_cursor_t *cursor)
  */
 void ds_display_remove_cursor(ds_cursor_t *cursor)
 {
+	if (cursor->display->hw_cursor == cursor)
+		ds_display_hide_hw_cursor(cursor->display);
+
 	list_remove(&cursor->ldisplay);
 	cursor->display = NULL;
 }
 
+/** Determine whether cursor can be shown using hardware cursor planes.
+ *
+ * @param disp Display
+ * @param cursor Cursor
+ * @return @c true iff all display devices can show @a cursor in hardware
+ */
+static bool ds_display_hw_cursor_avail(ds_display_t *disp,
+    ds_cursor_t *cursor)
+{
+	gfx_coord2_t dims;
+
+	if (list_empty(&disp->ddevs))
+		return false;
+
+	gfx_rect_dims(&cursor->rect, &dims);
+
+	list_foreach(disp->ddevs, lddevs, ds_ddev_t, ddev) {
+		if (ddev->dd == NULL || (ddev->info.caps & ddc_cursor) == 0)
+			return false;
+		if (dims.x > ddev->info.cursor_max.x ||
+		    dims.y > ddev->info.cursor_max.y)
+			return false;
+	}
+
+	return true;
+}
+
+/** Show cursor using hardware cursor planes.
+ *
+ * Load the cursor image into the hardware cursor plane of every display
+ * device (unless it is there already) and move the cursor to @a pos.
+ * Moving a hardware cursor does not require repainting anything.
+ *
+ * @param disp Display
+ * @param cursor Cursor
+ * @param pos Cursor position
+ * @return EOK on success, ENOTSUP if some display device does not
+ *         support hardware cursor or an error code. On failure the
+ *         hardware cursor is hidden and the caller needs to paint
+ *         the cursor in software.
+ */
+errno_t ds_display_set_hw_cursor(ds_display_t *disp, ds_cursor_t *cursor,
+    gfx_coord2_t *pos)
+{
+	pixel_t *pixels;
+	errno_t rc;
+
+	if (!ds_display_hw_cursor_avail(disp, cursor)) {
+		rc = ENOTSUP;
+		goto error;
+	}
+
+	if (cursor != disp->hw_cursor) {
+		rc = ds_cursor_get_argb(cursor, &pixels);
+		if (rc != EOK)
+			goto error;
+
+		list_foreach(disp->ddevs, lddevs, ds_ddev_t, ddev) {
+			rc = ddev_cursor_set_image(ddev->dd, &cursor->rect,
+			    pixels);
+			if (rc != EOK) {
+				free(pixels);
+				goto error;
+			}
+		}
+
+		free(pixels);
+	}
+
+	if (cursor != disp->hw_cursor || pos->x != disp->hw_cursor_pos.x ||
+	    pos->y != disp->hw_cursor_pos.y) {
+		list_foreach(disp->ddevs, lddevs, ds_ddev_t, ddev) {
+			rc = ddev_cursor_move(ddev->dd, pos);
+			if (rc != EOK)
+				goto error;
+		}
+	}
+
+	if (disp->hw_cursor == NULL) {
+		list_foreach(disp->ddevs, lddevs, ds_ddev_t, ddev) {
+			rc = ddev_cursor_set_visible(ddev->dd, true);
+			if (rc != EOK)
+				goto error;
+		}
+	}
+
+	disp->hw_cursor = cursor;
+	disp->hw_cursor_pos = *pos;
+	return EOK;
+error:
+	ds_display_hide_hw_cursor(disp);
+	return rc;
+}
+
+/** Hide hardware cursor.
+ *
+ * @param disp Display
+ */
+void ds_display_hide_hw_cursor(ds_display_t *disp)
+{
+	if (disp->hw_cursor == NULL)
+		return;
+
+	list_foreach(disp->ddevs, lddevs, ds_ddev_t, ddev) {
+		if (ddev->dd != NULL && (ddev->info.caps & ddc_cursor) != 0)
+			(void) ddev_cursor_set_visible(ddev->dd, false);
+	}
+
+	disp->hw_cursor = NULL;
+}
+
 /** Get unbuffered GC.
  *
  * Get the display's (unbuffered) graphic context. If the display
@@ -660,15 +804,30 @@ errno_t ds_display_paint_bg(ds_display_t *disp, gfx_rect_t *rect)
 	return gfx_fill_rect(gc, &crect);
 }
 
+/** Get frame statistics.
+ *
+ * @param disp Display
+ * @param stats Place to store frame statistics
+ */
+void ds_display_get_frame_stats(ds_display_t *disp, ds_frame_stats_t *stats)
+{
+	*stats = disp->frame_stats;
+}
+
 /** Update front buffer from back buffer.
  *
+ * Only the dirty region of the back buffer is copied, rectangle by
+ * rectangle, so every display device receives just the changed pixels.
  * If the display is not double-buffered, no action is taken.
  *
  * @param disp Display
+ * @param rbytes Place to add number of bytes copied per display device
  * @return EOK on success, or an error code
  */
-static errno_t ds_display_update(ds_display_t *disp)
+static errno_t ds_display_update(ds_display_t *disp, uint64_t *rbytes)
 {
+	gfx_rect_t *rect;
+	gfx_coord2_t dim;
 	errno_t rc;
 
 	if (disp->backbuf == NULL) {
@@ -676,28 +835,149 @@ static errno_t ds_display_update(ds_display_t *disp)
 		return EOK;
 	}
 
-	rc = gfx_bitmap_render(disp->backbuf, &disp->dirty_rect, NULL);
-	if (rc != EOK)
-		return rc;
+	if (disp->dirty_all) {
+		rc = gfx_bitmap_render(disp->backbuf, NULL, NULL);
+		if (rc != EOK)
+			return rc;
 
-	disp->dirty_rect.p0.x = 0;
-	disp->dirty_rect.p0.y = 0;
-	disp->dirty_rect.p1.x = 0;
-	disp->dirty_rect.p1.y = 0;
+		gfx_rect_dims(&disp->rect, &dim);
+		*rbytes += (uint64_t) dim.x * dim.y * sizeof(uint32_t);
+	} else {
+		rect = gfx_region_first(&disp->dirty);
+		while (rect != NULL) {
+			rc = gfx_bitmap_render(disp->backbuf, rect, NULL);
+			if (rc != EOK)
+				return rc;
+
+			gfx_rect_dims(rect, &dim);
+			*rbytes += (uint64_t) dim.x * dim.y * sizeof(uint32_t);
+			rect = gfx_region_next(&disp->dirty, rect);
+		}
+	}
+
+	gfx_region_clear(&disp->dirty);
+	disp->dirty_all = false;
 
 	return EOK;
 }
 
-/** Paint display.
+/** Flush one frame to the output devices.
+ *
+ * Everything rendered into the back buffer since the last frame, by
+ * any number of windows, goes out in a single update.
+ *
+ * @param disp Display
+ */
+static void ds_display_frame(ds_display_t *disp)
+{
+	ds_frame_stats_t *stats = &disp->frame_stats;
+	struct timespec start;
+	struct timespec end;
+	uint64_t bytes = 0;
+	usec_t since;
+	usec_t dur;
+	errno_t rc;
+
+	getuptime(&start);
+
+	rc = ds_display_update(disp, &bytes);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Error updating display "
+		    "devices.");
+	}
+
+	getuptime(&end);
+
+	/*
+	 * A frame that goes out a whole interval or more after it was due
+	 * has missed one or more refreshes.
+	 */
+	if (stats->frames > 0) {
+		since = NSEC2USEC(ts_sub_diff(&start, &disp->frame_last));
+		if (since > disp->frame_due) {
+			stats->dropped += (since - disp->frame_due) /
+			    ds_frame_interval;
+		}
+	}
+
+	dur = NSEC2USEC(ts_sub_diff(&end, &start));
+	++stats->frames;
+	stats->last_usec = dur;
+	if (dur > stats->max_usec)
+		stats->max_usec = dur;
+	stats->flush_bytes += bytes * list_count(&disp->ddevs);
+
+	disp->frame_last = start;
+
+	if (stats->frames % ds_frame_stats_period == 0) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Frames: %lu, dropped: %lu, "
+		    "last: %llu us, max: %llu us, flushed: %llu bytes",
+		    stats->frames, stats->dropped,
+		    (unsigned long long) stats->last_usec,
+		    (unsigned long long) stats->max_usec,
+		    (unsigned long long) stats->flush_bytes);
+	}
+}
+
+/** Frame timer handler.
+ *
+ * @param arg Display (cast as void *)
+ */
+static void ds_display_frame_timer(void *arg)
+{
+	ds_display_t *disp = (ds_display_t *) arg;
+
+	ds_display_lock(disp);
+	disp->frame_pending = false;
+	ds_display_frame(disp);
+	ds_display_unlock(disp);
+}
+
+/** Schedule flushing the back buffer to the output devices.
+ *
+ * Frames are paced to one per refresh interval. If the previous frame
+ * went out long enough ago, the next one is flushed right away. Output
+ * devices do not report vertical blanking so the interval is timed.
+ *
+ * @param disp Display
+ */
+static void ds_display_schedule_update(ds_display_t *disp)
+{
+	struct timespec now;
+	usec_t since;
+	usec_t delay;
+
+	if (disp->backbuf == NULL) {
+		/* Not double-buffered, nothing to do. */
+		return;
+	}
+
+	if (disp->frame_pending)
+		return;
+
+	getuptime(&now);
+	since = NSEC2USEC(ts_sub_diff(&now, &disp->frame_last));
+	delay = since < ds_frame_interval ? ds_frame_interval - since : 0;
+
+	disp->frame_pending = true;
+	disp->frame_due = since + delay;
+	fibril_timer_set(disp->frame_timer, delay, ds_display_frame_timer,
+	    (void *) disp);
+}
+
+/** Paint display rectangle by rectangle.
+ *
+ * Paint everything that intersects @a rect from bottom to top. This is
+ * used as a fallback if there is not enough memory to compute the visible
+ * regions.
  *
  * @param display Display
  * @param rect Bounding rectangle or @c NULL to repaint entire display
  */
-errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
+static errno_t ds_display_paint_rect(ds_display_t *disp, gfx_rect_t *rect)
 {
 	errno_t rc;
 	ds_window_t *wnd;
-	ds_seat_t *seat;
 
 	/* Paint background */
 	rc = ds_display_paint_bg(disp, rect);
@@ -714,6 +994,23 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 		wnd = ds_display_prev_window(wnd);
 	}
 
+	return EOK;
+}
+
+/** Paint display overlays.
+ *
+ * Paint window previews and pointers, which are drawn on top of
+ * everything else.
+ *
+ * @param display Display
+ * @param rect Bounding rectangle or @c NULL to repaint entire display
+ */
+static errno_t ds_display_paint_overlays(ds_display_t *disp, gfx_rect_t *rect)
+{
+	errno_t rc;
+	ds_window_t *wnd;
+	ds_seat_t *seat;
+
 	/* Paint window previews for windows being resized or moved */
 	wnd = ds_display_last_window(disp);
 	while (wnd != NULL) {
@@ -734,13 +1031,162 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 		seat = ds_display_next_seat(seat);
 	}
 
-	return ds_display_update(disp);
+	return EOK;
+}
+
+/** Paint visible parts of windows and background in region.
+ *
+ * Windows are opaque. Going from top to bottom, each window paints only
+ * the part of @a todo it covers, which is then removed from @a todo. Since
+ * the painted parts never overlap, each pixel is painted exactly once.
+ * What remains at the end is background.
+ *
+ * @param disp Display
+ * @param todo Region to paint, consumed
+ * @return EOK on success or an error code
+ */
+static errno_t ds_display_paint_visible(ds_display_t *disp,
+    gfx_region_t *todo)
+{
+	gfx_region_t vis;
+	gfx_rect_t wrect;
+	gfx_rect_t *rect;
+	ds_window_t *wnd;
+	errno_t rc;
+
+	gfx_region_init(&vis);
+
+	wnd = ds_display_first_window(disp);
+	while (wnd != NULL && !gfx_region_is_empty(todo)) {
+		gfx_rect_translate(&wnd->dpos, &wnd->rect, &wrect);
+
+		rc = gfx_region_set_rect(&vis, &wrect);
+		if (rc != EOK)
+			goto error;
+
+		rc = gfx_region_intersect(&vis, todo, &vis);
+		if (rc != EOK)
+			goto error;
+
+		rc = gfx_region_subtract_rect(todo, &wrect);
+		if (rc != EOK)
+			goto error;
+
+		rect = gfx_region_first(&vis);
+		while (rect != NULL) {
+			rc = ds_window_paint(wnd, rect);
+			if (rc != EOK)
+				goto error;
+
+			rect = gfx_region_next(&vis, rect);
+		}
+
+		wnd = ds_display_next_window(wnd);
+	}
+
+	rect = gfx_region_first(todo);
+	while (rect != NULL) {
+		rc = ds_display_paint_bg(disp, rect);
+		if (rc != EOK)
+			goto error;
+
+		rect = gfx_region_next(todo, rect);
+	}
+
+	gfx_region_fini(&vis);
+	return EOK;
+error:
+	gfx_region_fini(&vis);
+	return rc;
+}
+
+/** Paint display region.
+ *
+ * @param display Display
+ * @param region Region to repaint
+ * @return EOK on success or an error code
+ */
+errno_t ds_display_paint_region(ds_display_t *disp, gfx_region_t *region)
+{
+	gfx_region_t todo;
+	gfx_rect_t bounds;
+	gfx_rect_t *rect;
+	errno_t rc;
+
+	if (gfx_region_is_empty(region))
+		return EOK;
+
+	/* Clip to display */
+	gfx_region_init(&todo);
+	rc = gfx_region_union(region, &todo, &todo);
+	if (rc == EOK && !gfx_rect_is_empty(&disp->rect))
+		rc = gfx_region_intersect_rect(&todo, &disp->rect);
+	if (rc == EOK)
+		rc = ds_display_paint_visible(disp, &todo);
+	gfx_region_fini(&todo);
+
+	if (rc == ENOMEM) {
+		/*
+		 * Fall back to painting everything inside the bounds. This
+		 * covers anything painted before we ran out of memory.
+		 */
+		gfx_region_get_bounds(region, &bounds);
+		rc = ds_display_paint_rect(disp, &bounds);
+	}
+
+	if (rc != EOK)
+		return rc;
+
+	rect = gfx_region_first(region);
+	while (rect != NULL) {
+		rc = ds_display_paint_overlays(disp, rect);
+		if (rc != EOK)
+			return rc;
+
+		rect = gfx_region_next(region, rect);
+	}
+
+	ds_display_schedule_update(disp);
+	return EOK;
+}
+
+/** Paint display.
+ *
+ * @param display Display
+ * @param rect Bounding rectangle or @c NULL to repaint entire display
+ */
+errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
+{
+	gfx_region_t region;
+	errno_t rc;
+
+	gfx_region_init(&region);
+	rc = gfx_region_set_rect(&region, rect != NULL ? rect : &disp->rect);
+	if (rc == EOK && !gfx_region_is_empty(&region)) {
+		rc = ds_display_paint_region(disp, &region);
+		gfx_region_fini(&region);
+		return rc;
+	}
+
+	gfx_region_fini(&region);
+
+	/* Display has no area yet (unit tests) or out of memory */
+	rc = ds_display_paint_rect(disp, rect);
+	if (rc != EOK)
+		return rc;
+
+	rc = ds_display_paint_overlays(disp, rect);
+	if (rc != EOK)
+		return rc;
+
+	ds_display_schedule_update(disp);
+	return EOK;
 }
 
 /** Display invalidate callback.
  *
  * Called by backbuffer memory GC when something is rendered into it.
- * Updates the display's dirty rectangle.
+ * Adds the rectangle to the display's dirty region.
  *
  * @param arg Argument (display cast as void *)
  * @param rect Rectangle to update
@@ -748,10 +1194,12 @@ errno_t ds_display_paint(ds_display_t *disp, gfx_rect_t *rect)
 static void ds_display_invalidate_cb(void *arg, gfx_rect_t *rect)
 {
 	ds_display_t *disp = (ds_display_t *) arg;
-	gfx_rect_t env;
 
-	gfx_rect_envelope(&disp->dirty_rect, rect, &env);
-	disp->dirty_rect = env;
+	if (disp->dirty_all)
+		return;
+
+	if (gfx_region_union_rect(&disp->dirty, rect) != EOK)
+		disp->dirty_all = true;
 }
 
 /** Display update callback.
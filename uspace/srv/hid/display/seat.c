@@ -36,6 +36,7 @@
 #include <adt/list.h>
 #include <errno.h>
 #include <gfx/color.h>
+#include <gfx/region.h>
 #include <gfx/render.h>
 #include <stdlib.h>
 #include "client.h"
@@ -78,6 +79,10 @@ errno_t ds_seat_create(ds_display_t *display, ds_seat_t **rseat)
  */
 void ds_seat_destroy(ds_seat_t *seat)
 {
+	/* The hardware cursor shows the pointer of the first seat */
+	if (seat == ds_display_first_seat(seat->display))
+		ds_display_hide_hw_cursor(seat->display);
+
 	ds_display_remove_seat(seat);
 	free(seat);
 }
@@ -291,11 +296,30 @@ void ds_seat_get_pointer_rect(ds_seat_t *seat, gfx_rect_t *rect)
 	ds_cursor_get_rect(cursor, &seat->pntpos, rect);
 }
 
+/** Show seat pointer using hardware cursor.
+ *
+ * Only the first seat can use the hardware cursor, the pointers of any
+ * other seats are always painted in software.
+ *
+ * @param seat Seat
+ * @return EOK if the pointer is shown by hardware cursor, otherwise
+ *         an error code and the pointer needs to be painted in software
+ */
+static errno_t ds_seat_update_hw_pointer(ds_seat_t *seat)
+{
+	if (seat != ds_display_first_seat(seat->display))
+		return ENOTSUP;
+
+	return ds_display_set_hw_cursor(seat->display, ds_seat_get_cursor(seat),
+	    &seat->pntpos);
+}
+
 /** Repaint seat pointer
  *
- * Repaint the pointer after it has moved or changed. This is done by
- * repainting the area of the display previously (@a old_rect) and currently
- * covered by the pointer.
+ * Repaint the pointer after it has moved or changed. If the pointer
+ * is shown using hardware cursor, it is just updated. Otherwise this
+ * is done by repainting the area of the display previously (@a old_rect)
+ * and currently covered by the pointer.
  *
  * @param seat Seat
  * @param old_rect Rectangle previously covered by pointer
@@ -305,33 +329,36 @@ void ds_seat_get_pointer_rect(ds_seat_t *seat, gfx_rect_t *rect)
 static errno_t ds_seat_repaint_pointer(ds_seat_t *seat, gfx_rect_t *old_rect)
 {
 	gfx_rect_t new_rect;
-	gfx_rect_t envelope;
+	gfx_region_t region;
 	errno_t rc;
 
+	/* No repainting needed with hardware cursor */
+	if (ds_seat_update_hw_pointer(seat) == EOK)
+		return EOK;
+
 	ds_seat_get_pointer_rect(seat, &new_rect);
 
-	if (gfx_rect_is_incident(old_rect, &new_rect)) {
-		/* Rectangles do not intersect. Repaint them separately. */
-		rc = ds_display_paint(seat->display, &new_rect);
-		if (rc != EOK)
-			return rc;
+	/* Repaint the union of both rectangles in a single operation. */
+	gfx_region_init(&region);
 
-		rc = ds_display_paint(seat->display, old_rect);
-		if (rc != EOK)
-			return rc;
-	} else {
-		/*
-		 * Rectangles intersect. As an optimization, repaint them
-		 * in a single operation.
-		 */
-		gfx_rect_envelope(old_rect, &new_rect, &envelope);
+	rc = gfx_region_set_rect(&region, &new_rect);
+	if (rc == EOK)
+		rc = gfx_region_union_rect(&region, old_rect);
 
-		rc = ds_display_paint(seat->display, &envelope);
-		if (rc != EOK)
-			return rc;
+	if (rc == EOK) {
+		rc = ds_display_paint_region(seat->display, &region);
+		gfx_region_fini(&region);
+		return rc;
 	}
 
-	return EOK;
+	gfx_region_fini(&region);
+
+	/* Out of memory, repaint each rectangle separately */
+	rc = ds_display_paint(seat->display, &new_rect);
+	if (rc != EOK)
+		return rc;
+
+	return ds_display_paint(seat->display, old_rect);
 }
 
 /** Post pointing device event to the seat
@@ -505,6 +532,9 @@ errno_t ds_seat_paint_pointer(ds_seat_t *seat, gfx_rect_t *rect)
 {
 	ds_cursor_t *cursor;
 
+	if (ds_seat_update_hw_pointer(seat) == EOK)
+		return EOK;
+
 	cursor = ds_seat_get_cursor(seat);
 	return ds_cursor_paint(cursor, &seat->pntpos, rect);
 }
@@ -29,6 +29,7 @@
 #include <errno.h>
 #include <gfx/context.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <pcut/pcut.h>
 
 #include "../cursor.h"
@@ -258,4 +259,38 @@ static errno_t dummy_bitmap_get_alloc(void *arg, gfx_bitmap_alloc_t *alloc)
 	return EOK;
 }
 
+/** Test ds_cursor_get_argb() */
+PCUT_TEST(cursor_get_argb)
+{
+	ds_display_t *disp;
+	ds_cursor_t *cursor;
+	gfx_coord2_t dims;
+	pixel_t *pixels;
+	errno_t rc;
+
+	rc = ds_display_create(NULL, df_none, &disp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ds_cursor_create(disp, &ds_cursimg[dcurs_arrow].rect,
+	    ds_cursimg[dcurs_arrow].image, &cursor);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ds_cursor_get_argb(cursor, &pixels);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	gfx_rect_dims(&cursor->rect, &dims);
+
+	/* Top-left pixel of the arrow is black */
+	PCUT_ASSERT_INT_EQUALS(PIXEL(255, 0, 0, 0), pixels[0]);
+	/* Next to it is transparent */
+	PCUT_ASSERT_INT_EQUALS(0, ALPHA(pixels[1]));
+	/* Inside of the arrow is white */
+	PCUT_ASSERT_INT_EQUALS(PIXEL(255, 255, 255, 255),
+	    pixels[2 * dims.x + 1]);
+
+	free(pixels);
+	ds_cursor_destroy(cursor);
+	ds_display_destroy(disp);
+}
+
 PCUT_EXPORT(cursor);
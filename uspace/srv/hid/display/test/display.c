@@ -64,6 +64,30 @@ PCUT_TEST(display_create_destroy)
 	ds_display_destroy(disp);
 }
 
+/** Frame statistics start out empty and paint without a back buffer
+ * does not schedule any frame.
+ */
+PCUT_TEST(display_frame_stats)
+{
+	ds_display_t *disp;
+	ds_frame_stats_t stats;
+	errno_t rc;
+
+	rc = ds_display_create(NULL, df_none, &disp);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = ds_display_paint(disp, NULL);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_FALSE(disp->frame_pending);
+
+	ds_display_get_frame_stats(disp, &stats);
+	PCUT_ASSERT_INT_EQUALS(0, stats.frames);
+	PCUT_ASSERT_INT_EQUALS(0, stats.dropped);
+	PCUT_ASSERT_INT_EQUALS(0, stats.flush_bytes);
+
+	ds_display_destroy(disp);
+}
+
 /** Basic client operation. */
 PCUT_TEST(display_client)
 {
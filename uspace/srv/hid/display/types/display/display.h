@@ -40,8 +40,12 @@
 #include <fibril_synch.h>
 #include <gfx/color.h>
 #include <gfx/coord.h>
+#include <gfx/region.h>
 #include <io/input.h>
 #include <memgfx/memgc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 #include <types/display/cursor.h>
 #include "cursor.h"
 #include "clonegc.h"
@@ -55,6 +59,20 @@ typedef enum {
 	df_disp_double_buf = 0x1
 } ds_display_flags_t;
 
+/** Frame statistics */
+typedef struct {
+	/** Number of frames flushed to output devices */
+	unsigned long frames;
+	/** Number of refresh intervals missed */
+	unsigned long dropped;
+	/** Duration of last flush in microseconds */
+	usec_t last_usec;
+	/** Longest flush in microseconds */
+	usec_t max_usec;
+	/** Total number of bytes flushed to output devices */
+	uint64_t flush_bytes;
+} ds_frame_stats_t;
+
 /** Display server display */
 typedef struct ds_display {
 	/** Synchronize access to display */
@@ -103,8 +121,26 @@ typedef struct ds_display {
 	/** Frontbuffer (clone) GC */
 	ds_clonegc_t *fbgc;
 
-	/** Backbuffer dirty rectangle */
-	gfx_rect_t dirty_rect;
+	/** Backbuffer dirty region */
+	gfx_region_t dirty;
+	/** Entire backbuffer is dirty (could not extend @c dirty) */
+	bool dirty_all;
+
+	/** Frame timer, flushes back buffer once per refresh interval */
+	fibril_timer_t *frame_timer;
+	/** Frame flush is scheduled */
+	bool frame_pending;
+	/** Time when the last frame was flushed */
+	struct timespec frame_last;
+	/** Microseconds after @c frame_last the pending frame is due */
+	usec_t frame_due;
+	/** Frame statistics */
+	ds_frame_stats_t frame_stats;
+
+	/** Cursor shown in hardware cursor planes or @c NULL if none */
+	ds_cursor_t *hw_cursor;
+	/** Position of hardware cursor */
+	gfx_coord2_t hw_cursor_pos;
 
 	/** Display flags */
 	ds_display_flags_t flags;
@@ -37,6 +37,7 @@
 #include <gfx/color.h>
 #include <gfx/coord.h>
 #include <gfx/context.h>
+#include <gfx/region.h>
 #include <gfx/render.h>
 #include <io/log.h>
 #include <io/pixelmap.h>
@@ -356,9 +357,7 @@ static errno_t ds_window_repaint_preview(ds_window_t *wnd, gfx_rect_t *old_rect)
 {
 	errno_t rc;
 	gfx_rect_t prect;
-	gfx_rect_t envelope;
-	bool oldr;
-	bool newr;
+	gfx_region_t region;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ds_window_repaint_preview");
 
@@ -368,33 +367,36 @@ static errno_t ds_window_repaint_preview(ds_window_t *wnd, gfx_rect_t *old_rect)
 	 */
 	ds_window_get_preview_rect(wnd, &prect);
 
-	oldr = (old_rect != NULL) && !gfx_rect_is_empty(old_rect);
-	newr = !gfx_rect_is_empty(&prect);
+	/*
+	 * Repaint the union of both rectangles in a single operation.
+	 * Unlike their envelope, it does not include any area that
+	 * was not covered by either preview.
+	 */
+	gfx_region_init(&region);
 
-	if (oldr && newr && gfx_rect_is_incident(old_rect, &prect)) {
-		/*
-		 * As an optimization, repaint both rectangles in a single
-		 * operation.
-		 */
+	rc = gfx_region_set_rect(&region, &prect);
+	if (rc == EOK && old_rect != NULL)
+		rc = gfx_region_union_rect(&region, old_rect);
+
+	if (rc == EOK) {
+		rc = ds_display_paint_region(wnd->display, &region);
+		gfx_region_fini(&region);
+		return rc;
+	}
 
-		gfx_rect_envelope(old_rect, &prect, &envelope);
+	gfx_region_fini(&region);
 
-		rc = ds_display_paint(wnd->display, &envelope);
+	/* Out of memory, repaint each rectangle separately */
+	if (old_rect != NULL && !gfx_rect_is_empty(old_rect)) {
+		rc = ds_display_paint(wnd->display, old_rect);
 		if (rc != EOK)
 			return rc;
-	} else {
-		/* Repaint each rectangle separately */
-		if (oldr) {
-			rc = ds_display_paint(wnd->display, old_rect);
-			if (rc != EOK)
-				return rc;
-		}
+	}
 
-		if (newr) {
-			rc = ds_display_paint(wnd->display, &prect);
-			if (rc != EOK)
-				return rc;
-		}
+	if (!gfx_rect_is_empty(&prect)) {
+		rc = ds_display_paint(wnd->display, &prect);
+		if (rc != EOK)
+			return rc;
 	}
 
 	return EOK;
@@ -318,6 +318,13 @@ static void srv_update(ipc_call_t *icall)
 		return;
 
 	chargrid_t *buf = (chargrid_t *) frontbuf->data;
+	sysarg_t r0, r1;
+
+	/* Only rows touched since the last update need to be compared */
+	if (!chargrid_get_dirty(buf, &r0, &r1)) {
+		r0 = 0;
+		r1 = 0;
+	}
 
 	list_foreach(outdevs, link, outdev_t, dev) {
 		assert(dev->ops.char_update);
@@ -325,7 +332,7 @@ static void srv_update(ipc_call_t *icall)
 		if (srv_update_scroll(dev, buf))
 			continue;
 
-		for (sysarg_t y = 0; y < dev->rows; y++) {
+		for (sysarg_t y = r0; y < r1 && y < dev->rows; y++) {
 			for (sysarg_t x = 0; x < dev->cols; x++) {
 				charfield_t *front_field =
 				    chargrid_charfield_at(buf, x, y);
@@ -357,6 +364,7 @@ static void srv_update(ipc_call_t *icall)
 		dev->ops.flush(dev);
 	}
 
+	chargrid_clear_dirty(buf);
 	async_answer_0(icall, EOK);
 }
 
@@ -58,6 +58,7 @@ typedef struct {
 	uint32_t serial;
 	uint32_t facility;
 	uint32_t level;
+	uint64_t timestamp;
 	char message[0];
 
 } __attribute__((__packed__)) log_entry_t;
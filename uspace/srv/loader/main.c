@@ -41,6 +41,7 @@
  * and completely hidden from applications.
  */
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -53,6 +54,8 @@
 #include <errno.h>
 #include <async.h>
 #include <str.h>
+#include <mem.h>
+#include <macros.h>
 #include <as.h>
 #include <elf/elf.h>
 #include <elf/elf_load.h>
@@ -168,6 +171,67 @@ static void ldr_set_program(ipc_call_t *req)
 	async_answer_0(req, EOK);
 }
 
+/** Set arguments of the program to execute.
+ *
+ * @param buf      Null-terminated arguments, the loader takes ownership
+ *                 of the buffer on success.
+ * @param buf_size Size of @a buf.
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ */
+static errno_t ldr_args_set(char *buf, size_t buf_size)
+{
+	/*
+	 * Count number of arguments
+	 */
+	char *cur = buf;
+	int count = 0;
+
+	while (cur < buf + buf_size) {
+		size_t arg_size = str_size(cur);
+		cur += arg_size + 1;
+		count++;
+	}
+
+	/*
+	 * Allocate new argv
+	 */
+	char **_argv = (char **) malloc((count + 1) * sizeof(char *));
+	if (_argv == NULL)
+		return ENOMEM;
+
+	/*
+	 * Fill the new argv with argument pointers
+	 */
+	cur = buf;
+	count = 0;
+	while (cur < buf + buf_size) {
+		_argv[count] = cur;
+
+		size_t arg_size = str_size(cur);
+		cur += arg_size + 1;
+		count++;
+	}
+	_argv[count] = NULL;
+
+	/*
+	 * Copy temporary data to global variables
+	 */
+	if (arg_buf != NULL)
+		free(arg_buf);
+
+	if (argv != NULL)
+		free(argv);
+
+	for (int i = 0; i < count; i++)
+		DPRINTF("LOADER_SET_ARGS('%s')\n", _argv[i]);
+
+	argc = count;
+	arg_buf = buf;
+	argv = _argv;
+	return EOK;
+}
+
 /** Receive a call setting arguments of the program to execute.
  *
  */
@@ -178,60 +242,35 @@ static void ldr_set_args(ipc_call_t *req)
 	errno_t rc = async_data_write_accept((void **) &buf, true, 0, 0, 0, &buf_size);
 
 	if (rc == EOK) {
-		/*
-		 * Count number of arguments
-		 */
-		char *cur = buf;
-		int count = 0;
-
-		while (cur < buf + buf_size) {
-			size_t arg_size = str_size(cur);
-			cur += arg_size + 1;
-			count++;
-		}
-
-		/*
-		 * Allocate new argv
-		 */
-		char **_argv = (char **) malloc((count + 1) * sizeof(char *));
-		if (_argv == NULL) {
+		rc = ldr_args_set(buf, buf_size);
+		if (rc != EOK)
 			free(buf);
-			async_answer_0(req, ENOMEM);
-			return;
-		}
-
-		/*
-		 * Fill the new argv with argument pointers
-		 */
-		cur = buf;
-		count = 0;
-		while (cur < buf + buf_size) {
-			_argv[count] = cur;
-
-			size_t arg_size = str_size(cur);
-			cur += arg_size + 1;
-			count++;
-		}
-		_argv[count] = NULL;
+	}
 
-		/*
-		 * Copy temporary data to global variables
-		 */
-		if (arg_buf != NULL)
-			free(arg_buf);
+	async_answer_0(req, rc);
+}
 
-		if (argv != NULL)
-			free(argv);
+/** Add an inbox entry of the program to execute.
+ *
+ * @param name Name of the entry, the loader takes ownership of it.
+ * @param file File handle of the entry.
+ */
+static void ldr_inbox_add(char *name, int file)
+{
+	assert(inbox_entries < INBOX_MAX_ENTRIES);
 
-		for (int i = 0; i < count; i++)
-			DPRINTF("LOADER_SET_ARGS('%s')\n", _argv[i]);
+	DPRINTF("LOADER_ADD_INBOX('%s')\n", name);
 
-		argc = count;
-		arg_buf = buf;
-		argv = _argv;
-	}
+	/*
+	 * We need to set the root early for dynamically linked binaries so
+	 * that the loader can use it too.
+	 */
+	if (str_cmp(name, "root") == 0)
+		vfs_root_set(file);
 
-	async_answer_0(req, rc);
+	inbox[inbox_entries].name = name;
+	inbox[inbox_entries].file = file;
+	inbox_entries++;
 }
 
 /** Receive a call setting inbox files of the program to execute.
@@ -265,35 +304,20 @@ static void ldr_add_inbox(ipc_call_t *req)
 		return;
 	}
 
-	DPRINTF("LOADER_ADD_INBOX('%s')\n", name);
-
-	/*
-	 * We need to set the root early for dynamically linked binaries so
-	 * that the loader can use it too.
-	 */
-	if (str_cmp(name, "root") == 0)
-		vfs_root_set(file);
-
-	inbox[inbox_entries].name = name;
-	inbox[inbox_entries].file = file;
-	inbox_entries++;
+	ldr_inbox_add(name, file);
 	async_answer_0(req, EOK);
 }
 
 /** Load the previously selected program.
  *
- * @return 0 on success, !0 on error.
- *
+ * @return EOK on success, error code otherwise.
  */
-static int ldr_load(ipc_call_t *req)
+static errno_t ldr_load_program(void)
 {
-	DPRINTF("LOADER_LOAD()\n");
-
 	errno_t rc = elf_load(program_fd, &prog_info);
 	if (rc != EOK) {
 		DPRINTF("Failed to load executable for '%s'.\n", progname);
-		async_answer_0(req, EINVAL);
-		return 1;
+		return EINVAL;
 	}
 
 	DPRINTF("Loaded.\n");
@@ -310,8 +334,7 @@ static int ldr_load(ipc_call_t *req)
 
 	if (!pcb.tcb) {
 		DPRINTF("Failed to make TLS for '%s'.\n", progname);
-		async_answer_0(req, ENOMEM);
-		return 1;
+		return ENOMEM;
 	}
 
 	elf_set_pcb(&prog_info, &pcb);
@@ -326,9 +349,154 @@ static int ldr_load(ipc_call_t *req)
 	pcb.inbox = inbox;
 	pcb.inbox_entries = inbox_entries;
 
+	return EOK;
+}
+
+/** Load the previously selected program.
+ *
+ */
+static void ldr_load(ipc_call_t *req)
+{
+	DPRINTF("LOADER_LOAD()\n");
+
+	errno_t rc = ldr_load_program();
+
 	DPRINTF("Answering.\n");
-	async_answer_0(req, EOK);
-	return 0;
+	async_answer_0(req, rc);
+}
+
+/** Get the next null-terminated string from spawn data.
+ *
+ * @param cur Current position, advanced past the string.
+ * @param end End of the data.
+ *
+ * @return Copy of the string or NULL if it is not terminated
+ *         or out of memory.
+ */
+static char *ldr_spawn_str(char **cur, char *end)
+{
+	char *nul = memchr(*cur, '\0', end - *cur);
+	if (nul == NULL)
+		return NULL;
+
+	char *str = str_dup(*cur);
+	*cur = nul + 1;
+	return str;
+}
+
+/** Receive all parameters of the program to execute and load it.
+ *
+ * This is equivalent to LOADER_SET_CWD, LOADER_SET_PROGRAM,
+ * LOADER_SET_ARGS, a LOADER_ADD_INBOX for each inbox entry and
+ * LOADER_LOAD, but takes a single request.
+ *
+ */
+static void ldr_spawn(ipc_call_t *req)
+{
+	size_t inboxes = ipc_get_arg1(req);
+	char *names[INBOX_MAX_ENTRIES];
+	int files[INBOX_MAX_ENTRIES];
+	char *_cwd = NULL;
+	char *name = NULL;
+	char *args = NULL;
+	int file = -1;
+	size_t nnames = 0;
+	size_t nfiles = 0;
+	size_t args_size;
+	char *buf;
+	size_t size;
+
+	if (inboxes > (size_t) (INBOX_MAX_ENTRIES - inbox_entries)) {
+		async_answer_0(req, ERANGE);
+		return;
+	}
+
+	errno_t rc = async_data_write_accept((void **) &buf, false, 0,
+	    LOADER_SPAWN_MAX_SIZE, 0, &size);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
+
+	char *cur = buf;
+	char *end = buf + size;
+
+	rc = EINVAL;
+
+	_cwd = ldr_spawn_str(&cur, end);
+	if (_cwd == NULL)
+		goto error;
+
+	name = ldr_spawn_str(&cur, end);
+	if (name == NULL)
+		goto error;
+
+	while (nnames < inboxes) {
+		names[nnames] = ldr_spawn_str(&cur, end);
+		if (names[nnames] == NULL)
+			goto error;
+		nnames++;
+	}
+
+	/* The arguments extend up to the end of the data */
+	args_size = end - cur;
+	if ((args_size > 0) && (end[-1] != '\0'))
+		goto error;
+
+	args = malloc(max(args_size, 1));
+	if (args == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	memcpy(args, cur, args_size);
+
+	rc = vfs_receive_handle(true, &file);
+	if (rc != EOK)
+		goto error;
+
+	while (nfiles < inboxes) {
+		rc = vfs_receive_handle(true, &files[nfiles]);
+		if (rc != EOK)
+			goto error;
+		nfiles++;
+	}
+
+	rc = ldr_args_set(args, args_size);
+	if (rc != EOK)
+		goto error;
+
+	free(buf);
+
+	if (cwd != NULL)
+		free(cwd);
+	cwd = _cwd;
+
+	DPRINTF("LOADER_SPAWN('%s')\n", name);
+	progname = name;
+	program_fd = file;
+
+	for (size_t i = 0; i < inboxes; i++)
+		ldr_inbox_add(names[i], files[i]);
+
+	rc = ldr_load_program();
+
+	task_id_t task_id = task_get_id();
+	async_answer_2(req, rc, LOWER32(task_id), UPPER32(task_id));
+	return;
+
+error:
+	for (size_t i = 0; i < nfiles; i++)
+		vfs_put(files[i]);
+	if (file >= 0)
+		vfs_put(file);
+	for (size_t i = 0; i < nnames; i++)
+		free(names[i]);
+	free(args);
+	free(name);
+	free(_cwd);
+	free(buf);
+	async_answer_0(req, rc);
 }
 
 /** Run the previously loaded program.
@@ -415,6 +583,9 @@ static void ldr_connection(ipc_call_t *icall, void *arg)
 		case LOADER_LOAD:
 			ldr_load(&call);
 			continue;
+		case LOADER_SPAWN:
+			ldr_spawn(&call);
+			continue;
 		case LOADER_RUN:
 			ldr_run(&call);
 			/* Not reached */
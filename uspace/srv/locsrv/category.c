@@ -41,17 +41,81 @@
 #include "category.h"
 #include "locsrv.h"
 
+static size_t cat_name_key_hash(const void *key)
+{
+	return loc_str_hash(0, key);
+}
+
+static size_t cat_name_hash(const ht_link_t *item)
+{
+	category_t *cat = hash_table_get_inst(item, category_t, name_link);
+	return cat_name_key_hash(cat->name);
+}
+
+static bool cat_name_key_equal(const void *key, const ht_link_t *item)
+{
+	category_t *cat = hash_table_get_inst(item, category_t, name_link);
+	return str_cmp(cat->name, key) == 0;
+}
+
+static size_t cat_id_key_hash(const void *key)
+{
+	const catid_t *id = key;
+	return *id;
+}
+
+static size_t cat_id_hash(const ht_link_t *item)
+{
+	category_t *cat = hash_table_get_inst(item, category_t, id_link);
+	return cat_id_key_hash(&cat->id);
+}
+
+static bool cat_id_key_equal(const void *key, const ht_link_t *item)
+{
+	const catid_t *id = key;
+	category_t *cat = hash_table_get_inst(item, category_t, id_link);
+	return cat->id == *id;
+}
+
+static hash_table_ops_t cat_name_ops = {
+	.hash = cat_name_hash,
+	.key_hash = cat_name_key_hash,
+	.key_equal = cat_name_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static hash_table_ops_t cat_id_ops = {
+	.hash = cat_id_hash,
+	.key_hash = cat_id_key_hash,
+	.key_equal = cat_id_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
 /** Initialize category directory. */
-void categ_dir_init(categ_dir_t *cdir)
+errno_t categ_dir_init(categ_dir_t *cdir)
 {
 	fibril_mutex_initialize(&cdir->mutex);
 	list_initialize(&cdir->categories);
+
+	if (!hash_table_create(&cdir->by_name, 0, 0, &cat_name_ops))
+		return ENOMEM;
+
+	if (!hash_table_create(&cdir->by_id, 0, 0, &cat_id_ops)) {
+		hash_table_destroy(&cdir->by_name);
+		return ENOMEM;
+	}
+
+	return EOK;
 }
 
 /** Add new category to directory. */
 void categ_dir_add_cat(categ_dir_t *cdir, category_t *cat)
 {
 	list_append(&cat->cat_list, &cdir->categories);
+	hash_table_insert(&cdir->by_name, &cat->name_link);
+	hash_table_insert(&cdir->by_id, &cat->id_link);
 }
 
 /** Get list of categories. */
@@ -147,12 +211,11 @@ category_t *category_get(categ_dir_t *cdir, catid_t catid)
 {
 	assert(fibril_mutex_is_locked(&cdir->mutex));
 
-	list_foreach(cdir->categories, cat_list, category_t, cat) {
-		if (cat->id == catid)
-			return cat;
-	}
+	ht_link_t *link = hash_table_find(&cdir->by_id, &catid);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, category_t, id_link);
 }
 
 /** Find category by name. */
@@ -160,12 +223,11 @@ category_t *category_find_by_name(categ_dir_t *cdir, const char *name)
 {
 	assert(fibril_mutex_is_locked(&cdir->mutex));
 
-	list_foreach(cdir->categories, cat_list, category_t, cat) {
-		if (str_cmp(cat->name, name) == 0)
-			return cat;
-	}
+	ht_link_t *link = hash_table_find(&cdir->by_name, name);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, category_t, name_link);
 }
 
 /** Get list of services in category. */
@@ -35,6 +35,7 @@
 #ifndef CATEGORY_H_
 #define CATEGORY_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include "locsrv.h"
 
@@ -54,6 +55,12 @@ typedef struct {
 	/** Link to list of categories (categ_dir_t.categories) */
 	link_t cat_list;
 
+	/** Link to categ_dir_t.by_name */
+	ht_link_t name_link;
+
+	/** Link to categ_dir_t.by_id */
+	ht_link_t id_link;
+
 	/** List of service memberships in this category (svc_categ_t) */
 	list_t svc_memb;
 } category_t;
@@ -64,6 +71,10 @@ typedef struct {
 	fibril_mutex_t mutex;
 	/** List of all categories (category_t) */
 	list_t categories;
+	/** Categories hashed by name */
+	hash_table_t by_name;
+	/** Categories hashed by ID */
+	hash_table_t by_id;
 } categ_dir_t;
 
 /** Service in category membership. */
@@ -79,7 +90,7 @@ typedef struct {
 	loc_service_t *svc;
 } svc_categ_t;
 
-extern void categ_dir_init(categ_dir_t *);
+extern errno_t categ_dir_init(categ_dir_t *);
 extern void categ_dir_add_cat(categ_dir_t *, category_t *);
 extern errno_t categ_dir_get_categories(categ_dir_t *, service_id_t *, size_t,
     size_t *);
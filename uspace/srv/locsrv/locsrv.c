@@ -37,6 +37,8 @@
 
 #include <ipc/services.h>
 #include <ns.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <async.h>
 #include <stdio.h>
 #include <errno.h>
@@ -61,10 +63,25 @@ typedef struct {
 	async_sess_t *sess;
 } cb_sess_t;
 
+/** Fully qualified service name used as a hash table key */
+typedef struct {
+	const char *ns_name;
+	const char *name;
+} loc_fqsn_key_t;
+
 LIST_INITIALIZE(services_list);
 LIST_INITIALIZE(namespaces_list);
 LIST_INITIALIZE(servers_list);
 
+/*
+ * Hash tables indexing services_list and namespaces_list, protected by
+ * services_list_mutex.
+ */
+static hash_table_t services_by_name;
+static hash_table_t services_by_id;
+static hash_table_t namespaces_by_name;
+static hash_table_t namespaces_by_id;
+
 /*
  * Locking order:
  *  servers_list_mutex
@@ -94,6 +111,150 @@ static categ_dir_t cdir;
 static FIBRIL_MUTEX_INITIALIZE(callback_sess_mutex);
 static LIST_INITIALIZE(callback_sess_list);
 
+/** Hash a string.
+ *
+ * @param seed Hash to continue from
+ * @param str  String
+ * @return Hash of @a seed followed by @a str
+ */
+size_t loc_str_hash(size_t seed, const char *str)
+{
+	size_t hash = seed;
+
+	while (*str != '\0')
+		hash = hash_combine(hash, (uint8_t) *str++);
+
+	return hash;
+}
+
+static size_t loc_id_key_hash(const void *key)
+{
+	const service_id_t *id = key;
+	return hash_mix(*id);
+}
+
+static size_t svc_name_key_hash(const void *key)
+{
+	const loc_fqsn_key_t *fqsn = key;
+
+	/* The separator keeps "a" + "bc" apart from "ab" + "c" */
+	return loc_str_hash(hash_combine(loc_str_hash(0, fqsn->ns_name), '/'),
+	    fqsn->name);
+}
+
+static size_t svc_name_hash(const ht_link_t *item)
+{
+	loc_service_t *svc = hash_table_get_inst(item, loc_service_t,
+	    name_link);
+	loc_fqsn_key_t key = {
+		.ns_name = svc->namespace->name,
+		.name = svc->name
+	};
+
+	return svc_name_key_hash(&key);
+}
+
+static bool svc_name_key_equal(const void *key, const ht_link_t *item)
+{
+	const loc_fqsn_key_t *fqsn = key;
+	loc_service_t *svc = hash_table_get_inst(item, loc_service_t,
+	    name_link);
+
+	return (str_cmp(svc->namespace->name, fqsn->ns_name) == 0) &&
+	    (str_cmp(svc->name, fqsn->name) == 0);
+}
+
+static size_t svc_id_hash(const ht_link_t *item)
+{
+	loc_service_t *svc = hash_table_get_inst(item, loc_service_t,
+	    id_link);
+	return loc_id_key_hash(&svc->id);
+}
+
+static bool svc_id_key_equal(const void *key, const ht_link_t *item)
+{
+	const service_id_t *id = key;
+	loc_service_t *svc = hash_table_get_inst(item, loc_service_t,
+	    id_link);
+	return svc->id == *id;
+}
+
+static size_t ns_name_key_hash(const void *key)
+{
+	return loc_str_hash(0, key);
+}
+
+static size_t ns_name_hash(const ht_link_t *item)
+{
+	loc_namespace_t *ns = hash_table_get_inst(item, loc_namespace_t,
+	    name_link);
+	return ns_name_key_hash(ns->name);
+}
+
+static bool ns_name_key_equal(const void *key, const ht_link_t *item)
+{
+	loc_namespace_t *ns = hash_table_get_inst(item, loc_namespace_t,
+	    name_link);
+	return str_cmp(ns->name, key) == 0;
+}
+
+static size_t ns_id_hash(const ht_link_t *item)
+{
+	loc_namespace_t *ns = hash_table_get_inst(item, loc_namespace_t,
+	    id_link);
+	return loc_id_key_hash(&ns->id);
+}
+
+static bool ns_id_key_equal(const void *key, const ht_link_t *item)
+{
+	const service_id_t *id = key;
+	loc_namespace_t *ns = hash_table_get_inst(item, loc_namespace_t,
+	    id_link);
+	return ns->id == *id;
+}
+
+static hash_table_ops_t svc_name_ops = {
+	.hash = svc_name_hash,
+	.key_hash = svc_name_key_hash,
+	.key_equal = svc_name_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static hash_table_ops_t svc_id_ops = {
+	.hash = svc_id_hash,
+	.key_hash = loc_id_key_hash,
+	.key_equal = svc_id_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static hash_table_ops_t ns_name_ops = {
+	.hash = ns_name_hash,
+	.key_hash = ns_name_key_hash,
+	.key_equal = ns_name_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static hash_table_ops_t ns_id_ops = {
+	.hash = ns_id_hash,
+	.key_hash = loc_id_key_hash,
+	.key_equal = ns_id_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+/** Add service to services_list and its indices. */
+static void loc_service_insert(loc_service_t *service)
+{
+	assert(fibril_mutex_is_locked(&services_list_mutex));
+
+	list_append(&service->services, &services_list);
+	hash_table_insert(&services_by_name, &service->name_link);
+	hash_table_insert(&services_by_id, &service->id_link);
+}
+
 service_id_t loc_create_id(void)
 {
 	/*
@@ -185,29 +346,23 @@ static loc_namespace_t *loc_namespace_find_name(const char *name)
 {
 	assert(fibril_mutex_is_locked(&services_list_mutex));
 
-	list_foreach(namespaces_list, namespaces, loc_namespace_t, namespace) {
-		if (str_cmp(namespace->name, name) == 0)
-			return namespace;
-	}
+	ht_link_t *link = hash_table_find(&namespaces_by_name, name);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, loc_namespace_t, name_link);
 }
 
-/** Find namespace with given ID.
- *
- * @todo: use hash table
- *
- */
+/** Find namespace with given ID. */
 static loc_namespace_t *loc_namespace_find_id(service_id_t id)
 {
 	assert(fibril_mutex_is_locked(&services_list_mutex));
 
-	list_foreach(namespaces_list, namespaces, loc_namespace_t, namespace) {
-		if (namespace->id == id)
-			return namespace;
-	}
+	ht_link_t *link = hash_table_find(&namespaces_by_id, &id);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, loc_namespace_t, id_link);
 }
 
 /** Find service with given name. */
@@ -216,30 +371,28 @@ static loc_service_t *loc_service_find_name(const char *ns_name,
 {
 	assert(fibril_mutex_is_locked(&services_list_mutex));
 
-	list_foreach(services_list, services, loc_service_t, service) {
-		if ((str_cmp(service->namespace->name, ns_name) == 0) &&
-		    (str_cmp(service->name, name) == 0))
-			return service;
-	}
+	loc_fqsn_key_t key = {
+		.ns_name = ns_name,
+		.name = name
+	};
+
+	ht_link_t *link = hash_table_find(&services_by_name, &key);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, loc_service_t, name_link);
 }
 
-/** Find service with given ID.
- *
- * @todo: use hash table
- *
- */
+/** Find service with given ID. */
 static loc_service_t *loc_service_find_id(service_id_t id)
 {
 	assert(fibril_mutex_is_locked(&services_list_mutex));
 
-	list_foreach(services_list, services, loc_service_t, service) {
-		if (service->id == id)
-			return service;
-	}
+	ht_link_t *link = hash_table_find(&services_by_id, &id);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, loc_service_t, id_link);
 }
 
 /** Create a namespace (if not already present). */
@@ -270,6 +423,8 @@ static loc_namespace_t *loc_namespace_create(const char *ns_name)
 	 * Insert new namespace into list of registered namespaces
 	 */
 	list_append(&(namespace->namespaces), &namespaces_list);
+	hash_table_insert(&namespaces_by_name, &namespace->name_link);
+	hash_table_insert(&namespaces_by_id, &namespace->id_link);
 
 	return namespace;
 }
@@ -281,6 +436,9 @@ static void loc_namespace_destroy(loc_namespace_t *namespace)
 
 	if (namespace->refcnt == 0) {
 		list_remove(&(namespace->namespaces));
+		hash_table_remove_item(&namespaces_by_name,
+		    &namespace->name_link);
+		hash_table_remove_item(&namespaces_by_id, &namespace->id_link);
 
 		free(namespace->name);
 		free(namespace);
@@ -312,6 +470,9 @@ static void loc_service_unregister_core(loc_service_t *service)
 	assert(fibril_mutex_is_locked(&services_list_mutex));
 	assert(fibril_mutex_is_locked(&cdir.mutex));
 
+	/* The name hash needs the namespace, remove before dropping it */
+	hash_table_remove_item(&services_by_name, &service->name_link);
+	hash_table_remove_item(&services_by_id, &service->id_link);
 	loc_namespace_delref(service->namespace);
 	list_remove(&(service->services));
 	list_remove(&(service->server_services));
@@ -524,7 +685,7 @@ static void loc_service_register(ipc_call_t *icall, loc_server_t *server)
 	service->server = server;
 
 	/* Insert service into list of all services  */
-	list_append(&service->services, &services_list);
+	loc_service_insert(service);
 
 	/* Insert service into list of services supplied by one server */
 	fibril_mutex_lock(&service->server->services_mutex);
@@ -1234,7 +1395,7 @@ static void loc_null_create(ipc_call_t *icall)
 	 * Insert service into a dummy list of null server's services so that it
 	 * can be safely removed later.
 	 */
-	list_append(&service->services, &services_list);
+	loc_service_insert(service);
 	list_append(&service->server_services, &dummy_null_services);
 	null_services[i] = service;
 
@@ -1324,7 +1485,14 @@ static bool loc_init(void)
 	for (i = 0; i < NULL_SERVICES; i++)
 		null_services[i] = NULL;
 
-	categ_dir_init(&cdir);
+	if (!hash_table_create(&services_by_name, 0, 0, &svc_name_ops) ||
+	    !hash_table_create(&services_by_id, 0, 0, &svc_id_ops) ||
+	    !hash_table_create(&namespaces_by_name, 0, 0, &ns_name_ops) ||
+	    !hash_table_create(&namespaces_by_id, 0, 0, &ns_id_ops))
+		return false;
+
+	if (categ_dir_init(&cdir) != EOK)
+		return false;
 
 	cat = category_new("disk");
 	categ_dir_add_cat(&cdir, cat);
@@ -35,6 +35,7 @@
 #ifndef LOCSRV_H_
 #define LOCSRV_H_
 
+#include <adt/hash_table.h>
 #include <ipc/loc.h>
 #include <async.h>
 #include <fibril_synch.h>
@@ -69,6 +70,12 @@ typedef struct {
 	/** Link to namespaces_list */
 	link_t namespaces;
 
+	/** Link to namespaces_by_name */
+	ht_link_t name_link;
+
+	/** Link to namespaces_by_id */
+	ht_link_t id_link;
+
 	/** Unique namespace identifier */
 	service_id_t id;
 
@@ -86,6 +93,12 @@ typedef struct {
 	/** Link to global list of services (services_list) */
 	link_t services;
 
+	/** Link to services_by_name */
+	ht_link_t name_link;
+
+	/** Link to services_by_id */
+	ht_link_t id_link;
+
 	/** Link to server list of services (loc_server_t.services) */
 	link_t server_services;
 
@@ -111,6 +124,7 @@ typedef struct {
 extern fibril_mutex_t services_list_mutex;
 
 extern service_id_t loc_create_id(void);
+extern size_t loc_str_hash(size_t, const char *);
 extern void loc_category_change_event(void);
 
 #endif
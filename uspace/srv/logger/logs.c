@@ -34,6 +34,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
+#include <vfs/vfs.h>
 #include "logger.h"
 
 static FIBRIL_MUTEX_INITIALIZE(log_list_guard);
@@ -59,6 +60,7 @@ static errno_t create_dest(const char *name, logger_dest_t **dest)
 		return ENOMEM;
 	}
 	result->logfile = NULL;
+	result->dirty = false;
 	fibril_mutex_initialize(&result->guard);
 	*dest = result;
 	return EOK;
@@ -183,6 +185,15 @@ static log_level_t get_actual_log_level(logger_log_t *log)
 	return log->logged_level;
 }
 
+/** Get the most verbose level written to the log. */
+log_level_t get_logged_level(logger_log_t *log)
+{
+	fibril_mutex_lock(&log_list_guard);
+	log_level_t result = get_actual_log_level(log);
+	fibril_mutex_unlock(&log_list_guard);
+	return result;
+}
+
 bool shall_log_message(logger_log_t *log, log_level_t level)
 {
 	fibril_mutex_lock(&log_list_guard);
@@ -294,12 +305,37 @@ void write_to_log(logger_log_t *log, log_level_t level, const char *message)
 		fprintf(log->dest->logfile, "[%s] %s: %s\n",
 		    log->full_name, log_level_str(level),
 		    (const char *) message);
-		fflush(log->dest->logfile);
+
+		/* Errors go out immediately, the rest is flushed periodically. */
+		if (level <= LVL_ERROR)
+			fflush(log->dest->logfile);
+		else
+			log->dest->dirty = true;
 	}
 
 	fibril_mutex_unlock(&log->dest->guard);
 }
 
+/** Flush buffered messages of all logs and sync them to storage. */
+void flush_logs(void)
+{
+	fibril_mutex_lock(&log_list_guard);
+	list_foreach(log_list, link, logger_log_t, log) {
+		if (log->parent != NULL)
+			continue;
+
+		logger_dest_t *dest = log->dest;
+		fibril_mutex_lock(&dest->guard);
+		if (dest->dirty && dest->logfile != NULL) {
+			fflush(dest->logfile);
+			vfs_sync(fileno(dest->logfile));
+		}
+		dest->dirty = false;
+		fibril_mutex_unlock(&dest->guard);
+	}
+	fibril_mutex_unlock(&log_list_guard);
+}
+
 void registered_logs_init(logger_registered_logs_t *logs)
 {
 	logs->logs_count = 0;
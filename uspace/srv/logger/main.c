@@ -40,6 +40,7 @@
 #include <io/logctl.h>
 #include <ns.h>
 #include <async.h>
+#include <fibril.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
@@ -56,6 +57,17 @@ static void connection_handler_writer(ipc_call_t *icall, void *arg)
 	logger_connection_handler_writer(icall);
 }
 
+/** Periodically flush buffered messages to the logfiles. */
+static errno_t flush_fibril(void *arg)
+{
+	while (true) {
+		fibril_usleep(LOGGER_FLUSH_USEC);
+		flush_logs();
+	}
+
+	return EOK;
+}
+
 int main(int argc, char *argv[])
 {
 	printf(NAME ": HelenOS Logging Service\n");
@@ -81,6 +93,13 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
+	fid_t fid = fibril_create(flush_fibril, NULL);
+	if (fid == 0) {
+		printf("%s: Failed to create flush fibril.\n", NAME);
+		return -1;
+	}
+	fibril_add_ready(fid);
+
 	printf("%s: Accepting connections\n", NAME);
 	async_manager();
 
@@ -34,19 +34,39 @@
 /** @file
  */
 
+#include <assert.h>
 #include <ipc/services.h>
 #include <ipc/logger.h>
 #include <io/log.h>
 #include <io/logctl.h>
 #include <io/klog.h>
 #include <ns.h>
+#include <as.h>
 #include <async.h>
 #include <errno.h>
+#include <mem.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str_error.h>
 #include "logger.h"
 
+/** Writer client. */
+typedef struct {
+	/** Link in writers. */
+	link_t link;
+	/** Logs created by the client. */
+	logger_registered_logs_t logs;
+	/** Message ring shared by the client or NULL. */
+	logger_ring_t *ring;
+	/** Dropped messages already reported. */
+	size_t dropped;
+} logger_writer_t;
+
+/** Writers sharing a message ring, guarded by writers_guard. */
+static FIBRIL_MUTEX_INITIALIZE(writers_guard);
+static LIST_INITIALIZE(writers);
+
 static logger_log_t *handle_create_log(sysarg_t parent)
 {
 	void *name;
@@ -61,6 +81,17 @@ static logger_log_t *handle_create_log(sysarg_t parent)
 	return log;
 }
 
+static void write_message(logger_log_t *log, log_level_t level,
+    const char *message)
+{
+	if (!shall_log_message(log, level))
+		return;
+
+	KLOG_PRINTF(level, "[%s] %s: %s",
+	    log->full_name, log_level_str(level), message);
+	write_to_log(log, level, message);
+}
+
 static errno_t handle_receive_message(sysarg_t log_id, sysarg_t level)
 {
 	logger_log_t *log = find_log_by_id_and_lock(log_id);
@@ -72,16 +103,7 @@ static errno_t handle_receive_message(sysarg_t log_id, sysarg_t level)
 	if (rc != EOK)
 		goto leave;
 
-	if (!shall_log_message(log, level)) {
-		rc = EOK;
-		goto leave;
-	}
-
-	KLOG_PRINTF(level, "[%s] %s: %s",
-	    log->full_name, log_level_str(level),
-	    (const char *) message);
-	write_to_log(log, level, message);
-
+	write_message(log, level, message);
 	rc = EOK;
 
 leave:
@@ -91,6 +113,165 @@ leave:
 	return rc;
 }
 
+/** Publish levels of the logs of a writer to its message ring.
+ *
+ * Precondition: writers_guard is locked.
+ */
+static void writer_levels_update(logger_writer_t *writer)
+{
+	assert(fibril_mutex_is_locked(&writers_guard));
+
+	if (writer->ring == NULL)
+		return;
+
+	for (size_t i = 0; i < writer->logs.logs_count; i++) {
+		logger_log_t *log = writer->logs.logs[i];
+		logger_ring_log_t *rlog = &writer->ring->logs[i];
+
+		atomic_store_explicit(&rlog->level, get_logged_level(log),
+		    memory_order_relaxed);
+		atomic_store_explicit(&rlog->log, (sysarg_t) log,
+		    memory_order_release);
+	}
+}
+
+/** Publish levels of all logs to the clients after a level change. */
+void writers_levels_update(void)
+{
+	fibril_mutex_lock(&writers_guard);
+	list_foreach(writers, link, logger_writer_t, writer) {
+		writer_levels_update(writer);
+	}
+	fibril_mutex_unlock(&writers_guard);
+}
+
+static void handle_ring_share(logger_writer_t *writer, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+	void *ring;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	if (writer->ring != NULL || size != sizeof(logger_ring_t)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	errno_t rc = async_share_out_finalize(&call, &ring);
+	if (rc != EOK || ring == AS_MAP_FAILED) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	fibril_mutex_lock(&writers_guard);
+	writer->ring = (logger_ring_t *) ring;
+	writer->dropped = atomic_load(&writer->ring->dropped);
+	list_append(&writer->link, &writers);
+	writer_levels_update(writer);
+	fibril_mutex_unlock(&writers_guard);
+
+	async_answer_0(icall, EOK);
+}
+
+/** Write one message from the ring.
+ *
+ * The client can modify the buffer at any time, so the text is copied
+ * and terminated first.
+ */
+static void writer_ring_message(logger_ring_msg_t *msg, size_t size)
+{
+	sysarg_t log_id = msg->log;
+	log_level_t level = msg->level;
+	size_t length = size - sizeof(logger_ring_msg_t);
+
+	if (level >= LVL_LIMIT)
+		return;
+
+	char *message = malloc(length + 1);
+	if (message == NULL)
+		return;
+
+	memcpy(message, msg + 1, length);
+	message[length] = '\0';
+
+	logger_log_t *log = find_log_by_id_and_lock(log_id);
+	if (log != NULL) {
+		write_message(log, level, message);
+		log_unlock(log);
+	}
+
+	free(message);
+}
+
+/** Write all messages queued in the ring of a writer.
+ *
+ * Announces to the client that the logger is going to wait for
+ * LOGGER_WRITER_RING_KICK once the ring is found empty.
+ */
+static void writer_ring_drain(logger_writer_t *writer)
+{
+	logger_ring_t *ring = writer->ring;
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	while (true) {
+		size_t tail = atomic_load(&ring->tail);
+
+		while (head != tail) {
+			size_t pos = head % LOGGER_RING_SIZE;
+			size_t contig = LOGGER_RING_SIZE - pos;
+
+			if (contig < sizeof(logger_ring_msg_t)) {
+				head += contig;
+				continue;
+			}
+
+			logger_ring_msg_t *msg =
+			    (logger_ring_msg_t *) &ring->buffer[pos];
+			size_t size = msg->size;
+			if (size < sizeof(logger_ring_msg_t) || size > contig ||
+			    size > tail - head) {
+				/* Corrupted by the client, discard the rest. */
+				head = tail;
+				break;
+			}
+
+			if (msg->log != 0)
+				writer_ring_message(msg, size);
+
+			head += size;
+		}
+
+		atomic_store_explicit(&ring->head, head, memory_order_release);
+
+		size_t dropped = atomic_load(&ring->dropped);
+		if (dropped != writer->dropped && writer->logs.logs_count > 0) {
+			logger_log_t *log = writer->logs.logs[0];
+			char *message;
+
+			if (asprintf(&message, "%zu messages dropped",
+			    dropped - writer->dropped) >= 0) {
+				fibril_mutex_lock(&log->guard);
+				write_message(log, LVL_WARN, message);
+				log_unlock(log);
+				free(message);
+			}
+			writer->dropped = dropped;
+		}
+
+		/* Recheck after announcing sleep so that no kick is lost. */
+		atomic_store(&ring->sleeping, true);
+		if (atomic_load(&ring->tail) == head)
+			break;
+		atomic_store(&ring->sleeping, false);
+	}
+}
+
 void logger_connection_handler_writer(ipc_call_t *icall)
 {
 	logger_log_t *log;
@@ -101,8 +282,11 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 
 	logger_log("writer: new client.\n");
 
-	logger_registered_logs_t registered_logs;
-	registered_logs_init(&registered_logs);
+	logger_writer_t writer;
+	link_initialize(&writer.link);
+	registered_logs_init(&writer.logs);
+	writer.ring = NULL;
+	writer.dropped = 0;
 
 	while (true) {
 		ipc_call_t call;
@@ -120,12 +304,17 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 				async_answer_0(&call, ENOMEM);
 				break;
 			}
-			if (!register_log(&registered_logs, log)) {
+			if (!register_log(&writer.logs, log)) {
 				log_unlock(log);
 				async_answer_0(&call, ELIMIT);
 				break;
 			}
 			log_unlock(log);
+
+			fibril_mutex_lock(&writers_guard);
+			writer_levels_update(&writer);
+			fibril_mutex_unlock(&writers_guard);
+
 			async_answer_1(&call, EOK, (sysarg_t) log);
 			break;
 		case LOGGER_WRITER_MESSAGE:
@@ -133,13 +322,32 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 			    ipc_get_arg2(&call));
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_WRITER_RING_SHARE:
+			handle_ring_share(&writer, &call);
+			break;
+		case LOGGER_WRITER_RING_KICK:
+			async_answer_0(&call, EOK);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
 		}
+
+		if (writer.ring != NULL)
+			writer_ring_drain(&writer);
+	}
+
+	if (writer.ring != NULL) {
+		writer_ring_drain(&writer);
+
+		fibril_mutex_lock(&writers_guard);
+		list_remove(&writer.link);
+		fibril_mutex_unlock(&writers_guard);
+
+		as_area_destroy(writer.ring);
 	}
 
-	unregister_logs(&registered_logs);
+	unregister_logs(&writer.logs);
 	logger_log("writer: client terminated.\n");
 }
 
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup dnsrsrv
+ * @{
+ */
+/**
+ * @file DNS resolver cache
+ *
+ * Caches positive and negative answers for as long as their TTL allows.
+ * Concurrent identical queries are coalesced so that only one of them
+ * is sent upstream.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <io/log.h>
+#include <macros.h>
+#include <stdlib.h>
+#include <str.h>
+#include <time.h>
+#include "cache.h"
+
+/** Default maximum number of cached answers */
+#define DNS_CACHE_DEFAULT_SIZE 256
+/** Upper bound on the time an answer is cached (seconds) */
+#define DNS_CACHE_MAX_TTL (24 * 60 * 60)
+
+/** Cached answer */
+typedef struct {
+	/** Link to dns_cache_table */
+	ht_link_t htlink;
+	/** Link to dns_cache_lru if the answer is cached */
+	link_t lru_link;
+	/** Query name */
+	char *name;
+	/** Query type */
+	dns_qtype_t qtype;
+	/** Query is being resolved */
+	bool pending;
+	/** Entry has been removed from the cache */
+	bool detached;
+	/** Number of fibrils waiting for the answer */
+	unsigned refcnt;
+	/** Result of the query */
+	errno_t rc;
+	/** Host information if @c rc is EOK */
+	dns_host_info_t info;
+	/** Uptime at which the answer expires */
+	usec_t expires;
+} dns_cache_entry_t;
+
+/** Cache lookup key */
+typedef struct {
+	const char *name;
+	dns_qtype_t qtype;
+} dns_cache_key_t;
+
+static FIBRIL_MUTEX_INITIALIZE(dns_cache_lock);
+/** Signalled when a pending query is resolved */
+static FIBRIL_CONDVAR_INITIALIZE(dns_cache_cv);
+/** Cache entries, of dns_cache_entry_t */
+static hash_table_t dns_cache_table;
+/** Cached answers, least recently used first */
+static LIST_INITIALIZE(dns_cache_lru);
+/** Number of answers in dns_cache_lru */
+static size_t dns_cache_count;
+/** Statistics */
+static dnsr_cache_stats_t dns_cache_stats = {
+	.max_entries = DNS_CACHE_DEFAULT_SIZE
+};
+
+static size_t dns_cache_key_hash_name(const char *name, dns_qtype_t qtype)
+{
+	size_t hash = qtype;
+
+	/* Domain names are case-insensitive */
+	while (*name != '\0') {
+		hash = hash_combine(hash, tolower((unsigned char) *name));
+		++name;
+	}
+
+	return hash;
+}
+
+static size_t dns_cache_ht_hash(const ht_link_t *item)
+{
+	dns_cache_entry_t *entry = hash_table_get_inst(item, dns_cache_entry_t,
+	    htlink);
+
+	return dns_cache_key_hash_name(entry->name, entry->qtype);
+}
+
+static size_t dns_cache_ht_key_hash(const void *arg)
+{
+	const dns_cache_key_t *key = arg;
+
+	return dns_cache_key_hash_name(key->name, key->qtype);
+}
+
+static bool dns_cache_ht_key_equal(const void *arg, const ht_link_t *item)
+{
+	dns_cache_entry_t *entry = hash_table_get_inst(item, dns_cache_entry_t,
+	    htlink);
+	const dns_cache_key_t *key = arg;
+
+	return entry->qtype == key->qtype &&
+	    str_casecmp(entry->name, key->name) == 0;
+}
+
+static hash_table_ops_t dns_cache_ht_ops = {
+	.hash = dns_cache_ht_hash,
+	.key_hash = dns_cache_ht_key_hash,
+	.key_equal = dns_cache_ht_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static usec_t dns_cache_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+static void dns_cache_entry_delete(dns_cache_entry_t *entry)
+{
+	free(entry->info.cname);
+	free(entry->name);
+	free(entry);
+}
+
+/** Remove entry from the cache.
+ *
+ * The entry is freed once no fibril is waiting for it.
+ *
+ * @param entry Cache entry
+ */
+static void dns_cache_entry_detach(dns_cache_entry_t *entry)
+{
+	assert(fibril_mutex_is_locked(&dns_cache_lock));
+	assert(!entry->detached);
+
+	hash_table_remove_item(&dns_cache_table, &entry->htlink);
+	if (link_in_use(&entry->lru_link)) {
+		list_remove(&entry->lru_link);
+		--dns_cache_count;
+	}
+
+	entry->detached = true;
+	if (entry->refcnt == 0)
+		dns_cache_entry_delete(entry);
+}
+
+/** Evict least recently used answers until the cache fits its size limit. */
+static void dns_cache_trim(void)
+{
+	assert(fibril_mutex_is_locked(&dns_cache_lock));
+
+	while (dns_cache_count > dns_cache_stats.max_entries) {
+		dns_cache_entry_t *entry = list_get_instance(
+		    list_first(&dns_cache_lru), dns_cache_entry_t, lru_link);
+
+		dns_cache_entry_detach(entry);
+		++dns_cache_stats.evictions;
+	}
+}
+
+/** Find cache entry.
+ *
+ * Expired answers are removed from the cache and not returned.
+ *
+ * @param name  Query name
+ * @param qtype Query type
+ * @return Cache entry or @c NULL if not found
+ */
+static dns_cache_entry_t *dns_cache_find(const char *name, dns_qtype_t qtype)
+{
+	dns_cache_entry_t *entry;
+	dns_cache_key_t key;
+	ht_link_t *link;
+
+	assert(fibril_mutex_is_locked(&dns_cache_lock));
+
+	key.name = name;
+	key.qtype = qtype;
+
+	link = hash_table_find(&dns_cache_table, &key);
+	if (link == NULL)
+		return NULL;
+
+	entry = hash_table_get_inst(link, dns_cache_entry_t, htlink);
+	if (!entry->pending && dns_cache_now() >= entry->expires) {
+		dns_cache_entry_detach(entry);
+		return NULL;
+	}
+
+	return entry;
+}
+
+/** Copy result of a resolved query.
+ *
+ * @param entry Resolved cache entry
+ * @param info  Place to store host information
+ * @return Result of the query or ENOMEM
+ */
+static errno_t dns_cache_entry_result(dns_cache_entry_t *entry,
+    dns_host_info_t *info)
+{
+	assert(!entry->pending);
+
+	if (entry->rc != EOK)
+		return entry->rc;
+
+	info->cname = str_dup(entry->info.cname);
+	if (info->cname == NULL)
+		return ENOMEM;
+
+	info->addr = entry->info.addr;
+	return EOK;
+}
+
+/** Resolve query using the cache.
+ *
+ * If the answer is cached, it is returned immediately. If the same query
+ * is already being resolved, wait for its answer. Otherwise resolve
+ * the query using @a resolve and cache the answer.
+ *
+ * @param name    Query name
+ * @param qtype   Query type
+ * @param info    Place to store host information
+ * @param resolve Function to resolve the query
+ * @return EOK on success or an error code
+ */
+errno_t dns_cache_query(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info, dns_cache_resolve_t resolve)
+{
+	dns_cache_entry_t *entry;
+	uint32_t ttl;
+	errno_t rc;
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	entry = dns_cache_find(name, qtype);
+	if (entry != NULL) {
+		if (entry->pending) {
+			/* Same query is in progress, wait for it */
+			++dns_cache_stats.coalesced;
+			++entry->refcnt;
+			while (entry->pending)
+				fibril_condvar_wait(&dns_cache_cv, &dns_cache_lock);
+			--entry->refcnt;
+		} else {
+			if (entry->rc == EOK)
+				++dns_cache_stats.hits;
+			else
+				++dns_cache_stats.neg_hits;
+
+			list_remove(&entry->lru_link);
+			list_append(&entry->lru_link, &dns_cache_lru);
+		}
+
+		rc = dns_cache_entry_result(entry, info);
+		if (entry->detached && entry->refcnt == 0)
+			dns_cache_entry_delete(entry);
+
+		fibril_mutex_unlock(&dns_cache_lock);
+		return rc;
+	}
+
+	++dns_cache_stats.misses;
+
+	entry = calloc(1, sizeof(dns_cache_entry_t));
+	if (entry != NULL) {
+		entry->name = str_dup(name);
+		if (entry->name == NULL) {
+			free(entry);
+			entry = NULL;
+		}
+	}
+
+	if (entry == NULL) {
+		/* Resolve without caching */
+		fibril_mutex_unlock(&dns_cache_lock);
+		return resolve(name, qtype, info, &ttl);
+	}
+
+	entry->qtype = qtype;
+	entry->pending = true;
+	link_initialize(&entry->lru_link);
+	hash_table_insert(&dns_cache_table, &entry->htlink);
+
+	fibril_mutex_unlock(&dns_cache_lock);
+
+	ttl = 0;
+	rc = resolve(name, qtype, info, &ttl);
+
+	fibril_mutex_lock(&dns_cache_lock);
+
+	entry->rc = rc;
+	if (rc == EOK) {
+		entry->info.addr = info->addr;
+		entry->info.cname = str_dup(info->cname);
+		if (entry->info.cname == NULL) {
+			entry->rc = ENOMEM;
+			ttl = 0;
+		}
+	}
+
+	entry->pending = false;
+	fibril_condvar_broadcast(&dns_cache_cv);
+
+	if (ttl > 0 && dns_cache_stats.max_entries > 0) {
+		entry->expires = dns_cache_now() +
+		    SEC2USEC(min(ttl, (uint32_t) DNS_CACHE_MAX_TTL));
+		list_append(&entry->lru_link, &dns_cache_lru);
+		++dns_cache_count;
+		dns_cache_trim();
+	} else {
+		dns_cache_entry_detach(entry);
+	}
+
+	fibril_mutex_unlock(&dns_cache_lock);
+	return rc;
+}
+
+/** Set maximum number of cached answers.
+ *
+ * @param size Maximum number of answers, zero disables caching
+ */
+void dns_cache_set_size(size_t size)
+{
+	fibril_mutex_lock(&dns_cache_lock);
+	dns_cache_stats.max_entries = size;
+	dns_cache_trim();
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** Get cache statistics.
+ *
+ * @param stats Place to store statistics
+ */
+void dns_cache_get_stats(dnsr_cache_stats_t *stats)
+{
+	fibril_mutex_lock(&dns_cache_lock);
+	*stats = dns_cache_stats;
+	stats->entries = dns_cache_count;
+	fibril_mutex_unlock(&dns_cache_lock);
+}
+
+/** Initialize resolver cache.
+ *
+ * @return EOK on success or ENOMEM
+ */
+errno_t dns_cache_init(void)
+{
+	if (!hash_table_create(&dns_cache_table, 0, 0, &dns_cache_ht_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
+/** @}
+ */
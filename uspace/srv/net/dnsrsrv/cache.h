@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup dnsrsrv
+ * @{
+ */
+/**
+ * @file
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <types/dnsr.h>
+#include "dns_std.h"
+#include "dns_type.h"
+
+/** Resolve query that is not in the cache.
+ *
+ * Stores the time for which the result may be cached (in seconds, zero
+ * if it must not be cached) to the last argument.
+ */
+typedef errno_t (*dns_cache_resolve_t)(const char *, dns_qtype_t,
+    dns_host_info_t *, uint32_t *);
+
+extern errno_t dns_cache_init(void);
+extern errno_t dns_cache_query(const char *, dns_qtype_t, dns_host_info_t *,
+    dns_cache_resolve_t);
+extern void dns_cache_set_size(size_t);
+extern void dns_cache_get_stats(dnsr_cache_stats_t *);
+
+#endif
+
+/** @}
+ */
@@ -45,6 +45,7 @@
 #include <str.h>
 #include <task.h>
 
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "query.h"
@@ -59,6 +60,12 @@ static errno_t dnsr_init(void)
 	errno_t rc;
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_init()");
 
+	rc = dns_cache_init();
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed initializing cache.");
+		return rc;
+	}
+
 	rc = transport_init();
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed initializing transport.");
@@ -206,6 +213,43 @@ static void dnsr_set_srvaddr_srv(dnsr_client_t *client, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+static void dnsr_get_cache_stats_srv(dnsr_client_t *client,
+    ipc_call_t *icall)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_get_cache_stats_srv()");
+
+	ipc_call_t call;
+	size_t size;
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size != sizeof(dnsr_cache_stats_t)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	dnsr_cache_stats_t stats;
+	dns_cache_get_stats(&stats);
+
+	errno_t rc = async_data_read_finalize(&call, &stats, size);
+	if (rc != EOK)
+		async_answer_0(&call, rc);
+
+	async_answer_0(icall, rc);
+}
+
+static void dnsr_set_cache_size_srv(dnsr_client_t *client, ipc_call_t *icall)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dnsr_set_cache_size_srv()");
+
+	dns_cache_set_size(ipc_get_arg1(icall));
+	async_answer_0(icall, EOK);
+}
+
 static void dnsr_client_conn(ipc_call_t *icall, void *arg)
 {
 	dnsr_client_t client;
@@ -236,6 +280,12 @@ static void dnsr_client_conn(ipc_call_t *icall, void *arg)
 		case DNSR_SET_SRVADDR:
 			dnsr_set_srvaddr_srv(&client, &call);
 			break;
+		case DNSR_GET_CACHE_STATS:
+			dnsr_get_cache_stats_srv(&client, &call);
+			break;
+		case DNSR_SET_CACHE_SIZE:
+			dnsr_set_cache_size_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
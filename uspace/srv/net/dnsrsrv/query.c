@@ -35,9 +35,11 @@
 
 #include <errno.h>
 #include <io/log.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 #include <str.h>
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "dns_type.h"
@@ -46,9 +48,51 @@
 
 static uint16_t msg_id;
 
+/** Determine how long a negative answer may be cached.
+ *
+ * Per RFC 2308 this is the lesser of the TTL of the SOA record
+ * in the authority section and its MINIMUM field. Without a SOA
+ * record the answer is not cached.
+ *
+ * @param amsg Answer message
+ * @return Time in seconds
+ */
+static uint32_t dns_negative_ttl(dns_message_t *amsg)
+{
+	if (amsg->rcode != RC_OK && amsg->rcode != RC_NAME_ERR)
+		return 0;
+
+	list_foreach(amsg->authority, msg, dns_rr_t, rr) {
+		if (rr->rtype != DTYPE_SOA || rr->rclass != DC_IN)
+			continue;
+
+		/* MINIMUM is the last field of SOA RDATA */
+		if (rr->rdata_size < 5 * sizeof(uint32_t))
+			continue;
+
+		return min(rr->ttl, dns_uint32_t_decode((uint8_t *) rr->rdata +
+		    rr->rdata_size - sizeof(uint32_t), sizeof(uint32_t)));
+	}
+
+	return 0;
+}
+
+/** Query name server.
+ *
+ * @param name  Host name
+ * @param qtype Query type
+ * @param info  Place to store host information
+ * @param rttl  Place to store time in seconds for which the result may
+ *              be cached
+ * @return EOK on success, EIO if the name was not resolved or an error code
+ */
 static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
-    dns_host_info_t *info)
+    dns_host_info_t *info, uint32_t *rttl)
 {
+	uint32_t ttl = UINT32_MAX;
+
+	*rttl = 0;
+
 	/* Start with the caller-provided name */
 	char *sname = str_dup(name);
 	if (sname == NULL)
@@ -129,6 +173,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			/* Continue looking for the more canonical name */
 			free(sname);
 			sname = cname;
+			ttl = min(ttl, rr->ttl);
 		}
 
 		if ((qtype == DTYPE_A) && (rr->rtype == DTYPE_A) &&
@@ -146,6 +191,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 			inet_addr_set(dns_uint32_t_decode(rr->rdata, rr->rdata_size),
 			    &info->addr);
+			*rttl = min(ttl, rr->ttl);
 
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
@@ -171,6 +217,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 			dns_addr128_t_decode(rr->rdata, rr->rdata_size, addr);
 
 			inet_addr_set6(addr, &info->addr);
+			*rttl = min(ttl, rr->ttl);
 
 			dns_message_destroy(msg);
 			dns_message_destroy(amsg);
@@ -181,6 +228,7 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 	}
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "'%s' not resolved, fail", sname);
+	*rttl = dns_negative_ttl(amsg);
 
 	dns_message_destroy(msg);
 	dns_message_destroy(amsg);
@@ -199,17 +247,17 @@ errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
 
 	switch (ver) {
 	case ip_any:
-		rc = dns_name_query(name, DTYPE_AAAA, info);
+		rc = dns_cache_query(name, DTYPE_AAAA, info, dns_name_query);
 
 		if (rc != EOK)
-			rc = dns_name_query(name, DTYPE_A, info);
+			rc = dns_cache_query(name, DTYPE_A, info, dns_name_query);
 
 		break;
 	case ip_v4:
-		rc = dns_name_query(name, DTYPE_A, info);
+		rc = dns_cache_query(name, DTYPE_A, info, dns_name_query);
 		break;
 	case ip_v6:
-		rc = dns_name_query(name, DTYPE_AAAA, info);
+		rc = dns_cache_query(name, DTYPE_AAAA, info, dns_name_query);
 		break;
 	default:
 		rc = EINVAL;
@@ -39,6 +39,7 @@
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <io/log.h>
+#include <mem.h>
 #include <stdlib.h>
 #include "arp.h"
 #include "atrans.h"
@@ -47,9 +48,6 @@
 #include "pdu.h"
 #include "std.h"
 
-/** Time to wait for ARP reply in microseconds */
-#define ARP_REQUEST_TIMEOUT (3 * 1000 * 1000)
-
 static errno_t arp_send_packet(ethip_nic_t *nic, arp_eth_packet_t *packet);
 
 void arp_received(ethip_nic_t *nic, eth_frame_t *frame)
@@ -94,19 +92,15 @@ void arp_received(ethip_nic_t *nic, eth_frame_t *frame)
 	}
 }
 
-errno_t arp_translate(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
-    eth_addr_t *mac_addr)
+/** Send ARP request.
+ *
+ * @param nic      NIC
+ * @param src_addr Source IP address
+ * @param ip_addr  IP address to resolve
+ * @return EOK on success or an error code
+ */
+errno_t arp_request(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr)
 {
-	/* Broadcast address */
-	if (ip_addr == addr32_broadcast_all_hosts) {
-		*mac_addr = eth_addr_broadcast;
-		return EOK;
-	}
-
-	errno_t rc = atrans_lookup(ip_addr, mac_addr);
-	if (rc == EOK)
-		return EOK;
-
 	arp_eth_packet_t packet;
 
 	packet.opcode = aop_request;
@@ -115,11 +109,39 @@ errno_t arp_translate(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
 	packet.target_hw_addr = eth_addr_broadcast;
 	packet.target_proto_addr = ip_addr;
 
-	rc = arp_send_packet(nic, &packet);
-	if (rc != EOK)
-		return rc;
+	return arp_send_packet(nic, &packet);
+}
 
-	return atrans_lookup_timeout(ip_addr, ARP_REQUEST_TIMEOUT, mac_addr);
+/** Fill in destination MAC address of a frame.
+ *
+ * If the address is not known yet, the frame is queued until ARP
+ * resolves it (or gives up).
+ *
+ * @param nic      NIC
+ * @param src_addr Source IP address
+ * @param ip_addr  Destination IP address
+ * @param frame    Frame
+ *
+ * @return EOK if the destination was filled in, EAGAIN if the frame
+ *         was queued, ENOMEM if out of memory
+ */
+errno_t arp_translate(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
+    eth_frame_t *frame)
+{
+	bool solicit;
+	errno_t rc;
+
+	/* Broadcast address */
+	if (ip_addr == addr32_broadcast_all_hosts) {
+		frame->dest = eth_addr_broadcast;
+		return EOK;
+	}
+
+	rc = atrans_resolve(nic, src_addr, ip_addr, frame, &solicit);
+	if (solicit)
+		(void) arp_request(nic, src_addr, ip_addr);
+
+	return rc;
 }
 
 static errno_t arp_send_packet(ethip_nic_t *nic, arp_eth_packet_t *packet)
@@ -143,6 +165,7 @@ static errno_t arp_send_packet(ethip_nic_t *nic, arp_eth_packet_t *packet)
 	frame.etype_len = ETYPE_ARP;
 	frame.data = pdata;
 	frame.size = psize;
+	memset(&frame.offload, 0, sizeof(frame.offload));
 
 	rc = eth_pdu_encode(&frame, &fdata, &fsize);
 	if (rc != EOK) {
@@ -150,7 +173,7 @@ static errno_t arp_send_packet(ethip_nic_t *nic, arp_eth_packet_t *packet)
 		return rc;
 	}
 
-	rc = ethip_nic_send(nic, fdata, fsize);
+	rc = ethip_nic_send(nic, fdata, fsize, NULL);
 	free(fdata);
 	free(pdata);
 
@@ -34,132 +34,446 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <io/log.h>
+#include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
+#include "arp.h"
 #include "atrans.h"
 #include "ethip.h"
+#include "ethip_nic.h"
+#include "pdu.h"
 
-/** Address translation list (of ethip_atrans_t) */
-static FIBRIL_MUTEX_INITIALIZE(atrans_list_lock);
-static LIST_INITIALIZE(atrans_list);
-static FIBRIL_CONDVAR_INITIALIZE(atrans_cv);
+/** How long a confirmed entry stays reachable (microseconds) */
+#define ATRANS_REACHABLE_TIME (30 * 1000 * 1000)
+/** How long an unused stale entry is kept (microseconds) */
+#define ATRANS_STALE_TIME (60 * 1000 * 1000)
+/** Interval between ARP requests while resolving (microseconds) */
+#define ATRANS_RETRANS_TIME (1000 * 1000)
+/** Number of ARP requests sent before giving up */
+#define ATRANS_MAX_PROBES 3
+/** Maximum number of frames queued per unresolved entry */
+#define ATRANS_MAX_PENDING 3
 
-static ethip_atrans_t *atrans_find(addr32_t ip_addr)
+/** Frame waiting for address resolution */
+typedef struct {
+	/** Link to ethip_atrans_t.pending */
+	link_t lpending;
+	/** NIC to send the frame through */
+	ethip_nic_t *nic;
+	/** Frame, destination address not filled in yet */
+	eth_frame_t frame;
+} ethip_atrans_pkt_t;
+
+/** ARP request to send after the translation table is unlocked */
+typedef struct {
+	link_t lsolicit;
+	ethip_nic_t *nic;
+	addr32_t src_addr;
+	addr32_t ip_addr;
+} ethip_atrans_solicit_t;
+
+/** Address translation table (of ethip_atrans_t) */
+static FIBRIL_MUTEX_INITIALIZE(atrans_lock);
+static hash_table_t atrans_table;
+/** Ages entries and retransmits ARP requests */
+static fibril_timer_t *atrans_timer;
+
+static size_t atrans_ht_hash(const ht_link_t *item)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    lentries);
+
+	return hash_mix32(atrans->ip_addr);
+}
+
+static size_t atrans_ht_key_hash(const void *key)
 {
-	list_foreach(atrans_list, atrans_list, ethip_atrans_t, atrans) {
-		if (atrans->ip_addr == ip_addr)
-			return atrans;
+	return hash_mix32(*(const addr32_t *) key);
+}
+
+static bool atrans_ht_key_equal(const void *key, const ht_link_t *item)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    lentries);
+
+	return atrans->ip_addr == *(const addr32_t *) key;
+}
+
+static void atrans_ht_remove(ht_link_t *item)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    lentries);
+
+	while (!list_empty(&atrans->pending)) {
+		ethip_atrans_pkt_t *pkt = list_get_instance(
+		    list_first(&atrans->pending), ethip_atrans_pkt_t, lpending);
+
+		list_remove(&pkt->lpending);
+		free(pkt->frame.data);
+		free(pkt);
 	}
 
-	return NULL;
+	free(atrans);
 }
 
-errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
+static hash_table_ops_t atrans_ht_ops = {
+	.hash = atrans_ht_hash,
+	.key_hash = atrans_ht_key_hash,
+	.key_equal = atrans_ht_key_equal,
+	.equal = NULL,
+	.remove_callback = atrans_ht_remove
+};
+
+static usec_t atrans_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+static ethip_atrans_t *atrans_find(addr32_t ip_addr)
+{
+	ht_link_t *link;
+
+	link = hash_table_find(&atrans_table, &ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, ethip_atrans_t, lentries);
+}
+
+/** Create translation table entry.
+ *
+ * @param ip_addr IP address
+ * @return New entry or @c NULL if out of memory
+ */
+static ethip_atrans_t *atrans_create(addr32_t ip_addr)
 {
 	ethip_atrans_t *atrans;
-	ethip_atrans_t *prev;
 
 	atrans = calloc(1, sizeof(ethip_atrans_t));
 	if (atrans == NULL)
-		return ENOMEM;
+		return NULL;
 
 	atrans->ip_addr = ip_addr;
-	atrans->mac_addr = *mac_addr;
+	list_initialize(&atrans->pending);
+	hash_table_insert(&atrans_table, &atrans->lentries);
+	return atrans;
+}
+
+/** Send frame through NIC.
+ *
+ * @param nic   NIC
+ * @param frame Frame
+ * @return EOK on success or an error code
+ */
+static errno_t atrans_frame_send(ethip_nic_t *nic, eth_frame_t *frame)
+{
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	rc = eth_pdu_encode(frame, &data, &size);
+	if (rc != EOK)
+		return rc;
+
+	rc = ethip_nic_send(nic, data, size, &frame->offload);
+	free(data);
+	return rc;
+}
+
+/** Queue ARP request to send once the translation table is unlocked.
+ *
+ * @param solicit List of ethip_atrans_solicit_t
+ * @param atrans  Entry being resolved
+ */
+static void atrans_solicit_queue(list_t *solicit, ethip_atrans_t *atrans)
+{
+	ethip_atrans_solicit_t *req;
+
+	req = calloc(1, sizeof(ethip_atrans_solicit_t));
+	if (req == NULL)
+		return;
+
+	req->nic = atrans->nic;
+	req->src_addr = atrans->src_addr;
+	req->ip_addr = atrans->ip_addr;
+	list_append(&req->lsolicit, solicit);
+}
+
+/** Age one translation table entry.
+ *
+ * @param item Entry
+ * @param arg  List of ethip_atrans_solicit_t to append ARP requests to
+ * @return @c true to continue with the next entry
+ */
+static bool atrans_age(ht_link_t *item, void *arg)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    lentries);
+	list_t *solicit = (list_t *) arg;
+	usec_t now = atrans_now();
+
+	switch (atrans->state) {
+	case as_incomplete:
+	case as_probe:
+		if (now - atrans->changed < ATRANS_RETRANS_TIME)
+			break;
+
+		if (atrans->probes >= ATRANS_MAX_PROBES) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "ARP resolution of "
+			    "0x%" PRIx32 " failed", atrans->ip_addr);
+			hash_table_remove_item(&atrans_table, item);
+			break;
+		}
+
+		++atrans->probes;
+		atrans->changed = now;
+		atrans_solicit_queue(solicit, atrans);
+		break;
+	case as_reachable:
+		if (now - atrans->changed >= ATRANS_REACHABLE_TIME) {
+			atrans->state = as_stale;
+			atrans->changed = now;
+		}
+		break;
+	case as_stale:
+		if (now - atrans->changed >= ATRANS_STALE_TIME)
+			hash_table_remove_item(&atrans_table, item);
+		break;
+	}
+
+	return true;
+}
+
+/** Translation table timer handler.
+ *
+ * @param arg Not used
+ */
+static void atrans_timer_handler(void *arg)
+{
+	list_t solicit;
+
+	list_initialize(&solicit);
+
+	fibril_mutex_lock(&atrans_lock);
+	hash_table_apply(&atrans_table, atrans_age, &solicit);
+	fibril_mutex_unlock(&atrans_lock);
 
-	fibril_mutex_lock(&atrans_list_lock);
-	prev = atrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->atrans_list);
-		free(prev);
+	while (!list_empty(&solicit)) {
+		ethip_atrans_solicit_t *req = list_get_instance(
+		    list_first(&solicit), ethip_atrans_solicit_t, lsolicit);
+
+		list_remove(&req->lsolicit);
+		(void) arp_request(req->nic, req->src_addr, req->ip_addr);
+		free(req);
 	}
 
-	list_append(&atrans->atrans_list, &atrans_list);
-	fibril_mutex_unlock(&atrans_list_lock);
-	fibril_condvar_broadcast(&atrans_cv);
+	fibril_timer_set(atrans_timer, ATRANS_RETRANS_TIME,
+	    atrans_timer_handler, NULL);
+}
+
+/** Initialize address translation table.
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t atrans_init(void)
+{
+	if (!hash_table_create(&atrans_table, 0, 0, &atrans_ht_ops))
+		return ENOMEM;
+
+	atrans_timer = fibril_timer_create(NULL);
+	if (atrans_timer == NULL) {
+		hash_table_destroy(&atrans_table);
+		return ENOMEM;
+	}
 
+	fibril_timer_set(atrans_timer, ATRANS_RETRANS_TIME,
+	    atrans_timer_handler, NULL);
 	return EOK;
 }
 
-errno_t atrans_remove(addr32_t ip_addr)
+/** Add or confirm translation.
+ *
+ * The entry becomes reachable and frames waiting for the translation
+ * are sent.
+ *
+ * @param ip_addr  IP address
+ * @param mac_addr MAC address
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t atrans_add(addr32_t ip_addr, eth_addr_t *mac_addr)
 {
 	ethip_atrans_t *atrans;
+	list_t pending;
+
+	list_initialize(&pending);
 
-	fibril_mutex_lock(&atrans_list_lock);
+	fibril_mutex_lock(&atrans_lock);
 	atrans = atrans_find(ip_addr);
 	if (atrans == NULL) {
-		fibril_mutex_unlock(&atrans_list_lock);
-		return ENOENT;
+		atrans = atrans_create(ip_addr);
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_lock);
+			return ENOMEM;
+		}
 	}
 
-	list_remove(&atrans->atrans_list);
-	fibril_mutex_unlock(&atrans_list_lock);
-	free(atrans);
+	atrans->mac_addr = *mac_addr;
+	atrans->state = as_reachable;
+	atrans->changed = atrans_now();
+	atrans->probes = 0;
+	list_concat(&pending, &atrans->pending);
+	atrans->npending = 0;
+	fibril_mutex_unlock(&atrans_lock);
+
+	while (!list_empty(&pending)) {
+		ethip_atrans_pkt_t *pkt = list_get_instance(
+		    list_first(&pending), ethip_atrans_pkt_t, lpending);
+
+		list_remove(&pkt->lpending);
+		pkt->frame.dest = *mac_addr;
+		(void) atrans_frame_send(pkt->nic, &pkt->frame);
+		free(pkt->frame.data);
+		free(pkt);
+	}
 
 	return EOK;
 }
 
-static errno_t atrans_lookup_locked(addr32_t ip_addr, eth_addr_t *mac_addr)
+errno_t atrans_remove(addr32_t ip_addr)
 {
-	ethip_atrans_t *atrans = atrans_find(ip_addr);
-	if (atrans == NULL)
+	ethip_atrans_t *atrans;
+
+	fibril_mutex_lock(&atrans_lock);
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL) {
+		fibril_mutex_unlock(&atrans_lock);
 		return ENOENT;
+	}
+
+	hash_table_remove_item(&atrans_table, &atrans->lentries);
+	fibril_mutex_unlock(&atrans_lock);
 
-	*mac_addr = atrans->mac_addr;
 	return EOK;
 }
 
 errno_t atrans_lookup(addr32_t ip_addr, eth_addr_t *mac_addr)
 {
-	errno_t rc;
+	ethip_atrans_t *atrans;
 
-	fibril_mutex_lock(&atrans_list_lock);
-	rc = atrans_lookup_locked(ip_addr, mac_addr);
-	fibril_mutex_unlock(&atrans_list_lock);
+	fibril_mutex_lock(&atrans_lock);
+	atrans = atrans_find(ip_addr);
+	if (atrans == NULL || atrans->state == as_incomplete) {
+		fibril_mutex_unlock(&atrans_lock);
+		return ENOENT;
+	}
 
-	return rc;
+	*mac_addr = atrans->mac_addr;
+	fibril_mutex_unlock(&atrans_lock);
+	return EOK;
 }
 
-static void atrans_lookup_timeout_handler(void *arg)
+/** Resolve destination of a frame.
+ *
+ * If the translation is known, fills in the destination address of
+ * @a frame. Otherwise a copy of @a frame is queued and sent once the
+ * translation becomes known.
+ *
+ * @param nic      NIC the frame is to be sent through
+ * @param src_addr Source IP address for ARP requests
+ * @param ip_addr  Destination IP address
+ * @param frame    Frame
+ * @param rsolicit Place to store @c true if the caller should send
+ *                 an ARP request for @a ip_addr
+ *
+ * @return EOK if the destination address was filled in, EAGAIN if
+ *         the frame was queued, ENOMEM if out of memory
+ */
+errno_t atrans_resolve(ethip_nic_t *nic, addr32_t src_addr, addr32_t ip_addr,
+    eth_frame_t *frame, bool *rsolicit)
 {
-	bool *timedout = (bool *)arg;
+	ethip_atrans_t *atrans;
+	ethip_atrans_pkt_t *pkt;
 
-	fibril_mutex_lock(&atrans_list_lock);
-	*timedout = true;
-	fibril_mutex_unlock(&atrans_list_lock);
-	fibril_condvar_broadcast(&atrans_cv);
-}
+	*rsolicit = false;
 
-errno_t atrans_lookup_timeout(addr32_t ip_addr, usec_t timeout,
-    eth_addr_t *mac_addr)
-{
-	fibril_timer_t *t;
-	bool timedout;
-	errno_t rc;
+	fibril_mutex_lock(&atrans_lock);
+	atrans = atrans_find(ip_addr);
+	if (atrans != NULL && atrans->state != as_incomplete) {
+		if (atrans->state == as_stale) {
+			/* Re-confirm, keep using the entry meanwhile */
+			atrans->state = as_probe;
+			atrans->changed = atrans_now();
+			atrans->probes = 1;
+			atrans->nic = nic;
+			atrans->src_addr = src_addr;
+			*rsolicit = true;
+		}
+
+		frame->dest = atrans->mac_addr;
+		fibril_mutex_unlock(&atrans_lock);
+		return EOK;
+	}
+
+	if (atrans == NULL) {
+		atrans = atrans_create(ip_addr);
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_lock);
+			return ENOMEM;
+		}
 
-	t = fibril_timer_create(NULL);
-	if (t == NULL)
+		atrans->state = as_incomplete;
+		atrans->changed = atrans_now();
+		atrans->probes = 1;
+		atrans->nic = nic;
+		atrans->src_addr = src_addr;
+		*rsolicit = true;
+	}
+
+	pkt = calloc(1, sizeof(ethip_atrans_pkt_t));
+	if (pkt == NULL) {
+		fibril_mutex_unlock(&atrans_lock);
 		return ENOMEM;
+	}
 
-	timedout = false;
-	fibril_timer_set(t, timeout, atrans_lookup_timeout_handler, &timedout);
+	pkt->frame = *frame;
+	pkt->frame.data = malloc(frame->size);
+	if (pkt->frame.data == NULL) {
+		free(pkt);
+		fibril_mutex_unlock(&atrans_lock);
+		return ENOMEM;
+	}
+
+	memcpy(pkt->frame.data, frame->data, frame->size);
+	pkt->nic = nic;
 
-	fibril_mutex_lock(&atrans_list_lock);
+	/* Drop the oldest frame if too many are waiting */
+	if (atrans->npending >= ATRANS_MAX_PENDING) {
+		ethip_atrans_pkt_t *old = list_get_instance(
+		    list_first(&atrans->pending), ethip_atrans_pkt_t, lpending);
 
-	while ((rc = atrans_lookup_locked(ip_addr, mac_addr)) == ENOENT &&
-	    !timedout) {
-		fibril_condvar_wait(&atrans_cv, &atrans_list_lock);
+		list_remove(&old->lpending);
+		free(old->frame.data);
+		free(old);
+		--atrans->npending;
 	}
 
-	fibril_mutex_unlock(&atrans_list_lock);
-	(void) fibril_timer_clear(t);
-	fibril_timer_destroy(t);
+	list_append(&pkt->lpending, &atrans->pending);
+	++atrans->npending;
+	fibril_mutex_unlock(&atrans_lock);
 
-	return rc;
+	return EAGAIN;
 }
 
 /** @}
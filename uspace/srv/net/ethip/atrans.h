@@ -38,14 +38,17 @@
 #define ATRANS_H_
 
 #include <inet/addr.h>
+#include <stdbool.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 #include "ethip.h"
 
+extern errno_t atrans_init(void);
 extern errno_t atrans_add(addr32_t, eth_addr_t *);
 extern errno_t atrans_remove(addr32_t);
 extern errno_t atrans_lookup(addr32_t, eth_addr_t *);
-extern errno_t atrans_lookup_timeout(addr32_t, usec_t, eth_addr_t *);
+extern errno_t atrans_resolve(ethip_nic_t *, addr32_t, addr32_t,
+    eth_frame_t *, bool *);
 
 #endif
 
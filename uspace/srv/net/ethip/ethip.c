@@ -42,10 +42,12 @@
 #include <inet/iplink_srv.h>
 #include <io/log.h>
 #include <loc.h>
+#include <mem.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <task.h>
 #include "arp.h"
+#include "atrans.h"
 #include "ethip.h"
 #include "ethip_nic.h"
 #include "pdu.h"
@@ -58,6 +60,7 @@ static errno_t ethip_close(iplink_srv_t *srv);
 static errno_t ethip_send(iplink_srv_t *srv, iplink_sdu_t *sdu);
 static errno_t ethip_send6(iplink_srv_t *srv, iplink_sdu6_t *sdu);
 static errno_t ethip_get_mtu(iplink_srv_t *srv, size_t *mtu);
+static errno_t ethip_get_offload(iplink_srv_t *srv, uint32_t *offload);
 static errno_t ethip_get_mac48(iplink_srv_t *srv, eth_addr_t *mac);
 static errno_t ethip_set_mac48(iplink_srv_t *srv, eth_addr_t *mac);
 static errno_t ethip_addr_add(iplink_srv_t *srv, inet_addr_t *addr);
@@ -74,14 +77,22 @@ static iplink_ops_t ethip_iplink_ops = {
 	.get_mac48 = ethip_get_mac48,
 	.set_mac48 = ethip_set_mac48,
 	.addr_add = ethip_addr_add,
-	.addr_remove = ethip_addr_remove
+	.addr_remove = ethip_addr_remove,
+	.get_offload = ethip_get_offload
 };
 
 static errno_t ethip_init(void)
 {
 	async_set_fallback_port_handler(ethip_client_conn, NULL);
 
-	errno_t rc = loc_server_register(NAME);
+	errno_t rc = atrans_init();
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed initializing address "
+		    "translation table.");
+		return rc;
+	}
+
+	rc = loc_server_register(NAME);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed registering server.");
 		return rc;
@@ -177,25 +188,42 @@ static errno_t ethip_send(iplink_srv_t *srv, iplink_sdu_t *sdu)
 	ethip_nic_t *nic = (ethip_nic_t *) srv->arg;
 	eth_frame_t frame;
 
-	errno_t rc = arp_translate(nic, sdu->src, sdu->dest, &frame.dest);
+	frame.src = nic->mac_addr;
+	frame.etype_len = ETYPE_IP;
+	frame.data = sdu->data;
+	frame.size = sdu->size;
+
+	memset(&frame.offload, 0, sizeof(frame.offload));
+	if ((sdu->offload & IPLINK_OFFLOAD_TX_CSUM) != 0)
+		frame.offload.flags |= NIC_OFFLOAD_TX_CSUM;
+	if ((sdu->offload & IPLINK_OFFLOAD_TSO) != 0)
+		frame.offload.flags |= NIC_OFFLOAD_TSO;
+	if (frame.offload.flags != 0) {
+		frame.offload.csum_start = sizeof(eth_header_t) +
+		    sdu->csum_start;
+		frame.offload.csum_offs = sdu->csum_offs;
+		frame.offload.mss = sdu->mss;
+	}
+
+	errno_t rc = arp_translate(nic, sdu->src, sdu->dest, &frame);
+	if (rc == EAGAIN) {
+		/* Queued until the address is resolved */
+		return EOK;
+	}
+
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_WARN, "Failed to look up IPv4 address 0x%"
 		    PRIx32, sdu->dest);
 		return rc;
 	}
 
-	frame.src = nic->mac_addr;
-	frame.etype_len = ETYPE_IP;
-	frame.data = sdu->data;
-	frame.size = sdu->size;
-
 	void *data;
 	size_t size;
 	rc = eth_pdu_encode(&frame, &data, &size);
 	if (rc != EOK)
 		return rc;
 
-	rc = ethip_nic_send(nic, data, size);
+	rc = ethip_nic_send(nic, data, size, &frame.offload);
 	free(data);
 
 	return rc;
@@ -213,6 +241,7 @@ static errno_t ethip_send6(iplink_srv_t *srv, iplink_sdu6_t *sdu)
 	frame.etype_len = ETYPE_IPV6;
 	frame.data = sdu->data;
 	frame.size = sdu->size;
+	memset(&frame.offload, 0, sizeof(frame.offload));
 
 	void *data;
 	size_t size;
@@ -220,13 +249,14 @@ static errno_t ethip_send6(iplink_srv_t *srv, iplink_sdu6_t *sdu)
 	if (rc != EOK)
 		return rc;
 
-	rc = ethip_nic_send(nic, data, size);
+	rc = ethip_nic_send(nic, data, size, NULL);
 	free(data);
 
 	return rc;
 }
 
-errno_t ethip_received(iplink_srv_t *srv, void *data, size_t size)
+errno_t ethip_received(iplink_srv_t *srv, void *data, size_t size,
+    uint32_t offload)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_received(): srv=%p", srv);
 	ethip_nic_t *nic = (ethip_nic_t *) srv->arg;
@@ -242,6 +272,10 @@ errno_t ethip_received(iplink_srv_t *srv, void *data, size_t size)
 
 	iplink_recv_sdu_t sdu;
 
+	sdu.offload = 0;
+	if ((offload & NIC_OFFLOAD_RX_CSUM) != 0)
+		sdu.offload |= IPLINK_OFFLOAD_RX_CSUM;
+
 	switch (frame.etype_len) {
 	case ETYPE_ARP:
 		arp_received(nic, &frame);
@@ -276,6 +310,22 @@ static errno_t ethip_get_mtu(iplink_srv_t *srv, size_t *mtu)
 	return EOK;
 }
 
+static errno_t ethip_get_offload(iplink_srv_t *srv, uint32_t *offload)
+{
+	ethip_nic_t *nic = (ethip_nic_t *) srv->arg;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_get_offload()");
+
+	*offload = 0;
+	if ((nic->offload & NIC_OFFLOAD_RX_CSUM) != 0)
+		*offload |= IPLINK_OFFLOAD_RX_CSUM;
+	if ((nic->offload & NIC_OFFLOAD_TX_CSUM) != 0)
+		*offload |= IPLINK_OFFLOAD_TX_CSUM;
+	if ((nic->offload & NIC_OFFLOAD_TSO) != 0)
+		*offload |= IPLINK_OFFLOAD_TSO;
+	return EOK;
+}
+
 static errno_t ethip_get_mac48(iplink_srv_t *srv, eth_addr_t *mac)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_get_mac48()");
@@ -37,14 +37,19 @@
 #ifndef ETHIP_H_
 #define ETHIP_H_
 
+#include <adt/hash_table.h>
+#include <adt/pkt_ring.h>
 #include <adt/list.h>
 #include <async.h>
+#include <fibril_synch.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
 #include <loc.h>
+#include <nic/nic.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 
 typedef struct {
 	link_t link;
@@ -62,6 +67,21 @@ typedef struct ethip_nic {
 
 	/** MAC address */
 	eth_addr_t mac_addr;
+	/** Offloads enabled on the NIC (NIC_OFFLOAD_*) */
+	uint32_t offload;
+
+	/** Area holding the ring of received frames, NULL if not shared */
+	void *rx_ring_area;
+	/** Ring of frames received by the NIC */
+	pkt_ring_t rx_ring;
+	/** Rung by the NIC when it publishes frames in the RX ring */
+	fibril_semaphore_t rx_ring_doorbell;
+	/** Area holding the ring of frames to send, NULL if not shared */
+	void *tx_ring_area;
+	/** Ring of frames to be sent by the NIC */
+	pkt_ring_t tx_ring;
+	/** Serializes producers of the TX ring */
+	fibril_mutex_t tx_ring_lock;
 
 	/**
 	 * List of IP addresses configured on this link
@@ -82,6 +102,8 @@ typedef struct {
 	void *data;
 	/** Payload size */
 	size_t size;
+	/** Offload computations requested when sending the frame */
+	nic_tx_offload_t offload;
 } eth_frame_t;
 
 /** ARP opcode */
@@ -109,15 +131,39 @@ typedef struct {
 	addr32_t target_proto_addr;
 } arp_eth_packet_t;
 
+/** Address translation entry state */
+typedef enum {
+	/** Resolution in progress, no address known yet */
+	as_incomplete,
+	/** Address confirmed recently */
+	as_reachable,
+	/** Address not confirmed recently, confirmed when next used */
+	as_stale,
+	/** Stale address in use, being confirmed */
+	as_probe
+} ethip_atrans_state_t;
+
 /** Address translation table element */
 typedef struct {
-	link_t atrans_list;
+	/** Link to translation table */
+	ht_link_t lentries;
 	addr32_t ip_addr;
 	eth_addr_t mac_addr;
+	ethip_atrans_state_t state;
+	/** Uptime of the last state change or ARP request in microseconds */
+	usec_t changed;
+	/** Number of ARP requests sent in the current resolution */
+	unsigned probes;
+	/** NIC and source address to send ARP requests with */
+	ethip_nic_t *nic;
+	addr32_t src_addr;
+	/** Frames waiting for the resolution (of ethip_atrans_pkt_t) */
+	list_t pending;
+	size_t npending;
 } ethip_atrans_t;
 
 extern errno_t ethip_iplink_init(ethip_nic_t *);
-extern errno_t ethip_received(iplink_srv_t *, void *, size_t);
+extern errno_t ethip_received(iplink_srv_t *, void *, size_t, uint32_t);
 
 #endif
 
@@ -35,11 +35,15 @@
  */
 
 #include <adt/list.h>
+#include <adt/pkt_ring.h>
+#include <as.h>
 #include <async.h>
 #include <errno.h>
+#include <fibril.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <inttypes.h>
 #include <io/log.h>
 #include <loc.h>
 #include <mem.h>
@@ -115,6 +119,8 @@ static ethip_nic_t *ethip_nic_new(void)
 
 	link_initialize(&nic->link);
 	list_initialize(&nic->addr_list);
+	fibril_semaphore_initialize(&nic->rx_ring_doorbell, 0);
+	fibril_mutex_initialize(&nic->tx_ring_lock);
 
 	return nic;
 }
@@ -147,6 +153,132 @@ static void ethip_link_addr_delete(ethip_link_addr_t *laddr)
 	free(laddr);
 }
 
+/** Enable the checksum and segmentation offloads the NIC supports.
+ *
+ * NICs without offload support are used with software checksums.
+ *
+ * @param nic NIC
+ */
+static void ethip_nic_offload_setup(ethip_nic_t *nic)
+{
+	uint32_t supported;
+	uint32_t active;
+	errno_t rc;
+
+	nic->offload = 0;
+
+	rc = nic_offload_probe(nic->sess, &supported, &active);
+	if (rc != EOK)
+		return;
+
+	supported &= NIC_OFFLOAD_RX_CSUM | NIC_OFFLOAD_TX_CSUM |
+	    NIC_OFFLOAD_TSO;
+	if (supported == 0)
+		return;
+
+	rc = nic_offload_set(nic->sess, supported, supported);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_WARN, "Failed enabling offloads "
+		    "on '%s'.", nic->svc_name);
+		return;
+	}
+
+	nic->offload = supported;
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Offloads enabled on '%s': 0x%"
+	    PRIx32, nic->svc_name, supported);
+}
+
+/** Fibril passing frames from the RX ring to the IP link.
+ *
+ * Drains all frames published by the NIC, then waits for the doorbell.
+ *
+ * @param arg NIC
+ * @return Never returns
+ */
+static errno_t ethip_nic_rx_ring_fibril(void *arg)
+{
+	ethip_nic_t *nic = (ethip_nic_t *) arg;
+	pkt_ring_desc_t desc;
+	void *data;
+
+	while (true) {
+		while ((data = pkt_ring_cons_peek(&nic->rx_ring, &desc)) != NULL) {
+			(void) ethip_received(&nic->iplink, data, desc.size,
+			    desc.flags);
+			pkt_ring_cons_next(&nic->rx_ring);
+		}
+
+		pkt_ring_cons_publish(&nic->rx_ring);
+
+		if (pkt_ring_cons_wait(&nic->rx_ring))
+			fibril_semaphore_down(&nic->rx_ring_doorbell);
+	}
+
+	return EOK;
+}
+
+/** Create a packet ring and share it with the NIC.
+ *
+ * @param nic  NIC
+ * @param dir  Direction of the ring
+ * @param ring Place to store the ring view
+ * @return Ring area or @c NULL if the ring could not be shared
+ */
+static void *ethip_nic_ring_create(ethip_nic_t *nic, nic_ring_dir_t dir,
+    pkt_ring_t *ring)
+{
+	size_t size;
+	void *area;
+	errno_t rc;
+
+	size = pkt_ring_area_size(NIC_RING_SLOTS, NIC_RING_SLOT_SIZE);
+	area = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED)
+		return NULL;
+
+	rc = pkt_ring_create(ring, area, NIC_RING_SLOTS, NIC_RING_SLOT_SIZE);
+	if (rc == EOK)
+		rc = nic_ring_setup(nic->sess, dir, area);
+
+	if (rc != EOK) {
+		as_area_destroy(area);
+		return NULL;
+	}
+
+	return area;
+}
+
+/** Pass frames to and from the NIC through shared packet rings.
+ *
+ * NICs that do not support packet rings keep using a separate IPC
+ * call for each frame.
+ *
+ * @param nic NIC
+ */
+static void ethip_nic_ring_setup(ethip_nic_t *nic)
+{
+	fid_t fid;
+
+	fid = fibril_create(ethip_nic_rx_ring_fibril, nic);
+	if (fid == 0)
+		return;
+
+	nic->rx_ring_area = ethip_nic_ring_create(nic, NIC_RING_RX,
+	    &nic->rx_ring);
+	if (nic->rx_ring_area != NULL)
+		fibril_add_ready(fid);
+	else
+		fibril_destroy(fid);
+
+	nic->tx_ring_area = ethip_nic_ring_create(nic, NIC_RING_TX,
+	    &nic->tx_ring);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Packet rings on '%s': RX %s, TX %s",
+	    nic->svc_name, nic->rx_ring_area != NULL ? "yes" : "no",
+	    nic->tx_ring_area != NULL ? "yes" : "no");
+}
+
 static errno_t ethip_nic_open(service_id_t sid)
 {
 	bool in_list = false;
@@ -179,6 +311,10 @@ static errno_t ethip_nic_open(service_id_t sid)
 	}
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Opened NIC '%s'", nic->svc_name);
+
+	ethip_nic_offload_setup(nic);
+	ethip_nic_ring_setup(nic);
+
 	list_append(&nic->link, &ethip_nic_list);
 	in_list = true;
 
@@ -262,9 +398,12 @@ static void ethip_nic_received(ethip_nic_t *nic, ipc_call_t *call)
 	errno_t rc;
 	void *data;
 	size_t size;
+	uint32_t offload;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_received() nic=%p", nic);
 
+	offload = ipc_get_arg1(call);
+
 	rc = async_data_write_accept(&data, false, 0, 0, 0, &size);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "data_write_accept() failed");
@@ -275,7 +414,7 @@ static void ethip_nic_received(ethip_nic_t *nic, ipc_call_t *call)
 	    size);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "call ethip_received");
-	rc = ethip_received(&nic->iplink, data, size);
+	rc = ethip_received(&nic->iplink, data, size, offload);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "free data");
 	free(data);
 
@@ -283,6 +422,12 @@ static void ethip_nic_received(ethip_nic_t *nic, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void ethip_nic_ring(ethip_nic_t *nic, ipc_call_t *call)
+{
+	fibril_semaphore_up(&nic->rx_ring_doorbell);
+	async_answer_0(call, EOK);
+}
+
 static void ethip_nic_device_state(ethip_nic_t *nic, ipc_call_t *call)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_device_state()");
@@ -311,6 +456,9 @@ static void ethip_nic_cb_conn(ipc_call_t *icall, void *arg)
 		case NIC_EV_RECEIVED:
 			ethip_nic_received(nic, &call);
 			break;
+		case NIC_EV_RING:
+			ethip_nic_ring(nic, &call);
+			break;
 		case NIC_EV_DEVICE_STATE:
 			ethip_nic_device_state(nic, &call);
 			break;
@@ -350,11 +498,67 @@ ethip_nic_t *ethip_nic_find_by_iplink_sid(service_id_t iplink_sid)
 	return NULL;
 }
 
-errno_t ethip_nic_send(ethip_nic_t *nic, void *data, size_t size)
+/** Queue frame in the TX ring.
+ *
+ * @param nic     NIC
+ * @param data    Frame
+ * @param size    Frame size
+ * @param offload Offload computations or @c NULL
+ * @return @c true if the frame was queued, @c false if it has to be sent
+ *         by IPC (no ring, ring full or frame larger than a slot)
+ */
+static bool ethip_nic_ring_send(ethip_nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
+{
+	pkt_ring_desc_t desc;
+	void *slot;
+	bool doorbell;
+
+	if (nic->tx_ring_area == NULL || size > nic->tx_ring.slot_size)
+		return false;
+
+	fibril_mutex_lock(&nic->tx_ring_lock);
+
+	slot = pkt_ring_prod_slot(&nic->tx_ring);
+	if (slot == NULL) {
+		fibril_mutex_unlock(&nic->tx_ring_lock);
+		return false;
+	}
+
+	memcpy(slot, data, size);
+	desc.size = size;
+	if (offload != NULL && offload->flags != 0) {
+		desc.flags = offload->flags;
+		desc.arg1 = offload->csum_start |
+		    ((uint32_t) offload->csum_offs << 16);
+		desc.arg2 = offload->mss;
+	} else {
+		desc.flags = 0;
+		desc.arg1 = 0;
+		desc.arg2 = 0;
+	}
+
+	pkt_ring_prod_put(&nic->tx_ring, &desc);
+	doorbell = pkt_ring_prod_publish(&nic->tx_ring);
+
+	fibril_mutex_unlock(&nic->tx_ring_lock);
+
+	if (doorbell)
+		nic_ring_doorbell(nic->sess);
+	return true;
+}
+
+errno_t ethip_nic_send(ethip_nic_t *nic, void *data, size_t size,
+    const nic_tx_offload_t *offload)
 {
 	errno_t rc;
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "ethip_nic_send(size=%zu)", size);
-	rc = nic_send_frame(nic->sess, data, size);
+	if (ethip_nic_ring_send(nic, data, size, offload))
+		return EOK;
+	if (offload != NULL && offload->flags != 0)
+		rc = nic_send_frame_offload(nic->sess, data, size, offload);
+	else
+		rc = nic_send_frame(nic->sess, data, size);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "nic_send_frame -> %s", str_error_name(rc));
 	return rc;
 }
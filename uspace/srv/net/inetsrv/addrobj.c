@@ -239,7 +239,13 @@ errno_t inet_addrobj_send_dgram(inet_addrobj_t *addr, inet_addr_t *ldest,
 		/*
 		 * Translate local destination IPv6 address.
 		 */
-		rc = ndp_translate(lsrc_v6, ldest_v6, &ldest_mac, addr->ilink);
+		rc = ndp_translate(lsrc_v6, ldest_v6, &ldest_mac, addr->ilink,
+		    dgram, proto, ttl, df);
+		if (rc == EAGAIN) {
+			/* Queued until the address is resolved */
+			return EOK;
+		}
+
 		if (rc != EOK)
 			return rc;
 
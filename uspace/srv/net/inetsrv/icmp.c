@@ -108,6 +108,9 @@ static errno_t icmp_recv_echo_request(inet_dgram_t *dgram)
 	rdgram.src = dgram->dest;
 	rdgram.dest = dgram->src;
 	rdgram.tos = ICMP_TOS;
+	rdgram.csum = INET_CSUM_NONE;
+	rdgram.csum_offs = 0;
+	rdgram.tso_mss = 0;
 	rdgram.data = reply;
 	rdgram.size = size;
 
@@ -166,6 +169,9 @@ errno_t icmp_ping_send(uint16_t ident, inetping_sdu_t *sdu)
 	dgram.dest = sdu->dest;
 	dgram.iplink = 0;
 	dgram.tos = ICMP_TOS;
+	dgram.csum = INET_CSUM_NONE;
+	dgram.csum_offs = 0;
+	dgram.tso_mss = 0;
 	dgram.data = rdata;
 	dgram.size = rsize;
 
@@ -81,6 +81,9 @@ static errno_t icmpv6_recv_echo_request(inet_dgram_t *dgram)
 	rdgram.dest = dgram->src;
 	rdgram.iplink = 0;
 	rdgram.tos = 0;
+	rdgram.csum = INET_CSUM_NONE;
+	rdgram.csum_offs = 0;
+	rdgram.tso_mss = 0;
 	rdgram.data = reply;
 	rdgram.size = size;
 
@@ -179,6 +182,9 @@ errno_t icmpv6_ping_send(uint16_t ident, inetping_sdu_t *sdu)
 	dgram.dest = sdu->dest;
 	dgram.iplink = 0;
 	dgram.tos = 0;
+	dgram.csum = INET_CSUM_NONE;
+	dgram.csum_offs = 0;
+	dgram.tso_mss = 0;
 	dgram.data = rdata;
 	dgram.size = rsize;
 
@@ -34,12 +34,16 @@
  * @brief
  */
 
+#include <assert.h>
+#include <byteorder.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink.h>
 #include <io/log.h>
 #include <loc.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <str.h>
@@ -47,8 +51,21 @@
 #include "addrobj.h"
 #include "inetsrv.h"
 #include "inet_link.h"
+#include "inet_std.h"
 #include "pdu.h"
 
+/** TCP protocol number */
+#define IP_PROTO_TCP    6
+
+/** Offset of sequence number in TCP header */
+#define TCP_SEQ_OFFS    4
+/** Offset of data offset field in TCP header */
+#define TCP_DOFFS_OFFS  12
+/** Offset of flags in TCP header */
+#define TCP_FLAGS_OFFS  13
+/** TCP flags that may only be set in the last segment of a burst */
+#define TCP_FLAGS_LAST  (0x01 | 0x08)
+
 static bool first_link = true;
 static bool first_link6 = true;
 
@@ -115,6 +132,11 @@ static errno_t inet_iplink_recv(iplink_t *iplink, iplink_recv_sdu_t *sdu, ip_ver
 		return rc;
 	}
 
+	/* Only unfragmented datagrams can be verified by the link */
+	if ((sdu->offload & IPLINK_OFFLOAD_RX_CSUM) != 0 &&
+	    packet.offs == 0 && !packet.mf)
+		packet.csum_ok = true;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_iplink_recv: link_id=%zu", packet.link_id);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "call inet_recv_packet()");
 	rc = inet_recv_packet(&packet);
@@ -210,6 +232,11 @@ errno_t inet_link_open(service_id_t sid)
 	rc = iplink_get_mac48(ilink->iplink, &ilink->mac);
 	ilink->mac_valid = (rc == EOK);
 
+	/* Links that do not know about offloads support none */
+	rc = iplink_get_offload(ilink->iplink, &ilink->offload);
+	if (rc != EOK)
+		ilink->offload = 0;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Opened IP link '%s'", ilink->svc_name);
 
 	fibril_mutex_lock(&inet_links_lock);
@@ -302,6 +329,107 @@ error:
 	return rc;
 }
 
+/** Complete partial transport checksum of a datagram in software.
+ *
+ * @param dgram Datagram whose checksum field holds the pseudo-header sum
+ */
+static void inet_link_csum_complete(inet_dgram_t *dgram)
+{
+	uint16_t cs;
+
+	if (dgram->csum != INET_CSUM_PARTIAL)
+		return;
+
+	assert(dgram->csum_offs + sizeof(uint16_t) <= dgram->size);
+
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, dgram->data, dgram->size);
+	cs = host2uint16_t_be(cs);
+	memcpy((uint8_t *) dgram->data + dgram->csum_offs, &cs, sizeof(cs));
+	dgram->csum = INET_CSUM_NONE;
+}
+
+/** Split TCP datagram into segments of at most @c tso_mss bytes.
+ *
+ * Used when the link cannot segment the datagram itself. Each segment
+ * gets a copy of the TCP header with the sequence number advanced,
+ * FIN and PSH cleared on all but the last segment and the segment
+ * length added to the partial checksum.
+ *
+ * @param ilink Internet link
+ * @param lsrc  Source IPv4 address
+ * @param ldest Destination IPv4 address
+ * @param dgram Datagram with TCP header and payload
+ * @param proto Protocol
+ * @param ttl   Time-to-live
+ * @param df    Do-not-Fragment flag
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t inet_link_send_gso(inet_link_t *ilink, addr32_t lsrc,
+    addr32_t ldest, inet_dgram_t *dgram, uint8_t proto, uint8_t ttl, int df)
+{
+	uint8_t *data = dgram->data;
+	inet_dgram_t seg;
+	size_t hdr_size;
+	size_t offs;
+	uint32_t seq;
+	uint16_t cs;
+	errno_t rc;
+
+	if (proto != IP_PROTO_TCP || dgram->csum != INET_CSUM_PARTIAL ||
+	    dgram->size < TCP_FLAGS_OFFS + 1)
+		return EINVAL;
+
+	hdr_size = sizeof(uint32_t) * (data[TCP_DOFFS_OFFS] >> 4);
+	if (hdr_size > dgram->size ||
+	    dgram->csum_offs + sizeof(uint16_t) > hdr_size)
+		return EINVAL;
+
+	memcpy(&seq, data + TCP_SEQ_OFFS, sizeof(seq));
+	seq = uint32_t_be2host(seq);
+	memcpy(&cs, data + dgram->csum_offs, sizeof(cs));
+	cs = uint16_t_be2host(cs);
+
+	seg = *dgram;
+	seg.tso_mss = 0;
+	seg.data = malloc(hdr_size + dgram->tso_mss);
+	if (seg.data == NULL)
+		return ENOMEM;
+
+	offs = hdr_size;
+	rc = EOK;
+	do {
+		uint8_t *sdata = seg.data;
+		size_t xfer = min(dgram->size - offs, dgram->tso_mss);
+		bool last = offs + xfer >= dgram->size;
+		uint32_t sseq;
+		uint16_t scs;
+
+		memcpy(sdata, data, hdr_size);
+		memcpy(sdata + hdr_size, data + offs, xfer);
+		seg.size = hdr_size + xfer;
+		seg.csum = INET_CSUM_PARTIAL;
+
+		sseq = host2uint32_t_be(seq + (offs - hdr_size));
+		memcpy(sdata + TCP_SEQ_OFFS, &sseq, sizeof(sseq));
+		if (!last)
+			sdata[TCP_FLAGS_OFFS] &= ~TCP_FLAGS_LAST;
+
+		scs = host2uint16_t_be(inet_checksum_add(cs, seg.size));
+		memcpy(sdata + dgram->csum_offs, &scs, sizeof(scs));
+
+		rc = inet_link_send_dgram(ilink, lsrc, ldest, &seg, proto,
+		    ttl, df);
+		if (rc != EOK)
+			break;
+
+		offs += xfer;
+	} while (offs < dgram->size);
+
+	free(seg.data);
+	return rc;
+}
+
 /** Send IPv4 datagram over Internet link
  *
  * @param ilink Internet link
@@ -330,15 +458,45 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
 	if (dest_ver != ip_v4)
 		return EINVAL;
 
+	bool tso = false;
+	if (dgram->tso_mss != 0) {
+		if ((ilink->offload & IPLINK_OFFLOAD_TSO) == 0)
+			return inet_link_send_gso(ilink, lsrc, ldest, dgram,
+			    proto, ttl, df);
+		tso = true;
+	}
+
+	if (dgram->csum == INET_CSUM_PARTIAL &&
+	    (ilink->offload & IPLINK_OFFLOAD_TX_CSUM) == 0)
+		inet_link_csum_complete(dgram);
+
 	/*
 	 * Fill packet structure. Fragmentation is performed by
-	 * inet_pdu_encode().
+	 * inet_pdu_encode(), unless the link segments the datagram.
 	 */
 
 	iplink_sdu_t sdu;
 
 	sdu.src = lsrc;
 	sdu.dest = ldest;
+	sdu.offload = 0;
+	sdu.csum_start = 0;
+	sdu.csum_offs = 0;
+	sdu.mss = 0;
+
+	if (dgram->csum == INET_CSUM_PARTIAL) {
+		sdu.offload = IPLINK_OFFLOAD_TX_CSUM;
+		sdu.csum_start = sizeof(ip_header_t);
+		sdu.csum_offs = dgram->csum_offs;
+		if (tso) {
+			sdu.offload |= IPLINK_OFFLOAD_TSO;
+			sdu.mss = dgram->tso_mss;
+		}
+	}
+
+	size_t mtu = ilink->def_mtu;
+	if (tso)
+		mtu = sizeof(ip_header_t) + dgram->size;
 
 	inet_packet_t packet;
 
@@ -364,7 +522,7 @@ errno_t inet_link_send_dgram(inet_link_t *ilink, addr32_t lsrc, addr32_t ldest,
 		/* Encode one fragment */
 
 		size_t roffs;
-		rc = inet_pdu_encode(&packet, src_v4, dest_v4, offs, ilink->def_mtu,
+		rc = inet_pdu_encode(&packet, src_v4, dest_v4, offs, mtu,
 		    &sdu.data, &sdu.size, &roffs);
 		if (rc != EOK)
 			return rc;
@@ -405,6 +563,11 @@ errno_t inet_link_send_dgram6(inet_link_t *ilink, eth_addr_t *ldest,
 	if (dest_ver != ip_v6)
 		return EINVAL;
 
+	/* Offloads are only used for IPv4 */
+	if (dgram->tso_mss != 0)
+		return EINVAL;
+	inet_link_csum_complete(dgram);
+
 	iplink_sdu6_t sdu6;
 	sdu6.dest = *ldest;
 
@@ -49,6 +49,7 @@
 #include "inetsrv.h"
 #include "inet_link.h"
 #include "inetcfg.h"
+#include "reass.h"
 #include "sroute.h"
 
 static errno_t inetcfg_addr_create_static(char *name, inet_naddr_t *naddr,
@@ -193,6 +194,7 @@ static errno_t inetcfg_sroute_create(char *name, inet_naddr_t *dest,
     inet_addr_t *router, sysarg_t *sroute_id)
 {
 	inet_sroute_t *sroute;
+	errno_t rc;
 
 	sroute = inet_sroute_new();
 	if (sroute == NULL) {
@@ -203,7 +205,13 @@ static errno_t inetcfg_sroute_create(char *name, inet_naddr_t *dest,
 	sroute->dest = *dest;
 	sroute->router = *router;
 	sroute->name = str_dup(name);
-	inet_sroute_add(sroute);
+
+	rc = inet_sroute_add(sroute);
+	if (rc != EOK) {
+		inet_sroute_delete(sroute);
+		*sroute_id = 0;
+		return rc;
+	}
 
 	*sroute_id = sroute->id;
 	return EOK;
@@ -736,6 +744,39 @@ static void inetcfg_sroute_get_id_srv(ipc_call_t *call)
 	async_answer_1(call, rc, sroute_id);
 }
 
+static void inetcfg_reass_stats_get_srv(ipc_call_t *icall)
+{
+	inet_reass_stats_t stats;
+	ipc_call_t call;
+	size_t size;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "inetcfg_reass_stats_get_srv()");
+
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size != sizeof(inet_reass_stats_t)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	inet_reass_get_stats(&stats);
+
+	rc = async_data_read_finalize(&call, &stats, size);
+	if (rc != EOK) {
+		async_answer_0(&call, rc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	async_answer_0(icall, EOK);
+}
+
 void inet_cfg_conn(ipc_call_t *icall, void *arg)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_cfg_conn()");
@@ -798,6 +839,9 @@ void inet_cfg_conn(ipc_call_t *icall, void *arg)
 		case INETCFG_SROUTE_GET_ID:
 			inetcfg_sroute_get_id_srv(&call);
 			break;
+		case INETCFG_REASS_STATS_GET:
+			inetcfg_reass_stats_get_srv(&call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
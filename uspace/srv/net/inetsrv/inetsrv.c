@@ -57,6 +57,7 @@
 #include "inetcfg.h"
 #include "inetping.h"
 #include "inet_link.h"
+#include "ntrans.h"
 #include "reass.h"
 #include "sroute.h"
 
@@ -87,8 +88,16 @@ static errno_t inet_init(void)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_init()");
 
+	errno_t rc = ntrans_init();
+	if (rc != EOK)
+		return rc;
+
+	rc = inet_reass_init();
+	if (rc != EOK)
+		return rc;
+
 	port_id_t port;
-	errno_t rc = async_create_port(INTERFACE_INET,
+	rc = async_create_port(INTERFACE_INET,
 	    inet_default_conn, NULL, &port);
 	if (rc != EOK)
 		return rc;
@@ -163,9 +172,40 @@ static errno_t inet_find_dir(inet_addr_t *src, inet_addr_t *dest, uint8_t tos,
 	return EOK;
 }
 
+/** Deliver datagram destined to one of our own addresses.
+ *
+ * The datagram is handed directly to the local receive path instead of
+ * going through an IP link. The payload never leaves this host, so its
+ * checksum needs neither to be computed nor verified and segmentation
+ * offload is not needed.
+ *
+ * @param aobj  Address object with the destination address
+ * @param dgram Datagram
+ * @param proto Protocol
+ * @return EOK on success or an error code
+ */
+static errno_t inet_deliver_local(inet_addrobj_t *aobj, inet_dgram_t *dgram,
+    uint8_t proto)
+{
+	inet_dgram_t ldgram;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "dgram to local address");
+
+	ldgram = *dgram;
+	ldgram.iplink = aobj->ilink->svc_id;
+	/* Source address is taken from the address object as when sending */
+	inet_naddr_addr(&aobj->naddr, &ldgram.src);
+	ldgram.csum = INET_CSUM_VALID;
+	ldgram.csum_offs = 0;
+	ldgram.tso_mss = 0;
+
+	return inet_recv_dgram_local(&ldgram, proto);
+}
+
 errno_t inet_route_packet(inet_dgram_t *dgram, uint8_t proto, uint8_t ttl,
     int df)
 {
+	inet_addrobj_t *aobj;
 	inet_dir_t dir;
 	inet_link_t *ilink;
 	errno_t rc;
@@ -187,6 +227,10 @@ errno_t inet_route_packet(inet_dgram_t *dgram, uint8_t proto, uint8_t ttl,
 		    dgram->dest.addr, dgram, proto, ttl, df);
 	}
 
+	aobj = inet_addrobj_find(&dgram->dest, iaf_addr);
+	if (aobj != NULL)
+		return inet_deliver_local(aobj, dgram, proto);
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "dgram to be routed");
 
 	/* Route packet using source/destination addresses */
@@ -296,6 +340,11 @@ static void inet_send_srv(inet_client_t *client, ipc_call_t *icall)
 	uint8_t ttl = ipc_get_arg3(icall);
 	int df = ipc_get_arg4(icall);
 
+	sysarg_t csum = ipc_get_arg5(icall);
+	dgram.csum = csum & 0xff;
+	dgram.csum_offs = (csum >> 8) & 0xff;
+	dgram.tso_mss = (csum >> 16) & 0xffff;
+
 	ipc_call_t call;
 	size_t size;
 	if (!async_data_write_receive(&call, &size)) {
@@ -449,8 +498,8 @@ errno_t inet_ev_recv(inet_client_t *client, inet_dgram_t *dgram)
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_ev_recv: iplink=%zu",
 	    dgram->iplink);
 
-	aid_t req = async_send_2(exch, INET_EV_RECV, dgram->tos,
-	    dgram->iplink, &answer);
+	aid_t req = async_send_3(exch, INET_EV_RECV, dgram->tos,
+	    dgram->iplink, dgram->csum, &answer);
 
 	errno_t rc = async_data_write_start(exch, &dgram->src, sizeof(inet_addr_t));
 	if (rc != EOK) {
@@ -525,6 +574,10 @@ errno_t inet_recv_packet(inet_packet_t *packet)
 			dgram.tos = packet->tos;
 			dgram.data = packet->data;
 			dgram.size = packet->size;
+			dgram.csum = packet->csum_ok ? INET_CSUM_VALID :
+			    INET_CSUM_NONE;
+			dgram.csum_offs = 0;
+			dgram.tso_mss = 0;
 
 			return inet_recv_dgram_local(&dgram, packet->proto);
 		} else {
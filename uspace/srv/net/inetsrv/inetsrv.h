@@ -100,6 +100,8 @@ typedef struct {
 	void *data;
 	/** Packet data size in bytes */
 	size_t size;
+	/** Transport checksum verified by the link */
+	bool csum_ok;
 } inet_packet_t;
 
 typedef struct {
@@ -111,6 +113,8 @@ typedef struct {
 	size_t def_mtu;
 	eth_addr_t mac;
 	bool mac_valid;
+	/** Offloads supported by the link (IPLINK_OFFLOAD_xxx) */
+	uint32_t offload;
 } inet_link_t;
 
 typedef struct {
@@ -124,6 +128,10 @@ typedef struct {
 /** Static route configuration */
 typedef struct {
 	link_t sroute_list;
+	/** Link to inet_rtrie_node_t.routes */
+	link_t rnode_link;
+	/** Routing trie node holding the route or @c NULL */
+	struct inet_rtrie_node *rnode;
 	sysarg_t id;
 	/** Destination network */
 	inet_naddr_t dest;
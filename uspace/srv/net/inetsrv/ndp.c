@@ -46,9 +46,6 @@
 #include "inet_link.h"
 #include "ndp.h"
 
-/** Time to wait for NDP reply in microseconds */
-#define NDP_REQUEST_TIMEOUT  (3 * 1000 * 1000)
-
 static addr128_t solicited_node_ip =
     { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0xff, 0, 0, 0 };
 
@@ -141,30 +138,17 @@ errno_t ndp_received(inet_dgram_t *dgram)
 	return EOK;
 }
 
-/** Translate IPv6 to MAC address
+/** Send neighbour solicitation
  *
- * @param src  Source IPv6 address
- * @param dest Destination IPv6 address
- * @param mac  Target MAC address to be assigned
- * @param link Network interface
+ * @param ilink    Network interface
+ * @param src_addr Source IPv6 address
+ * @param ip_addr  IPv6 address to resolve
  *
- * @return EOK on success
- * @return ENOENT when NDP translation failed
+ * @return EOK on success or an error code
  *
  */
-errno_t ndp_translate(addr128_t src_addr, addr128_t ip_addr, eth_addr_t *mac_addr,
-    inet_link_t *ilink)
+errno_t ndp_solicit(inet_link_t *ilink, addr128_t src_addr, addr128_t ip_addr)
 {
-	if (!ilink->mac_valid) {
-		/* The link does not support NDP */
-		memset(mac_addr, 0, 6);
-		return EOK;
-	}
-
-	errno_t rc = ntrans_lookup(ip_addr, mac_addr);
-	if (rc == EOK)
-		return EOK;
-
 	ndp_packet_t packet;
 
 	packet.opcode = ICMPV6_NEIGHBOUR_SOLICITATION;
@@ -174,11 +158,45 @@ errno_t ndp_translate(addr128_t src_addr, addr128_t ip_addr, eth_addr_t *mac_add
 	eth_addr_solicited_node(ip_addr, &packet.target_hw_addr);
 	ndp_solicited_node_ip(ip_addr, packet.target_proto_addr);
 
-	rc = ndp_send_packet(ilink, &packet);
-	if (rc != EOK)
-		return rc;
+	return ndp_send_packet(ilink, &packet);
+}
+
+/** Translate IPv6 to MAC address
+ *
+ * If the address is not known yet, a copy of the datagram is queued
+ * and sent once the address is resolved.
+ *
+ * @param src   Source IPv6 address
+ * @param dest  Destination IPv6 address
+ * @param mac   Target MAC address to be assigned
+ * @param link  Network interface
+ * @param dgram Datagram to be sent
+ * @param proto Protocol
+ * @param ttl   Time to live
+ * @param df    Do not fragment
+ *
+ * @return EOK on success
+ * @return EAGAIN when the datagram was queued
+ * @return ENOMEM if not enough memory
+ *
+ */
+errno_t ndp_translate(addr128_t src_addr, addr128_t ip_addr, eth_addr_t *mac_addr,
+    inet_link_t *ilink, inet_dgram_t *dgram, uint8_t proto, uint8_t ttl,
+    int df)
+{
+	bool solicit;
+	errno_t rc;
+
+	if (!ilink->mac_valid) {
+		/* The link does not support NDP */
+		memset(mac_addr, 0, 6);
+		return EOK;
+	}
 
-	(void) ntrans_wait_timeout(NDP_REQUEST_TIMEOUT);
+	rc = ntrans_resolve(ilink, src_addr, ip_addr, dgram, proto, ttl, df,
+	    mac_addr, &solicit);
+	if (solicit)
+		(void) ndp_solicit(ilink, src_addr, ip_addr);
 
-	return ntrans_lookup(ip_addr, mac_addr);
+	return rc;
 }
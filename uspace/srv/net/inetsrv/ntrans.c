@@ -35,18 +35,129 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <io/log.h>
+#include <mem.h>
 #include <stdlib.h>
+#include <time.h>
+#include "inet_link.h"
+#include "ndp.h"
 #include "ntrans.h"
 
-/** Address translation list (of inet_ntrans_t) */
-static FIBRIL_MUTEX_INITIALIZE(ntrans_list_lock);
-static LIST_INITIALIZE(ntrans_list);
-static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
+/** How long a confirmed entry stays reachable (microseconds) */
+#define NTRANS_REACHABLE_TIME (30 * 1000 * 1000)
+/** How long an unused stale entry is kept (microseconds) */
+#define NTRANS_STALE_TIME (60 * 1000 * 1000)
+/** Interval between neighbour solicitations while resolving (microseconds) */
+#define NTRANS_RETRANS_TIME (1000 * 1000)
+/** Number of neighbour solicitations sent before giving up */
+#define NTRANS_MAX_PROBES 3
+/** Maximum number of datagrams queued per unresolved entry */
+#define NTRANS_MAX_PENDING 3
+
+/** Datagram waiting for address resolution */
+typedef struct {
+	/** Link to inet_ntrans_t.pending */
+	link_t lpending;
+	/** Link to send the datagram through */
+	inet_link_t *ilink;
+	inet_dgram_t dgram;
+	uint8_t proto;
+	uint8_t ttl;
+	int df;
+} inet_ntrans_pkt_t;
+
+/** Neighbour solicitation to send after the table is unlocked */
+typedef struct {
+	link_t lsolicit;
+	inet_link_t *ilink;
+	addr128_t src_addr;
+	addr128_t ip_addr;
+} inet_ntrans_solicit_t;
+
+/** Address translation table (of inet_ntrans_t) */
+static FIBRIL_MUTEX_INITIALIZE(ntrans_lock);
+static hash_table_t ntrans_table;
+/** Ages entries and retransmits neighbour solicitations */
+static fibril_timer_t *ntrans_timer;
+
+static size_t ntrans_addr_hash(const addr128_t addr)
+{
+	size_t hash = 0;
+
+	for (size_t i = 0; i < sizeof(addr128_t); i += 4) {
+		hash = hash_combine(hash, ((uint32_t) addr[i] << 24) |
+		    ((uint32_t) addr[i + 1] << 16) |
+		    ((uint32_t) addr[i + 2] << 8) | addr[i + 3]);
+	}
+
+	return hash;
+}
+
+static size_t ntrans_ht_hash(const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    lentries);
+
+	return ntrans_addr_hash(ntrans->ip_addr);
+}
+
+static size_t ntrans_ht_key_hash(const void *key)
+{
+	return ntrans_addr_hash(key);
+}
+
+static bool ntrans_ht_key_equal(const void *key, const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    lentries);
+
+	return addr128_compare(ntrans->ip_addr, key);
+}
+
+static void ntrans_pkt_delete(inet_ntrans_pkt_t *pkt)
+{
+	free(pkt->dgram.data);
+	free(pkt);
+}
+
+static void ntrans_ht_remove(ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    lentries);
+
+	while (!list_empty(&ntrans->pending)) {
+		inet_ntrans_pkt_t *pkt = list_get_instance(
+		    list_first(&ntrans->pending), inet_ntrans_pkt_t, lpending);
+
+		list_remove(&pkt->lpending);
+		ntrans_pkt_delete(pkt);
+	}
+
+	free(ntrans);
+}
+
+static hash_table_ops_t ntrans_ht_ops = {
+	.hash = ntrans_ht_hash,
+	.key_hash = ntrans_ht_key_hash,
+	.key_equal = ntrans_ht_key_equal,
+	.equal = NULL,
+	.remove_callback = ntrans_ht_remove
+};
+
+static usec_t ntrans_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
 
 /** Look for address in translation table
  *
@@ -57,15 +168,152 @@ static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
  */
 static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 {
-	list_foreach(ntrans_list, ntrans_list, inet_ntrans_t, ntrans) {
-		if (addr128_compare(ntrans->ip_addr, ip_addr))
-			return ntrans;
+	ht_link_t *link;
+
+	link = hash_table_find(&ntrans_table, ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, inet_ntrans_t, lentries);
+}
+
+/** Create translation table entry
+ *
+ * @param ip_addr IPv6 address
+ *
+ * @return New entry or @c NULL if out of memory
+ */
+static inet_ntrans_t *ntrans_create(addr128_t ip_addr)
+{
+	inet_ntrans_t *ntrans;
+
+	ntrans = calloc(1, sizeof(inet_ntrans_t));
+	if (ntrans == NULL)
+		return NULL;
+
+	addr128(ip_addr, ntrans->ip_addr);
+	list_initialize(&ntrans->pending);
+	hash_table_insert(&ntrans_table, &ntrans->lentries);
+	return ntrans;
+}
+
+/** Queue neighbour solicitation to send once the table is unlocked
+ *
+ * @param solicit List of inet_ntrans_solicit_t
+ * @param ntrans  Entry being resolved
+ */
+static void ntrans_solicit_queue(list_t *solicit, inet_ntrans_t *ntrans)
+{
+	inet_ntrans_solicit_t *req;
+
+	req = calloc(1, sizeof(inet_ntrans_solicit_t));
+	if (req == NULL)
+		return;
+
+	req->ilink = ntrans->ilink;
+	addr128(ntrans->src_addr, req->src_addr);
+	addr128(ntrans->ip_addr, req->ip_addr);
+	list_append(&req->lsolicit, solicit);
+}
+
+/** Age one translation table entry
+ *
+ * @param item Entry
+ * @param arg  List of inet_ntrans_solicit_t to append solicitations to
+ *
+ * @return @c true to continue with the next entry
+ */
+static bool ntrans_age(ht_link_t *item, void *arg)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    lentries);
+	list_t *solicit = (list_t *) arg;
+	usec_t now = ntrans_now();
+
+	switch (ntrans->state) {
+	case ns_incomplete:
+	case ns_probe:
+		if (now - ntrans->changed < NTRANS_RETRANS_TIME)
+			break;
+
+		if (ntrans->probes >= NTRANS_MAX_PROBES) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "Neighbour resolution "
+			    "failed");
+			hash_table_remove_item(&ntrans_table, item);
+			break;
+		}
+
+		++ntrans->probes;
+		ntrans->changed = now;
+		ntrans_solicit_queue(solicit, ntrans);
+		break;
+	case ns_reachable:
+		if (now - ntrans->changed >= NTRANS_REACHABLE_TIME) {
+			ntrans->state = ns_stale;
+			ntrans->changed = now;
+		}
+		break;
+	case ns_stale:
+		if (now - ntrans->changed >= NTRANS_STALE_TIME)
+			hash_table_remove_item(&ntrans_table, item);
+		break;
+	}
+
+	return true;
+}
+
+/** Translation table timer handler
+ *
+ * @param arg Not used
+ */
+static void ntrans_timer_handler(void *arg)
+{
+	list_t solicit;
+
+	list_initialize(&solicit);
+
+	fibril_mutex_lock(&ntrans_lock);
+	hash_table_apply(&ntrans_table, ntrans_age, &solicit);
+	fibril_mutex_unlock(&ntrans_lock);
+
+	while (!list_empty(&solicit)) {
+		inet_ntrans_solicit_t *req = list_get_instance(
+		    list_first(&solicit), inet_ntrans_solicit_t, lsolicit);
+
+		list_remove(&req->lsolicit);
+		(void) ndp_solicit(req->ilink, req->src_addr, req->ip_addr);
+		free(req);
 	}
 
-	return NULL;
+	fibril_timer_set(ntrans_timer, NTRANS_RETRANS_TIME,
+	    ntrans_timer_handler, NULL);
 }
 
-/** Add entry to translation table
+/** Initialize translation table
+ *
+ * @return EOK on success
+ * @return ENOMEM if not enough memory
+ *
+ */
+errno_t ntrans_init(void)
+{
+	if (!hash_table_create(&ntrans_table, 0, 0, &ntrans_ht_ops))
+		return ENOMEM;
+
+	ntrans_timer = fibril_timer_create(NULL);
+	if (ntrans_timer == NULL) {
+		hash_table_destroy(&ntrans_table);
+		return ENOMEM;
+	}
+
+	fibril_timer_set(ntrans_timer, NTRANS_RETRANS_TIME,
+	    ntrans_timer_handler, NULL);
+	return EOK;
+}
+
+/** Add or confirm entry in translation table
+ *
+ * The entry becomes reachable and datagrams waiting for it are sent.
  *
  * @param ip_addr  IPv6 address of the new entry
  * @param mac_addr MAC address of the new entry
@@ -77,25 +325,37 @@ static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 errno_t ntrans_add(addr128_t ip_addr, eth_addr_t *mac_addr)
 {
 	inet_ntrans_t *ntrans;
-	inet_ntrans_t *prev;
+	list_t pending;
 
-	ntrans = calloc(1, sizeof(inet_ntrans_t));
-	if (ntrans == NULL)
-		return ENOMEM;
+	list_initialize(&pending);
+
+	fibril_mutex_lock(&ntrans_lock);
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL) {
+		ntrans = ntrans_create(ip_addr);
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_lock);
+			return ENOMEM;
+		}
+	}
 
-	addr128(ip_addr, ntrans->ip_addr);
 	ntrans->mac_addr = *mac_addr;
+	ntrans->state = ns_reachable;
+	ntrans->changed = ntrans_now();
+	ntrans->probes = 0;
+	list_concat(&pending, &ntrans->pending);
+	ntrans->npending = 0;
+	fibril_mutex_unlock(&ntrans_lock);
 
-	fibril_mutex_lock(&ntrans_list_lock);
-	prev = ntrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->ntrans_list);
-		free(prev);
-	}
+	while (!list_empty(&pending)) {
+		inet_ntrans_pkt_t *pkt = list_get_instance(list_first(&pending),
+		    inet_ntrans_pkt_t, lpending);
 
-	list_append(&ntrans->ntrans_list, &ntrans_list);
-	fibril_mutex_unlock(&ntrans_list_lock);
-	fibril_condvar_broadcast(&ntrans_cv);
+		list_remove(&pkt->lpending);
+		(void) inet_link_send_dgram6(pkt->ilink, mac_addr, &pkt->dgram,
+		    pkt->proto, pkt->ttl, pkt->df);
+		ntrans_pkt_delete(pkt);
+	}
 
 	return EOK;
 }
@@ -112,16 +372,15 @@ errno_t ntrans_remove(addr128_t ip_addr)
 {
 	inet_ntrans_t *ntrans;
 
-	fibril_mutex_lock(&ntrans_list_lock);
+	fibril_mutex_lock(&ntrans_lock);
 	ntrans = ntrans_find(ip_addr);
 	if (ntrans == NULL) {
-		fibril_mutex_unlock(&ntrans_list_lock);
+		fibril_mutex_unlock(&ntrans_lock);
 		return ENOENT;
 	}
 
-	list_remove(&ntrans->ntrans_list);
-	fibril_mutex_unlock(&ntrans_list_lock);
-	free(ntrans);
+	hash_table_remove_item(&ntrans_table, &ntrans->lentries);
+	fibril_mutex_unlock(&ntrans_lock);
 
 	return EOK;
 }
@@ -137,34 +396,115 @@ errno_t ntrans_remove(addr128_t ip_addr)
  */
 errno_t ntrans_lookup(addr128_t ip_addr, eth_addr_t *mac_addr)
 {
-	fibril_mutex_lock(&ntrans_list_lock);
-	inet_ntrans_t *ntrans = ntrans_find(ip_addr);
-	if (ntrans == NULL) {
-		fibril_mutex_unlock(&ntrans_list_lock);
+	inet_ntrans_t *ntrans;
+
+	fibril_mutex_lock(&ntrans_lock);
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans == NULL || ntrans->state == ns_incomplete) {
+		fibril_mutex_unlock(&ntrans_lock);
 		return ENOENT;
 	}
 
-	fibril_mutex_unlock(&ntrans_list_lock);
 	*mac_addr = ntrans->mac_addr;
+	fibril_mutex_unlock(&ntrans_lock);
 	return EOK;
 }
 
-/** Wait on translation table CV for some time
+/** Resolve IPv6 address or queue datagram until it is resolved
  *
- * @param timeout Timeout in microseconds
+ * @param ilink    Link the datagram is to be sent through
+ * @param src_addr Source IPv6 address for neighbour solicitations
+ * @param ip_addr  IPv6 address to be translated
+ * @param dgram    Datagram
+ * @param proto    Protocol
+ * @param ttl      Time to live
+ * @param df       Do not fragment
+ * @param mac_addr MAC address to be assigned
+ * @param rsolicit Place to store @c true if the caller should send
+ *                 a neighbour solicitation for @a ip_addr
  *
- * @return EOK if woken up by another fibril
- * @return ETIMEOUT if timed out
+ * @return EOK if @a mac_addr was assigned
+ * @return EAGAIN if a copy of the datagram was queued
+ * @return ENOMEM if not enough memory
  *
  */
-errno_t ntrans_wait_timeout(usec_t timeout)
+errno_t ntrans_resolve(inet_link_t *ilink, addr128_t src_addr,
+    addr128_t ip_addr, inet_dgram_t *dgram, uint8_t proto, uint8_t ttl,
+    int df, eth_addr_t *mac_addr, bool *rsolicit)
 {
-	fibril_mutex_lock(&ntrans_list_lock);
-	errno_t rc = fibril_condvar_wait_timeout(&ntrans_cv, &ntrans_list_lock,
-	    timeout);
-	fibril_mutex_unlock(&ntrans_list_lock);
+	inet_ntrans_t *ntrans;
+	inet_ntrans_pkt_t *pkt;
+
+	*rsolicit = false;
+
+	fibril_mutex_lock(&ntrans_lock);
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans != NULL && ntrans->state != ns_incomplete) {
+		if (ntrans->state == ns_stale) {
+			/* Re-confirm, keep using the entry meanwhile */
+			ntrans->state = ns_probe;
+			ntrans->changed = ntrans_now();
+			ntrans->probes = 1;
+			ntrans->ilink = ilink;
+			addr128(src_addr, ntrans->src_addr);
+			*rsolicit = true;
+		}
+
+		*mac_addr = ntrans->mac_addr;
+		fibril_mutex_unlock(&ntrans_lock);
+		return EOK;
+	}
+
+	if (ntrans == NULL) {
+		ntrans = ntrans_create(ip_addr);
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_lock);
+			return ENOMEM;
+		}
+
+		ntrans->state = ns_incomplete;
+		ntrans->changed = ntrans_now();
+		ntrans->probes = 1;
+		ntrans->ilink = ilink;
+		addr128(src_addr, ntrans->src_addr);
+		*rsolicit = true;
+	}
+
+	pkt = calloc(1, sizeof(inet_ntrans_pkt_t));
+	if (pkt == NULL) {
+		fibril_mutex_unlock(&ntrans_lock);
+		return ENOMEM;
+	}
+
+	pkt->dgram = *dgram;
+	pkt->dgram.data = malloc(dgram->size);
+	if (pkt->dgram.data == NULL) {
+		free(pkt);
+		fibril_mutex_unlock(&ntrans_lock);
+		return ENOMEM;
+	}
+
+	memcpy(pkt->dgram.data, dgram->data, dgram->size);
+	pkt->ilink = ilink;
+	pkt->proto = proto;
+	pkt->ttl = ttl;
+	pkt->df = df;
+
+	/* Drop the oldest datagram if too many are waiting */
+	if (ntrans->npending >= NTRANS_MAX_PENDING) {
+		inet_ntrans_pkt_t *old = list_get_instance(
+		    list_first(&ntrans->pending), inet_ntrans_pkt_t, lpending);
+
+		list_remove(&old->lpending);
+		ntrans_pkt_delete(old);
+		--ntrans->npending;
+	}
+
+	list_append(&pkt->lpending, &ntrans->pending);
+	++ntrans->npending;
+	fibril_mutex_unlock(&ntrans_lock);
 
-	return rc;
+	return EAGAIN;
 }
 
 /** @}
@@ -38,21 +38,51 @@
 #ifndef NTRANS_H_
 #define NTRANS_H_
 
+#include <adt/hash_table.h>
 #include <inet/addr.h>
 #include <inet/eth_addr.h>
 #include <inet/iplink_srv.h>
+#include <stdbool.h>
+#include <time.h>
+#include "inetsrv.h"
+
+/** Address translation entry state */
+typedef enum {
+	/** Resolution in progress, no address known yet */
+	ns_incomplete,
+	/** Address confirmed recently */
+	ns_reachable,
+	/** Address not confirmed recently, confirmed when next used */
+	ns_stale,
+	/** Stale address in use, being confirmed */
+	ns_probe
+} inet_ntrans_state_t;
 
 /** Address translation table element */
 typedef struct {
-	link_t ntrans_list;
+	/** Link to translation table */
+	ht_link_t lentries;
 	addr128_t ip_addr;
 	eth_addr_t mac_addr;
+	inet_ntrans_state_t state;
+	/** Uptime of the last state change or solicitation in microseconds */
+	usec_t changed;
+	/** Number of solicitations sent in the current resolution */
+	unsigned probes;
+	/** Link and source address to send solicitations with */
+	inet_link_t *ilink;
+	addr128_t src_addr;
+	/** Datagrams waiting for the resolution (of inet_ntrans_pkt_t) */
+	list_t pending;
+	size_t npending;
 } inet_ntrans_t;
 
+extern errno_t ntrans_init(void);
 extern errno_t ntrans_add(addr128_t, eth_addr_t *);
 extern errno_t ntrans_remove(addr128_t);
 extern errno_t ntrans_lookup(addr128_t, eth_addr_t *);
-extern errno_t ntrans_wait_timeout(usec_t);
+extern errno_t ntrans_resolve(inet_link_t *, addr128_t, addr128_t,
+    inet_dgram_t *, uint8_t, uint8_t, int, eth_addr_t *, bool *);
 
 #endif
 
@@ -48,42 +48,6 @@
 #include "inet_std.h"
 #include "pdu.h"
 
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t inet_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-uint16_t inet_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = inet_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = inet_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
-
 /** Encode IPv4 PDU.
  *
  * Encode internet packet into PDU (serialized form). Will encode a
@@ -343,7 +307,20 @@ errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
 	uint16_t flags_foff = uint16_t_be2host(hdr->flags_foff);
 	uint16_t foff = BIT_RANGE_EXTRACT(uint16_t, FF_FRAGOFF_h, FF_FRAGOFF_l,
 	    flags_foff);
-	/* XXX Checksum */
+
+	/* XXX IP options */
+	size_t data_offs = sizeof(uint32_t) *
+	    BIT_RANGE_EXTRACT(uint8_t, VI_IHL_h, VI_IHL_l, hdr->ver_ihl);
+	if (data_offs < sizeof(ip_header_t) || data_offs > tot_len) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Invalid header length (%zu)",
+		    data_offs);
+		return EINVAL;
+	}
+
+	if (inet_checksum_calc(INET_CHECKSUM_INIT, hdr, data_offs) != 0) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Header checksum mismatch");
+		return EINVAL;
+	}
 
 	inet_addr_set(uint32_t_be2host(hdr->src_addr), &packet->src);
 	inet_addr_set(uint32_t_be2host(hdr->dest_addr), &packet->dest);
@@ -355,10 +332,7 @@ errno_t inet_pdu_decode(void *data, size_t size, service_id_t link_id,
 	packet->df = (flags_foff & BIT_V(uint16_t, FF_FLAG_DF)) != 0;
 	packet->mf = (flags_foff & BIT_V(uint16_t, FF_FLAG_MF)) != 0;
 	packet->offs = foff * FRAG_OFFS_UNIT;
-
-	/* XXX IP options */
-	size_t data_offs = sizeof(uint32_t) *
-	    BIT_RANGE_EXTRACT(uint8_t, VI_IHL_h, VI_IHL_l, hdr->ver_ihl);
+	packet->csum_ok = false;
 
 	packet->size = tot_len - data_offs;
 	packet->data = calloc(packet->size, 1);
@@ -453,6 +427,7 @@ errno_t inet_pdu_decode6(void *data, size_t size, service_id_t link_id,
 	packet->df = 1;
 	packet->mf = (offsmf & BIT_V(uint16_t, OF_FLAG_M)) != 0;
 	packet->offs = foff * FRAG_OFFS_UNIT;
+	packet->csum_ok = false;
 
 	packet->size = payload_len;
 	packet->data = calloc(packet->size, 1);
@@ -479,6 +454,9 @@ errno_t ndp_pdu_encode(ndp_packet_t *ndp, inet_dgram_t *dgram)
 	inet_addr_set6(ndp->sender_proto_addr, &dgram->src);
 	inet_addr_set6(ndp->target_proto_addr, &dgram->dest);
 	dgram->tos = 0;
+	dgram->csum = INET_CSUM_NONE;
+	dgram->csum_offs = 0;
+	dgram->tso_mss = 0;
 	dgram->size = sizeof(icmpv6_message_t) + sizeof(ndp_message_t);
 
 	dgram->data = calloc(1, dgram->size);
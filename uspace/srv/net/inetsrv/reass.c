@@ -34,198 +34,364 @@
  * @brief Datagram reassembly.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <adt/odict.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "inetsrv.h"
 #include "inet_std.h"
 #include "reass.h"
 
-/** Datagram being reassembled.
+/** Time after which an incomplete datagram is discarded (microseconds) */
+#define REASS_TIMEOUT (30 * 1000 * 1000)
+/** Interval between checks for timed out datagrams (microseconds) */
+#define REASS_TIMER_INTERVAL (1000 * 1000)
+/** Maximum memory used by all datagrams being reassembled, in bytes */
+#define REASS_MEM_MAX (1024 * 1024)
+/** Maximum size of a reassembled datagram */
+#define REASS_DGRAM_MAX \
+	(FRAG_OFFS_UNIT * (1 << (FF_FRAGOFF_h - FF_FRAGOFF_l + 1)))
+
+/** Datagram identification.
  *
- * Uniquely identified by (source address, destination address, protocol,
- * identification) per RFC 791 sec. 2.3 / Fragmentation.
+ * Per RFC 791 sec. 2.3 / Fragmentation.
  */
 typedef struct {
-	link_t map_link;
-	/** List of fragments, @c reass_frag_t */
-	list_t frags;
+	inet_addr_t src;
+	inet_addr_t dest;
+	uint8_t proto;
+	uint32_t ident;
+} reass_key_t;
+
+/** Datagram being reassembled. */
+typedef struct {
+	/** Link to reass_dgram_table */
+	ht_link_t htlink;
+	/** Link to reass_dgram_lru */
+	link_t lru_link;
+	/** Datagram identification */
+	reass_key_t key;
+	/** Link the first fragment was received on */
+	service_id_t link_id;
+	/** Type of service */
+	uint8_t tos;
+	/** Received data, non-overlapping reass_frag_t ordered by offset */
+	odict_t frags;
+	/** Number of data bytes received */
+	size_t received;
+	/** @c true once the last fragment (MF = 0) has been received */
+	bool have_last;
+	/** Datagram size, valid if @c have_last is @c true */
+	size_t size;
+	/** Memory charged to this datagram in bytes */
+	size_t mem;
+	/** Uptime at which the datagram times out */
+	usec_t expires;
 } reass_dgram_t;
 
-/** One datagram fragment */
+/** Contiguous piece of datagram data */
 typedef struct {
-	link_t dgram_link;
-	inet_packet_t packet;
+	/** Link to reass_dgram_t.frags */
+	odlink_t lfrags;
+	/** Offset into datagram in bytes */
+	size_t offs;
+	/** Size in bytes */
+	size_t size;
+	/** Data */
+	uint8_t data[];
 } reass_frag_t;
 
-/** Datagram map, list of reass_dgram_t */
-static LIST_INITIALIZE(reass_dgram_map);
-/** Protects access to @c reass_dgram_map */
-static FIBRIL_MUTEX_INITIALIZE(reass_dgram_map_lock);
+/** Datagrams being reassembled, of reass_dgram_t */
+static hash_table_t reass_dgram_table;
+/** Datagrams being reassembled, oldest first */
+static LIST_INITIALIZE(reass_dgram_lru);
+/** Protects reassembly state */
+static FIBRIL_MUTEX_INITIALIZE(reass_lock);
+/** Discards timed out datagrams */
+static fibril_timer_t *reass_timer;
+/** Memory used by all datagrams being reassembled */
+static size_t reass_mem;
+/** Reassembly statistics */
+static inet_reass_stats_t reass_stats;
 
-static reass_dgram_t *reass_dgram_new(void);
-static reass_dgram_t *reass_dgram_get(inet_packet_t *);
-static errno_t reass_dgram_insert_frag(reass_dgram_t *, inet_packet_t *);
-static bool reass_dgram_complete(reass_dgram_t *);
 static void reass_dgram_remove(reass_dgram_t *);
 static errno_t reass_dgram_deliver(reass_dgram_t *);
 static void reass_dgram_destroy(reass_dgram_t *);
 
-/** Queue packet for datagram reassembly.
+static size_t reass_addr_hash(size_t hash, const inet_addr_t *addr)
+{
+	if (addr->version != ip_v6)
+		return hash_combine(hash, addr->addr);
+
+	for (size_t i = 0; i < sizeof(addr128_t); i += 4) {
+		hash = hash_combine(hash, ((uint32_t) addr->addr6[i] << 24) |
+		    ((uint32_t) addr->addr6[i + 1] << 16) |
+		    ((uint32_t) addr->addr6[i + 2] << 8) | addr->addr6[i + 3]);
+	}
+
+	return hash;
+}
+
+static size_t reass_key_hash(const reass_key_t *key)
+{
+	size_t hash;
+
+	hash = hash_combine(key->ident, key->proto);
+	hash = reass_addr_hash(hash, &key->src);
+	return reass_addr_hash(hash, &key->dest);
+}
+
+static size_t reass_ht_hash(const ht_link_t *item)
+{
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t, htlink);
+
+	return reass_key_hash(&rdg->key);
+}
+
+static size_t reass_ht_key_hash(const void *key)
+{
+	return reass_key_hash(key);
+}
+
+static bool reass_ht_key_equal(const void *arg, const ht_link_t *item)
+{
+	reass_dgram_t *rdg = hash_table_get_inst(item, reass_dgram_t, htlink);
+	const reass_key_t *key = arg;
+
+	return inet_addr_compare(&rdg->key.src, &key->src) &&
+	    inet_addr_compare(&rdg->key.dest, &key->dest) &&
+	    rdg->key.proto == key->proto && rdg->key.ident == key->ident;
+}
+
+static hash_table_ops_t reass_ht_ops = {
+	.hash = reass_ht_hash,
+	.key_hash = reass_ht_key_hash,
+	.key_equal = reass_ht_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static void *reass_frag_getkey(odlink_t *odlink)
+{
+	return &odict_get_instance(odlink, reass_frag_t, lfrags)->offs;
+}
+
+static int reass_frag_cmp(void *a, void *b)
+{
+	size_t oa = *(size_t *) a;
+	size_t ob = *(size_t *) b;
+
+	if (oa < ob)
+		return -1;
+	if (oa > ob)
+		return 1;
+	return 0;
+}
+
+static usec_t reass_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+/** Charge memory to datagram.
  *
- * @param packet	Packet
- * @return		EOK on success or ENOMEM.
+ * @param rdg  Datagram reassembly structure
+ * @param size Number of bytes
  */
-errno_t inet_reass_queue_packet(inet_packet_t *packet)
+static void reass_mem_charge(reass_dgram_t *rdg, size_t size)
 {
-	reass_dgram_t *rdg;
-	errno_t rc;
+	rdg->mem += size;
+	reass_mem += size;
+}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_reass_queue_packet()");
+/** Evict oldest datagrams to make room for new data.
+ *
+ * @param keep Datagram that must not be evicted or @c NULL
+ * @param size Number of bytes needed
+ * @return @c true if there is enough room
+ */
+static bool reass_mem_reserve(reass_dgram_t *keep, size_t size)
+{
+	assert(fibril_mutex_is_locked(&reass_lock));
 
-	fibril_mutex_lock(&reass_dgram_map_lock);
+	list_foreach_safe(reass_dgram_lru, cur, next) {
+		reass_dgram_t *rdg;
 
-	/* Get existing or new datagram */
-	rdg = reass_dgram_get(packet);
-	if (rdg == NULL) {
-		/* Only happens when we are out of memory */
-		fibril_mutex_unlock(&reass_dgram_map_lock);
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "Allocation failed, packet dropped.");
-		return ENOMEM;
-	}
+		if (reass_mem + size <= REASS_MEM_MAX)
+			break;
 
-	/* Insert fragment into the datagram */
-	rc = reass_dgram_insert_frag(rdg, packet);
-	if (rc != EOK)
-		return ENOMEM;
+		rdg = list_get_instance(cur, reass_dgram_t, lru_link);
+		if (rdg == keep)
+			continue;
 
-	/* Check if datagram is complete */
-	if (reass_dgram_complete(rdg)) {
-		/* Remove it from the map */
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly memory exhausted, "
+		    "evicting datagram.");
 		reass_dgram_remove(rdg);
-		fibril_mutex_unlock(&reass_dgram_map_lock);
-
-		/* Deliver complete datagram */
-		rc = reass_dgram_deliver(rdg);
 		reass_dgram_destroy(rdg);
-		return rc;
+		++reass_stats.evictions;
 	}
 
-	fibril_mutex_unlock(&reass_dgram_map_lock);
-	return EOK;
+	return reass_mem + size <= REASS_MEM_MAX;
 }
 
 /** Get datagram reassembly structure for packet.
  *
  * @param packet	Packet
- * @return		Datagram reassembly structure matching @a packet
+ * @return		Datagram reassembly structure matching @a packet or
+ *			@c NULL if out of memory
  */
 static reass_dgram_t *reass_dgram_get(inet_packet_t *packet)
 {
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+	reass_dgram_t *rdg;
+	reass_key_t key;
+	ht_link_t *link;
 
-	list_foreach(reass_dgram_map, map_link, reass_dgram_t, rdg) {
-		link_t *f1_link = list_first(&rdg->frags);
-		assert(f1_link != NULL);
+	assert(fibril_mutex_is_locked(&reass_lock));
 
-		reass_frag_t *f1 = list_get_instance(f1_link, reass_frag_t,
-		    dgram_link);
+	key.src = packet->src;
+	key.dest = packet->dest;
+	key.proto = packet->proto;
+	key.ident = packet->ident;
 
-		if ((inet_addr_compare(&f1->packet.src, &packet->src)) &&
-		    (inet_addr_compare(&f1->packet.dest, &packet->dest)) &&
-		    (f1->packet.proto == packet->proto) &&
-		    (f1->packet.ident == packet->ident)) {
-			/* Match */
-			return rdg;
-		}
-	}
+	link = hash_table_find(&reass_dgram_table, &key);
+	if (link != NULL)
+		return hash_table_get_inst(link, reass_dgram_t, htlink);
 
 	/* No existing reassembly structure. Create a new one. */
-	return reass_dgram_new();
-}
-
-/** Create new datagram reassembly structure.
- *
- * @return New datagram reassembly structure.
- */
-static reass_dgram_t *reass_dgram_new(void)
-{
-	reass_dgram_t *rdg;
+	if (!reass_mem_reserve(NULL, sizeof(reass_dgram_t)))
+		return NULL;
 
 	rdg = calloc(1, sizeof(reass_dgram_t));
 	if (rdg == NULL)
 		return NULL;
 
-	list_append(&rdg->map_link, &reass_dgram_map);
-	list_initialize(&rdg->frags);
+	rdg->key = key;
+	rdg->link_id = packet->link_id;
+	rdg->tos = packet->tos;
+	rdg->expires = reass_now() + REASS_TIMEOUT;
+	odict_initialize(&rdg->frags, reass_frag_getkey, reass_frag_cmp);
+	reass_mem_charge(rdg, sizeof(reass_dgram_t));
+
+	hash_table_insert(&reass_dgram_table, &rdg->htlink);
+	list_append(&rdg->lru_link, &reass_dgram_lru);
+	++reass_stats.pending;
 
 	return rdg;
 }
 
-static reass_frag_t *reass_frag_new(void)
+/** Add piece of fragment data to datagram.
+ *
+ * @param rdg    Datagram reassembly structure
+ * @param packet Fragment
+ * @param b      Start offset of the piece in the datagram
+ * @param e      End offset of the piece in the datagram
+ * @return EOK on success or ENOMEM
+ */
+static errno_t reass_dgram_add_piece(reass_dgram_t *rdg, inet_packet_t *packet,
+    size_t b, size_t e)
 {
 	reass_frag_t *frag;
 
-	frag = calloc(1, sizeof(reass_frag_t));
+	frag = malloc(sizeof(reass_frag_t) + (e - b));
 	if (frag == NULL)
-		return NULL;
+		return ENOMEM;
 
-	link_initialize(&frag->dgram_link);
+	frag->offs = b;
+	frag->size = e - b;
+	memcpy(frag->data, (uint8_t *) packet->data + (b - packet->offs), e - b);
 
-	return frag;
+	odlink_initialize(&frag->lfrags);
+	odict_insert(&frag->lfrags, &rdg->frags, NULL);
+	rdg->received += e - b;
+	reass_mem_charge(rdg, sizeof(reass_frag_t) + (e - b));
+	return EOK;
 }
 
+/** Insert fragment into datagram.
+ *
+ * Only data not yet received is stored, so that the pieces of the
+ * datagram never overlap and duplicate fragments consume no memory.
+ *
+ * @param rdg    Datagram reassembly structure
+ * @param packet Fragment
+ * @return EOK on success, EINVAL if fragment is inconsistent with the
+ *         datagram or ENOMEM
+ */
 static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet)
 {
-	reass_frag_t *frag;
-	void *data_copy;
-	link_t *link;
+	size_t b = packet->offs;
+	size_t e = packet->offs + packet->size;
+	reass_frag_t *qf;
+	odlink_t *link;
+	errno_t rc;
 
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
+	assert(fibril_mutex_is_locked(&reass_lock));
 
-	frag = reass_frag_new();
+	if (e > REASS_DGRAM_MAX)
+		return EINVAL;
 
-	/* Clone the packet */
+	if (!packet->mf) {
+		/* Last fragment determines datagram size */
+		if (rdg->have_last && rdg->size != e)
+			return EINVAL;
 
-	data_copy = malloc(packet->size);
-	if (data_copy == NULL) {
-		free(frag);
-		return ENOMEM;
+		link = odict_last(&rdg->frags);
+		if (link != NULL) {
+			qf = odict_get_instance(link, reass_frag_t, lfrags);
+			if (qf->offs + qf->size > e)
+				return EINVAL;
+		}
+	} else if (rdg->have_last && e > rdg->size) {
+		return EINVAL;
 	}
 
-	memcpy(data_copy, packet->data, packet->size);
+	if (!reass_mem_reserve(rdg, sizeof(reass_frag_t) + packet->size))
+		return ENOMEM;
 
-	frag->packet = *packet;
-	frag->packet.data = data_copy;
+	if (!packet->mf) {
+		rdg->have_last = true;
+		rdg->size = e;
+	}
 
-	/*
-	 * XXX Make resource-consuming attacks harder, eliminate any duplicate
-	 * data immediately. Possibly eliminate redundant packet headers.
-	 */
+	/* Start with the piece beginning at or before the fragment */
+	link = odict_find_leq(&rdg->frags, &b, NULL);
+	if (link == NULL)
+		link = odict_first(&rdg->frags);
 
-	/*
-	 * Insert into the list, which is sorted by offs member ascending.
-	 */
+	while (b < e && link != NULL) {
+		qf = odict_get_instance(link, reass_frag_t, lfrags);
+		if (qf->offs >= e)
+			break;
 
-	link = list_first(&rdg->frags);
-	while (link != NULL) {
-		reass_frag_t *qf = list_get_instance(link, reass_frag_t,
-		    dgram_link);
+		if (qf->offs > b) {
+			/* Fill the hole before this piece */
+			rc = reass_dgram_add_piece(rdg, packet, b, qf->offs);
+			if (rc != EOK)
+				return rc;
+			b = qf->offs;
+		}
 
-		if (qf->packet.offs >= packet->offs)
-			break;
+		if (qf->offs + qf->size > b) {
+			++reass_stats.overlaps;
+			b = qf->offs + qf->size;
+		}
 
-		link = list_next(link, &rdg->frags);
+		link = odict_next(link, &rdg->frags);
 	}
 
-	if (link != NULL)
-		list_insert_after(&frag->dgram_link, link);
-	else
-		list_append(&frag->dgram_link, &rdg->frags);
+	if (b < e)
+		return reass_dgram_add_piece(rdg, packet, b, e);
 
 	return EOK;
 }
@@ -237,42 +403,63 @@ static errno_t reass_dgram_insert_frag(reass_dgram_t *rdg, inet_packet_t *packet
  */
 static bool reass_dgram_complete(reass_dgram_t *rdg)
 {
-	reass_frag_t *frag, *prev;
-	link_t *link;
-
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	assert(!list_empty(&rdg->frags));
+	/* Pieces do not overlap and lie within the datagram */
+	return rdg->have_last && rdg->received == rdg->size;
+}
 
-	link = list_first(&rdg->frags);
-	assert(link != NULL);
+/** Queue packet for datagram reassembly.
+ *
+ * @param packet	Packet
+ * @return		EOK on success, EINVAL if fragment was invalid
+ *			or ENOMEM.
+ */
+errno_t inet_reass_queue_packet(inet_packet_t *packet)
+{
+	reass_dgram_t *rdg;
+	errno_t rc;
 
-	frag = list_get_instance(link, reass_frag_t,
-	    dgram_link);
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_reass_queue_packet()");
 
-	/* First fragment must be at offset zero */
-	if (frag->packet.offs != 0)
-		return false;
+	fibril_mutex_lock(&reass_lock);
 
-	prev = frag;
+	/* Get existing or new datagram */
+	rdg = reass_dgram_get(packet);
+	if (rdg == NULL) {
+		++reass_stats.drops;
+		fibril_mutex_unlock(&reass_lock);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Allocation failed, packet dropped.");
+		return ENOMEM;
+	}
 
-	while (true) {
-		link = list_next(link, &rdg->frags);
-		if (link == NULL)
-			break;
+	/* Insert fragment into the datagram */
+	rc = reass_dgram_insert_frag(rdg, packet);
+	if (rc != EOK) {
+		if (odict_empty(&rdg->frags)) {
+			reass_dgram_remove(rdg);
+			reass_dgram_destroy(rdg);
+		}
 
-		/* Each next fragment must follow immediately or overlap */
-		frag = list_get_instance(link, reass_frag_t, dgram_link);
-		if (frag->packet.offs > prev->packet.offs + prev->packet.size)
-			return false;
+		++reass_stats.drops;
+		fibril_mutex_unlock(&reass_lock);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Fragment dropped.");
+		return rc;
+	}
 
-		/* No more fragments - datagram is complete */
-		if (!frag->packet.mf)
-			return true;
+	/* Check if datagram is complete */
+	if (reass_dgram_complete(rdg)) {
+		/* Remove it from the map */
+		reass_dgram_remove(rdg);
+		++reass_stats.reassembled;
+		fibril_mutex_unlock(&reass_lock);
 
-		prev = frag;
+		/* Deliver complete datagram */
+		rc = reass_dgram_deliver(rdg);
+		reass_dgram_destroy(rdg);
+		return rc;
 	}
 
-	return false;
+	fibril_mutex_unlock(&reass_lock);
+	return EOK;
 }
 
 /** Remove datagram from reassembly map.
@@ -281,8 +468,11 @@ static bool reass_dgram_complete(reass_dgram_t *rdg)
  */
 static void reass_dgram_remove(reass_dgram_t *rdg)
 {
-	assert(fibril_mutex_is_locked(&reass_dgram_map_lock));
-	list_remove(&rdg->map_link);
+	assert(fibril_mutex_is_locked(&reass_lock));
+	hash_table_remove_item(&reass_dgram_table, &rdg->htlink);
+	list_remove(&rdg->lru_link);
+	reass_mem -= rdg->mem;
+	--reass_stats.pending;
 }
 
 /** Deliver complete datagram.
@@ -291,70 +481,36 @@ static void reass_dgram_remove(reass_dgram_t *rdg)
  */
 static errno_t reass_dgram_deliver(reass_dgram_t *rdg)
 {
-	size_t dgram_size;
-	size_t fragoff_limit;
 	inet_dgram_t dgram;
-	uint8_t proto;
-	reass_frag_t *frag;
+	odlink_t *link;
 	errno_t rc;
 
-	/*
-	 * Potentially there could be something beyond the first packet
-	 * that has !MF. Make sure we ignore that.
-	 */
-	frag = NULL;
-	list_foreach(rdg->frags, dgram_link, reass_frag_t, cfrag) {
-		if (!cfrag->packet.mf) {
-			frag = cfrag;
-			break;
-		}
-	}
-
-	assert(frag != NULL);
-	assert(!frag->packet.mf);
-
-	dgram_size = frag->packet.offs + frag->packet.size;
-
-	/* Upper bound for fragment offset field */
-	fragoff_limit = 1 << (FF_FRAGOFF_h - FF_FRAGOFF_l + 1);
-
-	/* Verify that total size of datagram is within reasonable bounds */
-	if (dgram_size > FRAG_OFFS_UNIT * fragoff_limit)
-		return ELIMIT;
-
-	dgram.data = calloc(dgram_size, 1);
+	dgram.data = malloc(rdg->size);
 	if (dgram.data == NULL)
 		return ENOMEM;
 
 	/* XXX What if different fragments came from different link? */
-	dgram.iplink = frag->packet.link_id;
-	dgram.size = dgram_size;
-	dgram.src = frag->packet.src;
-	dgram.dest = frag->packet.dest;
-	dgram.tos = frag->packet.tos;
-	proto = frag->packet.proto;
-
-	/* Pull together data from individual fragments */
-
-	size_t doffs = 0;
-
-	list_foreach(rdg->frags, dgram_link, reass_frag_t, cfrag) {
-		size_t cb, ce;
-
-		cb = max(doffs, cfrag->packet.offs);
-		ce = min(dgram_size, cfrag->packet.offs + cfrag->packet.size);
-
-		if (ce > cb) {
-			memcpy(dgram.data + cb,
-			    cfrag->packet.data + cb - cfrag->packet.offs,
-			    ce - cb);
-		}
+	dgram.iplink = rdg->link_id;
+	dgram.size = rdg->size;
+	dgram.src = rdg->key.src;
+	dgram.dest = rdg->key.dest;
+	dgram.tos = rdg->tos;
+	dgram.csum = INET_CSUM_NONE;
+	dgram.csum_offs = 0;
+	dgram.tso_mss = 0;
+
+	/* Pull together data from individual pieces */
+	link = odict_first(&rdg->frags);
+	while (link != NULL) {
+		reass_frag_t *frag = odict_get_instance(link, reass_frag_t,
+		    lfrags);
 
-		if (!cfrag->packet.mf)
-			break;
+		memcpy((uint8_t *) dgram.data + frag->offs, frag->data,
+		    frag->size);
+		link = odict_next(link, &rdg->frags);
 	}
 
-	rc = inet_recv_dgram_local(&dgram, proto);
+	rc = inet_recv_dgram_local(&dgram, rdg->key.proto);
 	free(dgram.data);
 	return rc;
 }
@@ -365,18 +521,82 @@ static errno_t reass_dgram_deliver(reass_dgram_t *rdg)
  */
 static void reass_dgram_destroy(reass_dgram_t *rdg)
 {
-	while (!list_empty(&rdg->frags)) {
-		link_t *flink = list_first(&rdg->frags);
-		reass_frag_t *frag = list_get_instance(flink, reass_frag_t,
-		    dgram_link);
+	odlink_t *link;
 
-		list_remove(&frag->dgram_link);
-		free(frag->packet.data);
+	while ((link = odict_first(&rdg->frags)) != NULL) {
+		reass_frag_t *frag = odict_get_instance(link, reass_frag_t,
+		    lfrags);
+
+		odict_remove(&frag->lfrags);
 		free(frag);
 	}
 
 	free(rdg);
 }
 
+/** Reassembly timer handler.
+ *
+ * Discard datagrams that have not been completed in time.
+ *
+ * @param arg Not used
+ */
+static void reass_timer_handler(void *arg)
+{
+	usec_t now = reass_now();
+
+	fibril_mutex_lock(&reass_lock);
+
+	/* Datagrams in LRU list are ordered by expiration time */
+	while (!list_empty(&reass_dgram_lru)) {
+		reass_dgram_t *rdg = list_get_instance(
+		    list_first(&reass_dgram_lru), reass_dgram_t, lru_link);
+
+		if (rdg->expires > now)
+			break;
+
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Reassembly timed out.");
+		reass_dgram_remove(rdg);
+		reass_dgram_destroy(rdg);
+		++reass_stats.timeouts;
+	}
+
+	fibril_mutex_unlock(&reass_lock);
+
+	fibril_timer_set(reass_timer, REASS_TIMER_INTERVAL,
+	    reass_timer_handler, NULL);
+}
+
+/** Initialize datagram reassembly.
+ *
+ * @return EOK on success or ENOMEM
+ */
+errno_t inet_reass_init(void)
+{
+	if (!hash_table_create(&reass_dgram_table, 0, 0, &reass_ht_ops))
+		return ENOMEM;
+
+	reass_timer = fibril_timer_create(NULL);
+	if (reass_timer == NULL) {
+		hash_table_destroy(&reass_dgram_table);
+		return ENOMEM;
+	}
+
+	fibril_timer_set(reass_timer, REASS_TIMER_INTERVAL,
+	    reass_timer_handler, NULL);
+	return EOK;
+}
+
+/** Get datagram reassembly statistics.
+ *
+ * @param stats Place to store statistics
+ */
+void inet_reass_get_stats(inet_reass_stats_t *stats)
+{
+	fibril_mutex_lock(&reass_lock);
+	*stats = reass_stats;
+	stats->mem_used = reass_mem;
+	fibril_mutex_unlock(&reass_lock);
+}
+
 /** @}
  */
@@ -37,9 +37,12 @@
 #ifndef INET_REASS_H_
 #define INET_REASS_H_
 
+#include <types/inetcfg.h>
 #include "inetsrv.h"
 
+extern errno_t inet_reass_init(void);
 extern errno_t inet_reass_queue_packet(inet_packet_t *);
+extern void inet_reass_get_stats(inet_reass_stats_t *);
 
 #endif
 
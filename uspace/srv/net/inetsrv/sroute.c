@@ -34,21 +34,320 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <assert.h>
 #include <bitops.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <ipc/loc.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <str.h>
 #include "sroute.h"
 #include "inetsrv.h"
 #include "inet_link.h"
 
+/** Number of entries in the next-hop cache */
+#define SROUTE_CACHE_SIZE  64
+
+/** Routing trie node.
+ *
+ * Path-compressed binary trie over destination prefixes. Each node
+ * holds the routes whose destination is exactly its prefix (possibly
+ * none, for nodes that only join two subtrees).
+ */
+typedef struct inet_rtrie_node {
+	/** Subtrees for next bit 0 and 1 */
+	struct inet_rtrie_node *child[2];
+	/** Prefix, most significant bit first, bits past @c plen are zero */
+	addr128_t key;
+	/** Prefix length in bits */
+	uint8_t plen;
+	/** Routes with this destination */
+	list_t routes; /* of inet_sroute_t */
+} inet_rtrie_node_t;
+
+/** Next-hop cache entry */
+typedef struct {
+	/** Destination address */
+	inet_addr_t addr;
+	/** Matching route or @c NULL if there is none */
+	inet_sroute_t *sroute;
+	/** Entry is valid */
+	bool valid;
+} inet_sroute_cache_t;
+
 static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
 static sysarg_t sroute_id = 0;
 
+/** Routing trie roots for IPv4 and IPv6 */
+static inet_rtrie_node_t *sroute_trie4;
+static inet_rtrie_node_t *sroute_trie6;
+
+/** Results of recent lookups, invalidated whenever routes change */
+static inet_sroute_cache_t sroute_cache[SROUTE_CACHE_SIZE];
+
+/** Get routing trie key of an address.
+ *
+ * @param ver  IP version
+ * @param a4   IPv4 address
+ * @param a6   IPv6 address
+ * @param key  Place to store key
+ * @param root Place to store pointer to root of the trie for @a ver
+ * @param bits Place to store number of address bits
+ *
+ * @return EOK on success, EINVAL if @a ver is not IPv4 or IPv6
+ */
+static errno_t inet_rtrie_key(ip_ver_t ver, addr32_t a4, addr128_t a6,
+    addr128_t key, inet_rtrie_node_t ***root, uint8_t *bits)
+{
+	memset(key, 0, sizeof(addr128_t));
+
+	switch (ver) {
+	case ip_v4:
+		key[0] = a4 >> 24;
+		key[1] = (a4 >> 16) & 0xff;
+		key[2] = (a4 >> 8) & 0xff;
+		key[3] = a4 & 0xff;
+		*root = &sroute_trie4;
+		*bits = 32;
+		return EOK;
+	case ip_v6:
+		memcpy(key, a6, sizeof(addr128_t));
+		*root = &sroute_trie6;
+		*bits = 128;
+		return EOK;
+	default:
+		return EINVAL;
+	}
+}
+
+/** Get bit of a routing trie key.
+ *
+ * @param key Key
+ * @param i   Bit index, 0 is the most significant bit
+ * @return Value of the bit
+ */
+static unsigned inet_rtrie_bit(const addr128_t key, unsigned i)
+{
+	return (key[i / 8] >> (7 - i % 8)) & 1;
+}
+
+/** Get length of common prefix of two keys.
+ *
+ * @param a   First key
+ * @param b   Second key
+ * @param max Maximum number of bits to compare
+ * @return Number of leading bits that are equal, at most @a max
+ */
+static unsigned inet_rtrie_common(const addr128_t a, const addr128_t b,
+    unsigned max)
+{
+	unsigned i;
+
+	for (i = 0; i < max; i += 8) {
+		uint8_t x = a[i / 8] ^ b[i / 8];
+
+		if (x != 0) {
+			while ((x & 0x80) == 0) {
+				x <<= 1;
+				i++;
+			}
+			return min(i, max);
+		}
+	}
+
+	return max;
+}
+
+/** Create routing trie node.
+ *
+ * @param key  Key, only the first @a plen bits are used
+ * @param plen Prefix length
+ * @return New node or @c NULL if out of memory
+ */
+static inet_rtrie_node_t *inet_rtrie_node_create(const addr128_t key,
+    unsigned plen)
+{
+	inet_rtrie_node_t *node;
+
+	node = calloc(1, sizeof(inet_rtrie_node_t));
+	if (node == NULL)
+		return NULL;
+
+	for (unsigned i = 0; i < plen; i++) {
+		if (inet_rtrie_bit(key, i))
+			node->key[i / 8] |= 0x80 >> (i % 8);
+	}
+
+	node->plen = plen;
+	list_initialize(&node->routes);
+	return node;
+}
+
+/** Insert route into routing trie.
+ *
+ * @param pnode Pointer to root of the (sub)trie
+ * @param key   Destination prefix
+ * @param plen  Prefix length
+ * @param sroute Static route
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t inet_rtrie_insert(inet_rtrie_node_t **pnode,
+    const addr128_t key, unsigned plen, inet_sroute_t *sroute)
+{
+	inet_rtrie_node_t *node;
+	inet_rtrie_node_t *nnode;
+	inet_rtrie_node_t *leaf;
+	unsigned common;
+
+	while (*pnode != NULL) {
+		node = *pnode;
+		common = inet_rtrie_common(node->key, key, min(plen,
+		    node->plen));
+
+		if (common == node->plen) {
+			if (plen == node->plen) {
+				/* Exact match */
+				list_append(&sroute->rnode_link, &node->routes);
+				sroute->rnode = node;
+				return EOK;
+			}
+
+			pnode = &node->child[inet_rtrie_bit(key, node->plen)];
+			continue;
+		}
+
+		/* Prefixes diverge within @a node, split it */
+		nnode = inet_rtrie_node_create(key, common);
+		if (nnode == NULL)
+			return ENOMEM;
+
+		if (common == plen) {
+			/* New route is a prefix of @a node */
+			list_append(&sroute->rnode_link, &nnode->routes);
+			sroute->rnode = nnode;
+		} else {
+			leaf = inet_rtrie_node_create(key, plen);
+			if (leaf == NULL) {
+				free(nnode);
+				return ENOMEM;
+			}
+
+			list_append(&sroute->rnode_link, &leaf->routes);
+			sroute->rnode = leaf;
+			nnode->child[inet_rtrie_bit(key, common)] = leaf;
+		}
+
+		nnode->child[inet_rtrie_bit(node->key, common)] = node;
+		*pnode = nnode;
+		return EOK;
+	}
+
+	leaf = inet_rtrie_node_create(key, plen);
+	if (leaf == NULL)
+		return ENOMEM;
+
+	list_append(&sroute->rnode_link, &leaf->routes);
+	sroute->rnode = leaf;
+	*pnode = leaf;
+	return EOK;
+}
+
+/** Remove route from routing trie.
+ *
+ * Nodes left without routes and with less than two subtrees are
+ * removed on the way back up.
+ *
+ * @param pnode  Pointer to root of the (sub)trie
+ * @param sroute Static route
+ */
+static void inet_rtrie_remove(inet_rtrie_node_t **pnode, inet_sroute_t *sroute)
+{
+	inet_rtrie_node_t *node = *pnode;
+	inet_rtrie_node_t *target = sroute->rnode;
+
+	assert(node != NULL);
+
+	if (node == target) {
+		list_remove(&sroute->rnode_link);
+		sroute->rnode = NULL;
+	} else {
+		assert(target->plen > node->plen);
+		inet_rtrie_remove(&node->child[inet_rtrie_bit(target->key,
+		    node->plen)], sroute);
+	}
+
+	if (!list_empty(&node->routes))
+		return;
+
+	if (node->child[0] != NULL && node->child[1] != NULL)
+		return;
+
+	*pnode = node->child[0] != NULL ? node->child[0] : node->child[1];
+	free(node);
+}
+
+/** Find most specific route in routing trie.
+ *
+ * @param node Root of the trie
+ * @param key  Address
+ * @param bits Number of address bits
+ * @return Route or @c NULL if not found
+ */
+static inet_sroute_t *inet_rtrie_find(inet_rtrie_node_t *node,
+    const addr128_t key, unsigned bits)
+{
+	inet_sroute_t *best = NULL;
+
+	while (node != NULL) {
+		if (inet_rtrie_common(node->key, key, node->plen) != node->plen)
+			break;
+
+		if (!list_empty(&node->routes)) {
+			best = list_get_instance(list_first(&node->routes),
+			    inet_sroute_t, rnode_link);
+		}
+
+		if (node->plen >= bits)
+			break;
+
+		node = node->child[inet_rtrie_bit(key, node->plen)];
+	}
+
+	return best;
+}
+
+/** Get next-hop cache entry for an address.
+ *
+ * @param addr Address
+ * @return Cache entry
+ */
+static inet_sroute_cache_t *inet_sroute_cache_entry(inet_addr_t *addr)
+{
+	size_t hash;
+
+	hash = addr->version;
+	if (addr->version == ip_v4) {
+		hash = hash_combine(hash, addr->addr);
+	} else {
+		for (size_t i = 0; i < sizeof(addr128_t); i++)
+			hash = hash_combine(hash, addr->addr6[i]);
+	}
+
+	return &sroute_cache[hash_mix(hash) % SROUTE_CACHE_SIZE];
+}
+
+/** Invalidate the next-hop cache. */
+static void inet_sroute_cache_clear(void)
+{
+	memset(sroute_cache, 0, sizeof(sroute_cache));
+}
+
 inet_sroute_t *inet_sroute_new(void)
 {
 	inet_sroute_t *sroute = calloc(1, sizeof(inet_sroute_t));
@@ -60,6 +359,7 @@ inet_sroute_t *inet_sroute_new(void)
 	}
 
 	link_initialize(&sroute->sroute_list);
+	link_initialize(&sroute->rnode_link);
 	fibril_mutex_lock(&sroute_list_lock);
 	sroute->id = ++sroute_id;
 	fibril_mutex_unlock(&sroute_list_lock);
@@ -74,57 +374,108 @@ void inet_sroute_delete(inet_sroute_t *sroute)
 	free(sroute);
 }
 
-void inet_sroute_add(inet_sroute_t *sroute)
+/** Add static route.
+ *
+ * @param sroute Static route
+ * @return EOK on success, ENOMEM if out of memory
+ */
+errno_t inet_sroute_add(inet_sroute_t *sroute)
 {
+	inet_rtrie_node_t **root;
+	addr32_t a4;
+	addr128_t a6;
+	addr128_t key;
+	uint8_t plen;
+	uint8_t bits;
+	ip_ver_t ver;
+	errno_t rc;
+
+	ver = inet_naddr_get(&sroute->dest, &a4, &a6, &plen);
+
 	fibril_mutex_lock(&sroute_list_lock);
+
+	/* Routes that can never match are only kept in the list */
+	rc = inet_rtrie_key(ver, a4, a6, key, &root, &bits);
+	if (rc == EOK && plen <= bits) {
+		rc = inet_rtrie_insert(root, key, plen, sroute);
+		if (rc != EOK) {
+			fibril_mutex_unlock(&sroute_list_lock);
+			return rc;
+		}
+	}
+
 	list_append(&sroute->sroute_list, &sroute_list);
+	inet_sroute_cache_clear();
 	fibril_mutex_unlock(&sroute_list_lock);
+	return EOK;
 }
 
 void inet_sroute_remove(inet_sroute_t *sroute)
 {
+	inet_rtrie_node_t **root;
+	addr32_t a4;
+	addr128_t a6;
+	addr128_t key;
+	uint8_t plen;
+	uint8_t bits;
+	ip_ver_t ver;
+
 	fibril_mutex_lock(&sroute_list_lock);
+
+	if (sroute->rnode != NULL) {
+		ver = inet_naddr_get(&sroute->dest, &a4, &a6, &plen);
+		(void) inet_rtrie_key(ver, a4, a6, key, &root, &bits);
+		inet_rtrie_remove(root, sroute);
+	}
+
 	list_remove(&sroute->sroute_list);
+	inet_sroute_cache_clear();
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
 /** Find static route object matching address @a addr.
+ *
+ * Returns the route with the longest destination prefix containing
+ * @a addr. Among routes with the same destination the one added first
+ * is used.
  *
  * @param addr	Address
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
-	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
+	inet_sroute_cache_t *cent;
+	inet_rtrie_node_t **root;
+	inet_sroute_t *best;
+	addr32_t a4;
+	addr128_t a6;
+	addr128_t key;
+	uint8_t bits;
+	ip_ver_t ver;
 
 	fibril_mutex_lock(&sroute_list_lock);
 
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
-
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
-
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
+	cent = inet_sroute_cache_entry(addr);
+	if (cent->valid && inet_addr_compare(&cent->addr, addr)) {
+		best = cent->sroute;
+		fibril_mutex_unlock(&sroute_list_lock);
+		return best;
+	}
 
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
+	best = NULL;
+	ver = inet_addr_get(addr, &a4, &a6);
+	if (inet_rtrie_key(ver, a4, a6, key, &root, &bits) == EOK)
+		best = inet_rtrie_find(*root, key, bits);
 
-			best = sroute;
-			best_bits = dest_bits;
-		}
+	if (best != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found %p",
+		    best);
+	} else {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
 	}
 
-	if (best == NULL)
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
+	cent->addr = *addr;
+	cent->sroute = best;
+	cent->valid = true;
 
 	fibril_mutex_unlock(&sroute_list_lock);
 
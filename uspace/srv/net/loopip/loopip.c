@@ -55,6 +55,7 @@ static errno_t loopip_close(iplink_srv_t *srv);
 static errno_t loopip_send(iplink_srv_t *srv, iplink_sdu_t *sdu);
 static errno_t loopip_send6(iplink_srv_t *srv, iplink_sdu6_t *sdu);
 static errno_t loopip_get_mtu(iplink_srv_t *srv, size_t *mtu);
+static errno_t loopip_get_offload(iplink_srv_t *srv, uint32_t *offload);
 static errno_t loopip_get_mac48(iplink_srv_t *srv, eth_addr_t *mac);
 static errno_t loopip_addr_add(iplink_srv_t *srv, inet_addr_t *addr);
 static errno_t loopip_addr_remove(iplink_srv_t *srv, inet_addr_t *addr);
@@ -69,7 +70,8 @@ static iplink_ops_t loopip_iplink_ops = {
 	.get_mtu = loopip_get_mtu,
 	.get_mac48 = loopip_get_mac48,
 	.addr_add = loopip_addr_add,
-	.addr_remove = loopip_addr_remove
+	.addr_remove = loopip_addr_remove,
+	.get_offload = loopip_get_offload
 };
 
 static iplink_srv_t loopip_iplink;
@@ -186,6 +188,8 @@ static errno_t loopip_send(iplink_srv_t *srv, iplink_sdu_t *sdu)
 
 	memcpy(rqe->sdu.data, sdu->data, sdu->size);
 	rqe->sdu.size = sdu->size;
+	/* The packet never leaves memory, no need to verify checksums */
+	rqe->sdu.offload = IPLINK_OFFLOAD_RX_CSUM;
 
 	/*
 	 * Insert to receive queue
@@ -215,6 +219,8 @@ static errno_t loopip_send6(iplink_srv_t *srv, iplink_sdu6_t *sdu)
 
 	memcpy(rqe->sdu.data, sdu->data, sdu->size);
 	rqe->sdu.size = sdu->size;
+	/* The packet never leaves memory, no need to verify checksums */
+	rqe->sdu.offload = IPLINK_OFFLOAD_RX_CSUM;
 
 	/*
 	 * Insert to receive queue
@@ -231,6 +237,15 @@ static errno_t loopip_get_mtu(iplink_srv_t *srv, size_t *mtu)
 	return EOK;
 }
 
+static errno_t loopip_get_offload(iplink_srv_t *srv, uint32_t *offload)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "loopip_get_offload()");
+	/* Checksums need not be filled in nor packets segmented */
+	*offload = IPLINK_OFFLOAD_RX_CSUM | IPLINK_OFFLOAD_TX_CSUM |
+	    IPLINK_OFFLOAD_TSO;
+	return EOK;
+}
+
 static errno_t loopip_get_mac48(iplink_srv_t *src, eth_addr_t *mac)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "loopip_get_mac48()");
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup tcp
+ * @{
+ */
+
+/**
+ * @file TCP congestion control
+ *
+ * Congestion window management according to RFC 5681 with the NewReno
+ * modification to fast recovery (RFC 6582), optionally using CUBIC
+ * (RFC 8312) for congestion avoidance. Retransmission timeout is computed
+ * from round-trip time samples as described in RFC 6298.
+ */
+
+#include <io/log.h>
+#include <macros.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "cc.h"
+#include "tqueue.h"
+#include "tcp_type.h"
+
+/** Initial congestion window (RFC 5681 section 3.1) */
+#define CC_IW min(4 * TCP_SMSS, max(2 * TCP_SMSS, 4380))
+/** Upper bound on the congestion window */
+#define CC_CWND_MAX (UINT32_MAX / 2)
+/** Number of duplicate ACKs that trigger fast retransmit */
+#define CC_DUPACK_THRESH 3
+
+/** Initial retransmission timeout */
+#define CC_RTO_INIT (1000 * 1000)
+/** Lower bound on the retransmission timeout */
+#define CC_RTO_MIN (1000 * 1000)
+/** Upper bound on the retransmission timeout */
+#define CC_RTO_MAX (60 * 1000 * 1000)
+/** Clock granularity */
+#define CC_CLOCK_G 1000
+
+/** CUBIC multiplicative decrease factor (tenths) */
+#define CUBIC_BETA 7
+/** Bound on the CUBIC time offset (milliseconds) */
+#define CUBIC_T_MAX 100000
+
+/** Congestion control algorithm used by new connections */
+tcp_cc_alg_t tcp_cc_default = tcp_cc_newreno;
+
+static usec_t tcp_cc_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec);
+}
+
+/** Number of bytes sent but not yet acknowledged. */
+static uint32_t tcp_cc_flight(tcp_conn_t *conn)
+{
+	return conn->snd_nxt - conn->snd_una;
+}
+
+/** Integer cube root. */
+static uint32_t tcp_cc_icbrt(uint64_t x)
+{
+	uint64_t lo = 0;
+	uint64_t hi = 1 << 21;
+	uint64_t mid;
+
+	/* Largest r such that r^3 <= x, (2^21)^3 does not fit */
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (mid * mid * mid <= x)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return lo;
+}
+
+/** Initialize congestion control state of a new connection.
+ *
+ * @param conn Connection
+ */
+void tcp_cc_init(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	cc->alg = tcp_cc_default;
+	cc->cwnd = CC_IW;
+	cc->ssthresh = UINT32_MAX;
+	cc->una = conn->snd_una;
+	cc->dupacks = 0;
+	cc->recovery = false;
+	cc->recover = 0;
+	cc->bytes_acked = 0;
+
+	cc->w_max = 0;
+	cc->epoch_start = 0;
+	cc->k = 0;
+	cc->w_est = 0;
+
+	cc->srtt = 0;
+	cc->rttvar = 0;
+	cc->rto = CC_RTO_INIT;
+	cc->rtt_valid = false;
+	cc->rtt_timing = false;
+}
+
+/** Synchronize congestion control state with the initial send sequence.
+ *
+ * Called when SND.UNA has been set to ISS.
+ *
+ * @param conn Connection
+ */
+void tcp_cc_sync(tcp_conn_t *conn)
+{
+	conn->cc.una = conn->snd_una;
+	conn->cc.recover = conn->snd_una;
+}
+
+/** Number of sequence numbers the congestion window allows to send.
+ *
+ * @param conn Connection
+ * @return Free space in the congestion window
+ */
+uint32_t tcp_cc_avail(tcp_conn_t *conn)
+{
+	uint32_t flight = tcp_cc_flight(conn);
+
+	if (flight >= conn->cc.cwnd)
+		return 0;
+
+	return conn->cc.cwnd - flight;
+}
+
+/** Note that a segment has been transmitted.
+ *
+ * Starts timing a round-trip if none is being timed. Retransmitted
+ * segments are never timed and cancel timing in progress (Karn's algorithm).
+ *
+ * @param conn       Connection
+ * @param seg        Segment
+ * @param retransmit @c true if @a seg is a retransmission
+ */
+void tcp_cc_seg_sent(tcp_conn_t *conn, tcp_segment_t *seg, bool retransmit)
+{
+	if (retransmit) {
+		conn->cc.rtt_timing = false;
+		return;
+	}
+
+	if (conn->cc.rtt_timing || seg->len == 0)
+		return;
+
+	conn->cc.rtt_timing = true;
+	conn->cc.rtt_seq = seg->seq + seg->len;
+	conn->cc.rtt_start = tcp_cc_now();
+}
+
+/** Update RTT estimate with a new sample and recompute RTO.
+ *
+ * @param conn Connection
+ * @param r    Round-trip time sample (microseconds)
+ */
+void tcp_cc_rtt_sample(tcp_conn_t *conn, usec_t r)
+{
+	tcp_cc_t *cc = &conn->cc;
+	usec_t delta;
+
+	if (!cc->rtt_valid) {
+		cc->srtt = r;
+		cc->rttvar = r / 2;
+		cc->rtt_valid = true;
+	} else {
+		delta = cc->srtt > r ? cc->srtt - r : r - cc->srtt;
+		cc->rttvar = (3 * cc->rttvar + delta) / 4;
+		cc->srtt = (7 * cc->srtt + r) / 8;
+	}
+
+	cc->rto = cc->srtt + max(CC_CLOCK_G, 4 * cc->rttvar);
+	if (cc->rto < CC_RTO_MIN)
+		cc->rto = CC_RTO_MIN;
+	if (cc->rto > CC_RTO_MAX)
+		cc->rto = CC_RTO_MAX;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: SRTT=%lld RTTVAR=%lld RTO=%lld",
+	    conn->name, (long long) cc->srtt, (long long) cc->rttvar,
+	    (long long) cc->rto);
+}
+
+/** Current value of the timestamp clock.
+ *
+ * @return Timestamp clock value (milliseconds)
+ */
+uint32_t tcp_cc_ts_now(void)
+{
+	return (uint32_t) (tcp_cc_now() / 1000);
+}
+
+/** Take a round-trip time sample from an echoed timestamp (RFC 7323).
+ *
+ * Supersedes timing of the segment, if any.
+ *
+ * @param conn  Connection
+ * @param tsecr Timestamp echo reply from an acknowledgement
+ */
+void tcp_cc_ts_ack(tcp_conn_t *conn, uint32_t tsecr)
+{
+	uint32_t delta;
+
+	delta = tcp_cc_ts_now() - tsecr;
+	if ((int32_t) delta < 0)
+		return;
+
+	conn->cc.rtt_timing = false;
+	tcp_cc_rtt_sample(conn, (usec_t) delta * 1000);
+}
+
+/** Reduce slow start threshold in response to a loss. */
+static void tcp_cc_loss(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	if (cc->alg == tcp_cc_cubic) {
+		/* Fast convergence */
+		if (cc->cwnd < cc->w_max)
+			cc->w_max = (uint64_t) cc->cwnd * (10 + CUBIC_BETA) / 20;
+		else
+			cc->w_max = cc->cwnd;
+
+		cc->ssthresh = max((uint64_t) cc->cwnd * CUBIC_BETA / 10,
+		    2 * TCP_SMSS);
+		cc->epoch_start = 0;
+	} else {
+		cc->ssthresh = max(tcp_cc_flight(conn) / 2, 2 * TCP_SMSS);
+	}
+
+	cc->bytes_acked = 0;
+}
+
+/** CUBIC window growth in congestion avoidance.
+ *
+ * @param conn  Connection
+ * @param acked Number of newly acknowledged bytes
+ */
+static void tcp_cc_cubic_ack(tcp_conn_t *conn, uint32_t acked)
+{
+	tcp_cc_t *cc = &conn->cc;
+	usec_t now = tcp_cc_now();
+	int64_t t, target;
+	uint64_t inc;
+
+	if (cc->epoch_start == 0) {
+		cc->epoch_start = now;
+		if (cc->cwnd < cc->w_max) {
+			/* K = cbrt((W_max - cwnd) / C) with C = 0.4 */
+			cc->k = tcp_cc_icbrt((uint64_t) (cc->w_max - cc->cwnd) *
+			    1000 / TCP_SMSS * 2500000);
+		} else {
+			cc->k = 0;
+			cc->w_max = cc->cwnd;
+		}
+
+		cc->w_est = cc->cwnd;
+	}
+
+	/* Time offset from K one RTT from now, in milliseconds */
+	t = (now - cc->epoch_start + cc->srtt) / 1000 - cc->k;
+	if (t > CUBIC_T_MAX)
+		t = CUBIC_T_MAX;
+	if (t < -CUBIC_T_MAX)
+		t = -CUBIC_T_MAX;
+
+	/* W_cubic(t) = C * t^3 + W_max */
+	target = (int64_t) cc->w_max + 4 * TCP_SMSS * t * t * t / 10000000000LL;
+	if (target < 0)
+		target = 0;
+
+	/* TCP-friendly region, alpha = 3 * (1 - beta) / (1 + beta) */
+	cc->w_est += (uint64_t) acked * TCP_SMSS * 3 * (10 - CUBIC_BETA) /
+	    ((10 + CUBIC_BETA) * (uint64_t) cc->cwnd);
+	if (target < cc->w_est)
+		target = cc->w_est;
+
+	if (target > (int64_t) cc->cwnd * 3 / 2)
+		target = (int64_t) cc->cwnd * 3 / 2;
+
+	if (target > cc->cwnd) {
+		inc = (uint64_t) (target - cc->cwnd) * acked / cc->cwnd;
+	} else {
+		/* Grow very slowly around the plateau */
+		inc = (uint64_t) acked * TCP_SMSS / (100 * (uint64_t) cc->cwnd);
+	}
+
+	cc->cwnd = min(cc->cwnd + inc, CC_CWND_MAX);
+}
+
+/** Update congestion state after SND.UNA has advanced.
+ *
+ * @param conn Connection
+ */
+void tcp_cc_ack(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+	uint32_t acked;
+
+	acked = conn->snd_una - cc->una;
+	if (acked == 0 || acked > conn->snd_nxt - cc->una) {
+		cc->una = conn->snd_una;
+		return;
+	}
+
+	cc->una = conn->snd_una;
+	cc->dupacks = 0;
+
+	if (cc->rtt_timing && (int32_t) (conn->snd_una - cc->rtt_seq) >= 0) {
+		cc->rtt_timing = false;
+		tcp_cc_rtt_sample(conn, tcp_cc_now() - cc->rtt_start);
+	}
+
+	if (cc->recovery) {
+		if ((int32_t) (conn->snd_una - cc->recover) >= 0) {
+			/* Full acknowledgement, leave fast recovery */
+			cc->recovery = false;
+			cc->cwnd = cc->ssthresh;
+		} else {
+			/* Partial acknowledgement, retransmit next segment */
+			tcp_tqueue_retransmit(conn);
+			cc->cwnd = cc->cwnd > acked ? cc->cwnd - acked : 0;
+			if (acked >= TCP_SMSS)
+				cc->cwnd += TCP_SMSS;
+			cc->cwnd = max(cc->cwnd, TCP_SMSS);
+		}
+
+		return;
+	}
+
+	if (cc->cwnd < cc->ssthresh) {
+		/* Slow start */
+		cc->cwnd = min(cc->cwnd + min(acked, TCP_SMSS), CC_CWND_MAX);
+		return;
+	}
+
+	/* Congestion avoidance */
+	if (cc->alg == tcp_cc_cubic) {
+		tcp_cc_cubic_ack(conn, acked);
+		return;
+	}
+
+	cc->bytes_acked += acked;
+	if (cc->bytes_acked >= cc->cwnd) {
+		cc->bytes_acked -= cc->cwnd;
+		cc->cwnd = min(cc->cwnd + TCP_SMSS, CC_CWND_MAX);
+	}
+}
+
+/** Process a duplicate acknowledgement.
+ *
+ * The third duplicate ACK triggers fast retransmit and enters fast
+ * recovery, further ones inflate the congestion window.
+ *
+ * @param conn Connection
+ */
+void tcp_cc_dupack(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	++cc->dupacks;
+
+	if (cc->recovery) {
+		cc->cwnd = min(cc->cwnd + TCP_SMSS, CC_CWND_MAX);
+
+		/* With SACK, fill the next hole below the highest SACKed data */
+		if (conn->sack_ok)
+			tcp_tqueue_sack_retransmit(conn);
+		return;
+	}
+
+	if (cc->dupacks != CC_DUPACK_THRESH)
+		return;
+
+	/* Do not enter recovery again for losses from the previous window */
+	if ((int32_t) (conn->snd_una - cc->recover) < 0)
+		return;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: fast retransmit", conn->name);
+
+	tcp_cc_loss(conn);
+	cc->recovery = true;
+	cc->recover = conn->snd_nxt;
+	cc->cwnd = cc->ssthresh + CC_DUPACK_THRESH * TCP_SMSS;
+
+	tcp_tqueue_retransmit(conn);
+}
+
+/** Update congestion state after retransmission timeout.
+ *
+ * @param conn Connection
+ */
+void tcp_cc_timeout(tcp_conn_t *conn)
+{
+	tcp_cc_t *cc = &conn->cc;
+
+	tcp_cc_loss(conn);
+	cc->cwnd = TCP_SMSS;
+	cc->recovery = false;
+	cc->recover = conn->snd_nxt;
+	cc->dupacks = 0;
+	cc->rtt_timing = false;
+
+	/* Back off the timer */
+	cc->rto = min(cc->rto * 2, CC_RTO_MAX);
+}
+
+/**
+ * @}
+ */
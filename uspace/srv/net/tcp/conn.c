@@ -36,41 +36,54 @@
 
 #include <adt/list.h>
 #include <errno.h>
+#include <fibril.h>
 #include <inet/endpoint.h>
 #include <io/log.h>
 #include <macros.h>
 #include <nettl/amap.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
 #include "iqueue.h"
+#include "ncsim.h"
 #include "pdu.h"
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
 #include "tcp_type.h"
+#include "timer.h"
 #include "tqueue.h"
 #include "ucall.h"
 
-#define RCV_BUF_SIZE 4096/*2*/
-#define SND_BUF_SIZE 4096
+#define RCV_BUF_SIZE (256 * 1024)
+#define SND_BUF_SIZE (256 * 1024)
 
 #define MAX_SEGMENT_LIFETIME	(15*1000*1000) //(2*60*1000*1000)
 #define TIME_WAIT_TIMEOUT	(2*MAX_SEGMENT_LIFETIME)
 
+/** Number of attempts to lock all connections for getting information */
+#define TCP_CONN_INFO_ATTEMPTS 100
+/** Delay before the next attempt to lock all connections (microseconds) */
+#define TCP_CONN_INFO_RETRY 1000
+
 /** List of all allocated connections */
 static LIST_INITIALIZE(conn_list);
+
 /** Taken after tcp_conn_t lock */
 static FIBRIL_MUTEX_INITIALIZE(conn_list_lock);
 /** Connection association map */
 static amap_t *amap;
-/** Taken after tcp_conn_t lock */
-static FIBRIL_MUTEX_INITIALIZE(amap_lock);
+/** Taken after tcp_conn_t lock. Lookups only take it for reading. */
+static FIBRIL_RWLOCK_INITIALIZE(amap_lock);
 
 /** Internal loopback configuration */
 tcp_lb_t tcp_conn_lb = tcp_lb_none;
 
+/** Leave checksums and segmentation to the network layer */
+bool tcp_conn_offload = false;
+
 static void tcp_conn_seg_process(tcp_conn_t *, tcp_segment_t *);
 static void tcp_conn_tw_timer_set(tcp_conn_t *);
 static void tcp_conn_tw_timer_clear(tcp_conn_t *);
@@ -122,9 +135,7 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 
 	fibril_mutex_initialize(&conn->lock);
 
-	conn->tw_timer = fibril_timer_create(&conn->lock);
-	if (conn->tw_timer == NULL)
-		goto error;
+	tcp_timer_init(&conn->tw_timer);
 
 	/* One for the user, one for not being in closed state */
 	refcount_init(&conn->refcnt);
@@ -152,6 +163,12 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 	/* Set up receive window. */
 	conn->rcv_wnd = conn->rcv_buf_size;
 
+	/* Smallest window scale that lets us advertise the whole buffer */
+	conn->rcv_wscale = 0;
+	while ((conn->rcv_buf_size >> conn->rcv_wscale) > UINT16_MAX &&
+	    conn->rcv_wscale < TCP_WSCALE_MAX)
+		++conn->rcv_wscale;
+
 	/* Initialize incoming segment queue */
 	tcp_iqueue_init(&conn->incoming, conn);
 
@@ -163,6 +180,9 @@ tcp_conn_t *tcp_conn_new(inet_ep2_t *epp)
 
 	tqueue_inited = true;
 
+	/* Initialize congestion control */
+	tcp_cc_init(conn);
+
 	/* Connection state change signalling */
 	fibril_condvar_initialize(&conn->cstate_cv);
 
@@ -189,8 +209,6 @@ error:
 		free(conn->rcv_buf);
 	if (conn != NULL && conn->snd_buf != NULL)
 		free(conn->snd_buf);
-	if (conn != NULL && conn->tw_timer != NULL)
-		fibril_timer_destroy(conn->tw_timer);
 	if (conn != NULL)
 		free(conn);
 
@@ -225,8 +243,7 @@ static void tcp_conn_free(tcp_conn_t *conn)
 		free(conn->rcv_buf);
 	if (conn->snd_buf != NULL)
 		free(conn->snd_buf);
-	if (conn->tw_timer != NULL)
-		fibril_timer_destroy(conn->tw_timer);
+	tcp_timer_fini(&conn->tw_timer);
 	free(conn);
 }
 
@@ -310,20 +327,20 @@ errno_t tcp_conn_add(tcp_conn_t *conn)
 	errno_t rc;
 
 	tcp_conn_addref(conn);
-	fibril_mutex_lock(&amap_lock);
+	fibril_rwlock_write_lock(&amap_lock);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_add: conn=%p", conn);
 
 	rc = amap_insert(amap, &conn->ident, conn, af_allow_system, &aepp);
 	if (rc != EOK) {
 		tcp_conn_delref(conn);
-		fibril_mutex_unlock(&amap_lock);
+		fibril_rwlock_write_unlock(&amap_lock);
 		return rc;
 	}
 
 	conn->ident = aepp;
 	conn->mapped = true;
-	fibril_mutex_unlock(&amap_lock);
+	fibril_rwlock_write_unlock(&amap_lock);
 
 	return EOK;
 }
@@ -337,10 +354,10 @@ static void tcp_conn_remove(tcp_conn_t *conn)
 	if (!conn->mapped)
 		return;
 
-	fibril_mutex_lock(&amap_lock);
+	fibril_rwlock_write_lock(&amap_lock);
 	amap_remove(amap, &conn->ident);
 	conn->mapped = false;
-	fibril_mutex_unlock(&amap_lock);
+	fibril_rwlock_write_unlock(&amap_lock);
 	tcp_conn_delref(conn);
 }
 
@@ -383,6 +400,7 @@ void tcp_conn_sync(tcp_conn_t *conn)
 	conn->iss = 1;
 	conn->snd_nxt = conn->iss;
 	conn->snd_una = conn->iss;
+	tcp_cc_sync(conn);
 	conn->ap = ap_active;
 
 	tcp_tqueue_ctrl_seg(conn, CTL_SYN);
@@ -432,24 +450,146 @@ tcp_conn_t *tcp_conn_find_ref(inet_ep2_t *epp)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_find_ref(%p)", epp);
 
-	fibril_mutex_lock(&amap_lock);
+	fibril_rwlock_read_lock(&amap_lock);
 
 	rc = amap_find_match(amap, epp, &arg);
 	if (rc != EOK) {
 		assert(rc == ENOENT);
-		fibril_mutex_unlock(&amap_lock);
+		fibril_rwlock_read_unlock(&amap_lock);
 		return NULL;
 	}
 
 	conn = (tcp_conn_t *)arg;
 	tcp_conn_addref(conn);
 
-	fibril_mutex_unlock(&amap_lock);
+	fibril_rwlock_read_unlock(&amap_lock);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_find_ref: got conn=%p",
 	    conn);
 	return conn;
 }
 
+/** Convert connection state to the form reported to clients.
+ *
+ * @param cstate Connection state
+ * @return Reported connection state
+ */
+static tcp_info_state_t tcp_conn_info_state(tcp_cstate_t cstate)
+{
+	switch (cstate) {
+	case st_listen:
+		return tcp_is_listen;
+	case st_syn_sent:
+		return tcp_is_syn_sent;
+	case st_syn_received:
+		return tcp_is_syn_received;
+	case st_established:
+		return tcp_is_established;
+	case st_fin_wait_1:
+		return tcp_is_fin_wait_1;
+	case st_fin_wait_2:
+		return tcp_is_fin_wait_2;
+	case st_close_wait:
+		return tcp_is_close_wait;
+	case st_closing:
+		return tcp_is_closing;
+	case st_last_ack:
+		return tcp_is_last_ack;
+	case st_time_wait:
+		return tcp_is_time_wait;
+	case st_closed:
+		break;
+	}
+
+	return tcp_is_closed;
+}
+
+/** Get information and statistics for connection.
+ *
+ * @param conn Connection
+ * @param info Place to store information
+ */
+static void tcp_conn_get_info(tcp_conn_t *conn, tcp_conn_info_t *info)
+{
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	info->ident = conn->ident;
+	info->state = tcp_conn_info_state(conn->cstate);
+	info->segs_in = conn->stats.segs_in;
+	info->segs_out = conn->stats.segs_out;
+	info->bytes_in = conn->stats.bytes_in;
+	info->bytes_out = conn->stats.bytes_out;
+	info->retransmits = conn->stats.retransmits;
+	info->rto_timeouts = conn->stats.rto_timeouts;
+	info->dupacks = conn->stats.dupacks;
+	info->srtt = conn->cc.srtt;
+	info->rttvar = conn->cc.rttvar;
+	info->rto = conn->cc.rto;
+	info->cwnd = conn->cc.cwnd;
+	info->ssthresh = conn->cc.ssthresh;
+	info->snd_wnd = conn->snd_wnd;
+	info->rcv_wnd = conn->rcv_wnd;
+	info->in_flight = conn->snd_nxt - conn->snd_una;
+	info->snd_queue = conn->snd_buf_used;
+	info->rcv_queue = conn->rcv_buf_used;
+}
+
+/** Get information and statistics for all connections.
+ *
+ * @param rinfo  Place to store pointer to newly allocated array
+ * @param rcount Place to store number of connections
+ * @return EOK on success or ENOMEM
+ */
+errno_t tcp_conn_get_info_list(tcp_conn_info_t **rinfo, size_t *rcount)
+{
+	tcp_conn_info_t *info;
+	unsigned attempts;
+	size_t count;
+	size_t i;
+	bool busy;
+
+	for (attempts = 0; attempts < TCP_CONN_INFO_ATTEMPTS; attempts++) {
+		fibril_mutex_lock(&conn_list_lock);
+
+		count = list_count(&conn_list);
+		info = calloc(max(count, 1), sizeof(tcp_conn_info_t));
+		if (info == NULL) {
+			fibril_mutex_unlock(&conn_list_lock);
+			return ENOMEM;
+		}
+
+		/*
+		 * Connection locks can be held while conn_list_lock is
+		 * being acquired (e.g. when a listener is replenished), so
+		 * we must not block on them here. Start over if any
+		 * connection is busy.
+		 */
+		i = 0;
+		busy = false;
+		list_foreach(conn_list, link, tcp_conn_t, conn) {
+			if (!fibril_mutex_trylock(&conn->lock)) {
+				busy = true;
+				break;
+			}
+
+			tcp_conn_get_info(conn, &info[i++]);
+			tcp_conn_unlock(conn);
+		}
+
+		fibril_mutex_unlock(&conn_list_lock);
+
+		if (!busy) {
+			*rinfo = info;
+			*rcount = count;
+			return EOK;
+		}
+
+		free(info);
+		fibril_usleep(TCP_CONN_INFO_RETRY);
+	}
+
+	return EBUSY;
+}
+
 /** Reset connection.
  *
  * @param conn	Connection
@@ -511,6 +651,35 @@ bool tcp_conn_got_syn(tcp_conn_t *conn)
 	assert(false);
 }
 
+/** Negotiate options from a received SYN segment.
+ *
+ * In Listen state @a seg holds options offered by the peer, all of which we
+ * accept. In Syn-Sent state it holds those the peer accepted out of ours.
+ *
+ * @param conn		Connection
+ * @param seg		SYN segment
+ */
+static void tcp_conn_opts_negotiate(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	conn->ws_ok = (seg->opts.flags & tcp_opt_wscale) != 0;
+	if (conn->ws_ok) {
+		conn->snd_wscale = min(seg->opts.wscale, TCP_WSCALE_MAX);
+	} else {
+		conn->snd_wscale = 0;
+		conn->rcv_wscale = 0;
+	}
+
+	conn->sack_ok = (seg->opts.flags & tcp_opt_sack_perm) != 0;
+
+	conn->ts_ok = (seg->opts.flags & tcp_opt_ts) != 0;
+	if (conn->ts_ok)
+		conn->ts_recent = seg->opts.tsval;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: WS=%d (%u/%u) SACK=%d TS=%d",
+	    conn->name, conn->ws_ok, conn->snd_wscale, conn->rcv_wscale,
+	    conn->sack_ok, conn->ts_ok);
+}
+
 /** Segment arrived in Listen state.
  *
  * @param conn		Connection
@@ -540,6 +709,7 @@ static void tcp_conn_sa_listen(tcp_conn_t *conn, tcp_segment_t *seg)
 
 	conn->rcv_nxt = seg->seq + 1;
 	conn->irs = seg->seq;
+	tcp_conn_opts_negotiate(conn, seg);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "rcv_nxt=%u", conn->rcv_nxt);
 
@@ -550,6 +720,7 @@ static void tcp_conn_sa_listen(tcp_conn_t *conn, tcp_segment_t *seg)
 	conn->iss = 1;
 	conn->snd_nxt = conn->iss;
 	conn->snd_una = conn->iss;
+	tcp_cc_sync(conn);
 
 	/*
 	 * Surprisingly the spec does not deal with initial window setting.
@@ -614,6 +785,7 @@ static void tcp_conn_sa_syn_sent(tcp_conn_t *conn, tcp_segment_t *seg)
 
 	conn->rcv_nxt = seg->seq + 1;
 	conn->irs = seg->seq;
+	tcp_conn_opts_negotiate(conn, seg);
 
 	if ((seg->ctrl & CTL_ACK) != 0) {
 		conn->snd_una = seg->ack;
@@ -663,8 +835,27 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 {
 	tcp_segment_t *pseg;
 
+	bool has_ts;
+	bool ooo;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_sa_seq(%p, %p)", conn, seg);
 
+	/* Window in a SYN segment is never scaled */
+	if (conn->ws_ok && (seg->ctrl & CTL_SYN) == 0)
+		seg->wnd <<= conn->snd_wscale;
+
+	has_ts = conn->ts_ok && (seg->opts.flags & tcp_opt_ts) != 0;
+
+	/* Protection against wrapped sequence numbers (RFC 7323 section 5) */
+	if (has_ts && (seg->ctrl & CTL_RST) == 0 &&
+	    (int32_t) (seg->opts.tsval - conn->ts_recent) < 0) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "PAWS: replying ACK to old "
+		    "duplicate segment.");
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+		tcp_segment_delete(seg);
+		return;
+	}
+
 	/* Discard unacceptable segments ("old duplicates") */
 	if (!seq_no_segment_acceptable(conn, seg)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "Replying ACK to unacceptable segment.");
@@ -673,6 +864,13 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 		return;
 	}
 
+	/* Remember timestamp to echo (RFC 7323 section 4.3) */
+	if (has_ts && (int32_t) (seg->seq - conn->last_ack_sent) <= 0)
+		conn->ts_recent = seg->opts.tsval;
+
+	/* Segment arrived out of order */
+	ooo = !seq_no_segment_ready(conn, seg);
+
 	/* Queue for processing */
 	tcp_iqueue_insert_seg(&conn->incoming, seg);
 
@@ -684,6 +882,13 @@ static void tcp_conn_sa_queue(tcp_conn_t *conn, tcp_segment_t *seg)
 	 */
 	while (tcp_iqueue_get_ready_seg(&conn->incoming, &pseg) == EOK)
 		tcp_conn_seg_process(conn, pseg);
+
+	/*
+	 * Acknowledge out-of-order segment immediately so that the peer
+	 * learns about the hole (and what we have above it, with SACK).
+	 */
+	if (ooo && conn->cstate != st_closed)
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
 }
 
 /** Process segment RST field.
@@ -817,6 +1022,10 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 	    (unsigned)seg->ack, (unsigned)conn->snd_una,
 	    (unsigned)conn->snd_nxt);
 
+	/* Update SACK scoreboard before any retransmission */
+	if (conn->sack_ok)
+		tcp_tqueue_sack(conn, seg);
+
 	if (!seq_no_ack_acceptable(conn, seg->ack)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "ACK not acceptable.");
 		if (!seq_no_ack_duplicate(conn, seg->ack)) {
@@ -828,10 +1037,27 @@ static cproc_t tcp_conn_seg_proc_ack_est(tcp_conn_t *conn, tcp_segment_t *seg)
 			return cp_done;
 		} else {
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "Ignoring duplicate ACK.");
+
+			/*
+			 * An ACK that carries no data, does not move the window
+			 * and arrives while data is outstanding indicates
+			 * a segment was lost or reordered (RFC 5681).
+			 */
+			if (seg->ack == conn->snd_una && seg->len == 0 &&
+			    seg->wnd == conn->snd_wnd &&
+			    conn->snd_nxt != conn->snd_una) {
+				++conn->stats.dupacks;
+				tcp_cc_dupack(conn);
+			}
 		}
 	} else {
 		/* Update SND.UNA */
 		conn->snd_una = seg->ack;
+
+		/* Measure RTT using echoed timestamp */
+		if (conn->ts_ok && (seg->opts.flags & tcp_opt_ts) != 0 &&
+		    seg->opts.tsecr != 0)
+			tcp_cc_ts_ack(conn, seg->opts.tsecr);
 	}
 
 	if (seq_no_new_wnd_update(conn, seg)) {
@@ -1079,9 +1305,16 @@ static cproc_t tcp_conn_seg_proc_text(tcp_conn_t *conn, tcp_segment_t *seg)
 	/* Update receive window. XXX Not an efficient strategy. */
 	conn->rcv_wnd -= xfer_size;
 
-	/* Send ACK */
-	if (xfer_size > 0)
-		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+	/*
+	 * Acknowledge at once if out-of-order data is waiting (we may have
+	 * just filled a hole), otherwise the ACK may be delayed.
+	 */
+	if (xfer_size > 0) {
+		if (!list_empty(&conn->incoming.list))
+			tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+		else
+			tcp_tqueue_ack_delayed(conn, xfer_size);
+	}
 
 	if (xfer_size < seg->len) {
 		/* Trim part of segment which we just received */
@@ -1245,6 +1478,9 @@ void tcp_conn_segment_arrived(tcp_conn_t *conn, inet_ep2_t *epp,
 		return;
 	}
 
+	++conn->stats.segs_in;
+	conn->stats.bytes_in += tcp_segment_text_size(seg);
+
 	if (inet_addr_is_any(&conn->ident.remote.addr) ||
 	    conn->ident.remote.port == inet_port_any ||
 	    inet_addr_is_any(&conn->ident.local.addr)) {
@@ -1254,7 +1490,7 @@ void tcp_conn_segment_arrived(tcp_conn_t *conn, inet_ep2_t *epp,
 		oldepp = conn->ident;
 
 		/* Need to remove and re-insert connection with new identity */
-		fibril_mutex_lock(&amap_lock);
+		fibril_rwlock_write_lock(&amap_lock);
 
 		if (inet_addr_is_any(&conn->ident.remote.addr))
 			conn->ident.remote.addr = epp->remote.addr;
@@ -1270,13 +1506,13 @@ void tcp_conn_segment_arrived(tcp_conn_t *conn, inet_ep2_t *epp,
 			assert(rc != EEXIST);
 			assert(rc == ENOMEM);
 			log_msg(LOG_DEFAULT, LVL_ERROR, "Out of memory.");
-			fibril_mutex_unlock(&amap_lock);
+			fibril_rwlock_write_unlock(&amap_lock);
 			tcp_conn_unlock(conn);
 			return;
 		}
 
 		amap_remove(amap, &oldepp);
-		fibril_mutex_unlock(&amap_lock);
+		fibril_rwlock_write_unlock(&amap_lock);
 
 		conn->name = (char *) "a";
 	}
@@ -1342,9 +1578,13 @@ static void tw_timeout_func(void *arg)
 void tcp_conn_tw_timer_set(tcp_conn_t *conn)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_set() begin");
+
+	/* Clear first to make sure we update refcnt correctly */
+	tcp_conn_tw_timer_clear(conn);
+
 	tcp_conn_addref(conn);
-	fibril_timer_set_locked(conn->tw_timer, TIME_WAIT_TIMEOUT,
-	    tw_timeout_func, (void *)conn);
+	tcp_timer_set(&conn->tw_timer, TIME_WAIT_TIMEOUT, tw_timeout_func,
+	    (void *)conn);
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_set() end");
 }
 
@@ -1355,7 +1595,7 @@ void tcp_conn_tw_timer_set(tcp_conn_t *conn)
 void tcp_conn_tw_timer_clear(tcp_conn_t *conn)
 {
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_clear() begin");
-	if (fibril_timer_clear_locked(conn->tw_timer) == fts_active)
+	if (tcp_timer_clear(&conn->tw_timer))
 		tcp_conn_delref(conn);
 	log_msg(LOG_DEFAULT, LVL_DEBUG2, "tcp_conn_tw_timer_clear() end");
 }
@@ -1389,6 +1629,59 @@ void tcp_unexpected_segment(inet_ep2_t *epp, tcp_segment_t *seg)
 		tcp_reply_rst(epp, seg);
 }
 
+/** Determine whether endpoint pair stays within this host.
+ *
+ * Segments sent to a loopback address or to the local address itself
+ * are necessarily received by this TCP service.
+ *
+ * @param epp Endpoint pair, oriented for transmission
+ * @return @c true if segments for @a epp are delivered locally
+ */
+static bool tcp_ep2_is_local(inet_ep2_t *epp)
+{
+	addr32_t v4;
+	addr128_t v6;
+	inet_addr_t lo6;
+
+	switch (inet_addr_get(&epp->remote.addr, &v4, &v6)) {
+	case ip_v4:
+		if ((v4 >> 24) == 127)
+			return true;
+		break;
+	case ip_v6:
+		inet_addr6(&lo6, 0, 0, 0, 0, 0, 0, 0, 1);
+		if (inet_addr_compare(&epp->remote.addr, &lo6))
+			return true;
+		break;
+	default:
+		return false;
+	}
+
+	return !inet_addr_is_any(&epp->local.addr) &&
+	    inet_addr_compare(&epp->local.addr, &epp->remote.addr);
+}
+
+/** Determine largest segment to queue for transmission.
+ *
+ * With offload, IPv4 segments larger than SMSS are handed to the network
+ * layer that splits them into SMSS-sized segments.
+ *
+ * @param conn Connection
+ * @return Maximum segment text size
+ */
+size_t tcp_conn_seg_max(tcp_conn_t *conn)
+{
+	/* Local segments are not subject to any link MTU */
+	if (tcp_conn_lb == tcp_lb_none && tcp_ep2_is_local(&conn->ident))
+		return TCP_TSO_SIZE;
+
+	if (tcp_conn_offload && tcp_conn_lb == tcp_lb_none &&
+	    conn->ident.remote.addr.version == ip_v4)
+		return TCP_TSO_SIZE;
+
+	return TCP_SMSS;
+}
+
 /** Transmit segment over network.
  *
  * @param epp Endpoint pair with source and destination information
@@ -1399,6 +1692,7 @@ static void tcp_transmit_segment(inet_ep2_t *epp, tcp_segment_t *seg)
 	tcp_pdu_t *pdu;
 	tcp_segment_t *dseg;
 	inet_ep2_t rident;
+	errno_t rc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG,
 	    "tcp_transmit_segment(l:(%u),f:(%u), %p)",
@@ -1410,21 +1704,39 @@ static void tcp_transmit_segment(inet_ep2_t *epp, tcp_segment_t *seg)
 	tcp_segment_dump(seg);
 
 	if (tcp_conn_lb == tcp_lb_segment) {
-		/* Loop back segment */
-#if 0
-		tcp_ncsim_bounce_seg(sp, seg);
-#endif
+		/* Loop back segment through network condition simulator */
+		dseg = tcp_segment_dup(seg);
+		if (dseg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_WARN, "Not enough memory. Segment dropped.");
+			return;
+		}
 
-		/* Reverse the identification */
-		tcp_ep2_flipped(epp, &rident);
+		tcp_ncsim_bounce_seg(epp, dseg);
+		return;
+	}
 
-		/* Insert segment back into rqueue */
+	if (tcp_conn_lb == tcp_lb_none && tcp_ep2_is_local(epp)) {
+		/* Hand segment directly to our own receive queue */
 		dseg = tcp_segment_dup(seg);
+		if (dseg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_WARN, "Not enough memory. Segment dropped.");
+			return;
+		}
+
+		tcp_ep2_flipped(epp, &rident);
+		/* Source address is the destination itself, as in inetsrv */
+		if (inet_addr_is_any(&rident.remote.addr))
+			rident.remote.addr = epp->remote.addr;
+
 		tcp_rqueue_insert_seg(&rident, dseg);
 		return;
 	}
 
-	if (tcp_pdu_encode(epp, seg, &pdu) != EOK) {
+	if (tcp_conn_offload && epp->remote.addr.version == ip_v4)
+		rc = tcp_pdu_encode_partial(epp, seg, TCP_SMSS, &pdu);
+	else
+		rc = tcp_pdu_encode(epp, seg, &pdu);
+	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_WARN, "Not enough memory. Segment dropped.");
 		return;
 	}
@@ -37,6 +37,7 @@
 
 #include <inet/endpoint.h>
 #include <stdbool.h>
+#include <types/tcp.h>
 #include "tcp_type.h"
 
 extern errno_t tcp_conns_init(void);
@@ -48,6 +49,7 @@ extern void tcp_conn_reset(tcp_conn_t *conn);
 extern void tcp_conn_sync(tcp_conn_t *);
 extern void tcp_conn_fin_sent(tcp_conn_t *);
 extern tcp_conn_t *tcp_conn_find_ref(inet_ep2_t *);
+extern errno_t tcp_conn_get_info_list(tcp_conn_info_t **, size_t *);
 extern void tcp_conn_addref(tcp_conn_t *);
 extern void tcp_conn_delref(tcp_conn_t *);
 extern void tcp_conn_lock(tcp_conn_t *);
@@ -58,7 +60,10 @@ extern void tcp_conn_segment_arrived(tcp_conn_t *, inet_ep2_t *,
 extern void tcp_unexpected_segment(inet_ep2_t *, tcp_segment_t *);
 extern void tcp_ep2_flipped(inet_ep2_t *, inet_ep2_t *);
 
+extern size_t tcp_conn_seg_max(tcp_conn_t *);
+
 extern tcp_lb_t tcp_conn_lb;
+extern bool tcp_conn_offload;
 
 #endif
 
@@ -40,6 +40,7 @@
 #include <inet/inet.h>
 #include <mem.h>
 #include <io/log.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 #include "inet.h"
@@ -112,6 +113,13 @@ static errno_t tcp_inet_ev_recv(inet_dgram_t *dgram)
 	pdu->src = dgram->src;
 	pdu->dest = dgram->dest;
 
+	/* Verify checksum unless the link has already done so */
+	if (dgram->csum != INET_CSUM_VALID && !tcp_pdu_checksum_ok(pdu)) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Checksum mismatch. Dropped.");
+		tcp_pdu_delete(pdu);
+		return EINVAL;
+	}
+
 	tcp_received_pdu(pdu);
 	tcp_pdu_delete(pdu);
 
@@ -143,6 +151,9 @@ void tcp_transmit_pdu(tcp_pdu_t *pdu)
 	dgram.tos = 0;
 	dgram.data = pdu_raw;
 	dgram.size = pdu_raw_size;
+	dgram.csum = pdu->csum_partial ? INET_CSUM_PARTIAL : INET_CSUM_NONE;
+	dgram.csum_offs = offsetof(tcp_header_t, checksum);
+	dgram.tso_mss = pdu->tso_mss;
 
 	rc = inet_send(&dgram, INET_TTL_MAX, 0);
 	if (rc != EOK)
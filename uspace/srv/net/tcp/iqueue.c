@@ -186,6 +186,50 @@ errno_t tcp_iqueue_get_ready_seg(tcp_iqueue_t *iqueue, tcp_segment_t **seg)
 	return EOK;
 }
 
+/** Describe out-of-order data in incoming queue as SACK blocks.
+ *
+ * Adjacent and overlapping segments are merged into a single block.
+ *
+ * @param iqueue	Incoming queue
+ * @param blocks	Array to fill in
+ * @param max		Maximum number of blocks
+ * @return		Number of blocks stored in @a blocks
+ */
+size_t tcp_iqueue_sack_blocks(tcp_iqueue_t *iqueue, tcp_sack_block_t *blocks,
+    size_t max)
+{
+	tcp_segment_t *seg;
+	size_t cnt = 0;
+	uint32_t end;
+
+	list_foreach(iqueue->list, link, tcp_iqueue_entry_t, iqe) {
+		seg = iqe->seg;
+
+		/* Only segments above RCV.NXT are out of order */
+		if ((int32_t) (seg->seq - iqueue->conn->rcv_nxt) <= 0 ||
+		    seg->len == 0)
+			continue;
+
+		end = seg->seq + seg->len;
+
+		if (cnt > 0 && (int32_t) (seg->seq - blocks[cnt - 1].end) <= 0) {
+			/* Extend previous block */
+			if ((int32_t) (end - blocks[cnt - 1].end) > 0)
+				blocks[cnt - 1].end = end;
+			continue;
+		}
+
+		if (cnt == max)
+			break;
+
+		blocks[cnt].start = seg->seq;
+		blocks[cnt].end = end;
+		++cnt;
+	}
+
+	return cnt;
+}
+
 /**
  * @}
  */
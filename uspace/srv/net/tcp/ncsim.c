@@ -33,9 +33,12 @@
 /**
  * @file Network condition simulator
  *
- * Simulate network conditions for testing the reliability implementation:
+ * Simulate network conditions for testing the reliability and congestion
+ * control implementation:
  *    - variable latency
  *    - frame drop
+ *
+ * The conditions are selected from a table of named scenarios.
  */
 
 #include <adt/list.h>
@@ -44,6 +47,7 @@
 #include <inet/endpoint.h>
 #include <io/log.h>
 #include <stdlib.h>
+#include <str.h>
 #include <fibril.h>
 #include "conn.h"
 #include "ncsim.h"
@@ -55,6 +59,43 @@ static list_t sim_queue;
 static fibril_mutex_t sim_queue_lock;
 static fibril_condvar_t sim_queue_cv;
 
+/** Simulation scenarios */
+static tcp_ncsim_cfg_t sim_scenarios[] = {
+	{
+		/* Deliver segments immediately */
+		.name = "none"
+	},
+	{
+		/* Random latency of up to one second */
+		.name = "delay",
+		.delay_max = 1000 * 1000
+	},
+	{
+		/* Moderate latency and loss */
+		.name = "lossy",
+		.drop = 20,
+		.delay_min = 10 * 1000,
+		.delay_max = 50 * 1000
+	},
+	{
+		/* Long fat network, high latency, rare loss */
+		.name = "lfn",
+		.drop = 1,
+		.delay_min = 250 * 1000,
+		.delay_max = 300 * 1000
+	},
+	{
+		/* Congested path, heavy loss and jitter */
+		.name = "congested",
+		.drop = 100,
+		.delay_min = 50 * 1000,
+		.delay_max = 200 * 1000
+	}
+};
+
+/** Active scenario */
+static tcp_ncsim_cfg_t *sim_cfg = &sim_scenarios[0];
+
 /** Initialize segment receive queue. */
 void tcp_ncsim_init(void)
 {
@@ -63,6 +104,31 @@ void tcp_ncsim_init(void)
 	fibril_condvar_initialize(&sim_queue_cv);
 }
 
+/** Select simulation scenario.
+ *
+ * @param name	Scenario name
+ * @return	EOK on success, ENOENT if there is no such scenario
+ */
+errno_t tcp_ncsim_scenario_set(const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(sim_scenarios) / sizeof(sim_scenarios[0]); i++) {
+		if (str_cmp(sim_scenarios[i].name, name) == 0) {
+			sim_cfg = &sim_scenarios[i];
+			return EOK;
+		}
+	}
+
+	return ENOENT;
+}
+
+/** Get active simulation scenario. */
+tcp_ncsim_cfg_t *tcp_ncsim_scenario_get(void)
+{
+	return sim_cfg;
+}
+
 /** Bounce segment through simulator into receive queue.
  *
  * @param epp	Endpoint pair, oriented for transmission
@@ -76,13 +142,17 @@ void tcp_ncsim_bounce_seg(inet_ep2_t *epp, tcp_segment_t *seg)
 	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_ncsim_bounce_seg()");
-	tcp_ep2_flipped(epp, &rident);
-	tcp_rqueue_insert_seg(&rident, seg);
-	return;
 
-	if (0 /* rand() % 4 == 3 */) {
+	if (sim_cfg->drop == 0 && sim_cfg->delay_max == 0) {
+		/* Nothing to simulate */
+		tcp_ep2_flipped(epp, &rident);
+		tcp_rqueue_insert_seg(&rident, seg);
+		return;
+	}
+
+	if (sim_cfg->drop != 0 && (unsigned) rand() % 1000 < sim_cfg->drop) {
 		/* Drop segment */
-		log_msg(LOG_DEFAULT, LVL_ERROR, "NCSim dropping segment");
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "NCSim dropping segment");
 		tcp_segment_delete(seg);
 		return;
 	}
@@ -90,32 +160,37 @@ void tcp_ncsim_bounce_seg(inet_ep2_t *epp, tcp_segment_t *seg)
 	sqe = calloc(1, sizeof(tcp_squeue_entry_t));
 	if (sqe == NULL) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed allocating SQE.");
+		tcp_segment_delete(seg);
 		return;
 	}
 
-	sqe->delay = rand() % (1000 * 1000);
+	sqe->delay = sim_cfg->delay_min;
+	if (sim_cfg->delay_max > sim_cfg->delay_min) {
+		sqe->delay += (usec_t) rand() %
+		    (sim_cfg->delay_max - sim_cfg->delay_min);
+	}
 	sqe->epp = *epp;
 	sqe->seg = seg;
 
 	fibril_mutex_lock(&sim_queue_lock);
 
+	/* Queue entries hold delays relative to their predecessor */
 	link = list_first(&sim_queue);
-	while (link != NULL && sqe->delay > 0) {
+	while (link != NULL) {
 		old_qe = list_get_instance(link, tcp_squeue_entry_t, link);
 		if (sqe->delay < old_qe->delay)
 			break;
 
 		sqe->delay -= old_qe->delay;
-
-		link = link->next;
-		if (link == &sim_queue.head)
-			link = NULL;
+		link = list_next(link, &sim_queue);
 	}
 
-	if (link != NULL)
-		list_insert_after(&sqe->link, link);
-	else
+	if (link != NULL) {
+		old_qe->delay -= sqe->delay;
+		list_insert_before(&sqe->link, link);
+	} else {
 		list_append(&sqe->link, &sim_queue);
+	}
 
 	fibril_condvar_broadcast(&sim_queue_cv);
 	fibril_mutex_unlock(&sim_queue_lock);
@@ -39,6 +39,8 @@
 #include "tcp_type.h"
 
 extern void tcp_ncsim_init(void);
+extern errno_t tcp_ncsim_scenario_set(const char *);
+extern tcp_ncsim_cfg_t *tcp_ncsim_scenario_get(void);
 extern void tcp_ncsim_bounce_seg(inet_ep2_t *, tcp_segment_t *);
 extern void tcp_ncsim_fibril_start(void);
 
@@ -37,7 +37,9 @@
 #include <bitops.h>
 #include <byteorder.h>
 #include <errno.h>
+#include <inet/checksum.h>
 #include <inet/endpoint.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 #include "pdu.h"
@@ -46,44 +48,6 @@
 #include "std.h"
 #include "tcp_type.h"
 
-#define TCP_CHECKSUM_INIT 0xffff
-
-/** One's complement addition.
- *
- * Result is a + b + carry.
- */
-static uint16_t tcp_ocadd16(uint16_t a, uint16_t b)
-{
-	uint32_t s;
-
-	s = (uint32_t)a + (uint32_t)b;
-	return (s & 0xffff) + (s >> 16);
-}
-
-static uint16_t tcp_checksum_calc(uint16_t ivalue, void *data, size_t size)
-{
-	uint16_t sum;
-	uint16_t w;
-	size_t words, i;
-	uint8_t *bdata;
-
-	sum = ~ivalue;
-	words = size / 2;
-	bdata = (uint8_t *)data;
-
-	for (i = 0; i < words; i++) {
-		w = ((uint16_t)bdata[2 * i] << 8) | bdata[2 * i + 1];
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	if (size % 2 != 0) {
-		w = ((uint16_t)bdata[2 * words] << 8);
-		sum = tcp_ocadd16(sum, w);
-	}
-
-	return ~sum;
-}
-
 static void tcp_header_decode_flags(uint16_t doff_flags, tcp_control_t *rctl)
 {
 	tcp_control_t ctl;
@@ -125,7 +89,8 @@ static void tcp_header_encode_flags(tcp_control_t ctl, uint16_t doff_flags0,
 	*rdoff_flags = doff_flags;
 }
 
-static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *hdr)
+static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg,
+    tcp_header_t *hdr, size_t hdr_size)
 {
 	uint16_t doff_flags;
 	uint16_t doff;
@@ -135,7 +100,7 @@ static void tcp_header_setup(inet_ep2_t *epp, tcp_segment_t *seg, tcp_header_t *
 	hdr->seq = host2uint32_t_be(seg->seq);
 	hdr->ack = host2uint32_t_be(seg->ack);
 
-	doff = (sizeof(tcp_header_t) / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
+	doff = (hdr_size / sizeof(uint32_t)) << DF_DATA_OFFSET_l;
 	tcp_header_encode_flags(seg->ctrl, doff, &doff_flags);
 
 	hdr->doff_flags = host2uint16_t_be(doff_flags);
@@ -190,18 +155,191 @@ static void tcp_header_decode(tcp_header_t *hdr, tcp_segment_t *seg)
 	seg->up = uint16_t_be2host(hdr->urg_ptr);
 }
 
+static void tcp_opt_put16(uint8_t *p, uint16_t val)
+{
+	p[0] = val >> 8;
+	p[1] = val & 0xff;
+}
+
+static void tcp_opt_put32(uint8_t *p, uint32_t val)
+{
+	tcp_opt_put16(p, val >> 16);
+	tcp_opt_put16(p + 2, val & 0xffff);
+}
+
+static uint16_t tcp_opt_get16(uint8_t *p)
+{
+	return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static uint32_t tcp_opt_get32(uint8_t *p)
+{
+	return ((uint32_t)tcp_opt_get16(p) << 16) | tcp_opt_get16(p + 2);
+}
+
+/** Encode segment options.
+ *
+ * Each option is preceded by NOPs so that it ends on a 32-bit boundary.
+ * SACK blocks that do not fit in the options area are left out.
+ *
+ * @param opts		Options
+ * @param buf		Buffer of at least TCP_OPTS_MAX_SIZE bytes
+ * @return		Size of encoded options, multiple of four
+ */
+static size_t tcp_opts_encode(tcp_opts_t *opts, uint8_t *buf)
+{
+	size_t size = 0;
+	size_t cnt;
+	size_t i;
+
+	if ((opts->flags & tcp_opt_mss) != 0) {
+		buf[size++] = OPT_MAX_SEG_SIZE;
+		buf[size++] = OPT_MAX_SEG_SIZE_LEN;
+		tcp_opt_put16(buf + size, opts->mss);
+		size += 2;
+	}
+
+	if ((opts->flags & tcp_opt_wscale) != 0) {
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_WINDOW_SCALE;
+		buf[size++] = OPT_WINDOW_SCALE_LEN;
+		buf[size++] = opts->wscale;
+	}
+
+	if ((opts->flags & tcp_opt_sack_perm) != 0) {
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_SACK_PERMITTED;
+		buf[size++] = OPT_SACK_PERMITTED_LEN;
+	}
+
+	if ((opts->flags & tcp_opt_ts) != 0) {
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_TIMESTAMP;
+		buf[size++] = OPT_TIMESTAMP_LEN;
+		tcp_opt_put32(buf + size, opts->tsval);
+		tcp_opt_put32(buf + size + 4, opts->tsecr);
+		size += 8;
+	}
+
+	if ((opts->flags & tcp_opt_sack) != 0 && opts->sack_cnt > 0) {
+		cnt = (TCP_OPTS_MAX_SIZE - size - 2 - OPT_SACK_BASE_LEN) /
+		    OPT_SACK_BLOCK_LEN;
+		cnt = min(cnt, opts->sack_cnt);
+
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_NOP;
+		buf[size++] = OPT_SACK;
+		buf[size++] = OPT_SACK_BASE_LEN + cnt * OPT_SACK_BLOCK_LEN;
+		for (i = 0; i < cnt; i++) {
+			tcp_opt_put32(buf + size, opts->sack[i].start);
+			tcp_opt_put32(buf + size + 4, opts->sack[i].end);
+			size += OPT_SACK_BLOCK_LEN;
+		}
+	}
+
+	assert(size <= TCP_OPTS_MAX_SIZE);
+	assert(size % sizeof(uint32_t) == 0);
+	return size;
+}
+
+/** Decode segment options.
+ *
+ * Malformed options end decoding, options decoded so far are kept.
+ *
+ * @param buf		Options area
+ * @param size		Size of options area
+ * @param opts		Place to store options
+ */
+static void tcp_opts_decode(uint8_t *buf, size_t size, tcp_opts_t *opts)
+{
+	size_t off = 0;
+	uint8_t kind;
+	uint8_t len;
+	size_t i;
+
+	memset(opts, 0, sizeof(tcp_opts_t));
+
+	while (off < size) {
+		kind = buf[off];
+		if (kind == OPT_END_LIST)
+			break;
+		if (kind == OPT_NOP) {
+			++off;
+			continue;
+		}
+
+		if (size - off < 2)
+			break;
+		len = buf[off + 1];
+		if (len < 2 || len > size - off)
+			break;
+
+		switch (kind) {
+		case OPT_MAX_SEG_SIZE:
+			if (len != OPT_MAX_SEG_SIZE_LEN)
+				break;
+			opts->flags |= tcp_opt_mss;
+			opts->mss = tcp_opt_get16(buf + off + 2);
+			break;
+		case OPT_WINDOW_SCALE:
+			if (len != OPT_WINDOW_SCALE_LEN)
+				break;
+			opts->flags |= tcp_opt_wscale;
+			opts->wscale = buf[off + 2];
+			break;
+		case OPT_SACK_PERMITTED:
+			if (len != OPT_SACK_PERMITTED_LEN)
+				break;
+			opts->flags |= tcp_opt_sack_perm;
+			break;
+		case OPT_TIMESTAMP:
+			if (len != OPT_TIMESTAMP_LEN)
+				break;
+			opts->flags |= tcp_opt_ts;
+			opts->tsval = tcp_opt_get32(buf + off + 2);
+			opts->tsecr = tcp_opt_get32(buf + off + 6);
+			break;
+		case OPT_SACK:
+			if ((len - OPT_SACK_BASE_LEN) % OPT_SACK_BLOCK_LEN != 0)
+				break;
+			opts->flags |= tcp_opt_sack;
+			opts->sack_cnt = min((size_t) (len - OPT_SACK_BASE_LEN) /
+			    OPT_SACK_BLOCK_LEN, TCP_SACK_BLOCKS_MAX);
+			for (i = 0; i < opts->sack_cnt; i++) {
+				opts->sack[i].start = tcp_opt_get32(buf + off +
+				    OPT_SACK_BASE_LEN + i * OPT_SACK_BLOCK_LEN);
+				opts->sack[i].end = tcp_opt_get32(buf + off +
+				    OPT_SACK_BASE_LEN + i * OPT_SACK_BLOCK_LEN + 4);
+			}
+			break;
+		default:
+			/* Unknown option, skip */
+			break;
+		}
+
+		off += len;
+	}
+}
+
 static errno_t tcp_header_encode(inet_ep2_t *epp, tcp_segment_t *seg,
     void **header, size_t *size)
 {
 	tcp_header_t *hdr;
+	uint8_t opts[TCP_OPTS_MAX_SIZE];
+	size_t opts_size;
+
+	opts_size = tcp_opts_encode(&seg->opts, opts);
 
-	hdr = calloc(1, sizeof(tcp_header_t));
+	hdr = calloc(1, sizeof(tcp_header_t) + opts_size);
 	if (hdr == NULL)
 		return ENOMEM;
 
-	tcp_header_setup(epp, seg, hdr);
+	tcp_header_setup(epp, seg, hdr, sizeof(tcp_header_t) + opts_size);
+	memcpy((uint8_t *)hdr + sizeof(tcp_header_t), opts, opts_size);
 	*header = hdr;
-	*size = sizeof(tcp_header_t);
+	*size = sizeof(tcp_header_t) + opts_size;
 
 	return EOK;
 }
@@ -270,19 +408,19 @@ static uint16_t tcp_pdu_checksum_calc(tcp_pdu_t *pdu)
 	ip_ver_t ver = tcp_phdr_setup(pdu, &phdr, &phdr6);
 	switch (ver) {
 	case ip_v4:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr,
+		cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, (void *) &phdr,
 		    sizeof(tcp_phdr_t));
 		break;
 	case ip_v6:
-		cs_phdr = tcp_checksum_calc(TCP_CHECKSUM_INIT, (void *) &phdr6,
+		cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, (void *) &phdr6,
 		    sizeof(tcp_phdr6_t));
 		break;
 	default:
 		assert(false);
 	}
 
-	cs_headers = tcp_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
-	return tcp_checksum_calc(cs_headers, pdu->text, pdu->text_size);
+	cs_headers = inet_checksum_calc(cs_phdr, pdu->header, pdu->header_size);
+	return inet_checksum_calc(cs_headers, pdu->text, pdu->text_size);
 }
 
 static void tcp_pdu_set_checksum(tcp_pdu_t *pdu, uint16_t checksum)
@@ -293,6 +431,16 @@ static void tcp_pdu_set_checksum(tcp_pdu_t *pdu, uint16_t checksum)
 	hdr->checksum = host2uint16_t_be(checksum);
 }
 
+/** Verify checksum of incoming PDU.
+ *
+ * @param pdu PDU with source and destination address set
+ * @return @c true if checksum is correct
+ */
+bool tcp_pdu_checksum_ok(tcp_pdu_t *pdu)
+{
+	return tcp_pdu_checksum_calc(pdu) == 0;
+}
+
 /** Decode incoming PDU */
 errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 {
@@ -306,6 +454,11 @@ errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 	tcp_header_decode(pdu->header, nseg);
 	nseg->len += seq_no_control_len(nseg->ctrl);
 
+	if (pdu->header_size > sizeof(tcp_header_t)) {
+		tcp_opts_decode((uint8_t *)pdu->header + sizeof(tcp_header_t),
+		    pdu->header_size - sizeof(tcp_header_t), &nseg->opts);
+	}
+
 	hdr = (tcp_header_t *)pdu->header;
 
 	epp->local.port = uint16_t_be2host(hdr->dest_port);
@@ -317,12 +470,12 @@ errno_t tcp_pdu_decode(tcp_pdu_t *pdu, inet_ep2_t *epp, tcp_segment_t **seg)
 	return EOK;
 }
 
-/** Encode outgoing PDU */
-errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
+/** Encode segment header and text into a new PDU, without checksum. */
+static errno_t tcp_pdu_encode_seg(inet_ep2_t *epp, tcp_segment_t *seg,
+    tcp_pdu_t **pdu)
 {
 	tcp_pdu_t *npdu;
 	size_t text_size;
-	uint16_t checksum;
 	errno_t rc;
 
 	npdu = tcp_pdu_new();
@@ -348,6 +501,21 @@ errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
 	npdu->text_size = text_size;
 	memcpy(npdu->text, seg->data, text_size);
 
+	*pdu = npdu;
+	return EOK;
+}
+
+/** Encode outgoing PDU */
+errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
+{
+	tcp_pdu_t *npdu;
+	uint16_t checksum;
+	errno_t rc;
+
+	rc = tcp_pdu_encode_seg(epp, seg, &npdu);
+	if (rc != EOK)
+		return rc;
+
 	/* Checksum calculation */
 	checksum = tcp_pdu_checksum_calc(npdu);
 	tcp_pdu_set_checksum(npdu, checksum);
@@ -356,6 +524,51 @@ errno_t tcp_pdu_encode(inet_ep2_t *epp, tcp_segment_t *seg, tcp_pdu_t **pdu)
 	return EOK;
 }
 
+/** Encode outgoing PDU for checksum and segmentation offload.
+ *
+ * Only the pseudo-header sum is stored in the checksum field, the network
+ * layer or the NIC completes the checksum. If the text is longer than
+ * @a mss, the PDU is marked for segmentation and the pseudo-header sum
+ * excludes the length, which differs for each resulting segment.
+ *
+ * @param epp Endpoint pair (IPv4)
+ * @param seg Segment
+ * @param mss Maximum segment size
+ * @param pdu Place to store pointer to new PDU
+ * @return EOK on success or an error code
+ */
+errno_t tcp_pdu_encode_partial(inet_ep2_t *epp, tcp_segment_t *seg,
+    size_t mss, tcp_pdu_t **pdu)
+{
+	tcp_pdu_t *npdu;
+	tcp_phdr_t phdr;
+	tcp_phdr6_t phdr6;
+	uint16_t cs_phdr;
+	errno_t rc;
+
+	rc = tcp_pdu_encode_seg(epp, seg, &npdu);
+	if (rc != EOK)
+		return rc;
+
+	if (tcp_phdr_setup(npdu, &phdr, &phdr6) != ip_v4) {
+		tcp_pdu_delete(npdu);
+		return EINVAL;
+	}
+
+	if (npdu->text_size > mss) {
+		npdu->tso_mss = mss;
+		phdr.tcp_length = 0;
+	}
+
+	cs_phdr = inet_checksum_calc(INET_CHECKSUM_INIT, (void *) &phdr,
+	    sizeof(tcp_phdr_t));
+	tcp_pdu_set_checksum(npdu, (uint16_t) ~cs_phdr);
+	npdu->csum_partial = true;
+
+	*pdu = npdu;
+	return EOK;
+}
+
 /**
  * @}
  */
@@ -67,6 +67,30 @@ bool seq_no_ack_acceptable(tcp_conn_t *conn, uint32_t seg_ack)
 	return seq_no_lt_le(conn->snd_una, seg_ack, conn->snd_nxt);
 }
 
+/** Determine whether SACK block lies within outstanding data.
+ *
+ * @param conn	Connection
+ * @param blk	SACK block
+ * @return	@c true if SND.UNA <= start < end <= SND.NXT
+ */
+bool seq_no_sack_valid(tcp_conn_t *conn, tcp_sack_block_t *blk)
+{
+	return seq_no_le_lt(conn->snd_una, blk->start, blk->end) &&
+	    seq_no_lt_le(blk->start, blk->end, conn->snd_nxt);
+}
+
+/** Determine whether segment is covered by SACK block.
+ *
+ * @param blk	SACK block
+ * @param seg	Segment
+ * @return	@c true if the whole segment lies within @a blk
+ */
+bool seq_no_segment_sacked(tcp_sack_block_t *blk, tcp_segment_t *seg)
+{
+	return seq_no_le_lt(blk->start, seg->seq, blk->end) &&
+	    seq_no_lt_le(blk->start, seg->seq + seg->len, blk->end);
+}
+
 /** Determine wheter ack is duplicate.
  *
  * ACK is duplicate if it refers to a sequence number that has
@@ -147,6 +171,19 @@ bool seq_no_segment_acked(tcp_conn_t *conn, tcp_segment_t *seg, uint32_t ack)
 	return seq_no_lt_le(seg->seq, seg->seq + seg->len, ack);
 }
 
+/** Determine whether segment is partially acked.
+ *
+ * @param seg  Segment
+ * @param ack  Last received ACK (i.e. SND.UNA)
+ *
+ * @return @c true if @a ack lies strictly inside the segment
+ */
+bool seq_no_segment_acked_part(tcp_segment_t *seg, uint32_t ack)
+{
+	assert(seg->len > 1);
+	return seq_no_lt_le(seg->seq, ack, seg->seq + seg->len - 1);
+}
+
 /** Determine whether initial SYN is acked.
  *
  * @param conn Connection
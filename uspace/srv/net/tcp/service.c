@@ -34,6 +34,7 @@
  * @file HelenOS service implementation
  */
 
+#include <as.h>
 #include <async.h>
 #include <errno.h>
 #include <str_error.h>
@@ -611,6 +612,7 @@ static errno_t tcp_conn_push_impl(tcp_client_t *client, sysarg_t conn_id)
 {
 	tcp_cconn_t *cconn;
 	errno_t rc;
+	tcp_error_t trc;
 
 	rc = tcp_cconn_get(client, conn_id, &cconn);
 	if (rc != EOK) {
@@ -618,8 +620,37 @@ static errno_t tcp_conn_push_impl(tcp_client_t *client, sysarg_t conn_id)
 		return ENOENT;
 	}
 
-	(void) cconn;
-	/* XXX TODO */
+	trc = tcp_uc_push(cconn->conn);
+	if (trc != TCP_EOK)
+		return EIO;
+
+	return EOK;
+}
+
+/** Set connection no-delay option.
+ *
+ * Handle client request to set no-delay option (with parameters
+ * unmarshalled).
+ *
+ * @param client  TCP client
+ * @param conn_id Connection ID
+ * @param nodelay @c true to send small segments without delay
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t tcp_conn_set_nodelay_impl(tcp_client_t *client,
+    sysarg_t conn_id, bool nodelay)
+{
+	tcp_cconn_t *cconn;
+	errno_t rc;
+
+	rc = tcp_cconn_get(client, conn_id, &cconn);
+	if (rc != EOK) {
+		assert(rc == ENOENT);
+		return ENOENT;
+	}
+
+	tcp_uc_set_nodelay(cconn->conn, nodelay);
 	return EOK;
 }
 
@@ -916,6 +947,70 @@ static void tcp_conn_push_srv(tcp_client_t *client, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+/** Set connection no-delay option.
+ *
+ * Handle client request to set no-delay option.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_conn_set_nodelay_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	sysarg_t conn_id;
+	bool nodelay;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_set_nodelay_srv()");
+
+	conn_id = ipc_get_arg1(icall);
+	nodelay = ipc_get_arg2(icall) != 0;
+	rc = tcp_conn_set_nodelay_impl(client, conn_id, nodelay);
+	async_answer_0(icall, rc);
+}
+
+/** Get connection list.
+ *
+ * Handle client request to get information on all connections.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_get_conn_list_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	tcp_conn_info_t *info;
+	size_t count;
+	size_t max_size;
+	size_t act_size;
+	size_t size;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_get_conn_list_srv()");
+
+	if (!async_data_read_receive(&call, &max_size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	rc = tcp_conn_get_info_list(&info, &count);
+	if (rc != EOK) {
+		async_answer_0(&call, rc);
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	act_size = count * sizeof(tcp_conn_info_t);
+	size = min(act_size, max_size);
+
+	errno_t retval = async_data_read_finalize(&call, info, size);
+	free(info);
+
+	async_answer_1(icall, retval, act_size);
+}
+
 /** Reset connection.
  *
  * Handle client request to reset connection.
@@ -996,6 +1091,87 @@ static void tcp_conn_send_srv(tcp_client_t *client, ipc_call_t *icall)
 	free(data);
 }
 
+/** Set up buffer shared by client.
+ *
+ * Handle client request to share a buffer for sending files.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_shm_setup_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	unsigned int flags;
+	void *area;
+	size_t size;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_shm_setup_srv()");
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	if ((flags & AS_AREA_READ) == 0) {
+		async_answer_0(&call, EPERM);
+		async_answer_0(icall, EPERM);
+		return;
+	}
+
+	if (client->shm != NULL) {
+		async_answer_0(&call, EEXIST);
+		async_answer_0(icall, EEXIST);
+		return;
+	}
+
+	rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK || area == AS_MAP_FAILED) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	client->shm = area;
+	client->shm_size = size;
+	async_answer_0(icall, EOK);
+}
+
+/** Send data from shared buffer via connection.
+ *
+ * Handle client request to send data placed at the start of the buffer
+ * shared by the client.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_conn_send_shm_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	sysarg_t conn_id;
+	size_t size;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_send_shm_srv()");
+
+	conn_id = ipc_get_arg1(icall);
+	size = ipc_get_arg2(icall);
+
+	if (client->shm == NULL) {
+		async_answer_0(icall, ENOENT);
+		return;
+	}
+
+	if (size > client->shm_size) {
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	rc = tcp_conn_send_impl(client, conn_id, client->shm, size);
+	async_answer_0(icall, rc);
+}
+
 /** Read received data from connection without blocking.
  *
  * Handle client request to read received data via connection without blocking.
@@ -1153,6 +1329,11 @@ static void tcp_client_fini(tcp_client_t *client)
 		/* XXX Destroy listeners */
 	}
 
+	if (client->shm != NULL) {
+		as_area_destroy(client->shm);
+		client->shm = NULL;
+	}
+
 	if (client->sess != NULL)
 		async_hangup(client->sess);
 }
@@ -1223,6 +1404,18 @@ static void tcp_client_conn(ipc_call_t *icall, void *arg)
 		case TCP_CONN_RECV_WAIT:
 			tcp_conn_recv_wait_srv(&client, &call);
 			break;
+		case TCP_CONN_SET_NODELAY:
+			tcp_conn_set_nodelay_srv(&client, &call);
+			break;
+		case TCP_GET_CONN_LIST:
+			tcp_get_conn_list_srv(&client, &call);
+			break;
+		case TCP_SHM_SETUP:
+			tcp_shm_setup_srv(&client, &call);
+			break;
+		case TCP_CONN_SEND_SHM:
+			tcp_conn_send_shm_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -38,8 +38,10 @@
 #include <errno.h>
 #include <io/log.h>
 #include <stdio.h>
+#include <str.h>
 #include <task.h>
 
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
 #include "ncsim.h"
@@ -89,12 +91,33 @@ static errno_t tcp_init(void)
 	return EOK;
 }
 
+static void print_syntax(void)
+{
+	printf("Syntax: %s [--cubic] [--no-offload]\n", NAME);
+	printf("\t--cubic\tUse CUBIC congestion control instead of NewReno\n");
+	printf("\t--no-offload\tCompute checksums and segment data in TCP\n");
+}
+
 int main(int argc, char **argv)
 {
 	errno_t rc;
+	int i;
 
 	printf(NAME ": TCP (Transmission Control Protocol) network module\n");
 
+	tcp_conn_offload = true;
+
+	for (i = 1; i < argc; i++) {
+		if (str_cmp(argv[i], "--cubic") == 0) {
+			tcp_cc_default = tcp_cc_cubic;
+		} else if (str_cmp(argv[i], "--no-offload") == 0) {
+			tcp_conn_offload = false;
+		} else {
+			print_syntax();
+			return 1;
+		}
+	}
+
 	rc = log_init(NAME);
 	if (rc != EOK) {
 		printf(NAME ": Failed to initialize log.\n");
@@ -43,6 +43,7 @@
 #include <refcount.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 #include <inet/addr.h>
 #include <inet/endpoint.h>
 
@@ -154,6 +155,49 @@ typedef struct {
 	tcp_cstate_t cstate;
 } tcp_conn_status_t;
 
+/** Maximum number of SACK blocks in a segment */
+#define TCP_SACK_BLOCKS_MAX 4
+
+/** SACK block */
+typedef struct {
+	/** First sequence number in the block */
+	uint32_t start;
+	/** Sequence number immediately following the block */
+	uint32_t end;
+} tcp_sack_block_t;
+
+/** Bits in tcp_opts_t.flags */
+typedef enum {
+	/** Maximum segment size */
+	tcp_opt_mss = 0x01,
+	/** Window scale */
+	tcp_opt_wscale = 0x02,
+	/** SACK permitted */
+	tcp_opt_sack_perm = 0x04,
+	/** Timestamps */
+	tcp_opt_ts = 0x08,
+	/** SACK */
+	tcp_opt_sack = 0x10
+} tcp_opt_flags_t;
+
+/** Segment options */
+typedef struct {
+	/** Options present (tcp_opt_flags_t bits) */
+	unsigned flags;
+	/** Maximum segment size */
+	uint16_t mss;
+	/** Window scale shift count */
+	uint8_t wscale;
+	/** Timestamp value */
+	uint32_t tsval;
+	/** Timestamp echo reply */
+	uint32_t tsecr;
+	/** Number of SACK blocks */
+	size_t sack_cnt;
+	/** SACK blocks */
+	tcp_sack_block_t sack[TCP_SACK_BLOCKS_MAX];
+} tcp_opts_t;
+
 typedef struct {
 	/** SYN, FIN */
 	tcp_control_t ctrl;
@@ -168,6 +212,8 @@ typedef struct {
 	uint32_t wnd;
 	/** Segment urgent pointer */
 	uint32_t up;
+	/** Segment options */
+	tcp_opts_t opts;
 
 	/** Segment data, may be moved when trimming segment */
 	void *data;
@@ -196,6 +242,18 @@ typedef struct {
 	tcp_segment_t *seg;
 } tcp_squeue_entry_t;
 
+/** NCSim scenario */
+typedef struct {
+	/** Scenario name */
+	const char *name;
+	/** Probability of dropping a segment (per mille) */
+	unsigned drop;
+	/** Minimum one-way delay (microseconds) */
+	usec_t delay_min;
+	/** Maximum one-way delay (microseconds) */
+	usec_t delay_max;
+} tcp_ncsim_cfg_t;
+
 /** Incoming queue entry */
 typedef struct {
 	link_t link;
@@ -207,6 +265,10 @@ typedef struct {
 	link_t link;
 	tcp_conn_t *conn;
 	tcp_segment_t *seg;
+	/** Segment has been selectively acknowledged by the peer */
+	bool sacked;
+	/** Segment has been retransmitted since the last timeout */
+	bool rexmit;
 } tcp_tqueue_entry_t;
 
 /** Retransmission queue callbacks */
@@ -215,18 +277,107 @@ typedef struct {
 	void (*transmit_seg)(inet_ep2_t *, tcp_segment_t *);
 } tcp_tqueue_cb_t;
 
+/** Timer handler */
+typedef void (*tcp_timer_func_t)(void *);
+
+/** Timer driven by the TCP timer wheel */
+typedef struct {
+	/** Link to timer wheel slot or list of expired timers */
+	link_t link;
+	/** Tick at which the timer expires */
+	uint64_t expires;
+	/** Timer is pending (its handler has not been called yet) */
+	bool active;
+	/** Handler */
+	tcp_timer_func_t func;
+	/** Handler argument */
+	void *arg;
+} tcp_timer_t;
+
 /** Retransmission queue */
 typedef struct {
 	struct tcp_conn *conn;
 	list_t list;
 
 	/** Retransmission timer */
-	fibril_timer_t *timer;
+	tcp_timer_t timer;
+	/** Delayed acknowledgement timer */
+	tcp_timer_t ack_timer;
 
 	/** Callbacks */
 	tcp_tqueue_cb_t *cb;
 } tcp_tqueue_t;
 
+/** Congestion control algorithm */
+typedef enum {
+	/** NewReno (RFC 5681, RFC 6582) */
+	tcp_cc_newreno,
+	/** CUBIC (RFC 8312) */
+	tcp_cc_cubic
+} tcp_cc_alg_t;
+
+/** Congestion control and round-trip time estimation state */
+typedef struct {
+	/** Congestion control algorithm */
+	tcp_cc_alg_t alg;
+	/** Congestion window (bytes) */
+	uint32_t cwnd;
+	/** Slow start threshold (bytes) */
+	uint32_t ssthresh;
+	/** SND.UNA when congestion control last saw an ACK */
+	uint32_t una;
+	/** Number of consecutive duplicate ACKs */
+	unsigned dupacks;
+	/** Fast recovery in progress */
+	bool recovery;
+	/** SND.NXT when fast recovery was entered */
+	uint32_t recover;
+	/** Bytes acked towards next congestion avoidance increase */
+	uint32_t bytes_acked;
+
+	/** CUBIC: congestion window before the last reduction (bytes) */
+	uint32_t w_max;
+	/** CUBIC: start of current congestion avoidance epoch, 0 if none */
+	usec_t epoch_start;
+	/** CUBIC: time to grow back to @c w_max (milliseconds) */
+	uint32_t k;
+	/** CUBIC: window NewReno would have in the same epoch (bytes) */
+	uint32_t w_est;
+
+	/** Smoothed round-trip time (microseconds) */
+	usec_t srtt;
+	/** Round-trip time variation (microseconds) */
+	usec_t rttvar;
+	/** Retransmission timeout (microseconds) */
+	usec_t rto;
+	/** At least one round-trip time sample has been taken */
+	bool rtt_valid;
+	/** A segment is being timed */
+	bool rtt_timing;
+	/** Acknowledgement number that acknowledges the timed segment */
+	uint32_t rtt_seq;
+	/** When the timed segment was sent (microseconds of uptime) */
+	usec_t rtt_start;
+} tcp_cc_t;
+
+/** Connection statistics */
+typedef struct {
+	/** Segments received */
+	uint64_t segs_in;
+	/** Segments sent */
+	uint64_t segs_out;
+	/** Data bytes received */
+	uint64_t bytes_in;
+	/** Data bytes sent, including retransmissions */
+	uint64_t bytes_out;
+	/** Segments retransmitted */
+	uint64_t retransmits;
+	/** Retransmission timeouts */
+	uint64_t rto_timeouts;
+	/** Duplicate ACKs received */
+	uint64_t dupacks;
+} tcp_conn_stats_t;
+
 /** Connection */
 struct tcp_conn {
 	char *name;
@@ -268,8 +419,13 @@ struct tcp_conn {
 	/** Retransmission queue */
 	tcp_tqueue_t retransmit;
 
+	/** Congestion control */
+	tcp_cc_t cc;
+	/** Statistics */
+	tcp_conn_stats_t stats;
+
 	/** Time-Wait timeout timer */
-	fibril_timer_t *tw_timer;
+	tcp_timer_t tw_timer;
 
 	/** Receive buffer */
 	uint8_t *rcv_buf;
@@ -292,6 +448,10 @@ struct tcp_conn {
 	bool snd_buf_fin;
 	/** Send buffer CV. Broadcast when space is made available in buffer */
 	fibril_condvar_t snd_buf_cv;
+	/** Send small segments without waiting for ACK (no Nagle algorithm) */
+	bool nodelay;
+	/** Send out buffered data without waiting for a full segment */
+	bool snd_push;
 
 	/** Send unacknowledged */
 	uint32_t snd_una;
@@ -312,10 +472,29 @@ struct tcp_conn {
 	uint32_t rcv_nxt;
 	/** Receive window */
 	uint32_t rcv_wnd;
+	/** Right edge of receive window last advertised to peer */
+	uint32_t rcv_adv;
+	/** Number of bytes received but not acknowledged yet */
+	uint32_t rcv_unacked;
 	/** Receive urgent pointer */
 	uint32_t rcv_up;
 	/** Initial receive sequence number */
 	uint32_t irs;
+
+	/** Window scaling has been negotiated */
+	bool ws_ok;
+	/** Shift count applied to window received from peer */
+	uint8_t snd_wscale;
+	/** Shift count applied to window we advertise */
+	uint8_t rcv_wscale;
+	/** Peer has permitted SACK */
+	bool sack_ok;
+	/** Timestamps have been negotiated */
+	bool ts_ok;
+	/** Timestamp to echo to peer (TS.Recent) */
+	uint32_t ts_recent;
+	/** Acknowledgement number in last segment sent (Last.ACK.sent) */
+	uint32_t last_ack_sent;
 };
 
 /** Continuation of processing.
@@ -342,6 +521,10 @@ typedef struct {
 	void *text;
 	/** Text size */
 	size_t text_size;
+	/** Checksum field only holds the pseudo-header sum */
+	bool csum_partial;
+	/** Segment size for segmentation offload, zero if none */
+	uint16_t tso_mss;
 } tcp_pdu_t;
 
 /** TCP client connection */
@@ -377,6 +560,10 @@ typedef struct tcp_client {
 	list_t cconn; /* of tcp_cconn_t */
 	/** Client's listeners */
 	list_t clst;
+	/** Buffer shared by the client for sending files or @c NULL */
+	void *shm;
+	/** Size of @c shm */
+	size_t shm_size;
 } tcp_client_t;
 
 /** Internal loopback type */
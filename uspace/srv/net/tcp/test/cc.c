@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//#include <inet/endpoint.h>
+#include <errno.h>
+#include <inet/endpoint.h>
+#include <io/log.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+#include "../cc.h"
+#include "../conn.h"
+#include "../ncsim.h"
+#include "../segment.h"
+#include "../tqueue.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(cc);
+
+enum {
+	test_seg_max = 10
+};
+
+static int seg_cnt;
+static tcp_segment_t *trans_seg[test_seg_max];
+
+static void cc_test_transmit_seg(inet_ep2_t *, tcp_segment_t *);
+
+static tcp_tqueue_cb_t cc_test_cb = {
+	.transmit_seg = cc_test_transmit_seg
+};
+
+PCUT_TEST_BEFORE
+{
+	errno_t rc;
+
+	/* We will be calling functions that perform logging */
+	rc = log_init("test-tcp");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = tcp_conns_init();
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+PCUT_TEST_AFTER
+{
+	tcp_conns_fini();
+}
+
+/** Create connection with outstanding data for testing. */
+static tcp_conn_t *cc_test_conn(uint32_t flight)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->retransmit.cb = &cc_test_cb;
+	seg_cnt = 0;
+
+	conn->cstate = st_established;
+	conn->snd_una = 10;
+	conn->snd_nxt = 10 + flight;
+	conn->snd_wnd = 65535;
+	tcp_cc_sync(conn);
+
+	return conn;
+}
+
+/** New connection starts with the initial window and RTO */
+PCUT_TEST(init)
+{
+	tcp_conn_t *conn;
+
+	conn = cc_test_conn(0);
+
+	PCUT_ASSERT_INT_EQUALS(3 * TCP_SMSS, conn->cc.cwnd);
+	PCUT_ASSERT_TRUE(conn->cc.ssthresh == UINT32_MAX);
+	PCUT_ASSERT_TRUE(conn->cc.rto == 1000 * 1000);
+	PCUT_ASSERT_FALSE(conn->cc.rtt_valid);
+
+	tcp_conn_delete(conn);
+}
+
+/** Congestion window grows by up to SMSS per ACK in slow start */
+PCUT_TEST(slow_start)
+{
+	tcp_conn_t *conn;
+	uint32_t cwnd;
+
+	conn = cc_test_conn(3 * TCP_SMSS);
+	cwnd = conn->cc.cwnd;
+
+	conn->snd_una += TCP_SMSS;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_INT_EQUALS(cwnd + TCP_SMSS, conn->cc.cwnd);
+
+	/* ACK for less than SMSS grows window by the amount acked */
+	conn->snd_una += 100;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_INT_EQUALS(cwnd + TCP_SMSS + 100, conn->cc.cwnd);
+
+	tcp_conn_delete(conn);
+}
+
+/** Congestion window grows by SMSS per window in congestion avoidance */
+PCUT_TEST(cong_avoid)
+{
+	tcp_conn_t *conn;
+
+	conn = cc_test_conn(8 * TCP_SMSS);
+	conn->cc.cwnd = 4 * TCP_SMSS;
+	conn->cc.ssthresh = 4 * TCP_SMSS;
+
+	conn->snd_una += 3 * TCP_SMSS;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_INT_EQUALS(4 * TCP_SMSS, conn->cc.cwnd);
+
+	conn->snd_una += TCP_SMSS;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_INT_EQUALS(5 * TCP_SMSS, conn->cc.cwnd);
+
+	tcp_conn_delete(conn);
+}
+
+/** Retransmission timeout collapses the window and backs off the timer */
+PCUT_TEST(timeout)
+{
+	tcp_conn_t *conn;
+
+	conn = cc_test_conn(20000);
+	conn->cc.cwnd = 20000;
+
+	tcp_cc_timeout(conn);
+	PCUT_ASSERT_INT_EQUALS(10000, conn->cc.ssthresh);
+	PCUT_ASSERT_INT_EQUALS(TCP_SMSS, conn->cc.cwnd);
+	PCUT_ASSERT_TRUE(conn->cc.rto == 2 * 1000 * 1000);
+
+	/* Slow start threshold does not drop below two segments */
+	conn->snd_nxt = conn->snd_una + TCP_SMSS;
+	tcp_cc_timeout(conn);
+	PCUT_ASSERT_INT_EQUALS(2 * TCP_SMSS, conn->cc.ssthresh);
+	PCUT_ASSERT_TRUE(conn->cc.rto == 4 * 1000 * 1000);
+
+	tcp_conn_delete(conn);
+}
+
+/** RTT samples update SRTT, RTTVAR and RTO */
+PCUT_TEST(rtt_estimate)
+{
+	tcp_conn_t *conn;
+
+	conn = cc_test_conn(0);
+
+	/* First sample */
+	tcp_cc_rtt_sample(conn, 2000 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.rtt_valid);
+	PCUT_ASSERT_TRUE(conn->cc.srtt == 2000 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.rttvar == 1000 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.rto == 6000 * 1000);
+
+	/* Subsequent sample */
+	tcp_cc_rtt_sample(conn, 1000 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.srtt == 1875 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.rttvar == 1000 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.rto == 5875 * 1000);
+
+	tcp_conn_delete(conn);
+
+	/* RTO does not drop below one second */
+	conn = cc_test_conn(0);
+	tcp_cc_rtt_sample(conn, 100 * 1000);
+	PCUT_ASSERT_TRUE(conn->cc.rto == 1000 * 1000);
+	tcp_conn_delete(conn);
+}
+
+/** Three duplicate ACKs trigger fast retransmit and recovery */
+PCUT_TEST(fast_retransmit)
+{
+	tcp_conn_t *conn;
+	int i;
+
+	conn = cc_test_conn(0);
+	conn->snd_buf_used = 2 * TCP_SMSS + 1000;
+	conn->snd_buf_fin = false;
+
+	tcp_conn_lock(conn);
+	tcp_tqueue_new_data(conn);
+
+	/* Data is sent in SMSS-sized segments */
+	PCUT_ASSERT_INT_EQUALS(3, seg_cnt);
+	PCUT_ASSERT_INT_EQUALS(TCP_SMSS, trans_seg[0]->len);
+	PCUT_ASSERT_INT_EQUALS(1000, trans_seg[2]->len);
+	PCUT_ASSERT_INT_EQUALS(10 + 2 * TCP_SMSS + 1000, conn->snd_nxt);
+
+	tcp_cc_dupack(conn);
+	tcp_cc_dupack(conn);
+	PCUT_ASSERT_INT_EQUALS(3, seg_cnt);
+	PCUT_ASSERT_FALSE(conn->cc.recovery);
+
+	/* First segment is retransmitted */
+	tcp_cc_dupack(conn);
+	PCUT_ASSERT_INT_EQUALS(4, seg_cnt);
+	PCUT_ASSERT_INT_EQUALS(10, trans_seg[3]->seq);
+	PCUT_ASSERT_INT_EQUALS(TCP_SMSS, trans_seg[3]->len);
+	PCUT_ASSERT_TRUE(conn->cc.recovery);
+	PCUT_ASSERT_INT_EQUALS(2 * TCP_SMSS, conn->cc.ssthresh);
+	PCUT_ASSERT_INT_EQUALS(5 * TCP_SMSS, conn->cc.cwnd);
+
+	/* Further duplicate ACKs inflate the window */
+	tcp_cc_dupack(conn);
+	PCUT_ASSERT_INT_EQUALS(6 * TCP_SMSS, conn->cc.cwnd);
+
+	/* Partial ACK retransmits the next segment */
+	conn->snd_una = 10 + TCP_SMSS;
+	tcp_tqueue_ack_received(conn);
+	PCUT_ASSERT_INT_EQUALS(5, seg_cnt);
+	PCUT_ASSERT_INT_EQUALS(10 + TCP_SMSS, trans_seg[4]->seq);
+	PCUT_ASSERT_TRUE(conn->cc.recovery);
+
+	/* Full ACK deflates the window and leaves recovery */
+	conn->snd_una = 10 + 2 * TCP_SMSS + 1000;
+	tcp_tqueue_ack_received(conn);
+	PCUT_ASSERT_FALSE(conn->cc.recovery);
+	PCUT_ASSERT_INT_EQUALS(2 * TCP_SMSS, conn->cc.cwnd);
+
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+	tcp_conn_delete(conn);
+
+	for (i = 0; i < seg_cnt; i++)
+		tcp_segment_delete(trans_seg[i]);
+}
+
+/** CUBIC reduces the window less than NewReno and regrows it faster */
+PCUT_TEST(cubic)
+{
+	tcp_conn_t *conn;
+	uint32_t cwnd;
+
+	conn = cc_test_conn(20000);
+	conn->cc.alg = tcp_cc_cubic;
+	conn->cc.cwnd = 20000;
+
+	tcp_conn_lock(conn);
+	tcp_cc_dupack(conn);
+	tcp_cc_dupack(conn);
+	tcp_cc_dupack(conn);
+	tcp_conn_unlock(conn);
+	PCUT_ASSERT_TRUE(conn->cc.recovery);
+	PCUT_ASSERT_INT_EQUALS(20000, conn->cc.w_max);
+	PCUT_ASSERT_INT_EQUALS(14000, conn->cc.ssthresh);
+
+	/* Leave recovery */
+	conn->snd_una = conn->snd_nxt;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_FALSE(conn->cc.recovery);
+	PCUT_ASSERT_INT_EQUALS(14000, conn->cc.cwnd);
+
+	/* Start of epoch, close to the plateau the window grows slowly */
+	conn->snd_nxt += 10 * TCP_SMSS;
+	conn->snd_una += TCP_SMSS;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_TRUE(conn->cc.k > 0);
+	PCUT_ASSERT_TRUE(conn->cc.cwnd >= 14000);
+	PCUT_ASSERT_TRUE(conn->cc.cwnd < 14000 + TCP_SMSS);
+
+	/* Beyond K the window grows past W_max quickly */
+	conn->cc.epoch_start -= 4000 * 1000;
+	cwnd = conn->cc.cwnd;
+	conn->snd_una += TCP_SMSS;
+	tcp_cc_ack(conn);
+	PCUT_ASSERT_TRUE(conn->cc.cwnd > cwnd + TCP_SMSS / 4);
+
+	tcp_conn_delete(conn);
+}
+
+/** Network condition simulator scenarios can be selected by name */
+PCUT_TEST(ncsim_scenario)
+{
+	errno_t rc;
+
+	rc = tcp_ncsim_scenario_set("lossy");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_STR_EQUALS("lossy", tcp_ncsim_scenario_get()->name);
+	PCUT_ASSERT_TRUE(tcp_ncsim_scenario_get()->drop > 0);
+
+	rc = tcp_ncsim_scenario_set("nonexistent");
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+	PCUT_ASSERT_STR_EQUALS("lossy", tcp_ncsim_scenario_get()->name);
+
+	rc = tcp_ncsim_scenario_set("none");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+}
+
+static void cc_test_transmit_seg(inet_ep2_t *epp, tcp_segment_t *seg)
+{
+	if (seg_cnt < test_seg_max)
+		trans_seg[seg_cnt++] = tcp_segment_dup(seg);
+}
+
+PCUT_EXPORT(cc);
@@ -175,4 +175,64 @@ PCUT_TEST(two_segments)
 	tcp_conn_delete(conn);
 }
 
+/** Test describing out-of-order segments as SACK blocks */
+PCUT_TEST(sack_blocks)
+{
+	tcp_conn_t *conn;
+	tcp_iqueue_t iqueue;
+	inet_ep2_t epp;
+	tcp_segment_t *seg[4];
+	tcp_sack_block_t blocks[TCP_SACK_BLOCKS_MAX];
+	uint32_t seq[4] = { 10, 20, 30, 60 };
+	void *data;
+	size_t dsize;
+	size_t cnt;
+	int i;
+
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->rcv_nxt = 10;
+	conn->rcv_wnd = 100;
+
+	dsize = 10;
+	data = calloc(dsize, 1);
+	PCUT_ASSERT_NOT_NULL(data);
+
+	tcp_iqueue_init(&iqueue, conn);
+
+	/* Nothing out of order */
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, TCP_SACK_BLOCKS_MAX);
+	PCUT_ASSERT_INT_EQUALS(0, cnt);
+
+	for (i = 0; i < 4; i++) {
+		seg[i] = tcp_segment_make_data(0, data, dsize);
+		PCUT_ASSERT_NOT_NULL(seg[i]);
+		seg[i]->seq = seq[i];
+		tcp_iqueue_insert_seg(&iqueue, seg[i]);
+	}
+
+	/* Ready segment is not reported, adjacent segments are merged */
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, TCP_SACK_BLOCKS_MAX);
+	PCUT_ASSERT_INT_EQUALS(2, cnt);
+	PCUT_ASSERT_INT_EQUALS(20, blocks[0].start);
+	PCUT_ASSERT_INT_EQUALS(40, blocks[0].end);
+	PCUT_ASSERT_INT_EQUALS(60, blocks[1].start);
+	PCUT_ASSERT_INT_EQUALS(70, blocks[1].end);
+
+	/* Number of blocks is limited */
+	cnt = tcp_iqueue_sack_blocks(&iqueue, blocks, 1);
+	PCUT_ASSERT_INT_EQUALS(1, cnt);
+	PCUT_ASSERT_INT_EQUALS(40, blocks[0].end);
+
+	for (i = 0; i < 4; i++) {
+		tcp_iqueue_remove_seg(&iqueue, seg[i]);
+		tcp_segment_delete(seg[i]);
+	}
+
+	free(data);
+	tcp_conn_delete(conn);
+}
+
 PCUT_EXPORT(iqueue);
@@ -56,12 +56,14 @@ void test_seg_same(tcp_segment_t *a, tcp_segment_t *b)
 
 PCUT_INIT;
 
+PCUT_IMPORT(cc);
 PCUT_IMPORT(conn);
 PCUT_IMPORT(iqueue);
 PCUT_IMPORT(pdu);
 PCUT_IMPORT(rqueue);
 PCUT_IMPORT(segment);
 PCUT_IMPORT(seq_no);
+PCUT_IMPORT(timer);
 PCUT_IMPORT(tqueue);
 PCUT_IMPORT(ucall);
 
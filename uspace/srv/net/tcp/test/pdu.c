@@ -26,7 +26,9 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <byteorder.h>
 #include <errno.h>
+#include <inet/checksum.h>
 #include <inet/endpoint.h>
 #include <mem.h>
 #include <pcut/pcut.h>
@@ -35,6 +37,7 @@
 #include "main.h"
 #include "../pdu.h"
 #include "../segment.h"
+#include "../std.h"
 
 PCUT_INIT;
 
@@ -108,4 +111,142 @@ PCUT_TEST(encdec_data)
 	free(data);
 }
 
+/** Test encode/decode round trip for segment options */
+PCUT_TEST(encdec_opts)
+{
+	tcp_segment_t *seg, *dseg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t epp, depp;
+	size_t i;
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	seg = tcp_segment_make_ctrl(CTL_SYN | CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	seg->opts.flags = tcp_opt_mss | tcp_opt_wscale | tcp_opt_sack_perm |
+	    tcp_opt_ts;
+	seg->opts.mss = 1460;
+	seg->opts.wscale = 7;
+	seg->opts.tsval = 0x12345678;
+	seg->opts.tsecr = 0x9abcdef0;
+
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(sizeof(tcp_header_t) + 24, pdu->header_size);
+	rc = tcp_pdu_decode(pdu, &depp, &dseg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	test_seg_same(seg, dseg);
+	PCUT_ASSERT_INT_EQUALS(seg->opts.flags, dseg->opts.flags);
+	PCUT_ASSERT_INT_EQUALS(1460, dseg->opts.mss);
+	PCUT_ASSERT_INT_EQUALS(7, dseg->opts.wscale);
+	PCUT_ASSERT_INT_EQUALS(0x12345678, dseg->opts.tsval);
+	PCUT_ASSERT_INT_EQUALS(0x9abcdef0, dseg->opts.tsecr);
+
+	tcp_pdu_delete(pdu);
+	tcp_segment_delete(dseg);
+	tcp_segment_delete(seg);
+
+	/* Only three SACK blocks fit next to timestamps */
+	seg = tcp_segment_make_ctrl(CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	seg->opts.flags = tcp_opt_ts | tcp_opt_sack;
+	seg->opts.sack_cnt = 4;
+	for (i = 0; i < 4; i++) {
+		seg->opts.sack[i].start = 100 * i;
+		seg->opts.sack[i].end = 100 * i + 50;
+	}
+
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(sizeof(tcp_header_t) + 40, pdu->header_size);
+	rc = tcp_pdu_decode(pdu, &depp, &dseg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_INT_EQUALS(tcp_opt_ts | tcp_opt_sack, dseg->opts.flags);
+	PCUT_ASSERT_INT_EQUALS(3, dseg->opts.sack_cnt);
+	for (i = 0; i < 3; i++) {
+		PCUT_ASSERT_INT_EQUALS(100 * i, dseg->opts.sack[i].start);
+		PCUT_ASSERT_INT_EQUALS(100 * i + 50, dseg->opts.sack[i].end);
+	}
+
+	tcp_pdu_delete(pdu);
+	tcp_segment_delete(dseg);
+	tcp_segment_delete(seg);
+}
+
+/** Test that encoded PDU passes checksum verification */
+PCUT_TEST(checksum)
+{
+	tcp_segment_t *seg;
+	tcp_pdu_t *pdu;
+	inet_ep2_t epp;
+	uint8_t data[7] = { 1, 2, 3, 4, 5, 6, 7 };
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	seg = tcp_segment_make_data(0, data, sizeof(data));
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	rc = tcp_pdu_encode(&epp, seg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(tcp_pdu_checksum_ok(pdu));
+
+	/* Corrupt one byte of text */
+	((uint8_t *) pdu->text)[3] ^= 0x10;
+	PCUT_ASSERT_FALSE(tcp_pdu_checksum_ok(pdu));
+
+	tcp_pdu_delete(pdu);
+	tcp_segment_delete(seg);
+}
+
+/** Test completing checksum of PDU encoded for offload */
+PCUT_TEST(encode_partial)
+{
+	tcp_segment_t *seg;
+	tcp_pdu_t *pdu;
+	tcp_header_t *hdr;
+	inet_ep2_t epp;
+	uint8_t data[7] = { 1, 2, 3, 4, 5, 6, 7 };
+	uint16_t cs;
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 1, 2, 3, 4);
+	inet_addr(&epp.remote.addr, 5, 6, 7, 8);
+
+	seg = tcp_segment_make_data(0, data, sizeof(data));
+	PCUT_ASSERT_NOT_NULL(seg);
+
+	rc = tcp_pdu_encode_partial(&epp, seg, 1460, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(pdu->csum_partial);
+	PCUT_ASSERT_INT_EQUALS(0, pdu->tso_mss);
+
+	/* Complete the checksum as the NIC would */
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, pdu->header,
+	    pdu->header_size);
+	cs = inet_checksum_calc(cs, pdu->text, pdu->text_size);
+	hdr = (tcp_header_t *) pdu->header;
+	hdr->checksum = host2uint16_t_be(cs);
+	PCUT_ASSERT_TRUE(tcp_pdu_checksum_ok(pdu));
+	tcp_pdu_delete(pdu);
+
+	/* Text longer than MSS is marked for segmentation */
+	rc = tcp_pdu_encode_partial(&epp, seg, 4, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(4, pdu->tso_mss);
+	tcp_pdu_delete(pdu);
+
+	tcp_segment_delete(seg);
+}
+
 PCUT_EXPORT(pdu);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fibril.h>
+#include <io/log.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+
+#include "../timer.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(timer);
+
+static int fired;
+
+static void test_timer_func(void *arg)
+{
+	int *counter = (int *) arg;
+
+	++*counter;
+}
+
+PCUT_TEST_BEFORE
+{
+	errno_t rc;
+
+	/* We will be calling functions that perform logging */
+	rc = log_init("test-tcp");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	fired = 0;
+}
+
+/** Timer handler is called once after the timer expires */
+PCUT_TEST(set_expire)
+{
+	tcp_timer_t timer;
+
+	tcp_timer_init(&timer);
+	tcp_timer_set(&timer, 20 * 1000, test_timer_func, &fired);
+	PCUT_ASSERT_INT_EQUALS(0, fired);
+
+	fibril_usleep(200 * 1000);
+	PCUT_ASSERT_INT_EQUALS(1, fired);
+
+	/* Timer is no longer pending */
+	PCUT_ASSERT_FALSE(tcp_timer_clear(&timer));
+	tcp_timer_fini(&timer);
+}
+
+/** Cleared timer does not fire */
+PCUT_TEST(clear)
+{
+	tcp_timer_t timer;
+
+	tcp_timer_init(&timer);
+	tcp_timer_set(&timer, 20 * 1000, test_timer_func, &fired);
+	PCUT_ASSERT_TRUE(tcp_timer_clear(&timer));
+	PCUT_ASSERT_FALSE(tcp_timer_clear(&timer));
+
+	fibril_usleep(200 * 1000);
+	PCUT_ASSERT_INT_EQUALS(0, fired);
+	tcp_timer_fini(&timer);
+}
+
+/** Re-setting a pending timer postpones it and replaces the handler */
+PCUT_TEST(reset)
+{
+	tcp_timer_t timer;
+	int other = 0;
+
+	tcp_timer_init(&timer);
+	tcp_timer_set(&timer, 20 * 1000, test_timer_func, &other);
+	tcp_timer_set(&timer, 300 * 1000, test_timer_func, &fired);
+
+	fibril_usleep(100 * 1000);
+	PCUT_ASSERT_INT_EQUALS(0, other);
+	PCUT_ASSERT_INT_EQUALS(0, fired);
+
+	fibril_usleep(500 * 1000);
+	PCUT_ASSERT_INT_EQUALS(0, other);
+	PCUT_ASSERT_INT_EQUALS(1, fired);
+	tcp_timer_fini(&timer);
+}
+
+/** Timers longer than one revolution of the wheel fire on time */
+PCUT_TEST(long_delay)
+{
+	tcp_timer_t timer;
+
+	tcp_timer_init(&timer);
+	tcp_timer_set(&timer, 6 * 1000 * 1000, test_timer_func, &fired);
+
+	fibril_usleep(5500 * 1000);
+	PCUT_ASSERT_INT_EQUALS(0, fired);
+
+	fibril_usleep(1500 * 1000);
+	PCUT_ASSERT_INT_EQUALS(1, fired);
+	tcp_timer_fini(&timer);
+}
+
+PCUT_EXPORT(timer);
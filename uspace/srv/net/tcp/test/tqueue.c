@@ -27,9 +27,11 @@
  */
 
 //#include <inet/endpoint.h>
+#include <fibril.h>
 #include <io/log.h>
 #include <pcut/pcut.h>
 
+#include "../cc.h"
 #include "../conn.h"
 #include "../segment.h"
 #include "../tqueue.h"
@@ -219,6 +221,8 @@ PCUT_TEST(ack_received)
 	conn->snd_una = 10;
 	conn->snd_nxt = 10;
 	conn->snd_wnd = 1024;
+	/* Do not hold back the second small segment */
+	conn->nodelay = true;
 
 	/* Redirect segment transmission */
 	conn->retransmit.cb = &tqueue_test_cb;
@@ -257,6 +261,179 @@ PCUT_TEST(ack_received)
 	tcp_conn_delete(conn);
 }
 
+/** Test retransmitting only segments missing from SACK scoreboard */
+PCUT_TEST(sack_retransmit)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+	tcp_segment_t *aseg;
+	int i;
+
+	/* XXX tqueue can only be created via tcp_conn_new */
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->cstate = st_established;
+	conn->snd_una = 10;
+	conn->snd_nxt = 10;
+	conn->snd_wnd = 65535;
+	conn->sack_ok = true;
+	conn->cc.cwnd = 10 * TCP_SMSS;
+	conn->snd_buf_used = 4 * TCP_SMSS;
+	conn->snd_buf_fin = false;
+
+	/* Redirect segment transmission */
+	conn->retransmit.cb = &tqueue_test_cb;
+	seg_cnt = 0;
+
+	tcp_conn_lock(conn);
+	tcp_tqueue_new_data(conn);
+	PCUT_ASSERT_INT_EQUALS(4, seg_cnt);
+
+	/* Peer has received the second and fourth segment */
+	aseg = tcp_segment_make_ctrl(CTL_ACK);
+	PCUT_ASSERT_NOT_NULL(aseg);
+	aseg->ack = 10;
+	aseg->opts.flags = tcp_opt_sack;
+	aseg->opts.sack_cnt = 2;
+	aseg->opts.sack[0].start = 10 + TCP_SMSS;
+	aseg->opts.sack[0].end = 10 + 2 * TCP_SMSS;
+	aseg->opts.sack[1].start = 10 + 3 * TCP_SMSS;
+	aseg->opts.sack[1].end = 10 + 4 * TCP_SMSS;
+	tcp_tqueue_sack(conn, aseg);
+	tcp_segment_delete(aseg);
+
+	/* First hole */
+	tcp_tqueue_retransmit(conn);
+	PCUT_ASSERT_INT_EQUALS(5, seg_cnt);
+	PCUT_ASSERT_INT_EQUALS(10, trans_seg[4]->seq);
+
+	/* Second hole */
+	tcp_tqueue_sack_retransmit(conn);
+	PCUT_ASSERT_INT_EQUALS(6, seg_cnt);
+	PCUT_ASSERT_INT_EQUALS(10 + 2 * TCP_SMSS, trans_seg[5]->seq);
+
+	/* No more holes */
+	tcp_tqueue_sack_retransmit(conn);
+	PCUT_ASSERT_INT_EQUALS(6, seg_cnt);
+
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+	tcp_conn_delete(conn);
+
+	for (i = 0; i < seg_cnt; i++)
+		tcp_segment_delete(trans_seg[i]);
+}
+
+/** Test holding back small segment while data is unacknowledged */
+PCUT_TEST(nagle)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+	int i;
+
+	/* XXX tqueue can only be created via tcp_conn_new */
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->cstate = st_established;
+	conn->snd_una = 10;
+	conn->snd_nxt = 10;
+	conn->snd_wnd = 65535;
+
+	/* Redirect segment transmission */
+	conn->retransmit.cb = &tqueue_test_cb;
+	seg_cnt = 0;
+
+	tcp_conn_lock(conn);
+
+	/* Nothing outstanding, small segment goes out immediately */
+	conn->snd_buf_used = 10;
+	conn->snd_buf_fin = false;
+	tcp_tqueue_new_data(conn);
+	PCUT_ASSERT_INT_EQUALS(1, seg_cnt);
+	PCUT_ASSERT_EQUALS(20, conn->snd_nxt);
+
+	/* Second small write is held back until the first one is acked */
+	conn->snd_buf_used = 10;
+	tcp_tqueue_new_data(conn);
+	PCUT_ASSERT_INT_EQUALS(1, seg_cnt);
+	PCUT_ASSERT_EQUALS(20, conn->snd_nxt);
+
+	/* More data is coalesced into the pending segment */
+	conn->snd_buf_used = 30;
+	tcp_tqueue_new_data(conn);
+	PCUT_ASSERT_INT_EQUALS(1, seg_cnt);
+
+	/* Push sends the coalesced data at once */
+	conn->snd_push = true;
+	tcp_tqueue_new_data(conn);
+	PCUT_ASSERT_INT_EQUALS(2, seg_cnt);
+	PCUT_ASSERT_EQUALS(30, trans_seg[1]->len);
+	PCUT_ASSERT_EQUALS(50, conn->snd_nxt);
+	PCUT_ASSERT_FALSE(conn->snd_push);
+
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+	tcp_conn_delete(conn);
+
+	for (i = 0; i < seg_cnt; i++)
+		tcp_segment_delete(trans_seg[i]);
+}
+
+/** Test sending delayed ACK after the delayed ACK timeout */
+PCUT_TEST(ack_delayed_timeout)
+{
+	tcp_conn_t *conn;
+	inet_ep2_t epp;
+
+	/* XXX tqueue can only be created via tcp_conn_new */
+	inet_ep2_init(&epp);
+	conn = tcp_conn_new(&epp);
+	PCUT_ASSERT_NOT_NULL(conn);
+
+	conn->cstate = st_established;
+	conn->rcv_nxt = 100;
+	conn->rcv_wnd = 1024;
+
+	/* Redirect segment transmission */
+	conn->retransmit.cb = &tqueue_test_cb;
+	seg_cnt = 0;
+
+	/* A single small segment is not acknowledged at once */
+	tcp_conn_lock(conn);
+	tcp_tqueue_ack_delayed(conn, 10);
+	tcp_conn_unlock(conn);
+	PCUT_ASSERT_INT_EQUALS(0, seg_cnt);
+
+	fibril_usleep(200 * 1000);
+
+	tcp_conn_lock(conn);
+	PCUT_ASSERT_INT_EQUALS(1, seg_cnt);
+	PCUT_ASSERT_EQUALS(CTL_ACK, trans_seg[0]->ctrl);
+	PCUT_ASSERT_EQUALS(100, trans_seg[0]->ack);
+	PCUT_ASSERT_EQUALS(0, conn->rcv_unacked);
+
+	/* The next small segment arms the timer again */
+	tcp_tqueue_ack_delayed(conn, 10);
+	tcp_conn_unlock(conn);
+
+	fibril_usleep(200 * 1000);
+
+	tcp_conn_lock(conn);
+	PCUT_ASSERT_INT_EQUALS(2, seg_cnt);
+	PCUT_ASSERT_EQUALS(CTL_ACK, trans_seg[1]->ctrl);
+
+	tcp_conn_reset(conn);
+	tcp_conn_unlock(conn);
+	tcp_conn_delete(conn);
+
+	tcp_segment_delete(trans_seg[0]);
+	tcp_segment_delete(trans_seg[1]);
+}
+
 static void tqueue_test_transmit_seg(inet_ep2_t *epp, tcp_segment_t *seg)
 {
 	trans_seg[seg_cnt++] = tcp_segment_dup(seg);
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup tcp
+ * @{
+ */
+
+/**
+ * @file TCP timer wheel
+ *
+ * All TCP timers (retransmission, delayed acknowledgement, Time-Wait)
+ * live in a single hashed timing wheel driven by one fibril. A timer
+ * expiring at tick T is kept in slot T mod TCP_TIMER_SLOTS and setting
+ * or clearing it takes constant time. Timers further in the future than
+ * one revolution of the wheel simply stay in their slot until the tick
+ * counter catches up with them.
+ *
+ * Handlers are called from the timer fibril without any lock held.
+ * A timer stays pending until its handler is about to be called, so
+ * tcp_timer_clear() returning @c true guarantees the handler will not run.
+ */
+
+#include <adt/list.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <io/log.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "tcp_type.h"
+#include "timer.h"
+
+/** Length of one tick (microseconds) */
+#define TCP_TIMER_TICK (10 * 1000)
+/** Number of wheel slots */
+#define TCP_TIMER_SLOTS 512
+
+/** Protects the wheel and all timers in it */
+static FIBRIL_MUTEX_INITIALIZE(wheel_lock);
+/** Signalled when the first timer is set */
+static FIBRIL_CONDVAR_INITIALIZE(wheel_cv);
+/** Wheel slots */
+static list_t wheel[TCP_TIMER_SLOTS];
+/** Expired timers whose handlers have not been called yet */
+static LIST_INITIALIZE(wheel_expired);
+/** Last tick processed */
+static uint64_t wheel_tick;
+/** Number of pending timers */
+static size_t wheel_active;
+/** Wheel has been initialized and the timer fibril started */
+static bool wheel_started;
+
+/** Get current time in ticks. */
+static uint64_t tcp_timer_now(void)
+{
+	struct timespec ts;
+
+	getuptime(&ts);
+	return (SEC2USEC(ts.tv_sec) + NSEC2USEC(ts.tv_nsec)) / TCP_TIMER_TICK;
+}
+
+/** Move expired timers from a wheel slot to the list of expired timers.
+ *
+ * @param tick Tick being processed
+ */
+static void tcp_timer_expire_slot(uint64_t tick)
+{
+	list_t *slot = &wheel[tick % TCP_TIMER_SLOTS];
+	link_t *link, *next;
+	tcp_timer_t *timer;
+
+	assert(fibril_mutex_is_locked(&wheel_lock));
+
+	link = list_first(slot);
+	while (link != NULL) {
+		next = list_next(link, slot);
+		timer = list_get_instance(link, tcp_timer_t, link);
+
+		if (timer->expires <= tick) {
+			list_remove(&timer->link);
+			list_append(&timer->link, &wheel_expired);
+		}
+
+		link = next;
+	}
+}
+
+/** Call handlers of expired timers. */
+static void tcp_timer_fire(void)
+{
+	tcp_timer_t *timer;
+	tcp_timer_func_t func;
+	void *arg;
+
+	assert(fibril_mutex_is_locked(&wheel_lock));
+
+	while (!list_empty(&wheel_expired)) {
+		timer = list_get_instance(list_first(&wheel_expired),
+		    tcp_timer_t, link);
+
+		list_remove(&timer->link);
+		timer->active = false;
+		--wheel_active;
+
+		func = timer->func;
+		arg = timer->arg;
+
+		/* The timer may be set again or freed by the handler */
+		fibril_mutex_unlock(&wheel_lock);
+		func(arg);
+		fibril_mutex_lock(&wheel_lock);
+	}
+}
+
+/** Timer wheel fibril.
+ *
+ * @param arg Not used
+ * @return Never returns
+ */
+static errno_t tcp_timer_fibril(void *arg)
+{
+	uint64_t now;
+
+	fibril_mutex_lock(&wheel_lock);
+
+	while (true) {
+		while (wheel_active == 0)
+			fibril_condvar_wait(&wheel_cv, &wheel_lock);
+
+		fibril_mutex_unlock(&wheel_lock);
+		fibril_usleep(TCP_TIMER_TICK);
+		fibril_mutex_lock(&wheel_lock);
+
+		/*
+		 * Catch up if we were delayed. Visiting each slot once is
+		 * enough to find all timers that have expired by now.
+		 */
+		now = tcp_timer_now();
+		if (now - wheel_tick > TCP_TIMER_SLOTS)
+			wheel_tick = now - TCP_TIMER_SLOTS;
+
+		while (wheel_tick < now) {
+			++wheel_tick;
+			tcp_timer_expire_slot(wheel_tick);
+		}
+
+		tcp_timer_fire();
+	}
+
+	return EOK;
+}
+
+/** Initialize the wheel and start the timer fibril. */
+static void tcp_timer_wheel_start(void)
+{
+	fid_t fid;
+	size_t i;
+
+	assert(fibril_mutex_is_locked(&wheel_lock));
+
+	for (i = 0; i < TCP_TIMER_SLOTS; i++)
+		list_initialize(&wheel[i]);
+
+	wheel_tick = tcp_timer_now();
+	wheel_started = true;
+
+	fid = fibril_create(tcp_timer_fibril, NULL);
+	if (fid == 0) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed creating timer fibril.");
+		return;
+	}
+
+	fibril_add_ready(fid);
+}
+
+/** Initialize timer.
+ *
+ * @param timer Timer
+ */
+void tcp_timer_init(tcp_timer_t *timer)
+{
+	link_initialize(&timer->link);
+	timer->active = false;
+}
+
+/** Finalize timer.
+ *
+ * @param timer Timer, must not be pending
+ */
+void tcp_timer_fini(tcp_timer_t *timer)
+{
+	assert(!timer->active);
+	assert(!link_in_use(&timer->link));
+}
+
+/** Set or re-set timer.
+ *
+ * If the timer is already pending, it is re-scheduled and the previous
+ * handler will not be called.
+ *
+ * @param timer Timer
+ * @param delay Delay in microseconds
+ * @param func  Handler
+ * @param arg   Handler argument
+ */
+void tcp_timer_set(tcp_timer_t *timer, usec_t delay, tcp_timer_func_t func,
+    void *arg)
+{
+	uint64_t now;
+	uint64_t ticks;
+
+	fibril_mutex_lock(&wheel_lock);
+
+	if (!wheel_started)
+		tcp_timer_wheel_start();
+
+	now = tcp_timer_now();
+
+	if (timer->active) {
+		list_remove(&timer->link);
+	} else {
+		/* Do not make the fibril sweep the wheel after being idle */
+		if (wheel_active == 0) {
+			wheel_tick = now;
+			fibril_condvar_broadcast(&wheel_cv);
+		}
+
+		++wheel_active;
+		timer->active = true;
+	}
+
+	/* Round up so that the timer never fires early */
+	ticks = (delay + TCP_TIMER_TICK - 1) / TCP_TIMER_TICK;
+	if (ticks == 0)
+		ticks = 1;
+
+	timer->expires = now + ticks;
+	timer->func = func;
+	timer->arg = arg;
+	list_append(&timer->link, &wheel[timer->expires % TCP_TIMER_SLOTS]);
+
+	fibril_mutex_unlock(&wheel_lock);
+}
+
+/** Clear timer.
+ *
+ * @param timer Timer
+ * @return @c true if the timer was pending (its handler will not be called),
+ *         @c false if it was not set or its handler has already been called
+ */
+bool tcp_timer_clear(tcp_timer_t *timer)
+{
+	bool was_active;
+
+	fibril_mutex_lock(&wheel_lock);
+
+	was_active = timer->active;
+	if (was_active) {
+		list_remove(&timer->link);
+		timer->active = false;
+		--wheel_active;
+	}
+
+	fibril_mutex_unlock(&wheel_lock);
+	return was_active;
+}
+
+/**
+ * @}
+ */
@@ -43,18 +43,24 @@
 #include <mem.h>
 #include <stdlib.h>
 
+#include "cc.h"
 #include "conn.h"
 #include "inet.h"
+#include "iqueue.h"
 #include "ncsim.h"
 #include "rqueue.h"
 #include "segment.h"
 #include "seq_no.h"
+#include "timer.h"
 #include "tqueue.h"
 #include "tcp_type.h"
 
-#define RETRANSMIT_TIMEOUT	(2*1000*1000)
+/** Delay of acknowledgement (RFC 1122 requires less than 0.5 s) */
+#define DELAYED_ACK_TIMEOUT	(40 * 1000)
 
 static void retransmit_timeout_func(void *);
+static void delayed_ack_timeout_func(void *);
+static void tcp_tqueue_ack_timer_clear(tcp_conn_t *);
 static void tcp_tqueue_timer_set(tcp_conn_t *);
 static void tcp_tqueue_timer_clear(tcp_conn_t *);
 static void tcp_tqueue_seg(tcp_conn_t *, tcp_segment_t *);
@@ -66,10 +72,9 @@ errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
     tcp_tqueue_cb_t *cb)
 {
 	tqueue->conn = conn;
-	tqueue->timer = fibril_timer_create(&conn->lock);
 	tqueue->cb = cb;
-	if (tqueue->timer == NULL)
-		return ENOMEM;
+	tcp_timer_init(&tqueue->timer);
+	tcp_timer_init(&tqueue->ack_timer);
 
 	list_initialize(&tqueue->list);
 
@@ -79,6 +84,7 @@ errno_t tcp_tqueue_init(tcp_tqueue_t *tqueue, tcp_conn_t *conn,
 void tcp_tqueue_clear(tcp_tqueue_t *tqueue)
 {
 	tcp_tqueue_timer_clear(tqueue->conn);
+	tcp_tqueue_ack_timer_clear(tqueue->conn);
 }
 
 void tcp_tqueue_fini(tcp_tqueue_t *tqueue)
@@ -86,10 +92,8 @@ void tcp_tqueue_fini(tcp_tqueue_t *tqueue)
 	link_t *link;
 	tcp_tqueue_entry_t *tqe;
 
-	if (tqueue->timer != NULL) {
-		fibril_timer_destroy(tqueue->timer);
-		tqueue->timer = NULL;
-	}
+	tcp_timer_fini(&tqueue->timer);
+	tcp_timer_fini(&tqueue->ack_timer);
 
 	while (!list_empty(&tqueue->list)) {
 		link = list_first(&tqueue->list);
@@ -154,6 +158,7 @@ static void tcp_tqueue_seg(tcp_conn_t *conn, tcp_segment_t *seg)
 	}
 
 	tcp_prepare_transmit_segment(conn, seg);
+	tcp_cc_seg_sent(conn, seg, false);
 }
 
 static void tcp_prepare_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
@@ -173,6 +178,10 @@ static void tcp_prepare_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 }
 
 /** Transmit data from the send buffer.
+ *
+ * Data is sent in segments of at most TCP_SMSS bytes (or larger ones
+ * segmented by the network layer if offload is enabled) for as long as
+ * both the send window and the congestion window allow.
  *
  * @param conn	Connection
  */
@@ -182,6 +191,7 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 	size_t xfer_seqlen;
 	size_t snd_buf_seqlen;
 	size_t data_size;
+	size_t seg_max;
 	tcp_control_t ctrl;
 	bool send_fin;
 
@@ -189,52 +199,76 @@ void tcp_tqueue_new_data(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_tqueue_new_data()", conn->name);
 
-	/* Number of free sequence numbers in send window */
-	avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
-	snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
+	seg_max = tcp_conn_seg_max(conn);
 
-	xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, SND.WND = %" PRIu32 ", "
-	    "xfer_seqlen = %zu", conn->name, snd_buf_seqlen, conn->snd_wnd,
-	    xfer_seqlen);
+	while (true) {
+		/* Number of free sequence numbers in send window */
+		avail_wnd = (conn->snd_una + conn->snd_wnd) - conn->snd_nxt;
+		if ((int32_t) avail_wnd < 0)
+			avail_wnd = 0;
+		avail_wnd = min(avail_wnd, tcp_cc_avail(conn));
+		snd_buf_seqlen = conn->snd_buf_used + (conn->snd_buf_fin ? 1 : 0);
 
-	if (xfer_seqlen == 0)
-		return;
+		xfer_seqlen = min(snd_buf_seqlen, avail_wnd);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: snd_buf_seqlen = %zu, "
+		    "SND.WND = %" PRIu32 ", CWND = %" PRIu32 ", "
+		    "xfer_seqlen = %zu", conn->name, snd_buf_seqlen,
+		    conn->snd_wnd, conn->cc.cwnd, xfer_seqlen);
 
-	/* XXX Do not always send immediately */
+		if (xfer_seqlen == 0)
+			return;
 
-	send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen;
-	data_size = xfer_seqlen - (send_fin ? 1 : 0);
+		send_fin = conn->snd_buf_fin && xfer_seqlen == snd_buf_seqlen &&
+		    snd_buf_seqlen <= seg_max + 1;
+		data_size = min(xfer_seqlen - (send_fin ? 1 : 0), seg_max);
+
+		/*
+		 * Nagle algorithm (RFC 896): while data is unacknowledged,
+		 * hold back a segment smaller than SMSS so that more data
+		 * can be coalesced into it, unless it carries FIN or
+		 * the data has been pushed.
+		 */
+		if (data_size < TCP_SMSS && !send_fin && !conn->nodelay &&
+		    !conn->snd_push && conn->snd_nxt != conn->snd_una) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Nagle, holding "
+			    "back %zu bytes.", conn->name, data_size);
+			return;
+		}
 
-	if (send_fin) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.", conn->name);
-		/* We are sending out FIN */
-		ctrl = CTL_FIN;
-	} else {
-		ctrl = 0;
-	}
+		if (send_fin) {
+			log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: Sending out FIN.", conn->name);
+			/* We are sending out FIN */
+			ctrl = CTL_FIN;
+		} else {
+			ctrl = 0;
+		}
 
-	seg = tcp_segment_make_data(ctrl, conn->snd_buf, data_size);
-	if (seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
-		return;
-	}
+		seg = tcp_segment_make_data(ctrl, conn->snd_buf, data_size);
+		if (seg == NULL) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failure.");
+			return;
+		}
 
-	/* Remove data from send buffer */
-	memmove(conn->snd_buf, conn->snd_buf + data_size,
-	    conn->snd_buf_used - data_size);
-	conn->snd_buf_used -= data_size;
+		/* Remove data from send buffer */
+		memmove(conn->snd_buf, conn->snd_buf + data_size,
+		    conn->snd_buf_used - data_size);
+		conn->snd_buf_used -= data_size;
 
-	if (send_fin)
-		conn->snd_buf_fin = false;
+		if (send_fin)
+			conn->snd_buf_fin = false;
 
-	fibril_condvar_broadcast(&conn->snd_buf_cv);
+		/* Everything pushed has been sent */
+		if (conn->snd_buf_used == 0)
+			conn->snd_push = false;
 
-	if (send_fin)
-		tcp_conn_fin_sent(conn);
+		fibril_condvar_broadcast(&conn->snd_buf_cv);
 
-	tcp_tqueue_seg(conn, seg);
-	tcp_segment_delete(seg);
+		if (send_fin)
+			tcp_conn_fin_sent(conn);
+
+		tcp_tqueue_seg(conn, seg);
+		tcp_segment_delete(seg);
+	}
 }
 
 /** Remove ACKed segments from retransmission queue and possibly transmit
@@ -284,27 +318,103 @@ void tcp_tqueue_ack_received(tcp_conn_t *conn)
 	if (list_empty(&conn->retransmit.list))
 		tcp_tqueue_timer_clear(conn);
 
+	/* Open the congestion window */
+	tcp_cc_ack(conn);
+
 	/* Possibly transmit more data */
 	tcp_tqueue_new_data(conn);
 }
 
+/** Fill in options of an outgoing segment.
+ *
+ * A SYN offers all options we support, a SYN-ACK only those the peer
+ * has offered. Other segments carry timestamps and SACK blocks if they
+ * have been negotiated.
+ *
+ * @param conn	Connection
+ * @param seg	Segment
+ */
+static void tcp_tqueue_seg_opts(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	tcp_opts_t *opts = &seg->opts;
+	bool syn = (seg->ctrl & CTL_SYN) != 0;
+	bool ack = (seg->ctrl & CTL_ACK) != 0;
+
+	memset(opts, 0, sizeof(tcp_opts_t));
+
+	if ((seg->ctrl & CTL_RST) != 0)
+		return;
+
+	if (syn) {
+		opts->flags |= tcp_opt_mss;
+		opts->mss = TCP_SMSS;
+
+		if (!ack || conn->ws_ok) {
+			opts->flags |= tcp_opt_wscale;
+			opts->wscale = conn->rcv_wscale;
+		}
+
+		if (!ack || conn->sack_ok)
+			opts->flags |= tcp_opt_sack_perm;
+	}
+
+	if ((syn && !ack) || conn->ts_ok) {
+		opts->flags |= tcp_opt_ts;
+		opts->tsval = tcp_cc_ts_now();
+		opts->tsecr = ack ? conn->ts_recent : 0;
+	}
+
+	if (!syn && ack && conn->sack_ok) {
+		opts->sack_cnt = tcp_iqueue_sack_blocks(&conn->incoming,
+		    opts->sack, TCP_SACK_BLOCKS_MAX);
+		if (opts->sack_cnt > 0)
+			opts->flags |= tcp_opt_sack;
+	}
+}
+
 static void tcp_conn_transmit_segment(tcp_conn_t *conn, tcp_segment_t *seg)
 {
+	uint32_t wnd;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_conn_transmit_segment(%p, %p)",
 	    conn->name, conn, seg);
 
-	seg->wnd = conn->rcv_wnd;
+	/* Window in a SYN segment is never scaled */
+	wnd = conn->rcv_wnd;
+	if (conn->ws_ok && (seg->ctrl & CTL_SYN) == 0)
+		wnd >>= conn->rcv_wscale;
+	seg->wnd = min(wnd, UINT16_MAX);
 
-	if ((seg->ctrl & CTL_ACK) != 0)
+	if ((seg->ctrl & CTL_ACK) != 0) {
 		seg->ack = conn->rcv_nxt;
-	else
+		conn->last_ack_sent = seg->ack;
+
+		/*
+		 * This acknowledges everything, no need for a delayed ACK.
+		 * The timer is only pending while there is unacknowledged
+		 * data, which the timeout handler clears before sending
+		 * its ACK.
+		 */
+		if (conn->rcv_unacked > 0) {
+			conn->rcv_unacked = 0;
+			tcp_tqueue_ack_timer_clear(conn);
+		}
+
+		conn->rcv_adv = conn->rcv_nxt + (seg->wnd <<
+		    ((conn->ws_ok && (seg->ctrl & CTL_SYN) == 0) ?
+		    conn->rcv_wscale : 0));
+	} else {
 		seg->ack = 0;
+	}
 
+	tcp_tqueue_seg_opts(conn, seg);
 	tcp_tqueue_send_immed(conn, seg);
 }
 
 void tcp_tqueue_send_immed(tcp_conn_t *conn, tcp_segment_t *seg)
 {
+	size_t text_size;
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG,
 	    "tcp_tqueue_send_immed(l:(%u),f:(%u), %p)",
 	    conn->ident.local.port, conn->ident.remote.port, seg);
@@ -314,15 +424,140 @@ void tcp_tqueue_send_immed(tcp_conn_t *conn, tcp_segment_t *seg)
 
 	tcp_segment_dump(seg);
 
+	text_size = tcp_segment_text_size(seg);
+	conn->stats.bytes_out += text_size;
+	/* Count each segment the network layer makes under offload */
+	conn->stats.segs_out += text_size > TCP_SMSS ?
+	    (text_size + TCP_SMSS - 1) / TCP_SMSS : 1;
+
 	conn->retransmit.cb->transmit_seg(&conn->ident, seg);
 }
 
+/** Retransmit a queued segment.
+ *
+ * @param conn	Connection
+ * @param tqe	Retransmission queue entry
+ */
+static void tcp_tqueue_retransmit_entry(tcp_conn_t *conn,
+    tcp_tqueue_entry_t *tqe)
+{
+	tcp_segment_t *rt_seg;
+	uint32_t left;
+
+	rt_seg = tcp_segment_dup(tqe->seg);
+	if (rt_seg == NULL) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
+		/* XXX Handle properly */
+		return;
+	}
+
+	/*
+	 * Segments queued for segmentation offload may be partially
+	 * acknowledged. Only retransmit the first SMSS of what is missing.
+	 */
+	if (rt_seg->len > TCP_SMSS + 1) {
+		left = 0;
+		if (seq_no_segment_acked_part(rt_seg, conn->snd_una))
+			left = conn->snd_una - rt_seg->seq;
+		if (rt_seg->len - left > TCP_SMSS)
+			tcp_segment_trim(rt_seg, left,
+			    rt_seg->len - left - TCP_SMSS);
+		else
+			tcp_segment_trim(rt_seg, left, 0);
+	}
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment "
+	    "SEG.SEQ=%" PRIu32, conn->name, rt_seg->seq);
+	tqe->rexmit = true;
+	++conn->stats.retransmits;
+	tcp_cc_seg_sent(conn, rt_seg, true);
+	tcp_conn_transmit_segment(conn, rt_seg);
+	tcp_segment_delete(rt_seg);
+}
+
+/** Retransmit the first segment that has not been acknowledged.
+ *
+ * Segments selectively acknowledged by the peer are skipped.
+ *
+ * @param conn	Connection
+ */
+void tcp_tqueue_retransmit(tcp_conn_t *conn)
+{
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	if (list_empty(&conn->retransmit.list)) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Nothing to retransmit");
+		return;
+	}
+
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		if (!tqe->sacked) {
+			tcp_tqueue_retransmit_entry(conn, tqe);
+			return;
+		}
+	}
+
+	/* Everything has been SACKed, the peer may have reneged */
+	tcp_tqueue_retransmit_entry(conn, list_get_instance(
+	    list_first(&conn->retransmit.list), tcp_tqueue_entry_t, link));
+}
+
+/** Retransmit the next segment the SACK scoreboard shows as lost.
+ *
+ * Retransmits the first segment that has been neither SACKed nor
+ * retransmitted yet and that is followed by a SACKed segment.
+ *
+ * @param conn	Connection
+ */
+void tcp_tqueue_sack_retransmit(tcp_conn_t *conn)
+{
+	tcp_tqueue_entry_t *hole = NULL;
+
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		if (tqe->sacked) {
+			if (hole != NULL) {
+				tcp_tqueue_retransmit_entry(conn, hole);
+				return;
+			}
+		} else if (hole == NULL && !tqe->rexmit) {
+			hole = tqe;
+		}
+	}
+}
+
+/** Update the SACK scoreboard from SACK blocks in an acknowledgement.
+ *
+ * @param conn	Connection
+ * @param seg	Received segment
+ */
+void tcp_tqueue_sack(tcp_conn_t *conn, tcp_segment_t *seg)
+{
+	tcp_sack_block_t *blk;
+	size_t i;
+
+	if ((seg->opts.flags & tcp_opt_sack) == 0)
+		return;
+
+	for (i = 0; i < seg->opts.sack_cnt; i++) {
+		blk = &seg->opts.sack[i];
+
+		/* Ignore blocks outside of outstanding data */
+		if (!seq_no_sack_valid(conn, blk))
+			continue;
+
+		list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t,
+		    tqe) {
+			if (seq_no_segment_sacked(blk, tqe->seg))
+				tqe->sacked = true;
+		}
+	}
+}
+
 static void retransmit_timeout_func(void *arg)
 {
 	tcp_conn_t *conn = (tcp_conn_t *) arg;
-	tcp_tqueue_entry_t *tqe;
-	tcp_segment_t *rt_seg;
-	link_t *link;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmit_timeout_func(%p)", conn->name, conn);
 
@@ -335,37 +570,96 @@ static void retransmit_timeout_func(void *arg)
 		return;
 	}
 
-	link = list_first(&conn->retransmit.list);
-	if (link == NULL) {
+	if (list_empty(&conn->retransmit.list)) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "Nothing to retransmit");
 		tcp_conn_unlock(conn);
 		tcp_conn_delref(conn);
 		return;
 	}
 
-	tqe = list_get_instance(link, tcp_tqueue_entry_t, link);
-
-	rt_seg = tcp_segment_dup(tqe->seg);
-	if (rt_seg == NULL) {
-		log_msg(LOG_DEFAULT, LVL_ERROR, "Memory allocation failed.");
-		tcp_conn_unlock(conn);
-		tcp_conn_delref(conn);
-		/* XXX Handle properly */
-		return;
+	/*
+	 * The peer may discard data it has SACKed, so forget the SACK
+	 * scoreboard (RFC 2018 section 8).
+	 */
+	list_foreach(conn->retransmit.list, link, tcp_tqueue_entry_t, tqe) {
+		tqe->sacked = false;
+		tqe->rexmit = false;
 	}
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmitting segment", conn->name);
-	tcp_conn_transmit_segment(tqe->conn, rt_seg);
+	/* Collapse the congestion window and back off the timer */
+	++conn->stats.rto_timeouts;
+	tcp_cc_timeout(conn);
+	tcp_tqueue_retransmit(conn);
 
 	/* Reset retransmission timer */
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
-	    retransmit_timeout_func, (void *) conn);
+	tcp_tqueue_timer_set(conn);
 
 	tcp_conn_unlock(conn);
+	tcp_conn_delref(conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: retransmit_timeout_func(%p) end", conn->name, conn);
 }
 
+/** Acknowledge received data.
+ *
+ * The ACK is sent at once for every second full-sized segment, otherwise it
+ * is delayed (RFC 1122 section 4.2.3.2) so that it can be piggybacked on
+ * outgoing data or combined with the next ACK.
+ *
+ * @param conn	Connection
+ * @param len	Number of bytes received
+ */
+void tcp_tqueue_ack_delayed(tcp_conn_t *conn, uint32_t len)
+{
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	conn->rcv_unacked += len;
+	if (conn->rcv_unacked >= 2 * TCP_SMSS) {
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+		return;
+	}
+
+	/* Timer is running if there already was unacknowledged data */
+	if (conn->rcv_unacked != len)
+		return;
+
+	tcp_conn_addref(conn);
+	tcp_timer_set(&conn->retransmit.ack_timer, DELAYED_ACK_TIMEOUT,
+	    delayed_ack_timeout_func, (void *) conn);
+}
+
+/** Delayed acknowledgement timeout handler.
+ *
+ * @param arg	Connection
+ */
+static void delayed_ack_timeout_func(void *arg)
+{
+	tcp_conn_t *conn = (tcp_conn_t *) arg;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: delayed_ack_timeout_func(%p)",
+	    conn->name, conn);
+
+	tcp_conn_lock(conn);
+
+	/* Do not let sending the ACK clear the timer we are running from */
+	if (conn->cstate != st_closed && conn->rcv_unacked > 0) {
+		conn->rcv_unacked = 0;
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+	}
+
+	tcp_conn_unlock(conn);
+	tcp_conn_delref(conn);
+}
+
+/** Clear delayed acknowledgement timer */
+static void tcp_tqueue_ack_timer_clear(tcp_conn_t *conn)
+{
+	assert(fibril_mutex_is_locked(&conn->lock));
+
+	if (tcp_timer_clear(&conn->retransmit.ack_timer))
+		tcp_conn_delref(conn);
+}
+
 /** Set or re-set retransmission timer */
 static void tcp_tqueue_timer_set(tcp_conn_t *conn)
 {
@@ -377,7 +671,7 @@ static void tcp_tqueue_timer_set(tcp_conn_t *conn)
 	tcp_tqueue_timer_clear(conn);
 
 	tcp_conn_addref(conn);
-	fibril_timer_set_locked(conn->retransmit.timer, RETRANSMIT_TIMEOUT,
+	tcp_timer_set(&conn->retransmit.timer, conn->cc.rto,
 	    retransmit_timeout_func, (void *) conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_set() end", conn->name);
@@ -390,7 +684,7 @@ static void tcp_tqueue_timer_clear(tcp_conn_t *conn)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_clear() begin", conn->name);
 
-	if (fibril_timer_clear_locked(conn->retransmit.timer) == fts_active)
+	if (tcp_timer_clear(&conn->retransmit.timer))
 		tcp_conn_delref(conn);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "### %s: tcp_tqueue_timer_clear() end", conn->name);
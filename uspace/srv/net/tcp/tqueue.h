@@ -46,6 +46,10 @@ extern void tcp_tqueue_fini(tcp_tqueue_t *);
 extern void tcp_tqueue_ctrl_seg(tcp_conn_t *, tcp_control_t);
 extern void tcp_tqueue_new_data(tcp_conn_t *);
 extern void tcp_tqueue_ack_received(tcp_conn_t *);
+extern void tcp_tqueue_ack_delayed(tcp_conn_t *, uint32_t);
+extern void tcp_tqueue_retransmit(tcp_conn_t *);
+extern void tcp_tqueue_sack_retransmit(tcp_conn_t *);
+extern void tcp_tqueue_sack(tcp_conn_t *, tcp_segment_t *);
 
 #endif
 
@@ -39,6 +39,7 @@
 #include <io/log.h>
 #include <macros.h>
 #include <mem.h>
+#include "cc.h"
 #include "conn.h"
 #include "tcp_type.h"
 #include "tqueue.h"
@@ -170,6 +171,9 @@ tcp_error_t tcp_uc_send(tcp_conn_t *conn, void *data, size_t size,
 		tcp_tqueue_new_data(conn);
 	}
 
+	if ((flags & XF_PUSH) != 0 && conn->snd_buf_used > 0)
+		conn->snd_push = true;
+
 	tcp_tqueue_new_data(conn);
 	tcp_conn_unlock(conn);
 
@@ -229,8 +233,13 @@ tcp_error_t tcp_uc_receive(tcp_conn_t *conn, void *buf, size_t size,
 	/* TODO */
 	*xflags = 0;
 
-	/* Send new size of receive window */
-	tcp_tqueue_ctrl_seg(conn, CTL_ACK);
+	/*
+	 * Send new size of receive window once it has opened enough
+	 * to be worth it (RFC 1122 section 4.2.3.3).
+	 */
+	if ((conn->rcv_nxt + conn->rcv_wnd) - conn->rcv_adv >=
+	    min(conn->rcv_buf_size / 2, 2 * TCP_SMSS))
+		tcp_tqueue_ctrl_seg(conn, CTL_ACK);
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_uc_receive() - returning %zu bytes",
 	    conn->name, xfer_size);
@@ -285,6 +294,49 @@ void tcp_uc_abort(tcp_conn_t *conn)
 	tcp_conn_unlock(conn);
 }
 
+/** PUSH user call.
+ *
+ * (Not a separate call in spec.) Send out data in the send buffer
+ * without waiting for more data to fill a segment.
+ */
+tcp_error_t tcp_uc_push(tcp_conn_t *conn)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_uc_push()", conn->name);
+
+	tcp_conn_lock(conn);
+
+	if (conn->cstate == st_closed) {
+		tcp_conn_unlock(conn);
+		return TCP_ENOTEXIST;
+	}
+
+	if (conn->snd_buf_used > 0) {
+		conn->snd_push = true;
+		tcp_tqueue_new_data(conn);
+	}
+
+	tcp_conn_unlock(conn);
+	return TCP_EOK;
+}
+
+/** Set no-delay option.
+ *
+ * (Not in spec.) With no-delay set, small segments are sent immediately
+ * instead of being held back while data is unacknowledged (Nagle
+ * algorithm).
+ */
+void tcp_uc_set_nodelay(tcp_conn_t *conn, bool nodelay)
+{
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "%s: tcp_uc_set_nodelay(%d)",
+	    conn->name, (int) nodelay);
+
+	tcp_conn_lock(conn);
+	conn->nodelay = nodelay;
+	if (nodelay)
+		tcp_tqueue_new_data(conn);
+	tcp_conn_unlock(conn);
+}
+
 /** STATUS user call */
 void tcp_uc_status(tcp_conn_t *conn, tcp_conn_status_t *cstatus)
 {
@@ -48,6 +48,8 @@ extern tcp_error_t tcp_uc_send(tcp_conn_t *, void *, size_t, xflags_t);
 extern tcp_error_t tcp_uc_receive(tcp_conn_t *, void *, size_t, size_t *, xflags_t *);
 extern tcp_error_t tcp_uc_close(tcp_conn_t *);
 extern void tcp_uc_abort(tcp_conn_t *);
+extern tcp_error_t tcp_uc_push(tcp_conn_t *);
+extern void tcp_uc_set_nodelay(tcp_conn_t *, bool);
 extern void tcp_uc_status(tcp_conn_t *, tcp_conn_status_t *);
 extern void tcp_uc_delete(tcp_conn_t *);
 extern void tcp_uc_set_cb(tcp_conn_t *, tcp_cb_t *, void *);
@@ -51,6 +51,8 @@
 static LIST_INITIALIZE(assoc_list);
 static FIBRIL_MUTEX_INITIALIZE(assoc_list_lock);
 static amap_t *amap;
+/** Taken after assoc_list_lock. Lookups only take it for reading. */
+static FIBRIL_RWLOCK_INITIALIZE(amap_lock);
 
 static udp_assoc_t *udp_assoc_find_ref(inet_ep2_t *);
 static errno_t udp_assoc_queue_msg(udp_assoc_t *, inet_ep2_t *, udp_msg_t *);
@@ -197,14 +199,17 @@ errno_t udp_assoc_add(udp_assoc_t *assoc)
 
 	udp_assoc_addref(assoc);
 	fibril_mutex_lock(&assoc_list_lock);
+	fibril_rwlock_write_lock(&amap_lock);
 
 	rc = amap_insert(amap, &assoc->ident, assoc, af_allow_system, &aepp);
 	if (rc != EOK) {
+		fibril_rwlock_write_unlock(&amap_lock);
 		udp_assoc_delref(assoc);
 		fibril_mutex_unlock(&assoc_list_lock);
 		return rc;
 	}
 
+	fibril_rwlock_write_unlock(&amap_lock);
 	assoc->ident = aepp;
 	list_append(&assoc->link, &assoc_list);
 	fibril_mutex_unlock(&assoc_list_lock);
@@ -219,7 +224,9 @@ errno_t udp_assoc_add(udp_assoc_t *assoc)
 void udp_assoc_remove(udp_assoc_t *assoc)
 {
 	fibril_mutex_lock(&assoc_list_lock);
+	fibril_rwlock_write_lock(&amap_lock);
 	amap_remove(amap, &assoc->ident);
+	fibril_rwlock_write_unlock(&amap_lock);
 	list_remove(&assoc->link);
 	fibril_mutex_unlock(&assoc_list_lock);
 	udp_assoc_delref(assoc);
@@ -423,19 +430,19 @@ static udp_assoc_t *udp_assoc_find_ref(inet_ep2_t *epp)
 	udp_assoc_t *assoc;
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "udp_assoc_find_ref(%p)", epp);
-	fibril_mutex_lock(&assoc_list_lock);
+	fibril_rwlock_read_lock(&amap_lock);
 
 	rc = amap_find_match(amap, epp, &arg);
 	if (rc != EOK) {
 		assert(rc == ENOENT);
-		fibril_mutex_unlock(&assoc_list_lock);
+		fibril_rwlock_read_unlock(&amap_lock);
 		return NULL;
 	}
 
 	assoc = (udp_assoc_t *)arg;
 	udp_assoc_addref(assoc);
 
-	fibril_mutex_unlock(&assoc_list_lock);
+	fibril_rwlock_read_unlock(&amap_lock);
 	return assoc;
 }
 
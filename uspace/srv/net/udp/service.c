@@ -42,6 +42,8 @@
 #include <ipc/udp.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "assoc.h"
@@ -414,6 +416,85 @@ static void udp_assoc_send_msg_srv(udp_client_t *client, ipc_call_t *icall)
 	free(data);
 }
 
+/** Send multiple messages via association.
+ *
+ * Handle client request to send a batch of messages packed in a single
+ * data write. Each message is preceded by a udp_mmsg_hdr_t.
+ *
+ * @param client UDP client
+ * @param icall  Async request data
+ *
+ */
+static void udp_assoc_send_mmsg_srv(udp_client_t *client, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	udp_mmsg_hdr_t *hdr;
+	sysarg_t assoc_id;
+	size_t count;
+	size_t sent;
+	size_t size;
+	size_t off;
+	uint8_t *data;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "udp_assoc_send_mmsg_srv()");
+
+	assoc_id = ipc_get_arg1(icall);
+	count = ipc_get_arg2(icall);
+
+	if (!async_data_write_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_1(icall, EREFUSED, 0);
+		return;
+	}
+
+	if (size > MAX_MSG_SIZE) {
+		async_answer_0(&call, EINVAL);
+		async_answer_1(icall, EINVAL, 0);
+		return;
+	}
+
+	data = malloc(size);
+	if (data == NULL) {
+		async_answer_0(&call, ENOMEM);
+		async_answer_1(icall, ENOMEM, 0);
+		return;
+	}
+
+	rc = async_data_write_finalize(&call, data, size);
+	if (rc != EOK) {
+		async_answer_1(icall, rc, 0);
+		free(data);
+		return;
+	}
+
+	sent = 0;
+	off = 0;
+	while (sent < count) {
+		if (size - off < sizeof(udp_mmsg_hdr_t)) {
+			rc = EINVAL;
+			break;
+		}
+
+		hdr = (udp_mmsg_hdr_t *) (data + off);
+		if (hdr->size > size - off - sizeof(udp_mmsg_hdr_t)) {
+			rc = EINVAL;
+			break;
+		}
+
+		rc = udp_assoc_send_msg_impl(client, assoc_id, &hdr->ep,
+		    data + off + sizeof(udp_mmsg_hdr_t), hdr->size);
+		if (rc != EOK)
+			break;
+
+		++sent;
+		off += min(UDP_MMSG_SPACE(hdr->size), size - off);
+	}
+
+	async_answer_1(icall, rc, sent);
+	free(data);
+}
+
 /** Get next received message.
  *
  * @param client UDP Client
@@ -558,6 +639,93 @@ static void udp_rmsg_discard_srv(udp_client_t *client, ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+/** Read and consume multiple received messages.
+ *
+ * Handle client request to read as many received messages as fit in
+ * the client's buffer. Each message is preceded by a udp_mmsg_hdr_t.
+ * Messages that were read are removed from the receive queue. If the first
+ * message does not fit, zero messages are returned and the client needs
+ * to read it using UDP_RMSG_INFO/UDP_RMSG_READ.
+ *
+ * @param client UDP client
+ * @param icall  Async request data
+ *
+ */
+static void udp_rmsg_read_multi_srv(udp_client_t *client, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	udp_crcv_queue_entry_t *enext;
+	udp_mmsg_hdr_t *hdr;
+	link_t *link;
+	uint8_t *buf;
+	size_t count;
+	size_t size;
+	size_t off;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "udp_rmsg_read_multi_srv()");
+
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	enext = udp_rmsg_get_next(client);
+	if (enext == NULL) {
+		async_answer_0(&call, ENOENT);
+		async_answer_0(icall, ENOENT);
+		return;
+	}
+
+	size = min(size, (size_t) MAX_MSG_SIZE);
+	buf = malloc(size);
+	if (buf == NULL) {
+		async_answer_0(&call, ENOMEM);
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
+	count = 0;
+	off = 0;
+	while (enext != NULL && enext->msg->data_size <= size &&
+	    UDP_MMSG_SPACE(enext->msg->data_size) <= size - off) {
+		hdr = (udp_mmsg_hdr_t *) (buf + off);
+		memset(hdr, 0, UDP_MMSG_SPACE(enext->msg->data_size));
+		hdr->ep = enext->epp.remote;
+		hdr->assoc_id = enext->cassoc->id;
+		hdr->size = enext->msg->data_size;
+		memcpy(buf + off + sizeof(udp_mmsg_hdr_t), enext->msg->data,
+		    enext->msg->data_size);
+
+		off += UDP_MMSG_SPACE(enext->msg->data_size);
+		++count;
+
+		link = list_next(&enext->link, &client->crcv_queue);
+		enext = link != NULL ?
+		    list_get_instance(link, udp_crcv_queue_entry_t, link) : NULL;
+	}
+
+	rc = async_data_read_finalize(&call, buf, off);
+	free(buf);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	/* Messages were delivered, remove them from the queue */
+	for (size_t i = 0; i < count; i++) {
+		enext = udp_rmsg_get_next(client);
+		list_remove(&enext->link);
+		udp_msg_delete(enext->msg);
+		free(enext);
+	}
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "udp_rmsg_read_multi_srv(): "
+	    "count=%zu", count);
+	async_answer_1(icall, EOK, count);
+}
+
 /** Handle UDP client connection.
  *
  * @param icall Connect call data
@@ -617,6 +785,12 @@ static void udp_client_conn(ipc_call_t *icall, void *arg)
 		case UDP_RMSG_DISCARD:
 			udp_rmsg_discard_srv(&client, &call);
 			break;
+		case UDP_ASSOC_SEND_MMSG:
+			udp_assoc_send_mmsg_srv(&client, &call);
+			break;
+		case UDP_RMSG_READ_MULTI:
+			udp_rmsg_read_multi_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -128,4 +128,43 @@ PCUT_TEST(encode_decode_v6)
 	udp_msg_delete(dmsg);
 }
 
+/** Test that PDU with damaged checksum is rejected */
+PCUT_TEST(decode_bad_checksum)
+{
+	inet_ep2_t epp;
+	udp_msg_t *msg;
+	inet_ep2_t depp;
+	udp_msg_t *dmsg;
+	udp_pdu_t *pdu;
+	const char *msgstr = "Hello";
+	errno_t rc;
+
+	inet_ep2_init(&epp);
+	inet_addr(&epp.local.addr, 192, 168, 0, 1);
+	epp.local.port = 1;
+	inet_addr(&epp.remote.addr, 192, 168, 0, 2);
+	epp.remote.port = 2;
+
+	msg = udp_msg_new();
+	PCUT_ASSERT_NOT_NULL(msg);
+	msg->data_size = str_size(msgstr) + 1;
+	msg->data = str_dup(msgstr);
+
+	rc = udp_pdu_encode(&epp, msg, &pdu);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	((uint8_t *) pdu->data)[pdu->data_size - 2] ^= 0x01;
+	rc = udp_pdu_decode(pdu, &depp, &dmsg);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	/* Checksum verified by the link is not checked again */
+	pdu->csum_ok = true;
+	rc = udp_pdu_decode(pdu, &depp, &dmsg);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	udp_pdu_delete(pdu);
+	udp_msg_delete(msg);
+	udp_msg_delete(dmsg);
+}
+
 PCUT_EXPORT(pdu);
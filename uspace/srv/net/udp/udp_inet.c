@@ -62,6 +62,7 @@ static errno_t udp_inet_ev_recv(inet_dgram_t *dgram)
 	pdu->iplink = dgram->iplink;
 	pdu->data = dgram->data;
 	pdu->data_size = dgram->size;
+	pdu->csum_ok = dgram->csum == INET_CSUM_VALID;
 
 	pdu->src = dgram->src;
 	pdu->dest = dgram->dest;
@@ -87,6 +88,9 @@ errno_t udp_transmit_pdu(udp_pdu_t *pdu)
 	dgram.src = pdu->src;
 	dgram.dest = pdu->dest;
 	dgram.tos = 0;
+	dgram.csum = INET_CSUM_NONE;
+	dgram.csum_offs = 0;
+	dgram.tso_mss = 0;
 	dgram.data = pdu->data;
 	dgram.size = pdu->data_size;
 
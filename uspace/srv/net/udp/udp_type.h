@@ -86,6 +86,8 @@ typedef struct {
 	void *data;
 	/** Encoded PDU data size */
 	size_t data_size;
+	/** Checksum has been verified by the link */
+	bool csum_ok;
 } udp_pdu_t;
 
 /** Functions needed by associations module.
@@ -42,6 +42,9 @@
 #include "clonable.h"
 #include "ns.h"
 
+/** Number of idle loaders kept ready for connection requests. */
+#define CS_POOL_SIZE  2
+
 /** Request for connection to a clonable service. */
 typedef struct {
 	link_t link;
@@ -50,12 +53,52 @@ typedef struct {
 	ipc_call_t call;
 } cs_req_t;
 
+/** Idle clonable server, registered ahead of a connection request. */
+typedef struct {
+	link_t link;
+	async_sess_t *sess;
+} cs_idle_t;
+
 /** List of clonable-service connection requests. */
 static list_t cs_req;
 
+/** List of idle clonable servers. */
+static list_t cs_idle;
+
+/** Number of servers spawned, but not registered yet. */
+static size_t cs_spawned;
+
+/** Spawn loaders until the pool is full.
+ *
+ * Servers which are still starting count towards the pool, minus those
+ * which will be consumed by pending connection requests.
+ *
+ * @return Zero on success or a value from @ref errno.h.
+ *
+ */
+static errno_t ns_clonable_pool_fill(void)
+{
+	size_t want = list_count(&cs_req) + CS_POOL_SIZE;
+
+	while (list_count(&cs_idle) + cs_spawned < want) {
+		errno_t rc = loader_spawn("loader");
+		if (rc != EOK)
+			return rc;
+
+		cs_spawned++;
+	}
+
+	return EOK;
+}
+
 errno_t ns_clonable_init(void)
 {
 	list_initialize(&cs_req);
+	list_initialize(&cs_idle);
+	cs_spawned = 0;
+
+	/* The loader image need not be available yet, fill the pool later */
+	(void) ns_clonable_pool_fill();
 	return EOK;
 }
 
@@ -65,6 +108,21 @@ bool ns_service_is_clonable(service_t service, iface_t iface)
 	return (service == SERVICE_LOADER) && (iface == INTERFACE_LOADER);
 }
 
+/** Forward connection request to a clonable server.
+ *
+ * @param sess  Session to the server.
+ * @param call  Connection request.
+ * @param iface Interface to be connected to.
+ *
+ */
+static void ns_clonable_connect(async_sess_t *sess, ipc_call_t *call,
+    iface_t iface)
+{
+	async_exch_t *exch = async_exchange_begin(sess);
+	async_forward_1(call, exch, iface, ipc_get_arg3(call), IPC_FF_NONE);
+	async_exchange_end(exch);
+}
+
 /** Register clonable service.
  *
  * @param call Pointer to call structure.
@@ -72,36 +130,52 @@ bool ns_service_is_clonable(service_t service, iface_t iface)
  */
 void ns_clonable_register(ipc_call_t *call)
 {
-	link_t *req_link = list_first(&cs_req);
-	if (req_link == NULL) {
-		/* There was no pending connection request. */
+	if (cs_spawned == 0) {
+		/* We did not spawn this server. */
 		printf("%s: Unexpected clonable server.\n", NAME);
 		async_answer_0(call, EBUSY);
 		return;
 	}
 
+	cs_spawned--;
+	async_answer_0(call, EOK);
+
+	async_sess_t *sess = async_callback_receive(EXCHANGE_SERIALIZE);
+	if (sess == NULL)
+		return;
+
+	link_t *req_link = list_first(&cs_req);
+	if (req_link == NULL) {
+		/* There is no pending connection request, keep the server. */
+		cs_idle_t *idle = malloc(sizeof(cs_idle_t));
+		if (idle == NULL) {
+			async_hangup(sess);
+			return;
+		}
+
+		link_initialize(&idle->link);
+		idle->sess = sess;
+		list_append(&idle->link, &cs_idle);
+		return;
+	}
+
 	cs_req_t *csr = list_get_instance(req_link, cs_req_t, link);
 	list_remove(req_link);
 
 	/* Currently we can only handle a single type of clonable service. */
 	assert(ns_service_is_clonable(csr->service, csr->iface));
 
-	async_answer_0(call, EOK);
-
-	async_sess_t *sess = async_callback_receive(EXCHANGE_SERIALIZE);
-	if (sess == NULL)
-		async_answer_0(call, EIO);
-
-	async_exch_t *exch = async_exchange_begin(sess);
-	async_forward_1(&csr->call, exch, csr->iface,
-	    ipc_get_arg3(&csr->call), IPC_FF_NONE);
-	async_exchange_end(exch);
+	ns_clonable_connect(sess, &csr->call, csr->iface);
 
 	free(csr);
 	async_hangup(sess);
 }
 
 /** Connect client to clonable service.
+ *
+ * An idle server from the pool is used if there is one, otherwise
+ * a new server is spawned for the request. The pool is refilled
+ * in both cases, so that the next request does not need to wait.
  *
  * @param service Service to be connected to.
  * @param iface   Interface to be connected to.
@@ -114,6 +188,20 @@ void ns_clonable_forward(service_t service, iface_t iface, ipc_call_t *call)
 {
 	assert(ns_service_is_clonable(service, iface));
 
+	link_t *idle_link = list_first(&cs_idle);
+	if (idle_link != NULL) {
+		cs_idle_t *idle = list_get_instance(idle_link, cs_idle_t, link);
+		list_remove(idle_link);
+
+		ns_clonable_connect(idle->sess, call, iface);
+
+		async_hangup(idle->sess);
+		free(idle);
+
+		(void) ns_clonable_pool_fill();
+		return;
+	}
+
 	cs_req_t *csr = malloc(sizeof(cs_req_t));
 	if (csr == NULL) {
 		async_answer_0(call, ENOMEM);
@@ -129,6 +217,8 @@ void ns_clonable_forward(service_t service, iface_t iface, ipc_call_t *call)
 		return;
 	}
 
+	cs_spawned++;
+
 	link_initialize(&csr->link);
 	csr->service = service;
 	csr->iface = iface;
@@ -140,6 +230,8 @@ void ns_clonable_forward(service_t service, iface_t iface, ipc_call_t *call)
 	 * Thus we store the call in a queue.
 	 */
 	list_append(&csr->link, &cs_req);
+
+	(void) ns_clonable_pool_fill();
 }
 
 /**
@@ -67,6 +67,9 @@ static const char *ro_data = "Hello, world!";
  */
 static char rw_data[] = "Hello, world!";
 
+/** Buffer receiving (and discarding) data written by clients. */
+static uint8_t write_buf[DATA_XFER_LIMIT];
+
 static void ipc_test_get_ro_area_size_srv(ipc_call_t *icall)
 {
 	errno_t rc;
@@ -181,6 +184,28 @@ static void ipc_test_share_in_rw_srv(ipc_call_t *icall)
 	async_answer_0(icall, EOK);
 }
 
+static void ipc_test_write_srv(ipc_call_t *icall)
+{
+	ipc_call_t call;
+	size_t size;
+	errno_t rc;
+
+	if (!async_data_write_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size > sizeof(write_buf)) {
+		async_answer_0(&call, EINVAL);
+		async_answer_0(icall, EINVAL);
+		return;
+	}
+
+	rc = async_data_write_finalize(&call, write_buf, size);
+	async_answer_0(icall, rc);
+}
+
 static void ipc_test_connection(ipc_call_t *icall, void *arg)
 {
 	/* Accept connection */
@@ -211,6 +236,9 @@ static void ipc_test_connection(ipc_call_t *icall, void *arg)
 		case IPC_TEST_SHARE_IN_RW:
 			ipc_test_share_in_rw_srv(&call);
 			break;
+		case IPC_TEST_WRITE:
+			ipc_test_write_srv(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
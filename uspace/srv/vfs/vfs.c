@@ -70,6 +70,12 @@ static void vfs_pager(ipc_call_t *icall, void *arg)
 		case IPC_M_PAGE_IN:
 			vfs_page_in(&call);
 			break;
+		case IPC_M_PAGE_OUT:
+			vfs_page_out(&call);
+			break;
+		case IPC_M_PAGE_RELEASE:
+			vfs_page_release(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -99,6 +105,14 @@ int main(int argc, char **argv)
 		return ENOMEM;
 	}
 
+	/*
+	 * Initialize the page cache and the name cache.
+	 */
+	if (!vfs_cache_init() || !vfs_lookup_cache_init()) {
+		printf("%s: Failed to initialize caches\n", NAME);
+		return ENOMEM;
+	}
+
 	/*
 	 * Allocate and initialize the Path Lookup Buffer.
 	 */
@@ -123,6 +123,13 @@ typedef struct _vfs_node {
 	 */
 	fibril_rwlock_t contents_rwlock;
 
+	/**
+	 * A name of the node was removed while it was in memory. Its pages
+	 * must leave the page cache when the node is destroyed, because the
+	 * file system may reuse the index.
+	 */
+	bool unlinked;
+
 	struct _vfs_node *mount;
 } vfs_node_t;
 
@@ -145,6 +152,13 @@ typedef struct {
 
 	/** Append on write. */
 	bool append;
+
+	/**
+	 * Data buffer shared by the client for VFS_IN_READ_BUFFER and
+	 * VFS_IN_WRITE_BUFFER, mapped into VFS, or NULL.
+	 */
+	void *buffer;
+	size_t buffer_size;
 } vfs_file_t;
 
 extern fibril_mutex_t nodes_mutex;
@@ -182,6 +196,11 @@ extern errno_t vfs_get_fstypes(vfs_fstypes_t *);
 extern errno_t vfs_lookup_internal(vfs_node_t *, char *, int, vfs_lookup_res_t *);
 extern errno_t vfs_link_internal(vfs_node_t *, char *, vfs_triplet_t *);
 
+extern bool vfs_lookup_cache_init(void);
+extern void vfs_lookup_cache_size_update(vfs_triplet_t *, aoff64_t);
+extern void vfs_lookup_cache_invalidate_fs(fs_handle_t, service_id_t);
+extern void vfs_lookup_cache_stats_get(vfs_cache_stats_t *);
+
 extern bool vfs_nodes_init(void);
 extern vfs_node_t *vfs_node_get(vfs_lookup_res_t *);
 extern vfs_node_t *vfs_node_peek(vfs_lookup_res_t *result);
@@ -193,6 +212,7 @@ extern bool vfs_node_has_children(vfs_node_t *node);
 
 extern void *vfs_client_data_create(void);
 extern void vfs_client_data_destroy(void *);
+extern list_t *vfs_client_pins(void);
 
 extern void vfs_op_pass_handle(task_id_t, task_id_t, int);
 extern errno_t vfs_wait_handle_internal(bool, int *);
@@ -207,6 +227,7 @@ extern void vfs_node_addref(vfs_node_t *);
 extern void vfs_node_delref(vfs_node_t *);
 extern errno_t vfs_open_node_remote(vfs_node_t *);
 
+extern errno_t vfs_op_buffer(int fd, void *buf, size_t size);
 extern errno_t vfs_op_clone(int oldfd, int newfd, bool desc, int *);
 extern errno_t vfs_op_fsprobe(const char *, service_id_t, vfs_fs_probe_info_t *);
 extern errno_t vfs_op_mount(int mpfd, unsigned servid, unsigned flags, unsigned instance, const char *opts, const char *fsname, int *outfd);
@@ -214,6 +235,7 @@ extern errno_t vfs_op_mtab_get(void);
 extern errno_t vfs_op_open(int fd, int flags);
 extern errno_t vfs_op_put(int fd);
 extern errno_t vfs_op_read(int fd, aoff64_t, size_t *out_bytes);
+extern errno_t vfs_op_read_buffer(int fd, aoff64_t, size_t, size_t *out_bytes);
 extern errno_t vfs_op_rename(int basefd, char *old, char *new);
 extern errno_t vfs_op_resize(int fd, int64_t size);
 extern errno_t vfs_op_stat(int fd);
@@ -224,10 +246,63 @@ extern errno_t vfs_op_unmount(int mpfd);
 extern errno_t vfs_op_wait_handle(bool high_fd, int *out_fd);
 extern errno_t vfs_op_walk(int parentfd, int flags, char *path, int *out_fd);
 extern errno_t vfs_op_write(int fd, aoff64_t, size_t *out_bytes);
+extern errno_t vfs_op_write_buffer(int fd, aoff64_t, size_t,
+    size_t *out_bytes);
 
 extern void vfs_register(ipc_call_t *);
 
 extern void vfs_page_in(ipc_call_t *);
+extern void vfs_page_out(ipc_call_t *);
+extern void vfs_page_release(ipc_call_t *);
+extern void vfs_pager_pins_release(list_t *);
+
+/** Identifies one page of a file in the page cache. */
+typedef struct {
+	fs_handle_t fs_handle;
+	service_id_t service_id;
+	fs_index_t index;
+	/** Page-aligned offset of the page within the file. */
+	aoff64_t offset;
+} vfs_cache_key_t;
+
+/** One page of file contents kept in the page cache. */
+typedef struct {
+	ht_link_t link;		/**< Page cache hash table link. */
+	link_t lru_link;	/**< Link in the LRU list. */
+	vfs_cache_key_t key;
+
+	/** Page-sized anonymous area holding the data. */
+	void *data;
+	/** Number of valid bytes, less than a page only at the end of file. */
+	size_t valid;
+
+	/** Number of users currently holding the page. */
+	unsigned refcnt;
+	/** The page is still reachable from the hash table. */
+	bool cached;
+
+	/** Number of writable shared mappings of the page. */
+	unsigned pincnt;
+	/** Link in the list of pinned pages. */
+	link_t pin_link;
+} vfs_cache_page_t;
+
+extern bool vfs_cache_init(void);
+extern bool vfs_cache_node_cacheable(vfs_node_t *);
+extern errno_t vfs_cache_page_get(async_exch_t *, vfs_node_t *, aoff64_t,
+    vfs_cache_page_t **);
+extern void vfs_cache_page_put(vfs_cache_page_t *);
+extern void vfs_cache_page_pin(vfs_cache_page_t *);
+extern void vfs_cache_page_unpin(vfs_cache_page_t *);
+extern errno_t vfs_cache_page_write(async_exch_t *, vfs_node_t *,
+    vfs_cache_page_t *);
+extern errno_t vfs_cache_copy(async_exch_t *, vfs_node_t *, aoff64_t, void *,
+    size_t, size_t *);
+extern errno_t vfs_cache_read(async_exch_t *, vfs_node_t *, aoff64_t,
+    size_t *);
+extern void vfs_cache_invalidate(vfs_triplet_t *, aoff64_t, aoff64_t);
+extern void vfs_cache_invalidate_fs(fs_handle_t, service_id_t);
+extern void vfs_cache_stats_get(vfs_cache_stats_t *);
 
 typedef struct {
 	void *buffer;
@@ -0,0 +1,767 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup vfs
+ * @{
+ */
+
+/**
+ * @file vfs_cache.c
+ * @brief VFS page cache.
+ *
+ * Pages of regular files are kept in page-sized anonymous areas indexed by
+ * the file's triplet and the page offset. The cache serves both page-in
+ * requests from the VFS pager and regular reads. Its contents are
+ * invalidated whenever VFS modifies the file, truncates it, removes its name
+ * or unmounts the file system. The least recently used pages are evicted
+ * once the cache reaches VFS_CACHE_PAGES.
+ *
+ * Users of a page must hold the node's contents_rwlock (at least for
+ * reading) while filling the page and must hold a reference while looking
+ * at its data.
+ *
+ * Pages mapped into clients by writable shared mappings are pinned. Their
+ * frames are the clients' view of the file, so pinned pages are never
+ * evicted and VFS writes to the file re-read them in place instead of
+ * dropping them.
+ */
+
+#include "vfs.h"
+#include <align.h>
+#include <as.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdlib.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <libarch/config.h>
+
+/** Maximum number of pages kept in the cache. */
+#define VFS_CACHE_PAGES  1024
+
+/** Mutex protecting the page cache. */
+static FIBRIL_MUTEX_INITIALIZE(cache_mutex);
+
+/** Page cache hash table. */
+static hash_table_t cache;
+
+/** List of cached pages, the most recently used first. */
+static LIST_INITIALIZE(cache_lru);
+
+/** List of pinned pages. */
+static LIST_INITIALIZE(cache_pinned);
+
+/** Number of pages reachable from the hash table. */
+static size_t cache_pages;
+
+static vfs_cache_stats_t cache_stats;
+
+static size_t cache_key_hash(const void *key)
+{
+	const vfs_cache_key_t *k = key;
+	size_t hash = hash_combine(k->fs_handle, k->index);
+	hash = hash_combine(hash, k->service_id);
+	return hash_combine(hash, hash_mix64(k->offset));
+}
+
+static size_t cache_hash(const ht_link_t *item)
+{
+	vfs_cache_page_t *page = hash_table_get_inst(item, vfs_cache_page_t,
+	    link);
+	return cache_key_hash(&page->key);
+}
+
+static bool cache_key_equal(const void *key, const ht_link_t *item)
+{
+	const vfs_cache_key_t *k = key;
+	vfs_cache_page_t *page = hash_table_get_inst(item, vfs_cache_page_t,
+	    link);
+
+	return page->key.fs_handle == k->fs_handle &&
+	    page->key.service_id == k->service_id &&
+	    page->key.index == k->index &&
+	    page->key.offset == k->offset;
+}
+
+/** Page cache hash table operations. */
+static hash_table_ops_t cache_ops = {
+	.hash = cache_hash,
+	.key_hash = cache_key_hash,
+	.key_equal = cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the VFS page cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_cache_init(void)
+{
+	return hash_table_create(&cache, 0, 0, &cache_ops);
+}
+
+/** Check whether contents of a node may be cached.
+ *
+ * @param node		VFS node.
+ *
+ * @return		True if the node is a regular file of a file system
+ *			which allows caching.
+ */
+bool vfs_cache_node_cacheable(vfs_node_t *node)
+{
+	if (node->type != VFS_NODE_FILE)
+		return false;
+
+	vfs_info_t *info = fs_handle_to_info(node->fs_handle);
+	return info != NULL && info->cacheable;
+}
+
+static void cache_page_destroy(vfs_cache_page_t *page)
+{
+	as_area_destroy(page->data);
+	free(page);
+}
+
+/** Remove a page from the cache.
+ *
+ * The page is destroyed right away unless someone holds it, in which case
+ * the last vfs_cache_page_put() destroys it.
+ */
+static void cache_page_drop(vfs_cache_page_t *page)
+{
+	assert(fibril_mutex_is_locked(&cache_mutex));
+	assert(page->cached);
+
+	hash_table_remove_item(&cache, &page->link);
+	list_remove(&page->lru_link);
+	page->cached = false;
+	cache_pages--;
+
+	if (page->refcnt == 0)
+		cache_page_destroy(page);
+}
+
+/** Evict unused pages until the cache fits its limit. */
+static void cache_evict(void)
+{
+	assert(fibril_mutex_is_locked(&cache_mutex));
+
+	link_t *link = list_last(&cache_lru);
+	while (cache_pages > VFS_CACHE_PAGES && link != NULL) {
+		vfs_cache_page_t *page = list_get_instance(link,
+		    vfs_cache_page_t, lru_link);
+		link = list_prev(link, &cache_lru);
+
+		if (page->refcnt == 0) {
+			cache_page_drop(page);
+			cache_stats.evictions++;
+		}
+	}
+}
+
+/** Read the contents of a page from its file system.
+ *
+ * The part of the page past the end of file is cleared.
+ *
+ * @param exch		Exchange with the file system.
+ * @param page		Page to read.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t cache_page_read(async_exch_t *exch, vfs_cache_page_t *page)
+{
+	vfs_cache_key_t *key = &page->key;
+
+	if (exch == NULL)
+		return ENOENT;
+
+	page->valid = 0;
+
+	errno_t rc = EOK;
+	while (page->valid < PAGE_SIZE) {
+		aoff64_t pos = key->offset + page->valid;
+		ipc_call_t answer;
+
+		aid_t msg = async_send_4(exch, VFS_OUT_READ, key->service_id,
+		    key->index, LOWER32(pos), UPPER32(pos), &answer);
+		if (msg == 0) {
+			rc = EINVAL;
+			break;
+		}
+
+		rc = async_data_read_start(exch, page->data + page->valid,
+		    PAGE_SIZE - page->valid);
+		if (rc != EOK) {
+			async_forget(msg);
+			break;
+		}
+
+		async_wait_for(msg, &rc);
+		if (rc != EOK)
+			break;
+
+		size_t bytes = ipc_get_arg1(&answer);
+		if (bytes == 0)
+			break;
+
+		page->valid += bytes;
+	}
+
+	memset(page->data + page->valid, 0, PAGE_SIZE - page->valid);
+	return rc;
+}
+
+/** Read one page of a file from its file system.
+ *
+ * @param exch		Exchange with the file system.
+ * @param key		Page to read.
+ * @param[out] out	The new page, not yet in the cache.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t cache_page_fill(async_exch_t *exch, vfs_cache_key_t *key,
+    vfs_cache_page_t **out)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	vfs_cache_page_t *page = calloc(1, sizeof(vfs_cache_page_t));
+	if (page == NULL)
+		return ENOMEM;
+
+	page->data = as_area_create(AS_AREA_ANY, PAGE_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_UNPAGED);
+	if (page->data == AS_MAP_FAILED) {
+		free(page);
+		return ENOMEM;
+	}
+
+	link_initialize(&page->lru_link);
+	link_initialize(&page->pin_link);
+	page->key = *key;
+
+	errno_t rc = cache_page_read(exch, page);
+	if (rc != EOK) {
+		cache_page_destroy(page);
+		return rc;
+	}
+
+	*out = page;
+	return EOK;
+}
+
+/** Get a page of a file, reading it from the file system if needed.
+ *
+ * The caller must hold the node's contents_rwlock.
+ *
+ * @param exch		Exchange with the node's file system.
+ * @param node		Cacheable VFS node.
+ * @param offset	Page-aligned offset within the file.
+ * @param[out] out	The page. Release it with vfs_cache_page_put().
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t vfs_cache_page_get(async_exch_t *exch, vfs_node_t *node,
+    aoff64_t offset, vfs_cache_page_t **out)
+{
+	assert(ALIGN_DOWN(offset, PAGE_SIZE) == offset);
+
+	vfs_cache_key_t key = {
+		.fs_handle = node->fs_handle,
+		.service_id = node->service_id,
+		.index = node->index,
+		.offset = offset
+	};
+
+	/*
+	 * A page cached when the file was shorter may lack data written past
+	 * the old end of file since. Pinned pages are kept up to date by
+	 * vfs_cache_invalidate().
+	 */
+	size_t needed = 0;
+	if (offset < node->size)
+		needed = min(node->size - offset, PAGE_SIZE);
+
+	fibril_mutex_lock(&cache_mutex);
+
+	vfs_cache_page_t *page = NULL;
+	ht_link_t *link = hash_table_find(&cache, &key);
+	if (link != NULL) {
+		page = hash_table_get_inst(link, vfs_cache_page_t, link);
+		if (page->valid >= needed || page->pincnt > 0) {
+			page->refcnt++;
+			list_remove(&page->lru_link);
+			list_prepend(&page->lru_link, &cache_lru);
+			cache_stats.hits++;
+			fibril_mutex_unlock(&cache_mutex);
+
+			*out = page;
+			return EOK;
+		}
+
+		cache_page_drop(page);
+	}
+
+	cache_stats.misses++;
+	fibril_mutex_unlock(&cache_mutex);
+
+	errno_t rc = cache_page_fill(exch, &key, &page);
+	if (rc != EOK)
+		return rc;
+
+	fibril_mutex_lock(&cache_mutex);
+
+	/*
+	 * Another reader might have filled the same page meanwhile. A pinned
+	 * page stays, it is mapped by clients.
+	 */
+	link = hash_table_find(&cache, &key);
+	if (link != NULL) {
+		vfs_cache_page_t *other = hash_table_get_inst(link,
+		    vfs_cache_page_t, link);
+		if (other->pincnt > 0) {
+			other->refcnt++;
+			fibril_mutex_unlock(&cache_mutex);
+			cache_page_destroy(page);
+
+			*out = other;
+			return EOK;
+		}
+
+		cache_page_drop(other);
+	}
+
+	page->refcnt = 1;
+	page->cached = true;
+	hash_table_insert(&cache, &page->link);
+	list_prepend(&page->lru_link, &cache_lru);
+	cache_pages++;
+	cache_evict();
+
+	fibril_mutex_unlock(&cache_mutex);
+
+	*out = page;
+	return EOK;
+}
+
+/** Release a page obtained by vfs_cache_page_get().
+ *
+ * @param page		Page to release.
+ */
+void vfs_cache_page_put(vfs_cache_page_t *page)
+{
+	fibril_mutex_lock(&cache_mutex);
+
+	assert(page->refcnt > 0);
+	page->refcnt--;
+	if (page->refcnt == 0) {
+		if (!page->cached)
+			cache_page_destroy(page);
+		else
+			cache_evict();
+	}
+
+	fibril_mutex_unlock(&cache_mutex);
+}
+
+/** Pin a page for a writable shared mapping.
+ *
+ * The pin holds its own reference to the page.
+ *
+ * @param page		Page held by the caller.
+ */
+void vfs_cache_page_pin(vfs_cache_page_t *page)
+{
+	fibril_mutex_lock(&cache_mutex);
+
+	assert(page->refcnt > 0);
+	page->refcnt++;
+	if (page->pincnt++ == 0)
+		list_append(&page->pin_link, &cache_pinned);
+
+	fibril_mutex_unlock(&cache_mutex);
+}
+
+/** Unpin a page pinned by vfs_cache_page_pin().
+ *
+ * @param page		Page to unpin.
+ */
+void vfs_cache_page_unpin(vfs_cache_page_t *page)
+{
+	fibril_mutex_lock(&cache_mutex);
+
+	assert(page->pincnt > 0);
+	if (--page->pincnt == 0)
+		list_remove(&page->pin_link);
+
+	fibril_mutex_unlock(&cache_mutex);
+
+	vfs_cache_page_put(page);
+}
+
+/** Write a page back to its file system.
+ *
+ * Only the part of the page inside the file is written, the file does not
+ * grow.
+ *
+ * The caller must hold the node's contents_rwlock for writing.
+ *
+ * @param exch		Exchange with the node's file system.
+ * @param node		VFS node the page belongs to.
+ * @param page		Page held by the caller.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t vfs_cache_page_write(async_exch_t *exch, vfs_node_t *node,
+    vfs_cache_page_t *page)
+{
+	if (exch == NULL)
+		return ENOENT;
+
+	aoff64_t offset = page->key.offset;
+	size_t len = 0;
+	if (offset < node->size)
+		len = min(node->size - offset, PAGE_SIZE);
+
+	size_t done = 0;
+	while (done < len) {
+		aoff64_t pos = offset + done;
+		ipc_call_t answer;
+
+		aid_t msg = async_send_4(exch, VFS_OUT_WRITE, node->service_id,
+		    node->index, LOWER32(pos), UPPER32(pos), &answer);
+		if (msg == 0)
+			return EINVAL;
+
+		errno_t rc = async_data_write_start(exch, page->data + done,
+		    len - done);
+		if (rc != EOK) {
+			async_forget(msg);
+			return rc;
+		}
+
+		async_wait_for(msg, &rc);
+		if (rc != EOK)
+			return rc;
+
+		size_t bytes = ipc_get_arg1(&answer);
+		if (bytes == 0)
+			return EIO;
+
+		done += bytes;
+	}
+
+	return EOK;
+}
+
+/** Copy part of a regular file from the page cache into a buffer.
+ *
+ * The caller must hold the node's contents_rwlock.
+ *
+ * @param exch		Exchange with the node's file system.
+ * @param node		Cacheable VFS node.
+ * @param pos		Position in the file.
+ * @param buf		Destination buffer.
+ * @param len		Maximum number of bytes to copy.
+ * @param[out] bytes	Number of bytes copied.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t vfs_cache_copy(async_exch_t *exch, vfs_node_t *node, aoff64_t pos,
+    void *buf, size_t len, size_t *bytes)
+{
+	uint8_t *dst = buf;
+
+	if (pos >= node->size)
+		len = 0;
+	else
+		len = min(len, node->size - pos);
+
+	size_t done = 0;
+	while (done < len) {
+		aoff64_t offset = ALIGN_DOWN(pos + done, PAGE_SIZE);
+		size_t skip = pos + done - offset;
+
+		vfs_cache_page_t *page;
+		errno_t rc = vfs_cache_page_get(exch, node, offset, &page);
+		if (rc != EOK)
+			return rc;
+
+		/* The file system may know the file to be shorter. */
+		if (page->valid <= skip) {
+			vfs_cache_page_put(page);
+			break;
+		}
+
+		size_t chunk = min(page->valid - skip, len - done);
+		memcpy(dst + done, page->data + skip, chunk);
+		vfs_cache_page_put(page);
+		done += chunk;
+	}
+
+	*bytes = done;
+	return EOK;
+}
+
+/** Serve a client's read of a regular file from the page cache.
+ *
+ * This is the cached counterpart of forwarding the client's IPC_M_DATA_READ
+ * to the file system: the request is received and answered here.
+ *
+ * The caller must hold the node's contents_rwlock.
+ *
+ * @param exch		Exchange with the node's file system.
+ * @param node		Cacheable VFS node.
+ * @param pos		Position in the file.
+ * @param[out] bytes	Number of bytes read.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t vfs_cache_read(async_exch_t *exch, vfs_node_t *node, aoff64_t pos,
+    size_t *bytes)
+{
+	ipc_call_t call;
+	size_t len;
+	if (!async_data_read_receive(&call, &len)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (pos >= node->size)
+		len = 0;
+	else
+		len = min(len, node->size - pos);
+
+	uint8_t *buf = NULL;
+	if (len > 0) {
+		buf = malloc(len);
+		if (buf == NULL) {
+			async_answer_0(&call, ENOMEM);
+			return ENOMEM;
+		}
+	}
+
+	size_t done = 0;
+	errno_t rc = vfs_cache_copy(exch, node, pos, buf, len, &done);
+	if (rc != EOK) {
+		free(buf);
+		async_answer_0(&call, rc);
+		return rc;
+	}
+
+	rc = async_data_read_finalize(&call, buf, done);
+	free(buf);
+
+	*bytes = done;
+	return rc;
+}
+
+typedef struct {
+	fs_handle_t fs_handle;
+	service_id_t service_id;
+	fs_index_t index;
+	/** Drop pages of all files of the file system instance. */
+	bool all_files;
+	aoff64_t start;
+	aoff64_t end;
+} cache_invalidate_arg_t;
+
+static bool cache_invalidate_cb(ht_link_t *item, void *arg)
+{
+	cache_invalidate_arg_t *range = arg;
+	vfs_cache_page_t *page = hash_table_get_inst(item, vfs_cache_page_t,
+	    link);
+
+	if (page->key.fs_handle != range->fs_handle ||
+	    page->key.service_id != range->service_id)
+		return true;
+
+	if (!range->all_files && page->key.index != range->index)
+		return true;
+
+	if (!range->all_files && page->pincnt > 0)
+		return true;
+
+	if (page->key.offset + PAGE_SIZE > range->start &&
+	    page->key.offset < range->end) {
+		cache_page_drop(page);
+		cache_stats.invalidations++;
+	}
+
+	return true;
+}
+
+/** Re-read pinned pages of a file overlapping a range.
+ *
+ * Must be called with cache_mutex held, which is released.
+ */
+static void cache_refresh_pinned(vfs_triplet_t *triplet, aoff64_t start,
+    aoff64_t end)
+{
+	assert(fibril_mutex_is_locked(&cache_mutex));
+
+	size_t count = 0;
+	list_foreach(cache_pinned, pin_link, vfs_cache_page_t, page) {
+		if (page->cached && page->key.fs_handle == triplet->fs_handle &&
+		    page->key.service_id == triplet->service_id &&
+		    page->key.index == triplet->index &&
+		    page->key.offset + PAGE_SIZE > start &&
+		    page->key.offset < end)
+			count++;
+	}
+
+	vfs_cache_page_t **pages = NULL;
+	if (count > 0)
+		pages = malloc(count * sizeof(vfs_cache_page_t *));
+	if (pages == NULL) {
+		fibril_mutex_unlock(&cache_mutex);
+		return;
+	}
+
+	size_t i = 0;
+	list_foreach(cache_pinned, pin_link, vfs_cache_page_t, page) {
+		if (page->cached && page->key.fs_handle == triplet->fs_handle &&
+		    page->key.service_id == triplet->service_id &&
+		    page->key.index == triplet->index &&
+		    page->key.offset + PAGE_SIZE > start &&
+		    page->key.offset < end) {
+			page->refcnt++;
+			pages[i++] = page;
+		}
+	}
+
+	fibril_mutex_unlock(&cache_mutex);
+
+	async_exch_t *exch = vfs_exchange_grab(triplet->fs_handle);
+	for (i = 0; i < count; i++) {
+		(void) cache_page_read(exch, pages[i]);
+		vfs_cache_page_put(pages[i]);
+	}
+	vfs_exchange_release(exch);
+
+	free(pages);
+}
+
+/** Drop cached pages of a file overlapping a range.
+ *
+ * Pinned pages are re-read from the file system instead.
+ *
+ * @param triplet	File whose pages to drop.
+ * @param start		Start of the modified range.
+ * @param end		End of the modified range (exclusive). Use
+ *			UINT64_MAX to cover the rest of the file.
+ */
+void vfs_cache_invalidate(vfs_triplet_t *triplet, aoff64_t start,
+    aoff64_t end)
+{
+	if (start >= end)
+		return;
+
+	fibril_mutex_lock(&cache_mutex);
+
+	if (end - start <= 16 * PAGE_SIZE) {
+		/* Look up the few affected pages directly. */
+		vfs_cache_key_t key = {
+			.fs_handle = triplet->fs_handle,
+			.service_id = triplet->service_id,
+			.index = triplet->index
+		};
+
+		key.offset = ALIGN_DOWN(start, PAGE_SIZE);
+		for (; key.offset < end; key.offset += PAGE_SIZE) {
+			ht_link_t *link = hash_table_find(&cache, &key);
+			if (link == NULL)
+				continue;
+
+			vfs_cache_page_t *page = hash_table_get_inst(link,
+			    vfs_cache_page_t, link);
+			if (page->pincnt == 0) {
+				cache_page_drop(page);
+				cache_stats.invalidations++;
+			}
+		}
+	} else {
+		cache_invalidate_arg_t arg = {
+			.fs_handle = triplet->fs_handle,
+			.service_id = triplet->service_id,
+			.index = triplet->index,
+			.all_files = false,
+			.start = start,
+			.end = end
+		};
+
+		hash_table_apply(&cache, cache_invalidate_cb, &arg);
+	}
+
+	if (list_empty(&cache_pinned))
+		fibril_mutex_unlock(&cache_mutex);
+	else
+		cache_refresh_pinned(triplet, start, end);
+}
+
+/** Drop all cached pages of a file system instance.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ */
+void vfs_cache_invalidate_fs(fs_handle_t fs_handle, service_id_t service_id)
+{
+	cache_invalidate_arg_t arg = {
+		.fs_handle = fs_handle,
+		.service_id = service_id,
+		.all_files = true,
+		.start = 0,
+		.end = UINT64_MAX
+	};
+
+	fibril_mutex_lock(&cache_mutex);
+	hash_table_apply(&cache, cache_invalidate_cb, &arg);
+	fibril_mutex_unlock(&cache_mutex);
+}
+
+/** Get page cache statistics.
+ *
+ * @param[out] stats	Place to store the statistics.
+ */
+void vfs_cache_stats_get(vfs_cache_stats_t *stats)
+{
+	fibril_mutex_lock(&cache_mutex);
+	*stats = cache_stats;
+	stats->entries = cache_pages;
+	fibril_mutex_unlock(&cache_mutex);
+}
+
+/**
+ * @}
+ */
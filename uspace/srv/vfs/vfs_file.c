@@ -35,6 +35,7 @@
  * @brief	Various operations on files have their home in this file.
  */
 
+#include <as.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <str.h>
@@ -55,6 +56,8 @@ typedef struct {
 	fibril_condvar_t cv;
 	list_t passed_handles;
 	vfs_file_t **files;
+	/** Pages mapped for writing by the client (vfs_pager_pin_t). */
+	list_t pins;
 } vfs_client_data_t;
 
 typedef struct {
@@ -118,6 +121,7 @@ void *vfs_client_data_create(void)
 		fibril_condvar_initialize(&vfs_data->cv);
 		list_initialize(&vfs_data->passed_handles);
 		vfs_data->files = NULL;
+		list_initialize(&vfs_data->pins);
 	}
 
 	return vfs_data;
@@ -127,10 +131,17 @@ void vfs_client_data_destroy(void *data)
 {
 	vfs_client_data_t *vfs_data = (vfs_client_data_t *) data;
 
+	vfs_pager_pins_release(&vfs_data->pins);
 	vfs_files_done(vfs_data);
 	free(vfs_data);
 }
 
+/** Get the list of pages mapped for writing by the current client. */
+list_t *vfs_client_pins(void)
+{
+	return &VFS_DATA->pins;
+}
+
 /** Close the file in the endpoint FS server. */
 static errno_t vfs_file_close_remote(vfs_file_t *file)
 {
@@ -185,6 +196,8 @@ static errno_t vfs_file_delref(vfs_client_data_t *vfs_data, vfs_file_t *file)
 			}
 			vfs_node_delref(file->node);
 		}
+		if (file->buffer != NULL)
+			as_area_destroy(file->buffer);
 		free(file);
 	}
 
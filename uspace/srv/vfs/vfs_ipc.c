@@ -29,11 +29,70 @@
 #include <vfs/vfs.h>
 #include "vfs.h"
 
+#include <as.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <str.h>
 #include <vfs/canonify.h>
 
+static void vfs_in_buffer(ipc_call_t *req)
+{
+	int fd = ipc_get_arg1(req);
+	bool share = ipc_get_arg2(req);
+	void *buf = NULL;
+	size_t size = 0;
+
+	if (share) {
+		ipc_call_t call;
+		unsigned int flags;
+
+		if (!async_share_out_receive(&call, &size, &flags)) {
+			async_answer_0(&call, EINVAL);
+			async_answer_0(req, EINVAL);
+			return;
+		}
+
+		if ((flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+		    (AS_AREA_READ | AS_AREA_WRITE)) {
+			async_answer_0(&call, EPERM);
+			async_answer_0(req, EPERM);
+			return;
+		}
+
+		errno_t rc = async_share_out_finalize(&call, &buf);
+		if (rc != EOK || buf == AS_MAP_FAILED) {
+			async_answer_0(req, ENOMEM);
+			return;
+		}
+	}
+
+	errno_t rc = vfs_op_buffer(fd, buf, size);
+	if (rc != EOK && buf != NULL)
+		as_area_destroy(buf);
+	async_answer_0(req, rc);
+}
+
+static void vfs_in_cache_stats(ipc_call_t *req)
+{
+	vfs_cache_t cache = ipc_get_arg1(req);
+	vfs_cache_stats_t stats;
+
+	switch (cache) {
+	case VFS_PAGE_CACHE:
+		vfs_cache_stats_get(&stats);
+		break;
+	case VFS_NAME_CACHE:
+		vfs_lookup_cache_stats_get(&stats);
+		break;
+	default:
+		async_answer_0(req, EINVAL);
+		return;
+	}
+
+	async_answer_5(req, EOK, stats.hits, stats.misses, stats.evictions,
+	    stats.invalidations, stats.entries);
+}
+
 static void vfs_in_clone(ipc_call_t *req)
 {
 	int oldfd = ipc_get_arg1(req);
@@ -183,6 +242,18 @@ static void vfs_in_read(ipc_call_t *req)
 	async_answer_1(req, rc, bytes);
 }
 
+static void vfs_in_read_buffer(ipc_call_t *req)
+{
+	int fd = ipc_get_arg1(req);
+	aoff64_t pos = MERGE_LOUP32(ipc_get_arg2(req),
+	    ipc_get_arg3(req));
+	size_t size = ipc_get_arg4(req);
+
+	size_t bytes = 0;
+	errno_t rc = vfs_op_read_buffer(fd, pos, size, &bytes);
+	async_answer_1(req, rc, bytes);
+}
+
 static void vfs_in_rename(ipc_call_t *req)
 {
 	/* The common base directory. */
@@ -315,6 +386,18 @@ static void vfs_in_write(ipc_call_t *req)
 	async_answer_1(req, rc, bytes);
 }
 
+static void vfs_in_write_buffer(ipc_call_t *req)
+{
+	int fd = ipc_get_arg1(req);
+	aoff64_t pos = MERGE_LOUP32(ipc_get_arg2(req),
+	    ipc_get_arg3(req));
+	size_t size = ipc_get_arg4(req);
+
+	size_t bytes = 0;
+	errno_t rc = vfs_op_write_buffer(fd, pos, size, &bytes);
+	async_answer_1(req, rc, bytes);
+}
+
 void vfs_connection(ipc_call_t *icall, void *arg)
 {
 	bool cont = true;
@@ -335,6 +418,12 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		}
 
 		switch (ipc_get_imethod(&call)) {
+		case VFS_IN_BUFFER:
+			vfs_in_buffer(&call);
+			break;
+		case VFS_IN_CACHE_STATS:
+			vfs_in_cache_stats(&call);
+			break;
 		case VFS_IN_CLONE:
 			vfs_in_clone(&call);
 			break;
@@ -356,6 +445,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_READ:
 			vfs_in_read(&call);
 			break;
+		case VFS_IN_READ_BUFFER:
+			vfs_in_read_buffer(&call);
+			break;
 		case VFS_IN_REGISTER:
 			vfs_register(&call);
 			cont = false;
@@ -390,6 +482,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_WRITE:
 			vfs_in_write(&call);
 			break;
+		case VFS_IN_WRITE_BUFFER:
+			vfs_in_write_buffer(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -43,6 +43,9 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <fibril_synch.h>
+#include <stdlib.h>
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <vfs/canonify.h>
 #include <dirent.h>
@@ -137,6 +140,385 @@ static void plb_clear_entry(plb_entry_t *entry, size_t first, size_t len)
 	fibril_mutex_unlock(&plb_mutex);
 }
 
+/** Maximum number of entries in the name cache. */
+#define DCACHE_ENTRIES  4096
+
+/**
+ * Name cache entry: the result of looking up one path component in a
+ * directory, or the fact that the name does not exist there.
+ */
+typedef struct {
+	ht_link_t link;		/**< Link in dcache. */
+	ht_link_t child_link;	/**< Link in dcache_children, if positive. */
+	link_t lru_link;	/**< Link in dcache_lru. */
+
+	vfs_triplet_t parent;
+	char *name;
+	size_t name_len;
+
+	/** The name does not exist in the parent directory. */
+	bool negative;
+	vfs_lookup_res_t child;
+} dentry_t;
+
+typedef struct {
+	const vfs_triplet_t *parent;
+	const char *name;
+	size_t name_len;
+} dentry_key_t;
+
+/** Mutex protecting the name cache. */
+static FIBRIL_MUTEX_INITIALIZE(dcache_mutex);
+
+/** Name cache entries keyed by the parent triplet and the name. */
+static hash_table_t dcache;
+
+/** Positive name cache entries keyed by the child triplet. */
+static hash_table_t dcache_children;
+
+/** List of name cache entries, the most recently used first. */
+static LIST_INITIALIZE(dcache_lru);
+
+/**
+ * Incremented by every invalidation, so that lookups racing with a
+ * namespace change do not insert what they learned before the change.
+ */
+static unsigned dcache_gen;
+
+static vfs_cache_stats_t dcache_stats;
+
+static size_t triplet_hash(const vfs_triplet_t *triplet)
+{
+	size_t hash = hash_combine(triplet->fs_handle, triplet->index);
+	return hash_combine(hash, triplet->service_id);
+}
+
+static bool triplet_equal(const vfs_triplet_t *a, const vfs_triplet_t *b)
+{
+	return a->fs_handle == b->fs_handle &&
+	    a->service_id == b->service_id && a->index == b->index;
+}
+
+static size_t dcache_key_hash(const void *key)
+{
+	const dentry_key_t *k = key;
+	size_t hash = triplet_hash(k->parent);
+
+	for (size_t i = 0; i < k->name_len; i++)
+		hash = hash_combine(hash, (uint8_t) k->name[i]);
+
+	return hash;
+}
+
+static size_t dcache_hash(const ht_link_t *item)
+{
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, link);
+	dentry_key_t key = {
+		.parent = &dentry->parent,
+		.name = dentry->name,
+		.name_len = dentry->name_len
+	};
+
+	return dcache_key_hash(&key);
+}
+
+static bool dcache_key_equal(const void *key, const ht_link_t *item)
+{
+	const dentry_key_t *k = key;
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, link);
+
+	return triplet_equal(k->parent, &dentry->parent) &&
+	    k->name_len == dentry->name_len &&
+	    memcmp(k->name, dentry->name, k->name_len) == 0;
+}
+
+static size_t dcache_children_key_hash(const void *key)
+{
+	return triplet_hash(key);
+}
+
+static size_t dcache_children_hash(const ht_link_t *item)
+{
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, child_link);
+	return triplet_hash(&dentry->child.triplet);
+}
+
+static bool dcache_children_key_equal(const void *key, const ht_link_t *item)
+{
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, child_link);
+	return triplet_equal(key, &dentry->child.triplet);
+}
+
+static hash_table_ops_t dcache_ops = {
+	.hash = dcache_hash,
+	.key_hash = dcache_key_hash,
+	.key_equal = dcache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+static hash_table_ops_t dcache_children_ops = {
+	.hash = dcache_children_hash,
+	.key_hash = dcache_children_key_hash,
+	.key_equal = dcache_children_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL,
+};
+
+/** Initialize the name cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_lookup_cache_init(void)
+{
+	if (!hash_table_create(&dcache, 0, 0, &dcache_ops))
+		return false;
+
+	if (!hash_table_create(&dcache_children, 0, 0, &dcache_children_ops)) {
+		hash_table_destroy(&dcache);
+		return false;
+	}
+
+	return true;
+}
+
+static void dentry_remove(dentry_t *dentry)
+{
+	assert(fibril_mutex_is_locked(&dcache_mutex));
+
+	hash_table_remove_item(&dcache, &dentry->link);
+	if (!dentry->negative)
+		hash_table_remove_item(&dcache_children, &dentry->child_link);
+	list_remove(&dentry->lru_link);
+	dcache_stats.entries--;
+
+	free(dentry->name);
+	free(dentry);
+}
+
+/** Look up a name in the name cache.
+ *
+ * @param parent	Directory containing the name.
+ * @param name		Name, not necessarily NUL-terminated.
+ * @param len		Length of the name.
+ * @param[out] negative	The name is known not to exist.
+ * @param[out] child	Result of the lookup if the name exists.
+ * @param[out] gen	Generation to pass to dcache_insert() on a miss.
+ *
+ * @return		True if the cache knows the answer.
+ */
+static bool dcache_find(vfs_triplet_t *parent, const char *name, size_t len,
+    bool *negative, vfs_lookup_res_t *child, unsigned *gen)
+{
+	dentry_key_t key = {
+		.parent = parent,
+		.name = name,
+		.name_len = len
+	};
+
+	fibril_mutex_lock(&dcache_mutex);
+
+	ht_link_t *link = hash_table_find(&dcache, &key);
+	if (link == NULL) {
+		dcache_stats.misses++;
+		*gen = dcache_gen;
+		fibril_mutex_unlock(&dcache_mutex);
+		return false;
+	}
+
+	dentry_t *dentry = hash_table_get_inst(link, dentry_t, link);
+	list_remove(&dentry->lru_link);
+	list_prepend(&dentry->lru_link, &dcache_lru);
+	dcache_stats.hits++;
+
+	*negative = dentry->negative;
+	if (!dentry->negative)
+		*child = dentry->child;
+
+	fibril_mutex_unlock(&dcache_mutex);
+	return true;
+}
+
+/** Remember the result of looking up a name.
+ *
+ * @param parent	Directory containing the name.
+ * @param name		Name, not necessarily NUL-terminated.
+ * @param len		Length of the name.
+ * @param child		Result of the lookup or NULL if the name does not
+ *			exist.
+ * @param gen		Generation returned by the dcache_find() miss.
+ */
+static void dcache_insert(vfs_triplet_t *parent, const char *name, size_t len,
+    vfs_lookup_res_t *child, unsigned gen)
+{
+	dentry_t *dentry = calloc(1, sizeof(dentry_t));
+	if (dentry == NULL)
+		return;
+
+	dentry->name = malloc(len + 1);
+	if (dentry->name == NULL) {
+		free(dentry);
+		return;
+	}
+
+	memcpy(dentry->name, name, len);
+	dentry->name[len] = 0;
+	dentry->name_len = len;
+	dentry->parent = *parent;
+	dentry->negative = (child == NULL);
+	if (child != NULL)
+		dentry->child = *child;
+	link_initialize(&dentry->lru_link);
+
+	fibril_mutex_lock(&dcache_mutex);
+
+	if (gen != dcache_gen) {
+		fibril_mutex_unlock(&dcache_mutex);
+		free(dentry->name);
+		free(dentry);
+		return;
+	}
+
+	/* A concurrent lookup of the same name may have been faster. */
+	dentry_key_t key = {
+		.parent = parent,
+		.name = name,
+		.name_len = len
+	};
+	ht_link_t *link = hash_table_find(&dcache, &key);
+	if (link != NULL)
+		dentry_remove(hash_table_get_inst(link, dentry_t, link));
+
+	hash_table_insert(&dcache, &dentry->link);
+	if (!dentry->negative)
+		hash_table_insert(&dcache_children, &dentry->child_link);
+	list_prepend(&dentry->lru_link, &dcache_lru);
+	dcache_stats.entries++;
+
+	while (dcache_stats.entries > DCACHE_ENTRIES) {
+		dentry_remove(list_get_instance(list_last(&dcache_lru),
+		    dentry_t, lru_link));
+		dcache_stats.evictions++;
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Forget what the name cache knows about a name. */
+static void dcache_invalidate_name(vfs_triplet_t *parent, const char *name,
+    size_t len)
+{
+	dentry_key_t key = {
+		.parent = parent,
+		.name = name,
+		.name_len = len
+	};
+
+	fibril_mutex_lock(&dcache_mutex);
+
+	dcache_gen++;
+	ht_link_t *link = hash_table_find(&dcache, &key);
+	if (link != NULL) {
+		dentry_remove(hash_table_get_inst(link, dentry_t, link));
+		dcache_stats.invalidations++;
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+static bool dcache_invalidate_dir_cb(ht_link_t *item, void *arg)
+{
+	vfs_triplet_t *dir = arg;
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, link);
+
+	if (triplet_equal(&dentry->parent, dir)) {
+		dentry_remove(dentry);
+		dcache_stats.invalidations++;
+	}
+
+	return true;
+}
+
+/**
+ * Forget all names in a removed directory. The file system may reuse its
+ * index for another directory.
+ */
+static void dcache_invalidate_dir(vfs_triplet_t *dir)
+{
+	fibril_mutex_lock(&dcache_mutex);
+	dcache_gen++;
+	hash_table_apply(&dcache, dcache_invalidate_dir_cb, dir);
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+static bool dcache_invalidate_fs_cb(ht_link_t *item, void *arg)
+{
+	vfs_pair_t *pair = arg;
+	dentry_t *dentry = hash_table_get_inst(item, dentry_t, link);
+
+	if (dentry->parent.fs_handle == pair->fs_handle &&
+	    dentry->parent.service_id == pair->service_id) {
+		dentry_remove(dentry);
+		dcache_stats.invalidations++;
+	}
+
+	return true;
+}
+
+/** Forget all names of a file system instance.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ */
+void vfs_lookup_cache_invalidate_fs(fs_handle_t fs_handle,
+    service_id_t service_id)
+{
+	vfs_pair_t pair = {
+		.fs_handle = fs_handle,
+		.service_id = service_id
+	};
+
+	fibril_mutex_lock(&dcache_mutex);
+	dcache_gen++;
+	hash_table_apply(&dcache, dcache_invalidate_fs_cb, &pair);
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Update the size of a node remembered by the name cache.
+ *
+ * VFS keeps the size of nodes in memory up to date, so this needs to be
+ * called only when a node leaves memory.
+ *
+ * @param triplet	Node whose size may have changed.
+ * @param size		Current size of the node.
+ */
+void vfs_lookup_cache_size_update(vfs_triplet_t *triplet, aoff64_t size)
+{
+	fibril_mutex_lock(&dcache_mutex);
+
+	ht_link_t *first = hash_table_find(&dcache_children, triplet);
+	ht_link_t *link = first;
+	while (link != NULL) {
+		dentry_t *dentry = hash_table_get_inst(link, dentry_t,
+		    child_link);
+		dentry->child.size = size;
+		link = hash_table_find_next(&dcache_children, first, link);
+	}
+
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
+/** Get name cache statistics.
+ *
+ * @param[out] stats	Place to store the statistics.
+ */
+void vfs_lookup_cache_stats_get(vfs_cache_stats_t *stats)
+{
+	fibril_mutex_lock(&dcache_mutex);
+	*stats = dcache_stats;
+	fibril_mutex_unlock(&dcache_mutex);
+}
+
 errno_t vfs_link_internal(vfs_node_t *base, char *path, vfs_triplet_t *child)
 {
 	assert(base != NULL);
@@ -202,6 +584,8 @@ errno_t vfs_link_internal(vfs_node_t *base, char *path, vfs_triplet_t *child)
 	if (orig_rc != EOK)
 		rc = orig_rc;
 
+	dcache_invalidate_name(triplet, component, str_size(component));
+
 out:
 	return rc;
 }
@@ -321,6 +705,146 @@ out:
 	return rc;
 }
 
+/** Look up one path component at the file system.
+ *
+ * @param parent	Directory to look the component up in.
+ * @param component	The component, preceded by a slash.
+ * @param len		Length of the component including the slash.
+ * @param[out] res	Result of the lookup.
+ *
+ * @return		EOK on success, ENOENT if the name does not exist or
+ *			another error code.
+ */
+static errno_t lookup_component(vfs_triplet_t *parent, char *component,
+    size_t len, vfs_lookup_res_t *res)
+{
+	size_t first;
+	plb_entry_t entry;
+	errno_t rc = plb_insert_entry(&entry, component, &first, len);
+	if (rc != EOK)
+		return rc;
+
+	size_t next = first;
+	size_t nlen = len;
+	rc = out_lookup(parent, &next, &nlen, L_NONE, res);
+
+	/*
+	 * The file system answers with the directory itself if the name
+	 * does not exist in it.
+	 */
+	if (rc == EOK && nlen > 0)
+		rc = ENOENT;
+
+	plb_clear_entry(&entry, first, len);
+	return rc;
+}
+
+/** Cross the mount points stacked on top of a node.
+ *
+ * @param res		Node to start at, replaced by the root of the
+ *			topmost mounted file system.
+ * @param disable	Fail instead of crossing.
+ *
+ * @return		EOK on success or EXDEV if the node is a mount point
+ *			and crossing is disabled.
+ */
+static errno_t cross_mounts(vfs_lookup_res_t *res, bool disable)
+{
+	vfs_node_t *node = vfs_node_peek(res);
+	if (node == NULL)
+		return EOK;
+
+	errno_t rc = EOK;
+	if (node->mount != NULL) {
+		if (disable) {
+			rc = EXDEV;
+		} else {
+			vfs_node_t *mp = node;
+			while (mp->mount != NULL)
+				mp = mp->mount;
+
+			res->triplet = *((vfs_triplet_t *) mp);
+			res->type = mp->type;
+			res->size = mp->size;
+		}
+	}
+
+	vfs_node_put(node);
+	return rc;
+}
+
+/** Perform a path lookup which does not modify the namespace.
+ *
+ * The path is resolved component by component, consulting the name cache
+ * before asking the file system.
+ */
+static errno_t _vfs_lookup_cached(vfs_node_t *base, char *path, int lflag,
+    vfs_lookup_res_t *result, size_t len)
+{
+	assert(!(lflag & (L_CREATE | L_UNLINK)));
+	assert(path[0] == '/');
+
+	vfs_lookup_res_t cur = {
+		.triplet = *((vfs_triplet_t *) base),
+		.type = base->type,
+		.size = base->size
+	};
+
+	errno_t rc;
+	size_t next = 1;
+	do {
+		rc = cross_mounts(&cur, lflag & L_DISABLE_MOUNTS);
+		if (rc != EOK)
+			return rc;
+
+		if (next >= len)
+			break;
+
+		char *name = &path[next];
+		size_t nlen = 0;
+		while (next + nlen < len && name[nlen] != '/')
+			nlen++;
+
+		if (cur.type == VFS_NODE_FILE)
+			return ENOTDIR;
+
+		bool negative;
+		vfs_lookup_res_t child;
+		unsigned gen;
+		if (!dcache_find(&cur.triplet, name, nlen, &negative, &child,
+		    &gen)) {
+			rc = lookup_component(&cur.triplet, name - 1, nlen + 1,
+			    &child);
+			if (rc != EOK && rc != ENOENT)
+				return rc;
+
+			negative = (rc == ENOENT);
+			dcache_insert(&cur.triplet, name, nlen,
+			    negative ? NULL : &child, gen);
+		}
+
+		if (negative)
+			return ENOENT;
+
+		cur = child;
+		next += nlen + 1;
+	} while (next < len);
+
+	if ((lflag & L_FILE) && cur.type == VFS_NODE_DIRECTORY)
+		return EISDIR;
+	if ((lflag & L_DIRECTORY) && cur.type == VFS_NODE_FILE)
+		return ENOTDIR;
+
+	/* The found file may be a mount point. Try to cross it. */
+	if (!(lflag & (L_MP | L_DISABLE_MOUNTS)))
+		(void) cross_mounts(&cur, false);
+
+	if (result != NULL)
+		*result = cur;
+
+	return EOK;
+}
+
 /** Perform a path lookup.
  *
  * @param base    The file from which to perform the lookup.
@@ -372,7 +896,7 @@ errno_t vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
 
 			tflag &= ~(L_CREATE | L_EXCLUSIVE | L_UNLINK | L_FILE);
 			tflag |= L_DIRECTORY;
-			rc = _vfs_lookup_internal(base, path, tflag, &tres,
+			rc = _vfs_lookup_cached(base, path, tflag, &tres,
 			    slash - path);
 			if (rc != EOK)
 				return rc;
@@ -382,13 +906,31 @@ errno_t vfs_lookup_internal(vfs_node_t *base, char *path, int lflag,
 		} else
 			vfs_node_addref(parent);
 
-		rc = _vfs_lookup_internal(parent, slash, lflag, result,
+		vfs_lookup_res_t res;
+		rc = _vfs_lookup_internal(parent, slash, lflag, &res,
 		    len - (slash - path));
 
+		/*
+		 * The name was created or removed in the directory the
+		 * lookup ended up in.
+		 */
+		vfs_node_t *dir = parent;
+		while (dir->mount != NULL && !(lflag & L_DISABLE_MOUNTS))
+			dir = dir->mount;
+		dcache_invalidate_name((vfs_triplet_t *) dir, slash + 1,
+		    str_size(slash + 1));
+
+		if (rc == EOK && (lflag & L_UNLINK) &&
+		    res.type == VFS_NODE_DIRECTORY)
+			dcache_invalidate_dir(&res.triplet);
+
+		if (rc == EOK && result != NULL)
+			*result = res;
+
 		vfs_node_put(parent);
 
 	} else {
-		rc = _vfs_lookup_internal(base, path, lflag, result, len);
+		rc = _vfs_lookup_cached(base, path, lflag, result, len);
 	}
 
 	return rc;
@@ -124,6 +124,13 @@ void vfs_node_delref(vfs_node_t *node)
 	fibril_mutex_unlock(&nodes_mutex);
 
 	if (free_node) {
+		/*
+		 * The name cache remembers the size for when the node gets
+		 * looked up again.
+		 */
+		vfs_triplet_t triplet = node_triplet(node);
+		vfs_lookup_cache_size_update(&triplet, node->size);
+
 		/*
 		 * VFS_OUT_DESTROY will free up the file's resources if there
 		 * are no more hard links.
@@ -134,6 +141,9 @@ void vfs_node_delref(vfs_node_t *node)
 		    (sysarg_t)node->index);
 		vfs_exchange_release(exch);
 
+		if (node->unlinked)
+			vfs_cache_invalidate(&triplet, 0, UINT64_MAX);
+
 		free(node);
 	}
 }
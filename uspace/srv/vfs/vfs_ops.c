@@ -46,6 +46,7 @@
 #include <stdbool.h>
 #include <fibril_synch.h>
 #include <adt/list.h>
+#include <as.h>
 #include <ctype.h>
 #include <assert.h>
 #include <vfs/canonify.h>
@@ -85,6 +86,32 @@ static void out_destroy(vfs_triplet_t *file)
 	vfs_exchange_release(exch);
 }
 
+/** Replace the data buffer of an open file.
+ *
+ * @param fd		File descriptor.
+ * @param buf		Address of the client's area mapped into VFS or NULL
+ *			to drop the current buffer.
+ * @param size		Size of the area.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t vfs_op_buffer(int fd, void *buf, size_t size)
+{
+	vfs_file_t *file = vfs_file_get(fd);
+	if (file == NULL)
+		return EBADF;
+
+	void *old = file->buffer;
+	file->buffer = buf;
+	file->buffer_size = buf != NULL ? size : 0;
+
+	vfs_file_put(file);
+
+	if (old != NULL)
+		as_area_destroy(old);
+	return EOK;
+}
+
 errno_t vfs_op_clone(int oldfd, int newfd, bool desc, int *out_fd)
 {
 	errno_t rc;
@@ -357,6 +384,10 @@ static errno_t rdwr_ipc_client(async_exch_t *exch, vfs_file_t *file, aoff64_t po
 	size_t *bytes = (size_t *) data;
 	errno_t rc;
 
+	/* Serve reads of regular files from the page cache. */
+	if (read && vfs_cache_node_cacheable(file->node))
+		return vfs_cache_read(exch, file->node, pos, bytes);
+
 	/*
 	 * Make a VFS_READ/VFS_WRITE request at the destination FS server
 	 * and forward the IPC_M_DATA_READ/IPC_M_DATA_WRITE request to the
@@ -407,6 +438,87 @@ static errno_t rdwr_ipc_internal(async_exch_t *exch, vfs_file_t *file, aoff64_t
 	return (errno_t) rc;
 }
 
+typedef struct {
+	size_t size;
+	size_t bytes;
+} rdwr_buffer_t;
+
+/** Transfer file data between the file system and a file's shared buffer.
+ *
+ * Only control messages travel between the client and VFS. Cached reads are
+ * copied from the page cache straight into the buffer, other transfers are
+ * split into DATA_XFER_LIMIT sized requests to the file system which stop
+ * early on a short transfer.
+ */
+static errno_t rdwr_ipc_buffer(async_exch_t *exch, vfs_file_t *file,
+    aoff64_t pos, ipc_call_t *answer, bool read, void *data)
+{
+	rdwr_buffer_t *io = (rdwr_buffer_t *) data;
+	uint8_t *buf = file->buffer;
+	errno_t rc = EOK;
+
+	io->bytes = 0;
+
+	if (exch == NULL)
+		return ENOENT;
+
+	if (buf == NULL || io->size > file->buffer_size)
+		return EINVAL;
+
+	if (read && vfs_cache_node_cacheable(file->node)) {
+		rc = vfs_cache_copy(exch, file->node, pos, buf, io->size,
+		    &io->bytes);
+		ipc_set_arg1(answer, io->bytes);
+		return rc;
+	}
+
+	/* An empty transfer leaves the file size as it is. */
+	ipc_set_arg1(answer, 0);
+	ipc_set_arg2(answer, LOWER32(file->node->size));
+	ipc_set_arg3(answer, UPPER32(file->node->size));
+
+	while (io->bytes < io->size) {
+		size_t chunk = min(io->size - io->bytes,
+		    (size_t) DATA_XFER_LIMIT);
+		aoff64_t p = pos + io->bytes;
+		ipc_call_t reply;
+
+		aid_t msg = async_send_4(exch,
+		    read ? VFS_OUT_READ : VFS_OUT_WRITE,
+		    file->node->service_id, file->node->index, LOWER32(p),
+		    UPPER32(p), &reply);
+		if (msg == 0) {
+			rc = EINVAL;
+			break;
+		}
+
+		uint8_t *dst = buf + io->bytes;
+		if (read)
+			rc = async_data_read_start(exch, dst, chunk);
+		else
+			rc = async_data_write_start(exch, dst, chunk);
+		if (rc != EOK) {
+			async_forget(msg);
+			break;
+		}
+
+		async_wait_for(msg, &rc);
+		if (rc != EOK)
+			break;
+
+		size_t n = ipc_get_arg1(&reply);
+		io->bytes += n;
+		*answer = reply;
+		ipc_set_arg1(answer, io->bytes);
+
+		if (n < chunk)
+			break;
+	}
+
+	/* Report partial success so that the caller keeps the data. */
+	return io->bytes > 0 ? EOK : rc;
+}
+
 static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
     void *ipc_cb_data)
 {
@@ -480,6 +592,22 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 
 	vfs_exchange_release(fs_exch);
 
+	/* Drop cached pages of the file which are now stale. */
+	if (!read && file->node->type == VFS_NODE_FILE) {
+		vfs_triplet_t triplet = {
+			.fs_handle = file->node->fs_handle,
+			.service_id = file->node->service_id,
+			.index = file->node->index
+		};
+
+		if (rc == EOK) {
+			vfs_cache_invalidate(&triplet, pos,
+			    pos + ipc_get_arg1(&answer));
+		} else {
+			vfs_cache_invalidate(&triplet, 0, UINT64_MAX);
+		}
+	}
+
 	if (file->node->type == VFS_NODE_DIRECTORY)
 		fibril_rwlock_read_unlock(&namespace_rwlock);
 
@@ -510,6 +638,16 @@ errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
 	return vfs_rdwr(fd, pos, true, rdwr_ipc_client, out_bytes);
 }
 
+errno_t vfs_op_read_buffer(int fd, aoff64_t pos, size_t size,
+    size_t *out_bytes)
+{
+	rdwr_buffer_t io = { .size = size };
+
+	errno_t rc = vfs_rdwr(fd, pos, true, rdwr_ipc_buffer, &io);
+	*out_bytes = io.bytes;
+	return rc;
+}
+
 errno_t vfs_op_rename(int basefd, char *old, char *new)
 {
 	vfs_file_t *base_file = vfs_file_get(basefd);
@@ -599,11 +737,15 @@ errno_t vfs_op_rename(int basefd, char *old, char *new)
 
 	/* If the node is not held by anyone, try to destroy it. */
 	if (orig_unlinked) {
+		vfs_cache_invalidate(&new_lr_orig.triplet, 0, UINT64_MAX);
+
 		vfs_node_t *node = vfs_node_peek(&new_lr_orig);
-		if (!node)
+		if (!node) {
 			out_destroy(&new_lr_orig.triplet);
-		else
+		} else {
+			node->unlinked = true;
 			vfs_node_put(node);
+		}
 	}
 
 	vfs_node_put(base);
@@ -629,6 +771,14 @@ errno_t vfs_op_resize(int fd, int64_t size)
 	if (rc == EOK)
 		file->node->size = size;
 
+	vfs_triplet_t triplet = {
+		.fs_handle = file->node->fs_handle,
+		.service_id = file->node->service_id,
+		.index = file->node->index
+	};
+	vfs_cache_invalidate(&triplet, rc == EOK ? (aoff64_t) size : 0,
+	    UINT64_MAX);
+
 	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	vfs_file_put(file);
 	return rc;
@@ -766,12 +916,17 @@ errno_t vfs_op_unlink(int parentfd, int expectfd, char *path)
 	if (rc != EOK)
 		goto exit;
 
+	/* The file system may reuse the index once the node is destroyed. */
+	vfs_cache_invalidate(&lr.triplet, 0, UINT64_MAX);
+
 	/* If the node is not held by anyone, try to destroy it. */
 	vfs_node_t *node = vfs_node_peek(&lr);
-	if (!node)
+	if (!node) {
 		out_destroy(&lr.triplet);
-	else
+	} else {
+		node->unlinked = true;
 		vfs_node_put(node);
+	}
 
 exit:
 	if (path)
@@ -822,6 +977,11 @@ errno_t vfs_op_unmount(int mpfd)
 		return rc;
 	}
 
+	vfs_cache_invalidate_fs(mp->node->mount->fs_handle,
+	    mp->node->mount->service_id);
+	vfs_lookup_cache_invalidate_fs(mp->node->mount->fs_handle,
+	    mp->node->mount->service_id);
+
 	vfs_node_forget(mp->node->mount);
 	vfs_node_put(mp->node);
 	mp->node->mount = NULL;
@@ -923,6 +1083,16 @@ errno_t vfs_op_write(int fd, aoff64_t pos, size_t *out_bytes)
 	return vfs_rdwr(fd, pos, false, rdwr_ipc_client, out_bytes);
 }
 
+errno_t vfs_op_write_buffer(int fd, aoff64_t pos, size_t size,
+    size_t *out_bytes)
+{
+	rdwr_buffer_t io = { .size = size };
+
+	errno_t rc = vfs_rdwr(fd, pos, false, rdwr_ipc_buffer, &io);
+	*out_bytes = io.bytes;
+	return rc;
+}
+
 /**
  * @}
  */
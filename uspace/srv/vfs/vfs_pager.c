@@ -39,16 +39,200 @@
 #include <async.h>
 #include <fibril_synch.h>
 #include <errno.h>
+#include <align.h>
 #include <as.h>
+#include <mem.h>
+#include <libarch/config.h>
+#include <stdlib.h>
+
+/** A page mapped into a client by a writable shared mapping. */
+typedef struct {
+	/** Link in the client's list of pins */
+	link_t link;
+	/** File handle the client mapped the page through */
+	int fd;
+	/** The file, referenced by the pin */
+	vfs_node_t *node;
+	/** The page, pinned in the page cache */
+	vfs_cache_page_t *page;
+} vfs_pager_pin_t;
+
+/** Mutex protecting the clients' lists of pins. */
+static FIBRIL_MUTEX_INITIALIZE(pins_mutex);
+
+/** Pin a page for the current client.
+ *
+ * @param fd		File handle the page is mapped through.
+ * @param node		The file.
+ * @param page		The page, held by the caller.
+ *
+ * @return		EOK on success, ENOMEM if out of memory.
+ */
+static errno_t vfs_pager_pin(int fd, vfs_node_t *node, vfs_cache_page_t *page)
+{
+	vfs_pager_pin_t *pin = malloc(sizeof(vfs_pager_pin_t));
+	if (pin == NULL)
+		return ENOMEM;
+
+	link_initialize(&pin->link);
+	pin->fd = fd;
+	pin->node = node;
+	pin->page = page;
+
+	vfs_node_addref(node);
+	vfs_cache_page_pin(page);
+
+	fibril_mutex_lock(&pins_mutex);
+	list_append(&pin->link, vfs_client_pins());
+	fibril_mutex_unlock(&pins_mutex);
+
+	return EOK;
+}
+
+/** Write a pinned page back to its file.
+ *
+ * @param pin		Pin of the page.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t vfs_pager_pin_write(vfs_pager_pin_t *pin)
+{
+	vfs_node_t *node = pin->node;
+
+	fibril_rwlock_write_lock(&node->contents_rwlock);
+	async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
+	errno_t rc = vfs_cache_page_write(exch, node, pin->page);
+	vfs_exchange_release(exch);
+	fibril_rwlock_write_unlock(&node->contents_rwlock);
+
+	return rc;
+}
+
+/** Drop a pin, which must not be on any list. */
+static void vfs_pager_pin_destroy(vfs_pager_pin_t *pin)
+{
+	vfs_cache_page_unpin(pin->page);
+	vfs_node_delref(pin->node);
+	free(pin);
+}
+
+/** Serve a page-in request from the page cache.
+ *
+ * @param req		Page-in request.
+ * @param fd		File handle backing the area.
+ * @param offset	Page-aligned offset of the page within the file.
+ * @param flags		Pager flags of the area.
+ *
+ * @return		False if the file cannot be cached and the request
+ *			was not answered.
+ */
+static bool vfs_page_in_cached(ipc_call_t *req, int fd, aoff64_t offset,
+    sysarg_t flags)
+{
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file) {
+		async_answer_0(req, EBADF);
+		return true;
+	}
+
+	vfs_node_t *node = file->node;
+	if (!vfs_cache_node_cacheable(node)) {
+		vfs_file_put(file);
+		return false;
+	}
+
+	if (!file->open_read) {
+		vfs_file_put(file);
+		async_answer_0(req, EINVAL);
+		return true;
+	}
+
+	if ((flags & VFS_PAGER_WRITEBACK) && !file->open_write) {
+		vfs_file_put(file);
+		async_answer_0(req, EACCES);
+		return true;
+	}
+
+	vfs_cache_page_t *page;
+	fibril_rwlock_read_lock(&node->contents_rwlock);
+	async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
+	errno_t rc = vfs_cache_page_get(exch, node, offset, &page);
+	vfs_exchange_release(exch);
+	fibril_rwlock_read_unlock(&node->contents_rwlock);
+
+	if (rc == EOK && (flags & VFS_PAGER_WRITEBACK)) {
+		rc = vfs_pager_pin(fd, node, page);
+		if (rc != EOK)
+			vfs_cache_page_put(page);
+	}
+
+	vfs_file_put(file);
+
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return true;
+	}
+
+	if (flags & VFS_PAGER_WRITEBACK) {
+		/*
+		 * The client writes right into the cached frame. The kernel
+		 * reports the modified pages with IPC_M_PAGE_OUT and the
+		 * unmapped ones with IPC_M_PAGE_RELEASE.
+		 */
+		async_answer_2(req, EOK, (sysarg_t) page->data,
+		    AS_PAGER_WRITEBACK);
+		vfs_cache_page_put(page);
+		return true;
+	}
+
+	if (flags & VFS_PAGER_SHARED) {
+		/*
+		 * The kernel takes its own reference to the frame while
+		 * processing the answer, so the client keeps its mapping even
+		 * after the page leaves the cache.
+		 */
+		async_answer_1(req, EOK, (sysarg_t) page->data);
+		vfs_cache_page_put(page);
+		return true;
+	}
+
+	void *copy = as_area_create(AS_AREA_ANY, PAGE_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_UNPAGED);
+	if (copy == AS_MAP_FAILED) {
+		vfs_cache_page_put(page);
+		async_answer_0(req, ENOMEM);
+		return true;
+	}
+
+	memcpy(copy, page->data, page->valid);
+	vfs_cache_page_put(page);
+
+	async_answer_1(req, EOK, (sysarg_t) copy);
+	as_area_destroy(copy);
+	return true;
+}
 
 void vfs_page_in(ipc_call_t *req)
 {
-	aoff64_t offset = ipc_get_arg1(req);
+	aoff64_t offset = ipc_get_arg1(req) + ipc_get_arg5(req);
 	size_t page_size = ipc_get_arg2(req);
 	int fd = ipc_get_arg3(req);
+	sysarg_t flags = ipc_get_arg4(req);
 	void *page;
 	errno_t rc;
 
+	bool cacheable = page_size == PAGE_SIZE &&
+	    ALIGN_DOWN(offset, PAGE_SIZE) == offset;
+	if (cacheable && vfs_page_in_cached(req, fd, offset, flags))
+		return;
+
+	/* Private copies cannot be written back. */
+	if (flags & VFS_PAGER_WRITEBACK) {
+		async_answer_0(req, ENOTSUP);
+		return;
+	}
+
 	page = as_area_create(AS_AREA_ANY, page_size,
 	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
 	    AS_AREA_UNPAGED);
@@ -80,14 +264,100 @@ void vfs_page_in(ipc_call_t *req)
 	async_answer_1(req, rc, (sysarg_t) page);
 
 	/*
-	 * FIXME:
-	 * This is just for now until we implement proper page cache
-	 * management.  Not keeping the pages around in a cache results in
-	 * inherently non-coherent private mappings.
+	 * Files which cannot be cached are paged in through a private copy
+	 * which is not kept around. This results in inherently non-coherent
+	 * private mappings.
 	 */
 	as_area_destroy(page);
 }
 
+/** Check whether a pin belongs to a range of a pager request. */
+static bool vfs_pager_pin_match(vfs_pager_pin_t *pin, int fd, aoff64_t start,
+    aoff64_t end)
+{
+	return pin->fd == fd && pin->page->key.offset >= start &&
+	    pin->page->key.offset < end;
+}
+
+/** Write back pages modified through a writable shared mapping.
+ *
+ * The pages are looked up among the pins of the client, so the file handle
+ * need not be open anymore.
+ *
+ * @param req		Page-out request.
+ */
+void vfs_page_out(ipc_call_t *req)
+{
+	aoff64_t start = ipc_get_arg1(req) + ipc_get_arg5(req);
+	aoff64_t end = start + ipc_get_arg2(req);
+	int fd = ipc_get_arg3(req);
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&pins_mutex);
+
+	list_foreach(*vfs_client_pins(), link, vfs_pager_pin_t, pin) {
+		if (!vfs_pager_pin_match(pin, fd, start, end))
+			continue;
+
+		errno_t rc2 = vfs_pager_pin_write(pin);
+		if (rc == EOK)
+			rc = rc2;
+	}
+
+	fibril_mutex_unlock(&pins_mutex);
+
+	async_answer_0(req, rc);
+}
+
+/** Unpin pages no longer mapped by a writable shared mapping.
+ *
+ * @param req		Page release request.
+ */
+void vfs_page_release(ipc_call_t *req)
+{
+	aoff64_t start = ipc_get_arg1(req) + ipc_get_arg5(req);
+	aoff64_t end = start + ipc_get_arg2(req);
+	int fd = ipc_get_arg3(req);
+
+	fibril_mutex_lock(&pins_mutex);
+
+	/* Each page was pinned once per mapping of it. */
+	for (aoff64_t offset = start; offset < end; offset += PAGE_SIZE) {
+		list_foreach(*vfs_client_pins(), link, vfs_pager_pin_t, pin) {
+			if (vfs_pager_pin_match(pin, fd, offset,
+			    offset + PAGE_SIZE)) {
+				list_remove(&pin->link);
+				vfs_pager_pin_destroy(pin);
+				break;
+			}
+		}
+	}
+
+	fibril_mutex_unlock(&pins_mutex);
+
+	async_answer_0(req, EOK);
+}
+
+/** Write back and unpin all pages mapped by a client.
+ *
+ * Called when the client goes away without having destroyed its mappings.
+ * Not knowing which pages were modified, all of them are written back.
+ *
+ * @param pins		The client's list of pins.
+ */
+void vfs_pager_pins_release(list_t *pins)
+{
+	fibril_mutex_lock(&pins_mutex);
+
+	while (!list_empty(pins)) {
+		vfs_pager_pin_t *pin = list_pop(pins, vfs_pager_pin_t, link);
+		(void) vfs_pager_pin_write(pin);
+		vfs_pager_pin_destroy(pin);
+	}
+
+	fibril_mutex_unlock(&pins_mutex);
+}
+
 /**
  * @}
  */
@@ -36,9 +36,12 @@
 
 #include <adt/list.h>
 #include <errno.h>
+#include <fibril.h>
 #include <fibril_synch.h>
+#include <io/klog.h>
 #include <io/log.h>
 #include <loc.h>
+#include <macros.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <str.h>
@@ -49,9 +52,34 @@
 #include "empty.h"
 #include "mkfs.h"
 #include "part.h"
+#include "probe.h"
 #include "types/part.h"
 #include "volume.h"
 
+/** Maximum number of partitions probed at the same time */
+#define VOL_PROBE_WORKERS 4
+
+/** New partitions being probed by worker fibrils */
+typedef struct {
+	/** Partitions */
+	vol_parts_t *parts;
+	/** Service IDs of the new partitions */
+	service_id_t *sids;
+	/** Set up partitions, @c NULL where setting up failed */
+	vol_part_t **newp;
+	/** Number of new partitions */
+	size_t count;
+	/** Index of the next partition to set up */
+	size_t next;
+	/** Number of workers still running */
+	unsigned workers;
+	/** Protects @c next and @c workers */
+	fibril_mutex_t lock;
+	/** Signalled when @c workers drops to zero */
+	fibril_condvar_t done_cv;
+} vol_probe_batch_t;
+
+static errno_t vol_part_setup(vol_parts_t *, service_id_t, vol_part_t **);
 static errno_t vol_part_add_locked(vol_parts_t *, service_id_t);
 static void vol_part_remove_locked(vol_part_t *);
 static errno_t vol_part_find_by_id_ref_locked(vol_parts_t *, service_id_t,
@@ -71,6 +99,25 @@ static struct fsname_type fstab[] = {
 	{ NULL, 0 }
 };
 
+/** Find file system type by name.
+ *
+ * @param name File system name
+ * @return Entry of @c fstab or @c NULL if there is no such file system
+ */
+static struct fsname_type *fstab_find(const char *name)
+{
+	struct fsname_type *fst;
+
+	fst = &fstab[0];
+	while (fst->name != NULL) {
+		if (str_cmp(fst->name, name) == 0)
+			return fst;
+		++fst;
+	}
+
+	return NULL;
+}
+
 static const char *fstype_str(vol_fstype_t fstype)
 {
 	struct fsname_type *fst;
@@ -86,6 +133,110 @@ static const char *fstype_str(vol_fstype_t fstype)
 	return NULL;
 }
 
+/** Worker fibril setting up new partitions.
+ *
+ * @param arg Batch of new partitions
+ * @return EOK
+ */
+static errno_t vol_part_probe_worker(void *arg)
+{
+	vol_probe_batch_t *batch = (vol_probe_batch_t *) arg;
+	size_t i;
+	errno_t rc;
+
+	fibril_mutex_lock(&batch->lock);
+	while (batch->next < batch->count) {
+		i = batch->next++;
+		fibril_mutex_unlock(&batch->lock);
+
+		rc = vol_part_setup(batch->parts, batch->sids[i],
+		    &batch->newp[i]);
+		if (rc != EOK) {
+			log_msg(LOG_DEFAULT, LVL_ERROR, "Could not add "
+			    "partition.");
+			batch->newp[i] = NULL;
+		}
+
+		fibril_mutex_lock(&batch->lock);
+	}
+
+	if (--batch->workers == 0)
+		fibril_condvar_broadcast(&batch->done_cv);
+	fibril_mutex_unlock(&batch->lock);
+	return EOK;
+}
+
+/** Set up new partitions and add them to the list of partitions.
+ *
+ * The partitions are probed and mounted by up to VOL_PROBE_WORKERS fibrils
+ * at the same time, so that a slow device does not hold up the others.
+ *
+ * @param parts Partitions, locked
+ * @param sids Service IDs of the new partitions
+ * @param count Number of new partitions
+ */
+static void vol_part_add_batch_locked(vol_parts_t *parts, service_id_t *sids,
+    size_t count)
+{
+	vol_probe_batch_t batch;
+	unsigned nworkers;
+	fid_t fid;
+	size_t i;
+
+	assert(fibril_mutex_is_locked(&parts->lock));
+
+	batch.parts = parts;
+	batch.sids = sids;
+	batch.newp = calloc(count, sizeof(vol_part_t *));
+	batch.count = count;
+	batch.next = 0;
+	fibril_mutex_initialize(&batch.lock);
+	fibril_condvar_initialize(&batch.done_cv);
+
+	if (batch.newp == NULL) {
+		/* Fall back to adding the partitions one by one. */
+		for (i = 0; i < count; i++) {
+			if (vol_part_add_locked(parts, sids[i]) != EOK) {
+				log_msg(LOG_DEFAULT, LVL_ERROR, "Could not "
+				    "add partition.");
+			}
+		}
+		return;
+	}
+
+	/* This fibril is one of the workers. */
+	nworkers = min(count, VOL_PROBE_WORKERS);
+	batch.workers = 1;
+	for (i = 1; i < nworkers; i++) {
+		fid = fibril_create(vol_part_probe_worker, &batch);
+		if (fid == 0)
+			break;
+
+		fibril_mutex_lock(&batch.lock);
+		batch.workers++;
+		fibril_mutex_unlock(&batch.lock);
+		fibril_add_ready(fid);
+	}
+
+	(void) vol_part_probe_worker(&batch);
+
+	fibril_mutex_lock(&batch.lock);
+	while (batch.workers > 0)
+		fibril_condvar_wait(&batch.done_cv, &batch.lock);
+	fibril_mutex_unlock(&batch.lock);
+
+	for (i = 0; i < count; i++) {
+		if (batch.newp[i] == NULL)
+			continue;
+
+		list_append(&batch.newp[i]->lparts, &parts->parts);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Added partition %zu",
+		    batch.newp[i]->svc_id);
+	}
+
+	free(batch.newp);
+}
+
 /** Check for new and removed partitions */
 static errno_t vol_part_check_new(vol_parts_t *parts)
 {
@@ -93,7 +244,8 @@ static errno_t vol_part_check_new(vol_parts_t *parts)
 	bool still_exists;
 	category_id_t part_cat;
 	service_id_t *svcs;
-	size_t count, i;
+	service_id_t *new_svcs;
+	size_t count, new_count, i;
 	link_t *cur, *next;
 	vol_part_t *part;
 	errno_t rc;
@@ -115,7 +267,15 @@ static errno_t vol_part_check_new(vol_parts_t *parts)
 		return EIO;
 	}
 
+	new_svcs = calloc(count, sizeof(service_id_t));
+	if (new_svcs == NULL) {
+		free(svcs);
+		fibril_mutex_unlock(&parts->lock);
+		return ENOMEM;
+	}
+
 	/* Check for new partitions */
+	new_count = 0;
 	for (i = 0; i < count; i++) {
 		already_known = false;
 
@@ -130,14 +290,14 @@ static errno_t vol_part_check_new(vol_parts_t *parts)
 		if (!already_known) {
 			log_msg(LOG_DEFAULT, LVL_DEBUG, "Found partition '%lu'",
 			    (unsigned long) svcs[i]);
-			rc = vol_part_add_locked(parts, svcs[i]);
-			if (rc != EOK) {
-				log_msg(LOG_DEFAULT, LVL_ERROR, "Could not add "
-				    "partition.");
-			}
+			new_svcs[new_count++] = svcs[i];
 		}
 	}
 
+	if (new_count > 0)
+		vol_part_add_batch_locked(parts, new_svcs, new_count);
+	free(new_svcs);
+
 	/* Check for removed partitions */
 	cur = list_first(&parts->parts);
 	while (cur != NULL) {
@@ -200,36 +360,119 @@ static void vol_part_delete(vol_part_t *part)
 	free(part);
 }
 
-static errno_t vol_part_probe(vol_part_t *part)
+/** Find the file system on a partition.
+ *
+ * The start of the partition is read once. Unless the result of probing
+ * the same contents is cached, only the file systems whose signatures
+ * are found there are asked to probe the partition.
+ *
+ * @param part Partition
+ * @param rfst Place to store file system type or @c NULL if none was found
+ * @param rlabel Place to store newly allocated volume label
+ *
+ * @return EOK on success, ENOMEM if out of memory
+ */
+static errno_t vol_part_probe_fs(vol_part_t *part, struct fsname_type **rfst,
+    char **rlabel)
 {
-	bool empty;
 	vfs_fs_probe_info_t info;
 	struct fsname_type *fst;
+	char key[VOL_PROBE_KEY_SIZE];
+	char *fsname;
 	char *label;
-	vol_volume_t *volume;
+	bool nofs;
+	void *head;
+	size_t hsize;
 	errno_t rc;
 
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "Probe partition %s", part->svc_name);
+	rc = volsrv_part_head_read(part->svc_id, &head, &hsize);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_WARN, "Failed reading start of "
+		    "partition %s, probing all file systems.", part->svc_name);
+		head = NULL;
+	}
 
-	assert(fibril_mutex_is_locked(&part->parts->lock));
+	if (head != NULL) {
+		volsrv_probe_key(head, hsize, key);
+		rc = vol_probe_cache_lookup(part->parts->volumes, key, &fsname,
+		    &label);
+		if (rc == ENOMEM) {
+			free(head);
+			return ENOMEM;
+		}
+
+		if (rc == EOK) {
+			fst = fstab_find(fsname);
+			nofs = *fsname == '\0';
+			free(fsname);
+			if (fst != NULL || nofs) {
+				log_msg(LOG_DEFAULT, LVL_DEBUG, "Using cached "
+				    "probe result for %s", part->svc_name);
+				free(head);
+				*rfst = fst;
+				*rlabel = label;
+				return EOK;
+			}
+
+			/* File system no longer supported, probe again. */
+			free(label);
+		}
+	}
 
 	fst = &fstab[0];
 	while (fst->name != NULL) {
-		rc = vfs_fsprobe(fst->name, part->svc_id, &info);
-		if (rc == EOK)
-			break;
+		if (head == NULL ||
+		    volsrv_fs_sig_match(fst->fstype, head, hsize)) {
+			rc = vfs_fsprobe(fst->name, part->svc_id, &info);
+			if (rc == EOK)
+				break;
+		}
 		++fst;
 	}
 
-	if (fst->name != NULL) {
-		log_msg(LOG_DEFAULT, LVL_DEBUG, "Found %s, label '%s'",
-		    fst->name, info.label);
-		label = str_dup(info.label);
-		if (label == NULL) {
-			rc = ENOMEM;
-			goto error;
+	label = str_dup(fst->name != NULL ? info.label : "");
+	if (label == NULL) {
+		free(head);
+		return ENOMEM;
+	}
+
+	if (head != NULL) {
+		rc = vol_probe_cache_store(part->parts->volumes, key,
+		    fst->name != NULL ? fst->name : "", label,
+		    fst->name != NULL ? info.vuid : "");
+		if (rc != EOK) {
+			log_msg(LOG_DEFAULT, LVL_WARN, "Failed caching probe "
+			    "result: %s", str_error(rc));
 		}
 
+		free(head);
+	}
+
+	*rfst = fst->name != NULL ? fst : NULL;
+	*rlabel = label;
+	return EOK;
+}
+
+static errno_t vol_part_probe(vol_part_t *part)
+{
+	bool empty;
+	struct fsname_type *fst;
+	char *label;
+	vol_volume_t *volume;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Probe partition %s", part->svc_name);
+
+	assert(fibril_mutex_is_locked(&part->parts->lock));
+
+	rc = vol_part_probe_fs(part, &fst, &label);
+	if (rc != EOK)
+		goto error;
+
+	if (fst != NULL) {
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "Found %s, label '%s'",
+		    fst->name, label);
+
 		part->pcnt = vpc_fs;
 		part->fstype = fst->fstype;
 		part->label = label;
@@ -241,16 +484,11 @@ static errno_t vol_part_probe(vol_part_t *part)
 		if (rc != EOK) {
 			log_msg(LOG_DEFAULT, LVL_ERROR, "Failed determining if "
 			    "partition is empty.");
+			free(label);
 			rc = EIO;
 			goto error;
 		}
 
-		label = str_dup("");
-		if (label == NULL) {
-			rc = ENOMEM;
-			goto error;
-		}
-
 		part->pcnt = empty ? vpc_empty : vpc_unknown;
 		part->label = label;
 	}
@@ -389,8 +627,10 @@ static errno_t vol_part_mount(vol_part_t *part)
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Call vfs_mount_path mp='%s' fstype='%s' svc_name='%s'",
 	    mp, fstype_str(part->fstype), part->svc_name);
+	klog_bootmark("start mount %s", mp);
 	rc = vfs_mount_path(mp, fstype_str(part->fstype),
 	    part->svc_name, "", 0, 0);
+	klog_bootmark("done mount %s", mp);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_ERROR, "Failed mounting %s at %s to %s",
 		    fstype_str(part->fstype), part->svc_name, mp);
@@ -405,22 +645,25 @@ static errno_t vol_part_mount(vol_part_t *part)
 	return rc;
 }
 
-static errno_t vol_part_add_locked(vol_parts_t *parts, service_id_t sid)
+/** Create, probe and mount a new partition.
+ *
+ * The partition is not added to the list of partitions. Several partitions
+ * can be set up at the same time on behalf of the holder of the partitions
+ * lock.
+ *
+ * @param parts Partitions, locked
+ * @param sid Service ID of the partition
+ * @param rpart Place to store pointer to the new partition
+ *
+ * @return EOK on success or an error code
+ */
+static errno_t vol_part_setup(vol_parts_t *parts, service_id_t sid,
+    vol_part_t **rpart)
 {
 	vol_part_t *part;
 	errno_t rc;
 
 	assert(fibril_mutex_is_locked(&parts->lock));
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "vol_part_add_locked(%zu)", sid);
-
-	/* Check for duplicates */
-	rc = vol_part_find_by_id_ref_locked(parts, sid, &part);
-	if (rc == EOK) {
-		vol_part_del_ref(part);
-		return EEXIST;
-	}
-
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "partition %zu is new", sid);
 
 	part = vol_part_new();
 	if (part == NULL)
@@ -443,10 +686,7 @@ static errno_t vol_part_add_locked(vol_parts_t *parts, service_id_t sid)
 	if (rc != EOK)
 		goto error;
 
-	list_append(&part->lparts, &parts->parts);
-
-	log_msg(LOG_DEFAULT, LVL_DEBUG, "Added partition %zu", part->svc_id);
-
+	*rpart = part;
 	return EOK;
 
 error:
@@ -454,6 +694,34 @@ error:
 	return rc;
 }
 
+static errno_t vol_part_add_locked(vol_parts_t *parts, service_id_t sid)
+{
+	vol_part_t *part;
+	errno_t rc;
+
+	assert(fibril_mutex_is_locked(&parts->lock));
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "vol_part_add_locked(%zu)", sid);
+
+	/* Check for duplicates */
+	rc = vol_part_find_by_id_ref_locked(parts, sid, &part);
+	if (rc == EOK) {
+		vol_part_del_ref(part);
+		return EEXIST;
+	}
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "partition %zu is new", sid);
+
+	rc = vol_part_setup(parts, sid, &part);
+	if (rc != EOK)
+		return rc;
+
+	list_append(&part->lparts, &parts->parts);
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "Added partition %zu", part->svc_id);
+
+	return EOK;
+}
+
 static void vol_part_remove_locked(vol_part_t *part)
 {
 	assert(fibril_mutex_is_locked(&part->parts->lock));
@@ -520,6 +788,9 @@ errno_t vol_part_discovery_start(vol_parts_t *parts)
 		return rc;
 	}
 
+	/* Every rescan resolves the same names again */
+	(void) loc_cache_enable();
+
 	return vol_part_check_new(parts);
 }
 
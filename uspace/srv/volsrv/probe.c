@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup volsrv
+ * @{
+ */
+/**
+ * @file Partition probing helpers
+ * @brief
+ *
+ * The start of a partition is read once and used to rule out the file
+ * systems whose signatures are missing, so that only the remaining ones
+ * need to be asked to probe it. The checks only rule out, a match does not
+ * mean the file system is really there.
+ */
+
+#include <block.h>
+#include <byteorder.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <io/log.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "probe.h"
+
+/** Offset of the ext2/3/4 and MINIX superblock */
+#define SB_OFFSET 1024
+/** Offset of the ISO 9660 volume descriptor set */
+#define ISO_VD_OFFSET (16 * 2048)
+
+/** Get a little-endian 16-bit value from the start of a partition. */
+static uint16_t head_u16(const uint8_t *head, size_t offset)
+{
+	return head[offset] | (head[offset + 1] << 8);
+}
+
+/** Read the start of a partition.
+ *
+ * @param sid Service ID of the partition
+ * @param rbuf Place to store pointer to newly allocated buffer
+ * @param rsize Place to store number of bytes read, at most
+ *              VOL_PROBE_HEAD_SIZE
+ *
+ * @return EOK on success or an error code
+ */
+errno_t volsrv_part_head_read(service_id_t sid, void **rbuf, size_t *rsize)
+{
+	aoff64_t nblocks;
+	size_t bsize;
+	size_t size;
+	void *buf;
+	errno_t rc;
+
+	rc = block_init(sid, 2048);
+	if (rc != EOK) {
+		log_msg(LOG_DEFAULT, LVL_ERROR, "Error opening "
+		    "block device service %zu", sid);
+		return EIO;
+	}
+
+	rc = block_get_bsize(sid, &bsize);
+	if (rc == EOK)
+		rc = block_get_nblocks(sid, &nblocks);
+	if (rc != EOK)
+		goto error;
+
+	size = VOL_PROBE_HEAD_SIZE;
+	if (nblocks < size / bsize)
+		size = nblocks * bsize;
+
+	buf = malloc(max(size, 1));
+	if (buf == NULL) {
+		rc = ENOMEM;
+		goto error;
+	}
+
+	rc = block_read_bytes_direct(sid, 0, size, buf);
+	if (rc != EOK) {
+		free(buf);
+		goto error;
+	}
+
+	block_fini(sid);
+	*rbuf = buf;
+	*rsize = size;
+	return EOK;
+error:
+	block_fini(sid);
+	return rc;
+}
+
+/** Check whether a MINIX file system magic number is valid.
+ *
+ * Both byte orders are accepted like the file system server does.
+ */
+static bool mfs_magic_match(uint16_t magic)
+{
+	static const uint16_t magics[] = {
+		0x137f, 0x138f, 0x2468, 0x2478, 0x4d5a
+	};
+
+	for (size_t i = 0; i < sizeof(magics) / sizeof(magics[0]); i++) {
+		if (magic == magics[i] || magic == uint16_t_byteorder_swap(
+		    magics[i]))
+			return true;
+	}
+
+	return false;
+}
+
+/** Determine whether a partition may contain a file system.
+ *
+ * @param fstype File system type
+ * @param buf Start of the partition
+ * @param size Number of bytes in @a buf
+ *
+ * @return @c false if the file system is certainly not there
+ */
+bool volsrv_fs_sig_match(vol_fstype_t fstype, const void *buf, size_t size)
+{
+	const uint8_t *head = (const uint8_t *) buf;
+
+	switch (fstype) {
+	case fs_ext4:
+		/* s_magic of the superblock */
+		return size >= SB_OFFSET + 58 &&
+		    head_u16(head, SB_OFFSET + 56) == 0xef53;
+	case fs_minix:
+		/* s_magic of the V1/V2 or the V3 superblock */
+		return size >= SB_OFFSET + 26 &&
+		    (mfs_magic_match(head_u16(head, SB_OFFSET + 16)) ||
+		    mfs_magic_match(head_u16(head, SB_OFFSET + 24)));
+	case fs_exfat:
+		/* OEM name of the boot sector */
+		return size >= 11 && memcmp(head + 3, "EXFAT   ", 8) == 0;
+	case fs_fat:
+		/* Number of FATs and media descriptor of the boot sector */
+		return size >= 22 && memcmp(head + 3, "EXFAT   ", 8) != 0 &&
+		    head[16] != 0 && (head[21] & 0xf0) == 0xf0;
+	case fs_cdfs:
+		/* Standard identifier of the first volume descriptor */
+		return size >= ISO_VD_OFFSET + 6 &&
+		    memcmp(head + ISO_VD_OFFSET + 1, "CD001", 5) == 0;
+	}
+
+	return true;
+}
+
+/** Compute the probe key of a partition.
+ *
+ * The key identifies the contents read for probing, a partition with the
+ * same key is sure to probe the same. It is the 64-bit FNV-1a hash of the
+ * contents followed by their size.
+ *
+ * @param buf Start of the partition
+ * @param size Number of bytes in @a buf
+ * @param key Buffer of VOL_PROBE_KEY_SIZE bytes to store the key
+ */
+void volsrv_probe_key(const void *buf, size_t size, char *key)
+{
+	const uint8_t *head = (const uint8_t *) buf;
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= head[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	snprintf(key, VOL_PROBE_KEY_SIZE, "%016" PRIx64 "-%zx", hash, size);
+}
+
+/** @}
+ */
@@ -30,6 +30,7 @@
 
 PCUT_INIT;
 
+PCUT_IMPORT(probe);
 PCUT_IMPORT(volume);
 
 PCUT_MAIN();
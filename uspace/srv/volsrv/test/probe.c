@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 yfx contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <str.h>
+
+#include "../probe.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(probe);
+
+static uint8_t head[VOL_PROBE_HEAD_SIZE];
+
+/** Zeroed partition start matches no file system. */
+PCUT_TEST(sig_none)
+{
+	memset(head, 0, sizeof(head));
+
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_ext4, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_minix, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_exfat, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_fat, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_cdfs, head, sizeof(head)));
+}
+
+/** Each signature matches its own file system only. */
+PCUT_TEST(sig_match)
+{
+	memset(head, 0, sizeof(head));
+	head[1024 + 56] = 0x53;
+	head[1024 + 57] = 0xef;
+	PCUT_ASSERT_TRUE(volsrv_fs_sig_match(fs_ext4, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_minix, head, sizeof(head)));
+
+	memset(head, 0, sizeof(head));
+	head[1024 + 24] = 0x5a;
+	head[1024 + 25] = 0x4d;
+	PCUT_ASSERT_TRUE(volsrv_fs_sig_match(fs_minix, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_ext4, head, sizeof(head)));
+
+	memset(head, 0, sizeof(head));
+	memcpy(head + 3, "EXFAT   ", 8);
+	head[16] = 1;
+	head[21] = 0xf8;
+	PCUT_ASSERT_TRUE(volsrv_fs_sig_match(fs_exfat, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_fat, head, sizeof(head)));
+
+	memcpy(head + 3, "MSWIN4.1", 8);
+	PCUT_ASSERT_TRUE(volsrv_fs_sig_match(fs_fat, head, sizeof(head)));
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_exfat, head, sizeof(head)));
+
+	memset(head, 0, sizeof(head));
+	memcpy(head + 16 * 2048 + 1, "CD001", 5);
+	PCUT_ASSERT_TRUE(volsrv_fs_sig_match(fs_cdfs, head, sizeof(head)));
+}
+
+/** A partition start too short for the signature does not match. */
+PCUT_TEST(sig_short)
+{
+	memset(head, 0, sizeof(head));
+	memcpy(head + 16 * 2048 + 1, "CD001", 5);
+	PCUT_ASSERT_FALSE(volsrv_fs_sig_match(fs_cdfs, head, 16 * 2048));
+}
+
+/** Probe key depends on both contents and size. */
+PCUT_TEST(key)
+{
+	char key1[VOL_PROBE_KEY_SIZE];
+	char key2[VOL_PROBE_KEY_SIZE];
+
+	memset(head, 0, sizeof(head));
+	volsrv_probe_key(head, sizeof(head), key1);
+	volsrv_probe_key(head, sizeof(head), key2);
+	PCUT_ASSERT_STR_EQUALS(key1, key2);
+
+	volsrv_probe_key(head, sizeof(head) / 2, key2);
+	PCUT_ASSERT_TRUE(str_cmp(key1, key2) != 0);
+
+	head[100] = 1;
+	volsrv_probe_key(head, sizeof(head), key2);
+	PCUT_ASSERT_TRUE(str_cmp(key1, key2) != 0);
+}
+
+PCUT_EXPORT(probe);
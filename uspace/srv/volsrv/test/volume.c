@@ -146,4 +146,62 @@ PCUT_TEST(same_twice)
 	free(fname);
 }
 
+/** Probe results are remembered across restarts, one entry per volume. */
+PCUT_TEST(probe_cache)
+{
+	vol_volumes_t *volumes;
+	char *namebuf;
+	char *fname;
+	char *fsname;
+	char *label;
+	errno_t rc;
+	int rv;
+
+	namebuf = malloc(L_tmpnam);
+	PCUT_ASSERT_NOT_NULL(namebuf);
+
+	fname = tmpnam(namebuf);
+	PCUT_ASSERT_NOT_NULL(fname);
+
+	rc = vol_volumes_create(fname, &volumes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = vol_probe_cache_lookup(volumes, "k1", &fsname, &label);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	rc = vol_probe_cache_store(volumes, "k1", "fat", "foo", "1234");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	vol_volumes_destroy(volumes);
+
+	/* The entry survives reopening the repository */
+	rc = vol_volumes_create(fname, &volumes);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = vol_probe_cache_lookup(volumes, "k1", &fsname, &label);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_STR_EQUALS("fat", fsname);
+	PCUT_ASSERT_STR_EQUALS("foo", label);
+	free(fsname);
+	free(label);
+
+	/* New contents of the same volume replace the old entry */
+	rc = vol_probe_cache_store(volumes, "k2", "fat", "bar", "1234");
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = vol_probe_cache_lookup(volumes, "k1", &fsname, &label);
+	PCUT_ASSERT_ERRNO_VAL(ENOENT, rc);
+
+	rc = vol_probe_cache_lookup(volumes, "k2", &fsname, &label);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_STR_EQUALS("bar", label);
+	free(fsname);
+	free(label);
+
+	vol_volumes_destroy(volumes);
+	rv = remove(fname);
+	PCUT_ASSERT_INT_EQUALS(0, rv);
+	free(fname);
+}
+
 PCUT_EXPORT(volume);
@@ -70,6 +70,8 @@ typedef struct vol_volumes {
 	sif_sess_t *repo;
 	/** Volumes SIF node */
 	sif_node_t *nvolumes;
+	/** Probe cache SIF node or @c NULL if not created yet */
+	sif_node_t *nprobes;
 	/** Next ID */
 	sysarg_t next_id;
 } vol_volumes_t;
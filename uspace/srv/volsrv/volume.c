@@ -54,6 +54,9 @@
 #include "volume.h"
 #include "types/volume.h"
 
+/** Maximum number of entries in the probe cache */
+#define VOL_PROBE_CACHE_MAX 32
+
 static void vol_volume_delete(vol_volume_t *);
 static void vol_volume_add_locked(vol_volumes_t *, vol_volume_t *);
 static errno_t vol_volume_lookup_ref_locked(vol_volumes_t *, const char *,
@@ -166,6 +169,12 @@ errno_t vol_volumes_create(const char *cfg_path,
 		rc = vol_volumes_load(node, volumes);
 		if (rc != EOK)
 			goto error;
+
+		/* The probe cache follows, if it was ever created. */
+		node = sif_node_next_child(node);
+		if (node != NULL &&
+		    str_cmp(sif_node_get_type(node), "probes") == 0)
+			volumes->nprobes = node;
 	}
 
 	volumes->repo = repo;
@@ -578,6 +587,160 @@ error:
 	return rc;
 }
 
+/** Look up the cached result of probing a partition.
+ *
+ * Probe results are remembered across restarts, so that partitions which
+ * have not changed need not be probed by every file system again.
+ *
+ * @param volumes Volumes object
+ * @param key Fingerprint of the partition contents read for probing
+ * @param rfsname Place to store newly allocated file system name
+ * @param rlabel Place to store newly allocated volume label
+ *
+ * @return EOK on success, ENOENT if there is no such entry, ENOMEM if
+ *         out of memory
+ */
+errno_t vol_probe_cache_lookup(vol_volumes_t *volumes, const char *key,
+    char **rfsname, char **rlabel)
+{
+	sif_node_t *nprobe;
+	const char *attr;
+	char *fsname;
+	char *label;
+
+	fibril_mutex_lock(&volumes->lock);
+
+	nprobe = volumes->nprobes != NULL ?
+	    sif_node_first_child(volumes->nprobes) : NULL;
+	while (nprobe != NULL) {
+		attr = sif_node_get_attr(nprobe, "key");
+		if (attr != NULL && str_cmp(attr, key) == 0)
+			break;
+		nprobe = sif_node_next_child(nprobe);
+	}
+
+	if (nprobe == NULL) {
+		fibril_mutex_unlock(&volumes->lock);
+		return ENOENT;
+	}
+
+	attr = sif_node_get_attr(nprobe, "fs");
+	fsname = str_dup(attr != NULL ? attr : "");
+	attr = sif_node_get_attr(nprobe, "label");
+	label = str_dup(attr != NULL ? attr : "");
+
+	fibril_mutex_unlock(&volumes->lock);
+
+	if (fsname == NULL || label == NULL) {
+		free(fsname);
+		free(label);
+		return ENOMEM;
+	}
+
+	*rfsname = fsname;
+	*rlabel = label;
+	return EOK;
+}
+
+/** Remember the result of probing a partition.
+ *
+ * There is at most one entry per volume UUID, an entry for a volume
+ * which has changed since it was last probed is replaced. The oldest
+ * entries are dropped once the cache is full.
+ *
+ * @param volumes Volumes object
+ * @param key Fingerprint of the partition contents read for probing
+ * @param fsname File system name
+ * @param label Volume label
+ * @param vuid Volume UUID or empty string if the file system has none
+ *
+ * @return EOK on success or an error code
+ */
+errno_t vol_probe_cache_store(vol_volumes_t *volumes, const char *key,
+    const char *fsname, const char *label, const char *vuid)
+{
+	sif_trans_t *trans = NULL;
+	sif_node_t *nprobes;
+	sif_node_t *nprobe;
+	sif_node_t *next;
+	const char *attr;
+	size_t count = 0;
+	errno_t rc;
+
+	fibril_mutex_lock(&volumes->lock);
+
+	rc = sif_trans_begin(volumes->repo, &trans);
+	if (rc != EOK)
+		goto error;
+
+	nprobes = volumes->nprobes;
+	if (nprobes == NULL) {
+		rc = sif_node_insert_after(trans, volumes->nvolumes, "probes",
+		    &nprobes);
+		if (rc != EOK)
+			goto error;
+
+		/* Aborting the transaction does not remove the node. */
+		volumes->nprobes = nprobes;
+	}
+
+	/* Drop stale entries for the same contents or the same volume. */
+	nprobe = sif_node_first_child(nprobes);
+	while (nprobe != NULL) {
+		next = sif_node_next_child(nprobe);
+
+		attr = sif_node_get_attr(nprobe, "key");
+		if (attr != NULL && str_cmp(attr, key) == 0) {
+			sif_node_destroy(trans, nprobe);
+		} else if (*vuid != '\0' &&
+		    (attr = sif_node_get_attr(nprobe, "vuid")) != NULL &&
+		    str_cmp(attr, vuid) == 0) {
+			sif_node_destroy(trans, nprobe);
+		} else {
+			count++;
+		}
+
+		nprobe = next;
+	}
+
+	while (count >= VOL_PROBE_CACHE_MAX) {
+		sif_node_destroy(trans, sif_node_first_child(nprobes));
+		count--;
+	}
+
+	rc = sif_node_append_child(trans, nprobes, "probe", &nprobe);
+	if (rc != EOK)
+		goto error;
+
+	rc = sif_node_set_attr(trans, nprobe, "key", key);
+	if (rc != EOK)
+		goto error;
+
+	rc = sif_node_set_attr(trans, nprobe, "fs", fsname);
+	if (rc != EOK)
+		goto error;
+
+	rc = sif_node_set_attr(trans, nprobe, "label", label);
+	if (rc != EOK)
+		goto error;
+
+	rc = sif_node_set_attr(trans, nprobe, "vuid", vuid);
+	if (rc != EOK)
+		goto error;
+
+	rc = sif_trans_end(trans);
+	if (rc != EOK)
+		goto error;
+
+	fibril_mutex_unlock(&volumes->lock);
+	return EOK;
+error:
+	if (trans != NULL)
+		sif_trans_abort(trans);
+	fibril_mutex_unlock(&volumes->lock);
+	return rc;
+}
+
 /** Get volume information.
  *
  * @param volume Volume
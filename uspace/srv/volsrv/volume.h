@@ -51,6 +51,10 @@ extern errno_t vol_volume_set_mountp(vol_volume_t *, const char *);
 extern errno_t vol_get_ids(vol_volumes_t *, volume_id_t *, size_t,
     size_t *);
 extern errno_t vol_volume_get_info(vol_volume_t *, vol_info_t *);
+extern errno_t vol_probe_cache_lookup(vol_volumes_t *, const char *, char **,
+    char **);
+extern errno_t vol_probe_cache_store(vol_volumes_t *, const char *,
+    const char *, const char *, const char *);
 
 #endif
 